@@ -154,6 +154,7 @@ contains(DEFINES, QGC_ENABLE_PAIRING) {
             INCLUDEPATH += /usr/local/Cellar/openssl/1.0.2t/include
             LIBS += -L/usr/local/Cellar/openssl/1.0.2t/lib
             LIBS += -lcrypto
+            DEFINES += QGC_AES_OPENSSL
         } else {
             # There is some circular reference settings going on between QGCExternalLibs.pri and gqgroundcontrol.pro.
             # So this duplicates some of the enable/disable logic which would normally be in qgroundcontrol.pro.
@@ -164,6 +165,7 @@ contains(DEFINES, QGC_ENABLE_PAIRING) {
         DEFINES -= QGC_ENABLE_PAIRING
     } else {
         LIBS += -lcrypto
+        DEFINES += QGC_AES_OPENSSL
         AndroidBuild {
             contains(QT_ARCH, arm) {
                 LIBS += $$ANDROID_EXTRA_LIBS
@@ -0,0 +1,394 @@
+#include "VideoBenchmark.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <ctime>
+
+#include <GStreamer.h>
+
+#include "QGCLoggingCategory.h"
+
+QGC_LOGGING_CATEGORY(BenchmarkLog, "VideoBenchmark")
+
+VideoBenchmark::VideoBenchmark(const Options& options, QObject* parent)
+    : QObject(parent)
+    , _options(options)
+{
+    _durationTimer.setSingleShot(true);
+    connect(&_durationTimer, &QTimer::timeout, this, &VideoBenchmark::_finish);
+    connect(&_induceTimer, &QTimer::timeout, this, &VideoBenchmark::_inducedTimeout);
+    connect(&_senderTimer, &QTimer::timeout, this, &VideoBenchmark::_pollSenders);
+}
+
+VideoBenchmark::~VideoBenchmark()
+{
+    for (Stream* stream: _streams) {
+        delete stream->receiver;
+        if (stream->sender != nullptr) {
+            gst_element_set_state(stream->sender, GST_STATE_NULL);
+            gst_object_unref(stream->sender);
+        }
+        if (stream->sink != nullptr) {
+            gst_object_unref(stream->sink);
+        }
+        delete stream;
+    }
+}
+
+bool
+VideoBenchmark::start(void)
+{
+    for (int i=0; i<_options.streams; i++) {
+        Stream* stream = new Stream;
+
+        stream->index = i;
+        _streams.append(stream);
+
+        if (_options.testSource.isEmpty()) {
+            stream->url = _options.url;
+        } else {
+            const unsigned port = _options.port + static_cast<unsigned>(i);
+
+            if ((stream->sender = _makeSender(i, port)) == nullptr) {
+                return false;
+            }
+            stream->url = QStringLiteral("udp://127.0.0.1:%1").arg(port);
+        }
+
+        if ((stream->receiver = GStreamer::createVideoReceiver(nullptr)) == nullptr) {
+            qCCritical(BenchmarkLog) << "createVideoReceiver failed";
+            return false;
+        }
+
+        if (_options.decode) {
+            // Sync like a real display so that latency and QoS drops are comparable
+            if ((stream->sink = gst_element_factory_make("fakesink", nullptr)) == nullptr) {
+                qCCritical(BenchmarkLog) << "Failed to create fakesink";
+                return false;
+            }
+            gst_object_ref_sink(stream->sink);
+            g_object_set(stream->sink, "sync", TRUE, "qos", TRUE, nullptr);
+        }
+
+        _connectReceiver(stream);
+    }
+
+    for (Stream* stream: _streams) {
+        if (stream->sender != nullptr && gst_element_set_state(stream->sender, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+            qCCritical(BenchmarkLog) << "Unable to start sender" << stream->index;
+            return false;
+        }
+        _startStream(stream);
+    }
+
+    qCDebug(BenchmarkLog) << "Benchmark started, streams:" << _streams.count() << "seconds:" << _options.duration;
+
+    _cpuStart = static_cast<qint64>(std::clock());
+    _wallTimer.start();
+    _durationTimer.start(static_cast<int>(_options.duration * 1000));
+    _senderTimer.start(1000);
+    if (_options.induceTimeout > 0 && !_options.testSource.isEmpty()) {
+        _induceTimer.start(static_cast<int>(_options.induceTimeout * 1000));
+    }
+
+    return true;
+}
+
+GstElement*
+VideoBenchmark::_makeSender(int index, unsigned port)
+{
+    QString description;
+
+    if (_options.testSource == QLatin1String("videotestsrc")) {
+        description = QStringLiteral("videotestsrc is-live=true pattern=ball ! video/x-raw,width=%1,height=%2,framerate=%3/1 ! "
+                                     "x264enc tune=zerolatency speed-preset=ultrafast key-int-max=%3 ! "
+                                     "rtph264pay config-interval=1 pt=96 ! udpsink host=127.0.0.1 port=%4")
+                .arg(_options.width).arg(_options.height).arg(_options.framerate).arg(port);
+    } else if (QFileInfo(_options.testSource).exists()) {
+        // Replays the capture at its recorded rate, the capture should hold a single RTP H.264 stream
+        description = QStringLiteral("filesrc location=\"%1\" ! pcapparse ! udpsink host=127.0.0.1 port=%2")
+                .arg(QFileInfo(_options.testSource).absoluteFilePath()).arg(port);
+    } else {
+        qCCritical(BenchmarkLog) << "Unknown test source" << _options.testSource;
+        return nullptr;
+    }
+
+    GError*     error   = nullptr;
+    GstElement* sender  = gst_parse_launch(description.toUtf8().constData(), &error);
+
+    if (error != nullptr) {
+        qCCritical(BenchmarkLog) << "Unable to create sender" << index << error->message;
+        g_error_free(error);
+        error = nullptr;
+        if (sender != nullptr) {
+            gst_object_unref(sender);
+        }
+        return nullptr;
+    }
+
+    return sender;
+}
+
+void
+VideoBenchmark::_connectReceiver(Stream* stream)
+{
+    VideoReceiver* receiver = stream->receiver;
+
+    connect(receiver, &VideoReceiver::onStartComplete, this, [this, stream](VideoReceiver::STATUS status) {
+        if (status == VideoReceiver::STATUS_OK) {
+            stream->started = true;
+            if (stream->sink != nullptr) {
+                stream->receiver->startDecoding(stream->sink);
+            }
+        } else if (!_finishing) {
+            qCDebug(BenchmarkLog) << "Stream" << stream->index << "start failed, retrying";
+            QTimer::singleShot(_restartDelayMsecs, this, [this, stream]() {
+                if (!_finishing) {
+                    _startStream(stream);
+                }
+            });
+        }
+    });
+
+    connect(receiver, &VideoReceiver::onStopComplete, this, [this, stream](VideoReceiver::STATUS) {
+        stream->started = false;
+        stream->decoding = false;
+        _addCounters(stream);
+
+        if (_finishing) {
+            if (--_stopping == 0) {
+                _writeResults();
+            }
+        } else {
+            // Watchdog gave up on the stream, reconnect right away
+            _startStream(stream);
+        }
+    });
+
+    connect(receiver, &VideoReceiver::timeout, this, [this, stream]() {
+        if (_finishing) {
+            return;
+        }
+
+        stream->timeouts++;
+        if (stream->stalled) {
+            stream->detectMsecs.append(stream->stallTimer.elapsed());
+            stream->stalled = false;
+            gst_element_set_state(stream->sender, GST_STATE_PLAYING);
+        }
+        stream->reconnecting = true;
+        stream->reconnectTimer.start();
+        qCDebug(BenchmarkLog) << "Stream" << stream->index << "timeout";
+    });
+
+    connect(receiver, &VideoReceiver::streamingChanged, this, [this, stream](bool active) {
+        if (active && !_options.decode) {
+            _frameSeen(stream);
+        }
+    });
+
+    connect(receiver, &VideoReceiver::decodingChanged, this, [this, stream](bool active) {
+        stream->decoding = active;
+        if (active) {
+            _frameSeen(stream);
+        }
+    });
+
+    // Source restarted without stopping the receiver
+    connect(receiver, &VideoReceiver::streamRecovered, this, [this, stream](qint64 msecs) {
+        Q_UNUSED(msecs)
+        _frameSeen(stream);
+    });
+
+    connect(receiver, &VideoReceiver::videoDecoderChanged, this, [stream](QString decoder, bool hardware, QString memory) {
+        Q_UNUSED(memory)
+        stream->decoder = decoder;
+        stream->hardware = hardware;
+    });
+
+    connect(receiver, &VideoReceiver::latencyStatsChanged, this, [this, stream](VideoReceiver::LatencyStats stats) {
+        stream->last = stats;
+
+        if (_finishing || (_options.decode && !stream->decoding)) {
+            return;
+        }
+
+        stream->samples++;
+        stream->fpsSum += stats.framesPerSecond;
+        if (stats.totalMsecs >= 0) {
+            stream->latencySamples++;
+            stream->latencySum += stats.totalMsecs;
+            stream->latencyMax = qMax(stream->latencyMax, stats.totalMsecs);
+        }
+        if (stats.jitterMsecs >= 0) {
+            stream->jitterSamples++;
+            stream->jitterSum += stats.jitterMsecs;
+        }
+    });
+}
+
+void
+VideoBenchmark::_startStream(Stream* stream)
+{
+    stream->receiver->start(stream->url, _options.timeout);
+}
+
+void
+VideoBenchmark::_addCounters(Stream* stream)
+{
+    stream->lostTotal       += stream->last.packetsLost;
+    stream->lateTotal       += stream->last.packetsLate;
+    stream->droppedTotal    += stream->last.framesDropped;
+    stream->last            = VideoReceiver::LatencyStats();
+}
+
+void
+VideoBenchmark::_frameSeen(Stream* stream)
+{
+    if (stream->reconnecting) {
+        stream->reconnecting = false;
+        stream->reconnectMsecs.append(stream->reconnectTimer.elapsed());
+        qCDebug(BenchmarkLog) << "Stream" << stream->index << "reconnected after" << stream->reconnectMsecs.last() << "msecs";
+    }
+}
+
+void
+VideoBenchmark::_inducedTimeout(void)
+{
+    // One stream at a time, the others keep going
+    for (int i=0; i<_streams.count(); i++) {
+        Stream* stream = _streams[_nextStall++ % _streams.count()];
+
+        if (stream->started && !stream->stalled && !stream->reconnecting) {
+            qCDebug(BenchmarkLog) << "Stalling stream" << stream->index;
+            stream->stalled = true;
+            stream->stallTimer.start();
+            gst_element_set_state(stream->sender, GST_STATE_PAUSED);
+            break;
+        }
+    }
+}
+
+void
+VideoBenchmark::_pollSenders(void)
+{
+    for (Stream* stream: _streams) {
+        if (stream->sender == nullptr) {
+            continue;
+        }
+
+        GstBus*     bus = gst_element_get_bus(stream->sender);
+        GstMessage* msg;
+
+        while ((msg = gst_bus_pop_filtered(bus, static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR))) != nullptr) {
+            if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
+                GError* error = nullptr;
+
+                gst_message_parse_error(msg, &error, nullptr);
+                qCWarning(BenchmarkLog) << "Sender" << stream->index << "error:" << (error != nullptr ? error->message : "");
+                if (error != nullptr) {
+                    g_error_free(error);
+                }
+            } else if (!stream->stalled) {
+                // Loop captures for soak runs
+                gst_element_set_state(stream->sender, GST_STATE_NULL);
+                gst_element_set_state(stream->sender, GST_STATE_PLAYING);
+            }
+            gst_message_unref(msg);
+        }
+
+        gst_object_unref(bus);
+    }
+}
+
+void
+VideoBenchmark::_finish(void)
+{
+    _finishing = true;
+    _induceTimer.stop();
+    _senderTimer.stop();
+
+    for (Stream* stream: _streams) {
+        _stopping++;
+        stream->receiver->stop();
+    }
+}
+
+void
+VideoBenchmark::_writeResults(void)
+{
+    const double    wallSecs    = _wallTimer.elapsed() / 1000.0;
+    const double    cpuSecs     = static_cast<double>(static_cast<qint64>(std::clock()) - _cpuStart) / CLOCKS_PER_SEC;
+    const double    cpuPercent  = wallSecs > 0 ? cpuSecs / wallSecs * 100 : 0;
+    bool            allDecoded  = true;
+    QJsonArray      results;
+
+    auto average = [](const QList<qint64>& values) {
+        qint64 sum = 0;
+        for (qint64 value: values) {
+            sum += value;
+        }
+        return values.isEmpty() ? -1.0 : static_cast<double>(sum) / values.count();
+    };
+
+    for (const Stream* stream: _streams) {
+        QJsonObject result;
+
+        if (stream->samples == 0) {
+            allDecoded = false;
+        }
+
+        result[QStringLiteral("stream")]            = stream->index;
+        result[QStringLiteral("url")]               = stream->url;
+        result[QStringLiteral("decoder")]           = stream->decoder;
+        result[QStringLiteral("hardware")]          = stream->hardware;
+        result[QStringLiteral("framesPerSecond")]   = stream->samples > 0 ? stream->fpsSum / stream->samples : 0.0;
+        result[QStringLiteral("latencyMsecs")]      = stream->latencySamples > 0 ? stream->latencySum / stream->latencySamples : -1.0;
+        result[QStringLiteral("latencyMaxMsecs")]   = stream->latencySamples > 0 ? stream->latencyMax : -1.0;
+        result[QStringLiteral("jitterMsecs")]       = stream->jitterSamples > 0 ? stream->jitterSum / stream->jitterSamples : -1.0;
+        result[QStringLiteral("packetsLost")]       = static_cast<double>(stream->lostTotal);
+        result[QStringLiteral("packetsLate")]       = static_cast<double>(stream->lateTotal);
+        result[QStringLiteral("framesDropped")]     = static_cast<double>(stream->droppedTotal);
+        result[QStringLiteral("timeouts")]          = stream->timeouts;
+        result[QStringLiteral("reconnects")]        = stream->reconnectMsecs.count();
+        result[QStringLiteral("reconnectMsecs")]    = average(stream->reconnectMsecs);
+        result[QStringLiteral("timeoutDetectMsecs")] = average(stream->detectMsecs);
+        results.append(result);
+    }
+
+    QJsonObject root;
+
+    root[QStringLiteral("source")]              = _options.testSource.isEmpty() ? _options.url : _options.testSource;
+    root[QStringLiteral("streams")]             = _streams.count();
+    root[QStringLiteral("durationSecs")]        = wallSecs;
+    root[QStringLiteral("decode")]              = _options.decode;
+    gchar* version = gst_version_string();
+    root[QStringLiteral("gstreamerVersion")]    = QString::fromUtf8(version);
+    g_free(version);
+    root[QStringLiteral("cpuPercent")]          = cpuPercent;
+    // Pipelines share worker and streaming threads, so this is the process total split evenly
+    root[QStringLiteral("cpuPercentPerStream")] = _streams.isEmpty() ? 0.0 : cpuPercent / _streams.count();
+    root[QStringLiteral("results")]             = results;
+
+    const QByteArray json = QJsonDocument(root).toJson();
+
+    if (_options.output.isEmpty()) {
+        fputs(json.constData(), stdout);
+        fflush(stdout);
+    } else {
+        QFile file(_options.output);
+        if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            file.write(json);
+        } else {
+            qCCritical(BenchmarkLog) << "Unable to write" << _options.output << file.errorString();
+            allDecoded = false;
+        }
+    }
+
+    emit finished(allDecoded ? 0 : 1);
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QList>
+#include <QTimer>
+
+#include <gst/gst.h>
+
+#include <VideoReceiver.h>
+
+/// Headless benchmark/soak run of several receivers at once, used to qualify ground station hardware and GStreamer
+/// versions. Each stream either plays the given url or a local sender pipeline (videotestsrc or a pcap capture of an
+/// RTP stream) which is sent over UDP to the receiver. At the end the results are written as JSON.
+class VideoBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        QString     url;                        ///< Used when testSource is empty
+        QString     testSource;                 ///< "videotestsrc" or a .pcap file
+        int         streams             = 1;
+        unsigned    duration            = 60;   ///< seconds
+        unsigned    timeout             = 5;    ///< Receiver source timeout, seconds
+        bool        decode              = true;
+        unsigned    port                = 5600; ///< First UDP port for test sources, one per stream
+        unsigned    induceTimeout       = 0;    ///< Stall one test source every N seconds, 0 to disable
+        QString     output;                     ///< JSON file, stdout if empty
+        int         width               = 1280; ///< videotestsrc
+        int         height              = 720;
+        int         framerate           = 30;
+    };
+
+    explicit VideoBenchmark(const Options& options, QObject* parent = nullptr);
+    ~VideoBenchmark();
+
+    /// @return false: Could not set up the senders or receivers
+    bool start(void);
+
+signals:
+    void finished(int exitCode);
+
+private:
+    struct Stream {
+        int             index           = 0;
+        QString         url;
+        VideoReceiver*  receiver        = nullptr;
+        GstElement*     sender          = nullptr;
+        GstElement*     sink            = nullptr;
+        bool            started         = false;
+        bool            decoding        = false;
+
+        // Latency stats samples while decoding
+        int             samples         = 0;
+        double          fpsSum          = 0;
+        int             latencySamples  = 0;
+        double          latencySum      = 0;
+        double          latencyMax      = 0;
+        int             jitterSamples   = 0;
+        double          jitterSum       = 0;
+
+        // Receiver counters restart with the receiver, totals are kept over restarts
+        VideoReceiver::LatencyStats last;
+        quint64         lostTotal       = 0;
+        quint64         lateTotal       = 0;
+        quint64         droppedTotal    = 0;
+
+        int             timeouts        = 0;
+        bool            stalled         = false;    ///< Sender paused by induceTimeout
+        QElapsedTimer   stallTimer;
+        QList<qint64>   detectMsecs;                ///< Sender paused to receiver timeout
+        bool            reconnecting    = false;
+        QElapsedTimer   reconnectTimer;
+        QList<qint64>   reconnectMsecs;             ///< Receiver timeout to the first frame again
+
+        QString         decoder;
+        bool            hardware        = false;
+    };
+
+    GstElement* _makeSender         (int index, unsigned port);
+    void        _connectReceiver    (Stream* stream);
+    void        _startStream        (Stream* stream);
+    void        _addCounters        (Stream* stream);
+    void        _frameSeen          (Stream* stream);
+    void        _inducedTimeout     (void);
+    void        _pollSenders        (void);
+    void        _finish             (void);
+    void        _writeResults       (void);
+
+    Options         _options;
+    QList<Stream*>  _streams;
+    QTimer          _durationTimer;
+    QTimer          _induceTimer;
+    QTimer          _senderTimer;
+    QElapsedTimer   _wallTimer;
+    qint64          _cpuStart       = 0;
+    int             _nextStall      = 0;
+    bool            _finishing      = false;
+    int             _stopping       = 0;
+
+    static const int _restartDelayMsecs = 1000;
+};
@@ -119,6 +119,8 @@ jint JNI_OnLoad(JavaVM* vm, void* reserved)
 #include <GStreamer.h>
 #include <VideoReceiver.h>
 
+#include "VideoBenchmark.h"
+
 class VideoReceiverApp : public QRunnable
 {
 public:
@@ -235,10 +237,88 @@ VideoReceiverApp::exec()
         parser.addOption(videoSinkOption);
     }
 
+    QCommandLineOption benchmarkOption("benchmark",
+        QCoreApplication::translate("main", "Run a headless benchmark with this number of streams and print the results as JSON."),
+        QCoreApplication::translate("main", "streams"));
+
+    QCommandLineOption durationOption("duration",
+        QCoreApplication::translate("main", "Benchmark duration."),
+        QCoreApplication::translate("main", "seconds"));
+
+    QCommandLineOption testSourceOption("test-source",
+        QCoreApplication::translate("main", "Benchmark against local senders instead of url: videotestsrc or a pcap file of an RTP H.264 stream."),
+        QCoreApplication::translate("main", "source"));
+
+    QCommandLineOption portOption("port",
+        QCoreApplication::translate("main", "First UDP port of the test sources."),
+        QCoreApplication::translate("main", "port"));
+
+    QCommandLineOption induceTimeoutOption("induce-timeout",
+        QCoreApplication::translate("main", "Stall one test source at this interval to measure reconnects."),
+        QCoreApplication::translate("main", "seconds"));
+
+    QCommandLineOption outputOption(QStringList() << "o" << "output",
+        QCoreApplication::translate("main", "Write the benchmark results to a file."),
+        QCoreApplication::translate("main", "file"));
+
+    if (!_qmlAllowed) {
+        parser.addOption(benchmarkOption);
+        parser.addOption(durationOption);
+        parser.addOption(testSourceOption);
+        parser.addOption(portOption);
+        parser.addOption(induceTimeoutOption);
+        parser.addOption(outputOption);
+    }
+
     parser.process(_app);
 
     const QStringList args = parser.positionalArguments();
 
+    if (parser.isSet(benchmarkOption)) {
+        VideoBenchmark::Options options;
+
+        options.streams = qMax(1, parser.value(benchmarkOption).toInt());
+        options.decode = !parser.isSet(noDecodeOption);
+
+        if (parser.isSet(testSourceOption)) {
+            options.testSource = parser.value(testSourceOption);
+        } else if (args.size() == 1) {
+            options.url = args.at(0);
+        } else {
+            parser.showHelp(0);
+        }
+
+        if (parser.isSet(timeoutOption)) {
+            options.timeout = parser.value(timeoutOption).toUInt();
+        }
+
+        if (parser.isSet(durationOption)) {
+            options.duration = parser.value(durationOption).toUInt();
+        }
+
+        if (parser.isSet(portOption)) {
+            options.port = parser.value(portOption).toUInt();
+        }
+
+        if (parser.isSet(induceTimeoutOption)) {
+            options.induceTimeout = parser.value(induceTimeoutOption).toUInt();
+        }
+
+        if (parser.isSet(outputOption)) {
+            options.output = parser.value(outputOption);
+        }
+
+        VideoBenchmark benchmark(options);
+
+        QObject::connect(&benchmark, &VideoBenchmark::finished, &_app, &QCoreApplication::exit);
+
+        if (!benchmark.start()) {
+            return 1;
+        }
+
+        return _app.exec();
+    }
+
     if (args.size() != 1) {
         parser.showHelp(0);
     }
@@ -173,6 +173,34 @@ contains (CONFIG, QGC_DISABLE_PX4_PLUGIN_FACTORY) {
     CONFIG += PX4FirmwarePluginFactory
 }
 
+# Resources which only some users need are built as separate bundles, see src/QGCResourceBundles.h
+contains (CONFIG, QGC_LAZY_RESOURCES) {
+    MacBuild | iOSBuild {
+        message("Resource bundles are not supported in app bundles, all resources are compiled in")
+    } else {
+        message("Build firmware plugin resources and Korean fonts as resource bundles")
+        CONFIG  += LazyResources
+        DEFINES += QGC_LAZY_RESOURCES
+    }
+}
+
+# Trace points, see src/QGCTrace.h
+contains (CONFIG, QGC_DISABLE_TRACE) {
+    message("Disable trace points")
+    DEFINES += QGC_TRACE_DISABLED
+}
+
+# Allocator heap statistics for the memory usage, see src/QGCMemoryAccounting.h
+contains (CONFIG, QGC_JEMALLOC_STATS) {
+    message("Link jemalloc for heap statistics")
+    DEFINES += QGC_JEMALLOC_STATS
+    LIBS += -ljemalloc
+} else:contains (CONFIG, QGC_TCMALLOC_STATS) {
+    message("Link tcmalloc for heap statistics")
+    DEFINES += QGC_TCMALLOC_STATS
+    LIBS += -ltcmalloc
+}
+
 # Bluetooth
 contains (DEFINES, QGC_DISABLE_BLUETOOTH) {
     message("Skipping support for Bluetooth (manual override from command line)")
@@ -361,6 +389,13 @@ CustomBuild {
         $$PWD/resources/InstrumentValueIcons/InstrumentValueIcons.qrc \
 }
 
+# Only used when Korean is the language
+LazyResources {
+    RESOURCE_BUNDLES += $$PWD/qgckoreanfonts.qrc
+} else {
+    RESOURCES += $$PWD/qgckoreanfonts.qrc
+}
+
 #
 # Main QGroundControl portion of project file
 #
@@ -426,6 +461,7 @@ contains (DEFINES, QGC_ENABLE_PAIRING) {
 HEADERS += \
     src/QmlControls/QmlUnitsConversion.h \
     src/Vehicle/VehicleEscStatusFactGroup.h \
+    src/Vehicle/VehicleEscStatusModel.h \
     src/api/QGCCorePlugin.h \
     src/api/QGCOptions.h \
     src/api/QGCSettings.h \
@@ -435,10 +471,16 @@ HEADERS += \
 contains (DEFINES, QGC_ENABLE_PAIRING) {
     HEADERS += \
         src/PairingManager/aes.h
+
+    contains (DEFINES, QGC_AES_OPENSSL) {
+        HEADERS += \
+            src/PairingManager/AESCipherOpenSSL.h
+    }
 }
 
 SOURCES += \
     src/Vehicle/VehicleEscStatusFactGroup.cc \
+    src/Vehicle/VehicleEscStatusModel.cc \
     src/api/QGCCorePlugin.cc \
     src/api/QGCOptions.cc \
     src/api/QGCSettings.cc \
@@ -447,6 +489,11 @@ SOURCES += \
 contains (DEFINES, QGC_ENABLE_PAIRING) {
     SOURCES += \
         src/PairingManager/aes.cpp
+
+    contains (DEFINES, QGC_AES_OPENSSL) {
+        SOURCES += \
+            src/PairingManager/AESCipherOpenSSL.cc
+    }
 }
 
 #
@@ -461,20 +508,29 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
 
     HEADERS += \
         src/Audio/AudioOutputTest.h \
+        src/AutoPilotPlugins/APM/CompassSphereFitTest.h \
+        src/FactSystem/FactGroupTest.h \
+        src/FactSystem/FactHistoryTest.h \
+        src/FactSystem/FactMetaDataStoreTest.h \
         src/FactSystem/FactSystemTestBase.h \
         src/FactSystem/FactSystemTestGeneric.h \
         src/FactSystem/FactSystemTestPX4.h \
         src/FactSystem/ParameterManagerTest.h \
+        src/FactSystem/SettingsStoreTest.h \
+        src/FollowMe/FollowMeMotionEstimatorTest.h \
         src/MissionManager/CameraCalcTest.h \
         src/MissionManager/CameraSectionTest.h \
         src/MissionManager/CorridorScanComplexItemTest.h \
         src/MissionManager/FWLandingPatternTest.h \
+        src/MissionManager/KMLPlanDocumentTest.h \
         src/MissionManager/LandingComplexItemTest.h \
         src/MissionManager/MissionCommandTreeEditorTest.h \
         src/MissionManager/MissionCommandTreeTest.h \
         src/MissionManager/MissionControllerManagerTest.h \
         src/MissionManager/MissionControllerTest.h \
         src/MissionManager/MissionItemTest.h \
+        src/MissionManager/MissionLoadBenchmark.h \
+        src/MissionManager/MissionPlanningBenchmark.h \
         src/MissionManager/MissionManagerTest.h \
         src/MissionManager/MissionSettingsTest.h \
         src/MissionManager/PlanMasterControllerTest.h \
@@ -488,18 +544,87 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
         src/MissionManager/TransectStyleComplexItemTest.h \
         src/MissionManager/TransectStyleComplexItemTestBase.h \
         src/MissionManager/VisualMissionItemTest.h \
+        src/PositionManager/NmeaParserTest.h \
+        src/QmlControls/InstrumentValueDataTest.h \
+        src/QmlControls/ParameterSearchIndexTest.h \
+        src/QmlControls/QGCImageProviderTest.h \
+        src/QmlControls/QmlObjectListModelTest.h \
+        src/QmlControls/RCChannelThrottleTest.h \
+        src/QmlControls/TerrainProfileTest.h \
+        src/QmlControls/VehicleMarkerLayerTest.h \
+        src/QtLocationPlugin/QGCTileCacheTest.h \
+        src/qgcunittest/BenchmarkResults.h \
+        src/qgcunittest/GeoBenchmark.h \
         src/qgcunittest/GeoTest.h \
+        src/qgcunittest/LogCompressorTest.h \
         src/qgcunittest/MavlinkLogTest.h \
         src/qgcunittest/MultiSignalSpy.h \
         src/qgcunittest/MultiSignalSpyV2.h \
+        src/qgcunittest/QGCLoggingCategoryTest.h \
+        src/qgcunittest/QGCMemoryAccountingTest.h \
+        src/qgcunittest/QGCNetworkServiceTest.h \
+        src/qgcunittest/QGCPowerManagerTest.h \
+        src/qgcunittest/QGCTimerWheelTest.h \
+        src/qgcunittest/QGCTraceTest.h \
+        src/qgcunittest/QGCZlibTest.h \
+        src/qgcunittest/StartupBenchmark.h \
         src/qgcunittest/UnitTest.h \
+        src/qgcunittest/VideoKeyframeIndexTest.h \
+        src/qgcunittest/VideoStreamPoolTest.h \
+        src/Terrain/TerrainLocalDEMTest.h \
+        src/Terrain/TerrainPathQueryTest.h \
+        src/Terrain/TerrainTileTest.h \
         src/Vehicle/FTPManagerTest.h \
+        src/Vehicle/InitialConnectTest.h \
         src/Vehicle/RequestMessageTest.h \
         src/Vehicle/SendMavCommandWithHandlerTest.h \
         src/Vehicle/SendMavCommandWithSignallingTest.h \
+        src/Vehicle/TelemetryBenchmark.h \
+        src/Vehicle/TelemetryRecorderTest.h \
+        src/ADSB/ADSBParserTest.h \
+        src/ADSB/ADSBTargetModelTest.h \
+        src/ADSB/TrafficConflictEngineTest.h \
+        src/Camera/QGCCameraDefinitionTest.h \
+        src/Camera/QGCCameraMediaTest.h \
+        src/GPS/NTRIPTest.h \
+        src/Vehicle/LightweightVehicleTest.h \
+        src/Vehicle/MAVLinkLogUploaderTest.h \
+        src/Vehicle/MAVLinkULogWriterTest.h \
+        src/Vehicle/MessageDuplicateFilterTest.h \
+        src/Vehicle/MessageRateManagerTest.h \
+        src/Vehicle/StatusTextHandlerTest.h \
+        src/Vehicle/TerrainProtocolHandlerTest.h \
+        src/Vehicle/ObstacleDistanceBufferTest.h \
+        src/Vehicle/TrajectoryBufferTest.h \
         src/Vehicle/VehicleLinkManagerTest.h \
+        src/Vehicle/VehicleStatusModelTest.h \
+        src/VehicleSetup/FirmwareDownloadCacheTest.h \
+        src/api/QGCCorePluginTest.h \
+        src/comm/LinkReadStatisticsTest.h \
+        src/comm/LinkTrafficStatisticsTest.h \
+        src/comm/MAVLinkFieldDecoderTest.h \
+        src/comm/MAVLinkForwarderTest.h \
+        src/comm/MAVLinkFramerTest.h \
+        src/comm/MAVLinkLogWriterTest.h \
+        src/comm/MAVLinkMessageDispatcherTest.h \
+        src/comm/MAVLinkMessageStatisticsTest.h \
+        src/comm/MockLinkLoadGeneratorTest.h \
+        src/comm/QGCByteRingBufferTest.h \
+        src/comm/QGCPacketQueueTest.h \
+        src/comm/TCPLinkTest.h \
+        src/comm/TelemetryStreamServerTest.h \
+        src/comm/TlogIndexTest.h \
+        src/comm/UDPLinkTest.h \
+        src/uas/UASMessageModelTest.h \
         #src/qgcunittest/RadioConfigTest.h \
+        src/AnalyzeView/ExifParserTest.h \
         #src/AnalyzeView/LogDownloadTest.h \
+        src/AnalyzeView/LogIndexerTest.h \
+        src/AnalyzeView/MAVLinkChartBufferTest.h \
+        src/AnalyzeView/MavlinkConsoleBufferTest.h \
+        src/AnalyzeView/TlogAnalyzerTest.h \
+        src/AnalyzeView/ULogReaderTest.h \
+        src/AnalyzeView/VibrationAnalyzerTest.h \
         #src/qgcunittest/FileDialogTest.h \
         #src/qgcunittest/FileManagerTest.h \
         #src/qgcunittest/MainWindowTest.h \
@@ -507,20 +632,29 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
 
     SOURCES += \
         src/Audio/AudioOutputTest.cc \
+        src/AutoPilotPlugins/APM/CompassSphereFitTest.cc \
+        src/FactSystem/FactGroupTest.cc \
+        src/FactSystem/FactHistoryTest.cc \
+        src/FactSystem/FactMetaDataStoreTest.cc \
         src/FactSystem/FactSystemTestBase.cc \
         src/FactSystem/FactSystemTestGeneric.cc \
         src/FactSystem/FactSystemTestPX4.cc \
         src/FactSystem/ParameterManagerTest.cc \
+        src/FactSystem/SettingsStoreTest.cc \
+        src/FollowMe/FollowMeMotionEstimatorTest.cc \
         src/MissionManager/CameraCalcTest.cc \
         src/MissionManager/CameraSectionTest.cc \
         src/MissionManager/CorridorScanComplexItemTest.cc \
         src/MissionManager/FWLandingPatternTest.cc \
+        src/MissionManager/KMLPlanDocumentTest.cc \
         src/MissionManager/LandingComplexItemTest.cc \
         src/MissionManager/MissionCommandTreeEditorTest.cc \
         src/MissionManager/MissionCommandTreeTest.cc \
         src/MissionManager/MissionControllerManagerTest.cc \
         src/MissionManager/MissionControllerTest.cc \
         src/MissionManager/MissionItemTest.cc \
+        src/MissionManager/MissionLoadBenchmark.cc \
+        src/MissionManager/MissionPlanningBenchmark.cc \
         src/MissionManager/MissionManagerTest.cc \
         src/MissionManager/MissionSettingsTest.cc \
         src/MissionManager/PlanMasterControllerTest.cc \
@@ -534,47 +668,141 @@ DebugBuild { PX4FirmwarePlugin { PX4FirmwarePluginFactory { APMFirmwarePlugin {
         src/MissionManager/TransectStyleComplexItemTest.cc \
         src/MissionManager/TransectStyleComplexItemTestBase.cc \
         src/MissionManager/VisualMissionItemTest.cc \
+        src/PositionManager/NmeaParserTest.cc \
+        src/QmlControls/InstrumentValueDataTest.cc \
+        src/QmlControls/ParameterSearchIndexTest.cc \
+        src/QmlControls/QGCImageProviderTest.cc \
+        src/QmlControls/QmlObjectListModelTest.cc \
+        src/QmlControls/RCChannelThrottleTest.cc \
+        src/QmlControls/TerrainProfileTest.cc \
+        src/QmlControls/VehicleMarkerLayerTest.cc \
+        src/QtLocationPlugin/QGCTileCacheTest.cc \
+        src/qgcunittest/BenchmarkResults.cc \
+        src/qgcunittest/GeoBenchmark.cc \
         src/qgcunittest/GeoTest.cc \
+        src/qgcunittest/LogCompressorTest.cc \
         src/qgcunittest/MavlinkLogTest.cc \
         src/qgcunittest/MultiSignalSpy.cc \
         src/qgcunittest/MultiSignalSpyV2.cc \
+        src/qgcunittest/QGCLoggingCategoryTest.cc \
+        src/qgcunittest/QGCMemoryAccountingTest.cc \
+        src/qgcunittest/QGCNetworkServiceTest.cc \
+        src/qgcunittest/QGCPowerManagerTest.cc \
+        src/qgcunittest/QGCTimerWheelTest.cc \
+        src/qgcunittest/QGCTraceTest.cc \
+        src/qgcunittest/QGCZlibTest.cc \
+        src/qgcunittest/StartupBenchmark.cc \
         src/qgcunittest/UnitTest.cc \
         src/qgcunittest/UnitTestList.cc \
+        src/qgcunittest/VideoKeyframeIndexTest.cc \
+        src/qgcunittest/VideoStreamPoolTest.cc \
+        src/Terrain/TerrainLocalDEMTest.cc \
+        src/Terrain/TerrainPathQueryTest.cc \
+        src/Terrain/TerrainTileTest.cc \
         src/Vehicle/FTPManagerTest.cc \
+        src/Vehicle/InitialConnectTest.cc \
         src/Vehicle/RequestMessageTest.cc \
         src/Vehicle/SendMavCommandWithHandlerTest.cc \
         src/Vehicle/SendMavCommandWithSignallingTest.cc \
+        src/Vehicle/TelemetryBenchmark.cc \
+        src/Vehicle/TelemetryRecorderTest.cc \
+        src/ADSB/ADSBParserTest.cc \
+        src/ADSB/ADSBTargetModelTest.cc \
+        src/ADSB/TrafficConflictEngineTest.cc \
+        src/Camera/QGCCameraDefinitionTest.cc \
+        src/Camera/QGCCameraMediaTest.cc \
+        src/GPS/NTRIPTest.cc \
+        src/Vehicle/LightweightVehicleTest.cc \
+        src/Vehicle/MAVLinkLogUploaderTest.cc \
+        src/Vehicle/MAVLinkULogWriterTest.cc \
+        src/Vehicle/MessageDuplicateFilterTest.cc \
+        src/Vehicle/MessageRateManagerTest.cc \
+        src/Vehicle/StatusTextHandlerTest.cc \
+        src/Vehicle/TerrainProtocolHandlerTest.cc \
+        src/Vehicle/ObstacleDistanceBufferTest.cc \
+        src/Vehicle/TrajectoryBufferTest.cc \
         src/Vehicle/VehicleLinkManagerTest.cc \
+        src/Vehicle/VehicleStatusModelTest.cc \
+        src/VehicleSetup/FirmwareDownloadCacheTest.cc \
+        src/api/QGCCorePluginTest.cc \
+        src/comm/LinkReadStatisticsTest.cc \
+        src/comm/LinkTrafficStatisticsTest.cc \
+        src/comm/MAVLinkFieldDecoderTest.cc \
+        src/comm/MAVLinkForwarderTest.cc \
+        src/comm/MAVLinkFramerTest.cc \
+        src/comm/MAVLinkLogWriterTest.cc \
+        src/comm/MAVLinkMessageDispatcherTest.cc \
+        src/comm/MAVLinkMessageStatisticsTest.cc \
+        src/comm/MockLinkLoadGeneratorTest.cc \
+        src/comm/QGCByteRingBufferTest.cc \
+        src/comm/QGCPacketQueueTest.cc \
+        src/comm/TCPLinkTest.cc \
+        src/comm/TelemetryStreamServerTest.cc \
+        src/comm/TlogIndexTest.cc \
+        src/comm/UDPLinkTest.cc \
+        src/uas/UASMessageModelTest.cc \
         #src/qgcunittest/RadioConfigTest.cc \
+        src/AnalyzeView/ExifParserTest.cc \
         #src/AnalyzeView/LogDownloadTest.cc \
+        src/AnalyzeView/LogIndexerTest.cc \
+        src/AnalyzeView/MAVLinkChartBufferTest.cc \
+        src/AnalyzeView/MavlinkConsoleBufferTest.cc \
+        src/AnalyzeView/TlogAnalyzerTest.cc \
+        src/AnalyzeView/ULogReaderTest.cc \
+        src/AnalyzeView/VibrationAnalyzerTest.cc \
         #src/qgcunittest/FileDialogTest.cc \
         #src/qgcunittest/FileManagerTest.cc \
         #src/qgcunittest/MainWindowTest.cc \
         #src/qgcunittest/MessageBoxTest.cc \
 
+    contains (DEFINES, QGC_ENABLE_PAIRING) {
+        HEADERS += \
+            src/PairingManager/AESTest.h
+
+        SOURCES += \
+            src/PairingManager/AESTest.cc
+    }
+
 } } } } } }
 
 # Main QGC Headers and Source files
 
 HEADERS += \
+    src/ADSB/ADSBParser.h \
+    src/ADSB/ADSBTargetModel.h \
     src/ADSB/ADSBVehicle.h \
     src/ADSB/ADSBVehicleManager.h \
+    src/ADSB/TrafficConflictEngine.h \
     src/AnalyzeView/LogDownloadController.h \
+    src/AnalyzeView/LogIndexController.h \
+    src/AnalyzeView/LogIndexer.h \
+    src/AnalyzeView/LogIndexManager.h \
+    src/AnalyzeView/MAVLinkChartBuffer.h \
     src/AnalyzeView/PX4LogParser.h \
+    src/AnalyzeView/TlogAnalyzer.h \
     src/AnalyzeView/ULogParser.h \
+    src/AnalyzeView/ULogReader.h \
+    src/AnalyzeView/MavlinkConsoleBuffer.h \
     src/AnalyzeView/MavlinkConsoleController.h \
+    src/AnalyzeView/VibrationAnalyzer.h \
+    src/AnalyzeView/VibrationController.h \
+    src/AnalyzeView/VibrationSpectrum.h \
     src/Audio/AudioOutput.h \
+    src/Audio/AudioOutputQueue.h \
     src/Camera/QGCCameraControl.h \
+    src/Camera/QGCCameraDefinition.h \
     src/Camera/QGCCameraIO.h \
+    src/Camera/QGCCameraMedia.h \
     src/Camera/QGCCameraManager.h \
     src/CmdLineOptParser.h \
     src/FirmwarePlugin/PX4/px4_custom_mode.h \
     src/FollowMe/FollowMe.h \
+    src/FollowMe/FollowMeMotionEstimator.h \
     src/Joystick/Joystick.h \
     src/Joystick/JoystickManager.h \
     src/JsonHelper.h \
-    src/KMLDomDocument.h \
     src/KMLHelper.h \
+    src/KMLStreamWriter.h \
     src/LogCompressor.h \
     src/MissionManager/CameraCalc.h \
     src/MissionManager/CameraSection.h \
@@ -584,9 +812,10 @@ HEADERS += \
     src/MissionManager/CorridorScanPlanCreator.h \
     src/MissionManager/BlankPlanCreator.h \
     src/MissionManager/FixedWingLandingComplexItem.h \
+    src/MissionManager/FlightPathLOD.h \
     src/MissionManager/GeoFenceController.h \
     src/MissionManager/GeoFenceManager.h \
-    src/MissionManager/KMLPlanDomDocument.h \
+    src/MissionManager/KMLPlanDocument.h \
     src/MissionManager/LandingComplexItem.h \
     src/MissionManager/MissionCommandList.h \
     src/MissionManager/MissionCommandTree.h \
@@ -599,10 +828,12 @@ HEADERS += \
     src/MissionManager/PlanCreator.h \
     src/MissionManager/PlanManager.h \
     src/MissionManager/PlanMasterController.h \
+    src/MissionManager/PlanUndoStack.h \
     src/MissionManager/QGCFenceCircle.h \
     src/MissionManager/QGCFencePolygon.h \
     src/MissionManager/QGCMapCircle.h \
     src/MissionManager/QGCMapPolygon.h \
+    src/MissionManager/QGCPolygonIndex.h \
     src/MissionManager/QGCMapPolyline.h \
     src/MissionManager/RallyPoint.h \
     src/MissionManager/RallyPointController.h \
@@ -616,8 +847,11 @@ HEADERS += \
     src/MissionManager/SurveyPlanCreator.h \
     src/MissionManager/TakeoffMissionItem.h \
     src/MissionManager/TransectStyleComplexItem.h \
+    src/MissionManager/VisualItemsViewportModel.h \
     src/MissionManager/VisualMissionItem.h \
     src/MissionManager/VTOLLandingComplexItem.h \
+    src/PositionManager/NmeaParser.h \
+    src/PositionManager/NmeaPositionSource.h \
     src/PositionManager/PositionManager.h \
     src/PositionManager/SimulatedPosition.h \
     src/Geo/QGCGeo.h \
@@ -635,9 +869,15 @@ HEADERS += \
     src/QGCFileDownload.h \
     src/QGCLoggingCategory.h \
     src/QGCMapPalette.h \
+    src/QGCMemoryAccounting.h \
     src/QGCPalette.h \
     src/QGCQGeoCoordinate.h \
     src/QGCTemporaryFile.h \
+    src/QGCNetworkService.h \
+    src/QGCPowerManager.h \
+    src/QGCResourceBundles.h \
+    src/QGCTimerWheel.h \
+    src/QGCTrace.h \
     src/QGCToolbox.h \
     src/QGCZlib.h \
     src/QmlControls/AppMessages.h \
@@ -647,17 +887,21 @@ HEADERS += \
     src/QmlControls/InstrumentValueData.h \
     src/QmlControls/FactValueGrid.h \
     src/QmlControls/ParameterEditorController.h \
+    src/QmlControls/ParameterSearchIndex.h \
     src/QmlControls/QGCFileDialogController.h \
     src/QmlControls/QGCImageProvider.h \
     src/QmlControls/QGroundControlQmlGlobal.h \
     src/QmlControls/QmlObjectListModel.h \
     src/QmlControls/QGCGeoBoundingCube.h \
     src/QmlControls/RCChannelMonitorController.h \
+    src/QmlControls/RCChannelThrottle.h \
     src/QmlControls/RCToParamDialogController.h \
     src/QmlControls/ScreenToolsController.h \
+    src/QmlControls/ObstacleDistanceItem.h \
     src/QmlControls/TerrainProfile.h \
     src/QmlControls/ToolStripAction.h \
     src/QmlControls/ToolStripActionList.h \
+    src/QmlControls/VehicleMarkerLayer.h \
     src/QtLocationPlugin/QMLControl/QGCMapEngineManager.h \
     src/Settings/ADSBVehicleManagerSettings.h \
     src/Settings/AppSettings.h \
@@ -675,6 +919,7 @@ HEADERS += \
     src/Settings/VideoSettings.h \
     src/ShapeFileHelper.h \
     src/SHPFileHelper.h \
+    src/Terrain/TerrainLocalDEM.h \
     src/Terrain/TerrainQuery.h \
     src/TerrainTile.h \
     src/Vehicle/CompInfo.h \
@@ -685,15 +930,24 @@ HEADERS += \
     src/Vehicle/GPSRTKFactGroup.h \
     src/Vehicle/InitialConnectStateMachine.h \
     src/Vehicle/MAVLinkLogManager.h \
+    src/Vehicle/MAVLinkLogUploader.h \
+    src/Vehicle/MAVLinkULogWriter.h \
+    src/Vehicle/MessageDuplicateFilter.h \
+    src/Vehicle/MessageRateManager.h \
     src/Vehicle/MultiVehicleManager.h \
     src/Vehicle/StateMachine.h \
+    src/Vehicle/StatusTextHandler.h \
     src/Vehicle/SysStatusSensorInfo.h \
+    src/Vehicle/TelemetryRecorder.h \
     src/Vehicle/TerrainFactGroup.h \
     src/Vehicle/TerrainProtocolHandler.h \
+    src/Vehicle/ObstacleDistanceBuffer.h \
+    src/Vehicle/TrajectoryBuffer.h \
     src/Vehicle/TrajectoryPoints.h \
     src/Vehicle/Vehicle.h \
     src/Vehicle/VehicleObjectAvoidance.h \
     src/Vehicle/VehicleBatteryFactGroup.h \
+    src/Vehicle/VehicleBatteryStatusModel.h \
     src/Vehicle/VehicleClockFactGroup.h \
     src/Vehicle/VehicleDistanceSensorFactGroup.h \
     src/Vehicle/VehicleEstimatorStatusFactGroup.h \
@@ -707,10 +961,23 @@ HEADERS += \
     src/comm/LinkConfiguration.h \
     src/comm/LinkInterface.h \
     src/comm/LinkManager.h \
+    src/comm/LinkReadStatistics.h \
+    src/comm/LinkTrafficStatistics.h \
     src/comm/LogReplayLink.h \
+    src/comm/ReplayClock.h \
+    src/comm/MAVLinkFieldDecoder.h \
+    src/comm/MAVLinkForwarder.h \
+    src/comm/MAVLinkFramer.h \
+    src/comm/MAVLinkMessageDispatcher.h \
+    src/comm/MAVLinkMessageStatistics.h \
+    src/comm/MAVLinkLogWriter.h \
+    src/comm/QGCByteRingBuffer.h \
+    src/comm/QGCPacketQueue.h \
     src/comm/MAVLinkProtocol.h \
     src/comm/QGCMAVLink.h \
     src/comm/TCPLink.h \
+    src/comm/TelemetryStreamServer.h \
+    src/comm/TlogIndex.h \
     src/comm/UDPLink.h \
     src/comm/UdpIODevice.h \
     src/uas/UAS.h \
@@ -733,6 +1000,7 @@ DebugBuild {
 HEADERS += \
     src/comm/MockLink.h \
     src/comm/MockLinkFTP.h \
+    src/comm/MockLinkLoadGenerator.h \
     src/comm/MockLinkMissionItemHandler.h \
 }
 
@@ -771,10 +1039,13 @@ HEADERS += \
     src/GPS/GPSManager.h \
     src/GPS/GPSPositionMessage.h \
     src/GPS/GPSProvider.h \
+    src/GPS/NTRIPTCPLink.h \
     src/GPS/RTCM/RTCMMavlink.h \
+    src/GPS/RTCM/RTCMParser.h \
     src/GPS/definitions.h \
     src/GPS/satellite_info.h \
     src/GPS/vehicle_gps_position.h \
+    src/AnalyzeView/TlogAnalyzeRunner.h \
     src/Joystick/JoystickSDL.h \
     src/RunGuard.h \
 }
@@ -790,23 +1061,40 @@ AndroidBuild {
 }
 
 SOURCES += \
+    src/ADSB/ADSBParser.cc \
+    src/ADSB/ADSBTargetModel.cc \
     src/ADSB/ADSBVehicle.cc \
     src/ADSB/ADSBVehicleManager.cc \
+    src/ADSB/TrafficConflictEngine.cc \
     src/AnalyzeView/LogDownloadController.cc \
+    src/AnalyzeView/LogIndexController.cc \
+    src/AnalyzeView/LogIndexer.cc \
+    src/AnalyzeView/LogIndexManager.cc \
+    src/AnalyzeView/MAVLinkChartBuffer.cc \
     src/AnalyzeView/PX4LogParser.cc \
+    src/AnalyzeView/TlogAnalyzer.cc \
     src/AnalyzeView/ULogParser.cc \
+    src/AnalyzeView/ULogReader.cc \
+    src/AnalyzeView/MavlinkConsoleBuffer.cc \
     src/AnalyzeView/MavlinkConsoleController.cc \
+    src/AnalyzeView/VibrationAnalyzer.cc \
+    src/AnalyzeView/VibrationController.cc \
+    src/AnalyzeView/VibrationSpectrum.cc \
     src/Audio/AudioOutput.cc \
+    src/Audio/AudioOutputQueue.cc \
     src/Camera/QGCCameraControl.cc \
+    src/Camera/QGCCameraDefinition.cc \
     src/Camera/QGCCameraIO.cc \
+    src/Camera/QGCCameraMedia.cc \
     src/Camera/QGCCameraManager.cc \
     src/CmdLineOptParser.cc \
     src/FollowMe/FollowMe.cc \
+    src/FollowMe/FollowMeMotionEstimator.cc \
     src/Joystick/Joystick.cc \
     src/Joystick/JoystickManager.cc \
     src/JsonHelper.cc \
-    src/KMLDomDocument.cc \
     src/KMLHelper.cc \
+    src/KMLStreamWriter.cc \
     src/LogCompressor.cc \
     src/MissionManager/CameraCalc.cc \
     src/MissionManager/CameraSection.cc \
@@ -816,9 +1104,10 @@ SOURCES += \
     src/MissionManager/CorridorScanPlanCreator.cc \
     src/MissionManager/BlankPlanCreator.cc \
     src/MissionManager/FixedWingLandingComplexItem.cc \
+    src/MissionManager/FlightPathLOD.cc \
     src/MissionManager/GeoFenceController.cc \
     src/MissionManager/GeoFenceManager.cc \
-    src/MissionManager/KMLPlanDomDocument.cc \
+    src/MissionManager/KMLPlanDocument.cc \
     src/MissionManager/LandingComplexItem.cc \
     src/MissionManager/MissionCommandList.cc \
     src/MissionManager/MissionCommandTree.cc \
@@ -831,10 +1120,12 @@ SOURCES += \
     src/MissionManager/PlanCreator.cc \
     src/MissionManager/PlanManager.cc \
     src/MissionManager/PlanMasterController.cc \
+    src/MissionManager/PlanUndoStack.cc \
     src/MissionManager/QGCFenceCircle.cc \
     src/MissionManager/QGCFencePolygon.cc \
     src/MissionManager/QGCMapCircle.cc \
     src/MissionManager/QGCMapPolygon.cc \
+    src/MissionManager/QGCPolygonIndex.cc \
     src/MissionManager/QGCMapPolyline.cc \
     src/MissionManager/RallyPoint.cc \
     src/MissionManager/RallyPointController.cc \
@@ -847,8 +1138,11 @@ SOURCES += \
     src/MissionManager/SurveyPlanCreator.cc \
     src/MissionManager/TakeoffMissionItem.cc \
     src/MissionManager/TransectStyleComplexItem.cc \
+    src/MissionManager/VisualItemsViewportModel.cc \
     src/MissionManager/VisualMissionItem.cc \
     src/MissionManager/VTOLLandingComplexItem.cc \
+    src/PositionManager/NmeaParser.cc \
+    src/PositionManager/NmeaPositionSource.cc \
     src/PositionManager/PositionManager.cpp \
     src/PositionManager/SimulatedPosition.cc \
     src/Geo/QGCGeo.cc \
@@ -864,9 +1158,15 @@ SOURCES += \
     src/QGCFileDownload.cc \
     src/QGCLoggingCategory.cc \
     src/QGCMapPalette.cc \
+    src/QGCMemoryAccounting.cc \
     src/QGCPalette.cc \
     src/QGCQGeoCoordinate.cc \
     src/QGCTemporaryFile.cc \
+    src/QGCNetworkService.cc \
+    src/QGCPowerManager.cc \
+    src/QGCResourceBundles.cc \
+    src/QGCTimerWheel.cc \
+    src/QGCTrace.cc \
     src/QGCToolbox.cc \
     src/QGCZlib.cc \
     src/QmlControls/AppMessages.cc \
@@ -876,17 +1176,21 @@ SOURCES += \
     src/QmlControls/InstrumentValueData.cc \
     src/QmlControls/FactValueGrid.cc \
     src/QmlControls/ParameterEditorController.cc \
+    src/QmlControls/ParameterSearchIndex.cc \
     src/QmlControls/QGCFileDialogController.cc \
     src/QmlControls/QGCImageProvider.cc \
     src/QmlControls/QGroundControlQmlGlobal.cc \
     src/QmlControls/QmlObjectListModel.cc \
     src/QmlControls/QGCGeoBoundingCube.cc \
     src/QmlControls/RCChannelMonitorController.cc \
+    src/QmlControls/RCChannelThrottle.cc \
     src/QmlControls/RCToParamDialogController.cc \
     src/QmlControls/ScreenToolsController.cc \
+    src/QmlControls/ObstacleDistanceItem.cc \
     src/QmlControls/TerrainProfile.cc \
     src/QmlControls/ToolStripAction.cc \
     src/QmlControls/ToolStripActionList.cc \
+    src/QmlControls/VehicleMarkerLayer.cc \
     src/QtLocationPlugin/QMLControl/QGCMapEngineManager.cc \
     src/Settings/ADSBVehicleManagerSettings.cc \
     src/Settings/AppSettings.cc \
@@ -904,6 +1208,7 @@ SOURCES += \
     src/Settings/VideoSettings.cc \
     src/ShapeFileHelper.cc \
     src/SHPFileHelper.cc \
+    src/Terrain/TerrainLocalDEM.cc \
     src/Terrain/TerrainQuery.cc \
     src/TerrainTile.cc\
     src/Vehicle/CompInfo.cc \
@@ -914,15 +1219,24 @@ SOURCES += \
     src/Vehicle/GPSRTKFactGroup.cc \
     src/Vehicle/InitialConnectStateMachine.cc \
     src/Vehicle/MAVLinkLogManager.cc \
+    src/Vehicle/MAVLinkLogUploader.cc \
+    src/Vehicle/MAVLinkULogWriter.cc \
+    src/Vehicle/MessageDuplicateFilter.cc \
+    src/Vehicle/MessageRateManager.cc \
     src/Vehicle/MultiVehicleManager.cc \
     src/Vehicle/StateMachine.cc \
+    src/Vehicle/StatusTextHandler.cc \
     src/Vehicle/SysStatusSensorInfo.cc \
+    src/Vehicle/TelemetryRecorder.cc \
     src/Vehicle/TerrainFactGroup.cc \
     src/Vehicle/TerrainProtocolHandler.cc \
+    src/Vehicle/ObstacleDistanceBuffer.cc \
+    src/Vehicle/TrajectoryBuffer.cc \
     src/Vehicle/TrajectoryPoints.cc \
     src/Vehicle/Vehicle.cc \
     src/Vehicle/VehicleObjectAvoidance.cc \
     src/Vehicle/VehicleBatteryFactGroup.cc \
+    src/Vehicle/VehicleBatteryStatusModel.cc \
     src/Vehicle/VehicleClockFactGroup.cc \
     src/Vehicle/VehicleDistanceSensorFactGroup.cc \
     src/Vehicle/VehicleEstimatorStatusFactGroup.cc \
@@ -936,10 +1250,23 @@ SOURCES += \
     src/comm/LinkConfiguration.cc \
     src/comm/LinkInterface.cc \
     src/comm/LinkManager.cc \
+    src/comm/LinkReadStatistics.cc \
+    src/comm/LinkTrafficStatistics.cc \
     src/comm/LogReplayLink.cc \
+    src/comm/ReplayClock.cc \
+    src/comm/MAVLinkFieldDecoder.cc \
+    src/comm/MAVLinkForwarder.cc \
+    src/comm/MAVLinkFramer.cc \
+    src/comm/MAVLinkMessageDispatcher.cc \
+    src/comm/MAVLinkMessageStatistics.cc \
+    src/comm/MAVLinkLogWriter.cc \
+    src/comm/QGCByteRingBuffer.cc \
+    src/comm/QGCPacketQueue.cc \
     src/comm/MAVLinkProtocol.cc \
     src/comm/QGCMAVLink.cc \
     src/comm/TCPLink.cc \
+    src/comm/TelemetryStreamServer.cc \
+    src/comm/TlogIndex.cc \
     src/comm/UDPLink.cc \
     src/comm/UdpIODevice.cc \
     src/main.cc \
@@ -957,6 +1284,7 @@ DebugBuild {
 SOURCES += \
     src/comm/MockLink.cc \
     src/comm/MockLinkFTP.cc \
+    src/comm/MockLinkLoadGenerator.cc \
     src/comm/MockLinkMissionItemHandler.cc \
 }
 
@@ -987,7 +1315,10 @@ SOURCES += \
     src/GPS/Drivers/src/sbf.cpp \
     src/GPS/GPSManager.cc \
     src/GPS/GPSProvider.cc \
+    src/GPS/NTRIPTCPLink.cc \
     src/GPS/RTCM/RTCMMavlink.cc \
+    src/GPS/RTCM/RTCMParser.cc \
+    src/AnalyzeView/TlogAnalyzeRunner.cc \
     src/Joystick/JoystickSDL.cc \
     src/RunGuard.cc \
 }
@@ -1018,6 +1349,8 @@ HEADERS+= \
 !MobileBuild { !NoSerialBuild {
     HEADERS += \
         src/VehicleSetup/Bootloader.h \
+        src/VehicleSetup/FirmwareBatchFlasher.h \
+        src/VehicleSetup/FirmwareDownloadCache.h \
         src/VehicleSetup/FirmwareImage.h \
         src/VehicleSetup/FirmwareUpgradeController.h \
         src/VehicleSetup/PX4FirmwareUpgradeThread.h \
@@ -1040,6 +1373,8 @@ SOURCES += \
 !MobileBuild { !NoSerialBuild {
     SOURCES += \
         src/VehicleSetup/Bootloader.cc \
+        src/VehicleSetup/FirmwareBatchFlasher.cc \
+        src/VehicleSetup/FirmwareDownloadCache.cc \
         src/VehicleSetup/FirmwareImage.cc \
         src/VehicleSetup/FirmwareUpgradeController.cc \
         src/VehicleSetup/PX4FirmwareUpgradeThread.cc \
@@ -1058,7 +1393,11 @@ ArdupilotEnabled {
 # ArduPilot FirmwarePlugin
 
 APMFirmwarePlugin {
-    RESOURCES *= src/FirmwarePlugin/APM/APMResources.qrc
+    LazyResources {
+        RESOURCE_BUNDLES *= src/FirmwarePlugin/APM/APMResources.qrc
+    } else {
+        RESOURCES *= src/FirmwarePlugin/APM/APMResources.qrc
+    }
 
     INCLUDEPATH += \
         src/AutoPilotPlugins/APM \
@@ -1085,6 +1424,7 @@ APMFirmwarePlugin {
         src/AutoPilotPlugins/APM/APMSensorsComponentController.h \
         src/AutoPilotPlugins/APM/APMSubMotorComponentController.h \
         src/AutoPilotPlugins/APM/APMTuningComponent.h \
+        src/AutoPilotPlugins/APM/CompassSphereFit.h \
         src/FirmwarePlugin/APM/APMFirmwarePlugin.h \
         src/FirmwarePlugin/APM/APMParameterMetaData.h \
         src/FirmwarePlugin/APM/ArduCopterFirmwarePlugin.h \
@@ -1113,6 +1453,7 @@ APMFirmwarePlugin {
         src/AutoPilotPlugins/APM/APMSensorsComponentController.cc \
         src/AutoPilotPlugins/APM/APMSubMotorComponentController.cc \
         src/AutoPilotPlugins/APM/APMTuningComponent.cc \
+        src/AutoPilotPlugins/APM/CompassSphereFit.cc \
         src/FirmwarePlugin/APM/APMFirmwarePlugin.cc \
         src/FirmwarePlugin/APM/APMParameterMetaData.cc \
         src/FirmwarePlugin/APM/ArduCopterFirmwarePlugin.cc \
@@ -1129,7 +1470,11 @@ APMFirmwarePluginFactory {
 # PX4 FirmwarePlugin
 
 PX4FirmwarePlugin {
-    RESOURCES *= src/FirmwarePlugin/PX4/PX4Resources.qrc
+    LazyResources {
+        RESOURCE_BUNDLES *= src/FirmwarePlugin/PX4/PX4Resources.qrc
+    } else {
+        RESOURCES *= src/FirmwarePlugin/PX4/PX4Resources.qrc
+    }
 
     INCLUDEPATH += \
         src/AutoPilotPlugins/PX4 \
@@ -1181,6 +1526,29 @@ PX4FirmwarePluginFactory {
     SOURCES   += src/FirmwarePlugin/PX4/PX4FirmwarePluginFactory.cc
 }
 
+# Resource bundles, each .qrc becomes bundles/<name>.rcc next to the executable
+
+LazyResources {
+    RESOURCE_BUNDLE_DIR = $$OUT_PWD/$$DESTDIR/bundles
+
+    resource_bundle.input           = RESOURCE_BUNDLES
+    resource_bundle.output          = $$RESOURCE_BUNDLE_DIR/${QMAKE_FILE_BASE}.rcc
+    resource_bundle.commands        = $$sprintf($$QMAKE_MKDIR_CMD, $$shell_path($$RESOURCE_BUNDLE_DIR)) $$escape_expand(\\n\\t)
+    resource_bundle.commands       += $$shell_path($$[QT_HOST_BINS]/rcc) -binary ${QMAKE_FILE_IN} -o ${QMAKE_FILE_OUT}
+    resource_bundle.depend_command  = $$shell_path($$[QT_HOST_BINS]/rcc) -list ${QMAKE_FILE_IN}
+    resource_bundle.CONFIG         += no_link target_predeps
+    QMAKE_EXTRA_COMPILERS          += resource_bundle
+
+    AndroidBuild {
+        for (bundle, RESOURCE_BUNDLES) {
+            resource_bundle_assets.files += $$RESOURCE_BUNDLE_DIR/$$basename($$replace(bundle, \.qrc$, .rcc))
+        }
+        resource_bundle_assets.path     = /assets/bundles
+        resource_bundle_assets.CONFIG  += no_check_exist
+        INSTALLS                       += resource_bundle_assets
+    }
+}
+
 # Fact System code
 
 INCLUDEPATH += \
@@ -1191,21 +1559,28 @@ HEADERS += \
     src/FactSystem/Fact.h \
     src/FactSystem/FactControls/FactPanelController.h \
     src/FactSystem/FactGroup.h \
+    src/FactSystem/FactHistory.h \
     src/FactSystem/FactMetaData.h \
+    src/FactSystem/FactMetaDataStore.h \
+    src/FactSystem/FactValueCache.h \
     src/FactSystem/FactSystem.h \
     src/FactSystem/FactValueSliderListModel.h \
     src/FactSystem/ParameterManager.h \
     src/FactSystem/SettingsFact.h \
+    src/FactSystem/SettingsStore.h \
 
 SOURCES += \
     src/FactSystem/Fact.cc \
     src/FactSystem/FactControls/FactPanelController.cc \
     src/FactSystem/FactGroup.cc \
+    src/FactSystem/FactHistory.cc \
     src/FactSystem/FactMetaData.cc \
+    src/FactSystem/FactMetaDataStore.cc \
     src/FactSystem/FactSystem.cc \
     src/FactSystem/FactValueSliderListModel.cc \
     src/FactSystem/ParameterManager.cc \
     src/FactSystem/SettingsFact.cc \
+    src/FactSystem/SettingsStore.cc \
 
 #-------------------------------------------------------------------------------------
 # MAVLink Inspector
@@ -1284,6 +1659,7 @@ contains (DEFINES, QGC_AIRMAP_ENABLED) {
     HEADERS += \
         src/AirspaceManagement/AirspaceAdvisoryProvider.h \
         src/AirspaceManagement/AirspaceFlightPlanProvider.h \
+        src/AirspaceManagement/AirspaceGeometryCache.h \
         src/AirspaceManagement/AirspaceManager.h \
         src/AirspaceManagement/AirspaceRestriction.h \
         src/AirspaceManagement/AirspaceRestrictionProvider.h \
@@ -1294,6 +1670,7 @@ contains (DEFINES, QGC_AIRMAP_ENABLED) {
     SOURCES += \
         src/AirspaceManagement/AirspaceAdvisoryProvider.cc \
         src/AirspaceManagement/AirspaceFlightPlanProvider.cc \
+        src/AirspaceManagement/AirspaceGeometryCache.cc \
         src/AirspaceManagement/AirspaceManager.cc \
         src/AirspaceManagement/AirspaceRestriction.cc \
         src/AirspaceManagement/AirspaceRestrictionProvider.cc \
@@ -1301,6 +1678,14 @@ contains (DEFINES, QGC_AIRMAP_ENABLED) {
         src/AirspaceManagement/AirspaceVehicleManager.cc \
         src/AirspaceManagement/AirspaceWeatherInfoProvider.cc \
 
+    contains (DEFINES, UNITTEST_BUILD) {
+        HEADERS += \
+            src/AirspaceManagement/AirspaceGeometryCacheTest.h \
+
+        SOURCES += \
+            src/AirspaceManagement/AirspaceGeometryCacheTest.cc \
+    }
+
     #-- This is the AirMap implementation of the above
     RESOURCES += \
         src/Airmap/airmap.qrc
@@ -1318,6 +1703,7 @@ contains (DEFINES, QGC_AIRMAP_ENABLED) {
         src/Airmap/AirMapSettings.h \
         src/Airmap/AirMapSharedState.h \
         src/Airmap/AirMapTelemetry.h \
+        src/Airmap/AirMapTelemetryShaper.h \
         src/Airmap/AirMapTrafficMonitor.h \
         src/Airmap/AirMapVehicleManager.h \
         src/Airmap/AirMapWeatherInfoManager.h \
@@ -1333,10 +1719,19 @@ contains (DEFINES, QGC_AIRMAP_ENABLED) {
         src/Airmap/AirMapSettings.cc \
         src/Airmap/AirMapSharedState.cc \
         src/Airmap/AirMapTelemetry.cc \
+        src/Airmap/AirMapTelemetryShaper.cc \
         src/Airmap/AirMapTrafficMonitor.cc \
         src/Airmap/AirMapVehicleManager.cc \
         src/Airmap/AirMapWeatherInfoManager.cc \
 
+    contains (DEFINES, UNITTEST_BUILD) {
+        HEADERS += \
+            src/Airmap/AirMapTelemetryShaperTest.h \
+
+        SOURCES += \
+            src/Airmap/AirMapTelemetryShaperTest.cc \
+    }
+
     #-- Do we have an API key?
     exists(src/Airmap/Airmap_api_key.h) {
         message("Using compile time Airmap API key")
@@ -1367,11 +1762,17 @@ INCLUDEPATH += \
 
 HEADERS += \
     src/VideoManager/SubtitleWriter.h \
-    src/VideoManager/VideoManager.h
+    src/VideoManager/VideoKeyframeIndex.h \
+    src/VideoManager/VideoManager.h \
+    src/VideoManager/VideoReplay.h \
+    src/VideoManager/VideoStreamPool.h
 
 SOURCES += \
     src/VideoManager/SubtitleWriter.cc \
-    src/VideoManager/VideoManager.cc
+    src/VideoManager/VideoKeyframeIndex.cc \
+    src/VideoManager/VideoManager.cc \
+    src/VideoManager/VideoReplay.cc \
+    src/VideoManager/VideoStreamPool.cc
 
 contains (CONFIG, DISABLE_VIDEOSTREAMING) {
     message("Skipping support for video streaming (manual override from command line)")
@@ -1388,10 +1789,12 @@ contains (CONFIG, DISABLE_VIDEOSTREAMING) {
 
     HEADERS += \
         src/VideoManager/GLVideoItemStub.h \
-        src/VideoReceiver/VideoReceiver.h
+        src/VideoReceiver/VideoReceiver.h \
+        src/VideoReceiver/VideoStreamFeed.h
 
     SOURCES += \
-        src/VideoManager/GLVideoItemStub.cc
+        src/VideoManager/GLVideoItemStub.cc \
+        src/VideoReceiver/VideoStreamFeed.cc
 }
 
 #-------------------------------------------------------------------------------------
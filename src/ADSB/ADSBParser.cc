@@ -0,0 +1,584 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ADSBParser.h"
+
+#include <QtMath>
+
+#include <string.h>
+
+static const char kBeastEscape = 0x1a;
+
+static int _hexDigit(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/// Field parsers work on [begin, end) of the receive buffer
+static bool _parseUInt(const char* begin, const char* end, int base, uint32_t& value)
+{
+    if (begin == end) {
+        return false;
+    }
+
+    value = 0;
+    for (const char* p = begin; p < end; p++) {
+        const int digit = _hexDigit(*p);
+        if (digit < 0 || digit >= base) {
+            return false;
+        }
+        value = value * static_cast<uint32_t>(base) + static_cast<uint32_t>(digit);
+    }
+
+    return true;
+}
+
+static bool _parseInt(const char* begin, const char* end, int& value)
+{
+    const bool  negative = begin != end && *begin == '-';
+    uint32_t    magnitude;
+
+    if (!_parseUInt(negative ? begin + 1 : begin, end, 10, magnitude)) {
+        return false;
+    }
+    value = negative ? -static_cast<int>(magnitude) : static_cast<int>(magnitude);
+
+    return true;
+}
+
+/// Plain decimals only, which is all SBS-1 sends. Independent of the locale unlike strtod.
+static bool _parseDouble(const char* begin, const char* end, double& value)
+{
+    const char* p           = begin;
+    bool        negative    = false;
+    bool        digits      = false;
+    double      integer     = 0;
+    double      fraction    = 0;
+    double      scale       = 1;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+        integer = integer * 10 + (*p - '0');
+        digits = true;
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++) {
+            fraction = fraction * 10 + (*p - '0');
+            scale *= 10;
+            digits = true;
+        }
+    }
+    if (!digits || p != end) {
+        return false;
+    }
+    value = integer + fraction / scale;
+    if (negative) {
+        value = -value;
+    }
+
+    return true;
+}
+
+/// Mode S frame length from the Beast message type, -1 for unknown type
+static int _beastFrameLength(char type)
+{
+    switch (type) {
+    case '1':
+        return 2;   // Mode A/C
+    case '2':
+        return 7;   // Mode S short
+    case '3':
+        return 14;  // Mode S long
+    default:
+        return -1;
+    }
+}
+
+ADSBParser::ADSBParser(void)
+{
+
+}
+
+int ADSBParser::parse(const char* data, int length, qint64 nowMsecs, QHash<uint32_t, ADSBVehicle::VehicleInfo_t>& updates)
+{
+    int pos = 0;
+
+    _pruneCpr(nowMsecs);
+
+    while (pos < length) {
+        if (data[pos] == kBeastEscape) {
+            const int used = _parseBeast(data + pos, length - pos, nowMsecs, updates);
+            if (used == 0) {
+                break;
+            }
+            pos += used;
+            continue;
+        }
+
+        const char* lineStart   = data + pos;
+        const char* lineEnd     = static_cast<const char*>(memchr(lineStart, '\n', static_cast<size_t>(length - pos)));
+        const char* escape      = static_cast<const char*>(memchr(lineStart, kBeastEscape, static_cast<size_t>((lineEnd ? lineEnd : data + length) - lineStart)));
+        if (escape) {
+            // Rest of a Beast message we could not sync to, resync on the next one
+            pos += static_cast<int>(escape - lineStart);
+            continue;
+        }
+        if (!lineEnd) {
+            if (length - pos > _maxLineLength) {
+                // Not a feed we understand, don't let it pile up
+                pos = length;
+            }
+            break;
+        }
+        pos += static_cast<int>(lineEnd - lineStart) + 1;
+
+        int lineLength = static_cast<int>(lineEnd - lineStart);
+        if (lineLength > 0 && lineStart[lineLength - 1] == '\r') {
+            lineLength--;
+        }
+
+        ADSBVehicle::VehicleInfo_t vehicleInfo;
+        if (lineLength > 0 && (lineStart[0] == '*' || lineStart[0] == '@' || lineStart[0] == ':')) {
+            if (_parseAVR(lineStart, lineLength, nowMsecs, vehicleInfo)) {
+                _merge(updates, vehicleInfo);
+            }
+        } else if (parseSBS(lineStart, lineLength, vehicleInfo)) {
+            _merge(updates, vehicleInfo);
+        }
+    }
+
+    return pos;
+}
+
+bool ADSBParser::parseSBS(const char* line, int length, ADSBVehicle::VehicleInfo_t& vehicleInfo)
+{
+    typedef struct {
+        const char* begin;
+        const char* end;
+    } Field_t;
+
+    static const int    kFieldCount = 16;
+    Field_t             fields[kFieldCount];
+    int                 fieldCount  = 0;
+    const char*         end         = line + length;
+    const char*         fieldStart  = line;
+
+    if (length < 3 || strncmp(line, "MSG", 3) != 0) {
+        return false;
+    }
+
+    // Views into the line, only the fields used are looked at
+    for (const char* p = line; p <= end && fieldCount < kFieldCount; p++) {
+        if (p == end || *p == ',') {
+            fields[fieldCount].begin    = fieldStart;
+            fields[fieldCount].end      = p;
+            fieldCount++;
+            fieldStart = p + 1;
+        }
+    }
+    if (fieldCount < kFieldCount) {
+        return false;
+    }
+
+    auto fieldBegin = [&fields](int index) { return fields[index].begin; };
+    auto fieldEnd   = [&fields](int index) { return fields[index].end; };
+
+    if (fieldEnd(1) - fieldBegin(1) != 1) {
+        return false;
+    }
+    const char messageType = *fieldBegin(1);
+
+    if (messageType != '1' && messageType != '3' && messageType != '4') {
+        return false;
+    }
+
+    uint32_t icaoAddress;
+    if (!_parseUInt(fieldBegin(4), fieldEnd(4), 16, icaoAddress)) {
+        return false;
+    }
+    vehicleInfo.icaoAddress = icaoAddress;
+
+    // Callsign is often left empty, don't let that clear the one from an earlier message
+    QString callsign;
+    if (fieldEnd(10) != fieldBegin(10)) {
+        callsign = QString::fromLatin1(fieldBegin(10), static_cast<int>(fieldEnd(10) - fieldBegin(10))).trimmed();
+    }
+
+    if (messageType == '3') {
+        int     modeCAltitude;
+        double  lat, lon;
+
+        if (!_parseInt(fieldBegin(11), fieldEnd(11), modeCAltitude) ||
+                !_parseDouble(fieldBegin(14), fieldEnd(14), lat) ||
+                !_parseDouble(fieldBegin(15), fieldEnd(15), lon)) {
+            return false;
+        }
+        if (lat == 0 && lon == 0) {
+            return false;
+        }
+
+        vehicleInfo.location = QGeoCoordinate(lat, lon);
+        vehicleInfo.altitude = modeCAltitude * 0.3048;
+        vehicleInfo.availableFlags = ADSBVehicle::LocationAvailable | ADSBVehicle::AltitudeAvailable;
+        if (!callsign.isEmpty()) {
+            vehicleInfo.callsign = callsign;
+            vehicleInfo.availableFlags |= ADSBVehicle::CallsignAvailable;
+        }
+        return true;
+    } else if (messageType == '4') {
+        double heading;
+
+        if (!_parseDouble(fieldBegin(13), fieldEnd(13), heading)) {
+            return false;
+        }
+
+        vehicleInfo.heading = heading;
+        vehicleInfo.availableFlags = ADSBVehicle::HeadingAvailable;
+
+        double groundSpeed;
+        if (_parseDouble(fieldBegin(12), fieldEnd(12), groundSpeed)) {
+            vehicleInfo.velocity = groundSpeed * _knotsToMetersPerSecond;
+            vehicleInfo.availableFlags |= ADSBVehicle::VelocityAvailable;
+        }
+        return true;
+    } else {
+        if (callsign.isEmpty()) {
+            return false;
+        }
+
+        vehicleInfo.callsign = callsign;
+        vehicleInfo.availableFlags = ADSBVehicle::CallsignAvailable;
+        return true;
+    }
+}
+
+bool ADSBParser::_parseAVR(const char* line, int length, qint64 nowMsecs, ADSBVehicle::VehicleInfo_t& vehicleInfo)
+{
+    // "*<frame>;", "@<48 bit timestamp><frame>;" or ":" with the same
+    const char* p   = line + 1;
+    const char* end = line + length;
+
+    if (line[0] == '@') {
+        p += 12;
+    }
+    while (end > p && (end[-1] == ';' || end[-1] == ' ')) {
+        end--;
+    }
+
+    const int hexLength = static_cast<int>(end - p);
+    if (hexLength <= 0 || hexLength % 2 != 0 || hexLength > 28) {
+        return false;
+    }
+
+    quint8 frame[14];
+    for (int i=0; i<hexLength / 2; i++) {
+        const int high  = _hexDigit(p[i * 2]);
+        const int low   = _hexDigit(p[i * 2 + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        frame[i] = static_cast<quint8>((high << 4) | low);
+    }
+
+    return parseModeS(frame, hexLength / 2, nowMsecs, vehicleInfo);
+}
+
+int ADSBParser::_parseBeast(const char* data, int length, qint64 nowMsecs, QHash<uint32_t, ADSBVehicle::VehicleInfo_t>& updates)
+{
+    // <esc> <type> <6 byte timestamp> <1 byte signal> <frame>, with <esc> in the rest doubled
+    if (length < 2) {
+        return 0;
+    }
+
+    const int frameLength = _beastFrameLength(data[1]);
+    if (frameLength < 0) {
+        // Lost sync or a message type without a frame, skip to the next <esc>
+        return 1;
+    }
+
+    const int   payloadLength = 7 + frameLength;
+    quint8      payload[7 + 14];
+    int         payloadCount = 0;
+    int         pos = 2;
+
+    while (payloadCount < payloadLength) {
+        if (pos >= length) {
+            return 0;
+        }
+        if (data[pos] == kBeastEscape) {
+            if (pos + 1 >= length) {
+                return 0;
+            }
+            if (data[pos + 1] != kBeastEscape) {
+                // Start of the next message, this one was cut short
+                return pos;
+            }
+            pos++;
+        }
+        payload[payloadCount++] = static_cast<quint8>(data[pos++]);
+    }
+
+    ADSBVehicle::VehicleInfo_t vehicleInfo;
+    if (parseModeS(payload + 7, frameLength, nowMsecs, vehicleInfo)) {
+        _merge(updates, vehicleInfo);
+    }
+
+    return pos;
+}
+
+uint32_t ADSBParser::modeSCrc(const quint8* frame, int length)
+{
+    uint32_t remainder = 0;
+
+    for (int i=0; i<length - 3; i++) {
+        remainder ^= static_cast<uint32_t>(frame[i]) << 16;
+        for (int bit=0; bit<8; bit++) {
+            remainder = (remainder & 0x800000) ? ((remainder << 1) ^ 0xFFF409) : (remainder << 1);
+        }
+        remainder &= 0xFFFFFF;
+    }
+
+    const uint32_t parity = (static_cast<uint32_t>(frame[length - 3]) << 16) | (static_cast<uint32_t>(frame[length - 2]) << 8) | frame[length - 1];
+
+    return remainder ^ parity;
+}
+
+bool ADSBParser::parseModeS(const quint8* frame, int length, qint64 nowMsecs, ADSBVehicle::VehicleInfo_t& vehicleInfo)
+{
+    // Only extended squitters carry identification/position/velocity
+    if (length != 14) {
+        return false;
+    }
+
+    const int df = frame[0] >> 3;
+    if (df != 17 && (df != 18 || (frame[0] & 0x07) != 0)) {
+        return false;
+    }
+    if (modeSCrc(frame, length) != 0) {
+        return false;
+    }
+
+    const uint32_t icaoAddress = (static_cast<uint32_t>(frame[1]) << 16) | (static_cast<uint32_t>(frame[2]) << 8) | frame[3];
+
+    // 56 bit ME field, bit 1 of the spec in bit 55
+    quint64 me = 0;
+    for (int i=4; i<11; i++) {
+        me = (me << 8) | frame[i];
+    }
+    const int typeCode = static_cast<int>(me >> 51);
+
+    vehicleInfo.icaoAddress = icaoAddress;
+
+    if (typeCode >= 1 && typeCode <= 4) {
+        static const char kCharset[] = "?ABCDEFGHIJKLMNOPQRSTUVWXYZ????? ???????????????0123456789??????";
+
+        char callsign[8];
+        int  count = 0;
+        for (int i=0; i<8; i++) {
+            const char c = kCharset[(me >> (42 - 6 * i)) & 0x3F];
+            if (c != '?') {
+                callsign[count++] = c;
+            }
+        }
+        vehicleInfo.callsign = QString::fromLatin1(callsign, count).trimmed();
+        vehicleInfo.availableFlags = ADSBVehicle::CallsignAvailable;
+        return !vehicleInfo.callsign.isEmpty();
+    } else if (typeCode >= 9 && typeCode <= 18) {
+        // Airborne position with barometric altitude
+        const uint32_t  altitudeCode    = static_cast<uint32_t>((me >> 36) & 0xFFF);
+        const int       oddFrame        = static_cast<int>((me >> 34) & 1);
+
+        vehicleInfo.availableFlags = 0;
+        if (altitudeCode & 0x10) {
+            // 25 ft steps, Gillham coded 100 ft steps are not decoded
+            const uint32_t n = ((altitudeCode & 0xFE0) >> 1) | (altitudeCode & 0x0F);
+            vehicleInfo.altitude = (static_cast<int>(n) * 25 - 1000) * 0.3048;
+            vehicleInfo.availableFlags |= ADSBVehicle::AltitudeAvailable;
+        }
+
+        auto it = _cprStates.find(icaoAddress);
+        if (it == _cprStates.end()) {
+            CprState_t newState = { { 0, 0 }, { 0, 0 }, { -1, -1 } };
+            it = _cprStates.insert(icaoAddress, newState);
+        }
+
+        CprState_t& state = it.value();
+        state.latCpr[oddFrame]      = static_cast<uint32_t>((me >> 17) & 0x1FFFF);
+        state.lonCpr[oddFrame]      = static_cast<uint32_t>(me & 0x1FFFF);
+        state.timeMsecs[oddFrame]   = nowMsecs;
+
+        const qint64 otherTime = state.timeMsecs[1 - oddFrame];
+        if (otherTime >= 0 && nowMsecs - otherTime <= _cprMaxAgeMsecs) {
+            QGeoCoordinate location;
+            if (_decodeCpr(state, oddFrame, location)) {
+                vehicleInfo.location = location;
+                vehicleInfo.availableFlags |= ADSBVehicle::LocationAvailable;
+            }
+        }
+        return vehicleInfo.availableFlags != 0;
+    } else if (typeCode == 19) {
+        // Airborne velocity, only ground speed subtypes have a track
+        const int subType = static_cast<int>((me >> 48) & 0x07);
+        if (subType != 1 && subType != 2) {
+            return false;
+        }
+
+        const int eastWest      = static_cast<int>((me >> 32) & 0x3FF);
+        const int northSouth    = static_cast<int>((me >> 21) & 0x3FF);
+        if (eastWest == 0 || northSouth == 0) {
+            return false;
+        }
+
+        const double vx = ((me >> 42) & 1) ? -(eastWest - 1) : (eastWest - 1);
+        const double vy = ((me >> 31) & 1) ? -(northSouth - 1) : (northSouth - 1);
+        double heading = qRadiansToDegrees(qAtan2(vx, vy));
+        if (heading < 0) {
+            heading += 360;
+        }
+
+        // Supersonic subtype is in 4 knot steps
+        vehicleInfo.heading = heading;
+        vehicleInfo.velocity = qSqrt(vx * vx + vy * vy) * (subType == 2 ? 4 : 1) * _knotsToMetersPerSecond;
+        vehicleInfo.availableFlags = ADSBVehicle::HeadingAvailable | ADSBVehicle::VelocityAvailable;
+        return true;
+    }
+
+    return false;
+}
+
+int ADSBParser::_cprNL(double latitude)
+{
+    latitude = qAbs(latitude);
+    if (latitude == 0) {
+        return 59;
+    } else if (latitude == 87) {
+        return 2;
+    } else if (latitude > 87) {
+        return 1;
+    }
+
+    const double a = 1 - qCos(M_PI / (2 * 15));
+    const double b = qCos(M_PI / 180 * latitude);
+
+    return static_cast<int>(qFloor(2 * M_PI / qAcos(1 - a / (b * b))));
+}
+
+bool ADSBParser::_decodeCpr(const CprState_t& state, int newest, QGeoCoordinate& location)
+{
+    // Globally unambiguous decoding from an even and an odd frame
+    static const double kCprMax = 131072;   // 2^17
+
+    auto mod = [](double a, double b) { return a - b * qFloor(a / b); };
+
+    const double latEven    = state.latCpr[0] / kCprMax;
+    const double latOdd     = state.latCpr[1] / kCprMax;
+    const double lonEven    = state.lonCpr[0] / kCprMax;
+    const double lonOdd     = state.lonCpr[1] / kCprMax;
+
+    const double j = qFloor(59 * latEven - 60 * latOdd + 0.5);
+    double rlatEven = 360.0 / 60 * (mod(j, 60) + latEven);
+    double rlatOdd  = 360.0 / 59 * (mod(j, 59) + latOdd);
+    if (rlatEven >= 270) {
+        rlatEven -= 360;
+    }
+    if (rlatOdd >= 270) {
+        rlatOdd -= 360;
+    }
+
+    // Frames from different longitude zones can't be paired
+    const int nl = _cprNL(rlatEven);
+    if (nl != _cprNL(rlatOdd)) {
+        return false;
+    }
+
+    const double    latitude    = newest ? rlatOdd : rlatEven;
+    const int       ni          = qMax(newest ? nl - 1 : nl, 1);
+    const double    m           = qFloor(lonEven * (nl - 1) - lonOdd * nl + 0.5);
+    double          longitude   = 360.0 / ni * (mod(m, ni) + (newest ? lonOdd : lonEven));
+    if (longitude >= 180) {
+        longitude -= 360;
+    }
+    if (latitude < -90 || latitude > 90) {
+        return false;
+    }
+
+    location = QGeoCoordinate(latitude, longitude);
+    return true;
+}
+
+void ADSBParser::_pruneCpr(qint64 nowMsecs)
+{
+    // Once a minute, so vehicles which are gone don't pile up
+    if (nowMsecs - _lastPruneMsecs < 60000) {
+        return;
+    }
+    _lastPruneMsecs = nowMsecs;
+
+    for (auto it = _cprStates.begin(); it != _cprStates.end();) {
+        if (nowMsecs - qMax(it->timeMsecs[0], it->timeMsecs[1]) > _cprMaxAgeMsecs) {
+            it = _cprStates.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool ADSBParser::parseMavlink(const mavlink_adsb_vehicle_t& adsbVehicle, ADSBVehicle::VehicleInfo_t& vehicleInfo)
+{
+    if (!(adsbVehicle.flags & ADSB_FLAGS_VALID_COORDS) || adsbVehicle.tslc > _maxTimeSinceLastSeen) {
+        return false;
+    }
+
+    vehicleInfo.availableFlags = 0;
+    vehicleInfo.icaoAddress = adsbVehicle.ICAO_address;
+
+    vehicleInfo.location.setLatitude(adsbVehicle.lat / 1e7);
+    vehicleInfo.location.setLongitude(adsbVehicle.lon / 1e7);
+    vehicleInfo.availableFlags |= ADSBVehicle::LocationAvailable;
+
+    vehicleInfo.callsign = QString::fromLatin1(adsbVehicle.callsign, static_cast<int>(strnlen(adsbVehicle.callsign, sizeof(adsbVehicle.callsign)))).trimmed();
+    vehicleInfo.availableFlags |= ADSBVehicle::CallsignAvailable;
+
+    if (adsbVehicle.flags & ADSB_FLAGS_VALID_ALTITUDE) {
+        vehicleInfo.altitude = (double)adsbVehicle.altitude / 1e3;
+        vehicleInfo.availableFlags |= ADSBVehicle::AltitudeAvailable;
+    }
+
+    if (adsbVehicle.flags & ADSB_FLAGS_VALID_HEADING) {
+        vehicleInfo.heading = (double)adsbVehicle.heading / 100.0;
+        vehicleInfo.availableFlags |= ADSBVehicle::HeadingAvailable;
+    }
+
+    if (adsbVehicle.flags & ADSB_FLAGS_VALID_VELOCITY) {
+        vehicleInfo.velocity = (double)adsbVehicle.hor_velocity / 100.0;
+        vehicleInfo.availableFlags |= ADSBVehicle::VelocityAvailable;
+    }
+
+    return true;
+}
+
+void ADSBParser::_merge(QHash<uint32_t, ADSBVehicle::VehicleInfo_t>& updates, const ADSBVehicle::VehicleInfo_t& vehicleInfo)
+{
+    auto it = updates.find(vehicleInfo.icaoAddress);
+    if (it == updates.end()) {
+        updates.insert(vehicleInfo.icaoAddress, vehicleInfo);
+    } else {
+        ADSBVehicle::mergeInfo(it.value(), vehicleInfo);
+    }
+}
@@ -0,0 +1,74 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "ADSBVehicle.h"
+
+#include <QHash>
+
+/// Decodes ADSB traffic straight from the received bytes, fields are parsed in place without building a QString or
+/// QStringList per message. Handles:
+///     - SBS-1/BaseStation text, "MSG,3,..." (usually port 30003)
+///     - AVR raw Mode S frames, "*8D...;" or "@<timestamp>8D...;" (usually port 30002)
+///     - Beast binary Mode S frames (usually port 30005)
+///     - MAVLink ADSB_VEHICLE
+/// The format is detected for each message, so any of the TCP feeds can be used.
+class ADSBParser
+{
+public:
+    ADSBParser(void);
+
+    /// Parses all complete messages in data
+    ///     @param nowMsecs Receive time, pairs up the even/odd position frames of Mode S
+    ///     @param updates  Vehicle information is merged in, keyed by ICAO address
+    /// @return Number of bytes used, the rest is the start of an incomplete message
+    int parse(const char* data, int length, qint64 nowMsecs, QHash<uint32_t, ADSBVehicle::VehicleInfo_t>& updates);
+
+    /// Forget the Mode S position frames
+    void clear(void) { _cprStates.clear(); }
+
+    /// @param line Without the line end
+    /// @return false: Not a message with vehicle information
+    static bool parseSBS(const char* line, int length, ADSBVehicle::VehicleInfo_t& vehicleInfo);
+
+    /// Decodes DF17/DF18 extended squitter identification, airborne position and airborne velocity. Position needs
+    /// an even and an odd frame within 10 seconds of each other.
+    /// @return false: Not a message with vehicle information
+    bool parseModeS(const quint8* frame, int length, qint64 nowMsecs, ADSBVehicle::VehicleInfo_t& vehicleInfo);
+
+    /// @return false: No valid coordinate or not seen recently
+    static bool parseMavlink(const mavlink_adsb_vehicle_t& adsbVehicle, ADSBVehicle::VehicleInfo_t& vehicleInfo);
+
+    /// @return Mode S CRC remainder, 0 for a valid extended squitter
+    static uint32_t modeSCrc(const quint8* frame, int length);
+
+private:
+    typedef struct {
+        uint32_t    latCpr[2];      ///< [0] even, [1] odd
+        uint32_t    lonCpr[2];
+        qint64      timeMsecs[2];   ///< -1 for none
+    } CprState_t;
+
+    int         _parseBeast     (const char* data, int length, qint64 nowMsecs, QHash<uint32_t, ADSBVehicle::VehicleInfo_t>& updates);
+    bool        _parseAVR       (const char* line, int length, qint64 nowMsecs, ADSBVehicle::VehicleInfo_t& vehicleInfo);
+    void        _pruneCpr       (qint64 nowMsecs);
+
+    static bool _decodeCpr      (const CprState_t& state, int newest, QGeoCoordinate& location);
+    static int  _cprNL          (double latitude);
+    static void _merge          (QHash<uint32_t, ADSBVehicle::VehicleInfo_t>& updates, const ADSBVehicle::VehicleInfo_t& vehicleInfo);
+
+    QHash<uint32_t, CprState_t> _cprStates;
+    qint64                      _lastPruneMsecs = 0;
+
+    static const int        _maxLineLength          = 1024;     ///< Longer text without a line end is dropped
+    static const int        _maxTimeSinceLastSeen   = 15;       ///< ADSB_VEHICLE.tslc, seconds
+    static constexpr qint64 _cprMaxAgeMsecs         = 10000;    ///< Even and odd frames further apart can't be paired
+    static constexpr double _knotsToMetersPerSecond = 0.514444;
+};
@@ -0,0 +1,170 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ADSBParserTest.h"
+#include "ADSBParser.h"
+
+#include <string.h>
+
+// Sample extended squitters with known contents
+static const char* kIdentFrame      = "8D4840D6202CC371C32CE0576098";  // 4840D6 KLM1023
+static const char* kEvenFrame       = "8D40621D58C382D690C8AC2863A7";  // 40621D even position, 38000 ft
+static const char* kOddFrame        = "8D40621D58C386435CC412692AD6";  // 40621D odd position
+static const char* kVelocityFrame   = "8D485020994409940838175B284F";  // 485020 track 182.88
+
+void ADSBParserTest::_sbsTest(void)
+{
+    ADSBVehicle::VehicleInfo_t vehicleInfo;
+
+    const QByteArray position("MSG,3,1,1,4CA2D6,1,2020/01/01,12:00:00.000,2020/01/01,12:00:00.000,,3000,,,47.3900,-8.5400,,,0,0,0,0");
+    QVERIFY(ADSBParser::parseSBS(position.constData(), position.size(), vehicleInfo));
+    QCOMPARE(vehicleInfo.icaoAddress, static_cast<uint32_t>(0x4CA2D6));
+    QCOMPARE(vehicleInfo.location, QGeoCoordinate(47.39, -8.54));
+    QCOMPARE(vehicleInfo.altitude, 3000 * 0.3048);
+    // No callsign in this message, so it must not claim one
+    QCOMPARE(vehicleInfo.availableFlags, static_cast<uint32_t>(ADSBVehicle::LocationAvailable | ADSBVehicle::AltitudeAvailable));
+
+    const QByteArray heading("MSG,4,1,1,4CA2D6,1,2020/01/01,12:00:00.000,2020/01/01,12:00:00.000,,,450,90.5,,,0,,0,0,0,0");
+    QVERIFY(ADSBParser::parseSBS(heading.constData(), heading.size(), vehicleInfo));
+    QCOMPARE(vehicleInfo.availableFlags, static_cast<uint32_t>(ADSBVehicle::HeadingAvailable | ADSBVehicle::VelocityAvailable));
+    QCOMPARE(vehicleInfo.heading, 90.5);
+    QVERIFY(qAbs(vehicleInfo.velocity - 450 * 0.514444) < 0.001);
+
+    const QByteArray callsign("MSG,1,1,1,4CA2D6,1,2020/01/01,12:00:00.000,2020/01/01,12:00:00.000,EIN123  ,,,,,,,0,0,0,0");
+    QVERIFY(ADSBParser::parseSBS(callsign.constData(), callsign.size(), vehicleInfo));
+    QCOMPARE(vehicleInfo.callsign, QStringLiteral("EIN123"));
+
+    // Not vehicle information, cut short, no position or a bad number
+    const QList<QByteArray> bad = {
+        "STA,,1,1,4CA2D6",
+        "MSG,3,1,1,4CA2D6",
+        "MSG,3,1,1,4CA2D6,1,2020/01/01,12:00:00.000,2020/01/01,12:00:00.000,,3000,,,0,0,,,0,0,0,0",
+        "MSG,3,1,1,4CA2D6,1,2020/01/01,12:00:00.000,2020/01/01,12:00:00.000,,3000,,,47.3x,8.5,,,0,0,0,0",
+    };
+    for (const QByteArray& line: bad) {
+        QVERIFY(!ADSBParser::parseSBS(line.constData(), line.size(), vehicleInfo));
+    }
+}
+
+void ADSBParserTest::_modeSTest(void)
+{
+    ADSBParser                  parser;
+    ADSBVehicle::VehicleInfo_t  vehicleInfo;
+    QByteArray                  frame;
+
+    frame = QByteArray::fromHex(kIdentFrame);
+    QCOMPARE(ADSBParser::modeSCrc(reinterpret_cast<const quint8*>(frame.constData()), frame.size()), static_cast<uint32_t>(0));
+    QVERIFY(parser.parseModeS(reinterpret_cast<const quint8*>(frame.constData()), frame.size(), 0, vehicleInfo));
+    QCOMPARE(vehicleInfo.icaoAddress, static_cast<uint32_t>(0x4840D6));
+    QCOMPARE(vehicleInfo.callsign, QStringLiteral("KLM1023"));
+
+    // Corrupt frame fails the CRC
+    frame[5] = frame[5] ^ 0x01;
+    QVERIFY(!parser.parseModeS(reinterpret_cast<const quint8*>(frame.constData()), frame.size(), 0, vehicleInfo));
+
+    // Odd frame alone has no position yet
+    frame = QByteArray::fromHex(kOddFrame);
+    QVERIFY(parser.parseModeS(reinterpret_cast<const quint8*>(frame.constData()), frame.size(), 0, vehicleInfo));
+    QCOMPARE(vehicleInfo.availableFlags, static_cast<uint32_t>(ADSBVehicle::AltitudeAvailable));
+    QCOMPARE(vehicleInfo.altitude, 38000 * 0.3048);
+
+    frame = QByteArray::fromHex(kEvenFrame);
+    QVERIFY(parser.parseModeS(reinterpret_cast<const quint8*>(frame.constData()), frame.size(), 2000, vehicleInfo));
+    QVERIFY(vehicleInfo.availableFlags & ADSBVehicle::LocationAvailable);
+    QVERIFY(qAbs(vehicleInfo.location.latitude() - 52.2572) < 0.0001);
+    QVERIFY(qAbs(vehicleInfo.location.longitude() - 3.91937) < 0.0001);
+
+    // Too far apart to pair up
+    parser.clear();
+    frame = QByteArray::fromHex(kOddFrame);
+    QVERIFY(parser.parseModeS(reinterpret_cast<const quint8*>(frame.constData()), frame.size(), 0, vehicleInfo));
+    frame = QByteArray::fromHex(kEvenFrame);
+    QVERIFY(parser.parseModeS(reinterpret_cast<const quint8*>(frame.constData()), frame.size(), 20000, vehicleInfo));
+    QVERIFY(!(vehicleInfo.availableFlags & ADSBVehicle::LocationAvailable));
+
+    frame = QByteArray::fromHex(kVelocityFrame);
+    QVERIFY(parser.parseModeS(reinterpret_cast<const quint8*>(frame.constData()), frame.size(), 0, vehicleInfo));
+    QCOMPARE(vehicleInfo.availableFlags, static_cast<uint32_t>(ADSBVehicle::HeadingAvailable | ADSBVehicle::VelocityAvailable));
+    QVERIFY(qAbs(vehicleInfo.heading - 182.88) < 0.01);
+    QVERIFY(qAbs(vehicleInfo.velocity - 159.20 * 0.514444) < 0.01);
+}
+
+void ADSBParserTest::_avrTest(void)
+{
+    ADSBParser                                  parser;
+    QHash<uint32_t, ADSBVehicle::VehicleInfo_t> updates;
+
+    const QByteArray data = QByteArray("*") + kOddFrame + ";\r\n@0123456789AB" + kEvenFrame + ";\n*" + kIdentFrame;
+
+    // Last line has no line end yet, the caller keeps it for the next read
+    const int used = parser.parse(data.constData(), data.size(), 0, updates);
+    QCOMPARE(used, data.indexOf('*', 1));
+    QCOMPARE(updates.count(), 1);
+    QVERIFY(updates.contains(0x40621D));
+    QVERIFY(updates[0x40621D].availableFlags & ADSBVehicle::LocationAvailable);
+    QVERIFY(updates[0x40621D].availableFlags & ADSBVehicle::AltitudeAvailable);
+
+    const QByteArray rest = data.mid(used) + ";\n";
+    QCOMPARE(parser.parse(rest.constData(), rest.size(), 0, updates), rest.size());
+    QCOMPARE(updates.count(), 2);
+    QCOMPARE(updates[0x4840D6].callsign, QStringLiteral("KLM1023"));
+}
+
+void ADSBParserTest::_beastTest(void)
+{
+    ADSBParser                                  parser;
+    QHash<uint32_t, ADSBVehicle::VehicleInfo_t> updates;
+    QByteArray                                  data;
+
+    // <esc> '3' <6 byte timestamp> <signal> <frame>, the 0x1a in the timestamp is escaped
+    data.append("\x1a" "3");
+    data.append(QByteArray::fromHex("00001a1a020304" "40"));
+    data.append(QByteArray::fromHex(kIdentFrame));
+    // Mode A/C frame is skipped
+    data.append("\x1a" "1");
+    data.append(QByteArray::fromHex("000000000000" "40" "1234"));
+    data.append("\x1a" "3");
+    data.append(QByteArray::fromHex("000000000000" "40"));
+    data.append(QByteArray::fromHex(kVelocityFrame).left(5));
+
+    const int used = parser.parse(data.constData(), data.size(), 0, updates);
+    QCOMPARE(used, data.lastIndexOf("\x1a" "3"));
+    QCOMPARE(updates.count(), 1);
+    QCOMPARE(updates[0x4840D6].callsign, QStringLiteral("KLM1023"));
+
+    // Rest of the frame arrives
+    const QByteArray rest = data.mid(used) + QByteArray::fromHex(kVelocityFrame).mid(5);
+    QCOMPARE(parser.parse(rest.constData(), rest.size(), 0, updates), rest.size());
+    QCOMPARE(updates.count(), 2);
+    QVERIFY(updates[0x485020].availableFlags & ADSBVehicle::HeadingAvailable);
+}
+
+void ADSBParserTest::_mavlinkTest(void)
+{
+    mavlink_adsb_vehicle_t      adsbVehicle;
+    ADSBVehicle::VehicleInfo_t  vehicleInfo;
+
+    memset(&adsbVehicle, 0, sizeof(adsbVehicle));
+    adsbVehicle.ICAO_address    = 0x4CA2D6;
+    adsbVehicle.lat             = 473900000;
+    adsbVehicle.lon             = 85400000;
+    adsbVehicle.altitude        = 1000000;
+    adsbVehicle.flags           = ADSB_FLAGS_VALID_COORDS | ADSB_FLAGS_VALID_ALTITUDE;
+    strcpy(adsbVehicle.callsign, "EIN123");
+
+    QVERIFY(ADSBParser::parseMavlink(adsbVehicle, vehicleInfo));
+    QCOMPARE(vehicleInfo.location, QGeoCoordinate(47.39, 8.54));
+    QCOMPARE(vehicleInfo.altitude, 1000.0);
+    QCOMPARE(vehicleInfo.callsign, QStringLiteral("EIN123"));
+    QVERIFY(!(vehicleInfo.availableFlags & ADSBVehicle::HeadingAvailable));
+
+    // Not seen for too long
+    adsbVehicle.tslc = 60;
+    QVERIFY(!ADSBParser::parseMavlink(adsbVehicle, vehicleInfo));
+}
@@ -0,0 +1,24 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class ADSBParserTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _sbsTest       (void);
+    void _modeSTest     (void);
+    void _avrTest       (void);
+    void _beastTest     (void);
+    void _mavlinkTest   (void);
+};
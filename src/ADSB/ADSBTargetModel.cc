@@ -0,0 +1,175 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ADSBTargetModel.h"
+
+#include <QGeoCoordinate>
+
+ADSBTargetModel::ADSBTargetModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+
+}
+
+void ADSBTargetModel::update(const QList<ADSBVehicle::VehicleInfo_t>& updates, qint64 nowMsecs)
+{
+    QVector<Target_t>       newTargets;
+    QHash<uint32_t, int>    newIndex;
+    int                     firstChanged    = -1;
+    int                     lastChanged     = -1;
+
+    for (const ADSBVehicle::VehicleInfo_t& update: updates) {
+        const int index = _indexByICAO.value(update.icaoAddress, -1);
+
+        if (index != -1) {
+            ADSBVehicle::mergeInfo(_targets[index].info, update);
+            _targets[index].lastUpdateMsecs = nowMsecs;
+            firstChanged = firstChanged == -1 ? index : qMin(firstChanged, index);
+            lastChanged = qMax(lastChanged, index);
+        } else if (newIndex.contains(update.icaoAddress)) {
+            Target_t& target = newTargets[newIndex[update.icaoAddress]];
+            ADSBVehicle::mergeInfo(target.info, update);
+            target.lastUpdateMsecs = nowMsecs;
+        } else if (update.availableFlags & ADSBVehicle::LocationAvailable) {
+            Target_t target;
+            target.info.icaoAddress = update.icaoAddress;
+            target.info.altitude = qQNaN();
+            target.info.heading = qQNaN();
+            target.info.velocity = qQNaN();
+            target.info.alert = false;
+            target.info.availableFlags = 0;
+            ADSBVehicle::mergeInfo(target.info, update);
+            target.lastUpdateMsecs = nowMsecs;
+            newIndex[update.icaoAddress] = newTargets.count();
+            newTargets.append(target);
+        }
+    }
+
+    if (firstChanged != -1) {
+        emit dataChanged(createIndex(firstChanged, 0), createIndex(lastChanged, 0));
+    }
+    if (!newTargets.isEmpty()) {
+        const int first = _targets.count();
+        beginInsertRows(QModelIndex(), first, first + newTargets.count() - 1);
+        for (const Target_t& target: newTargets) {
+            _indexByICAO[target.info.icaoAddress] = _targets.count();
+            _targets.append(target);
+        }
+        endInsertRows();
+        emit countChanged();
+    }
+}
+
+QList<uint32_t> ADSBTargetModel::removeExpired(qint64 nowMsecs, qint64 timeoutMsecs)
+{
+    QList<uint32_t> removed;
+
+    // Back to front so the rows still to check keep their index. Neighbouring rows go in one remove.
+    int row = _targets.count() - 1;
+    while (row >= 0) {
+        if (nowMsecs - _targets[row].lastUpdateMsecs <= timeoutMsecs) {
+            row--;
+            continue;
+        }
+        int first = row;
+        while (first > 0 && nowMsecs - _targets[first - 1].lastUpdateMsecs > timeoutMsecs) {
+            first--;
+        }
+        beginRemoveRows(QModelIndex(), first, row);
+        for (int i=first; i<=row; i++) {
+            removed.append(_targets[i].info.icaoAddress);
+        }
+        _targets.remove(first, row - first + 1);
+        endRemoveRows();
+        row = first - 1;
+    }
+
+    if (!removed.isEmpty()) {
+        _rebuildIndex();
+        emit countChanged();
+    }
+
+    return removed;
+}
+
+void ADSBTargetModel::clear(void)
+{
+    if (_targets.isEmpty()) {
+        return;
+    }
+    beginResetModel();
+    _targets.clear();
+    _indexByICAO.clear();
+    endResetModel();
+    emit countChanged();
+}
+
+const ADSBVehicle::VehicleInfo_t* ADSBTargetModel::target(uint32_t icaoAddress) const
+{
+    const int index = _indexByICAO.value(icaoAddress, -1);
+
+    return index == -1 ? nullptr : &_targets[index].info;
+}
+
+int ADSBTargetModel::rowCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+    return _targets.count();
+}
+
+QVariant ADSBTargetModel::data(const QModelIndex& index, int role) const
+{
+    if (index.row() < 0 || index.row() >= _targets.count()) {
+        return QVariant();
+    }
+
+    const ADSBVehicle::VehicleInfo_t& info = _targets[index.row()].info;
+
+    switch (role) {
+    case IcaoAddressRole:
+        return static_cast<int>(info.icaoAddress);
+    case CallsignRole:
+        return info.callsign;
+    case CoordinateRole:
+        return QVariant::fromValue(info.location);
+    case AltitudeRole:
+        return info.altitude;
+    case HeadingRole:
+        return info.heading;
+    case AlertRole:
+        return info.alert;
+    case VelocityRole:
+        return info.velocity;
+    }
+
+    return QVariant();
+}
+
+QHash<int, QByteArray> ADSBTargetModel::roleNames(void) const
+{
+    QHash<int, QByteArray> roles;
+
+    roles[IcaoAddressRole]  = "icaoAddress";
+    roles[CallsignRole]     = "callsign";
+    roles[CoordinateRole]   = "coordinate";
+    roles[AltitudeRole]     = "altitude";
+    roles[HeadingRole]      = "heading";
+    roles[AlertRole]        = "alert";
+    roles[VelocityRole]     = "velocity";
+
+    return roles;
+}
+
+void ADSBTargetModel::_rebuildIndex(void)
+{
+    _indexByICAO.clear();
+    for (int i=0; i<_targets.count(); i++) {
+        _indexByICAO[_targets[i].info.icaoAddress] = i;
+    }
+}
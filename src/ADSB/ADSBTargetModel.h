@@ -0,0 +1,73 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "ADSBVehicle.h"
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QVector>
+
+/// All ADSB targets which are being tracked, in range or not, as plain data. Updates are applied in batches so QML
+/// sees one rowsInserted and one dataChanged per batch instead of a signal per target property.
+class ADSBTargetModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    ADSBTargetModel(QObject* parent = nullptr);
+
+    enum Roles {
+        IcaoAddressRole = Qt::UserRole + 1,
+        CallsignRole,
+        CoordinateRole,
+        AltitudeRole,
+        HeadingRole,
+        AlertRole,
+        VelocityRole,
+    };
+
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+    int count(void) const { return _targets.count(); }
+
+    /// Merges the updates into the targets. New targets are only added once their location is known.
+    ///     @param nowMsecs Time of the updates, used for expiration
+    void update(const QList<ADSBVehicle::VehicleInfo_t>& updates, qint64 nowMsecs);
+
+    /// Removes targets which have not been updated for timeoutMsecs
+    /// @return ICAO addresses of the removed targets
+    QList<uint32_t> removeExpired(qint64 nowMsecs, qint64 timeoutMsecs);
+
+    void clear(void);
+
+    /// @return nullptr if the target is not tracked
+    const ADSBVehicle::VehicleInfo_t* target(uint32_t icaoAddress) const;
+    const ADSBVehicle::VehicleInfo_t& targetAt(int index) const { return _targets[index].info; }
+
+    // QAbstractListModel overrides
+    int                     rowCount    (const QModelIndex& parent = QModelIndex()) const override;
+    QVariant                data        (const QModelIndex& index, int role) const override;
+    QHash<int, QByteArray>  roleNames   (void) const override;
+
+signals:
+    void countChanged(void);
+
+private:
+    typedef struct {
+        ADSBVehicle::VehicleInfo_t  info;
+        qint64                      lastUpdateMsecs;
+    } Target_t;
+
+    void _rebuildIndex(void);
+
+    QVector<Target_t>       _targets;
+    QHash<uint32_t, int>    _indexByICAO;
+};
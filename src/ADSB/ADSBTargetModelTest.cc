@@ -0,0 +1,95 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ADSBTargetModelTest.h"
+#include "ADSBTargetModel.h"
+
+#include <QSignalSpy>
+
+#include <algorithm>
+
+static ADSBVehicle::VehicleInfo_t _locationInfo(uint32_t icaoAddress, double lat, double lon)
+{
+    ADSBVehicle::VehicleInfo_t vehicleInfo;
+
+    vehicleInfo.icaoAddress     = icaoAddress;
+    vehicleInfo.location        = QGeoCoordinate(lat, lon);
+    vehicleInfo.availableFlags  = ADSBVehicle::LocationAvailable;
+
+    return vehicleInfo;
+}
+
+void ADSBTargetModelTest::_mergeTest(void)
+{
+    ADSBVehicle::VehicleInfo_t merged = _locationInfo(1, 47.0, 8.0);
+
+    ADSBVehicle::VehicleInfo_t heading;
+    heading.icaoAddress     = 1;
+    heading.heading         = 180;
+    heading.availableFlags  = ADSBVehicle::HeadingAvailable;
+
+    ADSBVehicle::mergeInfo(merged, heading);
+    ADSBVehicle::mergeInfo(merged, _locationInfo(1, 47.1, 8.1));
+
+    // Latest location, heading from the earlier update
+    QCOMPARE(merged.location, QGeoCoordinate(47.1, 8.1));
+    QCOMPARE(merged.heading, 180.0);
+    QCOMPARE(merged.availableFlags, static_cast<uint32_t>(ADSBVehicle::LocationAvailable | ADSBVehicle::HeadingAvailable));
+}
+
+void ADSBTargetModelTest::_updateTest(void)
+{
+    ADSBTargetModel model;
+    QSignalSpy      insertedSpy(&model, &ADSBTargetModel::rowsInserted);
+    QSignalSpy      changedSpy(&model, &ADSBTargetModel::dataChanged);
+
+    ADSBVehicle::VehicleInfo_t headingOnly;
+    headingOnly.icaoAddress     = 3;
+    headingOnly.heading         = 90;
+    headingOnly.availableFlags  = ADSBVehicle::HeadingAvailable;
+
+    // One insert for the whole batch, nothing for a vehicle without a location yet
+    model.update({ _locationInfo(1, 47.0, 8.0), _locationInfo(2, 47.0, 8.1), headingOnly }, 0);
+    QCOMPARE(model.count(), 2);
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(changedSpy.count(), 0);
+    QVERIFY(!model.target(3));
+
+    model.update({ _locationInfo(2, 47.5, 8.5), _locationInfo(1, 47.2, 8.2) }, 100);
+    QCOMPARE(model.count(), 2);
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(changedSpy.count(), 1);
+    QCOMPARE(model.target(2)->location, QGeoCoordinate(47.5, 8.5));
+    QCOMPARE(model.data(model.index(0), ADSBTargetModel::CoordinateRole).value<QGeoCoordinate>(), QGeoCoordinate(47.2, 8.2));
+    QVERIFY(qIsNaN(model.data(model.index(0), ADSBTargetModel::AltitudeRole).toDouble()));
+}
+
+void ADSBTargetModelTest::_expireTest(void)
+{
+    ADSBTargetModel model;
+
+    model.update({ _locationInfo(1, 47.0, 8.0), _locationInfo(2, 47.0, 8.1), _locationInfo(3, 47.0, 8.2), _locationInfo(4, 47.0, 8.3) }, 0);
+    model.update({ _locationInfo(3, 47.0, 8.2) }, 1000);
+
+    QSignalSpy removedSpy(&model, &ADSBTargetModel::rowsRemoved);
+
+    QList<uint32_t> expired = model.removeExpired(1500, 1000);
+    std::sort(expired.begin(), expired.end());
+    QCOMPARE(expired, QList<uint32_t>({ 1, 2, 4 }));
+    // 1 and 2 are neighbours, so two removes
+    QCOMPARE(removedSpy.count(), 2);
+    QCOMPARE(model.count(), 1);
+    QVERIFY(model.target(3));
+    QCOMPARE(model.targetAt(0).icaoAddress, static_cast<uint32_t>(3));
+
+    // Index still works after the rows moved
+    model.update({ _locationInfo(3, 48.0, 9.0) }, 2000);
+    QCOMPARE(model.target(3)->location, QGeoCoordinate(48.0, 9.0));
+    QCOMPARE(model.removeExpired(2500, 1000).count(), 0);
+}
@@ -63,6 +63,29 @@ void ADSBVehicle::update(const VehicleInfo_t& vehicleInfo)
     _lastUpdateTimer.restart();
 }
 
+void ADSBVehicle::mergeInfo(VehicleInfo_t& to, const VehicleInfo_t& from)
+{
+    if (from.availableFlags & CallsignAvailable) {
+        to.callsign = from.callsign;
+    }
+    if (from.availableFlags & LocationAvailable) {
+        to.location = from.location;
+    }
+    if (from.availableFlags & AltitudeAvailable) {
+        to.altitude = from.altitude;
+    }
+    if (from.availableFlags & HeadingAvailable) {
+        to.heading = from.heading;
+    }
+    if (from.availableFlags & AlertAvailable) {
+        to.alert = from.alert;
+    }
+    if (from.availableFlags & VelocityAvailable) {
+        to.velocity = from.velocity;
+    }
+    to.availableFlags |= from.availableFlags;
+}
+
 bool ADSBVehicle::expired()
 {
     return _lastUpdateTimer.hasExpired(expirationTimeoutMs);
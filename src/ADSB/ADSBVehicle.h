@@ -26,6 +26,7 @@ public:
         AltitudeAvailable =     1 << 3,
         HeadingAvailable =      1 << 4,
         AlertAvailable =        1 << 5,
+        VelocityAvailable =     1 << 6,
     };
 
     typedef struct {
@@ -34,6 +35,7 @@ public:
         QGeoCoordinate  location;
         double          altitude;
         double          heading;
+        double          velocity;       // Ground speed m/s
         bool            alert;
         uint32_t        availableFlags;
     } VehicleInfo_t;
@@ -56,6 +58,9 @@ public:
 
     void update(const VehicleInfo_t& vehicleInfo);
 
+    /// Copies the fields available in from into to. Used to coalesce several updates for the same vehicle.
+    static void mergeInfo(VehicleInfo_t& to, const VehicleInfo_t& from);
+
     /// check if the vehicle is expired and should be removed
     bool expired();
 
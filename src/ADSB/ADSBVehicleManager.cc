@@ -12,6 +12,10 @@
 #include "QGCApplication.h"
 #include "SettingsManager.h"
 #include "ADSBVehicleManagerSettings.h"
+#include "MultiVehicleManager.h"
+#include "Vehicle.h"
+#include "AudioOutput.h"
+#include "QGCPowerManager.h"
 
 #include <QDebug>
 
@@ -20,18 +24,51 @@ ADSBVehicleManager::ADSBVehicleManager(QGCApplication* app, QGCToolbox* toolbox)
 {
 }
 
+ADSBVehicleManager::~ADSBVehicleManager()
+{
+    _conflictThread.quit();
+    _conflictThread.wait();
+}
+
 void ADSBVehicleManager::setToolbox(QGCToolbox* toolbox)
 {
     QGCTool::setToolbox(toolbox);
 
-    connect(&_adsbVehicleCleanupTimer, &QTimer::timeout, this, &ADSBVehicleManager::_cleanupStaleVehicles);
+    _clock.start();
+
+    connect(&_adsbVehicleCleanupTimer, &QGCWheelTimer::timeout, this, &ADSBVehicleManager::_cleanupStaleVehicles);
     _adsbVehicleCleanupTimer.setSingleShot(false);
     _adsbVehicleCleanupTimer.start(1000);
 
+    connect(&_updateTimer, &QGCWheelTimer::timeout, this, &ADSBVehicleManager::_applyUpdates);
+    _updateTimer.setSingleShot(false);
+    _updateTimer.start(_updateIntervalMsecs);
+
     ADSBVehicleManagerSettings* settings = qgcApp()->toolbox()->settingsManager()->adsbVehicleManagerSettings();
+    _maxDistanceFact = settings->adsbMaxDistance();
+    connect(_maxDistanceFact, &Fact::rawValueChanged, this, &ADSBVehicleManager::_cleanupStaleVehicles);
+    _conflictAlertsFact = settings->adsbConflictAlerts();
+
+    // The engine is deleted on its own thread once the thread is done
+    TrafficConflictEngine* conflictEngine = new TrafficConflictEngine();
+    conflictEngine->moveToThread(&_conflictThread);
+    connect(&_conflictThread,   &QThread::finished,                         conflictEngine, &QObject::deleteLater);
+    connect(this,               &ADSBVehicleManager::_processConflicts,     conflictEngine, &TrafficConflictEngine::process,            Qt::QueuedConnection);
+    connect(conflictEngine,     &TrafficConflictEngine::conflictsFound,     this,           &ADSBVehicleManager::_conflictsFound,       Qt::QueuedConnection);
+    _conflictThread.setObjectName(QStringLiteral("TrafficConflicts"));
+    _conflictThread.start();
+
+    connect(&_conflictTimer, &QGCWheelTimer::timeout, this, &ADSBVehicleManager::_checkConflicts);
+    _conflictTimer.setSingleShot(false);
+    _conflictTimer.start(_conflictIntervalMsecs);
+}
+
+void ADSBVehicleManager::deferredInit(void)
+{
+    ADSBVehicleManagerSettings* settings = _toolbox->settingsManager()->adsbVehicleManagerSettings();
     if (settings->adsbServerConnectEnabled()->rawValue().toBool()) {
         _tcpLink = new ADSBTCPLink(settings->adsbServerHostAddress()->rawValue().toString(), settings->adsbServerPort()->rawValue().toInt(), this);
-        connect(_tcpLink, &ADSBTCPLink::adsbVehicleUpdate,  this, &ADSBVehicleManager::adsbVehicleUpdate,   Qt::QueuedConnection);
+        connect(_tcpLink, &ADSBTCPLink::adsbVehicleUpdates, this, &ADSBVehicleManager::_adsbVehicleUpdates,  Qt::QueuedConnection);
         connect(_tcpLink, &ADSBTCPLink::error,              this, &ADSBVehicleManager::_tcpError,           Qt::QueuedConnection);
     }
 }
@@ -39,29 +76,277 @@ void ADSBVehicleManager::setToolbox(QGCToolbox* toolbox)
 void ADSBVehicleManager::_cleanupStaleVehicles()
 {
     // Remove all expired ADSB vehicles
-    for (int i=_adsbVehicles.count()-1; i>=0; i--) {
-        ADSBVehicle* adsbVehicle = _adsbVehicles.value<ADSBVehicle*>(i);
-        if (adsbVehicle->expired()) {
-            qCDebug(ADSBVehicleManagerLog) << "Expired" << QStringLiteral("%1").arg(adsbVehicle->icaoAddress(), 0, 16);
-            _adsbVehicles.removeAt(i);
-            _adsbICAOMap.remove(adsbVehicle->icaoAddress());
-            adsbVehicle->deleteLater();
+    for (uint32_t icaoAddress: _adsbTargets.removeExpired(_clock.elapsed(), _targetTimeoutMsecs)) {
+        qCDebug(ADSBVehicleManagerLog) << "Expired" << QStringLiteral("%1").arg(icaoAddress, 0, 16);
+        _removeADSBVehicle(icaoAddress);
+    }
+
+    // The vehicles and the map move, so targets come into and go out of range without an update of their own
+    for (int i=0; i<_adsbTargets.count(); i++) {
+        const ADSBVehicle::VehicleInfo_t&   target  = _adsbTargets.targetAt(i);
+        const bool                          shown   = _adsbICAOMap.contains(target.icaoAddress);
+
+        if (_inRange(target.location, shown) != shown) {
+            if (shown) {
+                _removeADSBVehicle(target.icaoAddress);
+            } else {
+                _addADSBVehicle(target);
+            }
         }
     }
 }
 
+void ADSBVehicleManager::_mergeUpdate(QHash<uint32_t, ADSBVehicle::VehicleInfo_t>& updates, const ADSBVehicle::VehicleInfo_t& vehicleInfo)
+{
+    auto it = updates.find(vehicleInfo.icaoAddress);
+    if (it == updates.end()) {
+        updates.insert(vehicleInfo.icaoAddress, vehicleInfo);
+    } else {
+        ADSBVehicle::mergeInfo(it.value(), vehicleInfo);
+    }
+}
+
 void ADSBVehicleManager::adsbVehicleUpdate(const ADSBVehicle::VehicleInfo_t vehicleInfo)
 {
-    uint32_t icaoAddress = vehicleInfo.icaoAddress;
+    // Applied on the next update interval, only the latest values for each vehicle are kept until then
+    _mergeUpdate(_pendingUpdates, vehicleInfo);
+}
 
-    if (_adsbICAOMap.contains(icaoAddress)) {
-        _adsbICAOMap[icaoAddress]->update(vehicleInfo);
-    } else {
-        if (vehicleInfo.availableFlags & ADSBVehicle::LocationAvailable) {
-            ADSBVehicle* adsbVehicle = new ADSBVehicle(vehicleInfo, this);
-            _adsbICAOMap[icaoAddress] = adsbVehicle;
-            _adsbVehicles.append(adsbVehicle);
+void ADSBVehicleManager::_adsbVehicleUpdates(const QList<ADSBVehicle::VehicleInfo_t> vehicleInfos)
+{
+    for (const ADSBVehicle::VehicleInfo_t& vehicleInfo: vehicleInfos) {
+        adsbVehicleUpdate(vehicleInfo);
+    }
+}
+
+void ADSBVehicleManager::_applyUpdates(void)
+{
+    // The targets feed the conflict checks, they take the updates right away
+    if (!_pendingUpdates.isEmpty()) {
+        _adsbTargets.update(_pendingUpdates.values(), _clock.elapsed());
+        if (_mapUpdates.isEmpty()) {
+            _mapUpdates.swap(_pendingUpdates);
+        } else {
+            for (const ADSBVehicle::VehicleInfo_t& update: _pendingUpdates) {
+                _mergeUpdate(_mapUpdates, update);
+            }
+            _pendingUpdates.clear();
+        }
+    }
+
+    // The vehicles on the map only every few intervals while the ui saves power
+    if (_mapUpdates.isEmpty() || ++_mapUpdateTicks < _toolbox->powerManager()->updateRateFactor()) {
+        return;
+    }
+    _mapUpdateTicks = 0;
+
+    const QList<ADSBVehicle::VehicleInfo_t> updates = _mapUpdates.values();
+    _mapUpdates.clear();
+
+    for (const ADSBVehicle::VehicleInfo_t& update: updates) {
+        ADSBVehicle* adsbVehicle = _adsbICAOMap.value(update.icaoAddress, nullptr);
+
+        if (adsbVehicle) {
+            adsbVehicle->update(update);
+        } else {
+            // Shown vehicles going out of range are left to _cleanupStaleVehicles
+            const ADSBVehicle::VehicleInfo_t* target = _adsbTargets.target(update.icaoAddress);
+            if (target && _inRange(target->location, false)) {
+                _addADSBVehicle(*target);
+            }
+        }
+    }
+
+    emit adsbVehiclesUpdated();
+}
+
+bool ADSBVehicleManager::_inRange(const QGeoCoordinate& coordinate, bool shown) const
+{
+    const double maxDistance = _maxDistanceFact ? _maxDistanceFact->rawValue().toDouble() : 0;
+
+    if (maxDistance <= 0) {
+        return true;
+    }
+    if (!coordinate.isValid()) {
+        return false;
+    }
+
+    const double    distance        = shown ? maxDistance * _rangeHysteresis : maxDistance;
+    bool            haveReference   = false;
+
+    QmlObjectListModel* vehicles = _toolbox->multiVehicleManager()->vehicles();
+    for (int i=0; i<vehicles->count(); i++) {
+        const QGeoCoordinate vehicleCoordinate = vehicles->value<Vehicle*>(i)->coordinate();
+        if (vehicleCoordinate.isValid()) {
+            haveReference = true;
+            if (vehicleCoordinate.distanceTo(coordinate) <= distance) {
+                return true;
+            }
+        }
+    }
+    if (_mapCenter.isValid()) {
+        haveReference = true;
+        if (_mapCenter.distanceTo(coordinate) <= distance) {
+            return true;
+        }
+    }
+
+    // Nothing to measure from yet
+    return !haveReference;
+}
+
+void ADSBVehicleManager::_addADSBVehicle(const ADSBVehicle::VehicleInfo_t& vehicleInfo)
+{
+    ADSBVehicle* adsbVehicle = new ADSBVehicle(vehicleInfo, this);
+    _adsbICAOMap[vehicleInfo.icaoAddress] = adsbVehicle;
+    if (_alertedICAOs.contains(vehicleInfo.icaoAddress)) {
+        _setAlert(vehicleInfo.icaoAddress, true);
+    }
+    _adsbVehicles.append(adsbVehicle);
+}
+
+void ADSBVehicleManager::_removeADSBVehicle(uint32_t icaoAddress)
+{
+    ADSBVehicle* adsbVehicle = _adsbICAOMap.take(icaoAddress);
+
+    if (adsbVehicle) {
+        _adsbVehicles.removeOne(adsbVehicle);
+        adsbVehicle->deleteLater();
+    }
+}
+
+void ADSBVehicleManager::_checkConflicts(void)
+{
+    if (_conflictBusy) {
+        // Don't queue up work behind a slow check, the next one has newer positions anyway
+        return;
+    }
+
+    QList<TrafficConflictEngine::Track_t> ownVehicles;
+    QList<TrafficConflictEngine::Track_t> traffic;
+
+    if (_conflictAlertsFact && _conflictAlertsFact->rawValue().toBool()) {
+        QmlObjectListModel* vehicles = _toolbox->multiVehicleManager()->vehicles();
+        for (int i=0; i<vehicles->count(); i++) {
+            Vehicle* vehicle = vehicles->value<Vehicle*>(i);
+            if (!vehicle->coordinate().isValid()) {
+                continue;
+            }
+
+            TrafficConflictEngine::Track_t track;
+            track.id            = static_cast<uint32_t>(vehicle->id());
+            track.ownVehicle    = true;
+            track.name          = tr("Vehicle %1").arg(vehicle->id());
+            track.coordinate    = vehicle->coordinate();
+            track.altitude      = vehicle->altitudeAMSL()->rawValue().toDouble();
+            track.heading       = vehicle->heading()->rawValue().toDouble();
+            track.speed         = vehicle->groundSpeed()->rawValue().toDouble();
+            ownVehicles.append(track);
+        }
+
+        if (!ownVehicles.isEmpty()) {
+            traffic.reserve(_adsbTargets.count());
+            for (int i=0; i<_adsbTargets.count(); i++) {
+                const ADSBVehicle::VehicleInfo_t& target = _adsbTargets.targetAt(i);
+
+                TrafficConflictEngine::Track_t track;
+                track.id            = target.icaoAddress;
+                track.ownVehicle    = false;
+                track.name          = target.callsign.isEmpty() ? QStringLiteral("%1").arg(target.icaoAddress, 6, 16, QChar('0')).toUpper() : target.callsign;
+                track.coordinate    = target.location;
+                track.altitude      = target.altitude;
+                track.heading       = target.heading;
+                track.speed         = target.velocity;
+                traffic.append(track);
+            }
+        }
+    }
+
+    if (ownVehicles.isEmpty()) {
+        if (_trafficConflicts.count() || !_alertedICAOs.isEmpty()) {
+            _conflictsFound(QList<TrafficConflictEngine::Conflict_t>());
         }
+        return;
+    }
+
+    _conflictBusy = true;
+    emit _processConflicts(ownVehicles, traffic);
+}
+
+void ADSBVehicleManager::_conflictsFound(const QList<TrafficConflictEngine::Conflict_t> conflicts)
+{
+    _conflictBusy = false;
+
+    const qint64                            now         = _clock.elapsed();
+    const bool                              enabled     = _conflictAlertsFact && _conflictAlertsFact->rawValue().toBool();
+    QSet<uint32_t>                          alertedICAOs;
+    QHash<quint64, Announced_t>             announced;
+    const TrafficConflictEngine::Conflict_t* announce   = nullptr;
+
+    _trafficConflicts.clearAndDeleteContents();
+
+    if (enabled) {
+        for (const TrafficConflictEngine::Conflict_t& conflict: conflicts) {
+            if (!conflict.other.ownVehicle) {
+                alertedICAOs.insert(conflict.other.id);
+            }
+            _trafficConflicts.append(new TrafficConflict(conflict, this));
+
+            // Own vehicle ids and ICAO addresses can overlap, so the kind of the other track is part of the key
+            const quint64   key         = (static_cast<quint64>(conflict.ownVehicle.id) << 33) | (conflict.other.ownVehicle ? (1ull << 32) : 0) | conflict.other.id;
+            Announced_t     previous    = _announced.value(key, { TrafficConflictEngine::LevelNone, 0 });
+            const bool      escalated   = conflict.level > previous.level;
+            const bool      repeat      = conflict.level == TrafficConflictEngine::LevelWarning && now - previous.msecs >= _warningRepeatMsecs;
+
+            // Only the most urgent one is spoken, the others keep their previous state so they come up next time
+            if (!announce && (escalated || repeat)) {
+                announce = &conflict;
+                previous = { conflict.level, now };
+            } else if (conflict.level < previous.level) {
+                previous.level = conflict.level;
+            }
+            announced.insert(key, previous);
+        }
+    }
+    _announced = announced;
+
+    for (uint32_t icaoAddress: _alertedICAOs) {
+        if (!alertedICAOs.contains(icaoAddress)) {
+            _setAlert(icaoAddress, false);
+        }
+    }
+    for (uint32_t icaoAddress: alertedICAOs) {
+        if (!_alertedICAOs.contains(icaoAddress)) {
+            _setAlert(icaoAddress, true);
+        }
+    }
+    _alertedICAOs = alertedICAOs;
+
+    if (announce) {
+        QString text = tr("%1 %2, %3 seconds")
+                .arg(announce->level == TrafficConflictEngine::LevelWarning ? tr("Traffic warning") : tr("Traffic advisory"))
+                .arg(announce->other.name)
+                .arg(qRound(announce->timeToCpa));
+        if (_toolbox->multiVehicleManager()->vehicles()->count() > 1) {
+            text = tr("Vehicle %1, %2").arg(announce->ownVehicle.id).arg(text);
+        }
+        qCDebug(ADSBVehicleManagerLog) << "Conflict" << text << announce->cpaDistance << announce->verticalSeparation;
+        _toolbox->audioOutput()->say(text, announce->ownVehicle.id, QStringLiteral("traffic"),
+                                     announce->level == TrafficConflictEngine::LevelWarning ? AudioOutputQueue::PriorityCritical : AudioOutputQueue::PriorityHigh);
+    }
+}
+
+void ADSBVehicleManager::_setAlert(uint32_t icaoAddress, bool alert)
+{
+    ADSBVehicle* adsbVehicle = _adsbICAOMap.value(icaoAddress, nullptr);
+
+    if (adsbVehicle) {
+        ADSBVehicle::VehicleInfo_t vehicleInfo;
+        vehicleInfo.icaoAddress     = icaoAddress;
+        vehicleInfo.availableFlags  = ADSBVehicle::AlertAvailable;
+        vehicleInfo.alert           = alert;
+        adsbVehicle->update(vehicleInfo);
+        emit adsbVehiclesUpdated();
     }
 }
 
@@ -96,6 +381,9 @@ void ADSBTCPLink::run(void)
 {
     _hardwareConnect();
     exec();
+
+    delete _updateTimer;
+    _updateTimer = nullptr;
 }
 
 void ADSBTCPLink::_hardwareConnect()
@@ -115,78 +403,30 @@ void ADSBTCPLink::_hardwareConnect()
         return;
     }
 
+    // A busy feed has thousands of messages a second, they are sent on as one batch per interval
+    _clock.start();
+    _updateTimer = new QTimer();
+    QObject::connect(_updateTimer, &QTimer::timeout, this, &ADSBTCPLink::_sendUpdates);
+    _updateTimer->start(_updateIntervalMsecs);
+
     qCDebug(ADSBVehicleManagerLog) << "ADSB Socket connected";
 }
 
 void ADSBTCPLink::_readBytes(void)
 {
-    if (_socket) {
-        QByteArray bytes = _socket->readLine();
-        _parseLine(QString::fromLocal8Bit(bytes));
+    if (!_socket) {
+        return;
     }
+
+    _buffer.append(_socket->readAll());
+    const int used = _parser.parse(_buffer.constData(), _buffer.size(), _clock.elapsed(), _pendingUpdates);
+    _buffer.remove(0, used);
 }
 
-void ADSBTCPLink::_parseLine(const QString& line)
+void ADSBTCPLink::_sendUpdates(void)
 {
-    if (line.startsWith(QStringLiteral("MSG"))) {
-        qCDebug(ADSBVehicleManagerLog) << "ADSB SBS-1" << line;
-
-        QStringList values = line.split(QStringLiteral(","));
-
-        if (values[1] == QStringLiteral("3")) {
-            bool icaoOk, altOk, latOk, lonOk;
-
-            uint32_t    icaoAddress =   values[4].toUInt(&icaoOk, 16);
-            int         modeCAltitude = values[11].toInt(&altOk);
-            double      lat =           values[14].toDouble(&latOk);
-            double      lon =           values[15].toDouble(&lonOk);
-            QString     callsign =      values[10];
-
-            if (!icaoOk || !altOk || !latOk || !lonOk) {
-                return;
-            }
-            if (lat == 0 && lon == 0) {
-                return;
-            }
-
-            double altitude = modeCAltitude / 3.048;
-            QGeoCoordinate location(lat, lon);
-
-            ADSBVehicle::VehicleInfo_t adsbInfo;
-            adsbInfo.icaoAddress = icaoAddress;
-            adsbInfo.callsign = callsign;
-            adsbInfo.location = location;
-            adsbInfo.altitude = altitude;
-            adsbInfo.availableFlags = ADSBVehicle::CallsignAvailable | ADSBVehicle::LocationAvailable | ADSBVehicle::AltitudeAvailable;
-            emit adsbVehicleUpdate(adsbInfo);
-        } else if (values[1] == QStringLiteral("4")) {
-            bool icaoOk, headingOk;
-
-            uint32_t    icaoAddress =   values[4].toUInt(&icaoOk, 16);
-            double      heading =       values[13].toDouble(&headingOk);
-
-            if (!icaoOk || !headingOk) {
-                return;
-            }
-
-            ADSBVehicle::VehicleInfo_t adsbInfo;
-            adsbInfo.icaoAddress = icaoAddress;
-            adsbInfo.heading = heading;
-            adsbInfo.availableFlags = ADSBVehicle::HeadingAvailable;
-            emit adsbVehicleUpdate(adsbInfo);
-        } else if (values[1] == QStringLiteral("1")) {
-            bool icaoOk;
-
-            uint32_t icaoAddress = values[4].toUInt(&icaoOk, 16);
-            if (!icaoOk) {
-                return;
-            }
-
-            ADSBVehicle::VehicleInfo_t adsbInfo;
-            adsbInfo.icaoAddress = icaoAddress;
-            adsbInfo.callsign = values[10];
-            adsbInfo.availableFlags = ADSBVehicle::CallsignAvailable;
-            emit adsbVehicleUpdate(adsbInfo);
-        }
+    if (!_pendingUpdates.isEmpty()) {
+        emit adsbVehicleUpdates(_pendingUpdates.values());
+        _pendingUpdates.clear();
     }
 }
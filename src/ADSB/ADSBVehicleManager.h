@@ -12,13 +12,21 @@
 #include "QGCToolbox.h"
 #include "QmlObjectListModel.h"
 #include "ADSBVehicle.h"
+#include "ADSBTargetModel.h"
+#include "ADSBParser.h"
+#include "TrafficConflictEngine.h"
+#include "QGCTimerWheel.h"
 
 #include <QThread>
 #include <QTcpSocket>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
 #include <QGeoCoordinate>
 
 class ADSBVehicleManagerSettings;
+class Fact;
 
 class ADSBTCPLink : public QThread
 {
@@ -29,47 +37,114 @@ public:
     ~ADSBTCPLink();
 
 signals:
-    void adsbVehicleUpdate(const ADSBVehicle::VehicleInfo_t vehicleInfo);
+    /// Updates since the last batch, at most one per vehicle
+    void adsbVehicleUpdates(const QList<ADSBVehicle::VehicleInfo_t> vehicleInfos);
     void error(const QString errorMsg);
 
 protected:
     void run(void) final;
 
 private slots:
-    void _readBytes(void);
+    void _readBytes     (void);
+    void _sendUpdates   (void);
 
 private:
     void _hardwareConnect(void);
-    void _parseLine(const QString& line);
 
-    QString         _hostAddress;
-    int             _port;
-    QTcpSocket*     _socket =   nullptr;
+    QString                                     _hostAddress;
+    int                                         _port;
+    QTcpSocket*                                 _socket         = nullptr;
+    QTimer*                                     _updateTimer    = nullptr;
+    ADSBParser                                  _parser;
+    QByteArray                                  _buffer;                    ///< Incomplete message from the last read
+    QElapsedTimer                               _clock;
+    QHash<uint32_t, ADSBVehicle::VehicleInfo_t> _pendingUpdates;            ///< Parsed since the last batch
+
+    static const int _updateIntervalMsecs = 250;
 };
 
+/// Tracks ADSB vehicles from the SBS-1 server and from the vehicles (ADSB_VEHICLE). Updates are coalesced per ICAO
+/// address and applied once per update interval. All targets are kept in adsbTargets, ADSBVehicle objects
+/// (adsbVehicles) are only created for targets within adsbMaxDistance of a vehicle or of the map center.
+///
+/// Once per conflict interval the vehicles and all targets are handed to a TrafficConflictEngine on its own thread.
+/// Conflicts are shown in trafficConflicts, mark the ADSB vehicle as alert and the most urgent new one is announced.
 class ADSBVehicleManager : public QGCTool {
     Q_OBJECT
-    
+
 public:
     ADSBVehicleManager(QGCApplication* app, QGCToolbox* toolbox);
+    ~ADSBVehicleManager();
+
+    Q_PROPERTY(QmlObjectListModel*  adsbVehicles        READ adsbVehicles       CONSTANT)
+    Q_PROPERTY(ADSBTargetModel*     adsbTargets         READ adsbTargets        CONSTANT)
+    Q_PROPERTY(QmlObjectListModel*  trafficConflicts    READ trafficConflicts   CONSTANT)   ///< TrafficConflict, most urgent first
 
-    Q_PROPERTY(QmlObjectListModel* adsbVehicles READ adsbVehicles CONSTANT)
+    QmlObjectListModel* adsbVehicles    (void) { return &_adsbVehicles; }
+    ADSBTargetModel*    adsbTargets     (void) { return &_adsbTargets; }
+    QmlObjectListModel* trafficConflicts(void) { return &_trafficConflicts; }
 
-    QmlObjectListModel* adsbVehicles(void) { return &_adsbVehicles; }
+    /// Targets near the map center are shown even when they are far from all vehicles
+    Q_INVOKABLE void setMapCenter(const QGeoCoordinate& mapCenter) { _mapCenter = mapCenter; }
 
     // QGCTool overrides
     void setToolbox(QGCToolbox* toolbox) final;
+    void deferredInit(void) final;
 
 public slots:
     void adsbVehicleUpdate  (const ADSBVehicle::VehicleInfo_t vehicleInfo);
     void _tcpError          (const QString errorMsg);
 
 private slots:
-    void _cleanupStaleVehicles(void);
+    void _adsbVehicleUpdates    (const QList<ADSBVehicle::VehicleInfo_t> vehicleInfos);
+    void _applyUpdates          (void);
+    void _cleanupStaleVehicles  (void);
+    void _checkConflicts        (void);
+    void _conflictsFound        (const QList<TrafficConflictEngine::Conflict_t> conflicts);
+
+signals:
+    /// Sent once for each batch of changes to the vehicles in adsbVehicles, so views don't have to watch each one
+    void adsbVehiclesUpdated(void);
+
+    // Internal, queued to the engine thread
+    void _processConflicts(const QList<TrafficConflictEngine::Track_t> ownVehicles, const QList<TrafficConflictEngine::Track_t> traffic);
 
 private:
-    QmlObjectListModel              _adsbVehicles;
-    QMap<uint32_t, ADSBVehicle*>    _adsbICAOMap;
-    QTimer                          _adsbVehicleCleanupTimer;
-    ADSBTCPLink*                    _tcpLink = nullptr;
+    typedef struct {
+        TrafficConflictEngine::Level_t  level;
+        qint64                          msecs;
+    } Announced_t;
+
+    bool _inRange           (const QGeoCoordinate& coordinate, bool shown) const;
+    void _addADSBVehicle    (const ADSBVehicle::VehicleInfo_t& vehicleInfo);
+    void _removeADSBVehicle (uint32_t icaoAddress);
+    void _setAlert          (uint32_t icaoAddress, bool alert);
+
+    static void _mergeUpdate(QHash<uint32_t, ADSBVehicle::VehicleInfo_t>& updates, const ADSBVehicle::VehicleInfo_t& vehicleInfo);
+
+    QmlObjectListModel                          _adsbVehicles;
+    QMap<uint32_t, ADSBVehicle*>                _adsbICAOMap;
+    ADSBTargetModel                             _adsbTargets;
+    QHash<uint32_t, ADSBVehicle::VehicleInfo_t> _pendingUpdates;
+    QHash<uint32_t, ADSBVehicle::VehicleInfo_t> _mapUpdates;                ///< Applied to the targets, not to adsbVehicles yet
+    int                                         _mapUpdateTicks = 0;
+    QGCWheelTimer                               _adsbVehicleCleanupTimer { "ADSB" };
+    QGCWheelTimer                               _updateTimer { "ADSB" };
+    QElapsedTimer                               _clock;
+    QGeoCoordinate                              _mapCenter;
+    Fact*                                       _maxDistanceFact = nullptr;
+    Fact*                                       _conflictAlertsFact = nullptr;
+    ADSBTCPLink*                                _tcpLink = nullptr;
+    QThread                                     _conflictThread;
+    QGCWheelTimer                               _conflictTimer { "ADSB" };
+    bool                                        _conflictBusy = false;      ///< The engine hasn't answered the last check yet
+    QmlObjectListModel                          _trafficConflicts;
+    QSet<uint32_t>                              _alertedICAOs;
+    QHash<quint64, Announced_t>                 _announced;                 ///< By own vehicle and other track
+
+    static const int        _updateIntervalMsecs    = 250;
+    static const int        _conflictIntervalMsecs  = 1000;
+    static constexpr qint64 _warningRepeatMsecs     = 10000;    ///< An ongoing warning is announced again after this long
+    static constexpr qint64 _targetTimeoutMsecs     = 120000;   ///< Same as ADSBVehicle
+    static constexpr double _rangeHysteresis        = 1.1;      ///< Shown targets are kept until this much further out
 };
@@ -0,0 +1,216 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TrafficConflictEngine.h"
+
+#include <QHash>
+#include <QVector>
+#include <QtMath>
+
+#include <algorithm>
+
+static const double kMetersPerDegree    = 111195.08;    ///< Along a meridian, same mean earth radius as QGeoCoordinate
+static const double kMaxSpeed           = 600;          ///< m/s, faster is bad data and treated as not moving
+
+/// Track on a flat plane around the first own vehicle, good enough for the few kilometers that matter here
+typedef struct {
+    double x;
+    double y;
+    double vx;
+    double vy;
+} Projected_t;
+
+static Projected_t _project(const TrafficConflictEngine::Track_t& track, const QGeoCoordinate& origin, double cosOriginLat)
+{
+    Projected_t projected;
+
+    double deltaLon = track.coordinate.longitude() - origin.longitude();
+    if (deltaLon > 180) {
+        deltaLon -= 360;
+    } else if (deltaLon < -180) {
+        deltaLon += 360;
+    }
+    projected.x = deltaLon * cosOriginLat * kMetersPerDegree;
+    projected.y = (track.coordinate.latitude() - origin.latitude()) * kMetersPerDegree;
+
+    if (qIsNaN(track.speed) || qIsNaN(track.heading) || track.speed > kMaxSpeed) {
+        projected.vx = projected.vy = 0;
+    } else {
+        const double heading = qDegreesToRadians(track.heading);
+        projected.vx = track.speed * qSin(heading);
+        projected.vy = track.speed * qCos(heading);
+    }
+
+    return projected;
+}
+
+static quint64 _cellKey(int x, int y)
+{
+    return (static_cast<quint64>(static_cast<quint32>(x)) << 32) | static_cast<quint32>(y);
+}
+
+static QGeoCoordinate _predict(const TrafficConflictEngine::Track_t& track, double secs)
+{
+    if (secs <= 0 || qIsNaN(track.speed) || qIsNaN(track.heading) || track.speed > kMaxSpeed) {
+        return track.coordinate;
+    }
+    return track.coordinate.atDistanceAndAzimuth(track.speed * secs, track.heading);
+}
+
+TrafficConflictEngine::TrafficConflictEngine(QObject* parent)
+    : QObject(parent)
+{
+
+}
+
+void TrafficConflictEngine::process(const QList<TrafficConflictEngine::Track_t> ownVehicles, const QList<TrafficConflictEngine::Track_t> traffic)
+{
+    emit conflictsFound(findConflicts(ownVehicles, traffic));
+}
+
+TrafficConflictEngine::Level_t TrafficConflictEngine::_level(double timeToCpa, double cpaDistance, double verticalSeparation)
+{
+    // Unknown altitude can't rule a conflict out
+    if (timeToCpa <= warningSecs && cpaDistance <= warningDistance && (qIsNaN(verticalSeparation) || verticalSeparation <= warningVertical)) {
+        return LevelWarning;
+    }
+    if (timeToCpa <= lookAheadSecs && cpaDistance <= advisoryDistance && (qIsNaN(verticalSeparation) || verticalSeparation <= advisoryVertical)) {
+        return LevelAdvisory;
+    }
+    return LevelNone;
+}
+
+QList<TrafficConflictEngine::Conflict_t> TrafficConflictEngine::findConflicts(const QList<Track_t>& ownVehicles, const QList<Track_t>& traffic)
+{
+    QList<Conflict_t> conflicts;
+
+    if (ownVehicles.isEmpty()) {
+        return conflicts;
+    }
+
+    const QGeoCoordinate    origin          = ownVehicles[0].coordinate;
+    const double            cosOriginLat    = qCos(qDegreesToRadians(origin.latitude()));
+    const int               trafficCount    = traffic.count();
+    const int               otherCount      = trafficCount + ownVehicles.count();
+
+    // The own vehicles are traffic for each other, indices past the ADSB traffic
+    auto other = [&](int index) -> const Track_t& {
+        return index < trafficCount ? traffic[index] : ownVehicles[index - trafficCount];
+    };
+
+    // Each track goes in all the cells its path can reach within the look ahead time, widened by the advisory
+    // distance. An own vehicle then only has to look in the cells of its own path.
+    QVector<Projected_t>            projected(otherCount);
+    QHash<quint64, QVector<int>>    grid;
+
+    for (int i=0; i<otherCount; i++) {
+        const Projected_t& track = projected[i] = _project(other(i), origin, cosOriginLat);
+
+        const double endX = track.x + track.vx * lookAheadSecs;
+        const double endY = track.y + track.vy * lookAheadSecs;
+        const int minX = qFloor((qMin(track.x, endX) - advisoryDistance) / _cellSize);
+        const int maxX = qFloor((qMax(track.x, endX) + advisoryDistance) / _cellSize);
+        const int minY = qFloor((qMin(track.y, endY) - advisoryDistance) / _cellSize);
+        const int maxY = qFloor((qMax(track.y, endY) + advisoryDistance) / _cellSize);
+
+        for (int x=minX; x<=maxX; x++) {
+            for (int y=minY; y<=maxY; y++) {
+                grid[_cellKey(x, y)].append(i);
+            }
+        }
+    }
+
+    QVector<int> checkedBy(otherCount, -1);
+
+    for (int ownIndex=0; ownIndex<ownVehicles.count(); ownIndex++) {
+        const Track_t&      ownTrack    = ownVehicles[ownIndex];
+        const Projected_t&  own         = projected[trafficCount + ownIndex];
+
+        const double endX = own.x + own.vx * lookAheadSecs;
+        const double endY = own.y + own.vy * lookAheadSecs;
+        const int minX = qFloor(qMin(own.x, endX) / _cellSize);
+        const int maxX = qFloor(qMax(own.x, endX) / _cellSize);
+        const int minY = qFloor(qMin(own.y, endY) / _cellSize);
+        const int maxY = qFloor(qMax(own.y, endY) / _cellSize);
+
+        for (int x=minX; x<=maxX; x++) {
+            for (int y=minY; y<=maxY; y++) {
+                const auto cell = grid.constFind(_cellKey(x, y));
+                if (cell == grid.constEnd()) {
+                    continue;
+                }
+
+                for (int otherIndex: cell.value()) {
+                    if (checkedBy[otherIndex] == ownIndex) {
+                        continue;
+                    }
+                    checkedBy[otherIndex] = ownIndex;
+
+                    // Self, or a pair of own vehicles which was already checked the other way around
+                    if (otherIndex >= trafficCount && otherIndex - trafficCount <= ownIndex) {
+                        continue;
+                    }
+
+                    const Projected_t&  target  = projected[otherIndex];
+                    const double        dx      = target.x - own.x;
+                    const double        dy      = target.y - own.y;
+                    const double        dvx     = target.vx - own.vx;
+                    const double        dvy     = target.vy - own.vy;
+                    const double        dv2     = dvx * dvx + dvy * dvy;
+
+                    // Time of the closest approach of the relative motion, now if already moving apart
+                    double timeToCpa = dv2 > 0 ? -(dx * dvx + dy * dvy) / dv2 : 0;
+                    timeToCpa = qBound(0.0, timeToCpa, static_cast<double>(lookAheadSecs));
+
+                    const double cpaX = dx + dvx * timeToCpa;
+                    const double cpaY = dy + dvy * timeToCpa;
+                    const double cpaDistance = qSqrt(cpaX * cpaX + cpaY * cpaY);
+
+                    const Track_t& otherTrack = other(otherIndex);
+                    const double verticalSeparation = qIsNaN(ownTrack.altitude) || qIsNaN(otherTrack.altitude) ? qQNaN() : qAbs(ownTrack.altitude - otherTrack.altitude);
+
+                    const Level_t level = _level(timeToCpa, cpaDistance, verticalSeparation);
+                    if (level == LevelNone) {
+                        continue;
+                    }
+
+                    Conflict_t conflict;
+                    conflict.ownVehicle         = ownTrack;
+                    conflict.other              = otherTrack;
+                    conflict.level              = level;
+                    conflict.timeToCpa          = timeToCpa;
+                    conflict.cpaDistance        = cpaDistance;
+                    conflict.verticalSeparation = verticalSeparation;
+                    conflict.ownCpa             = _predict(ownTrack, timeToCpa);
+                    conflict.otherCpa           = _predict(otherTrack, timeToCpa);
+                    conflicts.append(conflict);
+                }
+            }
+        }
+    }
+
+    std::sort(conflicts.begin(), conflicts.end(), [](const Conflict_t& a, const Conflict_t& b) {
+        if (a.level != b.level) {
+            return a.level > b.level;
+        }
+        if (!qFuzzyCompare(a.timeToCpa + 1, b.timeToCpa + 1)) {
+            return a.timeToCpa < b.timeToCpa;
+        }
+        return a.cpaDistance < b.cpaDistance;
+    });
+
+    return conflicts;
+}
+
+TrafficConflict::TrafficConflict(const TrafficConflictEngine::Conflict_t& conflict, QObject* parent)
+    : QObject   (parent)
+    , _conflict (conflict)
+{
+
+}
@@ -0,0 +1,111 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QGeoCoordinate>
+#include <QList>
+
+/// Predicts conflicts between the own vehicles and ADSB traffic, and between the own vehicles, from the closest point
+/// of approach (CPA) of straight line tracks. Traffic is bucketed in a grid over the area it can reach within the look
+/// ahead time, so each own vehicle is only checked against the traffic near its own path.
+///
+/// Runs on a worker thread, see ADSBVehicleManager.
+class TrafficConflictEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    TrafficConflictEngine(QObject* parent = nullptr);
+
+    typedef enum {
+        LevelNone = 0,
+        LevelAdvisory,
+        LevelWarning,
+    } Level_t;
+
+    typedef struct {
+        uint32_t        id;             ///< ICAO address, vehicle id for own vehicles
+        bool            ownVehicle;
+        QString         name;
+        QGeoCoordinate  coordinate;
+        double          altitude;       ///< AMSL m, NaN for unknown
+        double          heading;        ///< Degrees, NaN for unknown
+        double          speed;          ///< Ground speed m/s, NaN for unknown
+    } Track_t;
+
+    typedef struct {
+        Track_t         ownVehicle;
+        Track_t         other;
+        Level_t         level;
+        double          timeToCpa;          ///< Seconds
+        double          cpaDistance;        ///< Horizontal distance at CPA, m
+        double          verticalSeparation; ///< m, NaN if an altitude is unknown
+        QGeoCoordinate  ownCpa;             ///< Where the own vehicle is at CPA
+        QGeoCoordinate  otherCpa;
+    } Conflict_t;
+
+    /// @return Conflicts of each own vehicle with the traffic and with the other own vehicles, most urgent first.
+    ///         A conflict between two own vehicles is only listed once.
+    static QList<Conflict_t> findConflicts(const QList<Track_t>& ownVehicles, const QList<Track_t>& traffic);
+
+    static const int        lookAheadSecs           = 60;
+    static constexpr double advisoryDistance        = 1500;     ///< Horizontal CPA distance, m
+    static constexpr double advisoryVertical        = 300;      ///< m
+    static const int        warningSecs             = 30;
+    static constexpr double warningDistance         = 500;
+    static constexpr double warningVertical         = 150;
+
+public slots:
+    void process(const QList<TrafficConflictEngine::Track_t> ownVehicles, const QList<TrafficConflictEngine::Track_t> traffic);
+
+signals:
+    void conflictsFound(const QList<TrafficConflictEngine::Conflict_t> conflicts);
+
+private:
+    static Level_t _level(double timeToCpa, double cpaDistance, double verticalSeparation);
+
+    static constexpr double _cellSize = 5000;   ///< Grid cell, m
+};
+
+/// A conflict as shown on the map, see ADSBVehicleManager::trafficConflicts
+class TrafficConflict : public QObject
+{
+    Q_OBJECT
+
+public:
+    TrafficConflict(const TrafficConflictEngine::Conflict_t& conflict, QObject* parent = nullptr);
+
+    Q_PROPERTY(bool             warning             READ warning            CONSTANT)   ///< false: Advisory
+    Q_PROPERTY(int              vehicleId           READ vehicleId          CONSTANT)
+    Q_PROPERTY(QString          otherName           READ otherName          CONSTANT)
+    Q_PROPERTY(double           timeToCpa           READ timeToCpa          CONSTANT)
+    Q_PROPERTY(double           cpaDistance         READ cpaDistance        CONSTANT)
+    Q_PROPERTY(QGeoCoordinate   coordinate          READ coordinate         CONSTANT)
+    Q_PROPERTY(QGeoCoordinate   otherCoordinate     READ otherCoordinate    CONSTANT)
+    Q_PROPERTY(QGeoCoordinate   cpaCoordinate       READ cpaCoordinate      CONSTANT)
+    Q_PROPERTY(QGeoCoordinate   otherCpaCoordinate  READ otherCpaCoordinate CONSTANT)
+
+    bool            warning             (void) const { return _conflict.level == TrafficConflictEngine::LevelWarning; }
+    int             vehicleId           (void) const { return static_cast<int>(_conflict.ownVehicle.id); }
+    QString         otherName           (void) const { return _conflict.other.name; }
+    double          timeToCpa           (void) const { return _conflict.timeToCpa; }
+    double          cpaDistance         (void) const { return _conflict.cpaDistance; }
+    QGeoCoordinate  coordinate          (void) const { return _conflict.ownVehicle.coordinate; }
+    QGeoCoordinate  otherCoordinate     (void) const { return _conflict.other.coordinate; }
+    QGeoCoordinate  cpaCoordinate       (void) const { return _conflict.ownCpa; }
+    QGeoCoordinate  otherCpaCoordinate  (void) const { return _conflict.otherCpa; }
+
+private:
+    TrafficConflictEngine::Conflict_t _conflict;
+};
+
+Q_DECLARE_METATYPE(TrafficConflictEngine::Track_t)
+Q_DECLARE_METATYPE(TrafficConflictEngine::Conflict_t)
@@ -0,0 +1,124 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TrafficConflictEngineTest.h"
+#include "TrafficConflictEngine.h"
+
+static const QGeoCoordinate kOrigin(47.0, 8.0);
+
+static TrafficConflictEngine::Track_t _track(uint32_t id, bool ownVehicle, const QGeoCoordinate& coordinate, double altitude, double heading, double speed)
+{
+    TrafficConflictEngine::Track_t track;
+
+    track.id            = id;
+    track.ownVehicle    = ownVehicle;
+    track.name          = QString::number(id);
+    track.coordinate    = coordinate;
+    track.altitude      = altitude;
+    track.heading       = heading;
+    track.speed         = speed;
+
+    return track;
+}
+
+void TrafficConflictEngineTest::_headOnTest(void)
+{
+    // Closing at 100 m/s from 3 km, meet in the middle after 30 seconds
+    const TrafficConflictEngine::Track_t own     = _track(1, true, kOrigin, 500, 90, 50);
+    const TrafficConflictEngine::Track_t target  = _track(0xABCDEF, false, kOrigin.atDistanceAndAzimuth(3000, 90), 600, 270, 50);
+
+    QList<TrafficConflictEngine::Conflict_t> conflicts = TrafficConflictEngine::findConflicts({ own }, { target });
+    QCOMPARE(conflicts.count(), 1);
+
+    const TrafficConflictEngine::Conflict_t& conflict = conflicts[0];
+    QCOMPARE(conflict.level, TrafficConflictEngine::LevelWarning);
+    QCOMPARE(conflict.other.id, static_cast<uint32_t>(0xABCDEF));
+    QVERIFY(qAbs(conflict.timeToCpa - 30) < 0.5);
+    QVERIFY(conflict.cpaDistance < 10);
+    QCOMPARE(conflict.verticalSeparation, 100.0);
+    QVERIFY(qAbs(kOrigin.distanceTo(conflict.ownCpa) - 1500) < 10);
+    QVERIFY(conflict.ownCpa.distanceTo(conflict.otherCpa) < 10);
+
+    // Unknown altitude can't rule it out
+    TrafficConflictEngine::Track_t noAltitude = target;
+    noAltitude.altitude = qQNaN();
+    conflicts = TrafficConflictEngine::findConflicts({ own }, { noAltitude });
+    QCOMPARE(conflicts.count(), 1);
+    QCOMPARE(conflicts[0].level, TrafficConflictEngine::LevelWarning);
+
+    // Passing 1 km to the side is only an advisory
+    const TrafficConflictEngine::Track_t offset = _track(2, false, kOrigin.atDistanceAndAzimuth(3000, 90).atDistanceAndAzimuth(1000, 0), 500, 270, 50);
+    conflicts = TrafficConflictEngine::findConflicts({ own }, { offset, target });
+    QCOMPARE(conflicts.count(), 2);
+    QCOMPARE(conflicts[0].level, TrafficConflictEngine::LevelWarning);
+    QCOMPARE(conflicts[1].level, TrafficConflictEngine::LevelAdvisory);
+    QCOMPARE(conflicts[1].other.id, static_cast<uint32_t>(2));
+}
+
+void TrafficConflictEngineTest::_noConflictTest(void)
+{
+    const TrafficConflictEngine::Track_t own = _track(1, true, kOrigin, 500, 0, 50);
+
+    // Parallel 3 km apart
+    QVERIFY(TrafficConflictEngine::findConflicts({ own }, { _track(2, false, kOrigin.atDistanceAndAzimuth(3000, 90), 500, 0, 50) }).isEmpty());
+
+    // Head on but 1000 m above
+    QVERIFY(TrafficConflictEngine::findConflicts({ own }, { _track(3, false, kOrigin.atDistanceAndAzimuth(3000, 0), 1500, 180, 50) }).isEmpty());
+
+    // Moving away faster
+    QVERIFY(TrafficConflictEngine::findConflicts({ own }, { _track(4, false, kOrigin.atDistanceAndAzimuth(2000, 0), 500, 0, 100) }).isEmpty());
+
+    // Too far to close in within the look ahead time
+    QVERIFY(TrafficConflictEngine::findConflicts({ own }, { _track(5, false, kOrigin.atDistanceAndAzimuth(20000, 0), 500, 180, 100) }).isEmpty());
+
+    // Nothing without own vehicles
+    QVERIFY(TrafficConflictEngine::findConflicts({ }, { own }).isEmpty());
+}
+
+void TrafficConflictEngineTest::_ownVehiclesTest(void)
+{
+    // Converging own vehicles, with no speed known for the second one
+    const TrafficConflictEngine::Track_t first   = _track(1, true, kOrigin, 100, 90, 20);
+    const TrafficConflictEngine::Track_t second  = _track(2, true, kOrigin.atDistanceAndAzimuth(400, 90), 110, qQNaN(), qQNaN());
+    const TrafficConflictEngine::Track_t third   = _track(3, true, kOrigin.atDistanceAndAzimuth(10000, 180), 100, 180, 20);
+
+    // Listed once, not once for each of the two
+    const QList<TrafficConflictEngine::Conflict_t> conflicts = TrafficConflictEngine::findConflicts({ first, second, third }, { });
+    QCOMPARE(conflicts.count(), 1);
+    QCOMPARE(conflicts[0].level, TrafficConflictEngine::LevelWarning);
+    QCOMPARE(conflicts[0].ownVehicle.id, static_cast<uint32_t>(1));
+    QCOMPARE(conflicts[0].other.id, static_cast<uint32_t>(2));
+    QVERIFY(conflicts[0].other.ownVehicle);
+    QVERIFY(qAbs(conflicts[0].timeToCpa - 20) < 0.5);
+}
+
+void TrafficConflictEngineTest::_manyTargetsTest(void)
+{
+    QList<TrafficConflictEngine::Track_t> ownVehicles;
+    QList<TrafficConflictEngine::Track_t> traffic;
+
+    // 20 own vehicles 10 km apart, heading north
+    for (int i=0; i<20; i++) {
+        ownVehicles.append(_track(static_cast<uint32_t>(i + 1), true, kOrigin.atDistanceAndAzimuth(i * 10000, 90), 500, 0, 30));
+    }
+
+    // Lots of traffic well south of all of them
+    for (int i=0; i<2000; i++) {
+        const QGeoCoordinate coordinate = kOrigin.atDistanceAndAzimuth(50000 + (i % 40) * 2000, 180 + (i / 40) * 0.5);
+        traffic.append(_track(static_cast<uint32_t>(0x100000 + i), false, coordinate, 3000, i % 360, 200));
+    }
+
+    // And one straight at the tenth vehicle
+    traffic.append(_track(42, false, ownVehicles[9].coordinate.atDistanceAndAzimuth(2000, 0), 500, 180, 30));
+
+    const QList<TrafficConflictEngine::Conflict_t> conflicts = TrafficConflictEngine::findConflicts(ownVehicles, traffic);
+    QCOMPARE(conflicts.count(), 1);
+    QCOMPARE(conflicts[0].ownVehicle.id, static_cast<uint32_t>(10));
+    QCOMPARE(conflicts[0].other.id, static_cast<uint32_t>(42));
+}
@@ -11,6 +11,7 @@
 #include "AirspaceRestriction.h"
 #include "AirMapRulesetsManager.h"
 #include "AirMapManager.h"
+#include "AirspaceGeometryCache.h"
 #include "QGCApplication.h"
 
 #include <cmath>
@@ -59,6 +60,28 @@ adv_sort(QObject* a, QObject* b)
     return static_cast<int>(aa->color()) > static_cast<int>(bb->color());
 }
 
+//-----------------------------------------------------------------------------
+QString
+AirMapAdvisoryManager::_selectedRuleIDs()
+{
+    auto* pRulesMgr = qobject_cast<AirMapRulesetsManager*>(qgcApp()->toolbox()->airspaceManager()->ruleSets());
+    QString ruleIDs;
+    if(pRulesMgr) {
+        for(int rs = 0; rs < pRulesMgr->ruleSets()->count(); rs++) {
+            AirMapRuleSet* ruleSet = qobject_cast<AirMapRuleSet*>(pRulesMgr->ruleSets()->get(rs));
+            //-- If this ruleset is selected
+            if(ruleSet && ruleSet->selected()) {
+                ruleIDs = ruleIDs + ruleSet->id();
+                //-- Separate rules with commas
+                if(rs < pRulesMgr->ruleSets()->count() - 1) {
+                    ruleIDs = ruleIDs + ",";
+                }
+            }
+        }
+    }
+    return ruleIDs;
+}
+
 //-----------------------------------------------------------------------------
 void
 AirMapAdvisoryManager::_requestAdvisories()
@@ -70,6 +93,15 @@ AirMapAdvisoryManager::_requestAdvisories()
         emit advisoryChanged();
         return;
     }
+    //-- Rulesets
+    QString ruleIDs = _selectedRuleIDs();
+    qint64  now     = static_cast<qint64>(qgcApp()->msecsSinceBoot());
+    //-- Rule changes come in bursts while the rulesets load, most of them would ask for what we already have
+    if(_valid && ruleIDs == _searchRuleIDs && now - _searchMsecs < AirspaceGeometryCache::defaultTtlMsecs &&
+       _searchROI.pointNW.distanceTo(_lastROI.pointNW) <= ADVISORY_UPDATE_DISTANCE && _searchROI.pointSE.distanceTo(_lastROI.pointSE) <= ADVISORY_UPDATE_DISTANCE) {
+        qCDebug(AirMapManagerLog) << "Advisories are up to date";
+        return;
+    }
     _valid = false;
     _advisories.clearAndDeleteContents();
     Advisory::Search::Parameters params;
@@ -83,22 +115,6 @@ AirMapAdvisoryManager::_requestAdvisories()
         polygon.outer_ring.coordinates.push_back(coord);
     }
     params.geometry = Geometry(polygon);
-    //-- Rulesets
-    auto* pRulesMgr = qobject_cast<AirMapRulesetsManager*>(qgcApp()->toolbox()->airspaceManager()->ruleSets());
-    QString ruleIDs;
-    if(pRulesMgr) {
-        for(int rs = 0; rs < pRulesMgr->ruleSets()->count(); rs++) {
-            AirMapRuleSet* ruleSet = qobject_cast<AirMapRuleSet*>(pRulesMgr->ruleSets()->get(rs));
-            //-- If this ruleset is selected
-            if(ruleSet && ruleSet->selected()) {
-                ruleIDs = ruleIDs + ruleSet->id();
-                //-- Separate rules with commas
-                if(rs < pRulesMgr->ruleSets()->count() - 1) {
-                    ruleIDs = ruleIDs + ",";
-                }
-            }
-        }
-    }
     if(ruleIDs.isEmpty()) {
         qCDebug(AirMapManagerLog) << "No rules defined. Not updating Advisories";
         _valid = false;
@@ -112,7 +128,8 @@ AirMapAdvisoryManager::_requestAdvisories()
     params.start    = airmap::from_milliseconds_since_epoch(airmap::milliseconds(static_cast<qint64>(start)));
     params.end      = airmap::from_milliseconds_since_epoch(airmap::milliseconds(static_cast<qint64>(end)));
     std::weak_ptr<LifetimeChecker> isAlive(_instance);
-    _shared.client()->advisory().search(params, [this, isAlive](const Advisory::Search::Result& result) {
+    QGCGeoBoundingCube searchROI = _lastROI;
+    _shared.client()->advisory().search(params, [this, isAlive, searchROI, ruleIDs](const Advisory::Search::Result& result) {
         if (!isAlive.lock()) return;
         if (result) {
             qCDebug(AirMapManagerLog) << "Successful advisory search. Items:" << result.value().size();
@@ -133,7 +150,10 @@ AirMapAdvisoryManager::_requestAdvisories()
             _advisories.beginReset();
             std::sort(_advisories.objectList()->begin(), _advisories.objectList()->end(), adv_sort);
             _advisories.endReset();
-            _valid = true;
+            _valid          = true;
+            _searchROI      = searchROI;
+            _searchRuleIDs  = ruleIDs;
+            _searchMsecs    = static_cast<qint64>(qgcApp()->msecsSinceBoot());
         } else {
             QString description = QString::fromStdString(result.error().description() ? result.error().description().get() : "");
             qCDebug(AirMapManagerLog) << "Advisories Request Failed" << QString::fromStdString(result.error().message()) << description;
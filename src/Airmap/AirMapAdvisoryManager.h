@@ -62,10 +62,15 @@ signals:
     void                error               (const QString& what, const QString& airmapdMessage, const QString& airmapdDetails);
 private:
     void                _requestAdvisories  ();
+    QString             _selectedRuleIDs    ();
 private:
     bool                _valid;
     AirMapSharedState&  _shared;
     QGCGeoBoundingCube  _lastROI;
     QmlObjectListModel  _advisories;
     AdvisoryColor       _airspaceColor;
+    //-- Last successful search, repeated searches for the same area and rules are skipped until it gets old
+    QGCGeoBoundingCube  _searchROI;
+    QString             _searchRuleIDs;
+    qint64              _searchMsecs = 0;
 };
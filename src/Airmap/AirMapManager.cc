@@ -74,6 +74,13 @@ AirMapManager::setToolbox(QGCToolbox* toolbox)
     connect(ap->password(),         &Fact::rawValueChanged, this, &AirMapManager::_settingsChanged);
     connect(ap->enableAirspace(),   &Fact::rawValueChanged, this, &AirMapManager::_airspaceEnabled);
     connect(&_settingsTimer,        &QTimer::timeout,       this, &AirMapManager::_settingsTimeout);
+}
+
+//-----------------------------------------------------------------------------
+void
+AirMapManager::deferredInit()
+{
+    //-- Logging in talks to the AirMap servers, which the first frame shouldn't wait for
     _settingsTimeout();
 }
 
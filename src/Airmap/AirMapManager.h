@@ -38,6 +38,7 @@ public:
     virtual ~AirMapManager() override;
 
     void setToolbox (QGCToolbox* toolbox) override;
+    void deferredInit(void) override;
 
     QString                         providerName                            () const override { return QString("AirMap"); }
     AirspaceVehicleManager*         instantiateVehicle                      (const Vehicle& vehicle) override;
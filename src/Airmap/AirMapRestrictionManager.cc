@@ -29,23 +29,73 @@ void
 AirMapRestrictionManager::setROI(const QGCGeoBoundingCube& roi, bool reset)
 {
     if(qgcApp()->toolbox()->settingsManager()->airMapSettings()->enableAirspace()->rawValue().toBool()) {
-        //-- If first time or we've moved more than RESTRICTION_UPDATE_DISTANCE, ask for updates.
+        //-- If first time or we've moved more than RESTRICTION_UPDATE_DISTANCE, update.
         if(reset ||
           (!_lastROI.isValid() || _lastROI.pointNW.distanceTo(roi.pointNW) > RESTRICTION_UPDATE_DISTANCE || _lastROI.pointSE.distanceTo(roi.pointSE) > RESTRICTION_UPDATE_DISTANCE) ||
            (_polygons.count() == 0 && _circles.count() == 0)) {
             //-- Limit area of interest
             qCDebug(AirMapManagerLog) << "ROI Area:" << roi.area() << "km^2";
+            _lastROI = roi;
             if(roi.area() < qgcApp()->toolbox()->airspaceManager()->maxAreaOfInterest()) {
-                _lastROI = roi;
-                _requestRestrictions(roi);
+                qint64 now = static_cast<qint64>(qgcApp()->msecsSinceBoot());
+                _cache.expire(now);
+                //-- Show what is cached right away, then download what is missing
+                _updateVisible();
+                _requestRestrictions(_cache.missingTiles(roi, now));
             } else {
-                _polygons.clear();
-                _circles.clear();
+                _clearVisible();
             }
         }
     }
 }
 
+//-----------------------------------------------------------------------------
+void
+AirMapRestrictionManager::_clearVisible()
+{
+    _polygons.clear();
+    _circles.clear();
+    for (QObject* object : _restrictionObjects) {
+        object->deleteLater();
+    }
+    _restrictionObjects.clear();
+}
+
+//-----------------------------------------------------------------------------
+void
+AirMapRestrictionManager::_updateVisible()
+{
+    //-- Objects which are still in view are kept, so the map only has to add and remove the difference
+    int                         lod = AirspaceGeometryCache::lodForArea(_lastROI);
+    QHash<QString, QObject*>    restrictionObjects;
+    QObjectList                 polygons;
+    QObjectList                 circles;
+    for (const AirspaceGeometryCache::Airspace_t* airspace : _cache.visible(_lastROI)) {
+        QString     key     = airspace->circle ? airspace->key : QStringLiteral("%1/%2").arg(airspace->key).arg(lod);
+        QObject*    object  = _restrictionObjects.take(key);
+        if (!object) {
+            if (airspace->circle) {
+                object = new AirspaceCircularRestriction(airspace->center, airspace->radius, airspace->id, airspace->color, airspace->lineColor, airspace->lineWidth);
+            } else {
+                QVariantList polygonArray;
+                polygonArray.reserve(airspace->lods[lod].count());
+                for (const QGeoCoordinate& coord : airspace->lods[lod]) {
+                    polygonArray.append(QVariant::fromValue(coord));
+                }
+                object = new AirspacePolygonRestriction(polygonArray, airspace->id, airspace->color, airspace->lineColor, airspace->lineWidth);
+            }
+        }
+        restrictionObjects[key] = object;
+        (airspace->circle ? circles : polygons).append(object);
+    }
+    _polygons.updateObjectList(polygons);
+    _circles.updateObjectList(circles);
+    //-- What is left went out of view
+    for (QObject* object : _restrictionObjects) {
+        object->deleteLater();
+    }
+    _restrictionObjects = restrictionObjects;
+}
 
 //-----------------------------------------------------------------------------
 void
@@ -135,26 +185,37 @@ AirMapRestrictionManager::_getColor(const Airspace& airspace, QColor& color, QCo
 
 //-----------------------------------------------------------------------------
 void
-AirMapRestrictionManager::_requestRestrictions(const QGCGeoBoundingCube& roi)
+AirMapRestrictionManager::_requestRestrictions(const QList<AirspaceGeometryCache::TileKey_t>& tiles)
 {
+    if (tiles.isEmpty()) {
+        return;
+    }
     if (!_shared.client()) {
         qCDebug(AirMapManagerLog) << "No AirMap client instance. Not updating Airspace";
         return;
     }
     if (_state != State::Idle) {
-        qCWarning(AirMapManagerLog) << "AirMapRestrictionManager::updateROI: state not idle";
+        //-- Picked up once the current request is done
+        _roiChangedDuringRequest = true;
         return;
     }
-    qCDebug(AirMapManagerLog) << "Restrictions Request (ROI Changed)";
-    _polygons.clear();
-    _circles.clear();
+    qCDebug(AirMapManagerLog) << "Restrictions Request (ROI Changed). Tiles:" << tiles.count();
     _state = State::RetrieveItems;
+    _roiChangedDuringRequest = false;
     Airspaces::Search::Parameters params;
     params.full = false;
     params.date_time = Clock::universal_time();
-    //-- Geometry: Polygon
+    //-- Geometry: Polygon around the missing tiles
+    QGCGeoBoundingCube bounds = _cache.tileBounds(tiles);
+    QList<QGeoCoordinate> corners = {
+        bounds.pointNW,
+        QGeoCoordinate(bounds.pointNW.latitude(), bounds.pointSE.longitude()),
+        bounds.pointSE,
+        QGeoCoordinate(bounds.pointSE.latitude(), bounds.pointNW.longitude()),
+        bounds.pointNW,
+    };
     Geometry::Polygon polygon;
-    for (const auto& qcoord : roi.polygon2D()) {
+    for (const auto& qcoord : corners) {
         Geometry::Coordinate coord;
         coord.latitude  = qcoord.latitude();
         coord.longitude = qcoord.longitude();
@@ -163,12 +224,13 @@ AirMapRestrictionManager::_requestRestrictions(const QGCGeoBoundingCube& roi)
     params.geometry = Geometry(polygon);
     std::weak_ptr<LifetimeChecker> isAlive(_instance);
     _shared.client()->airspaces().search(params,
-            [this, isAlive](const Airspaces::Search::Result& result) {
+            [this, isAlive, tiles](const Airspaces::Search::Result& result) {
         if (!isAlive.lock()) return;
         if (_state != State::RetrieveItems) return;
         if (result) {
             const std::vector<Airspace>& airspaces = result.value();
             qCDebug(AirMapManagerLog)<<"Successful search. Items:" << airspaces.size();
+            QList<AirspaceGeometryCache::Airspace_t> cacheAirspaces;
             for (const auto& airspace : airspaces) {
                 QColor color;
                 QColor lineColor;
@@ -178,19 +240,27 @@ AirMapRestrictionManager::_requestRestrictions(const QGCGeoBoundingCube& roi)
                 switch(geometry.type()) {
                     case Geometry::Type::polygon: {
                         const Geometry::Polygon& polygon = geometry.details_for_polygon();
-                        _addPolygonToList(polygon, QString::fromStdString(airspace.id()), color, lineColor, lineWidth);
+                        _addPolygonToList(polygon, QString::fromStdString(airspace.id()), color, lineColor, lineWidth, cacheAirspaces);
                     }
                         break;
                     case Geometry::Type::multi_polygon: {
                         const Geometry::MultiPolygon& multiPolygon = geometry.details_for_multi_polygon();
                         for (const auto& polygon : multiPolygon) {
-                            _addPolygonToList(polygon, QString::fromStdString(airspace.id()), color, lineColor, lineWidth);
+                            _addPolygonToList(polygon, QString::fromStdString(airspace.id()), color, lineColor, lineWidth, cacheAirspaces);
                         }
                     }
                         break;
                     case Geometry::Type::point: {
                         const Geometry::Point& point = geometry.details_for_point();
-                        _circles.append(new AirspaceCircularRestriction(QGeoCoordinate(point.latitude, point.longitude), 0., QString::fromStdString(airspace.id()), color, lineColor, lineWidth));
+                        AirspaceGeometryCache::Airspace_t circle = {};
+                        circle.id           = QString::fromStdString(airspace.id());
+                        circle.color        = color;
+                        circle.lineColor    = lineColor;
+                        circle.lineWidth    = lineWidth;
+                        circle.circle       = true;
+                        circle.center       = QGeoCoordinate(point.latitude, point.longitude);
+                        circle.radius       = 0.;
+                        cacheAirspaces.append(circle);
                         // TODO: radius???
                     }
                         break;
@@ -203,20 +273,34 @@ AirMapRestrictionManager::_requestRestrictions(const QGCGeoBoundingCube& roi)
                         break;
                 }
             }
+            _cache.addTiles(tiles, cacheAirspaces, static_cast<qint64>(qgcApp()->msecsSinceBoot()));
+            qCDebug(AirMapManagerLog) << "Cached tiles:" << _cache.tileCount() << "airspaces:" << _cache.airspaceCount();
+            //-- Downloaded airspaces may have changed, so all the map objects are made again
+            _clearVisible();
+            _updateVisible();
         } else {
             QString description = QString::fromStdString(result.error().description() ? result.error().description().get() : "");
             emit error("Failed to retrieve Geofences",
                     QString::fromStdString(result.error().message()), description);
         }
         _state = State::Idle;
+        if (_roiChangedDuringRequest) {
+            _roiChangedDuringRequest = false;
+            _requestRestrictions(_cache.missingTiles(_lastROI, static_cast<qint64>(qgcApp()->msecsSinceBoot())));
+        }
     });
 }
 
 //-----------------------------------------------------------------------------
 void
-AirMapRestrictionManager::_addPolygonToList(const airmap::Geometry::Polygon& polygon, const QString advisoryID, const QColor color, const QColor lineColor, float lineWidth)
+AirMapRestrictionManager::_addPolygonToList(const airmap::Geometry::Polygon& polygon, const QString advisoryID, const QColor color, const QColor lineColor, float lineWidth, QList<AirspaceGeometryCache::Airspace_t>& airspaces)
 {
-    QVariantList polygonArray;
+    AirspaceGeometryCache::Airspace_t airspace = {};
+    airspace.id         = advisoryID;
+    airspace.color      = color;
+    airspace.lineColor  = lineColor;
+    airspace.lineWidth  = lineWidth;
+    airspace.circle     = false;
     for (const auto& vertex : polygon.outer_ring.coordinates) {
         QGeoCoordinate coord;
         if (vertex.altitude) {
@@ -224,9 +308,9 @@ AirMapRestrictionManager::_addPolygonToList(const airmap::Geometry::Polygon& pol
         } else {
             coord = QGeoCoordinate(vertex.latitude, vertex.longitude);
         }
-        polygonArray.append(QVariant::fromValue(coord));
+        airspace.polygon.append(coord);
     }
-    _polygons.append(new AirspacePolygonRestriction(polygonArray, advisoryID, color, lineColor, lineWidth));
+    airspaces.append(airspace);
     if (polygon.inner_rings.size() > 0) {
         // no need to support those (they are rare, and in most cases, there's a more restrictive polygon filling the hole)
         qCDebug(AirMapManagerLog) << "Polygon with holes. Size: "<<polygon.inner_rings.size();
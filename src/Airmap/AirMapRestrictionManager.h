@@ -12,8 +12,10 @@
 #include "LifetimeChecker.h"
 #include "AirspaceRestrictionProvider.h"
 #include "AirMapSharedState.h"
+#include "AirspaceGeometryCache.h"
 #include "QGCGeoBoundingCube.h"
 
+#include <QHash>
 #include <QList>
 #include <QGeoCoordinate>
 
@@ -22,7 +24,8 @@
 
 /**
  * @file AirMapRestrictionManager.h
- * Class to download polygons from AirMap
+ * Class to download polygons from AirMap. Downloads are kept in a tile cache, so panning around only downloads the
+ * tiles which haven't been seen yet, and only the airspaces which are in view are given to the map.
  */
 
 class AirMapRestrictionManager : public AirspaceRestrictionProvider, public LifetimeChecker
@@ -33,24 +36,30 @@ public:
     QmlObjectListModel* polygons        () override { return &_polygons; }
     QmlObjectListModel* circles         () override { return &_circles; }
     void                setROI          (const QGCGeoBoundingCube &roi, bool reset = false) override;
+    QStringList         airspacesAlongPath(const QList<QGeoCoordinate>& path) override { return _cache.intersectingIds(path); }
 
 signals:
     void error                          (const QString& what, const QString& airmapdMessage, const QString& airmapdDetails);
 
 private:
-    void            _requestRestrictions(const QGCGeoBoundingCube& roi);
-    void            _addPolygonToList   (const airmap::Geometry::Polygon& polygon, const QString advisoryID, const QColor color, const QColor lineColor, float lineWidth);
+    void            _requestRestrictions(const QList<AirspaceGeometryCache::TileKey_t>& tiles);
+    void            _addPolygonToList   (const airmap::Geometry::Polygon& polygon, const QString advisoryID, const QColor color, const QColor lineColor, float lineWidth, QList<AirspaceGeometryCache::Airspace_t>& airspaces);
     void            _getColor           (const airmap::Airspace& airspace, QColor &color, QColor &lineColor, float &lineWidth);
+    void            _updateVisible      (void);
+    void            _clearVisible       (void);
 
     enum class State {
         Idle,
         RetrieveItems,
     };
 
-    AirMapSharedState&  _shared;
-    QGCGeoBoundingCube  _lastROI;
-    State               _state = State::Idle;
-    QmlObjectListModel  _polygons;
-    QmlObjectListModel  _circles;
+    AirMapSharedState&          _shared;
+    QGCGeoBoundingCube          _lastROI;
+    State                       _state = State::Idle;
+    QmlObjectListModel          _polygons;
+    QmlObjectListModel          _circles;
+    AirspaceGeometryCache       _cache;
+    QHash<QString, QObject*>    _restrictionObjects;                ///< Objects in _polygons and _circles by cache key and level of detail
+    bool                        _roiChangedDuringRequest = false;
 };
 
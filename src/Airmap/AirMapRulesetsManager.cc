@@ -10,9 +10,12 @@
 #include "AirspaceFlightPlanProvider.h"
 #include "AirMapRulesetsManager.h"
 #include "AirMapManager.h"
+#include "AirspaceGeometryCache.h"
 #include "QGCApplication.h"
 #include <QSettings>
 
+#define RULESETS_UPDATE_DISTANCE    2000    //-- Rulesets follow jurisdictions, they don't change over short distances
+
 using namespace airmap;
 
 static const char* kAirMapFeatureGroup = "AirMapFeatureGroup";
@@ -227,7 +230,6 @@ rules_sort(QObject* a, QObject* b)
 //-----------------------------------------------------------------------------
 void AirMapRulesetsManager::setROI(const QGCGeoBoundingCube& roi, bool reset)
 {
-    Q_UNUSED(reset);
     if (!_shared.client()) {
         qCDebug(AirMapManagerLog) << "No AirMap client instance. Not updating Airspace";
         return;
@@ -236,6 +238,12 @@ void AirMapRulesetsManager::setROI(const QGCGeoBoundingCube& roi, bool reset)
         qCWarning(AirMapManagerLog) << "AirMapRulesetsManager::updateROI: state not idle";
         return;
     }
+    //-- Not QGCGeoBoundingCube::center(), which needs an altitude
+    QGeoCoordinate center((roi.pointNW.latitude() + roi.pointSE.latitude()) / 2.0, (roi.pointNW.longitude() + roi.pointSE.longitude()) / 2.0);
+    if (!reset && _valid && static_cast<qint64>(qgcApp()->msecsSinceBoot()) - _searchMsecs < AirspaceGeometryCache::defaultTtlMsecs &&
+        _searchCenter.isValid() && _searchCenter.distanceTo(center) <= RULESETS_UPDATE_DISTANCE) {
+        return;
+    }
     qCDebug(AirMapManagerLog) << "Rulesets Request (ROI Changed)";
     _valid = false;
     //-- Save current selection state
@@ -259,7 +267,7 @@ void AirMapRulesetsManager::setROI(const QGCGeoBoundingCube& roi, bool reset)
     params.geometry = Geometry(polygon);
     std::weak_ptr<LifetimeChecker> isAlive(_instance);
     _shared.client()->rulesets().search(params,
-            [this, isAlive, selectionSet](const RuleSets::Search::Result& result) {
+            [this, isAlive, selectionSet, center](const RuleSets::Search::Result& result) {
         if (!isAlive.lock()) return;
         if (_state != State::RetrieveItems) return;
         if (result) {
@@ -338,7 +346,9 @@ void AirMapRulesetsManager::setROI(const QGCGeoBoundingCube& roi, bool reset)
                 }
                 */
             }
-            _valid = true;
+            _valid          = true;
+            _searchCenter   = center;
+            _searchMsecs    = static_cast<qint64>(qgcApp()->msecsSinceBoot());
         } else {
             QString description = QString::fromStdString(result.error().description() ? result.error().description().get() : "");
             emit error("Failed to retrieve RuleSets", QString::fromStdString(result.error().message()), description);
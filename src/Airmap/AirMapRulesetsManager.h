@@ -127,6 +127,8 @@ private:
     State                           _state = State::Idle;
     AirMapSharedState&              _shared;
     QmlObjectListModel              _ruleSets;  //-- List of AirMapRuleSet elements
+    QGeoCoordinate                  _searchCenter;      ///< Center of the last successful search
+    qint64                          _searchMsecs = 0;
 };
 
 
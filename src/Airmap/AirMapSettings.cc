@@ -26,3 +26,4 @@ DECLARE_SETTINGSFACT(AirMapSettings, password)
 DECLARE_SETTINGSFACT(AirMapSettings, enableAirMap)
 DECLARE_SETTINGSFACT(AirMapSettings, enableAirspace)
 DECLARE_SETTINGSFACT(AirMapSettings, enableTelemetry)
+DECLARE_SETTINGSFACT(AirMapSettings, telemetryRate)
@@ -27,5 +27,6 @@ public:
     DEFINE_SETTINGFACT(enableAirMap)
     DEFINE_SETTINGFACT(enableAirspace)
     DEFINE_SETTINGFACT(enableTelemetry)
+    DEFINE_SETTINGFACT(telemetryRate)
 
 };
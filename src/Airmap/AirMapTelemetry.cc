@@ -9,9 +9,14 @@
 
 #include "AirMapTelemetry.h"
 #include "AirMapManager.h"
+#include "QGCApplication.h"
+#include "SettingsManager.h"
 
 #include "QGCMAVLink.h"
 
+#include <QtMath>
+#include <cmath>
+
 #include "airmap/telemetry.h"
 #include "airmap/flights.h"
 
@@ -21,6 +26,15 @@ using namespace airmap;
 AirMapTelemetry::AirMapTelemetry(AirMapSharedState& shared)
     : _shared(shared)
 {
+    connect(qgcApp()->toolbox()->settingsManager()->airMapSettings()->telemetryRate(), &Fact::rawValueChanged, this, &AirMapTelemetry::_telemetryRateChanged);
+    _telemetryRateChanged();
+}
+
+//-----------------------------------------------------------------------------
+void
+AirMapTelemetry::_telemetryRateChanged()
+{
+    _shaper.setRate(qgcApp()->toolbox()->settingsManager()->airMapSettings()->telemetryRate()->rawValue().toDouble());
 }
 
 //-----------------------------------------------------------------------------
@@ -34,6 +48,9 @@ AirMapTelemetry::vehicleMessageReceived(const mavlink_message_t& message)
     case MAVLINK_MSG_ID_GPS_RAW_INT:
         _handleGPSRawInt(message);
         break;
+    case MAVLINK_MSG_ID_ATTITUDE:
+        _handleAttitude(message);
+        break;
     }
 }
 
@@ -62,19 +79,38 @@ AirMapTelemetry::_handleGPSRawInt(const mavlink_message_t& message)
 
 //-----------------------------------------------------------------------------
 void
-AirMapTelemetry::_handleGlobalPositionInt(const mavlink_message_t& message)
+AirMapTelemetry::_handleAttitude(const mavlink_message_t& message)
 {
     if (!isTelemetryStreaming()) {
         return;
     }
-    // rate-limit updates to 5 Hz
-    if (!_timerLastSent.hasExpired(200)) {
+    mavlink_attitude_t attitude;
+    mavlink_msg_attitude_decode(&message, &attitude);
+    _lastYaw    = qRadiansToDegrees(attitude.yaw);
+    _lastPitch  = qRadiansToDegrees(attitude.pitch);
+    _lastRoll   = qRadiansToDegrees(attitude.roll);
+    _attitudeTimer.start();
+}
+
+//-----------------------------------------------------------------------------
+void
+AirMapTelemetry::_handleGlobalPositionInt(const mavlink_message_t& message)
+{
+    if (!isTelemetryStreaming()) {
         return;
     }
-    _timerLastSent.restart();
-
     mavlink_global_position_int_t globalPosition;
     mavlink_msg_global_position_int_decode(&message, &globalPosition);
+
+    //-- Rate limit, and hold back positions of a vehicle which isn't going anywhere
+    QGeoCoordinate coordinate(globalPosition.lat / 1e7, globalPosition.lon / 1e7, globalPosition.alt / 1000.0);
+    double vx = globalPosition.vx / 100.0;
+    double vy = globalPosition.vy / 100.0;
+    double vz = globalPosition.vz / 100.0;
+    double speed = std::sqrt(vx * vx + vy * vy + vz * vz);
+    if (!_shaper.send(static_cast<qint64>(qgcApp()->msecsSinceBoot()), coordinate, speed)) {
+        return;
+    }
     Telemetry::Position position{
         milliseconds_since_epoch(Clock::universal_time()),
         static_cast<double>(globalPosition.lat / 1e7),
@@ -93,8 +129,20 @@ AirMapTelemetry::_handleGlobalPositionInt(const mavlink_message_t& message)
     //qCDebug(AirMapManagerLog) << "Telemetry:" << globalPosition.lat / 1e7 << globalPosition.lon / 1e7;
     Flight flight;
     flight.id = _flightID.toStdString();
-    _shared.client()->telemetry().submit_updates(flight, _key,
-        {Telemetry::Update{position}, Telemetry::Update{speed}});
+    //-- All the updates go out in one encrypted packet, the SDK encodes it on its own thread
+    if (_attitudeTimer.isValid() && !_attitudeTimer.hasExpired(_attitudeTimeoutMsecs)) {
+        Telemetry::Attitude attitude{
+            position.timestamp,
+            _lastYaw,
+            _lastPitch,
+            _lastRoll
+        };
+        _shared.client()->telemetry().submit_updates(flight, _key,
+            {Telemetry::Update{position}, Telemetry::Update{speed}, Telemetry::Update{attitude}});
+    } else {
+        _shared.client()->telemetry().submit_updates(flight, _key,
+            {Telemetry::Update{position}, Telemetry::Update{speed}});
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -129,7 +177,8 @@ AirMapTelemetry::startTelemetryStream(const QString& flightID)
                     QString::fromStdString(result.error().message()), description);
         }
     });
-    _timerLastSent.start();
+    _shaper.reset();
+    _attitudeTimer.invalidate();
 }
 
 //-----------------------------------------------------------------------------
@@ -140,6 +189,7 @@ AirMapTelemetry::stopTelemetryStream()
         return;
     }
     qCInfo(AirMapManagerLog) << "Stopping Telemetry stream with flightID" << _flightID;
+    qCDebug(AirMapManagerLog) << "Telemetry positions sent:" << _shaper.sentCount() << "held back:" << _shaper.suppressedCount();
     _state = State::EndCommunication;
     Flights::EndFlightCommunications::Parameters params;
     params.authorization = _shared.loginToken().toStdString();
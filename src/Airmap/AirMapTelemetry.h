@@ -11,13 +11,15 @@
 
 #include "LifetimeChecker.h"
 #include "AirMapSharedState.h"
+#include "AirMapTelemetryShaper.h"
 
 #include <QGCMAVLink.h>
 
 #include <QObject>
 #include <QElapsedTimer>
 
-/// Class to send telemetry data to AirMap
+/// Class to send telemetry data to AirMap. Positions go through AirMapTelemetryShaper, each one that is sent carries
+/// the speed and the latest attitude in the same packet.
 class AirMapTelemetry : public QObject, public LifetimeChecker
 {
     Q_OBJECT
@@ -35,10 +37,14 @@ signals:
 public slots:
     void vehicleMessageReceived     (const mavlink_message_t& message);
 
+private slots:
+    void _telemetryRateChanged      ();
+
 private:
 
     void _handleGlobalPositionInt   (const mavlink_message_t& message);
     void _handleGPSRawInt           (const mavlink_message_t& message);
+    void _handleAttitude            (const mavlink_message_t& message);
 
     enum class State {
         Idle,
@@ -52,6 +58,12 @@ private:
     std::string             _key; ///< key for AES encryption (16 bytes)
     QString                 _flightID;
     float                   _lastHdop = 1.f;
-    QElapsedTimer           _timerLastSent;
+    AirMapTelemetryShaper   _shaper;
+    float                   _lastYaw = 0.f;         ///< Degrees
+    float                   _lastPitch = 0.f;
+    float                   _lastRoll = 0.f;
+    QElapsedTimer           _attitudeTimer;         ///< Since the last attitude, invalid until the first one
+
+    static const int        _attitudeTimeoutMsecs = 1000;   ///< Older attitudes aren't sent
 };
 
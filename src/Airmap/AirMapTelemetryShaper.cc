@@ -0,0 +1,54 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "AirMapTelemetryShaper.h"
+
+#include <cmath>
+
+void AirMapTelemetryShaper::setRate(double rateHz)
+{
+    _intervalMsecs = rateHz > 0 ? static_cast<int>(1000.0 / rateHz) : 0;
+}
+
+void AirMapTelemetryShaper::reset(void)
+{
+    _lastSentMsecs      = -1;
+    _lastSentCoordinate = QGeoCoordinate();
+    _sentCount          = 0;
+    _suppressedCount    = 0;
+}
+
+bool AirMapTelemetryShaper::send(qint64 nowMsecs, const QGeoCoordinate& coordinate, double speed)
+{
+    if (_lastSentMsecs != -1) {
+        qint64 elapsedMsecs = nowMsecs - _lastSentMsecs;
+
+        if (elapsedMsecs < _intervalMsecs) {
+            _suppressedCount++;
+            return false;
+        }
+
+        // Only the distance to the last sent position counts, so a slow drift is still sent once it adds up
+        if (_lastSentCoordinate.isValid() && coordinate.isValid() && speed < stationarySpeed && elapsedMsecs < stationaryIntervalMsecs) {
+            double altitudeChange = 0;
+            if (!std::isnan(coordinate.altitude()) && !std::isnan(_lastSentCoordinate.altitude())) {
+                altitudeChange = std::fabs(coordinate.altitude() - _lastSentCoordinate.altitude());
+            }
+            if (_lastSentCoordinate.distanceTo(coordinate) < stationaryDistanceMeters && altitudeChange < stationaryDistanceMeters) {
+                _suppressedCount++;
+                return false;
+            }
+        }
+    }
+
+    _lastSentMsecs      = nowMsecs;
+    _lastSentCoordinate = coordinate;
+    _sentCount++;
+    return true;
+}
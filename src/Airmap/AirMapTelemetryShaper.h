@@ -0,0 +1,45 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QGeoCoordinate>
+
+/// Decides which vehicle positions are worth sending to AirMap. Positions are limited to the configured rate, and a
+/// vehicle which isn't moving is only reported every stationaryIntervalMsecs to keep the flight alive.
+///
+/// Times are passed in by the caller, msecs on any monotonic clock.
+class AirMapTelemetryShaper
+{
+public:
+    AirMapTelemetryShaper(void) = default;
+
+    /// @param rateHz Positions per second while moving, 0 or less for no limit
+    void setRate(double rateHz);
+
+    /// @param speed Ground speed, m/s
+    /// @return true: position should be sent
+    bool send(qint64 nowMsecs, const QGeoCoordinate& coordinate, double speed);
+
+    void reset(void);
+
+    quint64 sentCount       (void) const { return _sentCount; }
+    quint64 suppressedCount (void) const { return _suppressedCount; }
+
+    static const int        stationaryIntervalMsecs     = 5000;
+    static constexpr double stationaryDistanceMeters    = 1.0;  ///< Movement since the last sent position, including altitude
+    static constexpr double stationarySpeed             = 0.3;  ///< m/s
+
+private:
+    int             _intervalMsecs      = 0;
+    qint64          _lastSentMsecs      = -1;
+    QGeoCoordinate  _lastSentCoordinate;
+    quint64         _sentCount          = 0;
+    quint64         _suppressedCount    = 0;
+};
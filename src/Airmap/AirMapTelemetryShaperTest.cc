@@ -0,0 +1,72 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "AirMapTelemetryShaperTest.h"
+#include "AirMapTelemetryShaper.h"
+
+void AirMapTelemetryShaperTest::_rateTest(void)
+{
+    AirMapTelemetryShaper   shaper;
+    QGeoCoordinate          coordinate(47.6, -122.1, 100);
+
+    // 50Hz positions of a vehicle at 10 m/s, sent at 5Hz
+    shaper.setRate(5);
+    int sent = 0;
+    for (int i=0; i<50; i++) {
+        if (shaper.send(i * 20, coordinate.atDistanceAndAzimuth(i * 0.2, 90), 10)) {
+            sent++;
+        }
+    }
+    QCOMPARE(sent, 5);
+    QCOMPARE(shaper.sentCount(), static_cast<quint64>(5));
+    QCOMPARE(shaper.suppressedCount(), static_cast<quint64>(45));
+
+    // No limit
+    shaper.reset();
+    shaper.setRate(0);
+    for (int i=0; i<10; i++) {
+        QVERIFY(shaper.send(i, coordinate.atDistanceAndAzimuth(i * 10, 90), 10));
+    }
+}
+
+void AirMapTelemetryShaperTest::_stationaryTest(void)
+{
+    AirMapTelemetryShaper   shaper;
+    QGeoCoordinate          coordinate(47.6, -122.1, 100);
+
+    shaper.setRate(5);
+    QVERIFY(shaper.send(0, coordinate, 0));
+
+    // Sitting on the pad only goes out as a keep alive
+    int sent = 0;
+    for (qint64 msecs=200; msecs<=20000; msecs+=200) {
+        if (shaper.send(msecs, coordinate.atDistanceAndAzimuth(0.1, 0), 0.05)) {
+            sent++;
+        }
+    }
+    QCOMPARE(sent, 20000 / AirMapTelemetryShaper::stationaryIntervalMsecs);
+
+    // Taking off is sent right away
+    QVERIFY(shaper.send(20200, coordinate.atDistanceAndAzimuth(0.1, 0), 1));
+    QVERIFY(shaper.send(20400, QGeoCoordinate(coordinate.latitude(), coordinate.longitude(), coordinate.altitude() + 2), 0.1));
+}
+
+void AirMapTelemetryShaperTest::_driftTest(void)
+{
+    AirMapTelemetryShaper   shaper;
+    QGeoCoordinate          coordinate(47.6, -122.1, 100);
+
+    shaper.setRate(5);
+    QVERIFY(shaper.send(0, coordinate, 0));
+
+    // Slow creep below the stationary speed is sent once it moved far enough
+    QVERIFY(!shaper.send(200, coordinate.atDistanceAndAzimuth(0.5, 0), 0.2));
+    QVERIFY(!shaper.send(400, coordinate.atDistanceAndAzimuth(0.9, 0), 0.2));
+    QVERIFY(shaper.send(600, coordinate.atDistanceAndAzimuth(1.5, 0), 0.2));
+}
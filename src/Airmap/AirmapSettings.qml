@@ -92,6 +92,20 @@ Item {
                             enabled:    _airMapEnabled
                             property Fact _enableTelemetryFact: QGroundControl.settingsManager.airMapSettings.enableTelemetry
                         }
+                        Row {
+                            spacing:    ScreenTools.defaultFontPixelWidth
+                            visible:    _telemetryRateFact.visible
+                            property Fact _telemetryRateFact: QGroundControl.settingsManager.airMapSettings.telemetryRate
+                            QGCLabel {
+                                text:                   qsTr("Telemetry Rate")
+                                anchors.verticalCenter: parent.verticalCenter
+                            }
+                            FactTextField {
+                                fact:       parent._telemetryRateFact
+                                width:      _editFieldWidth * 0.5
+                                enabled:    _airMapEnabled && QGroundControl.settingsManager.airMapSettings.enableTelemetry.rawValue
+                            }
+                        }
                         FactCheckBox {
                             text:       qsTr("Show Airspace on Map (Experimental)")
                             fact:       _enableAirspaceFact
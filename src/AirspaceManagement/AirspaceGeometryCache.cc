@@ -0,0 +1,413 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "AirspaceGeometryCache.h"
+#include "QGCGeo.h"
+
+#include <QSet>
+#include <QtMath>
+
+#include <algorithm>
+#include <cmath>
+
+/// Simplification tolerance of each level of detail
+static const double _lodToleranceMeters[AirspaceGeometryCache::lodCount] = { 0, 25, 150, 750 };
+
+/// Map area width per meter of simplification tolerance, roughly the width of the map in pixels
+static const double _areaWidthPerToleranceMeter = 2000;
+
+static const double _metersPerDegreeLatitude = 111320;
+
+/// The areas only need valid corners, altitude isn't used
+static bool _areaValid(const QGCGeoBoundingCube& area)
+{
+    return area.pointNW.isValid() && area.pointSE.isValid();
+}
+
+AirspaceGeometryCache::AirspaceGeometryCache(double tileSizeDegrees, qint64 ttlMsecs)
+    : _tileSizeDegrees  (tileSizeDegrees)
+    , _ttlMsecs         (ttlMsecs)
+{
+
+}
+
+QList<AirspaceGeometryCache::TileKey_t> AirspaceGeometryCache::tiles(const QGCGeoBoundingCube& area) const
+{
+    QList<TileKey_t> tileKeys;
+    if (!_areaValid(area)) {
+        return tileKeys;
+    }
+
+    int west    = static_cast<int>(std::floor((area.pointNW.longitude() + 180) / _tileSizeDegrees));
+    int east    = static_cast<int>(std::floor((area.pointSE.longitude() + 180) / _tileSizeDegrees));
+    int north   = static_cast<int>(std::floor((area.pointNW.latitude() + 90) / _tileSizeDegrees));
+    int south   = static_cast<int>(std::floor((area.pointSE.latitude() + 90) / _tileSizeDegrees));
+
+    for (int y=south; y<=north; y++) {
+        for (int x=west; x<=east; x++) {
+            tileKeys.append(_tileKey(x, y));
+        }
+    }
+    return tileKeys;
+}
+
+QList<AirspaceGeometryCache::TileKey_t> AirspaceGeometryCache::missingTiles(const QGCGeoBoundingCube& area, qint64 nowMsecs) const
+{
+    QList<TileKey_t> missing;
+
+    for (TileKey_t tileKey: tiles(area)) {
+        auto it = _tiles.constFind(tileKey);
+        if (it == _tiles.constEnd() || nowMsecs - it->fetchedMsecs > _ttlMsecs) {
+            missing.append(tileKey);
+        }
+    }
+    return missing;
+}
+
+void AirspaceGeometryCache::_tileBox(TileKey_t tileKey, double& north, double& south, double& east, double& west) const
+{
+    int x = static_cast<int>(tileKey & 0xFFFFFFFF);
+    int y = static_cast<int>(tileKey >> 32);
+
+    west    = x * _tileSizeDegrees - 180;
+    east    = west + _tileSizeDegrees;
+    south   = y * _tileSizeDegrees - 90;
+    north   = south + _tileSizeDegrees;
+}
+
+QGCGeoBoundingCube AirspaceGeometryCache::tileBounds(const QList<TileKey_t>& tileKeys) const
+{
+    if (tileKeys.isEmpty()) {
+        return QGCGeoBoundingCube();
+    }
+
+    double north = -90, south = 90, east = -180, west = 180;
+    for (TileKey_t tileKey: tileKeys) {
+        double tileNorth, tileSouth, tileEast, tileWest;
+        _tileBox(tileKey, tileNorth, tileSouth, tileEast, tileWest);
+        north   = qMax(north, tileNorth);
+        south   = qMin(south, tileSouth);
+        east    = qMax(east, tileEast);
+        west    = qMin(west, tileWest);
+    }
+    return QGCGeoBoundingCube(QGeoCoordinate(qMin(north, 90.0), qMax(west, -180.0)), QGeoCoordinate(qMax(south, -90.0), qMin(east, 180.0)));
+}
+
+void AirspaceGeometryCache::_setBounds(Airspace_t& airspace)
+{
+    if (airspace.circle) {
+        double latitudeRadius   = airspace.radius / _metersPerDegreeLatitude;
+        double longitudeRadius  = latitudeRadius / qMax(std::cos(qDegreesToRadians(airspace.center.latitude())), 0.01);
+
+        airspace.north  = airspace.center.latitude() + latitudeRadius;
+        airspace.south  = airspace.center.latitude() - latitudeRadius;
+        airspace.east   = airspace.center.longitude() + longitudeRadius;
+        airspace.west   = airspace.center.longitude() - longitudeRadius;
+        return;
+    }
+
+    airspace.north = -90;
+    airspace.south = 90;
+    airspace.east = -180;
+    airspace.west = 180;
+    for (const QGeoCoordinate& coord: airspace.polygon) {
+        airspace.north  = qMax(airspace.north, coord.latitude());
+        airspace.south  = qMin(airspace.south, coord.latitude());
+        airspace.east   = qMax(airspace.east, coord.longitude());
+        airspace.west   = qMin(airspace.west, coord.longitude());
+    }
+}
+
+void AirspaceGeometryCache::addTiles(const QList<TileKey_t>& tileKeys, const QList<Airspace_t>& airspaces, qint64 nowMsecs)
+{
+    QHash<QString, int> partCounts;
+    QStringList         keys;
+
+    for (const Airspace_t& airspace: airspaces) {
+        QString key = QStringLiteral("%1:%2").arg(airspace.id).arg(partCounts[airspace.id]++);
+
+        Airspace_t& cached = _airspaces[key];
+        cached = airspace;
+        cached.key = key;
+        _setBounds(cached);
+        if (!cached.circle) {
+            cached.lods[0] = cached.polygon;
+            for (int lod=1; lod<lodCount; lod++) {
+                QList<QGeoCoordinate> simplified = simplifyPath(cached.polygon, _lodToleranceMeters[lod]);
+                // Anything less than a triangle isn't worth drawing, the coarser level is used instead
+                cached.lods[lod] = simplified.count() >= 3 ? simplified : cached.lods[lod - 1];
+            }
+        }
+        keys.append(key);
+    }
+
+    for (TileKey_t tileKey: tileKeys) {
+        double north, south, east, west;
+        _tileBox(tileKey, north, south, east, west);
+
+        Tile_t& tile = _tiles[tileKey];
+        tile.fetchedMsecs = nowMsecs;
+        tile.keys.clear();
+        for (const QString& key: keys) {
+            const Airspace_t& airspace = _airspaces[key];
+            if (airspace.south <= north && airspace.north >= south && airspace.west <= east && airspace.east >= west) {
+                tile.keys.append(key);
+            }
+        }
+    }
+
+    // Past the limit the oldest tiles go first
+    if (_tiles.count() > maxTiles) {
+        QVector<QPair<qint64, TileKey_t>> ages;
+        for (auto it = _tiles.constBegin(); it != _tiles.constEnd(); it++) {
+            ages.append(qMakePair(it->fetchedMsecs, it.key()));
+        }
+        std::sort(ages.begin(), ages.end());
+        for (int i=0; i<ages.count() - maxTiles; i++) {
+            _tiles.remove(ages[i].second);
+        }
+    }
+
+    _removeUnreferenced();
+}
+
+void AirspaceGeometryCache::expire(qint64 nowMsecs)
+{
+    bool removed = false;
+
+    for (auto it = _tiles.begin(); it != _tiles.end(); ) {
+        if (nowMsecs - it->fetchedMsecs > _ttlMsecs) {
+            it = _tiles.erase(it);
+            removed = true;
+        } else {
+            it++;
+        }
+    }
+    if (removed) {
+        _removeUnreferenced();
+    }
+}
+
+void AirspaceGeometryCache::clear(void)
+{
+    _tiles.clear();
+    _airspaces.clear();
+    _treeDirty = true;
+}
+
+void AirspaceGeometryCache::_removeUnreferenced(void)
+{
+    QSet<QString> referenced;
+    for (const Tile_t& tile: _tiles) {
+        for (const QString& key: tile.keys) {
+            referenced.insert(key);
+        }
+    }
+
+    for (auto it = _airspaces.begin(); it != _airspaces.end(); ) {
+        if (referenced.contains(it.key())) {
+            it++;
+        } else {
+            it = _airspaces.erase(it);
+        }
+    }
+
+    _treeDirty = true;
+}
+
+void AirspaceGeometryCache::_strSort(QVector<Node_t>& nodes)
+{
+    auto centerX = [](const Node_t& node) { return node.east + node.west; };
+    auto centerY = [](const Node_t& node) { return node.north + node.south; };
+
+    // Vertical slices of sqrt(parent count) parents each, each slice then sorted north to south
+    int parentCount = (nodes.count() + nodeCapacity - 1) / nodeCapacity;
+    int sliceSize   = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(parentCount)))) * nodeCapacity;
+
+    std::sort(nodes.begin(), nodes.end(), [&centerX](const Node_t& a, const Node_t& b) { return centerX(a) < centerX(b); });
+    for (int i=0; i<nodes.count(); i+=sliceSize) {
+        auto sliceEnd = nodes.begin() + qMin(i + sliceSize, nodes.count());
+        std::sort(nodes.begin() + i, sliceEnd, [&centerY](const Node_t& a, const Node_t& b) { return centerY(a) < centerY(b); });
+    }
+}
+
+void AirspaceGeometryCache::_buildTree(void) const
+{
+    _treeItems.clear();
+    _treeLevels.clear();
+    _treeDirty = false;
+
+    QVector<Node_t> level;
+    for (const Airspace_t& airspace: _airspaces) {
+        level.append({ airspace.north, airspace.south, airspace.east, airspace.west, _treeItems.count(), 0 });
+        _treeItems.append(&airspace);
+    }
+    if (level.isEmpty()) {
+        return;
+    }
+
+    // Each level is packed into parents of nodeCapacity children, until the top level fits in a single node
+    while (true) {
+        _strSort(level);
+        _treeLevels.append(level);
+        if (level.count() <= nodeCapacity) {
+            break;
+        }
+
+        QVector<Node_t> parents;
+        for (int i=0; i<level.count(); i+=nodeCapacity) {
+            Node_t parent = level[i];
+            parent.first = i;
+            parent.count = level.count() - i < nodeCapacity ? level.count() - i : nodeCapacity;
+            for (int j=i+1; j<i+parent.count; j++) {
+                parent.north    = qMax(parent.north, level[j].north);
+                parent.south    = qMin(parent.south, level[j].south);
+                parent.east     = qMax(parent.east, level[j].east);
+                parent.west     = qMin(parent.west, level[j].west);
+            }
+            parents.append(parent);
+        }
+        level = parents;
+    }
+}
+
+void AirspaceGeometryCache::_queryLevel(int level, int first, int count, double north, double south, double east, double west, QVector<int>& items) const
+{
+    const QVector<Node_t>& nodes = _treeLevels[level];
+
+    for (int i=first; i<first+count; i++) {
+        const Node_t& node = nodes[i];
+        if (node.south > north || node.north < south || node.west > east || node.east < west) {
+            continue;
+        }
+        if (level == 0) {
+            items.append(node.first);
+        } else {
+            _queryLevel(level - 1, node.first, node.count, north, south, east, west, items);
+        }
+    }
+}
+
+void AirspaceGeometryCache::_query(double north, double south, double east, double west, QVector<int>& items) const
+{
+    if (_treeDirty) {
+        _buildTree();
+    }
+    if (!_treeLevels.isEmpty()) {
+        _queryLevel(_treeLevels.count() - 1, 0, _treeLevels.last().count(), north, south, east, west, items);
+    }
+}
+
+QList<const AirspaceGeometryCache::Airspace_t*> AirspaceGeometryCache::visible(const QGCGeoBoundingCube& area) const
+{
+    QList<const Airspace_t*> airspaces;
+    if (!_areaValid(area)) {
+        return airspaces;
+    }
+
+    QVector<int> items;
+    _query(area.pointNW.latitude(), area.pointSE.latitude(), area.pointSE.longitude(), area.pointNW.longitude(), items);
+    for (int item: items) {
+        airspaces.append(_treeItems[item]);
+    }
+    return airspaces;
+}
+
+bool AirspaceGeometryCache::_touches(const Airspace_t& airspace, const QGeoCoordinate& from, const QGeoCoordinate& to) const
+{
+    if (airspace.circle) {
+        // Closest point of the segment to the center, on the tangent plane at the center
+        double x1, y1, x2, y2, z;
+        convertGeoToNed(from, airspace.center, &x1, &y1, &z);
+        convertGeoToNed(to, airspace.center, &x2, &y2, &z);
+
+        double dx = x2 - x1;
+        double dy = y2 - y1;
+        double lengthSquared = dx * dx + dy * dy;
+        double t = lengthSquared > 0 ? qBound(0.0, -(x1 * dx + y1 * dy) / lengthSquared, 1.0) : 0;
+        double closestX = x1 + t * dx;
+        double closestY = y1 + t * dy;
+        return closestX * closestX + closestY * closestY <= airspace.radius * airspace.radius;
+    }
+
+    // Lat/lon are treated as planar, which is fine for the size of an airspace
+    const QList<QGeoCoordinate>& polygon = airspace.polygon;
+    double px = from.longitude(), py = from.latitude();
+    double qx = to.longitude(), qy = to.latitude();
+    bool inside = false;
+
+    auto cross = [](double ax, double ay, double bx, double by, double cx, double cy) {
+        return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+    };
+
+    for (int i=0, j=polygon.count() - 1; i<polygon.count(); j=i++) {
+        double ax = polygon[j].longitude(), ay = polygon[j].latitude();
+        double bx = polygon[i].longitude(), by = polygon[i].latitude();
+
+        // Crossing test for the start point being inside
+        if ((by > py) != (ay > py) && px < (ax - bx) * (py - by) / (ay - by) + bx) {
+            inside = !inside;
+        }
+
+        // Segment against edge
+        double d1 = cross(ax, ay, bx, by, px, py);
+        double d2 = cross(ax, ay, bx, by, qx, qy);
+        double d3 = cross(px, py, qx, qy, ax, ay);
+        double d4 = cross(px, py, qx, qy, bx, by);
+        if (((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0))) {
+            return true;
+        }
+    }
+    return inside;
+}
+
+QStringList AirspaceGeometryCache::intersectingIds(const QList<QGeoCoordinate>& path) const
+{
+    QSet<QString> ids;
+
+    // A single point is checked as a segment of no length
+    int segmentCount = path.count() > 1 ? path.count() - 1 : path.count();
+    for (int i=0; i<segmentCount; i++) {
+        const QGeoCoordinate& from  = path[i];
+        const QGeoCoordinate& to    = path.count() > 1 ? path[i + 1] : path[i];
+
+        QVector<int> items;
+        _query(qMax(from.latitude(), to.latitude()), qMin(from.latitude(), to.latitude()),
+               qMax(from.longitude(), to.longitude()), qMin(from.longitude(), to.longitude()), items);
+        for (int item: items) {
+            const Airspace_t* airspace = _treeItems[item];
+            if (!ids.contains(airspace->id) && _touches(*airspace, from, to)) {
+                ids.insert(airspace->id);
+            }
+        }
+    }
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
+    return ids.toList();
+#else
+    return QStringList(ids.begin(), ids.end());
+#endif
+}
+
+int AirspaceGeometryCache::lodForArea(const QGCGeoBoundingCube& area)
+{
+    if (!_areaValid(area)) {
+        return 0;
+    }
+
+    double latitude     = (area.pointNW.latitude() + area.pointSE.latitude()) / 2;
+    double widthMeters  = QGeoCoordinate(latitude, area.pointNW.longitude()).distanceTo(QGeoCoordinate(latitude, area.pointSE.longitude()));
+    double tolerance    = widthMeters / _areaWidthPerToleranceMeter;
+
+    int lod = 0;
+    while (lod + 1 < lodCount && _lodToleranceMeters[lod + 1] <= tolerance) {
+        lod++;
+    }
+    return lod;
+}
@@ -0,0 +1,128 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCGeoBoundingCube.h"
+
+#include <QColor>
+#include <QGeoCoordinate>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/// Local cache of airspace geometries, keyed by fixed size lat/lon tiles which expire after a time to live. Panning
+/// only has to download the tiles which aren't cached yet. Airspaces are indexed in an R-tree, packed with the
+/// Sort-Tile-Recursive algorithm, for visibility queries against the map area and intersection queries against plans.
+/// Polygons are simplified once for a few levels of detail, so zoomed out views don't draw every vertex.
+///
+/// Times are passed in by the caller, msecs on any monotonic clock. Not thread safe.
+class AirspaceGeometryCache
+{
+public:
+    typedef quint64 TileKey_t;
+
+    static const int lodCount = 4;
+
+    /// One airspace polygon or circle. Multi polygons are added as one entry per polygon with the same id.
+    typedef struct {
+        QString                 id;
+        QString                 key;                    ///< Filled in by the cache, unique for each entry
+        QColor                  color;
+        QColor                  lineColor;
+        float                   lineWidth;
+        bool                    circle;
+        QGeoCoordinate          center;                 ///< Circles only
+        double                  radius;                 ///< Circles only, meters
+        QList<QGeoCoordinate>   polygon;                ///< Polygons only
+        QList<QGeoCoordinate>   lods[lodCount];         ///< Filled in by the cache, lods[0] is the full polygon
+        double                  north;                  ///< Bounding box, filled in by the cache
+        double                  south;
+        double                  east;
+        double                  west;
+    } Airspace_t;
+
+    ///     @param tileSizeDegrees  Size of a cache tile
+    ///     @param ttlMsecs         Time after which a tile is downloaded again
+    AirspaceGeometryCache(double tileSizeDegrees = defaultTileSizeDegrees, qint64 ttlMsecs = defaultTtlMsecs);
+
+    /// @return Tiles which cover the area
+    QList<TileKey_t> tiles(const QGCGeoBoundingCube& area) const;
+
+    /// @return Tiles of the area which aren't cached or have expired
+    QList<TileKey_t> missingTiles(const QGCGeoBoundingCube& area, qint64 nowMsecs) const;
+
+    /// @return Bounding box of the tiles, for the download request
+    QGCGeoBoundingCube tileBounds(const QList<TileKey_t>& tiles) const;
+
+    /// Adds the airspaces of a download which covered the tiles. The tiles are replaced, airspaces which are already
+    /// cached from a neighbouring tile are replaced as well.
+    void addTiles(const QList<TileKey_t>& tiles, const QList<Airspace_t>& airspaces, qint64 nowMsecs);
+
+    /// Drops expired tiles and the airspaces which are only in those
+    void expire(qint64 nowMsecs);
+
+    void clear(void);
+
+    /// @return Airspaces which overlap the area
+    QList<const Airspace_t*> visible(const QGCGeoBoundingCube& area) const;
+
+    /// @return Ids of the airspaces which the path touches, in no particular order
+    QStringList intersectingIds(const QList<QGeoCoordinate>& path) const;
+
+    /// @return Level of detail to draw polygons at for the area, 0 for full detail
+    static int lodForArea(const QGCGeoBoundingCube& area);
+
+    int tileCount       (void) const { return _tiles.count(); }
+    int airspaceCount   (void) const { return _airspaces.count(); }
+
+    static constexpr double defaultTileSizeDegrees  = 0.1;              ///< About 11 km north to south
+    static const qint64     defaultTtlMsecs         = 15 * 60 * 1000;
+    static const int        maxTiles                = 2048;             ///< Oldest tiles go first past this
+    static const int        nodeCapacity            = 16;               ///< R-tree fan out
+
+private:
+    typedef struct {
+        qint64      fetchedMsecs;
+        QStringList keys;           ///< Keys of the airspaces in the tile
+    } Tile_t;
+
+    typedef struct {
+        double  north;
+        double  south;
+        double  east;
+        double  west;
+        int     first;              ///< Leaf level: index into _treeItems. Otherwise: first child in the level below
+        int     count;              ///< Children in the level below, 0 on the leaf level
+    } Node_t;
+
+    TileKey_t   _tileKey            (int x, int y) const { return static_cast<TileKey_t>(static_cast<quint32>(y)) << 32 | static_cast<quint32>(x); }
+    void        _tileBox            (TileKey_t tileKey, double& north, double& south, double& east, double& west) const;
+    void        _removeUnreferenced (void);
+    void        _buildTree          (void) const;
+    void        _query              (double north, double south, double east, double west, QVector<int>& items) const;
+    void        _queryLevel         (int level, int first, int count, double north, double south, double east, double west, QVector<int>& items) const;
+    bool        _touches            (const Airspace_t& airspace, const QGeoCoordinate& from, const QGeoCoordinate& to) const;
+
+    static void _setBounds          (Airspace_t& airspace);
+    static void _strSort            (QVector<Node_t>& nodes);
+
+    double                          _tileSizeDegrees;
+    qint64                          _ttlMsecs;
+    QHash<TileKey_t, Tile_t>        _tiles;
+    QMap<QString, Airspace_t>       _airspaces;     ///< By id and polygon index
+
+    // Built on the first query after a change
+    mutable bool                        _treeDirty = true;
+    mutable QVector<const Airspace_t*>  _treeItems;
+    mutable QVector<QVector<Node_t>>    _treeLevels;    ///< Leaf level first, the last level is the root's children
+};
@@ -0,0 +1,179 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "AirspaceGeometryCacheTest.h"
+#include "AirspaceGeometryCache.h"
+
+/// Square polygon airspace with many vertices along each side
+static AirspaceGeometryCache::Airspace_t _square(const QString& id, double north, double west, double sizeDegrees)
+{
+    AirspaceGeometryCache::Airspace_t airspace = {};
+    airspace.id = id;
+
+    const int stepsPerSide = 50;
+    double step = sizeDegrees / stepsPerSide;
+    for (int i=0; i<stepsPerSide; i++) {
+        airspace.polygon.append(QGeoCoordinate(north, west + i * step));
+    }
+    for (int i=0; i<stepsPerSide; i++) {
+        airspace.polygon.append(QGeoCoordinate(north - i * step, west + sizeDegrees));
+    }
+    for (int i=0; i<stepsPerSide; i++) {
+        airspace.polygon.append(QGeoCoordinate(north - sizeDegrees, west + sizeDegrees - i * step));
+    }
+    for (int i=0; i<stepsPerSide; i++) {
+        airspace.polygon.append(QGeoCoordinate(north - sizeDegrees + i * step, west));
+    }
+    return airspace;
+}
+
+static AirspaceGeometryCache::Airspace_t _circle(const QString& id, const QGeoCoordinate& center, double radius)
+{
+    AirspaceGeometryCache::Airspace_t airspace = {};
+    airspace.id     = id;
+    airspace.circle = true;
+    airspace.center = center;
+    airspace.radius = radius;
+    return airspace;
+}
+
+void AirspaceGeometryCacheTest::_tilesTest(void)
+{
+    AirspaceGeometryCache cache(0.1, 1000);
+
+    QGCGeoBoundingCube area(QGeoCoordinate(47.25, 8.45), QGeoCoordinate(47.05, 8.65));
+    QList<AirspaceGeometryCache::TileKey_t> tiles = cache.tiles(area);
+    QCOMPARE(tiles.count(), 9);
+    QCOMPARE(cache.missingTiles(area, 0).count(), 9);
+
+    // The download area covers the whole tiles
+    QGCGeoBoundingCube bounds = cache.tileBounds(tiles);
+    QVERIFY(bounds.pointNW.latitude() >= 47.25 && bounds.pointNW.latitude() < 47.35);
+    QVERIFY(bounds.pointSE.latitude() <= 47.05 && bounds.pointSE.latitude() > 46.95);
+    QVERIFY(bounds.pointNW.longitude() <= 8.45 && bounds.pointNW.longitude() > 8.35);
+    QVERIFY(bounds.pointSE.longitude() >= 8.65 && bounds.pointSE.longitude() < 8.75);
+
+    cache.addTiles(tiles, QList<AirspaceGeometryCache::Airspace_t>(), 0);
+    QCOMPARE(cache.tileCount(), 9);
+    QCOMPARE(cache.missingTiles(area, 500).count(), 0);
+
+    // Panning east by one tile only needs the new column
+    QGCGeoBoundingCube panned(QGeoCoordinate(47.25, 8.55), QGeoCoordinate(47.05, 8.75));
+    QCOMPARE(cache.missingTiles(panned, 500).count(), 3);
+}
+
+void AirspaceGeometryCacheTest::_expireTest(void)
+{
+    AirspaceGeometryCache cache(0.1, 1000);
+
+    QGCGeoBoundingCube oldArea(QGeoCoordinate(47.05, 8.05), QGeoCoordinate(47.01, 8.09));
+    QGCGeoBoundingCube newArea(QGeoCoordinate(48.05, 8.05), QGeoCoordinate(48.01, 8.09));
+
+    cache.addTiles(cache.tiles(oldArea), { _square(QStringLiteral("old"), 47.04, 8.02, 0.02) }, 0);
+    cache.addTiles(cache.tiles(newArea), { _square(QStringLiteral("new"), 48.04, 8.02, 0.02) }, 800);
+    QCOMPARE(cache.airspaceCount(), 2);
+
+    // Expired tiles go together with the airspaces only they were holding
+    QCOMPARE(cache.missingTiles(oldArea, 1500).count(), 1);
+    cache.expire(1500);
+    QCOMPARE(cache.tileCount(), 1);
+    QCOMPARE(cache.airspaceCount(), 1);
+    QCOMPARE(cache.visible(oldArea).count(), 0);
+    QCOMPARE(cache.visible(newArea).count(), 1);
+
+    cache.clear();
+    QCOMPARE(cache.tileCount(), 0);
+    QCOMPARE(cache.airspaceCount(), 0);
+}
+
+void AirspaceGeometryCacheTest::_visibleTest(void)
+{
+    AirspaceGeometryCache cache(1.0, 1000);
+
+    // A grid of small airspaces, enough for a tree of several levels
+    QList<AirspaceGeometryCache::Airspace_t> airspaces;
+    const int gridSize = 40;
+    for (int y=0; y<gridSize; y++) {
+        for (int x=0; x<gridSize; x++) {
+            airspaces.append(_square(QStringLiteral("%1,%2").arg(x).arg(y), 10.0 + y * 0.02 + 0.01, 20.0 + x * 0.02, 0.01));
+        }
+    }
+    QGCGeoBoundingCube all(QGeoCoordinate(11.0, 20.0), QGeoCoordinate(10.0, 21.0));
+    cache.addTiles(cache.tiles(all), airspaces, 0);
+    QCOMPARE(cache.airspaceCount(), gridSize * gridSize);
+    QCOMPARE(cache.visible(all).count(), gridSize * gridSize);
+
+    // A window of 5 by 5 cells
+    QGCGeoBoundingCube window(QGeoCoordinate(10.0 + 9 * 0.02 + 0.005, 20.0 + 4 * 0.02 + 0.005), QGeoCoordinate(10.0 + 5 * 0.02 + 0.005, 20.0 + 8 * 0.02 + 0.005));
+    QList<const AirspaceGeometryCache::Airspace_t*> visible = cache.visible(window);
+    QCOMPARE(visible.count(), 25);
+    for (const AirspaceGeometryCache::Airspace_t* airspace: visible) {
+        QStringList cell = airspace->id.split(',');
+        QVERIFY(cell[0].toInt() >= 4 && cell[0].toInt() <= 8);
+        QVERIFY(cell[1].toInt() >= 5 && cell[1].toInt() <= 9);
+    }
+
+    // Nothing outside of the grid
+    QGCGeoBoundingCube nowhere(QGeoCoordinate(12.0, 22.0), QGeoCoordinate(11.5, 22.5));
+    QCOMPARE(cache.visible(nowhere).count(), 0);
+}
+
+void AirspaceGeometryCacheTest::_intersectingTest(void)
+{
+    AirspaceGeometryCache cache(1.0, 1000);
+
+    QGeoCoordinate center(30.5, 40.5);
+    QGCGeoBoundingCube area(QGeoCoordinate(31.0, 40.0), QGeoCoordinate(30.0, 41.0));
+    cache.addTiles(cache.tiles(area), {
+                       _square(QStringLiteral("square"), 30.3, 40.1, 0.1),
+                       _circle(QStringLiteral("circle"), center, 1000),
+                   }, 0);
+
+    // Crossing the square without a vertex inside it
+    QStringList ids = cache.intersectingIds({ QGeoCoordinate(30.25, 40.05), QGeoCoordinate(30.25, 40.25) });
+    QCOMPARE(ids, QStringList(QStringLiteral("square")));
+
+    // Entirely inside
+    ids = cache.intersectingIds({ QGeoCoordinate(30.25, 40.14), QGeoCoordinate(30.26, 40.15) });
+    QCOMPARE(ids, QStringList(QStringLiteral("square")));
+
+    // Passing the circle 500m from its center, then 2km from it
+    QGeoCoordinate near = center.atDistanceAndAzimuth(500, 0);
+    ids = cache.intersectingIds({ near.atDistanceAndAzimuth(3000, 270), near.atDistanceAndAzimuth(3000, 90) });
+    QCOMPARE(ids, QStringList(QStringLiteral("circle")));
+    QGeoCoordinate far = center.atDistanceAndAzimuth(2000, 0);
+    QCOMPARE(cache.intersectingIds({ far.atDistanceAndAzimuth(3000, 270), far.atDistanceAndAzimuth(3000, 90) }).count(), 0);
+
+    // Both, with a single point inside the circle
+    ids = cache.intersectingIds({ QGeoCoordinate(30.25, 40.05), QGeoCoordinate(30.25, 40.25), center });
+    ids.sort();
+    QCOMPARE(ids, QStringList({ QStringLiteral("circle"), QStringLiteral("square") }));
+    QCOMPARE(cache.intersectingIds({ center }), QStringList(QStringLiteral("circle")));
+}
+
+void AirspaceGeometryCacheTest::_lodTest(void)
+{
+    AirspaceGeometryCache cache(1.0, 1000);
+
+    QGCGeoBoundingCube area(QGeoCoordinate(31.0, 40.0), QGeoCoordinate(30.0, 41.0));
+    cache.addTiles(cache.tiles(area), { _square(QStringLiteral("square"), 30.3, 40.1, 0.1) }, 0);
+
+    const AirspaceGeometryCache::Airspace_t* airspace = cache.visible(area).first();
+    QCOMPARE(airspace->lods[0].count(), airspace->polygon.count());
+    for (int lod=1; lod<AirspaceGeometryCache::lodCount; lod++) {
+        QVERIFY(airspace->lods[lod].count() >= 3);
+        QVERIFY(airspace->lods[lod].count() <= airspace->lods[lod - 1].count());
+    }
+    // The sides are straight, so the corners are all that is left
+    QVERIFY(airspace->lods[AirspaceGeometryCache::lodCount - 1].count() <= 5);
+
+    // Street level draws everything, a country wide view the coarsest level
+    QCOMPARE(AirspaceGeometryCache::lodForArea(QGCGeoBoundingCube(QGeoCoordinate(30.01, 40.0), QGeoCoordinate(30.0, 40.01))), 0);
+    QCOMPARE(AirspaceGeometryCache::lodForArea(QGCGeoBoundingCube(QGeoCoordinate(35.0, 30.0), QGeoCoordinate(30.0, 50.0))), AirspaceGeometryCache::lodCount - 1);
+}
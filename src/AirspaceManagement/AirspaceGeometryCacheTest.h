@@ -0,0 +1,25 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for AirspaceGeometryCache
+class AirspaceGeometryCacheTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _tilesTest                 (void);
+    void _expireTest                (void);
+    void _visibleTest               (void);
+    void _intersectingTest          (void);
+    void _lodTest                   (void);
+};
@@ -19,6 +19,7 @@
 
 #include <QObject>
 #include <QList>
+#include <QStringList>
 #include <QGeoCoordinate>
 
 class AirspacePolygonRestriction;
@@ -42,4 +43,7 @@ public:
 
     virtual QmlObjectListModel* polygons        () = 0;     ///< List of AirspacePolygonRestriction objects
     virtual QmlObjectListModel* circles         () = 0;     ///< List of AirspaceCircularRestriction objects
+
+    /// @return Ids of the airspaces already known which the path touches, to check a plan against them
+    virtual QStringList airspacesAlongPath(const QList<QGeoCoordinate>& path) { Q_UNUSED(path); return QStringList(); }
 };
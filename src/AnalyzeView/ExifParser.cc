@@ -2,6 +2,19 @@
 #include <math.h>
 #include <QtEndian>
 #include <QDateTime>
+#include <QDataStream>
+
+#include <cstring>
+
+/// Splits an angle into rationals of whole degrees, whole minutes and seconds in 1/10000
+static void _degreesMinutesSeconds(double value, uint32_t& degrees, uint32_t& minutes, uint32_t& seconds)
+{
+    value = fabs(value);
+    const double fractionalMinutes = (value - floor(value)) * 60.0;
+    degrees = static_cast<uint32_t>(floor(value));
+    minutes = static_cast<uint32_t>(floor(fractionalMinutes));
+    seconds = static_cast<uint32_t>((fractionalMinutes - floor(fractionalMinutes)) * 60.0 * 10000.0);
+}
 
 ExifParser::ExifParser()
 {
@@ -222,3 +235,214 @@ bool ExifParser::write(QByteArray& buf, GeoTagWorker::cameraFeedbackPacket& geot
     buf.replace(tiffHeaderInd + 8, 2, converter.c, 2);
     return true;
 }
+
+bool ExifParser::writeGps(QByteArray& jpeg, const QGeoCoordinate& coordinate)
+{
+    if (!jpeg.startsWith("\xff\xd8") || jpeg.contains(QByteArray("Exif\0\0", 6)) || !coordinate.isValid()) {
+        return false;
+    }
+
+    // Tag, type, count and either the value (<= 4 bytes) or the offset of data
+    struct entry_s {
+        uint16_t    tagID;
+        uint16_t    type;
+        uint32_t    count;
+        QByteArray  data;
+    };
+
+    auto rational = [](uint32_t numerator, uint32_t denominator) {
+        QByteArray  bytes;
+        QDataStream stream(&bytes, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream << numerator << denominator;
+        return bytes;
+    };
+    auto degrees = [&rational](double value) {
+        uint32_t d, m, s;
+        _degreesMinutesSeconds(value, d, m, s);
+        return rational(d, 1) + rational(m, 1) + rational(s, 10000);
+    };
+
+    QList<entry_s> entries;
+    entries.append({ 0, 1, 4, QByteArray("\x02\x03\x00\x00", 4) });                                     // GPSVersionID 2.3
+    entries.append({ 1, 2, 2, QByteArray(coordinate.latitude() >= 0 ? "N" : "S", 2) });                    // GPSLatitudeRef
+    entries.append({ 2, 5, 3, degrees(coordinate.latitude()) });                                            // GPSLatitude
+    entries.append({ 3, 2, 2, QByteArray(coordinate.longitude() >= 0 ? "E" : "W", 2) });                   // GPSLongitudeRef
+    entries.append({ 4, 5, 3, degrees(coordinate.longitude()) });                                           // GPSLongitude
+    if (!qIsNaN(coordinate.altitude())) {
+        entries.append({ 5, 1, 1, QByteArray(1, coordinate.altitude() < 0 ? 1 : 0) });                     // GPSAltitudeRef
+        entries.append({ 6, 5, 1, rational(static_cast<uint32_t>(fabs(coordinate.altitude()) * 100.0), 100) });  // GPSAltitude
+    }
+    entries.append({ 18, 2, 7, QByteArray("WGS-84", 7) });                                                  // GPSMapDatum
+
+    // TIFF header, IFD0 with only the GPS IFD pointer, GPS IFD, then the data which does not fit in an entry
+    const uint32_t gpsIfdOffset     = 8 + 2 + 12 + 4;
+    const uint32_t dataOffset       = gpsIfdOffset + 2 + 12 * static_cast<uint32_t>(entries.count()) + 4;
+
+    QByteArray  tiff;
+    QByteArray  data;
+    QDataStream stream(&tiff, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    stream.writeRawData("II", 2);
+    stream << static_cast<uint16_t>(42) << static_cast<uint32_t>(8);
+    stream << static_cast<uint16_t>(1) << static_cast<uint16_t>(0x8825) << static_cast<uint16_t>(4) << static_cast<uint32_t>(1) << gpsIfdOffset;
+    stream << static_cast<uint32_t>(0);
+
+    stream << static_cast<uint16_t>(entries.count());
+    for (const entry_s& entry: entries) {
+        stream << entry.tagID << entry.type << entry.count;
+        if (entry.data.size() <= 4) {
+            QByteArray value = entry.data;
+            value.append(4 - value.size(), '\0');
+            stream.writeRawData(value.constData(), 4);
+        } else {
+            stream << dataOffset + static_cast<uint32_t>(data.size());
+            data.append(entry.data);
+        }
+    }
+    stream << static_cast<uint32_t>(0);
+    tiff.append(data);
+
+    QByteArray app1("\xff\xe1", 2);
+    const uint16_t app1Size = static_cast<uint16_t>(2 + 6 + tiff.size());
+    app1.append(static_cast<char>(app1Size >> 8));
+    app1.append(static_cast<char>(app1Size & 0xff));
+    app1.append("Exif\0\0", 6);
+    app1.append(tiff);
+
+    // Right after SOI
+    jpeg.insert(2, app1);
+    return true;
+}
+
+QByteArray ExifParser::readHeader(QIODevice& device)
+{
+    QByteArray header = device.read(2);
+    if (header != QByteArray("\xff\xd8", 2)) {
+        return QByteArray();
+    }
+
+    // Segments up to the Exif APP1, which comes ahead of the image data
+    while (header.size() < maxHeaderSize) {
+        const QByteArray marker = device.read(4);
+        if (marker.size() != 4 || static_cast<uchar>(marker[0]) != 0xff) {
+            return QByteArray();
+        }
+        const uchar type = static_cast<uchar>(marker[1]);
+        if (type == 0xda || type == 0xd9) {
+            // Start of scan or end of image
+            return QByteArray();
+        }
+        const int length = (static_cast<uchar>(marker[2]) << 8) | static_cast<uchar>(marker[3]);
+        if (length < 2) {
+            return QByteArray();
+        }
+        const QByteArray segment = device.read(length - 2);
+        if (segment.size() != length - 2) {
+            return QByteArray();
+        }
+        header.append(marker);
+        header.append(segment);
+        if (type == 0xe1 && segment.startsWith(QByteArray("Exif\0\0", 6))) {
+            return header;
+        }
+    }
+
+    return QByteArray();
+}
+
+bool ExifParser::patchGps(QByteArray& header, const GeoTagWorker::cameraFeedbackPacket& geotag)
+{
+    const int exifIndex = header.indexOf(QByteArray("Exif\0\0", 6));
+    if (exifIndex < 0 || exifIndex + 6 + 8 > header.size()) {
+        return false;
+    }
+    const int   tiffIndex       = exifIndex + 6;
+    const bool  littleEndian    = header.mid(tiffIndex, 2) == "II";
+    if (!littleEndian && header.mid(tiffIndex, 2) != "MM") {
+        return false;
+    }
+    uchar* tiff = reinterpret_cast<uchar*>(header.data()) + tiffIndex;
+
+    // All offsets are from the TIFF header
+    auto inRange = [&header, tiffIndex](quint32 offset, quint32 size) {
+        return static_cast<qint64>(tiffIndex) + offset + size <= header.size();
+    };
+    auto read16 = [tiff, littleEndian](quint32 offset) {
+        return littleEndian ? qFromLittleEndian<quint16>(tiff + offset) : qFromBigEndian<quint16>(tiff + offset);
+    };
+    auto read32 = [tiff, littleEndian](quint32 offset) {
+        return littleEndian ? qFromLittleEndian<quint32>(tiff + offset) : qFromBigEndian<quint32>(tiff + offset);
+    };
+    auto write32 = [tiff, littleEndian](quint32 offset, quint32 value) {
+        if (littleEndian) {
+            qToLittleEndian<quint32>(value, tiff + offset);
+        } else {
+            qToBigEndian<quint32>(value, tiff + offset);
+        }
+    };
+
+    // GPS IFD pointer from IFD0
+    const quint32 ifd0 = read32(4);
+    if (!inRange(ifd0, 2) || !inRange(ifd0 + 2, 12u * read16(ifd0))) {
+        return false;
+    }
+    quint32 gpsIfd = 0;
+    for (quint32 i = 0; i < read16(ifd0); i++) {
+        const quint32 entry = ifd0 + 2 + 12 * i;
+        if (read16(entry) == 0x8825) {
+            gpsIfd = read32(entry + 8);
+        }
+    }
+    if (gpsIfd == 0 || !inRange(gpsIfd, 2) || !inRange(gpsIfd + 2, 12u * read16(gpsIfd))) {
+        return false;
+    }
+
+    // Entries of GPSLatitudeRef through GPSAltitude, by tag
+    quint32 entries[7] = { 0, 0, 0, 0, 0, 0, 0 };
+    for (quint32 i = 0; i < read16(gpsIfd); i++) {
+        const quint32 entry = gpsIfd + 2 + 12 * i;
+        const quint16 tag   = read16(entry);
+        if (tag >= 1 && tag <= 6) {
+            entries[tag] = entry;
+        }
+    }
+    auto fits = [&](int tag, quint16 type, quint32 count) {
+        const quint32 entry = entries[tag];
+        return entry != 0 && read16(entry + 2) == type && read32(entry + 4) == count && (type != 5 || inRange(read32(entry + 8), 8 * count));
+    };
+    if (!fits(1, 2, 2) || !fits(2, 5, 3) || !fits(3, 2, 2) || !fits(4, 5, 3)) {
+        return false;
+    }
+
+    auto writeDegrees = [&](int tag, double value) {
+        uint32_t d, m, s;
+        _degreesMinutesSeconds(value, d, m, s);
+        const quint32 offset = read32(entries[tag] + 8);
+        write32(offset,      d);
+        write32(offset + 4,  1);
+        write32(offset + 8,  m);
+        write32(offset + 12, 1);
+        write32(offset + 16, s);
+        write32(offset + 20, 10000);
+    };
+    auto writeInline = [&](int tag, char value) {
+        uchar* content = tiff + entries[tag] + 8;
+        memset(content, 0, 4);
+        content[0] = static_cast<uchar>(value);
+    };
+
+    writeInline(1, geotag.latitude >= 0 ? 'N' : 'S');
+    writeDegrees(2, geotag.latitude);
+    writeInline(3, geotag.longitude >= 0 ? 'E' : 'W');
+    writeDegrees(4, geotag.longitude);
+    if (fits(5, 1, 1) && fits(6, 5, 1)) {
+        writeInline(5, geotag.altitude < 0 ? 1 : 0);
+        const quint32 offset = read32(entries[6] + 8);
+        write32(offset,     static_cast<uint32_t>(fabs(geotag.altitude) * 100.0));
+        write32(offset + 4, 100);
+    }
+
+    return true;
+}
@@ -3,6 +3,7 @@
 
 #include <QGeoCoordinate>
 #include <QDebug>
+#include <QIODevice>
 
 #include "GeoTagController.h"
 
@@ -13,6 +14,22 @@ public:
     ~ExifParser();
     double readTime(QByteArray& buf);
     bool write(QByteArray& buf, GeoTagWorker::cameraFeedbackPacket& geotag);
+
+    /// Reads a jpeg up to the end of its Exif segment, which is enough for readTime and patchGps
+    /// @return Header from the start of the file, empty if there is no Exif segment within maxHeaderSize
+    QByteArray readHeader(QIODevice& device);
+
+    /// Overwrites the values of an existing GPS IFD, e.g. the empty one written by many cameras. The header keeps its
+    /// size, so it can be written back over the start of the image.
+    /// @return false: No GPS IFD with latitude and longitude entries (use write instead)
+    bool patchGps(QByteArray& header, const GeoTagWorker::cameraFeedbackPacket& geotag);
+
+    /// Adds an Exif block with only GPS tags to a jpeg which has none, e.g. one written by QImage
+    ///     @param coordinate Altitude is written if valid, AMSL
+    /// @return false: Not a jpeg or it already has Exif data (use write instead)
+    bool writeGps(QByteArray& jpeg, const QGeoCoordinate& coordinate);
+
+    static const int maxHeaderSize = 256 * 1024;
 };
 
 #endif // EXIFPARSER_H
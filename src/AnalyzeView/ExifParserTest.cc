@@ -0,0 +1,68 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ExifParserTest.h"
+#include "ExifParser.h"
+
+#include <QBuffer>
+
+#include <cstring>
+
+/// Start and end of image, enough for ExifParser::writeGps
+static const QByteArray _emptyJpeg("\xff\xd8\xff\xd9", 4);
+
+static QByteArray _readHeader(const QByteArray& jpeg)
+{
+    QBuffer buffer;
+    buffer.setData(jpeg);
+    buffer.open(QIODevice::ReadOnly);
+    return ExifParser().readHeader(buffer);
+}
+
+void ExifParserTest::_readHeaderTest(void)
+{
+    QByteArray jpeg = _emptyJpeg;
+    QVERIFY(ExifParser().writeGps(jpeg, QGeoCoordinate(10.5, 20.25, 50)));
+
+    // Everything up to the end of the Exif segment
+    QByteArray header = _readHeader(jpeg);
+    QCOMPARE(header.size(), jpeg.size() - 2);
+    QVERIFY(jpeg.startsWith(header));
+
+    QVERIFY(_readHeader(_emptyJpeg).isEmpty());
+    QVERIFY(_readHeader(QByteArray("not a jpeg")).isEmpty());
+}
+
+void ExifParserTest::_patchGpsTest(void)
+{
+    const QGeoCoordinate patchCoordinate(-33.123456, -70.654321, 120);
+
+    QByteArray jpeg = _emptyJpeg;
+    QVERIFY(ExifParser().writeGps(jpeg, QGeoCoordinate(10.5, 20.25, 50)));
+    QByteArray expectedJpeg = _emptyJpeg;
+    QVERIFY(ExifParser().writeGps(expectedJpeg, patchCoordinate));
+
+    GeoTagWorker::cameraFeedbackPacket geotag;
+    memset(&geotag, 0, sizeof(geotag));
+    geotag.latitude     = patchCoordinate.latitude();
+    geotag.longitude    = patchCoordinate.longitude();
+    geotag.altitude     = static_cast<float>(patchCoordinate.altitude());
+
+    // Patching the existing GPS IFD gives the same bytes as writing the patched position from scratch
+    QByteArray header = _readHeader(jpeg);
+    const int headerSize = header.size();
+    QVERIFY(ExifParser().patchGps(header, geotag));
+    QCOMPARE(header.size(), headerSize);
+    QVERIFY(expectedJpeg.startsWith(header));
+
+    // Nothing to patch
+    QByteArray noExif = _emptyJpeg;
+    QVERIFY(!ExifParser().patchGps(noExif, geotag));
+    QCOMPARE(noExif, _emptyJpeg);
+}
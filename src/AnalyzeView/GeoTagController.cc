@@ -15,6 +15,7 @@
 #include <cfloat>
 #include <QDir>
 #include <QUrl>
+#include <QtConcurrent>
 
 #include "ExifParser.h"
 #include "ULogParser.h"
@@ -161,47 +162,39 @@ void GeoTagWorker::run()
     emit progressChanged((100/nSteps));
 
     // Parse EXIF
-    ExifParser exifParser;
-    _imageTime.clear();
-    for (int i = 0; i < _imageList.size(); ++i) {
-        QFile file(_imageList.at(i).absoluteFilePath());
-        if (!file.open(QIODevice::ReadOnly)) {
+    QFuture<double> timeFuture = QtConcurrent::mapped(_imageList, &GeoTagWorker::_readImageTime);
+    if (!_waitForFuture(timeFuture, 100/nSteps, 100/nSteps)) {
+        qCDebug(GeotaggingLog) << "Tagging cancelled";
+        emit error(tr("Tagging cancelled"));
+        return;
+    }
+    _imageTime = timeFuture.results();
+    for (double imageTime: _imageTime) {
+        if (qIsNaN(imageTime)) {
             emit error(tr("Geotagging failed. Couldn't open an image."));
             return;
         }
-        QByteArray imageBuffer = file.readAll();
-        file.close();
-
-        _imageTime.append(exifParser.readTime(imageBuffer));
-
-        emit progressChanged((100/nSteps) + ((100/nSteps) / _imageList.size())*i);
-
-        if (_cancel) {
-            qCDebug(GeotaggingLog) << "Tagging cancelled";
-            emit error(tr("Tagging cancelled"));
-            return;
-        }
-    }
-
-    // Load log
-    bool isULog = _logFile.endsWith(".ulg", Qt::CaseSensitive);
-    QFile file(_logFile);
-    if (!file.open(QIODevice::ReadOnly)) {
-        emit error(tr("Geotagging failed. Couldn't open log file."));
-        return;
     }
-    QByteArray log = file.readAll();
-    file.close();
 
     // Instantiate appropriate parser
+    bool isULog = _logFile.endsWith(".ulg", Qt::CaseSensitive);
     _triggerList.clear();
     bool parseComplete = false;
     QString errorString;
     if (isULog) {
+        // Memory mapped, ULogs can be several gigabytes
         ULogParser parser;
-        parseComplete = parser.getTagsFromLog(log, _triggerList, errorString);
+        parseComplete = parser.getTagsFromLog(_logFile, _triggerList, errorString);
 
     } else {
+        QFile file(_logFile);
+        if (!file.open(QIODevice::ReadOnly)) {
+            emit error(tr("Geotagging failed. Couldn't open log file."));
+            return;
+        }
+        QByteArray log = file.readAll();
+        file.close();
+
         PX4LogParser parser;
         parseComplete = parser.getTagsFromLog(log, _triggerList);
 
@@ -246,53 +239,118 @@ void GeoTagWorker::run()
     // Tag images
     int maxIndex = std::min(_imageIndices.count(), _triggerIndices.count());
     maxIndex = std::min(maxIndex, _imageList.count());
+    QList<TagJob_t> tagJobs;
     for(int i = 0; i < maxIndex; i++) {
         int imageIndex = _imageIndices[i];
         if (imageIndex >= _imageList.count()) {
             emit error(tr("Geotagging failed. Requesting image #%1, but only %2 images present.").arg(imageIndex).arg(_imageList.count()));
             return;
         }
-        QFile fileRead(_imageList.at(_imageIndices[i]).absoluteFilePath());
-        if (!fileRead.open(QIODevice::ReadOnly)) {
-            emit error(tr("Geotagging failed. Couldn't open an image."));
-            return;
+        TagJob_t job;
+        job.imageFile = _imageList.at(imageIndex).absoluteFilePath();
+        if(_saveDirectory == "") {
+            job.taggedFile = _imageDirectory + "/TAGGED/" + _imageList.at(imageIndex).fileName();
+        } else {
+            job.taggedFile = _saveDirectory + "/" + _imageList.at(imageIndex).fileName();
         }
-        QByteArray imageBuffer = fileRead.readAll();
-        fileRead.close();
+        job.geotag = _triggerList[_triggerIndices[i]];
+        tagJobs.append(job);
+    }
 
-        if (!exifParser.write(imageBuffer, _triggerList[_triggerIndices[i]])) {
-            emit error(tr("Geotagging failed. Couldn't write to image."));
+    QFuture<QString> tagFuture = QtConcurrent::mapped(tagJobs, &GeoTagWorker::_tagImage);
+    if (!_waitForFuture(tagFuture, 4*(100/nSteps), 100/nSteps)) {
+        qCDebug(GeotaggingLog) << "Tagging cancelled";
+        emit error(tr("Tagging cancelled"));
+        return;
+    }
+    for (const QString& tagError: tagFuture.results()) {
+        if (!tagError.isEmpty()) {
+            emit error(tagError);
             return;
-        } else {
-            QFile fileWrite;
-            if(_saveDirectory == "") {
-                fileWrite.setFileName(_imageDirectory + "/TAGGED/" + _imageList.at(_imageIndices[i]).fileName());
-            } else {
-                fileWrite.setFileName(_saveDirectory + "/" + _imageList.at(_imageIndices[i]).fileName());
-            }
-            if (!fileWrite.open(QFile::WriteOnly)) {
-                emit error(tr("Geotagging failed. Couldn't write to an image."));
-                return;
-            }
-            fileWrite.write(imageBuffer);
-            fileWrite.close();
         }
-        emit progressChanged(4*(100/nSteps) + ((100/nSteps) / maxIndex)*i);
+    }
+
+    emit progressChanged(100);
+}
 
+bool GeoTagWorker::_waitForFuture(QFuture<void> future, double progressStart, double progressSpan)
+{
+    // Progress is polled, a signal for each of thousands of images would only flood the GUI thread
+    while (!future.isFinished()) {
         if (_cancel) {
-            qCDebug(GeotaggingLog) << "Tagging cancelled";
-            emit error(tr("Tagging cancelled"));
-            return;
+            future.cancel();
+            future.waitForFinished();
+            return false;
+        }
+        if (future.progressMaximum() > 0) {
+            emit progressChanged(progressStart + (progressSpan * future.progressValue()) / future.progressMaximum());
         }
+        QThread::msleep(_progressIntervalMSecs);
     }
+    return !_cancel;
+}
 
-    if (_cancel) {
-        qCDebug(GeotaggingLog) << "Tagging cancelled";
-        emit error(tr("Tagging cancelled"));
-        return;
+double GeoTagWorker::_readImageTime(const QFileInfo& imageInfo)
+{
+    QFile file(imageInfo.absoluteFilePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return qQNaN();
     }
 
-    emit progressChanged(100);
+    ExifParser exifParser;
+    QByteArray imageBuffer = exifParser.readHeader(file);
+    if (imageBuffer.isEmpty()) {
+        // Exif further into the file than expected
+        file.seek(0);
+        imageBuffer = file.readAll();
+    }
+    return exifParser.readTime(imageBuffer);
+}
+
+QString GeoTagWorker::tagImage(const QString& imageFile, const QString& taggedFile, const cameraFeedbackPacket& geotag)
+{
+    return _tagImage({ imageFile, taggedFile, geotag });
+}
+
+QString GeoTagWorker::_tagImage(const TagJob_t& job)
+{
+    QFile fileRead(job.imageFile);
+    if (!fileRead.open(QIODevice::ReadOnly)) {
+        return tr("Geotagging failed. Couldn't open an image.");
+    }
+
+    ExifParser              exifParser;
+    cameraFeedbackPacket    geotag = job.geotag;
+    QByteArray              header = exifParser.readHeader(fileRead);
+
+    if (!header.isEmpty() && exifParser.patchGps(header, geotag)) {
+        // The header keeps its size, so the image data is copied as is instead of going through memory
+        fileRead.close();
+        QFile::remove(job.taggedFile);
+        if (!QFile::copy(job.imageFile, job.taggedFile)) {
+            return tr("Geotagging failed. Couldn't write to an image.");
+        }
+        QFile fileWrite(job.taggedFile);
+        if (!fileWrite.open(QIODevice::ReadWrite) || fileWrite.write(header) != header.size()) {
+            return tr("Geotagging failed. Couldn't write to an image.");
+        }
+        return QString();
+    }
+
+    fileRead.seek(0);
+    QByteArray imageBuffer = fileRead.readAll();
+    fileRead.close();
+
+    if (!exifParser.write(imageBuffer, geotag)) {
+        return tr("Geotagging failed. Couldn't write to image.");
+    }
+    QFile fileWrite(job.taggedFile);
+    if (!fileWrite.open(QFile::WriteOnly)) {
+        return tr("Geotagging failed. Couldn't write to an image.");
+    }
+    fileWrite.write(imageBuffer);
+    fileWrite.close();
+    return QString();
 }
 
 bool GeoTagWorker::triggerFiltering()
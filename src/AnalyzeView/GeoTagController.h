@@ -19,8 +19,12 @@
 #include <QFileInfoList>
 #include <QElapsedTimer>
 #include <QDebug>
+#include <QFuture>
 #include <QGeoCoordinate>
 
+#include <atomic>
+
+/// Images are parsed and tagged on the global thread pool, run() only drives the stages and polls progress
 class GeoTagWorker : public QThread
 {
     Q_OBJECT
@@ -50,6 +54,10 @@ public:
         uint8_t captureResult;
     };
 
+    /// Writes imageFile to taggedFile with the position of geotag in its Exif header, on any thread
+    /// @return Error message, empty for success
+    static QString  tagImage        (const QString& imageFile, const QString& taggedFile, const cameraFeedbackPacket& geotag);
+
 protected:
     void run() final;
 
@@ -59,9 +67,26 @@ signals:
     void progressChanged    (double progress);
 
 private:
+    typedef struct {
+        QString                 imageFile;
+        QString                 taggedFile;
+        cameraFeedbackPacket    geotag;
+    } TagJob_t;
+
     bool triggerFiltering();
 
-    bool                    _cancel;
+    /// Waits for the pool to finish the future, emitting progress from progressStart to progressStart + progressSpan
+    /// @return false: cancelled
+    bool _waitForFuture(QFuture<void> future, double progressStart, double progressSpan);
+
+    /// @return Creation time from the Exif header, NaN if the image can't be opened
+    static double   _readImageTime  (const QFileInfo& imageInfo);
+    /// @return Error message, empty for success
+    static QString  _tagImage       (const TagJob_t& job);
+
+    static const int _progressIntervalMSecs = 100;
+
+    std::atomic<bool>       _cancel;
     QString                 _logFile;
     QString                 _imageDirectory;
     QString                 _saveDirectory;
@@ -18,17 +18,22 @@
 #include "ParameterManager.h"
 #include "Vehicle.h"
 #include "SettingsManager.h"
+#include "FTPManager.h"
 
 #include <QDebug>
 #include <QSettings>
 #include <QUrl>
 #include <QBitArray>
+#include <QFileInfo>
 #include <QtCore/qmath.h>
 
 #define kTimeOutMilliseconds 500
 #define kGUIRateMilliseconds 17
 #define kTableBins           512
 #define kChunkSize           (kTableBins * MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN)
+#define kFtpMaxRetries       3
+
+static const char* kPX4LogDirectory = "/fs/microsd/log";
 
 QGC_LOGGING_CATEGORY(LogDownloadLog, "LogDownloadLog")
 
@@ -137,6 +142,9 @@ LogDownloadController::_setActiveVehicle(Vehicle* vehicle)
         _logEntriesModel.clear();
         disconnect(_uas, &UASInterface::logEntry, this, &LogDownloadController::_logEntry);
         disconnect(_uas, &UASInterface::logData,  this, &LogDownloadController::_logData);
+        disconnect(_vehicle->ftpManager(), &FTPManager::listDirectoryComplete, this, &LogDownloadController::_ftpListDirectoryComplete);
+        disconnect(_vehicle->ftpManager(), &FTPManager::downloadComplete,      this, &LogDownloadController::_ftpDownloadComplete);
+        disconnect(_vehicle->ftpManager(), &FTPManager::downloadProgress,      this, &LogDownloadController::_ftpDownloadProgress);
         _uas = nullptr;
     }
     _vehicle = vehicle;
@@ -144,6 +152,9 @@ LogDownloadController::_setActiveVehicle(Vehicle* vehicle)
         _uas = vehicle->uas();
         connect(_uas, &UASInterface::logEntry, this, &LogDownloadController::_logEntry);
         connect(_uas, &UASInterface::logData,  this, &LogDownloadController::_logData);
+        connect(_vehicle->ftpManager(), &FTPManager::listDirectoryComplete, this, &LogDownloadController::_ftpListDirectoryComplete);
+        connect(_vehicle->ftpManager(), &FTPManager::downloadComplete,      this, &LogDownloadController::_ftpDownloadComplete);
+        connect(_vehicle->ftpManager(), &FTPManager::downloadProgress,      this, &LogDownloadController::_ftpDownloadProgress);
     }
 }
 
@@ -408,6 +419,10 @@ LogDownloadController::_receivedAllData()
     _timer.stop();
     //-- Anything queued up for download?
     if(_prepareLogDownload()) {
+        if (!_downloadData->entry->ftpPath().isEmpty()) {
+            _ftpDownload();
+            return;
+        }
         //-- Request Log
         _requestLogData(_downloadData->ID, 0, _downloadData->chunk_table.size()*MAVLINK_MSG_LOG_DATA_FIELD_DATA_LEN);
         _timer.start(kTimeOutMilliseconds);
@@ -492,10 +507,151 @@ void
 LogDownloadController::refresh(void)
 {
     _logEntriesModel.clear();
+    if (_useFtp()) {
+        //-- List the log directory tree, much faster to download from than LOG_REQUEST_DATA
+        _ftpLogFiles.clear();
+        _ftpPendingDirectories = QStringList(kPX4LogDirectory);
+        _setListing(true);
+        _ftpListNextDirectory();
+        return;
+    }
     //-- Get first 50 entries
     _requestLogList(0, 49);
 }
 
+//----------------------------------------------------------------------------------------
+bool
+LogDownloadController::_useFtp() const
+{
+    return _vehicle && _vehicle->px4Firmware() && (_vehicle->capabilityBits() & MAV_PROTOCOL_CAPABILITY_FTP);
+}
+
+//----------------------------------------------------------------------------------------
+void
+LogDownloadController::_ftpListNextDirectory()
+{
+    if (!_ftpPendingDirectories.isEmpty()) {
+        if (_vehicle->ftpManager()->listDirectory(_ftpPendingDirectories.first())) {
+            return;
+        }
+        qCWarning(LogDownloadLog) << "Unable to list log directory" << _ftpPendingDirectories.first();
+        _ftpPendingDirectories.clear();
+    }
+
+    //-- Paths sort by date and time, the same as the log ids of LOG_REQUEST_LIST
+    uint id = 0;
+    for (auto it = _ftpLogFiles.constBegin(); it != _ftpLogFiles.constEnd(); ++it) {
+        const QStringList pathParts = it.key().split('/');
+        QDateTime time = QDateTime::fromString(QStringLiteral("%1 %2").arg(pathParts.value(pathParts.count() - 2), QFileInfo(it.key()).completeBaseName()),
+                                               QStringLiteral("yyyy-MM-dd hh_mm_ss"));
+        time.setTimeSpec(Qt::UTC);
+        QGCLogEntry* entry = new QGCLogEntry(id++, time, it.value(), true);
+        entry->setFtpPath(it.key());
+        entry->setStatus(tr("Available"));
+        _logEntriesModel.append(entry);
+    }
+    _receivedAllEntries();
+}
+
+//----------------------------------------------------------------------------------------
+void
+LogDownloadController::_ftpListDirectoryComplete(const QStringList& dirList, const QString& errorMsg)
+{
+    if (!_requestingLogEntries || _ftpPendingDirectories.isEmpty()) {
+        return;
+    }
+    const QString directory = _ftpPendingDirectories.takeFirst();
+    if (!errorMsg.isEmpty()) {
+        qCWarning(LogDownloadLog) << "Listing log directory failed" << directory << errorMsg;
+    }
+    for (const QString& entry: dirList) {
+        const QString name = entry.mid(1).section('\t', 0, 0);
+        if (entry.startsWith('D') && name != QStringLiteral(".") && name != QStringLiteral("..")) {
+            _ftpPendingDirectories.append(directory + '/' + name);
+        } else if (entry.startsWith('F') && name.endsWith(QStringLiteral(".ulg"))) {
+            _ftpLogFiles[directory + '/' + name] = entry.section('\t', 1, 1).toUInt();
+        }
+    }
+    _ftpListNextDirectory();
+}
+
+//----------------------------------------------------------------------------------------
+QString
+LogDownloadController::_ftpPartialFileName(const QGCLogEntry* entry) const
+{
+    //-- Named after the path on the vehicle, so downloading the same log again resumes it
+    const QStringList pathParts = entry->ftpPath().split('/');
+    return QStringLiteral("%1_%2.part").arg(pathParts.value(pathParts.count() - 2), pathParts.last());
+}
+
+//----------------------------------------------------------------------------------------
+void
+LogDownloadController::_ftpDownload()
+{
+    const QString partialFileName = _ftpPartialFileName(_downloadData->entry);
+    _downloadData->written      = static_cast<uint>(QFileInfo(_downloadPath + partialFileName).size());
+    _downloadData->rate_bytes   = 0;
+    _downloadData->elapsed.start();
+    if (!_vehicle->ftpManager()->download(_downloadData->entry->ftpPath(), _downloadPath, partialFileName, true /* resume */)) {
+        qCWarning(LogDownloadLog) << "FTP download failed to start" << _downloadData->entry->ftpPath();
+        _downloadData->entry->setStatus(tr("Error"));
+        _receivedAllData();
+    }
+}
+
+//----------------------------------------------------------------------------------------
+void
+LogDownloadController::_ftpDownloadProgress(quint32 bytesWritten, quint32 /*fileSize*/)
+{
+    if (!_downloadData || _downloadData->entry->ftpPath().isEmpty()) {
+        return;
+    }
+    if (bytesWritten > _downloadData->written) {
+        _downloadData->rate_bytes   += bytesWritten - _downloadData->written;
+        _downloadData->written      = bytesWritten;
+    }
+    _updateDataRate();
+}
+
+//----------------------------------------------------------------------------------------
+void
+LogDownloadController::_ftpDownloadComplete(const QString& file, const QString& errorMsg)
+{
+    if (!_downloadData || _downloadData->entry->ftpPath().isEmpty() || QFileInfo(file).fileName() != _ftpPartialFileName(_downloadData->entry)) {
+        return;
+    }
+    QGCLogEntry* entry = _downloadData->entry;
+
+    if (errorMsg.isEmpty()) {
+        //-- Append a number to the end if the filename already exists
+        QString     fileName = _downloadPath + _downloadData->filename;
+        QFileInfo   fileInfo(fileName);
+        for (uint num_dups = 1; QFile::exists(fileName); num_dups++) {
+            fileName = QStringLiteral("%1%2_%3.%4").arg(_downloadPath, fileInfo.completeBaseName()).arg(num_dups).arg(fileInfo.suffix());
+        }
+        if (QFile::rename(file, fileName)) {
+            entry->setStatus(tr("Downloaded"));
+        } else {
+            qCWarning(LogDownloadLog) << "Unable to rename" << file << "to" << fileName;
+            entry->setStatus(tr("Error"));
+        }
+    } else if (++_ftpRetries <= kFtpMaxRetries) {
+        //-- The partial file is kept, the retry continues after its end
+        qCDebug(LogDownloadLog) << "FTP download failed, retrying" << errorMsg << _ftpRetries;
+        entry->setStatus(tr("Retrying"));
+        QTimer::singleShot(kTimeOutMilliseconds, this, [this, entry]() {
+            if (_downloadData && _downloadData->entry == entry) {
+                _ftpDownload();
+            }
+        });
+        return;
+    } else {
+        qCWarning(LogDownloadLog) << "FTP download failed" << errorMsg;
+        entry->setStatus(tr("Incomplete, download again to resume"));
+    }
+    _receivedAllData();
+}
+
 //----------------------------------------------------------------------------------------
 void
 LogDownloadController::_requestLogList(uint32_t start, uint32_t end)
@@ -604,6 +760,12 @@ LogDownloadController::_prepareLogDownload()
     }
     _downloadData = new LogDownloadData(entry);
     _downloadData->filename = QString("log_") + QString::number(entry->id()) + "_" + ftime;
+    if (!entry->ftpPath().isEmpty()) {
+        //-- Downloads into a partial file which is renamed once complete, see _ftpDownloadComplete
+        _downloadData->filename += ".ulg";
+        _ftpRetries = 0;
+        return true;
+    }
     if (_vehicle->firmwareType() == MAV_AUTOPILOT_PX4) {
         QString loggerParam = QStringLiteral("SYS_LOGGER");
         if (_vehicle->parameterManager()->parameterExists(FactSystem::defaultComponentId, loggerParam) &&
@@ -706,8 +868,13 @@ LogDownloadController::cancel(void)
         if (_downloadData->file.exists()) {
             _downloadData->file.remove();
         }
+        const QString ftpPartialFile = _downloadData->entry->ftpPath().isEmpty() ? QString() : _downloadPath + _ftpPartialFileName(_downloadData->entry);
         delete _downloadData;
         _downloadData = 0;
+        if (!ftpPartialFile.isEmpty()) {
+            _vehicle->ftpManager()->cancelDownload();
+            QFile::remove(ftpPartialFile);
+        }
     }
     _resetSelection(true);
     _setDownloading(false);
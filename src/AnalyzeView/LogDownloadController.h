@@ -16,6 +16,7 @@
 #include <QAbstractListModel>
 #include <QLocale>
 #include <QElapsedTimer>
+#include <QMap>
 
 #include <memory>
 
@@ -83,6 +84,7 @@ public:
     bool        received    () const { return _received; }
     bool        selected    () const { return _selected; }
     QString     status      () const { return _status; }
+    QString     ftpPath     () const { return _ftpPath; }   ///< Path on the vehicle for logs listed over MAVLink FTP
 
     void        setId       (uint id_)          { _logID = id_; }
     void        setSize     (uint size_)        { _logSize = size_;     emit sizeChanged(); }
@@ -90,6 +92,7 @@ public:
     void        setReceived (bool rec_)         { _received = rec_;     emit receivedChanged(); }
     void        setSelected (bool sel_)         { _selected = sel_;     emit selectedChanged(); }
     void        setStatus   (QString stat_)     { _status = stat_;      emit statusChanged(); }
+    void        setFtpPath  (QString path_)     { _ftpPath = path_; }
 
 signals:
     void        idChanged       ();
@@ -106,6 +109,7 @@ private:
     bool        _received;
     bool        _selected;
     QString     _status;
+    QString     _ftpPath;
 };
 
 //-----------------------------------------------------------------------------
@@ -142,6 +146,9 @@ private slots:
     void _logEntry          (UASInterface *uas, uint32_t time_utc, uint32_t size, uint16_t id, uint16_t num_logs, uint16_t last_log_num);
     void _logData           (UASInterface *uas, uint32_t ofs, uint16_t id, uint8_t count, const uint8_t *data);
     void _processDownload   ();
+    void _ftpListDirectoryComplete  (const QStringList& dirList, const QString& errorMsg);
+    void _ftpDownloadComplete       (const QString& file, const QString& errorMsg);
+    void _ftpDownloadProgress       (quint32 bytesWritten, quint32 fileSize);
 
 private:
     bool _entriesComplete   ();
@@ -158,6 +165,10 @@ private:
     void _setDownloading    (bool active);
     void _setListing        (bool active);
     void _updateDataRate    ();
+    bool _useFtp            () const;
+    void _ftpListNextDirectory();
+    void _ftpDownload       ();
+    QString _ftpPartialFileName(const QGCLogEntry* entry) const;
 
     QGCLogEntry* _getNextSelected();
 
@@ -171,6 +182,9 @@ private:
     int                 _retries;
     int                 _apmOneBased;
     QString             _downloadPath;
+    QStringList         _ftpPendingDirectories;     ///< Still to be listed, the first one is being listed
+    QMap<QString, uint> _ftpLogFiles;               ///< Size of each log found, by path on the vehicle
+    int                 _ftpRetries             = 0;
 };
 
 #endif
@@ -0,0 +1,152 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LogIndexController.h"
+#include "LogIndexManager.h"
+#include "QGCApplication.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileInfo>
+
+LogIndexController::LogIndexController(QObject* parent)
+    : QAbstractListModel(parent)
+    , _manager          (qgcApp()->toolbox()->logIndexManager())
+{
+    connect(_manager, &LogIndexManager::indexUpdated,       this, &LogIndexController::search);
+    connect(_manager, &LogIndexManager::indexingChanged,    this, &LogIndexController::indexingChanged);
+    connect(_manager, &LogIndexManager::progressChanged,    this, &LogIndexController::indexingChanged);
+
+    search();
+}
+
+bool LogIndexController::indexing(void) const
+{
+    return _manager->indexing();
+}
+
+double LogIndexController::progress(void) const
+{
+    return _manager->progress();
+}
+
+int LogIndexController::logCount(void) const
+{
+    return _manager->logCount();
+}
+
+void LogIndexController::search(void)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    beginResetModel();
+    _manager->query(_query, _entries, _errorString);
+    endResetModel();
+    _queryMSecs = timer.nsecsElapsed() / 1e6;
+
+    _vehicleIds.clear();
+    for (int id: _manager->vehicleIds()) {
+        _vehicleIds.append(id);
+    }
+    emit resultsChanged();
+}
+
+void LogIndexController::update(void)
+{
+    _manager->update();
+}
+
+void LogIndexController::setSearchText(const QString& searchText)
+{
+    if (searchText != _query.text) {
+        _query.text = searchText;
+        emit searchTextChanged();
+        search();
+    }
+}
+
+void LogIndexController::setVehicleId(int vehicleId)
+{
+    if (vehicleId != _query.vehicleId) {
+        _query.vehicleId = vehicleId;
+        emit vehicleIdChanged();
+        search();
+    }
+}
+
+void LogIndexController::setErrorsOnly(bool errorsOnly)
+{
+    if (errorsOnly != _query.errorsOnly) {
+        _query.errorsOnly = errorsOnly;
+        emit errorsOnlyChanged();
+        search();
+    }
+}
+
+int LogIndexController::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : _entries.count();
+}
+
+QVariant LogIndexController::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= _entries.count()) {
+        return QVariant();
+    }
+
+    const LogIndexer::Entry_t& entry = _entries[index.row()];
+    switch (role) {
+    case Qt::DisplayRole:
+    case FileNameRole:
+        return QFileInfo(entry.path).fileName();
+    case PathRole:
+        return entry.path;
+    case TypeRole:
+        return entry.type;
+    case VehicleIdRole:
+        return entry.vehicleId;
+    case StartTimeRole:
+        return QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(entry.startUSecs / 1000));
+    case DurationRole:
+        return entry.durationSecs;
+    case MaxAltitudeRole:
+        return entry.maxAltitude;
+    case MinBatteryVoltageRole:
+        return entry.minBatteryVoltage;
+    case MinBatteryRemainingRole:
+        return entry.minBatteryRemaining;
+    case ErrorCountRole:
+        return entry.errorCount;
+    case WarningCountRole:
+        return entry.warningCount;
+    case MessageRole:
+        return entry.message;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> LogIndexController::roleNames(void) const
+{
+    return {
+        { FileNameRole,             "fileName" },
+        { PathRole,                 "path" },
+        { TypeRole,                 "type" },
+        { VehicleIdRole,            "vehicleId" },
+        { StartTimeRole,            "startTime" },
+        { DurationRole,             "duration" },
+        { MaxAltitudeRole,          "maxAltitude" },
+        { MinBatteryVoltageRole,    "minBatteryVoltage" },
+        { MinBatteryRemainingRole,  "minBatteryRemaining" },
+        { ErrorCountRole,           "errorCount" },
+        { WarningCountRole,         "warningCount" },
+        { MessageRole,              "message" },
+    };
+}
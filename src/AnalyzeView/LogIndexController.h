@@ -0,0 +1,94 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "LogIndexer.h"
+
+#include <QAbstractListModel>
+#include <QVariantList>
+
+class LogIndexManager;
+
+/// Controller for LogIndexPage.qml. The model holds the logs of the index which match the search criteria, it
+/// searches again whenever a criterion changes or the index was updated.
+class LogIndexController : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    LogIndexController(QObject* parent = nullptr);
+
+    enum Roles {
+        FileNameRole = Qt::UserRole + 1,
+        PathRole,
+        TypeRole,
+        VehicleIdRole,
+        StartTimeRole,
+        DurationRole,
+        MaxAltitudeRole,
+        MinBatteryVoltageRole,
+        MinBatteryRemainingRole,
+        ErrorCountRole,
+        WarningCountRole,
+        MessageRole,
+    };
+
+    Q_PROPERTY(QString      searchText  READ searchText WRITE setSearchText NOTIFY searchTextChanged)
+    Q_PROPERTY(int          vehicleId   READ vehicleId  WRITE setVehicleId  NOTIFY vehicleIdChanged)     ///< 0 for any
+    Q_PROPERTY(bool         errorsOnly  READ errorsOnly WRITE setErrorsOnly NOTIFY errorsOnlyChanged)
+    Q_PROPERTY(QVariantList vehicleIds  READ vehicleIds                     NOTIFY resultsChanged)
+    Q_PROPERTY(int          count       READ count                          NOTIFY resultsChanged)
+    Q_PROPERTY(double       queryMSecs  READ queryMSecs                     NOTIFY resultsChanged)
+    Q_PROPERTY(QString      errorString READ errorString                    NOTIFY resultsChanged)
+    Q_PROPERTY(bool         indexing    READ indexing                       NOTIFY indexingChanged)
+    Q_PROPERTY(double       progress    READ progress                       NOTIFY indexingChanged)
+    Q_PROPERTY(int          logCount    READ logCount                       NOTIFY resultsChanged)
+
+    /// Searches the index again
+    Q_INVOKABLE void search (void);
+
+    /// Rescans the log directories
+    Q_INVOKABLE void update (void);
+
+    QString         searchText  (void) const { return _query.text; }
+    int             vehicleId   (void) const { return _query.vehicleId; }
+    bool            errorsOnly  (void) const { return _query.errorsOnly; }
+    QVariantList    vehicleIds  (void) const { return _vehicleIds; }
+    int             count       (void) const { return _entries.count(); }
+    double          queryMSecs  (void) const { return _queryMSecs; }
+    QString         errorString (void) const { return _errorString; }
+    bool            indexing    (void) const;
+    double          progress    (void) const;
+    int             logCount    (void) const;
+
+    void setSearchText  (const QString& searchText);
+    void setVehicleId   (int vehicleId);
+    void setErrorsOnly  (bool errorsOnly);
+
+    // QAbstractListModel overrides
+    int                     rowCount    (const QModelIndex& parent = QModelIndex()) const override;
+    QVariant                data        (const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray>  roleNames   (void) const override;
+
+signals:
+    void searchTextChanged  (void);
+    void vehicleIdChanged   (void);
+    void errorsOnlyChanged  (void);
+    void resultsChanged     (void);
+    void indexingChanged    (void);
+
+private:
+    LogIndexManager*            _manager    = nullptr;
+    LogIndexer::Query_t         _query;
+    QList<LogIndexer::Entry_t>  _entries;
+    QVariantList                _vehicleIds;
+    double                      _queryMSecs = 0;
+    QString                     _errorString;
+};
@@ -0,0 +1,188 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LogIndexManager.h"
+#include "LogIndexer.h"
+#include "QGCApplication.h"
+#include "SettingsManager.h"
+#include "AppSettings.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QStandardPaths>
+
+QGC_LOGGING_CATEGORY(LogIndexManagerLog, "LogIndexManagerLog")
+
+LogIndexManager::LogIndexManager(QGCApplication* app, QGCToolbox* toolbox)
+    : QGCTool(app, toolbox)
+{
+    _connectionName = QStringLiteral("LogIndexManager%1").arg(reinterpret_cast<quintptr>(this));
+}
+
+LogIndexManager::~LogIndexManager()
+{
+    if (_indexer) {
+        _indexer->stop();
+    }
+    _indexerThread.quit();
+    _indexerThread.wait();
+
+    if (_databaseOpen) {
+        QSqlDatabase::database(_connectionName, false).close();
+    }
+    QSqlDatabase::removeDatabase(_connectionName);
+}
+
+void LogIndexManager::setToolbox(QGCToolbox* toolbox)
+{
+    QGCTool::setToolbox(toolbox);
+
+    // The indexer is deleted on its own thread once the thread is done
+    _indexer = new LogIndexer(databaseFile());
+    _indexer->moveToThread(&_indexerThread);
+    connect(&_indexerThread,    &QThread::finished,                 _indexer,   &QObject::deleteLater);
+    connect(this,               &LogIndexManager::_update,          _indexer,   &LogIndexer::update,                    Qt::QueuedConnection);
+    connect(_indexer,           &LogIndexer::progressChanged,       this,       &LogIndexManager::_indexerProgress,     Qt::QueuedConnection);
+    connect(_indexer,           &LogIndexer::updated,               this,       &LogIndexManager::_indexerUpdated,      Qt::QueuedConnection);
+    _indexerThread.setObjectName(QStringLiteral("LogIndexer"));
+    _indexerThread.setPriority(QThread::LowPriority);
+    _indexerThread.start();
+
+    _updateTimer.setSingleShot(true);
+    _updateTimer.setInterval(updateDelayMSecs);
+    connect(&_updateTimer,  &QGCWheelTimer::timeout,                this, &LogIndexManager::update);
+    connect(&_watcher,      &QFileSystemWatcher::directoryChanged,  this, &LogIndexManager::_directoryChanged);
+    connect(toolbox->settingsManager()->appSettings(), &AppSettings::savePathsChanged, this, &LogIndexManager::_directoryChanged);
+}
+
+void LogIndexManager::deferredInit(void)
+{
+    // Unit tests use an indexer of their own on directories of their own
+    if (!qgcApp()->runningUnitTests()) {
+        _watchDirectories();
+        update();
+    }
+}
+
+QString LogIndexManager::databaseFile(void)
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).absoluteFilePath(QStringLiteral("LogIndex.db"));
+}
+
+QStringList LogIndexManager::directories(void)
+{
+    AppSettings* appSettings = _toolbox->settingsManager()->appSettings();
+
+    QStringList directories;
+    for (const QString& directory: { appSettings->telemetrySavePath(), appSettings->logSavePath() }) {
+        if (!directory.isEmpty() && QDir(directory).exists()) {
+            directories.append(directory);
+        }
+    }
+    return directories;
+}
+
+void LogIndexManager::update(void)
+{
+    if (_indexing) {
+        _updatePending = true;
+        return;
+    }
+    _indexing   = true;
+    _progress   = 0;
+    emit indexingChanged();
+    emit progressChanged();
+    emit _update(directories());
+}
+
+void LogIndexManager::_watchDirectories(void)
+{
+    if (!_watcher.directories().isEmpty()) {
+        _watcher.removePaths(_watcher.directories());
+    }
+    const QStringList watched = directories();
+    if (!watched.isEmpty()) {
+        _watcher.addPaths(watched);
+    }
+}
+
+void LogIndexManager::_directoryChanged(void)
+{
+    // The save path may have moved or a directory may have been created since
+    _watchDirectories();
+    _updateTimer.start();
+}
+
+void LogIndexManager::_indexerProgress(int summarized, int total)
+{
+    _progress = total ? static_cast<double>(summarized) / total : 1.0;
+    emit progressChanged();
+}
+
+void LogIndexManager::_indexerUpdated(int logCount, bool changed)
+{
+    qCDebug(LogIndexManagerLog) << "Index updated logCount:changed" << logCount << changed;
+
+    _indexing   = false;
+    _progress   = 1.0;
+    _logCount   = logCount;
+    emit indexingChanged();
+    emit progressChanged();
+    emit indexUpdated();
+
+    if (_updatePending) {
+        _updatePending = false;
+        update();
+    }
+}
+
+bool LogIndexManager::_openDatabase(void)
+{
+    if (_databaseOpen) {
+        return true;
+    }
+
+    // The indexer creates the schema, until its first update is done there is nothing to find
+    const QString fileName = databaseFile();
+    if (!QFile::exists(fileName)) {
+        return false;
+    }
+
+    QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), _connectionName);
+    db.setDatabaseName(fileName);
+    if (!db.open()) {
+        qCWarning(LogIndexManagerLog) << "Unable to open log index" << fileName << db.lastError().text();
+        return false;
+    }
+    _databaseOpen = true;
+    return true;
+}
+
+bool LogIndexManager::query(const LogIndexer::Query_t& query, QList<LogIndexer::Entry_t>& entries, QString& errorString)
+{
+    entries.clear();
+    errorString.clear();
+
+    if (!_openDatabase()) {
+        return true;
+    }
+    QSqlDatabase db = QSqlDatabase::database(_connectionName, false);
+    return LogIndexer::query(db, query, entries, errorString);
+}
+
+QList<int> LogIndexManager::vehicleIds(void)
+{
+    if (!_openDatabase()) {
+        return QList<int>();
+    }
+    QSqlDatabase db = QSqlDatabase::database(_connectionName, false);
+    return LogIndexer::vehicleIds(db);
+}
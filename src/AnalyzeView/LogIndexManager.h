@@ -0,0 +1,93 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCToolbox.h"
+#include "QGCTimerWheel.h"
+#include "QGCLoggingCategory.h"
+#include "LogIndexer.h"
+
+#include <QFileSystemWatcher>
+#include <QList>
+#include <QStringList>
+#include <QThread>
+
+Q_DECLARE_LOGGING_CATEGORY(LogIndexManagerLog)
+
+/// Keeps the log index of the telemetry and log save directories up to date and answers queries of it. A LogIndexer
+/// on a worker thread does the indexing, once at startup and then whenever the directories change, so logs which
+/// are saved or downloaded show up after updateDelayMSecs. Queries run here through a connection of their own and
+/// only touch the index, never the logs.
+class LogIndexManager : public QGCTool
+{
+    Q_OBJECT
+
+public:
+    LogIndexManager(QGCApplication* app, QGCToolbox* toolbox);
+    ~LogIndexManager();
+
+    Q_PROPERTY(bool     indexing    READ indexing   NOTIFY indexingChanged)
+    Q_PROPERTY(double   progress    READ progress   NOTIFY progressChanged)
+    Q_PROPERTY(int      logCount    READ logCount   NOTIFY indexUpdated)
+
+    /// Newest logs first, see LogIndexer::query
+    /// @return false: query failed, errorString set
+    bool query(const LogIndexer::Query_t& query, QList<LogIndexer::Entry_t>& entries, QString& errorString);
+
+    /// @return Vehicle ids in the index, ascending
+    QList<int> vehicleIds(void);
+
+    /// Starts updating the index, queued behind an update which is running
+    Q_INVOKABLE void update(void);
+
+    bool    indexing    (void) const { return _indexing; }
+    double  progress    (void) const { return _progress; }
+    int     logCount    (void) const { return _logCount; }
+
+    /// The index lives with the application data, not with the logs, so changing the save path keeps it
+    static QString databaseFile(void);
+
+    /// @return Directories which are indexed
+    QStringList directories(void);
+
+    // QGCTool overrides
+    void setToolbox(QGCToolbox* toolbox) final;
+    void deferredInit(void) final;
+
+    static const int updateDelayMSecs = 2000;   ///< Saving a log is a burst of changes, indexing waits for quiet
+
+signals:
+    void indexingChanged    (void);
+    void progressChanged    (void);
+    void indexUpdated       (void);
+
+    // Queued to the indexer
+    void _update            (const QStringList directories);
+
+private slots:
+    void _directoryChanged  (void);
+    void _indexerProgress   (int summarized, int total);
+    void _indexerUpdated    (int logCount, bool changed);
+
+private:
+    bool _openDatabase      (void);
+    void _watchDirectories  (void);
+
+    QThread             _indexerThread;
+    LogIndexer*         _indexer            = nullptr;
+    QFileSystemWatcher  _watcher;
+    QGCWheelTimer       _updateTimer        { "LogIndex" };
+    QString             _connectionName;
+    bool                _databaseOpen       = false;
+    bool                _indexing           = false;
+    bool                _updatePending      = false;    ///< Directories changed during the running update
+    double              _progress           = 0;
+    int                 _logCount           = 0;
+};
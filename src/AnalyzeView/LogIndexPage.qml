@@ -0,0 +1,152 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+import QtQuick                      2.11
+import QtQuick.Controls             2.4
+import QtQuick.Layouts              1.11
+
+import QGroundControl               1.0
+import QGroundControl.Palette       1.0
+import QGroundControl.Controls      1.0
+import QGroundControl.Controllers   1.0
+import QGroundControl.ScreenTools   1.0
+
+AnalyzePage {
+    id:                 logIndexPage
+    pageComponent:      pageComponent
+    pageName:           qsTr("Log Index")
+    pageDescription:    qsTr("Log Index searches all telemetry logs and downloaded logs on this computer. Logs are indexed in the background as they are saved.")
+
+    property real _margin:          ScreenTools.defaultFontPixelWidth
+    property var  _columnWidths:    [ 30, 18, 6, 8, 8, 8, 6 ]
+
+    QGCPalette { id: qgcPal; colorGroupEnabled: enabled }
+
+    LogIndexController {
+        id: logIndexController
+    }
+
+    function _number(value, decimals, unit) {
+        return isNaN(value) ? "-" : value.toFixed(decimals) + unit
+    }
+
+    function _duration(secs) {
+        var minutes = Math.floor(secs / 60)
+        var seconds = Math.floor(secs % 60)
+        return minutes + ":" + (seconds < 10 ? "0" : "") + seconds
+    }
+
+    Component {
+        id: pageComponent
+
+        ColumnLayout {
+            width:      availableWidth
+            height:     availableHeight
+            spacing:    _margin
+
+            RowLayout {
+                Layout.fillWidth:   true
+                spacing:            _margin
+
+                QGCTextField {
+                    Layout.fillWidth:   true
+                    placeholderText:    qsTr("Search file names and messages")
+                    onTextChanged:      logIndexController.searchText = text
+                }
+
+                QGCComboBox {
+                    model:          [ qsTr("All Vehicles") ].concat(logIndexController.vehicleIds.map(function(id) { return qsTr("Vehicle %1").arg(id) }))
+                    onActivated:    logIndexController.vehicleId = index === 0 ? 0 : logIndexController.vehicleIds[index - 1]
+                }
+
+                QGCCheckBox {
+                    text:       qsTr("Errors only")
+                    checked:    logIndexController.errorsOnly
+                    onClicked:  logIndexController.errorsOnly = checked
+                }
+
+                QGCButton {
+                    text:       qsTr("Rescan")
+                    enabled:    !logIndexController.indexing
+                    onClicked:  logIndexController.update()
+                }
+            }
+
+            QGCLabel {
+                text: {
+                    var status = qsTr("%1 of %2 logs (%3 ms)").arg(logIndexController.count).arg(logIndexController.logCount).arg(logIndexController.queryMSecs.toFixed(1))
+                    if (logIndexController.indexing) {
+                        status += " - " + qsTr("Indexing %1%").arg(Math.round(logIndexController.progress * 100))
+                    }
+                    if (logIndexController.errorString !== "") {
+                        status += " - " + logIndexController.errorString
+                    }
+                    return status
+                }
+            }
+
+            Row {
+                Repeater {
+                    model: [ qsTr("Log"), qsTr("Date"), qsTr("Vehicle"), qsTr("Duration"), qsTr("Max Alt"), qsTr("Min Battery"), qsTr("Errors"), qsTr("Message") ]
+                    QGCLabel {
+                        width:          index < _columnWidths.length ? ScreenTools.defaultFontPixelWidth * _columnWidths[index] : implicitWidth
+                        text:           modelData
+                        font.family:    ScreenTools.demiboldFontFamily
+                    }
+                }
+            }
+
+            QGCListView {
+                id:                 logList
+                Layout.fillWidth:   true
+                Layout.fillHeight:  true
+                clip:               true
+                model:              logIndexController
+
+                delegate: Row {
+                    QGCLabel {
+                        width:  ScreenTools.defaultFontPixelWidth * _columnWidths[0]
+                        text:   fileName
+                        elide:  Text.ElideMiddle
+                    }
+                    QGCLabel {
+                        width:  ScreenTools.defaultFontPixelWidth * _columnWidths[1]
+                        text:   startTime.toLocaleString(Qt.locale(), Locale.ShortFormat)
+                    }
+                    QGCLabel {
+                        width:  ScreenTools.defaultFontPixelWidth * _columnWidths[2]
+                        text:   vehicleId ? vehicleId : "-"
+                    }
+                    QGCLabel {
+                        width:  ScreenTools.defaultFontPixelWidth * _columnWidths[3]
+                        text:   _duration(duration)
+                    }
+                    QGCLabel {
+                        width:  ScreenTools.defaultFontPixelWidth * _columnWidths[4]
+                        text:   _number(maxAltitude, 1, " m")
+                    }
+                    QGCLabel {
+                        width:  ScreenTools.defaultFontPixelWidth * _columnWidths[5]
+                        text:   isNaN(minBatteryRemaining) ? _number(minBatteryVoltage, 2, " V") : _number(minBatteryRemaining, 0, " %")
+                    }
+                    QGCLabel {
+                        width:  ScreenTools.defaultFontPixelWidth * _columnWidths[6]
+                        text:   errorCount
+                        color:  errorCount ? qgcPal.colorRed : qgcPal.text
+                    }
+                    QGCLabel {
+                        width:  logList.width - x
+                        text:   message
+                        elide:  Text.ElideRight
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,701 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LogIndexer.h"
+#include "MAVLinkFramer.h"
+#include "QGCMAVLink.h"
+#include "TlogIndex.h"
+#include "ULogReader.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+#include <QtNumeric>
+
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+QGC_LOGGING_CATEGORY(LogIndexerLog, "LogIndexerLog")
+
+const char* LogIndexer::tlogSuffix = "tlog";
+const char* LogIndexer::ulogSuffix = "ulg";
+
+static const int _readChunkSize = 1024 * 1024;
+
+static void _updateMin(double& min, double value)
+{
+    if (std::isnan(min) || value < min) {
+        min = value;
+    }
+}
+
+static void _updateMax(double& max, double value)
+{
+    if (std::isnan(max) || value > max) {
+        max = value;
+    }
+}
+
+/// NULL for NaN
+static QVariant _realValue(double value)
+{
+    return std::isnan(value) ? QVariant(QVariant::Double) : QVariant(value);
+}
+
+static void _addMessage(LogIndexer::Summary_t& summary, quint64 timeUSecs, int severity, const QString& text)
+{
+    if (severity <= MAV_SEVERITY_ERROR) {
+        summary.errorCount++;
+    } else if (severity <= MAV_SEVERITY_WARNING) {
+        summary.warningCount++;
+    } else {
+        return;
+    }
+    if (summary.messages.count() < LogIndexer::maxMessagesPerLog) {
+        summary.messages.append({ timeUSecs, severity, text.trimmed() });
+    }
+}
+
+/// NaN for NULL
+static double _realFromValue(const QVariant& value)
+{
+    return value.isNull() ? qQNaN() : value.toDouble();
+}
+
+/// Calls valueFunction with the value of the field in every sample of the first instance of the topic
+static void _forEachValue(const ULogReader& reader, const QString& topicName, const QString& fieldName, std::function<void(quint64 timestamp, double value)> valueFunction)
+{
+    const ULogReader::Topic_t* topic = reader.topic(topicName);
+    if (!topic) {
+        return;
+    }
+    const ULogReader::Field_t* field = reader.field(topicName, fieldName);
+    if (!field) {
+        return;
+    }
+    const int count = reader.sampleCount(topic);
+    for (int i=0; i<count; i++) {
+        valueFunction(reader.sampleTimestamp(topic, i), ULogReader::fieldValue(reader.sample(topic, i), *field));
+    }
+}
+
+LogIndexer::LogIndexer(const QString& databaseFile, QObject* parent)
+    : QObject       (parent)
+    , _databaseFile (databaseFile)
+    , _stop         (false)
+{
+    _connectionName = QStringLiteral("LogIndexer%1").arg(reinterpret_cast<quintptr>(this));
+}
+
+LogIndexer::~LogIndexer()
+{
+    if (_opened) {
+        QSqlDatabase::database(_connectionName, false).close();
+    }
+    QSqlDatabase::removeDatabase(_connectionName);
+}
+
+int LogIndexer::logType(const QString& fileName)
+{
+    const QString suffix = QFileInfo(fileName).suffix();
+    if (suffix.compare(QLatin1String(tlogSuffix), Qt::CaseInsensitive) == 0) {
+        return LogTypeTlog;
+    } else if (suffix.compare(QLatin1String(ulogSuffix), Qt::CaseInsensitive) == 0) {
+        return LogTypeULog;
+    }
+    return -1;
+}
+
+void LogIndexer::_clearSummary(Summary_t& summary)
+{
+    summary.vehicleId           = 0;
+    summary.startUSecs          = 0;
+    summary.durationSecs        = 0;
+    summary.maxAltitude         = qQNaN();
+    summary.minBatteryVoltage   = qQNaN();
+    summary.minBatteryRemaining = qQNaN();
+    summary.minLatitude         = qQNaN();
+    summary.maxLatitude         = qQNaN();
+    summary.minLongitude        = qQNaN();
+    summary.maxLongitude        = qQNaN();
+    summary.errorCount          = 0;
+    summary.warningCount        = 0;
+    summary.messages.clear();
+}
+
+bool LogIndexer::summarize(const QString& fileName, Summary_t& summary, QString& errorString)
+{
+    switch (logType(fileName)) {
+    case LogTypeTlog:
+        return summarizeTlog(fileName, summary, errorString);
+    case LogTypeULog:
+        return summarizeULog(fileName, summary, errorString);
+    default:
+        _clearSummary(summary);
+        errorString = tr("Not a log file: '%1'").arg(fileName);
+        return false;
+    }
+}
+
+bool LogIndexer::summarizeTlog(const QString& fileName, Summary_t& summary, QString& errorString)
+{
+    _clearSummary(summary);
+
+    QFile file(fileName);
+    if (!file.open(QFile::ReadOnly)) {
+        errorString = tr("Unable to open log file: '%1', error: %2").arg(fileName, file.errorString());
+        return false;
+    }
+
+    QByteArray          buffer;
+    int                 position        = 0;
+    quint64             recordCount     = 0;
+    quint64             lastUSecs       = 0;
+    QHash<int, QString> chunkedTexts;   ///< Chunked status text being assembled, by component
+    mavlink_message_t   message;
+
+    forever {
+        // Keep at least one whole record ahead, unless the end of the log was reached
+        if (buffer.size() - position < TlogIndex::cbTimestamp + MAVLINK_MAX_PACKET_LEN && !file.atEnd()) {
+            buffer.remove(0, position);
+            position = 0;
+            buffer.append(file.read(_readChunkSize));
+        }
+
+        const int available = buffer.size() - position;
+        if (available <= TlogIndex::cbTimestamp) {
+            break;
+        }
+
+        // Decoding on the side leaves the channels of the protocol untouched, so this is safe on any thread
+        const char* record = buffer.constData() + position;
+        const int   length = MAVLinkFramer::decodePacket(reinterpret_cast<const uint8_t*>(record + TlogIndex::cbTimestamp), available - TlogIndex::cbTimestamp, message);
+        if (length == 0) {
+            // Partial record at the end of the log
+            break;
+        } else if (length < 0) {
+            // Corrupt data, resync on the next byte
+            position++;
+            continue;
+        }
+        position += TlogIndex::cbTimestamp + length;
+
+        const quint64 timeUSecs = TlogIndex::parseTimestamp(record);
+        if (recordCount++ == 0) {
+            summary.startUSecs = timeUSecs;
+        }
+        lastUSecs = qMax(lastUSecs, timeUSecs);
+
+        if (message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+            if (summary.vehicleId == 0) {
+                mavlink_heartbeat_t heartbeat;
+                mavlink_msg_heartbeat_decode(&message, &heartbeat);
+                if (heartbeat.type != MAV_TYPE_GCS && heartbeat.autopilot != MAV_AUTOPILOT_INVALID) {
+                    summary.vehicleId = message.sysid;
+                }
+            }
+            continue;
+        }
+
+        // Only the first vehicle in the log is summarized
+        if (summary.vehicleId == 0 || message.sysid != summary.vehicleId) {
+            continue;
+        }
+
+        switch (message.msgid) {
+        case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+        {
+            mavlink_global_position_int_t globalPosition;
+            mavlink_msg_global_position_int_decode(&message, &globalPosition);
+            if (globalPosition.lat != 0 || globalPosition.lon != 0) {
+                const double latitude   = globalPosition.lat / 1e7;
+                const double longitude  = globalPosition.lon / 1e7;
+                _updateMin(summary.minLatitude,     latitude);
+                _updateMax(summary.maxLatitude,     latitude);
+                _updateMin(summary.minLongitude,    longitude);
+                _updateMax(summary.maxLongitude,    longitude);
+                _updateMax(summary.maxAltitude,     globalPosition.relative_alt / 1000.0);
+            }
+            break;
+        }
+        case MAVLINK_MSG_ID_SYS_STATUS:
+        {
+            mavlink_sys_status_t sysStatus;
+            mavlink_msg_sys_status_decode(&message, &sysStatus);
+            if (sysStatus.voltage_battery != 0 && sysStatus.voltage_battery != UINT16_MAX) {
+                _updateMin(summary.minBatteryVoltage, sysStatus.voltage_battery / 1000.0);
+            }
+            if (sysStatus.battery_remaining >= 0) {
+                _updateMin(summary.minBatteryRemaining, sysStatus.battery_remaining);
+            }
+            break;
+        }
+        case MAVLINK_MSG_ID_STATUSTEXT:
+        {
+            mavlink_statustext_t statusText;
+            mavlink_msg_statustext_decode(&message, &statusText);
+
+            // Same reassembly of chunks as Vehicle, the last chunk is the one with a null terminator
+            const QString   chunk       = QString::fromUtf8(statusText.text, static_cast<int>(strnlen(statusText.text, MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN)));
+            QString         text        = chunkedTexts.take(message.compid) + chunk;
+            const bool      complete    = statusText.id == 0 || chunk.length() < MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN;
+            if (complete) {
+                _addMessage(summary, timeUSecs, statusText.severity, text);
+            } else {
+                chunkedTexts[message.compid] = text;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    if (recordCount == 0) {
+        errorString = tr("No records found in log file: '%1'").arg(fileName);
+        return false;
+    }
+    summary.durationSecs = (lastUSecs - summary.startUSecs) / 1e6;
+
+    return true;
+}
+
+bool LogIndexer::summarizeULog(const QString& fileName, Summary_t& summary, QString& errorString)
+{
+    _clearSummary(summary);
+
+    ULogReader reader;
+    if (!reader.open(fileName, errorString)) {
+        return false;
+    }
+
+    // ULog times are since boot
+    quint64 endUSecs = reader.startUSecs();
+    for (const QString& topicName: reader.topicNames()) {
+        for (const ULogReader::Topic_t* topic: reader.topics(topicName)) {
+            const int count = reader.sampleCount(topic);
+            if (count) {
+                endUSecs = qMax(endUSecs, reader.sampleTimestamp(topic, count - 1));
+            }
+        }
+    }
+    summary.durationSecs = (endUSecs - reader.startUSecs()) / 1e6;
+
+    // Unix time from the first GPS fix, otherwise the log was closed when the file was last written
+    qint64 utcOffsetUSecs = 0;
+    _forEachValue(reader, QStringLiteral("vehicle_gps_position"), QStringLiteral("time_utc_usec"), [&](quint64 timestamp, double value) {
+        if (utcOffsetUSecs == 0 && value > 0) {
+            utcOffsetUSecs = static_cast<qint64>(value) - static_cast<qint64>(timestamp);
+        }
+    });
+    if (utcOffsetUSecs == 0) {
+        utcOffsetUSecs = (QFileInfo(fileName).lastModified().toMSecsSinceEpoch() * 1000) - static_cast<qint64>(endUSecs);
+    }
+    summary.startUSecs = static_cast<quint64>(qMax(static_cast<qint64>(reader.startUSecs()) + utcOffsetUSecs, static_cast<qint64>(0)));
+
+    _forEachValue(reader, QStringLiteral("vehicle_status"), QStringLiteral("system_id"), [&](quint64, double value) {
+        if (summary.vehicleId == 0) {
+            summary.vehicleId = static_cast<int>(value);
+        }
+    });
+    _forEachValue(reader, QStringLiteral("vehicle_global_position"), QStringLiteral("lat"), [&](quint64, double value) {
+        if (value != 0) {
+            _updateMin(summary.minLatitude, value);
+            _updateMax(summary.maxLatitude, value);
+        }
+    });
+    _forEachValue(reader, QStringLiteral("vehicle_global_position"), QStringLiteral("lon"), [&](quint64, double value) {
+        if (value != 0) {
+            _updateMin(summary.minLongitude, value);
+            _updateMax(summary.maxLongitude, value);
+        }
+    });
+    _forEachValue(reader, QStringLiteral("vehicle_local_position"), QStringLiteral("z"), [&](quint64, double value) {
+        if (!std::isnan(value)) {
+            // Down is positive
+            _updateMax(summary.maxAltitude, -value);
+        }
+    });
+    const QString voltageField = reader.field(QStringLiteral("battery_status"), QStringLiteral("voltage_v")) ? QStringLiteral("voltage_v") : QStringLiteral("voltage_filtered_v");
+    _forEachValue(reader, QStringLiteral("battery_status"), voltageField, [&](quint64, double value) {
+        if (value > 0) {
+            _updateMin(summary.minBatteryVoltage, value);
+        }
+    });
+    _forEachValue(reader, QStringLiteral("battery_status"), QStringLiteral("remaining"), [&](quint64, double value) {
+        if (value >= 0) {
+            _updateMin(summary.minBatteryRemaining, value * 100.0);
+        }
+    });
+
+    for (const ULogReader::LogMessage_t& logMessage: reader.logMessages()) {
+        const qint64 timeUSecs = static_cast<qint64>(logMessage.timestampUSecs) + utcOffsetUSecs;
+        _addMessage(summary, static_cast<quint64>(qMax(timeUSecs, static_cast<qint64>(0))), logMessage.level, logMessage.text);
+    }
+
+    return true;
+}
+
+bool LogIndexer::createSchema(QSqlDatabase& db, QString& errorString)
+{
+    QSqlQuery query(db);
+
+    int version = 0;
+    if (query.exec(QStringLiteral("PRAGMA user_version")) && query.next()) {
+        version = query.value(0).toInt();
+    }
+
+    QStringList statements;
+    if (version != schemaVersion) {
+        statements << QStringLiteral("DROP TABLE IF EXISTS messages")
+                   << QStringLiteral("DROP TABLE IF EXISTS logs");
+    }
+    statements << QStringLiteral("CREATE TABLE IF NOT EXISTS logs ("
+                                 "id INTEGER PRIMARY KEY, "
+                                 "path TEXT NOT NULL UNIQUE, "
+                                 "size INTEGER NOT NULL, "
+                                 "modified INTEGER NOT NULL, "
+                                 "type INTEGER NOT NULL, "
+                                 "valid INTEGER NOT NULL, "
+                                 "vehicle_id INTEGER, "
+                                 "start_time INTEGER, "
+                                 "duration REAL, "
+                                 "max_altitude REAL, "
+                                 "min_battery_voltage REAL, "
+                                 "min_battery_remaining REAL, "
+                                 "min_latitude REAL, "
+                                 "max_latitude REAL, "
+                                 "min_longitude REAL, "
+                                 "max_longitude REAL, "
+                                 "error_count INTEGER, "
+                                 "warning_count INTEGER)")
+               << QStringLiteral("CREATE TABLE IF NOT EXISTS messages ("
+                                 "log_id INTEGER NOT NULL, "
+                                 "time INTEGER NOT NULL, "
+                                 "severity INTEGER NOT NULL, "
+                                 "text TEXT NOT NULL)")
+               << QStringLiteral("CREATE INDEX IF NOT EXISTS messages_log ON messages (log_id)")
+               << QStringLiteral("CREATE INDEX IF NOT EXISTS logs_start_time ON logs (start_time)")
+               << QStringLiteral("CREATE INDEX IF NOT EXISTS logs_vehicle ON logs (vehicle_id, start_time)")
+               << QStringLiteral("PRAGMA user_version = %1").arg(schemaVersion);
+
+    for (const QString& statement: statements) {
+        if (!query.exec(statement)) {
+            errorString = tr("Unable to create log index: %1").arg(query.lastError().text());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LogIndexer::query(QSqlDatabase& db, const Query_t& query, QList<Entry_t>& entries, QString& errorString)
+{
+    entries.clear();
+    errorString.clear();
+
+    QStringList     conditions  { QStringLiteral("valid = 1") };
+    QVariantList    values;
+    QString         escaped     = query.text;
+    escaped.replace(QLatin1Char('\\'), QLatin1String("\\\\")).replace(QLatin1Char('%'), QLatin1String("\\%")).replace(QLatin1Char('_'), QLatin1String("\\_"));
+    const QString   pattern     = QStringLiteral("%%1%").arg(escaped);
+
+    // The matching message, otherwise the worst one
+    QString messageColumn = QStringLiteral("(SELECT text FROM messages m WHERE m.log_id = logs.id ORDER BY severity, time LIMIT 1)");
+    if (!query.text.isEmpty()) {
+        messageColumn = QStringLiteral("(SELECT text FROM messages m WHERE m.log_id = logs.id AND m.text LIKE ? ESCAPE '\\' ORDER BY severity, time LIMIT 1)");
+        values.append(pattern);
+        conditions.append(QStringLiteral("(path LIKE ? ESCAPE '\\' OR EXISTS (SELECT 1 FROM messages m WHERE m.log_id = logs.id AND m.text LIKE ? ESCAPE '\\'))"));
+        values.append(pattern);
+        values.append(pattern);
+    }
+    if (query.vehicleId) {
+        conditions.append(QStringLiteral("vehicle_id = ?"));
+        values.append(query.vehicleId);
+    }
+    if (query.errorsOnly) {
+        conditions.append(QStringLiteral("error_count > 0"));
+    }
+    if (query.area.isValid()) {
+        conditions.append(QStringLiteral("max_latitude >= ? AND min_latitude <= ? AND max_longitude >= ? AND min_longitude <= ?"));
+        values.append(query.area.bottomLeft().latitude());
+        values.append(query.area.topRight().latitude());
+        values.append(query.area.bottomLeft().longitude());
+        values.append(query.area.topRight().longitude());
+    }
+    values.append(query.limit);
+
+    QSqlQuery sqlQuery(db);
+    sqlQuery.setForwardOnly(true);
+    sqlQuery.prepare(QStringLiteral("SELECT path, type, vehicle_id, start_time, duration, max_altitude, min_battery_voltage, "
+                                    "min_battery_remaining, min_latitude, max_latitude, min_longitude, max_longitude, "
+                                    "error_count, warning_count, %1 FROM logs WHERE %2 ORDER BY start_time DESC LIMIT ?")
+                     .arg(messageColumn, conditions.join(QStringLiteral(" AND "))));
+    for (const QVariant& value: values) {
+        sqlQuery.addBindValue(value);
+    }
+    if (!sqlQuery.exec()) {
+        errorString = tr("Log index query failed: %1").arg(sqlQuery.lastError().text());
+        return false;
+    }
+
+    while (sqlQuery.next()) {
+        Entry_t entry;
+        entry.path                  = sqlQuery.value(0).toString();
+        entry.type                  = sqlQuery.value(1).toInt();
+        entry.vehicleId             = sqlQuery.value(2).toInt();
+        entry.startUSecs            = sqlQuery.value(3).toULongLong();
+        entry.durationSecs          = sqlQuery.value(4).toDouble();
+        entry.maxAltitude           = _realFromValue(sqlQuery.value(5));
+        entry.minBatteryVoltage     = _realFromValue(sqlQuery.value(6));
+        entry.minBatteryRemaining   = _realFromValue(sqlQuery.value(7));
+        if (!sqlQuery.value(8).isNull()) {
+            entry.boundingBox = QGeoRectangle(QGeoCoordinate(sqlQuery.value(9).toDouble(), sqlQuery.value(10).toDouble()),
+                                              QGeoCoordinate(sqlQuery.value(8).toDouble(), sqlQuery.value(11).toDouble()));
+        }
+        entry.errorCount            = sqlQuery.value(12).toInt();
+        entry.warningCount          = sqlQuery.value(13).toInt();
+        entry.message               = sqlQuery.value(14).toString();
+        entries.append(entry);
+    }
+    return true;
+}
+
+QList<int> LogIndexer::vehicleIds(QSqlDatabase& db)
+{
+    QList<int> ids;
+
+    QSqlQuery sqlQuery(db);
+    if (sqlQuery.exec(QStringLiteral("SELECT DISTINCT vehicle_id FROM logs WHERE valid = 1 AND vehicle_id IS NOT NULL ORDER BY vehicle_id"))) {
+        while (sqlQuery.next()) {
+            ids.append(sqlQuery.value(0).toInt());
+        }
+    }
+    return ids;
+}
+
+bool LogIndexer::_open(void)
+{
+    QDir().mkpath(QFileInfo(_databaseFile).absolutePath());
+
+    QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), _connectionName);
+    db.setDatabaseName(_databaseFile);
+    if (!db.open()) {
+        qCWarning(LogIndexerLog) << "Unable to open log index" << _databaseFile << db.lastError().text();
+        return false;
+    }
+
+    // Write ahead logging lets the manager query while an update is running
+    _exec(QStringLiteral("PRAGMA journal_mode = WAL"));
+    _exec(QStringLiteral("PRAGMA synchronous = NORMAL"));
+
+    QString errorString;
+    if (!createSchema(db, errorString)) {
+        qCWarning(LogIndexerLog) << errorString;
+        db.close();
+        return false;
+    }
+    return true;
+}
+
+bool LogIndexer::_exec(const QString& statement)
+{
+    QSqlQuery query(QSqlDatabase::database(_connectionName, false));
+    if (!query.exec(statement)) {
+        qCWarning(LogIndexerLog) << "Statement failed" << statement << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool LogIndexer::_loadKnown(QHash<QString, Known_t>& known)
+{
+    QSqlQuery query(QSqlDatabase::database(_connectionName, false));
+    if (!query.exec(QStringLiteral("SELECT id, path, size, modified FROM logs"))) {
+        qCWarning(LogIndexerLog) << "Unable to read log index" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        known[query.value(1).toString()] = { query.value(0).toLongLong(), query.value(2).toLongLong(), query.value(3).toLongLong() };
+    }
+    return true;
+}
+
+bool LogIndexer::_remove(qint64 id)
+{
+    QSqlDatabase    db = QSqlDatabase::database(_connectionName, false);
+    QSqlQuery       query(db);
+
+    query.prepare(QStringLiteral("DELETE FROM messages WHERE log_id = ?"));
+    query.addBindValue(id);
+    if (!query.exec()) {
+        qCWarning(LogIndexerLog) << "Unable to remove messages" << query.lastError().text();
+        return false;
+    }
+    query.prepare(QStringLiteral("DELETE FROM logs WHERE id = ?"));
+    query.addBindValue(id);
+    if (!query.exec()) {
+        qCWarning(LogIndexerLog) << "Unable to remove log" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool LogIndexer::_insert(const QString& fileName, qint64 size, qint64 modified, bool valid, const Summary_t& summary)
+{
+    QSqlDatabase    db = QSqlDatabase::database(_connectionName, false);
+    QSqlQuery       query(db);
+
+    query.prepare(QStringLiteral("INSERT INTO logs (path, size, modified, type, valid, vehicle_id, start_time, duration, max_altitude, "
+                                 "min_battery_voltage, min_battery_remaining, min_latitude, max_latitude, min_longitude, max_longitude, "
+                                 "error_count, warning_count) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"));
+    query.addBindValue(fileName);
+    query.addBindValue(size);
+    query.addBindValue(modified);
+    query.addBindValue(logType(fileName));
+    query.addBindValue(valid ? 1 : 0);
+    query.addBindValue(summary.vehicleId ? QVariant(summary.vehicleId) : QVariant(QVariant::Int));
+    query.addBindValue(static_cast<qint64>(summary.startUSecs));
+    query.addBindValue(summary.durationSecs);
+    query.addBindValue(_realValue(summary.maxAltitude));
+    query.addBindValue(_realValue(summary.minBatteryVoltage));
+    query.addBindValue(_realValue(summary.minBatteryRemaining));
+    query.addBindValue(_realValue(summary.minLatitude));
+    query.addBindValue(_realValue(summary.maxLatitude));
+    query.addBindValue(_realValue(summary.minLongitude));
+    query.addBindValue(_realValue(summary.maxLongitude));
+    query.addBindValue(summary.errorCount);
+    query.addBindValue(summary.warningCount);
+    if (!query.exec()) {
+        qCWarning(LogIndexerLog) << "Unable to add log" << fileName << query.lastError().text();
+        return false;
+    }
+
+    const qint64 id = query.lastInsertId().toLongLong();
+    query.prepare(QStringLiteral("INSERT INTO messages (log_id, time, severity, text) VALUES (?, ?, ?, ?)"));
+    for (const Message_t& message: summary.messages) {
+        query.addBindValue(id);
+        query.addBindValue(static_cast<qint64>(message.timeUSecs));
+        query.addBindValue(message.severity);
+        query.addBindValue(message.text);
+        if (!query.exec()) {
+            qCWarning(LogIndexerLog) << "Unable to add message" << fileName << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+int LogIndexer::_logCount(void)
+{
+    QSqlQuery query(QSqlDatabase::database(_connectionName, false));
+    if (query.exec(QStringLiteral("SELECT COUNT(*) FROM logs WHERE valid = 1")) && query.next()) {
+        return query.value(0).toInt();
+    }
+    return 0;
+}
+
+void LogIndexer::update(const QStringList directories)
+{
+    if (!_opened) {
+        _opened = _open();
+        if (!_opened) {
+            emit updated(0, false);
+            return;
+        }
+    }
+
+    QSqlDatabase            db = QSqlDatabase::database(_connectionName, false);
+    QHash<QString, Known_t> known;
+    if (!_loadKnown(known)) {
+        emit updated(0, false);
+        return;
+    }
+
+    typedef struct {
+        QString path;
+        qint64  size;
+        qint64  modified;
+    } Changed_t;
+
+    QSet<QString>       seen;
+    QList<Changed_t>    changed;
+    for (const QString& directory: directories) {
+        if (directory.isEmpty()) {
+            continue;
+        }
+        QDirIterator it(directory, { QStringLiteral("*.%1").arg(tlogSuffix), QStringLiteral("*.%1").arg(ulogSuffix) }, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            it.next();
+            const QFileInfo info = it.fileInfo();
+            const QString   path = info.absoluteFilePath();
+            if (seen.contains(path)) {
+                // Directories may overlap
+                continue;
+            }
+            seen.insert(path);
+
+            const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+            auto knownIt = known.constFind(path);
+            if (knownIt == known.constEnd() || knownIt->size != info.size() || knownIt->modified != modified) {
+                changed.append({ path, info.size(), modified });
+            }
+        }
+    }
+
+    int removedCount = 0;
+    db.transaction();
+    for (auto it = known.constBegin(); it != known.constEnd(); ++it) {
+        if (!seen.contains(it.key()) && _remove(it->id)) {
+            removedCount++;
+        }
+    }
+    db.commit();
+
+    qCDebug(LogIndexerLog) << "Update known:changed:removed" << known.count() << changed.count() << removedCount;
+
+    const int total = changed.count();
+    for (int i=0; i<total; i++) {
+        if (_stop) {
+            db.commit();
+            return;
+        }
+        if (i % commitInterval == 0) {
+            db.transaction();
+        }
+
+        const Changed_t&    log = changed[i];
+        Summary_t           summary;
+        QString             errorString;
+
+        // Logs which can't be read are kept as invalid, so they are only read again once they change
+        const bool valid = summarize(log.path, summary, errorString);
+        if (!valid) {
+            qCDebug(LogIndexerLog) << errorString;
+        }
+        auto knownIt = known.constFind(log.path);
+        if (knownIt != known.constEnd()) {
+            _remove(knownIt->id);
+        }
+        _insert(log.path, log.size, log.modified, valid, summary);
+
+        if ((i + 1) % commitInterval == 0 || i == total - 1) {
+            db.commit();
+        }
+        emit progressChanged(i + 1, total);
+    }
+
+    emit updated(_logCount(), total != 0 || removedCount != 0);
+}
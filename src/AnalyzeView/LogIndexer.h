@@ -0,0 +1,152 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCLoggingCategory.h"
+
+#include <QGeoRectangle>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+
+#include <atomic>
+
+Q_DECLARE_LOGGING_CATEGORY(LogIndexerLog)
+
+/// Keeps an SQLite index of summaries of the telemetry logs and ULogs in a set of directories. An update only
+/// summarizes logs which are new or whose size or modification time changed, and drops the logs which are gone.
+/// Runs on a worker thread, see LogIndexManager, which reads the index through its own connection.
+///
+/// Tables:
+///     logs        A row per log, values which are not in a log are NULL
+///     messages    Status texts of warning severity or worse, at most maxMessagesPerLog per log
+class LogIndexer : public QObject
+{
+    Q_OBJECT
+
+public:
+    LogIndexer(const QString& databaseFile, QObject* parent = nullptr);
+    ~LogIndexer();
+
+    typedef enum {
+        LogTypeTlog = 0,
+        LogTypeULog,
+    } LogType_t;
+
+    typedef struct {
+        quint64 timeUSecs;
+        int     severity;           ///< MAV_SEVERITY
+        QString text;
+    } Message_t;
+
+    /// Values which are not in the log are NaN
+    typedef struct {
+        int                 vehicleId;
+        quint64             startUSecs;             ///< Unix time
+        double              durationSecs;
+        double              maxAltitude;            ///< Relative to home
+        double              minBatteryVoltage;
+        double              minBatteryRemaining;    ///< Percent
+        double              minLatitude;
+        double              maxLatitude;
+        double              minLongitude;
+        double              maxLongitude;
+        int                 errorCount;             ///< Messages of error severity or worse
+        int                 warningCount;
+        QList<Message_t>    messages;
+    } Summary_t;
+
+    /// Summarizes a log of either type, by file suffix
+    /// @return false: not a log or unreadable, errorString set
+    static bool summarize(const QString& fileName, Summary_t& summary, QString& errorString);
+
+    static bool summarizeTlog(const QString& fileName, Summary_t& summary, QString& errorString);
+    static bool summarizeULog(const QString& fileName, Summary_t& summary, QString& errorString);
+
+    /// Logs which match all criteria, empty criteria match any log
+    typedef struct Query_s {
+        QString         text;                   ///< Part of the file name or of a message, case insensitive
+        int             vehicleId   = 0;
+        bool            errorsOnly  = false;    ///< Only logs with messages of error severity or worse
+        QGeoRectangle   area;                   ///< Logs whose bounding box intersects it
+        int             limit       = defaultQueryLimit;
+    } Query_t;
+
+    /// Values which are not in the log are NaN
+    typedef struct {
+        QString         path;
+        int             type;                   ///< LogType_t
+        int             vehicleId;
+        quint64         startUSecs;             ///< Unix time
+        double          durationSecs;
+        double          maxAltitude;
+        double          minBatteryVoltage;
+        double          minBatteryRemaining;
+        QGeoRectangle   boundingBox;            ///< Invalid for no position
+        int             errorCount;
+        int             warningCount;
+        QString         message;                ///< Matching message, otherwise the worst one
+    } Entry_t;
+
+    /// Creates the tables, recreating them if they are from another schemaVersion
+    static bool createSchema(QSqlDatabase& db, QString& errorString);
+
+    /// Runs a query against an index, newest logs first. The connection must belong to the calling thread.
+    /// @return false: query failed, errorString set
+    static bool query(QSqlDatabase& db, const Query_t& query, QList<Entry_t>& entries, QString& errorString);
+
+    /// @return Vehicle ids in the index, ascending
+    static QList<int> vehicleIds(QSqlDatabase& db);
+
+    /// @return Log type of the file, -1 for none
+    static int logType(const QString& fileName);
+
+    /// Stops a running update as soon as possible, thread safe
+    void stop(void) { _stop = true; }
+
+    static const char*  tlogSuffix;
+    static const char*  ulogSuffix;
+    static const int    schemaVersion       = 1;
+    static const int    maxMessagesPerLog   = 200;
+    static const int    commitInterval      = 50;   ///< Logs summarized per transaction, readers see progress as it's made
+    static const int    defaultQueryLimit   = 500;
+
+public slots:
+    /// Brings the index up to date with the logs in the directories and their sub directories
+    void update(const QStringList directories);
+
+signals:
+    void progressChanged(int summarized, int total);
+    void updated        (int logCount, bool changed);
+
+private:
+    typedef struct {
+        qint64  id;
+        qint64  size;
+        qint64  modified;
+    } Known_t;
+
+    bool _open          (void);
+    bool _exec          (const QString& statement);
+    bool _loadKnown     (QHash<QString, Known_t>& known);
+    bool _remove        (qint64 id);
+    bool _insert        (const QString& fileName, qint64 size, qint64 modified, bool valid, const Summary_t& summary);
+    int  _logCount      (void);
+
+    static void _clearSummary(Summary_t& summary);
+
+    QString             _databaseFile;
+    QString             _connectionName;
+    bool                _opened         = false;
+    std::atomic<bool>   _stop;
+};
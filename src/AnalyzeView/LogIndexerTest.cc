@@ -0,0 +1,340 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LogIndexerTest.h"
+#include "LogIndexer.h"
+#include "QGCMAVLink.h"
+#include "TlogIndex.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSignalSpy>
+#include <QSqlDatabase>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+#include <cmath>
+#include <cstring>
+
+static const quint64 _startTimeUSecs = Q_UINT64_C(1600000000000000);
+
+template <typename T>
+static void _append(QByteArray& bytes, T value)
+{
+    bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static void _appendMessage(QByteArray& log, char msgType, const QByteArray& payload)
+{
+    _append<quint16>(log, static_cast<quint16>(payload.size()));
+    log.append(msgType);
+    log.append(payload);
+}
+
+static void _appendRecord(QByteArray& log, quint64 timeUSecs, const mavlink_message_t& message)
+{
+    uint8_t buffer[TlogIndex::cbTimestamp + MAVLINK_MAX_PACKET_LEN];
+
+    qToBigEndian<quint64>(timeUSecs, buffer);
+    int length = mavlink_msg_to_send_buffer(&buffer[TlogIndex::cbTimestamp], &message);
+    log.append(reinterpret_cast<const char*>(buffer), TlogIndex::cbTimestamp + length);
+}
+
+static void _appendStatusText(QByteArray& log, quint64 timeUSecs, uint8_t sysid, uint8_t severity, const char* text, uint16_t id = 0, uint8_t chunkSeq = 0)
+{
+    mavlink_message_t   message;
+    char                buffer[MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN] = {};
+
+    strncpy(buffer, text, MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN);
+    mavlink_msg_statustext_pack(sysid, MAV_COMP_ID_AUTOPILOT1, &message, severity, buffer, id, chunkSeq);
+    _appendRecord(log, timeUSecs, message);
+}
+
+/// Ten seconds of a vehicle flying north east and climbing, with a gcs and a second vehicle in the log as well
+static QByteArray _tlog(quint64 startUSecs, uint8_t vehicleId, double latitude, bool error)
+{
+    QByteArray          log;
+    mavlink_message_t   message;
+
+    mavlink_msg_heartbeat_pack(255, MAV_COMP_ID_MISSIONPLANNER, &message, MAV_TYPE_GCS, MAV_AUTOPILOT_INVALID, 0, 0, MAV_STATE_ACTIVE);
+    _appendRecord(log, startUSecs, message);
+    mavlink_msg_heartbeat_pack(vehicleId, MAV_COMP_ID_AUTOPILOT1, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+    _appendRecord(log, startUSecs + 1000000, message);
+
+    for (int i=0; i<5; i++) {
+        const quint64 timeUSecs = startUSecs + ((i + 2) * 1000000);
+        mavlink_msg_global_position_int_pack(vehicleId, MAV_COMP_ID_AUTOPILOT1, &message, 0,
+                                             static_cast<int32_t>((latitude + (i * 0.001)) * 1e7), static_cast<int32_t>((8.0 + (i * 0.002)) * 1e7),
+                                             0, i * 10000, 0, 0, 0, UINT16_MAX);
+        _appendRecord(log, timeUSecs, message);
+        mavlink_msg_sys_status_pack(vehicleId, MAV_COMP_ID_AUTOPILOT1, &message, 0, 0, 0, 0, static_cast<uint16_t>(12600 - (i * 300)), -1, static_cast<int8_t>(90 - (i * 10)), 0, 0, 0, 0, 0, 0);
+        _appendRecord(log, timeUSecs, message);
+
+        // Not from the vehicle being summarized
+        mavlink_msg_global_position_int_pack(vehicleId + 1, MAV_COMP_ID_AUTOPILOT1, &message, 0, 100000000, 100000000, 0, 500000, 0, 0, 0, UINT16_MAX);
+        _appendRecord(log, timeUSecs, message);
+    }
+
+    if (error) {
+        _appendStatusText(log, startUSecs + 7000000, vehicleId, MAV_SEVERITY_ERROR, "Preflight Fail: Compass");
+    }
+    _appendStatusText(log, startUSecs + 8000000, vehicleId, MAV_SEVERITY_INFO, "Takeoff detected");
+    _appendStatusText(log, startUSecs + 9000000, vehicleId, MAV_SEVERITY_WARNING, "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", 1, 0);
+    _appendStatusText(log, startUSecs + 9000000, vehicleId, MAV_SEVERITY_WARNING, "bc", 1, 1);
+
+    mavlink_msg_heartbeat_pack(vehicleId, MAV_COMP_ID_AUTOPILOT1, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+    _appendRecord(log, startUSecs + 10000000, message);
+
+    return log;
+}
+
+/// Five seconds of a vehicle climbing with a draining battery and two logged messages
+static QByteArray _ulog(uint8_t vehicleId)
+{
+    QByteArray log("ULog\x01\x12\x35\x01", 8);
+    _append<quint64>(log, 0);
+
+    _appendMessage(log, 'F', QByteArray("vehicle_status:uint64_t timestamp;uint8_t system_id;"));
+    _appendMessage(log, 'F', QByteArray("vehicle_local_position:uint64_t timestamp;float z;"));
+    _appendMessage(log, 'F', QByteArray("battery_status:uint64_t timestamp;float voltage_v;float remaining;"));
+    const char* topicNames[] = { "vehicle_status", "vehicle_local_position", "battery_status" };
+    for (quint16 msgId=0; msgId<3; msgId++) {
+        QByteArray subscription;
+        _append<quint8>(subscription, 0);
+        _append<quint16>(subscription, msgId);
+        subscription.append(topicNames[msgId]);
+        _appendMessage(log, 'A', subscription);
+    }
+
+    for (int i=0; i<5; i++) {
+        const quint64 timestamp = (i + 1) * 1000000;
+
+        QByteArray status;
+        _append<quint16>(status, 0);
+        _append<quint64>(status, timestamp);
+        _append<quint8>(status, vehicleId);
+        _appendMessage(log, 'D', status);
+
+        QByteArray position;
+        _append<quint16>(position, 1);
+        _append<quint64>(position, timestamp);
+        _append<float>(position, -5.0f * i);
+        _appendMessage(log, 'D', position);
+
+        QByteArray battery;
+        _append<quint16>(battery, 2);
+        _append<quint64>(battery, timestamp);
+        _append<float>(battery, 16.0f - (0.5f * i));
+        _append<float>(battery, 1.0f - (0.2f * i));
+        _appendMessage(log, 'D', battery);
+    }
+
+    QByteArray error("3");
+    _append<quint64>(error, 2000000);
+    error.append("Accel #0 fail");
+    _appendMessage(log, 'L', error);
+
+    QByteArray info("6");
+    _append<quint64>(info, 2500000);
+    info.append("Takeoff detected");
+    _appendMessage(log, 'L', info);
+
+    QByteArray warning("4");
+    _append<quint16>(warning, 7);
+    _append<quint64>(warning, 3000000);
+    warning.append("Low battery");
+    _appendMessage(log, 'C', warning);
+
+    return log;
+}
+
+static bool _writeFile(const QString& fileName, const QByteArray& bytes, bool append = false)
+{
+    QFile file(fileName);
+    if (!file.open(append ? QFile::Append : QFile::WriteOnly | QFile::Truncate)) {
+        return false;
+    }
+    return file.write(bytes) == bytes.size();
+}
+
+void LogIndexerTest::_tlogSummaryTest(void)
+{
+    QTemporaryDir   tempDir;
+    QString         fileName = tempDir.filePath(QStringLiteral("summary.tlog"));
+    QVERIFY(_writeFile(fileName, _tlog(_startTimeUSecs, 1, 47.0, true)));
+
+    LogIndexer::Summary_t   summary;
+    QString                 errorString;
+    QVERIFY2(LogIndexer::summarize(fileName, summary, errorString), qPrintable(errorString));
+    QCOMPARE(summary.vehicleId,     1);
+    QCOMPARE(summary.startUSecs,    _startTimeUSecs);
+    QCOMPARE(summary.durationSecs,  10.0);
+    QCOMPARE(summary.maxAltitude,   40.0);
+    QCOMPARE(summary.minBatteryVoltage,     11.4);
+    QCOMPARE(summary.minBatteryRemaining,   50.0);
+    QVERIFY(qAbs(summary.minLatitude - 47.0) < 1e-6);
+    QVERIFY(qAbs(summary.maxLatitude - 47.004) < 1e-6);
+    QVERIFY(qAbs(summary.minLongitude - 8.0) < 1e-6);
+    QVERIFY(qAbs(summary.maxLongitude - 8.008) < 1e-6);
+
+    // The info is not kept, the chunks of the warning are joined
+    QCOMPARE(summary.errorCount,    1);
+    QCOMPARE(summary.warningCount,  1);
+    QCOMPARE(summary.messages.count(), 2);
+    QCOMPARE(summary.messages[0].severity,  static_cast<int>(MAV_SEVERITY_ERROR));
+    QCOMPARE(summary.messages[0].text,      QStringLiteral("Preflight Fail: Compass"));
+    QCOMPARE(summary.messages[0].timeUSecs, _startTimeUSecs + 7000000);
+    QCOMPARE(summary.messages[1].text,      QString(50, QLatin1Char('a')) + QStringLiteral("bc"));
+
+    // Nothing but garbage
+    QVERIFY(_writeFile(fileName, QByteArray(1000, 'x')));
+    QVERIFY(!LogIndexer::summarize(fileName, summary, errorString));
+    QVERIFY(!errorString.isEmpty());
+}
+
+void LogIndexerTest::_ulogSummaryTest(void)
+{
+    QTemporaryDir   tempDir;
+    QString         fileName = tempDir.filePath(QStringLiteral("summary.ulg"));
+    QVERIFY(_writeFile(fileName, _ulog(3)));
+
+    LogIndexer::Summary_t   summary;
+    QString                 errorString;
+    QVERIFY2(LogIndexer::summarize(fileName, summary, errorString), qPrintable(errorString));
+    QCOMPARE(summary.vehicleId,             3);
+    QCOMPARE(summary.durationSecs,          5.0);
+    QCOMPARE(summary.maxAltitude,           20.0);
+    QCOMPARE(summary.minBatteryVoltage,     14.0);
+    QVERIFY(qAbs(summary.minBatteryRemaining - 20.0) < 1e-3);
+    QVERIFY(std::isnan(summary.minLatitude));
+
+    // Without a GPS the log ends when the file was written
+    QVERIFY(qAbs(static_cast<qint64>(summary.startUSecs / 1000) + 5000 - QFileInfo(fileName).lastModified().toMSecsSinceEpoch()) < 2);
+
+    QCOMPARE(summary.errorCount,    1);
+    QCOMPARE(summary.warningCount,  1);
+    QCOMPARE(summary.messages.count(), 2);
+    QCOMPARE(summary.messages[0].text,      QStringLiteral("Accel #0 fail"));
+    QCOMPARE(summary.messages[1].severity,  static_cast<int>(MAV_SEVERITY_WARNING));
+    QCOMPARE(summary.messages[1].text,      QStringLiteral("Low battery"));
+}
+
+void LogIndexerTest::_indexTest(void)
+{
+    QTemporaryDir   logDir;
+    QTemporaryDir   indexDir;
+    const QString   aFileName = logDir.filePath(QStringLiteral("a.tlog"));
+    const QString   bFileName = logDir.filePath(QStringLiteral("sub/b.tlog"));
+    const QString   cFileName = logDir.filePath(QStringLiteral("c.ulg"));
+
+    QVERIFY(QDir(logDir.path()).mkdir(QStringLiteral("sub")));
+    QVERIFY(_writeFile(aFileName, _tlog(_startTimeUSecs, 1, 47.0, true)));
+    QVERIFY(_writeFile(bFileName, _tlog(_startTimeUSecs + Q_UINT64_C(3600000000), 2, -33.0, false)));
+    QVERIFY(_writeFile(cFileName, _ulog(3)));
+    QVERIFY(_writeFile(logDir.filePath(QStringLiteral("broken.tlog")), QByteArray(100, 'x')));
+    QVERIFY(_writeFile(logDir.filePath(QStringLiteral("notes.txt")), QByteArray("a.tlog")));
+
+    LogIndexer  indexer(indexDir.filePath(QStringLiteral("LogIndex.db")));
+    QSignalSpy  progressSpy (&indexer, &LogIndexer::progressChanged);
+    QSignalSpy  updatedSpy  (&indexer, &LogIndexer::updated);
+
+    indexer.update(QStringList({ logDir.path(), logDir.path() }));
+    QCOMPARE(updatedSpy.count(),                    1);
+    QCOMPARE(updatedSpy[0][0].toInt(),              3);
+    QCOMPARE(updatedSpy[0][1].toBool(),             true);
+    QCOMPARE(progressSpy.count(),                   4);
+    QCOMPARE(progressSpy.last()[1].toInt(),         4);
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), QStringLiteral("LogIndexerTest"));
+        db.setDatabaseName(indexDir.filePath(QStringLiteral("LogIndex.db")));
+        QVERIFY(db.open());
+
+        auto paths = [&db](const LogIndexer::Query_t& query) {
+            QList<LogIndexer::Entry_t>  entries;
+            QString                     errorString;
+            QStringList                 paths;
+            if (LogIndexer::query(db, query, entries, errorString)) {
+                for (const LogIndexer::Entry_t& entry: entries) {
+                    paths.append(QFileInfo(entry.path).fileName());
+                }
+            } else {
+                paths.append(errorString);
+            }
+            return paths;
+        };
+
+        // The ULog has no GPS, so it started shortly before it was written, newest first
+        LogIndexer::Query_t query;
+        QCOMPARE(paths(query), QStringList({ "c.ulg", "b.tlog", "a.tlog" }));
+
+        query.limit = 1;
+        QCOMPARE(paths(query), QStringList({ "c.ulg" }));
+        query.limit = LogIndexer::defaultQueryLimit;
+
+        query.text = QStringLiteral("COMPASS");
+        QCOMPARE(paths(query), QStringList({ "a.tlog" }));
+        QList<LogIndexer::Entry_t>  entries;
+        QString                     errorString;
+        QVERIFY(LogIndexer::query(db, query, entries, errorString));
+        QCOMPARE(entries[0].message,        QStringLiteral("Preflight Fail: Compass"));
+        QCOMPARE(entries[0].vehicleId,      1);
+        QCOMPARE(entries[0].startUSecs,     _startTimeUSecs);
+        QCOMPARE(entries[0].maxAltitude,    40.0);
+        QCOMPARE(entries[0].errorCount,     1);
+        QVERIFY(entries[0].boundingBox.contains(QGeoCoordinate(47.002, 8.004)));
+
+        query.text = QStringLiteral("sub/b");
+        QCOMPARE(paths(query), QStringList({ "b.tlog" }));
+
+        // Wildcards are searched for literally
+        query.text = QStringLiteral("%");
+        QCOMPARE(paths(query), QStringList());
+        query.text.clear();
+
+        query.vehicleId = 2;
+        QCOMPARE(paths(query), QStringList({ "b.tlog" }));
+        query.vehicleId = 0;
+
+        query.errorsOnly = true;
+        QCOMPARE(paths(query), QStringList({ "c.ulg", "a.tlog" }));
+        query.errorsOnly = false;
+
+        query.area = QGeoRectangle(QGeoCoordinate(47.5, 7.5), QGeoCoordinate(46.5, 8.5));
+        QCOMPARE(paths(query), QStringList({ "a.tlog" }));
+
+        QCOMPARE(LogIndexer::vehicleIds(db), QList<int>({ 1, 2, 3 }));
+
+        // Nothing changed, nothing is read again
+        progressSpy.clear();
+        updatedSpy.clear();
+        indexer.update(QStringList(logDir.path()));
+        QCOMPARE(progressSpy.count(),           0);
+        QCOMPARE(updatedSpy.count(),            1);
+        QCOMPARE(updatedSpy[0][0].toInt(),      3);
+        QCOMPARE(updatedSpy[0][1].toBool(),     false);
+
+        // Only the log which grew is read again, the removed one is dropped
+        QVERIFY(QFile::remove(bFileName));
+        QVERIFY(_writeFile(aFileName, _tlog(_startTimeUSecs + 20000000, 1, 47.0, false), true));
+        progressSpy.clear();
+        updatedSpy.clear();
+        indexer.update(QStringList(logDir.path()));
+        QCOMPARE(progressSpy.count(),           1);
+        QCOMPARE(updatedSpy[0][0].toInt(),      2);
+        query = LogIndexer::Query_t();
+        QCOMPARE(paths(query), QStringList({ "c.ulg", "a.tlog" }));
+        QVERIFY(LogIndexer::query(db, query, entries, errorString));
+        QCOMPARE(entries[1].durationSecs,   30.0);
+
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(QStringLiteral("LogIndexerTest"));
+}
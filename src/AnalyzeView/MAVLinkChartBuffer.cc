@@ -0,0 +1,124 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkChartBuffer.h"
+
+MAVLinkChartBuffer::MAVLinkChartBuffer(int capacity)
+    : _samples(qMax(capacity, 1))
+{
+
+}
+
+void MAVLinkChartBuffer::append(qreal x, qreal y)
+{
+    QPointF& sample = _samples[static_cast<int>(_nextSequence % _samples.count())];
+    sample.setX(x);
+    sample.setY(y);
+    _nextSequence++;
+    if (_count < _samples.count()) {
+        _count++;
+    }
+}
+
+void MAVLinkChartBuffer::clear(void)
+{
+    _count          = 0;
+    _nextSequence   = 0;
+}
+
+const QPointF& MAVLinkChartBuffer::at(qint64 sequence) const
+{
+    Q_ASSERT(sequence >= firstSequence() && sequence < _nextSequence);
+    return _samples[static_cast<int>(sequence % _samples.count())];
+}
+
+qint64 MAVLinkChartBuffer::lowerBound(qreal x) const
+{
+    qint64 first    = firstSequence();
+    qint64 last     = _nextSequence;
+    while (first < last) {
+        qint64 middle = first + ((last - first) / 2);
+        if (at(middle).x() < x) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    return first;
+}
+
+bool MAVLinkChartBuffer::decimate(qint64 firstSequence, int buckets, QVector<QPointF>& points, qreal& yMin, qreal& yMax) const
+{
+    firstSequence = qMax(firstSequence, this->firstSequence());
+    if (firstSequence >= _nextSequence) {
+        return false;
+    }
+    buckets = qMax(buckets, 1);
+
+    points.clear();
+    yMin = yMax = at(firstSequence).y();
+
+    if (_nextSequence - firstSequence <= 4 * buckets) {
+        points.reserve(static_cast<int>(_nextSequence - firstSequence));
+        for (qint64 sequence = firstSequence; sequence < _nextSequence; sequence++) {
+            const QPointF& sample = at(sequence);
+            yMin = qMin(yMin, sample.y());
+            yMax = qMax(yMax, sample.y());
+            points.append(sample);
+        }
+        return true;
+    }
+
+    const qreal xFirst      = at(firstSequence).x();
+    const qreal bucketWidth = (at(_nextSequence - 1).x() - xFirst) / buckets;
+
+    points.reserve(4 * buckets);
+    qint64  bucketFirst     = firstSequence;
+    qint64  bucketMin       = firstSequence;
+    qint64  bucketMax       = firstSequence;
+    int     bucket          = 0;
+    for (qint64 sequence = firstSequence; sequence <= _nextSequence; sequence++) {
+        int sampleBucket = buckets;     // One past the end flushes the last column
+        if (sequence < _nextSequence) {
+            sampleBucket = bucketWidth > 0 ? qMin(static_cast<int>((at(sequence).x() - xFirst) / bucketWidth), buckets - 1) : 0;
+        }
+        if (sampleBucket != bucket) {
+            //-- Column complete: first, lowest and highest in their own order, then last
+            const qint64 bucketLast = sequence - 1;
+            const qint64 low        = qMin(bucketMin, bucketMax);
+            const qint64 high       = qMax(bucketMin, bucketMax);
+            points.append(at(bucketFirst));
+            if (low != bucketFirst) {
+                points.append(at(low));
+            }
+            if (high != low && high != bucketFirst) {
+                points.append(at(high));
+            }
+            if (bucketLast != high && bucketLast != low && bucketLast != bucketFirst) {
+                points.append(at(bucketLast));
+            }
+            yMin = qMin(yMin, at(bucketMin).y());
+            yMax = qMax(yMax, at(bucketMax).y());
+            if (sequence == _nextSequence) {
+                break;
+            }
+            bucket      = sampleBucket;
+            bucketFirst = bucketMin = bucketMax = sequence;
+        } else {
+            const qreal y = at(sequence).y();
+            if (y < at(bucketMin).y()) {
+                bucketMin = sequence;
+            }
+            if (y > at(bucketMax).y()) {
+                bucketMax = sequence;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,54 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QPointF>
+#include <QVector>
+
+/// Preallocated ring of chart samples for a single MAVLink Inspector field. Once full the oldest samples are
+/// overwritten, so memory stays bounded no matter how long a field is plotted.
+///
+/// Samples must be appended in x (time) order. They are addressed by sequence number, the count of samples appended
+/// since the last clear, which lets a chart series append only the samples it hasn't seen yet.
+class MAVLinkChartBuffer
+{
+public:
+    MAVLinkChartBuffer(int capacity = defaultCapacity);
+
+    void    append  (qreal x, qreal y);
+    void    clear   (void);
+
+    int     capacity        (void) const { return _samples.count(); }
+    int     count           (void) const { return _count; }
+    qint64  firstSequence   (void) const { return _nextSequence - _count; }  ///< Sequence of the oldest sample held
+    qint64  nextSequence    (void) const { return _nextSequence; }           ///< Sequence the next sample gets
+
+    /// @return Sample with the sequence number, which must be held
+    const QPointF& at(qint64 sequence) const;
+
+    /// @return Sequence of the first sample with an x of at least x, nextSequence for none
+    qint64 lowerBound(qreal x) const;
+
+    /// Reduces the samples from firstSequence up to nextSequence onto buckets columns of equal x width. Each column
+    /// keeps its first, lowest, highest and last sample in x order, so spikes survive however many samples fall
+    /// into a single pixel. Ranges with no more than 4 samples per column are copied as is.
+    ///     @param[out] points  Replaced by the reduced samples
+    ///     @param[out] yMin    Lowest y of the range
+    ///     @param[out] yMax    Highest y of the range
+    ///     @return false: no samples in range, outputs untouched
+    bool decimate(qint64 firstSequence, int buckets, QVector<QPointF>& points, qreal& yMin, qreal& yMax) const;
+
+    static const int defaultCapacity = 200 * 60;    ///< 60 seconds at 200Hz
+
+private:
+    QVector<QPointF>    _samples;
+    int                 _count          = 0;
+    qint64              _nextSequence   = 0;
+};
@@ -0,0 +1,93 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkChartBufferTest.h"
+#include "MAVLinkChartBuffer.h"
+
+void MAVLinkChartBufferTest::_wrapTest(void)
+{
+    MAVLinkChartBuffer buffer(10);
+
+    for (int i=0; i<25; i++) {
+        buffer.append(i, i * 2);
+    }
+
+    // Only the newest samples are held once full
+    QCOMPARE(buffer.count(), 10);
+    QCOMPARE(buffer.firstSequence(), Q_INT64_C(15));
+    QCOMPARE(buffer.nextSequence(), Q_INT64_C(25));
+    for (qint64 sequence = buffer.firstSequence(); sequence < buffer.nextSequence(); sequence++) {
+        QCOMPARE(buffer.at(sequence), QPointF(sequence, sequence * 2));
+    }
+
+    buffer.clear();
+    QCOMPARE(buffer.count(), 0);
+    QCOMPARE(buffer.nextSequence(), Q_INT64_C(0));
+}
+
+void MAVLinkChartBufferTest::_lowerBoundTest(void)
+{
+    MAVLinkChartBuffer buffer(10);
+
+    QCOMPARE(buffer.lowerBound(0), Q_INT64_C(0));
+
+    for (int i=0; i<15; i++) {
+        buffer.append(i * 10, 0);
+    }
+
+    QCOMPARE(buffer.lowerBound(0),      Q_INT64_C(5));     // Older than the oldest held
+    QCOMPARE(buffer.lowerBound(70),     Q_INT64_C(7));
+    QCOMPARE(buffer.lowerBound(71),     Q_INT64_C(8));
+    QCOMPARE(buffer.lowerBound(140),    Q_INT64_C(14));
+    QCOMPARE(buffer.lowerBound(141),    Q_INT64_C(15));    // None
+}
+
+void MAVLinkChartBufferTest::_decimateTest(void)
+{
+    MAVLinkChartBuffer  buffer(10000);
+    QVector<QPointF>    points;
+    qreal               yMin;
+    qreal               yMax;
+
+    QVERIFY(!buffer.decimate(0, 10, points, yMin, yMax));
+
+    // Few samples are copied as is
+    for (int i=0; i<20; i++) {
+        buffer.append(i, i);
+    }
+    QVERIFY(buffer.decimate(5, 10, points, yMin, yMax));
+    QCOMPARE(points.count(), 15);
+    QCOMPARE(points.first(), QPointF(5, 5));
+    QCOMPARE(yMin, 5.0);
+    QCOMPARE(yMax, 19.0);
+
+    // Flat signal with a single spike in each direction, which must survive decimation
+    buffer.clear();
+    for (int i=0; i<10000; i++) {
+        qreal y = 0;
+        if (i == 1234) {
+            y = 100;
+        } else if (i == 8765) {
+            y = -50;
+        }
+        buffer.append(i, y);
+    }
+    const int buckets = 100;
+    QVERIFY(buffer.decimate(0, buckets, points, yMin, yMax));
+    QVERIFY(points.count() <= 4 * buckets);
+    QCOMPARE(yMin, -50.0);
+    QCOMPARE(yMax, 100.0);
+    QVERIFY(points.contains(QPointF(1234, 100)));
+    QVERIFY(points.contains(QPointF(8765, -50)));
+    QCOMPARE(points.first(), QPointF(0, 0));
+    QCOMPARE(points.last(), QPointF(9999, 0));
+    for (int i=1; i<points.count(); i++) {
+        QVERIFY(points[i - 1].x() < points[i].x());
+    }
+}
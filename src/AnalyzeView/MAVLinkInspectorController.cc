@@ -10,6 +10,8 @@
 #include "MAVLinkInspectorController.h"
 #include "QGCApplication.h"
 #include "MultiVehicleManager.h"
+#include "MessageRateManager.h"
+#include "QGCMemoryAccounting.h"
 #include <QtCharts/QLineSeries>
 
 QGC_LOGGING_CATEGORY(MAVLinkInspectorLog, "MAVLinkInspectorLog")
@@ -38,7 +40,9 @@ QGCMAVLinkMessageField::addSeries(MAVLinkChartController* chart, QAbstractSeries
         _chart = chart;
         _pSeries = series;
         emit seriesChanged();
-        _dataIndex = 0;
+        _buffer.clear();
+        _seriesDecimated = false;
+        _seriesFirst = _seriesNext = 0;
         _msg->updateFieldSelection();
     }
 }
@@ -48,9 +52,10 @@ void
 QGCMAVLinkMessageField::delSeries()
 {
     if(_pSeries) {
-        _values.clear();
+        _buffer.clear();
+        _points.clear();
         QLineSeries* lineSeries = static_cast<QLineSeries*>(_pSeries);
-        lineSeries->replace(_values);
+        lineSeries->clear();
         _pSeries = nullptr;
         _chart   = nullptr;
         emit seriesChanged();
@@ -88,45 +93,28 @@ QGCMAVLinkMessageField::chartIndex()
 //-----------------------------------------------------------------------------
 void
 QGCMAVLinkMessageField::updateValue(QString newValue, qreal v)
+{
+    setValue(newValue);
+    appendSample(v);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMAVLinkMessageField::setValue(const QString& newValue)
 {
     if(_value != newValue) {
         _value = newValue;
         emit valueChanged();
     }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMAVLinkMessageField::appendSample(qreal v)
+{
     if(_pSeries && _chart) {
-        int count = _values.count();
-        //-- Arbitrary limit of 1 minute of data at 50Hz for now
-        if(count < (50 * 60)) {
-            QPointF p(QGC::bootTimeMilliseconds(), v);
-            _values.append(p);
-        } else {
-            if(_dataIndex >= count) _dataIndex = 0;
-            _values[_dataIndex].setX(QGC::bootTimeMilliseconds());
-            _values[_dataIndex].setY(v);
-            _dataIndex++;
-        }
-        //-- Auto Range
-        if(_chart->rangeYIndex() == 0) {
-            qreal vmin  = std::numeric_limits<qreal>::max();
-            qreal vmax  = std::numeric_limits<qreal>::min();
-            for(int i = 0; i < _values.count(); i++) {
-                qreal v = _values[i].y();
-                if(vmax < v) vmax = v;
-                if(vmin > v) vmin = v;
-            }
-            bool changed = false;
-            if(std::abs(_rangeMin - vmin) > 0.000001) {
-                _rangeMin = vmin;
-                changed = true;
-            }
-            if(std::abs(_rangeMax - vmax) > 0.000001) {
-                _rangeMax = vmax;
-                changed = true;
-            }
-            if(changed) {
-                _chart->updateYRange();
-            }
-        }
+        //-- The series and the auto range catch up on the next updateSeries
+        _buffer.append(QGC::bootTimeMilliseconds(), v);
     }
 }
 
@@ -134,49 +122,91 @@ QGCMAVLinkMessageField::updateValue(QString newValue, qreal v)
 void
 QGCMAVLinkMessageField::updateSeries()
 {
-    int count = _values.count();
-    if (count > 1) {
-        QList<QPointF> s;
-        s.reserve(count);
-        int idx = _dataIndex;
-        for(int i = 0; i < count; i++, idx++) {
-            if(idx >= count) idx = 0;
-            QPointF p(_values[idx]);
-            s.append(p);
+    //-- Only the visible time range is plotted
+    const qint64 first          = _buffer.lowerBound(_chart->rangeXMin().toMSecsSinceEpoch());
+    const qint64 next           = _buffer.nextSequence();
+    const qint64 visibleCount   = next - first;
+    if (visibleCount < 2) {
+        return;
+    }
+    QLineSeries* lineSeries = static_cast<QLineSeries*>(_pSeries);
+    qreal vmin = 0;
+    qreal vmax = 0;
+    if (visibleCount <= 4 * _chart->plotWidth()) {
+        //-- Few enough samples to plot as is: expired samples are removed from the front and new ones appended
+        if (_seriesDecimated || _seriesFirst > first || _seriesNext > next) {
+            lineSeries->clear();
+            _seriesDecimated    = false;
+            _seriesFirst        = first;
+            _seriesNext         = first;
+        }
+        if (first > _seriesFirst) {
+            lineSeries->removePoints(0, static_cast<int>(qMin(first, _seriesNext) - _seriesFirst));
+            _seriesFirst = first;
+            _seriesNext  = qMax(_seriesNext, first);
+        }
+        if (_seriesNext < next) {
+            QList<QPointF> points;
+            points.reserve(static_cast<int>(next - _seriesNext));
+            for (qint64 sequence = _seriesNext; sequence < next; sequence++) {
+                points.append(_buffer.at(sequence));
+            }
+            lineSeries->append(points);
+            _seriesNext = next;
+        }
+        if (_chart->rangeYIndex() == 0) {
+            vmin = vmax = _buffer.at(first).y();
+            for (qint64 sequence = first + 1; sequence < next; sequence++) {
+                const qreal v = _buffer.at(sequence).y();
+                vmin = qMin(vmin, v);
+                vmax = qMax(vmax, v);
+            }
+        }
+    } else {
+        //-- More samples than pixels: min/max decimation onto the plot width
+        _buffer.decimate(first, _chart->plotWidth(), _points, vmin, vmax);
+        lineSeries->replace(_points);
+        _seriesDecimated = true;
+    }
+    //-- OpenGL only pays off for dense series
+    const bool useOpenGL = visibleCount >= openGLSampleCount;
+    if (_pSeries->useOpenGL() != useOpenGL) {
+        _pSeries->setUseOpenGL(useOpenGL);
+    }
+    //-- Auto Range
+    if(_chart->rangeYIndex() == 0) {
+        bool changed = false;
+        if(std::abs(_rangeMin - vmin) > 0.000001) {
+            _rangeMin = vmin;
+            changed = true;
+        }
+        if(std::abs(_rangeMax - vmax) > 0.000001) {
+            _rangeMax = vmax;
+            changed = true;
+        }
+        if(changed) {
+            _chart->updateYRange();
         }
-        QLineSeries* lineSeries = static_cast<QLineSeries*>(_pSeries);
-        lineSeries->replace(s);
     }
 }
 
 //-----------------------------------------------------------------------------
-QGCMAVLinkMessage::QGCMAVLinkMessage(QObject *parent, mavlink_message_t* message)
+QGCMAVLinkMessage::QGCMAVLinkMessage(QObject *parent, const mavlink_message_t* message)
     : QObject(parent)
 {
     _message = *message;
-    const mavlink_message_info_t* msgInfo = mavlink_get_message_info(message);
-    if (!msgInfo) {
+    _decoder = MAVLinkFieldDecoder::decoder(message->msgid);
+    if (!_decoder) {
         qCWarning(MAVLinkInspectorLog) << QStringLiteral("QGCMAVLinkMessage NULL msgInfo msgid(%1)").arg(message->msgid);
         return;
     }
-    _name = QString(msgInfo->name);
+    _name = _decoder->name();
+    _values.resize(_decoder->slotCount());
     qCDebug(MAVLinkInspectorLog) << "New Message:" << _name;
-    for (unsigned int i = 0; i < msgInfo->num_fields; ++i) {
-        QString type = QString("?");
-        switch (msgInfo->fields[i].type) {
-            case MAVLINK_TYPE_CHAR:     type = QString("char");     break;
-            case MAVLINK_TYPE_UINT8_T:  type = QString("uint8_t");  break;
-            case MAVLINK_TYPE_INT8_T:   type = QString("int8_t");   break;
-            case MAVLINK_TYPE_UINT16_T: type = QString("uint16_t"); break;
-            case MAVLINK_TYPE_INT16_T:  type = QString("int16_t");  break;
-            case MAVLINK_TYPE_UINT32_T: type = QString("uint32_t"); break;
-            case MAVLINK_TYPE_INT32_T:  type = QString("int32_t");  break;
-            case MAVLINK_TYPE_FLOAT:    type = QString("float");    break;
-            case MAVLINK_TYPE_DOUBLE:   type = QString("double");   break;
-            case MAVLINK_TYPE_UINT64_T: type = QString("uint64_t"); break;
-            case MAVLINK_TYPE_INT64_T:  type = QString("int64_t");  break;
-        }
-        QGCMAVLinkMessageField* f = new QGCMAVLinkMessageField(this, msgInfo->fields[i].name, type);
+    for (const MAVLinkFieldDecoder::Field_t& field: _decoder->fields()) {
+        QGCMAVLinkMessageField* f = new QGCMAVLinkMessageField(this, field.name, field.typeName);
+        //-- Char fields have no numeric value to chart
+        f->setSelectable(field.slot >= 0);
         _fields.append(f);
     }
 }
@@ -209,12 +239,17 @@ QGCMAVLinkMessage::updateFieldSelection()
 
 //-----------------------------------------------------------------------------
 void
-QGCMAVLinkMessage::updateFreq()
+QGCMAVLinkMessage::updateStatistics(const MAVLinkMessageStatistics::Stats_t& stats)
 {
-    quint64 msgCount = _count - _lastCount;
-    _messageHz = (0.2 * _messageHz) + (0.8 * msgCount);
-    _lastCount = _count;
-    emit freqChanged();
+    if(_count != stats.count) {
+        _count = stats.count;
+        emit countChanged();
+    }
+    if(std::abs(_messageHz - stats.messageHz) > 0.01 || std::abs(_bytesPerSec - stats.bytesPerSec) > 0.01) {
+        _messageHz   = stats.messageHz;
+        _bytesPerSec = stats.bytesPerSec;
+        emit freqChanged();
+    }
 }
 
 void QGCMAVLinkMessage::setSelected(bool sel)
@@ -228,245 +263,61 @@ void QGCMAVLinkMessage::setSelected(bool sel)
 
 //-----------------------------------------------------------------------------
 void
-QGCMAVLinkMessage::update(mavlink_message_t* message)
+QGCMAVLinkMessage::update(const mavlink_message_t* message)
 {
-    _count++;
     _message = *message;
 
-    if (_selected) {
-        // Don't update field info unless selected to reduce perf hit of message processing
+    if (_selected || _fieldSelected) {
+        // Don't update field info unless shown to reduce perf hit of message processing
         _updateFields();
     }
-    emit countChanged();
 }
 
 void QGCMAVLinkMessage::_updateFields(void)
 {
-    const mavlink_message_info_t* msgInfo = mavlink_get_message_info(&_message);
-    if (!msgInfo) {
-        qWarning() << QStringLiteral("QGCMAVLinkMessage::update NULL msgInfo msgid(%1)").arg(_message.msgid);
+    if (!_decoder) {
         return;
     }
-    if(_fields.count() != static_cast<int>(msgInfo->num_fields)) {
+    if(_fields.count() != _decoder->fields().count()) {
         qWarning() << QStringLiteral("QGCMAVLinkMessage::update msgInfo field count mismatch msgid(%1)").arg(_message.msgid);
         return;
     }
-    uint8_t* m = reinterpret_cast<uint8_t*>(&_message.payload64[0]);
-    for (unsigned int i = 0; i < msgInfo->num_fields; ++i) {
-        QGCMAVLinkMessageField* f = qobject_cast<QGCMAVLinkMessageField*>(_fields.get(static_cast<int>(i)));
+    //-- Numbers for the charts come straight from the decoder, strings are only built while the message is shown
+    _decoder->decode(_message, _values.data());
+    const QVector<MAVLinkFieldDecoder::Field_t>& decoderFields = _decoder->fields();
+    for (int i = 0; i < decoderFields.count(); ++i) {
+        QGCMAVLinkMessageField* f = qobject_cast<QGCMAVLinkMessageField*>(_fields.get(i));
         if(f) {
-            const unsigned int offset = msgInfo->fields[i].wire_offset;
-            const unsigned int array_length = msgInfo->fields[i].array_length;
-            static const unsigned int array_buffer_length = (MAVLINK_MAX_PAYLOAD_LEN + MAVLINK_NUM_CHECKSUM_BYTES + 7);
-            switch (msgInfo->fields[i].type) {
-            case MAVLINK_TYPE_CHAR:
-                f->setSelectable(false);
-                if (array_length > 0) {
-                    char* str = reinterpret_cast<char*>(m + offset);
-                    // Enforce null termination
-                    str[array_length - 1] = '\0';
-                    QString v(str);
-                    f->updateValue(v, 0);
-                } else {
-                    // Single char
-                    char b = *(reinterpret_cast<char*>(m + offset));
-                    QString v(b);
-                    f->updateValue(v, 0);
-                }
-                break;
-            case MAVLINK_TYPE_UINT8_T:
-                if (array_length > 0) {
-                    uint8_t* nums = m + offset;
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                        string += tmp.arg(nums[j]);
-                    }
-                    string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    uint8_t u = *(m + offset);
-                    f->updateValue(QString::number(u), static_cast<qreal>(u));
-                }
-                break;
-            case MAVLINK_TYPE_INT8_T:
-                if (array_length > 0) {
-                    int8_t* nums = reinterpret_cast<int8_t*>(m + offset);
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                        string += tmp.arg(nums[j]);
-                    }
-                    string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    int8_t n = *(reinterpret_cast<int8_t*>(m + offset));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
-                }
-                break;
-            case MAVLINK_TYPE_UINT16_T:
-                if (array_length > 0) {
-                    uint16_t nums[array_buffer_length / sizeof(uint16_t)];
-                    memcpy(nums, m + offset,  sizeof(uint16_t) * array_length);
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                        string += tmp.arg(nums[j]);
-                    }
-                    string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    uint16_t n;
-                    memcpy(&n, m + offset, sizeof(uint16_t));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
-                }
-                break;
-            case MAVLINK_TYPE_INT16_T:
-                if (array_length > 0) {
-                    int16_t nums[array_buffer_length / sizeof(int16_t)];
-                    memcpy(nums, m + offset,  sizeof(int16_t) * array_length);
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                        string += tmp.arg(nums[j]);
-                    }
-                    string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    int16_t n;
-                    memcpy(&n, m + offset, sizeof(int16_t));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
-                }
-                break;
-            case MAVLINK_TYPE_UINT32_T:
-                if (array_length > 0) {
-                    uint32_t nums[array_buffer_length / sizeof(uint32_t)];
-                    memcpy(nums, m + offset,  sizeof(uint32_t) * array_length);
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                        string += tmp.arg(nums[j]);
-                    }
-                    string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    uint32_t n;
-                    memcpy(&n, m + offset, sizeof(uint32_t));
-                    //-- Special case
-                    if(_message.msgid == MAVLINK_MSG_ID_SYSTEM_TIME) {
-                        QDateTime d = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(n),Qt::UTC,0);
-                        f->updateValue(d.toString("HH:mm:ss"), static_cast<qreal>(n));
-                    } else {
-                        f->updateValue(QString::number(n), static_cast<qreal>(n));
-                    }
-                }
-                break;
-            case MAVLINK_TYPE_INT32_T:
-                if (array_length > 0) {
-                    int32_t nums[array_buffer_length / sizeof(int32_t)];
-                    memcpy(nums, m + offset,  sizeof(int32_t) * array_length);
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                        string += tmp.arg(nums[j]);
-                    }
-                    string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    int32_t n;
-                    memcpy(&n, m + offset, sizeof(int32_t));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
-                }
-                break;
-            case MAVLINK_TYPE_FLOAT:
-                if (array_length > 0) {
-                    float nums[array_buffer_length / sizeof(float)];
-                    memcpy(nums, m + offset,  sizeof(float) * array_length);
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                       string += tmp.arg(static_cast<double>(nums[j]));
-                    }
-                    string += QString::number(static_cast<double>(nums[array_length - 1]));
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    float fv;
-                    memcpy(&fv, m + offset, sizeof(float));
-                    f->updateValue(QString::number(static_cast<double>(fv)), static_cast<qreal>(fv));
-                }
-                break;
-            case MAVLINK_TYPE_DOUBLE:
-                if (array_length > 0) {
-                    double nums[array_buffer_length / sizeof(double)];
-                    memcpy(nums, m + offset,  sizeof(double) * array_length);
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                        string += tmp.arg(nums[j]);
-                    }
-                    string += QString::number(static_cast<double>(nums[array_length - 1]));
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    double d;
-                    memcpy(&d, m + offset, sizeof(double));
-                    f->updateValue(QString::number(d), static_cast<qreal>(d));
-                }
-                break;
-            case MAVLINK_TYPE_UINT64_T:
-                if (array_length > 0) {
-                    uint64_t nums[array_buffer_length / sizeof(uint64_t)];
-                    memcpy(nums, m + offset,  sizeof(uint64_t) * array_length);
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                        string += tmp.arg(nums[j]);
-                    }
-                    string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    uint64_t n;
-                    memcpy(&n, m + offset, sizeof(uint64_t));
-                    //-- Special case
-                    if(_message.msgid == MAVLINK_MSG_ID_SYSTEM_TIME) {
-                        QDateTime d = QDateTime::fromMSecsSinceEpoch(n/1000,Qt::UTC,0);
-                        f->updateValue(d.toString("yyyy MM dd HH:mm:ss"), static_cast<qreal>(n));
-                    } else {
-                        f->updateValue(QString::number(n), static_cast<qreal>(n));
-                    }
-                }
-                break;
-            case MAVLINK_TYPE_INT64_T:
-                if (array_length > 0) {
-                    int64_t nums[array_buffer_length / sizeof(int64_t)];
-                    memcpy(nums, m + offset,  sizeof(int64_t) * array_length);
-                    QString tmp("%1, ");
-                    QString string;
-                    for (unsigned int j = 0; j < array_length - 1; ++j) {
-                        string += tmp.arg(nums[j]);
-                    }
-                    string += QString::number(nums[array_length - 1]);
-                    f->updateValue(string, static_cast<qreal>(nums[0]));
-                } else {
-                    // Single value
-                    int64_t n;
-                    memcpy(&n, m + offset, sizeof(int64_t));
-                    f->updateValue(QString::number(n), static_cast<qreal>(n));
-                }
-                break;
+            const int slot = decoderFields[i].slot;
+            if (slot >= 0 && f->selected()) {
+                f->appendSample(_values[slot]);
+            }
+            if (_selected) {
+                f->setValue(_fieldText(i));
             }
         }
     }
 }
 
+QString QGCMAVLinkMessage::_fieldText(int fieldIndex) const
+{
+    const MAVLinkFieldDecoder::Field_t& field = _decoder->fields()[fieldIndex];
+
+    //-- Special case
+    if (_message.msgid == MAVLINK_MSG_ID_SYSTEM_TIME && field.arrayLength == 0) {
+        if (field.type == MAVLINK_TYPE_UINT32_T) {
+            QDateTime d = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(_values[field.slot]), Qt::UTC, 0);
+            return d.toString("HH:mm:ss");
+        } else if (field.type == MAVLINK_TYPE_UINT64_T) {
+            quint64 n;
+            memcpy(&n, reinterpret_cast<const uint8_t*>(&_message.payload64[0]) + field.wireOffset, sizeof(n));
+            QDateTime d = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(n / 1000), Qt::UTC, 0);
+            return d.toString("yyyy MM dd HH:mm:ss");
+        }
+    }
+    return _decoder->text(_message, fieldIndex);
+}
+
 //-----------------------------------------------------------------------------
 QGCMAVLinkSystem::QGCMAVLinkSystem(QObject* parent, quint8 id)
     : QObject(parent)
@@ -478,6 +329,14 @@ QGCMAVLinkSystem::QGCMAVLinkSystem(QObject* parent, quint8 id)
 //-----------------------------------------------------------------------------
 QGCMAVLinkSystem::~QGCMAVLinkSystem()
 {
+    clearMessages();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMAVLinkSystem::clearMessages()
+{
+    _messagesByKey.clear();
     _messages.clearAndDeleteContents();
 }
 
@@ -485,15 +344,7 @@ QGCMAVLinkSystem::~QGCMAVLinkSystem()
 QGCMAVLinkMessage*
 QGCMAVLinkSystem::findMessage(uint32_t id, uint8_t cid)
 {
-    for(int i = 0; i < _messages.count(); i++) {
-        QGCMAVLinkMessage* m = qobject_cast<QGCMAVLinkMessage*>(_messages.get(i));
-        if(m) {
-            if(m->id() == id && m->cid() == cid) {
-                return m;
-            }
-        }
-    }
-    return nullptr;
+    return _messagesByKey.value(_messageKey(id, cid), nullptr);
 }
 
 //-----------------------------------------------------------------------------
@@ -562,6 +413,7 @@ QGCMAVLinkSystem::append(QGCMAVLinkMessage* message)
         message->setSelected(true);
     }
     _messages.append(message);
+    _messagesByKey.insert(_messageKey(message->id(), message->cid()), message);
     //-- Sort messages by id and then cid
     if (_messages.count() > 0) {
         _messages.beginReset();
@@ -622,6 +474,17 @@ MAVLinkChartController::setRangeYIndex(quint32 r)
     }
 }
 
+//-----------------------------------------------------------------------------
+void
+MAVLinkChartController::setPlotWidth(int width)
+{
+    width = qMax(width, 1);
+    if(_plotWidth != width) {
+        _plotWidth = width;
+        emit plotWidthChanged();
+    }
+}
+
 //-----------------------------------------------------------------------------
 void
 MAVLinkChartController::setRangeXIndex(quint32 t)
@@ -730,7 +593,8 @@ MAVLinkInspectorController::MAVLinkInspectorController()
     connect(multiVehicleManager, &MultiVehicleManager::vehicleAdded,   this, &MAVLinkInspectorController::_vehicleAdded);
     connect(multiVehicleManager, &MultiVehicleManager::vehicleRemoved, this, &MAVLinkInspectorController::_vehicleRemoved);
     MAVLinkProtocol* mavlinkProtocol = qgcApp()->toolbox()->mavlinkProtocol();
-    connect(mavlinkProtocol, &MAVLinkProtocol::messageReceived, this, &MAVLinkInspectorController::_receiveMessage);
+    mavlinkProtocol->messageDispatcher()->subscribe(MAVLinkMessageDispatcher::AnyMessage, MAVLinkMessageDispatcher::AnySystem, MAVLinkMessageDispatcher::AnyComponent,
+                                                    this, &MAVLinkInspectorController::_receiveMessage);
     connect(&_updateFrequencyTimer, &QTimer::timeout, this, &MAVLinkInspectorController::_refreshFrequency);
     _updateFrequencyTimer.start(1000);
     MultiVehicleManager *manager = qgcApp()->toolbox()->multiVehicleManager();
@@ -751,6 +615,35 @@ MAVLinkInspectorController::MAVLinkInspectorController()
     _rangeSt.append(new Range_st(this, tr("0.001"),   0.001));
     _rangeSt.append(new Range_st(this, tr("0.0001"),  0.0001));
     emit rangeListChanged();
+
+    qgcApp()->toolbox()->memoryAccounting()->addSource(QStringLiteral("MAVLink inspector messages"), this, [this]() {
+        QGCMemoryAccounting::Usage_t usage{ 0, 0 };
+        for (int i=0; i<_systems.count(); i++) {
+            QmlObjectListModel* messages = _systems.value<QGCMAVLinkSystem*>(i)->messages();
+            usage.count += messages->count();
+            usage.bytes += messages->count() * static_cast<qint64>(sizeof(QGCMAVLinkMessage));
+            for (int j=0; j<messages->count(); j++) {
+                usage.bytes += messages->value<QGCMAVLinkMessage*>(j)->fields()->count() * static_cast<qint64>(sizeof(QGCMAVLinkMessageField));
+            }
+        }
+        return usage;
+    });
+    // Each field has its own preallocated ring, sized for a minute of samples
+    qgcApp()->toolbox()->memoryAccounting()->addSource(QStringLiteral("Chart samples"), this, [this]() {
+        QGCMemoryAccounting::Usage_t usage{ 0, 0 };
+        for (int i=0; i<_systems.count(); i++) {
+            QmlObjectListModel* messages = _systems.value<QGCMAVLinkSystem*>(i)->messages();
+            for (int j=0; j<messages->count(); j++) {
+                QmlObjectListModel* fields = messages->value<QGCMAVLinkMessage*>(j)->fields();
+                for (int k=0; k<fields->count(); k++) {
+                    const MAVLinkChartBuffer& buffer = fields->value<QGCMAVLinkMessageField*>(k)->buffer();
+                    usage.count += buffer.count();
+                    usage.bytes += buffer.capacity() * static_cast<qint64>(sizeof(QPointF));
+                }
+            }
+        }
+        return usage;
+    });
 }
 
 //-----------------------------------------------------------------------------
@@ -820,13 +713,15 @@ MAVLinkInspectorController::_findVehicle(uint8_t id)
 void
 MAVLinkInspectorController::_refreshFrequency()
 {
+    const MAVLinkMessageStatistics* statistics = qgcApp()->toolbox()->mavlinkProtocol()->messageStatistics();
+    const quint64 now = QGC::bootTimeMilliseconds();
     for(int i = 0; i < _systems.count(); i++) {
         QGCMAVLinkSystem* v = qobject_cast<QGCMAVLinkSystem*>(_systems.get(i));
         if(v) {
             for(int i = 0; i < v->messages()->count(); i++) {
                 QGCMAVLinkMessage* m = qobject_cast<QGCMAVLinkMessage*>(v->messages()->get(i));
                 if(m) {
-                    m->updateFreq();
+                    m->updateStatistics(statistics->messageStats(v->id(), m->cid(), m->id(), now));
                 }
             }
         }
@@ -839,7 +734,7 @@ MAVLinkInspectorController::_vehicleAdded(Vehicle* vehicle)
 {
     QGCMAVLinkSystem* v = _findVehicle(static_cast<uint8_t>(vehicle->id()));
     if(v) {
-        v->messages()->clearAndDeleteContents();
+        v->clearMessages();
     } else {
         v = new QGCMAVLinkSystem(this, static_cast<uint8_t>(vehicle->id()));
         _systems.append(v);
@@ -864,7 +759,7 @@ MAVLinkInspectorController::_vehicleRemoved(Vehicle* vehicle)
 
 //-----------------------------------------------------------------------------
 void
-MAVLinkInspectorController::_receiveMessage(LinkInterface*, mavlink_message_t message)
+MAVLinkInspectorController::_receiveMessage(LinkInterface*, const mavlink_message_t& message)
 {
     QGCMAVLinkMessage* m = nullptr;
     QGCMAVLinkSystem* v = _findVehicle(message.sysid);
@@ -941,3 +836,26 @@ void MAVLinkInspectorController::setActiveSystem(int systemId)
     }
 }
 
+Vehicle* MAVLinkInspectorController::_activeVehicle(void)
+{
+    return _activeSystem ? qgcApp()->toolbox()->multiVehicleManager()->getVehicleById(_activeSystem->id()) : nullptr;
+}
+
+void MAVLinkInspectorController::setMessageRate(quint32 msgId, qreal rateHz)
+{
+    // The request goes away with the inspector
+    Vehicle* vehicle = _activeVehicle();
+    if (vehicle) {
+        if (rateHz > 0) {
+            vehicle->messageRateManager()->requestMessageRate(this, static_cast<int>(msgId), rateHz);
+        } else {
+            vehicle->messageRateManager()->removeMessageRate(this, static_cast<int>(msgId));
+        }
+    }
+}
+
+qreal MAVLinkInspectorController::messageRate(quint32 msgId)
+{
+    Vehicle* vehicle = _activeVehicle();
+    return vehicle ? vehicle->messageRateManager()->requestedMessageRate(this, static_cast<int>(msgId)) : 0;
+}
@@ -14,8 +14,11 @@
 #pragma once
 
 #include "MAVLinkProtocol.h"
+#include "MAVLinkChartBuffer.h"
+#include "MAVLinkFieldDecoder.h"
 #include "Vehicle.h"
 
+#include <QHash>
 #include <QObject>
 #include <QString>
 #include <QDebug>
@@ -53,18 +56,23 @@ public:
     bool            selectable      () { return _selectable; }
     bool            selected        () { return _pSeries != nullptr; }
     QAbstractSeries*series          () { return _pSeries; }
-    QList<QPointF>* values          () { return &_values;}
     qreal           rangeMin        () { return _rangeMin; }
     qreal           rangeMax        () { return _rangeMax; }
     int             chartIndex      ();
+    const MAVLinkChartBuffer& buffer() const { return _buffer; }
 
     void            setSelectable   (bool sel);
     void            updateValue     (QString newValue, qreal v);
+    void            setValue        (const QString& newValue);
+    /// Adds a sample to the chart buffer, if the field is charted
+    void            appendSample    (qreal v);
 
     void            addSeries       (MAVLinkChartController* chart, QAbstractSeries* series);
     void            delSeries       ();
     void            updateSeries    ();
 
+    static const int openGLSampleCount = 2000;  ///< Visible samples from which the series is drawn with OpenGL
+
 signals:
     void            seriesChanged       ();
     void            selectableChanged   ();
@@ -75,14 +83,17 @@ private:
     QString     _name;
     QString     _value;
     bool        _selectable = true;
-    int         _dataIndex  = 0;
     qreal       _rangeMin   = 0;
     qreal       _rangeMax   = 0;
 
     QAbstractSeries*    _pSeries = nullptr;
     QGCMAVLinkMessage*  _msg     = nullptr;
     MAVLinkChartController*      _chart   = nullptr;
-    QList<QPointF>      _values;
+    MAVLinkChartBuffer  _buffer;
+    QVector<QPointF>    _points;                    ///< Reused for decimated series updates
+    bool                _seriesDecimated = false;
+    qint64              _seriesFirst    = 0;        ///< Buffer sequence of the first sample in the series, unless decimated
+    qint64              _seriesNext     = 0;        ///< Buffer sequence after the last sample in the series, unless decimated
 };
 
 //-----------------------------------------------------------------------------
@@ -94,27 +105,30 @@ public:
     Q_PROPERTY(quint32              cid             READ cid            CONSTANT)
     Q_PROPERTY(QString              name            READ name           CONSTANT)
     Q_PROPERTY(qreal                messageHz       READ messageHz      NOTIFY freqChanged)
+    Q_PROPERTY(qreal                bytesPerSec     READ bytesPerSec    NOTIFY freqChanged)
     Q_PROPERTY(quint64              count           READ count          NOTIFY countChanged)
     Q_PROPERTY(QmlObjectListModel*  fields          READ fields         CONSTANT)
     Q_PROPERTY(bool                 fieldSelected   READ fieldSelected  NOTIFY fieldSelectedChanged)
     Q_PROPERTY(bool                 selected        READ selected       NOTIFY selectedChanged)
 
-    QGCMAVLinkMessage   (QObject* parent, mavlink_message_t* message);
+    QGCMAVLinkMessage   (QObject* parent, const mavlink_message_t* message);
     ~QGCMAVLinkMessage  ();
 
     quint32             id              () { return _message.msgid;  }
     quint8              cid             () { return _message.compid; }
     QString             name            () { return _name;  }
     qreal               messageHz       () { return _messageHz; }
+    qreal               bytesPerSec     () { return _bytesPerSec; }
     quint64             count           () { return _count; }
-    quint64             lastCount       () { return _lastCount; }
     QmlObjectListModel* fields          () { return &_fields; }
     bool                fieldSelected   () { return _fieldSelected; }
     bool                selected        () { return _selected; }
 
     void                updateFieldSelection();
-    void                update          (mavlink_message_t* message);
-    void                updateFreq      ();
+    /// Keeps the message, fields are only decoded while the message is selected or one of them is charted
+    void                update          (const mavlink_message_t* message);
+    /// Count and rates come from MAVLinkMessageStatistics, polled instead of counted here for each message
+    void                updateStatistics(const MAVLinkMessageStatistics::Stats_t& stats);
     void                setSelected     (bool sel);
 
 signals:
@@ -124,16 +138,19 @@ signals:
     void selectedChanged                ();
 
 private:
-    void _updateFields(void);
-
-    QmlObjectListModel  _fields;
-    QString             _name;
-    qreal               _messageHz      = 0.0;
-    uint64_t            _count          = 1;
-    uint64_t            _lastCount      = 0;
-    mavlink_message_t   _message;
-    bool                _fieldSelected  = false;
-    bool                _selected       = false;
+    void    _updateFields   (void);
+    QString _fieldText      (int fieldIndex) const;
+
+    QmlObjectListModel          _fields;
+    QString                     _name;
+    qreal                       _messageHz      = 0.0;
+    qreal                       _bytesPerSec    = 0.0;
+    uint64_t                    _count          = 1;
+    mavlink_message_t           _message;
+    bool                        _fieldSelected  = false;
+    bool                        _selected       = false;
+    const MAVLinkFieldDecoder*  _decoder        = nullptr;
+    QVector<double>             _values;                    ///< Numeric field values, by decoder slot
 };
 
 //-----------------------------------------------------------------------------
@@ -160,6 +177,7 @@ public:
     QGCMAVLinkMessage*  findMessage     (uint32_t id, uint8_t cid);
     int                 findMessage     (QGCMAVLinkMessage* message);
     void                append          (QGCMAVLinkMessage* message);
+    void                clearMessages   ();
 
 signals:
     void compIDsChanged                 ();
@@ -169,11 +187,14 @@ private:
     void _checkCompID                   (QGCMAVLinkMessage *message);
     void _resetSelection                ();
 
+    static quint64 _messageKey          (uint32_t id, uint8_t cid) { return (static_cast<quint64>(id) << 8) | cid; }
+
 private:
     quint8              _id;
     QList<int>          _compIDs;
     QStringList         _compIDsStr;
     QmlObjectListModel  _messages;      //-- List of QGCMAVLinkMessage
+    QHash<quint64, QGCMAVLinkMessage*> _messagesByKey;  ///< Same messages, for the lookup of each received one
     int                 _selected = 0;
 };
 
@@ -190,6 +211,7 @@ public:
     Q_PROPERTY(qreal        rangeYMin           READ rangeYMin              NOTIFY rangeYMinChanged)
     Q_PROPERTY(qreal        rangeYMax           READ rangeYMax              NOTIFY rangeYMaxChanged)
     Q_PROPERTY(int          chartIndex          READ chartIndex             CONSTANT)
+    Q_PROPERTY(int          plotWidth           READ plotWidth              WRITE setPlotWidth      NOTIFY plotWidthChanged)   ///< Pixels, series are decimated onto this
 
     Q_PROPERTY(quint32      rangeYIndex         READ rangeYIndex            WRITE setRangeYIndex    NOTIFY rangeYIndexChanged)
     Q_PROPERTY(quint32      rangeXIndex         READ rangeXIndex            WRITE setRangeXIndex    NOTIFY rangeXIndexChanged)
@@ -207,9 +229,11 @@ public:
     quint32                 rangeXIndex         () { return _rangeXIndex; }
     quint32                 rangeYIndex         () { return _rangeYIndex; }
     int                     chartIndex          () { return _index; }
+    int                     plotWidth           () { return _plotWidth; }
 
     void                    setRangeXIndex      (quint32 t);
     void                    setRangeYIndex      (quint32 r);
+    void                    setPlotWidth        (int width);
     void                    updateXRange        ();
     void                    updateYRange        ();
 
@@ -221,6 +245,7 @@ signals:
     void rangeYMaxChanged   ();
     void rangeYIndexChanged ();
     void rangeXIndexChanged ();
+    void plotWidthChanged   ();
 
 private slots:
     void _refreshSeries     ();
@@ -230,6 +255,7 @@ private:
     QDateTime           _rangeXMin;
     QDateTime           _rangeXMax;
     int                 _index               = 0;
+    int                 _plotWidth           = 1000;
     qreal               _rangeYMin           = 0;
     qreal               _rangeYMax           = 1;
     quint32             _rangeXIndex         = 0;                    ///< 5 Seconds
@@ -258,6 +284,11 @@ public:
     Q_INVOKABLE void                    deleteChart     (MAVLinkChartController* chart);
     Q_INVOKABLE void                    setActiveSystem (int systemId);
 
+    /// Asks the active system for the message at rateHz, 0 for its default rate
+    Q_INVOKABLE void                    setMessageRate  (quint32 msgId, qreal rateHz);
+    /// @return Rate asked for with setMessageRate, 0 for none
+    Q_INVOKABLE qreal                   messageRate     (quint32 msgId);
+
     QmlObjectListModel* systems     () { return &_systems;     }
     QmlObjectListModel* charts      () { return &_charts;       }
     QGCMAVLinkSystem*   activeSystem() { return _activeSystem; }
@@ -290,14 +321,15 @@ signals:
     void rangeListChanged   ();
 
 private slots:
-    void _receiveMessage    (LinkInterface* link, mavlink_message_t message);
     void _vehicleAdded      (Vehicle* vehicle);
     void _vehicleRemoved    (Vehicle* vehicle);
     void _setActiveVehicle  (Vehicle* vehicle);
     void _refreshFrequency  ();
 
 private:
+    void              _receiveMessage(LinkInterface* link, const mavlink_message_t& message);
     QGCMAVLinkSystem* _findVehicle (uint8_t id);
+    Vehicle*          _activeVehicle(void);
 
 private:
 
@@ -157,6 +157,24 @@ AnalyzePage {
                         QGCLabel {
                             text:       curMessage ? curMessage.count : ""
                         }
+                        QGCLabel {
+                            text:       qsTr("Bandwidth:")
+                        }
+                        QGCLabel {
+                            text:       curMessage ? curMessage.bytesPerSec.toFixed(0) + " B/s" : ""
+                        }
+                        QGCLabel {
+                            text:       qsTr("Requested Rate:")
+                        }
+                        QGCComboBox {
+                            id:             rateCombo
+                            model:          [ qsTr("Vehicle Default"), "1 Hz", "2 Hz", "5 Hz", "10 Hz", "20 Hz", "50 Hz" ]
+                            sizeToContents: true
+                            currentIndex:   curMessage ? Math.max(0, _rates.indexOf(controller.messageRate(curMessage.id))) : 0
+                            onActivated:    controller.setMessageRate(curMessage.id, _rates[index])
+
+                            property var _rates: [ 0, 1, 2, 5, 10, 20, 50 ]
+                        }
                     }
                     Item { height: ScreenTools.defaultFontPixelHeight; width: 1 }
                     //---------------------------------------------------------
@@ -0,0 +1,220 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MavlinkConsoleBuffer.h"
+
+MavlinkConsoleBuffer::MavlinkConsoleBuffer(int capacity)
+    : _capacity(capacity > chunkLines ? capacity : chunkLines)
+{
+
+}
+
+void MavlinkConsoleBuffer::append(const QByteArray& data)
+{
+    _pending.append(data);
+
+    const int   size        = _pending.size();
+    int         position    = 0;
+    int         runStart    = 0;
+    while (position < size) {
+        const char c = _pending.at(position);
+        if (c == '\n') {
+            _write(_pending.mid(runStart, position - runStart));
+            _newLine();
+            runStart = ++position;
+        } else if (c == '\x1B') {
+            // Codes apply to the text written so far
+            _write(_pending.mid(runStart, position - runStart));
+            runStart = position;
+            if (!_processANSI(position)) {
+                // Fragmented control code, wait for the rest of it
+                break;
+            }
+            if (position != runStart) {
+                runStart = position;
+            } else {
+                // Not a code we know, it stays part of the text
+                position++;
+            }
+        } else {
+            position++;
+        }
+    }
+    _write(_pending.mid(runStart, position - runStart));
+    _pending.remove(0, position);
+}
+
+void MavlinkConsoleBuffer::clear(void)
+{
+    _chunks.clear();
+    _count          = 0;
+    _firstSequence  = 0;
+    _cursorSequence = 0;
+    _cursorX        = 0;
+    _homeSequence   = -1;
+    _changedSequence= -1;
+    _pending.clear();
+}
+
+const QString& MavlinkConsoleBuffer::at(qint64 sequence) const
+{
+    Q_ASSERT(sequence >= _firstSequence && sequence < nextSequence());
+    const int offset = static_cast<int>(sequence - _firstSequence);
+    return _chunks[offset / chunkLines][offset % chunkLines];
+}
+
+QStringList MavlinkConsoleBuffer::lines(qint64 firstSequence, int count) const
+{
+    QStringList lines;
+
+    const qint64 lastSequence = qMin(firstSequence + count, nextSequence());
+    for (qint64 sequence = qMax(firstSequence, _firstSequence); sequence < lastSequence; sequence++) {
+        lines.append(at(sequence));
+    }
+    return lines;
+}
+
+qint64 MavlinkConsoleBuffer::search(const QString& text, qint64 fromSequence, bool forward, Qt::CaseSensitivity caseSensitivity) const
+{
+    if (text.isEmpty() || _count == 0) {
+        return -1;
+    }
+
+    if (forward) {
+        for (qint64 sequence = qMax(fromSequence, _firstSequence); sequence < nextSequence(); sequence++) {
+            if (at(sequence).contains(text, caseSensitivity)) {
+                return sequence;
+            }
+        }
+    } else {
+        for (qint64 sequence = qMin(fromSequence, nextSequence() - 1); sequence >= _firstSequence; sequence--) {
+            if (at(sequence).contains(text, caseSensitivity)) {
+                return sequence;
+            }
+        }
+    }
+    return -1;
+}
+
+void MavlinkConsoleBuffer::_write(const QByteArray& text)
+{
+    _ensureLine(_cursorSequence);
+    if (text.isEmpty()) {
+        return;
+    }
+
+    const QString   string  = QString::fromUtf8(text);
+    QString&        line    = _line(_cursorSequence);
+    if (line.length() < _cursorX) {
+        line.append(QString(_cursorX - line.length(), QLatin1Char(' ')));
+    }
+    line.replace(_cursorX, string.length(), string);
+    _cursorX += string.length();
+    _markChanged(_cursorSequence);
+}
+
+void MavlinkConsoleBuffer::_newLine(void)
+{
+    _cursorSequence++;
+    _cursorX = 0;
+    _ensureLine(_cursorSequence);
+}
+
+bool MavlinkConsoleBuffer::_processANSI(int& position)
+{
+    if (position + 1 < _pending.size() && _pending.at(position + 1) != '[') {
+        return true;
+    }
+    // For ANSI codes we expect at least 3 chars
+    if (position + 2 >= _pending.size()) {
+        return false;
+    }
+
+    switch (_pending.at(position + 2)) {
+    case 'H':
+        if (_homeSequence == -1) {
+            // Assign new home position if home is unset
+            _homeSequence = _cursorSequence;
+        } else {
+            // Rewind write cursor position to home
+            _cursorSequence = _homeSequence;
+            _cursorX        = 0;
+        }
+        position += 3;
+        break;
+    case 'K':
+        // Erase the current line to the end
+        if (_cursorSequence < nextSequence()) {
+            QString& line = _line(_cursorSequence);
+            if (_cursorX < line.length()) {
+                line.truncate(_cursorX);
+                _markChanged(_cursorSequence);
+            }
+        }
+        position += 3;
+        break;
+    case '2':
+        if (position + 3 >= _pending.size()) {
+            return false;
+        }
+        if (_pending.at(position + 3) == 'J' && _homeSequence != -1) {
+            // Erase everything from home on
+            for (qint64 sequence = _homeSequence; sequence < nextSequence(); sequence++) {
+                _line(sequence).clear();
+            }
+            _markChanged(_homeSequence);
+        }
+        // Even if we didn't understand this code, remove all 4 chars
+        position += 4;
+        break;
+    default:
+        break;
+    }
+    return true;
+}
+
+void MavlinkConsoleBuffer::_ensureLine(qint64 sequence)
+{
+    while (nextSequence() <= sequence) {
+        if (_chunks.isEmpty() || _chunks.last().count() == chunkLines) {
+            _chunks.append(QStringList());
+            _chunks.last().reserve(chunkLines);
+        }
+        _markChanged(nextSequence());
+        _chunks.last().append(QString());
+        _count++;
+    }
+
+    // The cursor is always on the newest line when lines are added, so dropping the oldest chunk never takes it
+    while (_count > _capacity && _chunks.count() > 1) {
+        _count          -= _chunks.first().count();
+        _firstSequence  += _chunks.first().count();
+        _chunks.removeFirst();
+    }
+    if (_homeSequence < _firstSequence) {
+        _homeSequence = -1;
+    }
+    if (_changedSequence != -1 && _changedSequence < _firstSequence) {
+        _changedSequence = _firstSequence;
+    }
+}
+
+QString& MavlinkConsoleBuffer::_line(qint64 sequence)
+{
+    Q_ASSERT(sequence >= _firstSequence && sequence < nextSequence());
+    const int offset = static_cast<int>(sequence - _firstSequence);
+    return _chunks[offset / chunkLines][offset % chunkLines];
+}
+
+void MavlinkConsoleBuffer::_markChanged(qint64 sequence)
+{
+    if (_changedSequence == -1 || sequence < _changedSequence) {
+        _changedSequence = sequence;
+    }
+}
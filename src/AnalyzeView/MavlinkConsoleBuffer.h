@@ -0,0 +1,75 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+/// Output lines of the vehicle shell. Raw SERIAL_CONTROL bytes are split into lines as they arrive, only an
+/// incomplete ANSI control code is held back until the rest of it comes in. The ANSI codes the PX4 shell uses for
+/// top and friends are applied to the lines: ESC[H (cursor home), ESC[K (erase to end of line) and ESC[2J (erase
+/// from home).
+///
+/// Lines live in chunks of chunkLines. Once more than capacity lines are held the oldest chunk is dropped as a whole,
+/// so long sessions neither grow memory nor shift the remaining lines. Lines are addressed by sequence number, the
+/// count of lines written before them since the last clear.
+class MavlinkConsoleBuffer
+{
+public:
+    MavlinkConsoleBuffer(int capacity = defaultCapacity);
+
+    /// Splits data onto the lines, starting where the previous data left off
+    void append(const QByteArray& data);
+    void clear (void);
+
+    /// Forgets the cursor home, the next ESC[H sets a new one
+    void resetHome(void) { _homeSequence = -1; }
+
+    int     capacity        (void) const { return _capacity; }
+    int     count           (void) const { return _count; }
+    qint64  firstSequence   (void) const { return _firstSequence; }             ///< Sequence of the oldest line held
+    qint64  nextSequence    (void) const { return _firstSequence + _count; }    ///< Sequence the next new line gets
+
+    /// @return Line with the sequence number, which must be held
+    const QString& at(qint64 sequence) const;
+
+    /// @return Held lines from firstSequence on, up to count of them
+    QStringList lines(qint64 firstSequence, int count) const;
+
+    /// @return Sequence of the nearest line containing text starting at fromSequence, -1 for none
+    qint64 search(const QString& text, qint64 fromSequence, bool forward, Qt::CaseSensitivity caseSensitivity = Qt::CaseInsensitive) const;
+
+    /// @return Oldest line which changed or was added since the last clearChanged, -1 for none
+    qint64  changedSequence (void) const { return _changedSequence; }
+    void    clearChanged    (void) { _changedSequence = -1; }
+
+    static const int defaultCapacity    = 10000;
+    static const int chunkLines         = 256;
+
+private:
+    void        _write          (const QByteArray& text);
+    void        _newLine        (void);
+    bool        _processANSI    (int& position);
+    void        _ensureLine     (qint64 sequence);
+    QString&    _line           (qint64 sequence);
+    void        _markChanged    (qint64 sequence);
+
+    int                 _capacity;
+    QList<QStringList>  _chunks;
+    int                 _count              = 0;
+    qint64              _firstSequence      = 0;
+    qint64              _cursorSequence     = 0;
+    int                 _cursorX            = 0;
+    qint64              _homeSequence       = -1;
+    qint64              _changedSequence    = -1;
+    QByteArray          _pending;                   ///< Incomplete ANSI control code
+};
@@ -0,0 +1,101 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MavlinkConsoleBufferTest.h"
+#include "MavlinkConsoleBuffer.h"
+
+void MavlinkConsoleBufferTest::_splitTest(void)
+{
+    MavlinkConsoleBuffer buffer;
+
+    // Lines split over several packets are joined
+    buffer.append("nsh> ver");
+    buffer.append(" all\nHW arch: PX4_");
+    buffer.append("FMU_V5\n");
+
+    QCOMPARE(buffer.count(), 3);
+    QCOMPARE(buffer.at(0), QStringLiteral("nsh> ver all"));
+    QCOMPARE(buffer.at(1), QStringLiteral("HW arch: PX4_FMU_V5"));
+    QCOMPARE(buffer.at(2), QString());
+    QCOMPARE(buffer.changedSequence(), Q_INT64_C(0));
+
+    buffer.clearChanged();
+    QCOMPARE(buffer.changedSequence(), Q_INT64_C(-1));
+    buffer.append("nsh> ");
+    QCOMPARE(buffer.changedSequence(), Q_INT64_C(2));
+    QCOMPARE(buffer.lines(1, 5), QStringList({ QStringLiteral("HW arch: PX4_FMU_V5"), QStringLiteral("nsh> ") }));
+}
+
+void MavlinkConsoleBufferTest::_ansiTest(void)
+{
+    MavlinkConsoleBuffer buffer;
+
+    // The first home sets the home line, the second one rewinds to it
+    buffer.append("nsh> top\n\x1B[H");
+    buffer.append("PID COMMAND\n1 idle\n2 hpwork\n");
+    buffer.append("\x1B");                      // Fragmented code
+    buffer.append("[H\x1B[2");
+    QCOMPARE(buffer.at(3), QStringLiteral("2 hpwork"));
+    buffer.append("J");
+    QCOMPARE(buffer.count(), 5);
+    QCOMPARE(buffer.at(0), QStringLiteral("nsh> top"));
+    for (qint64 sequence = 1; sequence < buffer.nextSequence(); sequence++) {
+        QCOMPARE(buffer.at(sequence), QString());
+    }
+
+    // Output after the rewind overwrites the lines from home on
+    buffer.append("PID COMMAND\n1 idle_task\x1B[K\n");
+    QCOMPARE(buffer.count(), 5);
+    QCOMPARE(buffer.at(1), QStringLiteral("PID COMMAND"));
+    QCOMPARE(buffer.at(2), QStringLiteral("1 idle_task"));
+
+    // Erase to end of line keeps what is left of the cursor
+    buffer.append("abcdef\x1B[H");
+    buffer.append("xy\x1B[K");
+    QCOMPARE(buffer.at(1), QStringLiteral("xy"));
+
+    // Codes which aren't known stay part of the text
+    buffer.clear();
+    buffer.append("\x1B[0mok\n");
+    QCOMPARE(buffer.at(0), QStringLiteral("\x1B[0mok"));
+}
+
+void MavlinkConsoleBufferTest::_capacityTest(void)
+{
+    MavlinkConsoleBuffer buffer(MavlinkConsoleBuffer::chunkLines * 2);
+
+    const int lineCount = MavlinkConsoleBuffer::chunkLines * 5 + 10;
+    for (int i=0; i<lineCount; i++) {
+        buffer.append(QByteArray::number(i) + '\n');
+    }
+
+    // Whole chunks of the oldest lines are dropped, the newest are kept
+    QVERIFY(buffer.count() <= buffer.capacity());
+    QVERIFY(buffer.count() > buffer.capacity() - MavlinkConsoleBuffer::chunkLines);
+    QCOMPARE(buffer.nextSequence(), static_cast<qint64>(lineCount + 1));
+    QCOMPARE(buffer.firstSequence() % MavlinkConsoleBuffer::chunkLines, Q_INT64_C(0));
+    for (qint64 sequence = buffer.firstSequence(); sequence < buffer.nextSequence() - 1; sequence++) {
+        QCOMPARE(buffer.at(sequence), QString::number(sequence));
+    }
+}
+
+void MavlinkConsoleBufferTest::_searchTest(void)
+{
+    MavlinkConsoleBuffer buffer;
+
+    buffer.append("INFO  [commander] Ready\nWARN  [health] low battery\nINFO  [logger] started\nwarn again\n");
+
+    QCOMPARE(buffer.search(QStringLiteral("warn"), 0, true),                           Q_INT64_C(1));
+    QCOMPARE(buffer.search(QStringLiteral("warn"), 2, true),                           Q_INT64_C(3));
+    QCOMPARE(buffer.search(QStringLiteral("warn"), 2, false),                          Q_INT64_C(1));
+    QCOMPARE(buffer.search(QStringLiteral("warn"), 2, true, Qt::CaseSensitive),        Q_INT64_C(3));
+    QCOMPARE(buffer.search(QStringLiteral("WARN"), 2, true, Qt::CaseSensitive),        Q_INT64_C(-1));
+    QCOMPARE(buffer.search(QStringLiteral("missing"), 0, true),                        Q_INT64_C(-1));
+    QCOMPARE(buffer.search(QString(), 0, true),                                        Q_INT64_C(-1));
+}
@@ -14,7 +14,7 @@
 #include <QClipboard>
 
 MavlinkConsoleController::MavlinkConsoleController()
-    : QStringListModel()
+    : QAbstractListModel()
 {
     auto *manager = qgcApp()->toolbox()->multiVehicleManager();
     connect(manager, &MultiVehicleManager::activeVehicleChanged, this, &MavlinkConsoleController::_setActiveVehicle);
@@ -41,7 +41,7 @@ MavlinkConsoleController::sendCommand(QString command)
     }
     command.append("\n");
     _sendSerialData(qPrintable(command));
-    _cursor_home_pos = -1;
+    _buffer.resetHome();
 }
 
 QString
@@ -79,12 +79,16 @@ MavlinkConsoleController::_setActiveVehicle(Vehicle* vehicle)
     _vehicle = vehicle;
 
     if (_vehicle) {
-        _incoming_buffer.clear();
         // Reset the model
-        setStringList(QStringList());
-        _cursorY = 0;
-        _cursorX = 0;
-        _cursor_home_pos = -1;
+        beginResetModel();
+        _buffer.clear();
+        _windowSequence = 0;
+        _followOutput   = true;
+        _searchSequence = -1;
+        endResetModel();
+        emit lineCountChanged();
+        emit windowChanged();
+        emit textChanged();
         _uas_connections << connect(_vehicle, &Vehicle::mavlinkSerialControl, this, &MavlinkConsoleController::_receiveData);
     }
 }
@@ -95,35 +99,24 @@ MavlinkConsoleController::_receiveData(uint8_t device, uint8_t, uint16_t, uint32
     if (device != SERIAL_CONTROL_DEV_SHELL)
         return;
 
-    // Append incoming data and parse for ANSI codes
-    _incoming_buffer.append(data);
-    while(!_incoming_buffer.isEmpty()) {
-        bool newline = false;
-        int idx = _incoming_buffer.indexOf('\n');
-        if (idx == -1) {
-            // Read the whole incoming buffer
-            idx = _incoming_buffer.size();
-        } else {
-            newline = true;
-        }
+    const int       lineCount       = _buffer.count();
+    const qint64    firstSequence   = _buffer.firstSequence();
+    _buffer.append(data);
 
-        QByteArray fragment = _incoming_buffer.mid(0, idx);
-        if (_processANSItext(fragment)) {
-            writeLine(_cursorY, fragment);
-            if (newline) {
-                _cursorY++;
-                _cursorX = 0;
-                // ensure line exists
-                int rc = rowCount();
-                if (_cursorY >= rc) {
-                    insertRows(rc, 1 + _cursorY - rc);
-                }
-            }
-            _incoming_buffer.remove(0, idx + (newline ? 1 : 0));
-        } else {
-            // ANSI processing failed, need more data
-            return;
-        }
+    const qint64 changedSequence = _buffer.changedSequence();
+    _buffer.clearChanged();
+    if (lineCount != _buffer.count()) {
+        emit lineCountChanged();
+    }
+
+    // Only changes within the window need the view to update
+    const qint64 windowSequence = _followOutput ? _buffer.nextSequence() - _windowSize : _windowSequence;
+    const bool   inWindow       = changedSequence != -1 && changedSequence < _windowSequence + _windowSize;
+    if (inWindow || qMax(windowSequence, _buffer.firstSequence()) != _windowSequence) {
+        _moveWindow(windowSequence, _followOutput);
+    } else if (firstSequence != _buffer.firstSequence()) {
+        // Dropping the oldest lines renumbers the window
+        emit windowChanged();
     }
 }
 
@@ -164,68 +157,108 @@ MavlinkConsoleController::_sendSerialData(QByteArray data, bool close)
     }
 }
 
-bool
-MavlinkConsoleController::_processANSItext(QByteArray &line)
+void
+MavlinkConsoleController::_moveWindow(qint64 windowSequence, bool follow)
 {
-    // Iterate over the incoming buffer to parse off known ANSI control codes
-    for (int i = 0; i < line.size(); i++) {
-        if (line.at(i) == '\x1B') {
-            // For ANSI codes we expect at least 3 incoming chars
-            if (i < line.size() - 2 && line.at(i+1) == '[') {
-                // Parse ANSI code
-                switch(line.at(i+2)) {
-                    default:
-                        continue;
-                    case 'H':
-                        if (_cursor_home_pos == -1) {
-                            // Assign new home position if home is unset
-                            _cursor_home_pos = _cursorY;
-                        } else {
-                            // Rewind write cursor position to home
-                            _cursorY = _cursor_home_pos;
-                            _cursorX = 0;
-                        }
-                        break;
-                    case 'K':
-                        // Erase the current line to the end
-                        if (_cursorY < rowCount()) {
-                            auto idx = index(_cursorY);
-                            QString updated = data(idx, Qt::DisplayRole).toString();
-                            int eraseIdx = _cursorX + i;
-                            if (eraseIdx < updated.length()) {
-                                setData(idx, updated.remove(eraseIdx, updated.length()));
-                            }
-                        }
-                        break;
-                    case '2':
-                        // Check for sufficient buffer size
-                        if ( i >= line.size() - 3)
-                            return false;
-
-                        if (line.at(i+3) == 'J' && _cursor_home_pos != -1) {
-                            // Erase everything and rewind to home
-                            bool blocked = blockSignals(true);
-                            for (int j = _cursor_home_pos; j < rowCount(); j++)
-                                setData(index(j), "");
-                            blockSignals(blocked);
-                            QVector<int> roles({Qt::DisplayRole, Qt::EditRole});
-                            emit dataChanged(index(_cursorY), index(rowCount()), roles);
-                        }
-                        // Even if we didn't understand this ANSI code, remove the 4th char
-                        line.remove(i+3,1);
-                        break;
-                }
-                // Remove the parsed ANSI code and decrement the bufferpos
-                line.remove(i, 3);
-                i--;
-            } else {
-                // We can reasonably expect a control code was fragemented
-                // Stop parsing here and wait for it to come in
-                return false;
-            }
-        }
+    _windowSequence = qMax(qMin(windowSequence, _buffer.nextSequence() - _windowSize), _buffer.firstSequence());
+    _followOutput   = follow || _windowSequence + _windowSize >= _buffer.nextSequence();
+
+    // The window is small, so resetting it is cheaper than tracking the rows which moved
+    beginResetModel();
+    endResetModel();
+    emit windowChanged();
+    emit textChanged();
+}
+
+void
+MavlinkConsoleController::setWindowStart(int windowStart)
+{
+    _moveWindow(_buffer.firstSequence() + windowStart, false);
+}
+
+void
+MavlinkConsoleController::setWindowSize(int windowSize)
+{
+    windowSize = qMax(windowSize, 1);
+    if (windowSize != _windowSize) {
+        _windowSize = windowSize;
+        _moveWindow(_followOutput ? _buffer.nextSequence() - _windowSize : _windowSequence, _followOutput);
+    }
+}
+
+void
+MavlinkConsoleController::scrollToEnd()
+{
+    if (!_followOutput || _searchSequence != -1) {
+        _searchSequence = -1;
+        _moveWindow(_buffer.nextSequence() - _windowSize, true);
+    }
+}
+
+int
+MavlinkConsoleController::search(const QString& text, bool forward)
+{
+    qint64 fromSequence;
+    if (_searchSequence >= _buffer.firstSequence()) {
+        fromSequence = _searchSequence + (forward ? 1 : -1);
+    } else {
+        fromSequence = forward ? _windowSequence : _windowSequence + _windowSize - 1;
+    }
+
+    qint64 sequence = _buffer.search(text, fromSequence, forward);
+    if (sequence == -1) {
+        // Wrap around
+        sequence = _buffer.search(text, forward ? _buffer.firstSequence() : _buffer.nextSequence() - 1, forward);
+    }
+    _searchSequence = sequence;
+    if (sequence == -1) {
+        emit textChanged();
+        return -1;
+    }
+
+    // Center the match unless it is already shown
+    qint64 windowSequence = _windowSequence;
+    if (sequence < _windowSequence || sequence >= _windowSequence + _windowSize) {
+        windowSequence = sequence - (_windowSize / 2);
+    }
+    _moveWindow(windowSequence, false);
+    return static_cast<int>(sequence - _buffer.firstSequence());
+}
+
+int
+MavlinkConsoleController::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return static_cast<int>(qMin(_buffer.nextSequence() - _windowSequence, static_cast<qint64>(_windowSize)));
+}
+
+QVariant
+MavlinkConsoleController::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= rowCount()) {
+        return QVariant();
+    }
+
+    const QString& line = _buffer.at(_windowSequence + index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        return line;
+    case RichTextRole:
+        return transformLineForRichText(line);
+    default:
+        return QVariant();
     }
-    return true;
+}
+
+QHash<int, QByteArray>
+MavlinkConsoleController::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[Qt::DisplayRole]  = "display";
+    roles[RichTextRole]     = "richText";
+    return roles;
 }
 
 QString
@@ -245,38 +278,19 @@ MavlinkConsoleController::transformLineForRichText(const QString& line) const
 QString
 MavlinkConsoleController::getText() const
 {
-    QString ret;
-    if (rowCount() > 0) {
-        ret = transformLineForRichText(data(index(0), Qt::DisplayRole).toString());
-    }
-    for (int i = 1; i < rowCount(); ++i) {
-        ret += "<br>" + transformLineForRichText(data(index(i), Qt::DisplayRole).toString());
+    const int rows = rowCount();
+
+    QStringList lines;
+    lines.reserve(rows);
+    for (int row = 0; row < rows; ++row) {
+        QString line = transformLineForRichText(_buffer.at(_windowSequence + row));
+        if (_windowSequence + row == _searchSequence) {
+            line = "<span style=\"background-color:" + _palette.colorGrey().name() + "\">" + line + "</span>";
+        }
+        lines.append(line);
     }
 
-    return ret;
-}
-
-void
-MavlinkConsoleController::writeLine(int line, const QByteArray &text)
-{
-    auto rc = rowCount();
-    if (line >= rc) {
-        insertRows(rc, 1 + line - rc);
-    }
-    if (rowCount() > _max_num_lines) {
-        int count = rowCount() - _max_num_lines;
-        removeRows(0, count);
-        line -= count;
-        _cursorY -= count;
-        _cursor_home_pos -= count;
-        if (_cursor_home_pos < 0)
-            _cursor_home_pos = -1;
-    }
-    auto idx = index(line);
-    QString updated = data(idx, Qt::DisplayRole).toString();
-    updated.replace(_cursorX, text.size(), text);
-    setData(idx, updated);
-    _cursorX += text.size();
+    return lines.join("<br>");
 }
 
 void MavlinkConsoleController::CommandHistory::append(const QString& command)
@@ -9,20 +9,22 @@
 
 #pragma once
 
-#include "QmlObjectListModel.h"
+#include "MavlinkConsoleBuffer.h"
 #include "QGCPalette.h"
-#include "Fact.h"
-#include "FactMetaData.h"
 #include <QObject>
 #include <QString>
 #include <QMetaObject>
-#include <QStringListModel>
+#include <QAbstractListModel>
 
 // Fordward decls
 class Vehicle;
 
 /// Controller for MavlinkConsole.qml.
-class MavlinkConsoleController : public QStringListModel
+///
+/// The shell output is held by a MavlinkConsoleBuffer, the model only exposes the window of lines the console
+/// currently shows: rows are the lines from windowStart on, at most windowSize of them. While following the output
+/// the window sticks to the newest lines. Lines are numbered from the oldest line held.
+class MavlinkConsoleController : public QAbstractListModel
 {
     Q_OBJECT
 
@@ -30,6 +32,10 @@ public:
     MavlinkConsoleController();
     virtual ~MavlinkConsoleController();
 
+    enum Roles {
+        RichTextRole = Qt::UserRole + 1,
+    };
+
     Q_INVOKABLE void sendCommand(QString command);
 
     Q_INVOKABLE QString historyUp(const QString& current);
@@ -42,16 +48,48 @@ public:
      */
     Q_INVOKABLE QString handleClipboard(const QString& command_pre);
 
-    Q_PROPERTY(QString text                     READ getText                    CONSTANT)
+    /// Moves the window to the newest lines and follows the output from then on
+    Q_INVOKABLE void scrollToEnd(void);
+
+    /**
+     * Find the next line containing text, starting next to the previous match and wrapping around. The window
+     * is moved to show the match, which is highlighted.
+     * @param forward true: search towards the newest lines
+     * @return line number of the match, -1 if there is none
+     */
+    Q_INVOKABLE int search(const QString& text, bool forward);
+
+    Q_PROPERTY(QString  text            READ getText                            NOTIFY textChanged)
+    Q_PROPERTY(int      lineCount       READ lineCount                          NOTIFY lineCountChanged)
+    Q_PROPERTY(int      windowStart     READ windowStart    WRITE setWindowStart NOTIFY windowChanged)
+    Q_PROPERTY(int      windowSize      READ windowSize     WRITE setWindowSize NOTIFY windowChanged)
+    Q_PROPERTY(bool     followOutput    READ followOutput                       NOTIFY windowChanged)
+
+    int     lineCount       (void) const { return _buffer.count(); }
+    int     windowStart     (void) const { return static_cast<int>(_windowSequence - _buffer.firstSequence()); }
+    int     windowSize      (void) const { return _windowSize; }
+    bool    followOutput    (void) const { return _followOutput; }
+
+    void    setWindowStart  (int windowStart);
+    void    setWindowSize   (int windowSize);
+
+    // Overrides from QAbstractListModel
+    int                     rowCount    (const QModelIndex& parent = QModelIndex()) const override;
+    QVariant                data        (const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray>  roleNames   (void) const override;
+
+signals:
+    void textChanged        (void);
+    void lineCountChanged   (void);
+    void windowChanged      (void);
 
 private slots:
     void _setActiveVehicle  (Vehicle* vehicle);
     void _receiveData(uint8_t device, uint8_t flags, uint16_t timeout, uint32_t baudrate, QByteArray data);
 
 private:
-    bool _processANSItext(QByteArray &line);
     void _sendSerialData(QByteArray, bool close = false);
-    void writeLine(int line, const QByteArray &text);
+    void _moveWindow(qint64 windowSequence, bool follow);
 
     QString transformLineForRichText(const QString& line) const;
 
@@ -69,12 +107,11 @@ private:
         int _index = 0;
     };
 
-    static constexpr int _max_num_lines = 500; ///< history size (affects CPU load)
-
-    int           _cursor_home_pos{-1};
-    int           _cursorY{0};
-    int           _cursorX{0};
-    QByteArray    _incoming_buffer;
+    MavlinkConsoleBuffer _buffer;
+    qint64        _windowSequence{0};
+    int           _windowSize{40};
+    bool          _followOutput{true};
+    qint64        _searchSequence{-1};
     Vehicle*      _vehicle{nullptr};
     QList<QMetaObject::Connection> _uas_connections;
     CommandHistory _history;
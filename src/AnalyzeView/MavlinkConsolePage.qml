@@ -48,7 +48,7 @@ AnalyzePage {
             Connections {
                 target: conController
 
-                onDataChanged: {
+                onTextChanged: {
                     if (isLoaded) {
                         // rate-limit updates to reduce CPU load
                         updateTimer.start();
@@ -59,10 +59,22 @@ AnalyzePage {
             property int _consoleOutputLen: 0
 
             function scrollToBottom() {
+                conController.scrollToEnd()
                 var flickable = textConsole.flickableItem
                 if (flickable.contentHeight > flickable.height)
                     flickable.contentY = flickable.contentHeight-flickable.height
             }
+            function scrollLines(lines) {
+                conController.windowStart = Math.max(0, conController.windowStart + lines)
+            }
+            function updateWindowSize() {
+                // Only the lines which fit are handed to the text area, scrolling moves the window over the output
+                conController.windowSize = Math.max(1, Math.floor(textConsole.flickableItem.height / ScreenTools.defaultFontPixelHeight))
+            }
+            function searchOutput(forward) {
+                var line = conController.search(searchField.text, forward)
+                searchResult.text = line < 0 ? qsTr("Not found") : qsTr("Line %1 of %2").arg(line + 1).arg(conController.lineCount)
+            }
             function getCommand() {
                 return textConsole.getText(_consoleOutputLen, textConsole.length)
             }
@@ -95,22 +107,22 @@ AnalyzePage {
                 running: false
                 repeat: false
                 onTriggered: {
-                    // only update if scroll bar is at the bottom
-                    if (textConsole.flickableItem.atYEnd) {
-                        // backup & restore cursor & command
-                        var command = getCommand()
-                        var cursor = textConsole.cursorPosition - _consoleOutputLen
-                        textConsole.text = conController.text
-                        _consoleOutputLen = textConsole.length
-                        textConsole.insert(textConsole.length, command)
-                        textConsole.cursorPosition = textConsole.length
-                        scrollToBottom()
-                        if (cursor >= 0) {
-                            // We could restore the selection here too...
-                            textConsole.cursorPosition = _consoleOutputLen + cursor
-                        }
-                    } else {
-                        updateTimer.start();
+                    // The text only holds the lines of the window, so updating it stays cheap however long the output gets
+                    // backup & restore cursor & command
+                    var command = getCommand()
+                    var cursor = textConsole.cursorPosition - _consoleOutputLen
+                    textConsole.text = conController.text
+                    _consoleOutputLen = textConsole.length
+                    textConsole.insert(textConsole.length, command)
+                    textConsole.cursorPosition = textConsole.length
+                    if (conController.followOutput) {
+                        var flickable = textConsole.flickableItem
+                        if (flickable.contentHeight > flickable.height)
+                            flickable.contentY = flickable.contentHeight-flickable.height
+                    }
+                    if (cursor >= 0) {
+                        // We could restore the selection here too...
+                        textConsole.cursorPosition = _consoleOutputLen + cursor
                     }
                 }
             }
@@ -118,6 +130,7 @@ AnalyzePage {
             TextArea {
                 Component.onCompleted: {
                     isLoaded = true
+                    updateWindowSize()
                     _consoleOutputLen = textConsole.length
                     textConsole.cursorPosition = _consoleOutputLen
                     if (!_separateCommandInput)
@@ -134,6 +147,11 @@ AnalyzePage {
                 text:                    "> "
                 focus:                   true
 
+                onHeightChanged: {
+                    if (isLoaded)
+                        updateWindowSize()
+                }
+
                 menu: Menu {
                     id: contextMenu
                     MenuItem {
@@ -212,6 +230,14 @@ AnalyzePage {
                         }
                     }
 
+                    if (event.key == Qt.Key_PageUp) {
+                        scrollLines(-conController.windowSize)
+                        event.accepted = true
+                    } else if (event.key == Qt.Key_PageDown) {
+                        scrollLines(conController.windowSize)
+                        event.accepted = true
+                    }
+
                     if (event.key == Qt.Key_Left) {
                         // don't move beyond current command
                         if (textConsole.cursorPosition == _consoleOutputLen) {
@@ -257,8 +283,9 @@ AnalyzePage {
                         // increase scrolling speed (the default is a single line)
                         var numLines = 4
                         var flickable = textConsole.flickableItem
-                        var dy = wheel.angleDelta.y * numLines / 120 * textConsole.font.pixelSize
-                        flickable.contentY = Math.max(0, Math.min(flickable.contentHeight - flickable.height, flickable.contentY - dy))
+                        if (wheel.angleDelta.y != 0) {
+                            scrollLines(-Math.round(wheel.angleDelta.y * numLines / 120))
+                        }
                         if (wheel.angleDelta.x != 0) {
                             var dx = wheel.angleDelta.x * numLines / 120 * textConsole.font.pixelSize
                             flickable.contentX = Math.max(0, Math.min(flickable.contentWidth - flickable.width, flickable.contentX - dx))
@@ -268,6 +295,43 @@ AnalyzePage {
                 }
             }
 
+            RowLayout {
+                Layout.fillWidth:   true
+
+                QGCTextField {
+                    id:               searchField
+                    Layout.fillWidth: true
+                    placeholderText:  qsTr("Search output...")
+                    inputMethodHints: Qt.ImhNoAutoUppercase
+                    onAccepted:       searchOutput(false)
+                }
+
+                QGCButton {
+                    text:      qsTr("Previous")
+                    enabled:   searchField.text !== ""
+                    onClicked: searchOutput(false)
+                }
+
+                QGCButton {
+                    text:      qsTr("Next")
+                    enabled:   searchField.text !== ""
+                    onClicked: searchOutput(true)
+                }
+
+                QGCLabel {
+                    id: searchResult
+                }
+
+                QGCButton {
+                    text:      qsTr("Bottom")
+                    enabled:   !conController.followOutput
+                    onClicked: {
+                        searchResult.text = ""
+                        scrollToBottom()
+                    }
+                }
+            }
+
             RowLayout {
                 Layout.fillWidth:   true
                 visible:            _separateCommandInput
@@ -0,0 +1,164 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogAnalyzeRunner.h"
+#include "TlogAnalyzer.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QTimer>
+#include <QDebug>
+
+QGC_LOGGING_CATEGORY(TlogAnalyzeLog, "TlogAnalyzeLog")
+
+const char* TlogAnalyzeRunner::summaryFileName = "summary.csv";
+
+TlogAnalyzeRunner::TlogAnalyzeRunner(const QStringList& logFileNames, const QString& outputDir, int jobs, QObject* parent)
+    : QObject       (parent)
+    , _logFileNames (logFileNames)
+    , _outputDir    (QDir(outputDir).absolutePath())
+    , _jobs         (qMax(jobs, 1))
+{
+
+}
+
+QStringList TlogAnalyzeRunner::logFileNames(const QString& option)
+{
+    QStringList logFileNames;
+
+    for (const QString& name: option.split(QLatin1Char(','), QString::SkipEmptyParts)) {
+        QFileInfo fileInfo(name);
+        if (fileInfo.isDir()) {
+            QDir dir(fileInfo.absoluteFilePath());
+            for (const QFileInfo& logFileInfo: dir.entryInfoList(QStringList(QStringLiteral("*.tlog")), QDir::Files, QDir::Name)) {
+                logFileNames.append(logFileInfo.absoluteFilePath());
+            }
+        } else {
+            logFileNames.append(fileInfo.absoluteFilePath());
+        }
+    }
+
+    return logFileNames;
+}
+
+int TlogAnalyzeRunner::run(void)
+{
+    if (_logFileNames.isEmpty()) {
+        qWarning() << "No logs to analyze";
+        return 1;
+    }
+    if (!QDir().mkpath(_outputDir)) {
+        qWarning() << "Unable to create output directory" << _outputDir;
+        return 1;
+    }
+
+    qCDebug(TlogAnalyzeLog) << "Analyzing" << _logFileNames.count() << "logs, jobs" << _jobs << "output" << _outputDir;
+
+    QTimer::singleShot(0, this, &TlogAnalyzeRunner::_startNext);
+    _eventLoop.exec();
+
+    if (!_mergeSummaries()) {
+        return qMax(_failureCount, 1);
+    }
+    return _failureCount;
+}
+
+void TlogAnalyzeRunner::_startNext(void)
+{
+    while (_runningCount < _jobs && _nextLog < _logFileNames.count()) {
+        const QString logFileName = _logFileNames[_nextLog++];
+
+        QProcess* process = new QProcess(this);
+        process->setStandardOutputFile(QProcess::nullDevice());
+        process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, [this, process, logFileName](int exitCode, QProcess::ExitStatus exitStatus) {
+            _workerFinished(process, logFileName, exitCode, exitStatus);
+        });
+        connect(process, &QProcess::errorOccurred, this, [this, process, logFileName](QProcess::ProcessError error) {
+            // A worker which fails to start never finishes
+            if (error == QProcess::FailedToStart) {
+                _workerFinished(process, logFileName, -1, QProcess::CrashExit);
+            }
+        });
+
+        _runningCount++;
+        process->start(QCoreApplication::applicationFilePath(), QStringList({
+            QStringLiteral("--analyze-log:%1").arg(logFileName),
+            QStringLiteral("--analyze-output:%1").arg(_outputDir),
+        }));
+    }
+
+    if (_runningCount == 0) {
+        _eventLoop.quit();
+    }
+}
+
+void TlogAnalyzeRunner::_workerFinished(QProcess* process, const QString& logFileName, int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (exitStatus == QProcess::NormalExit && exitCode == 0) {
+        qCDebug(TlogAnalyzeLog) << "Analyzed" << logFileName;
+        _analyzedLogFileNames.append(logFileName);
+    } else {
+        qWarning() << "Analyzing failed" << logFileName << "exit code" << exitCode << process->errorString();
+        _failureCount++;
+    }
+
+    process->deleteLater();
+    _runningCount--;
+    _startNext();
+}
+
+bool TlogAnalyzeRunner::_mergeSummaries(void)
+{
+    const QString   fileName = QDir(_outputDir).filePath(summaryFileName);
+    QSaveFile       summaryFile(fileName);
+
+    if (!summaryFile.open(QFile::WriteOnly | QFile::Text)) {
+        qWarning() << "Unable to open" << fileName << summaryFile.errorString();
+        return false;
+    }
+
+    // All summaries have the same columns, so the rows simply follow a single header
+    summaryFile.write(TlogAnalyzer::summaryColumns().join(QLatin1Char(',')).toUtf8() + '\n');
+    for (const QString& logFileName: _analyzedLogFileNames) {
+        QFile logSummaryFile(TlogAnalyzer::outputFileName(_outputDir, logFileName, TlogAnalyzer::summarySuffix));
+        if (!logSummaryFile.open(QFile::ReadOnly | QFile::Text)) {
+            qWarning() << "Unable to open" << logSummaryFile.fileName() << logSummaryFile.errorString();
+            continue;
+        }
+        logSummaryFile.readLine();
+        summaryFile.write(logSummaryFile.readAll());
+    }
+
+    if (!summaryFile.commit()) {
+        qWarning() << "Unable to write" << fileName << summaryFile.errorString();
+        return false;
+    }
+
+    QTextStream(stdout) << tr("Analyzed %1 of %2 logs, summary %3").arg(_analyzedLogFileNames.count()).arg(_logFileNames.count()).arg(QDir::toNativeSeparators(fileName)) << QLatin1Char('\n');
+    return true;
+}
+
+int TlogAnalyzeRunner::runWorker(const QString& logFileName, const QString& outputDir)
+{
+    TlogAnalyzer analyzer(logFileName, outputDir);
+
+    QObject::connect(&analyzer, &TlogAnalyzer::finished, &analyzer, [&analyzer](bool success) {
+        if (!success) {
+            qWarning() << "Analyzing failed" << analyzer.errorString();
+        }
+        QCoreApplication::exit(success ? 0 : 1);
+    });
+    QTimer::singleShot(0, &analyzer, &TlogAnalyzer::start);
+
+    return QCoreApplication::exec();
+}
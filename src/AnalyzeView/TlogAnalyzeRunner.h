@@ -0,0 +1,64 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCLoggingCategory.h"
+
+#include <QEventLoop>
+#include <QObject>
+#include <QProcess>
+#include <QStringList>
+
+Q_DECLARE_LOGGING_CATEGORY(TlogAnalyzeLog)
+
+/// Headless command line mode which runs telemetry logs through TlogAnalyzer:
+///     --analyze:<log or directory>[,...]  Logs to analyze, directories are searched for *.tlog
+///     --analyze-output:<directory>        Where the csv files go, the current directory by default
+///     --analyze-jobs:<count>              Logs analyzed at once, the number of cores by default
+///
+/// Vehicles can only live on the main thread of an application with the full toolbox, so each log is analyzed by a
+/// worker process of its own (--analyze-log:<log>), started as many at a time as there are jobs. The runner itself
+/// only needs a QCoreApplication. Once all workers are done the summaries of all logs are merged into summary.csv.
+///
+/// Progress is logged to TlogAnalyzeLog and failures are warnings. The outcome is written to stdout.
+class TlogAnalyzeRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    TlogAnalyzeRunner(const QStringList& logFileNames, const QString& outputDir, int jobs, QObject* parent = nullptr);
+
+    /// Analyzes all logs
+    /// @return Process exit code: 0 all logs analyzed, otherwise the number of logs which failed
+    int run(void);
+
+    /// Analyzes a single log within a worker process, QGCApplication must be initialized
+    /// @return Process exit code
+    static int runWorker(const QString& logFileName, const QString& outputDir);
+
+    /// @return Logs of an --analyze option, with directories expanded
+    static QStringList logFileNames(const QString& option);
+
+    static const char* summaryFileName;
+
+private:
+    void _startNext         (void);
+    void _workerFinished    (QProcess* process, const QString& logFileName, int exitCode, QProcess::ExitStatus exitStatus);
+    bool _mergeSummaries    (void);
+
+    QStringList _logFileNames;
+    QStringList _analyzedLogFileNames;
+    QString     _outputDir;
+    int         _jobs;
+    int         _nextLog        = 0;
+    int         _runningCount   = 0;
+    int         _failureCount   = 0;
+    QEventLoop  _eventLoop;
+};
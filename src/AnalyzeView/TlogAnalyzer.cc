@@ -0,0 +1,445 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogAnalyzer.h"
+#include "QGCApplication.h"
+#include "LinkManager.h"
+#include "LogReplayLink.h"
+#include "MAVLinkFramer.h"
+#include "MAVLinkProtocol.h"
+#include "MultiVehicleManager.h"
+#include "TlogIndex.h"
+#include "Vehicle.h"
+#include "VehicleBatteryFactGroup.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QTimer>
+
+#include <cmath>
+
+QGC_LOGGING_CATEGORY(TlogAnalyzerLog, "TlogAnalyzerLog")
+
+const char* TlogAnalyzer::telemetrySuffix   = "telemetry";
+const char* TlogAnalyzer::eventsSuffix      = "events";
+const char* TlogAnalyzer::summarySuffix     = "summary";
+
+TlogAnalyzer::TlogAnalyzer(const QString& logFileName, const QString& outputDir, QObject* parent)
+    : QObject               (parent)
+    , _logFileName          (logFileName)
+    , _outputDir            (outputDir)
+    , _maxAltitudeRelative  (qQNaN())
+    , _maxGroundSpeed       (qQNaN())
+    , _batteryMinVoltage    (qQNaN())
+    , _batteryConsumedMah   (qQNaN())
+    , _batteryMinRemaining  (qQNaN())
+{
+
+}
+
+TlogAnalyzer::~TlogAnalyzer()
+{
+    if (_running) {
+        _finish(false);
+    }
+}
+
+QString TlogAnalyzer::outputFileName(const QString& outputDir, const QString& logFileName, const char* suffix)
+{
+    return QDir(outputDir).filePath(QStringLiteral("%1.%2.csv").arg(QFileInfo(logFileName).completeBaseName(), suffix));
+}
+
+QStringList TlogAnalyzer::summaryColumns(void)
+{
+    return QStringList({
+        QStringLiteral("log"),
+        QStringLiteral("duration_secs"),
+        QStringLiteral("records"),
+        QStringLiteral("vehicle_id"),
+        QStringLiteral("firmware_type"),
+        QStringLiteral("vehicle_type"),
+        QStringLiteral("flight_time_secs"),
+        QStringLiteral("distance_m"),
+        QStringLiteral("max_altitude_relative_m"),
+        QStringLiteral("max_ground_speed_mps"),
+        QStringLiteral("battery_min_voltage"),
+        QStringLiteral("battery_consumed_mah"),
+        QStringLiteral("battery_min_remaining_pct"),
+        QStringLiteral("arm_count"),
+        QStringLiteral("status_errors"),
+        QStringLiteral("status_warnings"),
+    });
+}
+
+QStringList TlogAnalyzer::summaryRow(void) const
+{
+    auto number = [](double value) {
+        return std::isnan(value) ? QString() : QString::number(value, 'f', 2);
+    };
+
+    return QStringList({
+        QFileInfo(_logFileName).fileName(),
+        QString::number((_logTimeUSecs - _startTimeUSecs) / 1.0e6, 'f', 3),
+        QString::number(_recordCount),
+        _vehicleId ? QString::number(_vehicleId) : QString(),
+        _firmwareType,
+        _vehicleType,
+        QString::number(_flightTimeUSecs / 1.0e6, 'f', 3),
+        number(_distanceMeters),
+        number(_maxAltitudeRelative),
+        number(_maxGroundSpeed),
+        number(_batteryMinVoltage),
+        number(_batteryConsumedMah),
+        number(_batteryMinRemaining),
+        QString::number(_armCount),
+        QString::number(_statusErrorCount),
+        QString::number(_statusWarningCount),
+    });
+}
+
+void TlogAnalyzer::start(void)
+{
+    QGCToolbox*     toolbox     = qgcApp()->toolbox();
+    LinkManager*    linkManager = toolbox->linkManager();
+
+    _mavlink = toolbox->mavlinkProtocol();
+
+    // The index gives us the start time, the link finds it cached when it loads the log
+    TlogIndex index;
+    if (!index.loadOrBuild(_logFileName, _errorString)) {
+        emit finished(false);
+        return;
+    }
+    _startTimeUSecs = _logTimeUSecs = _nextSnapshotUSecs = index.startTimeUSecs();
+
+    _logFile.setFileName(_logFileName);
+    if (!_logFile.open(QFile::ReadOnly)) {
+        _errorString = tr("Unable to open log file: '%1', error: %2").arg(_logFileName, _logFile.errorString());
+        emit finished(false);
+        return;
+    }
+
+    // The link is only there for the vehicle to belong to, the messages are fed to the protocol from here so
+    // processing runs as fast as the vehicle can keep up instead of at log speed
+    LogReplayLinkConfiguration* config = new LogReplayLinkConfiguration(tr("Analyze %1").arg(QFileInfo(_logFileName).fileName()));
+    config->setLogFilename(_logFileName);
+    config->setPlayOnConnect(false);
+    config->setDynamic(true);
+    SharedLinkConfigurationPtr sharedConfig = linkManager->addConfiguration(config);
+    if (!linkManager->createConnectedLink(sharedConfig)) {
+        _errorString = tr("Unable to create link for log file: '%1'").arg(_logFileName);
+        emit finished(false);
+        return;
+    }
+    _link       = sharedConfig->link();
+    _weakLink   = linkManager->sharedLinkInterfacePointerForLink(_link);
+
+    _mavlink->suspendLogForReplay(true);
+
+    connect(toolbox->multiVehicleManager(), &MultiVehicleManager::vehicleAdded,     this, &TlogAnalyzer::_vehicleAdded);
+    connect(toolbox->multiVehicleManager(), &MultiVehicleManager::vehicleRemoved,   this, &TlogAnalyzer::_vehicleRemoved);
+    _mavlink->messageDispatcher()->subscribe(MAVLINK_MSG_ID_STATUSTEXT, MAVLinkMessageDispatcher::AnySystem, MAVLinkMessageDispatcher::AnyComponent, this, &TlogAnalyzer::_handleStatusText);
+
+    qCDebug(TlogAnalyzerLog) << "Analyzing" << _logFileName << "records" << index.recordCount();
+
+    _running = true;
+    QTimer::singleShot(0, this, &TlogAnalyzer::_processSlice);
+}
+
+void TlogAnalyzer::_processSlice(void)
+{
+    if (!_running) {
+        return;
+    }
+
+    for (int i=0; i<_sliceRecords; i++) {
+        // Keep at least one whole record ahead, unless the end of the log was reached
+        if (_buffer.size() - _bufferPosition < TlogIndex::cbTimestamp + MAVLINK_MAX_PACKET_LEN && !_logFile.atEnd()) {
+            _buffer.remove(0, _bufferPosition);
+            _bufferPosition = 0;
+            _buffer.append(_logFile.read(_readChunkSize));
+        }
+
+        const int available = _buffer.size() - _bufferPosition;
+        if (available <= TlogIndex::cbTimestamp) {
+            _finish(true);
+            return;
+        }
+
+        const char* record = _buffer.constData() + _bufferPosition;
+        const int   length = MAVLinkFramer::packetLength(reinterpret_cast<const uint8_t*>(record + TlogIndex::cbTimestamp), available - TlogIndex::cbTimestamp);
+        if (length == 0) {
+            // Partial record at the end of the log
+            _finish(true);
+            return;
+        } else if (length < 0) {
+            // Corrupt data, resync on the next byte
+            _bufferPosition++;
+            continue;
+        }
+
+        _logTimeUSecs = TlogIndex::parseTimestamp(record);
+        _recordCount++;
+        _mavlink->receiveBytes(_link, QByteArray(record + TlogIndex::cbTimestamp, length));
+        _bufferPosition += TlogIndex::cbTimestamp + length;
+
+        if (_weakLink.expired()) {
+            _errorString = tr("Link closed while analyzing log file: '%1'").arg(_logFileName);
+            _finish(false);
+            return;
+        }
+
+        if (_vehicle && _logTimeUSecs >= _nextSnapshotUSecs) {
+            _snapshot();
+            _nextSnapshotUSecs = _logTimeUSecs + snapshotIntervalUSecs;
+        }
+    }
+
+    // Let the timers and queued signals of the vehicle run before the next slice
+    QTimer::singleShot(0, this, &TlogAnalyzer::_processSlice);
+}
+
+QString TlogAnalyzer::_logTimeSecs(void) const
+{
+    return QString::number((_logTimeUSecs - _startTimeUSecs) / 1.0e6, 'f', 3);
+}
+
+void TlogAnalyzer::_vehicleAdded(Vehicle* vehicle)
+{
+    if (_vehicle || !vehicle->vehicleLinkManager()->containsLink(_link)) {
+        return;
+    }
+
+    _vehicle        = vehicle;
+    _vehicleId      = vehicle->id();
+    _firmwareType   = QGCMAVLink::firmwareClassToString(QGCMAVLink::firmwareClass(vehicle->firmwareType()));
+    _vehicleType    = vehicle->vehicleTypeName();
+    _addEvent(QStringLiteral("vehicle"), QString(), QString::number(_vehicleId));
+
+    connect(vehicle, &Vehicle::armedChanged,        this, &TlogAnalyzer::_armedChanged);
+    connect(vehicle, &Vehicle::flightModeChanged,   this, &TlogAnalyzer::_flightModeChanged);
+    connect(vehicle, &Vehicle::coordinateChanged,   this, &TlogAnalyzer::_coordinateChanged);
+}
+
+void TlogAnalyzer::_vehicleRemoved(Vehicle* vehicle)
+{
+    if (vehicle == _vehicle) {
+        _snapshot();
+        _vehicle = nullptr;
+    }
+}
+
+void TlogAnalyzer::_armedChanged(bool armed)
+{
+    if (armed == _armed) {
+        return;
+    }
+    _armed = armed;
+
+    if (armed) {
+        _armCount++;
+        _armedTimeUSecs         = _logTimeUSecs;
+        _lastArmedCoordinate    = _vehicle->coordinate();
+    } else {
+        _flightTimeUSecs += _logTimeUSecs - _armedTimeUSecs;
+    }
+    _addEvent(armed ? QStringLiteral("armed") : QStringLiteral("disarmed"), QString(), QString());
+}
+
+void TlogAnalyzer::_flightModeChanged(const QString& flightMode)
+{
+    _addEvent(QStringLiteral("flight_mode"), QString(), flightMode);
+}
+
+void TlogAnalyzer::_coordinateChanged(QGeoCoordinate coordinate)
+{
+    if (!_armed || !coordinate.isValid()) {
+        return;
+    }
+    if (_lastArmedCoordinate.isValid()) {
+        _distanceMeters += _lastArmedCoordinate.distanceTo(coordinate);
+    }
+    _lastArmedCoordinate = coordinate;
+}
+
+void TlogAnalyzer::_handleStatusText(LinkInterface* link, const mavlink_message_t& message)
+{
+    if (link != _link || !_vehicle || message.sysid != _vehicleId) {
+        return;
+    }
+
+    mavlink_statustext_t statustext;
+    mavlink_msg_statustext_decode(&message, &statustext);
+
+    QString text = QString::fromLatin1(statustext.text, static_cast<int>(qstrnlen(statustext.text, sizeof(statustext.text))));
+    if (statustext.severity <= MAV_SEVERITY_ERROR) {
+        _statusErrorCount++;
+    } else if (statustext.severity == MAV_SEVERITY_WARNING) {
+        _statusWarningCount++;
+    }
+    _addEvent(QStringLiteral("status_text"), QString::number(statustext.severity), text);
+}
+
+void TlogAnalyzer::_addEvent(const QString& type, const QString& severity, const QString& value)
+{
+    _eventRows.append(QStringList({ _logTimeSecs(), type, severity, value }));
+}
+
+void TlogAnalyzer::_snapshot(void)
+{
+    if (!_vehicle) {
+        return;
+    }
+
+    QStringList row(_logTimeSecs());
+    _snapshotFactGroup(row, QString(), _vehicle);
+    _telemetryRows.append(row);
+
+    _updateMax(_maxAltitudeRelative,    _vehicle->altitudeRelative()->rawValue().toDouble());
+    _updateMax(_maxGroundSpeed,         _vehicle->groundSpeed()->rawValue().toDouble());
+
+    // Battery statistics are for the first battery
+    QmlObjectListModel* batteries = _vehicle->batteries();
+    VehicleBatteryFactGroup* battery = batteries->count() ? qobject_cast<VehicleBatteryFactGroup*>(batteries->get(0)) : nullptr;
+    if (battery) {
+        double voltage = battery->voltage()->rawValue().toDouble();
+        if (voltage > 0) {
+            _updateMin(_batteryMinVoltage, voltage);
+        }
+        _updateMax(_batteryConsumedMah,     battery->mahConsumed()->rawValue().toDouble());
+        _updateMin(_batteryMinRemaining,    battery->percentRemaining()->rawValue().toDouble());
+    }
+}
+
+void TlogAnalyzer::_snapshotFactGroup(QStringList& row, const QString& prefix, FactGroup* factGroup)
+{
+    for (const QString& factName: factGroup->factNames()) {
+        const QString column = prefix + factName;
+        int columnIndex = _telemetryColumnIndices.value(column, -1);
+        if (columnIndex == -1) {
+            // Fact groups such as additional batteries show up part way through, so columns are added as they are found
+            columnIndex = _telemetryColumns.count() + 1;
+            _telemetryColumns.append(column);
+            _telemetryColumnIndices[column] = columnIndex;
+        }
+        while (row.count() <= columnIndex) {
+            row.append(QString());
+        }
+        row[columnIndex] = factGroup->getFact(factName)->rawValue().toString();
+    }
+
+    for (const QString& factGroupName: factGroup->factGroupNames()) {
+        _snapshotFactGroup(row, prefix + factGroupName + QStringLiteral("."), factGroup->getFactGroup(factGroupName));
+    }
+}
+
+void TlogAnalyzer::_updateMin(double& min, double value)
+{
+    if (!std::isnan(value) && (std::isnan(min) || value < min)) {
+        min = value;
+    }
+}
+
+void TlogAnalyzer::_updateMax(double& max, double value)
+{
+    if (!std::isnan(value) && (std::isnan(max) || value > max)) {
+        max = value;
+    }
+}
+
+void TlogAnalyzer::_finish(bool success)
+{
+    _running = false;
+
+    if (_armed) {
+        // Still armed at the end of the log, count the flight up to here
+        _flightTimeUSecs += _logTimeUSecs - _armedTimeUSecs;
+        _armed = false;
+    }
+    _snapshot();
+
+    _mavlink->messageDispatcher()->unsubscribeAll(this);
+    disconnect(qgcApp()->toolbox()->multiVehicleManager(), nullptr, this, nullptr);
+    if (_vehicle) {
+        disconnect(_vehicle, nullptr, this, nullptr);
+        _vehicle = nullptr;
+    }
+
+    SharedLinkInterfacePtr sharedLink = _weakLink.lock();
+    if (sharedLink) {
+        sharedLink->disconnect();
+    }
+    _mavlink->suspendLogForReplay(false);
+    _logFile.close();
+
+    if (success) {
+        success = _writeOutput();
+    }
+
+    qCDebug(TlogAnalyzerLog) << "Analyzed" << _logFileName << "records" << _recordCount << "success" << success << _errorString;
+    emit finished(success);
+}
+
+bool TlogAnalyzer::_writeOutput(void)
+{
+    if (!QDir().mkpath(_outputDir)) {
+        _errorString = tr("Unable to create output directory: '%1'").arg(_outputDir);
+        return false;
+    }
+
+    return _writeCsv(outputFileName(_outputDir, _logFileName, telemetrySuffix), QStringList(QStringLiteral("time_secs")) + _telemetryColumns, _telemetryRows, _errorString) &&
+            _writeCsv(outputFileName(_outputDir, _logFileName, eventsSuffix), QStringList({ QStringLiteral("time_secs"), QStringLiteral("type"), QStringLiteral("severity"), QStringLiteral("value") }), _eventRows, _errorString) &&
+            _writeCsv(outputFileName(_outputDir, _logFileName, summarySuffix), summaryColumns(), QList<QStringList>({ summaryRow() }), _errorString);
+}
+
+QString TlogAnalyzer::_csvField(const QString& value)
+{
+    if (value.contains(QLatin1Char(',')) || value.contains(QLatin1Char('"')) || value.contains(QLatin1Char('\n'))) {
+        QString quoted = value;
+        return QStringLiteral("\"%1\"").arg(quoted.replace(QStringLiteral("\""), QStringLiteral("\"\"")));
+    }
+    return value;
+}
+
+bool TlogAnalyzer::_writeCsv(const QString& fileName, const QStringList& columns, const QList<QStringList>& rows, QString& errorString)
+{
+    QSaveFile file(fileName);
+    if (!file.open(QFile::WriteOnly | QFile::Text)) {
+        errorString = tr("Unable to open output file: '%1', error: %2").arg(fileName, file.errorString());
+        return false;
+    }
+
+    QTextStream stream(&file);
+    auto writeRow = [&stream, &columns](const QStringList& row) {
+        // Rows from before a column was added are shorter, the missing values are empty
+        for (int i=0; i<columns.count(); i++) {
+            if (i) {
+                stream << ',';
+            }
+            if (i < row.count()) {
+                stream << _csvField(row[i]);
+            }
+        }
+        stream << '\n';
+    };
+
+    writeRow(columns);
+    for (const QStringList& row: rows) {
+        writeRow(row);
+    }
+    stream.flush();
+
+    if (!file.commit()) {
+        errorString = tr("Unable to write output file: '%1', error: %2").arg(fileName, file.errorString());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,131 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCLoggingCategory.h"
+#include "QGCMAVLink.h"
+#include "LinkInterface.h"
+
+#include <QFile>
+#include <QGeoCoordinate>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+
+Q_DECLARE_LOGGING_CATEGORY(TlogAnalyzerLog)
+
+class FactGroup;
+class MAVLinkProtocol;
+class Vehicle;
+
+/// Pushes a telemetry log through MAVLinkProtocol and Vehicle as fast as they can process it and writes the derived
+/// telemetry as csv files to the output directory:
+///     <log>.telemetry.csv     Values of the vehicle and all its fact groups, one row each snapshotIntervalUSecs
+///     <log>.events.csv        Arming, flight mode changes and status texts
+///     <log>.summary.csv       A single row of summaryColumns
+///
+/// All times are log times. Only the first vehicle in the log is analyzed. Needs the toolbox, but not the UI, see
+/// TlogAnalyzeRunner for the command line mode which runs it.
+class TlogAnalyzer : public QObject
+{
+    Q_OBJECT
+
+public:
+    TlogAnalyzer(const QString& logFileName, const QString& outputDir, QObject* parent = nullptr);
+    ~TlogAnalyzer();
+
+    /// Starts processing the log, finished is signalled once done
+    void start(void);
+
+    QString errorString(void) const { return _errorString; }
+
+    /// @return Values of summaryColumns for the log
+    QStringList summaryRow(void) const;
+
+    /// @return Columns of the summary, the same for all logs so summaries can be concatenated
+    static QStringList summaryColumns(void);
+
+    /// @return File name of an output file of the log
+    static QString outputFileName(const QString& outputDir, const QString& logFileName, const char* suffix);
+
+    static const char*      telemetrySuffix;
+    static const char*      eventsSuffix;
+    static const char*      summarySuffix;
+    static const quint64    snapshotIntervalUSecs = 1000000;
+
+signals:
+    void finished(bool success);
+
+private slots:
+    void _processSlice      (void);
+    void _vehicleAdded      (Vehicle* vehicle);
+    void _vehicleRemoved    (Vehicle* vehicle);
+    void _armedChanged      (bool armed);
+    void _flightModeChanged (const QString& flightMode);
+    void _coordinateChanged (QGeoCoordinate coordinate);
+
+private:
+    void    _handleStatusText   (LinkInterface* link, const mavlink_message_t& message);
+    void    _snapshot           (void);
+    void    _snapshotFactGroup  (QStringList& row, const QString& prefix, FactGroup* factGroup);
+    void    _addEvent           (const QString& type, const QString& severity, const QString& value);
+    void    _finish             (bool success);
+    bool    _writeOutput        (void);
+    QString _logTimeSecs        (void) const;
+
+    static bool     _writeCsv   (const QString& fileName, const QStringList& columns, const QList<QStringList>& rows, QString& errorString);
+    static QString  _csvField   (const QString& value);
+    static void     _updateMin  (double& min, double value);
+    static void     _updateMax  (double& max, double value);
+
+    QString                 _logFileName;
+    QString                 _outputDir;
+    QString                 _errorString;
+    QFile                   _logFile;
+    QByteArray              _buffer;
+    int                     _bufferPosition     = 0;
+    MAVLinkProtocol*        _mavlink            = nullptr;
+    LinkInterface*          _link               = nullptr;
+    WeakLinkInterfacePtr    _weakLink;
+    Vehicle*                _vehicle            = nullptr;
+    bool                    _running            = false;
+
+    quint64                 _startTimeUSecs     = 0;
+    quint64                 _logTimeUSecs       = 0;
+    quint64                 _nextSnapshotUSecs  = 0;
+    quint64                 _recordCount        = 0;
+
+    QStringList             _telemetryColumns;
+    QHash<QString, int>     _telemetryColumnIndices;
+    QList<QStringList>      _telemetryRows;
+    QList<QStringList>      _eventRows;
+
+    // Summary
+    int                     _vehicleId              = 0;
+    QString                 _firmwareType;
+    QString                 _vehicleType;
+    bool                    _armed                  = false;
+    quint64                 _armedTimeUSecs         = 0;
+    quint64                 _flightTimeUSecs        = 0;
+    double                  _distanceMeters         = 0;
+    QGeoCoordinate          _lastArmedCoordinate;
+    int                     _armCount               = 0;
+    int                     _statusErrorCount       = 0;
+    int                     _statusWarningCount     = 0;
+    double                  _maxAltitudeRelative;
+    double                  _maxGroundSpeed;
+    double                  _batteryMinVoltage;
+    double                  _batteryConsumedMah;
+    double                  _batteryMinRemaining;
+
+    static const int _sliceRecords  = 5000;         ///< Records processed before the event loop gets to run
+    static const int _readChunkSize = 1024 * 1024;
+};
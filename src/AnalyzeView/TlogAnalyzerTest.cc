@@ -0,0 +1,124 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogAnalyzerTest.h"
+#include "TlogAnalyzer.h"
+#include "TlogIndex.h"
+#include "QGCApplication.h"
+#include "MultiVehicleManager.h"
+
+#include <QtEndian>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+static const quint64 _startTimeUSecs = Q_UINT64_C(1600000000000000);
+
+QByteArray TlogAnalyzerTest::_record(quint64 timeUSecs, mavlink_message_t& message)
+{
+    uint8_t buffer[TlogIndex::cbTimestamp + MAVLINK_MAX_PACKET_LEN];
+
+    qToBigEndian<quint64>(timeUSecs, buffer);
+    int length = mavlink_msg_to_send_buffer(&buffer[TlogIndex::cbTimestamp], &message);
+
+    return QByteArray(reinterpret_cast<const char*>(buffer), TlogIndex::cbTimestamp + length);
+}
+
+QStringList TlogAnalyzerTest::_readLines(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QFile::ReadOnly | QFile::Text)) {
+        return QStringList();
+    }
+    return QString::fromUtf8(file.readAll()).split('\n', QString::SkipEmptyParts);
+}
+
+void TlogAnalyzerTest::_analyzeTest(void)
+{
+    QTemporaryDir   tempDir;
+    QString         logFileName = tempDir.filePath(QStringLiteral("flight.tlog"));
+    QString         outputDir   = tempDir.filePath(QStringLiteral("output"));
+    QByteArray      bytes;
+
+    // Ten seconds at 10Hz, armed from 2 to 7 seconds while moving north, a warning along the way
+    mavlink_reset_channel_status(_channel);
+    for (int i=0; i<100; i++) {
+        const quint64       timeUSecs = _startTimeUSecs + (i * 100000);
+        mavlink_message_t   message;
+
+        if (i % 10 == 0) {
+            const uint8_t baseMode = MAV_MODE_FLAG_CUSTOM_MODE_ENABLED | (i >= 20 && i < 70 ? MAV_MODE_FLAG_SAFETY_ARMED : 0);
+            mavlink_msg_heartbeat_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _channel, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, baseMode, 0, MAV_STATE_ACTIVE);
+            bytes.append(_record(timeUSecs, message));
+        }
+        if (i == 50) {
+            mavlink_msg_statustext_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _channel, &message, MAV_SEVERITY_WARNING, "Low battery", 0, 0);
+            bytes.append(_record(timeUSecs, message));
+        }
+        mavlink_msg_global_position_int_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _channel, &message,
+                                                  static_cast<uint32_t>(i * 100),                   // time_boot_ms
+                                                  470000000 + (i * 100),                            // lat, ~1.1m a step
+                                                  80000000,                                         // lon
+                                                  500000,                                           // alt
+                                                  10000,                                            // relative_alt
+                                                  0, 0, 0, UINT16_MAX);
+        bytes.append(_record(timeUSecs, message));
+    }
+    QFile logFile(logFileName);
+    QVERIFY(logFile.open(QFile::WriteOnly));
+    QCOMPARE(logFile.write(bytes), static_cast<qint64>(bytes.size()));
+    logFile.close();
+
+    TlogAnalyzer    analyzer(logFileName, outputDir);
+    QSignalSpy      spyFinished(&analyzer, &TlogAnalyzer::finished);
+    analyzer.start();
+    QVERIFY(spyFinished.count() || spyFinished.wait(10000));
+    QCOMPARE(spyFinished[0][0].toBool(), true);
+
+    const QStringList columns   = TlogAnalyzer::summaryColumns();
+    const QStringList summary   = analyzer.summaryRow();
+    QCOMPARE(summary.count(), columns.count());
+    QCOMPARE(summary[columns.indexOf("records")],           QStringLiteral("111"));
+    QCOMPARE(summary[columns.indexOf("vehicle_id")],        QStringLiteral("1"));
+    QCOMPARE(summary[columns.indexOf("flight_time_secs")],  QStringLiteral("5.000"));
+    QCOMPARE(summary[columns.indexOf("arm_count")],         QStringLiteral("1"));
+    QCOMPARE(summary[columns.indexOf("status_warnings")],   QStringLiteral("1"));
+    QCOMPARE(summary[columns.indexOf("max_altitude_relative_m")], QStringLiteral("10.00"));
+    const double distance = summary[columns.indexOf("distance_m")].toDouble();
+    QVERIFY(distance > 50 && distance < 60);
+
+    // One telemetry row each second of the log, plus the header and the final row
+    QStringList telemetry = _readLines(TlogAnalyzer::outputFileName(outputDir, logFileName, TlogAnalyzer::telemetrySuffix));
+    QVERIFY(telemetry.count() >= 11);
+    QVERIFY(telemetry[0].startsWith(QStringLiteral("time_secs,")));
+    QVERIFY(telemetry[0].split(',').contains(QStringLiteral("altitudeRelative")));
+
+    QStringList events = _readLines(TlogAnalyzer::outputFileName(outputDir, logFileName, TlogAnalyzer::eventsSuffix));
+    QVERIFY(events.contains(QStringLiteral("2.000,armed,,")));
+    QVERIFY(events.contains(QStringLiteral("7.000,disarmed,,")));
+    QVERIFY(events.contains(QStringLiteral("5.000,status_text,4,Low battery")));
+
+    QStringList summaryLines = _readLines(TlogAnalyzer::outputFileName(outputDir, logFileName, TlogAnalyzer::summarySuffix));
+    QCOMPARE(summaryLines.count(), 2);
+    QCOMPARE(summaryLines[0], columns.join(','));
+
+    // The vehicle goes away with the link
+    QTRY_VERIFY_WITH_TIMEOUT(!qgcApp()->toolbox()->multiVehicleManager()->activeVehicle(), 10000);
+}
+
+void TlogAnalyzerTest::_badFileTest(void)
+{
+    QTemporaryDir   tempDir;
+    TlogAnalyzer    analyzer(tempDir.filePath(QStringLiteral("missing.tlog")), tempDir.path());
+    QSignalSpy      spyFinished(&analyzer, &TlogAnalyzer::finished);
+
+    analyzer.start();
+    QCOMPARE(spyFinished.count(), 1);
+    QCOMPARE(spyFinished[0][0].toBool(), false);
+    QVERIFY(!analyzer.errorString().isEmpty());
+}
@@ -0,0 +1,28 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "QGCMAVLink.h"
+
+class TlogAnalyzerTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _analyzeTest   (void);
+    void _badFileTest   (void);
+
+private:
+    QByteArray  _record     (quint64 timeUSecs, mavlink_message_t& message);
+    QStringList _readLines  (const QString& fileName);
+
+    static const uint8_t _channel = 0;
+};
@@ -0,0 +1,459 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ULogReader.h"
+
+#include <QtNumeric>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+QGC_LOGGING_CATEGORY(ULogReaderLog, "ULogReaderLog")
+
+static const char   _ulogMagic[]        = { 'U', 'L', 'o', 'g', 0x01, 0x12, 0x35 };
+static const int    _maxNestingDepth    = 16;
+
+template <typename T>
+static T _read(const uchar* data)
+{
+    T value;
+    memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+/// @return false: unknown type
+static bool _fieldType(const QString& typeName, ULogReader::FieldType_t& type, int& typeSize)
+{
+    static const struct {
+        const char*             name;
+        ULogReader::FieldType_t type;
+        int                     size;
+    } rgTypes[] = {
+        { "int8_t",     ULogReader::FieldTypeInt8,      1 },
+        { "uint8_t",    ULogReader::FieldTypeUInt8,     1 },
+        { "int16_t",    ULogReader::FieldTypeInt16,     2 },
+        { "uint16_t",   ULogReader::FieldTypeUInt16,    2 },
+        { "int32_t",    ULogReader::FieldTypeInt32,     4 },
+        { "uint32_t",   ULogReader::FieldTypeUInt32,    4 },
+        { "int64_t",    ULogReader::FieldTypeInt64,     8 },
+        { "uint64_t",   ULogReader::FieldTypeUInt64,    8 },
+        { "float",      ULogReader::FieldTypeFloat,     4 },
+        { "double",     ULogReader::FieldTypeDouble,    8 },
+        { "char",       ULogReader::FieldTypeChar,      1 },
+        { "bool",       ULogReader::FieldTypeBool,      1 },
+    };
+
+    for (size_t i = 0; i < sizeof(rgTypes) / sizeof(rgTypes[0]); i++) {
+        if (typeName == QLatin1String(rgTypes[i].name)) {
+            type     = rgTypes[i].type;
+            typeSize = rgTypes[i].size;
+            return true;
+        }
+    }
+    return false;
+}
+
+ULogReader::ULogReader(void)
+{
+
+}
+
+ULogReader::~ULogReader()
+{
+    close();
+}
+
+bool ULogReader::open(const QString& fileName, QString& errorString)
+{
+    close();
+    errorString.clear();
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        errorString = tr("Unable to open log file: %1").arg(_file.errorString());
+        return false;
+    }
+
+    _size = _file.size();
+    if (_size < fileHeaderSize) {
+        errorString = tr("Could not detect ULog file header magic");
+        close();
+        return false;
+    }
+
+    _data = _file.map(0, _size);
+    if (!_data) {
+        errorString = tr("Unable to map log file: %1").arg(_file.errorString());
+        close();
+        return false;
+    }
+
+    if (memcmp(_data, _ulogMagic, sizeof(_ulogMagic)) != 0) {
+        errorString = tr("Could not detect ULog file header magic");
+        close();
+        return false;
+    }
+    _startUSecs = _read<quint64>(_data + 8);
+
+    if (!_index(errorString)) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void ULogReader::close(void)
+{
+    if (_data) {
+        _file.unmap(_data);
+        _data = nullptr;
+    }
+    _file.close();
+    _size       = 0;
+    _startUSecs = 0;
+    _formats.clear();
+    _formatIndices.clear();
+    _topics.clear();
+    _msgIdTopics.clear();
+    _logMessages.clear();
+}
+
+bool ULogReader::_index(QString& errorString)
+{
+    qint64 offset = fileHeaderSize;
+
+    while (offset + messageHeaderSize <= _size) {
+        const uchar*    header  = _data + offset;
+        int             msgSize = _read<quint16>(header);
+        uchar           msgType = header[2];
+        const uchar*    payload = header + messageHeaderSize;
+
+        if (offset + messageHeaderSize + msgSize > _size) {
+            // Logs of a vehicle which lost power end with a partial message
+            qCDebug(ULogReaderLog) << "Truncated message at" << offset;
+            break;
+        }
+
+        switch (msgType) {
+        case MessageTypeFormat:
+            _addFormat(reinterpret_cast<const char*>(payload), msgSize);
+            break;
+        case MessageTypeAddLogged:
+            _addSubscription(payload, msgSize);
+            break;
+        case MessageTypeRemoveLogged:
+            if (msgSize >= 2) {
+                _msgIdTopics.remove(_read<quint16>(payload));
+            }
+            break;
+        case MessageTypeData:
+            if (msgSize >= 2) {
+                int topicIndex = _msgIdTopics.value(_read<quint16>(payload), -1);
+                if (topicIndex != -1) {
+                    // Every sample starts with its uint64 timestamp
+                    int sampleSize = qMax(_formats[_topics[topicIndex].formatIndex].size, 8);
+                    if (msgSize - 2 < sampleSize) {
+                        qCDebug(ULogReaderLog) << "Short data message at" << offset;
+                    } else {
+                        _addSample(topicIndex, offset + messageHeaderSize + 2);
+                    }
+                }
+            }
+            break;
+        case MessageTypeLogging:
+        case MessageTypeLoggingTagged:
+            _addLogMessage(payload, msgSize, msgType == MessageTypeLoggingTagged);
+            break;
+        default:
+            break;
+        }
+
+        offset += messageHeaderSize + msgSize;
+    }
+
+    if (_formats.isEmpty()) {
+        errorString = tr("No message formats found in ULog");
+        return false;
+    }
+
+    qCDebug(ULogReaderLog) << "Indexed" << _formats.count() << "formats" << _topics.count() << "topics";
+    return true;
+}
+
+void ULogReader::_addLogMessage(const uchar* data, int size, bool tagged)
+{
+    // log_level, [tag,] timestamp, message
+    const int headerSize = 1 + (tagged ? 2 : 0) + 8;
+    if (size < headerSize) {
+        return;
+    }
+
+    LogMessage_t message;
+    message.level           = qBound(0, data[0] - '0', 7);
+    message.timestampUSecs  = _read<quint64>(data + headerSize - 8);
+    message.text            = QString::fromUtf8(reinterpret_cast<const char*>(data + headerSize), size - headerSize);
+    _logMessages.append(message);
+}
+
+void ULogReader::_addFormat(const char* data, int size)
+{
+    QString formatString    = QString::fromLatin1(data, size);
+    int     separator       = formatString.indexOf(':');
+
+    if (separator <= 0) {
+        qCWarning(ULogReaderLog) << "Bad format" << formatString;
+        return;
+    }
+
+    Format_t format;
+    format.name = formatString.left(separator);
+    format.size = -1;
+
+    const QStringList fieldStrings = formatString.mid(separator + 1).split(';', QString::SkipEmptyParts);
+    for (const QString& fieldString: fieldStrings) {
+        int space = fieldString.indexOf(' ');
+        if (space <= 0) {
+            continue;
+        }
+
+        Field_t field;
+        QString typeNameFull = fieldString.left(space);
+        field.name      = fieldString.mid(space + 1);
+        field.offset    = -1;
+        field.typeSize  = -1;
+        field.arraySize = 1;
+
+        int arrayStart  = typeNameFull.indexOf('[');
+        int arrayEnd    = typeNameFull.indexOf(']');
+        if (arrayStart != -1 && arrayEnd > arrayStart) {
+            field.arraySize = typeNameFull.midRef(arrayStart + 1, arrayEnd - arrayStart - 1).toInt();
+            typeNameFull    = typeNameFull.left(arrayStart);
+        }
+        field.typeName = typeNameFull;
+
+        if (!_fieldType(field.typeName, field.type, field.typeSize)) {
+            // Size comes from the nested format, see _resolveFormat
+            field.type = FieldTypeNested;
+        }
+        format.fields.append(field);
+    }
+
+    if (_formatIndices.contains(format.name)) {
+        _formats[_formatIndices[format.name]] = format;
+    } else {
+        _formatIndices[format.name] = _formats.count();
+        _formats.append(format);
+    }
+}
+
+bool ULogReader::_resolveFormat(int formatIndex, int depth)
+{
+    if (_formats[formatIndex].size >= 0) {
+        return true;
+    }
+    if (depth > _maxNestingDepth) {
+        qCWarning(ULogReaderLog) << "Formats nested too deep" << _formats[formatIndex].name;
+        return false;
+    }
+
+    int offset = 0;
+    for (int i = 0; i < _formats[formatIndex].fields.count(); i++) {
+        const Field_t& field = _formats[formatIndex].fields[i];
+
+        int typeSize = field.typeSize;
+        if (field.type == FieldTypeNested) {
+            int nestedIndex = _formatIndices.value(field.typeName, -1);
+            if (nestedIndex == -1 || nestedIndex == formatIndex || !_resolveFormat(nestedIndex, depth + 1)) {
+                qCWarning(ULogReaderLog) << "Unknown type" << field.typeName << "in format" << _formats[formatIndex].name;
+                return false;
+            }
+            typeSize = _formats[nestedIndex].size;
+        }
+
+        Field_t& resolvedField  = _formats[formatIndex].fields[i];
+        resolvedField.typeSize  = typeSize;
+        resolvedField.offset    = offset;
+        offset += typeSize * resolvedField.arraySize;
+    }
+    _formats[formatIndex].size = offset;
+
+    return true;
+}
+
+void ULogReader::_addSubscription(const uchar* data, int size)
+{
+    if (size < 4) {
+        return;
+    }
+
+    int     multiId     = data[0];
+    int     msgId       = _read<quint16>(data + 1);
+    QString name        = QString::fromLatin1(reinterpret_cast<const char*>(data + 3), size - 3);
+    int     formatIndex = _formatIndices.value(name, -1);
+
+    if (formatIndex == -1 || !_resolveFormat(formatIndex)) {
+        qCWarning(ULogReaderLog) << "Subscription without format" << name;
+        return;
+    }
+
+    int topicIndex = -1;
+    for (int i = 0; i < _topics.count(); i++) {
+        if (_topics[i].name == name && _topics[i].multiId == multiId) {
+            topicIndex = i;
+            break;
+        }
+    }
+    if (topicIndex == -1) {
+        Topic_t topic;
+        topic.name          = name;
+        topic.multiId       = multiId;
+        topic.formatIndex   = formatIndex;
+        topicIndex = _topics.count();
+        _topics.append(topic);
+    }
+
+    _msgIdTopics[msgId] = topicIndex;
+}
+
+void ULogReader::_addSample(int topicIndex, qint64 offset)
+{
+    Topic_t& topic = _topics[topicIndex];
+
+    if (topic.chunkBases.isEmpty() || offset - topic.chunkBases.last() > std::numeric_limits<quint32>::max()) {
+        topic.chunkBases.append(offset);
+        topic.chunkFirsts.append(topic.offsetDeltas.count());
+    }
+    topic.offsetDeltas.append(static_cast<quint32>(offset - topic.chunkBases.last()));
+}
+
+qint64 ULogReader::_sampleOffset(const Topic_t* topic, int index) const
+{
+    // Last chunk starting at or before index
+    auto chunk = std::upper_bound(topic->chunkFirsts.constBegin(), topic->chunkFirsts.constEnd(), index) - 1;
+    return topic->chunkBases[static_cast<int>(chunk - topic->chunkFirsts.constBegin())] + topic->offsetDeltas[index];
+}
+
+QStringList ULogReader::topicNames(void) const
+{
+    QStringList names;
+    for (const Topic_t& topic: _topics) {
+        if (!names.contains(topic.name)) {
+            names.append(topic.name);
+        }
+    }
+    return names;
+}
+
+const ULogReader::Format_t* ULogReader::format(const QString& name) const
+{
+    int index = _formatIndices.value(name, -1);
+    return index == -1 ? nullptr : &_formats[index];
+}
+
+const ULogReader::Field_t* ULogReader::field(const QString& formatName, const QString& fieldName) const
+{
+    const Format_t* fieldFormat = format(formatName);
+    if (fieldFormat && fieldFormat->size >= 0) {
+        for (const Field_t& formatField: fieldFormat->fields) {
+            if (formatField.name == fieldName) {
+                return &formatField;
+            }
+        }
+    }
+    return nullptr;
+}
+
+const ULogReader::Topic_t* ULogReader::topic(const QString& name, int multiId) const
+{
+    for (const Topic_t& topic: _topics) {
+        if (topic.name == name && topic.multiId == multiId) {
+            return &topic;
+        }
+    }
+    return nullptr;
+}
+
+QList<const ULogReader::Topic_t*> ULogReader::topics(const QString& name) const
+{
+    QList<const Topic_t*> list;
+    for (const Topic_t& topic: _topics) {
+        if (topic.name == name) {
+            list.append(&topic);
+        }
+    }
+    return list;
+}
+
+const uchar* ULogReader::sample(const Topic_t* topic, int index) const
+{
+    return _data + _sampleOffset(topic, index);
+}
+
+quint64 ULogReader::sampleTimestamp(const Topic_t* topic, int index) const
+{
+    return _read<quint64>(sample(topic, index));
+}
+
+void ULogReader::sampleRange(const Topic_t* topic, quint64 startUSecs, quint64 endUSecs, int& first, int& last) const
+{
+    // Timestamps of a topic only go up, so both ends are a binary search
+    auto lowerBound = [this, topic](quint64 usecs) {
+        int low     = 0;
+        int high    = sampleCount(topic);
+        while (low < high) {
+            int middle = low + (high - low) / 2;
+            if (sampleTimestamp(topic, middle) < usecs) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return low;
+    };
+
+    first   = lowerBound(startUSecs);
+    last    = endUSecs > startUSecs ? lowerBound(endUSecs) : first;
+}
+
+double ULogReader::fieldValue(const uchar* sample, const Field_t& field, int arrayIndex)
+{
+    const uchar* data = sample + field.offset + (arrayIndex * field.typeSize);
+
+    switch (field.type) {
+    case FieldTypeInt8:
+        return _read<qint8>(data);
+    case FieldTypeUInt8:
+    case FieldTypeChar:
+        return _read<quint8>(data);
+    case FieldTypeBool:
+        return _read<quint8>(data) ? 1 : 0;
+    case FieldTypeInt16:
+        return _read<qint16>(data);
+    case FieldTypeUInt16:
+        return _read<quint16>(data);
+    case FieldTypeInt32:
+        return _read<qint32>(data);
+    case FieldTypeUInt32:
+        return _read<quint32>(data);
+    case FieldTypeInt64:
+        return static_cast<double>(_read<qint64>(data));
+    case FieldTypeUInt64:
+        return static_cast<double>(_read<quint64>(data));
+    case FieldTypeFloat:
+        return static_cast<double>(_read<float>(data));
+    case FieldTypeDouble:
+        return _read<double>(data);
+    case FieldTypeNested:
+        break;
+    }
+
+    return qQNaN();
+}
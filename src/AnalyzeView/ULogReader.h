@@ -0,0 +1,153 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCLoggingCategory.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+Q_DECLARE_LOGGING_CATEGORY(ULogReaderLog)
+
+/// Memory maps a ULog file and indexes it in a single pass, so logs of several gigabytes can be read without loading
+/// them. The index holds the formats, the subscriptions of each topic and the file offset of every data message. Data
+/// is read straight from the mapping, by sample index or by time range.
+///
+/// Shared by anything which reads PX4 logs, see ULogParser for geotagging.
+class ULogReader
+{
+    Q_DECLARE_TR_FUNCTIONS(ULogReader)
+
+public:
+    ULogReader(void);
+    ~ULogReader();
+
+    typedef enum {
+        FieldTypeInt8,
+        FieldTypeUInt8,
+        FieldTypeInt16,
+        FieldTypeUInt16,
+        FieldTypeInt32,
+        FieldTypeUInt32,
+        FieldTypeInt64,
+        FieldTypeUInt64,
+        FieldTypeFloat,
+        FieldTypeDouble,
+        FieldTypeChar,
+        FieldTypeBool,
+        FieldTypeNested,    ///< Another format, see Field_t::typeName
+    } FieldType_t;
+
+    typedef struct {
+        QString     name;
+        QString     typeName;
+        FieldType_t type;
+        int         offset;     ///< From the start of the sample
+        int         typeSize;   ///< Size of a single element
+        int         arraySize;  ///< 1 for no array
+    } Field_t;
+
+    typedef struct {
+        QString         name;
+        QList<Field_t>  fields;     ///< Padding fields are named _padding<n>
+        int             size;       ///< -1 while nested formats are unresolved
+    } Format_t;
+
+    /// A subscription to a topic, there is one for each multi id. Sample offsets are kept as 32 bit deltas from the
+    /// base of their chunk, which halves the index of large logs.
+    typedef struct {
+        QString             name;
+        int                 multiId;
+        int                 formatIndex;
+        QVector<quint32>    offsetDeltas;   ///< Sample offset from the base of its chunk
+        QVector<qint64>     chunkBases;     ///< File offset the deltas of a chunk start from
+        QVector<int>        chunkFirsts;    ///< First sample of each chunk
+    } Topic_t;
+
+    /// A logged string message, level is a syslog level the same as MAV_SEVERITY
+    typedef struct {
+        quint64 timestampUSecs;
+        int     level;
+        QString text;
+    } LogMessage_t;
+
+    /// Maps and indexes the file
+    /// @return false: failed, errorString set
+    bool open   (const QString& fileName, QString& errorString);
+    void close  (void);
+
+    bool        isOpen      (void) const { return _data != nullptr; }
+    quint64     startUSecs  (void) const { return _startUSecs; }
+
+    QStringList     topicNames  (void) const;
+    const Format_t* format      (const QString& name) const;
+    const Field_t*  field       (const QString& formatName, const QString& fieldName) const;
+
+    /// @return Subscription of the topic, nullptr for none
+    const Topic_t*          topic   (const QString& name, int multiId = 0) const;
+    QList<const Topic_t*>   topics  (const QString& name) const;
+
+    /// @return Logged string messages, tagged or not, in log order
+    const QList<LogMessage_t>& logMessages(void) const { return _logMessages; }
+
+    int     sampleCount (const Topic_t* topic) const { return topic->offsetDeltas.count(); }
+
+    /// @return Sample data, starting with the timestamp field. Valid until close.
+    const uchar*    sample          (const Topic_t* topic, int index) const;
+    quint64         sampleTimestamp (const Topic_t* topic, int index) const;
+
+    /// Samples from startUSecs up to but not including endUSecs
+    ///     @param[out] first   First sample of the range
+    ///     @param[out] last    One past the last sample of the range, same as first for none
+    void sampleRange(const Topic_t* topic, quint64 startUSecs, quint64 endUSecs, int& first, int& last) const;
+
+    /// @return Value of the field in the sample
+    static double fieldValue(const uchar* sample, const Field_t& field, int arrayIndex = 0);
+
+    static const int messageHeaderSize  = 3;    ///< msg_size, msg_type
+    static const int fileHeaderSize     = 16;
+
+private:
+    typedef enum {
+        MessageTypeFormat           = 'F',
+        MessageTypeData             = 'D',
+        MessageTypeInfo             = 'I',
+        MessageTypeParameter        = 'P',
+        MessageTypeAddLogged        = 'A',
+        MessageTypeRemoveLogged     = 'R',
+        MessageTypeSync             = 'S',
+        MessageTypeDropout          = 'O',
+        MessageTypeLogging          = 'L',
+        MessageTypeLoggingTagged    = 'C',
+    } MessageType_t;
+
+    bool    _index              (QString& errorString);
+    void    _addFormat          (const char* data, int size);
+    void    _addSubscription    (const uchar* data, int size);
+    void    _addSample          (int topicIndex, qint64 offset);
+    void    _addLogMessage      (const uchar* data, int size, bool tagged);
+    bool    _resolveFormat      (int formatIndex, int depth = 0);
+    qint64  _sampleOffset       (const Topic_t* topic, int index) const;
+
+    QFile                   _file;
+    uchar*                  _data           = nullptr;
+    qint64                  _size           = 0;
+    quint64                 _startUSecs     = 0;
+    QList<Format_t>         _formats;
+    QHash<QString, int>     _formatIndices;     ///< Key: format name
+    QList<Topic_t>          _topics;
+    QHash<int, int>         _msgIdTopics;       ///< Topic of each subscribed message id
+    QList<LogMessage_t>     _logMessages;
+};
@@ -0,0 +1,156 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ULogReaderTest.h"
+#include "ULogReader.h"
+
+#include <QTemporaryDir>
+
+static const char* _testFormat = "test_topic:uint64_t timestamp;int16_t a;uint8_t[2] _padding0;vec v;double[2] d;";
+
+template <typename T>
+static void _append(QByteArray& bytes, T value)
+{
+    bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static void _appendMessage(QByteArray& log, char msgType, const QByteArray& payload)
+{
+    _append<quint16>(log, static_cast<quint16>(payload.size()));
+    log.append(msgType);
+    log.append(payload);
+}
+
+static void _appendSubscription(QByteArray& log, quint8 multiId, quint16 msgId, const QByteArray& name)
+{
+    QByteArray payload;
+    _append<quint8>(payload, multiId);
+    _append<quint16>(payload, msgId);
+    payload.append(name);
+    _appendMessage(log, 'A', payload);
+}
+
+static void _appendSample(QByteArray& log, quint16 msgId, quint64 timestamp, int i)
+{
+    QByteArray payload;
+    _append<quint16>(payload, msgId);
+    _append<quint64>(payload, timestamp);
+    _append<qint16>(payload, static_cast<qint16>(-i));
+    _append<quint16>(payload, 0);
+    _append<float>(payload, i * 0.5f);
+    _append<float>(payload, 0);
+    _append<double>(payload, 0);
+    _append<double>(payload, i * 2.0);
+    _appendMessage(log, 'D', payload);
+}
+
+static bool _writeFile(const QString& fileName, const QByteArray& bytes)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    return file.write(bytes) == bytes.size();
+}
+
+void ULogReaderTest::_indexTest(void)
+{
+    QByteArray log("ULog\x01\x12\x35\x01", 8);
+    _append<quint64>(log, 123456);
+
+    // The nested format is defined after its user, which is valid ULog
+    _appendMessage(log, 'F', QByteArray(_testFormat));
+    _appendMessage(log, 'F', QByteArray("vec:float x;float y;"));
+    _appendSubscription(log, 0, 1, "test_topic");
+    _appendSubscription(log, 1, 2, "test_topic");
+    for (int i=0; i<10; i++) {
+        _appendSample(log, 1, 1000 * (i + 1), i);
+        if (i < 3) {
+            _appendSample(log, 2, 1000 * (i + 1), i);
+        }
+    }
+    QByteArray remove;
+    _append<quint16>(remove, 2);
+    _appendMessage(log, 'R', remove);
+    _appendSample(log, 2, 20000, 20);
+
+    // Partial message, as left behind by a power loss
+    _append<quint16>(log, 100);
+    log.append('D');
+
+    QTemporaryDir   tempDir;
+    QString         fileName = tempDir.filePath(QStringLiteral("test.ulg"));
+    QVERIFY(_writeFile(fileName, log));
+
+    ULogReader  reader;
+    QString     errorString;
+    QVERIFY2(reader.open(fileName, errorString), qPrintable(errorString));
+    QCOMPARE(reader.startUSecs(), static_cast<quint64>(123456));
+    QCOMPARE(reader.topicNames(), QStringList(QStringLiteral("test_topic")));
+    QCOMPARE(reader.topics(QStringLiteral("test_topic")).count(), 2);
+    QVERIFY(!reader.topic(QStringLiteral("test_topic"), 2));
+
+    const ULogReader::Format_t* format = reader.format(QStringLiteral("test_topic"));
+    QVERIFY(format);
+    QCOMPARE(format->size, 36);
+
+    const ULogReader::Topic_t* topic0 = reader.topic(QStringLiteral("test_topic"), 0);
+    const ULogReader::Topic_t* topic1 = reader.topic(QStringLiteral("test_topic"), 1);
+    QVERIFY(topic0);
+    QVERIFY(topic1);
+    QCOMPARE(reader.sampleCount(topic0), 10);
+    QCOMPARE(reader.sampleCount(topic1), 3);
+
+    const ULogReader::Field_t* aField = reader.field(QStringLiteral("test_topic"), QStringLiteral("a"));
+    const ULogReader::Field_t* vField = reader.field(QStringLiteral("test_topic"), QStringLiteral("v"));
+    const ULogReader::Field_t* dField = reader.field(QStringLiteral("test_topic"), QStringLiteral("d"));
+    const ULogReader::Field_t* xField = reader.field(QStringLiteral("vec"), QStringLiteral("x"));
+    QVERIFY(aField && vField && dField && xField);
+    QCOMPARE(vField->type, ULogReader::FieldTypeNested);
+    QCOMPARE(vField->offset, 12);
+    QCOMPARE(dField->offset, 20);
+    QCOMPARE(dField->arraySize, 2);
+
+    for (int i=0; i<10; i++) {
+        const uchar* sample = reader.sample(topic0, i);
+        QCOMPARE(reader.sampleTimestamp(topic0, i), static_cast<quint64>(1000 * (i + 1)));
+        QCOMPARE(ULogReader::fieldValue(sample, *aField), static_cast<double>(-i));
+        QCOMPARE(ULogReader::fieldValue(sample + vField->offset, *xField), i * 0.5);
+        QCOMPARE(ULogReader::fieldValue(sample, *dField, 1), i * 2.0);
+    }
+
+    int first, last;
+    reader.sampleRange(topic0, 2500, 6000, first, last);
+    QCOMPARE(first, 2);
+    QCOMPARE(last, 5);
+    reader.sampleRange(topic0, 0, 100000, first, last);
+    QCOMPARE(first, 0);
+    QCOMPARE(last, 10);
+    reader.sampleRange(topic1, 5000, 6000, first, last);
+    QCOMPARE(first, last);
+
+    reader.close();
+    QVERIFY(!reader.isOpen());
+}
+
+void ULogReaderTest::_badFileTest(void)
+{
+    QTemporaryDir   tempDir;
+    QString         fileName = tempDir.filePath(QStringLiteral("bad.ulg"));
+    ULogReader      reader;
+    QString         errorString;
+
+    QVERIFY(!reader.open(fileName, errorString));
+    QVERIFY(!errorString.isEmpty());
+
+    QVERIFY(_writeFile(fileName, QByteArray("not a ulog file, not a ulog file")));
+    QVERIFY(!reader.open(fileName, errorString));
+    QVERIFY(!errorString.isEmpty());
+    QVERIFY(!reader.isOpen());
+}
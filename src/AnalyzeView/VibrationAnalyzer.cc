@@ -0,0 +1,223 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VibrationAnalyzer.h"
+#include "ULogReader.h"
+
+QGC_LOGGING_CATEGORY(VibrationAnalyzerLog, "VibrationAnalyzerLog")
+
+VibrationAnalyzer::VibrationAnalyzer(QObject* parent)
+    : QObject           (parent)
+    , _currentRequest   (0)
+{
+
+}
+
+bool VibrationAnalyzer::readSamples(const ULogReader& reader, Sensor_t sensor, Samples_t& samples, QString& errorString)
+{
+    const bool accel = sensor == SensorAccel;
+
+    if (_readFifoSamples(reader, accel ? QStringLiteral("sensor_accel_fifo") : QStringLiteral("sensor_gyro_fifo"), samples) ||
+            _readVectorSamples(reader, accel ? QStringLiteral("sensor_accel") : QStringLiteral("sensor_gyro"), QStringList({ QStringLiteral("x"), QStringLiteral("y"), QStringLiteral("z") }), samples) ||
+            _readVectorSamples(reader, QStringLiteral("sensor_combined"), QStringList(accel ? QStringLiteral("accelerometer_m_s2") : QStringLiteral("gyro_rad")), samples)) {
+        qCDebug(VibrationAnalyzerLog) << "Samples" << samples.topicName << samples.axes[0].count() << "rate" << samples.sampleRateHz;
+        return true;
+    }
+
+    errorString = accel ? tr("The log has no accelerometer data") : tr("The log has no gyro data");
+    return false;
+}
+
+bool VibrationAnalyzer::_readFifoSamples(const ULogReader& reader, const QString& topicName, Samples_t& samples)
+{
+    const ULogReader::Topic_t* topic = reader.topic(topicName);
+    if (!topic || reader.sampleCount(topic) == 0) {
+        return false;
+    }
+
+    const ULogReader::Field_t* axisFields[VibrationSpectrogram::axisCount] = {
+        reader.field(topicName, QStringLiteral("x")),
+        reader.field(topicName, QStringLiteral("y")),
+        reader.field(topicName, QStringLiteral("z")),
+    };
+    const ULogReader::Field_t* countField   = reader.field(topicName, QStringLiteral("samples"));
+    const ULogReader::Field_t* dtField      = reader.field(topicName, QStringLiteral("dt"));
+    const ULogReader::Field_t* scaleField   = reader.field(topicName, QStringLiteral("scale"));
+    if (!axisFields[0] || !axisFields[1] || !axisFields[2] || !countField || !dtField || !scaleField) {
+        return false;
+    }
+
+    const int   sampleCount = reader.sampleCount(topic);
+    double      dtSum       = 0;
+    for (int axis=0; axis<VibrationSpectrogram::axisCount; axis++) {
+        samples.axes[axis].clear();
+        samples.axes[axis].reserve(sampleCount * axisFields[axis]->arraySize);
+    }
+    for (int i=0; i<sampleCount; i++) {
+        const uchar*    sample  = reader.sample(topic, i);
+        const int       count   = qMin(static_cast<int>(ULogReader::fieldValue(sample, *countField)), axisFields[0]->arraySize);
+        const float     scale   = static_cast<float>(ULogReader::fieldValue(sample, *scaleField));
+        for (int axis=0; axis<VibrationSpectrogram::axisCount; axis++) {
+            for (int j=0; j<count; j++) {
+                samples.axes[axis].append(static_cast<float>(ULogReader::fieldValue(sample, *axisFields[axis], j)) * scale);
+            }
+        }
+        dtSum += ULogReader::fieldValue(sample, *dtField);
+    }
+
+    if (samples.axes[0].isEmpty() || dtSum <= 0) {
+        return false;
+    }
+    samples.topicName       = topicName;
+    samples.startUSecs      = reader.sampleTimestamp(topic, 0);
+    samples.sampleRateHz    = (1e6 * sampleCount) / dtSum;
+    return true;
+}
+
+bool VibrationAnalyzer::_readVectorSamples(const ULogReader& reader, const QString& topicName, const QStringList& fieldNames, Samples_t& samples)
+{
+    // A single field is an array holding all axes
+    const ULogReader::Topic_t* topic = reader.topic(topicName);
+    if (!topic || reader.sampleCount(topic) < 2) {
+        return false;
+    }
+
+    const ULogReader::Field_t*  axisFields[VibrationSpectrogram::axisCount];
+    int                         arrayIndices[VibrationSpectrogram::axisCount];
+    for (int axis=0; axis<VibrationSpectrogram::axisCount; axis++) {
+        const bool array = fieldNames.count() == 1;
+        axisFields[axis]    = reader.field(topicName, array ? fieldNames[0] : fieldNames[axis]);
+        arrayIndices[axis]  = array ? axis : 0;
+        if (!axisFields[axis] || axisFields[axis]->arraySize <= arrayIndices[axis]) {
+            return false;
+        }
+    }
+
+    const int       sampleCount = reader.sampleCount(topic);
+    const quint64   firstUSecs  = reader.sampleTimestamp(topic, 0);
+    const quint64   lastUSecs   = reader.sampleTimestamp(topic, sampleCount - 1);
+    if (lastUSecs <= firstUSecs) {
+        return false;
+    }
+
+    for (int axis=0; axis<VibrationSpectrogram::axisCount; axis++) {
+        samples.axes[axis].resize(sampleCount);
+    }
+    for (int i=0; i<sampleCount; i++) {
+        const uchar* sample = reader.sample(topic, i);
+        for (int axis=0; axis<VibrationSpectrogram::axisCount; axis++) {
+            samples.axes[axis][i] = static_cast<float>(ULogReader::fieldValue(sample, *axisFields[axis], arrayIndices[axis]));
+        }
+    }
+
+    samples.topicName       = topicName;
+    samples.startUSecs      = firstUSecs;
+    samples.sampleRateHz    = (1e6 * (sampleCount - 1)) / (lastUSecs - firstUSecs);
+    return true;
+}
+
+VibrationSpectrogram VibrationAnalyzer::spectrogram(const Samples_t& samples, int windowSize, int maxColumns, Progress_t progress)
+{
+    maxColumns = qMax(maxColumns, 1);
+
+    VibrationSpectrum       spectrum(windowSize);
+    VibrationSpectrogram    spectrogram(spectrum.binCount(), samples.sampleRateHz, maxColumns);
+
+    const int size  = spectrum.windowSize();
+    const int count = samples.axes[0].count();
+    if (count < size || samples.sampleRateHz <= 0) {
+        return spectrogram;
+    }
+
+    // Windows overlap by half, unless that gives more than maxColumns of them. Then maxColumns windows are spread
+    // evenly over the samples instead.
+    const qint64    span    = count - size;
+    int             windows = static_cast<int>((span / (size / 2)) + 1);
+    const bool      spread  = windows > maxColumns;
+    if (spread) {
+        windows = maxColumns;
+    }
+
+    QVector<float> amplitudes[VibrationSpectrogram::axisCount];
+    for (int axis=0; axis<VibrationSpectrogram::axisCount; axis++) {
+        amplitudes[axis].resize(spectrum.binCount());
+    }
+    for (int window=0; window<windows; window++) {
+        if (progress && (window % _progressWindows) == 0 && !progress(static_cast<double>(window) / windows)) {
+            return VibrationSpectrogram(spectrum.binCount(), samples.sampleRateHz, maxColumns);
+        }
+
+        qint64 offset = static_cast<qint64>(window) * (size / 2);
+        if (spread) {
+            offset = windows > 1 ? (window * span) / (windows - 1) : 0;
+        }
+        for (int axis=0; axis<VibrationSpectrogram::axisCount; axis++) {
+            spectrum.compute(samples.axes[axis].constData() + offset, amplitudes[axis].data());
+        }
+        spectrogram.appendColumn(samples.startUSecs + static_cast<quint64>((offset * 1e6) / samples.sampleRateHz),
+                                 amplitudes[0].constData(), amplitudes[1].constData(), amplitudes[2].constData());
+    }
+
+    return spectrogram;
+}
+
+void VibrationAnalyzer::analyzeLog(int requestId, const QString& fileName, int sensor, int windowSize)
+{
+    ULogReader  reader;
+    Samples_t   samples;
+    QString     errorString;
+
+    if (requestId != _currentRequest) {
+        return;
+    }
+    if (!reader.open(fileName, errorString) || !readSamples(reader, static_cast<Sensor_t>(sensor), samples, errorString)) {
+        emit logAnalyzed(requestId, false, errorString, QString(), VibrationSpectrogram());
+        return;
+    }
+    reader.close();
+
+    windowSize = VibrationSpectrum::validWindowSize(windowSize);
+    if (samples.axes[0].count() < windowSize) {
+        emit logAnalyzed(requestId, false, tr("The log has fewer samples than a single window of %1").arg(windowSize), samples.topicName, VibrationSpectrogram());
+        return;
+    }
+
+    VibrationSpectrogram result = spectrogram(samples, windowSize, VibrationSpectrogram::defaultMaxColumns, [this, requestId](double progress) {
+        if (requestId != _currentRequest) {
+            return false;
+        }
+        emit progressChanged(requestId, progress);
+        return true;
+    });
+
+    // A newer request makes this one pointless
+    if (requestId == _currentRequest) {
+        emit logAnalyzed(requestId, true, QString(), samples.topicName, result);
+    }
+}
+
+void VibrationAnalyzer::analyzeWindow(quint64 timeUSecs, const QVector<float> x, const QVector<float> y, const QVector<float> z)
+{
+    const int size = x.count();
+    if (VibrationSpectrum::validWindowSize(size) != size || y.count() != size || z.count() != size) {
+        qWarning() << "Internal error: invalid live window" << size;
+        return;
+    }
+    if (_liveSpectrum.windowSize() != size) {
+        _liveSpectrum = VibrationSpectrum(size);
+    }
+
+    QVector<float> amplitudes[VibrationSpectrogram::axisCount];
+    const QVector<float>* axes[VibrationSpectrogram::axisCount] = { &x, &y, &z };
+    for (int axis=0; axis<VibrationSpectrogram::axisCount; axis++) {
+        amplitudes[axis].resize(_liveSpectrum.binCount());
+        _liveSpectrum.compute(axes[axis]->constData(), amplitudes[axis].data());
+    }
+    emit windowAnalyzed(timeUSecs, amplitudes[0], amplitudes[1], amplitudes[2]);
+}
@@ -0,0 +1,85 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCLoggingCategory.h"
+#include "VibrationSpectrum.h"
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+#include <functional>
+
+Q_DECLARE_LOGGING_CATEGORY(VibrationAnalyzerLog)
+
+class ULogReader;
+
+/// Computes spectrograms of the IMU of a ULog or of live samples. Runs on a worker thread, see VibrationController.
+///
+/// Log samples come from the highest rate topic the log has for the sensor: the FIFO topics of the high rate logging
+/// profile, then the raw sensor topics and finally sensor_combined, which every log has.
+class VibrationAnalyzer : public QObject
+{
+    Q_OBJECT
+
+public:
+    VibrationAnalyzer(QObject* parent = nullptr);
+
+    typedef enum {
+        SensorAccel = 0,
+        SensorGyro,
+    } Sensor_t;
+
+    /// Uniformly sampled values of the three axes of a sensor
+    typedef struct {
+        QString         topicName;
+        quint64         startUSecs;
+        double          sampleRateHz;
+        QVector<float>  axes[VibrationSpectrogram::axisCount];
+    } Samples_t;
+
+    /// Reads the samples of the sensor from the log
+    /// @return false: the log has no samples for the sensor, errorString set
+    static bool readSamples(const ULogReader& reader, Sensor_t sensor, Samples_t& samples, QString& errorString);
+
+    /// Called with the fraction done while computing, returning false stops computing
+    typedef std::function<bool(double progress)> Progress_t;
+
+    /// Computes the spectra of windows of windowSize samples, which overlap by half. Long logs are spread over
+    /// maxColumns windows instead.
+    static VibrationSpectrogram spectrogram(const Samples_t& samples, int windowSize, int maxColumns = VibrationSpectrogram::defaultMaxColumns, Progress_t progress = Progress_t());
+
+    /// Requests older than requestId stop as soon as possible, thread safe
+    void setCurrentRequest(int requestId) { _currentRequest = requestId; }
+
+public slots:
+    /// Computes the spectrogram of a log, signalling logAnalyzed once done
+    void analyzeLog(int requestId, const QString& fileName, int sensor, int windowSize);
+
+    /// Computes the spectra of a single window of live samples, signalling windowAnalyzed
+    void analyzeWindow(quint64 timeUSecs, const QVector<float> x, const QVector<float> y, const QVector<float> z);
+
+signals:
+    void progressChanged(int requestId, double progress);
+    void logAnalyzed    (int requestId, bool success, const QString& errorString, const QString& topicName, const VibrationSpectrogram spectrogram);
+    void windowAnalyzed (quint64 timeUSecs, const QVector<float> x, const QVector<float> y, const QVector<float> z);
+
+private:
+    static bool _readFifoSamples    (const ULogReader& reader, const QString& topicName, Samples_t& samples);
+    static bool _readVectorSamples  (const ULogReader& reader, const QString& topicName, const QStringList& fieldNames, Samples_t& samples);
+
+    std::atomic<int>    _currentRequest;
+    VibrationSpectrum   _liveSpectrum;
+
+    static const int _progressWindows = 32;     ///< Windows computed between progress reports
+};
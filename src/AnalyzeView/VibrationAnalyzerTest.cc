@@ -0,0 +1,155 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VibrationAnalyzerTest.h"
+#include "VibrationAnalyzer.h"
+#include "ULogReader.h"
+
+#include <QTemporaryDir>
+#include <QtMath>
+
+static const double _sampleRateHz = 1000;
+
+template <typename T>
+static void _append(QByteArray& bytes, T value)
+{
+    bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static void _appendMessage(QByteArray& log, char msgType, const QByteArray& payload)
+{
+    _append<quint16>(log, static_cast<quint16>(payload.size()));
+    log.append(msgType);
+    log.append(payload);
+}
+
+static float _sine(double frequencyHz, double amplitude, int i)
+{
+    return static_cast<float>(amplitude * qSin((2.0 * M_PI * frequencyHz * i) / _sampleRateHz));
+}
+
+void VibrationAnalyzerTest::_spectrumTest(void)
+{
+    QCOMPARE(VibrationSpectrum::validWindowSize(1000),   1024);
+    QCOMPARE(VibrationSpectrum::validWindowSize(1),      VibrationSpectrum::minWindowSize);
+    QCOMPARE(VibrationSpectrum::validWindowSize(100000), VibrationSpectrum::maxWindowSize);
+
+    VibrationSpectrum spectrum(256);
+    QCOMPARE(spectrum.binCount(), 129);
+
+    // Sine centered on bin 32 on top of gravity, which is removed with the mean
+    QVector<float> samples(256);
+    for (int i=0; i<samples.count(); i++) {
+        samples[i] = 9.81f + _sine(32 * _sampleRateHz / 256, 2.0, i);
+    }
+    QVector<float> amplitudes(spectrum.binCount());
+    spectrum.compute(samples.constData(), amplitudes.data());
+
+    int peakBin = 0;
+    for (int bin=1; bin<amplitudes.count(); bin++) {
+        if (amplitudes[bin] > amplitudes[peakBin]) {
+            peakBin = bin;
+        }
+    }
+    QCOMPARE(peakBin, 32);
+    QVERIFY(qAbs(amplitudes[32] - 2.0f) < 0.01f);
+    QVERIFY(amplitudes[0] < 0.01f);
+    QVERIFY(amplitudes[64] < 0.01f);
+}
+
+void VibrationAnalyzerTest::_spectrogramTest(void)
+{
+    VibrationAnalyzer::Samples_t samples;
+    samples.startUSecs      = 1000000;
+    samples.sampleRateHz    = _sampleRateHz;
+    for (int i=0; i<10240; i++) {
+        samples.axes[0].append(_sine(125, 1.0, i));
+        samples.axes[1].append(_sine(250, 0.5, i));
+        samples.axes[2].append(_sine(62.5, 0.1, i) + _sine(300, 0.2, i));
+    }
+
+    // Windows overlap by half
+    VibrationSpectrogram spectrogram = VibrationAnalyzer::spectrogram(samples, 1024);
+    QCOMPARE(spectrogram.binCount(), 513);
+    QCOMPARE(spectrogram.columnCount(), 19);
+    QCOMPARE(spectrogram.columnTimeUSecs(0), static_cast<quint64>(1000000));
+    QCOMPARE(spectrogram.columnTimeUSecs(1), static_cast<quint64>(1512000));
+    QCOMPARE(spectrogram.peakFrequency(VibrationSpectrogram::AxisX), 125.0);
+    QCOMPARE(spectrogram.peakFrequency(VibrationSpectrogram::AxisY), 250.0);
+    QVERIFY(qAbs(spectrogram.peakFrequency(VibrationSpectrogram::AxisZ) - 300) < 1);
+    QVERIFY(qAbs(spectrogram.peakFrequency(VibrationSpectrogram::AxisZ, 0) - spectrogram.peakFrequency(VibrationSpectrogram::AxisZ, 100)) < 1);
+    QCOMPARE(spectrogram.peakFrequency(VibrationSpectrogram::AxisAll), 125.0);
+
+    QImage image = spectrogram.render(VibrationSpectrogram::AxisAll);
+    QCOMPARE(image.width(), 19);
+    QCOMPARE(image.height(), 513);
+
+    // Long logs are spread over maxColumns windows
+    spectrogram = VibrationAnalyzer::spectrogram(samples, 256, 10);
+    QCOMPARE(spectrogram.columnCount(), 10);
+
+    // Returning false from progress stops computing
+    spectrogram = VibrationAnalyzer::spectrogram(samples, 256, VibrationSpectrogram::defaultMaxColumns, [](double) { return false; });
+    QCOMPARE(spectrogram.columnCount(), 0);
+
+    // Too few samples for a single window
+    spectrogram = VibrationAnalyzer::spectrogram(samples, 8192 * 2);
+    QCOMPARE(spectrogram.columnCount(), 1);
+    samples.axes[0].resize(100);
+    spectrogram = VibrationAnalyzer::spectrogram(samples, 1024);
+    QCOMPARE(spectrogram.columnCount(), 0);
+}
+
+void VibrationAnalyzerTest::_logTest(void)
+{
+    QByteArray log("ULog\x01\x12\x35\x01", 8);
+    _append<quint64>(log, 0);
+    _appendMessage(log, 'F', QByteArray("sensor_combined:uint64_t timestamp;float[3] gyro_rad;float[3] accelerometer_m_s2;"));
+
+    QByteArray subscription;
+    _append<quint8>(subscription, 0);
+    _append<quint16>(subscription, 1);
+    subscription.append("sensor_combined");
+    _appendMessage(log, 'A', subscription);
+
+    for (int i=0; i<2048; i++) {
+        QByteArray payload;
+        _append<quint16>(payload, 1);
+        _append<quint64>(payload, static_cast<quint64>(1000 * i));
+        _append<float>(payload, _sine(62.5, 0.1, i));
+        _append<float>(payload, 0);
+        _append<float>(payload, 0);
+        _append<float>(payload, 0);
+        _append<float>(payload, 0);
+        _append<float>(payload, -9.81f + _sine(125, 1.0, i));
+        _appendMessage(log, 'D', payload);
+    }
+
+    QTemporaryDir   tempDir;
+    QString         fileName = tempDir.filePath(QStringLiteral("vibration.ulg"));
+    QFile           file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(log), static_cast<qint64>(log.size()));
+    file.close();
+
+    ULogReader  reader;
+    QString     errorString;
+    QVERIFY2(reader.open(fileName, errorString), qPrintable(errorString));
+
+    // Only sensor_combined is logged, which serves both sensors
+    VibrationAnalyzer::Samples_t samples;
+    QVERIFY2(VibrationAnalyzer::readSamples(reader, VibrationAnalyzer::SensorAccel, samples, errorString), qPrintable(errorString));
+    QCOMPARE(samples.topicName, QStringLiteral("sensor_combined"));
+    QCOMPARE(samples.axes[2].count(), 2048);
+    QCOMPARE(samples.sampleRateHz, _sampleRateHz);
+    QCOMPARE(VibrationAnalyzer::spectrogram(samples, 512).peakFrequency(VibrationSpectrogram::AxisZ), 125.0);
+
+    QVERIFY2(VibrationAnalyzer::readSamples(reader, VibrationAnalyzer::SensorGyro, samples, errorString), qPrintable(errorString));
+    QCOMPARE(VibrationAnalyzer::spectrogram(samples, 512).peakFrequency(VibrationSpectrogram::AxisX), 62.5);
+}
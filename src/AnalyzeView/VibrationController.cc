@@ -0,0 +1,282 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VibrationController.h"
+#include "VibrationAnalyzer.h"
+#include "QGCApplication.h"
+#include "QGCImageProvider.h"
+#include "MultiVehicleManager.h"
+#include "MessageRateManager.h"
+#include "MAVLinkProtocol.h"
+#include "Vehicle.h"
+
+const char* VibrationController::imageName = "vibrationSpectrogram";
+
+VibrationController::VibrationController(QObject* parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<VibrationSpectrogram>();
+    qRegisterMetaType<QVector<float>>();
+
+    // The analyzer is deleted on its own thread once the thread is done
+    _analyzer = new VibrationAnalyzer();
+    _analyzer->moveToThread(&_analyzerThread);
+    connect(&_analyzerThread,   &QThread::finished,                     _analyzer,  &QObject::deleteLater);
+    connect(this,               &VibrationController::_analyzeLog,      _analyzer,  &VibrationAnalyzer::analyzeLog,             Qt::QueuedConnection);
+    connect(this,               &VibrationController::_analyzeWindow,   _analyzer,  &VibrationAnalyzer::analyzeWindow,          Qt::QueuedConnection);
+    connect(_analyzer,          &VibrationAnalyzer::logAnalyzed,        this,       &VibrationController::_logAnalyzed,         Qt::QueuedConnection);
+    connect(_analyzer,          &VibrationAnalyzer::progressChanged,    this,       &VibrationController::_progressChanged,     Qt::QueuedConnection);
+    connect(_analyzer,          &VibrationAnalyzer::windowAnalyzed,     this,       &VibrationController::_windowAnalyzed,      Qt::QueuedConnection);
+    _analyzerThread.setObjectName(QStringLiteral("VibrationAnalyzer"));
+    _analyzerThread.start();
+
+    connect(qgcApp()->toolbox()->multiVehicleManager(), &MultiVehicleManager::activeVehicleChanged, this, &VibrationController::_activeVehicleChanged);
+}
+
+VibrationController::~VibrationController()
+{
+    _stopLive();
+    _analyzer->setCurrentRequest(++_requestId);
+    _analyzerThread.quit();
+    _analyzerThread.wait();
+}
+
+void VibrationController::analyzeLog(const QString& fileName)
+{
+    _stopLive();
+    _clearSpectrogram();
+    _setErrorString(QString());
+
+    _logFileName = fileName;
+    _analyzer->setCurrentRequest(++_requestId);
+    _progress = 0;
+    emit progressChanged();
+    _setBusy(true);
+    emit _analyzeLog(_requestId, fileName, _sensor, _windowSize);
+}
+
+void VibrationController::startLive(void)
+{
+    Vehicle* vehicle = qgcApp()->toolbox()->multiVehicleManager()->activeVehicle();
+    if (!vehicle) {
+        _setErrorString(tr("No vehicle connected"));
+        return;
+    }
+
+    stop();
+    _clearSpectrogram();
+    _setErrorString(QString());
+    _logFileName.clear();
+    _topicName = QStringLiteral("HIGHRES_IMU");
+    emit spectrogramChanged();
+
+    _vehicle = vehicle;
+    _vehicle->messageRateManager()->requestMessageRate(this, MAVLINK_MSG_ID_HIGHRES_IMU, liveRateHz);
+    qgcApp()->toolbox()->mavlinkProtocol()->messageDispatcher()->subscribe(MAVLINK_MSG_ID_HIGHRES_IMU, _vehicle->id(), MAVLinkMessageDispatcher::AnyComponent, this, &VibrationController::_handleHighresImu);
+    emit liveChanged();
+}
+
+void VibrationController::stop(void)
+{
+    _stopLive();
+    if (_busy) {
+        _analyzer->setCurrentRequest(++_requestId);
+        _setBusy(false);
+    }
+}
+
+void VibrationController::_stopLive(void)
+{
+    if (_vehicle) {
+        qgcApp()->toolbox()->mavlinkProtocol()->messageDispatcher()->unsubscribeAll(this);
+        _vehicle->messageRateManager()->removeConsumer(this);
+        _vehicle = nullptr;
+        emit liveChanged();
+    }
+    for (int axis=0; axis<VibrationSpectrogram::axisCount; axis++) {
+        _liveSamples[axis].clear();
+    }
+    _liveTimesUSecs.clear();
+    _liveNewSamples = 0;
+}
+
+double VibrationController::durationSecs(void) const
+{
+    const int columns = _spectrogram.columnCount();
+    if (columns < 2) {
+        return 0;
+    }
+    return (_spectrogram.columnTimeUSecs(columns - 1) - _spectrogram.columnTimeUSecs(0)) / 1e6;
+}
+
+QString VibrationController::imageUrl(void) const
+{
+    if (_spectrogram.columnCount() == 0) {
+        return QString();
+    }
+    return QStringLiteral("image://QGCImages/%1/%2").arg(imageName).arg(_imageIndex);
+}
+
+void VibrationController::setSensor(int sensor)
+{
+    sensor = qBound(static_cast<int>(VibrationAnalyzer::SensorAccel), sensor, static_cast<int>(VibrationAnalyzer::SensorGyro));
+    if (sensor == _sensor) {
+        return;
+    }
+    _sensor = sensor;
+    emit sensorChanged();
+
+    if (live()) {
+        startLive();
+    } else if (!_logFileName.isEmpty()) {
+        analyzeLog(_logFileName);
+    }
+}
+
+void VibrationController::setAxis(int axis)
+{
+    axis = qBound(static_cast<int>(VibrationSpectrogram::AxisX), axis, static_cast<int>(VibrationSpectrogram::AxisAll));
+    if (axis == _axis) {
+        return;
+    }
+    _axis = axis;
+    emit axisChanged();
+    _updateImage();
+}
+
+void VibrationController::setWindowSize(int windowSize)
+{
+    windowSize = VibrationSpectrum::validWindowSize(windowSize);
+    if (windowSize == _windowSize) {
+        return;
+    }
+    _windowSize = windowSize;
+    emit windowSizeChanged();
+
+    if (live()) {
+        startLive();
+    } else if (!_logFileName.isEmpty()) {
+        analyzeLog(_logFileName);
+    }
+}
+
+int VibrationController::_liveWindowSize(void) const
+{
+    return qMin(_windowSize, static_cast<int>(maxLiveWindowSize));
+}
+
+void VibrationController::_handleHighresImu(LinkInterface*, const mavlink_message_t& message)
+{
+    mavlink_highres_imu_t highresImu;
+    mavlink_msg_highres_imu_decode(&message, &highresImu);
+
+    const bool accel = _sensor == VibrationAnalyzer::SensorAccel;
+    _liveSamples[0].append(accel ? highresImu.xacc : highresImu.xgyro);
+    _liveSamples[1].append(accel ? highresImu.yacc : highresImu.ygyro);
+    _liveSamples[2].append(accel ? highresImu.zacc : highresImu.zgyro);
+    _liveTimesUSecs.append(highresImu.time_usec);
+    _liveNewSamples++;
+
+    // Windows overlap by half, like those of logs
+    const int size = _liveWindowSize();
+    if (_liveTimesUSecs.count() < size || _liveNewSamples < size / 2) {
+        return;
+    }
+    const int excess = _liveTimesUSecs.count() - size;
+    for (int axis=0; axis<VibrationSpectrogram::axisCount; axis++) {
+        _liveSamples[axis].remove(0, excess);
+    }
+    _liveTimesUSecs.remove(0, excess);
+    _liveNewSamples = 0;
+
+    if (_spectrogram.binCount() == 0) {
+        if (_liveTimesUSecs.last() <= _liveTimesUSecs.first()) {
+            return;
+        }
+        const double sampleRateHz = (1e6 * (size - 1)) / (_liveTimesUSecs.last() - _liveTimesUSecs.first());
+        _spectrogram = VibrationSpectrogram((size / 2) + 1, sampleRateHz, maxLiveColumns);
+    }
+    emit _analyzeWindow(_liveTimesUSecs.first(), _liveSamples[0], _liveSamples[1], _liveSamples[2]);
+}
+
+void VibrationController::_windowAnalyzed(quint64 timeUSecs, const QVector<float> x, const QVector<float> y, const QVector<float> z)
+{
+    // Windows of a live spectrogram which was stopped or restarted since
+    if (!live() || x.count() != _spectrogram.binCount()) {
+        return;
+    }
+    _spectrogram.appendColumn(timeUSecs, x.constData(), y.constData(), z.constData());
+    _updateImage();
+}
+
+void VibrationController::_logAnalyzed(int requestId, bool success, const QString& errorString, const QString& topicName, const VibrationSpectrogram spectrogram)
+{
+    if (requestId != _requestId) {
+        return;
+    }
+    _setBusy(false);
+
+    if (!success) {
+        _setErrorString(errorString);
+        _clearSpectrogram();
+        return;
+    }
+    _topicName      = topicName;
+    _spectrogram    = spectrogram;
+    _updateImage();
+}
+
+void VibrationController::_progressChanged(int requestId, double progress)
+{
+    if (requestId == _requestId) {
+        _progress = progress;
+        emit progressChanged();
+    }
+}
+
+void VibrationController::_activeVehicleChanged(Vehicle* vehicle)
+{
+    if (_vehicle && vehicle != _vehicle) {
+        _stopLive();
+    }
+}
+
+void VibrationController::_setBusy(bool busy)
+{
+    if (busy != _busy) {
+        _busy = busy;
+        emit busyChanged();
+    }
+}
+
+void VibrationController::_setErrorString(const QString& errorString)
+{
+    if (errorString != _errorString) {
+        _errorString = errorString;
+        emit errorStringChanged();
+    }
+}
+
+void VibrationController::_updateImage(void)
+{
+    const VibrationSpectrogram::Axis_t axis = static_cast<VibrationSpectrogram::Axis_t>(_axis);
+
+    qgcApp()->toolbox()->imageProvider()->setNamedImage(imageName, _spectrogram.render(axis));
+    _peakFrequency = _spectrogram.peakFrequency(axis, minPeakHz);
+    _imageIndex++;
+    emit spectrogramChanged();
+}
+
+void VibrationController::_clearSpectrogram(void)
+{
+    _spectrogram    = VibrationSpectrogram();
+    _peakFrequency  = 0;
+    _topicName.clear();
+    emit spectrogramChanged();
+}
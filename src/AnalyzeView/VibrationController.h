@@ -0,0 +1,134 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCLoggingCategory.h"
+#include "QGCMAVLink.h"
+#include "VibrationSpectrum.h"
+
+#include <QObject>
+#include <QThread>
+#include <QVector>
+
+class LinkInterface;
+class Vehicle;
+class VibrationAnalyzer;
+
+/// Controller for the spectral analysis of VibrationPage.qml. Spectrograms of a ULog are computed by a
+/// VibrationAnalyzer on a worker thread. Live spectrograms come from HIGHRES_IMU of the active vehicle, which is
+/// requested at liveRateHz while live. Live windows are at most maxLiveWindowSize samples, so the spectrogram keeps up
+/// with the vehicle, and a live spectrogram covers the last maxLiveColumns windows.
+///
+/// The image is served by QGCImageProvider as image://QGCImages/<imageName>/<imageIndex>.
+class VibrationController : public QObject
+{
+    Q_OBJECT
+
+public:
+    VibrationController(QObject* parent = nullptr);
+    ~VibrationController();
+
+    Q_PROPERTY(int      sensor          READ sensor         WRITE setSensor         NOTIFY sensorChanged)
+    Q_PROPERTY(int      axis            READ axis           WRITE setAxis           NOTIFY axisChanged)
+    Q_PROPERTY(int      windowSize      READ windowSize     WRITE setWindowSize     NOTIFY windowSizeChanged)
+    Q_PROPERTY(bool     live            READ live                                   NOTIFY liveChanged)
+    Q_PROPERTY(bool     busy            READ busy                                   NOTIFY busyChanged)
+    Q_PROPERTY(double   progress        READ progress                               NOTIFY progressChanged)
+    Q_PROPERTY(QString  logFileName     READ logFileName                            NOTIFY spectrogramChanged)
+    Q_PROPERTY(QString  topicName       READ topicName                              NOTIFY spectrogramChanged)
+    Q_PROPERTY(QString  errorString     READ errorString                            NOTIFY errorStringChanged)
+    Q_PROPERTY(double   sampleRate      READ sampleRate                             NOTIFY spectrogramChanged)
+    Q_PROPERTY(double   durationSecs    READ durationSecs                           NOTIFY spectrogramChanged)
+    Q_PROPERTY(double   peakFrequency   READ peakFrequency                          NOTIFY spectrogramChanged)
+    Q_PROPERTY(QString  imageUrl        READ imageUrl                               NOTIFY spectrogramChanged)
+
+    /// Computes the spectrogram of a ULog
+    Q_INVOKABLE void analyzeLog (const QString& fileName);
+
+    /// Starts a live spectrogram of the active vehicle
+    Q_INVOKABLE void startLive  (void);
+
+    /// Stops the live spectrogram or the log analysis
+    Q_INVOKABLE void stop       (void);
+
+    int     sensor          (void) const { return _sensor; }
+    int     axis            (void) const { return _axis; }
+    int     windowSize      (void) const { return _windowSize; }
+    bool    live            (void) const { return _vehicle != nullptr; }
+    bool    busy            (void) const { return _busy; }
+    double  progress        (void) const { return _progress; }
+    QString logFileName     (void) const { return _logFileName; }
+    QString topicName       (void) const { return _topicName; }
+    QString errorString     (void) const { return _errorString; }
+    double  sampleRate      (void) const { return _spectrogram.sampleRateHz(); }
+    double  durationSecs    (void) const;
+    double  peakFrequency   (void) const { return _peakFrequency; }
+    QString imageUrl        (void) const;
+
+    void setSensor      (int sensor);
+    void setAxis        (int axis);
+    void setWindowSize  (int windowSize);
+
+    static const char*  imageName;
+    static const int    liveRateHz          = 250;
+    static const int    maxLiveColumns      = 600;
+    static const int    maxLiveWindowSize   = 256;
+    static const int    minPeakHz           = 5;    ///< Peaks below are motion rather than vibration
+
+signals:
+    void sensorChanged      (void);
+    void axisChanged        (void);
+    void windowSizeChanged  (void);
+    void liveChanged        (void);
+    void busyChanged        (void);
+    void progressChanged    (void);
+    void spectrogramChanged (void);
+    void errorStringChanged (void);
+
+    // Queued to the analyzer
+    void _analyzeLog    (int requestId, const QString& fileName, int sensor, int windowSize);
+    void _analyzeWindow (quint64 timeUSecs, const QVector<float> x, const QVector<float> y, const QVector<float> z);
+
+private slots:
+    void _logAnalyzed       (int requestId, bool success, const QString& errorString, const QString& topicName, const VibrationSpectrogram spectrogram);
+    void _progressChanged   (int requestId, double progress);
+    void _windowAnalyzed    (quint64 timeUSecs, const QVector<float> x, const QVector<float> y, const QVector<float> z);
+    void _activeVehicleChanged(Vehicle* vehicle);
+
+private:
+    void _handleHighresImu  (LinkInterface* link, const mavlink_message_t& message);
+    void _stopLive          (void);
+    void _setBusy           (bool busy);
+    void _setErrorString    (const QString& errorString);
+    void _updateImage       (void);
+    void _clearSpectrogram  (void);
+    int  _liveWindowSize    (void) const;
+
+    QThread                 _analyzerThread;
+    VibrationAnalyzer*      _analyzer           = nullptr;
+    int                     _requestId          = 0;
+    int                     _sensor             = 0;
+    int                     _axis               = VibrationSpectrogram::AxisAll;
+    int                     _windowSize         = VibrationSpectrum::defaultWindowSize;
+    bool                    _busy               = false;
+    double                  _progress           = 0;
+    QString                 _logFileName;
+    QString                 _topicName;
+    QString                 _errorString;
+    VibrationSpectrogram    _spectrogram;
+    double                  _peakFrequency      = 0;
+    int                     _imageIndex         = 0;
+
+    // Live
+    Vehicle*                _vehicle            = nullptr;
+    QVector<float>          _liveSamples[VibrationSpectrogram::axisCount];
+    QVector<quint64>        _liveTimesUSecs;
+    int                     _liveNewSamples     = 0;
+};
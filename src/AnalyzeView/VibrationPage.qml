@@ -38,131 +38,252 @@ AnalyzePage {
     readonly property real _barMinimum:     0.0
     readonly property real _barMaximum:     90.0
     readonly property real _barBadValue:    60.0
+    readonly property var  _windowSizes:    [ 256, 512, 1024, 2048, 4096 ]
 
     QGCPalette { id:qgcPal; colorGroupEnabled: true }
 
+    VibrationController {
+        id: vibrationController
+    }
+
     Component {
         id: pageComponent
 
-        Item {
-            width:  childrenRect.width
-            height: childrenRect.height
+        Column {
+            spacing: ScreenTools.defaultFontPixelHeight
 
-            RowLayout {
-                id:         barRow
-                spacing:    ScreenTools.defaultFontPixelWidth * 4
+            Item {
+                width:  childrenRect.width
+                height: childrenRect.height
 
-                ColumnLayout {
-                    Rectangle {
-                        id:                 xBar
-                        height:             _barHeight
-                        width:              _barWidth
-                        Layout.alignment:   Qt.AlignHCenter
-                        border.width:       1
-                        border.color:       qgcPal.text
+                RowLayout {
+                    id:         barRow
+                    spacing:    ScreenTools.defaultFontPixelWidth * 4
 
+                    ColumnLayout {
                         Rectangle {
-                            anchors.bottom: parent.bottom
-                            width:          parent.width
-                            height:         parent.height * (Math.min(_barMaximum, _xValue) / (_barMaximum - _barMinimum))
-                            color:          qgcPal.text
+                            id:                 xBar
+                            height:             _barHeight
+                            width:              _barWidth
+                            Layout.alignment:   Qt.AlignHCenter
+                            border.width:       1
+                            border.color:       qgcPal.text
+
+                            Rectangle {
+                                anchors.bottom: parent.bottom
+                                width:          parent.width
+                                height:         parent.height * (Math.min(_barMaximum, _xValue) / (_barMaximum - _barMinimum))
+                                color:          qgcPal.text
+                            }
                         }
-                    }
 
-                    QGCLabel {
-                        Layout.alignment:   Qt.AlignHCenter
-                        text:               qsTr("X")
+                        QGCLabel {
+                            Layout.alignment:   Qt.AlignHCenter
+                            text:               qsTr("X")
+                        }
                     }
-                }
-
-                Column {
-                    Rectangle {
-                        height:             _barHeight
-                        width:              _barWidth
-                        Layout.alignment:   Qt.AlignHCenter
-                        border.width:       1
-                        border.color:       qgcPal.text
 
+                    Column {
                         Rectangle {
-                            anchors.bottom: parent.bottom
-                            width:          parent.width
-                            height:         parent.height * (Math.min(_barMaximum, _yValue) / (_barMaximum - _barMinimum))
-                            color:          qgcPal.text
+                            height:             _barHeight
+                            width:              _barWidth
+                            Layout.alignment:   Qt.AlignHCenter
+                            border.width:       1
+                            border.color:       qgcPal.text
+
+                            Rectangle {
+                                anchors.bottom: parent.bottom
+                                width:          parent.width
+                                height:         parent.height * (Math.min(_barMaximum, _yValue) / (_barMaximum - _barMinimum))
+                                color:          qgcPal.text
+                            }
+                        }
+
+                        QGCLabel {
+                            Layout.alignment:   Qt.AlignHCenter
+                            text:               qsTr("Y")
                         }
                     }
 
-                    QGCLabel {
-                        Layout.alignment:   Qt.AlignHCenter
-                        text:               qsTr("Y")
+                    Column {
+                        Rectangle {
+                            height:             _barHeight
+                            width:              _barWidth
+                            Layout.alignment:   Qt.AlignHCenter
+                            border.width:       1
+                            border.color:       qgcPal.text
+
+                            Rectangle {
+                                anchors.bottom: parent.bottom
+                                width:          parent.width
+                                height:         parent.height * (Math.min(_barMaximum, _zValue) / (_barMaximum - _barMinimum))
+                                color:          qgcPal.text
+                            }
+                        }
+
+                        QGCLabel {
+                            Layout.alignment:   Qt.AlignHCenter
+                            text:               qsTr("Z")
+                        }
                     }
                 }
 
+                // Max vibe indication line at 60
+                Rectangle {
+                    anchors.topMargin:      xBar.height * (1.0 - ((_barBadValue - _barMinimum) / (_barMaximum - _barMinimum)))
+                    anchors.top:            barRow.top
+                    anchors.left:           barRow.left
+                    anchors.right:          barRow.right
+                    width:                  barRow.width
+                    height:                 1
+                    color:                  "red"
+                }
+
                 Column {
-                    Rectangle {
-                        height:             _barHeight
-                        width:              _barWidth
-                        Layout.alignment:   Qt.AlignHCenter
-                        border.width:       1
-                        border.color:       qgcPal.text
+                    anchors.margins:    ScreenTools.defaultFontPixelWidth
+                    anchors.left:       barRow.right
 
-                        Rectangle {
-                            anchors.bottom: parent.bottom
-                            width:          parent.width
-                            height:         parent.height * (Math.min(_barMaximum, _zValue) / (_barMaximum - _barMinimum))
-                            color:          qgcPal.text
-                        }
+                    QGCLabel {
+                        text: qsTr("Clip count")
+                    }
+
+                    QGCLabel {
+                        text: qsTr("Accel 1: ") + (_activeVehicle.vibration.clipCount1.rawValueString)
+                    }
+
+                    QGCLabel {
+                        text: qsTr("Accel 2: ") + (_activeVehicle.vibration.clipCount2.rawValueString)
                     }
 
                     QGCLabel {
-                        Layout.alignment:   Qt.AlignHCenter
-                        text:               qsTr("Z")
+                        text: qsTr("Accel 3: ") + (_activeVehicle.vibration.clipCount3.rawValueString)
                     }
                 }
-            }
 
-            // Max vibe indication line at 60
-            Rectangle {
-                anchors.topMargin:      xBar.height * (1.0 - ((_barBadValue - _barMinimum) / (_barMaximum - _barMinimum)))
-                anchors.top:            barRow.top
-                anchors.left:           barRow.left
-                anchors.right:          barRow.right
-                width:                  barRow.width
-                height:                 1
-                color:                  "red"
+                Rectangle {
+                    anchors.fill:   parent
+                    color:          qgcPal.window
+                    opacity:        0.75
+                    visible:        !_available
+
+                    QGCLabel {
+                        anchors.fill:           parent
+                        horizontalAlignment:    Text.AlignHCenter
+                        verticalAlignment:      Text.AlignVCenter
+                        text:                   qsTr("Not Available")
+                    }
+                }
             }
 
-            Column {
-                anchors.margins:    ScreenTools.defaultFontPixelWidth
-                anchors.left:       barRow.right
+            ColumnLayout {
+                width:      availableWidth
+                spacing:    _margins
 
                 QGCLabel {
-                    text: qsTr("Clip count")
+                    text:           qsTr("Spectral Analysis")
+                    font.family:    ScreenTools.demiboldFontFamily
                 }
 
-                QGCLabel {
-                    text: qsTr("Accel 1: ") + (_activeVehicle.vibration.clipCount1.rawValueString)
+                RowLayout {
+                    spacing: ScreenTools.defaultFontPixelWidth
+
+                    QGCComboBox {
+                        model:          [ qsTr("Accelerometer"), qsTr("Gyro") ]
+                        currentIndex:   vibrationController.sensor
+                        onActivated:    vibrationController.sensor = index
+                    }
+
+                    QGCComboBox {
+                        model:          [ qsTr("X"), qsTr("Y"), qsTr("Z"), qsTr("All axes") ]
+                        currentIndex:   vibrationController.axis
+                        onActivated:    vibrationController.axis = index
+                    }
+
+                    QGCComboBox {
+                        model:          _windowSizes
+                        currentIndex:   _windowSizes.indexOf(vibrationController.windowSize)
+                        onActivated:    vibrationController.windowSize = _windowSizes[index]
+                    }
+
+                    QGCButton {
+                        text:       qsTr("Open Log...")
+                        enabled:    !vibrationController.busy
+                        onClicked:  logFileDialog.openForLoad()
+
+                        QGCFileDialog {
+                            id:             logFileDialog
+                            title:          qsTr("Select log file")
+                            nameFilters:    [ qsTr("ULog file (*.ulg)"), qsTr("All Files (*)") ]
+                            selectExisting: true
+                            folder:         QGroundControl.settingsManager.appSettings.logSavePath
+                            onAcceptedForLoad: {
+                                vibrationController.analyzeLog(file)
+                                close()
+                            }
+                        }
+                    }
+
+                    QGCButton {
+                        text:       vibrationController.live || vibrationController.busy ? qsTr("Stop") : qsTr("Live")
+                        enabled:    vibrationController.live || vibrationController.busy || !!QGroundControl.multiVehicleManager.activeVehicle
+                        onClicked: {
+                            if (vibrationController.live || vibrationController.busy) {
+                                vibrationController.stop()
+                            } else {
+                                vibrationController.startLive()
+                            }
+                        }
+                    }
+
+                    ProgressBar {
+                        visible:    vibrationController.busy
+                        value:      vibrationController.progress
+                    }
                 }
 
                 QGCLabel {
-                    text: qsTr("Accel 2: ") + (_activeVehicle.vibration.clipCount2.rawValueString)
+                    visible:    vibrationController.errorString !== ""
+                    text:       vibrationController.errorString
+                    color:      qgcPal.warningText
                 }
 
                 QGCLabel {
-                    text: qsTr("Accel 3: ") + (_activeVehicle.vibration.clipCount3.rawValueString)
+                    visible:    vibrationController.imageUrl !== ""
+                    text:       qsTr("%1 at %2 Hz, %3 s, peak %4 Hz").arg(vibrationController.topicName)
+                                                                       .arg(vibrationController.sampleRate.toFixed(0))
+                                                                       .arg(vibrationController.durationSecs.toFixed(1))
+                                                                       .arg(vibrationController.peakFrequency.toFixed(1))
                 }
-            }
 
-            Rectangle {
-                anchors.fill:   parent
-                color:          qgcPal.window
-                opacity:        0.75
-                visible:        !_available
+                RowLayout {
+                    visible:    vibrationController.imageUrl !== ""
+                    spacing:    _margins
 
-                QGCLabel {
-                    anchors.fill:           parent
-                    horizontalAlignment:    Text.AlignHCenter
-                    verticalAlignment:      Text.AlignVCenter
-                    text:                   qsTr("Not Available")
+                    // Frequency axis
+                    Item {
+                        Layout.fillHeight:      true
+                        Layout.preferredWidth:  ScreenTools.defaultFontPixelWidth * 8
+
+                        QGCLabel {
+                            anchors.top:    parent.top
+                            anchors.right:  parent.right
+                            text:           qsTr("%1 Hz").arg((vibrationController.sampleRate / 2).toFixed(0))
+                        }
+                        QGCLabel {
+                            anchors.bottom: parent.bottom
+                            anchors.right:  parent.right
+                            text:           qsTr("0 Hz")
+                        }
+                    }
+
+                    Image {
+                        Layout.fillWidth:       true
+                        Layout.preferredHeight: ScreenTools.defaultFontPixelHeight * 20
+                        source:                 vibrationController.imageUrl
+                        cache:                  false
+                        smooth:                 true
+                        fillMode:               Image.Stretch
+                    }
                 }
             }
         }
@@ -0,0 +1,251 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VibrationSpectrum.h"
+
+#include <QtMath>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+VibrationSpectrum::VibrationSpectrum(int windowSize)
+    : _windowSize(validWindowSize(windowSize))
+{
+    const int n = _windowSize;
+
+    // Periodic Hann window, amplitudes are corrected for its coherent gain of 0.5
+    _window.resize(n);
+    for (int i=0; i<n; i++) {
+        _window[i] = static_cast<float>(0.5 * (1.0 - qCos((2.0 * M_PI * i) / n)));
+    }
+    _amplitudeScale = 2.0f / (n * 0.5f);
+
+    _bitReverse.resize(n);
+    int bits = 0;
+    while ((1 << bits) < n) {
+        bits++;
+    }
+    for (int i=0; i<n; i++) {
+        int reversed = 0;
+        for (int bit=0; bit<bits; bit++) {
+            if (i & (1 << bit)) {
+                reversed |= 1 << (bits - 1 - bit);
+            }
+        }
+        _bitReverse[i] = reversed;
+    }
+
+    _twiddleReal.resize(n - 1);
+    _twiddleImag.resize(n - 1);
+    for (int half=1; half<n; half*=2) {
+        for (int k=0; k<half; k++) {
+            const double angle = -M_PI * k / half;
+            _twiddleReal[half - 1 + k] = static_cast<float>(qCos(angle));
+            _twiddleImag[half - 1 + k] = static_cast<float>(qSin(angle));
+        }
+    }
+
+    _real.resize(n);
+    _imag.resize(n);
+}
+
+int VibrationSpectrum::validWindowSize(int windowSize)
+{
+    int size = minWindowSize;
+    while (size < maxWindowSize && size * 2 <= windowSize) {
+        size *= 2;
+    }
+    // Round to the nearer of the two powers
+    if (size < maxWindowSize && windowSize - size > (size * 2) - windowSize) {
+        size *= 2;
+    }
+    return size;
+}
+
+void VibrationSpectrum::compute(const float* samples, float* amplitudes)
+{
+    const int       n       = _windowSize;
+    float* const    real    = _real.data();
+    float* const    imag    = _imag.data();
+
+    double sum = 0;
+    for (int i=0; i<n; i++) {
+        sum += samples[i];
+    }
+    const float mean = static_cast<float>(sum / n);
+
+    for (int i=0; i<n; i++) {
+        const int source = _bitReverse[i];
+        real[i] = (samples[source] - mean) * _window[source];
+        imag[i] = 0;
+    }
+
+    for (int half=1; half<n; half*=2) {
+        const float* const twiddleReal = _twiddleReal.constData() + half - 1;
+        const float* const twiddleImag = _twiddleImag.constData() + half - 1;
+        for (int group=0; group<n; group+=2*half) {
+            float* const aReal = real + group;
+            float* const aImag = imag + group;
+            float* const bReal = aReal + half;
+            float* const bImag = aImag + half;
+            for (int k=0; k<half; k++) {
+                const float tReal = (twiddleReal[k] * bReal[k]) - (twiddleImag[k] * bImag[k]);
+                const float tImag = (twiddleReal[k] * bImag[k]) + (twiddleImag[k] * bReal[k]);
+                bReal[k] = aReal[k] - tReal;
+                bImag[k] = aImag[k] - tImag;
+                aReal[k] += tReal;
+                aImag[k] += tImag;
+            }
+        }
+    }
+
+    const int bins = binCount();
+    for (int bin=0; bin<bins; bin++) {
+        amplitudes[bin] = std::sqrt((real[bin] * real[bin]) + (imag[bin] * imag[bin])) * _amplitudeScale;
+    }
+    // DC and Nyquist have no mirror image
+    amplitudes[0]           *= 0.5f;
+    amplitudes[bins - 1]    *= 0.5f;
+}
+
+VibrationSpectrogram::VibrationSpectrogram(int binCount, double sampleRateHz, int maxColumns)
+    : _binCount     (binCount)
+    , _sampleRateHz (sampleRateHz)
+    , _maxColumns   (qMax(maxColumns, 1))
+{
+
+}
+
+void VibrationSpectrogram::appendColumn(quint64 timeUSecs, const float* x, const float* y, const float* z)
+{
+    const float* columns[axisCount] = { x, y, z };
+
+    if (_timesUSecs.count() >= _maxColumns) {
+        _timesUSecs.removeFirst();
+        for (int axis=0; axis<axisCount; axis++) {
+            _amplitudes[axis].remove(0, _binCount);
+        }
+    }
+
+    _timesUSecs.append(timeUSecs);
+    for (int axis=0; axis<axisCount; axis++) {
+        const int offset = _amplitudes[axis].count();
+        _amplitudes[axis].resize(offset + _binCount);
+        std::copy(columns[axis], columns[axis] + _binCount, _amplitudes[axis].begin() + offset);
+    }
+}
+
+double VibrationSpectrogram::binFrequency(int bin) const
+{
+    if (_binCount < 2) {
+        return 0;
+    }
+    return (bin * _sampleRateHz) / (2.0 * (_binCount - 1));
+}
+
+float VibrationSpectrogram::amplitude(Axis_t axis, int column, int bin) const
+{
+    const int index = (column * _binCount) + bin;
+
+    if (axis == AxisAll) {
+        float sumSquares = 0;
+        for (int i=0; i<axisCount; i++) {
+            const float value = _amplitudes[i][index];
+            sumSquares += value * value;
+        }
+        return std::sqrt(sumSquares);
+    }
+    return _amplitudes[axis][index];
+}
+
+QVector<float> VibrationSpectrogram::averageSpectrum(Axis_t axis) const
+{
+    QVector<float>  average(_binCount, 0.0f);
+    const int       columns = columnCount();
+
+    if (columns == 0) {
+        return average;
+    }
+    for (int column=0; column<columns; column++) {
+        for (int bin=0; bin<_binCount; bin++) {
+            average[bin] += amplitude(axis, column, bin);
+        }
+    }
+    for (int bin=0; bin<_binCount; bin++) {
+        average[bin] /= columns;
+    }
+    return average;
+}
+
+double VibrationSpectrogram::peakFrequency(Axis_t axis, double minFrequencyHz) const
+{
+    const QVector<float> average = averageSpectrum(axis);
+
+    int     peakBin         = -1;
+    float   peakAmplitude   = 0;
+    for (int bin=0; bin<_binCount; bin++) {
+        if (binFrequency(bin) >= minFrequencyHz && average[bin] > peakAmplitude) {
+            peakBin         = bin;
+            peakAmplitude   = average[bin];
+        }
+    }
+    return peakBin == -1 ? 0 : binFrequency(peakBin);
+}
+
+QImage VibrationSpectrogram::render(Axis_t axis, double dynamicRangeDB) const
+{
+    const int columns = columnCount();
+    if (columns == 0 || _binCount == 0) {
+        return QImage();
+    }
+
+    // Decibels relative to the highest amplitude
+    QVector<float>  decibels(columns * _binCount);
+    float           maxDecibels = -std::numeric_limits<float>::max();
+    for (int column=0; column<columns; column++) {
+        for (int bin=0; bin<_binCount; bin++) {
+            const float value = 20.0f * std::log10(qMax(amplitude(axis, column, bin), 1e-9f));
+            decibels[(column * _binCount) + bin] = value;
+            maxDecibels = qMax(maxDecibels, value);
+        }
+    }
+
+    QImage image(columns, _binCount, QImage::Format_RGB32);
+    for (int bin=0; bin<_binCount; bin++) {
+        QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(_binCount - 1 - bin));
+        for (int column=0; column<columns; column++) {
+            const double value = 1.0 + ((decibels[(column * _binCount) + bin] - maxDecibels) / dynamicRangeDB);
+            line[column] = _color(value);
+        }
+    }
+    return image;
+}
+
+QRgb VibrationSpectrogram::_color(double value)
+{
+    // Black through blue, red and yellow to white
+    static const int stops[][3] = {
+        {   0,   0,   0 },
+        {  32,   0, 128 },
+        { 192,   0,  64 },
+        { 255, 160,   0 },
+        { 255, 255, 255 },
+    };
+    static const int stopCount = sizeof(stops) / sizeof(stops[0]);
+
+    value = qBound(0.0, value, 1.0) * (stopCount - 1);
+    const int       stop        = qMin(static_cast<int>(value), stopCount - 2);
+    const double    fraction    = value - stop;
+    int rgb[3];
+    for (int i=0; i<3; i++) {
+        rgb[i] = static_cast<int>(stops[stop][i] + (fraction * (stops[stop + 1][i] - stops[stop][i])));
+    }
+    return qRgb(rgb[0], rgb[1], rgb[2]);
+}
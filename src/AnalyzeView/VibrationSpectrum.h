@@ -0,0 +1,103 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QImage>
+#include <QMetaType>
+#include <QVector>
+
+/// Amplitude spectrum of a window of uniformly sampled data: the mean is removed, a Hann window applied and the
+/// window transformed by a radix 2 FFT. The butterflies work on separate real and imaginary arrays with the twiddles
+/// of each stage stored contiguously, which lets the compiler vectorize the inner loop on all our targets.
+class VibrationSpectrum
+{
+public:
+    VibrationSpectrum(int windowSize = defaultWindowSize);
+
+    int windowSize  (void) const { return _windowSize; }
+    int binCount    (void) const { return (_windowSize / 2) + 1; }     ///< From 0 Hz up to and including Nyquist
+
+    /// Transforms windowSize samples
+    ///     @param[out] amplitudes binCount amplitudes, in the unit of the samples
+    void compute(const float* samples, float* amplitudes);
+
+    /// @return Power of two window size nearest to windowSize, within minWindowSize and maxWindowSize
+    static int validWindowSize(int windowSize);
+
+    static const int defaultWindowSize  = 1024;
+    static const int minWindowSize      = 64;
+    static const int maxWindowSize      = 8192;
+
+private:
+    int             _windowSize;
+    QVector<float>  _window;
+    QVector<float>  _twiddleReal;   ///< Stage with h butterflies per group starts at h - 1
+    QVector<float>  _twiddleImag;
+    QVector<int>    _bitReverse;
+    QVector<float>  _real;
+    QVector<float>  _imag;
+    float           _amplitudeScale;
+};
+
+/// Spectra of consecutive windows of the three axes of a sensor, oldest column first. Once maxColumns are held the
+/// oldest column is dropped for each one appended.
+class VibrationSpectrogram
+{
+public:
+    VibrationSpectrogram(int binCount = 0, double sampleRateHz = 0, int maxColumns = defaultMaxColumns);
+
+    typedef enum {
+        AxisX = 0,
+        AxisY,
+        AxisZ,
+        AxisAll,    ///< Root sum square of the three axes
+    } Axis_t;
+
+    static const int axisCount = 3;
+
+    /// Appends the spectra of a window, each array holds binCount amplitudes
+    void appendColumn(quint64 timeUSecs, const float* x, const float* y, const float* z);
+
+    int     binCount        (void) const { return _binCount; }
+    int     columnCount     (void) const { return _timesUSecs.count(); }
+    int     maxColumns      (void) const { return _maxColumns; }
+    double  sampleRateHz    (void) const { return _sampleRateHz; }
+    double  binFrequency    (int bin) const;
+
+    /// @return Start time of the window of a column
+    quint64 columnTimeUSecs (int column) const { return _timesUSecs[column]; }
+
+    /// @return Amplitude of the bin in the column
+    float amplitude(Axis_t axis, int column, int bin) const;
+
+    /// @return Mean amplitude of each bin over all columns
+    QVector<float> averageSpectrum(Axis_t axis) const;
+
+    /// @return Frequency of the highest bin of the average spectrum at or above minFrequencyHz, 0 for none
+    double peakFrequency(Axis_t axis, double minFrequencyHz = 0) const;
+
+    /// Renders the amplitudes in dB on a color scale covering dynamicRangeDB below the highest amplitude. The image
+    /// is a pixel per column and bin, time from left to right and frequency from bottom to top.
+    QImage render(Axis_t axis, double dynamicRangeDB = defaultDynamicRangeDB) const;
+
+    static const int        defaultMaxColumns       = 2000;
+    static constexpr double defaultDynamicRangeDB   = 60;
+
+private:
+    static QRgb _color(double value);
+
+    int                 _binCount;
+    double              _sampleRateHz;
+    int                 _maxColumns;
+    QVector<quint64>    _timesUSecs;
+    QVector<float>      _amplitudes[axisCount];     ///< binCount amplitudes per column
+};
+
+Q_DECLARE_METATYPE(VibrationSpectrogram)
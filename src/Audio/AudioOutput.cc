@@ -17,8 +17,10 @@
 #include "SettingsManager.h"
 
 AudioOutput::AudioOutput(QGCApplication* app, QGCToolbox* toolbox)
-    : QGCTool   (app, toolbox)
-    , _tts      (nullptr)
+    : QGCTool           (app, toolbox)
+    , _tts              (nullptr)
+    , _speaking         (false)
+    , _speakingPriority (AudioOutputQueue::PriorityNormal)
 {
     if (qgcApp()->runningUnitTests()) {
         // Cloud based unit tests don't have speech capabilty. If you try to crank up
@@ -34,44 +36,71 @@ AudioOutput::AudioOutput(QGCApplication* app, QGCToolbox* toolbox)
     _tts->setLocale(QLocale("en_US"));
 #endif
     connect(_tts, &QTextToSpeech::stateChanged, this, &AudioOutput::_stateChanged);
+
+    _queueClock.start();
+    _nextTimer.setSingleShot(true);
+    connect(&_nextTimer, &QTimer::timeout, this, &AudioOutput::_sayNext);
+}
+
+void AudioOutput::say(const QString& text)
+{
+    say(text, 0, QString(), AudioOutputQueue::PriorityNormal);
 }
 
-void AudioOutput::say(const QString& inText)
+void AudioOutput::say(const QString& inText, int vehicleId, const QString& messageClass, AudioOutputQueue::Priority priority)
 {
     if (!_tts) {
         qDebug() << "say" << inText;
         return;
     }
 
-    bool muted = qgcApp()->toolbox()->settingsManager()->appSettings()->audioMuted()->rawValue().toBool();
+    AppSettings* appSettings = qgcApp()->toolbox()->settingsManager()->appSettings();
+    bool muted = appSettings->audioMuted()->rawValue().toBool();
     muted |= qgcApp()->runningUnitTests();
     if (!muted && !qgcApp()->runningUnitTests()) {
-        QString text = fixTextMessageForAudio(inText);
-        if(_tts->state() == QTextToSpeech::Speaking) {
-            if(!_texts.contains(text)) {
-                //-- Some arbitrary limit
-                if(_texts.size() > 20) {
-                    _texts.removeFirst();
-                }
-                _texts.append(text);
+        _queue.setMaxAgeMsecs(static_cast<int>(appSettings->audioMessageMaxAge()->rawValue().toDouble() * 1000));
+        _queue.setVehicleIntervalMsecs(static_cast<int>(appSettings->audioVehicleInterval()->rawValue().toDouble() * 1000));
+        _queue.enqueue(fixTextMessageForAudio(inText), vehicleId, messageClass, priority, _queueClock.elapsed());
+        if (_speaking) {
+            if (priority == AudioOutputQueue::PriorityCritical && _speakingPriority != AudioOutputQueue::PriorityCritical) {
+                // Ready state change says the critical announcement
+                _tts->stop();
             }
         } else {
-            _tts->say(text);
+            _sayNext();
         }
     }
 }
 
-void AudioOutput::_stateChanged(QTextToSpeech::State state)
+void AudioOutput::_sayNext(void)
 {
-    if(state == QTextToSpeech::Ready) {
-        if(_texts.size()) {
-            QString text = _texts.first();
-            _texts.removeFirst();
-            _tts->say(text);
+    if (!_tts || _speaking) {
+        return;
+    }
+    _nextTimer.stop();
+
+    AudioOutputQueue::Announcement_t announcement;
+    qint64 now = _queueClock.elapsed();
+    if (_queue.takeNext(now, announcement)) {
+        _speaking           = true;
+        _speakingPriority   = announcement.priority;
+        _tts->say(announcement.text);
+    } else {
+        int msecs = _queue.msecsUntilNext(now);
+        if (msecs >= 0) {
+            _nextTimer.start(msecs);
         }
     }
 }
 
+void AudioOutput::_stateChanged(QTextToSpeech::State state)
+{
+    if (state == QTextToSpeech::Ready || state == QTextToSpeech::BackendError) {
+        _speaking = false;
+        _sayNext();
+    }
+}
+
 bool AudioOutput::getMillisecondString(const QString& string, QString& match, int& number) {
     static QRegularExpression re("([0-9]+ms)");
     QRegularExpressionMatchIterator i = re.globalMatch(string);
@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QTimer>
 #include <QThread>
@@ -16,6 +17,7 @@
 #include <QTextToSpeech>
 
 #include "QGCToolbox.h"
+#include "AudioOutputQueue.h"
 
 class QGCApplication;
 
@@ -33,11 +35,22 @@ public slots:
     /// Convert string to speech output and say it
     void            say                     (const QString& text);
 
+public:
+    /// Queues the announcement, see AudioOutputQueue for how it is ordered, coalesced and rate limited
+    ///     @param vehicleId 0: not from a vehicle
+    ///     @param messageClass Announcements of the same vehicle and class replace each other, e.g. "flightMode"
+    void            say                     (const QString& text, int vehicleId, const QString& messageClass, AudioOutputQueue::Priority priority);
+
 private slots:
     void            _stateChanged           (QTextToSpeech::State state);
+    void            _sayNext                (void);
 
 protected:
-    QTextToSpeech*  _tts;
-    QStringList     _texts;
+    QTextToSpeech*              _tts;
+    AudioOutputQueue            _queue;
+    QElapsedTimer               _queueClock;
+    QTimer                      _nextTimer;             ///< Waits out the vehicle interval of the next announcement
+    bool                        _speaking;
+    AudioOutputQueue::Priority  _speakingPriority;
 };
 
@@ -0,0 +1,98 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "AudioOutputQueue.h"
+
+void AudioOutputQueue::enqueue(const QString& text, int vehicleId, const QString& messageClass, Priority priority, qint64 nowMsecs)
+{
+    // Coalesce with what is already waiting
+    for (int i=0; i<_announcements.count(); i++) {
+        const Announcement_t& queued = _announcements[i];
+        if (queued.vehicleId == vehicleId && queued.messageClass == messageClass && (!messageClass.isEmpty() || queued.text == text)) {
+            if (priority < queued.priority) {
+                // Keep the urgency of the state which is being replaced
+                priority = queued.priority;
+            }
+            _announcements.removeAt(i);
+            break;
+        }
+    }
+
+    int index = _announcements.count();
+    while (index > 0 && _announcements[index - 1].priority < priority) {
+        index--;
+    }
+    _announcements.insert(index, Announcement_t{ text, vehicleId, messageClass, priority, nowMsecs });
+
+    if (_announcements.count() > maxCount) {
+        // The oldest of the least important goes
+        int lowest = _announcements.last().priority;
+        for (int i=0; i<_announcements.count(); i++) {
+            if (_announcements[i].priority == lowest) {
+                _announcements.removeAt(i);
+                break;
+            }
+        }
+    }
+}
+
+bool AudioOutputQueue::takeNext(qint64 nowMsecs, Announcement_t& announcement)
+{
+    _expire(nowMsecs);
+    for (int i=0; i<_announcements.count(); i++) {
+        if (_msecsUntilFree(_announcements[i], nowMsecs) == 0) {
+            announcement = _announcements.takeAt(i);
+            if (announcement.vehicleId != 0) {
+                _lastSpokenMsecs[announcement.vehicleId] = nowMsecs;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+int AudioOutputQueue::msecsUntilNext(qint64 nowMsecs)
+{
+    _expire(nowMsecs);
+    int msecs = -1;
+    for (const Announcement_t& announcement: _announcements) {
+        int free = _msecsUntilFree(announcement, nowMsecs);
+        if (msecs == -1 || free < msecs) {
+            msecs = free;
+        }
+    }
+    return msecs;
+}
+
+void AudioOutputQueue::clear(void)
+{
+    _announcements.clear();
+    _lastSpokenMsecs.clear();
+}
+
+void AudioOutputQueue::_expire(qint64 nowMsecs)
+{
+    if (_maxAgeMsecs <= 0) {
+        return;
+    }
+    for (int i=_announcements.count() - 1; i>=0; i--) {
+        if (nowMsecs - _announcements[i].queuedMsecs > _maxAgeMsecs) {
+            _announcements.removeAt(i);
+        }
+    }
+}
+
+int AudioOutputQueue::_msecsUntilFree(const Announcement_t& announcement, qint64 nowMsecs) const
+{
+    if (announcement.priority == PriorityCritical || announcement.vehicleId == 0 || !_lastSpokenMsecs.contains(announcement.vehicleId)) {
+        return 0;
+    }
+    qint64 free = _lastSpokenMsecs[announcement.vehicleId] + _vehicleIntervalMsecs - nowMsecs;
+    return free > 0 ? static_cast<int>(free) : 0;
+}
@@ -0,0 +1,68 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+/// Announcements waiting to be spoken, so speech follows what is happening now instead of working through a backlog.
+///  - Higher priority first, oldest first within a priority
+///  - A new announcement replaces a queued one of the same vehicle and message class, only the latest state is spoken
+///  - Announcements older than the max age are dropped
+///  - A vehicle is spoken for at most once per vehicle interval, unless the announcement is critical
+/// Times are msecs on any monotonic clock.
+class AudioOutputQueue
+{
+public:
+    enum Priority {
+        PriorityNormal,
+        PriorityHigh,
+        PriorityCritical,   ///< Interrupts whatever is being said
+    };
+
+    typedef struct {
+        QString     text;
+        int         vehicleId;      ///< 0: not from a vehicle, never rate limited
+        QString     messageClass;   ///< Empty: only identical texts are coalesced
+        Priority    priority;
+        qint64      queuedMsecs;
+    } Announcement_t;
+
+    void    setMaxAgeMsecs          (int maxAgeMsecs)           { _maxAgeMsecs = maxAgeMsecs; }
+    void    setVehicleIntervalMsecs (int vehicleIntervalMsecs)  { _vehicleIntervalMsecs = vehicleIntervalMsecs; }
+    int     maxAgeMsecs             (void) const { return _maxAgeMsecs; }
+    int     vehicleIntervalMsecs    (void) const { return _vehicleIntervalMsecs; }
+
+    void    enqueue     (const QString& text, int vehicleId, const QString& messageClass, Priority priority, qint64 nowMsecs);
+
+    /// Takes the next announcement which may be spoken now
+    /// @return false: nothing to say right now
+    bool    takeNext    (qint64 nowMsecs, Announcement_t& announcement);
+
+    /// @return Msecs until takeNext will hand out an announcement, -1 if there is nothing queued
+    int     msecsUntilNext  (qint64 nowMsecs);
+
+    int     count       (void) const { return _announcements.count(); }
+    void    clear       (void);
+
+    static const int maxCount                       = 20;
+    static const int defaultMaxAgeMsecs             = 10000;
+    static const int defaultVehicleIntervalMsecs    = 2000;
+
+private:
+    void    _expire         (qint64 nowMsecs);
+    int     _msecsUntilFree (const Announcement_t& announcement, qint64 nowMsecs) const;
+
+    QList<Announcement_t>   _announcements;         ///< In the order they are spoken
+    QHash<int, qint64>      _lastSpokenMsecs;       ///< Vehicle id to when it was last spoken for
+    int                     _maxAgeMsecs            = defaultMaxAgeMsecs;
+    int                     _vehicleIntervalMsecs   = defaultVehicleIntervalMsecs;
+};
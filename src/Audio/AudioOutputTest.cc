@@ -9,6 +9,7 @@
 
 #include "AudioOutputTest.h"
 #include "AudioOutput.h"
+#include "AudioOutputQueue.h"
 
 AudioOutputTest::AudioOutputTest(void)
 {
@@ -30,3 +31,115 @@ void AudioOutputTest::_testSpokenReplacements(void)
     result = AudioOutput::fixTextMessageForAudio(QStringLiteral("10moo"));
     QCOMPARE(result, QStringLiteral("10moo"));
 }
+
+void AudioOutputTest::_testQueuePriority(void)
+{
+    AudioOutputQueue                queue;
+    AudioOutputQueue::Announcement_t announcement;
+
+    queue.enqueue("normal 1",   1, "a", AudioOutputQueue::PriorityNormal,   0);
+    queue.enqueue("high",       2, "b", AudioOutputQueue::PriorityHigh,     0);
+    queue.enqueue("normal 2",   3, "c", AudioOutputQueue::PriorityNormal,   0);
+    queue.enqueue("critical",   4, "d", AudioOutputQueue::PriorityCritical, 0);
+    QCOMPARE(queue.count(), 4);
+
+    QStringList spoken;
+    while (queue.takeNext(0, announcement)) {
+        spoken.append(announcement.text);
+    }
+    QCOMPARE(spoken, QStringList({ "critical", "high", "normal 1", "normal 2" }));
+
+    // A full queue drops the oldest of the least important
+    const int maxCount = AudioOutputQueue::maxCount;
+    queue.enqueue("critical", 0, "critical", AudioOutputQueue::PriorityCritical, 0);
+    for (int i=0; i<maxCount; i++) {
+        queue.enqueue(QString::number(i), 0, QString(), AudioOutputQueue::PriorityNormal, 0);
+    }
+    QCOMPARE(queue.count(), maxCount);
+    QVERIFY(queue.takeNext(0, announcement));
+    QCOMPARE(announcement.text, QStringLiteral("critical"));
+    QVERIFY(queue.takeNext(0, announcement));
+    QCOMPARE(announcement.text, QStringLiteral("1"));
+}
+
+void AudioOutputTest::_testQueueCoalesce(void)
+{
+    AudioOutputQueue                queue;
+    AudioOutputQueue::Announcement_t announcement;
+
+    // Same vehicle and class: only the latest flight mode is spoken
+    queue.enqueue("loiter",     1, "flightMode", AudioOutputQueue::PriorityNormal, 0);
+    queue.enqueue("mission",    1, "flightMode", AudioOutputQueue::PriorityNormal, 10);
+    queue.enqueue("manual",     2, "flightMode", AudioOutputQueue::PriorityNormal, 20);
+    queue.enqueue("rtl",        1, "flightMode", AudioOutputQueue::PriorityNormal, 30);
+    QCOMPARE(queue.count(), 2);
+    QVERIFY(queue.takeNext(30, announcement));
+    QCOMPARE(announcement.text, QStringLiteral("manual"));
+    QVERIFY(queue.takeNext(30, announcement));
+    QCOMPARE(announcement.text, QStringLiteral("rtl"));
+    QCOMPARE(announcement.vehicleId, 1);
+
+    // No class: only identical texts coalesce
+    queue.enqueue("gps lost", 1, QString(), AudioOutputQueue::PriorityNormal, 0);
+    queue.enqueue("gps lost", 1, QString(), AudioOutputQueue::PriorityNormal, 0);
+    queue.enqueue("ekf lost", 1, QString(), AudioOutputQueue::PriorityNormal, 0);
+    QCOMPARE(queue.count(), 2);
+
+    // The replacement keeps the higher priority
+    queue.clear();
+    queue.enqueue("low battery",    1, "battery", AudioOutputQueue::PriorityCritical,   0);
+    queue.enqueue("other",          2, "other",   AudioOutputQueue::PriorityHigh,       0);
+    queue.enqueue("battery ok",     1, "battery", AudioOutputQueue::PriorityNormal,     0);
+    QVERIFY(queue.takeNext(0, announcement));
+    QCOMPARE(announcement.text, QStringLiteral("battery ok"));
+    QCOMPARE(announcement.priority, AudioOutputQueue::PriorityCritical);
+}
+
+void AudioOutputTest::_testQueueExpiry(void)
+{
+    AudioOutputQueue                queue;
+    AudioOutputQueue::Announcement_t announcement;
+
+    queue.setMaxAgeMsecs(1000);
+    queue.enqueue("old",    0, "a", AudioOutputQueue::PriorityCritical, 0);
+    queue.enqueue("new",    0, "b", AudioOutputQueue::PriorityNormal,   800);
+    QCOMPARE(queue.msecsUntilNext(1500), 0);
+    QCOMPARE(queue.count(), 1);
+    QVERIFY(queue.takeNext(1500, announcement));
+    QCOMPARE(announcement.text, QStringLiteral("new"));
+
+    queue.enqueue("stale", 0, "a", AudioOutputQueue::PriorityNormal, 0);
+    QVERIFY(!queue.takeNext(5000, announcement));
+    QCOMPARE(queue.count(), 0);
+    QCOMPARE(queue.msecsUntilNext(5000), -1);
+}
+
+void AudioOutputTest::_testQueueVehicleRate(void)
+{
+    AudioOutputQueue                queue;
+    AudioOutputQueue::Announcement_t announcement;
+
+    queue.setMaxAgeMsecs(60000);
+    queue.setVehicleIntervalMsecs(2000);
+    queue.enqueue("mode",   1, "flightMode",    AudioOutputQueue::PriorityNormal, 0);
+    queue.enqueue("armed",  1, "armed",         AudioOutputQueue::PriorityNormal, 0);
+    queue.enqueue("other",  2, "flightMode",    AudioOutputQueue::PriorityNormal, 0);
+
+    QVERIFY(queue.takeNext(0, announcement));
+    QCOMPARE(announcement.text, QStringLiteral("mode"));
+
+    // Vehicle 1 has to wait, vehicle 2 goes ahead of it
+    QVERIFY(queue.takeNext(100, announcement));
+    QCOMPARE(announcement.text, QStringLiteral("other"));
+    QVERIFY(!queue.takeNext(100, announcement));
+    QCOMPARE(queue.msecsUntilNext(100), 1900);
+
+    // Critical alerts are not held back
+    queue.enqueue("failsafe", 1, "failsafe", AudioOutputQueue::PriorityCritical, 200);
+    QVERIFY(queue.takeNext(200, announcement));
+    QCOMPARE(announcement.text, QStringLiteral("failsafe"));
+
+    QCOMPARE(queue.msecsUntilNext(2000), 200);
+    QVERIFY(queue.takeNext(2200, announcement));
+    QCOMPARE(announcement.text, QStringLiteral("armed"));
+}
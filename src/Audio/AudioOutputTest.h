@@ -20,4 +20,8 @@ public:
 
 private slots:
     void _testSpokenReplacements(void);
+    void _testQueuePriority     (void);
+    void _testQueueCoalesce     (void);
+    void _testQueueExpiry       (void);
+    void _testQueueVehicleRate  (void);
 };
@@ -11,6 +11,9 @@
 #include "APMCompassCal.h"
 #include "AutoPilotPlugin.h"
 #include "ParameterManager.h"
+#include "MessageRateManager.h"
+
+#include <QtConcurrent>
 
 QGC_LOGGING_CATEGORY(APMCompassCalLog, "APMCompassCalLog")
 
@@ -71,52 +74,24 @@ CalWorkerThread::calibrate_return CalWorkerThread::calibrate(void)
     worker_data.side_data_collected[DETECT_ORIENTATION_UPSIDE_DOWN] =   false;
     worker_data.side_data_collected[DETECT_ORIENTATION_RIGHT] =         false;
 
-    for (size_t cur_mag=0; cur_mag<max_mags; cur_mag++) {
-        // Initialize to no memory allocated
-        worker_data.x[cur_mag] = nullptr;
-        worker_data.y[cur_mag] = nullptr;
-        worker_data.z[cur_mag] = nullptr;
-        worker_data.calibration_counter_total[cur_mag] = 0;
-    }
-
     const unsigned int calibration_points_maxcount = calibration_sides * worker_data.calibration_points_perside;
 
     for (size_t cur_mag=0; cur_mag<max_mags; cur_mag++) {
-        if (rgCompassAvailable[cur_mag]) {
-            worker_data.x[cur_mag] = reinterpret_cast<float *>(malloc(sizeof(float) * calibration_points_maxcount));
-            worker_data.y[cur_mag] = reinterpret_cast<float *>(malloc(sizeof(float) * calibration_points_maxcount));
-            worker_data.z[cur_mag] = reinterpret_cast<float *>(malloc(sizeof(float) * calibration_points_maxcount));
-            if (worker_data.x[cur_mag] == nullptr || worker_data.y[cur_mag] == nullptr || worker_data.z[cur_mag] == nullptr) {
-                _emitVehicleTextMessage(QStringLiteral("[cal] ERROR: out of memory"));
-                result = calibrate_return_error;
-            }
-        }
-    }
-
-    if (result == calibrate_return_ok) {
-        result = calibrate_from_orientation(
-                    worker_data.side_data_collected,    // Sides to calibrate
-                    &worker_data);                      // Opaque data for calibration worked
+        worker_data.fit[cur_mag].reset(rgCompassAvailable[cur_mag] ? static_cast<int>(calibration_points_maxcount) : 0);
     }
 
-    // Calculate calibration values for each mag
+    result = calibrate_from_orientation(
+                worker_data.side_data_collected,    // Sides to calibrate
+                &worker_data);                      // Opaque data for calibration worked
 
-    float sphere_x[max_mags];
-    float sphere_y[max_mags];
-    float sphere_z[max_mags];
-    float sphere_radius[max_mags];
-
-    // Sphere fit the data to get calibration values
+    // Sphere fit the data to get calibration values. The fit has been following along as samples came in, this settles it.
     if (result == calibrate_return_ok) {
+        _refineFits(&worker_data, final_fit_iterations);
+
         for (unsigned cur_mag=0; cur_mag<max_mags; cur_mag++) {
             if (rgCompassAvailable[cur_mag]) {
-                sphere_fit_least_squares(worker_data.x[cur_mag], worker_data.y[cur_mag], worker_data.z[cur_mag],
-                                         worker_data.calibration_counter_total[cur_mag],
-                                         100, 0.0f,
-                                         &sphere_x[cur_mag], &sphere_y[cur_mag], &sphere_z[cur_mag],
-                                         &sphere_radius[cur_mag]);
-
-                if (qIsNaN(sphere_x[cur_mag]) || qIsNaN(sphere_y[cur_mag]) || qIsNaN(sphere_z[cur_mag])) {
+                const CompassSphereFit& fit = worker_data.fit[cur_mag];
+                if (!fit.valid() || qIsNaN(fit.centerX()) || qIsNaN(fit.centerY()) || qIsNaN(fit.centerZ())) {
                     _emitVehicleTextMessage(QStringLiteral("[cal] ERROR: NaN in sphere fit for mag %1").arg(cur_mag));
                     result = calibrate_return_error;
                 }
@@ -124,17 +99,11 @@ CalWorkerThread::calibrate_return CalWorkerThread::calibrate(void)
         }
     }
 
-    // Data points are no longer needed
-    for (size_t cur_mag=0; cur_mag<max_mags; cur_mag++) {
-        free(worker_data.x[cur_mag]);
-        free(worker_data.y[cur_mag]);
-        free(worker_data.z[cur_mag]);
-    }
-
     if (result == calibrate_return_ok) {
         for (unsigned cur_mag=0; cur_mag<max_mags; cur_mag++) {
             if (rgCompassAvailable[cur_mag]) {
-                _emitVehicleTextMessage(QStringLiteral("[cal] mag #%1 off: x:%2 y:%3 z:%4").arg(cur_mag).arg(-sphere_x[cur_mag]).arg(-sphere_y[cur_mag]).arg(-sphere_z[cur_mag]));
+                const CompassSphereFit& fit = worker_data.fit[cur_mag];
+                _emitVehicleTextMessage(QStringLiteral("[cal] mag #%1 off: x:%2 y:%3 z:%4 fitness:%5").arg(cur_mag).arg(-fit.centerX()).arg(-fit.centerY()).arg(-fit.centerZ()).arg(fit.fitness()));
 
                 float sensorId = 0.0f;
                 if (cur_mag == 0) {
@@ -148,7 +117,7 @@ CalWorkerThread::calibrate_return CalWorkerThread::calibrate(void)
                     _vehicle->sendMavCommand(_vehicle->defaultComponentId(),
                                              MAV_CMD_PREFLIGHT_SET_SENSOR_OFFSETS,
                                              true, /* showErrors */
-                                             sensorId, -sphere_x[cur_mag], -sphere_y[cur_mag], -sphere_z[cur_mag]);
+                                             sensorId, -fit.centerX(), -fit.centerY(), -fit.centerZ());
                 }
             }
         }
@@ -189,14 +158,14 @@ CalWorkerThread::calibrate_return CalWorkerThread::mag_calibration_worker(detect
             mavlink_scaled_imu_t copyLastScaledImu = rgLastScaledImu[cur_mag];
             lastScaledImuMutex.unlock();
 
-            worker_data->x[cur_mag][worker_data->calibration_counter_total[cur_mag]] = copyLastScaledImu.xmag;
-            worker_data->y[cur_mag][worker_data->calibration_counter_total[cur_mag]] = copyLastScaledImu.ymag;
-            worker_data->z[cur_mag][worker_data->calibration_counter_total[cur_mag]] = copyLastScaledImu.zmag;
-            worker_data->calibration_counter_total[cur_mag]++;
+            worker_data->fit[cur_mag].addSample(copyLastScaledImu.xmag, copyLastScaledImu.ymag, copyLastScaledImu.zmag);
         }
 
         calibration_counter_side++;
 
+        // Fitness feedback while the vehicle is still being rotated
+        _refineFits(worker_data, live_fit_iterations);
+
         // Progress indicator for side
         _emitVehicleTextMessage(QStringLiteral("[cal] %1 side calibration: progress <%2>").arg(detect_orientation_str(orientation)).arg(progress_percentage(worker_data) +
                                                                                                                                         (unsigned)((100 / calibration_sides) * ((float)calibration_counter_side / (float)worker_data->calibration_points_perside))));
@@ -382,182 +351,24 @@ const char* CalWorkerThread::detect_orientation_str(enum detect_orientation_retu
     return rgOrientationStrs[orientation];
 }
 
-int CalWorkerThread::sphere_fit_least_squares(const float x[], const float y[], const float z[],
-                                              unsigned int size, unsigned int max_iterations, float delta, float *sphere_x, float *sphere_y, float *sphere_z,
-                                              float *sphere_radius)
+void CalWorkerThread::_refineFits(mag_worker_data_t* worker_data, int maxIterations)
 {
-
-    float x_sumplain = 0.0f;
-    float x_sumsq = 0.0f;
-    float x_sumcube = 0.0f;
-
-    float y_sumplain = 0.0f;
-    float y_sumsq = 0.0f;
-    float y_sumcube = 0.0f;
-
-    float z_sumplain = 0.0f;
-    float z_sumsq = 0.0f;
-    float z_sumcube = 0.0f;
-
-    float xy_sum = 0.0f;
-    float xz_sum = 0.0f;
-    float yz_sum = 0.0f;
-
-    float x2y_sum = 0.0f;
-    float x2z_sum = 0.0f;
-    float y2x_sum = 0.0f;
-    float y2z_sum = 0.0f;
-    float z2x_sum = 0.0f;
-    float z2y_sum = 0.0f;
-
-    for (unsigned int i = 0; i < size; i++) {
-
-        float x2 = x[i] * x[i];
-        float y2 = y[i] * y[i];
-        float z2 = z[i] * z[i];
-
-        x_sumplain += x[i];
-        x_sumsq += x2;
-        x_sumcube += x2 * x[i];
-
-        y_sumplain += y[i];
-        y_sumsq += y2;
-        y_sumcube += y2 * y[i];
-
-        z_sumplain += z[i];
-        z_sumsq += z2;
-        z_sumcube += z2 * z[i];
-
-        xy_sum += x[i] * y[i];
-        xz_sum += x[i] * z[i];
-        yz_sum += y[i] * z[i];
-
-        x2y_sum += x2 * y[i];
-        x2z_sum += x2 * z[i];
-
-        y2x_sum += y2 * x[i];
-        y2z_sum += y2 * z[i];
-
-        z2x_sum += z2 * x[i];
-        z2y_sum += z2 * y[i];
+    // Each mag has its own samples, so the fits don't depend on each other
+    QList<QFuture<bool>> futures;
+    for (unsigned cur_mag=0; cur_mag<max_mags; cur_mag++) {
+        if (rgCompassAvailable[cur_mag]) {
+            futures.append(QtConcurrent::run(&worker_data->fit[cur_mag], &CompassSphereFit::refine, maxIterations));
+        }
     }
-
-    //
-    //Least Squares Fit a sphere A,B,C with radius squared Rsq to 3D data
-    //
-    //    P is a structure that has been computed with the data earlier.
-    //    P.npoints is the number of elements; the length of X,Y,Z are identical.
-    //    P's members are logically named.
-    //
-    //    X[n] is the x component of point n
-    //    Y[n] is the y component of point n
-    //    Z[n] is the z component of point n
-    //
-    //    A is the x coordiante of the sphere
-    //    B is the y coordiante of the sphere
-    //    C is the z coordiante of the sphere
-    //    Rsq is the radius squared of the sphere.
-    //
-    //This method should converge; maybe 5-100 iterations or more.
-    //
-    float x_sum = x_sumplain / size;        //sum( X[n] )
-    float x_sum2 = x_sumsq / size;    //sum( X[n]^2 )
-    float x_sum3 = x_sumcube / size;    //sum( X[n]^3 )
-    float y_sum = y_sumplain / size;        //sum( Y[n] )
-    float y_sum2 = y_sumsq / size;    //sum( Y[n]^2 )
-    float y_sum3 = y_sumcube / size;    //sum( Y[n]^3 )
-    float z_sum = z_sumplain / size;        //sum( Z[n] )
-    float z_sum2 = z_sumsq / size;    //sum( Z[n]^2 )
-    float z_sum3 = z_sumcube / size;    //sum( Z[n]^3 )
-
-    float XY = xy_sum / size;        //sum( X[n] * Y[n] )
-    float XZ = xz_sum / size;        //sum( X[n] * Z[n] )
-    float YZ = yz_sum / size;        //sum( Y[n] * Z[n] )
-    float X2Y = x2y_sum / size;    //sum( X[n]^2 * Y[n] )
-    float X2Z = x2z_sum / size;    //sum( X[n]^2 * Z[n] )
-    float Y2X = y2x_sum / size;    //sum( Y[n]^2 * X[n] )
-    float Y2Z = y2z_sum / size;    //sum( Y[n]^2 * Z[n] )
-    float Z2X = z2x_sum / size;    //sum( Z[n]^2 * X[n] )
-    float Z2Y = z2y_sum / size;    //sum( Z[n]^2 * Y[n] )
-
-    //Reduction of multiplications
-    float F0 = x_sum2 + y_sum2 + z_sum2;
-    float F1 =  0.5f * F0;
-    float F2 = -8.0f * (x_sum3 + Y2X + Z2X);
-    float F3 = -8.0f * (X2Y + y_sum3 + Z2Y);
-    float F4 = -8.0f * (X2Z + Y2Z + z_sum3);
-
-    //Set initial conditions:
-    float A = x_sum;
-    float B = y_sum;
-    float C = z_sum;
-
-    //First iteration computation:
-    float A2 = A * A;
-    float B2 = B * B;
-    float C2 = C * C;
-    float QS = A2 + B2 + C2;
-    float QB = -2.0f * (A * x_sum + B * y_sum + C * z_sum);
-
-    //Set initial conditions:
-    float Rsq = F0 + QB + QS;
-
-    //First iteration computation:
-    float Q0 = 0.5f * (QS - Rsq);
-    float Q1 = F1 + Q0;
-    float Q2 = 8.0f * (QS - Rsq + QB + F0);
-    float aA, aB, aC, nA, nB, nC, dA, dB, dC;
-
-    //Iterate N times, ignore stop condition.
-    unsigned int n = 0;
-
-#undef  FLT_EPSILON
-#define FLT_EPSILON 1.1920929e-07F  /* 1E-5 */
-
-    while (n < max_iterations) {
-        n++;
-
-        //Compute denominator:
-        aA = Q2 + 16.0f * (A2 - 2.0f * A * x_sum + x_sum2);
-        aB = Q2 + 16.0f * (B2 - 2.0f * B * y_sum + y_sum2);
-        aC = Q2 + 16.0f * (C2 - 2.0f * C * z_sum + z_sum2);
-        aA = (fabsf(aA) < FLT_EPSILON) ? 1.0f : aA;
-        aB = (fabsf(aB) < FLT_EPSILON) ? 1.0f : aB;
-        aC = (fabsf(aC) < FLT_EPSILON) ? 1.0f : aC;
-
-        //Compute next iteration
-        nA = A - ((F2 + 16.0f * (B * XY + C * XZ + x_sum * (-A2 - Q0) + A * (x_sum2 + Q1 - C * z_sum - B * y_sum))) / aA);
-        nB = B - ((F3 + 16.0f * (A * XY + C * YZ + y_sum * (-B2 - Q0) + B * (y_sum2 + Q1 - A * x_sum - C * z_sum))) / aB);
-        nC = C - ((F4 + 16.0f * (A * XZ + B * YZ + z_sum * (-C2 - Q0) + C * (z_sum2 + Q1 - A * x_sum - B * y_sum))) / aC);
-
-        //Check for stop condition
-        dA = (nA - A);
-        dB = (nB - B);
-        dC = (nC - C);
-
-        if ((dA * dA + dB * dB + dC * dC) <= delta) { break; }
-
-        //Compute next iteration's values
-        A = nA;
-        B = nB;
-        C = nC;
-        A2 = A * A;
-        B2 = B * B;
-        C2 = C * C;
-        QS = A2 + B2 + C2;
-        QB = -2.0f * (A * x_sum + B * y_sum + C * z_sum);
-        Rsq = F0 + QB + QS;
-        Q0 = 0.5f * (QS - Rsq);
-        Q1 = F1 + Q0;
-        Q2 = 8.0f * (QS - Rsq + QB + F0);
+    for (QFuture<bool>& future: futures) {
+        future.waitForFinished();
     }
 
-    *sphere_x = A;
-    *sphere_y = B;
-    *sphere_z = C;
-    *sphere_radius = sqrtf(Rsq);
-
-    return 0;
+    for (unsigned cur_mag=0; cur_mag<max_mags; cur_mag++) {
+        if (rgCompassAvailable[cur_mag] && worker_data->fit[cur_mag].valid()) {
+            emit compassCalFitness(static_cast<int>(cur_mag), worker_data->fit[cur_mag].fitness());
+        }
+    }
 }
 
 APMCompassCal::APMCompassCal(void)
@@ -597,6 +408,7 @@ void APMCompassCal::startCalibration(void)
 
     _calWorkerThread = new CalWorkerThread(_vehicle);
     connect(_calWorkerThread, &CalWorkerThread::vehicleTextMessage, this, &APMCompassCal::vehicleTextMessage);
+    connect(_calWorkerThread, &CalWorkerThread::compassCalFitness,  this, &APMCompassCal::compassCalFitness);
 
     // Clear the offset parameters so we get raw data
     for (int i=0; i<3; i++) {
@@ -639,7 +451,7 @@ void APMCompassCal::cancelCalibration(void)
     _emitVehicleTextMessage(QStringLiteral("[cal] calibration cancelled"));
 }
 
-void APMCompassCal::_handleMavlinkRawImu(mavlink_message_t message)
+void APMCompassCal::_handleMavlinkRawImu(const mavlink_message_t& message)
 {
     _calWorkerThread->lastScaledImuMutex.lock();
     mavlink_msg_raw_imu_decode(&message, &_calWorkerThread->lastRawImu);
@@ -655,14 +467,14 @@ void APMCompassCal::_handleMavlinkRawImu(mavlink_message_t message)
     _calWorkerThread->lastScaledImuMutex.unlock();
 }
 
-void APMCompassCal::_handleMavlinkScaledImu2(mavlink_message_t message)
+void APMCompassCal::_handleMavlinkScaledImu2(const mavlink_message_t& message)
 {
     _calWorkerThread->lastScaledImuMutex.lock();
     mavlink_msg_scaled_imu2_decode(&message, (mavlink_scaled_imu2_t*)&_calWorkerThread->rgLastScaledImu[1]);
     _calWorkerThread->lastScaledImuMutex.unlock();
 }
 
-void APMCompassCal::_handleMavlinkScaledImu3(mavlink_message_t message)
+void APMCompassCal::_handleMavlinkScaledImu3(const mavlink_message_t& message)
 {
     _calWorkerThread->lastScaledImuMutex.lock();
     mavlink_msg_scaled_imu3_decode(&message, (mavlink_scaled_imu3_t*)&_calWorkerThread->rgLastScaledImu[2]);
@@ -671,7 +483,12 @@ void APMCompassCal::_handleMavlinkScaledImu3(mavlink_message_t message)
 
 void APMCompassCal::_setSensorTransmissionSpeed(bool fast)
 {
-    _vehicle->requestDataStream(MAV_DATA_STREAM_RAW_SENSORS, fast ? 10 : 2);
+    // Once calibration is done the stream drops back to the rate the stream rate settings ask for
+    if (fast) {
+        _vehicle->messageRateManager()->requestStreamRate(this, MAV_DATA_STREAM_RAW_SENSORS, 10);
+    } else {
+        _vehicle->messageRateManager()->removeStreamRate(this, MAV_DATA_STREAM_RAW_SENSORS);
+    }
 }
 
 void APMCompassCal::_stopCalibration(void)
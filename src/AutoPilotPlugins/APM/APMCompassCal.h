@@ -18,6 +18,7 @@
 #include "QGCLoggingCategory.h"
 #include "QGCMAVLink.h"
 #include "Vehicle.h"
+#include "CompassSphereFit.h"
 
 Q_DECLARE_LOGGING_CATEGORY(APMCompassCalLog)
 
@@ -45,6 +46,7 @@ public:
 
 signals:
     void vehicleTextMessage(int vehicleId, int compId, int severity, QString text);
+    void compassCalFitness (int compassIndex, float fitness);
 
 private:
     void _emitVehicleTextMessage(const QString& message);
@@ -56,6 +58,8 @@ private:
     static const unsigned int calibration_sides;			///< The total number of sides
     static const unsigned int calibration_total_points;     ///< The total points per magnetometer
     static const unsigned int calibraton_duration_seconds;  ///< The total duration the routine is allowed to take
+    static const int live_fit_iterations = 3;               ///< Fit iterations after each sample, the fit carries on from the last one
+    static const int final_fit_iterations = 100;            ///< Fit iterations once all samples are collected
 
     // The order of these cannot change since the calibration calculations depend on them in this order
     enum detect_orientation_return {
@@ -75,11 +79,8 @@ private:
         unsigned int	calibration_points_perside;
         unsigned int	calibration_interval_perside_seconds;
         uint64_t        calibration_interval_perside_useconds;
-        unsigned int	calibration_counter_total[max_mags];
         bool            side_data_collected[detect_orientation_side_count];
-        float*          x[max_mags];
-        float*          y[max_mags];
-        float*          z[max_mags];
+        CompassSphereFit fit[max_mags];
     } mag_worker_data_t;
 
     enum calibrate_return {
@@ -88,27 +89,8 @@ private:
         calibrate_return_cancelled
     };
 
-    /**
-     * Least-squares fit of a sphere to a set of points.
-     *
-     * Fits a sphere to a set of points on the sphere surface.
-     *
-     * @param x point coordinates on the X axis
-     * @param y point coordinates on the Y axis
-     * @param z point coordinates on the Z axis
-     * @param size number of points
-     * @param max_iterations abort if maximum number of iterations have been reached. If unsure, set to 100.
-     * @param delta abort if error is below delta. If unsure, set to 0 to run max_iterations times.
-     * @param sphere_x coordinate of the sphere center on the X axis
-     * @param sphere_y coordinate of the sphere center on the Y axis
-     * @param sphere_z coordinate of the sphere center on the Z axis
-     * @param sphere_radius sphere radius
-     *
-     * @return 0 on success, 1 on failure
-     */
-    int sphere_fit_least_squares(const float x[], const float y[], const float z[],
-                     unsigned int size, unsigned int max_iterations, float delta, float *sphere_x, float *sphere_y, float *sphere_z,
-                     float *sphere_radius);
+    /// Refines the sphere fit of each available mag, all mags at the same time, and signals the new fitness
+    void _refineFits(mag_worker_data_t* worker_data, int maxIterations);
 
     /// Wait for vehicle to become still and detect it's orientation
     ///	@return Returns detect_orientation_return according to orientation of still vehicle
@@ -148,11 +130,12 @@ public:
     
 signals:
     void vehicleTextMessage(int vehicleId, int compId, int severity, QString text);
+    void compassCalFitness (int compassIndex, float fitness);
 
 private slots:
-    void _handleMavlinkRawImu(mavlink_message_t message);
-    void _handleMavlinkScaledImu2(mavlink_message_t message);
-    void _handleMavlinkScaledImu3(mavlink_message_t message);
+    void _handleMavlinkRawImu(const mavlink_message_t& message);
+    void _handleMavlinkScaledImu2(const mavlink_message_t& message);
+    void _handleMavlinkScaledImu3(const mavlink_message_t& message);
 
 private:
     void _setSensorTransmissionSpeed(bool fast);
@@ -14,6 +14,7 @@
 #include "QGCApplication.h"
 #include "APMAutoPilotPlugin.h"
 #include "ParameterManager.h"
+#include "MAVLinkProtocol.h"
 
 #include <QVariant>
 #include <QQmlProperty>
@@ -60,6 +61,7 @@ APMSensorsComponentController::APMSensorsComponentController(void)
 {
     _compassCal.setVehicle(_vehicle);
     connect(&_compassCal, &APMCompassCal::vehicleTextMessage, this, &APMSensorsComponentController::_handleUASTextMessage);
+    connect(&_compassCal, &APMCompassCal::compassCalFitness,  this, &APMSensorsComponentController::_offboardCompassCalFitness);
 
     APMAutoPilotPlugin * apmPlugin = qobject_cast<APMAutoPilotPlugin*>(_vehicle->autopilotPlugin());
 
@@ -109,7 +111,7 @@ void APMSensorsComponentController::_startLogCalibration(void)
     }
     _cancelButton->setEnabled(_calTypeInProgress == CalTypeOnboardCompass);
 
-    connect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, &APMSensorsComponentController::_mavlinkMessageReceived);
+    _subscribeCalibrationMessages();
 }
 
 void APMSensorsComponentController::_startVisualCalibration(void)
@@ -122,7 +124,7 @@ void APMSensorsComponentController::_startVisualCalibration(void)
     
     _progressBar->setProperty("value", 0);
 
-    connect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, &APMSensorsComponentController::_mavlinkMessageReceived);
+    _subscribeCalibrationMessages();
 }
 
 void APMSensorsComponentController::_resetInternalState(void)
@@ -153,7 +155,7 @@ void APMSensorsComponentController::_resetInternalState(void)
 
 void APMSensorsComponentController::_stopCalibration(APMSensorsComponentController::StopCalibrationCode code)
 {
-    disconnect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this, &APMSensorsComponentController::_mavlinkMessageReceived);
+    _unsubscribeCalibrationMessages();
     _vehicle->vehicleLinkManager()->setCommunicationLostEnabled(true);
 
     disconnect(_vehicle, &Vehicle::textMessageReceived, this, &APMSensorsComponentController::_handleUASTextMessage);
@@ -400,6 +402,27 @@ void APMSensorsComponentController::_handleUASTextMessage(int uasId, int compId,
     qCDebug(APMSensorsComponentControllerLog) << originalMessageText << severity;
 }
 
+void APMSensorsComponentController::_offboardCompassCalFitness(int compassIndex, float fitness)
+{
+    if (compassIndex < 0 || compassIndex >= 3) {
+        return;
+    }
+
+    // Updated as samples arrive, so the fitness can be watched while the vehicle is being rotated
+    _rgCompassCalFitness[compassIndex] = fitness;
+    switch (compassIndex) {
+    case 0:
+        emit compass1CalFitnessChanged(fitness);
+        break;
+    case 1:
+        emit compass2CalFitnessChanged(fitness);
+        break;
+    case 2:
+        emit compass3CalFitnessChanged(fitness);
+        break;
+    }
+}
+
 void APMSensorsComponentController::_refreshParams(void)
 {
     QStringList fastRefreshList;
@@ -494,7 +517,7 @@ bool APMSensorsComponentController::usingUDPLink(void)
     }
 }
 
-void APMSensorsComponentController::_handleCommandAck(mavlink_message_t& message)
+void APMSensorsComponentController::_handleCommandAck(const mavlink_message_t& message)
 {
     if (_calTypeInProgress == CalTypeLevelHorizon || _calTypeInProgress == CalTypeGyro || _calTypeInProgress == CalTypePressure) {
         mavlink_command_ack_t commandAck;
@@ -515,7 +538,7 @@ void APMSensorsComponentController::_handleCommandAck(mavlink_message_t& message
     }
 }
 
-void APMSensorsComponentController::_handleMagCalProgress(mavlink_message_t& message)
+void APMSensorsComponentController::_handleMagCalProgress(const mavlink_message_t& message)
 {
     if (_calTypeInProgress == CalTypeOnboardCompass) {
         mavlink_mag_cal_progress_t magCalProgress;
@@ -543,7 +566,7 @@ void APMSensorsComponentController::_handleMagCalProgress(mavlink_message_t& mes
     }
 }
 
-void APMSensorsComponentController::_handleMagCalReport(mavlink_message_t& message)
+void APMSensorsComponentController::_handleMagCalReport(const mavlink_message_t& message)
 {
     if (_calTypeInProgress == CalTypeOnboardCompass) {
         mavlink_mag_cal_report_t magCalReport;
@@ -591,7 +614,7 @@ void APMSensorsComponentController::_handleMagCalReport(mavlink_message_t& messa
     }
 }
 
-void APMSensorsComponentController::_handleCommandLong(mavlink_message_t& message)
+void APMSensorsComponentController::_handleCommandLong(const mavlink_message_t& message)
 {
     bool                    updateImages = false;
     mavlink_command_long_t  commandLong;
@@ -671,7 +694,37 @@ void APMSensorsComponentController::_handleCommandLong(mavlink_message_t& messag
     }
 }
 
-void APMSensorsComponentController::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message)
+/// Only the messages handled by _mavlinkMessageReceived are delivered, and only from our vehicle
+void APMSensorsComponentController::_subscribeCalibrationMessages(void)
+{
+    static const uint32_t rgMsgIds[] = {
+        MAVLINK_MSG_ID_COMMAND_ACK,
+        MAVLINK_MSG_ID_MAG_CAL_PROGRESS,
+        MAVLINK_MSG_ID_MAG_CAL_REPORT,
+        MAVLINK_MSG_ID_COMMAND_LONG,
+    };
+
+    _unsubscribeCalibrationMessages();
+
+    MAVLinkMessageDispatcher* dispatcher = qgcApp()->toolbox()->mavlinkProtocol()->messageDispatcher();
+    for (uint32_t msgId: rgMsgIds) {
+        _calibrationMessageSubscriptions.append(dispatcher->subscribe(msgId, _vehicle->id(), MAVLinkMessageDispatcher::AnyComponent, this,
+                                                                      [this](LinkInterface* link, const mavlink_message_t& message) {
+            _mavlinkMessageReceived(link, message);
+        }));
+    }
+}
+
+void APMSensorsComponentController::_unsubscribeCalibrationMessages(void)
+{
+    MAVLinkMessageDispatcher* dispatcher = qgcApp()->toolbox()->mavlinkProtocol()->messageDispatcher();
+    for (int handle: _calibrationMessageSubscriptions) {
+        dispatcher->unsubscribe(handle);
+    }
+    _calibrationMessageSubscriptions.clear();
+}
+
+void APMSensorsComponentController::_mavlinkMessageReceived(LinkInterface* link, const mavlink_message_t& message)
 {
     Q_UNUSED(link);
 
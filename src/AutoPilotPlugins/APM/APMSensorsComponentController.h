@@ -133,8 +133,9 @@ signals:
 
 private slots:
     void _handleUASTextMessage  (int uasId, int compId, int severity, QString text);
-    void _mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message);
+    void _mavlinkMessageReceived(LinkInterface* link, const mavlink_message_t& message);
     void _mavCommandResult      (int vehicleId, int component, int command, int result, bool noReponseFromVehicle);
+    void _offboardCompassCalFitness(int compassIndex, float fitness);
 
 private:
     void _startLogCalibration               (void);
@@ -143,10 +144,12 @@ private:
     void _refreshParams                     (void);
     void _hideAllCalAreas                   (void);
     void _resetInternalState                (void);
-    void _handleCommandAck                  (mavlink_message_t& message);
-    void _handleMagCalProgress              (mavlink_message_t& message);
-    void _handleMagCalReport                (mavlink_message_t& message);
-    void _handleCommandLong                 (mavlink_message_t& message);
+    void _subscribeCalibrationMessages      (void);
+    void _unsubscribeCalibrationMessages    (void);
+    void _handleCommandAck                  (const mavlink_message_t& message);
+    void _handleMagCalProgress              (const mavlink_message_t& message);
+    void _handleMagCalReport                (const mavlink_message_t& message);
+    void _handleCommandLong                 (const mavlink_message_t& message);
     void _restorePreviousCompassCalFitness  (void);
 
     enum StopCalibrationCode {
@@ -172,6 +175,8 @@ private:
     
     CalType_t _calTypeInProgress;
 
+    QList<int> _calibrationMessageSubscriptions;    ///< MAVLinkMessageDispatcher handles while calibrating
+
     uint8_t _rgCompassCalProgress[3];
     bool    _rgCompassCalComplete[3];
     bool    _rgCompassCalSucceeded[3];
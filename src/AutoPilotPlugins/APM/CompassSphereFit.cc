@@ -0,0 +1,137 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "CompassSphereFit.h"
+
+#include <algorithm>
+#include <cmath>
+
+CompassSphereFit::CompassSphereFit(void)
+{
+    reset(0);
+}
+
+void CompassSphereFit::reset(int maxSamples)
+{
+    _samples.resize(3, maxSamples);
+    _sampleCount = 0;
+    _normalMatrix.setZero();
+    _normalVector.setZero();
+    _center.setZero();
+    _radius     = 0;
+    _fitness    = 0;
+    _lambda     = 1e-3;
+    _valid      = false;
+}
+
+bool CompassSphereFit::addSample(float x, float y, float z)
+{
+    if (_sampleCount >= _samples.cols()) {
+        return false;
+    }
+
+    Eigen::Vector3d sample(x, y, z);
+    _samples.col(_sampleCount++) = sample;
+
+    Eigen::Vector4d row(x, y, z, 1.0);
+    _normalMatrix += row * row.transpose();
+    _normalVector += row * sample.squaredNorm();
+
+    return true;
+}
+
+bool CompassSphereFit::_linearFit(void)
+{
+    Eigen::LDLT<Eigen::Matrix4d> ldlt(_normalMatrix);
+
+    // Samples which all lie close to a plane or line don't pin down a sphere
+    if (ldlt.info() != Eigen::Success || ldlt.rcond() < 1e-12) {
+        return false;
+    }
+
+    Eigen::Vector4d solution        = ldlt.solve(_normalVector);
+    Eigen::Vector3d center          = solution.head<3>() / 2.0;
+    double          radiusSquared   = solution[3] + center.squaredNorm();
+    if (!solution.allFinite() || radiusSquared <= 0) {
+        return false;
+    }
+
+    _center = center;
+    _radius = std::sqrt(radiusSquared);
+    _lambda = 1e-3;
+    _valid  = true;
+
+    return true;
+}
+
+double CompassSphereFit::_cost(const Eigen::Vector3d& center, double radius) const
+{
+    return ((_samples.leftCols(_sampleCount).colwise() - center).colwise().norm().array() - radius).square().sum();
+}
+
+bool CompassSphereFit::refine(int maxIterations)
+{
+    if (_sampleCount < minSamples) {
+        return false;
+    }
+    if (!_valid && !_linearFit()) {
+        return false;
+    }
+
+    auto samples = _samples.leftCols(_sampleCount);
+
+    for (int iteration=0; iteration<maxIterations; iteration++) {
+        Eigen::Matrix3Xd    offsets     = samples.colwise() - _center;
+        Eigen::ArrayXd      distances   = offsets.colwise().norm().transpose().array().max(1e-9);
+        Eigen::VectorXd     residuals   = (distances - _radius).matrix();
+        double              cost        = residuals.squaredNorm();
+
+        _fitness = std::sqrt(cost / _sampleCount);
+
+        // Derivatives of each residual by the center and the radius
+        Eigen::Matrix4Xd jacobian(4, _sampleCount);
+        jacobian.topRows<3>()   = -(offsets.array().rowwise() / distances.transpose()).matrix();
+        jacobian.row(3).setConstant(-1.0);
+
+        Eigen::Matrix4d hessian     = jacobian * jacobian.transpose();
+        Eigen::Vector4d gradient    = jacobian * residuals;
+
+        bool            improved = false;
+        Eigen::Vector4d step;
+        while (!improved && _lambda < 1e10) {
+            Eigen::Matrix4d damped = hessian;
+            damped.diagonal() *= 1.0 + _lambda;
+            step = damped.ldlt().solve(-gradient);
+
+            Eigen::Vector3d center  = _center + step.head<3>();
+            double          radius  = _radius + step[3];
+            double          newCost = _cost(center, radius);
+            if (step.allFinite() && newCost < cost) {
+                _center     = center;
+                _radius     = radius;
+                _fitness    = std::sqrt(newCost / _sampleCount);
+                _lambda     = std::max(_lambda / 10.0, 1e-9);
+                improved    = true;
+            } else {
+                _lambda *= 10.0;
+            }
+        }
+
+        if (!improved) {
+            // Already at the minimum, nothing left to do until more samples arrive
+            _lambda = 1e-3;
+            break;
+        }
+        if (step.norm() < 1e-6 * std::max(1.0, _radius)) {
+            break;
+        }
+    }
+
+    return true;
+}
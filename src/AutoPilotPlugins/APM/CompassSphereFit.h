@@ -0,0 +1,64 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <Eigen/Dense>
+
+/// Least squares sphere fit of the samples from a single magnetometer.
+///
+/// Samples are added as they arrive. Each one also goes into the normal equations of the linear fit of
+/// |p|^2 = 2 c.p + r^2 - |c|^2, which gives a starting point at any time without another pass over the samples.
+/// refine() then runs Levenberg-Marquardt on the distance of every sample from the sphere surface using whole matrix
+/// operations. It carries on from the previous fit, so calling it as samples arrive only takes a few iterations each time.
+class CompassSphereFit
+{
+public:
+    CompassSphereFit(void);
+
+    /// Drops all samples and the current fit
+    ///     @param maxSamples Number of samples storage is allocated for
+    void reset(int maxSamples);
+
+    /// @return false: No room for the sample
+    bool addSample(float x, float y, float z);
+
+    /// Runs Levenberg-Marquardt from the current fit
+    ///     @param maxIterations Maximum number of iterations to run
+    /// @return false: Not enough samples to fit yet
+    bool refine(int maxIterations = 10);
+
+    int     sampleCount (void) const { return _sampleCount; }
+    bool    valid       (void) const { return _valid; }
+    float   centerX     (void) const { return static_cast<float>(_center.x()); }
+    float   centerY     (void) const { return static_cast<float>(_center.y()); }
+    float   centerZ     (void) const { return static_cast<float>(_center.z()); }
+    float   radius      (void) const { return static_cast<float>(_radius); }
+
+    /// @return RMS distance of the samples from the sphere surface, in the units of the samples. -1 if there is no fit.
+    float   fitness     (void) const { return _valid ? static_cast<float>(_fitness) : -1.0f; }
+
+    static const int minSamples = 4;
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+private:
+    bool    _linearFit  (void);
+    double  _cost       (const Eigen::Vector3d& center, double radius) const;
+
+    Eigen::Matrix3Xd    _samples;
+    int                 _sampleCount;
+    Eigen::Matrix4d     _normalMatrix;      ///< Sum of [p 1][p 1]' over the samples
+    Eigen::Vector4d     _normalVector;      ///< Sum of [p 1]|p|^2 over the samples
+    Eigen::Vector3d     _center;
+    double              _radius;
+    double              _fitness;
+    double              _lambda;            ///< Levenberg-Marquardt damping, kept from one refine to the next
+    bool                _valid;
+};
@@ -0,0 +1,111 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "CompassSphereFitTest.h"
+#include "CompassSphereFit.h"
+
+#include <QRandomGenerator>
+#include <QVector3D>
+#include <QtMath>
+
+/// @return Sample index of count spread evenly over the sphere surface, with up to noise added in each axis
+static QVector3D _sphereSample(int index, int count, const QVector3D& center, float radius, float noise, QRandomGenerator& random)
+{
+    double height   = 1.0 - (2.0 * (index + 0.5) / count);
+    double azimuth  = index * M_PI * (3.0 - qSqrt(5.0));
+    double ring     = qSqrt(1.0 - height * height);
+
+    QVector3D surface(static_cast<float>(ring * qCos(azimuth)), static_cast<float>(ring * qSin(azimuth)), static_cast<float>(height));
+    QVector3D offset(static_cast<float>(random.bounded(2.0) - 1.0), static_cast<float>(random.bounded(2.0) - 1.0), static_cast<float>(random.bounded(2.0) - 1.0));
+    return center + (surface * radius) + (offset * noise);
+}
+
+static void _addSphereSamples(CompassSphereFit& fit, int count, const QVector3D& center, float radius, float noise)
+{
+    QRandomGenerator random(1234);
+    for (int i=0; i<count; i++) {
+        QVector3D sample = _sphereSample(i, count, center, radius, noise, random);
+        fit.addSample(sample.x(), sample.y(), sample.z());
+    }
+}
+
+void CompassSphereFitTest::_fitTest(void)
+{
+    CompassSphereFit fit;
+
+    fit.reset(240);
+    _addSphereSamples(fit, 240, QVector3D(120, -60, 30), 400, 0);
+    QVERIFY(fit.refine(100));
+    QVERIFY(fit.valid());
+    QVERIFY(qAbs(fit.centerX() - 120) < 0.1f);
+    QVERIFY(qAbs(fit.centerY() + 60) < 0.1f);
+    QVERIFY(qAbs(fit.centerZ() - 30) < 0.1f);
+    QVERIFY(qAbs(fit.radius() - 400) < 0.1f);
+    QVERIFY(fit.fitness() < 0.1f);
+
+    // Noise shows up in the fitness, not in the offsets
+    fit.reset(240);
+    _addSphereSamples(fit, 240, QVector3D(120, -60, 30), 400, 10);
+    QVERIFY(fit.refine(100));
+    QVERIFY(qAbs(fit.centerX() - 120) < 3);
+    QVERIFY(qAbs(fit.centerY() + 60) < 3);
+    QVERIFY(qAbs(fit.centerZ() - 30) < 3);
+    QVERIFY(fit.fitness() > 1 && fit.fitness() < 10);
+}
+
+void CompassSphereFitTest::_incrementalTest(void)
+{
+    const int   sampleCount = 240;
+    QVector3D   center(-200, 50, 80);
+
+    CompassSphereFit batchFit;
+    batchFit.reset(sampleCount);
+    _addSphereSamples(batchFit, sampleCount, center, 350, 5);
+    QVERIFY(batchFit.refine(100));
+
+    // A few iterations after each sample, the way calibration runs it, end up at the same fit as fitting once at the end
+    CompassSphereFit    liveFit;
+    QRandomGenerator    random(1234);
+    liveFit.reset(sampleCount);
+    QCOMPARE(liveFit.fitness(), -1.0f);
+    for (int i=0; i<sampleCount; i++) {
+        QVector3D sample = _sphereSample(i, sampleCount, center, 350, 5, random);
+        QVERIFY(liveFit.addSample(sample.x(), sample.y(), sample.z()));
+        liveFit.refine(3);
+    }
+    QVERIFY(liveFit.valid());
+    QVERIFY(qAbs(liveFit.centerX() - batchFit.centerX()) < 0.01f);
+    QVERIFY(qAbs(liveFit.centerY() - batchFit.centerY()) < 0.01f);
+    QVERIFY(qAbs(liveFit.centerZ() - batchFit.centerZ()) < 0.01f);
+    QVERIFY(qAbs(liveFit.fitness() - batchFit.fitness()) < 0.01f);
+}
+
+void CompassSphereFitTest::_degenerateTest(void)
+{
+    CompassSphereFit fit;
+
+    // Too few samples
+    fit.reset(10);
+    fit.addSample(1, 2, 3);
+    fit.addSample(4, 5, 6);
+    QVERIFY(!fit.refine());
+    QVERIFY(!fit.valid());
+
+    // Samples all in a plane don't give a sphere
+    fit.reset(10);
+    for (int i=0; i<10; i++) {
+        QVERIFY(fit.addSample(i, i * 2, 5));
+    }
+    QVERIFY(!fit.refine());
+    QVERIFY(!fit.valid());
+
+    // Storage is full
+    QVERIFY(!fit.addSample(0, 0, 0));
+    QCOMPARE(fit.sampleCount(), 10);
+}
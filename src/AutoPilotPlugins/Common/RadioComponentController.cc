@@ -95,7 +95,9 @@ RadioComponentController::RadioComponentController(void)
         _revParamIsBool = false;    // paeram value if -1 indicates reversed
     }
 
-    connect(_vehicle, &Vehicle::rcChannelsChanged, this, &RadioComponentController::_rcChannelsChanged);
+    connect(_vehicle,               &Vehicle::rcChannelsChanged,                this, &RadioComponentController::_rcChannelsChanged);
+    connect(&_rcChannelThrottle,    &RCChannelThrottle::channelValueChanged,    this, &RadioComponentController::_rcChannelPublished);
+    connect(&_rcChannelThrottle,    &RCChannelThrottle::valuesChanged,          this, &RadioComponentController::channelRCValuesChanged);
     _loadSettings();
 
     _resetInternalCalibrationValues();
@@ -225,6 +227,9 @@ void RadioComponentController::_setupCurrentState(void)
 /// Connected to Vehicle::rcChannelsChanged signal
 void RadioComponentController::_rcChannelsChanged(int channelCount, int pwmValues[Vehicle::cMaxRcChannels])
 {
+    // The calibration state machine sees every value, Qml only gets them once per display frame
+    _rcChannelThrottle.update(channelCount, pwmValues);
+
     for (int channel=0; channel<channelCount; channel++) {
         int channelValue = pwmValues[channel];
 
@@ -232,28 +237,6 @@ void RadioComponentController::_rcChannelsChanged(int channelCount, int pwmValue
             qCDebug(RadioComponentControllerVerboseLog) << "Raw value" << channel << channelValue;
 
             _rcRawValue[channel] = channelValue;
-            emit channelRCValueChanged(channel, channelValue);
-
-            // Signal attitude rc values to Qml if mapped
-            if (_rgChannelInfo[channel].function != rcCalFunctionMax) {
-                switch (_rgChannelInfo[channel].function) {
-                case rcCalFunctionRoll:
-                    emit rollChannelRCValueChanged(channelValue);
-                    break;
-                case rcCalFunctionPitch:
-                    emit pitchChannelRCValueChanged(channelValue);
-                    break;
-                case rcCalFunctionYaw:
-                    emit yawChannelRCValueChanged(channelValue);
-                    break;
-                case rcCalFunctionThrottle:
-                    emit throttleChannelRCValueChanged(channelValue);
-                    break;
-                default:
-                    break;
-
-                }
-            }
 
             if (_currentStep == -1) {
                 if (_chanCount != channelCount) {
@@ -274,6 +257,32 @@ void RadioComponentController::_rcChannelsChanged(int channelCount, int pwmValue
     }
 }
 
+/// Connected to RCChannelThrottle::channelValueChanged signal
+void RadioComponentController::_rcChannelPublished(int channel, int channelValue)
+{
+    emit channelRCValueChanged(channel, channelValue);
+
+    // Signal attitude rc values to Qml if mapped
+    if (channel < _chanMax && _rgChannelInfo[channel].function != rcCalFunctionMax) {
+        switch (_rgChannelInfo[channel].function) {
+        case rcCalFunctionRoll:
+            emit rollChannelRCValueChanged(channelValue);
+            break;
+        case rcCalFunctionPitch:
+            emit pitchChannelRCValueChanged(channelValue);
+            break;
+        case rcCalFunctionYaw:
+            emit yawChannelRCValueChanged(channelValue);
+            break;
+        case rcCalFunctionThrottle:
+            emit throttleChannelRCValueChanged(channelValue);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
 void RadioComponentController::nextButtonClicked(void)
 {
     if (_currentStep == -1) {
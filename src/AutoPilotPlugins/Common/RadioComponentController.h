@@ -22,6 +22,7 @@
 #include "UASInterface.h"
 #include "QGCLoggingCategory.h"
 #include "AutoPilotPlugin.h"
+#include "RCChannelThrottle.h"
 
 Q_DECLARE_LOGGING_CATEGORY(RadioComponentControllerLog)
 Q_DECLARE_LOGGING_CATEGORY(RadioComponentControllerVerboseLog)
@@ -45,6 +46,7 @@ public:
 
     Q_PROPERTY(int minChannelCount MEMBER _chanMinimum CONSTANT)
     Q_PROPERTY(int channelCount READ channelCount NOTIFY channelCountChanged)
+    Q_PROPERTY(QVariantList channelRCValues READ channelRCValues NOTIFY channelRCValuesChanged)
 
     Q_PROPERTY(QQuickItem* statusText   MEMBER _statusText      NOTIFY statusTextChanged)
     Q_PROPERTY(QQuickItem* cancelButton MEMBER _cancelButton    NOTIFY cancelButtonChanged)
@@ -99,6 +101,7 @@ public:
     bool throttleChannelReversed(void);
 
     int channelCount(void);
+    QVariantList channelRCValues(void) const { return _rcChannelThrottle.values(); }
 
     int transmitterMode(void) { return _transmitterMode; }
     void setTransmitterMode(int mode);
@@ -110,7 +113,11 @@ signals:
     void skipButtonChanged(void);
 
     void channelCountChanged(int channelCount);
+
+    /// Signalled at most once per display frame, only for channels which moved more than the deadband. The same goes
+    /// for the roll, pitch, yaw and throttle value signals.
     void channelRCValueChanged(int channel, int rcValue);
+    void channelRCValuesChanged(void);
 
     void rollChannelMappedChanged(bool mapped);
     void pitchChannelMappedChanged(bool mapped);
@@ -141,6 +148,7 @@ signals:
 
 private slots:
     void _rcChannelsChanged(int channelCount, int pwmValues[Vehicle::cMaxRcChannels]);
+    void _rcChannelPublished(int channel, int channelValue);
 
 private:
     /// @brief These identify the various controls functions. They are also used as indices into the _rgFunctioInfo
@@ -299,6 +307,7 @@ private:
     int _rcValueSave[_chanMax];        ///< Saved values prior to detecting channel movement
 
     int _rcRawValue[_chanMax];         ///< Current set of raw channel values
+    RCChannelThrottle _rcChannelThrottle;   ///< Channel values on their way to Qml
 
     int     _stickDetectChannel;
     int     _stickDetectInitialValue;
@@ -7,53 +7,26 @@
 
 #include "QGCCameraControl.h"
 #include "QGCCameraIO.h"
+#include "QGCCameraMedia.h"
 #include "SettingsManager.h"
 #include "VideoManager.h"
 #include "QGCMapEngine.h"
 #include "QGCCameraManager.h"
+#include "QGCNetworkService.h"
 
 #include <QDir>
 #include <QStandardPaths>
-#include <QDomDocument>
-#include <QDomNodeList>
+#include <QtConcurrent>
 
 QGC_LOGGING_CATEGORY(CameraControlLog, "CameraControlLog")
 QGC_LOGGING_CATEGORY(CameraControlVerboseLog, "CameraControlVerboseLog")
 
-static const char* kCondition       = "condition";
-static const char* kControl         = "control";
 static const char* kDefault         = "default";
-static const char* kDefnition       = "definition";
-static const char* kDescription     = "description";
-static const char* kExclusion       = "exclude";
-static const char* kExclusions      = "exclusions";
-static const char* kLocale          = "locale";
-static const char* kLocalization    = "localization";
 static const char* kMax             = "max";
 static const char* kMin             = "min";
-static const char* kModel           = "model";
-static const char* kName            = "name";
-static const char* kOption          = "option";
-static const char* kOptions         = "options";
-static const char* kOriginal        = "original";
-static const char* kParameter       = "parameter";
-static const char* kParameterrange  = "parameterrange";
-static const char* kParameterranges = "parameterranges";
-static const char* kParameters      = "parameters";
-static const char* kReadOnly        = "readonly";
-static const char* kWriteOnly       = "writeonly";
-static const char* kRoption         = "roption";
 static const char* kStep            = "step";
 static const char* kDecimalPlaces   = "decimalPlaces";
-static const char* kStrings         = "strings";
-static const char* kTranslated      = "translated";
-static const char* kType            = "type";
 static const char* kUnit            = "unit";
-static const char* kUpdate          = "update";
-static const char* kUpdates         = "updates";
-static const char* kValue           = "value";
-static const char* kVendor          = "vendor";
-static const char* kVersion         = "version";
 
 static const char* kPhotoMode       = "PhotoMode";
 static const char* kPhotoLapse      = "PhotoLapse";
@@ -92,66 +65,6 @@ QGCCameraOptionRange::QGCCameraOptionRange(QObject* parent, QString param_, QStr
 {
 }
 
-//-----------------------------------------------------------------------------
-static bool
-read_attribute(QDomNode& node, const char* tagName, bool& target)
-{
-    QDomNamedNodeMap attrs = node.attributes();
-    if(!attrs.count()) {
-        return false;
-    }
-    QDomNode subNode = attrs.namedItem(tagName);
-    if(subNode.isNull()) {
-        return false;
-    }
-    target = subNode.nodeValue() != "0";
-    return true;
-}
-
-//-----------------------------------------------------------------------------
-static bool
-read_attribute(QDomNode& node, const char* tagName, int& target)
-{
-    QDomNamedNodeMap attrs = node.attributes();
-    if(!attrs.count()) {
-        return false;
-    }
-    QDomNode subNode = attrs.namedItem(tagName);
-    if(subNode.isNull()) {
-        return false;
-    }
-    target = subNode.nodeValue().toInt();
-    return true;
-}
-
-//-----------------------------------------------------------------------------
-static bool
-read_attribute(QDomNode& node, const char* tagName, QString& target)
-{
-    QDomNamedNodeMap attrs = node.attributes();
-    if(!attrs.count()) {
-        return false;
-    }
-    QDomNode subNode = attrs.namedItem(tagName);
-    if(subNode.isNull()) {
-        return false;
-    }
-    target = subNode.nodeValue();
-    return true;
-}
-
-//-----------------------------------------------------------------------------
-static bool
-read_value(QDomNode& element, const char* tagName, QString& target)
-{
-    QDomElement de = element.firstChildElement(tagName);
-    if(de.isNull()) {
-        return false;
-    }
-    target = de.text();
-    return true;
-}
-
 //-----------------------------------------------------------------------------
 QGCCameraControl::QGCCameraControl(const mavlink_camera_information_t *info, Vehicle* vehicle, int compID, QObject* parent)
     : FactGroup(0, parent, true /* ignore camel case */)
@@ -161,6 +74,8 @@ QGCCameraControl::QGCCameraControl(const mavlink_camera_information_t *info, Veh
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
     memcpy(&_info, info, sizeof(mavlink_camera_information_t));
     connect(this, &QGCCameraControl::dataReady, this, &QGCCameraControl::_dataReady);
+    connect(&_definitionWatcher, &QFutureWatcherBase::finished, this, &QGCCameraControl::_definitionLoaded);
+    _media = new QGCCameraMedia(vehicle, compID, this);
     _vendor = QString(reinterpret_cast<const char*>(info->vendor_name));
     _modelName = QString(reinterpret_cast<const char*>(info->model_name));
     int ver = static_cast<int>(_info.cam_definition_version);
@@ -184,13 +99,19 @@ QGCCameraControl::QGCCameraControl(const mavlink_camera_information_t *info, Veh
     _recTimer.setSingleShot(false);
     _recTimer.setInterval(333);
     connect(&_recTimer, &QTimer::timeout, this, &QGCCameraControl::_recTimerHandler);
+    _paramClock.start();
+    _paramRequestTimer.setSingleShot(true);
+    _paramRequestTimer.setInterval(_paramRequestTimeoutMsecs);
+    connect(&_paramRequestTimer, &QTimer::timeout, this, &QGCCameraControl::_paramRequestTimeout);
+    _paramWriteTimer.setSingleShot(false);
+    _paramWriteTimer.setInterval(_paramWriteCheckMsecs);
+    connect(&_paramWriteTimer, &QTimer::timeout, this, &QGCCameraControl::_paramWriteCheck);
 }
 
 //-----------------------------------------------------------------------------
 QGCCameraControl::~QGCCameraControl()
 {
-    delete _netManager;
-    _netManager = nullptr;
+
 }
 
 //-----------------------------------------------------------------------------
@@ -216,9 +137,6 @@ QGCCameraControl::_initWhenReady()
     QTimer::singleShot(2500, this, &QGCCameraControl::_requestStorageInfo);
     _captureStatusTimer.start(2750);
     emit infoChanged();
-
-    delete _netManager;
-    _netManager = nullptr;
 }
 
 //-----------------------------------------------------------------------------
@@ -796,111 +714,42 @@ QGCCameraControl::_setPhotoStatus(PhotoStatus status)
 
 //-----------------------------------------------------------------------------
 bool
-QGCCameraControl::_loadCameraDefinitionFile(QByteArray& bytes)
-{
-    QByteArray originalData(bytes);
-    //-- Handle localization
-    if(!_handleLocalization(bytes)) {
-        return false;
-    }
-    int errorLine;
-    QString errorMsg;
-    QDomDocument doc;
-    if(!doc.setContent(bytes, false, &errorMsg, &errorLine)) {
-        qCritical() << "Unable to parse camera definition file on line:" << errorLine;
-        qCritical() << errorMsg;
-        return false;
-    }
-    //-- Load camera constants
-    QDomNodeList defElements = doc.elementsByTagName(kDefnition);
-    if(!defElements.size() || !_loadConstants(defElements)) {
-        qWarning() <<  "Unable to load camera constants from camera definition";
-        return false;
-    }
-    //-- Load camera parameters
-    QDomNodeList paramElements = doc.elementsByTagName(kParameters);
-    if(!paramElements.size() || !_loadSettings(paramElements)) {
+QGCCameraControl::_applyDefinition(const QGCCameraDefinition::Definition_t& definition)
+{
+    //-- Camera constants
+    _version   = definition.version;
+    _modelName = definition.model;
+    _vendor    = definition.vendor;
+    //-- Camera parameters
+    if(!_loadSettings(definition.parameters)) {
         qWarning() <<  "Unable to load camera parameters from camera definition";
         return false;
     }
-    //-- If this is new, cache it
-    if(!_cached) {
-        qCDebug(CameraControlLog) << "Saving camera definition file" << _cacheFile;
-        QFile file(_cacheFile);
-        if (!file.open(QIODevice::WriteOnly)) {
-            qWarning() << QString("Could not save cache file %1. Error: %2").arg(_cacheFile).arg(file.errorString());
-        } else {
-            file.write(originalData);
-        }
-    }
-    return true;
-}
-
-//-----------------------------------------------------------------------------
-bool
-QGCCameraControl::_loadConstants(const QDomNodeList nodeList)
-{
-    QDomNode node = nodeList.item(0);
-    if(!read_attribute(node, kVersion, _version)) {
-        return false;
-    }
-    if(!read_value(node, kModel, _modelName)) {
-        return false;
-    }
-    if(!read_value(node, kVendor, _vendor)) {
-        return false;
-    }
     return true;
 }
 
 //-----------------------------------------------------------------------------
 bool
-QGCCameraControl::_loadSettings(const QDomNodeList nodeList)
+QGCCameraControl::_loadSettings(const QList<QGCCameraDefinition::Parameter_t>& parameters)
 {
-    QDomNode node = nodeList.item(0);
-    QDomElement elem = node.toElement();
-    QDomNodeList parameters = elem.elementsByTagName(kParameter);
     //-- Pre-process settings (maintain order and skip non-controls)
-    for(int i = 0; i < parameters.size(); i++) {
-        QDomNode parameterNode = parameters.item(i);
-        QString name;
-        if(read_attribute(parameterNode, kName, name)) {
-            bool control = true;
-            read_attribute(parameterNode, kControl, control);
-            if(control) {
-                _settings << name;
-            }
-        } else {
-            qCritical() << "Parameter entry missing parameter name";
-            return false;
+    for(const QGCCameraDefinition::Parameter_t& parameter: parameters) {
+        if(parameter.control) {
+            _settings << parameter.name;
         }
     }
     //-- Load parameters
-    for(int i = 0; i < parameters.size(); i++) {
-        QDomNode parameterNode = parameters.item(i);
-        QString factName;
-        read_attribute(parameterNode, kName, factName);
-        QString type;
-        if(!read_attribute(parameterNode, kType, type)) {
-            qCritical() << QString("Parameter %1 missing parameter type").arg(factName);
-            return false;
-        }
+    for(const QGCCameraDefinition::Parameter_t& parameter: parameters) {
+        const QString& factName = parameter.name;
         //-- Does it have a control?
-        bool control = true;
-        read_attribute(parameterNode, kControl, control);
-        //-- Is it read only?
-        bool readOnly = false;
-        read_attribute(parameterNode, kReadOnly, readOnly);
-        //-- Is it write only?
-        bool writeOnly = false;
-        read_attribute(parameterNode, kWriteOnly, writeOnly);
+        bool control = parameter.control;
         //-- It can't be both
-        if(readOnly && writeOnly) {
+        if(parameter.readOnly && parameter.writeOnly) {
             qCritical() << QString("Parameter %1 cannot be both read only and write only").arg(factName);
         }
         //-- Param type
         bool unknownType;
-        FactMetaData::ValueType_t factType = FactMetaData::stringToType(type, unknownType);
+        FactMetaData::ValueType_t factType = FactMetaData::stringToType(parameter.type, unknownType);
         if (unknownType) {
             qCritical() << QString("Unknown type for parameter %1").arg(factName);
             return false;
@@ -909,63 +758,38 @@ QGCCameraControl::_loadSettings(const QDomNodeList nodeList)
         if(factType == FactMetaData::valueTypeCustom) {
             control = false;
         }
-        //-- Description
-        QString description;
-        if(!read_value(parameterNode, kDescription, description)) {
-            qCritical() << QString("Parameter %1 missing parameter description").arg(factName);
-            return false;
-        }
         //-- Check for updates
-        QStringList updates = _loadUpdates(parameterNode);
-        if(updates.size()) {
-            qCDebug(CameraControlVerboseLog) << "Parameter" << factName << "requires updates for:" << updates;
-            _requestUpdates[factName] = updates;
+        if(parameter.updates.size()) {
+            qCDebug(CameraControlVerboseLog) << "Parameter" << factName << "requires updates for:" << parameter.updates;
+            _requestUpdates[factName] = parameter.updates;
         }
         //-- Build metadata
         FactMetaData* metaData = new FactMetaData(factType, factName, this);
         QQmlEngine::setObjectOwnership(metaData, QQmlEngine::CppOwnership);
-        metaData->setShortDescription(description);
-        metaData->setLongDescription(description);
+        metaData->setShortDescription(parameter.description);
+        metaData->setLongDescription(parameter.description);
         metaData->setHasControl(control);
-        metaData->setReadOnly(readOnly);
-        metaData->setWriteOnly(writeOnly);
+        metaData->setReadOnly(parameter.readOnly);
+        metaData->setWriteOnly(parameter.writeOnly);
         //-- Options (enums)
-        QDomElement optionElem = parameterNode.toElement();
-        QDomNodeList optionsRoot = optionElem.elementsByTagName(kOptions);
-        if(optionsRoot.size()) {
-            //-- Iterate options
-            QDomNode node = optionsRoot.item(0);
-            QDomElement elem = node.toElement();
-            QDomNodeList options = elem.elementsByTagName(kOption);
-            for(int i = 0; i < options.size(); i++) {
-                QDomNode option = options.item(i);
-                QString optName;
-                QString optValue;
-                QVariant optVariant;
-                if(!_loadNameValue(option, factName, metaData, optName, optValue, optVariant)) {
-                    delete metaData;
-                    return false;
-                }
-                metaData->addEnumInfo(optName, optVariant);
-                _originalOptNames[factName]  << optName;
-                _originalOptValues[factName] << optVariant;
-                //-- Check for exclusions
-                QStringList exclusions = _loadExclusions(option);
-                if(exclusions.size()) {
-                    qCDebug(CameraControlVerboseLog) << "New exclusions:" << factName << optValue << exclusions;
-                    QGCCameraOptionExclusion* pExc = new QGCCameraOptionExclusion(this, factName, optValue, exclusions);
-                    QQmlEngine::setObjectOwnership(pExc, QQmlEngine::CppOwnership);
-                    _valueExclusions.append(pExc);
-                }
-                //-- Check for range rules
-                if(!_loadRanges(option, factName, optValue)) {
-                    delete metaData;
-                    return false;
-                }
+        for(const QGCCameraDefinition::Option_t& option: parameter.options) {
+            QVariant optVariant;
+            _loadNameValue(option, factName, metaData, optVariant);
+            metaData->addEnumInfo(option.name, optVariant);
+            _originalOptNames[factName]  << option.name;
+            _originalOptValues[factName] << optVariant;
+            //-- Check for exclusions
+            if(option.exclusions.size()) {
+                qCDebug(CameraControlVerboseLog) << "New exclusions:" << factName << option.value << option.exclusions;
+                QGCCameraOptionExclusion* pExc = new QGCCameraOptionExclusion(this, factName, option.value, option.exclusions);
+                QQmlEngine::setObjectOwnership(pExc, QQmlEngine::CppOwnership);
+                _valueExclusions.append(pExc);
             }
+            //-- Check for range rules
+            _loadRanges(option, factName);
         }
-        QString defaultValue;
-        if(read_attribute(parameterNode, kDefault, defaultValue)) {
+        if(parameter.attributes.contains(kDefault)) {
+            const QString defaultValue = parameter.attributes[kDefault];
             QVariant defaultVariant;
             QString  errorString;
             if (metaData->convertAndValidateRaw(defaultValue, false, defaultVariant, errorString)) {
@@ -984,8 +808,8 @@ QGCCameraControl::_loadSettings(const QDomNodeList nodeList)
         } else {
             {
                 //-- Check for Min Value
-                QString attr;
-                if(read_attribute(parameterNode, kMin, attr)) {
+                if(parameter.attributes.contains(kMin)) {
+                    const QString attr = parameter.attributes[kMin];
                     QVariant typedValue;
                     QString  errorString;
                     if (metaData->convertAndValidateRaw(attr, true /* convertOnly */, typedValue, errorString)) {
@@ -1000,8 +824,8 @@ QGCCameraControl::_loadSettings(const QDomNodeList nodeList)
             }
             {
                 //-- Check for Max Value
-                QString attr;
-                if(read_attribute(parameterNode, kMax, attr)) {
+                if(parameter.attributes.contains(kMax)) {
+                    const QString attr = parameter.attributes[kMax];
                     QVariant typedValue;
                     QString  errorString;
                     if (metaData->convertAndValidateRaw(attr, true /* convertOnly */, typedValue, errorString)) {
@@ -1016,8 +840,8 @@ QGCCameraControl::_loadSettings(const QDomNodeList nodeList)
             }
             {
                 //-- Check for Step Value
-                QString attr;
-                if(read_attribute(parameterNode, kStep, attr)) {
+                if(parameter.attributes.contains(kStep)) {
+                    const QString attr = parameter.attributes[kStep];
                     QVariant typedValue;
                     QString  errorString;
                     if (metaData->convertAndValidateRaw(attr, true /* convertOnly */, typedValue, errorString)) {
@@ -1032,8 +856,8 @@ QGCCameraControl::_loadSettings(const QDomNodeList nodeList)
             }
             {
                 //-- Check for Decimal Places
-                QString attr;
-                if(read_attribute(parameterNode, kDecimalPlaces, attr)) {
+                if(parameter.attributes.contains(kDecimalPlaces)) {
+                    const QString attr = parameter.attributes[kDecimalPlaces];
                     QVariant typedValue;
                     QString  errorString;
                     if (metaData->convertAndValidateRaw(attr, true /* convertOnly */, typedValue, errorString)) {
@@ -1048,12 +872,11 @@ QGCCameraControl::_loadSettings(const QDomNodeList nodeList)
             }
             {
                 //-- Check for Units
-                QString attr;
-                if(read_attribute(parameterNode, kUnit, attr)) {
-                    metaData->setRawUnits(attr);
+                if(parameter.attributes.contains(kUnit)) {
+                    metaData->setRawUnits(parameter.attributes[kUnit]);
                 }
             }
-            qCDebug(CameraControlLog) << "New parameter:" << factName << (readOnly ? "ReadOnly" : "Writable") << (writeOnly ? "WriteOnly" : "Readable");
+            qCDebug(CameraControlLog) << "New parameter:" << factName << (parameter.readOnly ? "ReadOnly" : "Writable") << (parameter.writeOnly ? "WriteOnly" : "Readable");
             _nameToFactMetaDataMap[factName] = metaData;
             Fact* pFact = new Fact(_compID, factName, factType, this);
             QQmlEngine::setObjectOwnership(pFact, QQmlEngine::CppOwnership);
@@ -1075,98 +898,19 @@ QGCCameraControl::_loadSettings(const QDomNodeList nodeList)
     return false;
 }
 
-//-----------------------------------------------------------------------------
-bool
-QGCCameraControl::_handleLocalization(QByteArray& bytes)
-{
-    QString errorMsg;
-    int errorLine;
-    QDomDocument doc;
-    if(!doc.setContent(bytes, false, &errorMsg, &errorLine)) {
-        qCritical() << "Unable to parse camera definition file on line:" << errorLine;
-        qCritical() << errorMsg;
-        return false;
-    }
-    //-- Find out where we are
-    QLocale locale = QLocale::system();
-#if defined (Q_OS_MAC)
-    locale = QLocale(locale.name());
-#endif
-    QString localeName = locale.name().toLower().replace("-", "_");
-    qCDebug(CameraControlLog) << "Current locale:" << localeName;
-    if(localeName == "en_us") {
-        // Nothing to do
-        return true;
-    }
-    QDomNodeList locRoot = doc.elementsByTagName(kLocalization);
-    if(!locRoot.size()) {
-        // Nothing to do
-        return true;
-    }
-    //-- Iterate locales
-    QDomNode node = locRoot.item(0);
-    QDomElement elem = node.toElement();
-    QDomNodeList locales = elem.elementsByTagName(kLocale);
-    for(int i = 0; i < locales.size(); i++) {
-        QDomNode locale = locales.item(i);
-        QString name;
-        if(!read_attribute(locale, kName, name)) {
-            qWarning() << "Localization entry is missing its name attribute";
-            continue;
-        }
-        // If we found a direct match, deal with it now
-        if(localeName == name.toLower().replace("-", "_")) {
-            return _replaceLocaleStrings(locale, bytes);
-        }
-    }
-    //-- No direct match. Pick first matching language (if any)
-    localeName = localeName.left(3);
-    for(int i = 0; i < locales.size(); i++) {
-        QDomNode locale = locales.item(i);
-        QString name;
-        read_attribute(locale, kName, name);
-        if(name.toLower().startsWith(localeName)) {
-            return _replaceLocaleStrings(locale, bytes);
-        }
-    }
-    //-- Could not find a language to use
-    qWarning() <<  "No match for" << QLocale::system().name() << "in camera definition file";
-    //-- Just use default, en_US
-    return true;
-}
-
-//-----------------------------------------------------------------------------
-bool
-QGCCameraControl::_replaceLocaleStrings(const QDomNode node, QByteArray& bytes)
-{
-    QDomElement stringElem = node.toElement();
-    QDomNodeList strings = stringElem.elementsByTagName(kStrings);
-    for(int i = 0; i < strings.size(); i++) {
-        QDomNode stringNode = strings.item(i);
-        QString original;
-        QString translated;
-        if(read_attribute(stringNode, kOriginal, original)) {
-            if(read_attribute(stringNode, kTranslated, translated)) {
-                QString o; o = "\"" + original + "\"";
-                QString t; t = "\"" + translated + "\"";
-                bytes.replace(o.toUtf8(), t.toUtf8());
-                o = ">" + original + "<";
-                t = ">" + translated + "<";
-                bytes.replace(o.toUtf8(), t.toUtf8());
-            }
-        }
-    }
-    return true;
-}
-
 //-----------------------------------------------------------------------------
 void
 QGCCameraControl::_requestAllParameters()
 {
     //-- Reset receive list
+    _waitingReadParams.clear();
+    _readBatchQueue.clear();
+    _readBatchQueueActive = false;
     for(const QString& paramName: _paramIO.keys()) {
         if(_paramIO[paramName]) {
-            _paramIO[paramName]->setParamRequest();
+            if(_paramIO[paramName]->setParamRequest()) {
+                _waitingReadParams[paramName] = 0;
+            }
         } else {
             qCritical() << "QGCParamIO is NULL" << paramName;
         }
@@ -1188,6 +932,108 @@ QGCCameraControl::_requestAllParameters()
         _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
     }
     qCDebug(CameraControlVerboseLog) << "Request all parameters";
+    //-- The camera streams the whole list, anything missing once it goes quiet is re-requested in batches
+    if(_waitingReadParams.count()) {
+        _paramRequestTimer.start();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraControl::_requestParam(const QString& paramName)
+{
+    if(!_paramIO[paramName]->setParamRequest()) {
+        _paramIO[paramName]->paramRequest();
+        return;
+    }
+    //-- While the list request is still coming in this is picked up by the first gap fill
+    _waitingReadParams[paramName] = 0;
+    if(_readBatchQueueActive && !_readBatchQueue.contains(paramName)) {
+        _readBatchQueue.append(paramName);
+    }
+    _paramIO[paramName]->paramRequest();
+    _paramRequestTimer.start();
+}
+
+//-----------------------------------------------------------------------------
+/// Re-requests missing parameters, at most _maxReadBatchSize at a time
+///     @param requestTimeout true: nothing came in for a while so everything in flight is lost, false: a parameter came in, make room for the next one
+/// @return true: Parameters were requested, false: No more requests needed
+bool
+QGCCameraControl::_fillReadBatchQueue(bool requestTimeout)
+{
+    if(!_readBatchQueueActive) {
+        return false;
+    }
+    if(requestTimeout) {
+        _readBatchQueue.clear();
+    }
+    for(const QString& paramName: _waitingReadParams.keys()) {
+        if(_readBatchQueue.count() >= _maxReadBatchSize) {
+            break;
+        }
+        if(_readBatchQueue.contains(paramName)) {
+            continue;
+        }
+        if(++_waitingReadParams[paramName] > _maxReadRetries) {
+            //-- Give up on this one
+            _waitingReadParams.remove(paramName);
+            _paramIO[paramName]->paramRequestFailed();
+        } else {
+            qCDebug(CameraControlLog) << "Param request retry:" << paramName << _waitingReadParams[paramName];
+            _readBatchQueue.append(paramName);
+            _paramIO[paramName]->paramRequest(false);
+        }
+    }
+    return _readBatchQueue.count() != 0;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraControl::_paramRequestTimeout()
+{
+    qCDebug(CameraControlLog) << "Param request timeout, waiting for" << _waitingReadParams.count();
+    _readBatchQueueActive = true;
+    if(_fillReadBatchQueue(true /* requestTimeout */)) {
+        _paramRequestTimer.start();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraControl::_scheduleParamWrite(const QString& paramName)
+{
+    _waitingWriteParams[paramName] = _paramClock.elapsed() + _paramWriteTimeoutMsecs;
+    if(!_paramWriteTimer.isActive()) {
+        _paramWriteTimer.start();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraControl::_cancelParamWrite(const QString& paramName)
+{
+    _waitingWriteParams.remove(paramName);
+    if(_waitingWriteParams.isEmpty()) {
+        _paramWriteTimer.stop();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraControl::_paramWriteCheck()
+{
+    const qint64 now = _paramClock.elapsed();
+    for(const QString& paramName: _waitingWriteParams.keys()) {
+        if(_waitingWriteParams.value(paramName, now + 1) <= now) {
+            //-- A retry schedules the write again
+            _waitingWriteParams.remove(paramName);
+            _paramIO[paramName]->paramWriteTimeout();
+        }
+    }
+    if(_waitingWriteParams.isEmpty()) {
+        _paramWriteTimer.stop();
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -1229,6 +1075,15 @@ QGCCameraControl::handleParamValue(const mavlink_param_ext_value_t& value)
     } else {
         qCritical() << "QGCParamIO is NULL" << paramName;
     }
+    if(_waitingReadParams.remove(paramName)) {
+        _readBatchQueue.removeOne(paramName);
+        _fillReadBatchQueue(false /* requestTimeout */);
+        if(_waitingReadParams.count()) {
+            _paramRequestTimer.start();
+        } else {
+            _paramRequestTimer.stop();
+        }
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -1437,7 +1292,7 @@ void
 QGCCameraControl::_requestParamUpdates()
 {
     for(const QString& param: _updatesToRequest) {
-        _paramIO[param]->paramRequest();
+        _requestParam(param);
     }
     _updatesToRequest.clear();
 }
@@ -1541,6 +1396,7 @@ QGCCameraControl::handleCaptureStatus(const mavlink_camera_capture_status_t& cap
         _recTime = _recTime.addMSecs(_recTime.msec() - static_cast<int>(cap.recording_time_ms));
         emit recordTimeChanged();
     }
+    _media->handleCaptureStatus(cap);
     //-- Video/Image Capture Status
     uint8_t vs = cap.video_status < static_cast<uint8_t>(VIDEO_CAPTURE_STATUS_LAST) ? cap.video_status : static_cast<uint8_t>(VIDEO_CAPTURE_STATUS_UNDEFINED);
     uint8_t ps = cap.image_status < static_cast<uint8_t>(PHOTO_CAPTURE_LAST) ? cap.image_status : static_cast<uint8_t>(PHOTO_CAPTURE_STATUS_UNDEFINED);
@@ -1565,6 +1421,13 @@ QGCCameraControl::handleCaptureStatus(const mavlink_camera_capture_status_t& cap
     }
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCCameraControl::handleImageCaptured(const mavlink_camera_image_captured_t& captured)
+{
+    _media->handleImageCaptured(captured);
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCCameraControl::handleVideoInfo(const mavlink_video_stream_information_t* vi)
@@ -1813,97 +1676,14 @@ QGCCameraControl::_streamStatusTimeout()
 }
 
 //-----------------------------------------------------------------------------
-QStringList
-QGCCameraControl::_loadExclusions(QDomNode option)
+void
+QGCCameraControl::_loadRanges(const QGCCameraDefinition::Option_t& option, const QString factName)
 {
-    QStringList exclusionList;
-    QDomElement optionElem = option.toElement();
-    QDomNodeList excRoot = optionElem.elementsByTagName(kExclusions);
-    if(excRoot.size()) {
-        //-- Iterate exclusions
-        QDomNode node = excRoot.item(0);
-        QDomElement elem = node.toElement();
-        QDomNodeList exclusions = elem.elementsByTagName(kExclusion);
-        for(int i = 0; i < exclusions.size(); i++) {
-            QString exclude = exclusions.item(i).toElement().text();
-            if(!exclude.isEmpty()) {
-                exclusionList << exclude;
-            }
-        }
-    }
-    return exclusionList;
-}
-
-//-----------------------------------------------------------------------------
-QStringList
-QGCCameraControl::_loadUpdates(QDomNode option)
-{
-    QStringList updateList;
-    QDomElement optionElem = option.toElement();
-    QDomNodeList updateRoot = optionElem.elementsByTagName(kUpdates);
-    if(updateRoot.size()) {
-        //-- Iterate updates
-        QDomNode node = updateRoot.item(0);
-        QDomElement elem = node.toElement();
-        QDomNodeList updates = elem.elementsByTagName(kUpdate);
-        for(int i = 0; i < updates.size(); i++) {
-            QString update = updates.item(i).toElement().text();
-            if(!update.isEmpty()) {
-                updateList << update;
-            }
-        }
-    }
-    return updateList;
-}
-
-//-----------------------------------------------------------------------------
-bool
-QGCCameraControl::_loadRanges(QDomNode option, const QString factName, QString paramValue)
-{
-    QDomElement optionElem = option.toElement();
-    QDomNodeList rangeRoot = optionElem.elementsByTagName(kParameterranges);
-    if(rangeRoot.size()) {
-        QDomNode node = rangeRoot.item(0);
-        QDomElement elem = node.toElement();
-        QDomNodeList parameterRanges = elem.elementsByTagName(kParameterrange);
-        //-- Iterate parameter ranges
-        for(int i = 0; i < parameterRanges.size(); i++) {
-            QString param;
-            QString condition;
-            QDomNode paramRange = parameterRanges.item(i);
-            if(!read_attribute(paramRange, kParameter, param)) {
-                qCritical() << QString("Malformed option range for parameter %1").arg(factName);
-                return false;
-            }
-            read_attribute(paramRange, kCondition, condition);
-            QDomElement pelem = paramRange.toElement();
-            QDomNodeList rangeOptions = pelem.elementsByTagName(kRoption);
-            QStringList  optNames;
-            QStringList  optValues;
-            //-- Iterate options
-            for(int i = 0; i < rangeOptions.size(); i++) {
-                QString optName;
-                QString optValue;
-                QDomNode roption = rangeOptions.item(i);
-                if(!read_attribute(roption, kName, optName)) {
-                    qCritical() << QString("Malformed roption for parameter %1").arg(factName);
-                    return false;
-                }
-                if(!read_attribute(roption, kValue, optValue)) {
-                    qCritical() << QString("Malformed rvalue for parameter %1").arg(factName);
-                    return false;
-                }
-                optNames  << optName;
-                optValues << optValue;
-            }
-            if(optNames.size()) {
-                QGCCameraOptionRange* pRange = new QGCCameraOptionRange(this, factName, paramValue, param, condition, optNames, optValues);
-                _optionRanges.append(pRange);
-                qCDebug(CameraControlVerboseLog) << "New range limit:" << factName << paramValue << param << condition << optNames << optValues;
-            }
-        }
+    for(const QGCCameraDefinition::Range_t& range: option.ranges) {
+        QGCCameraOptionRange* pRange = new QGCCameraOptionRange(this, factName, option.value, range.parameter, range.condition, range.optNames, range.optValues);
+        _optionRanges.append(pRange);
+        qCDebug(CameraControlVerboseLog) << "New range limit:" << factName << option.value << range.parameter << range.condition << range.optNames << range.optValues;
     }
-    return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -1931,54 +1711,48 @@ QGCCameraControl::_processRanges()
 }
 
 //-----------------------------------------------------------------------------
-bool
-QGCCameraControl::_loadNameValue(QDomNode option, const QString factName, FactMetaData* metaData, QString& optName, QString& optValue, QVariant& optVariant)
+void
+QGCCameraControl::_loadNameValue(const QGCCameraDefinition::Option_t& option, const QString factName, FactMetaData* metaData, QVariant& optVariant)
 {
-    if(!read_attribute(option, kName, optName)) {
-        qCritical() << QString("Malformed option for parameter %1").arg(factName);
-        return false;
-    }
-    if(!read_attribute(option, kValue, optValue)) {
-        qCritical() << QString("Malformed value for parameter %1").arg(factName);
-        return false;
-    }
     QString  errorString;
-    if (!metaData->convertAndValidateRaw(optValue, false, optVariant, errorString)) {
+    if (!metaData->convertAndValidateRaw(option.value, false, optVariant, errorString)) {
         qWarning() << "Invalid option value, name:" << factName
                    << " type:"  << metaData->type()
-                   << " value:" << optValue
+                   << " value:" << option.value
                    << " error:" << errorString;
     }
-    return true;
+}
+
+//-----------------------------------------------------------------------------
+QHash<QString, QGCCameraDefinition::Definition_t>&
+QGCCameraControl::_definitionCache()
+{
+    static QHash<QString, QGCCameraDefinition::Definition_t> cache;
+    return cache;
 }
 
 //-----------------------------------------------------------------------------
 void
 QGCCameraControl::_handleDefinitionFile(const QString &url)
 {
-    //-- First check and see if we have it cached
-    QFile xmlFile(_cacheFile);
-    if (!xmlFile.exists()) {
-        qCDebug(CameraControlLog) << "No camera definition file cached";
-        _httpRequest(url);
-        return;
-    }
-    if (!xmlFile.open(QIODevice::ReadOnly)) {
-        qWarning() << "Could not read cached camera definition file:" << _cacheFile;
-        _httpRequest(url);
+    _definitionUrl = url;
+    //-- Cameras of the same model, or a camera which connects again, share what was parsed before
+    auto it = _definitionCache().constFind(_definitionCacheKey());
+    if (it != _definitionCache().constEnd()) {
+        qCDebug(CameraControlLog) << "Using camera definition loaded before:" << _cacheFile;
+        _cached = true;
+        _applyDefinition(it.value());
+        _initWhenReady();
         return;
     }
-    QByteArray bytes = xmlFile.readAll();
-    QDomDocument doc;
-    if(!doc.setContent(bytes, false)) {
-        qWarning() << "Could not parse cached camera definition file:" << _cacheFile;
+    //-- Then check and see if we have it cached on disk
+    if (!QFile::exists(_cacheFile)) {
+        qCDebug(CameraControlLog) << "No camera definition file cached";
         _httpRequest(url);
         return;
     }
-    //-- We have it
-    qCDebug(CameraControlLog) << "Using cached camera definition file:" << _cacheFile;
-    _cached = true;
-    emit dataReady(bytes);
+    qCDebug(CameraControlLog) << "Loading cached camera definition file:" << _cacheFile;
+    _loadDefinition(QByteArray());
 }
 
 //-----------------------------------------------------------------------------
@@ -1986,21 +1760,14 @@ void
 QGCCameraControl::_httpRequest(const QString &url)
 {
     qCDebug(CameraControlLog) << "Request camera definition:" << url;
-    if(!_netManager) {
-        _netManager = new QNetworkAccessManager(this);
-    }
-    QNetworkProxy savedProxy = _netManager->proxy();
-    QNetworkProxy tempProxy;
-    tempProxy.setType(QNetworkProxy::DefaultProxy);
-    _netManager->setProxy(tempProxy);
     QNetworkRequest request(url);
     request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
     QSslConfiguration conf = request.sslConfiguration();
     conf.setPeerVerifyMode(QSslSocket::VerifyNone);
     request.setSslConfiguration(conf);
-    QNetworkReply* reply = _netManager->get(request);
+    QGCNetworkService::setConsumer(request, QGCNetworkService::consumerCamera);
+    QNetworkReply* reply = qgcApp()->toolbox()->networkService()->networkAccessManager()->get(request);
     connect(reply, &QNetworkReply::finished,  this, &QGCCameraControl::_downloadFinished);
-    _netManager->setProxy(savedProxy);
 }
 
 //-----------------------------------------------------------------------------
@@ -2011,6 +1778,7 @@ QGCCameraControl::_downloadFinished()
     if(!reply) {
         return;
     }
+    reply->deleteLater();
     int err = reply->error();
     int http_code = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
     QByteArray data = reply->readAll();
@@ -2030,9 +1798,46 @@ QGCCameraControl::_dataReady(QByteArray data)
 {
     if(data.size()) {
         qCDebug(CameraControlLog) << "Parsing camera definition";
-        _loadCameraDefinitionFile(data);
+        _loadDefinition(data);
     } else {
         qCDebug(CameraControlLog) << "No camera definition";
+        _initWhenReady();
+    }
+}
+
+//-----------------------------------------------------------------------------
+QString
+QGCCameraControl::_definitionCacheKey()
+{
+    return _cacheFile + QStringLiteral(":") + QGCCameraDefinition::systemLocaleName();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraControl::_loadDefinition(const QByteArray& bytes)
+{
+    //-- File access and parsing stay off the GUI thread, an empty bytes reads the cache file
+    _definitionWatcher.setFuture(QtConcurrent::run(&QGCCameraDefinition::load, _cacheFile, bytes, QGCCameraDefinition::systemLocaleName()));
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraControl::_definitionLoaded()
+{
+    const QGCCameraDefinition::Load_t result = _definitionWatcher.result();
+    if(!result.valid) {
+        if(result.fromCache) {
+            qWarning() << "Could not parse cached camera definition file:" << _cacheFile << result.errorString;
+            _httpRequest(_definitionUrl);
+            return;
+        }
+        qCritical() << result.errorString;
+    } else {
+        qCDebug(CameraControlLog) << "Camera definition loaded" << (result.fromCache ? "from cache" : "from camera");
+        _cached = result.fromCache;
+        if(_applyDefinition(result.definition)) {
+            _definitionCache()[_definitionCacheKey()] = result.definition;
+        }
     }
     _initWhenReady();
 }
@@ -2058,8 +1863,9 @@ void
 QGCCameraControl::_checkForVideoStreams()
 {
     if(_info.flags & CAMERA_CAP_FLAGS_HAS_VIDEO_STREAM) {
-        //-- Skip it if using Taisync as it has its own video settings
-        if(!qgcApp()->toolbox()->videoManager()->isTaisync()) {
+        //-- Skip it if there is no video (relay) or using Taisync as it has its own video settings
+        VideoManager* videoManager = qgcApp()->toolbox()->videoManager();
+        if(videoManager && !videoManager->isTaisync()) {
             connect(&_streamInfoTimer, &QTimer::timeout, this, &QGCCameraControl::_streamTimeout);
             _streamInfoTimer.setSingleShot(false);
             connect(&_streamStatusTimer, &QTimer::timeout, this, &QGCCameraControl::_streamStatusTimeout);
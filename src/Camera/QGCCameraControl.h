@@ -12,11 +12,13 @@
 #pragma once
 
 #include "QGCApplication.h"
+#include "QGCCameraDefinition.h"
 #include <QLoggingCategory>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
 
-class QDomNode;
-class QDomNodeList;
 class QGCCameraParamIO;
+class QGCCameraMedia;
 
 Q_DECLARE_LOGGING_CATEGORY(CameraControlLog)
 Q_DECLARE_LOGGING_CATEGORY(CameraControlVerboseLog)
@@ -197,6 +199,7 @@ public:
     Q_PROPERTY(QStringList  streamLabels        READ streamLabels                                   NOTIFY streamLabelsChanged)
     Q_PROPERTY(ThermalViewMode thermalMode      READ thermalMode        WRITE  setThermalMode       NOTIFY thermalModeChanged)
     Q_PROPERTY(double       thermalOpacity      READ thermalOpacity     WRITE  setThermalOpacity    NOTIFY thermalOpacityChanged)
+    Q_PROPERTY(QGCCameraMedia* media            READ media                                          CONSTANT)
 
     Q_INVOKABLE virtual void setVideoMode   ();
     Q_INVOKABLE virtual void setPhotoMode   ();
@@ -274,6 +277,9 @@ public:
     virtual double      thermalOpacity      () { return _thermalOpacity; }
     virtual void        setThermalOpacity   (double val);
 
+    /// Captures on the camera storage and their download
+    virtual QGCCameraMedia* media           () { return _media; }
+
     virtual void        setZoomLevel        (qreal level);
     virtual void        setFocusLevel       (qreal level);
     virtual void        setCameraMode       (CameraMode mode);
@@ -289,6 +295,7 @@ public:
     virtual void        handleBatteryStatus (const mavlink_battery_status_t& bs);
     virtual void        handleVideoInfo     (const mavlink_video_stream_information_t *vi);
     virtual void        handleVideoStatus   (const mavlink_video_stream_status_t *vs);
+    virtual void        handleImageCaptured (const mavlink_camera_image_captured_t& captured);
 
     /// Notify controller a parameter has changed
     virtual void        factChanged         (Fact* pFact);
@@ -356,25 +363,31 @@ protected slots:
     virtual void    _streamStatusTimeout    ();
     virtual void    _recTimerHandler        ();
     virtual void    _checkForVideoStreams   ();
+    virtual void    _definitionLoaded       ();
+    virtual void    _paramRequestTimeout    ();
+    virtual void    _paramWriteCheck        ();
 
 private:
-    bool    _handleLocalization             (QByteArray& bytes);
-    bool    _replaceLocaleStrings           (const QDomNode node, QByteArray& bytes);
-    bool    _loadCameraDefinitionFile       (QByteArray& bytes);
-    bool    _loadConstants                  (const QDomNodeList nodeList);
-    bool    _loadSettings                   (const QDomNodeList nodeList);
+    bool    _applyDefinition                (const QGCCameraDefinition::Definition_t& definition);
+    bool    _loadSettings                   (const QList<QGCCameraDefinition::Parameter_t>& parameters);
     void    _processRanges                  ();
     bool    _processCondition               (const QString condition);
     bool    _processConditionTest           (const QString conditionTest);
-    bool    _loadNameValue                  (QDomNode option, const QString factName, FactMetaData* metaData, QString& optName, QString& optValue, QVariant& optVariant);
-    bool    _loadRanges                     (QDomNode option, const QString factName, QString paramValue);
+    void    _loadNameValue                  (const QGCCameraDefinition::Option_t& option, const QString factName, FactMetaData* metaData, QVariant& optVariant);
+    void    _loadRanges                     (const QGCCameraDefinition::Option_t& option, const QString factName);
     void    _updateActiveList               ();
     void    _updateRanges                   (Fact* pFact);
     void    _httpRequest                    (const QString& url);
     void    _handleDefinitionFile           (const QString& url);
+    void    _loadDefinition                 (const QByteArray& bytes);
+    bool    _fillReadBatchQueue             (bool requestTimeout);
+    void    _requestParam                   (const QString& paramName);
+    void    _scheduleParamWrite             (const QString& paramName);
+    void    _cancelParamWrite               (const QString& paramName);
+    QString _definitionCacheKey             ();
+
+    static QHash<QString, QGCCameraDefinition::Definition_t>& _definitionCache();   ///< Parsed definitions by cache file and locale, GUI thread only
 
-    QStringList     _loadExclusions         (QDomNode option);
-    QStringList     _loadUpdates            (QDomNode option);
     QString         _getParamName           (const char* param_id);
 
 protected:
@@ -389,10 +402,11 @@ protected:
     uint32_t                            _storageFree        = 0;
     uint32_t                            _storageTotal       = 0;
     int                                 _batteryRemaining   = -1;
-    QNetworkAccessManager*              _netManager         = nullptr;
     QString                             _modelName;
     QString                             _vendor;
     QString                             _cacheFile;
+    QString                             _definitionUrl;
+    QFutureWatcher<QGCCameraDefinition::Load_t> _definitionWatcher;
     CameraMode                          _cameraMode         = CAM_MODE_UNDEFINED;
     StorageStatus                       _storageStatus      = STORAGE_NOT_SUPPORTED;
     PhotoMode                           _photoMode          = PHOTO_CAPTURE_SINGLE;
@@ -414,6 +428,19 @@ protected:
     QTimer                              _recTimer;
     QTime                               _recTime;
     uint32_t                            _recordTime         = 0;
+    //-- Parameter reads and writes waiting on the camera, retried from one timer each
+    QMap<QString, int>                  _waitingReadParams;             ///< Key: parameter name, Value: retry count
+    QStringList                         _readBatchQueue;                ///< Re-requests waiting on a response
+    bool                                _readBatchQueueActive = false;  ///< Re-requests start once the list request went quiet
+    QTimer                              _paramRequestTimer;
+    QMap<QString, qint64>               _waitingWriteParams;            ///< Key: parameter name, Value: _paramClock time the write times out
+    QTimer                              _paramWriteTimer;
+    QElapsedTimer                       _paramClock;
+    static const int                    _paramRequestTimeoutMsecs   = 3500;
+    static const int                    _paramWriteTimeoutMsecs     = 3000;
+    static const int                    _paramWriteCheckMsecs       = 250;
+    static const int                    _maxReadRetries             = 3;
+    static const int                    _maxReadBatchSize           = 5;    ///< Re-requests in flight at once
     //-- Parameters that require a full update
     QMap<QString, QStringList>          _requestUpdates;
     QStringList                         _updatesToRequest;
@@ -427,4 +454,5 @@ protected:
     QStringList                         _streamLabels;
     ThermalViewMode                     _thermalMode        = THERMAL_BLEND;
     double                              _thermalOpacity     = 85.0;
+    QGCCameraMedia*                     _media              = nullptr;
 };
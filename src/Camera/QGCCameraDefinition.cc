@@ -0,0 +1,402 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCCameraDefinition.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QLocale>
+#include <QXmlStreamReader>
+
+static const char* kCondition       = "condition";
+static const char* kControl         = "control";
+static const char* kDefnition       = "definition";
+static const char* kDescription     = "description";
+static const char* kExclusion       = "exclude";
+static const char* kExclusions      = "exclusions";
+static const char* kLocale          = "locale";
+static const char* kLocalization    = "localization";
+static const char* kModel           = "model";
+static const char* kName            = "name";
+static const char* kOption          = "option";
+static const char* kOptions         = "options";
+static const char* kOriginal        = "original";
+static const char* kParameter       = "parameter";
+static const char* kParameterrange  = "parameterrange";
+static const char* kParameterranges = "parameterranges";
+static const char* kParameters      = "parameters";
+static const char* kReadOnly        = "readonly";
+static const char* kWriteOnly       = "writeonly";
+static const char* kRoption         = "roption";
+static const char* kStrings         = "strings";
+static const char* kTranslated      = "translated";
+static const char* kType            = "type";
+static const char* kUpdate          = "update";
+static const char* kUpdates         = "updates";
+static const char* kValue           = "value";
+static const char* kVendor          = "vendor";
+static const char* kVersion         = "version";
+
+//-----------------------------------------------------------------------------
+static bool
+read_attribute(const QXmlStreamReader& xml, const char* name, QString& target)
+{
+    const QXmlStreamAttributes attrs = xml.attributes();
+    if(!attrs.hasAttribute(QLatin1String(name))) {
+        return false;
+    }
+    target = attrs.value(QLatin1String(name)).toString();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+static void
+read_attribute(const QXmlStreamReader& xml, const char* name, bool& target)
+{
+    QString value;
+    if(read_attribute(xml, name, value)) {
+        target = value != "0";
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCameraDefinition::parse(const QByteArray& bytes, const QString& localeName, Definition_t& definition, QString& errorString)
+{
+    QXmlStreamReader            xml(bytes);
+    QHash<QString, Strings_t>   locales;
+    QStringList                 localeNames;
+    bool                        haveDefinition = false;
+    bool                        haveParameters = false;
+
+    definition = Definition_t();
+    //-- The sections may be anywhere in the file, only the first of each is used
+    while(!xml.atEnd()) {
+        if(xml.readNext() != QXmlStreamReader::StartElement) {
+            continue;
+        }
+        if(xml.name() == QLatin1String(kDefnition) && !haveDefinition) {
+            if(!_readDefinition(xml, definition, errorString)) {
+                return false;
+            }
+            haveDefinition = true;
+        } else if(xml.name() == QLatin1String(kParameters) && !haveParameters) {
+            if(!_readParameters(xml, definition.parameters, errorString)) {
+                return false;
+            }
+            haveParameters = true;
+        } else if(xml.name() == QLatin1String(kLocalization) && localeNames.isEmpty()) {
+            _readLocalization(xml, locales, localeNames);
+        }
+    }
+    if(xml.hasError()) {
+        errorString = QString("Unable to parse camera definition file on line %1: %2").arg(xml.lineNumber()).arg(xml.errorString());
+        return false;
+    }
+    if(!haveDefinition) {
+        errorString = QStringLiteral("Unable to load camera constants from camera definition");
+        return false;
+    }
+    if(!haveParameters) {
+        errorString = QStringLiteral("Unable to load camera parameters from camera definition");
+        return false;
+    }
+
+    //-- Translate, if the file has strings for us
+    if(localeName != "en_us" && !localeNames.isEmpty()) {
+        //-- A direct match first, otherwise the first one for the same language
+        for(const QString& name: localeNames) {
+            if(localeName == name.toLower().replace("-", "_")) {
+                _translate(definition, locales[name]);
+                return true;
+            }
+        }
+        const QString language = localeName.left(3);
+        for(const QString& name: localeNames) {
+            if(name.toLower().startsWith(language)) {
+                _translate(definition, locales[name]);
+                return true;
+            }
+        }
+        qWarning() << "No match for" << localeName << "in camera definition file";
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+QGCCameraDefinition::Load_t
+QGCCameraDefinition::load(const QString& cacheFile, const QByteArray& bytes, const QString& localeName)
+{
+    Load_t result;
+    result.fromCache = bytes.isEmpty();
+
+    QByteArray fileBytes;
+    if(result.fromCache) {
+        QFile file(cacheFile);
+        if(!file.open(QIODevice::ReadOnly)) {
+            result.errorString = QString("Could not read cached camera definition file %1: %2").arg(cacheFile, file.errorString());
+            return result;
+        }
+        fileBytes = file.readAll();
+    }
+
+    result.valid = parse(result.fromCache ? fileBytes : bytes, localeName, result.definition, result.errorString);
+
+    //-- Only a definition which parses is worth keeping
+    if(result.valid && !result.fromCache) {
+        QFile file(cacheFile);
+        if(!file.open(QIODevice::WriteOnly)) {
+            qWarning() << QString("Could not save cache file %1. Error: %2").arg(cacheFile).arg(file.errorString());
+        } else {
+            file.write(bytes);
+        }
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+QString
+QGCCameraDefinition::systemLocaleName()
+{
+    QLocale locale = QLocale::system();
+#if defined (Q_OS_MAC)
+    locale = QLocale(locale.name());
+#endif
+    return locale.name().toLower().replace("-", "_");
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCameraDefinition::_readDefinition(QXmlStreamReader& xml, Definition_t& definition, QString& errorString)
+{
+    QString version;
+    if(!read_attribute(xml, kVersion, version)) {
+        errorString = QStringLiteral("Camera definition is missing its version");
+        return false;
+    }
+    definition.version = version.toInt();
+    bool haveModel  = false;
+    bool haveVendor = false;
+    while(xml.readNextStartElement()) {
+        if(xml.name() == QLatin1String(kModel)) {
+            definition.model = xml.readElementText();
+            haveModel = true;
+        } else if(xml.name() == QLatin1String(kVendor)) {
+            definition.vendor = xml.readElementText();
+            haveVendor = true;
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+    if(!haveModel || !haveVendor) {
+        errorString = QStringLiteral("Unable to load camera constants from camera definition");
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCameraDefinition::_readParameters(QXmlStreamReader& xml, QList<Parameter_t>& parameters, QString& errorString)
+{
+    while(xml.readNextStartElement()) {
+        if(xml.name() == QLatin1String(kParameter)) {
+            Parameter_t parameter;
+            if(!_readParameter(xml, parameter, errorString)) {
+                return false;
+            }
+            parameters.append(parameter);
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+    if(parameters.isEmpty()) {
+        errorString = QStringLiteral("Unable to load camera parameters from camera definition");
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCameraDefinition::_readParameter(QXmlStreamReader& xml, Parameter_t& parameter, QString& errorString)
+{
+    for(const QXmlStreamAttribute& attr: xml.attributes()) {
+        parameter.attributes[attr.name().toString()] = attr.value().toString();
+    }
+    if(!read_attribute(xml, kName, parameter.name)) {
+        errorString = QStringLiteral("Parameter entry missing parameter name");
+        return false;
+    }
+    if(!read_attribute(xml, kType, parameter.type)) {
+        errorString = QString("Parameter %1 missing parameter type").arg(parameter.name);
+        return false;
+    }
+    read_attribute(xml, kControl,   parameter.control);
+    read_attribute(xml, kReadOnly,  parameter.readOnly);
+    read_attribute(xml, kWriteOnly, parameter.writeOnly);
+
+    bool haveDescription = false;
+    bool haveOptions     = false;
+    while(xml.readNextStartElement()) {
+        if(xml.name() == QLatin1String(kDescription) && !haveDescription) {
+            parameter.description = xml.readElementText();
+            haveDescription = true;
+        } else if(xml.name() == QLatin1String(kOptions) && !haveOptions) {
+            if(!_readOptions(xml, parameter.name, parameter.options, errorString)) {
+                return false;
+            }
+            haveOptions = true;
+        } else if(xml.name() == QLatin1String(kUpdates)) {
+            _readStrings(xml, kUpdate, parameter.updates);
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+    if(!haveDescription) {
+        errorString = QString("Parameter %1 missing parameter description").arg(parameter.name);
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCameraDefinition::_readOptions(QXmlStreamReader& xml, const QString& factName, QList<Option_t>& options, QString& errorString)
+{
+    while(xml.readNextStartElement()) {
+        if(xml.name() != QLatin1String(kOption)) {
+            xml.skipCurrentElement();
+            continue;
+        }
+        Option_t option;
+        if(!read_attribute(xml, kName, option.name)) {
+            errorString = QString("Malformed option for parameter %1").arg(factName);
+            return false;
+        }
+        if(!read_attribute(xml, kValue, option.value)) {
+            errorString = QString("Malformed value for parameter %1").arg(factName);
+            return false;
+        }
+        while(xml.readNextStartElement()) {
+            if(xml.name() == QLatin1String(kExclusions)) {
+                _readStrings(xml, kExclusion, option.exclusions);
+            } else if(xml.name() == QLatin1String(kParameterranges)) {
+                if(!_readRanges(xml, factName, option.ranges, errorString)) {
+                    return false;
+                }
+            } else {
+                xml.skipCurrentElement();
+            }
+        }
+        options.append(option);
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCameraDefinition::_readRanges(QXmlStreamReader& xml, const QString& factName, QList<Range_t>& ranges, QString& errorString)
+{
+    while(xml.readNextStartElement()) {
+        if(xml.name() != QLatin1String(kParameterrange)) {
+            xml.skipCurrentElement();
+            continue;
+        }
+        Range_t range;
+        if(!read_attribute(xml, kParameter, range.parameter)) {
+            errorString = QString("Malformed option range for parameter %1").arg(factName);
+            return false;
+        }
+        read_attribute(xml, kCondition, range.condition);
+        while(xml.readNextStartElement()) {
+            if(xml.name() == QLatin1String(kRoption)) {
+                QString optName;
+                QString optValue;
+                if(!read_attribute(xml, kName, optName)) {
+                    errorString = QString("Malformed roption for parameter %1").arg(factName);
+                    return false;
+                }
+                if(!read_attribute(xml, kValue, optValue)) {
+                    errorString = QString("Malformed rvalue for parameter %1").arg(factName);
+                    return false;
+                }
+                range.optNames  << optName;
+                range.optValues << optValue;
+            }
+            xml.skipCurrentElement();
+        }
+        if(range.optNames.size()) {
+            ranges.append(range);
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraDefinition::_readStrings(QXmlStreamReader& xml, const QString& childName, QStringList& strings)
+{
+    while(xml.readNextStartElement()) {
+        if(xml.name() == childName) {
+            const QString text = xml.readElementText();
+            if(!text.isEmpty()) {
+                strings << text;
+            }
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraDefinition::_readLocalization(QXmlStreamReader& xml, QHash<QString, Strings_t>& locales, QStringList& localeNames)
+{
+    while(xml.readNextStartElement()) {
+        if(xml.name() != QLatin1String(kLocale)) {
+            xml.skipCurrentElement();
+            continue;
+        }
+        QString name;
+        if(!read_attribute(xml, kName, name)) {
+            qWarning() << "Localization entry is missing its name attribute";
+            xml.skipCurrentElement();
+            continue;
+        }
+        Strings_t& strings = locales[name];
+        localeNames << name;
+        while(xml.readNextStartElement()) {
+            QString original;
+            QString translated;
+            if(xml.name() == QLatin1String(kStrings) && read_attribute(xml, kOriginal, original) && read_attribute(xml, kTranslated, translated)) {
+                strings[original] = translated;
+            }
+            xml.skipCurrentElement();
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraDefinition::_translate(Definition_t& definition, const Strings_t& strings)
+{
+    //-- Only what is shown to the user, names and values are what the camera knows
+    for(Parameter_t& parameter: definition.parameters) {
+        parameter.description = strings.value(parameter.description, parameter.description);
+        for(Option_t& option: parameter.options) {
+            option.name = strings.value(option.name, option.name);
+            for(Range_t& range: option.ranges) {
+                for(QString& optName: range.optNames) {
+                    optName = strings.value(optName, optName);
+                }
+            }
+        }
+    }
+}
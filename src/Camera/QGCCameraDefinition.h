@@ -0,0 +1,89 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class QXmlStreamReader;
+
+/// Contents of a MAVLink camera definition file. The file is read with a single streaming pass, which is
+/// safe to run on a worker thread as nothing here touches a QObject. Turning the contents into Facts
+/// is left to QGCCameraControl.
+class QGCCameraDefinition
+{
+public:
+    typedef struct {
+        QString     parameter;              ///< Parameter whose options are limited
+        QString     condition;
+        QStringList optNames;
+        QStringList optValues;
+    } Range_t;
+
+    typedef struct {
+        QString         name;
+        QString         value;
+        QStringList     exclusions;         ///< Parameters which don't apply while this option is set
+        QList<Range_t>  ranges;
+    } Option_t;
+
+    typedef struct {
+        QString                 name;
+        QString                 type;
+        QString                 description;
+        bool                    control     = true;
+        bool                    readOnly    = false;
+        bool                    writeOnly   = false;
+        QStringList             updates;    ///< Parameters to request again after this one changed
+        QList<Option_t>         options;
+        QHash<QString, QString> attributes; ///< All attributes of the parameter element, for the optional ones such as min and max
+    } Parameter_t;
+
+    typedef struct {
+        int                 version = 0;
+        QString             model;
+        QString             vendor;
+        QList<Parameter_t>  parameters;
+    } Definition_t;
+
+    typedef struct {
+        bool            valid       = false;
+        bool            fromCache   = false;    ///< Read from the cache file rather than downloaded
+        Definition_t    definition;
+        QString         errorString;
+    } Load_t;
+
+    /// Parses a camera definition file
+    ///     @param localeName Lower case locale such as pt_br, descriptions and option names are translated if the file has strings for it
+    /// @return false if the file is malformed, errorString says why
+    static bool parse(const QByteArray& bytes, const QString& localeName, Definition_t& definition, QString& errorString);
+
+    /// Loads a camera definition, meant to run on a worker thread
+    ///     @param bytes Downloaded file, which is saved to cacheFile if it parses. The cache file is read if bytes is empty.
+    static Load_t load(const QString& cacheFile, const QByteArray& bytes, const QString& localeName);
+
+    /// @return Lower case name of the system locale such as pt_br
+    static QString systemLocaleName(void);
+
+private:
+    typedef QHash<QString, QString> Strings_t;  ///< Original to translated
+
+    static bool _readDefinition (QXmlStreamReader& xml, Definition_t& definition, QString& errorString);
+    static bool _readParameters (QXmlStreamReader& xml, QList<Parameter_t>& parameters, QString& errorString);
+    static bool _readParameter  (QXmlStreamReader& xml, Parameter_t& parameter, QString& errorString);
+    static bool _readOptions    (QXmlStreamReader& xml, const QString& factName, QList<Option_t>& options, QString& errorString);
+    static bool _readRanges     (QXmlStreamReader& xml, const QString& factName, QList<Range_t>& ranges, QString& errorString);
+    static void _readStrings    (QXmlStreamReader& xml, const QString& childName, QStringList& strings);
+    static void _readLocalization(QXmlStreamReader& xml, QHash<QString, Strings_t>& locales, QStringList& localeNames);
+    static void _translate      (Definition_t& definition, const Strings_t& strings);
+};
@@ -0,0 +1,167 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCCameraDefinitionTest.h"
+#include "QGCCameraDefinition.h"
+
+#include <QTemporaryDir>
+
+// Localization at the end of the file, as in camera_definition_example.xml
+static const char* kDefinition =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"
+        "<mavlinkcamera>"
+        "  <definition version=\"3\"><model>SD II</model><vendor>Super Dupper Industries</vendor></definition>"
+        "  <parameters>"
+        "    <parameter name=\"CAM_MODE\" type=\"uint32\" default=\"1\" control=\"0\">"
+        "      <description>Camera Mode</description>"
+        "      <options>"
+        "        <option name=\"Photo\" value=\"0\">"
+        "          <exclusions><exclude>CAM_VIDRES</exclude><exclude>CAM_VIDFMT</exclude></exclusions>"
+        "        </option>"
+        "        <option name=\"Video\" value=\"1\">"
+        "          <parameterranges>"
+        "            <parameterrange parameter=\"CAM_ISO\" condition=\"CAM_EXPMODE=1\">"
+        "              <roption name=\"Auto\" value=\"0\" />"
+        "              <roption name=\"100\" value=\"100\" />"
+        "            </parameterrange>"
+        "          </parameterranges>"
+        "        </option>"
+        "      </options>"
+        "      <updates><update>CAM_ISO</update></updates>"
+        "    </parameter>"
+        "    <parameter name=\"CAM_EV\" type=\"float\" default=\"0\" min=\"-2\" max=\"2\" step=\"0.5\" readonly=\"1\">"
+        "      <description>Exposure Compensation</description>"
+        "    </parameter>"
+        "  </parameters>"
+        "  <localization>"
+        "    <locale name=\"pt_BR\">"
+        "      <strings original=\"Camera Mode\" translated=\"Modo de Operação\" />"
+        "      <strings original=\"Video\" translated=\"Vídeo\" />"
+        "      <strings original=\"Auto\" translated=\"Automático\" />"
+        "    </locale>"
+        "    <locale name=\"de-DE\">"
+        "      <strings original=\"Camera Mode\" translated=\"Kameramodus\" />"
+        "    </locale>"
+        "  </localization>"
+        "</mavlinkcamera>";
+
+void QGCCameraDefinitionTest::_parseTest(void)
+{
+    QGCCameraDefinition::Definition_t   definition;
+    QString                             errorString;
+
+    QVERIFY(QGCCameraDefinition::parse(kDefinition, QStringLiteral("en_us"), definition, errorString));
+    QCOMPARE(definition.version, 3);
+    QCOMPARE(definition.model, QStringLiteral("SD II"));
+    QCOMPARE(definition.vendor, QStringLiteral("Super Dupper Industries"));
+    QCOMPARE(definition.parameters.count(), 2);
+
+    const QGCCameraDefinition::Parameter_t& mode = definition.parameters[0];
+    QCOMPARE(mode.name, QStringLiteral("CAM_MODE"));
+    QCOMPARE(mode.type, QStringLiteral("uint32"));
+    QCOMPARE(mode.description, QStringLiteral("Camera Mode"));
+    QVERIFY(!mode.control);
+    QVERIFY(!mode.readOnly);
+    QCOMPARE(mode.attributes.value(QStringLiteral("default")), QStringLiteral("1"));
+    QCOMPARE(mode.updates, QStringList({ QStringLiteral("CAM_ISO") }));
+    QCOMPARE(mode.options.count(), 2);
+    QCOMPARE(mode.options[0].name, QStringLiteral("Photo"));
+    QCOMPARE(mode.options[0].exclusions, QStringList({ QStringLiteral("CAM_VIDRES"), QStringLiteral("CAM_VIDFMT") }));
+    QVERIFY(mode.options[0].ranges.isEmpty());
+    QCOMPARE(mode.options[1].value, QStringLiteral("1"));
+    QCOMPARE(mode.options[1].ranges.count(), 1);
+    QCOMPARE(mode.options[1].ranges[0].parameter, QStringLiteral("CAM_ISO"));
+    QCOMPARE(mode.options[1].ranges[0].condition, QStringLiteral("CAM_EXPMODE=1"));
+    QCOMPARE(mode.options[1].ranges[0].optNames, QStringList({ QStringLiteral("Auto"), QStringLiteral("100") }));
+    QCOMPARE(mode.options[1].ranges[0].optValues, QStringList({ QStringLiteral("0"), QStringLiteral("100") }));
+
+    const QGCCameraDefinition::Parameter_t& ev = definition.parameters[1];
+    QVERIFY(ev.control);
+    QVERIFY(ev.readOnly);
+    QVERIFY(ev.options.isEmpty());
+    QCOMPARE(ev.attributes.value(QStringLiteral("min")), QStringLiteral("-2"));
+    QCOMPARE(ev.attributes.value(QStringLiteral("step")), QStringLiteral("0.5"));
+    QVERIFY(!ev.attributes.contains(QStringLiteral("unit")));
+}
+
+void QGCCameraDefinitionTest::_localizationTest(void)
+{
+    QGCCameraDefinition::Definition_t   definition;
+    QString                             errorString;
+
+    // Direct match, only what the user sees is translated
+    QVERIFY(QGCCameraDefinition::parse(kDefinition, QStringLiteral("pt_br"), definition, errorString));
+    QCOMPARE(definition.parameters[0].description, QString::fromUtf8("Modo de Operação"));
+    QCOMPARE(definition.parameters[0].options[1].name, QString::fromUtf8("Vídeo"));
+    QCOMPARE(definition.parameters[0].options[1].ranges[0].optNames[0], QString::fromUtf8("Automático"));
+    QCOMPARE(definition.parameters[0].options[1].ranges[0].optValues[0], QStringLiteral("0"));
+    QCOMPARE(definition.parameters[0].name, QStringLiteral("CAM_MODE"));
+
+    // Same language, other country
+    QVERIFY(QGCCameraDefinition::parse(kDefinition, QStringLiteral("pt_pt"), definition, errorString));
+    QCOMPARE(definition.parameters[0].description, QString::fromUtf8("Modo de Operação"));
+
+    // Locale names may use a dash
+    QVERIFY(QGCCameraDefinition::parse(kDefinition, QStringLiteral("de_de"), definition, errorString));
+    QCOMPARE(definition.parameters[0].description, QStringLiteral("Kameramodus"));
+
+    // No strings for the language
+    QVERIFY(QGCCameraDefinition::parse(kDefinition, QStringLiteral("fr_fr"), definition, errorString));
+    QCOMPARE(definition.parameters[0].description, QStringLiteral("Camera Mode"));
+}
+
+void QGCCameraDefinitionTest::_malformedTest(void)
+{
+    const QList<QByteArray> bad = {
+        // Not XML
+        "<mavlinkcamera><definition version=\"1\">",
+        // No definition
+        "<mavlinkcamera><parameters><parameter name=\"A\" type=\"uint32\"><description>A</description></parameter></parameters></mavlinkcamera>",
+        // No parameters
+        "<mavlinkcamera><definition version=\"1\"><model>M</model><vendor>V</vendor></definition></mavlinkcamera>",
+        // Parameter without a type
+        "<mavlinkcamera><definition version=\"1\"><model>M</model><vendor>V</vendor></definition>"
+        "<parameters><parameter name=\"A\"><description>A</description></parameter></parameters></mavlinkcamera>",
+        // Option without a value
+        "<mavlinkcamera><definition version=\"1\"><model>M</model><vendor>V</vendor></definition>"
+        "<parameters><parameter name=\"A\" type=\"uint32\"><description>A</description><options><option name=\"B\"/></options></parameter></parameters></mavlinkcamera>",
+    };
+    for (const QByteArray& bytes: bad) {
+        QGCCameraDefinition::Definition_t   definition;
+        QString                             errorString;
+        QVERIFY(!QGCCameraDefinition::parse(bytes, QStringLiteral("en_us"), definition, errorString));
+        QVERIFY(!errorString.isEmpty());
+    }
+}
+
+void QGCCameraDefinitionTest::_cacheTest(void)
+{
+    QTemporaryDir   dir;
+    const QString   cacheFile = dir.filePath(QStringLiteral("Vendor_Model_003.xml"));
+
+    // Nothing cached yet
+    QGCCameraDefinition::Load_t result = QGCCameraDefinition::load(cacheFile, QByteArray(), QStringLiteral("en_us"));
+    QVERIFY(!result.valid);
+    QVERIFY(result.fromCache);
+
+    // A downloaded file which doesn't parse isn't cached
+    result = QGCCameraDefinition::load(cacheFile, "<mavlinkcamera>", QStringLiteral("en_us"));
+    QVERIFY(!result.valid);
+    QVERIFY(!QFile::exists(cacheFile));
+
+    result = QGCCameraDefinition::load(cacheFile, kDefinition, QStringLiteral("en_us"));
+    QVERIFY(result.valid);
+    QVERIFY(!result.fromCache);
+    QVERIFY(QFile::exists(cacheFile));
+
+    result = QGCCameraDefinition::load(cacheFile, QByteArray(), QStringLiteral("en_us"));
+    QVERIFY(result.valid);
+    QVERIFY(result.fromCache);
+    QCOMPARE(result.definition.parameters.count(), 2);
+}
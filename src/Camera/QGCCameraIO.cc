@@ -18,23 +18,15 @@ QGCCameraParamIO::QGCCameraParamIO(QGCCameraControl *control, Fact* fact, Vehicl
     , _fact(fact)
     , _vehicle(vehicle)
     , _sentRetries(0)
-    , _requestRetries(0)
     , _done(false)
     , _updateOnSet(false)
     , _forceUIUpdate(false)
 {
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
-    _paramWriteTimer.setSingleShot(true);
-    _paramWriteTimer.setInterval(3000);
-    _paramRequestTimer.setSingleShot(true);
-    _paramRequestTimer.setInterval(3500);
     if(_fact->writeOnly()) {
         //-- Write mode is always "done" as it won't ever read
         _done = true;
-    } else {
-        connect(&_paramRequestTimer, &QTimer::timeout, this, &QGCCameraParamIO::_paramRequestTimeout);
     }
-    connect(&_paramWriteTimer,   &QTimer::timeout, this, &QGCCameraParamIO::_paramWriteTimeout);
     connect(_fact, &Fact::rawValueChanged, this, &QGCCameraParamIO::_factChanged);
     connect(_fact, &Fact::_containerRawValueChanged, this, &QGCCameraParamIO::_containerRawValueChanged);
     _pMavlink = qgcApp()->toolbox()->mavlinkProtocol();
@@ -84,14 +76,10 @@ QGCCameraParamIO::QGCCameraParamIO(QGCCameraControl *control, Fact* fact, Vehicl
 }
 
 //-----------------------------------------------------------------------------
-void
+bool
 QGCCameraParamIO::setParamRequest()
 {
-    if(!_fact->writeOnly()) {
-        _paramRequestReceived = false;
-        _requestRetries = 0;
-        _paramRequestTimer.start();
-    }
+    return !_fact->writeOnly();
 }
 
 //-----------------------------------------------------------------------------
@@ -197,12 +185,12 @@ QGCCameraParamIO::_sendParameter()
                     &p);
         _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
     }
-    _paramWriteTimer.start();
+    _control->_scheduleParamWrite(_fact->name());
 }
 
 //-----------------------------------------------------------------------------
 void
-QGCCameraParamIO::_paramWriteTimeout()
+QGCCameraParamIO::paramWriteTimeout()
 {
     if(++_sentRetries > 3) {
         qCWarning(CameraIOLog) << "No response for param set:" << _fact->name();
@@ -211,7 +199,6 @@ QGCCameraParamIO::_paramWriteTimeout()
         //-- Send it again
         qCDebug(CameraIOLog) << "Param set retry:" << _fact->name() << _sentRetries;
         _sendParameter();
-        _paramWriteTimer.start();
     }
 }
 
@@ -219,7 +206,7 @@ QGCCameraParamIO::_paramWriteTimeout()
 void
 QGCCameraParamIO::handleParamAck(const mavlink_param_ext_ack_t& ack)
 {
-    _paramWriteTimer.stop();
+    _control->_cancelParamWrite(_fact->name());
     if(ack.param_result == PARAM_ACK_ACCEPTED) {
         QVariant val = _valueFromMessage(ack.param_value, ack.param_type);
         if(_fact->rawValue() != val) {
@@ -232,13 +219,13 @@ QGCCameraParamIO::handleParamAck(const mavlink_param_ext_ack_t& ack)
     } else if(ack.param_result == PARAM_ACK_IN_PROGRESS) {
         //-- Wait a bit longer for this one
         qCDebug(CameraIOLogVerbose) << "Param set in progress:" << _fact->name();
-        _paramWriteTimer.start();
+        _control->_scheduleParamWrite(_fact->name());
     } else {
         if(ack.param_result == PARAM_ACK_FAILED) {
             if(++_sentRetries < 3) {
                 //-- Try again
                 qCWarning(CameraIOLog) << "Param set failed:" << _fact->name() << _sentRetries;
-                _paramWriteTimer.start();
+                _control->_scheduleParamWrite(_fact->name());
             }
             return;
         } else if(ack.param_result == PARAM_ACK_VALUE_UNSUPPORTED) {
@@ -258,12 +245,10 @@ QGCCameraParamIO::handleParamAck(const mavlink_param_ext_ack_t& ack)
 void
 QGCCameraParamIO::handleParamValue(const mavlink_param_ext_value_t& value)
 {
-    _paramRequestTimer.stop();
     QVariant newValue = _valueFromMessage(value.param_value, value.param_type);
     if(_control->incomingParameter(_fact, newValue)) {
         _fact->_containerSetRawValue(newValue);
     }
-    _paramRequestReceived = true;
     if(_forceUIUpdate) {
         emit _fact->rawValueChanged(_fact->rawValue());
         emit _fact->valueChanged(_fact->rawValue());
@@ -323,19 +308,12 @@ QGCCameraParamIO::_valueFromMessage(const char* value, uint8_t param_type)
 
 //-----------------------------------------------------------------------------
 void
-QGCCameraParamIO::_paramRequestTimeout()
+QGCCameraParamIO::paramRequestFailed()
 {
-    if(++_requestRetries > 3) {
-        qCWarning(CameraIOLog) << "No response for param request:" << _fact->name();
-        if(!_done) {
-            _done = true;
-            _control->_paramDone();
-        }
-    } else {
-        //-- Request it again
-        qCDebug(CameraIOLog) << "Param request retry:" << _fact->name();
-        paramRequest(false);
-        _paramRequestTimer.start();
+    qCWarning(CameraIOLog) << "No response for param request:" << _fact->name();
+    if(!_done) {
+        _done = true;
+        _control->_paramDone();
     }
 }
 
@@ -352,7 +330,6 @@ QGCCameraParamIO::paramRequest(bool reset)
         return;
     }
     if(reset) {
-        _requestRetries = 0;
         _forceUIUpdate  = true;
     }
     qCDebug(CameraIOLog) << "Request parameter:" << _fact->name();
@@ -376,5 +353,4 @@ QGCCameraParamIO::paramRequest(bool reset)
                     0);                                                 // trimmed messages = false
         _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
     }
-    _paramRequestTimer.start();
 }
@@ -38,7 +38,8 @@ typedef struct {
 }) param_ext_union_t;
 
 //-----------------------------------------------------------------------------
-/// Camera parameter handler.
+/// Camera parameter handler. Retries are scheduled by QGCCameraControl, which shares one timer for reads and
+/// one for writes across all parameters.
 class QGCCameraParamIO : public QObject
 {
 public:
@@ -46,17 +47,17 @@ public:
 
     void        handleParamAck              (const mavlink_param_ext_ack_t& ack);
     void        handleParamValue            (const mavlink_param_ext_value_t& value);
-    void        setParamRequest             ();
+    bool        setParamRequest             ();     ///< @return false if there is nothing to read, as for write only parameters
     bool        paramDone                   () { return _done; }
     void        paramRequest                (bool reset = true);
+    void        paramRequestFailed          ();     ///< Gives up on reading the parameter
+    void        paramWriteTimeout           ();
     void        sendParameter               (bool updateUI = false);
 
     QStringList  optNames;
     QVariantList optVariants;
 
 private slots:
-    void        _paramWriteTimeout          ();
-    void        _paramRequestTimeout        ();
     void        _factChanged                (QVariant value);
     void        _containerRawValueChanged   (const QVariant value);
 
@@ -69,14 +70,9 @@ private:
     Fact*               _fact;
     Vehicle*            _vehicle;
     int                 _sentRetries;
-    int                 _requestRetries;
-    bool                _paramRequestReceived;
-    QTimer              _paramWriteTimer;
-    QTimer              _paramRequestTimer;
     bool                _done;
     bool                _updateOnSet;
     MAV_PARAM_EXT_TYPE  _mavParamType;
     MAVLinkProtocol*    _pMavlink;
     bool                _forceUIUpdate;
 };
-
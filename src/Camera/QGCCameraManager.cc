@@ -101,6 +101,9 @@ QGCCameraManager::_mavlinkMessageReceived(const mavlink_message_t& message)
             case MAVLINK_MSG_ID_BATTERY_STATUS:
                 _handleBatteryStatus(message);
                 break;
+            case MAVLINK_MSG_ID_CAMERA_IMAGE_CAPTURED:
+                _handleImageCaptured(message);
+                break;
         }
     }
 }
@@ -371,6 +374,18 @@ QGCCameraManager::_handleBatteryStatus(const mavlink_message_t& message)
     }
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCCameraManager::_handleImageCaptured(const mavlink_message_t& message)
+{
+    QGCCameraControl* pCamera = _findCamera(message.compid);
+    if(pCamera) {
+        mavlink_camera_image_captured_t captured;
+        mavlink_msg_camera_image_captured_decode(&message, &captured);
+        pCamera->handleImageCaptured(captured);
+    }
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCCameraManager::_requestCameraInfo(int compID)
@@ -0,0 +1,630 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCCameraMedia.h"
+#include "QGCApplication.h"
+#include "QGCImageProvider.h"
+#include "QGCNetworkService.h"
+#include "SettingsManager.h"
+#include "FTPManager.h"
+#include "Vehicle.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QNetworkReply>
+#include <QQmlEngine>
+#include <QUrl>
+#include <QtConcurrent>
+
+#include <iterator>
+
+QGC_LOGGING_CATEGORY(CameraMediaLog, "CameraMediaLog")
+
+//-----------------------------------------------------------------------------
+QGCCameraMediaItem::QGCCameraMediaItem(const mavlink_camera_image_captured_t& captured, QObject* parent)
+    : QObject(parent)
+    , _index(captured.image_index)
+    , _relativeAlt(captured.relative_alt / 1000.0f)
+    , _captureResult(captured.capture_result)
+{
+    QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
+    if(captured.time_utc) {
+        _time = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(captured.time_utc / 1000), Qt::UTC);
+    }
+    if(captured.lat || captured.lon) {
+        _coordinate = QGeoCoordinate(captured.lat / 1.0e7, captured.lon / 1.0e7, captured.alt / 1000.0);
+    }
+    for(int i = 0; i < 4; i++) {
+        _q[i] = captured.q[i];
+    }
+    //-- file_url isn't terminated when it fills the field
+    _fileUrl  = QString::fromLatin1(captured.file_url, static_cast<int>(qstrnlen(captured.file_url, sizeof(captured.file_url))));
+    _fileName = QFileInfo(QUrl(_fileUrl).path()).fileName();
+    if(_fileName.isEmpty()) {
+        _fileName = QStringLiteral("IMG_%1.jpg").arg(_index, 5, 10, QLatin1Char('0'));
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCameraMediaItem::isHttp() const
+{
+    return _fileUrl.startsWith(QStringLiteral("http://"), Qt::CaseInsensitive) || _fileUrl.startsWith(QStringLiteral("https://"), Qt::CaseInsensitive);
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCameraMediaItem::hasPosition() const
+{
+    return _captureResult == 1 && _coordinate.isValid();
+}
+
+//-----------------------------------------------------------------------------
+GeoTagWorker::cameraFeedbackPacket
+QGCCameraMediaItem::geotag() const
+{
+    GeoTagWorker::cameraFeedbackPacket geotag = {};
+    geotag.timestamp        = _time.isValid() ? _time.toMSecsSinceEpoch() / 1000.0 : 0;
+    geotag.timestampUTC     = geotag.timestamp;
+    geotag.imageSequence    = static_cast<uint32_t>(_index);
+    geotag.latitude         = _coordinate.latitude();
+    geotag.longitude        = _coordinate.longitude();
+    geotag.altitude         = static_cast<float>(_coordinate.altitude());
+    geotag.groundDistance   = _relativeAlt;
+    for(int i = 0; i < 4; i++) {
+        geotag.attitudeQuaternion[i] = _q[i];
+    }
+    geotag.captureResult    = static_cast<uint8_t>(_captureResult);
+    return geotag;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMediaItem::_setState(MediaState state, const QString& errorString)
+{
+    if(_state != state || _errorString != errorString) {
+        _state       = state;
+        _errorString = errorString;
+        emit stateChanged();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMediaItem::_setProgress(double progress)
+{
+    if(!qFuzzyCompare(_progress, progress)) {
+        _progress = progress;
+        emit progressChanged();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMediaItem::_setThumbnail(const QString& thumbnail)
+{
+    if(_thumbnail != thumbnail) {
+        _thumbnail = thumbnail;
+        emit thumbnailChanged();
+    }
+}
+
+//-----------------------------------------------------------------------------
+QGCCameraMedia::QGCCameraMedia(Vehicle* vehicle, int compID, QObject* parent)
+    : QObject(parent)
+    , _vehicle(vehicle)
+    , _compID(compID)
+{
+    QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
+    _listTimer.setSingleShot(true);
+    _listTimer.setInterval(listTimeoutMsecs);
+    connect(&_listTimer, &QTimer::timeout, this, &QGCCameraMedia::_listTimeout);
+    _ftpRetryTimer.setSingleShot(true);
+    _ftpRetryTimer.setInterval(ftpRetryMsecs);
+    connect(&_ftpRetryTimer, &QTimer::timeout, this, &QGCCameraMedia::_startDownloads);
+    FTPManager* ftpManager = _vehicle->ftpManager();
+    connect(ftpManager, &FTPManager::downloadComplete, this, &QGCCameraMedia::_ftpDownloadComplete);
+    connect(ftpManager, &FTPManager::downloadProgress, this, &QGCCameraMedia::_ftpDownloadProgress);
+}
+
+//-----------------------------------------------------------------------------
+QGCCameraMedia::~QGCCameraMedia()
+{
+    cancelDownloads();
+    _items.clearAndDeleteContents();
+}
+
+//-----------------------------------------------------------------------------
+QString
+QGCCameraMedia::downloadDirectory() const
+{
+    return qgcApp()->toolbox()->settingsManager()->appSettings()->photoSavePath();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::setGeotagImages(bool geotagImages)
+{
+    if(_geotagImages != geotagImages) {
+        _geotagImages = geotagImages;
+        emit geotagImagesChanged();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::handleCaptureStatus(const mavlink_camera_capture_status_t& cap)
+{
+    if(cap.image_count < 0 || cap.image_count == _imageCount) {
+        return;
+    }
+    //-- Fewer images than before: the storage was formatted
+    if(cap.image_count < _imageCount) {
+        qCDebug(CameraMediaLog) << "Image count went down, clearing captures" << _imageCount << cap.image_count;
+        cancelDownloads();
+        _listTimer.stop();
+        _listIndex = -1;
+        _listSkipped.clear();
+        _itemsByIndex.clear();
+        _items.clearAndDeleteContents();
+        emit listingChanged();
+    }
+    _imageCount = cap.image_count;
+    emit imageCountChanged();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::handleImageCaptured(const mavlink_camera_image_captured_t& captured)
+{
+    qCDebug(CameraMediaLog) << "handleImageCaptured:" << captured.image_index << captured.capture_result;
+    if(captured.image_index < 0) {
+        return;
+    }
+    if(captured.image_index >= _imageCount) {
+        _imageCount = captured.image_index + 1;
+        emit imageCountChanged();
+    }
+    if(!_itemsByIndex.contains(captured.image_index)) {
+        QGCCameraMediaItem* item = new QGCCameraMediaItem(captured, this);
+        //-- Downloaded in an earlier session
+        const QString localFile = downloadDirectory() + QStringLiteral("/") + item->fileName();
+        if(QFile::exists(localFile)) {
+            item->_localFile = localFile;
+            item->_progress  = 1;
+            item->_state     = QGCCameraMediaItem::MEDIA_DOWNLOADED;
+        }
+        //-- Newest first
+        const int row = static_cast<int>(std::distance(_itemsByIndex.upperBound(item->index()), _itemsByIndex.end()));
+        _itemsByIndex[item->index()] = item;
+        _items.insert(row, item);
+    }
+    if(captured.image_index == _listIndex) {
+        _listTimer.stop();
+        _requestNextIndex();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::refresh()
+{
+    _listSkipped.clear();
+    if(!listing()) {
+        _requestNextIndex();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::_requestNextIndex()
+{
+    const bool wasListing = listing();
+    _listIndex = -1;
+    _listTries = 0;
+    for(int index = _imageCount - 1; index >= 0; index--) {
+        if(!_itemsByIndex.contains(index) && !_listSkipped.contains(index)) {
+            _listIndex = index;
+            break;
+        }
+    }
+    if(listing()) {
+        qCDebug(CameraMediaLog) << "Requesting capture" << _listIndex;
+        _vehicle->sendMavCommand(_compID, MAV_CMD_REQUEST_MESSAGE, false /* showError */, MAVLINK_MSG_ID_CAMERA_IMAGE_CAPTURED, _listIndex);
+        _listTimer.start();
+    }
+    if(wasListing != listing()) {
+        emit listingChanged();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::_listTimeout()
+{
+    if(++_listTries < maxListTries) {
+        qCDebug(CameraMediaLog) << "Capture request timed out, retrying" << _listIndex;
+        _vehicle->sendMavCommand(_compID, MAV_CMD_REQUEST_MESSAGE, false /* showError */, MAVLINK_MSG_ID_CAMERA_IMAGE_CAPTURED, _listIndex);
+        _listTimer.start();
+        return;
+    }
+    qCWarning(CameraMediaLog) << "Camera did not send capture" << _listIndex;
+    _listSkipped.insert(_listIndex);
+    _requestNextIndex();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::download(int row)
+{
+    if(row >= 0 && row < _items.count()) {
+        _queue(_items.value<QGCCameraMediaItem*>(row));
+        _startDownloads();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::downloadAll()
+{
+    for(int row = 0; row < _items.count(); row++) {
+        _queue(_items.value<QGCCameraMediaItem*>(row));
+    }
+    _startDownloads();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::_queue(QGCCameraMediaItem* item)
+{
+    if(item->state() == QGCCameraMediaItem::MEDIA_REMOTE || item->state() == QGCCameraMediaItem::MEDIA_FAILED) {
+        item->_setState(QGCCameraMediaItem::MEDIA_QUEUED);
+        _downloadQueue.append(item);
+        emit downloadsPendingChanged();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::cancelDownloads()
+{
+    _ftpRetryTimer.stop();
+    for(QGCCameraMediaItem* item: _downloadQueue) {
+        item->_setState(QGCCameraMediaItem::MEDIA_REMOTE);
+    }
+    _downloadQueue.clear();
+    for(QNetworkReply* reply: _httpDownloads.keys()) {
+        const HttpDownload_t download = _httpDownloads.take(reply);
+        disconnect(reply, nullptr, this, nullptr);
+        reply->abort();
+        reply->deleteLater();
+        download.file->close();
+        download.file->deleteLater();
+        download.item->_setState(QGCCameraMediaItem::MEDIA_REMOTE);
+    }
+    if(_ftpItem) {
+        QGCCameraMediaItem* item = _ftpItem;
+        _ftpItem = nullptr;
+        _vehicle->ftpManager()->cancelDownload();
+        item->_setState(QGCCameraMediaItem::MEDIA_REMOTE);
+    }
+    emit downloadsPendingChanged();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::_startDownloads()
+{
+    if(!QDir().mkpath(downloadDirectory())) {
+        qCWarning(CameraMediaLog) << "Unable to create" << downloadDirectory();
+    }
+    for(int i = 0; i < _downloadQueue.count(); ) {
+        QGCCameraMediaItem* item = _downloadQueue[i];
+        if(item->isHttp()) {
+            if(_httpDownloads.count() < maxHttpDownloads) {
+                _downloadQueue.removeAt(i);
+                _startHttp(item);
+                continue;
+            }
+        } else if(!_ftpItem) {
+            if(_startFtp(item)) {
+                _downloadQueue.removeAt(i);
+                continue;
+            }
+            //-- Somebody else is using MAVLink FTP, try again later
+            _ftpRetryTimer.start();
+        }
+        i++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+QString
+QGCCameraMedia::_partFile(QGCCameraMediaItem* item) const
+{
+    return downloadDirectory() + QStringLiteral("/") + item->fileName() + QStringLiteral(".part");
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::_startHttp(QGCCameraMediaItem* item)
+{
+    HttpDownload_t download;
+    download.item   = item;
+    download.file   = new QFile(_partFile(item), this);
+    download.offset = download.file->size();
+
+    qCDebug(CameraMediaLog) << "HTTP download" << item->fileUrl() << "from" << download.offset;
+    QNetworkRequest request(QUrl(item->fileUrl()));
+    request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+    QSslConfiguration conf = request.sslConfiguration();
+    conf.setPeerVerifyMode(QSslSocket::VerifyNone);
+    request.setSslConfiguration(conf);
+    if(download.offset > 0) {
+        request.setRawHeader("Range", QByteArray("bytes=") + QByteArray::number(download.offset) + "-");
+    }
+    //-- Images aren't kept in the network cache, the download directory is their cache
+    QGCNetworkService::setConsumer(request, QGCNetworkService::consumerCamera);
+    QNetworkReply* reply = qgcApp()->toolbox()->networkService()->networkAccessManager()->get(request);
+
+    _httpDownloads[reply] = download;
+    connect(reply, &QNetworkReply::readyRead,        this, &QGCCameraMedia::_httpReadyRead);
+    connect(reply, &QNetworkReply::downloadProgress, this, &QGCCameraMedia::_httpProgress);
+    connect(reply, &QNetworkReply::finished,         this, &QGCCameraMedia::_httpFinished);
+    item->_setState(QGCCameraMediaItem::MEDIA_DOWNLOADING);
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCameraMedia::httpResumes(int httpStatus, const QByteArray& contentRange, qint64 partSize)
+{
+    return httpStatus == 206 && contentRange.trimmed().startsWith(QByteArray("bytes ") + QByteArray::number(partSize) + "-");
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::_httpReadyRead()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    if(!reply || !_httpDownloads.contains(reply)) {
+        return;
+    }
+    HttpDownload_t& download = _httpDownloads[reply];
+    if(!download.file->isOpen()) {
+        const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        bool opened = false;
+        if(httpResumes(status, reply->rawHeader("Content-Range"), download.offset)) {
+            opened = download.file->open(QIODevice::WriteOnly | QIODevice::Append);
+        } else if(status == 200) {
+            //-- The camera ignored the range, start over
+            download.offset = 0;
+            opened = download.file->open(QIODevice::WriteOnly | QIODevice::Truncate);
+        } else {
+            //-- Any other range than the one asked for can't go on the partial file
+            qCWarning(CameraMediaLog) << "Unexpected response" << status << reply->rawHeader("Content-Range") << reply->url();
+            download.file->remove();
+            reply->abort();
+            return;
+        }
+        if(!opened) {
+            qCWarning(CameraMediaLog) << "Unable to write" << download.file->fileName();
+            reply->abort();
+            return;
+        }
+    }
+    if(download.file->write(reply->readAll()) < 0) {
+        reply->abort();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::_httpProgress(qint64 bytesReceived, qint64 bytesTotal)
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    if(reply && _httpDownloads.contains(reply) && bytesTotal > 0) {
+        const HttpDownload_t& download = _httpDownloads[reply];
+        download.item->_setProgress(static_cast<double>(download.offset + bytesReceived) / (download.offset + bytesTotal));
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::_httpFinished()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    if(!reply || !_httpDownloads.contains(reply)) {
+        return;
+    }
+    reply->deleteLater();
+    const HttpDownload_t download = _httpDownloads.take(reply);
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    download.file->close();
+    download.file->deleteLater();
+
+    if(reply->error() == QNetworkReply::NoError) {
+        _downloaded(download.item);
+    } else if(status == 416 && download.offset > 0) {
+        //-- Nothing after the end of the partial file, it holds the whole image
+        _downloaded(download.item);
+    } else {
+        qCWarning(CameraMediaLog) << "HTTP download failed" << reply->url() << reply->errorString();
+        download.item->_setState(QGCCameraMediaItem::MEDIA_FAILED, reply->errorString());
+    }
+    emit downloadsPendingChanged();
+    _startDownloads();
+}
+
+//-----------------------------------------------------------------------------
+QString
+QGCCameraMedia::ftpUri(const QString& fileUrl, int compID)
+{
+    const QString ftpPrefix = QStringLiteral("%1://").arg(FTPManager::mavlinkFTPScheme);
+    if(fileUrl.startsWith(ftpPrefix, Qt::CaseInsensitive)) {
+        return fileUrl;
+    }
+    QString path = fileUrl;
+    if(path.startsWith(QStringLiteral("file://"), Qt::CaseInsensitive)) {
+        path = QUrl(path).path();
+    }
+    if(!path.startsWith(QLatin1Char('/'))) {
+        path.prepend(QLatin1Char('/'));
+    }
+    return QStringLiteral("%1[;comp=%2]%3").arg(ftpPrefix).arg(compID).arg(path);
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCameraMedia::_startFtp(QGCCameraMediaItem* item)
+{
+    const QString uri = ftpUri(item->fileUrl(), _compID);
+    qCDebug(CameraMediaLog) << "FTP download" << uri;
+    if(!_vehicle->ftpManager()->download(uri, downloadDirectory(), QFileInfo(_partFile(item)).fileName(), true /* resume */)) {
+        return false;
+    }
+    _ftpItem = item;
+    item->_setState(QGCCameraMediaItem::MEDIA_DOWNLOADING);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::_ftpDownloadComplete(const QString& file, const QString& errorMsg)
+{
+    //-- FTPManager signals the downloads of everybody using it
+    if(!_ftpItem || QFileInfo(file).absoluteFilePath() != QFileInfo(_partFile(_ftpItem)).absoluteFilePath()) {
+        return;
+    }
+    QGCCameraMediaItem* item = _ftpItem;
+    _ftpItem = nullptr;
+    if(errorMsg.isEmpty()) {
+        _downloaded(item);
+    } else {
+        qCWarning(CameraMediaLog) << "FTP download failed" << item->fileUrl() << errorMsg;
+        item->_setState(QGCCameraMediaItem::MEDIA_FAILED, errorMsg);
+    }
+    emit downloadsPendingChanged();
+    _startDownloads();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::_ftpDownloadProgress(quint32 bytesWritten, quint32 fileSize)
+{
+    if(_ftpItem && fileSize) {
+        _ftpItem->_setProgress(static_cast<double>(bytesWritten) / fileSize);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::_downloaded(QGCCameraMediaItem* item)
+{
+    const QString   partFile    = _partFile(item);
+    const QString   localFile   = downloadDirectory() + QStringLiteral("/") + item->fileName();
+    const bool      tag         = _geotagImages && item->hasPosition();
+    const GeoTagWorker::cameraFeedbackPacket geotag = item->geotag();
+    const int       index       = item->index();
+
+    //-- Tagging reads and writes the whole image, it goes on the pool like the log based tagging
+    QFutureWatcher<QString>* watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, index, localFile, tag]() {
+        watcher->deleteLater();
+        QGCCameraMediaItem* downloadedItem = _itemsByIndex.value(index);
+        if(!downloadedItem) {
+            return;
+        }
+        const QString error = watcher->result();
+        if(!QFile::exists(localFile)) {
+            downloadedItem->_setState(QGCCameraMediaItem::MEDIA_FAILED, error);
+            return;
+        }
+        if(!error.isEmpty()) {
+            qCWarning(CameraMediaLog) << "Image kept without geotag" << localFile << error;
+        }
+        downloadedItem->_localFile = localFile;
+        downloadedItem->_geotagged = tag && error.isEmpty();
+        downloadedItem->_setProgress(1);
+        downloadedItem->_setState(QGCCameraMediaItem::MEDIA_DOWNLOADED);
+        _loadThumbnail(downloadedItem);
+    });
+    watcher->setFuture(QtConcurrent::run([partFile, localFile, tag, geotag]() {
+        QString error;
+        if(tag) {
+            error = GeoTagWorker::tagImage(partFile, localFile, geotag);
+            if(error.isEmpty()) {
+                QFile::remove(partFile);
+                return error;
+            }
+        }
+        QFile::remove(localFile);
+        if(!QFile::rename(partFile, localFile)) {
+            error = tr("Unable to save %1").arg(localFile);
+        }
+        return error;
+    }));
+}
+
+//-----------------------------------------------------------------------------
+QString
+QGCCameraMedia::_thumbnailName(QGCCameraMediaItem* item) const
+{
+    return QStringLiteral("CameraMedia_%1_%2_%3").arg(_vehicle->id()).arg(_compID).arg(item->index());
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::prefetchThumbnails(int firstRow, int count)
+{
+    QGCImageProvider* imageProvider = qgcApp()->toolbox()->imageProvider();
+    for(int row = qMax(firstRow, 0); row < firstRow + count && row < _items.count(); row++) {
+        QGCCameraMediaItem* item = _items.value<QGCCameraMediaItem*>(row);
+        //-- Loaded again once the cache dropped it
+        if(item->state() == QGCCameraMediaItem::MEDIA_DOWNLOADED && (item->thumbnail().isEmpty() || !imageProvider->hasNamedImage(_thumbnailName(item)))) {
+            _loadThumbnail(item);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCameraMedia::_loadThumbnail(QGCCameraMediaItem* item)
+{
+    const int index = item->index();
+    if(_thumbnailsLoading.contains(index)) {
+        return;
+    }
+    _thumbnailsLoading.insert(index);
+
+    QFutureWatcher<QImage>* watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, index]() {
+        watcher->deleteLater();
+        _thumbnailsLoading.remove(index);
+        QGCCameraMediaItem* thumbnailItem = _itemsByIndex.value(index);
+        const QImage image = watcher->result();
+        if(thumbnailItem && !image.isNull()) {
+            const QString name = _thumbnailName(thumbnailItem);
+            qgcApp()->toolbox()->imageProvider()->setNamedImage(name, image);
+            thumbnailItem->_setThumbnail(QStringLiteral("image://QGCImages/%1/%2").arg(name).arg(++_thumbnailIndex));
+        }
+    });
+    const QString localFile = item->localFile();
+    watcher->setFuture(QtConcurrent::run([localFile]() {
+        //-- Decoding at the scaled size skips most of the full size image
+        QImageReader reader(localFile);
+        reader.setAutoTransform(true);
+        const QSize size = reader.size();
+        if(size.isValid()) {
+            reader.setScaledSize(size.scaled(thumbnailSize, thumbnailSize, Qt::KeepAspectRatio));
+        }
+        return reader.read();
+    }));
+}
@@ -0,0 +1,209 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCMAVLink.h"
+#include "QmlObjectListModel.h"
+#include "GeoTagController.h"
+
+#include <QDateTime>
+#include <QGeoCoordinate>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QMap>
+#include <QSet>
+#include <QTimer>
+
+class QFile;
+class QNetworkReply;
+class Vehicle;
+
+Q_DECLARE_LOGGING_CATEGORY(CameraMediaLog)
+
+//-----------------------------------------------------------------------------
+/// One capture on the camera storage, as reported by CAMERA_IMAGE_CAPTURED
+class QGCCameraMediaItem : public QObject
+{
+    Q_OBJECT
+public:
+    QGCCameraMediaItem(const mavlink_camera_image_captured_t& captured, QObject* parent = nullptr);
+
+    enum MediaState {
+        MEDIA_REMOTE = 0,       ///< Only on the camera
+        MEDIA_QUEUED,
+        MEDIA_DOWNLOADING,
+        MEDIA_DOWNLOADED,
+        MEDIA_FAILED,           ///< A partial file is kept, downloading again resumes it
+    };
+    Q_ENUM(MediaState)
+
+    Q_PROPERTY(int              index       READ index          CONSTANT)
+    Q_PROPERTY(QDateTime        time        READ time           CONSTANT)
+    Q_PROPERTY(QGeoCoordinate   coordinate  READ coordinate     CONSTANT)
+    Q_PROPERTY(QString          fileUrl     READ fileUrl        CONSTANT)
+    Q_PROPERTY(QString          fileName    READ fileName       CONSTANT)
+    Q_PROPERTY(MediaState       state       READ state          NOTIFY stateChanged)
+    Q_PROPERTY(QString          localFile   READ localFile      NOTIFY stateChanged)
+    Q_PROPERTY(bool             geotagged   READ geotagged      NOTIFY stateChanged)
+    Q_PROPERTY(QString          errorString READ errorString    NOTIFY stateChanged)
+    Q_PROPERTY(double           progress    READ progress       NOTIFY progressChanged)
+    Q_PROPERTY(QString          thumbnail   READ thumbnail      NOTIFY thumbnailChanged)    ///< image:// url, empty until loaded
+
+    int             index       () const { return _index; }
+    QDateTime       time        () const { return _time; }
+    QGeoCoordinate  coordinate  () const { return _coordinate; }
+    QString         fileUrl     () const { return _fileUrl; }
+    QString         fileName    () const { return _fileName; }
+    MediaState      state       () const { return _state; }
+    QString         localFile   () const { return _localFile; }
+    bool            geotagged   () const { return _geotagged; }
+    QString         errorString () const { return _errorString; }
+    double          progress    () const { return _progress; }
+    QString         thumbnail   () const { return _thumbnail; }
+
+    /// @return true: Captured over http(s) from the camera, false: over MAVLink FTP
+    bool            isHttp      () const;
+    /// @return true: The camera reported where the image was taken
+    bool            hasPosition () const;
+    /// Position and attitude at capture in the form the geotagging takes
+    GeoTagWorker::cameraFeedbackPacket geotag() const;
+
+signals:
+    void stateChanged       ();
+    void progressChanged    ();
+    void thumbnailChanged   ();
+
+private:
+    friend class QGCCameraMedia;
+
+    void _setState          (MediaState state, const QString& errorString = QString());
+    void _setProgress       (double progress);
+    void _setThumbnail      (const QString& thumbnail);
+
+    int             _index          = 0;
+    QDateTime       _time;
+    QGeoCoordinate  _coordinate;
+    float           _relativeAlt    = 0;                ///< Meters above home
+    float           _q[4]           = { 1, 0, 0, 0 };
+    int             _captureResult  = 0;
+    QString         _fileUrl;
+    QString         _fileName;
+    MediaState      _state          = MEDIA_REMOTE;
+    QString         _localFile;
+    bool            _geotagged      = false;
+    QString         _errorString;
+    double          _progress       = 0;
+    QString         _thumbnail;
+};
+
+//-----------------------------------------------------------------------------
+/// Captures on the onboard storage of a camera and their download.
+///
+/// The camera is asked for each capture it reports in CAMERA_CAPTURE_STATUS by index with MAV_CMD_REQUEST_MESSAGE,
+/// one at a time since the vehicle only keeps one of the same command in flight per component. New captures come in
+/// on their own. Captures the camera serves over http(s) download maxHttpDownloads at a time, the others go through
+/// the vehicle MAVLink FTP one after the other. Both write to <name>.part next to the final file and continue after
+/// it the next time, with a Range request over http. Downloaded images are geotagged with the position the camera
+/// reported on the thread pool, as the log based geotagging does, and thumbnails are scaled on the pool into the
+/// bounded QGCImageProvider cache.
+class QGCCameraMedia : public QObject
+{
+    Q_OBJECT
+public:
+    QGCCameraMedia(Vehicle* vehicle, int compID, QObject* parent = nullptr);
+    ~QGCCameraMedia();
+
+    Q_PROPERTY(QmlObjectListModel*  items               READ items                                  CONSTANT)       ///< Newest first
+    Q_PROPERTY(int                  imageCount          READ imageCount                             NOTIFY imageCountChanged)
+    Q_PROPERTY(bool                 listing             READ listing                                NOTIFY listingChanged)
+    Q_PROPERTY(int                  downloadsPending    READ downloadsPending                       NOTIFY downloadsPendingChanged)
+    Q_PROPERTY(bool                 geotagImages        READ geotagImages   WRITE setGeotagImages   NOTIFY geotagImagesChanged)
+    Q_PROPERTY(QString              downloadDirectory   READ downloadDirectory                      CONSTANT)
+
+    /// Requests the captures on the camera which aren't listed yet
+    Q_INVOKABLE void refresh            ();
+    Q_INVOKABLE void download           (int row);
+    Q_INVOKABLE void downloadAll        ();
+    /// Stops all downloads, partial files are kept to resume from
+    Q_INVOKABLE void cancelDownloads    ();
+    /// Loads thumbnails of the downloaded items in the rows, for instance the ones coming into view
+    Q_INVOKABLE void prefetchThumbnails (int firstRow, int count);
+
+    QmlObjectListModel* items           () { return &_items; }
+    int                 imageCount      () const { return _imageCount; }
+    bool                listing         () const { return _listIndex >= 0; }
+    int                 downloadsPending() const { return _downloadQueue.count() + _httpDownloads.count() + (_ftpItem ? 1 : 0); }
+    bool                geotagImages    () const { return _geotagImages; }
+    QString             downloadDirectory() const;
+
+    void setGeotagImages                (bool geotagImages);
+
+    void handleCaptureStatus            (const mavlink_camera_capture_status_t& cap);
+    void handleImageCaptured            (const mavlink_camera_image_captured_t& captured);
+
+    /// @return Uri for the vehicle FTPManager of a capture not served over http
+    static QString  ftpUri              (const QString& fileUrl, int compID);
+    /// @return true: The http reply continues the partial file, false: it starts over
+    static bool     httpResumes         (int httpStatus, const QByteArray& contentRange, qint64 partSize);
+
+    static const int maxHttpDownloads       = 4;
+    static const int thumbnailSize          = 256;
+    static const int listTimeoutMsecs       = 1500;
+    static const int maxListTries           = 3;
+    static const int ftpRetryMsecs          = 1000;     ///< FTPManager is busy with another transfer
+
+signals:
+    void imageCountChanged          ();
+    void listingChanged             ();
+    void downloadsPendingChanged    ();
+    void geotagImagesChanged        ();
+
+private slots:
+    void _listTimeout               ();
+    void _startDownloads            ();
+    void _httpReadyRead             ();
+    void _httpProgress              (qint64 bytesReceived, qint64 bytesTotal);
+    void _httpFinished              ();
+    void _ftpDownloadComplete       (const QString& file, const QString& errorMsg);
+    void _ftpDownloadProgress       (quint32 bytesWritten, quint32 fileSize);
+
+private:
+    struct HttpDownload_t {
+        QGCCameraMediaItem* item    = nullptr;
+        QFile*              file    = nullptr;
+        qint64              offset  = 0;        ///< Bytes of the partial file the reply continues
+    };
+
+    void    _requestNextIndex       ();
+    void    _queue                  (QGCCameraMediaItem* item);
+    void    _startHttp              (QGCCameraMediaItem* item);
+    bool    _startFtp               (QGCCameraMediaItem* item);
+    void    _downloaded             (QGCCameraMediaItem* item);
+    void    _loadThumbnail          (QGCCameraMediaItem* item);
+    QString _partFile               (QGCCameraMediaItem* item) const;
+    QString _thumbnailName          (QGCCameraMediaItem* item) const;
+
+    Vehicle*                                    _vehicle            = nullptr;
+    int                                         _compID             = 0;
+    QmlObjectListModel                          _items;
+    QMap<int, QGCCameraMediaItem*>              _itemsByIndex;
+    int                                         _imageCount         = 0;
+    int                                         _listIndex          = -1;       ///< Capture index requested, -1 while not listing
+    int                                         _listTries          = 0;
+    QSet<int>                                   _listSkipped;                   ///< Indices the camera didn't answer for
+    QTimer                                      _listTimer;
+    QList<QGCCameraMediaItem*>                  _downloadQueue;
+    QHash<QNetworkReply*, HttpDownload_t>       _httpDownloads;
+    QGCCameraMediaItem*                         _ftpItem            = nullptr;
+    QTimer                                      _ftpRetryTimer;
+    QSet<int>                                   _thumbnailsLoading;
+    int                                         _thumbnailIndex     = 0;        ///< Changes the url so QML reloads
+    bool                                        _geotagImages       = true;
+};
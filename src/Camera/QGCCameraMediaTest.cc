@@ -0,0 +1,72 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCCameraMediaTest.h"
+#include "QGCCameraMedia.h"
+
+#include <cstring>
+
+void QGCCameraMediaTest::_itemTest(void)
+{
+    mavlink_camera_image_captured_t captured = {};
+    captured.time_utc       = 1600000000000000ULL;
+    captured.lat            = 473977420;
+    captured.lon            = 85455940;
+    captured.alt            = 488500;
+    captured.relative_alt   = 50000;
+    captured.q[0]           = 1;
+    captured.image_index    = 12;
+    captured.capture_result = 1;
+    strcpy(captured.file_url, "http://192.168.0.10/DCIM/100MEDIA/IMG_0012.JPG");
+
+    QGCCameraMediaItem item(captured);
+    QCOMPARE(item.index(), 12);
+    QCOMPARE(item.fileName(), QStringLiteral("IMG_0012.JPG"));
+    QVERIFY(item.isHttp());
+    QVERIFY(item.hasPosition());
+    QCOMPARE(item.time().toMSecsSinceEpoch(), 1600000000000LL);
+    QCOMPARE(item.state(), QGCCameraMediaItem::MEDIA_REMOTE);
+
+    GeoTagWorker::cameraFeedbackPacket geotag = item.geotag();
+    QCOMPARE(geotag.latitude, 47.397742);
+    QCOMPARE(geotag.longitude, 8.545594);
+    QCOMPARE(geotag.altitude, 488.5f);
+    QCOMPARE(geotag.groundDistance, 50.0f);
+    QCOMPARE(geotag.imageSequence, 12u);
+
+    // A full file_url isn't terminated, a failed capture has no position
+    captured.capture_result = 0;
+    memset(captured.file_url, 'a', sizeof(captured.file_url));
+    captured.file_url[0] = '/';
+    QGCCameraMediaItem unterminated(captured);
+    QCOMPARE(unterminated.fileUrl().length(), static_cast<int>(sizeof(captured.file_url)));
+    QVERIFY(!unterminated.isHttp());
+    QVERIFY(!unterminated.hasPosition());
+
+    // Without a file name the index makes one
+    captured.file_url[0] = 0;
+    QGCCameraMediaItem unnamed(captured);
+    QCOMPARE(unnamed.fileName(), QStringLiteral("IMG_00012.jpg"));
+}
+
+void QGCCameraMediaTest::_ftpUriTest(void)
+{
+    QCOMPARE(QGCCameraMedia::ftpUri(QStringLiteral("/DCIM/IMG_1.JPG"), 100),           QStringLiteral("mftp://[;comp=100]/DCIM/IMG_1.JPG"));
+    QCOMPARE(QGCCameraMedia::ftpUri(QStringLiteral("DCIM/IMG_1.JPG"), 100),            QStringLiteral("mftp://[;comp=100]/DCIM/IMG_1.JPG"));
+    QCOMPARE(QGCCameraMedia::ftpUri(QStringLiteral("file:///DCIM/IMG_1.JPG"), 101),    QStringLiteral("mftp://[;comp=101]/DCIM/IMG_1.JPG"));
+    QCOMPARE(QGCCameraMedia::ftpUri(QStringLiteral("mftp://[;comp=1]/fs/IMG_1.JPG"), 100), QStringLiteral("mftp://[;comp=1]/fs/IMG_1.JPG"));
+}
+
+void QGCCameraMediaTest::_httpResumesTest(void)
+{
+    QVERIFY(QGCCameraMedia::httpResumes(206, "bytes 1024-4095/4096", 1024));
+    QVERIFY(!QGCCameraMedia::httpResumes(206, "bytes 0-4095/4096", 1024));
+    QVERIFY(!QGCCameraMedia::httpResumes(206, QByteArray(), 1024));
+    QVERIFY(!QGCCameraMedia::httpResumes(200, QByteArray(), 1024));
+}
@@ -8,6 +8,7 @@
  ****************************************************************************/
 
 #include "Fact.h"
+#include "FactHistory.h"
 #include "FactValueSliderListModel.h"
 #include "QGCMAVLink.h"
 #include "QGCApplication.h"
@@ -15,6 +16,10 @@
 
 #include <QtQml>
 #include <QQmlEngine>
+#include <QDateTime>
+#include <QPointF>
+
+#include <limits>
 
 static const char* kMissingMetadata = "Meta data pointer missing";
 
@@ -28,6 +33,8 @@ Fact::Fact(QObject* parent)
     , _deferredValueChangeSignal(false)
     , _valueSliderModel         (nullptr)
     , _ignoreQGCRebootRequired  (false)
+    , _history                  (nullptr)
+    , _historyRefCount          (0)
 {    
     FactMetaData* metaData = new FactMetaData(_type, this);
     setMetaData(metaData);
@@ -46,6 +53,8 @@ Fact::Fact(int componentId, QString name, FactMetaData::ValueType_t type, QObjec
     , _deferredValueChangeSignal(false)
     , _valueSliderModel         (nullptr)
     , _ignoreQGCRebootRequired  (false)
+    , _history                  (nullptr)
+    , _historyRefCount          (0)
 {
     FactMetaData* metaData = new FactMetaData(_type, this);
     setMetaData(metaData);
@@ -64,6 +73,8 @@ Fact::Fact(const QString& settingsGroup, FactMetaData* metaData, QObject* parent
     , _deferredValueChangeSignal(false)
     , _valueSliderModel         (nullptr)
     , _ignoreQGCRebootRequired  (false)
+    , _history                  (nullptr)
+    , _historyRefCount          (0)
 {
     qgcApp()->toolbox()->corePlugin()->adjustSettingMetaData(settingsGroup, *metaData);
     setMetaData(metaData, true /* setDefaultFromMetaData */);
@@ -73,12 +84,19 @@ Fact::Fact(const QString& settingsGroup, FactMetaData* metaData, QObject* parent
 
 Fact::Fact(const Fact& other, QObject* parent)
     : QObject(parent)
+    , _history                  (nullptr)
+    , _historyRefCount          (0)
 {
     *this = other;
 
     _init();
 }
 
+Fact::~Fact()
+{
+    delete _history;
+}
+
 void Fact::_init(void)
 {
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
@@ -90,6 +108,8 @@ const Fact& Fact::operator=(const Fact& other)
     _name                       = other._name;
     _componentId                = other._componentId;
     _rawValue                   = other._rawValue;
+    _native                     = other._native;
+    _nativeValid                = other._nativeValid;
     _type                       = other._type;
     _sendValueChangedSignals    = other._sendValueChangedSignals;
     _deferredValueChangeSignal  = other._deferredValueChangeSignal;
@@ -112,10 +132,8 @@ void Fact::forceSetRawValue(const QVariant& value)
         
         if (_metaData->convertAndValidateRaw(value, true /* convertOnly */, typedValue, errorString)) {
             _rawValue.setValue(typedValue);
-            _sendValueChangedSignal(cookedValue());
-            //-- Must be in this order
-            emit _containerRawValueChanged(rawValue());
-            emit rawValueChanged(_rawValue);
+            _nativeValid = false;
+            _rawValueChangedSignals();
         }
     } else {
         qWarning() << kMissingMetadata << name();
@@ -131,10 +149,8 @@ void Fact::setRawValue(const QVariant& value)
         if (_metaData->convertAndValidateRaw(value, true /* convertOnly */, typedValue, errorString)) {
             if (typedValue != _rawValue) {
                 _rawValue.setValue(typedValue);
-                _sendValueChangedSignal(cookedValue());
-                //-- Must be in this order
-                emit _containerRawValueChanged(rawValue());
-                emit rawValueChanged(_rawValue);
+                _nativeValid = false;
+                _rawValueChangedSignals();
             }
         }
     } else {
@@ -142,6 +158,120 @@ void Fact::setRawValue(const QVariant& value)
     }
 }
 
+/// Signals for a raw value change made through the property write accessor or the C++ setters
+void Fact::_rawValueChangedSignals(void)
+{
+    _sendValueChangedSignal();
+    //-- Must be in this order
+    emit _containerRawValueChanged(rawValue());
+    emit rawValueChanged(_rawValue);
+}
+
+template <typename S>
+void Fact::_setNativeIfChanged(S value, S& slot)
+{
+    if (_nativeValid) {
+        if (_nativeEqual(slot, value)) {
+            return;
+        }
+    } else if (_rawValue.userType() == qMetaTypeId<S>() && _nativeEqual(_rawValue.value<S>(), value)) {
+        // Set through another path, same value
+        slot            = value;
+        _nativeValid    = true;
+        return;
+    }
+    slot            = value;
+    _nativeValid    = true;
+    _rawValue       = QVariant(value);  // Numeric QVariants are stored inline, so this does not allocate
+    _rawValueChangedSignals();
+}
+
+/// NaN equals NaN, so telemetry which keeps reporting an invalid value doesn't signal each time
+template <typename S>
+bool Fact::_nativeEqual(S a, S b)
+{
+    return a == b || (std::is_floating_point<S>::value && qIsNaN(static_cast<double>(a)) && qIsNaN(static_cast<double>(b)));
+}
+
+/// Converts to the storage type S the way QVariant does for FactMetaData::convertAndValidateRaw: doubles are rounded
+/// to integers with qRound64, integers are truncated to the storage size, floats are converted through double.
+/// A double which can't be converted with a defined cast, NaN or out of range, is handed to setRawValue instead.
+template <typename S, typename V>
+void Fact::_setNativeConverted(V value, S& slot)
+{
+    if (std::is_floating_point<V>::value && std::is_integral<S>::value) {
+        const double maxExactInteger    = 9007199254740992.0;   // 2^53, qRound64 can't overflow below it
+        const double lowest             = std::is_signed<S>::value ? qMax(static_cast<double>(std::numeric_limits<S>::lowest()), -maxExactInteger) : 0.0;
+        const double highest            = qMin(static_cast<double>(std::numeric_limits<S>::max()), maxExactInteger);
+        const double doubleValue        = static_cast<double>(value);
+        if (!(doubleValue >= lowest && doubleValue <= highest)) {
+            setRawValue(QVariant(value));
+            return;
+        }
+        _setNativeIfChanged(static_cast<S>(qRound64(doubleValue)), slot);
+    } else if (std::is_same<S, float>::value) {
+        const double doubleValue = static_cast<double>(value);
+        if (qIsFinite(doubleValue) && qAbs(doubleValue) > static_cast<double>(std::numeric_limits<float>::max())) {
+            setRawValue(QVariant(value));
+            return;
+        }
+        _setNativeIfChanged(static_cast<S>(doubleValue), slot);
+    } else {
+        _setNativeIfChanged(static_cast<S>(value), slot);
+    }
+}
+
+template <typename V>
+void Fact::_setRawValueNative(V value)
+{
+    switch (_type) {
+    case FactMetaData::valueTypeInt8:
+    case FactMetaData::valueTypeInt16:
+    case FactMetaData::valueTypeInt32:
+        _setNativeConverted(value, _native.i);
+        break;
+    case FactMetaData::valueTypeInt64:
+        _setNativeConverted(value, _native.ll);
+        break;
+    case FactMetaData::valueTypeUint8:
+    case FactMetaData::valueTypeUint16:
+    case FactMetaData::valueTypeUint32:
+        _setNativeConverted(value, _native.u);
+        break;
+    case FactMetaData::valueTypeUint64:
+        _setNativeConverted(value, _native.ull);
+        break;
+    case FactMetaData::valueTypeFloat:
+        _setNativeConverted(value, _native.f);
+        break;
+    case FactMetaData::valueTypeElapsedTimeInSeconds:
+    case FactMetaData::valueTypeDouble:
+        _setNativeConverted(value, _native.d);
+        break;
+    case FactMetaData::valueTypeBool:
+        _setNativeIfChanged(value != 0, _native.b);
+        break;
+    default:
+        setRawValue(QVariant(value));
+        break;
+    }
+}
+
+void Fact::_setRawValueNumeric(double value)
+{
+    _setRawValueNative(value);
+}
+
+void Fact::_setRawValueNumeric(qint64 value)
+{
+    _setRawValueNative(value);
+}
+
+void Fact::_setRawValueNumeric(quint64 value)
+{
+    _setRawValueNative(value);
+}
+
 void Fact::setCookedValue(const QVariant& value)
 {
     if (_metaData) {
@@ -181,7 +311,8 @@ void Fact::_containerSetRawValue(const QVariant& value)
 {
     if(_rawValue != value) {
         _rawValue = value;
-        _sendValueChangedSignal(cookedValue());
+        _nativeValid = false;
+        _sendValueChangedSignal();
         emit rawValueChanged(_rawValue);
     }
 
@@ -637,9 +768,12 @@ void Fact::setSendValueChangedSignals (bool sendValueChangedSignals)
     }
 }
 
-void Fact::_sendValueChangedSignal(QVariant value)
+/// The cooked value is only translated when the signal is actually sent
+void Fact::_sendValueChangedSignal(void)
 {
     if (_sendValueChangedSignals) {
+        QVariant value = cookedValue();
+        _recordHistory(value);
         emit valueChanged(value);
         _deferredValueChangeSignal = false;
     } else {
@@ -651,8 +785,61 @@ void Fact::sendDeferredValueChangedSignal(void)
 {
     if (_deferredValueChangeSignal) {
         _deferredValueChangeSignal = false;
-        emit valueChanged(cookedValue());
+        QVariant value = cookedValue();
+        _recordHistory(value);
+        emit valueChanged(value);
+    }
+}
+
+void Fact::retainHistory(void)
+{
+    if (_historyRefCount++ == 0) {
+        _history = new FactHistory();
+        // Start out with the current value so there is something to show until the next change
+        _recordHistory(cookedValue());
+    }
+}
+
+void Fact::releaseHistory(void)
+{
+    if (_historyRefCount == 0) {
+        qWarning() << "Fact::releaseHistory without retainHistory" << name();
+        return;
+    }
+    if (--_historyRefCount == 0) {
+        delete _history;
+        _history = nullptr;
+    }
+}
+
+void Fact::_recordHistory(const QVariant& cookedValue)
+{
+    if (_history) {
+        bool    ok;
+        double  value = cookedValue.toDouble(&ok);
+        if (ok) {
+            _history->append(QDateTime::currentMSecsSinceEpoch(), value);
+        }
+    }
+}
+
+QVariantList Fact::historyPoints(double seconds, int maxPoints) const
+{
+    QVariantList points;
+    if (!_history) {
+        return points;
+    }
+
+    const qint64    nowMSecs = QDateTime::currentMSecsSinceEpoch();
+    QVector<qint64> msecs;
+    QVector<float>  values;
+    _history->samples(nowMSecs - static_cast<qint64>(seconds * 1000.0), maxPoints, msecs, values);
+
+    points.reserve(msecs.count());
+    for (int i = 0; i < msecs.count(); i++) {
+        points.append(QPointF((msecs[i] - nowMSecs) / 1000.0, static_cast<double>(values[i])));
     }
+    return points;
 }
 
 QString Fact::enumOrValueString(void)
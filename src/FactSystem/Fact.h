@@ -17,7 +17,10 @@
 #include <QDebug>
 #include <QAbstractListModel>
 
+#include <type_traits>
+
 class FactValueSliderListModel;
+class FactHistory;
 
 /// @brief A Fact is used to hold a single value within the system.
 class Fact : public QObject
@@ -28,6 +31,7 @@ public:
     Fact(QObject* parent = nullptr);
     Fact(int componentId, QString name, FactMetaData::ValueType_t type, QObject* parent = nullptr);
     Fact(const Fact& other, QObject* parent = nullptr);
+    ~Fact();
 
     /// Creates a Fact using the name and type from metaData. Also calls QGCCorePlugin::adjustSettingsMetaData allowing
     /// custom builds to override the metadata.
@@ -131,11 +135,41 @@ public:
 
     Q_INVOKABLE FactValueSliderListModel* valueSliderModel(void);
 
+    /// History of the cooked value, see FactHistory. It is only kept while retained, each retainHistory needs a matching
+    /// releaseHistory. Values are recorded as valueChanged is signalled, so Facts of a FactGroup record at its update rate.
+    Q_INVOKABLE void retainHistory (void);
+    Q_INVOKABLE void releaseHistory(void);
+
+    /// Samples of the last seconds for charts, as points of seconds relative to now and cooked value
+    ///     @param maxPoints Neighbouring samples are averaged to fit, 0 for all of them
+    Q_INVOKABLE QVariantList historyPoints(double seconds, int maxPoints) const;
+
+    /// @return nullptr: History isn't retained
+    const FactHistory* history(void) const { return _history; }
+
     /// Returns the values as a string with full 18 digit precision if float/double.
     QString rawValueStringFullPrecision(void) const;
 
     void setRawValue        (const QVariant& value);
     void setCookedValue     (const QVariant& value);
+
+    /// Fast path of setRawValue for numeric values, meant for high rate telemetry. For numeric and bool Facts the
+    /// value is converted straight to the storage type, the same way setRawValue converts it, and compared natively,
+    /// skipping QVariant conversion, validation and comparison. Signals are the same as setRawValue, except that NaN
+    /// equals NaN. Other types, and doubles which don't fit an integer type, fall back to setRawValue.
+    template <typename T>
+    void setRawValueTyped(T value)
+    {
+        static_assert(std::is_arithmetic<T>::value, "setRawValueTyped requires a numeric type");
+        if (std::is_floating_point<T>::value) {
+            _setRawValueNumeric(static_cast<double>(value));
+        } else if (std::is_signed<T>::value) {
+            _setRawValueNumeric(static_cast<qint64>(value));
+        } else {
+            _setRawValueNumeric(static_cast<quint64>(value));
+        }
+    }
+
     void setEnumIndex       (int index);
     void setEnumStringValue (const QString& value);
     int  valueIndex         (const QString& value);
@@ -198,7 +232,16 @@ private:
     
 protected:
     QString _variantToString(const QVariant& variant, int decimalPlaces) const;
-    void _sendValueChangedSignal(QVariant value);
+    void _sendValueChangedSignal(void);
+    void _rawValueChangedSignals(void);
+    void _setRawValueNumeric(double value);
+    void _setRawValueNumeric(qint64 value);
+    void _setRawValueNumeric(quint64 value);
+    void _recordHistory(const QVariant& cookedValue);
+    template <typename V> void _setRawValueNative(V value);
+    template <typename S> void _setNativeIfChanged(S value, S& slot);
+    template <typename S, typename V> void _setNativeConverted(V value, S& slot);
+    template <typename S> static bool _nativeEqual(S a, S b);
 
     QString                     _name;
     int                         _componentId;
@@ -209,4 +252,19 @@ protected:
     bool                        _deferredValueChangeSignal;
     FactValueSliderListModel*   _valueSliderModel;
     bool                        _ignoreQGCRebootRequired;
+    FactHistory*                _history;
+    int                         _historyRefCount;
+
+    /// Native copy of _rawValue for numeric types, used by setRawValueTyped. Only valid while _nativeValid is true,
+    /// any other path which changes _rawValue clears it.
+    union {
+        int         i;
+        uint        u;
+        qint64      ll;
+        quint64     ull;
+        float       f;
+        double      d;
+        bool        b;
+    }                           _native;
+    bool                        _nativeValid = false;
 };
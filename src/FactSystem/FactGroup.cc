@@ -10,6 +10,9 @@
 
 #include "FactGroup.h"
 #include "JsonHelper.h"
+#include "QGCTrace.h"
+#include "QGCPowerManager.h"
+#include "QGCApplication.h"
 
 #include <QJsonDocument>
 #include <QJsonParseError>
@@ -22,6 +25,7 @@ FactGroup::FactGroup(int updateRateMsecs, const QString& metaDataFile, QObject*
     : QObject(parent)
     , _updateRateMSecs(updateRateMsecs)
     , _ignoreCamelCase(ignoreCamelCase)
+    , _updateTimer    ("FactGroup")
 {
     _setupTimer();
     _nameToFactMetaDataMap = FactMetaData::createMapFromJsonFile(metaDataFile, this);
@@ -32,6 +36,7 @@ FactGroup::FactGroup(int updateRateMsecs, QObject* parent, bool ignoreCamelCase)
     : QObject(parent)
     , _updateRateMSecs(updateRateMsecs)
     , _ignoreCamelCase(ignoreCamelCase)
+    , _updateTimer    ("FactGroup")
 {
     _setupTimer();
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
@@ -45,14 +50,46 @@ void FactGroup::_loadFromJsonArray(const QJsonArray jsonArray)
 
 void FactGroup::_setupTimer()
 {
+    QGCPowerManager* powerManager = _powerManager();
+    if (powerManager) {
+        connect(powerManager, &QGCPowerManager::updateRateFactorChanged, this, &FactGroup::_updateRateFactorChanged);
+    }
+
     if (_updateRateMSecs > 0) {
-        connect(&_updateTimer, &QTimer::timeout, this, &FactGroup::_updateAllValues);
+        connect(&_updateTimer, &QGCWheelTimer::timeout, this, &FactGroup::_updateAllValues);
         _updateTimer.setSingleShot(false);
-        _updateTimer.setInterval(_updateRateMSecs);
+        _setTimerInterval();
         _updateTimer.start();
     }
 }
 
+QGCPowerManager* FactGroup::_powerManager(void)
+{
+    QGCToolbox* toolbox = qgcApp() ? qgcApp()->toolbox() : nullptr;
+    return toolbox ? toolbox->powerManager() : nullptr;
+}
+
+void FactGroup::_setTimerInterval(void)
+{
+    // Published less often while the ui saves power, the values themselves keep coming in at full rate
+    QGCPowerManager*    powerManager    = _powerManager();
+    const int           intervalMSecs   = _updateRateMSecs * (powerManager ? powerManager->updateRateFactor() : 1);
+
+    _updateTimer.setInterval(intervalMSecs);
+    // All groups with the same rate, of all vehicles, update in the same timer wheel wakeup
+    _updateTimer.setWindow(intervalMSecs);
+}
+
+void FactGroup::_updateRateFactorChanged(void)
+{
+    if (_updateRateMSecs > 0) {
+        _setTimerInterval();
+        if (_updateTimer.isActive()) {
+            _updateTimer.start();
+        }
+    }
+}
+
 bool FactGroup::factExists(const QString& name)
 {
     if (name.contains(".")) {
@@ -136,6 +173,12 @@ void FactGroup::_addFact(Fact* fact, const QString& name)
     _nameToFactMap[name] = fact;
     _factNames.append(name);
 
+    _factIndexMap[fact] = _pendingFacts.count();
+    _pendingFacts.append(fact);
+    _pendingRawValues.append(QVariant());
+    _pendingDirty.append(false);
+    _dirtyIndices.reserve(_pendingFacts.count());
+
     emit factNamesChanged();
 }
 
@@ -153,6 +196,10 @@ void FactGroup::_addFactGroup(FactGroup* factGroup, const QString& name)
 
 void FactGroup::_updateAllValues(void)
 {
+    QGC_TRACE_SCOPE_ARG("FactGroup", "updateAllValues", "facts", _nameToFactMap.count());
+
+    _publishPendingValues();
+
     for(Fact* fact: _nameToFactMap) {
         fact->sendDeferredValueChangedSignal();
     }
@@ -164,9 +211,11 @@ void FactGroup::setLiveUpdates(bool liveUpdates)
         return;
     }
 
+    _liveUpdates = liveUpdates;
     if (liveUpdates) {
         _updateTimer.stop();
-    } else {
+        _publishPendingValues();
+    } else if (!_externalUpdates) {
         _updateTimer.start();
     }
     for(Fact* fact: _nameToFactMap) {
@@ -174,6 +223,119 @@ void FactGroup::setLiveUpdates(bool liveUpdates)
     }
 }
 
+void FactGroup::setUpdateRateMSecs(int updateRateMSecs)
+{
+    if (updateRateMSecs == _updateRateMSecs) {
+        return;
+    }
+
+    if (_updateRateMSecs == 0) {
+        connect(&_updateTimer, &QGCWheelTimer::timeout, this, &FactGroup::_updateAllValues);
+        _updateTimer.setSingleShot(false);
+    }
+    _updateRateMSecs = updateRateMSecs;
+
+    if (_updateRateMSecs == 0) {
+        disconnect(&_updateTimer, &QGCWheelTimer::timeout, this, &FactGroup::_updateAllValues);
+        _updateTimer.stop();
+        _updateAllValues();
+    } else {
+        _setTimerInterval();
+        if (!_liveUpdates && !_externalUpdates) {
+            _updateTimer.start();
+        }
+    }
+    for(Fact* fact: _nameToFactMap) {
+        fact->setSendValueChangedSignals(_liveUpdates || _updateRateMSecs == 0);
+    }
+}
+
+void FactGroup::setExternalUpdates(bool externalUpdates)
+{
+    if (externalUpdates == _externalUpdates) {
+        return;
+    }
+
+    _externalUpdates = externalUpdates;
+    if (_updateRateMSecs == 0 || _liveUpdates) {
+        // No timer running either way
+        return;
+    }
+    if (externalUpdates) {
+        _updateTimer.stop();
+    } else {
+        _updateAllValues();
+        _updateTimer.start();
+    }
+}
+
+void FactGroup::_setFactValue(Fact* fact, const QVariant& rawValue)
+{
+    if (_liveUpdates || _updateRateMSecs == 0) {
+        _setRawValueTyped(fact, rawValue);
+        return;
+    }
+
+    auto iter = _factIndexMap.constFind(fact);
+    if (iter == _factIndexMap.constEnd()) {
+        qWarning() << "FactGroup::_setFactValue Fact not in group" << fact->name();
+        _setRawValueTyped(fact, rawValue);
+        return;
+    }
+
+    int index = iter.value();
+    _pendingRawValues[index] = rawValue;
+    if (!_pendingDirty[index]) {
+        _pendingDirty[index] = true;
+        _dirtyIndices.append(index);
+    }
+}
+
+QVariant FactGroup::latestRawValue(Fact* fact) const
+{
+    auto iter = _factIndexMap.constFind(fact);
+    if (iter != _factIndexMap.constEnd() && _pendingDirty[iter.value()]) {
+        return _pendingRawValues[iter.value()];
+    }
+    return fact->rawValue();
+}
+
+void FactGroup::_publishPendingValues(void)
+{
+    QGC_TRACE_SCOPE_ARG("FactGroup", "publishPendingValues", "facts", _dirtyIndices.count());
+
+    // Fact signal handlers may store new values while we publish, so work through the list by index
+    for (int i=0; i<_dirtyIndices.count(); i++) {
+        int index = _dirtyIndices[i];
+        _pendingDirty[index] = false;
+        _setRawValueTyped(_pendingFacts[index], _pendingRawValues[index]);
+    }
+    _dirtyIndices.clear();
+}
+
+/// Uses the Fact numeric fast path for the plain numeric values message handlers store
+void FactGroup::_setRawValueTyped(Fact* fact, const QVariant& rawValue)
+{
+    switch (static_cast<QMetaType::Type>(rawValue.userType())) {
+    case QMetaType::Float:
+    case QMetaType::Double:
+        fact->setRawValueTyped(rawValue.toDouble());
+        break;
+    case QMetaType::Bool:
+    case QMetaType::Int:
+    case QMetaType::LongLong:
+        fact->setRawValueTyped(rawValue.toLongLong());
+        break;
+    case QMetaType::UInt:
+    case QMetaType::ULongLong:
+        fact->setRawValueTyped(rawValue.toULongLong());
+        break;
+    default:
+        fact->setRawValue(rawValue);
+        break;
+    }
+}
+
 
 QString FactGroup::_camelCase(const QString& text)
 {
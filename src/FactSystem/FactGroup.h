@@ -12,12 +12,15 @@
 #include "Fact.h"
 #include "QGCMAVLink.h"
 #include "QGCLoggingCategory.h"
+#include "QGCTimerWheel.h"
 
 #include <QStringList>
 #include <QMap>
-#include <QTimer>
+#include <QHash>
+#include <QVector>
 
 class Vehicle;
+class QGCPowerManager;
 
 /// Used to group Facts together into an object hierarachy.
 class FactGroup : public QObject
@@ -46,6 +49,23 @@ public:
     /// Turning on live updates will allow value changes to flow through as they are received.
     Q_INVOKABLE void setLiveUpdates(bool liveUpdates);
 
+    /// Changes how often value changes are published when live updates are off. Used by consumers which need
+    /// values at a different rate than the default display rate of the group. While the ui saves power they are
+    /// published QGCPowerManager::updateRateFactor times less often.
+    void setUpdateRateMSecs(int updateRateMSecs);
+    int  updateRateMSecs   (void) const { return _updateRateMSecs; }
+
+    /// Stops the update timer of the group. Value changes are then only published by publishValues, which lets one
+    /// shared timer drive the groups of many vehicles.
+    void setExternalUpdates(bool externalUpdates);
+    bool externalUpdates   (void) const { return _externalUpdates; }
+
+    /// Publishes the value changes since the last update now
+    void publishValues(void) { _updateAllValues(); }
+
+    /// @return Newest raw value of a fact of this group, also when it is still waiting to be published
+    QVariant latestRawValue(Fact* fact) const;
+
     QStringList factNames           (void) const { return _factNames; }
     QStringList factGroupNames      (void) const { return _nameToFactGroupMap.keys(); }
     bool        telemetryAvailable  (void) const { return _telemetryAvailable; }
@@ -62,12 +82,24 @@ signals:
 protected slots:
     virtual void _updateAllValues(void);
 
+private slots:
+    void _updateRateFactorChanged(void);
+
 protected:
     void _addFact               (Fact* fact, const QString& name);
     void _addFactGroup          (FactGroup* factGroup, const QString& name);
     void _loadFromJsonArray     (const QJsonArray jsonArray);
     void _setTelemetryAvailable (bool telemetryAvailable);
 
+    /// Coalesced update of a Fact in this group from a high rate message handler. The value is only stored and
+    /// the Fact marked dirty. Dirty Facts are set on the next update tick, so rawValueChanged/valueChanged are
+    /// signalled at most once per tick no matter how fast messages arrive. With live updates on, or an update
+    /// rate of 0, the value is set immediately. Fact::rawValue returns the previous value until it is published.
+    void _setFactValue(Fact* fact, const QVariant& rawValue);
+
+    /// Sets all values stored by _setFactValue on their Facts
+    void _publishPendingValues(void);
+
     int  _updateRateMSecs;   ///< Update rate for Fact::valueChanged signals, 0: immediate update
 
     QMap<QString, Fact*>            _nameToFactMap;
@@ -77,9 +109,22 @@ protected:
 
 private:
     void    _setupTimer (void);
+    void    _setTimerInterval(void);
+    /// @return nullptr: No toolbox, values are published at the plain update rate
+    static QGCPowerManager* _powerManager(void);
+    void    _setRawValueTyped(Fact* fact, const QVariant& rawValue);
     QString _camelCase  (const QString& text);
 
-    bool    _ignoreCamelCase    = false;
-    QTimer  _updateTimer;
-    bool    _telemetryAvailable = false;
+    bool            _ignoreCamelCase    = false;
+    QGCWheelTimer   _updateTimer;
+    bool            _telemetryAvailable = false;
+    bool            _liveUpdates        = false;
+    bool            _externalUpdates    = false;
+
+    // Coalesced updates. Indices are assigned by _addFact and the vectors are sized once, so storing a value does not allocate.
+    QHash<Fact*, int>   _factIndexMap;
+    QVector<Fact*>      _pendingFacts;
+    QVector<QVariant>   _pendingRawValues;
+    QVector<bool>       _pendingDirty;
+    QVector<int>        _dirtyIndices;
 };
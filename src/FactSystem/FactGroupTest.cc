@@ -0,0 +1,161 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactGroupTest.h"
+#include "FactGroup.h"
+
+#include <QSignalSpy>
+
+namespace {
+
+/// Long enough that the update timer doesn't fire during a test, ticks are done through publishValues
+const int _manualUpdateRateMSecs = 60 * 60 * 1000;
+
+/// Gives the test access to the protected message handler side of FactGroup
+class TestFactGroup : public FactGroup
+{
+public:
+    TestFactGroup(int updateRateMsecs)
+        : FactGroup (updateRateMsecs)
+        , a         (0, QStringLiteral("a"), FactMetaData::valueTypeDouble, this)
+        , b         (0, QStringLiteral("b"), FactMetaData::valueTypeInt32,  this)
+    {
+        _addFact(&a, QStringLiteral("a"));
+        _addFact(&b, QStringLiteral("b"));
+    }
+
+    void setFactValue(Fact* fact, const QVariant& rawValue) { _setFactValue(fact, rawValue); }
+
+    Fact a;
+    Fact b;
+};
+
+}
+
+void FactGroupTest::_deferredTest(void)
+{
+    TestFactGroup   group(_manualUpdateRateMSecs);
+    QSignalSpy      rawSpy  (&group.a, &Fact::rawValueChanged);
+    QSignalSpy      valueSpy(&group.a, &Fact::valueChanged);
+
+    // Stored values wait for the next tick
+    group.setFactValue(&group.a, 1.5);
+    group.setFactValue(&group.a, 2.5);
+    QCOMPARE(rawSpy.count(),                    0);
+    QCOMPARE(valueSpy.count(),                  0);
+    QCOMPARE(group.a.rawValue().toDouble(),     0.0);
+    QCOMPARE(group.latestRawValue(&group.a),    QVariant(2.5));
+
+    // Only the last value is published, once
+    group.publishValues();
+    QCOMPARE(rawSpy.count(),                    1);
+    QCOMPARE(valueSpy.count(),                  1);
+    QCOMPARE(group.a.rawValue().toDouble(),     2.5);
+    QCOMPARE(group.latestRawValue(&group.a),    QVariant(2.5));
+
+    // Storing the published value again doesn't signal
+    group.setFactValue(&group.a, 2.5);
+    group.publishValues();
+    QCOMPARE(rawSpy.count(),                    1);
+    QCOMPARE(valueSpy.count(),                  1);
+}
+
+void FactGroupTest::_dirtyOnlyTest(void)
+{
+    TestFactGroup   group(_manualUpdateRateMSecs);
+    QSignalSpy      aSpy(&group.a, &Fact::rawValueChanged);
+    QSignalSpy      bSpy(&group.b, &Fact::rawValueChanged);
+
+    group.setFactValue(&group.b, 7);
+    QCOMPARE(group.latestRawValue(&group.a), group.a.rawValue());
+    QCOMPARE(group.latestRawValue(&group.b).toInt(), 7);
+
+    group.publishValues();
+    QCOMPARE(aSpy.count(), 0);
+    QCOMPARE(bSpy.count(), 1);
+    QCOMPARE(group.b.rawValue().toInt(), 7);
+
+    // Nothing is dirty after the tick
+    group.publishValues();
+    QCOMPARE(aSpy.count(), 0);
+    QCOMPARE(bSpy.count(), 1);
+
+    group.setFactValue(&group.a, 1.5);
+    group.publishValues();
+    QCOMPARE(aSpy.count(), 1);
+    QCOMPARE(bSpy.count(), 1);
+}
+
+void FactGroupTest::_liveUpdatesTest(void)
+{
+    TestFactGroup   group(_manualUpdateRateMSecs);
+    QSignalSpy      rawSpy  (&group.a, &Fact::rawValueChanged);
+    QSignalSpy      valueSpy(&group.a, &Fact::valueChanged);
+
+    // Turning live updates on flushes what is pending
+    group.setFactValue(&group.a, 1.5);
+    group.setLiveUpdates(true);
+    QCOMPARE(rawSpy.count(),                1);
+    QCOMPARE(group.a.rawValue().toDouble(), 1.5);
+
+    // Then values are set right away
+    group.setFactValue(&group.a, 2.5);
+    QCOMPARE(rawSpy.count(),                2);
+    QCOMPARE(valueSpy.count(),              2);
+    QCOMPARE(group.a.rawValue().toDouble(), 2.5);
+
+    // And deferred again once they are off
+    group.setLiveUpdates(false);
+    group.setFactValue(&group.a, 3.5);
+    QCOMPARE(rawSpy.count(),                    2);
+    QCOMPARE(group.latestRawValue(&group.a),    QVariant(3.5));
+    group.publishValues();
+    QCOMPARE(rawSpy.count(),                    3);
+    QCOMPARE(group.a.rawValue().toDouble(),     3.5);
+}
+
+void FactGroupTest::_updateRateTest(void)
+{
+    TestFactGroup   group(_manualUpdateRateMSecs);
+    QSignalSpy      rawSpy  (&group.a, &Fact::rawValueChanged);
+    QSignalSpy      valueSpy(&group.a, &Fact::valueChanged);
+
+    // A rate of 0 publishes what is pending and sets values immediately from then on
+    group.setFactValue(&group.a, 1.5);
+    group.setUpdateRateMSecs(0);
+    QCOMPARE(group.updateRateMSecs(),       0);
+    QCOMPARE(rawSpy.count(),                1);
+    QCOMPARE(valueSpy.count(),              1);
+    QCOMPARE(group.a.rawValue().toDouble(), 1.5);
+
+    group.setFactValue(&group.a, 2.5);
+    QCOMPARE(rawSpy.count(),                2);
+    QCOMPARE(valueSpy.count(),              2);
+
+    // Back to deferred
+    group.setUpdateRateMSecs(_manualUpdateRateMSecs);
+    group.setFactValue(&group.a, 3.5);
+    QCOMPARE(rawSpy.count(),                    2);
+    QCOMPARE(group.latestRawValue(&group.a),    QVariant(3.5));
+    group.publishValues();
+    QCOMPARE(rawSpy.count(),                    3);
+    QCOMPARE(valueSpy.count(),                  3);
+}
+
+void FactGroupTest::_timerTest(void)
+{
+    TestFactGroup   group(20);
+    QSignalSpy      rawSpy(&group.a, &Fact::rawValueChanged);
+
+    // The update timer does the tick on its own
+    group.setFactValue(&group.a, 1.5);
+    QCOMPARE(rawSpy.count(), 0);
+    QTRY_COMPARE_WITH_TIMEOUT(rawSpy.count(), 1, 2000);
+    QCOMPARE(group.a.rawValue().toDouble(), 1.5);
+}
@@ -0,0 +1,25 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for the coalesced value updates of FactGroup
+class FactGroupTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _deferredTest      (void);
+    void _dirtyOnlyTest     (void);
+    void _liveUpdatesTest   (void);
+    void _updateRateTest    (void);
+    void _timerTest         (void);
+};
@@ -0,0 +1,251 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactHistory.h"
+
+#include <QtMath>
+
+FactHistory::FactHistory(void)
+{
+    clear();
+}
+
+void FactHistory::clear(void)
+{
+    for (int tier = TierRaw; tier < TierCount; tier++) {
+        Ring_t& ring = _tiers[tier];
+        // Assigned rather than cleared, which would keep the memory
+        ring.msecs          = QVector<qint64>();
+        ring.values         = QVector<float>();
+        ring.mins           = QVector<float>();
+        ring.maxs           = QVector<float>();
+        ring.head           = 0;
+        ring.count          = 0;
+        ring.bucketStart    = 0;
+        ring.bucketSum      = 0;
+        ring.bucketMin      = 0;
+        ring.bucketMax      = 0;
+        ring.bucketCount    = 0;
+    }
+    _lastMSecs = 0;
+    _lastValue = qQNaN();
+}
+
+qint64 FactHistory::bucketMSecs(Tier tier)
+{
+    switch (tier) {
+    case TierSeconds:
+        return 1000;
+    case TierTenSeconds:
+        return 10000;
+    default:
+        return 0;
+    }
+}
+
+void FactHistory::_push(Ring_t& ring, bool range, qint64 msecs, float value, float min, float max)
+{
+    if (ring.count < tierCapacity) {
+        ring.msecs.append(msecs);
+        ring.values.append(value);
+        if (range) {
+            ring.mins.append(min);
+            ring.maxs.append(max);
+        }
+        if (++ring.count == tierCapacity) {
+            // From here on entries are only overwritten, drop the spare room left by growing
+            ring.msecs.squeeze();
+            ring.values.squeeze();
+            ring.mins.squeeze();
+            ring.maxs.squeeze();
+        }
+    } else {
+        ring.msecs[ring.head]   = msecs;
+        ring.values[ring.head]  = value;
+        if (range) {
+            ring.mins[ring.head] = min;
+            ring.maxs[ring.head] = max;
+        }
+        ring.head = (ring.head + 1) % tierCapacity;
+    }
+}
+
+void FactHistory::_fold(Ring_t& ring, qint64 width, qint64 msecs, float value)
+{
+    const qint64 bucketStart = msecs - (msecs % width);
+
+    if (ring.bucketCount && bucketStart != ring.bucketStart) {
+        _push(ring, true, ring.bucketStart, static_cast<float>(ring.bucketSum / ring.bucketCount), ring.bucketMin, ring.bucketMax);
+        ring.bucketCount = 0;
+    }
+    if (ring.bucketCount == 0) {
+        ring.bucketStart    = bucketStart;
+        ring.bucketSum      = 0;
+        ring.bucketMin      = value;
+        ring.bucketMax      = value;
+    }
+    ring.bucketSum += static_cast<double>(value);
+    ring.bucketMin = qMin(ring.bucketMin, value);
+    ring.bucketMax = qMax(ring.bucketMax, value);
+    ring.bucketCount++;
+}
+
+void FactHistory::append(qint64 msecs, double value)
+{
+    if (qIsNaN(value)) {
+        return;
+    }
+
+    const float sample = static_cast<float>(value);
+    _push(_tiers[TierRaw], false, msecs, sample, sample, sample);
+    _fold(_tiers[TierSeconds],      bucketMSecs(TierSeconds),       msecs, sample);
+    _fold(_tiers[TierTenSeconds],   bucketMSecs(TierTenSeconds),    msecs, sample);
+
+    _lastMSecs = msecs;
+    _lastValue = value;
+}
+
+void FactHistory::samples(qint64 fromMSecs, int maxPoints, QVector<qint64>& msecs, QVector<float>& values, QVector<float>* mins, QVector<float>* maxs) const
+{
+    msecs.clear();
+    values.clear();
+    if (mins) {
+        mins->clear();
+    }
+    if (maxs) {
+        maxs->clear();
+    }
+
+    // A ring which hasn't wrapped yet still holds everything since the start
+    int tier = TierCount - 1;
+    for (int i = TierRaw; i < TierCount; i++) {
+        const Ring_t& ring = _tiers[i];
+        if (ring.count < tierCapacity || ring.msecs[_index(ring, 0)] <= fromMSecs) {
+            tier = i;
+            break;
+        }
+    }
+
+    const Ring_t&   ring    = _tiers[tier];
+    const qint64    width   = bucketMSecs(static_cast<Tier>(tier));
+    auto            inRange = [width, fromMSecs](qint64 start) { return width ? start + width > fromMSecs : start >= fromMSecs; };
+
+    // Times only go forward, so what is in range is the tail of the ring
+    int first = ring.count;
+    while (first > 0 && inRange(ring.msecs[_index(ring, first - 1)])) {
+        first--;
+    }
+    const bool  pending = ring.bucketCount && inRange(ring.bucketStart);
+    const int   total   = ring.count - first + (pending ? 1 : 0);
+    if (total == 0) {
+        return;
+    }
+
+    auto point = [&](int i, qint64& start, float& value, float& min, float& max) {
+        if (first + i < ring.count) {
+            const int index = _index(ring, first + i);
+            start   = ring.msecs[index];
+            value   = ring.values[index];
+            min     = width ? ring.mins[index] : value;
+            max     = width ? ring.maxs[index] : value;
+        } else {
+            start   = ring.bucketStart;
+            value   = static_cast<float>(ring.bucketSum / ring.bucketCount);
+            min     = ring.bucketMin;
+            max     = ring.bucketMax;
+        }
+    };
+
+    const int points = (maxPoints > 0 && total > maxPoints) ? maxPoints : total;
+    msecs.reserve(points);
+    values.reserve(points);
+    if (mins) {
+        mins->reserve(points);
+    }
+    if (maxs) {
+        maxs->reserve(points);
+    }
+
+    for (int i = 0; i < points; i++) {
+        const int begin = static_cast<int>(static_cast<qint64>(i) * total / points);
+        const int end   = static_cast<int>(static_cast<qint64>(i + 1) * total / points);
+
+        qint64  groupStart = 0;
+        double  groupSum   = 0;
+        float   groupMin   = 0;
+        float   groupMax   = 0;
+        for (int j = begin; j < end; j++) {
+            qint64  start;
+            float   value, min, max;
+            point(j, start, value, min, max);
+            if (j == begin) {
+                groupStart  = start;
+                groupMin    = min;
+                groupMax    = max;
+            } else {
+                groupMin    = qMin(groupMin, min);
+                groupMax    = qMax(groupMax, max);
+            }
+            groupSum += static_cast<double>(value);
+        }
+
+        msecs.append(groupStart);
+        values.append(static_cast<float>(groupSum / (end - begin)));
+        if (mins) {
+            mins->append(groupMin);
+        }
+        if (maxs) {
+            maxs->append(groupMax);
+        }
+    }
+}
+
+bool FactHistory::trend(qint64 windowMSecs, double& perSecond) const
+{
+    perSecond = 0;
+    if (isEmpty()) {
+        return false;
+    }
+
+    QVector<qint64> msecs;
+    QVector<float>  values;
+    samples(_lastMSecs - windowMSecs, 0, msecs, values);
+    if (msecs.count() < 2) {
+        return false;
+    }
+
+    const double n = msecs.count();
+    double sumT = 0, sumV = 0, sumTT = 0, sumTV = 0;
+    for (int i = 0; i < msecs.count(); i++) {
+        const double t = (msecs[i] - msecs[0]) / 1000.0;
+        const double v = static_cast<double>(values[i]);
+        sumT    += t;
+        sumV    += v;
+        sumTT   += t * t;
+        sumTV   += t * v;
+    }
+
+    const double denominator = (n * sumTT) - (sumT * sumT);
+    if (denominator <= 0) {
+        // All samples at the same time
+        return false;
+    }
+    perSecond = ((n * sumTV) - (sumT * sumV)) / denominator;
+    return true;
+}
+
+int FactHistory::memoryBytes(void) const
+{
+    int bytes = 0;
+    for (const Ring_t& ring: _tiers) {
+        bytes += ring.msecs.capacity() * static_cast<int>(sizeof(qint64));
+        bytes += (ring.values.capacity() + ring.mins.capacity() + ring.maxs.capacity()) * static_cast<int>(sizeof(float));
+    }
+    return bytes;
+}
@@ -0,0 +1,87 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QVector>
+
+/// Memory bounded time series of the values of a Fact, for sparklines and charts.
+///
+/// Each sample goes into a ring of raw values and is folded into two coarser tiers of fixed width buckets which hold
+/// the mean, min and max of the samples in the bucket. All tiers are rings of tierCapacity entries, so a history never
+/// grows past that no matter how long it runs: the raw tier covers minutes at a display update rate, the seconds tier
+/// ten minutes and the ten seconds tier well over an hour. Each column is its own array, reading a range walks plain
+/// arrays of times and values.
+///
+/// Views don't keep samples of their own, they read the range they show from the history of the Fact. See
+/// Fact::retainHistory.
+class FactHistory
+{
+public:
+    FactHistory(void);
+
+    enum Tier {
+        TierRaw,
+        TierSeconds,
+        TierTenSeconds,
+        TierCount
+    };
+
+    static const int tierCapacity = 600;
+
+    /// Adds a sample, times must not go backwards. NaN values are skipped.
+    void append(qint64 msecs, double value);
+
+    void clear(void);
+
+    /// Samples since fromMSecs, from the finest tier which reaches back that far
+    ///     @param maxPoints Neighbouring samples are averaged to fit, 0 for all of them
+    ///     @param mins, maxs Optional, range of the samples which went into each point
+    void samples(qint64 fromMSecs, int maxPoints, QVector<qint64>& msecs, QVector<float>& values, QVector<float>* mins = nullptr, QVector<float>* maxs = nullptr) const;
+
+    /// Change per second over the last windowMSecs, from a least squares fit
+    /// @return false: Less than two samples in the window
+    bool trend(qint64 windowMSecs, double& perSecond) const;
+
+    bool    isEmpty     (void) const { return _tiers[TierRaw].count == 0; }
+    int     count       (Tier tier) const { return _tiers[tier].count; }
+    qint64  lastMSecs   (void) const { return _lastMSecs; }
+    double  lastValue   (void) const { return _lastValue; }
+
+    /// Bytes held by the sample columns
+    int memoryBytes(void) const;
+
+    /// @return Bucket width of the tier, 0 for TierRaw
+    static qint64 bucketMSecs(Tier tier);
+
+private:
+    typedef struct {
+        QVector<qint64> msecs;              ///< Start of the bucket for the coarse tiers
+        QVector<float>  values;             ///< Mean for the coarse tiers
+        QVector<float>  mins;               ///< Empty for TierRaw
+        QVector<float>  maxs;               ///< Empty for TierRaw
+        int             head;               ///< Next entry written once the ring is full
+        int             count;
+
+        // Bucket being filled
+        qint64          bucketStart;
+        double          bucketSum;
+        float           bucketMin;
+        float           bucketMax;
+        int             bucketCount;
+    } Ring_t;
+
+    static int  _index  (const Ring_t& ring, int i) { return ring.count < tierCapacity ? i : (ring.head + i) % tierCapacity; }
+    static void _push   (Ring_t& ring, bool range, qint64 msecs, float value, float min, float max);
+    void        _fold   (Ring_t& ring, qint64 width, qint64 msecs, float value);
+
+    Ring_t  _tiers[TierCount];
+    qint64  _lastMSecs;
+    double  _lastValue;
+};
@@ -0,0 +1,189 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactHistoryTest.h"
+#include "FactHistory.h"
+#include "Fact.h"
+
+void FactHistoryTest::_appendTest(void)
+{
+    FactHistory     history;
+    QVector<qint64> msecs;
+    QVector<float>  values;
+
+    QVERIFY(history.isEmpty());
+    history.samples(0, 0, msecs, values);
+    QVERIFY(msecs.isEmpty());
+
+    history.append(1000, 1.0);
+    history.append(1100, qQNaN());
+    history.append(1200, 2.0);
+    QCOMPARE(history.count(FactHistory::TierRaw), 2);
+    QCOMPARE(history.lastMSecs(), static_cast<qint64>(1200));
+    QCOMPARE(history.lastValue(), 2.0);
+
+    history.samples(1100, 0, msecs, values);
+    QCOMPARE(msecs.count(), 1);
+    QCOMPARE(msecs[0], static_cast<qint64>(1200));
+    QCOMPARE(values[0], 2.0f);
+
+    // The raw ring keeps the newest samples
+    const int capacity = FactHistory::tierCapacity;
+    for (int i = 0; i < capacity * 3; i++) {
+        history.append(2000 + i, i);
+    }
+    QCOMPARE(history.count(FactHistory::TierRaw), capacity);
+
+    history.samples(2000 + (capacity * 3) - 10, 0, msecs, values);
+    QCOMPARE(msecs.count(), 10);
+    for (int i = 0; i < 10; i++) {
+        QCOMPARE(msecs[i], static_cast<qint64>(2000 + (capacity * 3) - 10 + i));
+        QCOMPARE(values[i], static_cast<float>((capacity * 3) - 10 + i));
+    }
+
+    history.clear();
+    QVERIFY(history.isEmpty());
+
+    // Once all tiers are full the memory stays the same, one sample a second for three hours fills them
+    const int fullBytes = capacity * static_cast<int>(sizeof(qint64) + sizeof(float)) + (2 * capacity * static_cast<int>(sizeof(qint64) + (3 * sizeof(float))));
+    for (int i = 0; i < 3 * 60 * 60; i++) {
+        history.append(i * 1000, i);
+    }
+    QCOMPARE(history.count(FactHistory::TierTenSeconds), capacity);
+    QCOMPARE(history.memoryBytes(), fullBytes);
+    for (int i = 3 * 60 * 60; i < 4 * 60 * 60; i++) {
+        history.append(i * 1000, i);
+    }
+    QCOMPARE(history.memoryBytes(), fullBytes);
+}
+
+void FactHistoryTest::_tierTest(void)
+{
+    FactHistory     history;
+    QVector<qint64> msecs;
+    QVector<float>  values;
+    QVector<float>  mins;
+    QVector<float>  maxs;
+
+    // Ten samples a second for 30 minutes: the raw ring covers one minute, the seconds tier ten
+    const qint64 endMSecs = 30 * 60 * 1000;
+    for (qint64 t = 0; t < endMSecs; t += 100) {
+        history.append(t, (t % 1000) / 100);
+    }
+    QCOMPARE(history.count(FactHistory::TierRaw),       static_cast<int>(FactHistory::tierCapacity));
+    QCOMPARE(history.count(FactHistory::TierSeconds),   static_cast<int>(FactHistory::tierCapacity));
+
+    history.samples(endMSecs - 30000, 0, msecs, values, &mins, &maxs);
+    QCOMPARE(msecs.count(), 300);
+    QCOMPARE(mins, values);
+
+    // Second buckets, the one still being filled comes last
+    history.samples(endMSecs - (5 * 60 * 1000), 0, msecs, values, &mins, &maxs);
+    QCOMPARE(msecs.count(), 300);
+    QCOMPARE(msecs[0], endMSecs - (5 * 60 * 1000));
+    QCOMPARE(msecs.last(), endMSecs - 1000);
+    QCOMPARE(values[0], 4.5f);
+    QCOMPARE(mins[0], 0.0f);
+    QCOMPARE(maxs[0], 9.0f);
+
+    // Ten second buckets
+    history.samples(endMSecs - (20 * 60 * 1000), 0, msecs, values, &mins, &maxs);
+    QCOMPARE(msecs.count(), 120);
+    QCOMPARE(msecs[1] - msecs[0], FactHistory::bucketMSecs(FactHistory::TierTenSeconds));
+    QCOMPARE(values[0], 4.5f);
+
+    // Past what any tier holds the coarsest one is used
+    history.samples(-endMSecs, 0, msecs, values);
+    QCOMPARE(msecs.count(), static_cast<int>(endMSecs / 10000));
+}
+
+void FactHistoryTest::_reduceTest(void)
+{
+    FactHistory     history;
+    QVector<qint64> msecs;
+    QVector<float>  values;
+    QVector<float>  mins;
+    QVector<float>  maxs;
+
+    for (int i = 0; i < 100; i++) {
+        history.append(i * 10, i);
+    }
+
+    history.samples(0, 10, msecs, values, &mins, &maxs);
+    QCOMPARE(msecs.count(), 10);
+    for (int i = 0; i < 10; i++) {
+        QCOMPARE(msecs[i],  static_cast<qint64>(i * 100));
+        QCOMPARE(values[i], (i * 10) + 4.5f);
+        QCOMPARE(mins[i],   static_cast<float>(i * 10));
+        QCOMPARE(maxs[i],   static_cast<float>((i * 10) + 9));
+    }
+
+    // Fewer samples than points are returned as they are
+    history.samples(900, 10, msecs, values);
+    QCOMPARE(msecs.count(), 10);
+    QCOMPARE(values[0], 90.0f);
+}
+
+void FactHistoryTest::_trendTest(void)
+{
+    FactHistory history;
+    double      perSecond;
+
+    history.append(0, 5.0);
+    QVERIFY(!history.trend(10000, perSecond));
+
+    // Climbing two per second, then holding
+    for (int i = 1; i <= 10; i++) {
+        history.append(i * 1000, 5.0 + (i * 2.0));
+    }
+    QVERIFY(history.trend(10000, perSecond));
+    QVERIFY(qAbs(perSecond - 2.0) < 0.001);
+
+    for (int i = 11; i <= 30; i++) {
+        history.append(i * 1000, 25.0);
+    }
+    QVERIFY(history.trend(10000, perSecond));
+    QVERIFY(qAbs(perSecond) < 0.001);
+}
+
+void FactHistoryTest::_retainTest(void)
+{
+    Fact fact(0, QStringLiteral("test"), FactMetaData::valueTypeDouble);
+
+    fact.setRawValue(1.0);
+    QVERIFY(!fact.history());
+    QVERIFY(fact.historyPoints(60, 0).isEmpty());
+
+    fact.retainHistory();
+    fact.retainHistory();
+    QVERIFY(fact.history());
+    QCOMPARE(fact.history()->count(FactHistory::TierRaw), 1);
+
+    fact.setRawValue(2.0);
+    fact.setRawValue(3.0);
+    QCOMPARE(fact.history()->count(FactHistory::TierRaw), 3);
+    QVariantList points = fact.historyPoints(60, 0);
+    QCOMPARE(points.count(), 3);
+    QCOMPARE(points.last().toPointF().y(), 3.0);
+    QVERIFY(points.last().toPointF().x() <= 0);
+
+    // Deferred values are recorded once they are signalled
+    fact.setSendValueChangedSignals(false);
+    fact.setRawValue(4.0);
+    fact.setRawValue(5.0);
+    QCOMPARE(fact.history()->count(FactHistory::TierRaw), 3);
+    fact.sendDeferredValueChangedSignal();
+    QCOMPARE(fact.history()->count(FactHistory::TierRaw), 4);
+    QCOMPARE(fact.history()->lastValue(), 5.0);
+
+    fact.releaseHistory();
+    QVERIFY(fact.history());
+    fact.releaseHistory();
+    QVERIFY(!fact.history());
+}
@@ -0,0 +1,25 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for FactHistory
+class FactHistoryTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _appendTest    (void);
+    void _tierTest      (void);
+    void _reduceTest    (void);
+    void _trendTest     (void);
+    void _retainTest    (void);
+};
@@ -16,6 +16,7 @@
 #include <QtMath>
 #include <QJsonParseError>
 #include <QJsonArray>
+#include <QDataStream>
 
 #include <limits>
 #include <cmath>
@@ -1478,6 +1479,18 @@ QMap<QString, FactMetaData*> FactMetaData::createMapFromJsonFile(const QString&
     return createMapFromJsonArray(factArray, defineMap, metaDataParent);
 }
 
+QMap<QString, FactMetaData*> FactMetaData::sharedMapFromJsonFile(const QString& jsonFilename)
+{
+    // Facts of any instance may point into these up to shutdown, so they are never deleted
+    static QMap<QString /* jsonFilename */, QMap<QString, FactMetaData*>> sharedMaps;
+
+    auto it = sharedMaps.find(jsonFilename);
+    if (it == sharedMaps.end()) {
+        it = sharedMaps.insert(jsonFilename, createMapFromJsonFile(jsonFilename, nullptr /* metaDataParent */));
+    }
+    return *it;
+}
+
 QMap<QString, FactMetaData*> FactMetaData::createMapFromJsonArray(const QJsonArray jsonArray, QMap<QString, QString>& defineMap, QObject* metaDataParent)
 {
     QMap<QString, FactMetaData*> metaDataMap;
@@ -1620,3 +1633,73 @@ bool FactMetaData::_parseBitmaskArray(const QJsonObject& jsonObject, QStringList
 
     return true;
 }
+
+void FactMetaData::writeToStream(QDataStream& stream) const
+{
+    stream << static_cast<qint32>(_type)
+           << _name
+           << _category
+           << _group
+           << _shortDescription
+           << _longDescription
+           << _rawUnits
+           << static_cast<qint32>(_decimalPlaces)
+           << _defaultValueAvailable
+           << _rawDefaultValue
+           << _minIsDefaultForType
+           << _rawMin
+           << _maxIsDefaultForType
+           << _rawMax
+           << _rawIncrement
+           << _vehicleRebootRequired
+           << _qgcRebootRequired
+           << _hasControl
+           << _readOnly
+           << _writeOnly
+           << _volatile
+           << _enumStrings
+           << _enumValues
+           << _bitmaskStrings
+           << _bitmaskValues;
+}
+
+FactMetaData* FactMetaData::createFromStream(QDataStream& stream, QObject* metaDataParent)
+{
+    qint32 type;
+    qint32 decimalPlaces;
+
+    stream >> type;
+
+    FactMetaData* metaData = new FactMetaData(static_cast<ValueType_t>(type), metaDataParent);
+
+    stream >> metaData->_name
+           >> metaData->_category
+           >> metaData->_group
+           >> metaData->_shortDescription
+           >> metaData->_longDescription
+           >> metaData->_rawUnits
+           >> decimalPlaces
+           >> metaData->_defaultValueAvailable
+           >> metaData->_rawDefaultValue
+           >> metaData->_minIsDefaultForType
+           >> metaData->_rawMin
+           >> metaData->_maxIsDefaultForType
+           >> metaData->_rawMax
+           >> metaData->_rawIncrement
+           >> metaData->_vehicleRebootRequired
+           >> metaData->_qgcRebootRequired
+           >> metaData->_hasControl
+           >> metaData->_readOnly
+           >> metaData->_writeOnly
+           >> metaData->_volatile
+           >> metaData->_enumStrings
+           >> metaData->_enumValues
+           >> metaData->_bitmaskStrings
+           >> metaData->_bitmaskValues;
+
+    metaData->_decimalPlaces = decimalPlaces;
+    metaData->_cookedUnits = metaData->_rawUnits;
+    metaData->setBuiltInTranslator();
+
+    return metaData;
+}
@@ -14,6 +14,8 @@
 #include <QVariant>
 #include <QJsonObject>
 
+class QDataStream;
+
 /// Holds the meta data associated with a Fact.
 ///
 /// Holds the meta data associated with a Fact. This is kept in a separate object from the Fact itself
@@ -57,10 +59,19 @@ public:
     typedef QMap<QString, QString> DefineMap_t;
 
     static QMap<QString, FactMetaData*> createMapFromJsonFile(const QString& jsonFilename, QObject* metaDataParent);
+
+    /// Same as createMapFromJsonFile, but the file is only parsed on the first call. Every caller gets the same meta data
+    /// which lives until the app exits, so treat it as read only and copy a FactMetaData which needs per instance changes.
+    /// Call on the GUI thread.
+    static QMap<QString, FactMetaData*> sharedMapFromJsonFile(const QString& jsonFilename);
     static QMap<QString, FactMetaData*> createMapFromJsonArray(const QJsonArray jsonArray, DefineMap_t& defineMap, QObject* metaDataParent);
 
     static FactMetaData* createFromJsonObject(const QJsonObject& json, QMap<QString, QString>& defineMap, QObject* metaDataParent);
 
+    /// Compact binary form of the meta data, see FactMetaDataStore. Translators are not written, they are rebuilt from the units.
+    void                    writeToStream   (QDataStream& stream) const;
+    static FactMetaData*    createFromStream(QDataStream& stream, QObject* metaDataParent);
+
     const FactMetaData& operator=(const FactMetaData& other);
 
     /// Converts from meters to the user specified horizontal distance unit
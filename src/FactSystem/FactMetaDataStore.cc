@@ -0,0 +1,168 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactMetaDataStore.h"
+#include "QGCLoggingCategory.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QLocale>
+#include <QSaveFile>
+#include <QSettings>
+
+QGC_LOGGING_CATEGORY(FactMetaDataStoreLog, "FactMetaDataStoreLog")
+
+FactMetaDataStore::FactMetaDataStore(void)
+{
+
+}
+
+QString FactMetaDataStore::storeDir(void)
+{
+    return QFileInfo(QSettings().fileName()).dir().absoluteFilePath(QStringLiteral("FactMetaDataStore"));
+}
+
+bool FactMetaDataStore::open(const QString& sourceFile, const QString& storeName)
+{
+    _file.close();
+    _data       = nullptr;
+    _records    = nullptr;
+    _size       = 0;
+    _index.clear();
+    _storeFile.clear();
+
+    QFile source(sourceFile);
+    if (!source.open(QIODevice::ReadOnly)) {
+        qCWarning(FactMetaDataStoreLog) << "Unable to open source file" << sourceFile << source.errorString();
+        return false;
+    }
+
+    // Enum strings may be translated and the record format follows FactMetaData, so both are part of the key
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&source);
+    hash.addData(QLocale().name().toUtf8());
+    hash.addData(QCoreApplication::applicationVersion().toUtf8());
+    hash.addData(QByteArray::number(_version));
+    _storeName = storeName;
+    _storeFile = QDir(storeDir()).absoluteFilePath(QStringLiteral("%1_%2.bin").arg(_storeName).arg(QString(hash.result().toHex())));
+
+    _file.setFileName(_storeFile);
+    if (!_file.exists()) {
+        qCDebug(FactMetaDataStoreLog) << "No store for" << sourceFile;
+        return false;
+    }
+    if (!_file.open(QIODevice::ReadOnly)) {
+        qCWarning(FactMetaDataStoreLog) << "Unable to open store" << _storeFile << _file.errorString();
+        return false;
+    }
+
+    _size = _file.size();
+    _data = _file.map(0, _size);
+    if (!_data || !_readIndex()) {
+        qCWarning(FactMetaDataStoreLog) << "Unable to use store" << _storeFile;
+        _file.close();
+        _data = nullptr;
+        _index.clear();
+        return false;
+    }
+
+    qCDebug(FactMetaDataStoreLog) << "Mapped store" << _storeFile << "parameters:" << _index.count();
+    return true;
+}
+
+bool FactMetaDataStore::_readIndex(void)
+{
+    QDataStream stream(QByteArray::fromRawData(reinterpret_cast<const char*>(_data), static_cast<int>(_size)));
+
+    quint32 magic   = 0;
+    qint32  version = 0;
+    qint32  count   = 0;
+
+    stream >> magic >> version >> count;
+    if (magic != _magic || version != _version || count < 0) {
+        return false;
+    }
+
+    _index.reserve(count);
+    for (qint32 i=0; i<count; i++) {
+        QString name;
+        quint32 offset;
+        quint32 length;
+
+        stream >> name >> offset >> length;
+        _index[name] = Record_t(offset, length);
+    }
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    qint64 recordsStart = stream.device()->pos();
+    for (const Record_t& record: _index) {
+        if (recordsStart + record.first + record.second > _size) {
+            return false;
+        }
+    }
+    _records = _data + recordsStart;
+
+    return true;
+}
+
+FactMetaData* FactMetaDataStore::create(const QString& name, QObject* metaDataParent) const
+{
+    auto iter = _index.constFind(name);
+    if (!_records || iter == _index.constEnd()) {
+        return nullptr;
+    }
+
+    QDataStream stream(QByteArray::fromRawData(reinterpret_cast<const char*>(_records + iter->first), static_cast<int>(iter->second)));
+    return FactMetaData::createFromStream(stream, metaDataParent);
+}
+
+void FactMetaDataStore::write(const FactMetaData::NameToMetaDataMap_t& nameToMetaDataMap)
+{
+    if (_storeFile.isEmpty()) {
+        qWarning() << "Internal error: FactMetaDataStore::write called without open";
+        return;
+    }
+
+    QByteArray  records;
+    QDataStream recordStream(&records, QIODevice::WriteOnly);
+    QByteArray  header;
+    QDataStream headerStream(&header, QIODevice::WriteOnly);
+
+    headerStream << _magic << _version << static_cast<qint32>(nameToMetaDataMap.count());
+    for (const QString& name: nameToMetaDataMap.keys()) {
+        quint32 offset = static_cast<quint32>(records.size());
+        nameToMetaDataMap[name]->writeToStream(recordStream);
+        headerStream << name << offset << static_cast<quint32>(records.size() - static_cast<int>(offset));
+    }
+
+    // Stores for previous contents of the same source are no longer needed
+    QDir dir(storeDir());
+    dir.mkpath(dir.absolutePath());
+    for (const QString& oldStore: dir.entryList(QStringList(QStringLiteral("%1_*.bin").arg(_storeName)), QDir::Files)) {
+        dir.remove(oldStore);
+    }
+
+    QSaveFile storeFile(_storeFile);
+    if (!storeFile.open(QIODevice::WriteOnly)) {
+        qCWarning(FactMetaDataStoreLog) << "Unable to write store" << _storeFile << storeFile.errorString();
+        return;
+    }
+    storeFile.write(header);
+    storeFile.write(records);
+    if (storeFile.commit()) {
+        qCDebug(FactMetaDataStoreLog) << "Wrote store" << _storeFile << "parameters:" << nameToMetaDataMap.count() << "bytes:" << header.size() + records.size();
+    } else {
+        qCWarning(FactMetaDataStoreLog) << "Unable to write store" << _storeFile << storeFile.errorString();
+    }
+}
@@ -0,0 +1,74 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QFile>
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QLoggingCategory>
+
+#include "FactMetaData.h"
+
+Q_DECLARE_LOGGING_CATEGORY(FactMetaDataStoreLog)
+
+/// Compact binary copy of a parameter meta data file (PX4 xml, component information json) which is memory mapped and
+/// only creates the FactMetaData of a parameter the first time it is asked for.
+///
+/// The store is written the first time a meta data file is parsed and is keyed by the contents of that file, the
+/// QGC version and the locale. From then on open succeeds and the source no longer needs to be parsed at all.
+/// Only the parameter name index is read on open, each record is decoded straight from the mapped file.
+///
+/// File layout (QDataStream):
+///     quint32 magic, qint32 version, qint32 count
+///     count * { QString name, quint32 offset, quint32 length }
+///     records, offsets are relative to the first record, see FactMetaData::writeToStream
+class FactMetaDataStore
+{
+public:
+    FactMetaDataStore(void);
+
+    /// Maps the store previously written for the current contents of the source file
+    ///     @param storeName Stores of the same name for other contents are replaced by write
+    /// @return false: No store available, parse the source file and call write
+    bool open(const QString& sourceFile, const QString& storeName);
+
+    /// Writes the store for the source file passed to the last open call
+    void write(const FactMetaData::NameToMetaDataMap_t& nameToMetaDataMap);
+
+    bool        isOpen      (void) const { return _data != nullptr; }
+    bool        contains    (const QString& name) const { return _index.contains(name); }
+    QStringList names       (void) const { return _index.keys(); }
+    int         count       (void) const { return _index.count(); }
+
+    /// Creates the FactMetaData for the specified parameter from the store
+    /// @return nullptr: Parameter is not in the store
+    FactMetaData* create(const QString& name, QObject* metaDataParent) const;
+
+    /// @return Directory the stores are kept in
+    static QString storeDir(void);
+
+private:
+    typedef QPair<quint32 /* offset */, quint32 /* length */> Record_t;
+
+    bool _readIndex(void);
+
+    QString                 _storeName;
+    QString                 _storeFile;     ///< Store for the source file passed to open
+    QFile                   _file;
+    const uchar*            _data = nullptr;
+    const uchar*            _records = nullptr;
+    qint64                  _size = 0;
+    QHash<QString, Record_t> _index;
+
+    static const quint32    _magic      = 0x51474d44;   ///< "QGMD"
+    static const qint32     _version    = 1;
+};
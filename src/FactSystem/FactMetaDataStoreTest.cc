@@ -0,0 +1,108 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FactMetaDataStoreTest.h"
+#include "FactMetaDataStore.h"
+
+#include <QTemporaryDir>
+
+FactMetaDataStoreTest::FactMetaDataStoreTest(void)
+{
+
+}
+
+void FactMetaDataStoreTest::_writeSource(const QString& filename, const QByteArray& contents)
+{
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(contents);
+}
+
+void FactMetaDataStoreTest::_roundTrip(void)
+{
+    QTemporaryDir   tempDir;
+    QString         sourceFile = tempDir.filePath("source.xml");
+    _writeSource(sourceFile, "FactMetaDataStoreTest::_roundTrip");
+
+    FactMetaData::NameToMetaDataMap_t   metaDataMap;
+    FactMetaData*                       enumMetaData = new FactMetaData(FactMetaData::valueTypeInt32, this);
+    FactMetaData*                       floatMetaData = new FactMetaData(FactMetaData::valueTypeFloat, this);
+
+    enumMetaData->setName("TEST_ENUM");
+    enumMetaData->setGroup("Test");
+    enumMetaData->setShortDescription("Enum value");
+    enumMetaData->setEnumInfo(QStringList({ "Off", "On" }), QVariantList({ 0, 1 }));
+    enumMetaData->setRawDefaultValue(1);
+    enumMetaData->setVehicleRebootRequired(true);
+    metaDataMap[enumMetaData->name()] = enumMetaData;
+
+    floatMetaData->setName("TEST_FLOAT");
+    floatMetaData->setLongDescription("Float value");
+    floatMetaData->setRawUnits("m");
+    floatMetaData->setRawMin(1.5f);
+    floatMetaData->setRawMax(10.0f);
+    floatMetaData->setRawIncrement(0.5);
+    floatMetaData->setDecimalPlaces(2);
+    floatMetaData->setVolatileValue(true);
+    metaDataMap[floatMetaData->name()] = floatMetaData;
+
+    FactMetaDataStore writeStore;
+    QCOMPARE(writeStore.open(sourceFile, "FactMetaDataStoreTest"), false);
+    writeStore.write(metaDataMap);
+
+    FactMetaDataStore readStore;
+    QCOMPARE(readStore.open(sourceFile, "FactMetaDataStoreTest"), true);
+    QCOMPARE(readStore.count(), 2);
+    QVERIFY(!readStore.create("TEST_MISSING", this));
+
+    FactMetaData* metaData = readStore.create("TEST_ENUM", this);
+    QVERIFY(metaData);
+    QCOMPARE(metaData->type(),                  FactMetaData::valueTypeInt32);
+    QCOMPARE(metaData->name(),                  enumMetaData->name());
+    QCOMPARE(metaData->group(),                 enumMetaData->group());
+    QCOMPARE(metaData->shortDescription(),      enumMetaData->shortDescription());
+    QCOMPARE(metaData->enumStrings(),           enumMetaData->enumStrings());
+    QCOMPARE(metaData->enumValues(),            enumMetaData->enumValues());
+    QCOMPARE(metaData->defaultValueAvailable(), true);
+    QCOMPARE(metaData->rawDefaultValue(),       enumMetaData->rawDefaultValue());
+    QCOMPARE(metaData->vehicleRebootRequired(), true);
+
+    metaData = readStore.create("TEST_FLOAT", this);
+    QVERIFY(metaData);
+    QCOMPARE(metaData->type(),              FactMetaData::valueTypeFloat);
+    QCOMPARE(metaData->longDescription(),   floatMetaData->longDescription());
+    QCOMPARE(metaData->rawUnits(),          floatMetaData->rawUnits());
+    QCOMPARE(metaData->cookedUnits(),       floatMetaData->cookedUnits());
+    QCOMPARE(metaData->rawMin(),            floatMetaData->rawMin());
+    QCOMPARE(metaData->rawMax(),            floatMetaData->rawMax());
+    QCOMPARE(metaData->rawIncrement(),      floatMetaData->rawIncrement());
+    QCOMPARE(metaData->decimalPlaces(),     floatMetaData->decimalPlaces());
+    QCOMPARE(metaData->volatileValue(),     true);
+    QCOMPARE(metaData->readOnly(),          true);
+}
+
+void FactMetaDataStoreTest::_sourceChanged(void)
+{
+    QTemporaryDir   tempDir;
+    QString         sourceFile = tempDir.filePath("source.xml");
+    _writeSource(sourceFile, "FactMetaDataStoreTest::_sourceChanged 1");
+
+    FactMetaData::NameToMetaDataMap_t metaDataMap;
+    metaDataMap["TEST"] = new FactMetaData(FactMetaData::valueTypeUint8, "TEST", this);
+
+    FactMetaDataStore store;
+    QCOMPARE(store.open(sourceFile, "FactMetaDataStoreTest"), false);
+    store.write(metaDataMap);
+    QCOMPARE(store.open(sourceFile, "FactMetaDataStoreTest"), true);
+
+    // A different source must not use the previous store
+    _writeSource(sourceFile, "FactMetaDataStoreTest::_sourceChanged 2");
+    QCOMPARE(store.open(sourceFile, "FactMetaDataStoreTest"), false);
+    QCOMPARE(store.contains("TEST"), false);
+}
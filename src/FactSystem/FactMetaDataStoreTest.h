@@ -0,0 +1,28 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for FactMetaDataStore
+class FactMetaDataStoreTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    FactMetaDataStoreTest(void);
+
+private slots:
+    void _roundTrip     (void);
+    void _sourceChanged (void);
+
+private:
+    void _writeSource(const QString& filename, const QByteArray& contents);
+};
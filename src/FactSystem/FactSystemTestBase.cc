@@ -21,6 +21,10 @@
 #include "ParameterManager.h"
 
 #include <QQuickItem>
+#include <QSignalSpy>
+
+#include <functional>
+#include <limits>
 
 /// FactSystem Unit Test
 FactSystemTestBase::FactSystemTestBase(void)
@@ -116,3 +120,140 @@ void FactSystemTestBase::_qmlUpdate_test(void)
 #endif
 }
 
+/// Fact::setRawValueTyped keeps a native copy of the value. Every other writer must invalidate it, or the fast path
+/// would compare against a stale value.
+void FactSystemTestBase::_setRawValueTypedWriters_test(void)
+{
+    Fact        fact(0, QStringLiteral("test"), FactMetaData::valueTypeDouble);
+    QSignalSpy  spy(&fact, &Fact::rawValueChanged);
+
+    fact.setRawValueTyped(1.5);
+    QCOMPARE(spy.count(), 1);
+    fact.setRawValueTyped(1.5);
+    QCOMPARE(spy.count(), 1);
+
+    fact.setRawValue(2.5);
+    QCOMPARE(spy.count(), 2);
+    fact.setRawValueTyped(1.5);
+    QCOMPARE(spy.count(), 3);
+    QCOMPARE(fact.rawValue().toDouble(), 1.5);
+
+    fact.forceSetRawValue(2.5);
+    QCOMPARE(spy.count(), 4);
+    fact.setRawValueTyped(1.5);
+    QCOMPARE(spy.count(), 5);
+    QCOMPARE(fact.rawValue().toDouble(), 1.5);
+
+    fact._containerSetRawValue(QVariant(2.5));
+    QCOMPARE(spy.count(), 6);
+    fact.setRawValueTyped(1.5);
+    QCOMPARE(spy.count(), 7);
+    QCOMPARE(fact.rawValue().toDouble(), 1.5);
+
+    // The native copy comes along with the value
+    Fact other(0, QStringLiteral("other"), FactMetaData::valueTypeDouble);
+    other.setRawValueTyped(3.5);
+    fact = other;
+    fact.setRawValueTyped(3.5);
+    QCOMPARE(spy.count(), 7);
+    fact.setRawValueTyped(1.5);
+    QCOMPARE(spy.count(), 8);
+    QCOMPARE(fact.rawValue().toDouble(), 1.5);
+
+    // The same value set through another path isn't a change for the fast path either
+    fact.setRawValue(4.5);
+    QCOMPARE(spy.count(), 9);
+    fact.setRawValueTyped(4.5);
+    QCOMPARE(spy.count(), 9);
+}
+
+/// Fact::setRawValueTyped must store the same value and type FactMetaData::convertAndValidateRaw makes of the input
+void FactSystemTestBase::_setRawValueTypedConversion_test(void)
+{
+    const QList<FactMetaData::ValueType_t> types = {
+        FactMetaData::valueTypeInt8,    FactMetaData::valueTypeInt16,   FactMetaData::valueTypeInt32,   FactMetaData::valueTypeInt64,
+        FactMetaData::valueTypeUint8,   FactMetaData::valueTypeUint16,  FactMetaData::valueTypeUint32,  FactMetaData::valueTypeUint64,
+        FactMetaData::valueTypeFloat,   FactMetaData::valueTypeDouble,  FactMetaData::valueTypeElapsedTimeInSeconds,
+        FactMetaData::valueTypeBool,
+    };
+    const QList<double>     doubleValues    = { 0.0, 0.1, 1.5, 2.4, 2.5, -2.5, -0.4, 100.7, 1000000.3, 16777217.0 };
+    const QList<qint64>     int64Values     = { 0, 1, -3, 42, 70000, 16777217, -5000000000LL };
+    const QList<quint64>    uint64Values    = { 0, 7, 70000, 5000000000ULL };
+
+    for (FactMetaData::ValueType_t type: types) {
+        FactMetaData metaData(type);
+
+        auto check = [&](const QVariant& input, std::function<void(Fact&)> setTyped) {
+            QVariant    expected;
+            QString     errorString;
+            QVERIFY(metaData.convertAndValidateRaw(input, true /* convertOnly */, expected, errorString));
+
+            Fact fact(0, QStringLiteral("test"), type);
+            setTyped(fact);
+            QVERIFY2(fact.rawValue().userType() == expected.userType(), qPrintable(QStringLiteral("type %1 input %2").arg(FactMetaData::typeToString(type)).arg(input.toString())));
+            QVERIFY2(fact.rawValue() == expected, qPrintable(QStringLiteral("type %1 input %2: %3 != %4").arg(FactMetaData::typeToString(type)).arg(input.toString()).arg(fact.rawValue().toString()).arg(expected.toString())));
+        };
+
+        for (double value: doubleValues) {
+            check(QVariant(value), [value](Fact& fact) { fact.setRawValueTyped(value); });
+            if (QTest::currentTestFailed()) {
+                return;
+            }
+        }
+        for (qint64 value: int64Values) {
+            check(QVariant(value), [value](Fact& fact) { fact.setRawValueTyped(value); });
+            if (QTest::currentTestFailed()) {
+                return;
+            }
+        }
+        for (quint64 value: uint64Values) {
+            check(QVariant(value), [value](Fact& fact) { fact.setRawValueTyped(value); });
+            if (QTest::currentTestFailed()) {
+                return;
+            }
+        }
+    }
+}
+
+/// Doubles which can't be cast to the storage type go through setRawValue instead, and NaN doesn't signal repeatedly
+void FactSystemTestBase::_setRawValueTypedNaNRange_test(void)
+{
+    const QList<QPair<FactMetaData::ValueType_t, double>> outOfRange = {
+        { FactMetaData::valueTypeInt32,     1.0e12 },
+        { FactMetaData::valueTypeInt32,     -1.0e12 },
+        { FactMetaData::valueTypeUint32,    -1.0 },
+        { FactMetaData::valueTypeUint32,    1.0e12 },
+        { FactMetaData::valueTypeInt64,     1.0e16 },
+        { FactMetaData::valueTypeUint64,    1.0e16 },
+        { FactMetaData::valueTypeInt32,     qQNaN() },
+        { FactMetaData::valueTypeUint64,    qQNaN() },
+    };
+    for (const auto& entry: outOfRange) {
+        Fact typedFact  (0, QStringLiteral("typed"),    entry.first);
+        Fact variantFact(0, QStringLiteral("variant"),  entry.first);
+
+        typedFact.setRawValueTyped(entry.second);
+        variantFact.setRawValue(QVariant(entry.second));
+        QCOMPARE(typedFact.rawValue(), variantFact.rawValue());
+    }
+
+    // Infinity converts to float without leaving the fast path
+    Fact floatFact(0, QStringLiteral("float"), FactMetaData::valueTypeFloat);
+    floatFact.setRawValueTyped(std::numeric_limits<double>::infinity());
+    QVERIFY(qIsInf(floatFact.rawValue().toFloat()));
+
+    for (FactMetaData::ValueType_t type: { FactMetaData::valueTypeFloat, FactMetaData::valueTypeDouble }) {
+        Fact        fact(0, QStringLiteral("test"), type);
+        QSignalSpy  spy(&fact, &Fact::rawValueChanged);
+
+        fact.setRawValueTyped(qQNaN());
+        QCOMPARE(spy.count(), 1);
+        QVERIFY(qIsNaN(fact.rawValue().toDouble()));
+        fact.setRawValueTyped(qQNaN());
+        QCOMPARE(spy.count(), 1);
+        fact.setRawValueTyped(1.0);
+        QCOMPARE(spy.count(), 2);
+        fact.setRawValueTyped(qQNaN());
+        QCOMPARE(spy.count(), 3);
+    }
+}
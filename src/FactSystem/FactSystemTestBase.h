@@ -34,6 +34,9 @@ protected:
     void _parameter_specific_component_id_test(void);
     void _qml_test(void);
     void _qmlUpdate_test(void);
+    void _setRawValueTypedWriters_test(void);
+    void _setRawValueTypedConversion_test(void);
+    void _setRawValueTypedNaNRange_test(void);
     
     AutoPilotPlugin*                _plugin;
 };
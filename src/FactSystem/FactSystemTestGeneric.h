@@ -34,6 +34,11 @@ private slots:
     void parameter_specific_component_id_test(void) { _parameter_specific_component_id_test(); }
     void qml_test(void) { _qml_test(); }
     void qmlUpdate_test(void) { _qmlUpdate_test(); }
+
+    // Don't depend on the autopilot, only run here
+    void setRawValueTypedWriters_test(void) { _setRawValueTypedWriters_test(); }
+    void setRawValueTypedConversion_test(void) { _setRawValueTypedConversion_test(); }
+    void setRawValueTypedNaNRange_test(void) { _setRawValueTypedNaNRange_test(); }
 };
 
 #endif
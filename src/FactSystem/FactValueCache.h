@@ -0,0 +1,55 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QVariant>
+
+#include <atomic>
+
+#include "Fact.h"
+
+/// Keeps a plain C++ copy of a Fact's raw value which is updated whenever the Fact changes.
+///
+/// Use this for Facts (typically SettingsFacts) which are read on hot paths such as the MAVLink receive
+/// loop, where repeatedly walking the toolbox/settings pointer chain and converting the QVariant shows up
+/// in profiles. Reads are lock free and may come from any thread, updates happen on the thread of the
+/// context object passed to bind. T must be a trivially copyable type such as bool, int or double.
+template <typename T>
+class FactValueCache
+{
+public:
+    FactValueCache(void) = default;
+    FactValueCache(const FactValueCache&) = delete;
+    FactValueCache& operator=(const FactValueCache&) = delete;
+
+    ~FactValueCache()
+    {
+        QObject::disconnect(_connection);
+    }
+
+    /// Loads the current value of the fact and follows any changes to it
+    ///     @param context Updates stop when this object is destroyed, normally the owner of the cache
+    void bind(Fact* fact, QObject* context)
+    {
+        QObject::disconnect(_connection);
+        _value.store(fact->rawValue().template value<T>(), std::memory_order_relaxed);
+        _connection = QObject::connect(fact, &Fact::rawValueChanged, context, [this](QVariant value) {
+            _value.store(value.template value<T>(), std::memory_order_relaxed);
+        });
+    }
+
+    T value(void) const { return _value.load(std::memory_order_relaxed); }
+    operator T(void) const { return value(); }
+
+private:
+    std::atomic<T>          _value { T() };
+    QMetaObject::Connection _connection;
+};
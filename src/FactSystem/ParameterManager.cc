@@ -10,6 +10,7 @@
 #include "ParameterManager.h"
 #include "QGCApplication.h"
 #include "QGCLoggingCategory.h"
+#include "QGCMemoryAccounting.h"
 #include "QGCApplication.h"
 #include "UASMessageHandler.h"
 #include "FirmwarePlugin.h"
@@ -17,12 +18,14 @@
 #include "JsonHelper.h"
 #include "ComponentInformationManager.h"
 #include "CompInfoParam.h"
+#include "FTPManager.h"
 
 #include <QEasingCurve>
 #include <QFile>
 #include <QDebug>
 #include <QVariantAnimation>
 #include <QJsonArray>
+#include <QtEndian>
 
 QGC_LOGGING_CATEGORY(ParameterManagerVerbose1Log,           "ParameterManagerVerbose1Log")
 QGC_LOGGING_CATEGORY(ParameterManagerVerbose2Log,           "ParameterManagerVerbose2Log")
@@ -90,6 +93,16 @@ ParameterManager::ParameterManager(Vehicle* vehicle)
     , _indexBatchQueueActive            (false)
     , _totalParamCount                  (0)
 {
+    // Meta data is shared between vehicles and not counted
+    qgcApp()->toolbox()->memoryAccounting()->addSource(QStringLiteral("Parameter facts"), this, [this]() {
+        QGCMemoryAccounting::Usage_t usage{ 0, 0 };
+        for (const QMap<QString, Fact*>& factMap: _mapCompId2FactMap) {
+            usage.count += factMap.count();
+        }
+        usage.bytes = usage.count * static_cast<qint64>(sizeof(Fact));
+        return usage;
+    });
+
     if (_vehicle->isOfflineEditingVehicle()) {
         _loadOfflineEditingParams();
         return;
@@ -99,16 +112,23 @@ ParameterManager::ParameterManager(Vehicle* vehicle)
 
     _initialRequestTimeoutTimer.setSingleShot(true);
     _initialRequestTimeoutTimer.setInterval(5000);
-    connect(&_initialRequestTimeoutTimer, &QTimer::timeout, this, &ParameterManager::_initialRequestTimeout);
+    connect(&_initialRequestTimeoutTimer, &QGCWheelTimer::timeout, this, &ParameterManager::_initialRequestTimeout);
 
     _waitingParamTimeoutTimer.setSingleShot(true);
-    _waitingParamTimeoutTimer.setInterval(3000);
-    connect(&_waitingParamTimeoutTimer, &QTimer::timeout, this, &ParameterManager::_waitingParamTimeout);
+    _waitingParamTimeoutTimer.setInterval(_defaultWaitingParamTimeoutMsecs);
+    connect(&_waitingParamTimeoutTimer, &QGCWheelTimer::timeout, this, &ParameterManager::_waitingParamTimeout);
+
+    _syncTimer.start();
 
     // Ensure the cache directory exists
     QFileInfo(QSettings().fileName()).dir().mkdir("ParamCache");
 }
 
+ParameterManager::~ParameterManager()
+{
+    delete _ftpParamDir;
+}
+
 void ParameterManager::_updateProgressBar(void)
 {
     int waitingReadParamIndexCount = 0;
@@ -124,6 +144,7 @@ void ParameterManager::_updateProgressBar(void)
     for(int compId: _waitingWriteParamNameMap.keys()) {
         waitingWriteParamCount += _waitingWriteParamNameMap[compId].count();
     }
+    waitingWriteParamCount += _paramWriteQueue.count();
 
     if (waitingReadParamIndexCount == 0) {
         if (_readParamIndexProgressActive) {
@@ -167,7 +188,7 @@ void ParameterManager::_updateProgressBar(void)
 }
 
 
-void ParameterManager::mavlinkMessageReceived(mavlink_message_t message)
+void ParameterManager::mavlinkMessageReceived(const mavlink_message_t& message)
 {
     if (message.msgid == MAVLINK_MSG_ID_PARAM_VALUE) {
         mavlink_param_value_t param_value;
@@ -236,6 +257,15 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
 
     _initialRequestTimeoutTimer.stop();
 
+    if (!_loadingFromCache) {
+        _paramReceivedCount++;
+        if (_paramListRequestMsecs >= 0) {
+            // First response to the request list
+            _sampleRoundTrip(_paramListRequestMsecs);
+            _paramListRequestMsecs = -1;
+        }
+    }
+
 #if 0
     if (!_initialLoadComplete && !_indexBatchQueueActive) {
         // Handy for testing retry logic
@@ -257,7 +287,7 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
     if (_vehicle->px4Firmware() && parameterName == "_HASH_CHECK") {
         if (!_initialLoadComplete && !_logReplay) {
             /* we received a cache hash, potentially load from cache */
-            _tryCacheHashLoad(_vehicle->id(), componentId, parameterValue);
+            _tryCacheHashLoad(_vehicle->id(), componentId, parameterCount, parameterValue);
         }
         return;
     }
@@ -301,6 +331,10 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
         _waitingWriteParamNameMap[componentId] = QMap<QString, int>();
 
         qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Seeing component for first time - paramcount:" << parameterCount;
+
+        if (!_initialLoadComplete && !_logReplay && !_loadingFromCache) {
+            _prefetchFromCache(componentId, parameterCount);
+        }
     }
 
     if (!_waitingReadParamIndexMap[componentId].contains(parameterIndex) &&
@@ -309,6 +343,20 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Unrequested param update" << parameterName;
     }
 
+    // Round trips are only measured for requests which were sent once, otherwise the response may be to an earlier attempt
+    if (_indexRequestTimeMap[componentId].contains(parameterIndex)) {
+        if (_waitingReadParamIndexMap[componentId].value(parameterIndex) == 1) {
+            _sampleRoundTrip(_indexRequestTimeMap[componentId][parameterIndex]);
+        }
+        _indexRequestTimeMap[componentId].remove(parameterIndex);
+    }
+    if (_nameRequestTimeMap[componentId].contains(parameterName)) {
+        if (_waitingReadParamNameMap[componentId].value(parameterName, -1) == 0 || _waitingWriteParamNameMap[componentId].value(parameterName, -1) == 0) {
+            _sampleRoundTrip(_nameRequestTimeMap[componentId][parameterName]);
+        }
+        _nameRequestTimeMap[componentId].remove(parameterName);
+    }
+
     // Remove this parameter from the waiting lists
     if (_waitingReadParamIndexMap[componentId].contains(parameterIndex)) {
         _waitingReadParamIndexMap[componentId].remove(parameterIndex);
@@ -316,15 +364,34 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
         _fillIndexBatchQueue(false /* waitingParamTimeout */);
     }
     _waitingReadParamNameMap[componentId].remove(parameterName);
+    if (_waitingWriteParamNameMap[componentId].contains(parameterName) && _paramWriteMap[componentId].contains(parameterName)) {
+        // Batched write, verify the vehicle took the value
+        ParamWrite_t paramWrite = _paramWriteMap[componentId].take(parameterName);
+        if (_rawValuesEqual(paramWrite.valueType, parameterValue, paramWrite.rawValue)) {
+            _paramWriteCompleteCount++;
+            _paramWriteLastMsecs = _paramWriteTimer.elapsed();
+        } else if (++paramWrite.retryCount <= _maxReadWriteRetry) {
+            qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Batched write echo mismatch, resending (paramName:" << parameterName << "sent:" << paramWrite.rawValue << "echo:" << parameterValue << ")";
+            _paramRetryCount++;
+            _paramWriteQueue.prepend(paramWrite);
+        } else {
+            _paramWriteFailedCount++;
+            QString errorMsg = tr("Parameter write failed: veh:%1 comp:%2 param:%3 vehicle value:%4").arg(_vehicle->id()).arg(componentId).arg(parameterName).arg(parameterValue.toString());
+            qCDebug(ParameterManagerLog) << errorMsg;
+            qgcApp()->showAppMessage(errorMsg);
+        }
+        emit syncStatsChanged();
+    }
     _waitingWriteParamNameMap[componentId].remove(parameterName);
+    _sendQueuedParamWrites();
     if (_waitingReadParamIndexMap[componentId].count()) {
-        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap:" << _waitingReadParamIndexMap[componentId];
+        QGC_DEBUG_RATE_LIMITED(ParameterManagerVerbose2Log, _verboseLogIntervalMsecs) << _logVehiclePrefix(componentId) << "_waitingReadParamIndexMap:" << _waitingReadParamIndexMap[componentId];
     }
     if (_waitingReadParamNameMap[componentId].count()) {
-        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "_waitingReadParamNameMap" << _waitingReadParamNameMap[componentId];
+        QGC_DEBUG_RATE_LIMITED(ParameterManagerVerbose2Log, _verboseLogIntervalMsecs) << _logVehiclePrefix(componentId) << "_waitingReadParamNameMap" << _waitingReadParamNameMap[componentId];
     }
     if (_waitingWriteParamNameMap[componentId].count()) {
-        qCDebug(ParameterManagerVerbose2Log) << _logVehiclePrefix(componentId) << "_waitingWriteParamNameMap" << _waitingWriteParamNameMap[componentId];
+        QGC_DEBUG_RATE_LIMITED(ParameterManagerVerbose2Log, _verboseLogIntervalMsecs) << _logVehiclePrefix(componentId) << "_waitingWriteParamNameMap" << _waitingWriteParamNameMap[componentId];
     }
 
     // Track how many parameters we are still waiting for
@@ -337,21 +404,21 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
         waitingReadParamIndexCount += _waitingReadParamIndexMap[waitingComponentId].count();
     }
     if (waitingReadParamIndexCount) {
-        qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "waitingReadParamIndexCount:" << waitingReadParamIndexCount;
+        QGC_DEBUG_RATE_LIMITED(ParameterManagerVerbose1Log, _verboseLogIntervalMsecs) << _logVehiclePrefix(componentId) << "waitingReadParamIndexCount:" << waitingReadParamIndexCount;
     }
 
     for(int waitingComponentId: _waitingReadParamNameMap.keys()) {
         waitingReadParamNameCount += _waitingReadParamNameMap[waitingComponentId].count();
     }
     if (waitingReadParamNameCount) {
-        qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "waitingReadParamNameCount:" << waitingReadParamNameCount;
+        QGC_DEBUG_RATE_LIMITED(ParameterManagerVerbose1Log, _verboseLogIntervalMsecs) << _logVehiclePrefix(componentId) << "waitingReadParamNameCount:" << waitingReadParamNameCount;
     }
 
     for(int waitingComponentId: _waitingWriteParamNameMap.keys()) {
         waitingWriteParamNameCount += _waitingWriteParamNameMap[waitingComponentId].count();
     }
     if (waitingWriteParamNameCount) {
-        qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "waitingWriteParamNameCount:" << waitingWriteParamNameCount;
+        QGC_DEBUG_RATE_LIMITED(ParameterManagerVerbose1Log, _verboseLogIntervalMsecs) << _logVehiclePrefix(componentId) << "waitingWriteParamNameCount:" << waitingWriteParamNameCount;
     }
 
     int readWaitingParamCount = waitingReadParamIndexCount + waitingReadParamNameCount;
@@ -359,7 +426,7 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
     if (totalWaitingParamCount) {
         // More params to wait for, restart timer
         _waitingParamTimeoutTimer.start();
-        qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(-1) << "Restarting _waitingParamTimeoutTimer: totalWaitingParamCount:" << totalWaitingParamCount;
+        QGC_DEBUG_RATE_LIMITED(ParameterManagerVerbose1Log, _verboseLogIntervalMsecs) << _logVehiclePrefix(-1) << "Restarting _waitingParamTimeoutTimer: totalWaitingParamCount:" << totalWaitingParamCount;
     } else {
         if (!_mapCompId2FactMap.contains(_vehicle->defaultComponentId())) {
             // Still waiting for parameters from default component
@@ -372,17 +439,25 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
 \
     _updateProgressBar();
 
-    Fact* fact = nullptr;
-    if (_mapCompId2FactMap.contains(componentId) && _mapCompId2FactMap[componentId].contains(parameterName)) {
-        fact = _mapCompId2FactMap[componentId][parameterName];
-    } else {
+    Fact* fact = _findFact(componentId, parameterName);
+    if (!fact) {
         qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(componentId) << "Adding new fact" << parameterName;
 
-        fact = new Fact(componentId, parameterName, mavTypeToFactType(mavParamType), this);
-        FactMetaData* factMetaData = _vehicle->compInfoManager()->compInfoParam(componentId)->factMetaDataForName(parameterName, fact->type());
-        fact->setMetaData(factMetaData);
+        if (_prefetchFactMap.contains(componentId) && _prefetchFactMap[componentId].contains(parameterName)) {
+            fact = _prefetchFactMap[componentId].take(parameterName);
+            if (fact->type() != mavTypeToFactType(mavParamType)) {
+                // Parameter type changed since the cache was written
+                fact->deleteLater();
+                fact = nullptr;
+            }
+        }
+        if (!fact) {
+            fact = new Fact(componentId, parameterName, mavTypeToFactType(mavParamType), this);
+            FactMetaData* factMetaData = _vehicle->compInfoManager()->compInfoParam(componentId)->factMetaDataForName(parameterName, fact->type());
+            fact->setMetaData(factMetaData);
+        }
 
-        _mapCompId2FactMap[componentId][parameterName] = fact;
+        _addFact(fact);
 
         // We need to know when the fact value changes so we can update the vehicle
         connect(fact, &Fact::_containerRawValueChanged, this, &ParameterManager::_factRawValueUpdated);
@@ -390,12 +465,21 @@ void ParameterManager::_handleParamValue(int componentId, QString parameterName,
         emit factAdded(componentId, fact);
     }
 
+    if (parameterIndex >= 0 && parameterIndex < parameterCount) {
+        QVector<Fact*>& indexFacts = _compId2IndexFactMap[componentId];
+        if (indexFacts.count() != parameterCount) {
+            indexFacts.fill(nullptr, parameterCount);
+        }
+        indexFacts[parameterIndex] = fact;
+    }
+
     fact->_containerSetRawValue(parameterValue);
 
-    // Update param cache. The param cache is only used on PX4 Firmware since ArduPilot and Solo have volatile params
-    // which invalidate the cache. The Solo also streams param updates in flight for things like gimbal values
-    // which in turn causes a perf problem with all the param cache updates.
-    if (!_logReplay && _vehicle->px4Firmware()) {
+    // Update param cache. The cached values are only trusted on PX4 Firmware since only it provides the _HASH_CHECK to validate
+    // them against. Other firmware only uses the cached names and types to prefetch facts, so the cache is written once when the
+    // initial load completes. ArduPilot and Solo also stream param updates in flight for things like gimbal values which
+    // would otherwise cause a perf problem with all the param cache updates.
+    if (!_logReplay && (_vehicle->px4Firmware() || !_initialLoadComplete)) {
         if (_prevWaitingReadParamIndexCount + _prevWaitingReadParamNameCount != 0 && readWaitingParamCount == 0) {
             // All reads just finished, update the cache
             _writeLocalParamCache(_vehicle->id(), componentId);
@@ -440,9 +524,145 @@ void ParameterManager::_factRawValueUpdated(const QVariant& rawValue)
         return;
     }
 
+    // A user edit replaces any batched write of the same parameter
+    _cancelParamWrite(fact->componentId(), fact->name());
     _factRawValueUpdateWorker(fact->componentId(), fact->name(), fact->type(), rawValue);
 }
 
+void ParameterManager::_cancelParamWrite(int componentId, const QString& name)
+{
+    if (_paramWriteMap[componentId].remove(name)) {
+        _paramWriteTotalCount--;
+    }
+    for (int i=_paramWriteQueue.count()-1; i>=0; i--) {
+        if (_paramWriteQueue[i].componentId == componentId && _paramWriteQueue[i].name == name) {
+            _paramWriteQueue.removeAt(i);
+            _paramWriteTotalCount--;
+        }
+    }
+}
+
+int ParameterManager::writeParameters(const QList<ParamWrite_t>& rgWrites)
+{
+    int queuedCount = 0;
+
+    if (_paramWriteQueue.isEmpty() && _outstandingParamWriteCount() == 0) {
+        // Start a new batch
+        _paramWriteTimer.start();
+        _paramWriteLastMsecs    = 0;
+        _paramWriteTotalCount   = 0;
+        _paramWriteCompleteCount= 0;
+        _paramWriteFailedCount  = 0;
+    }
+
+    for (const ParamWrite_t& paramWrite: rgWrites) {
+        if (!_waitingWriteParamNameMap.contains(paramWrite.componentId)) {
+            qCWarning(ParameterManagerLog) << _logVehiclePrefix(paramWrite.componentId) << "writeParameters: unknown component, skipping" << paramWrite.name;
+            continue;
+        }
+
+        ParamWrite_t    queuedWrite = paramWrite;
+        Fact*           fact        = _findFact(paramWrite.componentId, paramWrite.name);
+
+        queuedWrite.retryCount = 0;
+        if (fact) {
+            if (_rawValuesEqual(fact->type(), fact->rawValue(), paramWrite.rawValue)) {
+                // No change from the current vehicle value
+                continue;
+            }
+            queuedWrite.valueType = fact->type();
+        }
+
+        _cancelParamWrite(queuedWrite.componentId, queuedWrite.name);
+        _paramWriteQueue.append(queuedWrite);
+        queuedCount++;
+    }
+
+    qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "writeParameters: requested:queued" << rgWrites.count() << queuedCount;
+
+    // Queued writes are part of the progress bar batch from the start
+    _paramWriteTotalCount           += queuedCount;
+    _waitingWriteParamBatchCount    += queuedCount;
+    _sendQueuedParamWrites();
+    _updateProgressBar();
+    emit syncStatsChanged();
+
+    return queuedCount;
+}
+
+/// Moves batched writes from the queue to the vehicle until the window is full
+void ParameterManager::_sendQueuedParamWrites(void)
+{
+    while (!_paramWriteQueue.isEmpty() && _outstandingParamWriteCount() < _paramWriteWindowSize) {
+        ParamWrite_t paramWrite = _paramWriteQueue.takeFirst();
+
+        _waitingWriteParamNameMap[paramWrite.componentId][paramWrite.name] = 0;
+        _paramWriteMap[paramWrite.componentId][paramWrite.name] = paramWrite;
+        _saveRequired = true;
+
+        _sendParamSetToVehicle(paramWrite.componentId, paramWrite.name, paramWrite.valueType, paramWrite.rawValue);
+        _waitingParamTimeoutTimer.start();
+    }
+}
+
+int ParameterManager::_outstandingParamWriteCount(void) const
+{
+    int count = 0;
+    for (const QMap<QString, ParamWrite_t>& writeMap: _paramWriteMap) {
+        count += writeMap.count();
+    }
+    return count;
+}
+
+bool ParameterManager::_rawValuesEqual(FactMetaData::ValueType_t valueType, const QVariant& rawValue1, const QVariant& rawValue2)
+{
+    switch (valueType) {
+    case FactMetaData::valueTypeFloat:
+        // PARAM_VALUE carries a float, compare at that precision
+        return static_cast<float>(rawValue1.toDouble()) == static_cast<float>(rawValue2.toDouble());
+    case FactMetaData::valueTypeDouble:
+        return rawValue1.toDouble() == rawValue2.toDouble();
+    case FactMetaData::valueTypeUint8:
+    case FactMetaData::valueTypeUint16:
+    case FactMetaData::valueTypeUint32:
+    case FactMetaData::valueTypeUint64:
+        return rawValue1.toULongLong() == rawValue2.toULongLong();
+    case FactMetaData::valueTypeInt8:
+    case FactMetaData::valueTypeInt16:
+    case FactMetaData::valueTypeInt32:
+    case FactMetaData::valueTypeInt64:
+        return rawValue1.toLongLong() == rawValue2.toLongLong();
+    default:
+        return rawValue1 == rawValue2;
+    }
+}
+
+double ParameterManager::paramWriteProgress(void) const
+{
+    if (_paramWriteTotalCount <= 0) {
+        return 0.0;
+    }
+    return qMin(1.0, static_cast<double>(_paramWriteCompleteCount + _paramWriteFailedCount) / _paramWriteTotalCount);
+}
+
+double ParameterManager::paramWritesPerSecond(void) const
+{
+    if (_paramWriteCompleteCount == 0) {
+        return 0.0;
+    }
+    return (_paramWriteCompleteCount * 1000.0) / qMax(static_cast<qint64>(1), _paramWriteLastMsecs);
+}
+
+void ParameterManager::setParamWriteWindowSize(int windowSize)
+{
+    windowSize = qMax(1, windowSize);
+    if (windowSize != _paramWriteWindowSize) {
+        _paramWriteWindowSize = windowSize;
+        _sendQueuedParamWrites();
+        emit syncStatsChanged();
+    }
+}
+
 void ParameterManager::refreshAllParameters(uint8_t componentId)
 {
     WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
@@ -459,6 +679,21 @@ void ParameterManager::refreshAllParameters(uint8_t componentId)
         _waitingForDefaultComponent = false;
         emit parametersReadyChanged(_parametersReady);
         emit missingParametersChanged(_missingParameters);
+    } else if ((componentId == MAV_COMP_ID_ALL || componentId == MAV_COMP_ID_AUTOPILOT1) && _ftpParamLoadBegin()) {
+        // Parameters arrive through _ftpParamLoadComplete, which falls back to _requestParamList on failure
+        return;
+    }
+
+    _requestParamList(componentId);
+}
+
+/// Requests the parameters be streamed from the vehicle with PARAM_REQUEST_LIST
+void ParameterManager::_requestParamList(uint8_t componentId)
+{
+    WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
+
+    if (weakLink.expired()) {
+        return;
     }
 
     if (!_initialLoadComplete) {
@@ -480,6 +715,7 @@ void ParameterManager::refreshAllParameters(uint8_t componentId)
     mavlink_message_t       msg;
     SharedLinkInterfacePtr  sharedLink = weakLink.lock();
 
+    _paramListRequestMsecs = _syncTimer.elapsed();
     mavlink_msg_param_request_list_pack_chan(mavlink->getSystemId(),
                                              mavlink->getComponentId(),
                                              sharedLink->mavlinkChannel(),
@@ -492,6 +728,193 @@ void ParameterManager::refreshAllParameters(uint8_t componentId)
     qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Request to refresh all parameters for component ID:" << what;
 }
 
+/// Starts reading the autopilot parameters as a single MAVLink FTP file download if the firmware supports that.
+/// Parameters of other components are not part of the packed file, they are only loaded by PARAM_REQUEST_LIST.
+/// @return true: download started, false: parameters must be requested with PARAM_REQUEST_LIST
+bool ParameterManager::_ftpParamLoadBegin(void)
+{
+    QString ftpFile = _vehicle->firmwarePlugin()->parameterFtpFile();
+    if (ftpFile.isEmpty()) {
+        return false;
+    }
+
+    delete _ftpParamDir;
+    _ftpParamDir = new QTemporaryDir();
+    if (!_ftpParamDir->isValid()) {
+        qCWarning(ParameterManagerLog) << _logVehiclePrefix(-1) << "_ftpParamLoadBegin unable to create download directory";
+        delete _ftpParamDir;
+        _ftpParamDir = nullptr;
+        return false;
+    }
+
+    FTPManager* ftpManager = _vehicle->ftpManager();
+    connect(ftpManager, &FTPManager::downloadComplete,  this, &ParameterManager::_ftpParamLoadComplete);
+    connect(ftpManager, &FTPManager::commandProgress,   this, &ParameterManager::_ftpParamLoadProgress);
+    if (!ftpManager->download(ftpFile, _ftpParamDir->path())) {
+        // FTPManager is busy with something else
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "_ftpParamLoadBegin FTP download could not be started, using PARAM_REQUEST_LIST";
+        ftpManager->disconnect(this);
+        delete _ftpParamDir;
+        _ftpParamDir = nullptr;
+        return false;
+    }
+
+    qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "_ftpParamLoadBegin reading" << ftpFile;
+    return true;
+}
+
+void ParameterManager::_ftpParamLoadProgress(int value)
+{
+    _setLoadProgress(value / 100.0);
+}
+
+void ParameterManager::_ftpParamLoadComplete(const QString& file, const QString& errorMsg)
+{
+    if (!_ftpParamDir || !file.startsWith(_ftpParamDir->path())) {
+        return;
+    }
+
+    _vehicle->ftpManager()->disconnect(this);
+
+    bool success = errorMsg.isEmpty() && _loadFtpParamFile(file);
+
+    delete _ftpParamDir;
+    _ftpParamDir = nullptr;
+
+    if (!success) {
+        // Older firmware has no @PARAM directory
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "_ftpParamLoadComplete FTP read failed, using PARAM_REQUEST_LIST:" << errorMsg;
+        _setLoadProgress(0.0);
+        _requestParamList(MAV_COMP_ID_ALL);
+    }
+}
+
+/// Decodes a parameter file in the ArduPilot param.pck format and hands each parameter to _handleParamValue
+/// the same way as a PARAM_VALUE, so the wait lists and initial load completion work as with streamed parameters.
+///
+/// Header: uint16 magic, uint16 parameter count, uint16 total parameter count. Parameters follow, each optionally preceded
+/// by zero padding bytes:
+///     uint8   type in the low nibble, flags in the high nibble
+///     uint8   length of the name prefix shared with the previous parameter in the low nibble, suffix length - 1 in the high nibble
+///     name suffix, little endian value, little endian default value if the defaults flag is set
+/// @return false: file is not a complete parameter pack, no parameters were updated
+bool ParameterManager::_loadFtpParamFile(const QString& filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCDebug(ParameterManagerLog) << "_loadFtpParamFile open failed" << file.errorString();
+        return false;
+    }
+    QByteArray bytes = file.readAll();
+
+    if (bytes.size() < _paramPackHeaderSize) {
+        qCDebug(ParameterManagerLog) << "_loadFtpParamFile file too short" << bytes.size();
+        return false;
+    }
+    const uchar*    data            = reinterpret_cast<const uchar*>(bytes.constData());
+    int             size            = bytes.size();
+    uint16_t        magic           = qFromLittleEndian<quint16>(data);
+    uint16_t        paramCount      = qFromLittleEndian<quint16>(data + 2);
+    uint16_t        totalParamCount = qFromLittleEndian<quint16>(data + 4);
+
+    if ((magic != _paramPackMagic && magic != _paramPackWithDefaultsMagic) || paramCount != totalParamCount) {
+        qCDebug(ParameterManagerLog) << "_loadFtpParamFile invalid header magic:count:totalCount" << magic << paramCount << totalParamCount;
+        return false;
+    }
+    bool withDefaults = magic == _paramPackWithDefaultsMagic;
+
+    typedef struct {
+        QString         name;
+        MAV_PARAM_TYPE  mavParamType;
+        QVariant        value;
+    } PackedParam_t;
+
+    // Decode everything before touching any fact so a damaged file can fall back to streaming cleanly
+    QList<PackedParam_t>    rgParams;
+    QByteArray              name;
+    int                     offset = _paramPackHeaderSize;
+    while (rgParams.count() < paramCount) {
+        while (offset < size && data[offset] == 0) {
+            offset++;
+        }
+        if (offset + 2 > size) {
+            qCDebug(ParameterManagerLog) << "_loadFtpParamFile truncated after parameter" << rgParams.count();
+            return false;
+        }
+
+        int typeCode        = data[offset] & 0x0F;
+        int flags           = data[offset] >> 4;
+        int commonLength    = data[offset + 1] & 0x0F;
+        int suffixLength    = (data[offset + 1] >> 4) + 1;
+        offset += 2;
+
+        PackedParam_t   param;
+        int             valueSize;
+        switch (typeCode) {
+        case 1:
+            param.mavParamType  = MAV_PARAM_TYPE_INT8;
+            valueSize           = 1;
+            break;
+        case 2:
+            param.mavParamType  = MAV_PARAM_TYPE_INT16;
+            valueSize           = 2;
+            break;
+        case 3:
+            param.mavParamType  = MAV_PARAM_TYPE_INT32;
+            valueSize           = 4;
+            break;
+        case 4:
+            param.mavParamType  = MAV_PARAM_TYPE_REAL32;
+            valueSize           = 4;
+            break;
+        default:
+            qCDebug(ParameterManagerLog) << "_loadFtpParamFile unknown parameter type" << typeCode;
+            return false;
+        }
+        int defaultSize = withDefaults && (flags & 1) ? valueSize : 0;
+
+        if (commonLength > name.size() || offset + suffixLength + valueSize + defaultSize > size) {
+            qCDebug(ParameterManagerLog) << "_loadFtpParamFile bad parameter entry" << rgParams.count();
+            return false;
+        }
+        name = name.left(commonLength) + QByteArray(reinterpret_cast<const char*>(data + offset), suffixLength);
+        offset += suffixLength;
+
+        const uchar* valueData = data + offset;
+        switch (param.mavParamType) {
+        case MAV_PARAM_TYPE_INT8:
+            param.value = QVariant(static_cast<qint8>(valueData[0]));
+            break;
+        case MAV_PARAM_TYPE_INT16:
+            param.value = QVariant(qFromLittleEndian<qint16>(valueData));
+            break;
+        case MAV_PARAM_TYPE_INT32:
+            param.value = QVariant(qFromLittleEndian<qint32>(valueData));
+            break;
+        default:
+        {
+            quint32 floatBits = qFromLittleEndian<quint32>(valueData);
+            float   floatValue;
+            memcpy(&floatValue, &floatBits, sizeof(floatValue));
+            param.value = QVariant(floatValue);
+            break;
+        }
+        }
+        offset += valueSize + defaultSize;
+
+        param.name = QString::fromLatin1(name);
+        rgParams.append(param);
+    }
+
+    qCDebug(ParameterManagerLog) << _logVehiclePrefix(MAV_COMP_ID_AUTOPILOT1) << "_loadFtpParamFile loaded" << rgParams.count() << "parameters";
+    for (int i=0; i<rgParams.count(); i++) {
+        const PackedParam_t& param = rgParams[i];
+        _handleParamValue(MAV_COMP_ID_AUTOPILOT1, param.name, paramCount, i, param.mavParamType, param.value);
+    }
+
+    return true;
+}
+
 /// Translates FactSystem::defaultComponentId to real component id if needed
 int ParameterManager::_actualComponentId(int componentId)
 {
@@ -546,9 +969,7 @@ bool ParameterManager::parameterExists(int componentId, const QString& paramName
     bool ret = false;
 
     componentId = _actualComponentId(componentId);
-    if (_mapCompId2FactMap.contains(componentId)) {
-        ret = _mapCompId2FactMap[componentId].contains(_remapParamNameToVersion(paramName));
-    }
+    ret = _findFact(componentId, _remapParamNameToVersion(paramName)) != nullptr;
 
     return ret;
 }
@@ -558,19 +979,38 @@ Fact* ParameterManager::getParameter(int componentId, const QString& paramName)
     componentId = _actualComponentId(componentId);
 
     QString mappedParamName = _remapParamNameToVersion(paramName);
-    if (!_mapCompId2FactMap.contains(componentId) || !_mapCompId2FactMap[componentId].contains(mappedParamName)) {
+    Fact*   fact            = _findFact(componentId, mappedParamName);
+    if (!fact) {
         qgcApp()->reportMissingParameter(componentId, mappedParamName);
         return &_defaultFact;
     }
 
-    return _mapCompId2FactMap[componentId][mappedParamName];
+    return fact;
+}
+
+Fact* ParameterManager::_findFact(int componentId, const QString& paramName) const
+{
+    auto compIter = _hashCompId2FactMap.constFind(componentId);
+    if (compIter == _hashCompId2FactMap.constEnd()) {
+        return nullptr;
+    }
+    return compIter->value(paramName, nullptr);
+}
+
+/// Adds a new fact to the lookup structures. The fact's own name is used as the key so all of them share one copy of it.
+void ParameterManager::_addFact(Fact* fact)
+{
+    const QString& name = fact->name();
+
+    _mapCompId2FactMap[fact->componentId()][name] = fact;
+    _hashCompId2FactMap[fact->componentId()][name] = fact;
 }
 
 QStringList ParameterManager::parameterNames(int componentId)
 {
     QStringList names;
 
-    for(const QString &paramName: _mapCompId2FactMap[_actualComponentId(componentId)].keys()) {
+    for(const QString &paramName: _mapCompId2FactMap.value(_actualComponentId(componentId)).keys()) {
         names << paramName;
     }
 
@@ -586,7 +1026,7 @@ bool ParameterManager::_fillIndexBatchQueue(bool waitingParamTimeout)
         return false;
     }
 
-    const int maxBatchSize = 10;
+    const int maxBatchSize = paramRetryBatchSize();
 
     if (waitingParamTimeout) {
         // We timed out, clear the queue and try again
@@ -613,6 +1053,9 @@ bool ParameterManager::_fillIndexBatchQueue(bool waitingParamTimeout)
             }
 
             _waitingReadParamIndexMap[componentId][paramIndex]++;   // Bump retry count
+            if (_waitingReadParamIndexMap[componentId][paramIndex] > 1) {
+                _paramRetryCount++;
+            }
             if (_disableAllRetries || _waitingReadParamIndexMap[componentId][paramIndex] > _maxInitialLoadRetrySingleParam) {
                 // Give up on this index
                 _failedReadParamIndexMap[componentId] << paramIndex;
@@ -637,7 +1080,7 @@ void ParameterManager::_waitingParamTimeout(void)
     }
 
     bool paramsRequested = false;
-    const int maxBatchSize = 10;
+    const int maxBatchSize = paramRetryBatchSize();
     int batchCount = 0;
 
     qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "_waitingParamTimeout";
@@ -666,8 +1109,15 @@ void ParameterManager::_waitingParamTimeout(void)
                 paramsRequested = true;
                 _waitingWriteParamNameMap[componentId][paramName]++;   // Bump retry count
                 if (_waitingWriteParamNameMap[componentId][paramName] <= _maxReadWriteRetry) {
-                    Fact* fact = getParameter(componentId, paramName);
-                    _sendParamSetToVehicle(componentId, paramName, fact->type(), fact->rawValue());
+                    _paramRetryCount++;
+                    if (_paramWriteMap[componentId].contains(paramName)) {
+                        // Batched writes don't update the fact until the echo, so send the value from the batch
+                        const ParamWrite_t& paramWrite = _paramWriteMap[componentId][paramName];
+                        _sendParamSetToVehicle(componentId, paramName, paramWrite.valueType, paramWrite.rawValue);
+                    } else {
+                        Fact* fact = getParameter(componentId, paramName);
+                        _sendParamSetToVehicle(componentId, paramName, fact->type(), fact->rawValue());
+                    }
                     qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Write resend for (paramName:" << paramName << "retryCount:" << _waitingWriteParamNameMap[componentId][paramName] << ")";
                     if (++batchCount > maxBatchSize) {
                         goto Out;
@@ -675,6 +1125,9 @@ void ParameterManager::_waitingParamTimeout(void)
                 } else {
                     // Exceeded max retry count, notify user
                     _waitingWriteParamNameMap[componentId].remove(paramName);
+                    if (_paramWriteMap[componentId].remove(paramName)) {
+                        _paramWriteFailedCount++;
+                    }
                     QString errorMsg = tr("Parameter write failed: veh:%1 comp:%2 param:%3").arg(_vehicle->id()).arg(componentId).arg(paramName);
                     qCDebug(ParameterManagerLog) << errorMsg;
                     qgcApp()->showAppMessage(errorMsg);
@@ -689,6 +1142,7 @@ void ParameterManager::_waitingParamTimeout(void)
                 paramsRequested = true;
                 _waitingReadParamNameMap[componentId][paramName]++;   // Bump retry count
                 if (_waitingReadParamNameMap[componentId][paramName] <= _maxReadWriteRetry) {
+                    _paramRetryCount++;
                     _readParameterRaw(componentId, paramName, -1);
                     qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Read re-request for (paramName:" << paramName << "retryCount:" << _waitingReadParamNameMap[componentId][paramName] << ")";
                     if (++batchCount > maxBatchSize) {
@@ -706,10 +1160,49 @@ void ParameterManager::_waitingParamTimeout(void)
     }
 
 Out:
+    // Write failures free up space in the window
+    _sendQueuedParamWrites();
+
     if (paramsRequested) {
-        qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Restarting _waitingParamTimeoutTimer - re-request";
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Restarting _waitingParamTimeoutTimer - re-request" << "timeout:batch" << _waitingParamTimeoutTimer.interval() << maxBatchSize;
         _waitingParamTimeoutTimer.start();
     }
+    emit syncStatsChanged();
+}
+
+/// @return Number of re-requests sent per cycle. Fewer are sent as loss goes up so they don't crowd out the responses on a
+/// saturated link, down to one at 50% loss.
+int ParameterManager::paramRetryBatchSize(void) const
+{
+    float lossPercent = qBound(0.0f, _vehicle->mavlinkLossPercent(), 50.0f);
+    return qMax(1, qRound(_maxRetryBatchSize * (1.0f - (lossPercent / 50.0f))));
+}
+
+/// Updates the smoothed request round trip and the re-request timeout from it (RFC 6298 style)
+void ParameterManager::_sampleRoundTrip(qint64 sentMsecs)
+{
+    double sample = static_cast<double>(_syncTimer.elapsed() - sentMsecs);
+
+    if (_roundTripMsecs < 0) {
+        _roundTripMsecs     = sample;
+        _roundTripVarMsecs  = sample / 2.0;
+    } else {
+        _roundTripVarMsecs  = (0.75 * _roundTripVarMsecs) + (0.25 * qAbs(_roundTripMsecs - sample));
+        _roundTripMsecs     = (0.875 * _roundTripMsecs) + (0.125 * sample);
+    }
+
+    int timeout = qBound(static_cast<int>(_minWaitingParamTimeoutMsecs),
+                         qRound(_roundTripMsecs + (4.0 * _roundTripVarMsecs)),
+                         static_cast<int>(_maxWaitingParamTimeoutMsecs));
+    if (!_initialLoadComplete && !_indexBatchQueueActive) {
+        // The initial stream is paced by the vehicle, not by the round trip. Only allow waiting longer than the default for gaps in it.
+        timeout = qMax(timeout, static_cast<int>(_defaultWaitingParamTimeoutMsecs));
+    }
+    if (timeout != _waitingParamTimeoutTimer.interval()) {
+        qCDebug(ParameterManagerVerbose1Log) << _logVehiclePrefix(-1) << "Re-request timeout:roundTrip" << timeout << _roundTripMsecs;
+        _waitingParamTimeoutTimer.setInterval(timeout);
+    }
+    emit syncStatsChanged();
 }
 
 void ParameterManager::_readParameterRaw(int componentId, const QString& paramName, int paramIndex)
@@ -720,6 +1213,12 @@ void ParameterManager::_readParameterRaw(int componentId, const QString& paramNa
         char                    fixedParamName[MAVLINK_MSG_PARAM_REQUEST_READ_FIELD_PARAM_ID_LEN];
         SharedLinkInterfacePtr  sharedLink = weakLink.lock();
 
+        _paramRequestCount++;
+        if (paramIndex >= 0) {
+            _indexRequestTimeMap[componentId][paramIndex] = _syncTimer.elapsed();
+        } else {
+            _nameRequestTimeMap[componentId][paramName] = _syncTimer.elapsed();
+        }
 
         strncpy(fixedParamName, paramName.toStdString().c_str(), sizeof(fixedParamName));
         mavlink_msg_param_request_read_pack_chan(_mavlink->getSystemId(),   // QGC system id
@@ -743,6 +1242,9 @@ void ParameterManager::_sendParamSetToVehicle(int componentId, const QString& pa
         mavlink_param_union_t   union_value;
         SharedLinkInterfacePtr  sharedLink = weakLink.lock();
 
+        _paramRequestCount++;
+        _nameRequestTimeMap[componentId][paramName] = _syncTimer.elapsed();
+
         memset(&p, 0, sizeof(p));
 
         p.param_type = factTypeToMavType(valueType);
@@ -797,20 +1299,87 @@ void ParameterManager::_sendParamSetToVehicle(int componentId, const QString& pa
     }
 }
 
+/// The cache file holds a header followed by the name, index, type and value of each parameter:
+///     quint32 magic, qint32 version, qint32 vehicle parameter count, CacheMapName2ParamIndexTypeVal
 void ParameterManager::_writeLocalParamCache(int vehicleId, int componentId)
 {
-    CacheMapName2ParamTypeVal cacheMap;
+    CacheMapName2ParamIndexTypeVal  cacheMap;
+    QHash<const Fact*, int>         factIndexMap;
+
+    const QVector<Fact*> indexFacts = _compId2IndexFactMap.value(componentId);
+    for (int index=0; index<indexFacts.count(); index++) {
+        if (indexFacts[index]) {
+            factIndexMap[indexFacts[index]] = index;
+        }
+    }
 
     for (const QString& paramName: _mapCompId2FactMap[componentId].keys()) {
         const Fact *fact = _mapCompId2FactMap[componentId][paramName];
-        cacheMap[paramName] = ParamTypeVal(fact->type(), fact->rawValue());
+        cacheMap[paramName] = ParamIndexTypeVal(factIndexMap.value(fact, -1), ParamTypeVal(fact->type(), fact->rawValue()));
     }
 
     QFile cacheFile(parameterCacheFile(vehicleId, componentId));
-    cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    if (!cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(ParameterManagerLog) << "Unable to write parameter cache" << cacheFile.fileName() << cacheFile.errorString();
+        return;
+    }
 
     QDataStream ds(&cacheFile);
-    ds << cacheMap;
+    ds << _cacheFileMagic << _cacheFileVersion << static_cast<qint32>(_paramCountMap.value(componentId, cacheMap.count())) << cacheMap;
+
+    // Superseded by the file just written
+    QFile::remove(_legacyParameterCacheFile(vehicleId, componentId));
+}
+
+/// Reads the cache for the specified component, falling back to the previous format which has no parameter indices.
+///     @param[out] cacheMap Cached parameters, index is -1 if not known
+///     @param[out] parameterCount Parameter count the vehicle reported when the cache was written
+/// @return false: No usable cache
+bool ParameterManager::_readLocalParamCache(int vehicleId, int componentId, CacheMapName2ParamIndexTypeVal& cacheMap, int& parameterCount)
+{
+    cacheMap.clear();
+    parameterCount = 0;
+
+    QFile cacheFile(parameterCacheFile(vehicleId, componentId));
+    if (cacheFile.open(QIODevice::ReadOnly)) {
+        QDataStream ds(&cacheFile);
+        quint32     magic   = 0;
+        qint32      version = 0;
+        qint32      count   = 0;
+
+        ds >> magic >> version >> count;
+        if (magic != _cacheFileMagic || version != _cacheFileVersion) {
+            qCDebug(ParameterManagerLog) << "Parameter cache has unknown format" << cacheFile.fileName() << magic << version;
+            return false;
+        }
+        ds >> cacheMap;
+        if (ds.status() != QDataStream::Ok) {
+            qCWarning(ParameterManagerLog) << "Parameter cache is corrupt" << cacheFile.fileName();
+            cacheMap.clear();
+            return false;
+        }
+        parameterCount = count;
+        return true;
+    }
+
+    QFile legacyCacheFile(_legacyParameterCacheFile(vehicleId, componentId));
+    if (!legacyCacheFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    CacheMapName2ParamTypeVal   legacyCacheMap;
+    QDataStream                 ds(&legacyCacheFile);
+
+    ds >> legacyCacheMap;
+    if (ds.status() != QDataStream::Ok) {
+        return false;
+    }
+    for (const QString& name: legacyCacheMap.keys()) {
+        cacheMap[name] = ParamIndexTypeVal(-1, legacyCacheMap[name]);
+    }
+    parameterCount = legacyCacheMap.count();
+
+    return true;
 }
 
 QDir ParameterManager::parameterCacheDir()
@@ -820,32 +1389,38 @@ QDir ParameterManager::parameterCacheDir()
 }
 
 QString ParameterManager::parameterCacheFile(int vehicleId, int componentId)
+{
+    return parameterCacheDir().filePath(QString("%1_%2.v3").arg(vehicleId).arg(componentId));
+}
+
+QString ParameterManager::_legacyParameterCacheFile(int vehicleId, int componentId)
 {
     return parameterCacheDir().filePath(QString("%1_%2.v2").arg(vehicleId).arg(componentId));
 }
 
-void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVariant hash_value)
+void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, int parameterCount, QVariant hash_value)
 {
     qCInfo(ParameterManagerLog) << "Attemping load from cache";
 
     uint32_t crc32_value = 0;
     /* The datastructure of the cache table */
-    CacheMapName2ParamTypeVal cacheMap;
-    QFile cacheFile(parameterCacheFile(vehicleId, componentId));
-    if (!cacheFile.exists()) {
+    CacheMapName2ParamIndexTypeVal  cacheMap;
+    int                             cacheParameterCount;
+    if (!_readLocalParamCache(vehicleId, componentId, cacheMap, cacheParameterCount)) {
         /* no local cache, just wait for them to come in*/
         return;
     }
-    cacheFile.open(QIODevice::ReadOnly);
 
-    /* Deserialize the parameter cache table */
-    QDataStream ds(&cacheFile);
-    ds >> cacheMap;
+    /* a different parameter count means a different parameter set, no need to compute the crc */
+    if (parameterCount > 0 && parameterCount != cacheParameterCount) {
+        qCInfo(ParameterManagerLog) << "Parameters cache count mismatch" << cacheParameterCount << parameterCount;
+        return;
+    }
 
     /* compute the crc of the local cache to check against the remote */
 
     for (const QString& name: cacheMap.keys()) {
-        const ParamTypeVal&             paramTypeVal    = cacheMap[name];
+        const ParamTypeVal&             paramTypeVal    = cacheMap[name].second;
         const FactMetaData::ValueType_t fact_type       = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
 
         if (_vehicle->compInfoManager()->compInfoParam(MAV_COMP_ID_AUTOPILOT1)->factMetaDataForName(name, fact_type)->volatileValue()) {
@@ -861,17 +1436,37 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVarian
 
     /* if the two param set hashes match, just load from the disk */
     if (crc32_value == hash_value.toUInt()) {
-        qCInfo(ParameterManagerLog) << "Parameters loaded from cache" << qPrintable(QFileInfo(cacheFile).absoluteFilePath());
+        qCInfo(ParameterManagerLog) << "Parameters loaded from cache" << qPrintable(parameterCacheFile(vehicleId, componentId));
 
-        int count = cacheMap.count();
-        int index = 0;
+        // Use the indices the vehicle reported if they are all known, otherwise fall back to name order
+        QMap<int, QString> index2NameMap;
         for (const QString& name: cacheMap.keys()) {
-            const ParamTypeVal& paramTypeVal = cacheMap[name];
-            const FactMetaData::ValueType_t fact_type = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
-            const MAV_PARAM_TYPE mavParamType = factTypeToMavType(fact_type);
-            _handleParamValue(componentId, name, count, index++, mavParamType, paramTypeVal.second);
+            int index = cacheMap[name].first;
+            if (index < 0 || index >= cacheParameterCount || index2NameMap.contains(index)) {
+                index2NameMap.clear();
+                break;
+            }
+            index2NameMap[index] = name;
+        }
+        if (index2NameMap.isEmpty()) {
+            cacheParameterCount = cacheMap.count();
+            int index = 0;
+            for (const QString& name: cacheMap.keys()) {
+                index2NameMap[index++] = name;
+            }
         }
 
+        // Any index missing from the cache is left on the wait list and requested through the index batch queue
+        _loadingFromCache = true;
+        for (int index: index2NameMap.keys()) {
+            const QString&                  name            = index2NameMap[index];
+            const ParamTypeVal&             paramTypeVal    = cacheMap[name].second;
+            const FactMetaData::ValueType_t fact_type       = static_cast<FactMetaData::ValueType_t>(paramTypeVal.first);
+            const MAV_PARAM_TYPE            mavParamType    = factTypeToMavType(fact_type);
+            _handleParamValue(componentId, name, cacheParameterCount, index, mavParamType, paramTypeVal.second);
+        }
+        _loadingFromCache = false;
+
         WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
 
         if (!weakLink.expired()) {
@@ -916,11 +1511,11 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVarian
 
         ani->start(QAbstractAnimation::DeleteWhenStopped);
     } else {
-        qCInfo(ParameterManagerLog) << "Parameters cache match failed" << qPrintable(QFileInfo(cacheFile).absoluteFilePath());
+        qCInfo(ParameterManagerLog) << "Parameters cache match failed" << qPrintable(parameterCacheFile(vehicleId, componentId));
         if (ParameterManagerDebugCacheFailureLog().isDebugEnabled()) {
             _debugCacheCRC[componentId] = true;
-            _debugCacheMap[componentId] = cacheMap;
             for (const QString& name: cacheMap.keys()) {
+                _debugCacheMap[componentId][name] = cacheMap[name].second;
                 _debugCacheParamSeen[componentId][name] = false;
             }
             qgcApp()->showAppMessage(tr("Parameter cache CRC match failed"));
@@ -928,6 +1523,45 @@ void ParameterManager::_tryCacheHashLoad(int vehicleId, int componentId, QVarian
     }
 }
 
+/// Creates the facts named in the cache, along with their metadata, ahead of the vehicle reporting them. Values always come
+/// from the vehicle, the cache is only used when the vehicle reports the same parameter count it did when the cache was written.
+void ParameterManager::_prefetchFromCache(int componentId, int parameterCount)
+{
+    CacheMapName2ParamIndexTypeVal  cacheMap;
+    int                             cacheParameterCount;
+
+    if (!_readLocalParamCache(_vehicle->id(), componentId, cacheMap, cacheParameterCount)) {
+        return;
+    }
+    if (cacheParameterCount != parameterCount) {
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Skipping cache prefetch due to parameter count mismatch" << cacheParameterCount << parameterCount;
+        return;
+    }
+
+    qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Prefetching facts from cache" << cacheMap.count();
+
+    CompInfoParam* compInfoParam = _vehicle->compInfoManager()->compInfoParam(componentId);
+    for (const QString& name: cacheMap.keys()) {
+        if (_findFact(componentId, name)) {
+            continue;
+        }
+        FactMetaData::ValueType_t   type = static_cast<FactMetaData::ValueType_t>(cacheMap[name].second.first);
+        Fact*                       fact = new Fact(componentId, name, type, this);
+        fact->setMetaData(compInfoParam->factMetaDataForName(name, type));
+        _prefetchFactMap[componentId][name] = fact;
+    }
+}
+
+void ParameterManager::_clearPrefetchFacts(void)
+{
+    for (int componentId: _prefetchFactMap.keys()) {
+        for (Fact* fact: _prefetchFactMap[componentId]) {
+            fact->deleteLater();
+        }
+    }
+    _prefetchFactMap.clear();
+}
+
 QString ParameterManager::readParametersFromStream(QTextStream& stream)
 {
     QString missingErrors;
@@ -1115,6 +1749,13 @@ void ParameterManager::_checkInitialLoadComplete(void)
     // We aren't waiting for any more initial parameter updates, initial parameter loading is complete
     _initialLoadComplete = true;
 
+    // Anything left over from the cache prefetch is no longer on the vehicle
+    _clearPrefetchFacts();
+
+    qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Sync stats - received:requests:retries:roundTrip:timeout"
+                                 << _paramReceivedCount << _paramRequestCount << _paramRetryCount << paramRoundTripMsecs() << paramRetryTimeoutMsecs();
+    emit syncStatsChanged();
+
     // Parameter cache crc failure debugging
     for (int componentId: _debugCacheParamSeen.keys()) {
         if (!_logReplay && _debugCacheCRC.contains(componentId) && _debugCacheCRC[componentId]) {
@@ -1157,18 +1798,54 @@ void ParameterManager::_checkInitialLoadComplete(void)
         }
     }
 
-    // Signal load complete
+    if (_metaDataPending) {
+        qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Waiting for parameter metadata before signalling parameters ready";
+    } else {
+        _signalParametersReady();
+    }
+}
+
+void ParameterManager::_signalParametersReady(void)
+{
     _parametersReady = true;
     _vehicle->autopilotPlugin()->parametersReadyPreChecks();
     emit parametersReadyChanged(true);
     emit missingParametersChanged(_missingParameters);
 }
 
+void ParameterManager::setMetaDataPending(bool metaDataPending)
+{
+    if (metaDataPending == _metaDataPending) {
+        return;
+    }
+    _metaDataPending = metaDataPending;
+    if (_metaDataPending) {
+        return;
+    }
+
+    // Facts created while the request was outstanding were given FirmwarePlugin metadata
+    _clearPrefetchFacts();
+    for (int componentId: _mapCompId2FactMap.keys()) {
+        CompInfoParam* compInfoParam = _vehicle->compInfoManager()->compInfoParam(componentId);
+        if (compInfoParam->jsonMetaDataAvailable()) {
+            qCDebug(ParameterManagerLog) << _logVehiclePrefix(componentId) << "Rebinding parameter metadata from component information";
+            for (Fact* fact: _mapCompId2FactMap[componentId]) {
+                fact->setMetaData(compInfoParam->factMetaDataForName(fact->name(), fact->type()));
+            }
+        }
+    }
+
+    if (_initialLoadComplete && !_parametersReady) {
+        _signalParametersReady();
+    }
+}
+
 void ParameterManager::_initialRequestTimeout(void)
 {
     if (!_disableAllRetries && ++_initialRequestRetryCount <= _maxInitialRequestListRetry) {
         qCDebug(ParameterManagerLog) << _logVehiclePrefix(-1) << "Retrying initial parameter request list";
-        refreshAllParameters();
+        _requestParamList(MAV_COMP_ID_ALL);
+        _paramListRequestMsecs = -1;
         _initialRequestTimeoutTimer.start();
     } else {
         if (!_vehicle->genericFirmware()) {
@@ -1294,7 +1971,7 @@ void ParameterManager::_loadOfflineEditingParams(void)
         FactMetaData* factMetaData = _vehicle->compInfoManager()->compInfoParam(defaultComponentId)->factMetaDataForName(paramName, fact->type());
         fact->setMetaData(factMetaData);
 
-        _mapCompId2FactMap[defaultComponentId][paramName] = fact;
+        _addFact(fact);
     }
 
     _parametersReady = true;
@@ -1344,6 +2021,9 @@ QList<int> ParameterManager::componentIds(void)
 
 bool ParameterManager::pendingWrites(void)
 {
+    if (!_paramWriteQueue.isEmpty()) {
+        return true;
+    }
     for (int compId: _waitingWriteParamNameMap.keys()) {
         if (_waitingWriteParamNameMap[compId].count()) {
             return true;
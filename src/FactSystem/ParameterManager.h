@@ -11,17 +11,22 @@
 
 #include <QObject>
 #include <QMap>
+#include <QHash>
+#include <QVector>
 #include <QXmlStreamReader>
 #include <QLoggingCategory>
 #include <QMutex>
 #include <QDir>
 #include <QJsonObject>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
 
 #include "FactSystem.h"
 #include "MAVLinkProtocol.h"
 #include "AutoPilotPlugin.h"
 #include "QGCMAVLink.h"
 #include "Vehicle.h"
+#include "QGCTimerWheel.h"
 
 Q_DECLARE_LOGGING_CATEGORY(ParameterManagerVerbose1Log)
 Q_DECLARE_LOGGING_CATEGORY(ParameterManagerVerbose2Log)
@@ -38,26 +43,77 @@ class ParameterManager : public QObject
 public:
     /// @param uas Uas which this set of facts is associated with
     ParameterManager(Vehicle* vehicle);
+    ~ParameterManager();
 
     Q_PROPERTY(bool     parametersReady     READ parametersReady    NOTIFY parametersReadyChanged)      ///< true: Parameters are ready for use
     Q_PROPERTY(bool     missingParameters   READ missingParameters  NOTIFY missingParametersChanged)    ///< true: Parameters are missing from firmware response, false: all parameters received from firmware
     Q_PROPERTY(double   loadProgress        READ loadProgress       NOTIFY loadProgressChanged)
     Q_PROPERTY(bool     pendingWrites       READ pendingWrites      NOTIFY pendingWritesChanged)        ///< true: There are still pending write updates against the vehicle
 
+    // Parameter sync statistics, updated after each re-request cycle and when the initial load completes
+    Q_PROPERTY(int      paramRequestCount       READ paramRequestCount      NOTIFY syncStatsChanged)    ///< Single parameter reads and writes sent to the vehicle
+    Q_PROPERTY(int      paramRetryCount         READ paramRetryCount        NOTIFY syncStatsChanged)    ///< Reads and writes which had to be sent again
+    Q_PROPERTY(int      paramReceivedCount      READ paramReceivedCount     NOTIFY syncStatsChanged)    ///< Parameter values received from the vehicle
+    Q_PROPERTY(int      paramRoundTripMsecs     READ paramRoundTripMsecs    NOTIFY syncStatsChanged)    ///< Smoothed request round trip, -1 until measured
+    Q_PROPERTY(int      paramRetryTimeoutMsecs  READ paramRetryTimeoutMsecs NOTIFY syncStatsChanged)    ///< Current wait before re-requesting
+    Q_PROPERTY(int      paramRetryBatchSize     READ paramRetryBatchSize    NOTIFY syncStatsChanged)    ///< Current number of re-requests sent per cycle
+
+    // Batched writes through writeParameters
+    Q_PROPERTY(int      paramWriteWindowSize    READ paramWriteWindowSize   WRITE setParamWriteWindowSize   NOTIFY syncStatsChanged)    ///< Maximum number of PARAM_SETs awaiting their echo
+    Q_PROPERTY(int      paramWriteTotalCount    READ paramWriteTotalCount   NOTIFY syncStatsChanged)    ///< Writes in the current batch
+    Q_PROPERTY(int      paramWriteCompleteCount READ paramWriteCompleteCount NOTIFY syncStatsChanged)   ///< Writes verified by the PARAM_VALUE echo
+    Q_PROPERTY(int      paramWriteFailedCount   READ paramWriteFailedCount  NOTIFY syncStatsChanged)    ///< Writes which failed after all retries
+    Q_PROPERTY(double   paramWriteProgress      READ paramWriteProgress     NOTIFY syncStatsChanged)    ///< 0.0 to 1.0 through the current batch
+    Q_PROPERTY(double   paramWritesPerSecond    READ paramWritesPerSecond   NOTIFY syncStatsChanged)    ///< Verified writes per second for the current batch
+
     bool parametersReady    (void) const { return _parametersReady; }
     bool missingParameters  (void) const { return _missingParameters; }
     double loadProgress     (void) const { return _loadProgress; }
 
+    int paramRequestCount       (void) const { return _paramRequestCount; }
+    int paramRetryCount         (void) const { return _paramRetryCount; }
+    int paramReceivedCount      (void) const { return _paramReceivedCount; }
+    int paramRoundTripMsecs     (void) const { return _roundTripMsecs < 0 ? -1 : qRound(_roundTripMsecs); }
+    int paramRetryTimeoutMsecs  (void) const { return _waitingParamTimeoutTimer.interval(); }
+    int paramRetryBatchSize     (void) const;
+
+    int     paramWriteWindowSize    (void) const { return _paramWriteWindowSize; }
+    int     paramWriteTotalCount    (void) const { return _paramWriteTotalCount; }
+    int     paramWriteCompleteCount (void) const { return _paramWriteCompleteCount; }
+    int     paramWriteFailedCount   (void) const { return _paramWriteFailedCount; }
+    double  paramWriteProgress      (void) const;
+    double  paramWritesPerSecond    (void) const;
+    void    setParamWriteWindowSize (int windowSize);
+
+    typedef struct {
+        int                         componentId;
+        QString                     name;
+        FactMetaData::ValueType_t   valueType;
+        QVariant                    rawValue;
+        int                         retryCount;     ///< Times the echo did not match
+    } ParamWrite_t;
+
+    /// Writes a set of parameter values to the vehicle. Values which already match the current value are skipped. The rest
+    /// are pipelined with up to paramWriteWindowSize PARAM_SETs outstanding. Each write is verified against the PARAM_VALUE
+    /// echo and only those which time out or echo a different value are sent again. Fact values are updated from the echo.
+    /// @return Number of writes queued
+    int writeParameters(const QList<ParamWrite_t>& rgWrites);
+
     /// @return Directory of parameter caches
     static QDir parameterCacheDir();
 
     /// @return Location of parameter cache file
     static QString parameterCacheFile(int vehicleId, int componentId);
 
-    void mavlinkMessageReceived(mavlink_message_t message);
+    void mavlinkMessageReceived(const mavlink_message_t& message);
 
     QList<int> componentIds(void);
 
+    /// Set while parameter metadata is still being requested from the vehicle in parallel with the parameter download.
+    /// Parameters which arrive in the meantime use the FirmwarePlugin metadata and are rebound once the request completes.
+    /// Parameters are not signalled as ready until then.
+    void setMetaDataPending(bool metaDataPending);
+
     /// Re-request the full set of parameters from the autopilot
     void refreshAllParameters(uint8_t componentID = MAV_COMP_ID_ALL);
 
@@ -102,13 +158,23 @@ signals:
     void loadProgressChanged        (float value);
     void pendingWritesChanged       (bool pendingWrites);
     void factAdded                  (int componentId, Fact* fact);
+    void syncStatsChanged           (void);
 
 private slots:
     void    _factRawValueUpdated                (const QVariant& rawValue);
+    void    _ftpParamLoadProgress               (int value);
+    void    _ftpParamLoadComplete               (const QString& file, const QString& errorMsg);
 
 private:
     void    _handleParamValue                   (int componentId, QString parameterName, int parameterCount, int parameterIndex, MAV_PARAM_TYPE mavParamType, QVariant parameterValue);
+    void    _requestParamList                   (uint8_t componentId);
+    bool    _ftpParamLoadBegin                  (void);
+    bool    _loadFtpParamFile                   (const QString& filename);
     void    _factRawValueUpdateWorker           (int componentId, const QString& name, FactMetaData::ValueType_t valueType, const QVariant& rawValue);
+    void    _sendQueuedParamWrites              (void);
+    int     _outstandingParamWriteCount         (void) const;
+    void    _cancelParamWrite                   (int componentId, const QString& name);
+    static bool _rawValuesEqual                 (FactMetaData::ValueType_t valueType, const QVariant& rawValue1, const QVariant& rawValue2);
     void    _waitingParamTimeout                (void);
     void    _tryCacheLookup                     (void);
     void    _initialRequestTimeout              (void);
@@ -116,7 +182,9 @@ private:
     void    _readParameterRaw                   (int componentId, const QString& paramName, int paramIndex);
     void    _sendParamSetToVehicle              (int componentId, const QString& paramName, FactMetaData::ValueType_t valueType, const QVariant& value);
     void    _writeLocalParamCache               (int vehicleId, int componentId);
-    void    _tryCacheHashLoad                   (int vehicleId, int componentId, QVariant hash_value);
+    void    _tryCacheHashLoad                   (int vehicleId, int componentId, int parameterCount, QVariant hash_value);
+    void    _prefetchFromCache                  (int componentId, int parameterCount);
+    void    _clearPrefetchFacts                 (void);
     void    _loadMetaData                       (void);
     void    _clearMetaData                      (void);
     QString _remapParamNameToVersion            (const QString& paramName);
@@ -126,13 +194,19 @@ private:
     bool    _fillIndexBatchQueue                (bool waitingParamTimeout);
     void    _updateProgressBar                  (void);
     void    _checkInitialLoadComplete           (void);
+    void    _signalParametersReady              (void);
+    void    _sampleRoundTrip                    (qint64 sentMsecs);
+    Fact*   _findFact                           (int componentId, const QString& paramName) const;
+    void    _addFact                            (Fact* fact);
 
     static QVariant _stringToTypedVariant(const QString& string, FactMetaData::ValueType_t type, bool failOk = false);
 
     Vehicle*            _vehicle;
     MAVLinkProtocol*    _mavlink;
 
-    QMap<int /* comp id */, QMap<QString /* parameter name */, Fact*>> _mapCompId2FactMap;
+    QMap<int /* comp id */, QMap<QString /* parameter name */, Fact*>>     _mapCompId2FactMap;     ///< Ordered by name, used for iteration
+    QHash<int /* comp id */, QHash<QString /* parameter name */, Fact*>>   _hashCompId2FactMap;    ///< Same facts keyed by Fact::name, used for lookups, see _findFact
+    QHash<int /* comp id */, QVector<Fact*>>                               _compId2IndexFactMap;   ///< Fact at each parameter index the vehicle reported, nullptr until seen
 
     double      _loadProgress;                  ///< Parameter load progess, [0.0,1.0]
     bool        _parametersReady;               ///< true: parameter load complete
@@ -142,13 +216,22 @@ private:
     bool        _saveRequired;                  ///< true: _saveToEEPROM should be called
     bool        _metaDataAddedToFacts;          ///< true: FactMetaData has been adde to the default component facts
     bool        _logReplay;                     ///< true: running with log replay link
+    bool        _metaDataPending = false;       ///< true: parameter metadata is still being requested, see setMetaDataPending
 
     typedef QPair<int /* FactMetaData::ValueType_t */, QVariant /* Fact::rawValue */> ParamTypeVal;
     typedef QMap<QString /* parameter name */, ParamTypeVal> CacheMapName2ParamTypeVal;
+    typedef QPair<int /* parameter index */, ParamTypeVal> ParamIndexTypeVal;
+    typedef QMap<QString /* parameter name */, ParamIndexTypeVal> CacheMapName2ParamIndexTypeVal;
+
+    bool    _readLocalParamCache                (int vehicleId, int componentId, CacheMapName2ParamIndexTypeVal& cacheMap, int& parameterCount);
+
+    static QString _legacyParameterCacheFile    (int vehicleId, int componentId);
 
     QMap<int /* component id */, bool>                                              _debugCacheCRC; ///< true: debug cache crc failure
     QMap<int /* component id */, CacheMapName2ParamTypeVal>                         _debugCacheMap;
     QMap<int /* component id */, QMap<QString /* param name */, bool /* seen */>>   _debugCacheParamSeen;
+    QMap<int /* component id */, QMap<QString /* param name */, Fact*>>             _prefetchFactMap;       ///< Facts created from the cache before the vehicle reports them, see _prefetchFromCache
+    bool                                                                            _loadingFromCache = false;
 
     // Wait counts from previous parameter update cycle
     int _prevWaitingReadParamIndexCount;
@@ -163,6 +246,12 @@ private:
     int                 _initialRequestRetryCount;              ///< Current retry count for request list
     static const int    _maxInitialLoadRetrySingleParam = 5;    ///< Maximum retries for initial index based load of a single param
     static const int    _maxReadWriteRetry = 5;                 ///< Maximum retries read/write
+    static const int    _maxRetryBatchSize = 10;                ///< Re-requests sent per cycle on a loss free link
+    static const int    _defaultParamWriteWindowSize = 8;       ///< Outstanding batched writes
+    static const int    _defaultWaitingParamTimeoutMsecs = 3000;///< Re-request wait until a round trip has been measured
+    static const int    _minWaitingParamTimeoutMsecs = 1000;
+    static const int    _maxWaitingParamTimeoutMsecs = 10000;
+    static const int    _verboseLogIntervalMsecs = 1000;        ///< Rate limit for the wait list logging done for every received param
     bool                _disableAllRetries;                     ///< true: Don't retry any requests (used for testing)
 
     bool        _indexBatchQueueActive; ///< true: we are actively batching re-requests for missing index base params, false: index based re-request has not yet started
@@ -178,8 +267,29 @@ private:
     int _waitingWriteParamBatchCount = 0;       ///< Number of parameters which are batched up waiting on write responses
     int _waitingReadParamNameBatchCount = 0;    ///< Number of parameters which are batched up waiting on read responses
 
-    QTimer _initialRequestTimeoutTimer;
-    QTimer _waitingParamTimeoutTimer;
+    QGCWheelTimer _initialRequestTimeoutTimer   { "ParameterManager" };
+    QGCWheelTimer _waitingParamTimeoutTimer     { "ParameterManager" };     ///< Restarted with each received parameter
+
+    QElapsedTimer                       _syncTimer;                     ///< Time base for request round trip measurement
+    QMap<int, QMap<int, qint64> >       _indexRequestTimeMap;           ///< Key: Component id, Value: Map { Key: parameter index requested, Value: _syncTimer msecs when sent }
+    QMap<int, QMap<QString, qint64> >   _nameRequestTimeMap;            ///< Key: Component id, Value: Map { Key: parameter name read or written, Value: _syncTimer msecs when sent }
+    qint64                              _paramListRequestMsecs  = -1;   ///< _syncTimer msecs of the first PARAM_REQUEST_LIST, -1 once answered or retried
+    double                              _roundTripMsecs         = -1;   ///< Smoothed round trip, -1 until measured
+    double                              _roundTripVarMsecs      = 0;    ///< Round trip variation
+    int                                 _paramRequestCount      = 0;
+    int                                 _paramRetryCount        = 0;
+    int                                 _paramReceivedCount     = 0;
+
+    QList<ParamWrite_t>                 _paramWriteQueue;               ///< Batched writes not sent yet
+    QMap<int, QMap<QString, ParamWrite_t> > _paramWriteMap;             ///< Key: Component id, Value: Map { Key: parameter name, Value: batched write awaiting echo }
+    QElapsedTimer                       _paramWriteTimer;               ///< Started with each new batch of writes
+    qint64                              _paramWriteLastMsecs    = 0;    ///< _paramWriteTimer msecs of the last verified write
+    int                                 _paramWriteWindowSize   = _defaultParamWriteWindowSize;
+    int                                 _paramWriteTotalCount   = 0;
+    int                                 _paramWriteCompleteCount = 0;
+    int                                 _paramWriteFailedCount  = 0;
+
+    QTemporaryDir* _ftpParamDir = nullptr;      ///< Download location while the packed parameter file is read over FTP
 
     Fact _defaultFact;   ///< Used to return default fact, when parameter not found
 
@@ -187,4 +297,11 @@ private:
     static const char* _jsonCompIdKey;
     static const char* _jsonParamNameKey;
     static const char* _jsonParamValueKey;
+
+    static const int        _paramPackHeaderSize        = 6;
+    static const uint16_t   _paramPackMagic             = 0x671b;
+    static const uint16_t   _paramPackWithDefaultsMagic = 0x671c;   ///< Each parameter may be followed by its default value
+
+    static const quint32    _cacheFileMagic             = 0x51474350;   ///< "QGCP"
+    static const qint32     _cacheFileVersion           = 3;
 };
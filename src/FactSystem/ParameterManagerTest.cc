@@ -12,6 +12,7 @@
 #include "MultiVehicleManager.h"
 #include "QGCApplication.h"
 #include "ParameterManager.h"
+#include "FTPManager.h"
 
 /// Test failure modes which should still lead to param load success
 void ParameterManagerTest::_noFailureWorker(MockConfiguration::FailureMode_t failureMode)
@@ -138,3 +139,154 @@ void ParameterManagerTest::_requestListMissingParamFail(void)
     // User should have been notified
     checkExpectedMessageBox();
 }
+
+// ArduPilot parameters are read as a single param.pck FTP download instead of being streamed
+void ParameterManagerTest::_ftpParamLoad(void)
+{
+    Q_ASSERT(!_mockLink);
+    _mockLink = MockLink::startAPMArduSubMockLink(false);
+
+    MultiVehicleManager* vehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+    QVERIFY(vehicleMgr);
+
+    // Wait for the Vehicle to get created
+    QSignalSpy spyVehicle(vehicleMgr, SIGNAL(activeVehicleAvailableChanged(bool)));
+    QCOMPARE(spyVehicle.wait(5000), true);
+
+    Vehicle* vehicle = vehicleMgr->activeVehicle();
+    QVERIFY(vehicle);
+
+    QSignalSpy spyDownload(vehicle->ftpManager(), &FTPManager::downloadComplete);
+    QSignalSpy spyParamsReady(vehicleMgr, SIGNAL(parameterReadyVehicleAvailableChanged(bool)));
+    QCOMPARE(spyParamsReady.wait(60000), true);
+
+    // Plan files are only read once parameters are ready, so the parameter pack is the first download
+    QVERIFY(spyDownload.count() >= 1);
+    QVERIFY(spyDownload[0][0].toString().endsWith(QStringLiteral("param.pck")));
+    QCOMPARE(spyDownload[0][1].toString(), QString());
+
+    // Sub mock link has 691 autopilot parameters of all four packed types
+    ParameterManager* paramMgr = vehicle->parameterManager();
+    QCOMPARE(paramMgr->missingParameters(), false);
+    QCOMPARE(paramMgr->parameterNames(MAV_COMP_ID_AUTOPILOT1).count(), 691);
+}
+
+// The parameter cache records the parameter count the vehicle reported along with each parameter
+void ParameterManagerTest::_paramCacheWrite(void)
+{
+    Q_ASSERT(!_mockLink);
+    _mockLink = MockLink::startPX4MockLink(false);
+
+    MultiVehicleManager* vehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+    QVERIFY(vehicleMgr);
+
+    QSignalSpy spyParamsReady(vehicleMgr, SIGNAL(parameterReadyVehicleAvailableChanged(bool)));
+    QCOMPARE(spyParamsReady.wait(60000), true);
+
+    Vehicle* vehicle = vehicleMgr->activeVehicle();
+    QVERIFY(vehicle);
+
+    QFile cacheFile(ParameterManager::parameterCacheFile(vehicle->id(), MAV_COMP_ID_AUTOPILOT1));
+    QVERIFY(cacheFile.open(QIODevice::ReadOnly));
+
+    QDataStream ds(&cacheFile);
+    quint32     magic;
+    qint32      version;
+    qint32      count;
+    ds >> magic >> version >> count;
+    QCOMPARE(magic, static_cast<quint32>(0x51474350));
+    QCOMPARE(version, 3);
+    QCOMPARE(count, vehicle->parameterManager()->parameterNames(MAV_COMP_ID_AUTOPILOT1).count());
+}
+
+// Parameters missing from the initial stream are re-requested, which feeds the round trip measurement
+void ParameterManagerTest::_syncStats(void)
+{
+    Q_ASSERT(!_mockLink);
+    _mockLink = MockLink::startPX4MockLink(false, MockConfiguration::FailMissingParamOnInitialReqest);
+
+    MultiVehicleManager* vehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+    QVERIFY(vehicleMgr);
+
+    QSignalSpy spyParamsReady(vehicleMgr, SIGNAL(parameterReadyVehicleAvailableChanged(bool)));
+    QCOMPARE(spyParamsReady.wait(60000), true);
+
+    Vehicle* vehicle = vehicleMgr->activeVehicle();
+    QVERIFY(vehicle);
+    ParameterManager* paramMgr = vehicle->parameterManager();
+
+    QVERIFY(paramMgr->paramReceivedCount() >= paramMgr->parameterNames(MAV_COMP_ID_AUTOPILOT1).count());
+    QVERIFY(paramMgr->paramRequestCount() > 0);
+    QVERIFY(paramMgr->paramRoundTripMsecs() >= 0);
+    QVERIFY(paramMgr->paramRetryTimeoutMsecs() >= 1000 && paramMgr->paramRetryTimeoutMsecs() <= 10000);
+
+    // MockLink does not drop messages
+    QCOMPARE(paramMgr->paramRetryBatchSize(), 10);
+}
+
+// Batched writes skip unchanged values and are verified against the vehicle echo
+void ParameterManagerTest::_writeParameters(void)
+{
+    Q_ASSERT(!_mockLink);
+    _mockLink = MockLink::startPX4MockLink(false);
+
+    MultiVehicleManager* vehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+    QVERIFY(vehicleMgr);
+
+    QSignalSpy spyParamsReady(vehicleMgr, SIGNAL(parameterReadyVehicleAvailableChanged(bool)));
+    QCOMPARE(spyParamsReady.wait(60000), true);
+
+    Vehicle* vehicle = vehicleMgr->activeVehicle();
+    QVERIFY(vehicle);
+    ParameterManager* paramMgr = vehicle->parameterManager();
+
+    // Smaller window than writes so the queue has to drain through it
+    paramMgr->setParamWriteWindowSize(2);
+    QCOMPARE(paramMgr->paramWriteWindowSize(), 2);
+
+    QMap<QString, QVariant> changedValues;
+    changedValues["COM_RC_LOSS_T"]      = 1.5;
+    changedValues["MIS_TAKEOFF_ALT"]    = 5.0;
+    changedValues["MPC_XY_VEL_MAX"]     = 8.0;
+    changedValues["RTL_RETURN_ALT"]     = 45.0;
+
+    QList<ParameterManager::ParamWrite_t> rgWrites;
+    for (const QString& name: changedValues.keys()) {
+        ParameterManager::ParamWrite_t paramWrite;
+        paramWrite.componentId  = MAV_COMP_ID_AUTOPILOT1;
+        paramWrite.name         = name;
+        paramWrite.valueType    = FactMetaData::valueTypeFloat;
+        paramWrite.rawValue     = changedValues[name];
+        paramWrite.retryCount   = 0;
+        rgWrites.append(paramWrite);
+    }
+
+    // Same value as the vehicle already has
+    Fact* unchangedFact = paramMgr->getParameter(MAV_COMP_ID_AUTOPILOT1, "SYS_AUTOSTART");
+    ParameterManager::ParamWrite_t unchangedWrite;
+    unchangedWrite.componentId  = MAV_COMP_ID_AUTOPILOT1;
+    unchangedWrite.name         = unchangedFact->name();
+    unchangedWrite.valueType    = unchangedFact->type();
+    unchangedWrite.rawValue     = unchangedFact->rawValue();
+    unchangedWrite.retryCount   = 0;
+    rgWrites.append(unchangedWrite);
+
+    QCOMPARE(paramMgr->writeParameters(rgWrites), changedValues.count());
+    QCOMPARE(paramMgr->paramWriteTotalCount(), changedValues.count());
+    QVERIFY(paramMgr->pendingWrites());
+
+    QElapsedTimer timer;
+    timer.start();
+    while (paramMgr->pendingWrites() && timer.elapsed() < 10000) {
+        QTest::qWait(50);
+    }
+    QVERIFY(!paramMgr->pendingWrites());
+
+    for (const QString& name: changedValues.keys()) {
+        QCOMPARE(paramMgr->getParameter(MAV_COMP_ID_AUTOPILOT1, name)->rawValue().toFloat(), changedValues[name].toFloat());
+    }
+    QCOMPARE(paramMgr->paramWriteCompleteCount(), changedValues.count());
+    QCOMPARE(paramMgr->paramWriteFailedCount(), 0);
+    QCOMPARE(paramMgr->paramWriteProgress(), 1.0);
+    QVERIFY(paramMgr->paramWritesPerSecond() > 0);
+}
@@ -25,6 +25,10 @@ private slots:
     void _requestListNoResponse(void);
     void _requestListMissingParamSuccess(void);
     void _requestListMissingParamFail(void);
+    void _ftpParamLoad(void);
+    void _paramCacheWrite(void);
+    void _syncStats(void);
+    void _writeParameters(void);
 
 private:
     void _noFailureWorker(MockConfiguration::FailureMode_t failureMode);
@@ -11,8 +11,7 @@
 #include "SettingsFact.h"
 #include "QGCCorePlugin.h"
 #include "QGCApplication.h"
-
-#include <QSettings>
+#include "SettingsStore.h"
 
 SettingsFact::SettingsFact(QObject* parent)
     : Fact(parent)
@@ -25,12 +24,6 @@ SettingsFact::SettingsFact(QString settingsGroup, FactMetaData* metaData, QObjec
     , _settingsGroup(settingsGroup)
     , _visible      (true)
 {
-    QSettings settings;
-
-    if (!_settingsGroup.isEmpty()) {
-        settings.beginGroup(_settingsGroup);
-    }
-
     // Allow core plugin a chance to override the default value
     _visible = qgcApp()->toolbox()->corePlugin()->adjustSettingMetaData(settingsGroup, *metaData);
     setMetaData(metaData);
@@ -44,11 +37,11 @@ SettingsFact::SettingsFact(QString settingsGroup, FactMetaData* metaData, QObjec
             if (_visible) {
                 QVariant typedValue;
                 QString errorString;
-                metaData->convertAndValidateRaw(settings.value(_name, rawDefaultValue), true /* conertOnly */, typedValue, errorString);
+                metaData->convertAndValidateRaw(qgcApp()->settingsStore()->value(_settingsGroup, _name, rawDefaultValue), true /* conertOnly */, typedValue, errorString);
                 _rawValue = typedValue;
             } else {
                 // Setting is not visible, force to default value always
-                settings.setValue(_name, rawDefaultValue);
+                qgcApp()->settingsStore()->setValue(_settingsGroup, _name, rawDefaultValue);
                 _rawValue = rawDefaultValue;
             }
         }
@@ -74,11 +67,5 @@ const SettingsFact& SettingsFact::operator=(const SettingsFact& other)
 
 void SettingsFact::_rawValueChanged(QVariant value)
 {
-    QSettings settings;
-
-    if (!_settingsGroup.isEmpty()) {
-        settings.beginGroup(_settingsGroup);
-    }
-
-    settings.setValue(_name, value);
+    qgcApp()->settingsStore()->setValue(_settingsGroup, _name, value);
 }
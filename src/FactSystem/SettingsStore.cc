@@ -0,0 +1,114 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "SettingsStore.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QSettings>
+#include <QThread>
+
+QGC_LOGGING_CATEGORY(SettingsStoreLog, "SettingsStoreLog")
+
+SettingsStore::SettingsStore(QObject* parent)
+    : QObject(parent)
+{
+    _flushTimer.setSingleShot(true);
+    _flushTimer.setInterval(flushDelayMSecs);
+    connect(&_flushTimer, &QTimer::timeout, this, &SettingsStore::flush);
+}
+
+SettingsStore::Group_t& SettingsStore::_group(const QString& group)
+{
+    auto it = _groups.find(group);
+    if (it != _groups.end()) {
+        return it.value();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QSettings   settings;
+    Group_t&    values = _groups[group];
+
+    if (!group.isEmpty()) {
+        settings.beginGroup(group);
+    }
+    for (const QString& key: settings.childKeys()) {
+        values[key] = settings.value(key);
+    }
+
+    qCDebug(SettingsStoreLog) << "Loaded group" << group << values.count() << "keys in" << timer.elapsed() << "msecs";
+    return values;
+}
+
+QVariant SettingsStore::value(const QString& group, const QString& key, const QVariant& defaultValue)
+{
+    Q_ASSERT(QThread::currentThread() == qApp->thread());
+
+    const Group_t& values = _group(group);
+
+    auto it = values.constFind(key);
+    return it == values.constEnd() ? defaultValue : it.value();
+}
+
+void SettingsStore::setValue(const QString& group, const QString& key, const QVariant& value)
+{
+    Q_ASSERT(QThread::currentThread() == qApp->thread());
+
+    Group_t& values = _group(group);
+
+    auto it = values.find(key);
+    if (it != values.end() && it.value() == value && it.value().type() == value.type()) {
+        return;
+    }
+    values[key] = value;
+    _dirtyKeys[group].insert(key);
+
+    // Not restarted by later changes, so a continuous stream of changes still flushes
+    if (!_flushTimer.isActive()) {
+        _flushTimer.start();
+    }
+}
+
+void SettingsStore::flush(void)
+{
+    _flushTimer.stop();
+    if (_dirtyKeys.isEmpty()) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QSettings   settings;
+    int         keyCount = 0;
+
+    for (auto it = _dirtyKeys.constBegin(); it != _dirtyKeys.constEnd(); ++it) {
+        const Group_t& values = _groups[it.key()];
+
+        if (!it.key().isEmpty()) {
+            settings.beginGroup(it.key());
+        }
+        for (const QString& key: it.value()) {
+            settings.setValue(key, values[key]);
+            keyCount++;
+        }
+        if (!it.key().isEmpty()) {
+            settings.endGroup();
+        }
+    }
+    _dirtyKeys.clear();
+    settings.sync();
+
+    if (settings.status() != QSettings::NoError) {
+        qCWarning(SettingsStoreLog) << "Writing settings failed" << settings.status();
+    }
+    qCDebug(SettingsStoreLog) << "Flushed" << keyCount << "keys in" << timer.elapsed() << "msecs";
+}
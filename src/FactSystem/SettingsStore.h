@@ -0,0 +1,60 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCLoggingCategory.h"
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QVariant>
+
+Q_DECLARE_LOGGING_CATEGORY(SettingsStoreLog)
+
+/// In memory copy of the QSettings values used by SettingsFact. A settings group is read from QSettings in one go the
+/// first time it is used, after that all reads come from memory. Changed values are written back in one batch at most
+/// flushDelayMSecs after the first change and at shutdown, so a slider bound to a setting doesn't write on every step.
+///
+/// Values reach the disk with QSettings::sync. The ini backend replaces the file through QSaveFile, so a crash during the
+/// write leaves the previous file. A crash before the flush loses at most the last flushDelayMSecs of changes.
+///
+/// Code reading the same keys through its own QSettings sees values up to flushDelayMSecs old, call flush first if that
+/// matters. Values written through QSettings after a group was loaded aren't seen here at all.
+///
+/// Owned by QGCApplication and created before the toolbox, since SettingsManager builds its SettingsFacts from the
+/// QGCToolbox constructor. Only to be used from the GUI thread, which also runs the flush timer.
+class SettingsStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    SettingsStore(QObject* parent = nullptr);
+
+    /// @return Value of key in group, defaultValue if it was never saved
+    QVariant value(const QString& group, const QString& key, const QVariant& defaultValue);
+
+    /// Changes the value in memory, QSettings gets it with the next flush
+    void setValue(const QString& group, const QString& key, const QVariant& value);
+
+    /// Writes all changed values to QSettings and syncs it
+    void flush(void);
+
+    static const int flushDelayMSecs = 1000;
+
+private:
+    typedef QHash<QString, QVariant> Group_t;
+
+    Group_t& _group(const QString& group);
+
+    QHash<QString, Group_t>         _groups;
+    QHash<QString, QSet<QString>>   _dirtyKeys;     ///< Group to changed keys not yet flushed
+    QTimer                          _flushTimer;
+};
@@ -0,0 +1,99 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "SettingsStoreTest.h"
+#include "SettingsStore.h"
+#include "QGCApplication.h"
+
+#include <QSettings>
+
+const char* SettingsStoreTest::_group = "SettingsStoreTest";
+
+SettingsStoreTest::SettingsStoreTest(void)
+{
+
+}
+
+void SettingsStoreTest::cleanup(void)
+{
+    qgcApp()->settingsStore()->flush();
+
+    QSettings settings;
+    settings.remove(_group);
+
+    UnitTest::cleanup();
+}
+
+void SettingsStoreTest::_loadTest(void)
+{
+    SettingsStore*  store = qgcApp()->settingsStore();
+    // Nested groups use the same path syntax as QSettings
+    QString         group = QStringLiteral("%1/load").arg(_group);
+
+    {
+        QSettings settings;
+        settings.beginGroup(_group);
+        settings.beginGroup(QStringLiteral("load"));
+        settings.setValue("saved", 42);
+    }
+
+    QCOMPARE(store->value(group, "saved", 0).toInt(), 42);
+    QCOMPARE(store->value(group, "missing", 7).toInt(), 7);
+
+    // Once loaded reads come from memory
+    {
+        QSettings settings;
+        settings.setValue(QStringLiteral("%1/saved").arg(group), 43);
+    }
+    QCOMPARE(store->value(group, "saved", 0).toInt(), 42);
+}
+
+void SettingsStoreTest::_batchedFlushTest(void)
+{
+    SettingsStore*  store = qgcApp()->settingsStore();
+    QString         group = QStringLiteral("%1/batch").arg(_group);
+
+    for (int i=0; i<=100; i++) {
+        store->setValue(group, "slider", i);
+    }
+    store->setValue(group, "other", QStringLiteral("text"));
+    QCOMPARE(store->value(group, "slider", 0).toInt(), 100);
+
+    // Nothing written until the flush
+    {
+        QSettings settings;
+        QVERIFY(!settings.contains(QStringLiteral("%1/slider").arg(group)));
+    }
+
+    QTest::qWait(SettingsStore::flushDelayMSecs * 2);
+
+    QSettings settings;
+    QCOMPARE(settings.value(QStringLiteral("%1/slider").arg(group)).toInt(), 100);
+    QCOMPARE(settings.value(QStringLiteral("%1/other").arg(group)).toString(), QStringLiteral("text"));
+}
+
+void SettingsStoreTest::_unchangedTest(void)
+{
+    SettingsStore*  store = qgcApp()->settingsStore();
+    QString         group = QStringLiteral("%1/unchanged").arg(_group);
+
+    store->setValue(group, "value", 5);
+    store->flush();
+
+    // Writing the same value again doesn't make the key dirty, so the external change survives a flush
+    {
+        QSettings settings;
+        settings.setValue(QStringLiteral("%1/value").arg(group), 6);
+    }
+    store->setValue(group, "value", 5);
+    store->flush();
+
+    QSettings settings;
+    QCOMPARE(settings.value(QStringLiteral("%1/value").arg(group)).toInt(), 6);
+}
@@ -0,0 +1,32 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for SettingsStore
+class SettingsStoreTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    SettingsStoreTest(void);
+
+protected:
+    void cleanup(void) final;
+
+private slots:
+    void _loadTest          (void);
+    void _batchedFlushTest  (void);
+    void _unchangedTest     (void);
+
+private:
+    static const char* _group;
+};
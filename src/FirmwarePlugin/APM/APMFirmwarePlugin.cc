@@ -22,6 +22,8 @@
 #include "SettingsManager.h"
 #include "AppSettings.h"
 #include "APMMavlinkStreamRateSettings.h"
+#include "MessageRateManager.h"
+#include "QGCResourceBundles.h"
 #include "ArduPlaneFirmwarePlugin.h"
 #include "ArduCopterFirmwarePlugin.h"
 #include "ArduRoverFirmwarePlugin.h"
@@ -62,6 +64,11 @@ QString APMCustomMode::modeString() const
 APMFirmwarePlugin::APMFirmwarePlugin(void)
     : _coaxialMotors(false)
 {
+    // The qml, json and parameter meta data of the plugin aren't registered until an ArduPilot vehicle shows up
+    if (!QGCResourceBundles::load(QStringLiteral("APMResources"))) {
+        qWarning() << "ArduPilot plugin resources are missing";
+    }
+
     qmlRegisterType<APMFlightModesComponentController>  ("QGroundControl.Controllers", 1, 0, "APMFlightModesComponentController");
     qmlRegisterType<APMAirframeComponentController>     ("QGroundControl.Controllers", 1, 0, "APMAirframeComponentController");
     qmlRegisterType<APMSensorsComponentController>      ("QGroundControl.Controllers", 1, 0, "APMSensorsComponentController");
@@ -397,7 +404,9 @@ void APMFirmwarePlugin::initializeStreamRates(Vehicle* vehicle)
         const StreamInfo_s& streamInfo = rgStreamInfo[i];
 
         if (streamInfo.streamRate >= 0) {
-            vehicle->requestDataStream(streamInfo.mavStream, static_cast<uint16_t>(streamInfo.streamRate));
+            vehicle->messageRateManager()->requestStreamRate(this, streamInfo.mavStream, streamInfo.streamRate);
+        } else {
+            vehicle->messageRateManager()->removeStreamRate(this, streamInfo.mavStream);
         }
     }
 
@@ -406,7 +415,7 @@ void APMFirmwarePlugin::initializeStreamRates(Vehicle* vehicle)
     // This can cause various features to not be available. So we request home position streaming ourselves.
     // The MAV_CMD_SET_MESSAGE_INTERVAL command is only supported on newer firmwares. So we set showError=false.
     // Which also means than on older firmwares you may be left with some missing features.
-    vehicle->sendMavCommand(MAV_COMP_ID_AUTOPILOT1, MAV_CMD_SET_MESSAGE_INTERVAL, false /* showError */, MAVLINK_MSG_ID_HOME_POSITION, 1000000 /* 1 second interval in usec */);
+    vehicle->messageRateManager()->requestMessageRate(this, MAVLINK_MSG_ID_HOME_POSITION, 1);
 }
 
 
@@ -466,6 +475,33 @@ bool APMFirmwarePlugin::sendHomePositionToVehicle(void)
     return true;
 }
 
+bool APMFirmwarePlugin::pipelinedMissionRead(void)
+{
+    // ArduPilot answers each MISSION_REQUEST on its own without tracking which item it expects next
+    return true;
+}
+
+QString APMFirmwarePlugin::planFtpFile(MAV_MISSION_TYPE planType)
+{
+    // ArduPilot exposes the stored plans through the @MISSION virtual directory
+    switch (planType) {
+    case MAV_MISSION_TYPE_MISSION:
+        return QStringLiteral("@MISSION/mission.dat");
+    case MAV_MISSION_TYPE_FENCE:
+        return QStringLiteral("@MISSION/fence.dat");
+    case MAV_MISSION_TYPE_RALLY:
+        return QStringLiteral("@MISSION/rally.dat");
+    default:
+        return QString();
+    }
+}
+
+QString APMFirmwarePlugin::parameterFtpFile(void)
+{
+    // ArduPilot generates the packed parameter set on the fly in the @PARAM virtual directory
+    return QStringLiteral("@PARAM/param.pck");
+}
+
 FactMetaData* APMFirmwarePlugin::_getMetaDataForFact(QObject* parameterMetaData, const QString& name, FactMetaData::ValueType_t type, MAV_TYPE vehicleType)
 {
     APMParameterMetaData* apmMetaData = qobject_cast<APMParameterMetaData*>(parameterMetaData);
@@ -937,7 +973,7 @@ void APMFirmwarePlugin::_sendGCSMotionReport(Vehicle* vehicle, FollowMe::GCSMoti
         globalPositionInt.relative_alt =    static_cast<int32_t>(0);                                            // mm
         globalPositionInt.vx =              static_cast<int16_t>(motionReport.vxMetersPerSec * 100);            // cm/sec
         globalPositionInt.vy =              static_cast<int16_t>(motionReport.vyMetersPerSec * 100);            // cm/sec
-        globalPositionInt.vy =              static_cast<int16_t>(motionReport.vzMetersPerSec * 100);            // cm/sec
+        globalPositionInt.vz =              static_cast<int16_t>(motionReport.vzMetersPerSec * 100);            // cm/sec
         globalPositionInt.hdg =             static_cast<uint16_t>(motionReport.headingDegrees * 100.0);         // centi-degrees
 
         mavlink_message_t message;
@@ -25,6 +25,7 @@
 ///     @author Rustom Jehangir <rusty@bluerobotics.com>
 
 #include "ArduSubFirmwarePlugin.h"
+#include "MessageRateManager.h"
 
 bool ArduSubFirmwarePlugin::_remapParamNameIntialized = false;
 FirmwarePlugin::remapParamNameMajorVersionMap_t ArduSubFirmwarePlugin::_remapParamName;
@@ -151,13 +152,13 @@ int ArduSubFirmwarePlugin::remapParamNameHigestMinorVersionNumber(int majorVersi
 }
 
 void ArduSubFirmwarePlugin::initializeStreamRates(Vehicle* vehicle) {
-    vehicle->requestDataStream(MAV_DATA_STREAM_RAW_SENSORS,     2);
-    vehicle->requestDataStream(MAV_DATA_STREAM_EXTENDED_STATUS, 2);
-    vehicle->requestDataStream(MAV_DATA_STREAM_RC_CHANNELS,     2);
-    vehicle->requestDataStream(MAV_DATA_STREAM_POSITION,        3);
-    vehicle->requestDataStream(MAV_DATA_STREAM_EXTRA1,          20);
-    vehicle->requestDataStream(MAV_DATA_STREAM_EXTRA2,          10);
-    vehicle->requestDataStream(MAV_DATA_STREAM_EXTRA3,          3);
+    vehicle->messageRateManager()->requestStreamRate(this, MAV_DATA_STREAM_RAW_SENSORS,     2);
+    vehicle->messageRateManager()->requestStreamRate(this, MAV_DATA_STREAM_EXTENDED_STATUS, 2);
+    vehicle->messageRateManager()->requestStreamRate(this, MAV_DATA_STREAM_RC_CHANNELS,     2);
+    vehicle->messageRateManager()->requestStreamRate(this, MAV_DATA_STREAM_POSITION,        3);
+    vehicle->messageRateManager()->requestStreamRate(this, MAV_DATA_STREAM_EXTRA1,          20);
+    vehicle->messageRateManager()->requestStreamRate(this, MAV_DATA_STREAM_EXTRA2,          10);
+    vehicle->messageRateManager()->requestStreamRate(this, MAV_DATA_STREAM_EXTRA3,          3);
 }
 
 bool ArduSubFirmwarePlugin::isCapable(const Vehicle* vehicle, FirmwareCapabilities capabilities)
@@ -174,6 +174,22 @@ bool FirmwarePlugin::sendHomePositionToVehicle(void)
     return false;
 }
 
+bool FirmwarePlugin::pipelinedMissionRead(void)
+{
+    // We don't know how a generic stack handles multiple outstanding requests so stick to the spec sequence
+    return false;
+}
+
+QString FirmwarePlugin::planFtpFile(MAV_MISSION_TYPE /* planType */)
+{
+    return QString();
+}
+
+QString FirmwarePlugin::parameterFtpFile(void)
+{
+    return QString();
+}
+
 QList<MAV_CMD> FirmwarePlugin::supportedMissionCommands(QGCMAVLink::VehicleClass_t /* vehicleClass */)
 {
     // Generic supports all commands
@@ -1035,6 +1051,14 @@ void FirmwarePlugin::sendGCSMotionReport(Vehicle* vehicle, FollowMe::GCSMotionRe
         mavlink_follow_target_t follow_target   = {};
         SharedLinkInterfacePtr  sharedLink      = weakLink.lock();
 
+        // FOLLOW_TARGET has no target system, every vehicle on the link picks up the same message
+        if (motionReport.reportId != 0) {
+            if (_lastMotionReportIds.value(sharedLink.get(), 0) == motionReport.reportId) {
+                return;
+            }
+            _lastMotionReportIds[sharedLink.get()] = motionReport.reportId;
+        }
+
         follow_target.timestamp =           qgcApp()->msecsSinceBoot();
         follow_target.est_capabilities =    estimationCapabilities;
         follow_target.position_cov[0] =     static_cast<float>(motionReport.pos_std_dev[0]);
@@ -1044,6 +1068,7 @@ void FirmwarePlugin::sendGCSMotionReport(Vehicle* vehicle, FollowMe::GCSMotionRe
         follow_target.lon =                 motionReport.lon_int;
         follow_target.vel[0] =              static_cast<float>(motionReport.vxMetersPerSec);
         follow_target.vel[1] =              static_cast<float>(motionReport.vyMetersPerSec);
+        follow_target.vel[2] =              static_cast<float>(motionReport.vzMetersPerSec);
 
         mavlink_message_t message;
         mavlink_msg_follow_target_encode_chan(static_cast<uint8_t>(mavlinkProtocol->getSystemId()),
@@ -22,10 +22,12 @@
 #include "FollowMe.h"
 
 #include <QList>
+#include <QMap>
 #include <QString>
 #include <QVariantList>
 
 class Vehicle;
+class LinkInterface;
 class QGCCameraControl;
 class QGCCameraManager;
 
@@ -209,6 +211,21 @@ public:
     ///     false: Do not send first item to vehicle, sequence numbers must be adjusted
     virtual bool sendHomePositionToVehicle(void);
 
+    /// Determines whether mission items can be read from the vehicle with more than one MISSION_REQUEST outstanding.
+    ///     true: PlanManager keeps a window of requests outstanding which is sized from the measured round trip time
+    ///     false: Strict stop-and-wait, the next item is only requested once the previous one arrives
+    virtual bool pipelinedMissionRead(void);
+
+    /// Returns the MAVLink FTP path of the file which holds the whole plan of the specified type. PlanManager reads the plan
+    /// as a single burst download from there and falls back to the item protocol if that fails.
+    ///     @return Empty string if the plan type can't be read over FTP
+    virtual QString planFtpFile(MAV_MISSION_TYPE planType);
+
+    /// Returns the MAVLink FTP path of the file which holds the autopilot parameters packed in the ArduPilot param.pck format.
+    /// ParameterManager reads all parameters as a single burst download from there and falls back to PARAM_REQUEST_LIST if that fails.
+    ///     @return Empty string if parameters can't be read over FTP
+    virtual QString parameterFtpFile(void);
+
     /// Returns the parameter set version info pulled from inside the meta data file. -1 if not found.
     /// Note: The implementation for this must not vary by vehicle type.
     /// Important: Only CompInfoParam code should use this method
@@ -354,6 +371,8 @@ private:
     QVariantList _modeIndicatorList;
 
     static QVariantList _cameraList;    ///< Standard QGC camera list
+
+    QMap<LinkInterface*, quint32> _lastMotionReportIds;    ///< Last GCS motion report sent on each link
 };
 
 class FirmwarePluginFactory : public QObject
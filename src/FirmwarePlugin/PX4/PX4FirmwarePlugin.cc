@@ -25,6 +25,7 @@
 #include "QGCFileDownload.h"
 #include "SettingsManager.h"
 #include "PlanViewSettings.h"
+#include "QGCResourceBundles.h"
 
 #include <QDebug>
 
@@ -57,6 +58,11 @@ PX4FirmwarePlugin::PX4FirmwarePlugin()
     , _simpleFlightMode     (tr("Simple"))
     , _orbitFlightMode      (tr("Orbit"))
 {
+    // The qml, json and parameter meta data of the plugin aren't registered until a PX4 vehicle shows up
+    if (!QGCResourceBundles::load(QStringLiteral("PX4Resources"))) {
+        qWarning() << "PX4 plugin resources are missing";
+    }
+
     qmlRegisterType<PX4AdvancedFlightModesController>   ("QGroundControl.Controllers", 1, 0, "PX4AdvancedFlightModesController");
     qmlRegisterType<PX4SimpleFlightModesController>     ("QGroundControl.Controllers", 1, 0, "PX4SimpleFlightModesController");
     qmlRegisterType<AirframeComponentController>        ("QGroundControl.Controllers", 1, 0, "AirframeComponentController");
@@ -250,6 +256,12 @@ bool PX4FirmwarePlugin::sendHomePositionToVehicle(void)
     return false;
 }
 
+bool PX4FirmwarePlugin::pipelinedMissionRead(void)
+{
+    // PX4 answers each MISSION_REQUEST_INT on its own without tracking which item it expects next
+    return true;
+}
+
 FactMetaData* PX4FirmwarePlugin::_getMetaDataForFact(QObject* parameterMetaData, const QString& name, FactMetaData::ValueType_t type, MAV_TYPE vehicleType)
 {
     PX4ParameterMetaData* px4MetaData = qobject_cast<PX4ParameterMetaData*>(parameterMetaData);
@@ -90,6 +90,12 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
 
     qCDebug(PX4ParameterMetaDataLog) << "Loading parameter meta data:" << metaDataFile;
 
+    if (_metaDataStore.open(metaDataFile, QStringLiteral("PX4ParameterMetaData"))) {
+        // FactMetaData is created from the store as parameters are asked for
+        qCDebug(PX4ParameterMetaDataLog) << "Using meta data store, parameter count:" << _metaDataStore.count();
+        return;
+    }
+
     QFile xmlFile(metaDataFile);
 
     if (!xmlFile.exists()) {
@@ -401,6 +407,8 @@ void PX4ParameterMetaData::loadParameterFactMetaDataFile(const QString& metaData
         xml.readNext();
     }
 
+    _metaDataStore.write(_mapParameterName2FactMetaData);
+
 #ifdef GENERATE_PARAMETER_JSON
     _generateParameterJson();
 #endif
@@ -495,8 +503,11 @@ FactMetaData* PX4ParameterMetaData::getMetaDataForFact(const QString& name, MAV_
     Q_UNUSED(vehicleType)
 
     if (!_mapParameterName2FactMetaData.contains(name)) {
-        qCDebug(PX4ParameterMetaDataLog) << "No metaData for " << name << "using generic metadata";
-        FactMetaData* metaData = new FactMetaData(type, this);
+        FactMetaData* metaData = _metaDataStore.create(name, this);
+        if (!metaData) {
+            qCDebug(PX4ParameterMetaDataLog) << "No metaData for " << name << "using generic metadata";
+            metaData = new FactMetaData(type, this);
+        }
         _mapParameterName2FactMetaData[name] = metaData;
     }
 
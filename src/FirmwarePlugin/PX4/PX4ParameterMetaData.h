@@ -15,6 +15,7 @@
 #include <QLoggingCategory>
 
 #include "FactSystem.h"
+#include "FactMetaDataStore.h"
 #include "AutoPilotPlugin.h"
 #include "Vehicle.h"
 
@@ -57,4 +58,5 @@ private:
 
     bool                                _parameterMetaDataLoaded        = false;    ///< true: parameter meta data already loaded
     FactMetaData::NameToMetaDataMap_t   _mapParameterName2FactMetaData;             ///< Maps from a parameter name to FactMetaData
+    FactMetaDataStore                   _metaDataStore;                             ///< FactMetaData not yet in the map is created from here when open
 };
@@ -19,6 +19,7 @@ import QGroundControl.Controls          1.0
 import QGroundControl.Palette           1.0
 import QGroundControl.Vehicle           1.0
 import QGroundControl.Controllers       1.0
+import QGroundControl.SettingsManager   1.0
 
 Item {
     id:     root
@@ -37,6 +38,17 @@ Item {
     property int    _fitMode:           QGroundControl.settingsManager.videoSettings.videoFit.rawValue
 
     property double _thermalHeightFactor: 0.85 //-- TODO
+    property bool   _thermalRadiometric:  QGroundControl.videoManager.thermalRadiometric
+    property point  _thermalSpot:         QGroundControl.videoManager.thermalSpot
+    property rect   _thermalArea:         QGroundControl.videoManager.thermalArea
+    property bool   _thermalCelsius:      QGroundControl.settingsManager.unitsSettings.temperatureUnits.rawValue === UnitsSettings.TemperatureUnitsCelsius
+
+    function _thermalTempString(celsius) {
+        if (isNaN(celsius)) {
+            return "--"
+        }
+        return _thermalCelsius ? celsius.toFixed(1) + "°C" : (celsius * 1.8 + 32).toFixed(1) + "°F"
+    }
 
     Rectangle {
         id:             noVideo
@@ -169,6 +181,56 @@ Item {
                 receiver:       QGroundControl.videoManager.thermalVideoReceiver
                 opacity:        _camera ? (_camera.thermalMode === QGCCameraControl.THERMAL_BLEND ? _camera.thermalOpacity / 100 : 1.0) : 0
             }
+            //-- Radiometric measurements: click for a spot, drag for an area, double click clears
+            MouseArea {
+                id:             thermalMeasureArea
+                anchors.fill:   parent
+                enabled:        _thermalRadiometric
+                property point  _pressPoint
+
+                function _normalized(x, y) {
+                    return Qt.point(Math.min(Math.max(x / width, 0), 1), Math.min(Math.max(y / height, 0), 1))
+                }
+
+                onPressed:          _pressPoint = _normalized(mouse.x, mouse.y)
+                onPositionChanged: {
+                    var p = _normalized(mouse.x, mouse.y)
+                    QGroundControl.videoManager.thermalArea = Qt.rect(_pressPoint.x, _pressPoint.y, p.x - _pressPoint.x, p.y - _pressPoint.y)
+                }
+                onClicked:          QGroundControl.videoManager.thermalSpot = _normalized(mouse.x, mouse.y)
+                onDoubleClicked:    QGroundControl.videoManager.clearThermalMeasurement()
+            }
+            Rectangle {
+                x:              _thermalArea.x * parent.width
+                y:              _thermalArea.y * parent.height
+                width:          _thermalArea.width * parent.width
+                height:         _thermalArea.height * parent.height
+                color:          "transparent"
+                border.color:   "white"
+                border.width:   1
+                visible:        _thermalRadiometric && _thermalArea.width > 0 && _thermalArea.height > 0
+                QGCLabel {
+                    anchors.top:    parent.bottom
+                    anchors.left:   parent.left
+                    color:          "white"
+                    text:           qsTr("Min %1 Max %2 Avg %3").arg(_thermalTempString(QGroundControl.videoManager.thermalAreaMinTemp))
+                                        .arg(_thermalTempString(QGroundControl.videoManager.thermalAreaMaxTemp))
+                                        .arg(_thermalTempString(QGroundControl.videoManager.thermalAreaMeanTemp))
+                }
+            }
+            Item {
+                x:          _thermalSpot.x * parent.width
+                y:          _thermalSpot.y * parent.height
+                visible:    _thermalRadiometric && _thermalSpot.x >= 0
+                Rectangle { x: -ScreenTools.defaultFontPixelWidth; y: 0; width: ScreenTools.defaultFontPixelWidth * 2; height: 1; color: "white" }
+                Rectangle { x: 0; y: -ScreenTools.defaultFontPixelWidth; width: 1; height: ScreenTools.defaultFontPixelWidth * 2; color: "white" }
+                QGCLabel {
+                    x:      ScreenTools.defaultFontPixelWidth
+                    y:      ScreenTools.defaultFontPixelWidth * 0.5
+                    color:  "white"
+                    text:   _thermalTempString(QGroundControl.videoManager.thermalSpotTemp)
+                }
+            }
         }
         //-- Zoom
         PinchArea {
@@ -97,6 +97,7 @@ FlightMap {
     }
     onCenterChanged: {
         QGroundControl.flightMapPosition = center
+        QGroundControl.adsbVehicleManager.setMapCenter(center)
         updateAirspace(false)
     }
 
@@ -241,19 +242,37 @@ FlightMap {
             onPointAdded:           trajectoryPolyline.addCoordinate(coordinate)
             onUpdateLastPoint:      trajectoryPolyline.replaceCoordinate(trajectoryPolyline.pathLength() - 1, coordinate)
             onPointsCleared:        trajectoryPolyline.path = []
+            onPointsReset:          trajectoryPolyline.path = _activeVehicle.trajectoryPoints.list()
         }
     }
 
-    // Add the vehicles to the map
-    MapItemView {
-        model: QGroundControl.multiVehicleManager.vehicles
-        delegate: VehicleMapItem {
-            vehicle:        object
-            coordinate:     object.coordinate
-            map:            _root
-            size:           pipMode ? ScreenTools.defaultFontPixelHeight : ScreenTools.defaultFontPixelHeight * 3
-            z:              QGroundControl.zOrderVehicles
-        }
+    // All other vehicles and the ADSB vehicles are drawn by a single layer, only the active vehicle and the selected
+    // ADSB vehicle get a full delegate
+    VehicleMarkerLayer {
+        id:                     vehicleMarkerLayer
+        anchors.fill:           parent
+        mapCenter:              _root.center
+        zoomLevel:              _root.zoomLevel
+        bearing:                _root.bearing
+        vehicleSize:            pipMode ? ScreenTools.defaultFontPixelHeight : ScreenTools.defaultFontPixelHeight * 3
+        adsbVehicleSize:        ScreenTools.defaultFontPixelHeight * 2.5
+        delegateVehicle:        _activeVehicle
+        delegateAdsbVehicle:    _selectedAdsbVehicle
+        z:                      QGroundControl.zOrderVehicles
+
+        onVehicleClicked:       QGroundControl.multiVehicleManager.activeVehicle = vehicle
+        onAdsbVehicleClicked:   _selectedAdsbVehicle = (adsbVehicle === _selectedAdsbVehicle ? null : adsbVehicle)
+    }
+
+    property var _selectedAdsbVehicle: null
+
+    VehicleMapItem {
+        vehicle:        _activeVehicle
+        coordinate:     _activeVehicleCoordinate
+        map:            _root
+        size:           pipMode ? ScreenTools.defaultFontPixelHeight : ScreenTools.defaultFontPixelHeight * 3
+        z:              QGroundControl.zOrderVehicles
+        visible:        _activeVehicle && coordinate.isValid
     }
     // Add distance sensor view
     MapItemView{
@@ -265,19 +284,38 @@ FlightMap {
             z:              QGroundControl.zOrderVehicles
         }
     }
-    // Add ADSB vehicles to the map
+    // Add obstacle distance view
     MapItemView {
-        model: QGroundControl.adsbVehicleManager.adsbVehicles
-        delegate: VehicleMapItem {
+        model: QGroundControl.multiVehicleManager.vehicles
+        delegate: ObstacleDistanceMapView {
+            vehicle:        object
             coordinate:     object.coordinate
-            altitude:       object.altitude
-            callsign:       object.callsign
-            heading:        object.heading
-            alert:          object.alert
             map:            _root
             z:              QGroundControl.zOrderVehicles
         }
     }
+    // Selected ADSB vehicle, with its altitude
+    VehicleMapItem {
+        coordinate:     _selectedAdsbVehicle ? _selectedAdsbVehicle.coordinate : QtPositioning.coordinate()
+        altitude:       _selectedAdsbVehicle ? _selectedAdsbVehicle.altitude : NaN
+        callsign:       _selectedAdsbVehicle ? _selectedAdsbVehicle.callsign : ""
+        heading:        _selectedAdsbVehicle ? _selectedAdsbVehicle.heading : NaN
+        alert:          _selectedAdsbVehicle ? _selectedAdsbVehicle.alert : false
+        map:            _root
+        z:              QGroundControl.zOrderVehicles
+        visible:        _selectedAdsbVehicle && coordinate.isValid
+    }
+
+    // Predicted paths of traffic conflicts up to the closest point of approach
+    MapItemView {
+        model: QGroundControl.adsbVehicleManager.trafficConflicts
+        delegate: MapPolyline {
+            line.width: 3
+            line.color: object.warning ? "red" : "orange"
+            z:          QGroundControl.zOrderTrajectoryLines
+            path:       [ object.coordinate, object.cpaCoordinate, object.otherCpaCoordinate, object.otherCoordinate ]
+        }
+    }
 
     // Add the items associated with each vehicles flight plan to the map
     Repeater {
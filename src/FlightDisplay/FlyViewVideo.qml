@@ -55,6 +55,12 @@ Item {
         useSmallFont:   _root.pipState.state !== _root.pipState.fullState
         visible:        QGroundControl.videoManager.isGStreamer
     }
+    // Reads as shown only with all of its parents, so also false while the pip is collapsed or another view is up
+    Binding {
+        target:     QGroundControl.videoManager
+        property:   "videoVisible"
+        value:      videoStreaming.visible
+    }
     //-- UVC Video (USB Camera or Video Device)
     Loader {
         id:             cameraLoader
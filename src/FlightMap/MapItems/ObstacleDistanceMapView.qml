@@ -0,0 +1,67 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+import QtQuick                  2.12
+import QtLocation               5.3
+import QtPositioning            5.3
+
+import QGroundControl               1.0
+import QGroundControl.ScreenTools   1.0
+import QGroundControl.Controls      1.0
+
+/// Obstacles reported through OBSTACLE_DISTANCE(_3D) around the vehicle
+MapQuickItem {
+    id:             _root
+    visible:        _objectAvoidance && _objectAvoidance.sensorCount > 0 && coordinate.isValid
+
+    property var    vehicle
+    property var    map
+    property double heading:    vehicle ? vehicle.heading.value : Number.NaN    ///< Vehicle heading, NAN for none
+
+    property var    _objectAvoidance:   vehicle ? vehicle.objectAvoidance : null
+    property real   _pixelsPerMeter:    1
+
+    anchorPoint.x:  0
+    anchorPoint.y:  0
+
+    function calcSize() {
+        var scaleLinePixelLength    = 100
+        var leftCoord               = map.toCoordinate(Qt.point(0, 0), false /* clipToViewPort */)
+        var rightCoord              = map.toCoordinate(Qt.point(scaleLinePixelLength, 0), false /* clipToViewPort */)
+        var scaleLineMeters         = leftCoord.distanceTo(rightCoord)
+        if (scaleLineMeters > 0) {
+            _pixelsPerMeter = scaleLinePixelLength / scaleLineMeters
+        }
+    }
+
+    Connections {
+        target:             map
+        onWidthChanged:     scaleTimer.restart()
+        onHeightChanged:    scaleTimer.restart()
+        onZoomLevelChanged: scaleTimer.restart()
+    }
+
+    Timer {
+        id:                 scaleTimer
+        interval:           100
+        running:            false
+        repeat:             false
+        onTriggered:        calcSize()
+    }
+
+    sourceItem: ObstacleDistanceItem {
+        objectAvoidance:    _objectAvoidance
+        pixelsPerMeter:     _pixelsPerMeter
+        pointSize:          ScreenTools.defaultFontPixelHeight * 0.5
+        rotation:           isNaN(heading) ? 0 : heading
+        opacity:            0.75
+
+        Component.onCompleted: calcSize()
+    }
+}
@@ -14,25 +14,36 @@
 #include "FirmwarePlugin.h"
 #include "MAVLinkProtocol.h"
 #include "FollowMe.h"
+#include "FollowMeMotionEstimator.h"
 #include "Vehicle.h"
 #include "PositionManager.h"
 #include "SettingsManager.h"
 #include "AppSettings.h"
+#include "QGCApplication.h"
+
+#include <QDateTime>
 
 QGC_LOGGING_CATEGORY(FollowMeLog, "FollowMeLog")
 
 FollowMe::FollowMe(QGCApplication* app, QGCToolbox* toolbox)
-    : QGCTool(app, toolbox)
+    : QGCTool           (app, toolbox)
+    , _motionEstimator  (new FollowMeMotionEstimator)
 {
     _gcsMotionReportTimer.setSingleShot(false);
 }
 
+FollowMe::~FollowMe()
+{
+    delete _motionEstimator;
+}
+
 void FollowMe::setToolbox(QGCToolbox* toolbox)
 {
     QGCTool::setToolbox(toolbox);
 
-    connect(&_gcsMotionReportTimer,                                     &QTimer::timeout,       this, &FollowMe::_sendGCSMotionReport);
-    connect(toolbox->settingsManager()->appSettings()->followTarget(),  &Fact::rawValueChanged, this, &FollowMe::_settingsChanged);
+    connect(&_gcsMotionReportTimer,                                         &QTimer::timeout,       this, &FollowMe::_sendGCSMotionReport);
+    connect(toolbox->settingsManager()->appSettings()->followTarget(),      &Fact::rawValueChanged, this, &FollowMe::_settingsChanged);
+    connect(toolbox->settingsManager()->appSettings()->followTargetRate(),  &Fact::rawValueChanged, this, &FollowMe::_reportRateChanged);
 
     _settingsChanged();
 }
@@ -60,10 +71,22 @@ void FollowMe::_settingsChanged()
     }
 }
 
+int FollowMe::_reportIntervalMsecs(void)
+{
+    double rateHz = _toolbox->settingsManager()->appSettings()->followTargetRate()->rawValue().toDouble();
+    return rateHz > 0 ? qMax(static_cast<int>(1000.0 / rateHz), 1) : 250;
+}
+
 void FollowMe::_enableFollowSend()
 {
     if (!_gcsMotionReportTimer.isActive()) {
-        _gcsMotionReportTimer.setInterval(qMin(_toolbox->qgcPositionManager()->updateInterval(), 250));
+        // Reports are extrapolated between position source updates, so they can go out faster than the source runs.
+        // Reporting starts with the next update, there is no telling how old the last one is.
+        _motionEstimator->reset();
+        _motionEstimator->setSourceInterval(_toolbox->qgcPositionManager()->updateInterval());
+        connect(_toolbox->qgcPositionManager(), &QGCPositionManager::positionInfoUpdated, this, &FollowMe::_positionInfoUpdated);
+
+        _gcsMotionReportTimer.setInterval(_reportIntervalMsecs());
         _gcsMotionReportTimer.start();
     }
 }
@@ -72,18 +95,24 @@ void FollowMe::_disableFollowSend()
 {
     if (_gcsMotionReportTimer.isActive()) {
         _gcsMotionReportTimer.stop();
+        disconnect(_toolbox->qgcPositionManager(), &QGCPositionManager::positionInfoUpdated, this, &FollowMe::_positionInfoUpdated);
     }
 }
 
-void FollowMe::_sendGCSMotionReport()
+void FollowMe::_reportRateChanged(void)
 {
-    QGeoPositionInfo    geoPositionInfo =   _toolbox->qgcPositionManager()->geoPositionInfo();
-    QGeoCoordinate      gcsCoordinate =     geoPositionInfo.coordinate();
+    _gcsMotionReportTimer.setInterval(_reportIntervalMsecs());
+}
 
-    if (!geoPositionInfo.isValid()) {
-        return;
-    }
+void FollowMe::_positionInfoUpdated(QGeoPositionInfo update)
+{
+    // The source interval can change along with the source
+    _motionEstimator->setSourceInterval(_toolbox->qgcPositionManager()->updateInterval());
+    _motionEstimator->update(update, static_cast<qint64>(qgcApp()->msecsSinceBoot()), FollowMeMotionEstimator::sourceLatencyMsecs(update, QDateTime::currentMSecsSinceEpoch()));
+}
 
+void FollowMe::_sendGCSMotionReport()
+{
     // First check to see if any vehicles need follow me updates
     bool needFollowMe = false;
     if (_currentMode == MODE_ALWAYS) {
@@ -101,68 +130,26 @@ void FollowMe::_sendGCSMotionReport()
         return;
     }
 
-    GCSMotionReport motionReport = {};
-    uint8_t         estimatation_capabilities = 0;
-
-    // get the current location coordinates
-
-    motionReport.lat_int =          static_cast<int>(gcsCoordinate.latitude()  * 1e7);
-    motionReport.lon_int =          static_cast<int>(gcsCoordinate.longitude() * 1e7);
-    motionReport.altMetersAMSL =    gcsCoordinate.altitude();
-    estimatation_capabilities |=    (1 << POS);
-
-    if (geoPositionInfo.hasAttribute(QGeoPositionInfo::Direction) == true) {
-        estimatation_capabilities |= (1 << HEADING);
-        motionReport.headingDegrees = geoPositionInfo.attribute(QGeoPositionInfo::Direction);
-    }
-
-    // get the current eph and epv
-
-    if (geoPositionInfo.hasAttribute(QGeoPositionInfo::HorizontalAccuracy)) {
-        motionReport.pos_std_dev[0] = motionReport.pos_std_dev[1] = geoPositionInfo.attribute(QGeoPositionInfo::HorizontalAccuracy);
-    }
-
-    if (geoPositionInfo.hasAttribute(QGeoPositionInfo::VerticalAccuracy)) {
-        motionReport.pos_std_dev[2] = geoPositionInfo.attribute(QGeoPositionInfo::VerticalAccuracy);
-    }
-
-    // calculate z velocity if it's available
-
-    if (geoPositionInfo.hasAttribute(QGeoPositionInfo::VerticalSpeed)) {
-        motionReport.vzMetersPerSec = geoPositionInfo.attribute(QGeoPositionInfo::VerticalSpeed);
-    }
-
-    // calculate x,y velocity if it's available
-
-    if (geoPositionInfo.hasAttribute(QGeoPositionInfo::Direction) && geoPositionInfo.hasAttribute(QGeoPositionInfo::GroundSpeed) == true) {
-        estimatation_capabilities |= (1 << VEL);
-
-        qreal direction = _degreesToRadian(geoPositionInfo.attribute(QGeoPositionInfo::Direction));
-        qreal velocity  = geoPositionInfo.attribute(QGeoPositionInfo::GroundSpeed);
-
-        motionReport.vxMetersPerSec = cos(direction)*velocity;
-        motionReport.vyMetersPerSec = sin(direction)*velocity;
-    } else {
-        motionReport.vxMetersPerSec = 0;
-        motionReport.vyMetersPerSec = 0;
+    // The report is built once and shared by all the vehicles
+    GCSMotionReport motionReport;
+    uint8_t         estimatation_capabilities;
+    if (!_motionEstimator->report(static_cast<qint64>(qgcApp()->msecsSinceBoot()), motionReport, estimatation_capabilities)) {
+        return;
     }
+    motionReport.reportId   = ++_motionReportId;
+    _positionAgeMsecs       = motionReport.positionAgeMsecs;
 
     QmlObjectListModel* vehicles = _toolbox->multiVehicleManager()->vehicles();
 
     for (int i=0; i<vehicles->count(); i++) {
         Vehicle* vehicle = vehicles->value<Vehicle*>(i);
         if (_currentMode == MODE_ALWAYS || _isFollowFlightMode(vehicle, vehicle->flightMode())) {
-            qCDebug(FollowMeLog) << "sendGCSMotionReport latInt:lonInt:altMetersAMSL" << motionReport.lat_int << motionReport.lon_int << motionReport.altMetersAMSL;
+            qCDebug(FollowMeLog) << "sendGCSMotionReport latInt:lonInt:altMetersAMSL:ageMsecs" << motionReport.lat_int << motionReport.lon_int << motionReport.altMetersAMSL << motionReport.positionAgeMsecs;
             vehicle->firmwarePlugin()->sendGCSMotionReport(vehicle, motionReport, estimatation_capabilities);
         }
     }
 }
 
-double FollowMe::_degreesToRadian(double deg)
-{
-    return deg * M_PI / 180.0;
-}
-
 void FollowMe::_vehicleAdded(Vehicle* vehicle)
 {
     connect(vehicle, &Vehicle::flightModeChanged, this, &FollowMe::_enableIfVehicleInFollow);
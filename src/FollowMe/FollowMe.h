@@ -21,6 +21,7 @@
 #include "MAVLinkProtocol.h"
 
 class Vehicle;
+class FollowMeMotionEstimator;
 
 Q_DECLARE_LOGGING_CATEGORY(FollowMeLog)
 
@@ -30,6 +31,7 @@ class FollowMe : public QGCTool
 
 public:
     FollowMe(QGCApplication* app, QGCToolbox* toolbox);
+    ~FollowMe();
 
     struct GCSMotionReport {
         int     lat_int;            // X Position in WGS84 frame in 1e7 * meters
@@ -40,6 +42,8 @@ public:
         double  vyMetersPerSec;     //	Y velocity in NED frame in meter / s
         double  vzMetersPerSec;     //	Z velocity in NED frame in meter / s
         double  pos_std_dev[3];     // -1 for unknown
+        qint64  positionAgeMsecs;   // Age of the GCS position fix the report was extrapolated from
+        quint32 reportId;           // Same for every vehicle the report is sent to, so a link only has to carry it once
     };
 
     // Mavlink defined motion reporting capabilities
@@ -53,12 +57,18 @@ public:
 
     void setToolbox(QGCToolbox* toolbox) override;
 
+    /// @return Age of the GCS position in the last motion report, from when the position source took the fix. -1 if
+    /// no report has been sent.
+    qint64 positionAgeMsecs(void) const { return _positionAgeMsecs; }
+
 private slots:
     void _sendGCSMotionReport       (void);
     void _settingsChanged           (void);
     void _vehicleAdded              (Vehicle* vehicle);
     void _vehicleRemoved            (Vehicle* vehicle);
     void _enableIfVehicleInFollow   (void);
+    void _positionInfoUpdated       (QGeoPositionInfo update);
+    void _reportRateChanged         (void);
 
 private:
     enum {
@@ -69,9 +79,12 @@ private:
 
     void    _disableFollowSend  (void);
     void    _enableFollowSend   (void);
-    double  _degreesToRadian    (double deg);
+    int     _reportIntervalMsecs(void);
     bool    _isFollowFlightMode (Vehicle* vehicle, const QString& flightMode);
 
-    QTimer      _gcsMotionReportTimer;
-    uint32_t    _currentMode;
+    QTimer                      _gcsMotionReportTimer;
+    uint32_t                    _currentMode;
+    FollowMeMotionEstimator*    _motionEstimator;
+    quint32                     _motionReportId     = 0;
+    qint64                      _positionAgeMsecs   = -1;
 };
@@ -0,0 +1,157 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FollowMeMotionEstimator.h"
+#include "QGCGeo.h"
+
+#include <QDateTime>
+#include <QtMath>
+
+void FollowMeMotionEstimator::setSourceInterval(int sourceIntervalMsecs)
+{
+    _sourceIntervalMsecs = sourceIntervalMsecs;
+}
+
+int FollowMeMotionEstimator::maxExtrapolationMsecs(void) const
+{
+    return 2 * (_sourceIntervalMsecs > 0 ? _sourceIntervalMsecs : defaultSourceIntervalMsecs);
+}
+
+int FollowMeMotionEstimator::staleMsecs(void) const
+{
+    int staleMsecs = 5 * (_sourceIntervalMsecs > 0 ? _sourceIntervalMsecs : defaultSourceIntervalMsecs);
+    return staleMsecs > minStaleMsecs ? staleMsecs : minStaleMsecs;
+}
+
+qint64 FollowMeMotionEstimator::sourceLatencyMsecs(const QGeoPositionInfo& info, qint64 receivedUtcMsecs)
+{
+    if (!info.timestamp().isValid()) {
+        return 0;
+    }
+
+    qint64 latencyMsecs = receivedUtcMsecs - info.timestamp().toMSecsSinceEpoch();
+    if (latencyMsecs < 0 || latencyMsecs > maxSourceLatencyMsecs) {
+        return 0;
+    }
+    return latencyMsecs;
+}
+
+void FollowMeMotionEstimator::reset(void)
+{
+    _info               = QGeoPositionInfo();
+    _hasVelocity        = false;
+    _hasVerticalSpeed   = false;
+}
+
+void FollowMeMotionEstimator::update(const QGeoPositionInfo& info, qint64 receivedMsecs, qint64 sourceLatencyMsecs)
+{
+    if (!info.isValid()) {
+        return;
+    }
+
+    // Time between the fixes, preferring the source's own timestamps over when they happened to arrive
+    double dtSecs = 0;
+    if (_info.isValid()) {
+        qint64 dtMsecs = _info.timestamp().msecsTo(info.timestamp());
+        if (dtMsecs <= 0) {
+            dtMsecs = (receivedMsecs - sourceLatencyMsecs) - (_receivedMsecs - _sourceLatencyMsecs);
+        }
+        if (dtMsecs > 0 && dtMsecs < staleMsecs()) {
+            dtSecs = dtMsecs / 1000.0;
+        }
+    }
+
+    double north = 0, east = 0, down = 0;
+    if (dtSecs > 0) {
+        convertGeoToNed(info.coordinate(), _info.coordinate(), &north, &east, &down);
+    }
+
+    if (info.hasAttribute(QGeoPositionInfo::Direction) && info.hasAttribute(QGeoPositionInfo::GroundSpeed)) {
+        double direction    = qDegreesToRadians(info.attribute(QGeoPositionInfo::Direction));
+        double speed        = info.attribute(QGeoPositionInfo::GroundSpeed);
+
+        _vNorth         = cos(direction) * speed;
+        _vEast          = sin(direction) * speed;
+        _hasVelocity    = true;
+    } else if (dtSecs > 0) {
+        _vNorth         = north / dtSecs;
+        _vEast          = east / dtSecs;
+        _hasVelocity    = true;
+    } else {
+        _vNorth = _vEast = 0;
+        _hasVelocity    = false;
+    }
+
+    if (info.hasAttribute(QGeoPositionInfo::VerticalSpeed)) {
+        // Vertical speed is positive up
+        _vDown              = -info.attribute(QGeoPositionInfo::VerticalSpeed);
+        _hasVerticalSpeed   = true;
+    } else if (dtSecs > 0 && info.coordinate().type() == QGeoCoordinate::Coordinate3D && _info.coordinate().type() == QGeoCoordinate::Coordinate3D) {
+        _vDown              = down / dtSecs;
+        _hasVerticalSpeed   = true;
+    } else {
+        _vDown              = 0;
+        _hasVerticalSpeed   = false;
+    }
+
+    _info               = info;
+    _receivedMsecs      = receivedMsecs;
+    _sourceLatencyMsecs = sourceLatencyMsecs;
+}
+
+qint64 FollowMeMotionEstimator::positionAgeMsecs(qint64 nowMsecs) const
+{
+    if (!_info.isValid()) {
+        return -1;
+    }
+    return _sourceLatencyMsecs + (nowMsecs - _receivedMsecs);
+}
+
+bool FollowMeMotionEstimator::report(qint64 nowMsecs, FollowMe::GCSMotionReport& motionReport, uint8_t& estimationCapabilities) const
+{
+    qint64 ageMsecs = positionAgeMsecs(nowMsecs);
+    if (ageMsecs < 0 || ageMsecs > staleMsecs()) {
+        return false;
+    }
+
+    motionReport            = {};
+    estimationCapabilities  = 1 << FollowMe::POS;
+    motionReport.pos_std_dev[0] = motionReport.pos_std_dev[1] = motionReport.pos_std_dev[2] = -1;
+
+    QGeoCoordinate coordinate = _info.coordinate();
+    if (_hasVelocity) {
+        // Brings the fix forward to now, which also takes out the latency of the source
+        double dtSecs = (ageMsecs < maxExtrapolationMsecs() ? ageMsecs : maxExtrapolationMsecs()) / 1000.0;
+        convertNedToGeo(_vNorth * dtSecs, _vEast * dtSecs, _vDown * dtSecs, _info.coordinate(), &coordinate);
+
+        estimationCapabilities      |= 1 << FollowMe::VEL;
+        motionReport.vxMetersPerSec = _vNorth;
+        motionReport.vyMetersPerSec = _vEast;
+        motionReport.vzMetersPerSec = _vDown;
+    }
+
+    motionReport.lat_int            = static_cast<int>(coordinate.latitude()  * 1e7);
+    motionReport.lon_int            = static_cast<int>(coordinate.longitude() * 1e7);
+    motionReport.altMetersAMSL      = coordinate.altitude();
+    motionReport.positionAgeMsecs   = ageMsecs;
+
+    if (_info.hasAttribute(QGeoPositionInfo::Direction)) {
+        estimationCapabilities      |= 1 << FollowMe::HEADING;
+        motionReport.headingDegrees = _info.attribute(QGeoPositionInfo::Direction);
+    }
+
+    if (_info.hasAttribute(QGeoPositionInfo::HorizontalAccuracy)) {
+        motionReport.pos_std_dev[0] = motionReport.pos_std_dev[1] = _info.attribute(QGeoPositionInfo::HorizontalAccuracy);
+    }
+    if (_info.hasAttribute(QGeoPositionInfo::VerticalAccuracy)) {
+        motionReport.pos_std_dev[2] = _info.attribute(QGeoPositionInfo::VerticalAccuracy);
+    }
+
+    return true;
+}
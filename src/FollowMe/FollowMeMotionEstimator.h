@@ -0,0 +1,65 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QGeoCoordinate>
+#include <QGeoPositionInfo>
+
+#include "FollowMe.h"
+
+/// Estimates the GCS motion between position source updates, so motion reports can go out at a higher rate than the
+/// source delivers fixes. Velocity is taken from the fix when the source reports it, otherwise it is worked out from
+/// the last two fixes. The position is extrapolated along the velocity for up to two source update periods, after
+/// which it is held. Fixes which are too old aren't reported at all.
+class FollowMeMotionEstimator
+{
+public:
+    /// @param sourceIntervalMsecs Update interval of the position source, 0 if unknown
+    void setSourceInterval(int sourceIntervalMsecs);
+
+    /// Adds a fix from the position source
+    ///     @param receivedMsecs        When the fix was received, on the clock which is later passed to report
+    ///     @param sourceLatencyMsecs   How old the fix already was when it was received
+    void update(const QGeoPositionInfo& info, qint64 receivedMsecs, qint64 sourceLatencyMsecs);
+
+    void reset(void);
+
+    /// Builds the motion report for nowMsecs
+    /// @return false: there is no fix recent enough to report
+    bool report(qint64 nowMsecs, FollowMe::GCSMotionReport& motionReport, uint8_t& estimationCapabilities) const;
+
+    /// @return Age of the last fix at nowMsecs, from when the source took it, -1 for no fix
+    qint64 positionAgeMsecs(qint64 nowMsecs) const;
+
+    /// @return Longest interval the position is extrapolated over
+    int maxExtrapolationMsecs(void) const;
+
+    /// @return Age past which a fix is no longer reported
+    int staleMsecs(void) const;
+
+    /// @return Age of the fix when it was received, from its timestamp. 0 when the timestamp can't be trusted.
+    ///     @param receivedUtcMsecs Msecs since epoch when the fix was received
+    static qint64 sourceLatencyMsecs(const QGeoPositionInfo& info, qint64 receivedUtcMsecs);
+
+    static const int defaultSourceIntervalMsecs = 1000;     ///< Used when the source doesn't say
+    static const int maxSourceLatencyMsecs      = 5000;     ///< Larger differences are put down to the clocks being out of step
+    static const int minStaleMsecs              = 3000;
+
+private:
+    QGeoPositionInfo    _info;
+    qint64              _receivedMsecs          = 0;
+    qint64              _sourceLatencyMsecs     = 0;
+    int                 _sourceIntervalMsecs    = 0;
+    bool                _hasVelocity            = false;
+    bool                _hasVerticalSpeed       = false;
+    double              _vNorth                 = 0;    ///< m/s
+    double              _vEast                  = 0;    ///< m/s
+    double              _vDown                  = 0;    ///< m/s
+};
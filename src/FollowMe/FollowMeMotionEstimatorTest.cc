@@ -0,0 +1,130 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FollowMeMotionEstimatorTest.h"
+#include "FollowMeMotionEstimator.h"
+
+#include <QDateTime>
+
+static QGeoPositionInfo _positionInfo(const QGeoCoordinate& coordinate, const QDateTime& timestamp)
+{
+    return QGeoPositionInfo(coordinate, timestamp);
+}
+
+static QGeoCoordinate _reportCoordinate(const FollowMe::GCSMotionReport& motionReport)
+{
+    return QGeoCoordinate(motionReport.lat_int / 1e7, motionReport.lon_int / 1e7, motionReport.altMetersAMSL);
+}
+
+void FollowMeMotionEstimatorTest::_extrapolationTest(void)
+{
+    FollowMeMotionEstimator     estimator;
+    FollowMe::GCSMotionReport   motionReport;
+    uint8_t                     capabilities;
+    QGeoCoordinate              origin(47.6, -122.1, 100);
+    QDateTime                   timestamp = QDateTime::currentDateTimeUtc();
+
+    estimator.setSourceInterval(1000);
+    QVERIFY(!estimator.report(0, motionReport, capabilities));
+    QCOMPARE(estimator.positionAgeMsecs(0), Q_INT64_C(-1));
+
+    // A single fix without velocity is held where it is
+    estimator.update(_positionInfo(origin, timestamp), 0, 0);
+    QVERIFY(estimator.report(500, motionReport, capabilities));
+    QCOMPARE(capabilities, static_cast<uint8_t>(1 << FollowMe::POS));
+    QVERIFY(_reportCoordinate(motionReport).distanceTo(origin) < 0.1);
+
+    // Second fix 10 meters north, a second later, gives 10 m/s north from the difference
+    QGeoCoordinate north = origin.atDistanceAndAzimuth(10, 0);
+    estimator.update(_positionInfo(north, timestamp.addMSecs(1000)), 1000, 0);
+    QVERIFY(estimator.report(1500, motionReport, capabilities));
+    QVERIFY(capabilities & (1 << FollowMe::VEL));
+    QVERIFY(qAbs(motionReport.vxMetersPerSec - 10) < 0.1);
+    QVERIFY(qAbs(motionReport.vyMetersPerSec) < 0.1);
+    QCOMPARE(motionReport.positionAgeMsecs, Q_INT64_C(500));
+
+    QGeoCoordinate expected = north.atDistanceAndAzimuth(5, 0);
+    QVERIFY(_reportCoordinate(motionReport).distanceTo(expected) < 0.1);
+}
+
+void FollowMeMotionEstimatorTest::_fixVelocityTest(void)
+{
+    FollowMeMotionEstimator     estimator;
+    FollowMe::GCSMotionReport   motionReport;
+    uint8_t                     capabilities;
+    QGeoCoordinate              origin(47.6, -122.1, 100);
+    QGeoPositionInfo            info = _positionInfo(origin, QDateTime::currentDateTimeUtc());
+
+    // Heading east at 4 m/s and climbing at 1 m/s, with the fix 250 msecs old when it arrives
+    info.setAttribute(QGeoPositionInfo::Direction,          90);
+    info.setAttribute(QGeoPositionInfo::GroundSpeed,        4);
+    info.setAttribute(QGeoPositionInfo::VerticalSpeed,      1);
+    info.setAttribute(QGeoPositionInfo::HorizontalAccuracy, 3);
+
+    estimator.setSourceInterval(1000);
+    estimator.update(info, 1000, 250);
+    QVERIFY(estimator.report(1250, motionReport, capabilities));
+    QCOMPARE(capabilities, static_cast<uint8_t>((1 << FollowMe::POS) | (1 << FollowMe::VEL) | (1 << FollowMe::HEADING)));
+    QCOMPARE(motionReport.positionAgeMsecs, Q_INT64_C(500));
+    QVERIFY(qAbs(motionReport.vxMetersPerSec) < 0.01);
+    QVERIFY(qAbs(motionReport.vyMetersPerSec - 4) < 0.01);
+    QVERIFY(qAbs(motionReport.vzMetersPerSec + 1) < 0.01);
+    QCOMPARE(motionReport.headingDegrees, 90.0);
+    QCOMPARE(motionReport.pos_std_dev[0], 3.0);
+    QCOMPARE(motionReport.pos_std_dev[2], -1.0);
+
+    QGeoCoordinate expected = origin.atDistanceAndAzimuth(2, 90);
+    QVERIFY(_reportCoordinate(motionReport).distanceTo(expected) < 0.1);
+    QVERIFY(qAbs(motionReport.altMetersAMSL - 100.5) < 0.1);
+}
+
+void FollowMeMotionEstimatorTest::_staleTest(void)
+{
+    FollowMeMotionEstimator     estimator;
+    FollowMe::GCSMotionReport   motionReport;
+    uint8_t                     capabilities;
+    QGeoCoordinate              origin(47.6, -122.1, 100);
+    QGeoPositionInfo            info = _positionInfo(origin, QDateTime::currentDateTimeUtc());
+
+    info.setAttribute(QGeoPositionInfo::Direction,      0);
+    info.setAttribute(QGeoPositionInfo::GroundSpeed,    10);
+
+    estimator.setSourceInterval(500);
+    QCOMPARE(estimator.maxExtrapolationMsecs(), 1000);
+    QCOMPARE(estimator.staleMsecs(), 3000);
+    estimator.setSourceInterval(0);
+    QCOMPARE(estimator.maxExtrapolationMsecs(), 2000);
+    QCOMPARE(estimator.staleMsecs(), 5000);
+
+    // Extrapolation stops after two source intervals, the position is then held
+    estimator.setSourceInterval(1000);
+    estimator.update(info, 0, 0);
+    QVERIFY(estimator.report(2500, motionReport, capabilities));
+    QGeoCoordinate expected = origin.atDistanceAndAzimuth(20, 0);
+    QVERIFY(_reportCoordinate(motionReport).distanceTo(expected) < 0.1);
+
+    QVERIFY(estimator.report(5000, motionReport, capabilities));
+    QVERIFY(!estimator.report(5001, motionReport, capabilities));
+
+    estimator.reset();
+    QVERIFY(!estimator.report(0, motionReport, capabilities));
+}
+
+void FollowMeMotionEstimatorTest::_sourceLatencyTest(void)
+{
+    QDateTime           timestamp = QDateTime::currentDateTimeUtc();
+    QGeoPositionInfo    info = _positionInfo(QGeoCoordinate(47.6, -122.1), timestamp);
+    qint64              utcMsecs = timestamp.toMSecsSinceEpoch();
+
+    QCOMPARE(FollowMeMotionEstimator::sourceLatencyMsecs(info, utcMsecs + 300), Q_INT64_C(300));
+    // Fixes from the future or from too far back are put down to the clocks being out of step
+    QCOMPARE(FollowMeMotionEstimator::sourceLatencyMsecs(info, utcMsecs - 300), Q_INT64_C(0));
+    QCOMPARE(FollowMeMotionEstimator::sourceLatencyMsecs(info, utcMsecs + 60000), Q_INT64_C(0));
+    QCOMPARE(FollowMeMotionEstimator::sourceLatencyMsecs(_positionInfo(QGeoCoordinate(47.6, -122.1), QDateTime()), utcMsecs), Q_INT64_C(0));
+}
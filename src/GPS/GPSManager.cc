@@ -13,6 +13,8 @@
 #include "QGCApplication.h"
 #include "SettingsManager.h"
 #include "RTKSettings.h"
+#include "MultiVehicleManager.h"
+#include "Vehicle.h"
 
 GPSManager::GPSManager(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
@@ -24,6 +26,39 @@ GPSManager::GPSManager(QGCApplication* app, QGCToolbox* toolbox)
 GPSManager::~GPSManager()
 {
     disconnectGPS();
+    delete _ntripLink;
+    delete _rtcmMavlink;
+}
+
+void GPSManager::setToolbox(QGCToolbox* toolbox)
+{
+    QGCTool::setToolbox(toolbox);
+
+    _rtcmMavlink = new RTCMMavlink(*_toolbox);
+}
+
+void GPSManager::deferredInit(void)
+{
+    RTKSettings* rtkSettings = _toolbox->settingsManager()->rtkSettings();
+    if (rtkSettings->ntripServerConnectEnabled()->rawValue().toBool()) {
+        _ntripLink = new NTRIPTCPLink(rtkSettings->ntripServerHostAddress()->rawValue().toString(),
+                                      rtkSettings->ntripServerPort()->rawValue().toInt(),
+                                      rtkSettings->ntripMountpoint()->rawValue().toString(),
+                                      rtkSettings->ntripUsername()->rawValue().toString(),
+                                      rtkSettings->ntripPassword()->rawValue().toString(),
+                                      this);
+        connect(_ntripLink, &NTRIPTCPLink::RTCMDataUpdate,      _rtcmMavlink,   &RTCMMavlink::RTCMDataUpdate,       Qt::QueuedConnection);
+        connect(_ntripLink, &NTRIPTCPLink::error,               this,           &GPSManager::_ntripError,           Qt::QueuedConnection);
+        connect(_ntripLink, &NTRIPTCPLink::streamingChanged,    this,           &GPSManager::_sendNtripPosition,    Qt::QueuedConnection);
+        connect(this,       &GPSManager::_ntripPosition,        _ntripLink,     &NTRIPTCPLink::sendPosition,        Qt::QueuedConnection);
+
+        const int ggaIntervalSecs = rtkSettings->ntripGgaInterval()->rawValue().toInt();
+        if (ggaIntervalSecs > 0) {
+            connect(&_ntripGgaTimer, &QGCWheelTimer::timeout, this, &GPSManager::_sendNtripPosition);
+            _ntripGgaTimer.setSingleShot(false);
+            _ntripGgaTimer.start(ggaIntervalSecs * 1000);
+        }
+    }
 }
 
 void GPSManager::connectGPS(const QString& device, const QString& gps_type)
@@ -57,9 +92,6 @@ void GPSManager::connectGPS(const QString& device, const QString& gps_type)
                                    _requestGpsStop);
     _gpsProvider->start();
 
-    //create RTCM device
-    _rtcmMavlink = new RTCMMavlink(*_toolbox);
-
     connect(_gpsProvider, &GPSProvider::RTCMDataUpdate, _rtcmMavlink, &RTCMMavlink::RTCMDataUpdate);
 
     //test: connect to position update
@@ -81,11 +113,20 @@ void GPSManager::disconnectGPS(void)
         }
         delete(_gpsProvider);
     }
-    if (_rtcmMavlink) {
-        delete(_rtcmMavlink);
-    }
     _gpsProvider = nullptr;
-    _rtcmMavlink = nullptr;
+}
+
+void GPSManager::_ntripError(const QString errorMsg)
+{
+    qgcApp()->showAppMessage(tr("NTRIP: %1").arg(errorMsg));
+}
+
+void GPSManager::_sendNtripPosition(void)
+{
+    Vehicle* vehicle = _toolbox->multiVehicleManager()->activeVehicle();
+    if (vehicle && vehicle->coordinate().isValid()) {
+        emit _ntripPosition(vehicle->coordinate(), vehicle->altitudeAMSL()->rawValue().toDouble());
+    }
 }
 
 
@@ -12,6 +12,8 @@
 
 #include "GPSProvider.h"
 #include "RTCM/RTCMMavlink.h"
+#include "NTRIPTCPLink.h"
+#include "QGCTimerWheel.h"
 #include <QGCToolbox.h>
 
 #include <QString>
@@ -28,6 +30,10 @@ public:
     GPSManager(QGCApplication* app, QGCToolbox* toolbox);
     ~GPSManager();
 
+    // Overrides from QGCTool
+    void setToolbox(QGCToolbox* toolbox) final;
+    void deferredInit(void) final;
+
     void connectGPS     (const QString& device, const QString& gps_type);
     void disconnectGPS  (void);
     bool connected      (void) const { return _gpsProvider && _gpsProvider->isRunning(); }
@@ -37,14 +43,19 @@ signals:
     void onDisconnect();
     void surveyInStatus(float duration, float accuracyMM,  double latitude, double longitude, float altitude, bool valid, bool active);
     void satelliteUpdate(int numSats);
+    void _ntripPosition(const QGeoCoordinate& coordinate, double altitudeAMSL);
 
 private slots:
     void GPSPositionUpdate(GPSPositionMessage msg);
     void GPSSatelliteUpdate(GPSSatelliteMessage msg);
+    void _ntripError(const QString errorMsg);
+    void _sendNtripPosition(void);
 
 private:
-    GPSProvider* _gpsProvider = nullptr;
-    RTCMMavlink* _rtcmMavlink = nullptr;
+    GPSProvider*    _gpsProvider    = nullptr;
+    RTCMMavlink*    _rtcmMavlink    = nullptr;  ///< Shared by the GPS provider and the NTRIP link
+    NTRIPTCPLink*   _ntripLink      = nullptr;
+    QGCWheelTimer   _ntripGgaTimer { "RTK" };
 
     std::atomic_bool _requestGpsStop; ///< signals the thread to quit
 };
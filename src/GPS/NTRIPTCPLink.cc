@@ -0,0 +1,246 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "NTRIPTCPLink.h"
+
+#include <QCoreApplication>
+#include <QUrl>
+
+QGC_LOGGING_CATEGORY(NTRIPLog, "NTRIPLog")
+
+NTRIPTCPLink::NTRIPTCPLink(const QString& hostAddress, int port, const QString& mountpoint, const QString& username, const QString& password, QObject* parent)
+    : QThread       (parent)
+    , _hostAddress  (hostAddress)
+    , _port         (port)
+    , _request      (request(mountpoint, username, password, QStringLiteral("%1/%2").arg(QCoreApplication::applicationName(), QCoreApplication::applicationVersion())))
+{
+    moveToThread(this);
+    start();
+}
+
+NTRIPTCPLink::~NTRIPTCPLink(void)
+{
+    quit();
+    wait();
+}
+
+void NTRIPTCPLink::run(void)
+{
+    _socket         = new QTcpSocket();
+    _reconnectTimer = new QTimer();
+    _stallTimer     = new QTimer();
+
+    _reconnectTimer->setSingleShot(true);
+    _stallTimer->setSingleShot(true);
+    _stallTimer->setInterval(stallTimeoutMSecs);
+
+    connect(_socket,            &QTcpSocket::connected,     this, &NTRIPTCPLink::_connected);
+    connect(_socket,            &QTcpSocket::readyRead,     this, &NTRIPTCPLink::_readBytes);
+    connect(_socket,            &QTcpSocket::disconnected,  this, &NTRIPTCPLink::_disconnected);
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+    connect(_socket,            static_cast<void (QTcpSocket::*)(QAbstractSocket::SocketError)>(&QTcpSocket::error), this, &NTRIPTCPLink::_socketError);
+#else
+    connect(_socket,            &QAbstractSocket::errorOccurred, this, &NTRIPTCPLink::_socketError);
+#endif
+    connect(_reconnectTimer,    &QTimer::timeout,           this, &NTRIPTCPLink::_connect);
+    connect(_stallTimer,        &QTimer::timeout,           this, &NTRIPTCPLink::_stalled);
+
+    _connect();
+    exec();
+
+    // Nothing is left to handle the signals of an abort
+    _socket->disconnect(this);
+    _socket->abort();
+    delete _socket;
+    delete _reconnectTimer;
+    delete _stallTimer;
+    _socket         = nullptr;
+    _reconnectTimer = nullptr;
+    _stallTimer     = nullptr;
+}
+
+QByteArray NTRIPTCPLink::request(const QString& mountpoint, const QString& username, const QString& password, const QString& userAgent)
+{
+    // NTRIP 1.0, so the caster doesn't switch to the chunked transfer encoding of NTRIP 2.0
+    QByteArray text;
+    text += "GET /" + QUrl::toPercentEncoding(mountpoint) + " HTTP/1.0\r\n";
+    text += "User-Agent: NTRIP " + userAgent.toUtf8() + "\r\n";
+    text += "Accept: */*\r\n";
+    if (!username.isEmpty()) {
+        text += "Authorization: Basic " + QStringLiteral("%1:%2").arg(username, password).toUtf8().toBase64() + "\r\n";
+    }
+    text += "Connection: close\r\n";
+    text += "\r\n";
+    return text;
+}
+
+QByteArray NTRIPTCPLink::ggaSentence(const QGeoCoordinate& coordinate, double altitudeAMSL, const QDateTime& utc)
+{
+    const double latitude   = qAbs(coordinate.latitude());
+    const double longitude  = qAbs(coordinate.longitude());
+    const int    latDegrees = static_cast<int>(latitude);
+    const int    lonDegrees = static_cast<int>(longitude);
+
+    // Fix quality 1 (GPS fix), casters only use the position to pick or compute the reference station
+    const QString body = QStringLiteral("GPGGA,%1,%2%3,%4,%5%6,%7,1,12,1.0,%8,M,0.0,M,,")
+            .arg(utc.toUTC().toString(QStringLiteral("hhmmss.zzz")).left(9))
+            .arg(latDegrees, 2, 10, QChar('0'))
+            .arg((latitude - latDegrees) * 60.0, 8, 'f', 5, QChar('0'))
+            .arg(coordinate.latitude() < 0 ? QChar('S') : QChar('N'))
+            .arg(lonDegrees, 3, 10, QChar('0'))
+            .arg((longitude - lonDegrees) * 60.0, 8, 'f', 5, QChar('0'))
+            .arg(coordinate.longitude() < 0 ? QChar('W') : QChar('E'))
+            .arg(altitudeAMSL, 0, 'f', 1);
+
+    const QByteArray bodyBytes = body.toLatin1();
+    quint8 checksum = 0;
+    for (char c: bodyBytes) {
+        checksum ^= static_cast<quint8>(c);
+    }
+    return "$" + bodyBytes + "*" + QByteArray::number(checksum, 16).rightJustified(2, '0').toUpper() + "\r\n";
+}
+
+void NTRIPTCPLink::sendPosition(const QGeoCoordinate& coordinate, double altitudeAMSL)
+{
+    _coordinate     = coordinate;
+    _altitudeAMSL   = altitudeAMSL;
+    _sendGGA();
+}
+
+void NTRIPTCPLink::_sendGGA(void)
+{
+    if (_streaming && _coordinate.isValid()) {
+        _socket->write(ggaSentence(_coordinate, _altitudeAMSL, QDateTime::currentDateTimeUtc()));
+    }
+}
+
+void NTRIPTCPLink::_connect(void)
+{
+    qCDebug(NTRIPLog) << "Connecting" << _hostAddress << _port;
+
+    _buffer.clear();
+    _setStreaming(false);
+    _socket->abort();
+    _socket->connectToHost(_hostAddress, static_cast<quint16>(_port));
+}
+
+void NTRIPTCPLink::_connected(void)
+{
+    qCDebug(NTRIPLog) << "Connected, requesting mountpoint";
+    _socket->write(_request);
+    _stallTimer->start();
+}
+
+void NTRIPTCPLink::_readBytes(void)
+{
+    _buffer.append(_socket->readAll());
+
+    if (!_streaming && !_parseResponse()) {
+        return;
+    }
+
+    QVector<RTCMParser::Frame_t> frames;
+    const int used = _parser.parse(_buffer.constData(), _buffer.size(), frames);
+    for (const RTCMParser::Frame_t& frame: frames) {
+        emit RTCMDataUpdate(QByteArray(frame.data, frame.length));
+    }
+    _buffer.remove(0, used);
+
+    if (!frames.isEmpty()) {
+        _stallTimer->start();
+        _reconnectMSecs = reconnectMinMSecs;
+    }
+}
+
+bool NTRIPTCPLink::_parseResponse(void)
+{
+    const int statusEnd = _buffer.indexOf("\r\n");
+    if (statusEnd < 0) {
+        if (_buffer.size() > maxHeaderLength) {
+            _reconnectLater(tr("Invalid response from NTRIP caster"));
+        }
+        return false;
+    }
+
+    const QByteArray    status      = _buffer.left(statusEnd);
+    int                 headerEnd   = 0;
+
+    if (status.startsWith("ICY 200")) {
+        // NTRIP 1.0 has no header fields, the stream starts right after the status line
+        headerEnd = statusEnd + 2;
+    } else if (status.startsWith("HTTP/1.") && status.mid(9, 3) == "200") {
+        headerEnd = _buffer.indexOf("\r\n\r\n");
+        if (headerEnd < 0) {
+            if (_buffer.size() > maxHeaderLength) {
+                _reconnectLater(tr("Invalid response from NTRIP caster"));
+            }
+            return false;
+        }
+        if (_buffer.left(headerEnd).toLower().contains("transfer-encoding: chunked")) {
+            _reconnectLater(tr("NTRIP caster uses chunked transfer encoding, which is not supported"));
+            return false;
+        }
+        headerEnd += 4;
+    } else if (status.startsWith("SOURCETABLE")) {
+        _reconnectLater(tr("NTRIP mountpoint not found, the caster sent its source table"));
+        return false;
+    } else {
+        _reconnectLater(tr("NTRIP caster refused the connection: %1").arg(QString::fromLatin1(status)));
+        return false;
+    }
+
+    qCDebug(NTRIPLog) << "Streaming" << status;
+    _buffer.remove(0, headerEnd);
+    _setStreaming(true);
+    _sendGGA();
+    return true;
+}
+
+void NTRIPTCPLink::_disconnected(void)
+{
+    _reconnectLater(tr("NTRIP caster closed the connection"));
+}
+
+void NTRIPTCPLink::_socketError(QAbstractSocket::SocketError /*socketError*/)
+{
+    _reconnectLater(_socket->errorString());
+}
+
+void NTRIPTCPLink::_stalled(void)
+{
+    _reconnectLater(tr("No corrections from NTRIP caster for %1 seconds").arg(stallTimeoutMSecs / 1000));
+}
+
+void NTRIPTCPLink::_reconnectLater(const QString& reason)
+{
+    // An abort, error and disconnect may all report the same failure
+    if (_reconnectTimer->isActive()) {
+        return;
+    }
+
+    qCDebug(NTRIPLog) << "Reconnecting in" << _reconnectMSecs << "msecs:" << reason;
+    // Only the first of a series of failures is reported
+    if (_reconnectMSecs == reconnectMinMSecs) {
+        emit error(reason);
+    }
+
+    _setStreaming(false);
+    _stallTimer->stop();
+    _reconnectTimer->start(_reconnectMSecs);
+    _reconnectMSecs = _reconnectMSecs * 2 > reconnectMaxMSecs ? reconnectMaxMSecs : _reconnectMSecs * 2;
+    _socket->abort();
+}
+
+void NTRIPTCPLink::_setStreaming(bool streaming)
+{
+    if (streaming != _streaming) {
+        _streaming = streaming;
+        emit streamingChanged(_streaming);
+    }
+}
@@ -0,0 +1,84 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "RTCM/RTCMParser.h"
+#include "QGCLoggingCategory.h"
+
+#include <QThread>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QDateTime>
+#include <QGeoCoordinate>
+
+Q_DECLARE_LOGGING_CATEGORY(NTRIPLog)
+
+/// NTRIP 1.0 client for a network RTK caster, runs on its own thread. Each verified RTCM 3 frame of the mountpoint
+/// is sent on with RTCMDataUpdate. The link reconnects with a growing delay after a connection failure or when the
+/// stream stalls. For VRS mountpoints the caster needs the rover position, which is uploaded as NMEA GGA whenever
+/// sendPosition is called.
+class NTRIPTCPLink : public QThread
+{
+    Q_OBJECT
+
+public:
+    NTRIPTCPLink(const QString& hostAddress, int port, const QString& mountpoint, const QString& username, const QString& password, QObject* parent);
+    ~NTRIPTCPLink();
+
+    /// @return Request for mountpoint, with basic authentication if username is set
+    static QByteArray request(const QString& mountpoint, const QString& username, const QString& password, const QString& userAgent);
+
+    /// @return NMEA GGA sentence with checksum and line end
+    static QByteArray ggaSentence(const QGeoCoordinate& coordinate, double altitudeAMSL, const QDateTime& utc);
+
+    static const int reconnectMinMSecs  = 1000;
+    static const int reconnectMaxMSecs  = 30000;
+    static const int stallTimeoutMSecs  = 20000;    ///< Casters send at least once per second
+    static const int maxHeaderLength    = 4096;
+
+public slots:
+    /// Uploads the position as GGA now, or once the stream started
+    void sendPosition(const QGeoCoordinate& coordinate, double altitudeAMSL);
+
+signals:
+    void RTCMDataUpdate (QByteArray message);
+    void error          (const QString errorMsg);
+    void streamingChanged(bool streaming);
+
+protected:
+    void run(void) final;
+
+private slots:
+    void _connect           (void);
+    void _connected         (void);
+    void _readBytes         (void);
+    void _disconnected      (void);
+    void _socketError       (QAbstractSocket::SocketError socketError);
+    void _stalled           (void);
+
+private:
+    bool _parseResponse     (void);
+    void _reconnectLater    (const QString& reason);
+    void _setStreaming      (bool streaming);
+    void _sendGGA           (void);
+
+    QString         _hostAddress;
+    int             _port;
+    QByteArray      _request;
+    QTcpSocket*     _socket             = nullptr;
+    QTimer*         _reconnectTimer     = nullptr;
+    QTimer*         _stallTimer         = nullptr;
+    RTCMParser      _parser;
+    QByteArray      _buffer;                        ///< Response header or incomplete frame from the last read
+    bool            _streaming          = false;    ///< Response header is done, the rest is RTCM
+    int             _reconnectMSecs     = reconnectMinMSecs;
+    QGeoCoordinate  _coordinate;
+    double          _altitudeAMSL       = 0;
+};
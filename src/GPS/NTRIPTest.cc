@@ -0,0 +1,140 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "NTRIPTest.h"
+#include "NTRIPTCPLink.h"
+#include "RTCM/RTCMParser.h"
+
+/// @return RTCM 3 frame of messageType with a payload of payloadLength bytes
+static QByteArray _frame(int messageType, int payloadLength)
+{
+    QByteArray frame;
+    frame.append(static_cast<char>(RTCMParser::preamble));
+    frame.append(static_cast<char>((payloadLength >> 8) & 0x03));
+    frame.append(static_cast<char>(payloadLength & 0xFF));
+    for (int i = 0; i < payloadLength; i++) {
+        frame.append(static_cast<char>(i * 7));
+    }
+    if (payloadLength >= 2) {
+        frame[3] = static_cast<char>(messageType >> 4);
+        frame[4] = static_cast<char>(((messageType & 0x0F) << 4) | (frame[4] & 0x0F));
+    }
+    const quint32 crc = RTCMParser::crc24q(frame.constData(), frame.size());
+    frame.append(static_cast<char>((crc >> 16) & 0xFF));
+    frame.append(static_cast<char>((crc >> 8) & 0xFF));
+    frame.append(static_cast<char>(crc & 0xFF));
+    return frame;
+}
+
+void NTRIPTest::_crcTest(void)
+{
+    // Check value of CRC-24Q
+    const QByteArray check("123456789");
+    QCOMPARE(RTCMParser::crc24q(check.constData(), check.size()), static_cast<quint32>(0xCDE703));
+    QCOMPARE(RTCMParser::crc24q(check.constData(), 0), static_cast<quint32>(0));
+}
+
+void NTRIPTest::_parseTest(void)
+{
+    RTCMParser                  parser;
+    QVector<RTCMParser::Frame_t> frames;
+
+    const QByteArray observations   = _frame(1077, 200);
+    const QByteArray station        = _frame(1005, 19);
+    const QByteArray empty          = _frame(0, 0);
+    QByteArray corrupted            = _frame(1087, 50);
+    corrupted[20] = static_cast<char>(corrupted[20] ^ 0x01);
+
+    // Garbage, including something which looks like a preamble, around and between the frames
+    const QByteArray garbage("\x01\xD3\xFF\x02", 4);
+    const QByteArray data = garbage + observations + corrupted + station + garbage + empty;
+
+    QCOMPARE(parser.parse(data.constData(), data.size(), frames), data.size());
+    QCOMPARE(frames.count(), 3);
+
+    QCOMPARE(frames[0].messageType, 1077);
+    QCOMPARE(frames[0].length, observations.size());
+    QCOMPARE(frames[1].messageType, 1005);
+    QCOMPARE(frames[2].messageType, 0);
+    QCOMPARE(frames[2].length, empty.size());
+
+    // Frames point into the data
+    QVERIFY(frames[0].data == data.constData() + garbage.size());
+    QVERIFY(frames[1].data == data.constData() + garbage.size() + observations.size() + corrupted.size());
+    QCOMPARE(QByteArray(frames[1].data, frames[1].length), station);
+
+    QCOMPARE(parser.frameCount(), static_cast<quint32>(3));
+    QCOMPARE(parser.crcErrorCount(), static_cast<quint32>(1));
+    QCOMPARE(parser.skippedBytes(), static_cast<quint32>(2 * garbage.size() + corrupted.size()));
+    QCOMPARE(parser.messageCounts().value(1077), static_cast<quint32>(1));
+    QCOMPARE(parser.messageCounts().value(1087), static_cast<quint32>(0));
+
+    QCOMPARE(RTCMParser::messageType(observations.constData(), observations.size()), 1077);
+    QCOMPARE(RTCMParser::messageType(garbage.constData(), garbage.size()), -1);
+}
+
+void NTRIPTest::_splitTest(void)
+{
+    RTCMParser                  parser;
+    QVector<RTCMParser::Frame_t> frames;
+
+    const QByteArray first  = _frame(1074, 100);
+    const QByteArray second = _frame(1230, 10);
+    QByteArray buffer       = first + second.left(second.size() / 2);
+
+    // The incomplete frame is left for the next read
+    const int used = parser.parse(buffer.constData(), buffer.size(), frames);
+    QCOMPARE(used, first.size());
+    QCOMPARE(frames.count(), 1);
+    buffer.remove(0, used);
+
+    buffer.append(second.mid(second.size() / 2));
+    frames.clear();
+    QCOMPARE(parser.parse(buffer.constData(), buffer.size(), frames), buffer.size());
+    QCOMPARE(frames.count(), 1);
+    QCOMPARE(frames[0].messageType, 1230);
+    QCOMPARE(parser.skippedBytes(), static_cast<quint32>(0));
+
+    // A header alone isn't enough for a frame
+    frames.clear();
+    QCOMPARE(parser.parse(second.constData(), 2, frames), 0);
+    QVERIFY(frames.isEmpty());
+}
+
+void NTRIPTest::_ggaTest(void)
+{
+    const QDateTime     utc(QDate(2020, 1, 1), QTime(12, 34, 56, 780), Qt::UTC);
+    const QByteArray    gga = NTRIPTCPLink::ggaSentence(QGeoCoordinate(47.5, -8.25), 450.3, utc);
+
+    QVERIFY(gga.startsWith("$GPGGA,123456.78,4730.00000,N,00815.00000,W,1,12,1.0,450.3,M,0.0,M,,*"));
+    QVERIFY(gga.endsWith("\r\n"));
+
+    // Checksum is the xor of everything between $ and *
+    const int   star        = gga.indexOf('*');
+    quint8      checksum    = 0;
+    for (int i = 1; i < star; i++) {
+        checksum ^= static_cast<quint8>(gga[i]);
+    }
+    QCOMPARE(gga.mid(star + 1, 2), QByteArray::number(checksum, 16).rightJustified(2, '0').toUpper());
+
+    const QByteArray south = NTRIPTCPLink::ggaSentence(QGeoCoordinate(-33.75, 151.125), 10, utc);
+    QVERIFY(south.contains(",3345.00000,S,15107.50000,E,"));
+}
+
+void NTRIPTest::_requestTest(void)
+{
+    const QByteArray request = NTRIPTCPLink::request(QStringLiteral("MOUNT1"), QStringLiteral("user"), QStringLiteral("pass"), QStringLiteral("QGC/1.0"));
+    QVERIFY(request.startsWith("GET /MOUNT1 HTTP/1.0\r\n"));
+    QVERIFY(request.contains("User-Agent: NTRIP QGC/1.0\r\n"));
+    QVERIFY(request.contains("Authorization: Basic " + QByteArray("user:pass").toBase64() + "\r\n"));
+    QVERIFY(request.endsWith("\r\n\r\n"));
+
+    const QByteArray anonymous = NTRIPTCPLink::request(QStringLiteral("MOUNT1"), QString(), QString(), QStringLiteral("QGC/1.0"));
+    QVERIFY(!anonymous.contains("Authorization"));
+}
@@ -0,0 +1,24 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class NTRIPTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _crcTest       (void);
+    void _parseTest     (void);
+    void _splitTest     (void);
+    void _ggaTest       (void);
+    void _requestTest   (void);
+};
@@ -9,38 +9,60 @@
 
 
 #include "RTCMMavlink.h"
+#include "RTCMParser.h"
 
 #include "MultiVehicleManager.h"
 #include "Vehicle.h"
+#include "SettingsManager.h"
+#include "RTKSettings.h"
 
-#include <cstdio>
+QGC_LOGGING_CATEGORY(RTCMMavlinkLog, "RTCMMavlinkLog")
 
 RTCMMavlink::RTCMMavlink(QGCToolbox& toolbox)
     : _toolbox(toolbox)
 {
-    _bandwidthTimer.start();
+    _statusTimer.start();
+    _flushTimer.setInterval(flushIntervalMSecs);
+    connect(&_flushTimer, &QGCWheelTimer::timeout, this, &RTCMMavlink::_flushQueues);
 }
 
-void RTCMMavlink::RTCMDataUpdate(QByteArray message)
+int RTCMMavlink::messageType(const QByteArray& message)
 {
-    /* statistics */
-    _bandwidthByteCounter += message.size();
-    qint64 elapsed = _bandwidthTimer.elapsed();
-    if (elapsed > 1000) {
-        printf("RTCM bandwidth: %.2f kB/s\n", (float) _bandwidthByteCounter / elapsed * 1000.f / 1024.f);
-        _bandwidthTimer.restart();
-        _bandwidthByteCounter = 0;
+    return RTCMParser::messageType(message.constData(), message.size());
+}
+
+RTCMMavlink::Priority_t RTCMMavlink::messagePriority(int messageType)
+{
+    if ((messageType >= 1001 && messageType <= 1012) ||     // Legacy GPS and GLONASS observations
+            (messageType >= 1071 && messageType <= 1137) || // MSM observations of all constellations
+            (messageType >= 1005 && messageType <= 1008) || // Station position and antenna
+            messageType == 1033) {                          // Receiver and antenna descriptor
+        return PriorityHigh;
+    }
+    if (messageType == 1019 || messageType == 1020 ||       // GPS and GLONASS ephemerides
+            (messageType >= 1041 && messageType <= 1046)) { // NavIC, QZSS, Galileo and BeiDou ephemerides
+        return PriorityLow;
     }
+    return PriorityNormal;
+}
 
+void RTCMMavlink::RTCMDataUpdate(QByteArray message)
+{
+    // Fragment once, the fragments are the same for every link
     const int maxMessageLength = MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN;
     mavlink_gps_rtcm_data_t mavlinkRtcmData;
     memset(&mavlinkRtcmData, 0, sizeof(mavlink_gps_rtcm_data_t));
 
+    Packet_t packet;
+    packet.priority = messagePriority(messageType(message));
+    packet.bytes    = 0;
+    packet.receivedTimer.start();
+
     if (message.size() < maxMessageLength) {
         mavlinkRtcmData.len = message.size();
         mavlinkRtcmData.flags = (_sequenceId & 0x1F) << 3;
         memcpy(&mavlinkRtcmData.data, message.data(), message.size());
-        sendMessageToVehicle(mavlinkRtcmData);
+        packet.fragments.append(mavlinkRtcmData);
     } else {
         // We need to fragment
 
@@ -53,31 +75,195 @@ void RTCMMavlink::RTCMDataUpdate(QByteArray message)
             mavlinkRtcmData.flags |= (_sequenceId & 0x1F) << 3;     // Next 5 bits are sequence id
             mavlinkRtcmData.len = length;
             memcpy(&mavlinkRtcmData.data, message.data() + start, length);
-            sendMessageToVehicle(mavlinkRtcmData);
+            packet.fragments.append(mavlinkRtcmData);
             start += length;
         }
     }
     ++_sequenceId;
+
+    for (const mavlink_gps_rtcm_data_t& fragment: packet.fragments) {
+        // flags and len ahead of the data, which is truncated on the wire
+        packet.bytes += MAVLINK_NUM_NON_PAYLOAD_BYTES + 2 + fragment.len;
+    }
+
+    const int bandwidthLimit = _bandwidthLimit();
+    for (const PrimaryLink_t& primaryLink: _primaryLinks()) {
+        LinkState_t& state = _linkState(primaryLink);
+        if (!bandwidthLimit && state.queue.isEmpty()) {
+            _sendPacket(state, primaryLink, packet);
+        } else {
+            state.queue.append(packet);
+            _flushQueue(state, primaryLink, bandwidthLimit);
+            if (!state.queue.isEmpty() && !_flushTimer.isActive()) {
+                _flushTimer.start();
+            }
+        }
+    }
+
+    if (_statusTimer.elapsed() >= statusIntervalMSecs) {
+        _updateLinkStatus();
+    }
 }
 
-void RTCMMavlink::sendMessageToVehicle(const mavlink_gps_rtcm_data_t& msg)
+int RTCMMavlink::_bandwidthLimit(void)
 {
+    return _toolbox.settingsManager()->rtkSettings()->rtcmBandwidthLimit()->rawValue().toInt();
+}
+
+QList<RTCMMavlink::PrimaryLink_t> RTCMMavlink::_primaryLinks(void)
+{
+    QList<PrimaryLink_t> primaryLinks;
+
     QmlObjectListModel& vehicles = *_toolbox.multiVehicleManager()->vehicles();
-    MAVLinkProtocol* mavlinkProtocol = _toolbox.mavlinkProtocol();
     for (int i = 0; i < vehicles.count(); i++) {
         Vehicle*                vehicle     = qobject_cast<Vehicle*>(vehicles[i]);
-        WeakLinkInterfacePtr    weakLink    = vehicle->vehicleLinkManager()->primaryLink();
-
-        if (!weakLink.expired()) {
-            mavlink_message_t       message;
-            SharedLinkInterfacePtr  sharedLink = weakLink.lock();
-
-            mavlink_msg_gps_rtcm_data_encode_chan(mavlinkProtocol->getSystemId(),
-                                                  mavlinkProtocol->getComponentId(),
-                                                  sharedLink->mavlinkChannel(),
-                                                  &message,
-                                                  &msg);
-            vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), message);
+        SharedLinkInterfacePtr  sharedLink  = vehicle->vehicleLinkManager()->primaryLink().lock();
+
+        if (!sharedLink) {
+            continue;
+        }
+        bool duplicate = false;
+        for (const PrimaryLink_t& primaryLink: primaryLinks) {
+            if (primaryLink.sharedLink == sharedLink) {
+                duplicate = true;
+                break;
+            }
+        }
+        if (!duplicate) {
+            primaryLinks.append({ sharedLink, vehicle });
+        }
+    }
+    return primaryLinks;
+}
+
+RTCMMavlink::LinkState_t& RTCMMavlink::_linkState(const PrimaryLink_t& primaryLink)
+{
+    LinkInterface*  link    = primaryLink.sharedLink.get();
+    LinkState_t&    state   = _linkStates[link];
+
+    // A new link may have been allocated where an old one was
+    if (state.weakLink.lock() != primaryLink.sharedLink) {
+        state = LinkState_t();
+        state.weakLink  = primaryLink.sharedLink;
+        state.name      = primaryLink.sharedLink->linkConfiguration()->name();
+    }
+    return state;
+}
+
+void RTCMMavlink::_flushQueue(LinkState_t& state, const PrimaryLink_t& primaryLink, int bandwidthLimit)
+{
+    for (int i = state.queue.count() - 1; i >= 0; i--) {
+        if (state.queue[i].receivedTimer.elapsed() > maxQueueMSecs) {
+            state.queue.removeAt(i);
+            state.droppedMessages++;
+        }
+    }
+
+    if (!bandwidthLimit) {
+        for (const Packet_t& packet: state.queue) {
+            _sendPacket(state, primaryLink, packet);
+        }
+        state.queue.clear();
+        return;
+    }
+
+    // The bucket holds at most a second worth of bandwidth
+    if (state.budgetTimer.isValid()) {
+        state.budgetBytes = std::min(state.budgetBytes + bandwidthLimit * state.budgetTimer.restart() / 1000.0, static_cast<double>(bandwidthLimit));
+    } else {
+        state.budgetTimer.start();
+        state.budgetBytes = bandwidthLimit;
+    }
+
+    while (!state.queue.isEmpty()) {
+        // Highest priority first, the oldest of those
+        int next = 0;
+        for (int i = 1; i < state.queue.count(); i++) {
+            if (state.queue[i].priority > state.queue[next].priority) {
+                next = i;
+            }
+        }
+        // A message larger than the limit goes out on a full bucket, otherwise it would block the queue
+        const Packet_t& packet = state.queue[next];
+        if (packet.bytes > state.budgetBytes && state.budgetBytes < bandwidthLimit) {
+            break;
         }
+        state.budgetBytes -= packet.bytes;
+        _sendPacket(state, primaryLink, packet);
+        state.queue.removeAt(next);
+    }
+}
+
+void RTCMMavlink::_sendPacket(LinkState_t& state, const PrimaryLink_t& primaryLink, const Packet_t& packet)
+{
+    MAVLinkProtocol* mavlinkProtocol = _toolbox.mavlinkProtocol();
+
+    for (const mavlink_gps_rtcm_data_t& fragment: packet.fragments) {
+        mavlink_message_t message;
+
+        mavlink_msg_gps_rtcm_data_encode_chan(mavlinkProtocol->getSystemId(),
+                                              mavlinkProtocol->getComponentId(),
+                                              primaryLink.sharedLink->mavlinkChannel(),
+                                              &message,
+                                              &fragment);
+        primaryLink.vehicle->sendMessageOnLinkThreadSafe(primaryLink.sharedLink.get(), message);
+    }
+
+    state.sentBytes         += packet.bytes;
+    state.latencySumMSecs   += packet.receivedTimer.elapsed();
+    state.latencyCount++;
+    state.lastSentTimer.start();
+}
+
+void RTCMMavlink::_flushQueues(void)
+{
+    const int   bandwidthLimit  = _bandwidthLimit();
+    bool        queued          = false;
+
+    for (const PrimaryLink_t& primaryLink: _primaryLinks()) {
+        LinkState_t& state = _linkState(primaryLink);
+        if (!state.queue.isEmpty()) {
+            _flushQueue(state, primaryLink, bandwidthLimit);
+            queued |= !state.queue.isEmpty();
+        }
+    }
+    if (!queued) {
+        _flushTimer.stop();
+    }
+
+    if (_statusTimer.elapsed() >= statusIntervalMSecs) {
+        _updateLinkStatus();
+    }
+}
+
+void RTCMMavlink::_updateLinkStatus(void)
+{
+    const qint64 elapsed = _statusTimer.restart();
+
+    _linkStatus.clear();
+    for (auto it = _linkStates.begin(); it != _linkStates.end(); ) {
+        LinkState_t& state = it.value();
+        if (state.weakLink.expired()) {
+            it = _linkStates.erase(it);
+            continue;
+        }
+
+        LinkStatus_t status;
+        status.name                 = state.name;
+        status.bytesPerSecond       = elapsed ? state.sentBytes * 1000.0 / elapsed : 0;
+        status.meanLatencyMSecs     = state.latencyCount ? static_cast<double>(state.latencySumMSecs) / state.latencyCount : 0;
+        status.ageMSecs             = state.lastSentTimer.isValid() ? state.lastSentTimer.elapsed() : -1;
+        status.queuedMessages       = state.queue.count();
+        status.droppedMessages      = state.droppedMessages;
+        _linkStatus.append(status);
+
+        qCDebug(RTCMMavlinkLog) << "link:bytesPerSecond:meanLatencyMSecs:ageMSecs:queued:dropped"
+                                << status.name << status.bytesPerSecond << status.meanLatencyMSecs << status.ageMSecs << status.queuedMessages << status.droppedMessages;
+
+        state.sentBytes         = 0;
+        state.latencySumMSecs   = 0;
+        state.latencyCount      = 0;
+        ++it;
     }
+    emit linkStatusChanged();
 }
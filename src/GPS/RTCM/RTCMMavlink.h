@@ -12,13 +12,27 @@
 
 #include <QObject>
 #include <QElapsedTimer>
+#include <QMap>
+#include <QVector>
 
 #include "QGCToolbox.h"
+#include "QGCLoggingCategory.h"
+#include "QGCTimerWheel.h"
 #include "MAVLinkProtocol.h"
+#include "LinkInterface.h"
+
+Q_DECLARE_LOGGING_CATEGORY(RTCMMavlinkLog)
+
+class Vehicle;
 
 /**
  ** class RTCMMavlink
  * Receives RTCM updates and sends them via MAVLINK to the device
+ *
+ * GPS_RTCM_DATA has no target, so each RTCM message is fragmented once and sent once on every link which is the
+ * primary link of a vehicle, no matter how many vehicles share that link. With a bandwidth limit each link has a
+ * token bucket and a queue, high priority messages (observations, station position) go out first and messages
+ * which waited longer than maxQueueMSecs are dropped.
  */
 class RTCMMavlink : public QObject
 {
@@ -27,14 +41,81 @@ public:
     RTCMMavlink(QGCToolbox& toolbox);
     //TODO: API to select device(s)?
 
+    typedef enum {
+        PriorityLow,        ///< Ephemerides, only needed after a change
+        PriorityNormal,
+        PriorityHigh,       ///< Observations and station position, useless when late
+    } Priority_t;
+
+    typedef struct {
+        QString name;
+        double  bytesPerSecond;     ///< Over the last status interval
+        double  meanLatencyMSecs;   ///< From RTCMDataUpdate to the link, over the last status interval
+        qint64  ageMSecs;           ///< Since corrections were last sent on the link, -1 for never
+        int     queuedMessages;
+        int     droppedMessages;    ///< Since the link was first used
+    } LinkStatus_t;
+
+    /// @return Status of each link corrections are sent on, updated every statusIntervalMSecs
+    QList<LinkStatus_t> linkStatus(void) const { return _linkStatus; }
+
+    /// @return RTCM 3 message type of message, -1 if it isn't an RTCM 3 frame
+    static int messageType(const QByteArray& message);
+
+    static Priority_t messagePriority(int messageType);
+
+    static const int maxQueueMSecs          = 1000;
+    static const int flushIntervalMSecs     = 50;
+    static const int statusIntervalMSecs    = 1000;
+
 public slots:
     void RTCMDataUpdate(QByteArray message);
 
+signals:
+    void linkStatusChanged(void);
+
+private slots:
+    void _flushQueues(void);
+
 private:
-    void sendMessageToVehicle(const mavlink_gps_rtcm_data_t& msg);
+    typedef struct {
+        Priority_t                          priority;
+        int                                 bytes;          ///< On the wire, for the bandwidth budget
+        QElapsedTimer                       receivedTimer;
+        QVector<mavlink_gps_rtcm_data_t>    fragments;
+    } Packet_t;
+
+    typedef struct {
+        SharedLinkInterfacePtr  sharedLink;
+        Vehicle*                vehicle;        ///< One of the vehicles using the link as primary link
+    } PrimaryLink_t;
+
+    typedef struct {
+        WeakLinkInterfacePtr    weakLink;
+        QString                 name;
+        QList<Packet_t>         queue;
+        double                  budgetBytes     = 0;
+        QElapsedTimer           budgetTimer;
+        QElapsedTimer           lastSentTimer;
+        qint64                  latencySumMSecs = 0;
+        int                     latencyCount    = 0;
+        int                     sentBytes       = 0;
+        int                     droppedMessages = 0;
+    } LinkState_t;
+
+    /// @return Each physical link which is the primary link of at least one vehicle
+    QList<PrimaryLink_t> _primaryLinks(void);
+
+    LinkState_t&    _linkState          (const PrimaryLink_t& primaryLink);
+    void            _flushQueue         (LinkState_t& state, const PrimaryLink_t& primaryLink, int bandwidthLimit);
+    void            _sendPacket         (LinkState_t& state, const PrimaryLink_t& primaryLink, const Packet_t& packet);
+    int             _bandwidthLimit     (void);
+    void            _updateLinkStatus   (void);
 
-    QGCToolbox& _toolbox;
-    QElapsedTimer _bandwidthTimer;
-    int _bandwidthByteCounter = 0;
-    uint8_t _sequenceId = 0;
+    QGCToolbox&                         _toolbox;
+    QMap<LinkInterface*, LinkState_t>   _linkStates;
+    QList<LinkStatus_t>                 _linkStatus;
+    QElapsedTimer                       _statusTimer;
+    QGCWheelTimer                       _flushTimer     { QStringLiteral("RTCM") };
+    uint8_t                             _sequenceId     = 0;
 };
@@ -0,0 +1,94 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "RTCMParser.h"
+
+#include <array>
+
+int RTCMParser::parse(const char* data, int length, QVector<Frame_t>& frames)
+{
+    const quint8*   bytes   = reinterpret_cast<const quint8*>(data);
+    int             i       = 0;
+
+    while (i < length) {
+        if (bytes[i] != preamble) {
+            _skippedBytes++;
+            i++;
+            continue;
+        }
+        if (length - i < headerLength) {
+            break;
+        }
+        // The reserved bits are zero, otherwise this is a data byte which happens to look like the preamble
+        if (bytes[i + 1] & 0xFC) {
+            _skippedBytes++;
+            i++;
+            continue;
+        }
+
+        const int payloadLength = ((bytes[i + 1] & 0x03) << 8) | bytes[i + 2];
+        const int frameLength   = headerLength + payloadLength + crcLength;
+        if (length - i < frameLength) {
+            break;
+        }
+
+        const quint8*   crcBytes    = bytes + i + headerLength + payloadLength;
+        const quint32   frameCrc    = (static_cast<quint32>(crcBytes[0]) << 16) | (static_cast<quint32>(crcBytes[1]) << 8) | crcBytes[2];
+        if (crc24q(data + i, headerLength + payloadLength) != frameCrc) {
+            // Resync on the next preamble, which may be inside this frame
+            _crcErrorCount++;
+            _skippedBytes++;
+            i++;
+            continue;
+        }
+
+        const int type = payloadLength >= 2 ? messageType(data + i, frameLength) : 0;
+        frames.append({ data + i, frameLength, type });
+        _frameCount++;
+        _messageCounts[type]++;
+        i += frameLength;
+    }
+
+    return i;
+}
+
+quint32 RTCMParser::crc24q(const char* data, int length)
+{
+    static const std::array<quint32, 256> table = [] {
+        std::array<quint32, 256> crcTable;
+        for (quint32 i = 0; i < 256; i++) {
+            quint32 crc = i << 16;
+            for (int bit = 0; bit < 8; bit++) {
+                crc <<= 1;
+                if (crc & 0x1000000) {
+                    crc ^= 0x1864CFB;
+                }
+            }
+            crcTable[i] = crc & 0xFFFFFF;
+        }
+        return crcTable;
+    }();
+
+    const quint8*   bytes   = reinterpret_cast<const quint8*>(data);
+    quint32         crc     = 0;
+    for (int i = 0; i < length; i++) {
+        crc = ((crc << 8) & 0xFFFFFF) ^ table[((crc >> 16) ^ bytes[i]) & 0xFF];
+    }
+    return crc;
+}
+
+int RTCMParser::messageType(const char* frame, int length)
+{
+    const quint8* bytes = reinterpret_cast<const quint8*>(frame);
+
+    if (length < headerLength + 2 || bytes[0] != preamble) {
+        return -1;
+    }
+    return (bytes[headerLength] << 4) | (bytes[headerLength + 1] >> 4);
+}
@@ -0,0 +1,55 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QHash>
+#include <QVector>
+
+/// Finds RTCM 3 frames in a byte stream. Frames are verified with CRC-24Q and handed out as pointers into the
+/// received data, nothing is copied. Bytes which are not part of a valid frame are skipped, so the parser
+/// resynchronizes on the next preamble after garbage or a corrupted frame.
+class RTCMParser
+{
+public:
+    typedef struct {
+        const char* data;           ///< Points into the data given to parse, preamble through CRC
+        int         length;
+        int         messageType;    ///< 12 bit message number, 0 for an empty frame
+    } Frame_t;
+
+    /// Finds all complete frames in data
+    ///     @param frames Found frames are appended, they are valid as long as data is
+    /// @return Number of bytes used, the rest is the start of an incomplete frame
+    int parse(const char* data, int length, QVector<Frame_t>& frames);
+
+    quint32 frameCount      (void) const { return _frameCount; }
+    quint32 crcErrorCount   (void) const { return _crcErrorCount; }
+    quint32 skippedBytes    (void) const { return _skippedBytes; }
+
+    /// @return Number of frames received for each message type
+    const QHash<int, quint32>& messageCounts(void) const { return _messageCounts; }
+
+    /// @return CRC-24Q over data, as used by RTCM 3 and SBAS
+    static quint32 crc24q(const char* data, int length);
+
+    /// @param frame At least the header and the first two payload bytes
+    /// @return 12 bit message number, -1 if frame isn't the start of an RTCM 3 frame
+    static int messageType(const char* frame, int length);
+
+    static const quint8 preamble        = 0xD3;
+    static const int    headerLength    = 3;        ///< Preamble, 6 reserved bits and 10 bits payload length
+    static const int    crcLength       = 3;
+
+private:
+    quint32             _frameCount     = 0;
+    quint32             _crcErrorCount  = 0;
+    quint32             _skippedBytes   = 0;
+    QHash<int, quint32> _messageCounts;
+};
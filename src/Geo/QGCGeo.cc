@@ -9,8 +9,12 @@
 
 #include <QDebug>
 #include <QString>
+#include <QVector>
+#include <QPair>
 
+#include <algorithm>
 #include <cmath>
+#include <functional>
 #include <limits>
 
 #include "QGCGeo.h"
@@ -26,7 +30,36 @@ static const double epsilon = std::numeric_limits<double>::epsilon();
 
 void convertGeoToNed(QGeoCoordinate coord, QGeoCoordinate origin, double* x, double* y, double* z)
 {
-    if (coord == origin) {
+    QGCTangentPlane(origin).geoToNed(coord, x, y, z);
+}
+
+void convertNedToGeo(double x, double y, double z, QGeoCoordinate origin, QGeoCoordinate *coord) {
+    QGCTangentPlane(origin).nedToGeo(x, y, z, coord);
+}
+
+void convertGeoToNed(const double* latitudes, const double* longitudes, int count, const QGeoCoordinate& origin, double* north, double* east)
+{
+    QGCTangentPlane(origin).geoToNed(latitudes, longitudes, north, east, count);
+}
+
+void convertNedToGeo(const double* north, const double* east, int count, const QGeoCoordinate& origin, double* latitudes, double* longitudes)
+{
+    QGCTangentPlane(origin).nedToGeo(north, east, latitudes, longitudes, count);
+}
+
+QGCTangentPlane::QGCTangentPlane(const QGeoCoordinate& origin)
+    : _origin   (origin)
+    , _refLatRad(origin.latitude() * M_DEG_TO_RAD)
+    , _refLonRad(origin.longitude() * M_DEG_TO_RAD)
+    , _refSinLat(sin(_refLatRad))
+    , _refCosLat(cos(_refLatRad))
+{
+
+}
+
+void QGCTangentPlane::geoToNed(const QGeoCoordinate& coord, double* x, double* y, double* z) const
+{
+    if (coord == _origin) {
         // Short circuit to prevent NaNs in calculation
         *x = *y = *z = 0;
         return;
@@ -35,54 +68,233 @@ void convertGeoToNed(QGeoCoordinate coord, QGeoCoordinate origin, double* x, dou
     double lat_rad = coord.latitude() * M_DEG_TO_RAD;
     double lon_rad = coord.longitude() * M_DEG_TO_RAD;
 
-    double ref_lon_rad = origin.longitude() * M_DEG_TO_RAD;
-    double ref_lat_rad = origin.latitude() * M_DEG_TO_RAD;
-
     double sin_lat = sin(lat_rad);
     double cos_lat = cos(lat_rad);
-    double cos_d_lon = cos(lon_rad - ref_lon_rad);
-
-    double ref_sin_lat = sin(ref_lat_rad);
-    double ref_cos_lat = cos(ref_lat_rad);
+    double cos_d_lon = cos(lon_rad - _refLonRad);
 
-    double c = acos(ref_sin_lat * sin_lat + ref_cos_lat * cos_lat * cos_d_lon);
+    double c = acos(_refSinLat * sin_lat + _refCosLat * cos_lat * cos_d_lon);
     double k = (fabs(c) < epsilon) ? 1.0 : (c / sin(c));
 
-    *x = k * (ref_cos_lat * sin_lat - ref_sin_lat * cos_lat * cos_d_lon) * CONSTANTS_RADIUS_OF_EARTH;
-    *y = k * cos_lat * sin(lon_rad - ref_lon_rad) * CONSTANTS_RADIUS_OF_EARTH;
+    *x = k * (_refCosLat * sin_lat - _refSinLat * cos_lat * cos_d_lon) * CONSTANTS_RADIUS_OF_EARTH;
+    *y = k * cos_lat * sin(lon_rad - _refLonRad) * CONSTANTS_RADIUS_OF_EARTH;
 
-    *z = -(coord.altitude() - origin.altitude());
+    *z = -(coord.altitude() - _origin.altitude());
 }
 
-void convertNedToGeo(double x, double y, double z, QGeoCoordinate origin, QGeoCoordinate *coord) {
+void QGCTangentPlane::nedToGeo(double x, double y, double z, QGeoCoordinate* coord) const
+{
     double x_rad = x / CONSTANTS_RADIUS_OF_EARTH;
     double y_rad = y / CONSTANTS_RADIUS_OF_EARTH;
     double c = sqrt(x_rad * x_rad + y_rad * y_rad);
     double sin_c = sin(c);
     double cos_c = cos(c);
 
-    double ref_lon_rad = origin.longitude() * M_DEG_TO_RAD;
-    double ref_lat_rad = origin.latitude() * M_DEG_TO_RAD;
-
-    double ref_sin_lat = sin(ref_lat_rad);
-    double ref_cos_lat = cos(ref_lat_rad);
-
     double lat_rad;
     double lon_rad;
 
     if (fabs(c) > epsilon) {
-        lat_rad = asin(cos_c * ref_sin_lat + (x_rad * sin_c * ref_cos_lat) / c);
-        lon_rad = (ref_lon_rad + atan2(y_rad * sin_c, c * ref_cos_lat * cos_c - x_rad * ref_sin_lat * sin_c));
+        lat_rad = asin(cos_c * _refSinLat + (x_rad * sin_c * _refCosLat) / c);
+        lon_rad = (_refLonRad + atan2(y_rad * sin_c, c * _refCosLat * cos_c - x_rad * _refSinLat * sin_c));
 
     } else {
-        lat_rad = ref_lat_rad;
-        lon_rad = ref_lon_rad;
+        lat_rad = _refLatRad;
+        lon_rad = _refLonRad;
     }
 
     coord->setLatitude(lat_rad * M_RAD_TO_DEG);
     coord->setLongitude(lon_rad * M_RAD_TO_DEG);
 
-    coord->setAltitude(-z + origin.altitude());
+    coord->setAltitude(-z + _origin.altitude());
+}
+
+void QGCTangentPlane::geoToNed(const double* latitudes, const double* longitudes, double* north, double* east, int count) const
+{
+    for (int i=0; i<count; i++) {
+        double lat_rad = latitudes[i] * M_DEG_TO_RAD;
+        double d_lon = longitudes[i] * M_DEG_TO_RAD - _refLonRad;
+
+        double sin_lat = sin(lat_rad);
+        double cos_lat = cos(lat_rad);
+        double cos_d_lon = cos(d_lon);
+
+        // Rounding can take the cosine just past 1 for points at the origin, clamping it gives c = 0 instead of nan
+        double cos_c = std::min(1.0, std::max(-1.0, _refSinLat * sin_lat + _refCosLat * cos_lat * cos_d_lon));
+        double c = acos(cos_c);
+        double k = (c < epsilon) ? 1.0 : (c / sin(c));
+
+        north[i] = k * (_refCosLat * sin_lat - _refSinLat * cos_lat * cos_d_lon) * CONSTANTS_RADIUS_OF_EARTH;
+        east[i] = k * cos_lat * sin(d_lon) * CONSTANTS_RADIUS_OF_EARTH;
+    }
+}
+
+void QGCTangentPlane::nedToGeo(const double* north, const double* east, double* latitudes, double* longitudes, int count) const
+{
+    for (int i=0; i<count; i++) {
+        double x_rad = north[i] / CONSTANTS_RADIUS_OF_EARTH;
+        double y_rad = east[i] / CONSTANTS_RADIUS_OF_EARTH;
+        double c = sqrt(x_rad * x_rad + y_rad * y_rad);
+        double sin_c = sin(c);
+        double cos_c = cos(c);
+
+        // Points at the origin select the origin rather than branching around the division by c
+        bool atOrigin = c <= epsilon;
+        double safe_c = atOrigin ? 1.0 : c;
+        double lat_rad = asin(std::min(1.0, std::max(-1.0, cos_c * _refSinLat + (x_rad * sin_c * _refCosLat) / safe_c)));
+        double lon_rad = _refLonRad + atan2(y_rad * sin_c, c * _refCosLat * cos_c - x_rad * _refSinLat * sin_c);
+
+        latitudes[i] = (atOrigin ? _refLatRad : lat_rad) * M_RAD_TO_DEG;
+        longitudes[i] = (atOrigin ? _refLonRad : lon_rad) * M_RAD_TO_DEG;
+    }
+}
+
+QList<QPointF> QGCTangentPlane::geoToEastNorth(const QList<QGeoCoordinate>& coords) const
+{
+    int             count = coords.count();
+    QVector<double> buffer(count * 4);
+    double*         latitudes = buffer.data();
+    double*         longitudes = latitudes + count;
+    double*         north = longitudes + count;
+    double*         east = north + count;
+
+    for (int i=0; i<count; i++) {
+        latitudes[i] = coords[i].latitude();
+        longitudes[i] = coords[i].longitude();
+    }
+    geoToNed(latitudes, longitudes, north, east, count);
+
+    QList<QPointF> points;
+    points.reserve(count);
+    for (int i=0; i<count; i++) {
+        points.append(QPointF(east[i], north[i]));
+    }
+
+    return points;
+}
+
+QList<QGeoCoordinate> QGCTangentPlane::eastNorthToGeo(const QList<QPointF>& points) const
+{
+    int             count = points.count();
+    QVector<double> buffer(count * 4);
+    double*         north = buffer.data();
+    double*         east = north + count;
+    double*         latitudes = east + count;
+    double*         longitudes = latitudes + count;
+
+    for (int i=0; i<count; i++) {
+        north[i] = points[i].y();
+        east[i] = points[i].x();
+    }
+    nedToGeo(north, east, latitudes, longitudes, count);
+
+    QList<QGeoCoordinate> coords;
+    coords.reserve(count);
+    for (int i=0; i<count; i++) {
+        coords.append(QGeoCoordinate(latitudes[i], longitudes[i], _origin.altitude()));
+    }
+
+    return coords;
+}
+
+/// Runs Douglas-Peucker over the points, exploring only splits farther than toleranceMeters. Each point which splits a
+/// range gets the distance it was split at, clamped to that of the point which split its parent range, so the points
+/// kept at a larger tolerance are always those with larger significance. Points never split are left at -1.
+static QVector<double> _douglasPeuckerSignificance(const QList<QPointF>& points, double toleranceMeters)
+{
+    QVector<double>             significance(points.count(), -1);
+    QVector<QPair<int, int>>    ranges;
+
+    significance[0] = significance[points.count() - 1] = std::numeric_limits<double>::infinity();
+    ranges.append(qMakePair(0, points.count() - 1));
+
+    // Iterative rather than recursive so a long path with no simplification possible can't overflow the stack
+    while (!ranges.isEmpty()) {
+        QPair<int, int> range = ranges.takeLast();
+        const QPointF&  start = points[range.first];
+        const QPointF&  end = points[range.second];
+        QPointF         direction = end - start;
+        double          lengthSquared = QPointF::dotProduct(direction, direction);
+
+        int     farthestIndex = -1;
+        double  farthestDistance = toleranceMeters;
+        for (int i=range.first + 1; i<range.second; i++) {
+            QPointF offset = points[i] - start;
+            double distance;
+            if (lengthSquared < epsilon) {
+                distance = sqrt(QPointF::dotProduct(offset, offset));
+            } else {
+                // Distance to the segment, not the infinite line, so points past either end are measured to that end
+                double t = qBound(0.0, QPointF::dotProduct(offset, direction) / lengthSquared, 1.0);
+                QPointF delta = offset - (direction * t);
+                distance = sqrt(QPointF::dotProduct(delta, delta));
+            }
+            if (distance > farthestDistance) {
+                farthestDistance = distance;
+                farthestIndex = i;
+            }
+        }
+
+        if (farthestIndex != -1) {
+            // The parent of a range is whichever of its ends was split last, which is the one with lower significance
+            double parentSignificance = qMin(significance[range.first], significance[range.second]);
+            significance[farthestIndex] = qMin(farthestDistance, parentSignificance);
+            ranges.append(qMakePair(range.first, farthestIndex));
+            ranges.append(qMakePair(farthestIndex, range.second));
+        }
+    }
+
+    return significance;
+}
+
+QList<QGeoCoordinate> simplifyPath(const QList<QGeoCoordinate>& path, double toleranceMeters)
+{
+    if (path.count() < 3) {
+        return path;
+    }
+
+    QVector<double> significance = _douglasPeuckerSignificance(QGCTangentPlane(path.first()).geoToEastNorth(path), toleranceMeters);
+
+    QList<QGeoCoordinate> simplifiedPath;
+    for (int i=0; i<path.count(); i++) {
+        if (significance[i] >= 0) {
+            simplifiedPath.append(path[i]);
+        }
+    }
+
+    return simplifiedPath;
+}
+
+QList<QGeoCoordinate> simplifyPathToCount(const QList<QGeoCoordinate>& path, int maxCount)
+{
+    if (path.count() <= maxCount || path.count() < 3) {
+        return path;
+    }
+    maxCount = qMax(maxCount, 2);
+
+    // A full Douglas-Peucker pass ranks every point, the tolerance which keeps maxCount points is then the significance
+    // of the maxCount'th point.
+    QVector<double> significance = _douglasPeuckerSignificance(QGCTangentPlane(path.first()).geoToEastNorth(path), -1);
+    QVector<double> ranked = significance;
+    std::nth_element(ranked.begin(), ranked.begin() + (maxCount - 1), ranked.end(), std::greater<double>());
+    double threshold = ranked[maxCount - 1];
+
+    // Points tied with the threshold are only taken until the count is reached
+    int aboveCount = 0;
+    for (double value: significance) {
+        if (value > threshold) {
+            aboveCount++;
+        }
+    }
+    int tiedCount = maxCount - aboveCount;
+
+    QList<QGeoCoordinate> simplifiedPath;
+    simplifiedPath.reserve(maxCount);
+    for (int i=0; i<path.count(); i++) {
+        if (significance[i] > threshold || (significance[i] == threshold && tiedCount-- > 0)) {
+            simplifiedPath.append(path[i]);
+        }
+    }
+
+    return simplifiedPath;
 }
 
 int convertGeoToUTM(const QGeoCoordinate& coord, double& easting, double& northing)
@@ -111,6 +323,35 @@ bool convertUTMToGeo(double easting, double northing, int zone, bool southhemi,
     return true;
 }
 
+int convertGeoToUTM(const double* latitudes, const double* longitudes, int count, double* eastings, double* northings)
+{
+    if (count == 0) {
+        return 0;
+    }
+
+    try {
+        int zone;
+        bool northp;
+        double easting, northing;
+        GeographicLib::UTMUPS::Forward(latitudes[0], longitudes[0], zone, northp, easting, northing);
+        GeographicLib::UTMUPS::Forward(zone, northp, latitudes, longitudes, eastings, northings, count);
+        return zone;
+    } catch(...) {
+        return 0;
+    }
+}
+
+bool convertUTMToGeo(const double* eastings, const double* northings, int count, int zone, bool southhemi, double* latitudes, double* longitudes)
+{
+    try {
+        GeographicLib::UTMUPS::Reverse(zone, !southhemi, eastings, northings, latitudes, longitudes, count);
+    } catch(...) {
+        return false;
+    }
+
+    return true;
+}
+
 QString convertGeoToMGRS(const QGeoCoordinate& coord)
 {
     int zone;
@@ -19,6 +19,8 @@
 #define QGCGEO_H
 
 #include <QGeoCoordinate>
+#include <QList>
+#include <QPointF>
 
 /**
  * @brief Project a geodetic coordinate on to local tangential plane (LTP) as coordinate with East,
@@ -41,6 +43,70 @@ void convertGeoToNed(QGeoCoordinate coord, QGeoCoordinate origin, double* x, dou
  */
 void convertNedToGeo(double x, double y, double z, QGeoCoordinate origin, QGeoCoordinate *coord);
 
+/// Batch version of convertGeoToNed for points held in separate latitude and longitude buffers, down is left out.
+/// See QGCTangentPlane::geoToNed.
+void convertGeoToNed(const double* latitudes, const double* longitudes, int count, const QGeoCoordinate& origin, double* north, double* east);
+
+/// Batch version of convertNedToGeo, output in degrees. See QGCTangentPlane::nedToGeo.
+void convertNedToGeo(const double* north, const double* east, int count, const QGeoCoordinate& origin, double* latitudes, double* longitudes);
+
+/// Local tangent plane around a fixed origin, using the same math as convertGeoToNed/convertNedToGeo.
+///
+/// The origin terms are computed once at construction so converting all the vertices of a polygon, polyline or
+/// set of transects only pays for the per point trigonometry.
+class QGCTangentPlane
+{
+public:
+    QGCTangentPlane(const QGeoCoordinate& origin);
+
+    const QGeoCoordinate& origin(void) const { return _origin; }
+
+    /// Same results as convertGeoToNed(coord, origin(), x, y, z)
+    void geoToNed(const QGeoCoordinate& coord, double* x, double* y, double* z) const;
+
+    /// Same results as convertNedToGeo(x, y, z, origin(), coord)
+    void nedToGeo(double x, double y, double z, QGeoCoordinate* coord) const;
+
+    /// Batch version of geoToNed for count points held in separate buffers, down is left out. The loop has no branches
+    /// so it can be vectorized, and points at the origin come out as 0,0 without the special case.
+    void geoToNed(const double* latitudes, const double* longitudes, double* north, double* east, int count) const;
+
+    /// Batch version of nedToGeo for count points, output in degrees
+    void nedToGeo(const double* north, const double* east, double* latitudes, double* longitudes, int count) const;
+
+    /// Converts a list of coordinates to points with x east and y north, altitude is ignored
+    QList<QPointF>          geoToEastNorth(const QList<QGeoCoordinate>& coords) const;
+
+    /// Converts a list of points with x east and y north back to coordinates at the origin altitude
+    QList<QGeoCoordinate>   eastNorthToGeo(const QList<QPointF>& points) const;
+
+private:
+    QGeoCoordinate  _origin;
+    double          _refLatRad;
+    double          _refLonRad;
+    double          _refSinLat;
+    double          _refCosLat;
+};
+
+/**
+ * @brief Simplify a path with the Douglas-Peucker algorithm.
+ * @param[in] path Coordinates of the path.
+ * @param[in] toleranceMeters Points closer than this to the simplified path are dropped.
+ * @return The simplified path. The first and last coordinates are always kept, altitude is carried through from the
+ * kept coordinates.
+ */
+QList<QGeoCoordinate> simplifyPath(const QList<QGeoCoordinate>& path, double toleranceMeters);
+
+/**
+ * @brief Simplify a path with the Douglas-Peucker algorithm down to a number of points.
+ * @param[in] path Coordinates of the path.
+ * @param[in] maxCount Number of points to keep, at least 2.
+ * @return The simplified path. Points are kept in the order simplifyPath would keep them as the tolerance is lowered,
+ * so this matches simplifyPath at the tolerance which leaves maxCount points. Equally significant points are taken
+ * from the start of the path until the count is reached.
+ */
+QList<QGeoCoordinate> simplifyPathToCount(const QList<QGeoCoordinate>& path, int maxCount);
+
 // LatLonToUTMXY
 // Converts a latitude/longitude pair to x and y coordinates in the
 // Universal Transverse Mercator projection.
@@ -61,6 +127,18 @@ void convertNedToGeo(double x, double y, double z, QGeoCoordinate origin, QGeoCo
 //   If conversion failed the function returns 0
 int convertGeoToUTM(const QGeoCoordinate& coord, double& easting, double& northing);
 
+// Batch version of convertGeoToUTM. All the points are converted in the zone
+// and hemisphere of the first one, so a polygon which crosses a zone boundary
+// stays in one grid.
+//
+// Outputs:
+//   eastings, northings - Must have room for count values, NaN for points
+//                         which are out of range for the zone
+//
+// Returns:
+//   The UTM zone used, 0 if the first point can't be converted
+int convertGeoToUTM(const double* latitudes, const double* longitudes, int count, double* eastings, double* northings);
+
 // UTMXYToLatLon
 //
 // Converts x and y coordinates in the Universal Transverse Mercator//   The UTM zone parameter should be in the range [1,60].
@@ -82,6 +160,13 @@ int convertGeoToUTM(const QGeoCoordinate& coord, double& easting, double& northi
 // The function returns true if conversion succeeded.
 bool convertUTMToGeo(double easting, double northing, int zone, bool southhemi, QGeoCoordinate& coord);
 
+// Batch version of convertUTMToGeo, output in degrees. Points which are out of
+// range for the zone give NaN latitude and longitude.
+//
+// Returns:
+// false if the zone is invalid
+bool convertUTMToGeo(const double* eastings, const double* northings, int count, int zone, bool southhemi, double* latitudes, double* longitudes);
+
 // Converts a latitude/longitude pair to MGRS string
 //
 // Inputs:
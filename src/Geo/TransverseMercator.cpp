@@ -593,4 +593,19 @@ namespace GeographicLib {
     k *= _k0;
   }
 
+  void TransverseMercator::Forward(real lon0, const real* lat,
+                                   const real* lon, real* x, real* y,
+                                   int count) const {
+    real gamma, k;
+    for (int i = 0; i < count; ++i)
+      Forward(lon0, lat[i], lon[i], x[i], y[i], gamma, k);
+  }
+
+  void TransverseMercator::Reverse(real lon0, const real* x, const real* y,
+                                   real* lat, real* lon, int count) const {
+    real gamma, k;
+    for (int i = 0; i < count; ++i)
+      Reverse(lon0, x[i], y[i], lat[i], lon[i], gamma, k);
+  }
+
 } // namespace GeographicLib
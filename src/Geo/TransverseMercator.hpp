@@ -165,6 +165,20 @@ namespace GeographicLib {
       Reverse(lon0, x, y, lat, lon, gamma, k);
     }
 
+    /**
+     * TransverseMercator::Forward for \e count points about the same central
+     * meridian, without returning the convergence and scale.
+     **********************************************************************/
+    void Forward(real lon0, const real* lat, const real* lon,
+                 real* x, real* y, int count) const;
+
+    /**
+     * TransverseMercator::Reverse for \e count points about the same central
+     * meridian, without returning the convergence and scale.
+     **********************************************************************/
+    void Reverse(real lon0, const real* x, const real* y,
+                 real* lat, real* lon, int count) const;
+
     /** \name Inspector functions
      **********************************************************************/
     ///@{
@@ -13,6 +13,8 @@
 #include "TransverseMercator.hpp"
 #include "Utility.hpp"
 
+#include <vector>
+
 namespace GeographicLib {
 
   using namespace std;
@@ -137,6 +139,63 @@ namespace GeographicLib {
       PolarStereographic::UPS().Reverse(northp, x, y, lat, lon, gamma, k);
   }
 
+  void UTMUPS::Forward(int zone, bool northp, const real* lat,
+                       const real* lon, real* x, real* y, int count) {
+    if (!(zone >= MINZONE && zone <= MAXZONE))
+      throw GeographicErr("Zone " + Utility::str(zone)
+                          + " not in range [0, 60]");
+    bool utmp = zone != UPS;
+    int ind = (utmp ? 2 : 0) + (northp ? 1 : 0);
+    if (utmp)
+      TransverseMercator::UTM().Forward(CentralMeridian(zone),
+                                        lat, lon, x, y, count);
+    else {
+      real gamma, k;
+      for (int i = 0; i < count; ++i)
+        PolarStereographic::UPS().Forward(northp, lat[i], lon[i],
+                                          x[i], y[i], gamma, k);
+    }
+    for (int i = 0; i < count; ++i) {
+      x[i] += falseeasting_[ind];
+      y[i] += falsenorthing_[ind];
+      if (abs(lat[i]) > 90 ||
+          !CheckCoords(utmp, northp, x[i], y[i], false, false))
+        x[i] = y[i] = Math::NaN();
+    }
+  }
+
+  void UTMUPS::Reverse(int zone, bool northp, const real* x, const real* y,
+                       real* lat, real* lon, int count) {
+    if (!(zone >= MINZONE && zone <= MAXZONE))
+      throw GeographicErr("Zone " + Utility::str(zone)
+                          + " not in range [0, 60]");
+    bool utmp = zone != UPS;
+    int ind = (utmp ? 2 : 0) + (northp ? 1 : 0);
+    vector<real> x1(count), y1(count);
+    for (int i = 0; i < count; ++i) {
+      if (Math::isnan(x[i]) || Math::isnan(y[i]) ||
+          !CheckCoords(utmp, northp, x[i], y[i], false, false))
+        x1[i] = y1[i] = Math::NaN();
+      else {
+        x1[i] = x[i] - falseeasting_[ind];
+        y1[i] = y[i] - falsenorthing_[ind];
+      }
+    }
+    if (utmp)
+      TransverseMercator::UTM().Reverse(CentralMeridian(zone),
+                                        x1.data(), y1.data(), lat, lon, count);
+    else {
+      real gamma, k;
+      for (int i = 0; i < count; ++i)
+        PolarStereographic::UPS().Reverse(northp, x1[i], y1[i],
+                                          lat[i], lon[i], gamma, k);
+    }
+    for (int i = 0; i < count; ++i) {
+      if (Math::isnan(x1[i]))
+        lat[i] = lon[i] = Math::NaN();
+    }
+  }
+
   bool UTMUPS::CheckCoords(bool utmp, bool northp, real x, real y,
                            bool mgrslimits, bool throwp) {
     // Limits are all multiples of 100km and are all closed on the both ends.
@@ -282,6 +282,44 @@ namespace GeographicLib {
       Reverse(zone, northp, x, y, lat, lon, gamma, k, mgrslimits);
     }
 
+    /**
+     * Forward projection of \e count points into one zone and hemisphere.
+     *
+     * @param[in] zone the UTM zone (zero means UPS).
+     * @param[in] northp hemisphere (true means north, false means south).
+     * @param[in] lat latitudes of the points (degrees).
+     * @param[in] lon longitudes of the points (degrees).
+     * @param[out] x eastings of the points (meters).
+     * @param[out] y northings of the points (meters).
+     * @param[in] count number of points.
+     * @exception GeographicErr if \e zone is not in [0, 60].
+     *
+     * The central meridian and the false easting and northing are only worked
+     * out once.  Points which are out of the allowed range for the zone (see
+     * Reverse) get NaN eastings and northings rather than an exception, so a
+     * single bad point does not lose the rest.
+     **********************************************************************/
+    static void Forward(int zone, bool northp, const real* lat, const real* lon,
+                        real* x, real* y, int count);
+
+    /**
+     * Reverse projection of \e count points in one zone and hemisphere.
+     *
+     * @param[in] zone the UTM zone (zero means UPS).
+     * @param[in] northp hemisphere (true means north, false means south).
+     * @param[in] x eastings of the points (meters).
+     * @param[in] y northings of the points (meters).
+     * @param[out] lat latitudes of the points (degrees).
+     * @param[out] lon longitudes of the points (degrees).
+     * @param[in] count number of points.
+     * @exception GeographicErr if \e zone is not in [0, 60].
+     *
+     * Points which are out of the allowed range give NaN latitudes and
+     * longitudes rather than an exception.
+     **********************************************************************/
+    static void Reverse(int zone, bool northp, const real* x, const real* y,
+                        real* lat, real* lon, int count);
+
     /**
      * Transfer UTM/UPS coordinated from one zone to another.
      *
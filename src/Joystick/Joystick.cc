@@ -16,6 +16,7 @@
 #include "VideoManager.h"
 #include "QGCCameraManager.h"
 #include "QGCCameraControl.h"
+#include "QGCTrace.h"
 
 #include <QSettings>
 
@@ -31,6 +32,7 @@ const char* Joystick::_exponentialSettingsKey =         "Exponential";
 const char* Joystick::_accumulatorSettingsKey =         "Accumulator";
 const char* Joystick::_deadbandSettingsKey =            "Deadband";
 const char* Joystick::_circleCorrectionSettingsKey =    "Circle_Correction";
+const char* Joystick::_eventDrivenSettingsKey =         "EventDriven";
 const char* Joystick::_axisFrequencySettingsKey =       "AxisFrequency";
 const char* Joystick::_buttonFrequencySettingsKey =     "ButtonFrequency";
 const char* Joystick::_txModeSettingsKey =              nullptr;
@@ -119,6 +121,7 @@ Joystick::Joystick(const QString& name, int axisCount, int buttonCount, int hatC
     _updateTXModeSettingsKey(_multiVehicleManager->activeVehicle());
     _loadSettings();
     connect(_multiVehicleManager, &MultiVehicleManager::activeVehicleChanged, this, &Joystick::_activeVehicleChanged);
+    connect(this, &Joystick::_inputLatencyMeasured, this, &Joystick::_setInputLatency, Qt::QueuedConnection);
 }
 
 Joystick::~Joystick()
@@ -231,6 +234,7 @@ void Joystick::_loadSettings()
     _axisFrequencyHz    = settings.value(_axisFrequencySettingsKey,     _defaultAxisFrequencyHz).toFloat();
     _buttonFrequencyHz  = settings.value(_buttonFrequencySettingsKey,   _defaultButtonFrequencyHz).toFloat();
     _circleCorrection   = settings.value(_circleCorrectionSettingsKey,  false).toBool();
+    _eventDriven        = settings.value(_eventDrivenSettingsKey,       false).toBool();
 
     _throttleMode   = static_cast<ThrottleMode_t>(settings.value(_throttleModeSettingsKey, ThrottleModeDownZero).toInt(&convertOk));
     badSettings |= !convertOk;
@@ -335,6 +339,7 @@ void Joystick::_saveSettings()
     settings.setValue(_buttonFrequencySettingsKey,  _buttonFrequencyHz);
     settings.setValue(_throttleModeSettingsKey,     _throttleMode);
     settings.setValue(_circleCorrectionSettingsKey, _circleCorrection);
+    settings.setValue(_eventDrivenSettingsKey,      _eventDriven);
 
     qCDebug(JoystickLog) << "_saveSettings calibrated:throttlemode:deadband:txmode" << _calibrated << _throttleMode << _deadband << _circleCorrection << _transmitterMode;
 
@@ -462,6 +467,7 @@ float Joystick::_adjustRange(int value, Calibration_t calibration, bool withDead
 void Joystick::run()
 {
     //-- Joystick thread
+    QGCTrace::setThreadName(QStringLiteral("Joystick"));
     _open();
     //-- Reset timers
     _axisTime.start();
@@ -470,13 +476,118 @@ void Joystick::run()
             _buttonActionArray[buttonIndex]->buttonTime.start();
         }
     }
+    //-- The mode can be switched while running
     while (!_exitThread) {
+        if (_eventDriven) {
+            _runEventDriven();
+        } else {
+            _runPolling();
+        }
+    }
+    _close();
+}
+
+void Joystick::_runPolling()
+{
+    while (!_exitThread && !_eventDriven) {
+        {
+            QGC_TRACE_SCOPE("Joystick", "update");
+            _update();
+            _handleButtons();
+            _handleAxis();
+        }
+        QGC::SLEEP::msleep(qMin(static_cast<int>(1000.0f / _maxAxisFrequencyHz), static_cast<int>(1000.0f / _maxButtonFrequencyHz)) / 2);
+    }
+}
+
+void Joystick::_runEventDriven()
+{
+    // All times are nanoseconds on a monotonic clock. Sends are scheduled against absolute deadlines such that
+    // the time spent handling input does not add up to drift or jitter.
+    QElapsedTimer clock;
+    clock.start();
+
+    const qint64 minSendIntervalNSecs   = static_cast<qint64>(1e9 / _maxAxisFrequencyHz);
+    const qint64 maxWaitNSecs           = static_cast<qint64>(1e9 / _maxButtonFrequencyHz);     // Keeps button repeats and thread exit responsive
+
+    QVector<int>    sentAxisValues(_axisCount, 0);
+    QVector<bool>   sentButtonValues(_totalButtonCount, false);
+    bool            changed             = true;                     // Send right away
+    qint64          lastSendNSecs       = -minSendIntervalNSecs;
+    qint64          inputNSecs          = -1;                       // Time of the first input which isn't on the wire yet
+    qint64          latencyWindowNSecs  = 0;
+    qint64          latencySumNSecs     = 0;
+    qint64          latencyMaxNSecs     = 0;
+    int             latencyCount        = 0;
+
+    while (!_exitThread && _eventDriven) {
+        const qint64 keepaliveNSecs = static_cast<qint64>(1e9 / _axisFrequencyHz);
+
+        qint64 now      = clock.nsecsElapsed();
+        qint64 deadline = lastSendNSecs + (changed ? minSendIntervalNSecs : keepaliveNSecs);
+        deadline = qMin(deadline, now + maxWaitNSecs);
+        if (deadline > now && _waitForInput(static_cast<int>((deadline - now) / 1000)) && inputNSecs < 0) {
+            inputNSecs = clock.nsecsElapsed();
+        }
+
+        QGC_TRACE_SCOPE("Joystick", "update");
         _update();
         _handleButtons();
-        _handleAxis();
-        QGC::SLEEP::msleep(qMin(static_cast<int>(1000.0f / _maxAxisFrequencyHz), static_cast<int>(1000.0f / _maxButtonFrequencyHz)) / 2);
+        _readAxes();
+
+        for (int axisIndex = 0; axisIndex < _axisCount && !changed; axisIndex++) {
+            changed = _rgAxisValues[axisIndex] != sentAxisValues[axisIndex];
+        }
+        for (int buttonIndex = 0; buttonIndex < _totalButtonCount && !changed; buttonIndex++) {
+            changed = (_rgButtonValues[buttonIndex] != BUTTON_UP) != sentButtonValues[buttonIndex];
+        }
+        if (!changed) {
+            // Input which didn't change anything, e.g. an axis which moved and came back, has nothing to measure
+            inputNSecs = -1;
+        }
+
+        now = clock.nsecsElapsed();
+        const qint64 sinceSendNSecs = now - lastSendNSecs;
+        if ((changed && sinceSendNSecs >= minSendIntervalNSecs) || sinceSendNSecs >= keepaliveNSecs) {
+            if (_sendAxes() && inputNSecs >= 0) {
+                const qint64 latencyNSecs = clock.nsecsElapsed() - inputNSecs;
+                latencySumNSecs += latencyNSecs;
+                latencyMaxNSecs = qMax(latencyMaxNSecs, latencyNSecs);
+                latencyCount++;
+            }
+            lastSendNSecs   = now;
+            inputNSecs      = -1;
+            changed         = false;
+            for (int axisIndex = 0; axisIndex < _axisCount; axisIndex++) {
+                sentAxisValues[axisIndex] = _rgAxisValues[axisIndex];
+            }
+            for (int buttonIndex = 0; buttonIndex < _totalButtonCount; buttonIndex++) {
+                sentButtonValues[buttonIndex] = _rgButtonValues[buttonIndex] != BUTTON_UP;
+            }
+        }
+
+        if (now - latencyWindowNSecs >= 1000000000 && latencyCount) {
+            qCDebug(JoystickValuesLog) << "name:latencyMeanMSecs:latencyMaxMSecs:sends" << name() << latencySumNSecs / latencyCount / 1e6 << latencyMaxNSecs / 1e6 << latencyCount;
+            emit _inputLatencyMeasured(latencySumNSecs / latencyCount / 1e6, latencyMaxNSecs / 1e6);
+            latencyWindowNSecs  = now;
+            latencySumNSecs     = 0;
+            latencyMaxNSecs     = 0;
+            latencyCount        = 0;
+        }
     }
-    _close();
+}
+
+bool Joystick::_waitForInput(int timeoutUSecs)
+{
+    QGC::SLEEP::usleep(static_cast<unsigned long>(timeoutUSecs));
+    return true;
+}
+
+void Joystick::_setInputLatency(double meanMSecs, double maxMSecs)
+{
+    _inputLatencyMSecs      = meanMSecs;
+    _maxInputLatencyMSecs   = maxMSecs;
+    emit inputLatencyChanged();
 }
 
 void Joystick::_handleButtons()
@@ -582,91 +693,108 @@ void Joystick::_handleAxis()
     //-- Check elapsed time since last run
     if(_axisTime.elapsed() > axisDelay) {
         _axisTime.start();
-        //-- Update axis
-        for (int axisIndex = 0; axisIndex < _axisCount; axisIndex++) {
-            int newAxisValue = _getAxis(axisIndex);
-            // Calibration code requires signal to be emitted even if value hasn't changed
-            _rgAxisValues[axisIndex] = newAxisValue;
-            emit rawAxisValueChanged(axisIndex, newAxisValue);
-        }
-        if (_activeVehicle->joystickEnabled() && !_calibrationMode && _calibrated) {
-            int     axis = _rgFunctionAxis[rollFunction];
-            float   roll = _adjustRange(_rgAxisValues[axis],    _rgCalibration[axis], _deadband);
+        _readAxes();
+        _sendAxes();
+    }
+}
 
-                    axis = _rgFunctionAxis[pitchFunction];
-            float   pitch = _adjustRange(_rgAxisValues[axis],   _rgCalibration[axis], _deadband);
+void Joystick::_readAxes()
+{
+    for (int axisIndex = 0; axisIndex < _axisCount; axisIndex++) {
+        int newAxisValue = _getAxis(axisIndex);
+        // Calibration code requires signal to be emitted even if value hasn't changed
+        _rgAxisValues[axisIndex] = newAxisValue;
+        emit rawAxisValueChanged(axisIndex, newAxisValue);
+    }
+}
 
-                    axis = _rgFunctionAxis[yawFunction];
-            float   yaw = _adjustRange(_rgAxisValues[axis],     _rgCalibration[axis],_deadband);
+bool Joystick::_sendAxes()
+{
+    if (!_activeVehicle->joystickEnabled() || _calibrationMode || !_calibrated) {
+        return false;
+    }
+    int     axis = _rgFunctionAxis[rollFunction];
+    float   roll = _adjustRange(_rgAxisValues[axis],    _rgCalibration[axis], _deadband);
 
-                    axis = _rgFunctionAxis[throttleFunction];
-            float   throttle = _adjustRange(_rgAxisValues[axis],_rgCalibration[axis], _throttleMode==ThrottleModeDownZero?false:_deadband);
+            axis = _rgFunctionAxis[pitchFunction];
+    float   pitch = _adjustRange(_rgAxisValues[axis],   _rgCalibration[axis], _deadband);
 
-            float   gimbalPitch = 0.0f;
-            float   gimbalYaw   = 0.0f;
+            axis = _rgFunctionAxis[yawFunction];
+    float   yaw = _adjustRange(_rgAxisValues[axis],     _rgCalibration[axis],_deadband);
 
-            if(_axisCount > 4) {
-                axis = _rgFunctionAxis[gimbalPitchFunction];
-                gimbalPitch = _adjustRange(_rgAxisValues[axis], _rgCalibration[axis],_deadband);
-            }
+            axis = _rgFunctionAxis[throttleFunction];
+    float   throttle = _adjustRange(_rgAxisValues[axis],_rgCalibration[axis], _throttleMode==ThrottleModeDownZero?false:_deadband);
 
-            if(_axisCount > 5) {
-                axis = _rgFunctionAxis[gimbalYawFunction];
-                gimbalYaw = _adjustRange(_rgAxisValues[axis],   _rgCalibration[axis],_deadband);
-            }
+    float   gimbalPitch = 0.0f;
+    float   gimbalYaw   = 0.0f;
 
-            if (_accumulator) {
-                static float throttle_accu = 0.f;
-                throttle_accu += throttle * (40 / 1000.f); //for throttle to change from min to max it will take 1000ms (40ms is a loop time)
-                throttle_accu = std::max(static_cast<float>(-1.f), std::min(throttle_accu, static_cast<float>(1.f)));
-                throttle = throttle_accu;
-            }
+    if(_axisCount > 4) {
+        axis = _rgFunctionAxis[gimbalPitchFunction];
+        gimbalPitch = _adjustRange(_rgAxisValues[axis], _rgCalibration[axis],_deadband);
+    }
 
-            if (_circleCorrection) {
-                float roll_limited      = std::max(static_cast<float>(-M_PI_4), std::min(roll,      static_cast<float>(M_PI_4)));
-                float pitch_limited     = std::max(static_cast<float>(-M_PI_4), std::min(pitch,     static_cast<float>(M_PI_4)));
-                float yaw_limited       = std::max(static_cast<float>(-M_PI_4), std::min(yaw,       static_cast<float>(M_PI_4)));
-                float throttle_limited  = std::max(static_cast<float>(-M_PI_4), std::min(throttle,  static_cast<float>(M_PI_4)));
-
-                // Map from unit circle to linear range and limit
-                roll =      std::max(-1.0f, std::min(tanf(asinf(roll_limited)),     1.0f));
-                pitch =     std::max(-1.0f, std::min(tanf(asinf(pitch_limited)),    1.0f));
-                yaw =       std::max(-1.0f, std::min(tanf(asinf(yaw_limited)),      1.0f));
-                throttle =  std::max(-1.0f, std::min(tanf(asinf(throttle_limited)), 1.0f));
-            }
+    if(_axisCount > 5) {
+        axis = _rgFunctionAxis[gimbalYawFunction];
+        gimbalYaw = _adjustRange(_rgAxisValues[axis],   _rgCalibration[axis],_deadband);
+    }
 
-            if ( _exponential < -0.01f) {
-                // Exponential (0% to -50% range like most RC radios)
-                // _exponential is set by a slider in joystickConfigAdvanced.qml
-                // Calculate new RPY with exponential applied
-                roll =  -_exponential*powf(roll, 3) + (1+_exponential)*roll;
-                pitch = -_exponential*powf(pitch,3) + (1+_exponential)*pitch;
-                yaw =   -_exponential*powf(yaw,  3) + (1+_exponential)*yaw;
-            }
+    if (_accumulator) {
+        static float throttle_accu = 0.f;
+        // Integrate over the actual time since the last send, which varies while event driven
+        float loopSecs = 1.0f / _axisFrequencyHz;
+        if (_accumulatorTime.isValid()) {
+            loopSecs = std::min(_accumulatorTime.elapsed(), static_cast<qint64>(100)) / 1000.f;
+        }
+        _accumulatorTime.start();
+        throttle_accu += throttle * loopSecs; //for throttle to change from min to max it will take 1000ms
+        throttle_accu = std::max(static_cast<float>(-1.f), std::min(throttle_accu, static_cast<float>(1.f)));
+        throttle = throttle_accu;
+    }
 
-            // Adjust throttle to 0:1 range
-            if (_throttleMode == ThrottleModeCenterZero && _activeVehicle->supportsThrottleModeCenterZero()) {
-                if (!_activeVehicle->supportsNegativeThrust() || !_negativeThrust) {
-                    throttle = std::max(0.0f, throttle);
-                }
-            } else {
-                throttle = (throttle + 1.0f) / 2.0f;
-            }
-            qCDebug(JoystickValuesLog) << "name:roll:pitch:yaw:throttle:gimbalPitch:gimbalYaw" << name() << roll << -pitch << yaw << throttle << gimbalPitch << gimbalYaw;
-            // NOTE: The buttonPressedBits going to MANUAL_CONTROL are currently used by ArduSub (and it only handles 16 bits)
-            // Set up button bitmap
-            quint64 buttonPressedBits = 0;  // Buttons pressed for manualControl signal
-            for (int buttonIndex = 0; buttonIndex < _totalButtonCount; buttonIndex++) {
-                quint64 buttonBit = static_cast<quint64>(1LL << buttonIndex);
-                if (_rgButtonValues[buttonIndex] != BUTTON_UP) {
-                    // Mark the button as pressed as long as its pressed
-                    buttonPressedBits |= buttonBit;
-                }
-            }
-            uint16_t shortButtons = static_cast<uint16_t>(buttonPressedBits & 0xFFFF);
-            _activeVehicle->sendJoystickDataThreadSafe(roll, pitch, yaw, throttle, shortButtons);
+    if (_circleCorrection) {
+        float roll_limited      = std::max(static_cast<float>(-M_PI_4), std::min(roll,      static_cast<float>(M_PI_4)));
+        float pitch_limited     = std::max(static_cast<float>(-M_PI_4), std::min(pitch,     static_cast<float>(M_PI_4)));
+        float yaw_limited       = std::max(static_cast<float>(-M_PI_4), std::min(yaw,       static_cast<float>(M_PI_4)));
+        float throttle_limited  = std::max(static_cast<float>(-M_PI_4), std::min(throttle,  static_cast<float>(M_PI_4)));
+
+        // Map from unit circle to linear range and limit
+        roll =      std::max(-1.0f, std::min(tanf(asinf(roll_limited)),     1.0f));
+        pitch =     std::max(-1.0f, std::min(tanf(asinf(pitch_limited)),    1.0f));
+        yaw =       std::max(-1.0f, std::min(tanf(asinf(yaw_limited)),      1.0f));
+        throttle =  std::max(-1.0f, std::min(tanf(asinf(throttle_limited)), 1.0f));
+    }
+
+    if ( _exponential < -0.01f) {
+        // Exponential (0% to -50% range like most RC radios)
+        // _exponential is set by a slider in joystickConfigAdvanced.qml
+        // Calculate new RPY with exponential applied
+        roll =  -_exponential*powf(roll, 3) + (1+_exponential)*roll;
+        pitch = -_exponential*powf(pitch,3) + (1+_exponential)*pitch;
+        yaw =   -_exponential*powf(yaw,  3) + (1+_exponential)*yaw;
+    }
+
+    // Adjust throttle to 0:1 range
+    if (_throttleMode == ThrottleModeCenterZero && _activeVehicle->supportsThrottleModeCenterZero()) {
+        if (!_activeVehicle->supportsNegativeThrust() || !_negativeThrust) {
+            throttle = std::max(0.0f, throttle);
+        }
+    } else {
+        throttle = (throttle + 1.0f) / 2.0f;
+    }
+    qCDebug(JoystickValuesLog) << "name:roll:pitch:yaw:throttle:gimbalPitch:gimbalYaw" << name() << roll << -pitch << yaw << throttle << gimbalPitch << gimbalYaw;
+    // NOTE: The buttonPressedBits going to MANUAL_CONTROL are currently used by ArduSub (and it only handles 16 bits)
+    // Set up button bitmap
+    quint64 buttonPressedBits = 0;  // Buttons pressed for manualControl signal
+    for (int buttonIndex = 0; buttonIndex < _totalButtonCount; buttonIndex++) {
+        quint64 buttonBit = static_cast<quint64>(1LL << buttonIndex);
+        if (_rgButtonValues[buttonIndex] != BUTTON_UP) {
+            // Mark the button as pressed as long as its pressed
+            buttonPressedBits |= buttonBit;
         }
     }
+    uint16_t shortButtons = static_cast<uint16_t>(buttonPressedBits & 0xFFFF);
+    _activeVehicle->sendJoystickDataThreadSafe(roll, pitch, yaw, throttle, shortButtons);
+    return true;
 }
 
 void Joystick::startPolling(Vehicle* vehicle)
@@ -926,6 +1054,13 @@ void Joystick::setCircleCorrection(bool circleCorrection)
     emit circleCorrectionChanged(_circleCorrection);
 }
 
+void Joystick::setEventDriven(bool eventDriven)
+{
+    _eventDriven = eventDriven;
+    _saveSettings();
+    emit eventDrivenChanged(_eventDriven);
+}
+
 void Joystick::setAxisFrequency(float val)
 {
     //-- Arbitrary limits
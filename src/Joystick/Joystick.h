@@ -110,6 +110,9 @@ public:
     Q_PROPERTY(float    exponential             READ exponential            WRITE setExponential        NOTIFY exponentialChanged)
     Q_PROPERTY(bool     accumulator             READ accumulator            WRITE setAccumulator        NOTIFY accumulatorChanged)
     Q_PROPERTY(bool     circleCorrection        READ circleCorrection       WRITE setCircleCorrection   NOTIFY circleCorrectionChanged)
+    Q_PROPERTY(bool     eventDriven             READ eventDriven            WRITE setEventDriven        NOTIFY eventDrivenChanged)
+    Q_PROPERTY(double   inputLatencyMSecs       READ inputLatencyMSecs                                  NOTIFY inputLatencyChanged)
+    Q_PROPERTY(double   maxInputLatencyMSecs    READ maxInputLatencyMSecs                               NOTIFY inputLatencyChanged)
 
     Q_INVOKABLE void    setButtonRepeat     (int button, bool repeat);
     Q_INVOKABLE bool    getButtonRepeat     (int button);
@@ -164,6 +167,16 @@ public:
     bool  circleCorrection  ();
     void  setCircleCorrection(bool circleCorrection);
 
+    /// Event driven: axes are sent as soon as they change (at most at maxAxisFrequencyHz) and otherwise at
+    /// axisFrequencyHz as a keepalive. Polling: axes are sent at axisFrequencyHz only.
+    bool  eventDriven       () { return _eventDriven; }
+    void  setEventDriven    (bool eventDriven);
+
+    /// Mean and maximum time from an input event to its MANUAL_CONTROL being handed to the link, over the
+    /// last second with input. Only measured while event driven.
+    double inputLatencyMSecs    () { return _inputLatencyMSecs; }
+    double maxInputLatencyMSecs () { return _maxInputLatencyMSecs; }
+
     void  setTXMode         (int mode);
     int   getTXMode         () { return _transmitterMode; }
 
@@ -193,6 +206,8 @@ signals:
     void accumulatorChanged         (bool accumulator);
     void enabledChanged             (bool enabled);
     void circleCorrectionChanged    (bool circleCorrection);
+    void eventDrivenChanged         (bool eventDriven);
+    void inputLatencyChanged        ();
     void axisValues                 (float roll, float pitch, float yaw, float throttle);
 
     void axisFrequencyHzChanged     ();
@@ -226,7 +241,11 @@ protected:
     bool    _validAxis              (int axis);
     bool    _validButton            (int button);
     void    _handleAxis             ();
+    void    _readAxes               ();
+    bool    _sendAxes               ();
     void    _handleButtons          ();
+    void    _runPolling             ();
+    void    _runEventDriven         ();
     void    _buildActionList        (Vehicle* activeVehicle);
 
     void    _pitchStep              (int direction);
@@ -243,6 +262,10 @@ private:
     virtual int  _getAxis   (int i)      = 0;
     virtual bool _getHat    (int hat,int i) = 0;
 
+    /// Waits until there is new input or the timeout expired, returns true for new input. The default
+    /// implementation sleeps and always claims new input, which makes the event driven loop poll.
+    virtual bool _waitForInput(int timeoutUSecs);
+
     void _updateTXModeSettingsKey(Vehicle* activeVehicle);
     int _mapFunctionMode(int mode, int function);
     void _remapAxes(int currentMode, int newMode, int (&newMapping)[maxFunction]);
@@ -273,6 +296,7 @@ protected:
     bool    _accumulator            = false;
     bool    _deadband               = false;
     bool    _circleCorrection       = true;
+    bool    _eventDriven            = false;
     float   _axisFrequencyHz        = _defaultAxisFrequencyHz;
     float   _buttonFrequencyHz      = _defaultButtonFrequencyHz;
     Vehicle* _activeVehicle         = nullptr;
@@ -290,6 +314,9 @@ protected:
     static int          _transmitterMode;
     int                 _rgFunctionAxis[maxFunction] = {};
     QElapsedTimer       _axisTime;
+    QElapsedTimer       _accumulatorTime;
+    double              _inputLatencyMSecs      = 0;
+    double              _maxInputLatencyMSecs   = 0;
 
     QmlObjectListModel              _assignableButtonActions;
     QList<AssignedButtonAction*>    _buttonActionArray;
@@ -313,6 +340,7 @@ private:
     static const char* _accumulatorSettingsKey;
     static const char* _deadbandSettingsKey;
     static const char* _circleCorrectionSettingsKey;
+    static const char* _eventDrivenSettingsKey;
     static const char* _axisFrequencySettingsKey;
     static const char* _buttonFrequencySettingsKey;
     static const char* _txModeSettingsKey;
@@ -349,4 +377,9 @@ private:
 
 private slots:
     void _activeVehicleChanged(Vehicle* activeVehicle);
+    void _setInputLatency(double meanMSecs, double maxMSecs);
+
+signals:
+    /// Queued from the joystick thread to publish latency statistics on the main thread
+    void _inputLatencyMeasured(double meanMSecs, double maxMSecs);
 };
@@ -161,6 +161,8 @@ bool JoystickAndroid::handleKeyEvent(jobject event) {
         if (btnCode[i] == keyCode) {
             if (action == ACTION_DOWN) btnValue[i] = true;
             if (action == ACTION_UP)   btnValue[i] = false;
+            _inputPending = true;
+            _inputCondition.wakeAll();
             return true;
         }
     }
@@ -177,6 +179,8 @@ bool JoystickAndroid::handleGenericMotionEvent(jobject event) {
         const float v = ev.callMethod<jfloat>("getAxisValue", "(I)F",axisCode[i]);
         axisValue[i] = static_cast<int>((v*32767.f));
     }
+    _inputPending = true;
+    _inputCondition.wakeAll();
     return true;
 }
 
@@ -192,6 +196,18 @@ bool JoystickAndroid::_update(void)
     return true;
 }
 
+bool JoystickAndroid::_waitForInput(int timeoutUSecs)
+{
+    // Input events are delivered by the Android UI thread, which wakes us up
+    QMutexLocker lock(&m_mutex);
+    if (!_inputPending) {
+        _inputCondition.wait(&m_mutex, static_cast<unsigned long>(timeoutUSecs / 1000));
+    }
+    bool input = _inputPending;
+    _inputPending = false;
+    return input;
+}
+
 bool JoystickAndroid::_getButton(int i) {
     return btnValue[ i ];
 }
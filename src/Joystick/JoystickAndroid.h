@@ -5,6 +5,8 @@
 #include "Vehicle.h"
 #include "MultiVehicleManager.h"
 
+#include <QWaitCondition>
+
 #include <jni.h>
 #include <QtCore/private/qjni_p.h>
 #include <QtCore/private/qjnihelpers_p.h>
@@ -37,6 +39,8 @@ private:
     virtual int  _getAxis       (int i);
     virtual bool _getHat        (int hat,int i);
 
+    virtual bool _waitForInput  (int timeoutUSecs);
+
     int *btnCode;
     int *axisCode;
     bool *btnValue;
@@ -49,6 +53,9 @@ private:
     static QMutex m_mutex;
 
     int deviceId;
+
+    bool            _inputPending = false;  ///< Protected by m_mutex
+    QWaitCondition  _inputCondition;
 };
 
 #endif // JOYSTICKANDROID_H
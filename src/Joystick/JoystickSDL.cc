@@ -1,7 +1,9 @@
 #include "JoystickSDL.h"
 
+#include "QGC.h"
 #include "QGCApplication.h"
 
+#include <QElapsedTimer>
 #include <QQmlEngine>
 #include <QTextStream>
 
@@ -185,3 +187,59 @@ bool JoystickSDL::_getHat(int hat, int i) {
     }
     return false;
 }
+
+bool JoystickSDL::_waitForInput(int timeoutUSecs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    forever {
+        SDL_JoystickUpdate();
+        SDL_GameControllerUpdate();
+        _inputEvent = false;
+        SDL_FilterEvents(_filterInputEvent, this);
+        if (_inputEvent) {
+            return true;
+        }
+        qint64 remainingUSecs = timeoutUSecs - timer.nsecsElapsed() / 1000;
+        if (remainingUSecs <= 0) {
+            return false;
+        }
+        QGC::SLEEP::usleep(static_cast<unsigned long>(std::min(remainingUSecs, static_cast<qint64>(_pumpIntervalUSecs))));
+    }
+}
+
+/// Removes the input events of this joystick from the SDL queue. Events of other joysticks as well as device
+/// added/removed events are left in the queue for their joystick threads and JoystickManager respectively.
+int JoystickSDL::_filterInputEvent(void* userdata, SDL_Event* event)
+{
+    JoystickSDL*    joystick    = static_cast<JoystickSDL*>(userdata);
+    SDL_JoystickID  which       = -1;
+
+    switch (event->type) {
+    case SDL_JOYAXISMOTION:
+        which = event->jaxis.which;
+        break;
+    case SDL_JOYHATMOTION:
+        which = event->jhat.which;
+        break;
+    case SDL_JOYBUTTONDOWN:
+    case SDL_JOYBUTTONUP:
+        which = event->jbutton.which;
+        break;
+    case SDL_CONTROLLERAXISMOTION:
+        which = event->caxis.which;
+        break;
+    case SDL_CONTROLLERBUTTONDOWN:
+    case SDL_CONTROLLERBUTTONUP:
+        which = event->cbutton.which;
+        break;
+    default:
+        return 1;
+    }
+
+    if (!joystick->sdlJoystick || which != SDL_JoystickInstanceID(joystick->sdlJoystick)) {
+        return 1;
+    }
+    joystick->_inputEvent = true;
+    return 0;
+}
@@ -44,10 +44,17 @@ private:
     int  _getAxis   (int i) final;
     bool _getHat    (int hat,int i) final;
 
-    SDL_Joystick*       sdlJoystick;
-    SDL_GameController* sdlController;
+    bool _waitForInput(int timeoutUSecs) final;
+
+    static int _filterInputEvent(void* userdata, SDL_Event* event);
+
+    static const int _pumpIntervalUSecs = 1000;    ///< SDL only queues joystick events while its devices are pumped
+
+    SDL_Joystick*       sdlJoystick     = nullptr;
+    SDL_GameController* sdlController   = nullptr;
 
     bool    _isGameController;
     int     _index;      ///< Index for SDL_JoystickOpen
+    bool    _inputEvent = false;
 
 };
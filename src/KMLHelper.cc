@@ -11,50 +11,55 @@
 
 #include <QFile>
 #include <QVariant>
+#include <QXmlStreamReader>
+
+#include <algorithm>
 
 const char* KMLHelper::_errorPrefix = QT_TR_NOOP("KML file load failed. %1");
 
-QDomDocument KMLHelper::_loadFile(const QString& kmlFile, QString& errorString)
+bool KMLHelper::_openFile(QFile& file, QString& errorString)
 {
-    QFile file(kmlFile);
-
     errorString.clear();
 
     if (!file.exists()) {
-        errorString = QString(_errorPrefix).arg(tr("File not found: %1").arg(kmlFile));
-        return QDomDocument();
+        errorString = QString(_errorPrefix).arg(tr("File not found: %1").arg(file.fileName()));
+        return false;
     }
 
     if (!file.open(QIODevice::ReadOnly)) {
-        errorString = QString(_errorPrefix).arg(tr("Unable to open file: %1 error: $%2").arg(kmlFile).arg(file.errorString()));
-        return QDomDocument();
-    }
-
-    QDomDocument doc;
-    QString errorMessage;
-    int errorLine;
-    if (!doc.setContent(&file, &errorMessage, &errorLine)) {
-        errorString = QString(_errorPrefix).arg(tr("Unable to parse KML file: %1 error: %2 line: %3").arg(kmlFile).arg(errorMessage).arg(errorLine));
-        return QDomDocument();
+        errorString = QString(_errorPrefix).arg(tr("Unable to open file: %1 error: $%2").arg(file.fileName()).arg(file.errorString()));
+        return false;
     }
 
-    return doc;
+    return true;
 }
 
 ShapeFileHelper::ShapeType KMLHelper::determineShapeType(const QString& kmlFile, QString& errorString)
 {
-    QDomDocument domDocument = KMLHelper::_loadFile(kmlFile, errorString);
-    if (!errorString.isEmpty()) {
+    QFile file(kmlFile);
+    if (!_openFile(file, errorString)) {
         return ShapeFileHelper::Error;
     }
 
-    QDomNodeList rgNodes = domDocument.elementsByTagName("Polygon");
-    if (rgNodes.count()) {
-        return ShapeFileHelper::Polygon;
+    // Polygons win over polylines, so only a polygon ends the scan early
+    QXmlStreamReader    reader(&file);
+    bool                foundLineString = false;
+    while (!reader.atEnd()) {
+        if (reader.readNext() == QXmlStreamReader::StartElement) {
+            if (reader.name() == QLatin1String("Polygon")) {
+                return ShapeFileHelper::Polygon;
+            } else if (reader.name() == QLatin1String("LineString")) {
+                foundLineString = true;
+            }
+        }
     }
 
-    rgNodes = domDocument.elementsByTagName("LineString");
-    if (rgNodes.count()) {
+    if (reader.hasError()) {
+        errorString = QString(_errorPrefix).arg(tr("Unable to parse KML file: %1 error: %2 line: %3").arg(kmlFile).arg(reader.errorString()).arg(reader.lineNumber()));
+        return ShapeFileHelper::Error;
+    }
+
+    if (foundLineString) {
         return ShapeFileHelper::Polyline;
     }
 
@@ -62,60 +67,128 @@ ShapeFileHelper::ShapeType KMLHelper::determineShapeType(const QString& kmlFile,
     return ShapeFileHelper::Error;
 }
 
-bool KMLHelper::loadPolygonFromFile(const QString& kmlFile, QList<QGeoCoordinate>& vertices, QString& errorString)
+void KMLHelper::_parseCoordinates(const QString& text, bool final, QString& partialTuple, QList<QGeoCoordinate>& coords)
 {
-    errorString.clear();
-    vertices.clear();
+    // Tuples are lon,lat[,alt] separated by whitespace. The text can arrive in pieces which split a tuple, so whatever
+    // follows the last separator is held back until the next piece.
+    QString buffer = partialTuple + text;
+    int     start = 0;
+
+    for (int i=0; i<=buffer.length(); i++) {
+        if (i < buffer.length() && !buffer[i].isSpace()) {
+            continue;
+        }
+        if (i == buffer.length() && !final) {
+            break;
+        }
+        if (i > start) {
+            QStringList rgValueStrings = buffer.mid(start, i - start).split(',');
+            if (rgValueStrings.count() >= 2) {
+                QGeoCoordinate coord;
+                coord.setLongitude(rgValueStrings[0].toDouble());
+                coord.setLatitude(rgValueStrings[1].toDouble());
+                coords.append(coord);
+            }
+        }
+        start = i + 1;
+    }
 
-    QDomDocument domDocument = KMLHelper::_loadFile(kmlFile, errorString);
-    if (!errorString.isEmpty()) {
+    partialTuple = start < buffer.length() ? buffer.mid(start) : QString();
+}
+
+bool KMLHelper::_loadCoordinates(const QString& kmlFile, const QStringList& coordinatesPath, QList<QGeoCoordinate>& coords, QString& errorString, const ShapeFileHelper::ProgressCallback_t& progress)
+{
+    QFile file(kmlFile);
+    if (!_openFile(file, errorString)) {
         return false;
     }
 
-    QDomNodeList rgNodes = domDocument.elementsByTagName("Polygon");
-    if (rgNodes.count() == 0) {
-        errorString = QString(_errorPrefix).arg(tr("Unable to find Polygon node in KML"));
-        return false;
+    const QString&      shapeElement    = coordinatesPath.first();
+    QXmlStreamReader    reader(&file);
+    QStringList         elementPath;                // Names of the currently open elements, outermost first
+    int                 shapeDepth      = -1;       // Depth of the first shape element, -1 until it is found
+    bool                inCoordinates   = false;
+    QString             partialTuple;
+    double              fileSize        = qMax(file.size(), static_cast<qint64>(1));
+    qint64              nextProgressPos = 0;
+
+    while (!reader.atEnd()) {
+        QXmlStreamReader::TokenType token = reader.readNext();
+
+        if (progress && file.pos() >= nextProgressPos) {
+            if (!progress(file.pos() / fileSize)) {
+                errorString = QString(_errorPrefix).arg(tr("Load cancelled."));
+                return false;
+            }
+            nextProgressPos = file.pos() + _progressStepBytes;
+        }
+
+        if (token == QXmlStreamReader::StartElement) {
+            elementPath.append(reader.name().toString());
+            if (shapeDepth == -1 && elementPath.last() == shapeElement) {
+                shapeDepth = elementPath.count();
+            } else if (shapeDepth != -1 && elementPath.count() == shapeDepth + coordinatesPath.count() - 1 && elementPath.mid(shapeDepth - 1) == coordinatesPath) {
+                // Direct descendants only, the same way the coordinates of a KML shape are laid out
+                inCoordinates = true;
+            }
+        } else if (token == QXmlStreamReader::Characters) {
+            if (inCoordinates) {
+                _parseCoordinates(reader.text().toString(), false /* final */, partialTuple, coords);
+            }
+        } else if (token == QXmlStreamReader::EndElement) {
+            if (inCoordinates) {
+                // The rest of the file isn't needed
+                _parseCoordinates(QString(), true /* final */, partialTuple, coords);
+                if (progress) {
+                    progress(1);
+                }
+                return true;
+            }
+            if (elementPath.count() == shapeDepth) {
+                errorString = QString(_errorPrefix).arg(tr("Internal error: Unable to find coordinates node in KML"));
+                return false;
+            }
+            elementPath.removeLast();
+        }
     }
 
-    QDomNode coordinatesNode = rgNodes.item(0).namedItem("outerBoundaryIs").namedItem("LinearRing").namedItem("coordinates");
-    if (coordinatesNode.isNull()) {
-        errorString = QString(_errorPrefix).arg(tr("Internal error: Unable to find coordinates node in KML"));
-        return false;
+    if (reader.hasError()) {
+        errorString = QString(_errorPrefix).arg(tr("Unable to parse KML file: %1 error: %2 line: %3").arg(kmlFile).arg(reader.errorString()).arg(reader.lineNumber()));
+    } else {
+        errorString = QString(_errorPrefix).arg(tr("Unable to find %1 node in KML").arg(shapeElement));
     }
 
-    QString coordinatesString = coordinatesNode.toElement().text().simplified();
-    QStringList rgCoordinateStrings = coordinatesString.split(" ");
+    return false;
+}
 
-    QList<QGeoCoordinate> rgCoords;
-    for (int i=0; i<rgCoordinateStrings.count()-1; i++) {
-        QString coordinateString = rgCoordinateStrings[i];
+bool KMLHelper::loadPolygonFromFile(const QString& kmlFile, QList<QGeoCoordinate>& vertices, QString& errorString, const ShapeFileHelper::ProgressCallback_t& progress)
+{
+    static const QStringList coordinatesPath = { QStringLiteral("Polygon"), QStringLiteral("outerBoundaryIs"), QStringLiteral("LinearRing"), QStringLiteral("coordinates") };
 
-        QStringList rgValueStrings = coordinateString.split(",");
+    errorString.clear();
+    vertices.clear();
 
-        QGeoCoordinate coord;
-        coord.setLongitude(rgValueStrings[0].toDouble());
-        coord.setLatitude(rgValueStrings[1].toDouble());
+    QList<QGeoCoordinate> rgCoords;
+    if (!_loadCoordinates(kmlFile, coordinatesPath, rgCoords, errorString, progress)) {
+        return false;
+    }
 
-        rgCoords.append(coord);
+    // A linear ring repeats the first vertex at the end to close it
+    if (rgCoords.count() > 1 && rgCoords.first() == rgCoords.last()) {
+        rgCoords.removeLast();
     }
 
     // Determine winding, reverse if needed. QGC wants clockwise winding
     double sum = 0;
     for (int i=0; i<rgCoords.count(); i++) {
-        QGeoCoordinate coord1 = rgCoords[i];
-        QGeoCoordinate coord2 = (i == rgCoords.count() - 1) ? rgCoords[0] : rgCoords[i+1];
+        const QGeoCoordinate& coord1 = rgCoords[i];
+        const QGeoCoordinate& coord2 = (i == rgCoords.count() - 1) ? rgCoords[0] : rgCoords[i+1];
 
         sum += (coord2.longitude() - coord1.longitude()) * (coord2.latitude() + coord1.latitude());
     }
     bool reverse = sum < 0.0;
     if (reverse) {
-        QList<QGeoCoordinate> rgReversed;
-
-        for (int i=0; i<rgCoords.count(); i++) {
-            rgReversed.prepend(rgCoords[i]);
-        }
-        rgCoords = rgReversed;
+        std::reverse(rgCoords.begin(), rgCoords.end());
     }
 
     vertices = rgCoords;
@@ -123,45 +196,12 @@ bool KMLHelper::loadPolygonFromFile(const QString& kmlFile, QList<QGeoCoordinate
     return true;
 }
 
-bool KMLHelper::loadPolylineFromFile(const QString& kmlFile, QList<QGeoCoordinate>& coords, QString& errorString)
+bool KMLHelper::loadPolylineFromFile(const QString& kmlFile, QList<QGeoCoordinate>& coords, QString& errorString, const ShapeFileHelper::ProgressCallback_t& progress)
 {
+    static const QStringList coordinatesPath = { QStringLiteral("LineString"), QStringLiteral("coordinates") };
+
     errorString.clear();
     coords.clear();
 
-    QDomDocument domDocument = KMLHelper::_loadFile(kmlFile, errorString);
-    if (!errorString.isEmpty()) {
-        return false;
-    }
-
-    QDomNodeList rgNodes = domDocument.elementsByTagName("LineString");
-    if (rgNodes.count() == 0) {
-        errorString = QString(_errorPrefix).arg(tr("Unable to find LineString node in KML"));
-        return false;
-    }
-
-    QDomNode coordinatesNode = rgNodes.item(0).namedItem("coordinates");
-    if (coordinatesNode.isNull()) {
-        errorString = QString(_errorPrefix).arg(tr("Internal error: Unable to find coordinates node in KML"));
-        return false;
-    }
-
-    QString coordinatesString = coordinatesNode.toElement().text().simplified();
-    QStringList rgCoordinateStrings = coordinatesString.split(" ");
-
-    QList<QGeoCoordinate> rgCoords;
-    for (int i=0; i<rgCoordinateStrings.count()-1; i++) {
-        QString coordinateString = rgCoordinateStrings[i];
-
-        QStringList rgValueStrings = coordinateString.split(",");
-
-        QGeoCoordinate coord;
-        coord.setLongitude(rgValueStrings[0].toDouble());
-        coord.setLatitude(rgValueStrings[1].toDouble());
-
-        rgCoords.append(coord);
-    }
-
-    coords = rgCoords;
-
-    return true;
+    return _loadCoordinates(kmlFile, coordinatesPath, coords, errorString, progress);
 }
@@ -10,23 +10,30 @@
 #pragma once
 
 #include <QObject>
-#include <QDomDocument>
 #include <QList>
 #include <QGeoCoordinate>
+#include <QStringList>
 
 #include "ShapeFileHelper.h"
 
+class QFile;
+
+/// Loads shapes from KML files. The file is streamed rather than loaded into a document, so memory use doesn't grow
+/// with the size of the file and reading stops as soon as the shape has been found.
 class KMLHelper : public QObject
 {
     Q_OBJECT
 
 public:
     static ShapeFileHelper::ShapeType determineShapeType(const QString& kmlFile, QString& errorString);
-    static bool loadPolygonFromFile(const QString& kmlFile, QList<QGeoCoordinate>& vertices, QString& errorString);
-    static bool loadPolylineFromFile(const QString& kmlFile, QList<QGeoCoordinate>& coords, QString& errorString);
+    static bool loadPolygonFromFile(const QString& kmlFile, QList<QGeoCoordinate>& vertices, QString& errorString, const ShapeFileHelper::ProgressCallback_t& progress = ShapeFileHelper::ProgressCallback_t());
+    static bool loadPolylineFromFile(const QString& kmlFile, QList<QGeoCoordinate>& coords, QString& errorString, const ShapeFileHelper::ProgressCallback_t& progress = ShapeFileHelper::ProgressCallback_t());
 
 private:
-    static QDomDocument _loadFile(const QString& kmlFile, QString& errorString);
+    static bool _openFile           (QFile& file, QString& errorString);
+    static bool _loadCoordinates    (const QString& kmlFile, const QStringList& coordinatesPath, QList<QGeoCoordinate>& coords, QString& errorString, const ShapeFileHelper::ProgressCallback_t& progress);
+    static void _parseCoordinates   (const QString& text, bool final, QString& partialTuple, QList<QGeoCoordinate>& coords);
 
-    static const char* _errorPrefix;
+    static const char*  _errorPrefix;
+    static const int    _progressStepBytes = 1024 * 1024;   ///< Progress is reported each time this much more of the file has been read
 };
@@ -0,0 +1,203 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "KMLStreamWriter.h"
+
+#include <QIODevice>
+
+const char* KMLStreamWriter::balloonStyleName = "BalloonStyle";
+
+KMLStreamWriter::KMLStreamWriter(QIODevice* device, const QString& name, int latLonDecimals, int altitudeDecimals)
+    : _writer           (device)
+    , _latLonDecimals   (latLonDecimals)
+    , _altitudeDecimals (altitudeDecimals)
+{
+    _writer.setAutoFormatting(true);
+    _writer.writeStartDocument();
+
+    _writer.writeStartElement(QStringLiteral("kml"));
+    _writer.writeDefaultNamespace(QStringLiteral("http://www.opengis.net/kml/2.2"));
+
+    startElement(QStringLiteral("Document"));
+    addTextElement(QStringLiteral("name"), name);
+    addTextElement(QStringLiteral("open"), QStringLiteral("1"));
+
+    startElement(QStringLiteral("Style"));
+    _writer.writeAttribute(QStringLiteral("id"), balloonStyleName);
+    startElement(QStringLiteral("BalloonStyle"));
+    addTextElement(QStringLiteral("text"), QStringLiteral("$[description]"));
+    endElement();
+    endElement();
+}
+
+void KMLStreamWriter::finish(void)
+{
+    if (!_finished) {
+        _finished = true;
+        _writer.writeEndDocument();
+    }
+}
+
+void KMLStreamWriter::startElement(const QString& name)
+{
+    _writer.writeStartElement(name);
+}
+
+void KMLStreamWriter::endElement(void)
+{
+    _writer.writeEndElement();
+}
+
+void KMLStreamWriter::addTextElement(const QString& name, const QString& value)
+{
+    _writer.writeTextElement(name, value);
+}
+
+void KMLStreamWriter::addCDATAElement(const QString& name, const QString& value)
+{
+    _writer.writeStartElement(name);
+    _writer.writeCDATA(value);
+    _writer.writeEndElement();
+}
+
+void KMLStreamWriter::startFolder(const QString& name)
+{
+    startElement(QStringLiteral("Folder"));
+    addTextElement(QStringLiteral("name"), name);
+}
+
+void KMLStreamWriter::startPlacemark(const QString& name, bool visible, const QString& styleName)
+{
+    startElement(QStringLiteral("Placemark"));
+    addTextElement(QStringLiteral("name"),         name);
+    addTextElement(QStringLiteral("visibility"),   visible ? QStringLiteral("1") : QStringLiteral("0"));
+    if (!styleName.isEmpty()) {
+        addTextElement(QStringLiteral("styleUrl"), QStringLiteral("#%1").arg(styleName));
+    }
+}
+
+void KMLStreamWriter::addLookAt(const QGeoCoordinate& coord)
+{
+    startElement(QStringLiteral("LookAt"));
+    addTextElement(QStringLiteral("latitude"),  QString::number(coord.latitude(), 'f', 7));
+    addTextElement(QStringLiteral("longitude"), QString::number(coord.longitude(), 'f', 7));
+    addTextElement(QStringLiteral("altitude"),  QString::number(qIsNaN(coord.altitude()) ? 0 : coord.altitude(), 'f', 2));
+    addTextElement(QStringLiteral("heading"),   QStringLiteral("-100"));
+    addTextElement(QStringLiteral("tilt"),      QStringLiteral("45"));
+    addTextElement(QStringLiteral("range"),     QStringLiteral("2500"));
+    endElement();
+}
+
+void KMLStreamWriter::addLineStyle(const QString& styleName, const QColor& color, int width)
+{
+    startElement(QStringLiteral("Style"));
+    _writer.writeAttribute(QStringLiteral("id"), styleName);
+    startElement(QStringLiteral("LineStyle"));
+    addTextElement(QStringLiteral("color"), kmlColorString(color));
+    addTextElement(QStringLiteral("width"), QString::number(width));
+    endElement();
+    endElement();
+}
+
+void KMLStreamWriter::addPolygonStyle(const QString& styleName, const QColor& color, double opacity)
+{
+    QString colorString = kmlColorString(color, opacity);
+
+    startElement(QStringLiteral("Style"));
+    _writer.writeAttribute(QStringLiteral("id"), styleName);
+    startElement(QStringLiteral("PolyStyle"));
+    addTextElement(QStringLiteral("color"), colorString);
+    endElement();
+    startElement(QStringLiteral("LineStyle"));
+    addTextElement(QStringLiteral("color"), colorString);
+    endElement();
+    endElement();
+}
+
+QString KMLStreamWriter::kmlCoordString(double latitude, double longitude, double altitude) const
+{
+    return QStringLiteral("%1,%2,%3").arg(QString::number(longitude, 'f', _latLonDecimals), QString::number(latitude, 'f', _latLonDecimals), QString::number(qIsNaN(altitude) ? 0 : altitude, 'f', _altitudeDecimals));
+}
+
+QString KMLStreamWriter::kmlCoordString(const QGeoCoordinate& coord) const
+{
+    return kmlCoordString(coord.latitude(), coord.longitude(), coord.altitude());
+}
+
+QString KMLStreamWriter::kmlColorString(const QColor& color, double opacity)
+{
+    return QStringLiteral("%1%2%3%4").arg(static_cast<int>(255.0 * opacity), 2, 16, QChar('0')).arg(color.blue(), 2, 16, QChar('0')).arg(color.green(), 2, 16, QChar('0')).arg(color.red(), 2, 16, QChar('0'));
+}
+
+void KMLStreamWriter::addCoordinates(const QList<QGeoCoordinate>& coords, bool closeRing)
+{
+    QString text;
+    text.reserve(_coordinatesChunkChars + 64);
+
+    startElement(QStringLiteral("coordinates"));
+    for (int i=0; i<coords.count() + (closeRing && coords.count() ? 1 : 0); i++) {
+        text += kmlCoordString(coords[i % coords.count()]);
+        text += QLatin1Char('\n');
+        if (text.length() >= _coordinatesChunkChars) {
+            _writer.writeCharacters(text);
+            text.clear();
+        }
+    }
+    _writer.writeCharacters(text);
+    endElement();
+}
+
+void KMLStreamWriter::addCoordinates(const double* latitudes, const double* longitudes, const double* altitudes, int count)
+{
+    QString text;
+    text.reserve(_coordinatesChunkChars + 64);
+
+    startElement(QStringLiteral("coordinates"));
+    for (int i=0; i<count; i++) {
+        text += kmlCoordString(latitudes[i], longitudes[i], altitudes ? altitudes[i] : qQNaN());
+        text += QLatin1Char('\n');
+        if (text.length() >= _coordinatesChunkChars) {
+            _writer.writeCharacters(text);
+            text.clear();
+        }
+    }
+    _writer.writeCharacters(text);
+    endElement();
+}
+
+void KMLStreamWriter::addPoint(const QGeoCoordinate& coord, const QString& altitudeMode)
+{
+    startElement(QStringLiteral("Point"));
+    addTextElement(QStringLiteral("altitudeMode"), altitudeMode);
+    addTextElement(QStringLiteral("coordinates"),  kmlCoordString(coord));
+    addTextElement(QStringLiteral("extrude"),      QStringLiteral("1"));
+    endElement();
+}
+
+void KMLStreamWriter::addLineString(const QList<QGeoCoordinate>& coords, const QString& altitudeMode)
+{
+    startElement(QStringLiteral("LineString"));
+    addTextElement(QStringLiteral("extruder"),     QStringLiteral("1"));
+    addTextElement(QStringLiteral("tessellate"),   QStringLiteral("1"));
+    addTextElement(QStringLiteral("altitudeMode"), altitudeMode);
+    addCoordinates(coords);
+    endElement();
+}
+
+void KMLStreamWriter::addPolygon(const QList<QGeoCoordinate>& vertices, const QString& altitudeMode)
+{
+    startElement(QStringLiteral("Polygon"));
+    addTextElement(QStringLiteral("altitudeMode"), altitudeMode);
+    startElement(QStringLiteral("outerBoundaryIs"));
+    startElement(QStringLiteral("LinearRing"));
+    addCoordinates(vertices, true /* closeRing */);
+    endElement();
+    endElement();
+    endElement();
+}
@@ -0,0 +1,71 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QColor>
+#include <QGeoCoordinate>
+#include <QList>
+#include <QXmlStreamWriter>
+
+class QIODevice;
+
+/// Writes a KML document straight to a device as it is built, so memory use doesn't grow with the size of the export.
+/// Has no ties to the rest of QGC, so it can be used from a worker thread.
+class KMLStreamWriter
+{
+public:
+    /// Starts the document
+    ///     @param name             Document name
+    ///     @param latLonDecimals   Decimal places for latitude and longitude, 7 is about 1cm
+    ///     @param altitudeDecimals Decimal places for altitude
+    KMLStreamWriter(QIODevice* device, const QString& name, int latLonDecimals = 7, int altitudeDecimals = 2);
+
+    /// Closes all open elements and ends the document
+    void finish(void);
+
+    /// @return true: a write to the device failed
+    bool hasError(void) const { return _writer.hasError(); }
+
+    void startElement       (const QString& name);
+    void endElement         (void);
+    void addTextElement     (const QString& name, const QString& value);
+    void addCDATAElement    (const QString& name, const QString& value);
+    void startFolder        (const QString& name);
+    /// Starts a Placemark element, end it with endElement
+    void startPlacemark     (const QString& name, bool visible, const QString& styleName = QString());
+    void addLookAt          (const QGeoCoordinate& coord);
+    void addLineStyle       (const QString& styleName, const QColor& color, int width);
+    void addPolygonStyle    (const QString& styleName, const QColor& color, double opacity);
+
+    /// Adds a coordinates element. The text is written in pieces so a long list never becomes one large string.
+    ///     @param closeRing Repeats the first coordinate at the end, as a polygon's LinearRing requires
+    void addCoordinates     (const QList<QGeoCoordinate>& coords, bool closeRing = false);
+
+    /// Same as the above for a track kept as separate arrays, altitudes can be null
+    void addCoordinates     (const double* latitudes, const double* longitudes, const double* altitudes, int count);
+
+    void addPoint           (const QGeoCoordinate& coord, const QString& altitudeMode);
+    void addLineString      (const QList<QGeoCoordinate>& coords, const QString& altitudeMode);
+    void addPolygon         (const QList<QGeoCoordinate>& vertices, const QString& altitudeMode);
+
+    QString         kmlCoordString  (double latitude, double longitude, double altitude) const;
+    QString         kmlCoordString  (const QGeoCoordinate& coord) const;
+    static QString  kmlColorString  (const QColor& color, double opacity = 1);
+
+    static const char* balloonStyleName;
+
+private:
+    QXmlStreamWriter    _writer;
+    int                 _latLonDecimals;
+    int                 _altitudeDecimals;
+    bool                _finished = false;
+
+    static const int _coordinatesChunkChars = 64 * 1024;    ///< Coordinates text is handed to the writer in pieces of about this size
+};
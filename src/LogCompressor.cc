@@ -21,11 +21,15 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
-#include <QTextStream>
 #include <QStringList>
-#include <QFileInfo>
 #include <QList>
 #include <QDebug>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <limits>
+
+QGC_LOGGING_CATEGORY(LogCompressorLog, "LogCompressorLog")
 
 /**
  * Initializes all the variables necessary for a compression run. This won't actually happen
@@ -42,16 +46,170 @@ LogCompressor::LogCompressor(QString logFileName, QString outFileName, QString d
     connect(this, &LogCompressor::logProcessingCriticalError, qgcApp(), &QGCApplication::criticalMessageBoxOnMainThread);
 }
 
-void LogCompressor::run()
+template<typename Result, typename Map, typename Reduce>
+void LogCompressor::_mapChunks(QFile& file, Map map, Reduce reduce)
+{
+    // Enough chunks in flight to keep the pool busy while the oldest one is reduced, no more
+    const int               maxInFlight = qMax(2, QThread::idealThreadCount());
+    QList<QFuture<Result>>  inFlight;
+    QByteArray              carry;
+
+    while (true) {
+        QByteArray chunk = _readChunk(file, carry);
+        if (!chunk.isEmpty()) {
+            inFlight.append(QtConcurrent::run([map, chunk]() { return map(chunk); }));
+        }
+        if (inFlight.isEmpty()) {
+            break;
+        }
+        if (chunk.isEmpty() || inFlight.count() >= maxInFlight) {
+            reduce(inFlight.takeFirst().result());
+        }
+    }
+}
+
+/// Next chunk of whole lines. The partial line at the end of the read is held in carry for the next chunk.
+QByteArray LogCompressor::_readChunk(QFile& file, QByteArray& carry)
+{
+    QByteArray  chunk = carry;
+    int         newline = -1;
+
+    carry.clear();
+    while (!file.atEnd()) {
+        chunk.append(file.read(chunkBytes));
+        newline = chunk.lastIndexOf('\n');
+        if (newline >= 0) {
+            break;
+        }
+    }
+    if (!file.atEnd() && newline >= 0) {
+        carry = chunk.mid(newline + 1);
+        chunk.truncate(newline + 1);
+    }
+    return chunk;
+}
+
+/// Lines are: timestamp, component, name, value, ...
+/// @return false: Fewer than four fields
+bool LogCompressor::_lineFields(const QByteArray& chunk, int start, int end, const QByteArray& delimiter, QByteArray& timestamp, QByteArray& name, QByteArray& value)
+{
+    int fieldStart[4];
+    int fieldEnd[4];
+    int pos = start;
+
+    for (int i=0; i<4; i++) {
+        int next = chunk.indexOf(delimiter, pos);
+        if (next < 0 || next > end) {
+            if (i < 3) {
+                return false;
+            }
+            next = end;
+        }
+        fieldStart[i]   = pos;
+        fieldEnd[i]     = next;
+        pos = next + delimiter.length();
+    }
+
+    timestamp   = chunk.mid(fieldStart[0], fieldEnd[0] - fieldStart[0]);
+    name        = chunk.mid(fieldStart[2], fieldEnd[2] - fieldStart[2]);
+    value       = chunk.mid(fieldStart[3], fieldEnd[3] - fieldStart[3]);
+    return true;
+}
+
+QSet<QByteArray> LogCompressor::_chunkNames(const QByteArray& chunk, const QByteArray& delimiter)
+{
+    QSet<QByteArray>    names;
+    QByteArray          timestamp, name, value;
+
+    for (int start = 0; start < chunk.length(); ) {
+        int end = chunk.indexOf('\n', start);
+        if (end < 0) {
+            end = chunk.length();
+        }
+        if (_lineFields(chunk, start, end, delimiter, timestamp, name, value)) {
+            names.insert(name);
+        }
+        start = end + 1;
+    }
+    return names;
+}
+
+LogCompressor::ChunkRows_t LogCompressor::_chunkRows(const QByteArray& chunk, const QByteArray& delimiter, const QHash<QByteArray, int>& columns)
+{
+    ChunkRows_t chunkRows;
+    QByteArray  timestamp, name, value;
+
+    chunkRows.lineCount = 0;
+    for (int start = 0; start < chunk.length(); ) {
+        int end = chunk.indexOf('\n', start);
+        if (end < 0) {
+            end = chunk.length();
+        }
+        int lineEnd = end;
+        if (lineEnd > start && chunk.at(lineEnd - 1) == '\r') {
+            lineEnd--;
+        }
+        if (_lineFields(chunk, start, lineEnd, delimiter, timestamp, name, value)) {
+            QHash<QByteArray, int>::const_iterator column = columns.constFind(name);
+            if (column != columns.constEnd()) {
+                QVector<QByteArray>& row = chunkRows.rows[timestamp.toULongLong()];
+                if (row.isEmpty()) {
+                    row.resize(columns.count());
+                }
+                row[column.value()] = value;
+            }
+        }
+        chunkRows.lineCount++;
+        start = end + 1;
+    }
+    return chunkRows;
+}
+
+/// Writes out and removes the rows before the timestamp
+void LogCompressor::_writeRows(QFile& outFile, Rows_t& rows, quint64 before, QVector<QByteArray>& lastValues, int& rowCount)
 {
-	// Verify that the input file is useable
-	QFile infile(logFileName);
-	if (!infile.exists() || !infile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-		_signalCriticalError(tr("Log Compressor: Cannot start/compress log file, since input file %1 is not readable").arg(QFileInfo(infile.fileName()).absoluteFilePath()));
-		return;
-	}
+    const QByteArray    delimiterBytes = delimiter.toLocal8Bit();
+    QByteArray          output;
 
-//    outFileName = logFileName;
+    Rows_t::iterator row = rows.begin();
+    while (row != rows.end() && row.key() < before) {
+        QVector<QByteArray>& values = row.value();
+
+        // Fill holes if necessary
+        for (int i=0; i<values.count(); i++) {
+            if (values[i].isEmpty() || (holeFillingEnabled && values[i] == "NaN")) {
+                values[i] = holeFillingEnabled ? lastValues[i] : QByteArray();
+            }
+        }
+        lastValues = values;
+
+        // Only write from the 3rd row on, since the first rows could be incomplete. They still seed hole filling.
+        if (rowCount > 1) {
+            output += QByteArray::number(row.key());
+            for (const QByteArray& value: values) {
+                output += delimiterBytes;
+                output += value;
+            }
+            output += '\n';
+            if (output.length() >= chunkBytes) {
+                outFile.write(output);
+                output.clear();
+            }
+        }
+        rowCount++;
+        row = rows.erase(row);
+    }
+    outFile.write(output);
+}
+
+void LogCompressor::run()
+{
+    // Verify that the input file is useable
+    QFile infile(logFileName);
+    if (!infile.exists() || !infile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        _signalCriticalError(tr("Log Compressor: Cannot start/compress log file, since input file %1 is not readable").arg(QFileInfo(infile.fileName()).absoluteFilePath()));
+        return;
+    }
 
     QString outFileName;
 
@@ -65,130 +223,82 @@ void LogCompressor::run()
     parts.replace(parts.size()-1, "txt");
     outFileName = parts.join(".");
 
-	// Verify that the output file is useable
+    // Verify that the output file is useable
     QFile outTmpFile(outFileName);
     if (!outTmpFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
-		_signalCriticalError(tr("Log Compressor: Cannot start/compress log file, since output file %1 is not writable").arg(QFileInfo(outTmpFile.fileName()).absoluteFilePath()));
-		return;
-	}
-
-
-	// First we search the input file through keySearchLimit number of lines
-	// looking for variables. This is necessary before CSV files require
-	// the same number of fields for every line.
-	const unsigned int keySearchLimit = 15000;
-	unsigned int keyCounter = 0;
-	QTextStream in(&infile);
-	QMap<QString, int> messageMap;
-
-	while (!in.atEnd() && keyCounter < keySearchLimit) {
-		QString messageName = in.readLine().split(delimiter).at(2);
-		messageMap.insert(messageName, 0);
-		++keyCounter;
-	}
-
-	// Now update each key with its index in the output string. These are
-	// all offset by one to account for the first field: timestamp_ms.
-    QMap<QString, int>::iterator i = messageMap.begin();
-	int j;
-	for (i = messageMap.begin(), j = 1; i != messageMap.end(); ++i, ++j) {
-		i.value() = j;
-	}
-
-	// Open the output file and write the header line to it
-	QStringList headerList(messageMap.keys());
-
-	QString headerLine = "timestamp_ms" + delimiter + headerList.join(delimiter) + "\n";
+        _signalCriticalError(tr("Log Compressor: Cannot start/compress log file, since output file %1 is not writable").arg(QFileInfo(outTmpFile.fileName()).absoluteFilePath()));
+        return;
+    }
+
+    const QByteArray delimiterBytes = delimiter.toLocal8Bit();
+
+    // First pass collects the variables from every chunk. This is necessary since CSV files require the same number
+    // of fields for every line.
+    QSet<QByteArray> names;
+    _mapChunks<QSet<QByteArray>>(infile,
+                                 [delimiterBytes](const QByteArray& chunk) { return _chunkNames(chunk, delimiterBytes); },
+                                 [&names](const QSet<QByteArray>& chunkNames) { names.unite(chunkNames); });
+
+    // Columns are in name order, offset by one to account for the first field: timestamp_ms
+    QList<QByteArray> headerList = names.values();
+    std::sort(headerList.begin(), headerList.end());
+    QHash<QByteArray, int> columns;
+    for (int i=0; i<headerList.count(); i++) {
+        columns[headerList[i]] = i;
+    }
+
+    // Write the header line to the output file
+    QString headerLine = "timestamp_ms";
+    for (const QByteArray& name: headerList) {
+        headerLine += delimiter + QString::fromLocal8Bit(name);
+    }
+    headerLine += "\n";
     // Clean header names from symbols Matlab considers as Latex syntax
     headerLine = headerLine.replace("timestamp", "TIMESTAMP");
     headerLine = headerLine.replace(":", "");
     headerLine = headerLine.replace("_", "");
     headerLine = headerLine.replace(".", "");
-	outTmpFile.write(headerLine.toLocal8Bit());
-
-    _signalCriticalError(tr("Log compressor: Dataset contains dimensions: ") + headerLine);
-
-    // Template list stores a list for populating with data as it's parsed from messages.
-    QStringList templateList;
-    for (int i = 0; i < headerList.size() + 1; ++i) {
-        templateList << (holeFillingEnabled?"NaN":"");
-    }
-
-
-//	// Reset our position in the input file before we start the main processing loop.
-//    in.seek(0);
-
-//    // Search through all lines and build a list of unique timestamps
-//    QMap<quint64, QStringList> timestampMap;
-//    while (!in.atEnd()) {
-//        quint64 timestamp = in.readLine().split(delimiter).at(0).toULongLong();
-//        timestampMap.insert(timestamp, templateList);
-//    }
-
-    // Jump back to start of file
-    in.seek(0);
-
-    // Map of final output lines, key is time
-    QMap<quint64, QStringList> timestampMap;
-
-    // Run through the whole file and fill map of timestamps
-    while (!in.atEnd()) {
-        QStringList newLine = in.readLine().split(delimiter);
-        quint64 timestamp = newLine.at(0).toULongLong();
-
-        // Check if timestamp does exist - if not, add it
-        if (!timestampMap.contains(timestamp)) {
-            timestampMap.insert(timestamp, templateList);
-        }
-
-        QStringList list = timestampMap.value(timestamp);
-
-        QString currentDataName = newLine.at(2);
-        QString currentDataValue = newLine.at(3);
-        list.replace(messageMap.value(currentDataName), currentDataValue);
-        timestampMap.insert(timestamp, list);
-    }
-
-    int lineCounter = 0;
-
-    QStringList lastList = timestampMap.values().at(1);
-
-    foreach (QStringList list, timestampMap.values()) {
-        // Write this current time set out to the file
-        // only do so from the 2nd line on, since the first
-        // line could be incomplete
-        if (lineCounter > 1) {
-            // Set the timestamp
-            list.replace(0,QString("%1").arg(timestampMap.keys().at(lineCounter)));
-
-            // Fill holes if necessary
-            if (holeFillingEnabled) {
-                int index = 0;
-                foreach (const QString& str, list) {
-                    if (str == "" || str == "NaN") {
-                        list.replace(index, lastList.at(index));
+    outTmpFile.write(headerLine.toLocal8Bit());
+
+    qCDebug(LogCompressorLog) << "Dataset contains dimensions:" << headerLine;
+
+    // Second pass merges the rows of each chunk in file order. A row can only still change while later chunks may
+    // hold samples for its timestamp, so everything before the start of the previous chunk is written out.
+    infile.seek(0);
+    Rows_t              pending;
+    QVector<QByteArray> lastValues(columns.count(), holeFillingEnabled ? QByteArray("NaN") : QByteArray());
+    int                 rowCount = 0;
+    quint64             flushBefore = 0;
+    _mapChunks<ChunkRows_t>(infile,
+                            [delimiterBytes, columns](const QByteArray& chunk) { return _chunkRows(chunk, delimiterBytes, columns); },
+                            [&](const ChunkRows_t& chunkRows) {
+        _writeRows(outTmpFile, pending, flushBefore, lastValues, rowCount);
+        for (Rows_t::const_iterator row = chunkRows.rows.constBegin(); row != chunkRows.rows.constEnd(); ++row) {
+            Rows_t::iterator pendingRow = pending.find(row.key());
+            if (pendingRow == pending.end()) {
+                pending.insert(row.key(), row.value());
+            } else {
+                for (int i=0; i<row.value().count(); i++) {
+                    if (!row.value()[i].isNull()) {
+                        (*pendingRow)[i] = row.value()[i];
                     }
-                    index++;
                 }
             }
-
-            // Set last list
-            lastList = list;
-
-            // Write data columns
-            QString output = list.join(delimiter) + "\n";
-            outTmpFile.write(output.toLocal8Bit());
         }
-        lineCounter++;
-    }
+        if (!chunkRows.rows.isEmpty()) {
+            flushBefore = chunkRows.rows.firstKey();
+        }
+        currentDataLine += chunkRows.lineCount;
+    });
+    _writeRows(outTmpFile, pending, std::numeric_limits<quint64>::max(), lastValues, rowCount);
 
-	// We're now done with the source file
-	infile.close();
+    // We're now done with the source file
+    infile.close();
 
-	// Clean up and update the status before we return.
-	currentDataLine = 0;
-	emit finishedFile(outFileName);
-	running = false;
+    // Clean up and update the status before we return.
+    currentDataLine = 0;
+    emit finishedFile(outFileName);
+    running = false;
 }
 
 /**
@@ -9,13 +9,30 @@
 
 #pragma once
 
+#include "QGCLoggingCategory.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QSet>
 #include <QThread>
+#include <QVector>
+
+class QFile;
+
+Q_DECLARE_LOGGING_CATEGORY(LogCompressorLog)
 
 /**
  * @file
  *   @brief Declaration of class LogCompressor.
  *          This class reads in a file containing messages and translates it into a tab-delimited CSV file.
  *   @author Lorenz Meier <mavteam@student.ethz.ch>
+ *
+ * The input is streamed through in chunks of about chunkBytes. Chunks are parsed on the global thread pool, a few at
+ * a time, and merged in file order. A first pass collects the column names from every chunk, the second builds the
+ * output rows and writes out every row which is more than a chunk behind the one just merged. Memory use depends on
+ * the chunk size and thread count, not on the length of the log. Rows come out in timestamp order as long as the log
+ * is never out of order by more than a chunk, which the line based logs always are.
  */
 
 class LogCompressor : public QThread
@@ -29,6 +46,8 @@ public:
     bool isFinished();
     int getCurrentLine();
 
+    static const int chunkBytes = 4 * 1024 * 1024;     ///< Input is parsed in chunks of about this size
+
 protected:
     void run();                     ///< This function actually performs the compression. It's an overloaded function from QThread
     QString logFileName;            ///< The input file name.
@@ -49,6 +68,22 @@ signals:
     void logProcessingCriticalError(const QString& title, const QString& msg);
     
 private:
+    typedef QMap<quint64, QVector<QByteArray>> Rows_t;    ///< Column values by timestamp, a null value for no sample
+
+    typedef struct {
+        Rows_t  rows;
+        int     lineCount;
+    } ChunkRows_t;
+
     void _signalCriticalError(const QString& msg);
-    
+
+    template<typename Result, typename Map, typename Reduce>
+    static void _mapChunks(QFile& file, Map map, Reduce reduce);
+
+    static QByteArray       _readChunk  (QFile& file, QByteArray& carry);
+    static bool             _lineFields (const QByteArray& chunk, int start, int end, const QByteArray& delimiter, QByteArray& timestamp, QByteArray& name, QByteArray& value);
+    static QSet<QByteArray> _chunkNames (const QByteArray& chunk, const QByteArray& delimiter);
+    static ChunkRows_t      _chunkRows  (const QByteArray& chunk, const QByteArray& delimiter, const QHash<QByteArray, int>& columns);
+
+    void _writeRows(QFile& outFile, Rows_t& rows, quint64 before, QVector<QByteArray>& lastValues, int& rowCount);
 };
@@ -107,9 +107,8 @@ MicrohardManager::_createMetadata(const char* name, QStringList enums)
 
 //-----------------------------------------------------------------------------
 void
-MicrohardManager::setToolbox(QGCToolbox* toolbox)
+MicrohardManager::deferredInit()
 {
-    QGCTool::setToolbox(toolbox);
     //-- Start it all
     _reset();
 }
@@ -42,7 +42,7 @@ public:
     explicit MicrohardManager                   (QGCApplication* app, QGCToolbox* toolbox);
     ~MicrohardManager                           () override;
 
-    void        setToolbox                      (QGCToolbox* toolbox) override;
+    void        deferredInit                    () override;
 
     int         connected                       () { return _connectedStatus; }
     int         linkConnected                   () { return _linkConnectedStatus; }
@@ -30,7 +30,7 @@ const char* CameraCalc::_jsonCameraSpecTypeKey =            "CameraSpecType";
 CameraCalc::CameraCalc(PlanMasterController* masterController, const QString& settingsGroup, QObject* parent)
     : CameraSpec                    (settingsGroup, parent)
     , _knownCameraList              (masterController->controllerVehicle()->staticCameraList())
-    , _metaDataMap                  (FactMetaData::createMapFromJsonFile(QStringLiteral(":/json/CameraCalc.FactMetaData.json"), this))
+    , _metaDataMap                  (FactMetaData::sharedMapFromJsonFile(QStringLiteral(":/json/CameraCalc.FactMetaData.json")))
     , _cameraNameFact               (settingsGroup, _metaDataMap[cameraNameName])
     , _valueSetIsDistanceFact       (settingsGroup, _metaDataMap[valueSetIsDistanceName])
     , _distanceToSurfaceFact        (settingsGroup, _metaDataMap[distanceToSurfaceName])
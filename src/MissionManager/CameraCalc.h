@@ -131,7 +131,7 @@ private:
     double          _imageFootprintFrontal      = 0;
     QVariantList    _knownCameraList;
 
-    QMap<QString, FactMetaData*> _metaDataMap;
+    const QMap<QString, FactMetaData*> _metaDataMap;
 
     SettingsFact _cameraNameFact;
     SettingsFact _valueSetIsDistanceFact;
@@ -38,7 +38,7 @@ CameraSection::CameraSection(PlanMasterController* masterController, QObject* pa
     , _dirty                            (false)
 {
     if (_metaDataMap.isEmpty()) {
-        _metaDataMap = FactMetaData::createMapFromJsonFile(QStringLiteral(":/json/CameraSection.FactMetaData.json"), Q_NULLPTR /* metaDataParent */);
+        _metaDataMap = FactMetaData::sharedMapFromJsonFile(QStringLiteral(":/json/CameraSection.FactMetaData.json"));
     }
 
     _gimbalPitchFact.setMetaData                    (_metaDataMap[_gimbalPitchName]);
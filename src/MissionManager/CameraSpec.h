@@ -51,7 +51,7 @@ signals:
 private:
     bool _dirty;
 
-    QMap<QString, FactMetaData*> _metaDataMap;
+    const QMap<QString, FactMetaData*> _metaDataMap;
 
     SettingsFact _sensorWidthFact;
     SettingsFact _sensorHeightFact;
@@ -111,7 +111,7 @@ QJsonObject ComplexMissionItem::_loadPresetJson(const QString& name)
     return QCborValue(settings.value(name).toByteArray()).toMap().toJsonObject();
 }
 
-void ComplexMissionItem::addKMLVisuals(KMLPlanDomDocument& /* domDocument */)
+void ComplexMissionItem::addKMLVisuals(KMLPlanDocument& /* planDocument */)
 {
     // Default implementation has no visuals
 }
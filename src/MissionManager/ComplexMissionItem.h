@@ -13,7 +13,7 @@
 #include "QGCGeo.h"
 #include "QGCToolbox.h"
 #include "SettingsManager.h"
-#include "KMLPlanDomDocument.h"
+#include "KMLPlanDocument.h"
 #include "QmlObjectListModel.h"
 
 #include <QSettings>
@@ -93,7 +93,7 @@ public:
     ///     Empty string signals no support for presets.
     virtual QString presetsSettingsGroup(void) { return QString(); }
 
-    virtual void addKMLVisuals(KMLPlanDomDocument& domDocument);
+    virtual void addKMLVisuals(KMLPlanDocument& planDocument);
 
     bool presetsSupported   (void) { return !presetsSettingsGroup().isEmpty(); }
     bool isIncomplete       (void) const { return _isIncomplete; }
@@ -19,6 +19,7 @@
 #include "QGCApplication.h"
 
 #include <QPolygonF>
+#include <QtConcurrent>
 
 QGC_LOGGING_CATEGORY(CorridorScanComplexItemLog, "CorridorScanComplexItemLog")
 
@@ -33,8 +34,9 @@ const char* CorridorScanComplexItem::jsonComplexItemTypeValue = "CorridorScan";
 CorridorScanComplexItem::CorridorScanComplexItem(PlanMasterController* masterController, bool flyView, const QString& kmlFile, QObject* parent)
     : TransectStyleComplexItem  (masterController, flyView, settingsGroup, parent)
     , _entryPoint               (0)
-    , _metaDataMap              (FactMetaData::createMapFromJsonFile(QStringLiteral(":/json/CorridorScan.SettingsGroup.json"), this))
+    , _metaDataMap              (FactMetaData::sharedMapFromJsonFile(QStringLiteral(":/json/CorridorScan.SettingsGroup.json")))
     , _corridorWidthFact        (settingsGroup, _metaDataMap[corridorWidthName])
+    , _transectsGeneration      (new QAtomicInt(0))
 {
     _editorQml = "qrc:/qml/CorridorScanEditor.qml";
 
@@ -48,12 +50,16 @@ CorridorScanComplexItem::CorridorScanComplexItem(PlanMasterController* masterCon
 
     connect(&_corridorPolyline,     &QGCMapPolyline::dirtyChanged,                  this, &CorridorScanComplexItem::_polylineDirtyChanged);
 
+    // Drops the cached geometry before the rebuild below uses it
+    connect(&_corridorPolyline,     &QGCMapPolyline::pathChanged,                   this, &CorridorScanComplexItem::_corridorPolylineChanged);
     connect(&_corridorPolyline,     &QGCMapPolyline::pathChanged,                   this, &CorridorScanComplexItem::_rebuildCorridorPolygon);
     connect(&_corridorWidthFact,    &Fact::valueChanged,                            this, &CorridorScanComplexItem::_rebuildCorridorPolygon);
 
     connect(&_corridorPolyline,     &QGCMapPolyline::isValidChanged,                this, &CorridorScanComplexItem::_updateWizardMode);
     connect(&_corridorPolyline,     &QGCMapPolyline::traceModeChanged,              this, &CorridorScanComplexItem::_updateWizardMode);
 
+    connect(&_transectsWatcher,     &QFutureWatcherBase::finished,                  this, &CorridorScanComplexItem::_transectsJobFinished);
+
     if (!kmlFile.isEmpty()) {
         _corridorPolyline.loadKMLFile(kmlFile);
         _corridorPolyline.setDirty(false);
@@ -61,6 +67,12 @@ CorridorScanComplexItem::CorridorScanComplexItem(PlanMasterController* masterCon
     setDirty(false);
 }
 
+CorridorScanComplexItem::~CorridorScanComplexItem()
+{
+    // A job still running holds its own reference to the generation counter, this makes it give up
+    _transectsGeneration->fetchAndAddOrdered(1);
+}
+
 void CorridorScanComplexItem::save(QJsonArray&  planItems)
 {
     QJsonObject saveObject;
@@ -175,10 +187,11 @@ void CorridorScanComplexItem::_rebuildCorridorPolygon(void)
 
     double halfWidth = _corridorWidthFact.rawValue().toDouble() / 2.0;
 
-    QList<QGeoCoordinate> firstSideVertices = _corridorPolyline.offsetPolyline(halfWidth);
-    QList<QGeoCoordinate> secondSideVertices = _corridorPolyline.offsetPolyline(-halfWidth);
-
-    _surveyAreaPolygon.clear();
+    if (_nedPolyline.isEmpty()) {
+        _nedPolyline = _corridorPolyline.nedPolyline();
+    }
+    QList<QGeoCoordinate> firstSideVertices = QGCMapPolyline::offsetPolyline(_nedPolyline, _corridorPolyline.vertexCoordinate(0), halfWidth);
+    QList<QGeoCoordinate> secondSideVertices = QGCMapPolyline::offsetPolyline(_nedPolyline, _corridorPolyline.vertexCoordinate(0), -halfWidth);
 
     QList<QGeoCoordinate> rgCoord;
     for (const QGeoCoordinate& vertex: firstSideVertices) {
@@ -187,7 +200,12 @@ void CorridorScanComplexItem::_rebuildCorridorPolygon(void)
     for (int i=secondSideVertices.count() - 1; i >= 0; i--) {
         rgCoord.append(secondSideVertices[i]);
     }
+
+    // A single path change, so the transects are rebuilt once instead of for the cleared polygon as well
+    _surveyAreaPolygon.beginReset();
+    _surveyAreaPolygon.clear();
     _surveyAreaPolygon.appendVertices(rgCoord);
+    _surveyAreaPolygon.endReset();
 }
 
 void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
@@ -196,135 +214,255 @@ void CorridorScanComplexItem::_rebuildTransectsPhase1(void)
         return;
     }
 
+    _clearLoadedMissionItems();
+    _setTransectsResult(_buildTransects(_transectsInput()));
+}
+
+bool CorridorScanComplexItem::_rebuildTransectsPhase1Background(void)
+{
+    _clearLoadedMissionItems();
+
+    // Taking a new snapshot cancels any job still working from an older one
+    TransectsInput_t input = _transectsInput();
+    if (_transectsJobCost(input) < _backgroundRebuildMinCost) {
+        _transectsJobPending = false;
+        return false;
+    }
+
+    qCDebug(CorridorScanComplexItemLog) << "_rebuildTransectsPhase1Background generation" << input.generation;
+    _transectsJobPending = true;
+    input.parallel = true;
+    _transectsWatcher.setFuture(QtConcurrent::run(&CorridorScanComplexItem::_buildTransects, input));
+    return true;
+}
+
+void CorridorScanComplexItem::_waitForRebuildTransectsPhase1(void)
+{
+    if (_transectsJobPending) {
+        _transectsWatcher.waitForFinished();
+        _transectsJobFinished();
+    }
+}
+
+void CorridorScanComplexItem::_transectsJobFinished(void)
+{
+    // The watcher only ever follows the latest job, anything older was dropped by setFuture
+    if (!_transectsJobPending) {
+        return;
+    }
+    _transectsJobPending = false;
+
+    _setTransectsResult(_transectsWatcher.result());
+    _rebuildTransectsPhase2();
+}
+
+void CorridorScanComplexItem::_setTransectsResult(const TransectsResult_t& result)
+{
+    _transects              = result.transects;
+    _offsetPolylines        = result.offsetPolylines;
+    _offsetPolylinesOffsets = result.offsets;
+}
+
+void CorridorScanComplexItem::_clearLoadedMissionItems(void)
+{
     // If the transects are getting rebuilt then any previsouly loaded mission items are now invalid
     if (_loadedMissionItemsParent) {
         _loadedMissionItems.clear();
         _loadedMissionItemsParent->deleteLater();
         _loadedMissionItemsParent = nullptr;
     }
+}
 
-    double transectSpacing = _calcTransectSpacing();
-    double fullWidth = _corridorWidthFact.rawValue().toDouble();
-    double halfWidth = fullWidth / 2.0;
-    int transectCount = _calcTransectCount();
-    double normalizedTransectPosition = transectSpacing / 2.0;
+void CorridorScanComplexItem::_corridorPolylineChanged(void)
+{
+    _nedPolyline.clear();
+    _offsetPolylines.clear();
+    _offsetPolylinesOffsets.clear();
+}
+
+CorridorScanComplexItem::TransectsInput_t CorridorScanComplexItem::_transectsInput(void)
+{
+    TransectsInput_t input;
 
     if (_corridorPolyline.count() >= 2) {
-        // First build up the transects all going the same direction
-        //qDebug() << "_rebuildTransectsPhase1";
+        // Projecting the polyline only has to happen again once it changes
+        if (_nedPolyline.isEmpty()) {
+            _nedPolyline = _corridorPolyline.nedPolyline();
+        }
+        input.nedPolyline   = _nedPolyline;
+        input.tangentOrigin = _corridorPolyline.vertexCoordinate(0);
+
+        double  transectSpacing             = _calcTransectSpacing();
+        double  halfWidth                   = _corridorWidthFact.rawValue().toDouble() / 2.0;
+        int     transectCount               = _calcTransectCount();
+        double  normalizedTransectPosition  = transectSpacing / 2.0;
         for (int i=0; i<transectCount; i++) {
-            //qDebug() << "start transect";
-            double offsetDistance;
-            if (transectCount == 1) {
-                // Single transect is flown over scan line
-                offsetDistance = 0;
-            } else {
-                // Convert from normalized to absolute transect offset distance
-                offsetDistance = halfWidth - normalizedTransectPosition;
-            }
+            // Single transect is flown over scan line, otherwise convert from normalized to absolute transect offset distance
+            input.offsets.append(transectCount == 1 ? 0 : halfWidth - normalizedTransectPosition);
+            normalizedTransectPosition += transectSpacing;
+        }
 
-            // Turn transect into CoordInfo transect
-            QList<TransectStyleComplexItem::CoordInfo_t> transect;
-            QList<QGeoCoordinate> transectCoords = _corridorPolyline.offsetPolyline(offsetDistance);
-            for (int j=1; j<transectCoords.count() - 1; j++) {
-                TransectStyleComplexItem::CoordInfo_t coordInfo = { transectCoords[j], CoordTypeInterior };
-                transect.append(coordInfo);
-            }
-            TransectStyleComplexItem::CoordInfo_t coordInfo = { transectCoords.first(), CoordTypeSurveyEntry };
-            transect.prepend(coordInfo);
-            coordInfo = { transectCoords.last(), CoordTypeSurveyExit };
-            transect.append(coordInfo);
+        // Turnaround and entry point changes don't move the offset polylines
+        if (input.offsets == _offsetPolylinesOffsets) {
+            input.offsetPolylines = _offsetPolylines;
+        }
+    }
+    input.turnAroundDistance    = _hasTurnaround() ? _turnAroundDistanceFact.rawValue().toDouble() : 0;
+    input.entryPoint            = _entryPoint;
+    input.parallel              = false;
+    input.generation            = _transectsGeneration->fetchAndAddOrdered(1) + 1;
+    input.currentGeneration     = _transectsGeneration;
 
-            // Extend the transect ends for turnaround
-            if (_hasTurnaround()) {
-                 QGeoCoordinate turnaroundCoord;
-                 double turnAroundDistance = _turnAroundDistanceFact.rawValue().toDouble();
-
-                 double azimuth = transectCoords[0].azimuthTo(transectCoords[1]);
-                 turnaroundCoord = transectCoords[0].atDistanceAndAzimuth(-turnAroundDistance, azimuth);
-                 turnaroundCoord.setAltitude(qQNaN());
-                 TransectStyleComplexItem::CoordInfo_t coordInfo = { turnaroundCoord, CoordTypeTurnaround };
-                 transect.prepend(coordInfo);
-
-                 azimuth = transectCoords.last().azimuthTo(transectCoords[transectCoords.count() - 2]);
-                 turnaroundCoord = transectCoords.last().atDistanceAndAzimuth(-turnAroundDistance, azimuth);
-                 turnaroundCoord.setAltitude(qQNaN());
-                 coordInfo = { turnaroundCoord, CoordTypeTurnaround };
-                 transect.append(coordInfo);
-            }
+    return input;
+}
 
-#if 0
-            qDebug() << "transect debug";
-            for (const TransectStyleComplexItem::CoordInfo_t& coordInfo: transect) {
-                qDebug() << coordInfo.coordType;
-            }
-#endif
+/// @return Number of offset polyline edges which have to be built for the input
+int CorridorScanComplexItem::_transectsJobCost(const TransectsInput_t& input)
+{
+    return input.offsetPolylines.isEmpty() ? input.offsets.count() * input.nedPolyline.count() : 0;
+}
 
-            _transects.append(transect);
-            normalizedTransectPosition += transectSpacing;
-        }
+bool CorridorScanComplexItem::_transectsJobCancelled(const TransectsInput_t& input)
+{
+    return input.currentGeneration && input.currentGeneration->loadAcquire() != input.generation;
+}
 
-        // Now deal with fixing up the entry point:
-        //  0: Leave alone
-        //  1: Start at same end, opposite side of center
-        //  2: Start at opposite end, same side
-        //  3: Start at opposite end, opposite side
-
-        bool reverseTransects = false;
-        bool reverseVertices = false;
-        switch (_entryPoint) {
-        case 0:
-            reverseTransects = false;
-            reverseVertices = false;
-            break;
-        case 1:
-            reverseTransects = true;
-            reverseVertices = false;
-            break;
-        case 2:
-            reverseTransects = false;
-            reverseVertices = true;
-            break;
-        case 3:
-            reverseTransects = true;
-            reverseVertices = true;
-            break;
-        }
-        if (reverseTransects) {
-            QList<QList<TransectStyleComplexItem::CoordInfo_t>> reversedTransects;
-            for (const QList<TransectStyleComplexItem::CoordInfo_t>& transect: _transects) {
-                reversedTransects.prepend(transect);
+QList<QGeoCoordinate> CorridorScanComplexItem::_offsetPolyline(const TransectsInput_t& input, double offset)
+{
+    if (_transectsJobCancelled(input)) {
+        return QList<QGeoCoordinate>();
+    }
+    return QGCMapPolyline::offsetPolyline(input.nedPolyline, input.tangentOrigin, offset);
+}
+
+/// Builds the transects from the input snapshot. Runs on a worker thread for large corridors so it must not touch this object.
+CorridorScanComplexItem::TransectsResult_t CorridorScanComplexItem::_buildTransects(const TransectsInput_t& input)
+{
+    TransectsResult_t result;
+
+    if (input.nedPolyline.count() < 2) {
+        return result;
+    }
+
+    // Each offset polyline only depends on the corridor polyline and its own offset
+    QList<QList<QGeoCoordinate>> offsetPolylines = input.offsetPolylines;
+    if (offsetPolylines.isEmpty()) {
+        if (input.parallel) {
+            QList<QFuture<QList<QGeoCoordinate>>> futures;
+            for (double offset: input.offsets) {
+                futures.append(QtConcurrent::run(&CorridorScanComplexItem::_offsetPolyline, input, offset));
             }
-            _transects = reversedTransects;
-        }
-        if (reverseVertices) {
-            for (int i=0; i<_transects.count(); i++) {
-                QList<TransectStyleComplexItem::CoordInfo_t> reversedVertices;
-                for (const TransectStyleComplexItem::CoordInfo_t& vertex: _transects[i]) {
-                    reversedVertices.prepend(vertex);
-                }
-                _transects[i] = reversedVertices;
+            for (QFuture<QList<QGeoCoordinate>>& future: futures) {
+                offsetPolylines.append(future.result());
+            }
+        } else {
+            for (double offset: input.offsets) {
+                offsetPolylines.append(_offsetPolyline(input, offset));
             }
         }
+        if (_transectsJobCancelled(input)) {
+            return result;
+        }
+    }
+    result.offsets          = input.offsets;
+    result.offsetPolylines  = offsetPolylines;
+
+    // First build up the transects all going the same direction
+    for (const QList<QGeoCoordinate>& transectCoords: offsetPolylines) {
+        // Turn transect into CoordInfo transect
+        QList<TransectStyleComplexItem::CoordInfo_t> transect;
+        for (int j=1; j<transectCoords.count() - 1; j++) {
+            TransectStyleComplexItem::CoordInfo_t coordInfo = { transectCoords[j], CoordTypeInterior };
+            transect.append(coordInfo);
+        }
+        TransectStyleComplexItem::CoordInfo_t coordInfo = { transectCoords.first(), CoordTypeSurveyEntry };
+        transect.prepend(coordInfo);
+        coordInfo = { transectCoords.last(), CoordTypeSurveyExit };
+        transect.append(coordInfo);
+
+        // Extend the transect ends for turnaround
+        if (input.turnAroundDistance > 0) {
+             QGeoCoordinate turnaroundCoord;
+             double turnAroundDistance = input.turnAroundDistance;
+
+             double azimuth = transectCoords[0].azimuthTo(transectCoords[1]);
+             turnaroundCoord = transectCoords[0].atDistanceAndAzimuth(-turnAroundDistance, azimuth);
+             turnaroundCoord.setAltitude(qQNaN());
+             TransectStyleComplexItem::CoordInfo_t coordInfo = { turnaroundCoord, CoordTypeTurnaround };
+             transect.prepend(coordInfo);
+
+             azimuth = transectCoords.last().azimuthTo(transectCoords[transectCoords.count() - 2]);
+             turnaroundCoord = transectCoords.last().atDistanceAndAzimuth(-turnAroundDistance, azimuth);
+             turnaroundCoord.setAltitude(qQNaN());
+             coordInfo = { turnaroundCoord, CoordTypeTurnaround };
+             transect.append(coordInfo);
+        }
+
+        result.transects.append(transect);
+    }
 
-        // Adjust to lawnmower pattern
+    // Now deal with fixing up the entry point:
+    //  0: Leave alone
+    //  1: Start at same end, opposite side of center
+    //  2: Start at opposite end, same side
+    //  3: Start at opposite end, opposite side
+
+    bool reverseTransects = false;
+    bool reverseVertices = false;
+    switch (input.entryPoint) {
+    case 0:
+        reverseTransects = false;
+        reverseVertices = false;
+        break;
+    case 1:
+        reverseTransects = true;
         reverseVertices = false;
-        for (int i=0; i<_transects.count(); i++) {
-            // We must reverse the vertices for every other transect in order to make a lawnmower pattern
-            QList<TransectStyleComplexItem::CoordInfo_t> transectVertices = _transects[i];
-            if (reverseVertices) {
-                reverseVertices = false;
-                QList<TransectStyleComplexItem::CoordInfo_t> reversedVertices;
-                for (int j=transectVertices.count()-1; j>=0; j--) {
-                    reversedVertices.append(transectVertices[j]);
-                }
-                transectVertices = reversedVertices;
-            } else {
-                reverseVertices = true;
+        break;
+    case 2:
+        reverseTransects = false;
+        reverseVertices = true;
+        break;
+    case 3:
+        reverseTransects = true;
+        reverseVertices = true;
+        break;
+    }
+    if (reverseTransects) {
+        QList<QList<TransectStyleComplexItem::CoordInfo_t>> reversedTransects;
+        for (const QList<TransectStyleComplexItem::CoordInfo_t>& transect: result.transects) {
+            reversedTransects.prepend(transect);
+        }
+        result.transects = reversedTransects;
+    }
+    if (reverseVertices) {
+        for (int i=0; i<result.transects.count(); i++) {
+            QList<TransectStyleComplexItem::CoordInfo_t> reversedVertices;
+            for (const TransectStyleComplexItem::CoordInfo_t& vertex: result.transects[i]) {
+                reversedVertices.prepend(vertex);
             }
-            _transects[i] = transectVertices;
+            result.transects[i] = reversedVertices;
         }
     }
+
+    // Adjust to lawnmower pattern
+    reverseVertices = false;
+    for (int i=0; i<result.transects.count(); i++) {
+        // We must reverse the vertices for every other transect in order to make a lawnmower pattern
+        QList<TransectStyleComplexItem::CoordInfo_t> transectVertices = result.transects[i];
+        if (reverseVertices) {
+            reverseVertices = false;
+            QList<TransectStyleComplexItem::CoordInfo_t> reversedVertices;
+            for (int j=transectVertices.count()-1; j>=0; j--) {
+                reversedVertices.append(transectVertices[j]);
+            }
+            transectVertices = reversedVertices;
+        } else {
+            reverseVertices = true;
+        }
+        result.transects[i] = transectVertices;
+    }
+
+    return result;
 }
 
 void CorridorScanComplexItem::_recalcCameraShots(void)
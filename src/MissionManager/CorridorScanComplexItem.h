@@ -16,6 +16,10 @@
 #include "QGCMapPolyline.h"
 #include "QGCMapPolygon.h"
 
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QSharedPointer>
+
 Q_DECLARE_LOGGING_CATEGORY(CorridorScanComplexItemLog)
 
 class CorridorScanComplexItem : public TransectStyleComplexItem
@@ -26,6 +30,7 @@ public:
     /// @param flyView true: Created for use in the Fly View, false: Created for use in the Plan View
     /// @param kmlFile Polyline comes from this file, empty for default polyline
     CorridorScanComplexItem(PlanMasterController* masterController, bool flyView, const QString& kmlFile, QObject* parent);
+    ~CorridorScanComplexItem();
 
     Q_PROPERTY(QGCMapPolyline*  corridorPolyline    READ corridorPolyline   CONSTANT)
     Q_PROPERTY(Fact*            corridorWidth       READ corridorWidth      CONSTANT)
@@ -35,6 +40,9 @@ public:
 
     Q_INVOKABLE void rotateEntryPoint(void);
 
+    // Used internally only by unit tests
+    void _setBackgroundRebuildMinCost(int cost) { _backgroundRebuildMinCost = cost; }
+
     // Overrides from TransectStyleComplexItem
     QString patternName         (void) const final { return name; }
     void    save                (QJsonArray&  planItems) final;
@@ -61,6 +69,7 @@ public:
 
 private slots:
     void _polylineDirtyChanged          (bool dirty);
+    void _corridorPolylineChanged       (void);
     void _rebuildCorridorPolygon        (void);
     void _updateWizardMode              (void);
 
@@ -68,17 +77,59 @@ private slots:
     void _rebuildTransectsPhase1    (void) final;
     void _recalcCameraShots         (void) final;
 
+    void _transectsJobFinished      (void);
+
 private:
+    /// Immutable copy of everything transect generation depends on so it can run away from the gui thread
+    typedef struct {
+        QList<QPointF>                  nedPolyline;            ///< Corridor polyline in NED around tangentOrigin
+        QGeoCoordinate                  tangentOrigin;          ///< First polyline vertex
+        QList<double>                   offsets;                ///< Offset from the polyline of each transect
+        QList<QList<QGeoCoordinate>>    offsetPolylines;        ///< Already built for these offsets, empty: build them
+        double                          turnAroundDistance;     ///< 0 for no turnaround
+        int                             entryPoint;
+        bool                            parallel;               ///< Build the offset polylines concurrently
+        int                             generation;             ///< Job is stale once currentGeneration no longer matches
+        QSharedPointer<QAtomicInt>      currentGeneration;
+    } TransectsInput_t;
+
+    typedef struct {
+        QList<double>                   offsets;
+        QList<QList<QGeoCoordinate>>    offsetPolylines;
+        QList<QList<CoordInfo_t>>       transects;
+    } TransectsResult_t;
+
+    // Overrides from TransectStyleComplexItem
+    bool _rebuildTransectsPhase1Background  (void) final;
+    void _waitForRebuildTransectsPhase1     (void) final;
+
     double  _calcTransectSpacing    (void) const;
     int     _calcTransectCount      (void) const;
 
-    QGCMapPolyline                  _corridorPolyline;
-    QList<QList<QGeoCoordinate>>    _transectSegments;      ///< Internal transect segments including grid exit, turnaround and internal camera points
+    void                _clearLoadedMissionItems(void);
+    TransectsInput_t    _transectsInput         (void);
+    void                _setTransectsResult     (const TransectsResult_t& result);
+
+    static int                      _transectsJobCost       (const TransectsInput_t& input);
+    static bool                     _transectsJobCancelled  (const TransectsInput_t& input);
+    static QList<QGeoCoordinate>    _offsetPolyline         (const TransectsInput_t& input, double offset);
+    static TransectsResult_t        _buildTransects         (const TransectsInput_t& input);
+
+    QGCMapPolyline                      _corridorPolyline;
+    QList<QList<QGeoCoordinate>>        _transectSegments;      ///< Internal transect segments including grid exit, turnaround and internal camera points
+
+    int                                 _entryPoint;
 
-    int                             _entryPoint;
+    const QMap<QString, FactMetaData*>  _metaDataMap;
+    SettingsFact                        _corridorWidthFact;
 
-    QMap<QString, FactMetaData*>    _metaDataMap;
-    SettingsFact                    _corridorWidthFact;
+    QList<QPointF>                      _nedPolyline;               ///< _corridorPolyline in NED, empty: project it again
+    QList<double>                       _offsetPolylinesOffsets;    ///< Offsets _offsetPolylines were built for
+    QList<QList<QGeoCoordinate>>        _offsetPolylines;           ///< Transects before turnaround and entry point, kept until the polyline or the offsets change
+    QSharedPointer<QAtomicInt>          _transectsGeneration;
+    QFutureWatcher<TransectsResult_t>   _transectsWatcher;
+    bool                                _transectsJobPending =      false;
+    int                                 _backgroundRebuildMinCost = 20000;  ///< Offset polyline edges, smaller rebuilds run synchronously
 
     static const char* _jsonEntryPointKey;
 };
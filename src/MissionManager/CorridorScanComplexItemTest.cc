@@ -250,3 +250,38 @@ void CorridorScanComplexItemTest::_testItemGeneration(void)
     }
 }
 
+void CorridorScanComplexItemTest::_testBackgroundRebuild(void)
+{
+    int         expectedTransectCount   = _expectedTransectCount;
+    QVariantList originalTransectPoints = _corridorItem->visualTransectPoints();
+
+    // Entry point changes reuse the offset polylines, a full turn must end up where it started
+    for (int i=0; i<4; i++) {
+        _corridorItem->rotateEntryPoint();
+    }
+    QCOMPARE(_corridorItem->visualTransectPoints(), originalTransectPoints);
+
+    // Push every rebuild into the background
+    _corridorItem->_setBackgroundRebuildMinCost(0);
+
+    QSignalSpy visualTransectPointsSpy(_corridorItem, &TransectStyleComplexItem::visualTransectPointsChanged);
+
+    // The first job is stale as soon as the second one starts, only the second one publishes
+    _corridorItem->corridorWidth()->setRawValue(_corridorWidth * 0.75);
+    _corridorItem->corridorWidth()->setRawValue(_corridorWidth);
+    QCOMPARE(visualTransectPointsSpy.count(), 0);
+    QVERIFY(visualTransectPointsSpy.wait(5000));
+    QTest::qWait(100);
+    QCOMPARE(visualTransectPointsSpy.count(), 1);
+    QCOMPARE(_corridorItem->_transectCount(), expectedTransectCount);
+    QCOMPARE(_corridorItem->visualTransectPoints(), originalTransectPoints);
+
+    // Building mission items must wait for the pending job instead of using the old transects
+    visualTransectPointsSpy.clear();
+    _corridorItem->rotateEntryPoint();
+    QObject missionItemParent;
+    QList<MissionItem*> missionItems;
+    _corridorItem->appendMissionItems(missionItems, &missionItemParent);
+    QCOMPARE(visualTransectPointsSpy.count(), 1);
+    QCOMPARE(_corridorItem->_transectCount(), expectedTransectCount);
+}
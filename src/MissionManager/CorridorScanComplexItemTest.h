@@ -35,6 +35,7 @@ private slots:
     void _testPathChanges   (void);
     void _testItemGeneration(void);
     void _testItemCount     (void);
+    void _testBackgroundRebuild(void);
 #else
     // Used to debug a single test
 private slots:
@@ -44,6 +45,7 @@ private:
     void _testCameraTrigger (void);
     void _testPathChanges   (void);
     void _testItemCount     (void);
+    void _testBackgroundRebuild(void);
 #endif
 
 private:
@@ -31,7 +31,7 @@ const char* FixedWingLandingComplexItem::_jsonValueSetIsDistanceKey         = "v
 
 FixedWingLandingComplexItem::FixedWingLandingComplexItem(PlanMasterController* masterController, bool flyView, QObject* parent)
     : LandingComplexItem        (masterController, flyView, parent)
-    , _metaDataMap              (FactMetaData::createMapFromJsonFile(QStringLiteral(":/json/FWLandingPattern.FactMetaData.json"), this))
+    , _metaDataMap              (FactMetaData::sharedMapFromJsonFile(QStringLiteral(":/json/FWLandingPattern.FactMetaData.json")))
     , _landingDistanceFact      (settingsGroup, _metaDataMap[finalApproachToLandDistanceName])
     , _finalApproachAltitudeFact(settingsGroup, _metaDataMap[finalApproachAltitudeName])
     , _loiterRadiusFact         (settingsGroup, _metaDataMap[loiterRadiusName])
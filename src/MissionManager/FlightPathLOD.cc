@@ -0,0 +1,118 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FlightPathLOD.h"
+#include "FlightPathSegment.h"
+#include "QmlObjectListModel.h"
+#include "QGCGeo.h"
+
+#include <QtMath>
+
+QGC_LOGGING_CATEGORY(FlightPathLODLog, "FlightPathLODLog")
+
+FlightPathLOD::FlightPathLOD(QmlObjectListModel* segments, QObject* parent)
+    : QObject   (parent)
+    , _segments (segments)
+{
+    _rebuildTimer.setSingleShot(true);
+    _rebuildTimer.setInterval(0);
+
+    connect(&_rebuildTimer, &QTimer::timeout,                   this, &FlightPathLOD::_rebuild);
+    connect(_segments,      &QmlObjectListModel::countChanged,  this, &FlightPathLOD::rebuild);
+}
+
+void FlightPathLOD::rebuild(void)
+{
+    _rebuildTimer.start();
+}
+
+void FlightPathLOD::setZoomLevel(double zoomLevel)
+{
+    if (!qFuzzyCompare(zoomLevel, _zoomLevel)) {
+        bool lodChanged = qFloor(zoomLevel) != qFloor(_zoomLevel);
+        _zoomLevel = zoomLevel;
+        emit zoomLevelChanged(_zoomLevel);
+        if (lodChanged) {
+            emit pathsChanged();
+        }
+    }
+}
+
+double FlightPathLOD::toleranceMeters(int zoomLevel, double latitude)
+{
+    // Ground resolution of a 256 pixel web mercator tile
+    double metersPerPixel = 156543.03392 * cos(qDegreesToRadians(latitude)) / pow(2.0, zoomLevel);
+    return metersPerPixel * _tolerancePixels;
+}
+
+QVariantList FlightPathLOD::paths(void)
+{
+    int zoomLevel = qBound(0, qFloor(_zoomLevel), static_cast<int>(_maxZoomLevel));
+
+    if (!_pathsByZoomLevel.contains(zoomLevel)) {
+        QVariantList paths;
+        int pointCount = 0;
+
+        for (const MergedPath_t& mergedPath: _mergedPaths) {
+            QList<QGeoCoordinate> path;
+            if (zoomLevel == _maxZoomLevel) {
+                path = mergedPath.path;
+            } else {
+                path = simplifyPath(mergedPath.path, toleranceMeters(zoomLevel, mergedPath.path.first().latitude()));
+            }
+            pointCount += path.count();
+
+            QVariantList varPath;
+            varPath.reserve(path.count());
+            for (const QGeoCoordinate& coord: path) {
+                varPath.append(QVariant::fromValue(coord));
+            }
+
+            QVariantMap map;
+            map[QStringLiteral("path")]             = varPath;
+            map[QStringLiteral("terrainCollision")] = mergedPath.terrainCollision;
+            paths.append(map);
+        }
+
+        qCDebug(FlightPathLODLog) << "paths zoomLevel:mergedPaths:points" << zoomLevel << paths.count() << pointCount;
+        _pathsByZoomLevel[zoomLevel] = paths;
+    }
+
+    return _pathsByZoomLevel[zoomLevel];
+}
+
+void FlightPathLOD::_rebuild(void)
+{
+    _mergedPaths.clear();
+    _pathsByZoomLevel.clear();
+
+    for (int i=0; i<_segments->count(); i++) {
+        FlightPathSegment* segment = _segments->value<FlightPathSegment*>(i);
+        if (!segment || !segment->coordinate1().isValid() || !segment->coordinate2().isValid()) {
+            continue;
+        }
+
+        if (!_mergedPaths.isEmpty()) {
+            MergedPath_t& lastPath = _mergedPaths.last();
+            if (lastPath.terrainCollision == segment->terrainCollision() && lastPath.path.last() == segment->coordinate1()) {
+                lastPath.path.append(segment->coordinate2());
+                continue;
+            }
+        }
+
+        MergedPath_t mergedPath;
+        mergedPath.path.append(segment->coordinate1());
+        mergedPath.path.append(segment->coordinate2());
+        mergedPath.terrainCollision = segment->terrainCollision();
+        _mergedPaths.append(mergedPath);
+    }
+
+    qCDebug(FlightPathLODLog) << "_rebuild segments:mergedPaths" << _segments->count() << _mergedPaths.count();
+    emit pathsChanged();
+}
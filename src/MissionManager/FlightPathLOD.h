@@ -0,0 +1,71 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QGeoCoordinate>
+#include <QVariantList>
+#include <QHash>
+#include <QTimer>
+
+#include "QGCLoggingCategory.h"
+
+Q_DECLARE_LOGGING_CATEGORY(FlightPathLODLog)
+
+class QmlObjectListModel;
+
+/// Level of detail version of a list of FlightPathSegments for display on the map.
+///
+/// Consecutive segments which join up and share the same terrain collision state are merged into a single polyline,
+/// which is then simplified for the current zoom level. Large missions end up as a handful of MapPolyline delegates
+/// instead of one per segment. The simplified paths for each integer zoom level are kept until the segments change.
+class FlightPathLOD : public QObject
+{
+    Q_OBJECT
+
+public:
+    FlightPathLOD(QmlObjectListModel* segments, QObject* parent = nullptr);
+
+    Q_PROPERTY(double       zoomLevel   READ zoomLevel  WRITE setZoomLevel  NOTIFY zoomLevelChanged)
+    Q_PROPERTY(QVariantList paths       READ paths                          NOTIFY pathsChanged)        ///< Each entry is a map with path and terrainCollision values
+
+    double          zoomLevel   (void) const { return _zoomLevel; }
+    QVariantList    paths       (void);
+
+    void setZoomLevel(double zoomLevel);
+
+    /// Rebuilds the merged paths from the segments, multiple calls are coalesced into a single rebuild
+    void rebuild(void);
+
+    /// @return Allowed distance in meters between the simplified and the full path at the zoom level
+    static double toleranceMeters(int zoomLevel, double latitude);
+
+signals:
+    void zoomLevelChanged   (double zoomLevel);
+    void pathsChanged       (void);
+
+private slots:
+    void _rebuild(void);
+
+private:
+    typedef struct {
+        QList<QGeoCoordinate>   path;
+        bool                    terrainCollision;
+    } MergedPath_t;
+
+    QmlObjectListModel*         _segments;
+    QList<MergedPath_t>         _mergedPaths;
+    QHash<int, QVariantList>    _pathsByZoomLevel;
+    double                      _zoomLevel = 0;
+    QTimer                      _rebuildTimer;
+
+    static constexpr double _tolerancePixels = 1.0;
+    static const int        _maxZoomLevel = 22;     ///< Beyond this no simplification is done
+};
@@ -48,7 +48,7 @@ GeoFenceController::GeoFenceController(PlanMasterController* masterController, Q
     , _breachReturnDefaultAltitude  (qgcApp()->toolbox()->settingsManager()->appSettings()->defaultMissionItemAltitude()->rawValue().toDouble())
 {
     if (_metaDataMap.isEmpty()) {
-        _metaDataMap = FactMetaData::createMapFromJsonFile(QStringLiteral(":/json/BreachReturn.FactMetaData.json"), nullptr /* metaDataParent */);
+        _metaDataMap = FactMetaData::sharedMapFromJsonFile(QStringLiteral(":/json/BreachReturn.FactMetaData.json"));
     }
 
     _breachReturnAltitudeFact.setMetaData(_metaDataMap[_breachReturnAltitudeFactName]);
@@ -0,0 +1,223 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "KMLPlanDocument.h"
+#include "KMLStreamWriter.h"
+#include "QGCPalette.h"
+#include "QGCApplication.h"
+#include "MissionCommandTree.h"
+#include "MissionCommandUIInfo.h"
+#include "FactMetaData.h"
+#include "ComplexMissionItem.h"
+#include "QmlObjectListModel.h"
+#include "QGCQGeoCoordinate.h"
+#include "TrajectoryPoints.h"
+#include "Vehicle.h"
+
+#include <QFile>
+
+const char* KMLPlanDocument::surveyPolygonStyleName =  "SurveyPolygonStyle";
+const char* KMLPlanDocument::_missionLineStyleName =   "MissionLineStyle";
+const char* KMLPlanDocument::_trackStyleName =         "TrackStyle";
+
+KMLPlanDocument::KMLPlanDocument()
+    : _name(QStringLiteral("%1 Plan KML").arg(qgcApp()->applicationName()))
+{
+    // The palette is only usable from the main thread, so the colors are picked up here
+    QGCPalette palette;
+    _missionLineColor   = palette.mapMissionTrajectory();
+    _surveyPolygonColor = palette.surveyPolygonInterior();
+}
+
+void KMLPlanDocument::setCoordinatePrecision(int latLonDecimals, int altitudeDecimals)
+{
+    _latLonDecimals     = latLonDecimals;
+    _altitudeDecimals   = altitudeDecimals;
+}
+
+void KMLPlanDocument::_addFlightPath(Vehicle* vehicle, QList<MissionItem*> rgMissionItems)
+{
+    if (rgMissionItems.count() == 0) {
+        return;
+    }
+
+    // Build up the mission trajectory line coords
+    QGeoCoordinate homeCoord = rgMissionItems[0]->coordinate();
+    for (const MissionItem* item : rgMissionItems) {
+        const MissionCommandUIInfo* uiInfo = qgcApp()->toolbox()->missionCommandTree()->getUIInfo(vehicle, QGCMAVLink::VehicleClassGeneric, item->command());
+        if (uiInfo) {
+            double altAdjustment = item->frame() == MAV_FRAME_GLOBAL ? 0 : homeCoord.altitude(); // Used to convert to amsl
+            if (uiInfo->isTakeoffCommand() && !vehicle->fixedWing()) {
+                // These takeoff items go straight up from home position to specified altitude
+                QGeoCoordinate coord = homeCoord;
+                coord.setAltitude(item->param7() + altAdjustment);
+                _flightPath += coord;
+            }
+            if (uiInfo->specifiesCoordinate()) {
+                QGeoCoordinate coord = item->coordinate();
+                coord.setAltitude(coord.altitude() + altAdjustment); // convert to amsl
+
+                if (!uiInfo->isStandaloneCoordinate()) {
+                    // Flight path goes through this item
+                    _flightPath += coord;
+                }
+
+                // Add a place mark for each WP
+                Waypoint_t waypoint;
+                waypoint.name       = QStringLiteral("%1 %2").arg(QString::number(item->sequenceNumber())).arg(item->command() == MAV_CMD_NAV_WAYPOINT ? "" : uiInfo->friendlyName());
+                waypoint.coordinate = coord;
+                waypoint.description += QStringLiteral("Index: %1\n").arg(item->sequenceNumber());
+                waypoint.description += uiInfo->friendlyName() + "\n";
+                waypoint.description += QStringLiteral("Alt AMSL: %1 %2\n").arg(QString::number(FactMetaData::metersToAppSettingsHorizontalDistanceUnits(coord.altitude()).toDouble(), 'f', 2)).arg(FactMetaData::appSettingsHorizontalDistanceUnitsString());
+                waypoint.description += QStringLiteral("Alt Rel: %1 %2\n").arg(QString::number(FactMetaData::metersToAppSettingsHorizontalDistanceUnits(coord.altitude() - homeCoord.altitude()).toDouble(), 'f', 2)).arg(FactMetaData::appSettingsHorizontalDistanceUnitsString());
+                waypoint.description += QStringLiteral("Lat: %1\n").arg(QString::number(coord.latitude(), 'f', 7));
+                waypoint.description += QStringLiteral("Lon: %1\n").arg(QString::number(coord.longitude(), 'f', 7));
+                _waypoints.append(waypoint);
+            }
+        }
+    }
+}
+
+void KMLPlanDocument::addMission(Vehicle* vehicle, QmlObjectListModel* visualItems, QList<MissionItem*> rgMissionItems)
+{
+    _addFlightPath(vehicle, rgMissionItems);
+
+    for (int i=0; i<visualItems->count(); i++) {
+        ComplexMissionItem* complexItem = visualItems->value<ComplexMissionItem*>(i);
+        if (complexItem) {
+            complexItem->addKMLVisuals(*this);
+        }
+    }
+}
+
+void KMLPlanDocument::addSurveyPolygon(const QString& name, const QList<QGeoCoordinate>& vertices)
+{
+    if (!vertices.isEmpty()) {
+        _surveyPolygons.append({ name, vertices });
+    }
+}
+
+void KMLPlanDocument::addTrack(const QVector<double>& latitudes, const QVector<double>& longitudes, const QVector<double>& altitudes)
+{
+    _trackLatitudes     += latitudes;
+    _trackLongitudes    += longitudes;
+    _trackAltitudes     += altitudes;
+}
+
+void KMLPlanDocument::addCameraTriggers(const QList<QGeoCoordinate>& coords)
+{
+    _cameraTriggers += coords;
+}
+
+void KMLPlanDocument::addVehicleFlight(Vehicle* vehicle)
+{
+    TrajectoryPoints* trajectoryPoints = vehicle->trajectoryPoints();
+    if (trajectoryPoints) {
+        // The buffer keeps changing on the main thread so the finest level is copied out rather than shared
+        const TrajectoryBuffer& track = trajectoryPoints->level(0);
+        QVector<double> latitudes(track.count());
+        QVector<double> longitudes(track.count());
+        QVector<double> altitudes(track.count());
+        for (int i=0; i<track.count(); i++) {
+            QGeoCoordinate coord = track.coordinate(i);
+            latitudes[i]    = coord.latitude();
+            longitudes[i]   = coord.longitude();
+            altitudes[i]    = coord.altitude();
+        }
+        addTrack(latitudes, longitudes, altitudes);
+    }
+
+    QmlObjectListModel* cameraTriggerPoints = vehicle->cameraTriggerPoints();
+    QList<QGeoCoordinate> triggers;
+    triggers.reserve(cameraTriggerPoints->count());
+    for (int i=0; i<cameraTriggerPoints->count(); i++) {
+        triggers.append(cameraTriggerPoints->value<QGCQGeoCoordinate*>(i)->coordinate());
+    }
+    addCameraTriggers(triggers);
+}
+
+void KMLPlanDocument::_writeStyles(KMLStreamWriter& writer) const
+{
+    writer.addLineStyle(_missionLineStyleName, _missionLineColor, 4);
+    writer.addPolygonStyle(surveyPolygonStyleName, _surveyPolygonColor, 0.5 /* opacity */);
+    writer.addLineStyle(_trackStyleName, QColor(Qt::red), 3);
+}
+
+bool KMLPlanDocument::write(QIODevice* device) const
+{
+    KMLStreamWriter writer(device, _name, _latLonDecimals, _altitudeDecimals);
+
+    _writeStyles(writer);
+
+    if (!_waypoints.isEmpty() || !_flightPath.isEmpty()) {
+        writer.startFolder(QStringLiteral("Items"));
+        for (const Waypoint_t& waypoint: _waypoints) {
+            writer.startPlacemark(waypoint.name, true /* visible */, KMLStreamWriter::balloonStyleName);
+            writer.addCDATAElement(QStringLiteral("description"), waypoint.description);
+            writer.addPoint(waypoint.coordinate, QStringLiteral("absolute"));
+            writer.endElement();
+        }
+        writer.endElement();
+
+        writer.startPlacemark(QStringLiteral("Flight Path"), true /* visible */, _missionLineStyleName);
+        if (!_flightPath.isEmpty()) {
+            writer.addLookAt(_flightPath.first());
+        }
+        writer.addLineString(_flightPath, QStringLiteral("absolute"));
+        writer.endElement();
+    }
+
+    for (const Polygon_t& polygon: _surveyPolygons) {
+        writer.startPlacemark(polygon.name, true /* visible */, surveyPolygonStyleName);
+        writer.addPolygon(polygon.vertices, QStringLiteral("clampToGround"));
+        writer.endElement();
+    }
+
+    if (!_trackLatitudes.isEmpty()) {
+        writer.startPlacemark(QStringLiteral("Flight Track"), true /* visible */, _trackStyleName);
+        writer.startElement(QStringLiteral("LineString"));
+        writer.addTextElement(QStringLiteral("tessellate"),    QStringLiteral("1"));
+        writer.addTextElement(QStringLiteral("altitudeMode"),  QStringLiteral("absolute"));
+        writer.addCoordinates(_trackLatitudes.constData(), _trackLongitudes.constData(), _trackAltitudes.constData(), _trackLatitudes.count());
+        writer.endElement();
+        writer.endElement();
+    }
+
+    if (!_cameraTriggers.isEmpty()) {
+        writer.startFolder(QStringLiteral("Camera Triggers"));
+        for (int i=0; i<_cameraTriggers.count(); i++) {
+            writer.startPlacemark(QString::number(i + 1), true /* visible */);
+            writer.addPoint(_cameraTriggers[i], QStringLiteral("absolute"));
+            writer.endElement();
+        }
+        writer.endElement();
+    }
+
+    writer.finish();
+
+    return !writer.hasError();
+}
+
+bool KMLPlanDocument::save(const QString& fileName, QString& errorString) const
+{
+    QFile file(fileName);
+
+    errorString.clear();
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        errorString = file.errorString();
+        return false;
+    }
+    if (!write(&file)) {
+        errorString = file.errorString();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,85 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QColor>
+#include <QGeoCoordinate>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+class MissionItem;
+class Vehicle;
+class QIODevice;
+class QmlObjectListModel;
+class KMLStreamWriter;
+
+/// Used to convert a Plan, and optionally what a vehicle has flown, to a KML document. The document is filled in on
+/// the main thread and only keeps plain values, so it can then be written out from a worker thread.
+class KMLPlanDocument
+{
+public:
+    KMLPlanDocument();
+
+    void addMission         (Vehicle* vehicle, QmlObjectListModel* visualItems, QList<MissionItem*> rgMissionItems);
+    void addSurveyPolygon   (const QString& name, const QList<QGeoCoordinate>& vertices);
+
+    /// Adds the flown track of the vehicle along with its camera trigger positions
+    void addVehicleFlight   (Vehicle* vehicle);
+
+    /// Adds a flown track with one entry per point in each array, altitudes are AMSL
+    void addTrack           (const QVector<double>& latitudes, const QVector<double>& longitudes, const QVector<double>& altitudes);
+    void addCameraTriggers  (const QList<QGeoCoordinate>& coords);
+
+    /// Coordinate precision of the output, fewer decimals make a smaller file
+    ///     @param latLonDecimals   7 is about 1cm, 5 about 1m
+    void setCoordinatePrecision(int latLonDecimals, int altitudeDecimals);
+
+    /// Writes the document. Safe to call from any thread once the document is filled in.
+    /// @return false: write failed, errorString set
+    bool save(const QString& fileName, QString& errorString) const;
+    bool write(QIODevice* device) const;
+
+    int trackCount          (void) const { return _trackLatitudes.count(); }
+    int cameraTriggerCount  (void) const { return _cameraTriggers.count(); }
+
+    static const char* surveyPolygonStyleName;
+
+private:
+    typedef struct {
+        QString         name;
+        QString         description;
+        QGeoCoordinate  coordinate;
+    } Waypoint_t;
+
+    typedef struct {
+        QString                 name;
+        QList<QGeoCoordinate>   vertices;
+    } Polygon_t;
+
+    void _addFlightPath (Vehicle* vehicle, QList<MissionItem*> rgMissionItems);
+    void _writeStyles   (KMLStreamWriter& writer) const;
+
+    QString                 _name;
+    QColor                  _missionLineColor;
+    QColor                  _surveyPolygonColor;
+    QList<QGeoCoordinate>   _flightPath;
+    QList<Waypoint_t>       _waypoints;
+    QList<Polygon_t>        _surveyPolygons;
+    QVector<double>         _trackLatitudes;
+    QVector<double>         _trackLongitudes;
+    QVector<double>         _trackAltitudes;
+    QList<QGeoCoordinate>   _cameraTriggers;
+    int                     _latLonDecimals     = 7;
+    int                     _altitudeDecimals   = 2;
+
+    static const char* _missionLineStyleName;
+    static const char* _trackStyleName;
+};
@@ -0,0 +1,85 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "KMLPlanDocumentTest.h"
+#include "KMLPlanDocument.h"
+#include "KMLHelper.h"
+
+#include <QBuffer>
+#include <QDir>
+#include <QTemporaryFile>
+
+void KMLPlanDocumentTest::_roundTripTest(void)
+{
+    QGeoCoordinate          origin(47.6, -122.1, 100);
+    QList<QGeoCoordinate>   polygon;
+    polygon << origin << origin.atDistanceAndAzimuth(100, 90) << origin.atDistanceAndAzimuth(100, 180);
+
+    QVector<double> latitudes, longitudes, altitudes;
+    for (int i=0; i<10000; i++) {
+        QGeoCoordinate coord = origin.atDistanceAndAzimuth(i * 0.5, 45);
+        latitudes.append(coord.latitude());
+        longitudes.append(coord.longitude());
+        altitudes.append(100 + i * 0.01);
+    }
+
+    KMLPlanDocument planKML;
+    planKML.addSurveyPolygon(QStringLiteral("Survey Area"), polygon);
+    planKML.addTrack(latitudes, longitudes, altitudes);
+    planKML.addCameraTriggers(polygon);
+    QCOMPARE(planKML.trackCount(), latitudes.count());
+    QCOMPARE(planKML.cameraTriggerCount(), polygon.count());
+
+    QTemporaryFile file(QDir::tempPath() + QStringLiteral("/XXXXXX.kml"));
+    QVERIFY(file.open());
+    file.close();
+    QString errorString;
+    QVERIFY(planKML.save(file.fileName(), errorString));
+    QVERIFY(errorString.isEmpty());
+
+    // The polygon comes back without the vertex which closes the ring
+    QList<QGeoCoordinate> vertices;
+    QVERIFY(KMLHelper::loadPolygonFromFile(file.fileName(), vertices, errorString));
+    QCOMPARE(vertices.count(), polygon.count());
+
+    // With no mission the only line is the track
+    QList<QGeoCoordinate> track;
+    QVERIFY(KMLHelper::loadPolylineFromFile(file.fileName(), track, errorString));
+    QCOMPARE(track.count(), latitudes.count());
+    QVERIFY(qAbs(track.last().latitude() - latitudes.last()) < 1e-6);
+    QVERIFY(qAbs(track.last().longitude() - longitudes.last()) < 1e-6);
+}
+
+void KMLPlanDocumentTest::_precisionTest(void)
+{
+    QVector<double> latitudes, longitudes, altitudes;
+    for (int i=0; i<1000; i++) {
+        latitudes.append(47.6 + i * 1e-5);
+        longitudes.append(-122.1123456 + i * 1e-5);
+        altitudes.append(100.123);
+    }
+
+    QBuffer fullBuffer;
+    QVERIFY(fullBuffer.open(QIODevice::WriteOnly));
+    KMLPlanDocument fullKML;
+    fullKML.addTrack(latitudes, longitudes, altitudes);
+    QVERIFY(fullKML.write(&fullBuffer));
+
+    QBuffer reducedBuffer;
+    QVERIFY(reducedBuffer.open(QIODevice::WriteOnly));
+    KMLPlanDocument reducedKML;
+    reducedKML.setCoordinatePrecision(5, 0);
+    reducedKML.addTrack(latitudes, longitudes, altitudes);
+    QVERIFY(reducedKML.write(&reducedBuffer));
+
+    // Four fewer characters per point
+    QVERIFY(fullBuffer.data().size() - reducedBuffer.data().size() >= latitudes.count() * 4);
+    QVERIFY(reducedBuffer.data().contains("-122.11235,47.60000,100\n"));
+    QVERIFY(fullBuffer.data().contains("-122.1123456,47.6000000,100.12\n"));
+}
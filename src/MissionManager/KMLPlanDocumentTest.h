@@ -0,0 +1,24 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QGeoCoordinate>
+
+/// Writes KML plan documents and reads them back through KMLHelper
+class KMLPlanDocumentTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _roundTripTest(void);
+    void _precisionTest(void);
+};
@@ -35,22 +35,22 @@ void MissionCommandTree::setToolbox(QGCToolbox* toolbox)
 #ifdef UNITTEST_BUILD
     if (_unitTest) {
         // Load unit testing tree
-        _staticCommandTree[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassGeneric]      = new MissionCommandList(":/unittest/UT-MavCmdInfoCommon.json", true, this);
-        _staticCommandTree[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassFixedWing]    = new MissionCommandList(":/unittest/UT-MavCmdInfoFixedWing.json", false, this);
-        _staticCommandTree[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassMultiRotor]   = new MissionCommandList(":/unittest/UT-MavCmdInfoMultiRotor.json", false, this);
-        _staticCommandTree[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassVTOL]         = new MissionCommandList(":/unittest/UT-MavCmdInfoVTOL.json", false, this);
-        _staticCommandTree[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassSub]          = new MissionCommandList(":/unittest/UT-MavCmdInfoSub.json", false, this);
-        _staticCommandTree[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassRoverBoat]    = new MissionCommandList(":/unittest/UT-MavCmdInfoRover.json", false, this);
+        _staticCommandFiles[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassGeneric]     = QStringLiteral(":/unittest/UT-MavCmdInfoCommon.json");
+        _staticCommandFiles[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassFixedWing]   = QStringLiteral(":/unittest/UT-MavCmdInfoFixedWing.json");
+        _staticCommandFiles[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassMultiRotor]  = QStringLiteral(":/unittest/UT-MavCmdInfoMultiRotor.json");
+        _staticCommandFiles[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassVTOL]        = QStringLiteral(":/unittest/UT-MavCmdInfoVTOL.json");
+        _staticCommandFiles[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassSub]         = QStringLiteral(":/unittest/UT-MavCmdInfoSub.json");
+        _staticCommandFiles[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassRoverBoat]   = QStringLiteral(":/unittest/UT-MavCmdInfoRover.json");
     } else {
 #endif
-        // Load all levels of hierarchy
+        // Find all levels of hierarchy, the command lists themselves are only loaded when first needed
         for (const QGCMAVLink::FirmwareClass_t firmwareClass: _toolbox->firmwarePluginManager()->supportedFirmwareClasses()) {
             FirmwarePlugin* plugin = _toolbox->firmwarePluginManager()->firmwarePluginForAutopilot(QGCMAVLink::firmwareClassToAutopilot(firmwareClass), MAV_TYPE_QUADROTOR);
 
             for (const QGCMAVLink::VehicleClass_t vehicleClass: QGCMAVLink::allVehicleClasses()) {
                 QString overrideFile = plugin->missionCommandOverrides(vehicleClass);
                 if (!overrideFile.isEmpty()) {
-                    _staticCommandTree[firmwareClass][vehicleClass] = new MissionCommandList(overrideFile, firmwareClass == QGCMAVLink::FirmwareClassGeneric && vehicleClass == QGCMAVLink::VehicleClassGeneric /* baseCommandList */, this);
+                    _staticCommandFiles[firmwareClass][vehicleClass] = overrideFile;
                 }
             }
         }
@@ -59,6 +59,23 @@ void MissionCommandTree::setToolbox(QGCToolbox* toolbox)
 #endif
 }
 
+/// Loads the command list for a level of the hierarchy on first use
+///     @return nullptr: No overrides at this level
+MissionCommandList* MissionCommandTree::_commandList(QGCMAVLink::FirmwareClass_t firmwareClass, QGCMAVLink::VehicleClass_t vehicleClass)
+{
+    MissionCommandList* commandList = _staticCommandTree.value(firmwareClass).value(vehicleClass, nullptr);
+
+    if (!commandList) {
+        QString jsonFilename = _staticCommandFiles.value(firmwareClass).value(vehicleClass);
+        if (!jsonFilename.isEmpty()) {
+            commandList = new MissionCommandList(jsonFilename, firmwareClass == QGCMAVLink::FirmwareClassGeneric && vehicleClass == QGCMAVLink::VehicleClassGeneric /* baseCommandList */, this);
+            _staticCommandTree[firmwareClass][vehicleClass] = commandList;
+        }
+    }
+
+    return commandList;
+}
+
 /// Add the next level of the hierarchy to a collapsed tree.
 ///     @param cmdList          List of mission commands to collapse into ui info
 ///     @param collapsedTree    Tree we are collapsing into
@@ -96,20 +113,20 @@ void MissionCommandTree::_buildAllCommands(Vehicle* vehicle, QGCMAVLink::Vehicle
     QMap<MAV_CMD, MissionCommandUIInfo*>& collapsedTree = _allCommands[firmwareClass][vehicleClass];
 
     // Base of the tree is all commands
-    _collapseHierarchy(_staticCommandTree[MAV_AUTOPILOT_GENERIC][QGCMAVLink::VehicleClassGeneric], collapsedTree);
+    _collapseHierarchy(_commandList(QGCMAVLink::FirmwareClassGeneric, QGCMAVLink::VehicleClassGeneric), collapsedTree);
 
     // Add the overrides for specific vehicle types
     if (vehicleClass != QGCMAVLink::VehicleClassGeneric) {
-        _collapseHierarchy(_staticCommandTree[QGCMAVLink::FirmwareClassGeneric][vehicleClass], collapsedTree);
+        _collapseHierarchy(_commandList(QGCMAVLink::FirmwareClassGeneric, vehicleClass), collapsedTree);
     }
 
     // Add the overrides for specific firmware class, all vehicles
     if (firmwareClass != QGCMAVLink::FirmwareClassGeneric) {
-        _collapseHierarchy(_staticCommandTree[firmwareClass][QGCMAVLink::VehicleClassGeneric], collapsedTree);
+        _collapseHierarchy(_commandList(firmwareClass, QGCMAVLink::VehicleClassGeneric), collapsedTree);
 
         // Add overrides for specific vehicle class
         if (vehicleClass != QGCMAVLink::VehicleClassGeneric) {
-            _collapseHierarchy(_staticCommandTree[firmwareClass][vehicleClass], collapsedTree);
+            _collapseHierarchy(_commandList(firmwareClass, vehicleClass), collapsedTree);
         }
     }
 
@@ -139,7 +156,7 @@ QStringList MissionCommandTree::_availableCategoriesForVehicle(Vehicle* vehicle)
 
 QString MissionCommandTree::friendlyName(MAV_CMD command)
 {
-    MissionCommandList *    commandList =   _staticCommandTree[QGCMAVLink::FirmwareClassGeneric][QGCMAVLink::VehicleClassGeneric];
+    MissionCommandList *    commandList =   _commandList(QGCMAVLink::FirmwareClassGeneric, QGCMAVLink::VehicleClassGeneric);
     MissionCommandUIInfo*   uiInfo =        commandList->getUIInfo(command);
 
     if (uiInfo) {
@@ -151,7 +168,7 @@ QString MissionCommandTree::friendlyName(MAV_CMD command)
 
 QString MissionCommandTree::rawName(MAV_CMD command)
 {
-    MissionCommandList *    commandList =   _staticCommandTree[QGCMAVLink::FirmwareClassGeneric][QGCMAVLink::VehicleClassGeneric];
+    MissionCommandList *    commandList =   _commandList(QGCMAVLink::FirmwareClassGeneric, QGCMAVLink::VehicleClassGeneric);
     MissionCommandUIInfo*   uiInfo =        commandList->getUIInfo(command);
 
     if (uiInfo) {
@@ -163,7 +180,7 @@ QString MissionCommandTree::rawName(MAV_CMD command)
 
 bool MissionCommandTree::isLandCommand(MAV_CMD command)
 {
-    MissionCommandList *    commandList =   _staticCommandTree[QGCMAVLink::FirmwareClassGeneric][QGCMAVLink::VehicleClassGeneric];
+    MissionCommandList *    commandList =   _commandList(QGCMAVLink::FirmwareClassGeneric, QGCMAVLink::VehicleClassGeneric);
     MissionCommandUIInfo*   uiInfo =        commandList->getUIInfo(command);
 
     return uiInfo ? uiInfo->isLandCommand() : false;
@@ -171,15 +188,15 @@ bool MissionCommandTree::isLandCommand(MAV_CMD command)
 
 bool MissionCommandTree::isTakeoffCommand(MAV_CMD command)
 {
-    MissionCommandList *    commandList =   _staticCommandTree[QGCMAVLink::FirmwareClassGeneric][QGCMAVLink::VehicleClassGeneric];
+    MissionCommandList *    commandList =   _commandList(QGCMAVLink::FirmwareClassGeneric, QGCMAVLink::VehicleClassGeneric);
     MissionCommandUIInfo*   uiInfo =        commandList->getUIInfo(command);
 
     return uiInfo ? uiInfo->isTakeoffCommand() : false;
 }
 
-const QList<MAV_CMD>& MissionCommandTree::allCommandIds(void) const
+const QList<MAV_CMD>& MissionCommandTree::allCommandIds(void)
 {
-    return _staticCommandTree[QGCMAVLink::FirmwareClassGeneric][QGCMAVLink::VehicleClassGeneric]->commandIds();
+    return _commandList(QGCMAVLink::FirmwareClassGeneric, QGCMAVLink::VehicleClassGeneric)->commandIds();
 }
 
 const MissionCommandUIInfo* MissionCommandTree::getUIInfo(Vehicle* vehicle, QGCMAVLink::VehicleClass_t vtolMode,  MAV_CMD command)
@@ -39,6 +39,8 @@ class MissionCommandTreeTest;
 ///             Known Firmware, Sub
 /// For known firmwares, the override files are requested from the FirmwarePlugin.
 ///
+/// The command lists of the hierarchy are only loaded once they are first needed in _staticCommandTree.
+///
 /// When ui info is requested for a specific vehicle the static hierarchy in _staticCommandTree is collapsed into the set of available commands in
 /// _allCommands taking into account the appropriate set of overrides for the MAV_AUTOPILOT/MAV_TYPE combination associated with the vehicle.
 ///
@@ -58,7 +60,7 @@ public:
     bool isLandCommand(MAV_CMD command);
     bool isTakeoffCommand(MAV_CMD command);
 
-    const QList<MAV_CMD>& allCommandIds(void) const;
+    const QList<MAV_CMD>& allCommandIds(void);
 
     Q_INVOKABLE QStringList categoriesForVehicle(Vehicle* vehicle) { return _availableCategoriesForVehicle(vehicle); }
 
@@ -71,6 +73,7 @@ public:
     virtual void setToolbox(QGCToolbox* toolbox);
 
 private:
+    MissionCommandList*         _commandList                    (QGCMAVLink::FirmwareClass_t firmwareClass, QGCMAVLink::VehicleClass_t vehicleClass);
     void                        _collapseHierarchy              (const MissionCommandList* cmdList, QMap<MAV_CMD, MissionCommandUIInfo*>& collapsedTree);
     void                        _buildAllCommands               (Vehicle* vehicle, QGCMAVLink::VehicleClass_t vtolMode);
     QStringList                 _availableCategoriesForVehicle  (Vehicle* vehicle);
@@ -82,7 +85,10 @@ private:
     SettingsManager*    _settingsManager;
     bool                _unitTest;              ///< true: running in unit test mode
 
-    /// Full hierarchy
+    /// Json files of the full hierarchy
+    QMap<QGCMAVLink::FirmwareClass_t, QMap<QGCMAVLink::VehicleClass_t, QString>>                                _staticCommandFiles;
+
+    /// Full hierarchy, filled in by _commandList as levels are needed
     QMap<QGCMAVLink::FirmwareClass_t, QMap<QGCMAVLink::VehicleClass_t, MissionCommandList*>>                    _staticCommandTree;
 
     /// Collapsed hierarchy for specific vehicle type
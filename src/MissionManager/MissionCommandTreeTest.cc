@@ -142,7 +142,7 @@ void MissionCommandTreeTest::testJsonLoad(void)
     bool showUI;
 
     // Test loading from the bad command list
-    MissionCommandList* commandList = _commandTree->_staticCommandTree[MAV_AUTOPILOT_GENERIC][MAV_TYPE_GENERIC];
+    MissionCommandList* commandList = _commandTree->_commandList(QGCMAVLink::FirmwareClassGeneric, QGCMAVLink::VehicleClassGeneric);
     QVERIFY(commandList != nullptr);
 
     // Command 1 should have all values defaulted, no params
@@ -197,6 +197,24 @@ void MissionCommandTreeTest::testOverride(void)
     delete vehicle;
 }
 
+void MissionCommandTreeTest::testLazyLoad(void)
+{
+    // Nothing is loaded up front
+    QVERIFY(_commandTree->_staticCommandTree.isEmpty());
+
+    // Base command list only
+    QCOMPARE(_commandTree->rawName((MAV_CMD)1), _rawName(1));
+    QCOMPARE(_commandTree->_staticCommandTree.count(), 1);
+    QCOMPARE(_commandTree->_staticCommandTree[QGCMAVLink::FirmwareClassGeneric].count(), 1);
+
+    // Only the levels of the vehicle are added
+    Vehicle* vehicle = new Vehicle(MAV_AUTOPILOT_GENERIC, MAV_TYPE_FIXED_WING, qgcApp()->toolbox()->firmwarePluginManager());
+    QVERIFY(_commandTree->getUIInfo(vehicle, QGCMAVLink::VehicleClassGeneric, (MAV_CMD)4));
+    delete vehicle;
+    QCOMPARE(_commandTree->_staticCommandTree[QGCMAVLink::FirmwareClassGeneric].count(), 2);
+    QVERIFY(_commandTree->_staticCommandTree[QGCMAVLink::FirmwareClassGeneric].contains(QGCMAVLink::VehicleClassFixedWing));
+}
+
 void MissionCommandTreeTest::testAllTrees(void)
 {
     QList<MAV_AUTOPILOT>    firmwareList;
@@ -28,6 +28,7 @@ private slots:
     void testJsonLoad(void);
     void testOverride(void);
     void testAllTrees(void);
+    void testLazyLoad(void);
 
 private:
     QString _rawName(int id);
@@ -28,10 +28,13 @@
 #include "MissionSettingsItem.h"
 #include "QGCQGeoCoordinate.h"
 #include "PlanMasterController.h"
-#include "KMLPlanDomDocument.h"
 #include "QGCCorePlugin.h"
 #include "TakeoffMissionItem.h"
 #include "PlanViewSettings.h"
+#include "QGCTrace.h"
+
+#include <QPointer>
+#include <limits>
 
 #define UPDATE_TIMEOUT 5000 ///< How often we check for bounding box changes
 
@@ -67,9 +70,14 @@ MissionController::MissionController(PlanMasterController* masterController, QOb
 
     _updateTimer.setSingleShot(true);
 
+    _flightPathLOD          = new FlightPathLOD(&_simpleFlightPathSegments, this);
+    _viewportVisualItems    = new VisualItemsViewportModel(this);
+
     connect(&_updateTimer,                                  &QTimer::timeout,                           this, &MissionController::_updateTimeout);
     connect(_planViewSettings->takeoffItemNotRequired(),    &Fact::rawValueChanged,                     this, &MissionController::_takeoffItemNotRequiredChanged);
     connect(this,                                           &MissionController::missionDistanceChanged, this, &MissionController::recalcTerrainProfile);
+    connect(this,                                           &MissionController::recalcTerrainProfile,   _flightPathLOD, &FlightPathLOD::rebuild);
+    connect(this,                                           &MissionController::currentPlanViewSeqNumChanged, _viewportVisualItems, &VisualItemsViewportModel::refilter);
 
     // The follow is used to compress multiple recalc calls in a row to into a single call.
     connect(this, &MissionController::_recalcMissionFlightStatusSignal, this, &MissionController::_recalcMissionFlightStatus,   Qt::QueuedConnection);
@@ -276,7 +284,7 @@ bool MissionController::_convertToMissionItems(QmlObjectListModel* visualMission
     return endActionSet;
 }
 
-void MissionController::addMissionToKML(KMLPlanDomDocument& planKML)
+void MissionController::addMissionToKML(KMLPlanDocument& planKML)
 {
     QObject*            deleteParent = new QObject();
     QList<MissionItem*> rgMissionItems;
@@ -650,15 +658,17 @@ bool MissionController::_loadJsonMissionFileV1(const QJsonObject& json, QmlObjec
 
     MissionSettingsItem* settingsItem = _addMissionSettings(visualItems);
     if (json.contains(_jsonPlannedHomePositionKey)) {
-        SimpleMissionItem* item = new SimpleMissionItem(_masterController, _flyView, true /* forLoad */, visualItems);
-        if (item->load(json[_jsonPlannedHomePositionKey].toObject(), 0, errorString)) {
-            settingsItem->setInitialHomePositionFromUser(item->coordinate());
-            item->deleteLater();
+        MissionItem homeItem;
+        if (homeItem.load(json[_jsonPlannedHomePositionKey].toObject(), 0, errorString)) {
+            settingsItem->setInitialHomePositionFromUser(homeItem.coordinate());
         } else {
             return false;
         }
     }
 
+    // Items are collected and added to the model in a single insert once they are all loaded
+    QObjectList loadedItems;
+
     qCDebug(MissionControllerLog) << "Json load: simple item loop start simpleItemCount:ComplexItemCount" << itemArray.count() << surveyItems.count();
     do {
         qCDebug(MissionControllerLog) << "Json load: simple item loop nextSimpleItemIndex:nextComplexItemIndex:nextSequenceNumber" << nextSimpleItemIndex << nextComplexItemIndex << nextSequenceNumber;
@@ -669,7 +679,7 @@ bool MissionController::_loadJsonMissionFileV1(const QJsonObject& json, QmlObjec
 
             if (complexItem->sequenceNumber() == nextSequenceNumber) {
                 qCDebug(MissionControllerLog) << "Json load: injecting complex item expectedSequence:actualSequence:" << nextSequenceNumber << complexItem->sequenceNumber();
-                visualItems->append(complexItem);
+                loadedItems.append(complexItem);
                 nextSequenceNumber = complexItem->lastSequenceNumber() + 1;
                 nextComplexItemIndex++;
                 continue;
@@ -686,24 +696,19 @@ bool MissionController::_loadJsonMissionFileV1(const QJsonObject& json, QmlObjec
             }
 
             const QJsonObject itemObject = itemValue.toObject();
-            SimpleMissionItem* item = new SimpleMissionItem(_masterController, _flyView, true /* forLoad */, visualItems);
+            SimpleMissionItem* item = _createLoadSimpleItem(static_cast<MAV_CMD>(itemObject[MissionItem::_jsonCommandKey].toInt()), settingsItem, visualItems);
             if (item->load(itemObject, itemObject["id"].toInt(), errorString)) {
-                if (TakeoffMissionItem::isTakeoffCommand(item->mavCommand())) {
-                    // This needs to be a TakeoffMissionItem
-                    TakeoffMissionItem* takeoffItem = new TakeoffMissionItem(_masterController, _flyView, settingsItem, true /* forLoad */, visualItems);
-                    takeoffItem->load(itemObject, itemObject["id"].toInt(), errorString);
-                    item->deleteLater();
-                    item = takeoffItem;
-                }
                 qCDebug(MissionControllerLog) << "Json load: adding simple item expectedSequence:actualSequence" << nextSequenceNumber << item->sequenceNumber();
                 nextSequenceNumber = item->lastSequenceNumber() + 1;
-                visualItems->append(item);
+                loadedItems.append(item);
             } else {
                 return false;
             }
         }
     } while (nextSimpleItemIndex < itemArray.count() || nextComplexItemIndex < surveyItems.count());
 
+    visualItems->append(loadedItems);
+
     return true;
 }
 
@@ -768,8 +773,9 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
     visualItems->insert(0, settingsItem);
     qCDebug(MissionControllerLog) << "plannedHomePosition" << homeCoordinate;
 
-    // Read mission items
+    // Read mission items. They are collected and added to the model in a single insert once they are all loaded.
 
+    QObjectList loadedItems;
     int nextSequenceNumber = 1; // Start with 1 since home is in 0
     const QJsonArray rgMissionItems(json[_jsonItemsKey].toArray());
     for (int i=0; i<rgMissionItems.count(); i++) {
@@ -792,18 +798,11 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
         QString itemType = itemObject[VisualMissionItem::jsonTypeKey].toString();
 
         if (itemType == VisualMissionItem::jsonTypeSimpleItemValue) {
-            SimpleMissionItem* simpleItem = new SimpleMissionItem(_masterController, _flyView, true /* forLoad */, visualItems);
+            SimpleMissionItem* simpleItem = _createLoadSimpleItem(static_cast<MAV_CMD>(itemObject[MissionItem::_jsonCommandKey].toInt()), settingsItem, visualItems);
             if (simpleItem->load(itemObject, nextSequenceNumber, errorString)) {
-                if (TakeoffMissionItem::isTakeoffCommand(static_cast<MAV_CMD>(simpleItem->command()))) {
-                    // This needs to be a TakeoffMissionItem
-                    TakeoffMissionItem* takeoffItem = new TakeoffMissionItem(_masterController, _flyView, settingsItem, true /* forLoad */, this);
-                    takeoffItem->load(itemObject, nextSequenceNumber, errorString);
-                    simpleItem->deleteLater();
-                    simpleItem = takeoffItem;
-                }
                 qCDebug(MissionControllerLog) << "Loading simple item: nextSequenceNumber:command" << nextSequenceNumber << simpleItem->command();
                 nextSequenceNumber = simpleItem->lastSequenceNumber() + 1;
-                visualItems->append(simpleItem);
+                loadedItems.append(simpleItem);
             } else {
                 return false;
             }
@@ -824,7 +823,7 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
                 }
                 nextSequenceNumber = surveyItem->lastSequenceNumber() + 1;
                 qCDebug(MissionControllerLog) << "Survey load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(surveyItem);
+                loadedItems.append(surveyItem);
             } else if (complexItemType == FixedWingLandingComplexItem::jsonComplexItemTypeValue) {
                 qCDebug(MissionControllerLog) << "Loading Fixed Wing Landing Pattern: nextSequenceNumber" << nextSequenceNumber;
                 FixedWingLandingComplexItem* landingItem = new FixedWingLandingComplexItem(_masterController, _flyView, visualItems);
@@ -833,7 +832,7 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
                 }
                 nextSequenceNumber = landingItem->lastSequenceNumber() + 1;
                 qCDebug(MissionControllerLog) << "FW Landing Pattern load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(landingItem);
+                loadedItems.append(landingItem);
             } else if (complexItemType == VTOLLandingComplexItem::jsonComplexItemTypeValue) {
                 qCDebug(MissionControllerLog) << "Loading VTOL Landing Pattern: nextSequenceNumber" << nextSequenceNumber;
                 VTOLLandingComplexItem* landingItem = new VTOLLandingComplexItem(_masterController, _flyView, visualItems);
@@ -842,7 +841,7 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
                 }
                 nextSequenceNumber = landingItem->lastSequenceNumber() + 1;
                 qCDebug(MissionControllerLog) << "VTOL Landing Pattern load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(landingItem);
+                loadedItems.append(landingItem);
             } else if (complexItemType == StructureScanComplexItem::jsonComplexItemTypeValue) {
                 qCDebug(MissionControllerLog) << "Loading Structure Scan: nextSequenceNumber" << nextSequenceNumber;
                 StructureScanComplexItem* structureItem = new StructureScanComplexItem(_masterController, _flyView, QString() /* kmlFile */, visualItems);
@@ -851,7 +850,7 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
                 }
                 nextSequenceNumber = structureItem->lastSequenceNumber() + 1;
                 qCDebug(MissionControllerLog) << "Structure Scan load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(structureItem);
+                loadedItems.append(structureItem);
             } else if (complexItemType == CorridorScanComplexItem::jsonComplexItemTypeValue) {
                 qCDebug(MissionControllerLog) << "Loading Corridor Scan: nextSequenceNumber" << nextSequenceNumber;
                 CorridorScanComplexItem* corridorItem = new CorridorScanComplexItem(_masterController, _flyView, QString() /* kmlFile */, visualItems);
@@ -860,7 +859,7 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
                 }
                 nextSequenceNumber = corridorItem->lastSequenceNumber() + 1;
                 qCDebug(MissionControllerLog) << "Corridor Scan load complete: nextSequenceNumber" << nextSequenceNumber;
-                visualItems->append(corridorItem);
+                loadedItems.append(corridorItem);
             } else {
                 errorString = tr("Unsupported complex item type: %1").arg(complexItemType);
             }
@@ -870,29 +869,31 @@ bool MissionController::_loadJsonMissionFileV2(const QJsonObject& json, QmlObjec
         }
     }
 
-    // Fix up the DO_JUMP commands jump sequence number by finding the item with the matching doJumpId
+    visualItems->append(loadedItems);
+
+    // Fix up the DO_JUMP commands jump sequence number by finding the item with the matching doJumpId.
+    // The first item with a given doJumpId wins, same as a front to back search would.
+    QHash<int, int>             doJumpIdToSequenceNumber;
+    QList<SimpleMissionItem*>   doJumpItems;
     for (int i=0; i<visualItems->count(); i++) {
         if (visualItems->value<VisualMissionItem*>(i)->isSimpleItem()) {
-            SimpleMissionItem* doJumpItem = visualItems->value<SimpleMissionItem*>(i);
-            if (doJumpItem->command() == MAV_CMD_DO_JUMP) {
-                bool found = false;
-                int findDoJumpId = static_cast<int>(doJumpItem->missionItem().param1());
-                for (int j=0; j<visualItems->count(); j++) {
-                    if (visualItems->value<VisualMissionItem*>(j)->isSimpleItem()) {
-                        SimpleMissionItem* targetItem = visualItems->value<SimpleMissionItem*>(j);
-                        if (targetItem->missionItem().doJumpId() == findDoJumpId) {
-                            doJumpItem->missionItem().setParam1(targetItem->sequenceNumber());
-                            found = true;
-                            break;
-                        }
-                    }
-                }
-                if (!found) {
-                    errorString = tr("Could not find doJumpId: %1").arg(findDoJumpId);
-                    return false;
-                }
+            SimpleMissionItem* simpleItem = visualItems->value<SimpleMissionItem*>(i);
+            int doJumpId = simpleItem->missionItem().doJumpId();
+            if (!doJumpIdToSequenceNumber.contains(doJumpId)) {
+                doJumpIdToSequenceNumber[doJumpId] = simpleItem->sequenceNumber();
             }
+            if (simpleItem->command() == MAV_CMD_DO_JUMP) {
+                doJumpItems.append(simpleItem);
+            }
+        }
+    }
+    for (SimpleMissionItem* doJumpItem: doJumpItems) {
+        int findDoJumpId = static_cast<int>(doJumpItem->missionItem().param1());
+        if (!doJumpIdToSequenceNumber.contains(findDoJumpId)) {
+            errorString = tr("Could not find doJumpId: %1").arg(findDoJumpId);
+            return false;
         }
+        doJumpItem->missionItem().setParam1(doJumpIdToSequenceNumber[findDoJumpId]);
     }
 
     return true;
@@ -944,27 +945,34 @@ bool MissionController::_loadTextMissionFile(QTextStream& stream, QmlObjectListM
     if (versionOk) {
         MissionSettingsItem* settingsItem = _addMissionSettings(visualItems);
 
+        // Items are collected and added to the model in a single insert once they are all loaded
+        QObjectList loadedItems;
+
         while (!stream.atEnd()) {
-            SimpleMissionItem* item = new SimpleMissionItem(_masterController, _flyView, true /* forLoad */, visualItems);
-            if (item->load(stream)) {
-                if (firstItem && plannedHomePositionInFile) {
-                    settingsItem->setInitialHomePositionFromUser(item->coordinate());
-                } else {
-                    if (TakeoffMissionItem::isTakeoffCommand(static_cast<MAV_CMD>(item->command()))) {
-                        // This needs to be a TakeoffMissionItem
-                        TakeoffMissionItem* takeoffItem = new TakeoffMissionItem(_masterController, _flyView, settingsItem, true /* forLoad */, visualItems);
-                        takeoffItem->load(stream);
-                        item->deleteLater();
-                        item = takeoffItem;
-                    }
-                    visualItems->append(item);
+            // Each line is a single item. The command is looked at first so the right item type is created up front.
+            QString     line = stream.readLine();
+            QTextStream lineStream(&line, QIODevice::ReadOnly);
+            bool        success;
+
+            if (firstItem && plannedHomePositionInFile) {
+                MissionItem homeItem;
+                if ((success = homeItem.load(lineStream))) {
+                    settingsItem->setInitialHomePositionFromUser(homeItem.coordinate());
                 }
-                firstItem = false;
             } else {
+                SimpleMissionItem* item = _createLoadSimpleItem(static_cast<MAV_CMD>(line.section('\t', 3, 3).toInt()), settingsItem, visualItems);
+                if ((success = item->load(lineStream))) {
+                    loadedItems.append(item);
+                }
+            }
+            if (!success) {
                 errorString = tr("The mission file is corrupted.");
                 return false;
             }
+            firstItem = false;
         }
+
+        visualItems->append(loadedItems);
     } else {
         errorString = tr("The mission file is not compatible with this version of %1.").arg(qgcApp()->applicationName());
         return false;
@@ -983,6 +991,14 @@ bool MissionController::_loadTextMissionFile(QTextStream& stream, QmlObjectListM
     return true;
 }
 
+SimpleMissionItem* MissionController::_createLoadSimpleItem(MAV_CMD command, MissionSettingsItem* settingsItem, QObject* parent)
+{
+    if (TakeoffMissionItem::isTakeoffCommand(command)) {
+        return new TakeoffMissionItem(_masterController, _flyView, settingsItem, true /* forLoad */, parent);
+    }
+    return new SimpleMissionItem(_masterController, _flyView, true /* forLoad */, parent);
+}
+
 void MissionController::_initLoadedVisualItems(QmlObjectListModel* loadedVisualItems)
 {
     if (_visualItems) {
@@ -1083,6 +1099,19 @@ int MissionController::readyForSaveState(void) const
 }
 
 void MissionController::save(QJsonObject& json)
+{
+    saveHeader(json);
+
+    QList<QJsonArray> rgVisualItemsJson;
+    for (int i=0; i<_visualItems->count(); i++) {
+        QJsonArray visualItemJson;
+        qobject_cast<VisualMissionItem*>(_visualItems->get(i))->save(visualItemJson);
+        rgVisualItemsJson.append(visualItemJson);
+    }
+    saveVisualItemsJson(json, rgVisualItemsJson);
+}
+
+void MissionController::saveHeader(QJsonObject& json)
 {
     json[JsonHelper::jsonVersionKey] = _missionFileVersion;
 
@@ -1101,31 +1130,16 @@ void MissionController::save(QJsonObject& json)
     json[_jsonCruiseSpeedKey]               = _controllerVehicle->defaultCruiseSpeed();
     json[_jsonHoverSpeedKey]                = _controllerVehicle->defaultHoverSpeed();
     json[_jsonGlobalPlanAltitudeModeKey]    = _globalAltMode;
+}
 
-    // Save the visual items
-
+void MissionController::saveVisualItemsJson(QJsonObject& json, const QList<QJsonArray>& rgVisualItemsJson)
+{
     QJsonArray rgJsonMissionItems;
-    for (int i=0; i<_visualItems->count(); i++) {
-        VisualMissionItem* visualItem = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
-
-        visualItem->save(rgJsonMissionItems);
-    }
-
-    // Mission settings has a special case for end mission action
-    if (settingsItem) {
-        QList<MissionItem*> rgMissionItems;
-
-        if (_convertToMissionItems(_visualItems, rgMissionItems, this /* missionItemParent */)) {
-            QJsonObject saveObject;
-            MissionItem* missionItem = rgMissionItems[rgMissionItems.count() - 1];
-            missionItem->save(saveObject);
-            rgJsonMissionItems.append(saveObject);
-        }
-        for (int i=0; i<rgMissionItems.count(); i++) {
-            rgMissionItems[i]->deleteLater();
+    for (const QJsonArray& visualItemJson: rgVisualItemsJson) {
+        for (const QJsonValue& itemJson: visualItemJson) {
+            rgJsonMissionItems.append(itemJson);
         }
     }
-
     json[_jsonItemsKey] = rgJsonMissionItems;
 }
 
@@ -1174,18 +1188,22 @@ FlightPathSegment* MissionController::_createFlightPathSegmentWorker(VisualItemP
     connect(pair.second, &VisualMissionItem::coordinateChanged,     segment,    &FlightPathSegment::setCoordinate2);
     connect(pair.second, &VisualMissionItem::amslEntryAltChanged,   segment,    &FlightPathSegment::setCoord2AMSLAlt);
 
-    connect(pair.second, &VisualMissionItem::coordinateChanged,         this,       &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+    connect(pair.second, &VisualMissionItem::coordinateChanged,         this,       &MissionController::_itemFlightStatusChanged,         Qt::UniqueConnection);
+
+    // Altitude changes at either end only affect the flight status from the start of the segment onward
+    QPointer<VisualMissionItem> segmentStartItem = pair.first;
+    auto recalcFromSegmentStart = [this, segmentStartItem]() { _recalcMissionFlightStatusFrom(segmentStartItem ? _visualItems->indexOf(segmentStartItem) : 0); };
 
     connect(segment,    &FlightPathSegment::totalDistanceChanged,       this,       &MissionController::recalcTerrainProfile,             Qt::QueuedConnection);
-    connect(segment,    &FlightPathSegment::coord1AMSLAltChanged,       this,       &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(segment,    &FlightPathSegment::coord2AMSLAltChanged,       this,       &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+    connect(segment,    &FlightPathSegment::coord1AMSLAltChanged,       this,       recalcFromSegmentStart);
+    connect(segment,    &FlightPathSegment::coord2AMSLAltChanged,       this,       recalcFromSegmentStart);
     connect(segment,    &FlightPathSegment::amslTerrainHeightsChanged,  this,       &MissionController::recalcTerrainProfile,             Qt::QueuedConnection);
     connect(segment,    &FlightPathSegment::terrainCollisionChanged,    this,       &MissionController::recalcTerrainProfile,             Qt::QueuedConnection);
 
     return segment;
 }
 
-FlightPathSegment* MissionController::_addFlightPathSegment(FlightPathSegmentHashTable& prevItemPairHashTable, VisualItemPair& pair)
+FlightPathSegment* MissionController::_addFlightPathSegment(FlightPathSegmentHashTable& prevItemPairHashTable, VisualItemPair& pair, QObjectList& segments)
 {
     FlightPathSegment* segment = nullptr;
 
@@ -1197,11 +1215,36 @@ FlightPathSegment* MissionController::_addFlightPathSegment(FlightPathSegmentHas
         _flightPathSegmentHashTable[pair] = segment;
     }
 
-    _simpleFlightPathSegments.append(segment);
+    segments.append(segment);
 
     return segment;
 }
 
+/// Makes the model match the new list by only removing and inserting the range which differs between them. For a change
+/// to a single item this is just the segments on either side of it.
+void MissionController::_updateSegmentModel(QmlObjectListModel& model, const QObjectList& newList)
+{
+    const QObjectList& oldList = *model.objectList();
+    int oldCount = oldList.count();
+    int newCount = newList.count();
+
+    int prefixCount = 0;
+    while (prefixCount < oldCount && prefixCount < newCount && oldList[prefixCount] == newList[prefixCount]) {
+        prefixCount++;
+    }
+    int suffixCount = 0;
+    while (suffixCount < oldCount - prefixCount && suffixCount < newCount - prefixCount && oldList[oldCount - 1 - suffixCount] == newList[newCount - 1 - suffixCount]) {
+        suffixCount++;
+    }
+
+    for (int i=oldCount - suffixCount - 1; i>=prefixCount; i--) {
+        model.removeAt(i);
+    }
+    for (int i=prefixCount; i<newCount - suffixCount; i++) {
+        model.insert(i, newList[i]);
+    }
+}
+
 void MissionController::_recalcROISpecialVisuals(void)
 {
     return;
@@ -1237,6 +1280,8 @@ void MissionController::_recalcROISpecialVisuals(void)
 
 void MissionController::_recalcFlightPathSegments(void)
 {
+    QGC_TRACE_SCOPE_ARG("MissionController", "recalcFlightPathSegments", "items", _visualItems->count());
+
     VisualItemPair      lastSegmentVisualItemPair;
     int                 segmentCount =              0;
     bool                firstCoordinateNotFound =   true;
@@ -1260,12 +1305,12 @@ void MissionController::_recalcFlightPathSegments(void)
     // This is due to the initial implementation being buggy and incomplete with respect to correctly generating the line set.
     // So for now we leave the code for displaying them in, but none are ever added until we have time to implement the correct support.
 
-    _simpleFlightPathSegments.beginReset();
-    _directionArrows.beginReset();
-    _incompleteComplexItemLines.beginReset();
+    // The segment and arrow lists are built up separately and then applied as an edit to the models. That way the visuals
+    // for segments which did not change are left alone instead of the whole model being reset.
+    QObjectList simpleFlightPathSegments;
+    QObjectList directionArrows;
 
-    _simpleFlightPathSegments.clear();
-    _directionArrows.clear();
+    _incompleteComplexItemLines.beginReset();
     _incompleteComplexItemLines.clearAndDeleteContents();
 
     // Mission Settings item needs to start with no segment
@@ -1348,10 +1393,10 @@ void MissionController::_recalcFlightPathSegments(void)
 
                     lastSegmentVisualItemPair =  VisualItemPair(lastFlyThroughVI, visualItem);
                     if (!_flyView || addDirectionArrow) {
-                        FlightPathSegment* segment = _addFlightPathSegment(oldSegmentTable, lastSegmentVisualItemPair);
+                        FlightPathSegment* segment = _addFlightPathSegment(oldSegmentTable, lastSegmentVisualItemPair, simpleFlightPathSegments);
                         segment->setSpecialVisual(roiActive);
                         if (addDirectionArrow) {
-                            _directionArrows.append(segment);
+                            directionArrows.append(segment);
                         }
                         lastFlyThroughVI->setSimpleFlighPathSegment(segment);
                     }
@@ -1372,7 +1417,7 @@ void MissionController::_recalcFlightPathSegments(void)
         if (_flyView) {
             _waypointPath.append(QVariant::fromValue(_settingsItem->coordinate()));
         }
-        FlightPathSegment* segment = _addFlightPathSegment(oldSegmentTable, lastSegmentVisualItemPair);
+        FlightPathSegment* segment = _addFlightPathSegment(oldSegmentTable, lastSegmentVisualItemPair, simpleFlightPathSegments);
         segment->setSpecialVisual(roiActive);
         lastFlyThroughVI->setSimpleFlighPathSegment(segment);
     }
@@ -1401,17 +1446,18 @@ void MissionController::_recalcFlightPathSegments(void)
             _flightPathSegmentHashTable[lastSegmentVisualItemPair] = coordVector;
         }
 
-        _directionArrows.append(coordVector);
+        directionArrows.append(coordVector);
     }
 
-    _simpleFlightPathSegments.endReset();
-    _directionArrows.endReset();
+    _updateSegmentModel(_simpleFlightPathSegments, simpleFlightPathSegments);
+    _updateSegmentModel(_directionArrows, directionArrows);
     _incompleteComplexItemLines.endReset();
 
     // Anything left in the old table is an obsolete line object that can go
     qDeleteAll(oldSegmentTable);
 
-    emit _recalcMissionFlightStatusSignal();
+    // The set of flight path segments changed, which means items were added, removed or changed how they link together
+    _recalcMissionFlightStatusFrom(0);
 
     if (_waypointPath.count() == 0) {
         // MapPolyLine has a bug where if you change from a path which has elements to an empty path the line drawn
@@ -1485,42 +1531,83 @@ void MissionController::_addTimeDistance(bool vtolInHover, double hoverTime, dou
     }
 }
 
+/// Queues a flight status recalc which starts at the specified visual item. Items before it keep their current values.
+void MissionController::_recalcMissionFlightStatusFrom(int visualItemIndex)
+{
+    _flightStatusDirtyIndex = qMin(_flightStatusDirtyIndex, qMax(visualItemIndex, 0));
+    emit _recalcMissionFlightStatusSignal();
+}
+
+void MissionController::_itemFlightStatusChanged(void)
+{
+    VisualMissionItem* visualItem = qobject_cast<VisualMissionItem*>(sender());
+    _recalcMissionFlightStatusFrom(visualItem ? _visualItems->indexOf(visualItem) : 0);
+}
+
 void MissionController::_recalcMissionFlightStatus()
 {
+    QGC_TRACE_SCOPE_ARG("MissionController", "recalcMissionFlightStatus", "items", _visualItems->count());
+
     if (!_visualItems->count()) {
         return;
     }
 
+    // Resume from the first changed item if we have the state from the previous pass for it
+    int startIndex = _flightStatusDirtyIndex;
+    _flightStatusDirtyIndex = std::numeric_limits<int>::max();
+    if (startIndex >= _visualItems->count() || _flightStatusCheckpoints.count() != _visualItems->count()) {
+        startIndex = 0;
+    }
+    _flightStatusCheckpoints.resize(_visualItems->count());
+
     bool                firstCoordinateItem =           true;
     VisualMissionItem*  lastFlyThroughVI =   qobject_cast<VisualMissionItem*>(_visualItems->get(0));
 
     bool homePositionValid = _settingsItem->coordinate().isValid();
 
-    qCDebug(MissionControllerLog) << "_recalcMissionFlightStatus";
+    qCDebug(MissionControllerLog) << "_recalcMissionFlightStatus startIndex" << startIndex;
 
-    // If home position is valid we can calculate distances between all waypoints.
-    // If home position is not valid we can only calculate distances between waypoints which are
-    // both relative altitude.
-
-    // No values for first item
-    lastFlyThroughVI->setAltDifference(0);
-    lastFlyThroughVI->setAzimuth(0);
-    lastFlyThroughVI->setDistance(0);
-    lastFlyThroughVI->setDistanceFromStart(0);
-
-    _minAMSLAltitude = _maxAMSLAltitude = qQNaN();
-
-    _resetMissionFlightStatus();
+    double prevMinAMSLAltitude = _minAMSLAltitude;
+    double prevMaxAMSLAltitude = _maxAMSLAltitude;
 
     bool   linkStartToHome =            false;
     bool   foundRTL =                   false;
     double totalHorizontalDistance =    0;
 
-    for (int i=0; i<_visualItems->count(); i++) {
+    if (startIndex == 0) {
+        // If home position is valid we can calculate distances between all waypoints.
+        // If home position is not valid we can only calculate distances between waypoints which are
+        // both relative altitude.
+
+        // No values for first item
+        lastFlyThroughVI->setAltDifference(0);
+        lastFlyThroughVI->setAzimuth(0);
+        lastFlyThroughVI->setDistance(0);
+        lastFlyThroughVI->setDistanceFromStart(0);
+
+        _minAMSLAltitude = _maxAMSLAltitude = qQNaN();
+
+        _resetMissionFlightStatus();
+    } else {
+        const FlightStatusCheckpoint_t& checkpoint = _flightStatusCheckpoints[startIndex];
+
+        _missionFlightStatus    = checkpoint.missionFlightStatus;
+        lastFlyThroughVI        = checkpoint.lastFlyThroughVI;
+        firstCoordinateItem     = checkpoint.firstCoordinateItem;
+        linkStartToHome         = checkpoint.linkStartToHome;
+        foundRTL                = checkpoint.foundRTL;
+        totalHorizontalDistance = checkpoint.totalHorizontalDistance;
+        _minAMSLAltitude        = checkpoint.minAMSLAltitude;
+        _maxAMSLAltitude        = checkpoint.maxAMSLAltitude;
+    }
+
+    for (int i=startIndex; i<_visualItems->count(); i++) {
         VisualMissionItem*  item =          qobject_cast<VisualMissionItem*>(_visualItems->get(i));
         SimpleMissionItem*  simpleItem =    qobject_cast<SimpleMissionItem*>(item);
         ComplexMissionItem* complexItem =   qobject_cast<ComplexMissionItem*>(item);
 
+        _flightStatusCheckpoints[i] = { _missionFlightStatus, lastFlyThroughVI, firstCoordinateItem, linkStartToHome, foundRTL, totalHorizontalDistance, _minAMSLAltitude, _maxAMSLAltitude };
+
         if (simpleItem && simpleItem->mavCommand() == MAV_CMD_NAV_RETURN_TO_LAUNCH) {
             foundRTL = true;
         }
@@ -1729,9 +1816,11 @@ void MissionController::_recalcMissionFlightStatus()
     emit minAMSLAltitudeChanged         (_minAMSLAltitude);
     emit maxAMSLAltitudeChanged         (_maxAMSLAltitude);
 
-    // Walk the list again calculating altitude percentages
+    // Walk the list again calculating altitude percentages. Items before the start index only need it if the range changed.
+    auto sameAltitude = [](double alt1, double alt2) { return alt1 == alt2 || (qIsNaN(alt1) && qIsNaN(alt2)); };
+    int altPercentStartIndex = sameAltitude(prevMinAMSLAltitude, _minAMSLAltitude) && sameAltitude(prevMaxAMSLAltitude, _maxAMSLAltitude) ? startIndex : 0;
     double altRange = _maxAMSLAltitude - _minAMSLAltitude;
-    for (int i=0; i<_visualItems->count(); i++) {
+    for (int i=altPercentStartIndex; i<_visualItems->count(); i++) {
         VisualMissionItem* item = qobject_cast<VisualMissionItem*>(_visualItems->get(i));
 
         if (item->specifiesCoordinate()) {
@@ -1840,6 +1929,8 @@ void MissionController::_setPlannedHomePositionFromFirstCoordinate(const QGeoCoo
 
 void MissionController::_recalcAllWithCoordinate(const QGeoCoordinate& coordinate)
 {
+    QGC_TRACE_SCOPE("MissionController", "recalcAll");
+
     if (!_flyView) {
         _setPlannedHomePositionFromFirstCoordinate(coordinate);
     }
@@ -1886,6 +1977,8 @@ void MissionController::_initAllVisualItems(void)
     connect(_visualItems, &QmlObjectListModel::dirtyChanged, this, &MissionController::_visualItemsDirtyChanged);
     connect(_visualItems, &QmlObjectListModel::countChanged, this, &MissionController::_updateContainsItems);
 
+    _viewportVisualItems->setVisualItems(_visualItems);
+
     emit visualItemsChanged();
     emit containsItemsChanged(containsItems());
     emit plannedHomePositionChanged(plannedHomePosition());
@@ -1914,14 +2007,17 @@ void MissionController::_initVisualItem(VisualMissionItem* visualItem)
 {
     setDirty(false);
 
+    // Item indices are changing so previous flight status checkpoints can't be used
+    _flightStatusCheckpoints.clear();
+
     connect(visualItem, &VisualMissionItem::specifiesCoordinateChanged,                 this, &MissionController::_recalcFlightPathSegmentsSignal,  Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedFlightSpeedChanged,                this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedGimbalYawChanged,                  this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedGimbalPitchChanged,                this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::specifiedVehicleYawChanged,                 this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::terrainAltitudeChanged,                     this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::additionalTimeDelayChanged,                 this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(visualItem, &VisualMissionItem::currentVTOLModeChanged,                     this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+    connect(visualItem, &VisualMissionItem::specifiedFlightSpeedChanged,                this, &MissionController::_itemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::specifiedGimbalYawChanged,                  this, &MissionController::_itemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::specifiedGimbalPitchChanged,                this, &MissionController::_itemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::specifiedVehicleYawChanged,                 this, &MissionController::_itemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::terrainAltitudeChanged,                     this, &MissionController::_itemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::additionalTimeDelayChanged,                 this, &MissionController::_itemFlightStatusChanged);
+    connect(visualItem, &VisualMissionItem::currentVTOLModeChanged,                     this, &MissionController::_itemFlightStatusChanged);
     connect(visualItem, &VisualMissionItem::lastSequenceNumberChanged,                  this, &MissionController::_recalcSequence);
 
     if (visualItem->isSimpleItem()) {
@@ -1935,10 +2031,10 @@ void MissionController::_initVisualItem(VisualMissionItem* visualItem)
     } else {
         ComplexMissionItem* complexItem = qobject_cast<ComplexMissionItem*>(visualItem);
         if (complexItem) {
-            connect(complexItem, &ComplexMissionItem::complexDistanceChanged,       this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-            connect(complexItem, &ComplexMissionItem::greatestDistanceToChanged,    this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-            connect(complexItem, &ComplexMissionItem::minAMSLAltitudeChanged,       this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-            connect(complexItem, &ComplexMissionItem::maxAMSLAltitudeChanged,       this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+            connect(complexItem, &ComplexMissionItem::complexDistanceChanged,       this, &MissionController::_itemFlightStatusChanged);
+            connect(complexItem, &ComplexMissionItem::greatestDistanceToChanged,    this, &MissionController::_itemFlightStatusChanged);
+            connect(complexItem, &ComplexMissionItem::minAMSLAltitudeChanged,       this, &MissionController::_itemFlightStatusChanged);
+            connect(complexItem, &ComplexMissionItem::maxAMSLAltitudeChanged,       this, &MissionController::_itemFlightStatusChanged);
             connect(complexItem, &ComplexMissionItem::isIncompleteChanged,          this, &MissionController::_recalcFlightPathSegmentsSignal,  Qt::QueuedConnection);
         } else {
             qWarning() << "ComplexMissionItem not found";
@@ -1950,6 +2046,9 @@ void MissionController::_deinitVisualItem(VisualMissionItem* visualItem)
 {
     // Disconnect all signals
     disconnect(visualItem, nullptr, nullptr, nullptr);
+
+    // Item indices are changing so previous flight status checkpoints can't be used
+    _flightStatusCheckpoints.clear();
 }
 
 void MissionController::_itemCommandChanged(void)
@@ -1983,8 +2082,8 @@ void MissionController::_managerVehicleChanged(Vehicle* managerVehicle)
     connect(_missionManager, &MissionManager::lastCurrentIndexChanged,  this, &MissionController::resumeMissionIndexChanged);
     connect(_missionManager, &MissionManager::resumeMissionReady,       this, &MissionController::resumeMissionReady);
     connect(_missionManager, &MissionManager::resumeMissionUploadFail,  this, &MissionController::resumeMissionUploadFail);
-    connect(_managerVehicle, &Vehicle::defaultCruiseSpeedChanged,       this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
-    connect(_managerVehicle, &Vehicle::defaultHoverSpeedChanged,        this, &MissionController::_recalcMissionFlightStatusSignal, Qt::QueuedConnection);
+    connect(_managerVehicle, &Vehicle::defaultCruiseSpeedChanged,       this, [this]() { _recalcMissionFlightStatusFrom(0); });
+    connect(_managerVehicle, &Vehicle::defaultHoverSpeedChanged,        this, [this]() { _recalcMissionFlightStatusFrom(0); });
     connect(_managerVehicle, &Vehicle::vehicleTypeChanged,              this, &MissionController::complexMissionItemNamesChanged);
 
     emit complexMissionItemNamesChanged();
@@ -13,11 +13,15 @@
 #include "QmlObjectListModel.h"
 #include "Vehicle.h"
 #include "QGCLoggingCategory.h"
-#include "KMLPlanDomDocument.h"
+#include "KMLPlanDocument.h"
 #include "QGCGeoBoundingCube.h"
 #include "QGroundControlQmlGlobal.h"
+#include "FlightPathLOD.h"
+#include "VisualItemsViewportModel.h"
 
 #include <QHash>
+#include <QJsonArray>
+#include <QVector>
 
 class FlightPathSegment;
 class VisualMissionItem;
@@ -74,6 +78,8 @@ public:
     Q_PROPERTY(QmlObjectListModel*  simpleFlightPathSegments        READ simpleFlightPathSegments       CONSTANT)                               ///< Used by Plan view only for interactive editing
     Q_PROPERTY(QVariantList         waypointPath                    READ waypointPath                   NOTIFY waypointPathChanged)             ///< Used by Fly view only for static display
     Q_PROPERTY(QmlObjectListModel*  directionArrows                 READ directionArrows                CONSTANT)
+    Q_PROPERTY(FlightPathLOD*               flightPathLOD       READ flightPathLOD                  CONSTANT)                               ///< Merged and simplified simpleFlightPathSegments for display in the Plan view
+    Q_PROPERTY(VisualItemsViewportModel*    viewportVisualItems READ viewportVisualItems            CONSTANT)                               ///< visualItems near the Plan view map viewport
     Q_PROPERTY(QmlObjectListModel*  incompleteComplexItemLines      READ incompleteComplexItemLines     CONSTANT)                               ///< Segments which are not yet completed.
     Q_PROPERTY(QStringList          complexMissionItemNames         READ complexMissionItemNames        NOTIFY complexMissionItemNamesChanged)
     Q_PROPERTY(QGeoCoordinate       plannedHomePosition             READ plannedHomePosition            NOTIFY plannedHomePositionChanged)      ///< Includes AMSL altitude
@@ -198,6 +204,11 @@ public:
     QGCGeoBoundingCube* travelBoundingCube  () { return &_travelBoundingCube; }
     QGeoCoordinate      takeoffCoordinate   () { return _takeoffCoordinate; }
 
+    /// save in two parts: saveHeader writes everything except the items, saveVisualItemsJson adds the items from the
+    /// json each visual item saved. Lets PlanUndoStack keep the json of unchanged items between snapshots.
+    void        saveHeader          (QJsonObject& json);
+    static void saveVisualItemsJson (QJsonObject& json, const QList<QJsonArray>& rgVisualItemsJson);
+
     // Overrides from PlanElementController
     bool supported                  (void) const final { return true; }
     void start                      (bool flyView) final;
@@ -214,13 +225,15 @@ public:
     bool showPlanFromManagerVehicle (void) final;
 
     // Create KML file
-    void addMissionToKML(KMLPlanDomDocument& planKML);
+    void addMissionToKML(KMLPlanDocument& planKML);
 
     // Property accessors
 
     QmlObjectListModel* visualItems                 (void) { return _visualItems; }
     QmlObjectListModel* simpleFlightPathSegments    (void) { return &_simpleFlightPathSegments; }
     QmlObjectListModel* directionArrows             (void) { return &_directionArrows; }
+    FlightPathLOD*              flightPathLOD       (void) { return _flightPathLOD; }
+    VisualItemsViewportModel*   viewportVisualItems (void) { return _viewportVisualItems; }
     QmlObjectListModel* incompleteComplexItemLines  (void) { return &_incompleteComplexItemLines; }
     QVariantList        waypointPath                (void) { return _waypointPath; }
     QStringList         complexMissionItemNames     (void) const;
@@ -316,6 +329,7 @@ private slots:
     void _recalcAll                             (void);
     void _managerVehicleChanged                 (Vehicle* managerVehicle);
     void _takeoffItemNotRequiredChanged         (void);
+    void _itemFlightStatusChanged               (void);
 
 private:
     void                    _init                               (void);
@@ -336,6 +350,7 @@ private:
     bool                    _loadJsonMissionFileV1              (const QJsonObject& json, QmlObjectListModel* visualItems, QString& errorString);
     bool                    _loadJsonMissionFileV2              (const QJsonObject& json, QmlObjectListModel* visualItems, QString& errorString);
     bool                    _loadTextMissionFile                (QTextStream& stream, QmlObjectListModel* visualItems, QString& errorString);
+    SimpleMissionItem*      _createLoadSimpleItem               (MAV_CMD command, MissionSettingsItem* settingsItem, QObject* parent);
     int                     _nextSequenceNumber                 (void);
     void                    _scanForAdditionalSettings          (QmlObjectListModel* visualItems, PlanMasterController* masterController);
     void                    _setPlannedHomePositionFromFirstCoordinate(const QGeoCoordinate& clickCoordinate);
@@ -345,7 +360,8 @@ private:
     void                    _updateBatteryInfo                  (int waypointIndex);
     bool                    _loadItemsFromJson                  (const QJsonObject& json, QmlObjectListModel* visualItems, QString& errorString);
     void                    _initLoadedVisualItems              (QmlObjectListModel* loadedVisualItems);
-    FlightPathSegment*      _addFlightPathSegment               (FlightPathSegmentHashTable& prevItemPairHashTable, VisualItemPair& pair);
+    FlightPathSegment*      _addFlightPathSegment               (FlightPathSegmentHashTable& prevItemPairHashTable, VisualItemPair& pair, QObjectList& segments);
+    void                    _recalcMissionFlightStatusFrom      (int visualItemIndex);
     void                    _addTimeDistance                    (bool vtolInHover, double hoverTime, double cruiseTime, double extraTime, double distance, int seqNum);
     VisualMissionItem*      _insertSimpleMissionItemWorker      (QGeoCoordinate coordinate, MAV_CMD command, int visualItemIndex, bool makeCurrentItem);
     void                    _insertComplexMissionItemWorker     (const QGeoCoordinate& mapCenterCoordinate, ComplexMissionItem* complexItem, int visualItemIndex, bool makeCurrentItem);
@@ -356,11 +372,24 @@ private:
     void                    _firstItemAdded                     (void);
 
     static double           _calcDistanceToHome                 (VisualMissionItem* currentItem, VisualMissionItem* homeItem);
+    static void             _updateSegmentModel                 (QmlObjectListModel& model, const QObjectList& newList);
     static double           _normalizeLat                       (double lat);
     static double           _normalizeLon                       (double lon);
     static bool             _convertToMissionItems              (QmlObjectListModel* visualMissionItems, QList<MissionItem*>& rgMissionItems, QObject* missionItemParent);
 
 private:
+    /// State of the _recalcMissionFlightStatus walk at the start of a visual item
+    typedef struct {
+        MissionFlightStatus_t   missionFlightStatus;
+        VisualMissionItem*      lastFlyThroughVI;
+        bool                    firstCoordinateItem;
+        bool                    linkStartToHome;
+        bool                    foundRTL;
+        double                  totalHorizontalDistance;
+        double                  minAMSLAltitude;
+        double                  maxAMSLAltitude;
+    } FlightStatusCheckpoint_t;
+
     Vehicle*                    _controllerVehicle =            nullptr;
     Vehicle*                    _managerVehicle =               nullptr;
     MissionManager*             _missionManager =               nullptr;
@@ -372,6 +401,8 @@ private:
     QVariantList                _waypointPath;
     QmlObjectListModel          _directionArrows;
     QmlObjectListModel          _incompleteComplexItemLines;
+    FlightPathLOD*              _flightPathLOD =                nullptr;
+    VisualItemsViewportModel*   _viewportVisualItems =          nullptr;
     FlightPathSegmentHashTable  _flightPathSegmentHashTable;
     bool                        _firstItemsFromVehicle =        false;
     bool                        _itemsRequested =               false;
@@ -397,6 +428,8 @@ private:
     double                      _minAMSLAltitude =              0;
     double                      _maxAMSLAltitude =              0;
     bool                        _missionContainsVTOLTakeoff =   false;
+    QVector<FlightStatusCheckpoint_t> _flightStatusCheckpoints;                                     ///< Indexed by visual item, cleared when the item list changes
+    int                         _flightStatusDirtyIndex =       0;                                  ///< First visual item the next flight status recalc starts from
 
     QGroundControlQmlGlobal::AltitudeMode _globalAltMode = QGroundControlQmlGlobal::AltitudeModeRelative;
 
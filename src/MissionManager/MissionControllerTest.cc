@@ -232,10 +232,56 @@ void MissionControllerTest::_testVehicleYawRecalc(void)
     }
 }
 
+void MissionControllerTest::_testIncrementalRecalc(void)
+{
+    _initForFirmwareType(MAV_AUTOPILOT_PX4);
+
+    const int cMissionItems = 5;
+    QGeoCoordinate currentCoord(0, 0);
+    _missionController->insertSimpleMissionItem(currentCoord, 1);
+    for (int i=2; i<=cMissionItems; i++) {
+        currentCoord = currentCoord.atDistanceAndAzimuth(1000, 90);
+        _missionController->insertSimpleMissionItem(currentCoord, i);
+    }
+
+    QTest::qWait(100); // Recalcs in MissionController are queued to remove dups. Allow return to main message loop.
+
+    QmlObjectListModel* segments = _missionController->simpleFlightPathSegments();
+    QList<QObject*> rgSegments;
+    for (int i=0; i<segments->count(); i++) {
+        rgSegments.append(segments->get(i));
+    }
+
+    // Moving a single item in the middle must update the values from that item onward
+    VisualMissionItem* movedItem = _missionController->visualItems()->value<VisualMissionItem*>(3);
+    movedItem->setCoordinate(movedItem->coordinate().atDistanceAndAzimuth(500, 0));
+
+    QTest::qWait(100);
+
+    double expectedDistanceFromStart = 0;
+    for (int i=2; i<=cMissionItems; i++) {
+        VisualMissionItem* prevItem     = _missionController->visualItems()->value<VisualMissionItem*>(i - 1);
+        VisualMissionItem* visualItem   = _missionController->visualItems()->value<VisualMissionItem*>(i);
+        double expectedDistance = prevItem->coordinate().distanceTo(visualItem->coordinate());
+        expectedDistanceFromStart += expectedDistance;
+        QCOMPARE(visualItem->distance(), expectedDistance);
+        QCOMPARE(visualItem->distanceFromStart(), expectedDistanceFromStart);
+    }
+    QCOMPARE(_missionController->missionDistance(), expectedDistanceFromStart);
+
+    // The item pairs did not change so the same segment objects must still be in use
+    QCOMPARE(segments->count(), rgSegments.count());
+    for (int i=0; i<segments->count(); i++) {
+        QCOMPARE(segments->get(i), rgSegments[i]);
+    }
+}
+
 void MissionControllerTest::_testLoadJsonSectionAvailable(void)
 {
     _initForFirmwareType(MAV_AUTOPILOT_PX4);
+    QSignalSpy loadCompleteSpy(_masterController, &PlanMasterController::loadFromFileComplete);
     _masterController->loadFromFile(":/unittest/SectionTest.plan");
+    QVERIFY(loadCompleteSpy.wait());
 
     QmlObjectListModel* visualItems = _missionController->visualItems();
     QVERIFY(visualItems);
@@ -38,6 +38,7 @@ private slots:
     void _testGlobalAltMode             (void);
     void _testGimbalRecalc              (void);
     void _testVehicleYawRecalc          (void);
+    void _testIncrementalRecalc         (void);
 
 private:
 #if 0
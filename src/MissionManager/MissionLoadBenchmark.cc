@@ -0,0 +1,104 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MissionLoadBenchmark.h"
+#include "BenchmarkResults.h"
+#include "PlanMasterController.h"
+#include "MissionController.h"
+
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+MissionLoadBenchmark::MissionLoadBenchmark(void)
+{
+
+}
+
+void MissionLoadBenchmark::init(void)
+{
+    UnitTest::init();
+
+    _masterController = new PlanMasterController(this);
+    _masterController->setFlyView(false);
+    _masterController->start();
+}
+
+void MissionLoadBenchmark::cleanup(void)
+{
+    delete _masterController;
+    _masterController = nullptr;
+
+    UnitTest::cleanup();
+}
+
+void MissionLoadBenchmark::_missionLoadBenchmark_data(void)
+{
+    QTest::addColumn<QString>("filename");
+    QTest::addColumn<int>("visualItemCount");
+
+    // Visual item count is the mission settings item plus every waypoint line after the home position
+    QTest::newRow("100Waypoints") << QStringLiteral(":/unittest/100Waypoints.waypoints") << 100;
+    QTest::newRow("800Waypoints") << QStringLiteral(":/unittest/800Waypoints.waypoints") << 829;
+}
+
+void MissionLoadBenchmark::_missionLoadBenchmark(void)
+{
+    QFETCH(QString, filename);
+    QFETCH(int,     visualItemCount);
+
+    int iterations = BenchmarkResults::iterations();
+
+    qint64 textNSecs = 0;
+    _timeLoad(filename, iterations, visualItemCount, textNSecs);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QString planFilename = tempDir.filePath(QStringLiteral("MissionLoadBenchmark.plan"));
+    _masterController->saveToFile(planFilename);
+    QTRY_VERIFY(!_masterController->planFileInProgress());
+
+    qint64 jsonNSecs = 0;
+    _timeLoad(planFilename, iterations, visualItemCount, jsonNSecs);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    for (const auto& result: { qMakePair(QStringLiteral("text"), textNSecs), qMakePair(QStringLiteral("json"), jsonNSecs) }) {
+        double msecsPerLoad = result.second / 1.0e6 / iterations;
+        BenchmarkResults::record(this, result.first + QStringLiteral("MsecsPerLoad"), msecsPerLoad,                                                      QStringLiteral("ms"));
+        BenchmarkResults::record(this, result.first + QStringLiteral("ItemsPerSec"),  msecsPerLoad > 0 ? visualItemCount / (msecsPerLoad / 1000.0) : 0,  QStringLiteral("items/s"));
+    }
+}
+
+/// Loads the file the specified number of times, including the queued flight path and flight status recalcs
+/// @param[out] elapsedNSecs Total time spent loading
+void MissionLoadBenchmark::_timeLoad(const QString& filename, int iterations, int expectedVisualItemCount, qint64& elapsedNSecs)
+{
+    QElapsedTimer   timer;
+    QSignalSpy      loadCompleteSpy(_masterController, &PlanMasterController::loadFromFileComplete);
+
+    elapsedNSecs = 0;
+    for (int i=0; i<iterations; i++) {
+        timer.start();
+        // Plan files complete on the worker thread, the others right away
+        loadCompleteSpy.clear();
+        _masterController->loadFromFile(filename);
+        if (loadCompleteSpy.isEmpty()) {
+            QVERIFY(loadCompleteSpy.wait());
+        }
+        QCoreApplication::processEvents();
+        elapsedNSecs += timer.nsecsElapsed();
+
+        QCOMPARE(_masterController->missionController()->visualItems()->count(), expectedVisualItemCount);
+    }
+}
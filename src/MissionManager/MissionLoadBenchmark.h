@@ -0,0 +1,46 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class PlanMasterController;
+
+/// Benchmark for loading large missions into the Plan view: file parse -> visual items -> flight path recalc.
+///
+/// Loads the 100 and 800 waypoint Mission Planner files, then saves each one as a .plan file and loads that back so
+/// both the text and json loaders are covered with the same mission. Reports the average time per load and the number
+/// of visual items per second.
+///
+/// Registered standalone so it only runs when asked for by name:
+///     QGroundControl --unittest:MissionLoadBenchmark
+///
+/// Configured through the environment:
+///     QGC_BENCH_ITERATIONS    Number of loads for each file, default 5
+class MissionLoadBenchmark : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MissionLoadBenchmark(void);
+
+protected:
+    void init   (void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _missionLoadBenchmark_data (void);
+    void _missionLoadBenchmark      (void);
+
+private:
+    void _timeLoad(const QString& filename, int iterations, int expectedVisualItemCount, qint64& elapsedNSecs);
+
+    PlanMasterController* _masterController = nullptr;
+};
@@ -11,6 +11,12 @@
 #include "MissionManagerTest.h"
 #include "LinkManager.h"
 #include "MultiVehicleManager.h"
+#include "GeoFenceManager.h"
+#include "Vehicle.h"
+
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtEndian>
 
 const MissionManagerTest::TestCase_t MissionManagerTest::_rgTestCases[] = {
     { "0\t0\t3\t16\t10\t20\t30\t40\t-10\t-20\t-30\t1\r\n",  { 0, QGeoCoordinate(-10.0, -20.0, -30.0), MAV_CMD_NAV_WAYPOINT,     10.0, 20.0, 30.0, 40.0, true, false, MAV_FRAME_GLOBAL_RELATIVE_ALT } },
@@ -22,6 +28,8 @@ const MissionManagerTest::TestCase_t MissionManagerTest::_rgTestCases[] = {
 };
 const size_t MissionManagerTest::_cTestCases = sizeof(_rgTestCases)/sizeof(_rgTestCases[0]);
 
+const char* MissionManagerTest::_ftpMissionFile = "@MISSION/mission.dat";
+
 MissionManagerTest::MissionManagerTest(void)
 {
     
@@ -360,3 +368,263 @@ void MissionManagerTest::_testErrorAckFailureStrings(void)
     }
 
 }
+
+static QList<MissionItem*> _fenceItems(void)
+{
+    QList<MissionItem*> items;
+
+    for (int i=0; i<4; i++) {
+        items.append(new MissionItem(i, MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION, MAV_FRAME_GLOBAL, 4, 0, 0, 0, 47.39 + (i / 2) * 0.001, 8.54 + (i % 2) * 0.001, 0, true, false));
+    }
+
+    return items;
+}
+
+void MissionManagerTest::_testRedundantFenceWrite(void)
+{
+    _initForFirmwareType(MAV_AUTOPILOT_PX4);
+
+    Vehicle* vehicle = qgcApp()->toolbox()->multiVehicleManager()->activeVehicle();
+    if (!vehicle->initialPlanRequestComplete()) {
+        QSignalSpy spyInitialPlan(vehicle, &Vehicle::initialPlanRequestCompleteChanged);
+        QVERIFY(spyInitialPlan.wait(_missionManagerSignalWaitTime * 3));
+    }
+
+    PlanManager*    fenceManager = vehicle->geoFenceManager();
+    QSignalSpy      spySendComplete(fenceManager, &PlanManager::sendComplete);
+    int             writeCount = _mockLink->missionWriteSequenceCount();
+
+    fenceManager->writeMissionItems(_fenceItems());
+    QVERIFY(spySendComplete.wait(_missionManagerSignalWaitTime));
+    QCOMPARE(spySendComplete.takeFirst()[0].toBool(), false);
+    QCOMPARE(_mockLink->missionWriteSequenceCount(), writeCount + 1);
+
+    // Same items only check the count on the vehicle
+    fenceManager->writeMissionItems(_fenceItems());
+    QVERIFY(spySendComplete.wait(_missionManagerSignalWaitTime));
+    QCOMPARE(spySendComplete.takeFirst()[0].toBool(), false);
+    QCOMPARE(_mockLink->missionWriteSequenceCount(), writeCount + 1);
+    QCOMPARE(fenceManager->missionItems().count(), 4);
+
+    // Vehicle lost its fence
+    _mockLink->resetMissionItemHandler();
+    fenceManager->writeMissionItems(_fenceItems());
+    QVERIFY(spySendComplete.wait(_missionManagerSignalWaitTime));
+    QCOMPARE(spySendComplete.takeFirst()[0].toBool(), false);
+    QCOMPARE(_mockLink->missionWriteSequenceCount(), writeCount + 2);
+
+    // Changed fence
+    QList<MissionItem*> changedItems = _fenceItems();
+    changedItems[1]->setParam5(47.4);
+    fenceManager->writeMissionItems(changedItems);
+    QVERIFY(spySendComplete.wait(_missionManagerSignalWaitTime));
+    QCOMPARE(spySendComplete.takeFirst()[0].toBool(), false);
+    QCOMPARE(_mockLink->missionWriteSequenceCount(), writeCount + 3);
+}
+
+mavlink_mission_item_int_t MissionManagerTest::_ftpItem(uint16_t seq, MAV_CMD command, MAV_FRAME frame, float param1, int32_t x, int32_t y, float z)
+{
+    mavlink_mission_item_int_t item;
+
+    memset(&item, 0, sizeof(item));
+    item.seq            = seq;
+    item.command        = command;
+    item.frame          = frame;
+    item.param1         = param1;
+    item.x              = x;
+    item.y              = y;
+    item.z              = z;
+    item.autocontinue   = 1;
+    item.mission_type   = MAV_MISSION_TYPE_MISSION;
+
+    return item;
+}
+
+/// Mission as ArduPilot stores it: home first, then the items, a DO_JUMP to sequence number 2 at the end
+QList<mavlink_mission_item_int_t> MissionManagerTest::_ftpItems(void)
+{
+    return {
+        _ftpItem(0, MAV_CMD_NAV_WAYPOINT,   MAV_FRAME_GLOBAL_INT,               0,  473977000,  85456000,   488),
+        _ftpItem(1, MAV_CMD_NAV_TAKEOFF,    MAV_FRAME_GLOBAL_RELATIVE_ALT_INT,  0,  473977000,  85456000,   20),
+        _ftpItem(2, MAV_CMD_NAV_WAYPOINT,   MAV_FRAME_GLOBAL_RELATIVE_ALT_INT,  0,  473987000,  85466000,   30),
+        _ftpItem(3, MAV_CMD_DO_JUMP,        MAV_FRAME_MISSION,                  2,  3,          0,          0),
+    };
+}
+
+QByteArray MissionManagerTest::_ftpPlanFile(const QList<mavlink_mission_item_int_t>& items, uint16_t magic, uint16_t planType)
+{
+    // Header of magic, plan type, options, start and item count
+    QByteArray  bytes(PlanManager::_ftpPlanFileHeaderSize, 0);
+    uchar*      header = reinterpret_cast<uchar*>(bytes.data());
+
+    qToLittleEndian<quint16>(magic,                                 header);
+    qToLittleEndian<quint16>(planType,                              header + 2);
+    qToLittleEndian<quint16>(0,                                     header + 4);
+    qToLittleEndian<quint16>(0,                                     header + 6);
+    qToLittleEndian<quint16>(static_cast<quint16>(items.count()),   header + 8);
+    for (const mavlink_mission_item_int_t& item: items) {
+        bytes.append(reinterpret_cast<const char*>(&item), sizeof(item));
+    }
+
+    return bytes;
+}
+
+void MissionManagerTest::_initFtpRead(void)
+{
+    // Only ArduPilot has the plans as FTP files. Without a plan file served the initial plan request used the item protocol.
+    _initForFirmwareType(MAV_AUTOPILOT_ARDUPILOTMEGA);
+
+    // Fence and rally are read after the mission, FTPManager must be done with them
+    Vehicle* vehicle = qgcApp()->toolbox()->multiVehicleManager()->activeVehicle();
+    if (!vehicle->initialPlanRequestComplete()) {
+        QSignalSpy spyInitialPlan(vehicle, &Vehicle::initialPlanRequestCompleteChanged);
+        QVERIFY(spyInitialPlan.wait(_missionManagerSignalWaitTime * 3));
+    }
+    _multiSpyMissionManager->clearAllSignals();
+}
+
+void MissionManagerTest::_readMission(void)
+{
+    _missionManager->loadFromVehicle();
+    QVERIFY(_missionManager->inProgress());
+    _checkInProgressValues(true);
+    _multiSpyMissionManager->clearAllSignals();
+
+    _multiSpyMissionManager->waitForSignalByIndex(inProgressChangedSignalIndex, _missionManagerSignalWaitTime);
+    QCOMPARE(_multiSpyMissionManager->checkSignalByMask(newMissionItemsAvailableSignalMask | inProgressChangedSignalMask), true);
+    _checkInProgressValues(false);
+    _multiSpyMissionManager->clearAllSignals();
+}
+
+void MissionManagerTest::_testFtpRead(void)
+{
+    _initFtpRead();
+
+    const QList<mavlink_mission_item_int_t> ftpItems = _ftpItems();
+    _mockLink->mockLinkFTP()->setFileData(_ftpMissionFile, _ftpPlanFile(ftpItems));
+    _readMission();
+
+    const QList<MissionItem*>& items = _missionManager->missionItems();
+    QCOMPARE(items.count(), ftpItems.count());
+    for (int i=0; i<items.count(); i++) {
+        QCOMPARE(items[i]->sequenceNumber(),    i);
+        QCOMPARE(items[i]->command(),           static_cast<MAV_CMD>(ftpItems[i].command));
+        QCOMPARE(items[i]->autoContinue(),      true);
+    }
+
+    // Int frames are converted the same way as for MISSION_ITEM_INT, positions scaled to degrees
+    QCOMPARE(items[0]->frame(),                 MAV_FRAME_GLOBAL);
+    QCOMPARE(items[1]->frame(),                 MAV_FRAME_GLOBAL_RELATIVE_ALT);
+    QCOMPARE(items[2]->frame(),                 MAV_FRAME_GLOBAL_RELATIVE_ALT);
+    QCOMPARE(items[0]->param5(),                47.3977);
+    QCOMPARE(items[0]->param6(),                8.5456);
+    QCOMPARE(items[0]->param7(),                488.0);
+    QCOMPARE(items[2]->param5(),                47.3987);
+    QCOMPARE(items[2]->param6(),                8.5466);
+    QCOMPARE(items[2]->param7(),                30.0);
+
+    // MAV_FRAME_MISSION values aren't scaled. ArduPilot has home in sequence 0, so the jump target stays as it is.
+    QCOMPARE(items[3]->frame(),                 MAV_FRAME_MISSION);
+    QCOMPARE(items[3]->param1(),                2.0);
+    QCOMPARE(items[3]->param5(),                3.0);
+}
+
+void MissionManagerTest::_testFtpReadInvalidFile(void)
+{
+    _initFtpRead();
+
+    const QList<mavlink_mission_item_int_t> ftpItems = _ftpItems();
+    const QByteArray                        planFile = _ftpPlanFile(ftpItems);
+
+    typedef struct {
+        const char* description;
+        QByteArray  planFile;
+    } InvalidFileCase_t;
+
+    const InvalidFileCase_t rgCases[] = {
+        { "Bad magic",          _ftpPlanFile(ftpItems, PlanManager::_ftpPlanFileMagic + 1) },
+        { "Other plan type",    _ftpPlanFile(ftpItems, PlanManager::_ftpPlanFileMagic, MAV_MISSION_TYPE_FENCE) },
+        { "Truncated item",     planFile.left(planFile.size() - 1) },
+        { "Extra bytes",        planFile + QByteArray(1, 0) },
+        { "Short header",       planFile.left(PlanManager::_ftpPlanFileHeaderSize - 1) },
+    };
+
+    // The vehicle holds no items for the item protocol, the FTP file would give four
+    for (const InvalidFileCase_t& invalidCase: rgCases) {
+        qDebug() << "TEST CASE _testFtpReadInvalidFile" << invalidCase.description;
+        _mockLink->mockLinkFTP()->setFileData(_ftpMissionFile, invalidCase.planFile);
+        _readMission();
+        QCOMPARE(_missionManager->missionItems().count(), 0);
+    }
+
+    // A valid file is used again afterwards
+    _mockLink->mockLinkFTP()->setFileData(_ftpMissionFile, planFile);
+    _readMission();
+    QCOMPARE(_missionManager->missionItems().count(), ftpItems.count());
+}
+
+void MissionManagerTest::_testFtpReadBusy(void)
+{
+    _initFtpRead();
+
+    _mockLink->mockLinkFTP()->setFileData(_ftpMissionFile, _ftpPlanFile(_ftpItems()));
+
+    // FTPManager only does one thing at a time, a download in progress sends the read to the item protocol
+    FTPManager*     ftpManager = qgcApp()->toolbox()->multiVehicleManager()->activeVehicle()->ftpManager();
+    QTemporaryDir   downloadDir;
+    QSignalSpy      spyDownloadComplete(ftpManager, &FTPManager::downloadComplete);
+    QVERIFY(downloadDir.isValid());
+    QVERIFY(ftpManager->download(QStringLiteral("%1%2").arg(MockLinkFTP::sizeFilenamePrefix).arg(64 * 1024), downloadDir.path()));
+
+    _readMission();
+    QCOMPARE(_missionManager->missionItems().count(), 0);
+
+    // Completion of the other download isn't taken for the plan
+    if (spyDownloadComplete.isEmpty()) {
+        QVERIFY(spyDownloadComplete.wait(_missionManagerSignalWaitTime));
+    }
+    QCOMPARE(spyDownloadComplete.takeFirst()[1].toString(), QString());
+    QCOMPARE(_multiSpyMissionManager->checkNoSignals(), true);
+    QCOMPARE(_missionManager->missionItems().count(), 0);
+
+    // Once FTPManager is free the FTP file is read
+    _readMission();
+    QCOMPARE(_missionManager->missionItems().count(), _ftpItems().count());
+}
+
+void MissionManagerTest::_pipelinedReadWorker(MockLinkMissionItemHandler::FailureMode_t failureMode)
+{
+    // Enough items for the window to open up against the response delay
+    const int cItems                = 40;
+    const int responseDelayMsecs    = 200;
+
+    _initForFirmwareType(MAV_AUTOPILOT_PX4);
+
+    _mockLink->loadMissionItems(cItems);
+    _mockLink->setMissionItemFailureMode(failureMode, MAV_MISSION_ERROR);
+    _mockLink->setMissionItemReadResponseDelay(responseDelayMsecs);
+
+    _readMission();
+
+    QCOMPARE(_missionManager->missionItems().count(), cItems);
+    for (int i=0; i<cItems; i++) {
+        QCOMPARE(_missionManager->missionItems()[i]->sequenceNumber(), i);
+    }
+
+    // The round trip time is several times _readWindowRttMilliseconds so more than one request was kept outstanding
+    QVERIFY(_missionManager->readWindow() > 1);
+    QVERIFY(_missionManager->readWindow() <= PlanManager::_maxReadWindow);
+
+    _mockLink->resetMissionItemHandler();
+}
+
+void MissionManagerTest::_testPipelinedRead(void)
+{
+    _pipelinedReadWorker(MockLinkMissionItemHandler::FailNone);
+}
+
+void MissionManagerTest::_testPipelinedReadDropped(void)
+{
+    // The response to item 1 is dropped, the read times out on it, retries with a smaller window and still gets every item
+    _pipelinedReadWorker(MockLinkMissionItemHandler::FailReadRequest1FirstResponse);
+}
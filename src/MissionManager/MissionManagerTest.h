@@ -32,12 +32,27 @@ private slots:
     void _testReadFailureHandlingPX4(void);
     void _testReadFailureHandlingAPM(void);
     void _testErrorAckFailureStrings(void);
+    void _testRedundantFenceWrite(void);
+    void _testFtpRead(void);
+    void _testFtpReadInvalidFile(void);
+    void _testFtpReadBusy(void);
+    void _testPipelinedRead(void);
+    void _testPipelinedReadDropped(void);
 
 private:
     void _roundTripItems(MockLinkMissionItemHandler::FailureMode_t failureMode, MAV_MISSION_RESULT failureAckResult, bool shouldFail);
     void _writeItems(MockLinkMissionItemHandler::FailureMode_t failureMode, MAV_MISSION_RESULT failureAckResult, bool shouldFail);
     void _testWriteFailureHandlingWorker(void);
     void _testReadFailureHandlingWorker(void);
+    void _initFtpRead(void);
+    void _readMission(void);
+    void _pipelinedReadWorker(MockLinkMissionItemHandler::FailureMode_t failureMode);
+
+    static mavlink_mission_item_int_t   _ftpItem(uint16_t seq, MAV_CMD command, MAV_FRAME frame, float param1, int32_t x, int32_t y, float z);
+    static QByteArray                   _ftpPlanFile(const QList<mavlink_mission_item_int_t>& items, uint16_t magic = PlanManager::_ftpPlanFileMagic, uint16_t planType = MAV_MISSION_TYPE_MISSION);
+    static QList<mavlink_mission_item_int_t> _ftpItems(void);
+
+    static const char* _ftpMissionFile;
     
     static const TestCase_t _rgTestCases[];
     static const size_t     _cTestCases;
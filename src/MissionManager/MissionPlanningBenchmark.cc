@@ -0,0 +1,322 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MissionPlanningBenchmark.h"
+#include "BenchmarkResults.h"
+#include "PlanMasterController.h"
+#include "MissionController.h"
+#include "MissionManager.h"
+#include "SurveyComplexItem.h"
+#include "CorridorScanComplexItem.h"
+#include "TerrainQuery.h"
+#include "Vehicle.h"
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimer>
+#include <QtMath>
+
+const QGeoCoordinate MissionPlanningBenchmark::_origin(47.3769, 8.549444);
+
+MissionPlanningBenchmark::MissionPlanningBenchmark(void)
+{
+
+}
+
+void MissionPlanningBenchmark::init(void)
+{
+    UnitTest::init();
+
+    _masterController = new PlanMasterController(this);
+    _masterController->setFlyView(false);
+    _masterController->start();
+}
+
+void MissionPlanningBenchmark::cleanup(void)
+{
+    delete _masterController;
+    _masterController = nullptr;
+
+    UnitTest::cleanup();
+}
+
+/// Writes a QGC WPL 110 file with a home position followed by a lawnmower of plain waypoints
+void MissionPlanningBenchmark::_writeWaypointFile(const QString& filename, int waypointCount)
+{
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Text));
+
+    QTextStream stream(&file);
+    stream.setRealNumberPrecision(10);
+    stream << "QGC WPL 110\n";
+    stream << "0\t1\t0\t16\t0\t0\t0\t0\t" << _origin.latitude() << "\t" << _origin.longitude() << "\t488\t1\n";
+    for (int i=1; i<=waypointCount; i++) {
+        QGeoCoordinate coord = _origin.atDistanceAndAzimuth(25.0 * (i % 40), 90).atDistanceAndAzimuth(50.0 * (i / 40), 0);
+        stream << i << "\t0\t3\t16\t0\t0\t0\t0\t" << coord.latitude() << "\t" << coord.longitude() << "\t50\t1\n";
+    }
+}
+
+/// @param concave true: alternate vertices are pulled in to form a star
+QList<QGeoCoordinate> MissionPlanningBenchmark::_polygonVertices(const QGeoCoordinate& center, double radius, int vertexCount, bool concave)
+{
+    QList<QGeoCoordinate> vertices;
+    for (int i=0; i<vertexCount; i++) {
+        double vertexRadius = concave && (i % 2) ? radius * 0.6 : radius;
+        vertices.append(center.atDistanceAndAzimuth(vertexRadius, 360.0 * i / vertexCount));
+    }
+    return vertices;
+}
+
+void MissionPlanningBenchmark::_planLoadBenchmark_data(void)
+{
+    QTest::addColumn<int>("waypointCount");
+
+    QTest::newRow("1000Waypoints") << 1000;
+    QTest::newRow("5000Waypoints") << 5000;
+}
+
+void MissionPlanningBenchmark::_planLoadBenchmark(void)
+{
+    QFETCH(int, waypointCount);
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QString waypointFilename = tempDir.filePath(QStringLiteral("MissionPlanningBenchmark.waypoints"));
+    QString planFilename = tempDir.filePath(QStringLiteral("MissionPlanningBenchmark.plan"));
+    _writeWaypointFile(waypointFilename, waypointCount);
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    // Mission settings item plus every waypoint
+    int expectedVisualItemCount = waypointCount + 1;
+    _masterController->loadFromFile(waypointFilename);
+    QCoreApplication::processEvents();
+    QCOMPARE(_masterController->missionController()->visualItems()->count(), expectedVisualItemCount);
+    _masterController->saveToFile(planFilename);
+    QTRY_VERIFY(!_masterController->planFileInProgress());
+
+    QSignalSpy      loadCompleteSpy(_masterController, &PlanMasterController::loadFromFileComplete);
+    int             iterations = BenchmarkResults::iterations();
+    QElapsedTimer   timer;
+    qint64          elapsedNSecs = 0;
+    for (int i=0; i<iterations; i++) {
+        timer.start();
+        _masterController->loadFromFile(planFilename);
+        QVERIFY(loadCompleteSpy.wait());
+        QCoreApplication::processEvents();
+        elapsedNSecs += timer.nsecsElapsed();
+
+        QCOMPARE(_masterController->missionController()->visualItems()->count(), expectedVisualItemCount);
+    }
+
+    double msecsPerLoad = elapsedNSecs / 1.0e6 / iterations;
+    BenchmarkResults::record(this, QStringLiteral("msecsPerLoad"), msecsPerLoad, QStringLiteral("ms"));
+    BenchmarkResults::record(this, QStringLiteral("itemsPerSec"), msecsPerLoad > 0 ? expectedVisualItemCount / (msecsPerLoad / 1000.0) : 0, QStringLiteral("items/s"));
+}
+
+void MissionPlanningBenchmark::_surveyRebuildBenchmark_data(void)
+{
+    QTest::addColumn<int>("vertexCount");
+    QTest::addColumn<bool>("concave");
+
+    QTest::newRow("convex64")   << 64   << false;
+    QTest::newRow("convex1024") << 1024 << false;
+    QTest::newRow("concave64")  << 64   << true;
+    QTest::newRow("concave256") << 256  << true;
+}
+
+void MissionPlanningBenchmark::_surveyRebuildBenchmark(void)
+{
+    QFETCH(int,     vertexCount);
+    QFETCH(bool,    concave);
+
+    SurveyComplexItem* surveyItem = new SurveyComplexItem(_masterController, false /* flyView */, QString() /* kmlOrShpFile */, this);
+
+    // Time the rebuild itself, not the hand off to the background worker
+    surveyItem->_setBackgroundRebuildMinCost(1e12);
+    surveyItem->cameraCalc()->adjustedFootprintSide()->setRawValue(20);
+    surveyItem->cameraCalc()->adjustedFootprintFrontal()->setRawValue(20);
+    surveyItem->splitConcavePolygons()->setRawValue(concave);
+
+    QList<QGeoCoordinate> vertices = _polygonVertices(_origin, 2000, vertexCount, concave);
+    surveyItem->surveyAreaPolygon()->appendVertices(vertices);
+    QVERIFY(surveyItem->_transectCount() > 0);
+
+    // Each rebuild is triggered by a drag step of a single vertex, the same as editing the polygon on the map
+    int             rebuildCount = BenchmarkResults::iterations() * 10;
+    QElapsedTimer   timer;
+    timer.start();
+    for (int i=0; i<rebuildCount; i++) {
+        int vertexIndex = i % vertexCount;
+        surveyItem->surveyAreaPolygon()->adjustVertex(vertexIndex, vertices[vertexIndex].atDistanceAndAzimuth(i % 2 ? 0 : 5, 0));
+    }
+    qint64 elapsedNSecs = timer.nsecsElapsed();
+
+    BenchmarkResults::record(this, QStringLiteral("msecsPerRebuild"), elapsedNSecs / 1.0e6 / rebuildCount, QStringLiteral("ms"));
+    BenchmarkResults::record(this, QStringLiteral("transectCount"), surveyItem->_transectCount(), QStringLiteral("transects"));
+
+    delete surveyItem;
+}
+
+void MissionPlanningBenchmark::_corridorScanBenchmark_data(void)
+{
+    QTest::addColumn<int>("vertexCount");
+    QTest::addColumn<double>("corridorWidth");
+
+    QTest::newRow("100Vertices")        << 100  << 100.0;
+    QTest::newRow("1000Vertices")       << 1000 << 100.0;
+    QTest::newRow("1000VerticesWide")   << 1000 << 500.0;
+}
+
+void MissionPlanningBenchmark::_corridorScanBenchmark(void)
+{
+    QFETCH(int,     vertexCount);
+    QFETCH(double,  corridorWidth);
+
+    CorridorScanComplexItem* corridorItem = new CorridorScanComplexItem(_masterController, false /* flyView */, QString() /* kmlFile */, this);
+
+    corridorItem->cameraCalc()->adjustedFootprintSide()->setRawValue(20);
+    corridorItem->cameraCalc()->adjustedFootprintFrontal()->setRawValue(20);
+    corridorItem->corridorWidth()->setRawValue(corridorWidth);
+
+    // Zig zag eastwards so every vertex is a turn
+    QList<QGeoCoordinate> vertices;
+    for (int i=0; i<vertexCount; i++) {
+        vertices.append(_origin.atDistanceAndAzimuth(100.0 * i, 90).atDistanceAndAzimuth(i % 2 ? 50 : 0, 0));
+    }
+    corridorItem->corridorPolyline()->appendVertices(vertices);
+    QVERIFY(corridorItem->lastSequenceNumber() > corridorItem->sequenceNumber());
+
+    int             rebuildCount = BenchmarkResults::iterations() * 10;
+    QElapsedTimer   timer;
+    timer.start();
+    for (int i=0; i<rebuildCount; i++) {
+        int vertexIndex = i % vertexCount;
+        corridorItem->corridorPolyline()->adjustVertex(vertexIndex, vertices[vertexIndex].atDistanceAndAzimuth(i % 2 ? 0 : 5, 0));
+    }
+    qint64 elapsedNSecs = timer.nsecsElapsed();
+
+    BenchmarkResults::record(this, QStringLiteral("msecsPerRebuild"), elapsedNSecs / 1.0e6 / rebuildCount, QStringLiteral("ms"));
+
+    delete corridorItem;
+}
+
+void MissionPlanningBenchmark::_terrainPathQueryBenchmark_data(void)
+{
+    QTest::addColumn<int>("pathCoordCount");
+
+    QTest::newRow("100Coords")  << 100;
+    QTest::newRow("1000Coords") << 1000;
+}
+
+void MissionPlanningBenchmark::_terrainPathQueryBenchmark(void)
+{
+    QFETCH(int, pathCoordCount);
+
+    // Lawnmower across the sloped region so every segment has a different height profile
+    const QGeoRectangle&    region      = UnitTestTerrainQuery::linearSlopeRegion;
+    double                  latStep     = region.height() / (pathCoordCount + 1);
+    QList<QGeoCoordinate>   pathCoords;
+    for (int i=0; i<pathCoordCount; i++) {
+        double lon = region.topLeft().longitude() + region.width() * (i % 2 ? 0.9 : 0.1);
+        pathCoords.append(QGeoCoordinate(region.topLeft().latitude() - latStep * (i + 1), lon));
+    }
+
+    int             iterations      = BenchmarkResults::iterations();
+    int             heightCount     = 0;
+    qint64          elapsedNSecs    = 0;
+    QElapsedTimer   timer;
+    for (int i=0; i<iterations; i++) {
+        TerrainPolyPathQuery    query(false /* autoDelete */);
+        QEventLoop              loop;
+        bool                    received    = false;
+        bool                    success     = false;
+
+        connect(&query, &TerrainPolyPathQuery::terrainDataReceived, &loop, [&](bool querySuccess, const QList<TerrainPathQuery::PathHeightInfo_t>& rgPathHeightInfo) {
+            received    = true;
+            success     = querySuccess;
+            heightCount = 0;
+            for (const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo: rgPathHeightInfo) {
+                heightCount += pathHeightInfo.heights.count();
+            }
+            loop.quit();
+        });
+        QTimer::singleShot(30000, &loop, &QEventLoop::quit);
+
+        timer.start();
+        query.requestData(pathCoords);
+        if (!received) {
+            loop.exec();
+        }
+        elapsedNSecs += timer.nsecsElapsed();
+
+        QVERIFY(received);
+        QVERIFY(success);
+    }
+
+    BenchmarkResults::record(this, QStringLiteral("msecsPerQuery"), elapsedNSecs / 1.0e6 / iterations, QStringLiteral("ms"));
+    BenchmarkResults::record(this, QStringLiteral("heightCount"), heightCount, QStringLiteral("heights"));
+}
+
+void MissionPlanningBenchmark::_missionUploadBenchmark_data(void)
+{
+    QTest::addColumn<int>("itemCount");
+
+    QTest::newRow("100Items") << 100;
+    QTest::newRow("500Items") << 500;
+}
+
+void MissionPlanningBenchmark::_missionUploadBenchmark(void)
+{
+    QFETCH(int, itemCount);
+
+    _connectMockLink(MAV_AUTOPILOT_PX4);
+    MissionManager* missionManager = _vehicle->missionManager();
+
+    int             iterations      = BenchmarkResults::iterations();
+    qint64          elapsedNSecs    = 0;
+    QElapsedTimer   timer;
+    for (int i=0; i<iterations; i++) {
+        // MissionManager takes ownership of the items, except for the home position on PX4
+        QList<MissionItem*> missionItems;
+        MissionItem* homeItem = new MissionItem(nullptr /* Vehicle */, this);
+        homeItem->setCommand(MAV_CMD_NAV_WAYPOINT);
+        homeItem->setParam5(_origin.latitude());
+        homeItem->setParam6(_origin.longitude());
+        homeItem->setParam7(0);
+        homeItem->setSequenceNumber(0);
+        missionItems.append(homeItem);
+        for (int seq=1; seq<=itemCount; seq++) {
+            QGeoCoordinate coord = _origin.atDistanceAndAzimuth(10.0 * seq, 45);
+            missionItems.append(new MissionItem(seq, MAV_CMD_NAV_WAYPOINT, MAV_FRAME_GLOBAL_RELATIVE_ALT,
+                                                0, 0, 0, qQNaN(), coord.latitude(), coord.longitude(), 50,
+                                                true /* autoContinue */, false /* isCurrentItem */, this));
+        }
+
+        QSignalSpy sendCompleteSpy(missionManager, &MissionManager::sendComplete);
+        timer.start();
+        missionManager->writeMissionItems(missionItems);
+        QVERIFY(sendCompleteSpy.wait(60000));
+        elapsedNSecs += timer.nsecsElapsed();
+
+        QCOMPARE(sendCompleteSpy.count(), 1);
+        QCOMPARE(sendCompleteSpy[0][0].toBool(), false /* error */);
+    }
+
+    double msecsPerUpload = elapsedNSecs / 1.0e6 / iterations;
+    BenchmarkResults::record(this, QStringLiteral("msecsPerUpload"), msecsPerUpload, QStringLiteral("ms"));
+    BenchmarkResults::record(this, QStringLiteral("itemsPerSec"), msecsPerUpload > 0 ? itemCount / (msecsPerUpload / 1000.0) : 0, QStringLiteral("items/s"));
+
+    _disconnectMockLink();
+}
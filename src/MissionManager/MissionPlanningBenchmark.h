@@ -0,0 +1,57 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QGeoCoordinate>
+
+class PlanMasterController;
+
+/// Benchmarks for the mission planning code paths, run against generated inputs much larger than the unit tests use:
+///     - Plan file load of generated missions
+///     - Survey rebuild while a polygon vertex is dragged, including split concave polygons
+///     - Corridor scan rebuild while a polyline vertex is dragged
+///     - Terrain follow path queries against UnitTestTerrainQuery
+///     - Mission upload to MockLinkMissionItemHandler
+///
+/// Rebuilds are repeated 10 times QGC_BENCH_ITERATIONS. See BenchmarkResults for how to run it and where results go.
+class MissionPlanningBenchmark : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    MissionPlanningBenchmark(void);
+
+protected:
+    void init   (void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _planLoadBenchmark_data        (void);
+    void _planLoadBenchmark             (void);
+    void _surveyRebuildBenchmark_data   (void);
+    void _surveyRebuildBenchmark        (void);
+    void _corridorScanBenchmark_data    (void);
+    void _corridorScanBenchmark         (void);
+    void _terrainPathQueryBenchmark_data(void);
+    void _terrainPathQueryBenchmark     (void);
+    void _missionUploadBenchmark_data   (void);
+    void _missionUploadBenchmark        (void);
+
+private:
+    void    _writeWaypointFile  (const QString& filename, int waypointCount);
+
+    static QList<QGeoCoordinate>    _polygonVertices(const QGeoCoordinate& center, double radius, int vertexCount, bool concave);
+
+    PlanMasterController* _masterController = nullptr;
+
+    static const QGeoCoordinate _origin;
+};
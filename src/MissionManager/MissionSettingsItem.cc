@@ -36,7 +36,7 @@ MissionSettingsItem::MissionSettingsItem(PlanMasterController* masterController,
     _editorQml = "qrc:/qml/MissionSettingsEditor.qml";
 
     if (_metaDataMap.isEmpty()) {
-        _metaDataMap = FactMetaData::createMapFromJsonFile(QStringLiteral(":/json/MissionSettings.FactMetaData.json"), nullptr /* metaDataParent */);
+        _metaDataMap = FactMetaData::sharedMapFromJsonFile(QStringLiteral(":/json/MissionSettings.FactMetaData.json"));
     }
 
     _plannedHomePositionAltitudeFact.setMetaData    (_metaDataMap[_plannedHomePositionAltitudeName]);
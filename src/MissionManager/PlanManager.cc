@@ -14,6 +14,13 @@
 #include "QGCApplication.h"
 #include "MissionCommandTree.h"
 #include "MissionCommandUIInfo.h"
+#include "QGC.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+#include <algorithm>
 
 QGC_LOGGING_CATEGORY(PlanManagerLog, "PlanManagerLog")
 
@@ -27,18 +34,22 @@ PlanManager::PlanManager(Vehicle* vehicle, MAV_MISSION_TYPE planType)
     , _resumeMission            (false)
     , _lastMissionRequest       (-1)
     , _missionItemCountToRead   (-1)
+    , _readSmoothedRttMsecs     (-1)
+    , _readMinRttMsecs          (-1)
+    , _readTimeoutMsecs         (_retryTimeoutMilliseconds)
+    , _readWindow               (1)
     , _currentMissionIndex      (-1)
     , _lastCurrentIndex         (-1)
 {
-    _ackTimeoutTimer = new QTimer(this);
+    _ackTimeoutTimer = new QGCWheelTimer("PlanManager", this);
     _ackTimeoutTimer->setSingleShot(true);
 
-    connect(_ackTimeoutTimer, &QTimer::timeout, this, &PlanManager::_ackTimeout);
+    connect(_ackTimeoutTimer, &QGCWheelTimer::timeout, this, &PlanManager::_ackTimeout);
 }
 
 PlanManager::~PlanManager()
 {
-
+    delete _ftpReadDir;
 }
 
 void PlanManager::_writeMissionItemsWorker(void)
@@ -58,7 +69,17 @@ void PlanManager::_writeMissionItemsWorker(void)
     _retryCount = 0;
     _setTransactionInProgress(TransactionWrite);
     _connectToMavlink();
-    _writeMissionCount();
+
+    // Large fences take a round trip per vertex. If these are the same items the vehicle had as of the last
+    // transaction only check that it still has that many. Missions are always written since that also resets
+    // the current item.
+    if (_planType != MAV_MISSION_TYPE_MISSION && _vehicleItemsKnown && itemsCrc(_writeMissionItems) == _vehicleItemsCrc) {
+        qCDebug(PlanManagerLog) << QStringLiteral("_writeMissionItemsWorker %1 same items as vehicle, checking count").arg(_planTypeString());
+        _sendRequestList();
+        _startAckTimeout(AckWriteCheck);
+    } else {
+        _writeMissionCount();
+    }
 }
 
 
@@ -134,10 +155,146 @@ void PlanManager::loadFromVehicle(void)
         return;
     }
 
-    _retryCount = 0;
+    _retryCount             = 0;
+    _readSmoothedRttMsecs   = -1;
+    _readMinRttMsecs        = -1;
+    _readTimeoutMsecs       = _retryTimeoutMilliseconds;
+    _readWindow             = 1;
+    _readClock.start();
     _setTransactionInProgress(TransactionRead);
-    _connectToMavlink();
-    _requestList();
+    if (!_ftpReadBegin()) {
+        _connectToMavlink();
+        _requestList();
+    }
+}
+
+/// Starts reading the whole plan as a single MAVLink FTP file download if the firmware supports that
+/// @return true: download started, false: plan must be read using the item protocol
+bool PlanManager::_ftpReadBegin(void)
+{
+    QString ftpFile = _vehicle->firmwarePlugin()->planFtpFile(_planType);
+    if (ftpFile.isEmpty()) {
+        return false;
+    }
+
+    delete _ftpReadDir;
+    _ftpReadDir = new QTemporaryDir();
+    if (!_ftpReadDir->isValid()) {
+        qCWarning(PlanManagerLog) << QStringLiteral("_ftpReadBegin %1 unable to create download directory").arg(_planTypeString());
+        delete _ftpReadDir;
+        _ftpReadDir = nullptr;
+        return false;
+    }
+
+    FTPManager* ftpManager = _vehicle->ftpManager();
+    connect(ftpManager, &FTPManager::downloadComplete,  this, &PlanManager::_ftpReadComplete);
+    connect(ftpManager, &FTPManager::commandProgress,   this, &PlanManager::_ftpReadProgress);
+    if (!ftpManager->download(ftpFile, _ftpReadDir->path())) {
+        // FTPManager is busy with something else
+        qCDebug(PlanManagerLog) << QStringLiteral("_ftpReadBegin %1 FTP download could not be started, using item protocol").arg(_planTypeString());
+        ftpManager->disconnect(this);
+        delete _ftpReadDir;
+        _ftpReadDir = nullptr;
+        return false;
+    }
+
+    qCDebug(PlanManagerLog) << QStringLiteral("_ftpReadBegin %1 reading").arg(_planTypeString()) << ftpFile;
+    return true;
+}
+
+void PlanManager::_ftpReadProgress(int value)
+{
+    emit progressPct(value / 100.0);
+}
+
+void PlanManager::_ftpReadComplete(const QString& file, const QString& errorMsg)
+{
+    if (!_ftpReadDir || !file.startsWith(_ftpReadDir->path())) {
+        return;
+    }
+
+    _vehicle->ftpManager()->disconnect(this);
+
+    bool success = errorMsg.isEmpty() && _loadFtpPlanFile(file);
+
+    delete _ftpReadDir;
+    _ftpReadDir = nullptr;
+
+    if (success) {
+        qCDebug(PlanManagerLog) << QStringLiteral("_ftpReadComplete %1 count:").arg(_planTypeString()) << _missionItems.count();
+        _finishTransaction(true);
+    } else {
+        // Fall back to the item protocol. Not all firmware versions which know the FTP plan files support every plan type.
+        qCDebug(PlanManagerLog) << QStringLiteral("_ftpReadComplete %1 FTP read failed, using item protocol:").arg(_planTypeString()) << errorMsg;
+        _connectToMavlink();
+        _requestList();
+    }
+}
+
+/// Loads _missionItems from a plan file downloaded over MAVLink FTP
+/// @return false: file is not a valid plan file for this plan type, _missionItems is left empty
+bool PlanManager::_loadFtpPlanFile(const QString& filename)
+{
+    _clearMissionItems();
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCDebug(PlanManagerLog) << "_loadFtpPlanFile open failed" << file.errorString();
+        return false;
+    }
+    QByteArray bytes = file.readAll();
+
+    if (bytes.size() < _ftpPlanFileHeaderSize) {
+        qCDebug(PlanManagerLog) << "_loadFtpPlanFile file too short" << bytes.size();
+        return false;
+    }
+    const uchar* header = reinterpret_cast<const uchar*>(bytes.constData());
+    uint16_t magic      = qFromLittleEndian<quint16>(header);
+    uint16_t planType   = qFromLittleEndian<quint16>(header + 2);
+    uint16_t start      = qFromLittleEndian<quint16>(header + 6);
+    uint16_t itemCount  = qFromLittleEndian<quint16>(header + 8);
+
+    const int itemSize = sizeof(mavlink_mission_item_int_t);
+    if (magic != _ftpPlanFileMagic || planType != _planType || start != 0 || bytes.size() != _ftpPlanFileHeaderSize + (itemCount * itemSize)) {
+        qCDebug(PlanManagerLog) << "_loadFtpPlanFile invalid header magic:planType:start:itemCount:size" << magic << planType << start << itemCount << bytes.size();
+        return false;
+    }
+
+    for (int i=0; i<itemCount; i++) {
+        mavlink_mission_item_int_t missionItem;
+        memcpy(&missionItem, bytes.constData() + _ftpPlanFileHeaderSize + (i * itemSize), itemSize);
+
+        // Same conversions as a MISSION_ITEM_INT received through the item protocol
+        MAV_FRAME frame = static_cast<MAV_FRAME>(missionItem.frame);
+        if (frame == MAV_FRAME_GLOBAL_INT) {
+            frame = MAV_FRAME_GLOBAL;
+        } else if (frame == MAV_FRAME_GLOBAL_RELATIVE_ALT_INT) {
+            frame = MAV_FRAME_GLOBAL_RELATIVE_ALT;
+        }
+
+        MissionItem* item = new MissionItem(missionItem.seq,
+                                            static_cast<MAV_CMD>(missionItem.command),
+                                            frame,
+                                            missionItem.param1,
+                                            missionItem.param2,
+                                            missionItem.param3,
+                                            missionItem.param4,
+                                            missionItem.frame == MAV_FRAME_MISSION ? (double)missionItem.x : (double)missionItem.x * 1e-7,
+                                            missionItem.frame == MAV_FRAME_MISSION ? (double)missionItem.y : (double)missionItem.y * 1e-7,
+                                            (double)missionItem.z,
+                                            missionItem.autocontinue,
+                                            missionItem.current,
+                                            this);
+
+        if (item->command() == MAV_CMD_DO_JUMP && !_vehicle->firmwarePlugin()->sendHomePositionToVehicle()) {
+            // Home is in position 0
+            item->setParam1((int)item->param1() + 1);
+        }
+
+        _missionItems.append(item);
+    }
+
+    return true;
 }
 
 /// Internal call to request list of mission items. May be called during a retry sequence.
@@ -145,9 +302,13 @@ void PlanManager::_requestList(void)
 {
     qCDebug(PlanManagerLog) << QStringLiteral("_requestList %1 _planType:_retryCount").arg(_planTypeString()) << _planType << _retryCount;
 
-    _itemIndicesToRead.clear();
     _clearMissionItems();
+    _sendRequestList();
+    _startAckTimeout(AckMissionCount);
+}
 
+void PlanManager::_sendRequestList(void)
+{
     WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
     if (!weakLink.expired()) {
         mavlink_message_t       message;
@@ -163,7 +324,6 @@ void PlanManager::_requestList(void)
 
         _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), message);
     }
-    _startAckTimeout(AckMissionCount);
 }
 
 void PlanManager::_ackTimeout(void)
@@ -195,7 +355,15 @@ void PlanManager::_ackTimeout(void)
             _finishTransaction(false);
         } else {
             _retryCount++;
-            qCDebug(PlanManagerLog) << tr("Retrying %1 MISSION_REQUEST retry Count").arg(_planTypeString()) << _retryCount;
+            qCDebug(PlanManagerLog) << tr("Retrying %1 MISSION_REQUEST retry Count:window").arg(_planTypeString()) << _retryCount << _readWindow;
+            // Everything outstanding is requested again. Back off both the timeout and the window since the link is
+            // either slower than we thought or dropping messages.
+            for (auto iter = _outstandingReadRequests.keyBegin(); iter != _outstandingReadRequests.keyEnd(); iter++) {
+                _retriedReadRequests.insert(*iter);
+            }
+            _outstandingReadRequests.clear();
+            _readTimeoutMsecs   = qMin(_readTimeoutMsecs * 2, static_cast<int>(_maxReadTimeoutMilliseconds));
+            _readWindow         = qMax(1, _readWindow / 2);
             _requestNextMissionItem();
         }
         break;
@@ -233,6 +401,11 @@ void PlanManager::_ackTimeout(void)
             _removeAllWorker();
         }
         break;
+    case AckWriteCheck:
+        // Can't tell what the vehicle has, so write the items
+        qCDebug(PlanManagerLog) << QStringLiteral("_ackTimeout %1 no count for write check, writing").arg(_planTypeString());
+        _writeMissionCount();
+        break;
     case AckGuidedItem:
         // MISSION_REQUEST is expected, or MISSION_ACK to end sequence
     default:
@@ -246,7 +419,12 @@ void PlanManager::_startAckTimeout(AckType_t ack)
 {
     switch (ack) {
     case AckMissionItem:
-        // We are actively trying to get the mission item, so we don't want to wait as long.
+        // We are actively trying to get the mission item, so we don't want to wait as long. This adapts to the
+        // measured round trip time so slow links don't retry every item.
+        _ackTimeoutTimer->setInterval(_readTimeoutMsecs);
+        break;
+    case AckWriteCheck:
+        // Only used to skip the write, so don't hold it up for long
         _ackTimeoutTimer->setInterval(_retryTimeoutMilliseconds);
         break;
     case AckNone:
@@ -281,7 +459,7 @@ bool PlanManager::_checkForExpectedAck(AckType_t receivedAck)
         } else {
             // We just warn in this case, this could be crap left over from a previous transaction or the vehicle going bonkers.
             // Whatever it is we let the ack timeout handle any error output to the user.
-            qCDebug(PlanManagerLog) << QString("Out of sequence ack %1 expected:received %2:%3").arg(_planTypeString().arg(_ackTypeToString(_expectedAck)).arg(_ackTypeToString(receivedAck)));
+            qCDebug(PlanManagerLog) << QStringLiteral("Out of sequence ack %1 expected:received").arg(_planTypeString()) << _ackTypeToString(_expectedAck) << _ackTypeToString(receivedAck);
         }
         return false;
     }
@@ -291,6 +469,12 @@ void PlanManager::_readTransactionComplete(void)
 {
     qCDebug(PlanManagerLog) << "_readTransactionComplete read sequence complete";
     
+    _sendMissionAck(MAV_MISSION_ACCEPTED);
+    _finishTransaction(true);
+}
+
+void PlanManager::_sendMissionAck(MAV_MISSION_RESULT result)
+{
     WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
     if (!weakLink.expired()) {
         SharedLinkInterfacePtr  sharedLink = weakLink.lock();
@@ -302,13 +486,11 @@ void PlanManager::_readTransactionComplete(void)
                                           &message,
                                           _vehicle->id(),
                                           MAV_COMP_ID_AUTOPILOT1,
-                                          MAV_MISSION_ACCEPTED,
+                                          result,
                                           _planType);
 
         _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), message);
     }
-
-    _finishTransaction(true);
 }
 
 void PlanManager::_handleMissionCount(const mavlink_message_t& message)
@@ -324,6 +506,20 @@ void PlanManager::_handleMissionCount(const mavlink_message_t& message)
         return;
     }
 
+    if (_expectedAck == AckWriteCheck) {
+        _checkForExpectedAck(AckWriteCheck);
+        if (missionCount.count == _writeMissionItems.count()) {
+            qCDebug(PlanManagerLog) << QStringLiteral("_handleMissionCount %1 vehicle already has the items, skipping write").arg(_planTypeString());
+            // Ends the read sequence which the request list started on the vehicle
+            _sendMissionAck(MAV_MISSION_ACCEPTED);
+            _finishTransaction(true);
+        } else {
+            qCDebug(PlanManagerLog) << QStringLiteral("_handleMissionCount %1 vehicle count changed, writing:").arg(_planTypeString()) << missionCount.count;
+            _writeMissionCount();
+        }
+        return;
+    }
+
     if (!_checkForExpectedAck(AckMissionCount)) {
         return;
     }
@@ -344,6 +540,8 @@ void PlanManager::_handleMissionCount(const mavlink_message_t& message)
     }
 }
 
+/// Requests items from the read list until the window of outstanding requests is full. With a window of one this is
+/// the strict stop-and-wait MISSION_REQUEST sequence.
 void PlanManager::_requestNextMissionItem(void)
 {
     if (_itemIndicesToRead.count() == 0) {
@@ -351,7 +549,20 @@ void PlanManager::_requestNextMissionItem(void)
         return;
     }
 
-    qCDebug(PlanManagerLog) << QStringLiteral("_requestNextMissionItem %1 sequenceNumber:retry").arg(_planTypeString()) << _itemIndicesToRead[0] << _retryCount;
+    int window = _vehicle->firmwarePlugin()->pipelinedMissionRead() ? _readWindow : 1;
+    for (int i=0; i<_itemIndicesToRead.count() && _outstandingReadRequests.count() < window; i++) {
+        int sequenceNumber = _itemIndicesToRead[i];
+        if (!_outstandingReadRequests.contains(sequenceNumber)) {
+            _outstandingReadRequests[sequenceNumber] = _readClock.nsecsElapsed();
+            _sendMissionRequest(sequenceNumber);
+        }
+    }
+    _startAckTimeout(AckMissionItem);
+}
+
+void PlanManager::_sendMissionRequest(int sequenceNumber)
+{
+    qCDebug(PlanManagerLog) << QStringLiteral("_sendMissionRequest %1 sequenceNumber:retry").arg(_planTypeString()) << sequenceNumber << _retryCount;
 
     WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
     if (!weakLink.expired()) {
@@ -365,7 +576,7 @@ void PlanManager::_requestNextMissionItem(void)
                                                       &message,
                                                       _vehicle->id(),
                                                       MAV_COMP_ID_AUTOPILOT1,
-                                                      _itemIndicesToRead[0],
+                                                      sequenceNumber,
                     _planType);
         } else {
             mavlink_msg_mission_request_pack_chan(qgcApp()->toolbox()->mavlinkProtocol()->getSystemId(),
@@ -374,13 +585,43 @@ void PlanManager::_requestNextMissionItem(void)
                                                   &message,
                                                   _vehicle->id(),
                                                   MAV_COMP_ID_AUTOPILOT1,
-                                                  _itemIndicesToRead[0],
+                                                  sequenceNumber,
                     _planType);
         }
 
         _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), message);
     }
-    _startAckTimeout(AckMissionItem);
+}
+
+/// Updates the round trip time estimates from a response to a request which was only sent once and then sizes the
+/// read timeout and the request window from them.
+///     timeout: twice the smoothed round trip time, never lower than the original fixed retry timeout
+///     window: grows by one per response up to one request per _readWindowRttMilliseconds of minimum round trip time.
+///             The minimum is used since responses to a full window queue up behind each other on the vehicle.
+void PlanManager::_updateReadRtt(qint64 requestNSecs)
+{
+    double rttMsecs = (_readClock.nsecsElapsed() - requestNSecs) / 1.0e6;
+
+    if (_readSmoothedRttMsecs < 0) {
+        _readSmoothedRttMsecs   = rttMsecs;
+        _readMinRttMsecs        = rttMsecs;
+    } else {
+        _readSmoothedRttMsecs   = (0.875 * _readSmoothedRttMsecs) + (0.125 * rttMsecs);
+        _readMinRttMsecs        = qMin(_readMinRttMsecs, rttMsecs);
+    }
+
+    int minTimeoutMsecs = _retryTimeoutMilliseconds;
+    int maxTimeoutMsecs = _maxReadTimeoutMilliseconds;
+    int maxWindow       = _maxReadWindow;
+
+    _readTimeoutMsecs = qBound(minTimeoutMsecs, static_cast<int>(2 * _readSmoothedRttMsecs), maxTimeoutMsecs);
+
+    int targetWindow = qMin(1 + static_cast<int>(_readMinRttMsecs / _readWindowRttMilliseconds), maxWindow);
+    if (_readWindow < targetWindow) {
+        _readWindow++;
+    } else {
+        _readWindow = targetWindow;
+    }
 }
 
 void PlanManager::_handleMissionItem(const mavlink_message_t& message, bool missionItemInt)
@@ -397,6 +638,7 @@ void PlanManager::_handleMissionItem(const mavlink_message_t& message, bool miss
     bool        autoContinue;
     bool        isCurrentItem;
     int         seq;
+    MAV_MISSION_TYPE missionType;
 
     if (missionItemInt) {
         mavlink_mission_item_int_t missionItem;
@@ -414,6 +656,7 @@ void PlanManager::_handleMissionItem(const mavlink_message_t& message, bool miss
         autoContinue =  missionItem.autocontinue;
         isCurrentItem = missionItem.current;
         seq =           missionItem.seq;
+        missionType =   static_cast<MAV_MISSION_TYPE>(missionItem.mission_type);
     } else {
         mavlink_mission_item_t missionItem;
         mavlink_msg_mission_item_decode(&message, &missionItem);
@@ -430,6 +673,13 @@ void PlanManager::_handleMissionItem(const mavlink_message_t& message, bool miss
         autoContinue =  missionItem.autocontinue;
         isCurrentItem = missionItem.current;
         seq =           missionItem.seq;
+        missionType =   static_cast<MAV_MISSION_TYPE>(missionItem.mission_type);
+    }
+
+    if (missionType != _planType) {
+        // Items for another plan type being read at the same time, or a stale message from a previous transaction
+        qCDebug(PlanManagerLog) << QStringLiteral("_handleMissionItem %1 Incorrect mission_type received expected:actual").arg(_planTypeString()) << _planType << missionType;
+        return;
     }
 
     // We don't support editing ALT_INT frames so change on the way in.
@@ -460,6 +710,12 @@ void PlanManager::_handleMissionItem(const mavlink_message_t& message, bool miss
     if (_itemIndicesToRead.contains(seq)) {
         _itemIndicesToRead.removeOne(seq);
 
+        qint64 requestNSecs = _outstandingReadRequests.value(seq, -1);
+        _outstandingReadRequests.remove(seq);
+        if (requestNSecs >= 0 && !_retriedReadRequests.contains(seq)) {
+            _updateReadRtt(requestNSecs);
+        }
+
         MissionItem* item = new MissionItem(seq,
                                             command,
                                             frame,
@@ -487,10 +743,12 @@ void PlanManager::_handleMissionItem(const mavlink_message_t& message, bool miss
         return;
     }
 
-    emit progressPct((double)seq / (double)_missionItemCountToRead);
+    emit progressPct((double)(_missionItemCountToRead - _itemIndicesToRead.count()) / (double)_missionItemCountToRead);
     
     _retryCount = 0;
     if (_itemIndicesToRead.count() == 0) {
+        // Pipelined reads can complete out of order
+        std::sort(_missionItems.begin(), _missionItems.end(), [](const MissionItem* a, const MissionItem* b) { return a->sequenceNumber() < b->sequenceNumber(); });
         _readTransactionComplete();
     } else {
         _requestNextMissionItem();
@@ -500,6 +758,8 @@ void PlanManager::_handleMissionItem(const mavlink_message_t& message, bool miss
 void PlanManager::_clearMissionItems(void)
 {
     _itemIndicesToRead.clear();
+    _outstandingReadRequests.clear();
+    _retriedReadRequests.clear();
     _clearAndDeleteMissionItems();
 }
 
@@ -671,6 +931,10 @@ void PlanManager::_handleMissionAck(const mavlink_message_t& message)
             _finishTransaction(false);
         }
         break;
+    case AckWriteCheck:
+        // Vehicle refused the request list, write the items instead
+        _writeMissionCount();
+        break;
     case AckMissionClearAll:
         // MAV_MISSION_ACCEPTED expected
         if (missionAck.type != MAV_MISSION_ACCEPTED) {
@@ -742,6 +1006,8 @@ QString PlanManager::_ackTypeToString(AckType_t ackType)
         return QString("MISSION_REQUEST");
     case AckGuidedItem:
         return QString("Guided Mode Item");
+    case AckWriteCheck:
+        return QString("MISSION_COUNT (write check)");
     default:
         qWarning(PlanManagerLog) << QStringLiteral("Fell off end of switch statement %1").arg(_planTypeString());
         return QString("QGC Internal Error");
@@ -879,6 +1145,7 @@ void PlanManager::_finishTransaction(bool success, bool apmGuidedItemWrite)
             // Read from vehicle failed, clear partial list
             _clearAndDeleteMissionItems();
         }
+        _setVehicleItemsKnown(success);
         emit newMissionItemsAvailable(false);
         break;
     case TransactionWrite:
@@ -901,10 +1168,12 @@ void PlanManager::_finishTransaction(bool success, bool apmGuidedItemWrite)
                 // Write failed, throw out the write list
                 _clearAndDeleteWriteMissionItems();
             }
+            _setVehicleItemsKnown(success);
             emit sendComplete(!success /* error */);
         }
         break;
     case TransactionRemoveAll:
+        _setVehicleItemsKnown(success);
         emit removeAllComplete(!success /* error */);
         break;
     default:
@@ -921,6 +1190,36 @@ void PlanManager::_finishTransaction(bool success, bool apmGuidedItemWrite)
     }
 }
 
+void PlanManager::_setVehicleItemsKnown(bool known)
+{
+    _vehicleItemsKnown  = known;
+    _vehicleItemsCrc    = known ? itemsCrc(_missionItems) : 0;
+}
+
+quint32 PlanManager::itemsCrc(const QList<MissionItem*>& items)
+{
+    quint32 crc = 0;
+
+    for (const MissionItem* item: items) {
+        // Same values as MISSION_ITEM_INT, positions compared in 1e-7 degrees
+        const bool  positionAsFloat = item->frame() == MAV_FRAME_MISSION;
+        const float params[]        = { static_cast<float>(item->param1()), static_cast<float>(item->param2()),
+                                        static_cast<float>(item->param3()), static_cast<float>(item->param4()),
+                                        positionAsFloat ? static_cast<float>(item->param5()) : 0.0f,
+                                        positionAsFloat ? static_cast<float>(item->param6()) : 0.0f,
+                                        static_cast<float>(item->param7()) };
+        const qint32 position[]     = { positionAsFloat ? 0 : static_cast<qint32>(qRound64(item->param5() * 1e7)),
+                                        positionAsFloat ? 0 : static_cast<qint32>(qRound64(item->param6() * 1e7)) };
+        const quint16 info[]        = { static_cast<quint16>(item->command()), static_cast<quint16>(item->frame()), static_cast<quint16>(item->autoContinue()) };
+
+        crc = QGC::crc32(reinterpret_cast<const quint8*>(params),   sizeof(params),     crc);
+        crc = QGC::crc32(reinterpret_cast<const quint8*>(position), sizeof(position),   crc);
+        crc = QGC::crc32(reinterpret_cast<const quint8*>(info),     sizeof(info),       crc);
+    }
+
+    return crc;
+}
+
 bool PlanManager::inProgress(void) const
 {
     return _transactionInProgress != TransactionNone;
@@ -11,15 +11,19 @@
 
 #include <QObject>
 #include <QLoggingCategory>
-#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
 
 #include "MissionItem.h"
 #include "QGCMAVLink.h"
 #include "QGCLoggingCategory.h"
 #include "LinkInterface.h"
+#include "QGCTimerWheel.h"
 
 class Vehicle;
 class MissionCommandTree;
+class QTemporaryDir;
 
 Q_DECLARE_LOGGING_CATEGORY(PlanManagerLog)
 
@@ -42,6 +46,9 @@ public:
     /// Last current mission item reported while in Mission flight mode
     int lastCurrentIndex(void) const { return _lastCurrentIndex; }
 
+    /// Number of item requests the last read kept outstanding when it finished, for unit testing
+    int readWindow(void) const { return _readWindow; }
+
     /// Load the mission items from the vehicle
     ///     Signals newMissionItemsAvailable when done
     void loadFromVehicle(void);
@@ -56,6 +63,9 @@ public:
     ///     Signals removeAllComplete when done
     void removeAll(void);
 
+    /// @return CRC32 of the items as they go out over MAVLink, so items read back from the vehicle match the items which were written
+    static quint32 itemsCrc(const QList<MissionItem*>& items);
+
     /// Error codes returned in error signal
     typedef enum {
         InternalError,
@@ -75,6 +85,14 @@ public:
     // When actively retrying to request mission items, use a shorter timeout instead.
     static const int _retryTimeoutMilliseconds = 250;
     static const int _maxRetryCount = 5;
+    // Read timeout backs off up to this while no round trip time can be measured
+    static const int _maxReadTimeoutMilliseconds = _ackTimeoutMilliseconds * 2;
+    // Pipelined reads keep one additional item request outstanding for each this much round trip time
+    static const int _readWindowRttMilliseconds = 50;
+    static const int _maxReadWindow = 16;
+    // MAVLink FTP plan files: header of magic, plan type, options, start and item count followed by packed mavlink_mission_item_int_t
+    static const uint16_t   _ftpPlanFileMagic       = 0x763d;
+    static const int        _ftpPlanFileHeaderSize  = 5 * sizeof(uint16_t);
 
 signals:
     void newMissionItemsAvailable   (bool removeAllRequested);
@@ -91,6 +109,8 @@ signals:
 private slots:
     void _mavlinkMessageReceived(const mavlink_message_t& message);
     void _ackTimeout(void);
+    void _ftpReadComplete       (const QString& file, const QString& errorMsg);
+    void _ftpReadProgress       (int value);
 
 protected:
     typedef enum {
@@ -100,6 +120,7 @@ protected:
         AckMissionRequest,  ///< MISSION_REQUEST is expected, or MISSION_ACK to end sequence
         AckMissionClearAll, ///< MISSION_CLEAR_ALL sent, MISSION_ACK is expected
         AckGuidedItem,      ///< MISSION_ACK expected in response to ArduPilot guided mode single item send
+        AckWriteCheck,      ///< MISSION_COUNT expected, tells whether a write would change anything on the vehicle
     } AckType_t;
 
     typedef enum {
@@ -117,12 +138,18 @@ protected:
     void _handleMissionRequest(const mavlink_message_t& message, bool missionItemInt);
     void _handleMissionAck(const mavlink_message_t& message);
     void _requestNextMissionItem(void);
+    void _sendMissionRequest(int sequenceNumber);
+    bool _ftpReadBegin(void);
+    bool _loadFtpPlanFile(const QString& filename);
+    void _updateReadRtt(qint64 requestNSecs);
     void _clearMissionItems(void);
     void _sendError(ErrorCode_t errorCode, const QString& errorMsg);
     QString _ackTypeToString(AckType_t ackType);
     QString _missionResultToString(MAV_MISSION_RESULT result);
     void _finishTransaction(bool success, bool apmGuidedItemWrite = false);
     void _requestList(void);
+    void _sendRequestList(void);
+    void _sendMissionAck(MAV_MISSION_RESULT result);
     void _writeMissionCount(void);
     void _writeMissionItemsWorker(void);
     void _clearAndDeleteMissionItems(void);
@@ -138,7 +165,7 @@ protected:
     MissionCommandTree* _missionCommandTree =   nullptr;
     MAV_MISSION_TYPE    _planType;
 
-    QTimer*             _ackTimeoutTimer =      nullptr;
+    QGCWheelTimer*      _ackTimeoutTimer =      nullptr;
     AckType_t           _expectedAck;
     int                 _retryCount;
 
@@ -149,11 +176,25 @@ protected:
     int                 _lastMissionRequest;    ///< Index of item last requested by MISSION_REQUEST
     int                 _missionItemCountToRead;///< Count of all mission items to read
 
+    // Pipelined read state. With a window of one the read is strictly stop-and-wait.
+    QHash<int, qint64>  _outstandingReadRequests;   ///< Item requests waiting for a response, mapped to the time they were sent
+    QSet<int>           _retriedReadRequests;       ///< Items requested more than once, these don't produce round trip time samples
+    QElapsedTimer       _readClock;
+    double              _readSmoothedRttMsecs;      ///< -1 until the first sample
+    double              _readMinRttMsecs;           ///< -1 until the first sample
+    int                 _readTimeoutMsecs;
+    int                 _readWindow;
+
+    QTemporaryDir*      _ftpReadDir =           nullptr;    ///< Download location while the plan is being read over MAVLink FTP
+
     QList<MissionItem*> _missionItems;          ///< Set of mission items on vehicle
     QList<MissionItem*> _writeMissionItems;     ///< Set of mission items currently being written to vehicle
+    bool                _vehicleItemsKnown =    false;  ///< true: _missionItems are what the vehicle has, as of the last transaction
+    quint32             _vehicleItemsCrc =      0;      ///< itemsCrc of _missionItems when _vehicleItemsKnown
     int                 _currentMissionIndex;
     int                 _lastCurrentIndex;
 
 private:
     void _setTransactionInProgress(TransactionType_t type);
+    void _setVehicleItemsKnown(bool known);
 };
@@ -15,7 +15,7 @@
 #include "AppSettings.h"
 #include "JsonHelper.h"
 #include "MissionManager.h"
-#include "KMLPlanDomDocument.h"
+#include "KMLPlanDocument.h"
 #include "SurveyPlanCreator.h"
 #include "StructureScanPlanCreator.h"
 #include "CorridorScanPlanCreator.h"
@@ -24,9 +24,12 @@
 #include "AirspaceFlightPlanProvider.h"
 #endif
 
-#include <QDomDocument>
 #include <QJsonDocument>
 #include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QSettings>
+#include <QtConcurrent>
 
 QGC_LOGGING_CATEGORY(PlanMasterControllerLog, "PlanMasterControllerLog")
 
@@ -44,6 +47,7 @@ PlanMasterController::PlanMasterController(QObject* parent)
     , _missionController    (this)
     , _geoFenceController   (this)
     , _rallyPointController (this)
+    , _undoStack            (&_missionController, &_geoFenceController, &_rallyPointController)
 {
     _commonInit();
 }
@@ -57,6 +61,7 @@ PlanMasterController::PlanMasterController(MAV_AUTOPILOT firmwareType, MAV_TYPE
     , _missionController    (this)
     , _geoFenceController   (this)
     , _rallyPointController (this)
+    , _undoStack            (&_missionController, &_geoFenceController, &_rallyPointController)
 {
     _commonInit();
 }
@@ -76,6 +81,15 @@ void PlanMasterController::_commonInit(void)
     connect(&_geoFenceController,   &GeoFenceController::syncInProgressChanged,     this, &PlanMasterController::syncInProgressChanged);
     connect(&_rallyPointController, &RallyPointController::syncInProgressChanged,   this, &PlanMasterController::syncInProgressChanged);
 
+    connect(&_kmlSaveWatcher,       &QFutureWatcher<QString>::finished,             this, &PlanMasterController::_kmlSaveFinished);
+    connect(&_planSaveWatcher,      &QFutureWatcher<QString>::finished,             this, &PlanMasterController::_planSaveFinished);
+    connect(&_planLoadWatcher,      &QFutureWatcher<PlanFileRead_t>::finished,      this, &PlanMasterController::_planLoadFinished);
+    connect(&_autosaveTimer,        &QTimer::timeout,                               this, &PlanMasterController::_autosave);
+    connect(&_autosaveWatcher,      &QFutureWatcher<QString>::finished,             this, &PlanMasterController::_autosaveFinished);
+
+    // Rally points are the last to come in when the plan is loaded from the vehicle
+    connect(&_rallyPointController, &RallyPointController::loadComplete,            &_undoStack, &PlanUndoStack::reset);
+
     // Offline vehicle can change firmware/vehicle type
     connect(_controllerVehicle,     &Vehicle::vehicleTypeChanged,                   this, &PlanMasterController::_updatePlanCreatorsList);
 }
@@ -83,7 +97,11 @@ void PlanMasterController::_commonInit(void)
 
 PlanMasterController::~PlanMasterController()
 {
-
+    // The writers only hold their own copy of the plan, but the files must be complete before we go away
+    _kmlSaveWatcher.waitForFinished();
+    _planSaveWatcher.waitForFinished();
+    _autosaveWatcher.waitForFinished();
+    _planLoadWatcher.waitForFinished();
 }
 
 void PlanMasterController::start(void)
@@ -97,6 +115,13 @@ void PlanMasterController::start(void)
 
     _updatePlanCreatorsList();
 
+    if (!_flyView) {
+        _autosaveAvailable = QFile::exists(autosaveFile());
+        emit autosaveAvailableChanged();
+        _autosaveTimer.start(_autosaveIntervalMSecs);
+        _undoStack.start();
+    }
+
 #if defined(QGC_AIRMAP_ENABLED)
     //-- This assumes there is one single instance of PlanMasterController in edit mode.
     if(!flyView) {
@@ -267,6 +292,7 @@ void PlanMasterController::_loadGeoFenceComplete(void)
         } else {
             qCDebug(PlanMasterControllerLog) << "PlanMasterController::_loadMissionComplete Rally Points not supported skipping";
             _rallyPointController.removeAll();
+            _undoStack.reset();
             _loadRallyPointsComplete();
         }
         setDirty(false);
@@ -359,13 +385,27 @@ void PlanMasterController::loadFromFile(const QString& filename)
     if (filename.isEmpty()) {
         return;
     }
+    if (planFileInProgress()) {
+        qgcApp()->showAppMessage(errorMessage.arg(tr("Previous plan file save or load is still in progress")));
+        return;
+    }
 
     QFileInfo fileInfo(filename);
+    if (fileInfo.suffix() != AppSettings::missionFileExtension &&
+            fileInfo.suffix() != AppSettings::waypointsFileExtension && fileInfo.suffix() != QStringLiteral("txt")) {
+        // Reading and parsing the json is done by the worker, the plan itself can only be built on this thread
+        _planLoadFilename = filename;
+        _planLoadWatcher.setFuture(QtConcurrent::run(&PlanMasterController::_readPlanFile, filename));
+        emit planFileInProgressChanged();
+        return;
+    }
+
     QFile file(filename);
 
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         errorString = file.errorString() + QStringLiteral(" ") + filename;
         qgcApp()->showAppMessage(errorMessage.arg(errorString));
+        emit loadFromFileComplete();
         return;
     }
 
@@ -376,53 +416,99 @@ void PlanMasterController::loadFromFile(const QString& filename)
         } else {
             success = true;
         }
-    } else if (fileInfo.suffix() == AppSettings::waypointsFileExtension || fileInfo.suffix() == QStringLiteral("txt")) {
+    } else {
         if (!_missionController.loadTextFile(file, errorString)) {
             qgcApp()->showAppMessage(errorMessage.arg(errorString));
         } else {
             success = true;
         }
-    } else {
-        QJsonDocument   jsonDoc;
-        QByteArray      bytes = file.readAll();
+    }
 
-        if (!JsonHelper::isJsonFile(bytes, jsonDoc, errorString)) {
-            qgcApp()->showAppMessage(errorMessage.arg(errorString));
-            return;
-        }
+    _setLoadedPlanFile(filename, success);
+}
 
-        QJsonObject json = jsonDoc.object();
-        //-- Allow plugins to pre process the load
-        qgcApp()->toolbox()->corePlugin()->preLoadFromJson(this, json);
+PlanMasterController::PlanFileRead_t PlanMasterController::_readPlanFile(const QString& filename)
+{
+    PlanFileRead_t  planFileRead;
+    QFile           file(filename);
 
-        int version;
-        if (!JsonHelper::validateExternalQGCJsonFile(json, kPlanFileType, kPlanFileVersion, kPlanFileVersion, version, errorString)) {
-            qgcApp()->showAppMessage(errorMessage.arg(errorString));
-            return;
-        }
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        planFileRead.errorString = file.errorString() + QStringLiteral(" ") + filename;
+        return planFileRead;
+    }
+    JsonHelper::isJsonFile(file.readAll(), planFileRead.jsonDoc, planFileRead.errorString);
 
-        QList<JsonHelper::KeyValidateInfo> rgKeyInfo = {
-            { kJsonMissionObjectKey,        QJsonValue::Object, true },
-            { kJsonGeoFenceObjectKey,       QJsonValue::Object, true },
-            { kJsonRallyPointsObjectKey,    QJsonValue::Object, true },
-        };
-        if (!JsonHelper::validateKeys(json, rgKeyInfo, errorString)) {
-            qgcApp()->showAppMessage(errorMessage.arg(errorString));
-            return;
-        }
+    return planFileRead;
+}
 
-        if (!_missionController.load(json[kJsonMissionObjectKey].toObject(), errorString) ||
-                !_geoFenceController.load(json[kJsonGeoFenceObjectKey].toObject(), errorString) ||
-                !_rallyPointController.load(json[kJsonRallyPointsObjectKey].toObject(), errorString)) {
-            qgcApp()->showAppMessage(errorMessage.arg(errorString));
-        } else {
-            //-- Allow plugins to post process the load
-            qgcApp()->toolbox()->corePlugin()->postLoadFromJson(this, json);
-            success = true;
-        }
+void PlanMasterController::_planLoadFinished(void)
+{
+    PlanFileRead_t  planFileRead    = _planLoadWatcher.result();
+    QString         filename        = _planLoadFilename;
+    QString         errorString     = planFileRead.errorString;
+    QString         errorMessage    = tr("Error loading Plan file (%1). %2").arg(filename).arg("%1");
+
+    _planLoadFilename.clear();
+    emit planFileInProgressChanged();
+
+    if (!errorString.isEmpty()) {
+        // Nothing was loaded, the current plan stays as is
+        qgcApp()->showAppMessage(errorMessage.arg(errorString));
+        emit loadFromFileComplete();
+        return;
+    }
+
+    bool success = _loadPlanJson(planFileRead.jsonDoc.object(), errorString);
+    if (!success) {
+        qgcApp()->showAppMessage(errorMessage.arg(errorString));
+    }
+
+    _setLoadedPlanFile(filename, success);
+}
+
+bool PlanMasterController::_loadPlanJson(QJsonObject json, QString& errorString)
+{
+    //-- Allow plugins to pre process the load
+    qgcApp()->toolbox()->corePlugin()->preLoadFromJson(this, json);
+
+    int version;
+    if (!JsonHelper::validateExternalQGCJsonFile(json, kPlanFileType, kPlanFileVersion, kPlanFileVersion, version, errorString)) {
+        return false;
     }
 
-    if(success){
+    QList<JsonHelper::KeyValidateInfo> rgKeyInfo = {
+        { kJsonMissionObjectKey,        QJsonValue::Object, true },
+        { kJsonGeoFenceObjectKey,       QJsonValue::Object, true },
+        { kJsonRallyPointsObjectKey,    QJsonValue::Object, true },
+    };
+    if (!JsonHelper::validateKeys(json, rgKeyInfo, errorString)) {
+        return false;
+    }
+
+    if (!_missionController.load(json[kJsonMissionObjectKey].toObject(), errorString) ||
+            !_geoFenceController.load(json[kJsonGeoFenceObjectKey].toObject(), errorString) ||
+            !_rallyPointController.load(json[kJsonRallyPointsObjectKey].toObject(), errorString)) {
+        return false;
+    }
+
+    //-- Allow plugins to post process the load
+    qgcApp()->toolbox()->corePlugin()->postLoadFromJson(this, json);
+    return true;
+}
+
+void PlanMasterController::_setLoadedPlanFile(const QString& filename, bool success)
+{
+    QFileInfo fileInfo(filename);
+
+    if (success && filename == autosaveFile()) {
+        // A restored autosave was never saved by the user, so there is no plan file to save it back to
+        _currentPlanFile.clear();
+        setDirty(true);
+        if (_autosaveAvailable) {
+            _autosaveAvailable = false;
+            emit autosaveAvailableChanged();
+        }
+    } else if(success){
         _currentPlanFile = QString::asprintf("%s/%s.%s", fileInfo.path().toLocal8Bit().data(), fileInfo.completeBaseName().toLocal8Bit().data(), AppSettings::planFileExtension);
     } else {
         _currentPlanFile.clear();
@@ -432,6 +518,9 @@ void PlanMasterController::loadFromFile(const QString& filename)
     if (!offline()) {
         setDirty(true);
     }
+
+    _undoStack.reset();
+    emit loadFromFileComplete();
 }
 
 QJsonDocument PlanMasterController::saveToJson()
@@ -469,25 +558,25 @@ void PlanMasterController::saveToFile(const QString& filename)
     if (filename.isEmpty()) {
         return;
     }
+    if (planFileInProgress()) {
+        qgcApp()->showAppMessage(tr("Plan save error %1 : %2").arg(filename).arg(tr("Previous plan file save or load is still in progress")));
+        return;
+    }
 
     QString planFilename = filename;
     if (!QFileInfo(filename).fileName().contains(".")) {
         planFilename += QString(".%1").arg(fileExtension());
     }
 
-    QFile file(planFilename);
+    // The json is a snapshot of the plan as it is now, further edits don't change what the worker writes
+    QJsonDocument saveDoc = saveToJson();
+    _planSaveFilename = planFilename;
+    _planSaveWatcher.setFuture(QtConcurrent::run(&PlanMasterController::_writePlanFile, saveDoc, planFilename));
+    emit planFileInProgressChanged();
 
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qgcApp()->showAppMessage(tr("Plan save error %1 : %2").arg(filename).arg(file.errorString()));
-        _currentPlanFile.clear();
+    if(_currentPlanFile != planFilename) {
+        _currentPlanFile = planFilename;
         emit currentPlanFileChanged();
-    } else {
-        QJsonDocument saveDoc = saveToJson();
-        file.write(saveDoc.toJson());
-        if(_currentPlanFile != planFilename) {
-            _currentPlanFile = planFilename;
-            emit currentPlanFileChanged();
-        }
     }
 
     // Only clear dirty bit if we are offline
@@ -496,28 +585,154 @@ void PlanMasterController::saveToFile(const QString& filename)
     }
 }
 
-void PlanMasterController::saveToKml(const QString& filename)
+void PlanMasterController::_planSaveFinished(void)
+{
+    QString errorString = _planSaveWatcher.result();
+    QString filename    = _planSaveFilename;
+
+    _planSaveFilename.clear();
+    emit planFileInProgressChanged();
+
+    if (!errorString.isEmpty()) {
+        qgcApp()->showAppMessage(tr("Plan save error %1 : %2").arg(filename).arg(errorString));
+        if (_currentPlanFile == filename) {
+            _currentPlanFile.clear();
+            emit currentPlanFileChanged();
+        }
+        // The changes are still only in memory
+        setDirty(true);
+        return;
+    }
+
+    if (!_flyView && !_autosaveAvailable) {
+        // The plan is safe in its own file now. An autosave left by an earlier session is kept until it is restored or replaced.
+        // An autosave started before the save is older than the saved file, it is removed once it is written instead of
+        // being committed after the removal.
+        if (_autosaveWatcher.isRunning()) {
+            _discardAutosaveWhenWritten = true;
+        } else {
+            discardAutosave();
+        }
+    }
+}
+
+QString PlanMasterController::_writePlanFile(const QJsonDocument& jsonDoc, const QString& filename)
+{
+    // Written to a temporary file which replaces the old one once complete, so a crash never leaves half a plan behind
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return file.errorString();
+    }
+    file.write(jsonDoc.toJson());
+    if (!file.commit()) {
+        return file.errorString();
+    }
+    return QString();
+}
+
+QString PlanMasterController::autosaveFile(void)
+{
+    return QFileInfo(QSettings().fileName()).dir().absoluteFilePath(QStringLiteral("PlanAutosave.%1").arg(AppSettings::planFileExtension));
+}
+
+void PlanMasterController::_autosave(void)
+{
+    if (!dirty() || isEmpty() || _autosaveWatcher.isRunning() || planFileInProgress() || syncInProgress()) {
+        return;
+    }
+
+    // Only changes since the last autosave are written
+    QJsonDocument saveDoc = saveToJson();
+    if (saveDoc == _lastAutosaveDoc) {
+        return;
+    }
+    _lastAutosaveDoc = saveDoc;
+
+    if (_autosaveAvailable) {
+        // Editing went on without restoring, the autosave of the earlier session is replaced
+        _autosaveAvailable = false;
+        emit autosaveAvailableChanged();
+    }
+
+    // This write replaces anything still pending from before the last save
+    _discardAutosaveWhenWritten = false;
+
+    QString filename = autosaveFile();
+    qCDebug(PlanMasterControllerLog) << "Autosave" << filename;
+    QDir().mkpath(QFileInfo(filename).absolutePath());
+    _autosaveWatcher.setFuture(QtConcurrent::run(&PlanMasterController::_writePlanFile, saveDoc, filename));
+}
+
+void PlanMasterController::_autosaveFinished(void)
+{
+    QString errorString = _autosaveWatcher.result();
+    if (!errorString.isEmpty()) {
+        qCWarning(PlanMasterControllerLog) << "Autosave failed" << errorString;
+    }
+    if (_discardAutosaveWhenWritten) {
+        discardAutosave();
+    }
+}
+
+void PlanMasterController::loadFromAutosave(void)
+{
+    if (QFile::exists(autosaveFile())) {
+        loadFromFile(autosaveFile());
+    }
+}
+
+void PlanMasterController::discardAutosave(void)
+{
+    _autosaveWatcher.waitForFinished();
+    _discardAutosaveWhenWritten = false;
+    _lastAutosaveDoc = QJsonDocument();
+    QFile::remove(autosaveFile());
+    if (_autosaveAvailable) {
+        _autosaveAvailable = false;
+        emit autosaveAvailableChanged();
+    }
+}
+
+void PlanMasterController::saveToKml(const QString& filename, bool includeFlight, int latLonDecimals)
 {
     if (filename.isEmpty()) {
         return;
     }
+    if (kmlSaveInProgress()) {
+        qgcApp()->showAppMessage(tr("KML save error %1 : %2").arg(filename).arg(tr("Previous KML save is still in progress")));
+        return;
+    }
 
     QString kmlFilename = filename;
     if (!QFileInfo(filename).fileName().contains(".")) {
         kmlFilename += QString(".%1").arg(kmlFileExtension());
     }
 
-    QFile file(kmlFilename);
+    // The document is filled in here since the plan and vehicle can only be read from this thread. After that it is
+    // plain values, so the slow part of building and writing the xml is done by the worker.
+    KMLPlanDocument planKML;
+    planKML.setCoordinatePrecision(latLonDecimals, 2 /* altitudeDecimals */);
+    _missionController.addMissionToKML(planKML);
+    if (includeFlight && !_offline) {
+        planKML.addVehicleFlight(_managerVehicle);
+    }
 
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qgcApp()->showAppMessage(tr("KML save error %1 : %2").arg(filename).arg(file.errorString()));
-    } else {
-        KMLPlanDomDocument planKML;
-        _missionController.addMissionToKML(planKML);
-        QTextStream stream(&file);
-        stream << planKML.toString();
-        file.close();
+    _kmlSaveFilename = filename;
+    _kmlSaveWatcher.setFuture(QtConcurrent::run([planKML, kmlFilename]() {
+        QString errorString;
+        planKML.save(kmlFilename, errorString);
+        return errorString;
+    }));
+    emit kmlSaveInProgressChanged();
+}
+
+void PlanMasterController::_kmlSaveFinished(void)
+{
+    QString errorString = _kmlSaveWatcher.result();
+    if (!errorString.isEmpty()) {
+        qgcApp()->showAppMessage(tr("KML save error %1 : %2").arg(_kmlSaveFilename).arg(errorString));
     }
+    emit kmlSaveInProgressChanged();
 }
 
 void PlanMasterController::removeAll(void)
@@ -532,6 +747,7 @@ void PlanMasterController::removeAll(void)
         _currentPlanFile.clear();
         emit currentPlanFileChanged();
     }
+    _undoStack.reset();
 }
 
 void PlanMasterController::removeAllFromVehicle(void)
@@ -600,8 +816,8 @@ void PlanMasterController::sendPlanToVehicle(Vehicle* vehicle, const QString& fi
     // Use a transient PlanMasterController to accomplish this
     PlanMasterController* controller = new PlanMasterController();
     controller->startStaticActiveVehicle(vehicle, true /* deleteWhenSendCompleted */);
+    connect(controller, &PlanMasterController::loadFromFileComplete, controller, &PlanMasterController::sendToVehicle);
     controller->loadFromFile(filename);
-    controller->sendToVehicle();
 }
 
 void PlanMasterController::_showPlanFromManagerVehicle(void)
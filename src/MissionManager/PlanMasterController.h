@@ -10,6 +10,9 @@
 #pragma once
 
 #include <QObject>
+#include <QFutureWatcher>
+#include <QJsonDocument>
+#include <QTimer>
 
 #include "MissionController.h"
 #include "GeoFenceController.h"
@@ -18,6 +21,7 @@
 #include "MultiVehicleManager.h"
 #include "QGCLoggingCategory.h"
 #include "QmlObjectListModel.h"
+#include "PlanUndoStack.h"
 
 Q_DECLARE_LOGGING_CATEGORY(PlanMasterControllerLog)
 
@@ -51,6 +55,10 @@ public:
     Q_PROPERTY(QStringList              loadNameFilters         READ loadNameFilters                        CONSTANT)                       ///< File filter list loading plan files
     Q_PROPERTY(QStringList              saveNameFilters         READ saveNameFilters                        CONSTANT)                       ///< File filter list saving plan files
     Q_PROPERTY(QmlObjectListModel*      planCreators            MEMBER _planCreators                        NOTIFY planCreatorsChanged)
+    Q_PROPERTY(bool                     kmlSaveInProgress       READ kmlSaveInProgress                      NOTIFY kmlSaveInProgressChanged)
+    Q_PROPERTY(bool                     planFileInProgress      READ planFileInProgress                     NOTIFY planFileInProgressChanged)   ///< true: Plan file is being written or read by a worker thread
+    Q_PROPERTY(bool                     autosaveAvailable       READ autosaveAvailable                      NOTIFY autosaveAvailableChanged)    ///< true: Autosave from an earlier session which wasn't saved to a plan file
+    Q_PROPERTY(PlanUndoStack*           undoStack               READ undoStack                              CONSTANT)                       ///< Plan view only
 
     /// Should be called immediately upon Component.onCompleted.
     Q_INVOKABLE void start(void);
@@ -74,20 +82,33 @@ public:
 
     Q_INVOKABLE void loadFromVehicle(void);
     Q_INVOKABLE void sendToVehicle(void);
+    /// Plan files are read and parsed by a worker thread, loadFromFileComplete is signalled once the plan is loaded
     Q_INVOKABLE void loadFromFile(const QString& filename);
     Q_INVOKABLE void saveToCurrent();
+    /// The plan is captured right away, the file is written by a worker thread
     Q_INVOKABLE void saveToFile(const QString& filename);
-    Q_INVOKABLE void saveToKml(const QString& filename);
+    Q_INVOKABLE void loadFromAutosave(void);
+    Q_INVOKABLE void discardAutosave(void);
+
+    /// Saves the plan as KML. The file is written on a worker thread, kmlSaveInProgress is true until it is done.
+    ///     @param includeFlight    Also exports the flown track and camera trigger positions of the active vehicle
+    ///     @param latLonDecimals   Decimal places for coordinates, fewer make a smaller file
+    Q_INVOKABLE void saveToKml(const QString& filename, bool includeFlight = true, int latLonDecimals = 7);
+
     Q_INVOKABLE void removeAll(void);                       ///< Removes all from controller only, synce required to remove from vehicle
     Q_INVOKABLE void removeAllFromVehicle(void);            ///< Removes all from vehicle and controller
 
     MissionController*      missionController(void)     { return &_missionController; }
     GeoFenceController*     geoFenceController(void)    { return &_geoFenceController; }
     RallyPointController*   rallyPointController(void)  { return &_rallyPointController; }
+    PlanUndoStack*          undoStack(void)             { return &_undoStack; }
 
     bool        offline         (void) const { return _offline; }
     bool        containsItems   (void) const;
     bool        syncInProgress  (void) const;
+    bool        kmlSaveInProgress(void) const { return _kmlSaveWatcher.isRunning(); }
+    bool        planFileInProgress(void) const { return !_planSaveFilename.isEmpty() || !_planLoadFilename.isEmpty(); }
+    bool        autosaveAvailable(void) const { return _autosaveAvailable; }
     bool        dirty           (void) const;
     void        setDirty        (bool dirty);
     QString     fileExtension   (void) const;
@@ -104,6 +125,9 @@ public:
     Vehicle* controllerVehicle(void) { return _controllerVehicle; }
     Vehicle* managerVehicle(void) { return _managerVehicle; }
 
+    /// Plan view keeps the plan being edited here while it is dirty, so it can be restored after a crash
+    static QString autosaveFile(void);
+
     static const int    kPlanFileVersion;
     static const char*  kPlanFileType;
     static const char*  kJsonMissionObjectKey;
@@ -119,6 +143,10 @@ signals:
     void planCreatorsChanged                (QmlObjectListModel* planCreators);
     void managerVehicleChanged              (Vehicle* managerVehicle);
     void promptForPlanUsageOnVehicleChange  (void);
+    void kmlSaveInProgressChanged           (void);
+    void planFileInProgressChanged          (void);
+    void autosaveAvailableChanged           (void);
+    void loadFromFileComplete               (void);     ///< Also signalled when the load failed
 
 private slots:
     void _activeVehicleChanged      (Vehicle* activeVehicle);
@@ -129,6 +157,11 @@ private slots:
     void _sendGeoFenceComplete      (void);
     void _sendRallyPointsComplete   (void);
     void _updatePlanCreatorsList    (void);
+    void _kmlSaveFinished           (void);
+    void _planSaveFinished          (void);
+    void _planLoadFinished          (void);
+    void _autosave                  (void);
+    void _autosaveFinished          (void);
 #if defined(QGC_AIRMAP_ENABLED)
     void _startFlightPlanning       (void);
 #endif
@@ -136,6 +169,16 @@ private slots:
 private:
     void _commonInit                (void);
     void _showPlanFromManagerVehicle(void);
+    bool _loadPlanJson              (QJsonObject json, QString& errorString);
+    void _setLoadedPlanFile         (const QString& filename, bool success);
+
+    typedef struct {
+        QJsonDocument   jsonDoc;
+        QString         errorString;    ///< Empty on success
+    } PlanFileRead_t;
+
+    static PlanFileRead_t   _readPlanFile   (const QString& filename);
+    static QString          _writePlanFile  (const QJsonDocument& jsonDoc, const QString& filename);
 
     MultiVehicleManager*    _multiVehicleMgr =          nullptr;
     Vehicle*                _controllerVehicle =        nullptr;    ///< Offline controller vehicle
@@ -145,6 +188,7 @@ private:
     MissionController       _missionController;
     GeoFenceController      _geoFenceController;
     RallyPointController    _rallyPointController;
+    PlanUndoStack           _undoStack;
     bool                    _loadGeoFence =             false;
     bool                    _loadRallyPoints =          false;
     bool                    _sendGeoFence =             false;
@@ -152,4 +196,17 @@ private:
     QString                 _currentPlanFile;
     bool                    _deleteWhenSendCompleted =  false;
     QmlObjectListModel*     _planCreators =             nullptr;
+    QFutureWatcher<QString> _kmlSaveWatcher;                        ///< Result is the error string, empty on success
+    QString                 _kmlSaveFilename;
+    QFutureWatcher<QString> _planSaveWatcher;                       ///< Result is the error string, empty on success
+    QString                 _planSaveFilename;                      ///< Non-empty while a save is pending
+    QFutureWatcher<PlanFileRead_t> _planLoadWatcher;
+    QString                 _planLoadFilename;                      ///< Non-empty while a load is pending
+    QTimer                  _autosaveTimer;
+    QFutureWatcher<QString> _autosaveWatcher;
+    QJsonDocument           _lastAutosaveDoc;                       ///< Skips the write when nothing changed since the last autosave
+    bool                    _autosaveAvailable =        false;
+    bool                    _discardAutosaveWhenWritten = false;    ///< A save completed while an autosave was being written
+
+    static const int _autosaveIntervalMSecs = 30 * 1000;
 };
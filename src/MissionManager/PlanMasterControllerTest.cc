@@ -16,6 +16,9 @@
 #include "SettingsManager.h"
 #include "AppSettings.h"
 
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
 PlanMasterControllerTest::PlanMasterControllerTest(void)
     : _masterController(nullptr)
 {
@@ -51,3 +54,143 @@ void PlanMasterControllerTest::_testMissionPlannerFileLoad(void)
     _masterController->loadFromFile(":/unittest/MissionPlanner.waypoints");
     QCOMPARE(_masterController->missionController()->visualItems()->count(), 6);
 }
+
+void PlanMasterControllerTest::_testPlanFileSaveLoad(void)
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QString planFilename = tempDir.filePath(QStringLiteral("PlanMasterControllerTest.plan"));
+
+    _masterController->loadFromFile(":/unittest/MissionPlanner.waypoints");
+    QCOMPARE(_masterController->missionController()->visualItems()->count(), 6);
+
+    // The plan is captured right away, so emptying it while the file is written doesn't change what is saved
+    _masterController->saveToFile(planFilename);
+    QVERIFY(_masterController->planFileInProgress());
+    QCOMPARE(_masterController->currentPlanFile(), planFilename);
+    _masterController->removeAll();
+    QTRY_VERIFY(!_masterController->planFileInProgress());
+    QVERIFY(QFile::exists(planFilename));
+
+    QSignalSpy loadCompleteSpy(_masterController, &PlanMasterController::loadFromFileComplete);
+    _masterController->loadFromFile(planFilename);
+    QVERIFY(_masterController->planFileInProgress());
+    QVERIFY(loadCompleteSpy.wait());
+    QVERIFY(!_masterController->planFileInProgress());
+    QCOMPARE(_masterController->missionController()->visualItems()->count(), 6);
+    QCOMPARE(_masterController->currentPlanFile(), planFilename);
+}
+
+void PlanMasterControllerTest::_testAutosave(void)
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QString planFilename    = tempDir.filePath(QStringLiteral("PlanMasterControllerTest.plan"));
+    QString autosaveFile    = PlanMasterController::autosaveFile();
+
+    _masterController->discardAutosave();
+    _masterController->loadFromFile(":/unittest/MissionPlanner.waypoints");
+
+    // Nothing to keep while the plan isn't dirty
+    _masterController->setDirty(false);
+    QVERIFY(QMetaObject::invokeMethod(_masterController, "_autosave"));
+    QTest::qWait(100);
+    QVERIFY(!QFile::exists(autosaveFile));
+
+    _masterController->setDirty(true);
+    QVERIFY(QMetaObject::invokeMethod(_masterController, "_autosave"));
+    QTRY_VERIFY(QFile::exists(autosaveFile));
+
+    // A fresh controller offers the autosave, restoring it leaves the plan dirty without a plan file
+    PlanMasterController restoreController;
+    restoreController.setFlyView(false);
+    restoreController.start();
+    QVERIFY(restoreController.autosaveAvailable());
+    QSignalSpy loadCompleteSpy(&restoreController, &PlanMasterController::loadFromFileComplete);
+    restoreController.loadFromAutosave();
+    QVERIFY(loadCompleteSpy.wait());
+    QCOMPARE(restoreController.missionController()->visualItems()->count(), 6);
+    QVERIFY(restoreController.dirty());
+    QVERIFY(restoreController.currentPlanFile().isEmpty());
+    QVERIFY(!restoreController.autosaveAvailable());
+
+    // Saving to a plan file makes the autosave obsolete
+    _masterController->saveToFile(planFilename);
+    QTRY_VERIFY(!_masterController->planFileInProgress());
+    QVERIFY(!QFile::exists(autosaveFile));
+}
+
+void PlanMasterControllerTest::_testAutosaveDuringSave(void)
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QString planFilename    = tempDir.filePath(QStringLiteral("PlanMasterControllerTest.plan"));
+    QString autosaveFile    = PlanMasterController::autosaveFile();
+
+    _masterController->discardAutosave();
+    _masterController->loadFromFile(":/unittest/MissionPlanner.waypoints");
+    _masterController->setDirty(true);
+
+    // The autosave is still being written when the save starts, it mustn't be left behind once both are done
+    QVERIFY(QMetaObject::invokeMethod(_masterController, "_autosave"));
+    _masterController->saveToFile(planFilename);
+    QTRY_VERIFY(!_masterController->planFileInProgress());
+    QTRY_VERIFY(!QFile::exists(autosaveFile));
+    QTest::qWait(100);
+    QVERIFY(!QFile::exists(autosaveFile));
+    QVERIFY(QFile::exists(planFilename));
+}
+
+void PlanMasterControllerTest::_testUndoRedo(void)
+{
+    MissionController*  missionController   = _masterController->missionController();
+    PlanUndoStack*      undoStack           = _masterController->undoStack();
+    QGeoCoordinate      coordinate1(47.3977, 8.5456, 50);
+    QGeoCoordinate      coordinate2(47.3987, 8.5466, 50);
+
+    QCOMPARE(undoStack->snapshotCount(), 1);
+    QVERIFY(!undoStack->canUndo());
+    QVERIFY(!undoStack->canRedo());
+
+    missionController->insertSimpleMissionItem(coordinate1, missionController->visualItems()->count());
+    undoStack->takeSnapshot();
+    missionController->insertSimpleMissionItem(coordinate2, missionController->visualItems()->count());
+    undoStack->takeSnapshot();
+    QCOMPARE(missionController->visualItems()->count(), 3);
+    QCOMPARE(undoStack->snapshotCount(), 3);
+
+    // Nothing changed since the last snapshot
+    undoStack->takeSnapshot();
+    QCOMPARE(undoStack->snapshotCount(), 3);
+
+    undoStack->undo();
+    QCOMPARE(missionController->visualItems()->count(), 2);
+    QVERIFY(_masterController->dirty());
+    undoStack->undo();
+    QCOMPARE(missionController->visualItems()->count(), 1);
+    QVERIFY(!undoStack->canUndo());
+    QVERIFY(undoStack->canRedo());
+
+    undoStack->redo();
+    undoStack->redo();
+    QCOMPARE(missionController->visualItems()->count(), 3);
+    QCOMPARE(missionController->visualItems()->value<VisualMissionItem*>(2)->coordinate().latitude(),   coordinate2.latitude());
+    QCOMPARE(missionController->visualItems()->value<VisualMissionItem*>(2)->coordinate().longitude(),  coordinate2.longitude());
+    QVERIFY(!undoStack->canRedo());
+
+    // An edit which hasn't been snapshotted yet is undone as well, and drops what could have been redone
+    undoStack->undo();
+    missionController->insertSimpleMissionItem(coordinate1, missionController->visualItems()->count());
+    QVERIFY(undoStack->canUndo());
+    undoStack->undo();
+    QCOMPARE(missionController->visualItems()->count(), 2);
+    QVERIFY(undoStack->canRedo());
+    missionController->insertSimpleMissionItem(coordinate2, missionController->visualItems()->count());
+    undoStack->takeSnapshot();
+    QVERIFY(!undoStack->canRedo());
+
+    // A new plan is where undo stops
+    _masterController->removeAll();
+    QCOMPARE(undoStack->snapshotCount(), 1);
+    QVERIFY(!undoStack->canUndo());
+}
@@ -33,6 +33,10 @@ private slots:
 
     void _testMissionFileLoad(void);
     void _testMissionPlannerFileLoad(void);
+    void _testPlanFileSaveLoad(void);
+    void _testAutosave(void);
+    void _testAutosaveDuringSave(void);
+    void _testUndoRedo(void);
 
 private:
     PlanMasterController*   _masterController;
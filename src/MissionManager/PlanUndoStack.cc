@@ -0,0 +1,221 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "PlanUndoStack.h"
+#include "MissionController.h"
+#include "GeoFenceController.h"
+#include "RallyPointController.h"
+#include "VisualMissionItem.h"
+#include "ComplexMissionItem.h"
+#include "QmlObjectListModel.h"
+#include "QGCApplication.h"
+
+QGC_LOGGING_CATEGORY(PlanUndoStackLog, "PlanUndoStackLog")
+
+PlanUndoStack::PlanUndoStack(MissionController* missionController, GeoFenceController* geoFenceController, RallyPointController* rallyPointController, QObject* parent)
+    : QObject               (parent)
+    , _missionController    (missionController)
+    , _geoFenceController   (geoFenceController)
+    , _rallyPointController (rallyPointController)
+{
+    _snapshotTimer.setSingleShot(true);
+    _snapshotTimer.setInterval(_snapshotDelayMSecs);
+    connect(&_snapshotTimer, &QTimer::timeout, this, &PlanUndoStack::takeSnapshot);
+}
+
+void PlanUndoStack::start(void)
+{
+    _started = true;
+
+    connect(_missionController,                 &MissionController::visualItemsChanged,         this, &PlanUndoStack::_visualItemsChanged);
+    connect(_missionController,                 &MissionController::globalAltitudeModeChanged,  this, &PlanUndoStack::_scheduleSnapshot);
+    connect(_geoFenceController,                &GeoFenceController::dirtyChanged,              this, &PlanUndoStack::_scheduleSnapshot);
+    connect(_geoFenceController,                &GeoFenceController::breachReturnPointChanged,  this, &PlanUndoStack::_scheduleSnapshot);
+    connect(_geoFenceController->polygons(),    &QmlObjectListModel::countChanged,              this, &PlanUndoStack::_scheduleSnapshot);
+    connect(_geoFenceController->circles(),     &QmlObjectListModel::countChanged,              this, &PlanUndoStack::_scheduleSnapshot);
+    connect(_rallyPointController,              &RallyPointController::dirtyChanged,            this, &PlanUndoStack::_scheduleSnapshot);
+    connect(_rallyPointController->points(),    &QmlObjectListModel::countChanged,              this, &PlanUndoStack::_scheduleSnapshot);
+
+    _visualItemsChanged();
+    reset();
+}
+
+void PlanUndoStack::reset(void)
+{
+    if (!_started) {
+        return;
+    }
+    _snapshots.clear();
+    _index = -1;
+    takeSnapshot();
+}
+
+void PlanUndoStack::_scheduleSnapshot(void)
+{
+    if (!_started || _restoring) {
+        return;
+    }
+    bool pending = _snapshotTimer.isActive();
+    _snapshotTimer.start();
+    if (!pending) {
+        emit canUndoRedoChanged();
+    }
+}
+
+void PlanUndoStack::_visualItemsChanged(void)
+{
+    connect(_missionController->visualItems(), &QmlObjectListModel::countChanged, this, &PlanUndoStack::_visualItemsCountChanged, Qt::UniqueConnection);
+    _visualItemsCountChanged();
+}
+
+void PlanUndoStack::_visualItemsCountChanged(void)
+{
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+    for (int i=0; i<visualItems->count(); i++) {
+        _connectItem(visualItems->value<VisualMissionItem*>(i));
+    }
+    _scheduleSnapshot();
+}
+
+void PlanUndoStack::_connectItem(VisualMissionItem* item)
+{
+    // Any change to a clean item makes it dirty, which is what drops its json from the cache
+    connect(item, &VisualMissionItem::dirtyChanged,                 this, &PlanUndoStack::_itemChanged,         Qt::UniqueConnection);
+    connect(item, &VisualMissionItem::sequenceNumberChanged,        this, &PlanUndoStack::_itemChanged,         Qt::UniqueConnection);
+    connect(item, &VisualMissionItem::coordinateChanged,            this, &PlanUndoStack::_scheduleSnapshot,    Qt::UniqueConnection);
+    connect(item, &VisualMissionItem::lastSequenceNumberChanged,    this, &PlanUndoStack::_scheduleSnapshot,    Qt::UniqueConnection);
+    connect(item, &QObject::destroyed,                              this, &PlanUndoStack::_itemDestroyed,       Qt::UniqueConnection);
+
+    ComplexMissionItem* complexItem = qobject_cast<ComplexMissionItem*>(item);
+    if (complexItem) {
+        connect(complexItem, &ComplexMissionItem::complexDistanceChanged, this, &PlanUndoStack::_scheduleSnapshot, Qt::UniqueConnection);
+    }
+}
+
+void PlanUndoStack::_itemChanged(void)
+{
+    _itemJsonCache.remove(qobject_cast<VisualMissionItem*>(sender()));
+    _scheduleSnapshot();
+}
+
+void PlanUndoStack::_itemDestroyed(QObject* object)
+{
+    // Already down to a QObject, only the pointer value is used
+    _itemJsonCache.remove(static_cast<VisualMissionItem*>(object));
+}
+
+QJsonArray PlanUndoStack::_itemJson(VisualMissionItem* item)
+{
+    auto it = _itemJsonCache.constFind(item);
+    if (it != _itemJsonCache.constEnd()) {
+        return *it;
+    }
+
+    QJsonArray json;
+    item->save(json);
+    // Complex items only signal the first edit after they are saved, so the json of a dirty item can't be kept
+    if (!item->dirty()) {
+        _itemJsonCache[item] = json;
+    }
+    return json;
+}
+
+void PlanUndoStack::takeSnapshot(void)
+{
+    _snapshotTimer.stop();
+    if (!_started) {
+        return;
+    }
+
+    Snapshot_t snapshot;
+    _missionController->saveHeader(snapshot.missionHeader);
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+    for (int i=0; i<visualItems->count(); i++) {
+        snapshot.visualItems.append(_itemJson(visualItems->value<VisualMissionItem*>(i)));
+    }
+    _geoFenceController->save(snapshot.geoFence);
+    _rallyPointController->save(snapshot.rallyPoints);
+
+    if (_index >= 0 && _sameSnapshot(snapshot, _snapshots[_index])) {
+        emit canUndoRedoChanged();
+        return;
+    }
+
+    // An edit after an undo drops what could have been redone
+    while (_snapshots.count() > _index + 1) {
+        _snapshots.removeLast();
+    }
+    _snapshots.append(snapshot);
+    if (_snapshots.count() > maxSnapshots) {
+        _snapshots.removeFirst();
+    }
+    _index = _snapshots.count() - 1;
+    qCDebug(PlanUndoStackLog) << "takeSnapshot index:visualItems" << _index << snapshot.visualItems.count();
+
+    emit canUndoRedoChanged();
+}
+
+bool PlanUndoStack::_sameSnapshot(const Snapshot_t& a, const Snapshot_t& b)
+{
+    // Comparing json which is still shared doesn't look at the contents
+    return a.visualItems == b.visualItems && a.missionHeader == b.missionHeader && a.geoFence == b.geoFence && a.rallyPoints == b.rallyPoints;
+}
+
+void PlanUndoStack::undo(void)
+{
+    // Edits which haven't settled yet are undone as well
+    takeSnapshot();
+    if (_index > 0) {
+        _index--;
+        _restore(_snapshots[_index]);
+        emit canUndoRedoChanged();
+    }
+}
+
+void PlanUndoStack::redo(void)
+{
+    if (_snapshotTimer.isActive()) {
+        takeSnapshot();
+    }
+    if (canRedo()) {
+        _index++;
+        _restore(_snapshots[_index]);
+        emit canUndoRedoChanged();
+    }
+}
+
+void PlanUndoStack::_restore(const Snapshot_t& snapshot)
+{
+    QJsonObject missionJson = snapshot.missionHeader;
+    MissionController::saveVisualItemsJson(missionJson, snapshot.visualItems);
+
+    QString errorString;
+    _restoring = true;
+    if (!_missionController->load(missionJson, errorString) ||
+            !_geoFenceController->load(snapshot.geoFence, errorString) ||
+            !_rallyPointController->load(snapshot.rallyPoints, errorString)) {
+        qgcApp()->showAppMessage(tr("Undo failed: %1").arg(errorString));
+    }
+    _missionController->setDirty(true);
+    _geoFenceController->setDirty(true);
+    _rallyPointController->setDirty(true);
+    _restoring = false;
+    _snapshotTimer.stop();
+
+    // The loaded items are clean and were created from the snapshot json, so the next snapshot doesn't have to save them again
+    QmlObjectListModel* visualItems = _missionController->visualItems();
+    if (visualItems->count() == snapshot.visualItems.count()) {
+        for (int i=0; i<visualItems->count(); i++) {
+            VisualMissionItem* item = visualItems->value<VisualMissionItem*>(i);
+            if (!item->dirty()) {
+                _itemJsonCache[item] = snapshot.visualItems[i];
+            }
+        }
+    }
+}
@@ -0,0 +1,96 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCLoggingCategory.h"
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+
+class MissionController;
+class GeoFenceController;
+class RallyPointController;
+class VisualMissionItem;
+
+Q_DECLARE_LOGGING_CATEGORY(PlanUndoStackLog)
+
+/// Undo/redo of Plan view edits to the mission, fence and rally points.
+///
+/// A snapshot of the plan is taken once edits settle. The saved json of each visual item is kept while the item is
+/// clean and shared by all snapshots it shows up in, so a snapshot only saves the items which were edited since the
+/// plan was last loaded or saved, and the history mostly holds references to the same json. Undo and redo load the
+/// snapshot back into the controllers.
+class PlanUndoStack : public QObject
+{
+    Q_OBJECT
+
+public:
+    PlanUndoStack(MissionController* missionController, GeoFenceController* geoFenceController, RallyPointController* rallyPointController, QObject* parent = nullptr);
+
+    Q_PROPERTY(bool canUndo READ canUndo NOTIFY canUndoRedoChanged)
+    Q_PROPERTY(bool canRedo READ canRedo NOTIFY canUndoRedoChanged)
+
+    Q_INVOKABLE void undo(void);
+    Q_INVOKABLE void redo(void);
+
+    /// Starts following edits to the plan. Only used by the Plan view.
+    void start(void);
+
+    /// Drops the history, the current plan is where undo stops. Called when a plan is loaded or removed.
+    void reset(void);
+
+    /// Snapshots are taken once edits settle, this takes one right away
+    void takeSnapshot(void);
+
+    bool canUndo        (void) const { return _index > 0 || _snapshotTimer.isActive(); }
+    bool canRedo        (void) const { return _index < _snapshots.count() - 1; }
+    int  snapshotCount  (void) const { return _snapshots.count(); }
+
+    static const int maxSnapshots = 50;
+
+signals:
+    void canUndoRedoChanged(void);
+
+private slots:
+    void _scheduleSnapshot          (void);
+    void _visualItemsChanged        (void);
+    void _visualItemsCountChanged   (void);
+    void _itemChanged               (void);
+    void _itemDestroyed             (QObject* object);
+
+private:
+    typedef struct {
+        QJsonObject         missionHeader;  ///< Mission json without the items
+        QList<QJsonArray>   visualItems;    ///< Saved json of each visual item, shared with other snapshots while the item is unchanged
+        QJsonObject         geoFence;
+        QJsonObject         rallyPoints;
+    } Snapshot_t;
+
+    void        _connectItem    (VisualMissionItem* item);
+    QJsonArray  _itemJson       (VisualMissionItem* item);
+    void        _restore        (const Snapshot_t& snapshot);
+    static bool _sameSnapshot   (const Snapshot_t& a, const Snapshot_t& b);
+
+    MissionController*      _missionController;
+    GeoFenceController*     _geoFenceController;
+    RallyPointController*   _rallyPointController;
+    QList<Snapshot_t>       _snapshots;
+    int                     _index =        -1;     ///< Snapshot the plan is at
+    QHash<VisualMissionItem*, QJsonArray> _itemJsonCache;   ///< Only clean items
+    QTimer                  _snapshotTimer;
+    bool                    _started =      false;
+    bool                    _restoring =    false;
+
+    static const int _snapshotDelayMSecs = 500;
+};
@@ -20,7 +20,6 @@
 #include <QJsonArray>
 #include <QLineF>
 #include <QFile>
-#include <QDomDocument>
 
 const char* QGCMapPolygon::jsonPolygonKey = "polygon";
 
@@ -54,6 +53,7 @@ void QGCMapPolygon::_init(void)
     connect(&_polygonModel, &QmlObjectListModel::countChanged, this, &QGCMapPolygon::_polygonModelCountChanged);
 
     connect(this, &QGCMapPolygon::pathChanged,  this, &QGCMapPolygon::_updateCenter);
+    connect(this, &QGCMapPolygon::pathChanged,  this, &QGCMapPolygon::_clearContainsIndex);
     connect(this, &QGCMapPolygon::countChanged, this, &QGCMapPolygon::isValidChanged);
     connect(this, &QGCMapPolygon::countChanged, this, &QGCMapPolygon::isEmptyChanged);
 }
@@ -76,11 +76,13 @@ const QGCMapPolygon& QGCMapPolygon::operator=(const QGCMapPolygon& other)
 
 void QGCMapPolygon::clear(void)
 {
-    // Bug workaround, see below
-    while (_polygonPath.count() > 1) {
-        _polygonPath.takeLast();
+    // Bug workaround, see below. Not needed during a reset, which signals the path change once it ends.
+    if (!_resetActive) {
+        while (_polygonPath.count() > 1) {
+            _polygonPath.takeLast();
+        }
+        emit pathChanged();
     }
-    emit pathChanged();
 
     // Although this code should remove the polygon from the map it doesn't. There appears
     // to be a bug in QGCMapPolygon which causes it to not be redrawn if the list is empty. So
@@ -98,6 +100,7 @@ void QGCMapPolygon::clear(void)
 void QGCMapPolygon::adjustVertex(int vertexIndex, const QGeoCoordinate coordinate)
 {
     _polygonPath[vertexIndex] = QVariant::fromValue(coordinate);
+    _clearContainsIndex();
     _polygonModel.value<QGCQGeoCoordinate*>(vertexIndex)->setCoordinate(coordinate);
     if (!_centerDrag) {
         // When dragging center we don't signal path changed until all vertices are updated
@@ -147,8 +150,9 @@ QPolygonF QGCMapPolygon::_toPolygonF(void) const
     QPolygonF polygon;
 
     if (_polygonPath.count() > 2) {
-        for (int i=0; i<_polygonPath.count(); i++) {
-            polygon.append(_pointFFromCoord(_polygonPath[i].value<QGeoCoordinate>()));
+        QGCTangentPlane tangentPlane(_polygonPath[0].value<QGeoCoordinate>());
+        for (const QPointF& point: tangentPlane.geoToEastNorth(coordinateList())) {
+            polygon.append(QPointF(point.x(), -point.y()));
         }
     }
 
@@ -158,7 +162,11 @@ QPolygonF QGCMapPolygon::_toPolygonF(void) const
 bool QGCMapPolygon::containsCoordinate(const QGeoCoordinate& coordinate) const
 {
     if (_polygonPath.count() > 2) {
-        return _toPolygonF().containsPoint(_pointFFromCoord(coordinate), Qt::OddEvenFill);
+        // The projected polygon and its edge index are built on first use after the vertices change
+        if (!_containsIndex.isValid() || _containsIndex.count() != _polygonPath.count()) {
+            _containsIndex.build(_toPolygonF());
+        }
+        return _containsIndex.containsPoint(_pointFFromCoord(coordinate));
     } else {
         return false;
     }
@@ -270,7 +278,10 @@ void QGCMapPolygon::appendVertex(const QGeoCoordinate& coordinate)
 void QGCMapPolygon::appendVertices(const QList<QGeoCoordinate>& coordinates)
 {
     QList<QObject*> objects;
+    objects.reserve(coordinates.count());
+    _polygonPath.reserve(_polygonPath.count() + coordinates.count());
 
+    // All the vertices go in under one reset, whose end is the only path change signalled
     _beginResetIfNotActive();
     for (const QGeoCoordinate& coordinate: coordinates) {
         objects.append(new QGCQGeoCoordinate(coordinate, this));
@@ -278,8 +289,6 @@ void QGCMapPolygon::appendVertices(const QList<QGeoCoordinate>& coordinates)
     }
     _polygonModel.append(objects);
     _endResetIfNotActive();
-
-    emit pathChanged();
 }
 
 void QGCMapPolygon::appendVertices(const QVariantList& varCoords)
@@ -322,6 +331,11 @@ void QGCMapPolygon::removeVertex(int vertexIndex)
     emit pathChanged();
 }
 
+void QGCMapPolygon::_clearContainsIndex(void)
+{
+    _containsIndex.clear();
+}
+
 void QGCMapPolygon::_polygonModelCountChanged(int count)
 {
     emit countChanged(count);
@@ -405,19 +419,7 @@ QList<QPointF> QGCMapPolygon::nedPolygon(void) const
     QList<QPointF>  nedPolygon;
 
     if (count() > 0) {
-        QGeoCoordinate  tangentOrigin = vertexCoordinate(0);
-
-        for (int i=0; i<_polygonModel.count(); i++) {
-            double y, x, down;
-            QGeoCoordinate vertex = vertexCoordinate(i);
-            if (i == 0) {
-                // This avoids a nan calculation that comes out of convertGeoToNed
-                x = y = 0;
-            } else {
-                convertGeoToNed(vertex, tangentOrigin, &y, &x, &down);
-            }
-            nedPolygon += QPointF(x, y);
-        }
+        nedPolygon = QGCTangentPlane(vertexCoordinate(0)).geoToEastNorth(coordinateList());
     }
 
     return nedPolygon;
@@ -456,7 +458,7 @@ void QGCMapPolygon::offset(double distance)
 
         // Intersect the offset edges to generate new vertices
         QPointF         newVertex;
-        QGeoCoordinate  tangentOrigin = vertexCoordinate(0);
+        QGCTangentPlane tangentPlane(vertexCoordinate(0));
         for (int i=0; i<rgOffsetEdges.count(); i++) {
             int prevIndex = i == 0 ? rgOffsetEdges.count() - 1 : i - 1;
 #if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
@@ -470,7 +472,7 @@ void QGCMapPolygon::offset(double distance)
                 return;
             }
             QGeoCoordinate coord;
-            convertNedToGeo(newVertex.y(), newVertex.x(), 0, tangentOrigin, &coord);
+            tangentPlane.nedToGeo(newVertex.y(), newVertex.x(), 0, &coord);
             rgNewPolygon.append(coord);
         }
     }
@@ -482,11 +484,11 @@ void QGCMapPolygon::offset(double distance)
     _endResetIfNotActive();
 }
 
-bool QGCMapPolygon::loadKMLOrSHPFile(const QString& file)
+bool QGCMapPolygon::loadKMLOrSHPFile(const QString& file, int maxVertices)
 {
     QString errorString;
     QList<QGeoCoordinate> rgCoords;
-    if (!ShapeFileHelper::loadPolygonFromFile(file, rgCoords, errorString)) {
+    if (!ShapeFileHelper::loadPolygonFromFile(file, rgCoords, errorString, maxVertices)) {
         qgcApp()->showAppMessage(errorString);
         return false;
     }
@@ -576,49 +578,6 @@ void QGCMapPolygon::_endResetIfNotActive(void)
     }
 }
 
-QDomElement QGCMapPolygon::kmlPolygonElement(KMLDomDocument& domDocument)
-{
-#if 0
-    <Polygon id="ID">
-      <!-- specific to Polygon -->
-      <extrude>0</extrude>                       <!-- boolean -->
-      <tessellate>0</tessellate>                 <!-- boolean -->
-      <altitudeMode>clampToGround</altitudeMode>
-            <!-- kml:altitudeModeEnum: clampToGround, relativeToGround, or absolute -->
-            <!-- or, substitute gx:altitudeMode: clampToSeaFloor, relativeToSeaFloor -->
-      <outerBoundaryIs>
-        <LinearRing>
-          <coordinates>...</coordinates>         <!-- lon,lat[,alt] -->
-        </LinearRing>
-      </outerBoundaryIs>
-      <innerBoundaryIs>
-        <LinearRing>
-          <coordinates>...</coordinates>         <!-- lon,lat[,alt] -->
-        </LinearRing>
-      </innerBoundaryIs>
-    </Polygon>
-#endif
-
-    QDomElement polygonElement = domDocument.createElement("Polygon");
-
-    domDocument.addTextElement(polygonElement, "altitudeMode", "clampToGround");
-
-    QDomElement outerBoundaryIsElement = domDocument.createElement("outerBoundaryIs");
-    QDomElement linearRingElement = domDocument.createElement("LinearRing");
-
-    outerBoundaryIsElement.appendChild(linearRingElement);
-    polygonElement.appendChild(outerBoundaryIsElement);
-
-    QString coordString;
-    for (const QVariant& varCoord : _polygonPath) {
-        coordString += QStringLiteral("%1\n").arg(domDocument.kmlCoordString(varCoord.value<QGeoCoordinate>()));
-    }
-    coordString += QStringLiteral("%1\n").arg(domDocument.kmlCoordString(_polygonPath.first().value<QGeoCoordinate>()));
-    domDocument.addTextElement(linearRingElement, "coordinates", coordString);
-
-    return polygonElement;
-}
-
 void QGCMapPolygon::setTraceMode(bool traceMode)
 {
     if (traceMode != _traceMode) {
@@ -16,7 +16,7 @@
 #include <QPolygon>
 
 #include "QmlObjectListModel.h"
-#include "KMLDomDocument.h"
+#include "QGCPolygonIndex.h"
 
 /// The QGCMapPolygon class provides a polygon which can be displayed on a map using a map visuals control.
 /// It maintains a representation of the polygon on QVariantList and QmlObjectListModel format.
@@ -66,8 +66,9 @@ public:
     Q_INVOKABLE void offset(double distance);
 
     /// Loads a polygon from a KML/SH{ file
+    ///     @param maxVertices Larger polygons are simplified down to this many vertices, 0 for no limit
     /// @return true: success
-    Q_INVOKABLE bool loadKMLOrSHPFile(const QString& file);
+    Q_INVOKABLE bool loadKMLOrSHPFile(const QString& file, int maxVertices = 0);
 
     /// Returns the path in a list of QGeoCoordinate's format
     QList<QGeoCoordinate> coordinateList(void) const;
@@ -98,8 +99,6 @@ public:
     /// Returns the area of the polygon in meters squared
     double area(void) const;
 
-    QDomElement kmlPolygonElement(KMLDomDocument& domDocument);
-
     // Property methods
 
     int             count       (void) const { return _polygonPath.count(); }
@@ -147,6 +146,7 @@ private slots:
     void _polygonModelCountChanged(int count);
     void _polygonModelDirtyChanged(bool dirty);
     void _updateCenter(void);
+    void _clearContainsIndex(void);
 
 private:
     void            _init                   (void);
@@ -167,6 +167,8 @@ private:
     bool                _traceMode =            false;
     bool                _showAltColor =         false;
     int                 _selectedVertexIndex =  -1;
+
+    mutable QGCPolygonIndex _containsIndex;     ///< Built lazily by containsCoordinate, cleared whenever the vertices change
 };
 
 #endif
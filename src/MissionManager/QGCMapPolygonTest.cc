@@ -10,6 +10,11 @@
 #include "QGCMapPolygonTest.h"
 #include "QGCApplication.h"
 #include "QGCQGeoCoordinate.h"
+#include "QGCPolygonIndex.h"
+#include "ShapeFileHelper.h"
+
+#include <QRandomGenerator>
+#include <QtMath>
 
 QGCMapPolygonTest::QGCMapPolygonTest(void)
 {
@@ -220,6 +225,34 @@ void QGCMapPolygonTest::_testKMLLoad(void)
     checkExpectedMessageBox();
 }
 
+void QGCMapPolygonTest::_testKMLLoadSimplified(void)
+{
+    // The closing vertex of the ring isn't loaded
+    QVERIFY(_mapPolygon->loadKMLOrSHPFile(QStringLiteral(":/unittest/PolygonGood.kml")));
+    QCOMPARE(_mapPolygon->count(), 4);
+
+    // The whole load is signalled as a single path change
+    _multiSpyPolygon->clearAllSignals();
+    QVERIFY(_mapPolygon->loadKMLOrSHPFile(QStringLiteral(":/unittest/PolygonGood.kml"), 3));
+    QCOMPARE(_mapPolygon->count(), 3);
+    QCOMPARE(_multiSpyPolygon->getSpyByIndex(pathChangedIndex)->count(), 1);
+
+    // Progress is reported as the file is read and reaches the end
+    QList<QGeoCoordinate>   vertices;
+    QString                 errorString;
+    double                  lastProgress = -1;
+    QVERIFY(ShapeFileHelper::loadPolygonFromFile(QStringLiteral(":/unittest/PolygonGood.kml"), vertices, errorString, 0, [&lastProgress](double progress) {
+        lastProgress = progress;
+        return true;
+    }));
+    QCOMPARE(vertices.count(), 4);
+    QCOMPARE(lastProgress, 1.0);
+
+    // A cancelled load fails
+    QVERIFY(!ShapeFileHelper::loadPolygonFromFile(QStringLiteral(":/unittest/PolygonGood.kml"), vertices, errorString, 0, [](double) { return false; }));
+    QVERIFY(!errorString.isEmpty());
+}
+
 void QGCMapPolygonTest::_testSelectVertex(void)
 {
     // Create polygon
@@ -254,3 +287,46 @@ void QGCMapPolygonTest::_testSelectVertex(void)
     _mapPolygon->removeVertex(0);
     QVERIFY(_mapPolygon->selectedVertex() == _mapPolygon->count() - 1);
 }
+
+void QGCMapPolygonTest::_testContainsCoordinate(void)
+{
+    // Star shaped fence with a few thousand vertices: points closer than the inner radius are inside, points further
+    // out than the outer radius are outside.
+    const int               cVertices       = 3000;
+    const double            innerRadius     = 900;
+    const double            outerRadius     = 1000;
+    const QGeoCoordinate    center          = _polyPoints[0];
+
+    QList<QGeoCoordinate> rgVertices;
+    for (int i=0; i<cVertices; i++) {
+        rgVertices.append(center.atDistanceAndAzimuth(i % 2 ? innerRadius : outerRadius, 360.0 * i / cVertices));
+    }
+    _mapPolygon->setPath(rgVertices);
+
+    QVERIFY(_mapPolygon->containsCoordinate(center));
+    for (int i=0; i<360; i+=7) {
+        QVERIFY(_mapPolygon->containsCoordinate(center.atDistanceAndAzimuth(innerRadius - 10, i)));
+        QVERIFY(!_mapPolygon->containsCoordinate(center.atDistanceAndAzimuth(outerRadius + 10, i)));
+    }
+
+    // Index must be rebuilt after vertex changes
+    QGeoCoordinate farCoord = center.atDistanceAndAzimuth(outerRadius * 2, 0);
+    QVERIFY(!_mapPolygon->containsCoordinate(farCoord));
+    _mapPolygon->adjustVertex(0, center.atDistanceAndAzimuth(outerRadius * 3, 0));
+    QVERIFY(_mapPolygon->containsCoordinate(farCoord));
+    _mapPolygon->removeVertex(0);
+    QVERIFY(!_mapPolygon->containsCoordinate(farCoord));
+
+    // Index results must match QPolygonF for an irregular self intersecting polygon
+    QRandomGenerator    random(1234);
+    QPolygonF           polygonF;
+    for (int i=0; i<500; i++) {
+        polygonF.append(QPointF(random.bounded(1000.0), random.bounded(1000.0)));
+    }
+    QGCPolygonIndex index;
+    index.build(polygonF);
+    for (int i=0; i<5000; i++) {
+        QPointF point(random.bounded(1200.0) - 100, random.bounded(1200.0) - 100);
+        QCOMPARE(index.containsPoint(point), polygonF.containsPoint(point, Qt::OddEvenFill));
+    }
+}
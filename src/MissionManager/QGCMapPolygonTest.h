@@ -29,7 +29,9 @@ private slots:
     void _testDirty(void);
     void _testVertexManipulation(void);
     void _testKMLLoad(void);
+    void _testKMLLoadSimplified(void);
     void _testSelectVertex(void);
+    void _testContainsCoordinate(void);
 
 private:
     enum {
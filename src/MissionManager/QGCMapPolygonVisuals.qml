@@ -561,6 +561,14 @@ Item {
                 onClicked:          kmlOrSHPLoadDialog.openForLoad()
                 visible:            !mapPolygon.traceMode
             }
+
+            QGCButton {
+                _horizontalPadding: 0
+                text:               qsTr("Download Terrain")
+                visible:            !mapPolygon.traceMode
+                enabled:            mapPolygon.count >= 3
+                onClicked:          QGroundControl.mapEngineManager.startElevationDownloadForPolygon(QGroundControl.mapEngineManager.getUniqueName() + qsTr(" Terrain"), mapPolygon.path)
+            }
         }
     }
 
@@ -12,7 +12,7 @@
 #include "JsonHelper.h"
 #include "QGCQGeoCoordinate.h"
 #include "QGCApplication.h"
-#include "KMLHelper.h"
+#include "ShapeFileHelper.h"
 
 #include <QGeoRectangle>
 #include <QDebug>
@@ -69,7 +69,10 @@ void QGCMapPolyline::_init(void)
 void QGCMapPolyline::clear(void)
 {
     _polylinePath.clear();
-    emit pathChanged();
+    // A reset signals the path change once it ends
+    if (!_resetActive) {
+        emit pathChanged();
+    }
 
     _polylineModel.clearAndDeleteContents();
 
@@ -276,19 +279,7 @@ QList<QPointF> QGCMapPolyline::nedPolyline(void)
     QList<QPointF>  nedPolyline;
 
     if (count() > 0) {
-        QGeoCoordinate  tangentOrigin = vertexCoordinate(0);
-
-        for (int i=0; i<_polylinePath.count(); i++) {
-            double y, x, down;
-            QGeoCoordinate vertex = vertexCoordinate(i);
-            if (i == 0) {
-                // This avoids a nan calculation that comes out of convertGeoToNed
-                x = y = 0;
-            } else {
-                convertGeoToNed(vertex, tangentOrigin, &y, &x, &down);
-            }
-            nedPolyline += QPointF(x, y);
-        }
+        nedPolyline = QGCTangentPlane(vertexCoordinate(0)).geoToEastNorth(coordinateList());
     }
 
     return nedPolyline;
@@ -296,15 +287,20 @@ QList<QPointF> QGCMapPolyline::nedPolyline(void)
 
 
 QList<QGeoCoordinate> QGCMapPolyline::offsetPolyline(double distance)
+{
+    if (count() > 1) {
+        return offsetPolyline(nedPolyline(), vertexCoordinate(0), distance);
+    }
+    return QList<QGeoCoordinate>();
+}
+
+QList<QGeoCoordinate> QGCMapPolyline::offsetPolyline(const QList<QPointF>& rgNedVertices, const QGeoCoordinate& tangentOrigin, double distance)
 {
     QList<QGeoCoordinate> rgNewPolyline;
 
     // I'm sure there is some beautiful famous algorithm to do this, but here is a brute force method
 
-    if (count() > 1) {
-        // Convert the polygon to NED
-        QList<QPointF> rgNedVertices = nedPolyline();
-
+    if (rgNedVertices.count() > 1) {
         // Walk the edges, offsetting by the specified distance
         QList<QLineF> rgOffsetEdges;
         for (int i=0; i<rgNedVertices.count() - 1; i++) {
@@ -324,11 +320,11 @@ QList<QGeoCoordinate> QGCMapPolyline::offsetPolyline(double distance)
             rgOffsetEdges.append(offsetEdge);
         }
 
-        QGeoCoordinate  tangentOrigin = vertexCoordinate(0);
+        QGCTangentPlane tangentPlane(tangentOrigin);
 
         // Add first vertex
         QGeoCoordinate coord;
-        convertNedToGeo(rgOffsetEdges[0].p1().y(), rgOffsetEdges[0].p1().x(), 0, tangentOrigin, &coord);
+        tangentPlane.nedToGeo(rgOffsetEdges[0].p1().y(), rgOffsetEdges[0].p1().x(), 0, &coord);
         rgNewPolyline.append(coord);
 
         // Intersect the offset edges to generate new central vertices
@@ -343,30 +339,29 @@ QList<QGeoCoordinate> QGCMapPolyline::offsetPolyline(double distance)
                 // Two lines are colinear
                 newVertex = rgOffsetEdges[i].p2();
             }
-            convertNedToGeo(newVertex.y(), newVertex.x(), 0, tangentOrigin, &coord);
+            tangentPlane.nedToGeo(newVertex.y(), newVertex.x(), 0, &coord);
             rgNewPolyline.append(coord);
         }
 
         // Add last vertex
         int lastIndex = rgOffsetEdges.count() - 1;
-        convertNedToGeo(rgOffsetEdges[lastIndex].p2().y(), rgOffsetEdges[lastIndex].p2().x(), 0, tangentOrigin, &coord);
+        tangentPlane.nedToGeo(rgOffsetEdges[lastIndex].p2().y(), rgOffsetEdges[lastIndex].p2().x(), 0, &coord);
         rgNewPolyline.append(coord);
     }
 
     return rgNewPolyline;
 }
 
-bool QGCMapPolyline::loadKMLFile(const QString& kmlFile)
+bool QGCMapPolyline::loadKMLFile(const QString& kmlFile, int maxVertices)
 {
-    _beginResetIfNotActive();
-
     QString errorString;
     QList<QGeoCoordinate> rgCoords;
-    if (!KMLHelper::loadPolylineFromFile(kmlFile, rgCoords, errorString)) {
+    if (!ShapeFileHelper::loadPolylineFromFile(kmlFile, rgCoords, errorString, maxVertices)) {
         qgcApp()->showAppMessage(errorString);
         return false;
     }
 
+    _beginResetIfNotActive();
     clear();
     appendVertices(rgCoords);
 
@@ -406,6 +401,8 @@ void QGCMapPolyline::appendVertices(const QList<QGeoCoordinate>& coordinates)
     _beginResetIfNotActive();
 
     QList<QObject*> objects;
+    objects.reserve(coordinates.count());
+    _polylinePath.reserve(_polylinePath.count() + coordinates.count());
     for (const QGeoCoordinate& coordinate: coordinates) {
         objects.append(new QGCQGeoCoordinate(coordinate, this));
         _polylinePath.append(QVariant::fromValue(coordinate));
@@ -52,9 +52,15 @@ public:
     /// @return Offset set of vertices
     QList<QGeoCoordinate> offsetPolyline(double distance);
 
+    /// Same as offsetPolyline for a polyline already converted to NED by nedPolyline. Doesn't touch any polyline, so it
+    /// can run on a worker thread.
+    ///     @param tangentOrigin First vertex of the polyline, origin of nedVertices
+    static QList<QGeoCoordinate> offsetPolyline(const QList<QPointF>& nedVertices, const QGeoCoordinate& tangentOrigin, double distance);
+
     /// Loads a polyline from a KML file
+    ///     @param maxVertices Larger polylines are simplified down to this many vertices, 0 for no limit
     /// @return true: success
-    Q_INVOKABLE bool loadKMLFile(const QString& kmlFile);
+    Q_INVOKABLE bool loadKMLFile(const QString& kmlFile, int maxVertices = 0);
 
     Q_INVOKABLE void beginReset (void);
     Q_INVOKABLE void endReset   (void);
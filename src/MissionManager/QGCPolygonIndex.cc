@@ -0,0 +1,94 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCPolygonIndex.h"
+
+#include <QtMath>
+
+QGCPolygonIndex::QGCPolygonIndex(void)
+    : _valid    (false)
+    , _rowHeight(0)
+{
+
+}
+
+void QGCPolygonIndex::clear(void)
+{
+    _valid      = false;
+    _rowHeight  = 0;
+    _polygon.clear();
+    _rows.clear();
+}
+
+void QGCPolygonIndex::build(const QPolygonF& polygon)
+{
+    clear();
+
+    _polygon    = polygon;
+    _bounds     = polygon.boundingRect();
+    _valid      = true;
+
+    if (_polygon.count() < 2) {
+        return;
+    }
+
+    // Roughly one row per edge keeps the number of edges per row small for any reasonably shaped polygon
+    int rowCount = qBound(1, _polygon.count(), static_cast<int>(_maxRows));
+    _rowHeight = _bounds.height() / rowCount;
+    if (_rowHeight <= 0) {
+        rowCount    = 1;
+        _rowHeight  = 1;
+    }
+    _rows.resize(rowCount);
+
+    for (int i=0; i<_polygon.count(); i++) {
+        const QPointF& p1 = _polygon[i];
+        const QPointF& p2 = _polygon[(i + 1) % _polygon.count()];
+        if (qFuzzyCompare(p1.y(), p2.y())) {
+            // Horizontal edges never count as a crossing
+            continue;
+        }
+        int firstRow    = _row(qMin(p1.y(), p2.y()));
+        int lastRow     = _row(qMax(p1.y(), p2.y()));
+        for (int row=firstRow; row<=lastRow; row++) {
+            _rows[row].append(i);
+        }
+    }
+}
+
+int QGCPolygonIndex::_row(double y) const
+{
+    return qBound(0, static_cast<int>(qFloor((y - _bounds.top()) / _rowHeight)), _rows.count() - 1);
+}
+
+bool QGCPolygonIndex::containsPoint(const QPointF& point) const
+{
+    if (_rows.isEmpty() || point.y() < _bounds.top() || point.y() > _bounds.bottom() || point.x() < _bounds.left()) {
+        return false;
+    }
+
+    // Same scan conversion rule as QPolygonF::containsPoint: an edge counts when the point is in its half open y range
+    // and the edge crosses that y at or left of the point.
+    int crossings = 0;
+    for (int edgeIndex: _rows[_row(point.y())]) {
+        QPointF p1 = _polygon[edgeIndex];
+        QPointF p2 = _polygon[(edgeIndex + 1) % _polygon.count()];
+        if (p2.y() < p1.y()) {
+            qSwap(p1, p2);
+        }
+        if (point.y() >= p1.y() && point.y() < p2.y()) {
+            double x = p1.x() + ((p2.x() - p1.x()) / (p2.y() - p1.y())) * (point.y() - p1.y());
+            if (x <= point.x()) {
+                crossings++;
+            }
+        }
+    }
+
+    return crossings % 2 != 0;
+}
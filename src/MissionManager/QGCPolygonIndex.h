@@ -0,0 +1,46 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QPolygonF>
+#include <QRectF>
+#include <QVector>
+
+/// Row index over the edges of a planar polygon for fast point in polygon tests.
+///
+/// The bounding box is split into horizontal rows and each edge is recorded in every row its y range touches. A
+/// containment test then only has to look at the edges in the row of the point instead of every edge of the polygon.
+/// Results match QPolygonF::containsPoint with Qt::OddEvenFill.
+class QGCPolygonIndex
+{
+public:
+    QGCPolygonIndex(void);
+
+    void build  (const QPolygonF& polygon);
+    void clear  (void);
+
+    bool isValid(void) const { return _valid; }
+
+    /// @return Number of vertices in the polygon the index was built from
+    int count(void) const { return _polygon.count(); }
+
+    bool containsPoint(const QPointF& point) const;
+
+private:
+    int _row(double y) const;
+
+    bool                    _valid;
+    QPolygonF               _polygon;
+    QRectF                  _bounds;
+    double                  _rowHeight;
+    QVector<QVector<int>>   _rows;      ///< Indices of the edges which overlap each row, edge i goes from vertex i to i+1
+
+    static const int _maxRows = 4096;
+};
@@ -80,7 +80,7 @@ void RallyPoint::_factSetup(void)
 
 void RallyPoint::_cacheFactMetadata() {
     if (_metaDataMap.isEmpty()) {
-        _metaDataMap = FactMetaData::createMapFromJsonFile(QStringLiteral(":/json/RallyPoint.FactMetaData.json"), nullptr /* metaDataParent */);
+        _metaDataMap = FactMetaData::sharedMapFromJsonFile(QStringLiteral(":/json/RallyPoint.FactMetaData.json"));
     }
 }
 
@@ -25,7 +25,7 @@ SpeedSection::SpeedSection(PlanMasterController* masterController, QObject* pare
     , _flightSpeedFact      (0, _flightSpeedName,   FactMetaData::valueTypeDouble)
 {
     if (_metaDataMap.isEmpty()) {
-        _metaDataMap = FactMetaData::createMapFromJsonFile(QStringLiteral(":/json/SpeedSection.FactMetaData.json"), nullptr /* metaDataParent */);
+        _metaDataMap = FactMetaData::sharedMapFromJsonFile(QStringLiteral(":/json/SpeedSection.FactMetaData.json"));
     }
 
     double flightSpeed = 0;
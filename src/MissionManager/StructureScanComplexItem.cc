@@ -38,7 +38,7 @@ const char* StructureScanComplexItem::_jsonCameraCalcKey =          "CameraCalc"
 
 StructureScanComplexItem::StructureScanComplexItem(PlanMasterController* masterController, bool flyView, const QString& kmlOrShpFile, QObject* parent)
     : ComplexMissionItem        (masterController, flyView, parent)
-    , _metaDataMap              (FactMetaData::createMapFromJsonFile(QStringLiteral(":/json/StructureScan.SettingsGroup.json"), this /* QObject parent */))
+    , _metaDataMap              (FactMetaData::sharedMapFromJsonFile(QStringLiteral(":/json/StructureScan.SettingsGroup.json")))
     , _sequenceNumber           (0)
     , _entryVertex              (0)
     , _ignoreRecalc             (false)
@@ -277,6 +277,14 @@ void StructureScanComplexItem::_flightPathChanged(void)
     double bottom = 100000.;
     double top = 0.;
     QList<QGeoCoordinate> vertices = _flightPolygon.coordinateList();
+
+    // Layers all fly the same polygon, so the other layer calculations use these instead of going through the model again
+    _flightPolygonCoords    = vertices;
+    _flightPolygonPerimeter = 0;
+    for (int i=0; i<vertices.count(); i++) {
+        _flightPolygonPerimeter += vertices[i].distanceTo(vertices[i + 1 == vertices.count() ? 0 : i + 1]);
+    }
+
     for (int i = 0; i < vertices.count(); i++) {
         QGeoCoordinate vertex = vertices[i];
         double lat = vertex.latitude()  + 90.0;
@@ -535,8 +543,11 @@ void StructureScanComplexItem::_rebuildFlightPolygon(void)
     int savedEntryVertex = _entryVertex;
     _entryVertex = 0;
 
+    // Copy and offset under one reset, so every layer's flight path segments are rebuilt once instead of for each step
+    _flightPolygon.beginReset();
     _flightPolygon = _structurePolygon;
     _flightPolygon.offset(_cameraCalc.distanceToSurface()->rawValue().toDouble());
+    _flightPolygon.endReset();
 
     if (savedEntryVertex >= _flightPolygon.count()) {
         _entryVertex = 0;
@@ -562,12 +573,7 @@ void StructureScanComplexItem::_recalcCameraShots(void)
     }
 
     // Determine the distance for each polygon traverse
-    double distance = 0;
-    for (int i=0; i<_flightPolygon.count(); i++) {
-        QGeoCoordinate coord1 = _flightPolygon.vertexCoordinate(i);
-        QGeoCoordinate coord2 = _flightPolygon.vertexCoordinate(i + 1 == _flightPolygon.count() ? 0 : i + 1);
-        distance += coord1.distanceTo(coord2);
-    }
+    double distance = _flightPolygonPerimeter;
     if (distance == 0.0) {
         _setCameraShots(0);
         return;
@@ -629,13 +635,7 @@ void StructureScanComplexItem::_recalcScanDistance()
     double scanDistance = 0;
 
     if (_flightPolygon.count() > 2) {
-        QList<QGeoCoordinate> vertices = _flightPolygon.coordinateList();
-        for (int i=0; i<vertices.count() - 1; i++) {
-            scanDistance += vertices[i].distanceTo(vertices[i+1]);
-        }
-        scanDistance += vertices.last().distanceTo(vertices.first());
-
-        scanDistance *= _layersFact.rawValue().toInt();
+        scanDistance = _flightPolygonPerimeter * _layersFact.rawValue().toInt();
 
         double surfaceHeight = qMax(_structureHeightFact.rawValue().toDouble() - _scanBottomAltFact.rawValue().toDouble(), 0.0);
         scanDistance += surfaceHeight;
@@ -722,13 +722,13 @@ void StructureScanComplexItem::_updateFlightPathSegmentsDontCallDirectly(void)
             }
 
             QGeoCoordinate prevCoord = QGeoCoordinate();
-            for (const QGeoCoordinate& coord: _flightPolygon.coordinateList()) {
+            for (const QGeoCoordinate& coord: _flightPolygonCoords) {
                 if (prevCoord.isValid()) {
                     _appendFlightPathSegment(prevCoord, layerAltitude, coord, layerAltitude);
                 }
                 prevCoord = coord;
             }
-            _appendFlightPathSegment(_flightPolygon.coordinateList().last(), layerAltitude, _flightPolygon.coordinateList().first(), layerAltitude);
+            _appendFlightPathSegment(_flightPolygonCoords.last(), layerAltitude, _flightPolygonCoords.first(), layerAltitude);
 
             // Move to next layer altitude
             prevLayerAltitude = layerAltitude;
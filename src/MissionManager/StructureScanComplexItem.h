@@ -139,11 +139,13 @@ private:
     void    _setCameraShots                 (int cameraShots);
     double  _triggerDistance                (void) const;
 
-    QMap<QString, FactMetaData*> _metaDataMap;
+    const QMap<QString, FactMetaData*> _metaDataMap;
 
     int             _sequenceNumber;
     QGCMapPolygon   _structurePolygon;
     QGCMapPolygon   _flightPolygon;
+    QList<QGeoCoordinate> _flightPolygonCoords;     ///< _flightPolygon vertices, updated with each path change
+    double          _flightPolygonPerimeter = 0;
     int             _entryVertex;       // Polygon vertex which is used as the mission entry point
     bool            _ignoreRecalc;
     double          _scanDistance;
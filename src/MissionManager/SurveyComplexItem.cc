@@ -19,6 +19,8 @@
 #include "QGCApplication.h"
 
 #include <QPolygonF>
+#include <QGeoRectangle>
+#include <QtConcurrent>
 
 QGC_LOGGING_CATEGORY(SurveyComplexItemLog, "SurveyComplexItemLog")
 
@@ -66,11 +68,12 @@ const char* SurveyComplexItem::_jsonSplitConcavePolygonsKey =           "splitCo
 
 SurveyComplexItem::SurveyComplexItem(PlanMasterController* masterController, bool flyView, const QString& kmlOrShpFile, QObject* parent)
     : TransectStyleComplexItem  (masterController, flyView, settingsGroup, parent)
-    , _metaDataMap              (FactMetaData::createMapFromJsonFile(QStringLiteral(":/json/Survey.SettingsGroup.json"), this))
+    , _metaDataMap              (FactMetaData::sharedMapFromJsonFile(QStringLiteral(":/json/Survey.SettingsGroup.json")))
     , _gridAngleFact            (settingsGroup, _metaDataMap[gridAngleName])
     , _flyAlternateTransectsFact(settingsGroup, _metaDataMap[flyAlternateTransectsName])
     , _splitConcavePolygonsFact (settingsGroup, _metaDataMap[splitConcavePolygonsName])
     , _entryPoint               (EntryLocationTopLeft)
+    , _transectsGeneration      (new QAtomicInt(0))
 {
     _editorQml = "qrc:/qml/SurveyItemEditor.qml";
 
@@ -101,6 +104,8 @@ SurveyComplexItem::SurveyComplexItem(PlanMasterController* masterController, boo
     connect(&_splitConcavePolygonsFact, &Fact::valueChanged,                        this, &SurveyComplexItem::_rebuildTransects);
     connect(this,                       &SurveyComplexItem::refly90DegreesChanged,  this, &SurveyComplexItem::_rebuildTransects);
 
+    connect(&_transectsWatcher,         &QFutureWatcherBase::finished,              this, &SurveyComplexItem::_transectsJobFinished);
+
     connect(&_surveyAreaPolygon,        &QGCMapPolygon::isValidChanged,             this, &SurveyComplexItem::_updateWizardMode);
     connect(&_surveyAreaPolygon,        &QGCMapPolygon::traceModeChanged,           this, &SurveyComplexItem::_updateWizardMode);
 
@@ -111,6 +116,12 @@ SurveyComplexItem::SurveyComplexItem(PlanMasterController* masterController, boo
     setDirty(false);
 }
 
+SurveyComplexItem::~SurveyComplexItem()
+{
+    // A job still running holds its own reference to the generation counter, this makes it give up
+    _transectsGeneration->fetchAndAddOrdered(1);
+}
+
 void SurveyComplexItem::save(QJsonArray&  planItems)
 {
     QJsonObject saveObject;
@@ -469,7 +480,27 @@ bool SurveyComplexItem::_gridAngleIsNorthSouthTransects()
     return gridAngle < 45.0 || (gridAngle > 360.0 - 45.0) || (gridAngle > 90.0 + 45.0 && gridAngle < 270.0 - 45.0);
 }
 
-void SurveyComplexItem::_adjustTransectsToEntryPointLocation(QList<QList<QGeoCoordinate>>& transects)
+/// Converts the east/north lines to two point transects
+QList<QList<QGeoCoordinate>> SurveyComplexItem::_linesToTransects(const QList<QLineF>& lines, const QGCTangentPlane& tangentPlane)
+{
+    QList<QPointF> endPoints;
+
+    endPoints.reserve(lines.count() * 2);
+    for (const QLineF& line: lines) {
+        endPoints.append(line.p1());
+        endPoints.append(line.p2());
+    }
+
+    QList<QGeoCoordinate>           endCoords = tangentPlane.eastNorthToGeo(endPoints);
+    QList<QList<QGeoCoordinate>>    transects;
+    for (int i=0; i<endCoords.count(); i+=2) {
+        transects.append(QList<QGeoCoordinate>({ endCoords[i], endCoords[i + 1] }));
+    }
+
+    return transects;
+}
+
+void SurveyComplexItem::_adjustTransectsToEntryPointLocation(QList<QList<QGeoCoordinate>>& transects, int entryPoint)
 {
     if (transects.count() == 0) {
         return;
@@ -478,10 +509,10 @@ void SurveyComplexItem::_adjustTransectsToEntryPointLocation(QList<QList<QGeoCoo
     bool reversePoints = false;
     bool reverseTransects = false;
 
-    if (_entryPoint == EntryLocationBottomLeft || _entryPoint == EntryLocationBottomRight) {
+    if (entryPoint == EntryLocationBottomLeft || entryPoint == EntryLocationBottomRight) {
         reversePoints = true;
     }
-    if (_entryPoint == EntryLocationTopRight || _entryPoint == EntryLocationBottomRight) {
+    if (entryPoint == EntryLocationTopRight || entryPoint == EntryLocationBottomRight) {
         reverseTransects = true;
     }
 
@@ -494,7 +525,7 @@ void SurveyComplexItem::_adjustTransectsToEntryPointLocation(QList<QList<QGeoCoo
         _reverseTransectOrder(transects);
     }
 
-    qCDebug(SurveyComplexItemLog) << "_adjustTransectsToEntryPointLocation Modified entry point:entryLocation" << transects.first().first() << _entryPoint;
+    qCDebug(SurveyComplexItemLog) << "_adjustTransectsToEntryPointLocation Modified entry point:entryLocation" << transects.first().first() << entryPoint;
 }
 
 QPointF SurveyComplexItem::_rotatePoint(const QPointF& point, const QPointF& origin, double angle)
@@ -573,11 +604,15 @@ void SurveyComplexItem::_intersectLinesWithRect(const QList<QLineF>& lineList, c
     }
 }
 
-void SurveyComplexItem::_intersectLinesWithPolygon(const QList<QLineF>& lineList, const QPolygonF& polygon, QList<QLineF>& resultLines)
+void SurveyComplexItem::_intersectLinesWithPolygon(const QList<QLineF>& lineList, const QPolygonF& polygon, QList<QLineF>& resultLines, const TransectsInput_t& input)
 {
     resultLines.clear();
 
     for (int i=0; i<lineList.count(); i++) {
+        if (_transectsJobCancelled(input)) {
+            return;
+        }
+
         const QLineF& line = lineList[i];
         QList<QPointF> intersections;
 
@@ -680,60 +715,143 @@ double SurveyComplexItem::_turnaroundDistance(void) const
 
 void SurveyComplexItem::_rebuildTransectsPhase1(void)
 {
-    bool split = splitConcavePolygons()->rawValue().toBool();
-	if (split) {
-		_rebuildTransectsPhase1WorkerSplitPolygons(false /* refly */);
-	} else {
-		_rebuildTransectsPhase1WorkerSinglePolygon(false /* refly */);
-	}
-    if (_refly90DegreesFact.rawValue().toBool()) {
-    	if (split) {
-    		_rebuildTransectsPhase1WorkerSplitPolygons(true /* refly */);
-    	} else {
-    		_rebuildTransectsPhase1WorkerSinglePolygon(true /* refly */);
-    	}
+    _clearLoadedMissionItems();
+    _transects = _buildTransects(_transectsInput());
+}
+
+bool SurveyComplexItem::_rebuildTransectsPhase1Background(void)
+{
+    _clearLoadedMissionItems();
+
+    // Taking a new snapshot cancels any job still working from an older one
+    TransectsInput_t input = _transectsInput();
+    if (_transectsJobCost(input) < _backgroundRebuildMinCost) {
+        _transectsJobPending = false;
+        return false;
+    }
+
+    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1Background generation" << input.generation;
+    _transectsJobPending = true;
+    _transectsWatcher.setFuture(QtConcurrent::run(&SurveyComplexItem::_buildTransects, input));
+    return true;
+}
+
+void SurveyComplexItem::_waitForRebuildTransectsPhase1(void)
+{
+    if (_transectsJobPending) {
+        _transectsWatcher.waitForFinished();
+        _transectsJobFinished();
     }
 }
 
-void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
+void SurveyComplexItem::_transectsJobFinished(void)
 {
-    if (_ignoreRecalc) {
+    // The watcher only ever follows the latest job, anything older was dropped by setFuture
+    if (!_transectsJobPending) {
         return;
     }
+    _transectsJobPending = false;
 
+    _transects = _transectsWatcher.result();
+    _rebuildTransectsPhase2();
+}
+
+void SurveyComplexItem::_clearLoadedMissionItems(void)
+{
     // If the transects are getting rebuilt then any previously loaded mission items are now invalid
     if (_loadedMissionItemsParent) {
         _loadedMissionItems.clear();
         _loadedMissionItemsParent->deleteLater();
         _loadedMissionItemsParent = nullptr;
     }
+}
+
+SurveyComplexItem::TransectsInput_t SurveyComplexItem::_transectsInput(void)
+{
+    TransectsInput_t input;
+
+    for (int i=0; i<_surveyAreaPolygon.count(); i++) {
+        input.polygon.append(_surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(i)->coordinate());
+    }
+    input.gridAngle             = _gridAngleFact.rawValue().toDouble();
+    input.gridSpacing           = _cameraCalc.adjustedFootprintSide()->rawValue().toDouble();
+    input.refly90Degrees        = _refly90DegreesFact.rawValue().toBool();
+    input.splitConcavePolygons  = _splitConcavePolygonsFact.rawValue().toBool();
+    input.flyAlternateTransects = _flyAlternateTransectsFact.rawValue().toBool();
+    input.entryPoint            = _entryPoint;
+    input.hoverAndCapture       = triggerCamera() && hoverAndCaptureEnabled();
+    input.triggerDistance       = triggerDistance();
+    input.turnAroundDistance    = _hasTurnaround() ? _turnAroundDistanceFact.rawValue().toDouble() : 0;
+    input.generation            = _transectsGeneration->fetchAndAddOrdered(1) + 1;
+    input.currentGeneration     = _transectsGeneration;
+
+    return input;
+}
+
+/// @return Rough number of line/edge intersection tests needed to build the transects for the input
+double SurveyComplexItem::_transectsJobCost(const TransectsInput_t& input)
+{
+    if (input.polygon.count() < 3) {
+        return 0;
+    }
 
-    if (_surveyAreaPolygon.count() < 3) {
+    QGeoRectangle boundingBox(input.polygon);
+    double maxWidth = qMax(boundingBox.topLeft().distanceTo(boundingBox.topRight()), boundingBox.topLeft().distanceTo(boundingBox.bottomLeft())) + 2000.0;
+    double cost = (maxWidth / qMax(input.gridSpacing, 0.5)) * input.polygon.count() * (input.refly90Degrees ? 2 : 1);
+    if (input.splitConcavePolygons) {
+        // Convex decomposition tests every reflex vertex against every other vertex and edge
+        cost += pow(input.polygon.count(), 3);
+    }
+    return cost;
+}
+
+bool SurveyComplexItem::_transectsJobCancelled(const TransectsInput_t& input)
+{
+    return input.currentGeneration && input.currentGeneration->loadAcquire() != input.generation;
+}
+
+/// Builds the transects from the input snapshot. Runs on a worker thread so it must not touch this object.
+QList<QList<TransectStyleComplexItem::CoordInfo_t>> SurveyComplexItem::_buildTransects(const TransectsInput_t& input)
+{
+    QList<QList<CoordInfo_t>> transects;
+
+    if (input.splitConcavePolygons) {
+        _rebuildTransectsPhase1WorkerSplitPolygons(input, false /* refly */, transects);
+    } else {
+        _rebuildTransectsPhase1WorkerSinglePolygon(input, false /* refly */, transects);
+    }
+    if (input.refly90Degrees && !_transectsJobCancelled(input)) {
+        if (input.splitConcavePolygons) {
+            _rebuildTransectsPhase1WorkerSplitPolygons(input, true /* refly */, transects);
+        } else {
+            _rebuildTransectsPhase1WorkerSinglePolygon(input, true /* refly */, transects);
+        }
+    }
+
+    return transects;
+}
+
+void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(const TransectsInput_t& input, bool refly, QList<QList<CoordInfo_t>>& coordInfoTransects)
+{
+    if (input.polygon.count() < 3) {
         return;
     }
 
     // Convert polygon to NED
 
-    QList<QPointF> polygonPoints;
-    QGeoCoordinate tangentOrigin = _surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(0)->coordinate();
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Convert polygon to NED - _surveyAreaPolygon.count():tangentOrigin" << _surveyAreaPolygon.count() << tangentOrigin;
-    for (int i=0; i<_surveyAreaPolygon.count(); i++) {
-        double y, x, down;
-        QGeoCoordinate vertex = _surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(i)->coordinate();
-        if (i == 0) {
-            // This avoids a nan calculation that comes out of convertGeoToNed
-            x = y = 0;
-        } else {
-            convertGeoToNed(vertex, tangentOrigin, &y, &x, &down);
+    QGCTangentPlane tangentPlane(input.polygon[0]);
+    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Convert polygon to NED - polygon.count():tangentOrigin" << input.polygon.count() << tangentPlane.origin();
+    QList<QPointF> polygonPoints = tangentPlane.geoToEastNorth(input.polygon);
+    if (SurveyComplexItemLog().isDebugEnabled()) {
+        for (int i=0; i<input.polygon.count(); i++) {
+            qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 vertex:x:y" << input.polygon[i] << polygonPoints[i].x() << polygonPoints[i].y();
         }
-        polygonPoints += QPointF(x, y);
-        qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 vertex:x:y" << vertex << polygonPoints.last().x() << polygonPoints.last().y();
     }
 
     // Generate transects
 
-    double gridAngle = _gridAngleFact.rawValue().toDouble();
-    double gridSpacing = _cameraCalc.adjustedFootprintSide()->rawValue().toDouble();
+    double gridAngle = input.gridAngle;
+    double gridSpacing = input.gridSpacing;
     if (gridSpacing < 0.5) {
         // We can't let gridSpacing get too small otherwise we will end up with too many transects.
         // So we limit to 0.5 meter spacing as min and set to huge value which will cause a single
@@ -783,7 +901,7 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
     // Now intersect the lines with the polygon
     QList<QLineF> intersectLines;
 #if 1
-    _intersectLinesWithPolygon(lineList, polygon, intersectLines);
+    _intersectLinesWithPolygon(lineList, polygon, intersectLines, input);
 #else
     // This is handy for debugging grid problems, not for release
     intersectLines = lineList;
@@ -793,7 +911,6 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
     //      Create a single transect which goes through the center of the polygon
     //      Intersect it with the polygon
     if (intersectLines.count() < 2) {
-        _surveyAreaPolygon.center();
         QLineF firstLine = lineList.first();
         QPointF lineCenter = firstLine.pointAt(0.5);
         QPointF centerOffset = boundingCenter - lineCenter;
@@ -801,7 +918,11 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
         lineList.clear();
         lineList.append(firstLine);
         intersectLines = lineList;
-        _intersectLinesWithPolygon(lineList, polygon, intersectLines);
+        _intersectLinesWithPolygon(lineList, polygon, intersectLines, input);
+    }
+
+    if (_transectsJobCancelled(input)) {
+        return;
     }
 
     // Make sure all lines are going the same direction. Polygon intersection leads to lines which
@@ -809,27 +930,16 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
     QList<QLineF> resultLines;
     _adjustLineDirection(intersectLines, resultLines);
 
-    // Convert from NED to Geo
-    QList<QList<QGeoCoordinate>> transects;
-    for (const QLineF& line : resultLines) {
-        QGeoCoordinate          coord;
-        QList<QGeoCoordinate>   transect;
+    // Convert from NED to Geo, all the end points in one batch
+    QList<QList<QGeoCoordinate>> transects = _linesToTransects(resultLines, tangentPlane);
 
-        convertNedToGeo(line.p1().y(), line.p1().x(), 0, tangentOrigin, &coord);
-        transect.append(coord);
-        convertNedToGeo(line.p2().y(), line.p2().x(), 0, tangentOrigin, &coord);
-        transect.append(coord);
+    _adjustTransectsToEntryPointLocation(transects, input.entryPoint);
 
-        transects.append(transect);
+    if (refly && coordInfoTransects.count() && transects.count()) {
+        _optimizeTransectsForShortestDistance(coordInfoTransects.last().last().coord, transects);
     }
 
-    _adjustTransectsToEntryPointLocation(transects);
-
-    if (refly) {
-        _optimizeTransectsForShortestDistance(_transects.last().last().coord, transects);
-    }
-
-    if (_flyAlternateTransectsFact.rawValue().toBool()) {
+    if (input.flyAlternateTransects) {
         QList<QList<QGeoCoordinate>> alternatingTransects;
         for (int i=0; i<transects.count(); i++) {
             if (!(i & 1)) {
@@ -874,14 +984,14 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
         coordInfoTransect.append(coordInfo);
 
         // For hover and capture we need points for each camera location within the transect
-        if (triggerCamera() && hoverAndCaptureEnabled()) {
+        if (input.hoverAndCapture) {
             double transectLength = transect[0].distanceTo(transect[1]);
             double transectAzimuth = transect[0].azimuthTo(transect[1]);
-            if (triggerDistance() < transectLength) {
-                int cInnerHoverPoints = static_cast<int>(floor(transectLength / triggerDistance()));
+            if (input.triggerDistance < transectLength) {
+                int cInnerHoverPoints = static_cast<int>(floor(transectLength / input.triggerDistance));
                 qCDebug(SurveyComplexItemLog) << "cInnerHoverPoints" << cInnerHoverPoints;
                 for (int i=0; i<cInnerHoverPoints; i++) {
-                    QGeoCoordinate hoverCoord = transect[0].atDistanceAndAzimuth(triggerDistance() * (i + 1), transectAzimuth);
+                    QGeoCoordinate hoverCoord = transect[0].atDistanceAndAzimuth(input.triggerDistance * (i + 1), transectAzimuth);
                     TransectStyleComplexItem::CoordInfo_t coordInfo = { hoverCoord, CoordTypeInteriorHoverTrigger };
                     coordInfoTransect.insert(1 + i, coordInfo);
                 }
@@ -889,9 +999,9 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
         }
 
         // Extend the transect ends for turnaround
-        if (_hasTurnaround()) {
+        if (input.turnAroundDistance > 0) {
             QGeoCoordinate turnaroundCoord;
-            double turnAroundDistance = _turnAroundDistanceFact.rawValue().toDouble();
+            double turnAroundDistance = input.turnAroundDistance;
 
             double azimuth = transect[0].azimuthTo(transect[1]);
             turnaroundCoord = transect[0].atDistanceAndAzimuth(-turnAroundDistance, azimuth);
@@ -906,44 +1016,26 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSinglePolygon(bool refly)
             coordInfoTransect.append(coordInfo);
         }
 
-        _transects.append(coordInfoTransect);
+        coordInfoTransects.append(coordInfoTransect);
     }
 }
 
 
-void SurveyComplexItem::_rebuildTransectsPhase1WorkerSplitPolygons(bool refly)
+void SurveyComplexItem::_rebuildTransectsPhase1WorkerSplitPolygons(const TransectsInput_t& input, bool refly, QList<QList<CoordInfo_t>>& coordInfoTransects)
 {
-    if (_ignoreRecalc) {
-        return;
-    }
-
-    // If the transects are getting rebuilt then any previously loaded mission items are now invalid
-    if (_loadedMissionItemsParent) {
-        _loadedMissionItems.clear();
-        _loadedMissionItemsParent->deleteLater();
-        _loadedMissionItemsParent = nullptr;
-    }
-
-    if (_surveyAreaPolygon.count() < 3) {
+    if (input.polygon.count() < 3) {
         return;
     }
 
     // Convert polygon to NED
 
-    QList<QPointF> polygonPoints;
-    QGeoCoordinate tangentOrigin = _surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(0)->coordinate();
-    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Convert polygon to NED - _surveyAreaPolygon.count():tangentOrigin" << _surveyAreaPolygon.count() << tangentOrigin;
-    for (int i=0; i<_surveyAreaPolygon.count(); i++) {
-        double y, x, down;
-        QGeoCoordinate vertex = _surveyAreaPolygon.pathModel().value<QGCQGeoCoordinate*>(i)->coordinate();
-        if (i == 0) {
-            // This avoids a nan calculation that comes out of convertGeoToNed
-            x = y = 0;
-        } else {
-            convertGeoToNed(vertex, tangentOrigin, &y, &x, &down);
+    QGCTangentPlane tangentPlane(input.polygon[0]);
+    qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 Convert polygon to NED - polygon.count():tangentOrigin" << input.polygon.count() << tangentPlane.origin();
+    QList<QPointF> polygonPoints = tangentPlane.geoToEastNorth(input.polygon);
+    if (SurveyComplexItemLog().isDebugEnabled()) {
+        for (int i=0; i<input.polygon.count(); i++) {
+            qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 vertex:x:y" << input.polygon[i] << polygonPoints[i].x() << polygonPoints[i].y();
         }
-        polygonPoints += QPointF(x, y);
-        qCDebug(SurveyComplexItemLog) << "_rebuildTransectsPhase1 vertex:x:y" << vertex << polygonPoints.last().x() << polygonPoints.last().y();
     }
 
     // convert into QPolygonF
@@ -955,11 +1047,13 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSplitPolygons(bool refly)
 
     // Create list of separate polygons
     QList<QPolygonF> polygons{};
-    _PolygonDecomposeConvex(polygon, polygons);
+    _PolygonDecomposeConvex(polygon, polygons, input);
 
-    // iterate over polygons
+    // Find the vertex shared with the previous polygon, used as the transition point into each polygon
+    QList<QPointF>  transitionPoints;
+    QList<bool>     hasTransitionPoint;
     for (auto p = polygons.begin(); p != polygons.end(); ++p) {
-        QPointF* vMatch = nullptr;
+        const QPointF* vMatch = nullptr;
         // find matching vertex in previous polygon
         if (p != polygons.begin()) {
             auto pLast = p - 1;
@@ -974,19 +1068,42 @@ void SurveyComplexItem::_rebuildTransectsPhase1WorkerSplitPolygons(bool refly)
             }
 
         }
-
+        transitionPoints.append(vMatch ? *vMatch : QPointF());
+        hasTransitionPoint.append(vMatch != nullptr);
 
         // close polygon
         *p << p->front();
-        // build transects for this polygon
+    }
+
+    // The transect lines for each polygon are independent of each other so they are generated concurrently. Turning them
+    // into coordinates depends on the transects before them (refly direction), that part runs in polygon order so the
+    // result is the same as generating them one after the other.
+    QList<QList<QLineF>> polygonLines;
+    if (polygons.count() > 1) {
+        QList<QFuture<QList<QLineF>>> futures;
+        for (const QPolygonF& polygon: polygons) {
+            futures.append(QtConcurrent::run(&SurveyComplexItem::_polygonTransectLines, input, refly, polygon));
+        }
+        for (QFuture<QList<QLineF>>& future: futures) {
+            polygonLines.append(future.result());
+        }
+    } else {
+        for (const QPolygonF& polygon: polygons) {
+            polygonLines.append(_polygonTransectLines(input, refly, polygon));
+        }
+    }
+
+    for (int i=0; i<polygons.count(); i++) {
+        if (_transectsJobCancelled(input)) {
+            return;
+        }
         // TODO figure out tangent origin
         // TODO improve selection of entry points
-//        qCDebug(SurveyComplexItemLog) << "Transects from polynom p " << p;
-        _rebuildTransectsFromPolygon(refly, *p, tangentOrigin, vMatch);
+        _rebuildTransectsFromPolygon(input, refly, polygonLines[i], tangentPlane, hasTransitionPoint[i] ? &transitionPoints[i] : nullptr, coordInfoTransects);
     }
 }
 
-void SurveyComplexItem::_PolygonDecomposeConvex(const QPolygonF& polygon, QList<QPolygonF>& decomposedPolygons)
+void SurveyComplexItem::_PolygonDecomposeConvex(const QPolygonF& polygon, QList<QPolygonF>& decomposedPolygons, const TransectsInput_t& input)
 {
 	// this follows "Mark Keil's Algorithm" https://mpen.ca/406/keil
     int decompSize = std::numeric_limits<int>::max();
@@ -1000,6 +1117,10 @@ void SurveyComplexItem::_PolygonDecomposeConvex(const QPolygonF& polygon, QList<
 
     for (auto vertex = polygon.begin(); vertex != polygon.end(); ++vertex)
     {
+        if (_transectsJobCancelled(input)) {
+            break;
+        }
+
         // is vertex reflex?
         bool vertexIsReflex = _VertexIsReflex(polygon, vertex);
 
@@ -1050,10 +1171,10 @@ void SurveyComplexItem::_PolygonDecomposeConvex(const QPolygonF& polygon, QList<
 
             // recursion
             QList<QPolygonF> polyLeftDecomposed{};
-            _PolygonDecomposeConvex(polyLeft, polyLeftDecomposed);
+            _PolygonDecomposeConvex(polyLeft, polyLeftDecomposed, input);
 
             QList<QPolygonF> polyRightDecomposed{};
-            _PolygonDecomposeConvex(polyRight, polyRightDecomposed);
+            _PolygonDecomposeConvex(polyRight, polyRightDecomposed, input);
 
             // compositon
             auto subSize = polyLeftDecomposed.size() + polyRightDecomposed.size();
@@ -1138,12 +1259,14 @@ bool SurveyComplexItem::_VertexIsReflex(const QPolygonF& polygon, const QPointF*
 }
 
 
-void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF& polygon, const QGeoCoordinate& tangentOrigin, const QPointF* const transitionPoint)
+/// Generates the transect lines in NED for one polygon. Touches nothing but its arguments so the polygons from a split
+/// survey can be done concurrently.
+QList<QLineF> SurveyComplexItem::_polygonTransectLines(const TransectsInput_t& input, bool refly, const QPolygonF& polygon)
 {
     // Generate transects
 
-    double gridAngle = _gridAngleFact.rawValue().toDouble();
-    double gridSpacing = _cameraCalc.adjustedFootprintSide()->rawValue().toDouble();
+    double gridAngle = input.gridAngle;
+    double gridSpacing = input.gridSpacing;
 
     gridAngle = _clampGridAngle90(gridAngle);
     gridAngle += refly ? 90 : 0;
@@ -1181,7 +1304,7 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
     // Now intersect the lines with the polygon
     QList<QLineF> intersectLines;
 #if 1
-    _intersectLinesWithPolygon(lineList, polygon, intersectLines);
+    _intersectLinesWithPolygon(lineList, polygon, intersectLines, input);
 #else
     // This is handy for debugging grid problems, not for release
     intersectLines = lineList;
@@ -1191,7 +1314,6 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
     //      Create a single transect which goes through the center of the polygon
     //      Intersect it with the polygon
     if (intersectLines.count() < 2) {
-        _surveyAreaPolygon.center();
         QLineF firstLine = lineList.first();
         QPointF lineCenter = firstLine.pointAt(0.5);
         QPointF centerOffset = boundingCenter - lineCenter;
@@ -1199,13 +1321,21 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
         lineList.clear();
         lineList.append(firstLine);
         intersectLines = lineList;
-        _intersectLinesWithPolygon(lineList, polygon, intersectLines);
+        _intersectLinesWithPolygon(lineList, polygon, intersectLines, input);
     }
 
     // Make sure all lines are going the same direction. Polygon intersection leads to lines which
     // can be in varied directions depending on the order of the intesecting sides.
     QList<QLineF> resultLines;
-    _adjustLineDirection(intersectLines, resultLines);
+    if (!_transectsJobCancelled(input)) {
+        _adjustLineDirection(intersectLines, resultLines);
+    }
+
+    return resultLines;
+}
+
+void SurveyComplexItem::_rebuildTransectsFromPolygon(const TransectsInput_t& input, bool refly, const QList<QLineF>& resultLines, const QGCTangentPlane& tangentPlane, const QPointF* const transitionPoint, QList<QList<CoordInfo_t>>& coordInfoTransects)
+{
 
     // Convert from NED to Geo
     QList<QList<QGeoCoordinate>> transects;
@@ -1213,31 +1343,21 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
     if (transitionPoint != nullptr) {
         QList<QGeoCoordinate>   transect;
         QGeoCoordinate          coord;
-        convertNedToGeo(transitionPoint->y(), transitionPoint->x(), 0, tangentOrigin, &coord);
+        tangentPlane.nedToGeo(transitionPoint->y(), transitionPoint->x(), 0, &coord);
         transect.append(coord);
         transect.append(coord); //TODO
         transects.append(transect);
     }
 
-    for (const QLineF& line: resultLines) {
-        QList<QGeoCoordinate>   transect;
-        QGeoCoordinate          coord;
-
-        convertNedToGeo(line.p1().y(), line.p1().x(), 0, tangentOrigin, &coord);
-        transect.append(coord);
-        convertNedToGeo(line.p2().y(), line.p2().x(), 0, tangentOrigin, &coord);
-        transect.append(coord);
-
-        transects.append(transect);
-    }
+    transects.append(_linesToTransects(resultLines, tangentPlane));
 
-    _adjustTransectsToEntryPointLocation(transects);
+    _adjustTransectsToEntryPointLocation(transects, input.entryPoint);
 
-    if (refly) {
-        _optimizeTransectsForShortestDistance(_transects.last().last().coord, transects);
+    if (refly && coordInfoTransects.count() && transects.count()) {
+        _optimizeTransectsForShortestDistance(coordInfoTransects.last().last().coord, transects);
     }
 
-    if (_flyAlternateTransectsFact.rawValue().toBool()) {
+    if (input.flyAlternateTransects) {
         QList<QList<QGeoCoordinate>> alternatingTransects;
         for (int i=0; i<transects.count(); i++) {
             if (!(i & 1)) {
@@ -1282,14 +1402,14 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
         coordInfoTransect.append(coordInfo);
 
         // For hover and capture we need points for each camera location within the transect
-        if (triggerCamera() && hoverAndCaptureEnabled()) {
+        if (input.hoverAndCapture) {
             double transectLength = transect[0].distanceTo(transect[1]);
             double transectAzimuth = transect[0].azimuthTo(transect[1]);
-            if (triggerDistance() < transectLength) {
-                int cInnerHoverPoints = static_cast<int>(floor(transectLength / triggerDistance()));
+            if (input.triggerDistance < transectLength) {
+                int cInnerHoverPoints = static_cast<int>(floor(transectLength / input.triggerDistance));
                 qCDebug(SurveyComplexItemLog) << "cInnerHoverPoints" << cInnerHoverPoints;
                 for (int i=0; i<cInnerHoverPoints; i++) {
-                    QGeoCoordinate hoverCoord = transect[0].atDistanceAndAzimuth(triggerDistance() * (i + 1), transectAzimuth);
+                    QGeoCoordinate hoverCoord = transect[0].atDistanceAndAzimuth(input.triggerDistance * (i + 1), transectAzimuth);
                     TransectStyleComplexItem::CoordInfo_t coordInfo = { hoverCoord, CoordTypeInteriorHoverTrigger };
                     coordInfoTransect.insert(1 + i, coordInfo);
                 }
@@ -1297,9 +1417,9 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
         }
 
         // Extend the transect ends for turnaround
-        if (_hasTurnaround()) {
+        if (input.turnAroundDistance > 0) {
             QGeoCoordinate turnaroundCoord;
-            double turnAroundDistance = _turnAroundDistanceFact.rawValue().toDouble();
+            double turnAroundDistance = input.turnAroundDistance;
 
             double azimuth = transect[0].azimuthTo(transect[1]);
             turnaroundCoord = transect[0].atDistanceAndAzimuth(-turnAroundDistance, azimuth);
@@ -1314,9 +1434,9 @@ void SurveyComplexItem::_rebuildTransectsFromPolygon(bool refly, const QPolygonF
             coordInfoTransect.append(coordInfo);
         }
 
-        _transects.append(coordInfoTransect);
+        coordInfoTransects.append(coordInfoTransect);
     }
-    qCDebug(SurveyComplexItemLog) << "_transects.size() " << _transects.size();
+    qCDebug(SurveyComplexItemLog) << "_transects.size() " << coordInfoTransects.size();
 }
 
 void SurveyComplexItem::_recalcCameraShots(void)
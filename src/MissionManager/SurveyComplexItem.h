@@ -14,9 +14,14 @@
 #include "SettingsFact.h"
 #include "QGCLoggingCategory.h"
 
+#include <QFutureWatcher>
+#include <QSharedPointer>
+#include <QAtomicInt>
+
 Q_DECLARE_LOGGING_CATEGORY(SurveyComplexItemLog)
 
 class PlanMasterController;
+class QGCTangentPlane;
 
 class SurveyComplexItem : public TransectStyleComplexItem
 {
@@ -26,6 +31,7 @@ public:
     /// @param flyView true: Created for use in the Fly View, false: Created for use in the Plan View
     /// @param kmlOrShpFile Polygon comes from this file, empty for default polygon
     SurveyComplexItem(PlanMasterController* masterController, bool flyView, const QString& kmlOrShpFile, QObject* parent);
+    ~SurveyComplexItem();
 
     Q_PROPERTY(Fact* gridAngle              READ gridAngle              CONSTANT)
     Q_PROPERTY(Fact* flyAlternateTransects  READ flyAlternateTransects  CONSTANT)
@@ -45,6 +51,9 @@ public:
     void    savePreset          (const QString& name);
     void    loadPreset          (const QString& name);
 
+    // Used internally only by unit tests
+    void _setBackgroundRebuildMinCost(double cost) { _backgroundRebuildMinCost = cost; }
+
     // Overrides from TransectStyleComplexItem
     void    save                (QJsonArray&  planItems) final;
     bool    specifiesCoordinate (void) const final { return true; }
@@ -88,6 +97,8 @@ private slots:
     void _rebuildTransectsPhase1        (void) final;
     void _recalcCameraShots             (void) final;
 
+    void _transectsJobFinished          (void);
+
 private:
     enum CameraTriggerCode {
         CameraTriggerNone,
@@ -96,21 +107,49 @@ private:
         CameraTriggerHoverAndCapture
     };
 
-    QPointF _rotatePoint(const QPointF& point, const QPointF& origin, double angle);
+    /// Immutable copy of everything transect generation depends on so it can run away from the gui thread
+    typedef struct {
+        QList<QGeoCoordinate>       polygon;
+        double                      gridAngle;
+        double                      gridSpacing;
+        bool                        refly90Degrees;
+        bool                        splitConcavePolygons;
+        bool                        flyAlternateTransects;
+        int                         entryPoint;
+        bool                        hoverAndCapture;        ///< Camera triggering with hover and capture enabled
+        double                      triggerDistance;
+        double                      turnAroundDistance;     ///< 0 for no turnaround
+        int                         generation;             ///< Job is stale once currentGeneration no longer matches
+        QSharedPointer<QAtomicInt>  currentGeneration;
+    } TransectsInput_t;
+
+    // Overrides from TransectStyleComplexItem
+    bool _rebuildTransectsPhase1Background  (void) final;
+    void _waitForRebuildTransectsPhase1     (void) final;
+
+    void                _clearLoadedMissionItems(void);
+    TransectsInput_t    _transectsInput         (void);
+
+    static double                       _transectsJobCost       (const TransectsInput_t& input);
+    static bool                         _transectsJobCancelled  (const TransectsInput_t& input);
+    static QList<QList<CoordInfo_t>>    _buildTransects         (const TransectsInput_t& input);
+
+    static QPointF _rotatePoint(const QPointF& point, const QPointF& origin, double angle);
     void _intersectLinesWithRect(const QList<QLineF>& lineList, const QRectF& boundRect, QList<QLineF>& resultLines);
-    void _intersectLinesWithPolygon(const QList<QLineF>& lineList, const QPolygonF& polygon, QList<QLineF>& resultLines);
-    void _adjustLineDirection(const QList<QLineF>& lineList, QList<QLineF>& resultLines);
+    static void _intersectLinesWithPolygon(const QList<QLineF>& lineList, const QPolygonF& polygon, QList<QLineF>& resultLines, const TransectsInput_t& input);
+    static void _adjustLineDirection(const QList<QLineF>& lineList, QList<QLineF>& resultLines);
     bool _nextTransectCoord(const QList<QGeoCoordinate>& transectPoints, int pointIndex, QGeoCoordinate& coord);
     bool _appendMissionItemsWorker(QList<MissionItem*>& items, QObject* missionItemParent, int& seqNum, bool hasRefly, bool buildRefly);
-    void _optimizeTransectsForShortestDistance(const QGeoCoordinate& distanceCoord, QList<QList<QGeoCoordinate>>& transects);
+    static void _optimizeTransectsForShortestDistance(const QGeoCoordinate& distanceCoord, QList<QList<QGeoCoordinate>>& transects);
     qreal _ccw(QPointF pt1, QPointF pt2, QPointF pt3);
     qreal _dp(QPointF pt1, QPointF pt2);
     void _swapPoints(QList<QPointF>& points, int index1, int index2);
-    void _reverseTransectOrder(QList<QList<QGeoCoordinate>>& transects);
-    void _reverseInternalTransectPoints(QList<QList<QGeoCoordinate>>& transects);
-    void _adjustTransectsToEntryPointLocation(QList<QList<QGeoCoordinate>>& transects);
+    static void _reverseTransectOrder(QList<QList<QGeoCoordinate>>& transects);
+    static void _reverseInternalTransectPoints(QList<QList<QGeoCoordinate>>& transects);
+    static void _adjustTransectsToEntryPointLocation(QList<QList<QGeoCoordinate>>& transects, int entryPoint);
+    static QList<QList<QGeoCoordinate>> _linesToTransects(const QList<QLineF>& lines, const QGCTangentPlane& tangentPlane);
     bool _gridAngleIsNorthSouthTransects();
-    double _clampGridAngle90(double gridAngle);
+    static double _clampGridAngle90(double gridAngle);
     bool _imagesEverywhere(void) const;
     bool _triggerCamera(void) const;
     bool _hasTurnaround(void) const;
@@ -119,24 +158,29 @@ private:
     bool _loadV3(const QJsonObject& complexObject, int sequenceNumber, QString& errorString);
     bool _loadV4V5(const QJsonObject& complexObject, int sequenceNumber, QString& errorString, int version, bool forPresets);
     void _saveWorker(QJsonObject& complexObject);
-    void _rebuildTransectsPhase1Worker(bool refly);
-    void _rebuildTransectsPhase1WorkerSinglePolygon(bool refly);
-    void _rebuildTransectsPhase1WorkerSplitPolygons(bool refly);
-    /// Adds to the _transects array from one polygon
-    void _rebuildTransectsFromPolygon(bool refly, const QPolygonF& polygon, const QGeoCoordinate& tangentOrigin, const QPointF* const transitionPoint);
+    static void _rebuildTransectsPhase1WorkerSinglePolygon(const TransectsInput_t& input, bool refly, QList<QList<CoordInfo_t>>& coordInfoTransects);
+    static void _rebuildTransectsPhase1WorkerSplitPolygons(const TransectsInput_t& input, bool refly, QList<QList<CoordInfo_t>>& coordInfoTransects);
+    static QList<QLineF> _polygonTransectLines(const TransectsInput_t& input, bool refly, const QPolygonF& polygon);
+    /// Adds to the coordInfoTransects array from the transect lines of one polygon
+    static void _rebuildTransectsFromPolygon(const TransectsInput_t& input, bool refly, const QList<QLineF>& resultLines, const QGCTangentPlane& tangentPlane, const QPointF* const transitionPoint, QList<QList<CoordInfo_t>>& coordInfoTransects);
     // Decompose polygon into list of convex sub polygons
-    void _PolygonDecomposeConvex(const QPolygonF& polygon, QList<QPolygonF>& decomposedPolygons);
+    static void _PolygonDecomposeConvex(const QPolygonF& polygon, QList<QPolygonF>& decomposedPolygons, const TransectsInput_t& input);
     // return true if vertex a can see vertex b
-    bool _VertexCanSeeOther(const QPolygonF& polygon, const QPointF* vertexA, const QPointF* vertexB);
-    bool _VertexIsReflex(const QPolygonF& polygon, const QPointF* vertex);
+    static bool _VertexCanSeeOther(const QPolygonF& polygon, const QPointF* vertexA, const QPointF* vertexB);
+    static bool _VertexIsReflex(const QPolygonF& polygon, const QPointF* vertex);
 
-    QMap<QString, FactMetaData*> _metaDataMap;
+    const QMap<QString, FactMetaData*> _metaDataMap;
 
     SettingsFact    _gridAngleFact;
     SettingsFact    _flyAlternateTransectsFact;
     SettingsFact    _splitConcavePolygonsFact;
     int             _entryPoint;
 
+    QSharedPointer<QAtomicInt>              _transectsGeneration;
+    QFutureWatcher<QList<QList<CoordInfo_t>>> _transectsWatcher;
+    bool                                    _transectsJobPending =      false;
+    double                                  _backgroundRebuildMinCost = 250000;   ///< Smaller rebuilds run synchronously
+
     static const char* _jsonGridAngleKey;
     static const char* _jsonEntryPointKey;
     static const char* _jsonFlyAlternateTransectsKey;
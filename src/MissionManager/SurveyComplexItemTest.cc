@@ -351,3 +351,61 @@ void SurveyComplexItemTest::_testHoverCaptureItemGeneration(void)
     _testItemGenerationWorker(false /* imagesInTurnaround */, true /* hasTurnaround */, true /* useConditionGate */, expectedCommands);
     _testItemGenerationWorker(false /* imagesInTurnaround */, true /* hasTurnaround */, false /* useConditionGate */, expectedCommands);
 }
+
+void SurveyComplexItemTest::_testBackgroundRebuild(void)
+{
+    // Push every rebuild into the background
+    _surveyItem->_setBackgroundRebuildMinCost(0);
+
+    QSignalSpy visualTransectPointsSpy(_surveyItem, &TransectStyleComplexItem::visualTransectPointsChanged);
+    int expectedTransectCount = _expectedTransectCount;
+
+    // The first job is stale as soon as the second one starts, only the second one publishes
+    _surveyItem->gridAngle()->setRawValue(45);
+    _surveyItem->gridAngle()->setRawValue(90);
+    QCOMPARE(visualTransectPointsSpy.count(), 0);
+    QVERIFY(visualTransectPointsSpy.wait(5000));
+    QTest::qWait(100);
+    QCOMPARE(visualTransectPointsSpy.count(), 1);
+    QCOMPARE(_surveyItem->_transectCount(), expectedTransectCount);
+
+    // Building mission items must wait for the pending job instead of using the old transects
+    visualTransectPointsSpy.clear();
+    _surveyItem->gridAngle()->setRawValue(0);
+    QObject missionItemParent;
+    QList<MissionItem*> missionItems;
+    _surveyItem->appendMissionItems(missionItems, &missionItemParent);
+    QCOMPARE(visualTransectPointsSpy.count(), 1);
+    QTest::qWait(100);
+    QCOMPARE(visualTransectPointsSpy.count(), 1);
+    QCOMPARE(_surveyItem->_transectCount(), expectedTransectCount);
+}
+
+void SurveyComplexItemTest::_testVisualTransectPointsSignalling(void)
+{
+    QSignalSpy visualTransectPointsSpy(_surveyItem, &TransectStyleComplexItem::visualTransectPointsChanged);
+    QSignalSpy cameraShotsSpy(_surveyItem, &SurveyComplexItem::cameraShotsChanged);
+
+    // The frontal footprint only changes the trigger distance, the rebuilt transects are the same
+    Fact* frontalFootprint = _surveyItem->cameraCalc()->adjustedFootprintFrontal();
+    frontalFootprint->setRawValue(frontalFootprint->rawValue().toDouble() * 2);
+    QVERIFY(cameraShotsSpy.count() > 0);
+    QCOMPARE(visualTransectPointsSpy.count(), 0);
+
+    _surveyItem->gridAngle()->setRawValue(45);
+    QCOMPARE(visualTransectPointsSpy.count(), 1);
+}
+
+void SurveyComplexItemTest::_testSharedMetaData(void)
+{
+    SurveyComplexItem otherItem(_masterController, false /* flyView */, QString() /* kmlFile */, this /* parent */);
+
+    // Meta data comes from the same parsed json, values are still per item
+    QCOMPARE(otherItem.gridAngle()->metaData(), _surveyItem->gridAngle()->metaData());
+    QCOMPARE(otherItem.turnAroundDistance()->metaData(), _surveyItem->turnAroundDistance()->metaData());
+    QCOMPARE(otherItem.cameraCalc()->adjustedFootprintSide()->metaData(), _surveyItem->cameraCalc()->adjustedFootprintSide()->metaData());
+
+    _surveyItem->gridAngle()->setRawValue(10);
+    otherItem.gridAngle()->setRawValue(20);
+    QCOMPARE(_surveyItem->gridAngle()->rawValue().toDouble(), 10.0);
+}
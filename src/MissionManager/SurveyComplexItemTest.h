@@ -37,6 +37,9 @@ private slots:
     void _testItemGeneration(void);
     void _testItemCount(void);
     void _testHoverCaptureItemGeneration(void);
+    void _testBackgroundRebuild(void);
+    void _testVisualTransectPointsSignalling(void);
+    void _testSharedMetaData(void);
 #else
     // Handy mechanism to to a single test
 private slots:
@@ -47,6 +50,9 @@ private:
     void _testEntryLocation(void);
     void _testItemGeneration(void);
     void _testHoverCaptureItemGeneration(void);
+    void _testBackgroundRebuild(void);
+    void _testVisualTransectPointsSignalling(void);
+    void _testSharedMetaData(void);
 #endif
 
 private:
@@ -45,7 +45,7 @@ const char* TransectStyleComplexItem::_jsonCameraShotsKey =                 "Cam
 TransectStyleComplexItem::TransectStyleComplexItem(PlanMasterController* masterController, bool flyView, QString settingsGroup, QObject* parent)
     : ComplexMissionItem                (masterController, flyView, parent)
     , _cameraCalc                       (masterController, settingsGroup)
-    , _metaDataMap                      (FactMetaData::createMapFromJsonFile(QStringLiteral(":/json/TransectStyle.SettingsGroup.json"), this))
+    , _metaDataMap                      (FactMetaData::sharedMapFromJsonFile(QStringLiteral(":/json/TransectStyle.SettingsGroup.json")))
     , _turnAroundDistanceFact           (settingsGroup, _metaDataMap[_controllerVehicle->multiRotor() ? turnAroundDistanceMultiRotorName : turnAroundDistanceName])
     , _cameraTriggerInTurnAroundFact    (settingsGroup, _metaDataMap[cameraTriggerInTurnAroundName])
     , _hoverAndCaptureFact              (settingsGroup, _metaDataMap[hoverAndCaptureName])
@@ -152,6 +152,9 @@ void TransectStyleComplexItem::setDirty(bool dirty)
 
 void TransectStyleComplexItem::_save(QJsonObject& complexObject)
 {
+    // The visual transect points and mission items saved below must come from the latest transects
+    _waitForRebuildTransectsPhase1();
+
     QJsonObject innerObject;
 
     innerObject[JsonHelper::jsonVersionKey] =       1;
@@ -368,6 +371,19 @@ void TransectStyleComplexItem::_updateCoordinateAltitudes(void)
     emit exitCoordinateChanged(exitCoordinate());
 }
 
+bool TransectStyleComplexItem::_sameCoordinates(const QVariantList& list1, const QVariantList& list2)
+{
+    if (list1.count() != list2.count()) {
+        return false;
+    }
+    for (int i=0; i<list1.count(); i++) {
+        if (list1[i].value<QGeoCoordinate>() != list2[i].value<QGeoCoordinate>()) {
+            return false;
+        }
+    }
+    return true;
+}
+
 double TransectStyleComplexItem::coveredArea(void) const
 {
     return _surveyAreaPolygon.area();
@@ -394,12 +410,21 @@ void TransectStyleComplexItem::_rebuildTransects(void)
         return;
     }
 
+    if (_rebuildTransectsPhase1Background()) {
+        // The current _transects stay in place until the new ones are published, phase 2 runs at that point
+        return;
+    }
+
     _transects.clear();
+    _rebuildTransectsPhase1();
+    _rebuildTransectsPhase2();
+}
+
+void TransectStyleComplexItem::_rebuildTransectsPhase2(void)
+{
     _rgPathHeightInfo.clear();
     _rgFlightPathCoordInfo.clear();
 
-    _rebuildTransectsPhase1();
-
     _minAMSLAltitude = _maxAMSLAltitude = qQNaN();
 
     if (_followTerrain) {
@@ -418,10 +443,10 @@ void TransectStyleComplexItem::_rebuildTransects(void)
     double bottom = 100000.;
     double top = 0.;
     // Generate the visuals transect representation
-    _visualTransectPoints.clear();
+    QVariantList visualTransectPoints;
     for (const QList<CoordInfo_t>& transect: _transects) {
         for (const CoordInfo_t& coordInfo: transect) {
-            _visualTransectPoints.append(QVariant::fromValue(coordInfo.coord));
+            visualTransectPoints.append(QVariant::fromValue(coordInfo.coord));
             double lat = coordInfo.coord.latitude()  + 90.0;
             double lon = coordInfo.coord.longitude() + 180.0;
             north   = fmax(north, lat);
@@ -436,7 +461,12 @@ void TransectStyleComplexItem::_rebuildTransects(void)
     _setBoundingCube(QGCGeoBoundingCube(
                          QGeoCoordinate(north - 90.0, west - 180.0, bottom),
                          QGeoCoordinate(south - 90.0, east - 180.0, top)));
-    emit visualTransectPointsChanged();
+
+    // QML converts the whole list each time it is signalled, skip that when a rebuild produced the same points
+    if (!_sameCoordinates(visualTransectPoints, _visualTransectPoints)) {
+        _visualTransectPoints = visualTransectPoints;
+        emit visualTransectPointsChanged();
+    }
 
     _coordinate = _visualTransectPoints.count() ? _visualTransectPoints.first().value<QGeoCoordinate>() : QGeoCoordinate();
     _exitCoordinate = _visualTransectPoints.count() ? _visualTransectPoints.last().value<QGeoCoordinate>() : QGeoCoordinate();
@@ -957,6 +987,8 @@ void TransectStyleComplexItem::_handleHoverAndCaptureEnabled(QVariant enabled)
 
 void TransectStyleComplexItem::appendMissionItems(QList<MissionItem*>& items, QObject* missionItemParent)
 {
+    _waitForRebuildTransectsPhase1();
+
     if (_loadedMissionItems.count()) {
         // We have mission items from the loaded plan, use those
         _appendLoadedMissionItems(items, missionItemParent);
@@ -1134,16 +1166,10 @@ void TransectStyleComplexItem::_appendLoadedMissionItems(QList<MissionItem*>& it
     }
 }
 
-void TransectStyleComplexItem::addKMLVisuals(KMLPlanDomDocument& domDocument)
+void TransectStyleComplexItem::addKMLVisuals(KMLPlanDocument& planDocument)
 {
     // We add the survey area polygon as a Placemark
-
-    QDomElement placemarkElement = domDocument.addPlacemark(QStringLiteral("Survey Area"), true);
-    QDomElement polygonElement = _surveyAreaPolygon.kmlPolygonElement(domDocument);
-
-    placemarkElement.appendChild(polygonElement);
-    domDocument.addTextElement(placemarkElement, "styleUrl", QStringLiteral("#%1").arg(domDocument.surveyPolygonStyleName));
-    domDocument.appendChildToRoot(placemarkElement);
+    planDocument.addSurveyPolygon(QStringLiteral("Survey Area"), _surveyAreaPolygon.coordinateList());
 }
 
 void TransectStyleComplexItem::_recalcComplexDistance(void)
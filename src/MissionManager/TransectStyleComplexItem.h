@@ -81,7 +81,7 @@ public:
     int     lastSequenceNumber  (void) const final;
     QString mapVisualQML        (void) const override = 0;
     bool    load                (const QJsonObject& complexObject, int sequenceNumber, QString& errorString) override = 0;
-    void    addKMLVisuals       (KMLPlanDomDocument& domDocument) final;
+    void    addKMLVisuals       (KMLPlanDocument& planDocument) final;
     double  complexDistance     (void) const final { return _complexDistance; }
     double  greatestDistanceTo  (const QGeoCoordinate &other) const final;
 
@@ -140,6 +140,8 @@ protected slots:
 
 protected:
     virtual void _rebuildTransectsPhase1    (void) = 0; ///< Rebuilds the _transects array
+    virtual bool _rebuildTransectsPhase1Background(void) { return false; }  ///< Starts rebuilding _transects in the background, @return false: run _rebuildTransectsPhase1 instead
+    virtual void _waitForRebuildTransectsPhase1   (void) { }                ///< Blocks until a background rebuild has published its _transects
     virtual void _recalcCameraShots         (void) = 0;
 
     void    _save                           (QJsonObject& saveObject);
@@ -157,6 +159,7 @@ protected:
     void    _buildAndAppendMissionItems     (QList<MissionItem*>& items, QObject* missionItemParent);
     void    _appendLoadedMissionItems       (QList<MissionItem*>& items, QObject* missionItemParent);
     void    _recalcComplexDistance          (void);
+    void    _rebuildTransectsPhase2         (void);   ///< Terrain, flight path and visuals from the current _transects
 
     int                 _sequenceNumber = 0;
     QGeoCoordinate      _coordinate;
@@ -195,7 +198,7 @@ protected:
     QObject*            _loadedMissionItemsParent = nullptr;	///< Parent for all items in _loadedMissionItems for simpler delete
     QList<MissionItem*> _loadedMissionItems;                    ///< Mission items loaded from plan file
 
-    QMap<QString, FactMetaData*> _metaDataMap;
+    const QMap<QString, FactMetaData*> _metaDataMap;
 
     SettingsFact _turnAroundDistanceFact;
     SettingsFact _cameraTriggerInTurnAroundFact;
@@ -240,6 +243,8 @@ private:
     int     _maxPathHeight                  (const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo, int fromIndex, int toIndex, double& maxHeight);
     BuildMissionItemsState_t _buildMissionItemsState(void) const;
 
+    static bool _sameCoordinates(const QVariantList& list1, const QVariantList& list2);
+
     TerrainPolyPathQuery*       _currentTerrainFollowQuery =            nullptr;
     QTimer                      _terrainQueryTimer;
 };
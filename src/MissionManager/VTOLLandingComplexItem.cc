@@ -27,7 +27,7 @@ const char* VTOLLandingComplexItem::jsonComplexItemTypeValue = "vtolLandingPatte
 
 VTOLLandingComplexItem::VTOLLandingComplexItem(PlanMasterController* masterController, bool flyView, QObject* parent)
     : LandingComplexItem        (masterController, flyView, parent)
-    , _metaDataMap              (FactMetaData::createMapFromJsonFile(QStringLiteral(":/json/VTOLLandingPattern.FactMetaData.json"), this))
+    , _metaDataMap              (FactMetaData::sharedMapFromJsonFile(QStringLiteral(":/json/VTOLLandingPattern.FactMetaData.json")))
     , _landingDistanceFact      (settingsGroup, _metaDataMap[finalApproachToLandDistanceName])
     , _finalApproachAltitudeFact(settingsGroup, _metaDataMap[finalApproachAltitudeName])
     , _loiterRadiusFact         (settingsGroup, _metaDataMap[loiterRadiusName])
@@ -47,6 +47,8 @@ VTOLLandingComplexItem::VTOLLandingComplexItem(PlanMasterController* masterContr
     if (QGC::fuzzyCompare(_landingDistanceFact.rawValue().toDouble(), _landingDistanceFact.rawDefaultValue().toDouble())) {
         Fact* vtolTransitionDistanceFact = qgcApp()->toolbox()->settingsManager()->planViewSettings()->vtolTransitionDistance();
         double vtolTransitionDistance = vtolTransitionDistanceFact->rawValue().toDouble();
+        // The meta data is shared by all items, adjust a copy of our own
+        _landingDistanceFact.setMetaData(new FactMetaData(*_landingDistanceFact.metaData(), this));
         _landingDistanceFact.metaData()->setRawDefaultValue(vtolTransitionDistance);
         _landingDistanceFact.setRawValue(vtolTransitionDistance);
         _landingDistanceFact.metaData()->setRawMin(vtolTransitionDistanceFact->metaData()->rawMin());
@@ -0,0 +1,55 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VisualItemsViewportModel.h"
+#include "VisualMissionItem.h"
+#include "QmlObjectListModel.h"
+
+VisualItemsViewportModel::VisualItemsViewportModel(QObject* parent)
+    : QSortFilterProxyModel(parent)
+{
+
+}
+
+void VisualItemsViewportModel::setVisualItems(QmlObjectListModel* visualItems)
+{
+    _visualItems = visualItems;
+    setSourceModel(visualItems);
+}
+
+void VisualItemsViewportModel::setViewport(const QGeoRectangle& viewport)
+{
+    if (viewport != _viewport) {
+        _viewport = viewport;
+        _filterRect = viewport;
+        if (_filterRect.isValid()) {
+            _filterRect.setWidth(qMin(_filterRect.width() * 1.5, 360.0));
+            _filterRect.setHeight(qMin(_filterRect.height() * 1.5, 180.0));
+        }
+        emit viewportChanged();
+
+        if (_visualItems && _visualItems->count() >= filterMinCount) {
+            invalidateFilter();
+        }
+    }
+}
+
+bool VisualItemsViewportModel::filterAcceptsRow(int sourceRow, const QModelIndex& /*sourceParent*/) const
+{
+    if (!_visualItems || _visualItems->count() < filterMinCount || !_filterRect.isValid()) {
+        return true;
+    }
+
+    VisualMissionItem* visualItem = _visualItems->value<VisualMissionItem*>(sourceRow);
+    if (!visualItem || visualItem->isCurrentItem() || !visualItem->isSimpleItem() || !visualItem->specifiesCoordinate()) {
+        return true;
+    }
+
+    return _filterRect.contains(visualItem->coordinate());
+}
@@ -0,0 +1,50 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QSortFilterProxyModel>
+#include <QGeoRectangle>
+
+class QmlObjectListModel;
+
+/// Filters a mission's visual items down to the ones near the map viewport.
+///
+/// Used by the Plan view so large missions only create interactive map delegates for the items which can be seen.
+/// Small missions, the current item, complex items (their visuals cover an area) and items without a coordinate
+/// always pass the filter.
+class VisualItemsViewportModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    VisualItemsViewportModel(QObject* parent = nullptr);
+
+    Q_PROPERTY(QGeoRectangle viewport READ viewport WRITE setViewport NOTIFY viewportChanged)
+
+    QGeoRectangle   viewport        (void) const { return _viewport; }
+    void            setViewport     (const QGeoRectangle& viewport);
+    void            setVisualItems  (QmlObjectListModel* visualItems);
+
+    /// Re-evaluate the filter after something other than the viewport changed, such as the current item
+    void            refilter        (void) { invalidateFilter(); }
+
+    static const int filterMinCount = 250;  ///< Missions with fewer visual items than this are not filtered
+
+signals:
+    void viewportChanged(void);
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+
+private:
+    QmlObjectListModel* _visualItems = nullptr;
+    QGeoRectangle       _viewport;
+    QGeoRectangle       _filterRect;            ///< Viewport with a margin so items are created before they scroll into view
+};
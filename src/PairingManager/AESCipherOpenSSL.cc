@@ -0,0 +1,79 @@
+#include "AESCipherOpenSSL.h"
+
+//-----------------------------------------------------------------------------
+AESCipherOpenSSL::AESCipherOpenSSL(const unsigned char* key, const unsigned char* iv)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x1010000fL
+    encCipherContext = EVP_CIPHER_CTX_new();
+    decCipherContext = EVP_CIPHER_CTX_new();
+
+    EVP_CIPHER_CTX_init(encCipherContext);
+    EVP_EncryptInit_ex(encCipherContext, EVP_aes_256_cbc(), nullptr, key, iv);
+    EVP_CIPHER_CTX_init(decCipherContext);
+    EVP_DecryptInit_ex(decCipherContext, EVP_aes_256_cbc(), nullptr, key, iv);
+#else
+    EVP_CIPHER_CTX_init(&encCipherContext);
+    EVP_EncryptInit_ex(&encCipherContext, EVP_aes_256_cbc(), nullptr, key, iv);
+    EVP_CIPHER_CTX_init(&decCipherContext);
+    EVP_DecryptInit_ex(&decCipherContext, EVP_aes_256_cbc(), nullptr, key, iv);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+AESCipherOpenSSL::~AESCipherOpenSSL()
+{
+#if OPENSSL_VERSION_NUMBER >= 0x1010000fL
+    EVP_CIPHER_CTX_free(encCipherContext);
+    EVP_CIPHER_CTX_free(decCipherContext);
+#else
+    EVP_CIPHER_CTX_cleanup(&encCipherContext);
+    EVP_CIPHER_CTX_cleanup(&decCipherContext);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+bool
+AESCipherOpenSSL::encrypt(const unsigned char* plainText, size_t length, std::vector<unsigned char>& cipherText)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x1010000fL
+    EVP_CIPHER_CTX* context = encCipherContext;
+#else
+    EVP_CIPHER_CTX* context = &encCipherContext;
+#endif
+    int cLen = 0;
+    int fLen = 0;
+
+    cipherText.resize(length + blockSize);
+    // Init with no cipher, key or IV restarts the chain from the IV set in the constructor
+    if (!EVP_EncryptInit_ex(context, nullptr, nullptr, nullptr, nullptr) ||
+            !EVP_EncryptUpdate(context, cipherText.data(), &cLen, plainText, static_cast<int>(length)) ||
+            !EVP_EncryptFinal_ex(context, cipherText.data() + cLen, &fLen)) {
+        cipherText.clear();
+        return false;
+    }
+    cipherText.resize(static_cast<size_t>(cLen + fLen));
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool
+AESCipherOpenSSL::decrypt(const unsigned char* cipherText, size_t length, std::vector<unsigned char>& plainText)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x1010000fL
+    EVP_CIPHER_CTX* context = decCipherContext;
+#else
+    EVP_CIPHER_CTX* context = &decCipherContext;
+#endif
+    int pLen = 0;
+    int fLen = 0;
+
+    plainText.resize(length + blockSize);
+    if (!EVP_DecryptInit_ex(context, nullptr, nullptr, nullptr, nullptr) ||
+            !EVP_DecryptUpdate(context, plainText.data(), &pLen, cipherText, static_cast<int>(length)) ||
+            !EVP_DecryptFinal_ex(context, plainText.data() + pLen, &fLen)) {
+        plainText.clear();
+        return false;
+    }
+    plainText.resize(static_cast<size_t>(pLen + fLen));
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef AESCIPHEROPENSSL_H
+#define AESCIPHEROPENSSL_H
+
+#pragma once
+
+#include "aes.h"
+
+#include <openssl/evp.h>
+
+/// AES-256-CBC through OpenSSL EVP. EVP picks the AES-NI or ARMv8 crypto extension code paths at runtime when the CPU
+/// has them, which is several times faster than the portable implementation.
+class AESCipherOpenSSL : public AESCipher
+{
+public:
+    AESCipherOpenSSL(const unsigned char* key, const unsigned char* iv);
+
+    ~AESCipherOpenSSL() override;
+
+    const char* name() const override { return "openssl"; }
+
+    bool encrypt(const unsigned char* plainText, size_t length, std::vector<unsigned char>& cipherText) override;
+
+    bool decrypt(const unsigned char* cipherText, size_t length, std::vector<unsigned char>& plainText) override;
+
+private:
+#if OPENSSL_VERSION_NUMBER >= 0x1010000fL
+    EVP_CIPHER_CTX *encCipherContext = nullptr;
+    EVP_CIPHER_CTX *decCipherContext = nullptr;
+#else
+    EVP_CIPHER_CTX encCipherContext;
+    EVP_CIPHER_CTX decCipherContext;
+#endif
+};
+
+#endif // AESCIPHEROPENSSL_H
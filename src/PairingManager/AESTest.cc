@@ -0,0 +1,110 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "AESTest.h"
+#include "aes.h"
+
+#include <QRandomGenerator>
+
+static const char*              _password   = "J6+KuWh9K2!hG(F'";
+static const unsigned long long _salt       = 0x368de30e8ec063ce;
+
+void AESTest::_knownAnswerTest(void)
+{
+    // FIPS-197 appendix C.3. With a zero IV the first CBC block is the plain AES-256 block.
+    const QByteArray expected = QByteArray::fromHex("8ea2b7ca516745bfeafc49904b496089");
+    unsigned char key[AESCipher::keySize];
+    unsigned char iv[AESCipher::blockSize] = {};
+    unsigned char plainText[AESCipher::blockSize];
+
+    for (int i=0; i<static_cast<int>(AESCipher::keySize); i++) {
+        key[i] = static_cast<unsigned char>(i);
+    }
+    for (int i=0; i<static_cast<int>(AESCipher::blockSize); i++) {
+        plainText[i] = static_cast<unsigned char>(i * 0x11);
+    }
+
+    for (AESCipher::Backend backend: { AESCipher::BackendPortable, AESCipher::BackendOpenSSL }) {
+        if (!AESCipher::available(backend)) {
+            continue;
+        }
+        std::unique_ptr<AESCipher> cipher = AESCipher::create(backend, key, iv);
+        std::vector<unsigned char> cipherText;
+        QVERIFY(cipher->encrypt(plainText, sizeof(plainText), cipherText));
+        QCOMPARE(static_cast<int>(cipherText.size()), 32);  // Full padding block follows
+        QCOMPARE(QByteArray(reinterpret_cast<const char*>(cipherText.data()), 16), expected);
+    }
+}
+
+void AESTest::_backendsTest(void)
+{
+    if (!AESCipher::available(AESCipher::BackendOpenSSL)) {
+        QSKIP("OpenSSL backend not built in");
+    }
+
+    QRandomGenerator random(1234);
+    unsigned char    key[AESCipher::keySize];
+    unsigned char    iv[AESCipher::blockSize];
+
+    for (int length=0; length<200; length+=7) {
+        for (unsigned char& byte: key) {
+            byte = static_cast<unsigned char>(random.bounded(256));
+        }
+        for (unsigned char& byte: iv) {
+            byte = static_cast<unsigned char>(random.bounded(256));
+        }
+        std::vector<unsigned char> plainText(static_cast<size_t>(length));
+        for (unsigned char& byte: plainText) {
+            byte = static_cast<unsigned char>(random.bounded(256));
+        }
+
+        std::unique_ptr<AESCipher>  portable    = AESCipher::create(AESCipher::BackendPortable, key, iv);
+        std::unique_ptr<AESCipher>  openSSL     = AESCipher::create(AESCipher::BackendOpenSSL, key, iv);
+        std::vector<unsigned char>  portableCipherText;
+        std::vector<unsigned char>  openSSLCipherText;
+        QVERIFY(portable->encrypt(plainText.data(), plainText.size(), portableCipherText));
+        QVERIFY(openSSL->encrypt(plainText.data(), plainText.size(), openSSLCipherText));
+        QVERIFY(portableCipherText == openSSLCipherText);
+
+        // Each decrypts the other's output
+        std::vector<unsigned char> decrypted;
+        QVERIFY(portable->decrypt(openSSLCipherText.data(), openSSLCipherText.size(), decrypted));
+        QVERIFY(decrypted == plainText);
+        QVERIFY(openSSL->decrypt(portableCipherText.data(), portableCipherText.size(), decrypted));
+        QVERIFY(decrypted == plainText);
+
+        // Truncated cipher text is rejected
+        QVERIFY(!portable->decrypt(portableCipherText.data(), portableCipherText.size() - 1, decrypted));
+    }
+}
+
+void AESTest::_payloadTest(void)
+{
+    // Payloads large enough to compress past the 2:1 the previous decrypt buffer allowed for
+    QString json;
+    for (int i=0; i<2000; i++) {
+        json += QStringLiteral("{\"name\":\"Vehicle %1\",\"channel\":%2},").arg(i % 10).arg(i % 4);
+    }
+    const std::string plainText = json.toStdString();
+
+    AES portable(_password, _salt, AESCipher::BackendPortable);
+    QCOMPARE(QString(portable.backendName()), QStringLiteral("portable"));
+    const std::string encrypted = portable.encrypt(plainText);
+    QVERIFY(!encrypted.empty());
+    QVERIFY(portable.decrypt(encrypted) == plainText);
+
+    AES automatic(_password, _salt);
+    QVERIFY(automatic.encrypt(plainText) == encrypted);
+    QVERIFY(automatic.decrypt(encrypted) == plainText);
+    if (AESCipher::available(AESCipher::BackendOpenSSL)) {
+        QCOMPARE(QString(automatic.backendName()), QStringLiteral("openssl"));
+    }
+
+    QVERIFY(portable.decrypt("not a payload").empty());
+}
@@ -12,6 +12,7 @@
 #include "MicrohardManager.h"
 #include "QGCApplication.h"
 #include "QGCCorePlugin.h"
+#include "QGCNetworkService.h"
 
 #include <QSettings>
 #include <QJsonObject>
@@ -62,6 +63,12 @@ void
 PairingManager::setToolbox(QGCToolbox *toolbox)
 {
     QGCTool::setToolbox(toolbox);
+}
+
+//-----------------------------------------------------------------------------
+void
+PairingManager::deferredInit()
+{
     _updatePairedDeviceNameList();
     emit pairedListChanged();
 }
@@ -95,10 +102,9 @@ void
 PairingManager::_startUpload(QString pairURL, QJsonDocument jsonDoc)
 {
     QMutexLocker lock(&_uploadMutex);
-    if (_uploadManager != nullptr) {
+    if (_uploadReply != nullptr) {
         return;
     }
-    _uploadManager = new QNetworkAccessManager(this);
 
     QString str = jsonDoc.toJson(QJsonDocument::JsonFormat::Compact);
     qCDebug(PairingManagerLog) << "Starting upload to: " << pairURL << " " << str;
@@ -114,8 +120,9 @@ PairingManager::_startUploadRequest()
     QNetworkRequest req;
     req.setUrl(QUrl(_uploadURL));
     req.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
-    QNetworkReply *reply = _uploadManager->post(req, _uploadData.toUtf8());
-    connect(reply, &QNetworkReply::finished, this, &PairingManager::_uploadFinished);
+    QGCNetworkService::setConsumer(req, QGCNetworkService::consumerPairing);
+    _uploadReply = qgcApp()->toolbox()->networkService()->networkAccessManager()->post(req, _uploadData.toUtf8());
+    connect(_uploadReply, &QNetworkReply::finished, this, &PairingManager::_uploadFinished);
 }
 
 //-----------------------------------------------------------------------------
@@ -123,9 +130,11 @@ void
 PairingManager::_stopUpload()
 {
     QMutexLocker lock(&_uploadMutex);
-    if (_uploadManager != nullptr) {
-        delete _uploadManager;
-        _uploadManager = nullptr;
+    if (_uploadReply != nullptr) {
+        disconnect(_uploadReply, &QNetworkReply::finished, this, &PairingManager::_uploadFinished);
+        _uploadReply->abort();
+        _uploadReply->deleteLater();
+        _uploadReply = nullptr;
     }
 }
 
@@ -136,7 +145,9 @@ PairingManager::_uploadFinished()
     QMutexLocker lock(&_uploadMutex);
     QNetworkReply* reply = qobject_cast<QNetworkReply*>(QObject::sender());
     if (reply) {
-        if (_uploadManager != nullptr) {
+        reply->deleteLater();
+        if (reply == _uploadReply) {
+            _uploadReply = nullptr;
             if (reply->error() == QNetworkReply::NoError) {
                 qCDebug(PairingManagerLog) << "Upload finished.";
                 QByteArray bytes = reply->readAll();
@@ -154,14 +165,10 @@ PairingManager::_uploadFinished()
                     setPairingStatus(PairingRejected, tr("Pairing Rejected"));
                     qCDebug(PairingManagerLog) << "Pairing error: " << str;
                 }
-                _uploadManager->deleteLater();
-                _uploadManager = nullptr;
             } else {
                 if(++_pairRetryCount > 3) {
                     qCDebug(PairingManagerLog) << "Giving up";
                     setPairingStatus(PairingError, tr("No Response From Vehicle"));
-                    _uploadManager->deleteLater();
-                    _uploadManager = nullptr;
                 } else {
                     qCDebug(PairingManagerLog) << "Upload error: " + reply->errorString();
                     _startUploadRequest();
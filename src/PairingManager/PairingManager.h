@@ -44,6 +44,7 @@ public:
 
     // Override from QGCTool
     virtual void setToolbox(QGCToolbox *toolbox) override;
+    virtual void deferredInit() override;
 
     enum PairingStatus {
         PairingIdle,
@@ -125,7 +126,7 @@ private:
     AES                     _aes;
     QJsonDocument           _jsonDoc{};
     QMutex                  _uploadMutex{};
-    QNetworkAccessManager*  _uploadManager = nullptr;
+    QNetworkReply*          _uploadReply = nullptr;   ///< Upload request in flight
     QString                 _uploadURL{};
     QString                 _uploadData{};
     bool                    _firstBoot = true;
@@ -1,154 +1,375 @@
 #include "aes.h"
+#if defined(QGC_AES_OPENSSL)
+#include "AESCipherOpenSSL.h"
+#endif
 
-#include <memory>
-#include <openssl/aes.h>
-#include <openssl/bio.h>
+#include <cstring>
+#include <QByteArray>
+#include <QCryptographicHash>
 #include <zlib.h>
 
+namespace {
+
+//-----------------------------------------------------------------------------
+const unsigned long maxPayload = 16 * 1024 * 1024;
+
 //-----------------------------------------------------------------------------
-AES::AES(std::string password, unsigned long long salt)
+inline unsigned char
+xtime(unsigned char x)
 {
-    int nrounds = 5;
-    unsigned char key[32], iv[32];
+    return static_cast<unsigned char>((x << 1) ^ ((x & 0x80) ? 0x1b : 0x00));
+}
 
-    /*
-     * Gen key & IV for AES 256 CBC mode. A SHA1 digest is used to hash the supplied key material.
-     * nrounds is the number of times the we hash the material. More rounds are more secure but
-     * slower.
-     */
-    EVP_BytesToKey(EVP_aes_256_cbc(), EVP_sha1(),
-                   reinterpret_cast<const unsigned char*>(&salt),
-                   reinterpret_cast<const unsigned char*>(password.c_str()),
-                   static_cast<int>(password.length()),
-                   nrounds, key, iv);
-
-#if OPENSSL_VERSION_NUMBER >= 0x1010000fL
-    encCipherContext = EVP_CIPHER_CTX_new();
-    decCipherContext = EVP_CIPHER_CTX_new();
-
-    EVP_CIPHER_CTX_init(encCipherContext);
-    EVP_EncryptInit_ex(encCipherContext, EVP_aes_256_cbc(), nullptr, key, iv);
-    EVP_CIPHER_CTX_init(decCipherContext);
-    EVP_DecryptInit_ex(decCipherContext, EVP_aes_256_cbc(), nullptr, key, iv);
-#else
-    EVP_CIPHER_CTX_init(&encCipherContext);
-    EVP_EncryptInit_ex(&encCipherContext, EVP_aes_256_cbc(), nullptr, key, iv);
-    EVP_CIPHER_CTX_init(&decCipherContext);
-    EVP_DecryptInit_ex(&decCipherContext, EVP_aes_256_cbc(), nullptr, key, iv);
+//-----------------------------------------------------------------------------
+inline unsigned char
+gmul(unsigned char x, unsigned char y)
+{
+    unsigned char product = 0;
+    while (y) {
+        if (y & 1) {
+            product ^= x;
+        }
+        x = xtime(x);
+        y >>= 1;
+    }
+    return product;
+}
+
+//-----------------------------------------------------------------------------
+inline unsigned char
+rotl8(unsigned char x, int shift)
+{
+    return static_cast<unsigned char>((x << shift) | (x >> (8 - shift)));
+}
+
+/// S-boxes built from the GF(2^8) inverse and affine transform rather than typed in
+struct SBoxes
+{
+    SBoxes()
+    {
+        unsigned char p = 1;
+        unsigned char q = 1;
+        do {
+            // p walks the multiplicative group by multiplying by 3, q tracks its inverse by dividing by 3
+            p = static_cast<unsigned char>(p ^ xtime(p));
+            q ^= static_cast<unsigned char>(q << 1);
+            q ^= static_cast<unsigned char>(q << 2);
+            q ^= static_cast<unsigned char>(q << 4);
+            if (q & 0x80) {
+                q ^= 0x09;
+            }
+            forward[p] = static_cast<unsigned char>(q ^ rotl8(q, 1) ^ rotl8(q, 2) ^ rotl8(q, 3) ^ rotl8(q, 4) ^ 0x63);
+        } while (p != 1);
+        forward[0] = 0x63;
+        for (int i = 0; i < 256; i++) {
+            inverse[forward[i]] = static_cast<unsigned char>(i);
+        }
+    }
+
+    unsigned char forward[256];
+    unsigned char inverse[256];
+};
+
+//-----------------------------------------------------------------------------
+const SBoxes&
+sboxes()
+{
+    static const SBoxes boxes;
+    return boxes;
+}
+
+}
+
+//-----------------------------------------------------------------------------
+std::unique_ptr<AESCipher>
+AESCipher::create(Backend backend, const unsigned char* key, const unsigned char* iv)
+{
+    if (backend == BackendAuto) {
+        backend = available(BackendOpenSSL) ? BackendOpenSSL : BackendPortable;
+    }
+    switch (backend) {
+    case BackendPortable:
+        return std::unique_ptr<AESCipher>(new AESCipherPortable(key, iv));
+#if defined(QGC_AES_OPENSSL)
+    case BackendOpenSSL:
+        return std::unique_ptr<AESCipher>(new AESCipherOpenSSL(key, iv));
 #endif
+    default:
+        return nullptr;
+    }
 }
 
 //-----------------------------------------------------------------------------
-AES::~AES()
+bool
+AESCipher::available(Backend backend)
 {
-#if OPENSSL_VERSION_NUMBER >= 0x1010000fL
-    EVP_CIPHER_CTX_free(encCipherContext);
-    EVP_CIPHER_CTX_free(decCipherContext);
+    switch (backend) {
+    case BackendAuto:
+    case BackendPortable:
+        return true;
+    case BackendOpenSSL:
+#if defined(QGC_AES_OPENSSL)
+        return true;
 #else
-    EVP_CIPHER_CTX_cleanup(&encCipherContext);
-    EVP_CIPHER_CTX_cleanup(&decCipherContext);
+        return false;
 #endif
+    }
+    return false;
 }
 
 //-----------------------------------------------------------------------------
-std::string
-AES::encrypt(std::string plainText)
+AESCipherPortable::AESCipherPortable(const unsigned char* key, const unsigned char* iv)
 {
-    unsigned long sourceLen = static_cast<unsigned long>(plainText.length() + 1);
-    unsigned long destLen = sourceLen * 2;
-    unsigned char* compressed = new unsigned char[destLen];
-    int err = compress2(compressed, &destLen,
-                        reinterpret_cast<const unsigned char *>(plainText.c_str()),
-                        sourceLen, 9);
-    if (err != Z_OK) {
-        return {};
+    const unsigned char* sbox = sboxes().forward;
+    const int keyWords = static_cast<int>(keySize / 4);
+    unsigned char rcon = 1;
+
+    memcpy(initVector, iv, sizeof(initVector));
+    memcpy(roundKeys, key, keySize);
+    for (int i = keyWords; i < (rounds + 1) * 4; i++) {
+        unsigned char t[4];
+        memcpy(t, roundKeys + (i - 1) * 4, 4);
+        if (i % keyWords == 0) {
+            const unsigned char t0 = t[0];
+            t[0] = static_cast<unsigned char>(sbox[t[1]] ^ rcon);
+            t[1] = sbox[t[2]];
+            t[2] = sbox[t[3]];
+            t[3] = sbox[t0];
+            rcon = xtime(rcon);
+        } else if (i % keyWords == 4) {
+            for (int j = 0; j < 4; j++) {
+                t[j] = sbox[t[j]];
+            }
+        }
+        for (int j = 0; j < 4; j++) {
+            roundKeys[i * 4 + j] = roundKeys[(i - keyWords) * 4 + j] ^ t[j];
+        }
     }
+}
 
-    int pLen = static_cast<int>(destLen);
-    int cLen = pLen + AES_BLOCK_SIZE;
-    int fLen = 0;
-    unsigned char* cipherText = new unsigned char[cLen];
+//-----------------------------------------------------------------------------
+void
+AESCipherPortable::encryptBlock(unsigned char* block) const
+{
+    const unsigned char* sbox = sboxes().forward;
+    unsigned char state[16];
 
-#if OPENSSL_VERSION_NUMBER >= 0x1010000fL
-    EVP_EncryptInit_ex(encCipherContext, nullptr, nullptr, nullptr, nullptr);
-    EVP_EncryptUpdate(encCipherContext, cipherText, &cLen, compressed, pLen);
-    EVP_EncryptFinal_ex(encCipherContext, cipherText + cLen, &fLen);
-#else
-    EVP_EncryptInit_ex(&encCipherContext, nullptr, nullptr, nullptr, nullptr);
-    EVP_EncryptUpdate(&encCipherContext, cipherText, &cLen, compressed, pLen);
-    EVP_EncryptFinal_ex(&encCipherContext, cipherText + cLen, &fLen);
-#endif
+    for (int i = 0; i < 16; i++) {
+        block[i] ^= roundKeys[i];
+    }
+    for (int round = 1; round <= rounds; round++) {
+        // SubBytes and ShiftRows together, the state is stored column by column
+        for (int row = 0; row < 4; row++) {
+            for (int col = 0; col < 4; col++) {
+                state[row + 4 * col] = sbox[block[row + 4 * ((col + row) % 4)]];
+            }
+        }
+        if (round != rounds) {
+            for (int col = 0; col < 4; col++) {
+                unsigned char* c = state + 4 * col;
+                const unsigned char all = c[0] ^ c[1] ^ c[2] ^ c[3];
+                const unsigned char c0 = c[0];
+                c[0] ^= all ^ xtime(c[0] ^ c[1]);
+                c[1] ^= all ^ xtime(c[1] ^ c[2]);
+                c[2] ^= all ^ xtime(c[2] ^ c[3]);
+                c[3] ^= all ^ xtime(c[3] ^ c0);
+            }
+        }
+        const unsigned char* roundKey = roundKeys + round * 16;
+        for (int i = 0; i < 16; i++) {
+            block[i] = state[i] ^ roundKey[i];
+        }
+    }
+}
 
-    std::vector<unsigned char> data(cipherText, cipherText + cLen + fLen);
-    std::string res = base64Encode(data);
-    delete[] cipherText;
-    delete[] compressed;
+//-----------------------------------------------------------------------------
+void
+AESCipherPortable::decryptBlock(unsigned char* block) const
+{
+    const unsigned char* invSbox = sboxes().inverse;
+    unsigned char state[16];
 
-    return res;
+    for (int i = 0; i < 16; i++) {
+        block[i] ^= roundKeys[rounds * 16 + i];
+    }
+    for (int round = rounds - 1; round >= 0; round--) {
+        // InvShiftRows and InvSubBytes together
+        for (int row = 0; row < 4; row++) {
+            for (int col = 0; col < 4; col++) {
+                state[row + 4 * ((col + row) % 4)] = invSbox[block[row + 4 * col]];
+            }
+        }
+        const unsigned char* roundKey = roundKeys + round * 16;
+        for (int i = 0; i < 16; i++) {
+            block[i] = state[i] ^ roundKey[i];
+        }
+        if (round != 0) {
+            for (int col = 0; col < 4; col++) {
+                unsigned char* c = block + 4 * col;
+                const unsigned char a0 = c[0], a1 = c[1], a2 = c[2], a3 = c[3];
+                c[0] = gmul(a0, 14) ^ gmul(a1, 11) ^ gmul(a2, 13) ^ gmul(a3, 9);
+                c[1] = gmul(a0, 9)  ^ gmul(a1, 14) ^ gmul(a2, 11) ^ gmul(a3, 13);
+                c[2] = gmul(a0, 13) ^ gmul(a1, 9)  ^ gmul(a2, 14) ^ gmul(a3, 11);
+                c[3] = gmul(a0, 11) ^ gmul(a1, 13) ^ gmul(a2, 9)  ^ gmul(a3, 14);
+            }
+        }
+    }
 }
+
 //-----------------------------------------------------------------------------
-std::string
-AES::decrypt(std::string cipherText)
+bool
+AESCipherPortable::encrypt(const unsigned char* plainText, size_t length, std::vector<unsigned char>& cipherText)
 {
-    int fLen = 0;
-    std::vector<unsigned char> text = base64Decode(cipherText);
-    int pLen = static_cast<int>(text.size());
-    unsigned char* plainText = new unsigned char[pLen];
+    const size_t padding = blockSize - (length % blockSize);
+    const unsigned char* chain = initVector;
 
-#if OPENSSL_VERSION_NUMBER >= 0x1010000fL
-    EVP_DecryptInit_ex(decCipherContext, nullptr, nullptr, nullptr, nullptr);
-    EVP_DecryptUpdate(decCipherContext, plainText, &pLen, text.data(), pLen);
-    EVP_DecryptFinal_ex(decCipherContext, plainText + pLen, &fLen);
-#else
-    EVP_DecryptInit_ex(&decCipherContext, nullptr, nullptr, nullptr, nullptr);
-    EVP_DecryptUpdate(&decCipherContext, plainText, &pLen, text.data(), pLen);
-    EVP_DecryptFinal_ex(&decCipherContext, plainText + pLen, &fLen);
-#endif
+    cipherText.resize(length + padding);
+    memcpy(cipherText.data(), plainText, length);
+    memset(cipherText.data() + length, static_cast<int>(padding), padding);
+    for (size_t offset = 0; offset < cipherText.size(); offset += blockSize) {
+        unsigned char* block = cipherText.data() + offset;
+        for (size_t i = 0; i < blockSize; i++) {
+            block[i] ^= chain[i];
+        }
+        encryptBlock(block);
+        chain = block;
+    }
+    return true;
+}
 
-    unsigned long destLen = static_cast<unsigned long>((pLen + fLen) * 2);
-    unsigned char* uncompressed = new unsigned char[destLen];
-    int err = uncompress(uncompressed, &destLen, plainText, static_cast<unsigned long>(pLen + fLen));
-    if (err != Z_OK) {
-        return {};
+//-----------------------------------------------------------------------------
+bool
+AESCipherPortable::decrypt(const unsigned char* cipherText, size_t length, std::vector<unsigned char>& plainText)
+{
+    if (length == 0 || length % blockSize != 0) {
+        plainText.clear();
+        return false;
     }
 
-    std::string res(reinterpret_cast<char*>(uncompressed));
-    delete[] uncompressed;
+    const unsigned char* chain = initVector;
+
+    plainText.assign(cipherText, cipherText + length);
+    for (size_t offset = 0; offset < length; offset += blockSize) {
+        unsigned char* block = plainText.data() + offset;
+        decryptBlock(block);
+        for (size_t i = 0; i < blockSize; i++) {
+            block[i] ^= chain[i];
+        }
+        chain = cipherText + offset;
+    }
+
+    const size_t padding = plainText.back();
+    bool valid = padding >= 1 && padding <= blockSize;
+    for (size_t i = 0; valid && i < padding; i++) {
+        valid = plainText[length - 1 - i] == padding;
+    }
+    if (!valid) {
+        plainText.clear();
+        return false;
+    }
+    plainText.resize(length - padding);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+AES::AES(std::string password, unsigned long long salt, AESCipher::Backend backend)
+{
+    int nrounds = 5;
+    unsigned char key[AESCipher::keySize], iv[AESCipher::blockSize];
+
+    /*
+     * Gen key & IV for AES 256 CBC mode. A SHA1 digest is used to hash the supplied key material.
+     * nrounds is the number of times the we hash the material. More rounds are more secure but
+     * slower.
+     */
+    deriveKey(password, salt, nrounds, key, iv);
 
-    return res;
+    cipher = AESCipher::create(backend, key, iv);
+    if (!cipher) {
+        cipher = AESCipher::create(AESCipher::BackendPortable, key, iv);
+    }
 }
 
 //-----------------------------------------------------------------------------
-struct BIOFreeAll { void operator()(BIO* p) { BIO_free_all(p); } };
+void
+AES::deriveKey(const std::string& password, unsigned long long salt, int rounds, unsigned char* key, unsigned char* iv)
+{
+    // The salt goes in as its in-memory bytes, as it always has, so existing pairings keep working
+    const QByteArray passwordBytes(password.data(), static_cast<int>(password.length()));
+    const QByteArray saltBytes(reinterpret_cast<const char*>(&salt), sizeof(salt));
+    const int keyIVLength = static_cast<int>(AESCipher::keySize + AESCipher::blockSize);
+    QByteArray material;
+    QByteArray digest;
 
+    while (material.length() < keyIVLength) {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(digest);
+        hash.addData(passwordBytes);
+        hash.addData(saltBytes);
+        digest = hash.result();
+        for (int i = 1; i < rounds; i++) {
+            digest = QCryptographicHash::hash(digest, QCryptographicHash::Sha1);
+        }
+        material.append(digest);
+    }
+    memcpy(key, material.constData(), AESCipher::keySize);
+    memcpy(iv, material.constData() + AESCipher::keySize, AESCipher::blockSize);
+}
+
+//-----------------------------------------------------------------------------
 std::string
-AES::base64Encode(const std::vector<unsigned char>& binary)
+AES::encrypt(std::string plainText)
 {
-    std::unique_ptr<BIO, BIOFreeAll> b64(BIO_new(BIO_f_base64()));
-    BIO_set_flags(b64.get(), BIO_FLAGS_BASE64_NO_NL);
-    BIO* sink = BIO_new(BIO_s_mem());
-    BIO_push(b64.get(), sink);
-    BIO_write(b64.get(), binary.data(), static_cast<int>(binary.size()));
-    BIO_ctrl(b64.get(), BIO_CTRL_FLUSH, 0, nullptr);
-    const char* encoded;
-    const unsigned long len = static_cast<unsigned long>(BIO_ctrl(sink, BIO_CTRL_INFO, 0, &encoded));
+    // The terminating NUL is part of the payload, decrypt on the other end relies on it
+    unsigned long sourceLen = static_cast<unsigned long>(plainText.length() + 1);
+    unsigned long destLen = compressBound(sourceLen);
+    std::vector<unsigned char> compressed(destLen);
+    int err = compress2(compressed.data(), &destLen,
+                        reinterpret_cast<const unsigned char *>(plainText.c_str()),
+                        sourceLen, 9);
+    if (err != Z_OK) {
+        return {};
+    }
 
-    return std::string(encoded, len);
+    std::vector<unsigned char> data;
+    if (!cipher->encrypt(compressed.data(), destLen, data)) {
+        return {};
+    }
+
+    const QByteArray encoded = QByteArray::fromRawData(reinterpret_cast<const char*>(data.data()), static_cast<int>(data.size())).toBase64();
+    return std::string(encoded.constData(), static_cast<size_t>(encoded.length()));
 }
 
 //-----------------------------------------------------------------------------
-std::vector<unsigned char>
-AES::base64Decode(std::string encoded)
+std::string
+AES::decrypt(std::string cipherText)
 {
-    std::unique_ptr<BIO, BIOFreeAll> b64(BIO_new(BIO_f_base64()));
-    BIO_set_flags(b64.get(), BIO_FLAGS_BASE64_NO_NL);
-    BIO* source = BIO_new_mem_buf(encoded.c_str(), -1); // read-only source
-    BIO_push(b64.get(), source);
-    const unsigned long maxlen = encoded.length() / 4 * 3 + 1;
-    std::vector<unsigned char> decoded(maxlen);
-    const unsigned long len = static_cast<unsigned long>(BIO_read(b64.get(), decoded.data(), static_cast<int>(maxlen)));
-    decoded.resize(len);
-    return decoded;
+    const QByteArray text = QByteArray::fromBase64(QByteArray::fromRawData(cipherText.data(), static_cast<int>(cipherText.length())));
+    std::vector<unsigned char> plainText;
+    if (!cipher->decrypt(reinterpret_cast<const unsigned char*>(text.constData()), static_cast<size_t>(text.length()), plainText)) {
+        return {};
+    }
+
+    // JSON compresses well past 2:1, so grow the buffer until it fits rather than guessing once
+    unsigned long destLen = static_cast<unsigned long>(plainText.size() * 4 + 64);
+    std::vector<unsigned char> uncompressed;
+    int err = Z_BUF_ERROR;
+    while (err == Z_BUF_ERROR && destLen <= maxPayload) {
+        uncompressed.resize(destLen);
+        unsigned long len = destLen;
+        err = uncompress(uncompressed.data(), &len, plainText.data(), static_cast<unsigned long>(plainText.size()));
+        if (err == Z_OK) {
+            uncompressed.resize(len);
+        } else {
+            destLen *= 2;
+        }
+    }
+    if (err != Z_OK) {
+        return {};
+    }
+
+    const char* res = reinterpret_cast<const char*>(uncompressed.data());
+    return std::string(res, strnlen(res, uncompressed.size()));
 }
 
 //-----------------------------------------------------------------------------
@@ -3,33 +3,79 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
-#include <openssl/evp.h>
 
-class AES
+/// AES-256-CBC with PKCS#7 padding over whole messages. Every backend produces the same output for the same key
+/// and IV, they only differ in speed.
+class AESCipher
 {
 public:
-    AES(std::string password, unsigned long long salt);
+    enum Backend {
+        BackendAuto,        ///< Fastest backend built in
+        BackendPortable,    ///< Software implementation in aes.cpp, always available
+        BackendOpenSSL      ///< OpenSSL EVP, which uses AES-NI/ARMv8 crypto extensions where the CPU has them
+    };
+
+    virtual ~AESCipher() {}
+
+    virtual const char* name() const = 0;
+
+    virtual bool encrypt(const unsigned char* plainText, size_t length, std::vector<unsigned char>& cipherText) = 0;
+
+    /// @return false: Length isn't a whole number of blocks or the padding is bad
+    virtual bool decrypt(const unsigned char* cipherText, size_t length, std::vector<unsigned char>& plainText) = 0;
+
+    /// @return nullptr if the backend isn't built in
+    static std::unique_ptr<AESCipher> create(Backend backend, const unsigned char* key, const unsigned char* iv);
+
+    static bool available(Backend backend);
+
+    static const size_t keySize     = 32;
+    static const size_t blockSize   = 16;
+};
+
+/// Byte oriented software AES, used when no platform crypto backend is built in
+class AESCipherPortable : public AESCipher
+{
+public:
+    AESCipherPortable(const unsigned char* key, const unsigned char* iv);
+
+    const char* name() const override { return "portable"; }
 
-    ~AES();
+    bool encrypt(const unsigned char* plainText, size_t length, std::vector<unsigned char>& cipherText) override;
+
+    bool decrypt(const unsigned char* cipherText, size_t length, std::vector<unsigned char>& plainText) override;
+
+private:
+    static const int rounds = 14;
+
+    void encryptBlock(unsigned char* block) const;
+
+    void decryptBlock(unsigned char* block) const;
+
+    unsigned char roundKeys[(rounds + 1) * 16];
+    unsigned char initVector[16];
+};
+
+/// Compresses, encrypts and base64 encodes PairingManager payloads
+class AES
+{
+public:
+    AES(std::string password, unsigned long long salt, AESCipher::Backend backend = AESCipher::BackendAuto);
 
     std::string encrypt(std::string plainText);
 
     std::string decrypt(std::string cipherText);
 
-private:
-#if OPENSSL_VERSION_NUMBER >= 0x1010000fL
-    EVP_CIPHER_CTX *encCipherContext = nullptr;
-    EVP_CIPHER_CTX *decCipherContext = nullptr;
-#else
-    EVP_CIPHER_CTX encCipherContext;
-    EVP_CIPHER_CTX decCipherContext;
-#endif
+    const char* backendName() const { return cipher->name(); }
 
-    std::string base64Encode(const std::vector<unsigned char>& binary);
+    /// Same key and IV as OpenSSL EVP_BytesToKey with SHA1 for AES-256-CBC
+    static void deriveKey(const std::string& password, unsigned long long salt, int rounds, unsigned char* key, unsigned char* iv);
 
-    std::vector<unsigned char> base64Decode(std::string encoded);
+private:
+    std::unique_ptr<AESCipher> cipher;
 };
 
 #endif // AES_H
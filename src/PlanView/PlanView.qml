@@ -69,6 +69,14 @@ Item {
         return coordinate
     }
 
+    function updateViewport() {
+        var coordinateNW = editorMap.toCoordinate(Qt.point(0,0), false /* clipToViewPort */)
+        var coordinateSE = editorMap.toCoordinate(Qt.point(editorMap.width,editorMap.height), false /* clipToViewPort */)
+        if (coordinateNW.isValid && coordinateSE.isValid) {
+            _missionController.viewportVisualItems.viewport = QtPositioning.rectangle(coordinateNW, coordinateSE)
+        }
+    }
+
     function updateAirspace(reset) {
         if(_airspaceEnabled) {
             var coordinateNW = editorMap.toCoordinate(Qt.point(0,0), false /* clipToViewPort */)
@@ -220,6 +228,11 @@ Item {
             globals.planMasterControllerPlanView = _planMasterController
         }
 
+        onLoadFromFileComplete: {
+            fitViewportToItems()
+            _missionController.setCurrentPlanViewSeqNum(0, true)
+        }
+
         onPromptForPlanUsageOnVehicleChange: {
             if (!_promptForPlanUsageShowing) {
                 _promptForPlanUsageShowing = true
@@ -372,8 +385,6 @@ Item {
 
         onAcceptedForLoad: {
             _planMasterController.loadFromFile(file)
-            _planMasterController.fitViewportToItems()
-            _missionController.setCurrentPlanViewSeqNum(0, true)
             close()
         }
     }
@@ -433,18 +444,27 @@ Item {
             property real _nonInteractiveOpacity:  0.5
 
             // Initial map position duplicates Fly view position
-            Component.onCompleted: editorMap.center = QGroundControl.flightMapPosition
+            Component.onCompleted: {
+                editorMap.center = QGroundControl.flightMapPosition
+                _missionController.flightPathLOD.zoomLevel = zoomLevel
+                updateViewport()
+            }
 
             QGCMapPalette { id: mapPal; lightColors: editorMap.isSatelliteMap }
 
             onZoomLevelChanged: {
                 QGroundControl.flightMapZoom = zoomLevel
+                _missionController.flightPathLOD.zoomLevel = zoomLevel
+                updateViewport()
                 updateAirspace(false)
             }
             onCenterChanged: {
                 QGroundControl.flightMapPosition = center
+                updateViewport()
                 updateAirspace(false)
             }
+            onWidthChanged:     updateViewport()
+            onHeightChanged:    updateViewport()
 
             MouseArea {
                 anchors.fill: parent
@@ -475,9 +495,9 @@ Item {
                 }
             }
 
-            // Add the mission item visuals to the map
+            // Add the mission item visuals to the map, large missions only get them near the viewport
             Repeater {
-                model: _missionController.visualItems
+                model: _missionController.viewportVisualItems
                 delegate: MissionItemMapVisual {
                     map:        editorMap
                     onClicked:  _missionController.setCurrentPlanViewSeqNum(sequenceNumber, false)
@@ -486,11 +506,19 @@ Item {
                 }
             }
 
-            // Add lines between waypoints
-            MissionLineView {
-                showSpecialVisual:  _missionController.isROIBeginCurrentItem
-                model:              _missionController.simpleFlightPathSegments
-                opacity:            _editingLayer == _layerMission ? 1 : editorMap._nonInteractiveOpacity
+            // Add lines between waypoints, consecutive segments are merged and simplified for the zoom level
+            MapItemView {
+                model: _missionController.flightPathLOD.paths
+
+                delegate: MapPolyline {
+                    line.width: 3
+                    line.color: modelData.terrainCollision ?
+                                    "red" :
+                                    (_missionController.isROIBeginCurrentItem ? "green" : QGroundControl.globalPalette.mapMissionTrajectory)
+                    z:          QGroundControl.zOrderWaypointLines
+                    path:       modelData.path
+                    opacity:    _editingLayer == _layerMission ? 1 : editorMap._nonInteractiveOpacity
+                }
             }
 
             // Direction arrows in waypoint lines
@@ -958,6 +986,17 @@ Item {
         }
     }
 
+    Component {
+        id: syncLoadFromAutosaveOverwrite
+        QGCViewMessage {
+            message:   qsTr("You have unsaved/unsent changes. Restoring the unsaved plan of an earlier session will lose these changes. Are you sure you want to restore it?")
+            function accept() {
+                hideDialog()
+                _planMasterController.loadFromAutosave()
+            }
+        }
+    }
+
     property var createPlanRemoveAllPromptDialogMapCenter
     property var createPlanRemoveAllPromptDialogPlanCreator
     Component {
@@ -1134,7 +1173,7 @@ Item {
                 QGCButton {
                     text:               qsTr("Open...")
                     Layout.fillWidth:   true
-                    enabled:            !_planMasterController.syncInProgress
+                    enabled:            !_planMasterController.syncInProgress && !_planMasterController.planFileInProgress
                     onClicked: {
                         dropPanel.hide()
                         if (_planMasterController.dirty) {
@@ -1148,7 +1187,7 @@ Item {
                 QGCButton {
                     text:               qsTr("Save")
                     Layout.fillWidth:   true
-                    enabled:            !_planMasterController.syncInProgress && _planMasterController.currentPlanFile !== ""
+                    enabled:            !_planMasterController.syncInProgress && !_planMasterController.planFileInProgress && _planMasterController.currentPlanFile !== ""
                     onClicked: {
                         dropPanel.hide()
                         if(_planMasterController.currentPlanFile !== "") {
@@ -1162,13 +1201,49 @@ Item {
                 QGCButton {
                     text:               qsTr("Save As...")
                     Layout.fillWidth:   true
-                    enabled:            !_planMasterController.syncInProgress && _planMasterController.containsItems
+                    enabled:            !_planMasterController.syncInProgress && !_planMasterController.planFileInProgress && _planMasterController.containsItems
                     onClicked: {
                         dropPanel.hide()
                         _planMasterController.saveToSelectedFile()
                     }
                 }
 
+                RowLayout {
+                    Layout.columnSpan:  3
+                    Layout.fillWidth:   true
+                    spacing:            ScreenTools.defaultFontPixelWidth
+
+                    QGCButton {
+                        text:               qsTr("Undo")
+                        Layout.fillWidth:   true
+                        enabled:            !_planMasterController.syncInProgress && _planMasterController.undoStack.canUndo
+                        onClicked:          _planMasterController.undoStack.undo()
+                    }
+
+                    QGCButton {
+                        text:               qsTr("Redo")
+                        Layout.fillWidth:   true
+                        enabled:            !_planMasterController.syncInProgress && _planMasterController.undoStack.canRedo
+                        onClicked:          _planMasterController.undoStack.redo()
+                    }
+                }
+
+                QGCButton {
+                    Layout.columnSpan:  3
+                    Layout.fillWidth:   true
+                    text:               qsTr("Restore Unsaved Plan")
+                    visible:            _planMasterController.autosaveAvailable
+                    enabled:            !_planMasterController.syncInProgress && !_planMasterController.planFileInProgress
+                    onClicked: {
+                        dropPanel.hide()
+                        if (_planMasterController.dirty) {
+                            mainWindow.showComponentDialog(syncLoadFromAutosaveOverwrite, columnHolder._overwriteText, mainWindow.showDialogDefaultWidth, StandardButton.Yes | StandardButton.Cancel)
+                        } else {
+                            _planMasterController.loadFromAutosave()
+                        }
+                    }
+                }
+
                 QGCButton {
                     Layout.columnSpan:  3
                     Layout.fillWidth:   true
@@ -1184,6 +1259,18 @@ Item {
                         _planMasterController.saveKmlToSelectedFile()
                     }
                 }
+
+                QGCButton {
+                    Layout.columnSpan:  3
+                    Layout.fillWidth:   true
+                    text:               qsTr("Download Terrain For Offline Use")
+                    enabled:            _missionController.travelBoundingCube.isValid()
+                    onClicked: {
+                        dropPanel.hide()
+                        var cube = _missionController.travelBoundingCube
+                        QGroundControl.mapEngineManager.startElevationDownload(QGroundControl.mapEngineManager.getUniqueName() + qsTr(" Terrain"), cube.pointNW, cube.pointSE)
+                    }
+                }
             }
 
             SectionHeader {
@@ -0,0 +1,425 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "NmeaParser.h"
+
+#include <QDateTime>
+
+#include <cmath>
+#include <cstring>
+
+static const int    msecsPerDay         = 24 * 60 * 60 * 1000;
+static const double metersPerSecPerKnot = 1852.0 / 3600.0;
+
+/// @return Field i, or an empty field if the sentence is shorter
+static inline const char* _field(const char* fields[], int fieldCount, int i)
+{
+    return i < fieldCount ? fields[i] : "";
+}
+
+static inline int _hexDigit(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+NmeaParser::NmeaParser(const FixCallback_t& fixCallback)
+    : _fixCallback(fixCallback)
+{
+    _resetEpoch();
+}
+
+void NmeaParser::addData(const char* data, int length)
+{
+    for (int i=0; i<length; i++) {
+        char c = data[i];
+
+        if (c == '$') {
+            _sentenceLength = 0;
+        } else if (_sentenceLength < 0) {
+            continue;
+        } else if (c == '\r' || c == '\n') {
+            if (_sentenceLength > 0) {
+                _processSentence(_sentence, _sentenceLength);
+            }
+            _sentenceLength = -1;
+        } else if (_sentenceLength == maxSentenceLength) {
+            // Too long to be a sentence we know, skip to the next one
+            _sentenceLength = -1;
+        } else {
+            _sentence[_sentenceLength++] = c;
+        }
+    }
+}
+
+bool NmeaParser::checksumValid(const char* sentence, int length)
+{
+    const char* checksum = static_cast<const char*>(memchr(sentence, '*', static_cast<size_t>(length)));
+    if (!checksum) {
+        // The checksum is optional for most sentences
+        return true;
+    }
+
+    int checksumIndex = static_cast<int>(checksum - sentence);
+    if (checksumIndex + 3 > length || _hexDigit(checksum[1]) < 0 || _hexDigit(checksum[2]) < 0) {
+        return false;
+    }
+
+    int sum = 0;
+    for (int i=0; i<checksumIndex; i++) {
+        sum ^= static_cast<unsigned char>(sentence[i]);
+    }
+    return sum == (_hexDigit(checksum[1]) << 4 | _hexDigit(checksum[2]));
+}
+
+int NmeaParser::tokenize(char* sentence, int length, const char* fields[], int maxFields)
+{
+    int fieldCount = 0;
+
+    if (maxFields > 0) {
+        fields[fieldCount++] = sentence;
+    }
+    for (int i=0; i<length; i++) {
+        if (sentence[i] == '*') {
+            sentence[i] = 0;
+            break;
+        } else if (sentence[i] == ',') {
+            sentence[i] = 0;
+            if (fieldCount < maxFields) {
+                fields[fieldCount++] = &sentence[i + 1];
+            }
+        }
+    }
+
+    return fieldCount;
+}
+
+bool NmeaParser::parseDouble(const char* field, double& value)
+{
+    const char* p           = field;
+    bool        negative    = false;
+    bool        digits      = false;
+    double      mantissa    = 0;
+    double      divisor     = 1;
+
+    if (*p == '-' || *p == '+') {
+        negative = *p == '-';
+        p++;
+    }
+    for (; *p >= '0' && *p <= '9'; p++) {
+        mantissa    = mantissa * 10 + (*p - '0');
+        digits      = true;
+    }
+    if (*p == '.') {
+        for (p++; *p >= '0' && *p <= '9'; p++) {
+            mantissa    = mantissa * 10 + (*p - '0');
+            divisor     *= 10;
+            digits      = true;
+        }
+    }
+    if (!digits || *p != 0) {
+        return false;
+    }
+
+    // A single division of exact values rounds correctly for the number of digits NMEA uses
+    value = (negative ? -mantissa : mantissa) / divisor;
+    return true;
+}
+
+bool NmeaParser::_parseTime(const char* field, int& timeMsecs)
+{
+    for (int i=0; i<6; i++) {
+        if (field[i] < '0' || field[i] > '9') {
+            return false;
+        }
+    }
+
+    int     hours   = (field[0] - '0') * 10 + (field[1] - '0');
+    int     minutes = (field[2] - '0') * 10 + (field[3] - '0');
+    double  seconds;
+    if (hours > 23 || minutes > 59 || !parseDouble(&field[4], seconds) || seconds >= 61) {
+        return false;
+    }
+
+    timeMsecs = ((hours * 60) + minutes) * 60 * 1000 + static_cast<int>(std::lround(seconds * 1000));
+    if (timeMsecs >= msecsPerDay) {
+        // Leap second
+        timeMsecs = msecsPerDay - 1;
+    }
+    return true;
+}
+
+bool NmeaParser::_parseDate(const char* field, QDate& date)
+{
+    for (int i=0; i<6; i++) {
+        if (field[i] < '0' || field[i] > '9') {
+            return false;
+        }
+    }
+    if (field[6] != 0) {
+        return false;
+    }
+
+    date = QDate(2000 + (field[4] - '0') * 10 + (field[5] - '0'), (field[2] - '0') * 10 + (field[3] - '0'), (field[0] - '0') * 10 + (field[1] - '0'));
+    return date.isValid();
+}
+
+bool NmeaParser::_parseLatLon(const char* value, const char* hemisphere, bool latitude, double& degrees)
+{
+    double rawValue;
+    if (!parseDouble(value, rawValue) || rawValue < 0) {
+        return false;
+    }
+
+    // ddmm.mmmm for latitude, dddmm.mmmm for longitude
+    double wholeDegrees = std::floor(rawValue / 100);
+    double minutes      = rawValue - wholeDegrees * 100;
+    if (minutes >= 60) {
+        return false;
+    }
+    degrees = wholeDegrees + minutes / 60;
+    if (degrees > (latitude ? 90 : 180)) {
+        return false;
+    }
+
+    if (hemisphere[0] == (latitude ? 'S' : 'W')) {
+        degrees = -degrees;
+    } else if (hemisphere[0] != (latitude ? 'N' : 'E')) {
+        return false;
+    }
+    return hemisphere[1] == 0;
+}
+
+void NmeaParser::_processSentence(char* sentence, int length)
+{
+    sentence[length] = 0;
+    _sentenceCount++;
+
+    if (!checksumValid(sentence, length)) {
+        _checksumErrorCount++;
+        return;
+    }
+
+    const char* fields[maxFields];
+    int         fieldCount = tokenize(sentence, length, fields, maxFields);
+
+    // Address is the two character talker id followed by the sentence type, proprietary sentences aren't used
+    const char* address = fields[0];
+    if (strlen(address) != 5 || address[0] == 'P') {
+        return;
+    }
+
+    const char* type = &address[2];
+    if (strcmp(type, "GGA") == 0) {
+        _parseGGA(fields, fieldCount);
+    } else if (strcmp(type, "RMC") == 0) {
+        _parseRMC(fields, fieldCount);
+    } else if (strcmp(type, "VTG") == 0) {
+        _parseVTG(fields, fieldCount);
+    } else if (strcmp(type, "HDT") == 0) {
+        _parseHDT(fields, fieldCount);
+    }
+}
+
+void NmeaParser::_parseGGA(const char* fields[], int fieldCount)
+{
+    // GGA,time,lat,N/S,lon,E/W,quality,satellites,hdop,altitude,M,geoid separation,M,dgps age,dgps station
+    int timeMsecs = -1;
+    _parseTime(_field(fields, fieldCount, 1), timeMsecs);
+    _startSentence(timeMsecs);
+
+    double  latitude, longitude, quality;
+    if (parseDouble(_field(fields, fieldCount, 6), quality) && quality > 0 &&
+            _parseLatLon(_field(fields, fieldCount, 2), _field(fields, fieldCount, 3), true, latitude) &&
+            _parseLatLon(_field(fields, fieldCount, 4), _field(fields, fieldCount, 5), false, longitude)) {
+        _epoch.hasPosition  = true;
+        _epoch.latitude     = latitude;
+        _epoch.longitude    = longitude;
+
+        double altitude;
+        if (parseDouble(_field(fields, fieldCount, 9), altitude)) {
+            _epoch.hasAltitude  = true;
+            _epoch.altitude     = altitude;
+        }
+    }
+
+    _endSentence(SentenceGGA);
+}
+
+void NmeaParser::_parseRMC(const char* fields[], int fieldCount)
+{
+    // RMC,time,status,lat,N/S,lon,E/W,speed knots,course,date,magnetic variation,E/W,mode
+    int timeMsecs = -1;
+    _parseTime(_field(fields, fieldCount, 1), timeMsecs);
+    _startSentence(timeMsecs);
+
+    QDate date;
+    if (_parseDate(_field(fields, fieldCount, 9), date)) {
+        _date           = date;
+        _dateTimeMsecs  = timeMsecs;
+    }
+
+    if (strcmp(_field(fields, fieldCount, 2), "A") == 0 && strcmp(_field(fields, fieldCount, 12), "N") != 0) {
+        double latitude, longitude, speedKnots, course;
+
+        if (_parseLatLon(_field(fields, fieldCount, 3), _field(fields, fieldCount, 4), true, latitude) &&
+                _parseLatLon(_field(fields, fieldCount, 5), _field(fields, fieldCount, 6), false, longitude)) {
+            // GGA has the altitude as well, so it takes precedence for the position
+            if (!_epoch.hasPosition) {
+                _epoch.hasPosition  = true;
+                _epoch.latitude     = latitude;
+                _epoch.longitude    = longitude;
+            }
+        }
+        if (parseDouble(_field(fields, fieldCount, 7), speedKnots)) {
+            _epoch.hasSpeed = true;
+            _epoch.speed    = speedKnots * metersPerSecPerKnot;
+        }
+        if (parseDouble(_field(fields, fieldCount, 8), course)) {
+            _epoch.hasCourse    = true;
+            _epoch.course       = course;
+        }
+    }
+
+    _endSentence(SentenceRMC);
+}
+
+void NmeaParser::_parseVTG(const char* fields[], int fieldCount)
+{
+    // VTG,course,T,magnetic course,M,speed knots,N,speed km/h,K,mode
+    // Before NMEA 2.3 the unit fields weren't sent: VTG,course,magnetic course,speed knots,speed km/h
+    _startSentence(-1);
+
+    bool    unitFields  = strcmp(_field(fields, fieldCount, 2), "T") == 0;
+    int     knotsField  = unitFields ? 5 : 3;
+    int     kmhField    = unitFields ? 7 : 4;
+    double  course, speed;
+
+    if (!unitFields || strcmp(_field(fields, fieldCount, 9), "N") != 0) {
+        if (parseDouble(_field(fields, fieldCount, 1), course)) {
+            _epoch.hasCourse    = true;
+            _epoch.course       = course;
+        }
+        if (parseDouble(_field(fields, fieldCount, kmhField), speed)) {
+            _epoch.hasSpeed = true;
+            _epoch.speed    = speed / 3.6;
+        } else if (parseDouble(_field(fields, fieldCount, knotsField), speed)) {
+            _epoch.hasSpeed = true;
+            _epoch.speed    = speed * metersPerSecPerKnot;
+        }
+    }
+
+    _endSentence(SentenceVTG);
+}
+
+void NmeaParser::_parseHDT(const char* fields[], int fieldCount)
+{
+    // HDT,heading,T
+    _startSentence(-1);
+
+    double heading;
+    if (parseDouble(_field(fields, fieldCount, 1), heading)) {
+        _epoch.hasHeading   = true;
+        _epoch.heading      = heading;
+    }
+
+    _endSentence(SentenceHDT);
+}
+
+void NmeaParser::_startSentence(int timeMsecs)
+{
+    if (_epoch.reported && timeMsecs < 0) {
+        // Sentences without a time which show up after the epoch was reported belong to the next one
+        _finishEpoch();
+    } else if (timeMsecs >= 0 && _epoch.timeMsecs >= 0 && timeMsecs != _epoch.timeMsecs) {
+        _finishEpoch();
+    }
+
+    if (_epoch.timeMsecs < 0) {
+        _epoch.timeMsecs = timeMsecs;
+    }
+}
+
+void NmeaParser::_endSentence(int sentence)
+{
+    _epoch.sentences |= sentence;
+
+    if (!_epoch.reported && _expectedSentences != 0 && (_epoch.sentences & _expectedSentences) == _expectedSentences) {
+        _reportEpoch();
+    }
+}
+
+void NmeaParser::_finishEpoch(void)
+{
+    if (!_epoch.reported) {
+        _reportEpoch();
+    }
+    _expectedSentences = _epoch.sentences;
+    _resetEpoch();
+}
+
+void NmeaParser::_resetEpoch(void)
+{
+    memset(&_epoch, 0, sizeof(_epoch));
+    _epoch.timeMsecs = -1;
+}
+
+void NmeaParser::_reportEpoch(void)
+{
+    _epoch.reported = true;
+    if (!_epoch.hasPosition) {
+        return;
+    }
+
+    QDateTime timestamp = QDateTime::currentDateTimeUtc();
+    if (_epoch.timeMsecs >= 0) {
+        QDate date = _date.isValid() ? _date : timestamp.date();
+        if (_date.isValid() && _epoch.timeMsecs < _dateTimeMsecs - msecsPerDay / 2) {
+            // Past midnight before the RMC with the new date showed up
+            date = date.addDays(1);
+        }
+        timestamp = QDateTime(date, QTime::fromMSecsSinceStartOfDay(_epoch.timeMsecs), Qt::UTC);
+
+        if (_lastFixTimeMsecs >= 0) {
+            int intervalMsecs = _epoch.timeMsecs - _lastFixTimeMsecs;
+            if (intervalMsecs < 0) {
+                intervalMsecs += msecsPerDay;
+            }
+            if (intervalMsecs > 0 && intervalMsecs <= maxUpdateIntervalMsecs) {
+                _updateIntervalMsecs = _updateIntervalMsecs == 0 ? intervalMsecs : (3 * _updateIntervalMsecs + intervalMsecs) / 4;
+            }
+        }
+        _lastFixTimeMsecs = _epoch.timeMsecs;
+    }
+
+    QGeoCoordinate coordinate = _epoch.hasAltitude ?
+                QGeoCoordinate(_epoch.latitude, _epoch.longitude, _epoch.altitude) :
+                QGeoCoordinate(_epoch.latitude, _epoch.longitude);
+    QGeoPositionInfo fix(coordinate, timestamp);
+
+    if (_epoch.hasSpeed) {
+        fix.setAttribute(QGeoPositionInfo::GroundSpeed, _epoch.speed);
+    }
+    // Course over ground is what goes with the speed, heading is only used when there is no course
+    if (_epoch.hasCourse) {
+        fix.setAttribute(QGeoPositionInfo::Direction, _epoch.course);
+    } else if (_epoch.hasHeading) {
+        fix.setAttribute(QGeoPositionInfo::Direction, _epoch.heading);
+    }
+
+    if (_fixCallback) {
+        _fixCallback(fix);
+    }
+}
@@ -0,0 +1,107 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QGeoPositionInfo>
+
+#include <functional>
+
+/// Stream parser for NMEA 0183 position sentences. Sentences are collected in a fixed buffer and split into fields in
+/// place, so parsing doesn't allocate. GGA, RMC, VTG and HDT are understood, with any talker id.
+///
+/// The sentences of one epoch, which receivers send as a burst, are fused into a single fix. An epoch ends when a
+/// sentence with a new time shows up. It is also reported as soon as all the sentences of the previous epoch have
+/// been seen again, which avoids waiting for the next burst once the receiver's sentence set is known.
+class NmeaParser
+{
+public:
+    typedef std::function<void(const QGeoPositionInfo& fix)> FixCallback_t;
+
+    NmeaParser(const FixCallback_t& fixCallback);
+
+    /// Adds bytes from the stream, sentences can be split across calls
+    void addData(const char* data, int length);
+
+    /// @return Interval between the last fixes, from the sentence times. 0 until known.
+    int updateIntervalMsecs(void) const { return _updateIntervalMsecs; }
+
+    quint64 sentenceCount       (void) const { return _sentenceCount; }
+    quint64 checksumErrorCount  (void) const { return _checksumErrorCount; }
+
+    /// Splits a sentence into its fields in place, replacing the separators and the checksum delimiter with nulls
+    ///     @param sentence Sentence without the leading '$' and the line end
+    /// @return Number of fields, fields past maxFields are dropped
+    static int tokenize(char* sentence, int length, const char* fields[], int maxFields);
+
+    /// Checks the checksum of a sentence
+    ///     @param sentence Sentence without the leading '$' and the line end
+    /// @return false: checksum is present and doesn't match
+    static bool checksumValid(const char* sentence, int length);
+
+    /// Locale independent number parse
+    /// @return false: field is empty or not a number
+    static bool parseDouble(const char* field, double& value);
+
+    static const int maxSentenceLength      = 127;      ///< Standard sentences are at most 82, leave room for proprietary ones
+    static const int maxFields              = 32;
+    static const int maxUpdateIntervalMsecs = 10000;    ///< Longer gaps are treated as an interruption of the stream
+
+private:
+    enum {
+        SentenceGGA = 1 << 0,
+        SentenceRMC = 1 << 1,
+        SentenceVTG = 1 << 2,
+        SentenceHDT = 1 << 3,
+    };
+
+    typedef struct {
+        int     timeMsecs;          ///< Msecs since midnight UTC, -1 for unknown
+        int     sentences;          ///< Sentence* mask
+        bool    reported;
+        bool    hasPosition;
+        bool    hasAltitude;
+        bool    hasSpeed;
+        bool    hasCourse;
+        bool    hasHeading;
+        double  latitude;
+        double  longitude;
+        double  altitude;           ///< Meters above mean sea level
+        double  speed;              ///< m/s
+        double  course;             ///< Degrees true, over ground
+        double  heading;            ///< Degrees true
+    } Epoch_t;
+
+    void _processSentence   (char* sentence, int length);
+    void _parseGGA          (const char* fields[], int fieldCount);
+    void _parseRMC          (const char* fields[], int fieldCount);
+    void _parseVTG          (const char* fields[], int fieldCount);
+    void _parseHDT          (const char* fields[], int fieldCount);
+    void _startSentence     (int timeMsecs);
+    void _endSentence       (int sentence);
+    void _finishEpoch       (void);
+    void _reportEpoch       (void);
+    void _resetEpoch        (void);
+
+    static bool _parseTime      (const char* field, int& timeMsecs);
+    static bool _parseDate      (const char* field, QDate& date);
+    static bool _parseLatLon    (const char* value, const char* hemisphere, bool latitude, double& degrees);
+
+    FixCallback_t   _fixCallback;
+    char            _sentence[maxSentenceLength + 1];
+    int             _sentenceLength         = -1;   ///< -1 while waiting for the start of a sentence
+    Epoch_t         _epoch;
+    int             _expectedSentences      = 0;    ///< Sentences of the previous epoch
+    QDate           _date;                          ///< From the last RMC
+    int             _dateTimeMsecs          = -1;   ///< Time of the last RMC
+    int             _lastFixTimeMsecs       = -1;
+    int             _updateIntervalMsecs    = 0;
+    quint64         _sentenceCount          = 0;
+    quint64         _checksumErrorCount     = 0;
+};
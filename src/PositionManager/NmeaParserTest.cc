@@ -0,0 +1,143 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "NmeaParserTest.h"
+#include "NmeaParser.h"
+
+#include <QDateTime>
+
+#include <cstring>
+
+/// @return Sentence with its checksum and line end
+static QByteArray _sentence(const QByteArray& body)
+{
+    int checksum = 0;
+    for (char c: body) {
+        checksum ^= static_cast<unsigned char>(c);
+    }
+    return QByteArray("$") + body + QStringLiteral("*%1\r\n").arg(checksum, 2, 16, QLatin1Char('0')).toUpper().toLatin1();
+}
+
+static void _addData(NmeaParser& parser, const QByteArray& data)
+{
+    parser.addData(data.constData(), data.size());
+}
+
+void NmeaParserTest::_tokenizeTest(void)
+{
+    char        sentence[] = "GPHDT,274.07,T*03";
+    const char* fields[NmeaParser::maxFields];
+
+    int fieldCount = NmeaParser::tokenize(sentence, static_cast<int>(strlen(sentence)), fields, NmeaParser::maxFields);
+    QCOMPARE(fieldCount, 3);
+    QCOMPARE(QString(fields[0]), QStringLiteral("GPHDT"));
+    QCOMPARE(QString(fields[1]), QStringLiteral("274.07"));
+    QCOMPARE(QString(fields[2]), QStringLiteral("T"));
+
+    // Fields past the maximum are dropped
+    char sentence2[] = "GPGSA,,,,";
+    QCOMPARE(NmeaParser::tokenize(sentence2, static_cast<int>(strlen(sentence2)), fields, 3), 3);
+
+    double value;
+    QVERIFY(NmeaParser::parseDouble("-12.5", value));
+    QCOMPARE(value, -12.5);
+    QVERIFY(NmeaParser::parseDouble("4807.038", value));
+    QCOMPARE(value, 4807.038);
+    QVERIFY(!NmeaParser::parseDouble("", value));
+    QVERIFY(!NmeaParser::parseDouble("1,5", value));
+}
+
+void NmeaParserTest::_checksumTest(void)
+{
+    const char* valid   = "GPHDT,274.07,T*03";
+    const char* invalid = "GPHDT,274.07,T*04";
+    const char* none    = "GPHDT,274.07,T";
+
+    QVERIFY(NmeaParser::checksumValid(valid,    static_cast<int>(strlen(valid))));
+    QVERIFY(!NmeaParser::checksumValid(invalid, static_cast<int>(strlen(invalid))));
+    QVERIFY(NmeaParser::checksumValid(none,     static_cast<int>(strlen(none))));
+
+    QList<QGeoPositionInfo> fixes;
+    NmeaParser              parser([&fixes](const QGeoPositionInfo& fix) { fixes.append(fix); });
+
+    _addData(parser, QByteArray("$GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*68\r\n"));
+    QCOMPARE(parser.sentenceCount(), static_cast<quint64>(1));
+    QCOMPARE(parser.checksumErrorCount(), static_cast<quint64>(1));
+}
+
+void NmeaParserTest::_fusionTest(void)
+{
+    QList<QGeoPositionInfo> fixes;
+    NmeaParser              parser([&fixes](const QGeoPositionInfo& fix) { fixes.append(fix); });
+
+    // 10 Hz epochs of RMC, VTG, GGA and HDT
+    for (int i=0; i<3; i++) {
+        QByteArray time = "123519." + QByteArray::number(i) + "0";
+        _addData(parser, _sentence("GNRMC," + time + ",A,4807.038,N,01131.000,E,019.4,084.4,230324,003.1,W,A"));
+        _addData(parser, _sentence("GNVTG,084.4,T,087.5,M,019.4,N,036.0,K,A"));
+        _addData(parser, _sentence("GNGGA," + time + ",4807.038,N,01131.000,E,4,08,0.9,545.4,M,46.9,M,,"));
+        _addData(parser, _sentence("GNHDT,090.0,T"));
+
+        // The first epoch is only reported once the next one starts, after that as soon as the epoch is complete
+        QCOMPARE(fixes.count(), i == 0 ? 0 : i + 1);
+    }
+    _addData(parser, _sentence("GNRMC,123519.30,A,4807.038,N,01131.000,E,019.4,084.4,230324,003.1,W,A"));
+    QCOMPARE(fixes.count(), 3);
+
+    const QGeoPositionInfo& fix = fixes[1];
+    QVERIFY(fix.isValid());
+    QVERIFY(qAbs(fix.coordinate().latitude() - (48 + 7.038 / 60)) < 1e-9);
+    QVERIFY(qAbs(fix.coordinate().longitude() - (11 + 31.0 / 60)) < 1e-9);
+    QVERIFY(qAbs(fix.coordinate().altitude() - 545.4) < 1e-9);
+    QCOMPARE(fix.timestamp(), QDateTime(QDate(2024, 3, 23), QTime(12, 35, 19, 100), Qt::UTC));
+    // Speed from the km/h of VTG, course over ground is preferred to the HDT heading
+    QVERIFY(qAbs(fix.attribute(QGeoPositionInfo::GroundSpeed) - 10.0) < 1e-9);
+    QVERIFY(qAbs(fix.attribute(QGeoPositionInfo::Direction) - 84.4) < 1e-9);
+    QCOMPARE(parser.updateIntervalMsecs(), 100);
+}
+
+void NmeaParserTest::_splitDataTest(void)
+{
+    QList<QGeoPositionInfo> fixes;
+    NmeaParser              parser([&fixes](const QGeoPositionInfo& fix) { fixes.append(fix); });
+
+    QByteArray data;
+    data += QByteArray("garbage before the first sentence");
+    data += _sentence("GPGGA,000001.00,3723.2475,S,12158.3416,W,1,07,1.0,9.0,M,,,,");
+    data += _sentence("GPGGA,000002.00,3723.2475,S,12158.3416,W,1,07,1.0,9.0,M,,,,");
+    data += _sentence("GPGGA,000003.00,3723.2475,S,12158.3416,W,1,07,1.0,9.0,M,,,,");
+
+    // One byte at a time must give the same result as a single block
+    for (int i=0; i<data.size(); i++) {
+        parser.addData(data.constData() + i, 1);
+    }
+
+    QCOMPARE(fixes.count(), 3);
+    QVERIFY(qAbs(fixes[0].coordinate().latitude() + (37 + 23.2475 / 60)) < 1e-9);
+    QVERIFY(qAbs(fixes[0].coordinate().longitude() + (121 + 58.3416 / 60)) < 1e-9);
+    QCOMPARE(fixes[2].timestamp().time(), QTime(0, 0, 3));
+    QCOMPARE(parser.updateIntervalMsecs(), 1000);
+}
+
+void NmeaParserTest::_invalidFixTest(void)
+{
+    QList<QGeoPositionInfo> fixes;
+    NmeaParser              parser([&fixes](const QGeoPositionInfo& fix) { fixes.append(fix); });
+
+    // No fix from either sentence
+    _addData(parser, _sentence("GPRMC,000001.00,V,,,,,,,230394,,,N"));
+    _addData(parser, _sentence("GPGGA,000001.00,,,,,0,00,99.9,,,,,,"));
+    _addData(parser, _sentence("GPRMC,000002.00,V,,,,,,,230394,,,N"));
+    _addData(parser, _sentence("GPGGA,000002.00,,,,,0,00,99.9,,,,,,"));
+    QCOMPARE(fixes.count(), 0);
+
+    // Sentence which is too long is dropped
+    _addData(parser, QByteArray("$GPGGA,") + QByteArray(NmeaParser::maxSentenceLength, '0') + "\r\n");
+    QCOMPARE(parser.sentenceCount(), static_cast<quint64>(4));
+}
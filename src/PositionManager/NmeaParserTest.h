@@ -0,0 +1,25 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for NmeaParser
+class NmeaParserTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _tokenizeTest      (void);
+    void _checksumTest      (void);
+    void _fusionTest        (void);
+    void _splitDataTest     (void);
+    void _invalidFixTest    (void);
+};
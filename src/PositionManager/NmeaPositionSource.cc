@@ -0,0 +1,123 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "NmeaPositionSource.h"
+
+NmeaPositionSource::NmeaPositionSource(QObject* parent)
+    : QGeoPositionInfoSource(parent)
+{
+    qRegisterMetaType<QGeoPositionInfo>("QGeoPositionInfo");
+
+    // The worker is deleted on its own thread once the thread is done
+    NmeaPositionWorker* worker = new NmeaPositionWorker();
+    worker->moveToThread(&_parserThread);
+    connect(&_parserThread, &QThread::finished,                     worker, &QObject::deleteLater);
+    connect(this,           &NmeaPositionSource::_dataReceived,     worker, &NmeaPositionWorker::addData,           Qt::QueuedConnection);
+    connect(worker,         &NmeaPositionWorker::fixReceived,       this,   &NmeaPositionSource::_fixReceived,      Qt::QueuedConnection);
+    _parserThread.setObjectName(QStringLiteral("NmeaParser"));
+    _parserThread.start();
+}
+
+NmeaPositionSource::~NmeaPositionSource()
+{
+    stopUpdates();
+    _parserThread.quit();
+    _parserThread.wait();
+}
+
+void NmeaPositionSource::setDevice(QIODevice* device)
+{
+    bool running = _running;
+
+    stopUpdates();
+    _device = device;
+    if (running) {
+        startUpdates();
+    }
+}
+
+QGeoPositionInfo NmeaPositionSource::lastKnownPosition(bool /*fromSatellitePositioningMethodsOnly*/) const
+{
+    return _lastFix;
+}
+
+void NmeaPositionSource::startUpdates(void)
+{
+    if (_running) {
+        return;
+    }
+
+    if (!_device || (!_device->isOpen() && !_device->open(QIODevice::ReadOnly))) {
+        _error = AccessError;
+        emit QGeoPositionInfoSource::error(_error);
+        return;
+    }
+
+    _error      = NoError;
+    _running    = true;
+    connect(_device, &QIODevice::readyRead, this, &NmeaPositionSource::_readDevice);
+    _readDevice();
+}
+
+void NmeaPositionSource::stopUpdates(void)
+{
+    if (_running) {
+        _running = false;
+        if (_device) {
+            disconnect(_device, &QIODevice::readyRead, this, &NmeaPositionSource::_readDevice);
+        }
+    }
+}
+
+void NmeaPositionSource::requestUpdate(int /*timeout*/)
+{
+    if (_lastFix.isValid()) {
+        emit positionUpdated(_lastFix);
+    } else {
+        emit updateTimeout();
+    }
+}
+
+void NmeaPositionSource::_readDevice(void)
+{
+    // Whole lines only, UdpIODevice only supports line reads
+    QByteArray data;
+    while (_device->canReadLine()) {
+        qint64 length = _device->readLine(_line, sizeof(_line));
+        if (length <= 0) {
+            break;
+        }
+        data.append(_line, static_cast<int>(length));
+    }
+
+    if (!data.isEmpty()) {
+        emit _dataReceived(data);
+    }
+}
+
+void NmeaPositionSource::_fixReceived(QGeoPositionInfo fix, int updateIntervalMsecs)
+{
+    _lastFix                = fix;
+    _updateIntervalMsecs    = updateIntervalMsecs;
+    if (_running) {
+        emit positionUpdated(fix);
+    }
+}
+
+NmeaPositionWorker::NmeaPositionWorker(QObject* parent)
+    : QObject   (parent)
+    , _parser   ([this](const QGeoPositionInfo& fix) { emit fixReceived(fix, _parser.updateIntervalMsecs()); })
+{
+
+}
+
+void NmeaPositionWorker::addData(const QByteArray& data)
+{
+    _parser.addData(data.constData(), data.size());
+}
@@ -0,0 +1,81 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "NmeaParser.h"
+
+#include <QByteArray>
+#include <QGeoPositionInfoSource>
+#include <QIODevice>
+#include <QThread>
+
+/// Position source for an NMEA stream from a serial port or UDP socket. The device is read on the thread which owns it,
+/// normally the GUI thread, which only copies the lines out. Parsing happens on a parser thread, which sends back one
+/// fused fix per receiver epoch, so updates come at the rate of the receiver.
+class NmeaPositionSource : public QGeoPositionInfoSource
+{
+    Q_OBJECT
+
+public:
+    NmeaPositionSource(QObject* parent = nullptr);
+    ~NmeaPositionSource();
+
+    /// Sets the device to read from, ownership stays with the caller. A device which isn't open yet is opened read only
+    /// when updates start.
+    void setDevice(QIODevice* device);
+
+    QIODevice* device(void) const { return _device; }
+
+    QGeoPositionInfo lastKnownPosition(bool fromSatellitePositioningMethodsOnly = false) const override;
+
+    PositioningMethods  supportedPositioningMethods (void) const override { return SatellitePositioningMethods; }
+    /// Interval between the epochs of the receiver, 0 until known
+    int                 minimumUpdateInterval       (void) const override { return _updateIntervalMsecs; }
+    Error               error                       (void) const override { return _error; }
+
+public slots:
+    void startUpdates   (void) override;
+    void stopUpdates    (void) override;
+    void requestUpdate  (int timeout = 5000) override;
+
+signals:
+    void _dataReceived(QByteArray data);    ///< To the parser thread
+
+private slots:
+    void _readDevice    (void);
+    void _fixReceived   (QGeoPositionInfo fix, int updateIntervalMsecs);
+
+private:
+    QIODevice*          _device                 = nullptr;
+    bool                _running                = false;
+    Error               _error                  = NoError;
+    QGeoPositionInfo    _lastFix;
+    int                 _updateIntervalMsecs    = 0;
+    QThread             _parserThread;
+    char                _line[NmeaParser::maxSentenceLength + 3];   ///< Room for the '$', line end and null
+};
+
+/// Lives on the parser thread of a NmeaPositionSource
+class NmeaPositionWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    NmeaPositionWorker(QObject* parent = nullptr);
+
+public slots:
+    void addData(const QByteArray& data);
+
+signals:
+    void fixReceived(QGeoPositionInfo fix, int updateIntervalMsecs);
+
+private:
+    NmeaParser _parser;
+};
@@ -66,7 +66,7 @@ void QGCPositionManager::setNmeaSourceDevice(QIODevice* device)
         _nmeaSource = nullptr;
 
     }
-    _nmeaSource = new QNmeaPositionInfoSource(QNmeaPositionInfoSource::RealTimeMode, this);
+    _nmeaSource = new NmeaPositionSource(this);
     _nmeaSource->setDevice(device);
     setPositionSource(QGCPositionManager::NmeaGPS);
 }
@@ -75,6 +75,11 @@ void QGCPositionManager::_positionUpdated(const QGeoPositionInfo &update)
 {
     _geoPositionInfo = update;
 
+    if (_currentSource && _currentSource == _nmeaSource) {
+        // The NMEA source only knows its rate once the receiver's epochs have been seen
+        _updateInterval = _nmeaSource->minimumUpdateInterval();
+    }
+
     QGeoCoordinate newGCSPosition = QGeoCoordinate();
     qreal newGCSHeading = update.attribute(QGeoPositionInfo::Direction);
 
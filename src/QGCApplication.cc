@@ -69,6 +69,8 @@
 #include "QGroundControlQmlGlobal.h"
 #include "FlightMapSettings.h"
 #include "FlightPathSegment.h"
+#include "FlightPathLOD.h"
+#include "VisualItemsViewportModel.h"
 #include "PlanMasterController.h"
 #include "VideoManager.h"
 #include "VideoReceiver.h"
@@ -86,28 +88,44 @@
 #include "QGCMapPolygon.h"
 #include "QGCMapCircle.h"
 #include "ParameterManager.h"
+#include "ComponentInformationManager.h"
+#include "FactMetaDataStore.h"
 #include "SettingsManager.h"
+#include "SettingsStore.h"
 #include "QGCCorePlugin.h"
 #include "QGCCameraManager.h"
+#include "QGCCameraMedia.h"
 #include "CameraCalc.h"
 #include "VisualMissionItem.h"
 #include "EditPositionDialogController.h"
 #include "FactValueSliderListModel.h"
 #include "ShapeFileHelper.h"
 #include "QGCFileDownload.h"
+#include "QGCNetworkService.h"
 #include "FirmwareImage.h"
 #include "MavlinkConsoleController.h"
+#include "LogIndexController.h"
 #include "GeoTagController.h"
+#include "VibrationController.h"
 #include "LogReplayLink.h"
 #include "VehicleObjectAvoidance.h"
 #include "TrajectoryPoints.h"
+#include "ADSBTargetModel.h"
+#include "QGCResourceBundles.h"
+#include "VehicleEscStatusModel.h"
+#include "VehicleBatteryStatusModel.h"
+#include "TrafficConflictEngine.h"
 #include "RCToParamDialogController.h"
 #include "QGCImageProvider.h"
 #include "TerrainProfile.h"
+#include "ObstacleDistanceItem.h"
 #include "ToolStripAction.h"
 #include "ToolStripActionList.h"
+#include "VehicleMarkerLayer.h"
 #include "QGCMAVLink.h"
 #include "VehicleLinkManager.h"
+#include "QGCTrace.h"
+#include "QGCMemoryAccounting.h"
 
 #if defined(QGC_ENABLE_PAIRING)
 #include "PairingManager.h"
@@ -189,16 +207,18 @@ static QObject* shapeFileHelperSingletonFactory(QQmlEngine*, QJSEngine*)
     return new ShapeFileHelper;
 }
 
-QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting)
+QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting, bool analyzing, bool relaying)
     : QApplication          (argc, argv)
     , _runningUnitTests     (unitTesting)
+    , _runningAnalyze       (analyzing)
+    , _runningRelay         (relaying)
 {
     _app = this;
     _msecsElapsedTime.start();
 
 #ifdef Q_OS_LINUX
 #ifndef __mobile__
-    if (!_runningUnitTests) {
+    if (!_runningUnitTests && !_runningAnalyze && !_runningRelay) {
         if (getuid() == 0) {
             _exitWithError(QString(
                 tr("You are running %1 as root. "
@@ -243,6 +263,8 @@ QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting)
     bool fClearCache = false;           // Clear parameter/airframe caches
     bool logging = false;               // Turn on logging
     QString loggingOptions;
+    bool trace = false;                 // Start tracing, written on exit
+    QString traceFile;
 
     CmdLineOpt_t rgCmdLineOptions[] = {
         { "--clear-settings",   &fClearSettingsOptions, nullptr },
@@ -250,6 +272,7 @@ QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting)
         { "--logging",          &logging,               &loggingOptions },
         { "--fake-mobile",      &_fakeMobile,           nullptr },
         { "--log-output",       &_logOutput,            nullptr },
+        { "--trace",            &trace,                 &traceFile },
         // Add additional command line option flags here
     };
 
@@ -266,6 +289,12 @@ QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting)
         // We don't want unit tests to use the same QSettings space as the normal app. So we tweak the app
         // name. Also we want to run unit tests with clean settings every time.
         applicationName = QStringLiteral("%1_unittest").arg(QGC_APPLICATION_NAME);
+    } else if (_runningAnalyze) {
+        // Analysis workers run side by side, possibly next to the normal app, so they get their own settings space too
+        applicationName = QStringLiteral("%1_analyze").arg(QGC_APPLICATION_NAME);
+    } else if (_runningRelay) {
+        // Relays keep their links and forwarding targets apart from the normal app on the same machine
+        applicationName = QStringLiteral("%1_relay").arg(QGC_APPLICATION_NAME);
     } else {
 #ifdef DAILY_BUILD
         // This gives daily builds their own separate settings space. Allowing you to use daily and stable builds
@@ -307,6 +336,8 @@ QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting)
         QDir paramDir(ParameterManager::parameterCacheDir());
         paramDir.removeRecursively();
         paramDir.mkpath(paramDir.absolutePath());
+        QDir(ComponentInformationManager::cacheDir()).removeRecursively();
+        QDir(FactMetaDataStore::storeDir()).removeRecursively();
     } else {
         // Determine if upgrade message for settings version bump is required. Check and clear must happen before toolbox is started since
         // that will write some settings.
@@ -322,6 +353,8 @@ QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting)
     if (fClearCache) {
         QDir dir(ParameterManager::parameterCacheDir());
         dir.removeRecursively();
+        QDir(ComponentInformationManager::cacheDir()).removeRecursively();
+        QDir(FactMetaDataStore::storeDir()).removeRecursively();
         QFile airframe(cachedAirframeMetaDataFile());
         airframe.remove();
         QFile parameter(cachedParameterMetaDataFile());
@@ -331,6 +364,10 @@ QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting)
     // Set up our logging filters
     QGCLoggingCategoryRegister::instance()->setFilterRulesFromSettings(loggingOptions);
 
+    if (trace) {
+        startTrace(traceFile);
+    }
+
     // Initialize Bluetooth
 #ifdef QGC_ENABLE_BLUETOOTH
     QBluetoothLocalDevice localDevice;
@@ -347,8 +384,11 @@ QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting)
     }
 
 #if defined(QGC_GST_STREAMING)
-    // Initialize Video Receiver
-    GStreamer::initialize(argc, argv, gstDebugLevel);
+    // Initialize Video Receiver. The plugin registry scan runs while the toolbox is set up, VideoManager waits for it.
+    // Relays have no VideoManager.
+    if (!_runningRelay) {
+        GStreamer::initializeAsync(argc, argv, gstDebugLevel);
+    }
 #else
     Q_UNUSED(gstDebugLevel)
 #endif
@@ -356,8 +396,11 @@ QGCApplication::QGCApplication(int &argc, char* argv[], bool unitTesting)
     // We need to set language as early as possible prior to loading on JSON files.
     setLanguage();
 
+    // SettingsManager creates its SettingsFacts from the toolbox constructor
+    _settingsStore = new SettingsStore(this);
     _toolbox = new QGCToolbox(this);
     _toolbox->setChildToolboxes();
+    qCDebug(StartupLog) << "Toolbox set up at" << _msecsElapsedTime.elapsed() << "msecs";
 
 #ifndef __mobile__
     _gpsRtkFactGroup = new GPSRTKFactGroup(this);
@@ -458,6 +501,9 @@ void QGCApplication::setLanguage()
     //-- We have specific fonts for Korean
     if(_locale == QLocale::Korean) {
         qCDebug(LocalizationLog) << "Loading Korean fonts" << _locale.name();
+        if(!QGCResourceBundles::load(QStringLiteral("qgckoreanfonts"))) {
+            qCWarning(LocalizationLog) << "Korean font bundle is not installed";
+        }
         if(QFontDatabase::addApplicationFont(":/fonts/NanumGothic-Regular") < 0) {
             qCWarning(LocalizationLog) << "Could not load /fonts/NanumGothic-Regular font";
         }
@@ -471,6 +517,9 @@ void QGCApplication::setLanguage()
     _app->removeTranslator(&_qgcTranslatorQtLibs);
     if (_locale.name() != "en_US") {
         QLocale::setDefault(_locale);
+        // English needs no translations, they are only registered once another language is used. The bundle is
+        // optional, the translations may also be compiled in.
+        QGCResourceBundles::load(QStringLiteral("qgci18n"));
         if(_qgcTranslatorQtLibs.load("qt_" + _locale.name(), QLibraryInfo::location(QLibraryInfo::TranslationsPath))) {
             _app->installTranslator(&_qgcTranslatorQtLibs);
         } else {
@@ -494,10 +543,15 @@ void QGCApplication::setLanguage()
 
 void QGCApplication::_shutdown()
 {
+    // Write the trace while the settings which tell where to are still around
+    if (_tracing) {
+        stopTrace();
+    }
     // Close out all Qml before we delete toolbox. This way we don't get all sorts of null reference complaints from Qml.
     delete _qmlAppEngine;
     delete _toolbox;
     delete _gpsRtkFactGroup;
+    _settingsStore->flush();
 }
 
 QGCApplication::~QGCApplication()
@@ -527,6 +581,8 @@ void QGCApplication::_initCommon()
     qmlRegisterUncreatableType<VehicleObjectAvoidance>  (kQGCVehicle,                       1, 0, "VehicleObjectAvoidance",     kRefOnly);
     qmlRegisterUncreatableType<QGCCameraManager>        (kQGCVehicle,                       1, 0, "QGCCameraManager",           kRefOnly);
     qmlRegisterUncreatableType<QGCCameraControl>        (kQGCVehicle,                       1, 0, "QGCCameraControl",           kRefOnly);
+    qmlRegisterUncreatableType<QGCCameraMedia>          (kQGCVehicle,                       1, 0, "QGCCameraMedia",             kRefOnly);
+    qmlRegisterUncreatableType<QGCCameraMediaItem>      (kQGCVehicle,                       1, 0, "QGCCameraMediaItem",         kRefOnly);
     qmlRegisterUncreatableType<QGCVideoStreamInfo>      (kQGCVehicle,                       1, 0, "QGCVideoStreamInfo",         kRefOnly);
     qmlRegisterUncreatableType<LinkInterface>           (kQGCVehicle,                       1, 0, "LinkInterface",              kRefOnly);
     qmlRegisterUncreatableType<VehicleLinkManager>      (kQGCVehicle,                       1, 0, "VehicleLinkManager",         kRefOnly);
@@ -534,10 +590,20 @@ void QGCApplication::_initCommon()
     qmlRegisterUncreatableType<MissionController>       (kQGCControllers,                   1, 0, "MissionController",          kRefOnly);
     qmlRegisterUncreatableType<GeoFenceController>      (kQGCControllers,                   1, 0, "GeoFenceController",         kRefOnly);
     qmlRegisterUncreatableType<RallyPointController>    (kQGCControllers,                   1, 0, "RallyPointController",       kRefOnly);
+    qmlRegisterUncreatableType<PlanUndoStack>           (kQGCControllers,                   1, 0, "PlanUndoStack",              kRefOnly);
 
     qmlRegisterUncreatableType<MissionItem>         (kQGroundControl,                       1, 0, "MissionItem",                kRefOnly);
     qmlRegisterUncreatableType<VisualMissionItem>   (kQGroundControl,                       1, 0, "VisualMissionItem",          kRefOnly);
     qmlRegisterUncreatableType<FlightPathSegment>    (kQGroundControl,                       1, 0, "FlightPathSegment",           kRefOnly);
+    qmlRegisterUncreatableType<FlightPathLOD>       (kQGroundControl,                       1, 0, "FlightPathLOD",              kRefOnly);
+    qmlRegisterUncreatableType<VideoStreamPool>     (kQGroundControl,                       1, 0, "VideoStreamPool",            kRefOnly);
+    qmlRegisterUncreatableType<VisualItemsViewportModel>(kQGroundControl,                   1, 0, "VisualItemsViewportModel",   kRefOnly);
+    qmlRegisterUncreatableType<ADSBTargetModel>     (kQGroundControl,                       1, 0, "ADSBTargetModel",            kRefOnly);
+    qmlRegisterUncreatableType<VehicleEscStatusModel>(kQGroundControl,                      1, 0, "VehicleEscStatusModel",      kRefOnly);
+    qmlRegisterUncreatableType<VehicleBatteryStatusModel>(kQGroundControl,                  1, 0, "VehicleBatteryStatusModel",  kRefOnly);
+    qmlRegisterUncreatableType<TrafficConflict>     (kQGroundControl,                       1, 0, "TrafficConflict",            kRefOnly);
+    qmlRegisterUncreatableType<UASMessageModel>     (kQGroundControl,                       1, 0, "UASMessageModel",            kRefOnly);
+    qmlRegisterUncreatableType<QGCMemoryAccounting> (kQGroundControl,                       1, 0, "QGCMemoryAccounting",        kRefOnly);
     qmlRegisterUncreatableType<QmlObjectListModel>  (kQGroundControl,                       1, 0, "QmlObjectListModel",         kRefOnly);
     qmlRegisterUncreatableType<MissionCommandTree>  (kQGroundControl,                       1, 0, "MissionCommandTree",         kRefOnly);
     qmlRegisterUncreatableType<CameraCalc>          (kQGroundControl,                       1, 0, "CameraCalc",                 kRefOnly);
@@ -580,8 +646,10 @@ void QGCApplication::_initCommon()
     qmlRegisterType<RCToParamDialogController>      (kQGCControllers,                       1, 0, "RCToParamDialogController");
 
     qmlRegisterType<TerrainProfile>                 ("QGroundControl.Controls",             1, 0, "TerrainProfile");
+    qmlRegisterType<ObstacleDistanceItem>           ("QGroundControl.Controls",             1, 0, "ObstacleDistanceItem");
     qmlRegisterType<ToolStripAction>                ("QGroundControl.Controls",             1, 0, "ToolStripAction");
     qmlRegisterType<ToolStripActionList>            ("QGroundControl.Controls",             1, 0, "ToolStripActionList");
+    qmlRegisterType<VehicleMarkerLayer>             ("QGroundControl.Controls",             1, 0, "VehicleMarkerLayer");
 
 #ifndef __mobile__
 #ifndef NO_SERIAL_LINK
@@ -590,6 +658,8 @@ void QGCApplication::_initCommon()
 #endif
     qmlRegisterType<GeoTagController>               (kQGCControllers,                       1, 0, "GeoTagController");
     qmlRegisterType<MavlinkConsoleController>       (kQGCControllers,                       1, 0, "MavlinkConsoleController");
+    qmlRegisterType<VibrationController>            (kQGCControllers,                       1, 0, "VibrationController");
+    qmlRegisterType<LogIndexController>             (kQGCControllers,                       1, 0, "LogIndexController");
 #if defined(QGC_ENABLE_MAVLINK_INSPECTOR)
     qmlRegisterType<MAVLinkInspectorController>     (kQGCControllers,                       1, 0, "MAVLinkInspectorController");
 #endif
@@ -607,6 +677,8 @@ void QGCApplication::_initCommon()
     if(QFontDatabase::addApplicationFont(":/fonts/opensans-demibold") < 0) {
         qWarning() << "Could not load /fonts/opensans-demibold font";
     }
+
+    qCDebug(StartupLog) << "Qml types registered at" << _msecsElapsedTime.elapsed() << "msecs";
 }
 
 bool QGCApplication::_initForNormalAppBoot()
@@ -615,6 +687,7 @@ bool QGCApplication::_initForNormalAppBoot()
 
     _qmlAppEngine = toolbox()->corePlugin()->createQmlApplicationEngine(this);
     toolbox()->corePlugin()->createRootWindow(_qmlAppEngine);
+    qCDebug(StartupLog) << "Main window loaded at" << _msecsElapsedTime.elapsed() << "msecs";
 
     // Image provider for PX4 Flow
     QQuickImageProvider* pImgProvider = dynamic_cast<QQuickImageProvider*>(qgcApp()->toolbox()->imageProvider());
@@ -625,6 +698,9 @@ bool QGCApplication::_initForNormalAppBoot()
     if (rootWindow) {
         rootWindow->scheduleRenderJob (new FinishVideoInitialization (toolbox()->videoManager()),
                 QQuickWindow::BeforeSynchronizingStage);
+        // Work which isn't needed to show the ui waits until it is shown. With the threaded render loop the signal comes
+        // from the render thread, so it is queued to us.
+        _firstFrameConnection = connect(rootWindow, &QQuickWindow::frameSwapped, this, &QGCApplication::_firstFrameSwapped);
     }
 
     // Safe to show popup error messages now that main window is created
@@ -633,35 +709,83 @@ bool QGCApplication::_initForNormalAppBoot()
         msgHandler->showErrorsInToolbar();
     }
 
-    // Now that main window is up check for lost log files
     connect(this, &QGCApplication::checkForLostLogFiles, toolbox()->mavlinkProtocol(), &MAVLinkProtocol::checkForLostLogFiles);
-    emit checkForLostLogFiles();
 
     // Load known link configurations
     toolbox()->linkManager()->loadLinkConfigurationList();
 
-    // Probe for joysticks
-    toolbox()->joystickManager()->init();
-
     if (_settingsUpgraded) {
         showAppMessage(QString(tr("The format for %1 saved settings has been modified. "
                     "Your saved settings have been reset to defaults.")).arg(applicationName()));
     }
 
-    // Connect links with flag AutoconnectLink
-    toolbox()->linkManager()->startAutoConnectedLinks();
-
     if (getQGCMapEngine()->wasCacheReset()) {
         showAppMessage(tr("The Offline Map Cache database has been upgraded. "
                     "Your old map cache sets have been reset."));
     }
 
     settings.sync();
+
+    if (!rootWindow) {
+        _firstFrameSwapped();
+    }
+    return true;
+}
+
+void QGCApplication::_firstFrameSwapped(void)
+{
+    disconnect(_firstFrameConnection);
+    // Frames queued ahead of the disconnect still arrive
+    if (_deferredInitDone) {
+        return;
+    }
+    qCDebug(StartupLog) << "First frame at" << _msecsElapsedTime.elapsed() << "msecs";
+
+    // Now that main window is up check for lost log files
+    emit checkForLostLogFiles();
+
+    // Probe for joysticks
+    toolbox()->joystickManager()->init();
+
+    // Connect links with flag AutoconnectLink
+    toolbox()->linkManager()->startAutoConnectedLinks();
+
+    _deferredInitDone = true;
+    _toolbox->deferredInitChildToolboxes();
+    qCDebug(StartupLog) << "Startup done at" << _msecsElapsedTime.elapsed() << "msecs";
+}
+
+bool QGCApplication::_initForRelay()
+{
+    connect(this, &QGCApplication::checkForLostLogFiles, toolbox()->mavlinkProtocol(), &MAVLinkProtocol::checkForLostLogFiles);
+
+    // Load known link configurations
+    toolbox()->linkManager()->loadLinkConfigurationList();
+
+    if (_settingsUpgraded) {
+        showAppMessage(QString(tr("The format for %1 saved settings has been modified. "
+                    "Your saved settings have been reset to defaults.")).arg(applicationName()));
+    }
+
+    QSettings().sync();
+
+    // There is no first frame to wait for. Joysticks aren't probed since nothing flies from a relay.
+    emit checkForLostLogFiles();
+    toolbox()->linkManager()->startAutoConnectedLinks();
+
+    _deferredInitDone = true;
+    _toolbox->deferredInitChildToolboxes();
+    qCDebug(StartupLog) << "Relay started at" << _msecsElapsedTime.elapsed() << "msecs";
     return true;
 }
 
 bool QGCApplication::_initForUnitTests()
 {
+    // Stress testing calls this once per pass
+    if (!_deferredInitDone) {
+        _deferredInitDone = true;
+        _toolbox->deferredInitChildToolboxes();
+    }
     return true;
 }
 
@@ -727,6 +851,41 @@ void QGCApplication::saveTelemetryLogOnMainThread(QString tempLogfile)
     QFile::remove(tempLogfile);
 }
 
+void QGCApplication::startTrace(const QString& fileName)
+{
+    if (_tracing) {
+        return;
+    }
+    _traceFile  = fileName;
+    _tracing    = true;
+    QGCTrace::start();
+    emit tracingChanged(true);
+}
+
+QString QGCApplication::stopTrace(void)
+{
+    if (!_tracing) {
+        return QString();
+    }
+    _tracing = false;
+    emit tracingChanged(false);
+
+    QString traceFile = _traceFile;
+    if (traceFile.isEmpty()) {
+        QString saveDirPath = _toolbox ? _toolbox->settingsManager()->appSettings()->logSavePath() : QString();
+        if (saveDirPath.isEmpty()) {
+            saveDirPath = QDir::tempPath();
+        }
+        traceFile = QDir(saveDirPath).absoluteFilePath(QStringLiteral("trace-%1.json").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd hh-mm-ss")));
+    }
+    if (!QGCTrace::stop(traceFile)) {
+        qWarning() << "Unable to write trace file" << traceFile;
+        return QString();
+    }
+    qDebug() << "Trace written to" << traceFile;
+    return traceFile;
+}
+
 void QGCApplication::checkTelemetrySavePathOnMainThread()
 {
     // This is called with an active vehicle so don't pop message boxes which holds ui thread
@@ -803,6 +962,8 @@ void QGCApplication::showCriticalVehicleMessage(const QString& message)
     } else if (runningUnitTests()) {
         // Unit tests can run without UI
         qDebug() << "QGCApplication::showCriticalVehicleMessage unittest" << message;
+    } else if (runningRelay()) {
+        qWarning() << "Critical vehicle message:" << message;
     } else {
         qWarning() << "Internal error";
     }
@@ -817,9 +978,9 @@ void QGCApplication::showAppMessage(const QString& message, const QString& title
         QVariant varReturn;
         QVariant varMessage = QVariant::fromValue(message);
         QMetaObject::invokeMethod(_rootQmlObject(), "showMessageDialog", Q_RETURN_ARG(QVariant, varReturn), Q_ARG(QVariant, dialogTitle), Q_ARG(QVariant, varMessage));
-    } else if (runningUnitTests()) {
-        // Unit tests can run without UI
-        qDebug() << "QGCApplication::showAppMessage unittest title:message" << dialogTitle << message;
+    } else if (runningUnitTests() || runningAnalyze() || runningRelay()) {
+        // Unit tests, log analysis and relays run without UI
+        qDebug() << "QGCApplication::showAppMessage no ui title:message" << dialogTitle << message;
     } else {
         // UI isn't ready yet
         _delayedAppMessages.append(QPair<QString, QString>(dialogTitle, message));
@@ -863,9 +1024,7 @@ void QGCApplication::qmlAttemptWindowClose()
 
 bool QGCApplication::isInternetAvailable()
 {
-    if(_toolbox->settingsManager()->appSettings()->checkInternet()->rawValue().toBool())
-        return getQGCMapEngine()->isInternetActive();
-    return true;
+    return _toolbox->networkService()->internetAvailable();
 }
 
 void QGCApplication::_checkForNewVersion()
@@ -40,6 +40,7 @@
 class QQmlApplicationEngine;
 class QGCSingleton;
 class QGCToolbox;
+class SettingsStore;
 
 /**
  * @brief The main application and management class.
@@ -57,7 +58,7 @@ class QGCApplication : public QApplication
 {
     Q_OBJECT
 public:
-    QGCApplication(int &argc, char* argv[], bool unitTesting);
+    QGCApplication(int &argc, char* argv[], bool unitTesting, bool analyzing = false, bool relaying = false);
     ~QGCApplication();
 
     /// @brief Sets the persistent flag to delete all settings the next time QGroundControl is started.
@@ -69,6 +70,12 @@ public:
     /// @brief Returns true if unit tests are being run
     bool runningUnitTests(void) { return _runningUnitTests; }
 
+    /// @return true: Running headless as a log analysis worker, see TlogAnalyzeRunner
+    bool runningAnalyze(void) { return _runningAnalyze; }
+
+    /// @return true: Running headless as a MAVLink relay, see _initForRelay
+    bool runningRelay(void) { return _runningRelay; }
+
     /// @brief Returns true if Qt debug output should be logged to a file
     bool logOutput(void) { return _logOutput; }
 
@@ -96,6 +103,8 @@ public:
 
     FactGroup* gpsRtkFactGroup(void)  { return _gpsRtkFactGroup; }
 
+    SettingsStore* settingsStore(void) { return _settingsStore; }
+
     QTranslator& qgcJSONTranslator(void) { return _qgcTranslatorJSON; }
 
     void            setLanguage();
@@ -110,6 +119,14 @@ public:
     static QString cachedParameterMetaDataFile(void);
     static QString cachedAirframeMetaDataFile(void);
 
+    /// Starts collecting the trace points for a Chrome trace, see QGCTrace
+    ///     @param fileName File the trace is written to, empty for a new file in the log save path
+    void    startTrace  (const QString& fileName = QString());
+    /// Writes the trace started with startTrace
+    /// @return File written, empty if tracing wasn't running or the file couldn't be written
+    QString stopTrace   (void);
+    bool    tracing     (void) const { return _tracing; }
+
 public slots:
     /// You can connect to this slot to show an information message box from a different thread.
     void informationMessageBoxOnMainThread(const QString& title, const QString& msg);
@@ -139,6 +156,7 @@ signals:
     void checkForLostLogFiles   ();
 
     void languageChanged        (const QLocale locale);
+    void tracingChanged         (bool tracing);
 
 public:
     // Although public, these methods are internal and should only be called by UnitTest code
@@ -155,6 +173,11 @@ public:
     ///         unit tests. Although public should only be called by main.
     bool _initForUnitTests();
 
+    /// @brief Initialize the application to run headless as a relay which only routes, forwards and logs MAVLink.
+    ///         There is no Qml, video or maps and the toolbox leaves out the tools which only serve them, see QGCToolbox.
+    ///         Each link frames its traffic on its own thread. Although public should only be called by main.
+    bool _initForRelay();
+
     static QGCApplication*  _app;   ///< Our own singleton. Should be reference directly by qgcApp
 
     bool    isErrorState()  { return _error; }
@@ -176,6 +199,7 @@ private slots:
     void _gpsSurveyInStatus                         (float duration, float accuracyMM,  double latitude, double longitude, float altitude, bool valid, bool active);
     void _gpsNumSatellites                          (int numSatellites);
     void _showDelayedAppMessages                    (void);
+    void _firstFrameSwapped                         (void);
 
 private:
     QObject*    _rootQmlObject          ();
@@ -186,6 +210,8 @@ private:
     bool compressEvent(QEvent *event, QObject *receiver, QPostEventList *postedEvents) override;
 
     bool                        _runningUnitTests;                                  ///< true: running unit tests, false: normal app
+    bool                        _runningAnalyze;                                    ///< true: running as a headless log analysis worker
+    bool                        _runningRelay;                                      ///< true: running as a headless MAVLink relay
     static const int            _missingParamsDelayedDisplayTimerTimeout = 1000;    ///< Timeout to wait for next missing fact to come in before display
     QTimer                      _missingParamsDelayedDisplayTimer;                  ///< Timer use to delay missing fact display
     QList<QPair<int,QString>>   _missingParams;                                     ///< List of missing parameter component id:name
@@ -199,6 +225,7 @@ private:
     int                 _buildVersion           = 0;
     GPSRTKFactGroup*    _gpsRtkFactGroup        = nullptr;
     QGCToolbox*         _toolbox                = nullptr;
+    SettingsStore*      _settingsStore          = nullptr;
     QQuickItem*         _mainRootWindow         = nullptr;
     bool                _bluetoothAvailable     = false;
     QTranslator         _qgcTranslatorSourceCode;           ///< translations for source code C++/Qml
@@ -207,6 +234,10 @@ private:
     QLocale             _locale;
     bool                _error                  = false;
     QElapsedTimer       _msecsElapsedTime;
+    QMetaObject::Connection _firstFrameConnection;
+    bool                _deferredInitDone       = false;    ///< true: QGCTool::deferredInit calls were made
+    bool                _tracing                = false;
+    QString             _traceFile;                         ///< Empty for a new file in the log save path
 
     QList<QPair<QString /* title */, QString /* message */>> _delayedAppMessages;
 
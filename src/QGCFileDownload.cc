@@ -9,13 +9,14 @@
 
 
 #include "QGCFileDownload.h"
+#include "QGCApplication.h"
+#include "QGCNetworkService.h"
 
 #include <QFileInfo>
 #include <QStandardPaths>
-#include <QNetworkProxy>
 
 QGCFileDownload::QGCFileDownload(QObject* parent)
-    : QNetworkAccessManager(parent)
+    : QObject(parent)
 {
 
 }
@@ -44,12 +45,9 @@ bool QGCFileDownload::download(const QString& remoteFile, bool redirect)
     }
     
     QNetworkRequest networkRequest(remoteUrl);
+    QGCNetworkService::setConsumer(networkRequest, QGCNetworkService::consumerFileDownload);
 
-    QNetworkProxy tProxy;
-    tProxy.setType(QNetworkProxy::DefaultProxy);
-    setProxy(tProxy);
-    
-    QNetworkReply* networkReply = get(networkRequest);
+    QNetworkReply* networkReply = qgcApp()->toolbox()->networkService()->networkAccessManager()->get(networkRequest);
     if (!networkReply) {
         qWarning() << "QNetworkAccessManager::get failed";
         return false;
@@ -11,7 +11,8 @@
 
 #include <QNetworkReply>
 
-class QGCFileDownload : public QNetworkAccessManager
+/// Downloads a file through the access manager of the network service
+class QGCFileDownload : public QObject
 {
     Q_OBJECT
     
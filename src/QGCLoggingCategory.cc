@@ -13,6 +13,7 @@
 
 #include "QGCLoggingCategory.h"
 
+#include <QElapsedTimer>
 #include <QSettings>
 
 // Add Global logging categories (not class specific) here using QGC_LOGGING_CATEGORY
@@ -100,3 +101,27 @@ void QGCLoggingCategoryRegister::setFilterRulesFromSettings(const QString& comma
     qDebug() << "Filter rules" << filterRules;
     QLoggingCategory::setFilterRules(filterRules);
 }
+
+static qint64 _rateLimiterMsecs(void)
+{
+    static const QElapsedTimer timer = []() { QElapsedTimer started; started.start(); return started; }();
+    return timer.elapsed();
+}
+
+bool QGCLoggingRateLimiter::allow(const QLoggingCategory& category, int intervalMsecs)
+{
+    qint64 nowMsecs     = _rateLimiterMsecs();
+    qint64 lastMsecs    = _lastMsecs.load(std::memory_order_relaxed);
+
+    // Only one of several threads logging at the same time gets through
+    if ((lastMsecs >= 0 && nowMsecs - lastMsecs < intervalMsecs) || !_lastMsecs.compare_exchange_strong(lastMsecs, nowMsecs, std::memory_order_relaxed)) {
+        _suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    int suppressed = _suppressed.exchange(0, std::memory_order_relaxed);
+    if (suppressed) {
+        QMessageLogger(nullptr, 0, nullptr, category.categoryName()).debug() << suppressed << "messages suppressed by rate limit";
+    }
+    return true;
+}
@@ -12,6 +12,8 @@
 #include <QLoggingCategory>
 #include <QStringList>
 
+#include <atomic>
+
 // Add Global logging categories (not class specific) here using Q_DECLARE_LOGGING_CATEGORY
 Q_DECLARE_LOGGING_CATEGORY(FirmwareUpgradeLog)
 Q_DECLARE_LOGGING_CATEGORY(FirmwareUpgradeVerboseLog)
@@ -31,6 +33,17 @@ Q_DECLARE_LOGGING_CATEGORY(LocalizationLog)
     static QGCLoggingCategory qgcCategory ## name (__VA_ARGS__); \
     Q_LOGGING_CATEGORY(name, __VA_ARGS__)
 
+/// @def QGC_DEBUG_RATE_LIMITED
+/// Same as qCDebug but logs at most once every intervalMsecs per call site, for per message or per item paths
+/// which would flood the log. Like qCDebug nothing after it is evaluated while the category is off, and also not
+/// while the call site is suppressed. The next message that gets through reports how many were suppressed.
+///     QGC_DEBUG_RATE_LIMITED(ParameterManagerVerbose1Log, 1000) << "waiting:" << count;
+#define QGC_DEBUG_RATE_LIMITED(category, intervalMsecs) \
+    for (bool qgcLogEnabled = category().isDebugEnabled() && \
+            []() -> QGCLoggingRateLimiter& { static QGCLoggingRateLimiter limiter; return limiter; }().allow(category(), intervalMsecs); \
+            qgcLogEnabled; qgcLogEnabled = false) \
+        QMessageLogger(QT_MESSAGELOG_FILE, QT_MESSAGELOG_LINE, QT_MESSAGELOG_FUNC, category().categoryName()).debug()
+
 class QGCLoggingCategoryRegister : public QObject
 {
     Q_OBJECT
@@ -68,3 +81,15 @@ class QGCLoggingCategory
 public:
     QGCLoggingCategory(const char* category) { QGCLoggingCategoryRegister::instance()->registerCategory(category); }
 };
+
+/// State of a single QGC_DEBUG_RATE_LIMITED call site. Safe to use from any thread.
+class QGCLoggingRateLimiter
+{
+public:
+    /// @return true: the call site may log now
+    bool allow(const QLoggingCategory& category, int intervalMsecs);
+
+private:
+    std::atomic<qint64> _lastMsecs  { -1 };   ///< -1: never logged
+    std::atomic<int>    _suppressed { 0 };
+};
@@ -0,0 +1,216 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCMemoryAccounting.h"
+
+#include <QFile>
+#include <QMap>
+#include <QStringList>
+#include <QVariantMap>
+
+#include <algorithm>
+
+#if defined(Q_OS_LINUX) || defined(Q_OS_ANDROID)
+#include <unistd.h>
+#elif defined(Q_OS_MAC) || defined(Q_OS_IOS)
+#include <mach/mach.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+#if defined(QGC_JEMALLOC_STATS)
+#include <jemalloc/jemalloc.h>
+#elif defined(QGC_TCMALLOC_STATS)
+#include <gperftools/malloc_extension.h>
+#endif
+
+QGC_LOGGING_CATEGORY(MemoryAccountingLog, "MemoryAccountingLog")
+
+QGCMemoryAccounting* QGCMemoryAccounting::_instance = nullptr;
+
+QGCMemoryAccounting::QGCMemoryAccounting(QGCApplication* app, QGCToolbox* toolbox)
+    : QGCTool(app, toolbox)
+{
+    _instance = this;
+
+    connect(&_logTimer, &QTimer::timeout, this, &QGCMemoryAccounting::_logTimeout);
+    _logTimer.start(logIntervalMsecs);
+}
+
+QGCMemoryAccounting::~QGCMemoryAccounting()
+{
+    if (_instance == this) {
+        _instance = nullptr;
+    }
+}
+
+void QGCMemoryAccounting::addSource(const QString& subsystem, QObject* owner, UsageFunction_t usage)
+{
+    _sources.append(Source_t{ subsystem, owner, usage });
+    connect(owner, &QObject::destroyed, this, &QGCMemoryAccounting::_ownerDestroyed, Qt::UniqueConnection);
+}
+
+void QGCMemoryAccounting::_ownerDestroyed(void)
+{
+    // QPointer is already cleared by the time destroyed is signalled
+    for (int i=_sources.count()-1; i>=0; i--) {
+        if (_sources[i].owner.isNull()) {
+            _sources.removeAt(i);
+        }
+    }
+}
+
+void QGCMemoryAccounting::update(void)
+{
+    typedef struct {
+        qint64  count;
+        qint64  bytes;
+        int     sources;
+    } Total_t;
+
+    QMap<QString, Total_t> totals;
+    for (const Source_t& source: _sources) {
+        if (source.owner.isNull()) {
+            continue;
+        }
+        Usage_t     usage = source.usage();
+        Total_t&    total = totals[source.subsystem];
+        total.count     += usage.count;
+        total.bytes     += usage.bytes;
+        total.sources   += 1;
+    }
+
+    QList<QVariantMap> subsystems;
+    for (auto it = totals.constBegin(); it != totals.constEnd(); ++it) {
+        QVariantMap subsystem;
+        subsystem[QStringLiteral("name")]       = it.key();
+        subsystem[QStringLiteral("count")]      = it->count;
+        subsystem[QStringLiteral("bytes")]      = it->bytes;
+        subsystem[QStringLiteral("sources")]    = it->sources;
+        subsystems.append(subsystem);
+    }
+    std::stable_sort(subsystems.begin(), subsystems.end(), [](const QVariantMap& a, const QVariantMap& b) {
+        return a[QStringLiteral("bytes")].toLongLong() > b[QStringLiteral("bytes")].toLongLong();
+    });
+
+    _subsystems.clear();
+    for (const QVariantMap& subsystem: subsystems) {
+        _subsystems.append(subsystem);
+    }
+    _residentBytes  = processResidentBytes();
+    _heapBytes      = _allocatorHeapBytes();
+
+    emit updated();
+}
+
+void QGCMemoryAccounting::_logTimeout(void)
+{
+    if (MemoryAccountingLog().isDebugEnabled()) {
+        update();
+        qCDebug(MemoryAccountingLog) << qPrintable(summary());
+    }
+}
+
+QString QGCMemoryAccounting::summary(void) const
+{
+    QStringList parts;
+    parts.append(QStringLiteral("resident:%1").arg(_residentBytes < 0 ? QStringLiteral("?") : bytesToString(_residentBytes)));
+    if (_heapBytes >= 0) {
+        parts.append(QStringLiteral("%1:%2").arg(allocator()).arg(bytesToString(_heapBytes)));
+    }
+    for (const QVariant& value: _subsystems) {
+        QVariantMap subsystem = value.toMap();
+        parts.append(QStringLiteral("%1:%2/%3")
+                     .arg(subsystem[QStringLiteral("name")].toString())
+                     .arg(subsystem[QStringLiteral("count")].toLongLong())
+                     .arg(bytesToString(subsystem[QStringLiteral("bytes")].toLongLong())));
+    }
+    return parts.join(QStringLiteral(" "));
+}
+
+QString QGCMemoryAccounting::bytesToString(qint64 bytes) const
+{
+    if (bytes < 1024) {
+        return QStringLiteral("%1B").arg(bytes);
+    } else if (bytes < 1024 * 1024) {
+        return QStringLiteral("%1KB").arg(static_cast<double>(bytes) / 1024.0, 0, 'f', 1);
+    } else if (bytes < 1024 * 1024 * 1024) {
+        return QStringLiteral("%1MB").arg(static_cast<double>(bytes) / (1024.0 * 1024.0), 0, 'f', 1);
+    } else {
+        return QStringLiteral("%1GB").arg(static_cast<double>(bytes) / (1024.0 * 1024.0 * 1024.0), 0, 'f', 2);
+    }
+}
+
+QString QGCMemoryAccounting::allocator(void) const
+{
+#if defined(QGC_JEMALLOC_STATS)
+    return QStringLiteral("jemalloc");
+#elif defined(QGC_TCMALLOC_STATS)
+    return QStringLiteral("tcmalloc");
+#else
+    return QString();
+#endif
+}
+
+qint64 QGCMemoryAccounting::processResidentBytes(void)
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_ANDROID)
+    // Second field is the resident page count
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (!statm.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.count() < 2) {
+        return -1;
+    }
+    return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+#elif defined(Q_OS_MAC) || defined(Q_OS_IOS)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t      count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+        return -1;
+    }
+    return static_cast<qint64>(info.resident_size);
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return -1;
+    }
+    return static_cast<qint64>(counters.WorkingSetSize);
+#else
+    return -1;
+#endif
+}
+
+qint64 QGCMemoryAccounting::_allocatorHeapBytes(void)
+{
+#if defined(QGC_JEMALLOC_STATS)
+    // Statistics are only refreshed when the epoch is advanced
+    uint64_t    epoch   = 1;
+    size_t      size    = sizeof(epoch);
+    mallctl("epoch", &epoch, &size, &epoch, size);
+
+    size_t allocated = 0;
+    size = sizeof(allocated);
+    if (mallctl("stats.allocated", &allocated, &size, nullptr, 0) != 0) {
+        return -1;
+    }
+    return static_cast<qint64>(allocated);
+#elif defined(QGC_TCMALLOC_STATS)
+    size_t allocated = 0;
+    if (!MallocExtension::instance()->GetNumericProperty("generic.current_allocated_bytes", &allocated)) {
+        return -1;
+    }
+    return static_cast<qint64>(allocated);
+#else
+    return -1;
+#endif
+}
@@ -0,0 +1,101 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCLoggingCategory.h"
+#include "QGCToolbox.h"
+
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVariantList>
+
+#include <functional>
+
+Q_DECLARE_LOGGING_CATEGORY(MemoryAccountingLog)
+
+/// Item counts and estimated bytes of the containers which grow during a session, summed per subsystem, to find out
+/// what uses up the memory on long multi vehicle sessions. Shown on the Memory settings page, and logged every
+/// logIntervalMsecs while MemoryAccountingLog is on.
+///
+/// Bytes are estimates of the container storage, not measurements. The process resident size, and the allocator's
+/// own statistics when built with QGC_JEMALLOC_STATS or QGC_TCMALLOC_STATS, are the totals to compare them with.
+class QGCMemoryAccounting : public QGCTool
+{
+    Q_OBJECT
+
+public:
+    QGCMemoryAccounting(QGCApplication* app, QGCToolbox* toolbox);
+    ~QGCMemoryAccounting();
+
+    typedef struct {
+        qint64 count;   ///< Items, for example tiles or points
+        qint64 bytes;
+    } Usage_t;
+
+    /// Called on the GUI thread, it has to lock whatever other threads change
+    typedef std::function<Usage_t(void)> UsageFunction_t;
+
+    Q_PROPERTY(QVariantList subsystems      READ subsystems     NOTIFY updated)     ///< name, count, bytes and sources of each subsystem, largest first
+    Q_PROPERTY(qint64       residentBytes   READ residentBytes  NOTIFY updated)     ///< -1: not known on this platform
+    Q_PROPERTY(qint64       heapBytes       READ heapBytes      NOTIFY updated)     ///< Allocated according to the allocator, -1: no allocator statistics
+    Q_PROPERTY(QString      allocator       READ allocator      CONSTANT)
+
+    /// Samples all sources
+    Q_INVOKABLE void update(void);
+
+    /// @return bytes as KB, MB or GB
+    Q_INVOKABLE QString bytesToString(qint64 bytes) const;
+
+    /// Adds a source to the totals of subsystem until owner is destroyed. Several sources can add to the same
+    /// subsystem, one for each vehicle for example. Call on the GUI thread.
+    void addSource(const QString& subsystem, QObject* owner, UsageFunction_t usage);
+
+    QVariantList    subsystems      (void) const { return _subsystems; }
+    qint64          residentBytes   (void) const { return _residentBytes; }
+    qint64          heapBytes       (void) const { return _heapBytes; }
+    QString         allocator       (void) const;
+
+    /// @return Single line with the totals of the last update
+    QString summary(void) const;
+
+    /// @return Process resident set size, -1 if not known on this platform
+    static qint64 processResidentBytes(void);
+
+    static const int logIntervalMsecs = 60 * 1000;
+
+signals:
+    void updated(void);
+
+private slots:
+    void _logTimeout        (void);
+    void _ownerDestroyed    (void);
+
+private:
+    typedef struct {
+        QString             subsystem;
+        QPointer<QObject>   owner;
+        UsageFunction_t     usage;
+    } Source_t;
+
+    static qint64 _allocatorHeapBytes(void);
+
+    QList<Source_t> _sources;
+    QVariantList    _subsystems;
+    qint64          _residentBytes  = -1;
+    qint64          _heapBytes      = -1;
+    QTimer          _logTimer;
+
+    /// UASMessageHandler's model adds its source from the QGCToolbox constructor, before qgcApp()->toolbox() is set
+    static QGCMemoryAccounting* _instance;
+
+    friend class UASMessageModel;
+};
@@ -0,0 +1,863 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCNetworkService.h"
+#include "SettingsManager.h"
+
+#include <QHostAddress>
+#include <QNetworkDiskCache>
+#include <QNetworkInterface>
+#include <QNetworkProxy>
+#include <QStandardPaths>
+#include <QThread>
+
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(NetworkServiceLog, "NetworkServiceLog")
+
+QGCNetworkService* QGCNetworkService::_instance = nullptr;
+
+const char* QGCNetworkService::consumerMapTiles     = "MapTiles";
+const char* QGCNetworkService::consumerTerrain      = "Terrain";
+const char* QGCNetworkService::consumerGeocoding    = "Geocoding";
+const char* QGCNetworkService::consumerFileDownload = "FileDownload";
+const char* QGCNetworkService::consumerFirmware     = "Firmware";
+const char* QGCNetworkService::consumerLogUpload    = "LogUpload";
+const char* QGCNetworkService::consumerPairing      = "Pairing";
+const char* QGCNetworkService::consumerCamera       = "Camera";
+const char* QGCNetworkService::consumerOther        = "Other";
+
+// QNetworkRequest::User is taken by the tile set downloads
+static const QNetworkRequest::Attribute _consumerAttribute = static_cast<QNetworkRequest::Attribute>(QNetworkRequest::User + 1);
+
+QGCNetworkService::QGCNetworkService(QGCApplication* app, QGCToolbox* toolbox)
+    : QGCTool(app, toolbox)
+{
+    _instance = this;
+    _clock.start();
+    _cacheDirectory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/Network");
+
+    // Consumers without a cache of their own
+    _cacheBudgets[consumerFileDownload] = 20 * 1024 * 1024;
+    _cacheBudgets[consumerGeocoding]    = 5 * 1024 * 1024;
+    _cacheBudgets[consumerOther]        = 10 * 1024 * 1024;
+
+    connect(&_statisticsTimer, &QTimer::timeout, this, &QGCNetworkService::_logStatistics);
+    _statisticsTimer.start(statisticsIntervalMSecs);
+
+    connect(&_interfaceTimer, &QTimer::timeout, this, &QGCNetworkService::_checkInterfaces);
+    _interfaceTimer.start(interfaceCheckMSecs);
+    _checkInterfaces();
+}
+
+void QGCNetworkService::setToolbox(QGCToolbox* toolbox)
+{
+    QGCTool::setToolbox(toolbox);
+
+    Fact* checkInternet = toolbox->settingsManager()->appSettings()->checkInternet();
+    connect(checkInternet, &Fact::rawValueChanged, this, &QGCNetworkService::_checkInternetChanged);
+    _checkInternetChanged(checkInternet->rawValue());
+}
+
+QGCNetworkService::~QGCNetworkService()
+{
+    QList<QNetworkAccessManager*> accessManagers;
+    {
+        QMutexLocker locker(&_mutex);
+        accessManagers = _accessManagers.values();
+        _accessManagers.clear();
+    }
+
+    // Replies lock the mutex as they go away with their access manager
+    for (QNetworkAccessManager* accessManager: accessManagers) {
+        disconnect(accessManager, nullptr, this, nullptr);
+        if (accessManager->thread() == QThread::currentThread()) {
+            delete accessManager;
+        } else {
+            accessManager->deleteLater();
+        }
+    }
+    qDeleteAll(_diskCaches);
+    _diskCaches.clear();
+
+    if (_instance == this) {
+        _instance = nullptr;
+    }
+}
+
+QNetworkAccessManager* QGCNetworkService::networkAccessManager(void)
+{
+    QThread*        thread = QThread::currentThread();
+    QMutexLocker    locker(&_mutex);
+
+    QNetworkAccessManager* accessManager = _accessManagers.value(thread);
+    if (!accessManager) {
+        qCDebug(NetworkServiceLog) << "Access manager for thread" << thread;
+        accessManager = new QGCNetworkAccessManager();
+        accessManager->setCache(new QGCNetworkCache());
+        // The application proxy, which the subsystems used to set on their own access managers
+        accessManager->setProxy(QNetworkProxy(QNetworkProxy::DefaultProxy));
+        _accessManagers[thread] = accessManager;
+        if (thread != this->thread()) {
+            // Goes away with its thread, the thread has no event loop left to use it with
+            connect(thread, &QThread::finished, accessManager, &QObject::deleteLater, Qt::DirectConnection);
+        }
+        connect(accessManager, &QObject::destroyed, this, [this, thread]() {
+            QMutexLocker locker(&_mutex);
+            _accessManagers.remove(thread);
+        }, Qt::DirectConnection);
+    }
+    return accessManager;
+}
+
+void QGCNetworkService::setConsumer(QNetworkRequest& request, const QString& consumer)
+{
+    request.setAttribute(_consumerAttribute, consumer);
+}
+
+QString QGCNetworkService::consumer(const QNetworkRequest& request)
+{
+    const QString consumer = request.attribute(_consumerAttribute).toString();
+    return consumer.isEmpty() ? QString(consumerOther) : consumer;
+}
+
+void QGCNetworkService::setCacheBudget(const QString& consumer, qint64 bytes)
+{
+    QMutexLocker locker(&_mutex);
+
+    _cacheBudgets[consumer] = bytes;
+    // The disk cache stays for the devices it handed out, new requests don't get to it
+    QNetworkDiskCache* diskCache = _diskCaches.value(consumer);
+    if (diskCache) {
+        if (bytes > 0) {
+            diskCache->setMaximumCacheSize(bytes);
+        } else {
+            diskCache->clear();
+        }
+    }
+}
+
+qint64 QGCNetworkService::cacheBudget(const QString& consumer) const
+{
+    QMutexLocker locker(&_mutex);
+    return _cacheBudgets.value(consumer);
+}
+
+void QGCNetworkService::setMaxActiveRequests(int maxActiveRequests)
+{
+    QMutexLocker locker(&_mutex);
+    _maxActiveRequests = qMax(maxActiveRequests, 1);
+    _startWaiting();
+}
+
+int QGCNetworkService::maxActiveRequests(void) const
+{
+    QMutexLocker locker(&_mutex);
+    return _maxActiveRequests;
+}
+
+void QGCNetworkService::setMaxDownloadRate(qint64 bytesPerSecond)
+{
+    QMutexLocker locker(&_mutex);
+    _downloadThrottle.setBytesPerSecond(bytesPerSecond);
+}
+
+qint64 QGCNetworkService::maxDownloadRate(void) const
+{
+    QMutexLocker locker(&_mutex);
+    return _downloadThrottle.bytesPerSecond();
+}
+
+QList<QGCNetworkService::Statistics_t> QGCNetworkService::statistics(void)
+{
+    QMutexLocker locker(&_mutex);
+
+    QList<Statistics_t> statistics;
+    for (auto it = _counters.constBegin(); it != _counters.constEnd(); it++) {
+        const Counters_t&   counters    = it.value();
+        QNetworkDiskCache*  diskCache   = _diskCaches.value(it.key());
+        statistics.append({ it.key(), counters.requests, counters.active, counters.waiting, counters.failures, counters.skipped, counters.cacheHits,
+                            counters.bytesReceived, counters.bytesSent, diskCache ? diskCache->cacheSize() : 0 });
+    }
+    return statistics;
+}
+
+void QGCNetworkService::_logStatistics(void)
+{
+    if (!NetworkServiceLog().isDebugEnabled()) {
+        return;
+    }
+    for (const Statistics_t& statistics: this->statistics()) {
+        qCDebug(NetworkServiceLog) << statistics.consumer
+                                   << "requests:"   << statistics.requests
+                                   << "active:"     << statistics.active
+                                   << "waiting:"    << statistics.waiting
+                                   << "failures:"   << statistics.failures
+                                   << "skipped:"    << statistics.skipped
+                                   << "cache hits:" << statistics.cacheHits
+                                   << "received:"   << statistics.bytesReceived
+                                   << "sent:"       << statistics.bytesSent
+                                   << "cached:"     << statistics.cacheBytes;
+    }
+}
+
+bool QGCNetworkService::_acquire(QGCNetworkReply* reply)
+{
+    QMutexLocker locker(&_mutex);
+
+    Counters_t& counters = _counters[reply->_consumer];
+    counters.requests++;
+    // Requests which come later don't overtake the waiting ones
+    if (_active < _maxActiveRequests && _waiting.isEmpty()) {
+        _active++;
+        counters.active++;
+        reply->_slotHeld = true;
+        return true;
+    }
+    _waiting.append(reply);
+    counters.waiting++;
+    return false;
+}
+
+void QGCNetworkService::_release(QGCNetworkReply* reply)
+{
+    QMutexLocker locker(&_mutex);
+
+    Counters_t& counters = _counters[reply->_consumer];
+    if (reply->_slotHeld) {
+        reply->_slotHeld = false;
+        _active--;
+        counters.active--;
+        _startWaiting();
+    } else if (_waiting.removeOne(reply)) {
+        counters.waiting--;
+    }
+}
+
+/// Hands the free slots to the waiting replies, the caller holds _mutex
+void QGCNetworkService::_startWaiting(void)
+{
+    while (_active < _maxActiveRequests && !_waiting.isEmpty()) {
+        QGCNetworkReply*    reply       = _waiting.takeFirst();
+        Counters_t&         counters    = _counters[reply->_consumer];
+        counters.waiting--;
+        counters.active++;
+        _active++;
+        reply->_slotHeld = true;
+        // The reply may be in another thread, if it goes away first the call is dropped and its destructor frees the slot
+        QMetaObject::invokeMethod(reply, [reply]() { reply->_start(); }, Qt::QueuedConnection);
+    }
+}
+
+qint64 QGCNetworkService::_takeBytes(qint64 wanted)
+{
+    QMutexLocker locker(&_mutex);
+    return _downloadThrottle.take(_clock.elapsed(), wanted);
+}
+
+int QGCNetworkService::_msecsUntilBytes(qint64 bytes)
+{
+    QMutexLocker locker(&_mutex);
+    return _downloadThrottle.msecsUntilAvailable(_clock.elapsed(), bytes);
+}
+
+void QGCNetworkService::_count(const QString& consumer, int failures, int skipped, int cacheHits, qint64 bytesReceived, qint64 bytesSent)
+{
+    QMutexLocker locker(&_mutex);
+
+    Counters_t& counters = _counters[consumer];
+    counters.failures       += failures;
+    counters.skipped        += skipped;
+    counters.cacheHits      += cacheHits;
+    counters.bytesReceived  += bytesReceived;
+    counters.bytesSent      += bytesSent;
+}
+
+bool QGCNetworkService::internetAvailable(void) const
+{
+    QMutexLocker locker(&_mutex);
+    return !_checkInternet || (_internetUp && _interfaceUp);
+}
+
+bool QGCNetworkService::requestAllowed(const QUrl& url) const
+{
+    if (isLocalUrl(url)) {
+        return true;
+    }
+    QMutexLocker locker(&_mutex);
+    return !_checkInternet || (_internetUp && _interfaceUp) || _recheckDue();
+}
+
+bool QGCNetworkService::isLocalUrl(const QUrl& url)
+{
+    const QString host = url.host().toLower();
+    if (host.isEmpty() || host == QStringLiteral("localhost") || host.endsWith(QStringLiteral(".local"))) {
+        return true;
+    }
+
+    const QHostAddress address(host);
+    if (address.isNull()) {
+        return false;
+    }
+    return address.isLoopback() || address.isLinkLocal() || address.isUniqueLocalUnicast() ||
+            address.isInSubnet(QHostAddress(QStringLiteral("10.0.0.0")), 8) ||
+            address.isInSubnet(QHostAddress(QStringLiteral("172.16.0.0")), 12) ||
+            address.isInSubnet(QHostAddress(QStringLiteral("192.168.0.0")), 16);
+}
+
+bool QGCNetworkService::isConnectivityError(QNetworkReply::NetworkError error)
+{
+    switch (error) {
+    case QNetworkReply::HostNotFoundError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::UnknownNetworkError:
+    case QNetworkReply::ProxyConnectionRefusedError:
+    case QNetworkReply::ProxyConnectionClosedError:
+    case QNetworkReply::ProxyNotFoundError:
+    case QNetworkReply::ProxyTimeoutError:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void QGCNetworkService::_checkInternetChanged(QVariant value)
+{
+    {
+        QMutexLocker locker(&_mutex);
+        _checkInternet = value.toBool();
+    }
+    _announceInternet();
+}
+
+/// Asks the OS whether there is a network which could lead to the internet at all
+void QGCNetworkService::_checkInterfaces(void)
+{
+    const QList<QNetworkInterface> interfaces = QNetworkInterface::allInterfaces();
+
+    // Some platforms don't hand out the interfaces, that only leaves the requests to go by
+    bool interfaceUp = interfaces.isEmpty();
+    for (const QNetworkInterface& networkInterface: interfaces) {
+        const QNetworkInterface::InterfaceFlags flags = networkInterface.flags();
+        if (!(flags & QNetworkInterface::IsUp) || !(flags & QNetworkInterface::IsRunning) || (flags & QNetworkInterface::IsLoopBack)) {
+            continue;
+        }
+        for (const QNetworkAddressEntry& entry: networkInterface.addressEntries()) {
+            if (!entry.ip().isLoopback() && !entry.ip().isLinkLocal()) {
+                interfaceUp = true;
+                break;
+            }
+        }
+        if (interfaceUp) {
+            break;
+        }
+    }
+
+    QMutexLocker locker(&_mutex);
+    if (interfaceUp != _interfaceUp) {
+        qCDebug(NetworkServiceLog) << "Network interface" << (interfaceUp ? "up" : "down");
+        _interfaceUp = interfaceUp;
+        if (interfaceUp) {
+            // A new network, whatever the requests found out before is stale
+            _setInternetUp(true);
+        }
+        locker.unlock();
+        _announceInternet();
+    }
+}
+
+bool QGCNetworkService::_admit(const QUrl& url)
+{
+    if (isLocalUrl(url)) {
+        return true;
+    }
+
+    QMutexLocker locker(&_mutex);
+    if (!_checkInternet || (_internetUp && _interfaceUp)) {
+        return true;
+    }
+    if (_recheckDue()) {
+        _nextRecheck = _clock.elapsed() + _recheckMSecs;
+        qCDebug(NetworkServiceLog) << "Rechecking internet with" << url;
+        return true;
+    }
+    return false;
+}
+
+/// Called with the outcome of each request to the internet
+void QGCNetworkService::_reportReachable(bool reached)
+{
+    QMutexLocker locker(&_mutex);
+
+    const bool wasAvailable = _internetUp;
+    if (reached) {
+        _failuresInRow = 0;
+        _setInternetUp(true);
+    } else if (!_internetUp) {
+        // A recheck which failed
+        _recheckMSecs = qMin(_recheckMSecs * 2, maxRecheckMSecs);
+        _nextRecheck  = _clock.elapsed() + _recheckMSecs;
+    } else if (++_failuresInRow >= connectivityFailures) {
+        _setInternetUp(false);
+    }
+    if (wasAvailable != _internetUp) {
+        locker.unlock();
+        QMetaObject::invokeMethod(this, [this]() { _announceInternet(); }, Qt::QueuedConnection);
+    }
+}
+
+bool QGCNetworkService::_recheckDue(void) const
+{
+    return _interfaceUp && _clock.elapsed() >= _nextRecheck;
+}
+
+void QGCNetworkService::_setInternetUp(bool internetUp)
+{
+    if (internetUp == _internetUp) {
+        return;
+    }
+    qCDebug(NetworkServiceLog) << "Internet" << (internetUp ? "up" : "down");
+    _internetUp     = internetUp;
+    _failuresInRow  = 0;
+    _recheckMSecs   = recheckMSecs;
+    _nextRecheck    = _clock.elapsed() + _recheckMSecs;
+}
+
+/// Signals a change of internetAvailable, on the service thread
+void QGCNetworkService::_announceInternet(void)
+{
+    const bool available = internetAvailable();
+    if (available != _announcedInternet) {
+        _announcedInternet = available;
+        emit internetAvailableChanged(available);
+    }
+}
+
+void QGCNetworkService::_addRoute(const QUrl& url, const QString& consumer)
+{
+    QMutexLocker locker(&_mutex);
+
+    Route_t& route = _routes[url];
+    if (route.count == 0) {
+        route.consumer = consumer;
+    }
+    route.count++;
+}
+
+void QGCNetworkService::_removeRoute(const QUrl& url)
+{
+    QMutexLocker locker(&_mutex);
+
+    auto it = _routes.find(url);
+    if (it != _routes.end() && --it.value().count <= 0) {
+        _routes.erase(it);
+    }
+}
+
+QNetworkDiskCache* QGCNetworkService::_diskCache(const QUrl& url)
+{
+    // Urls nobody asked for here, such as redirect targets, go uncached
+    const Route_t route = _routes.value(url);
+    return route.count > 0 ? _diskCacheForConsumer(route.consumer) : nullptr;
+}
+
+QNetworkDiskCache* QGCNetworkService::_diskCacheForConsumer(const QString& consumer)
+{
+    const qint64 budget = _cacheBudgets.value(consumer);
+    if (budget <= 0) {
+        return nullptr;
+    }
+
+    QNetworkDiskCache* diskCache = _diskCaches.value(consumer);
+    if (!diskCache) {
+        diskCache = new QNetworkDiskCache();
+        diskCache->setCacheDirectory(_cacheDirectory + QStringLiteral("/") + consumer);
+        diskCache->setMaximumCacheSize(budget);
+        // Used from all threads under the mutex, deleted with the service
+        diskCache->moveToThread(thread());
+        _diskCaches[consumer] = diskCache;
+    }
+    return diskCache;
+}
+
+QGCNetworkAccessManager::QGCNetworkAccessManager(QObject* parent)
+    : QNetworkAccessManager(parent)
+{
+
+}
+
+QNetworkReply* QGCNetworkAccessManager::createRequest(Operation op, const QNetworkRequest& originalRequest, QIODevice* outgoingData)
+{
+    QNetworkRequest request(originalRequest);
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+
+    // Local files and resources don't count against the limits
+    QGCNetworkService*  service = QGCNetworkService::_instance;
+    const QString       scheme  = request.url().scheme().toLower();
+    if (!service || (scheme != QStringLiteral("http") && scheme != QStringLiteral("https"))) {
+        return QNetworkAccessManager::createRequest(op, request, outgoingData);
+    }
+    return new QGCNetworkReply(this, op, request, outgoingData, service->_admit(request.url()));
+}
+
+QNetworkReply* QGCNetworkAccessManager::_createRequest(Operation op, const QNetworkRequest& request, QIODevice* outgoingData)
+{
+    return QNetworkAccessManager::createRequest(op, request, outgoingData);
+}
+
+QGCNetworkReply::QGCNetworkReply(QGCNetworkAccessManager* manager, Operation op, const QNetworkRequest& request, QIODevice* outgoingData, bool admitted)
+    : QNetworkReply(manager)
+    , _manager(manager)
+    , _outgoingData(outgoingData)
+    , _consumer(QGCNetworkService::consumer(request))
+{
+    setOperation(op);
+    setRequest(request);
+    setUrl(request.url());
+    open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+
+    _pullTimer.setSingleShot(true);
+    connect(&_pullTimer, &QTimer::timeout, this, &QGCNetworkReply::_pull);
+
+    if (!admitted) {
+        // The user connects to the reply first
+        _skipped = true;
+        QMetaObject::invokeMethod(this, [this]() {
+            if (!isFinished()) {
+                _finish(NetworkSessionFailedError, tr("Internet not available"));
+            }
+        }, Qt::QueuedConnection);
+        return;
+    }
+    if (QGCNetworkService::_instance->_acquire(this)) {
+        _start();
+    } else {
+        qCDebug(NetworkServiceLog) << "Request waiting" << _consumer << url();
+    }
+}
+
+QGCNetworkReply::~QGCNetworkReply()
+{
+    if (_reply) {
+        disconnect(_reply, nullptr, this, nullptr);
+    }
+
+    QGCNetworkService* service = QGCNetworkService::_instance;
+    if (service && !isFinished()) {
+        if (_routed) {
+            service->_removeRoute(_routedUrl);
+        }
+        service->_release(this);
+    }
+}
+
+void QGCNetworkReply::_start(void)
+{
+    // Aborted while the slot was on its way
+    if (isFinished()) {
+        return;
+    }
+    if (!_manager) {
+        _finish(OperationCanceledError, tr("Network access manager is gone"));
+        return;
+    }
+
+    QGCNetworkService* service = QGCNetworkService::_instance;
+    if (service) {
+        _routedUrl  = url();
+        _routed     = true;
+        service->_addRoute(_routedUrl, _consumer);
+    }
+
+    _reply = _manager->_createRequest(operation(), request(), _outgoingData.data());
+    _reply->setParent(this);
+    _reply->setReadBufferSize(QGCNetworkService::readBufferBytes);
+    if (_ignoreAllSslErrors) {
+        _reply->ignoreSslErrors();
+    } else if (!_ignoredSslErrors.isEmpty()) {
+        _reply->ignoreSslErrors(_ignoredSslErrors);
+    }
+
+    connect(_reply, &QNetworkReply::metaDataChanged,   this, &QGCNetworkReply::_replyMetaData);
+    connect(_reply, &QNetworkReply::readyRead,         this, &QGCNetworkReply::_pull);
+    connect(_reply, &QNetworkReply::finished,          this, &QGCNetworkReply::_replyFinished);
+    connect(_reply, &QNetworkReply::uploadProgress,    this, &QGCNetworkReply::_replyUpload);
+    connect(_reply, &QNetworkReply::redirected,        this, &QNetworkReply::redirected);
+    connect(_reply, &QNetworkReply::encrypted,         this, &QNetworkReply::encrypted);
+    connect(_reply, &QNetworkReply::sslErrors,         this, &QNetworkReply::sslErrors);
+}
+
+void QGCNetworkReply::abort(void)
+{
+    if (isFinished()) {
+        return;
+    }
+    if (_reply) {
+        disconnect(_reply, nullptr, this, nullptr);
+        _reply->abort();
+    }
+    _buffer.clear();
+    _finish(OperationCanceledError, tr("Operation canceled"));
+}
+
+void QGCNetworkReply::ignoreSslErrors(void)
+{
+    _ignoreAllSslErrors = true;
+    if (_reply) {
+        _reply->ignoreSslErrors();
+    }
+}
+
+void QGCNetworkReply::ignoreSslErrorsImplementation(const QList<QSslError>& errors)
+{
+    _ignoredSslErrors = errors;
+    if (_reply) {
+        _reply->ignoreSslErrors(errors);
+    }
+}
+
+qint64 QGCNetworkReply::bytesAvailable(void) const
+{
+    return _buffer.size() + QNetworkReply::bytesAvailable();
+}
+
+qint64 QGCNetworkReply::readData(char* data, qint64 maxSize)
+{
+    if (_buffer.isEmpty()) {
+        return isFinished() ? -1 : 0;
+    }
+    const int count = static_cast<int>(qMin(maxSize, static_cast<qint64>(_buffer.size())));
+    memcpy(data, _buffer.constData(), static_cast<size_t>(count));
+    _buffer.remove(0, count);
+    return count;
+}
+
+/// Moves the data of the real reply over as fast as the download rate limit allows
+void QGCNetworkReply::_pull(void)
+{
+    if (!_reply || isFinished() || _pullTimer.isActive()) {
+        return;
+    }
+
+    QGCNetworkService*  service     = QGCNetworkService::_instance;
+    const qint64        available   = _reply->bytesAvailable();
+    if (available > 0) {
+        const qint64 allowed = service ? service->_takeBytes(available) : available;
+        if (allowed > 0) {
+            const QByteArray data = _reply->read(allowed);
+            _buffer.append(data);
+            _bytesReceived += data.size();
+            emit readyRead();
+            if (isFinished()) {
+                // Aborted by the user
+                return;
+            }
+            emit downloadProgress(_bytesReceived, _bytesTotal);
+        }
+        const qint64 left = _reply->bytesAvailable();
+        if (left > 0) {
+            _pullTimer.start(service ? qMax(service->_msecsUntilBytes(left), 1) : 0);
+            return;
+        }
+    }
+
+    if (_replyDone) {
+        _finish(_reply->error(), _reply->errorString());
+    }
+}
+
+void QGCNetworkReply::_replyMetaData(void)
+{
+    _copyMetaData();
+    emit metaDataChanged();
+}
+
+void QGCNetworkReply::_replyFinished(void)
+{
+    _replyDone = true;
+    _copyMetaData();
+    _pull();
+}
+
+void QGCNetworkReply::_replyUpload(qint64 bytesSent, qint64 bytesTotal)
+{
+    _bytesSent = bytesSent;
+    emit uploadProgress(bytesSent, bytesTotal);
+}
+
+void QGCNetworkReply::_copyMetaData(void)
+{
+    static const QNetworkRequest::Attribute attributes[] = {
+        QNetworkRequest::HttpStatusCodeAttribute,
+        QNetworkRequest::HttpReasonPhraseAttribute,
+        QNetworkRequest::RedirectionTargetAttribute,
+        QNetworkRequest::ConnectionEncryptedAttribute,
+        QNetworkRequest::SourceIsFromCacheAttribute,
+        QNetworkRequest::HttpPipeliningWasUsedAttribute,
+        QNetworkRequest::Http2WasUsedAttribute,
+    };
+
+    for (const RawHeaderPair& header: _reply->rawHeaderPairs()) {
+        setRawHeader(header.first, header.second);
+    }
+    for (const QNetworkRequest::Attribute attribute: attributes) {
+        const QVariant value = _reply->attribute(attribute);
+        if (value.isValid()) {
+            setAttribute(attribute, value);
+        }
+    }
+    setUrl(_reply->url());
+
+    const QVariant contentLength = _reply->header(QNetworkRequest::ContentLengthHeader);
+    _bytesTotal = contentLength.isValid() ? contentLength.toLongLong() : -1;
+}
+
+void QGCNetworkReply::_finish(NetworkError code, const QString& errorString)
+{
+    _pullTimer.stop();
+
+    QGCNetworkService* service = QGCNetworkService::_instance;
+    if (service) {
+        if (_routed) {
+            // The real reply is done with the cache by now
+            service->_removeRoute(_routedUrl);
+            _routed = false;
+        }
+        const bool fromCache = attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
+        service->_count(_consumer, code != NoError && !_skipped ? 1 : 0, _skipped ? 1 : 0, fromCache ? 1 : 0, _bytesReceived, _bytesSent);
+        service->_release(this);
+        // Canceled requests, often by a timeout of the user, say nothing either way
+        if (!_skipped && !fromCache && code != OperationCanceledError && !QGCNetworkService::isLocalUrl(request().url())) {
+            service->_reportReachable(!QGCNetworkService::isConnectivityError(code));
+        }
+    }
+
+    if (code != NoError) {
+        setError(code, errorString);
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+        emit this->error(code);
+#else
+        emit errorOccurred(code);
+#if QT_DEPRECATED_SINCE(5, 15)
+        // Still connected to by name
+        QT_WARNING_PUSH
+        QT_WARNING_DISABLE_DEPRECATED
+        emit this->error(code);
+        QT_WARNING_POP
+#endif
+#endif
+    }
+    setFinished(true);
+    emit finished();
+}
+
+QGCNetworkCache::QGCNetworkCache(QObject* parent)
+    : QAbstractNetworkCache(parent)
+{
+
+}
+
+QNetworkCacheMetaData QGCNetworkCache::metaData(const QUrl& url)
+{
+    QGCNetworkService* service = QGCNetworkService::_instance;
+    if (!service) {
+        return QNetworkCacheMetaData();
+    }
+    QMutexLocker        locker(&service->_mutex);
+    QNetworkDiskCache*  diskCache = service->_diskCache(url);
+    return diskCache ? diskCache->metaData(url) : QNetworkCacheMetaData();
+}
+
+void QGCNetworkCache::updateMetaData(const QNetworkCacheMetaData& metaData)
+{
+    QGCNetworkService* service = QGCNetworkService::_instance;
+    if (!service) {
+        return;
+    }
+    QMutexLocker        locker(&service->_mutex);
+    QNetworkDiskCache*  diskCache = service->_diskCache(metaData.url());
+    if (diskCache) {
+        diskCache->updateMetaData(metaData);
+    }
+}
+
+QIODevice* QGCNetworkCache::data(const QUrl& url)
+{
+    QGCNetworkService* service = QGCNetworkService::_instance;
+    if (!service) {
+        return nullptr;
+    }
+    QMutexLocker        locker(&service->_mutex);
+    QNetworkDiskCache*  diskCache = service->_diskCache(url);
+    return diskCache ? diskCache->data(url) : nullptr;
+}
+
+bool QGCNetworkCache::remove(const QUrl& url)
+{
+    QGCNetworkService* service = QGCNetworkService::_instance;
+    if (!service) {
+        return false;
+    }
+    QMutexLocker        locker(&service->_mutex);
+    QNetworkDiskCache*  diskCache = service->_diskCache(url);
+    return diskCache ? diskCache->remove(url) : false;
+}
+
+qint64 QGCNetworkCache::cacheSize(void) const
+{
+    QGCNetworkService* service = QGCNetworkService::_instance;
+    if (!service) {
+        return 0;
+    }
+    QMutexLocker    locker(&service->_mutex);
+    qint64          size = 0;
+    for (QNetworkDiskCache* diskCache: service->_diskCaches) {
+        size += diskCache->cacheSize();
+    }
+    return size;
+}
+
+QIODevice* QGCNetworkCache::prepare(const QNetworkCacheMetaData& metaData)
+{
+    QGCNetworkService* service = QGCNetworkService::_instance;
+    if (!service) {
+        return nullptr;
+    }
+    QMutexLocker        locker(&service->_mutex);
+    QNetworkDiskCache*  diskCache   = service->_diskCache(metaData.url());
+    QIODevice*          device      = diskCache ? diskCache->prepare(metaData) : nullptr;
+    if (device) {
+        _preparing[device] = diskCache;
+    }
+    return device;
+}
+
+void QGCNetworkCache::insert(QIODevice* device)
+{
+    QGCNetworkService*  service     = QGCNetworkService::_instance;
+    QNetworkDiskCache*  diskCache   = _preparing.take(device);
+    if (service && diskCache) {
+        QMutexLocker locker(&service->_mutex);
+        diskCache->insert(device);
+    }
+}
+
+void QGCNetworkCache::clear(void)
+{
+    QGCNetworkService* service = QGCNetworkService::_instance;
+    if (!service) {
+        return;
+    }
+    QMutexLocker locker(&service->_mutex);
+    for (QNetworkDiskCache* diskCache: service->_diskCaches) {
+        diskCache->clear();
+    }
+}
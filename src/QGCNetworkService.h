@@ -0,0 +1,300 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCToolbox.h"
+#include "QGCLoggingCategory.h"
+#include "MAVLinkLogUploader.h"
+
+#include <QAbstractNetworkCache>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QPointer>
+#include <QSslError>
+#include <QTimer>
+
+Q_DECLARE_LOGGING_CATEGORY(NetworkServiceLog)
+
+class QNetworkDiskCache;
+class QGCNetworkReply;
+
+/// Network access for all subsystems.
+///
+/// Each thread has one access manager, created on first use and shared by all subsystems in the thread, so they share
+/// connection pools and TLS sessions. A QNetworkAccessManager may only be used from its own thread, which is why there
+/// isn't just one. Requests are tagged with the consumer which made them, see setConsumer. HTTP/2 is allowed for all
+/// of them.
+///
+/// Responses are cached on disk, in a QNetworkDiskCache for each consumer which has a cache budget. Map tiles, terrain
+/// and firmware have caches of their own and no budget here.
+///
+/// http(s) requests of all threads share one limit of requests in flight and one limit of the download rate, the same
+/// token bucket as the log uploads. The access managers hand out a QGCNetworkReply in place of the real reply, which
+/// waits for its turn and then reads through the bucket.
+///
+/// Requests, traffic and cache hits are counted for each consumer, see statistics.
+///
+/// Whether the internet can be reached is decided without probe traffic. The network interfaces of the OS are checked
+/// every interfaceCheckMSecs, and the outcome of every request to a host outside the local network counts: an answer
+/// from a server is proof, connectivityFailures connection level errors in a row take the internet down. While it is
+/// down requests to the internet fail right away, except for one every recheckMSecs, doubling up to maxRecheckMSecs,
+/// which finds out whether it is back. Requests on the local network, such as to a camera or a pairing link, are never
+/// held back.
+class QGCNetworkService : public QGCTool
+{
+    Q_OBJECT
+
+public:
+    QGCNetworkService(QGCApplication* app, QGCToolbox* toolbox);
+    ~QGCNetworkService();
+
+    // Overrides from QGCTool
+    void setToolbox(QGCToolbox* toolbox) override;
+
+    /// @return Access manager of the calling thread, owned by the service
+    QNetworkAccessManager* networkAccessManager(void);
+
+    /// Tags the request with the consumer for statistics and the cache budget, untagged requests count as consumerOther
+    static void     setConsumer (QNetworkRequest& request, const QString& consumer);
+    static QString  consumer    (const QNetworkRequest& request);
+
+    /// @param bytes 0: Responses for the consumer aren't cached
+    void    setCacheBudget          (const QString& consumer, qint64 bytes);
+    qint64  cacheBudget             (const QString& consumer) const;
+
+    void    setMaxActiveRequests    (int maxActiveRequests);
+    int     maxActiveRequests       (void) const;
+
+    /// @param bytesPerSecond 0 for no limit
+    void    setMaxDownloadRate      (qint64 bytesPerSecond);
+    qint64  maxDownloadRate         (void) const;
+
+    typedef struct {
+        QString consumer;
+        int     requests;
+        int     active;             ///< Requests in flight now
+        int     waiting;            ///< Requests waiting for a slot now
+        int     failures;
+        int     skipped;            ///< Failed right away since the internet was down
+        int     cacheHits;
+        qint64  bytesReceived;
+        qint64  bytesSent;
+        qint64  cacheBytes;
+    } Statistics_t;
+
+    /// @return One entry for each consumer which made a request
+    QList<Statistics_t> statistics(void);
+
+    /// @return false: Requests to the internet fail, or the OS has no network. Always true if checkInternet is off.
+    bool internetAvailable(void) const;
+
+    /// @return false: A request for the url would fail right away, the consumer may as well skip it
+    bool requestAllowed(const QUrl& url) const;
+
+    /// @return true: The url is on this machine or the local network, it doesn't depend on the internet
+    static bool isLocalUrl(const QUrl& url);
+
+    /// @return true: The error says the host couldn't be reached at all, as opposed to an answer from it
+    static bool isConnectivityError(QNetworkReply::NetworkError error);
+
+    static const char* consumerMapTiles;
+    static const char* consumerTerrain;
+    static const char* consumerGeocoding;
+    static const char* consumerFileDownload;
+    static const char* consumerFirmware;
+    static const char* consumerLogUpload;
+    static const char* consumerPairing;
+    static const char* consumerCamera;
+    static const char* consumerOther;
+
+    static const int    defaultMaxActiveRequests    = 32;
+    static const qint64 readBufferBytes             = 256 * 1024;   ///< Held by an access manager for each reply
+    static const int    statisticsIntervalMSecs     = 10000;        ///< NetworkServiceLog logs the statistics this often
+    static const int    connectivityFailures        = 3;
+    static const int    interfaceCheckMSecs         = 5000;
+    static const int    recheckMSecs                = 5000;
+    static const int    maxRecheckMSecs             = 60000;
+
+signals:
+    void internetAvailableChanged(bool internetAvailable);
+
+private slots:
+    void _logStatistics         (void);
+    void _checkInterfaces       (void);
+    void _checkInternetChanged  (QVariant value);
+
+private:
+    typedef struct {
+        int     requests        = 0;
+        int     active          = 0;
+        int     waiting         = 0;
+        int     failures        = 0;
+        int     skipped         = 0;
+        int     cacheHits       = 0;
+        qint64  bytesReceived   = 0;
+        qint64  bytesSent       = 0;
+    } Counters_t;
+
+    // Used by the replies and caches of all threads, all of them lock _mutex
+
+    /// @return true: The reply may start now, false: it was queued and is started from its thread once a slot is free
+    bool    _acquire            (QGCNetworkReply* reply);
+    /// Frees the slot or the place in the queue of the reply, does nothing if it holds neither
+    void    _release            (QGCNetworkReply* reply);
+    qint64  _takeBytes          (qint64 wanted);
+    int     _msecsUntilBytes    (qint64 bytes);
+    void    _count              (const QString& consumer, int failures, int skipped, int cacheHits, qint64 bytesReceived, qint64 bytesSent);
+    /// @return false: The request fails right away. Takes the recheck turn if it is due.
+    bool    _admit              (const QUrl& url);
+    void    _reportReachable    (bool reached);
+    void    _addRoute           (const QUrl& url, const QString& consumer);
+    void    _removeRoute        (const QUrl& url);
+    void    _startWaiting       (void);
+
+    /// The caller holds _mutex
+    bool    _recheckDue         (void) const;
+    void    _setInternetUp      (bool internetUp);
+    void    _announceInternet   (void);
+
+    /// @return Disk cache for the url, nullptr if its consumer has no budget. The caller holds _mutex.
+    QNetworkDiskCache* _diskCache(const QUrl& url);
+    QNetworkDiskCache* _diskCacheForConsumer(const QString& consumer);
+
+    typedef struct {
+        QString consumer;
+        int     count;          ///< Requests of the url in flight
+    } Route_t;
+
+    mutable QMutex                              _mutex;
+    QHash<QThread*, QNetworkAccessManager*>     _accessManagers;
+    QHash<QString, Counters_t>                  _counters;
+    QHash<QString, qint64>                      _cacheBudgets;
+    QHash<QString, QNetworkDiskCache*>          _diskCaches;
+    QHash<QUrl, Route_t>                        _routes;            ///< Consumer of each url for the caches
+    QList<QGCNetworkReply*>                     _waiting;
+    int                                         _active             = 0;
+    int                                         _maxActiveRequests  = defaultMaxActiveRequests;
+    MAVLinkLogUploadThrottle                    _downloadThrottle;
+    QElapsedTimer                               _clock;
+    QString                                     _cacheDirectory;
+    QTimer                                      _statisticsTimer;
+    bool                                        _checkInternet      = true;
+    bool                                        _internetUp         = true;     ///< From the outcome of the requests
+    bool                                        _interfaceUp        = true;     ///< From the OS, true if it can't tell
+    int                                         _failuresInRow      = 0;
+    int                                         _recheckMSecs       = recheckMSecs;
+    qint64                                      _nextRecheck        = 0;        ///< _clock msecs
+    QTimer                                      _interfaceTimer;
+    bool                                        _announcedInternet  = true;     ///< Main thread only
+
+    /// The access managers, replies and caches run on the threads of their users and may outlive the toolbox. They
+    /// find the service here instead of through qgcApp()->toolbox(), nullptr once it is gone.
+    static QGCNetworkService*                   _instance;
+
+    friend class QGCNetworkAccessManager;
+    friend class QGCNetworkReply;
+    friend class QGCNetworkCache;
+    friend class QGCNetworkServiceTest;     // Unit test
+};
+
+/// Access manager of one thread, see QGCNetworkService
+class QGCNetworkAccessManager : public QNetworkAccessManager
+{
+    Q_OBJECT
+
+public:
+    QGCNetworkAccessManager(QObject* parent = nullptr);
+
+protected:
+    QNetworkReply* createRequest(Operation op, const QNetworkRequest& request, QIODevice* outgoingData) override;
+
+private:
+    /// Creates the real reply for a QGCNetworkReply once it has a slot
+    QNetworkReply* _createRequest(Operation op, const QNetworkRequest& request, QIODevice* outgoingData);
+
+    friend class QGCNetworkReply;
+};
+
+/// Reply to an http(s) request which holds off the real request until the limit of requests in flight allows it and
+/// then reads its data at the download rate limit
+class QGCNetworkReply : public QNetworkReply
+{
+    Q_OBJECT
+
+public:
+    /// @param admitted false: The internet is down, the reply fails right away
+    QGCNetworkReply(QGCNetworkAccessManager* manager, Operation op, const QNetworkRequest& request, QIODevice* outgoingData, bool admitted);
+    ~QGCNetworkReply();
+
+    void    abort           (void) override;
+    void    ignoreSslErrors (void) override;
+    bool    isSequential    (void) const override { return true; }
+    qint64  bytesAvailable  (void) const override;
+
+protected:
+    qint64  readData        (char* data, qint64 maxSize) override;
+    void    ignoreSslErrorsImplementation(const QList<QSslError>& errors) override;
+
+private slots:
+    void _start             (void);
+    void _pull              (void);
+    void _replyMetaData     (void);
+    void _replyFinished     (void);
+    void _replyUpload       (qint64 bytesSent, qint64 bytesTotal);
+
+private:
+    void _copyMetaData      (void);
+    void _finish            (NetworkError error, const QString& errorString);
+
+    QPointer<QGCNetworkAccessManager>   _manager;
+    QPointer<QIODevice>                 _outgoingData;
+    QNetworkReply*                      _reply              = nullptr;
+    QString                             _consumer;
+    QByteArray                          _buffer;                ///< Read from _reply, not read by the user yet
+    qint64                              _bytesReceived      = 0;
+    qint64                              _bytesTotal         = -1;
+    qint64                              _bytesSent          = 0;
+    bool                                _replyDone          = false;
+    bool                                _ignoreAllSslErrors = false;
+    QList<QSslError>                    _ignoredSslErrors;
+    QTimer                              _pullTimer;             ///< Waits for the download rate bucket to refill
+    bool                                _slotHeld           = false;    ///< Under the service mutex
+    bool                                _routed             = false;
+    bool                                _skipped            = false;
+    QUrl                                _routedUrl;             ///< Url the route was added for, url() follows redirects
+
+    friend class QGCNetworkService;
+};
+
+/// Cache of one access manager, forwards to the disk cache of the consumer of each url
+class QGCNetworkCache : public QAbstractNetworkCache
+{
+    Q_OBJECT
+
+public:
+    QGCNetworkCache(QObject* parent = nullptr);
+
+    QNetworkCacheMetaData   metaData        (const QUrl& url) override;
+    void                    updateMetaData  (const QNetworkCacheMetaData& metaData) override;
+    QIODevice*              data            (const QUrl& url) override;
+    bool                    remove          (const QUrl& url) override;
+    qint64                  cacheSize       (void) const override;
+    QIODevice*              prepare         (const QNetworkCacheMetaData& metaData) override;
+    void                    insert          (QIODevice* device) override;
+
+public slots:
+    void                    clear           (void) override;
+
+private:
+    QHash<QIODevice*, QNetworkDiskCache*> _preparing;     ///< Devices handed out by prepare, only used on this thread
+};
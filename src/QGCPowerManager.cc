@@ -0,0 +1,161 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCPowerManager.h"
+#include "QGCApplication.h"
+#include "SettingsManager.h"
+#include "MultiVehicleManager.h"
+
+#include <QEvent>
+#include <QGuiApplication>
+#include <QWindow>
+
+QGC_LOGGING_CATEGORY(PowerManagerLog, "PowerManagerLog")
+
+QGCPowerManager::QGCPowerManager(QGCApplication* app, QGCToolbox* toolbox)
+    : QGCTool(app, toolbox)
+{
+    _inputClock.start();
+
+    _checkTimer.setSingleShot(false);
+    _checkTimer.setInterval(checkMSecs);
+    _checkTimer.setWindow(checkMSecs);
+    connect(&_checkTimer, &QGCWheelTimer::timeout, this, &QGCPowerManager::_check);
+}
+
+QGCPowerManager::~QGCPowerManager()
+{
+    qApp->removeEventFilter(this);
+}
+
+void QGCPowerManager::setToolbox(QGCToolbox* toolbox)
+{
+    QGCTool::setToolbox(toolbox);
+
+    connect(qApp, &QGuiApplication::applicationStateChanged, this, &QGCPowerManager::_check);
+
+    Fact* powerSaving = toolbox->settingsManager()->appSettings()->powerSaving();
+    connect(powerSaving, &Fact::rawValueChanged, this, &QGCPowerManager::_powerSavingChanged);
+    _powerSavingChanged(powerSaving->rawValue());
+}
+
+void QGCPowerManager::_powerSavingChanged(QVariant value)
+{
+    // Unit tests run for minutes without user input, their fact groups have to keep their rates
+    _powerSaving = value.toBool() && !qgcApp()->runningUnitTests();
+    qCDebug(PowerManagerLog) << "Power saving" << _powerSaving;
+
+    if (_powerSaving) {
+        qApp->installEventFilter(this);
+        _inputClock.restart();
+        _checkTimer.start();
+    } else {
+        qApp->removeEventFilter(this);
+        _checkTimer.stop();
+    }
+    _check();
+}
+
+QGCPowerManager::PowerState QGCPowerManager::stateFor(bool background, bool vehicleConnected, qint64 msecsSinceInput)
+{
+    if (background) {
+        return PowerBackground;
+    }
+    if (!vehicleConnected && msecsSinceInput >= idleMSecs) {
+        return PowerIdle;
+    }
+    return PowerActive;
+}
+
+int QGCPowerManager::rateFactor(PowerState powerState)
+{
+    switch (powerState) {
+    case PowerIdle:
+        return idleRateFactor;
+    case PowerBackground:
+        return backgroundRateFactor;
+    case PowerActive:
+        break;
+    }
+    return 1;
+}
+
+void QGCPowerManager::userActivity(void)
+{
+    _inputClock.restart();
+    if (_powerState == PowerIdle) {
+        _check();
+    }
+}
+
+bool QGCPowerManager::eventFilter(QObject* object, QEvent* event)
+{
+    switch (event->type()) {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseMove:
+    case QEvent::Wheel:
+    case QEvent::KeyPress:
+    case QEvent::TouchBegin:
+    case QEvent::TouchUpdate:
+        userActivity();
+        break;
+    default:
+        break;
+    }
+    return QGCTool::eventFilter(object, event);
+}
+
+bool QGCPowerManager::_windowBackground(void) const
+{
+    const Qt::ApplicationState applicationState = QGuiApplication::applicationState();
+    if (applicationState == Qt::ApplicationSuspended || applicationState == Qt::ApplicationHidden) {
+        return true;
+    }
+
+    // On the desktop an inactive window behind others may still be looked at, only hidden ones count. Without any
+    // window, such as when running as a relay or in the unit tests, nothing is shown in the first place.
+    const QWindowList windows = QGuiApplication::topLevelWindows();
+    if (windows.isEmpty()) {
+        return false;
+    }
+    for (const QWindow* window: windows) {
+        if (window->isVisible() && window->visibility() != QWindow::Minimized) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void QGCPowerManager::_check(void)
+{
+    if (!_powerSaving) {
+        _setPowerState(PowerActive);
+        return;
+    }
+
+    MultiVehicleManager* multiVehicleManager = _toolbox->multiVehicleManager();
+    const bool vehicleConnected = multiVehicleManager && multiVehicleManager->vehicles()->count() > 0;
+    _setPowerState(stateFor(_windowBackground(), vehicleConnected, _inputClock.elapsed()));
+}
+
+void QGCPowerManager::_setPowerState(PowerState powerState)
+{
+    if (powerState == _powerState) {
+        return;
+    }
+
+    const int oldRateFactor = updateRateFactor();
+    qCDebug(PowerManagerLog) << "Power state" << _powerState << "->" << powerState;
+    _powerState = powerState;
+
+    emit powerStateChanged(_powerState);
+    if (updateRateFactor() != oldRateFactor) {
+        emit updateRateFactorChanged(updateRateFactor());
+    }
+}
@@ -0,0 +1,89 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCToolbox.h"
+#include "QGCLoggingCategory.h"
+#include "QGCTimerWheel.h"
+
+#include <QElapsedTimer>
+#include <QVariant>
+
+Q_DECLARE_LOGGING_CATEGORY(PowerManagerLog)
+
+/// Power saving of the user interface.
+///
+/// The scene graph only renders when an item changes, and not at all while the window is hidden, so saving power
+/// means changing items less often. Values which are only shown, the fact groups and the ADS-B vehicles on the map,
+/// are published updateRateFactor times less often while nobody is looking at them:
+///     PowerIdle:          No vehicle is connected and there was no user input for idleMSecs
+///     PowerBackground:    The main window is minimized or hidden, or the OS suspended the application
+/// Video isn't decoded in the background, see VideoManager. Links, commands, the telemetry recorder and the logs keep
+/// running at full rate in all states. The powerSaving app setting turns it off.
+class QGCPowerManager : public QGCTool
+{
+    Q_OBJECT
+
+public:
+    QGCPowerManager(QGCApplication* app, QGCToolbox* toolbox);
+    ~QGCPowerManager();
+
+    enum PowerState {
+        PowerActive = 0,
+        PowerIdle,
+        PowerBackground,
+    };
+    Q_ENUM(PowerState)
+
+    Q_PROPERTY(PowerState   powerState          READ powerState         NOTIFY powerStateChanged)
+    Q_PROPERTY(int          updateRateFactor    READ updateRateFactor   NOTIFY updateRateFactorChanged)
+
+    // Overrides from QGCTool
+    void setToolbox(QGCToolbox* toolbox) override;
+
+    PowerState  powerState      (void) const { return _powerState; }
+    bool        background      (void) const { return _powerState == PowerBackground; }
+
+    /// @return Values are published this many times less often than their normal rate, 1 while active
+    int         updateRateFactor(void) const { return rateFactor(_powerState); }
+
+    /// Counts as user input, moves the application out of idle
+    void        userActivity    (void);
+
+    static PowerState   stateFor    (bool background, bool vehicleConnected, qint64 msecsSinceInput);
+    static int          rateFactor  (PowerState powerState);
+
+    static const int idleMSecs              = 60000;
+    static const int checkMSecs             = 1000;
+    static const int idleRateFactor         = 4;
+    static const int backgroundRateFactor   = 10;
+
+signals:
+    void powerStateChanged      (PowerState powerState);
+    void updateRateFactorChanged(int updateRateFactor);
+
+protected:
+    bool eventFilter(QObject* object, QEvent* event) override;
+
+private slots:
+    void _check                 (void);
+    void _powerSavingChanged    (QVariant value);
+
+private:
+    bool _windowBackground      (void) const;
+    void _setPowerState         (PowerState powerState);
+
+    bool            _powerSaving    = true;
+    PowerState      _powerState     = PowerActive;
+    QElapsedTimer   _inputClock;                        ///< Since the last user input
+    QGCWheelTimer   _checkTimer     { "Power" };
+
+    friend class QGCPowerManagerTest;   // Unit test
+};
@@ -0,0 +1,84 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCResourceBundles.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QResource>
+
+QGC_LOGGING_CATEGORY(ResourceBundlesLog, "ResourceBundlesLog")
+
+const char*     QGCResourceBundles::bundleSuffix = ".rcc";
+QMutex          QGCResourceBundles::_mutex;
+QSet<QString>   QGCResourceBundles::_loaded;
+
+bool QGCResourceBundles::lazyResources(void)
+{
+#ifdef QGC_LAZY_RESOURCES
+    return true;
+#else
+    return false;
+#endif
+}
+
+QStringList QGCResourceBundles::searchPaths(void)
+{
+    QStringList paths;
+
+#if defined(__android__)
+    paths.append(QStringLiteral("assets:/bundles"));
+#else
+    const QString applicationDir = QCoreApplication::applicationDirPath();
+    paths.append(applicationDir + QStringLiteral("/bundles"));
+    paths.append(applicationDir);
+#endif
+
+    return paths;
+}
+
+bool QGCResourceBundles::isLoaded(const QString& name)
+{
+    QMutexLocker lock(&_mutex);
+
+    return _loaded.contains(name);
+}
+
+bool QGCResourceBundles::load(const QString& name)
+{
+    if (!lazyResources()) {
+        // Compiled in
+        return true;
+    }
+
+    QMutexLocker lock(&_mutex);
+
+    if (_loaded.contains(name)) {
+        return true;
+    }
+
+    for (const QString& path: searchPaths()) {
+        const QString bundleFile = QDir(path).filePath(name + bundleSuffix);
+        if (!QFileInfo::exists(bundleFile)) {
+            continue;
+        }
+        // The resource system maps the file, nothing is read until a resource in it is used
+        if (!QResource::registerResource(bundleFile)) {
+            qCWarning(ResourceBundlesLog) << "Not a valid resource bundle" << bundleFile;
+            return false;
+        }
+        _loaded.insert(name);
+        qCDebug(ResourceBundlesLog) << "Registered" << bundleFile;
+        return true;
+    }
+
+    qCDebug(ResourceBundlesLog) << "Bundle not installed" << name << searchPaths();
+    return false;
+}
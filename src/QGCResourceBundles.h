@@ -0,0 +1,52 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCLoggingCategory.h"
+
+#include <QMutex>
+#include <QSet>
+#include <QStringList>
+
+Q_DECLARE_LOGGING_CATEGORY(ResourceBundlesLog)
+
+/// Resources which only some users need, loaded on first use.
+///
+/// With the QGC_LAZY_RESOURCES build option these resources are built as bundles, binary .rcc files installed in a
+/// bundles directory next to the executable (the assets on Android), instead of being compiled into it:
+///     APMResources        ArduPilot firmware plugin, loaded when the plugin is created
+///     PX4Resources        PX4 firmware plugin, loaded when the plugin is created
+///     qgckoreanfonts      Korean fonts, loaded when Korean is the language
+///     qgci18n             Translations, loaded when the language isn't English. Optional, the release packaging
+///                         may install it, otherwise the translations are looked for as compiled in.
+/// A bundle is registered with the resource system the first time it is asked for and stays registered, its paths are
+/// the same as when it is compiled in. Without the option everything is compiled in and load has nothing to do.
+class QGCResourceBundles
+{
+public:
+    /// Registers the bundle on the first call for it. Thread safe.
+    /// @return false: The bundle file isn't installed or isn't valid, its resources are missing
+    static bool load(const QString& name);
+
+    /// @return true: The bundle was registered by load, always false if everything is compiled in
+    static bool isLoaded(const QString& name);
+
+    /// @return true: Built with QGC_LAZY_RESOURCES, load looks for bundle files
+    static bool lazyResources(void);
+
+    /// @return Directories load looks for <name>.rcc in, in order
+    static QStringList searchPaths(void);
+
+    static const char* bundleSuffix;
+
+private:
+    static QMutex           _mutex;
+    static QSet<QString>    _loaded;
+};
@@ -0,0 +1,348 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTimerWheel.h"
+
+#include <QThread>
+
+QGC_LOGGING_CATEGORY(TimerWheelLog, "TimerWheelLog")
+
+QGCTimerWheel* QGCTimerWheel::_instance = nullptr;
+
+/// @return Wheel tick for a timeout at msecs, moved onto a multiple of window
+static qint64 _dueTick(qint64 msecs, int window)
+{
+    if (window > 0) {
+        msecs = ((msecs + window - 1) / window) * window;
+    }
+    return (msecs + QGCTimerWheel::tickMSecs - 1) / QGCTimerWheel::tickMSecs;
+}
+
+QGCTimerWheel::QGCTimerWheel(QGCApplication* app, QGCToolbox* toolbox)
+    : QGCTool(app, toolbox)
+{
+    _instance = this;
+    _clock.start();
+
+    _wakeupTimer.setSingleShot(true);
+    _wakeupTimer.setTimerType(Qt::PreciseTimer);
+    connect(&_wakeupTimer, &QTimer::timeout, this, &QGCTimerWheel::_wakeup);
+}
+
+QGCTimerWheel::~QGCTimerWheel()
+{
+    // Timers which outlive the wheel can no longer be started
+    for (QGCWheelTimer* timer: _timers) {
+        timer->_id      = 0;
+        timer->_active  = false;
+    }
+    _timers.clear();
+
+    if (_instance == this) {
+        _instance = nullptr;
+    }
+}
+
+quint32 QGCTimerWheel::_register(QGCWheelTimer* timer)
+{
+    const quint32 id = _nextId++;
+    if (_nextId == 0) {
+        _nextId = 1;
+    }
+    _timers.insert(id, timer);
+    timer->_subsystemIndex = _subsystemIndex(timer->_subsystem);
+    return id;
+}
+
+void QGCTimerWheel::_unregister(QGCWheelTimer* timer)
+{
+    _stop(timer);
+    _timers.remove(timer->_id);
+    timer->_id = 0;
+}
+
+int QGCTimerWheel::_subsystemIndex(const QString& subsystem)
+{
+    int index = _subsystems.indexOf(subsystem);
+    if (index == -1) {
+        index = _subsystems.count();
+        _subsystems.append(subsystem);
+        _subsystemWakeups.append(0);
+        _subsystemTimeouts.append(0);
+        _subsystemActive.append(0);
+        _subsystemLastWakeup.append(-1);
+    }
+    return index;
+}
+
+void QGCTimerWheel::_start(QGCWheelTimer* timer, int msecs)
+{
+    _stop(timer);
+
+    const qint64 now = _clock.elapsed();
+
+    if (_activeCount == 0 && !_processing) {
+        // Nothing is running, so drop what stop and restart left behind and jump to now instead of stepping
+        // through all the ticks since the wheel went idle
+        for (int level=0; level<_levelCount; level++) {
+            for (int slot=0; slot<_slotCount; slot++) {
+                _slots[level][slot].clear();
+            }
+        }
+        _currentTick = now / tickMSecs;
+    }
+
+    timer->_serial++;
+    timer->_active  = true;
+    timer->_dueTick = _dueTick(now + qMax(msecs, 0), timer->_window);
+    _activeCount++;
+    _subsystemActive[timer->_subsystemIndex]++;
+    _insert(timer);
+
+    if (!_processing && (_wakeupTick < 0 || timer->_dueTick < _wakeupTick)) {
+        _scheduleWakeup(timer->_dueTick);
+    }
+}
+
+void QGCTimerWheel::_stop(QGCWheelTimer* timer)
+{
+    if (!timer->_active) {
+        return;
+    }
+
+    // The slot entry stays behind and is skipped because of the serial, finding it isn't worth it
+    timer->_active = false;
+    timer->_serial++;
+    _activeCount--;
+    _subsystemActive[timer->_subsystemIndex]--;
+}
+
+void QGCTimerWheel::_insert(QGCWheelTimer* timer)
+{
+    if (timer->_dueTick <= _currentTick) {
+        timer->_dueTick = _currentTick + 1;
+    }
+
+    const qint64        due     = timer->_dueTick;
+    const SlotEntry_t   entry   = { timer->_id, timer->_serial };
+
+    for (int level=0; level<_levelCount; level++) {
+        const int shift = level * _slotBits;
+        if ((due >> shift) - (_currentTick >> shift) < _slotCount) {
+            _slots[level][(due >> shift) & _slotMask].append(entry);
+            return;
+        }
+    }
+
+    // Further out than the top level reaches, wait in its last slot and get cascaded again from there
+    const int shift = (_levelCount - 1) * _slotBits;
+    _slots[_levelCount - 1][((_currentTick >> shift) + _slotMask) & _slotMask].append(entry);
+}
+
+void QGCTimerWheel::_cascade(int level, qint64 tick)
+{
+    _scratch.swap(_slots[level][(tick >> (level * _slotBits)) & _slotMask]);
+
+    for (const SlotEntry_t& entry: _scratch) {
+        QGCWheelTimer* timer = _timers.value(entry.id, nullptr);
+        if (timer && timer->_active && timer->_serial == entry.serial) {
+            _insert(timer);
+        }
+    }
+    _scratch.clear();
+}
+
+void QGCTimerWheel::_expire(qint64 tick, qint64 nowMSecs)
+{
+    _scratch.swap(_slots[0][tick & _slotMask]);
+
+    for (const SlotEntry_t& entry: _scratch) {
+        // Timeout handlers may stop, restart or delete any timer, which the lookup and serial catch
+        QGCWheelTimer* timer = _timers.value(entry.id, nullptr);
+        if (!timer || !timer->_active || timer->_serial != entry.serial) {
+            continue;
+        }
+        if (timer->_dueTick > tick) {
+            _insert(timer);
+            continue;
+        }
+
+        const int subsystem = timer->_subsystemIndex;
+        if (_subsystemLastWakeup[subsystem] != static_cast<qint64>(_wakeupCount)) {
+            _subsystemLastWakeup[subsystem] = static_cast<qint64>(_wakeupCount);
+            _subsystemWakeups[subsystem]++;
+        }
+        _subsystemTimeouts[subsystem]++;
+
+        if (timer->_singleShot) {
+            _stop(timer);
+        } else {
+            // Keep the cadence, but skip what was missed instead of firing in a burst like QTimer does
+            qint64 nextMSecs = timer->_dueTick * tickMSecs + timer->_interval;
+            if (nextMSecs <= nowMSecs) {
+                nextMSecs = nowMSecs + timer->_interval;
+            }
+            timer->_serial++;
+            timer->_dueTick = _dueTick(nextMSecs, timer->_window);
+            _insert(timer);
+        }
+
+        emit timer->timeout();
+    }
+    _scratch.clear();
+}
+
+void QGCTimerWheel::_wakeup(void)
+{
+    if (_processing) {
+        // A timeout handler ran the event loop, the outer wakeup schedules the next one
+        return;
+    }
+
+    _processing = true;
+    _wakeupTick = -1;
+    _wakeupCount++;
+    _intervalWakeups++;
+
+    const qint64 nowMSecs   = _clock.elapsed();
+    const qint64 nowTick    = nowMSecs / tickMSecs;
+
+    while (_currentTick < nowTick) {
+        const qint64 tick = ++_currentTick;
+
+        // Higher levels first, their timers may belong in the lower level slot which is up next
+        for (int level=_levelCount-1; level>0; level--) {
+            if ((tick & ((Q_INT64_C(1) << (level * _slotBits)) - 1)) == 0) {
+                _cascade(level, tick);
+            }
+        }
+        _expire(tick, nowMSecs);
+    }
+
+    _processing = false;
+
+    if (nowMSecs - _statisticsStartMSecs >= statisticsIntervalMSecs) {
+        _updateStatistics(nowMSecs);
+    }
+    _scheduleWakeup(_nextTick());
+}
+
+qint64 QGCTimerWheel::_nextTick(void) const
+{
+    if (_activeCount == 0) {
+        return -1;
+    }
+
+    // Earliest expiry on level 0, or the earliest slot start on the higher levels where timers move down a level
+    qint64 next = -1;
+    for (int level=0; level<_levelCount; level++) {
+        const int       shift   = level * _slotBits;
+        const qint64    base    = _currentTick >> shift;
+
+        for (int offset=1; offset<_slotCount; offset++) {
+            if (!_slots[level][(base + offset) & _slotMask].isEmpty()) {
+                const qint64 tick = (base + offset) << shift;
+                if (next < 0 || tick < next) {
+                    next = tick;
+                }
+                break;
+            }
+        }
+    }
+    return next;
+}
+
+void QGCTimerWheel::_scheduleWakeup(qint64 tick)
+{
+    _wakeupTick = tick;
+    if (tick < 0) {
+        _wakeupTimer.stop();
+    } else {
+        _wakeupTimer.start(static_cast<int>(qMax(Q_INT64_C(0), tick * tickMSecs - _clock.elapsed())));
+    }
+}
+
+void QGCTimerWheel::_updateStatistics(qint64 nowMSecs)
+{
+    const double secs = (nowMSecs - _statisticsStartMSecs) / 1000.0;
+
+    qCDebug(TimerWheelLog) << "Wakeups/sec" << _intervalWakeups / secs << "active timers" << _activeCount;
+
+    _statistics.clear();
+    for (int i=0; i<_subsystems.count(); i++) {
+        Statistics_t statistics;
+        statistics.subsystem            = _subsystems[i];
+        statistics.wakeupsPerSecond     = _subsystemWakeups[i] / secs;
+        statistics.timeoutsPerSecond    = _subsystemTimeouts[i] / secs;
+        statistics.activeTimers         = _subsystemActive[i];
+        _statistics.append(statistics);
+
+        qCDebug(TimerWheelLog) << "    " << statistics.subsystem
+                               << "wakeups/sec" << statistics.wakeupsPerSecond
+                               << "timeouts/sec" << statistics.timeoutsPerSecond
+                               << "active" << statistics.activeTimers;
+
+        _subsystemWakeups[i]    = 0;
+        _subsystemTimeouts[i]   = 0;
+    }
+
+    _intervalWakeups        = 0;
+    _statisticsStartMSecs   = nowMSecs;
+}
+
+QGCWheelTimer::QGCWheelTimer(const QString& subsystem, QObject* parent)
+    : QObject   (parent)
+    , _subsystem(subsystem)
+{
+
+}
+
+QGCWheelTimer::~QGCWheelTimer()
+{
+    QGCTimerWheel* wheel = QGCTimerWheel::_instance;
+    if (_id && wheel) {
+        wheel->_unregister(this);
+    }
+}
+
+void QGCWheelTimer::start(int msecs)
+{
+    _interval = msecs;
+    start();
+}
+
+void QGCWheelTimer::start(void)
+{
+    QGCTimerWheel* wheel = QGCTimerWheel::_instance;
+
+    if (!wheel) {
+        qCWarning(TimerWheelLog) << "Timer started without a timer wheel" << _subsystem;
+        return;
+    }
+    if (QThread::currentThread() != wheel->thread()) {
+        qCWarning(TimerWheelLog) << "Timer started from another thread" << _subsystem;
+        return;
+    }
+
+    if (!_id) {
+        _id = wheel->_register(this);
+    }
+    wheel->_start(this, _interval);
+}
+
+void QGCWheelTimer::stop(void)
+{
+    QGCTimerWheel* wheel = QGCTimerWheel::_instance;
+
+    if (_id && wheel) {
+        wheel->_stop(this);
+    } else {
+        _active = false;
+    }
+}
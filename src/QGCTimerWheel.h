@@ -0,0 +1,154 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCToolbox.h"
+#include "QGCLoggingCategory.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QTimer>
+#include <QVector>
+
+Q_DECLARE_LOGGING_CATEGORY(TimerWheelLog)
+
+class QGCWheelTimer;
+
+/// Runs the timers of all subsystems from a single QTimer, which only wakes up when a timer expires. Timers are kept
+/// in a hierarchical timing wheel: four levels of 64 slots, each slot of a level spanning all of the level below. Start,
+/// restart and stop are O(1), which matters for timeouts restarted on every received message.
+///
+/// Timers with a window expire on multiples of it, so for example all of the 100 msec fact group timers of all vehicles
+/// expire in the same wakeup. Wakeups are counted for each subsystem, see statistics. The TimerWheelLog category logs
+/// them every statisticsIntervalMSecs.
+///
+/// Timers must be used from the main thread.
+class QGCTimerWheel : public QGCTool
+{
+    Q_OBJECT
+
+public:
+    QGCTimerWheel(QGCApplication* app, QGCToolbox* toolbox);
+    ~QGCTimerWheel();
+
+    typedef struct {
+        QString subsystem;
+        double  wakeupsPerSecond;   ///< Wakeups which expired at least one timer of the subsystem
+        double  timeoutsPerSecond;
+        int     activeTimers;
+    } Statistics_t;
+
+    /// @return One entry for each subsystem over the last statistics interval
+    QList<Statistics_t> statistics(void) const { return _statistics; }
+
+    /// Total number of wakeups, including those which only move timers down a level
+    quint64 wakeupCount(void) const { return _wakeupCount; }
+
+    static const int tickMSecs                  = 10;
+    static const int statisticsIntervalMSecs    = 10000;
+
+private slots:
+    void _wakeup(void);
+
+private:
+    typedef struct {
+        quint32 id;
+        quint32 serial;     ///< Entries left behind by a stop or restart have an old serial
+    } SlotEntry_t;
+
+    quint32 _register           (QGCWheelTimer* timer);
+    void    _unregister         (QGCWheelTimer* timer);
+    void    _start              (QGCWheelTimer* timer, int msecs);
+    void    _stop               (QGCWheelTimer* timer);
+    void    _insert             (QGCWheelTimer* timer);
+    void    _cascade            (int level, qint64 tick);
+    void    _expire             (qint64 tick, qint64 nowMSecs);
+    qint64  _nextTick           (void) const;
+    void    _scheduleWakeup     (qint64 tick);
+    void    _updateStatistics   (qint64 nowMSecs);
+    int     _subsystemIndex     (const QString& subsystem);
+
+    static const int _levelCount    = 4;
+    static const int _slotBits      = 6;
+    static const int _slotCount     = 1 << _slotBits;
+    static const int _slotMask      = _slotCount - 1;
+
+    QVector<SlotEntry_t>            _slots[_levelCount][_slotCount];
+    QHash<quint32, QGCWheelTimer*>  _timers;
+    quint32                         _nextId         = 1;
+    int                             _activeCount    = 0;
+    qint64                          _currentTick    = 0;        ///< All ticks up to this one have been processed
+    qint64                          _wakeupTick     = -1;       ///< _wakeupTimer is set for this tick
+    bool                            _processing     = false;    ///< Inside _wakeup, timeout handlers may start timers
+    QVector<SlotEntry_t>            _scratch;                   ///< Slot being processed, swapped out to keep capacity
+    QElapsedTimer                   _clock;
+    QTimer                          _wakeupTimer;
+
+    // Statistics
+    QStringList                     _subsystems;
+    QVector<int>                    _subsystemWakeups;
+    QVector<int>                    _subsystemTimeouts;
+    QVector<int>                    _subsystemActive;
+    QVector<qint64>                 _subsystemLastWakeup;      ///< Counts a wakeup only once per subsystem
+    quint64                         _wakeupCount            = 0;
+    int                             _intervalWakeups        = 0;
+    qint64                          _statisticsStartMSecs   = 0;
+    QList<Statistics_t>             _statistics;
+
+    /// Tools create timers in the QGCToolbox constructor, before qgcApp()->toolbox() is set, and some timers are
+    /// destroyed after the toolbox. So QGCWheelTimer finds the wheel here instead of through the toolbox. nullptr
+    /// once the wheel is gone.
+    static QGCTimerWheel*           _instance;
+
+    friend class QGCWheelTimer;
+};
+
+/// A QTimer replacement run by QGCTimerWheel. Also for timers which are restarted at a high rate.
+class QGCWheelTimer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// @param subsystem Wakeups are counted for each subsystem, see QGCTimerWheel::statistics
+    explicit QGCWheelTimer(const QString& subsystem, QObject* parent = nullptr);
+    ~QGCWheelTimer();
+
+    void setInterval    (int msecs)         { _interval = msecs; }
+    int  interval       (void) const        { return _interval; }
+    void setSingleShot  (bool singleShot)   { _singleShot = singleShot; }
+    bool isSingleShot   (void) const        { return _singleShot; }
+    bool isActive       (void) const        { return _active; }
+
+    /// Expiry is delayed by up to window msecs, onto a multiple of window, so timers with the same window expire
+    /// together. 0 (default): Only rounded up to the wheel tick. Takes effect on the next start.
+    void setWindow      (int msecs)         { _window = msecs; }
+    int  window         (void) const        { return _window; }
+
+public slots:
+    void start  (void);
+    void start  (int msecs);
+    void stop   (void);
+
+signals:
+    void timeout(void);
+
+private:
+    QString _subsystem;
+    int     _subsystemIndex = -1;
+    quint32 _id             = 0;
+    quint32 _serial         = 0;
+    qint64  _dueTick        = 0;
+    int     _interval       = 0;
+    int     _window         = 0;
+    bool    _singleShot     = false;
+    bool    _active         = false;
+
+    friend class QGCTimerWheel;
+};
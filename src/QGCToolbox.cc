@@ -31,6 +31,12 @@
 #include "SettingsManager.h"
 #include "QGCApplication.h"
 #include "ADSBVehicleManager.h"
+#include "QGCTimerWheel.h"
+#include "QGCNetworkService.h"
+#include "QGCPowerManager.h"
+#include "QGCMemoryAccounting.h"
+#include "LogIndexManager.h"
+#include "TelemetryStreamServer.h"
 #if defined(QGC_ENABLE_PAIRING)
 #include "PairingManager.h"
 #endif
@@ -50,10 +56,22 @@
 #include CUSTOMHEADER
 #endif
 
+#include <QElapsedTimer>
+
+QGC_LOGGING_CATEGORY(StartupLog, "StartupLog")
+
 QGCToolbox::QGCToolbox(QGCApplication* app)
 {
     // SettingsManager must be first so settings are available to any subsequent tools
     _settingsManager        = new SettingsManager           (app, this);
+    // Tools create their timers from here on
+    _timerWheel             = new QGCTimerWheel             (app, this);
+    // Tools use the network from here on
+    _networkService         = new QGCNetworkService         (app, this);
+    // Tools publishing values to the ui follow its power state from here on
+    _powerManager           = new QGCPowerManager           (app, this);
+    // Tools report the memory they use from here on
+    _memoryAccounting       = new QGCMemoryAccounting       (app, this);
     //-- Scan and load plugins
     _scanAndLoadPlugins(app);
     _audioOutput            = new AudioOutput               (app, this);
@@ -62,19 +80,25 @@ QGCToolbox::QGCToolbox(QGCApplication* app)
 #ifndef __mobile__
     _gpsManager             = new GPSManager                (app, this);
 #endif
-    _imageProvider          = new QGCImageProvider          (app, this);
     _joystickManager        = new JoystickManager           (app, this);
     _linkManager            = new LinkManager               (app, this);
     _mavlinkProtocol        = new MAVLinkProtocol           (app, this);
     _missionCommandTree     = new MissionCommandTree        (app, this);
     _multiVehicleManager    = new MultiVehicleManager       (app, this);
-    _mapEngineManager       = new QGCMapEngineManager       (app, this);
     _uasMessageHandler      = new UASMessageHandler         (app, this);
     _qgcPositionManager     = new QGCPositionManager        (app, this);
-    _followMe               = new FollowMe                  (app, this);
-    _videoManager           = new VideoManager              (app, this);
+    if (!app->runningRelay()) {
+        // A relay has no ui to show images, maps or video in, and doesn't fly anything which could follow it. Users of
+        // these tools check for nullptr.
+        _imageProvider      = new QGCImageProvider          (app, this);
+        _mapEngineManager   = new QGCMapEngineManager       (app, this);
+        _followMe           = new FollowMe                  (app, this);
+        _videoManager       = new VideoManager              (app, this);
+    }
     _mavlinkLogManager      = new MAVLinkLogManager         (app, this);
     _adsbVehicleManager     = new ADSBVehicleManager        (app, this);
+    _logIndexManager        = new LogIndexManager           (app, this);
+    _telemetryStreamServer  = new TelemetryStreamServer     (app, this);
 #if defined(QGC_ENABLE_PAIRING)
     _pairingManager         = new PairingManager            (app, this);
 #endif
@@ -96,39 +120,79 @@ QGCToolbox::QGCToolbox(QGCApplication* app)
 
 void QGCToolbox::setChildToolboxes(void)
 {
+    QElapsedTimer timer;
+    timer.start();
+
     // SettingsManager must be first so settings are available to any subsequent tools
-    _settingsManager->setToolbox(this);
+    _setToolbox(_settingsManager);
 
-    _corePlugin->setToolbox(this);
-    _audioOutput->setToolbox(this);
-    _factSystem->setToolbox(this);
-    _firmwarePluginManager->setToolbox(this);
+    _setToolbox(_timerWheel);
+    _setToolbox(_networkService);
+    _setToolbox(_powerManager);
+    _setToolbox(_memoryAccounting);
+    _setToolbox(_corePlugin);
+    _setToolbox(_audioOutput);
+    _setToolbox(_factSystem);
+    _setToolbox(_firmwarePluginManager);
 #ifndef __mobile__
-    _gpsManager->setToolbox(this);
-#endif
-    _imageProvider->setToolbox(this);
-    _joystickManager->setToolbox(this);
-    _linkManager->setToolbox(this);
-    _mavlinkProtocol->setToolbox(this);
-    _missionCommandTree->setToolbox(this);
-    _multiVehicleManager->setToolbox(this);
-    _mapEngineManager->setToolbox(this);
-    _uasMessageHandler->setToolbox(this);
-    _followMe->setToolbox(this);
-    _qgcPositionManager->setToolbox(this);
-    _videoManager->setToolbox(this);
-    _mavlinkLogManager->setToolbox(this);
-    _airspaceManager->setToolbox(this);
-    _adsbVehicleManager->setToolbox(this);
+    _setToolbox(_gpsManager);
+#endif
+    _setToolbox(_imageProvider);
+    _setToolbox(_joystickManager);
+    _setToolbox(_linkManager);
+    _setToolbox(_mavlinkProtocol);
+    _setToolbox(_missionCommandTree);
+    _setToolbox(_multiVehicleManager);
+    _setToolbox(_mapEngineManager);
+    _setToolbox(_uasMessageHandler);
+    _setToolbox(_followMe);
+    _setToolbox(_qgcPositionManager);
+    _setToolbox(_videoManager);
+    _setToolbox(_mavlinkLogManager);
+    _setToolbox(_airspaceManager);
+    _setToolbox(_adsbVehicleManager);
+    _setToolbox(_logIndexManager);
+    _setToolbox(_telemetryStreamServer);
 #if defined(QGC_GST_TAISYNC_ENABLED)
-    _taisyncManager->setToolbox(this);
+    _setToolbox(_taisyncManager);
 #endif
 #if defined(QGC_GST_MICROHARD_ENABLED)
-    _microhardManager->setToolbox(this);
+    _setToolbox(_microhardManager);
 #endif
 #if defined(QGC_ENABLE_PAIRING)
-    _pairingManager->setToolbox(this);
+    _setToolbox(_pairingManager);
 #endif
+
+    qCDebug(StartupLog) << "All tools set up in" << timer.elapsed() << "msecs";
+}
+
+void QGCToolbox::_setToolbox(QGCTool* tool)
+{
+    if (!tool) {
+        // Left out of a relay toolbox
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    tool->setToolbox(this);
+    qCDebug(StartupLog) << "setToolbox" << tool->metaObject()->className() << timer.elapsed() << "msecs";
+    _tools.append(tool);
+}
+
+void QGCToolbox::deferredInitChildToolboxes(void)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    for (QGCTool* tool: _tools) {
+        QElapsedTimer toolTimer;
+        toolTimer.start();
+        tool->deferredInit();
+        qCDebug(StartupLog) << "deferredInit" << tool->metaObject()->className() << toolTimer.elapsed() << "msecs";
+    }
+
+    qCDebug(StartupLog) << "All deferred tool work done in" << timer.elapsed() << "msecs";
 }
 
 void QGCToolbox::_scanAndLoadPlugins(QGCApplication* app)
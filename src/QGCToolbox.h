@@ -11,7 +11,12 @@
 #ifndef QGCToolbox_h
 #define QGCToolbox_h
 
+#include "QGCLoggingCategory.h"
+
 #include <QObject>
+#include <QList>
+
+Q_DECLARE_LOGGING_CATEGORY(StartupLog)
 
 class FactSystem;
 class FirmwarePluginManager;
@@ -34,6 +39,13 @@ class QGCCorePlugin;
 class SettingsManager;
 class AirspaceManager;
 class ADSBVehicleManager;
+class QGCTimerWheel;
+class QGCNetworkService;
+class QGCPowerManager;
+class QGCMemoryAccounting;
+class LogIndexManager;
+class TelemetryStreamServer;
+class QGCTool;
 #if defined(QGC_ENABLE_PAIRING)
 class PairingManager;
 #endif
@@ -49,6 +61,8 @@ class QGCToolbox : public QObject {
     Q_OBJECT
 
 public:
+    /// When running as a relay the image provider, map engine manager, follow me and video manager tools aren't
+    /// created and their accessors return nullptr.
     QGCToolbox(QGCApplication* app);
 
     FirmwarePluginManager*      firmwarePluginManager   () { return _firmwarePluginManager; }
@@ -69,6 +83,12 @@ public:
     SettingsManager*            settingsManager         () { return _settingsManager; }
     AirspaceManager*            airspaceManager         () { return _airspaceManager; }
     ADSBVehicleManager*         adsbVehicleManager      () { return _adsbVehicleManager; }
+    QGCTimerWheel*              timerWheel              () { return _timerWheel; }
+    QGCNetworkService*          networkService          () { return _networkService; }
+    QGCPowerManager*            powerManager            () { return _powerManager; }
+    QGCMemoryAccounting*        memoryAccounting        () { return _memoryAccounting; }
+    LogIndexManager*            logIndexManager         () { return _logIndexManager; }
+    TelemetryStreamServer*      telemetryStreamServer   () { return _telemetryStreamServer; }
 #if defined(QGC_ENABLE_PAIRING)
     PairingManager*             pairingManager          () { return _pairingManager; }
 #endif
@@ -84,8 +104,12 @@ public:
 
 private:
     void setChildToolboxes(void);
+    void deferredInitChildToolboxes(void);
+    void _setToolbox(QGCTool* tool);
     void _scanAndLoadPlugins(QGCApplication *app);
 
+    QList<QGCTool*>             _tools;                         ///< In the order of setToolbox, for deferredInit
+
 
     AudioOutput*                _audioOutput            = nullptr;
     FactSystem*                 _factSystem             = nullptr;
@@ -109,6 +133,12 @@ private:
     SettingsManager*            _settingsManager        = nullptr;
     AirspaceManager*            _airspaceManager        = nullptr;
     ADSBVehicleManager*         _adsbVehicleManager     = nullptr;
+    QGCTimerWheel*              _timerWheel             = nullptr;
+    QGCNetworkService*          _networkService         = nullptr;
+    QGCPowerManager*            _powerManager           = nullptr;
+    QGCMemoryAccounting*        _memoryAccounting       = nullptr;
+    LogIndexManager*            _logIndexManager        = nullptr;
+    TelemetryStreamServer*      _telemetryStreamServer  = nullptr;
 #if defined(QGC_ENABLE_PAIRING)
     PairingManager*             _pairingManager         = nullptr;
 #endif
@@ -134,6 +164,11 @@ public:
     // If you override this method, you must call the base class.
     virtual void setToolbox(QGCToolbox* toolbox);
 
+    // Called once the main window has shown its first frame, or right after all setToolbox calls when running unit tests.
+    // Work which isn't needed for the first frame, such as opening connections or scanning directories, goes here so it
+    // stays off the startup path. Tools are called in the same order as setToolbox.
+    virtual void deferredInit(void) { }
+
 protected:
     QGCApplication* _app;
     QGCToolbox*     _toolbox;
@@ -0,0 +1,203 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTrace.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+
+#include <memory>
+
+namespace {
+
+typedef struct {
+    const char* category;
+    const char* name;
+    const char* argName;
+    qint64      argValue;
+    qint64      start;
+    qint64      duration;
+} Event_t;
+
+/// Events of one thread. Only that thread adds to it, the mutex is there for start and stop which run on another
+/// thread, so it is uncontended while tracing.
+typedef struct {
+    int                 tid;
+    QString             name;
+    QMutex              mutex;
+    QVector<Event_t>    events;
+    quint64             dropped;
+} ThreadBuffer_t;
+
+}
+
+std::atomic<bool> QGCTrace::_enabled(false);
+
+static QMutex                                       _buffersMutex;
+static QList<std::shared_ptr<ThreadBuffer_t>>       _buffers;           ///< Also keeps the events of threads which ended
+static int                                          _nextTid    = 1;
+static QElapsedTimer                                _clock;
+static thread_local std::shared_ptr<ThreadBuffer_t> _threadBuffer;
+
+static ThreadBuffer_t* _currentThreadBuffer(void)
+{
+    if (!_threadBuffer) {
+        auto buffer = std::make_shared<ThreadBuffer_t>();
+        buffer->dropped = 0;
+
+        QThread* thread = QThread::currentThread();
+        QMutexLocker lock(&_buffersMutex);
+        buffer->tid = _nextTid++;
+        if (!thread->objectName().isEmpty()) {
+            buffer->name = thread->objectName();
+        } else if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+            buffer->name = QStringLiteral("GUI");
+        } else {
+            buffer->name = QStringLiteral("Thread %1").arg(buffer->tid);
+        }
+        _buffers.append(buffer);
+        _threadBuffer = buffer;
+    }
+    return _threadBuffer.get();
+}
+
+static void _appendJsonString(QByteArray& json, const char* string)
+{
+    json.append('"');
+    for (const char* c = string; *c; c++) {
+        switch (*c) {
+        case '"':
+        case '\\':
+            json.append('\\');
+            json.append(*c);
+            break;
+        default:
+            if (static_cast<unsigned char>(*c) >= 0x20) {
+                json.append(*c);
+            }
+            break;
+        }
+    }
+    json.append('"');
+}
+
+void QGCTrace::start(void)
+{
+    _enabled.store(false);
+
+    QMutexLocker lock(&_buffersMutex);
+    for (int i=_buffers.count()-1; i>=0; i--) {
+        // Only this list holds on to the buffers of threads which ended
+        if (_buffers[i].use_count() == 1) {
+            _buffers.removeAt(i);
+            continue;
+        }
+        QMutexLocker bufferLock(&_buffers[i]->mutex);
+        _buffers[i]->events.clear();
+        _buffers[i]->dropped = 0;
+    }
+    _clock.start();
+
+    _enabled.store(true);
+}
+
+QByteArray QGCTrace::stop(void)
+{
+    _enabled.store(false);
+
+    const qint64    pid     = QCoreApplication::applicationPid();
+    quint64         dropped = 0;
+    QByteArray      json;
+
+    json.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    QMutexLocker lock(&_buffersMutex);
+    bool first = true;
+    for (const std::shared_ptr<ThreadBuffer_t>& buffer: _buffers) {
+        QMutexLocker bufferLock(&buffer->mutex);
+
+        json.append(first ? "\n" : ",\n");
+        first = false;
+        json.append(QStringLiteral("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%1,\"tid\":%2,\"args\":{\"name\":").arg(pid).arg(buffer->tid).toUtf8());
+        _appendJsonString(json, buffer->name.toUtf8().constData());
+        json.append("}}");
+
+        for (const Event_t& event: buffer->events) {
+            json.append(",\n{\"name\":");
+            _appendJsonString(json, event.name);
+            json.append(",\"cat\":");
+            _appendJsonString(json, event.category);
+            json.append(",\"ph\":\"X\",\"pid\":");
+            json.append(QByteArray::number(pid));
+            json.append(",\"tid\":");
+            json.append(QByteArray::number(buffer->tid));
+            json.append(",\"ts\":");
+            json.append(QByteArray::number(event.start));
+            json.append(",\"dur\":");
+            json.append(QByteArray::number(event.duration));
+            if (event.argName) {
+                json.append(",\"args\":{");
+                _appendJsonString(json, event.argName);
+                json.append(':');
+                json.append(QByteArray::number(event.argValue));
+                json.append('}');
+            }
+            json.append('}');
+        }
+        dropped += buffer->dropped;
+        buffer->events.clear();
+        buffer->events.squeeze();
+    }
+
+    json.append("\n],\"otherData\":{\"droppedEvents\":");
+    json.append(QByteArray::number(dropped));
+    json.append("}}\n");
+
+    return json;
+}
+
+bool QGCTrace::stop(const QString& fileName)
+{
+    QByteArray json = stop();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    return file.write(json) == json.length();
+}
+
+void QGCTrace::setThreadName(const QString& name)
+{
+    ThreadBuffer_t* buffer = _currentThreadBuffer();
+    QMutexLocker bufferLock(&buffer->mutex);
+    buffer->name = name;
+}
+
+qint64 QGCTrace::nowUsecs(void)
+{
+    return _clock.nsecsElapsed() / 1000;
+}
+
+void QGCTrace::addEvent(const char* category, const char* name, qint64 startUsecs, qint64 durationUsecs, const char* argName, qint64 argValue)
+{
+    ThreadBuffer_t* buffer = _currentThreadBuffer();
+    QMutexLocker bufferLock(&buffer->mutex);
+    if (buffer->events.count() >= maxThreadEvents) {
+        buffer->dropped++;
+        return;
+    }
+    buffer->events.append(Event_t{category, name, argName, argValue, startUsecs, durationUsecs});
+}
@@ -0,0 +1,99 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+#include <atomic>
+
+/// Scoped trace events, to see where time goes across the link, video, tile cache, joystick and GUI threads. While
+/// tracing runs each thread collects its events in its own buffer. Stopping writes them as a Chrome trace event JSON
+/// file, which chrome://tracing and ui.perfetto.dev open.
+///
+/// Trace points cost a relaxed atomic load while tracing is off. Define QGC_TRACE_DISABLED to compile them out.
+///
+/// Category, name and argument name must be string literals, only the pointers are kept.
+class QGCTrace
+{
+public:
+    static bool enabled(void) { return _enabled.load(std::memory_order_relaxed); }
+
+    /// Starts collecting events, anything collected before is dropped
+    static void start   (void);
+    /// Stops collecting events
+    /// @return Events collected since start as Chrome trace event JSON
+    static QByteArray stop(void);
+    /// Stops collecting events and writes them to fileName
+    /// @return false: the file couldn't be written
+    static bool stop    (const QString& fileName);
+
+    /// Names the calling thread in the trace. Defaults to the QThread object name.
+    static void setThreadName(const QString& name);
+
+    /// @return usecs since start
+    static qint64 nowUsecs(void);
+
+    /// @param argName nullptr for no argument
+    static void addEvent(const char* category, const char* name, qint64 startUsecs, qint64 durationUsecs, const char* argName = nullptr, qint64 argValue = 0);
+
+    /// Events kept per thread, later ones are counted as dropped
+    static const int maxThreadEvents = 256 * 1024;
+
+private:
+    static std::atomic<bool> _enabled;
+};
+
+/// Adds a complete event covering its lifetime. Use through QGC_TRACE_SCOPE.
+class QGCTraceScope
+{
+public:
+    QGCTraceScope(const char* category, const char* name, const char* argName = nullptr, qint64 argValue = 0)
+        : _category (category)
+        , _name     (name)
+        , _argName  (argName)
+        , _argValue (argValue)
+        , _start    (QGCTrace::enabled() ? QGCTrace::nowUsecs() : -1)
+    {
+    }
+
+    ~QGCTraceScope()
+    {
+        if (_start >= 0 && QGCTrace::enabled()) {
+            QGCTrace::addEvent(_category, _name, _start, QGCTrace::nowUsecs() - _start, _argName, _argValue);
+        }
+    }
+
+private:
+    const char* _category;
+    const char* _name;
+    const char* _argName;
+    qint64      _argValue;
+    qint64      _start;
+
+    Q_DISABLE_COPY(QGCTraceScope)
+};
+
+#define QGC_TRACE_CONCAT_(a, b) a ## b
+#define QGC_TRACE_CONCAT(a, b)  QGC_TRACE_CONCAT_(a, b)
+
+/// @def QGC_TRACE_SCOPE
+/// Traces the rest of the enclosing scope: QGC_TRACE_SCOPE("Category", "name")
+/// @def QGC_TRACE_SCOPE_ARG
+/// Same with a single integer argument shown with the event: QGC_TRACE_SCOPE_ARG("Category", "name", "argName", value)
+#if defined(QGC_TRACE_DISABLED)
+#define QGC_TRACE_SCOPE(category, name)
+#define QGC_TRACE_SCOPE_ARG(category, name, argName, argValue)
+#else
+#define QGC_TRACE_SCOPE(category, name) \
+    QGCTraceScope QGC_TRACE_CONCAT(qgcTraceScope, __LINE__)(category, name)
+#define QGC_TRACE_SCOPE_ARG(category, name, argName, argValue) \
+    QGCTraceScope QGC_TRACE_CONCAT(qgcTraceScope, __LINE__)(category, name, argName, static_cast<qint64>(argValue))
+#endif
@@ -10,6 +10,7 @@
 #include "QGCZlib.h"
 
 #include <QFile>
+#include <QBuffer>
 #include <QDir>
 #include <QtDebug>
 
@@ -17,13 +18,6 @@
 
 bool QGCZlib::inflateGzipFile(const QString& gzippedFileName, const QString& decompressedFilename)
 {
-    bool            success                 = true;
-    int             ret;
-    const int       cBuffer                 = 1024 * 5;
-    unsigned char   inputBuffer[cBuffer];
-    unsigned char   outputBuffer[cBuffer];
-    z_stream        strm;
-
     QFile inputFile(gzippedFileName);
     if (!inputFile.open(QIODevice::ReadOnly)) {
         qWarning() << "QGCZlib::inflateGzipFile: open input file failed" << gzippedFileName << inputFile.errorString();
@@ -36,6 +30,36 @@ bool QGCZlib::inflateGzipFile(const QString& gzippedFileName, const QString& dec
         return false;
     }
 
+    return inflateGzip(inputFile, outputFile);
+}
+
+bool QGCZlib::inflateGzipData(const QByteArray& gzippedData, QByteArray& decompressedData)
+{
+    QByteArray  inputData(gzippedData);
+    QBuffer     input(&inputData);
+    QBuffer     output(&decompressedData);
+
+    decompressedData.clear();
+    input.open(QIODevice::ReadOnly);
+    output.open(QIODevice::WriteOnly);
+
+    return inflateGzip(input, output);
+}
+
+bool QGCZlib::isGzipData(const QByteArray& data)
+{
+    return data.size() >= 2 && static_cast<uchar>(data[0]) == 0x1f && static_cast<uchar>(data[1]) == 0x8b;
+}
+
+bool QGCZlib::inflateGzip(QIODevice& input, QIODevice& output)
+{
+    bool            success                 = true;
+    int             ret;
+    const int       cBuffer                 = 1024 * 5;
+    unsigned char   inputBuffer[cBuffer];
+    unsigned char   outputBuffer[cBuffer];
+    z_stream        strm;
+
     strm.zalloc     = nullptr;
     strm.zfree      = nullptr;
     strm.opaque     = nullptr;
@@ -44,16 +68,17 @@ bool QGCZlib::inflateGzipFile(const QString& gzippedFileName, const QString& dec
 
     ret = inflateInit2(&strm, 16+MAX_WBITS);
     if (ret != Z_OK) {
-        qWarning() << "QGCZlib::inflateGzipFile: inflateInit2 failed:" << ret;
-        goto Error;
+        qWarning() << "QGCZlib::inflateGzip: inflateInit2 failed:" << ret;
+        return false;
     }
 
     do {
-        strm.avail_in = static_cast<unsigned>(inputFile.read((char*)inputBuffer, cBuffer));
-        if (strm.avail_in == 0) {
+        qint64 cBytesRead = input.read((char*)inputBuffer, cBuffer);
+        if (cBytesRead <= 0) {
             break;
         }
-        strm.next_in = inputBuffer;
+        strm.avail_in   = static_cast<unsigned>(cBytesRead);
+        strm.next_in    = inputBuffer;
 
         do {
             strm.avail_out  = cBuffer;
@@ -61,20 +86,25 @@ bool QGCZlib::inflateGzipFile(const QString& gzippedFileName, const QString& dec
 
             ret = inflate(&strm, Z_NO_FLUSH);
             if (ret != Z_OK && ret != Z_STREAM_END) {
-                qWarning() << "QGCZlib::inflateGzipFile: inflate failed:" << ret;
+                qWarning() << "QGCZlib::inflateGzip: inflate failed:" << ret;
                 goto Error;
             }
 
             unsigned cBytesInflated = cBuffer - strm.avail_out;
-            qint64 cBytesWritten = outputFile.write((char*)outputBuffer, static_cast<int>(cBytesInflated));
+            qint64 cBytesWritten = output.write((char*)outputBuffer, static_cast<int>(cBytesInflated));
             if (cBytesWritten != cBytesInflated) {
-                qWarning() << "QGCZlib::inflateGzipFile: output file write failed:" << outputFile.fileName() << outputFile.errorString();
+                qWarning() << "QGCZlib::inflateGzip: output write failed:" << output.errorString();
                 goto Error;
 
             }
         } while (strm.avail_out == 0);
     } while (ret != Z_STREAM_END);
 
+    if (ret != Z_STREAM_END) {
+        qWarning() << "QGCZlib::inflateGzip: input ended before end of gzip stream";
+        goto Error;
+    }
+
 Out:
     inflateEnd(&strm);
     return success;
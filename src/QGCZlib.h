@@ -10,6 +10,9 @@
 #pragma once
 
 #include <QString>
+#include <QByteArray>
+
+class QIODevice;
 
 class QGCZlib
 {
@@ -18,4 +21,17 @@ public:
     ///     @param gzipFilename         Fully qualified path to gzip file
     ///     @param decompressedFilename Fully qualified path to for file to decompress to
     static bool inflateGzipFile(const QString& gzippedFileName, const QString& decompressedFilename);
+
+    /// Decompresses gzip data from one device to another as it is read, without buffering the whole payload
+    ///     @param input    Open device to read the gzip data from
+    ///     @param output   Open device to write the decompressed data to
+    static bool inflateGzip(QIODevice& input, QIODevice& output);
+
+    /// Decompresses gzip data in memory
+    ///     @param gzippedData      gzip data
+    ///     @param decompressedData Returned decompressed data
+    static bool inflateGzipData(const QByteArray& gzippedData, QByteArray& decompressedData);
+
+    /// @return true: data starts with the gzip magic bytes
+    static bool isGzipData(const QByteArray& data);
 };
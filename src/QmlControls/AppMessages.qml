@@ -128,7 +128,7 @@ Item {
 
             QGCButton {
                 id:                     followTail
-                anchors.right:          filterButton.left
+                anchors.right:          traceButton.visible ? traceButton.left : filterButton.left
                 anchors.rightMargin:    ScreenTools.defaultFontPixelWidth
                 anchors.bottom:         parent.bottom
                 text:                   qsTr("Show Latest")
@@ -142,6 +142,24 @@ Item {
                 }
             }
 
+            QGCButton {
+                id:                     traceButton
+                anchors.right:          filterButton.left
+                anchors.rightMargin:    ScreenTools.defaultFontPixelWidth
+                anchors.bottom:         parent.bottom
+                text:                   QGroundControl.tracing ? qsTr("Stop Trace") : qsTr("Start Trace")
+                visible:                QGroundControl.traceAvailable
+
+                onClicked: {
+                    if (QGroundControl.tracing) {
+                        var traceFile = QGroundControl.stopTrace()
+                        mainWindow.showMessageDialog(qsTr("Trace"), traceFile ? qsTr("Trace written to %1").arg(traceFile) : qsTr("Unable to write the trace file"))
+                    } else {
+                        QGroundControl.startTrace()
+                    }
+                }
+            }
+
             QGCButton {
                 id:             filterButton
                 anchors.bottom: parent.bottom
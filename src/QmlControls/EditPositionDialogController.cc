@@ -31,7 +31,7 @@ EditPositionDialogController::EditPositionDialogController(void)
     , _mgrsFact         (0, _mgrsFactName,          FactMetaData::valueTypeString)
 {
     if (_metaDataMap.isEmpty()) {
-        _metaDataMap = FactMetaData::createMapFromJsonFile(QStringLiteral(":/json/EditPositionDialog.FactMetaData.json"), nullptr /* QObject parent */);
+        _metaDataMap = FactMetaData::sharedMapFromJsonFile(QStringLiteral(":/json/EditPositionDialog.FactMetaData.json"));
     }
 
     _latitudeFact.setMetaData   (_metaDataMap[_latitudeFactName]);
@@ -23,6 +23,7 @@ const char* FactValueGrid::_factGroupNameKey    = "factGroupName";
 const char* FactValueGrid::_factNameKey         = "factName";
 const char* FactValueGrid::_textKey             = "text";
 const char* FactValueGrid::_showUnitsKey        = "showUnits";
+const char* FactValueGrid::_showSparklineKey    = "showSparkline";
 const char* FactValueGrid::_iconKey             = "icon";
 const char* FactValueGrid::_rangeTypeKey        = "rangeType";
 const char* FactValueGrid::_rangeValuesKey      = "rangeValues";
@@ -68,6 +69,9 @@ void FactValueGrid::_init(void)
 
     connect(offlineVehicle, &Vehicle::vehicleTypeChanged,       this, &FactValueGrid::_offlineVehicleTypeChanged);
     connect(this,           &FactValueGrid::fontSizeChanged,    this, &FactValueGrid::_saveSettings);
+    connect(&_displayTimer, &QTimer::timeout,                   this, &FactValueGrid::displayTick);
+
+    _displayTimer.setInterval(displayIntervalMsecs);
 
     _vehicleClass = QGCMAVLink::vehicleClass(offlineVehicle->vehicleType());
 }
@@ -89,6 +93,9 @@ void FactValueGrid::componentComplete(void)
 
     // We should know settingsGroup/defaultSettingsGroup now so we can load settings
     _loadSettings();
+
+    // Only grids which are shown need to update their values
+    _displayTimer.start();
 }
 
 void FactValueGrid::resetToDefaults(void)
@@ -113,10 +120,11 @@ void FactValueGrid::setFontSize(FontSize fontSize)
 
 void FactValueGrid::_saveValueData(QSettings& settings, InstrumentValueData* value)
 {
-    settings.setValue(_textKey,         value->text());
-    settings.setValue(_showUnitsKey,    value->showUnits());
-    settings.setValue(_iconKey,         value->icon());
-    settings.setValue(_rangeTypeKey,    value->rangeType());
+    settings.setValue(_textKey,             value->text());
+    settings.setValue(_showUnitsKey,        value->showUnits());
+    settings.setValue(_showSparklineKey,    value->showSparkline());
+    settings.setValue(_iconKey,             value->icon());
+    settings.setValue(_rangeTypeKey,        value->rangeType());
 
     if (value->rangeType() != InstrumentValueData::NoRangeInfo) {
         settings.setValue(_rangeValuesKey, value->rangeValues());
@@ -152,10 +160,11 @@ void FactValueGrid::_loadValueData(QSettings& settings, InstrumentValueData* val
         value->setFact(settings.value(_factGroupNameKey).toString(), factName);
     }
 
-    value->setText      (settings.value(_textKey).toString());
-    value->setShowUnits (settings.value(_showUnitsKey, true).toBool());
-    value->setIcon      (settings.value(_iconKey).toString());
-    value->setRangeType (settings.value(_rangeTypeKey, InstrumentValueData::NoRangeInfo).value<InstrumentValueData::RangeType>());
+    value->setText          (settings.value(_textKey).toString());
+    value->setShowUnits     (settings.value(_showUnitsKey, true).toBool());
+    value->setShowSparkline (settings.value(_showSparklineKey, false).toBool());
+    value->setIcon          (settings.value(_iconKey).toString());
+    value->setRangeType     (settings.value(_rangeTypeKey, InstrumentValueData::NoRangeInfo).value<InstrumentValueData::RangeType>());
 
     if (value->rangeType() != InstrumentValueData::NoRangeInfo) {
         value->setRangeValues(settings.value(_rangeValuesKey).value<QVariantList>());
@@ -181,6 +190,7 @@ void FactValueGrid::_connectSaveSignals(InstrumentValueData* value)
     connect(value, &InstrumentValueData::factGroupNameChanged,  this, &FactValueGrid::_saveSettings);
     connect(value, &InstrumentValueData::textChanged,           this, &FactValueGrid::_saveSettings);
     connect(value, &InstrumentValueData::showUnitsChanged,      this, &FactValueGrid::_saveSettings);
+    connect(value, &InstrumentValueData::showSparklineChanged,  this, &FactValueGrid::_saveSettings);
     connect(value, &InstrumentValueData::iconChanged,           this, &FactValueGrid::_saveSettings);
     connect(value, &InstrumentValueData::rangeTypeChanged,      this, &FactValueGrid::_saveSettings);
     connect(value, &InstrumentValueData::rangeValuesChanged,    this, &FactValueGrid::_saveSettings);
@@ -15,6 +15,7 @@
 
 #include <QGridLayout>
 #include <QSettings>
+#include <QTimer>
 
 class InstrumentValueData;
 
@@ -65,6 +66,8 @@ public:
 
     void setFontSize(FontSize fontSize);
 
+    static const int displayIntervalMsecs = 200;    ///< Values are displayed at this rate, not at the rate they come in
+
     // This is only exposed for usage of FactValueGrid to be able to just read the settings and display no ui. For this case
     // create a FactValueGrid object with a null parent. Set the userSettingsGroup/defaultSettingsGroup appropriately and then
     // call _loadSettings. Then after that you can read the settings from the object. You should not change any of the values.
@@ -80,6 +83,7 @@ signals:
     void fontSizeChanged            (FontSize fontSize);
     void columnsChanged             (QmlObjectListModel* model);
     void rowCountChanged            (int rowCount);
+    void displayTick                (void);
 
 protected:
     Q_DISABLE_COPY(FactValueGrid)
@@ -91,6 +95,7 @@ protected:
     bool                        _preventSaveSettings    = false;
     QmlObjectListModel*         _columns                = nullptr;
     int                         _rowCount               = 0;
+    QTimer                      _displayTimer;
 
 private slots:
     void _offlineVehicleTypeChanged(void);
@@ -117,6 +122,7 @@ private:
     static const char* _factNameKey;
     static const char* _textKey;
     static const char* _showUnitsKey;
+    static const char* _showSparklineKey;
     static const char* _iconKey;
     static const char* _rangeTypeKey;
     static const char* _rangeValuesKey;
@@ -10,8 +10,15 @@
 #include "FlightPathSegment.h"
 #include "QGC.h"
 
+#include <QPointer>
+
+#include <limits>
+
 QGC_LOGGING_CATEGORY(FlightPathSegmentLog, "FlightPathSegmentLog")
 
+// Segments which need their terrain collision updated on the next pass
+static QList<QPointer<FlightPathSegment>> _terrainCollisionQueue;
+
 FlightPathSegment::FlightPathSegment(const QGeoCoordinate& coord1, double amslCoord1Alt, const QGeoCoordinate& coord2, double amslCoord2Alt, bool queryTerrainData, QObject* parent)
     : QObject           (parent)
     , _coord1           (coord1)
@@ -55,7 +62,7 @@ void FlightPathSegment::setCoord1AMSLAlt(double alt)
     if (!QGC::fuzzyCompare(alt, _coord1AMSLAlt)) {
         _coord1AMSLAlt = alt;
         emit coord1AMSLAltChanged();
-        _updateTerrainCollision();
+        _queueTerrainCollision();
     }
 }
 
@@ -64,7 +71,7 @@ void FlightPathSegment::setCoord2AMSLAlt(double alt)
     if (!QGC::fuzzyCompare(alt, _coord2AMSLAlt)) {
         _coord2AMSLAlt = alt;
         emit coord2AMSLAltChanged();
-        _updateTerrainCollision();
+        _queueTerrainCollision();
     }
 }
 
@@ -87,8 +94,18 @@ void FlightPathSegment::_sendTerrainPathQuery(void)
             _currentTerrainPathQuery = nullptr;
         }
 
+        // Legs which didn't change since the segments were last rebuilt were queried before
+        TerrainPathQuery::PathHeightInfo_t pathHeightInfo;
+        if (TerrainPathQuery::getCachedPathHeights(_coord1, _coord2, pathHeightInfo)) {
+            qCDebug(FlightPathSegmentLog) << this << "_sendTerrainPathQuery cached" << pathHeightInfo.heights.count();
+            _applyPathHeights(pathHeightInfo);
+            _queueTerrainCollision();
+            return;
+        }
+
         // Clear old terrain data
         _amslTerrainHeights.clear();
+        _terrainHeights.clear();
         _distanceBetween = 0;
         _finalDistanceBetween = 0;
         emit distanceBetweenChanged(0);
@@ -105,26 +122,32 @@ void FlightPathSegment::_terrainDataReceived(bool success, const TerrainPathQuer
 {
     qCDebug(FlightPathSegmentLog) << this << "_terrainDataReceived" << success << pathHeightInfo.heights.count();
     if (success) {
-        if (!QGC::fuzzyCompare(pathHeightInfo.distanceBetween, _distanceBetween)) {
-            _distanceBetween = pathHeightInfo.distanceBetween;
-            emit distanceBetweenChanged(_distanceBetween);
-        }
-        if (!QGC::fuzzyCompare(pathHeightInfo.finalDistanceBetween, _finalDistanceBetween)) {
-            _finalDistanceBetween = pathHeightInfo.finalDistanceBetween;
-            emit finalDistanceBetweenChanged(_finalDistanceBetween);
-        }
-
-        _amslTerrainHeights.clear();
-        for (const double& amslTerrainHeight: pathHeightInfo.heights) {
-            _amslTerrainHeights.append(amslTerrainHeight);
-        }
-        emit amslTerrainHeightsChanged();
+        _applyPathHeights(pathHeightInfo);
     }
 
     _currentTerrainPathQuery->deleteLater();
     _currentTerrainPathQuery = nullptr;
 
-    _updateTerrainCollision();
+    _queueTerrainCollision();
+}
+
+void FlightPathSegment::_applyPathHeights(const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo)
+{
+    if (!QGC::fuzzyCompare(pathHeightInfo.distanceBetween, _distanceBetween)) {
+        _distanceBetween = pathHeightInfo.distanceBetween;
+        emit distanceBetweenChanged(_distanceBetween);
+    }
+    if (!QGC::fuzzyCompare(pathHeightInfo.finalDistanceBetween, _finalDistanceBetween)) {
+        _finalDistanceBetween = pathHeightInfo.finalDistanceBetween;
+        emit finalDistanceBetweenChanged(_finalDistanceBetween);
+    }
+
+    _amslTerrainHeights.clear();
+    _terrainHeights = pathHeightInfo.heights.toVector();
+    for (const double& amslTerrainHeight: pathHeightInfo.heights) {
+        _amslTerrainHeights.append(amslTerrainHeight);
+    }
+    emit amslTerrainHeightsChanged();
 }
 
 void FlightPathSegment::_updateTotalDistance(void)
@@ -140,25 +163,61 @@ void FlightPathSegment::_updateTotalDistance(void)
     }
 }
 
-void FlightPathSegment::_updateTerrainCollision(void)
+void FlightPathSegment::_queueTerrainCollision(void)
 {
-    double slope =      (_coord2AMSLAlt - _coord1AMSLAlt) / _totalDistance;
-    double yIntercept = _coord1AMSLAlt;
-
-    bool newTerrainCollision = false;
-    double x = 0;
-    for (int i=0; i<_amslTerrainHeights.count(); i++) {
-        double y = _amslTerrainHeights[i].value<double>();
-        if (y > (slope * x) + yIntercept) {
-            newTerrainCollision = true;
-            break;
+    // Both altitudes and the terrain heights tend to change together, check them all in one pass after that
+    if (!_terrainCollisionQueued) {
+        _terrainCollisionQueued = true;
+        if (_terrainCollisionQueue.isEmpty()) {
+            QTimer::singleShot(0, &FlightPathSegment::_updateQueuedTerrainCollisions);
         }
-        if (i == _amslTerrainHeights.count() - 2) {
-            x += _finalDistanceBetween;
-        } else {
-            x += _distanceBetween;
+        _terrainCollisionQueue.append(this);
+    }
+}
+
+void FlightPathSegment::_updateQueuedTerrainCollisions(void)
+{
+    QList<QPointer<FlightPathSegment>> segments;
+    segments.swap(_terrainCollisionQueue);
+
+    qCDebug(FlightPathSegmentLog) << "_updateQueuedTerrainCollisions count" << segments.count();
+
+    for (const QPointer<FlightPathSegment>& segment: segments) {
+        if (segment) {
+            segment->_terrainCollisionQueued = false;
+            segment->_updateTerrainCollision();
         }
     }
+}
+
+bool FlightPathSegment::pathCollides(const double* amslTerrainHeights, int count, double distanceBetween, double finalDistanceBetween, double totalDistance, double coord1AMSLAlt, double coord2AMSLAlt)
+{
+    if (count <= 0) {
+        return false;
+    }
+
+    double slope =      (coord2AMSLAlt - coord1AMSLAlt) / totalDistance;
+    double yIntercept = coord1AMSLAlt;
+
+    // All heights but the last are evenly spaced. A NaN never compares greater, so it doesn't collide.
+    double maxAbovePath = -std::numeric_limits<double>::infinity();
+    int evenCount = count == 1 ? 1 : count - 1;
+    for (int i=0; i<evenCount; i++) {
+        double abovePath = amslTerrainHeights[i] - ((slope * (i * distanceBetween)) + yIntercept);
+        maxAbovePath = abovePath > maxAbovePath ? abovePath : maxAbovePath;
+    }
+    if (count > 1) {
+        double x = ((count - 2) * distanceBetween) + finalDistanceBetween;
+        double abovePath = amslTerrainHeights[count - 1] - ((slope * x) + yIntercept);
+        maxAbovePath = abovePath > maxAbovePath ? abovePath : maxAbovePath;
+    }
+
+    return maxAbovePath > 0;
+}
+
+void FlightPathSegment::_updateTerrainCollision(void)
+{
+    bool newTerrainCollision = pathCollides(_terrainHeights.constData(), _terrainHeights.count(), _distanceBetween, _finalDistanceBetween, _totalDistance, _coord1AMSLAlt, _coord2AMSLAlt);
 
     qCDebug(FlightPathSegmentLog) << this << "_updateTerrainCollision new:old" << newTerrainCollision << _terrainCollision;
 
@@ -12,6 +12,7 @@
 #include <QObject>
 #include <QGeoCoordinate>
 #include <QTimer>
+#include <QVector>
 
 #include "TerrainQuery.h"
 #include "QGCLoggingCategory.h"
@@ -50,6 +51,11 @@ public:
 
     void setSpecialVisual(bool specialVisual);
 
+    /// Checks whether terrain rises above the straight line between the two altitudes. Heights are spaced as in
+    /// TerrainPathQuery::PathHeightInfo_t. Written as a branch free max reduction the compiler can vectorize.
+    /// @return true: the path collides with terrain
+    static bool pathCollides(const double* amslTerrainHeights, int count, double distanceBetween, double finalDistanceBetween, double totalDistance, double coord1AMSLAlt, double coord2AMSLAlt);
+
 public slots:
     void setCoordinate1     (const QGeoCoordinate& coordinate);
     void setCoordinate2     (const QGeoCoordinate& coordinate);
@@ -75,6 +81,11 @@ private slots:
     void _updateTerrainCollision    (void);
 
 private:
+    void _applyPathHeights          (const TerrainPathQuery::PathHeightInfo_t& pathHeightInfo);
+    void _queueTerrainCollision     (void);
+
+    static void _updateQueuedTerrainCollisions(void);
+
     QGeoCoordinate      _coord1;
     QGeoCoordinate      _coord2;
     double              _coord1AMSLAlt =                qQNaN();
@@ -85,6 +96,8 @@ private:
     QTimer              _delayedTerrainPathQueryTimer;
     TerrainPathQuery*   _currentTerrainPathQuery =      nullptr;
     QVariantList        _amslTerrainHeights;
+    QVector<double>     _terrainHeights;                                ///< _amslTerrainHeights as doubles for the collision check
+    bool                _terrainCollisionQueued =       false;
     double              _distanceBetween =              0;
     double              _finalDistanceBetween =         0;
     double              _totalDistance =                0;
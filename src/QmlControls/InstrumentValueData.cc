@@ -11,8 +11,12 @@
 #include "FactValueGrid.h"
 #include "QGCApplication.h"
 #include "QGCCorePlugin.h"
+#include "FactHistory.h"
 
 #include <QSettings>
+#include <QDateTime>
+
+#include <cmath>
 
 const char*  InstrumentValueData::vehicleFactGroupName =   "Vehicle";
 
@@ -38,6 +42,19 @@ InstrumentValueData::InstrumentValueData(FactValueGrid* factValueGrid, QObject*
     connect(this, &InstrumentValueData::rangeColorsChanged,     this, &InstrumentValueData::_updateRanges);
     connect(this, &InstrumentValueData::rangeOpacitiesChanged,  this, &InstrumentValueData::_updateRanges);
     connect(this, &InstrumentValueData::rangeIconsChanged,      this, &InstrumentValueData::_updateRanges);
+
+    if (_factValueGrid) {
+        connect(_factValueGrid, &FactValueGrid::displayTick, this, &InstrumentValueData::updateDisplay);
+    }
+
+    _updateValueText(true /* force */);
+}
+
+InstrumentValueData::~InstrumentValueData()
+{
+    if (_historyFact) {
+        _historyFact->releaseHistory();
+    }
 }
 
 void InstrumentValueData::_activeVehicleChanged(Vehicle* activeVehicle)
@@ -71,11 +88,15 @@ void InstrumentValueData::_lookForMissingFact(void)
 
 void InstrumentValueData::clearFact(void)
 {
+    if (_fact) {
+        disconnect(_fact, &Fact::rawValueChanged, this, &InstrumentValueData::_factRawValueChanged);
+    }
     _fact = nullptr;
     _factName.clear();
     _text.clear();
     _icon.clear();
     _showUnits = true;
+    _showSparkline = false;
 
     emit factValueNamesChanged  ();
     emit factChanged            (_fact);
@@ -84,12 +105,18 @@ void InstrumentValueData::clearFact(void)
     emit textChanged            (_text);
     emit iconChanged            (_icon);
     emit showUnitsChanged       (_showUnits);
+    emit showSparklineChanged   (_showSparkline);
+
+    _valueDirty = false;
+    _updateRanges();
+    _updateValueText(true /* force */);
+    _updateHistory();
 }
 
 void InstrumentValueData::_setFactWorker(void)
 {
     if (_fact) {
-        disconnect(_fact, &Fact::rawValueChanged, this, &InstrumentValueData::_updateRanges);
+        disconnect(_fact, &Fact::rawValueChanged, this, &InstrumentValueData::_factRawValueChanged);
         _fact = nullptr;
     }
 
@@ -112,7 +139,7 @@ void InstrumentValueData::_setFactWorker(void)
 
     if (_fact) {
         _factName = nonEmptyFactName;
-        connect(_fact, &Fact::rawValueChanged, this, &InstrumentValueData::_updateRanges);
+        connect(_fact, &Fact::rawValueChanged, this, &InstrumentValueData::_factRawValueChanged);
     }
 
     emit factValueNamesChanged  ();
@@ -120,8 +147,12 @@ void InstrumentValueData::_setFactWorker(void)
     emit factNameChanged        (_factName);
     emit factGroupNameChanged   (_factGroupName);
 
+    _valueDirty = false;
     _updateRanges();
+    _updateValueText(true /* force */);
+    _updateHistory();
 }
+
 void InstrumentValueData::setFact(const QString& factGroupName, const QString& factName)
 {
     _factGroupName  = factGroupName;
@@ -143,6 +174,16 @@ void InstrumentValueData::setShowUnits(bool showUnits)
     if (showUnits != _showUnits) {
         _showUnits = showUnits;
         emit showUnitsChanged(showUnits);
+        _updateValueText(true /* force */);
+    }
+}
+
+void InstrumentValueData::setShowSparkline(bool showSparkline)
+{
+    if (showSparkline != _showSparkline) {
+        _showSparkline = showSparkline;
+        emit showSparklineChanged(showSparkline);
+        _updateHistory();
     }
 }
 
@@ -334,6 +375,105 @@ void InstrumentValueData::_updateIcon(void)
     }
 }
 
+void InstrumentValueData::_factRawValueChanged(void)
+{
+    // Vehicle values can change with every message, the work is done on the next display tick instead
+    _valueDirty = true;
+}
+
+void InstrumentValueData::updateDisplay(void)
+{
+    const bool valueChanged = _valueDirty;
+
+    if (_valueDirty) {
+        _valueDirty = false;
+        _updateRanges();
+        _updateValueText(false /* force */);
+    }
+    if (_historyFact && (valueChanged || QDateTime::currentMSecsSinceEpoch() - _sparklineMSecs >= _sparklineScrollMSecs)) {
+        _updateSparkline();
+    }
+}
+
+void InstrumentValueData::_updateHistory(void)
+{
+    // The history lives with the Fact, this only keeps it around while the sparkline is shown
+    Fact* fact = _showSparkline ? _fact : nullptr;
+    if (fact != _historyFact.data()) {
+        if (_historyFact) {
+            _historyFact->releaseHistory();
+        }
+        _historyFact = fact;
+        if (_historyFact) {
+            _historyFact->retainHistory();
+        }
+    }
+    _updateSparkline();
+}
+
+void InstrumentValueData::_updateSparkline(void)
+{
+    QVariantList    sparkline;
+    double          trend = 0;
+
+    if (_historyFact && _historyFact->history()) {
+        sparkline = _historyFact->historyPoints(_sparklineSeconds, _sparklinePoints);
+        if (!_historyFact->history()->trend(_sparklineSeconds * 1000, trend)) {
+            trend = 0;
+        }
+    }
+
+    _sparklineMSecs = QDateTime::currentMSecsSinceEpoch();
+    if (sparkline != _sparkline || !QGC::fuzzyCompare(trend, _trend)) {
+        _sparkline  = sparkline;
+        _trend      = trend;
+        emit sparklineChanged();
+    }
+}
+
+QVariant InstrumentValueData::displayedValueKey(double value, int decimalPlaces)
+{
+    if (qIsNaN(value)) {
+        return QVariant();
+    }
+
+    const double scaled = value * std::pow(10.0, decimalPlaces);
+    const double rounded = std::floor(scaled + 0.5);
+
+    // Rounding in binary may not match the decimal formatting right at a boundary, nor once the scaled value runs out of precision
+    if (qAbs(scaled - rounded) > 0.499 || qAbs(scaled) > 1e15) {
+        return QVariant(value);
+    }
+    return QVariant(rounded);
+}
+
+void InstrumentValueData::_updateValueText(bool force)
+{
+    QString newValueText;
+
+    if (_fact) {
+        QVariant key;
+        if (!_fact->enumStrings().count() && (_fact->type() == FactMetaData::valueTypeFloat || _fact->type() == FactMetaData::valueTypeDouble)) {
+            key = displayedValueKey(_fact->cookedValue().toDouble(), _fact->decimalPlaces());
+        } else {
+            key = _fact->rawValue();
+        }
+        if (!force && key == _valueTextKey) {
+            return;
+        }
+        _valueTextKey = key;
+        newValueText = _fact->enumOrValueString() + (_showUnits ? QStringLiteral(" ") + _fact->cookedUnits() : QString());
+    } else {
+        _valueTextKey.clear();
+        newValueText = QStringLiteral("--.--");
+    }
+
+    if (newValueText != _valueText) {
+        _valueText = newValueText;
+        emit valueTextChanged(_valueText);
+    }
+}
+
 int InstrumentValueData::_currentRangeIndex(const QVariant& value)
 {
     if (qIsNaN(value.toDouble())) {
@@ -14,6 +14,7 @@
 #include "QGCApplication.h"
 
 #include <QObject>
+#include <QPointer>
 
 class FactValueGrid;
 
@@ -31,6 +32,7 @@ public:
     Q_ENUMS(RangeType)
 
     explicit InstrumentValueData(FactValueGrid* factValueGrid, QObject* parent);
+    ~InstrumentValueData();
 
     Q_PROPERTY(FactValueGrid*       factValueGrid       MEMBER _factValueGrid                               CONSTANT)
     Q_PROPERTY(QStringList          factGroupNames      READ    factGroupNames                              NOTIFY factGroupNamesChanged)
@@ -41,6 +43,7 @@ public:
     Q_PROPERTY(QString              text                READ    text                WRITE setText           NOTIFY textChanged)
     Q_PROPERTY(QString              icon                READ    icon                WRITE setIcon           NOTIFY iconChanged)             ///< If !isEmpty icon will be show instead of label
     Q_PROPERTY(bool                 showUnits           READ    showUnits           WRITE setShowUnits      NOTIFY showUnitsChanged)
+    Q_PROPERTY(bool                 showSparkline       READ    showSparkline       WRITE setShowSparkline  NOTIFY showSparklineChanged)
     Q_PROPERTY(QStringList          rangeTypeNames      MEMBER _rangeTypeNames                              CONSTANT)
     Q_PROPERTY(RangeType            rangeType           READ    rangeType           WRITE setRangeType      NOTIFY rangeTypeChanged)
     Q_PROPERTY(QVariantList         rangeValues         READ    rangeValues         WRITE setRangeValues    NOTIFY rangeValuesChanged)
@@ -50,6 +53,10 @@ public:
     Q_PROPERTY(QColor               currentColor        MEMBER _currentColor                                NOTIFY currentColorChanged)
     Q_PROPERTY(double               currentOpacity      MEMBER _currentOpacity                              NOTIFY currentOpacityChanged)
     Q_PROPERTY(QString              currentIcon         MEMBER _currentIcon                                 NOTIFY currentIconChanged)
+    Q_PROPERTY(QString              valueText           READ    valueText                                   NOTIFY valueTextChanged)        ///< Formatted fact value, follows the display tick of the grid
+    Q_PROPERTY(QVariantList         sparkline           READ    sparkline                                   NOTIFY sparklineChanged)        ///< Points of seconds relative to now and cooked value over the last sparklineSeconds
+    Q_PROPERTY(double               trend               READ    trend                                       NOTIFY sparklineChanged)        ///< Change per second over the sparkline, 0 if unknown
+    Q_PROPERTY(int                  sparklineSeconds    READ    sparklineSeconds                            CONSTANT)
 
     Q_INVOKABLE void    setFact         (const QString& factGroupName, const QString& factName);
     Q_INVOKABLE void    clearFact       (void);
@@ -65,14 +72,20 @@ public:
     Fact*           fact                    (void) { return _fact; }
     QString         text                    (void) const { return _text; }
     bool            showUnits               (void) const { return _showUnits; }
+    bool            showSparkline           (void) const { return _showSparkline; }
     QString         icon                    (void) const { return _icon; }
     RangeType       rangeType               (void) const { return _rangeType; }
     QVariantList    rangeValues             (void) const { return _rangeValues; }
     QVariantList    rangeColors             (void) const { return _rangeColors; }
     QVariantList    rangeIcons              (void) const { return _rangeIcons; }
     QVariantList    rangeOpacities          (void) const { return _rangeOpacities; }
+    QString         valueText               (void) const { return _valueText; }
+    QVariantList    sparkline               (void) const { return _sparkline; }
+    double          trend                   (void) const { return _trend; }
+    int             sparklineSeconds        (void) const { return _sparklineSeconds; }
     void            setText                 (const QString& text);
     void            setShowUnits            (bool showUnits);
+    void            setShowSparkline        (bool showSparkline);
     void            setIcon                 (const QString& icon);
     void            setRangeType            (RangeType rangeType);
     void            setRangeValues          (const QVariantList& rangeValues);
@@ -80,6 +93,12 @@ public:
     void            setRangeIcons           (const QVariantList& rangeIcons);
     void            setRangeOpacities       (const QVariantList& rangeOpacities);
 
+    /// Applies the fact value changes since the last display tick
+    void updateDisplay(void);
+
+    /// @return Key which only changes when the given value displays differently with the decimal places. Values
+    ///         close to a rounding boundary return the value itself so those are always formatted.
+    static QVariant displayedValueKey(double value, int decimalPlaces);
 
     static const char*  vehicleFactGroupName;
 
@@ -89,6 +108,7 @@ signals:
     void factGroupNameChanged   (const QString& factGroup);
     void textChanged            (QString text);
     void showUnitsChanged       (bool showUnits);
+    void showSparklineChanged   (bool showSparkline);
     void iconChanged            (const QString& icon);
     void factGroupNamesChanged  (void);
     void factValueNamesChanged  (void);
@@ -100,12 +120,15 @@ signals:
     void currentColorChanged    (const QColor& currentColor);
     void currentOpacityChanged  (double currentOpacity);
     void currentIconChanged     (const QString& currentIcon);
+    void valueTextChanged       (const QString& valueText);
+    void sparklineChanged       (void);
 
 private slots:
     void _resetRangeInfo        (void);
     void _updateRanges          (void);
     void _activeVehicleChanged  (Vehicle* activeVehicle);
     void _lookForMissingFact    (void);
+    void _factRawValueChanged   (void);
 
 private:
     int  _currentRangeIndex     (const QVariant& value);
@@ -113,6 +136,9 @@ private:
     void _updateIcon            (void);
     void _updateOpacity         (void);
     void _setFactWorker         (void);
+    void _updateValueText       (bool force);
+    void _updateHistory         (void);
+    void _updateSparkline       (void);
 
     FactValueGrid*          _factValueGrid =        nullptr;
     Vehicle*                _activeVehicle =        nullptr;
@@ -126,6 +152,14 @@ private:
     QColor                  _currentColor;
     double                  _currentOpacity =       1.0;
     QString                 _currentIcon;
+    QString                 _valueText;
+    QVariant                _valueTextKey;                      ///< displayedValueKey of _valueText
+    bool                    _valueDirty =           false;      ///< Fact value changed since the last display tick
+    bool                    _showSparkline =        false;
+    QPointer<Fact>          _historyFact;                       ///< Fact whose history is retained for the sparkline
+    QVariantList            _sparkline;
+    double                  _trend =                0;
+    qint64                  _sparklineMSecs =       0;          ///< When the sparkline was last updated
 
     // Ranges allow you to specifiy semantics to apply when a value is within a certain range.
     // The limits for each section of the range are specified in _rangeValues. With the first
@@ -144,6 +178,10 @@ private:
     // These are user facing string for the various enums.
     static const QStringList _rangeTypeNames;
 
+    static const int _sparklineSeconds      = 60;
+    static const int _sparklinePoints       = 60;
+    static const int _sparklineScrollMSecs  = 1000;     ///< How often the sparkline moves on while the value doesn't change
+
 };
 
 QML_DECLARE_TYPE(InstrumentValueData)
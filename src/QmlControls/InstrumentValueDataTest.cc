@@ -0,0 +1,119 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "InstrumentValueDataTest.h"
+#include "InstrumentValueData.h"
+#include "HorizontalFactValueGrid.h"
+#include "MultiVehicleManager.h"
+#include "FactHistory.h"
+
+#include <QSignalSpy>
+
+void InstrumentValueDataTest::_displayedValueKeyTest(void)
+{
+    // Same text, same key
+    QCOMPARE(InstrumentValueData::displayedValueKey(10.01, 1), InstrumentValueData::displayedValueKey(10.04, 1));
+    QCOMPARE(InstrumentValueData::displayedValueKey(-3.2, 0),  InstrumentValueData::displayedValueKey(-2.9, 0));
+
+    // Different text
+    QVERIFY(InstrumentValueData::displayedValueKey(10.04, 1) != InstrumentValueData::displayedValueKey(10.06, 1));
+    QVERIFY(InstrumentValueData::displayedValueKey(10.04, 2) != InstrumentValueData::displayedValueKey(10.01, 2));
+
+    // Right at a rounding boundary the value itself is the key
+    QCOMPARE(InstrumentValueData::displayedValueKey(0.25, 1), QVariant(0.25));
+    QVERIFY(InstrumentValueData::displayedValueKey(0.25, 1) != InstrumentValueData::displayedValueKey(0.26, 1));
+
+    QVERIFY(!InstrumentValueData::displayedValueKey(qQNaN(), 1).isValid());
+}
+
+void InstrumentValueDataTest::_displayTickTest(void)
+{
+    HorizontalFactValueGrid grid(QStringLiteral("InstrumentValueDataTest"));
+    InstrumentValueData     value(&grid, nullptr);
+    Fact*                   fact = qgcApp()->toolbox()->multiVehicleManager()->offlineEditingVehicle()->altitudeRelative();
+
+    fact->setRawValue(10.0);
+    value.setShowUnits(false);
+    value.setFact(InstrumentValueData::vehicleFactGroupName, QStringLiteral("AltitudeRelative"));
+    QCOMPARE(value.valueText(), QStringLiteral("10.0"));
+
+    QSignalSpy spyValueText(&value, &InstrumentValueData::valueTextChanged);
+
+    // Nothing happens until the display tick
+    fact->setRawValue(12.0);
+    fact->setRawValue(12.3);
+    QCOMPARE(spyValueText.count(), 0);
+    QCOMPARE(value.valueText(), QStringLiteral("10.0"));
+    emit grid.displayTick();
+    QCOMPARE(spyValueText.count(), 1);
+    QCOMPARE(value.valueText(), QStringLiteral("12.3"));
+
+    // Changes which don't show with the decimal places
+    fact->setRawValue(12.31);
+    emit grid.displayTick();
+    fact->setRawValue(12.29);
+    emit grid.displayTick();
+    QCOMPARE(spyValueText.count(), 1);
+
+    fact->setRawValue(12.4);
+    value.updateDisplay();
+    QCOMPARE(spyValueText.count(), 2);
+    QCOMPARE(value.valueText(), QStringLiteral("12.4"));
+
+    // Units are applied right away
+    value.setShowUnits(true);
+    QCOMPARE(spyValueText.count(), 3);
+    QCOMPARE(value.valueText(), QStringLiteral("12.4 ") + fact->cookedUnits());
+
+    value.clearFact();
+    QCOMPARE(value.valueText(), QStringLiteral("--.--"));
+
+    fact->setRawValue(qQNaN());
+}
+
+void InstrumentValueDataTest::_sparklineTest(void)
+{
+    HorizontalFactValueGrid grid(QStringLiteral("InstrumentValueDataTest"));
+    InstrumentValueData     value(&grid, nullptr);
+    Fact*                   fact = qgcApp()->toolbox()->multiVehicleManager()->offlineEditingVehicle()->altitudeRelative();
+
+    fact->setRawValue(10.0);
+    value.setFact(InstrumentValueData::vehicleFactGroupName, QStringLiteral("AltitudeRelative"));
+    QVERIFY(!fact->history());
+    QVERIFY(value.sparkline().isEmpty());
+
+    // The history is only kept while the sparkline is shown, starting out with the current value
+    QSignalSpy spySparkline(&value, &InstrumentValueData::sparklineChanged);
+    value.setShowSparkline(true);
+    QVERIFY(fact->history());
+    QCOMPARE(fact->history()->count(FactHistory::TierRaw), 1);
+    QCOMPARE(spySparkline.count(), 1);
+    QCOMPARE(value.sparkline().count(), 1);
+    QCOMPARE(value.sparkline()[0].toPointF().y(), 10.0);
+
+    // Views share the history of the Fact
+    InstrumentValueData other(&grid, nullptr);
+    other.setFact(InstrumentValueData::vehicleFactGroupName, QStringLiteral("AltitudeRelative"));
+    other.setShowSparkline(true);
+    other.clearFact();
+    QVERIFY(fact->history());
+
+    value.setShowSparkline(false);
+    QVERIFY(!fact->history());
+    QVERIFY(value.sparkline().isEmpty());
+
+    // Released along with the Fact
+    value.setShowSparkline(true);
+    QVERIFY(fact->history());
+    value.clearFact();
+    QVERIFY(!fact->history());
+    QVERIFY(!value.showSparkline());
+
+    fact->setRawValue(qQNaN());
+}
@@ -161,6 +161,13 @@ QGCPopupDialog {
                 onClicked:          instrumentValueData.showUnits = checked
             }
 
+            QGCCheckBox {
+                Layout.columnSpan:  2
+                text:               qsTr("Show Sparkline")
+                checked:            instrumentValueData.showSparkline
+                onClicked:          instrumentValueData.showSparkline = checked
+            }
+
             QGCLabel { text: qsTr("Range") }
 
             QGCComboBox {
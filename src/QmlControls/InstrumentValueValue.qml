@@ -38,14 +38,50 @@ ColumnLayout {
         id:                 label
         Layout.alignment:   Qt.AlignVCenter
         font.pointSize:     _fontSize
-        text:               valueText()
+        text:               instrumentValueData.valueText
+    }
+
+    Canvas {
+        id:                     sparklineCanvas
+        Layout.preferredWidth:  Math.max(label.contentWidth, ScreenTools.defaultFontPixelWidth * 8)
+        Layout.preferredHeight: _tightHeight / 2
+        Layout.alignment:       Qt.AlignHCenter
+        visible:                instrumentValueData.showSparkline
 
-        function valueText() {
-            if (instrumentValueData.fact) {
-                return instrumentValueData.fact.enumOrValueString + (instrumentValueData.showUnits ? " " + instrumentValueData.fact.units : "")
-            } else {
-                return qsTr("--.--")
+        property var _qgcPal: QGCPalette { colorGroupEnabled: true }
+
+        onPaint: {
+            var ctx = getContext("2d")
+            ctx.reset()
+            var points = instrumentValueData.sparkline
+            if (points.length < 2) {
+                return
+            }
+            var yMin = points[0].y
+            var yMax = points[0].y
+            for (var i = 1; i < points.length; i++) {
+                yMin = Math.min(yMin, points[i].y)
+                yMax = Math.max(yMax, points[i].y)
             }
+            var ySpan = yMax - yMin > 0 ? yMax - yMin : 1
+            ctx.strokeStyle = _qgcPal.text
+            ctx.lineWidth = 1
+            ctx.beginPath()
+            for (var j = 0; j < points.length; j++) {
+                var x = (1 + points[j].x / instrumentValueData.sparklineSeconds) * (width - 1)
+                var y = (height - 1) - ((points[j].y - yMin) / ySpan) * (height - 1)
+                if (j === 0) {
+                    ctx.moveTo(x, y)
+                } else {
+                    ctx.lineTo(x, y)
+                }
+            }
+            ctx.stroke()
+        }
+
+        Connections {
+            target:             instrumentValueData
+            onSparklineChanged: sparklineCanvas.requestPaint()
         }
     }
 }
@@ -13,6 +13,7 @@ Rectangle {
 
     property real   _margins:       ScreenTools.defaultFontPixelHeight / 4
     property var    _logReplayLink: null
+    property var    _videoReplay:   QGroundControl.videoManager.videoReplay
 
     function pickLogFile() {
         if (globals.activeVehicle) {
@@ -39,6 +40,21 @@ Rectangle {
         property string _logFileExtension: QGroundControl.settingsManager.appSettings.telemetryFileExtension
     }
 
+    QGCFileDialog {
+        id:                 videoPicker
+        title:              qsTr("Select Recorded Video")
+        nameFilters:        [ qsTr("Videos (*.mkv *.mov *.mp4)"), qsTr("All Files (*)") ]
+        selectExisting:     true
+        folder:             QGroundControl.settingsManager.appSettings.videoSavePath
+        onAcceptedForLoad: {
+            _videoReplay.link = controller.link
+            if (!_videoReplay.open(file)) {
+                mainWindow.showMessageDialog(qsTr("Video Replay"), _videoReplay.errorString)
+            }
+            close()
+        }
+    }
+
     LogReplayLinkController {
         id: controller
 
@@ -69,6 +85,9 @@ Rectangle {
                 ListElement { text: "1x";   value: 1 }
                 ListElement { text: "2x";   value: 2 }
                 ListElement { text: "5x";   value: 5 }
+                ListElement { text: "10x";  value: 10 }
+                ListElement { text: "25x";  value: 25 }
+                ListElement { text: "100x"; value: 100 }
             }
 
             onActivated: controller.playbackSpeed = model.get(currentIndex).value
@@ -106,9 +125,34 @@ Rectangle {
             visible:    !controller.link
         }
 
+        QGCLabel {
+            text:       qsTr("Video offset (secs)")
+            visible:    _videoReplay.active
+        }
+
+        QGCTextField {
+            text:               _videoReplay.offsetSecs.toFixed(1)
+            visible:            _videoReplay.active
+            inputMethodHints:   Qt.ImhFormattedNumbersOnly
+            onEditingFinished:  _videoReplay.offsetSecs = parseFloat(text)
+        }
+
+        QGCButton {
+            text:       _videoReplay.active ? qsTr("Close Video") : qsTr("Load Video")
+            visible:    controller.link
+            onClicked: {
+                if (_videoReplay.active) {
+                    _videoReplay.close()
+                } else {
+                    videoPicker.openForLoad()
+                }
+            }
+        }
+
         QGCButton {
             text:       qsTr("Close")
             onClicked: {
+                _videoReplay.close()
                 var activeVehicle = QGroundControl.multiVehicleManager.activeVehicle
                 if (activeVehicle) {
                     activeVehicle.closeVehicle()
@@ -23,15 +23,21 @@ ChartView {
     property var chartController:   null
     property var seriesColors:      ["#00E04B","#DE8500","#F32836","#BFBFBF","#536DFF","#EECC44"]
 
+    onPlotAreaChanged: {
+        if(chartController) {
+            chartController.plotWidth = plotArea.width
+        }
+    }
+
     function addDimension(field) {
         if(!chartController) {
             chartController = controller.createChart()
+            chartController.plotWidth = plotArea.width
         }
         var color   = chartView.seriesColors[chartView.count]
         var serie   = createSeries(ChartView.SeriesTypeLine, field.label)
         serie.axisX = axisX
         serie.axisY = axisY
-        serie.useOpenGL = true
         serie.color = color
         serie.width = 1
         chartController.addSeries(field, serie)
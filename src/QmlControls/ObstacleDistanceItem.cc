@@ -0,0 +1,115 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ObstacleDistanceItem.h"
+#include "VehicleObjectAvoidance.h"
+
+#include <QSGGeometry>
+#include <QSGVertexColorMaterial>
+
+ObstacleDistanceItem::ObstacleDistanceItem(QQuickItem* parent)
+    : QQuickItem(parent)
+{
+    setFlag(QQuickItem::ItemHasContents, true);
+
+    connect(this, &QQuickItem::widthChanged,                    this, &ObstacleDistanceItem::_geometryChanged);
+    connect(this, &QQuickItem::heightChanged,                   this, &ObstacleDistanceItem::_geometryChanged);
+    connect(this, &ObstacleDistanceItem::pixelsPerMeterChanged, this, &ObstacleDistanceItem::_geometryChanged);
+    connect(this, &ObstacleDistanceItem::pointSizeChanged,      this, &ObstacleDistanceItem::_geometryChanged);
+    connect(this, &ObstacleDistanceItem::colorChanged,          this, &ObstacleDistanceItem::_geometryChanged);
+    connect(this, &ObstacleDistanceItem::nearColorChanged,      this, &ObstacleDistanceItem::_geometryChanged);
+    connect(this, &ObstacleDistanceItem::nearDistanceChanged,   this, &ObstacleDistanceItem::_geometryChanged);
+}
+
+void ObstacleDistanceItem::setObjectAvoidance(VehicleObjectAvoidance* objectAvoidance)
+{
+    if (objectAvoidance != _objectAvoidance) {
+        if (_objectAvoidance) {
+            disconnect(_objectAvoidance, &VehicleObjectAvoidance::pointsChanged, this, &ObstacleDistanceItem::_pointsChanged);
+        }
+        _objectAvoidance = objectAvoidance;
+        if (_objectAvoidance) {
+            connect(_objectAvoidance, &VehicleObjectAvoidance::pointsChanged, this, &ObstacleDistanceItem::_pointsChanged);
+        }
+        emit objectAvoidanceChanged();
+        _pointsChanged();
+    }
+}
+
+void ObstacleDistanceItem::_pointsChanged(void)
+{
+    // Implicitly shared, this doesn't copy the points
+    _points = _objectAvoidance ? _objectAvoidance->points() : QVector<QVector3D>();
+    _geometryChanged();
+}
+
+void ObstacleDistanceItem::_geometryChanged(void)
+{
+    _dirty = true;
+    update();
+}
+
+static void _setVertex(QSGGeometry::ColoredPoint2D* vertex, float x, float y, const QColor& color)
+{
+    // The vertex color material expects premultiplied alpha
+    int alpha = color.alpha();
+    vertex->set(x, y,
+                static_cast<uchar>(color.red() * alpha / 255),
+                static_cast<uchar>(color.green() * alpha / 255),
+                static_cast<uchar>(color.blue() * alpha / 255),
+                static_cast<uchar>(alpha));
+}
+
+QSGNode* ObstacleDistanceItem::updatePaintNode(QSGNode* oldNode, QQuickItem::UpdatePaintNodeData* /*updatePaintNodeData*/)
+{
+    QSGGeometryNode* node = static_cast<QSGGeometryNode*>(oldNode);
+
+    if (!node) {
+        QSGGeometry* geometry = new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), 0);
+        geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+
+        node = new QSGGeometryNode;
+        node->setFlag(QSGNode::OwnsGeometry);
+        node->setFlag(QSGNode::OwnsMaterial);
+        node->setMaterial(new QSGVertexColorMaterial);
+        node->setGeometry(geometry);
+        _dirty = true;
+    }
+
+    if (!_dirty) {
+        return node;
+    }
+    _dirty = false;
+
+    // Vehicle front is up, right is right
+    const float     centerX         = static_cast<float>(width() / 2);
+    const float     centerY         = static_cast<float>(height() / 2);
+    const float     scale           = static_cast<float>(_pixelsPerMeter);
+    const float     halfSize        = static_cast<float>(_pointSize / 2);
+    const float     nearDistance    = static_cast<float>(_nearDistance);
+    QSGGeometry*    geometry        = node->geometry();
+
+    geometry->allocate(_points.count() * _verticesPerPoint);
+    QSGGeometry::ColoredPoint2D* vertices = geometry->vertexDataAsColoredPoint2D();
+    for (const QVector3D& point: _points) {
+        const QColor&   color   = point.toVector2D().length() < nearDistance ? _nearColor : _color;
+        const float     x       = centerX + point.y() * scale;
+        const float     y       = centerY - point.x() * scale;
+
+        _setVertex(vertices++, x - halfSize, y - halfSize, color);
+        _setVertex(vertices++, x + halfSize, y - halfSize, color);
+        _setVertex(vertices++, x + halfSize, y + halfSize, color);
+        _setVertex(vertices++, x - halfSize, y - halfSize, color);
+        _setVertex(vertices++, x + halfSize, y + halfSize, color);
+        _setVertex(vertices++, x - halfSize, y + halfSize, color);
+    }
+    node->markDirty(QSGNode::DirtyGeometry);
+
+    return node;
+}
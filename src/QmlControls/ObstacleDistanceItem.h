@@ -0,0 +1,71 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QColor>
+#include <QQuickItem>
+#include <QSGGeometryNode>
+#include <QVector>
+#include <QVector3D>
+
+class VehicleObjectAvoidance;
+
+/// Draws the obstacles of VehicleObjectAvoidance as squares around the center of the item, vehicle front up. All
+/// points go into a single geometry node which is only rebuilt when the points, the scale or the look changed, so
+/// there is no per point QML object or call. Rotate the item to match the vehicle heading.
+class ObstacleDistanceItem : public QQuickItem
+{
+    Q_OBJECT
+
+public:
+    ObstacleDistanceItem(QQuickItem *parent = nullptr);
+
+    Q_PROPERTY(VehicleObjectAvoidance*  objectAvoidance READ objectAvoidance    WRITE setObjectAvoidance    NOTIFY objectAvoidanceChanged)
+    Q_PROPERTY(double                   pixelsPerMeter  MEMBER _pixelsPerMeter                              NOTIFY pixelsPerMeterChanged)
+    Q_PROPERTY(double                   pointSize       MEMBER _pointSize                                   NOTIFY pointSizeChanged)
+    Q_PROPERTY(QColor                   color           MEMBER _color                                       NOTIFY colorChanged)
+    Q_PROPERTY(QColor                   nearColor       MEMBER _nearColor                                   NOTIFY nearColorChanged)
+    Q_PROPERTY(double                   nearDistance    MEMBER _nearDistance                                NOTIFY nearDistanceChanged)   ///< Meters, obstacles closer than this use nearColor
+
+    VehicleObjectAvoidance* objectAvoidance(void) { return _objectAvoidance; }
+
+    void setObjectAvoidance(VehicleObjectAvoidance* objectAvoidance);
+
+    // Overrides from QQuickItem
+    QSGNode* updatePaintNode(QSGNode* oldNode, QQuickItem::UpdatePaintNodeData* updatePaintNodeData);
+
+signals:
+    void objectAvoidanceChanged (void);
+    void pixelsPerMeterChanged  (void);
+    void pointSizeChanged       (void);
+    void colorChanged           (void);
+    void nearColorChanged       (void);
+    void nearDistanceChanged    (void);
+
+private slots:
+    void _pointsChanged         (void);
+    void _geometryChanged       (void);
+
+private:
+    VehicleObjectAvoidance* _objectAvoidance =  nullptr;
+    QVector<QVector3D>      _points;                        ///< Copy of the points for the render thread
+    bool                    _dirty =            true;       ///< Geometry has to be rebuilt
+    double                  _pixelsPerMeter =   1;
+    double                  _pointSize =        6;
+    QColor                  _color =            QColor("orange");
+    QColor                  _nearColor =        QColor("red");
+    double                  _nearDistance =     0;
+
+    static const int _verticesPerPoint = 6;
+
+    Q_DISABLE_COPY(ObstacleDistanceItem)
+};
+
+QML_DECLARE_TYPE(ObstacleDistanceItem)
@@ -14,6 +14,7 @@
 #include "AppSettings.h"
 
 #include <QStandardPaths>
+#include <QtConcurrent>
 
 ParameterEditorController::ParameterEditorController(void)
     : _parameterMgr(_vehicle->parameterManager())
@@ -26,6 +27,7 @@ ParameterEditorController::ParameterEditorController(void)
     connect(this, &ParameterEditorController::showModifiedOnlyChanged,  this, &ParameterEditorController::_searchTextChanged);
 
     connect(_parameterMgr, &ParameterManager::factAdded, this, &ParameterEditorController::_factAdded);
+    connect(&_searchWatcher, &QFutureWatcherBase::finished, this, &ParameterEditorController::_searchFinished);
 
     ParameterEditorCategory* category = _categories.count() ? _categories.value<ParameterEditorCategory*>(0) : nullptr;
     setCurrentCategory(category);
@@ -100,6 +102,12 @@ void ParameterEditorController::_buildLists(void)
         }
     }
 
+    // Search covers the default component
+    for (const QString& factName: _parameterMgr->parameterNames(_vehicle->defaultComponentId())) {
+        Fact* fact = _parameterMgr->getParameter(_vehicle->defaultComponentId(), factName);
+        _searchIndex.add(fact->name(), fact->shortDescription(), fact->longDescription());
+    }
+
     // Default group should always be last
     for (int i=0; i<_categories.count(); i++) {
         ParameterEditorCategory* category = _categories.value<ParameterEditorCategory*>(i);
@@ -179,6 +187,17 @@ void ParameterEditorController::_factAdded(int compId, Fact* fact)
     if (!inserted) {
         facts.append(fact);
     }
+
+    if (compId == _vehicle->defaultComponentId()) {
+        _searchIndex.add(fact->name(), fact->shortDescription(), fact->longDescription());
+        _searchIndexGeneration++;
+        _searchResultsValid = false;
+
+        // Show the new parameter if it matches the current search
+        if (_searchActive()) {
+            _searchTextChanged();
+        }
+    }
 }
 
 QStringList ParameterEditorController::searchParameters(const QString& searchText, bool searchInName, bool searchInDescriptions)
@@ -236,18 +255,25 @@ void ParameterEditorController::clearDiff(void)
 
 void ParameterEditorController::sendDiff(void)
 {
+    QList<ParameterManager::ParamWrite_t> rgWrites;
+
     for (int i=0; i<_diffList.count(); i++) {
         ParameterEditorDiff* paramDiff = _diffList.value<ParameterEditorDiff*>(i);
 
         if (paramDiff->load) {
-            if (paramDiff->noVehicleValue) {
-                _parameterMgr->_factRawValueUpdateWorker(paramDiff->componentId, paramDiff->name, paramDiff->valueType, paramDiff->fileValueVar);
-            } else {
-                Fact* fact = _parameterMgr->getParameter(paramDiff->componentId, paramDiff->name);
-                fact->setRawValue(paramDiff->fileValueVar);
-            }
+            ParameterManager::ParamWrite_t paramWrite;
+
+            paramWrite.componentId  = paramDiff->componentId;
+            paramWrite.name         = paramDiff->name;
+            paramWrite.valueType    = paramDiff->valueType;
+            paramWrite.rawValue     = paramDiff->fileValueVar;
+            paramWrite.retryCount   = 0;
+            rgWrites.append(paramWrite);
         }
     }
+
+    // Unchanged values are skipped and the rest is pipelined to the vehicle
+    _parameterMgr->writeParameters(rgWrites);
 }
 
 bool ParameterEditorController::buildDiffFromFile(const QString& filename)
@@ -358,52 +384,76 @@ bool ParameterEditorController::_shouldShow(Fact* fact)
     return show;
 }
 
-void ParameterEditorController::_searchTextChanged(void)
+bool ParameterEditorController::_searchActive(void)
 {
-    QObjectList newParameterList;
-
-#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
-    QStringList rgSearchStrings = _searchText.split(' ', QString::SkipEmptyParts);
-#else
-    QStringList rgSearchStrings = _searchText.split(' ', Qt::SkipEmptyParts);
-#endif
+    return _showModifiedOnly || !ParameterSearchIndex::terms(_searchText).isEmpty();
+}
 
+void ParameterEditorController::_searchTextChanged(void)
+{
+    _searchGeneration++;
 
-    if (rgSearchStrings.isEmpty() && !_showModifiedOnly) {
+    if (!_searchActive()) {
         ParameterEditorCategory* category = _categories.count() ? _categories.value<ParameterEditorCategory*>(0) : nullptr;
         setCurrentCategory(category);
         _searchParameters.clear();
-    } else {
-        _searchParameters.beginReset();
-        _searchParameters.clear();
+    } else if (!_searchWatcher.isRunning()) {
+        // Otherwise _searchFinished starts a new search once the one running completes. Only the latest text is
+        // searched for when typing faster than the search.
+        _startSearch();
+    }
+}
 
-        for (const QString &paraName: _parameterMgr->parameterNames(_vehicle->defaultComponentId())) {
-            Fact* fact = _parameterMgr->getParameter(_vehicle->defaultComponentId(), paraName);
-            bool matched = _shouldShow(fact);
-            // All of the search items must match in order for the parameter to be added to the list
-            if (matched) {
-                for (const auto& searchItem : rgSearchStrings) {
-                    if (!fact->name().contains(searchItem, Qt::CaseInsensitive) &&
-                            !fact->shortDescription().contains(searchItem, Qt::CaseInsensitive) &&
-                            !fact->longDescription().contains(searchItem, Qt::CaseInsensitive)) {
-                        matched = false;
-                    }
-                }
-            }
-            if (matched) {
-                _searchParameters.append(fact);
+void ParameterEditorController::_startSearch(void)
+{
+    QStringList terms = ParameterSearchIndex::terms(_searchText);
+
+    // Narrowing the previous search only needs to look through what it found
+    bool refine = _searchResultsValid && ParameterSearchIndex::refines(terms, _searchResultsTerms);
+
+    _runningSearchGeneration        = _searchGeneration;
+    _runningSearchIndexGeneration   = _searchIndexGeneration;
+    _runningSearchTerms             = terms;
+    _searchWatcher.setFuture(QtConcurrent::run(&ParameterSearchIndex::match, refine ? _searchResults : _searchIndex.entries(), terms));
+}
+
+void ParameterEditorController::_searchFinished(void)
+{
+    // Results which are missing parameters added during the search can't be refined
+    if (_runningSearchIndexGeneration == _searchIndexGeneration) {
+        _searchResults      = _searchWatcher.result();
+        _searchResultsTerms = _runningSearchTerms;
+        _searchResultsValid = true;
+    }
+
+    if (_runningSearchGeneration != _searchGeneration) {
+        // The search changed while running
+        if (_searchActive()) {
+            _startSearch();
+        }
+        return;
+    }
+
+    // Modified state changes with the values, so it is checked here instead of being part of the index
+    QObjectList newParameterList;
+    for (const ParameterSearchIndex::Entry_t& entry: _searchWatcher.result()) {
+        if (_parameterMgr->parameterExists(_vehicle->defaultComponentId(), entry.name)) {
+            Fact* fact = _parameterMgr->getParameter(_vehicle->defaultComponentId(), entry.name);
+            if (_shouldShow(fact)) {
+                newParameterList.append(fact);
             }
         }
+    }
 
-        _searchParameters.endReset();
+    // Typing narrows or widens the results, only the rows which come and go change
+    _searchParameters.updateObjectList(newParameterList);
 
-        if (_parameters != &_searchParameters) {
-            _parameters = &_searchParameters;
-            emit parametersChanged();
+    if (_parameters != &_searchParameters) {
+        _parameters = &_searchParameters;
+        emit parametersChanged();
 
-            _currentCategory    = nullptr;
-            _currentGroup       = nullptr;
-        }
+        _currentCategory    = nullptr;
+        _currentGroup       = nullptr;
     }
 }
 
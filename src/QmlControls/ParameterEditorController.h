@@ -11,12 +11,14 @@
 
 #include <QObject>
 #include <QList>
+#include <QFutureWatcher>
 
 #include "AutoPilotPlugin.h"
 #include "UASInterface.h"
 #include "FactPanelController.h"
 #include "QmlObjectListModel.h"
 #include "ParameterManager.h"
+#include "ParameterSearchIndex.h"
 
 class ParameterEditorGroup : public QObject
 {
@@ -134,9 +136,12 @@ private slots:
     void _buildLists            (void);
     void _buildListsForComponent(int compId);
     void _factAdded             (int compId, Fact* fact);
+    void _searchFinished        (void);
 
 private:
-    bool _shouldShow(Fact *fact);
+    bool _shouldShow    (Fact *fact);
+    bool _searchActive  (void);
+    void _startSearch   (void);
 
 private:
     ParameterManager*           _parameterMgr           = nullptr;
@@ -152,4 +157,15 @@ private:
     QmlObjectListModel          _searchParameters;
     QmlObjectListModel*         _parameters             = nullptr;
     QMap<QString, ParameterEditorCategory*> _mapCategoryName2Category;
+
+    ParameterSearchIndex                            _searchIndex;                           ///< Default component parameters
+    QFutureWatcher<ParameterSearchIndex::Entries_t> _searchWatcher;
+    int                                             _searchGeneration               = 0;    ///< Bumped by each change to the search
+    int                                             _runningSearchGeneration        = 0;
+    int                                             _searchIndexGeneration          = 0;    ///< Bumped by each change to the index
+    int                                             _runningSearchIndexGeneration   = 0;
+    QStringList                                     _runningSearchTerms;
+    ParameterSearchIndex::Entries_t                 _searchResults;                         ///< Text matches of the last completed search
+    QStringList                                     _searchResultsTerms;
+    bool                                            _searchResultsValid             = false;
 };
@@ -0,0 +1,74 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterSearchIndex.h"
+
+#include <algorithm>
+
+void ParameterSearchIndex::add(const QString& name, const QString& shortDescription, const QString& longDescription)
+{
+    Entry_t entry;
+    entry.name = name;
+    // The separators keep a term from matching across the end of one field and the start of the next
+    entry.text = QStringLiteral("%1\n%2\n%3").arg(name, shortDescription, longDescription).toCaseFolded();
+
+    auto it = std::lower_bound(_entries.begin(), _entries.end(), name, [](const Entry_t& other, const QString& otherName) { return other.name < otherName; });
+    if (it != _entries.end() && it->name == name) {
+        *it = entry;
+    } else {
+        _entries.insert(it, entry);
+    }
+}
+
+QStringList ParameterSearchIndex::terms(const QString& searchText)
+{
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+    return searchText.toCaseFolded().split(' ', QString::SkipEmptyParts);
+#else
+    return searchText.toCaseFolded().split(' ', Qt::SkipEmptyParts);
+#endif
+}
+
+bool ParameterSearchIndex::refines(const QStringList& terms, const QStringList& previousTerms)
+{
+    // Each previous term must be part of a new one. Typing more of a word or adding a word narrows the search.
+    for (const QString& previousTerm: previousTerms) {
+        bool found = false;
+        for (const QString& term: terms) {
+            if (term.contains(previousTerm)) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ParameterSearchIndex::Entries_t ParameterSearchIndex::match(const Entries_t& entries, const QStringList& terms)
+{
+    Entries_t matches;
+
+    for (const Entry_t& entry: entries) {
+        bool matched = true;
+        for (const QString& term: terms) {
+            if (!entry.text.contains(term)) {
+                matched = false;
+                break;
+            }
+        }
+        if (matched) {
+            matches.append(entry);
+        }
+    }
+
+    return matches;
+}
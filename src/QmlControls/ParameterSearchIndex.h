@@ -0,0 +1,46 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/// Search text for the parameters of a component, kept sorted by name. The name and descriptions are case folded once
+/// when a parameter is added, so a search is a plain substring scan. Entries are plain data which is implicitly shared,
+/// so a copy of them can be searched from a background thread.
+class ParameterSearchIndex
+{
+public:
+    struct Entry_t {
+        QString name;   ///< Parameter name
+        QString text;   ///< Case folded name, short and long description
+    };
+    typedef QVector<Entry_t> Entries_t;
+
+    void                clear   (void) { _entries.clear(); }
+    int                 count   (void) const { return _entries.count(); }
+    const Entries_t&    entries (void) const { return _entries; }
+
+    /// Adds the parameter in name order, replaces it if it was already added
+    void add(const QString& name, const QString& shortDescription, const QString& longDescription);
+
+    /// @return Case folded search terms from the space separated search text
+    static QStringList terms(const QString& searchText);
+
+    /// @return true: everything matching terms also matches previousTerms, so only the previous results need searching
+    static bool refines(const QStringList& terms, const QStringList& previousTerms);
+
+    /// @return Entries whose text contains all of the terms, in the order of entries. Safe to call from any thread.
+    static Entries_t match(const Entries_t& entries, const QStringList& terms);
+
+private:
+    Entries_t _entries;
+};
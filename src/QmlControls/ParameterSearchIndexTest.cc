@@ -0,0 +1,95 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ParameterSearchIndexTest.h"
+#include "ParameterSearchIndex.h"
+
+ParameterSearchIndexTest::ParameterSearchIndexTest(void)
+{
+
+}
+
+static QStringList _names(const ParameterSearchIndex::Entries_t& entries)
+{
+    QStringList names;
+    for (const ParameterSearchIndex::Entry_t& entry: entries) {
+        names.append(entry.name);
+    }
+    return names;
+}
+
+void ParameterSearchIndexTest::_addTest(void)
+{
+    ParameterSearchIndex index;
+
+    index.add("RTL_ALT",        "RTL Altitude",     QString());
+    index.add("ARMING_CHECK",   "Arming Checks",    QString());
+    index.add("BATT_CAPACITY",  "Battery capacity", QString());
+    QCOMPARE(_names(index.entries()), QStringList({ "ARMING_CHECK", "BATT_CAPACITY", "RTL_ALT" }));
+
+    // Adding again replaces the entry
+    index.add("RTL_ALT", "Return altitude", QString());
+    QCOMPARE(index.count(), 3);
+    QCOMPARE(_names(ParameterSearchIndex::match(index.entries(), ParameterSearchIndex::terms("return"))), QStringList("RTL_ALT"));
+    QVERIFY(ParameterSearchIndex::match(index.entries(), ParameterSearchIndex::terms("rtl altitude")).isEmpty());
+}
+
+void ParameterSearchIndexTest::_matchTest_data(void)
+{
+    QTest::addColumn<QString>("searchText");
+    QTest::addColumn<QStringList>("matches");
+
+    QTest::newRow("empty")          << ""               << QStringList({ "ARMING_CHECK", "BATT_CAPACITY", "RTL_ALT" });
+    QTest::newRow("name")           << "batt_"          << QStringList("BATT_CAPACITY");
+    QTest::newRow("case")           << "rtl_alt"        << QStringList("RTL_ALT");
+    QTest::newRow("short")          << "checks"         << QStringList("ARMING_CHECK");
+    QTest::newRow("long")           << "mAh"            << QStringList("BATT_CAPACITY");
+    QTest::newRow("allTerms")       << "rtl  altitude"  << QStringList("RTL_ALT");
+    QTest::newRow("termsInFields")  << "arming disable" << QStringList("ARMING_CHECK");
+    QTest::newRow("oneTermMissing") << "rtl battery"    << QStringList();
+    QTest::newRow("acrossFields")   << "altreturn"      << QStringList();
+}
+
+void ParameterSearchIndexTest::_matchTest(void)
+{
+    QFETCH(QString,     searchText);
+    QFETCH(QStringList, matches);
+
+    ParameterSearchIndex index;
+    index.add("BATT_CAPACITY",  "Battery capacity", "Capacity of the battery in mAh");
+    index.add("RTL_ALT",        "Return altitude",  "Altitude to climb to before returning");
+    index.add("ARMING_CHECK",   "Arming Checks",    "Checks prior to arming, zero to disable");
+
+    QCOMPARE(_names(ParameterSearchIndex::match(index.entries(), ParameterSearchIndex::terms(searchText))), matches);
+}
+
+void ParameterSearchIndexTest::_refinesTest_data(void)
+{
+    QTest::addColumn<QString>("previousSearchText");
+    QTest::addColumn<QString>("searchText");
+    QTest::addColumn<bool>("refines");
+
+    QTest::newRow("fromEmpty")  << ""           << "rtl"        << true;
+    QTest::newRow("same")       << "rtl"        << "RTL"        << true;
+    QTest::newRow("typeMore")   << "rt"         << "rtl"        << true;
+    QTest::newRow("addTerm")    << "rtl"        << "rtl alt"    << true;
+    QTest::newRow("backspace")  << "rtl"        << "rt"         << false;
+    QTest::newRow("removeTerm") << "rtl alt"    << "rtl"        << false;
+    QTest::newRow("toEmpty")    << "rtl"        << ""           << false;
+    QTest::newRow("different")  << "rtl"        << "batt"       << false;
+}
+
+void ParameterSearchIndexTest::_refinesTest(void)
+{
+    QFETCH(QString, previousSearchText);
+    QFETCH(QString, searchText);
+    QFETCH(bool,    refines);
+
+    QCOMPARE(ParameterSearchIndex::refines(ParameterSearchIndex::terms(searchText), ParameterSearchIndex::terms(previousSearchText)), refines);
+}
@@ -0,0 +1,28 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for ParameterSearchIndex
+class ParameterSearchIndexTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    ParameterSearchIndexTest(void);
+
+private slots:
+    void _addTest           (void);
+    void _matchTest_data    (void);
+    void _matchTest         (void);
+    void _refinesTest_data  (void);
+    void _refinesTest       (void);
+};
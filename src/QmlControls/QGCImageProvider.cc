@@ -21,10 +21,12 @@
 
 #include <QPainter>
 #include <QFont>
+#include <QDebug>
 
 QGCImageProvider::QGCImageProvider(QGCApplication *app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
-    , QQuickImageProvider(QQmlImageProviderBase::Image)
+    , QQuickImageProvider(QQmlImageProviderBase::Image, QQmlImageProviderBase::ForceAsynchronousImageLoading)
+    , _namedImages(defaultCacheBytes)
 {
 }
 
@@ -37,18 +39,30 @@ void QGCImageProvider::setToolbox(QGCToolbox *toolbox)
 {
    QGCTool::setToolbox(toolbox);
    //-- Dummy temporary image until something comes along
-   _pImage = QImage(320, 240, QImage::Format_RGBA8888);
-   _pImage.fill(Qt::black);
-   QPainter painter(&_pImage);
+   QImage waitingImage(320, 240, QImage::Format_RGBA8888);
+   waitingImage.fill(Qt::black);
+   QPainter painter(&waitingImage);
    QFont f = painter.font();
    f.setPixelSize(20);
    painter.setFont(f);
    painter.setPen(Qt::white);
    painter.drawText(QRectF(0, 0, 320, 240), Qt::AlignCenter, "Waiting...");
+   painter.end();
+   QMutexLocker locker(&_imagesMutex);
+   _pImage = waitingImage;
 }
 
-QImage QGCImageProvider::requestImage(const QString & /* image url with vehicle id*/, QSize *, const QSize &)
+QImage QGCImageProvider::requestImage(const QString & id, QSize * size, const QSize & requestedSize)
 {
+    QSize namedImageSize;
+    QImage namedImage = _namedImage(id.section(QLatin1Char('/'), 0, 0), requestedSize, &namedImageSize);
+    if (!namedImage.isNull()) {
+        if (size) {
+            *size = namedImageSize;
+        }
+        return namedImage;
+    }
+
 /*
     The QML side will request an image using a special URL, which we've registered as QGCImages.
     The URL follows this format (or anything you want to make out of it after the "QGCImages" part):
@@ -71,14 +85,131 @@ QImage QGCImageProvider::requestImage(const QString & /* image url with vehicle
             fillMode: Image.PreserveAspectFit
         }
 
-    For now, we don't even look at the URL. This will have to be fixed if we're to support multiple
-    vehicles transmitting flow images.
+    For now, we only look at the URL for named images. This will have to be fixed if we're to support
+    multiple vehicles transmitting flow images.
 */
+    QMutexLocker locker(&_imagesMutex);
+    if (size) {
+        *size = _pImage.size();
+    }
     return _pImage;
 }
 
 void QGCImageProvider::setImage(QImage* pImage, int /* vehicle id*/)
 {
-    _pImage = pImage->mirrored();
+    QImage image = pImage->mirrored();
+    QMutexLocker locker(&_imagesMutex);
+    _pImage = image;
+}
+
+void QGCImageProvider::setNamedImage(const QString& name, const QImage& image)
+{
+    QMutexLocker locker(&_imagesMutex);
+
+    // Scaled copies of the previous image are stale now
+    const QString scaledPrefix = name + QLatin1Char('@');
+    for (const QString& key: _namedImages.keys()) {
+        if (key.startsWith(scaledPrefix)) {
+            _namedImages.remove(key);
+        }
+    }
+
+    if (!_namedImages.insert(name, new QImage(image), _imageCost(image))) {
+        qWarning() << "QGCImageProvider: Image larger than the cache" << name << image.size();
+    }
+}
+
+bool QGCImageProvider::hasNamedImage(const QString& name)
+{
+    QMutexLocker locker(&_imagesMutex);
+    return _namedImages.contains(name);
+}
+
+void QGCImageProvider::setCacheBytes(int cacheBytes)
+{
+    QMutexLocker locker(&_imagesMutex);
+    _namedImages.setMaxCost(cacheBytes);
+}
+
+int QGCImageProvider::cacheBytes(void)
+{
+    QMutexLocker locker(&_imagesMutex);
+    return _namedImages.maxCost();
+}
+
+int QGCImageProvider::cachedBytes(void)
+{
+    QMutexLocker locker(&_imagesMutex);
+    return _namedImages.totalCost();
+}
+
+QImage QGCImageProvider::_namedImage(const QString& name, const QSize& requestedSize, QSize* originalSize)
+{
+    QImage  original;
+    QSize   scaledSize;
+    QString scaledKey;
+
+    {
+        QMutexLocker locker(&_imagesMutex);
+        QImage* image = _namedImages.object(name);
+        if (!image) {
+            return QImage();
+        }
+        original        = *image;
+        *originalSize   = original.size();
+        scaledSize      = _scaledSize(original.size(), requestedSize);
+        if (scaledSize == original.size()) {
+            return original;
+        }
+        scaledKey = _scaledKey(name, scaledSize);
+        QImage* scaledImage = _namedImages.object(scaledKey);
+        if (scaledImage) {
+            return *scaledImage;
+        }
+    }
+
+    // Scaling is done without holding the lock so new images don't wait for it
+    QImage scaled = original.scaled(scaledSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    QMutexLocker locker(&_imagesMutex);
+    QImage* image = _namedImages.object(name);
+    if (image && image->cacheKey() == original.cacheKey()) {
+        _namedImages.insert(scaledKey, new QImage(scaled), _imageCost(scaled));
+    }
+    return scaled;
+}
+
+int QGCImageProvider::_imageCost(const QImage& image)
+{
+    return qMax(1, image.bytesPerLine() * image.height());
 }
 
+QString QGCImageProvider::_scaledKey(const QString& name, const QSize& size)
+{
+    return QStringLiteral("%1@%2x%3").arg(name).arg(size.width()).arg(size.height());
+}
+
+QSize QGCImageProvider::_scaledSize(const QSize& size, const QSize& requestedSize)
+{
+    if (size.isEmpty()) {
+        return size;
+    }
+
+    // QML sourceSize may only give one of width or height
+    QSize scaledSize;
+    if (requestedSize.width() > 0 && requestedSize.height() > 0) {
+        scaledSize = size.scaled(requestedSize, Qt::KeepAspectRatio);
+    } else if (requestedSize.width() > 0) {
+        scaledSize = QSize(requestedSize.width(), qMax(1, qRound(static_cast<double>(size.height()) * requestedSize.width() / size.width())));
+    } else if (requestedSize.height() > 0) {
+        scaledSize = QSize(qMax(1, qRound(static_cast<double>(size.width()) * requestedSize.height() / size.height())), requestedSize.height());
+    } else {
+        return size;
+    }
+
+    // Images are only ever scaled down
+    if (scaledSize.width() >= size.width() || scaledSize.height() >= size.height()) {
+        return size;
+    }
+    return scaledSize;
+}
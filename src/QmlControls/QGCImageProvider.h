@@ -20,12 +20,16 @@
 #ifndef QGCIMAGEPROVIDER_H
 #define QGCIMAGEPROVIDER_H
 
+#include <QCache>
+#include <QMutex>
 #include <QObject>
 #include <QQmlListProperty>
 #include <QQuickImageProvider>
 
 #include "QGCToolbox.h"
 
+/// Images are requested on the QML image reader thread. Named images, and the scaled down copies made for requests
+/// with a smaller sourceSize, are kept in a least recently used cache with a byte budget.
 class QGCImageProvider : public QGCTool, public QQuickImageProvider
 {
 public:
@@ -34,12 +38,35 @@ public:
     QImage  requestImage    (const QString & id, QSize * size, const QSize & requestedSize);
     void    setImage        (QImage* pImage, int id = 0);
     void    setToolbox      (QGCToolbox *toolbox);
+
+    /// Serves the image as image://QGCImages/<name>/<index>, alongside the flow image
+    void    setNamedImage   (const QString& name, const QImage& image);
+    /// @return false: Never set or dropped from the cache since
+    bool    hasNamedImage   (const QString& name);
+
+    /// Images which are least recently requested are dropped once the named images go over the budget
+    void    setCacheBytes   (int cacheBytes);
+    int     cacheBytes      (void);
+    int     cachedBytes     (void);
+
+    static const int defaultCacheBytes = 64 * 1024 * 1024;
+
 private:
+    QImage          _namedImage     (const QString& name, const QSize& requestedSize, QSize* originalSize);
+
+    static int      _imageCost      (const QImage& image);
+    static QString  _scaledKey      (const QString& name, const QSize& size);
+    static QSize    _scaledSize     (const QSize& size, const QSize& requestedSize);
+
+
     //-- TODO: For now this is holding a single image. If you happen to have two
     //   or more vehicles with flow, it will not work. To properly manage that condition
     //   this should be a map between each vehicle and its image. The URL provided
     //   for the image request would contain the vehicle identification.
     QImage _pImage;
+
+    QMutex                  _imagesMutex;   ///< Images are requested from the QML image reader thread
+    QCache<QString, QImage> _namedImages;   ///< Named and scaled images, cost in bytes
 };
 
 
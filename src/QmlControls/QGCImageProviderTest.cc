@@ -0,0 +1,75 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCImageProviderTest.h"
+#include "QGCImageProvider.h"
+#include "QGCApplication.h"
+
+static QImage _testImage(int width, int height, Qt::GlobalColor color)
+{
+    QImage image(width, height, QImage::Format_ARGB32);
+    image.fill(color);
+    return image;
+}
+
+void QGCImageProviderTest::_byteBudgetTest(void)
+{
+    QGCImageProvider provider(qgcApp(), nullptr);
+    QSize            size;
+    QImage           image = _testImage(100, 100, Qt::red);
+    const int        imageBytes = image.bytesPerLine() * image.height();
+
+    // Room for two images
+    provider.setCacheBytes(imageBytes * 2 + imageBytes / 2);
+    provider.setNamedImage(QStringLiteral("a"), image);
+    provider.setNamedImage(QStringLiteral("b"), image);
+    QCOMPARE(provider.cachedBytes(), imageBytes * 2);
+
+    // Least recently requested goes first
+    QVERIFY(!provider.requestImage(QStringLiteral("a/1"), &size, QSize()).isNull());
+    provider.setNamedImage(QStringLiteral("c"), image);
+    QCOMPARE(provider.cachedBytes(), imageBytes * 2);
+    QVERIFY(!provider.requestImage(QStringLiteral("a/2"), &size, QSize()).isNull());
+    QVERIFY(!provider.requestImage(QStringLiteral("c/1"), &size, QSize()).isNull());
+    QVERIFY(provider.requestImage(QStringLiteral("b/1"), &size, QSize()).isNull());
+
+    // Replacing an image doesn't add to the cost
+    provider.setNamedImage(QStringLiteral("c"), _testImage(100, 100, Qt::blue));
+    QCOMPARE(provider.cachedBytes(), imageBytes * 2);
+    QCOMPARE(provider.requestImage(QStringLiteral("c/2"), &size, QSize()).pixelColor(0, 0), QColor(Qt::blue));
+}
+
+void QGCImageProviderTest::_scaledImageTest(void)
+{
+    QGCImageProvider provider(qgcApp(), nullptr);
+    QSize            size;
+    QImage           image = _testImage(200, 100, Qt::green);
+    const int        imageBytes = image.bytesPerLine() * image.height();
+
+    provider.setNamedImage(QStringLiteral("a"), image);
+
+    // Scaled to fit, size is the one of the original image
+    QImage scaled = provider.requestImage(QStringLiteral("a/1"), &size, QSize(50, 0));
+    QCOMPARE(scaled.size(), QSize(50, 25));
+    QCOMPARE(size, QSize(200, 100));
+    QCOMPARE(provider.requestImage(QStringLiteral("a/1"), &size, QSize(50, 50)).size(), QSize(50, 25));
+    QCOMPARE(provider.requestImage(QStringLiteral("a/1"), &size, QSize(0, 10)).size(), QSize(20, 10));
+
+    // Scaled copies are cached
+    QCOMPARE(provider.requestImage(QStringLiteral("a/2"), &size, QSize(50, 0)).cacheKey(), scaled.cacheKey());
+    QVERIFY(provider.cachedBytes() > imageBytes);
+
+    // Never scaled up
+    QCOMPARE(provider.requestImage(QStringLiteral("a/3"), &size, QSize(400, 0)).size(), QSize(200, 100));
+    QCOMPARE(provider.requestImage(QStringLiteral("a/3"), &size, QSize()).size(), QSize(200, 100));
+
+    // A new image drops the scaled copies of the previous one
+    provider.setNamedImage(QStringLiteral("a"), image);
+    QCOMPARE(provider.cachedBytes(), imageBytes);
+}
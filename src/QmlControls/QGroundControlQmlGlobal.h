@@ -14,6 +14,7 @@
 #include "SettingsFact.h"
 #include "SimulatedPosition.h"
 #include "QGCLoggingCategory.h"
+#include "QGCMemoryAccounting.h"
 #include "AppSettings.h"
 #include "AirspaceManager.h"
 #include "ADSBVehicleManager.h"
@@ -78,6 +79,7 @@ public:
     Q_PROPERTY(bool                 supportsPairing         READ    supportsPairing         CONSTANT)
     Q_PROPERTY(QGCPalette*          globalPalette           MEMBER  _globalPalette          CONSTANT)   ///< This palette will always return enabled colors
     Q_PROPERTY(QmlUnitsConversion*  unitsConversion         READ    unitsConversion         CONSTANT)
+    Q_PROPERTY(QGCMemoryAccounting* memoryAccounting        READ    memoryAccounting        CONSTANT)
     Q_PROPERTY(bool                 singleFirmwareSupport   READ    singleFirmwareSupport   CONSTANT)
     Q_PROPERTY(bool                 singleVehicleSupport    READ    singleVehicleSupport    CONSTANT)
     Q_PROPERTY(bool                 px4ProFirmwareSupported READ    px4ProFirmwareSupported CONSTANT)
@@ -106,6 +108,8 @@ public:
     Q_PROPERTY(int      mavlinkSystemID         READ mavlinkSystemID            WRITE setMavlinkSystemID            NOTIFY mavlinkSystemIDChanged)
     Q_PROPERTY(bool     hasAPMSupport           READ hasAPMSupport              CONSTANT)
     Q_PROPERTY(bool     hasMAVLinkInspector     READ hasMAVLinkInspector        CONSTANT)
+    Q_PROPERTY(bool     traceAvailable          READ traceAvailable             CONSTANT)
+    Q_PROPERTY(bool     tracing                 READ tracing                    NOTIFY tracingChanged)
 
 
 #if defined(QGC_ENABLE_PAIRING)
@@ -140,6 +144,12 @@ public:
     /// Updates the logging filter rules after settings have changed
     Q_INVOKABLE void updateLoggingFilterRules(void) { QGCLoggingCategoryRegister::instance()->setFilterRulesFromSettings(QString()); }
 
+    /// Starts a Chrome trace of the trace points, written to the log save path by stopTrace
+    Q_INVOKABLE void startTrace(void) { qgcApp()->startTrace(); }
+
+    /// @return File the trace was written to, empty on error
+    Q_INVOKABLE QString stopTrace(void) { return qgcApp()->stopTrace(); }
+
     Q_INVOKABLE bool linesIntersect(QPointF xLine1, QPointF yLine1, QPointF xLine2, QPointF yLine2);
 
     Q_INVOKABLE QString altitudeModeExtraUnits(AltitudeMode altMode);       ///< String shown in the FactTextField.extraUnits ui
@@ -161,6 +171,7 @@ public:
     AirspaceManager*        airspaceManager     ()  { return _airspaceManager; }
     ADSBVehicleManager*     adsbVehicleManager  ()  { return _adsbVehicleManager; }
     QmlUnitsConversion*     unitsConversion     ()  { return &_unitsConversion; }
+    QGCMemoryAccounting*    memoryAccounting    ()  { return _memoryAccounting; }
 #if defined(QGC_ENABLE_PAIRING)
     bool                    supportsPairing     ()  { return true; }
     PairingManager*         pairingManager      ()  { return _pairingManager; }
@@ -206,6 +217,13 @@ public:
     bool    hasMAVLinkInspector     () { return false; }
 #endif
 
+#if defined(QGC_TRACE_DISABLED)
+    bool    traceAvailable          () { return false; }
+#else
+    bool    traceAvailable          () { return true; }
+#endif
+    bool    tracing                 () { return qgcApp()->tracing(); }
+
     bool    singleFirmwareSupport   ();
     bool    singleVehicleSupport    ();
     bool    px4ProFirmwareSupported ();
@@ -240,6 +258,7 @@ signals:
     void flightMapPositionChanged       (QGeoCoordinate flightMapPosition);
     void flightMapZoomChanged           (double flightMapZoom);
     void skipSetupPageChanged           ();
+    void tracingChanged                 ();
 
 private:
     double                  _flightMapInitialZoom   = 17.0;
@@ -258,6 +277,7 @@ private:
     TaisyncManager*         _taisyncManager         = nullptr;
     MicrohardManager*       _microhardManager       = nullptr;
     ADSBVehicleManager*     _adsbVehicleManager     = nullptr;
+    QGCMemoryAccounting*    _memoryAccounting       = nullptr;
     QGCPalette*             _globalPalette          = nullptr;
     QmlUnitsConversion      _unitsConversion;
 #if defined(QGC_ENABLE_PAIRING)
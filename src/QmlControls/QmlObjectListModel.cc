@@ -15,6 +15,7 @@
 
 #include <QDebug>
 #include <QQmlEngine>
+#include <QSet>
 
 const int QmlObjectListModel::ObjectRole = Qt::UserRole;
 const int QmlObjectListModel::TextRole = Qt::UserRole + 1;
@@ -172,14 +173,7 @@ void QmlObjectListModel::clear()
 QObject* QmlObjectListModel::removeAt(int i)
 {
     QObject* removedObject = _objectList[i];
-    if(removedObject) {
-        // Look for a dirtyChanged signal on the object
-        if (_objectList[i]->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
-            if (!_skipDirtyFirstItem || i != 0) {
-                QObject::disconnect(_objectList[i], SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
-            }
-        }
-    }
+    _disconnectDirty(removedObject, i);
     removeRows(i, 1);
     setDirty(true);
     return removedObject;
@@ -192,13 +186,8 @@ void QmlObjectListModel::insert(int i, QObject* object)
     }
     if(object) {
         QQmlEngine::setObjectOwnership(object, QQmlEngine::CppOwnership);
-        // Look for a dirtyChanged signal on the object
-        if (object->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
-            if (!_skipDirtyFirstItem || i != 0) {
-                QObject::connect(object, SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
-            }
-        }
     }
+    _connectDirty(object, i);
     _objectList.insert(i, object);
     insertRows(i, 1);
     setDirty(true);
@@ -213,16 +202,8 @@ void QmlObjectListModel::insert(int i, QList<QObject*> objects)
     int j = i;
     for (QObject* object: objects) {
         QQmlEngine::setObjectOwnership(object, QQmlEngine::CppOwnership);
-
-        // Look for a dirtyChanged signal on the object
-        if (object->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
-            if (!_skipDirtyFirstItem || j != 0) {
-                QObject::connect(object, SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
-            }
-        }
-        j++;
-
-        _objectList.insert(j, object);
+        _connectDirty(object, j);
+        _objectList.insert(j++, object);
     }
 
     insertRows(i, objects.count());
@@ -240,6 +221,106 @@ void QmlObjectListModel::append(QList<QObject*> objects)
     insert(_objectList.count(), objects);
 }
 
+bool QmlObjectListModel::updateObjectList(const QObjectList& newList)
+{
+    if (_objectList == newList) {
+        return false;
+    }
+
+    const int       oldCount    = _objectList.count();
+    QSet<QObject*>  newSet;
+    QSet<QObject*>  currentSet;
+    for (QObject* object: newList) {
+        newSet.insert(object);
+    }
+    for (QObject* object: _objectList) {
+        currentSet.insert(object);
+    }
+
+    // Rows can't be matched up if an object is in a list more than once
+    if (newSet.count() != newList.count() || currentSet.count() != _objectList.count()) {
+        swapObjectList(newList);
+        setDirty(true);
+        return true;
+    }
+
+    // Remove the objects which are gone, from the back so the indices of the runs ahead stay valid
+    int i = _objectList.count() - 1;
+    while (i >= 0) {
+        if (newSet.contains(_objectList[i])) {
+            i--;
+            continue;
+        }
+        int last = i;
+        while (i >= 0 && !newSet.contains(_objectList[i])) {
+            i--;
+        }
+        int first = i + 1;
+        beginRemoveRows(QModelIndex(), first, last);
+        for (int row=last; row>=first; row--) {
+            _disconnectDirty(_objectList[row], row);
+            currentSet.remove(_objectList[row]);
+            _objectList.removeAt(row);
+        }
+        endRemoveRows();
+    }
+
+    // What is left is in the new list, bring it to the new order and insert the rest around it
+    i = 0;
+    while (i < newList.count()) {
+        QObject* object = newList[i];
+
+        if (i < _objectList.count() && _objectList[i] == object) {
+            i++;
+        } else if (currentSet.contains(object)) {
+            int from = _objectList.indexOf(object, i + 1);
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), i);
+            _objectList.move(from, i);
+            endMoveRows();
+            i++;
+        } else {
+            int first = i;
+            while (i < newList.count() && !currentSet.contains(newList[i])) {
+                i++;
+            }
+            beginInsertRows(QModelIndex(), first, i - 1);
+            for (int row=first; row<i; row++) {
+                if (newList[row]) {
+                    QQmlEngine::setObjectOwnership(newList[row], QQmlEngine::CppOwnership);
+                }
+                _connectDirty(newList[row], row);
+                _objectList.insert(row, newList[row]);
+            }
+            endInsertRows();
+        }
+    }
+
+    if (count() != oldCount) {
+        emit countChanged(count());
+    }
+    setDirty(true);
+    return true;
+}
+
+void QmlObjectListModel::_connectDirty(QObject* object, int index)
+{
+    // Look for a dirtyChanged signal on the object
+    if (object && object->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
+        if (!_skipDirtyFirstItem || index != 0) {
+            QObject::connect(object, SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
+        }
+    }
+}
+
+void QmlObjectListModel::_disconnectDirty(QObject* object, int index)
+{
+    if (object && object->metaObject()->indexOfSignal(QMetaObject::normalizedSignature("dirtyChanged(bool)")) != -1) {
+        if (!_skipDirtyFirstItem || index != 0) {
+            QObject::disconnect(object, SIGNAL(dirtyChanged(bool)), this, SLOT(_childDirtyChanged(bool)));
+        }
+    }
+}
+
 QObjectList QmlObjectListModel::swapObjectList(const QObjectList& newlist)
 {
     QObjectList oldlist(_objectList);
@@ -38,6 +38,12 @@ public:
     void        append              (QObject* object);
     void        append              (QList<QObject*> objects);
     QObjectList swapObjectList      (const QObjectList& newlist);
+
+    /// Changes the list to newList with row removes, inserts and moves instead of a reset, so views keep the delegates
+    /// of the objects which stay. Contiguous rows are removed and inserted as one range. Objects which are dropped are
+    /// not deleted.
+    /// @return true: the list changed
+    bool        updateObjectList    (const QObjectList& newList);
     void        clear               ();
     QObject*    removeAt            (int i);
     QObject*    removeOne           (QObject* object) { return removeAt(indexOf(object)); }
@@ -71,6 +77,9 @@ private slots:
     void _childDirtyChanged         (bool dirty);
     
 private:
+    void _connectDirty      (QObject* object, int index);
+    void _disconnectDirty   (QObject* object, int index);
+
     // Overrides from QAbstractListModel
     int         rowCount    (const QModelIndex & parent = QModelIndex()) const override;
     QVariant    data        (const QModelIndex & index, int role = Qt::DisplayRole) const override;
@@ -0,0 +1,103 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QmlObjectListModelTest.h"
+#include "QmlObjectListModel.h"
+
+#include <QAbstractItemModelTester>
+#include <QSignalSpy>
+
+QmlObjectListModelTest::QmlObjectListModelTest(void)
+{
+
+}
+
+void QmlObjectListModelTest::_updateTest_data(void)
+{
+    // Lists are letters, each letter is one object
+    QTest::addColumn<QString>("oldList");
+    QTest::addColumn<QString>("newList");
+    QTest::addColumn<int>("insertSignals");
+    QTest::addColumn<int>("removeSignals");
+    QTest::addColumn<int>("moveSignals");
+
+    QTest::newRow("unchanged")      << "abcde"  << "abcde"  << 0 << 0 << 0;
+    QTest::newRow("append")         << "abc"    << "abcdef" << 1 << 0 << 0;
+    QTest::newRow("prepend")        << "abc"    << "xyabc"  << 1 << 0 << 0;
+    QTest::newRow("removeRun")      << "abcdef" << "af"     << 0 << 1 << 0;
+    QTest::newRow("removeRuns")     << "abcdef" << "bdf"    << 0 << 3 << 0;
+    QTest::newRow("narrowWiden")    << "abcdef" << "axcyf"  << 2 << 2 << 0;
+    QTest::newRow("moveToFront")    << "abcde"  << "eabcd"  << 0 << 0 << 1;
+    QTest::newRow("swap")           << "abcde"  << "aecdb"  << 0 << 0 << 3;
+    QTest::newRow("fromEmpty")      << ""       << "abc"    << 1 << 0 << 0;
+    QTest::newRow("toEmpty")        << "abc"    << ""       << 0 << 1 << 0;
+    QTest::newRow("replaceAll")     << "abc"    << "xyz"    << 1 << 1 << 0;
+}
+
+void QmlObjectListModelTest::_updateTest(void)
+{
+    QFETCH(QString, oldList);
+    QFETCH(QString, newList);
+    QFETCH(int,     insertSignals);
+    QFETCH(int,     removeSignals);
+    QFETCH(int,     moveSignals);
+
+    QHash<QChar, QObject*> objects;
+    for (QChar c: QStringLiteral("abcdefxyz")) {
+        objects[c] = new QObject(this);
+        objects[c]->setObjectName(c);
+    }
+
+    QmlObjectListModel model;
+    for (QChar c: oldList) {
+        model.append(objects[c]);
+    }
+
+    QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+
+    QSignalSpy resetSpy     (&model, &QAbstractItemModel::modelReset);
+    QSignalSpy insertSpy    (&model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy removeSpy    (&model, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy moveSpy      (&model, &QAbstractItemModel::rowsMoved);
+    QSignalSpy countSpy     (&model, &QmlObjectListModel::countChanged);
+
+    QObjectList newObjects;
+    for (QChar c: newList) {
+        newObjects.append(objects[c]);
+    }
+    QCOMPARE(model.updateObjectList(newObjects), oldList != newList);
+
+    QCOMPARE(*model.objectList(), newObjects);
+    QCOMPARE(resetSpy.count(),  0);
+    QCOMPARE(insertSpy.count(), insertSignals);
+    QCOMPARE(removeSpy.count(), removeSignals);
+    QCOMPARE(moveSpy.count(),   moveSignals);
+    QCOMPARE(countSpy.count(),  oldList.count() != newList.count() ? 1 : 0);
+}
+
+void QmlObjectListModelTest::_batchAppendTest(void)
+{
+    QmlObjectListModel model;
+    model.append(new QObject(this));
+
+    QSignalSpy insertSpy(&model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy countSpy (&model, &QmlObjectListModel::countChanged);
+
+    QObjectList objects;
+    for (int i=0; i<10; i++) {
+        objects.append(new QObject(this));
+    }
+    model.append(objects);
+
+    QCOMPARE(model.count(),     11);
+    QCOMPARE(insertSpy.count(), 1);
+    QCOMPARE(insertSpy[0][1].toInt(), 1);
+    QCOMPARE(insertSpy[0][2].toInt(), 10);
+    QCOMPARE(countSpy.count(),  1);
+}
@@ -0,0 +1,26 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for QmlObjectListModel::updateObjectList
+class QmlObjectListModelTest : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    QmlObjectListModelTest(void);
+
+private slots:
+    void _updateTest_data   (void);
+    void _updateTest        (void);
+    void _batchAppendTest   (void);
+};
@@ -13,21 +13,18 @@
 RCChannelMonitorController::RCChannelMonitorController(void)
     : _chanCount(0)
 {
-    connect(_vehicle, &Vehicle::rcChannelsChanged, this, &RCChannelMonitorController::_rcChannelsChanged);
+    connect(_vehicle,               &Vehicle::rcChannelsChanged,                this, &RCChannelMonitorController::_rcChannelsChanged);
+    connect(&_rcChannelThrottle,    &RCChannelThrottle::channelValueChanged,    this, &RCChannelMonitorController::channelRCValueChanged);
+    connect(&_rcChannelThrottle,    &RCChannelThrottle::valuesChanged,          this, &RCChannelMonitorController::channelRCValuesChanged);
 }
 
 void RCChannelMonitorController::_rcChannelsChanged(int channelCount, int pwmValues[Vehicle::cMaxRcChannels])
 {
-    for (int channel=0; channel<channelCount; channel++) {
-        int channelValue = pwmValues[channel];
-
-        if (_chanCount != channelCount) {
-            _chanCount = channelCount;
-            emit channelCountChanged(_chanCount);
-        }
-
-        if (channelValue != -1) {
-            emit channelRCValueChanged(channel, channelValue);
-        }
+    if (_chanCount != channelCount) {
+        _chanCount = channelCount;
+        emit channelCountChanged(_chanCount);
     }
+
+    // Values reach Qml through the throttle, once per display frame
+    _rcChannelThrottle.update(channelCount, pwmValues);
 }
@@ -17,6 +17,7 @@
 #include "UASInterface.h"
 #include "QGCLoggingCategory.h"
 #include "AutoPilotPlugin.h"
+#include "RCChannelThrottle.h"
 
 class RCChannelMonitorController : public FactPanelController
 {
@@ -25,19 +26,25 @@ class RCChannelMonitorController : public FactPanelController
 public:
     RCChannelMonitorController(void);
     
-    Q_PROPERTY(int channelCount READ channelCount NOTIFY channelCountChanged)
-        
-    int channelCount(void) { return _chanCount; }
-    
+    Q_PROPERTY(int          channelCount    READ channelCount       NOTIFY channelCountChanged)
+    Q_PROPERTY(QVariantList channelRCValues READ channelRCValues    NOTIFY channelRCValuesChanged)
+
+    int             channelCount    (void)       { return _chanCount; }
+    QVariantList    channelRCValues (void) const { return _rcChannelThrottle.values(); }
+
 signals:
     void channelCountChanged(int channelCount);
+
+    /// Signalled at most once per display frame, only for channels which moved more than the deadband
     void channelRCValueChanged(int channel, int rcValue);
+    void channelRCValuesChanged(void);
 
 private slots:
     void _rcChannelsChanged(int channelCount, int pwmValues[Vehicle::cMaxRcChannels]);
 
 private:
-    int _chanCount;
+    int                 _chanCount;
+    RCChannelThrottle   _rcChannelThrottle;
 };
 
 #endif // RCChannelMonitorController_H
@@ -0,0 +1,78 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "RCChannelThrottle.h"
+
+#include <cstdlib>
+
+RCChannelThrottle::RCChannelThrottle(QObject* parent)
+    : QObject(parent)
+{
+    for (int i=0; i<Vehicle::cMaxRcChannels; i++) {
+        _values[i]          = -1;
+        _publishedValues[i] = -1;
+    }
+
+    _frameTimer.setSingleShot(true);
+    _frameTimer.setInterval(frameMSecs);
+    connect(&_frameTimer, &QGCWheelTimer::timeout, this, &RCChannelThrottle::_publish);
+}
+
+void RCChannelThrottle::update(int channelCount, const int pwmValues[Vehicle::cMaxRcChannels])
+{
+    _channelCount = qBound(0, channelCount, static_cast<int>(Vehicle::cMaxRcChannels));
+
+    bool publish = false;
+    for (int channel=0; channel<_channelCount; channel++) {
+        int channelValue = pwmValues[channel];
+        if (channelValue != -1) {
+            _values[channel] = channelValue;
+            if (_publishedValues[channel] == -1 || std::abs(channelValue - _publishedValues[channel]) > deadband) {
+                publish = true;
+            }
+        }
+    }
+
+    if (publish && !_frameTimer.isActive()) {
+        _frameTimer.start();
+    }
+}
+
+void RCChannelThrottle::_publish(void)
+{
+    bool changed = false;
+    for (int channel=0; channel<_channelCount; channel++) {
+        int channelValue = _values[channel];
+        if (channelValue != -1 && (_publishedValues[channel] == -1 || std::abs(channelValue - _publishedValues[channel]) > deadband)) {
+            _publishedValues[channel] = channelValue;
+            changed = true;
+            emit channelValueChanged(channel, channelValue);
+        }
+    }
+    if (changed) {
+        emit valuesChanged();
+    }
+}
+
+QVariantList RCChannelThrottle::values(void) const
+{
+    QVariantList list;
+    for (int channel=0; channel<_channelCount; channel++) {
+        list.append(_publishedValues[channel]);
+    }
+    return list;
+}
+
+int RCChannelThrottle::value(int channel) const
+{
+    if (channel < 0 || channel >= Vehicle::cMaxRcChannels) {
+        return -1;
+    }
+    return _publishedValues[channel];
+}
@@ -0,0 +1,54 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCTimerWheel.h"
+#include "Vehicle.h"
+
+#include <QObject>
+#include <QVariantList>
+
+/// Publishes the RC channel values from Vehicle::rcChannelsChanged to Qml at most once per display frame.
+///
+/// Values are stored as they arrive. Once a frame, every channel which moved more than deadband since it was last
+/// published gets its own channelValueChanged, followed by a single valuesChanged for all of them. Jitter within the
+/// deadband isn't published at all, so a radio sitting still doesn't cost anything.
+class RCChannelThrottle : public QObject
+{
+    Q_OBJECT
+
+public:
+    RCChannelThrottle(QObject* parent = nullptr);
+
+    /// Stores the values of an RC_CHANNELS message. Channels without a value (-1) keep their previous value.
+    void update(int channelCount, const int pwmValues[Vehicle::cMaxRcChannels]);
+
+    /// @return Published value of each channel, -1 for channels which haven't had a value yet
+    QVariantList values(void) const;
+
+    /// @return Published value of the channel, -1 if it hasn't had a value yet
+    int value(int channel) const;
+
+    static const int frameMSecs = 16;   ///< Rounded up to the timer wheel tick
+    static const int deadband   = 2;    ///< Published values only move once the value is further than this from them
+
+signals:
+    void channelValueChanged(int channel, int value);
+    void valuesChanged      (void);
+
+private slots:
+    void _publish(void);
+
+private:
+    int             _values         [Vehicle::cMaxRcChannels];
+    int             _publishedValues[Vehicle::cMaxRcChannels];
+    int             _channelCount   = 0;
+    QGCWheelTimer   _frameTimer     { "RCChannels" };
+};
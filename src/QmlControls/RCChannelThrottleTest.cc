@@ -0,0 +1,82 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "RCChannelThrottleTest.h"
+#include "RCChannelThrottle.h"
+
+#include <QSignalSpy>
+
+static void _setValues(int pwmValues[Vehicle::cMaxRcChannels], int value)
+{
+    for (int i=0; i<Vehicle::cMaxRcChannels; i++) {
+        pwmValues[i] = value;
+    }
+}
+
+void RCChannelThrottleTest::_batchTest(void)
+{
+    RCChannelThrottle   throttle;
+    QSignalSpy          channelSpy(&throttle, &RCChannelThrottle::channelValueChanged);
+    QSignalSpy          valuesSpy(&throttle, &RCChannelThrottle::valuesChanged);
+    int                 pwmValues[Vehicle::cMaxRcChannels];
+
+    QCOMPARE(throttle.value(0), -1);
+
+    // A burst of messages is published once, with the latest values
+    for (int i=0; i<10; i++) {
+        _setValues(pwmValues, 1100 + (i * 10));
+        pwmValues[7] = -1;
+        throttle.update(8, pwmValues);
+    }
+    QCOMPARE(valuesSpy.count(), 0);
+    QVERIFY(valuesSpy.wait(1000));
+    QCOMPARE(valuesSpy.count(), 1);
+    QCOMPARE(channelSpy.count(), 7);
+    QCOMPARE(channelSpy[0][0].toInt(), 0);
+    QCOMPARE(channelSpy[0][1].toInt(), 1190);
+
+    // Channels without a value stay unpublished
+    QVariantList values = throttle.values();
+    QCOMPARE(values.count(), 8);
+    QCOMPARE(values[0].toInt(), 1190);
+    QCOMPARE(values[7].toInt(), -1);
+    QCOMPARE(throttle.value(7), -1);
+}
+
+void RCChannelThrottleTest::_deadbandTest(void)
+{
+    RCChannelThrottle   throttle;
+    QSignalSpy          channelSpy(&throttle, &RCChannelThrottle::channelValueChanged);
+    QSignalSpy          valuesSpy(&throttle, &RCChannelThrottle::valuesChanged);
+    int                 pwmValues[Vehicle::cMaxRcChannels];
+
+    _setValues(pwmValues, 1500);
+    throttle.update(4, pwmValues);
+    QVERIFY(valuesSpy.wait(1000));
+    channelSpy.clear();
+    valuesSpy.clear();
+
+    // Jitter within the deadband isn't published
+    pwmValues[0] = 1500 + RCChannelThrottle::deadband;
+    pwmValues[1] = 1500 - RCChannelThrottle::deadband;
+    throttle.update(4, pwmValues);
+    QTest::qWait(RCChannelThrottle::frameMSecs * 5);
+    QCOMPARE(valuesSpy.count(), 0);
+    QCOMPARE(channelSpy.count(), 0);
+    QCOMPARE(throttle.value(0), 1500);
+
+    // Only the channel which moved past it is
+    pwmValues[2] = 1600;
+    throttle.update(4, pwmValues);
+    QVERIFY(valuesSpy.wait(1000));
+    QCOMPARE(channelSpy.count(), 1);
+    QCOMPARE(channelSpy[0][0].toInt(), 2);
+    QCOMPARE(channelSpy[0][1].toInt(), 1600);
+    QCOMPARE(throttle.value(0), 1500);
+}
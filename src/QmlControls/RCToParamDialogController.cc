@@ -25,7 +25,7 @@ RCToParamDialogController::RCToParamDialogController(void)
     , _maxFact      (0, _maxFactName,       FactMetaData::valueTypeDouble)
 {
     if (_metaDataMap.isEmpty()) {
-        _metaDataMap = FactMetaData::createMapFromJsonFile(QStringLiteral(":/json/RCToParamDialog.FactMetaData.json"), nullptr /* QObject parent */);
+        _metaDataMap = FactMetaData::sharedMapFromJsonFile(QStringLiteral(":/json/RCToParamDialog.FactMetaData.json"));
     }
 
     _scaleFact.setMetaData  (_metaDataMap[_scaleFactName],  true /* setDefaultFromMetaData */);
@@ -14,8 +14,12 @@
 #include "SimpleMissionItem.h"
 #include "ComplexMissionItem.h"
 
+#include <QMatrix4x4>
+#include <QSGFlatColorMaterial>
 #include <QSGSimpleRectNode>
 
+#include <cmath>
+
 QGC_LOGGING_CATEGORY(TerrainProfileLog, "TerrainProfileLog")
 
 TerrainProfile::TerrainProfile(QQuickItem* parent)
@@ -57,157 +61,260 @@ void TerrainProfile::_newVisualItems(void)
     emit _updateSignal();
 }
 
-void TerrainProfile::_createGeometry(QSGGeometryNode*& geometryNode, QSGGeometry*& geometry, QSGGeometry::DrawingMode drawingMode, const QColor& color)
+static bool _sameValue(double value1, double value2)
+{
+    return value1 == value2 || (qIsNaN(value1) && qIsNaN(value2));
+}
+
+TerrainProfileSegmentNode::TerrainProfileSegmentNode(void)
+{
+    // Later children draw on top
+    _terrainProfileNode =   _createGeometryNode(QSGGeometry::DrawLineStrip, "green");
+    _missingTerrainNode =   _createGeometryNode(QSGGeometry::DrawLines,     "yellow");
+    _flightProfileNode =    _createGeometryNode(QSGGeometry::DrawLines,     "orange");
+    _terrainCollisionNode = _createGeometryNode(QSGGeometry::DrawLines,     "red");
+}
+
+QSGGeometryNode* TerrainProfileSegmentNode::_createGeometryNode(QSGGeometry::DrawingMode drawingMode, const QColor& color)
 {
     QSGFlatColorMaterial* terrainMaterial = new QSGFlatColorMaterial;
     terrainMaterial->setColor(color);
 
-    geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
+    QSGGeometry* geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
     geometry->setDrawingMode(drawingMode);
     geometry->setLineWidth(2);
 
-    geometryNode = new QSGGeometryNode;
+    QSGGeometryNode* geometryNode = new QSGGeometryNode;
     geometryNode->setFlag(QSGNode::OwnsGeometry);
     geometryNode->setFlag(QSGNode::OwnsMaterial);
     geometryNode->setFlag(QSGNode::OwnedByParent);
     geometryNode->setMaterial(terrainMaterial);
     geometryNode->setGeometry(geometry);
+    appendChildNode(geometryNode);
+
+    return geometryNode;
 }
 
-void TerrainProfile::_updateSegmentCounts(FlightPathSegment* segment, int& cFlightProfileSegments, int& cTerrainProfilePoints, int& cMissingTerrainSegments, int& cTerrainCollisionSegments, double& minTerrainHeight, double& maxTerrainHeight)
+void TerrainProfileSegmentNode::_setVertices(QSGGeometryNode* node, const QVector<QPointF>& vertices)
 {
-    if (_shouldAddFlightProfileSegment(segment)) {
-        cFlightProfileSegments++;
+    QSGGeometry* geometry = node->geometry();
+    geometry->allocate(vertices.count());
+
+    QSGGeometry::Point2D* geometryVertices = geometry->vertexDataAsPoint2D();
+    for (int i=0; i<vertices.count(); i++) {
+        geometryVertices[i].set(static_cast<float>(vertices[i].x()), static_cast<float>(vertices[i].y()));
     }
+    node->markDirty(QSGNode::DirtyGeometry);
+}
 
+void TerrainProfileSegmentNode::updateTerrainRange(FlightPathSegment* segment)
+{
     if (_shouldAddMissingTerrainSegment(segment)) {
-        cMissingTerrainSegments += 1;
-    } else {
-        cTerrainProfilePoints += segment->amslTerrainHeights().count();
-        for (int i=0; i<segment->amslTerrainHeights().count(); i++) {
-            minTerrainHeight = std::fmin(minTerrainHeight, segment->amslTerrainHeights()[i].value<double>());
-            maxTerrainHeight = std::fmax(maxTerrainHeight, segment->amslTerrainHeights()[i].value<double>());
-        }
+        minTerrainHeight = qQNaN();
+        maxTerrainHeight = qQNaN();
+        _rangeHeights.clear();
+        return;
     }
-    if (segment->terrainCollision()) {
-        cTerrainCollisionSegments++;
+    if (_rangeHeights.isEmpty() || _rangeHeights != segment->amslTerrainHeights()) {
+        _rangeHeights = segment->amslTerrainHeights();
+        minTerrainHeight = qQNaN();
+        maxTerrainHeight = qQNaN();
+        for (int i=0; i<_rangeHeights.count(); i++) {
+            minTerrainHeight = std::fmin(minTerrainHeight, _rangeHeights[i].value<double>());
+            maxTerrainHeight = std::fmax(maxTerrainHeight, _rangeHeights[i].value<double>());
+        }
     }
 }
 
-void TerrainProfile::_addTerrainProfileSegment(FlightPathSegment* segment, double currentDistance, double amslAltRange, QSGGeometry::Point2D* terrainVertices, int& terrainProfileVertexIndex)
+bool TerrainProfileSegmentNode::update(FlightPathSegment* segment, double lodMeters, double bottomAMSLAlt)
 {
-    double terrainDistance = 0;
-    for (int heightIndex=0; heightIndex<segment->amslTerrainHeights().count(); heightIndex++) {
-        // Move along the x axis which is distance
-        if (heightIndex == 0) {
-            // The first point in the segment is at the position of the last point. So nothing to do here.
-        } else if (heightIndex == segment->amslTerrainHeights().count() - 2) {
-            // The distance between the last two heights differs with each terrain query
-            terrainDistance += segment->finalDistanceBetween();
-        } else {
-            // The distance between all terrain heights except for the last is the same
-            terrainDistance += segment->distanceBetween();
+    bool terrainChanged =   !_built ||
+                            _amslTerrainHeights != segment->amslTerrainHeights() ||
+                            _distanceBetween != segment->distanceBetween() ||
+                            _finalDistanceBetween != segment->finalDistanceBetween() ||
+                            _lodMeters != lodMeters;
+    bool pathChanged =      !_built ||
+                            !_sameValue(_coord1AMSLAlt, segment->coord1AMSLAlt()) ||
+                            !_sameValue(_coord2AMSLAlt, segment->coord2AMSLAlt()) ||
+                            _totalDistance != segment->totalDistance() ||
+                            _terrainCollision != segment->terrainCollision();
+    bool bottomChanged =    !_built ||
+                            !_sameValue(_bottomAMSLAlt, bottomAMSLAlt);
+
+    if (terrainChanged) {
+        QVector<QPointF> vertices;
+        double           terrainDistance = 0;
+
+        vertices.reserve(segment->amslTerrainHeights().count());
+        for (int heightIndex=0; heightIndex<segment->amslTerrainHeights().count(); heightIndex++) {
+            // Move along the x axis which is distance
+            if (heightIndex == 0) {
+                // The first point in the segment is at the position of the last point. So nothing to do here.
+            } else if (heightIndex == segment->amslTerrainHeights().count() - 2) {
+                // The distance between the last two heights differs with each terrain query
+                terrainDistance += segment->finalDistanceBetween();
+            } else {
+                // The distance between all terrain heights except for the last is the same
+                terrainDistance += segment->distanceBetween();
+            }
+            vertices.append(QPointF(terrainDistance, segment->amslTerrainHeights()[heightIndex].value<double>()));
         }
+        if (lodMeters > 0) {
+            vertices = TerrainProfile::decimateProfile(vertices, lodMeters);
+        }
+        _setVertices(_terrainProfileNode, vertices);
+    }
 
-        // Move along the y axis which is a view or terrain height as a percentage between the min/max AMSL altitude for all segments
-        double amslTerrainHeight    = segment->amslTerrainHeights()[heightIndex].value<double>();
-        double terrainHeightPercent = (amslTerrainHeight - _minAMSLAlt) / amslAltRange;
+    if (pathChanged) {
+        QVector<QPointF> vertices;
+        if (_shouldAddFlightProfileSegment(segment)) {
+            vertices.append(QPointF(0,                          segment->coord1AMSLAlt()));
+            vertices.append(QPointF(segment->totalDistance(),   segment->coord2AMSLAlt()));
+        }
+        _setVertices(_flightProfileNode, vertices);
+        _setVertices(_terrainCollisionNode, segment->terrainCollision() ? vertices : QVector<QPointF>());
+    }
 
-        float x = (currentDistance + terrainDistance) * _pixelsPerMeter;
-        float y = height() - (terrainHeightPercent * height());
-        terrainVertices[terrainProfileVertexIndex++].set(x, y);
+    if (terrainChanged || pathChanged || bottomChanged) {
+        QVector<QPointF> vertices;
+        if (_shouldAddMissingTerrainSegment(segment)) {
+            vertices.append(QPointF(0,                          bottomAMSLAlt));
+            vertices.append(QPointF(segment->totalDistance(),   bottomAMSLAlt));
+        }
+        _setVertices(_missingTerrainNode, vertices);
     }
+
+    _built =                true;
+    _amslTerrainHeights =   segment->amslTerrainHeights();
+    _coord1AMSLAlt =        segment->coord1AMSLAlt();
+    _coord2AMSLAlt =        segment->coord2AMSLAlt();
+    _distanceBetween =      segment->distanceBetween();
+    _finalDistanceBetween = segment->finalDistanceBetween();
+    _totalDistance =        segment->totalDistance();
+    _terrainCollision =     segment->terrainCollision();
+    _lodMeters =            lodMeters;
+    _bottomAMSLAlt =        bottomAMSLAlt;
+
+    return terrainChanged;
 }
 
-void TerrainProfile::_addMissingTerrainSegment(FlightPathSegment* segment, double currentDistance, QSGGeometry::Point2D* missingTerrainVertices, int& missingterrainProfileVertexIndex)
+bool TerrainProfileSegmentNode::_shouldAddFlightProfileSegment(FlightPathSegment* segment) const
 {
-    if (_shouldAddMissingTerrainSegment(segment)) {
-        float x = currentDistance * _pixelsPerMeter;
-        float y = height();
-        missingTerrainVertices[missingterrainProfileVertexIndex++].set(x, y);
-        missingTerrainVertices[missingterrainProfileVertexIndex++].set(x + (segment->totalDistance() * _pixelsPerMeter), y);
-    }
+    return !qIsNaN(segment->coord1AMSLAlt()) && !qIsNaN(segment->coord2AMSLAlt());
 }
 
-void TerrainProfile::_addTerrainCollisionSegment(FlightPathSegment* segment, double currentDistance, double amslAltRange, QSGGeometry::Point2D* terrainCollisionVertices, int& terrainCollisionVertexIndex)
+bool TerrainProfileSegmentNode::_shouldAddMissingTerrainSegment(FlightPathSegment* segment) const
 {
-    if (segment->terrainCollision()) {
-        double amslCoord1Height =       segment->coord1AMSLAlt();
-        double amslCoord2Height =       segment->coord2AMSLAlt();
-        double coord1HeightPercent =    (amslCoord1Height - _minAMSLAlt) / amslAltRange;
-        double coord2HeightPercent =    (amslCoord2Height - _minAMSLAlt) / amslAltRange;
+    return segment->amslTerrainHeights().count() == 0;
+}
+
+QVector<QPointF> TerrainProfile::decimateProfile(const QVector<QPointF>& points, double bucketWidth)
+{
+    if (bucketWidth <= 0 || points.count() <= 2) {
+        return points;
+    }
 
-        float x = currentDistance * _pixelsPerMeter;
-        float y = height() - (coord1HeightPercent * height());
+    QVector<QPointF>    decimated;
+    int                 lastIndex = points.count() - 1;
+    int                 index =     1;
 
-        terrainCollisionVertices[terrainCollisionVertexIndex++].set(x, y);
+    decimated.append(points.first());
+    while (index < lastIndex) {
+        double  bucket =    std::floor(points[index].x() / bucketWidth);
+        int     minIndex =  index;
+        int     maxIndex =  index;
 
-        x += segment->totalDistance() * _pixelsPerMeter;
-        y = height() - (coord2HeightPercent * height());
+        for (index++; index < lastIndex && std::floor(points[index].x() / bucketWidth) == bucket; index++) {
+            if (points[index].y() < points[minIndex].y()) {
+                minIndex = index;
+            }
+            if (points[index].y() > points[maxIndex].y()) {
+                maxIndex = index;
+            }
+        }
 
-        terrainCollisionVertices[terrainCollisionVertexIndex++].set(x, y);
+        if (minIndex == maxIndex) {
+            decimated.append(points[minIndex]);
+        } else {
+            decimated.append(points[qMin(minIndex, maxIndex)]);
+            decimated.append(points[qMax(minIndex, maxIndex)]);
+        }
     }
+    decimated.append(points.last());
+
+    return decimated;
 }
 
-void TerrainProfile::_addFlightProfileSegment(FlightPathSegment* segment, double currentDistance, double amslAltRange, QSGGeometry::Point2D* flightProfileVertices, int& flightProfileVertexIndex)
+double TerrainProfile::_lodMeters(FlightPathSegment* segment) const
 {
-    if (!_shouldAddFlightProfileSegment(segment)) {
-        return;
+    // Decimate once there are more terrain points than pixels to show them in
+    double pixels = segment->totalDistance() * _pixelsPerMeter;
+    if (!qIsFinite(pixels) || _pixelsPerMeter <= 0 || segment->amslTerrainHeights().count() <= pixels) {
+        return 0;
     }
 
-    double amslCoord1Height =       segment->coord1AMSLAlt();
-    double amslCoord2Height =       segment->coord2AMSLAlt();
-    double coord1HeightPercent =    (amslCoord1Height - _minAMSLAlt) / amslAltRange;
-    double coord2HeightPercent =    (amslCoord2Height - _minAMSLAlt) / amslAltRange;
-
-    float x = currentDistance * _pixelsPerMeter;
-    float y = height() - (coord1HeightPercent * height());
-
-    flightProfileVertices[flightProfileVertexIndex++].set(x, y);
-
-    x += segment->totalDistance() * _pixelsPerMeter;
-    y = height() - (coord2HeightPercent * height());
-
-    flightProfileVertices[flightProfileVertexIndex++].set(x, y);
+    // Power of two steps so zooming only re-tessellates when the level of detail actually changes
+    return std::pow(2.0, std::ceil(std::log2(1.0 / _pixelsPerMeter)));
 }
 
 QSGNode* TerrainProfile::updatePaintNode(QSGNode* oldNode, QQuickItem::UpdatePaintNodeData* /*updatePaintNodeData*/)
 {
-    QSGNode*        rootNode =                  static_cast<QSGNode *>(oldNode);
-    QSGGeometry*    terrainProfileGeometry =    nullptr;
-    QSGGeometry*    missingTerrainGeometry =    nullptr;
-    QSGGeometry*    flightProfileGeometry =     nullptr;
-    QSGGeometry*    terrainCollisionGeometry =  nullptr;
-    int             cTerrainProfilePoints =     0;
-    int             cMissingTerrainSegments =   0;
-    int             cFlightProfileSegments =    0;
-    int             cTerrainCollisionSegments = 0;
-    double          minTerrainHeight =          qQNaN();
-    double          maxTerrainHeight =          qQNaN();
-
-    // First we need to determine:
-    //  - how many terrain profile vertices we need
-    //  - how many missing terrain segments there are
-    //  - how many flight profile segments we need
-    //  - how many terrain collision segments there are
-    //  - what is the total distance so we can calculate pixels per meter
+    TerrainProfileNode* rootNode =                  static_cast<TerrainProfileNode*>(oldNode);
+    int                 cTerrainProfileSegments =   0;
+    int                 cRebuiltSegments =          0;
+    double              currentDistance =           0;
+    double              minTerrainHeight =          qQNaN();
+    double              maxTerrainHeight =          qQNaN();
+
+    if (!rootNode) {
+        rootNode = new TerrainProfileNode;
+    }
+
+    // Flight path segments in profile order, along with the distance at which they start
+    QList<QPair<FlightPathSegment*, double>> segments;
 
     for (int viIndex=0; viIndex<_visualItems->count(); viIndex++) {
         VisualMissionItem*  visualItem =    _visualItems->value<VisualMissionItem*>(viIndex);
         ComplexMissionItem* complexItem =   _visualItems->value<ComplexMissionItem*>(viIndex);
 
+        if (complexItem) {
+            if (complexItem->flightPathSegments()->count() == 0) {
+                currentDistance += complexItem->complexDistance();
+            } else {
+                for (int segmentIndex=0; segmentIndex<complexItem->flightPathSegments()->count(); segmentIndex++) {
+                    FlightPathSegment* segment = complexItem->flightPathSegments()->value<FlightPathSegment*>(segmentIndex);
+                    segments.append(qMakePair(segment, currentDistance));
+                    currentDistance += segment->totalDistance();
+                }
+            }
+        }
+
         if (visualItem->simpleFlightPathSegment()) {
             FlightPathSegment* segment = visualItem->simpleFlightPathSegment();
-            _updateSegmentCounts(segment, cFlightProfileSegments, cTerrainProfilePoints, cMissingTerrainSegments, cTerrainCollisionSegments, minTerrainHeight, maxTerrainHeight);
+            segments.append(qMakePair(segment, currentDistance));
+            currentDistance += segment->totalDistance();
         }
+    }
 
-        if (complexItem) {
-            for (int segmentIndex=0; segmentIndex<complexItem->flightPathSegments()->count(); segmentIndex++) {
-                FlightPathSegment* segment = complexItem->flightPathSegments()->value<FlightPathSegment*>(segmentIndex);
-                _updateSegmentCounts(segment, cFlightProfileSegments, cTerrainProfilePoints, cMissingTerrainSegments, cTerrainCollisionSegments, minTerrainHeight, maxTerrainHeight);
-            }
+    // Pick up the nodes of the segments which are still there, the others go away
+    QHash<FlightPathSegment*, TerrainProfileSegmentNode*> segmentNodes;
+    for (const auto& segmentPair: segments) {
+        TerrainProfileSegmentNode* segmentNode = rootNode->segmentNodes.take(segmentPair.first);
+        if (!segmentNode) {
+            segmentNode = new TerrainProfileSegmentNode;
+            rootNode->appendChildNode(segmentNode);
         }
+        segmentNodes[segmentPair.first] = segmentNode;
+
+        segmentNode->updateTerrainRange(segmentPair.first);
+        minTerrainHeight = std::fmin(minTerrainHeight, segmentNode->minTerrainHeight);
+        maxTerrainHeight = std::fmax(maxTerrainHeight, segmentNode->maxTerrainHeight);
+    }
+    for (TerrainProfileSegmentNode* segmentNode: rootNode->segmentNodes) {
+        rootNode->removeChildNode(segmentNode);
+        delete segmentNode;
     }
+    rootNode->segmentNodes = segmentNodes;
 
     // The profile view min/max is setup to include a full terrain profile as well as the flight path segments.
     _minAMSLAlt = std::fmin(_missionController->minAMSLAltitude(), minTerrainHeight);
@@ -223,99 +330,43 @@ QSGNode* TerrainProfile::updatePaintNode(QSGNode* oldNode, QQuickItem::UpdatePai
     }
     amslAltRange = _maxAMSLAlt - _minAMSLAlt;
 
-    static int counter = 0;
-    qCDebug(TerrainProfileLog) << "missionController min/max" << _missionController->minAMSLAltitude() << _missionController->maxAMSLAltitude();
-    qCDebug(TerrainProfileLog) << QStringLiteral("updatePaintNode counter:%1 cFlightProfileSegments:%2 cTerrainProfilePoints:%3 cMissingTerrainSegments:%4 cTerrainCollisionSegments:%5 _minAMSLAlt:%6 _maxAMSLAlt:%7 maxTerrainHeight:%8")
-                               .arg(counter++).arg(cFlightProfileSegments).arg(cTerrainProfilePoints).arg(cMissingTerrainSegments).arg(cTerrainCollisionSegments).arg(_minAMSLAlt).arg(_maxAMSLAlt).arg(maxTerrainHeight);
-
     _pixelsPerMeter = _visibleWidth / _missionController->missionDistance();
 
-    // Instantiate nodes
-    if (!rootNode) {
-        rootNode = new QSGNode;
-
-        QSGGeometryNode* terrainProfileNode =   nullptr;
-        QSGGeometryNode* missingTerrainNode =   nullptr;
-        QSGGeometryNode* flightProfileNode =    nullptr;
-        QSGGeometryNode* terrainCollisionNode = nullptr;
-
-        _createGeometry(terrainProfileNode,     terrainProfileGeometry,     QSGGeometry::DrawLineStrip, "green");
-        _createGeometry(missingTerrainNode,     missingTerrainGeometry,     QSGGeometry::DrawLines,     "yellow");
-        _createGeometry(flightProfileNode,      flightProfileGeometry,      QSGGeometry::DrawLines,     "orange");
-        _createGeometry(terrainCollisionNode,   terrainCollisionGeometry,   QSGGeometry::DrawLines,     "red");
-
-        rootNode->appendChildNode(terrainProfileNode);
-        rootNode->appendChildNode(missingTerrainNode);
-        rootNode->appendChildNode(flightProfileNode);
-        rootNode->appendChildNode(terrainCollisionNode);
+    // Distance along x is scaled to pixels, y is the AMSL altitude as a percentage between the min/max AMSL altitude,
+    // with the min at the bottom
+    QMatrix4x4 profileMatrix;
+    if (amslAltRange > 0 && qIsFinite(_pixelsPerMeter)) {
+        profileMatrix.translate(0, static_cast<float>(height() + (_minAMSLAlt * height() / amslAltRange)));
+        profileMatrix.scale(static_cast<float>(_pixelsPerMeter), static_cast<float>(-height() / amslAltRange));
+    }
+    if (rootNode->matrix() != profileMatrix) {
+        rootNode->setMatrix(profileMatrix);
     }
 
-    // Allocate space for the vertices
-
-    QSGNode* node = rootNode->childAtIndex(0);
-    terrainProfileGeometry = static_cast<QSGGeometryNode*>(node)->geometry();
-    terrainProfileGeometry->allocate(cTerrainProfilePoints);
-    node->markDirty(QSGNode::DirtyGeometry);
-
-    node = rootNode->childAtIndex(1);
-    missingTerrainGeometry = static_cast<QSGGeometryNode*>(node)->geometry();
-    missingTerrainGeometry->allocate(cMissingTerrainSegments * 2);
-    node->markDirty(QSGNode::DirtyGeometry);
-
-    node = rootNode->childAtIndex(2);
-    flightProfileGeometry = static_cast<QSGGeometryNode*>(node)->geometry();
-    flightProfileGeometry->allocate(cFlightProfileSegments * 2);
-    node->markDirty(QSGNode::DirtyGeometry);
-
-    node = rootNode->childAtIndex(3);
-    terrainCollisionGeometry = static_cast<QSGGeometryNode*>(node)->geometry();
-    terrainCollisionGeometry->allocate(cTerrainCollisionSegments * 2);
-    node->markDirty(QSGNode::DirtyGeometry);
-
-    int                     flightProfileVertexIndex =          0;
-    int                     terrainProfileVertexIndex =         0;
-    int                     missingterrainProfileVertexIndex =  0;
-    int                     terrainCollisionVertexIndex =       0;
-    double                  currentDistance =                   0;
-    QSGGeometry::Point2D*   flightProfileVertices =             flightProfileGeometry->vertexDataAsPoint2D();
-    QSGGeometry::Point2D*   terrainProfileVertices =            terrainProfileGeometry->vertexDataAsPoint2D();
-    QSGGeometry::Point2D*   missingTerrainVertices =            missingTerrainGeometry->vertexDataAsPoint2D();
-    QSGGeometry::Point2D*   terrainCollisionVertices =          terrainCollisionGeometry->vertexDataAsPoint2D();
-
-    // This step places the vertices for display into the nodes
-    for (int viIndex=0; viIndex<_visualItems->count(); viIndex++) {
-        VisualMissionItem*  visualItem =    _visualItems->value<VisualMissionItem*>(viIndex);
-        ComplexMissionItem* complexItem =   _visualItems->value<ComplexMissionItem*>(viIndex);
-
-        if (complexItem) {
-            if (complexItem->flightPathSegments()->count() == 0) {
-                currentDistance += complexItem->complexDistance();
-            } else {
-                for (int segmentIndex=0; segmentIndex<complexItem->flightPathSegments()->count(); segmentIndex++) {
-                    FlightPathSegment* segment = complexItem->flightPathSegments()->value<FlightPathSegment*>(segmentIndex);
-
-                    _addFlightProfileSegment    (segment, currentDistance, amslAltRange,    flightProfileVertices,      flightProfileVertexIndex);
-                    _addTerrainProfileSegment   (segment, currentDistance, amslAltRange,    terrainProfileVertices,     terrainProfileVertexIndex);
-                    _addMissingTerrainSegment   (segment, currentDistance,                  missingTerrainVertices,     missingterrainProfileVertexIndex);
-                    _addTerrainCollisionSegment (segment, currentDistance, amslAltRange,    terrainCollisionVertices,   terrainCollisionVertexIndex);
+    // This step moves the segments into place and rebuilds the geometry of the ones which changed
+    for (const auto& segmentPair: segments) {
+        FlightPathSegment*          segment =       segmentPair.first;
+        TerrainProfileSegmentNode*  segmentNode =   rootNode->segmentNodes[segment];
 
-                    currentDistance += segment->totalDistance();
-                }
-            }
+        QMatrix4x4 segmentMatrix;
+        segmentMatrix.translate(static_cast<float>(segmentPair.second), 0);
+        if (segmentNode->matrix() != segmentMatrix) {
+            segmentNode->setMatrix(segmentMatrix);
         }
 
-        if (visualItem->simpleFlightPathSegment()) {
-            FlightPathSegment* segment = visualItem->simpleFlightPathSegment();
-
-            _addFlightProfileSegment    (segment, currentDistance, amslAltRange,    flightProfileVertices,      flightProfileVertexIndex);
-            _addTerrainProfileSegment   (segment, currentDistance, amslAltRange,    terrainProfileVertices,     terrainProfileVertexIndex);
-            _addMissingTerrainSegment   (segment, currentDistance,                  missingTerrainVertices,     missingterrainProfileVertexIndex);
-            _addTerrainCollisionSegment (segment, currentDistance, amslAltRange,    terrainCollisionVertices,   terrainCollisionVertexIndex);
-
-            currentDistance += segment->totalDistance();
+        if (segmentNode->update(segment, _lodMeters(segment), _minAMSLAlt)) {
+            cRebuiltSegments++;
+        }
+        if (!segment->amslTerrainHeights().isEmpty()) {
+            cTerrainProfileSegments++;
         }
     }
 
+    static int counter = 0;
+    qCDebug(TerrainProfileLog) << "missionController min/max" << _missionController->minAMSLAltitude() << _missionController->maxAMSLAltitude();
+    qCDebug(TerrainProfileLog) << QStringLiteral("updatePaintNode counter:%1 cSegments:%2 cTerrainProfileSegments:%3 cRebuiltSegments:%4 _minAMSLAlt:%5 _maxAMSLAlt:%6 maxTerrainHeight:%7")
+                               .arg(counter++).arg(segments.count()).arg(cTerrainProfileSegments).arg(cRebuiltSegments).arg(_minAMSLAlt).arg(_maxAMSLAlt).arg(maxTerrainHeight);
+
     setImplicitWidth(_visibleWidth/*(_totalDistance * pixelsPerMeter) + (_horizontalMargin * 2)*/);
     setWidth(implicitWidth());
 
@@ -327,13 +378,3 @@ QSGNode* TerrainProfile::updatePaintNode(QSGNode* oldNode, QQuickItem::UpdatePai
 
     return rootNode;
 }
-
-bool TerrainProfile::_shouldAddFlightProfileSegment  (FlightPathSegment* segment)
-{
-    return !qIsNaN(segment->coord1AMSLAlt()) && !qIsNaN(segment->coord2AMSLAlt());
-}
-
-bool TerrainProfile::_shouldAddMissingTerrainSegment (FlightPathSegment* segment)
-{
-    return segment->amslTerrainHeights().count() == 0;
-}
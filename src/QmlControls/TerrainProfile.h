@@ -9,10 +9,15 @@
 
 #pragma once
 
+#include <QHash>
+#include <QPointF>
 #include <QQuickItem>
 #include <QTimer>
+#include <QVariant>
 #include <QSGGeometryNode>
 #include <QSGGeometry>
+#include <QSGTransformNode>
+#include <QVector>
 
 #include "QGCLoggingCategory.h"
 
@@ -22,6 +27,61 @@ class MissionController;
 class QmlObjectListModel;
 class FlightPathSegment;
 
+/// Geometry of a single flight path segment. Vertices are in meters from the start of the segment along x and AMSL
+/// altitude along y. The node's own matrix moves it to where the segment starts and TerrainProfileNode scales it to
+/// pixels. So a segment is only re-tessellated when the segment itself or its level of detail changes, not when the
+/// profile is resized, the altitude range changes or a segment before it changes length.
+class TerrainProfileSegmentNode : public QSGTransformNode
+{
+public:
+    TerrainProfileSegmentNode(void);
+
+    /// Updates the cached terrain height range if the terrain heights changed
+    void updateTerrainRange (FlightPathSegment* segment);
+
+    /// Rebuilds the geometry which is out of date
+    ///     @param lodMeters Width of the decimation buckets, 0 for all terrain points
+    ///     @param bottomAMSLAlt Altitude at the bottom of the profile, where missing terrain is shown
+    /// @return true: the terrain profile was re-tessellated
+    bool update             (FlightPathSegment* segment, double lodMeters, double bottomAMSLAlt);
+
+    double minTerrainHeight = qQNaN();
+    double maxTerrainHeight = qQNaN();
+
+private:
+    QSGGeometryNode*    _createGeometryNode             (QSGGeometry::DrawingMode drawingMode, const QColor& color);
+    void                _setVertices                    (QSGGeometryNode* node, const QVector<QPointF>& vertices);
+    bool                _shouldAddFlightProfileSegment  (FlightPathSegment* segment) const;
+    bool                _shouldAddMissingTerrainSegment (FlightPathSegment* segment) const;
+
+    QSGGeometryNode*    _terrainProfileNode =   nullptr;
+    QSGGeometryNode*    _missingTerrainNode =   nullptr;
+    QSGGeometryNode*    _flightProfileNode =    nullptr;
+    QSGGeometryNode*    _terrainCollisionNode = nullptr;
+
+    // Input the geometry was built from. The terrain heights list is implicitly shared, so comparing it against the
+    // segment's is cheap while it is unchanged.
+    bool                _built =                false;
+    QVariantList        _rangeHeights;
+    QVariantList        _amslTerrainHeights;
+    double              _coord1AMSLAlt =        qQNaN();
+    double              _coord2AMSLAlt =        qQNaN();
+    double              _distanceBetween =      0;
+    double              _finalDistanceBetween = 0;
+    double              _totalDistance =        0;
+    bool                _terrainCollision =     false;
+    double              _lodMeters =            0;
+    double              _bottomAMSLAlt =        qQNaN();
+};
+
+/// Root of the profile's scene graph. Maps the meters/altitude coordinates of the segments to pixels and owns the
+/// segment nodes until the segment goes away.
+class TerrainProfileNode : public QSGTransformNode
+{
+public:
+    QHash<FlightPathSegment*, TerrainProfileSegmentNode*> segmentNodes;
+};
+
 class TerrainProfile : public QQuickItem
 {
     Q_OBJECT
@@ -45,6 +105,11 @@ public:
     // Override from QQmlParserStatus
     void componentComplete(void) final;
 
+    /// Decimates a profile line to the min and max point of each bucketWidth wide bucket along x, in the order they
+    /// occur. The first and last points are always kept so adjoining lines still meet.
+    ///     @param points Sorted by x
+    static QVector<QPointF> decimateProfile(const QVector<QPointF>& points, double bucketWidth);
+
 signals:
     void missionControllerChanged   (void);
     void visibleWidthChanged        (void);
@@ -57,14 +122,7 @@ private slots:
     void _newVisualItems            (void);
 
 private:
-    void    _createGeometry                 (QSGGeometryNode*& geometryNode, QSGGeometry*& geometry, QSGGeometry::DrawingMode drawingMode, const QColor& color);
-    void    _updateSegmentCounts            (FlightPathSegment* segment, int& cFlightProfileSegments, int& cTerrainPoints, int& cMissingTerrainSegments, int& cTerrainCollisionSegments, double& minTerrainHeight, double& maxTerrainHeight);
-    void    _addTerrainProfileSegment       (FlightPathSegment* segment, double currentDistance, double amslAltRange, QSGGeometry::Point2D* terrainProfileVertices, int& terrainVertexIndex);
-    void    _addMissingTerrainSegment       (FlightPathSegment* segment, double currentDistance, QSGGeometry::Point2D* missingTerrainVertices, int& missingTerrainVertexIndex);
-    void    _addTerrainCollisionSegment     (FlightPathSegment* segment, double currentDistance, double amslAltRange, QSGGeometry::Point2D* terrainCollisionVertices, int& terrainCollisionVertexIndex);
-    void    _addFlightProfileSegment        (FlightPathSegment* segment, double currentDistance, double amslAltRange, QSGGeometry::Point2D* flightProfileVertices, int& flightProfileVertexIndex);
-    bool    _shouldAddFlightProfileSegment  (FlightPathSegment* segment);
-    bool    _shouldAddMissingTerrainSegment (FlightPathSegment* segment);
+    double  _lodMeters  (FlightPathSegment* segment) const;
 
     MissionController*  _missionController =    nullptr;
     QmlObjectListModel* _visualItems =          nullptr;
@@ -0,0 +1,65 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainProfileTest.h"
+#include "TerrainProfile.h"
+
+void TerrainProfileTest::_decimateNoopTest(void)
+{
+    QVector<QPointF> points = { QPointF(0, 10), QPointF(1, 20), QPointF(2, 15) };
+
+    // Full detail
+    QCOMPARE(TerrainProfile::decimateProfile(points, 0), points);
+
+    // Nothing to drop with one point per bucket
+    QCOMPARE(TerrainProfile::decimateProfile(points, 1), points);
+
+    QVector<QPointF> twoPoints = { QPointF(0, 10), QPointF(100, 20) };
+    QCOMPARE(TerrainProfile::decimateProfile(twoPoints, 1000), twoPoints);
+}
+
+void TerrainProfileTest::_decimateMinMaxTest(void)
+{
+    // Points every meter, buckets of ten meters
+    QVector<QPointF> points;
+    for (int i=0; i<=100; i++) {
+        points.append(QPointF(i, 100));
+    }
+    points[13].setY(50);    // Min before max
+    points[17].setY(150);
+    points[25].setY(180);   // Max before min
+    points[28].setY(20);
+
+    QVector<QPointF> decimated = TerrainProfile::decimateProfile(points, 10);
+
+    // First, two per bucket at most and last
+    QVERIFY(decimated.count() <= 2 + (10 * 2));
+    QVERIFY(decimated.count() < points.count());
+
+    // Extremes are kept, in order of distance
+    QVERIFY(decimated.contains(points[13]));
+    QVERIFY(decimated.contains(points[17]));
+    QVERIFY(decimated.contains(points[25]));
+    QVERIFY(decimated.contains(points[28]));
+    for (int i=1; i<decimated.count(); i++) {
+        QVERIFY(decimated[i].x() > decimated[i - 1].x());
+    }
+}
+
+void TerrainProfileTest::_decimateEndpointsTest(void)
+{
+    QVector<QPointF> points;
+    for (int i=0; i<50; i++) {
+        points.append(QPointF(i * 0.5, i % 7));
+    }
+
+    QVector<QPointF> decimated = TerrainProfile::decimateProfile(points, 8);
+    QCOMPARE(decimated.first(), points.first());
+    QCOMPARE(decimated.last(), points.last());
+}
@@ -0,0 +1,401 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VehicleMarkerLayer.h"
+#include "QGCApplication.h"
+#include "MultiVehicleManager.h"
+#include "ADSBVehicleManager.h"
+#include "Vehicle.h"
+
+#include <QMouseEvent>
+#include <QPainter>
+#include <QQuickWindow>
+#include <QSGGeometryNode>
+#include <QSGTextureMaterial>
+#include <QSvgRenderer>
+#include <QtMath>
+
+/// Owns the atlas texture, which the material doesn't
+class VehicleMarkerNode : public QSGGeometryNode
+{
+public:
+    VehicleMarkerNode(void)
+        : _geometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 0)
+    {
+        _geometry.setDrawingMode(QSGGeometry::DrawTriangles);
+        _material.setFiltering(QSGTexture::Linear);
+        setGeometry(&_geometry);
+        setMaterial(&_material);
+    }
+
+    ~VehicleMarkerNode()
+    {
+        delete _texture;
+    }
+
+    void setTexture(QSGTexture* texture)
+    {
+        delete _texture;
+        _texture = texture;
+        _material.setTexture(texture);
+        markDirty(QSGNode::DirtyMaterial);
+    }
+
+private:
+    QSGGeometry         _geometry;
+    QSGTextureMaterial  _material;
+    QSGTexture*         _texture = nullptr;
+};
+
+VehicleMarkerLayer::VehicleMarkerLayer(QQuickItem* parent)
+    : QQuickItem(parent)
+{
+    setFlag(QQuickItem::ItemHasContents, true);
+    setAcceptedMouseButtons(Qt::LeftButton);
+
+    _iconSources.append(QStringLiteral("/qmlimages/AwarenessAircraft.svg"));
+    _iconSources.append(QStringLiteral("/qmlimages/AlertAircraft.svg"));
+
+    connect(this, &QQuickItem::widthChanged,                            this, &VehicleMarkerLayer::_viewChanged);
+    connect(this, &QQuickItem::heightChanged,                           this, &VehicleMarkerLayer::_viewChanged);
+    connect(this, &VehicleMarkerLayer::zoomLevelChanged,                this, &VehicleMarkerLayer::_viewChanged);
+    connect(this, &VehicleMarkerLayer::bearingChanged,                  this, &VehicleMarkerLayer::_viewChanged);
+    connect(this, &VehicleMarkerLayer::vehicleSizeChanged,              this, &VehicleMarkerLayer::_iconsChanged);
+    connect(this, &VehicleMarkerLayer::adsbVehicleSizeChanged,          this, &VehicleMarkerLayer::_iconsChanged);
+    connect(this, &VehicleMarkerLayer::showVehiclesChanged,             this, &VehicleMarkerLayer::_markersChanged);
+    connect(this, &VehicleMarkerLayer::showAdsbVehiclesChanged,         this, &VehicleMarkerLayer::_markersChanged);
+    connect(this, &QQuickItem::windowChanged,                           this, &VehicleMarkerLayer::_iconsChanged);
+
+    MultiVehicleManager* multiVehicleManager = qgcApp()->toolbox()->multiVehicleManager();
+    connect(multiVehicleManager, &MultiVehicleManager::vehicleAdded,    this, &VehicleMarkerLayer::_vehicleAdded);
+    connect(multiVehicleManager, &MultiVehicleManager::vehicleRemoved,  this, &VehicleMarkerLayer::_vehicleRemoved);
+    QmlObjectListModel* vehicles = multiVehicleManager->vehicles();
+    for (int i=0; i<vehicles->count(); i++) {
+        _vehicleAdded(vehicles->value<Vehicle*>(i));
+    }
+
+    ADSBVehicleManager* adsbVehicleManager = qgcApp()->toolbox()->adsbVehicleManager();
+    connect(adsbVehicleManager,                 &ADSBVehicleManager::adsbVehiclesUpdated,   this, &VehicleMarkerLayer::_markersChanged);
+    connect(adsbVehicleManager->adsbVehicles(), &QmlObjectListModel::countChanged,          this, &VehicleMarkerLayer::_markersChanged);
+
+    _markersChanged();
+}
+
+Vehicle* VehicleMarkerLayer::delegateVehicle(void)
+{
+    return _delegateVehicle;
+}
+
+ADSBVehicle* VehicleMarkerLayer::delegateAdsbVehicle(void)
+{
+    return _delegateAdsbVehicle;
+}
+
+void VehicleMarkerLayer::setMapCenter(const QGeoCoordinate& mapCenter)
+{
+    if (mapCenter != _mapCenter) {
+        _mapCenter      = mapCenter;
+        _worldCenter    = worldPosition(mapCenter);
+        emit mapCenterChanged();
+        _viewChanged();
+    }
+}
+
+void VehicleMarkerLayer::setDelegateVehicle(Vehicle* vehicle)
+{
+    if (vehicle != _delegateVehicle.data()) {
+        _delegateVehicle = vehicle;
+        emit delegateVehicleChanged();
+        _markersChanged();
+    }
+}
+
+void VehicleMarkerLayer::setDelegateAdsbVehicle(ADSBVehicle* adsbVehicle)
+{
+    if (adsbVehicle != _delegateAdsbVehicle.data()) {
+        _delegateAdsbVehicle = adsbVehicle;
+        emit delegateAdsbVehicleChanged();
+        _markersChanged();
+    }
+}
+
+void VehicleMarkerLayer::_vehicleAdded(Vehicle* vehicle)
+{
+    // Own vehicles are few, unlike ADSB vehicles they are watched one by one
+    connect(vehicle,            &Vehicle::coordinateChanged,    this, &VehicleMarkerLayer::_markersChanged);
+    connect(vehicle->heading(), &Fact::rawValueChanged,         this, &VehicleMarkerLayer::_markersChanged);
+    _markersChanged();
+}
+
+void VehicleMarkerLayer::_vehicleRemoved(Vehicle* vehicle)
+{
+    disconnect(vehicle,             nullptr, this, nullptr);
+    disconnect(vehicle->heading(),  nullptr, this, nullptr);
+    _markersChanged();
+}
+
+void VehicleMarkerLayer::_markersChanged(void)
+{
+    // Any number of changes until the next frame are picked up by a single updatePolish
+    polish();
+}
+
+void VehicleMarkerLayer::_viewChanged(void)
+{
+    update();
+}
+
+void VehicleMarkerLayer::_iconsChanged(void)
+{
+    _atlasDirty = true;
+    update();
+}
+
+QPointF VehicleMarkerLayer::worldPosition(const QGeoCoordinate& coordinate)
+{
+    // Web Mercator stops short of the poles
+    const double latitude   = qDegreesToRadians(qBound(-85.05112878, coordinate.latitude(), 85.05112878));
+    const double x          = (coordinate.longitude() + 180.0) / 360.0;
+    const double y          = (1.0 - (qLn(qTan(latitude) + (1.0 / qCos(latitude))) / M_PI)) / 2.0;
+
+    return QPointF(x, y);
+}
+
+QPointF VehicleMarkerLayer::itemPosition(const QPointF& worldPosition) const
+{
+    const double worldPixels = tileSize * qPow(2.0, _zoomLevel);
+
+    // Shortest way around, for maps across the antimeridian
+    double dx = worldPosition.x() - _worldCenter.x();
+    if (dx > 0.5) {
+        dx -= 1.0;
+    } else if (dx < -0.5) {
+        dx += 1.0;
+    }
+    const double x = dx * worldPixels;
+    const double y = (worldPosition.y() - _worldCenter.y()) * worldPixels;
+
+    // The map is turned so that the bearing points up
+    const double bearing    = qDegreesToRadians(_bearing);
+    const double cosBearing = qCos(bearing);
+    const double sinBearing = qSin(bearing);
+
+    return QPointF((width() / 2) + (x * cosBearing) + (y * sinBearing), (height() / 2) - (x * sinBearing) + (y * cosBearing));
+}
+
+int VehicleMarkerLayer::_iconIndex(const QString& source)
+{
+    int index = _iconSources.indexOf(source, FirstVehicleIcon);
+    if (index == -1) {
+        _iconSources.append(source);
+        index = _iconSources.count() - 1;
+        _atlasDirty = true;
+    }
+    return index;
+}
+
+void VehicleMarkerLayer::updatePolish(void)
+{
+    const int oldCount = _markers.count();
+
+    _markers.clear();
+    _markerObjects.clear();
+
+    // Drawn in order, so own vehicles go last to end up on top
+    if (_showAdsbVehicles) {
+        QmlObjectListModel* adsbVehicles = qgcApp()->toolbox()->adsbVehicleManager()->adsbVehicles();
+        _markers.reserve(adsbVehicles->count());
+        _markerObjects.reserve(adsbVehicles->count());
+        for (int i=0; i<adsbVehicles->count(); i++) {
+            ADSBVehicle* adsbVehicle = adsbVehicles->value<ADSBVehicle*>(i);
+            if (adsbVehicle == _delegateAdsbVehicle.data() || !adsbVehicle->coordinate().isValid()) {
+                continue;
+            }
+            const QPointF   world   = worldPosition(adsbVehicle->coordinate());
+            const double    heading = adsbVehicle->heading();
+            _markers.append({ world.x(), world.y(), qIsNaN(heading) ? 0.0f : static_cast<float>(heading), adsbVehicle->alert() ? AdsbAlertIcon : AdsbIcon });
+            _markerObjects.append(adsbVehicle);
+        }
+    }
+
+    if (_showVehicles) {
+        QmlObjectListModel* vehicles = qgcApp()->toolbox()->multiVehicleManager()->vehicles();
+        for (int i=0; i<vehicles->count(); i++) {
+            Vehicle* vehicle = vehicles->value<Vehicle*>(i);
+            if (vehicle == _delegateVehicle.data() || !vehicle->coordinate().isValid()) {
+                continue;
+            }
+            const QPointF   world   = worldPosition(vehicle->coordinate());
+            const double    heading = vehicle->heading()->rawValue().toDouble();
+            _markers.append({ world.x(), world.y(), qIsNaN(heading) ? 0.0f : static_cast<float>(heading), _iconIndex(vehicle->vehicleImageOpaque()) });
+            _markerObjects.append(vehicle);
+        }
+    }
+
+    if (_markers.count() != oldCount) {
+        emit markerCountChanged();
+    }
+    update();
+}
+
+QObject* VehicleMarkerLayer::markerAt(double x, double y) const
+{
+    // Top most first
+    for (int i=_markers.count() - 1; i>=0; i--) {
+        const Marker_t& marker      = _markers[i];
+        const QPointF   position    = itemPosition(QPointF(marker.worldX, marker.worldY));
+        const double    radius      = _markerSize(marker.icon) / 2;
+        const double    dx          = x - position.x();
+        const double    dy          = y - position.y();
+
+        if ((dx * dx) + (dy * dy) <= radius * radius) {
+            return _markerObjects[i].data();
+        }
+    }
+    return nullptr;
+}
+
+void VehicleMarkerLayer::mousePressEvent(QMouseEvent* event)
+{
+    _pressedObject = markerAt(event->localPos().x(), event->localPos().y());
+    if (_pressedObject) {
+        event->accept();
+    } else {
+        // Let the map have it
+        event->ignore();
+    }
+}
+
+void VehicleMarkerLayer::mouseReleaseEvent(QMouseEvent* event)
+{
+    QObject* object = _pressedObject.data();
+    _pressedObject.clear();
+
+    if (object && markerAt(event->localPos().x(), event->localPos().y()) == object) {
+        Vehicle* vehicle = qobject_cast<Vehicle*>(object);
+        if (vehicle) {
+            emit vehicleClicked(vehicle);
+        } else {
+            emit adsbVehicleClicked(qobject_cast<ADSBVehicle*>(object));
+        }
+    }
+}
+
+QImage VehicleMarkerLayer::_buildAtlas(int cellPixels) const
+{
+    QImage atlas(cellPixels * _iconSources.count(), cellPixels, QImage::Format_ARGB32_Premultiplied);
+    atlas.fill(Qt::transparent);
+
+    QPainter painter(&atlas);
+    painter.setRenderHint(QPainter::Antialiasing);
+    for (int i=0; i<_iconSources.count(); i++) {
+        const QRectF cell(i * cellPixels, 0, cellPixels, cellPixels);
+
+        if (i < FirstVehicleIcon) {
+            // Same glow as the ADSB delegate
+            QRadialGradient glow(cell.center(), cellPixels / 2);
+            glow.setColorAt(0.5, QColor::fromRgbF(0.94, 0.91, 0, 0.5));
+            glow.setColorAt(1.0, Qt::transparent);
+            painter.setPen(Qt::NoPen);
+            painter.setBrush(glow);
+            painter.drawEllipse(cell);
+        }
+
+        // qml image paths are resources
+        QString source = _iconSources[i];
+        if (source.startsWith(QStringLiteral("qrc:"))) {
+            source.remove(0, 3);
+        } else if (source.startsWith(QStringLiteral("/"))) {
+            source.prepend(QStringLiteral(":"));
+        }
+
+        // Own vehicles are only in the layer while they aren't the active one
+        painter.setOpacity(i < FirstVehicleIcon ? 1.0 : 0.5);
+        QSvgRenderer renderer(source);
+        if (renderer.isValid()) {
+            QSizeF size = renderer.defaultSize();
+            size.scale(cell.size(), Qt::KeepAspectRatio);
+            renderer.render(&painter, QRectF(cell.center() - QPointF(size.width() / 2, size.height() / 2), size));
+        } else {
+            QImage image(source);
+            if (!image.isNull()) {
+                QSizeF size = image.size();
+                size.scale(cell.size(), Qt::KeepAspectRatio);
+                painter.drawImage(QRectF(cell.center() - QPointF(size.width() / 2, size.height() / 2), size), image);
+            }
+        }
+        painter.setOpacity(1.0);
+    }
+
+    return atlas;
+}
+
+QSGNode* VehicleMarkerLayer::updatePaintNode(QSGNode* oldNode, QQuickItem::UpdatePaintNodeData* /*updatePaintNodeData*/)
+{
+    VehicleMarkerNode* node = static_cast<VehicleMarkerNode*>(oldNode);
+
+    if (!node) {
+        node = new VehicleMarkerNode;
+        _atlasDirty = true;
+    }
+
+    const int iconCount = _iconSources.count();
+    if (_atlasDirty) {
+        _atlasDirty = false;
+        const qreal devicePixelRatio    = window()->effectiveDevicePixelRatio();
+        const int   cellPixels          = qMax(1, qCeil(qMax(_vehicleSize, _adsbVehicleSize) * devicePixelRatio));
+        node->setTexture(window()->createTextureFromImage(_buildAtlas(cellPixels)));
+    }
+
+    // Markers which are off the item are left out
+    QVector<QPointF>    positions;
+    QVector<int>        visible;
+    positions.reserve(_markers.count());
+    for (int i=0; i<_markers.count(); i++) {
+        const Marker_t& marker      = _markers[i];
+        const QPointF   position    = itemPosition(QPointF(marker.worldX, marker.worldY));
+        const double    halfSize    = _markerSize(marker.icon) / 2;
+        if (position.x() >= -halfSize && position.y() >= -halfSize && position.x() <= width() + halfSize && position.y() <= height() + halfSize) {
+            positions.append(position);
+            visible.append(i);
+        }
+    }
+
+    QSGGeometry* geometry = node->geometry();
+    geometry->allocate(visible.count() * _verticesPerMarker);
+    QSGGeometry::TexturedPoint2D* vertices = geometry->vertexDataAsTexturedPoint2D();
+
+    for (int i=0; i<visible.count(); i++) {
+        const Marker_t& marker = _markers[visible[i]];
+
+        // Corners turned clockwise by the heading on the map
+        const float halfSize    = static_cast<float>(_markerSize(marker.icon) / 2);
+        const float angle       = qDegreesToRadians(marker.heading - static_cast<float>(_bearing));
+        const float cosA        = static_cast<float>(qCos(angle)) * halfSize;
+        const float sinA        = static_cast<float>(qSin(angle)) * halfSize;
+        const float x           = static_cast<float>(positions[i].x());
+        const float y           = static_cast<float>(positions[i].y());
+        const float u0          = static_cast<float>(marker.icon) / iconCount;
+        const float u1          = static_cast<float>(marker.icon + 1) / iconCount;
+
+        // Top left, top right, bottom right, bottom left
+        const float xs[4] = { x - cosA + sinA, x + cosA + sinA, x + cosA - sinA, x - cosA - sinA };
+        const float ys[4] = { y - sinA - cosA, y + sinA - cosA, y + sinA + cosA, y - sinA + cosA };
+        const float us[4] = { u0, u1, u1, u0 };
+        const float vs[4] = { 0, 0, 1, 1 };
+        static const int triangles[_verticesPerMarker] = { 0, 1, 2, 0, 2, 3 };
+
+        for (int corner: triangles) {
+            (vertices++)->set(xs[corner], ys[corner], us[corner], vs[corner]);
+        }
+    }
+    node->markDirty(QSGNode::DirtyGeometry);
+
+    return node;
+}
@@ -0,0 +1,139 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QGeoCoordinate>
+#include <QImage>
+#include <QPointer>
+#include <QQuickItem>
+#include <QStringList>
+#include <QVector>
+
+class Vehicle;
+class ADSBVehicle;
+
+/// Draws the icons of all vehicles and ADSB vehicles over a map in a single geometry node.
+///
+/// Icons are rendered once into a texture atlas. Each marker is then a position, heading and icon index in a packed
+/// array, which is rebuilt when the vehicles report new positions: once per update batch for ADSB vehicles, on
+/// coordinate and heading changes for own vehicles. Panning and zooming only projects that array again, there is no
+/// per marker QML object or binding. The projection is Web Mercator from mapCenter, zoomLevel and bearing, which
+/// matches the map as long as it isn't tilted.
+///
+/// Vehicles which need their full overlay (labels, alerts, shadows) are drawn by their own MapQuickItem delegate and set
+/// as delegateVehicle or delegateAdsbVehicle, those are left out of the layer. Clicks on a marker are taken by the
+/// layer and reported with vehicleClicked or adsbVehicleClicked, all others go through to the map.
+class VehicleMarkerLayer : public QQuickItem
+{
+    Q_OBJECT
+
+public:
+    VehicleMarkerLayer(QQuickItem *parent = nullptr);
+
+    Q_PROPERTY(QGeoCoordinate   mapCenter           READ mapCenter              WRITE setMapCenter              NOTIFY mapCenterChanged)
+    Q_PROPERTY(double           zoomLevel           MEMBER _zoomLevel                                           NOTIFY zoomLevelChanged)
+    Q_PROPERTY(double           bearing             MEMBER _bearing                                             NOTIFY bearingChanged)
+    Q_PROPERTY(double           vehicleSize         MEMBER _vehicleSize                                         NOTIFY vehicleSizeChanged)      ///< Pixels
+    Q_PROPERTY(double           adsbVehicleSize     MEMBER _adsbVehicleSize                                     NOTIFY adsbVehicleSizeChanged)  ///< Pixels
+    Q_PROPERTY(bool             showVehicles        MEMBER _showVehicles                                        NOTIFY showVehiclesChanged)
+    Q_PROPERTY(bool             showAdsbVehicles    MEMBER _showAdsbVehicles                                    NOTIFY showAdsbVehiclesChanged)
+    Q_PROPERTY(Vehicle*         delegateVehicle     READ delegateVehicle        WRITE setDelegateVehicle        NOTIFY delegateVehicleChanged)
+    Q_PROPERTY(ADSBVehicle*     delegateAdsbVehicle READ delegateAdsbVehicle    WRITE setDelegateAdsbVehicle    NOTIFY delegateAdsbVehicleChanged)
+    Q_PROPERTY(int              markerCount         READ markerCount                                            NOTIFY markerCountChanged)
+
+    /// @return Vehicle or ADSBVehicle whose marker is at the position, nullptr for none
+    Q_INVOKABLE QObject* markerAt(double x, double y) const;
+
+    QGeoCoordinate  mapCenter           (void) const { return _mapCenter; }
+    Vehicle*        delegateVehicle     (void);
+    ADSBVehicle*    delegateAdsbVehicle (void);
+    int             markerCount         (void) const { return _markers.count(); }
+
+    void setMapCenter           (const QGeoCoordinate& mapCenter);
+    void setDelegateVehicle     (Vehicle* vehicle);
+    void setDelegateAdsbVehicle (ADSBVehicle* adsbVehicle);
+
+    /// Web Mercator position of the coordinate, from 0 to 1 west to east and north to south
+    static QPointF worldPosition(const QGeoCoordinate& coordinate);
+
+    /// Position within the item of a world position, for the current map center, zoom level and bearing
+    QPointF itemPosition(const QPointF& worldPosition) const;
+
+    static const int tileSize = 256;    ///< Pixels across the world at zoom level 0
+
+    // Overrides from QQuickItem
+    QSGNode*    updatePaintNode     (QSGNode* oldNode, QQuickItem::UpdatePaintNodeData* updatePaintNodeData) override;
+    void        updatePolish        (void) override;
+
+signals:
+    void mapCenterChanged           (void);
+    void zoomLevelChanged           (void);
+    void bearingChanged             (void);
+    void vehicleSizeChanged         (void);
+    void adsbVehicleSizeChanged     (void);
+    void showVehiclesChanged        (void);
+    void showAdsbVehiclesChanged    (void);
+    void delegateVehicleChanged     (void);
+    void delegateAdsbVehicleChanged (void);
+    void markerCountChanged         (void);
+    void vehicleClicked             (Vehicle* vehicle);
+    void adsbVehicleClicked         (ADSBVehicle* adsbVehicle);
+
+protected:
+    void mousePressEvent    (QMouseEvent* event) override;
+    void mouseReleaseEvent  (QMouseEvent* event) override;
+
+private slots:
+    void _vehicleAdded      (Vehicle* vehicle);
+    void _vehicleRemoved    (Vehicle* vehicle);
+    void _markersChanged    (void);
+    void _viewChanged       (void);
+    void _iconsChanged      (void);
+
+private:
+    enum {
+        AdsbIcon,
+        AdsbAlertIcon,
+        FirstVehicleIcon,               ///< Vehicle images follow the ADSB icons
+    };
+
+    typedef struct {
+        double  worldX;
+        double  worldY;
+        float   heading;            ///< Degrees, clockwise from north
+        int     icon;               ///< Index into _iconSources
+    } Marker_t;
+
+    int     _iconIndex      (const QString& source);
+    QImage  _buildAtlas     (int cellPixels) const;
+    double  _markerSize     (int icon) const { return icon < FirstVehicleIcon ? _adsbVehicleSize : _vehicleSize; }
+
+    QGeoCoordinate          _mapCenter;
+    QPointF                 _worldCenter        { 0.5, 0.5 };
+    double                  _zoomLevel =        0;
+    double                  _bearing =          0;
+    double                  _vehicleSize =      40;
+    double                  _adsbVehicleSize =  20;
+    bool                    _showVehicles =     true;
+    bool                    _showAdsbVehicles = true;
+    QPointer<Vehicle>       _delegateVehicle;
+    QPointer<ADSBVehicle>   _delegateAdsbVehicle;
+    QVector<Marker_t>       _markers;
+    QVector<QPointer<QObject>> _markerObjects;                  ///< Same order as _markers, only used on the gui thread
+    QStringList             _iconSources;                       ///< ADSB icons come first, then vehicle images
+    bool                    _atlasDirty =       true;
+    QPointer<QObject>       _pressedObject;
+
+    static const int _verticesPerMarker = 6;
+
+    Q_DISABLE_COPY(VehicleMarkerLayer)
+};
+
+QML_DECLARE_TYPE(VehicleMarkerLayer)
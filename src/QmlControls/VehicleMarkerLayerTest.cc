@@ -0,0 +1,75 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VehicleMarkerLayerTest.h"
+#include "VehicleMarkerLayer.h"
+#include "Vehicle.h"
+
+static bool _near(const QPointF& a, const QPointF& b)
+{
+    return qAbs(a.x() - b.x()) < 0.001 && qAbs(a.y() - b.y()) < 0.001;
+}
+
+void VehicleMarkerLayerTest::_projectionTest(void)
+{
+    QVERIFY(_near(VehicleMarkerLayer::worldPosition(QGeoCoordinate(0, 0)),      QPointF(0.5, 0.5)));
+    QVERIFY(_near(VehicleMarkerLayer::worldPosition(QGeoCoordinate(0, 90)),     QPointF(0.75, 0.5)));
+    QVERIFY(_near(VehicleMarkerLayer::worldPosition(QGeoCoordinate(85.05112878, -180)), QPointF(0, 0)));
+
+    VehicleMarkerLayer layer;
+    layer.setSize(QSizeF(256, 256));
+    layer.setMapCenter(QGeoCoordinate(0, 0));
+
+    // At zoom level 0 the world is one tile
+    QVERIFY(_near(layer.itemPosition(QPointF(0.5, 0.5)),    QPointF(128, 128)));
+    QVERIFY(_near(layer.itemPosition(QPointF(0.75, 0.5)),   QPointF(192, 128)));
+
+    // Each zoom level doubles it
+    layer.setProperty("zoomLevel", 1.0);
+    QVERIFY(_near(layer.itemPosition(QPointF(0.75, 0.5)),   QPointF(256, 128)));
+
+    // Across the antimeridian
+    layer.setMapCenter(QGeoCoordinate(0, 179));
+    QPointF east = layer.itemPosition(VehicleMarkerLayer::worldPosition(QGeoCoordinate(0, -179)));
+    QVERIFY(east.x() > 128 && east.x() < 256);
+
+    // With the map turned east up, east is up
+    layer.setMapCenter(QGeoCoordinate(0, 0));
+    layer.setProperty("bearing", 90.0);
+    QVERIFY(_near(layer.itemPosition(QPointF(0.75, 0.5)),   QPointF(128, 0)));
+}
+
+void VehicleMarkerLayerTest::_markerTest(void)
+{
+    _connectMockLink();
+    QTRY_VERIFY_WITH_TIMEOUT(_vehicle->coordinate().isValid(), 5000);
+
+    VehicleMarkerLayer layer;
+    layer.setSize(QSizeF(200, 200));
+    layer.setProperty("vehicleSize", 40.0);
+    layer.setProperty("showAdsbVehicles", false);
+    layer.setProperty("zoomLevel", 18.0);
+    layer.setMapCenter(_vehicle->coordinate());
+
+    // Not in a window there is no polish pass of its own
+    layer.updatePolish();
+    QCOMPARE(layer.markerCount(), 1);
+    QCOMPARE(layer.markerAt(100, 100), static_cast<QObject*>(_vehicle));
+    QCOMPARE(layer.markerAt(110, 90), static_cast<QObject*>(_vehicle));
+    QVERIFY(!layer.markerAt(130, 100));
+    QVERIFY(!layer.markerAt(0, 0));
+
+    // Left to its delegate
+    layer.setDelegateVehicle(_vehicle);
+    layer.updatePolish();
+    QCOMPARE(layer.markerCount(), 0);
+    QVERIFY(!layer.markerAt(100, 100));
+
+    _disconnectMockLink();
+}
@@ -9,10 +9,26 @@
 
 #include "BingMapProvider.h"
 
+#include <QFile>
+
 BingMapProvider::BingMapProvider(const QString &imageFormat, const quint32 averageSize,
                                  const QGeoMapType::MapStyle mapType, QObject* parent)
     : MapProvider(QStringLiteral("https://www.bing.com/maps/"), imageFormat, averageSize, mapType, parent) {}
 
+static QByteArray _loadNoTileImage() {
+    QFile file(QStringLiteral(":/res/BingNoTileBytes.dat"));
+    if (!file.open(QFile::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+// Bing doesn't return an error above the supported zoom level, it sends this missing tile graphic instead
+bool BingMapProvider::_isNoTile(const QByteArray& image) const {
+    static const QByteArray noTileImage = _loadNoTileImage();
+    return image.size() && noTileImage.size() && image == noTileImage;
+}
+
 static const QString RoadMapUrl = QStringLiteral("http://ecn.t%1.tiles.virtualearth.net/tiles/r%2.png?g=%3&mkt=%4");
 
 QString BingRoadMapProvider::_getURL(const int x, const int y, const int zoom, QNetworkAccessManager* networkManager) {
@@ -21,6 +21,7 @@ public:
     ~BingMapProvider() = default;
 
     bool _isBingProvider() const override { return true; }
+    bool _isNoTile(const QByteArray& image) const override;
 
 
 protected:
@@ -49,3 +49,9 @@ QGCTileSet AirmapElevationProvider::getTileCount(const int zoom, const double to
 
     return set;
 }
+
+//-----------------------------------------------------------------------------
+QString TerrainMapProvider::_getURL(const int x, const int y, const int zoom, QNetworkAccessManager* networkManager) {
+    Q_UNUSED(networkManager)
+    return QString("qgc://terrain/%1/%2/%3/%4").arg(_tinted ? "relief" : "hillshade").arg(zoom).arg(x).arg(y);
+}
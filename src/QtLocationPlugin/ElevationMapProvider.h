@@ -31,6 +31,9 @@ class AirmapElevationProvider : public ElevationProvider {
         : ElevationProvider(QStringLiteral("bin"), AVERAGE_AIRMAP_ELEV_SIZE,
                             QGeoMapType::StreetMap, parent) {}
 
+    /// Single API endpoint with a rate limited key
+    int concurrentDownloads() const override { return 4; }
+
     int long2tileX(const double lon, const int z) const override;
 
     int lat2tileY(const double lat, const int z) const override;
@@ -43,3 +46,27 @@ class AirmapElevationProvider : public ElevationProvider {
     QString _getURL(const int x, const int y, const int zoom, QNetworkAccessManager* networkManager) override;
 };
 
+// -----------------------------------------------------------
+// Terrain rendered from the Airmap elevation tiles
+
+static const quint32 AVERAGE_TERRAIN_TILE_SIZE = 60000;
+
+class TerrainMapProvider : public MapProvider {
+    Q_OBJECT
+  public:
+    /// @param tinted true: colored by elevation, false: gray hillshade
+    TerrainMapProvider(bool tinted, QObject* parent = nullptr)
+        : MapProvider(QString(), QStringLiteral("png"), AVERAGE_TERRAIN_TILE_SIZE,
+                      QGeoMapType::TerrainMap, parent)
+        , _tinted(tinted) {}
+
+    bool _isLocalProvider() const override { return true; }
+
+    bool tinted() const { return _tinted; }
+
+  protected:
+    QString _getURL(const int x, const int y, const int zoom, QNetworkAccessManager* networkManager) override;
+
+  private:
+    bool _tinted;
+};
@@ -45,8 +45,15 @@ public:
 
     virtual int lat2tileY(const double lat, const int z) const;
 
+    /// Maximum number of tiles downloaded at the same time when fetching a tile set
+    virtual int concurrentDownloads() const { return 12; }
+
     virtual bool _isElevationProvider() const { return false; }
+    /// Tiles are rendered by QGC instead of downloaded, the URL only identifies the tile
+    virtual bool _isLocalProvider() const { return false; }
     virtual bool _isBingProvider() const { return false; }
+    /// @return true: the image is the provider's placeholder for a tile it doesn't have
+    virtual bool _isNoTile(const QByteArray& image) const { Q_UNUSED(image); return false; }
 
     virtual QGCTileSet getTileCount(const int zoom, const double topleftLon,
                                      const double topleftLat, const double bottomRightLon,
@@ -24,6 +24,9 @@ HEADERS += \
     $$PWD/QGCMapTileSet.h \
     $$PWD/QGCMapUrlEngine.h \
     $$PWD/QGCTileCacheWorker.h \
+    $$PWD/QGCTerrainTileRenderer.h \
+    $$PWD/QGCTileFetchQueue.h \
+    $$PWD/QGCTileMemoryCache.h \
     $$PWD/QGeoCodeReplyQGC.h \
     $$PWD/QGeoCodingManagerEngineQGC.h \
     $$PWD/QGeoMapReplyQGC.h \
@@ -45,6 +48,9 @@ SOURCES += \
     $$PWD/QGCMapTileSet.cpp \
     $$PWD/QGCMapUrlEngine.cpp \
     $$PWD/QGCTileCacheWorker.cpp \
+    $$PWD/QGCTerrainTileRenderer.cpp \
+    $$PWD/QGCTileFetchQueue.cpp \
+    $$PWD/QGCTileMemoryCache.cpp \
     $$PWD/QGeoCodeReplyQGC.cpp \
     $$PWD/QGeoCodingManagerEngineQGC.cpp \
     $$PWD/QGeoMapReplyQGC.cpp \
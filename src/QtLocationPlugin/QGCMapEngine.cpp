@@ -27,6 +27,7 @@
 
 #include "QGCMapEngine.h"
 #include "QGCMapTileSet.h"
+#include "QGCMemoryAccounting.h"
 
 Q_DECLARE_METATYPE(QGCMapTask::TaskType)
 Q_DECLARE_METATYPE(QGCTile)
@@ -89,13 +90,11 @@ QGCMapEngine::QGCMapEngine()
     , _maxMemCache(0)
     , _prunning(false)
     , _cacheWasReset(false)
-    , _isInternetActive(false)
 {
     qRegisterMetaType<QGCMapTask::TaskType>();
     qRegisterMetaType<QGCTile>();
     qRegisterMetaType<QList<QGCTile*>>();
     connect(&_worker, &QGCCacheWorker::updateTotals,   this, &QGCMapEngine::_updateTotals);
-    connect(&_worker, &QGCCacheWorker::internetStatus, this, &QGCMapEngine::_internetStatus);
 }
 
 //-----------------------------------------------------------------------------
@@ -165,10 +164,25 @@ QGCMapEngine::init()
     } else {
         qCritical() << "Could not find suitable map cache directory.";
     }
+    _memoryCache.setMaxBytes(_memoryCacheBytes());
+    qgcApp()->toolbox()->memoryAccounting()->addSource(QStringLiteral("Map tile memory cache"), this, [this]() {
+        int     count;
+        quint64 bytes;
+        _memoryCache.usage(count, bytes);
+        return QGCMemoryAccounting::Usage_t{ count, static_cast<qint64>(bytes) };
+    });
     QGCMapTask* task = new QGCMapTask(QGCMapTask::taskInit);
     _worker.enqueueTask(task);
 }
 
+//-----------------------------------------------------------------------------
+// QtLocation keeps its own decoded textures within the memory cache limit, the encoded images only get part of it
+quint64
+QGCMapEngine::_memoryCacheBytes()
+{
+    return static_cast<quint64>(getMaxMemCache()) * 1024 * 1024 / 4;
+}
+
 //-----------------------------------------------------------------------------
 bool
 QGCMapEngine::_wipeDirectory(const QString& dirPath)
@@ -218,6 +232,24 @@ QGCMapEngine::cacheTile(QString type, const QString& hash, const QByteArray& ima
     }
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCMapEngine::cacheEmptyTile(QString type, int x, int y, int z)
+{
+    cacheEmptyTile(getTileHash(type, x, y, z));
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCMapEngine::cacheEmptyTile(const QString& hash)
+{
+    AppSettings* appSettings = qgcApp()->toolbox()->settingsManager()->appSettings();
+    if(!appSettings->disableAllPersistence()->rawValue().toBool()) {
+        QGCSaveTileTask* task = new QGCSaveTileTask(new QGCCacheTile(hash, UINT64_MAX));
+        _worker.enqueueTask(task);
+    }
+}
+
 //-----------------------------------------------------------------------------
 QString
 QGCMapEngine::getTileHash(QString type, int x, int y, int z)
@@ -308,6 +340,7 @@ QGCMapEngine::setMaxMemCache(quint32 size)
     QSettings settings;
     settings.setValue(kMaxMemCacheKey, size);
     _maxMemCache = size;
+    _memoryCache.setMaxBytes(_memoryCacheBytes());
 }
 
 //-----------------------------------------------------------------------------
@@ -370,11 +403,8 @@ QGCMapEngine::_pruned()
 int
 QGCMapEngine::concurrentDownloads(QString type)
 {
-    Q_UNUSED(type);
-    // TODO : We may want different values depending on
-    // the provider here, let it like this as all provider are set to 12
-    // at the moment
-    return 12;
+    MapProvider* provider = getQGCMapEngine()->urlFactory()->getProviderTable().value(type, nullptr);
+    return provider ? provider->concurrentDownloads() : 12;
 }
 
 //-----------------------------------------------------------------------------
@@ -385,24 +415,4 @@ QGCCreateTileSetTask::~QGCCreateTileSetTask()
         delete _tileSet;
 }
 
-//-----------------------------------------------------------------------------
-void
-QGCMapEngine::testInternet()
-{
-    if(qgcApp()->toolbox()->settingsManager()->appSettings()->checkInternet()->rawValue().toBool())
-        getQGCMapEngine()->addTask(new QGCTestInternetTask());
-    else
-        _internetStatus(true);
-}
-
-//-----------------------------------------------------------------------------
-void
-QGCMapEngine::_internetStatus(bool active)
-{
-    if(_isInternetActive != active) {
-        _isInternetActive = active;
-        emit internetUpdated();
-    }
-}
-
 // Resolution math: https://wiki.openstreetmap.org/wiki/Slippy_map_tilenames#Resolution_and_Scale
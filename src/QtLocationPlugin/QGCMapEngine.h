@@ -24,6 +24,9 @@
 #include "QGCMapUrlEngine.h"
 #include "QGCMapEngineData.h"
 #include "QGCTileCacheWorker.h"
+#include "QGCTileMemoryCache.h"
+#include "QGCTileFetchQueue.h"
+#include "QGCTerrainTileRenderer.h"
 
 
 //-----------------------------------------------------------------------------
@@ -38,6 +41,9 @@ public:
     void                        addTask             (QGCMapTask *task);
     void                        cacheTile           (QString type, int x, int y, int z, const QByteArray& image, const QString& format, qulonglong set = UINT64_MAX);
     void                        cacheTile           (QString type, const QString& hash, const QByteArray& image, const QString& format, qulonglong set = UINT64_MAX);
+    /// Remembers that the provider has no such tile, fetches of it fail without going to the network for a while
+    void                        cacheEmptyTile      (QString type, int x, int y, int z);
+    void                        cacheEmptyTile      (const QString& hash);
     QGCFetchTileTask*           createFetchTileTask (QString type, int x, int y, int z);
     QStringList                 getMapNameList      ();
     const QString               userAgent           () { return _userAgent; }
@@ -49,11 +55,12 @@ public:
     void                        setMaxMemCache      (quint32 size);
     const QString               getCachePath        () { return _cachePath; }
     const QString               getCacheFilename    () { return _cacheFile; }
-    void                        testInternet        ();
     bool                        wasCacheReset       () { return _cacheWasReset; }
-    bool                        isInternetActive    () { return _isInternetActive; }
 
     UrlFactory*                 urlFactory          () { return _urlFactory; }
+    QGCTileMemoryCache*         tileMemoryCache     () { return &_memoryCache; }
+    QGCTileFetchQueue*          tileFetchQueue      () { return &_fetchQueue; }
+    QGCTerrainTileRenderer*     terrainTileRenderer () { return &_terrainRenderer; }
 
     //-- Tile Math
     static QGCTileSet           getTileCount        (int zoom, double topleftLon, double topleftLat, double bottomRightLon, double bottomRightLat, QString mapType);
@@ -67,19 +74,21 @@ public:
 private slots:
     void _updateTotals          (quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize);
     void _pruned                ();
-    void _internetStatus        (bool active);
 
 signals:
     void updateTotals           (quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize);
-    void internetUpdated        ();
 
 private:
     void _wipeOldCaches         ();
+    quint64 _memoryCacheBytes   ();
     void _checkWipeDirectory    (const QString& dirPath);
     bool _wipeDirectory         (const QString& dirPath);
 
 private:
     QGCCacheWorker          _worker;
+    QGCTileMemoryCache      _memoryCache;
+    QGCTileFetchQueue       _fetchQueue;
+    QGCTerrainTileRenderer  _terrainRenderer;
     QString                 _cachePath;
     QString                 _cacheFile;
     UrlFactory*             _urlFactory;
@@ -88,7 +97,6 @@ private:
     quint32                 _maxMemCache;
     bool                    _prunning;
     bool                    _cacheWasReset;
-    bool                    _isInternetActive;
 };
 
 extern QGCMapEngine*    getQGCMapEngine();
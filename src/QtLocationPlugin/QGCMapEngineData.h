@@ -23,11 +23,50 @@
 #include <QString>
 #include <QHash>
 #include <QDateTime>
+#include <QAtomicInt>
 
 #include "QGCMapUrlEngine.h"
 
 class QGCCachedTileSet;
 
+//-----------------------------------------------------------------------------
+/// Packed 64 bit identifier of a tile for in memory lookups and hash keys.
+/// The provider is identified by its UrlFactory::getProviderIndex, which is only stable for the current run, so keys
+/// must never be persisted. The tile cache database and exported sets keep using the QGCMapEngine::getTileHash string.
+///     bits 63-54 provider index, 53-49 zoom, 48-26 x, 25-3 y
+class QGCTileKey
+{
+public:
+    QGCTileKey(void)
+        : _key(0)
+    {
+    }
+    QGCTileKey(int providerIndex, int x, int y, int z)
+        : _key((static_cast<quint64>(providerIndex & 0x3FF) << 54) |
+               (static_cast<quint64>(z & 0x1F) << 49) |
+               (static_cast<quint64>(x & 0x7FFFFF) << 26) |
+               (static_cast<quint64>(y & 0x7FFFFF) << 3))
+    {
+    }
+
+    int     providerIndex   (void) const { return static_cast<int>(_key >> 54); }
+    int     zoom            (void) const { return static_cast<int>((_key >> 49) & 0x1F); }
+    int     x               (void) const { return static_cast<int>((_key >> 26) & 0x7FFFFF); }
+    int     y               (void) const { return static_cast<int>((_key >> 3) & 0x7FFFFF); }
+    quint64 value           (void) const { return _key; }
+
+    bool operator==(const QGCTileKey& other) const { return _key == other._key; }
+    bool operator!=(const QGCTileKey& other) const { return _key != other._key; }
+
+private:
+    quint64 _key;
+};
+
+inline uint qHash(const QGCTileKey& key, uint seed = 0)
+{
+    return qHash(key.value(), seed);
+}
+
 //-----------------------------------------------------------------------------
 class QGCTile
 {
@@ -84,6 +123,7 @@ public:
         , _type(type)
     {
     }
+    /// No image: marks the tile as one the provider doesn't have
     QGCCacheTile    (const QString hash, qulonglong set)
         : _set(set)
         , _hash(hash)
@@ -110,7 +150,6 @@ public:
 
     enum TaskType {
         taskInit,
-        taskTestInternet,
         taskCacheTile,
         taskFetchTile,
         taskFetchTileSets,
@@ -145,16 +184,6 @@ private:
     TaskType    _type;
 };
 
-//-----------------------------------------------------------------------------
-class QGCTestInternetTask : public QGCMapTask
-{
-    Q_OBJECT
-public:
-    QGCTestInternetTask()
-        : QGCMapTask(QGCMapTask::taskTestInternet)
-    {}
-};
-
 //-----------------------------------------------------------------------------
 class QGCFetchTileSetTask : public QGCMapTask
 {
@@ -222,10 +251,17 @@ public:
         emit tileFetched(tile);
     }
 
+    /// The provider recently answered that it has no such tile
+    void setTileEmpty()
+    {
+        emit tileEmpty();
+    }
+
     QString         hash() { return _hash; }
 
 signals:
     void            tileFetched     (QGCCacheTile* tile);
+    void            tileEmpty       ();
 
 private:
     QString         _hash;
@@ -285,14 +321,25 @@ class QGCUpdateTileDownloadStateTask : public QGCMapTask
 {
     Q_OBJECT
 public:
+    /// @param hash Tile to update, "*" for all tiles in the set
     QGCUpdateTileDownloadStateTask(qulonglong setID, QGCTile::TyleState state, const QString& hash)
         : QGCMapTask(QGCMapTask::taskUpdateTileDownloadState)
         , _setID(setID)
         , _state(state)
         , _hash(hash)
+        , _hashes(hash)
+    {}
+
+    /// Updates all these tiles in a single transaction
+    QGCUpdateTileDownloadStateTask(qulonglong setID, QGCTile::TyleState state, const QStringList& hashes)
+        : QGCMapTask(QGCMapTask::taskUpdateTileDownloadState)
+        , _setID(setID)
+        , _state(state)
+        , _hashes(hashes)
     {}
 
     QString             hash    () { return _hash; }
+    QStringList         hashes  () { return _hashes; }
     qulonglong          setID   () { return _setID; }
     QGCTile::TyleState  state   () { return _state; }
 
@@ -300,6 +347,7 @@ private:
     qulonglong          _setID;
     QGCTile::TyleState  _state;
     QString             _hash;
+    QStringList         _hashes;
 };
 
 //-----------------------------------------------------------------------------
@@ -388,24 +436,32 @@ signals:
 };
 
 //-----------------------------------------------------------------------------
-class QGCExportTileTask : public QGCMapTask
+/// Base of the export and import tasks. The worker copies the tiles in chunks between the other tasks, so the task
+/// lives until actionCompleted.
+class QGCTransferTileTask : public QGCMapTask
 {
     Q_OBJECT
 public:
-    QGCExportTileTask(QVector<QGCCachedTileSet*> sets, QString path)
-        : QGCMapTask(QGCMapTask::taskExport)
-        , _sets(sets)
+    QGCTransferTileTask(TaskType type, QString path)
+        : QGCMapTask(type)
         , _path(path)
+        , _cancelled(0)
     {}
 
-    ~QGCExportTileTask()
+    QString                    path     () { return _path; }
+
+    /// Can be called from any thread, the worker stops before its next chunk
+    void cancel()
     {
+        _cancelled.storeRelease(1);
     }
 
-    QVector<QGCCachedTileSet*> sets() { return _sets; }
-    QString                    path() { return _path; }
+    bool cancelled()
+    {
+        return _cancelled.loadAcquire() != 0;
+    }
 
-    void setExportCompleted()
+    void setCompleted()
     {
         emit actionCompleted();
     }
@@ -416,8 +472,8 @@ public:
     }
 
 private:
-    QVector<QGCCachedTileSet*>  _sets;
     QString                     _path;
+    QAtomicInt                  _cancelled;
 
 signals:
     void actionCompleted        ();
@@ -426,41 +482,43 @@ signals:
 };
 
 //-----------------------------------------------------------------------------
-class QGCImportTileTask : public QGCMapTask
+class QGCExportTileTask : public QGCTransferTileTask
 {
     Q_OBJECT
 public:
-    QGCImportTileTask(QString path, bool replace)
-        : QGCMapTask(QGCMapTask::taskImport)
-        , _path(path)
-        , _replace(replace)
+    QGCExportTileTask(QVector<QGCCachedTileSet*> sets, QString path)
+        : QGCTransferTileTask(QGCMapTask::taskExport, path)
+        , _sets(sets)
     {}
 
-    ~QGCImportTileTask()
+    ~QGCExportTileTask()
     {
     }
 
-    QString                    path     () { return _path; }
-    bool                       replace  () { return _replace; }
+    QVector<QGCCachedTileSet*> sets() { return _sets; }
 
-    void setImportCompleted()
-    {
-        emit actionCompleted();
-    }
+private:
+    QVector<QGCCachedTileSet*>  _sets;
+};
 
-    void setProgress(int percentage)
+//-----------------------------------------------------------------------------
+class QGCImportTileTask : public QGCTransferTileTask
+{
+    Q_OBJECT
+public:
+    QGCImportTileTask(QString path, bool replace)
+        : QGCTransferTileTask(QGCMapTask::taskImport, path)
+        , _replace(replace)
+    {}
+
+    ~QGCImportTileTask()
     {
-        emit actionProgress(percentage);
     }
 
+    bool                       replace  () { return _replace; }
+
 private:
-    QString                     _path;
     bool                        _replace;
-
-signals:
-    void actionCompleted        ();
-    void actionProgress         (int percentage);
-
 };
 
 #endif // QGC_MAP_ENGINE_DATA_H
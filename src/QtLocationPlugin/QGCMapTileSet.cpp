@@ -19,14 +19,20 @@
 #include "QGCMapEngine.h"
 #include "QGCMapTileSet.h"
 #include "QGCMapEngineManager.h"
+#include "QGCApplication.h"
+#include "QGCNetworkService.h"
 #include "TerrainTile.h"
 
 #include <QSettings>
+#include <QTimer>
 #include <math.h>
 
 QGC_LOGGING_CATEGORY(QGCCachedTileSetLog, "QGCCachedTileSetLog")
 
 #define TILE_BATCH_SIZE      256
+#define TILE_STATE_BATCH     64         ///< Download states written to the database in one go
+#define TILE_MAX_RETRIES     3
+#define TILE_RETRY_DELAY_MS  1000       ///< Doubled for each retry of the same tile
 
 //-----------------------------------------------------------------------------
 QGCCachedTileSet::QGCCachedTileSet(const QString& name)
@@ -61,8 +67,9 @@ QGCCachedTileSet::QGCCachedTileSet(const QString& name)
 //-----------------------------------------------------------------------------
 QGCCachedTileSet::~QGCCachedTileSet()
 {
-    delete _networkManager;
-    _networkManager = nullptr;
+    qDeleteAll(_tilesToDownload);
+    qDeleteAll(_repliesTile);
+    qDeleteAll(_retryTiles);
 }
 
 //-----------------------------------------------------------------------------
@@ -153,6 +160,7 @@ QGCCachedTileSet::createDownloadTask()
 void
 QGCCachedTileSet::resumeDownloadTask()
 {
+    _flushTileStates();
     //-- Reset and download error flag (for all tiles)
     QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StatePending, "*");
     getQGCMapEngine()->addTask(task);
@@ -164,6 +172,7 @@ QGCCachedTileSet::resumeDownloadTask()
 void
 QGCCachedTileSet::cancelDownloadTask()
 {
+    _flushTileStates();
     if(_downloading) {
         _downloading = false;
         emit downloadingChanged();
@@ -183,9 +192,9 @@ QGCCachedTileSet::_tileListFetched(QList<QGCTile *> tiles)
         _doneWithDownload();
         return;
     }
-    //-- If this is the first time, create Network Manager
+    //-- Shared network access, owned by the network service
     if (!_networkManager) {
-        _networkManager = new QNetworkAccessManager(this);
+        _networkManager = qgcApp()->toolbox()->networkService()->networkAccessManager();
     }
     //-- Add tiles to the list
     _tilesToDownload += tiles;
@@ -196,6 +205,7 @@ QGCCachedTileSet::_tileListFetched(QList<QGCTile *> tiles)
 //-----------------------------------------------------------------------------
 void QGCCachedTileSet::_doneWithDownload()
 {
+    _flushTileStates();
     if(!_errorCount) {
         _totalTileCount = _savedTileCount;
         _totalTileSize  = _savedTileSize;
@@ -226,7 +236,7 @@ void QGCCachedTileSet::_prepareDownload()
 {
     if(!_tilesToDownload.count()) {
         //-- Are we done?
-        if(_noMoreTiles) {
+        if(_noMoreTiles && _retryTiles.isEmpty()) {
             _doneWithDownload();
         } else {
             if(!_batchRequested)
@@ -241,11 +251,11 @@ void QGCCachedTileSet::_prepareDownload()
             _tilesToDownload.removeFirst();
             QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL(tile->type(), tile->x(), tile->y(), tile->z(), _networkManager);
             request.setAttribute(QNetworkRequest::User, tile->hash());
-#if !defined(__mobile__)
-            QNetworkProxy proxy = _networkManager->proxy();
-            QNetworkProxy tProxy;
-            tProxy.setType(QNetworkProxy::DefaultProxy);
-            _networkManager->setProxy(tProxy);
+            QGCNetworkService::setConsumer(request, QGCNetworkService::consumerMapTiles);
+            //-- Let all downloads to the same server share connections
+            request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+            request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
 #endif
             QNetworkReply* reply = _networkManager->get(request);
             reply->setParent(0);
@@ -256,10 +266,7 @@ void QGCCachedTileSet::_prepareDownload()
             connect(reply, &QNetworkReply::errorOccurred, this, &QGCCachedTileSet::_networkReplyError);
 #endif
             _replies.insert(tile->hash(), reply);
-#if !defined(__mobile__)
-            _networkManager->setProxy(proxy);
-#endif
-            delete tile;
+            _repliesTile.insert(tile->hash(), tile);
             //-- Refill queue if running low
             if(!_batchRequested && !_noMoreTiles && _tilesToDownload.count() < (QGCMapEngine::concurrentDownloads(_type) * 10)) {
                 //-- Request new batch of tiles
@@ -288,6 +295,8 @@ QGCCachedTileSet::_networkReplyFinished()
             } else {
                 qWarning() << "QGCMapEngineManager::networkReplyFinished() Reply not in list: " << hash;
             }
+            delete _repliesTile.take(hash);
+            _retryCounts.remove(hash);
             qCDebug(QGCCachedTileSetLog) << "Tile fetched" << hash;
             QByteArray image = reply->readAll();
             QString type = getQGCMapEngine()->hashToType(hash);
@@ -295,11 +304,15 @@ QGCCachedTileSet::_networkReplyFinished()
                 image = TerrainTile::serializeFromAirMapJson(image);
             }
             QString format = getQGCMapEngine()->urlFactory()->getImageFormat(type, image);
-            if(!format.isEmpty()) {
+            MapProvider* mapProvider = getQGCMapEngine()->urlFactory()->getMapProviderFromId(getQGCMapEngine()->urlFactory()->getIdFromType(type));
+            if(mapProvider && mapProvider->_isNoTile(image)) {
+                //-- Nothing to keep, the provider doesn't have this tile
+                getQGCMapEngine()->cacheEmptyTile(hash);
+                _queueTileState(hash, QGCTile::StateComplete);
+            } else if(!format.isEmpty()) {
                 //-- Cache tile
                 getQGCMapEngine()->cacheTile(type, hash, image, format, _id);
-                QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateComplete, hash);
-                getQGCMapEngine()->addTask(task);
+                _queueTileState(hash, QGCTile::StateComplete);
                 //-- Updated cached (downloaded) data
                 _savedTileSize += image.size();
                 _savedTileCount++;
@@ -332,9 +345,6 @@ QGCCachedTileSet::_networkReplyError(QNetworkReply::NetworkError error)
     if (!reply) {
         return;
     }
-    //-- Update error count
-    _errorCount++;
-    emit errorCountChanged();
     //-- Get tile hash
     QString hash = reply->request().attribute(QNetworkRequest::User).toString();
     qCDebug(QGCCachedTileSetLog) << "Error fetching tile" << reply->errorString();
@@ -344,11 +354,17 @@ QGCCachedTileSet::_networkReplyError(QNetworkReply::NetworkError error)
         } else {
             qWarning() << "QGCMapEngineManager::networkReplyError() Reply not in list: " << hash;
         }
+        if(_retryTile(hash, error)) {
+            reply->deleteLater();
+            return;
+        }
+        //-- Update error count
+        _errorCount++;
+        emit errorCountChanged();
         if (error != QNetworkReply::OperationCanceledError) {
             qWarning() << "QGCMapEngineManager::networkReplyError() Error:" << reply->errorString();
         }
-        QGCUpdateTileDownloadStateTask* task = new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateError, hash);
-        getQGCMapEngine()->addTask(task);
+        _queueTileState(hash, QGCTile::StateError);
     } else {
         qWarning() << "QGCMapEngineManager::networkReplyError() Empty Hash";
     }
@@ -357,6 +373,64 @@ QGCCachedTileSet::_networkReplyError(QNetworkReply::NetworkError error)
     reply->deleteLater();
 }
 
+//-----------------------------------------------------------------------------
+/// Puts the tile back in the download queue after a backoff delay if the error is worth retrying
+///     @return true: retry scheduled, false: tile has failed
+bool
+QGCCachedTileSet::_retryTile(const QString& hash, QNetworkReply::NetworkError error)
+{
+    QGCTile* tile = _repliesTile.take(hash);
+    if(!tile) {
+        return false;
+    }
+    int retries = _retryCounts.value(hash, 0);
+    bool permanent = error == QNetworkReply::OperationCanceledError || error == QNetworkReply::ContentNotFoundError || error == QNetworkReply::ContentAccessDenied;
+    if(permanent || retries >= TILE_MAX_RETRIES) {
+        _retryCounts.remove(hash);
+        delete tile;
+        return false;
+    }
+    _retryCounts[hash] = retries + 1;
+    _retryTiles.append(tile);
+    qCDebug(QGCCachedTileSetLog) << "Retrying tile" << hash << "attempt" << retries + 1;
+    QTimer::singleShot(TILE_RETRY_DELAY_MS << retries, this, [this, tile]() {
+        if(_retryTiles.removeOne(tile)) {
+            _tilesToDownload.prepend(tile);
+            _prepareDownload();
+        }
+    });
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCachedTileSet::_queueTileState(const QString& hash, QGCTile::TyleState state)
+{
+    if(state == QGCTile::StateComplete) {
+        _completedHashes.append(hash);
+    } else {
+        _failedHashes.append(hash);
+    }
+    if(_completedHashes.count() + _failedHashes.count() >= TILE_STATE_BATCH) {
+        _flushTileStates();
+    }
+}
+
+//-----------------------------------------------------------------------------
+/// Tiles not yet flushed stay in the downloading state in the database, so they are never handed out twice
+void
+QGCCachedTileSet::_flushTileStates()
+{
+    if(_completedHashes.count()) {
+        getQGCMapEngine()->addTask(new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateComplete, _completedHashes));
+        _completedHashes.clear();
+    }
+    if(_failedHashes.count()) {
+        getQGCMapEngine()->addTask(new QGCUpdateTileDownloadStateTask(_id, QGCTile::StateError, _failedHashes));
+        _failedHashes.clear();
+    }
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCCachedTileSet::setManager(QGCMapEngineManager* mgr)
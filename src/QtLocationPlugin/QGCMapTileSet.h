@@ -157,6 +157,9 @@ private slots:
 private:
     void        _prepareDownload        ();
     void        _doneWithDownload       ();
+    void        _queueTileState         (const QString& hash, QGCTile::TyleState state);
+    void        _flushTileStates        ();
+    bool        _retryTile              (const QString& hash, QNetworkReply::NetworkError error);
 
 private:
     QString     _name;
@@ -181,6 +184,11 @@ private:
     QString _type;
     QNetworkAccessManager*  _networkManager;
     QHash<QString, QNetworkReply*> _replies;
+    QHash<QString, QGCTile*> _repliesTile;      ///< Tile for each entry in _replies, kept so failed downloads can be retried
+    QHash<QString, int> _retryCounts;
+    QList<QGCTile*> _retryTiles;                ///< Tiles waiting for their retry backoff
+    QStringList _completedHashes;               ///< Download states not yet written to the database
+    QStringList _failedHashes;
     quint32     _errorCount;
     //-- Tile download
     QList<QGCTile *> _tilesToDownload;
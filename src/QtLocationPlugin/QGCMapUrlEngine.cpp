@@ -38,54 +38,62 @@ UrlFactory::UrlFactory() : _timeout(5 * 1000) {
     // Warning : in _providersTable, keys needs to follow this format :
     // "Provider Type"
 #ifndef QGC_NO_GOOGLE_MAPS
-    _providersTable["Google Street Map"] = new GoogleStreetMapProvider(this);
-    _providersTable["Google Satellite"]  = new GoogleSatelliteMapProvider(this);
-    _providersTable["Google Terrain"]    = new GoogleTerrainMapProvider(this);
-    _providersTable["Google Hybrid"]    = new GoogleHybridMapProvider(this);
-    _providersTable["Google Labels"]     = new GoogleTerrainMapProvider(this);
+    registerProvider("Google Street Map", new GoogleStreetMapProvider(this));
+    registerProvider("Google Satellite", new GoogleSatelliteMapProvider(this));
+    registerProvider("Google Terrain", new GoogleTerrainMapProvider(this));
+    registerProvider("Google Hybrid", new GoogleHybridMapProvider(this));
+    registerProvider("Google Labels", new GoogleTerrainMapProvider(this));
 #endif
 
-    _providersTable["Bing Road"]      = new BingRoadMapProvider(this);
-    _providersTable["Bing Satellite"] = new BingSatelliteMapProvider(this);
-    _providersTable["Bing Hybrid"]    = new BingHybridMapProvider(this);
+    registerProvider("Bing Road", new BingRoadMapProvider(this));
+    registerProvider("Bing Satellite", new BingSatelliteMapProvider(this));
+    registerProvider("Bing Hybrid", new BingHybridMapProvider(this));
 
-    _providersTable["Statkart Topo"] = new StatkartMapProvider(this);
+    registerProvider("Statkart Topo", new StatkartMapProvider(this));
 
-    _providersTable["Eniro Topo"] = new EniroMapProvider(this);
+    registerProvider("Eniro Topo", new EniroMapProvider(this));
 
     // To be add later on Token entry !
-    //_providersTable["Esri World Street"] = new EsriWorldStreetMapProvider(this);
-    //_providersTable["Esri World Satellite"] = new EsriWorldSatelliteMapProvider(this);
-    //_providersTable["Esri Terrain"] = new EsriTerrainMapProvider(this);
-
-    _providersTable["Mapbox Streets"]      = new MapboxStreetMapProvider(this);
-    _providersTable["Mapbox Light"]        = new MapboxLightMapProvider(this);
-    _providersTable["Mapbox Dark"]         = new MapboxDarkMapProvider(this);
-    _providersTable["Mapbox Satellite"]    = new MapboxSatelliteMapProvider(this);
-    _providersTable["Mapbox Hybrid"]       = new MapboxHybridMapProvider(this);
-    _providersTable["Mapbox StreetsBasic"] = new MapboxStreetsBasicMapProvider(this);
-    _providersTable["Mapbox Outdoors"]     = new MapboxOutdoorsMapProvider(this);
-    _providersTable["Mapbox RunBikeHike"]  = new MapboxRunBikeHikeMapProvider(this);
-    _providersTable["Mapbox HighContrast"] = new MapboxHighContrastMapProvider(this);
-    _providersTable["Mapbox Custom"]       = new MapboxCustomMapProvider(this);
-
-    //_providersTable["MapQuest Map"] = new MapQuestMapMapProvider(this);
-    //_providersTable["MapQuest Sat"] = new MapQuestSatMapProvider(this);
+    //registerProvider("Esri World Street", new EsriWorldStreetMapProvider(this));
+    //registerProvider("Esri World Satellite", new EsriWorldSatelliteMapProvider(this));
+    //registerProvider("Esri Terrain", new EsriTerrainMapProvider(this));
+
+    registerProvider("Mapbox Streets", new MapboxStreetMapProvider(this));
+    registerProvider("Mapbox Light", new MapboxLightMapProvider(this));
+    registerProvider("Mapbox Dark", new MapboxDarkMapProvider(this));
+    registerProvider("Mapbox Satellite", new MapboxSatelliteMapProvider(this));
+    registerProvider("Mapbox Hybrid", new MapboxHybridMapProvider(this));
+    registerProvider("Mapbox StreetsBasic", new MapboxStreetsBasicMapProvider(this));
+    registerProvider("Mapbox Outdoors", new MapboxOutdoorsMapProvider(this));
+    registerProvider("Mapbox RunBikeHike", new MapboxRunBikeHikeMapProvider(this));
+    registerProvider("Mapbox HighContrast", new MapboxHighContrastMapProvider(this));
+    registerProvider("Mapbox Custom", new MapboxCustomMapProvider(this));
+
+    //registerProvider("MapQuest Map", new MapQuestMapMapProvider(this));
+    //registerProvider("MapQuest Sat", new MapQuestSatMapProvider(this));
     
-    _providersTable["VWorld Street Map"] = new VWorldStreetMapProvider(this);
-    _providersTable["VWorld Satellite Map"] = new VWorldSatMapProvider(this);
+    registerProvider("VWorld Street Map", new VWorldStreetMapProvider(this));
+    registerProvider("VWorld Satellite Map", new VWorldSatMapProvider(this));
 
-    _providersTable["Airmap Elevation"] = new AirmapElevationProvider(this);
+    registerProvider("Airmap Elevation", new AirmapElevationProvider(this));
 
-    _providersTable["Japan-GSI Contour"] = new JapanStdMapProvider(this);
-    _providersTable["Japan-GSI Seamless"] = new JapanSeamlessMapProvider(this);
-    _providersTable["Japan-GSI Anaglyph"] = new JapanAnaglyphMapProvider(this);
-    _providersTable["Japan-GSI Slope"] = new JapanSlopeMapProvider(this);
-    _providersTable["Japan-GSI Relief"] = new JapanReliefMapProvider(this);
+    registerProvider("Terrain Hillshade", new TerrainMapProvider(false, this));
+    registerProvider("Terrain Relief", new TerrainMapProvider(true, this));
+
+    registerProvider("Japan-GSI Contour", new JapanStdMapProvider(this));
+    registerProvider("Japan-GSI Seamless", new JapanSeamlessMapProvider(this));
+    registerProvider("Japan-GSI Anaglyph", new JapanAnaglyphMapProvider(this));
+    registerProvider("Japan-GSI Slope", new JapanSlopeMapProvider(this));
+    registerProvider("Japan-GSI Relief", new JapanReliefMapProvider(this));
 }
 
 void UrlFactory::registerProvider(QString name, MapProvider* provider) {
     _providersTable[name] = provider;
+    _typesById[getIdFromType(name)] = name;
+    _providersById[getIdFromType(name)] = provider;
+    if (!_providerIndexByType.contains(name)) {
+        _providerIndexByType[name] = _providerIndexByType.count();
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -149,14 +157,9 @@ quint32 UrlFactory::averageSizeForType(QString type) {
 }
 
 QString UrlFactory::getTypeFromId(int id) {
-
-    QHashIterator<QString, MapProvider*> i(_providersTable);
-
-    while (i.hasNext()) {
-        i.next();
-        if ((int)(qHash(i.key())>>1) == id) {
-            return i.key();
-        }
+    auto iter = _typesById.constFind(id);
+    if (iter != _typesById.constEnd()) {
+        return iter.value();
     }
     qCDebug(QGCMapUrlEngineLog) << "getTypeFromId : id not found" << id;
     return "";
@@ -164,13 +167,12 @@ QString UrlFactory::getTypeFromId(int id) {
 
 MapProvider* UrlFactory::getMapProviderFromId(int id)
 {
-    QString type = getTypeFromId(id);
-    if (!type.isEmpty()) {
-        if (_providersTable.find(type) != _providersTable.end()) {
-            return _providersTable[type];
-        }
-    }
-    return nullptr;
+    return _providersById.value(id, nullptr);
+}
+
+int UrlFactory::getProviderIndex(const QString& type)
+{
+    return _providerIndexByType.value(type, -1);
 }
 
 // Todo : qHash produce a uint bigger than max(int)
@@ -201,5 +203,11 @@ UrlFactory::getTileCount(int zoom, double topleftLon, double topleftLat, double
 }
 
 bool UrlFactory::isElevation(int mapId){
-    return _providersTable[getTypeFromId(mapId)]->_isElevationProvider();
+    MapProvider* provider = getMapProviderFromId(mapId);
+    return provider && provider->_isElevationProvider();
+}
+
+bool UrlFactory::isLocal(int mapId){
+    MapProvider* provider = getMapProviderFromId(mapId);
+    return provider && provider->_isLocalProvider();
 }
@@ -50,15 +50,24 @@ public:
     QString getTypeFromId(int id);
     MapProvider* getMapProviderFromId(int id);
 
+    /// Small index for the provider which is fixed for the current run, used to build QGCTileKey
+    ///     @return -1 if type is not registered
+    int getProviderIndex(const QString& type);
+    int getProviderIndex(int id) { return _providerIndexByType.value(_typesById.value(id), -1); }
+
     QGCTileSet getTileCount(int zoom, double topleftLon, double topleftLat,
                             double bottomRightLon, double bottomRightLat,
                             QString mapType);
 
     bool isElevation(int mapId);
+    bool isLocal(int mapId);
 
   private:
     int             _timeout;
     QHash<QString, MapProvider*> _providersTable;
+    QHash<int, QString>          _typesById;             ///< Reverse of getIdFromType, ids are looked up for every tile
+    QHash<int, MapProvider*>     _providersById;
+    QHash<QString, int>          _providerIndexByType;
     void registerProvider(QString Name, MapProvider* provider);
 
 };
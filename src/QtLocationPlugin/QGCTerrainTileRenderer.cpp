@@ -0,0 +1,316 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTerrainTileRenderer.h"
+#include "QGCMapEngine.h"
+#include "QGeoMapReplyQGC.h"
+#include "TerrainQuery.h"
+#include "TerrainTile.h"
+
+#include <QBuffer>
+#include <QRunnable>
+#include <QSet>
+#include <QThread>
+#include <QtMath>
+#include <QtLocation/private/qgeotilespec_p.h>
+
+static const double kEarthCircumference = 40075016.686;
+static const double kExaggeration       = 2.0;          ///< Gentle slopes barely show at the true scale
+static const double kSunAzimuth         = 315.0;
+static const double kSunAltitude        = 45.0;
+
+typedef struct {
+    double  meters;
+    QRgb    color;
+} ElevationStop_t;
+
+static const ElevationStop_t kElevationStops[] = {
+    { 0,    qRgb(112, 153,  89) },
+    { 300,  qRgb(168, 192, 118) },
+    { 800,  qRgb(224, 213, 148) },
+    { 1500, qRgb(190, 150, 100) },
+    { 2500, qRgb(150, 120, 100) },
+    { 3500, qRgb(200, 200, 200) },
+    { 5000, qRgb(255, 255, 255) },
+};
+
+//-----------------------------------------------------------------------------
+static QRgb _elevationColor(double meters)
+{
+    const int count = sizeof(kElevationStops) / sizeof(kElevationStops[0]);
+    if(meters <= kElevationStops[0].meters) {
+        return kElevationStops[0].color;
+    }
+    for(int i = 1; i < count; i++) {
+        if(meters < kElevationStops[i].meters) {
+            const ElevationStop_t& low  = kElevationStops[i - 1];
+            const ElevationStop_t& high = kElevationStops[i];
+            double t = (meters - low.meters) / (high.meters - low.meters);
+            return qRgb(static_cast<int>(qRed(low.color)   + t * (qRed(high.color)   - qRed(low.color))),
+                        static_cast<int>(qGreen(low.color) + t * (qGreen(high.color) - qGreen(low.color))),
+                        static_cast<int>(qBlue(low.color)  + t * (qBlue(high.color)  - qBlue(low.color))));
+        }
+    }
+    return kElevationStops[count - 1].color;
+}
+
+//-----------------------------------------------------------------------------
+static int _elevationTileIndex(double degrees, double offset)
+{
+    return static_cast<int>(floor((degrees + offset) / TerrainTile::tileSizeDegrees));
+}
+
+//-----------------------------------------------------------------------------
+/// Shades and encodes one tile on the renderer's pool
+class QGCTerrainTileRunnable : public QRunnable
+{
+public:
+    QGCTerrainTileRunnable(QGCTerrainTileRenderer* renderer, quint64 jobId, const QVector<double>& heights, double sampleMeters, bool tinted, QSharedPointer<QAtomicInt> cancelled)
+        : _renderer     (renderer)
+        , _jobId        (jobId)
+        , _heights      (heights)
+        , _sampleMeters (sampleMeters)
+        , _tinted       (tinted)
+        , _cancelled    (cancelled)
+    {
+    }
+
+    void run() override
+    {
+        //-- Panned out of view while waiting for a thread
+        if(_cancelled->loadAcquire()) {
+            return;
+        }
+        QImage      image = QGCTerrainTileRenderer::shade(_heights, QGCTerrainTileRenderer::samples, _sampleMeters, _tinted);
+        QByteArray  bytes;
+        QBuffer     buffer(&bytes);
+        buffer.open(QIODevice::WriteOnly);
+        image.save(&buffer, "PNG");
+        QMetaObject::invokeMethod(_renderer, "_rendered", Qt::QueuedConnection, Q_ARG(quint64, _jobId), Q_ARG(QByteArray, bytes));
+    }
+
+private:
+    QGCTerrainTileRenderer*     _renderer;
+    quint64                     _jobId;
+    QVector<double>             _heights;
+    double                      _sampleMeters;
+    bool                        _tinted;
+    QSharedPointer<QAtomicInt>  _cancelled;
+};
+
+//-----------------------------------------------------------------------------
+QGCTerrainTileRenderer::QGCTerrainTileRenderer(QObject* parent)
+    : QObject(parent)
+    , _nextJobId(1)
+{
+    //-- Leave a core to the GUI thread
+    _pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
+
+//-----------------------------------------------------------------------------
+QGCTerrainTileRenderer::~QGCTerrainTileRenderer()
+{
+    _pool.clear();
+    _pool.waitForDone();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTerrainTileRenderer::render(QGeoTiledMapReplyQGC* reply)
+{
+    const QGeoTileSpec& spec = reply->tileSpec();
+    if(spec.zoom() < minZoom) {
+        reply->_renderFailed(tr("Zoom in to view terrain"));
+        return;
+    }
+    TerrainMapProvider* provider = qobject_cast<TerrainMapProvider*>(getQGCMapEngine()->urlFactory()->getMapProviderFromId(spec.mapId()));
+
+    Job_t job;
+    job.reply   = reply;
+    job.tinted  = provider && provider->tinted();
+    job.waits   = 0;
+
+    //-- Web mercator sample positions, with one more ring past the tile edges so shading matches the neighbouring tiles
+    const int       stride  = samples + 2;
+    const double    tiles   = pow(2.0, spec.zoom());
+    job.latitudes.resize(stride * stride);
+    job.longitudes.resize(stride * stride);
+    for(int row = 0; row < stride; row++) {
+        double y        = (spec.y() + static_cast<double>(row - 1) / (samples - 1)) / tiles;
+        double latitude = atan(sinh(M_PI * (1.0 - 2.0 * y))) * 180.0 / M_PI;
+        for(int column = 0; column < stride; column++) {
+            double longitude = (spec.x() + static_cast<double>(column - 1) / (samples - 1)) / tiles * 360.0 - 180.0;
+            if(longitude > 180.0) {
+                longitude -= 360.0;
+            } else if(longitude < -180.0) {
+                longitude += 360.0;
+            }
+            job.latitudes[row * stride + column]  = latitude;
+            job.longitudes[row * stride + column] = longitude;
+        }
+    }
+    double centerLatitude = job.latitudes[(stride / 2) * stride];
+    job.sampleMeters = kEarthCircumference * cos(centerLatitude * M_PI / 180.0) / tiles / (samples - 1);
+
+    quint64 jobId = _nextJobId++;
+    _jobs[jobId] = job;
+    _sample(jobId);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTerrainTileRenderer::cancel(QGeoTiledMapReplyQGC* reply)
+{
+    for(auto it = _jobs.begin(); it != _jobs.end(); ++it) {
+        if(it->reply == reply) {
+            if(it->cancelled) {
+                it->cancelled->storeRelease(1);
+            }
+            _jobs.erase(it);
+            return;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTerrainTileRenderer::_sample(quint64 jobId)
+{
+    Job_t&          job     = _jobs[jobId];
+    const int       count   = job.latitudes.count();
+    QVector<double> heights(count);
+    bool            error   = false;
+    if(!TerrainAtCoordinateQuery::getAltitudes(job.latitudes.constData(), job.longitudes.constData(), heights.data(), count, error)) {
+        _waitForTiles(jobId);
+        return;
+    }
+    if(error) {
+        _fail(jobId, tr("Terrain data not available"));
+        return;
+    }
+    //-- The positions aren't needed anymore
+    job.latitudes.clear();
+    job.longitudes.clear();
+    job.cancelled = QSharedPointer<QAtomicInt>(new QAtomicInt(0));
+    _pool.start(new QGCTerrainTileRunnable(this, jobId, heights, job.sampleMeters, job.tinted, job.cancelled));
+}
+
+//-----------------------------------------------------------------------------
+// getAltitudes already started loading the missing elevation tiles, a query for a point in each of them signals once they are in
+void
+QGCTerrainTileRenderer::_waitForTiles(quint64 jobId)
+{
+    Job_t& job = _jobs[jobId];
+    if(++job.waits > _maxWaits) {
+        _fail(jobId, tr("Terrain data not available"));
+        return;
+    }
+    QSet<quint64>           tiles;
+    QList<QGeoCoordinate>   coordinates;
+    for(int i = 0; i < job.latitudes.count(); i++) {
+        quint64 tile = (static_cast<quint64>(static_cast<quint32>(_elevationTileIndex(job.longitudes[i], 180.0))) << 32) |
+                        static_cast<quint32>(_elevationTileIndex(job.latitudes[i], 90.0));
+        if(!tiles.contains(tile)) {
+            tiles.insert(tile);
+            coordinates.append(QGeoCoordinate(job.latitudes[i], job.longitudes[i]));
+        }
+    }
+    TerrainAtCoordinateQuery* query = new TerrainAtCoordinateQuery(true /* autoDelete */);
+    connect(query, &TerrainAtCoordinateQuery::terrainDataReceived, this, [this, jobId](bool success, QList<double> /*heights*/) {
+        if(!_jobs.contains(jobId)) {
+            return;
+        }
+        if(success) {
+            _sample(jobId);
+        } else {
+            _fail(jobId, tr("Terrain data not available"));
+        }
+    });
+    query->requestData(coordinates);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTerrainTileRenderer::_fail(quint64 jobId, const QString& errorString)
+{
+    QGeoTiledMapReplyQGC* reply = _jobs.take(jobId).reply;
+    reply->_renderFailed(errorString);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTerrainTileRenderer::_rendered(quint64 jobId, QByteArray image)
+{
+    if(!_jobs.contains(jobId)) {
+        return;
+    }
+    QGeoTiledMapReplyQGC* reply = _jobs.take(jobId).reply;
+    if(image.isEmpty()) {
+        reply->_renderFailed(tr("Terrain tile could not be rendered"));
+    } else {
+        reply->_renderFinished(image);
+    }
+}
+
+//-----------------------------------------------------------------------------
+QImage
+QGCTerrainTileRenderer::shade(const QVector<double>& heights, int samples, double sampleMeters, bool tinted, int tileSize)
+{
+    const int       stride      = samples + 2;
+    const double    zenith      = (90.0 - kSunAltitude) * M_PI / 180.0;
+    const double    azimuth     = fmod(360.0 - kSunAzimuth + 90.0, 360.0) * M_PI / 180.0;
+    auto            height      = [&heights, stride](int column, int row) { return heights[(row + 1) * stride + column + 1]; };
+
+    //-- Colors at the samples, pixels in between are interpolated
+    QVector<QRgb> colors(samples * samples);
+    for(int row = 0; row < samples; row++) {
+        for(int column = 0; column < samples; column++) {
+            double dzdx     = kExaggeration * (height(column + 1, row) - height(column - 1, row)) / (2 * sampleMeters);
+            double dzdy     = kExaggeration * (height(column, row + 1) - height(column, row - 1)) / (2 * sampleMeters);
+            double slope    = atan(sqrt(dzdx * dzdx + dzdy * dzdy));
+            double aspect   = atan2(dzdy, -dzdx);
+            double light    = qBound(0.0, cos(zenith) * cos(slope) + sin(zenith) * sin(slope) * cos(azimuth - aspect), 1.0);
+            QRgb   color;
+            if(tinted) {
+                QRgb    base    = _elevationColor(height(column, row));
+                double  factor  = 0.35 + 0.65 * light;
+                color = qRgb(static_cast<int>(qRed(base) * factor), static_cast<int>(qGreen(base) * factor), static_cast<int>(qBlue(base) * factor));
+            } else {
+                int gray = static_cast<int>(255 * light);
+                color = qRgb(gray, gray, gray);
+            }
+            colors[row * samples + column] = color;
+        }
+    }
+
+    QImage image(tileSize, tileSize, QImage::Format_RGB32);
+    const double scale = static_cast<double>(samples - 1) / (tileSize - 1);
+    for(int py = 0; py < tileSize; py++) {
+        double  fy      = py * scale;
+        int     row0    = qMin(static_cast<int>(fy), samples - 2);
+        double  ty      = fy - row0;
+        QRgb*   line    = reinterpret_cast<QRgb*>(image.scanLine(py));
+        for(int px = 0; px < tileSize; px++) {
+            double  fx      = px * scale;
+            int     column0 = qMin(static_cast<int>(fx), samples - 2);
+            double  tx      = fx - column0;
+            QRgb    c00     = colors[row0 * samples + column0];
+            QRgb    c10     = colors[row0 * samples + column0 + 1];
+            QRgb    c01     = colors[(row0 + 1) * samples + column0];
+            QRgb    c11     = colors[(row0 + 1) * samples + column0 + 1];
+            auto    mix     = [tx, ty](int v00, int v10, int v01, int v11) {
+                return static_cast<int>((v00 * (1 - tx) + v10 * tx) * (1 - ty) + (v01 * (1 - tx) + v11 * tx) * ty);
+            };
+            line[px] = qRgb(mix(qRed(c00),   qRed(c10),   qRed(c01),   qRed(c11)),
+                            mix(qGreen(c00), qGreen(c10), qGreen(c01), qGreen(c11)),
+                            mix(qBlue(c00),  qBlue(c10),  qBlue(c01),  qBlue(c11)));
+        }
+    }
+    return image;
+}
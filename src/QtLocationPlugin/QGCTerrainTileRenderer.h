@@ -0,0 +1,74 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QVector>
+
+class QGeoTiledMapReplyQGC;
+
+/// Renders the map tiles of the terrain map types from the elevation tiles the terrain queries use.
+///
+/// Only the tiles QtLocation asks for are rendered, and they go into the tile cache like downloaded ones. Heights are
+/// sampled on the GUI thread which manages the elevation tiles; shading and PNG encoding run on a worker pool. A map
+/// tile whose elevation tiles aren't in memory waits for them to be read from the cache database or downloaded.
+class QGCTerrainTileRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    QGCTerrainTileRenderer(QObject* parent = nullptr);
+    ~QGCTerrainTileRenderer();
+
+    /// The reply gets its image through QGeoTiledMapReplyQGC::_renderFinished or _renderFailed
+    void render (QGeoTiledMapReplyQGC* reply);
+    /// Call when the reply is aborted or goes away before it has its image
+    void cancel (QGeoTiledMapReplyQGC* reply);
+
+    /// Shades a grid of heights lit from the north west
+    ///     @param heights (samples + 2)^2 heights, rows from north to south, with a ring of samples past the tile edges
+    ///     @param samples Samples across the tile, the first and last are on its edges
+    ///     @param sampleMeters Distance between samples
+    ///     @param tinted true: colored by elevation, false: gray
+    static QImage shade(const QVector<double>& heights, int samples, double sampleMeters, bool tinted, int tileSize = 256);
+
+    static const int minZoom    = 13;   ///< Below this a map tile covers too many elevation tiles
+    static const int samples    = 65;   ///< Across a map tile, ~20m apart at zoom 15
+
+private slots:
+    void _rendered(quint64 jobId, QByteArray image);
+
+private:
+    typedef struct {
+        QGeoTiledMapReplyQGC*       reply;
+        bool                        tinted;
+        int                         waits;          ///< Times the elevation tiles were waited for
+        double                      sampleMeters;
+        QVector<double>             latitudes;
+        QVector<double>             longitudes;
+        QSharedPointer<QAtomicInt>  cancelled;      ///< Shared with the worker once rendering is queued
+    } Job_t;
+
+    void _sample        (quint64 jobId);
+    void _waitForTiles  (quint64 jobId);
+    void _fail          (quint64 jobId, const QString& errorString);
+
+    QHash<quint64, Job_t>   _jobs;
+    quint64                 _nextJobId;
+    QThreadPool             _pool;
+
+    static const int _maxWaits = 3;     ///< Elevation tiles may be dropped from memory again before the tile is sampled
+};
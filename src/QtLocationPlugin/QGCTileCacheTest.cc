@@ -0,0 +1,189 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileCacheTest.h"
+#include "QGCTileCacheWorker.h"
+#include "QGCMapEngineData.h"
+
+#include <QDir>
+#include <QTemporaryDir>
+#include <QtSql/QSqlQuery>
+
+const char* QGCTileCacheTest::_tileFormat   = "png";
+const char* QGCTileCacheTest::_tileType     = "Google Street Map";
+
+/// Returns once the worker has opened its database
+void QGCTileCacheTest::_startWorker(QGCCacheWorker& worker, const QString& path)
+{
+    worker.setDatabaseFile(path);
+    worker.enqueueTask(new QGCMapTask(QGCMapTask::taskInit));
+    //-- Until then every other task is turned down
+    QVERIFY(QTest::qWaitFor([&]() {
+        QString errorString;
+        _fetchTile(worker, QStringLiteral("none"), &errorString);
+        return errorString != QStringLiteral("Database Not Initialized");
+    }, 10000));
+}
+
+void QGCTileCacheTest::_stopWorker(QGCCacheWorker& worker)
+{
+    worker.quit();
+    QVERIFY(worker.wait(10000));
+}
+
+/// Returns once the readers see the tile
+void QGCTileCacheTest::_saveTile(QGCCacheWorker& worker, const QString& hash, const QByteArray& img)
+{
+    worker.enqueueTask(new QGCSaveTileTask(new QGCCacheTile(hash, img, _tileFormat, _tileType)));
+    QVERIFY(QTest::qWaitFor([&]() { return _fetchTile(worker, hash) == img; }, 10000));
+}
+
+/// Looks the tile up through the reader pool, returns an empty array with the error in errorString if it isn't there
+QByteArray QGCTileCacheTest::_fetchTile(QGCCacheWorker& worker, const QString& hash, QString* errorString)
+{
+    QObject     context;
+    QByteArray  img;
+    bool        done = false;
+    QGCFetchTileTask* task = new QGCFetchTileTask(hash);
+    connect(task, &QGCFetchTileTask::tileFetched, &context, [&](QGCCacheTile* tile) {
+        img = tile->img();
+        delete tile;
+        done = true;
+    });
+    connect(task, &QGCFetchTileTask::tileEmpty, &context, [&]() { done = true; });
+    connect(task, &QGCMapTask::error, &context, [&](QGCMapTask::TaskType, QString error) {
+        if (errorString) {
+            *errorString = error;
+        }
+        done = true;
+    });
+    worker.enqueueTask(task);
+    if (!QTest::qWaitFor([&]() { return done; }, 10000) && errorString) {
+        *errorString = QStringLiteral("Timeout");
+    }
+    return img;
+}
+
+/// Moves what the worker left in the WAL into the database file, an import only copies the file itself
+void QGCTileCacheTest::_checkpoint(const QString& path)
+{
+    const QString session = QStringLiteral("QGCTileCacheTestCheckpoint");
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", session);
+        db.setDatabaseName(path);
+        QVERIFY(db.open());
+        QVERIFY(QSqlQuery(db).exec("PRAGMA wal_checkpoint(TRUNCATE)"));
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(session);
+}
+
+/// Imports path in place of the cache with the given number of fetches kept in flight throughout, returns the
+/// import error
+QString QGCTileCacheTest::_importReplace(QGCCacheWorker& worker, const QString& path, int readers)
+{
+    QObject context;
+    int     outstanding = 0;
+    bool    completed   = false;
+    QString importError;
+
+    auto fetch = [&]() {
+        QGCFetchTileTask* task = new QGCFetchTileTask(QStringLiteral("old"));
+        connect(task, &QGCFetchTileTask::tileFetched, &context, [&](QGCCacheTile* tile) { delete tile; outstanding--; });
+        connect(task, &QGCFetchTileTask::tileEmpty, &context, [&]() { outstanding--; });
+        connect(task, &QGCMapTask::error, &context, [&]() { outstanding--; });
+        outstanding++;
+        worker.enqueueTask(task);
+    };
+
+    //-- Warm every reader thread up with a connection on the database about to be replaced
+    for (int i = 0; i < readers; i++) {
+        fetch();
+    }
+    QGCImportTileTask* task = new QGCImportTileTask(path, true);
+    connect(task, &QGCMapTask::error, &context, [&](QGCMapTask::TaskType, QString error) { importError = error; });
+    connect(task, &QGCTransferTileTask::actionCompleted, &context, [&]() { completed = true; });
+    worker.enqueueTask(task);
+    while (!completed && QTest::qWaitFor([&]() { return completed || outstanding < readers; }, 10000)) {
+        while (outstanding < readers) {
+            fetch();
+        }
+    }
+    if (!completed) {
+        return QStringLiteral("Timeout");
+    }
+    //-- Fetches which waited out the swap still complete
+    if (!QTest::qWaitFor([&]() { return outstanding == 0; }, 10000)) {
+        return QStringLiteral("Fetches lost");
+    }
+    return importError;
+}
+
+void QGCTileCacheTest::_importReplaceTest(void)
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString importPath = tempDir.filePath("import.db");
+    const QString cachePath  = tempDir.filePath("cache.db");
+
+    {
+        QGCCacheWorker worker;
+        _startWorker(worker, importPath);
+        _saveTile(worker, QStringLiteral("new"), QByteArray("new tile"));
+        _stopWorker(worker);
+    }
+    _checkpoint(importPath);
+
+    QGCCacheWorker worker;
+    _startWorker(worker, cachePath);
+    _saveTile(worker, QStringLiteral("old"), QByteArray("old tile"));
+
+    QCOMPARE(_importReplace(worker, importPath, 20), QString());
+
+    //-- The readers opened the imported file, not the old one still open from before
+    QString errorString;
+    QCOMPARE(_fetchTile(worker, QStringLiteral("new")), QByteArray("new tile"));
+    QCOMPARE(_fetchTile(worker, QStringLiteral("old"), &errorString), QByteArray());
+    QCOMPARE(errorString, QStringLiteral("Tile not in cache database"));
+
+    //-- The cache takes tiles again
+    _saveTile(worker, QStringLiteral("after"), QByteArray("after tile"));
+
+    QVERIFY(!QFile::exists(cachePath + "-replaced"));
+    QVERIFY(!QFile::exists(cachePath + ".import"));
+    _stopWorker(worker);
+}
+
+void QGCTileCacheTest::_importReplaceFailTest(void)
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString importPath = tempDir.filePath("import.db");
+    const QString cachePath  = tempDir.filePath("cache.db");
+
+    QFile importFile(importPath);
+    QVERIFY(importFile.open(QIODevice::WriteOnly));
+    importFile.write("not used, the swap fails first");
+    importFile.close();
+
+    QGCCacheWorker worker;
+    _startWorker(worker, cachePath);
+    _saveTile(worker, QStringLiteral("old"), QByteArray("old tile"));
+
+    //-- A directory where the old file is moved aside can't be removed or renamed over
+    QVERIFY(QDir(tempDir.path()).mkpath("cache.db-replaced/busy"));
+
+    QCOMPARE(_importReplace(worker, importPath, 20), QStringLiteral("Unable to replace tile cache database"));
+
+    //-- The old cache is back in place and still served
+    QCOMPARE(_fetchTile(worker, QStringLiteral("old")), QByteArray("old tile"));
+    _saveTile(worker, QStringLiteral("after"), QByteArray("after tile"));
+    QVERIFY(!QFile::exists(cachePath + ".import"));
+    _stopWorker(worker);
+}
@@ -0,0 +1,35 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class QGCCacheWorker;
+
+/// Runs its own QGCCacheWorker on temporary databases, next to the map engine's
+class QGCTileCacheTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _importReplaceTest     (void);
+    void _importReplaceFailTest (void);
+
+private:
+    void        _startWorker    (QGCCacheWorker& worker, const QString& path);
+    void        _stopWorker     (QGCCacheWorker& worker);
+    void        _saveTile       (QGCCacheWorker& worker, const QString& hash, const QByteArray& img);
+    QByteArray  _fetchTile      (QGCCacheWorker& worker, const QString& hash, QString* errorString = nullptr);
+    void        _checkpoint     (const QString& path);
+    QString     _importReplace  (QGCCacheWorker& worker, const QString& path, int readers);
+
+    static const char* _tileFormat;
+    static const char* _tileType;
+};
@@ -18,6 +18,7 @@
 
 #include "QGCMapEngine.h"
 #include "QGCMapTileSet.h"
+#include "QGCTrace.h"
 
 #include <QVariant>
 #include <QtSql/QSqlQuery>
@@ -26,13 +27,26 @@
 #include <QDateTime>
 #include <QApplication>
 #include <QFile>
-#include <QSettings>
+#include <QRunnable>
+#include <QThreadStorage>
 
 #include "time.h"
 
 static const char*      kDefaultSet     = "Default Tile Set";
-static const QString    kSession        = QStringLiteral("QGeoTileWorkerSession");
+static const QString    kSession        = QStringLiteral("QGeoTileWorkerSession%1");
 static const QString    kExportSession  = QStringLiteral("QGeoTileExportSession");
+static const QString    kReaderSession  = QStringLiteral("QGeoTileReaderSession%1");
+static const uint       kTouchInterval  = 24 * 60 * 60;     ///< Seconds between updates of a tile's last used date
+static const int        kReaderThreads  = 3;
+static const int        kSaveBatchSize  = 64;               ///< Maximum number of queued tile saves written in a single transaction
+static const int        kDeleteChunk    = 1000;             ///< Tiles removed per transaction when deleting a tile set
+static const int        kFetchBatchSize = 50;               ///< Maximum number of queued tile fetches looked up in a single query
+static const uint       kEmptyTileTTL   = 7 * 24 * 60 * 60; ///< Seconds a tile the provider doesn't have is not asked for again
+static const int        kTransferChunk  = 256;              ///< Tiles copied per transaction when exporting or importing tile sets
+static const qint64     kCopyChunk      = 4 * 1024 * 1024;  ///< Bytes copied at a time when an import replaces the cache
+
+//-- Tiles of set %1 which are in no other set. Uses the SetTiles indices so the cost follows the size of the set, not of the cache.
+#define UNIQUE_SET_TILES "FROM Tiles T JOIN SetTiles A ON T.tileID = A.tileID WHERE A.setID = %1 AND NOT EXISTS (SELECT 1 FROM SetTiles B WHERE B.tileID = A.tileID AND B.setID != %1)"
 
 QGC_LOGGING_CATEGORY(QGCTileCacheLog, "QGCTileCacheLog")
 
@@ -41,6 +55,86 @@ QGC_LOGGING_CATEGORY(QGCTileCacheLog, "QGCTileCacheLog")
 #define LONG_TIMEOUT        5
 #define SHORT_TIMEOUT       2
 
+//-----------------------------------------------------------------------------
+/// Read only connection owned by one reader pool thread, closed when the thread exits
+class QGCTileReaderConnection
+{
+public:
+    QGCTileReaderConnection(const QString& path, int generation)
+        : generation(generation)
+        , _session(kReaderSession.arg(reinterpret_cast<quintptr>(QThread::currentThreadId())))
+    {
+        db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", _session));
+        db->setDatabaseName(path);
+        //-- Read only so a reader never creates an empty database while the file is being replaced
+        db->setConnectOptions("QSQLITE_OPEN_READONLY");
+        if(!db->open()) {
+            qCWarning(QGCTileCacheLog) << "Map Cache SQL error (open reader db):" << db->lastError();
+        }
+    }
+    ~QGCTileReaderConnection()
+    {
+        delete db;
+        QSqlDatabase::removeDatabase(_session);
+    }
+
+    QSqlDatabase*   db;
+    int             generation;
+
+private:
+    QString         _session;
+};
+
+static QThreadStorage<QGCTileReaderConnection*> _readerConnections;
+
+//-----------------------------------------------------------------------------
+/// Runs the queued fetch tasks on the reader pool, up to kFetchBatchSize in one query, until there are none left
+class QGCFetchTileRunnable : public QRunnable
+{
+public:
+    QGCFetchTileRunnable(QGCCacheWorker* worker)
+        : _worker(worker)
+        , _ran(false)
+    {
+    }
+    ~QGCFetchTileRunnable()
+    {
+        //-- The pool was cleared before we ran
+        if(!_ran) {
+            _worker->_fetchRunnableCancelled();
+        }
+    }
+
+    void run() override
+    {
+        _ran = true;
+        int generation = _worker->_readerGeneration.loadAcquire();
+        QGCTileReaderConnection* connection = _readerConnections.localData();
+        if(!connection || connection->generation != generation) {
+            connection = new QGCTileReaderConnection(_worker->_databasePath, generation);
+            _readerConnections.setLocalData(connection);  // Deletes the previous connection
+        }
+        while(true) {
+            QList<QGCMapTask*> tasks = _worker->_takeFetchBatch();
+            if(tasks.isEmpty()) {
+                break;
+            }
+            _worker->_getTiles(tasks, connection->db);
+            for(QGCMapTask* task: tasks) {
+                task->deleteLater();
+            }
+        }
+        //-- The file was replaced while we ran, don't keep the old one open on an idle pool thread
+        if(connection->generation != _worker->_readerGeneration.loadAcquire()) {
+            _readerConnections.setLocalData(nullptr);
+        }
+    }
+
+private:
+    QGCCacheWorker* _worker;
+    bool            _ran;
+};
+
 //-----------------------------------------------------------------------------
 QGCCacheWorker::QGCCacheWorker()
     : _db(nullptr)
@@ -53,13 +147,26 @@ QGCCacheWorker::QGCCacheWorker()
     , _defaultCount(0)
     , _lastUpdate(0)
     , _updateTimeout(SHORT_TIMEOUT)
-    , _hostLookupID(0)
+    , _totalsDirty(true)
+    , _deletedSetsChecked(false)
+    , _fetchRunnables(0)
+    , _readersPaused(false)
+    , _transferTask(nullptr)
+    , _transferLastTileID(0)
+    , _transferTotal(0)
+    , _transferDone(0)
+    , _transferSaved(0)
+    , _transferPercent(-1)
+    , _session(kSession.arg(reinterpret_cast<quintptr>(this)))
 {
+    _readerPool.setMaxThreadCount(kReaderThreads);
 }
 
 //-----------------------------------------------------------------------------
 QGCCacheWorker::~QGCCacheWorker()
 {
+    _readerPool.clear();
+    _readerPool.waitForDone();
 }
 
 //-----------------------------------------------------------------------------
@@ -73,15 +180,17 @@ QGCCacheWorker::setDatabaseFile(const QString& path)
 void
 QGCCacheWorker::quit()
 {
-    if(_hostLookupID) {
-        QHostInfo::abortHostLookup(_hostLookupID);
-    }
     _mutex.lock();
     while(_taskQueue.count()) {
         QGCMapTask* task = _taskQueue.dequeue();
         delete task;
     }
     _mutex.unlock();
+    _readerPool.clear();
+    _fetchMutex.lock();
+    qDeleteAll(_pendingFetches);
+    _pendingFetches.clear();
+    _fetchMutex.unlock();
     if(this->isRunning()) {
         _waitc.wakeAll();
     }
@@ -97,6 +206,21 @@ QGCCacheWorker::enqueueTask(QGCMapTask* task)
         task->deleteLater();
         return false;
     }
+    //-- Fetches go straight to the reader pool instead of waiting behind saves and set maintenance. While all the
+    //   readers are busy they pile up and the next free reader looks them up together.
+    if(task->type() == QGCMapTask::taskFetchTile) {
+        _fetchMutex.lock();
+        _pendingFetches.append(task);
+        bool startReader = !_readersPaused && _fetchRunnables < kReaderThreads;
+        if(startReader) {
+            _fetchRunnables++;
+        }
+        _fetchMutex.unlock();
+        if(startReader) {
+            _readerPool.start(new QGCFetchTileRunnable(this));
+        }
+        return true;
+    }
     _mutex.lock();
     _taskQueue.enqueue(task);
     _mutex.unlock();
@@ -112,66 +236,90 @@ QGCCacheWorker::enqueueTask(QGCMapTask* task)
 void
 QGCCacheWorker::run()
 {
+    QGCTrace::setThreadName(QStringLiteral("Tile Cache"));
     if(!_valid && !_failed) {
         _init();
     }
     if(_valid) {
-        _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession));
-        _db->setDatabaseName(_databasePath);
-        _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-        _valid = _db->open();
+        _valid = _openDB();
+    }
+    if(_valid) {
+        _pruneEmptyTiles();
+    }
+    if(_valid && !_deletedSetsChecked) {
+        _deletedSetsChecked = true;
+        _findDeletedTileSets();
     }
-    _deleteBingNoTileTiles();
     while(true) {
         QGCMapTask* task;
+        if(!_taskQueue.count() && _transferTask) {
+            //-- Exports and imports run in chunks while there is nothing else to do
+            _transferChunk();
+            continue;
+        }
+        if(!_taskQueue.count() && _deletedSets.count()) {
+            //-- Set deletion runs in chunks while there is nothing else to do
+            _deleteTileSetChunk();
+            continue;
+        }
         if(_taskQueue.count()) {
             _mutex.lock();
             task = _taskQueue.dequeue();
             _mutex.unlock();
-            switch(task->type()) {
-                case QGCMapTask::taskInit:
-                    break;
-                case QGCMapTask::taskCacheTile:
-                    _saveTile(task);
-                    break;
-                case QGCMapTask::taskFetchTile:
-                    _getTile(task);
-                    break;
-                case QGCMapTask::taskFetchTileSets:
-                    _getTileSets(task);
-                    break;
-                case QGCMapTask::taskCreateTileSet:
-                    _createTileSet(task);
-                    break;
-                case QGCMapTask::taskGetTileDownloadList:
-                    _getTileDownloadList(task);
-                    break;
-                case QGCMapTask::taskUpdateTileDownloadState:
-                    _updateTileDownloadState(task);
-                    break;
-                case QGCMapTask::taskDeleteTileSet:
-                    _deleteTileSet(task);
-                    break;
-                case QGCMapTask::taskRenameTileSet:
-                    _renameTileSet(task);
-                    break;
-                case QGCMapTask::taskPruneCache:
-                    _pruneCache(task);
-                    break;
-                case QGCMapTask::taskReset:
-                    _resetCacheDatabase(task);
-                    break;
-                case QGCMapTask::taskExport:
-                    _exportSets(task);
-                    break;
-                case QGCMapTask::taskImport:
-                    _importSets(task);
-                    break;
-                case QGCMapTask::taskTestInternet:
-                    _testInternet();
-                    break;
+            {
+                QGC_TRACE_SCOPE_ARG("TileCache", "task", "type", task->type());
+                switch(task->type()) {
+                    case QGCMapTask::taskInit:
+                        break;
+                    case QGCMapTask::taskCacheTile:
+                        _saveTiles(task);
+                        break;
+                    case QGCMapTask::taskFetchTile:
+                        _getTiles(QList<QGCMapTask*>() << task, _db);
+                        break;
+                    case QGCMapTask::taskFetchTileSets:
+                        _getTileSets(task);
+                        break;
+                    case QGCMapTask::taskCreateTileSet:
+                        _createTileSet(task);
+                        break;
+                    case QGCMapTask::taskGetTileDownloadList:
+                        _getTileDownloadList(task);
+                        break;
+                    case QGCMapTask::taskUpdateTileDownloadState:
+                        _updateTileDownloadState(task);
+                        break;
+                    case QGCMapTask::taskDeleteTileSet:
+                        _deleteTileSet(task);
+                        break;
+                    case QGCMapTask::taskRenameTileSet:
+                        _renameTileSet(task);
+                        break;
+                    case QGCMapTask::taskPruneCache:
+                        _pruneCache(task);
+                        break;
+                    case QGCMapTask::taskReset:
+                        _resetCacheDatabase(task);
+                        break;
+                    case QGCMapTask::taskExport:
+                    case QGCMapTask::taskImport:
+                        if(_startTransfer(task)) {
+                            //-- Deleted once the transfer is done
+                            task = nullptr;
+                        }
+                        break;
+                }
+            }
+            if(task) {
+                task->deleteLater();
+            }
+            //-- Keep transfers and set deletion moving even under a steady stream of tasks
+            if(_transferTask) {
+                _transferChunk();
+            }
+            if(_deletedSets.count()) {
+                _deleteTileSetChunk();
             }
-            task->deleteLater();
             //-- Check for update timeout
             size_t count = static_cast<size_t>(_taskQueue.count());
             if(count > 100) {
@@ -181,7 +329,12 @@ QGCCacheWorker::run()
             }
             if(!count || (time(nullptr) - _lastUpdate > _updateTimeout)) {
                 if(_valid) {
-                    _updateTotals();
+                    _flushTouchedTiles();
+                    if(_totalsDirty) {
+                        _updateTotals();
+                    } else {
+                        _emitTotals();
+                    }
                 }
             }
         } else {
@@ -199,52 +352,70 @@ QGCCacheWorker::run()
             _mutex.unlock();
         }
     }
+    if(_valid) {
+        _flushTouchedTiles();
+    }
     if(_db) {
         delete _db;
         _db = nullptr;
-        QSqlDatabase::removeDatabase(kSession);
+        QSqlDatabase::removeDatabase(_session);
     }
 }
 
 //-----------------------------------------------------------------------------
-void
-QGCCacheWorker::_deleteBingNoTileTiles()
+// WAL lets the reader pool keep reading while this connection writes
+bool
+QGCCacheWorker::_openDB()
 {
-    QSettings settings;
-    static const char* alreadyDoneKey = "_deleteBingNoTileTilesDone";
+    _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", _session));
+    _db->setDatabaseName(_databasePath);
+    if(!_db->open()) {
+        qCritical() << "Map Cache SQL error (open db):" << _db->lastError();
+        return false;
+    }
+    QSqlQuery query(*_db);
+    if(!query.exec("PRAGMA journal_mode=WAL")) {
+        qWarning() << "Map Cache SQL error (WAL mode):" << query.lastError().text();
+    }
+    query.exec("PRAGMA synchronous=NORMAL");
+    return true;
+}
 
-    if (settings.value(alreadyDoneKey, false).toBool()) {
-        return;
+//-----------------------------------------------------------------------------
+// Markers past their TTL are ignored by lookups already, this only keeps the table from growing. Goes by the date index.
+void
+QGCCacheWorker::_pruneEmptyTiles()
+{
+    QSqlQuery query(*_db);
+    QString s = QString("DELETE FROM EmptyTiles WHERE date < %1").arg(QDateTime::currentDateTime().toTime_t() - kEmptyTileTTL);
+    if(!query.exec(s)) {
+        qCWarning(QGCTileCacheLog) << "Map Cache SQL error (prune empty tiles):" << query.lastError().text();
     }
-    settings.setValue(alreadyDoneKey, true);
+}
 
-    // Previously we would store these empty tile graphics in the cache. This prevented the ability to zoom beyong the level
-    // of available tiles. So we need to remove only of these still hanging around to make higher zoom levels work.
+//-----------------------------------------------------------------------------
+// Previously we would store the empty tile graphic of Bing in the cache. This prevented the ability to zoom beyond the level
+// of available tiles. Runs once, when the database gets the EmptyTiles table which replaces those tiles. The comparison is
+// left to SQLite so the tiles aren't read into memory.
+void
+QGCCacheWorker::_deleteBingNoTileTiles(QSqlDatabase* db)
+{
     QFile file(":/res/BingNoTileBytes.dat");
-    file.open(QFile::ReadOnly);
+    if(!file.open(QFile::ReadOnly)) {
+        return;
+    }
     QByteArray noTileBytes = file.readAll();
     file.close();
-
-    QSqlQuery query(*_db);
-    QString s;
-    //-- Select tiles in default set only, sorted by oldest.
-    s = QString("SELECT tileID, tile, hash FROM Tiles WHERE LENGTH(tile) = %1").arg(noTileBytes.count());
-    QList<quint64> idsToDelete;
-    if (query.exec(s)) {
-        while(query.next()) {
-            if (query.value(1).toByteArray() == noTileBytes) {
-                idsToDelete.append(query.value(0).toULongLong());
-                qCDebug(QGCTileCacheLog) << "_deleteBingNoTileTiles HASH:" << query.value(2).toString();
-            }
-        }
-        for (const quint64 tileId: idsToDelete) {
-            s = QString("DELETE FROM Tiles WHERE tileID = %1").arg(tileId);
-            if (!query.exec(s)) {
-                qCWarning(QGCTileCacheLog) << "Delete failed";
-            }
-        }
-    } else {
+    QSqlQuery query(*db);
+    query.prepare("DELETE FROM Tiles WHERE size = ? AND tile = ?");
+    query.addBindValue(noTileBytes.size());
+    query.addBindValue(noTileBytes);
+    if(!query.exec()) {
         qCWarning(QGCTileCacheLog) << "_deleteBingNoTileTiles query failed";
+    } else if(query.numRowsAffected() > 0) {
+        qCDebug(QGCTileCacheLog) << "_deleteBingNoTileTiles" << query.numRowsAffected();
+        query.exec("DELETE FROM SetTiles WHERE NOT EXISTS (SELECT 1 FROM Tiles T WHERE T.tileID = SetTiles.tileID)");
+        _totalsDirty = true;
     }
 }
 
@@ -287,6 +458,16 @@ QGCCacheWorker::_saveTile(QGCMapTask *mtask)
     if(_valid) {
         QGCSaveTileTask* task = static_cast<QGCSaveTileTask*>(mtask);
         QSqlQuery query(*_db);
+        if(task->tile()->img().isEmpty()) {
+            //-- Marks a tile the provider doesn't have, renewing the date of an older marker
+            query.prepare("INSERT OR REPLACE INTO EmptyTiles(hash, date) VALUES(?, ?)");
+            query.addBindValue(task->tile()->hash());
+            query.addBindValue(QDateTime::currentDateTime().toTime_t());
+            if(!query.exec()) {
+                qWarning() << "Map Cache SQL error (add empty tile):" << query.lastError().text();
+            }
+            return;
+        }
         query.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
         query.addBindValue(task->tile()->hash());
         query.addBindValue(task->tile()->format());
@@ -302,6 +483,14 @@ QGCCacheWorker::_saveTile(QGCMapTask *mtask)
             if(!query.exec()) {
                 qWarning() << "Map Cache SQL error (add tile into SetTiles):" << query.lastError().text();
             }
+            //-- A new tile only belongs to the set it was saved into
+            quint64 size = static_cast<quint64>(task->tile()->img().size());
+            _totalCount++;
+            _totalSize += size;
+            if(setID == _getDefaultTileSet()) {
+                _defaultCount++;
+                _defaultSize += size;
+            }
             qCDebug(QGCTileCacheLog) << "_saveTile() HASH:" << task->tile()->hash();
         } else {
             //-- Tile was already there.
@@ -313,31 +502,190 @@ QGCCacheWorker::_saveTile(QGCMapTask *mtask)
 }
 
 //-----------------------------------------------------------------------------
+// Saves this task and the save tasks queued right behind it in a single transaction
 void
-QGCCacheWorker::_getTile(QGCMapTask* mtask)
+QGCCacheWorker::_saveTiles(QGCMapTask* mtask)
 {
-    if(!_testTask(mtask)) {
+    QList<QGCMapTask*> tasks;
+    _mutex.lock();
+    while(tasks.count() < kSaveBatchSize - 1 && _taskQueue.count() && _taskQueue.head()->type() == QGCMapTask::taskCacheTile) {
+        tasks.append(_taskQueue.dequeue());
+    }
+    _mutex.unlock();
+    if(_valid) {
+        _db->transaction();
+    }
+    _saveTile(mtask);
+    for(QGCMapTask* task: tasks) {
+        _saveTile(task);
+        task->deleteLater();
+    }
+    if(_valid) {
+        _db->commit();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Called from the reader pool, an empty list means the reader is done and counted out
+QList<QGCMapTask*>
+QGCCacheWorker::_takeFetchBatch()
+{
+    QMutexLocker lock(&_fetchMutex);
+    QList<QGCMapTask*> tasks;
+    if(!_readersPaused) {
+        tasks = _pendingFetches.mid(0, kFetchBatchSize);
+        _pendingFetches.erase(_pendingFetches.begin(), _pendingFetches.begin() + tasks.count());
+    }
+    if(tasks.isEmpty()) {
+        _fetchRunnables--;
+    }
+    return tasks;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_fetchRunnableCancelled()
+{
+    QMutexLocker lock(&_fetchMutex);
+    _fetchRunnables--;
+}
+
+//-----------------------------------------------------------------------------
+// Fetches queued from now on wait in _pendingFetches until _startReaders(). Waiting for the pool also ends its idle
+// threads, which closes the read only connections they keep in _readerConnections.
+void
+QGCCacheWorker::_stopReaders()
+{
+    _fetchMutex.lock();
+    _readersPaused = true;
+    _fetchMutex.unlock();
+    _readerGeneration.fetchAndAddOrdered(1);
+    _readerPool.clear();
+    _readerPool.waitForDone();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_startReaders()
+{
+    _fetchMutex.lock();
+    _readersPaused = false;
+    int start = qMin(_pendingFetches.count(), kReaderThreads - _fetchRunnables);
+    _fetchRunnables += qMax(start, 0);
+    _fetchMutex.unlock();
+    for(int i = 0; i < start; i++) {
+        _readerPool.start(new QGCFetchTileRunnable(this));
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Called from the reader pool with that thread's connection, must not write to the database
+void
+QGCCacheWorker::_getTiles(const QList<QGCMapTask*>& mtasks, QSqlDatabase* db)
+{
+    //-- The same tile may be asked for more than once
+    QHash<QString, QList<QGCFetchTileTask*>> tasks;
+    QStringList hashes;
+    for(QGCMapTask* mtask: mtasks) {
+        if(!_testTask(mtask)) {
+            continue;
+        }
+        QGCFetchTileTask* task = static_cast<QGCFetchTileTask*>(mtask);
+        if(!tasks.contains(task->hash())) {
+            hashes.append(QString("\"%1\"").arg(task->hash()));
+        }
+        tasks[task->hash()].append(task);
+    }
+    if(tasks.isEmpty()) {
         return;
     }
-    bool found = false;
-    QGCFetchTileTask* task = static_cast<QGCFetchTileTask*>(mtask);
-    QSqlQuery query(*_db);
-    QString s = QString("SELECT tile, format, type FROM Tiles WHERE hash = \"%1\"").arg(task->hash());
+    QSqlQuery query(*db);
+    QString s = QString("SELECT tile, format, type, tileID, date, hash FROM Tiles WHERE hash IN (%1)").arg(hashes.join(","));
     if(query.exec(s)) {
-        if(query.next()) {
+        while(query.next()) {
+            QString hash = query.value(5).toString();
+            QList<QGCFetchTileTask*> found = tasks.take(hash);
+            if(found.isEmpty()) {
+                continue;
+            }
             QByteArray ar   = query.value(0).toByteArray();
             QString format  = query.value(1).toString();
-            QString type = getQGCMapEngine()->urlFactory()->getTypeFromId(query.value(2).toInt());
-            qCDebug(QGCTileCacheLog) << "_getTile() (Found in DB) HASH:" << task->hash();
-            QGCCacheTile* tile = new QGCCacheTile(task->hash(), ar, format, type);
-            task->setTileFetched(tile);
-            found = true;
+            QString type    = getQGCMapEngine()->urlFactory()->getTypeFromId(query.value(2).toInt());
+            quint64 tileID  = query.value(3).toULongLong();
+            uint    date    = query.value(4).toUInt();
+            qCDebug(QGCTileCacheLog) << "_getTiles() (Found in DB) HASH:" << hash;
+            //-- Each receiver deletes its tile
+            for(QGCFetchTileTask* task: found) {
+                task->setTileFetched(new QGCCacheTile(hash, ar, format, type));
+            }
+            _touchTile(tileID, date);
+        }
+    } else {
+        qWarning() << "Map Cache SQL error (fetch tiles):" << query.lastError().text();
+    }
+    //-- Of the tiles which aren't there, the ones the provider recently didn't have fail without a network request
+    if(!tasks.isEmpty()) {
+        hashes.clear();
+        for(auto it = tasks.constBegin(); it != tasks.constEnd(); ++it) {
+            hashes.append(QString("\"%1\"").arg(it.key()));
+        }
+        s = QString("SELECT hash FROM EmptyTiles WHERE hash IN (%1) AND date >= %2")
+            .arg(hashes.join(",")).arg(QDateTime::currentDateTime().toTime_t() - kEmptyTileTTL);
+        if(query.exec(s)) {
+            while(query.next()) {
+                QString hash = query.value(0).toString();
+                qCDebug(QGCTileCacheLog) << "_getTiles() (Empty in DB) HASH:" << hash;
+                for(QGCFetchTileTask* task: tasks.take(hash)) {
+                    task->setTileEmpty();
+                }
+            }
+        } else {
+            qWarning() << "Map Cache SQL error (fetch empty tiles):" << query.lastError().text();
+        }
+    }
+    for(auto it = tasks.constBegin(); it != tasks.constEnd(); ++it) {
+        qCDebug(QGCTileCacheLog) << "_getTiles() (NOT in DB) HASH:" << it.key();
+        for(QGCFetchTileTask* task: it.value()) {
+            task->setError("Tile not in cache database");
         }
     }
-    if(!found) {
-        qCDebug(QGCTileCacheLog) << "_getTile() (NOT in DB) HASH:" << task->hash();
-        task->setError("Tile not in cache database");
+}
+
+//-----------------------------------------------------------------------------
+// Pruning removes the oldest dates first, so moving the date forward on use turns it into least recently used
+// eviction. Only done once a day for each tile to stay away from a write for every tile read. The update itself
+// is left to the worker thread which owns the only writable connection.
+void
+QGCCacheWorker::_touchTile(quint64 tileID, uint date)
+{
+    uint now = QDateTime::currentDateTime().toTime_t();
+    if(now - date > kTouchInterval) {
+        QMutexLocker lock(&_touchMutex);
+        _touchedTiles.insert(tileID);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_flushTouchedTiles()
+{
+    _touchMutex.lock();
+    QSet<quint64> tileIDs;
+    tileIDs.swap(_touchedTiles);
+    _touchMutex.unlock();
+    if(tileIDs.isEmpty()) {
+        return;
     }
+    uint now = QDateTime::currentDateTime().toTime_t();
+    QSqlQuery query(*_db);
+    _db->transaction();
+    for(quint64 tileID: tileIDs) {
+        QString s = QString("UPDATE Tiles SET date = %1 WHERE tileID = %2").arg(now).arg(tileID);
+        if(!query.exec(s)) {
+            qWarning() << "Map Cache SQL error (touch tile):" << query.lastError().text();
+        }
+    }
+    _db->commit();
 }
 
 //-----------------------------------------------------------------------------
@@ -382,7 +730,9 @@ void
 QGCCacheWorker::_updateSetTotals(QGCCachedTileSet* set)
 {
     if(set->defaultSet()) {
-        _updateTotals();
+        if(_totalsDirty) {
+            _updateTotals();
+        }
         set->setSavedTileCount(_totalCount);
         set->setSavedTileSize(_totalSize);
         set->setTotalTileCount(_defaultCount);
@@ -412,7 +762,7 @@ QGCCacheWorker::_updateSetTotals(QGCCachedTileSet* set)
             //-- Now figure out the count for tiles unique to this set
             quint32 ucount = 0;
             quint64 usize  = 0;
-            sq = QString("SELECT COUNT(size), SUM(size) FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1)").arg(set->id());
+            sq = QString("SELECT COUNT(T.size), SUM(T.size) " UNIQUE_SET_TILES).arg(set->id());
             if(subquery.exec(sq)) {
                 if(subquery.next()) {
                     //-- This is only accurate when all tiles are downloaded
@@ -447,7 +797,7 @@ QGCCacheWorker::_updateTotals()
             _totalSize  = query.value(1).toULongLong();
         }
     }
-    s = QString("SELECT COUNT(size), SUM(size) FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1)").arg(_getDefaultTileSet());
+    s = QString("SELECT COUNT(T.size), SUM(T.size) " UNIQUE_SET_TILES).arg(_getDefaultTileSet());
     qCDebug(QGCTileCacheLog) << "_updateTotals(): " << s;
     if(query.exec(s)) {
         if(query.next()) {
@@ -455,6 +805,14 @@ QGCCacheWorker::_updateTotals()
             _defaultSize  = query.value(1).toULongLong();
         }
     }
+    _totalsDirty = false;
+    _emitTotals();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_emitTotals()
+{
     emit updateTotals(_totalCount, _totalSize, _defaultCount, _defaultSize);
     _lastUpdate = time(nullptr);
 }
@@ -545,6 +903,8 @@ QGCCacheWorker::_createTileSet(QGCMapTask *mtask)
                 }
             }
             _db->commit();
+            //-- Cached tiles which joined the set are no longer unique to the default set
+            _totalsDirty = true;
             //-- Done
             _updateSetTotals(task->tileSet());
             task->setTileSetSaved();
@@ -564,7 +924,8 @@ QGCCacheWorker::_getTileDownloadList(QGCMapTask* mtask)
     QList<QGCTile*> tiles;
     QGCGetTileDownloadListTask* task = static_cast<QGCGetTileDownloadListTask*>(mtask);
     QSqlQuery query(*_db);
-    QString s = QString("SELECT hash, type, x, y, z FROM TilesDownload WHERE setID = %1 AND state = 0 LIMIT %2").arg(task->setID()).arg(task->count());
+    //-- Low zoom levels first, they cover the whole area with the fewest tiles
+    QString s = QString("SELECT hash, type, x, y, z FROM TilesDownload WHERE setID = %1 AND state = 0 ORDER BY z ASC LIMIT %2").arg(task->setID()).arg(task->count());
     if(query.exec(s)) {
         while(query.next()) {
             QGCTile* tile = new QGCTile;
@@ -575,12 +936,14 @@ QGCCacheWorker::_getTileDownloadList(QGCMapTask* mtask)
             tile->setZ(query.value("z").toInt());
             tiles.append(tile);
         }
+        _db->transaction();
         for(int i = 0; i < tiles.size(); i++) {
             s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 and hash = \"%3\"").arg(static_cast<int>(QGCTile::StateDownloading)).arg(task->setID()).arg(tiles[i]->hash());
             if(!query.exec(s)) {
                 qWarning() << "Map Cache SQL error (set TilesDownload state):" << query.lastError().text();
             }
         }
+        _db->commit();
     }
     task->setTileListFetched(tiles);
 }
@@ -595,18 +958,25 @@ QGCCacheWorker::_updateTileDownloadState(QGCMapTask* mtask)
     QGCUpdateTileDownloadStateTask* task = static_cast<QGCUpdateTileDownloadStateTask*>(mtask);
     QSqlQuery query(*_db);
     QString s;
-    if(task->state() == QGCTile::StateComplete) {
-        s = QString("DELETE FROM TilesDownload WHERE setID = %1 AND hash = \"%2\"").arg(task->setID()).arg(task->hash());
-    } else {
-        if(task->hash() == "*") {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2").arg(static_cast<int>(task->state())).arg(task->setID());
-        } else {
-            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 AND hash = \"%3\"").arg(static_cast<int>(task->state())).arg(task->setID()).arg(task->hash());
+    if(task->state() != QGCTile::StateComplete && task->hash() == "*") {
+        s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2").arg(static_cast<int>(task->state())).arg(task->setID());
+        if(!query.exec(s)) {
+            qWarning() << "QGCCacheWorker::_updateTileDownloadState() Error:" << query.lastError().text();
         }
+        return;
     }
-    if(!query.exec(s)) {
-        qWarning() << "QGCCacheWorker::_updateTileDownloadState() Error:" << query.lastError().text();
+    _db->transaction();
+    for(const QString& hash: task->hashes()) {
+        if(task->state() == QGCTile::StateComplete) {
+            s = QString("DELETE FROM TilesDownload WHERE setID = %1 AND hash = \"%2\"").arg(task->setID()).arg(hash);
+        } else {
+            s = QString("UPDATE TilesDownload SET state = %1 WHERE setID = %2 AND hash = \"%3\"").arg(static_cast<int>(task->state())).arg(task->setID()).arg(hash);
+        }
+        if(!query.exec(s)) {
+            qWarning() << "QGCCacheWorker::_updateTileDownloadState() Error:" << query.lastError().text();
+        }
     }
+    _db->commit();
 }
 
 //-----------------------------------------------------------------------------
@@ -619,22 +989,33 @@ QGCCacheWorker::_pruneCache(QGCMapTask* mtask)
     QGCPruneCacheTask* task = static_cast<QGCPruneCacheTask*>(mtask);
     QSqlQuery query(*_db);
     QString s;
-    //-- Select tiles in default set only, sorted by oldest.
-    s = QString("SELECT tileID, size, hash FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A join SetTiles B on A.tileID = B.tileID WHERE B.setID = %1 GROUP by A.tileID HAVING COUNT(A.tileID) = 1) ORDER BY DATE ASC LIMIT 128").arg(_getDefaultTileSet());
+    //-- Select tiles in default set only, sorted by oldest. Walks the date index from the oldest end so only the pruned
+    //   tiles and any older tiles held by other sets are visited.
+    s = QString("SELECT T.tileID, T.size, T.hash FROM Tiles T WHERE NOT EXISTS (SELECT 1 FROM SetTiles B WHERE B.tileID = T.tileID AND B.setID != %1) ORDER BY T.date ASC LIMIT 128").arg(_getDefaultTileSet());
     qint64 amount = (qint64)task->amount();
     QList<quint64> tlist;
+    QList<quint64> slist;
     if(query.exec(s)) {
         while(query.next() && amount >= 0) {
             tlist << query.value(0).toULongLong();
+            slist << query.value(1).toULongLong();
             amount -= query.value(1).toULongLong();
             qCDebug(QGCTileCacheLog) << "_pruneCache() HASH:" << query.value(2).toString();
         }
-        while(tlist.count()) {
-            s = QString("DELETE FROM Tiles WHERE tileID = %1").arg(tlist[0]);
-            tlist.removeFirst();
+        _db->transaction();
+        for(int i = 0; i < tlist.count(); i++) {
+            s = QString("DELETE FROM Tiles WHERE tileID = %1").arg(tlist[i]);
             if(!query.exec(s))
                 break;
+            s = QString("DELETE FROM SetTiles WHERE tileID = %1").arg(tlist[i]);
+            query.exec(s);
+            //-- These were only in the default set
+            _totalCount--;
+            _totalSize -= slist[i];
+            _defaultCount--;
+            _defaultSize -= slist[i];
         }
+        _db->commit();
         task->setPruned();
     }
 }
@@ -652,21 +1033,73 @@ QGCCacheWorker::_deleteTileSet(QGCMapTask* mtask)
 }
 
 //-----------------------------------------------------------------------------
+// The set itself goes away right away, its tiles are removed by _deleteTileSetChunk in the background
 void
 QGCCacheWorker::_deleteTileSet(qulonglong id)
 {
     QSqlQuery query(*_db);
     QString s;
-    //-- Only delete tiles unique to this set
-    s = QString("DELETE FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A JOIN SetTiles B ON A.tileID = B.tileID WHERE B.setID = %1 GROUP BY A.tileID HAVING COUNT(A.tileID) = 1)").arg(id);
-    query.exec(s);
+    _db->transaction();
     s = QString("DELETE FROM TilesDownload WHERE setID = %1").arg(id);
     query.exec(s);
     s = QString("DELETE FROM TileSets WHERE setID = %1").arg(id);
     query.exec(s);
-    s = QString("DELETE FROM SetTiles WHERE setID = %1").arg(id);
-    query.exec(s);
-    _updateTotals();
+    _db->commit();
+    if(!_deletedSets.contains(id)) {
+        _deletedSets.append(id);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Picks up deletions which were still running when we last shut down
+void
+QGCCacheWorker::_findDeletedTileSets()
+{
+    QSqlQuery query(*_db);
+    if(query.exec("SELECT DISTINCT setID FROM SetTiles WHERE setID NOT IN (SELECT setID FROM TileSets)")) {
+        while(query.next()) {
+            quint64 id = query.value(0).toULongLong();
+            if(!_deletedSets.contains(id)) {
+                _deletedSets.append(id);
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Removes one chunk of a deleted set's tiles, only deleting tiles no other set references
+void
+QGCCacheWorker::_deleteTileSetChunk()
+{
+    QGC_TRACE_SCOPE("TileCache", "deleteTileSetChunk");
+    quint64 id = _deletedSets.first();
+    QSqlQuery query(*_db);
+    QString s = QString("SELECT tileID FROM SetTiles WHERE setID = %1 LIMIT %2").arg(id).arg(kDeleteChunk);
+    QStringList tileIDs;
+    if(query.exec(s)) {
+        while(query.next()) {
+            tileIDs.append(query.value(0).toString());
+        }
+    }
+    if(tileIDs.isEmpty()) {
+        qCDebug(QGCTileCacheLog) << "_deleteTileSetChunk() done with set" << id;
+        _deletedSets.removeFirst();
+        _totalsDirty = true;
+        return;
+    }
+    QString list = tileIDs.join(",");
+    _db->transaction();
+    s = QString("DELETE FROM Tiles WHERE tileID IN (%1) AND NOT EXISTS (SELECT 1 FROM SetTiles B WHERE B.tileID = Tiles.tileID AND B.setID != %2)").arg(list).arg(id);
+    if(!query.exec(s)) {
+        qWarning() << "Map Cache SQL error (delete set tiles):" << query.lastError().text();
+    }
+    s = QString("DELETE FROM SetTiles WHERE setID = %1 AND tileID IN (%2)").arg(id).arg(list);
+    if(!query.exec(s)) {
+        qWarning() << "Map Cache SQL error (delete set tiles):" << query.lastError().text();
+        //-- Don't spin on a chunk we can't remove
+        _deletedSets.removeFirst();
+    }
+    _db->commit();
 }
 
 //-----------------------------------------------------------------------------
@@ -693,6 +1126,9 @@ QGCCacheWorker::_resetCacheDatabase(QGCMapTask* mtask)
         return;
     }
     QGCResetTask* task = static_cast<QGCResetTask*>(mtask);
+    if(_transferTask) {
+        _finishTransfer("Tile cache reset while importing or exporting tile sets");
+    }
     QSqlQuery query(*_db);
     QString s;
     s = QString("DROP TABLE Tiles");
@@ -703,303 +1139,470 @@ QGCCacheWorker::_resetCacheDatabase(QGCMapTask* mtask)
     query.exec(s);
     s = QString("DROP TABLE TilesDownload");
     query.exec(s);
+    s = QString("DROP TABLE EmptyTiles");
+    query.exec(s);
     _valid = _createDB(_db);
+    _defaultSet = UINT64_MAX;
+    _totalsDirty = true;
+    _deletedSets.clear();
     task->setResetCompleted();
 }
 
 //-----------------------------------------------------------------------------
-void
-QGCCacheWorker::_importSets(QGCMapTask* mtask)
+// Export and import only set things up here, the tiles are copied by _transferChunk between the other tasks
+// @return true: the transfer owns the task now
+bool
+QGCCacheWorker::_startTransfer(QGCMapTask* mtask)
 {
+    QGCTransferTileTask* task = static_cast<QGCTransferTileTask*>(mtask);
     if(!_testTask(mtask)) {
-        return;
+        task->setCompleted();
+        return false;
+    }
+    if(_transferTask) {
+        task->setError("Another tile set import or export is running");
+        task->setCompleted();
+        return false;
+    }
+    _transferTask       = task;
+    _transferSets.clear();
+    _transferLastTileID = 0;
+    _transferTotal      = 0;
+    _transferDone       = 0;
+    _transferSaved      = 0;
+    _transferPercent    = -1;
+    bool started;
+    if(mtask->type() == QGCMapTask::taskExport) {
+        started = _startExport(static_cast<QGCExportTileTask*>(mtask));
+    } else {
+        started = _startImport(static_cast<QGCImportTileTask*>(mtask));
+    }
+    if(!started) {
+        _transferTask = nullptr;
+        task->setCompleted();
     }
-    QGCImportTileTask* task = static_cast<QGCImportTileTask*>(mtask);
-    //-- If replacing, simply copy over it
+    return started;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_startExport(QGCExportTileTask* task)
+{
+    //-- Delete target if it exists
+    QFile::remove(task->path());
+    //-- Create the exported database on its own connection, the tiles are copied with it attached to ours
+    bool created = false;
+    {
+        QSqlDatabase dbExport = QSqlDatabase::addDatabase("QSQLITE", kExportSession);
+        dbExport.setDatabaseName(task->path());
+        if(dbExport.open()) {
+            created = _createDB(&dbExport, false);
+            dbExport.close();
+        } else {
+            qCritical() << "Map Cache SQL error (create export database):" << dbExport.lastError();
+        }
+    }
+    QSqlDatabase::removeDatabase(kExportSession);
+    if(!created) {
+        task->setError("Error creating export database");
+        return false;
+    }
+    QSqlQuery query(*_db);
+    query.prepare("ATTACH DATABASE ? AS transfer");
+    query.addBindValue(task->path());
+    if(!query.exec()) {
+        qWarning() << "Map Cache SQL error (attach export database):" << query.lastError().text();
+        task->setError("Error opening export database");
+        return false;
+    }
+    for(QGCCachedTileSet* set: task->sets()) {
+        //-- Default set has no unique tiles
+        _transferTotal += set->defaultSet() ? set->totalTileCount() : set->uniqueTileCount();
+        //-- Create Tile Exported Set
+        query.prepare("INSERT INTO transfer.TileSets("
+            "name, typeStr, topleftLat, topleftLon, bottomRightLat, bottomRightLon, minZoom, maxZoom, type, numTiles, defaultSet, date"
+            ") VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+        query.addBindValue(set->name());
+        query.addBindValue(set->mapTypeStr());
+        query.addBindValue(set->topleftLat());
+        query.addBindValue(set->topleftLon());
+        query.addBindValue(set->bottomRightLat());
+        query.addBindValue(set->bottomRightLon());
+        query.addBindValue(set->minZoom());
+        query.addBindValue(set->maxZoom());
+        query.addBindValue(getQGCMapEngine()->urlFactory()->getIdFromType(set->type()));
+        query.addBindValue(set->totalTileCount());
+        query.addBindValue(set->defaultSet());
+        query.addBindValue(QDateTime::currentDateTime().toTime_t());
+        if(!query.exec()) {
+            task->setError("Error adding tile set to exported database");
+            query.exec("DETACH DATABASE transfer");
+            return false;
+        }
+        //-- Get just created (auto-incremented) setID
+        TransferSet_t transferSet = { set->id(), query.lastInsertId().toULongLong(), set->defaultSet(), 0 };
+        _transferSets.append(transferSet);
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCCacheWorker::_startImport(QGCImportTileTask* task)
+{
+    //-- When replacing the file is copied next to the cache first, which stays in use until the copy is complete
     if(task->replace()) {
-        //-- Close and delete old database
-        if(_db) {
-            delete _db;
-            _db = nullptr;
-            QSqlDatabase::removeDatabase(kSession);
+        _transferSource.setFileName(task->path());
+        _transferTarget.setFileName(_databasePath + ".import");
+        if(!_transferSource.open(QIODevice::ReadOnly)) {
+            task->setError("Error opening import database");
+            return false;
         }
-        QFile file(_databasePath);
-        file.remove();
-        //-- Copy given database
-        QFile::copy(task->path(), _databasePath);
-        task->setProgress(25);
-        _init();
-        if(_valid) {
-            task->setProgress(50);
-            _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession));
-            _db->setDatabaseName(_databasePath);
-            _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-            _valid = _db->open();
+        if(!_transferTarget.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            _transferSource.close();
+            task->setError("Error copying import database");
+            return false;
         }
-        task->setProgress(100);
-    } else {
-        //-- Open imported set
-        QSqlDatabase* dbImport = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kExportSession));
-        dbImport->setDatabaseName(task->path());
-        dbImport->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-        if (dbImport->open()) {
-            QSqlQuery query(*dbImport);
-            //-- Prepare progress report
-            quint64 tileCount = 0;
-            quint64 currentCount = 0;
-            int lastProgress = -1;
-            QString s;
-            s = QString("SELECT COUNT(tileID) FROM Tiles");
-            if(query.exec(s)) {
-                if(query.next()) {
-                    //-- Total number of tiles in imported database
-                    tileCount  = query.value(0).toULongLong();
-                }
-            }
-            if(tileCount) {
-                //-- Iterate Tile Sets
-                s = QString("SELECT * FROM TileSets ORDER BY defaultSet DESC, name ASC");
-                if(query.exec(s)) {
-                    while(query.next()) {
-                        QString name            = query.value("name").toString();
-                        quint64 setID           = query.value("setID").toULongLong();
-                        QString mapType         = query.value("typeStr").toString();
-                        double  topleftLat      = query.value("topleftLat").toDouble();
-                        double  topleftLon      = query.value("topleftLon").toDouble();
-                        double  bottomRightLat  = query.value("bottomRightLat").toDouble();
-                        double  bottomRightLon  = query.value("bottomRightLon").toDouble();
-                        int     minZoom         = query.value("minZoom").toInt();
-                        int     maxZoom         = query.value("maxZoom").toInt();
-                        int     type            = query.value("type").toInt();
-                        quint32 numTiles        = query.value("numTiles").toUInt();
-                        int     defaultSet      = query.value("defaultSet").toInt();
-                        quint64 insertSetID     = _getDefaultTileSet();
-                        //-- If not default set, create new one
-                        if(!defaultSet) {
-                            //-- Check if we have this tile set already
-                            if(_findTileSetID(name, insertSetID)) {
-                                int testCount = 0;
-                                //-- Set with this name already exists. Make name unique.
-                                while (true) {
-                                    auto testName = QString::asprintf("%s %02d", name.toLatin1().data(), ++testCount);
-                                    if(!_findTileSetID(testName, insertSetID) || testCount > 99) {
-                                        name = testName;
-                                        break;
-                                    }
-                                }
-                            }
-                            //-- Create new set
-                            QSqlQuery cQuery(*_db);
-                            cQuery.prepare("INSERT INTO TileSets("
-                                "name, typeStr, topleftLat, topleftLon, bottomRightLat, bottomRightLon, minZoom, maxZoom, type, numTiles, defaultSet, date"
-                                ") VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
-                            cQuery.addBindValue(name);
-                            cQuery.addBindValue(mapType);
-                            cQuery.addBindValue(topleftLat);
-                            cQuery.addBindValue(topleftLon);
-                            cQuery.addBindValue(bottomRightLat);
-                            cQuery.addBindValue(bottomRightLon);
-                            cQuery.addBindValue(minZoom);
-                            cQuery.addBindValue(maxZoom);
-                            cQuery.addBindValue(type);
-                            cQuery.addBindValue(numTiles);
-                            cQuery.addBindValue(defaultSet);
-                            cQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
-                            if(!cQuery.exec()) {
-                                task->setError("Error adding imported tile set to database");
-                                break;
-                            } else {
-                                //-- Get just created (auto-incremented) setID
-                                insertSetID = cQuery.lastInsertId().toULongLong();
-                            }
-                        }
-                        //-- Find set tiles
-                        QSqlQuery cQuery(*_db);
-                        QSqlQuery subQuery(*dbImport);
-                        QString sb = QString("SELECT * FROM Tiles WHERE tileID IN (SELECT A.tileID FROM SetTiles A JOIN SetTiles B ON A.tileID = B.tileID WHERE B.setID = %1 GROUP BY A.tileID HAVING COUNT(A.tileID) = 1)").arg(setID);
-                        if(subQuery.exec(sb)) {
-                            quint64 tilesFound = 0;
-                            quint64 tilesSaved = 0;
-                            _db->transaction();
-                            while(subQuery.next()) {
-                                tilesFound++;
-                                QString hash    = subQuery.value("hash").toString();
-                                QString format  = subQuery.value("format").toString();
-                                QByteArray img  = subQuery.value("tile").toByteArray();
-                                int type        = subQuery.value("type").toInt();
-                                //-- Save tile
-                                cQuery.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-                                cQuery.addBindValue(hash);
-                                cQuery.addBindValue(format);
-                                cQuery.addBindValue(img);
-                                cQuery.addBindValue(img.size());
-                                cQuery.addBindValue(type);
-                                cQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
-                                if(cQuery.exec()) {
-                                    tilesSaved++;
-                                    quint64 importTileID = cQuery.lastInsertId().toULongLong();
-                                    QString s = QString("INSERT INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(importTileID).arg(insertSetID);
-                                    cQuery.prepare(s);
-                                    cQuery.exec();
-                                    currentCount++;
-                                    if(tileCount) {
-                                        int progress = (int)((double)currentCount / (double)tileCount * 100.0);
-                                        //-- Avoid calling this if (int) progress hasn't changed.
-                                        if(lastProgress != progress) {
-                                            lastProgress = progress;
-                                            task->setProgress(progress);
-                                        }
-                                    }
-                                }
-                            }
-                            _db->commit();
-                            if(tilesSaved) {
-                                //-- Update tile count (if any added)
-                                s = QString("SELECT COUNT(size) FROM Tiles A INNER JOIN SetTiles B on A.tileID = B.tileID WHERE B.setID = %1").arg(insertSetID);
-                                if(cQuery.exec(s)) {
-                                    if(cQuery.next()) {
-                                        quint64 count  = cQuery.value(0).toULongLong();
-                                        s = QString("UPDATE TileSets SET numTiles = %1 WHERE setID = %2").arg(count).arg(insertSetID);
-                                        cQuery.exec(s);
-                                    }
-                                }
-                            }
-                            qint64 uniqueTiles = tilesFound - tilesSaved;
-                            if((quint64)uniqueTiles < tileCount) {
-                                tileCount -= uniqueTiles;
-                            } else {
-                                tileCount = 0;
-                            }
-                            //-- If there was nothing new in this set, remove it.
-                            if(!tilesSaved && !defaultSet) {
-                                qCDebug(QGCTileCacheLog) << "No unique tiles in" << name << "Removing it.";
-                                _deleteTileSet(insertSetID);
-                            }
-                        }
+        _transferTotal = static_cast<quint64>(_transferSource.size());
+        return true;
+    }
+    QSqlQuery query(*_db);
+    query.prepare("ATTACH DATABASE ? AS transfer");
+    query.addBindValue(task->path());
+    if(!query.exec()) {
+        qWarning() << "Map Cache SQL error (attach import database):" << query.lastError().text();
+        task->setError("Error opening import database");
+        return false;
+    }
+    if(query.exec("SELECT COUNT(tileID) FROM transfer.SetTiles") && query.next()) {
+        _transferTotal = query.value(0).toULongLong();
+    }
+    if(!query.exec("SELECT * FROM transfer.TileSets ORDER BY defaultSet DESC, name ASC")) {
+        task->setError("No tile set in database");
+        query.exec("DETACH DATABASE transfer");
+        return false;
+    }
+    while(query.next()) {
+        QString name            = query.value("name").toString();
+        quint64 setID           = query.value("setID").toULongLong();
+        int     defaultSet      = query.value("defaultSet").toInt();
+        quint64 insertSetID     = _getDefaultTileSet();
+        //-- If not default set, create new one
+        if(!defaultSet) {
+            //-- Check if we have this tile set already
+            if(_findTileSetID(name, insertSetID)) {
+                int testCount = 0;
+                //-- Set with this name already exists. Make name unique.
+                while (true) {
+                    auto testName = QString::asprintf("%s %02d", name.toLatin1().data(), ++testCount);
+                    if(!_findTileSetID(testName, insertSetID) || testCount > 99) {
+                        name = testName;
+                        break;
                     }
-                } else {
-                    task->setError("No tile set in database");
                 }
             }
-            delete dbImport;
-            QSqlDatabase::removeDatabase(kExportSession);
-            if(!tileCount) {
-                task->setError("No unique tiles in imported database");
+            //-- Create new set
+            QSqlQuery cQuery(*_db);
+            cQuery.prepare("INSERT INTO TileSets("
+                "name, typeStr, topleftLat, topleftLon, bottomRightLat, bottomRightLon, minZoom, maxZoom, type, numTiles, defaultSet, date"
+                ") VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+            cQuery.addBindValue(name);
+            cQuery.addBindValue(query.value("typeStr").toString());
+            cQuery.addBindValue(query.value("topleftLat").toDouble());
+            cQuery.addBindValue(query.value("topleftLon").toDouble());
+            cQuery.addBindValue(query.value("bottomRightLat").toDouble());
+            cQuery.addBindValue(query.value("bottomRightLon").toDouble());
+            cQuery.addBindValue(query.value("minZoom").toInt());
+            cQuery.addBindValue(query.value("maxZoom").toInt());
+            cQuery.addBindValue(query.value("type").toInt());
+            cQuery.addBindValue(query.value("numTiles").toUInt());
+            cQuery.addBindValue(defaultSet);
+            cQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
+            if(!cQuery.exec()) {
+                task->setError("Error adding imported tile set to database");
+                break;
             }
-        } else {
-            task->setError("Error opening import database");
+            //-- Get just created (auto-incremented) setID
+            insertSetID = cQuery.lastInsertId().toULongLong();
         }
+        TransferSet_t transferSet = { setID, insertSetID, defaultSet != 0, 0 };
+        _transferSets.append(transferSet);
     }
-    task->setImportCompleted();
+    return true;
 }
 
 //-----------------------------------------------------------------------------
 void
-QGCCacheWorker::_exportSets(QGCMapTask* mtask)
+QGCCacheWorker::_transferChunk()
 {
-    if(!_testTask(mtask)) {
+    QGC_TRACE_SCOPE("TileCache", "transferChunk");
+    if(_transferTask->cancelled()) {
+        _finishTransfer(_transferTask->type() == QGCMapTask::taskExport ? "Tile set export cancelled" : "Tile set import cancelled");
         return;
     }
-    QGCExportTileTask* task = static_cast<QGCExportTileTask*>(mtask);
-    //-- Delete target if it exists
-    QFile file(task->path());
-    file.remove();
-    //-- Create exported database
-    QSqlDatabase *dbExport = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kExportSession));
-    dbExport->setDatabaseName(task->path());
-    dbExport->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-    if (dbExport->open()) {
-        if(_createDB(dbExport, false)) {
-            //-- Prepare progress report
-            quint64 tileCount = 0;
-            quint64 currentCount = 0;
-            for(int i = 0; i < task->sets().count(); i++) {
-                QGCCachedTileSet* set = task->sets()[i];
-                //-- Default set has no unique tiles
-                if(set->defaultSet()) {
-                    tileCount += set->totalTileCount();
-                } else {
-                    tileCount += set->uniqueTileCount();
-                }
-            }
-            if(!tileCount) {
-                tileCount = 1;
-            }
-            //-- Iterate sets to save
-            for(int i = 0; i < task->sets().count(); i++) {
-                QGCCachedTileSet* set = task->sets()[i];
-                //-- Create Tile Exported Set
-                QSqlQuery exportQuery(*dbExport);
-                exportQuery.prepare("INSERT INTO TileSets("
-                    "name, typeStr, topleftLat, topleftLon, bottomRightLat, bottomRightLon, minZoom, maxZoom, type, numTiles, defaultSet, date"
-                    ") VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
-                exportQuery.addBindValue(set->name());
-                exportQuery.addBindValue(set->mapTypeStr());
-                exportQuery.addBindValue(set->topleftLat());
-                exportQuery.addBindValue(set->topleftLon());
-                exportQuery.addBindValue(set->bottomRightLat());
-                exportQuery.addBindValue(set->bottomRightLon());
-                exportQuery.addBindValue(set->minZoom());
-                exportQuery.addBindValue(set->maxZoom());
-                exportQuery.addBindValue(getQGCMapEngine()->urlFactory()->getIdFromType(set->type()));
-                exportQuery.addBindValue(set->totalTileCount());
-                exportQuery.addBindValue(set->defaultSet());
-                exportQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
-                if(!exportQuery.exec()) {
-                    task->setError("Error adding tile set to exported database");
-                    break;
-                } else {
-                    //-- Get just created (auto-incremented) setID
-                    quint64 exportSetID = exportQuery.lastInsertId().toULongLong();
-                    //-- Find set tiles
-                    QString s = QString("SELECT * FROM SetTiles WHERE setID = %1").arg(set->id());
-                    QSqlQuery query(*_db);
-                    if(query.exec(s)) {
-                        dbExport->transaction();
-                        while(query.next()) {
-                            quint64 tileID = query.value("tileID").toULongLong();
-                            //-- Get tile
-                            QString s = QString("SELECT * FROM Tiles WHERE tileID = \"%1\"").arg(tileID);
-                            QSqlQuery subQuery(*_db);
-                            if(subQuery.exec(s)) {
-                                if(subQuery.next()) {
-                                    QString hash    = subQuery.value("hash").toString();
-                                    QString format  = subQuery.value("format").toString();
-                                    QByteArray img  = subQuery.value("tile").toByteArray();
-                                    int type        = subQuery.value("type").toInt();
-                                    //-- Save tile
-                                    exportQuery.prepare("INSERT INTO Tiles(hash, format, tile, size, type, date) VALUES(?, ?, ?, ?, ?, ?)");
-                                    exportQuery.addBindValue(hash);
-                                    exportQuery.addBindValue(format);
-                                    exportQuery.addBindValue(img);
-                                    exportQuery.addBindValue(img.size());
-                                    exportQuery.addBindValue(type);
-                                    exportQuery.addBindValue(QDateTime::currentDateTime().toTime_t());
-                                    if(exportQuery.exec()) {
-                                        quint64 exportTileID = exportQuery.lastInsertId().toULongLong();
-                                        QString s = QString("INSERT INTO SetTiles(tileID, setID) VALUES(%1, %2)").arg(exportTileID).arg(exportSetID);
-                                        exportQuery.prepare(s);
-                                        exportQuery.exec();
-                                        currentCount++;
-                                        task->setProgress((int)((double)currentCount / (double)tileCount * 100.0));
-                                    }
-                                }
-                            }
-                        }
-                    }
-                    dbExport->commit();
-                }
+    if(_transferTask->type() == QGCMapTask::taskExport) {
+        _exportChunk();
+    } else if(static_cast<QGCImportTileTask*>(_transferTask)->replace()) {
+        _copyChunk();
+    } else {
+        _importChunk();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Count and last tile of the next chunk of the first set, tiles are copied in tileID order so a chunk is a tileID range
+bool
+QGCCacheWorker::_nextTransferChunk(const QString& setTiles, quint64& lastTileID, quint64& count)
+{
+    QSqlQuery query(*_db);
+    QString s = QString("SELECT MAX(tileID), COUNT(tileID) FROM (SELECT tileID FROM %1 WHERE setID = %2 AND tileID > %3 ORDER BY tileID LIMIT %4)")
+        .arg(setTiles).arg(_transferSets.first().sourceSetID).arg(_transferLastTileID).arg(kTransferChunk);
+    if(!query.exec(s) || !query.next()) {
+        qWarning() << "Map Cache SQL error (transfer chunk):" << query.lastError().text();
+        return false;
+    }
+    lastTileID  = query.value(0).toULongLong();
+    count       = query.value(1).toULongLong();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_exportChunk()
+{
+    if(_transferSets.isEmpty()) {
+        _finishTransfer();
+        return;
+    }
+    const TransferSet_t& set = _transferSets.first();
+    quint64 lastTileID;
+    quint64 count;
+    if(!_nextTransferChunk("main.SetTiles", lastTileID, count)) {
+        _finishTransfer("Error exporting tile set");
+        return;
+    }
+    if(!count) {
+        _transferSets.removeFirst();
+        _transferLastTileID = 0;
+        return;
+    }
+    //-- Straight from table to table, tiles shared by several sets are stored once and linked to all of them
+    QString range = QString("S.setID = %1 AND S.tileID > %2 AND S.tileID <= %3").arg(set.sourceSetID).arg(_transferLastTileID).arg(lastTileID);
+    QSqlQuery query(*_db);
+    _db->transaction();
+    bool ok = query.exec(QString("INSERT OR IGNORE INTO transfer.Tiles(hash, format, tile, size, type, date) "
+            "SELECT T.hash, T.format, T.tile, T.size, T.type, %1 FROM main.Tiles T JOIN main.SetTiles S ON T.tileID = S.tileID WHERE %2")
+            .arg(QDateTime::currentDateTime().toTime_t()).arg(range)) &&
+        query.exec(QString("INSERT INTO transfer.SetTiles(tileID, setID) "
+            "SELECT E.tileID, %1 FROM main.SetTiles S JOIN main.Tiles T ON T.tileID = S.tileID JOIN transfer.Tiles E ON E.hash = T.hash WHERE %2")
+            .arg(set.targetSetID).arg(range));
+    if(!ok) {
+        qWarning() << "Map Cache SQL error (export tiles):" << query.lastError().text();
+        _db->rollback();
+        _finishTransfer("Error exporting tile set");
+        return;
+    }
+    _db->commit();
+    _transferLastTileID = lastTileID;
+    _transferProgress(count);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_importChunk()
+{
+    if(_transferSets.isEmpty()) {
+        _finishTransfer();
+        return;
+    }
+    TransferSet_t& set = _transferSets.first();
+    quint64 lastTileID;
+    quint64 count;
+    if(!_nextTransferChunk("transfer.SetTiles", lastTileID, count)) {
+        _finishTransfer("Error importing tile set");
+        return;
+    }
+    QSqlQuery query(*_db);
+    if(!count) {
+        if(set.linked) {
+            //-- Update tile count (if any added)
+            QString s = QString("SELECT COUNT(tileID) FROM SetTiles WHERE setID = %1").arg(set.targetSetID);
+            if(query.exec(s) && query.next()) {
+                s = QString("UPDATE TileSets SET numTiles = %1 WHERE setID = %2").arg(query.value(0).toULongLong()).arg(set.targetSetID);
+                query.exec(s);
             }
+        } else if(!set.defaultSet) {
+            //-- If there was nothing in this set, remove it.
+            qCDebug(QGCTileCacheLog) << "No tiles in imported set" << set.sourceSetID << "Removing it.";
+            _deleteTileSet(set.targetSetID);
+        }
+        _transferSets.removeFirst();
+        _transferLastTileID = 0;
+        return;
+    }
+    //-- Tiles already in the cache are not copied again, they are only added to the set
+    QString range = QString("S.setID = %1 AND S.tileID > %2 AND S.tileID <= %3").arg(set.sourceSetID).arg(_transferLastTileID).arg(lastTileID);
+    _db->transaction();
+    bool ok = query.exec(QString("INSERT OR IGNORE INTO main.Tiles(hash, format, tile, size, type, date) "
+            "SELECT I.hash, I.format, I.tile, length(I.tile), I.type, %1 FROM transfer.Tiles I JOIN transfer.SetTiles S ON I.tileID = S.tileID WHERE %2")
+            .arg(QDateTime::currentDateTime().toTime_t()).arg(range));
+    if(ok) {
+        _transferSaved += static_cast<quint64>(qMax(0, query.numRowsAffected()));
+        ok = query.exec(QString("INSERT INTO main.SetTiles(tileID, setID) "
+            "SELECT T.tileID, %1 FROM transfer.SetTiles S JOIN transfer.Tiles I ON I.tileID = S.tileID JOIN main.Tiles T ON T.hash = I.hash "
+            "WHERE %2 AND NOT EXISTS (SELECT 1 FROM main.SetTiles X WHERE X.tileID = T.tileID AND X.setID = %1)")
+            .arg(set.targetSetID).arg(range));
+        set.linked += static_cast<quint64>(qMax(0, query.numRowsAffected()));
+    }
+    if(!ok) {
+        qWarning() << "Map Cache SQL error (import tiles):" << query.lastError().text();
+        _db->rollback();
+        _finishTransfer("Error importing tile set");
+        return;
+    }
+    _db->commit();
+    _totalsDirty = true;
+    _transferLastTileID = lastTileID;
+    _transferProgress(count);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_copyChunk()
+{
+    QByteArray data = _transferSource.read(kCopyChunk);
+    if(data.isEmpty()) {
+        if(!_transferSource.atEnd()) {
+            _finishTransfer("Error reading import database");
         } else {
-            task->setError("Error creating export database");
+            _replaceDatabase();
         }
+        return;
+    }
+    if(_transferTarget.write(data) != data.size()) {
+        _finishTransfer("Error copying import database");
+        return;
+    }
+    _transferProgress(static_cast<quint64>(data.size()));
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_replaceDatabase()
+{
+    _transferSource.close();
+    _transferTarget.close();
+    //-- Close the old database, readers included, so nothing has it open while the files move
+    if(_db) {
+        delete _db;
+        _db = nullptr;
+        QSqlDatabase::removeDatabase(_session);
+    }
+    _stopReaders();
+    QString errorString = _swapDatabaseFile(_transferTarget.fileName());
+    if(!errorString.isEmpty()) {
+        _transferTarget.remove();
+    }
+    //-- Whichever file ended up in place, old or imported, is opened again
+    _valid = false;
+    _init();
+    _defaultSet = UINT64_MAX;
+    _deletedSets.clear();
+    if(_valid) {
+        _valid = _openDB();
+    }
+    if(errorString.isEmpty() && !_valid) {
+        errorString = "Error opening imported database";
+    }
+    _startReaders();
+    _finishTransfer(errorString);
+}
+
+//-----------------------------------------------------------------------------
+// The old files are moved aside rather than removed so they can be put back if the new one can't take their place
+QString
+QGCCacheWorker::_swapDatabaseFile(const QString& newPath)
+{
+    static const char* kSuffixes[] = { "", "-wal", "-shm" };
+    const QString backupPath = _databasePath + "-replaced";
+    QStringList moved;
+    bool ok = true;
+    for(const char* suffix: kSuffixes) {
+        QString path = _databasePath + suffix;
+        if(!QFile::exists(path)) {
+            continue;
+        }
+        QFile::remove(backupPath + suffix);
+        if(!QFile::rename(path, backupPath + suffix)) {
+            qCWarning(QGCTileCacheLog) << "Unable to move aside" << path;
+            ok = false;
+            break;
+        }
+        moved.append(suffix);
+    }
+    if(ok && !QFile::rename(newPath, _databasePath)) {
+        qCWarning(QGCTileCacheLog) << "Unable to move" << newPath << "to" << _databasePath;
+        ok = false;
+    }
+    if(!ok) {
+        for(const QString& suffix: moved) {
+            if(!QFile::rename(backupPath + suffix, _databasePath + suffix)) {
+                qCWarning(QGCTileCacheLog) << "Unable to restore" << _databasePath + suffix << "from" << backupPath + suffix;
+            }
+        }
+        return "Unable to replace tile cache database";
+    }
+    for(const QString& suffix: moved) {
+        if(!QFile::remove(backupPath + suffix)) {
+            qCWarning(QGCTileCacheLog) << "Unable to remove replaced database" << backupPath + suffix;
+        }
+    }
+    return QString();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_transferProgress(quint64 count)
+{
+    _transferDone += count;
+    int percent = _transferTotal ? static_cast<int>(qMin(_transferDone, _transferTotal) * 100 / _transferTotal) : 0;
+    //-- Avoid calling this if (int) progress hasn't changed.
+    if(percent != _transferPercent) {
+        _transferPercent = percent;
+        _transferTask->setProgress(percent);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCCacheWorker::_finishTransfer(const QString& errorString)
+{
+    QGCTransferTileTask* task = _transferTask;
+    _transferTask = nullptr;
+    _transferSets.clear();
+    if(task->type() == QGCMapTask::taskImport && static_cast<QGCImportTileTask*>(task)->replace()) {
+        if(_transferSource.isOpen()) {
+            _transferSource.close();
+            _transferTarget.close();
+            _transferTarget.remove();
+        }
+    } else if(_db) {
+        QSqlQuery query(*_db);
+        query.exec("DETACH DATABASE transfer");
+        if(task->type() == QGCMapTask::taskExport && !errorString.isEmpty()) {
+            QFile::remove(task->path());
+        }
+    }
+    if(!errorString.isEmpty()) {
+        task->setError(errorString);
+    } else if(task->type() == QGCMapTask::taskImport && !static_cast<QGCImportTileTask*>(task)->replace() && !_transferSaved) {
+        task->setError("No unique tiles in imported database");
     } else {
-        qCritical() << "Map Cache SQL error (create export database):" << dbExport->lastError();
-        task->setError("Error opening export database");
+        task->setProgress(100);
     }
-    delete dbExport;
-    QSqlDatabase::removeDatabase(kExportSession);
-    task->setExportCompleted();
+    _totalsDirty = true;
+    task->setCompleted();
+    task->deleteLater();
 }
 
 //-----------------------------------------------------------------------------
@@ -1020,7 +1623,7 @@ QGCCacheWorker::_init()
     if(!_databasePath.isEmpty()) {
         qCDebug(QGCTileCacheLog) << "Mapping cache directory:" << _databasePath;
         //-- Initialize Database
-        _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", kSession));
+        _db = new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", _session));
         _db->setDatabaseName(_databasePath);
         _db->setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
         if (_db->open()) {
@@ -1034,12 +1637,11 @@ QGCCacheWorker::_init()
         }
         delete _db;
         _db = nullptr;
-        QSqlDatabase::removeDatabase(kSession);
+        QSqlDatabase::removeDatabase(_session);
     } else {
         qCritical() << "Could not find suitable cache directory.";
         _failed = true;
     }
-    _testInternet();
     return _failed;
 }
 
@@ -1062,6 +1664,8 @@ QGCCacheWorker::_createDB(QSqlDatabase* db, bool createDefault)
         qWarning() << "Map Cache SQL error (create Tiles db):" << query.lastError().text();
     } else {
         query.exec("CREATE INDEX IF NOT EXISTS hash ON Tiles ( hash, size, type ) ");
+        //-- Least recently used order for pruning
+        query.exec("CREATE INDEX IF NOT EXISTS TilesDate ON Tiles ( date ) ");
              
         if(!query.exec(
             "CREATE TABLE IF NOT EXISTS TileSets ("
@@ -1088,6 +1692,9 @@ QGCCacheWorker::_createDB(QSqlDatabase* db, bool createDefault)
             {
                 qWarning() << "Map Cache SQL error (create SetTiles db):" << query.lastError().text();
             } else {
+                //-- Set membership is looked up both ways: the tiles of a set, and the sets of a tile
+                query.exec("CREATE INDEX IF NOT EXISTS SetTilesSet ON SetTiles ( setID, tileID ) ");
+                query.exec("CREATE INDEX IF NOT EXISTS SetTilesTile ON SetTiles ( tileID, setID ) ");
                 if(!query.exec(
                     "CREATE TABLE IF NOT EXISTS TilesDownload ("
                     "setID INTEGER, "
@@ -1100,8 +1707,23 @@ QGCCacheWorker::_createDB(QSqlDatabase* db, bool createDefault)
                 {
                     qWarning() << "Map Cache SQL error (create TilesDownload db):" << query.lastError().text();
                 } else {
-                    //-- Database it ready for use
-                    res = true;
+                    //-- Download lists are pulled by set and state in zoom order
+                    query.exec("CREATE INDEX IF NOT EXISTS TilesDownloadState ON TilesDownload ( setID, state, z ) ");
+                    bool hadEmptyTiles = query.exec("SELECT name FROM sqlite_master WHERE type = 'table' AND name = 'EmptyTiles'") && query.next();
+                    if(!query.exec(
+                        "CREATE TABLE IF NOT EXISTS EmptyTiles ("
+                        "hash TEXT PRIMARY KEY NOT NULL, "
+                        "date INTEGER DEFAULT 0)"))
+                    {
+                        qWarning() << "Map Cache SQL error (create EmptyTiles db):" << query.lastError().text();
+                    } else {
+                        query.exec("CREATE INDEX IF NOT EXISTS EmptyTilesDate ON EmptyTiles ( date ) ");
+                        if(!hadEmptyTiles) {
+                            _deleteBingNoTileTiles(db);
+                        }
+                        //-- Database it ready for use
+                        res = true;
+                    }
                 }
             }
         }
@@ -1130,59 +1752,3 @@ QGCCacheWorker::_createDB(QSqlDatabase* db, bool createDefault)
     }
     return res;
 }
-
-//-----------------------------------------------------------------------------
-void
-QGCCacheWorker::_testInternet()
-{
-    /*
-        To test if you have Internet connection, the code tests a connection to
-        8.8.8.8:53 (google DNS). It appears that some routers are now blocking TCP
-        connections to port 53. So instead, we use a TCP connection to "github.com"
-        (80). On exit, if the look up for "github.com" is under way, a call to abort
-        the lookup is made. This abort call on Android has no effect, and the code
-        blocks for a full minute. So to work around the issue, we continue a direct
-        TCP connection to 8.8.8.8:53 on Android and do the lookup/connect on the
-        other platforms.
-    */
-#if defined(__android__)
-    QTcpSocket socket;
-    socket.connectToHost("8.8.8.8", 53);
-    if (socket.waitForConnected(2000)) {
-        qCDebug(QGCTileCacheLog) << "Yes Internet Access";
-        emit internetStatus(true);
-        return;
-    }
-    qWarning() << "No Internet Access";
-    emit internetStatus(false);
-#else
-    if(!_hostLookupID) {
-        _hostLookupID = QHostInfo::lookupHost("www.github.com", this, SLOT(_lookupReady(QHostInfo)));
-    }
-#endif
-}
-
-//-----------------------------------------------------------------------------
-void
-QGCCacheWorker::_lookupReady(QHostInfo info)
-{
-#if defined(__android__)
-    Q_UNUSED(info);
-#else
-    _hostLookupID = 0;
-    if(info.error() == QHostInfo::NoError && info.addresses().size()) {
-        QTcpSocket socket;
-        QNetworkProxy tempProxy;
-        tempProxy.setType(QNetworkProxy::DefaultProxy);
-        socket.setProxy(tempProxy);
-        socket.connectToHost(info.addresses().first(), 80);
-        if (socket.waitForConnected(2000)) {
-            qCDebug(QGCTileCacheLog) << "Yes Internet Access";
-            emit internetStatus(true);
-            return;
-        }
-    }
-    qDebug() << "No Internet Access";
-    emit internetStatus(false);
-#endif
-}
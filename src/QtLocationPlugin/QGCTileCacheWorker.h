@@ -26,13 +26,19 @@
 #include <QWaitCondition>
 #include <QMutexLocker>
 #include <QtSql/QSqlDatabase>
-#include <QHostInfo>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QSet>
+#include <QFile>
 
 #include "QGCLoggingCategory.h"
 
 Q_DECLARE_LOGGING_CATEGORY(QGCTileCacheLog)
 
 class QGCMapTask;
+class QGCTransferTileTask;
+class QGCExportTileTask;
+class QGCImportTileTask;
 class QGCCachedTileSet;
 
 //-----------------------------------------------------------------------------
@@ -50,12 +56,14 @@ public:
 protected:
     void    run             ();
 
-private slots:
-    void        _lookupReady            (QHostInfo info);
-
 private:
     void        _saveTile               (QGCMapTask* mtask);
-    void        _getTile                (QGCMapTask* mtask);
+    void        _saveTiles              (QGCMapTask* mtask);
+    void        _getTiles               (const QList<QGCMapTask*>& mtasks, QSqlDatabase* db);
+    QList<QGCMapTask*> _takeFetchBatch  ();
+    void        _fetchRunnableCancelled ();
+    void        _stopReaders            ();
+    void        _startReaders           ();
     void        _getTileSets            (QGCMapTask* mtask);
     void        _createTileSet          (QGCMapTask* mtask);
     void        _getTileDownloadList    (QGCMapTask* mtask);
@@ -64,13 +72,27 @@ private:
     void        _renameTileSet          (QGCMapTask* mtask);
     void        _resetCacheDatabase     (QGCMapTask* mtask);
     void        _pruneCache             (QGCMapTask* mtask);
-    void        _exportSets             (QGCMapTask* mtask);
-    void        _importSets             (QGCMapTask* mtask);
+    bool        _startTransfer          (QGCMapTask* mtask);
+    bool        _startExport            (QGCExportTileTask* task);
+    bool        _startImport            (QGCImportTileTask* task);
+    void        _transferChunk          ();
+    bool        _nextTransferChunk      (const QString& setTiles, quint64& lastTileID, quint64& count);
+    void        _exportChunk            ();
+    void        _importChunk            ();
+    void        _copyChunk              ();
+    void        _replaceDatabase        ();
+    QString     _swapDatabaseFile       (const QString& newPath);
+    void        _transferProgress       (quint64 count);
+    void        _finishTransfer         (const QString& errorString = QString());
     bool        _testTask               (QGCMapTask* mtask);
-    void        _testInternet           ();
-    void        _deleteBingNoTileTiles  ();
+    void        _pruneEmptyTiles        ();
+    void        _deleteBingNoTileTiles  (QSqlDatabase* db);
 
     quint64     _findTile               (const QString hash);
+    void        _touchTile              (quint64 tileID, uint date);
+    void        _flushTouchedTiles      ();
+    bool        _openDB                 ();
+    void        _emitTotals             ();
     bool        _findTileSetID          (const QString name, quint64& setID);
     void        _updateSetTotals        (QGCCachedTileSet* set);
     bool        _init                   ();
@@ -78,12 +100,22 @@ private:
     quint64     _getDefaultTileSet      ();
     void        _updateTotals           ();
     void        _deleteTileSet          (qulonglong id);
+    void        _deleteTileSetChunk     ();
+    void        _findDeletedTileSets    ();
 
 signals:
     void        updateTotals            (quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize);
-    void        internetStatus          (bool active);
 
 private:
+    friend class QGCFetchTileRunnable;
+
+    typedef struct {
+        quint64     sourceSetID;
+        quint64     targetSetID;
+        bool        defaultSet;
+        quint64     linked;             ///< Tiles added to the target set
+    } TransferSet_t;
+
     QQueue<QGCMapTask*>     _taskQueue;
     QMutex                  _mutex;
     QMutex                  _waitmutex;
@@ -99,7 +131,27 @@ private:
     quint32                 _defaultCount;
     time_t                  _lastUpdate;
     int                     _updateTimeout;
-    int                     _hostLookupID;
+    bool                    _totalsDirty;           ///< Totals need the full aggregate queries, otherwise they are kept up to date as tiles are saved and pruned
+    QThreadPool             _readerPool;            ///< Tile fetches run here on their own read only connections so they never wait behind writes
+    QAtomicInt              _readerGeneration;      ///< Bumped when the database file is replaced so readers reopen it
+    QMutex                  _touchMutex;
+    QSet<quint64>           _touchedTiles;          ///< Tiles read by the reader pool whose date needs moving forward, written by the worker thread
+    QList<quint64>          _deletedSets;           ///< Deleted sets whose tiles are still being removed
+    bool                    _deletedSetsChecked;
+    QMutex                  _fetchMutex;
+    QList<QGCMapTask*>      _pendingFetches;        ///< Fetches waiting for a reader, looked up in batches
+    int                     _fetchRunnables;        ///< Readers started on the pool which have not run out of fetches yet
+    bool                    _readersPaused;         ///< Set while the database file is swapped, fetches wait in _pendingFetches
+    QGCTransferTileTask*    _transferTask;          ///< Export or import copied in chunks between the other tasks
+    QList<TransferSet_t>    _transferSets;          ///< Sets left to copy, the first one is in progress
+    quint64                 _transferLastTileID;    ///< Last source tile copied of the current set
+    quint64                 _transferTotal;         ///< Tiles, or bytes when an import replaces the cache
+    quint64                 _transferDone;
+    quint64                 _transferSaved;         ///< Tiles an import added to the cache
+    int                     _transferPercent;
+    QFile                   _transferSource;        ///< Import replacing the cache, copied next to it before it takes its place
+    QFile                   _transferTarget;
+    QString                 _session;               ///< Name of the writable connection, one per worker so a test can run its own next to the map engine's
 };
 
 #endif // QGC_TILE_CACHE_WORKER_H
@@ -0,0 +1,151 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileFetchQueue.h"
+#include "QGCMapEngine.h"
+#include "QGeoMapReplyQGC.h"
+
+#include <limits.h>
+#include <math.h>
+
+//-----------------------------------------------------------------------------
+QGCTileFetchQueue::QGCTileFetchQueue(void)
+{
+    _dispatchTimer.setSingleShot(true);
+    _dispatchTimer.setInterval(0);
+    QObject::connect(&_dispatchTimer, &QTimer::timeout, &_dispatchTimer, [this]() { _dispatch(); });
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileFetchQueue::setViewport(const void* map, const QSet<QGeoTileSpec>& visibleTiles)
+{
+    if(visibleTiles.isEmpty()) {
+        removeViewport(map);
+        return;
+    }
+    //-- Visible tiles are all at the zoom the map is drawn at, but don't count on it
+    Viewport_t viewport;
+    viewport.mapId  = visibleTiles.begin()->mapId();
+    viewport.zoom   = 0;
+    for(const QGeoTileSpec& spec: visibleTiles) {
+        viewport.zoom = qMax(viewport.zoom, spec.zoom());
+    }
+    double  x     = 0;
+    double  y     = 0;
+    int     count = 0;
+    for(const QGeoTileSpec& spec: visibleTiles) {
+        if(spec.zoom() == viewport.zoom) {
+            x += spec.x() + 0.5;
+            y += spec.y() + 0.5;
+            count++;
+        }
+    }
+    viewport.center = QPointF(x / count, y / count);
+    _viewports[map] = viewport;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileFetchQueue::removeViewport(const void* map)
+{
+    _viewports.remove(map);
+}
+
+//-----------------------------------------------------------------------------
+QPair<int, double>
+QGCTileFetchQueue::priority(const QGeoTileSpec& spec) const
+{
+    //-- Tiles no map shows, like those of the terrain queries, go in the order they came in
+    QPair<int, double> best(INT_MAX, 0);
+    for(const Viewport_t& viewport: _viewports) {
+        if(viewport.mapId != spec.mapId()) {
+            continue;
+        }
+        double scale = pow(2.0, viewport.zoom - spec.zoom());
+        double dx    = (spec.x() + 0.5) * scale - viewport.center.x();
+        double dy    = (spec.y() + 0.5) * scale - viewport.center.y();
+        QPair<int, double> current(qAbs(spec.zoom() - viewport.zoom), dx * dx + dy * dy);
+        if(current < best) {
+            best = current;
+        }
+    }
+    return best;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileFetchQueue::enqueue(QGeoTiledMapReplyQGC* reply)
+{
+    if(_queued.contains(reply) || _active.contains(reply)) {
+        return;
+    }
+    _queued.append(reply);
+    _dispatchTimer.start();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileFetchQueue::remove(QGeoTiledMapReplyQGC* reply)
+{
+    if(_active.remove(reply)) {
+        int mapId = reply->tileSpec().mapId();
+        if(--_activeByProvider[mapId] <= 0) {
+            _activeByProvider.remove(mapId);
+        }
+        _dispatchTimer.start();
+    } else {
+        _queued.removeOne(reply);
+    }
+}
+
+//-----------------------------------------------------------------------------
+int
+QGCTileFetchQueue::_connectionLimit(int mapId)
+{
+    MapProvider* provider = getQGCMapEngine()->urlFactory()->getMapProviderFromId(mapId);
+    int limit = maxConnectionsPerProvider;
+    if(provider) {
+        limit = qMin(provider->concurrentDownloads(), limit);
+    }
+    return qMax(1, limit);
+}
+
+//-----------------------------------------------------------------------------
+// Priorities are worked out when a connection frees up, the viewports have usually moved since the requests were queued
+void
+QGCTileFetchQueue::_dispatch(void)
+{
+    QHash<int, int> limits;
+    while(!_queued.isEmpty()) {
+        int                 next = -1;
+        QPair<int, double>  nextPriority;
+        for(int i = 0; i < _queued.count(); i++) {
+            int mapId = _queued[i]->tileSpec().mapId();
+            if(!limits.contains(mapId)) {
+                limits[mapId] = _connectionLimit(mapId);
+            }
+            if(_activeByProvider.value(mapId) >= limits[mapId]) {
+                continue;
+            }
+            QPair<int, double> current = priority(_queued[i]->tileSpec());
+            if(next == -1 || current < nextPriority) {
+                next            = i;
+                nextPriority    = current;
+            }
+        }
+        if(next == -1) {
+            break;
+        }
+        QGeoTiledMapReplyQGC* reply = _queued.takeAt(next);
+        _active.insert(reply);
+        _activeByProvider[reply->tileSpec().mapId()]++;
+        reply->_startNetworkRequest();
+    }
+}
@@ -0,0 +1,71 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QPointF>
+#include <QSet>
+#include <QTimer>
+#include <QtLocation/private/qgeotilespec_p.h>
+
+class QGeoTiledMapReplyQGC;
+
+/// Network requests of the tiles which were not in the cache.
+///
+/// QNetworkAccessManager only opens a few connections to each host and serves the rest of its requests in the order
+/// they came in. After a quick pan or zoom that order is mostly offscreen tiles. Requests are held here instead and
+/// started once a connection to their provider is free, the tiles at the zoom of a map and closest to its center
+/// first. Requests of tiles which went out of view are aborted by QtLocation and simply leave the queue.
+///
+/// Requests are started from the event loop, so the cache misses of a batched lookup and the aborts of a pan are all
+/// in before the next ones are picked.
+class QGCTileFetchQueue
+{
+public:
+    QGCTileFetchQueue(void);
+
+    /// Tiles a map currently shows, their center and zoom order the requests of that map type
+    /// @param map Only used to tell the maps apart
+    void    setViewport         (const void* map, const QSet<QGeoTileSpec>& visibleTiles);
+    void    removeViewport      (const void* map);
+
+    /// The reply is started through QGeoTiledMapReplyQGC::_startNetworkRequest when its turn comes
+    void    enqueue             (QGeoTiledMapReplyQGC* reply);
+    /// Call when the request of the reply is done or the reply goes away, queued or not
+    void    remove              (QGeoTiledMapReplyQGC* reply);
+
+    int     queuedCount         (void) const { return _queued.count(); }
+    int     activeCount         (void) const { return _active.count(); }
+
+    /// @return Order of the request of a tile, lowest first: distance in zoom levels from the closest viewport
+    ///         of the map type, then squared distance in tiles from its center
+    QPair<int, double> priority (const QGeoTileSpec& spec) const;
+
+    /// QNetworkAccessManager's own limit of connections to a host
+    static const int maxConnectionsPerProvider = 6;
+
+private:
+    typedef struct {
+        int     mapId;
+        int     zoom;
+        QPointF center;             ///< In tiles at zoom
+    } Viewport_t;
+
+    void    _dispatch           (void);
+    int     _connectionLimit    (int mapId);
+
+    QHash<const void*, Viewport_t>  _viewports;
+    QList<QGeoTiledMapReplyQGC*>    _queued;
+    QSet<QGeoTiledMapReplyQGC*>     _active;
+    QHash<int, int>                 _activeByProvider;  ///< Requests started for each map id
+    QTimer                          _dispatchTimer;
+};
@@ -0,0 +1,93 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTileMemoryCache.h"
+
+#include <QMutexLocker>
+
+#include <climits>
+
+//-----------------------------------------------------------------------------
+QGCTileMemoryCache::QGCTileMemoryCache(void)
+    : _hits(0)
+    , _misses(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+QGCTileMemoryCache::Shard_t&
+QGCTileMemoryCache::_shard(const QGCTileKey& key)
+{
+    // Neighbouring tiles differ in the low bits of x and y, spread them across shards
+    return _shards[(key.x() ^ (key.y() * 3)) & (_shardCount - 1)];
+}
+
+//-----------------------------------------------------------------------------
+bool
+QGCTileMemoryCache::find(const QGCTileKey& key, QByteArray& image, QString& format)
+{
+    Shard_t& shard = _shard(key);
+    QMutexLocker lock(&shard.mutex);
+    const CachedTile_t* tile = shard.tiles.object(key);
+    if (!tile) {
+        _misses.fetchAndAddRelaxed(1);
+        return false;
+    }
+    image   = tile->image;
+    format  = tile->format;
+    _hits.fetchAndAddRelaxed(1);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::insert(const QGCTileKey& key, const QByteArray& image, const QString& format)
+{
+    if (image.isEmpty()) {
+        return;
+    }
+    Shard_t& shard = _shard(key);
+    QMutexLocker lock(&shard.mutex);
+    // Tiles larger than a whole shard are simply not cached, QCache deletes them right away
+    shard.tiles.insert(key, new CachedTile_t{ image, format }, image.size());
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::clear(void)
+{
+    for (Shard_t& shard: _shards) {
+        QMutexLocker lock(&shard.mutex);
+        shard.tiles.clear();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::setMaxBytes(quint64 maxBytes)
+{
+    int shardBytes = static_cast<int>(qMin(maxBytes / _shardCount, static_cast<quint64>(INT_MAX)));
+    for (Shard_t& shard: _shards) {
+        QMutexLocker lock(&shard.mutex);
+        shard.tiles.setMaxCost(shardBytes);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGCTileMemoryCache::usage(int& count, quint64& bytes)
+{
+    count = 0;
+    bytes = 0;
+    for (Shard_t& shard: _shards) {
+        QMutexLocker lock(&shard.mutex);
+        count += shard.tiles.count();
+        bytes += static_cast<quint64>(shard.tiles.totalCost());
+    }
+}
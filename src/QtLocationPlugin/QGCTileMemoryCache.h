@@ -0,0 +1,61 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCMapEngineData.h"
+
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+#include <QAtomicInteger>
+
+/// Least recently used cache of the encoded tile images most recently served to QtLocation.
+///
+/// Sits in front of QGCCacheWorker so panning back and forth over the same area does not go back to the
+/// database for every tile. The budget is in bytes of image data and is split across independently locked
+/// shards so concurrent lookups do not contend on a single mutex.
+class QGCTileMemoryCache
+{
+public:
+    QGCTileMemoryCache(void);
+
+    /// @return true if the tile was in the cache, image and format are only set in that case
+    bool    find        (const QGCTileKey& key, QByteArray& image, QString& format);
+    void    insert      (const QGCTileKey& key, const QByteArray& image, const QString& format);
+    void    clear       (void);
+
+    /// Total budget for image data across all shards
+    void    setMaxBytes (quint64 maxBytes);
+
+    /// Tiles currently held and the bytes of their image data
+    void    usage       (int& count, quint64& bytes);
+
+    quint64 hits        (void) const { return _hits.loadAcquire(); }
+    quint64 misses      (void) const { return _misses.loadAcquire(); }
+
+private:
+    typedef struct {
+        QByteArray  image;
+        QString     format;
+    } CachedTile_t;
+
+    typedef struct {
+        QMutex                              mutex;
+        QCache<QGCTileKey, CachedTile_t>    tiles;      ///< Cost is the image size in bytes
+    } Shard_t;
+
+    Shard_t& _shard(const QGCTileKey& key);
+
+    static const int _shardCount = 8;
+
+    Shard_t                 _shards[_shardCount];
+    QAtomicInteger<quint64> _hits;
+    QAtomicInteger<quint64> _misses;
+};
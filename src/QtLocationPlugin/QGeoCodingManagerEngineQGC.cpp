@@ -46,6 +46,8 @@
 
 #include "QGeoCodingManagerEngineQGC.h"
 #include "QGeoCodeReplyQGC.h"
+#include "QGCApplication.h"
+#include "QGCNetworkService.h"
 
 #include <QtCore/QVariantMap>
 #include <QtCore/QUrl>
@@ -80,7 +82,7 @@ QGeoCodingManagerEngineQGC::QGeoCodingManagerEngineQGC(
     const QVariantMap &parameters,
     QGeoServiceProvider::Error *error,
     QString *errorString)
-    : QGeoCodingManagerEngine(parameters), m_networkManager(new QNetworkAccessManager(this))
+    : QGeoCodingManagerEngine(parameters), m_networkManager(qgcApp()->toolbox()->networkService()->networkAccessManager())
 {
     if (parameters.contains(QStringLiteral("useragent")))
         m_userAgent = parameters.value(QStringLiteral("useragent")).toString().toLatin1();
@@ -106,6 +108,7 @@ QGeoCodeReply *QGeoCodingManagerEngineQGC::geocode(const QString &address, int l
 
     QNetworkRequest request;
     request.setRawHeader("User-Agent", m_userAgent);
+    QGCNetworkService::setConsumer(request, QGCNetworkService::consumerGeocoding);
 
     QUrl url(QStringLiteral("http://maps.googleapis.com/maps/api/geocode/json"));
     QUrlQuery query;
@@ -138,6 +141,7 @@ QGeoCodeReply *QGeoCodingManagerEngineQGC::reverseGeocode(const QGeoCoordinate &
 
     QNetworkRequest request;
     request.setRawHeader("User-Agent", m_userAgent);
+    QGCNetworkService::setConsumer(request, QGCNetworkService::consumerGeocoding);
 
     QUrl url(QStringLiteral("http://maps.googleapis.com/maps/api/geocode/json"));
     QUrlQuery query;
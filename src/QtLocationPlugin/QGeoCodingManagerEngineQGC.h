@@ -72,7 +72,7 @@ private Q_SLOTS:
     void replyError     (QGeoCodeReply::Error errorCode, const QString &errorString);
 
 private:
-    QNetworkAccessManager *m_networkManager;
+    QNetworkAccessManager *m_networkManager;   ///< Owned by the network service
     QByteArray m_userAgent;
 };
 
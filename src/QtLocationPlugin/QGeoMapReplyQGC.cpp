@@ -47,6 +47,8 @@
 #include "QGCMapEngine.h"
 #include "QGeoMapReplyQGC.h"
 #include "QGeoTileFetcherQGC.h"
+#include "QGCApplication.h"
+#include "QGCNetworkService.h"
 
 #include <QtLocation/private/qgeotilespec_p.h>
 #include <QtNetwork/QNetworkAccessManager>
@@ -54,7 +56,6 @@
 #include "TerrainTile.h"
 
 int         QGeoTiledMapReplyQGC::_requestCount = 0;
-QByteArray  QGeoTiledMapReplyQGC::_bingNoTileImage;
 
 //-----------------------------------------------------------------------------
 QGeoTiledMapReplyQGC::QGeoTiledMapReplyQGC(QNetworkAccessManager *networkManager, const QNetworkRequest &request, const QGeoTileSpec &spec, QObject *parent)
@@ -62,13 +63,9 @@ QGeoTiledMapReplyQGC::QGeoTiledMapReplyQGC(QNetworkAccessManager *networkManager
     , _reply(nullptr)
     , _request(request)
     , _networkManager(networkManager)
+    , _fetchQueued(false)
+    , _rendering(false)
 {
-    if (_bingNoTileImage.count() == 0) {
-        QFile file(":/res/BingNoTileBytes.dat");
-        file.open(QFile::ReadOnly);
-        _bingNoTileImage = file.readAll();
-        file.close();
-    }
     if(_request.url().isEmpty()) {
         if(!_badMapbox.size()) {
             QFile b(":/res/notile.png");
@@ -79,20 +76,60 @@ QGeoTiledMapReplyQGC::QGeoTiledMapReplyQGC(QNetworkAccessManager *networkManager
         setMapImageFormat("png");
         setFinished(true);
         setCached(false);
+    } else if(_fromMemoryCache()) {
+        setFinished(true);
+        setCached(true);
     } else {
         QGCFetchTileTask* task = getQGCMapEngine()->createFetchTileTask(getQGCMapEngine()->urlFactory()->getTypeFromId(spec.mapId()), spec.x(), spec.y(), spec.zoom());
         connect(task, &QGCFetchTileTask::tileFetched, this, &QGeoTiledMapReplyQGC::cacheReply);
+        connect(task, &QGCFetchTileTask::tileEmpty, this, &QGeoTiledMapReplyQGC::cacheEmpty);
         connect(task, &QGCMapTask::error, this, &QGeoTiledMapReplyQGC::cacheError);
         getQGCMapEngine()->addTask(task);
     }
 }
 
+//-----------------------------------------------------------------------------
+QGCTileKey
+QGeoTiledMapReplyQGC::_memoryCacheKey()
+{
+    const QGeoTileSpec& spec = tileSpec();
+    return QGCTileKey(getQGCMapEngine()->urlFactory()->getProviderIndex(spec.mapId()), spec.x(), spec.y(), spec.zoom());
+}
+
+//-----------------------------------------------------------------------------
+// Elevation tiles are left out, TerrainTileManager keeps its own cache of parsed tiles
+bool
+QGeoTiledMapReplyQGC::_fromMemoryCache()
+{
+    if(getQGCMapEngine()->urlFactory()->isElevation(tileSpec().mapId())) {
+        return false;
+    }
+    QByteArray  image;
+    QString     format;
+    if(!getQGCMapEngine()->tileMemoryCache()->find(_memoryCacheKey(), image, format)) {
+        return false;
+    }
+    setMapImageData(image);
+    setMapImageFormat(format);
+    return true;
+}
+
 //-----------------------------------------------------------------------------
 QGeoTiledMapReplyQGC::~QGeoTiledMapReplyQGC()
 {
     _clearReply();
 }
 
+//-----------------------------------------------------------------------------
+void
+QGeoTiledMapReplyQGC::_leaveFetchQueue()
+{
+    if (_fetchQueued) {
+        _fetchQueued = false;
+        getQGCMapEngine()->tileFetchQueue()->remove(this);
+    }
+}
+
 //-----------------------------------------------------------------------------
 void
 QGeoTiledMapReplyQGC::_clearReply()
@@ -103,6 +140,18 @@ QGeoTiledMapReplyQGC::_clearReply()
         _reply = nullptr;
         _requestCount--;
     }
+    _leaveFetchQueue();
+    _cancelRender();
+}
+
+//-----------------------------------------------------------------------------
+void
+QGeoTiledMapReplyQGC::_cancelRender()
+{
+    if (_rendering) {
+        _rendering = false;
+        getQGCMapEngine()->terrainTileRenderer()->cancel(this);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -110,6 +159,9 @@ void
 QGeoTiledMapReplyQGC::abort()
 {
     _timer.stop();
+    //-- Also drops the request if it is still waiting for its turn
+    _leaveFetchQueue();
+    _cancelRender();
     if (_reply)
         _reply->abort();
     emit aborted();
@@ -144,17 +196,19 @@ QGeoTiledMapReplyQGC::networkReplyFinished()
         emit terrainDone(a, QNetworkReply::NoError);
     } else {
         MapProvider* mapProvider = urlFactory->getMapProviderFromId(tileSpec().mapId());
-        if (mapProvider && mapProvider->_isBingProvider() && a.size() && _bingNoTileImage.size() && a == _bingNoTileImage) {
-            // Bing doesn't return an error if you request a tile above supported zoom level
-            // It instead returns an image of a missing tile graphic. We need to detect that
+        if (mapProvider && mapProvider->_isNoTile(a)) {
+            // Some providers don't return an error if you request a tile above supported zoom level
+            // They instead return an image of a missing tile graphic. We need to detect that
             // and error out so Qt will deal with zooming correctly even if it doesn't have the tile.
             // This allows us to zoom up to level 23 even though the tiles don't actually exist
-            setError(QGeoTiledMapReply::CommunicationError, "Bing tile above zoom level");
+            getQGCMapEngine()->cacheEmptyTile(urlFactory->getTypeFromId(tileSpec().mapId()), tileSpec().x(), tileSpec().y(), tileSpec().zoom());
+            setError(QGeoTiledMapReply::CommunicationError, "Tile not available");
         } else {
             //-- This is a map tile. Process and cache it if valid.
             setMapImageData(a);
             if(!format.isEmpty()) {
                 setMapImageFormat(format);
+                getQGCMapEngine()->tileMemoryCache()->insert(_memoryCacheKey(), a, format);
                 getQGCMapEngine()->cacheTile(getQGCMapEngine()->urlFactory()->getTypeFromId(tileSpec().mapId()), tileSpec().x(), tileSpec().y(), tileSpec().zoom(), a, format);
             }
         }
@@ -171,6 +225,10 @@ QGeoTiledMapReplyQGC::networkReplyError(QNetworkReply::NetworkError error)
     if (!_reply) {
         return;
     }
+    //-- Not found is an answer, unlike the other errors
+    if (error == QNetworkReply::ContentNotFoundError) {
+        getQGCMapEngine()->cacheEmptyTile(getQGCMapEngine()->urlFactory()->getTypeFromId(tileSpec().mapId()), tileSpec().x(), tileSpec().y(), tileSpec().zoom());
+    }
     //-- Test for a specialized, elevation data (not map tile)
     if( getQGCMapEngine()->urlFactory()->isElevation(tileSpec().mapId())){
         emit terrainDone(QByteArray(), error);
@@ -189,7 +247,11 @@ QGeoTiledMapReplyQGC::networkReplyError(QNetworkReply::NetworkError error)
 void
 QGeoTiledMapReplyQGC::cacheError(QGCMapTask::TaskType type, QString /*errorString*/)
 {
-    if(!getQGCMapEngine()->isInternetActive()) {
+    if(getQGCMapEngine()->urlFactory()->isLocal(tileSpec().mapId())) {
+        //-- Rendered here, which also works offline as long as the elevation tiles are cached
+        _rendering = true;
+        getQGCMapEngine()->terrainTileRenderer()->render(this);
+    } else if(!qgcApp()->toolbox()->networkService()->requestAllowed(_request.url())) {
         if( getQGCMapEngine()->urlFactory()->isElevation(tileSpec().mapId())){
             emit terrainDone(QByteArray(), QNetworkReply::NetworkSessionFailedError);
         } else {
@@ -200,26 +262,56 @@ QGeoTiledMapReplyQGC::cacheError(QGCMapTask::TaskType type, QString /*errorStrin
         if(type != QGCMapTask::taskFetchTile) {
             qWarning() << "QGeoTiledMapReplyQGC::cacheError() for wrong task";
         }
-        //-- Tile not in cache. Get it off the Internet.
+        //-- Tile not in cache. Get it off the Internet once it's our turn.
+        _fetchQueued = true;
+        getQGCMapEngine()->tileFetchQueue()->enqueue(this);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+QGeoTiledMapReplyQGC::_startNetworkRequest()
+{
 #if !defined(__mobile__)
-        QNetworkProxy proxy = _networkManager->proxy();
-        QNetworkProxy tProxy;
-        tProxy.setType(QNetworkProxy::DefaultProxy);
-        _networkManager->setProxy(tProxy);
+    QNetworkProxy proxy = _networkManager->proxy();
+    QNetworkProxy tProxy;
+    tProxy.setType(QNetworkProxy::DefaultProxy);
+    _networkManager->setProxy(tProxy);
 #endif
-        _reply = _networkManager->get(_request);
-        _reply->setParent(nullptr);
-        connect(_reply, &QNetworkReply::finished, this, &QGeoTiledMapReplyQGC::networkReplyFinished);
-        connect(_reply, SIGNAL(error(QNetworkReply::NetworkError)), this, SLOT(networkReplyError(QNetworkReply::NetworkError)));
+    _reply = _networkManager->get(_request);
+    _reply->setParent(nullptr);
+    connect(_reply, &QNetworkReply::finished, this, &QGeoTiledMapReplyQGC::networkReplyFinished);
+    connect(_reply, SIGNAL(error(QNetworkReply::NetworkError)), this, SLOT(networkReplyError(QNetworkReply::NetworkError)));
 #if !defined(__mobile__)
-        _networkManager->setProxy(proxy);
+    _networkManager->setProxy(proxy);
 #endif
-        //- Wait for an answer up to 10 seconds
-        connect(&_timer, &QTimer::timeout, this, &QGeoTiledMapReplyQGC::timeout);
-        _timer.setSingleShot(true);
-        _timer.start(10000);
-        _requestCount++;
-    }
+    //- Wait for an answer up to 10 seconds
+    connect(&_timer, &QTimer::timeout, this, &QGeoTiledMapReplyQGC::timeout);
+    _timer.setSingleShot(true);
+    _timer.start(10000);
+    _requestCount++;
+}
+
+//-----------------------------------------------------------------------------
+void
+QGeoTiledMapReplyQGC::_renderFinished(const QByteArray& image)
+{
+    _rendering = false;
+    const QString format("png");
+    setMapImageData(image);
+    setMapImageFormat(format);
+    getQGCMapEngine()->tileMemoryCache()->insert(_memoryCacheKey(), image, format);
+    getQGCMapEngine()->cacheTile(getQGCMapEngine()->urlFactory()->getTypeFromId(tileSpec().mapId()), tileSpec().x(), tileSpec().y(), tileSpec().zoom(), image, format);
+    setFinished(true);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGeoTiledMapReplyQGC::_renderFailed(const QString& errorString)
+{
+    _rendering = false;
+    setError(QGeoTiledMapReply::CommunicationError, errorString);
+    setFinished(true);
 }
 
 //-----------------------------------------------------------------------------
@@ -233,12 +325,25 @@ QGeoTiledMapReplyQGC::cacheReply(QGCCacheTile* tile)
         //-- Regular map tile
         setMapImageData(tile->img());
         setMapImageFormat(tile->format());
+        getQGCMapEngine()->tileMemoryCache()->insert(_memoryCacheKey(), tile->img(), tile->format());
         setFinished(true);
         setCached(true);
     }
     tile->deleteLater();
 }
 
+//-----------------------------------------------------------------------------
+void
+QGeoTiledMapReplyQGC::cacheEmpty()
+{
+    if( getQGCMapEngine()->urlFactory()->isElevation(tileSpec().mapId())){
+        emit terrainDone(QByteArray(), QNetworkReply::ContentNotFoundError);
+    } else {
+        setError(QGeoTiledMapReply::CommunicationError, "Tile not available");
+        setFinished(true);
+    }
+}
+
 //-----------------------------------------------------------------------------
 void
 QGeoTiledMapReplyQGC::timeout()
@@ -68,11 +68,22 @@ private slots:
     void networkReplyFinished   ();
     void networkReplyError      (QNetworkReply::NetworkError error);
     void cacheReply             (QGCCacheTile* tile);
+    void cacheEmpty             ();
     void cacheError             (QGCMapTask::TaskType type, QString errorString);
     void timeout                ();
 
 private:
+    friend class QGCTileFetchQueue;
+    friend class QGCTerrainTileRenderer;
+
+    void _startNetworkRequest   ();
+    void _renderFinished        (const QByteArray& image);
+    void _renderFailed          (const QString& errorString);
+    void _cancelRender          ();
+    void _leaveFetchQueue       ();
     void _clearReply            ();
+    bool _fromMemoryCache       ();
+    QGCTileKey _memoryCacheKey  ();
 
 private:
     QNetworkReply*          _reply;
@@ -81,7 +92,8 @@ private:
     QByteArray              _badMapbox;
     QByteArray              _badTile;
     QTimer                  _timer;
-    static QByteArray       _bingNoTileImage;
+    bool                    _fetchQueued;       ///< Waiting in or started by the tile fetch queue
+    bool                    _rendering;         ///< Waiting for QGCTerrainTileRenderer
     static int              _requestCount;
 };
 
@@ -47,6 +47,8 @@
 #include "QGCMapEngine.h"
 #include "QGeoTileFetcherQGC.h"
 #include "QGeoMapReplyQGC.h"
+#include "QGCApplication.h"
+#include "QGCNetworkService.h"
 
 #include <QtCore/QLocale>
 #include <QtNetwork/QNetworkRequest>
@@ -55,12 +57,8 @@
 //-----------------------------------------------------------------------------
 QGeoTileFetcherQGC::QGeoTileFetcherQGC(QGeoTiledMappingManagerEngine *parent)
     : QGeoTileFetcher(parent)
-    , _networkManager(new QNetworkAccessManager(this))
 {
-    //-- Check internet status every 30 seconds or so
-    connect(&_timer, &QTimer::timeout, this, &QGeoTileFetcherQGC::timeout);
-    _timer.setSingleShot(false);
-    _timer.start(30000);
+
 }
 
 //-----------------------------------------------------------------------------
@@ -73,19 +71,15 @@ QGeoTileFetcherQGC::~QGeoTileFetcherQGC()
 QGeoTiledMapReply*
 QGeoTileFetcherQGC::getTileImage(const QGeoTileSpec &spec)
 {
+    //-- Shared with the other map and network users of this thread
+    QNetworkAccessManager* networkManager = qgcApp()->toolbox()->networkService()->networkAccessManager();
     //-- Build URL
-    QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL(spec.mapId(), spec.x(), spec.y(), spec.zoom(), _networkManager);
+    QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL(spec.mapId(), spec.x(), spec.y(), spec.zoom(), networkManager);
     if ( ! request.url().isEmpty() ) {
-        return new QGeoTiledMapReplyQGC(_networkManager, request, spec);
+        QGCNetworkService::setConsumer(request, QGCNetworkService::consumerMapTiles);
+        return new QGeoTiledMapReplyQGC(networkManager, request, spec);
     }
     else {
         return nullptr;
     }
 }
-
-//-----------------------------------------------------------------------------
-void
-QGeoTileFetcherQGC::timeout()
-{
-    getQGCMapEngine()->testInternet();
-}
@@ -48,11 +48,9 @@
 #define QGEOTILEFETCHERQGC_H
 
 #include <QtLocation/private/qgeotilefetcher_p.h>
-#include <QTimer>
 #include "QGCMapUrlEngine.h"
 
 class QGeoTiledMappingManagerEngine;
-class QNetworkAccessManager;
 
 class QGeoTileFetcherQGC : public QGeoTileFetcher
 {
@@ -60,13 +58,8 @@ class QGeoTileFetcherQGC : public QGeoTileFetcher
 public:
     explicit QGeoTileFetcherQGC             (QGeoTiledMappingManagerEngine *parent = 0);
     ~QGeoTileFetcherQGC();
-public slots:
-    void                    timeout         ();
 private:
     QGeoTiledMapReply*      getTileImage    (const QGeoTileSpec &spec);
-private:
-    QNetworkAccessManager*  _networkManager;
-    QTimer                  _timer;
 };
 
 #endif // QGEOTILEFETCHERQGC_H
@@ -63,6 +63,20 @@ QGeoTiledMapQGC::QGeoTiledMapQGC(QGeoTiledMappingManagerEngine *engine, QObject
 
 }
 
+//-----------------------------------------------------------------------------
+QGeoTiledMapQGC::~QGeoTiledMapQGC()
+{
+    getQGCMapEngine()->tileFetchQueue()->removeViewport(this);
+}
+
+//-----------------------------------------------------------------------------
+void
+QGeoTiledMapQGC::evaluateCopyrights(const QSet<QGeoTileSpec> &visibleTiles)
+{
+    getQGCMapEngine()->tileFetchQueue()->setViewport(this, visibleTiles);
+    QGeoTiledMap::evaluateCopyrights(visibleTiles);
+}
+
 //-----------------------------------------------------------------------------
 QGeoTiledMappingManagerEngineQGC::QGeoTiledMappingManagerEngineQGC(const QVariantMap &parameters, QGeoServiceProvider::Error *error, QString *errorString)
 :   QGeoTiledMappingManagerEngine()
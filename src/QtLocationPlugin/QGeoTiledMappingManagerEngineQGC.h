@@ -56,6 +56,11 @@ class QGeoTiledMapQGC : public QGeoTiledMap
     Q_OBJECT
 public:
     QGeoTiledMapQGC(QGeoTiledMappingManagerEngine *engine, QObject *parent = 0);
+    ~QGeoTiledMapQGC();
+
+protected:
+    /// Called with the visible tiles whenever new ones come into view, which is what the tile fetch queue orders by
+    void evaluateCopyrights(const QSet<QGeoTileSpec> &visibleTiles) override;
 };
 
 class QGeoTileFetcherQGC;
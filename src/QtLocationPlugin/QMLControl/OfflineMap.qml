@@ -301,6 +301,14 @@ Item {
                         text:           qsTr("Memory cache changes require a restart to take effect.")
                     }
 
+                    QGCLabel {
+                        anchors.left:   parent.left
+                        anchors.right:  parent.right
+                        wrapMode:       Text.WordWrap
+                        font.pointSize: _adjustableFontPointSize
+                        text:           qsTr("Memory cache hits: %1 misses: %2").arg(QGroundControl.mapEngineManager.memoryCacheHits).arg(QGroundControl.mapEngineManager.memoryCacheMisses)
+                    }
+
                     Item { width: 1; height: 1; visible: _mapboxFact ? _mapboxFact.visible : false }
                     QGCLabel { text: qsTr("Mapbox Access Token"); visible: _mapboxFact ? _mapboxFact.visible : false }
                     FactTextField {
@@ -1168,6 +1176,13 @@ Item {
                 height:         exportCloseButton.height
                 anchors.horizontalCenter: parent.horizontalCenter
             }
+            QGCButton {
+                text:           qsTr("Cancel")
+                width:          _buttonSize
+                visible:        QGroundControl.mapEngineManager.importAction === QGCMapEngineManager.ActionExporting
+                anchors.horizontalCenter: parent.horizontalCenter
+                onClicked:      QGroundControl.mapEngineManager.cancelImportExport()
+            }
             QGCButton {
                 id:             exportCloseButton
                 text:           qsTr("Close")
@@ -1231,6 +1246,13 @@ Item {
                 height:         width
                 anchors.horizontalCenter: parent.horizontalCenter
             }
+            QGCButton {
+                text:           qsTr("Cancel")
+                width:          _buttonSize
+                visible:        QGroundControl.mapEngineManager.importAction === QGCMapEngineManager.ActionImporting
+                anchors.horizontalCenter: parent.horizontalCenter
+                onClicked:      QGroundControl.mapEngineManager.cancelImportExport()
+            }
             Column {
                 id:                 mapSetButtons
                 spacing:            ScreenTools.defaultFontPixelHeight
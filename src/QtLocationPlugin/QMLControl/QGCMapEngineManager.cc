@@ -160,27 +160,76 @@ QGCMapEngineManager::startDownload(const QString& name, const QString& mapType)
         qWarning() <<  "QGCMapEngineManager::startDownload() No Tiles to save";
     }
     if (mapType != "Airmap Elevation" && _fetchElevation) {
-        QGCCachedTileSet* set = new QGCCachedTileSet(name + " Elevation");
-        set->setMapTypeStr("Airmap Elevation");
-        set->setTopleftLat(_topleftLat);
-        set->setTopleftLon(_topleftLon);
-        set->setBottomRightLat(_bottomRightLat);
-        set->setBottomRightLon(_bottomRightLon);
-        set->setMinZoom(1);
-        set->setMaxZoom(1);
-        set->setTotalTileSize(_elevationSet.tileSize);
-        set->setTotalTileCount(static_cast<quint32>(_elevationSet.tileCount));
-        set->setType("Airmap Elevation");
-        QGCCreateTileSetTask* task = new QGCCreateTileSetTask(set);
-        //-- Create Tile Set (it will also create a list of tiles to download)
-        connect(task, &QGCCreateTileSetTask::tileSetSaved, this, &QGCMapEngineManager::_tileSetSaved);
-        connect(task, &QGCMapTask::error, this, &QGCMapEngineManager::taskError);
-        getQGCMapEngine()->addTask(task);
+        _startElevationDownload(name + " Elevation", _topleftLat, _topleftLon, _bottomRightLat, _bottomRightLon, _elevationSet);
     } else {
         qWarning() <<  "QGCMapEngineManager::startDownload() No Tiles to save";
     }
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCMapEngineManager::startElevationDownload(const QString& name, const QGeoCoordinate& topLeft, const QGeoCoordinate& bottomRight)
+{
+    if (!topLeft.isValid() || !bottomRight.isValid()) {
+        qWarning() <<  "QGCMapEngineManager::startElevationDownload() Invalid area";
+        return;
+    }
+    QGCTileSet elevationSet = QGCMapEngine::getTileCount(1, topLeft.longitude(), topLeft.latitude(), bottomRight.longitude(), bottomRight.latitude(), "Airmap Elevation");
+    qCDebug(QGCMapEngineManagerLog) << "startElevationDownload" << name << topLeft << bottomRight << elevationSet.tileCount;
+    _startElevationDownload(name, topLeft.latitude(), topLeft.longitude(), bottomRight.latitude(), bottomRight.longitude(), elevationSet);
+}
+
+//-----------------------------------------------------------------------------
+// Tile sets are rectangular so this downloads the bounding box of the polygon, which is at most a few extra 1km tiles
+void
+QGCMapEngineManager::startElevationDownloadForPolygon(const QString& name, const QVariantList& polygon)
+{
+    double north = -90.0;
+    double south = 90.0;
+    double east  = -180.0;
+    double west  = 180.0;
+    int    count = 0;
+    for (const QVariant& vertex: polygon) {
+        QGeoCoordinate coord = vertex.value<QGeoCoordinate>();
+        if (!coord.isValid()) {
+            continue;
+        }
+        north = qMax(north, coord.latitude());
+        south = qMin(south, coord.latitude());
+        east  = qMax(east,  coord.longitude());
+        west  = qMin(west,  coord.longitude());
+        count++;
+    }
+    if (count < 3) {
+        qWarning() <<  "QGCMapEngineManager::startElevationDownloadForPolygon() Invalid polygon";
+        return;
+    }
+    startElevationDownload(name, QGeoCoordinate(north, west), QGeoCoordinate(south, east));
+}
+
+//-----------------------------------------------------------------------------
+// Elevation tiles in a named set are never pruned from the cache, so this is what makes terrain available offline
+void
+QGCMapEngineManager::_startElevationDownload(const QString& name, double topleftLat, double topleftLon, double bottomRightLat, double bottomRightLon, const QGCTileSet& elevationSet)
+{
+    QGCCachedTileSet* set = new QGCCachedTileSet(name);
+    set->setMapTypeStr("Airmap Elevation");
+    set->setTopleftLat(topleftLat);
+    set->setTopleftLon(topleftLon);
+    set->setBottomRightLat(bottomRightLat);
+    set->setBottomRightLon(bottomRightLon);
+    set->setMinZoom(1);
+    set->setMaxZoom(1);
+    set->setTotalTileSize(elevationSet.tileSize);
+    set->setTotalTileCount(static_cast<quint32>(elevationSet.tileCount));
+    set->setType("Airmap Elevation");
+    QGCCreateTileSetTask* task = new QGCCreateTileSetTask(set);
+    //-- Create Tile Set (it will also create a list of tiles to download)
+    connect(task, &QGCCreateTileSetTask::tileSetSaved, this, &QGCMapEngineManager::_tileSetSaved);
+    connect(task, &QGCMapTask::error, this, &QGCMapEngineManager::taskError);
+    getQGCMapEngine()->addTask(task);
+}
+
 //-----------------------------------------------------------------------------
 void
 QGCMapEngineManager::_tileSetSaved(QGCCachedTileSet *set)
@@ -382,6 +431,7 @@ QGCMapEngineManager::taskError(QGCMapTask::TaskType type, QString error)
 void
 QGCMapEngineManager::_updateTotals(quint32 totaltiles, quint64 totalsize, quint32 defaulttiles, quint64 defaultsize)
 {
+    emit memoryCacheStatsChanged();
     for(int i = 0; i < _tileSets.count(); i++ ) {
         QGCCachedTileSet* set = qobject_cast<QGCCachedTileSet*>(_tileSets.get(i));
         if (set && set->defaultSet()) {
@@ -468,6 +518,7 @@ QGCMapEngineManager::importSets(QString path) {
         connect(task, &QGCImportTileTask::actionCompleted, this, &QGCMapEngineManager::_actionCompleted);
         connect(task, &QGCImportTileTask::actionProgress, this, &QGCMapEngineManager::_actionProgressHandler);
         connect(task, &QGCMapTask::error, this, &QGCMapEngineManager::taskError);
+        _transferTask = task;
         getQGCMapEngine()->addTask(task);
         return true;
     }
@@ -501,6 +552,17 @@ QGCMapEngineManager::exportSets(QString path) {
                 sets.append(set);
             }
         }
+        //-- Map sets take the elevation set created along with them (see startDownload), so terrain is available wherever they are imported
+        QStringList elevationNames;
+        for(QGCCachedTileSet* set: sets) {
+            elevationNames.append(set->name() + " Elevation");
+        }
+        for(int i = 0; i < _tileSets.count(); i++ ) {
+            QGCCachedTileSet* set = qobject_cast<QGCCachedTileSet*>(_tileSets.get(i));
+            if(!set->selected() && !set->defaultSet() && set->type() == "Airmap Elevation" && elevationNames.contains(set->name())) {
+                sets.append(set);
+            }
+        }
         if(sets.count()) {
             _importAction = ActionExporting;
             emit importActionChanged();
@@ -508,6 +570,7 @@ QGCMapEngineManager::exportSets(QString path) {
             connect(task, &QGCExportTileTask::actionCompleted, this, &QGCMapEngineManager::_actionCompleted);
             connect(task, &QGCExportTileTask::actionProgress, this, &QGCMapEngineManager::_actionProgressHandler);
             connect(task, &QGCMapTask::error, this, &QGCMapEngineManager::taskError);
+            _transferTask = task;
             getQGCMapEngine()->addTask(task);
             return true;
         }
@@ -544,6 +607,16 @@ QGCMapEngineManager::resetAction()
     emit importActionChanged();
 }
 
+//-----------------------------------------------------------------------------
+void
+QGCMapEngineManager::cancelImportExport()
+{
+    //-- The worker stops at the next chunk and completes the task with an error
+    if(_transferTask) {
+        _transferTask->cancel();
+    }
+}
+
 //-----------------------------------------------------------------------------
 QString
 QGCMapEngineManager::getUniqueName()
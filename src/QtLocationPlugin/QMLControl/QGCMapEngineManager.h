@@ -20,6 +20,9 @@
 #include "QGCMapEngine.h"
 #include "QGCMapTileSet.h"
 
+#include <QGeoCoordinate>
+#include <QPointer>
+
 Q_DECLARE_LOGGING_CATEGORY(QGCMapEngineManagerLog)
 
 class QGCMapEngineManager : public QGCTool
@@ -48,6 +51,8 @@ public:
     Q_PROPERTY(quint32              maxDiskCache    READ    maxDiskCache    WRITE   setMaxDiskCache NOTIFY  maxDiskCacheChanged)
     Q_PROPERTY(QString              errorMessage    READ    errorMessage    NOTIFY  errorMessageChanged)
     Q_PROPERTY(bool                 fetchElevation  READ    fetchElevation  WRITE   setFetchElevation   NOTIFY  fetchElevationChanged)
+    Q_PROPERTY(quint64              memoryCacheHits     READ    memoryCacheHits     NOTIFY  memoryCacheStatsChanged)
+    Q_PROPERTY(quint64              memoryCacheMisses   READ    memoryCacheMisses   NOTIFY  memoryCacheStatsChanged)
     //-- Disk Space in MB
     Q_PROPERTY(quint32              freeDiskSpace   READ    freeDiskSpace   NOTIFY  freeDiskSpaceChanged)
     Q_PROPERTY(quint32              diskSpace       READ    diskSpace       CONSTANT)
@@ -61,6 +66,8 @@ public:
     Q_INVOKABLE void                loadTileSets            ();
     Q_INVOKABLE void                updateForCurrentView    (double lon0, double lat0, double lon1, double lat1, int minZoom, int maxZoom, const QString& mapName);
     Q_INVOKABLE void                startDownload           (const QString& name, const QString& mapType);
+    Q_INVOKABLE void                startElevationDownload  (const QString& name, const QGeoCoordinate& topLeft, const QGeoCoordinate& bottomRight);
+    Q_INVOKABLE void                startElevationDownloadForPolygon(const QString& name, const QVariantList& polygon);
     Q_INVOKABLE void                saveSetting             (const QString& key,  const QString& value);
     Q_INVOKABLE QString             loadSetting             (const QString& key,  const QString& defaultValue);
     Q_INVOKABLE void                deleteTileSet           (QGCCachedTileSet* tileSet);
@@ -72,6 +79,7 @@ public:
     Q_INVOKABLE bool                exportSets              (QString path = QString());
     Q_INVOKABLE bool                importSets              (QString path = QString());
     Q_INVOKABLE void                resetAction             ();
+    Q_INVOKABLE void                cancelImportExport      ();
 
     quint64                         tileCount               () { return _imageSet.tileCount + _elevationSet.tileCount; }
     QString                         tileCountStr            ();
@@ -85,6 +93,8 @@ public:
     quint32                         maxDiskCache            ();
     QString                         errorMessage            () { return _errorMessage; }
     bool                            fetchElevation          () { return _fetchElevation; }
+    quint64                         memoryCacheHits         () { return getQGCMapEngine()->tileMemoryCache()->hits(); }
+    quint64                         memoryCacheMisses       () { return getQGCMapEngine()->tileMemoryCache()->misses(); }
     quint64                         freeDiskSpace           () { return _freeDiskSpace; }
     quint64                         diskSpace               () { return _diskSpace; }
     int                             selectedCount           ();
@@ -110,6 +120,7 @@ signals:
     void maxDiskCacheChanged    ();
     void errorMessageChanged    ();
     void fetchElevationChanged  ();
+    void memoryCacheStatsChanged();
     void freeDiskSpaceChanged   ();
     void selectedCountChanged   ();
     void actionProgressChanged  ();
@@ -130,6 +141,7 @@ private slots:
 
 private:
     void _updateDiskFreeSpace   ();
+    void _startElevationDownload(const QString& name, double topleftLat, double topleftLon, double bottomRightLat, double bottomRightLon, const QGCTileSet& elevationSet);
 
 private:
     QGCTileSet  _imageSet;
@@ -149,6 +161,7 @@ private:
     int         _actionProgress;
     ImportAction _importAction;
     bool        _importReplace;
+    QPointer<QGCTransferTileTask> _transferTask;
 };
 
 #endif
@@ -11,6 +11,7 @@
 #include "QGCGeo.h"
 
 #include <QFile>
+#include <QVector>
 #include <QVariant>
 #include <QtDebug>
 #include <QRegularExpression>
@@ -111,7 +112,7 @@ ShapeFileHelper::ShapeType SHPFileHelper::determineShapeType(const QString& shpF
     return shapeType;
 }
 
-bool SHPFileHelper::loadPolygonFromFile(const QString& shpFile, QList<QGeoCoordinate>& vertices, QString& errorString)
+bool SHPFileHelper::loadPolygonFromFile(const QString& shpFile, QList<QGeoCoordinate>& vertices, QString& errorString, const ShapeFileHelper::ProgressCallback_t& progress)
 {
     int         utmZone = 0;
     bool        utmSouthernHemisphere;
@@ -140,13 +141,32 @@ bool SHPFileHelper::loadPolygonFromFile(const QString& shpFile, QList<QGeoCoordi
         goto Error;
     }
 
-    for (int i=0; i<shpObject->nVertices; i++) {
-        QGeoCoordinate coord;
-        if (!utmZone || !convertUTMToGeo(shpObject->padfX[i], shpObject->padfY[i], utmZone, utmSouthernHemisphere, coord)) {
-            coord.setLatitude(shpObject->padfY[i]);
-            coord.setLongitude(shpObject->padfX[i]);
+    // shapelib reads the whole shape at once, so progress can only be reported once that is done
+    if (progress && !progress(0.5)) {
+        errorString = QString(_errorPrefix).arg(tr("Load cancelled."));
+        goto Error;
+    }
+
+    {
+        // All the vertices are in the same zone, so they are converted in one batch
+        QVector<double> latitudes(shpObject->nVertices, qQNaN());
+        QVector<double> longitudes(shpObject->nVertices, qQNaN());
+        if (utmZone) {
+            convertUTMToGeo(shpObject->padfX, shpObject->padfY, shpObject->nVertices, utmZone, utmSouthernHemisphere, latitudes.data(), longitudes.data());
+        }
+
+        vertices.reserve(shpObject->nVertices);
+        for (int i=0; i<shpObject->nVertices; i++) {
+            QGeoCoordinate coord;
+            if (qIsNaN(latitudes[i])) {
+                coord.setLatitude(shpObject->padfY[i]);
+                coord.setLongitude(shpObject->padfX[i]);
+            } else {
+                coord.setLatitude(latitudes[i]);
+                coord.setLongitude(longitudes[i]);
+            }
+            vertices.append(coord);
         }
-        vertices.append(coord);
     }
 
     // Filter last vertex such that it differs from first
@@ -158,16 +178,20 @@ bool SHPFileHelper::loadPolygonFromFile(const QString& shpFile, QList<QGeoCoordi
         }
     }
 
-    // Filter vertex distances to be larger than 1 meter apart
-    {
-        int i = 0;
-        while (i < vertices.count() - 2) {
-            if (vertices[i].distanceTo(vertices[i+1]) < vertexFilterMeters) {
-                vertices.removeAt(i+1);
-            } else {
-                i++;
+    // Filter vertex distances to be larger than 1 meter apart. Kept vertices are compacted to the front in one pass
+    // rather than removing each filtered one, which is quadratic on large shapes. The last one is always kept.
+    if (vertices.count() > 2) {
+        int keptCount = 1;
+        for (int i=1; i<vertices.count(); i++) {
+            if (i == vertices.count() - 1 || vertices[keptCount-1].distanceTo(vertices[i]) >= vertexFilterMeters) {
+                vertices[keptCount++] = vertices[i];
             }
         }
+        vertices.erase(vertices.begin() + keptCount, vertices.end());
+    }
+
+    if (progress) {
+        progress(1);
     }
 
 Error:
@@ -26,7 +26,7 @@ class SHPFileHelper : public QObject
 
 public:
     static ShapeFileHelper::ShapeType determineShapeType(const QString& shpFile, QString& errorString);
-    static bool loadPolygonFromFile(const QString& shpFile, QList<QGeoCoordinate>& vertices, QString& errorString);
+    static bool loadPolygonFromFile(const QString& shpFile, QList<QGeoCoordinate>& vertices, QString& errorString, const ShapeFileHelper::ProgressCallback_t& progress = ShapeFileHelper::ProgressCallback_t());
 
 private:
     static bool         _validateSHPFiles(const QString& shpFile, int* utmZone, bool* utmSouthernHemisphere, QString& errorString);
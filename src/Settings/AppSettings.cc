@@ -34,6 +34,7 @@ const char* AppSettings::logDirectory =             QT_TRANSLATE_NOOP("AppSettin
 const char* AppSettings::videoDirectory =           QT_TRANSLATE_NOOP("AppSettings", "Video");
 const char* AppSettings::photoDirectory =           QT_TRANSLATE_NOOP("AppSettings", "Photo");
 const char* AppSettings::crashDirectory =           QT_TRANSLATE_NOOP("AppSettings", "CrashLogs");
+const char* AppSettings::terrainDirectory =         QT_TRANSLATE_NOOP("AppSettings", "Terrain");
 
 DECLARE_SETTINGGROUP(App, "")
 {
@@ -110,7 +111,10 @@ DECLARE_SETTINGSFACT(AppSettings, defaultMissionItemAltitude)
 DECLARE_SETTINGSFACT(AppSettings, telemetrySave)
 DECLARE_SETTINGSFACT(AppSettings, telemetrySaveNotArmed)
 DECLARE_SETTINGSFACT(AppSettings, audioMuted)
+DECLARE_SETTINGSFACT(AppSettings, audioMessageMaxAge)
+DECLARE_SETTINGSFACT(AppSettings, audioVehicleInterval)
 DECLARE_SETTINGSFACT(AppSettings, checkInternet)
+DECLARE_SETTINGSFACT(AppSettings, powerSaving)
 DECLARE_SETTINGSFACT(AppSettings, virtualJoystick)
 DECLARE_SETTINGSFACT(AppSettings, virtualJoystickAutoCenterThrottle)
 DECLARE_SETTINGSFACT(AppSettings, appFontPointSize)
@@ -125,6 +129,7 @@ DECLARE_SETTINGSFACT(AppSettings, esriToken)
 DECLARE_SETTINGSFACT(AppSettings, defaultFirmwareType)
 DECLARE_SETTINGSFACT(AppSettings, gstDebugLevel)
 DECLARE_SETTINGSFACT(AppSettings, followTarget)
+DECLARE_SETTINGSFACT(AppSettings, followTargetRate)
 DECLARE_SETTINGSFACT(AppSettings, apmStartMavlinkStreams)
 DECLARE_SETTINGSFACT(AppSettings, enableTaisync)
 DECLARE_SETTINGSFACT(AppSettings, enableTaisyncVideo)
@@ -133,9 +138,14 @@ DECLARE_SETTINGSFACT(AppSettings, language)
 DECLARE_SETTINGSFACT(AppSettings, disableAllPersistence)
 DECLARE_SETTINGSFACT(AppSettings, usePairing)
 DECLARE_SETTINGSFACT(AppSettings, saveCsvTelemetry)
+DECLARE_SETTINGSFACT(AppSettings, telemetryRecordRate)
+DECLARE_SETTINGSFACT(AppSettings, telemetryRecordCsv)
 DECLARE_SETTINGSFACT(AppSettings, firstRunPromptIdsShown)
 DECLARE_SETTINGSFACT(AppSettings, forwardMavlink)
 DECLARE_SETTINGSFACT(AppSettings, forwardMavlinkHostName)
+DECLARE_SETTINGSFACT(AppSettings, mavlinkDecodeOnLinkThread)
+DECLARE_SETTINGSFACT(AppSettings, telemetryStreamEnabled)
+DECLARE_SETTINGSFACT(AppSettings, telemetryStreamPort)
 DECLARE_SETTINGSFACT(AppSettings, useComponentInformationQuery)
 
 DECLARE_SETTINGSFACT_NO_FUNC(AppSettings, indoorPalette)
@@ -166,6 +176,7 @@ void AppSettings::_checkSavePathDirectories(void)
         savePathDir.mkdir(videoDirectory);
         savePathDir.mkdir(photoDirectory);
         savePathDir.mkdir(crashDirectory);
+        savePathDir.mkdir(terrainDirectory);
     }
 }
 
@@ -244,6 +255,16 @@ QString AppSettings::crashSavePath(void)
     return QString();
 }
 
+QString AppSettings::terrainSavePath(void)
+{
+    QString path = savePath()->rawValue().toString();
+    if (!path.isEmpty() && QDir(path).exists()) {
+        QDir dir(path);
+        return dir.filePath(terrainDirectory);
+    }
+    return QString();
+}
+
 QList<int> AppSettings::firstRunPromptsIdsVariantToList(const QVariant& firstRunPromptIds)
 {
     QList<int> rgIds;
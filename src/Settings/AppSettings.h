@@ -37,7 +37,10 @@ public:
     DEFINE_SETTINGFACT(telemetrySave)
     DEFINE_SETTINGFACT(telemetrySaveNotArmed)
     DEFINE_SETTINGFACT(audioMuted)
+    DEFINE_SETTINGFACT(audioMessageMaxAge)
+    DEFINE_SETTINGFACT(audioVehicleInterval)
     DEFINE_SETTINGFACT(checkInternet)
+    DEFINE_SETTINGFACT(powerSaving)
     DEFINE_SETTINGFACT(virtualJoystick)
     DEFINE_SETTINGFACT(virtualJoystickAutoCenterThrottle)
     DEFINE_SETTINGFACT(appFontPointSize)
@@ -53,6 +56,7 @@ public:
     DEFINE_SETTINGFACT(defaultFirmwareType)
     DEFINE_SETTINGFACT(gstDebugLevel)
     DEFINE_SETTINGFACT(followTarget)
+    DEFINE_SETTINGFACT(followTargetRate)
     DEFINE_SETTINGFACT(enableTaisync)
     DEFINE_SETTINGFACT(enableTaisyncVideo)
     DEFINE_SETTINGFACT(enableMicrohard)
@@ -60,9 +64,14 @@ public:
     DEFINE_SETTINGFACT(disableAllPersistence)
     DEFINE_SETTINGFACT(usePairing)
     DEFINE_SETTINGFACT(saveCsvTelemetry)
+    DEFINE_SETTINGFACT(telemetryRecordRate)
+    DEFINE_SETTINGFACT(telemetryRecordCsv)
     DEFINE_SETTINGFACT(firstRunPromptIdsShown)
     DEFINE_SETTINGFACT(forwardMavlink)
     DEFINE_SETTINGFACT(forwardMavlinkHostName)
+    DEFINE_SETTINGFACT(mavlinkDecodeOnLinkThread)
+    DEFINE_SETTINGFACT(telemetryStreamEnabled)
+    DEFINE_SETTINGFACT(telemetryStreamPort)
     DEFINE_SETTINGFACT(useComponentInformationQuery)
 
     // Although this is a global setting it only affects ArduPilot vehicle since PX4 automatically starts the stream from the vehicle side
@@ -75,6 +84,7 @@ public:
     Q_PROPERTY(QString videoSavePath        READ videoSavePath      NOTIFY savePathsChanged)
     Q_PROPERTY(QString photoSavePath        READ photoSavePath      NOTIFY savePathsChanged)
     Q_PROPERTY(QString crashSavePath        READ crashSavePath      NOTIFY savePathsChanged)
+    Q_PROPERTY(QString terrainSavePath      READ terrainSavePath    NOTIFY savePathsChanged)
 
     Q_PROPERTY(QString planFileExtension        MEMBER planFileExtension        CONSTANT)
     Q_PROPERTY(QString missionFileExtension     MEMBER missionFileExtension     CONSTANT)
@@ -92,6 +102,7 @@ public:
     QString videoSavePath       ();
     QString photoSavePath       ();
     QString crashSavePath       ();
+    QString terrainSavePath     ();
 
     // Helper methods for working with firstRunPromptIds QVariant settings string list
     static QList<int> firstRunPromptsIdsVariantToList   (const QVariant& firstRunPromptIds);
@@ -118,6 +129,7 @@ public:
     static const char* videoDirectory;
     static const char* photoDirectory;
     static const char* crashDirectory;
+    static const char* terrainDirectory;    ///< Local elevation datasets, see TerrainLocalDEM
 
     // Returns the current language setting bypassing the standard SettingsGroup path. This should only be used
     // by QGCApplication::setLanguage to query the language setting as early in the boot process as possible.
@@ -20,3 +20,4 @@ DECLARE_SETTINGGROUP(FirmwareUpgrade, "FirmwareUpgrade")
 DECLARE_SETTINGSFACT(FirmwareUpgradeSettings, defaultFirmwareType)
 DECLARE_SETTINGSFACT(FirmwareUpgradeSettings, apmChibiOS)
 DECLARE_SETTINGSFACT(FirmwareUpgradeSettings, apmVehicleType)
+DECLARE_SETTINGSFACT(FirmwareUpgradeSettings, prefetchBoardIds)
@@ -23,4 +23,5 @@ public:
     DEFINE_SETTINGFACT(defaultFirmwareType)
     DEFINE_SETTINGFACT(apmChibiOS)
     DEFINE_SETTINGFACT(apmVehicleType)
+    DEFINE_SETTINGFACT(prefetchBoardIds)
 };
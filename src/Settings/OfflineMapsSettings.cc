@@ -20,3 +20,4 @@ DECLARE_SETTINGGROUP(OfflineMaps, "OfflineMaps")
 DECLARE_SETTINGSFACT(OfflineMapsSettings, minZoomLevelDownload)
 DECLARE_SETTINGSFACT(OfflineMapsSettings, maxZoomLevelDownload)
 DECLARE_SETTINGSFACT(OfflineMapsSettings, maxTilesForDownload)
+DECLARE_SETTINGSFACT(OfflineMapsSettings, maxTerrainDownloads)
@@ -24,3 +24,11 @@ DECLARE_SETTINGSFACT(RTKSettings, fixedBasePositionLatitude)
 DECLARE_SETTINGSFACT(RTKSettings, fixedBasePositionLongitude)
 DECLARE_SETTINGSFACT(RTKSettings, fixedBasePositionAltitude)
 DECLARE_SETTINGSFACT(RTKSettings, fixedBasePositionAccuracy)
+DECLARE_SETTINGSFACT(RTKSettings, rtcmBandwidthLimit)
+DECLARE_SETTINGSFACT(RTKSettings, ntripServerConnectEnabled)
+DECLARE_SETTINGSFACT(RTKSettings, ntripServerHostAddress)
+DECLARE_SETTINGSFACT(RTKSettings, ntripServerPort)
+DECLARE_SETTINGSFACT(RTKSettings, ntripMountpoint)
+DECLARE_SETTINGSFACT(RTKSettings, ntripUsername)
+DECLARE_SETTINGSFACT(RTKSettings, ntripPassword)
+DECLARE_SETTINGSFACT(RTKSettings, ntripGgaInterval)
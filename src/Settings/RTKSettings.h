@@ -24,4 +24,12 @@ public:
     DEFINE_SETTINGFACT(fixedBasePositionLongitude)
     DEFINE_SETTINGFACT(fixedBasePositionAltitude)
     DEFINE_SETTINGFACT(fixedBasePositionAccuracy)
+    DEFINE_SETTINGFACT(rtcmBandwidthLimit)
+    DEFINE_SETTINGFACT(ntripServerConnectEnabled)
+    DEFINE_SETTINGFACT(ntripServerHostAddress)
+    DEFINE_SETTINGFACT(ntripServerPort)
+    DEFINE_SETTINGFACT(ntripMountpoint)
+    DEFINE_SETTINGFACT(ntripUsername)
+    DEFINE_SETTINGFACT(ntripPassword)
+    DEFINE_SETTINGFACT(ntripGgaInterval)
 };
@@ -26,6 +26,7 @@ const char* VideoSettings::videoSourceUDPH264           = "UDP h.264 Video Strea
 const char* VideoSettings::videoSourceUDPH265           = "UDP h.265 Video Stream";
 const char* VideoSettings::videoSourceTCP               = "TCP-MPEG2 Video Stream";
 const char* VideoSettings::videoSourceMPEGTS            = "MPEG-TS (h.264) Video Stream";
+const char* VideoSettings::videoSourceSRT               = "SRT Video Stream";
 const char* VideoSettings::videoSource3DRSolo           = "3DR Solo (requires restart)";
 const char* VideoSettings::videoSourceParrotDiscovery   = "Parrot Discovery";
 
@@ -43,6 +44,7 @@ DECLARE_SETTINGGROUP(Video, "Video")
 #endif
     videoSourceList.append(videoSourceTCP);
     videoSourceList.append(videoSourceMPEGTS);
+    videoSourceList.append(videoSourceSRT);
     videoSourceList.append(videoSource3DRSolo);
     videoSourceList.append(videoSourceParrotDiscovery);
 #endif
@@ -103,10 +105,28 @@ DECLARE_SETTINGSFACT(VideoSettings, showRecControl)
 DECLARE_SETTINGSFACT(VideoSettings, recordingFormat)
 DECLARE_SETTINGSFACT(VideoSettings, maxVideoSize)
 DECLARE_SETTINGSFACT(VideoSettings, enableStorageLimit)
+DECLARE_SETTINGSFACT(VideoSettings, preRecordDuration)
+DECLARE_SETTINGSFACT(VideoSettings, recordingSegmentDuration)
+DECLARE_SETTINGSFACT(VideoSettings, recordTelemetryTrack)
 DECLARE_SETTINGSFACT(VideoSettings, rtspTimeout)
 DECLARE_SETTINGSFACT(VideoSettings, streamEnabled)
 DECLARE_SETTINGSFACT(VideoSettings, disableWhenDisarmed)
 DECLARE_SETTINGSFACT(VideoSettings, lowLatencyMode)
+DECLARE_SETTINGSFACT(VideoSettings, adaptiveLatency)
+DECLARE_SETTINGSFACT(VideoSettings, latencyPreference)
+DECLARE_SETTINGSFACT(VideoSettings, decoderRankOverrides)
+DECLARE_SETTINGSFACT(VideoSettings, restreamEnabled)
+DECLARE_SETTINGSFACT(VideoSettings, restreamPort)
+DECLARE_SETTINGSFACT(VideoSettings, restreamMaxViewers)
+DECLARE_SETTINGSFACT(VideoSettings, thermalPalette)
+DECLARE_SETTINGSFACT(VideoSettings, thermalAutoRange)
+DECLARE_SETTINGSFACT(VideoSettings, thermalRangeLow)
+DECLARE_SETTINGSFACT(VideoSettings, thermalRangeHigh)
+DECLARE_SETTINGSFACT(VideoSettings, thermalIsotherm)
+DECLARE_SETTINGSFACT(VideoSettings, thermalIsothermLow)
+DECLARE_SETTINGSFACT(VideoSettings, thermalIsothermHigh)
+DECLARE_SETTINGSFACT(VideoSettings, thermalRawScale)
+DECLARE_SETTINGSFACT(VideoSettings, thermalRawOffset)
 
 DECLARE_SETTINGSFACT_NO_FUNC(VideoSettings, videoSource)
 {
@@ -165,6 +185,15 @@ DECLARE_SETTINGSFACT_NO_FUNC(VideoSettings, rtspUrl)
     return _rtspUrlFact;
 }
 
+DECLARE_SETTINGSFACT_NO_FUNC(VideoSettings, srtUrl)
+{
+    if (!_srtUrlFact) {
+        _srtUrlFact = _createSettingsFact(srtUrlName);
+        connect(_srtUrlFact, &Fact::valueChanged, this, &VideoSettings::_configChanged);
+    }
+    return _srtUrlFact;
+}
+
 DECLARE_SETTINGSFACT_NO_FUNC(VideoSettings, tcpUrl)
 {
     if (!_tcpUrlFact) {
@@ -180,7 +209,8 @@ bool VideoSettings::streamConfigured(void)
     return false;
 #endif
     //-- First, check if it's autoconfigured
-    if(qgcApp()->toolbox()->videoManager()->autoStreamConfigured()) {
+    VideoManager* videoManager = qgcApp()->toolbox()->videoManager();
+    if(videoManager && videoManager->autoStreamConfigured()) {
         qCDebug(VideoManagerLog) << "Stream auto configured";
         return true;
     }
@@ -204,6 +234,11 @@ bool VideoSettings::streamConfigured(void)
         qCDebug(VideoManagerLog) << "Testing configuration for TCP Stream:" << tcpUrl()->rawValue().toString();
         return !tcpUrl()->rawValue().toString().isEmpty();
     }
+    //-- If SRT, check for URL
+    if(vSource == videoSourceSRT) {
+        qCDebug(VideoManagerLog) << "Testing configuration for SRT Stream:" << srtUrl()->rawValue().toString();
+        return !srtUrl()->rawValue().toString().isEmpty();
+    }
     //-- If MPEG-TS, check if port is set
     if(vSource == videoSourceMPEGTS) {
         qCDebug(VideoManagerLog) << "Testing configuration for MPEG-TS Stream:" << udpPort()->rawValue().toInt();
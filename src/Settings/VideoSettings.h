@@ -24,6 +24,7 @@ public:
     DEFINE_SETTINGFACT(udpPort)
     DEFINE_SETTINGFACT(tcpUrl)
     DEFINE_SETTINGFACT(rtspUrl)
+    DEFINE_SETTINGFACT(srtUrl)
     DEFINE_SETTINGFACT(aspectRatio)
     DEFINE_SETTINGFACT(videoFit)
     DEFINE_SETTINGFACT(gridLines)
@@ -31,11 +32,29 @@ public:
     DEFINE_SETTINGFACT(recordingFormat)
     DEFINE_SETTINGFACT(maxVideoSize)
     DEFINE_SETTINGFACT(enableStorageLimit)
+    DEFINE_SETTINGFACT(preRecordDuration)
+    DEFINE_SETTINGFACT(recordingSegmentDuration)
+    DEFINE_SETTINGFACT(recordTelemetryTrack)
     DEFINE_SETTINGFACT(rtspTimeout)
     DEFINE_SETTINGFACT(streamEnabled)
     DEFINE_SETTINGFACT(disableWhenDisarmed)
     DEFINE_SETTINGFACT(lowLatencyMode)
+    DEFINE_SETTINGFACT(adaptiveLatency)
+    DEFINE_SETTINGFACT(latencyPreference)
     DEFINE_SETTINGFACT(forceVideoDecoder)
+    DEFINE_SETTINGFACT(decoderRankOverrides)
+    DEFINE_SETTINGFACT(restreamEnabled)
+    DEFINE_SETTINGFACT(restreamPort)
+    DEFINE_SETTINGFACT(restreamMaxViewers)
+    DEFINE_SETTINGFACT(thermalPalette)
+    DEFINE_SETTINGFACT(thermalAutoRange)
+    DEFINE_SETTINGFACT(thermalRangeLow)
+    DEFINE_SETTINGFACT(thermalRangeHigh)
+    DEFINE_SETTINGFACT(thermalIsotherm)
+    DEFINE_SETTINGFACT(thermalIsothermLow)
+    DEFINE_SETTINGFACT(thermalIsothermHigh)
+    DEFINE_SETTINGFACT(thermalRawScale)
+    DEFINE_SETTINGFACT(thermalRawOffset)
 
     enum VideoDecoderOptions {
         ForceVideoDecoderDefault = 0,
@@ -44,6 +63,7 @@ public:
         ForceVideoDecoderVAAPI,
         ForceVideoDecoderDirectX3D,
         ForceVideoDecoderVideoToolbox,
+        ForceVideoDecoderHardware,
     };
     Q_ENUM(VideoDecoderOptions)
 
@@ -53,6 +73,7 @@ public:
     Q_PROPERTY(QString  udp265VideoSource       READ udp265VideoSource      CONSTANT)
     Q_PROPERTY(QString  tcpVideoSource          READ tcpVideoSource         CONSTANT)
     Q_PROPERTY(QString  mpegtsVideoSource       READ mpegtsVideoSource      CONSTANT)
+    Q_PROPERTY(QString  srtVideoSource          READ srtVideoSource         CONSTANT)
     Q_PROPERTY(QString  disabledVideoSource     READ disabledVideoSource    CONSTANT)
 
     bool     streamConfigured       ();
@@ -61,6 +82,7 @@ public:
     QString  udp265VideoSource      () { return videoSourceUDPH265; }
     QString  tcpVideoSource         () { return videoSourceTCP; }
     QString  mpegtsVideoSource      () { return videoSourceMPEGTS; }
+    QString  srtVideoSource         () { return videoSourceSRT; }
     QString  disabledVideoSource    () { return videoDisabled; }
 
     static const char* videoSourceNoVideo;
@@ -70,6 +92,7 @@ public:
     static const char* videoSourceRTSP;
     static const char* videoSourceTCP;
     static const char* videoSourceMPEGTS;
+    static const char* videoSourceSRT;
     static const char* videoSource3DRSolo;
     static const char* videoSourceParrotDiscovery;
 
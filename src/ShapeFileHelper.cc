@@ -11,6 +11,7 @@
 #include "AppSettings.h"
 #include "KMLHelper.h"
 #include "SHPFileHelper.h"
+#include "QGCGeo.h"
 
 #include <QFile>
 
@@ -61,7 +62,7 @@ ShapeFileHelper::ShapeType ShapeFileHelper::determineShapeType(const QString& fi
     return shapeType;
 }
 
-bool ShapeFileHelper::loadPolygonFromFile(const QString& file, QList<QGeoCoordinate>& vertices, QString& errorString)
+bool ShapeFileHelper::loadPolygonFromFile(const QString& file, QList<QGeoCoordinate>& vertices, QString& errorString, int maxVertices, const ProgressCallback_t& progress)
 {
     bool success = false;
 
@@ -71,16 +72,21 @@ bool ShapeFileHelper::loadPolygonFromFile(const QString& file, QList<QGeoCoordin
     bool fileIsKML = _fileIsKML(file, errorString);
     if (errorString.isEmpty()) {
         if (fileIsKML) {
-            success = KMLHelper::loadPolygonFromFile(file, vertices, errorString);
+            success = KMLHelper::loadPolygonFromFile(file, vertices, errorString, progress);
         } else {
-            success = SHPFileHelper::loadPolygonFromFile(file, vertices, errorString);
+            success = SHPFileHelper::loadPolygonFromFile(file, vertices, errorString, progress);
         }
     }
 
+    if (success && maxVertices > 0) {
+        // A polygon needs at least three vertices
+        vertices = simplifyPathToCount(vertices, qMax(maxVertices, 3));
+    }
+
     return success;
 }
 
-bool ShapeFileHelper::loadPolylineFromFile(const QString& file, QList<QGeoCoordinate>& coords, QString& errorString)
+bool ShapeFileHelper::loadPolylineFromFile(const QString& file, QList<QGeoCoordinate>& coords, QString& errorString, int maxVertices, const ProgressCallback_t& progress)
 {
     errorString.clear();
     coords.clear();
@@ -88,7 +94,9 @@ bool ShapeFileHelper::loadPolylineFromFile(const QString& file, QList<QGeoCoordi
     bool fileIsKML = _fileIsKML(file, errorString);
     if (errorString.isEmpty()) {
         if (fileIsKML) {
-            KMLHelper::loadPolylineFromFile(file, coords, errorString);
+            if (KMLHelper::loadPolylineFromFile(file, coords, errorString, progress) && maxVertices > 0) {
+                coords = simplifyPathToCount(coords, maxVertices);
+            }
         } else {
             errorString = QString(_errorPrefix).arg(tr("Polyline not support from SHP files."));
         }
@@ -14,6 +14,8 @@
 #include <QGeoCoordinate>
 #include <QVariant>
 
+#include <functional>
+
 /// Routines for loading polygons or polylines from KML or SHP files.
 class ShapeFileHelper : public QObject
 {
@@ -27,6 +29,9 @@ public:
     };
     Q_ENUM(ShapeType)
 
+    /// Called while a file loads with the fraction loaded so far, from 0 to 1. Return false to cancel the load.
+    typedef std::function<bool(double progress)> ProgressCallback_t;
+
     Q_PROPERTY(QStringList fileDialogKMLFilters         READ fileDialogKMLFilters       CONSTANT) ///< File filter list for load/save KML file dialogs
     Q_PROPERTY(QStringList fileDialogKMLOrSHPFilters    READ fileDialogKMLOrSHPFilters  CONSTANT) ///< File filter list for load/save shape file dialogs
 
@@ -38,8 +43,12 @@ public:
     QStringList fileDialogKMLOrSHPFilters   (void) const;
 
     static ShapeType determineShapeType(const QString& file, QString& errorString);
-    static bool loadPolygonFromFile(const QString& file, QList<QGeoCoordinate>& vertices, QString& errorString);
-    static bool loadPolylineFromFile(const QString& file, QList<QGeoCoordinate>& coords, QString& errorString);
+
+    /// Loads a polygon or polyline from the file
+    ///     @param maxVertices  Simplifies larger shapes down to this many vertices, 0 for no limit
+    ///     @param progress     Called as the file loads, can be empty
+    static bool loadPolygonFromFile (const QString& file, QList<QGeoCoordinate>& vertices, QString& errorString, int maxVertices = 0, const ProgressCallback_t& progress = ProgressCallback_t());
+    static bool loadPolylineFromFile(const QString& file, QList<QGeoCoordinate>& coords, QString& errorString, int maxVertices = 0, const ProgressCallback_t& progress = ProgressCallback_t());
 
 private:
     static bool _fileIsKML(const QString& file, QString& errorString);
@@ -50,6 +50,11 @@ TaisyncManager::TaisyncManager(QGCApplication* app, QGCToolbox* toolbox)
 TaisyncManager::~TaisyncManager()
 {
     _close();
+#if defined(__ios__) || defined(__android__)
+    //-- The bridges are deleted as the thread finishes
+    _ioThread.quit();
+    _ioThread.wait();
+#endif
 }
 
 //-----------------------------------------------------------------------------
@@ -62,24 +67,32 @@ TaisyncManager::_close()
         _taiSettings = nullptr;
     }
 #if defined(__ios__) || defined(__android__)
+    //-- The bridges live on the I/O thread, they close their sockets there as they are deleted
     if (_taiTelemetery) {
-        _taiTelemetery->close();
         _taiTelemetery->deleteLater();
         _taiTelemetery = nullptr;
     }
-    if(_telemetrySocket) {
-        _telemetrySocket->close();
-        _telemetrySocket->deleteLater();
-        _telemetrySocket = nullptr;
-    }
     if (_taiVideo) {
-        _taiVideo->close();
         _taiVideo->deleteLater();
         _taiVideo = nullptr;
     }
 #endif
 }
 
+//-----------------------------------------------------------------------------
+#if defined(__ios__) || defined(__android__)
+void
+TaisyncManager::_startBridge(TaisyncHandler* handler)
+{
+    if(!_ioThread.isRunning()) {
+        _ioThread.setObjectName(QStringLiteral("TaisyncIO"));
+        _ioThread.start(QThread::HighPriority);
+    }
+    handler->moveToThread(&_ioThread);
+    QMetaObject::invokeMethod(handler, [handler]() { handler->start(); }, Qt::QueuedConnection);
+}
+#endif
+
 //-----------------------------------------------------------------------------
 void
 TaisyncManager::_reset()
@@ -180,6 +193,12 @@ TaisyncManager::setToolbox(QGCToolbox* toolbox)
         _videoRateList.append("high");
         connect(_videoRate, &Fact::_containerRawValueChanged, this, &TaisyncManager::_videoSettingsChanged);
     }
+}
+
+//-----------------------------------------------------------------------------
+void
+TaisyncManager::deferredInit()
+{
     //-- Start it all
     _reset();
 }
@@ -292,14 +311,8 @@ TaisyncManager::_setEnabled()
         }
 #if defined(__ios__) || defined(__android__)
         if(!_taiTelemetery) {
-            _taiTelemetery = new TaisyncTelemetry(this);
-            QObject::connect(_taiTelemetery, &TaisyncTelemetry::bytesReady, this, &TaisyncManager::_readTelemBytes);
-            _telemetrySocket = new QUdpSocket(this);
-            _telemetrySocket->setSocketOption(QAbstractSocket::SendBufferSizeSocketOption,    64 * 1024);
-            _telemetrySocket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 64 * 1024);
-            QObject::connect(_telemetrySocket, &QUdpSocket::readyRead, this, &TaisyncManager::_readUDPBytes);
-            _telemetrySocket->bind(QHostAddress::LocalHost, 0, QUdpSocket::ShareAddress);
-            _taiTelemetery->start();
+            _taiTelemetery = new TaisyncTelemetry();
+            _startBridge(_taiTelemetery);
         }
 #endif
         _reqMask = static_cast<uint32_t>(REQ_ALL);
@@ -342,8 +355,8 @@ TaisyncManager::_setVideoEnabled()
         if(!_taiVideo) {
             //-- iOS and Android receive raw h.264 and need a different pipeline
             qgcApp()->toolbox()->videoManager()->setIsTaisync(true);
-            _taiVideo = new TaisyncVideoReceiver(this);
-            _taiVideo->start();
+            _taiVideo = new TaisyncVideoReceiver();
+            _startBridge(_taiVideo);
         }
 #endif
     } else {
@@ -351,7 +364,6 @@ TaisyncManager::_setVideoEnabled()
 #if defined(__ios__) || defined(__android__)
         qgcApp()->toolbox()->videoManager()->setIsTaisync(false);
         if (_taiVideo) {
-            _taiVideo->close();
             _taiVideo->deleteLater();
             _taiVideo = nullptr;
         }
@@ -365,35 +377,6 @@ TaisyncManager::_setVideoEnabled()
     _enableVideo = enable;
 }
 
-//-----------------------------------------------------------------------------
-#if defined(__ios__) || defined(__android__)
-void
-TaisyncManager::_readTelemBytes(QByteArray bytesIn)
-{
-    //-- Send telemetry from vehicle to QGC (using normal UDP)
-    _telemetrySocket->writeDatagram(bytesIn, QHostAddress::LocalHost, TAISYNC_TELEM_TARGET_PORT);
-}
-#endif
-
-//-----------------------------------------------------------------------------
-#if defined(__ios__) || defined(__android__)
-void
-TaisyncManager::_readUDPBytes()
-{
-    if (!_telemetrySocket || !_taiTelemetery) {
-        return;
-    }
-    //-- Read UDP data from QGC
-    while (_telemetrySocket->hasPendingDatagrams()) {
-        QByteArray datagram;
-        datagram.resize(static_cast<int>(_telemetrySocket->pendingDatagramSize()));
-        _telemetrySocket->readDatagram(datagram.data(), datagram.size());
-        //-- Send it to vehicle
-        _taiTelemetery->writeBytes(datagram);
-    }
-}
-#endif
-
 //-----------------------------------------------------------------------------
 void
 TaisyncManager::_connected()
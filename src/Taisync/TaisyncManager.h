@@ -20,6 +20,7 @@
 
 #include <QTimer>
 #include <QTime>
+#include <QThread>
 
 class AppSettings;
 class QGCApplication;
@@ -57,6 +58,7 @@ public:
     ~TaisyncManager                         () override;
 
     void        setToolbox                      (QGCToolbox* toolbox) override;
+    void        deferredInit                    () override;
 
     bool        connected                       () { return _isConnected; }
     bool        linkConnected                   () { return _linkConnected; }
@@ -102,16 +104,15 @@ private slots:
     void    _setVideoEnabled                ();
     void    _radioSettingsChanged           (QVariant);
     void    _videoSettingsChanged           (QVariant);
-#if defined(__ios__) || defined(__android__)
-    void    _readUDPBytes                   ();
-    void    _readTelemBytes                 (QByteArray bytesIn);
-#endif
 
 private:
     void    _close                          ();
     void    _reset                          ();
     void    _restoreVideoSettings           (Fact* setting);
     FactMetaData *_createMetadata           (const char *name, QStringList enums);
+#if defined(__ios__) || defined(__android__)
+    void    _startBridge                    (TaisyncHandler* handler);
+#endif
 
 private:
 
@@ -135,7 +136,7 @@ private:
 #if defined(__ios__) || defined(__android__)
     TaisyncTelemetry*       _taiTelemetery  = nullptr;
     TaisyncVideoReceiver*   _taiVideo       = nullptr;
-    QUdpSocket*             _telemetrySocket= nullptr;
+    QThread                 _ioThread;                  ///< Telemetry and video bridges
 #endif
     bool            _enableVideo            = true;
     bool            _enabled                = true;
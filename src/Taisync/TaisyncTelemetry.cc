@@ -8,9 +8,6 @@
  ****************************************************************************/
 
 #include "TaisyncTelemetry.h"
-#include "SettingsManager.h"
-#include "QGCApplication.h"
-#include "VideoManager.h"
 
 //-----------------------------------------------------------------------------
 TaisyncTelemetry::TaisyncTelemetry(QObject* parent)
@@ -22,8 +19,13 @@ TaisyncTelemetry::TaisyncTelemetry(QObject* parent)
 bool
 TaisyncTelemetry::close()
 {
-    if(TaisyncHandler::close()) {
+    if(TaisyncHandler::close() || _udpSocket) {
         qCDebug(TaisyncLog) << "Close Taisync Telemetry";
+        if(_udpSocket) {
+            _udpSocket->close();
+            _udpSocket->deleteLater();
+            _udpSocket = nullptr;
+        }
         return true;
     }
     return false;
@@ -33,16 +35,17 @@ TaisyncTelemetry::close()
 bool TaisyncTelemetry::start()
 {
     qCDebug(TaisyncLog) << "Start Taisync Telemetry";
-    return _start(TAISYNC_TELEM_PORT);
-}
-
-//-----------------------------------------------------------------------------
-void
-TaisyncTelemetry::writeBytes(QByteArray bytes)
-{
-    if(_tcpSocket) {
-        _tcpSocket->write(bytes);
+    if(!_start(TAISYNC_TELEM_PORT)) {
+        return false;
     }
+    _tcpBuffer.resize(bufferSize);
+    _udpBuffer.resize(bufferSize);
+    _udpSocket = new QUdpSocket(this);
+    _udpSocket->setSocketOption(QAbstractSocket::SendBufferSizeSocketOption,    bufferSize);
+    _udpSocket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, bufferSize);
+    QObject::connect(_udpSocket, &QUdpSocket::readyRead, this, &TaisyncTelemetry::_readUDPBytes);
+    _udpSocket->bind(QHostAddress::LocalHost, 0, QUdpSocket::ShareAddress);
+    return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -57,8 +60,31 @@ TaisyncTelemetry::_newConnection()
 void
 TaisyncTelemetry::_readBytes()
 {
-    while(_tcpSocket->bytesAvailable()) {
-        QByteArray bytesIn = _tcpSocket->read(_tcpSocket->bytesAvailable());
-        emit bytesReady(bytesIn);
+    //-- Send telemetry from vehicle to QGC (using normal UDP)
+    while(_tcpSocket && _tcpSocket->bytesAvailable()) {
+        qint64 count = _tcpSocket->read(_tcpBuffer.data(), _tcpBuffer.size());
+        if(count <= 0) {
+            break;
+        }
+        if(_udpSocket) {
+            _udpSocket->writeDatagram(_tcpBuffer.constData(), count, QHostAddress::LocalHost, TAISYNC_TELEM_TARGET_PORT);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+TaisyncTelemetry::_readUDPBytes()
+{
+    //-- Read UDP data from QGC and send it to vehicle
+    while(_udpSocket && _udpSocket->hasPendingDatagrams()) {
+        qint64 size = _udpSocket->pendingDatagramSize();
+        if(size > _udpBuffer.size()) {
+            _udpBuffer.resize(static_cast<int>(size));
+        }
+        qint64 count = _udpSocket->readDatagram(_udpBuffer.data(), _udpBuffer.size());
+        if(count > 0 && _tcpSocket) {
+            _tcpSocket->write(_udpBuffer.constData(), count);
+        }
     }
 }
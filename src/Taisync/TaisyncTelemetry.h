@@ -11,8 +11,9 @@
 
 #include "TaisyncHandler.h"
 #include <QUdpSocket>
-#include <QTimer>
 
+/// Lives on the I/O thread of TaisyncManager. Relays MAVLink between the Taisync TCP connection and the UDP link of
+/// QGC on localhost, reading both ways into reused buffers.
 class TaisyncTelemetry : public TaisyncHandler
 {
     Q_OBJECT
@@ -21,13 +22,16 @@ public:
     explicit TaisyncTelemetry           (QObject* parent = nullptr);
     bool    close                       () override;
     bool    start                       () override;
-    void    writeBytes                  (QByteArray bytes);
 
-signals:
-    void    bytesReady                   (QByteArray bytes);
+    static const int bufferSize         = 64 * 1024;
 
 private slots:
     void    _newConnection              () override;
     void    _readBytes                  () override;
+    void    _readUDPBytes               ();
 
+private:
+    QUdpSocket*     _udpSocket          = nullptr;
+    QByteArray      _tcpBuffer;
+    QByteArray      _udpBuffer;
 };
@@ -8,50 +8,44 @@
  ****************************************************************************/
 
 #include "TaisyncVideoReceiver.h"
-#include "SettingsManager.h"
-#include "QGCApplication.h"
-#include "VideoManager.h"
+#include "VideoStreamFeed.h"
 
 //-----------------------------------------------------------------------------
 TaisyncVideoReceiver::TaisyncVideoReceiver(QObject* parent)
     : TaisyncHandler(parent)
+    , _feed(VideoStreamFeed::feed(VideoStreamFeed::taisyncFeed))
 {
 }
 
 //-----------------------------------------------------------------------------
 bool
-TaisyncVideoReceiver::close()
+TaisyncVideoReceiver::start()
 {
-    if(TaisyncHandler::close() || _udpVideoSocket) {
-        qCDebug(TaisyncLog) << "Close Taisync Video Receiver";
-        if(_udpVideoSocket) {
-            _udpVideoSocket->close();
-            _udpVideoSocket->deleteLater();
-            _udpVideoSocket = nullptr;
-        }
-        return true;
-    }
-    return false;
+    qCDebug(TaisyncLog) << "Start Taisync Video Receiver";
+    _buffer.resize(readSize);
+    return _start(TAISYNC_VIDEO_TCP_PORT);
 }
 
 //-----------------------------------------------------------------------------
-bool
-TaisyncVideoReceiver::start()
+void
+TaisyncVideoReceiver::_newConnection()
 {
-    qCDebug(TaisyncLog) << "Start Taisync Video Receiver";
-    if(_start(TAISYNC_VIDEO_TCP_PORT)) {
-        _udpVideoSocket = new QUdpSocket(this);
-        return true;
+    TaisyncHandler::_newConnection();
+    if(_tcpSocket) {
+        _tcpSocket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, readSize);
     }
-    return false;
 }
 
 //-----------------------------------------------------------------------------
 void
 TaisyncVideoReceiver::_readBytes()
 {
-    if(_udpVideoSocket) {
-        QByteArray bytesIn = _tcpSocket->read(_tcpSocket->bytesAvailable());
-        _udpVideoSocket->writeDatagram(bytesIn, QHostAddress::LocalHost, TAISYNC_VIDEO_UDP_PORT);
+    //-- Dropped by the feed while the video receiver isn't running
+    while(_tcpSocket && _tcpSocket->bytesAvailable()) {
+        qint64 count = _tcpSocket->read(_buffer.data(), _buffer.size());
+        if(count <= 0) {
+            break;
+        }
+        _feed->write(_buffer.constData(), static_cast<int>(count));
     }
 }
@@ -10,8 +10,11 @@
 #pragma once
 
 #include "TaisyncHandler.h"
-#include <QUdpSocket>
 
+class VideoStreamFeed;
+
+/// Lives on the I/O thread of TaisyncManager. Reads the raw h.264 stream into a reused buffer and hands it straight to
+/// the video receiver through its VideoStreamFeed.
 class TaisyncVideoReceiver : public TaisyncHandler
 {
     Q_OBJECT
@@ -19,11 +22,14 @@ public:
 
     explicit TaisyncVideoReceiver       (QObject* parent = nullptr);
     bool start                          () override;
-    bool close                          () override;
+
+    static const int readSize           = 256 * 1024;
 
 private slots:
+    void    _newConnection              () override;
     void    _readBytes                  () override;
 
 private:
-    QUdpSocket*     _udpVideoSocket     = nullptr;
+    VideoStreamFeed*    _feed           = nullptr;
+    QByteArray          _buffer;
 };
@@ -0,0 +1,879 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainLocalDEM.h"
+#include "QGCMemoryAccounting.h"
+#include "QGCApplication.h"
+#include "QGCTrace.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QtMath>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+QGC_LOGGING_CATEGORY(TerrainLocalDEMLog, "TerrainLocalDEMLog")
+
+Q_GLOBAL_STATIC(TerrainLocalDEM, _terrainLocalDEM)
+
+const QStringList TerrainLocalDEM::fileNameFilters = { "*.hgt", "*.dt0", "*.dt1", "*.dt2", "*.tif", "*.tiff" };
+
+namespace {
+
+const double _edgeTolerance = 1e-9;     ///< Degrees, points on the edge of a dataset count as inside it
+
+// DTED header records
+const int _dtedUHLBytes         = 80;
+const int _dtedDSIBytes         = 648;
+const int _dtedACCBytes         = 2700;
+const int _dtedRecordHeader     = 8;
+const int _dtedRecordChecksum   = 4;
+
+// TIFF tags and types used by the GeoTIFF reader
+const quint16 _tiffImageWidth       = 256;
+const quint16 _tiffImageLength      = 257;
+const quint16 _tiffBitsPerSample    = 258;
+const quint16 _tiffCompression      = 259;
+const quint16 _tiffStripOffsets     = 273;
+const quint16 _tiffSamplesPerPixel  = 277;
+const quint16 _tiffRowsPerStrip     = 278;
+const quint16 _tiffTileWidth        = 322;
+const quint16 _tiffTileLength       = 323;
+const quint16 _tiffTileOffsets      = 324;
+const quint16 _tiffSampleFormat     = 339;
+const quint16 _tiffModelPixelScale  = 33550;
+const quint16 _tiffModelTiepoint    = 33922;
+const quint16 _tiffGeoKeyDirectory  = 34735;
+const quint16 _tiffGDALNoData       = 42113;
+
+const quint16 _geoKeyModelType      = 1024;
+const quint16 _geoKeyRasterType     = 1025;
+const quint16 _modelTypeGeographic  = 2;
+const quint16 _rasterPixelIsPoint   = 2;
+
+quint16 _readUInt16(const uchar* p, bool bigEndian)
+{
+    return bigEndian ? static_cast<quint16>((p[0] << 8) | p[1]) : static_cast<quint16>((p[1] << 8) | p[0]);
+}
+
+quint32 _readUInt32(const uchar* p, bool bigEndian)
+{
+    return bigEndian ?
+                (static_cast<quint32>(p[0]) << 24) | (static_cast<quint32>(p[1]) << 16) | (static_cast<quint32>(p[2]) << 8) | p[3] :
+                (static_cast<quint32>(p[3]) << 24) | (static_cast<quint32>(p[2]) << 16) | (static_cast<quint32>(p[1]) << 8) | p[0];
+}
+
+double _readDouble(const uchar* p, bool bigEndian)
+{
+    quint64 bits = bigEndian ?
+                (static_cast<quint64>(_readUInt32(p, true)) << 32) | _readUInt32(p + 4, true) :
+                (static_cast<quint64>(_readUInt32(p + 4, false)) << 32) | _readUInt32(p, false);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/// @return Degrees from a DTED "DDDMMSSH" angle, NaN if it doesn't parse
+double _dtedAngle(const uchar* p)
+{
+    QByteArray  text    = QByteArray(reinterpret_cast<const char*>(p), 8);
+    bool        okDeg, okMin, okSec;
+    double      degrees = text.mid(0, 3).toInt(&okDeg) + (text.mid(3, 2).toInt(&okMin) / 60.0) + (text.mid(5, 2).toInt(&okSec) / 3600.0);
+    char        hemisphere = text[7];
+
+    if (!okDeg || !okMin || !okSec) {
+        return qQNaN();
+    }
+    if (hemisphere == 'S' || hemisphere == 'W') {
+        return -degrees;
+    } else if (hemisphere == 'N' || hemisphere == 'E') {
+        return degrees;
+    }
+    return qQNaN();
+}
+
+int _dtedInt(const uchar* p, int length, bool& ok)
+{
+    return QByteArray(reinterpret_cast<const char*>(p), length).trimmed().toInt(&ok);
+}
+
+/// A single entry of a TIFF image file directory
+class TiffEntry
+{
+public:
+    TiffEntry(const uchar* data, qint64 size, qint64 entryOffset, bool bigEndian)
+        : _data         (data)
+        , _size         (size)
+        , _bigEndian    (bigEndian)
+    {
+        const uchar* p = data + entryOffset;
+        tag         = _readUInt16(p, bigEndian);
+        _type       = _readUInt16(p + 2, bigEndian);
+        _count      = _readUInt32(p + 4, bigEndian);
+        _valueBytes = _typeBytes() * static_cast<qint64>(_count);
+        // Values which fit in the entry are stored in it, otherwise the entry holds their offset
+        _valueOffset = _valueBytes <= 4 ? entryOffset + 8 : _readUInt32(p + 8, bigEndian);
+    }
+
+    bool valid(void) const { return _typeBytes() > 0 && _valueOffset + _valueBytes <= _size; }
+
+    QVector<double> values(void) const
+    {
+        QVector<double> result;
+        if (!valid()) {
+            return result;
+        }
+        int typeBytes = _typeBytes();
+        result.reserve(static_cast<int>(_count));
+        for (quint32 i=0; i<_count; i++) {
+            const uchar* p = _data + _valueOffset + (i * typeBytes);
+            switch (_type) {
+            case 1:     // BYTE
+                result.append(*p);
+                break;
+            case 3:     // SHORT
+                result.append(_readUInt16(p, _bigEndian));
+                break;
+            case 4:     // LONG
+                result.append(_readUInt32(p, _bigEndian));
+                break;
+            case 12:    // DOUBLE
+                result.append(_readDouble(p, _bigEndian));
+                break;
+            default:
+                return QVector<double>();
+            }
+        }
+        return result;
+    }
+
+    QByteArray text(void) const
+    {
+        if (!valid() || _type != 2) {
+            return QByteArray();
+        }
+        return QByteArray(reinterpret_cast<const char*>(_data + _valueOffset), static_cast<int>(_count));
+    }
+
+    quint16 tag;
+
+private:
+    int _typeBytes(void) const
+    {
+        switch (_type) {
+        case 1:     // BYTE
+        case 2:     // ASCII
+            return 1;
+        case 3:     // SHORT
+            return 2;
+        case 4:     // LONG
+            return 4;
+        case 12:    // DOUBLE
+            return 8;
+        }
+        return 0;
+    }
+
+    const uchar*    _data;
+    qint64          _size;
+    bool            _bigEndian;
+    quint16         _type;
+    quint32         _count;
+    qint64          _valueBytes;
+    qint64          _valueOffset;
+};
+
+}
+
+TerrainDEMDataset::TerrainDEMDataset(void)
+{
+
+}
+
+TerrainDEMDataset::~TerrainDEMDataset()
+{
+    if (_data) {
+        _file.unmap(const_cast<uchar*>(_data));
+    }
+}
+
+bool TerrainDEMDataset::open(const QString& path, QString& errorString)
+{
+    _file.setFileName(path);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        errorString = _file.errorString();
+        return false;
+    }
+
+    _size = _file.size();
+    _data = _file.map(0, _size);
+    if (!_data) {
+        errorString = QStringLiteral("Unable to map file: %1").arg(_file.errorString());
+        return false;
+    }
+
+    QString suffix = QFileInfo(path).suffix().toLower();
+    bool    success;
+    if (suffix == QStringLiteral("hgt")) {
+        success = _openHGT(errorString);
+    } else if (suffix.startsWith(QStringLiteral("dt"))) {
+        success = _openDTED(errorString);
+    } else {
+        success = _openGeoTIFF(errorString);
+    }
+    if (!success) {
+        return false;
+    }
+
+    if (_rows < 2 || _cols < 2 || !(_latSpacing > 0) || !(_lonSpacing > 0) || south() < -90 || north() > 90) {
+        errorString = QStringLiteral("Bad dataset extent");
+        return false;
+    }
+
+    _overviewRows = (_rows + overviewBlockSize - 1) / overviewBlockSize;
+    _overviewCols = (_cols + overviewBlockSize - 1) / overviewBlockSize;
+    _overviewMin.fill(qQNaN(), _overviewRows * _overviewCols);
+    _overviewMax.fill(qQNaN(), _overviewRows * _overviewCols);
+
+    qCDebug(TerrainLocalDEMLog) << "Opened" << path << "south:west:north:east" << south() << west() << north() << east() << "rows:cols" << _rows << _cols;
+
+    return true;
+}
+
+/// SRTM tile: a square grid of big endian int16 samples from the north west corner, named by its south west corner
+bool TerrainDEMDataset::_openHGT(QString& errorString)
+{
+    QRegularExpressionMatch match = QRegularExpression(QStringLiteral("^([NS])(\\d{2})([EW])(\\d{3})"), QRegularExpression::CaseInsensitiveOption).match(QFileInfo(_file.fileName()).fileName());
+    if (!match.hasMatch()) {
+        errorString = QStringLiteral("File name isn't an SRTM tile name");
+        return false;
+    }
+
+    int samples = qRound(qSqrt(_size / 2.0));
+    if (samples < 2 || static_cast<qint64>(samples) * samples * 2 != _size) {
+        errorString = QStringLiteral("File size isn't a square grid of samples");
+        return false;
+    }
+
+    _format         = FormatHGT;
+    _sampleType     = SampleInt16BigEndian;
+    _south          = match.captured(2).toInt() * (match.captured(1).toUpper() == QStringLiteral("S") ? -1 : 1);
+    _west           = match.captured(4).toInt() * (match.captured(3).toUpper() == QStringLiteral("W") ? -1 : 1);
+    _rows           = samples;
+    _cols           = samples;
+    _latSpacing     = 1.0 / (samples - 1);
+    _lonSpacing     = 1.0 / (samples - 1);
+    _hasNoData      = true;
+    _noData         = -32768;
+    _blockRows      = samples;
+    _blockCols      = samples;
+    _blocksAcross   = 1;
+    _blockOffsets   = { 0 };
+
+    return true;
+}
+
+/// DTED cell: UHL, DSI and ACC header records followed by a record per meridian, each holding its samples south to north
+bool TerrainDEMDataset::_openDTED(QString& errorString)
+{
+    const qint64 dataOffset = _dtedUHLBytes + _dtedDSIBytes + _dtedACCBytes;
+
+    if (_size < dataOffset || memcmp(_data, "UHL", 3) != 0) {
+        errorString = QStringLiteral("Missing DTED UHL record");
+        return false;
+    }
+
+    bool okLonInterval, okLatInterval, okCols, okRows;
+    _west       = _dtedAngle(_data + 4);
+    _south      = _dtedAngle(_data + 12);
+    _lonSpacing = _dtedInt(_data + 20, 4, okLonInterval) / 36000.0;     // Tenths of a second
+    _latSpacing = _dtedInt(_data + 24, 4, okLatInterval) / 36000.0;
+    _cols       = _dtedInt(_data + 47, 4, okCols);
+    _rows       = _dtedInt(_data + 51, 4, okRows);
+    if (qIsNaN(_west) || qIsNaN(_south) || !okLonInterval || !okLatInterval || !okCols || !okRows) {
+        errorString = QStringLiteral("Bad DTED UHL record");
+        return false;
+    }
+
+    _columnStride = _dtedRecordHeader + (_rows * 2) + _dtedRecordChecksum;
+    if (dataOffset + (_cols * _columnStride) > _size) {
+        errorString = QStringLiteral("DTED file is shorter than its UHL record says");
+        return false;
+    }
+    if (_data[dataOffset] != 0xAA) {
+        errorString = QStringLiteral("Missing DTED data record sentinel");
+        return false;
+    }
+
+    _format         = FormatDTED;
+    _sampleType     = SampleSignMagnitude16;
+    _hasNoData      = true;
+    _noData         = -32767;
+    _columnMajor    = true;
+    _blockOffsets   = { dataOffset };
+
+    return true;
+}
+
+/// Single band int16 or float32 GeoTIFF in latitude/longitude, uncompressed, in strips or tiles. BigTIFF isn't supported.
+bool TerrainDEMDataset::_openGeoTIFF(QString& errorString)
+{
+    if (_size < 8) {
+        errorString = QStringLiteral("Not a TIFF file");
+        return false;
+    }
+
+    bool bigEndian;
+    if (memcmp(_data, "MM", 2) == 0) {
+        bigEndian = true;
+    } else if (memcmp(_data, "II", 2) == 0) {
+        bigEndian = false;
+    } else {
+        errorString = QStringLiteral("Not a TIFF file");
+        return false;
+    }
+    if (_readUInt16(_data + 2, bigEndian) != 42) {
+        errorString = QStringLiteral("Only classic TIFF files are supported");
+        return false;
+    }
+
+    // Only the first image is used, any others are overviews written by GDAL which aren't needed here
+    qint64 ifdOffset = _readUInt32(_data + 4, bigEndian);
+    if (ifdOffset + 2 > _size) {
+        errorString = QStringLiteral("Bad TIFF directory offset");
+        return false;
+    }
+    int entryCount = _readUInt16(_data + ifdOffset, bigEndian);
+    if (ifdOffset + 2 + (entryCount * 12) > _size) {
+        errorString = QStringLiteral("Bad TIFF directory");
+        return false;
+    }
+
+    QHash<quint16, QVector<double>> values;
+    QByteArray                      noDataText;
+    for (int i=0; i<entryCount; i++) {
+        TiffEntry entry(_data, _size, ifdOffset + 2 + (i * 12), bigEndian);
+        if (entry.tag == _tiffGDALNoData) {
+            noDataText = entry.text();
+        } else {
+            values[entry.tag] = entry.values();
+        }
+    }
+
+    auto value = [&values](quint16 tag, double defaultValue) -> double {
+        QVector<double> tagValues = values.value(tag);
+        return tagValues.isEmpty() ? defaultValue : tagValues[0];
+    };
+
+    int compression     = static_cast<int>(value(_tiffCompression, 1));
+    int samplesPerPixel = static_cast<int>(value(_tiffSamplesPerPixel, 1));
+    int bitsPerSample   = static_cast<int>(value(_tiffBitsPerSample, 1));
+    int sampleFormat    = static_cast<int>(value(_tiffSampleFormat, 1));
+    if (compression != 1) {
+        errorString = QStringLiteral("Compressed GeoTIFF isn't supported, convert it with: gdal_translate -co COMPRESS=NONE");
+        return false;
+    }
+    if (samplesPerPixel != 1) {
+        errorString = QStringLiteral("GeoTIFF must have a single band");
+        return false;
+    }
+    if (bitsPerSample == 16 && sampleFormat != 3) {
+        _sampleType = bigEndian ? SampleInt16BigEndian : SampleInt16LittleEndian;
+    } else if (bitsPerSample == 32 && sampleFormat == 3) {
+        _sampleType = bigEndian ? SampleFloat32BigEndian : SampleFloat32LittleEndian;
+    } else {
+        errorString = QStringLiteral("GeoTIFF samples must be int16 or float32");
+        return false;
+    }
+
+    // The model type has to be geographic, projected datasets would need a reprojection for every sample
+    QVector<double>         geoKeys     = values.value(_tiffGeoKeyDirectory);
+    bool                    pixelIsArea = true;
+    bool                    geographic  = false;
+    for (int i=4; i+3<geoKeys.count(); i+=4) {
+        if (geoKeys[i] == _geoKeyModelType) {
+            geographic = geoKeys[i + 3] == _modelTypeGeographic;
+        } else if (geoKeys[i] == _geoKeyRasterType) {
+            pixelIsArea = geoKeys[i + 3] != _rasterPixelIsPoint;
+        }
+    }
+    QVector<double> scale       = values.value(_tiffModelPixelScale);
+    QVector<double> tiepoint    = values.value(_tiffModelTiepoint);
+    if (!geographic || scale.count() < 2 || tiepoint.count() < 6) {
+        errorString = QStringLiteral("GeoTIFF must be in latitude/longitude with a pixel scale and tie point");
+        return false;
+    }
+
+    _cols       = static_cast<int>(value(_tiffImageWidth, 0));
+    _rows       = static_cast<int>(value(_tiffImageLength, 0));
+    _lonSpacing = scale[0];
+    _latSpacing = scale[1];
+
+    // Positions are given for the pixel corner with PixelIsArea, samples are taken to be at the pixel center
+    double  half     = pixelIsArea ? 0.5 : 0;
+    double  northLat = tiepoint[4] - ((half - tiepoint[1]) * _latSpacing);
+    _west    = tiepoint[3] + ((half - tiepoint[0]) * _lonSpacing);
+    _south   = northLat - ((_rows - 1) * _latSpacing);
+
+    int     sampleBytes = bitsPerSample / 8;
+    bool    strips      = !values.contains(_tiffTileOffsets);
+    if (!strips) {
+        _blockCols      = static_cast<int>(value(_tiffTileWidth, 0));
+        _blockRows      = static_cast<int>(value(_tiffTileLength, 0));
+        _blocksAcross   = _blockCols > 0 ? (_cols + _blockCols - 1) / _blockCols : 0;
+    } else {
+        _blockCols      = _cols;
+        _blockRows      = qMin(static_cast<int>(value(_tiffRowsPerStrip, _rows)), _rows);
+        _blocksAcross   = 1;
+    }
+    QVector<double> offsets = values.value(strips ? _tiffStripOffsets : _tiffTileOffsets);
+    if (_blockRows <= 0 || _blockCols <= 0 || _rows <= 0) {
+        errorString = QStringLiteral("Bad GeoTIFF layout");
+        return false;
+    }
+    int blocksDown = (_rows + _blockRows - 1) / _blockRows;
+    if (offsets.count() < blocksDown * _blocksAcross) {
+        errorString = QStringLiteral("GeoTIFF is missing strip or tile offsets");
+        return false;
+    }
+
+    _blockOffsets.resize(blocksDown * _blocksAcross);
+    for (int i=0; i<_blockOffsets.count(); i++) {
+        // The last strip only holds the rows which are left, tiles are always whole
+        int     blockRows   = strips ? qMin(_blockRows, _rows - ((i / _blocksAcross) * _blockRows)) : _blockRows;
+        qint64  blockBytes  = static_cast<qint64>(blockRows) * _blockCols * sampleBytes;
+        _blockOffsets[i] = static_cast<qint64>(offsets[i]);
+        if (_blockOffsets[i] + blockBytes > _size) {
+            errorString = QStringLiteral("GeoTIFF strip or tile is past the end of the file");
+            return false;
+        }
+    }
+
+    if (!noDataText.isEmpty()) {
+        _noData = noDataText.replace('\0', "").trimmed().toDouble(&_hasNoData);
+    }
+    _format = FormatGeoTIFF;
+
+    return true;
+}
+
+qint64 TerrainDEMDataset::overviewBytes(void) const
+{
+    return static_cast<qint64>(_overviewMin.count() + _overviewMax.count()) * static_cast<qint64>(sizeof(float));
+}
+
+double TerrainDEMDataset::_sample(int row, int col) const
+{
+    qint64 offset;
+    if (_columnMajor) {
+        offset = _blockOffsets[0] + (col * _columnStride) + _dtedRecordHeader + (row * 2);
+    } else {
+        int fileRow = _rows - 1 - row;
+        int block   = ((fileRow / _blockRows) * _blocksAcross) + (col / _blockCols);
+        offset = _blockOffsets[block] + ((static_cast<qint64>(fileRow % _blockRows) * _blockCols) + (col % _blockCols)) * (_sampleType >= SampleFloat32BigEndian ? 4 : 2);
+    }
+
+    const uchar*    p = _data + offset;
+    double          height;
+    switch (_sampleType) {
+    case SampleInt16BigEndian:
+        height = static_cast<qint16>(_readUInt16(p, true));
+        break;
+    case SampleInt16LittleEndian:
+        height = static_cast<qint16>(_readUInt16(p, false));
+        break;
+    case SampleSignMagnitude16:
+    {
+        quint16 raw = _readUInt16(p, true);
+        height = raw & 0x8000 ? -static_cast<double>(raw & 0x7FFF) : raw;
+        break;
+    }
+    case SampleFloat32BigEndian:
+    case SampleFloat32LittleEndian:
+    {
+        quint32 bits = _readUInt32(p, _sampleType == SampleFloat32BigEndian);
+        float   value;
+        memcpy(&value, &bits, sizeof(value));
+        height = value;
+        break;
+    }
+    default:
+        return qQNaN();
+    }
+
+    if (_hasNoData && height == _noData) {
+        return qQNaN();
+    }
+    return height;
+}
+
+bool TerrainDEMDataset::contains(double latitude, double longitude) const
+{
+    return latitude >= _south - _edgeTolerance && latitude <= north() + _edgeTolerance &&
+            longitude >= _west - _edgeTolerance && longitude <= east() + _edgeTolerance;
+}
+
+double TerrainDEMDataset::elevation(double latitude, double longitude) const
+{
+    if (!contains(latitude, longitude)) {
+        return qQNaN();
+    }
+
+    double  y   = qBound(0.0, (latitude - _south) / _latSpacing, _rows - 1.0);
+    double  x   = qBound(0.0, (longitude - _west) / _lonSpacing, _cols - 1.0);
+    int     row = qMin(static_cast<int>(y), _rows - 2);
+    int     col = qMin(static_cast<int>(x), _cols - 2);
+    double  fy  = y - row;
+    double  fx  = x - col;
+
+    double sw = _sample(row, col);
+    double se = _sample(row, col + 1);
+    double nw = _sample(row + 1, col);
+    double ne = _sample(row + 1, col + 1);
+    if (qIsNaN(sw) || qIsNaN(se) || qIsNaN(nw) || qIsNaN(ne)) {
+        return qQNaN();
+    }
+
+    return (((sw * (1 - fx)) + (se * fx)) * (1 - fy)) + (((nw * (1 - fx)) + (ne * fx)) * fy);
+}
+
+void TerrainDEMDataset::_scanMinMax(int row0, int col0, int row1, int col1, double& minHeight, double& maxHeight) const
+{
+    for (int row=row0; row<=row1; row++) {
+        for (int col=col0; col<=col1; col++) {
+            double height = _sample(row, col);
+            if (!qIsNaN(height)) {
+                minHeight = qMin(minHeight, height);
+                maxHeight = qMax(maxHeight, height);
+            }
+        }
+    }
+}
+
+void TerrainDEMDataset::_blockMinMax(int blockRow, int blockCol, double& minHeight, double& maxHeight) const
+{
+    QMutexLocker    lock(&_overviewMutex);
+    int             index = (blockRow * _overviewCols) + blockCol;
+
+    if (qIsNaN(_overviewMin[index])) {
+        double blockMin = std::numeric_limits<double>::infinity();
+        double blockMax = -std::numeric_limits<double>::infinity();
+        _scanMinMax(blockRow * overviewBlockSize, blockCol * overviewBlockSize,
+                    qMin((blockRow + 1) * overviewBlockSize, _rows) - 1, qMin((blockCol + 1) * overviewBlockSize, _cols) - 1,
+                    blockMin, blockMax);
+        // A block which is all voids keeps infinite bounds, which still marks it as scanned
+        _overviewMin[index] = static_cast<float>(blockMin);
+        _overviewMax[index] = static_cast<float>(blockMax);
+    }
+
+    minHeight = qMin(minHeight, static_cast<double>(_overviewMin[index]));
+    maxHeight = qMax(maxHeight, static_cast<double>(_overviewMax[index]));
+}
+
+bool TerrainDEMDataset::minMax(double swLat, double swLon, double neLat, double neLon, double& minHeight, double& maxHeight) const
+{
+    if (!contains(swLat, swLon) || !contains(neLat, neLon) || swLat > neLat || swLon > neLon) {
+        return false;
+    }
+
+    // The samples around the area bound the interpolated surface inside it
+    int row0 = qBound(0, static_cast<int>(qFloor((swLat - _south) / _latSpacing)), _rows - 1);
+    int row1 = qBound(0, static_cast<int>(qCeil ((neLat - _south) / _latSpacing)), _rows - 1);
+    int col0 = qBound(0, static_cast<int>(qFloor((swLon - _west)  / _lonSpacing)), _cols - 1);
+    int col1 = qBound(0, static_cast<int>(qCeil ((neLon - _west)  / _lonSpacing)), _cols - 1);
+
+    minHeight = std::numeric_limits<double>::infinity();
+    maxHeight = -std::numeric_limits<double>::infinity();
+
+    for (int blockRow=row0 / overviewBlockSize; blockRow<=row1 / overviewBlockSize; blockRow++) {
+        int blockRow0 = blockRow * overviewBlockSize;
+        int blockRow1 = qMin(blockRow0 + overviewBlockSize, _rows) - 1;
+        for (int blockCol=col0 / overviewBlockSize; blockCol<=col1 / overviewBlockSize; blockCol++) {
+            int blockCol0 = blockCol * overviewBlockSize;
+            int blockCol1 = qMin(blockCol0 + overviewBlockSize, _cols) - 1;
+            if (blockRow0 >= row0 && blockRow1 <= row1 && blockCol0 >= col0 && blockCol1 <= col1) {
+                _blockMinMax(blockRow, blockCol, minHeight, maxHeight);
+            } else {
+                _scanMinMax(qMax(row0, blockRow0), qMax(col0, blockCol0), qMin(row1, blockRow1), qMin(col1, blockCol1), minHeight, maxHeight);
+            }
+        }
+    }
+
+    return minHeight <= maxHeight;
+}
+
+TerrainLocalDEM::TerrainLocalDEM(void)
+{
+    connect(&_watcher, &QFileSystemWatcher::directoryChanged, this, &TerrainLocalDEM::_rescan);
+
+    qgcApp()->toolbox()->memoryAccounting()->addSource(QStringLiteral("Local terrain overviews"), this, [this]() {
+        QReadLocker lock(&_lock);
+        qint64 bytes = 0;
+        for (const DatasetPtr& dataset: _datasets) {
+            bytes += dataset->overviewBytes();
+        }
+        return QGCMemoryAccounting::Usage_t{ _datasets.count(), bytes };
+    });
+}
+
+TerrainLocalDEM* TerrainLocalDEM::instance(void)
+{
+    return _terrainLocalDEM;
+}
+
+void TerrainLocalDEM::setDirectory(const QString& path)
+{
+    if (path == _directory) {
+        return;
+    }
+
+    if (!_watcher.directories().isEmpty()) {
+        _watcher.removePaths(_watcher.directories());
+    }
+    _directory = path;
+    if (!_directory.isEmpty() && QDir(_directory).exists()) {
+        _watcher.addPath(_directory);
+    }
+
+    _rescan();
+}
+
+int TerrainLocalDEM::datasetCount(void) const
+{
+    QReadLocker lock(&_lock);
+    return _datasets.count();
+}
+
+void TerrainLocalDEM::_rescan(void)
+{
+    QGC_TRACE_SCOPE("Terrain", "localDEMRescan");
+
+    QHash<QString, DatasetPtr> previous;
+    {
+        QReadLocker lock(&_lock);
+        for (const DatasetPtr& dataset: _datasets) {
+            previous[dataset->path()] = dataset;
+        }
+    }
+
+    // Datasets which are already mapped are kept as long as the file hasn't changed size
+    QList<DatasetPtr> datasets;
+    if (!_directory.isEmpty()) {
+        const QFileInfoList fileInfos = QDir(_directory).entryInfoList(fileNameFilters, QDir::Files | QDir::Readable);
+        for (const QFileInfo& fileInfo: fileInfos) {
+            DatasetPtr dataset = previous.value(fileInfo.absoluteFilePath());
+            if (dataset && QFileInfo(dataset->path()).size() == fileInfo.size()) {
+                datasets.append(dataset);
+                continue;
+            }
+
+            QString errorString;
+            dataset.reset(new TerrainDEMDataset);
+            if (dataset->open(fileInfo.absoluteFilePath(), errorString)) {
+                datasets.append(dataset);
+            } else {
+                qCWarning(TerrainLocalDEMLog) << "Skipping" << fileInfo.absoluteFilePath() << errorString;
+            }
+        }
+    }
+
+    std::stable_sort(datasets.begin(), datasets.end(), [](const DatasetPtr& a, const DatasetPtr& b) {
+        return a->latSpacing() < b->latSpacing();
+    });
+
+    // Edges which land on a whole degree reach into the next cell as well
+    QHash<qint32, QList<DatasetPtr>> cells;
+    for (const DatasetPtr& dataset: datasets) {
+        for (int lat=qMax(-90, qFloor(dataset->south() - _edgeTolerance)); lat<=qMin(89, qFloor(dataset->north() + _edgeTolerance)); lat++) {
+            for (int lon=qMax(-180, qFloor(dataset->west() - _edgeTolerance)); lon<=qMin(179, qFloor(dataset->east() + _edgeTolerance)); lon++) {
+                cells[_cellKey(lat, lon)].append(dataset);
+            }
+        }
+    }
+
+    bool changed;
+    {
+        QWriteLocker lock(&_lock);
+        changed = datasets != _datasets;
+        _datasets   = datasets;
+        _cells      = cells;
+    }
+
+    qCDebug(TerrainLocalDEMLog) << "Rescanned" << _directory << "datasets" << datasets.count();
+    if (changed) {
+        emit datasetsChanged();
+    }
+}
+
+bool TerrainLocalDEM::elevation(double latitude, double longitude, double& height) const
+{
+    bool found;
+    elevations(&latitude, &longitude, &height, &found, 1);
+    return found;
+}
+
+int TerrainLocalDEM::elevations(const double* latitudes, const double* longitudes, double* heights, bool* found, int count) const
+{
+    QReadLocker lock(&_lock);
+
+    int foundCount = 0;
+    for (int i=0; i<count; i++) {
+        found[i] = false;
+        if (_cells.isEmpty()) {
+            continue;
+        }
+
+        auto it = _cells.constFind(_cellKey(qBound(-90, qFloor(latitudes[i]), 89), qBound(-180, qFloor(longitudes[i]), 179)));
+        if (it == _cells.constEnd()) {
+            continue;
+        }
+        for (const DatasetPtr& dataset: *it) {
+            double height = dataset->elevation(latitudes[i], longitudes[i]);
+            if (!qIsNaN(height)) {
+                heights[i]  = height;
+                found[i]    = true;
+                foundCount++;
+                break;
+            }
+        }
+    }
+
+    return foundCount;
+}
+
+bool TerrainLocalDEM::covers(double swLat, double swLon, double neLat, double neLon) const
+{
+    QReadLocker lock(&_lock);
+
+    auto it = _cells.constFind(_cellKey(qBound(-90, qFloor(swLat), 89), qBound(-180, qFloor(swLon), 179)));
+    if (it == _cells.constEnd()) {
+        return false;
+    }
+    for (const DatasetPtr& dataset: *it) {
+        if (dataset->contains(swLat, swLon) && dataset->contains(neLat, neLon)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TerrainLocalDEM::minMax(double swLat, double swLon, double neLat, double neLon, double& minHeight, double& maxHeight) const
+{
+    QReadLocker lock(&_lock);
+
+    auto it = _cells.constFind(_cellKey(qBound(-90, qFloor(swLat), 89), qBound(-180, qFloor(swLon), 179)));
+    if (it == _cells.constEnd()) {
+        return false;
+    }
+    for (const DatasetPtr& dataset: *it) {
+        if (dataset->minMax(swLat, swLon, neLat, neLon, minHeight, maxHeight)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+TerrainLocalDEMQuery::TerrainLocalDEMQuery(QObject* parent)
+    : TerrainQueryInterface(parent)
+{
+
+}
+
+bool TerrainLocalDEMQuery::_heights(const QList<QGeoCoordinate>& coordinates, QList<double>& heights)
+{
+    int             count = coordinates.count();
+    QVector<double> latitudes(count);
+    QVector<double> longitudes(count);
+    QVector<double> values(count);
+    QVector<bool>   found(count);
+
+    for (int i=0; i<count; i++) {
+        latitudes[i]    = coordinates[i].latitude();
+        longitudes[i]   = coordinates[i].longitude();
+    }
+
+    if (TerrainLocalDEM::instance()->elevations(latitudes.constData(), longitudes.constData(), values.data(), found.data(), count) != count) {
+        return false;
+    }
+
+    heights.reserve(count);
+    for (double value: values) {
+        heights.append(value);
+    }
+    return true;
+}
+
+void TerrainLocalDEMQuery::requestCoordinateHeights(const QList<QGeoCoordinate>& coordinates)
+{
+    QList<double> heights;
+    bool success = _heights(coordinates, heights);
+    emit coordinateHeightsReceived(success, success ? heights : QList<double>());
+}
+
+void TerrainLocalDEMQuery::requestPathHeights(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord)
+{
+    double                  distanceBetween;
+    double                  finalDistanceBetween;
+    QList<QGeoCoordinate>   coordinates = TerrainTileManager::pathQueryToCoords(fromCoord, toCoord, distanceBetween, finalDistanceBetween);
+    QList<double>           heights;
+
+    bool success = _heights(coordinates, heights);
+    emit pathHeightsReceived(success, distanceBetween, finalDistanceBetween, success ? heights : QList<double>());
+}
+
+void TerrainLocalDEMQuery::requestCarpetHeights(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly)
+{
+    QGC_TRACE_SCOPE("Terrain", "localDEMCarpet");
+
+    if (swCoord.longitude() > neCoord.longitude() || swCoord.latitude() > neCoord.latitude()) {
+        qCWarning(TerrainLocalDEMLog) << "TerrainLocalDEMQuery::requestCarpetHeights: Internal Error - bad carpet coords";
+        emit carpetHeightsReceived(false, qQNaN(), qQNaN(), TerrainCarpet());
+        return;
+    }
+
+    double minHeight;
+    double maxHeight;
+    if (statsOnly && TerrainLocalDEM::instance()->minMax(swCoord.latitude(), swCoord.longitude(), neCoord.latitude(), neCoord.longitude(), minHeight, maxHeight)) {
+        emit carpetHeightsReceived(true, minHeight, maxHeight, TerrainCarpet());
+        return;
+    }
+
+    // Same grid as the carpets from the tiles, the work depends on the area and not the datasets under it
+    TerrainCarpet   carpet(swCoord, neCoord, TerrainTile::tileValueSpacingDegrees);
+    int             cols = carpet.cols();
+    QVector<double> latitudes(cols);
+    QVector<double> longitudes(cols);
+    QVector<bool>   found(cols);
+    double*         heights = carpet.data();
+
+    for (int col=0; col<cols; col++) {
+        longitudes[col] = carpet.longitude(col);
+    }
+
+    minHeight = std::numeric_limits<double>::infinity();
+    maxHeight = -std::numeric_limits<double>::infinity();
+    for (int row=0; row<carpet.rows(); row++) {
+        double* rowHeights = heights + (row * cols);
+
+        latitudes.fill(carpet.latitude(row));
+        if (TerrainLocalDEM::instance()->elevations(latitudes.constData(), longitudes.constData(), rowHeights, found.data(), cols) != cols) {
+            emit carpetHeightsReceived(false, qQNaN(), qQNaN(), TerrainCarpet());
+            return;
+        }
+        for (int col=0; col<cols; col++) {
+            minHeight = qMin(minHeight, rowHeights[col]);
+            maxHeight = qMax(maxHeight, rowHeights[col]);
+        }
+    }
+
+    emit carpetHeightsReceived(true, minHeight, maxHeight, statsOnly ? TerrainCarpet() : carpet);
+}
@@ -0,0 +1,188 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "TerrainQuery.h"
+
+#include <QFile>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QSharedPointer>
+#include <QVector>
+
+Q_DECLARE_LOGGING_CATEGORY(TerrainLocalDEMLog)
+
+/// A single local elevation dataset: an SRTM .hgt tile, a DTED level 0/1/2 cell or an uncompressed single band
+/// GeoTIFF in geographic coordinates. The file is memory mapped and samples are read in place, so a query only
+/// touches the pages under the points it asks for no matter how large the dataset is.
+///
+/// Each block of overviewBlockSize x overviewBlockSize samples has a min/max overview which is filled in the first
+/// time an area query covers the whole block. Area queries then only read samples along the edges of the area.
+class TerrainDEMDataset
+{
+public:
+    TerrainDEMDataset(void);
+    ~TerrainDEMDataset();
+
+    enum Format {
+        FormatHGT,
+        FormatDTED,
+        FormatGeoTIFF
+    };
+
+    /// Maps the file and reads its header, the samples themselves aren't read
+    bool open(const QString& path, QString& errorString);
+
+    QString path            (void) const { return _file.fileName(); }
+    Format  format          (void) const { return _format; }
+    double  south           (void) const { return _south; }
+    double  west            (void) const { return _west; }
+    double  north           (void) const { return _south + ((_rows - 1) * _latSpacing); }
+    double  east            (void) const { return _west + ((_cols - 1) * _lonSpacing); }
+    double  latSpacing      (void) const { return _latSpacing; }
+    double  lonSpacing      (void) const { return _lonSpacing; }
+    int     rows            (void) const { return _rows; }
+    int     cols            (void) const { return _cols; }
+    qint64  overviewBytes   (void) const;
+
+    bool contains(double latitude, double longitude) const;
+
+    /// Bilinear interpolation between the surrounding samples
+    /// @return NaN if the point is outside the dataset or next to a void sample
+    double elevation(double latitude, double longitude) const;
+
+    /// Min/max of the samples inside the area
+    /// @return false: Area isn't inside the dataset, or only has void samples
+    bool minMax(double swLat, double swLon, double neLat, double neLon, double& minHeight, double& maxHeight) const;
+
+    static const int overviewBlockSize = 64;
+
+private:
+    enum SampleType {
+        SampleInt16BigEndian,
+        SampleInt16LittleEndian,
+        SampleSignMagnitude16,              ///< DTED, big endian
+        SampleFloat32BigEndian,
+        SampleFloat32LittleEndian
+    };
+
+    bool    _openHGT        (QString& errorString);
+    bool    _openDTED       (QString& errorString);
+    bool    _openGeoTIFF    (QString& errorString);
+    double  _sample         (int row, int col) const;   ///< Row 0 is the southern edge. NaN for a void sample.
+    void    _scanMinMax     (int row0, int col0, int row1, int col1, double& minHeight, double& maxHeight) const;
+    void    _blockMinMax    (int blockRow, int blockCol, double& minHeight, double& maxHeight) const;
+
+    QFile                   _file;
+    const uchar*            _data =         nullptr;
+    qint64                  _size =         0;
+    Format                  _format =       FormatHGT;
+    SampleType              _sampleType =   SampleInt16BigEndian;
+    double                  _south =        0;          ///< Latitude of the southernmost row of samples
+    double                  _west =         0;          ///< Longitude of the westernmost column of samples
+    double                  _latSpacing =   0;
+    double                  _lonSpacing =   0;
+    int                     _rows =         0;
+    int                     _cols =         0;
+    bool                    _hasNoData =    false;
+    double                  _noData =       0;
+
+    // Samples live in blocks of _blockRows x _blockCols stored row by row from the north. A plain raster is a single
+    // block, GeoTIFF strips and tiles are one block each. DTED stores columns from the west instead, each a record
+    // holding the samples south to north, which _columnMajor switches to.
+    bool                    _columnMajor =  false;
+    int                     _blockRows =    0;
+    int                     _blockCols =    0;
+    int                     _blocksAcross = 1;
+    QVector<qint64>         _blockOffsets;
+    qint64                  _columnStride = 0;          ///< Bytes from one DTED record to the next
+
+    mutable QMutex          _overviewMutex;
+    mutable QVector<float>  _overviewMin;               ///< NaN until the block is scanned
+    mutable QVector<float>  _overviewMax;
+    int                     _overviewRows = 0;
+    int                     _overviewCols = 0;
+};
+
+/// All local elevation datasets in the terrain directory. Points covered by a local dataset are answered from it
+/// directly by TerrainTileManager, so TerrainAtCoordinateQuery, TerrainPathQuery and TerrainPolyPathQuery use it
+/// ahead of the AirMap tiles without any change to their callers. Points it doesn't cover, or which fall on a void,
+/// still go to the tiles.
+///
+/// Lookups are thread safe. Datasets are indexed by the one degree cells they cover, with the finest resolution
+/// dataset first, so the cost of a lookup doesn't depend on the number or size of the datasets.
+class TerrainLocalDEM : public QObject
+{
+    Q_OBJECT
+
+public:
+    TerrainLocalDEM(void);
+
+    static TerrainLocalDEM* instance(void);
+
+    /// Loads all the datasets in the directory and follows changes to it. An empty path drops all datasets.
+    void setDirectory(const QString& path);
+
+    QString directory       (void) const { return _directory; }
+    int     datasetCount    (void) const;
+
+    /// @return false: No local dataset has a value at the point
+    bool elevation(double latitude, double longitude, double& height) const;
+
+    /// Fills heights and sets found for each point a local dataset has a value at
+    /// @return Number of points found
+    int elevations(const double* latitudes, const double* longitudes, double* heights, bool* found, int count) const;
+
+    /// @return true: A single dataset covers the whole area, though it may still have voids in it
+    bool covers(double swLat, double swLon, double neLat, double neLon) const;
+
+    /// Min/max from the overviews of a single dataset covering the whole area
+    /// @return false: No single dataset covers the area
+    bool minMax(double swLat, double swLon, double neLat, double neLon, double& minHeight, double& maxHeight) const;
+
+    static const QStringList fileNameFilters;
+
+signals:
+    void datasetsChanged(void);
+
+private slots:
+    void _rescan(void);
+
+private:
+    typedef QSharedPointer<TerrainDEMDataset> DatasetPtr;
+
+    static qint32 _cellKey(int latitude, int longitude) { return (latitude + 90) * 360 + (longitude + 180); }
+
+    QString                             _directory;
+    QFileSystemWatcher                  _watcher;
+    mutable QReadWriteLock              _lock;
+    QList<DatasetPtr>                   _datasets;
+    QHash<qint32, QList<DatasetPtr>>    _cells;         ///< Finest resolution first
+};
+
+/// Answers terrain queries from local datasets only. A query which isn't fully covered by them fails.
+/// Results are signalled before the request returns.
+class TerrainLocalDEMQuery : public TerrainQueryInterface
+{
+    Q_OBJECT
+
+public:
+    TerrainLocalDEMQuery(QObject* parent = nullptr);
+
+    // Overrides from TerrainQueryInterface
+    void requestCoordinateHeights   (const QList<QGeoCoordinate>& coordinates) final;
+    void requestPathHeights         (const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord) final;
+    void requestCarpetHeights       (const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly) final;
+
+private:
+    bool _heights(const QList<QGeoCoordinate>& coordinates, QList<double>& heights);
+};
@@ -0,0 +1,294 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainLocalDEMTest.h"
+#include "TerrainLocalDEM.h"
+
+#include <QDataStream>
+#include <QTemporaryDir>
+
+void TerrainLocalDEMTest::init(void)
+{
+    UnitTest::init();
+
+    // Creates the tile manager first so it doesn't point the datasets back at the terrain directory later
+    bool error;
+    TerrainAtCoordinateQuery::getAltitudes(nullptr, nullptr, nullptr, 0, error);
+    _previousDirectory = TerrainLocalDEM::instance()->directory();
+    _tempDir = new QTemporaryDir;
+}
+
+void TerrainLocalDEMTest::cleanup(void)
+{
+    // Unmaps the test datasets before their directory goes away
+    TerrainLocalDEM::instance()->setDirectory(_previousDirectory);
+    delete _tempDir;
+    _tempDir = nullptr;
+
+    UnitTest::cleanup();
+}
+
+/// Square SRTM tile with elevation 100 + 10 * row + column counting from the south west corner, and a single void
+void TerrainLocalDEMTest::_writeHGT(const QString& path, int samples)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::BigEndian);
+    for (int row=samples - 1; row>=0; row--) {
+        for (int col=0; col<samples; col++) {
+            stream << static_cast<qint16>(row == _hgtVoidRow && col == _hgtVoidCol ? -32768 : 100 + (10 * row) + col);
+        }
+    }
+}
+
+/// 1 degree DTED cell at N47 W123 with elevation 10 * row + column - 50 from the south west corner
+void TerrainLocalDEMTest::_writeDTED(const QString& path, int samples)
+{
+    QByteArray uhl(80, ' ');
+    uhl.replace(0,  4,  "UHL1");
+    uhl.replace(4,  8,  "1230000W");
+    uhl.replace(12, 8,  "0470000N");
+    uhl.replace(20, 4,  QByteArray::number(36000 / (samples - 1)).rightJustified(4, '0'));
+    uhl.replace(24, 4,  QByteArray::number(36000 / (samples - 1)).rightJustified(4, '0'));
+    uhl.replace(47, 4,  QByteArray::number(samples).rightJustified(4, '0'));
+    uhl.replace(51, 4,  QByteArray::number(samples).rightJustified(4, '0'));
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(uhl);
+    file.write(QByteArray(648, ' '));
+    file.write(QByteArray(2700, ' '));
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::BigEndian);
+    for (int col=0; col<samples; col++) {
+        stream << static_cast<quint8>(0xAA) << static_cast<quint8>(0) << static_cast<quint16>(0) << static_cast<quint16>(col) << static_cast<quint16>(0);
+        for (int row=0; row<samples; row++) {
+            int height = (10 * row) + col - 50;
+            // Sign and magnitude rather than two's complement
+            stream << static_cast<quint16>(height < 0 ? 0x8000 | -height : height);
+        }
+        stream << static_cast<quint32>(0);
+    }
+}
+
+/// 4x3 little endian int16 GeoTIFF, a strip per row, with elevation 100 * row + column from the north west corner
+/// and the south east sample set to the no data value
+void TerrainLocalDEMTest::_writeGeoTIFF(const QString& path)
+{
+    const int       width           = 4;
+    const int       height          = 3;
+    const quint32   scaleOffset     = 8 + 2 + (12 * 12) + 4;
+    const quint32   tieOffset       = scaleOffset + (3 * 8);
+    const quint32   keysOffset      = tieOffset + (6 * 8);
+    const quint32   noDataOffset    = keysOffset + (12 * 2);
+    const quint32   stripsOffset    = noDataOffset + 6;
+    const quint32   imageOffset     = stripsOffset + (height * 4);
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData("II", 2);
+    stream << static_cast<quint16>(42) << static_cast<quint32>(8);
+
+    auto entry = [&stream](quint16 tag, quint16 type, quint32 count, quint32 value) {
+        stream << tag << type << count;
+        if (type == 3 && count == 1) {
+            stream << static_cast<quint16>(value) << static_cast<quint16>(0);
+        } else {
+            stream << value;
+        }
+    };
+    stream << static_cast<quint16>(12);
+    entry(256,      3,  1,      width);
+    entry(257,      3,  1,      height);
+    entry(258,      3,  1,      16);
+    entry(259,      3,  1,      1);
+    entry(273,      4,  height, stripsOffset);
+    entry(277,      3,  1,      1);
+    entry(278,      3,  1,      1);
+    entry(339,      3,  1,      2);
+    entry(33550,    12, 3,      scaleOffset);
+    entry(33922,    12, 6,      tieOffset);
+    entry(34735,    3,  12,     keysOffset);
+    entry(42113,    2,  6,      noDataOffset);
+    stream << static_cast<quint32>(0);
+
+    stream << 0.01 << 0.01 << 0.0;
+    stream << 0.0 << 0.0 << 0.0 << 8.5 << 47.5 << 0.0;
+    // Geographic model, PixelIsPoint
+    for (quint16 key: { 1, 1, 0, 2, 1024, 0, 1, 2, 1025, 0, 1, 2 }) {
+        stream << key;
+    }
+    stream.writeRawData("-9999", 6);
+    for (int row=0; row<height; row++) {
+        stream << static_cast<quint32>(imageOffset + (row * width * 2));
+    }
+    for (int row=0; row<height; row++) {
+        for (int col=0; col<width; col++) {
+            stream << static_cast<qint16>(row == height - 1 && col == width - 1 ? -9999 : (100 * row) + col);
+        }
+    }
+}
+
+void TerrainLocalDEMTest::_hgtTest(void)
+{
+    _writeHGT(_tempDir->filePath(QStringLiteral("N47W123.hgt")), _hgtSamples);
+
+    // Files which aren't datasets are skipped
+    QFile badFile(_tempDir->filePath(QStringLiteral("N48W123.hgt")));
+    QVERIFY(badFile.open(QIODevice::WriteOnly));
+    badFile.write("bad");
+    badFile.close();
+
+    TerrainLocalDEM* localDEM = TerrainLocalDEM::instance();
+    localDEM->setDirectory(_tempDir->path());
+    QCOMPARE(localDEM->datasetCount(), 1);
+
+    const double    spacing = 1.0 / (_hgtSamples - 1);
+    double          height;
+    QVERIFY(localDEM->elevation(47, -123, height));
+    QVERIFY(qAbs(height - 100) < 1e-6);
+    QVERIFY(localDEM->elevation(47 + (2.5 * spacing), -123 + (0.5 * spacing), height));
+    QVERIFY(qAbs(height - 125.5) < 1e-6);
+    QVERIFY(localDEM->elevation(48, -122, height));
+    QVERIFY(qAbs(height - (100 + (10 * (_hgtSamples - 1)) + (_hgtSamples - 1))) < 1e-6);
+
+    // Void and outside
+    QVERIFY(!localDEM->elevation(47 + (_hgtVoidRow * spacing), -123 + (_hgtVoidCol * spacing), height));
+    QVERIFY(!localDEM->elevation(46.9, -123, height));
+    QVERIFY(!localDEM->elevation(47.5, -121.5, height));
+}
+
+void TerrainLocalDEMTest::_dtedTest(void)
+{
+    _writeDTED(_tempDir->filePath(QStringLiteral("n47.dt1")), _hgtSamples);
+
+    TerrainLocalDEM* localDEM = TerrainLocalDEM::instance();
+    localDEM->setDirectory(_tempDir->path());
+    QCOMPARE(localDEM->datasetCount(), 1);
+
+    const double    spacing = 1.0 / (_hgtSamples - 1);
+    double          height;
+    QVERIFY(localDEM->elevation(47, -123, height));
+    QVERIFY(qAbs(height - -50) < 1e-6);
+    QVERIFY(localDEM->elevation(47 + (3 * spacing), -123 + (1.5 * spacing), height));
+    QVERIFY(qAbs(height - -18.5) < 1e-6);
+    QVERIFY(!localDEM->elevation(48.1, -123, height));
+}
+
+void TerrainLocalDEMTest::_geoTiffTest(void)
+{
+    _writeGeoTIFF(_tempDir->filePath(QStringLiteral("dem.tif")));
+
+    TerrainLocalDEM* localDEM = TerrainLocalDEM::instance();
+    localDEM->setDirectory(_tempDir->path());
+    QCOMPARE(localDEM->datasetCount(), 1);
+
+    double height;
+    QVERIFY(localDEM->elevation(47.5, 8.5, height));
+    QVERIFY(qAbs(height) < 1e-6);
+    QVERIFY(localDEM->elevation(47.49, 8.51, height));
+    QVERIFY(qAbs(height - 101) < 1e-6);
+    QVERIFY(localDEM->elevation(47.495, 8.505, height));
+    QVERIFY(qAbs(height - 50.5) < 1e-6);
+
+    // Next to the no data sample
+    QVERIFY(!localDEM->elevation(47.485, 8.525, height));
+    QVERIFY(!localDEM->elevation(47.51, 8.5, height));
+}
+
+void TerrainLocalDEMTest::_minMaxTest(void)
+{
+    _writeHGT(_tempDir->filePath(QStringLiteral("N47W123.hgt")), _hgtSamples);
+
+    TerrainLocalDEM* localDEM = TerrainLocalDEM::instance();
+    localDEM->setDirectory(_tempDir->path());
+
+    // Covers the first overview block whole and part of the others, the samples around the area count
+    const double    spacing = 1.0 / (_hgtSamples - 1);
+    double          minHeight;
+    double          maxHeight;
+    QVERIFY(localDEM->minMax(47, -123, 47 + (100.5 * spacing), -123 + (80.5 * spacing), minHeight, maxHeight));
+    QCOMPARE(minHeight, 100.0);
+    QCOMPARE(maxHeight, 100.0 + (10 * 101) + 81);
+
+    // Second time round the overview is used
+    QVERIFY(localDEM->minMax(47, -123, 47 + (100.5 * spacing), -123 + (80.5 * spacing), minHeight, maxHeight));
+    QCOMPARE(maxHeight, 100.0 + (10 * 101) + 81);
+
+    QVERIFY(localDEM->minMax(47 + (10.5 * spacing), -123 + (20.5 * spacing), 47 + (11.5 * spacing), -123 + (21.5 * spacing), minHeight, maxHeight));
+    QCOMPARE(minHeight, 100.0 + (10 * 10) + 20);
+    QCOMPARE(maxHeight, 100.0 + (10 * 12) + 22);
+
+    // Not covered by a single dataset
+    QVERIFY(!localDEM->minMax(46.5, -123, 47.5, -122.5, minHeight, maxHeight));
+}
+
+void TerrainLocalDEMTest::_carpetTest(void)
+{
+    _writeHGT(_tempDir->filePath(QStringLiteral("N47W123.hgt")), _hgtSamples);
+    TerrainLocalDEM::instance()->setDirectory(_tempDir->path());
+
+    const double            spacing     = 1.0 / (_hgtSamples - 1);
+    bool                    success     = false;
+    double                  minHeight   = 0;
+    double                  maxHeight   = 0;
+    TerrainCarpet           carpet;
+    TerrainLocalDEMQuery    query;
+    connect(&query, &TerrainQueryInterface::carpetHeightsReceived, this, [&](bool carpetSuccess, double carpetMin, double carpetMax, const TerrainCarpet& carpetHeights) {
+        success     = carpetSuccess;
+        minHeight   = carpetMin;
+        maxHeight   = carpetMax;
+        carpet      = carpetHeights;
+    });
+
+    QGeoCoordinate sw(47, -123);
+    QGeoCoordinate ne(47 + (2 * spacing), -123 + (2 * spacing));
+    query.requestCarpetHeights(sw, ne, false /* statsOnly */);
+    QVERIFY(success);
+    QVERIFY(carpet.rows() > 1);
+    QCOMPARE(carpet.cols(), carpet.rows());
+    QCOMPARE(carpet.latitude(carpet.rows() - 1), ne.latitude());
+    QVERIFY(qAbs(carpet.height(0, 0) - 100) < 1e-6);
+    QVERIFY(qAbs(carpet.height(carpet.rows() - 1, carpet.cols() - 1) - 122) < 1e-6);
+    QVERIFY(qAbs(minHeight - 100) < 1e-6);
+    QVERIFY(qAbs(maxHeight - 122) < 1e-6);
+
+    query.requestCarpetHeights(sw, ne, true /* statsOnly */);
+    QVERIFY(success);
+    QVERIFY(carpet.isEmpty());
+    QCOMPARE(minHeight, 100.0);
+
+    // Partly outside the dataset
+    query.requestCarpetHeights(QGeoCoordinate(46.99, -123), ne, false /* statsOnly */);
+    QVERIFY(!success);
+}
+
+void TerrainLocalDEMTest::_getAltitudesTest(void)
+{
+    _writeHGT(_tempDir->filePath(QStringLiteral("N47W123.hgt")), _hgtSamples);
+    TerrainLocalDEM::instance()->setDirectory(_tempDir->path());
+
+    // Answered right away without any tiles
+    const double    spacing         = 1.0 / (_hgtSamples - 1);
+    double          latitudes[]     = { 47, 47 + spacing, 47.25 + (0.5 * spacing) };
+    double          longitudes[]    = { -123, -123 + spacing, -122.75 };
+    double          heights[3];
+    bool            error;
+    QVERIFY(TerrainAtCoordinateQuery::getAltitudes(latitudes, longitudes, heights, 3, error));
+    QVERIFY(!error);
+    QVERIFY(qAbs(heights[0] - 100) < 1e-6);
+    QVERIFY(qAbs(heights[1] - 111) < 1e-6);
+    QVERIFY(qAbs(heights[2] - (100 + (10 * 30.5) + 30)) < 1e-6);
+}
@@ -0,0 +1,43 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class QTemporaryDir;
+
+class TerrainLocalDEMTest : public UnitTest
+{
+    Q_OBJECT
+
+protected:
+    void init   (void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _hgtTest           (void);
+    void _dtedTest          (void);
+    void _geoTiffTest       (void);
+    void _minMaxTest        (void);
+    void _carpetTest        (void);
+    void _getAltitudesTest  (void);
+
+private:
+    void _writeHGT      (const QString& path, int samples);
+    void _writeDTED     (const QString& path, int samples);
+    void _writeGeoTIFF  (const QString& path);
+
+    QString         _previousDirectory;
+    QTemporaryDir*  _tempDir = nullptr;     ///< Outlives the datasets mapped from it
+
+    static const int _hgtSamples = 121;     ///< 30 arc-second spacing, two overview blocks across
+    static const int _hgtVoidRow = 60;
+    static const int _hgtVoidCol = 60;
+};
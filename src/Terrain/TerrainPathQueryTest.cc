@@ -0,0 +1,111 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainPathQueryTest.h"
+#include "TerrainQuery.h"
+#include "FlightPathSegment.h"
+
+#include <QSignalSpy>
+
+void TerrainPathQueryTest::_keyTest(void)
+{
+    QGeoCoordinate from (47.397, 8.545);
+    QGeoCoordinate to   (47.398, 8.546);
+
+    // Below the quantum
+    QVERIFY(TerrainPathKey(from, to, 30) == TerrainPathKey(QGeoCoordinate(47.397 + 1e-9, 8.545), to, 30));
+    QCOMPARE(qHash(TerrainPathKey(from, to, 30)), qHash(TerrainPathKey(QGeoCoordinate(47.397 + 1e-9, 8.545), to, 30)));
+
+    QVERIFY(TerrainPathKey(from, to, 30) != TerrainPathKey(QGeoCoordinate(47.397 + 1e-5, 8.545), to, 30));
+    QVERIFY(TerrainPathKey(from, to, 30) != TerrainPathKey(to, from, 30));
+    QVERIFY(TerrainPathKey(from, to, 30) != TerrainPathKey(from, to, 10));
+}
+
+void TerrainPathQueryTest::_cacheTest(void)
+{
+    QGeoCoordinate from = UnitTestTerrainQuery::flat10Region.center();
+    QGeoCoordinate to   = from.atDistanceAndAzimuth(500, 45);
+
+    TerrainPathQuery::PathHeightInfo_t  pathHeightInfo;
+    TerrainPathQuery                    pathQuery(false /* autoDelete */);
+    QSignalSpy                          spy(&pathQuery, &TerrainPathQuery::terrainDataReceived);
+
+    pathQuery.requestData(from, to);
+    if (spy.count() == 0) {
+        QVERIFY(spy.wait(1000));
+    }
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(spy[0][0].toBool());
+    TerrainPathQuery::PathHeightInfo_t queried = spy[0][1].value<TerrainPathQuery::PathHeightInfo_t>();
+    QVERIFY(queried.heights.count() > 2);
+
+    // Now known without a query
+    QVERIFY(TerrainPathQuery::getCachedPathHeights(from, to, pathHeightInfo));
+    QCOMPARE(pathHeightInfo.heights, queried.heights);
+    QCOMPARE(pathHeightInfo.distanceBetween, queried.distanceBetween);
+    QCOMPARE(pathHeightInfo.finalDistanceBetween, queried.finalDistanceBetween);
+
+    // Another query of the same path gets the same result right away
+    TerrainPathQuery    otherPathQuery(false /* autoDelete */);
+    QSignalSpy          otherSpy(&otherPathQuery, &TerrainPathQuery::terrainDataReceived);
+    otherPathQuery.requestData(from, to);
+    QCOMPARE(otherSpy.count(), 1);
+    QVERIFY(otherSpy[0][0].toBool());
+    QCOMPARE(otherSpy[0][1].value<TerrainPathQuery::PathHeightInfo_t>().heights, queried.heights);
+
+    // The reverse path is another path
+    QVERIFY(!TerrainPathQuery::getCachedPathHeights(to, from, pathHeightInfo));
+}
+
+void TerrainPathQueryTest::_failureTest(void)
+{
+    // No unit test terrain this far from Point Nemo
+    QGeoCoordinate from (47.397, 8.545);
+    QGeoCoordinate to   (47.398, 8.546);
+
+    TerrainPathQuery pathQuery(false /* autoDelete */);
+    QSignalSpy       spy(&pathQuery, &TerrainPathQuery::terrainDataReceived);
+
+    pathQuery.requestData(from, to);
+    if (spy.count() == 0) {
+        QVERIFY(spy.wait(1000));
+    }
+    QVERIFY(!spy[0][0].toBool());
+
+    TerrainPathQuery::PathHeightInfo_t pathHeightInfo;
+    QVERIFY(!TerrainPathQuery::getCachedPathHeights(from, to, pathHeightInfo));
+}
+
+void TerrainPathQueryTest::_collisionTest(void)
+{
+    // 10m spacing, final spacing 5m: x = 0, 10, 20, 30, 35
+    const double heights[] = { 0, 0, 0, 0, 0 };
+
+    // Level path at 10m above flat terrain
+    QVERIFY(!FlightPathSegment::pathCollides(heights, 5, 10, 5, 35, 10, 10));
+
+    // Path which ends in the ground
+    QVERIFY(FlightPathSegment::pathCollides(heights, 5, 10, 5, 35, 10, -1));
+
+    // Single peak under the path, 30m along a climb from 0 to 35m is at 30m
+    const double peak[] = { -1, -1, -1, 31, -1 };
+    QVERIFY(FlightPathSegment::pathCollides(peak, 5, 10, 5, 35, 0, 35));
+    const double lowPeak[] = { -1, -1, -1, 29, -1 };
+    QVERIFY(!FlightPathSegment::pathCollides(lowPeak, 5, 10, 5, 35, 0, 35));
+
+    // The final spacing applies to the last height only
+    const double lastPeak[] = { -1, -1, -1, -1, 34 };
+    QVERIFY(!FlightPathSegment::pathCollides(lastPeak, 5, 10, 5, 35, 0, 35));
+    QVERIFY(!FlightPathSegment::pathCollides(lastPeak, 5, 10, 10, 35, 0, 35));
+    QVERIFY(FlightPathSegment::pathCollides(lastPeak, 5, 10, 1, 35, 0, 35));
+
+    // Unknown altitudes never collide
+    QVERIFY(!FlightPathSegment::pathCollides(heights, 5, 10, 5, 35, qQNaN(), 10));
+    QVERIFY(!FlightPathSegment::pathCollides(heights, 0, 10, 5, 35, -10, -10));
+}
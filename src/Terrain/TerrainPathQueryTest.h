@@ -0,0 +1,24 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for the path heights shared between TerrainPathQuery instances
+class TerrainPathQueryTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _keyTest           (void);
+    void _cacheTest         (void);
+    void _failureTest       (void);
+    void _collisionTest     (void);
+};
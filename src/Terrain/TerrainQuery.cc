@@ -8,29 +8,72 @@
  ****************************************************************************/
 
 #include "TerrainQuery.h"
+#include "TerrainLocalDEM.h"
 #include "QGCMapEngine.h"
 #include "QGeoMapReplyQGC.h"
 #include "QGCApplication.h"
+#include "QGCMemoryAccounting.h"
+#include "QGCNetworkService.h"
+#include "QGCTrace.h"
+#include "QGroundControlQmlGlobal.h"
+#include "SettingsManager.h"
 
 #include <QUrl>
 #include <QUrlQuery>
 #include <QNetworkRequest>
-#include <QNetworkProxy>
 #include <QNetworkReply>
 #include <QSslConfiguration>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QTimer>
+#include <QtMath>
 #include <QtLocation/private/qgeotilespec_p.h>
+#include <QtConcurrent>
+#include <QThreadPool>
 
 #include <cmath>
+#include <limits>
 
 QGC_LOGGING_CATEGORY(TerrainQueryLog, "TerrainQueryLog")
 QGC_LOGGING_CATEGORY(TerrainQueryVerboseLog, "TerrainQueryVerboseLog")
 
 Q_GLOBAL_STATIC(TerrainAtCoordinateBatchManager, _TerrainAtCoordinateBatchManager)
 Q_GLOBAL_STATIC(TerrainTileManager, _terrainTileManager)
+Q_GLOBAL_STATIC(TerrainPathQueryCache, _terrainPathQueryCache)
+
+TerrainCarpet::TerrainCarpet(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, double spacingDegrees, bool withHeights)
+    : _swLat(swCoord.latitude())
+    , _swLon(swCoord.longitude())
+{
+    double latSpan = neCoord.latitude() - swCoord.latitude();
+    double lonSpan = neCoord.longitude() - swCoord.longitude();
+
+    _rows       = qMax(0, qCeil((latSpan / spacingDegrees) - 1e-9)) + 1;
+    _cols       = qMax(0, qCeil((lonSpan / spacingDegrees) - 1e-9)) + 1;
+    _latStep    = _rows > 1 ? latSpan / (_rows - 1) : 0;
+    _lonStep    = _cols > 1 ? lonSpan / (_cols - 1) : 0;
+    if (withHeights) {
+        _heights.fill(qQNaN(), _rows * _cols);
+    }
+}
+
+bool TerrainCarpet::appendRow(const QList<double>& row)
+{
+    if (_rows == 0) {
+        _cols = row.count();
+    } else if (row.count() != _cols) {
+        return false;
+    }
+
+    _heights.reserve(_heights.count() + row.count());
+    for (double height: row) {
+        _heights.append(height);
+    }
+    _rows++;
+
+    return true;
+}
 
 TerrainAirMapQuery::TerrainAirMapQuery(QObject* parent)
     : TerrainQueryInterface(parent)
@@ -107,17 +150,20 @@ void TerrainAirMapQuery::_sendQuery(const QString& path, const QUrlQuery& urlQue
     qCDebug(TerrainQueryLog) << "_sendQuery" << url;
     url.setQuery(urlQuery);
 
+    if (!qgcApp()->toolbox()->networkService()->requestAllowed(url)) {
+        qCDebug(TerrainQueryLog) << "_sendQuery skipped, internet not available";
+        _requestFailed();
+        return;
+    }
+
     QNetworkRequest request(url);
 
     QSslConfiguration sslConf = request.sslConfiguration();
     sslConf.setPeerVerifyMode(QSslSocket::VerifyNone);
     request.setSslConfiguration(sslConf);
+    QGCNetworkService::setConsumer(request, QGCNetworkService::consumerTerrain);
 
-    QNetworkProxy tProxy;
-    tProxy.setType(QNetworkProxy::DefaultProxy);
-    _networkManager.setProxy(tProxy);
-
-    QNetworkReply* networkReply = _networkManager.get(request);
+    QNetworkReply* networkReply = qgcApp()->toolbox()->networkService()->networkAccessManager()->get(request);
     if (!networkReply) {
         qCWarning(TerrainQueryLog) << "QNetworkManager::Get did not return QNetworkReply";
         _requestFailed();
@@ -159,6 +205,8 @@ void TerrainAirMapQuery::_sslErrors(const QList<QSslError> &errors)
 
 void TerrainAirMapQuery::_requestFinished(void)
 {
+    QGC_TRACE_SCOPE("Terrain", "airMapRequestFinished");
+
     QNetworkReply* reply = qobject_cast<QNetworkReply*>(QObject::sender());
 
     if (reply->error() != QNetworkReply::NoError) {
@@ -215,7 +263,7 @@ void TerrainAirMapQuery::_requestFailed(void)
         emit pathHeightsReceived(false /* success */, qQNaN() /* latStep */, qQNaN() /* lonStep */, QList<double>() /* heights */);
         break;
     case QueryModeCarpet:
-        emit carpetHeightsReceived(false /* success */, qQNaN() /* minHeight */, qQNaN() /* maxHeight */, QList<QList<double>>() /* carpet */);
+        emit carpetHeightsReceived(false /* success */, qQNaN() /* minHeight */, qQNaN() /* maxHeight */, TerrainCarpet() /* carpet */);
         break;
     }
 }
@@ -256,17 +304,22 @@ void TerrainAirMapQuery::_parseCarpetData(const QJsonValue& carpetJson)
     double      minHeight =     statsObject["min"].toDouble();
     double      maxHeight =     statsObject["max"].toDouble();
 
-    QList<QList<double>> carpet;
+    TerrainCarpet carpet;
     if (!_carpetStatsOnly) {
         QJsonArray carpetArray =   jsonObject["carpet"].toArray();
 
         for (int i=0; i<carpetArray.count(); i++) {
-            QJsonArray rowArray = carpetArray[i].toArray();
-            carpet.append(QList<double>());
+            QJsonArray      rowArray = carpetArray[i].toArray();
+            QList<double>   row;
 
             for (int j=0; j<rowArray.count(); j++) {
                 double height = rowArray[j].toDouble();
-                carpet.last().append(height);
+                row.append(height);
+            }
+            if (!carpet.appendRow(row)) {
+                qCWarning(TerrainQueryLog) << "TerrainAirMapQuery::_parseCarpetData: rows of different lengths";
+                emit carpetHeightsReceived(false /* success */, qQNaN() /* minHeight */, qQNaN() /* maxHeight */, TerrainCarpet() /* carpet */);
+                return;
             }
         }
     }
@@ -311,11 +364,7 @@ void TerrainOfflineAirMapQuery::requestCarpetHeights(const QGeoCoordinate& swCoo
         return;
     }
 
-    // TODO
-    Q_UNUSED(swCoord);
-    Q_UNUSED(neCoord);
-    Q_UNUSED(statsOnly);
-    qWarning() << "Carpet queries are currently not supported from offline air map data";
+    _terrainTileManager->addCarpetQuery(this, swCoord, neCoord, statsOnly);
 }
 
 void TerrainOfflineAirMapQuery::_signalCoordinateHeights(bool success, QList<double> heights)
@@ -328,18 +377,34 @@ void TerrainOfflineAirMapQuery::_signalPathHeights(bool success, double distance
     emit pathHeightsReceived(success, distanceBetween, finalDistanceBetween, heights);
 }
 
-void TerrainOfflineAirMapQuery::_signalCarpetHeights(bool success, double minHeight, double maxHeight, const QList<QList<double>>& carpet)
+void TerrainOfflineAirMapQuery::_signalCarpetHeights(bool success, double minHeight, double maxHeight, const TerrainCarpet& carpet)
 {
     emit carpetHeightsReceived(success, minHeight, maxHeight, carpet);
 }
 
 TerrainTileManager::TerrainTileManager(void)
+    : _elevationMapId           (getQGCMapEngine()->urlFactory()->getIdFromType("Airmap Elevation"))
+    , _elevationProviderIndex   (getQGCMapEngine()->urlFactory()->getProviderIndex("Airmap Elevation"))
 {
-
+    _tiles.setMaxCost(_maxMemoryTiles);
+
+    qgcApp()->toolbox()->memoryAccounting()->addSource(QStringLiteral("Terrain tiles"), this, [this]() {
+        QMutexLocker lock(&_tilesMutex);
+        qint64 count = _tiles.count();
+        return QGCMemoryAccounting::Usage_t{ count, count * _estimatedTileBytes };
+    });
+
+    // Local datasets answer the points they cover ahead of the tiles
+    AppSettings* appSettings = qgcApp()->toolbox()->settingsManager()->appSettings();
+    TerrainLocalDEM::instance()->setDirectory(appSettings->terrainSavePath());
+    connect(appSettings, &AppSettings::savePathsChanged, this, [appSettings]() {
+        TerrainLocalDEM::instance()->setDirectory(appSettings->terrainSavePath());
+    });
 }
 
 void TerrainTileManager::addCoordinateQuery(TerrainOfflineAirMapQuery* terrainQueryInterface, const QList<QGeoCoordinate>& coordinates)
 {
+    QGC_TRACE_SCOPE_ARG("Terrain", "addCoordinateQuery", "coordinates", coordinates.count());
     qCDebug(TerrainQueryLog) << "TerrainTileManager::addCoordinateQuery count" << coordinates.count();
 
     if (coordinates.length() > 0) {
@@ -398,6 +463,8 @@ QList<QGeoCoordinate> TerrainTileManager::pathQueryToCoords(const QGeoCoordinate
 
 void TerrainTileManager::addPathQuery(TerrainOfflineAirMapQuery* terrainQueryInterface, const QGeoCoordinate &startPoint, const QGeoCoordinate &endPoint)
 {
+    QGC_TRACE_SCOPE("Terrain", "addPathQuery");
+
     QList<QGeoCoordinate> coordinates;
     double distanceBetween;
     double finalDistanceBetween;
@@ -423,108 +490,507 @@ void TerrainTileManager::addPathQuery(TerrainOfflineAirMapQuery* terrainQueryInt
     }
 }
 
+void TerrainTileManager::addCarpetQuery(TerrainOfflineAirMapQuery* terrainQueryInterface, const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly)
+{
+    QGC_TRACE_SCOPE("Terrain", "addCarpetQuery");
+
+    if (swCoord.longitude() > neCoord.longitude() || swCoord.latitude() > neCoord.latitude()) {
+        qCWarning(TerrainQueryLog) << "TerrainTileManager::addCarpetQuery: Internal Error - bad carpet coords";
+        terrainQueryInterface->_signalCarpetHeights(false, qQNaN(), qQNaN(), TerrainCarpet());
+        return;
+    }
+
+    // A single local dataset under the whole area has the min/max in its overviews
+    double minHeight;
+    double maxHeight;
+    if (statsOnly && TerrainLocalDEM::instance()->minMax(swCoord.latitude(), swCoord.longitude(), neCoord.latitude(), neCoord.longitude(), minHeight, maxHeight)) {
+        terrainQueryInterface->_signalCarpetHeights(true, minHeight, maxHeight, TerrainCarpet());
+        return;
+    }
+
+    bool            error;
+    TerrainCarpet   carpet;
+    if (!_carpetHeights(swCoord, neCoord, statsOnly, carpet, minHeight, maxHeight, error)) {
+        qCDebug(TerrainQueryLog) << "TerrainTileManager::addCarpetQuery queue count" << _requestQueue.count();
+        QueuedRequestInfo_t queuedRequestInfo = { terrainQueryInterface, QueryMode::QueryModeCarpet, 0, 0, { swCoord, neCoord }, statsOnly };
+        _requestQueue.append(queuedRequestInfo);
+        return;
+    }
+
+    terrainQueryInterface->_signalCarpetHeights(!error, minHeight, maxHeight, carpet);
+}
+
+/// Builds the carpet once every tile under it is in memory, otherwise queues the missing tiles
+///     @param[out] error true: carpet not returned due to error, false: carpet returned
+/// @return true: carpet returned (check error as well), false: tiles queued (carpet not returned)
+bool TerrainTileManager::_carpetHeights(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly, TerrainCarpet& carpet, double& minHeight, double& maxHeight, bool& error)
+{
+    QGC_TRACE_SCOPE("Terrain", "carpetHeights");
+
+    error = false;
+
+    // Workers read copies of the tiles, which share the elevation data with the cached ones. That way the lock isn't
+    // held while they run and the cache is free to drop tiles in the meantime.
+    QHash<QGCTileKey, TerrainTile> tiles;
+    {
+        QMutexLocker lock(&_tilesMutex);
+
+        int tileX0 = _tileX(swCoord.longitude());
+        int tileX1 = _tileX(neCoord.longitude());
+        int tileY0 = _tileY(swCoord.latitude());
+        int tileY1 = _tileY(neCoord.latitude());
+        if ((tileX1 - tileX0 + 1) * (tileY1 - tileY0 + 1) > _maxCarpetTiles) {
+            qCWarning(TerrainQueryLog) << "TerrainTileManager::_carpetHeights: Area too large for the tiles in memory" << swCoord << neCoord;
+            error = true;
+            return true;
+        }
+
+        bool missingTiles = false;
+        for (int tileY=tileY0; tileY<=tileY1; tileY++) {
+            for (int tileX=tileX0; tileX<=tileX1; tileX++) {
+                // Tiles under a local dataset are never read
+                double tileSouth    = (tileY * TerrainTile::tileSizeDegrees) - 90.0;
+                double tileWest     = (tileX * TerrainTile::tileSizeDegrees) - 180.0;
+                if (TerrainLocalDEM::instance()->covers(tileSouth, tileWest, tileSouth + TerrainTile::tileSizeDegrees, tileWest + TerrainTile::tileSizeDegrees)) {
+                    continue;
+                }
+
+                const TerrainTile* tile = _tiles.object(_tileKey(tileX, tileY));
+                if (tile) {
+                    tiles.insert(_tileKey(tileX, tileY), *tile);
+                } else {
+                    _queueTile(tileX, tileY);
+                    missingTiles = true;
+                }
+            }
+        }
+        if (missingTiles) {
+            _startDownloads();
+            return false;
+        }
+    }
+
+    // Each worker takes a band of rows and reduces the min/max of its band while filling it
+    carpet = TerrainCarpet(swCoord, neCoord, TerrainTile::tileValueSpacingDegrees, !statsOnly);
+
+    double*                         heights     = statsOnly ? nullptr : carpet.data();
+    int                             chunkRows   = qMax(_minCarpetChunkRows, qCeil(carpet.rows() / static_cast<double>(QThreadPool::globalInstance()->maxThreadCount())));
+    QList<QFuture<CarpetRows_t>>    futures;
+    for (int rowStart=0; rowStart<carpet.rows(); rowStart+=chunkRows) {
+        futures.append(QtConcurrent::run(this, &TerrainTileManager::_carpetRows, &carpet, heights, &tiles, rowStart, qMin(rowStart + chunkRows, carpet.rows())));
+    }
+
+    bool complete = true;
+    minHeight = std::numeric_limits<double>::infinity();
+    maxHeight = -std::numeric_limits<double>::infinity();
+    for (const QFuture<CarpetRows_t>& future: futures) {
+        CarpetRows_t rows = future.result();
+        minHeight   = qMin(minHeight, rows.minHeight);
+        maxHeight   = qMax(maxHeight, rows.maxHeight);
+        complete    &= rows.complete;
+    }
+
+    if (!complete) {
+        qCWarning(TerrainQueryLog) << "TerrainTileManager::_carpetHeights: Internal Error - missing elevation under carpet";
+        error = true;
+    }
+    qCDebug(TerrainQueryLog) << "TerrainTileManager::_carpetHeights rows:cols:workers" << carpet.rows() << carpet.cols() << futures.count();
+
+    return true;
+}
+
+/// Fills rows [rowStart, rowEnd) of the carpet, on a worker thread
+///     @param heights Carpet heights, nullptr to only work out the min/max
+TerrainTileManager::CarpetRows_t TerrainTileManager::_carpetRows(const TerrainCarpet* carpet, double* heights, const QHash<QGCTileKey, TerrainTile>* tiles, int rowStart, int rowEnd) const
+{
+    CarpetRows_t    result = { std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), true };
+    int             cols = carpet->cols();
+    QVector<double> latitudes(cols);
+    QVector<double> longitudes(cols);
+    QVector<double> scratch(heights ? 0 : cols);
+    QVector<bool>   local(cols);
+
+    for (int col=0; col<cols; col++) {
+        longitudes[col] = carpet->longitude(col);
+    }
+
+    for (int row=rowStart; row<rowEnd && result.complete; row++) {
+        double* rowHeights = heights ? heights + (row * cols) : scratch.data();
+
+        latitudes.fill(carpet->latitude(row));
+        TerrainLocalDEM::instance()->elevations(latitudes.constData(), longitudes.constData(), rowHeights, local.data(), cols);
+
+        // Same as getAltitudes, each run of points in the same tile is evaluated together
+        int tileY       = _tileY(carpet->latitude(row));
+        int runStart    = 0;
+        while (runStart < cols) {
+            if (local[runStart]) {
+                runStart++;
+                continue;
+            }
+            int tileX   = _tileX(longitudes[runStart]);
+            int runEnd  = runStart + 1;
+            while (runEnd < cols && !local[runEnd] && _tileX(longitudes[runEnd]) == tileX) {
+                runEnd++;
+            }
+
+            auto tile = tiles->constFind(_tileKey(tileX, tileY));
+            if (tile == tiles->constEnd()) {
+                result.complete = false;
+                break;
+            }
+            tile->elevations(latitudes.constData() + runStart, longitudes.constData() + runStart, rowHeights + runStart, runEnd - runStart);
+            runStart = runEnd;
+        }
+
+        for (int col=0; col<cols; col++) {
+            if (qIsNaN(rowHeights[col])) {
+                result.complete = false;
+                break;
+            }
+            result.minHeight = qMin(result.minHeight, rowHeights[col]);
+            result.maxHeight = qMax(result.maxHeight, rowHeights[col]);
+        }
+    }
+
+    return result;
+}
+
 /// Either returns altitudes from cache or queues database request
 ///     @param[out] error true: altitude not returned due to error, false: altitudes returned
 /// @return true: altitude returned (check error as well), false: database query queued (altitudes not returned)
 bool TerrainTileManager::getAltitudesForCoordinates(const QList<QGeoCoordinate>& coordinates, QList<double>& altitudes, bool& error)
+{
+    int             count = coordinates.count();
+    QVector<double> latitudes(count);
+    QVector<double> longitudes(count);
+    QVector<double> heights(count);
+
+    for (int i=0; i<count; i++) {
+        latitudes[i]    = coordinates[i].latitude();
+        longitudes[i]   = coordinates[i].longitude();
+    }
+
+    if (!getAltitudes(latitudes.constData(), longitudes.constData(), heights.data(), count, error)) {
+        return false;
+    }
+
+    altitudes.reserve(altitudes.count() + count);
+    for (double height: heights) {
+        altitudes.push_back(height);
+    }
+
+    return true;
+}
+
+/// Same as getAltitudesForCoordinates for points held in separate latitude and longitude arrays
+///     @param[out] heights Must have room for count values
+bool TerrainTileManager::getAltitudes(const double* latitudes, const double* longitudes, double* heights, int count, bool& error)
 {
     error = false;
+    bool missingTiles = false;
 
-    for (const QGeoCoordinate& coordinate: coordinates) {
-        QString tileHash = _getTileHash(coordinate);
-        qCDebug(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates hash:coordinate" << tileHash << coordinate;
+    // Points covered by a local dataset never need a tile
+    QVector<bool> local(count);
+    if (TerrainLocalDEM::instance()->elevations(latitudes, longitudes, heights, local.data(), count) == count) {
+        return true;
+    }
+
+    QMutexLocker lock(&_tilesMutex);
 
-        _tilesMutex.lock();
-        if (_tiles.contains(tileHash)) {
-            double elevation = _tiles[tileHash].elevation(coordinate);
-            if (qIsNaN(elevation)) {
+    // Neighbouring points almost always share a tile, so each run of points in the same tile is evaluated together
+    int runStart = 0;
+    while (runStart < count) {
+        if (local[runStart]) {
+            runStart++;
+            continue;
+        }
+        int tileX   = _tileX(longitudes[runStart]);
+        int tileY   = _tileY(latitudes[runStart]);
+        int runEnd  = runStart + 1;
+        while (runEnd < count && !local[runEnd] && _tileX(longitudes[runEnd]) == tileX && _tileY(latitudes[runEnd]) == tileY) {
+            runEnd++;
+        }
+
+        const TerrainTile* tile = _tiles.object(_tileKey(tileX, tileY));
+        if (!tile) {
+            // Keep going so every missing tile for this query is queued up front and can be fetched in parallel
+            qCDebug(TerrainQueryLog) << "TerrainTileManager::getAltitudes tile not in memory x:y" << tileX << tileY;
+            _queueTile(tileX, tileY);
+            missingTiles = true;
+            runStart = runEnd;
+            continue;
+        }
+
+        tile->elevations(latitudes + runStart, longitudes + runStart, heights + runStart, runEnd - runStart);
+        for (int i=runStart; i<runEnd; i++) {
+            if (qIsNaN(heights[i])) {
                 error = true;
-                qCWarning(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates Internal Error: missing elevation in tile cache";
-            } else {
-                qCDebug(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates returning elevation from tile cache" << elevation;
+                qCWarning(TerrainQueryLog) << "TerrainTileManager::getAltitudes Internal Error: missing elevation in tile cache";
+                break;
             }
-            altitudes.push_back(elevation);
-        } else {
-            if (_state != State::Downloading) {
-                QNetworkRequest request = getQGCMapEngine()->urlFactory()->getTileURL("Airmap Elevation", getQGCMapEngine()->urlFactory()->long2tileX("Airmap Elevation",coordinate.longitude(), 1), getQGCMapEngine()->urlFactory()->lat2tileY("Airmap Elevation", coordinate.latitude(), 1), 1, &_networkManager);
-                qCDebug(TerrainQueryLog) << "TerrainTileManager::getAltitudesForCoordinates query from database" << request.url();
-                QGeoTileSpec spec;
-                spec.setX(getQGCMapEngine()->urlFactory()->long2tileX("Airmap Elevation", coordinate.longitude(), 1));
-                spec.setY(getQGCMapEngine()->urlFactory()->lat2tileY("Airmap Elevation", coordinate.latitude(), 1));
-                spec.setZoom(1);
-                spec.setMapId(getQGCMapEngine()->urlFactory()->getIdFromType("Airmap Elevation"));
-                QGeoTiledMapReplyQGC* reply = new QGeoTiledMapReplyQGC(&_networkManager, request, spec);
-                connect(reply, &QGeoTiledMapReplyQGC::terrainDone, this, &TerrainTileManager::_terrainDone);
-                _state = State::Downloading;
+        }
+
+        runStart = runEnd;
+    }
+
+    if (missingTiles) {
+        error = false;
+        _startDownloads();
+        return false;
+    }
+
+    return true;
+}
+
+/// Queues the tiles under the corridor which aren't in memory yet. Nothing waits on them, _terrainDone just keeps them.
+int TerrainTileManager::prefetchPath(const QList<QGeoCoordinate>& path, double corridorMeters)
+{
+    QList<QPoint>   tiles   = corridorTiles(path, corridorMeters, _maxPrefetchTiles);
+    int             missing = 0;
+
+    QMutexLocker lock(&_tilesMutex);
+
+    for (const QPoint& tile: tiles) {
+        if (!_tiles.contains(_tileKey(tile.x(), tile.y()))) {
+            _queueTile(tile.x(), tile.y());
+            missing++;
+        }
+    }
+    _startDownloads();
+
+    qCDebug(TerrainQueryLog) << "TerrainTileManager::prefetchPath tiles:missing" << tiles.count() << missing;
+    return missing;
+}
+
+QList<QPoint> TerrainTileManager::corridorTiles(const QList<QGeoCoordinate>& path, double corridorMeters, int maxTiles)
+{
+    const double    metersPerDegree = 111320.0;
+    const double    minSampleMeters = 100;      // Tiles are ~1km, less than that towards the poles
+    const double    maxSampleMeters = 500;
+
+    QList<QPoint>   tiles;
+    QSet<quint64>   seen;
+
+    // Adds the tiles under a box reaching corridorMeters out from the coordinate, false once maxTiles is reached
+    auto addBox = [&](const QGeoCoordinate& coord) -> bool {
+        double latDelta = corridorMeters / metersPerDegree;
+        double lonDelta = corridorMeters / (metersPerDegree * qMax(0.01, qCos(qDegreesToRadians(coord.latitude()))));
+
+        for (int tileY = _tileY(coord.latitude() - latDelta); tileY <= _tileY(coord.latitude() + latDelta); tileY++) {
+            for (int tileX = _tileX(coord.longitude() - lonDelta); tileX <= _tileX(coord.longitude() + lonDelta); tileX++) {
+                quint64 key = (static_cast<quint64>(static_cast<quint32>(tileX)) << 32) | static_cast<quint32>(tileY);
+                if (seen.contains(key)) {
+                    continue;
+                }
+                if (tiles.count() >= maxTiles) {
+                    return false;
+                }
+                seen.insert(key);
+                tiles.append(QPoint(tileX, tileY));
             }
-            _tilesMutex.unlock();
+        }
+        return true;
+    };
 
-            return false;
+    // Samples are no further apart than the corridor reaches out, so the boxes around them leave no gaps
+    double sampleMeters = qBound(minSampleMeters, corridorMeters, maxSampleMeters);
+
+    for (int i=0; i<path.count(); i++) {
+        if (i == 0) {
+            if (!addBox(path[i])) {
+                break;
+            }
+            continue;
+        }
+
+        double  distance    = path[i - 1].distanceTo(path[i]);
+        double  azimuth     = path[i - 1].azimuthTo(path[i]);
+        int     samples     = qMax(1, static_cast<int>(ceil(distance / sampleMeters)));
+        bool    full        = false;
+        for (int sample=1; sample<=samples && !full; sample++) {
+            full = !addBox(path[i - 1].atDistanceAndAzimuth(distance * sample / samples, azimuth));
+        }
+        if (full) {
+            break;
         }
-        _tilesMutex.unlock();
     }
 
-    return true;
+    return tiles;
+}
+
+/// Tile x/y calculations match AirmapElevationProvider, done here to stay clear of the map provider lookups for each point
+int TerrainTileManager::_tileX(double longitude)
+{
+    return static_cast<int>(floor((longitude + 180.0) / TerrainTile::tileSizeDegrees));
+}
+
+int TerrainTileManager::_tileY(double latitude)
+{
+    return static_cast<int>(floor((latitude + 90.0) / TerrainTile::tileSizeDegrees));
+}
+
+int TerrainTileManager::_maxConcurrentDownloads(void)
+{
+    return qMax(1, qgcApp()->toolbox()->settingsManager()->offlineMapsSettings()->maxTerrainDownloads()->rawValue().toInt());
 }
 
-void TerrainTileManager::_tileFailed(void)
+/// Adds the tile to the download queue unless it is already queued or being downloaded.
+/// Must be called with _tilesMutex locked
+void TerrainTileManager::_queueTile(int tileX, int tileY)
+{
+    QGCTileKey key = _tileKey(tileX, tileY);
+
+    if (!_downloadingTiles.contains(key) && !_pendingTiles.contains(key)) {
+        _pendingTiles.append(key);
+    }
+}
+
+/// Returns the index of the pending tile closest to the current map position, so what the user is looking at fills in first.
+/// Must be called with _tilesMutex locked
+int TerrainTileManager::_nextPendingTileIndex(void) const
+{
+    QGeoCoordinate  mapPosition = QGroundControlQmlGlobal::flightMapPosition();
+    int             centerX     = _tileX(mapPosition.longitude());
+    int             centerY     = _tileY(mapPosition.latitude());
+    int             bestIndex   = 0;
+    qint64          bestDistance = std::numeric_limits<qint64>::max();
+
+    for (int i=0; i<_pendingTiles.count(); i++) {
+        qint64 dx       = _pendingTiles[i].x() - centerX;
+        qint64 dy       = _pendingTiles[i].y() - centerY;
+        qint64 distance = dx * dx + dy * dy;
+        if (distance < bestDistance) {
+            bestDistance    = distance;
+            bestIndex       = i;
+        }
+    }
+
+    return bestIndex;
+}
+
+/// Fills the free download slots from the pending tiles.
+/// Must be called with _tilesMutex locked
+void TerrainTileManager::_startDownloads(void)
+{
+    int maxDownloads = _maxConcurrentDownloads();
+
+    while (!_pendingTiles.isEmpty() && _downloadingTiles.count() < maxDownloads) {
+        QGCTileKey key = _pendingTiles.takeAt(_nextPendingTileIndex());
+        _downloadingTiles.insert(key);
+        _requestTile(key.x(), key.y());
+    }
+}
+
+/// Must be called with _tilesMutex locked
+void TerrainTileManager::_requestTile(int tileX, int tileY)
+{
+    QNetworkAccessManager*  networkManager  = qgcApp()->toolbox()->networkService()->networkAccessManager();
+    QNetworkRequest         request         = getQGCMapEngine()->urlFactory()->getTileURL("Airmap Elevation", tileX, tileY, 1, networkManager);
+    QGCNetworkService::setConsumer(request, QGCNetworkService::consumerTerrain);
+    qCDebug(TerrainQueryLog) << "TerrainTileManager::_requestTile query from database" << request.url();
+    QGeoTileSpec spec;
+    spec.setX(tileX);
+    spec.setY(tileY);
+    spec.setZoom(1);
+    spec.setMapId(_elevationMapId);
+    QGeoTiledMapReplyQGC* reply = new QGeoTiledMapReplyQGC(networkManager, request, spec);
+    connect(reply, &QGeoTiledMapReplyQGC::terrainDone, this, &TerrainTileManager::_terrainDone);
+}
+
+bool TerrainTileManager::_requestNeedsTile(const QueuedRequestInfo_t& requestInfo, const QGCTileKey& key) const
+{
+    if (requestInfo.queryMode == QueryMode::QueryModeCarpet) {
+        const QGeoCoordinate& swCoord = requestInfo.coordinates[0];
+        const QGeoCoordinate& neCoord = requestInfo.coordinates[1];
+        return key.x() >= _tileX(swCoord.longitude()) && key.x() <= _tileX(neCoord.longitude()) &&
+                key.y() >= _tileY(swCoord.latitude()) && key.y() <= _tileY(neCoord.latitude());
+    }
+    for (const QGeoCoordinate& coordinate: requestInfo.coordinates) {
+        if (_tileX(coordinate.longitude()) == key.x() && _tileY(coordinate.latitude()) == key.y()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Fails only the queued requests which needed this tile, the others are still waiting on their own downloads
+void TerrainTileManager::_tileFailed(const QGCTileKey& key)
 {
     QList<double>    noAltitudes;
 
-    for (const QueuedRequestInfo_t& requestInfo: _requestQueue) {
+    for (int i = _requestQueue.count() - 1; i >= 0; i--) {
+        const QueuedRequestInfo_t requestInfo = _requestQueue[i];
+        if (!_requestNeedsTile(requestInfo, key)) {
+            continue;
+        }
+        _requestQueue.removeAt(i);
         if (requestInfo.queryMode == QueryMode::QueryModeCoordinates) {
             requestInfo.terrainQueryInterface->_signalCoordinateHeights(false, noAltitudes);
         } else if (requestInfo.queryMode == QueryMode::QueryModePath) {
             requestInfo.terrainQueryInterface->_signalPathHeights(false, requestInfo.distanceBetween, requestInfo.finalDistanceBetween, noAltitudes);
+        } else if (requestInfo.queryMode == QueryMode::QueryModeCarpet) {
+            requestInfo.terrainQueryInterface->_signalCarpetHeights(false, qQNaN(), qQNaN(), TerrainCarpet());
         }
     }
-    _requestQueue.clear();
 }
 
 void TerrainTileManager::_terrainDone(QByteArray responseBytes, QNetworkReply::NetworkError error)
 {
+    QGC_TRACE_SCOPE_ARG("Terrain", "terrainDone", "bytes", responseBytes.size());
+
     QGeoTiledMapReplyQGC* reply = qobject_cast<QGeoTiledMapReplyQGC*>(QObject::sender());
-    _state = State::Idle;
 
     if (!reply) {
         qCWarning(TerrainQueryLog) << "Elevation tile fetched but invalid reply data type.";
         return;
     }
+    reply->deleteLater();
 
     // remove from download queue
-    QGeoTileSpec spec = reply->tileSpec();
-    QString hash = QGCMapEngine::getTileHash("Airmap Elevation", spec.x(), spec.y(), spec.zoom());
+    QGeoTileSpec    spec    = reply->tileSpec();
+    QGCTileKey      key     = _tileKey(spec.x(), spec.y());
+    TerrainTile*    terrainTile = nullptr;
 
     // handle potential errors
     if (error != QNetworkReply::NoError) {
         qCWarning(TerrainQueryLog) << "Elevation tile fetching returned error (" << error << ")";
-        _tileFailed();
-        reply->deleteLater();
-        return;
-    }
-    if (responseBytes.isEmpty()) {
+    } else if (responseBytes.isEmpty()) {
         qCWarning(TerrainQueryLog) << "Error in fetching elevation tile. Empty response.";
-        _tileFailed();
-        reply->deleteLater();
-        return;
+    } else {
+        qCDebug(TerrainQueryLog) << "Received some bytes of terrain data: " << responseBytes.size();
+        terrainTile = new TerrainTile(responseBytes);
+        if (!terrainTile->isValid()) {
+            qCWarning(TerrainQueryLog) << "Received invalid tile";
+            delete terrainTile;
+            terrainTile = nullptr;
+        }
     }
 
-    qCDebug(TerrainQueryLog) << "Received some bytes of terrain data: " << responseBytes.size();
-
-    TerrainTile* terrainTile = new TerrainTile(responseBytes);
-    if (terrainTile->isValid()) {
-        _tilesMutex.lock();
-        if (!_tiles.contains(hash)) {
-            _tiles.insert(hash, *terrainTile);
+    _tilesMutex.lock();
+    _downloadingTiles.remove(key);
+    if (terrainTile) {
+        if (!_tiles.contains(key)) {
+            _tiles.insert(key, terrainTile);
         } else {
             delete terrainTile;
         }
-        _tilesMutex.unlock();
-    } else {
-        delete terrainTile;
-        qCWarning(TerrainQueryLog) << "Received invalid tile";
     }
-    reply->deleteLater();
+    _startDownloads();
+    _tilesMutex.unlock();
+
+    if (!terrainTile) {
+        _tileFailed(key);
+        return;
+    }
+
+    _signalQueuedRequests();
+}
+
+/// Signals all queued requests which now have all of their tiles
+void TerrainTileManager::_signalQueuedRequests(void)
+{
+    QGC_TRACE_SCOPE_ARG("Terrain", "signalQueuedRequests", "requests", _requestQueue.count());
 
     // now try to query the data again
     for (int i = _requestQueue.count() - 1; i >= 0; i--) {
@@ -532,6 +998,19 @@ void TerrainTileManager::_terrainDone(QByteArray responseBytes, QNetworkReply::N
         QList<double> altitudes;
         QueuedRequestInfo_t& requestInfo = _requestQueue[i];
 
+        if (requestInfo.queryMode == QueryMode::QueryModeCarpet) {
+            TerrainCarpet   carpet;
+            double          minHeight;
+            double          maxHeight;
+            if (_carpetHeights(requestInfo.coordinates[0], requestInfo.coordinates[1], requestInfo.statsOnly, carpet, minHeight, maxHeight, error)) {
+                // Signalling can queue more requests, so the request is taken out first
+                TerrainOfflineAirMapQuery* terrainQueryInterface = requestInfo.terrainQueryInterface;
+                _requestQueue.removeAt(i);
+                terrainQueryInterface->_signalCarpetHeights(!error, minHeight, maxHeight, carpet);
+            }
+            continue;
+        }
+
         if (getAltitudesForCoordinates(requestInfo.coordinates, altitudes, error)) {
             if (requestInfo.queryMode == QueryMode::QueryModeCoordinates) {
                 if (error) {
@@ -557,18 +1036,6 @@ void TerrainTileManager::_terrainDone(QByteArray responseBytes, QNetworkReply::N
     }
 }
 
-QString TerrainTileManager::_getTileHash(const QGeoCoordinate& coordinate)
-{
-    QString ret = QGCMapEngine::getTileHash(
-        "Airmap Elevation",
-        getQGCMapEngine()->urlFactory()->long2tileX("Airmap Elevation", coordinate.longitude(), 1),
-        getQGCMapEngine()->urlFactory()->lat2tileY("Airmap Elevation", coordinate.latitude(), 1),
-        1);
-    qCDebug(TerrainQueryVerboseLog) << "Computing unique tile hash for " << coordinate << ret;
-
-    return ret;
-}
-
 TerrainAtCoordinateBatchManager::TerrainAtCoordinateBatchManager(void)
 {
     _batchTimer.setSingleShot(true);
@@ -591,6 +1058,7 @@ void TerrainAtCoordinateBatchManager::addQuery(TerrainAtCoordinateQuery* terrain
 
 void TerrainAtCoordinateBatchManager::_sendNextBatch(void)
 {
+    QGC_TRACE_SCOPE("Terrain", "sendNextBatch");
     qCDebug(TerrainQueryLog) << "TerrainAtCoordinateBatchManager::_sendNextBatch _state:_requestQueue.count:_sentRequests.count" << _stateToString(_state) << _requestQueue.count() << _sentRequests.count();
 
     if (_state != State::Idle) {
@@ -723,6 +1191,16 @@ bool TerrainAtCoordinateQuery::getAltitudesForCoordinates(const QList<QGeoCoordi
     return _terrainTileManager->getAltitudesForCoordinates(coordinates, altitudes, error);
 }
 
+int TerrainAtCoordinateQuery::prefetchPath(const QList<QGeoCoordinate>& path, double corridorMeters)
+{
+    return _terrainTileManager->prefetchPath(path, corridorMeters);
+}
+
+bool TerrainAtCoordinateQuery::getAltitudes(const double* latitudes, const double* longitudes, double* heights, int count, bool& error)
+{
+    return _terrainTileManager->getAltitudes(latitudes, longitudes, heights, count, error);
+}
+
 void TerrainAtCoordinateQuery::_signalTerrainData(bool success, QList<double>& heights)
 {
     emit terrainDataReceived(success, heights);
@@ -735,26 +1213,114 @@ TerrainPathQuery::TerrainPathQuery(bool autoDelete)
    : _autoDelete   (autoDelete)
 {
     qRegisterMetaType<PathHeightInfo_t>();
-    connect(&_terrainQuery, &TerrainQueryInterface::pathHeightsReceived, this, &TerrainPathQuery::_pathHeights);
 }
 
 void TerrainPathQuery::requestData(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord)
 {
-    _terrainQuery.requestPathHeights(fromCoord, toCoord);
+    _terrainPathQueryCache->addQuery(this, fromCoord, toCoord);
 }
 
-void TerrainPathQuery::_pathHeights(bool success, double distanceBetween, double finalDistanceBetween, const QList<double>& heights)
+bool TerrainPathQuery::getCachedPathHeights(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, PathHeightInfo_t& pathHeightInfo)
+{
+    return _terrainPathQueryCache->cachedPathHeights(fromCoord, toCoord, pathHeightInfo);
+}
+
+void TerrainPathQuery::_signalTerrainData(bool success, const PathHeightInfo_t& pathHeightInfo)
 {
-    PathHeightInfo_t pathHeightInfo;
-    pathHeightInfo.distanceBetween =        distanceBetween;
-    pathHeightInfo.finalDistanceBetween =   finalDistanceBetween;
-    pathHeightInfo.heights =                heights;
     emit terrainDataReceived(success, pathHeightInfo);
     if (_autoDelete) {
         deleteLater();
     }
 }
 
+TerrainPathKey::TerrainPathKey(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, double spacingMeters)
+{
+    _values[0] = qRound(fromCoord.latitude()    / quantumDegrees);
+    _values[1] = qRound(fromCoord.longitude()   / quantumDegrees);
+    _values[2] = qRound(toCoord.latitude()      / quantumDegrees);
+    _values[3] = qRound(toCoord.longitude()     / quantumDegrees);
+    _values[4] = qRound(spacingMeters * 100);
+}
+
+bool TerrainPathKey::operator==(const TerrainPathKey& other) const
+{
+    for (int i=0; i<5; i++) {
+        if (_values[i] != other._values[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TerrainPathQueryCache::TerrainPathQueryCache(void)
+    : _paths(_maxCachedHeights)
+{
+    qgcApp()->toolbox()->memoryAccounting()->addSource(QStringLiteral("Terrain path heights"), this, [this]() {
+        return QGCMemoryAccounting::Usage_t{ _paths.count(), static_cast<qint64>(_paths.totalCost()) * static_cast<qint64>(sizeof(double)) };
+    });
+
+    // Heights taken with and without a local dataset differ
+    connect(TerrainLocalDEM::instance(), &TerrainLocalDEM::datasetsChanged, this, [this]() { _paths.clear(); });
+}
+
+bool TerrainPathQueryCache::cachedPathHeights(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, TerrainPathQuery::PathHeightInfo_t& pathHeightInfo)
+{
+    TerrainPathQuery::PathHeightInfo_t* cachedPathHeightInfo = _paths.object(TerrainPathKey(fromCoord, toCoord, TerrainTile::tileValueSpacingMeters));
+    if (cachedPathHeightInfo) {
+        pathHeightInfo = *cachedPathHeightInfo;
+        return true;
+    }
+    return false;
+}
+
+void TerrainPathQueryCache::addQuery(TerrainPathQuery* pathQuery, const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord)
+{
+    TerrainPathKey key(fromCoord, toCoord, TerrainTile::tileValueSpacingMeters);
+
+    TerrainPathQuery::PathHeightInfo_t pathHeightInfo;
+    if (cachedPathHeights(fromCoord, toCoord, pathHeightInfo)) {
+        qCDebug(TerrainQueryVerboseLog) << "TerrainPathQueryCache::addQuery cached" << fromCoord << toCoord;
+        pathQuery->_signalTerrainData(true /* success */, pathHeightInfo);
+        return;
+    }
+
+    if (_pending.contains(key)) {
+        qCDebug(TerrainQueryVerboseLog) << "TerrainPathQueryCache::addQuery waiting on pending query" << fromCoord << toCoord;
+        _pending[key].pathQueries.append(pathQuery);
+        return;
+    }
+
+    // The result may come back right away, so the pending entry must be there before the request goes out
+    TerrainOfflineAirMapQuery* terrainQuery = new TerrainOfflineAirMapQuery(this);
+    PendingPath_t pendingPath = { terrainQuery, { pathQuery } };
+    _pending[key] = pendingPath;
+    connect(terrainQuery, &TerrainQueryInterface::pathHeightsReceived, this, [this, key](bool success, double distanceBetween, double finalDistanceBetween, const QList<double>& heights) {
+        _pathHeights(key, success, distanceBetween, finalDistanceBetween, heights);
+    });
+    terrainQuery->requestPathHeights(fromCoord, toCoord);
+}
+
+void TerrainPathQueryCache::_pathHeights(const TerrainPathKey& key, bool success, double distanceBetween, double finalDistanceBetween, const QList<double>& heights)
+{
+    PendingPath_t pendingPath = _pending.take(key);
+    pendingPath.terrainQuery->deleteLater();
+
+    TerrainPathQuery::PathHeightInfo_t pathHeightInfo;
+    pathHeightInfo.distanceBetween =        distanceBetween;
+    pathHeightInfo.finalDistanceBetween =   finalDistanceBetween;
+    pathHeightInfo.heights =                heights;
+
+    if (success) {
+        _paths.insert(key, new TerrainPathQuery::PathHeightInfo_t(pathHeightInfo), heights.count() + 1);
+    }
+
+    for (const QPointer<TerrainPathQuery>& pathQuery: pendingPath.pathQueries) {
+        if (pathQuery) {
+            pathQuery->_signalTerrainData(success, pathHeightInfo);
+        }
+    }
+}
+
 TerrainPolyPathQuery::TerrainPolyPathQuery(bool autoDelete)
     : _autoDelete   (autoDelete)
     , _pathQuery    (false /* autoDelete */)
@@ -849,33 +1415,37 @@ void UnitTestTerrainQuery::requestPathHeights(const QGeoCoordinate& fromCoord, c
     );
 }
 
-void UnitTestTerrainQuery::requestCarpetHeights(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool) {
-    QList<QList<double>> carpet;
+void UnitTestTerrainQuery::requestCarpetHeights(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly) {
+    TerrainQueryInterface* terrainQuery = qobject_cast<TerrainQueryInterface*>(parent());
 
     if (swCoord.longitude() > neCoord.longitude() || swCoord.latitude() > neCoord.latitude()) {
         qCWarning(TerrainQueryLog) << "UnitTestTerrainQuery::requestCarpetHeights: Internal Error - bad carpet coords";
-        emit qobject_cast<TerrainQueryInterface*>(parent())->carpetHeightsReceived(false, qQNaN(), qQNaN(), carpet);
+        emit terrainQuery->carpetHeightsReceived(false, qQNaN(), qQNaN(), TerrainCarpet());
         return;
     }
 
-    double min = std::numeric_limits<double>::max();
-    double max = std::numeric_limits<double>::min();
-    for (double lat = swCoord.latitude(); lat < neCoord.latitude(); lat++) {
-        QGeoCoordinate fromCoord(lat, swCoord.longitude());
-        QGeoCoordinate toCoord  (lat, neCoord.longitude());
+    TerrainCarpet   carpet(swCoord, neCoord, TerrainTile::tileValueSpacingDegrees);
+    double*         heights = carpet.data();
+    double          min     = std::numeric_limits<double>::max();
+    double          max     = std::numeric_limits<double>::lowest();
+    for (int row=0; row<carpet.rows(); row++) {
+        QList<QGeoCoordinate> coordinates;
+        for (int col=0; col<carpet.cols(); col++) {
+            coordinates.append(QGeoCoordinate(carpet.latitude(row), carpet.longitude(col)));
+        }
 
-        QList<double> row = _requestPathHeights(fromCoord, toCoord).rgHeights;
-        if (row.size() == 0) {
-            emit carpetHeightsReceived(false, qQNaN(), qQNaN(), QList<QList<double>>());
+        QList<double> rowHeights = _requestCoordinateHeights(coordinates);
+        if (rowHeights.size() != carpet.cols()) {
+            emit terrainQuery->carpetHeightsReceived(false, qQNaN(), qQNaN(), TerrainCarpet());
             return;
         }
-        for (const auto val : row) {
-            min = qMin(val, min);
-            max = qMax(val, max);
+        for (int col=0; col<carpet.cols(); col++) {
+            min = qMin(rowHeights[col], min);
+            max = qMax(rowHeights[col], max);
+            heights[(row * carpet.cols()) + col] = rowHeights[col];
         }
-        carpet.append(row);
     }
-    emit qobject_cast<TerrainQueryInterface*>(parent())->carpetHeightsReceived(true, min, max, carpet);
+    emit terrainQuery->carpetHeightsReceived(true, min, max, statsOnly ? TerrainCarpet() : carpet);
 }
 
 UnitTestTerrainQuery::PathHeightInfo_t UnitTestTerrainQuery::_requestPathHeights(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord)
@@ -19,6 +19,12 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QTimer>
+#include <QCache>
+#include <QHash>
+#include <QPointer>
+#include <QSet>
+#include <QPoint>
+#include <QVector>
 #include <QtLocation/private/qgeotiledmapreply_p.h>
 
 Q_DECLARE_LOGGING_CATEGORY(TerrainQueryLog)
@@ -26,6 +32,42 @@ Q_DECLARE_LOGGING_CATEGORY(TerrainQueryVerboseLog)
 
 class TerrainAtCoordinateQuery;
 
+/// Terrain heights on a regular grid, held row by row from the south west corner in a single buffer
+class TerrainCarpet
+{
+public:
+    TerrainCarpet(void) { }
+
+    /// Grid covering the area with samples at most spacingDegrees apart, including both edges. Heights start out NaN.
+    ///     @param withHeights false: Only the grid, for going over the area without keeping the heights
+    TerrainCarpet(const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, double spacingDegrees, bool withHeights = true);
+
+    /// Adds a row to a carpet built up from rows of heights, the grid has no coordinates then
+    /// @return false: Row is not the same length as the first one
+    bool appendRow(const QList<double>& row);
+
+    int     rows        (void) const { return _rows; }
+    int     cols        (void) const { return _cols; }
+    bool    isEmpty     (void) const { return _heights.isEmpty(); }
+    double  latitude    (int row) const { return _swLat + (row * _latStep); }
+    double  longitude   (int col) const { return _swLon + (col * _lonStep); }
+    double  height      (int row, int col) const { return _heights[(row * _cols) + col]; }
+
+    const double*   row     (int row) const { return _heights.constData() + (row * _cols); }
+    double*         data    (void) { return _heights.data(); }
+
+private:
+    int             _rows =     0;
+    int             _cols =     0;
+    double          _swLat =    0;
+    double          _swLon =    0;
+    double          _latStep =  0;
+    double          _lonStep =  0;
+    QVector<double> _heights;
+};
+
+Q_DECLARE_METATYPE(TerrainCarpet)
+
 /// Base class for offline/online terrain queries
 class TerrainQueryInterface : public QObject
 {
@@ -53,7 +95,7 @@ public:
 signals:
     void coordinateHeightsReceived(bool success, QList<double> heights);
     void pathHeightsReceived(bool success, double distanceBetween, double finalDistanceBetween, const QList<double>& heights);
-    void carpetHeightsReceived(bool success, double minHeight, double maxHeight, const QList<QList<double>>& carpet);
+    void carpetHeightsReceived(bool success, double minHeight, double maxHeight, const TerrainCarpet& carpet);
 };
 
 /// AirMap online implementation of terrain queries
@@ -86,7 +128,6 @@ private:
         QueryModeCarpet
     };
 
-    QNetworkAccessManager   _networkManager;
     QueryMode               _queryMode;
     bool                    _carpetStatsOnly;
 };
@@ -106,7 +147,7 @@ public:
     // Internal methods
     void _signalCoordinateHeights(bool success, QList<double> heights);
     void _signalPathHeights(bool success, double distanceBetween, double finalDistanceBetween, const QList<double>& heights);
-    void _signalCarpetHeights(bool success, double minHeight, double maxHeight, const QList<QList<double>>& carpet);
+    void _signalCarpetHeights(bool success, double minHeight, double maxHeight, const TerrainCarpet& carpet);
 };
 
 /// Used internally by TerrainOfflineAirMapQuery to manage terrain tiles
@@ -118,7 +159,13 @@ public:
 
     void addCoordinateQuery         (TerrainOfflineAirMapQuery* terrainQueryInterface, const QList<QGeoCoordinate>& coordinates);
     void addPathQuery               (TerrainOfflineAirMapQuery* terrainQueryInterface, const QGeoCoordinate& startPoint, const QGeoCoordinate& endPoint);
+    void addCarpetQuery             (TerrainOfflineAirMapQuery* terrainQueryInterface, const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly);
     bool getAltitudesForCoordinates (const QList<QGeoCoordinate>& coordinates, QList<double>& altitudes, bool& error);
+    bool getAltitudes               (const double* latitudes, const double* longitudes, double* heights, int count, bool& error);
+    int  prefetchPath               (const QList<QGeoCoordinate>& path, double corridorMeters);
+
+    /// @return x/y of the tiles under a corridor along the path, in path order and at most maxTiles of them
+    static QList<QPoint> corridorTiles(const QList<QGeoCoordinate>& path, double corridorMeters, int maxTiles);
 
     static QList<QGeoCoordinate> pathQueryToCoords(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, double& distanceBetween, double& finalDistanceBetween);
 
@@ -126,11 +173,6 @@ private slots:
     void _terrainDone(QByteArray responseBytes, QNetworkReply::NetworkError error);
 
 private:
-    enum class State {
-        Idle,
-        Downloading,
-    };
-
     enum QueryMode {
         QueryModeCoordinates,
         QueryModePath,
@@ -142,18 +184,47 @@ private:
         QueryMode                   queryMode;
         double                      distanceBetween;        // Distance between each returned height
         double                      finalDistanceBetween;   // Distance between for final height
-        QList<QGeoCoordinate>       coordinates;
+        QList<QGeoCoordinate>       coordinates;            // South west and north east corners for a carpet
+        bool                        statsOnly;              // Carpet only
     } QueuedRequestInfo_t;
 
-    void    _tileFailed                         (void);
-    QString _getTileHash                        (const QGeoCoordinate& coordinate);
+    typedef struct {
+        double  minHeight;
+        double  maxHeight;
+        bool    complete;                                   // false: A height came from neither a local dataset nor a tile
+    } CarpetRows_t;
+
+    void    _tileFailed                         (const QGCTileKey& key);
+    void    _queueTile                          (int tileX, int tileY);
+    void    _startDownloads                     (void);
+    int     _nextPendingTileIndex               (void) const;
+    void    _requestTile                        (int tileX, int tileY);
+    void    _signalQueuedRequests               (void);
+    bool    _requestNeedsTile                   (const QueuedRequestInfo_t& requestInfo, const QGCTileKey& key) const;
+    bool    _carpetHeights                      (const QGeoCoordinate& swCoord, const QGeoCoordinate& neCoord, bool statsOnly, TerrainCarpet& carpet, double& minHeight, double& maxHeight, bool& error);
+    CarpetRows_t _carpetRows                    (const TerrainCarpet* carpet, double* heights, const QHash<QGCTileKey, TerrainTile>* tiles, int rowStart, int rowEnd) const;
+
+    QGCTileKey      _tileKey(int tileX, int tileY) const { return QGCTileKey(_elevationProviderIndex, tileX, tileY, 1); }
+
+    static int      _tileX  (double longitude);
+    static int      _tileY  (double latitude);
+    static int      _maxConcurrentDownloads(void);
 
     QList<QueuedRequestInfo_t>  _requestQueue;
-    State                       _state = State::Idle;
-    QNetworkAccessManager       _networkManager;
 
-    QMutex                      _tilesMutex;
-    QHash<QString, TerrainTile> _tiles;
+    // Tiles are only ever fetched once no matter how many queries are waiting on them. All of these are protected by _tilesMutex.
+    QList<QGCTileKey>               _pendingTiles;          ///< Missing tiles waiting for a download slot
+    QSet<QGCTileKey>                _downloadingTiles;      ///< Tiles with a request in flight
+    int                             _elevationMapId;
+    int                             _elevationProviderIndex;
+    QMutex                          _tilesMutex;
+    QCache<QGCTileKey, TerrainTile> _tiles;                 ///< Least recently used tiles are dropped, they are reloaded from the tile cache database
+
+    static const int _maxMemoryTiles = 2000;                ///< ~3KB each for 1 arc-second tiles
+    static const int _estimatedTileBytes = 3 * 1024;        ///< For memory accounting, QCache has no way to look at the tiles without reordering them
+    static const int _maxPrefetchTiles = 500;               ///< Leaves most of the memory tiles to what is being looked at
+    static const int _maxCarpetTiles = 1000;                ///< All of them have to be in memory at once, ~30km square
+    static const int _minCarpetChunkRows = 16;              ///< Rows given to each worker at the least
 };
 
 /// Used internally by TerrainAtCoordinateQuery to batch coordinate requests together
@@ -226,6 +297,16 @@ public:
     /// @return true: altitude returned (check error as well), false: database query queued (altitudes not returned)
     static bool getAltitudesForCoordinates(const QList<QGeoCoordinate>& coordinates, QList<double>& altitudes, bool& error);
 
+    /// Bulk version of getAltitudesForCoordinates which avoids building coordinate lists
+    ///     @param[out] heights Must have room for count values
+    static bool getAltitudes(const double* latitudes, const double* longitudes, double* heights, int count, bool& error);
+
+    /// Loads the tiles under a corridor along the path into memory ahead of use. Missing tiles are read from the tile
+    /// cache database, or downloaded and saved to it.
+    ///     @param corridorMeters Distance either side of the path to load
+    /// @return Number of tiles which weren't in memory yet
+    static int prefetchPath(const QList<QGeoCoordinate>& path, double corridorMeters);
+
     // Internal method
     void _signalTerrainData(bool success, QList<double>& heights);
 
@@ -255,20 +336,72 @@ public:
         QList<double>   heights;                ///< Terrain heights along path
     } PathHeightInfo_t;
 
+    /// Returns the heights of a path which was queried before without starting a query
+    /// @return true: pathHeightInfo is set
+    static bool getCachedPathHeights(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, PathHeightInfo_t& pathHeightInfo);
+
+    // Internal method
+    void _signalTerrainData(bool success, const PathHeightInfo_t& pathHeightInfo);
+
 signals:
     /// Signalled when terrain data comes back from server
     void terrainDataReceived(bool success, const PathHeightInfo_t& pathHeightInfo);
 
-private slots:
-    void _pathHeights(bool success, double distanceBetween, double finalDistanceBetween, const QList<double>& heights);
-
 private:
-    bool                        _autoDelete;
-    TerrainOfflineAirMapQuery   _terrainQuery;
+    bool _autoDelete;
 };
 
 Q_DECLARE_METATYPE(TerrainPathQuery::PathHeightInfo_t)
 
+/// Identifies a path query by its end points, quantized to quantumDegrees, and the spacing of the heights along it.
+/// Paths with the same key get the same heights.
+class TerrainPathKey
+{
+public:
+    TerrainPathKey(const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, double spacingMeters);
+
+    bool operator==(const TerrainPathKey& other) const;
+    bool operator!=(const TerrainPathKey& other) const { return !(*this == other); }
+
+    uint hash(uint seed) const { return qHashBits(_values, sizeof(_values), seed); }
+
+    static constexpr double quantumDegrees = 1e-7;  ///< About 1cm
+
+private:
+    qint32 _values[5];                              ///< From lat/lon, to lat/lon, spacing in cm
+};
+
+inline uint qHash(const TerrainPathKey& key, uint seed = 0)
+{
+    return key.hash(seed);
+}
+
+/// Used internally by TerrainPathQuery to share path heights between all path queries. The heights of each path are
+/// kept for later queries of the same path, and a path which is already being queried isn't queried again, the new
+/// query waits on the same result. Only successful results are kept.
+class TerrainPathQueryCache : public QObject {
+    Q_OBJECT
+
+public:
+    TerrainPathQueryCache(void);
+
+    void addQuery           (TerrainPathQuery* pathQuery, const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord);
+    bool cachedPathHeights  (const QGeoCoordinate& fromCoord, const QGeoCoordinate& toCoord, TerrainPathQuery::PathHeightInfo_t& pathHeightInfo);
+
+private:
+    typedef struct {
+        TerrainOfflineAirMapQuery*          terrainQuery;
+        QList<QPointer<TerrainPathQuery>>   pathQueries;    ///< Waiting on the result
+    } PendingPath_t;
+
+    void _pathHeights(const TerrainPathKey& key, bool success, double distanceBetween, double finalDistanceBetween, const QList<double>& heights);
+
+    QCache<TerrainPathKey, TerrainPathQuery::PathHeightInfo_t>  _paths;     ///< Cost is the number of heights
+    QHash<TerrainPathKey, PendingPath_t>                        _pending;
+
+    static const int _maxCachedHeights = 500000;                            ///< ~4MB
+};
+
 class TerrainPolyPathQuery : public QObject
 {
     Q_OBJECT
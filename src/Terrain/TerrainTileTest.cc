@@ -0,0 +1,213 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainTileTest.h"
+#include "TerrainTile.h"
+#include "TerrainQuery.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+/// 3x3 grid one arc-second apart with elevation 100 + 10 * row + column
+QByteArray TerrainTileTest::_airMapJson(void)
+{
+    QJsonArray carpet;
+    for (int i=0; i<3; i++) {
+        QJsonArray row;
+        for (int j=0; j<3; j++) {
+            row.append(100 + (10 * i) + j);
+        }
+        carpet.append(row);
+    }
+
+    QJsonObject bounds;
+    bounds["sw"] = QJsonArray({ _swLat, _swLon });
+    bounds["ne"] = QJsonArray({ _swLat + (2 * TerrainTile::tileValueSpacingDegrees), _swLon + (2 * TerrainTile::tileValueSpacingDegrees) });
+
+    QJsonObject stats;
+    stats["min"] = 100;
+    stats["max"] = 122;
+    stats["avg"] = 111.0;
+
+    QJsonObject data;
+    data["bounds"] = bounds;
+    data["stats"]  = stats;
+    data["carpet"] = carpet;
+
+    QJsonObject root;
+    root["status"] = "success";
+    root["data"]   = data;
+
+    return QJsonDocument(root).toJson();
+}
+
+void TerrainTileTest::_serializeTest(void)
+{
+    QByteArray bytes = TerrainTile::serializeFromAirMapJson(_airMapJson());
+    QCOMPARE(bytes.size(), 56 + (9 * 2));
+
+    TerrainTile tile(bytes);
+    QVERIFY(tile.isValid());
+    QCOMPARE(tile.minElevation(), 100.0);
+    QCOMPARE(tile.maxElevation(), 122.0);
+    QCOMPARE(tile.avgElevation(), 111.0);
+
+    double halfSpacing = TerrainTile::tileValueSpacingDegrees / 2;
+    QCOMPARE(tile.elevation(QGeoCoordinate(_swLat, _swLon)), 100.0);
+    QCOMPARE(tile.elevation(QGeoCoordinate(_swLat + halfSpacing, _swLon + halfSpacing)), 105.5);
+    QCOMPARE(tile.elevation(QGeoCoordinate(_swLat + TerrainTile::tileValueSpacingDegrees + halfSpacing, _swLon + halfSpacing)), 115.5);
+}
+
+void TerrainTileTest::_inPlaceTest(void)
+{
+    QByteArray bytes = TerrainTile::serializeFromAirMapJson(_airMapJson());
+
+    // Same as a memory mapped tile, the grid must be read from this buffer and never copied
+    QByteArray  raw = QByteArray::fromRawData(bytes.constData(), bytes.size());
+    TerrainTile tile(raw);
+    QVERIFY(tile.isValid());
+    QCOMPARE(tile.elevation(QGeoCoordinate(_swLat, _swLon)), 100.0);
+
+    int16_t* grid = reinterpret_cast<int16_t*>(bytes.data() + 56);
+    grid[0] = 500;
+    QCOMPARE(tile.elevation(QGeoCoordinate(_swLat, _swLon)), 500.0);
+
+    TerrainTile copy(tile);
+    QCOMPARE(copy.elevation(QGeoCoordinate(_swLat, _swLon)), 500.0);
+}
+
+void TerrainTileTest::_legacyTest(void)
+{
+    // Layout written by earlier versions into the tile cache
+    typedef struct {
+        double  swLat,swLon, neLat, neLon;
+        int16_t minElevation;
+        int16_t maxElevation;
+        double  avgElevation;
+        int16_t gridSizeLat;
+        int16_t gridSizeLon;
+    } LegacyTileInfo_t;
+
+    LegacyTileInfo_t info;
+    info.swLat          = _swLat;
+    info.swLon          = _swLon;
+    info.neLat          = _swLat + (2 * TerrainTile::tileValueSpacingDegrees);
+    info.neLon          = _swLon + (2 * TerrainTile::tileValueSpacingDegrees);
+    info.minElevation   = 100;
+    info.maxElevation   = 122;
+    info.avgElevation   = 111.0;
+    info.gridSizeLat    = 3;
+    info.gridSizeLon    = 3;
+
+    QByteArray bytes(reinterpret_cast<const char*>(&info), sizeof(info));
+    for (int i=0; i<3; i++) {
+        for (int j=0; j<3; j++) {
+            int16_t value = static_cast<int16_t>(100 + (10 * i) + j);
+            bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+    }
+
+    TerrainTile tile(bytes);
+    QVERIFY(tile.isValid());
+    QCOMPARE(tile.maxElevation(), 122.0);
+    QCOMPARE(tile.elevation(QGeoCoordinate(_swLat + TerrainTile::tileValueSpacingDegrees, _swLon)), 110.0);
+}
+
+void TerrainTileTest::_badDataTest(void)
+{
+    QByteArray bytes = TerrainTile::serializeFromAirMapJson(_airMapJson());
+
+    QVERIFY(!TerrainTile(bytes.left(40)).isValid());
+    QVERIFY(!TerrainTile(bytes.left(bytes.size() - 1)).isValid());
+
+    // Unknown version
+    QByteArray badVersion = bytes;
+    badVersion[4] = 2;
+    QVERIFY(!TerrainTile(badVersion).isValid());
+
+    QVERIFY(TerrainTile::serializeFromAirMapJson(QByteArray("not json")).isEmpty());
+}
+
+void TerrainTileTest::_bulkTest(void)
+{
+    TerrainTile tile(TerrainTile::serializeFromAirMapJson(_airMapJson()));
+    QVERIFY(tile.isValid());
+
+    // Includes points just outside each edge which must clamp to it
+    const int   cPoints = 6;
+    double      spacing = TerrainTile::tileValueSpacingDegrees;
+    double      latitudes[cPoints]  = { _swLat, _swLat + (spacing / 2), _swLat + (1.5 * spacing), _swLat - spacing, _swLat + (3 * spacing), _swLat + spacing };
+    double      longitudes[cPoints] = { _swLon, _swLon + (spacing / 2), _swLon + (0.25 * spacing), _swLon, _swLon + (2 * spacing), _swLon + (5 * spacing) };
+    double      heights[cPoints];
+
+    tile.elevations(latitudes, longitudes, heights, cPoints);
+    for (int i=0; i<cPoints; i++) {
+        QCOMPARE(heights[i], tile.elevation(QGeoCoordinate(latitudes[i], longitudes[i])));
+    }
+    QCOMPARE(heights[1], 105.5);
+    QCOMPARE(heights[3], 100.0);
+    QCOMPARE(heights[4], 122.0);
+    QCOMPARE(heights[5], 112.0);
+}
+
+void TerrainTileTest::_corridorTilesTest(void)
+{
+    // Middle of a tile, a narrow corridor around a single point stays inside it
+    QGeoCoordinate  start(_swLat + (TerrainTile::tileSizeDegrees / 2), _swLon + (TerrainTile::tileSizeDegrees / 2));
+    QList<QPoint>   tiles = TerrainTileManager::corridorTiles({ start }, 10, 100);
+    QCOMPARE(tiles.count(), 1);
+
+    // Due east for ten tiles, the path passes through each of them in order
+    QGeoCoordinate end(start.latitude(), start.longitude() + (10 * TerrainTile::tileSizeDegrees));
+    tiles = TerrainTileManager::corridorTiles({ start, end }, 10, 100);
+    QCOMPARE(tiles.count(), 11);
+    for (int i=1; i<tiles.count(); i++) {
+        QCOMPARE(tiles[i].x(), tiles[0].x() + i);
+        QCOMPARE(tiles[i].y(), tiles[0].y());
+    }
+
+    // A corridor wider than a tile takes in the rows either side as well
+    QCOMPARE(TerrainTileManager::corridorTiles({ start, end }, 1000, 100).count(), 3 * 13);
+
+    // Stops at the limit
+    QCOMPARE(TerrainTileManager::corridorTiles({ start, end }, 1000, 5).count(), 5);
+}
+
+void TerrainTileTest::_carpetTest(void)
+{
+    const double spacing = TerrainTile::tileValueSpacingDegrees;
+
+    // Both edges are in the grid, the step shrinks so the spacing is never more than asked for
+    TerrainCarpet carpet(QGeoCoordinate(_swLat, _swLon), QGeoCoordinate(_swLat + (2.5 * spacing), _swLon + (2 * spacing)), spacing);
+    QCOMPARE(carpet.rows(), 4);
+    QCOMPARE(carpet.cols(), 3);
+    QCOMPARE(carpet.latitude(0), _swLat);
+    QCOMPARE(carpet.latitude(3), _swLat + (2.5 * spacing));
+    QCOMPARE(carpet.longitude(1), _swLon + spacing);
+    QVERIFY(qIsNaN(carpet.height(3, 2)));
+
+    // Heights are held row by row in a single buffer
+    carpet.data()[(3 * carpet.cols()) + 2] = 42;
+    QCOMPARE(carpet.height(3, 2), 42.0);
+    QCOMPARE(carpet.row(3)[2], 42.0);
+
+    // A single point
+    QCOMPARE(TerrainCarpet(QGeoCoordinate(_swLat, _swLon), QGeoCoordinate(_swLat, _swLon), spacing).rows(), 1);
+
+    // Built from rows, which all have to be the same length
+    TerrainCarpet rows;
+    QVERIFY(rows.isEmpty());
+    QVERIFY(rows.appendRow({ 1, 2, 3 }));
+    QVERIFY(rows.appendRow({ 4, 5, 6 }));
+    QVERIFY(!rows.appendRow({ 7, 8 }));
+    QCOMPARE(rows.rows(), 2);
+    QCOMPARE(rows.cols(), 3);
+    QCOMPARE(rows.height(1, 0), 4.0);
+}
@@ -0,0 +1,32 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class TerrainTileTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _serializeTest     (void);
+    void _inPlaceTest       (void);
+    void _legacyTest        (void);
+    void _badDataTest       (void);
+    void _bulkTest          (void);
+    void _corridorTilesTest (void);
+    void _carpetTest        (void);
+
+private:
+    QByteArray _airMapJson(void);
+
+    static constexpr double _swLat = 47.39;
+    static constexpr double _swLon = 8.54;
+};
@@ -18,6 +18,8 @@
 #include <QDataStream>
 #include <QtMath>
 
+#include <string.h>
+
 QGC_LOGGING_CATEGORY(TerrainTileLog, "TerrainTileLog");
 
 const char*  TerrainTile::_jsonStatusKey        = "status";
@@ -35,7 +37,6 @@ TerrainTile::TerrainTile()
     : _minElevation(-1.0)
     , _maxElevation(-1.0)
     , _avgElevation(-1.0)
-    , _data(nullptr)
     , _gridSizeLat(-1)
     , _gridSizeLon(-1)
     , _isValid(false)
@@ -45,105 +46,169 @@ TerrainTile::TerrainTile()
 
 TerrainTile::~TerrainTile()
 {
-    if (_data) {
-        for (int i = 0; i < _gridSizeLat; i++) {
-            delete[] _data[i];
-        }
-        delete[] _data;
-        _data = nullptr;
-    }
+
 }
 
-TerrainTile::TerrainTile(QByteArray byteArray)
+TerrainTile::TerrainTile(const QByteArray& byteArray)
     : _minElevation(-1.0)
     , _maxElevation(-1.0)
     , _avgElevation(-1.0)
-    , _data(nullptr)
+    , _bytes(byteArray)
     , _gridSizeLat(-1)
     , _gridSizeLon(-1)
     , _isValid(false)
 {
-    int cTileHeaderBytes = static_cast<int>(sizeof(TileInfo_t));
-    int cTileBytesAvailable = byteArray.size();
+    static_assert(sizeof(TileHeader_t) == 56, "Binary tile header layout must not change");
 
-    if (cTileBytesAvailable < cTileHeaderBytes) {
-        qWarning() << "Terrain tile binary data too small for TileInfo_s header";
+    int cTileHeaderBytes = static_cast<int>(sizeof(TileHeader_t));
+
+    if (_bytes.size() < cTileHeaderBytes) {
+        qWarning() << "Terrain tile binary data too small for header";
+        _bytes.clear();
         return;
     }
 
-    const TileInfo_t* tileInfo = reinterpret_cast<const TileInfo_t*>(byteArray.constData());
-    _southWest.setLatitude(tileInfo->swLat);
-    _southWest.setLongitude(tileInfo->swLon);
-    _northEast.setLatitude(tileInfo->neLat);
-    _northEast.setLongitude(tileInfo->neLon);
-    _minElevation = tileInfo->minElevation;
-    _maxElevation = tileInfo->maxElevation;
-    _avgElevation = tileInfo->avgElevation;
-    _gridSizeLat = tileInfo->gridSizeLat;
-    _gridSizeLon = tileInfo->gridSizeLon;
+    TileHeader_t header;
+    memcpy(&header, _bytes.constData(), sizeof(header));
+    if (header.magic != _binaryMagic) {
+        _bytes = _convertLegacy(byteArray);
+        if (_bytes.isEmpty()) {
+            return;
+        }
+        memcpy(&header, _bytes.constData(), sizeof(header));
+    } else if (header.version != _binaryVersion) {
+        qWarning() << "Terrain tile binary data unsupported version" << header.version;
+        _bytes.clear();
+        return;
+    }
+
+    if (reinterpret_cast<quintptr>(_bytes.constData()) % alignof(int16_t)) {
+        // Raw data from an odd address can't be read in place
+        _bytes = QByteArray(_bytes.constData(), _bytes.size());
+    }
+
+    _isValid = _loadHeader(header, _bytes.size());
+    if (!_isValid) {
+        _bytes.clear();
+    }
+}
+
+bool TerrainTile::_loadHeader(const TileHeader_t& header, int cBytesAvailable)
+{
+    _southWest.setLatitude(header.swLat);
+    _southWest.setLongitude(header.swLon);
+    _northEast.setLatitude(header.neLat);
+    _northEast.setLongitude(header.neLon);
+    _minElevation = header.minElevation;
+    _maxElevation = header.maxElevation;
+    _avgElevation = header.avgElevation;
+    _gridSizeLat = header.gridSizeLat;
+    _gridSizeLon = header.gridSizeLon;
 
     qCDebug(TerrainTileLog) << "Loading terrain tile: " << _southWest << " - " << _northEast;
     qCDebug(TerrainTileLog) << "min:max:avg:sizeLat:sizeLon" << _minElevation << _maxElevation << _avgElevation << _gridSizeLat << _gridSizeLon;
 
     int cTileDataBytes = static_cast<int>(sizeof(int16_t)) * _gridSizeLat * _gridSizeLon;
-    if (cTileBytesAvailable < cTileHeaderBytes + cTileDataBytes) {
+    if (_gridSizeLat < 2 || _gridSizeLon < 2 || cBytesAvailable < static_cast<int>(sizeof(TileHeader_t)) + cTileDataBytes) {
         qWarning() << "Terrain tile binary data too small for tile data";
-        return;
+        return false;
     }
 
-    _data = new int16_t*[_gridSizeLat];
-    for (int k = 0; k < _gridSizeLat; k++) {
-        _data[k] = new int16_t[_gridSizeLon];
-    }
+    return true;
+}
 
-    int valueIndex = 0;
-    const int16_t* pTileData = reinterpret_cast<const int16_t*>(&reinterpret_cast<const uint8_t*>(byteArray.constData())[cTileHeaderBytes]);
-    for (int i = 0; i < _gridSizeLat; i++) {
-        for (int j = 0; j < _gridSizeLon; j++) {
-            _data[i][j] = pTileData[valueIndex++];
-        }
+/// Rewrites a tile in the unversioned layout to the current one
+QByteArray TerrainTile::_convertLegacy(const QByteArray& byteArray)
+{
+    int cLegacyHeaderBytes = static_cast<int>(sizeof(LegacyTileInfo_t));
+
+    if (byteArray.size() < cLegacyHeaderBytes) {
+        qWarning() << "Terrain tile binary data too small for TileInfo_s header";
+        return QByteArray();
     }
 
-    _isValid = true;
+    LegacyTileInfo_t tileInfo;
+    memcpy(&tileInfo, byteArray.constData(), sizeof(tileInfo));
 
-    return;
+    int cTileDataBytes = static_cast<int>(sizeof(int16_t)) * tileInfo.gridSizeLat * tileInfo.gridSizeLon;
+    if (tileInfo.gridSizeLat <= 0 || tileInfo.gridSizeLon <= 0 || byteArray.size() < cLegacyHeaderBytes + cTileDataBytes) {
+        qWarning() << "Terrain tile binary data too small for tile data";
+        return QByteArray();
+    }
+
+    TileHeader_t header = {};
+    header.magic        = _binaryMagic;
+    header.version      = _binaryVersion;
+    header.gridSizeLat  = tileInfo.gridSizeLat;
+    header.gridSizeLon  = tileInfo.gridSizeLon;
+    header.minElevation = tileInfo.minElevation;
+    header.maxElevation = tileInfo.maxElevation;
+    header.swLat        = tileInfo.swLat;
+    header.swLon        = tileInfo.swLon;
+    header.neLat        = tileInfo.neLat;
+    header.neLon        = tileInfo.neLon;
+    header.avgElevation = tileInfo.avgElevation;
+
+    QByteArray converted(static_cast<int>(sizeof(TileHeader_t)) + cTileDataBytes, Qt::Uninitialized);
+    memcpy(converted.data(), &header, sizeof(header));
+    memcpy(converted.data() + sizeof(header), byteArray.constData() + cLegacyHeaderBytes, static_cast<size_t>(cTileDataBytes));
+
+    return converted;
 }
 
 double TerrainTile::elevation(const QGeoCoordinate& coordinate) const
 {
-    if (_isValid && _southWest.isValid() && _northEast.isValid()) {
-        qCDebug(TerrainTileLog) << "elevation: " << coordinate << " , in sw " << _southWest << " , ne " << _northEast;
-
-        // The lat/lon values in _northEast and _southWest coordinates can have rounding errors such that the coordinate
-        // request may be slightly outside the tile box specified by these values. So we clamp the incoming values to the
-        // edges of the tile if needed.
-
-        double clampedLon = qMax(coordinate.longitude(), _southWest.longitude());
-        double clampedLat = qMax(coordinate.latitude(), _southWest.latitude());
-
-        // Calc the index of the southernmost and westernmost index data value
-        int lonIndex = qFloor((clampedLon - _southWest.longitude()) / tileValueSpacingDegrees);
-        int latIndex = qFloor((clampedLat - _southWest.latitude()) / tileValueSpacingDegrees);
-
-        // Calc how far along in between the known values the requested lat/lon is fractionally
-        double lonIndexLongitude    = _southWest.longitude() + (static_cast<double>(lonIndex) * tileValueSpacingDegrees);
-        double lonFraction          = (clampedLon - lonIndexLongitude) / tileValueSpacingDegrees;
-        double latIndexLatitude     = _southWest.latitude() + (static_cast<double>(latIndex) * tileValueSpacingDegrees);
-        double latFraction          = (clampedLat - latIndexLatitude) / tileValueSpacingDegrees;
-
-        // Calc the elevation as the average across the four known points
-        double known00      = _data[latIndex][lonIndex];
-        double known01      = _data[latIndex][lonIndex+1];
-        double known10      = _data[latIndex+1][lonIndex];
-        double known11      = _data[latIndex+1][lonIndex+1];
-        double lonValue1    = known00 + ((known01 - known00) * lonFraction);
-        double lonValue2    = known10 + ((known11 - known10) * lonFraction);
-        double latValue     = lonValue1 + ((lonValue2 - lonValue1) * latFraction);
-
-        return latValue;
-    } else {
+    qCDebug(TerrainTileLog) << "elevation: " << coordinate << " , in sw " << _southWest << " , ne " << _northEast;
+
+    double latitude     = coordinate.latitude();
+    double longitude    = coordinate.longitude();
+    double height;
+
+    elevations(&latitude, &longitude, &height, 1);
+
+    return height;
+}
+
+void TerrainTile::elevations(const double* latitudes, const double* longitudes, double* heights, int count) const
+{
+    if (!_isValid || !_southWest.isValid() || !_northEast.isValid()) {
         qCWarning(TerrainTileLog) << "elevation: Internal error - invalid tile";
-        return qQNaN();
+        for (int i=0; i<count; i++) {
+            heights[i] = qQNaN();
+        }
+        return;
+    }
+
+    const int16_t*  grid        = _grid();
+    const int       rowLength   = _gridSizeLon;
+    const int       maxLatIndex = _gridSizeLat - 2;
+    const int       maxLonIndex = _gridSizeLon - 2;
+    const double    maxLatPos   = _gridSizeLat - 1;
+    const double    maxLonPos   = _gridSizeLon - 1;
+    const double    swLat       = _southWest.latitude();
+    const double    swLon       = _southWest.longitude();
+    const double    scale       = 1.0 / tileValueSpacingDegrees;
+
+    // Straight line code with no calls or branches other than the clamps so the compiler is free to vectorize it
+    for (int i=0; i<count; i++) {
+        // Position in grid units. The lat/lon values in _northEast and _southWest coordinates can have rounding errors
+        // such that the coordinate requested may be slightly outside the tile, so clamp it to the edges.
+        double latPos = qBound(0.0, (latitudes[i]  - swLat) * scale, maxLatPos);
+        double lonPos = qBound(0.0, (longitudes[i] - swLon) * scale, maxLonPos);
+
+        // Index of the southernmost and westernmost known value, and how far along towards the next the position is
+        int     latIndex    = qMin(static_cast<int>(latPos), maxLatIndex);
+        int     lonIndex    = qMin(static_cast<int>(lonPos), maxLonIndex);
+        double  latFraction = latPos - latIndex;
+        double  lonFraction = lonPos - lonIndex;
+
+        // Bilinear interpolation across the four known points
+        const int16_t* south = grid + (latIndex * rowLength) + lonIndex;
+        const int16_t* north = south + rowLength;
+        double lonValue1    = south[0] + ((south[1] - south[0]) * lonFraction);
+        double lonValue2    = north[0] + ((north[1] - north[0]) * lonFraction);
+
+        heights[i] = lonValue1 + ((lonValue2 - lonValue1) * latFraction);
     }
 }
 
@@ -233,8 +298,10 @@ QByteArray TerrainTile::serializeFromAirMapJson(QByteArray input)
     int gridSizeLat = carpetArray.count();
     int gridSizeLon = carpetArray[0].toArray().count();
 
-    TileInfo_t tileInfo;
+    TileHeader_t tileInfo = {};
 
+    tileInfo.magic = _binaryMagic;
+    tileInfo.version = _binaryVersion;
     tileInfo.swLat = swArray[0].toDouble();
     tileInfo.swLon = swArray[1].toDouble();
     tileInfo.neLat = neArray[0].toDouble();
@@ -255,15 +322,14 @@ QByteArray TerrainTile::serializeFromAirMapJson(QByteArray input)
         return emptyArray;
     }
 
-    int cTileHeaderBytes = static_cast<int>(sizeof(TileInfo_t));
+    int cTileHeaderBytes = static_cast<int>(sizeof(TileHeader_t));
     int cTileDataBytes = static_cast<int>(sizeof(int16_t)) * gridSizeLat * gridSizeLon;
 
     QByteArray byteArray(cTileHeaderBytes + cTileDataBytes, 0);
 
-    TileInfo_t* pTileInfo = reinterpret_cast<TileInfo_t*>(byteArray.data());
     int16_t*    pTileData = reinterpret_cast<int16_t*>(&reinterpret_cast<uint8_t*>(byteArray.data())[cTileHeaderBytes]);
 
-    *pTileInfo = tileInfo;
+    memcpy(byteArray.data(), &tileInfo, sizeof(tileInfo));
 
     int valueIndex = 0;
     for (int i = 0; i < gridSizeLat; i++) {
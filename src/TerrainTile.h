@@ -4,6 +4,7 @@
 #include "QGCLoggingCategory.h"
 
 #include <QGeoCoordinate>
+#include <QByteArray>
 
 Q_DECLARE_LOGGING_CATEGORY(TerrainTileLog)
 
@@ -22,9 +23,13 @@ public:
     /**
     * Constructor from serialized elevation data (either from file or web)
     *
-    * @param document
+    * The data is used in place, no copy of the elevation grid is made. To read a tile straight from a memory mapped
+    * file pass QByteArray::fromRawData over the mapping, which must then outlive the tile and all copies of it.
+    * Tiles in the older unversioned layout are still accepted, they are converted on load.
+    *
+    * @param byteArray
     */
-    TerrainTile(QByteArray byteArray);
+    TerrainTile(const QByteArray& byteArray);
 
     /**
     * Check whether valid data is loaded
@@ -41,6 +46,16 @@ public:
     */
     double elevation(const QGeoCoordinate& coordinate) const;
 
+    /**
+    * Evaluates the elevation for a number of points at once. Points outside the tile are clamped to its edges.
+    *
+    * @param latitudes
+    * @param longitudes
+    * @param[out] heights Must have room for count values, NaN if the tile is not valid
+    * @param count
+    */
+    void elevations(const double* latitudes, const double* longitudes, double* heights, int count) const;
+
     /**
     * Accessor for the minimum elevation of the tile
     *
@@ -69,6 +84,11 @@ public:
     */
     QGeoCoordinate centerCoordinate(void) const;
 
+    /**
+    * Converts an AirMap elevation api response to the binary tile format
+    *
+    * @return binary tile, empty on error
+    */
     static QByteArray serializeFromAirMapJson(QByteArray input);
 
     static constexpr double tileSizeDegrees         = 0.01;         ///< Each terrain tile represents a square area .01 degrees in lat/lon
@@ -76,6 +96,21 @@ public:
     static constexpr double tileValueSpacingMeters  = 30.0;
 
 private:
+    /// Binary tile layout, version 1. All fields are naturally aligned so there is no padding, the header is
+    /// followed by gridSizeLat rows of gridSizeLon int16 elevations going north from the south west corner.
+    typedef struct {
+        uint32_t    magic;
+        uint16_t    version;
+        int16_t     gridSizeLat;
+        int16_t     gridSizeLon;
+        int16_t     minElevation;
+        int16_t     maxElevation;
+        int16_t     reserved;
+        double      swLat, swLon, neLat, neLon;
+        double      avgElevation;
+    } TileHeader_t;
+
+    /// Unversioned layout written by older versions, still found in existing tile caches
     typedef struct {
         double  swLat,swLon, neLat, neLon;
         int16_t minElevation;
@@ -83,7 +118,15 @@ private:
         double  avgElevation;
         int16_t gridSizeLat;
         int16_t gridSizeLon;
-    } TileInfo_t;
+    } LegacyTileInfo_t;
+
+    bool                _loadHeader     (const TileHeader_t& header, int cBytesAvailable);
+    static QByteArray   _convertLegacy  (const QByteArray& byteArray);
+
+    const int16_t* _grid(void) const { return reinterpret_cast<const int16_t*>(_bytes.constData() + sizeof(TileHeader_t)); }
+
+    static const uint32_t   _binaryMagic    = 0x31545451;   ///< "QTT1" little endian
+    static const uint16_t   _binaryVersion  = 1;
 
     QGeoCoordinate      _southWest;                                     /// South west corner of the tile
     QGeoCoordinate      _northEast;                                     /// North east corner of the tile
@@ -92,7 +135,7 @@ private:
     int16_t             _maxElevation;                                  /// Maximum elevation in tile
     double              _avgElevation;                                  /// Average elevation of the tile
 
-    int16_t**           _data;                                          /// 2D elevation data array
+    QByteArray          _bytes;                                         /// Binary tile, the elevation grid is read from it in place
     int16_t             _gridSizeLat;                                   /// data grid size in latitude direction
     int16_t             _gridSizeLon;                                   /// data grid size in longitude direction
     bool                _isValid;                                       /// data loaded is valid
@@ -46,6 +46,17 @@ void CompInfoParam::setJson(const QString& metadataJsonFileName, const QString&
 
     _noJsonMetadata = false;
 
+    if (_metaDataStore.open(metadataJsonFileName, QStringLiteral("CompInfoParam%1").arg(compId))) {
+        // Indexed names are matched against each unknown parameter name so they are created up front
+        for (const QString& name: _metaDataStore.names()) {
+            if (name.contains(_indexedNameTag)) {
+                _indexedNameMetaDataList.append(RegexFactMetaDataPair_t(name, _metaDataStore.create(name, this)));
+            }
+        }
+        qCDebug(CompInfoParamLog) << "Using meta data store, parameter count:" << _metaDataStore.count();
+        return;
+    }
+
     if (!JsonHelper::isJsonFile(metadataJsonFileName, jsonDoc, errorString)) {
         qCWarning(CompInfoParamLog) << "Metadata json file open failed: compid:" << compId << errorString;
         return;
@@ -85,6 +96,12 @@ void CompInfoParam::setJson(const QString& metadataJsonFileName, const QString&
             _nameToMetaDataMap[newMetaData->name()] = newMetaData;
         }
     }
+
+    FactMetaData::NameToMetaDataMap_t storeMap = _nameToMetaDataMap;
+    for (const RegexFactMetaDataPair_t& pair: _indexedNameMetaDataList) {
+        storeMap[pair.first] = pair.second;
+    }
+    _metaDataStore.write(storeMap);
 }
 
 FactMetaData* CompInfoParam::factMetaDataForName(const QString& name, FactMetaData::ValueType_t type)
@@ -102,28 +119,33 @@ FactMetaData* CompInfoParam::factMetaDataForName(const QString& name, FactMetaDa
         if (_nameToMetaDataMap.contains(name)) {
             factMetaData = _nameToMetaDataMap[name];
         } else {
+            // Json metadata loaded from the store is only created when first asked for
+            factMetaData = _metaDataStore.create(name, this);
+
             // We didn't get any direct matches. Try an indexed name.
-            for (int i=0; i<_indexedNameMetaDataList.count(); i++) {
-                const RegexFactMetaDataPair_t& pair = _indexedNameMetaDataList[i];
-
-                QString indexedName = pair.first;
-                QString indexedRegex("(\\d+)");
-                indexedName.replace(_indexedNameTag, indexedRegex);
-
-                QRegularExpression      regex(indexedName);
-                QRegularExpressionMatch match = regex.match(name);
-
-                QStringList captured = match.capturedTexts();
-                if (captured.count() == 2) {
-                    factMetaData = new FactMetaData(*pair.second, this);
-                    factMetaData->setName(name);
-
-                    QString shortDescription = factMetaData->shortDescription();
-                    shortDescription.replace(_indexedNameTag, captured[1]);
-                    factMetaData->setShortDescription(shortDescription);
-                    QString longDescription = factMetaData->shortDescription();
-                    longDescription.replace(_indexedNameTag, captured[1]);
-                    factMetaData->setLongDescription(longDescription);
+            if (!factMetaData) {
+                for (int i=0; i<_indexedNameMetaDataList.count(); i++) {
+                    const RegexFactMetaDataPair_t& pair = _indexedNameMetaDataList[i];
+
+                    QString indexedName = pair.first;
+                    QString indexedRegex("(\\d+)");
+                    indexedName.replace(_indexedNameTag, indexedRegex);
+
+                    QRegularExpression      regex(indexedName);
+                    QRegularExpressionMatch match = regex.match(name);
+
+                    QStringList captured = match.capturedTexts();
+                    if (captured.count() == 2) {
+                        factMetaData = new FactMetaData(*pair.second, this);
+                        factMetaData->setName(name);
+
+                        QString shortDescription = factMetaData->shortDescription();
+                        shortDescription.replace(_indexedNameTag, captured[1]);
+                        factMetaData->setShortDescription(shortDescription);
+                        QString longDescription = factMetaData->shortDescription();
+                        longDescription.replace(_indexedNameTag, captured[1]);
+                        factMetaData->setLongDescription(longDescription);
+                    }
                 }
             }
 
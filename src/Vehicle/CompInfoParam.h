@@ -13,6 +13,7 @@
 #include "QGCMAVLink.h"
 #include "QGCLoggingCategory.h"
 #include "FactMetaData.h"
+#include "FactMetaDataStore.h"
 
 #include <QObject>
 
@@ -31,6 +32,9 @@ public:
 
     FactMetaData* factMetaDataForName(const QString& name, FactMetaData::ValueType_t type);
 
+    /// @return true: Metadata came from the vehicle's component information json, false: FirmwarePlugin metadata is used
+    bool jsonMetaDataAvailable(void) const { return !_noJsonMetadata; }
+
     // Overrides from CompInfo
     void setJson(const QString& metadataJsonFileName, const QString& translationJsonFileName) override;
 
@@ -47,6 +51,7 @@ private:
     bool                                _noJsonMetadata             = true;
     FactMetaData::NameToMetaDataMap_t   _nameToMetaDataMap;
     QList<RegexFactMetaDataPair_t>      _indexedNameMetaDataList;
+    FactMetaDataStore                   _metaDataStore;             ///< Json metadata not yet in _nameToMetaDataMap is created from here when open
     QObject*                            _opaqueParameterMetaData    = nullptr;
 
     static const char* _cachedMetaDataFilePrefix;
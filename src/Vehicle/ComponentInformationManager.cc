@@ -22,6 +22,9 @@
 #include <QStandardPaths>
 #include <QJsonDocument>
 #include <QJsonArray>
+#include <QCryptographicHash>
+#include <QSettings>
+#include <QSaveFile>
 
 QGC_LOGGING_CATEGORY(ComponentInformationManagerLog, "ComponentInformationManagerLog")
 
@@ -117,6 +120,11 @@ CompInfoVersion* ComponentInformationManager::compInfoVersion(uint8_t compId)
     return _compInfoMap.contains(compId) && _compInfoMap[compId].contains(COMP_METADATA_TYPE_VERSION) ? qobject_cast<CompInfoVersion*>(_compInfoMap[compId][COMP_METADATA_TYPE_VERSION]) : nullptr;
 }
 
+QString ComponentInformationManager::cacheDir(void)
+{
+    return QFileInfo(QSettings().fileName()).dir().absoluteFilePath(QStringLiteral("CompInfoCache"));
+}
+
 RequestMetaDataTypeStateMachine::RequestMetaDataTypeStateMachine(ComponentInformationManager* compMgr)
     : _compMgr(compMgr)
 {
@@ -129,6 +137,8 @@ void RequestMetaDataTypeStateMachine::request(CompInfo* compInfo)
     _stateIndex = -1;
     _jsonMetadataFileName.clear();
     _jsonTranslationFileName.clear();
+    _jsonMetadataCached     = false;
+    _jsonTranslationCached  = false;
 
     start();
 }
@@ -206,23 +216,78 @@ void RequestMetaDataTypeStateMachine::_stateRequestCompInfo(StateMachine* stateM
     }
 }
 
-QString RequestMetaDataTypeStateMachine::_downloadCompleteJsonWorker(const QString& fileName, const QString& inflatedFileName)
+/// Writes the downloaded json, inflated if it is compressed, to the cache or to a temp file. The downloaded file is removed
+/// once it is no longer needed. Compressed json is inflated in memory, so it is written to disk a single time.
+///     @param cached Set to true if the returned file is in the cache
+/// @return File to load the json from, empty on failure
+QString RequestMetaDataTypeStateMachine::_downloadCompleteJsonWorker(const QString& fileName, const QString& inflatedFileName, const QString& cacheFileName, bool& cached)
 {
-    QString outputFileName = fileName;
+    cached = false;
 
-    if (fileName.endsWith(".gz", Qt::CaseInsensitive)) {
-        outputFileName = (QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).absoluteFilePath(inflatedFileName));
-        if (QGCZlib::inflateGzipFile(fileName, outputFileName)) {
-            QFile(fileName).remove();
-        } else {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(ComponentInformationManagerLog) << "Unable to open downloaded json" << fileName << file.errorString();
+        return QString();
+    }
+    QByteArray bytes = file.readAll();
+    file.close();
+
+    bool compressed = fileName.endsWith(".gz", Qt::CaseInsensitive);
+    if (compressed) {
+        QByteArray inflatedBytes;
+        if (!QGCZlib::inflateGzipData(bytes, inflatedBytes)) {
             qCWarning(ComponentInformationManagerLog) << "Inflate of compressed json failed" << inflatedFileName;
-            outputFileName.clear();
+            return QString();
         }
-    } else {
-        outputFileName = fileName;
+        bytes = inflatedBytes;
+    }
+
+    if (!cacheFileName.isEmpty()) {
+        QDir dir(ComponentInformationManager::cacheDir());
+        dir.mkpath(dir.absolutePath());
+        if (_writeJsonFile(cacheFileName, bytes)) {
+            cached = true;
+            file.remove();
+
+            QFileInfoList cacheFiles = dir.entryInfoList(QStringList(QStringLiteral("*.json")), QDir::Files, QDir::Time);
+            while (cacheFiles.count() > ComponentInformationManager::_maxCacheFiles) {
+                QFile::remove(cacheFiles.takeLast().absoluteFilePath());
+            }
+            return cacheFileName;
+        }
+        qCWarning(ComponentInformationManagerLog) << "Unable to add json to cache" << cacheFileName;
+    }
+
+    if (compressed) {
+        QString outputFileName = QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).absoluteFilePath(inflatedFileName);
+        file.remove();
+        return _writeJsonFile(outputFileName, bytes) ? outputFileName : QString();
     }
 
-    return outputFileName;
+    return fileName;
+}
+
+/// Writes the file atomically so an interrupted write is never taken for a cache hit
+bool RequestMetaDataTypeStateMachine::_writeJsonFile(const QString& fileName, const QByteArray& bytes)
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(ComponentInformationManagerLog) << "Unable to write json" << fileName << file.errorString();
+        return false;
+    }
+    file.write(bytes);
+    return file.commit();
+}
+
+/// @return Cache file for the json at the specified uri, empty if the vehicle doesn't provide a uid to key the cache with
+QString RequestMetaDataTypeStateMachine::_cacheFileName(const QString& uri, uint32_t uid, COMP_METADATA_TYPE type, const QString& kind)
+{
+    if (uid == 0 || uri.isEmpty()) {
+        return QString();
+    }
+
+    QString uriHash = QCryptographicHash::hash(uri.toUtf8(), QCryptographicHash::Sha1).toHex().left(16);
+    return QDir(ComponentInformationManager::cacheDir()).absoluteFilePath(QStringLiteral("%1_%2_%3_%4.json").arg(static_cast<int>(type)).arg(kind).arg(uid, 8, 16, QLatin1Char('0')).arg(uriHash));
 }
 
 void RequestMetaDataTypeStateMachine::_ftpDownloadCompleteMetaDataJson(const QString& fileName, const QString& errorMsg)
@@ -231,7 +296,7 @@ void RequestMetaDataTypeStateMachine::_ftpDownloadCompleteMetaDataJson(const QSt
 
     disconnect(_compInfo->vehicle->ftpManager(), &FTPManager::downloadComplete, this, &RequestMetaDataTypeStateMachine::_ftpDownloadCompleteMetaDataJson);
     if (errorMsg.isEmpty()) {
-        _jsonMetadataFileName = _downloadCompleteJsonWorker(fileName, "metadata.json");
+        _jsonMetadataFileName = _downloadCompleteJsonWorker(fileName, "metadata.json", _cacheFileName(_compInfo->uriMetaData, _compInfo->uidMetaData, _compInfo->type, "metadata"), _jsonMetadataCached);
     } else if (qgcApp()->runningUnitTests()) {
         // Unit test should always succeed
         qCWarning(ComponentInformationManagerLog) << "RequestMetaDataTypeStateMachine::_ftpDownloadCompleteMetaDataJson failed filename:errorMsg" << fileName << errorMsg;
@@ -248,7 +313,7 @@ void RequestMetaDataTypeStateMachine::_ftpDownloadCompleteTranslationJson(const
 
     disconnect(_compInfo->vehicle->ftpManager(), &FTPManager::downloadComplete, this, &RequestMetaDataTypeStateMachine::_ftpDownloadCompleteTranslationJson);
     if (errorMsg.isEmpty()) {
-        _jsonTranslationFileName = _downloadCompleteJsonWorker(fileName, "translation.json");
+        _jsonTranslationFileName = _downloadCompleteJsonWorker(fileName, "translation.json", _cacheFileName(_compInfo->uriTranslation, _compInfo->uidTranslation, _compInfo->type, "translation"), _jsonTranslationCached);
     } else if (qgcApp()->runningUnitTests()) {
         // Unit test should always succeed
         qCWarning(ComponentInformationManagerLog) << "RequestMetaDataTypeStateMachine::_ftpDownloadCompleteTranslationJson failed filename:errorMsg" << fileName << errorMsg;
@@ -263,7 +328,7 @@ void RequestMetaDataTypeStateMachine::_httpDownloadCompleteMetaDataJson(QString
 
     disconnect(qobject_cast<QGCFileDownload*>(sender()), &QGCFileDownload::downloadComplete, this, &RequestMetaDataTypeStateMachine::_httpDownloadCompleteMetaDataJson);
     if (errorMsg.isEmpty()) {
-        _jsonMetadataFileName = _downloadCompleteJsonWorker(localFile, "metadata.json");
+        _jsonMetadataFileName = _downloadCompleteJsonWorker(localFile, "metadata.json", _cacheFileName(_compInfo->uriMetaData, _compInfo->uidMetaData, _compInfo->type, "metadata"), _jsonMetadataCached);
     } else if (qgcApp()->runningUnitTests()) {
         // Unit test should always succeed
         qCWarning(ComponentInformationManagerLog) << "RequestMetaDataTypeStateMachine::_httpDownloadCompleteMetaDataJson failed remoteFile:localFile:errorMsg" << remoteFile << localFile << errorMsg;
@@ -280,7 +345,7 @@ void RequestMetaDataTypeStateMachine::_httpDownloadCompleteTranslationJson(QStri
 
     disconnect(qobject_cast<QGCFileDownload*>(sender()), &QGCFileDownload::downloadComplete, this, &RequestMetaDataTypeStateMachine::_httpDownloadCompleteTranslationJson);
     if (errorMsg.isEmpty()) {
-        _jsonTranslationFileName = _downloadCompleteJsonWorker(localFile, "translation.json");
+        _jsonTranslationFileName = _downloadCompleteJsonWorker(localFile, "translation.json", _cacheFileName(_compInfo->uriTranslation, _compInfo->uidTranslation, _compInfo->type, "translation"), _jsonTranslationCached);
     } else if (qgcApp()->runningUnitTests()) {
         // Unit test should always succeed
         qCWarning(ComponentInformationManagerLog) << "RequestMetaDataTypeStateMachine::_httpDownloadCompleteTranslationJson failed remoteFile:localFile:errorMsg" << remoteFile << localFile << errorMsg;
@@ -295,7 +360,14 @@ void RequestMetaDataTypeStateMachine::_stateRequestMetaDataJson(StateMachine* st
     CompInfo*                           compInfo        = requestMachine->compInfo();
     FTPManager*                         ftpManager      = compInfo->vehicle->ftpManager();
 
-    if (compInfo->available) {
+    QString                             cacheFileName   = _cacheFileName(compInfo->uriMetaData, compInfo->uidMetaData, compInfo->type, "metadata");
+
+    if (compInfo->available && !cacheFileName.isEmpty() && QFile::exists(cacheFileName)) {
+        qCDebug(ComponentInformationManagerLog) << "Using cached metadata json" << cacheFileName;
+        requestMachine->_jsonMetadataFileName   = cacheFileName;
+        requestMachine->_jsonMetadataCached     = true;
+        requestMachine->advance();
+    } else if (compInfo->available) {
         qCDebug(ComponentInformationManagerLog) << "Downloading metadata json" << compInfo->uriMetaData;
         if (_uriIsMAVLinkFTP(compInfo->uriMetaData)) {
             connect(ftpManager, &FTPManager::downloadComplete, requestMachine, &RequestMetaDataTypeStateMachine::_ftpDownloadCompleteMetaDataJson);
@@ -325,10 +397,17 @@ void RequestMetaDataTypeStateMachine::_stateRequestTranslationJson(StateMachine*
     CompInfo*                           compInfo        = requestMachine->compInfo();
     FTPManager*                         ftpManager      = compInfo->vehicle->ftpManager();
 
+    QString                             cacheFileName   = _cacheFileName(compInfo->uriTranslation, compInfo->uidTranslation, compInfo->type, "translation");
+
     if (compInfo->available) {
         if (compInfo->uriTranslation.isEmpty()) {
             qCDebug(ComponentInformationManagerLog) << "Skipping translation json download. No translation json specified";
             requestMachine->advance();
+        } else if (!cacheFileName.isEmpty() && QFile::exists(cacheFileName)) {
+            qCDebug(ComponentInformationManagerLog) << "Using cached translation json" << cacheFileName;
+            requestMachine->_jsonTranslationFileName    = cacheFileName;
+            requestMachine->_jsonTranslationCached      = true;
+            requestMachine->advance();
         } else {
             qCDebug(ComponentInformationManagerLog) << "Downloading translation json" << compInfo->uriTranslation;
             if (_uriIsMAVLinkFTP(compInfo->uriTranslation)) {
@@ -361,10 +440,10 @@ void RequestMetaDataTypeStateMachine::_stateRequestComplete(StateMachine* stateM
 
     compInfo->setJson(requestMachine->_jsonMetadataFileName, requestMachine->_jsonTranslationFileName);
 
-    if (!requestMachine->_jsonMetadataFileName.isEmpty()) {
+    if (!requestMachine->_jsonMetadataFileName.isEmpty() && !requestMachine->_jsonMetadataCached) {
         QFile(requestMachine->_jsonMetadataFileName).remove();
     }
-    if (!requestMachine->_jsonTranslationFileName.isEmpty()) {
+    if (!requestMachine->_jsonTranslationFileName.isEmpty() && !requestMachine->_jsonTranslationCached) {
         QFile(requestMachine->_jsonTranslationFileName).remove();
     }
 
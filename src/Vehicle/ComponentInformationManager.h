@@ -42,7 +42,7 @@ private slots:
     void    _ftpDownloadCompleteTranslationJson (const QString& file, const QString& errorMsg);
     void    _httpDownloadCompleteMetaDataJson   (QString remoteFile, QString localFile, QString errorMsg);
     void    _httpDownloadCompleteTranslationJson(QString remoteFile, QString localFile, QString errorMsg);
-    QString _downloadCompleteJsonWorker         (const QString& jsonFileName, const QString& inflatedFileName);
+    QString _downloadCompleteJsonWorker         (const QString& jsonFileName, const QString& inflatedFileName, const QString& cacheFileName, bool& cached);
 
 private:
     static void _stateRequestCompInfo           (StateMachine* stateMachine);
@@ -50,12 +50,16 @@ private:
     static void _stateRequestTranslationJson    (StateMachine* stateMachine);
     static void _stateRequestComplete           (StateMachine* stateMachine);
     static bool _uriIsMAVLinkFTP                (const QString& uri);
+    static QString _cacheFileName               (const QString& uri, uint32_t uid, COMP_METADATA_TYPE type, const QString& kind);
+    static bool _writeJsonFile                  (const QString& fileName, const QByteArray& bytes);
 
 
     ComponentInformationManager*    _compMgr                    = nullptr;
     CompInfo*                       _compInfo                   = nullptr;
     QString                         _jsonMetadataFileName;
     QString                         _jsonTranslationFileName;
+    bool                            _jsonMetadataCached         = false;    ///< _jsonMetadataFileName is in the cache, don't remove it
+    bool                            _jsonTranslationCached      = false;    ///< _jsonTranslationFileName is in the cache, don't remove it
 
     static StateFn  _rgStates[];
     static int      _cStates;
@@ -75,6 +79,9 @@ public:
     CompInfoParam*      compInfoParam                   (uint8_t compId);
     CompInfoVersion*    compInfoVersion                 (uint8_t compId);
 
+    /// Downloaded metadata and translation json is kept here, keyed by the uid and uri from COMPONENT_INFORMATION
+    static QString cacheDir(void);
+
     // Overrides from StateMachine
     int             stateCount  (void) const final;
     const StateFn*  rgStates    (void) const final;
@@ -97,5 +104,7 @@ private:
     static StateFn                  _rgStates[];
     static int                      _cStates;
 
+    static const int                _maxCacheFiles = 50;
+
     friend class RequestMetaDataTypeStateMachine;
 };
@@ -15,7 +15,9 @@
 
 #include <QFile>
 #include <QDir>
+#include <QTimer>
 #include <string>
+#include <algorithm>
 
 QGC_LOGGING_CATEGORY(FTPManagerLog, "FTPManagerLog")
 
@@ -28,13 +30,14 @@ FTPManager::FTPManager(Vehicle* vehicle)
     _ackOrNakTimeoutTimer.setSingleShot(true);
     // Mock link responds immediately if at all, speed up unit tests with faster timoue
     _ackOrNakTimeoutTimer.setInterval(qgcApp()->runningUnitTests() ? 10 : _ackOrNakTimeoutMsecs);
-    connect(&_ackOrNakTimeoutTimer, &QTimer::timeout, this, &FTPManager::_ackOrNakTimeout);
+    connect(&_ackOrNakTimeoutTimer, &QGCWheelTimer::timeout, this, &FTPManager::_ackOrNakTimeout);
+    _rttTimer.start();
     
     // Make sure we don't have bad structure packing
     Q_ASSERT(sizeof(MavlinkFTP::RequestHeader) == 12);
 }
 
-bool FTPManager::download(const QString& fromURI, const QString& toDir)
+bool FTPManager::download(const QString& fromURI, const QString& toDir, const QString& fileName, bool resume)
 {
     qCDebug(FTPManagerLog) << "download fromURI:" << fromURI << "to:" << toDir;
 
@@ -56,9 +59,11 @@ bool FTPManager::download(const QString& fromURI, const QString& toDir)
 
     _downloadState.reset();
     _downloadState.toDir.setPath(toDir);
+    _downloadState.resume = resume;
 
     if (!_parseURI(fromURI, _downloadState.fullPathOnVehicle, _ftpCompId)) {
         qCWarning(FTPManagerLog) << "_parseURI failed";
+        _rgStateMachine.clear();
         return false;
     }
 
@@ -72,7 +77,7 @@ bool FTPManager::download(const QString& fromURI, const QString& toDir)
     }
     lastDirSlashIndex++; // move past slash
 
-    _downloadState.fileName = _downloadState.fullPathOnVehicle.right(_downloadState.fullPathOnVehicle.size() - lastDirSlashIndex);
+    _downloadState.fileName = fileName.isEmpty() ? _downloadState.fullPathOnVehicle.right(_downloadState.fullPathOnVehicle.size() - lastDirSlashIndex) : fileName;
 
     qCDebug(FTPManagerLog) << "_downloadState.fullPathOnVehicle:_downloadState.fileName" << _downloadState.fullPathOnVehicle << _downloadState.fileName;
 
@@ -81,6 +86,290 @@ bool FTPManager::download(const QString& fromURI, const QString& toDir)
     return true;
 }
 
+void FTPManager::cancelDownload(void)
+{
+    if (_currentStateMachineIndex == -1 || _rgStateMachine.isEmpty() || _rgStateMachine[0].beginFn != &FTPManager::_openFileROBegin) {
+        return;
+    }
+
+    qCDebug(FTPManagerLog) << "cancelDownload";
+
+    // Frees the session on the vehicle. The ack is not waited for, it is ignored once the state machine is gone.
+    MavlinkFTP::Request request{};
+    request.hdr.opcode  = MavlinkFTP::kCmdResetSessions;
+    request.hdr.size    = 0;
+    _sendRequestExpectAck(&request);
+
+    _downloadComplete(tr("Download cancelled"));
+}
+
+bool FTPManager::listDirectory(const QString& fromURI, bool useCache)
+{
+    qCDebug(FTPManagerLog) << "listDirectory fromURI:" << fromURI << "useCache:" << useCache;
+
+    if (!_rgStateMachine.isEmpty()) {
+        qCDebug(FTPManagerLog) << "Cannot list directory. Already in another operation";
+        return false;
+    }
+
+    QString path;
+    uint8_t compId;
+    if (!_parseURI(fromURI, path, compId)) {
+        qCWarning(FTPManagerLog) << "_parseURI failed";
+        return false;
+    }
+
+    if (useCache) {
+        auto cached = _directoryCache.constFind(_directoryCacheKey(compId, path));
+        if (cached != _directoryCache.constEnd()) {
+            qCDebug(FTPManagerLog) << "listDirectory: cached" << path;
+            // Signalled from the event loop, the same as an answer from the vehicle
+            const QStringList dirList = cached.value();
+            QTimer::singleShot(0, this, [this, dirList]() { emit listDirectoryComplete(dirList, QString()); });
+            return true;
+        }
+    }
+
+    _listDirectoryState.reset();
+    _listDirectoryState.fullPathOnVehicle   = path;
+    _ftpCompId                              = compId;
+
+    static const StateFunctions_t rgListDirectoryStateMachine[] = {
+        { &FTPManager::_listDirectoryBegin,             &FTPManager::_listDirectoryAckOrNak,    &FTPManager::_listDirectoryTimeout },
+        { &FTPManager::_listDirectoryCompleteNoError,   nullptr,                                nullptr },
+    };
+    for (size_t i=0; i<sizeof(rgListDirectoryStateMachine)/sizeof(rgListDirectoryStateMachine[0]); i++) {
+        _rgStateMachine.append(rgListDirectoryStateMachine[i]);
+    }
+
+    _startStateMachine();
+
+    return true;
+}
+
+bool FTPManager::upload(const QString& toURI, const QString& fromFile)
+{
+    qCDebug(FTPManagerLog) << "upload fromFile:" << fromFile << "to:" << toURI;
+
+    if (!_rgStateMachine.isEmpty()) {
+        qCDebug(FTPManagerLog) << "Cannot upload. Already in another operation";
+        return false;
+    }
+
+    _uploadState.reset();
+    _uploadState.localFile = fromFile;
+
+    if (!_parseURI(toURI, _uploadState.fullPathOnVehicle, _ftpCompId)) {
+        qCWarning(FTPManagerLog) << "_parseURI failed";
+        return false;
+    }
+
+    QFile file(fromFile);
+    if (!file.open(QFile::ReadOnly)) {
+        qCWarning(FTPManagerLog) << "Unable to open upload file" << fromFile << file.errorString();
+        return false;
+    }
+    _uploadState.data = file.readAll();
+    if (_uploadState.data.count()) {
+        MissingData_t unsentData;
+        unsentData.offset           = 0;
+        unsentData.cBytesMissing    = static_cast<uint32_t>(_uploadState.data.count());
+        _uploadState.rgUnsentData.append(unsentData);
+    }
+
+    static const StateFunctions_t rgUploadStateMachine[] = {
+        { &FTPManager::_createFileBegin,            &FTPManager::_createFileAckOrNak,           &FTPManager::_createFileTimeout },
+        { &FTPManager::_writeFileBegin,             &FTPManager::_writeFileAckOrNak,            &FTPManager::_writeFileTimeout },
+        { &FTPManager::_terminateSessionBegin,      &FTPManager::_terminateSessionAckOrNak,     &FTPManager::_terminateSessionTimeout },
+        { &FTPManager::_uploadCompleteNoError,      nullptr,                                    nullptr },
+    };
+    for (size_t i=0; i<sizeof(rgUploadStateMachine)/sizeof(rgUploadStateMachine[0]); i++) {
+        _rgStateMachine.append(rgUploadStateMachine[i]);
+    }
+
+    _startStateMachine();
+
+    return true;
+}
+
+bool FTPManager::calcFileCRC32(const QString& fileURI)
+{
+    qCDebug(FTPManagerLog) << "calcFileCRC32 fileURI:" << fileURI;
+
+    if (!_rgStateMachine.isEmpty()) {
+        qCDebug(FTPManagerLog) << "Cannot calculate CRC32. Already in another operation";
+        return false;
+    }
+
+    _crc32State.reset();
+
+    if (!_parseURI(fileURI, _crc32State.fullPathOnVehicle, _ftpCompId)) {
+        qCWarning(FTPManagerLog) << "_parseURI failed";
+        return false;
+    }
+
+    static const StateFunctions_t rgCalcFileCRC32StateMachine[] = {
+        { &FTPManager::_calcFileCRC32Begin,             &FTPManager::_calcFileCRC32AckOrNak,    &FTPManager::_calcFileCRC32Timeout },
+        { &FTPManager::_calcFileCRC32CompleteNoError,   nullptr,                                nullptr },
+    };
+    for (size_t i=0; i<sizeof(rgCalcFileCRC32StateMachine)/sizeof(rgCalcFileCRC32StateMachine[0]); i++) {
+        _rgStateMachine.append(rgCalcFileCRC32StateMachine[i]);
+    }
+
+    _crc32State.sentMsecs = _rttTimer.elapsed();
+    _startStateMachine();
+
+    return true;
+}
+
+bool FTPManager::fileCRC32(const QString& localFile, quint32& crc)
+{
+    crc = 0;
+
+    QFile file(localFile);
+    if (!file.open(QFile::ReadOnly)) {
+        qCDebug(FTPManagerLog) << "fileCRC32: Unable to open" << localFile << file.errorString();
+        return false;
+    }
+
+    // Same algorithm and initial state as the vehicle uses for kCmdCalcFileCRC32
+    while (!file.atEnd()) {
+        QByteArray bytes = file.read(64 * 1024);
+        if (bytes.isEmpty()) {
+            qCDebug(FTPManagerLog) << "fileCRC32: Read failed" << localFile << file.errorString();
+            return false;
+        }
+        crc = QGC::crc32(reinterpret_cast<const quint8*>(bytes.constData()), static_cast<unsigned>(bytes.size()), crc);
+    }
+
+    return true;
+}
+
+void FTPManager::queueDownload(const QString& fromURI, const QString& toDir, const QString& fileName)
+{
+    Job_t job;
+    job.type            = JobDownload;
+    job.uri             = fromURI;
+    job.localPath       = toDir;
+    job.fileName        = fileName;
+    job.skipUnchanged   = false;
+    job.crcChecked      = false;
+    _jobQueue.enqueue(job);
+
+    qCDebug(FTPManagerLog) << "queueDownload" << fromURI << "jobs:" << _jobQueue.count();
+    QTimer::singleShot(0, this, &FTPManager::_runJobQueue);
+}
+
+void FTPManager::queueUpload(const QString& toURI, const QString& fromFile, bool skipUnchanged)
+{
+    Job_t job;
+    job.type            = JobUpload;
+    job.uri             = toURI;
+    job.localPath       = fromFile;
+    job.skipUnchanged   = skipUnchanged;
+    job.crcChecked      = false;
+    _jobQueue.enqueue(job);
+
+    qCDebug(FTPManagerLog) << "queueUpload" << toURI << "jobs:" << _jobQueue.count();
+    QTimer::singleShot(0, this, &FTPManager::_runJobQueue);
+}
+
+void FTPManager::cancelJobs(void)
+{
+    qCDebug(FTPManagerLog) << "cancelJobs" << _jobQueue.count() << "running:" << _jobRunning;
+
+    while (_jobQueue.count() > (_jobRunning ? 1 : 0)) {
+        _jobQueue.removeLast();
+    }
+    if (_jobQueue.isEmpty()) {
+        int failedJobs = _failedJobs;
+        _failedJobs = 0;
+        emit jobQueueComplete(failedJobs);
+    }
+}
+
+void FTPManager::_runJobQueue(void)
+{
+    // Called again once the operation in progress is complete
+    if (_jobRunning || _jobQueue.isEmpty() || !_rgStateMachine.isEmpty()) {
+        return;
+    }
+
+    const Job_t& job = _jobQueue.head();
+    bool started;
+    if (job.type == JobDownload) {
+        started = download(job.uri, job.localPath, job.fileName);
+    } else if (job.skipUnchanged && !job.crcChecked) {
+        started = calcFileCRC32(job.uri);
+    } else {
+        started = upload(job.uri, job.localPath);
+    }
+
+    if (started) {
+        _jobRunning = true;
+    } else {
+        _jobComplete(job.type == JobDownload ? tr("Download failed") : tr("Upload failed"), false);
+    }
+}
+
+/// Moves the job queue along once an operation is complete, whether it was started by a job or not
+void FTPManager::_operationComplete(const QString& errorMsg)
+{
+    if (!_jobRunning) {
+        if (!_jobQueue.isEmpty()) {
+            QTimer::singleShot(0, this, &FTPManager::_runJobQueue);
+        }
+        return;
+    }
+
+    _jobRunning = false;
+
+    Job_t& job = _jobQueue.head();
+    if (job.type == JobUpload && job.skipUnchanged && !job.crcChecked) {
+        job.crcChecked = true;
+
+        quint32 localCRC;
+        if (errorMsg.isEmpty() && fileCRC32(job.localPath, localCRC) && localCRC == _crc32State.crc) {
+            qCDebug(FTPManagerLog) << "_operationComplete: unchanged, upload skipped" << job.uri;
+            _jobComplete(QString(), true);
+        } else {
+            // Changed, not on the vehicle yet, or the vehicle can't calculate CRC32s
+            QTimer::singleShot(0, this, &FTPManager::_runJobQueue);
+        }
+    } else {
+        _jobComplete(errorMsg, false);
+    }
+}
+
+void FTPManager::_jobComplete(const QString& errorMsg, bool skipped)
+{
+    Job_t job = _jobQueue.dequeue();
+    _jobRunning = false;
+    if (!errorMsg.isEmpty()) {
+        _failedJobs++;
+    }
+
+    qCDebug(FTPManagerLog) << "_jobComplete" << job.uri << "errorMsg:" << errorMsg << "skipped:" << skipped << "left:" << _jobQueue.count();
+    emit jobComplete(job.uri, errorMsg, skipped);
+
+    if (_jobQueue.isEmpty()) {
+        int failedJobs = _failedJobs;
+        _failedJobs = 0;
+        emit jobQueueComplete(failedJobs);
+    } else {
+        QTimer::singleShot(0, this, &FTPManager::_runJobQueue);
+    }
+}
+
+QString FTPManager::_directoryCacheKey(uint8_t compId, const QString& path)
+{
+    QString directory = path;
+    while (directory.length() > 1 && directory.endsWith('/')) {
+        directory.chop(1);
+    }
+    return QStringLiteral("%1:%2").arg(compId).arg(directory);
+}
+
 /// Closes out a download session by writing the file and doing cleanup.
 ///     @param errorMsg Error message, empty if no error
 void FTPManager::_downloadComplete(const QString& errorMsg)
@@ -92,15 +381,79 @@ void FTPManager::_downloadComplete(const QString& errorMsg)
 
     _ackOrNakTimeoutTimer.stop();
     _rgStateMachine.clear();
+    _rgWindowRequests.clear();
     _currentStateMachineIndex = -1;
     if (_downloadState.file.isOpen()) {
         _downloadState.file.close();
-        if (!errorMsg.isEmpty()) {
+        if (!errorMsg.isEmpty() && !_downloadState.resume) {
             _downloadState.file.remove();
         }
     }
 
     emit downloadComplete(downloadFilePath, errorMsg);
+    _operationComplete(errorMsg);
+}
+
+void FTPManager::_listDirectoryComplete(const QString& errorMsg)
+{
+    qCDebug(FTPManagerLog) << QString("_listDirectoryComplete: errorMsg(%1)").arg(errorMsg);
+
+    QStringList dirList = _listDirectoryState.rgDirectoryList;
+
+    if (errorMsg.isEmpty()) {
+        _directoryCache[_directoryCacheKey(_ftpCompId, _listDirectoryState.fullPathOnVehicle)] = dirList;
+    }
+
+    _ackOrNakTimeoutTimer.stop();
+    _rgStateMachine.clear();
+    _currentStateMachineIndex = -1;
+    _listDirectoryState.reset();
+
+    emit listDirectoryComplete(dirList, errorMsg);
+    _operationComplete(errorMsg);
+}
+
+void FTPManager::_calcFileCRC32Complete(const QString& errorMsg)
+{
+    qCDebug(FTPManagerLog) << QString("_calcFileCRC32Complete: errorMsg(%1) crc(%2)").arg(errorMsg).arg(_crc32State.crc, 8, 16, QChar('0'));
+
+    _ackOrNakTimeoutTimer.stop();
+    _rgStateMachine.clear();
+    _currentStateMachineIndex = -1;
+
+    // _crc32State is kept until the next calculation, the job queue compares it
+    emit calcFileCRC32Complete(_crc32State.fullPathOnVehicle, errorMsg.isEmpty() ? _crc32State.crc : 0, errorMsg);
+    _operationComplete(errorMsg);
+}
+
+void FTPManager::_emitDownloadProgress(void)
+{
+    if (_downloadState.fileSize != 0) {
+        emit commandProgress(100 * ((float)(_downloadState.bytesWritten) / (float)_downloadState.fileSize));
+    }
+    emit downloadProgress(_downloadState.bytesWritten, _downloadState.fileSize);
+}
+
+/// Closes out an upload session.
+///     @param errorMsg Error message, empty if no error
+void FTPManager::_uploadComplete(const QString& errorMsg)
+{
+    qCDebug(FTPManagerLog) << QString("_uploadComplete: errorMsg(%1)").arg(errorMsg);
+
+    QString uploadFile = _uploadState.localFile;
+
+    // The cached listing of the directory doesn't have the file, or has the old size of it
+    QString directory = _uploadState.fullPathOnVehicle.left(_uploadState.fullPathOnVehicle.lastIndexOf('/'));
+    _directoryCache.remove(_directoryCacheKey(_ftpCompId, directory.isEmpty() ? QStringLiteral("/") : directory));
+
+    _ackOrNakTimeoutTimer.stop();
+    _rgStateMachine.clear();
+    _rgWindowRequests.clear();
+    _currentStateMachineIndex = -1;
+    _uploadState.reset();
+
+    emit uploadComplete(uploadFile, errorMsg);
+    _operationComplete(errorMsg);
 }
 
 void FTPManager::_mavlinkMessageReceived(const mavlink_message_t& message)
@@ -124,18 +477,27 @@ void FTPManager::_mavlinkMessageReceived(const mavlink_message_t& message)
     
     MavlinkFTP::Request* request = (MavlinkFTP::Request*)&data.payload[0];
 
-    // Ignore old/reordered packets (handle wrap-around properly)
     uint16_t actualIncomingSeqNumber = request->hdr.seqNumber;
-    if ((uint16_t)((_expectedIncomingSeqNumber - 1) - actualIncomingSeqNumber) < (std::numeric_limits<uint16_t>::max()/2)) {
-        qCDebug(FTPManagerLog) << "_mavlinkMessageReceived: Received old packet seqNum expected:actual" << _expectedIncomingSeqNumber << actualIncomingSeqNumber
-                               << "hdr.opcode:hdr.req_opcode" << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode)) <<  MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.req_opcode));
+    if (_rgWindowRequests.contains(actualIncomingSeqNumber)) {
+        // Pipelined requests are answered out of step with _expectedIncomingSeqNumber, each is matched by its own sequence number
+        _sampleRoundTrip(_rgWindowRequests[actualIncomingSeqNumber].sentMsecs);
+    } else {
+        // Ignore old/reordered packets (handle wrap-around properly)
+        if ((uint16_t)((_expectedIncomingSeqNumber - 1) - actualIncomingSeqNumber) < (std::numeric_limits<uint16_t>::max()/2)) {
+            qCDebug(FTPManagerLog) << "_mavlinkMessageReceived: Received old packet seqNum expected:actual" << _expectedIncomingSeqNumber << actualIncomingSeqNumber
+                                   << "hdr.opcode:hdr.req_opcode" << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode)) <<  MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.req_opcode));
 
-        return;
+            return;
+        }
+        if (_rttSampleMsecs != -1 && actualIncomingSeqNumber == _rttSampleSeqNumber) {
+            _sampleRoundTrip(_rttSampleMsecs);
+            _rttSampleMsecs = -1;
+        }
     }
 
-    qCDebug(FTPManagerLog) << "_mavlinkMessageReceived: hdr.opcode:hdr.req_opcode:seqNumber"
-                           << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode)) <<  MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.req_opcode))
-                           << request->hdr.seqNumber;
+    QGC_DEBUG_RATE_LIMITED(FTPManagerLog, _packetLogIntervalMsecs) << "_mavlinkMessageReceived: hdr.opcode:hdr.req_opcode:seqNumber"
+                                                                   << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode)) <<  MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.req_opcode))
+                                                                   << request->hdr.seqNumber;
 
     (this->*_rgStateMachine[_currentStateMachineIndex].ackNakFn)(request);
 }
@@ -157,6 +519,43 @@ void FTPManager::_ackOrNakTimeout(void)
     (this->*_rgStateMachine[_currentStateMachineIndex].timeoutFn)();
 }
 
+/// Updates the ack/nak timeout from a round trip sample using the smoothed estimator of RFC 6298
+void FTPManager::_sampleRoundTrip(qint64 sentMsecs)
+{
+    double sample = static_cast<double>(_rttTimer.elapsed() - sentMsecs);
+
+    if (_roundTripMsecs < 0) {
+        _roundTripMsecs     = sample;
+        _roundTripVarMsecs  = sample / 2.0;
+    } else {
+        _roundTripVarMsecs  = (0.75 * _roundTripVarMsecs) + (0.25 * qAbs(_roundTripMsecs - sample));
+        _roundTripMsecs     = (0.875 * _roundTripMsecs) + (0.125 * sample);
+    }
+
+    // Mock link responds immediately if at all, keep unit tests fast
+    int minTimeout  = qgcApp()->runningUnitTests() ? 10 : static_cast<int>(_minAckOrNakTimeoutMsecs);
+    int timeout     = qBound(minTimeout, qRound(_roundTripMsecs + (4.0 * _roundTripVarMsecs)), static_cast<int>(_maxAckOrNakTimeoutMsecs));
+    if (timeout != _ackOrNakTimeoutTimer.interval()) {
+        qCDebug(FTPManagerLog) << "_sampleRoundTrip: timeout:roundTrip" << timeout << _roundTripMsecs;
+        _ackOrNakTimeoutTimer.setInterval(timeout);
+    }
+}
+
+/// Moves the outstanding pipelined requests back into the list of data still to be transferred, so they are sent again
+/// with new sequence numbers.
+void FTPManager::_requeueWindowRequests(QList<MissingData_t>& rgData)
+{
+    for (const WindowRequest_t& windowRequest: _rgWindowRequests) {
+        MissingData_t data;
+        data.offset         = windowRequest.offset;
+        data.cBytesMissing  = windowRequest.cBytes;
+        rgData.append(data);
+    }
+    _rgWindowRequests.clear();
+
+    std::sort(rgData.begin(), rgData.end(), [](const MissingData_t& a, const MissingData_t& b) { return a.offset < b.offset; });
+}
+
 void FTPManager::_fillRequestDataWithString(MavlinkFTP::Request* request, const QString& str)
 {
     strncpy((char *)&request->data[0], str.toStdString().c_str(), sizeof(request->data));
@@ -225,7 +624,21 @@ void FTPManager::_openFileROAckOrNak(const MavlinkFTP::Request* ackOrNak)
         _downloadState.expectedOffset   = 0;
 
         _downloadState.file.setFileName(_downloadState.toDir.filePath(_downloadState.fileName));
-        if (_downloadState.file.open(QFile::WriteOnly | QFile::Truncate)) {
+
+        bool opened = false;
+        if (_downloadState.resume && _downloadState.file.exists() && _downloadState.file.size() <= _downloadState.fileSize) {
+            // Everything up to the end of the local file has been downloaded before
+            opened = _downloadState.file.open(QFile::ReadWrite);
+            if (opened) {
+                _downloadState.expectedOffset   = static_cast<uint32_t>(_downloadState.file.size());
+                _downloadState.bytesWritten     = _downloadState.expectedOffset;
+                qCDebug(FTPManagerLog) << "_openFileROAckOrNak: resuming at" << _downloadState.expectedOffset;
+            }
+        } else {
+            opened = _downloadState.file.open(QFile::WriteOnly | QFile::Truncate);
+        }
+        if (opened) {
+            _emitDownloadProgress();
             _advanceStateMachine();
         } else {
             qCDebug(FTPManagerLog) << "_openFileROAckOrNak: Ack _downloadState.file open failed" << _downloadState.file.errorString();
@@ -283,7 +696,7 @@ void FTPManager::_burstReadFileAckOrNak(const MavlinkFTP::Request* ackOrNak)
             return;
         }
 
-        qCDebug(FTPManagerLog) << QString("_burstReadFileAckOrNak: Ack offset(%1) size(%2) burstComplete(%3)").arg(ackOrNak->hdr.offset).arg(ackOrNak->hdr.size).arg(ackOrNak->hdr.burstComplete);
+        QGC_DEBUG_RATE_LIMITED(FTPManagerLog, _packetLogIntervalMsecs) << "_burstReadFileAckOrNak: Ack offset:size:burstComplete" << ackOrNak->hdr.offset << ackOrNak->hdr.size << ackOrNak->hdr.burstComplete;
 
         if (ackOrNak->hdr.offset != _downloadState.expectedOffset) {
             if (ackOrNak->hdr.offset > _downloadState.expectedOffset) {
@@ -310,9 +723,7 @@ void FTPManager::_burstReadFileAckOrNak(const MavlinkFTP::Request* ackOrNak)
         _downloadState.bytesWritten += ackOrNak->hdr.size;
         _downloadState.expectedOffset = ackOrNak->hdr.offset + ackOrNak->hdr.size;
 
-        if (_downloadState.fileSize != 0) {
-            emit commandProgress(100 * ((float)(_downloadState.bytesWritten) / (float)_downloadState.fileSize));
-        }
+        _emitDownloadProgress();
 
         if (ackOrNak->hdr.burstComplete) {
             // The current burst is done, request next one in offset sequence
@@ -354,36 +765,44 @@ void FTPManager::_burstReadFileTimeout(void)
     }
 }
 
-void FTPManager::_fillMissingBlocksWorker(bool firstRequest)
+/// Keeps up to _windowSize reads of missing data outstanding at the same time
+void FTPManager::_fillMissingBlocksWindow(void)
 {
-    if (_downloadState.rgMissingData.count()) {
+    while (_rgWindowRequests.count() < _windowSize && _downloadState.rgMissingData.count()) {
         MavlinkFTP::Request request{};
         MissingData_t&      missingData = _downloadState.rgMissingData.first();
 
         uint32_t cBytesToRead = qMin((uint32_t)sizeof(request.data), missingData.cBytesMissing);
 
-        qCDebug(FTPManagerLog) << "_fillMissingBlocksBegin: offset:cBytesToRead" << missingData.offset << cBytesToRead;
+        qCDebug(FTPManagerLog) << "_fillMissingBlocksWindow: offset:cBytesToRead" << missingData.offset << cBytesToRead;
 
         request.hdr.session                 = _downloadState.sessionId;
         request.hdr.opcode                  = MavlinkFTP::kCmdReadFile;
         request.hdr.offset                  = missingData.offset;
         request.hdr.size                    = cBytesToRead;
 
-        if (firstRequest) {
-            _downloadState.retryCount = 0;
-        } else {
-            // Must used same sequence number as previous request
-            _expectedIncomingSeqNumber -= 2;
+        WindowRequest_t windowRequest;
+        windowRequest.offset    = missingData.offset;
+        windowRequest.cBytes    = cBytesToRead;
+        windowRequest.sentMsecs = _rttTimer.elapsed();
+
+        missingData.offset          += cBytesToRead;
+        missingData.cBytesMissing   -= cBytesToRead;
+        if (missingData.cBytesMissing == 0) {
+            _downloadState.rgMissingData.takeFirst();
         }
-        _downloadState.expectedOffset = request.hdr.offset;
 
         _sendRequestExpectAck(&request);
-    } else {
+        _rgWindowRequests[_expectedIncomingSeqNumber] = windowRequest;
+        _rttSampleMsecs = -1;
+    }
+
+    if (_rgWindowRequests.isEmpty()) {
         // We should have the full file now
         if (_downloadState.bytesWritten == _downloadState.fileSize) {
             _advanceStateMachine();
         } else {
-            qCDebug(FTPManagerLog) << "_fillMissingBlocksWorker: no missing blocks but file still incomplete - bytesWritten:fileSize" << _downloadState.bytesWritten << _downloadState.fileSize;
+            qCDebug(FTPManagerLog) << "_fillMissingBlocksWindow: no missing blocks but file still incomplete - bytesWritten:fileSize" << _downloadState.bytesWritten << _downloadState.fileSize;
             _downloadComplete(tr("Download failed"));
         }
     }
@@ -391,7 +810,9 @@ void FTPManager::_fillMissingBlocksWorker(bool firstRequest)
 
 void FTPManager::_fillMissingBlocksBegin(void)
 {
-    _fillMissingBlocksWorker(true /* firstRequest */);
+    _downloadState.retryCount = 0;
+    _rgWindowRequests.clear();
+    _fillMissingBlocksWindow();
 }
 
 void FTPManager::_fillMissingBlocksAckOrNak(const MavlinkFTP::Request* ackOrNak)
@@ -402,8 +823,8 @@ void FTPManager::_fillMissingBlocksAckOrNak(const MavlinkFTP::Request* ackOrNak)
         qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Disregarding due to incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
         return;
     }
-    if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
-        qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Disregarding due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
+    if (!_rgWindowRequests.contains(ackOrNak->hdr.seqNumber)) {
+        qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Disregarding due to sequence number which is not outstanding" << ackOrNak->hdr.seqNumber;
         return;
     }
     if (ackOrNak->hdr.session != _downloadState.sessionId) {
@@ -411,21 +832,28 @@ void FTPManager::_fillMissingBlocksAckOrNak(const MavlinkFTP::Request* ackOrNak)
         return;
     }
 
+    WindowRequest_t windowRequest = _rgWindowRequests.take(ackOrNak->hdr.seqNumber);
+
     _ackOrNakTimeoutTimer.stop();
 
     if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
-        qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak: Ack offset:size" << ackOrNak->hdr.offset << ackOrNak->hdr.size;
+        QGC_DEBUG_RATE_LIMITED(FTPManagerLog, _packetLogIntervalMsecs) << "_fillMissingBlocksAckOrNak: Ack offset:size" << ackOrNak->hdr.offset << ackOrNak->hdr.size;
 
-        if (ackOrNak->hdr.offset != _downloadState.expectedOffset) {
+        MissingData_t missingData;
+        missingData.offset          = windowRequest.offset;
+        missingData.cBytesMissing   = windowRequest.cBytes;
+
+        if (ackOrNak->hdr.offset != windowRequest.offset || ackOrNak->hdr.size == 0 || ackOrNak->hdr.size > windowRequest.cBytes) {
             if (++_downloadState.retryCount > _maxRetry) {
                 qCDebug(FTPManagerLog) << QString("_fillMissingBlocksAckOrNak: offset mismatch, retries exceeded");
                 _downloadComplete(tr("Download failed"));
                 return;
             }
 
-            // Ask for current offset again
-            qCDebug(FTPManagerLog) << QString("_fillMissingBlocksAckOrNak: Ack offset mismatch retry, retryCount(%1) offset(%2)").arg(_downloadState.retryCount).arg(_downloadState.expectedOffset);
-            _fillMissingBlocksWorker(false /* firstReqeust */);
+            // Ask for this block again
+            qCDebug(FTPManagerLog) << QString("_fillMissingBlocksAckOrNak: Ack offset mismatch retry, retryCount(%1) offset(%2)").arg(_downloadState.retryCount).arg(windowRequest.offset);
+            _downloadState.rgMissingData.prepend(missingData);
+            _fillMissingBlocksWindow();
             return;
         }
 
@@ -436,21 +864,22 @@ void FTPManager::_fillMissingBlocksAckOrNak(const MavlinkFTP::Request* ackOrNak)
             return;
         }
         _downloadState.bytesWritten += ackOrNak->hdr.size;
+        _downloadState.retryCount   = 0;
 
-        MissingData_t& missingData = _downloadState.rgMissingData.first();
-        missingData.offset += ackOrNak->hdr.size;
-        missingData.cBytesMissing -= ackOrNak->hdr.size;
-        if (missingData.cBytesMissing == 0) {
-            // This block is finished, remove it
-            _downloadState.rgMissingData.takeFirst();
+        if (ackOrNak->hdr.size < windowRequest.cBytes) {
+            // Short read, the rest of the block is still missing
+            missingData.offset          += ackOrNak->hdr.size;
+            missingData.cBytesMissing   -= ackOrNak->hdr.size;
+            _downloadState.rgMissingData.prepend(missingData);
         }
 
-        if (_downloadState.fileSize != 0) {
-            emit commandProgress(100 * ((float)(_downloadState.bytesWritten) / (float)_downloadState.fileSize));
-        }
+        _emitDownloadProgress();
 
-        // Move on to fill in possible next hole
-        _fillMissingBlocksWorker(true /* firstReqeust */);
+        // Keep the window full
+        if (_rgWindowRequests.count()) {
+            _ackOrNakTimeoutTimer.start();
+        }
+        _fillMissingBlocksWindow();
     } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
         MavlinkFTP::ErrorCode_t errorCode = static_cast<MavlinkFTP::ErrorCode_t>(ackOrNak->data[0]);
 
@@ -458,6 +887,7 @@ void FTPManager::_fillMissingBlocksAckOrNak(const MavlinkFTP::Request* ackOrNak)
             qCDebug(FTPManagerLog) << "_fillMissingBlocksAckOrNak EOF";
             if (_downloadState.bytesWritten == _downloadState.fileSize) {
                 // We've successfully complete filling in all missing blocks
+                _rgWindowRequests.clear();
                 _advanceStateMachine();
                 return;
             }
@@ -475,9 +905,10 @@ void FTPManager::_fillMissingBlocksTimeout(void)
         qCDebug(FTPManagerLog) << QString("_fillMissingBlocksTimeout retries exceeded");
         _downloadComplete(tr("Download failed"));
     } else {
-        // Ask for current offset again
-        qCDebug(FTPManagerLog) << QString("_fillMissingBlocksTimeout: retrying - retryCount(%1) offset(%2)").arg(_downloadState.retryCount).arg(_downloadState.expectedOffset);
-        _fillMissingBlocksWorker(false /* firstReqeust */);
+        // Only the blocks which are still outstanding are asked for again
+        qCDebug(FTPManagerLog) << QString("_fillMissingBlocksTimeout: retrying - retryCount(%1) outstanding(%2)").arg(_downloadState.retryCount).arg(_rgWindowRequests.count());
+        _requeueWindowRequests(_downloadState.rgMissingData);
+        _fillMissingBlocksWindow();
     }
 }
 
@@ -519,6 +950,329 @@ void FTPManager::_resetSessionsTimeout(void)
     _downloadComplete(QString());
 }
 
+void FTPManager::_createFileBegin(void)
+{
+    MavlinkFTP::Request request{};
+    request.hdr.session = 0;
+    request.hdr.opcode  = MavlinkFTP::kCmdCreateFile;
+    request.hdr.offset  = 0;
+    request.hdr.size    = 0;
+    _fillRequestDataWithString(&request, _uploadState.fullPathOnVehicle);
+    _sendRequestExpectAck(&request);
+}
+
+void FTPManager::_createFileTimeout(void)
+{
+    if (++_uploadState.retryCount > _maxRetry) {
+        qCDebug(FTPManagerLog) << "_createFileTimeout retries exceeded";
+        _uploadComplete(tr("Upload failed"));
+    } else {
+        // Must used same sequence number as previous request
+        qCDebug(FTPManagerLog) << "_createFileTimeout: retrying - retryCount" << _uploadState.retryCount;
+        _expectedIncomingSeqNumber -= 2;
+        _createFileBegin();
+    }
+}
+
+void FTPManager::_createFileAckOrNak(const MavlinkFTP::Request* ackOrNak)
+{
+    MavlinkFTP::OpCode_t requestOpCode = static_cast<MavlinkFTP::OpCode_t>(ackOrNak->hdr.req_opcode);
+    if (requestOpCode != MavlinkFTP::kCmdCreateFile) {
+        qCDebug(FTPManagerLog) << "_createFileAckOrNak: Ack disregarding ack for incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
+        return;
+    }
+    if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
+        qCDebug(FTPManagerLog) << "_createFileAckOrNak: Ack disregarding ack for incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
+        return;
+    }
+
+    _ackOrNakTimeoutTimer.stop();
+
+    if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
+        qCDebug(FTPManagerLog) << "_createFileAckOrNak: Ack - sessionId" << ackOrNak->hdr.session;
+        _uploadState.sessionId = ackOrNak->hdr.session;
+        _advanceStateMachine();
+    } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
+        qCDebug(FTPManagerLog) << "_createFileAckOrNak: Nak -" << _errorMsgFromNak(ackOrNak);
+        _uploadComplete(tr("Upload failed"));
+    }
+}
+
+/// Keeps up to _windowSize writes outstanding at the same time
+void FTPManager::_writeFileWindow(void)
+{
+    while (_rgWindowRequests.count() < _windowSize && _uploadState.rgUnsentData.count()) {
+        MavlinkFTP::Request request{};
+        MissingData_t&      unsentData = _uploadState.rgUnsentData.first();
+
+        uint32_t cBytesToWrite = qMin((uint32_t)sizeof(request.data), unsentData.cBytesMissing);
+
+        qCDebug(FTPManagerLog) << "_writeFileWindow: offset:cBytesToWrite" << unsentData.offset << cBytesToWrite;
+
+        request.hdr.session = _uploadState.sessionId;
+        request.hdr.opcode  = MavlinkFTP::kCmdWriteFile;
+        request.hdr.offset  = unsentData.offset;
+        request.hdr.size    = cBytesToWrite;
+        memcpy(request.data, _uploadState.data.constData() + unsentData.offset, cBytesToWrite);
+
+        WindowRequest_t windowRequest;
+        windowRequest.offset    = unsentData.offset;
+        windowRequest.cBytes    = cBytesToWrite;
+        windowRequest.sentMsecs = _rttTimer.elapsed();
+
+        unsentData.offset           += cBytesToWrite;
+        unsentData.cBytesMissing    -= cBytesToWrite;
+        if (unsentData.cBytesMissing == 0) {
+            _uploadState.rgUnsentData.takeFirst();
+        }
+
+        _sendRequestExpectAck(&request);
+        _rgWindowRequests[_expectedIncomingSeqNumber] = windowRequest;
+        _rttSampleMsecs = -1;
+    }
+
+    if (_rgWindowRequests.isEmpty()) {
+        // Everything has been written
+        _advanceStateMachine();
+    }
+}
+
+void FTPManager::_writeFileBegin(void)
+{
+    _uploadState.retryCount = 0;
+    _rgWindowRequests.clear();
+    _writeFileWindow();
+}
+
+void FTPManager::_writeFileAckOrNak(const MavlinkFTP::Request* ackOrNak)
+{
+    MavlinkFTP::OpCode_t requestOpCode = static_cast<MavlinkFTP::OpCode_t>(ackOrNak->hdr.req_opcode);
+
+    if (requestOpCode != MavlinkFTP::kCmdWriteFile) {
+        qCDebug(FTPManagerLog) << "_writeFileAckOrNak: Disregarding due to incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
+        return;
+    }
+    if (!_rgWindowRequests.contains(ackOrNak->hdr.seqNumber)) {
+        qCDebug(FTPManagerLog) << "_writeFileAckOrNak: Disregarding due to sequence number which is not outstanding" << ackOrNak->hdr.seqNumber;
+        return;
+    }
+    if (ackOrNak->hdr.session != _uploadState.sessionId) {
+        qCDebug(FTPManagerLog) << "_writeFileAckOrNak: Disregarding due to incorrect session id actual:expected" << ackOrNak->hdr.session << _uploadState.sessionId;
+        return;
+    }
+
+    WindowRequest_t windowRequest = _rgWindowRequests.take(ackOrNak->hdr.seqNumber);
+
+    _ackOrNakTimeoutTimer.stop();
+
+    if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
+        qCDebug(FTPManagerLog) << "_writeFileAckOrNak: Ack offset:size" << windowRequest.offset << windowRequest.cBytes;
+
+        _uploadState.bytesAcked += windowRequest.cBytes;
+        _uploadState.retryCount = 0;
+        if (_uploadState.data.count()) {
+            emit commandProgress(100 * ((float)(_uploadState.bytesAcked) / (float)_uploadState.data.count()));
+        }
+
+        // Keep the window full
+        if (_rgWindowRequests.count()) {
+            _ackOrNakTimeoutTimer.start();
+        }
+        _writeFileWindow();
+    } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
+        qCDebug(FTPManagerLog) << "_writeFileAckOrNak: Nak -" << _errorMsgFromNak(ackOrNak);
+        _uploadComplete(tr("Upload failed"));
+    }
+}
+
+void FTPManager::_writeFileTimeout(void)
+{
+    if (++_uploadState.retryCount > _maxRetry) {
+        qCDebug(FTPManagerLog) << QString("_writeFileTimeout retries exceeded");
+        _uploadComplete(tr("Upload failed"));
+    } else {
+        // Only the writes which are still outstanding are sent again
+        qCDebug(FTPManagerLog) << QString("_writeFileTimeout: retrying - retryCount(%1) outstanding(%2)").arg(_uploadState.retryCount).arg(_rgWindowRequests.count());
+        _requeueWindowRequests(_uploadState.rgUnsentData);
+        _writeFileWindow();
+    }
+}
+
+void FTPManager::_terminateSessionBegin(void)
+{
+    MavlinkFTP::Request request{};
+    request.hdr.session = _uploadState.sessionId;
+    request.hdr.opcode  = MavlinkFTP::kCmdTerminateSession;
+    request.hdr.size    = 0;
+    _sendRequestExpectAck(&request);
+}
+
+void FTPManager::_terminateSessionAckOrNak(const MavlinkFTP::Request* ackOrNak)
+{
+    MavlinkFTP::OpCode_t requestOpCode = static_cast<MavlinkFTP::OpCode_t>(ackOrNak->hdr.req_opcode);
+
+    if (requestOpCode != MavlinkFTP::kCmdTerminateSession) {
+        qCDebug(FTPManagerLog) << "_terminateSessionAckOrNak: Disregarding due to incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
+        return;
+    }
+    if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
+        qCDebug(FTPManagerLog) << "_terminateSessionAckOrNak: Disregarding due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
+        return;
+    }
+
+    _ackOrNakTimeoutTimer.stop();
+
+    if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
+        qCDebug(FTPManagerLog) << "_terminateSessionAckOrNak: Ack";
+        _advanceStateMachine();
+    } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
+        // All writes have been acked, so the file is complete on the vehicle
+        qCDebug(FTPManagerLog) << "_terminateSessionAckOrNak: Nak -" << _errorMsgFromNak(ackOrNak);
+        _uploadComplete(QString());
+    }
+}
+
+void FTPManager::_terminateSessionTimeout(void)
+{
+    qCDebug(FTPManagerLog) << "_terminateSessionTimeout";
+    _uploadComplete(QString());
+}
+
+void FTPManager::_listDirectoryBegin(void)
+{
+    MavlinkFTP::Request request{};
+    request.hdr.session = 0;
+    request.hdr.opcode  = MavlinkFTP::kCmdListDirectory;
+    request.hdr.offset  = _listDirectoryState.expectedOffset;
+    request.hdr.size    = 0;
+    _fillRequestDataWithString(&request, _listDirectoryState.fullPathOnVehicle);
+    _sendRequestExpectAck(&request);
+}
+
+void FTPManager::_listDirectoryAckOrNak(const MavlinkFTP::Request* ackOrNak)
+{
+    MavlinkFTP::OpCode_t requestOpCode = static_cast<MavlinkFTP::OpCode_t>(ackOrNak->hdr.req_opcode);
+
+    if (requestOpCode != MavlinkFTP::kCmdListDirectory) {
+        qCDebug(FTPManagerLog) << "_listDirectoryAckOrNak: Disregarding due to incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
+        return;
+    }
+    if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
+        qCDebug(FTPManagerLog) << "_listDirectoryAckOrNak: Disregarding due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
+        return;
+    }
+
+    _ackOrNakTimeoutTimer.stop();
+
+    if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
+        // Null separated entries, skipped entries only count towards the offset
+        int         entryCount  = 0;
+        const char* data        = reinterpret_cast<const char*>(ackOrNak->data);
+        int         size        = qMin(static_cast<int>(ackOrNak->hdr.size), static_cast<int>(sizeof(ackOrNak->data)));
+        int         index       = 0;
+        while (index < size) {
+            int cchEntry = static_cast<int>(strnlen(data + index, static_cast<size_t>(size - index)));
+            if (cchEntry) {
+                QString entry = QString::fromUtf8(data + index, cchEntry);
+                if (!entry.startsWith('S')) {
+                    _listDirectoryState.rgDirectoryList.append(entry);
+                }
+                entryCount++;
+            }
+            index += cchEntry + 1;
+        }
+
+        qCDebug(FTPManagerLog) << "_listDirectoryAckOrNak: Ack offset:entryCount" << _listDirectoryState.expectedOffset << entryCount;
+
+        if (entryCount == 0) {
+            _advanceStateMachine();
+        } else {
+            _listDirectoryState.expectedOffset  += static_cast<uint32_t>(entryCount);
+            _listDirectoryState.retryCount      = 0;
+            _listDirectoryBegin();
+        }
+    } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
+        MavlinkFTP::ErrorCode_t errorCode = static_cast<MavlinkFTP::ErrorCode_t>(ackOrNak->data[0]);
+
+        if (errorCode == MavlinkFTP::kErrEOF) {
+            qCDebug(FTPManagerLog) << "_listDirectoryAckOrNak EOF";
+            _advanceStateMachine();
+        } else {
+            qCDebug(FTPManagerLog) << "_listDirectoryAckOrNak: Nak -" << _errorMsgFromNak(ackOrNak);
+            _listDirectoryComplete(tr("List directory failed"));
+        }
+    }
+}
+
+void FTPManager::_listDirectoryTimeout(void)
+{
+    if (++_listDirectoryState.retryCount > _maxRetry) {
+        qCDebug(FTPManagerLog) << "_listDirectoryTimeout retries exceeded";
+        _listDirectoryComplete(tr("List directory failed"));
+    } else {
+        // Must used same sequence number as previous request
+        qCDebug(FTPManagerLog) << "_listDirectoryTimeout: retrying - retryCount" << _listDirectoryState.retryCount;
+        _expectedIncomingSeqNumber -= 2;
+        _listDirectoryBegin();
+    }
+}
+
+void FTPManager::_calcFileCRC32Begin(void)
+{
+    MavlinkFTP::Request request{};
+    request.hdr.session = 0;
+    request.hdr.opcode  = MavlinkFTP::kCmdCalcFileCRC32;
+    request.hdr.offset  = 0;
+    request.hdr.size    = 0;
+    _fillRequestDataWithString(&request, _crc32State.fullPathOnVehicle);
+    _sendRequestExpectAck(&request);
+}
+
+void FTPManager::_calcFileCRC32AckOrNak(const MavlinkFTP::Request* ackOrNak)
+{
+    MavlinkFTP::OpCode_t requestOpCode = static_cast<MavlinkFTP::OpCode_t>(ackOrNak->hdr.req_opcode);
+
+    if (requestOpCode != MavlinkFTP::kCmdCalcFileCRC32) {
+        qCDebug(FTPManagerLog) << "_calcFileCRC32AckOrNak: Disregarding due to incorrect requestOpCode" << MavlinkFTP::opCodeToString(requestOpCode);
+        return;
+    }
+    if (ackOrNak->hdr.seqNumber != _expectedIncomingSeqNumber) {
+        qCDebug(FTPManagerLog) << "_calcFileCRC32AckOrNak: Disregarding due to incorrect sequence actual:expected" << ackOrNak->hdr.seqNumber << _expectedIncomingSeqNumber;
+        return;
+    }
+
+    _ackOrNakTimeoutTimer.stop();
+
+    if (ackOrNak->hdr.opcode == MavlinkFTP::kRspAck) {
+        if (ackOrNak->hdr.size < static_cast<uint8_t>(sizeof(uint32_t))) {
+            qCDebug(FTPManagerLog) << "_calcFileCRC32AckOrNak: Ack size too small" << ackOrNak->hdr.size;
+            _calcFileCRC32Complete(tr("CRC32 failed"));
+            return;
+        }
+        memcpy(&_crc32State.crc, ackOrNak->data, sizeof(uint32_t));
+        qCDebug(FTPManagerLog) << "_calcFileCRC32AckOrNak: Ack crc" << QString::number(_crc32State.crc, 16);
+        _advanceStateMachine();
+    } else if (ackOrNak->hdr.opcode == MavlinkFTP::kRspNak) {
+        qCDebug(FTPManagerLog) << "_calcFileCRC32AckOrNak: Nak -" << _errorMsgFromNak(ackOrNak);
+        _calcFileCRC32Complete(tr("CRC32 failed"));
+    }
+}
+
+void FTPManager::_calcFileCRC32Timeout(void)
+{
+    // The vehicle reads the whole file before it answers, which takes longer than a round trip for larger files.
+    // The request is repeated with the same sequence number until _crc32TimeoutMsecs, a vehicle which is done by then
+    // answers the repeat with its last reply.
+    if (_rttTimer.elapsed() - _crc32State.sentMsecs > _crc32TimeoutMsecs) {
+        qCDebug(FTPManagerLog) << "_calcFileCRC32Timeout: timed out";
+        _calcFileCRC32Complete(tr("CRC32 failed"));
+    } else {
+        qCDebug(FTPManagerLog) << "_calcFileCRC32Timeout: retrying";
+        _expectedIncomingSeqNumber -= 2;
+        _calcFileCRC32Begin();
+    }
+}
+
 void FTPManager::_emitErrorMessage(const QString& msg)
 {
     qCDebug(FTPManagerLog) << "Error:" << msg;
@@ -528,6 +1282,19 @@ void FTPManager::_emitErrorMessage(const QString& msg)
 void FTPManager::_sendRequestExpectAck(MavlinkFTP::Request* request)
 {
     _ackOrNakTimeoutTimer.start();
+
+    request->hdr.seqNumber = _expectedIncomingSeqNumber + 1;    // Outgoing is 1 past last incoming
+    _expectedIncomingSeqNumber += 2;
+
+    // A retry rewinds to the sequence number of the previous request. Its ack can't be told apart from a late ack
+    // of the original request, so it is not used as round trip sample.
+    if (static_cast<uint16_t>(_lastSentSeqNumber - request->hdr.seqNumber) < (std::numeric_limits<uint16_t>::max()/2)) {
+        _rttSampleMsecs = -1;
+    } else {
+        _rttSampleMsecs     = _rttTimer.elapsed();
+        _rttSampleSeqNumber = _expectedIncomingSeqNumber;
+    }
+    _lastSentSeqNumber = request->hdr.seqNumber;
     
     WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
 
@@ -536,9 +1303,6 @@ void FTPManager::_sendRequestExpectAck(MavlinkFTP::Request* request)
     } else {
         SharedLinkInterfacePtr sharedLink = weakLink.lock();
 
-        request->hdr.seqNumber = _expectedIncomingSeqNumber + 1;    // Outgoing is 1 past last incoming
-        _expectedIncomingSeqNumber += 2;
-
         qCDebug(FTPManagerLog) << "_sendRequestExpectAck opcode:" << MavlinkFTP::opCodeToString(static_cast<MavlinkFTP::OpCode_t>(request->hdr.opcode)) << "seqNumber:" << request->hdr.seqNumber;
 
         mavlink_message_t message;
@@ -11,12 +11,15 @@
 
 #include <QObject>
 #include <QDir>
-#include <QTimer>
 #include <QQueue>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMap>
 
 #include "UASInterface.h"
 #include "QGCLoggingCategory.h"
 #include "QGCMAVLink.h"
+#include "QGCTimerWheel.h"
 
 Q_DECLARE_LOGGING_CATEGORY(FTPManagerLog)
 
@@ -35,14 +38,75 @@ public:
     ///     @param fromURI  File to download from vehicle, fully qualified path. May be in the format "mftp://[;comp=<id>]..." where the component id is specified.
     ///                     If component id is not specified MAV_COMP_ID_AUTOPILOT1 is used.
     ///     @param toDir    Local directory to download file to
+    ///     @param fileName Local file name, empty for the name of the file on the vehicle
+    ///     @param resume   Continues after the end of an existing local file, which is also kept if the download fails
     /// @return true: download has started, false: error, no download
-    /// Signals downloadComplete, commandError, commandProgress
-    bool download(const QString& fromURI, const QString& toDir);
+    /// Signals downloadComplete, downloadProgress, commandError, commandProgress
+    bool download(const QString& fromURI, const QString& toDir, const QString& fileName = QString(), bool resume = false);
+
+    /// Stops the download in progress, signals downloadComplete with an error
+    void cancelDownload(void);
+
+    /// Lists the specified directory. Listings are cached, an upload drops the cached listing of its directory.
+    ///     @param fromURI  Directory on the vehicle, same format as download fromURI
+    ///     @param useCache true: An earlier listing of the directory is signalled again without asking the vehicle
+    /// @return true: listing has started, false: error
+    /// Signals listDirectoryComplete
+    bool listDirectory(const QString& fromURI, bool useCache = false);
+
+    /// Drops the cached listings, for files the vehicle changed on its own
+    void clearDirectoryCache(void) { _directoryCache.clear(); }
+
+    /// Uploads the specified file.
+    ///     @param toURI    File to upload to on the vehicle, fully qualified path. Same format as download fromURI.
+    ///     @param fromFile Local file to upload
+    /// @return true: upload has started, false: error, no upload
+    /// Signals uploadComplete, commandError, commandProgress
+    bool upload(const QString& toURI, const QString& fromFile);
+
+    /// Calculates the CRC32 of a file on the vehicle
+    ///     @param fileURI  File on the vehicle, same format as download fromURI
+    /// @return true: calculation has started, false: error
+    /// Signals calcFileCRC32Complete
+    bool calcFileCRC32(const QString& fileURI);
+
+    /// @return false: The file can't be read. crc is the CRC32 the way the vehicle calculates it for calcFileCRC32.
+    static bool fileCRC32(const QString& localFile, quint32& crc);
+
+    /// Queued transfers run one after the other, whenever no other operation is in progress. They signal
+    /// downloadComplete and uploadComplete like any other transfer, followed by jobComplete.
+    ///     @param skipUnchanged true: The file isn't uploaded if the file on the vehicle has the same CRC32
+    void queueDownload  (const QString& fromURI, const QString& toDir, const QString& fileName = QString());
+    void queueUpload    (const QString& toURI, const QString& fromFile, bool skipUnchanged = true);
+
+    /// Drops the queued transfers, the one in progress is finished
+    void cancelJobs     (void);
+
+    /// @return Queued transfers, including the one in progress
+    int  jobCount       (void) const { return _jobQueue.count(); }
+
+    /// @return Current ack/nak timeout, follows the measured round trip time of requests
+    int ackOrNakTimeoutMsecs(void) const { return _ackOrNakTimeoutTimer.interval(); }
 
     static const char* mavlinkFTPScheme;
 
 signals:
     void downloadComplete(const QString& file, const QString& errorMsg);
+    void uploadComplete  (const QString& file, const QString& errorMsg);
+
+    /// @param dirList Entries as sent by the vehicle: "F<name>\t<size>" for files, "D<name>" for directories
+    void listDirectoryComplete(const QStringList& dirList, const QString& errorMsg);
+
+    void calcFileCRC32Complete(const QString& file, quint32 crc, const QString& errorMsg);
+
+    /// @param skipped true: An upload which wasn't needed since the file on the vehicle is the same
+    void jobComplete        (const QString& uri, const QString& errorMsg, bool skipped);
+    /// Signalled once the queue is empty
+    ///     @param failedJobs Jobs which failed since the queue was last empty
+    void jobQueueComplete   (int failedJobs);
+
+    /// Bytes of the file which are on disk, including those of a resumed download
+    void downloadProgress(quint32 bytesWritten, quint32 fileSize);
     
     // Signals associated with all commands
     
@@ -85,6 +149,7 @@ private:
         uint32_t                fileSize;               ///< Size of file being downloaded
         QFile                   file;
         int                     retryCount;
+        bool                    resume;                 ///< Continue after an existing local file, keep it on failure
 
         void reset() {
             sessionId       = 0;
@@ -92,6 +157,7 @@ private:
             bytesWritten    = 0;
             retryCount      = 0;
             fileSize        = 0;
+            resume          = false;
             fullPathOnVehicle.clear();
             fileName.clear();
             rgMissingData.clear();
@@ -99,6 +165,73 @@ private:
         }
     } DownloadState_t;
 
+    typedef struct {
+        QString                 fullPathOnVehicle;      ///< Fully qualified path to directory on vehicle
+        QStringList             rgDirectoryList;
+        uint32_t                expectedOffset;         ///< Index of the next entry, skipped entries included
+        int                     retryCount;
+
+        void reset() {
+            expectedOffset  = 0;
+            retryCount      = 0;
+            fullPathOnVehicle.clear();
+            rgDirectoryList.clear();
+        }
+    } ListDirectoryState_t;
+
+    typedef struct {
+        uint8_t                 sessionId;
+        uint32_t                bytesAcked;
+        QList<MissingData_t>    rgUnsentData;           ///< Data which has not been written yet or needs to be written again
+        QString                 fullPathOnVehicle;      ///< Fully qualified path to file on vehicle
+        QString                 localFile;              ///< Local file being uploaded
+        QByteArray              data;                   ///< Contents of local file
+        int                     retryCount;
+
+        void reset() {
+            sessionId       = 0;
+            bytesAcked      = 0;
+            retryCount      = 0;
+            fullPathOnVehicle.clear();
+            localFile.clear();
+            data.clear();
+            rgUnsentData.clear();
+        }
+    } UploadState_t;
+
+    typedef struct {
+        QString                 fullPathOnVehicle;      ///< Fully qualified path to file on vehicle
+        quint32                 crc;
+        qint64                  sentMsecs;              ///< Of the first request, retries go on until _crc32TimeoutMsecs
+
+        void reset() {
+            crc         = 0;
+            sentMsecs   = 0;
+            fullPathOnVehicle.clear();
+        }
+    } CRC32State_t;
+
+    typedef enum {
+        JobDownload,
+        JobUpload,
+    } JobType_t;
+
+    typedef struct {
+        JobType_t               type;
+        QString                 uri;
+        QString                 localPath;              ///< Directory to download to, or file to upload
+        QString                 fileName;               ///< Local file name of a download
+        bool                    skipUnchanged;
+        bool                    crcChecked;             ///< The CRC32 of the file on the vehicle was asked for
+    } Job_t;
+
+    /// Read or write request which is outstanding within the window of pipelined requests
+    typedef struct {
+        uint32_t    offset;
+        uint32_t    cBytes;
+        qint64      sentMsecs;
+    } WindowRequest_t;
+
 
     void    _mavlinkMessageReceived     (const mavlink_message_t& message);
     void    _startStateMachine          (void);
@@ -115,25 +248,76 @@ private:
     void    _resetSessionsBegin         (void);
     void    _resetSessionsAckOrNak      (const MavlinkFTP::Request* ackOrNak);
     void    _resetSessionsTimeout       (void);
+    void    _createFileBegin            (void);
+    void    _createFileAckOrNak         (const MavlinkFTP::Request* ackOrNak);
+    void    _createFileTimeout          (void);
+    void    _writeFileBegin             (void);
+    void    _writeFileAckOrNak          (const MavlinkFTP::Request* ackOrNak);
+    void    _writeFileTimeout           (void);
+    void    _terminateSessionBegin      (void);
+    void    _terminateSessionAckOrNak   (const MavlinkFTP::Request* ackOrNak);
+    void    _terminateSessionTimeout    (void);
+    void    _listDirectoryBegin         (void);
+    void    _listDirectoryAckOrNak      (const MavlinkFTP::Request* ackOrNak);
+    void    _listDirectoryTimeout       (void);
+    void    _calcFileCRC32Begin         (void);
+    void    _calcFileCRC32AckOrNak      (const MavlinkFTP::Request* ackOrNak);
+    void    _calcFileCRC32Timeout       (void);
     QString _errorMsgFromNak            (const MavlinkFTP::Request* nak);
     void    _sendRequestExpectAck       (MavlinkFTP::Request* request);
     void    _downloadCompleteNoError    (void) { _downloadComplete(QString()); }
     void    _downloadComplete           (const QString& errorMsg);
+    void    _uploadCompleteNoError      (void) { _uploadComplete(QString()); }
+    void    _uploadComplete             (const QString& errorMsg);
+    void    _listDirectoryCompleteNoError(void) { _listDirectoryComplete(QString()); }
+    void    _listDirectoryComplete      (const QString& errorMsg);
+    void    _calcFileCRC32CompleteNoError(void) { _calcFileCRC32Complete(QString()); }
+    void    _calcFileCRC32Complete      (const QString& errorMsg);
+    void    _operationComplete          (const QString& errorMsg);
+    void    _runJobQueue                (void);
+    void    _jobComplete                (const QString& errorMsg, bool skipped);
+    void    _emitDownloadProgress       (void);
     void    _emitErrorMessage           (const QString& msg);
     void    _fillRequestDataWithString(MavlinkFTP::Request* request, const QString& str);
-    void    _fillMissingBlocksWorker    (bool firstRequest);
+    void    _fillMissingBlocksWindow    (void);
+    void    _writeFileWindow            (void);
+    void    _requeueWindowRequests      (QList<MissingData_t>& rgData);
     void    _burstReadFileWorker        (bool firstRequest);
+    void    _sampleRoundTrip            (qint64 sentMsecs);
     bool    _parseURI                   (const QString& uri, QString& parsedURI, uint8_t& compId);
 
+    static QString _directoryCacheKey   (uint8_t compId, const QString& path);
+
     Vehicle*                _vehicle;
     uint8_t                 _ftpCompId = MAV_COMP_ID_AUTOPILOT1;
     QList<StateFunctions_t> _rgStateMachine;
     DownloadState_t         _downloadState;
-    QTimer                  _ackOrNakTimeoutTimer;
+    UploadState_t           _uploadState;
+    ListDirectoryState_t    _listDirectoryState;
+    CRC32State_t            _crc32State;
+    QGCWheelTimer           _ackOrNakTimeoutTimer   { "FTPManager" };
     int                     _currentStateMachineIndex   = -1;
     uint16_t                _expectedIncomingSeqNumber  = 0;
-    
-    static const int _ackOrNakTimeoutMsecs  = 1000;
-    static const int _maxRetry              = 3;
+
+    QMap<uint16_t, WindowRequest_t> _rgWindowRequests;  ///< Outstanding pipelined requests keyed by the sequence number of their ack/nak
+    QElapsedTimer           _rttTimer;
+    qint64                  _rttSampleMsecs             = -1;   ///< Send time of the request being timed, -1 for none
+    uint16_t                _rttSampleSeqNumber         = 0;    ///< Ack/nak sequence number of the request being timed
+    uint16_t                _lastSentSeqNumber          = 0;
+    double                  _roundTripMsecs             = -1;   ///< Smoothed round trip time, -1 until the first sample
+    double                  _roundTripVarMsecs          = 0;
+
+    QHash<QString, QStringList> _directoryCache;            ///< Listings by _directoryCacheKey
+    QQueue<Job_t>           _jobQueue;                      ///< The head is the job in progress while _jobRunning
+    bool                    _jobRunning                 = false;
+    int                     _failedJobs                 = 0;
+
+    static const int _ackOrNakTimeoutMsecs      = 1000;     ///< Timeout until the first round trip has been measured
+    static const int _minAckOrNakTimeoutMsecs   = 250;
+    static const int _maxAckOrNakTimeoutMsecs   = 5000;
+    static const int _maxRetry                  = 3;
+    static const int _windowSize                = 4;        ///< Maximum number of outstanding read/write requests when filling gaps and uploading
+    static const int _packetLogIntervalMsecs    = 250;      ///< Rate limit for logging which happens for every packet of a transfer
+    static const int _crc32TimeoutMsecs         = 5000;     ///< The vehicle reads the whole file before it answers
 };
 
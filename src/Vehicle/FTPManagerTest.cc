@@ -120,6 +120,252 @@ void FTPManagerTest::_testLostPackets(void)
     _disconnectMockLink();
 }
 
+void FTPManagerTest::_uploadWorker(bool randomDrops)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    FTPManager* ftpManager  = _vehicle->ftpManager();
+    int         fileSize    = 3 * 1024 + 7;
+    QString     filename    = QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).absoluteFilePath("FTPManagerTestUpload.bin");
+
+    QFile file(filename);
+    QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+    for (int i=0; i<fileSize; i++) {
+        file.write(QByteArray(1, i % 255));
+    }
+    file.close();
+
+    QSignalSpy spyUploadComplete(ftpManager, &FTPManager::uploadComplete);
+
+    _mockLink->mockLinkFTP()->enableRandromDrops(randomDrops);
+    QVERIFY(ftpManager->upload("/fs/microsd/upload.bin", filename));
+
+    QCOMPARE(spyUploadComplete.wait(10000), true);
+    QCOMPARE(spyUploadComplete.count(), 1);
+
+    // void uploadComplete(const QString& file, const QString& errorMsg);
+    QList<QVariant> arguments = spyUploadComplete.takeFirst();
+    QCOMPARE(arguments[0].toString(), filename);
+    QVERIFY(arguments[1].toString().isEmpty());
+
+    QFile::remove(filename);
+    _verifyFileSizeAndDelete(_mockLink->mockLinkFTP()->uploadFileName(), fileSize);
+
+    _disconnectMockLink();
+}
+
+void FTPManagerTest::_testUpload(void)
+{
+    _uploadWorker(false /* randomDrops */);
+}
+
+void FTPManagerTest::_testUploadLostPackets(void)
+{
+    _uploadWorker(true /* randomDrops */);
+}
+
+void FTPManagerTest::_testListDirectory(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    FTPManager* ftpManager = _vehicle->ftpManager();
+
+    QSignalSpy spyListDirectoryComplete(ftpManager, &FTPManager::listDirectoryComplete);
+
+    // void listDirectoryComplete(const QStringList& dirList, const QString& errorMsg);
+    QVERIFY(ftpManager->listDirectory(MockLinkFTP::logDirectory));
+    QCOMPARE(spyListDirectoryComplete.wait(10000), true);
+    QList<QVariant> arguments = spyListDirectoryComplete.takeFirst();
+    QVERIFY(arguments[1].toString().isEmpty());
+    QStringList dirList = arguments[0].toStringList();
+    QCOMPARE(dirList.count(), 1);
+    QVERIFY(dirList[0].startsWith('D'));
+
+    const QString dateDirectory = QStringLiteral("%1/%2").arg(MockLinkFTP::logDirectory, dirList[0].mid(1));
+    QVERIFY(ftpManager->listDirectory(dateDirectory));
+    QCOMPARE(spyListDirectoryComplete.wait(10000), true);
+    arguments = spyListDirectoryComplete.takeFirst();
+    QVERIFY(arguments[1].toString().isEmpty());
+    dirList = arguments[0].toStringList();
+    QCOMPARE(dirList.count(), static_cast<int>(MockLinkFTP::mockLogCount));
+    for (int i=0; i<dirList.count(); i++) {
+        QCOMPARE(dirList[i], QStringLiteral("F%1\t%2").arg(QFileInfo(MockLinkFTP::mockLogPath(i)).fileName()).arg(MockLinkFTP::mockLogSize(i)));
+    }
+
+    _disconnectMockLink();
+}
+
+void FTPManagerTest::_testResume(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    FTPManager* ftpManager  = _vehicle->ftpManager();
+    int         fileSize    = MockLinkFTP::mockLogSize(0);
+    int         partialSize = fileSize / 2;
+    QString     tempDir     = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+    QString     fileName    = QStringLiteral("FTPManagerTestResume.part");
+
+    // Partial file from an earlier download
+    QFile file(QDir(tempDir).absoluteFilePath(fileName));
+    QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+    for (int i=0; i<partialSize; i++) {
+        file.write(QByteArray(1, i % 255));
+    }
+    file.close();
+
+    QSignalSpy spyDownloadComplete(ftpManager, &FTPManager::downloadComplete);
+
+    QVERIFY(ftpManager->download(MockLinkFTP::mockLogPath(0), tempDir, fileName, true /* resume */));
+    QCOMPARE(spyDownloadComplete.wait(10000), true);
+    QCOMPARE(spyDownloadComplete.count(), 1);
+
+    // void downloadComplete   (const QString& file, const QString& errorMsg);
+    QList<QVariant> arguments = spyDownloadComplete.takeFirst();
+    QVERIFY(arguments[1].toString().isEmpty());
+
+    _verifyFileSizeAndDelete(arguments[0].toString(), fileSize);
+
+    _disconnectMockLink();
+}
+
+void FTPManagerTest::_testListDirectoryCache(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    FTPManager*     ftpManager  = _vehicle->ftpManager();
+    MockLinkFTP*    mockLinkFTP = _mockLink->mockLinkFTP();
+    const QString   logDir      = MockLinkFTP::logDirectory;
+
+    QSignalSpy spyListDirectoryComplete(ftpManager, &FTPManager::listDirectoryComplete);
+
+    // Nothing cached yet, the vehicle is asked
+    int listCommandCount = mockLinkFTP->listCommandCount();
+    QVERIFY(ftpManager->listDirectory(logDir, true /* useCache */));
+    QCOMPARE(spyListDirectoryComplete.wait(10000), true);
+    QList<QVariant> arguments = spyListDirectoryComplete.takeFirst();
+    QVERIFY(arguments[1].toString().isEmpty());
+    QStringList dirList = arguments[0].toStringList();
+    QVERIFY(mockLinkFTP->listCommandCount() > listCommandCount);
+
+    // Cached, with or without trailing slash
+    listCommandCount = mockLinkFTP->listCommandCount();
+    for (const QString& dir: { logDir, logDir + QStringLiteral("/") }) {
+        QVERIFY(ftpManager->listDirectory(dir, true /* useCache */));
+        QCOMPARE(spyListDirectoryComplete.wait(10000), true);
+        arguments = spyListDirectoryComplete.takeFirst();
+        QVERIFY(arguments[1].toString().isEmpty());
+        QCOMPARE(arguments[0].toStringList(), dirList);
+    }
+    QCOMPARE(mockLinkFTP->listCommandCount(), listCommandCount);
+
+    // An upload into the directory drops its listing
+    QString     filename = QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).absoluteFilePath("FTPManagerTestCache.bin");
+    QSignalSpy  spyUploadComplete(ftpManager, &FTPManager::uploadComplete);
+    _writeTestFile(filename, 100);
+    QVERIFY(ftpManager->upload(QStringLiteral("%1/cache.bin").arg(logDir), filename));
+    QCOMPARE(spyUploadComplete.wait(10000), true);
+    QFile::remove(filename);
+    QFile::remove(mockLinkFTP->uploadFileName());
+
+    QVERIFY(ftpManager->listDirectory(logDir, true /* useCache */));
+    QCOMPARE(spyListDirectoryComplete.wait(10000), true);
+    QVERIFY(mockLinkFTP->listCommandCount() > listCommandCount);
+
+    _disconnectMockLink();
+}
+
+void FTPManagerTest::_testCalcFileCRC32(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    FTPManager* ftpManager  = _vehicle->ftpManager();
+    QString     filename    = QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).absoluteFilePath("FTPManagerTestCRC.bin");
+
+    _writeTestFile(filename, 1000);
+    quint32 localCRC;
+    QVERIFY(FTPManager::fileCRC32(filename, localCRC));
+
+    QSignalSpy spyUploadComplete        (ftpManager, &FTPManager::uploadComplete);
+    QSignalSpy spyCalcFileCRC32Complete (ftpManager, &FTPManager::calcFileCRC32Complete);
+
+    QVERIFY(ftpManager->upload("/fs/microsd/crc.bin", filename));
+    QCOMPARE(spyUploadComplete.wait(10000), true);
+
+    // void calcFileCRC32Complete(const QString& file, quint32 crc, const QString& errorMsg);
+    QVERIFY(ftpManager->calcFileCRC32("/fs/microsd/crc.bin"));
+    QCOMPARE(spyCalcFileCRC32Complete.wait(10000), true);
+    QList<QVariant> arguments = spyCalcFileCRC32Complete.takeFirst();
+    QVERIFY(arguments[2].toString().isEmpty());
+    QCOMPARE(arguments[1].toUInt(), localCRC);
+
+    // Not on the vehicle
+    QVERIFY(ftpManager->calcFileCRC32("/fs/microsd/FTPManagerTestMissing.bin"));
+    QCOMPARE(spyCalcFileCRC32Complete.wait(10000), true);
+    arguments = spyCalcFileCRC32Complete.takeFirst();
+    QVERIFY(!arguments[2].toString().isEmpty());
+
+    QFile::remove(filename);
+    QFile::remove(_mockLink->mockLinkFTP()->uploadFileName());
+
+    _disconnectMockLink();
+}
+
+void FTPManagerTest::_testJobQueue(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    FTPManager* ftpManager  = _vehicle->ftpManager();
+    int         fileSize    = 2 * 1024 + 3;
+    QString     tempDir     = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+    QString     filename    = QDir(tempDir).absoluteFilePath("FTPManagerTestJob.bin");
+    QString     vehicleFile = QStringLiteral("/fs/microsd/FTPManagerTestJob.bin");
+
+    // Left over from an earlier run the upload would be skipped
+    QFile::remove(QDir(tempDir).absoluteFilePath("MockLinkFTPUpload-FTPManagerTestJob.bin"));
+    _writeTestFile(filename, fileSize);
+
+    QSignalSpy spyUploadComplete    (ftpManager, &FTPManager::uploadComplete);
+    QSignalSpy spyJobComplete       (ftpManager, &FTPManager::jobComplete);
+    QSignalSpy spyJobQueueComplete  (ftpManager, &FTPManager::jobQueueComplete);
+
+    // Uploaded, skipped the second time since it is unchanged, then a download
+    ftpManager->queueUpload(vehicleFile, filename);
+    ftpManager->queueUpload(vehicleFile, filename);
+    ftpManager->queueDownload(MockLinkFTP::mockLogPath(0), tempDir, QStringLiteral("FTPManagerTestJob.log"));
+    QCOMPARE(ftpManager->jobCount(), 3);
+
+    // void jobQueueComplete(int failedJobs);
+    QCOMPARE(spyJobQueueComplete.wait(10000), true);
+    QCOMPARE(spyJobQueueComplete.takeFirst()[0].toInt(), 0);
+    QCOMPARE(ftpManager->jobCount(), 0);
+    QCOMPARE(spyUploadComplete.count(), 1);
+
+    // void jobComplete(const QString& uri, const QString& errorMsg, bool skipped);
+    QCOMPARE(spyJobComplete.count(), 3);
+    const bool rgSkipped[] = { false, true, false };
+    for (bool skipped: rgSkipped) {
+        QList<QVariant> arguments = spyJobComplete.takeFirst();
+        QVERIFY(arguments[1].toString().isEmpty());
+        QCOMPARE(arguments[2].toBool(), skipped);
+    }
+
+    QFile::remove(filename);
+    _verifyFileSizeAndDelete(_mockLink->mockLinkFTP()->uploadFileName(), fileSize);
+    _verifyFileSizeAndDelete(QDir(tempDir).absoluteFilePath("FTPManagerTestJob.log"), MockLinkFTP::mockLogSize(0));
+
+    _disconnectMockLink();
+}
+
+void FTPManagerTest::_writeTestFile(const QString& filename, int size)
+{
+    QFile file(filename);
+    QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+    for (int i=0; i<size; i++) {
+        file.write(QByteArray(1, i % 255));
+    }
+    file.close();
+}
+
 void FTPManagerTest::_verifyFileSizeAndDelete(const QString& filename, int expectedSize)
 {
     QFileInfo fileInfo(filename);
@@ -19,6 +19,13 @@ private slots:
     void _performSizeBasedTestCases (void);
     void _performTestCases          (void);
     void _testLostPackets           (void);
+    void _testUpload                (void);
+    void _testUploadLostPackets     (void);
+    void _testListDirectory         (void);
+    void _testResume                (void);
+    void _testListDirectoryCache    (void);
+    void _testCalcFileCRC32         (void);
+    void _testJobQueue              (void);
 
     // Overrides from UnitTest
     void cleanup(void) override;
@@ -30,7 +37,9 @@ private:
 
     void _testCaseWorker            (const TestCase_t& testCase);
     void _sizeTestCaseWorker        (int fileSize);
+    void _uploadWorker              (bool randomDrops);
     void _verifyFileSizeAndDelete   (const QString& filename, int expectedSize);
+    void _writeTestFile             (const QString& filename, int size);
 
     static const TestCase_t _rgTestCases[];
 };
@@ -21,11 +21,8 @@ QGC_LOGGING_CATEGORY(InitialConnectStateMachineLog, "InitialConnectStateMachineL
 const StateMachine::StateFn InitialConnectStateMachine::_rgStates[] = {
     InitialConnectStateMachine::_stateRequestCapabilities,
     InitialConnectStateMachine::_stateRequestProtocolVersion,
-    InitialConnectStateMachine::_stateRequestCompInfo,
-    InitialConnectStateMachine::_stateRequestParameters,
-    InitialConnectStateMachine::_stateRequestMission,
-    InitialConnectStateMachine::_stateRequestGeoFence,
-    InitialConnectStateMachine::_stateRequestRallyPoints,
+    InitialConnectStateMachine::_stateRequestCompInfoAndParameters,
+    InitialConnectStateMachine::_stateRequestPlan,
     InitialConnectStateMachine::_stateSignalInitialConnectComplete
 };
 
@@ -52,21 +49,96 @@ void InitialConnectStateMachine::statesCompleted(void) const
 
 }
 
+const char* InitialConnectStateMachine::_stageName(Stage_t stage)
+{
+    switch (stage) {
+    case StageCapabilities:
+        return "Capabilities";
+    case StageProtocolVersion:
+        return "ProtocolVersion";
+    case StageCompInfo:
+        return "CompInfo";
+    case StageParameters:
+        return "Parameters";
+    case StageMission:
+        return "Mission";
+    case StageGeoFence:
+        return "GeoFence";
+    case StageRallyPoints:
+        return "RallyPoints";
+    case StageCount:
+        break;
+    }
+    return "Unknown";
+}
+
+void InitialConnectStateMachine::_startStage(Stage_t stage)
+{
+    qCDebug(InitialConnectStateMachineLog) << "Stage started" << _stageName(stage) << "at msecs" << _connectTimer.elapsed();
+    _stageTimers[stage].start();
+}
+
+void InitialConnectStateMachine::stageComplete(Stage_t stage)
+{
+    if (!_active || _stageCompleted[stage] || !_stageTimers[stage].isValid()) {
+        // Late or duplicate completion, or a reload after the initial connect sequence
+        return;
+    }
+    _stageCompleted[stage] = true;
+    qCDebug(InitialConnectStateMachineLog) << "Stage complete" << _stageName(stage) << "msecs" << _stageTimers[stage].elapsed();
+
+    switch (stage) {
+    case StageCapabilities:
+    case StageProtocolVersion:
+        advance();
+        break;
+    case StageCompInfo:
+        // Parameters which arrived before their metadata are rebound here, the parameter stage can now complete
+        _vehicle->_parameterManager->setMetaDataPending(false);
+        if (_stageCompleted[StageParameters]) {
+            advance();
+        }
+        break;
+    case StageParameters:
+        if (_stageCompleted[StageCompInfo]) {
+            advance();
+        }
+        break;
+    case StageMission:
+    case StageGeoFence:
+    case StageRallyPoints:
+        _activePlanRequests--;
+        if (_stageCompleted[StageMission] && _stageCompleted[StageGeoFence] && _stageCompleted[StageRallyPoints]) {
+            _vehicle->_initialPlanRequestComplete = true;
+            emit _vehicle->initialPlanRequestCompleteChanged(true);
+            advance();
+        } else {
+            _requestNextPlanStages();
+        }
+        break;
+    case StageCount:
+        break;
+    }
+}
+
 void InitialConnectStateMachine::_stateRequestCapabilities(StateMachine* stateMachine)
 {
     InitialConnectStateMachine* connectMachine  = static_cast<InitialConnectStateMachine*>(stateMachine);
     Vehicle*                    vehicle         = connectMachine->_vehicle;
     WeakLinkInterfacePtr        weakLink        = vehicle->vehicleLinkManager()->primaryLink();
 
+    connectMachine->_connectTimer.start();
+    connectMachine->_startStage(StageCapabilities);
+
     if (weakLink.expired()) {
         qCDebug(InitialConnectStateMachineLog) << "_stateRequestCapabilities Skipping capability request due to no primary link";
-        connectMachine->advance();
+        connectMachine->stageComplete(StageCapabilities);
     } else {
         SharedLinkInterfacePtr sharedLink = weakLink.lock();
 
         if (sharedLink->linkConfiguration()->isHighLatency() || sharedLink->isPX4Flow() || sharedLink->isLogReplay()) {
             qCDebug(InitialConnectStateMachineLog) << "Skipping capability request due to link type";
-            connectMachine->advance();
+            connectMachine->stageComplete(StageCapabilities);
         } else {
             qCDebug(InitialConnectStateMachineLog) << "Requesting capabilities";
             vehicle->_waitForMavlinkMessage(_waitForAutopilotVersionResultHandler, connectMachine, MAVLINK_MSG_ID_AUTOPILOT_VERSION, 1000);
@@ -100,7 +172,7 @@ void InitialConnectStateMachine::_capabilitiesCmdResultHandler(void* resultHandl
         qCDebug(InitialConnectStateMachineLog) << "Setting no capabilities";
         vehicle->_setCapabilities(0);
         vehicle->_waitForMavlinkMessageClear();
-        connectMachine->advance();
+        connectMachine->stageComplete(StageCapabilities);
     }
 }
 
@@ -161,7 +233,7 @@ void InitialConnectStateMachine::_waitForAutopilotVersionResultHandler(void* res
 
         vehicle->_setCapabilities(autopilotVersion.capabilities);
     }
-    connectMachine->advance();
+    connectMachine->stageComplete(StageCapabilities);
 }
 
 void InitialConnectStateMachine::_stateRequestProtocolVersion(StateMachine* stateMachine)
@@ -170,15 +242,17 @@ void InitialConnectStateMachine::_stateRequestProtocolVersion(StateMachine* stat
     Vehicle*                    vehicle         = connectMachine->_vehicle;
     WeakLinkInterfacePtr        weakLink        = vehicle->vehicleLinkManager()->primaryLink();
 
+    connectMachine->_startStage(StageProtocolVersion);
+
     if (weakLink.expired()) {
         qCDebug(InitialConnectStateMachineLog) << "_stateRequestProtocolVersion Skipping protocol version request due to no primary link";
-        connectMachine->advance();
+        connectMachine->stageComplete(StageProtocolVersion);
     } else {
         SharedLinkInterfacePtr sharedLink = weakLink.lock();
 
         if (sharedLink->linkConfiguration()->isHighLatency() || sharedLink->isPX4Flow() || sharedLink->isLogReplay()) {
             qCDebug(InitialConnectStateMachineLog) << "_stateRequestProtocolVersion Skipping protocol version request due to link type";
-            connectMachine->advance();
+            connectMachine->stageComplete(StageProtocolVersion);
         } else {
             qCDebug(InitialConnectStateMachineLog) << "_stateRequestProtocolVersion Requesting protocol version";
             vehicle->_waitForMavlinkMessage(_waitForProtocolVersionResultHandler, connectMachine, MAVLINK_MSG_ID_PROTOCOL_VERSION, 1000);
@@ -213,7 +287,7 @@ void InitialConnectStateMachine::_protocolVersionCmdResultHandler(void* resultHa
         vehicle->_mavlinkProtocolRequestComplete = true;
         vehicle->_setMaxProtoVersionFromBothSources();
         vehicle->_waitForMavlinkMessageClear();
-        connectMachine->advance();
+        connectMachine->stageComplete(StageProtocolVersion);
     }
 }
 
@@ -239,15 +313,21 @@ void InitialConnectStateMachine::_waitForProtocolVersionResultHandler(void* resu
         vehicle->_mavlinkProtocolRequestComplete = true;
         vehicle->_setMaxProtoVersionFromBothSources();
     }
-    connectMachine->advance();
+    connectMachine->stageComplete(StageProtocolVersion);
 }
 
-void InitialConnectStateMachine::_stateRequestCompInfo(StateMachine* stateMachine)
+void InitialConnectStateMachine::_stateRequestCompInfoAndParameters(StateMachine* stateMachine)
 {
     InitialConnectStateMachine* connectMachine  = static_cast<InitialConnectStateMachine*>(stateMachine);
     Vehicle*                    vehicle         = connectMachine->_vehicle;
 
-    qCDebug(InitialConnectStateMachineLog) << "_stateRequestCompInfo";
+    // Both download in parallel. Parameter metadata comes from component information, so the parameter manager
+    // holds back parametersReady until the component information request completes.
+    qCDebug(InitialConnectStateMachineLog) << "_stateRequestCompInfoAndParameters";
+    connectMachine->_startStage(StageParameters);
+    connectMachine->_startStage(StageCompInfo);
+    vehicle->_parameterManager->setMetaDataPending(true);
+    vehicle->_parameterManager->refreshAllParameters();
     vehicle->_componentInformationManager->requestAllComponentInformation(_stateRequestCompInfoComplete, connectMachine);
 }
 
@@ -255,90 +335,114 @@ void InitialConnectStateMachine::_stateRequestCompInfoComplete(void* requestAllC
 {
     InitialConnectStateMachine* connectMachine  = static_cast<InitialConnectStateMachine*>(requestAllCompleteFnData);
 
-    connectMachine->advance();
+    connectMachine->stageComplete(StageCompInfo);
 }
 
-void InitialConnectStateMachine::_stateRequestParameters(StateMachine* stateMachine)
+void InitialConnectStateMachine::_stateRequestPlan(StateMachine* stateMachine)
 {
     InitialConnectStateMachine* connectMachine  = static_cast<InitialConnectStateMachine*>(stateMachine);
-    Vehicle*                    vehicle         = connectMachine->_vehicle;
 
-    qCDebug(InitialConnectStateMachineLog) << "_stateRequestParameters";
-    vehicle->_parameterManager->refreshAllParameters();
+    qCDebug(InitialConnectStateMachineLog) << "_stateRequestPlan max concurrent requests" << connectMachine->_maxConcurrentPlanRequests();
+    connectMachine->_activePlanRequests = 0;
+    connectMachine->_pendingPlanStages  = { StageMission, StageGeoFence, StageRallyPoints };
+    connectMachine->_requestNextPlanStages();
 }
 
-void InitialConnectStateMachine::_stateRequestMission(StateMachine* stateMachine)
+/// Mission, geofence and rally point loads are independent of each other. They are started as request slots
+/// free up, so a completion can start the next load from within this loop.
+void InitialConnectStateMachine::_requestNextPlanStages(void)
 {
-    InitialConnectStateMachine* connectMachine  = static_cast<InitialConnectStateMachine*>(stateMachine);
-    Vehicle*                    vehicle         = connectMachine->_vehicle;
-    WeakLinkInterfacePtr        weakLink        = vehicle->vehicleLinkManager()->primaryLink();
+    while (!_pendingPlanStages.isEmpty() && _activePlanRequests < _maxConcurrentPlanRequests()) {
+        Stage_t stage = _pendingPlanStages.takeFirst();
+
+        _activePlanRequests++;
+        _startStage(stage);
+        switch (stage) {
+        case StageMission:
+            _requestMission();
+            break;
+        case StageGeoFence:
+            _requestGeoFence();
+            break;
+        case StageRallyPoints:
+            _requestRallyPoints();
+            break;
+        default:
+            qWarning() << "Internal Error: InitialConnectStateMachine::_requestNextPlanStages unexpected stage" << stage;
+            break;
+        }
+    }
+}
 
-    if (weakLink.expired()) {
-        qCDebug(InitialConnectStateMachineLog) << "_stateRequestMission: Skipping first mission load request due to no primary link";
-        connectMachine->advance();
-    } else {
-        SharedLinkInterfacePtr sharedLink = weakLink.lock();
+/// @return Number of plan loads which may be in flight at the same time
+int InitialConnectStateMachine::_maxConcurrentPlanRequests(void) const
+{
+    // PX4 services a single mission protocol transfer at a time and answers any other as busy
+    if (!_vehicle->apmFirmware()) {
+        return 1;
+    }
 
-        if (sharedLink->linkConfiguration()->isHighLatency() || sharedLink->isPX4Flow() || sharedLink->isLogReplay()) {
-            qCDebug(InitialConnectStateMachineLog) << "_stateRequestMission: Skipping first mission load request due to link type";
-            vehicle->_firstMissionLoadComplete();
-        } else {
-            qCDebug(InitialConnectStateMachineLog) << "_stateRequestMission";
-            vehicle->_missionManager->loadFromVehicle();
-        }
+    // A telemetry radio whose transmit buffer is filling up is already at its bandwidth limit,
+    // more transfers in flight would only turn into retries
+    if (_vehicle->_telemetryRadioStatusReceived && _vehicle->_telemetryTXBuffer < static_cast<uint32_t>(_minRadioTXBufferPctForConcurrentPlanRequests)) {
+        return 1;
     }
+
+    return 3;
 }
 
-void InitialConnectStateMachine::_stateRequestGeoFence(StateMachine* stateMachine)
+bool InitialConnectStateMachine::_planLoadSkippedForLink(void) const
 {
-    InitialConnectStateMachine* connectMachine  = static_cast<InitialConnectStateMachine*>(stateMachine);
-    Vehicle*                    vehicle         = connectMachine->_vehicle;
-    WeakLinkInterfacePtr        weakLink        = vehicle->vehicleLinkManager()->primaryLink();
+    SharedLinkInterfacePtr sharedLink = _vehicle->vehicleLinkManager()->primaryLink().lock();
 
-    if (weakLink.expired()) {
-        qCDebug(InitialConnectStateMachineLog) << "_stateRequestGeoFence: Skipping first geofence load request due to no primary link";
-        connectMachine->advance();
-    } else {
-        SharedLinkInterfacePtr sharedLink = weakLink.lock();
+    return sharedLink->linkConfiguration()->isHighLatency() || sharedLink->isPX4Flow() || sharedLink->isLogReplay();
+}
 
-        if (sharedLink->linkConfiguration()->isHighLatency() || sharedLink->isPX4Flow() || sharedLink->isLogReplay()) {
-            qCDebug(InitialConnectStateMachineLog) << "_stateRequestGeoFence: Skipping first geofence load request due to link type";
-            vehicle->_firstGeoFenceLoadComplete();
-        } else {
-            if (vehicle->_geoFenceManager->supported()) {
-                qCDebug(InitialConnectStateMachineLog) << "_stateRequestGeoFence";
-                vehicle->_geoFenceManager->loadFromVehicle();
-            } else {
-                qCDebug(InitialConnectStateMachineLog) << "_stateRequestGeoFence: skipped due to no support";
-                vehicle->_firstGeoFenceLoadComplete();
-            }
-        }
+void InitialConnectStateMachine::_requestMission(void)
+{
+    if (_vehicle->vehicleLinkManager()->primaryLink().expired()) {
+        qCDebug(InitialConnectStateMachineLog) << "_requestMission: Skipping first mission load request due to no primary link";
+        stageComplete(StageMission);
+    } else if (_planLoadSkippedForLink()) {
+        qCDebug(InitialConnectStateMachineLog) << "_requestMission: Skipping first mission load request due to link type";
+        _vehicle->_firstMissionLoadComplete();
+    } else {
+        qCDebug(InitialConnectStateMachineLog) << "_requestMission";
+        _vehicle->_missionManager->loadFromVehicle();
     }
 }
 
-void InitialConnectStateMachine::_stateRequestRallyPoints(StateMachine* stateMachine)
+void InitialConnectStateMachine::_requestGeoFence(void)
 {
-    InitialConnectStateMachine* connectMachine  = static_cast<InitialConnectStateMachine*>(stateMachine);
-    Vehicle*                    vehicle         = connectMachine->_vehicle;
-    WeakLinkInterfacePtr        weakLink        = vehicle->vehicleLinkManager()->primaryLink();
-
-    if (weakLink.expired()) {
-        qCDebug(InitialConnectStateMachineLog) << "_stateRequestRallyPoints: Skipping first rally point load request due to no primary link";
-        connectMachine->advance();
+    if (_vehicle->vehicleLinkManager()->primaryLink().expired()) {
+        qCDebug(InitialConnectStateMachineLog) << "_requestGeoFence: Skipping first geofence load request due to no primary link";
+        stageComplete(StageGeoFence);
+    } else if (_planLoadSkippedForLink()) {
+        qCDebug(InitialConnectStateMachineLog) << "_requestGeoFence: Skipping first geofence load request due to link type";
+        _vehicle->_firstGeoFenceLoadComplete();
+    } else if (_vehicle->_geoFenceManager->supported()) {
+        qCDebug(InitialConnectStateMachineLog) << "_requestGeoFence";
+        _vehicle->_geoFenceManager->loadFromVehicle();
     } else {
-        SharedLinkInterfacePtr sharedLink = weakLink.lock();
+        qCDebug(InitialConnectStateMachineLog) << "_requestGeoFence: skipped due to no support";
+        _vehicle->_firstGeoFenceLoadComplete();
+    }
+}
 
-        if (sharedLink->linkConfiguration()->isHighLatency() || sharedLink->isPX4Flow() || sharedLink->isLogReplay()) {
-            qCDebug(InitialConnectStateMachineLog) << "_stateRequestRallyPoints: Skipping first rally point load request due to link type";
-            vehicle->_firstRallyPointLoadComplete();
-        } else {
-            if (vehicle->_rallyPointManager->supported()) {
-                vehicle->_rallyPointManager->loadFromVehicle();
-            } else {
-                qCDebug(InitialConnectStateMachineLog) << "_stateRequestRallyPoints: skipping due to no support";
-                vehicle->_firstRallyPointLoadComplete();
-            }
-        }
+void InitialConnectStateMachine::_requestRallyPoints(void)
+{
+    if (_vehicle->vehicleLinkManager()->primaryLink().expired()) {
+        qCDebug(InitialConnectStateMachineLog) << "_requestRallyPoints: Skipping first rally point load request due to no primary link";
+        stageComplete(StageRallyPoints);
+    } else if (_planLoadSkippedForLink()) {
+        qCDebug(InitialConnectStateMachineLog) << "_requestRallyPoints: Skipping first rally point load request due to link type";
+        _vehicle->_firstRallyPointLoadComplete();
+    } else if (_vehicle->_rallyPointManager->supported()) {
+        qCDebug(InitialConnectStateMachineLog) << "_requestRallyPoints";
+        _vehicle->_rallyPointManager->loadFromVehicle();
+    } else {
+        qCDebug(InitialConnectStateMachineLog) << "_requestRallyPoints: skipping due to no support";
+        _vehicle->_firstRallyPointLoadComplete();
     }
 }
 
@@ -347,7 +451,6 @@ void InitialConnectStateMachine::_stateSignalInitialConnectComplete(StateMachine
     InitialConnectStateMachine* connectMachine  = static_cast<InitialConnectStateMachine*>(stateMachine);
     Vehicle*                    vehicle         = connectMachine->_vehicle;
 
-    qCDebug(InitialConnectStateMachineLog) << "Signalling initialConnectComplete";
+    qCDebug(InitialConnectStateMachineLog) << "Signalling initialConnectComplete after msecs" << connectMachine->_connectTimer.elapsed();
     emit vehicle->initialConnectComplete();
 }
-
@@ -14,15 +14,36 @@
 #include "QGCLoggingCategory.h"
 #include "Vehicle.h"
 
+#include <QElapsedTimer>
+
 Q_DECLARE_LOGGING_CATEGORY(InitialConnectStateMachineLog)
 
 class Vehicle;
 
+/// Runs the initial requests made of a newly connected vehicle:
+///     - Capabilities and protocol version, one after the other since both wait on a single mavlink message
+///     - Component information and parameters in parallel, parameters are not signalled ready until their metadata is complete
+///     - Mission, geofence and rally points once parameters are ready, as many at a time as the vehicle and link allow
+/// The time taken by each stage is logged to InitialConnectStateMachineLog.
 class InitialConnectStateMachine : public StateMachine
 {
 public:
     InitialConnectStateMachine(Vehicle* vehicle);
 
+    typedef enum {
+        StageCapabilities,
+        StageProtocolVersion,
+        StageCompInfo,
+        StageParameters,
+        StageMission,
+        StageGeoFence,
+        StageRallyPoints,
+        StageCount
+    } Stage_t;
+
+    /// Called when the initial request for the stage has completed, whether successful or not
+    void stageComplete(Stage_t stage);
+
     // Overrides from StateMachine
     int             stateCount      (void) const final;
     const StateFn*  rgStates        (void) const final;
@@ -31,12 +52,9 @@ public:
 private:
     static void _stateRequestCapabilities               (StateMachine* stateMachine);
     static void _stateRequestProtocolVersion            (StateMachine* stateMachine);
-    static void _stateRequestCompInfo                   (StateMachine* stateMachine);
+    static void _stateRequestCompInfoAndParameters      (StateMachine* stateMachine);
     static void _stateRequestCompInfoComplete           (void* requestAllCompleteFnData);
-    static void _stateRequestParameters                 (StateMachine* stateMachine);
-    static void _stateRequestMission                    (StateMachine* stateMachine);
-    static void _stateRequestGeoFence                   (StateMachine* stateMachine);
-    static void _stateRequestRallyPoints                (StateMachine* stateMachine);
+    static void _stateRequestPlan                       (StateMachine* stateMachine);
     static void _stateSignalInitialConnectComplete      (StateMachine* stateMachine);
 
     static void _capabilitiesCmdResultHandler           (void* resultHandlerData, int compId, MAV_RESULT result, Vehicle::MavCmdResultFailureCode_t failureCode);
@@ -45,8 +63,25 @@ private:
     static void _waitForAutopilotVersionResultHandler   (void* resultHandlerData, bool noResponsefromVehicle, const mavlink_message_t& message);
     static void _waitForProtocolVersionResultHandler    (void* resultHandlerData, bool noResponsefromVehicle, const mavlink_message_t& message);
 
-    Vehicle* _vehicle;
+    void    _startStage                 (Stage_t stage);
+    void    _requestNextPlanStages      (void);
+    void    _requestMission             (void);
+    void    _requestGeoFence            (void);
+    void    _requestRallyPoints         (void);
+    int     _maxConcurrentPlanRequests  (void) const;
+    bool    _planLoadSkippedForLink     (void) const;
+
+    static const char* _stageName(Stage_t stage);
+
+    Vehicle*        _vehicle;
+    QElapsedTimer   _connectTimer;
+    QElapsedTimer   _stageTimers        [StageCount];
+    bool            _stageCompleted     [StageCount] = {};
+    QList<Stage_t>  _pendingPlanStages;
+    int             _activePlanRequests = 0;
 
     static const StateFn    _rgStates[];
     static const int        _cStates;
+
+    static const int        _minRadioTXBufferPctForConcurrentPlanRequests = 50; ///< RADIO_STATUS.txbuf below this is a congested radio
 };
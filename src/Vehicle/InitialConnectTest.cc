@@ -0,0 +1,71 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "InitialConnectTest.h"
+#include "MultiVehicleManager.h"
+#include "QGCApplication.h"
+#include "ParameterManager.h"
+#include "MissionManager.h"
+#include "GeoFenceManager.h"
+#include "RallyPointManager.h"
+
+void InitialConnectTest::_connectWorker(MockConfiguration::FailureMode_t paramFailureMode, MockLinkMissionItemHandler::FailureMode_t missionFailureMode, int expectedMissionItemCount)
+{
+    MultiVehicleManager*    vehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+    QSignalSpy              spyVehicle(vehicleMgr, &MultiVehicleManager::activeVehicleChanged);
+
+    Q_ASSERT(!_mockLink);
+    _mockLink = MockLink::startPX4MockLink(false, paramFailureMode);
+    QVERIFY(_mockLink);
+
+    // The plan is only requested once parameters are ready, so this is in place before the initial plan request
+    _mockLink->loadMissionItems(_cMissionItems);
+    _mockLink->setMissionItemFailureMode(missionFailureMode, MAV_MISSION_ERROR);
+
+    QCOMPARE(spyVehicle.wait(10000), true);
+    Vehicle* vehicle = vehicleMgr->activeVehicle();
+    QVERIFY(vehicle);
+
+    QSignalSpy spyConnectComplete(vehicle, &Vehicle::initialConnectComplete);
+    QCOMPARE(spyConnectComplete.wait(_connectWaitMsecs), true);
+
+    // Every stage has finished, successfully or not, by the time the sequence completes
+    QVERIFY(vehicle->parameterManager()->parametersReady());
+    QVERIFY(vehicle->initialPlanRequestComplete());
+    QVERIFY(!vehicle->missionManager()->inProgress());
+    QVERIFY(!vehicle->geoFenceManager()->inProgress());
+    QVERIFY(!vehicle->rallyPointManager()->inProgress());
+    QCOMPARE(vehicle->missionManager()->missionItems().count(), expectedMissionItemCount);
+
+    // Late or duplicate stage completions must not signal the sequence complete again
+    QTest::qWait(PlanManager::_ackTimeoutMilliseconds * 2);
+    QCOMPARE(spyConnectComplete.count(), 1);
+}
+
+void InitialConnectTest::_normalConnect(void)
+{
+    _connectWorker(MockConfiguration::FailNone, MockLinkMissionItemHandler::FailNone, _cMissionItems);
+}
+
+void InitialConnectTest::_parameterLoadFailure(void)
+{
+    // Parameters come up with some missing, the plan is still requested after them
+    setExpectedMessageBox(QMessageBox::Ok);
+    _connectWorker(MockConfiguration::FailMissingParamOnAllRequests, MockLinkMissionItemHandler::FailNone, _cMissionItems);
+    QVERIFY(qgcApp()->toolbox()->multiVehicleManager()->activeVehicle()->parameterManager()->missingParameters());
+    checkExpectedMessageBox();
+}
+
+void InitialConnectTest::_missionLoadTimeout(void)
+{
+    // Mission item 0 is never answered, the mission read times out and geofence and rally points still load after it
+    setExpectedMessageBox(QMessageBox::Ok);
+    _connectWorker(MockConfiguration::FailNone, MockLinkMissionItemHandler::FailReadRequest0NoResponse, 0);
+    checkExpectedMessageBox();
+}
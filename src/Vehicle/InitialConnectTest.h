@@ -0,0 +1,30 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "MockLink.h"
+
+/// Runs the initial connect sequence against MockLink, with and without failing stages
+class InitialConnectTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _normalConnect         (void);
+    void _parameterLoadFailure  (void);
+    void _missionLoadTimeout    (void);
+
+private:
+    void _connectWorker(MockConfiguration::FailureMode_t paramFailureMode, MockLinkMissionItemHandler::FailureMode_t missionFailureMode, int expectedMissionItemCount);
+
+    static const int _cMissionItems     = 10;
+    static const int _connectWaitMsecs  = 60000;   ///< Covers the parameter and plan load retries in the failure cases
+};
@@ -0,0 +1,68 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LightweightVehicleTest.h"
+#include "MultiVehicleManager.h"
+#include "QGCApplication.h"
+#include "Vehicle.h"
+
+#include <QSignalSpy>
+
+void LightweightVehicleTest::_externalUpdatesTest(void)
+{
+    FactGroup factGroup(50);
+
+    factGroup.setExternalUpdates(true);
+    QVERIFY(factGroup.externalUpdates());
+
+    // Live updates don't bring the timer back when turned off again
+    factGroup.setLiveUpdates(true);
+    factGroup.setLiveUpdates(false);
+    factGroup.setUpdateRateMSecs(100);
+    QVERIFY(factGroup.externalUpdates());
+
+    factGroup.setExternalUpdates(false);
+    QVERIFY(!factGroup.externalUpdates());
+}
+
+void LightweightVehicleTest::_lightweightTest(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    MultiVehicleManager*    vehicleMgr  = qgcApp()->toolbox()->multiVehicleManager();
+    Vehicle*                vehicle     = vehicleMgr->activeVehicle();
+    QSignalSpy              spy(vehicle, &Vehicle::lightweightChanged);
+
+    // A single vehicle is always a full vehicle
+    QVERIFY(!vehicleMgr->scalingMode());
+    QVERIFY(!vehicle->lightweight());
+    QVERIFY(vehicle->cameraManager());
+    QVERIFY(!vehicle->gpsFactGroup()->externalUpdates());
+
+    vehicle->setLightweight(true);
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(vehicle->lightweight());
+    QVERIFY(!vehicle->cameraManager());
+    QVERIFY(vehicle->externalUpdates());
+    QVERIFY(vehicle->gpsFactGroup()->externalUpdates());
+    QVERIFY(vehicle->vibrationFactGroup()->externalUpdates());
+
+    for (int i=0; i<10; i++) {
+        vehicle->lightweightUpdate();
+    }
+
+    vehicle->setLightweight(false);
+    QCOMPARE(spy.count(), 2);
+    QVERIFY(!vehicle->lightweight());
+    QVERIFY(vehicle->cameraManager());
+    QVERIFY(!vehicle->externalUpdates());
+    QVERIFY(!vehicle->gpsFactGroup()->externalUpdates());
+
+    _disconnectMockLink();
+}
@@ -10,13 +10,13 @@
 #include "MAVLinkLogManager.h"
 #include "QGCApplication.h"
 #include "SettingsManager.h"
+#include "QGCNetworkService.h"
 
 #include <QQmlContext>
 #include <QQmlProperty>
 #include <QQmlEngine>
 #include <QtQml>
 #include <QSettings>
-#include <QHttpPart>
 #include <QNetworkReply>
 #include <QFile>
 #include <QFileInfo>
@@ -37,6 +37,8 @@ static const char* kVideoURLKey             = "VideoURL";
 static const char* kWindSpeedKey            = "WindSpeed";
 static const char* kRateKey                 = "RateKey";
 static const char* kPublicLogKey            = "PublicLog";
+static const char* kMaxConcurrentUploadsKey = "MaxConcurrentUploads";
+static const char* kUploadRateLimitKey      = "UploadRateLimit";
 static const char* kFeedback                = "feedback";
 static const char* kVideoURL                = "videoUrl";
 
@@ -111,201 +113,18 @@ MAVLinkLogFiles::setUploaded(bool uploaded)
 }
 
 //-----------------------------------------------------------------------------
-//-----------------------------------------------------------------------------
-MAVLinkLogProcessor::MAVLinkLogProcessor()
-    : _fd(nullptr)
-    , _written(0)
-    , _sequence(-1)
-    , _numDrops(0)
-    , _gotHeader(false)
-    , _error(false)
-    , _record(nullptr)
-{
-}
-
-//-----------------------------------------------------------------------------
-MAVLinkLogProcessor::~MAVLinkLogProcessor()
-{
-    close();
-}
-
-//-----------------------------------------------------------------------------
-void
-MAVLinkLogProcessor::close()
-{
-    if(_fd) {
-        fclose(_fd);
-        _fd = nullptr;
-    }
-}
-
-//-----------------------------------------------------------------------------
-bool
-MAVLinkLogProcessor::valid()
-{
-    return (_fd != nullptr) && (_record != nullptr);
-}
-
-//-----------------------------------------------------------------------------
-bool
-MAVLinkLogProcessor::create(MAVLinkLogManager* manager, const QString path, uint8_t id)
-{
-    _fileName.asprintf("%s/%03d-%s%s",
-                      path.toLatin1().data(),
-                      id,
-                      QDateTime::currentDateTime().toString("yyyy-MM-dd-hh-mm-ss-zzz").toLocal8Bit().data(),
-                      manager->logExtension().toLocal8Bit().data());
-    _fd = fopen(_fileName.toLocal8Bit().data(), "wb");
-    if(_fd) {
-        _record = new MAVLinkLogFiles(manager, _fileName, true);
-        _record->setWriting(true);
-        _sequence = -1;
-        return true;
-    }
-    return false;
-}
-
-//-----------------------------------------------------------------------------
-bool
-MAVLinkLogProcessor::_checkSequence(uint16_t seq, int& num_drops)
-{
-    num_drops = 0;
-    //-- Check if a sequence is newer than the one previously received and if
-    //   there were dropped messages between the last one and this.
-    if(_sequence == -1) {
-        _sequence = seq;
-        return true;
-    }
-    if((uint16_t)_sequence == seq) {
-        return false;
-    }
-    if(seq > (uint16_t)_sequence) {
-        // Account for wrap-arounds, sequence is 2 bytes
-        if((seq - _sequence) > (1 << 15)) { // Assume reordered
-            return false;
-        }
-        num_drops = seq - _sequence - 1;
-        _numDrops += num_drops;
-        _sequence = seq;
-        return true;
-    } else {
-        if((_sequence - seq) > (1 << 15)) {
-            num_drops = (1 << 16) - _sequence - 1 + seq;
-            _numDrops += num_drops;
-            _sequence = seq;
-            return true;
-        }
-        return false;
-    }
-}
-
-//-----------------------------------------------------------------------------
-void
-MAVLinkLogProcessor::_writeData(void* data, int len)
-{
-    if(!_error) {
-        _error = fwrite(data, 1, len, _fd) != (size_t)len;
-        if(!_error) {
-            _written += len;
-            if(_record) {
-                _record->setSize(_written);
-            }
-        } else {
-            qCDebug(MAVLinkLogManagerLog) << "File IO error:" << len << "bytes into" << _fileName;
-        }
-    }
-}
-
-//-----------------------------------------------------------------------------
-QByteArray
-MAVLinkLogProcessor::_writeUlogMessage(QByteArray& data)
-{
-    //-- Write ulog data w/o integrity checking, assuming data starts with a
-    //   valid ulog message. returns the remaining data at the end.
-    while(data.length() > 2) {
-        uint8_t* ptr = (uint8_t*)data.data();
-        int message_length = ptr[0] + (ptr[1] * 256) + 3; // 3 = ULog msg header
-        if(message_length > data.length())
-            break;
-        _writeData(data.data(), message_length);
-        data.remove(0, message_length);
-    }
-    return data;
-}
-
-//-----------------------------------------------------------------------------
-bool
-MAVLinkLogProcessor::processStreamData(uint16_t sequence, uint8_t first_message, QByteArray data)
-{
-    int num_drops = 0;
-    _error = false;
-    while(_checkSequence(sequence, num_drops)) {
-        //-- The first 16 bytes need special treatment (this sounds awfully brittle)
-        if(!_gotHeader) {
-            if(data.size() < 16) {
-                //-- Shouldn't happen but if it does, we might as well close shop.
-                qCWarning(MAVLinkLogManagerLog) << "Corrupt log header. Canceling log download.";
-                return false;
-            }
-            //-- Write header
-            _writeData(data.data(), 16);
-            data.remove(0, 16);
-            _gotHeader = true;
-            // What about data start offset now that we removed 16 bytes off the start?
-        }
-        if(_gotHeader && num_drops > 0) {
-            if(num_drops > 25) num_drops = 25;
-            //-- Hocus Pocus
-            //   Write a dropout message. We don't really know the actual duration,
-            //   so just use the number of drops * 10 ms
-            uint8_t bogus[] = {2, 0, 79, 0, 0};
-            bogus[3] = num_drops * 10;
-            _writeData(bogus, sizeof(bogus));
-        }
-        if(num_drops > 0) {
-            _writeUlogMessage(_ulogMessage);
-            _ulogMessage.clear();
-            //-- If no useful information in this message. Drop it.
-            if(first_message == 255) {
-                break;
-            }
-            if(first_message > 0) {
-                data.remove(0, first_message);
-                first_message = 0;
-            }
-        }
-        if(first_message == 255 && _ulogMessage.length() > 0) {
-            _ulogMessage.append(data);
-            break;
-        }
-        if(_ulogMessage.length()) {
-            _writeData(_ulogMessage.data(), _ulogMessage.length());
-            if(first_message) {
-                _writeData(data.left(first_message).data(), first_message);
-            }
-            _ulogMessage.clear();
-        }
-        if(first_message) {
-            data.remove(0, first_message);
-        }
-        _ulogMessage = _writeUlogMessage(data);
-        break;
-    }
-    return !_error;
-}
-
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 MAVLinkLogManager::MAVLinkLogManager(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
     , _enableAutoUpload(true)
     , _enableAutoStart(false)
-    , _nam(nullptr)
-    , _currentLogfile(nullptr)
+    , _maxConcurrentUploads(2)
+    , _uploadRateLimit(0)
     , _vehicle(nullptr)
     , _logRunning(false)
     , _loggingDisabled(false)
-    , _logProcessor(nullptr)
+    , _logRecord(nullptr)
     , _deleteAfterUpload(false)
     , _windSpeed(-1)
     , _publicLog(false)
@@ -324,11 +143,29 @@ MAVLinkLogManager::MAVLinkLogManager(QGCApplication* app, QGCToolbox* toolbox)
     setWindSpeed(settings.value(kWindSpeedKey, -1).toInt());
     setRating(settings.value(kRateKey, "notset").toString());
     setPublicLog(settings.value(kPublicLogKey, true).toBool());
+    setMaxConcurrentUploads(settings.value(kMaxConcurrentUploadsKey, 2).toInt());
+    setUploadRateLimit(settings.value(kUploadRateLimitKey, 0).toInt());
+    //-- ULog reassembly and file writes happen on their own thread
+    qRegisterMetaType<MAVLinkLogStreamStats>("MAVLinkLogStreamStats");
+    MAVLinkULogWriter* writer = new MAVLinkULogWriter;
+    writer->moveToThread(&_logThread);
+    connect(&_logThread,    &QThread::finished,                     writer, &QObject::deleteLater);
+    connect(this,           &MAVLinkLogManager::_openLogFile,       writer, &MAVLinkULogWriter::open,               Qt::QueuedConnection);
+    connect(this,           &MAVLinkLogManager::_logDataReceived,   writer, &MAVLinkULogWriter::addData,            Qt::QueuedConnection);
+    connect(this,           &MAVLinkLogManager::_closeLogFile,      writer, &MAVLinkULogWriter::close,              Qt::QueuedConnection);
+    connect(writer,         &MAVLinkULogWriter::statsChanged,       this,   &MAVLinkLogManager::_logStatsChanged,   Qt::QueuedConnection);
+    connect(writer,         &MAVLinkULogWriter::closed,             this,   &MAVLinkLogManager::_logClosed,         Qt::QueuedConnection);
+    connect(writer,         &MAVLinkULogWriter::error,              this,   &MAVLinkLogManager::_logWriterError,    Qt::QueuedConnection);
+    _logThread.setObjectName(QStringLiteral("MAVLinkULogWriter"));
+    _logThread.start();
 }
 
 //-----------------------------------------------------------------------------
 MAVLinkLogManager::~MAVLinkLogManager()
 {
+    //-- The writer completes an open log when it is deleted
+    _logThread.quit();
+    _logThread.wait();
     _logFiles.clear();
 }
 
@@ -355,7 +192,16 @@ MAVLinkLogManager::setToolbox(QGCToolbox* toolbox)
         filter += _ulogExtension;
         QDirIterator it(_logPath, QStringList() << filter, QDir::Files);
         while(it.hasNext()) {
-            _insertNewLog(new MAVLinkLogFiles(this, it.next()));
+            QString filePath = it.next();
+            MAVLinkLogFiles* log = new MAVLinkLogFiles(this, filePath);
+            //-- Uploads which were interrupted by the last shutdown go on where they left off
+            if(_enableAutoUpload && !log->uploaded() && QFile::exists(MAVLinkLogUploader::stateFile(filePath))) {
+                log->setSelected(true);
+            }
+            _insertNewLog(log);
+        }
+        if(_enableAutoUpload) {
+            uploadLog();
         }
         qCDebug(MAVLinkLogManagerLog) << "MAVLink logs directory:" << _logPath;
         connect(toolbox->multiVehicleManager(), &MultiVehicleManager::activeVehicleChanged, this, &MAVLinkLogManager::_activeVehicleChanged);
@@ -483,39 +329,61 @@ MAVLinkLogManager::setPublicLog(bool pub)
     emit publicLogChanged();
 }
 
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogManager::setMaxConcurrentUploads(int count)
+{
+    _maxConcurrentUploads = count < 1 ? 1 : count;
+    QSettings settings;
+    settings.beginGroup(kMAVLinkLogGroup);
+    settings.setValue(kMaxConcurrentUploadsKey, _maxConcurrentUploads);
+    emit maxConcurrentUploadsChanged();
+    //-- Fill the new slots (if any)
+    if(uploading()) {
+        uploadLog();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogManager::setUploadRateLimit(int kbPerSecond)
+{
+    _uploadRateLimit = kbPerSecond < 0 ? 0 : kbPerSecond;
+    _uploadThrottle.setBytesPerSecond(static_cast<qint64>(_uploadRateLimit) * 1024);
+    QSettings settings;
+    settings.beginGroup(kMAVLinkLogGroup);
+    settings.setValue(kUploadRateLimitKey, _uploadRateLimit);
+    emit uploadRateLimitChanged();
+}
+
 //-----------------------------------------------------------------------------
 bool
 MAVLinkLogManager::uploading()
 {
-    return _currentLogfile != nullptr;
+    return !_uploads.isEmpty();
 }
 
 //-----------------------------------------------------------------------------
 void
 MAVLinkLogManager::uploadLog()
 {
-    if(_currentLogfile) {
-        _currentLogfile->setUploading(false);
-    }
-    for(int i = 0; i < _logFiles.count(); i++) {
-        _currentLogfile = qobject_cast<MAVLinkLogFiles*>(_logFiles.get(i));
-        if (_currentLogfile) {
-            if(_currentLogfile->selected()) {
-                _currentLogfile->setSelected(false);
-                if(!_currentLogfile->uploaded() && !_emailAddress.isEmpty() && !_uploadURL.isEmpty()) {
-                    _currentLogfile->setUploading(true);
-                    _currentLogfile->setProgress(0.0);
-                    QString filePath = _makeFilename(_currentLogfile->name());
-                    _sendLog(filePath);
-                    emit uploadingChanged();
-                    return;
+    //-- Selected logs wait for a free upload slot
+    for(int i = 0; i < _logFiles.count() && _uploads.count() < _maxConcurrentUploads; i++) {
+        MAVLinkLogFiles* pLogFile = qobject_cast<MAVLinkLogFiles*>(_logFiles.get(i));
+        if (pLogFile) {
+            if(pLogFile->selected() && !pLogFile->uploading()) {
+                pLogFile->setSelected(false);
+                if(!pLogFile->uploaded() && !_emailAddress.isEmpty() && !_uploadURL.isEmpty()) {
+                    pLogFile->setProgress(0.0);
+                    if(_sendLog(pLogFile)) {
+                        pLogFile->setUploading(true);
+                    }
                 }
             }
         } else {
             qWarning() << "Internal error";
         }
     }
-    _currentLogfile = nullptr;
     emit uploadingChanged();
 }
 
@@ -574,7 +442,17 @@ MAVLinkLogManager::deleteLog()
 void
 MAVLinkLogManager::_deleteLog(MAVLinkLogFiles* log)
 {
+    //-- Stop its upload (if any)
+    MAVLinkLogUploader* uploader = _uploads.key(log, nullptr);
+    if(uploader) {
+        _uploads.remove(uploader);
+        disconnect(uploader, nullptr, this, nullptr);
+        uploader->abort();
+        uploader->deleteLater();
+        emit uploadingChanged();
+    }
     QString filePath = _makeFilename(log->name());
+    QFile::remove(MAVLinkLogUploader::stateFile(filePath));
     QFile gone(filePath);
     if(!gone.remove()) {
         qCWarning(MAVLinkLogManagerLog) << "Could not delete MAVLink log file:" << _logPath;
@@ -598,14 +476,14 @@ MAVLinkLogManager::cancelUpload()
     for(int i = 0; i < _logFiles.count(); i++) {
         MAVLinkLogFiles* pLogFile = qobject_cast<MAVLinkLogFiles*>(_logFiles.get(i));
         if (pLogFile) {
-            if(pLogFile->selected() && pLogFile != _currentLogfile) {
+            if(pLogFile->selected() && !pLogFile->uploading()) {
                 pLogFile->setSelected(false);
             }
         } else {
             qWarning() << "Internal error";
         }
     }
-    if(_currentLogfile) {
+    if(uploading()) {
         emit abortUpload();
     }
 }
@@ -635,38 +513,18 @@ MAVLinkLogManager::stopLogging()
         //-- Tell vehicle to stop sending logs
         _vehicle->stopMavlinkLog();
     }
-    if(_logProcessor) {
-        _logProcessor->close();
-        if(_logProcessor->record()) {
-            _logProcessor->record()->setWriting(false);
-            if(_enableAutoUpload) {
-                //-- Queue log for auto upload (set selected flag)
-                _logProcessor->record()->setSelected(true);
-                if(!uploading()) {
-                    uploadLog();
-                }
-            }
-        }
-        delete _logProcessor;
-        _logProcessor = nullptr;
+    if(_logRecord) {
+        //-- The record is done with once the writer has flushed the file (_logClosed)
+        emit _closeLogFile(false);
+        _logRecord = nullptr;
         _logRunning = false;
         emit logRunningChanged();
     }
 }
 
-//-----------------------------------------------------------------------------
-QHttpPart
-create_form_part(const QString& name, const QString& value)
-{
-    QHttpPart formPart;
-    formPart.setHeader(QNetworkRequest::ContentDispositionHeader, QString("form-data; name=\"%1\"").arg(name));
-    formPart.setBody(value.toUtf8());
-    return formPart;
-}
-
 //-----------------------------------------------------------------------------
 bool
-MAVLinkLogManager::_sendLog(const QString& logFile)
+MAVLinkLogManager::_sendLog(MAVLinkLogFiles* logFile)
 {
     QString defaultDescription = _description;
     if(_description.isEmpty()) {
@@ -681,90 +539,35 @@ MAVLinkLogManager::_sendLog(const QString& logFile)
         qCWarning(MAVLinkLogManagerLog) << "Upload URL missing.";
         return false;
     }
-    QFileInfo fi(logFile);
+    QString filePath = _makeFilename(logFile->name());
+    QFileInfo fi(filePath);
     if(!fi.exists()) {
-        qCWarning(MAVLinkLogManagerLog) << "Log file missing:" << logFile;
-        return false;
-    }
-    QFile* file = new QFile(logFile);
-    if(!file || !file->open(QIODevice::ReadOnly)) {
-        delete file;
-        file = nullptr;
-        qCWarning(MAVLinkLogManagerLog) << "Could not open log file:" << logFile;
+        qCWarning(MAVLinkLogManagerLog) << "Log file missing:" << filePath;
         return false;
     }
-    if(!_nam) {
-        _nam = new QNetworkAccessManager(this);
-    }
-    QNetworkProxy savedProxy = _nam->proxy();
-    QNetworkProxy tempProxy;
-    tempProxy.setType(QNetworkProxy::DefaultProxy);
-    _nam->setProxy(tempProxy);
-    //-- Build POST request
-    QHttpMultiPart* multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
-    QHttpPart emailPart = create_form_part("email", _emailAddress);
-    QHttpPart descriptionPart = create_form_part("description", _description);
-    QHttpPart sourcePart      = create_form_part("source", "QGroundControl");
-    QHttpPart versionPart     = create_form_part("version", _app->applicationVersion());
-    QHttpPart typePart        = create_form_part("type", "flightreport");
-    QHttpPart windPart        = create_form_part("windSpeed", QString::number(_windSpeed));
-    QHttpPart ratingPart      = create_form_part("rating", _rating);
-    QHttpPart publicPart      = create_form_part("public", _publicLog ? "true" : "false");
-    //-- Assemble request and POST it
-    multiPart->append(emailPart);
-    multiPart->append(descriptionPart);
-    multiPart->append(sourcePart);
-    multiPart->append(versionPart);
-    multiPart->append(typePart);
-    multiPart->append(windPart);
-    multiPart->append(ratingPart);
-    multiPart->append(publicPart);
+    //-- Form fields, in the order the server has always received them
+    MAVLinkLogUploader::FormFields_t formFields;
+    formFields.append(qMakePair(QString("email"),           _emailAddress));
+    formFields.append(qMakePair(QString("description"),     _description));
+    formFields.append(qMakePair(QString("source"),          QString("QGroundControl")));
+    formFields.append(qMakePair(QString("version"),         _app->applicationVersion()));
+    formFields.append(qMakePair(QString("type"),            QString("flightreport")));
+    formFields.append(qMakePair(QString("windSpeed"),       QString::number(_windSpeed)));
+    formFields.append(qMakePair(QString("rating"),          _rating));
+    formFields.append(qMakePair(QString("public"),          QString(_publicLog ? "true" : "false")));
     //-- Optional
-    QHttpPart feedbackPart;
-    if(_feedback.isEmpty()) {
-        feedbackPart = create_form_part(kFeedback, "None Given");
-    } else {
-        feedbackPart = create_form_part(kFeedback, _feedback);
-    }
-    multiPart->append(feedbackPart);
-    QHttpPart videoPart;
-    if(_videoURL.isEmpty()) {
-        videoPart = create_form_part(kVideoURL, "None");
-    } else {
-        videoPart = create_form_part(kVideoURL, _videoURL);
-    }
-    multiPart->append(videoPart);
-    //-- Actual Log File
-    QHttpPart logPart;
-    logPart.setHeader(QNetworkRequest::ContentTypeHeader, "application/octet-stream");
-    logPart.setHeader(QNetworkRequest::ContentDispositionHeader, QString("form-data; name=\"filearg\"; filename=\"%1\"").arg(fi.fileName()));
-    logPart.setBodyDevice(file);
-    multiPart->append(logPart);
-    file->setParent(multiPart);
-    QNetworkRequest request(_uploadURL);
-#if QT_VERSION > 0x050600
-    request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
-#endif
-    QNetworkReply* reply = _nam->post(request, multiPart);
-    connect(reply, &QNetworkReply::finished,  this, &MAVLinkLogManager::_uploadFinished);
-    connect(this, &MAVLinkLogManager::abortUpload, reply, &QNetworkReply::abort);
-    //connect(reply, &QNetworkReply::readyRead, this, &MAVLinkLogManager::_dataAvailable);
-    connect(reply, &QNetworkReply::uploadProgress, this, &MAVLinkLogManager::_uploadProgress);
-    multiPart->setParent(reply);
+    formFields.append(qMakePair(QString(kFeedback),         _feedback.isEmpty() ? QString("None Given") : _feedback));
+    formFields.append(qMakePair(QString(kVideoURL),         _videoURL.isEmpty() ? QString("None") : _videoURL));
+    MAVLinkLogUploader* uploader = new MAVLinkLogUploader(filePath, _uploadURL, formFields, qgcApp()->toolbox()->networkService()->networkAccessManager(), &_uploadThrottle, this);
+    connect(uploader, &MAVLinkLogUploader::finished, this, &MAVLinkLogManager::_uploadFinished);
+    connect(uploader, &MAVLinkLogUploader::progress, this, &MAVLinkLogManager::_uploadProgress);
+    connect(this, &MAVLinkLogManager::abortUpload, uploader, &MAVLinkLogUploader::abort);
+    _uploads.insert(uploader, logFile);
     qCDebug(MAVLinkLogManagerLog) << "Log" << fi.baseName() << "Uploading." << fi.size() << "bytes.";
-    _nam->setProxy(savedProxy);
+    uploader->start();
     return true;
 }
 
-//-----------------------------------------------------------------------------
-bool
-MAVLinkLogManager::_processUploadResponse(int http_code, QByteArray& data)
-{
-    qCDebug(MAVLinkLogManagerLog) << "Uploaded response:" << QString::fromUtf8(data);
-    emit readyRead(data);
-    return http_code == 200;
-}
-
 //-----------------------------------------------------------------------------
 void
 MAVLinkLogManager::_dataAvailable()
@@ -779,39 +582,37 @@ MAVLinkLogManager::_dataAvailable()
 
 //-----------------------------------------------------------------------------
 void
-MAVLinkLogManager::_uploadFinished()
+MAVLinkLogManager::_uploadFinished(bool success, QByteArray response, QString errorString)
 {
-    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
-    if(!reply) {
+    MAVLinkLogUploader* uploader = qobject_cast<MAVLinkLogUploader*>(sender());
+    if(!uploader || !_uploads.contains(uploader)) {
         return;
     }
-    const int http_code = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-    QByteArray data = reply->readAll();
-    if(_processUploadResponse(http_code, data)) {
+    MAVLinkLogFiles* pLogFile = _uploads.take(uploader);
+    uploader->deleteLater();
+    qCDebug(MAVLinkLogManagerLog) << "Uploaded response:" << QString::fromUtf8(response);
+    emit readyRead(response);
+    if(success) {
         qCDebug(MAVLinkLogManagerLog) << "Log uploaded.";
         emit succeed();
         if(_deleteAfterUpload) {
-            if(_currentLogfile) {
-                _deleteLog(_currentLogfile);
-                _currentLogfile = nullptr;
-            }
+            _deleteLog(pLogFile);
         } else {
-            if(_currentLogfile) {
-                _currentLogfile->setUploaded(true);
-                //-- Write side-car file to flag it as uploaded
-                QString sideCar = _makeFilename(_currentLogfile->name());
-                sideCar.replace(_ulogExtension, kSidecarExtension);
-                FILE* f = fopen(sideCar.toLatin1().data(), "wb");
-                if(f) {
-                    fclose(f);
-                }
+            pLogFile->setUploading(false);
+            pLogFile->setUploaded(true);
+            //-- Write side-car file to flag it as uploaded
+            QString sideCar = _makeFilename(pLogFile->name());
+            sideCar.replace(_ulogExtension, kSidecarExtension);
+            FILE* f = fopen(sideCar.toLatin1().data(), "wb");
+            if(f) {
+                fclose(f);
             }
         }
     } else {
-        qCWarning(MAVLinkLogManagerLog) << QString("Log Upload Error: %1 status: %2").arg(reply->errorString(), reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toString());
+        qCWarning(MAVLinkLogManagerLog) << "Log Upload Error:" << errorString;
+        pLogFile->setUploading(false);
         emit failed();
     }
-    reply->deleteLater();
     //-- Next (if any)
     uploadLog();
 }
@@ -820,11 +621,10 @@ MAVLinkLogManager::_uploadFinished()
 void
 MAVLinkLogManager::_uploadProgress(qint64 bytesSent, qint64 bytesTotal)
 {
-    if(bytesTotal) {
+    MAVLinkLogFiles* pLogFile = _uploads.value(qobject_cast<MAVLinkLogUploader*>(sender()), nullptr);
+    if(bytesTotal && pLogFile) {
         qreal progress = static_cast<qreal>(bytesSent) / static_cast<qreal>(bytesTotal);
-        if(_currentLogfile) {
-            _currentLogfile->setProgress(progress);
-        }
+        pLogFile->setProgress(progress);
     }
     qCDebug(MAVLinkLogManagerLog) << bytesSent << "of" << bytesTotal;
 }
@@ -865,15 +665,8 @@ MAVLinkLogManager::_activeVehicleChanged(Vehicle* vehicle)
 void
 MAVLinkLogManager::_mavlinkLogData(Vehicle* /*vehicle*/, uint8_t /*target_system*/, uint8_t /*target_component*/, uint16_t sequence, uint8_t first_message, QByteArray data, bool /*acked*/)
 {
-    if(_logProcessor && _logProcessor->valid()) {
-        if(!_logProcessor->processStreamData(sequence, first_message, data)) {
-            qCWarning(MAVLinkLogManagerLog) << "Error writing MAVLink log file:" << _logProcessor->fileName();
-            delete _logProcessor;
-            _logProcessor = nullptr;
-            _logRunning = false;
-            _vehicle->stopMavlinkLog();
-            emit logRunningChanged();
-        }
+    if(_logRecord) {
+        emit _logDataReceived(sequence, first_message, data);
     } else {
         qCWarning(MAVLinkLogManagerLog) << "MAVLink log data received when not expected.";
     }
@@ -912,13 +705,11 @@ void
 MAVLinkLogManager::_discardLog()
 {
     //-- Delete (empty) log file (and record)
-    if(_logProcessor) {
-        _logProcessor->close();
-        if(_logProcessor->record()) {
-            _deleteLog(_logProcessor->record());
-        }
-        delete _logProcessor;
-        _logProcessor = nullptr;
+    if(_logRecord) {
+        //-- The writer deletes the file once it is closed
+        emit _closeLogFile(true);
+        _deleteLog(_logRecord);
+        _logRecord = nullptr;
     }
     _logRunning = false;
     emit logRunningChanged();
@@ -928,17 +719,24 @@ MAVLinkLogManager::_discardLog()
 bool
 MAVLinkLogManager::_createNewLog()
 {
-    delete _logProcessor;
-    _logProcessor = new MAVLinkLogProcessor;
-    if(_logProcessor->create(this, _logPath, static_cast<uint8_t>(_vehicle->id()))) {
-        _insertNewLog(_logProcessor->record());
-        emit logFilesChanged();
-    } else {
-        qCWarning(MAVLinkLogManagerLog) << "Could not create MAVLink log file:" << _logProcessor->fileName();
-        delete _logProcessor;
-        _logProcessor = nullptr;
-    }
-    return _logProcessor != nullptr;
+    if(_logRecord) {
+        emit _closeLogFile(false);
+        _logRecord = nullptr;
+    }
+    QString fileName = QString::asprintf("%s/%03d-%s%s",
+                                         _logPath.toLatin1().data(),
+                                         _vehicle->id(),
+                                         QDateTime::currentDateTime().toString("yyyy-MM-dd-hh-mm-ss-zzz").toLocal8Bit().data(),
+                                         _ulogExtension.toLocal8Bit().data());
+    //-- The file is created on the writer thread, _logWriterError reports if that fails
+    emit _openLogFile(fileName);
+    _logRecord = new MAVLinkLogFiles(this, fileName, true);
+    _logRecord->setWriting(true);
+    _insertNewLog(_logRecord);
+    emit logFilesChanged();
+    _logStreamStats = MAVLinkLogStreamStats();
+    emit logStreamStatsChanged();
+    return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -958,6 +756,81 @@ MAVLinkLogManager::_armedChanged(bool armed)
     }
 }
 
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogManager::_logStatsChanged(QString fileName, MAVLinkLogStreamStats stats)
+{
+    if(_logRecord && _findLog(fileName) == _logRecord) {
+        _logRecord->setSize(stats.bytesWritten);
+        _logStreamStats = stats;
+        emit logStreamStatsChanged();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogManager::_logClosed(QString fileName, MAVLinkLogStreamStats stats)
+{
+    qCDebug(MAVLinkLogManagerLog) << "MAVLink log closed:" << fileName << stats.bytesWritten << "bytes" << stats.received << "packets"
+                                  << stats.dropped << "dropped" << stats.reordered << "reordered" << stats.duplicates << "duplicates";
+    if(!_logRecord) {
+        _logStreamStats = stats;
+        emit logStreamStatsChanged();
+    }
+    //-- Gone if it was discarded
+    MAVLinkLogFiles* record = _findLog(fileName);
+    if(record) {
+        record->setSize(stats.bytesWritten);
+        record->setWriting(false);
+        if(_enableAutoUpload) {
+            //-- Queue log for auto upload (set selected flag)
+            record->setSelected(true);
+            uploadLog();
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogManager::_logWriterError(QString fileName, QString errorString)
+{
+    qCWarning(MAVLinkLogManagerLog) << errorString << fileName;
+    MAVLinkLogFiles* record = _findLog(fileName);
+    if(!record) {
+        return;
+    }
+    if(record == _logRecord) {
+        _logRecord = nullptr;
+        _logRunning = false;
+        if(_vehicle) {
+            _vehicle->stopMavlinkLog();
+        }
+        emit logRunningChanged();
+    }
+    if(QFile::exists(fileName)) {
+        record->setWriting(false);
+    } else {
+        //-- It was never created
+        _logFiles.removeOne(record);
+        delete record;
+        emit logFilesChanged();
+    }
+}
+
+//-----------------------------------------------------------------------------
+MAVLinkLogFiles*
+MAVLinkLogManager::_findLog(const QString& filePath)
+{
+    QString name = QFileInfo(filePath).baseName();
+    for(int i = 0; i < _logFiles.count(); i++) {
+        MAVLinkLogFiles* pLogFile = qobject_cast<MAVLinkLogFiles*>(_logFiles.get(i));
+        if(pLogFile && pLogFile->name() == name) {
+            return pLogFile;
+        }
+    }
+    return nullptr;
+}
+
 //-----------------------------------------------------------------------------
 QString
 MAVLinkLogManager::_makeFilename(const QString& baseName)
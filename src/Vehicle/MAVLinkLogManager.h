@@ -11,8 +11,12 @@
 #ifndef MAVLinkLogManager_H
 #define MAVLinkLogManager_H
 
+#include <QHash>
 #include <QObject>
+#include <QThread>
 
+#include "MAVLinkLogUploader.h"
+#include "MAVLinkULogWriter.h"
 #include "QmlObjectListModel.h"
 #include "QGCLoggingCategory.h"
 #include "QGCToolbox.h"
@@ -20,7 +24,6 @@
 
 Q_DECLARE_LOGGING_CATEGORY(MAVLinkLogManagerLog)
 
-class QNetworkAccessManager;
 class MAVLinkLogManager;
 
 //-----------------------------------------------------------------------------
@@ -72,34 +75,6 @@ private:
     bool                _uploaded;
 };
 
-//-----------------------------------------------------------------------------
-class MAVLinkLogProcessor
-{
-public:
-    MAVLinkLogProcessor();
-    ~MAVLinkLogProcessor();
-    void                close       ();
-    bool                valid       ();
-    bool                create      (MAVLinkLogManager *manager, const QString path, uint8_t id);
-    MAVLinkLogFiles*    record      () { return _record; }
-    QString             fileName    () { return _fileName; }
-    bool                processStreamData(uint16_t _sequence, uint8_t first_message, QByteArray data);
-private:
-    bool                _checkSequence(uint16_t seq, int &num_drops);
-    QByteArray          _writeUlogMessage(QByteArray &data);
-    void                _writeData(void* data, int len);
-private:
-    FILE*               _fd;
-    quint32             _written;
-    int                 _sequence;
-    int                 _numDrops;
-    bool                _gotHeader;
-    bool                _error;
-    QByteArray          _ulogMessage;
-    QString             _fileName;
-    MAVLinkLogFiles*    _record;
-};
-
 //-----------------------------------------------------------------------------
 class MAVLinkLogManager : public QGCTool
 {
@@ -124,6 +99,14 @@ public:
     Q_PROPERTY(QmlObjectListModel*  logFiles            READ    logFiles                                        NOTIFY logFilesChanged)
     Q_PROPERTY(int                  windSpeed           READ    windSpeed           WRITE setWindSpeed          NOTIFY windSpeedChanged)
     Q_PROPERTY(QString              rating              READ    rating              WRITE setRating             NOTIFY ratingChanged)
+    Q_PROPERTY(int                  maxConcurrentUploads READ   maxConcurrentUploads WRITE setMaxConcurrentUploads NOTIFY maxConcurrentUploadsChanged)
+    Q_PROPERTY(int                  uploadRateLimit     READ    uploadRateLimit     WRITE setUploadRateLimit    NOTIFY uploadRateLimitChanged)     ///< KB/s, 0 for no limit
+    // Streaming statistics of the log being written, or the last one
+    Q_PROPERTY(int                  logPacketsReceived  READ    logPacketsReceived                              NOTIFY logStreamStatsChanged)
+    Q_PROPERTY(int                  logPacketsDropped   READ    logPacketsDropped                               NOTIFY logStreamStatsChanged)
+    Q_PROPERTY(int                  logPacketsReordered READ    logPacketsReordered                             NOTIFY logStreamStatsChanged)
+    Q_PROPERTY(int                  logPacketsDuplicated READ   logPacketsDuplicated                            NOTIFY logStreamStatsChanged)
+    Q_PROPERTY(qreal                logDropRate         READ    logDropRate                                     NOTIFY logStreamStatsChanged)     ///< Percent
 
     Q_INVOKABLE void uploadLog      ();
     Q_INVOKABLE void deleteLog      ();
@@ -146,6 +129,13 @@ public:
     int         windSpeed           () { return _windSpeed; }
     QString     rating              () { return _rating; }
     QString     logExtension        () { return _ulogExtension; }
+    int         maxConcurrentUploads() { return _maxConcurrentUploads; }
+    int         uploadRateLimit     () { return _uploadRateLimit; }
+    int         logPacketsReceived  () { return static_cast<int>(_logStreamStats.received); }
+    int         logPacketsDropped   () { return static_cast<int>(_logStreamStats.dropped); }
+    int         logPacketsReordered () { return static_cast<int>(_logStreamStats.reordered); }
+    int         logPacketsDuplicated() { return static_cast<int>(_logStreamStats.duplicates); }
+    qreal       logDropRate         () { return _logStreamStats.dropRate(); }
 
     QmlObjectListModel* logFiles    () { return &_logFiles; }
 
@@ -160,6 +150,8 @@ public:
     void        setWindSpeed        (int speed);
     void        setRating           (QString rate);
     void        setPublicLog        (bool publicLog);
+    void        setMaxConcurrentUploads(int count);
+    void        setUploadRateLimit  (int kbPerSecond);
 
     // Override from QGCTool
     void        setToolbox          (QGCToolbox *toolbox);
@@ -185,25 +177,34 @@ signals:
     void ratingChanged              ();
     void videoURLChanged            ();
     void publicLogChanged           ();
+    void maxConcurrentUploadsChanged();
+    void uploadRateLimitChanged     ();
+    void logStreamStatsChanged      ();
+    void _openLogFile               (QString fileName);                                     ///< To the log writer thread
+    void _logDataReceived           (quint16 sequence, quint8 firstMessage, QByteArray data);   ///< To the log writer thread
+    void _closeLogFile              (bool discard);                                         ///< To the log writer thread
 
 private slots:
-    void _uploadFinished            ();
+    void _uploadFinished            (bool success, QByteArray response, QString errorString);
     void _dataAvailable             ();
     void _uploadProgress            (qint64 bytesSent, qint64 bytesTotal);
     void _activeVehicleChanged      (Vehicle* vehicle);
     void _mavlinkLogData            (Vehicle* vehicle, uint8_t target_system, uint8_t target_component, uint16_t sequence, uint8_t first_message, QByteArray data, bool acked);
     void _armedChanged              (bool armed);
     void _mavCommandResult          (int vehicleId, int component, int command, int result, bool noReponseFromVehicle);
+    void _logStatsChanged           (QString fileName, MAVLinkLogStreamStats stats);
+    void _logClosed                 (QString fileName, MAVLinkLogStreamStats stats);
+    void _logWriterError            (QString fileName, QString errorString);
 
 private:
-    bool _sendLog                   (const QString& logFile);
-    bool _processUploadResponse     (int http_code, QByteArray &data);
+    bool _sendLog                   (MAVLinkLogFiles* logFile);
     bool _createNewLog              ();
     int  _getFirstSelected          ();
     void _insertNewLog              (MAVLinkLogFiles* newLog);
     void _deleteLog                 (MAVLinkLogFiles* log);
     void _discardLog                ();
     QString _makeFilename           (const QString& baseName);
+    MAVLinkLogFiles* _findLog       (const QString& filePath);
 
 private:
     QString                 _description;
@@ -214,13 +215,17 @@ private:
     QString                 _videoURL;
     bool                    _enableAutoUpload;
     bool                    _enableAutoStart;
-    QNetworkAccessManager*  _nam;
     QmlObjectListModel      _logFiles;
-    MAVLinkLogFiles*        _currentLogfile;
+    QHash<MAVLinkLogUploader*, MAVLinkLogFiles*> _uploads;
+    MAVLinkLogUploadThrottle _uploadThrottle;   ///< Shared by all uploads
+    int                     _maxConcurrentUploads;
+    int                     _uploadRateLimit;
     Vehicle*                _vehicle;
     bool                    _logRunning;
     bool                    _loggingDisabled;
-    MAVLinkLogProcessor*    _logProcessor;
+    MAVLinkLogFiles*        _logRecord;         ///< Log being written
+    MAVLinkLogStreamStats   _logStreamStats;
+    QThread                 _logThread;         ///< MAVLinkULogWriter
     bool                    _deleteAfterUpload;
     int                     _windSpeed;
     QString                 _rating;
@@ -0,0 +1,626 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkLogUploader.h"
+#include "MAVLinkLogManager.h"
+#include "QGCApplication.h"
+#include "QGCNetworkService.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QHttpMultiPart>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+
+#include <cmath>
+
+const char* MAVLinkLogUploader::_tusVersion =       "1.0.0";
+const char* MAVLinkLogUploader::_stateExtension =   ".upload";
+const char* MAVLinkLogUploader::_jsonUploadURLKey = "uploadURL";
+const char* MAVLinkLogUploader::_jsonLocationKey =  "location";
+const char* MAVLinkLogUploader::_jsonSizeKey =      "size";
+
+MAVLinkLogUploadThrottle::MAVLinkLogUploadThrottle(qint64 bytesPerSecond)
+    : _bytesPerSecond(0)
+{
+    setBytesPerSecond(bytesPerSecond);
+}
+
+void MAVLinkLogUploadThrottle::setBytesPerSecond(qint64 bytesPerSecond)
+{
+    _bytesPerSecond = bytesPerSecond > 0 ? bytesPerSecond : 0;
+
+    qint64 burstBytes = _bytesPerSecond * burstMsecs / 1000;
+    _burstBytes = burstBytes > minBurstBytes ? burstBytes : minBurstBytes;
+    if (_tokens > _burstBytes) {
+        _tokens = _burstBytes;
+    }
+}
+
+void MAVLinkLogUploadThrottle::_refill(qint64 nowMsecs)
+{
+    if (_lastMsecs < 0) {
+        // Start with a full bucket
+        _tokens = _burstBytes;
+    } else if (nowMsecs > _lastMsecs) {
+        _tokens += (nowMsecs - _lastMsecs) * _bytesPerSecond / 1000.0;
+        if (_tokens > _burstBytes) {
+            _tokens = _burstBytes;
+        }
+    } else {
+        return;
+    }
+    _lastMsecs = nowMsecs;
+}
+
+qint64 MAVLinkLogUploadThrottle::take(qint64 nowMsecs, qint64 wanted)
+{
+    if (wanted <= 0) {
+        return 0;
+    }
+    if (_bytesPerSecond == 0) {
+        return wanted;
+    }
+
+    _refill(nowMsecs);
+    qint64 available    = static_cast<qint64>(_tokens);
+    qint64 taken        = wanted < available ? wanted : available;
+    _tokens -= taken;
+    return taken;
+}
+
+int MAVLinkLogUploadThrottle::msecsUntilAvailable(qint64 nowMsecs, qint64 bytes)
+{
+    if (_bytesPerSecond == 0) {
+        return 0;
+    }
+
+    // Waiting for more than the bucket holds would never end
+    _refill(nowMsecs);
+    double needed = bytes < _burstBytes ? bytes : _burstBytes;
+    if (_tokens >= needed) {
+        return 0;
+    }
+    return static_cast<int>(std::ceil((needed - _tokens) * 1000.0 / _bytesPerSecond));
+}
+
+MAVLinkLogUploadDevice::MAVLinkLogUploadDevice(const QString& fileName, qint64 offset, qint64 length, MAVLinkLogUploadThrottle* throttle, QObject* parent)
+    : QIODevice (parent)
+    , _file     (fileName)
+    , _offset   (offset)
+    , _remaining(length)
+    , _throttle (throttle)
+{
+    _refillTimer.setSingleShot(true);
+    connect(&_refillTimer, &QTimer::timeout, this, &QIODevice::readyRead);
+}
+
+bool MAVLinkLogUploadDevice::open(OpenMode mode)
+{
+    if (mode != QIODevice::ReadOnly) {
+        setErrorString(tr("Upload device is read only"));
+        return false;
+    }
+    if (!_file.open(QIODevice::ReadOnly) || !_file.seek(_offset)) {
+        setErrorString(_file.errorString());
+        _file.close();
+        return false;
+    }
+    return QIODevice::open(mode);
+}
+
+void MAVLinkLogUploadDevice::close(void)
+{
+    _refillTimer.stop();
+    _file.close();
+    QIODevice::close();
+}
+
+qint64 MAVLinkLogUploadDevice::bytesAvailable(void) const
+{
+    return _remaining + QIODevice::bytesAvailable();
+}
+
+bool MAVLinkLogUploadDevice::atEnd(void) const
+{
+    return _remaining == 0 && QIODevice::bytesAvailable() == 0;
+}
+
+qint64 MAVLinkLogUploadDevice::readData(char* data, qint64 maxSize)
+{
+    if (_remaining == 0) {
+        return -1;
+    }
+
+    qint64 wanted = maxSize < _remaining ? maxSize : _remaining;
+    if (wanted > readBlockSize) {
+        wanted = readBlockSize;
+    }
+
+    if (_throttle) {
+        qint64 nowMsecs = static_cast<qint64>(qgcApp()->msecsSinceBoot());
+
+        wanted = _throttle->take(nowMsecs, wanted);
+        if (wanted == 0) {
+            // The reader comes back on readyRead
+            if (!_refillTimer.isActive()) {
+                _refillTimer.start(_throttle->msecsUntilAvailable(nowMsecs, readBlockSize));
+            }
+            return 0;
+        }
+    }
+
+    qint64 bytesRead = _file.read(data, wanted);
+    if (bytesRead <= 0) {
+        setErrorString(bytesRead == 0 ? tr("Log file is shorter than expected") : _file.errorString());
+        return -1;
+    }
+    _remaining -= bytesRead;
+
+    return bytesRead;
+}
+
+qint64 MAVLinkLogUploadDevice::writeData(const char* /*data*/, qint64 /*maxSize*/)
+{
+    return -1;
+}
+
+MAVLinkLogUploader::MAVLinkLogUploader(const QString& logFile, const QString& uploadURL, const FormFields_t& formFields, QNetworkAccessManager* nam, MAVLinkLogUploadThrottle* throttle, QObject* parent)
+    : QObject       (parent)
+    , _logFile      (logFile)
+    , _uploadURL    (uploadURL)
+    , _formFields   (formFields)
+    , _nam          (nam)
+    , _throttle     (throttle)
+{
+    _retryTimer.setSingleShot(true);
+    connect(&_retryTimer, &QTimer::timeout, this, &MAVLinkLogUploader::_resume);
+}
+
+QByteArray MAVLinkLogUploader::tusMetadata(const FormFields_t& formFields)
+{
+    QList<QByteArray> pairs;
+
+    for (const auto& field: formFields) {
+        QByteArray pair = field.first.toLatin1();
+        if (!field.second.isEmpty()) {
+            pair += ' ';
+            pair += field.second.toUtf8().toBase64();
+        }
+        pairs.append(pair);
+    }
+
+    QByteArray metadata;
+    for (int i=0; i<pairs.count(); i++) {
+        if (i != 0) {
+            metadata += ',';
+        }
+        metadata += pairs[i];
+    }
+    return metadata;
+}
+
+QString MAVLinkLogUploader::stateFile(const QString& logFile)
+{
+    QFileInfo fi(logFile);
+    return fi.dir().absoluteFilePath(fi.completeBaseName() + QString::fromLatin1(_stateExtension));
+}
+
+void MAVLinkLogUploader::start(void)
+{
+    QFileInfo fi(_logFile);
+    if (!fi.exists()) {
+        _fail(tr("Log file missing: %1").arg(_logFile));
+        return;
+    }
+
+    _size       = fi.size();
+    _retryCount = 0;
+    _aborted    = false;
+
+    // An upload which was interrupted, maybe by a restart, continues where the server left off
+    if (_loadState()) {
+        _head();
+    } else {
+        _options();
+    }
+}
+
+void MAVLinkLogUploader::abort(void)
+{
+    _aborted = true;
+    if (_reply) {
+        // Completes through the finished handler of the request
+        _reply->abort();
+    } else if (_retryTimer.isActive()) {
+        _retryTimer.stop();
+        _fail(tr("Upload cancelled"));
+    }
+}
+
+void MAVLinkLogUploader::_resume(void)
+{
+    if (_location.isValid()) {
+        _head();
+    } else {
+        _options();
+    }
+}
+
+QNetworkRequest MAVLinkLogUploader::_tusRequest(const QUrl& url) const
+{
+    QNetworkRequest request(url);
+    request.setRawHeader("Tus-Resumable", _tusVersion);
+    QGCNetworkService::setConsumer(request, QGCNetworkService::consumerLogUpload);
+    return request;
+}
+
+int MAVLinkLogUploader::_httpStatus(QNetworkReply* reply)
+{
+    return reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+}
+
+QNetworkReply* MAVLinkLogUploader::_takeReply(void)
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    if (!reply) {
+        return nullptr;
+    }
+    reply->deleteLater();
+    if (reply != _reply) {
+        return nullptr;
+    }
+    _reply = nullptr;
+    return reply;
+}
+
+void MAVLinkLogUploader::_options(void)
+{
+    _reply = _nam->sendCustomRequest(_tusRequest(QUrl(_uploadURL)), "OPTIONS");
+    connect(_reply, &QNetworkReply::finished, this, &MAVLinkLogUploader::_optionsFinished);
+}
+
+void MAVLinkLogUploader::_optionsFinished(void)
+{
+    QNetworkReply* reply = _takeReply();
+    if (!reply) {
+        return;
+    }
+    if (_aborted) {
+        _fail(tr("Upload cancelled"));
+        return;
+    }
+
+    int status = _httpStatus(reply);
+    if (status == 0 || status >= 500) {
+        _retry(reply->errorString());
+        return;
+    }
+
+    bool tus = false;
+    if (reply->error() == QNetworkReply::NoError) {
+        for (const QByteArray& version: reply->rawHeader("Tus-Version").split(',')) {
+            if (version.trimmed() == _tusVersion) {
+                tus = true;
+            }
+        }
+    }
+
+    qCDebug(MAVLinkLogManagerLog) << "Log upload server" << _uploadURL << (tus ? "supports resumable uploads" : "takes form uploads");
+    if (tus) {
+        _create();
+    } else {
+        _postMultipart();
+    }
+}
+
+void MAVLinkLogUploader::_create(void)
+{
+    QNetworkRequest request = _tusRequest(QUrl(_uploadURL));
+    request.setRawHeader("Upload-Length", QByteArray::number(_size));
+    // tus servers know the file name by the filename metadata key, the multipart form carries it in the file part
+    FormFields_t metadataFields = _formFields;
+    metadataFields.append(qMakePair(QStringLiteral("filename"), QFileInfo(_logFile).fileName()));
+    request.setRawHeader("Upload-Metadata", tusMetadata(metadataFields));
+    request.setHeader(QNetworkRequest::ContentLengthHeader, 0);
+
+    _reply = _nam->post(request, QByteArray());
+    connect(_reply, &QNetworkReply::finished, this, &MAVLinkLogUploader::_createFinished);
+}
+
+void MAVLinkLogUploader::_createFinished(void)
+{
+    QNetworkReply* reply = _takeReply();
+    if (!reply) {
+        return;
+    }
+    if (_aborted) {
+        _fail(tr("Upload cancelled"));
+        return;
+    }
+
+    int status = _httpStatus(reply);
+    if (status == 0 || status >= 500) {
+        _retry(reply->errorString());
+        return;
+    }
+    if (status != 201 || !reply->hasRawHeader("Location")) {
+        _fail(tr("Log Upload Error: %1 status: %2").arg(reply->errorString()).arg(status), reply->readAll());
+        return;
+    }
+
+    _location   = reply->url().resolved(QUrl(QString::fromLatin1(reply->rawHeader("Location"))));
+    _offset     = 0;
+    _retryCount = 0;
+    _saveState();
+    qCDebug(MAVLinkLogManagerLog) << "Log upload created" << _logFile << _location;
+
+    _patch();
+}
+
+void MAVLinkLogUploader::_head(void)
+{
+    _reply = _nam->head(_tusRequest(_location));
+    connect(_reply, &QNetworkReply::finished, this, &MAVLinkLogUploader::_headFinished);
+}
+
+void MAVLinkLogUploader::_headFinished(void)
+{
+    QNetworkReply* reply = _takeReply();
+    if (!reply) {
+        return;
+    }
+    if (_aborted) {
+        _fail(tr("Upload cancelled"));
+        return;
+    }
+
+    int status = _httpStatus(reply);
+    if (status == 0 || status >= 500) {
+        _retry(reply->errorString());
+        return;
+    }
+    if (status == 403 || status == 404 || status == 410) {
+        // The server dropped the partial upload, the state file says it does resumable uploads though
+        qCDebug(MAVLinkLogManagerLog) << "Log upload expired on server, starting over" << _logFile << _location;
+        _removeState();
+        _location.clear();
+        _create();
+        return;
+    }
+
+    bool    ok      = false;
+    qint64  offset  = reply->rawHeader("Upload-Offset").toLongLong(&ok);
+    if (reply->error() != QNetworkReply::NoError || !ok || offset < 0 || offset > _size) {
+        _fail(tr("Log Upload Error: %1 status: %2").arg(reply->errorString()).arg(status));
+        return;
+    }
+
+    _offset = offset;
+    qCDebug(MAVLinkLogManagerLog) << "Log upload resumed" << _logFile << _offset << "of" << _size;
+    emit progress(_offset, _size);
+
+    if (_offset == _size) {
+        _complete(QByteArray());
+    } else {
+        _patch();
+    }
+}
+
+void MAVLinkLogUploader::_patch(void)
+{
+    qint64 length = _size - _offset;
+    if (length > chunkSize) {
+        length = chunkSize;
+    }
+
+    MAVLinkLogUploadDevice* device = new MAVLinkLogUploadDevice(_logFile, _offset, length, _throttle);
+    if (!device->open(QIODevice::ReadOnly)) {
+        QString errorString = device->errorString();
+        delete device;
+        _fail(tr("Could not open log file: %1").arg(errorString));
+        return;
+    }
+
+    // The length has to be known up front, or the whole body would be buffered
+    QNetworkRequest request = _tusRequest(_location);
+    request.setRawHeader("Upload-Offset", QByteArray::number(_offset));
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/offset+octet-stream");
+    request.setHeader(QNetworkRequest::ContentLengthHeader, length);
+    request.setAttribute(QNetworkRequest::DoNotBufferUploadDataAttribute, true);
+
+    _reply = _nam->sendCustomRequest(request, "PATCH", device);
+    device->setParent(_reply);
+    connect(_reply, &QNetworkReply::finished, this, &MAVLinkLogUploader::_patchFinished);
+    connect(_reply, &QNetworkReply::uploadProgress, this, [this](qint64 bytesSent, qint64 /*bytesTotal*/) {
+        emit progress(_offset + bytesSent, _size);
+    });
+}
+
+void MAVLinkLogUploader::_patchFinished(void)
+{
+    QNetworkReply* reply = _takeReply();
+    if (!reply) {
+        return;
+    }
+    if (_aborted) {
+        // The state file stays, a later upload of the log resumes
+        _fail(tr("Upload cancelled"));
+        return;
+    }
+
+    int status = _httpStatus(reply);
+    if (status == 0 || status >= 500) {
+        // How much of the chunk made it is asked for on the retry
+        _retry(reply->errorString());
+        return;
+    }
+    if (status == 409) {
+        // Our offset doesn't match the server's
+        _head();
+        return;
+    }
+    if (status != 204 && status != 200) {
+        _fail(tr("Log Upload Error: %1 status: %2").arg(reply->errorString()).arg(status), reply->readAll());
+        return;
+    }
+
+    bool    ok      = false;
+    qint64  offset  = reply->rawHeader("Upload-Offset").toLongLong(&ok);
+    if (!ok || offset <= _offset || offset > _size) {
+        _head();
+        return;
+    }
+
+    _offset     = offset;
+    _retryCount = 0;
+    emit progress(_offset, _size);
+
+    if (_offset == _size) {
+        _complete(reply->readAll());
+    } else {
+        _patch();
+    }
+}
+
+static QHttpPart _createFormPart(const QString& name, const QString& value)
+{
+    QHttpPart formPart;
+    formPart.setHeader(QNetworkRequest::ContentDispositionHeader, QString("form-data; name=\"%1\"").arg(name));
+    formPart.setBody(value.toUtf8());
+    return formPart;
+}
+
+void MAVLinkLogUploader::_postMultipart(void)
+{
+    QFile* file = new QFile(_logFile);
+    if (!file->open(QIODevice::ReadOnly)) {
+        delete file;
+        _fail(tr("Could not open log file: %1").arg(_logFile));
+        return;
+    }
+
+    QHttpMultiPart* multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+    for (const auto& field: _formFields) {
+        multiPart->append(_createFormPart(field.first, field.second));
+    }
+
+    //-- Actual Log File
+    QHttpPart logPart;
+    logPart.setHeader(QNetworkRequest::ContentTypeHeader, "application/octet-stream");
+    logPart.setHeader(QNetworkRequest::ContentDispositionHeader, QString("form-data; name=\"filearg\"; filename=\"%1\"").arg(QFileInfo(_logFile).fileName()));
+    logPart.setBodyDevice(file);
+    multiPart->append(logPart);
+    file->setParent(multiPart);
+
+    QNetworkRequest request(_uploadURL);
+    QGCNetworkService::setConsumer(request, QGCNetworkService::consumerLogUpload);
+#if QT_VERSION > 0x050600
+    request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+#endif
+    _reply = _nam->post(request, multiPart);
+    multiPart->setParent(_reply);
+    connect(_reply, &QNetworkReply::finished,         this, &MAVLinkLogUploader::_postFinished);
+    connect(_reply, &QNetworkReply::uploadProgress,   this, &MAVLinkLogUploader::progress);
+}
+
+void MAVLinkLogUploader::_postFinished(void)
+{
+    QNetworkReply* reply = _takeReply();
+    if (!reply) {
+        return;
+    }
+    if (_aborted) {
+        _fail(tr("Upload cancelled"));
+        return;
+    }
+
+    int status = _httpStatus(reply);
+    if (status == 0 || status >= 500) {
+        _retry(reply->errorString());
+        return;
+    }
+
+    QByteArray response = reply->readAll();
+    if (status == 200) {
+        _complete(response);
+    } else {
+        _fail(tr("Log Upload Error: %1 status: %2").arg(reply->errorString()).arg(status), response);
+    }
+}
+
+void MAVLinkLogUploader::_retry(const QString& errorString)
+{
+    if (_retryCount >= maxRetries) {
+        _fail(errorString);
+        return;
+    }
+
+    int delayMsecs = retryDelayMsecs << _retryCount;
+    _retryCount++;
+    qCDebug(MAVLinkLogManagerLog) << "Log upload interrupted, retrying" << _logFile << errorString << "in" << delayMsecs << "msecs";
+    _retryTimer.start(delayMsecs);
+}
+
+void MAVLinkLogUploader::_complete(const QByteArray& response)
+{
+    _removeState();
+    emit finished(true, response, QString());
+}
+
+void MAVLinkLogUploader::_fail(const QString& errorString, const QByteArray& response)
+{
+    emit finished(false, response, errorString);
+}
+
+bool MAVLinkLogUploader::_loadState(void)
+{
+    QFile file(stateFile(_logFile));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonParseError jsonParseError;
+    QJsonDocument   doc = QJsonDocument::fromJson(file.readAll(), &jsonParseError);
+    if (jsonParseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        qCWarning(MAVLinkLogManagerLog) << "Unable to parse log upload state" << file.fileName() << jsonParseError.errorString();
+        return false;
+    }
+
+    // A state for a different server or a log which changed since can't be continued
+    QJsonObject json        = doc.object();
+    QUrl        location    = QUrl(json[_jsonLocationKey].toString());
+    if (json[_jsonUploadURLKey].toString() != _uploadURL || static_cast<qint64>(json[_jsonSizeKey].toDouble()) != _size || !location.isValid()) {
+        return false;
+    }
+
+    _location = location;
+    return true;
+}
+
+void MAVLinkLogUploader::_saveState(void)
+{
+    QJsonObject json;
+    json[_jsonUploadURLKey] =   _uploadURL;
+    json[_jsonLocationKey] =    _location.toString();
+    json[_jsonSizeKey] =        static_cast<double>(_size);
+
+    QFile file(stateFile(_logFile));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(MAVLinkLogManagerLog) << "Unable to save log upload state" << file.fileName() << file.errorString();
+        return;
+    }
+    file.write(QJsonDocument(json).toJson());
+}
+
+void MAVLinkLogUploader::_removeState(void)
+{
+    QFile::remove(stateFile(_logFile));
+}
@@ -0,0 +1,159 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QFile>
+#include <QIODevice>
+#include <QList>
+#include <QNetworkReply>
+#include <QObject>
+#include <QPair>
+#include <QTimer>
+#include <QUrl>
+
+class QNetworkAccessManager;
+
+/// Token bucket which limits the combined rate of the log uploads, so they don't starve telemetry and video on a
+/// shared uplink. Times are msecs on any monotonic clock.
+class MAVLinkLogUploadThrottle
+{
+public:
+    /// @param bytesPerSecond 0 for no limit
+    MAVLinkLogUploadThrottle(qint64 bytesPerSecond = 0);
+
+    void    setBytesPerSecond   (qint64 bytesPerSecond);
+    qint64  bytesPerSecond      (void) const { return _bytesPerSecond; }
+
+    /// @return Bytes which may be sent now, at most wanted
+    qint64 take(qint64 nowMsecs, qint64 wanted);
+
+    /// @return Msecs until take will hand out the bytes, or a full bucket if that is less
+    int msecsUntilAvailable(qint64 nowMsecs, qint64 bytes);
+
+    static const qint64 minBurstBytes   = 4096;
+    static const int    burstMsecs      = 250;  ///< Bucket size, as time at the full rate
+
+private:
+    void _refill(qint64 nowMsecs);
+
+    qint64  _bytesPerSecond;
+    qint64  _burstBytes     = 0;
+    double  _tokens         = 0;
+    qint64  _lastMsecs      = -1;
+};
+
+/// Sequential device over a range of a file which reads through a throttle. Used as an upload body so only a small
+/// block of the log is in memory at a time. When the throttle is empty readyRead is emitted again once it refills.
+class MAVLinkLogUploadDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    /// @param throttle nullptr for no limit
+    MAVLinkLogUploadDevice(const QString& fileName, qint64 offset, qint64 length, MAVLinkLogUploadThrottle* throttle, QObject* parent = nullptr);
+
+    bool    open            (OpenMode mode) override;
+    void    close           (void) override;
+    bool    isSequential    (void) const override { return true; }
+    qint64  bytesAvailable  (void) const override;
+    bool    atEnd           (void) const override;
+
+    static const qint64 readBlockSize = 16 * 1024;
+
+protected:
+    qint64 readData     (char* data, qint64 maxSize) override;
+    qint64 writeData    (const char* data, qint64 maxSize) override;
+
+private:
+    QFile                       _file;
+    qint64                      _offset;
+    qint64                      _remaining;
+    MAVLinkLogUploadThrottle*   _throttle;
+    QTimer                      _refillTimer;
+};
+
+/// Uploads one log file. If the server speaks the tus 1.0 resumable upload protocol the file is sent in chunks, an
+/// upload which was interrupted continues where the server left off, also after a restart since the upload location
+/// is kept in a sidecar file next to the log. Otherwise the log goes up as a single multipart form POST.
+///
+/// Network errors are retried with an increasing delay.
+class MAVLinkLogUploader : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef QList<QPair<QString, QString>> FormFields_t;
+
+    /// @param throttle Shared by all uploads, nullptr for no limit
+    MAVLinkLogUploader(const QString& logFile, const QString& uploadURL, const FormFields_t& formFields, QNetworkAccessManager* nam, MAVLinkLogUploadThrottle* throttle, QObject* parent = nullptr);
+
+    void    start   (void);
+    void    abort   (void);
+
+    QString logFile (void) const { return _logFile; }
+
+    /// @return Upload-Metadata header value for the form fields
+    static QByteArray tusMetadata(const FormFields_t& formFields);
+
+    /// @return File which keeps the resumable upload location of the log
+    static QString stateFile(const QString& logFile);
+
+    static const qint64 chunkSize           = 1024 * 1024;
+    static const int    maxRetries          = 6;
+    static const int    retryDelayMsecs     = 2000;     ///< Doubles with each retry
+
+signals:
+    void progress(qint64 bytesSent, qint64 bytesTotal);
+    void finished(bool success, QByteArray response, QString errorString);
+
+private slots:
+    void _optionsFinished   (void);
+    void _createFinished    (void);
+    void _headFinished      (void);
+    void _patchFinished     (void);
+    void _postFinished      (void);
+    void _resume            (void);
+
+private:
+    void            _options        (void);
+    void            _create         (void);
+    void            _head           (void);
+    void            _patch          (void);
+    void            _postMultipart  (void);
+    void            _retry          (const QString& errorString);
+    void            _complete       (const QByteArray& response);
+    void            _fail           (const QString& errorString, const QByteArray& response = QByteArray());
+    bool            _loadState      (void);
+    void            _saveState      (void);
+    void            _removeState    (void);
+    QNetworkReply*  _takeReply      (void);
+    QNetworkRequest _tusRequest     (const QUrl& url) const;
+
+    static int      _httpStatus     (QNetworkReply* reply);
+
+    QString                     _logFile;
+    QString                     _uploadURL;
+    FormFields_t                _formFields;
+    QNetworkAccessManager*      _nam;
+    MAVLinkLogUploadThrottle*   _throttle;
+    QNetworkReply*              _reply          = nullptr;
+    QUrl                        _location;                  ///< tus upload resource
+    qint64                      _size           = 0;
+    qint64                      _offset         = 0;
+    int                         _retryCount     = 0;
+    bool                        _aborted        = false;
+    QTimer                      _retryTimer;
+
+    static const char* _tusVersion;
+    static const char* _stateExtension;
+    static const char* _jsonUploadURLKey;
+    static const char* _jsonLocationKey;
+    static const char* _jsonSizeKey;
+};
@@ -0,0 +1,132 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkLogUploaderTest.h"
+#include "MAVLinkLogUploader.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+static QByteArray _testData(int size)
+{
+    QByteArray data;
+    data.reserve(size);
+    for (int i=0; i<size; i++) {
+        data.append(static_cast<char>(i * 7 + i / 256));
+    }
+    return data;
+}
+
+void MAVLinkLogUploaderTest::_throttleTest(void)
+{
+    // No limit
+    MAVLinkLogUploadThrottle unlimited;
+    QCOMPARE(unlimited.take(0, 1 << 30), static_cast<qint64>(1 << 30));
+    QCOMPARE(unlimited.msecsUntilAvailable(0, 1 << 30), 0);
+
+    // 16 KiB/s makes a bucket of the minimum burst
+    const qint64                minBurstBytes = MAVLinkLogUploadThrottle::minBurstBytes;
+    MAVLinkLogUploadThrottle    throttle(16 * 1024);
+    QCOMPARE(throttle.take(1000, 100000), minBurstBytes);
+    QCOMPARE(throttle.take(1000, 1), static_cast<qint64>(0));
+    QCOMPARE(throttle.msecsUntilAvailable(1000, 1024), 63);
+
+    // Refills with time, but never above the bucket
+    QCOMPARE(throttle.take(1100, 100000), static_cast<qint64>(1638));
+    QCOMPARE(throttle.take(60000, 100000), minBurstBytes);
+
+    // More than a full bucket is only waited for up to a full bucket
+    QCOMPARE(throttle.msecsUntilAvailable(60000, 1 << 30), 250);
+
+    // Lifting the limit hands out everything again
+    throttle.setBytesPerSecond(0);
+    QCOMPARE(throttle.take(60000, 100000), static_cast<qint64>(100000));
+}
+
+void MAVLinkLogUploaderTest::_deviceTest(void)
+{
+    QTemporaryDir   tempDir;
+    QString         fileName    = tempDir.filePath("test.ulg");
+    QByteArray      data        = _testData(100000);
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(data), static_cast<qint64>(data.size()));
+    file.close();
+
+    // Only the range is read
+    MAVLinkLogUploadDevice device(fileName, 1000, 50000, nullptr);
+    QVERIFY(!device.open(QIODevice::ReadWrite));
+    QVERIFY(device.open(QIODevice::ReadOnly));
+    QVERIFY(device.isSequential());
+    QCOMPARE(device.bytesAvailable(), static_cast<qint64>(50000));
+    QCOMPARE(device.readAll(), data.mid(1000, 50000));
+    QVERIFY(device.atEnd());
+    device.close();
+
+    // A range past the end of the file is an error rather than a short upload
+    MAVLinkLogUploadDevice shortDevice(fileName, 90000, 20000, nullptr);
+    QVERIFY(shortDevice.open(QIODevice::ReadOnly));
+    QCOMPARE(shortDevice.readAll(), data.mid(90000));
+    QVERIFY(!shortDevice.atEnd());
+}
+
+void MAVLinkLogUploaderTest::_throttledDeviceTest(void)
+{
+    QTemporaryDir   tempDir;
+    QString         fileName    = tempDir.filePath("test.ulg");
+    QByteArray      data        = _testData(20000);
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(data);
+    file.close();
+
+    MAVLinkLogUploadThrottle    throttle(16 * 1024);
+    MAVLinkLogUploadDevice      device(fileName, 0, data.size(), &throttle);
+    QSignalSpy                  spyReadyRead(&device, &QIODevice::readyRead);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+
+    // The first read empties the bucket, the reader is called back once it refills
+    QByteArray received = device.read(data.size());
+    QVERIFY(received.size() >= 4096 && received.size() < data.size());
+
+    while (!device.atEnd()) {
+        QByteArray bytes = device.read(data.size());
+        if (bytes.isEmpty()) {
+            QCOMPARE(spyReadyRead.wait(1000), true);
+        }
+        received += bytes;
+    }
+    QCOMPARE(received, data);
+}
+
+void MAVLinkLogUploaderTest::_tusMetadataTest(void)
+{
+    MAVLinkLogUploader::FormFields_t formFields;
+
+    QVERIFY(MAVLinkLogUploader::tusMetadata(formFields).isEmpty());
+
+    formFields.append(qMakePair(QString("email"),       QString("a@b.c")));
+    formFields.append(qMakePair(QString("public"),      QString()));
+    formFields.append(qMakePair(QString("description"), QString::fromUtf8("F\xc3\xbc\xc3\x9f" "e")));
+    QCOMPARE(MAVLinkLogUploader::tusMetadata(formFields), QByteArray("email YUBiLmM=,public,description RsO8w59l"));
+}
+
+void MAVLinkLogUploaderTest::_stateFileTest(void)
+{
+    QString logFile     = QDir::temp().absoluteFilePath("2020-01-01-10-00-00.ulg");
+    QString stateFile   = MAVLinkLogUploader::stateFile(logFile);
+
+    QCOMPARE(QFileInfo(stateFile).fileName(), QString("2020-01-01-10-00-00.upload"));
+    QCOMPARE(QFileInfo(stateFile).absolutePath(), QFileInfo(logFile).absolutePath());
+}
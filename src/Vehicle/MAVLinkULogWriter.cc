@@ -0,0 +1,310 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkULogWriter.h"
+#include "MAVLinkLogManager.h"
+
+#include <QFile>
+
+//-----------------------------------------------------------------------------
+MAVLinkLogProcessor::MAVLinkLogProcessor()
+    : _fd(nullptr)
+    , _nextSequence(-1)
+    , _gotHeader(false)
+    , _error(false)
+{
+}
+
+//-----------------------------------------------------------------------------
+MAVLinkLogProcessor::~MAVLinkLogProcessor()
+{
+    close();
+}
+
+//-----------------------------------------------------------------------------
+bool
+MAVLinkLogProcessor::open(const QString& fileName)
+{
+    close();
+    _fileName = fileName;
+    _fd = fopen(_fileName.toLocal8Bit().data(), "wb");
+    if(!_fd) {
+        return false;
+    }
+    //-- Writes already come in writeBufferSize blocks
+    setvbuf(_fd, nullptr, _IONBF, 0);
+    _writeBuffer.clear();
+    _writeBuffer.reserve(writeBufferSize);
+    _nextSequence   = -1;
+    _gotHeader      = false;
+    _error          = false;
+    _stats          = MAVLinkLogStreamStats();
+    _pending.clear();
+    _ulogMessage.clear();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogProcessor::close()
+{
+    if(_fd) {
+        //-- Whatever was held back won't be filled in anymore
+        while(!_pending.isEmpty() && !_error) {
+            _skipGap();
+        }
+        //-- The last message is only complete once the next one starts, which it won't anymore
+        if(!_error) {
+            _writeUlogMessage(_ulogMessage);
+        }
+        _ulogMessage.clear();
+        flush();
+        fclose(_fd);
+        _fd = nullptr;
+    }
+    _pending.clear();
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogProcessor::discard()
+{
+    if(_fd) {
+        fclose(_fd);
+        _fd = nullptr;
+    }
+    _writeBuffer.clear();
+    _pending.clear();
+}
+
+//-----------------------------------------------------------------------------
+bool
+MAVLinkLogProcessor::flush()
+{
+    if(_fd && !_error && _writeBuffer.length()) {
+        _error = fwrite(_writeBuffer.constData(), 1, _writeBuffer.length(), _fd) != (size_t)_writeBuffer.length();
+        if(_error) {
+            qCWarning(MAVLinkLogManagerLog) << "File IO error:" << _writeBuffer.length() << "bytes into" << _fileName;
+        }
+        _writeBuffer.clear();
+    }
+    return !_error;
+}
+
+//-----------------------------------------------------------------------------
+bool
+MAVLinkLogProcessor::processStreamData(uint16_t sequence, uint8_t firstMessage, const QByteArray& data)
+{
+    if(!_fd || _error) {
+        return false;
+    }
+    if(_nextSequence == -1) {
+        _processPacket(firstMessage, data, 0);
+        _nextSequence = static_cast<uint16_t>(sequence + 1);
+        return !_error;
+    }
+    //-- Distance ahead of the expected packet, sequence is 2 bytes and wraps around
+    uint16_t distance = static_cast<uint16_t>(sequence - _nextSequence);
+    if(distance == 0) {
+        if(!_pending.isEmpty()) {
+            //-- Fills a gap which packets after it are waiting on
+            _stats.reordered++;
+        }
+        _processPacket(firstMessage, data, 0);
+        _nextSequence = static_cast<uint16_t>(sequence + 1);
+        _processPending();
+    } else if(distance < (1 << 15)) {
+        if(_pending.contains(sequence)) {
+            _stats.duplicates++;
+        } else {
+            _pending.insert(sequence, Packet_t{firstMessage, data});
+            if(_pending.count() > reorderWindow) {
+                _skipGap();
+            }
+        }
+    } else {
+        //-- Already written, or its gap was given up on
+        _stats.duplicates++;
+    }
+    return !_error;
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogProcessor::_processPending()
+{
+    while(!_pending.isEmpty() && _pending.contains(static_cast<uint16_t>(_nextSequence))) {
+        Packet_t packet = _pending.take(static_cast<uint16_t>(_nextSequence));
+        _processPacket(packet.firstMessage, packet.data, 0);
+        _nextSequence = static_cast<uint16_t>(_nextSequence + 1);
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogProcessor::_skipGap()
+{
+    //-- Go on with the held packet closest to the gap
+    uint16_t next       = 0;
+    int      numDrops   = -1;
+    for(auto it = _pending.constBegin(); it != _pending.constEnd(); ++it) {
+        int distance = static_cast<uint16_t>(it.key() - _nextSequence);
+        if(numDrops == -1 || distance < numDrops) {
+            numDrops    = distance;
+            next        = it.key();
+        }
+    }
+    if(numDrops == -1) {
+        return;
+    }
+    _stats.dropped += numDrops;
+    Packet_t packet = _pending.take(next);
+    _processPacket(packet.firstMessage, packet.data, numDrops);
+    _nextSequence = static_cast<uint16_t>(next + 1);
+    _processPending();
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogProcessor::_writeData(const void* data, int len)
+{
+    if(!_error) {
+        _writeBuffer.append(static_cast<const char*>(data), len);
+        _stats.bytesWritten += len;
+        if(_writeBuffer.length() >= writeBufferSize) {
+            flush();
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+QByteArray
+MAVLinkLogProcessor::_writeUlogMessage(QByteArray& data)
+{
+    //-- Write ulog data w/o integrity checking, assuming data starts with a
+    //   valid ulog message. returns the remaining data at the end.
+    while(data.length() > 2) {
+        uint8_t* ptr = (uint8_t*)data.data();
+        int message_length = ptr[0] + (ptr[1] * 256) + 3; // 3 = ULog msg header
+        if(message_length > data.length())
+            break;
+        _writeData(data.data(), message_length);
+        data.remove(0, message_length);
+    }
+    return data;
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkLogProcessor::_processPacket(uint8_t firstMessage, QByteArray data, int numDrops)
+{
+    _stats.received++;
+    //-- The first 16 bytes need special treatment (this sounds awfully brittle)
+    if(!_gotHeader) {
+        if(data.size() < 16) {
+            //-- Shouldn't happen but if it does, we might as well close shop.
+            qCWarning(MAVLinkLogManagerLog) << "Corrupt log header. Canceling log download.";
+            _error = true;
+            return;
+        }
+        //-- Write header
+        _writeData(data.data(), 16);
+        data.remove(0, 16);
+        _gotHeader = true;
+        // What about data start offset now that we removed 16 bytes off the start?
+    }
+    if(numDrops > 0) {
+        int dropoutDrops = numDrops > 25 ? 25 : numDrops;
+        //-- Hocus Pocus
+        //   Write a dropout message. We don't really know the actual duration,
+        //   so just use the number of drops * 10 ms
+        uint8_t bogus[] = {2, 0, 79, 0, 0};
+        bogus[3] = static_cast<uint8_t>(dropoutDrops * 10);
+        _writeData(bogus, sizeof(bogus));
+        _writeUlogMessage(_ulogMessage);
+        _ulogMessage.clear();
+        //-- If no useful information in this message. Drop it.
+        if(firstMessage == 255) {
+            return;
+        }
+        if(firstMessage > 0) {
+            data.remove(0, firstMessage);
+            firstMessage = 0;
+        }
+    }
+    if(firstMessage == 255 && _ulogMessage.length() > 0) {
+        _ulogMessage.append(data);
+        return;
+    }
+    if(_ulogMessage.length()) {
+        _writeData(_ulogMessage.data(), _ulogMessage.length());
+        if(firstMessage) {
+            _writeData(data.left(firstMessage).data(), firstMessage);
+        }
+        _ulogMessage.clear();
+    }
+    if(firstMessage) {
+        data.remove(0, firstMessage);
+    }
+    _ulogMessage = _writeUlogMessage(data);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+MAVLinkULogWriter::MAVLinkULogWriter(QObject* parent)
+    : QObject(parent)
+{
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkULogWriter::open(const QString& fileName)
+{
+    if(!_processor.open(fileName)) {
+        emit error(fileName, tr("Could not create MAVLink log file"));
+        return;
+    }
+    _statsTimer.start();
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkULogWriter::addData(quint16 sequence, quint8 firstMessage, QByteArray data)
+{
+    if(!_processor.valid()) {
+        return;
+    }
+    if(!_processor.processStreamData(sequence, firstMessage, data)) {
+        QString fileName = _processor.fileName();
+        _processor.close();
+        emit error(fileName, tr("Error writing MAVLink log file"));
+        return;
+    }
+    if(_statsTimer.elapsed() >= statsIntervalMsecs) {
+        _statsTimer.restart();
+        emit statsChanged(_processor.fileName(), _processor.stats());
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+MAVLinkULogWriter::close(bool discard)
+{
+    if(!_processor.valid()) {
+        return;
+    }
+    QString fileName = _processor.fileName();
+    if(discard) {
+        _processor.discard();
+        QFile::remove(fileName);
+    } else {
+        _processor.close();
+    }
+    emit closed(fileName, _processor.stats());
+}
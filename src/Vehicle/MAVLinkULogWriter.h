@@ -0,0 +1,110 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+
+#include <stdio.h>
+
+/// Sequence statistics of a streamed log, in LOGGING_DATA(_ACKED) packets
+struct MAVLinkLogStreamStats
+{
+    quint32 bytesWritten    = 0;
+    quint32 received        = 0;    ///< Packets written to the log
+    quint32 dropped         = 0;    ///< Sequence numbers which never showed up
+    quint32 reordered       = 0;    ///< Packets which arrived late and were put back in place
+    quint32 duplicates      = 0;    ///< Packets seen twice, or after their gap was given up on
+
+    /// @return Percentage of the packets which were lost
+    double dropRate(void) const { return received + dropped ? 100.0 * dropped / (received + dropped) : 0; }
+};
+
+Q_DECLARE_METATYPE(MAVLinkLogStreamStats)
+
+/// Turns the ULog stream of LOGGING_DATA(_ACKED) packets back into a ULog file. Packets which arrive out of order are
+/// held for up to reorderWindow packets waiting for the gap to fill. Gaps which don't are written as dropout messages.
+/// Writes are collected in a buffer and go to the file writeBufferSize bytes at a time.
+class MAVLinkLogProcessor
+{
+public:
+    MAVLinkLogProcessor();
+    ~MAVLinkLogProcessor();
+
+    bool    open                (const QString& fileName);
+    /// Writes all held packets and buffered data, then closes the file
+    void    close               (void);
+    /// Closes the file without writing what is left
+    void    discard             (void);
+    bool    valid               (void) const { return _fd != nullptr; }
+    QString fileName            (void) const { return _fileName; }
+    /// @return false: write error, the log is unusable
+    bool    processStreamData   (uint16_t sequence, uint8_t firstMessage, const QByteArray& data);
+    /// Writes the buffered data to the file
+    bool    flush               (void);
+
+    const MAVLinkLogStreamStats& stats(void) const { return _stats; }
+
+    static const int reorderWindow      = 16;
+    static const int writeBufferSize    = 256 * 1024;
+
+private:
+    typedef struct {
+        uint8_t     firstMessage;
+        QByteArray  data;
+    } Packet_t;
+
+    void        _processPacket      (uint8_t firstMessage, QByteArray data, int numDrops);
+    void        _processPending     (void);
+    void        _skipGap            (void);
+    QByteArray  _writeUlogMessage   (QByteArray& data);
+    void        _writeData          (const void* data, int len);
+
+    FILE*                       _fd;
+    QString                     _fileName;
+    QByteArray                  _writeBuffer;
+    int                         _nextSequence;      ///< -1 until the first packet
+    QMap<uint16_t, Packet_t>    _pending;           ///< Packets which came in ahead of a gap
+    bool                        _gotHeader;
+    bool                        _error;
+    QByteArray                  _ulogMessage;
+    MAVLinkLogStreamStats       _stats;
+};
+
+/// Lives on the log writer thread of MAVLinkLogManager, so neither the ULog reassembly nor the file writes hold up the
+/// GUI thread which receives the packets.
+class MAVLinkULogWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    MAVLinkULogWriter(QObject* parent = nullptr);
+
+    static const int statsIntervalMsecs = 1000;
+
+public slots:
+    void open       (const QString& fileName);
+    void addData    (quint16 sequence, quint8 firstMessage, QByteArray data);
+    /// @param discard true: delete the file instead of completing it
+    void close      (bool discard);
+
+signals:
+    void statsChanged   (QString fileName, MAVLinkLogStreamStats stats);
+    void closed         (QString fileName, MAVLinkLogStreamStats stats);
+    void error          (QString fileName, QString errorString);
+
+private:
+    MAVLinkLogProcessor _processor;
+    QElapsedTimer       _statsTimer;
+};
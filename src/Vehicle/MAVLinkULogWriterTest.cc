@@ -0,0 +1,250 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkULogWriterTest.h"
+#include "MAVLinkULogWriter.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+namespace {
+
+typedef struct {
+    uint8_t     firstMessage;
+    QByteArray  data;
+} TestPacket_t;
+
+const int _packetSize = 249;    ///< LOGGING_DATA payload
+
+/// ULog header followed by messages of various lengths, some of them spanning packets
+QByteArray _ulogStream(int messageCount, QList<int>& messageStarts)
+{
+    QByteArray stream("ULog\x01\x12\x35\x01\x00\x00\x00\x00\x00\x00\x00\x00", 16);
+
+    for (int i=0; i<messageCount; i++) {
+        int length = (i * 37) % 400 + 1;
+        messageStarts.append(stream.length());
+        stream.append(static_cast<char>(length & 0xff));
+        stream.append(static_cast<char>(length >> 8));
+        stream.append('D');
+        for (int j=0; j<length; j++) {
+            stream.append(static_cast<char>(i + j));
+        }
+    }
+    return stream;
+}
+
+/// Splits the stream the way the vehicle sends it. The first packet carries the header.
+QList<TestPacket_t> _packetize(const QByteArray& stream, const QList<int>& messageStarts)
+{
+    QList<TestPacket_t> packets;
+
+    for (int offset=0; offset<stream.length(); offset+=_packetSize) {
+        TestPacket_t packet;
+        packet.data         = stream.mid(offset, _packetSize);
+        packet.firstMessage = 255;
+        if (offset == 0) {
+            packet.firstMessage = 0;
+        } else {
+            for (int start: messageStarts) {
+                if (start >= offset && start < offset + _packetSize) {
+                    packet.firstMessage = static_cast<uint8_t>(start - offset);
+                    break;
+                }
+            }
+        }
+        packets.append(packet);
+    }
+    return packets;
+}
+
+QByteArray _fileContents(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+}
+
+void MAVLinkULogWriterTest::_inOrderTest(void)
+{
+    QTemporaryDir       tempDir;
+    QString             fileName = tempDir.filePath("inorder.ulg");
+    QList<int>          messageStarts;
+    QByteArray          stream  = _ulogStream(200, messageStarts);
+    QList<TestPacket_t> packets = _packetize(stream, messageStarts);
+    MAVLinkLogProcessor processor;
+
+    QVERIFY(processor.open(fileName));
+    for (int i=0; i<packets.count(); i++) {
+        QVERIFY(processor.processStreamData(static_cast<uint16_t>(i), packets[i].firstMessage, packets[i].data));
+    }
+    processor.close();
+
+    QCOMPARE(_fileContents(fileName), stream);
+    QCOMPARE(processor.stats().received, static_cast<quint32>(packets.count()));
+    QCOMPARE(processor.stats().bytesWritten, static_cast<quint32>(stream.length()));
+    QCOMPARE(processor.stats().dropped, 0u);
+    QCOMPARE(processor.stats().reordered, 0u);
+    QCOMPARE(processor.stats().duplicates, 0u);
+}
+
+void MAVLinkULogWriterTest::_reorderTest(void)
+{
+    QTemporaryDir       tempDir;
+    QString             fileName = tempDir.filePath("reorder.ulg");
+    QList<int>          messageStarts;
+    QByteArray          stream  = _ulogStream(200, messageStarts);
+    QList<TestPacket_t> packets = _packetize(stream, messageStarts);
+    MAVLinkLogProcessor processor;
+
+    // 4 comes before 3, 7 after 10, 12 twice
+    QList<int> order;
+    for (int i=0; i<packets.count(); i++) {
+        order.append(i);
+    }
+    order.move(3, 4);
+    order.move(7, 10);
+    order.insert(13, 12);
+
+    QVERIFY(processor.open(fileName));
+    for (int i: order) {
+        QVERIFY(processor.processStreamData(static_cast<uint16_t>(i), packets[i].firstMessage, packets[i].data));
+    }
+    processor.close();
+
+    // Nothing is lost
+    QCOMPARE(_fileContents(fileName), stream);
+    QCOMPARE(processor.stats().received, static_cast<quint32>(packets.count()));
+    QCOMPARE(processor.stats().dropped, 0u);
+    QCOMPARE(processor.stats().reordered, 2u);
+    QCOMPARE(processor.stats().duplicates, 1u);
+    QCOMPARE(processor.stats().dropRate(), 0.0);
+}
+
+void MAVLinkULogWriterTest::_dropTest(void)
+{
+    QTemporaryDir       tempDir;
+    QString             fileName = tempDir.filePath("drop.ulg");
+    QList<int>          messageStarts;
+    QByteArray          stream  = _ulogStream(400, messageStarts);
+    QList<TestPacket_t> packets = _packetize(stream, messageStarts);
+    const int           reorderWindow = MAVLinkLogProcessor::reorderWindow;
+    MAVLinkLogProcessor processor;
+
+    QVERIFY(packets.count() > reorderWindow + 20);
+
+    // 5 never shows up, neither does the one before last which is still waited on when the log closes
+    QVERIFY(processor.open(fileName));
+    for (int i=0; i<packets.count(); i++) {
+        if (i != 5 && i != packets.count() - 2) {
+            QVERIFY(processor.processStreamData(static_cast<uint16_t>(i), packets[i].firstMessage, packets[i].data));
+        }
+    }
+    // Given up on gap can't be filled in anymore
+    QVERIFY(processor.processStreamData(5, packets[5].firstMessage, packets[5].data));
+    processor.close();
+
+    QCOMPARE(processor.stats().received, static_cast<quint32>(packets.count() - 2));
+    QCOMPARE(processor.stats().dropped, 2u);
+    QCOMPARE(processor.stats().duplicates, 1u);
+    QVERIFY(processor.stats().dropRate() > 0);
+
+    // Gaps show up as dropout messages, the rest of the log is intact
+    QByteArray contents = _fileContents(fileName);
+    QVERIFY(contents.contains(QByteArray("\x02\x00\x4f\x0a\x00", 5)));
+    QVERIFY(contents.startsWith(stream.left(5 * _packetSize - 500)));
+    QVERIFY(contents.length() < stream.length());
+}
+
+void MAVLinkULogWriterTest::_wrapAroundTest(void)
+{
+    QTemporaryDir       tempDir;
+    QString             fileName = tempDir.filePath("wrap.ulg");
+    QList<int>          messageStarts;
+    QByteArray          stream  = _ulogStream(100, messageStarts);
+    QList<TestPacket_t> packets = _packetize(stream, messageStarts);
+    MAVLinkLogProcessor processor;
+
+    QVERIFY(processor.open(fileName));
+    for (int i=0; i<packets.count(); i++) {
+        QVERIFY(processor.processStreamData(static_cast<uint16_t>(65530 + i), packets[i].firstMessage, packets[i].data));
+    }
+    processor.close();
+
+    QCOMPARE(_fileContents(fileName), stream);
+    QCOMPARE(processor.stats().dropped, 0u);
+    QCOMPARE(processor.stats().duplicates, 0u);
+}
+
+void MAVLinkULogWriterTest::_bufferedWriteTest(void)
+{
+    QTemporaryDir       tempDir;
+    QString             fileName = tempDir.filePath("buffered.ulg");
+    QList<int>          messageStarts;
+    QByteArray          stream  = _ulogStream(100, messageStarts);
+    QList<TestPacket_t> packets = _packetize(stream, messageStarts);
+    const int           writeBufferSize = MAVLinkLogProcessor::writeBufferSize;
+    MAVLinkLogProcessor processor;
+
+    QVERIFY(stream.length() < writeBufferSize);
+
+    // Nothing goes to the file until the buffer is full or it is flushed
+    QVERIFY(processor.open(fileName));
+    for (int i=0; i<packets.count(); i++) {
+        QVERIFY(processor.processStreamData(static_cast<uint16_t>(i), packets[i].firstMessage, packets[i].data));
+    }
+    QCOMPARE(QFileInfo(fileName).size(), 0ll);
+    QVERIFY(processor.flush());
+    QCOMPARE(QFileInfo(fileName).size(), static_cast<qint64>(stream.length()));
+    processor.close();
+    QCOMPARE(_fileContents(fileName), stream);
+}
+
+void MAVLinkULogWriterTest::_writerTest(void)
+{
+    qRegisterMetaType<MAVLinkLogStreamStats>("MAVLinkLogStreamStats");
+
+    QTemporaryDir       tempDir;
+    QString             fileName = tempDir.filePath("writer.ulg");
+    QList<int>          messageStarts;
+    QByteArray          stream  = _ulogStream(100, messageStarts);
+    QList<TestPacket_t> packets = _packetize(stream, messageStarts);
+    MAVLinkULogWriter   writer;
+    QSignalSpy          spyClosed(&writer, &MAVLinkULogWriter::closed);
+    QSignalSpy          spyError(&writer, &MAVLinkULogWriter::error);
+
+    writer.open(fileName);
+    for (int i=0; i<packets.count(); i++) {
+        writer.addData(static_cast<quint16>(i), packets[i].firstMessage, packets[i].data);
+    }
+    writer.close(false);
+    QCOMPARE(spyError.count(), 0);
+    QCOMPARE(spyClosed.count(), 1);
+    QCOMPARE(spyClosed[0][0].toString(), fileName);
+    QCOMPARE(spyClosed[0][1].value<MAVLinkLogStreamStats>().bytesWritten, static_cast<quint32>(stream.length()));
+    QCOMPARE(_fileContents(fileName), stream);
+
+    // A discarded log leaves nothing behind
+    QString discardFileName = tempDir.filePath("discard.ulg");
+    writer.open(discardFileName);
+    writer.addData(0, packets[0].firstMessage, packets[0].data);
+    writer.close(true);
+    QCOMPARE(spyClosed.count(), 2);
+    QVERIFY(!QFile::exists(discardFileName));
+
+    // Failure to create the file is reported
+    writer.open(tempDir.filePath("missing/dir/error.ulg"));
+    QCOMPARE(spyError.count(), 1);
+}
@@ -0,0 +1,25 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class MAVLinkULogWriterTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _inOrderTest       (void);
+    void _reorderTest       (void);
+    void _dropTest          (void);
+    void _wrapAroundTest    (void);
+    void _bufferedWriteTest (void);
+    void _writerTest        (void);
+};
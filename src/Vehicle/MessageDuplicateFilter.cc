@@ -0,0 +1,31 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MessageDuplicateFilter.h"
+
+bool MessageDuplicateFilter::isDuplicate(const mavlink_message_t& message, qint64 nowMSecs, qint64& firstSeenMSecs)
+{
+    QVector<Entry_t>& entries = _components[(message.sysid << 8) | message.compid];
+    if (entries.isEmpty()) {
+        entries.resize(256);
+    }
+
+    Entry_t& entry = entries[message.seq];
+    if (entry.seenMSecs >= 0 && nowMSecs - entry.seenMSecs < windowMSecs && entry.msgid == message.msgid && entry.checksum == message.checksum) {
+        // The entry is left alone, so further copies still compare against the first one
+        firstSeenMSecs = entry.seenMSecs;
+        return true;
+    }
+
+    entry.seenMSecs = nowMSecs;
+    entry.msgid     = message.msgid;
+    entry.checksum  = message.checksum;
+    firstSeenMSecs  = nowMSecs;
+    return false;
+}
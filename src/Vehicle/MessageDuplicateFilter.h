@@ -0,0 +1,39 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QHash>
+#include <QVector>
+
+#include "QGCMAVLink.h"
+
+/// Spots copies of the same message arriving over more than one link. A message is identified by sysid, compid, seq
+/// and msgid, with the checksum guarding against the sequence number having wrapped around to the same message id.
+class MessageDuplicateFilter
+{
+public:
+    /// @return true: an identical message was seen less than windowMSecs ago
+    ///     @param nowMSecs Arrival time of the message
+    ///     @param[out] firstSeenMSecs Arrival time of the first copy of the message
+    bool isDuplicate(const mavlink_message_t& message, qint64 nowMSecs, qint64& firstSeenMSecs);
+
+    void clear(void) { _components.clear(); }
+
+    static const int windowMSecs = 500;
+
+private:
+    typedef struct {
+        qint64      seenMSecs   = -1;
+        uint32_t    msgid       = 0;
+        uint16_t    checksum    = 0;
+    } Entry_t;
+
+    QHash<int, QVector<Entry_t>> _components;   ///< Last message seen for each sequence number, key: sysid << 8 | compid
+};
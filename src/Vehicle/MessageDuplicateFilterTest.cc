@@ -0,0 +1,58 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MessageDuplicateFilterTest.h"
+#include "MessageDuplicateFilter.h"
+
+static mavlink_message_t _attitudeMessage(uint8_t compid, uint8_t seq, float roll)
+{
+    mavlink_message_t message;
+    mavlink_msg_attitude_pack(1, compid, &message, 0, roll, 0, 0, 0, 0, 0);
+    message.seq = seq;
+    return message;
+}
+
+void MessageDuplicateFilterTest::_duplicateTest(void)
+{
+    MessageDuplicateFilter  filter;
+    qint64                  firstSeenMSecs;
+
+    mavlink_message_t message = _attitudeMessage(MAV_COMP_ID_AUTOPILOT1, 10, 1);
+    QVERIFY(!filter.isDuplicate(message, 100, firstSeenMSecs));
+    QCOMPARE(firstSeenMSecs, static_cast<qint64>(100));
+
+    // Second and third link deliver the same message later
+    QVERIFY(filter.isDuplicate(message, 130, firstSeenMSecs));
+    QCOMPARE(firstSeenMSecs, static_cast<qint64>(100));
+    QVERIFY(filter.isDuplicate(message, 180, firstSeenMSecs));
+    QCOMPARE(firstSeenMSecs, static_cast<qint64>(100));
+
+    // Same sequence number from another component is a different message
+    QVERIFY(!filter.isDuplicate(_attitudeMessage(MAV_COMP_ID_CAMERA, 10, 1), 130, firstSeenMSecs));
+}
+
+void MessageDuplicateFilterTest::_windowTest(void)
+{
+    MessageDuplicateFilter  filter;
+    qint64                  firstSeenMSecs;
+
+    mavlink_message_t message = _attitudeMessage(MAV_COMP_ID_AUTOPILOT1, 10, 1);
+    QVERIFY(!filter.isDuplicate(message, 0, firstSeenMSecs));
+    QVERIFY(!filter.isDuplicate(message, MessageDuplicateFilter::windowMSecs, firstSeenMSecs));
+}
+
+void MessageDuplicateFilterTest::_wrapTest(void)
+{
+    MessageDuplicateFilter  filter;
+    qint64                  firstSeenMSecs;
+
+    // Sequence number wrapped around to the same message id within the window, the contents tell them apart
+    QVERIFY(!filter.isDuplicate(_attitudeMessage(MAV_COMP_ID_AUTOPILOT1, 10, 1), 0, firstSeenMSecs));
+    QVERIFY(!filter.isDuplicate(_attitudeMessage(MAV_COMP_ID_AUTOPILOT1, 10, 2), 100, firstSeenMSecs));
+}
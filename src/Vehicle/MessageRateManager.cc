@@ -0,0 +1,221 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MessageRateManager.h"
+
+QGC_LOGGING_CATEGORY(MessageRateManagerLog, "MessageRateManagerLog")
+
+MessageRateManager::MessageRateManager(Vehicle* vehicle)
+    : QObject   (vehicle)
+    , _vehicle  (vehicle)
+{
+
+}
+
+void MessageRateManager::requestMessageRate(QObject* consumer, int msgId, double rateHz)
+{
+    _trackConsumer(consumer);
+    _messageRequests[msgId][consumer] = rateHz;
+    _updateMessage(msgId);
+}
+
+void MessageRateManager::removeMessageRate(QObject* consumer, int msgId)
+{
+    if (_messageRequests.contains(msgId)) {
+        _messageRequests[msgId].remove(consumer);
+        if (_messageRequests[msgId].isEmpty()) {
+            _messageRequests.remove(msgId);
+        }
+    }
+    _updateMessage(msgId);
+}
+
+void MessageRateManager::requestStreamRate(QObject* consumer, MAV_DATA_STREAM stream, int rateHz)
+{
+    _trackConsumer(consumer);
+    _streamRequests[stream][consumer] = rateHz;
+    _updateStream(stream);
+}
+
+void MessageRateManager::removeStreamRate(QObject* consumer, MAV_DATA_STREAM stream)
+{
+    if (_streamRequests.contains(stream)) {
+        _streamRequests[stream].remove(consumer);
+        if (_streamRequests[stream].isEmpty()) {
+            _streamRequests.remove(stream);
+        }
+    }
+    _updateStream(stream);
+}
+
+void MessageRateManager::removeConsumer(QObject* consumer)
+{
+    if (!_consumers.contains(consumer)) {
+        return;
+    }
+    disconnect(consumer, &QObject::destroyed, this, &MessageRateManager::_consumerDestroyed);
+    _consumerDestroyed(consumer);
+}
+
+void MessageRateManager::_consumerDestroyed(QObject* consumer)
+{
+    // Only the pointer is used from here on, the consumer may be half destroyed
+    _consumers.remove(consumer);
+
+    for (int msgId: _messageRequests.keys()) {
+        if (_messageRequests[msgId].contains(consumer)) {
+            removeMessageRate(consumer, msgId);
+        }
+    }
+    for (int stream: _streamRequests.keys()) {
+        if (_streamRequests[stream].contains(consumer)) {
+            removeStreamRate(consumer, static_cast<MAV_DATA_STREAM>(stream));
+        }
+    }
+}
+
+void MessageRateManager::_trackConsumer(QObject* consumer)
+{
+    if (!_consumers.contains(consumer)) {
+        _consumers.insert(consumer);
+        connect(consumer, &QObject::destroyed, this, &MessageRateManager::_consumerDestroyed);
+    }
+}
+
+double MessageRateManager::requestedMessageRate(QObject* consumer, int msgId) const
+{
+    return _messageRequests.value(msgId).value(consumer, 0);
+}
+
+double MessageRateManager::messageRate(int msgId) const
+{
+    double rateHz = 0;
+    for (double requestedRateHz: _messageRequests.value(msgId)) {
+        rateHz = qMax(rateHz, requestedRateHz);
+    }
+
+    auto limitIt = _messageRateLimits.constFind(msgId);
+    if (limitIt != _messageRateLimits.constEnd()) {
+        if (limitIt.value() <= 0) {
+            return -1;
+        }
+        // Without requests the limit stands in for the vehicle default, which isn't known
+        rateHz = rateHz > 0 ? qMin(rateHz, limitIt.value()) : limitIt.value();
+    }
+
+    return rateHz;
+}
+
+void MessageRateManager::setMessageRateLimits(const QHash<int, double>& limits)
+{
+    const QHash<int, double> oldLimits = _messageRateLimits;
+
+    _messageRateLimits = limits;
+    for (int msgId: oldLimits.keys()) {
+        if (!limits.contains(msgId)) {
+            _updateMessage(msgId);
+        }
+    }
+    for (int msgId: limits.keys()) {
+        _updateMessage(msgId);
+    }
+}
+
+void MessageRateManager::setMessageIntervalsEnabled(bool enabled)
+{
+    if (enabled != _messageIntervalsEnabled) {
+        qCDebug(MessageRateManagerLog) << "Message intervals enabled" << enabled;
+        _messageIntervalsEnabled = enabled;
+        _sendNextMessage();
+    }
+}
+
+int MessageRateManager::streamRate(MAV_DATA_STREAM stream) const
+{
+    int rateHz = -1;
+    for (int requestedRateHz: _streamRequests.value(stream)) {
+        rateHz = qMax(rateHz, requestedRateHz);
+    }
+    return rateHz;
+}
+
+void MessageRateManager::_updateMessage(int msgId)
+{
+    if (messageRate(msgId) != _messageRatesSent.value(msgId, 0) && !_pendingMessages.contains(msgId)) {
+        _pendingMessages.append(msgId);
+    }
+    _sendNextMessage();
+}
+
+void MessageRateManager::_updateStream(int stream)
+{
+    const int rateHz = streamRate(static_cast<MAV_DATA_STREAM>(stream));
+
+    if (rateHz < 0 || rateHz == _streamRatesSent.value(stream, -1) || _vehicle->isOfflineEditingVehicle()) {
+        return;
+    }
+
+    qCDebug(MessageRateManagerLog) << "Stream" << stream << "rate" << rateHz;
+    _streamRatesSent[stream] = rateHz;
+    _vehicle->requestDataStream(static_cast<MAV_DATA_STREAM>(stream), static_cast<uint16_t>(rateHz));
+}
+
+void MessageRateManager::_sendNextMessage(void)
+{
+    // Without a link the command would never complete, pending rates go out with the next request
+    if (_messageCommandInFlight || !_messageIntervalsEnabled || _vehicle->isOfflineEditingVehicle() || _vehicle->vehicleLinkManager()->primaryLink().expired()) {
+        return;
+    }
+
+    while (!_pendingMessages.isEmpty()) {
+        const int       msgId   = _pendingMessages.takeFirst();
+        const double    rateHz  = messageRate(msgId);
+
+        // Requests may have come and gone while waiting
+        if (rateHz == _messageRatesSent.value(msgId, 0)) {
+            continue;
+        }
+
+        qCDebug(MessageRateManagerLog) << "Message" << msgId << "rate" << rateHz;
+        if (rateHz != 0) {
+            _messageRatesSent[msgId] = rateHz;
+        } else {
+            _messageRatesSent.remove(msgId);
+        }
+
+        // Interval 0 sets the message back to the vehicle default, -1 turns it off
+        float intervalUSecs = 0;
+        if (rateHz > 0) {
+            intervalUSecs = static_cast<float>(1000000.0 / rateHz);
+        } else if (rateHz < 0) {
+            intervalUSecs = -1;
+        }
+
+        _messageCommandInFlight = true;
+        _vehicle->sendMavCommandWithHandler(_setMessageIntervalResultHandler,
+                                            this,
+                                            _vehicle->defaultComponentId(),
+                                            MAV_CMD_SET_MESSAGE_INTERVAL,
+                                            msgId,
+                                            intervalUSecs);
+        return;
+    }
+}
+
+void MessageRateManager::_setMessageIntervalResultHandler(void* resultHandlerData, int /*compId*/, MAV_RESULT commandResult, Vehicle::MavCmdResultFailureCode_t failureCode)
+{
+    MessageRateManager* messageRateManager = static_cast<MessageRateManager*>(resultHandlerData);
+
+    if (commandResult != MAV_RESULT_ACCEPTED) {
+        qCDebug(MessageRateManagerLog) << "MAV_CMD_SET_MESSAGE_INTERVAL failed" << commandResult << failureCode;
+    }
+
+    messageRateManager->_messageCommandInFlight = false;
+    messageRateManager->_sendNextMessage();
+}
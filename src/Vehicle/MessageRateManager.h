@@ -0,0 +1,97 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCMAVLink.h"
+#include "QGCLoggingCategory.h"
+#include "Vehicle.h"
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+
+Q_DECLARE_LOGGING_CATEGORY(MessageRateManagerLog)
+
+class MessageRateManagerTest;
+
+/// Central registry of the message and stream rates consumers need from a vehicle. Each message or stream is set to
+/// the highest rate any consumer asks for. When consumers go away the rate drops to the highest remaining request,
+/// or back to the vehicle default once nobody needs the message any more.
+///
+/// Messages are set with MAV_CMD_SET_MESSAGE_INTERVAL, one command at a time since only one can be in flight per
+/// component. Streams are set with REQUEST_DATA_STREAM. Streams have no default to go back to, so they keep their
+/// last rate once all requests are gone.
+///
+/// Requests of a consumer are removed automatically when it is destroyed.
+///
+/// Rate limits cap messages below what consumers ask for, and below the vehicle default, to keep a link within its
+/// bandwidth budget. See VehicleLinkManager telemetry profiles.
+class MessageRateManager : public QObject
+{
+    Q_OBJECT
+
+    friend class MessageRateManagerTest;
+
+public:
+    MessageRateManager(Vehicle* vehicle);
+
+    /// Asks for the message at rateHz or faster
+    void requestMessageRate (QObject* consumer, int msgId, double rateHz);
+    void removeMessageRate  (QObject* consumer, int msgId);
+
+    /// Asks for the data stream at rateHz or faster. 0 asks for the stream to be off, which only holds as long as no
+    /// other consumer needs it.
+    void requestStreamRate  (QObject* consumer, MAV_DATA_STREAM stream, int rateHz);
+    void removeStreamRate   (QObject* consumer, MAV_DATA_STREAM stream);
+
+    /// Removes all requests of the consumer
+    void removeConsumer     (QObject* consumer);
+
+    /// Replaces all rate limits
+    ///     @param limits Highest rate for each message, 0 turns it off. Key: message id
+    void setMessageRateLimits       (const QHash<int, double>& limits);
+    QHash<int, double> messageRateLimits(void) const { return _messageRateLimits; }
+
+    /// false: Rate changes are held back until enabled again, for links where commands are expensive
+    void setMessageIntervalsEnabled (bool enabled);
+    bool messageIntervalsEnabled    (void) const { return _messageIntervalsEnabled; }
+
+    /// @return Rate the consumer asked for, 0 for none
+    double  requestedMessageRate    (QObject* consumer, int msgId) const;
+
+    /// @return Highest rate asked for within the limit, 0 for the vehicle default, -1 for off
+    double  messageRate             (int msgId) const;
+
+    /// @return Highest rate asked for, -1 for no requests
+    int     streamRate              (MAV_DATA_STREAM stream) const;
+
+private slots:
+    void _consumerDestroyed(QObject* consumer);
+
+private:
+    void _trackConsumer     (QObject* consumer);
+    void _updateMessage     (int msgId);
+    void _updateStream      (int stream);
+    void _sendNextMessage   (void);
+
+    static void _setMessageIntervalResultHandler(void* resultHandlerData, int compId, MAV_RESULT commandResult, Vehicle::MavCmdResultFailureCode_t failureCode);
+
+    Vehicle*                                _vehicle;
+    QHash<int, QHash<QObject*, double>>     _messageRequests;               ///< Key: message id
+    QHash<int, double>                      _messageRatesSent;              ///< Rate last set on the vehicle, key: message id
+    QList<int>                              _pendingMessages;               ///< Messages whose rate still has to be sent
+    bool                                    _messageCommandInFlight = false;
+    QHash<int, double>                      _messageRateLimits;             ///< Key: message id
+    bool                                    _messageIntervalsEnabled = true;
+    QHash<int, QHash<QObject*, int>>        _streamRequests;                ///< Key: MAV_DATA_STREAM
+    QHash<int, int>                         _streamRatesSent;
+    QSet<QObject*>                          _consumers;
+};
@@ -0,0 +1,72 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MessageRateManagerTest.h"
+#include "MessageRateManager.h"
+#include "MultiVehicleManager.h"
+#include "QGCApplication.h"
+
+void MessageRateManagerTest::_messageRateTest(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    Vehicle*            vehicle             = qgcApp()->toolbox()->multiVehicleManager()->activeVehicle();
+    MessageRateManager* messageRateManager  = vehicle->messageRateManager();
+    const int           baseSendCount       = vehicle->mavCommandStats(MAV_CMD_SET_MESSAGE_INTERVAL).sendCount;
+    QObject*            consumer1           = new QObject(this);
+    QObject             consumer2;
+
+    QCOMPARE(messageRateManager->messageRate(MAVLINK_MSG_ID_ATTITUDE), 0.0);
+
+    // Highest request wins
+    messageRateManager->requestMessageRate(consumer1, MAVLINK_MSG_ID_ATTITUDE, 10);
+    messageRateManager->requestMessageRate(&consumer2, MAVLINK_MSG_ID_ATTITUDE, 50);
+    QCOMPARE(messageRateManager->messageRate(MAVLINK_MSG_ID_ATTITUDE), 50.0);
+    QCOMPARE(messageRateManager->requestedMessageRate(consumer1, MAVLINK_MSG_ID_ATTITUDE), 10.0);
+
+    // Back down to what is left once the consumers go away
+    messageRateManager->removeMessageRate(&consumer2, MAVLINK_MSG_ID_ATTITUDE);
+    QCOMPARE(messageRateManager->messageRate(MAVLINK_MSG_ID_ATTITUDE), 10.0);
+    delete consumer1;
+    QCOMPARE(messageRateManager->messageRate(MAVLINK_MSG_ID_ATTITUDE), 0.0);
+
+    // The first rate went out right away, the changes which piled up behind it collapse into the final vehicle default
+    QTRY_VERIFY(!messageRateManager->_messageCommandInFlight && messageRateManager->_pendingMessages.isEmpty());
+    QCOMPARE(vehicle->mavCommandStats(MAV_CMD_SET_MESSAGE_INTERVAL).sendCount - baseSendCount, 2);
+    QVERIFY(!messageRateManager->_messageRatesSent.contains(MAVLINK_MSG_ID_ATTITUDE));
+
+    _disconnectMockLink();
+}
+
+void MessageRateManagerTest::_streamRateTest(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    MessageRateManager* messageRateManager = qgcApp()->toolbox()->multiVehicleManager()->activeVehicle()->messageRateManager();
+    QObject             consumer1;
+    QObject             consumer2;
+
+    QCOMPARE(messageRateManager->streamRate(MAV_DATA_STREAM_RAW_SENSORS), -1);
+
+    messageRateManager->requestStreamRate(&consumer1, MAV_DATA_STREAM_RAW_SENSORS, 0);
+    QCOMPARE(messageRateManager->streamRate(MAV_DATA_STREAM_RAW_SENSORS), 0);
+    messageRateManager->requestStreamRate(&consumer2, MAV_DATA_STREAM_RAW_SENSORS, 10);
+    QCOMPARE(messageRateManager->streamRate(MAV_DATA_STREAM_RAW_SENSORS), 10);
+
+    messageRateManager->removeConsumer(&consumer2);
+    QCOMPARE(messageRateManager->streamRate(MAV_DATA_STREAM_RAW_SENSORS), 0);
+    QCOMPARE(messageRateManager->_streamRatesSent.value(MAV_DATA_STREAM_RAW_SENSORS), 0);
+
+    // Streams have no default to go back to, the last rate stays
+    messageRateManager->removeStreamRate(&consumer1, MAV_DATA_STREAM_RAW_SENSORS);
+    QCOMPARE(messageRateManager->streamRate(MAV_DATA_STREAM_RAW_SENSORS), -1);
+    QCOMPARE(messageRateManager->_streamRatesSent.value(MAV_DATA_STREAM_RAW_SENSORS), 0);
+
+    _disconnectMockLink();
+}
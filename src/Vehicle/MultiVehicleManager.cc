@@ -16,6 +16,7 @@
 #include "ParameterManager.h"
 #include "SettingsManager.h"
 #include "QGCCorePlugin.h"
+#include "QGCPowerManager.h"
 #include "QGCOptions.h"
 #include "LinkManager.h"
 
@@ -44,6 +45,9 @@ MultiVehicleManager::MultiVehicleManager(QGCApplication* app, QGCToolbox* toolbo
     _gcsHeartbeatEnabled = settings.value(_gcsHeartbeatEnabledKey, true).toBool();
     _gcsHeartbeatTimer.setInterval(_gcsHeartbeatRateMSecs);
     _gcsHeartbeatTimer.setSingleShot(false);
+    _lightweightTimer.setInterval(Vehicle::lightweightUpdateMSecs);
+    _lightweightTimer.setWindow(Vehicle::lightweightUpdateMSecs);
+    _lightweightTimer.setSingleShot(false);
 }
 
 void MultiVehicleManager::setToolbox(QGCToolbox *toolbox)
@@ -59,6 +63,7 @@ void MultiVehicleManager::setToolbox(QGCToolbox *toolbox)
 
     connect(_mavlinkProtocol, &MAVLinkProtocol::vehicleHeartbeatInfo, this, &MultiVehicleManager::_vehicleHeartbeatInfo);
     connect(&_gcsHeartbeatTimer, &QTimer::timeout, this, &MultiVehicleManager::_sendGCSHeartbeat);
+    connect(&_lightweightTimer,  &QGCWheelTimer::timeout, this, &MultiVehicleManager::_lightweightUpdate);
 
     if (_gcsHeartbeatEnabled) {
         _gcsHeartbeatTimer.start();
@@ -137,6 +142,7 @@ void MultiVehicleManager::_vehicleHeartbeatInfo(LinkInterface* link, int vehicle
 
     if (_vehicles.count() > 1) {
         qgcApp()->showAppMessage(tr("Connected to Vehicle %1").arg(vehicleId));
+        _updateLightweight();
     } else {
         setActiveVehicle(vehicle);
     }
@@ -236,6 +242,7 @@ void MultiVehicleManager::_deleteVehiclePhase2(void)
     }
 
     _activeVehicle = newActiveVehicle;
+    _updateLightweight();
     emit activeVehicleChanged(newActiveVehicle);
 
     if (_activeVehicle) {
@@ -284,8 +291,9 @@ void MultiVehicleManager::_setActiveVehiclePhase2(void)
         connect(_vehicleBeingSetActive, &Vehicle::coordinateChanged, this, &MultiVehicleManager::_coordinateChanged);
     }
 
-    // Now we signal the new active vehicle
+    // Now we signal the new active vehicle, promoted to a full vehicle first
     _activeVehicle = _vehicleBeingSetActive;
+    _updateLightweight();
     emit activeVehicleChanged(_activeVehicle);
 
     // And finally vehicle availability
@@ -300,6 +308,38 @@ void MultiVehicleManager::_setActiveVehiclePhase2(void)
     }
 }
 
+void MultiVehicleManager::_updateLightweight(void)
+{
+    const bool scalingMode = _vehicles.count() >= scalingModeVehicleCount;
+    if (scalingMode != _scalingMode) {
+        qCDebug(MultiVehicleManagerLog) << "Scaling mode" << scalingMode;
+        _scalingMode = scalingMode;
+        emit scalingModeChanged(_scalingMode);
+    }
+
+    for (int i=0; i<_vehicles.count(); i++) {
+        Vehicle* vehicle = _vehicles.value<Vehicle*>(i);
+        vehicle->setLightweight(_scalingMode && vehicle != _activeVehicle);
+    }
+
+    if (_scalingMode) {
+        if (!_lightweightTimer.isActive()) {
+            _lightweightTimer.start();
+        }
+    } else {
+        _lightweightTimer.stop();
+    }
+}
+
+void MultiVehicleManager::_lightweightUpdate(void)
+{
+    // The timer itself keeps its rate, it also drives command retries of the lightweight vehicles
+    const int rateFactor = _toolbox->powerManager()->updateRateFactor();
+    for (int i=0; i<_vehicles.count(); i++) {
+        _vehicles.value<Vehicle*>(i)->lightweightUpdate(rateFactor);
+    }
+}
+
 void MultiVehicleManager::_coordinateChanged(QGeoCoordinate coordinate)
 {
     _lastKnownLocation = coordinate;
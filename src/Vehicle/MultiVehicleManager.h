@@ -45,6 +45,7 @@ public:
     Q_PROPERTY(bool                 gcsHeartBeatEnabled             READ gcsHeartbeatEnabled            WRITE setGcsHeartbeatEnabled    NOTIFY gcsHeartBeatEnabledChanged)
     Q_PROPERTY(Vehicle*             offlineEditingVehicle           READ offlineEditingVehicle                                          CONSTANT)
     Q_PROPERTY(QGeoCoordinate       lastKnownLocation               READ lastKnownLocation                                              NOTIFY lastKnownLocationChanged) //< Current vehicles last know location
+    Q_PROPERTY(bool                 scalingMode                     READ scalingMode                                                    NOTIFY scalingModeChanged)
 
     // Methods
 
@@ -73,6 +74,12 @@ public:
 
     QGeoCoordinate lastKnownLocation    () { return _lastKnownLocation; }
 
+    /// With many vehicles all but the active vehicle are lightweight, see Vehicle::setLightweight. They are driven by
+    /// a single shared timer and the active vehicle is promoted to a full vehicle.
+    bool scalingMode                    () const { return _scalingMode; }
+
+    static const int scalingModeVehicleCount = 5;   ///< Scaling mode is on from this many vehicles
+
 signals:
     void vehicleAdded                   (Vehicle* vehicle);
     void vehicleRemoved                 (Vehicle* vehicle);
@@ -81,6 +88,7 @@ signals:
     void activeVehicleChanged           (Vehicle* activeVehicle);
     void gcsHeartBeatEnabledChanged     (bool gcsHeartBeatEnabled);
     void lastKnownLocationChanged       ();
+    void scalingModeChanged             (bool scalingMode);
 #ifndef DOXYGEN_SKIP
     void _deleteVehiclePhase2Signal     (void);
 #endif
@@ -94,9 +102,11 @@ private slots:
     void _vehicleHeartbeatInfo          (LinkInterface* link, int vehicleId, int componentId, int vehicleFirmwareType, int vehicleType);
     void _requestProtocolVersion        (unsigned version);
     void _coordinateChanged             (QGeoCoordinate coordinate);
+    void _lightweightUpdate             (void);
 
 private:
-    bool _vehicleExists(int vehicleId);
+    bool _vehicleExists         (int vehicleId);
+    void _updateLightweight     (void);
 
     bool        _activeVehicleAvailable;            ///< true: An active vehicle is available
     bool        _parameterReadyVehicleAvailable;    ///< true: An active vehicle with ready parameters is available
@@ -115,6 +125,9 @@ private:
     MAVLinkProtocol*            _mavlinkProtocol;
     QGeoCoordinate              _lastKnownLocation;
 
+    bool                _scalingMode = false;
+    QGCWheelTimer       _lightweightTimer { "Vehicle" };    ///< Shared by all lightweight vehicles
+
     QTimer              _gcsHeartbeatTimer;             ///< Timer to emit heartbeats
     bool                _gcsHeartbeatEnabled;           ///< Enabled/disable heartbeat emission
     static const int    _gcsHeartbeatRateMSecs = 1000;  ///< Heartbeat rate
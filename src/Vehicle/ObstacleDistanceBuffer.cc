@@ -0,0 +1,167 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ObstacleDistanceBuffer.h"
+
+#include <QSet>
+#include <QtMath>
+
+#include <cmath>
+
+//-----------------------------------------------------------------------------
+bool
+ObstacleDistanceBuffer::_moved(const QVector3D& point1, const QVector3D& point2)
+{
+    return (point1 - point2).lengthSquared() * 10000.0f > static_cast<float>(deltaCentimeters * deltaCentimeters);
+}
+
+//-----------------------------------------------------------------------------
+bool
+ObstacleDistanceBuffer::update(uint8_t compId, const mavlink_obstacle_distance_t& message, double headingDegrees, qint64 nowMsecs)
+{
+    double increment = static_cast<double>(message.increment);
+    if(std::isfinite(message.increment_f) && message.increment_f > 0) {
+        increment = static_cast<double>(message.increment_f);
+    }
+    //-- Sectors are relative to north unless the sensor says they are relative to the front of the vehicle
+    double startAngle = static_cast<double>(message.angle_offset);
+    if(message.frame != MAV_FRAME_BODY_FRD && std::isfinite(headingDegrees)) {
+        startAngle -= headingDegrees;
+    }
+    QVector<QVector3D> points;
+    points.reserve(MAVLINK_MSG_OBSTACLE_DISTANCE_FIELD_DISTANCES_LEN);
+    for(int i = 0; i < MAVLINK_MSG_OBSTACLE_DISTANCE_FIELD_DISTANCES_LEN; i++) {
+        //-- UINT16_MAX: unknown, max_distance + 1: nothing in range
+        uint16_t distance = message.distances[i];
+        if(distance == UINT16_MAX || distance < message.min_distance || distance > message.max_distance) {
+            continue;
+        }
+        double angle = qDegreesToRadians(startAngle + increment * i);
+        double range = distance / 100.0;
+        points.append(QVector3D(static_cast<float>(range * cos(angle)), static_cast<float>(range * sin(angle)), 0));
+    }
+
+    quint16 key     = _sensorKey(compId, message.sensor_type);
+    auto    sensor  = _sensors.find(key);
+    if(sensor == _sensors.end()) {
+        _sensors.insert(key, Sensor_t{points, nowMsecs});
+        _dirty = true;
+        return true;
+    }
+    sensor->lastMsecs = nowMsecs;
+    bool changed = sensor->points.count() != points.count();
+    for(int i = 0; !changed && i < points.count(); i++) {
+        changed = _moved(sensor->points[i], points[i]);
+    }
+    if(changed) {
+        sensor->points = points;
+        _dirty = true;
+    }
+    return changed;
+}
+
+#if defined(MAVLINK_MSG_ID_OBSTACLE_DISTANCE_3D)
+//-----------------------------------------------------------------------------
+bool
+ObstacleDistanceBuffer::update3D(uint8_t compId, const mavlink_obstacle_distance_3d_t& message, qint64 nowMsecs)
+{
+    //-- Local NED obstacles would need the vehicle's local position, which isn't tracked
+    if(message.frame != MAV_FRAME_BODY_FRD || !std::isfinite(message.x) || !std::isfinite(message.y) || !std::isfinite(message.z)) {
+        return false;
+    }
+    QVector3D   point(message.x, message.y, message.z);
+    quint32     key         = (static_cast<quint32>(compId) << 16) | message.obstacle_id;
+    auto        obstacle    = _obstacles.find(key);
+    if(obstacle == _obstacles.end()) {
+        _obstacles.insert(key, Obstacle_t{point, _sensorKey(compId, message.sensor_type), nowMsecs});
+        _dirty = true;
+        return true;
+    }
+    obstacle->lastMsecs = nowMsecs;
+    if(_moved(obstacle->point, point)) {
+        obstacle->point = point;
+        _dirty = true;
+        return true;
+    }
+    return false;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+bool
+ObstacleDistanceBuffer::expire(qint64 nowMsecs)
+{
+    bool changed = false;
+    for(auto it = _sensors.begin(); it != _sensors.end(); ) {
+        if(nowMsecs - it->lastMsecs > timeoutMsecs) {
+            it = _sensors.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+    for(auto it = _obstacles.begin(); it != _obstacles.end(); ) {
+        if(nowMsecs - it->lastMsecs > timeoutMsecs) {
+            it = _obstacles.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+    _dirty |= changed;
+    return changed;
+}
+
+//-----------------------------------------------------------------------------
+void
+ObstacleDistanceBuffer::clear()
+{
+    _sensors.clear();
+    _obstacles.clear();
+    _points.clear();
+    _dirty = false;
+}
+
+//-----------------------------------------------------------------------------
+int
+ObstacleDistanceBuffer::sensorCount() const
+{
+    QSet<quint16> keys;
+    for(auto it = _sensors.constBegin(); it != _sensors.constEnd(); ++it) {
+        keys.insert(it.key());
+    }
+    for(const Obstacle_t& obstacle: _obstacles) {
+        keys.insert(obstacle.sensorKey);
+    }
+    return keys.count();
+}
+
+//-----------------------------------------------------------------------------
+const QVector<QVector3D>&
+ObstacleDistanceBuffer::points()
+{
+    if(_dirty) {
+        //-- A new vector, so copies handed out before keep the points they were given
+        QVector<QVector3D> points;
+        int count = _obstacles.count();
+        for(const Sensor_t& sensor: _sensors) {
+            count += sensor.points.count();
+        }
+        points.reserve(count);
+        for(const Sensor_t& sensor: _sensors) {
+            points += sensor.points;
+        }
+        for(const Obstacle_t& obstacle: _obstacles) {
+            points.append(obstacle.point);
+        }
+        _points = points;
+        _dirty  = false;
+    }
+    return _points;
+}
@@ -0,0 +1,69 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QMap>
+#include <QVector>
+#include <QVector3D>
+
+#include "QGCMAVLink.h"
+
+/// Obstacles seen by all proximity sensors of a vehicle, kept apart per sensor and packed into a single point buffer
+/// for drawing. Points are in meters in the vehicle body frame: x forward, y right, z down.
+///
+/// A sensor's points are only replaced when one of them moved by more than deltaCentimeters, or obstacles came or
+/// went. Sensors and OBSTACLE_DISTANCE_3D obstacles which aren't reported again within timeoutMsecs are dropped.
+class ObstacleDistanceBuffer
+{
+public:
+    /// Sectors from OBSTACLE_DISTANCE
+    ///     @param compId Component which sent the message
+    ///     @param headingDegrees Vehicle heading, used for north aligned sensors
+    /// @return true: the points changed
+    bool update     (uint8_t compId, const mavlink_obstacle_distance_t& message, double headingDegrees, qint64 nowMsecs);
+#if defined(MAVLINK_MSG_ID_OBSTACLE_DISTANCE_3D)
+    /// A single obstacle from OBSTACLE_DISTANCE_3D. Only MAV_FRAME_BODY_FRD is supported.
+    /// @return true: the points changed
+    bool update3D   (uint8_t compId, const mavlink_obstacle_distance_3d_t& message, qint64 nowMsecs);
+#endif
+    /// Drops what wasn't reported within timeoutMsecs
+    /// @return true: the points changed
+    bool expire     (qint64 nowMsecs);
+    void clear      (void);
+
+    bool isEmpty    (void) const { return _sensors.isEmpty() && _obstacles.isEmpty(); }
+    int  sensorCount(void) const;
+
+    /// @return Points of all sensors. Implicitly shared, so holding on to a copy is cheap until the points change.
+    const QVector<QVector3D>& points(void);
+
+    static const int timeoutMsecs       = 2000;
+    static const int deltaCentimeters   = 10;
+
+private:
+    typedef struct {
+        QVector<QVector3D>  points;
+        qint64              lastMsecs;
+    } Sensor_t;
+
+    typedef struct {
+        QVector3D   point;
+        quint16     sensorKey;
+        qint64      lastMsecs;
+    } Obstacle_t;
+
+    static quint16  _sensorKey  (uint8_t compId, uint8_t sensorType) { return static_cast<quint16>((compId << 8) | sensorType); }
+    static bool     _moved      (const QVector3D& point1, const QVector3D& point2);
+
+    QMap<quint16, Sensor_t>     _sensors;           ///< OBSTACLE_DISTANCE sectors by component and sensor type
+    QMap<quint32, Obstacle_t>   _obstacles;         ///< OBSTACLE_DISTANCE_3D by component and obstacle id
+    QVector<QVector3D>          _points;
+    bool                        _dirty  = false;    ///< _points needs to be packed again
+};
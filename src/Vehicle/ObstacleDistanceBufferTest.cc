@@ -0,0 +1,163 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ObstacleDistanceBufferTest.h"
+#include "ObstacleDistanceBuffer.h"
+
+static mavlink_obstacle_distance_t _testMessage(uint16_t distance, uint8_t frame = MAV_FRAME_BODY_FRD, uint8_t sensorType = MAV_DISTANCE_SENSOR_LASER)
+{
+    mavlink_obstacle_distance_t message;
+    memset(&message, 0, sizeof(message));
+    message.sensor_type     = sensorType;
+    message.min_distance    = 20;
+    message.max_distance    = 2000;
+    message.increment_f     = 5;
+    message.frame           = frame;
+    // Nothing in range anywhere other than straight ahead and to the right
+    for (int i=0; i<MAVLINK_MSG_OBSTACLE_DISTANCE_FIELD_DISTANCES_LEN; i++) {
+        message.distances[i] = message.max_distance + 1;
+    }
+    message.distances[0]    = distance;
+    message.distances[18]   = distance;
+    return message;
+}
+
+static bool _samePoint(const QVector3D& point1, const QVector3D& point2)
+{
+    return (point1 - point2).length() < 0.001f;
+}
+
+void ObstacleDistanceBufferTest::_sectorsTest(void)
+{
+    ObstacleDistanceBuffer buffer;
+
+    QVERIFY(buffer.isEmpty());
+    QVERIFY(buffer.update(1, _testMessage(500), 0, 0));
+    QCOMPARE(buffer.sensorCount(), 1);
+
+    QVector<QVector3D> points = buffer.points();
+    QCOMPARE(points.count(), 2);
+    QVERIFY(_samePoint(points[0], QVector3D(5, 0, 0)));
+    QVERIFY(_samePoint(points[1], QVector3D(0, 5, 0)));
+
+    // Unknown and out of range sectors are left out
+    mavlink_obstacle_distance_t message = _testMessage(500);
+    message.distances[0] = UINT16_MAX;
+    message.distances[18] = 10;
+    QVERIFY(buffer.update(1, message, 0, 0));
+    QVERIFY(buffer.points().isEmpty());
+
+    // North aligned sectors are turned into the vehicle frame. Heading east, north is to the left.
+    QVERIFY(buffer.update(1, _testMessage(500, MAV_FRAME_GLOBAL), 90, 0));
+    points = buffer.points();
+    QCOMPARE(points.count(), 2);
+    QVERIFY(_samePoint(points[0], QVector3D(0, -5, 0)));
+    QVERIFY(_samePoint(points[1], QVector3D(5, 0, 0)));
+}
+
+void ObstacleDistanceBufferTest::_deltaTest(void)
+{
+    ObstacleDistanceBuffer buffer;
+
+    QVERIFY(buffer.update(1, _testMessage(500), 0, 0));
+    QVector<QVector3D> points = buffer.points();
+
+    // Less than deltaCentimeters doesn't replace the points
+    QVERIFY(!buffer.update(1, _testMessage(500 + ObstacleDistanceBuffer::deltaCentimeters / 2), 0, 10));
+    QCOMPARE(buffer.points(), points);
+    QVERIFY(buffer.points().constData() == points.constData());
+
+    // Compared against the points kept, not the last message
+    QVERIFY(!buffer.update(1, _testMessage(500 - ObstacleDistanceBuffer::deltaCentimeters / 2), 0, 20));
+    QVERIFY(buffer.update(1, _testMessage(500 + ObstacleDistanceBuffer::deltaCentimeters * 2), 0, 30));
+    QVERIFY(buffer.points() != points);
+    // The copy handed out before keeps the old points
+    QVERIFY(_samePoint(points[0], QVector3D(5, 0, 0)));
+}
+
+void ObstacleDistanceBufferTest::_multiSensorTest(void)
+{
+    ObstacleDistanceBuffer buffer;
+
+    QVERIFY(buffer.update(1, _testMessage(500), 0, 0));
+    QVERIFY(buffer.update(2, _testMessage(1000), 0, 0));
+    QVERIFY(buffer.update(1, _testMessage(800, MAV_FRAME_BODY_FRD, MAV_DISTANCE_SENSOR_RADAR), 0, 0));
+    QCOMPARE(buffer.sensorCount(), 3);
+    QCOMPARE(buffer.points().count(), 6);
+
+    // An update of one sensor leaves the others alone. Sensor 2 has nothing in range anymore.
+    QVERIFY(buffer.update(2, _testMessage(2001), 0, 0));
+    QCOMPARE(buffer.sensorCount(), 3);
+    QCOMPARE(buffer.points().count(), 4);
+
+    buffer.clear();
+    QVERIFY(buffer.isEmpty());
+    QVERIFY(buffer.points().isEmpty());
+}
+
+void ObstacleDistanceBufferTest::_expireTest(void)
+{
+    ObstacleDistanceBuffer buffer;
+    const qint64 timeout = ObstacleDistanceBuffer::timeoutMsecs;
+
+    QVERIFY(buffer.update(1, _testMessage(500), 0, 0));
+    QVERIFY(buffer.update(2, _testMessage(1000), 0, timeout / 2));
+    QVERIFY(!buffer.expire(timeout));
+
+    // Reported again without a change still counts as seen
+    QVERIFY(!buffer.update(1, _testMessage(500), 0, timeout));
+    QVERIFY(buffer.expire(timeout * 2));
+    QCOMPARE(buffer.sensorCount(), 1);
+    QCOMPARE(buffer.points().count(), 2);
+    QVERIFY(buffer.expire(timeout * 3));
+    QVERIFY(buffer.isEmpty());
+}
+
+void ObstacleDistanceBufferTest::_obstacle3DTest(void)
+{
+#if defined(MAVLINK_MSG_ID_OBSTACLE_DISTANCE_3D)
+    ObstacleDistanceBuffer          buffer;
+    mavlink_obstacle_distance_3d_t  message;
+
+    memset(&message, 0, sizeof(message));
+    message.sensor_type     = MAV_DISTANCE_SENSOR_LASER;
+    message.frame           = MAV_FRAME_BODY_FRD;
+    message.min_distance    = 0.2f;
+    message.max_distance    = 20;
+
+    for (uint16_t id=0; id<3; id++) {
+        message.obstacle_id = id;
+        message.x           = id + 1;
+        message.y           = -1;
+        QVERIFY(buffer.update3D(1, message, 0));
+    }
+    QCOMPARE(buffer.sensorCount(), 1);
+    QCOMPARE(buffer.points().count(), 3);
+    QVERIFY(_samePoint(buffer.points()[2], QVector3D(3, -1, 0)));
+
+    // Same obstacle reported again
+    message.x += 0.01f;
+    QVERIFY(!buffer.update3D(1, message, 0));
+    message.x += 1;
+    QVERIFY(buffer.update3D(1, message, 0));
+    QCOMPARE(buffer.points().count(), 3);
+
+    // Local NED would need the vehicle position
+    message.frame       = MAV_FRAME_LOCAL_NED;
+    message.obstacle_id = 10;
+    QVERIFY(!buffer.update3D(1, message, 0));
+    QCOMPARE(buffer.points().count(), 3);
+
+    QVERIFY(buffer.update(1, _testMessage(500), 0, 0));
+    QCOMPARE(buffer.sensorCount(), 1);
+    QCOMPARE(buffer.points().count(), 5);
+#else
+    QSKIP("OBSTACLE_DISTANCE_3D is not in this MAVLink dialect");
+#endif
+}
@@ -0,0 +1,24 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class ObstacleDistanceBufferTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _sectorsTest       (void);
+    void _deltaTest         (void);
+    void _multiSensorTest   (void);
+    void _expireTest        (void);
+    void _obstacle3DTest    (void);
+};
@@ -43,7 +43,7 @@ void RequestMessageTest::_testCaseWorker(TestCase_t& testCase)
 
     vehicle->requestMessage(_requestMessageResultHandler, &testCase, MAV_COMP_ID_AUTOPILOT1, MAVLINK_MSG_ID_DEBUG);
     QVERIFY(QTest::qWaitFor([&]() { return testCase.resultHandlerCalled; }, 10000));
-    QCOMPARE(vehicle->_findMavCommandListEntryIndex(MAV_COMP_ID_AUTOPILOT1, MAV_CMD_REQUEST_MESSAGE),   -1);
+    QVERIFY(!vehicle->_mavCommandInFlight(MAV_COMP_ID_AUTOPILOT1, MAV_CMD_REQUEST_MESSAGE));
     QCOMPARE(_mockLink->sendMavCommandCount(MAV_CMD_REQUEST_MESSAGE),                                   testCase.expectedSendCount);
 
     _disconnectMockLink();
@@ -80,7 +80,7 @@ void RequestMessageTest::_duplicateCommand(void)
     // Duplicate command returns immediately
     QCOMPARE(testCase.resultHandlerCalled,                                                              true);
     QCOMPARE(_mockLink->sendMavCommandCount(MAV_CMD_REQUEST_MESSAGE),                                   testCase.expectedSendCount);
-    QVERIFY(vehicle->_findMavCommandListEntryIndex(MAV_COMP_ID_AUTOPILOT1, MAV_CMD_REQUEST_MESSAGE) != -1);
+    QVERIFY(vehicle->_mavCommandInFlight(MAV_COMP_ID_AUTOPILOT1, MAV_CMD_REQUEST_MESSAGE));
 }
 
 void RequestMessageTest::_compIdAllRequestMessageResultHandler(void* resultHandlerData, MAV_RESULT commandResult, Vehicle::RequestMessageResultHandlerFailureCode_t failureCode, const mavlink_message_t& /*message*/)
@@ -108,7 +108,7 @@ void RequestMessageTest::_compIdAllFailure(void)
 
     vehicle->requestMessage(_requestMessageResultHandler, &testCase, MAV_COMP_ID_ALL, MAVLINK_MSG_ID_DEBUG);
     QCOMPARE(testCase.resultHandlerCalled,                                                      true);
-    QCOMPARE(vehicle->_findMavCommandListEntryIndex(MAV_COMP_ID_ALL, MAV_CMD_REQUEST_MESSAGE),  -1);
+    QVERIFY(!vehicle->_mavCommandInFlight(MAV_COMP_ID_ALL, MAV_CMD_REQUEST_MESSAGE));
     QCOMPARE(_mockLink->sendMavCommandCount(MAV_CMD_REQUEST_MESSAGE),                           0);
 
     _disconnectMockLink();
@@ -45,7 +45,7 @@ void SendMavCommandWithHandlerTest::_testCaseWorker(TestCase_t& testCase)
     _mockLink->clearSendMavCommandCounts();
     vehicle->sendMavCommandWithHandler(_mavCmdResultHandler, &testCase, MAV_COMP_ID_AUTOPILOT1, testCase.command);
     QVERIFY(QTest::qWaitFor([&]() { return _handlerCalled; }, 10000));
-    QCOMPARE(vehicle->_findMavCommandListEntryIndex(MAV_COMP_ID_AUTOPILOT1, testCase.command),  -1);
+    QVERIFY(!vehicle->_mavCommandInFlight(MAV_COMP_ID_AUTOPILOT1, testCase.command));
     QCOMPARE(_mockLink->sendMavCommandCount(testCase.command),                  testCase.expectedSendCount);
 
     _disconnectMockLink();
@@ -80,7 +80,7 @@ void SendMavCommandWithHandlerTest::_duplicateCommand(void)
 
     // Duplicate command response should happen immediately
     QVERIFY(_handlerCalled);
-    QVERIFY(vehicle->_findMavCommandListEntryIndex(MAV_COMP_ID_AUTOPILOT1, testCase.command) != -1);
+    QVERIFY(vehicle->_mavCommandInFlight(MAV_COMP_ID_AUTOPILOT1, testCase.command));
     QCOMPARE(_mockLink->sendMavCommandCount(testCase.command), 1);
 }
 
@@ -108,8 +108,78 @@ void SendMavCommandWithHandlerTest::_compIdAllFailure(void)
     _mockLink->clearSendMavCommandCounts();
     vehicle->sendMavCommandWithHandler(_compIdAllMavCmdResultHandler, nullptr, MAV_COMP_ID_ALL, testCase.command);
     QCOMPARE(_handlerCalled,                                                            true);
-    QCOMPARE(vehicle->_findMavCommandListEntryIndex(MAV_COMP_ID_ALL, testCase.command), -1);
+    QVERIFY(!vehicle->_mavCommandInFlight(MAV_COMP_ID_ALL, testCase.command));
     QCOMPARE(_mockLink->sendMavCommandCount(testCase.command),                          testCase.expectedSendCount);
 
     _disconnectMockLink();
 }
+
+void SendMavCommandWithHandlerTest::_countMavCmdResultHandler(void* resultHandlerData, int /*compId*/, MAV_RESULT /*commandResult*/, Vehicle::MavCmdResultFailureCode_t /*failureCode*/)
+{
+    (*static_cast<int*>(resultHandlerData))++;
+}
+
+void SendMavCommandWithHandlerTest::_concurrentCommands(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    MultiVehicleManager*    vehicleMgr      = qgcApp()->toolbox()->multiVehicleManager();
+    Vehicle*                vehicle         = vehicleMgr->activeVehicle();
+    int                     acceptedCount   = 0;
+    int                     failedCount     = 0;
+
+    // Different commands to the same component are in flight together
+    _mockLink->clearSendMavCommandCounts();
+    vehicle->sendMavCommandWithHandler(_countMavCmdResultHandler, &acceptedCount,   MAV_COMP_ID_AUTOPILOT1, MockLink::MAV_CMD_MOCKLINK_ALWAYS_RESULT_ACCEPTED);
+    vehicle->sendMavCommandWithHandler(_countMavCmdResultHandler, &failedCount,     MAV_COMP_ID_AUTOPILOT1, MockLink::MAV_CMD_MOCKLINK_ALWAYS_RESULT_FAILED);
+    QVERIFY(vehicle->_mavCommandInFlight(MAV_COMP_ID_AUTOPILOT1, MockLink::MAV_CMD_MOCKLINK_ALWAYS_RESULT_ACCEPTED));
+    QVERIFY(vehicle->_mavCommandInFlight(MAV_COMP_ID_AUTOPILOT1, MockLink::MAV_CMD_MOCKLINK_ALWAYS_RESULT_FAILED));
+
+    QVERIFY(QTest::qWaitFor([&]() { return acceptedCount == 1 && failedCount == 1; }, 10000));
+    QVERIFY(!vehicle->_mavCommandInFlight(MAV_COMP_ID_AUTOPILOT1, MockLink::MAV_CMD_MOCKLINK_ALWAYS_RESULT_ACCEPTED));
+    QVERIFY(!vehicle->_mavCommandInFlight(MAV_COMP_ID_AUTOPILOT1, MockLink::MAV_CMD_MOCKLINK_ALWAYS_RESULT_FAILED));
+    QCOMPARE(_mockLink->sendMavCommandCount(MockLink::MAV_CMD_MOCKLINK_ALWAYS_RESULT_ACCEPTED), 1);
+    QCOMPARE(_mockLink->sendMavCommandCount(MockLink::MAV_CMD_MOCKLINK_ALWAYS_RESULT_FAILED),   1);
+
+    Vehicle::MavCommandStats_t stats = vehicle->mavCommandStats(MockLink::MAV_CMD_MOCKLINK_ALWAYS_RESULT_ACCEPTED);
+    QCOMPARE(stats.sendCount,   1);
+    QCOMPARE(stats.ackCount,    1);
+    QCOMPARE(stats.retryCount,  0);
+
+    _disconnectMockLink();
+}
+
+void SendMavCommandWithHandlerTest::_roundTripTimeout(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    MultiVehicleManager*    vehicleMgr  = qgcApp()->toolbox()->multiVehicleManager();
+    Vehicle*                vehicle     = vehicleMgr->activeVehicle();
+    int                     resultCount = 0;
+
+    Vehicle::MavCommandListEntry_t commandEntry;
+    commandEntry.targetCompId   = MAV_COMP_ID_AUTOPILOT1;
+    commandEntry.tryCount       = 1;
+    QCOMPARE(vehicle->_mavCommandTimeoutMSecs(commandEntry), static_cast<int>(Vehicle::_mavCommandAckTimeoutMSecs));
+
+    for (int i=0; i<3; i++) {
+        vehicle->sendMavCommandWithHandler(_countMavCmdResultHandler, &resultCount, MAV_COMP_ID_AUTOPILOT1, MockLink::MAV_CMD_MOCKLINK_ALWAYS_RESULT_ACCEPTED);
+        QVERIFY(QTest::qWaitFor([&]() { return resultCount == i + 1; }, 10000));
+    }
+
+    // MockLink answers right away, so the timeout drops to the minimum and grows with each retry
+    const int firstTimeout = vehicle->_mavCommandTimeoutMSecs(commandEntry);
+    QVERIFY(firstTimeout < Vehicle::_mavCommandAckTimeoutMSecs);
+    commandEntry.tryCount = 2;
+    QVERIFY(vehicle->_mavCommandTimeoutMSecs(commandEntry) > firstTimeout);
+
+    // Retry now comes well before the fixed timeout used without a round trip estimate
+    resultCount = 0;
+    _mockLink->clearSendMavCommandCounts();
+    vehicle->sendMavCommandWithHandler(_countMavCmdResultHandler, &resultCount, MAV_COMP_ID_AUTOPILOT1, MockLink::MAV_CMD_MOCKLINK_SECOND_ATTEMPT_RESULT_ACCEPTED);
+    QVERIFY(QTest::qWaitFor([&]() { return resultCount == 1; }, Vehicle::_mavCommandAckTimeoutMSecs / 2));
+    QCOMPARE(_mockLink->sendMavCommandCount(MockLink::MAV_CMD_MOCKLINK_SECOND_ATTEMPT_RESULT_ACCEPTED), 2);
+    QCOMPARE(vehicle->mavCommandStats(MockLink::MAV_CMD_MOCKLINK_SECOND_ATTEMPT_RESULT_ACCEPTED).retryCount, 1);
+
+    _disconnectMockLink();
+}
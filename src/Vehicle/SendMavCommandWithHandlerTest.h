@@ -20,6 +20,8 @@ private slots:
     void _performTestCases(void);
     void _compIdAllFailure(void);
     void _duplicateCommand(void);
+    void _concurrentCommands(void);
+    void _roundTripTimeout(void);
 
 private:
     typedef struct {
@@ -33,6 +35,7 @@ private:
 
     static void _mavCmdResultHandler            (void* resultHandlerData, int compId, MAV_RESULT commandResult, Vehicle::MavCmdResultFailureCode_t failureCode);
     static void _compIdAllMavCmdResultHandler   (void* resultHandlerData, int compId, MAV_RESULT commandResult, Vehicle::MavCmdResultFailureCode_t failureCode);
+    static void _countMavCmdResultHandler       (void* resultHandlerData, int compId, MAV_RESULT commandResult, Vehicle::MavCmdResultFailureCode_t failureCode);
 
     static bool _handlerCalled;
 
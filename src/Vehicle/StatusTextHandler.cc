@@ -0,0 +1,218 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "StatusTextHandler.h"
+
+StatusTextHandler::StatusTextHandler(QObject* parent)
+    : QObject(parent)
+{
+    _clock.start();
+
+    _chunkTimer.setSingleShot(true);
+    _chunkTimer.setInterval(chunkTimeoutMSecs);
+    connect(&_chunkTimer, &QGCWheelTimer::timeout, this, &StatusTextHandler::_chunkTimeout);
+}
+
+void StatusTextHandler::handleMessage(const mavlink_message_t& message)
+{
+    handleMessage(message, _clock.elapsed());
+}
+
+void StatusTextHandler::handleMessage(const mavlink_message_t& message, qint64 nowMsecs)
+{
+    if (message.msgid != MAVLINK_MSG_ID_STATUSTEXT) {
+        return;
+    }
+
+    mavlink_statustext_t statustext;
+    mavlink_msg_statustext_decode(&message, &statustext);
+
+    const uint8_t   compId                  = message.compid;
+    const uint      textLength              = qstrnlen(statustext.text, MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN);
+    const QString   text                    = QString::fromUtf8(statustext.text, static_cast<int>(textLength));
+    const bool      includesNullTerminator  = textLength < MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN;
+
+    auto pending = _pending.find(compId);
+    if (pending != _pending.end() && pending->chunkId != statustext.id) {
+        // A new text started before the last chunk of the previous one
+        pending->chunks.append(QString());
+        _complete(compId, nowMsecs);
+    }
+
+    if (statustext.id == 0) {
+        // Not chunked
+        _process(compId, statustext.severity, text, nowMsecs);
+        return;
+    }
+
+    pending = _pending.find(compId);
+    if (pending == _pending.end()) {
+        _limitPending(nowMsecs);
+        Pending_t newPending;
+        newPending.chunkId          = statustext.id;
+        newPending.severity         = statustext.severity;
+        newPending.lastChunkMsecs   = nowMsecs;
+        pending = _pending.insert(compId, newPending);
+    }
+
+    // Chunks past maxChunks are dropped, a late chunk fills in the place marked missing
+    const int chunkSeq = statustext.chunk_seq;
+    if (chunkSeq < maxChunks) {
+        QStringList& chunks = pending->chunks;
+        if (chunkSeq < chunks.count()) {
+            chunks[chunkSeq] = text;
+        } else {
+            while (chunks.count() < chunkSeq) {
+                chunks.append(QString());
+            }
+            chunks.append(text);
+        }
+    }
+    pending->lastChunkMsecs = nowMsecs;
+
+    if (includesNullTerminator) {
+        _complete(compId, nowMsecs);
+    }
+
+    if (_pending.isEmpty()) {
+        _chunkTimer.stop();
+    } else {
+        _chunkTimer.start();
+    }
+}
+
+void StatusTextHandler::flush(qint64 nowMsecs)
+{
+    const QList<uint8_t> rgCompId = _pending.keys();
+    for (uint8_t compId: rgCompId) {
+        _pending[compId].chunks.append(QString());
+        _complete(compId, nowMsecs);
+    }
+    _chunkTimer.stop();
+}
+
+void StatusTextHandler::clear(void)
+{
+    _pending.clear();
+    _recent.clear();
+    _chunkTimer.stop();
+}
+
+void StatusTextHandler::_chunkTimeout(void)
+{
+    flush(_clock.elapsed());
+}
+
+void StatusTextHandler::_complete(uint8_t compId, qint64 nowMsecs)
+{
+    auto pending = _pending.find(compId);
+    if (pending == _pending.end()) {
+        return;
+    }
+
+    QString text;
+    for (const QString& chunk: pending->chunks) {
+        if (chunk.isEmpty()) {
+            text += tr(" ... ", "Indicates missing chunk from chunked STATUS_TEXT");
+        } else {
+            text += chunk;
+        }
+    }
+    const uint8_t severity = pending->severity;
+    _pending.erase(pending);
+
+    _process(compId, severity, text, nowMsecs);
+}
+
+void StatusTextHandler::_process(uint8_t compId, uint8_t severity, QString text, qint64 nowMsecs)
+{
+    StatusText_t statusText;
+
+    statusText.compId   = compId;
+    statusText.severity = severity;
+    statusText.prearm   = text.startsWith(QStringLiteral("PreArm")) ||
+            (text.startsWith(QStringLiteral("preflight"), Qt::CaseInsensitive) && severity >= MAV_SEVERITY_CRITICAL);
+
+    // NOTICE or more severe is spoken, as is anything which starts with a '#'
+    bool readAloud = severity <= MAV_SEVERITY_NOTICE;
+    if (text.startsWith(QLatin1Char('#'))) {
+        text.remove(0, 1);
+        readAloud = true;
+    }
+    statusText.text = text;
+
+    const QString key = _recentKey(compId, severity, text);
+    auto recent = _recent.find(key);
+    if (recent != _recent.end() && nowMsecs - recent->lastMsecs <= repeatWindowMSecs) {
+        recent->repeatCount++;
+        recent->lastMsecs = nowMsecs;
+        statusText.announce = nowMsecs - recent->announcedMsecs >= announceIntervalMSecs;
+    } else {
+        if (recent == _recent.end()) {
+            _limitRecent(nowMsecs);
+            recent = _recent.insert(key, Recent_t());
+        }
+        recent->repeatCount = 1;
+        recent->lastMsecs   = nowMsecs;
+        statusText.announce = true;
+    }
+    if (statusText.announce) {
+        recent->announcedMsecs = nowMsecs;
+    }
+    statusText.repeatCount  = recent->repeatCount;
+    statusText.speak        = statusText.announce && readAloud;
+
+    emit statusTextReceived(statusText);
+}
+
+void StatusTextHandler::_limitPending(qint64 nowMsecs)
+{
+    if (_pending.count() < maxPendingComponents) {
+        return;
+    }
+
+    auto oldest = _pending.begin();
+    for (auto pending = _pending.begin(); pending != _pending.end(); pending++) {
+        if (pending->lastChunkMsecs < oldest->lastChunkMsecs) {
+            oldest = pending;
+        }
+    }
+    oldest->chunks.append(QString());
+    _complete(oldest.key(), nowMsecs);
+}
+
+void StatusTextHandler::_limitRecent(qint64 nowMsecs)
+{
+    if (_recent.count() < maxRecent) {
+        return;
+    }
+
+    for (auto recent = _recent.begin(); recent != _recent.end(); ) {
+        if (nowMsecs - recent->lastMsecs > repeatWindowMSecs) {
+            recent = _recent.erase(recent);
+        } else {
+            recent++;
+        }
+    }
+
+    if (_recent.count() >= maxRecent) {
+        auto oldest = _recent.begin();
+        for (auto recent = _recent.begin(); recent != _recent.end(); recent++) {
+            if (recent->lastMsecs < oldest->lastMsecs) {
+                oldest = recent;
+            }
+        }
+        _recent.erase(oldest);
+    }
+}
+
+QString StatusTextHandler::_recentKey(uint8_t compId, uint8_t severity, const QString& text)
+{
+    return QStringLiteral("%1:%2:").arg(compId).arg(severity) + text;
+}
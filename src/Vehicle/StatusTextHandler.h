@@ -0,0 +1,101 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCMAVLink.h"
+#include "QGCTimerWheel.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+
+/// Reassembles the STATUSTEXT messages of a vehicle and parses each finished text once for all of its consumers: the
+/// Vehicle speaks it and sets the prearm error from it, UASMessageHandler stores it for the ui.
+///
+/// Chunked texts keep at most maxChunks chunks, for at most maxPendingComponents components at a time. They are
+/// finished with the missing chunks marked once chunkTimeoutMSecs pass without a new chunk.
+///
+/// A text which a component sent with the same severity less than repeatWindowMSecs ago is a repeat. Repeats are
+/// counted, consumers update the entry of the first one instead of adding another, and a repeat is only announced
+/// again once announceIntervalMSecs passed since the last announcement. Autopilots which send the same prearm
+/// failure every second this way show one entry and are spoken every ten seconds.
+class StatusTextHandler : public QObject
+{
+    Q_OBJECT
+
+public:
+    StatusTextHandler(QObject* parent = nullptr);
+
+    typedef struct {
+        uint8_t compId;
+        uint8_t severity;       ///< MAV_SEVERITY
+        QString text;           ///< Without the leading '#' which asks for it to be spoken
+        int     repeatCount;    ///< 1 the first time, counts up with each repeat
+        bool    announce;       ///< First time, or first repeat after announceIntervalMSecs
+        bool    speak;          ///< Announced and asks to be spoken, either by a leading '#' or by its severity
+        bool    prearm;         ///< Prearm check failure of ArduPilot or PX4
+    } StatusText_t;
+
+    /// Handles STATUSTEXT, other messages are ignored
+    void handleMessage(const mavlink_message_t& message);
+    void handleMessage(const mavlink_message_t& message, qint64 nowMsecs);
+
+    /// Finishes all pending chunked texts, marking what is missing
+    void flush(qint64 nowMsecs);
+
+    /// Drops pending chunks and forgets about earlier texts, the next text is never a repeat
+    void clear(void);
+
+    int pendingCount    (void) const { return _pending.count(); }
+    int recentCount     (void) const { return _recent.count(); }
+
+    static const int maxChunks              = 32;       ///< 32 chunks of 50 characters
+    static const int maxPendingComponents   = 8;
+    static const int maxRecent              = 64;       ///< Texts remembered for repeats
+    static const int chunkTimeoutMSecs      = 1000;
+    static const int repeatWindowMSecs      = 10000;
+    static const int announceIntervalMSecs  = 10000;
+
+signals:
+    /// Sent for each finished text, repeats included
+    void statusTextReceived(const StatusTextHandler::StatusText_t& statusText);
+
+private slots:
+    void _chunkTimeout(void);
+
+private:
+    typedef struct {
+        uint16_t    chunkId;
+        uint8_t     severity;
+        QStringList chunks;             ///< Missing chunks are empty
+        qint64      lastChunkMsecs;
+    } Pending_t;
+
+    typedef struct {
+        int     repeatCount;
+        qint64  lastMsecs;
+        qint64  announcedMsecs;
+    } Recent_t;
+
+    void _complete      (uint8_t compId, qint64 nowMsecs);
+    void _process       (uint8_t compId, uint8_t severity, QString text, qint64 nowMsecs);
+    /// Makes room for one more pending component, finishing the one which waited the longest
+    void _limitPending  (qint64 nowMsecs);
+    /// Makes room for one more recent text, dropping expired ones, or else the oldest one
+    void _limitRecent   (qint64 nowMsecs);
+
+    static QString _recentKey(uint8_t compId, uint8_t severity, const QString& text);
+
+    QHash<uint8_t /* compId */, Pending_t>  _pending;
+    QHash<QString, Recent_t>                _recent;
+    QElapsedTimer                           _clock;
+    QGCWheelTimer                           _chunkTimer     { "Vehicle" };
+};
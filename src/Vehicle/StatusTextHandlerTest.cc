@@ -0,0 +1,220 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "StatusTextHandlerTest.h"
+#include "StatusTextHandler.h"
+
+/// A text of MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN characters or more fills the whole field, without terminator
+static mavlink_message_t _statusTextMessage(uint8_t compId, uint8_t severity, const QByteArray& text, uint16_t id = 0, uint8_t chunkSeq = 0)
+{
+    mavlink_message_t message;
+    char              buffer[MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN];
+
+    memset(buffer, 0, sizeof(buffer));
+    memcpy(buffer, text.constData(), qMin(static_cast<int>(sizeof(buffer)), text.length()));
+    mavlink_msg_statustext_pack(1, compId, &message, severity, buffer, id, chunkSeq);
+    return message;
+}
+
+class StatusTextRecorder : public QObject
+{
+public:
+    StatusTextRecorder(StatusTextHandler* handler)
+    {
+        connect(handler, &StatusTextHandler::statusTextReceived, this, [this](const StatusTextHandler::StatusText_t& statusText) {
+            statusTexts.append(statusText);
+        });
+    }
+
+    QList<StatusTextHandler::StatusText_t> statusTexts;
+};
+
+void StatusTextHandlerTest::_singleTextTest(void)
+{
+    StatusTextHandler   handler;
+    StatusTextRecorder  recorder(&handler);
+
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_INFO, "hello"), 0);
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_NOTICE, "#spoken"), 0);
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_INFO, "#also spoken"), 0);
+
+    QCOMPARE(recorder.statusTexts.count(), 3);
+    QCOMPARE(recorder.statusTexts[0].text, QString("hello"));
+    QCOMPARE(recorder.statusTexts[0].compId, static_cast<uint8_t>(MAV_COMP_ID_AUTOPILOT1));
+    QCOMPARE(recorder.statusTexts[0].repeatCount, 1);
+    QVERIFY(recorder.statusTexts[0].announce);
+    QVERIFY(!recorder.statusTexts[0].speak);
+    QCOMPARE(recorder.statusTexts[1].text, QString("spoken"));
+    QVERIFY(recorder.statusTexts[1].speak);
+    QCOMPARE(recorder.statusTexts[2].text, QString("also spoken"));
+    QVERIFY(recorder.statusTexts[2].speak);
+    QCOMPARE(handler.pendingCount(), 0);
+
+    // A full field without terminator isn't chunked when the id is 0
+    const QByteArray fullText(MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN, 'x');
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_INFO, fullText), 0);
+    QCOMPARE(recorder.statusTexts.count(), 4);
+    QCOMPARE(recorder.statusTexts[3].text, QString(fullText));
+}
+
+void StatusTextHandlerTest::_chunkedTest(void)
+{
+    StatusTextHandler   handler;
+    StatusTextRecorder  recorder(&handler);
+
+    const QByteArray chunk0(MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN, 'a');
+    const QByteArray chunk1(MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN, 'b');
+
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_WARNING, chunk0, 7, 0), 0);
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_WARNING, chunk1, 7, 1), 10);
+    QCOMPARE(recorder.statusTexts.count(), 0);
+    QCOMPARE(handler.pendingCount(), 1);
+
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_WARNING, "end", 7, 2), 20);
+    QCOMPARE(recorder.statusTexts.count(), 1);
+    QCOMPARE(recorder.statusTexts[0].text, QString(chunk0 + chunk1 + "end"));
+    QCOMPARE(recorder.statusTexts[0].severity, static_cast<uint8_t>(MAV_SEVERITY_WARNING));
+    QCOMPARE(handler.pendingCount(), 0);
+
+    // Components are reassembled separately
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_INFO, chunk0, 8, 0), 30);
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_CAMERA, MAV_SEVERITY_INFO, chunk1, 8, 0), 30);
+    QCOMPARE(handler.pendingCount(), 2);
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_CAMERA, MAV_SEVERITY_INFO, "camera", 8, 1), 40);
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_INFO, "autopilot", 8, 1), 40);
+    QCOMPARE(recorder.statusTexts.count(), 3);
+    QCOMPARE(recorder.statusTexts[1].text, QString(chunk1 + "camera"));
+    QCOMPARE(recorder.statusTexts[2].text, QString(chunk0 + "autopilot"));
+}
+
+void StatusTextHandlerTest::_missingChunkTest(void)
+{
+    StatusTextHandler   handler;
+    StatusTextRecorder  recorder(&handler);
+
+    const QByteArray    chunk(MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN, 'a');
+    const QString       missing = StatusTextHandler::tr(" ... ", "Indicates missing chunk from chunked STATUS_TEXT");
+
+    // Chunk 1 lost
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_INFO, chunk, 1, 0), 0);
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_INFO, "end", 1, 2), 0);
+    QCOMPARE(recorder.statusTexts.count(), 1);
+    QCOMPARE(recorder.statusTexts[0].text, QString(chunk) + missing + "end");
+
+    // Last chunk lost, the next text finishes it
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_INFO, chunk, 2, 0), 0);
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_INFO, "next"), 0);
+    QCOMPARE(recorder.statusTexts.count(), 3);
+    QCOMPARE(recorder.statusTexts[1].text, QString(chunk) + missing);
+    QCOMPARE(recorder.statusTexts[2].text, QString("next"));
+
+    // Last chunk lost, flushed by the timeout
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_INFO, chunk, 3, 0), 0);
+    QCOMPARE(handler.pendingCount(), 1);
+    handler.flush(StatusTextHandler::chunkTimeoutMSecs);
+    QCOMPARE(handler.pendingCount(), 0);
+    QCOMPARE(recorder.statusTexts.count(), 4);
+    QCOMPARE(recorder.statusTexts[3].text, QString(chunk) + missing);
+}
+
+void StatusTextHandlerTest::_boundsTest(void)
+{
+    StatusTextHandler   handler;
+    StatusTextRecorder  recorder(&handler);
+
+    const QByteArray chunk(MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN, 'a');
+
+    // Chunks past maxChunks are dropped
+    for (int i=0; i<StatusTextHandler::maxChunks + 10; i++) {
+        handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_INFO, chunk, 1, static_cast<uint8_t>(i)), 0);
+    }
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_INFO, "end", 1, 200), 0);
+    QCOMPARE(recorder.statusTexts.count(), 1);
+    QCOMPARE(recorder.statusTexts[0].text.length(), StatusTextHandler::maxChunks * MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN);
+
+    // The component which waited the longest is finished to make room
+    recorder.statusTexts.clear();
+    for (int i=0; i<StatusTextHandler::maxPendingComponents + 1; i++) {
+        handler.handleMessage(_statusTextMessage(static_cast<uint8_t>(100 + i), MAV_SEVERITY_INFO, chunk, 2, 0), i);
+        QVERIFY(handler.pendingCount() <= StatusTextHandler::maxPendingComponents);
+    }
+    QCOMPARE(handler.pendingCount(), StatusTextHandler::maxPendingComponents);
+    QCOMPARE(recorder.statusTexts.count(), 1);
+    QCOMPARE(recorder.statusTexts[0].compId, static_cast<uint8_t>(100));
+
+    // Remembered texts are bounded
+    for (int i=0; i<StatusTextHandler::maxRecent * 2; i++) {
+        handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_INFO, QByteArray::number(i)), 0);
+        QVERIFY(handler.recentCount() <= StatusTextHandler::maxRecent);
+    }
+
+    handler.clear();
+    QCOMPARE(handler.pendingCount(), 0);
+    QCOMPARE(handler.recentCount(), 0);
+}
+
+void StatusTextHandlerTest::_repeatTest(void)
+{
+    StatusTextHandler   handler;
+    StatusTextRecorder  recorder(&handler);
+
+    const QByteArray text("#Check the compass");
+
+    // Repeated every second
+    for (int i=0; i<12; i++) {
+        handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_INFO, text), i * 1000);
+    }
+    QCOMPARE(recorder.statusTexts.count(), 12);
+    QCOMPARE(handler.recentCount(), 1);
+    for (int i=0; i<12; i++) {
+        const StatusTextHandler::StatusText_t& statusText = recorder.statusTexts[i];
+        QCOMPARE(statusText.repeatCount, i + 1);
+        QCOMPARE(statusText.text, QString("Check the compass"));
+        // Announced at the start and again after announceIntervalMSecs
+        const bool announce = i == 0 || i == 10;
+        QCOMPARE(statusText.announce, announce);
+        QCOMPARE(statusText.speak, announce);
+    }
+
+    // Another severity or component isn't a repeat
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_WARNING, text), 12000);
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_CAMERA, MAV_SEVERITY_INFO, text), 12000);
+    QCOMPARE(recorder.statusTexts[12].repeatCount, 1);
+    QCOMPARE(recorder.statusTexts[13].repeatCount, 1);
+
+    // Once the repeat window passed it starts over
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_INFO, text), 11000 + StatusTextHandler::repeatWindowMSecs + 1);
+    QCOMPARE(recorder.statusTexts[14].repeatCount, 1);
+    QVERIFY(recorder.statusTexts[14].announce);
+}
+
+void StatusTextHandlerTest::_prearmTest(void)
+{
+    StatusTextHandler   handler;
+    StatusTextRecorder  recorder(&handler);
+
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_CRITICAL, "PreArm: Compass not calibrated"), 0);
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_CRITICAL, "Preflight Fail: Accel uncalibrated"), 0);
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_ALERT, "preflight check"), 0);
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_CRITICAL, "Compass not calibrated"), 0);
+
+    QCOMPARE(recorder.statusTexts.count(), 4);
+    QVERIFY(recorder.statusTexts[0].prearm);
+    QVERIFY(recorder.statusTexts[0].speak);
+    QVERIFY(recorder.statusTexts[1].prearm);
+    // PX4 preflight texts more severe than critical aren't prearm failures
+    QVERIFY(!recorder.statusTexts[2].prearm);
+    QVERIFY(!recorder.statusTexts[3].prearm);
+
+    // A repeated prearm failure is still flagged, but not announced until the interval passed
+    handler.handleMessage(_statusTextMessage(MAV_COMP_ID_AUTOPILOT1, MAV_SEVERITY_CRITICAL, "PreArm: Compass not calibrated"), 1000);
+    QVERIFY(recorder.statusTexts[4].prearm);
+    QVERIFY(!recorder.statusTexts[4].announce);
+    QCOMPARE(recorder.statusTexts[4].repeatCount, 2);
+}
@@ -0,0 +1,25 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class StatusTextHandlerTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _singleTextTest    (void);
+    void _chunkedTest       (void);
+    void _missingChunkTest  (void);
+    void _boundsTest        (void);
+    void _repeatTest        (void);
+    void _prearmTest        (void);
+};
@@ -0,0 +1,284 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryBenchmark.h"
+#include "BenchmarkResults.h"
+#include "QGCApplication.h"
+#include "MockLink.h"
+#include "LinkManager.h"
+#include "MultiVehicleManager.h"
+#include "Vehicle.h"
+
+#include <QThread>
+
+#include <algorithm>
+
+#ifdef QGC_TELEMETRY_BENCHMARK_ALLOCATIONS
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<qint64> _benchmarkAllocationCount(0);
+
+void* operator new(std::size_t size)
+{
+    _benchmarkAllocationCount++;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+static qint64 _allocationCount(void) { return _benchmarkAllocationCount.load(); }
+#else
+static qint64 _allocationCount(void) { return -1; }
+#endif
+
+TelemetryBenchmark::TelemetryBenchmark(void)
+{
+
+}
+
+void TelemetryBenchmark::init(void)
+{
+    UnitTest::init();
+
+    _multiVehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
+    _latencyNSecs.clear();
+    _coalescedCount = 0;
+
+    QCOMPARE(_linkManager->links().count(),         0);
+    QCOMPARE(_multiVehicleMgr->vehicles()->count(), 0);
+}
+
+void TelemetryBenchmark::cleanup(void)
+{
+    for (const BenchVehicle_t& benchVehicle: _vehicles) {
+        disconnect(benchVehicle.vehicle->roll(), &Fact::rawValueChanged, this, nullptr);
+    }
+    _vehicles.clear();
+
+    if (_linkManager->links().count()) {
+        QSignalSpy spyActiveVehicleChanged(_multiVehicleMgr, &MultiVehicleManager::activeVehicleChanged);
+        _linkManager->disconnectAll();
+        QCOMPARE(spyActiveVehicleChanged.wait(10000),   true);
+        QCOMPARE(_multiVehicleMgr->vehicles()->count(), 0);
+    }
+
+    _multiVehicleMgr = nullptr;
+
+    UnitTest::cleanup();
+}
+
+void TelemetryBenchmark::_startVehicles(int count)
+{
+    for (int i=0; i<count; i++) {
+        MockConfiguration*          mockConfig = new MockConfiguration(QStringLiteral("Benchmark Mock %1").arg(i));
+        SharedLinkConfigurationPtr  sharedConfig(mockConfig);
+
+        mockConfig->setDynamic              (true);
+        mockConfig->setIncrementVehicleId   (true);
+
+        QSignalSpy spyVehicleAdded(_multiVehicleMgr, &MultiVehicleManager::vehicleAdded);
+
+        QVERIFY(_linkManager->createConnectedLink(sharedConfig));
+        MockLink* mockLink = qobject_cast<MockLink*>(sharedConfig->link());
+        QVERIFY(mockLink);
+
+        QCOMPARE(spyVehicleAdded.wait(10000), true);
+        Vehicle* vehicle = _multiVehicleMgr->getVehicleById(mockLink->vehicleId());
+        QVERIFY(vehicle);
+
+        QSignalSpy spyInitialConnect(vehicle, &Vehicle::initialConnectComplete);
+        QCOMPARE(spyInitialConnect.wait(30000), true);
+
+        BenchVehicle_t benchVehicle;
+        benchVehicle.mockLink   = mockLink;
+        benchVehicle.sharedLink = _linkManager->sharedLinkInterfacePointerForLink(mockLink);
+        benchVehicle.vehicle    = vehicle;
+        benchVehicle.sent       = 0;
+        _vehicles.append(benchVehicle);
+
+        int vehicleIndex = _vehicles.count() - 1;
+        connect(vehicle->roll(), &Fact::rawValueChanged, this, [this, vehicleIndex]() { _attitudeUpdated(vehicleIndex); });
+    }
+}
+
+/// Injects one round of telemetry for a vehicle. Values change with every round so each one produces Fact updates.
+void TelemetryBenchmark::_injectTelemetry(BenchVehicle_t& benchVehicle, quint64 sequence)
+{
+    MockLink*           mockLink    = benchVehicle.mockLink;
+    uint8_t             sysId       = static_cast<uint8_t>(mockLink->vehicleId());
+    uint8_t             compId      = MAV_COMP_ID_AUTOPILOT1;
+    uint8_t             channel     = mockLink->mavlinkChannel();
+    uint32_t            bootMSecs   = static_cast<uint32_t>(_clock.elapsed());
+    float               step        = static_cast<float>(sequence % 100);
+    mavlink_message_t   message;
+
+    mavlink_attitude_t attitude = {};
+    attitude.time_boot_ms   = bootMSecs;
+    attitude.roll           = 0.1f + step * 0.001f;
+    attitude.pitch          = -0.1f + step * 0.001f;
+    attitude.yaw            = step * 0.01f;
+    attitude.rollspeed      = step * 0.0001f;
+    mavlink_msg_attitude_encode_chan(sysId, compId, channel, &message, &attitude);
+    benchVehicle.pendingInjectNSecs.append(_clock.nsecsElapsed());
+    mockLink->respondWithMavlinkMessage(message);
+
+    mavlink_global_position_int_t globalPosition = {};
+    globalPosition.time_boot_ms = bootMSecs;
+    globalPosition.lat          = 473977420 + static_cast<int32_t>(sequence % 1000);
+    globalPosition.lon          = 85455940 + static_cast<int32_t>(sequence % 1000);
+    globalPosition.alt          = 488000;
+    globalPosition.relative_alt = 10000 + static_cast<int32_t>(sequence % 100);
+    globalPosition.hdg          = static_cast<uint16_t>((sequence * 10) % 36000);
+    mavlink_msg_global_position_int_encode_chan(sysId, compId, channel, &message, &globalPosition);
+    mockLink->respondWithMavlinkMessage(message);
+
+    mavlink_gps_raw_int_t gpsRawInt = {};
+    gpsRawInt.time_usec             = static_cast<uint64_t>(bootMSecs) * 1000;
+    gpsRawInt.fix_type              = GPS_FIX_TYPE_3D_FIX;
+    gpsRawInt.lat                   = globalPosition.lat;
+    gpsRawInt.lon                   = globalPosition.lon;
+    gpsRawInt.alt                   = globalPosition.alt;
+    gpsRawInt.eph                   = 100;
+    gpsRawInt.epv                   = 150;
+    gpsRawInt.cog                   = globalPosition.hdg;
+    gpsRawInt.satellites_visible    = 12;
+    mavlink_msg_gps_raw_int_encode_chan(sysId, compId, channel, &message, &gpsRawInt);
+    mockLink->respondWithMavlinkMessage(message);
+
+    mavlink_vibration_t vibration = {};
+    vibration.time_usec     = gpsRawInt.time_usec;
+    vibration.vibration_x   = step * 0.01f;
+    vibration.vibration_y   = step * 0.02f;
+    vibration.vibration_z   = step * 0.03f;
+    mavlink_msg_vibration_encode_chan(sysId, compId, channel, &message, &vibration);
+    mockLink->respondWithMavlinkMessage(message);
+}
+
+/// Fact updates may be coalesced, so an update is matched against the newest injection and older ones are counted as coalesced
+void TelemetryBenchmark::_attitudeUpdated(int vehicleIndex)
+{
+    BenchVehicle_t& benchVehicle = _vehicles[vehicleIndex];
+
+    if (benchVehicle.pendingInjectNSecs.isEmpty()) {
+        // Update from MockLink's own telemetry
+        return;
+    }
+
+    _latencyNSecs.append(_clock.nsecsElapsed() - benchVehicle.pendingInjectNSecs.last());
+    _coalescedCount += static_cast<quint64>(benchVehicle.pendingInjectNSecs.count() - 1);
+    benchVehicle.pendingInjectNSecs.clear();
+}
+
+qint64 TelemetryBenchmark::_percentile(QVector<qint64>& sorted, double percentile)
+{
+    if (sorted.isEmpty()) {
+        return 0;
+    }
+    int index = qBound(0, static_cast<int>(percentile * (sorted.count() - 1) + 0.5), sorted.count() - 1);
+    return sorted[index];
+}
+
+void TelemetryBenchmark::_report(int rateHz, qint64 elapsedNSecs, qint64 busyNSecs, quint64 messageCount, qint64 allocations)
+{
+    std::sort(_latencyNSecs.begin(), _latencyNSecs.end());
+
+    double seconds          = elapsedNSecs / 1e9;
+    double usecsPerMessage  = messageCount ? (busyNSecs / 1e3) / messageCount : 0;
+
+    qInfo() << "TelemetryBenchmark vehicles:rateHz:seconds" << _vehicles.count() << rateHz << seconds
+            << "messages" << messageCount << "samples" << _latencyNSecs.count() << "coalesced" << _coalescedCount;
+    BenchmarkResults::record(this, QStringLiteral("messagesPerSec"),    seconds > 0 ? messageCount / seconds : 0,                   QStringLiteral("msg/s"));
+    BenchmarkResults::record(this, QStringLiteral("usecsPerMessage"),   usecsPerMessage,                                            QStringLiteral("us"));
+    BenchmarkResults::record(this, QStringLiteral("mainThreadBusy"),    elapsedNSecs ? (100.0 * busyNSecs) / elapsedNSecs : 0,      QStringLiteral("%"));
+    if (allocations >= 0) {
+        BenchmarkResults::record(this, QStringLiteral("allocationsPerMessage"), messageCount ? static_cast<double>(allocations) / messageCount : 0, QStringLiteral("allocations"));
+    } else {
+        qInfo() << "TelemetryBenchmark allocations not counted, build with QGC_TELEMETRY_BENCHMARK_ALLOCATIONS";
+    }
+    BenchmarkResults::record(this, QStringLiteral("usecsLatencyP50"),   _percentile(_latencyNSecs, 0.50) / 1e3,                     QStringLiteral("us"));
+    BenchmarkResults::record(this, QStringLiteral("usecsLatencyP90"),   _percentile(_latencyNSecs, 0.90) / 1e3,                     QStringLiteral("us"));
+    BenchmarkResults::record(this, QStringLiteral("usecsLatencyP99"),   _percentile(_latencyNSecs, 0.99) / 1e3,                     QStringLiteral("us"));
+    BenchmarkResults::record(this, QStringLiteral("usecsLatencyMax"),   _latencyNSecs.isEmpty() ? 0 : _latencyNSecs.last() / 1e3,   QStringLiteral("us"));
+}
+
+void TelemetryBenchmark::_telemetryPipelineBenchmark(void)
+{
+    int vehicleCount        = BenchmarkResults::envInt("QGC_BENCH_VEHICLES",         4);
+    int rateHz              = BenchmarkResults::envInt("QGC_BENCH_RATE_HZ",          50);
+    int seconds             = BenchmarkResults::envInt("QGC_BENCH_SECONDS",          5);
+    int maxUSecsPerMessage  = BenchmarkResults::envInt("QGC_BENCH_MAX_USEC_PER_MSG", 0);
+
+    _startVehicles(vehicleCount);
+    QCOMPARE(_vehicles.count(), vehicleCount);
+
+    // Drop any latency samples from the connect sequence
+    _clock.start();
+    for (BenchVehicle_t& benchVehicle: _vehicles) {
+        benchVehicle.pendingInjectNSecs.clear();
+    }
+    _latencyNSecs.clear();
+    _latencyNSecs.reserve(vehicleCount * rateHz * seconds);
+
+    qint64          durationNSecs       = static_cast<qint64>(seconds) * 1000000000;
+    qint64          busyNSecs           = 0;
+    qint64          startAllocations    = _allocationCount();
+    QElapsedTimer   busyTimer;
+
+    while (_clock.nsecsElapsed() < durationNSecs) {
+        quint64 due     = static_cast<quint64>((_clock.nsecsElapsed() * rateHz) / 1000000000);
+        bool    injected = false;
+
+        busyTimer.start();
+        for (BenchVehicle_t& benchVehicle: _vehicles) {
+            while (benchVehicle.sent < due) {
+                _injectTelemetry(benchVehicle, benchVehicle.sent++);
+                injected = true;
+            }
+        }
+        QCoreApplication::processEvents();
+        busyNSecs += busyTimer.nsecsElapsed();
+
+        if (!injected) {
+            QThread::usleep(100);
+        }
+    }
+
+    qint64 elapsedNSecs = _clock.nsecsElapsed();
+
+    // Let anything queued or coalesced drain before reporting
+    QTest::qWait(200);
+
+    quint64 messageCount = 0;
+    for (const BenchVehicle_t& benchVehicle: _vehicles) {
+        messageCount += benchVehicle.sent * _messagesPerTick;
+    }
+    qint64 allocations = startAllocations >= 0 ? _allocationCount() - startAllocations : -1;
+
+    _report(rateHz, elapsedNSecs, busyNSecs, messageCount, allocations);
+
+    QVERIFY(messageCount > 0);
+    QVERIFY(!_latencyNSecs.isEmpty());
+    if (maxUSecsPerMessage > 0) {
+        QVERIFY((busyNSecs / 1000) / static_cast<qint64>(messageCount) <= maxUSecsPerMessage);
+    }
+}
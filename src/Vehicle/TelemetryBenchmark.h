@@ -0,0 +1,75 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "LinkInterface.h"
+#include "LinkConfiguration.h"
+
+#include <QElapsedTimer>
+
+class MockLink;
+class MultiVehicleManager;
+
+/// Benchmark for the receive telemetry pipeline: MAVLinkProtocol -> Vehicle::_mavlinkMessageReceived -> FactGroups.
+///
+/// Connects a number of MockLink vehicles and then injects ATTITUDE, GLOBAL_POSITION_INT, GPS_RAW_INT and VIBRATION
+/// into each of them at a fixed rate. Reports messages/sec, main thread time per message, allocations per message and
+/// latency percentiles from injection to the resulting Fact update, all recorded through BenchmarkResults.
+///
+/// Registered standalone so it only runs when asked for by name:
+///     QGroundControl --unittest:TelemetryBenchmark
+///
+/// Configured through the environment:
+///     QGC_BENCH_VEHICLES          Number of vehicles, default 4
+///     QGC_BENCH_RATE_HZ           Rate for each message type on each vehicle, default 50
+///     QGC_BENCH_SECONDS           Measurement duration, default 5
+///     QGC_BENCH_MAX_USEC_PER_MSG  Fail if main thread time per message goes above this, default no limit
+///
+/// Allocation counts are only available when built with QGC_TELEMETRY_BENCHMARK_ALLOCATIONS defined, which replaces
+/// the global operator new with a counting version.
+class TelemetryBenchmark : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    TelemetryBenchmark(void);
+
+protected:
+    void init   (void) final;
+    void cleanup(void) final;
+
+private slots:
+    void _telemetryPipelineBenchmark(void);
+
+private:
+    typedef struct {
+        MockLink*               mockLink;
+        SharedLinkInterfacePtr  sharedLink;
+        Vehicle*                vehicle;
+        QList<qint64>           pendingInjectNSecs;     ///< Injection times of ATTITUDE messages not yet seen as a Fact update
+        quint64                 sent;
+    } BenchVehicle_t;
+
+    void    _startVehicles      (int count);
+    void    _injectTelemetry    (BenchVehicle_t& benchVehicle, quint64 sequence);
+    void    _attitudeUpdated    (int vehicleIndex);
+    void    _report             (int rateHz, qint64 elapsedNSecs, qint64 busyNSecs, quint64 messageCount, qint64 allocations);
+
+    static qint64   _percentile     (QVector<qint64>& sorted, double percentile);
+
+    MultiVehicleManager*    _multiVehicleMgr = nullptr;
+    QList<BenchVehicle_t>   _vehicles;
+    QElapsedTimer           _clock;
+    QVector<qint64>         _latencyNSecs;
+    quint64                 _coalescedCount = 0;    ///< Injected ATTITUDE messages which never produced their own Fact update
+
+    static const int _messagesPerTick = 4;
+};
@@ -0,0 +1,377 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryRecorder.h"
+#include "Vehicle.h"
+#include "FactGroup.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QTime>
+
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(TelemetryRecorderLog, "TelemetryRecorderLog")
+
+const char* TelemetryRecorder::fileExtension = "qgctel";
+
+static const char   kMagic[]    = "QGCTEL";
+static const int    kMagicSize  = sizeof(kMagic) - 1;
+
+static void _setupStream(QDataStream& stream)
+{
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+}
+
+static bool _stringColumn(int type)
+{
+    return type == FactMetaData::valueTypeString || type == FactMetaData::valueTypeCustom;
+}
+
+static bool _readHeader(QDataStream& stream, QList<TelemetryRecorder::Column_t>& columns)
+{
+    char    magic[kMagicSize];
+    quint16 version     = 0;
+    quint32 columnCount = 0;
+
+    if (stream.readRawData(magic, kMagicSize) != kMagicSize || memcmp(magic, kMagic, kMagicSize) != 0) {
+        return false;
+    }
+    stream >> version >> columnCount;
+    if (stream.status() != QDataStream::Ok || version != TelemetryRecorder::fileVersion) {
+        return false;
+    }
+
+    columns.clear();
+    for (quint32 i=0; i<columnCount; i++) {
+        TelemetryRecorder::Column_t column;
+        quint8                      type;
+        qint8                       decimalPlaces;
+
+        stream >> column.name >> type >> decimalPlaces;
+        column.type             = type;
+        column.decimalPlaces    = decimalPlaces;
+        columns.append(column);
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+/// Applies the changes of the next sample to values
+/// @return false: No complete sample left
+static bool _readSample(QDataStream& stream, const QList<TelemetryRecorder::Column_t>& columns, qint64& msecs, QVector<QVariant>& values)
+{
+    quint16 changeCount = 0;
+
+    stream >> msecs >> changeCount;
+    for (int i=0; i<changeCount && stream.status() == QDataStream::Ok; i++) {
+        quint16 column;
+
+        stream >> column;
+        if (column >= columns.count()) {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+        if (_stringColumn(columns[column].type)) {
+            QString value;
+            stream >> value;
+            values[column] = value;
+        } else {
+            double value;
+            stream >> value;
+            values[column] = value;
+        }
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+/// Same as Fact::cookedValueString
+static QString _csvValue(const TelemetryRecorder::Column_t& column, const QVariant& value)
+{
+    if (!value.isValid()) {
+        return QString();
+    }
+
+    switch (column.type) {
+    case FactMetaData::valueTypeString:
+    case FactMetaData::valueTypeCustom:
+        return value.toString();
+    case FactMetaData::valueTypeFloat:
+    case FactMetaData::valueTypeDouble:
+    {
+        const double dValue = value.toDouble();
+        return qIsNaN(dValue) ? QStringLiteral("--.--") : QString::number(dValue, 'f', column.decimalPlaces);
+    }
+    case FactMetaData::valueTypeBool:
+        return value.toDouble() != 0 ? QStringLiteral("true") : QStringLiteral("false");
+    case FactMetaData::valueTypeElapsedTimeInSeconds:
+    {
+        const double dValue = value.toDouble();
+        return qIsNaN(dValue) ? QStringLiteral("--:--:--") : QTime(0, 0, 0, 0).addSecs(static_cast<int>(dValue)).toString(QStringLiteral("hh:mm:ss"));
+    }
+    default:
+        return QString::number(static_cast<qint64>(value.toDouble()));
+    }
+}
+
+static QByteArray _csvHeader(const QList<TelemetryRecorder::Column_t>& columns)
+{
+    QStringList names;
+    for (const TelemetryRecorder::Column_t& column: columns) {
+        names.append(column.name);
+    }
+    return QStringLiteral("Timestamp,%1\n").arg(names.join(',')).toUtf8();
+}
+
+static QByteArray _csvRow(const QList<TelemetryRecorder::Column_t>& columns, qint64 msecs, const QVector<QVariant>& values)
+{
+    QStringList row;
+    row.reserve(columns.count() + 1);
+    row.append(QDateTime::fromMSecsSinceEpoch(msecs).toString(QStringLiteral("yyyy-MM-dd hh:mm:ss.zzz")));
+    for (int i=0; i<columns.count(); i++) {
+        row.append(_csvValue(columns[i], values[i]));
+    }
+    return (row.join(',') + QStringLiteral("\n")).toUtf8();
+}
+
+static bool _sameValue(const QVariant& a, const QVariant& b)
+{
+    if (a.type() == QVariant::Double && b.type() == QVariant::Double) {
+        const double dA = a.toDouble();
+        const double dB = b.toDouble();
+        return dA == dB || (qIsNaN(dA) && qIsNaN(dB));
+    }
+    return a == b;
+}
+
+TelemetryRecorder::TelemetryRecorder(Vehicle* vehicle, QObject* parent)
+    : QObject   (parent)
+    , _vehicle  (vehicle)
+{
+    _writerThread.setObjectName(QStringLiteral("TelemetryRecorder"));
+    connect(&_sampleTimer, &QGCWheelTimer::timeout, this, &TelemetryRecorder::sample);
+}
+
+TelemetryRecorder::~TelemetryRecorder()
+{
+    stop();
+}
+
+void TelemetryRecorder::start(const QString& fileName, const QString& csvFileName, int rateHz)
+{
+    stop();
+
+    _fileName = fileName;
+    _columns.clear();
+    _sources.clear();
+
+    auto addFactGroup = [this](const QString& groupName, FactGroup* factGroup) {
+        for (const QString& factName: factGroup->factNames()) {
+            Fact*       fact = factGroup->getFact(factName);
+            Column_t    column;
+
+            column.name             = groupName.isEmpty() ? factName : QStringLiteral("%1.%2").arg(groupName, factName);
+            column.type             = fact->type();
+            column.decimalPlaces    = fact->decimalPlaces();
+            _columns.append(column);
+            _sources.append({ factGroup, fact });
+        }
+    };
+    addFactGroup(QString(), _vehicle);
+    for (const QString& groupName: _vehicle->factGroupNames()) {
+        addFactGroup(groupName, _vehicle->getFactGroup(groupName));
+    }
+    qCDebug(TelemetryRecorderLog) << "Recording" << _columns.count() << "facts at" << rateHz << "Hz to" << fileName;
+
+    _lastValues = QVector<QVariant>(_columns.count());
+    _changed.clear();
+    _changed.reserve(_columns.count());
+
+    QByteArray  header;
+    QDataStream stream(&header, QIODevice::WriteOnly);
+    _setupStream(stream);
+    stream.writeRawData(kMagic, kMagicSize);
+    stream << static_cast<quint16>(fileVersion) << static_cast<quint32>(_columns.count());
+    for (const Column_t& column: _columns) {
+        stream << column.name << static_cast<quint8>(column.type) << static_cast<qint8>(column.decimalPlaces);
+    }
+
+    // The writer is deleted on its own thread once the thread is done
+    TelemetryRecorderWriter* writer = new TelemetryRecorderWriter();
+    writer->moveToThread(&_writerThread);
+    connect(&_writerThread, &QThread::finished,         writer, &QObject::deleteLater);
+    connect(this,           &TelemetryRecorder::_open,  writer, &TelemetryRecorderWriter::open,     Qt::QueuedConnection);
+    connect(this,           &TelemetryRecorder::_write, writer, &TelemetryRecorderWriter::write,    Qt::QueuedConnection);
+    connect(this,           &TelemetryRecorder::_close, writer, &TelemetryRecorderWriter::close,    Qt::QueuedConnection);
+    _writerThread.start();
+    _recording = true;
+    emit _open(fileName, csvFileName, header);
+
+    const int intervalMSecs = 1000 / qBound(1, rateHz, static_cast<int>(maxRateHz));
+    _chunk.clear();
+    _chunkTimer.start();
+    _sampleTimer.setWindow(intervalMSecs);
+    _sampleTimer.start(intervalMSecs);
+    sample();
+}
+
+void TelemetryRecorder::stop(void)
+{
+    if (!recording()) {
+        return;
+    }
+
+    _sampleTimer.stop();
+    _recording = false;
+    _flush();
+    emit _close();
+    disconnect(this, &TelemetryRecorder::_open,  nullptr, nullptr);
+    disconnect(this, &TelemetryRecorder::_write, nullptr, nullptr);
+    disconnect(this, &TelemetryRecorder::_close, nullptr, nullptr);
+    _writerThread.quit();
+    _writerThread.wait();
+    qCDebug(TelemetryRecorderLog) << "Recording stopped" << _fileName;
+}
+
+void TelemetryRecorder::sample(void)
+{
+    if (!recording()) {
+        return;
+    }
+
+    _changed.clear();
+    for (int i=0; i<_sources.count(); i++) {
+        const Source_t& source  = _sources[i];
+        QVariant        value   = source.factGroup->latestRawValue(source.fact);
+
+        if (source.fact->metaData()) {
+            value = source.fact->metaData()->rawTranslator()(value);
+        }
+        value = _stringColumn(_columns[i].type) ? QVariant(value.toString()) : QVariant(value.toDouble());
+
+        if (!_sameValue(value, _lastValues[i])) {
+            _lastValues[i] = value;
+            _changed.append(i);
+        }
+    }
+
+    QDataStream stream(&_chunk, QIODevice::WriteOnly | QIODevice::Append);
+    _setupStream(stream);
+    stream << QDateTime::currentMSecsSinceEpoch() << static_cast<quint16>(_changed.count());
+    for (int index: _changed) {
+        stream << static_cast<quint16>(index);
+        if (_stringColumn(_columns[index].type)) {
+            stream << _lastValues[index].toString();
+        } else {
+            stream << _lastValues[index].toDouble();
+        }
+    }
+
+    if (_chunkTimer.elapsed() >= chunkMSecs) {
+        _flush();
+    }
+}
+
+void TelemetryRecorder::_flush(void)
+{
+    if (!_chunk.isEmpty()) {
+        emit _write(_chunk);
+        _chunk.clear();
+    }
+    _chunkTimer.restart();
+}
+
+bool TelemetryRecorder::exportCsv(const QString& fileName, const QString& csvFileName, QString& errorString)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorString = tr("Unable to open %1: %2").arg(fileName, file.errorString());
+        return false;
+    }
+
+    QDataStream                 stream(&file);
+    QList<Column_t>             columns;
+    _setupStream(stream);
+    if (!_readHeader(stream, columns)) {
+        errorString = tr("%1 is not a telemetry recording").arg(fileName);
+        return false;
+    }
+
+    QFile csvFile(csvFileName);
+    if (!csvFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        errorString = tr("Unable to create %1: %2").arg(csvFileName, csvFile.errorString());
+        return false;
+    }
+
+    // A recording cut short ends in a partial sample, which is left out
+    QVector<QVariant>   values(columns.count());
+    qint64              msecs;
+    csvFile.write(_csvHeader(columns));
+    while (_readSample(stream, columns, msecs, values)) {
+        csvFile.write(_csvRow(columns, msecs, values));
+    }
+
+    return true;
+}
+
+TelemetryRecorderWriter::TelemetryRecorderWriter(QObject* parent)
+    : QObject(parent)
+{
+
+}
+
+void TelemetryRecorderWriter::open(const QString& fileName, const QString& csvFileName, const QByteArray& header)
+{
+    QDataStream stream(header);
+    _setupStream(stream);
+    _readHeader(stream, _columns);
+    _values = QVector<QVariant>(_columns.count());
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::WriteOnly)) {
+        qCWarning(TelemetryRecorderLog) << "Unable to open telemetry recording" << fileName << _file.errorString();
+        return;
+    }
+    _file.write(header);
+
+    if (!csvFileName.isEmpty()) {
+        _csvFile.setFileName(csvFileName);
+        if (_csvFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            _csvFile.write(_csvHeader(_columns));
+        } else {
+            qCWarning(TelemetryRecorderLog) << "Unable to open csv telemetry log" << csvFileName << _csvFile.errorString();
+        }
+    }
+}
+
+void TelemetryRecorderWriter::write(const QByteArray& chunk)
+{
+    if (_file.isOpen()) {
+        _file.write(chunk);
+    }
+
+    if (_csvFile.isOpen()) {
+        QDataStream stream(chunk);
+        qint64      msecs;
+
+        _setupStream(stream);
+        while (_readSample(stream, _columns, msecs, _values)) {
+            _csvFile.write(_csvRow(_columns, msecs, _values));
+        }
+    }
+}
+
+void TelemetryRecorderWriter::close(void)
+{
+    _file.close();
+    _csvFile.close();
+}
@@ -0,0 +1,119 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCLoggingCategory.h"
+#include "QGCTimerWheel.h"
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QObject>
+#include <QThread>
+#include <QVariant>
+#include <QVector>
+
+Q_DECLARE_LOGGING_CATEGORY(TelemetryRecorderLog)
+
+class Fact;
+class FactGroup;
+class Vehicle;
+
+/// Records all facts of a vehicle into a typed column file. Each sample only holds the values which changed since the
+/// previous one, so a high rate costs little while the vehicle is idle. Samples are encoded on the GUI thread, which
+/// is cheap, and handed over in chunks to a writer thread which does the file writes and the optional CSV export.
+///
+/// File layout, little endian QDataStream:
+///     "QGCTEL" version
+///     column count, then for each column: name, FactMetaData::ValueType_t, decimal places
+///     samples until the end of the file: msecs since epoch, change count, then for each change: column index, value.
+///     Values are a double, or a QString for string and custom facts.
+class TelemetryRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    TelemetryRecorder(Vehicle* vehicle, QObject* parent = nullptr);
+    ~TelemetryRecorder();
+
+    typedef struct {
+        QString name;
+        int     type;           ///< FactMetaData::ValueType_t
+        int     decimalPlaces;
+    } Column_t;
+
+    /// Records until stop, or until the recorder is deleted
+    ///     @param fileName     Typed column file
+    ///     @param csvFileName  Also writes the samples as CSV, empty for none
+    ///     @param rateHz       Samples per second
+    void start  (const QString& fileName, const QString& csvFileName, int rateHz);
+    void stop   (void);
+
+    bool    recording   (void) const { return _recording; }
+    QString fileName    (void) const { return _fileName; }
+
+    /// Samples right away, instead of waiting for the next sample timer
+    void sample(void);
+
+    /// Converts a recording to CSV, the same as the one written while recording
+    /// @return false: failed, errorString set
+    static bool exportCsv(const QString& fileName, const QString& csvFileName, QString& errorString);
+
+    static const char*  fileExtension;
+    static const int    chunkMSecs      = 1000;     ///< Samples go to the writer thread this often
+    static const int    maxRateHz       = 50;
+    static const int    fileVersion     = 1;
+
+signals:
+    void _open  (const QString& fileName, const QString& csvFileName, const QByteArray& header);
+    void _write (const QByteArray& chunk);
+    void _close (void);
+
+private:
+    typedef struct {
+        FactGroup*  factGroup;
+        Fact*       fact;
+    } Source_t;
+
+    void _flush(void);
+
+    Vehicle*            _vehicle;
+    QString             _fileName;
+    bool                _recording      = false;
+    QList<Column_t>     _columns;
+    QVector<Source_t>   _sources;
+    QVector<QVariant>   _lastValues;
+    QVector<int>        _changed;
+    QByteArray          _chunk;
+    QElapsedTimer       _chunkTimer;
+    QGCWheelTimer       _sampleTimer    { "TelemetryRecorder" };
+    QThread             _writerThread;
+};
+
+/// Lives on the writer thread of a TelemetryRecorder
+class TelemetryRecorderWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    TelemetryRecorderWriter(QObject* parent = nullptr);
+
+public slots:
+    void open   (const QString& fileName, const QString& csvFileName, const QByteArray& header);
+    void write  (const QByteArray& chunk);
+    void close  (void);
+
+private:
+    QFile                               _file;
+    QFile                               _csvFile;
+    QList<TelemetryRecorder::Column_t>  _columns;
+    QVector<QVariant>                   _values;    ///< Current value of each column, for the CSV rows
+};
@@ -0,0 +1,89 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryRecorderTest.h"
+#include "TelemetryRecorder.h"
+#include "MultiVehicleManager.h"
+#include "QGCApplication.h"
+#include "Vehicle.h"
+
+#include <QTemporaryDir>
+
+static QStringList _readLines(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return QStringList();
+    }
+    return QString::fromUtf8(file.readAll()).split('\n', QString::SkipEmptyParts);
+}
+
+void TelemetryRecorderTest::_recordTest(void)
+{
+    _connectMockLinkNoInitialConnectSequence();
+
+    Vehicle*        vehicle = qgcApp()->toolbox()->multiVehicleManager()->activeVehicle();
+    QTemporaryDir   tempDir;
+    QString         fileName    = tempDir.filePath(QStringLiteral("test.%1").arg(TelemetryRecorder::fileExtension));
+    QString         csvFileName = tempDir.filePath(QStringLiteral("test.csv"));
+    QString         exportName  = tempDir.filePath(QStringLiteral("export.csv"));
+
+    {
+        TelemetryRecorder recorder(vehicle);
+
+        QVERIFY(!recorder.recording());
+        recorder.start(fileName, csvFileName, 10);
+        QVERIFY(recorder.recording());
+        QCOMPARE(recorder.fileName(), fileName);
+
+        // Start took the first sample
+        recorder.sample();
+        recorder.sample();
+        recorder.stop();
+        QVERIFY(!recorder.recording());
+    }
+
+    QVERIFY(QFile::exists(fileName));
+
+    // Header plus one row for each sample, with a column for the timestamp, the vehicle facts and all fact group facts
+    QStringList csvLines = _readLines(csvFileName);
+    QCOMPARE(csvLines.count(), 4);
+    QVERIFY(csvLines[0].startsWith(QStringLiteral("Timestamp,")));
+    QVERIFY(csvLines[0].contains(QStringLiteral("gps.lat")));
+    const int columnCount = csvLines[0].split(',').count();
+    for (int i=1; i<csvLines.count(); i++) {
+        QCOMPARE(csvLines[i].split(',').count(), columnCount);
+    }
+
+    // Exporting afterwards gives the same CSV as the one written while recording
+    QString errorString;
+    QVERIFY(TelemetryRecorder::exportCsv(fileName, exportName, errorString));
+    QCOMPARE(_readLines(exportName), csvLines);
+
+    _disconnectMockLink();
+}
+
+void TelemetryRecorderTest::_badFileTest(void)
+{
+    QTemporaryDir   tempDir;
+    QString         fileName = tempDir.filePath(QStringLiteral("bad.%1").arg(TelemetryRecorder::fileExtension));
+    QString         errorString;
+
+    QVERIFY(!TelemetryRecorder::exportCsv(fileName, tempDir.filePath(QStringLiteral("bad.csv")), errorString));
+    QVERIFY(!errorString.isEmpty());
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("not a recording");
+    file.close();
+
+    errorString.clear();
+    QVERIFY(!TelemetryRecorder::exportCsv(fileName, tempDir.filePath(QStringLiteral("bad.csv")), errorString));
+    QVERIFY(!errorString.isEmpty());
+}
@@ -10,6 +10,9 @@
 #include "TerrainProtocolHandler.h"
 #include "TerrainQuery.h"
 #include "QGCApplication.h"
+#include "MissionItem.h"
+
+#include <limits>
 
 QGC_LOGGING_CATEGORY(TerrainProtocolHandlerLog, "TerrainProtocolHandlerLog")
 
@@ -18,12 +21,17 @@ TerrainProtocolHandler::TerrainProtocolHandler(Vehicle* vehicle, TerrainFactGrou
     , _vehicle          (vehicle)
     , _terrainFactGroup (terrainFactGroup)
 {
-    _terrainDataSendTimer.setSingleShot(false);
-    _terrainDataSendTimer.setInterval(1000.0/12.0);
+    _grids.setMaxCost(_maxCachedGrids);
+
+    _terrainDataSendTimer.setSingleShot(true);
     connect(&_terrainDataSendTimer, &QTimer::timeout, this, &TerrainProtocolHandler::_sendNextTerrainData);
+
+    _prefetchTimer.setSingleShot(false);
+    _prefetchTimer.setInterval(_prefetchIntervalMSecs);
+    connect(&_prefetchTimer, &QTimer::timeout, this, &TerrainProtocolHandler::_prefetchProjectedPath);
 }
 
-bool TerrainProtocolHandler::mavlinkMessageReceived(const mavlink_message_t message)
+bool TerrainProtocolHandler::mavlinkMessageReceived(const mavlink_message_t& message)
 {
     switch (message.msgid) {
     case MAVLINK_MSG_ID_TERRAIN_REQUEST:
@@ -41,6 +49,12 @@ void TerrainProtocolHandler::_handleTerrainRequest(const mavlink_message_t& mess
 {
     _terrainRequestActive = true;
     mavlink_msg_terrain_request_decode(&message, &_currentTerrainRequest);
+
+    // Asking for terrain means the vehicle is using it, from here on it is worth loading ahead
+    _startPrefetch();
+
+    // All the blocks are computed up front, which also queues every missing tile at once
+    _computeGrid(*_currentGrid());
     _sendNextTerrainData();
 }
 
@@ -67,91 +81,248 @@ void TerrainProtocolHandler::_handleTerrainReport(const mavlink_message_t& messa
     }
 }
 
-void TerrainProtocolHandler::_sendNextTerrainData(void)
+QGeoCoordinate TerrainProtocolHandler::blockSWCorner(const QGeoCoordinate& gridSWCorner, int gridSpacing, int gridBit)
 {
-    if (!_terrainRequestActive) {
+    int spacingBetweenBlocks    = gridSpacing * 4;
+    int rowIndex                = gridBit / 8;
+    int colIndex                = gridBit % 8;
+
+    // Move east and then north to generate the coordinate for sw corner of the specific gridBit
+    QGeoCoordinate swCorner = gridSWCorner.atDistanceAndAzimuth(spacingBetweenBlocks * colIndex, 90);
+    return swCorner.atDistanceAndAzimuth(spacingBetweenBlocks * rowIndex, 0);
+}
+
+int TerrainProtocolHandler::nextBlock(uint64_t readyMask, const QGeoCoordinate& gridSWCorner, int gridSpacing, const QGeoCoordinate& target)
+{
+    int     bestBit         = -1;
+    double  bestDistance    = std::numeric_limits<double>::max();
+
+    for (int gridBit=0; gridBit<gridBlockCount; gridBit++) {
+        if (!(readyMask & (1ull << gridBit))) {
+            continue;
+        }
+        if (!target.isValid()) {
+            return gridBit;
+        }
+
+        // Distance to the middle of the 4x4 block
+        QGeoCoordinate center = blockSWCorner(gridSWCorner, gridSpacing, gridBit).atDistanceAndAzimuth(gridSpacing * 1.5, 90);
+        center = center.atDistanceAndAzimuth(gridSpacing * 1.5, 0);
+        double distance = center.distanceTo(target);
+        if (distance < bestDistance) {
+            bestDistance    = distance;
+            bestBit         = gridBit;
+        }
+    }
+
+    return bestBit;
+}
+
+int TerrainProtocolHandler::sendIntervalMSecs(int budgetBytesPerSec)
+{
+    double rateHz = _maxSendRateHz;
+
+    if (budgetBytesPerSec > 0) {
+        const int messageBytes = MAVLINK_MSG_ID_TERRAIN_DATA_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+        rateHz = budgetBytesPerSec * _linkBudgetShare / messageBytes;
+        rateHz = rateHz > _maxSendRateHz ? _maxSendRateHz : (rateHz < _minSendRateHz ? _minSendRateHz : rateHz);
+    }
+
+    return static_cast<int>(1000.0 / rateHz);
+}
+
+QGeoCoordinate TerrainProtocolHandler::_gridSWCorner(void) const
+{
+    return QGeoCoordinate(static_cast<double>(_currentTerrainRequest.lat) / 1e7, static_cast<double>(_currentTerrainRequest.lon) / 1e7);
+}
+
+TerrainProtocolHandler::Grid_t* TerrainProtocolHandler::_currentGrid(void)
+{
+    quint64     latLon  = (static_cast<quint64>(static_cast<quint32>(_currentTerrainRequest.lat)) << 32) | static_cast<quint32>(_currentTerrainRequest.lon);
+    GridKey_t   key     (latLon, _currentTerrainRequest.grid_spacing);
+    Grid_t*     grid    = _grids.object(key);
+
+    if (!grid) {
+        grid = new Grid_t;
+        grid->computedMask = 0;
+        _grids.insert(key, grid);
+    }
+
+    return grid;
+}
+
+/// Computes the requested blocks which don't have heights yet in a single bulk query. Blocks on tiles which are in memory
+/// get their heights, the missing tiles are queued for loading and their blocks are picked up by a later call.
+void TerrainProtocolHandler::_computeGrid(Grid_t& grid)
+{
+    uint64_t missingMask = _currentTerrainRequest.mask & ~grid.computedMask;
+    if (!missingMask) {
         return;
     }
 
-    QGeoCoordinate terrainRequestCoordSWCorner(static_cast<double>(_currentTerrainRequest.lat) / 1e7, static_cast<double>(_currentTerrainRequest.lon) / 1e7);
-    int spacingBetweenGrids = _currentTerrainRequest.grid_spacing * 4;
-
-    // Each TERRAIN_DATA sent to vehicle contains a 4x4 grid of heights
-    // TERRAIN_REQUEST.mask has a bit for each entry in an 8x7 grid
-    // gridBit = 0 refers to the the sw corner of the 8x7 grid
-
-    bool bitFound = false;
-    for (int rowIndex=0; rowIndex<7; rowIndex++) {
-        for (int colIndex=0; colIndex<8; colIndex++) {
-            uint8_t gridBit = (rowIndex * 8) + colIndex;
-            uint64_t checkBit = 1ull << gridBit;
-            if (_currentTerrainRequest.mask & checkBit) {
-                // Move east and then north to generate the coordinate for sw corner of the specific gridBit
-                QGeoCoordinate swCorner = terrainRequestCoordSWCorner.atDistanceAndAzimuth(spacingBetweenGrids * colIndex, 90);
-                swCorner = swCorner.atDistanceAndAzimuth(spacingBetweenGrids * rowIndex, 0);
-                _sendTerrainData(swCorner, gridBit);
-                bitFound = true;
+    QVector<int> gridBits;
+    for (int gridBit=0; gridBit<gridBlockCount; gridBit++) {
+        if (missingMask & (1ull << gridBit)) {
+            gridBits.append(gridBit);
+        }
+    }
+
+    int             pointCount = gridBits.count() * blockPointCount;
+    QVector<double> latitudes(pointCount);
+    QVector<double> longitudes(pointCount);
+    QVector<double> altitudes(pointCount, qQNaN());
+    QGeoCoordinate  gridSWCorner = _gridSWCorner();
+    int             gridSpacing = _currentTerrainRequest.grid_spacing;
+
+    int pointIndex = 0;
+    for (int gridBit: gridBits) {
+        QGeoCoordinate swCorner = blockSWCorner(gridSWCorner, gridSpacing, gridBit);
+        for (int rowIndex=0; rowIndex<4; rowIndex++) {
+            for (int colIndex=0; colIndex<4; colIndex++) {
+                // Move east and then north to generate the coordinate for grid point
+                QGeoCoordinate coord = swCorner.atDistanceAndAzimuth(gridSpacing * colIndex, 90);
+                coord = coord.atDistanceAndAzimuth(gridSpacing * rowIndex, 0);
+                latitudes[pointIndex]   = coord.latitude();
+                longitudes[pointIndex]  = coord.longitude();
+                pointIndex++;
+            }
+        }
+    }
+
+    // Points on tiles in memory get their heights even when other tiles still have to be loaded, the rest stay NaN
+    bool error = false;
+    TerrainAtCoordinateQuery::getAltitudes(latitudes.constData(), longitudes.constData(), altitudes.data(), pointCount, error);
+    if (error) {
+        qCWarning(TerrainProtocolHandlerLog) << "_computeGrid TerrainAtCoordinateQuery::getAltitudes failed";
+    }
+
+    for (int i=0; i<gridBits.count(); i++) {
+        const double* blockAltitudes = altitudes.constData() + (i * blockPointCount);
+
+        bool complete = true;
+        for (int j=0; j<blockPointCount; j++) {
+            if (qIsNaN(blockAltitudes[j])) {
+                complete = false;
                 break;
             }
         }
-        if (bitFound) {
-            break;
+        if (!complete) {
+            continue;
+        }
+
+        for (int j=0; j<blockPointCount; j++) {
+            grid.heights[gridBits[i]][j] = static_cast<int16_t>(blockAltitudes[j]);
+        }
+        grid.computedMask |= 1ull << gridBits[i];
+    }
+
+    qCDebug(TerrainProtocolHandlerLog) << "_computeGrid requested:computed" << gridBits.count() << qPopulationCount(_currentTerrainRequest.mask & grid.computedMask);
+}
+
+void TerrainProtocolHandler::_sendNextTerrainData(void)
+{
+    if (!_terrainRequestActive) {
+        return;
+    }
+
+    if (_currentTerrainRequest.mask) {
+        Grid_t*         grid            = _currentGrid();
+        QGeoCoordinate  gridSWCorner    = _gridSWCorner();
+        QGeoCoordinate  target          = _projectedCoordinate(_sendLookAheadSecs);
+        int             gridBit         = nextBlock(_currentTerrainRequest.mask & grid->computedMask, gridSWCorner, _currentTerrainRequest.grid_spacing, target);
+
+        if (gridBit == -1) {
+            // Nothing ready, pick up the blocks of any tiles which have loaded since. Otherwise try again on the next tick.
+            _computeGrid(*grid);
+            gridBit = nextBlock(_currentTerrainRequest.mask & grid->computedMask, gridSWCorner, _currentTerrainRequest.grid_spacing, target);
+        }
+        if (gridBit != -1) {
+            _currentTerrainRequest.mask &= ~(1ull << gridBit);
+            _sendTerrainData(static_cast<uint8_t>(gridBit), grid->heights[gridBit]);
         }
     }
 
-    if (bitFound) {
+    if (_currentTerrainRequest.mask) {
         // Kick timer to send next possible TERRAIN_DATA to vehicle
-        _terrainDataSendTimer.start();
+        _terrainDataSendTimer.start(sendIntervalMSecs(_vehicle->vehicleLinkManager()->telemetryBudgetBytesPerSecond()));
     } else {
         _terrainRequestActive = false;
     }
 }
 
-void TerrainProtocolHandler::_sendTerrainData(const QGeoCoordinate& swCorner, uint8_t gridBit)
+void TerrainProtocolHandler::_sendTerrainData(uint8_t gridBit, const int16_t* heights)
 {
-    QList<QGeoCoordinate> coordinates;
-    for (int rowIndex=0; rowIndex<4; rowIndex++) {
-        for (int colIndex=0; colIndex<4; colIndex++) {
-            // Move east and then north to generate the coordinate for grid point
-            QGeoCoordinate coord = swCorner.atDistanceAndAzimuth(_currentTerrainRequest.grid_spacing * colIndex, 90);
-            coord = coord.atDistanceAndAzimuth(_currentTerrainRequest.grid_spacing * rowIndex, 0);
-            coordinates.append(coord);
-        }
+    WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
+    if (!weakLink.expired()) {
+        mavlink_message_t       msg;
+        SharedLinkInterfacePtr  sharedLink = weakLink.lock();
+
+        mavlink_msg_terrain_data_pack_chan(
+                    qgcApp()->toolbox()->mavlinkProtocol()->getSystemId(),
+                    qgcApp()->toolbox()->mavlinkProtocol()->getComponentId(),
+                    sharedLink->mavlinkChannel(),
+                    &msg,
+                    _currentTerrainRequest.lat,
+                    _currentTerrainRequest.lon,
+                    _currentTerrainRequest.grid_spacing,
+                    gridBit,
+                    heights);
+        _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
     }
+}
 
-    // Query terrain system for altitudes. If it has them available it will return them. If not they will be queued for download.
-    bool            error = false;
-    QList<double>   altitudes;
-    if (TerrainAtCoordinateQuery::getAltitudesForCoordinates(coordinates, altitudes, error)) {
-        if (error) {
-            qCWarning(TerrainProtocolHandlerLog) << "_sendTerrainData TerrainAtCoordinateQuery::getAltitudesForCoordinates failed";
-        } else {
-            // Only clear the bit if the query succeeds. Otherwise just let it try again on the next timer tick
-            uint64_t removeBit = ~(1ull << gridBit);
-            _currentTerrainRequest.mask &= removeBit;
-            int altIndex = 0;
-            int16_t terrainData[16];
-            for (const double& altitude : altitudes) {
-                terrainData[altIndex++] = static_cast<int16_t>(altitude);
-            }
+/// @return Where the vehicle will be after lookAheadSecs at its current speed and heading, invalid without a position
+QGeoCoordinate TerrainProtocolHandler::_projectedCoordinate(double lookAheadSecs) const
+{
+    QGeoCoordinate  coord   = _vehicle->coordinate();
+    double          speed   = _vehicle->groundSpeed()->rawValue().toDouble();
+    double          heading = _vehicle->heading()->rawValue().toDouble();
 
-            WeakLinkInterfacePtr weakLink = _vehicle->vehicleLinkManager()->primaryLink();
-            if (!weakLink.expired()) {
-                mavlink_message_t       msg;
-                SharedLinkInterfacePtr  sharedLink = weakLink.lock();
-
-                mavlink_msg_terrain_data_pack_chan(
-                            qgcApp()->toolbox()->mavlinkProtocol()->getSystemId(),
-                            qgcApp()->toolbox()->mavlinkProtocol()->getComponentId(),
-                            sharedLink->mavlinkChannel(),
-                            &msg,
-                            _currentTerrainRequest.lat,
-                            _currentTerrainRequest.lon,
-                            _currentTerrainRequest.grid_spacing,
-                            gridBit,
-                            terrainData);
-                _vehicle->sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
-            }
+    if (!coord.isValid() || qIsNaN(speed) || qIsNaN(heading) || speed <= 0) {
+        return coord;
+    }
+
+    return coord.atDistanceAndAzimuth(speed * lookAheadSecs, heading);
+}
+
+void TerrainProtocolHandler::_startPrefetch(void)
+{
+    if (_prefetchActive) {
+        return;
+    }
+    _prefetchActive = true;
+
+    connect(_vehicle->missionManager(), &MissionManager::newMissionItemsAvailable, this, &TerrainProtocolHandler::_prefetchMission);
+    _prefetchTimer.start();
+
+    _prefetchMission();
+    _prefetchProjectedPath();
+}
+
+void TerrainProtocolHandler::_prefetchMission(void)
+{
+    QList<QGeoCoordinate> path;
+
+    for (const MissionItem* missionItem: _vehicle->missionManager()->missionItems()) {
+        QGeoCoordinate coord = missionItem->coordinate();
+        // Commands without a location leave latitude and longitude at zero
+        if (coord.isValid() && (coord.latitude() != 0 || coord.longitude() != 0)) {
+            path.append(coord);
         }
     }
+
+    if (!path.isEmpty()) {
+        int missingTiles = TerrainAtCoordinateQuery::prefetchPath(path, _missionCorridorMeters);
+        qCDebug(TerrainProtocolHandlerLog) << "_prefetchMission items:missingTiles" << path.count() << missingTiles;
+    }
+}
+
+void TerrainProtocolHandler::_prefetchProjectedPath(void)
+{
+    QGeoCoordinate coord = _vehicle->coordinate();
+
+    if (coord.isValid()) {
+        QList<QGeoCoordinate> path({ coord, _projectedCoordinate(_prefetchLookAheadSecs) });
+        TerrainAtCoordinateQuery::prefetchPath(path, _projectedCorridorMeters);
+    }
 }
@@ -15,11 +15,18 @@
 
 #include <QObject>
 #include <QGeoCoordinate>
+#include <QCache>
+#include <QPair>
+#include <QTimer>
 
 class TerrainFactGroup;
 
 Q_DECLARE_LOGGING_CATEGORY(TerrainProtocolHandlerLog)
 
+/// Serves the terrain heights an ArduPilot vehicle asks for with TERRAIN_REQUEST. Once the vehicle has asked for terrain
+/// the tiles for the mission and for where the vehicle is heading are loaded ahead of time, so that requests can be
+/// answered right away. All the blocks of a request are computed at once and sent closest to the vehicle's path first,
+/// paced to the telemetry budget of the link.
 class TerrainProtocolHandler : public QObject
 {
     Q_OBJECT
@@ -28,19 +35,59 @@ public:
     explicit TerrainProtocolHandler(Vehicle* vehicle, TerrainFactGroup* terrainFactGroup, QObject *parent = nullptr);
 
     /// @return true: Allow vehicle to continue processing, false: Vehicle should not process message
-    bool mavlinkMessageReceived(const mavlink_message_t message);
+    bool mavlinkMessageReceived(const mavlink_message_t& message);
+
+    static const int gridBlockCount     = 56;   ///< TERRAIN_REQUEST.mask has a bit for each entry in an 8x7 grid of blocks
+    static const int blockPointCount    = 16;   ///< Each TERRAIN_DATA holds a 4x4 block of heights
+
+    /// @return South west corner of a block in the grid
+    static QGeoCoordinate blockSWCorner(const QGeoCoordinate& gridSWCorner, int gridSpacing, int gridBit);
+
+    /// @return Block to send next out of readyMask, the one closest to target. Lowest block first for an invalid target, -1 for none.
+    static int nextBlock(uint64_t readyMask, const QGeoCoordinate& gridSWCorner, int gridSpacing, const QGeoCoordinate& target);
+
+    /// @return Interval between TERRAIN_DATA messages for a link telemetry budget, 0 for no limit
+    static int sendIntervalMSecs(int budgetBytesPerSec);
 
 private slots:
-    void _sendNextTerrainData(void);
+    void _sendNextTerrainData   (void);
+    void _prefetchMission       (void);
+    void _prefetchProjectedPath (void);
 
 private:
-    void _handleTerrainRequest  (const mavlink_message_t& message);
-    void _handleTerrainReport   (const mavlink_message_t& message);
-    void _sendTerrainData       (const QGeoCoordinate& swCorner, uint8_t gridBit);
+    typedef struct {
+        uint64_t    computedMask;                           ///< Blocks which have heights
+        int16_t     heights[gridBlockCount][blockPointCount];
+    } Grid_t;
+
+    typedef QPair<quint64 /* lat << 32 | lon */, int /* grid spacing */> GridKey_t;
+
+    void            _handleTerrainRequest   (const mavlink_message_t& message);
+    void            _handleTerrainReport    (const mavlink_message_t& message);
+    void            _sendTerrainData        (uint8_t gridBit, const int16_t* heights);
+    void            _startPrefetch          (void);
+    Grid_t*         _currentGrid            (void);
+    void            _computeGrid            (Grid_t& grid);
+    QGeoCoordinate  _gridSWCorner           (void) const;
+    QGeoCoordinate  _projectedCoordinate    (double lookAheadSecs) const;
 
     Vehicle*                    _vehicle;
     TerrainFactGroup*           _terrainFactGroup;
     bool                        _terrainRequestActive =             false;
     mavlink_terrain_request_t   _currentTerrainRequest;
     QTimer                      _terrainDataSendTimer;
+    QCache<GridKey_t, Grid_t>   _grids;                             ///< The vehicle asks again for blocks which went missing
+    bool                        _prefetchActive =                   false;
+    QTimer                      _prefetchTimer;
+
+    static const int _maxCachedGrids            = 16;
+    static const int _prefetchIntervalMSecs     = 10000;
+    static const int _maxSendRateHz             = 50;
+    static const int _minSendRateHz             = 1;
+
+    static constexpr double _linkBudgetShare            = 0.2;      ///< Part of the link telemetry budget terrain may use
+    static constexpr double _sendLookAheadSecs          = 10;       ///< Blocks are sent closest to where the vehicle will be by then first
+    static constexpr double _prefetchLookAheadSecs      = 120;
+    static constexpr double _projectedCorridorMeters    = 3000;     ///< About the size of a grid at the default 100m spacing
+    static constexpr double _missionCorridorMeters      = 2000;
 };
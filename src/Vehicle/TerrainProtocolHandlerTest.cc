@@ -0,0 +1,58 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TerrainProtocolHandlerTest.h"
+#include "TerrainProtocolHandler.h"
+
+void TerrainProtocolHandlerTest::_blockSWCornerTest(void)
+{
+    QGeoCoordinate gridSWCorner(47.39, 8.54);
+
+    QVERIFY(TerrainProtocolHandler::blockSWCorner(gridSWCorner, 100, 0).distanceTo(gridSWCorner) < 0.01);
+
+    // Block 9 is one row north and one column east, each block is 4 grid points of 100m
+    QGeoCoordinate swCorner = TerrainProtocolHandler::blockSWCorner(gridSWCorner, 100, 9);
+    QVERIFY(qAbs(swCorner.distanceTo(gridSWCorner) - qSqrt(2.0) * 400) < 1);
+    QVERIFY(swCorner.latitude() > gridSWCorner.latitude());
+    QVERIFY(swCorner.longitude() > gridSWCorner.longitude());
+}
+
+void TerrainProtocolHandlerTest::_nextBlockTest(void)
+{
+    QGeoCoordinate  gridSWCorner(47.39, 8.54);
+    uint64_t        allBlocks = (1ull << TerrainProtocolHandler::gridBlockCount) - 1;
+
+    QCOMPARE(TerrainProtocolHandler::nextBlock(0, gridSWCorner, 100, gridSWCorner), -1);
+
+    // Without a target the blocks go out from the sw corner
+    QCOMPARE(TerrainProtocolHandler::nextBlock(allBlocks, gridSWCorner, 100, QGeoCoordinate()), 0);
+    QCOMPARE(TerrainProtocolHandler::nextBlock(allBlocks & ~1ull, gridSWCorner, 100, QGeoCoordinate()), 1);
+
+    // Target along the west edge of the north east block
+    QGeoCoordinate target = TerrainProtocolHandler::blockSWCorner(gridSWCorner, 100, 55).atDistanceAndAzimuth(10, 90).atDistanceAndAzimuth(150, 0);
+    QCOMPARE(TerrainProtocolHandler::nextBlock(allBlocks, gridSWCorner, 100, target), 55);
+
+    // Its neighbour to the west is next once it has been sent
+    QCOMPARE(TerrainProtocolHandler::nextBlock(allBlocks & ~(1ull << 55), gridSWCorner, 100, target), 54);
+}
+
+void TerrainProtocolHandlerTest::_sendIntervalTest(void)
+{
+    // No limit sends as fast as allowed
+    int fastestMSecs = TerrainProtocolHandler::sendIntervalMSecs(0);
+    QCOMPARE(fastestMSecs, TerrainProtocolHandler::sendIntervalMSecs(1000000));
+
+    // A low bandwidth radio only gets part of its budget
+    int radioMSecs = TerrainProtocolHandler::sendIntervalMSecs(1000);
+    QVERIFY(radioMSecs > fastestMSecs);
+    QVERIFY(1000.0 / radioMSecs * (MAVLINK_MSG_ID_TERRAIN_DATA_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES) <= 1000 * 0.25);
+
+    // Even a tiny budget keeps the vehicle from waiting forever
+    QVERIFY(TerrainProtocolHandler::sendIntervalMSecs(1) <= 1000);
+}
@@ -0,0 +1,148 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TrajectoryBuffer.h"
+
+TrajectoryBuffer::TrajectoryBuffer(int maxPoints)
+    : _maxPoints(qMax(0, maxPoints))
+{
+
+}
+
+void TrajectoryBuffer::append(const QGeoCoordinate& coordinate, qint64 timeMsecs)
+{
+    if (_count == 0) {
+        _chunks.clear();
+        _first = 0;
+        _timeBase = timeMsecs;
+    }
+    if ((_first + _count) % chunkSize == 0) {
+        _chunks.append(std::make_shared<Chunk_t>());
+    }
+    _count++;
+    _set(_count - 1, coordinate, timeMsecs);
+
+    _trim();
+}
+
+void TrajectoryBuffer::replaceLast(const QGeoCoordinate& coordinate, qint64 timeMsecs)
+{
+    if (_count == 0) {
+        append(coordinate, timeMsecs);
+    } else {
+        _set(_count - 1, coordinate, timeMsecs);
+    }
+}
+
+void TrajectoryBuffer::clear(void)
+{
+    _chunks.clear();
+    _first      = 0;
+    _count      = 0;
+    _dropped    = 0;
+    _timeBase   = 0;
+}
+
+int TrajectoryBuffer::removeBefore(qint64 timeMsecs)
+{
+    int removed = 0;
+
+    while (_count > 0 && this->timeMsecs(0) < timeMsecs) {
+        if (_first == 0 && _count >= chunkSize && this->timeMsecs(chunkSize - 1) < timeMsecs) {
+            // Whole chunk is older
+            removed += chunkSize;
+            _dropChunk();
+            continue;
+        }
+        _first++;
+        _count--;
+        removed++;
+        if (_first == chunkSize) {
+            _chunks.removeFirst();
+            _first = 0;
+        }
+    }
+    if (_count == 0) {
+        _chunks.clear();
+        _first = 0;
+    }
+
+    return removed;
+}
+
+void TrajectoryBuffer::setMaxPoints(int maxPoints)
+{
+    _maxPoints = qMax(0, maxPoints);
+    _trim();
+}
+
+QGeoCoordinate TrajectoryBuffer::coordinate(int index) const
+{
+    if (index < 0 || index >= _count) {
+        return QGeoCoordinate();
+    }
+
+    const int       position    = _first + index;
+    const Chunk_t*  chunk       = _chunks[position / chunkSize].get();
+    const int       offset      = position % chunkSize;
+
+    return QGeoCoordinate(chunk->latitude[offset], chunk->longitude[offset], static_cast<double>(chunk->altitude[offset]));
+}
+
+qint64 TrajectoryBuffer::timeMsecs(int index) const
+{
+    if (index < 0 || index >= _count) {
+        return 0;
+    }
+
+    const int position = _first + index;
+
+    return _timeBase + qRound64(static_cast<double>(_chunks[position / chunkSize]->time[position % chunkSize]) * 1000.0);
+}
+
+QVariantList TrajectoryBuffer::toVariantList(void) const
+{
+    QVariantList list;
+
+    list.reserve(_count);
+    for (int i=0; i<_count; i++) {
+        list.append(QVariant::fromValue(coordinate(i)));
+    }
+
+    return list;
+}
+
+void TrajectoryBuffer::_set(int index, const QGeoCoordinate& coordinate, qint64 timeMsecs)
+{
+    const int   position    = _first + index;
+    Chunk_t*    chunk       = _chunks[position / chunkSize].get();
+    const int   offset      = position % chunkSize;
+
+    chunk->latitude[offset]     = coordinate.latitude();
+    chunk->longitude[offset]    = coordinate.longitude();
+    // NaN altitude survives the float, so 2D coordinates come back as 2D
+    chunk->altitude[offset]     = static_cast<float>(coordinate.altitude());
+    chunk->time[offset]         = static_cast<float>(static_cast<double>(timeMsecs - _timeBase) / 1000.0);
+}
+
+void TrajectoryBuffer::_dropChunk(void)
+{
+    _count -= chunkSize - _first;
+    _chunks.removeFirst();
+    _first = 0;
+}
+
+void TrajectoryBuffer::_trim(void)
+{
+    // Only whole chunks are dropped, with what is left still holding at least maxPoints
+    while (_maxPoints > 0 && _count - (chunkSize - _first) >= _maxPoints) {
+        _dropped += chunkSize - _first;
+        _dropChunk();
+    }
+}
@@ -0,0 +1,77 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QGeoCoordinate>
+#include <QList>
+#include <QVariantList>
+
+#include <memory>
+
+/// Columnar storage for a flight track: latitude/longitude as double, altitude and time as float, in fixed size
+/// chunks. About 24 bytes per point compared to a QVariant wrapped QGeoCoordinate, and appending never reallocates
+/// the points already stored.
+///
+/// With maxPoints set the oldest points are dropped, a whole chunk at a time, so the count stays between maxPoints
+/// and maxPoints + chunkSize.
+class TrajectoryBuffer
+{
+public:
+    TrajectoryBuffer(int maxPoints = 0);
+
+    /// @param timeMsecs msecs since epoch
+    void append     (const QGeoCoordinate& coordinate, qint64 timeMsecs);
+    void replaceLast(const QGeoCoordinate& coordinate, qint64 timeMsecs);
+    void clear      (void);
+
+    /// Drops points from the front which are older than timeMsecs
+    /// @return Number of points dropped
+    int removeBefore(qint64 timeMsecs);
+
+    int             count       (void) const { return _count; }
+    bool            isEmpty     (void) const { return _count == 0; }
+    QGeoCoordinate  coordinate  (int index) const;
+    qint64          timeMsecs   (int index) const;
+    QGeoCoordinate  last        (void) const { return coordinate(_count - 1); }
+
+    /// @return Points dropped by maxPoints since the last clear
+    int             dropped     (void) const { return _dropped; }
+
+    /// 0 for unbounded
+    void            setMaxPoints(int maxPoints);
+    int             maxPoints   (void) const { return _maxPoints; }
+
+    /// @return Points as QGeoCoordinate, oldest first
+    QVariantList    toVariantList(void) const;
+
+    /// @return Bytes of the allocated chunks
+    qint64          allocatedBytes(void) const { return _chunks.count() * static_cast<qint64>(sizeof(Chunk_t)); }
+
+    static const int chunkSize = 1024;
+
+private:
+    struct Chunk_t {
+        double  latitude    [chunkSize];
+        double  longitude   [chunkSize];
+        float   altitude    [chunkSize];
+        float   time        [chunkSize];    ///< secs since _timeBase
+    };
+
+    void _set       (int index, const QGeoCoordinate& coordinate, qint64 timeMsecs);
+    void _dropChunk (void);
+    void _trim      (void);
+
+    QList<std::shared_ptr<Chunk_t>> _chunks;
+    int                             _first      = 0;    ///< Index of the oldest point in the first chunk
+    int                             _count      = 0;
+    int                             _maxPoints  = 0;
+    int                             _dropped    = 0;
+    qint64                          _timeBase   = 0;
+};
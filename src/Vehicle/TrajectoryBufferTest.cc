@@ -0,0 +1,98 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TrajectoryBufferTest.h"
+#include "TrajectoryBuffer.h"
+
+static QGeoCoordinate _testCoordinate(int index)
+{
+    return QGeoCoordinate(47.0 + index * 1e-5, 8.0 + index * 1e-5, 100.0 + index % 50);
+}
+
+void TrajectoryBufferTest::_appendTest(void)
+{
+    TrajectoryBuffer    buffer;
+    const int           pointCount  = TrajectoryBuffer::chunkSize * 2 + 10;
+    const qint64        timeBase    = 1600000000000;
+
+    QVERIFY(buffer.isEmpty());
+    QVERIFY(!buffer.last().isValid());
+
+    // Crosses chunk boundaries
+    for (int i=0; i<pointCount; i++) {
+        buffer.append(_testCoordinate(i), timeBase + i * 100);
+    }
+    QCOMPARE(buffer.count(), pointCount);
+    for (int i=0; i<pointCount; i++) {
+        QGeoCoordinate coordinate = buffer.coordinate(i);
+        QVERIFY(qAbs(coordinate.latitude() - _testCoordinate(i).latitude()) < 1e-9);
+        QVERIFY(qAbs(coordinate.altitude() - _testCoordinate(i).altitude()) < 0.01);
+        QCOMPARE(buffer.timeMsecs(i), timeBase + i * 100);
+    }
+    QVERIFY(!buffer.coordinate(pointCount).isValid());
+
+    buffer.replaceLast(_testCoordinate(0), timeBase);
+    QCOMPARE(buffer.count(), pointCount);
+    QCOMPARE(buffer.last(), buffer.coordinate(0));
+
+    // 2D coordinates stay 2D
+    buffer.append(QGeoCoordinate(47.0, 8.0), timeBase);
+    QCOMPARE(buffer.last().type(), QGeoCoordinate::Coordinate2D);
+
+    QCOMPARE(buffer.toVariantList().count(), buffer.count());
+    QCOMPARE(buffer.toVariantList().first().value<QGeoCoordinate>(), buffer.coordinate(0));
+
+    buffer.clear();
+    QVERIFY(buffer.isEmpty());
+    QVERIFY(buffer.toVariantList().isEmpty());
+}
+
+void TrajectoryBufferTest::_maxPointsTest(void)
+{
+    const int           maxPoints = 1500;
+    TrajectoryBuffer    buffer(maxPoints);
+
+    for (int i=0; i<TrajectoryBuffer::chunkSize * 10; i++) {
+        buffer.append(_testCoordinate(i), i);
+        QVERIFY(buffer.count() <= maxPoints + TrajectoryBuffer::chunkSize);
+        QVERIFY(buffer.count() == i + 1 || buffer.count() >= maxPoints);
+    }
+    QCOMPARE(buffer.count() + buffer.dropped(), TrajectoryBuffer::chunkSize * 10);
+    // Newest points are kept
+    QCOMPARE(buffer.timeMsecs(buffer.count() - 1), static_cast<qint64>(TrajectoryBuffer::chunkSize * 10 - 1));
+    QCOMPARE(buffer.timeMsecs(0), static_cast<qint64>(buffer.dropped()));
+
+    // Lowering the bound trims right away
+    buffer.setMaxPoints(10);
+    QVERIFY(buffer.count() >= 10 && buffer.count() <= 10 + TrajectoryBuffer::chunkSize);
+}
+
+void TrajectoryBufferTest::_removeBeforeTest(void)
+{
+    TrajectoryBuffer buffer;
+
+    for (int i=0; i<3000; i++) {
+        buffer.append(_testCoordinate(i), i * 10);
+    }
+
+    QCOMPARE(buffer.removeBefore(5), 1);
+    QCOMPARE(buffer.timeMsecs(0), static_cast<qint64>(10));
+    QCOMPARE(buffer.removeBefore(20000), 1999);
+    QCOMPARE(buffer.count(), 1000);
+    QCOMPARE(buffer.timeMsecs(0), static_cast<qint64>(20000));
+    QCOMPARE(buffer.coordinate(0).latitude(), _testCoordinate(2000).latitude());
+
+    // Appending after a partial removal keeps the order
+    buffer.append(_testCoordinate(3000), 30000);
+    QCOMPARE(buffer.count(), 1001);
+    QCOMPARE(buffer.timeMsecs(1000), static_cast<qint64>(30000));
+
+    QCOMPARE(buffer.removeBefore(100000), 1001);
+    QVERIFY(buffer.isEmpty());
+}
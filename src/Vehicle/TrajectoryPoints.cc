@@ -9,45 +9,123 @@
 
 #include "TrajectoryPoints.h"
 #include "Vehicle.h"
+#include "QGCMemoryAccounting.h"
+#include "QGCApplication.h"
+
+#include <QDateTime>
 
 TrajectoryPoints::TrajectoryPoints(Vehicle* vehicle, QObject* parent)
     : QObject       (parent)
     , _vehicle      (vehicle)
-    , _lastAzimuth  (qQNaN())
 {
+    double distanceTolerance = _distanceTolerance;
+
+    for (int i=0; i<_levelCount; i++) {
+        Level_t level;
+
+        level.distanceTolerance = distanceTolerance;
+        level.lastAzimuth       = qQNaN();
+        _levels.append(level);
+        distanceTolerance *= 4;
+    }
+
+    qgcApp()->toolbox()->memoryAccounting()->addSource(QStringLiteral("Trajectory points"), this, [this]() {
+        QGCMemoryAccounting::Usage_t usage{ 0, 0 };
+        for (const Level_t& level: _levels) {
+            usage.count += level.points.count();
+            usage.bytes += level.points.allocatedBytes();
+        }
+        return usage;
+    });
 }
 
-void TrajectoryPoints::_vehicleCoordinateChanged(QGeoCoordinate coordinate)
+TrajectoryPoints::PointChange_t TrajectoryPoints::_addToLevel(Level_t& level, const QGeoCoordinate& coordinate, qint64 timeMsecs, double* distance)
 {
     // The goal of this algorithm is to limit the number of trajectory points whic represent the vehicle path.
     // Fewer points means higher performance of map display.
 
-    if (_lastPoint.isValid()) {
-        double distance = _lastPoint.distanceTo(coordinate);
-        if (distance > _distanceTolerance) {
-            //-- Update flight distance
-            _vehicle->updateFlightDistance(distance);
+    if (level.lastPoint.isValid()) {
+        *distance = level.lastPoint.distanceTo(coordinate);
+        if (*distance > level.distanceTolerance) {
             // Vehicle has moved far enough from previous point for an update
-            double newAzimuth = _lastPoint.azimuthTo(coordinate);
-            if (qIsNaN(_lastAzimuth) || qAbs(newAzimuth - _lastAzimuth) > _azimuthTolerance) {
+            double newAzimuth = level.lastPoint.azimuthTo(coordinate);
+            if (qIsNaN(level.lastAzimuth) || qAbs(newAzimuth - level.lastAzimuth) > _azimuthTolerance) {
                 // The new position IS NOT colinear with the last segment. Append the new position to the list.
-                _lastAzimuth = _lastPoint.azimuthTo(coordinate);
-                _lastPoint = coordinate;
-                _points.append(QVariant::fromValue(coordinate));
-                emit pointAdded(coordinate);
+                level.lastAzimuth = newAzimuth;
+                level.lastPoint = coordinate;
+                level.points.append(coordinate, timeMsecs);
+                return PointAdded;
             } else {
                 // The new position IS colinear with the last segment. Don't add a new point, just update
                 // the last point to be the new position.
-                _lastPoint = coordinate;
-                _points[_points.count() - 1] = QVariant::fromValue(coordinate);
-                emit updateLastPoint(coordinate);
+                level.lastPoint = coordinate;
+                level.points.replaceLast(coordinate, timeMsecs);
+                return PointUpdated;
             }
         }
     } else {
         // Add the very first trajectory point to the list
-        _lastPoint = coordinate;
-        _points.append(QVariant::fromValue(coordinate));
+        level.lastPoint = coordinate;
+        level.points.append(coordinate, timeMsecs);
+        return PointAdded;
+    }
+
+    return PointNone;
+}
+
+void TrajectoryPoints::_vehicleCoordinateChanged(QGeoCoordinate coordinate)
+{
+    const qint64    now             = QDateTime::currentMSecsSinceEpoch();
+    const int       displayDropped  = _levels[_displayLevel].points.dropped();
+    PointChange_t   displayChange   = PointNone;
+
+    for (int i=0; i<_levels.count(); i++) {
+        double          distance    = 0;
+        PointChange_t   change      = _addToLevel(_levels[i], coordinate, now, &distance);
+
+        if (i == 0 && change != PointNone && distance > 0) {
+            //-- Update flight distance
+            _vehicle->updateFlightDistance(distance);
+        }
+        if (i == _displayLevel) {
+            displayChange = change;
+        }
+    }
+
+    const int previousDisplayLevel = _displayLevel;
+    _updateDisplayLevel();
+
+    if (_displayLevel != previousDisplayLevel || _levels[_displayLevel].points.dropped() != displayDropped) {
+        emit pointsReset();
+    } else if (displayChange == PointAdded) {
         emit pointAdded(coordinate);
+    } else if (displayChange == PointUpdated) {
+        emit updateLastPoint(coordinate);
+    }
+}
+
+void TrajectoryPoints::_updateDisplayLevel(void)
+{
+    // Finest level which fits, coarsest if none do
+    int displayLevel = 0;
+
+    while (displayLevel < _levels.count() - 1 && _levels[displayLevel].points.count() > _maxDisplayPoints) {
+        displayLevel++;
+    }
+    _displayLevel = displayLevel;
+}
+
+void TrajectoryPoints::setMaxPoints(int maxPoints)
+{
+    maxPoints = qMax(0, maxPoints);
+    if (maxPoints != _maxPoints) {
+        _maxPoints = maxPoints;
+        for (Level_t& level: _levels) {
+            level.points.setMaxPoints(_maxPoints);
+        }
+        _updateDisplayLevel();
+        emit maxPointsChanged();
+        emit pointsReset();
     }
 }
 
@@ -64,8 +142,11 @@ void TrajectoryPoints::stop(void)
 
 void TrajectoryPoints::clear(void)
 {
-    _points.clear();
-    _lastPoint = QGeoCoordinate();
-    _lastAzimuth = qQNaN();
+    for (Level_t& level: _levels) {
+        level.points.clear();
+        level.lastPoint = QGeoCoordinate();
+        level.lastAzimuth = qQNaN();
+    }
+    _displayLevel = 0;
     emit pointsCleared();
 }
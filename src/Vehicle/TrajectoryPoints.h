@@ -10,11 +10,15 @@
 #pragma once
 
 #include "QmlObjectListModel.h"
+#include "TrajectoryBuffer.h"
 
 #include <QGeoCoordinate>
 
 class Vehicle;
 
+/// Flight track of a vehicle. The track is kept at several resolutions, each level only adds a point once the vehicle
+/// has moved further from the previous one. The map shows the finest level which still fits in maxDisplayPoints, so
+/// long flights switch to a coarser track instead of growing the map polyline without bound.
 class TrajectoryPoints : public QObject
 {
     Q_OBJECT
@@ -22,28 +26,61 @@ class TrajectoryPoints : public QObject
 public:
     TrajectoryPoints(Vehicle* vehicle, QObject* parent = nullptr);
 
-    Q_INVOKABLE QVariantList list(void) const { return _points; }
+    Q_PROPERTY(int maxPoints    READ maxPoints      WRITE setMaxPoints  NOTIFY maxPointsChanged)
+    Q_PROPERTY(int displayLevel READ displayLevel                       NOTIFY pointsReset)
+
+    /// @return Points of the display level
+    Q_INVOKABLE QVariantList list(void) const { return _levels[_displayLevel].points.toVariantList(); }
 
     void start  (void);
     void stop   (void);
 
+    /// Maximum number of points kept for each level, oldest points are dropped. 0 for unbounded.
+    int     maxPoints   (void) const { return _maxPoints; }
+    void    setMaxPoints(int maxPoints);
+
+    int                     displayLevel(void) const { return _displayLevel; }
+    int                     levelCount  (void) const { return _levels.count(); }
+    const TrajectoryBuffer& level       (int level) const { return _levels[level].points; }
+
 public slots:
     void clear  (void);
 
 signals:
-    void pointAdded     (QGeoCoordinate coordinate);
-    void updateLastPoint(QGeoCoordinate coordinate);
-    void pointsCleared  (void);
+    void pointAdded         (QGeoCoordinate coordinate);
+    void updateLastPoint    (QGeoCoordinate coordinate);
+    void pointsCleared      (void);
+    /// Display level changed or old points were dropped, re-read list()
+    void pointsReset        (void);
+    void maxPointsChanged   (void);
 
 private slots:
     void _vehicleCoordinateChanged(QGeoCoordinate coordinate);
 
 private:
+    typedef enum {
+        PointNone,
+        PointAdded,
+        PointUpdated,
+    } PointChange_t;
+
+    struct Level_t {
+        TrajectoryBuffer    points;
+        double              distanceTolerance;
+        QGeoCoordinate      lastPoint;
+        double              lastAzimuth;
+    };
+
+    PointChange_t   _addToLevel         (Level_t& level, const QGeoCoordinate& coordinate, qint64 timeMsecs, double* distance);
+    void            _updateDisplayLevel (void);
+
     Vehicle*        _vehicle;
-    QVariantList    _points;
-    QGeoCoordinate  _lastPoint;
-    double          _lastAzimuth;
+    QList<Level_t>  _levels;
+    int             _displayLevel   = 0;
+    int             _maxPoints      = 0;
 
     static constexpr double _distanceTolerance = 2.0;
     static constexpr double _azimuthTolerance = 1.5;
+    static const int        _levelCount = 5;                ///< Each level is 4x coarser than the one before
+    static const int        _maxDisplayPoints = 2000;
 };
@@ -10,8 +10,11 @@
 #include <QTime>
 #include <QDateTime>
 #include <QLocale>
+#include <QMetaMethod>
 #include <QQuaternion>
 
+#include <limits>
+
 #include <Eigen/Eigen>
 
 #include "Vehicle.h"
@@ -49,6 +52,10 @@
 #include "ComponentInformationManager.h"
 #include "InitialConnectStateMachine.h"
 #include "VehicleBatteryFactGroup.h"
+#include "TelemetryRecorder.h"
+#include "MessageRateManager.h"
+#include "LogReplayLink.h"
+#include "QGCTrace.h"
 #ifdef QT_DEBUG
 #include "MockLink.h"
 #endif
@@ -152,6 +159,9 @@ Vehicle::Vehicle(LinkInterface*             link,
     , _escStatusFactGroup           (this)
     , _estimatorStatusFactGroup     (this)
     , _terrainFactGroup             (this)
+    , _escStatusModel               (this)
+    , _batteryStatusModel           (this)
+    , _statusTextHandler            (this)
     , _terrainProtocolHandler       (new TerrainProtocolHandler(this, &_terrainFactGroup, this))
 {
     _linkManager = _toolbox->linkManager();
@@ -162,7 +172,7 @@ Vehicle::Vehicle(LinkInterface*             link,
     _mavlink = _toolbox->mavlinkProtocol();
     qCDebug(VehicleLog) << "Link started with Mavlink " << (_mavlink->getCurrentVersion() >= 200 ? "V2" : "V1");
 
-    connect(_mavlink, &MAVLinkProtocol::messageReceived,        this, &Vehicle::_mavlinkMessageReceived);
+    _subscribeMavlinkMessages();
     connect(_mavlink, &MAVLinkProtocol::mavlinkMessageStatus,   this, &Vehicle::_mavlinkMessageStatus);
 
     connect(this, &Vehicle::flightModeChanged,          this, &Vehicle::_handleFlightModeChanged);
@@ -180,6 +190,12 @@ Vehicle::Vehicle(LinkInterface*             link,
 
     _vehicleLinkManager->_addLink(link);
 
+    LogReplayLink* logReplayLink = link->isLogReplay() ? qobject_cast<LogReplayLink*>(link) : nullptr;
+    if (logReplayLink) {
+        connect(logReplayLink, &LogReplayLink::factGroupRateLimitChanged, this, &Vehicle::_setFactGroupRateLimit);
+        _setFactGroupRateLimit(logReplayLink->factGroupRateLimitMSecs());
+    }
+
     // Set video stream to udp if running ArduSub and Video is disabled
     if (sub() && _settingsManager->videoSettings()->videoSource()->rawValue() == VideoSettings::videoDisabled) {
         _settingsManager->videoSettings()->videoSource()->setRawValue(VideoSettings::videoSourceUDPH264);
@@ -201,20 +217,16 @@ Vehicle::Vehicle(LinkInterface*             link,
     _autopilotPlugin->setParent(this);
 
     // PreArm Error self-destruct timer
-    connect(&_prearmErrorTimer, &QTimer::timeout, this, &Vehicle::_prearmErrorTimeout);
+    connect(&_prearmErrorTimer, &QGCWheelTimer::timeout, this, &Vehicle::_prearmErrorTimeout);
     _prearmErrorTimer.setInterval(_prearmErrorTimeoutMSecs);
     _prearmErrorTimer.setSingleShot(true);
 
-    // Send MAV_CMD ack timer
-    _mavCommandResponseCheckTimer.setSingleShot(false);
-    _mavCommandResponseCheckTimer.setInterval(_mavCommandResponseCheckTimeoutMSecs);
-    _mavCommandResponseCheckTimer.start();
-    connect(&_mavCommandResponseCheckTimer, &QTimer::timeout, this, &Vehicle::_sendMavCommandResponseTimeoutCheck);
+    // Send MAV_CMD ack timer, set for the earliest ack timeout by _scheduleMavCommandResponseCheck
+    _mavCommandResponseCheckTimer.setSingleShot(true);
+    connect(&_mavCommandResponseCheckTimer, &QGCWheelTimer::timeout, this, &Vehicle::_sendMavCommandResponseTimeoutCheck);
 
-    // Chunked status text timeout timer
-    _chunkedStatusTextTimer.setSingleShot(true);
-    _chunkedStatusTextTimer.setInterval(1000);
-    connect(&_chunkedStatusTextTimer, &QTimer::timeout, this, &Vehicle::_chunkedStatusTextTimeout);
+    // Status texts are reassembled and de-duplicated once for the audio output, prearm error and message list
+    connect(&_statusTextHandler, &StatusTextHandler::statusTextReceived, this, &Vehicle::_statusTextReceived);
 
     _mav = uas();
 
@@ -233,18 +245,20 @@ Vehicle::Vehicle(LinkInterface*             link,
         _firmwarePlugin->adjustMetaData(vehicleType, getFact(factName)->metaData());
     }
 
+    _sendMultipleTimer.setWindow(_sendMessageMultipleIntraMessageDelay);
     _sendMultipleTimer.start(_sendMessageMultipleIntraMessageDelay);
-    connect(&_sendMultipleTimer, &QTimer::timeout, this, &Vehicle::_sendMessageMultipleNext);
+    connect(&_sendMultipleTimer, &QGCWheelTimer::timeout, this, &Vehicle::_sendMessageMultipleNext);
 
-    connect(&_orbitTelemetryTimer, &QTimer::timeout, this, &Vehicle::_orbitTelemetryTimeout);
+    connect(&_orbitTelemetryTimer, &QGCWheelTimer::timeout, this, &Vehicle::_orbitTelemetryTimeout);
 
     // Create camera manager instance
     _cameraManager = _firmwarePlugin->createCameraManager(this);
     emit cameraManagerChanged();
 
-    // Start csv logger
-    connect(&_csvLogTimer, &QTimer::timeout, this, &Vehicle::_writeCsvLine);
-    _csvLogTimer.start(1000);
+    // Start telemetry recorder once the vehicle arms
+    connect(&_telemetryRecorderTimer, &QGCWheelTimer::timeout, this, &Vehicle::_checkTelemetryRecorder);
+    _telemetryRecorderTimer.setWindow(1000);
+    _telemetryRecorderTimer.start(1000);
 }
 
 // Disconnected Vehicle for offline editing
@@ -293,6 +307,9 @@ Vehicle::Vehicle(MAV_AUTOPILOT              firmwareType,
     , _vibrationFactGroup               (this)
     , _clockFactGroup                   (this)
     , _distanceSensorFactGroup          (this)
+    , _escStatusModel                   (this)
+    , _batteryStatusModel               (this)
+    , _statusTextHandler                (this)
 {
     _linkManager = _toolbox->linkManager();
 
@@ -354,6 +371,7 @@ void Vehicle::_commonInit()
     _initialConnectStateMachine     = new InitialConnectStateMachine    (this);
     _ftpManager                     = new FTPManager                    (this);    
     _vehicleLinkManager             = new VehicleLinkManager            (this);
+    _messageRateManager             = new MessageRateManager            (this);
 
     _parameterManager = new ParameterManager(this);
     connect(_parameterManager, &ParameterManager::parametersReadyChanged, this, &Vehicle::_parametersReady);
@@ -421,8 +439,9 @@ void Vehicle::_commonInit()
     _flightDistanceFact.setRawValue(0);
     _flightTimeFact.setRawValue(0);
     _flightTimeUpdater.setInterval(1000);
+    _flightTimeUpdater.setWindow(1000);
     _flightTimeUpdater.setSingleShot(false);
-    connect(&_flightTimeUpdater, &QTimer::timeout, this, &Vehicle::_updateFlightTime);
+    connect(&_flightTimeUpdater, &QGCWheelTimer::timeout, this, &Vehicle::_updateFlightTime);
 
     // Set video stream to udp if running ArduSub and Video is disabled
     if (sub() && _settingsManager->videoSettings()->videoSource()->rawValue() == VideoSettings::videoDisabled) {
@@ -446,6 +465,14 @@ Vehicle::~Vehicle()
 {
     qCDebug(VehicleLog) << "~Vehicle" << this;
 
+    // Stops recording while the facts are still around
+    delete _telemetryRecorder;
+    _telemetryRecorder = nullptr;
+
+    // Ahead of the members it uses, consumers destroyed during teardown would otherwise send commands from here
+    delete _messageRateManager;
+    _messageRateManager = nullptr;
+
     delete _missionManager;
     _missionManager = nullptr;
 
@@ -475,6 +502,121 @@ void Vehicle::prepareDelete()
     }
 }
 
+void Vehicle::_deleteCameraManager()
+{
+    if (_cameraManager) {
+        // Same as prepareDelete, bindings must see the nullptr before the object goes away
+        auto tmpCameras = _cameraManager;
+        _cameraManager = nullptr;
+        emit cameraManagerChanged();
+        tmpCameras->deleteLater();
+    }
+}
+
+void Vehicle::_forEachFactGroup(std::function<void(const QString& name, FactGroup* factGroup)> callback)
+{
+    // Fact groups of the firmware plugin are shared by all its vehicles, so they stay as they are
+    QMap<QString, FactGroup*>* firmwareFactGroups = _firmwarePlugin->factGroups();
+
+    callback(QString(), this);
+    for (auto it = factGroups().constBegin(); it != factGroups().constEnd(); it++) {
+        if (!firmwareFactGroups || firmwareFactGroups->value(it.key()) != it.value()) {
+            callback(it.key(), it.value());
+        }
+    }
+}
+
+void Vehicle::setLightweight(bool lightweight)
+{
+    if (lightweight == _lightweight || _offlineEditingVehicle) {
+        return;
+    }
+
+    qCDebug(VehicleLog) << "setLightweight" << _id << lightweight;
+    _lightweight        = lightweight;
+    _lightweightTicks   = 0;
+
+    _forEachFactGroup([lightweight](const QString& /*name*/, FactGroup* factGroup) {
+        factGroup->setExternalUpdates(lightweight);
+    });
+
+    if (lightweight) {
+        _telemetryRecorderTimer.stop();
+        _mavCommandResponseCheckTimer.stop();
+        _sendMultipleTimer.stop();
+        _flightTimeUpdater.stop();
+
+        // Cameras are found again from their heartbeats once the vehicle is promoted
+        _deleteCameraManager();
+    } else {
+        _telemetryRecorderTimer.start(1000);
+        _scheduleMavCommandResponseCheck();
+        _sendMultipleTimer.start(_sendMessageMultipleIntraMessageDelay);
+        if (_flightTimerActive) {
+            _updateFlightTime();
+            _flightTimeUpdater.start();
+        }
+
+        if (!_cameraManager) {
+            _cameraManager = _firmwarePlugin->createCameraManager(this);
+            emit cameraManagerChanged();
+        }
+    }
+
+    emit lightweightChanged(_lightweight);
+}
+
+void Vehicle::lightweightUpdate(int rateFactor)
+{
+    if (!_lightweight) {
+        return;
+    }
+
+    // Every tick
+    _sendMavCommandResponseTimeoutCheck();
+    _sendMessageMultipleNext();
+
+    if (++_lightweightTicks % _lightweightSecondTicks != 0) {
+        return;
+    }
+
+    // Every second, or every rateFactor seconds while the ui saves power. Groups other than the vehicle itself, gps and
+    // battery only every few of those. The telemetry recorder reads the latest values of the groups itself.
+    if (_lightweightTicks % (_lightweightSecondTicks * rateFactor) == 0) {
+        const bool allGroups = _lightweightTicks % (_lightweightSlowTicks * rateFactor) == 0;
+        _forEachFactGroup([allGroups](const QString& name, FactGroup* factGroup) {
+            // Groups added since the vehicle went lightweight still run their own timer
+            factGroup->setExternalUpdates(true);
+            if (allGroups || name.isEmpty() || name == _gpsFactGroupName || name.startsWith(QStringLiteral("battery"))) {
+                factGroup->publishValues();
+            }
+        });
+    }
+
+    if (_flightTimerActive) {
+        _updateFlightTime();
+    }
+    _checkTelemetryRecorder();
+}
+
+void Vehicle::_setFactGroupRateLimit(int updateRateMSecs)
+{
+    qCDebug(VehicleLog) << "_setFactGroupRateLimit" << _id << updateRateMSecs;
+
+    _forEachFactGroup([this, updateRateMSecs](const QString& /*name*/, FactGroup* factGroup) {
+        if (!_factGroupOriginalRates.contains(factGroup)) {
+            _factGroupOriginalRates[factGroup] = factGroup->updateRateMSecs();
+        }
+        const int originalRateMSecs = _factGroupOriginalRates[factGroup];
+        // An original rate of 0 means live updates, which also get limited
+        factGroup->setUpdateRateMSecs(updateRateMSecs ? qMax(originalRateMSecs, updateRateMSecs) : originalRateMSecs);
+    });
+
+    if (!updateRateMSecs) {
+        _factGroupOriginalRates.clear();
+    }
+}
+
 void Vehicle::_offlineFirmwareTypeSettingChanged(QVariant varFirmwareType)
 {
     _firmwareType = static_cast<MAV_AUTOPILOT>(varFirmwareType.toInt());
@@ -545,8 +687,28 @@ void Vehicle::resetCounters()
     _heardFrom          = false;
 }
 
-void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message)
+/// Only messages from this vehicle, broadcasts and RADIO_STATUS (which may come from a radio on one of our links)
+/// are delivered to us, traffic for other vehicles never reaches this object.
+void Vehicle::_subscribeMavlinkMessages(void)
 {
+    MAVLinkMessageDispatcher* dispatcher = _mavlink->messageDispatcher();
+    auto handler = [this](LinkInterface* link, const mavlink_message_t& message) { _mavlinkMessageReceived(link, message); };
+
+    dispatcher->subscribe(MAVLinkMessageDispatcher::AnyMessage, _id, MAVLinkMessageDispatcher::AnyComponent, this, handler);
+    dispatcher->subscribe(MAVLinkMessageDispatcher::AnyMessage, 0,   MAVLinkMessageDispatcher::AnyComponent, this, handler);
+    dispatcher->subscribe(MAVLINK_MSG_ID_RADIO_STATUS, MAVLinkMessageDispatcher::AnySystem, MAVLinkMessageDispatcher::AnyComponent, this,
+                          [this](LinkInterface* link, const mavlink_message_t& message) {
+        // Messages from us or broadcasts were already delivered by the subscriptions above
+        if (message.sysid != _id && message.sysid != 0) {
+            _mavlinkMessageReceived(link, message);
+        }
+    });
+}
+
+void Vehicle::_mavlinkMessageReceived(LinkInterface* link, const mavlink_message_t& receivedMessage)
+{
+    QGC_TRACE_SCOPE_ARG("Vehicle", "mavlinkMessageReceived", "msgid", receivedMessage.msgid);
+
     // If the link is already running at Mavlink V2 set our max proto version to it.
     unsigned mavlinkVersion = _mavlink->getCurrentVersion();
     if (_maxProtoVersion != mavlinkVersion && mavlinkVersion >= 200) {
@@ -554,28 +716,31 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
         qCDebug(VehicleLog) << "Vehicle::_mavlinkMessageReceived Link already running Mavlink v2. Setting _maxProtoVersion" << _maxProtoVersion;
     }
 
-    if (message.sysid != _id && message.sysid != 0) {
+    if (receivedMessage.sysid != _id && receivedMessage.sysid != 0) {
         // We allow RADIO_STATUS messages which come from a link the vehicle is using to pass through and be handled
-        if (!(message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _vehicleLinkManager->containsLink(link))) {
+        if (!(receivedMessage.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _vehicleLinkManager->containsLink(link))) {
             return;
         }
     }
 
-    // We give the link manager first whack since it it reponsible for adding new links
-    _vehicleLinkManager->mavlinkMessageReceived(link, message);
+    // We give the link manager first whack since it it reponsible for adding new links. It also drops the copies of
+    // a message which arrive over more than one link.
+    if (!_vehicleLinkManager->mavlinkMessageReceived(link, receivedMessage)) {
+        return;
+    }
 
     //-- Check link status
     _messagesReceived++;
     emit messagesReceivedChanged();
     if(!_heardFrom) {
-        if(message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        if(receivedMessage.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
             _heardFrom  = true;
-            _compID     = message.compid;
-            _messageSeq = message.seq + 1;
+            _compID     = receivedMessage.compid;
+            _messageSeq = receivedMessage.seq + 1;
         }
     } else {
-        if(_compID == message.compid) {
-            uint16_t seq_received = static_cast<uint16_t>(message.seq);
+        if(_compID == receivedMessage.compid) {
+            uint16_t seq_received = static_cast<uint16_t>(receivedMessage.seq);
             uint16_t packet_lost_count = 0;
             //-- Account for overflow during packet loss
             if(seq_received < _messageSeq) {
@@ -583,13 +748,16 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
             } else {
                 packet_lost_count = seq_received - _messageSeq;
             }
-            _messageSeq = message.seq + 1;
+            _messageSeq = receivedMessage.seq + 1;
             _messagesLost += packet_lost_count;
             if(packet_lost_count)
                 emit messagesLostChanged();
         }
     }
 
+    // The only copy on the way in, the firmware plugin adjusts it in place. Everything else takes it by reference.
+    mavlink_message_t message = receivedMessage;
+
     // Give the plugin a change to adjust the message contents
     if (!_firmwarePlugin->adjustIncomingMavlinkMessage(this, &message)) {
         return;
@@ -611,6 +779,10 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
     // Battery fact groups are created dynamically as new batteries are discovered
     VehicleBatteryFactGroup::handleMessageForFactGroupCreation(this, message);
 
+    // All ESCs and batteries as table models, with one change signal per message
+    _escStatusModel.handleMessage(message);
+    _batteryStatusModel.handleMessage(message);
+
     // Let the fact groups take a whack at the mavlink traffic
     for (FactGroup* factGroup : factGroups()) {
         factGroup->handleMessage(this, message);
@@ -690,14 +862,11 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
         _handleAttitudeQuaternion(message);
         break;
     case MAVLINK_MSG_ID_STATUSTEXT:
-        _handleStatusText(message);
+        _statusTextHandler.handleMessage(message);
         break;
     case MAVLINK_MSG_ID_ORBIT_EXECUTION_STATUS:
         _handleOrbitExecutionStatus(message);
         break;
-    case MAVLINK_MSG_ID_MESSAGE_INTERVAL:
-        _handleMessageInterval(message);
-        break;
     case MAVLINK_MSG_ID_PING:
         _handlePing(link, message);
         break;
@@ -707,6 +876,11 @@ void Vehicle::_mavlinkMessageReceived(LinkInterface* link, mavlink_message_t mes
     case MAVLINK_MSG_ID_OBSTACLE_DISTANCE:
         _handleObstacleDistance(message);
         break;
+#if defined(MAVLINK_MSG_ID_OBSTACLE_DISTANCE_3D)
+    case MAVLINK_MSG_ID_OBSTACLE_DISTANCE_3D:
+        _handleObstacleDistance3D(message);
+        break;
+#endif
 
     case MAVLINK_MSG_ID_SERIAL_CONTROL:
     {
@@ -793,123 +967,26 @@ void Vehicle::_handleCameraImageCaptured(const mavlink_message_t& message)
     }
 }
 
-void Vehicle::_chunkedStatusTextTimeout(void)
+void Vehicle::_statusTextReceived(const StatusTextHandler::StatusText_t& statusText)
 {
-    // Spit out all incomplete chunks
-    QList<uint8_t> rgCompId = _chunkedStatusTextInfoMap.keys();
-    for (uint8_t compId : rgCompId) {
-        _chunkedStatusTextInfoMap[compId].rgMessageChunks.append(QString());
-        _chunkedStatusTextCompleted(compId);
+    if (statusText.prearm && statusText.announce) {
+        setPrearmError(statusText.text);
     }
-}
 
-void Vehicle::_chunkedStatusTextCompleted(uint8_t compId)
-{
-    ChunkedStatusTextInfo_t&    chunkedInfo =   _chunkedStatusTextInfoMap[compId];
-    uint8_t                     severity =      chunkedInfo.severity;
-    QStringList&                rgChunks =      chunkedInfo.rgMessageChunks;
-
-    // Build up message from chunks
-    QString messageText;
-    for (const QString& chunk : rgChunks) {
-        if (chunk.isEmpty()) {
-            // Indicates missing chunk
-            messageText += tr(" ... ", "Indicates missing chunk from chunked STATUS_TEXT");
-        } else {
-            messageText += chunk;
+    if (statusText.speak) {
+        AudioOutputQueue::Priority priority = AudioOutputQueue::PriorityNormal;
+        if (statusText.severity <= MAV_SEVERITY_CRITICAL) {
+            priority = AudioOutputQueue::PriorityCritical;
+        } else if (statusText.severity <= MAV_SEVERITY_WARNING) {
+            priority = AudioOutputQueue::PriorityHigh;
         }
+        // No message class, texts which differ are all spoken
+        qgcApp()->toolbox()->audioOutput()->say(statusText.text, id(), QString(), priority);
     }
 
-    _chunkedStatusTextInfoMap.remove(compId);
-
-    bool skipSpoken = false;
-    bool ardupilotPrearm = messageText.startsWith(QStringLiteral("PreArm"));
-    bool px4Prearm = messageText.startsWith(QStringLiteral("preflight"), Qt::CaseInsensitive) && severity >= MAV_SEVERITY_CRITICAL;
-    if (ardupilotPrearm || px4Prearm) {
-        // Limit repeated PreArm message to once every 10 seconds
-        if (_noisySpokenPrearmMap.contains(messageText) && _noisySpokenPrearmMap[messageText].msecsTo(QTime::currentTime()) < (10 * 1000)) {
-            skipSpoken = true;
-        } else {
-            _noisySpokenPrearmMap[messageText] = QTime::currentTime();
-            setPrearmError(messageText);
-        }
-    }
-
-    // If the message is NOTIFY or higher severity, or starts with a '#',
-    // then read it aloud.
-    bool readAloud = false;
-
-    if (messageText.startsWith("#")) {
-        messageText.remove(0, 1);
-        readAloud = true;
-    }
-    else if (severity <= MAV_SEVERITY_NOTICE) {
-        readAloud = true;
-    }
-
-    if (readAloud) {
-        if (!skipSpoken) {
-            qgcApp()->toolbox()->audioOutput()->say(messageText);
-        }
-    }
-    emit textMessageReceived(id(), compId, severity, messageText);
-}
-
-void Vehicle::_handleStatusText(mavlink_message_t& message)
-{
-    QByteArray  b;
-    QString     messageText;
-
-    mavlink_statustext_t statustext;
-    mavlink_msg_statustext_decode(&message, &statustext);
-
-    uint8_t compId = message.compid;
-
-    b.resize(MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN+1);
-    strncpy(b.data(), statustext.text, MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN);
-    b[b.length()-1] = '\0';
-    messageText = QString(b);
-    bool includesNullTerminator = messageText.length() < MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN;
-
-    if (_chunkedStatusTextInfoMap.contains(compId) && _chunkedStatusTextInfoMap[compId].chunkId != statustext.id) {
-        // We have an incomplete chunked status still pending
-        _chunkedStatusTextInfoMap[compId].rgMessageChunks.append(QString());
-        _chunkedStatusTextCompleted(compId);
-    }
-
-    if (statustext.id == 0) {
-        // Non-chunked status text. We still use common chunked text output mechanism.
-        ChunkedStatusTextInfo_t chunkedInfo;
-        chunkedInfo.chunkId = 0;
-        chunkedInfo.severity = statustext.severity;
-        chunkedInfo.rgMessageChunks.append(messageText);
-        _chunkedStatusTextInfoMap[compId] = chunkedInfo;
-    } else {
-        if (_chunkedStatusTextInfoMap.contains(compId)) {
-            // A chunk sequence is in progress
-            QStringList& chunks = _chunkedStatusTextInfoMap[compId].rgMessageChunks;
-            if (statustext.chunk_seq > chunks.size()) {
-                // We are missing some chunks in between, fill them in as missing
-                for (int i=chunks.size(); i<statustext.chunk_seq; i++) {
-                    chunks.append(QString());
-                }
-            }
-            chunks.append(messageText);
-        } else {
-            // Starting a new chunk sequence
-            ChunkedStatusTextInfo_t chunkedInfo;
-            chunkedInfo.chunkId = statustext.id;
-            chunkedInfo.severity = statustext.severity;
-            chunkedInfo.rgMessageChunks.append(messageText);
-            _chunkedStatusTextInfoMap[compId] = chunkedInfo;
-        }
-        _chunkedStatusTextTimer.start();
-    }
-
-    if (statustext.id == 0 || includesNullTerminator) {
-        _chunkedStatusTextTimer.stop();
-        _chunkedStatusTextCompleted(message.compid);
-    }
+    emit statusTextReceived(statusText);
+    // Calibration and setup controllers parse every text, repeats included
+    emit textMessageReceived(id(), statusText.compId, statusText.severity, statusText.text);
 }
 
 void Vehicle::_handleVfrHud(mavlink_message_t& message)
@@ -959,9 +1036,10 @@ void Vehicle::_handleAttitudeWorker(double rollRadians, double pitchRadians, dou
     // truncate to integer so widget never displays 360
     yaw = trunc(yaw);
 
-    _rollFact.setRawValue(roll);
-    _pitchFact.setRawValue(pitch);
-    _headingFact.setRawValue(yaw);
+    // Attitude can arrive at 50Hz or more, the display only needs it once per update tick
+    _setFactValue(&_rollFact,    roll);
+    _setFactValue(&_pitchFact,   pitch);
+    _setFactValue(&_headingFact, yaw);
 }
 
 void Vehicle::_handleAttitude(mavlink_message_t& message)
@@ -999,9 +1077,9 @@ void Vehicle::_handleAttitudeQuaternion(mavlink_message_t& message)
 
     _handleAttitudeWorker(roll, pitch, yaw);
 
-    rollRate()->setRawValue(qRadiansToDegrees(rates[0]));
-    pitchRate()->setRawValue(qRadiansToDegrees(rates[1]));
-    yawRate()->setRawValue(qRadiansToDegrees(rates[2]));
+    _setFactValue(rollRate(),  qRadiansToDegrees(rates[0]));
+    _setFactValue(pitchRate(), qRadiansToDegrees(rates[1]));
+    _setFactValue(yawRate(),   qRadiansToDegrees(rates[2]));
 }
 
 void Vehicle::_handleGpsRawInt(mavlink_message_t& message)
@@ -1376,8 +1454,7 @@ void Vehicle::_handleBatteryStatus(mavlink_message_t& message)
         } else {
             batteryIdStr = batteryIdStr.arg("");
         }
-        _say(tr("warning"));
-        _say(QStringLiteral("%1 %2 ").arg(_vehicleIdSpeech()).arg(batteryMessage.arg(batteryIdStr)));
+        _say(QStringLiteral("%1, %2 %3 ").arg(tr("warning")).arg(_vehicleIdSpeech()).arg(batteryMessage.arg(batteryIdStr)), QStringLiteral("battery%1").arg(batteryStatus.id), AudioOutputQueue::PriorityHigh);
     }
 }
 
@@ -1417,10 +1494,11 @@ void Vehicle::_updateArmed(bool armed)
             _trajectoryPoints->stop();
             _flightTimerStop();
             // Also handle Video Streaming
-            if(qgcApp()->toolbox()->videoManager()->videoReceiver()) {
+            VideoManager* videoManager = qgcApp()->toolbox()->videoManager();
+            if(videoManager && videoManager->videoReceiver()) {
                 if(_settingsManager->videoSettings()->disableWhenDisarmed()->rawValue().toBool()) {
                     _settingsManager->videoSettings()->streamEnabled()->setRawValue(false);
-                    qgcApp()->toolbox()->videoManager()->videoReceiver()->stop();
+                    videoManager->videoReceiver()->stop();
                 }
             }
         }
@@ -1496,6 +1574,7 @@ void Vehicle::_handleRadioStatus(mavlink_message_t& message)
     //-- Process telemetry status message
     mavlink_radio_status_t rstatus;
     mavlink_msg_radio_status_decode(&message, &rstatus);
+    _telemetryRadioStatusReceived = true;
 
     int rssi    = rstatus.rssi;
     int remrssi = rstatus.remrssi;
@@ -1697,9 +1776,10 @@ bool Vehicle::xConfigMotors()
 
 QString Vehicle::formattedMessages()
 {
-    QString messages;
-    for(UASMessage* message: _toolbox->uasMessageHandler()->messages()) {
-        messages += message->getFormatedText();
+    QString             messages;
+    UASMessageModel*    messageModel = _toolbox->uasMessageHandler()->messages();
+    for(int i = 0; i < messageModel->count(); i++) {
+        messages += messageModel->at(i).getFormatedText();
     }
     return messages;
 }
@@ -1709,9 +1789,15 @@ void Vehicle::clearMessages()
     _toolbox->uasMessageHandler()->clearMessages();
 }
 
+UASMessageModel* Vehicle::messageModel()
+{
+    return _toolbox->uasMessageHandler()->messages();
+}
+
 void Vehicle::_handletextMessageReceived(UASMessage* message)
 {
-    if (message) {
+    // Formatting is only paid for when someone listens
+    if (message && isSignalConnected(QMetaMethod::fromSignal(&Vehicle::newFormattedMessage))) {
         emit newFormattedMessage(message->getFormatedText());
     }
 }
@@ -2023,13 +2109,17 @@ void Vehicle::_clearCameraTriggerPoints()
 void Vehicle::_flightTimerStart()
 {
     _flightTimer.start();
-    _flightTimeUpdater.start();
+    _flightTimerActive = true;
+    if (!_lightweight) {
+        _flightTimeUpdater.start();
+    }
     _flightDistanceFact.setRawValue(0);
     _flightTimeFact.setRawValue(0);
 }
 
 void Vehicle::_flightTimerStop()
 {
+    _flightTimerActive = false;
     _flightTimeUpdater.stop();
 }
 
@@ -2041,21 +2131,19 @@ void Vehicle::_updateFlightTime()
 void Vehicle::_firstMissionLoadComplete()
 {
     disconnect(_missionManager, &MissionManager::newMissionItemsAvailable, this, &Vehicle::_firstMissionLoadComplete);
-    _initialConnectStateMachine->advance();
+    _initialConnectStateMachine->stageComplete(InitialConnectStateMachine::StageMission);
 }
 
 void Vehicle::_firstGeoFenceLoadComplete()
 {
     disconnect(_geoFenceManager, &GeoFenceManager::loadComplete, this, &Vehicle::_firstGeoFenceLoadComplete);
-    _initialConnectStateMachine->advance();
+    _initialConnectStateMachine->stageComplete(InitialConnectStateMachine::StageGeoFence);
 }
 
 void Vehicle::_firstRallyPointLoadComplete()
 {
     disconnect(_rallyPointManager, &RallyPointManager::loadComplete, this, &Vehicle::_firstRallyPointLoadComplete);
-    _initialPlanRequestComplete = true;
-    emit initialPlanRequestCompleteChanged(true);
-    _initialConnectStateMachine->advance();
+    _initialConnectStateMachine->stageComplete(InitialConnectStateMachine::StageRallyPoints);
 }
 
 void Vehicle::_parametersReady(bool parametersReady)
@@ -2069,7 +2157,7 @@ void Vehicle::_parametersReady(bool parametersReady)
     if (parametersReady) {
         disconnect(_parameterManager, &ParameterManager::parametersReadyChanged, this, &Vehicle::_parametersReady);
         _setupAutoDisarmSignalling();
-        _initialConnectStateMachine->advance();
+        _initialConnectStateMachine->stageComplete(InitialConnectStateMachine::StageParameters);
     }
 }
 
@@ -2098,7 +2186,7 @@ void Vehicle::_sendQGCTimeToVehicle()
 
 void Vehicle::_imageReady(UASInterface*)
 {
-    if(_uas)
+    if(_uas && _toolbox->imageProvider())
     {
         QImage img = _uas->getImage();
         _toolbox->imageProvider()->setImage(&img, _id);
@@ -2146,9 +2234,9 @@ void Vehicle::virtualTabletJoystickValue(double roll, double pitch, double yaw,
     }
 }
 
-void Vehicle::_say(const QString& text)
+void Vehicle::_say(const QString& text, const QString& messageClass, AudioOutputQueue::Priority priority)
 {
-    _toolbox->audioOutput()->say(text.toLower());
+    _toolbox->audioOutput()->say(text.toLower(), id(), messageClass, priority);
 }
 
 bool Vehicle::airship() const
@@ -2257,13 +2345,13 @@ QString Vehicle::_vehicleIdSpeech()
 
 void Vehicle::_handleFlightModeChanged(const QString& flightMode)
 {
-    _say(tr("%1 %2 flight mode").arg(_vehicleIdSpeech()).arg(flightMode));
+    _say(tr("%1 %2 flight mode").arg(_vehicleIdSpeech()).arg(flightMode), QStringLiteral("flightMode"));
     emit guidedModeChanged(_firmwarePlugin->isGuidedMode(this));
 }
 
 void Vehicle::_announceArmedChanged(bool armed)
 {
-    _say(QString("%1 %2").arg(_vehicleIdSpeech()).arg(armed ? tr("armed") : tr("disarmed")));
+    _say(QString("%1 %2").arg(_vehicleIdSpeech()).arg(armed ? tr("armed") : tr("disarmed")), QStringLiteral("armed"), AudioOutputQueue::PriorityHigh);
     if(armed) {
         //-- Keep track of armed coordinates
         _armedPosition = _coordinate;
@@ -2594,16 +2682,52 @@ void Vehicle::sendMavCommandInt(int compId, MAV_CMD command, MAV_FRAME frame, bo
                           param1, param2, param3, param4, param5, param6, param7);
 }
 
-int Vehicle::_findMavCommandListEntryIndex(int targetCompId, MAV_CMD command)
+int Vehicle::_mavCommandTimeoutMSecs(const MavCommandListEntry_t& commandEntry) const
 {
-    for (int i=0; i<_mavCommandList.count(); i++) {
-        const MavCommandListEntry_t& entry = _mavCommandList[i];
-        if (entry.targetCompId == targetCompId && entry.command == command) {
-            return i;
-        }
+    auto rtt = _mavCommandRttMap.constFind(commandEntry.targetCompId);
+
+    if (rtt == _mavCommandRttMap.constEnd()) {
+        // Nothing measured yet. The first send waits long and the retries follow quickly.
+        return commandEntry.tryCount > 1 ? _mavCommandResponseCheckTimeoutMSecs : commandEntry.ackTimeoutMSecs;
+    }
+
+    // Retransmission timeout from the round trip estimate, doubled with each retry
+    const double    ackTimeout  = commandEntry.ackTimeoutMSecs;
+    const double    timeout     = qBound(static_cast<double>(_mavCommandMinAckTimeoutMSecs), rtt->srttMSecs + 4 * rtt->rttVarMSecs, ackTimeout);
+    return static_cast<int>(qMin(timeout * (1 << qBound(0, commandEntry.tryCount - 1, 8)), ackTimeout));
+}
+
+void Vehicle::_mavCommandRttSample(int compId, qint64 rttMSecs)
+{
+    auto rtt = _mavCommandRttMap.find(compId);
+
+    if (rtt == _mavCommandRttMap.end()) {
+        MavCommandRtt_t firstRtt;
+        firstRtt.srttMSecs      = rttMSecs;
+        firstRtt.rttVarMSecs    = rttMSecs / 2.0;
+        _mavCommandRttMap.insert(compId, firstRtt);
+    } else {
+        rtt->rttVarMSecs    = 0.75 * rtt->rttVarMSecs + 0.25 * qAbs(rtt->srttMSecs - rttMSecs);
+        rtt->srttMSecs      = 0.875 * rtt->srttMSecs + 0.125 * rttMSecs;
+    }
+}
+
+void Vehicle::_scheduleMavCommandResponseCheck(void)
+{
+    if (_mavCommandMap.isEmpty()) {
+        _mavCommandResponseCheckTimer.stop();
+        return;
+    }
+    if (_lightweight) {
+        // lightweightUpdate checks on its own tick
+        return;
     }
 
-    return -1;
+    qint64 nextMSecs = std::numeric_limits<qint64>::max();
+    for (const MavCommandListEntry_t& commandEntry: _mavCommandMap) {
+        nextMSecs = qMin(nextMSecs, commandEntry.sentMSecs + commandEntry.timeoutMSecs - commandEntry.elapsedTimer.elapsed());
+    }
+    _mavCommandResponseCheckTimer.start(static_cast<int>(qMax(static_cast<qint64>(0), nextMSecs)));
 }
 
 bool Vehicle::_sendMavCommandShouldRetry(MAV_CMD command)
@@ -2639,8 +2763,7 @@ bool Vehicle::_sendMavCommandShouldRetry(MAV_CMD command)
 
 void Vehicle::_sendMavCommandWorker(bool commandInt, bool requestMessage, bool showError, MavCmdResultHandler resultHandler, void* resultHandlerData, int targetCompId, MAV_CMD command, MAV_FRAME frame, float param1, float param2, float param3, float param4, float param5, float param6, float param7)
 {
-    int entryIndex = _findMavCommandListEntryIndex(targetCompId, command);
-    if (entryIndex != -1 || targetCompId == MAV_COMP_ID_ALL) {
+    if (targetCompId == MAV_COMP_ID_ALL || _mavCommandInFlight(targetCompId, command)) {
         bool    compIdAll       = targetCompId == MAV_COMP_ID_ALL;
         QString rawCommandName  = _toolbox->missionCommandTree()->rawName(command);
 
@@ -2685,29 +2808,49 @@ void Vehicle::_sendMavCommandWorker(bool commandInt, bool requestMessage, bool s
         entry.ackTimeoutMSecs   = sharedLink->linkConfiguration()->isHighLatency() ? _mavCommandAckTimeoutMSecsHighLatency : _mavCommandAckTimeoutMSecs;
         entry.elapsedTimer.start();
 
-        _mavCommandList.append(entry);
-        _sendMavCommandFromList(_mavCommandList.last());
+        const quint32 key = _mavCommandKey(targetCompId, command);
+        _mavCommandMap.insert(key, entry);
+        _mavCommandStatsMap[command].sendCount++;
+        _sendMavCommandFromList(key);
     }
 }
 
-void Vehicle::_sendMavCommandFromList(MavCommandListEntry_t& commandEntry)
+void Vehicle::_sendMavCommandFromList(quint32 key)
 {
-    QString rawCommandName  = _toolbox->missionCommandTree()->rawName(commandEntry.command);
+    auto entryIt = _mavCommandMap.find(key);
+    if (entryIt == _mavCommandMap.end()) {
+        return;
+    }
+
+    MavCommandListEntry_t&  commandEntry    = entryIt.value();
+    QString                 rawCommandName  = _toolbox->missionCommandTree()->rawName(commandEntry.command);
 
     if (++commandEntry.tryCount > commandEntry.maxTries) {
         qCDebug(VehicleLog) << "_sendMavCommandFromList giving up after max retries" << rawCommandName;
-        if (commandEntry.resultHandler) {
-            (*commandEntry.resultHandler)(commandEntry.resultHandlerData, commandEntry.targetCompId, MAV_RESULT_FAILED, MavCmdResultFailureNoResponseToCommand);
+
+        // Out of the map before the result goes out, the handler may well send the command again
+        const MavCommandListEntry_t failedEntry = _mavCommandMap.take(key);
+        _mavCommandStatsMap[failedEntry.command].noResponseCount++;
+        _scheduleMavCommandResponseCheck();
+
+        if (failedEntry.resultHandler) {
+            (*failedEntry.resultHandler)(failedEntry.resultHandlerData, failedEntry.targetCompId, MAV_RESULT_FAILED, MavCmdResultFailureNoResponseToCommand);
         } else {
-            emit mavCommandResult(_id, commandEntry.targetCompId, commandEntry.command, MAV_RESULT_FAILED, MavCmdResultFailureNoResponseToCommand);
+            emit mavCommandResult(_id, failedEntry.targetCompId, failedEntry.command, MAV_RESULT_FAILED, MavCmdResultFailureNoResponseToCommand);
         }
-        if (commandEntry.showError) {
+        if (failedEntry.showError) {
             qgcApp()->showAppMessage(tr("Vehicle did not respond to command: %1").arg(rawCommandName));
         }
-        _mavCommandList.removeAt(_findMavCommandListEntryIndex(commandEntry.targetCompId, commandEntry.command));
         return;
     }
 
+    if (commandEntry.tryCount > 1) {
+        _mavCommandStatsMap[commandEntry.command].retryCount++;
+    }
+    commandEntry.sentMSecs      = commandEntry.elapsedTimer.elapsed();
+    commandEntry.timeoutMSecs   = _mavCommandTimeoutMSecs(commandEntry);
+    _scheduleMavCommandResponseCheck();
+
     if (commandEntry.tryCount > 1 && !px4Firmware() && commandEntry.command == MAV_CMD_START_RX_PAIR) {
         // The implementation of this command comes from the IO layer and is shared across stacks. So for other firmwares
         // we aren't really sure whether they are correct or not.
@@ -2719,7 +2862,7 @@ void Vehicle::_sendMavCommandFromList(MavCommandListEntry_t& commandEntry)
         _waitForMavlinkMessage(_requestMessageWaitForMessageResultHandler, pInfo, pInfo->msgId, 1000);
     }
 
-    qCDebug(VehicleLog) << "_sendMavCommandFromList command:tryCount" << rawCommandName << commandEntry.tryCount;
+    qCDebug(VehicleLog) << "_sendMavCommandFromList command:tryCount:timeout" << rawCommandName << commandEntry.tryCount << commandEntry.timeoutMSecs;
 
     WeakLinkInterfacePtr weakLink = vehicleLinkManager()->primaryLink();
 
@@ -2727,66 +2870,88 @@ void Vehicle::_sendMavCommandFromList(MavCommandListEntry_t& commandEntry)
         mavlink_message_t       msg;
         SharedLinkInterfacePtr  sharedLink = weakLink.lock();
 
-        if (commandEntry.useCommandInt) {
-            mavlink_command_int_t  cmd;
-
-            memset(&cmd, 0, sizeof(cmd));
-            cmd.target_system =     _id;
-            cmd.target_component =  commandEntry.targetCompId;
-            cmd.command =           commandEntry.command;
-            cmd.frame =             commandEntry.frame;
-            cmd.param1 =            commandEntry.rgParam[0];
-            cmd.param2 =            commandEntry.rgParam[1];
-            cmd.param3 =            commandEntry.rgParam[2];
-            cmd.param4 =            commandEntry.rgParam[3];
-            cmd.x =                 commandEntry.frame == MAV_FRAME_MISSION ? commandEntry.rgParam[4] : commandEntry.rgParam[4] * 1e7;
-            cmd.y =                 commandEntry.frame == MAV_FRAME_MISSION ? commandEntry.rgParam[5] : commandEntry.rgParam[5] * 1e7;
-            cmd.z =                 commandEntry.rgParam[6];
-            mavlink_msg_command_int_encode_chan(_mavlink->getSystemId(),
-                                                _mavlink->getComponentId(),
-                                                sharedLink->mavlinkChannel(),
-                                                &msg,
-                                                &cmd);
-        } else {
-            mavlink_command_long_t  cmd;
-
-            memset(&cmd, 0, sizeof(cmd));
-            cmd.target_system =     _id;
-            cmd.target_component =  commandEntry.targetCompId;
-            cmd.command =           commandEntry.command;
-            cmd.confirmation =      0;
-            cmd.param1 =            commandEntry.rgParam[0];
-            cmd.param2 =            commandEntry.rgParam[1];
-            cmd.param3 =            commandEntry.rgParam[2];
-            cmd.param4 =            commandEntry.rgParam[3];
-            cmd.param5 =            commandEntry.rgParam[4];
-            cmd.param6 =            commandEntry.rgParam[5];
-            cmd.param7 =            commandEntry.rgParam[6];
-            mavlink_msg_command_long_encode_chan(_mavlink->getSystemId(),
-                                                 _mavlink->getComponentId(),
-                                                 sharedLink->mavlinkChannel(),
-                                                 &msg,
-                                                 &cmd);
-        }
+        // Encoded for each link since the sequence number comes from the channel of the link
+        auto encodeCommand = [this, &commandEntry, &msg](LinkInterface* link) {
+            if (commandEntry.useCommandInt) {
+                mavlink_command_int_t  cmd;
+
+                memset(&cmd, 0, sizeof(cmd));
+                cmd.target_system =     _id;
+                cmd.target_component =  commandEntry.targetCompId;
+                cmd.command =           commandEntry.command;
+                cmd.frame =             commandEntry.frame;
+                cmd.param1 =            commandEntry.rgParam[0];
+                cmd.param2 =            commandEntry.rgParam[1];
+                cmd.param3 =            commandEntry.rgParam[2];
+                cmd.param4 =            commandEntry.rgParam[3];
+                cmd.x =                 commandEntry.frame == MAV_FRAME_MISSION ? commandEntry.rgParam[4] : commandEntry.rgParam[4] * 1e7;
+                cmd.y =                 commandEntry.frame == MAV_FRAME_MISSION ? commandEntry.rgParam[5] : commandEntry.rgParam[5] * 1e7;
+                cmd.z =                 commandEntry.rgParam[6];
+                mavlink_msg_command_int_encode_chan(_mavlink->getSystemId(),
+                                                    _mavlink->getComponentId(),
+                                                    link->mavlinkChannel(),
+                                                    &msg,
+                                                    &cmd);
+            } else {
+                mavlink_command_long_t  cmd;
+
+                memset(&cmd, 0, sizeof(cmd));
+                cmd.target_system =     _id;
+                cmd.target_component =  commandEntry.targetCompId;
+                cmd.command =           commandEntry.command;
+                cmd.confirmation =      0;
+                cmd.param1 =            commandEntry.rgParam[0];
+                cmd.param2 =            commandEntry.rgParam[1];
+                cmd.param3 =            commandEntry.rgParam[2];
+                cmd.param4 =            commandEntry.rgParam[3];
+                cmd.param5 =            commandEntry.rgParam[4];
+                cmd.param6 =            commandEntry.rgParam[5];
+                cmd.param7 =            commandEntry.rgParam[6];
+                mavlink_msg_command_long_encode_chan(_mavlink->getSystemId(),
+                                                     _mavlink->getComponentId(),
+                                                     link->mavlinkChannel(),
+                                                     &msg,
+                                                     &cmd);
+            }
+        };
 
+        encodeCommand(sharedLink.get());
         sendMessageOnLinkThreadSafe(sharedLink.get(), msg);
+
+        // Critical commands also go out over the other links when bonded, so a single failing radio doesn't lose them
+        for (const SharedLinkInterfacePtr& bondedLink: vehicleLinkManager()->bondedCommandLinks(commandEntry.command)) {
+            encodeCommand(bondedLink.get());
+            sendMessageOnLinkThreadSafe(bondedLink.get(), msg);
+        }
     }
 }
 
 void Vehicle::_sendMavCommandResponseTimeoutCheck(void)
 {
-    if (_mavCommandList.isEmpty()) {
+    if (_mavCommandMap.isEmpty()) {
         return;
     }
 
-    // Walk the list backwards since _sendMavCommandFromList can remove entries
-    for (int i=_mavCommandList.count()-1; i>=0; i--) {
-        MavCommandListEntry_t& commandEntry = _mavCommandList[i];
-        if (commandEntry.elapsedTimer.elapsed() > commandEntry.ackTimeoutMSecs) {
+    auto timedOut = [](const MavCommandListEntry_t& commandEntry) {
+        return commandEntry.elapsedTimer.elapsed() - commandEntry.sentMSecs >= commandEntry.timeoutMSecs;
+    };
+
+    // Keys first, since result handlers can send new commands. Those are checked again before the retry.
+    QList<quint32> timedOutKeys;
+    for (auto entryIt = _mavCommandMap.constBegin(); entryIt != _mavCommandMap.constEnd(); entryIt++) {
+        if (timedOut(entryIt.value())) {
+            timedOutKeys.append(entryIt.key());
+        }
+    }
+    for (quint32 key: timedOutKeys) {
+        auto entryIt = _mavCommandMap.constFind(key);
+        if (entryIt != _mavCommandMap.constEnd() && timedOut(entryIt.value())) {
             // Try sending command again
-            _sendMavCommandFromList(commandEntry);
+            _sendMavCommandFromList(key);
         }
     }
+
+    _scheduleMavCommandResponseCheck();
 }
 
 void Vehicle::_handleCommandAck(mavlink_message_t& message)
@@ -2817,77 +2982,74 @@ void Vehicle::_handleCommandAck(mavlink_message_t& message)
     }
 #endif
 
-    int entryIndex = _findMavCommandListEntryIndex(message.compid, static_cast<MAV_CMD>(ack.command));
-    bool commandInList = false;
-    if (entryIndex != -1) {
-        const MavCommandListEntry_t& commandEntry = _mavCommandList[entryIndex];
-        if (commandEntry.command == ack.command) {
-            if (commandEntry.requestMessage) {
-                RequestMessageInfo_t* pInfo = static_cast<RequestMessageInfo_t*>(commandEntry.resultHandlerData);
-                pInfo->commandAckReceived = true;
-                if (ack.result == MAV_RESULT_ACCEPTED) {
-                    if (pInfo->messageReceived) {
-                        delete pInfo;
-                    } else {
-                        _waitForMavlinkMessageTimeoutActive = true;
-                        _waitForMavlinkMessageElapsed.restart();
-                    }
+    const quint32   key             = _mavCommandKey(message.compid, ack.command);
+    bool            commandInList   = _mavCommandMap.contains(key);
+    if (commandInList) {
+        // Out of the map before the result goes out, the handler may well send the command again
+        const MavCommandListEntry_t commandEntry = _mavCommandMap.take(key);
+        _scheduleMavCommandResponseCheck();
+
+        const qint64 latencyMSecs = commandEntry.elapsedTimer.elapsed();
+        if (commandEntry.tryCount == 1) {
+            // After a retry there is no telling which send the ack belongs to, so only the first send gives a round trip sample
+            _mavCommandRttSample(message.compid, latencyMSecs);
+        }
+        MavCommandStats_t& stats = _mavCommandStatsMap[commandEntry.command];
+        stats.minLatencyMSecs   = stats.ackCount == 0 ? latencyMSecs : qMin(stats.minLatencyMSecs, latencyMSecs);
+        stats.maxLatencyMSecs   = qMax(stats.maxLatencyMSecs, latencyMSecs);
+        stats.totalLatencyMSecs += latencyMSecs;
+        stats.ackCount++;
+        qCDebug(VehicleLog) << "_handleCommandAck latency:tryCount" << rawCommandName << latencyMSecs << commandEntry.tryCount;
+
+        if (commandEntry.requestMessage) {
+            RequestMessageInfo_t* pInfo = static_cast<RequestMessageInfo_t*>(commandEntry.resultHandlerData);
+            pInfo->commandAckReceived = true;
+            if (ack.result == MAV_RESULT_ACCEPTED) {
+                if (pInfo->messageReceived) {
+                    delete pInfo;
                 } else {
-                    if (pInfo->messageReceived) {
-                        qCWarning(VehicleLog) << "Internal Error: _handleCommandAck for requestMessage with result failure, but message already received";
-                    } else {
-                        _waitForMavlinkMessageClear();
-                        (*commandEntry.resultHandler)(commandEntry.resultHandlerData, message.compid, static_cast<MAV_RESULT>(ack.result), MavCmdResultCommandResultOnly);
-                    }
+                    _waitForMavlinkMessageTimeoutActive = true;
+                    _waitForMavlinkMessageElapsed.restart();
                 }
             } else {
-                if (commandEntry.resultHandler) {
-                    (*commandEntry.resultHandler)(commandEntry.resultHandlerData, message.compid, static_cast<MAV_RESULT>(ack.result), MavCmdResultCommandResultOnly);
+                if (pInfo->messageReceived) {
+                    qCWarning(VehicleLog) << "Internal Error: _handleCommandAck for requestMessage with result failure, but message already received";
                 } else {
-                    if (commandEntry.showError) {
-                        switch (ack.result) {
-                        case MAV_RESULT_TEMPORARILY_REJECTED:
-                            qgcApp()->showAppMessage(tr("%1 command temporarily rejected").arg(rawCommandName));
-                            break;
-                        case MAV_RESULT_DENIED:
-                            qgcApp()->showAppMessage(tr("%1 command denied").arg(rawCommandName));
-                            break;
-                        case MAV_RESULT_UNSUPPORTED:
-                            qgcApp()->showAppMessage(tr("%1 command not supported").arg(rawCommandName));
-                            break;
-                        case MAV_RESULT_FAILED:
-                            qgcApp()->showAppMessage(tr("%1 command failed").arg(rawCommandName));
-                            break;
-                        default:
-                            // Do nothing
-                            break;
-                        }
+                    _waitForMavlinkMessageClear();
+                    (*commandEntry.resultHandler)(commandEntry.resultHandlerData, message.compid, static_cast<MAV_RESULT>(ack.result), MavCmdResultCommandResultOnly);
+                }
+            }
+        } else {
+            if (commandEntry.resultHandler) {
+                (*commandEntry.resultHandler)(commandEntry.resultHandlerData, message.compid, static_cast<MAV_RESULT>(ack.result), MavCmdResultCommandResultOnly);
+            } else {
+                if (commandEntry.showError) {
+                    switch (ack.result) {
+                    case MAV_RESULT_TEMPORARILY_REJECTED:
+                        qgcApp()->showAppMessage(tr("%1 command temporarily rejected").arg(rawCommandName));
+                        break;
+                    case MAV_RESULT_DENIED:
+                        qgcApp()->showAppMessage(tr("%1 command denied").arg(rawCommandName));
+                        break;
+                    case MAV_RESULT_UNSUPPORTED:
+                        qgcApp()->showAppMessage(tr("%1 command not supported").arg(rawCommandName));
+                        break;
+                    case MAV_RESULT_FAILED:
+                        qgcApp()->showAppMessage(tr("%1 command failed").arg(rawCommandName));
+                        break;
+                    default:
+                        // Do nothing
+                        break;
                     }
-                    emit mavCommandResult(_id, message.compid, ack.command, ack.result, MavCmdResultCommandResultOnly);
                 }
+                emit mavCommandResult(_id, message.compid, ack.command, ack.result, MavCmdResultCommandResultOnly);
             }
-
-            _mavCommandList.removeAt(entryIndex);
-            commandInList = true;
         }
     }
 
     if (!commandInList) {
         qCDebug(VehicleLog) << "_handleCommandAck Ack not in list" << rawCommandName;
     }
-
-    // advance PID tuning setup/teardown
-    if (ack.command == MAV_CMD_SET_MESSAGE_INTERVAL && _pidTuningNextAdjustIndex >= 0) {
-        _pidTuningAdjustRates();
-    }
-    if (ack.command == MAV_CMD_GET_MESSAGE_INTERVAL && _pidTuningWaitingForRates) {
-        if (_pidTuningMessageRatesUsecs.count() < _pidTuningMessages.count()) {
-            sendMavCommand(defaultComponentId(),
-                    MAV_CMD_GET_MESSAGE_INTERVAL,
-                    true,                        // show error
-                    _pidTuningMessages[_pidTuningMessageRatesUsecs.count()]);
-        }
-    }
 }
 
 void Vehicle::_waitForMavlinkMessage(WaitForMavlinkMessageResultHandler resultHandler, void* resultHandlerData, int messageId, int timeoutMsecs)
@@ -3378,33 +3540,11 @@ bool Vehicle::autoDisarm()
 
 void Vehicle::_handleADSBVehicle(const mavlink_message_t& message)
 {
-    mavlink_adsb_vehicle_t adsbVehicleMsg;
-    static const int maxTimeSinceLastSeen = 15;
+    mavlink_adsb_vehicle_t      adsbVehicleMsg;
+    ADSBVehicle::VehicleInfo_t  vehicleInfo;
 
     mavlink_msg_adsb_vehicle_decode(&message, &adsbVehicleMsg);
-    if ((adsbVehicleMsg.flags & ADSB_FLAGS_VALID_COORDS) && adsbVehicleMsg.tslc <= maxTimeSinceLastSeen) {
-        ADSBVehicle::VehicleInfo_t vehicleInfo;
-
-        vehicleInfo.availableFlags = 0;
-        vehicleInfo.icaoAddress = adsbVehicleMsg.ICAO_address;
-
-        vehicleInfo.location.setLatitude(adsbVehicleMsg.lat / 1e7);
-        vehicleInfo.location.setLongitude(adsbVehicleMsg.lon / 1e7);
-        vehicleInfo.availableFlags |= ADSBVehicle::LocationAvailable;
-
-        vehicleInfo.callsign = adsbVehicleMsg.callsign;
-        vehicleInfo.availableFlags |= ADSBVehicle::CallsignAvailable;
-
-        if (adsbVehicleMsg.flags & ADSB_FLAGS_VALID_ALTITUDE) {
-            vehicleInfo.altitude = (double)adsbVehicleMsg.altitude / 1e3;
-            vehicleInfo.availableFlags |= ADSBVehicle::AltitudeAvailable;
-        }
-
-        if (adsbVehicleMsg.flags & ADSB_FLAGS_VALID_HEADING) {
-            vehicleInfo.heading = (double)adsbVehicleMsg.heading / 100.0;
-            vehicleInfo.availableFlags |= ADSBVehicle::HeadingAvailable;
-        }
-
+    if (ADSBParser::parseMavlink(adsbVehicleMsg, vehicleInfo)) {
         _toolbox->adsbVehicleManager()->adsbVehicleUpdate(vehicleInfo);
     }
 }
@@ -3543,136 +3683,51 @@ int  Vehicle::versionCompare(int major, int minor, int patch)
     return _firmwarePlugin->versionCompare(this, major, minor, patch);
 }
 
-void Vehicle::_handleMessageInterval(const mavlink_message_t& message)
-{
-    if (_pidTuningWaitingForRates) {
-        mavlink_message_interval_t messageInterval;
-
-        mavlink_msg_message_interval_decode(&message, &messageInterval);
-
-        int msgId = messageInterval.message_id;
-        if (_pidTuningMessages.contains(msgId)) {
-            _pidTuningMessageRatesUsecs[msgId] = messageInterval.interval_us;
-        }
-
-        if (_pidTuningMessageRatesUsecs.count() == _pidTuningMessages.count()) {
-            // We have back all the rates we requested
-            _pidTuningWaitingForRates = false;
-            _pidTuningNextAdjustIndex = 0;
-            _pidTuningAdjustRates();
-        }
-    }
-}
-
 void Vehicle::setPIDTuningTelemetryMode(bool pidTuning)
 {
-    if (pidTuning) {
-        if (!_pidTuningTelemetryMode) {
-            // First step is to get the current message rates before we adjust them
-            _pidTuningTelemetryMode = true;
-            _pidTuningWaitingForRates = true;
-            _pidTuningMessageRatesUsecs.clear();
-            sendMavCommand(defaultComponentId(),
-                    MAV_CMD_GET_MESSAGE_INTERVAL,
-                    true,                        // show error
-                    _pidTuningMessages[0]);
-        }
-    } else {
-        if (_pidTuningTelemetryMode) {
-            _pidTuningTelemetryMode = false;
-            if (_pidTuningWaitingForRates) {
-                // We never finished waiting for previous rates
-                _pidTuningWaitingForRates = false;
-            } else {
-                _pidTuningNextAdjustIndex = 0;
-                _pidTuningAdjustRates();
-            }
-        }
-    }
-}
-
-void Vehicle::_pidTuningAdjustRates()
-{
-    int requestedRate = (int)(1000000.0 / 100.0); // 100 Hz in usecs (better set this a bit higher than actually needed,
-    // to give it more priority in case of exceeing link bandwidth)
-
-    if (_pidTuningNextAdjustIndex >= _pidTuningMessages.size()) {
-        _pidTuningNextAdjustIndex = -1;
-        return;
-    }
-    int telemetry = _pidTuningMessages[_pidTuningNextAdjustIndex];
-
-    if (requestedRate < _pidTuningMessageRatesUsecs[telemetry] || _pidTuningMessageRatesUsecs[telemetry] == 0) {
-        sendMavCommand(defaultComponentId(),
-                MAV_CMD_SET_MESSAGE_INTERVAL,
-                true,                        // show error
-                telemetry,
-                _pidTuningTelemetryMode ? requestedRate : _pidTuningMessageRatesUsecs[telemetry]);
-    }
-
-    if (_pidTuningNextAdjustIndex == 0) {
-        setLiveUpdates(_pidTuningTelemetryMode);
-        _setpointFactGroup.setLiveUpdates(_pidTuningTelemetryMode);
-    }
-    ++_pidTuningNextAdjustIndex;
-}
-
-void Vehicle::_initializeCsv()
-{
-    if(!_toolbox->settingsManager()->appSettings()->saveCsvTelemetry()->rawValue().toBool()){
+    if (pidTuning == _pidTuningTelemetryMode) {
         return;
     }
-    QString now = QDateTime::currentDateTime().toString("yyyy-MM-dd hh-mm-ss");
-    QString fileName = QString("%1 vehicle%2.csv").arg(now).arg(_id);
-    QDir saveDir(_toolbox->settingsManager()->appSettings()->telemetrySavePath());
-    _csvLogFile.setFileName(saveDir.absoluteFilePath(fileName));
+    _pidTuningTelemetryMode = pidTuning;
 
-    if (!_csvLogFile.open(QIODevice::Append)) {
-        qCWarning(VehicleLog) << "unable to open file for csv logging, Stopping csv logging!";
-        return;
-    }
-
-    QTextStream stream(&_csvLogFile);
-    QStringList allFactNames;
-    allFactNames << factNames();
-    for (const QString& groupName: factGroupNames()) {
-        for(const QString& factName: getFactGroup(groupName)->factNames()){
-            allFactNames << QString("%1.%2").arg(groupName, factName);
+    // Asking a bit higher than actually needed gives the messages more priority in case of exceeding link bandwidth.
+    // Once tuning is done the rates drop back to whatever other consumers still need.
+    for (int msgId: _pidTuningMessages) {
+        if (pidTuning) {
+            _messageRateManager->requestMessageRate(this, msgId, _pidTuningMessageRateHz);
+        } else {
+            _messageRateManager->removeMessageRate(this, msgId);
         }
     }
-    qCDebug(VehicleLog) << "Facts logged to csv:" << allFactNames;
-    stream << "Timestamp," << allFactNames.join(",") << "\n";
+    setLiveUpdates(pidTuning);
+    _setpointFactGroup.setLiveUpdates(pidTuning);
 }
 
-void Vehicle::_writeCsvLine()
+void Vehicle::_checkTelemetryRecorder()
 {
-    // Only save the logs after the the vehicle gets armed, unless "Save logs even if vehicle was not armed" is checked
-    if(!_csvLogFile.isOpen() &&
-            (_armed || _toolbox->settingsManager()->appSettings()->telemetrySaveNotArmed()->rawValue().toBool())){
-        _initializeCsv();
+    if (_telemetryRecorder) {
+        return;
     }
 
-    if(!_csvLogFile.isOpen()){
+    // Only record after the the vehicle gets armed, unless "Save logs even if vehicle was not armed" is checked
+    AppSettings* appSettings = _toolbox->settingsManager()->appSettings();
+    if (!appSettings->saveCsvTelemetry()->rawValue().toBool() ||
+            (!_armed && !appSettings->telemetrySaveNotArmed()->rawValue().toBool())) {
         return;
     }
 
-    QStringList allFactValues;
-    QTextStream stream(&_csvLogFile);
-
-    // Write timestamp to csv file
-    allFactValues << QDateTime::currentDateTime().toString(QStringLiteral("yyyy-MM-dd hh:mm:ss.zzz"));
-    // Write Vehicle's own facts
-    for (const QString& factName : factNames()) {
-        allFactValues << getFact(factName)->cookedValueString();
-    }
-    // write facts from Vehicle's FactGroups
-    for (const QString& groupName: factGroupNames()) {
-        for (const QString& factName : getFactGroup(groupName)->factNames()) {
-            allFactValues << getFactGroup(groupName)->getFact(factName)->cookedValueString();
-        }
+    QString now         = QDateTime::currentDateTime().toString("yyyy-MM-dd hh-mm-ss");
+    QString baseName    = QString("%1 vehicle%2").arg(now).arg(_id);
+    QDir    saveDir(appSettings->telemetrySavePath());
+    QString csvFileName;
+    if (appSettings->telemetryRecordCsv()->rawValue().toBool()) {
+        csvFileName = saveDir.absoluteFilePath(baseName + QStringLiteral(".csv"));
     }
 
-    stream << allFactValues.join(",") << "\n";
+    _telemetryRecorder = new TelemetryRecorder(this, this);
+    _telemetryRecorder->start(saveDir.absoluteFilePath(QStringLiteral("%1.%2").arg(baseName, TelemetryRecorder::fileExtension)),
+                              csvFileName,
+                              appSettings->telemetryRecordRate()->rawValue().toInt());
 }
 
 #if !defined(NO_ARDUPILOT_DIALECT)
@@ -3754,8 +3809,17 @@ void Vehicle::_handleObstacleDistance(const mavlink_message_t& message)
 {
     mavlink_obstacle_distance_t o;
     mavlink_msg_obstacle_distance_decode(&message, &o);
-    _objectAvoidance->update(&o);
+    _objectAvoidance->update(message.compid, &o);
+}
+
+#if defined(MAVLINK_MSG_ID_OBSTACLE_DISTANCE_3D)
+void Vehicle::_handleObstacleDistance3D(const mavlink_message_t& message)
+{
+    mavlink_obstacle_distance_3d_t o;
+    mavlink_msg_obstacle_distance_3d_decode(&message, &o);
+    _objectAvoidance->update3D(message.compid, &o);
 }
+#endif
 
 void Vehicle::updateFlightDistance(double distance)
 {
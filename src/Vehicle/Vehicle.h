@@ -15,8 +15,12 @@
 #include <QGeoCoordinate>
 #include <QTime>
 #include <QQueue>
+#include <QHash>
+
+#include <functional>
 
 #include "FactGroup.h"
+#include "QGCTimerWheel.h"
 #include "QGCMAVLink.h"
 #include "QmlObjectListModel.h"
 #include "MAVLinkProtocol.h"
@@ -33,12 +37,16 @@
 #include "VehicleTemperatureFactGroup.h"
 #include "VehicleVibrationFactGroup.h"
 #include "VehicleEscStatusFactGroup.h"
+#include "VehicleEscStatusModel.h"
+#include "VehicleBatteryStatusModel.h"
+#include "StatusTextHandler.h"
 #include "VehicleEstimatorStatusFactGroup.h"
 #include "VehicleLinkManager.h"
 #include "MissionManager.h"
 #include "GeoFenceManager.h"
 #include "RallyPointManager.h"
 #include "FTPManager.h"
+#include "AudioOutputQueue.h"
 
 class UAS;
 class UASInterface;
@@ -48,6 +56,7 @@ class AutoPilotPlugin;
 class ParameterManager;
 class JoystickManager;
 class UASMessage;
+class UASMessageModel;
 class SettingsManager;
 class QGCCameraManager;
 class Joystick;
@@ -62,6 +71,8 @@ class RequestMessageTest;
 class LinkInterface;
 class LinkManager;
 class InitialConnectStateMachine;
+class TelemetryRecorder;
+class MessageRateManager;
 
 #if defined(QGC_AIRMAP_ENABLED)
 class AirspaceVehicleManager;
@@ -151,7 +162,7 @@ public:
     Q_PROPERTY(QStringList          flightModes                 READ flightModes                                                    NOTIFY flightModesChanged)
     Q_PROPERTY(QStringList          extraJoystickFlightModes    READ extraJoystickFlightModes                                       NOTIFY flightModesChanged)
     Q_PROPERTY(QString              flightMode                  READ flightMode                 WRITE setFlightMode                 NOTIFY flightModeChanged)
-    Q_PROPERTY(TrajectoryPoints*    trajectoryPoints            MEMBER _trajectoryPoints                                            CONSTANT)
+    Q_PROPERTY(TrajectoryPoints*    trajectoryPoints            READ trajectoryPoints                                               CONSTANT)
     Q_PROPERTY(QmlObjectListModel*  cameraTriggerPoints         READ cameraTriggerPoints                                            CONSTANT)
     Q_PROPERTY(float                latitude                    READ latitude                                                       NOTIFY coordinateChanged)
     Q_PROPERTY(float                longitude                   READ longitude                                                      NOTIFY coordinateChanged)
@@ -162,6 +173,7 @@ public:
     Q_PROPERTY(int                  newMessageCount             READ newMessageCount                                                NOTIFY newMessageCountChanged)
     Q_PROPERTY(int                  messageCount                READ messageCount                                                   NOTIFY messageCountChanged)
     Q_PROPERTY(QString              formattedMessages           READ formattedMessages                                              NOTIFY formattedMessagesChanged)
+    Q_PROPERTY(UASMessageModel*     messageModel                READ messageModel                                                   CONSTANT)
     Q_PROPERTY(QString              latestError                 READ latestError                                                    NOTIFY latestErrorChanged)
     Q_PROPERTY(bool                 joystickEnabled             READ joystickEnabled            WRITE setJoystickEnabled            NOTIFY joystickEnabledChanged)
     Q_PROPERTY(int                  flowImageIndex              READ flowImageIndex                                                 NOTIFY flowImageIndexChanged)
@@ -220,6 +232,7 @@ public:
     Q_PROPERTY(bool              initialPlanRequestComplete     READ initialPlanRequestComplete                                     NOTIFY initialPlanRequestCompleteChanged)
     Q_PROPERTY(QVariantList         staticCameraList            READ staticCameraList                                               CONSTANT)
     Q_PROPERTY(QGCCameraManager*    cameraManager               READ cameraManager                                                  NOTIFY cameraManagerChanged)
+    Q_PROPERTY(bool                 lightweight                 READ lightweight                                                    NOTIFY lightweightChanged)
     Q_PROPERTY(QString              hobbsMeter                  READ hobbsMeter                                                     NOTIFY hobbsMeterChanged)
     Q_PROPERTY(bool                 vtolInFwdFlight             READ vtolInFwdFlight            WRITE setVtolInFwdFlight            NOTIFY vtolInFwdFlightChanged)
     Q_PROPERTY(bool                 supportsTerrainFrame        READ supportsTerrainFrame                                           NOTIFY firmwareTypeChanged)
@@ -290,6 +303,8 @@ public:
     Q_PROPERTY(FactGroup*           terrain         READ terrainFactGroup           CONSTANT)
     Q_PROPERTY(FactGroup*           distanceSensors READ distanceSensorFactGroup    CONSTANT)
     Q_PROPERTY(QmlObjectListModel*  batteries       READ batteries                  CONSTANT)
+    Q_PROPERTY(VehicleEscStatusModel*       escStatusModel      READ escStatusModel     CONSTANT)   ///< All ESCs, one row each
+    Q_PROPERTY(VehicleBatteryStatusModel*   batteryStatusModel  READ batteryStatusModel CONSTANT)   ///< All batteries, one row each
 
     Q_PROPERTY(int      firmwareMajorVersion        READ firmwareMajorVersion       NOTIFY firmwareVersionChanged)
     Q_PROPERTY(int      firmwareMinorVersion        READ firmwareMinorVersion       NOTIFY firmwareVersionChanged)
@@ -473,6 +488,7 @@ public:
     void setPrearmError(const QString& prearmError);
 
     QmlObjectListModel* cameraTriggerPoints () { return &_cameraTriggerPoints; }
+    TrajectoryPoints*   trajectoryPoints    () { return _trajectoryPoints; }
 
     int  flowImageIndex() { return _flowImageIndex; }
 
@@ -484,6 +500,7 @@ public:
     ///     @param stream Stream which is being requested
     ///     @param rate Rate at which to send stream in Hz
     ///     @param sendMultiple Send multiple time to guarantee Vehicle reception
+    /// Consumers should go through messageRateManager instead, so they don't lower the rate someone else needs.
     void requestDataStream(MAV_DATA_STREAM stream, uint16_t rate, bool sendMultiple = true);
 
     // The follow method are used to turn on/off the tracking of settings updates for firmware/vehicle type on offline vehicles.
@@ -504,6 +521,7 @@ public:
     int             newMessageCount             () { return _currentMessageCount; }
     int             messageCount                () { return _messageCount; }
     QString         formattedMessages           ();
+    UASMessageModel* messageModel               ();
     QString         latestError                 () { return _latestError; }
     float           latitude                    () { return static_cast<float>(_coordinate.latitude()); }
     float           longitude                   () { return static_cast<float>(_coordinate.longitude()); }
@@ -611,6 +629,8 @@ public:
     FactGroup* estimatorStatusFactGroup     () { return &_estimatorStatusFactGroup; }
     FactGroup* terrainFactGroup             () { return &_terrainFactGroup; }
     QmlObjectListModel* batteries           () { return &_batteryFactGroupListModel; }
+    VehicleEscStatusModel*      escStatusModel      () { return &_escStatusModel; }
+    VehicleBatteryStatusModel*  batteryStatusModel  () { return &_batteryStatusModel; }
 
     MissionManager*                 missionManager      () { return _missionManager; }
     GeoFenceManager*                geoFenceManager     () { return _geoFenceManager; }
@@ -618,14 +638,16 @@ public:
     ParameterManager*               parameterManager    () { return _parameterManager; }
     ParameterManager*               parameterManager    () const { return _parameterManager; }
     VehicleLinkManager*             vehicleLinkManager  () { return _vehicleLinkManager; }
+    MessageRateManager*             messageRateManager  () { return _messageRateManager; }
     FTPManager*                     ftpManager          () { return _ftpManager; }
     ComponentInformationManager*    compInfoManager     () { return _componentInformationManager; }
     VehicleObjectAvoidance*         objectAvoidance     () { return _objectAvoidance; }
 
     static const int cMaxRcChannels = 18;
 
-    /// Sends the specified MAV_CMD to the vehicle. If no Ack is received command will be retried. If a sendMavCommand is already in progress
-    /// the command will be queued and sent when the previous command completes.
+    /// Sends the specified MAV_CMD to the vehicle. If no Ack is received command will be retried, with timeouts which follow the measured
+    /// ack round trip of the component. Any number of commands can be in flight, but only one of each MAV_CMD per component since acks
+    /// can't be told apart otherwise.
     ///     @param compId Component to send to.
     ///     @param command MAV_CMD to send
     ///     @param showError true: Display error to user if command failed, false:  no error shown
@@ -653,6 +675,19 @@ public:
     ///     @param resultHandleData Opaque data passed through callback
     void sendMavCommandWithHandler(MavCmdResultHandler resultHandler, void* resultHandlerData, int compId, MAV_CMD command, float param1 = 0.0f, float param2 = 0.0f, float param3 = 0.0f, float param4 = 0.0f, float param5 = 0.0f, float param6 = 0.0f, float param7 = 0.0f);
 
+    typedef struct {
+        int     sendCount           = 0;    ///< Commands sent, not counting retries
+        int     retryCount          = 0;
+        int     ackCount            = 0;
+        int     noResponseCount     = 0;    ///< Gave up after the last retry
+        qint64  minLatencyMSecs     = 0;    ///< First send to ack, over all acked commands
+        qint64  maxLatencyMSecs     = 0;
+        qint64  totalLatencyMSecs   = 0;
+    } MavCommandStats_t;
+
+    /// @return Counts and ack latencies for all sends of command to this vehicle
+    MavCommandStats_t mavCommandStats(MAV_CMD command) const { return _mavCommandStatsMap.value(command); }
+
     typedef enum {
         RequestMessageNoFailure,
         RequestMessageFailureCommandError,
@@ -742,6 +777,19 @@ public:
     /// Vehicle is about to be deleted
     void prepareDelete();
 
+    /// A lightweight vehicle runs no timers of its own, MultiVehicleManager drives it with lightweightUpdate from one
+    /// shared timer. Telemetry is published at a reduced rate and there is no camera manager. Turning it off restores
+    /// the full vehicle.
+    void setLightweight     (bool lightweight);
+    bool lightweight        () const { return _lightweight; }
+
+    /// Periodic work of a lightweight vehicle, called every lightweightUpdateMSecs
+    ///     @param rateFactor Telemetry is published this many times less often, commands and the telemetry recorder
+    ///                 keep their rate
+    void lightweightUpdate  (int rateFactor = 1);
+
+    static const int lightweightUpdateMSecs = 500;
+
     quint64     mavlinkSentCount        () { return _mavlinkSentCount; }        /// Calculated total number of messages sent to us
     quint64     mavlinkReceivedCount    () { return _mavlinkReceivedCount; }    /// Total number of sucessful messages received
     quint64     mavlinkLossCount        () { return _mavlinkLossCount; }        /// Total number of lost messages
@@ -780,6 +828,7 @@ signals:
     void firmwareTypeChanged            ();
     void vehicleTypeChanged             ();
     void cameraManagerChanged           ();
+    void lightweightChanged             (bool lightweight);
     void hobbsMeterChanged              ();
     void capabilitiesKnownChanged       (bool capabilitiesKnown);
     void initialPlanRequestCompleteChanged(bool initialPlanRequestComplete);
@@ -787,6 +836,8 @@ signals:
     void toolIndicatorsChanged          ();
     void modeIndicatorsChanged          ();
     void textMessageReceived            (int uasid, int componentid, int severity, QString text);
+    /// Sent once for each status text with its repeat count, textMessageReceived is sent for repeats as well
+    void statusTextReceived             (const StatusTextHandler::StatusText_t& statusText);
     void checkListStateChanged          ();
     void messagesReceivedChanged        ();
     void messagesSentChanged            ();
@@ -832,10 +883,10 @@ signals:
     /// Remote control RSSI changed  (0% - 100%)
     void remoteControlRSSIChanged       (uint8_t rssi);
 
-    void mavlinkRawImu                  (mavlink_message_t message);
-    void mavlinkScaledImu1              (mavlink_message_t message);
-    void mavlinkScaledImu2              (mavlink_message_t message);
-    void mavlinkScaledImu3              (mavlink_message_t message);
+    void mavlinkRawImu                  (const mavlink_message_t& message);
+    void mavlinkScaledImu1              (const mavlink_message_t& message);
+    void mavlinkScaledImu2              (const mavlink_message_t& message);
+    void mavlinkScaledImu3              (const mavlink_message_t& message);
 
     // Mavlink Log Download
     void mavlinkLogData                 (Vehicle* vehicle, uint8_t target_system, uint8_t target_component, uint16_t sequence, uint8_t first_message, QByteArray data, bool acked);
@@ -863,7 +914,7 @@ signals:
     void initialConnectComplete         ();
 
 private slots:
-    void _mavlinkMessageReceived            (LinkInterface* link, mavlink_message_t message);
+    void _mavlinkMessageReceived            (LinkInterface* link, const mavlink_message_t& receivedMessage);
     void _sendMessageMultipleNext           ();
     void _parametersReady                   (bool parametersReady);
     void _remoteControlRSSIChanged          (uint8_t rssi);
@@ -873,6 +924,7 @@ private slots:
     void _offlineHoverSpeedSettingChanged   (QVariant value);
     void _handleTextMessage                 (int newCount);
     void _handletextMessageReceived         (UASMessage* message);
+    void _statusTextReceived                (const StatusTextHandler::StatusText_t& statusText);
     void _imageReady                        (UASInterface* uas);    ///< A new camera image has arrived
     void _prearmErrorTimeout                ();
     void _firstMissionLoadComplete          ();
@@ -891,12 +943,14 @@ private slots:
     void _trafficUpdate                     (bool alert, QString traffic_id, QString vehicle_id, QGeoCoordinate location, float heading);
     void _orbitTelemetryTimeout             ();
     void _updateFlightTime                  ();
+    void _setFactGroupRateLimit             (int updateRateMSecs);
 
 private:
     void _joystickChanged               (Joystick* joystick);
     void _loadSettings                  ();
     void _saveSettings                  ();
     void _startJoystick                 (bool start);
+    void _subscribeMavlinkMessages      (void);
     void _handlePing                    (LinkInterface* link, mavlink_message_t& message);
     void _handleHomePosition            (mavlink_message_t& message);
     void _handleHeartbeat               (mavlink_message_t& message);
@@ -915,11 +969,12 @@ private:
     void _handleAttitudeWorker          (double rollRadians, double pitchRadians, double yawRadians);
     void _handleAttitude                (mavlink_message_t& message);
     void _handleAttitudeQuaternion      (mavlink_message_t& message);
-    void _handleStatusText              (mavlink_message_t& message);
     void _handleOrbitExecutionStatus    (const mavlink_message_t& message);
-    void _handleMessageInterval         (const mavlink_message_t& message);
     void _handleGimbalOrientation       (const mavlink_message_t& message);
     void _handleObstacleDistance        (const mavlink_message_t& message);
+#if defined(MAVLINK_MSG_ID_OBSTACLE_DISTANCE_3D)
+    void _handleObstacleDistance3D      (const mavlink_message_t& message);
+#endif
     // ArduPilot dialect messages
 #if !defined(NO_ARDUPILOT_DIALECT)
     void _handleCameraFeedback          (const mavlink_message_t& message);
@@ -929,7 +984,7 @@ private:
     void _missionManagerError           (int errorCode, const QString& errorMsg);
     void _geoFenceManagerError          (int errorCode, const QString& errorMsg);
     void _rallyPointManagerError        (int errorCode, const QString& errorMsg);
-    void _say                           (const QString& text);
+    void _say                           (const QString& text, const QString& messageClass, AudioOutputQueue::Priority priority = AudioOutputQueue::PriorityNormal);
     QString _vehicleIdSpeech            ();
     void _handleMavlinkLoggingData      (mavlink_message_t& message);
     void _handleMavlinkLoggingDataAcked (mavlink_message_t& message);
@@ -939,13 +994,11 @@ private:
     void _setCapabilities               (uint64_t capabilityBits);
     void _updateArmed                   (bool armed);
     bool _apmArmingNotRequired          ();
-    void _pidTuningAdjustRates          ();
-    void _initializeCsv                 ();
-    void _writeCsvLine                  ();
+    void _checkTelemetryRecorder        ();
     void _flightTimerStart              ();
     void _flightTimerStop               ();
-    void _chunkedStatusTextTimeout      (void);
-    void _chunkedStatusTextCompleted    (uint8_t compId);
+    void _deleteCameraManager           ();
+    void _forEachFactGroup              (std::function<void(const QString& name, FactGroup* factGroup)> callback);
 
     static void _rebootCommandResultHandler(void* resultHandlerData, int compId, MAV_RESULT commandResult, MavCmdResultFailureCode_t failureCode);
 
@@ -963,8 +1016,8 @@ private:
     QGCToolbox*         _toolbox = nullptr;
     SettingsManager*    _settingsManager = nullptr;
 
-    QTimer              _csvLogTimer;
-    QFile               _csvLogFile;
+    QGCWheelTimer       _telemetryRecorderTimer { "Vehicle" };
+    TelemetryRecorder*  _telemetryRecorder = nullptr;
 
     bool            _joystickEnabled = false;
 
@@ -1004,6 +1057,7 @@ private:
     uint32_t        _telemetryTXBuffer = 0;
     int             _telemetryLNoise = 0;
     int             _telemetryRNoise = 0;
+    bool            _telemetryRadioStatusReceived = false;  ///< true: A telemetry radio in the link reports RADIO_STATUS
     bool            _mavlinkProtocolRequestComplete         = false;
     unsigned        _mavlinkProtocolRequestMaxProtoVersion  = 0;
     unsigned        _maxProtoVersion                        = 0;
@@ -1020,7 +1074,7 @@ private:
     QGCCameraManager* _cameraManager = nullptr;
 
     QString             _prearmError;
-    QTimer              _prearmErrorTimer;
+    QGCWheelTimer       _prearmErrorTimer { "Vehicle" };
     static const int    _prearmErrorTimeoutMSecs = 35 * 1000;   ///< Take away prearm error after 35 seconds
 
     bool                _initialPlanRequestComplete = false;
@@ -1050,11 +1104,12 @@ private:
     static const int _sendMessageMultipleRetries = 5;
     static const int _sendMessageMultipleIntraMessageDelay = 500;
 
-    QTimer  _sendMultipleTimer;
-    int     _nextSendMessageMultipleIndex = 0;
+    QGCWheelTimer   _sendMultipleTimer { "Vehicle" };
+    int             _nextSendMessageMultipleIndex = 0;
 
     QElapsedTimer                   _flightTimer;
-    QTimer                          _flightTimeUpdater;
+    QGCWheelTimer                   _flightTimeUpdater { "Vehicle" };
+    bool                            _flightTimerActive = false;
     TrajectoryPoints*               _trajectoryPoints = nullptr;
     QmlObjectListModel              _cameraTriggerPoints;
     //QMap<QString, ADSBVehicle*>     _trafficVehicleMap;
@@ -1096,29 +1151,16 @@ private:
     uint64_t    _mavlinkLossCount       = 0;
     float       _mavlinkLossPercent     = 0.0f;
 
-    QMap<QString, QTime> _noisySpokenPrearmMap; ///< Used to prevent PreArm messages from being spoken too often
-
     // Orbit status values
     bool            _orbitActive = false;
     QGCMapCircle    _orbitMapCircle;
-    QTimer          _orbitTelemetryTimer;
+    QGCWheelTimer   _orbitTelemetryTimer { "Vehicle" };  ///< Restarted with each orbit telemetry message
     static const int _orbitTelemetryTimeoutMsecs = 3000; // No telemetry for this amount and orbit will go inactive
 
     // PID Tuning telemetry mode
     bool            _pidTuningTelemetryMode = false;
-    bool            _pidTuningWaitingForRates = false;
-    int             _pidTuningNextAdjustIndex = -1;
-    QMap<int, int>  _pidTuningMessageRatesUsecs;
     static const QList<int> _pidTuningMessages;
-
-    // Chunked status text support
-    typedef struct {
-        uint16_t    chunkId;
-        uint8_t     severity;
-        QStringList rgMessageChunks;
-    } ChunkedStatusTextInfo_t;
-    QMap<uint8_t /* compId */, ChunkedStatusTextInfo_t> _chunkedStatusTextInfoMap;
-    QTimer _chunkedStatusTextTimer;
+    static const int _pidTuningMessageRateHz = 100;
 
     /// Callback for waitForMavlinkMessage
     ///     @param resultHandleData     Opaque data passed in to waitForMavlinkMessage call
@@ -1164,21 +1206,37 @@ private:
         void*               resultHandlerData   = nullptr;
         int                 maxTries            = _mavCommandMaxRetryCount;
         int                 tryCount            = 0;
-        QElapsedTimer       elapsedTimer;
-        int                 ackTimeoutMSecs     = _mavCommandAckTimeoutMSecs;
+        QElapsedTimer       elapsedTimer;                                       // Started with the first send
+        qint64              sentMSecs           = 0;                            // elapsedTimer msecs of the latest send
+        int                 timeoutMSecs        = 0;                            // Ack timeout of the latest send
+        int                 ackTimeoutMSecs     = _mavCommandAckTimeoutMSecs;   // Upper bound for timeoutMSecs
     } MavCommandListEntry_t;
 
-    QList<MavCommandListEntry_t>    _mavCommandList;
-    QTimer                          _mavCommandResponseCheckTimer;
-    static const int                _mavCommandMaxRetryCount                = 3;
-    static const int                _mavCommandResponseCheckTimeoutMSecs    = 500;
-    static const int                _mavCommandAckTimeoutMSecs              = 3000;
-    static const int                _mavCommandAckTimeoutMSecsHighLatency   = 120000;
-
-    void _sendMavCommandWorker  (bool commandInt, bool requestMessage, bool showError, MavCmdResultHandler resultHandler, void* resultHandlerData, int compId, MAV_CMD command, MAV_FRAME frame, float param1, float param2, float param3, float param4, float param5, float param6, float param7);
-    void _sendMavCommandFromList(MavCommandListEntry_t& commandEntry);
-    int  _findMavCommandListEntryIndex(int targetCompId, MAV_CMD command);
-    bool _sendMavCommandShouldRetry(MAV_CMD command);
+    /// Smoothed ack round trip of a component, as in RFC 6298
+    typedef struct {
+        double  srttMSecs   = 0;
+        double  rttVarMSecs = 0;
+    } MavCommandRtt_t;
+
+    QHash<quint32, MavCommandListEntry_t>   _mavCommandMap;                                     ///< Key: _mavCommandKey
+    QHash<int, MavCommandRtt_t>             _mavCommandRttMap;                                  ///< Key: component id
+    QHash<int, MavCommandStats_t>           _mavCommandStatsMap;                                ///< Key: MAV_CMD
+    QGCWheelTimer                           _mavCommandResponseCheckTimer { "Vehicle" };        ///< Single shot, set for the earliest ack timeout
+    static const int                        _mavCommandMaxRetryCount                = 3;
+    static const int                        _mavCommandResponseCheckTimeoutMSecs    = 500;      ///< Retry timeout until the round trip is known
+    static const int                        _mavCommandMinAckTimeoutMSecs           = 200;
+    static const int                        _mavCommandAckTimeoutMSecs              = 3000;
+    static const int                        _mavCommandAckTimeoutMSecsHighLatency   = 120000;
+
+    static quint32 _mavCommandKey(int compId, int command) { return (static_cast<quint32>(compId) << 16) | static_cast<quint16>(command); }
+
+    void _sendMavCommandWorker              (bool commandInt, bool requestMessage, bool showError, MavCmdResultHandler resultHandler, void* resultHandlerData, int compId, MAV_CMD command, MAV_FRAME frame, float param1, float param2, float param3, float param4, float param5, float param6, float param7);
+    void _sendMavCommandFromList            (quint32 key);
+    bool _mavCommandInFlight                (int targetCompId, MAV_CMD command) const { return _mavCommandMap.contains(_mavCommandKey(targetCompId, command)); }
+    int  _mavCommandTimeoutMSecs            (const MavCommandListEntry_t& commandEntry) const;
+    void _mavCommandRttSample               (int compId, qint64 rttMSecs);
+    void _scheduleMavCommandResponseCheck   (void);
+    bool _sendMavCommandShouldRetry         (MAV_CMD command);
 
     QMap<uint8_t /* batteryId */, uint8_t /* MAV_BATTERY_CHARGE_STATE_OK */> _lowestBatteryChargeStateAnnouncedMap;
 
@@ -1216,6 +1274,9 @@ private:
     VehicleEstimatorStatusFactGroup _estimatorStatusFactGroup;
     TerrainFactGroup                _terrainFactGroup;
     QmlObjectListModel              _batteryFactGroupListModel;
+    VehicleEscStatusModel           _escStatusModel;
+    VehicleBatteryStatusModel       _batteryStatusModel;
+    StatusTextHandler               _statusTextHandler;
 
     TerrainProtocolHandler* _terrainProtocolHandler = nullptr;
 
@@ -1223,6 +1284,7 @@ private:
     GeoFenceManager*                _geoFenceManager            = nullptr;
     RallyPointManager*              _rallyPointManager          = nullptr;
     VehicleLinkManager*             _vehicleLinkManager         = nullptr;
+    MessageRateManager*             _messageRateManager         = nullptr;
     FTPManager*                     _ftpManager                 = nullptr;
     InitialConnectStateMachine*     _initialConnectStateMachine = nullptr;
 
@@ -1260,6 +1322,14 @@ private:
 
     static const int _vehicleUIUpdateRateMSecs      = 100;
 
+    // Lightweight vehicle
+    bool _lightweight       = false;
+    int  _lightweightTicks  = 0;
+
+    QHash<FactGroup*, int> _factGroupOriginalRates;  ///< Update rates to restore once log replay rate limiting ends
+    static const int _lightweightSecondTicks        = 1000 / lightweightUpdateMSecs;
+    static const int _lightweightSlowTicks          = 5000 / lightweightUpdateMSecs;    ///< Fact groups other than gps and battery
+
     // Settings keys
     static const char* _settingsGroup;
     static const char* _joystickEnabledSettingsKey;
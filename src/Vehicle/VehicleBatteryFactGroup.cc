@@ -8,6 +8,7 @@
  ****************************************************************************/
 
 #include "VehicleBatteryFactGroup.h"
+#include "VehicleBatteryStatusModel.h"
 #include "QmlObjectListModel.h"
 #include "Vehicle.h"
 
@@ -130,29 +131,19 @@ void VehicleBatteryFactGroup::_handleBatteryStatus(Vehicle* vehicle, mavlink_mes
 
     VehicleBatteryFactGroup* group = _findOrAddBatteryGroupById(vehicle, batteryStatus.id);
 
-    double totalVoltage = qQNaN();
-    for (int i=0; i<10; i++) {
-        double cellVoltage = batteryStatus.voltages[i] == UINT16_MAX ? qQNaN() : static_cast<double>(batteryStatus.voltages[i]) / 1000.0;
-        if (qIsNaN(cellVoltage)) {
-            break;
-        }
-        if (i == 0) {
-            totalVoltage = cellVoltage;
-        } else {
-            totalVoltage += cellVoltage;
-        }
-    }
-
-    group->function()->setRawValue          (batteryStatus.battery_function);
-    group->type()->setRawValue              (batteryStatus.type);
-    group->temperature()->setRawValue       (batteryStatus.temperature == INT16_MAX ?   qQNaN() : static_cast<double>(batteryStatus.temperature) / 100.0);
-    group->voltage()->setRawValue           (totalVoltage);
-    group->current()->setRawValue           (batteryStatus.current_battery == -1 ?      qQNaN() : static_cast<double>(batteryStatus.current_battery) / 100.0);
-    group->mahConsumed()->setRawValue       (batteryStatus.current_consumed == -1  ?    qQNaN() : batteryStatus.current_consumed);
-    group->percentRemaining()->setRawValue  (batteryStatus.battery_remaining == -1 ?    qQNaN() : batteryStatus.battery_remaining);
-    group->timeRemaining()->setRawValue     (batteryStatus.time_remaining == 0 ?        qQNaN() : batteryStatus.time_remaining);
-    group->chargeState()->setRawValue       (batteryStatus.charge_state);
-    group->instantPower()->setRawValue      (totalVoltage * group->current()->rawValue().toDouble());
+    VehicleBatteryStatusModel::BatteryState_t battery;
+    VehicleBatteryStatusModel::decodeBatteryStatus(batteryStatus, battery);
+
+    group->function()->setRawValue          (battery.function);
+    group->type()->setRawValue              (battery.type);
+    group->temperature()->setRawValue       (battery.temperature);
+    group->voltage()->setRawValue           (battery.voltage);
+    group->current()->setRawValue           (battery.current);
+    group->mahConsumed()->setRawValue       (battery.mahConsumed);
+    group->percentRemaining()->setRawValue  (battery.percentRemaining);
+    group->timeRemaining()->setRawValue     (battery.timeRemaining);
+    group->chargeState()->setRawValue       (battery.chargeState);
+    group->instantPower()->setRawValue      (battery.instantPower);
     group->_setTelemetryAvailable(true);
 }
 
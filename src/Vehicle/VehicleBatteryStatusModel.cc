@@ -0,0 +1,188 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VehicleBatteryStatusModel.h"
+
+VehicleBatteryStatusModel::VehicleBatteryStatusModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+
+}
+
+void VehicleBatteryStatusModel::handleMessage(const mavlink_message_t& message)
+{
+    switch (message.msgid) {
+    case MAVLINK_MSG_ID_HIGH_LATENCY:
+    {
+        mavlink_high_latency_t highLatency;
+        mavlink_msg_high_latency_decode(&message, &highLatency);
+        _setPercentRemaining(highLatency.battery_remaining == UINT8_MAX ? qQNaN() : highLatency.battery_remaining);
+    }
+        break;
+    case MAVLINK_MSG_ID_HIGH_LATENCY2:
+    {
+        mavlink_high_latency2_t highLatency2;
+        mavlink_msg_high_latency2_decode(&message, &highLatency2);
+        _setPercentRemaining(highLatency2.battery == -1 ? qQNaN() : highLatency2.battery);
+    }
+        break;
+    case MAVLINK_MSG_ID_BATTERY_STATUS:
+    {
+        mavlink_battery_status_t batteryStatus;
+        mavlink_msg_battery_status_decode(&message, &batteryStatus);
+
+        const int row = _findOrAddRow(batteryStatus.id);
+        decodeBatteryStatus(batteryStatus, _batteries[row]);
+        emit dataChanged(createIndex(row, 0), createIndex(row, 0));
+    }
+        break;
+    }
+}
+
+void VehicleBatteryStatusModel::decodeBatteryStatus(const mavlink_battery_status_t& batteryStatus, BatteryState_t& battery)
+{
+    int     cellCount       = 0;
+    double  totalVoltage    = qQNaN();
+    for (int i=0; i<10; i++) {
+        if (batteryStatus.voltages[i] == UINT16_MAX) {
+            break;
+        }
+        const double cellVoltage = static_cast<double>(batteryStatus.voltages[i]) / 1000.0;
+        totalVoltage = cellCount == 0 ? cellVoltage : totalVoltage + cellVoltage;
+        cellCount++;
+    }
+
+    battery.id                  = batteryStatus.id;
+    battery.function            = batteryStatus.battery_function;
+    battery.type                = batteryStatus.type;
+    battery.chargeState         = batteryStatus.charge_state;
+    battery.cellCount           = cellCount;
+    battery.voltage             = totalVoltage;
+    battery.temperature         = batteryStatus.temperature == INT16_MAX ?  qQNaN() : static_cast<double>(batteryStatus.temperature) / 100.0;
+    battery.current             = batteryStatus.current_battery == -1 ?     qQNaN() : static_cast<double>(batteryStatus.current_battery) / 100.0;
+    battery.mahConsumed         = batteryStatus.current_consumed == -1 ?    qQNaN() : batteryStatus.current_consumed;
+    battery.percentRemaining    = batteryStatus.battery_remaining == -1 ?   qQNaN() : batteryStatus.battery_remaining;
+    battery.timeRemaining       = batteryStatus.time_remaining == 0 ?       qQNaN() : batteryStatus.time_remaining;
+    battery.instantPower        = totalVoltage * battery.current;
+}
+
+const VehicleBatteryStatusModel::BatteryState_t* VehicleBatteryStatusModel::battery(uint8_t batteryId) const
+{
+    for (const BatteryState_t& battery: _batteries) {
+        if (battery.id == batteryId) {
+            return &battery;
+        }
+    }
+    return nullptr;
+}
+
+int VehicleBatteryStatusModel::_findOrAddRow(uint8_t batteryId)
+{
+    // Only a handful of batteries, a linear search is quicker than keeping an index
+    int row = 0;
+    while (row < _batteries.count() && _batteries[row].id < batteryId) {
+        row++;
+    }
+    if (row < _batteries.count() && _batteries[row].id == batteryId) {
+        return row;
+    }
+
+    BatteryState_t battery;
+    battery.id = batteryId;
+
+    beginInsertRows(QModelIndex(), row, row);
+    _batteries.insert(row, battery);
+    endInsertRows();
+    emit countChanged();
+
+    return row;
+}
+
+void VehicleBatteryStatusModel::_setPercentRemaining(double percentRemaining)
+{
+    const int row = _findOrAddRow(0);
+
+    _batteries[row].percentRemaining = percentRemaining;
+    emit dataChanged(createIndex(row, 0), createIndex(row, 0));
+}
+
+void VehicleBatteryStatusModel::clear(void)
+{
+    if (_batteries.isEmpty()) {
+        return;
+    }
+    beginResetModel();
+    _batteries.clear();
+    endResetModel();
+    emit countChanged();
+}
+
+int VehicleBatteryStatusModel::rowCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+    return _batteries.count();
+}
+
+QVariant VehicleBatteryStatusModel::data(const QModelIndex& index, int role) const
+{
+    if (index.row() < 0 || index.row() >= _batteries.count()) {
+        return QVariant();
+    }
+
+    const BatteryState_t& battery = _batteries[index.row()];
+
+    switch (role) {
+    case BatteryIdRole:
+        return battery.id;
+    case FunctionRole:
+        return battery.function;
+    case TypeRole:
+        return battery.type;
+    case VoltageRole:
+        return battery.voltage;
+    case CurrentRole:
+        return battery.current;
+    case MahConsumedRole:
+        return battery.mahConsumed;
+    case PercentRemainingRole:
+        return battery.percentRemaining;
+    case TemperatureRole:
+        return battery.temperature;
+    case TimeRemainingRole:
+        return battery.timeRemaining;
+    case ChargeStateRole:
+        return battery.chargeState;
+    case InstantPowerRole:
+        return battery.instantPower;
+    case CellCountRole:
+        return battery.cellCount;
+    }
+
+    return QVariant();
+}
+
+QHash<int, QByteArray> VehicleBatteryStatusModel::roleNames(void) const
+{
+    QHash<int, QByteArray> roles;
+
+    roles[BatteryIdRole]        = "batteryId";
+    roles[FunctionRole]         = "batteryFunction";
+    roles[TypeRole]             = "batteryType";
+    roles[VoltageRole]          = "voltage";
+    roles[CurrentRole]          = "current";
+    roles[MahConsumedRole]      = "mahConsumed";
+    roles[PercentRemainingRole] = "percentRemaining";
+    roles[TemperatureRole]      = "temperature";
+    roles[TimeRemainingRole]    = "timeRemaining";
+    roles[ChargeStateRole]      = "chargeState";
+    roles[InstantPowerRole]     = "instantPower";
+    roles[CellCountRole]        = "cellCount";
+
+    return roles;
+}
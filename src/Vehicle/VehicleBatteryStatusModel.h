@@ -0,0 +1,88 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCMAVLink.h"
+
+#include <QAbstractListModel>
+#include <QVector>
+
+/// Telemetry of all batteries of a vehicle as plain data, one row for each battery sorted by battery id. A
+/// BATTERY_STATUS updates its row in place and QML sees one dataChanged per message instead of a signal per value.
+/// VehicleBatteryFactGroup still publishes each battery as a fact group, decoded through decodeBatteryStatus.
+class VehicleBatteryStatusModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    VehicleBatteryStatusModel(QObject* parent = nullptr);
+
+    enum Roles {
+        BatteryIdRole = Qt::UserRole + 1,
+        FunctionRole,
+        TypeRole,
+        VoltageRole,
+        CurrentRole,
+        MahConsumedRole,
+        PercentRemainingRole,
+        TemperatureRole,
+        TimeRemainingRole,
+        ChargeStateRole,
+        InstantPowerRole,
+        CellCountRole,
+    };
+
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+    typedef struct {
+        uint8_t id                  = 0;
+        uint8_t function            = MAV_BATTERY_FUNCTION_UNKNOWN;
+        uint8_t type                = MAV_BATTERY_TYPE_UNKNOWN;
+        uint8_t chargeState         = MAV_BATTERY_CHARGE_STATE_UNDEFINED;
+        int     cellCount           = 0;
+        double  voltage             = qQNaN();  ///< Volts, sum of the cells
+        double  current             = qQNaN();  ///< Amps
+        double  mahConsumed         = qQNaN();
+        double  percentRemaining    = qQNaN();
+        double  temperature         = qQNaN();  ///< Degrees Celsius
+        double  timeRemaining       = qQNaN();  ///< Seconds
+        double  instantPower        = qQNaN();  ///< Watts
+    } BatteryState_t;
+
+    int                     count       (void) const { return _batteries.count(); }
+    const BatteryState_t&   batteryAt   (int index) const { return _batteries[index]; }
+
+    /// @return nullptr if no message for the battery id arrived yet
+    const BatteryState_t*   battery     (uint8_t batteryId) const;
+
+    /// Updates the rows from BATTERY_STATUS, HIGH_LATENCY and HIGH_LATENCY2, other messages are ignored
+    void handleMessage(const mavlink_message_t& message);
+
+    void clear(void);
+
+    /// Fills all fields from the message, invalid values become NaN
+    static void decodeBatteryStatus(const mavlink_battery_status_t& batteryStatus, BatteryState_t& battery);
+
+    // QAbstractListModel overrides
+    int                     rowCount    (const QModelIndex& parent = QModelIndex()) const override;
+    QVariant                data        (const QModelIndex& index, int role) const override;
+    QHash<int, QByteArray>  roleNames   (void) const override;
+
+signals:
+    void countChanged(void);
+
+private:
+    /// @return Row of the battery, added in battery id order if not there yet
+    int  _findOrAddRow          (uint8_t batteryId);
+    /// High latency messages only carry the remaining charge, of battery 0
+    void _setPercentRemaining   (double percentRemaining);
+
+    QVector<BatteryState_t> _batteries;
+};
@@ -73,20 +73,20 @@ void VehicleEscStatusFactGroup::handleMessage(Vehicle* /* vehicle */, mavlink_me
     mavlink_esc_status_t content;
     mavlink_msg_esc_status_decode(&message, &content);
 
-    index()->setRawValue                        (content.index);
-
-    rpmFirst()->setRawValue                     (content.rpm[0]);
-    rpmSecond()->setRawValue                    (content.rpm[1]);
-    rpmThird()->setRawValue                     (content.rpm[2]);
-    rpmFourth()->setRawValue                    (content.rpm[3]);
-
-    currentFirst()->setRawValue                 (content.current[0]);
-    currentSecond()->setRawValue                (content.current[1]);
-    currentThird()->setRawValue                 (content.current[2]);
-    currentFourth()->setRawValue                (content.current[3]);
-
-    voltageFirst()->setRawValue                 (content.voltage[0]);
-    voltageSecond()->setRawValue                (content.voltage[1]);
-    voltageThird()->setRawValue                 (content.voltage[2]);
-    voltageFourth()->setRawValue                (content.voltage[3]);
+    _setFactValue(index(),                        content.index);
+
+    _setFactValue(rpmFirst(),                     content.rpm[0]);
+    _setFactValue(rpmSecond(),                    content.rpm[1]);
+    _setFactValue(rpmThird(),                     content.rpm[2]);
+    _setFactValue(rpmFourth(),                    content.rpm[3]);
+
+    _setFactValue(currentFirst(),                 content.current[0]);
+    _setFactValue(currentSecond(),                content.current[1]);
+    _setFactValue(currentThird(),                 content.current[2]);
+    _setFactValue(currentFourth(),                content.current[3]);
+
+    _setFactValue(voltageFirst(),                 content.voltage[0]);
+    _setFactValue(voltageSecond(),                content.voltage[1]);
+    _setFactValue(voltageThird(),                 content.voltage[2]);
+    _setFactValue(voltageFourth(),                content.voltage[3]);
 }
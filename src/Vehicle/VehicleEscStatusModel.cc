@@ -0,0 +1,187 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VehicleEscStatusModel.h"
+
+VehicleEscStatusModel::VehicleEscStatusModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+
+}
+
+void VehicleEscStatusModel::handleMessage(const mavlink_message_t& message)
+{
+    switch (message.msgid) {
+    case MAVLINK_MSG_ID_ESC_STATUS:
+        _handleEscStatus(message);
+        break;
+    case MAVLINK_MSG_ID_ESC_INFO:
+        _handleEscInfo(message);
+        break;
+    }
+}
+
+void VehicleEscStatusModel::_handleEscStatus(const mavlink_message_t& message)
+{
+    mavlink_esc_status_t escStatus;
+    mavlink_msg_esc_status_decode(&message, &escStatus);
+
+    const int first = escStatus.index;
+    const int rows  = _rowsFor(first);
+    if (rows == 0) {
+        return;
+    }
+    if (first + rows > _escs.count()) {
+        _resize(first + rows);
+    }
+
+    for (int i=0; i<rows; i++) {
+        EscState_t& esc = _escs[first + i];
+        esc.rpm     = escStatus.rpm[i];
+        esc.voltage = static_cast<double>(escStatus.voltage[i]);
+        esc.current = static_cast<double>(escStatus.current[i]);
+        if (!esc.infoReceived) {
+            esc.online = true;
+        }
+    }
+
+    emit dataChanged(createIndex(first, 0), createIndex(first + rows - 1, 0));
+}
+
+void VehicleEscStatusModel::_handleEscInfo(const mavlink_message_t& message)
+{
+    mavlink_esc_info_t escInfo;
+    mavlink_msg_esc_info_decode(&message, &escInfo);
+
+    // The count is the number of ESCs the vehicle has, rows past it were only there because ESC_STATUS comes in fours
+    const int reportedCount = qMin(static_cast<int>(escInfo.count), maxEscs);
+    if (reportedCount != 0 && reportedCount != _reportedCount) {
+        _reportedCount = reportedCount;
+        if (_escs.count() > _reportedCount) {
+            _resize(_reportedCount);
+        }
+    }
+
+    const int first = escInfo.index;
+    const int rows  = _rowsFor(first);
+    if (rows == 0) {
+        return;
+    }
+    if (first + rows > _escs.count()) {
+        _resize(first + rows);
+    }
+
+    for (int i=0; i<rows; i++) {
+        EscState_t& esc = _escs[first + i];
+        esc.online          = escInfo.info & (1 << i);
+        esc.errorCount      = escInfo.error_count[i];
+        esc.failureFlags    = escInfo.failure_flags[i];
+        esc.temperature     = escInfo.temperature[i] == INT16_MAX ? qQNaN() : static_cast<double>(escInfo.temperature[i]) / 100.0;
+        esc.infoReceived    = true;
+    }
+
+    emit dataChanged(createIndex(first, 0), createIndex(first + rows - 1, 0));
+}
+
+int VehicleEscStatusModel::_rowsFor(int index) const
+{
+    if (index < 0 || index >= maxEscs) {
+        return 0;
+    }
+
+    int end = qMin(index + escsPerMessage, maxEscs);
+    if (_reportedCount != 0) {
+        end = qMin(end, _reportedCount);
+    }
+
+    return qMax(0, end - index);
+}
+
+void VehicleEscStatusModel::_resize(int count)
+{
+    if (count > _escs.count()) {
+        beginInsertRows(QModelIndex(), _escs.count(), count - 1);
+        _escs.resize(count);
+        endInsertRows();
+    } else if (count < _escs.count()) {
+        beginRemoveRows(QModelIndex(), count, _escs.count() - 1);
+        _escs.resize(count);
+        endRemoveRows();
+    } else {
+        return;
+    }
+    emit countChanged();
+}
+
+void VehicleEscStatusModel::clear(void)
+{
+    _reportedCount = 0;
+    if (_escs.isEmpty()) {
+        return;
+    }
+    beginResetModel();
+    _escs.clear();
+    endResetModel();
+    emit countChanged();
+}
+
+int VehicleEscStatusModel::rowCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+    return _escs.count();
+}
+
+QVariant VehicleEscStatusModel::data(const QModelIndex& index, int role) const
+{
+    if (index.row() < 0 || index.row() >= _escs.count()) {
+        return QVariant();
+    }
+
+    const EscState_t& esc = _escs[index.row()];
+
+    switch (role) {
+    case EscIndexRole:
+        return index.row();
+    case RpmRole:
+        return esc.rpm;
+    case VoltageRole:
+        return esc.voltage;
+    case CurrentRole:
+        return esc.current;
+    case PowerRole:
+        return esc.voltage * esc.current;
+    case TemperatureRole:
+        return esc.temperature;
+    case ErrorCountRole:
+        return esc.errorCount;
+    case FailureFlagsRole:
+        return esc.failureFlags;
+    case OnlineRole:
+        return esc.online;
+    }
+
+    return QVariant();
+}
+
+QHash<int, QByteArray> VehicleEscStatusModel::roleNames(void) const
+{
+    QHash<int, QByteArray> roles;
+
+    roles[EscIndexRole]     = "escIndex";
+    roles[RpmRole]          = "rpm";
+    roles[VoltageRole]      = "voltage";
+    roles[CurrentRole]      = "current";
+    roles[PowerRole]        = "power";
+    roles[TemperatureRole]  = "temperature";
+    roles[ErrorCountRole]   = "errorCount";
+    roles[FailureFlagsRole] = "failureFlags";
+    roles[OnlineRole]       = "online";
+
+    return roles;
+}
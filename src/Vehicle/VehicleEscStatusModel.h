@@ -0,0 +1,81 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCMAVLink.h"
+
+#include <QAbstractListModel>
+#include <QVector>
+
+/// Telemetry of all ESCs of a vehicle as plain data, one row for each ESC. ESC_STATUS and ESC_INFO each carry four
+/// ESCs, a message updates its rows in place and QML sees one dataChanged per message instead of a signal per value,
+/// however many motors there are. VehicleEscStatusFactGroup still publishes the first four ESCs as Facts.
+class VehicleEscStatusModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    VehicleEscStatusModel(QObject* parent = nullptr);
+
+    enum Roles {
+        EscIndexRole = Qt::UserRole + 1,
+        RpmRole,
+        VoltageRole,
+        CurrentRole,
+        PowerRole,
+        TemperatureRole,
+        ErrorCountRole,
+        FailureFlagsRole,
+        OnlineRole,
+    };
+
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+    typedef struct {
+        double      rpm             = qQNaN();
+        double      voltage         = qQNaN();      ///< Volts
+        double      current         = qQNaN();      ///< Amps
+        double      temperature     = qQNaN();      ///< Degrees Celsius
+        uint32_t    errorCount      = 0;
+        uint16_t    failureFlags    = 0;            ///< ESC_FAILURE_FLAGS
+        bool        online          = false;        ///< Reported online by ESC_INFO, true until then once ESC_STATUS arrives
+        bool        infoReceived    = false;
+    } EscState_t;
+
+    int                 count   (void) const { return _escs.count(); }
+    const EscState_t&   escAt   (int index) const { return _escs[index]; }
+
+    /// Updates the rows from ESC_STATUS and ESC_INFO, other messages are ignored
+    void handleMessage(const mavlink_message_t& message);
+
+    void clear(void);
+
+    // QAbstractListModel overrides
+    int                     rowCount    (const QModelIndex& parent = QModelIndex()) const override;
+    QVariant                data        (const QModelIndex& index, int role) const override;
+    QHash<int, QByteArray>  roleNames   (void) const override;
+
+    static const int escsPerMessage = 4;
+    static const int maxEscs        = 32;
+
+signals:
+    void countChanged(void);
+
+private:
+    void _handleEscStatus   (const mavlink_message_t& message);
+    void _handleEscInfo     (const mavlink_message_t& message);
+    /// Adds or removes rows so there are count of them
+    void _resize            (int count);
+    /// @return Number of rows the message with the first ESC at index fills, 0 if it is out of range
+    int  _rowsFor           (int index) const;
+
+    QVector<EscState_t> _escs;
+    int                 _reportedCount = 0;     ///< ESC count from ESC_INFO, 0 until it arrives
+};
@@ -85,26 +85,26 @@ void VehicleEstimatorStatusFactGroup::handleMessage(Vehicle* /* vehicle */, mavl
     mavlink_estimator_status_t estimatorStatus;
     mavlink_msg_estimator_status_decode(&message, &estimatorStatus);
 
-    goodAttitudeEstimate()->setRawValue         (!!(estimatorStatus.flags & ESTIMATOR_ATTITUDE));
-    goodHorizVelEstimate()->setRawValue         (!!(estimatorStatus.flags & ESTIMATOR_VELOCITY_HORIZ));
-    goodVertVelEstimate()->setRawValue          (!!(estimatorStatus.flags & ESTIMATOR_VELOCITY_VERT));
-    goodHorizPosRelEstimate()->setRawValue      (!!(estimatorStatus.flags & ESTIMATOR_POS_HORIZ_REL));
-    goodHorizPosAbsEstimate()->setRawValue      (!!(estimatorStatus.flags & ESTIMATOR_POS_HORIZ_ABS));
-    goodVertPosAbsEstimate()->setRawValue       (!!(estimatorStatus.flags & ESTIMATOR_POS_VERT_ABS));
-    goodVertPosAGLEstimate()->setRawValue       (!!(estimatorStatus.flags & ESTIMATOR_POS_VERT_AGL));
-    goodConstPosModeEstimate()->setRawValue     (!!(estimatorStatus.flags & ESTIMATOR_CONST_POS_MODE));
-    goodPredHorizPosRelEstimate()->setRawValue  (!!(estimatorStatus.flags & ESTIMATOR_PRED_POS_HORIZ_REL));
-    goodPredHorizPosAbsEstimate()->setRawValue  (!!(estimatorStatus.flags & ESTIMATOR_PRED_POS_HORIZ_ABS));
-    gpsGlitch()->setRawValue                    (estimatorStatus.flags & ESTIMATOR_GPS_GLITCH ? true : false);
-    accelError()->setRawValue                   (!!(estimatorStatus.flags & ESTIMATOR_ACCEL_ERROR));
-    velRatio()->setRawValue                     (estimatorStatus.vel_ratio);
-    horizPosRatio()->setRawValue                (estimatorStatus.pos_horiz_ratio);
-    vertPosRatio()->setRawValue                 (estimatorStatus.pos_vert_ratio);
-    magRatio()->setRawValue                     (estimatorStatus.mag_ratio);
-    haglRatio()->setRawValue                    (estimatorStatus.hagl_ratio);
-    tasRatio()->setRawValue                     (estimatorStatus.tas_ratio);
-    horizPosAccuracy()->setRawValue             (estimatorStatus.pos_horiz_accuracy);
-    vertPosAccuracy()->setRawValue              (estimatorStatus.pos_vert_accuracy);
+    _setFactValue(goodAttitudeEstimate(),         !!(estimatorStatus.flags & ESTIMATOR_ATTITUDE));
+    _setFactValue(goodHorizVelEstimate(),         !!(estimatorStatus.flags & ESTIMATOR_VELOCITY_HORIZ));
+    _setFactValue(goodVertVelEstimate(),          !!(estimatorStatus.flags & ESTIMATOR_VELOCITY_VERT));
+    _setFactValue(goodHorizPosRelEstimate(),      !!(estimatorStatus.flags & ESTIMATOR_POS_HORIZ_REL));
+    _setFactValue(goodHorizPosAbsEstimate(),      !!(estimatorStatus.flags & ESTIMATOR_POS_HORIZ_ABS));
+    _setFactValue(goodVertPosAbsEstimate(),       !!(estimatorStatus.flags & ESTIMATOR_POS_VERT_ABS));
+    _setFactValue(goodVertPosAGLEstimate(),       !!(estimatorStatus.flags & ESTIMATOR_POS_VERT_AGL));
+    _setFactValue(goodConstPosModeEstimate(),     !!(estimatorStatus.flags & ESTIMATOR_CONST_POS_MODE));
+    _setFactValue(goodPredHorizPosRelEstimate(),  !!(estimatorStatus.flags & ESTIMATOR_PRED_POS_HORIZ_REL));
+    _setFactValue(goodPredHorizPosAbsEstimate(),  !!(estimatorStatus.flags & ESTIMATOR_PRED_POS_HORIZ_ABS));
+    _setFactValue(gpsGlitch(),                    estimatorStatus.flags & ESTIMATOR_GPS_GLITCH ? true : false);
+    _setFactValue(accelError(),                   !!(estimatorStatus.flags & ESTIMATOR_ACCEL_ERROR));
+    _setFactValue(velRatio(),                     estimatorStatus.vel_ratio);
+    _setFactValue(horizPosRatio(),                estimatorStatus.pos_horiz_ratio);
+    _setFactValue(vertPosRatio(),                 estimatorStatus.pos_vert_ratio);
+    _setFactValue(magRatio(),                     estimatorStatus.mag_ratio);
+    _setFactValue(haglRatio(),                    estimatorStatus.hagl_ratio);
+    _setFactValue(tasRatio(),                     estimatorStatus.tas_ratio);
+    _setFactValue(horizPosAccuracy(),             estimatorStatus.pos_horiz_accuracy);
+    _setFactValue(vertPosAccuracy(),              estimatorStatus.pos_vert_accuracy);
 
     _setTelemetryAvailable(true);
 }
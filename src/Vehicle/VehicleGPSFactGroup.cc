@@ -70,14 +70,22 @@ void VehicleGPSFactGroup::_handleGpsRawInt(mavlink_message_t& message)
     mavlink_gps_raw_int_t gpsRawInt;
     mavlink_msg_gps_raw_int_decode(&message, &gpsRawInt);
 
-    lat()->setRawValue              (gpsRawInt.lat * 1e-7);
-    lon()->setRawValue              (gpsRawInt.lon * 1e-7);
-    mgrs()->setRawValue             (convertGeoToMGRS(QGeoCoordinate(gpsRawInt.lat * 1e-7, gpsRawInt.lon * 1e-7)));
-    count()->setRawValue            (gpsRawInt.satellites_visible == 255 ? 0 : gpsRawInt.satellites_visible);
-    hdop()->setRawValue             (gpsRawInt.eph == UINT16_MAX ? qQNaN() : gpsRawInt.eph / 100.0);
-    vdop()->setRawValue             (gpsRawInt.epv == UINT16_MAX ? qQNaN() : gpsRawInt.epv / 100.0);
-    courseOverGround()->setRawValue (gpsRawInt.cog == UINT16_MAX ? qQNaN() : gpsRawInt.cog / 100.0);
-    lock()->setRawValue             (gpsRawInt.fix_type);
+    // GPS_RAW_INT can come in at high rate so this uses the numeric fast path, and only redoes the MGRS
+    // conversion when the position actually changed
+    bool positionChanged = gpsRawInt.lat != _lastRawLat || gpsRawInt.lon != _lastRawLon;
+    _lastRawLat = gpsRawInt.lat;
+    _lastRawLon = gpsRawInt.lon;
+
+    lat()->setRawValueTyped             (gpsRawInt.lat * 1e-7);
+    lon()->setRawValueTyped             (gpsRawInt.lon * 1e-7);
+    if (positionChanged) {
+        mgrs()->setRawValue             (convertGeoToMGRS(QGeoCoordinate(gpsRawInt.lat * 1e-7, gpsRawInt.lon * 1e-7)));
+    }
+    count()->setRawValueTyped           (gpsRawInt.satellites_visible == 255 ? 0 : gpsRawInt.satellites_visible);
+    hdop()->setRawValueTyped            (gpsRawInt.eph == UINT16_MAX ? qQNaN() : gpsRawInt.eph / 100.0);
+    vdop()->setRawValueTyped            (gpsRawInt.epv == UINT16_MAX ? qQNaN() : gpsRawInt.epv / 100.0);
+    courseOverGround()->setRawValueTyped(gpsRawInt.cog == UINT16_MAX ? qQNaN() : gpsRawInt.cog / 100.0);
+    lock()->setRawValueTyped            (gpsRawInt.fix_type);
 }
 
 void VehicleGPSFactGroup::_handleHighLatency(mavlink_message_t& message)
@@ -98,6 +106,7 @@ void VehicleGPSFactGroup::_handleHighLatency(mavlink_message_t& message)
     lat()->setRawValue  (coordinate.latitude);
     lon()->setRawValue  (coordinate.longitude);
     mgrs()->setRawValue (convertGeoToMGRS(QGeoCoordinate(coordinate.latitude, coordinate.longitude)));
+    _lastRawLat = INT32_MAX;
     count()->setRawValue(0);
 }
 
@@ -109,6 +118,7 @@ void VehicleGPSFactGroup::_handleHighLatency2(mavlink_message_t& message)
     lat()->setRawValue  (highLatency2.latitude * 1e-7);
     lon()->setRawValue  (highLatency2.longitude * 1e-7);
     mgrs()->setRawValue (convertGeoToMGRS(QGeoCoordinate(highLatency2.latitude * 1e-7, highLatency2.longitude * 1e-7)));
+    _lastRawLat = INT32_MAX;
     count()->setRawValue(0);
     hdop()->setRawValue (highLatency2.eph == UINT8_MAX ? qQNaN() : highLatency2.eph / 10.0);
     vdop()->setRawValue (highLatency2.epv == UINT8_MAX ? qQNaN() : highLatency2.epv / 10.0);
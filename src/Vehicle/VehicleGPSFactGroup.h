@@ -62,4 +62,7 @@ private:
     Fact _courseOverGroundFact;
     Fact _countFact;
     Fact _lockFact;
+
+    int32_t _lastRawLat = INT32_MAX;    ///< Position of the last GPS_RAW_INT which updated mgrs, INT32_MAX for none
+    int32_t _lastRawLon = INT32_MAX;
 };
@@ -12,9 +12,38 @@
 #include "QGCLoggingCategory.h"
 #include "LinkManager.h"
 #include "QGCApplication.h"
+#include "MessageRateManager.h"
 
 QGC_LOGGING_CATEGORY(VehicleLinkManagerLog, "VehicleLinkManagerLog")
 
+const char* VehicleLinkManager::fullTelemetryProfileName           = "Full";
+const char* VehicleLinkManager::lowBandwidthTelemetryProfileName   = "LowBandwidth";
+const char* VehicleLinkManager::highLatencyTelemetryProfileName    = "HighLatency";
+
+/// Caps for the messages which take up most of a telemetry radio
+static QHash<int, double> _lowBandwidthRateLimits(void)
+{
+    return {
+        { MAVLINK_MSG_ID_ATTITUDE,                      4 },
+        { MAVLINK_MSG_ID_ATTITUDE_QUATERNION,           4 },
+        { MAVLINK_MSG_ID_GLOBAL_POSITION_INT,           3 },
+        { MAVLINK_MSG_ID_LOCAL_POSITION_NED,            2 },
+        { MAVLINK_MSG_ID_VFR_HUD,                       2 },
+        { MAVLINK_MSG_ID_ATTITUDE_TARGET,               2 },
+        { MAVLINK_MSG_ID_POSITION_TARGET_LOCAL_NED,     1 },
+        { MAVLINK_MSG_ID_POSITION_TARGET_GLOBAL_INT,    1 },
+        { MAVLINK_MSG_ID_SERVO_OUTPUT_RAW,              1 },
+        { MAVLINK_MSG_ID_RC_CHANNELS,                   1 },
+        { MAVLINK_MSG_ID_HIGHRES_IMU,                   1 },
+        { MAVLINK_MSG_ID_RAW_IMU,                       1 },
+        { MAVLINK_MSG_ID_SCALED_IMU,                    1 },
+        { MAVLINK_MSG_ID_ACTUATOR_CONTROL_TARGET,       1 },
+        { MAVLINK_MSG_ID_ODOMETRY,                      1 },
+        { MAVLINK_MSG_ID_ESTIMATOR_STATUS,              1 },
+        { MAVLINK_MSG_ID_VIBRATION,                     1 },
+    };
+}
+
 VehicleLinkManager::VehicleLinkManager(Vehicle* vehicle)
     : QObject   (vehicle)
     , _vehicle  (vehicle)
@@ -22,13 +51,24 @@ VehicleLinkManager::VehicleLinkManager(Vehicle* vehicle)
 {
     connect(this,                   &VehicleLinkManager::linkNamesChanged,  this, &VehicleLinkManager::linkStatusesChanged);
     connect(&_commLostCheckTimer,   &QTimer::timeout,                       this, &VehicleLinkManager::_commLostCheck);
+    connect(this,                   &VehicleLinkManager::primaryLinkChanged, this, &VehicleLinkManager::_updateTelemetryProfile);
 
     _commLostCheckTimer.setSingleShot(false);
     _commLostCheckTimer.setInterval(_commLostCheckTimeoutMSecs);
+    _accountingTimer.start();
+    _bondingClock.start();
 }
 
-void VehicleLinkManager::mavlinkMessageReceived(LinkInterface* link, mavlink_message_t message)
+bool VehicleLinkManager::mavlinkMessageReceived(LinkInterface* link, const mavlink_message_t& message)
 {
+    bool deliver = true;
+
+    if (link == _primaryLink.lock().get()) {
+        MessageCount_t& messageCount = _messageCounts[static_cast<int>(message.msgid)];
+        messageCount.bytes += message.len + MAVLINK_NUM_NON_PAYLOAD_BYTES + (message.incompat_flags & MAVLINK_IFLAG_SIGNED ? MAVLINK_SIGNATURE_BLOCK_LEN : 0);
+        messageCount.count++;
+    }
+
     // Radio status messages come from Sik Radios directly. It doesn't indicate there is any life on the other end.
     if (message.msgid != MAVLINK_MSG_ID_RADIO_STATUS) {
         int linkIndex = _containsLinkIndex(link);
@@ -37,11 +77,63 @@ void VehicleLinkManager::mavlinkMessageReceived(LinkInterface* link, mavlink_mes
         } else {
             LinkInfo_t& linkInfo = _rgLinkInfo[linkIndex];
             linkInfo.heartbeatElapsedTimer.restart();
+            _updateLinkLoss(linkInfo, message);
+
+            // With a single link there is nothing to suppress, so that case costs nothing
+            if (_bonding && _rgLinkInfo.count() > 1) {
+                qint64 nowMSecs = _bondingClock.elapsed();
+                qint64 firstSeenMSecs;
+                deliver = !_duplicateFilter.isDuplicate(message, nowMSecs, firstSeenMSecs);
+                linkInfo.latencyMSecs += (nowMSecs - firstSeenMSecs - linkInfo.latencyMSecs) * _linkQualitySmoothing;
+            }
+
             if (_rgLinkInfo[linkIndex].commLost) {
                 _commRegainedOnLink(link);
             }
         }
     }
+
+    return deliver;
+}
+
+/// Loss is worked out from gaps in the sequence numbers of the default component, which the vehicle numbers for each link
+void VehicleLinkManager::_updateLinkLoss(LinkInfo_t& linkInfo, const mavlink_message_t& message)
+{
+    if (message.compid != _vehicle->defaultComponentId()) {
+        return;
+    }
+
+    if (linkInfo.nextSeq != -1) {
+        uint8_t gap = static_cast<uint8_t>(message.seq - linkInfo.nextSeq);
+        if (gap > 128) {
+            // Sequence went backwards, a repeat rather than loss
+            return;
+        }
+        linkInfo.lostCount += gap;
+    }
+    linkInfo.nextSeq = static_cast<uint8_t>(message.seq + 1);
+    linkInfo.receivedCount++;
+}
+
+void VehicleLinkManager::_updateLinkQuality(void)
+{
+    for (LinkInfo_t& linkInfo: _rgLinkInfo) {
+        quint32 expectedCount = linkInfo.receivedCount + linkInfo.lostCount;
+        if (expectedCount) {
+            double lossPercent = linkInfo.lostCount * 100.0 / expectedCount;
+            linkInfo.lossPercent += (lossPercent - linkInfo.lossPercent) * _linkQualitySmoothing;
+        }
+        linkInfo.receivedCount  = 0;
+        linkInfo.lostCount      = 0;
+
+        qCDebug(VehicleLinkManagerLog) << "Link quality" << linkInfo.link->linkConfiguration()->name() << "latency msecs" << linkInfo.latencyMSecs << "loss percent" << linkInfo.lossPercent;
+    }
+}
+
+/// Lower is better
+double VehicleLinkManager::_linkCost(const LinkInfo_t& linkInfo)
+{
+    return linkInfo.latencyMSecs + linkInfo.lossPercent * _lossPercentCostMSecs;
 }
 
 void VehicleLinkManager::_commRegainedOnLink(LinkInterface* link)
@@ -102,6 +194,9 @@ void VehicleLinkManager::_commLostCheck(void)
 {
     QString switchingPrimaryLinkMessage;
 
+    _updateTelemetryAccounting();
+    _updateLinkQuality();
+
     if (!_communicationLostEnabled) {
         return;
     }
@@ -256,16 +351,19 @@ WeakLinkInterfacePtr VehicleLinkManager::_bestActivePrimaryLink(void)
     }
 #endif
 
-    // Next best is normal latency link
+    // Next best is the normal latency link with the least measured latency and loss
+    const LinkInfo_t* bestLinkInfo = nullptr;
     for (const LinkInfo_t& linkInfo: _rgLinkInfo) {
         if (!linkInfo.commLost) {
-            SharedLinkInterfacePtr      link    = linkInfo.link;
-            SharedLinkConfigurationPtr  config  = link->linkConfiguration();
-            if (config && !config->isHighLatency()) {
-                return link;
+            SharedLinkConfigurationPtr config = linkInfo.link->linkConfiguration();
+            if (config && !config->isHighLatency() && (!bestLinkInfo || _linkCost(linkInfo) < _linkCost(*bestLinkInfo))) {
+                bestLinkInfo = &linkInfo;
             }
         }
     }
+    if (bestLinkInfo) {
+        return bestLinkInfo->link;
+    }
 
     // Last possible choice is a high latency link
     if (!_primaryLink.expired() && _primaryLink.lock().get()->linkConfiguration()->isHighLatency()) {
@@ -347,6 +445,56 @@ void VehicleLinkManager::setCommunicationLostEnabled(bool communicationLostEnabl
     }
 }
 
+void VehicleLinkManager::setBonding(bool bonding)
+{
+    if (_bonding != bonding) {
+        _bonding = bonding;
+        _duplicateFilter.clear();
+        emit bondingChanged(bonding);
+    }
+}
+
+void VehicleLinkManager::setBondedCommands(bool bondedCommands)
+{
+    if (_bondedCommands != bondedCommands) {
+        _bondedCommands = bondedCommands;
+        emit bondedCommandsChanged(bondedCommands);
+    }
+}
+
+bool VehicleLinkManager::isCriticalCommand(MAV_CMD command)
+{
+    switch (command) {
+    case MAV_CMD_COMPONENT_ARM_DISARM:
+    case MAV_CMD_DO_FLIGHTTERMINATION:
+    case MAV_CMD_DO_PARACHUTE:
+    case MAV_CMD_DO_SET_MODE:
+    case MAV_CMD_DO_PAUSE_CONTINUE:
+    case MAV_CMD_NAV_RETURN_TO_LAUNCH:
+    case MAV_CMD_NAV_LAND:
+        return true;
+    default:
+        return false;
+    }
+}
+
+QList<SharedLinkInterfacePtr> VehicleLinkManager::bondedCommandLinks(MAV_CMD command) const
+{
+    QList<SharedLinkInterfacePtr> links;
+
+    if (_bonding && _bondedCommands && isCriticalCommand(command)) {
+        SharedLinkInterfacePtr primaryLink = _primaryLink.lock();
+        for (const LinkInfo_t& linkInfo: _rgLinkInfo) {
+            // High latency links are left out, every message over them costs
+            if (!linkInfo.commLost && linkInfo.link != primaryLink && !linkInfo.link->linkConfiguration()->isHighLatency()) {
+                links.append(linkInfo.link);
+            }
+        }
+    }
+
+    return links;
+}
+
 bool VehicleLinkManager::containsLink(LinkInterface* link)
 {
     return _containsLinkIndex(link) != -1;
@@ -402,3 +550,108 @@ bool VehicleLinkManager::primaryLinkIsPX4Flow(void) const
         return _primaryLink.lock()->isPX4Flow();
     }
 }
+
+VehicleLinkManager::TelemetryProfile_t VehicleLinkManager::telemetryProfileForLink(LinkInterface* link)
+{
+    TelemetryProfile_t profile;
+
+    profile.name                    = fullTelemetryProfileName;
+    profile.bandwidthBytesPerSec    = 0;
+    profile.messageIntervals        = true;
+
+    SharedLinkConfigurationPtr config = link ? link->linkConfiguration() : nullptr;
+    if (!config) {
+        return profile;
+    }
+
+    if (config->isHighLatency()) {
+        // The vehicle only sends HIGH_LATENCY2 over the link, every command sent costs
+        profile.name                    = highLatencyTelemetryProfileName;
+        profile.bandwidthBytesPerSec    = _highLatencyBudgetBytesPerSec;
+        profile.messageIntervals        = false;
+        return profile;
+    }
+
+#ifndef NO_SERIAL_LINK
+    SerialConfiguration* serialConfig = qobject_cast<SerialConfiguration*>(config.get());
+    if (serialConfig && !serialConfig->usbDirect() && serialConfig->baud() <= _lowBandwidthMaxBaud) {
+        // 8N1, ten bits on the wire for each byte
+        profile.name                    = lowBandwidthTelemetryProfileName;
+        profile.bandwidthBytesPerSec    = serialConfig->baud() / 10;
+        profile.messageRateLimits       = _lowBandwidthRateLimits();
+    }
+#endif
+
+    return profile;
+}
+
+void VehicleLinkManager::_updateTelemetryProfile(void)
+{
+    TelemetryProfile_t profile = telemetryProfileForLink(_primaryLink.lock().get());
+
+    if (profile.name == _telemetryProfile.name && profile.bandwidthBytesPerSec == _telemetryProfile.bandwidthBytesPerSec) {
+        return;
+    }
+
+    qCDebug(VehicleLinkManagerLog) << "Telemetry profile" << profile.name << "budget" << profile.bandwidthBytesPerSec;
+
+    _telemetryProfile   = profile;
+    _overBudgetReported = false;
+    _messageCounts.clear();
+    _accountingTimer.restart();
+
+    // Limits of the previous profile go, the new ones kick in once the messages are seen above them
+    _activeRateLimits.clear();
+    MessageRateManager* messageRateManager = _vehicle->messageRateManager();
+    if (messageRateManager) {
+        messageRateManager->setMessageIntervalsEnabled(profile.messageIntervals);
+        messageRateManager->setMessageRateLimits(_activeRateLimits);
+    }
+
+    emit telemetryProfileChanged();
+}
+
+void VehicleLinkManager::_updateTelemetryAccounting(void)
+{
+    const qint64 elapsedMSecs = _accountingTimer.restart();
+    if (elapsedMSecs <= 0) {
+        return;
+    }
+
+    QHash<int, double>  activeRateLimits    = _activeRateLimits;
+    int                 bytesPerSecond      = 0;
+
+    _messageBytesPerSecond.clear();
+    for (auto it = _messageCounts.constBegin(); it != _messageCounts.constEnd(); ++it) {
+        const int       messageBytesPerSecond   = static_cast<int>(it.value().bytes * 1000 / elapsedMSecs);
+        const double    messageHz               = it.value().count * 1000.0 / elapsedMSecs;
+
+        _messageBytesPerSecond[it.key()] = messageBytesPerSecond;
+        bytesPerSecond += messageBytesPerSecond;
+
+        // Some slack for jitter, messages right at their limit are left alone
+        auto limitIt = _telemetryProfile.messageRateLimits.constFind(it.key());
+        if (limitIt != _telemetryProfile.messageRateLimits.constEnd() && messageHz > limitIt.value() * 1.2) {
+            activeRateLimits[it.key()] = limitIt.value();
+        }
+    }
+    _messageCounts.clear();
+
+    if (activeRateLimits != _activeRateLimits) {
+        qCDebug(VehicleLinkManagerLog) << "Downsampling" << activeRateLimits.keys() << "for the" << _telemetryProfile.name << "profile";
+        _activeRateLimits = activeRateLimits;
+        if (_vehicle->messageRateManager()) {
+            _vehicle->messageRateManager()->setMessageRateLimits(_activeRateLimits);
+        }
+    }
+
+    if (bytesPerSecond != _telemetryBytesPerSecond) {
+        _telemetryBytesPerSecond = bytesPerSecond;
+        emit telemetryBytesPerSecondChanged(bytesPerSecond);
+    }
+
+    if (_telemetryProfile.bandwidthBytesPerSec > 0 && bytesPerSecond > _telemetryProfile.bandwidthBytesPerSec && !_overBudgetReported) {
+        qCWarning(VehicleLinkManagerLog) << "Telemetry over budget" << _telemetryProfile.name << bytesPerSecond << "bytes/sec, budget" << _telemetryProfile.bandwidthBytesPerSec;
+        _overBudgetReported = true;
+    }
+}
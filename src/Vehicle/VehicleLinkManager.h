@@ -14,9 +14,11 @@
 #include <QDebug>
 #include <QLoggingCategory>
 #include <QElapsedTimer>
+#include <QHash>
 
 #include "QGCMAVLink.h"
 #include "LinkInterface.h"
+#include "MessageDuplicateFilter.h"
 
 Q_DECLARE_LOGGING_CATEGORY(VehicleLinkManagerLog)
 
@@ -34,6 +36,14 @@ class VehicleLinkManager : public QObject
 public:
     VehicleLinkManager(Vehicle* vehicle);
 
+    /// What telemetry is asked for over the primary link
+    typedef struct {
+        QString             name;
+        int                 bandwidthBytesPerSec;   ///< Telemetry budget of the link, 0 for no limit
+        bool                messageIntervals;       ///< false: Message rate changes are not sent over the link
+        QHash<int, double>  messageRateLimits;      ///< Cap for messages seen faster than this on the link, key: message id
+    } TelemetryProfile_t;
+
     Q_PROPERTY(bool             primaryLinkIsPX4Flow        READ primaryLinkIsPX4Flow                                           NOTIFY primaryLinkChanged)
     Q_PROPERTY(QString          primaryLinkName             READ primaryLinkName            WRITE setPrimaryLinkByName          NOTIFY primaryLinkChanged)
     Q_PROPERTY(QStringList      linkNames                   READ linkNames                                                      NOTIFY linkNamesChanged)
@@ -41,9 +51,15 @@ public:
     Q_PROPERTY(bool             communicationLost           READ communicationLost                                              NOTIFY communicationLostChanged)
     Q_PROPERTY(bool             communicationLostEnabled    READ communicationLostEnabled   WRITE setCommunicationLostEnabled   NOTIFY communicationLostEnabledChanged)
     Q_PROPERTY(bool             autoDisconnect              MEMBER _autoDisconnect                                              NOTIFY autoDisconnectChanged)
+    Q_PROPERTY(QString          telemetryProfileName        READ telemetryProfileName                                           NOTIFY telemetryProfileChanged)
+    Q_PROPERTY(int              telemetryBudgetBytesPerSecond READ telemetryBudgetBytesPerSecond                                NOTIFY telemetryProfileChanged)
+    Q_PROPERTY(int              telemetryBytesPerSecond     READ telemetryBytesPerSecond                                        NOTIFY telemetryBytesPerSecondChanged)
+    Q_PROPERTY(bool             bonding                     READ bonding                    WRITE setBonding                    NOTIFY bondingChanged)          ///< true: copies of a message arriving over more than one link are dropped
+    Q_PROPERTY(bool             bondedCommands              READ bondedCommands             WRITE setBondedCommands             NOTIFY bondedCommandsChanged)   ///< true: critical commands are sent over all active links while bonding
 
     bool                    primaryLinkIsPX4Flow        (void) const;
-    void                    mavlinkMessageReceived      (LinkInterface* link, mavlink_message_t message);
+    /// @return false: copy of a message already received over another link, it should be dropped
+    bool                    mavlinkMessageReceived      (LinkInterface* link, const mavlink_message_t& message);
     bool                    containsLink                (LinkInterface* link);
     WeakLinkInterfacePtr    primaryLink                 (void) { return _primaryLink; }
     QString                 primaryLinkName             (void) const;
@@ -54,6 +70,31 @@ public:
     void                    setPrimaryLinkByName        (const QString& name);
     void                    setCommunicationLostEnabled (bool communicationLostEnabled);
     void                    closeVehicle                (void);
+    bool                    bonding                     (void) const { return _bonding; }
+    bool                    bondedCommands              (void) const { return _bondedCommands; }
+    void                    setBonding                  (bool bonding);
+    void                    setBondedCommands           (bool bondedCommands);
+
+    /// @return Active links other than the primary which the command should also be sent over, empty unless bonded
+    QList<SharedLinkInterfacePtr> bondedCommandLinks    (MAV_CMD command) const;
+
+    /// @return true: losing the command would be dangerous, so bonding sends it over every link
+    static bool             isCriticalCommand           (MAV_CMD command);
+
+    const TelemetryProfile_t&   telemetryProfile                (void) const { return _telemetryProfile; }
+    QString                     telemetryProfileName            (void) const { return _telemetryProfile.name; }
+    int                         telemetryBudgetBytesPerSecond   (void) const { return _telemetryProfile.bandwidthBytesPerSec; }
+    int                         telemetryBytesPerSecond         (void) const { return _telemetryBytesPerSecond; }
+
+    /// Bytes per second received on the primary link over the last second, key: message id
+    QHash<int, int>             messageBytesPerSecond           (void) const { return _messageBytesPerSecond; }
+
+    /// @return Profile for telemetry over the link, the full profile for no link
+    static TelemetryProfile_t   telemetryProfileForLink         (LinkInterface* link);
+
+    static const char* fullTelemetryProfileName;
+    static const char* lowBandwidthTelemetryProfileName;
+    static const char* highLatencyTelemetryProfileName;
 
 signals:
     void primaryLinkChanged             (void);
@@ -63,9 +104,14 @@ signals:
     void linkNamesChanged               (void);
     void linkStatusesChanged            (void);
     void autoDisconnectChanged          (bool autoDisconnect);
+    void telemetryProfileChanged        (void);
+    void telemetryBytesPerSecondChanged (int bytesPerSecond);
+    void bondingChanged                 (bool bonding);
+    void bondedCommandsChanged          (bool bondedCommands);
 
 private slots:
-    void _commLostCheck(void);
+    void _commLostCheck             (void);
+    void _updateTelemetryProfile    (void);
 
 private:
     int                     _containsLinkIndex      (LinkInterface* link);
@@ -75,13 +121,23 @@ private:
     bool                    _updatePrimaryLink      (void);
     WeakLinkInterfacePtr    _bestActivePrimaryLink  (void);
     void                    _commRegainedOnLink     (LinkInterface*  link);
+    void                    _updateTelemetryAccounting(void);
 
     typedef struct LinkInfo {
         SharedLinkInterfacePtr  link;
         bool                    commLost = false;
         QElapsedTimer           heartbeatElapsedTimer;
+        double                  latencyMSecs    = 0;    ///< Smoothed delay behind the first copy of each message over any link
+        double                  lossPercent     = 0;    ///< Smoothed loss of messages from the default component
+        int                     nextSeq         = -1;
+        quint32                 receivedCount   = 0;    ///< Since the last comm lost check
+        quint32                 lostCount       = 0;
     } LinkInfo_t;
 
+    void                    _updateLinkLoss         (LinkInfo_t& linkInfo, const mavlink_message_t& message);
+    void                    _updateLinkQuality      (void);
+    static double           _linkCost               (const LinkInfo_t& linkInfo);
+
     Vehicle*                _vehicle                    = nullptr;
     LinkManager*            _linkMgr                    = nullptr;
     QTimer                  _commLostCheckTimer;
@@ -91,6 +147,29 @@ private:
     bool                    _communicationLostEnabled   = true;
     bool                    _autoDisconnect             = false;    ///< true: Automatically disconnect vehicle when last connection goes away or lost heartbeat
 
+    typedef struct {
+        quint32 bytes = 0;
+        quint32 count = 0;
+    } MessageCount_t;
+
+    TelemetryProfile_t          _telemetryProfile           = telemetryProfileForLink(nullptr);
+    QHash<int, MessageCount_t>  _messageCounts;                         ///< Primary link traffic since the last accounting, key: message id
+    QHash<int, int>             _messageBytesPerSecond;
+    int                         _telemetryBytesPerSecond    = 0;
+    QElapsedTimer               _accountingTimer;
+    QHash<int, double>          _activeRateLimits;                      ///< Profile limits of the messages which were seen above them
+    bool                        _overBudgetReported         = false;
+
+    bool                        _bonding                    = true;
+    bool                        _bondedCommands             = false;
+    MessageDuplicateFilter      _duplicateFilter;
+    QElapsedTimer               _bondingClock;
+
     static const int _commLostCheckTimeoutMSecs     = 1000;  // Check for comm lost once a second
     static const int _heartbeatMaxElpasedMSecs      = 3500;  // No heartbeat for longer than this indicates comm loss
+    static const int _lowBandwidthMaxBaud           = 57600; // Serial links up to this baud rate which aren't USB are radios
+    static const int _highLatencyBudgetBytesPerSec  = 20;    // Roughly a HIGH_LATENCY2 message every few seconds
+    static const int _lossPercentCostMSecs          = 10;    // Failover treats each percent of loss like this much latency
+
+    static constexpr double _linkQualitySmoothing   = 0.2;
 };
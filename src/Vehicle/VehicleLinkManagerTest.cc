@@ -13,6 +13,7 @@
 #include "LinkManager.h"
 #include "QGCApplication.h"
 #include "MultiSignalSpyV2.h"
+#include "MessageRateManager.h"
 
 const char* VehicleLinkManagerTest::_primaryLinkChangedSignalName               = "primaryLinkChanged";
 const char* VehicleLinkManagerTest::_allLinksRemovedSignalName                  = "allLinksRemoved";
@@ -308,6 +309,46 @@ void VehicleLinkManagerTest::_highLatencyLinkTest(void)
     spyTransmissionEnabledChanged.clear();
 }
 
+void VehicleLinkManagerTest::_telemetryProfileTest(void)
+{
+    SharedLinkConfigurationPtr  mockConfig1;
+    SharedLinkInterfacePtr      mockLink1;
+    SharedLinkConfigurationPtr  mockConfig2;
+    SharedLinkInterfacePtr      mockLink2;
+
+    QSignalSpy spyVehicleCreate(_multiVehicleMgr, &MultiVehicleManager::activeVehicleChanged);
+
+    _startMockLink(1, true /*highLatency*/, false /*incrementVehicleId*/, mockConfig1, mockLink1);
+    QCOMPARE(spyVehicleCreate.wait(1000), true);
+    Vehicle*            vehicle             = _multiVehicleMgr->activeVehicle();
+    VehicleLinkManager* vehicleLinkManager  = vehicle->vehicleLinkManager();
+    QVERIFY(vehicleLinkManager);
+
+    // High latency link: no message interval commands, they would all go over the expensive link
+    QCOMPARE(vehicleLinkManager->telemetryProfileName(), QString(VehicleLinkManager::highLatencyTelemetryProfileName));
+    QVERIFY(vehicleLinkManager->telemetryBudgetBytesPerSecond() > 0);
+    QVERIFY(!vehicle->messageRateManager()->messageIntervalsEnabled());
+
+    // Failover to a normal link brings the full profile
+    QSignalSpy spyProfileChanged(vehicleLinkManager, &VehicleLinkManager::telemetryProfileChanged);
+    _startMockLink(2, false /*highLatency*/, false /*incrementVehicleId*/, mockConfig2, mockLink2);
+    QTRY_COMPARE(spyProfileChanged.count(), 1);
+    QCOMPARE(vehicleLinkManager->telemetryProfileName(), QString(VehicleLinkManager::fullTelemetryProfileName));
+    QCOMPARE(vehicleLinkManager->telemetryBudgetBytesPerSecond(), 0);
+    QVERIFY(vehicle->messageRateManager()->messageIntervalsEnabled());
+    QVERIFY(vehicle->messageRateManager()->messageRateLimits().isEmpty());
+
+    // Traffic on the primary link is accounted for each message
+    QTRY_VERIFY_WITH_TIMEOUT(vehicleLinkManager->telemetryBytesPerSecond() > 0, VehicleLinkManager::_commLostCheckTimeoutMSecs * 3);
+    QVERIFY(vehicleLinkManager->messageBytesPerSecond().value(MAVLINK_MSG_ID_HEARTBEAT) > 0);
+
+    // And back to high latency once the normal link is lost
+    qobject_cast<MockLink*>(mockLink2.get())->setCommLost(true);
+    QTRY_COMPARE_WITH_TIMEOUT(spyProfileChanged.count(), 2, VehicleLinkManager::_heartbeatMaxElpasedMSecs * 2);
+    QCOMPARE(vehicleLinkManager->telemetryProfileName(), QString(VehicleLinkManager::highLatencyTelemetryProfileName));
+    QVERIFY(!vehicle->messageRateManager()->messageIntervalsEnabled());
+}
+
 void VehicleLinkManagerTest::_startMockLink(int mockIndex, bool highLatency, bool incrementVehicleId, SharedLinkConfigurationPtr& mockConfig, SharedLinkInterfacePtr& mockLink)
 {
     MockConfiguration* pMockConfig = new MockConfiguration(QStringLiteral("Mock %1").arg(mockIndex));
@@ -10,6 +10,9 @@
 #include "Vehicle.h"
 #include "VehicleObjectAvoidance.h"
 #include "ParameterManager.h"
+
+#include <QDateTime>
+
 #include <cmath>
 
 static const char* kColPrevParam = "CP_DIST";
@@ -19,13 +22,21 @@ VehicleObjectAvoidance::VehicleObjectAvoidance(Vehicle *vehicle, QObject* parent
     : QObject(parent)
     , _vehicle(vehicle)
 {
+    _displayTimer.setInterval(displayIntervalMsecs);
+    connect(&_displayTimer, &QTimer::timeout, this, &VehicleObjectAvoidance::_displayTick);
 }
 
 //-----------------------------------------------------------------------------
 void
-VehicleObjectAvoidance::update(mavlink_obstacle_distance_t* message)
+VehicleObjectAvoidance::update(uint8_t compId, mavlink_obstacle_distance_t* message)
 {
+    _pointsChanged |= _obstacles.update(compId, *message, _vehicle->heading()->rawValue().toDouble(), QDateTime::currentMSecsSinceEpoch());
     //-- Collect raw data
+    QList<int> distances    = _distances;
+    qreal      increment    = _increment;
+    qreal      angleOffset  = _angleOffset;
+    int        minDistance  = _minDistance;
+    int        maxDistance  = _maxDistance;
     if(std::isfinite(message->increment_f) && message->increment_f > 0) {
         _increment = static_cast<qreal>(message->increment_f);
     } else {
@@ -44,6 +55,7 @@ VehicleObjectAvoidance::update(mavlink_obstacle_distance_t* message)
         }
     }
     //-- Create a plottable grid with found objects
+    QVector<QPointF> objGrid = _objGrid;
     _objGrid.clear();
     _objDistance.clear();
     auto* sp = qobject_cast<VehicleSetpointFactGroup*>(_vehicle->setpointFactGroup());
@@ -60,7 +72,47 @@ VehicleObjectAvoidance::update(mavlink_obstacle_distance_t* message)
             _objDistance.append(d);
         }
     }
-    emit objectAvoidanceChanged();
+    _valuesChanged |= _objGrid != objGrid || _distances != distances || _increment != increment ||
+            _angleOffset != angleOffset || _minDistance != minDistance || _maxDistance != maxDistance;
+    _startDisplayTimer();
+}
+
+#if defined(MAVLINK_MSG_ID_OBSTACLE_DISTANCE_3D)
+//-----------------------------------------------------------------------------
+void
+VehicleObjectAvoidance::update3D(uint8_t compId, mavlink_obstacle_distance_3d_t* message)
+{
+    _pointsChanged |= _obstacles.update3D(compId, *message, QDateTime::currentMSecsSinceEpoch());
+    _startDisplayTimer();
+}
+#endif
+
+//-----------------------------------------------------------------------------
+void
+VehicleObjectAvoidance::_startDisplayTimer()
+{
+    if(!_displayTimer.isActive()) {
+        _displayTimer.start();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+VehicleObjectAvoidance::_displayTick()
+{
+    _pointsChanged |= _obstacles.expire(QDateTime::currentMSecsSinceEpoch());
+    if(_pointsChanged) {
+        _pointsChanged = false;
+        emit pointsChanged();
+    }
+    if(_valuesChanged) {
+        _valuesChanged = false;
+        emit objectAvoidanceChanged();
+    }
+    //-- Nothing left to show, the next message starts the timer again
+    if(_obstacles.isEmpty()) {
+        _displayTimer.stop();
+    }
 }
 
 //-----------------------------------------------------------------------------
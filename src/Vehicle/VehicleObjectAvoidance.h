@@ -12,11 +12,15 @@
 #include <QObject>
 #include <QVector>
 #include <QPointF>
+#include <QTimer>
 
 #include "QGCMAVLink.h"
+#include "ObstacleDistanceBuffer.h"
 
 class Vehicle;
 
+/// Obstacle distances reported by the vehicle. Messages only update the data, the notifications go out at most once
+/// per displayIntervalMsecs and only when something visibly changed.
 class VehicleObjectAvoidance : public QObject
 {
     Q_OBJECT
@@ -31,6 +35,7 @@ public:
     Q_PROPERTY(int              maxDistance READ maxDistance    NOTIFY objectAvoidanceChanged)
     Q_PROPERTY(qreal            angleOffset READ angleOffset    NOTIFY objectAvoidanceChanged)
     Q_PROPERTY(int              gridSize    READ gridSize       NOTIFY objectAvoidanceChanged)
+    Q_PROPERTY(int              sensorCount READ sensorCount    NOTIFY pointsChanged)
 
     //-- Start collision avoidance. Argument is minimum distance the vehicle should keep to all obstacles
     Q_INVOKABLE void    start   (int minDistance);
@@ -48,13 +53,32 @@ public:
     int             maxDistance () { return _maxDistance; }
     qreal           angleOffset () { return _angleOffset; }
     int             gridSize    () { return _objGrid.count(); }
+    int             sensorCount () { return _obstacles.sensorCount(); }
 
-    void            update      (mavlink_obstacle_distance_t* message);
+    /// @return Obstacles of all sensors in meters, x forward, y right, z down from the vehicle
+    const QVector<QVector3D>& points() { return _obstacles.points(); }
+
+    void            update      (uint8_t compId, mavlink_obstacle_distance_t* message);
+#if defined(MAVLINK_MSG_ID_OBSTACLE_DISTANCE_3D)
+    void            update3D    (uint8_t compId, mavlink_obstacle_distance_3d_t* message);
+#endif
+
+    static const int displayIntervalMsecs = 100;
 
 signals:
     void            objectAvoidanceChanged  ();
+    void            pointsChanged           ();
+
+private slots:
+    void            _displayTick            ();
 
 private:
+    void            _startDisplayTimer      ();
+
+    ObstacleDistanceBuffer  _obstacles;
+    QTimer          _displayTimer;
+    bool            _pointsChanged  = false;
+    bool            _valuesChanged  = false;
     QList<int>      _distances;
     QVector<QPointF>_objGrid;
     QVector<qreal>  _objDistance;
@@ -57,13 +57,13 @@ void VehicleSetpointFactGroup::handleMessage(Vehicle* /* vehicle */, mavlink_mes
     float roll, pitch, yaw;
     mavlink_quaternion_to_euler(attitudeTarget.q, &roll, &pitch, &yaw);
 
-    this->roll()->setRawValue   (qRadiansToDegrees(roll));
-    this->pitch()->setRawValue  (qRadiansToDegrees(pitch));
-    this->yaw()->setRawValue    (qRadiansToDegrees(yaw));
+    _setFactValue(this->roll(),     qRadiansToDegrees(roll));
+    _setFactValue(this->pitch(),    qRadiansToDegrees(pitch));
+    _setFactValue(this->yaw(),      qRadiansToDegrees(yaw));
 
-    rollRate()->setRawValue (qRadiansToDegrees(attitudeTarget.body_roll_rate));
-    pitchRate()->setRawValue(qRadiansToDegrees(attitudeTarget.body_pitch_rate));
-    yawRate()->setRawValue  (qRadiansToDegrees(attitudeTarget.body_yaw_rate));
+    _setFactValue(rollRate(),       qRadiansToDegrees(attitudeTarget.body_roll_rate));
+    _setFactValue(pitchRate(),      qRadiansToDegrees(attitudeTarget.body_pitch_rate));
+    _setFactValue(yawRate(),        qRadiansToDegrees(attitudeTarget.body_yaw_rate));
 
     _setTelemetryAvailable(true);
 }
@@ -0,0 +1,175 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VehicleStatusModelTest.h"
+#include "VehicleEscStatusModel.h"
+#include "VehicleBatteryStatusModel.h"
+
+#include <QSignalSpy>
+
+static mavlink_message_t _escStatusMessage(uint8_t index, float voltage)
+{
+    mavlink_esc_status_t escStatus;
+    memset(&escStatus, 0, sizeof(escStatus));
+
+    escStatus.index = index;
+    for (int i=0; i<VehicleEscStatusModel::escsPerMessage; i++) {
+        escStatus.rpm[i]        = 1000 * (index + i + 1);
+        escStatus.voltage[i]    = voltage;
+        escStatus.current[i]    = 2;
+    }
+
+    mavlink_message_t message;
+    mavlink_msg_esc_status_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &escStatus);
+    return message;
+}
+
+static mavlink_message_t _escInfoMessage(uint8_t index, uint8_t count, uint16_t online)
+{
+    mavlink_esc_info_t escInfo;
+    memset(&escInfo, 0, sizeof(escInfo));
+
+    escInfo.index   = index;
+    escInfo.count   = count;
+    escInfo.info    = online;
+    for (int i=0; i<VehicleEscStatusModel::escsPerMessage; i++) {
+        escInfo.error_count[i] = index + i;
+        escInfo.temperature[i] = 4550;
+    }
+    escInfo.temperature[3] = INT16_MAX;
+
+    mavlink_message_t message;
+    mavlink_msg_esc_info_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &escInfo);
+    return message;
+}
+
+static mavlink_message_t _batteryStatusMessage(uint8_t batteryId, int cellCount)
+{
+    mavlink_battery_status_t batteryStatus;
+    memset(&batteryStatus, 0, sizeof(batteryStatus));
+
+    batteryStatus.id                = batteryId;
+    batteryStatus.battery_function  = MAV_BATTERY_FUNCTION_ALL;
+    batteryStatus.type              = MAV_BATTERY_TYPE_LIPO;
+    batteryStatus.temperature       = INT16_MAX;
+    batteryStatus.current_battery   = 1500;
+    batteryStatus.current_consumed  = -1;
+    batteryStatus.battery_remaining = 80;
+    for (int i=0; i<10; i++) {
+        batteryStatus.voltages[i] = i < cellCount ? 4000 : UINT16_MAX;
+    }
+
+    mavlink_message_t message;
+    mavlink_msg_battery_status_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &batteryStatus);
+    return message;
+}
+
+void VehicleStatusModelTest::_escStatusTest(void)
+{
+    VehicleEscStatusModel   model;
+    QSignalSpy              insertedSpy(&model, &VehicleEscStatusModel::rowsInserted);
+    QSignalSpy              changedSpy(&model, &VehicleEscStatusModel::dataChanged);
+
+    // Dodecacopter, three messages of four ESCs each
+    for (int index=0; index<12; index+=VehicleEscStatusModel::escsPerMessage) {
+        model.handleMessage(_escStatusMessage(static_cast<uint8_t>(index), 50));
+    }
+    QCOMPARE(model.count(), 12);
+    QCOMPARE(insertedSpy.count(), 3);
+    QCOMPARE(changedSpy.count(), 3);
+
+    // One change signal for all four ESCs of an update
+    model.handleMessage(_escStatusMessage(4, 48));
+    QCOMPARE(insertedSpy.count(), 3);
+    QCOMPARE(changedSpy.count(), 4);
+    QCOMPARE(changedSpy.last()[0].toModelIndex().row(), 4);
+    QCOMPARE(changedSpy.last()[1].toModelIndex().row(), 7);
+
+    QCOMPARE(model.escAt(5).rpm, 6000.0);
+    QCOMPARE(model.escAt(5).voltage, 48.0);
+    QCOMPARE(model.escAt(0).voltage, 50.0);
+    QVERIFY(model.escAt(5).online);
+    QCOMPARE(model.data(model.index(5), VehicleEscStatusModel::PowerRole).toDouble(), 96.0);
+    QCOMPARE(model.data(model.index(5), VehicleEscStatusModel::EscIndexRole).toInt(), 5);
+
+    // Out of range indices are dropped
+    model.handleMessage(_escStatusMessage(VehicleEscStatusModel::maxEscs, 50));
+    QCOMPARE(model.count(), 12);
+}
+
+void VehicleStatusModelTest::_escInfoTest(void)
+{
+    VehicleEscStatusModel   model;
+    QSignalSpy              removedSpy(&model, &VehicleEscStatusModel::rowsRemoved);
+
+    // A hexacopter reports its ESCs in two status messages, the second only half filled
+    model.handleMessage(_escStatusMessage(0, 25));
+    model.handleMessage(_escStatusMessage(4, 25));
+    QCOMPARE(model.count(), 8);
+
+    // The ESC count from ESC_INFO removes the rows no ESC is behind
+    model.handleMessage(_escInfoMessage(4, 6, 0x1));
+    QCOMPARE(model.count(), 6);
+    QCOMPARE(removedSpy.count(), 1);
+
+    QVERIFY(model.escAt(4).online);
+    QVERIFY(!model.escAt(5).online);
+    QCOMPARE(model.escAt(5).errorCount, static_cast<uint32_t>(5));
+    QCOMPARE(model.escAt(4).temperature, 45.5);
+
+    // Once ESC_INFO was seen the online state only comes from it
+    model.handleMessage(_escStatusMessage(4, 25));
+    QCOMPARE(model.count(), 6);
+    QVERIFY(!model.escAt(5).online);
+
+    // ESC 0 to 3 had no ESC_INFO yet
+    QVERIFY(model.escAt(0).online);
+    QVERIFY(qIsNaN(model.escAt(0).temperature));
+
+    model.handleMessage(_escInfoMessage(0, 6, 0xF));
+    QVERIFY(qIsNaN(model.escAt(3).temperature));
+    QCOMPARE(model.escAt(2).temperature, 45.5);
+}
+
+void VehicleStatusModelTest::_batteryTest(void)
+{
+    VehicleBatteryStatusModel   model;
+    QSignalSpy                  insertedSpy(&model, &VehicleBatteryStatusModel::rowsInserted);
+    QSignalSpy                  changedSpy(&model, &VehicleBatteryStatusModel::dataChanged);
+
+    // Rows are kept in battery id order, whatever the order they show up in
+    model.handleMessage(_batteryStatusMessage(2, 6));
+    model.handleMessage(_batteryStatusMessage(0, 12));
+    model.handleMessage(_batteryStatusMessage(1, 4));
+    QCOMPARE(model.count(), 3);
+    QCOMPARE(insertedSpy.count(), 3);
+    QCOMPARE(changedSpy.count(), 3);
+    for (int i=0; i<model.count(); i++) {
+        QCOMPARE(model.batteryAt(i).id, static_cast<uint8_t>(i));
+    }
+
+    // One change signal per message
+    model.handleMessage(_batteryStatusMessage(1, 4));
+    QCOMPARE(insertedSpy.count(), 3);
+    QCOMPARE(changedSpy.count(), 4);
+    QCOMPARE(changedSpy.last()[0].toModelIndex().row(), 1);
+
+    const VehicleBatteryStatusModel::BatteryState_t* battery = model.battery(0);
+    QVERIFY(battery);
+    QCOMPARE(battery->cellCount, 12);
+    QCOMPARE(battery->voltage, 48.0);
+    QCOMPARE(battery->current, 15.0);
+    QCOMPARE(battery->instantPower, 720.0);
+    QCOMPARE(battery->percentRemaining, 80.0);
+    QVERIFY(qIsNaN(battery->temperature));
+    QVERIFY(qIsNaN(battery->mahConsumed));
+    QVERIFY(!model.battery(3));
+
+    QCOMPARE(model.data(model.index(2), VehicleBatteryStatusModel::VoltageRole).toDouble(), 24.0);
+}
@@ -0,0 +1,23 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Tests VehicleEscStatusModel and VehicleBatteryStatusModel
+class VehicleStatusModelTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _escStatusTest     (void);
+    void _escInfoTest       (void);
+    void _batteryTest       (void);
+};
@@ -48,12 +48,12 @@ void VehicleVibrationFactGroup::handleMessage(Vehicle* /* vehicle */, mavlink_me
     mavlink_vibration_t vibration;
     mavlink_msg_vibration_decode(&message, &vibration);
 
-    xAxis()->setRawValue(vibration.vibration_x);
-    yAxis()->setRawValue(vibration.vibration_y);
-    zAxis()->setRawValue(vibration.vibration_z);
-    clipCount1()->setRawValue(vibration.clipping_0);
-    clipCount2()->setRawValue(vibration.clipping_1);
-    clipCount3()->setRawValue(vibration.clipping_2);
+    _setFactValue(xAxis(),      vibration.vibration_x);
+    _setFactValue(yAxis(),      vibration.vibration_y);
+    _setFactValue(zAxis(),      vibration.vibration_z);
+    _setFactValue(clipCount1(), vibration.clipping_0);
+    _setFactValue(clipCount2(), vibration.clipping_1);
+    _setFactValue(clipCount3(), vibration.clipping_2);
     _setTelemetryAvailable(true);
 }
 
@@ -15,6 +15,8 @@
 #include <QDebug>
 #include <QElapsedTimer>
 
+#include <cstring>
+
 #include "QGC.h"
 
 /// This class manages interactions with the bootloader
@@ -352,56 +354,74 @@ bool Bootloader::_binProgram(const FirmwareImage* image)
     }
     uint32_t imageSize = (uint32_t)firmwareFile.size();
     
-    uint8_t imageBuf[PROG_MULTI_MAX];
-    uint32_t bytesSent = 0;
+    // Each command is PROTO_PROG_MULTI, count, bytes, PROTO_EOC
+    uint8_t     commandBuf[PROG_MULTI_MAX_PX4 + 3];
+    int         maxBytesPerCommand  = _sikRadio ? PROG_MULTI_MAX : PROG_MULTI_MAX_PX4;
+    uint32_t    bytesSent           = 0;
+    uint32_t    bytesAcked          = 0;
+    uint32_t    pendingSizes[_programPipelineDepth];
+    int         pendingCount        = 0;
     _imageCRC = 0;
     
-    Q_ASSERT(PROG_MULTI_MAX <= 0x8F);
-    
-    while (bytesSent < imageSize) {
-        int bytesToSend = imageSize - bytesSent;
-        if (bytesToSend > (int)sizeof(imageBuf)) {
-            bytesToSend = (int)sizeof(imageBuf);
-        }
-        
-        Q_ASSERT((bytesToSend % 4) == 0);
-        
-        int bytesRead = firmwareFile.read((char *)imageBuf, bytesToSend);
-        if (bytesRead == -1 || bytesRead != bytesToSend) {
-            _errorString = tr("Firmware file read failed: %1").arg(firmwareFile.errorString());
-            return false;
-        }
-        
-        Q_ASSERT(bytesToSend <= 0x8F);
-        
-        bool failed = true;
-        if (_write(PROTO_PROG_MULTI) &&
-                _write((uint8_t)bytesToSend) &&
-                _write(imageBuf, bytesToSend) &&
-                _write(PROTO_EOC)) {
-            if (_getCommandResponse()) {
-                failed = false;
+    // The next command is written while the bootloader is still flashing the previous one, then the responses are
+    // collected in order. The bootloader only acts on a command once it is complete, so a failure still points to
+    // the chunk which caused it.
+    while (bytesAcked < imageSize) {
+        if (bytesSent < imageSize && pendingCount < _programPipelineDepth) {
+            int bytesToSend = imageSize - bytesSent;
+            if (bytesToSend > maxBytesPerCommand) {
+                bytesToSend = maxBytesPerCommand;
             }
+
+            Q_ASSERT((bytesToSend % 4) == 0);
+
+            int bytesRead = firmwareFile.read((char *)&commandBuf[2], bytesToSend);
+            if (bytesRead == -1 || bytesRead != bytesToSend) {
+                _errorString = tr("Firmware file read failed: %1").arg(firmwareFile.errorString());
+                return false;
+            }
+
+            commandBuf[0]               = PROTO_PROG_MULTI;
+            commandBuf[1]               = (uint8_t)bytesToSend;
+            commandBuf[bytesToSend + 2] = PROTO_EOC;
+            if (!_write(commandBuf, bytesToSend + 3)) {
+                _errorString = tr("Flash failed: %1 at address 0x%2").arg(_errorString).arg(bytesSent, 8, 16, QLatin1Char('0'));
+                return false;
+            }
+            _port.flush();
+
+            // Calculate the CRC now so we can test it after the board is flashed.
+            _imageCRC = QGC::crc32(&commandBuf[2], bytesToSend, _imageCRC);
+
+            pendingSizes[pendingCount++] = bytesToSend;
+            bytesSent += bytesToSend;
+            continue;
         }
-        if (failed) {
-            _errorString = tr("Flash failed: %1 at address 0x%2").arg(_errorString).arg(bytesSent, 8, 16, QLatin1Char('0'));
+
+        if (!_getCommandResponse()) {
+            _errorString = tr("Flash failed: %1 at address 0x%2").arg(_errorString).arg(bytesAcked, 8, 16, QLatin1Char('0'));
             return false;
         }
+        bytesAcked += pendingSizes[0];
+        for (int i=1; i<pendingCount; i++) {
+            pendingSizes[i - 1] = pendingSizes[i];
+        }
+        pendingCount--;
 
-        bytesSent += bytesToSend;
-
-        // Calculate the CRC now so we can test it after the board is flashed.
-        _imageCRC = QGC::crc32((uint8_t *)imageBuf, bytesToSend, _imageCRC);
-
-        emit updateProgress(bytesSent, imageSize);
+        emit updateProgress(bytesAcked, imageSize);
     }
     firmwareFile.close();
 
     // We calculate the CRC using the entire flash size, filling the remainder with 0xFF.
+    uint8_t fill[256];
+    memset(fill, 0xFF, sizeof(fill));
     while (bytesSent < _boardFlashSize) {
-        const uint8_t fill = 0xFF;
-        _imageCRC = QGC::crc32(&fill, 1, _imageCRC);
-        bytesSent++;
+        uint32_t fillBytes = _boardFlashSize - bytesSent;
+        if (fillBytes > sizeof(fill)) {
+            fillBytes = sizeof(fill);
+        }
+        _imageCRC = QGC::crc32(fill, fillBytes, _imageCRC);
+        bytesSent += fillBytes;
     }
 
     return true;
@@ -522,40 +542,49 @@ bool Bootloader::_binVerifyBytes(const FirmwareImage* image)
         return false;
     }
     
-    uint8_t fileBuf[READ_MULTI_MAX];
-    uint8_t readBuf[READ_MULTI_MAX];
-    uint32_t bytesVerified = 0;
-    
-    Q_ASSERT(PROG_MULTI_MAX <= 0x8F);
+    uint8_t     fileBuf[PROG_MULTI_MAX_PX4];
+    uint8_t     readBuf[PROG_MULTI_MAX_PX4];
+    int         maxBytesPerCommand  = _sikRadio ? READ_MULTI_MAX : PROG_MULTI_MAX_PX4;
+    uint32_t    bytesRequested      = 0;
+    uint32_t    bytesVerified       = 0;
+    uint32_t    pendingSizes[_programPipelineDepth];
+    int         pendingCount        = 0;
     
+    // Same as programming, the next read is requested before the previous one has come back
     while (bytesVerified < imageSize) {
-        int bytesToRead = imageSize - bytesVerified;
-        if (bytesToRead > (int)sizeof(readBuf)) {
-            bytesToRead = (int)sizeof(readBuf);
+        if (bytesRequested < imageSize && pendingCount < _programPipelineDepth) {
+            int bytesToRead = imageSize - bytesRequested;
+            if (bytesToRead > maxBytesPerCommand) {
+                bytesToRead = maxBytesPerCommand;
+            }
+
+            Q_ASSERT((bytesToRead % 4) == 0);
+
+            uint8_t command[3] = { PROTO_READ_MULTI, (uint8_t)bytesToRead, PROTO_EOC };
+            if (!_write(command, sizeof(command))) {
+                _errorString = tr("Read failed: %1 at address: 0x%2").arg(_errorString).arg(bytesRequested, 8, 16, QLatin1Char('0'));
+                return false;
+            }
+            _port.flush();
+
+            pendingSizes[pendingCount++] = bytesToRead;
+            bytesRequested += bytesToRead;
+            continue;
         }
-        
-        Q_ASSERT((bytesToRead % 4) == 0);
-        
+
+        int bytesToRead = pendingSizes[0];
+        for (int i=1; i<pendingCount; i++) {
+            pendingSizes[i - 1] = pendingSizes[i];
+        }
+        pendingCount--;
+
         int bytesRead = firmwareFile.read((char *)fileBuf, bytesToRead);
         if (bytesRead == -1 || bytesRead != bytesToRead) {
             _errorString = tr("Firmware file read failed: %1").arg(firmwareFile.errorString());
             return false;
         }
-        
-        Q_ASSERT(bytesToRead <= 0x8F);
-        
-        bool failed = true;
-        if (_write(PROTO_READ_MULTI) &&
-                _write((uint8_t)bytesToRead) &&
-                _write(PROTO_EOC)) {
-            _port.flush();
-            if (_read(readBuf, bytesToRead)) {
-                if (_getCommandResponse()) {
-                    failed = false;
-                }
-            }
-        }
-        if (failed) {
+
+        if (!_read(readBuf, bytesToRead) || !_getCommandResponse()) {
             _errorString = tr("Read failed: %1 at address: 0x%2").arg(_errorString).arg(bytesVerified, 8, 16, QLatin1Char('0'));
             return false;
         }
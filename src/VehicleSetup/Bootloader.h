@@ -97,6 +97,7 @@ private:
         INFO_FLASH_SIZE		=   4,    ///< max firmware size in bytes
         
         PROG_MULTI_MAX		=   64,     ///< write size for PROTO_PROG_MULTI, must be multiple of 4
+        PROG_MULTI_MAX_PX4	=   252,    ///< write and read size for PX4 and ArduPilot bootloaders, protocol max is 255 and must be multiple of 4
         READ_MULTI_MAX		=   0x28    ///< read size for PROTO_READ_MULTI, must be multiple of 4. Sik Radio max size is 0x28
     };
     
@@ -117,4 +118,5 @@ private:
     static const int _responseTimeout                   = 2000;     ///< Msecs to wait for command response bytes
     static const int _flashSizeSmall                    = 1032192;  ///< Flash size for boards with silicon error
     static const int _bootloaderVersionV2CorrectFlash   = 5;        ///< Anything below this bootloader version on V2 boards cannot trust flash size
+    static const int _programPipelineDepth              = 2;        ///< Commands in flight while programming .bin images
 };
@@ -0,0 +1,174 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FirmwareBatchFlasher.h"
+#include "Bootloader.h"
+#include "QGCLoggingCategory.h"
+#include "QGCSerialPortInfo.h"
+
+FirmwareBatchFlashWorker::FirmwareBatchFlashWorker(const QString& portName, bool sikRadio, const FirmwareImage* image, uint32_t boardID)
+    : _portName (portName)
+    , _sikRadio (sikRadio)
+    , _image    (image)
+    , _boardID  (boardID)
+{
+
+}
+
+void FirmwareBatchFlashWorker::flash(void)
+{
+    Bootloader  bootloader(_sikRadio);
+    uint32_t    bootloaderVersion;
+    uint32_t    boardID;
+    uint32_t    flashSize;
+
+    if (!bootloader.open(_portName)) {
+        emit finished(_portName, false, bootloader.errorString());
+        return;
+    }
+
+    if (!bootloader.getBoardInfo(bootloaderVersion, boardID, flashSize)) {
+        goto Error;
+    }
+    // The image was loaded for the first board, others have to be the same kind
+    if (boardID != _boardID) {
+        bootloader.reboot();
+        bootloader.close();
+        emit finished(_portName, false, tr("Board id %1 does not match the image board id %2").arg(boardID).arg(_boardID));
+        return;
+    }
+    if (flashSize != 0 && _image->imageSize() > flashSize) {
+        bootloader.reboot();
+        bootloader.close();
+        emit finished(_portName, false, tr("Image size of %1 is too large for board flash size %2").arg(_image->imageSize()).arg(flashSize));
+        return;
+    }
+
+    if (!bootloader.initFlashSequence()) {
+        goto Error;
+    }
+    emit status(_portName, tr("Erasing previous program..."));
+    if (!bootloader.erase()) {
+        goto Error;
+    }
+    emit status(_portName, tr("Programming new version..."));
+    if (!bootloader.program(_image)) {
+        goto Error;
+    }
+    emit status(_portName, tr("Verifying program..."));
+    // verify reboots the board
+    if (!bootloader.verify(_image)) {
+        bootloader.close();
+        emit finished(_portName, false, bootloader.errorString());
+        return;
+    }
+
+    bootloader.close();
+    emit finished(_portName, true, QString());
+    return;
+
+Error:
+    bootloader.reboot();
+    bootloader.close();
+    emit finished(_portName, false, bootloader.errorString());
+}
+
+FirmwareBatchFlasher::FirmwareBatchFlasher(const FirmwareImage* image, uint32_t boardID, QObject* parent)
+    : QObject   (parent)
+    , _image    (image)
+    , _boardID  (boardID)
+{
+    _scanTimer.setInterval(scanIntervalMsecs);
+    connect(&_scanTimer, &QTimer::timeout, this, &FirmwareBatchFlasher::_scan);
+    _scanTimer.start();
+    _scan();
+}
+
+FirmwareBatchFlasher::~FirmwareBatchFlasher()
+{
+    // Boards which are in the middle of flashing are finished, otherwise they would be left without firmware
+    _scanTimer.stop();
+    for (QThread* thread: _threads) {
+        thread->quit();
+        thread->wait();
+        delete thread;
+    }
+}
+
+void FirmwareBatchFlasher::_scan(void)
+{
+    QSet<QString> portNames;
+
+    for (const QGCSerialPortInfo& info: QGCSerialPortInfo::availablePorts()) {
+        if (!info.canFlash()) {
+            continue;
+        }
+        QString portName = info.portName();
+        portNames.insert(portName);
+
+        if (_firstScan) {
+            _ignoredPorts.insert(portName);
+            continue;
+        }
+        if (_ignoredPorts.contains(portName) || _activeBoards.contains(portName) || _activeBoards.count() >= maxParallelBoards) {
+            continue;
+        }
+        QString boardKey = info.serialNumber().isEmpty() ? portName : info.serialNumber();
+        if (_doneBoards.contains(boardKey)) {
+            continue;
+        }
+
+        QGCSerialPortInfo::BoardType_t  boardType;
+        QString                         boardName;
+        info.getBoardInfo(boardType, boardName);
+        qCDebug(FirmwareUpgradeLog) << "Batch flash found board" << portName << boardName << boardKey;
+
+        QThread*                    thread  = new QThread();
+        FirmwareBatchFlashWorker*   worker  = new FirmwareBatchFlashWorker(portName, boardType == QGCSerialPortInfo::BoardTypeSiKRadio, _image, _boardID);
+        worker->moveToThread(thread);
+        connect(thread, &QThread::started,                      worker, &FirmwareBatchFlashWorker::flash);
+        connect(thread, &QThread::finished,                     worker, &QObject::deleteLater);
+        connect(worker, &FirmwareBatchFlashWorker::status,      this,   &FirmwareBatchFlasher::status);
+        connect(worker, &FirmwareBatchFlashWorker::finished,    this,   &FirmwareBatchFlasher::_boardFinished);
+        connect(worker, &FirmwareBatchFlashWorker::finished,    thread, &QThread::quit);
+        _threads.append(thread);
+        _activeBoards[portName] = boardKey;
+        thread->start();
+
+        emit status(portName, tr("Found %1").arg(boardName));
+        emit countsChanged();
+    }
+    _firstScan = false;
+
+    // Ports which went away can be used by the next board
+    _ignoredPorts.intersect(portNames);
+
+    // Threads of the boards which are done
+    for (int i=_threads.count() - 1; i>=0; i--) {
+        if (_threads[i]->isFinished()) {
+            delete _threads.takeAt(i);
+        }
+    }
+}
+
+void FirmwareBatchFlasher::_boardFinished(const QString& portName, bool success, const QString& errorString)
+{
+    QString boardKey = _activeBoards.take(portName);
+    // The port stays on in application mode, it isn't worth another try until the board is plugged in again
+    _ignoredPorts.insert(portName);
+    if (success) {
+        _doneBoards.insert(boardKey);
+        _flashedCount++;
+    } else {
+        _failedCount++;
+    }
+    qCDebug(FirmwareUpgradeLog) << "Batch flash finished" << portName << success << errorString;
+    emit boardFinished(portName, success, errorString);
+    emit countsChanged();
+}
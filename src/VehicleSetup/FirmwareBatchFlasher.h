@@ -0,0 +1,82 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "FirmwareImage.h"
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QThread>
+#include <QTimer>
+
+/// Flashes one board on its own thread: board info, erase, program, verify and reboot, in one go
+class FirmwareBatchFlashWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    FirmwareBatchFlashWorker(const QString& portName, bool sikRadio, const FirmwareImage* image, uint32_t boardID);
+
+signals:
+    void status     (const QString& portName, const QString& statusText);
+    void finished   (const QString& portName, bool success, const QString& errorString);
+
+public slots:
+    void flash      (void);
+
+private:
+    QString                 _portName;
+    bool                    _sikRadio;
+    const FirmwareImage*    _image;
+    uint32_t                _boardID;
+};
+
+/// Flashes the same image to every matching board which is plugged in while it runs, several boards at a time on
+/// separate ports. Boards which are already plugged in when it starts are left alone, they are out of their bootloader
+/// by then. Each board is flashed once, it is recognized by its USB serial number when it comes back after the reboot.
+/// A board which failed is tried again once it is unplugged and plugged back in.
+class FirmwareBatchFlasher : public QObject
+{
+    Q_OBJECT
+
+public:
+    /// @param image Loaded for boardID, must stay around until the flasher is deleted
+    FirmwareBatchFlasher(const FirmwareImage* image, uint32_t boardID, QObject* parent = nullptr);
+    ~FirmwareBatchFlasher();
+
+    int activeCount     (void) const { return _activeBoards.count(); }
+    int flashedCount    (void) const { return _flashedCount; }
+    int failedCount     (void) const { return _failedCount; }
+
+    static const int maxParallelBoards  = 8;    ///< USB hubs get unreliable with more boards in bootloader at once
+    static const int scanIntervalMsecs  = 250;  ///< Bootloaders only wait a little while for a sync
+
+signals:
+    void status         (const QString& portName, const QString& statusText);
+    void boardFinished  (const QString& portName, bool success, const QString& errorString);
+    void countsChanged  (void);
+
+private slots:
+    void _scan          (void);
+    void _boardFinished (const QString& portName, bool success, const QString& errorString);
+
+private:
+    const FirmwareImage*    _image;
+    uint32_t                _boardID;
+    QTimer                  _scanTimer;
+    QSet<QString>           _ignoredPorts;      ///< Ports which are left alone until they go away
+    QSet<QString>           _doneBoards;        ///< Flashed boards by serial number, or port name when there is none
+    QHash<QString, QString> _activeBoards;      ///< Board key by port name
+    QList<QThread*>         _threads;
+    int                     _flashedCount   = 0;
+    int                     _failedCount    = 0;
+    bool                    _firstScan      = true;
+};
@@ -0,0 +1,309 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FirmwareDownloadCache.h"
+#include "QGCLoggingCategory.h"
+#include "QGCApplication.h"
+#include "QGCNetworkService.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSettings>
+
+const char* FirmwareDownloadCache::_jsonUrlKey =            "url";
+const char* FirmwareDownloadCache::_jsonFileNameKey =       "fileName";
+const char* FirmwareDownloadCache::_jsonETagKey =           "eTag";
+const char* FirmwareDownloadCache::_jsonLastModifiedKey =   "lastModified";
+const char* FirmwareDownloadCache::_jsonSha256Key =         "sha256";
+const char* FirmwareDownloadCache::_entryFileName =         "entry.json";
+
+FirmwareDownloadCache::FirmwareDownloadCache(const QString& cacheDir, QObject* parent)
+    : QObject   (parent)
+    , _cacheDir (cacheDir)
+{
+
+}
+
+QString FirmwareDownloadCache::cacheDir(void)
+{
+    return QFileInfo(QSettings().fileName()).dir().absoluteFilePath(QStringLiteral("FirmwareCache"));
+}
+
+QString FirmwareDownloadCache::fileSha256(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file)) {
+        return QString();
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+void FirmwareDownloadCache::download(const QString& remoteFile)
+{
+    if (_queue.contains(remoteFile) || _activeReplies.key(remoteFile, nullptr)) {
+        return;
+    }
+
+    _queue.append(remoteFile);
+    _startNext();
+}
+
+void FirmwareDownloadCache::prefetch(const QStringList& remoteFiles)
+{
+    QStringList newFiles;
+
+    // All of them are tracked before the first download starts, so a download which fails right away can't complete the prefetch early
+    for (const QString& remoteFile: remoteFiles) {
+        if (!_prefetchFiles.contains(remoteFile)) {
+            _prefetchFiles.insert(remoteFile);
+            _prefetchCount++;
+            newFiles.append(remoteFile);
+        }
+    }
+
+    for (const QString& remoteFile: newFiles) {
+        download(remoteFile);
+    }
+}
+
+QString FirmwareDownloadCache::cachedFile(const QString& remoteFile) const
+{
+    CacheEntry_t entry;
+    if (!_readEntry(remoteFile, entry)) {
+        return QString();
+    }
+
+    QString localFile = QDir(_entryDir(remoteFile)).absoluteFilePath(entry.fileName);
+    if (entry.sha256.isEmpty() || fileSha256(localFile) != entry.sha256) {
+        qCWarning(FirmwareUpgradeLog) << "Cached firmware file failed verification" << remoteFile << localFile;
+        return QString();
+    }
+
+    return localFile;
+}
+
+void FirmwareDownloadCache::_startNext(void)
+{
+    while (_activeReplies.count() < maxParallelDownloads && !_queue.isEmpty()) {
+        QString remoteFile  = _queue.takeFirst();
+        QUrl    remoteUrl   = _remoteUrl(remoteFile);
+
+        if (!remoteUrl.isValid()) {
+            qWarning() << "Remote URL is invalid" << remoteFile;
+            _finish(remoteFile, QString(), tr("Invalid download location: %1").arg(remoteFile));
+            continue;
+        }
+
+        QNetworkRequest networkRequest(remoteUrl);
+        networkRequest.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+        QGCNetworkService::setConsumer(networkRequest, QGCNetworkService::consumerFirmware);
+
+        // Only ask the server whether the file changed when there is a good copy to fall back to
+        CacheEntry_t entry;
+        if (!remoteUrl.isLocalFile() && _readEntry(remoteFile, entry) && !cachedFile(remoteFile).isEmpty()) {
+            if (!entry.eTag.isEmpty()) {
+                networkRequest.setRawHeader("If-None-Match", entry.eTag);
+            }
+            if (!entry.lastModified.isEmpty()) {
+                networkRequest.setRawHeader("If-Modified-Since", entry.lastModified);
+            }
+        }
+
+        QNetworkReply* networkReply = qgcApp()->toolbox()->networkService()->networkAccessManager()->get(networkRequest);
+        if (!networkReply) {
+            qWarning() << "QNetworkAccessManager::get failed";
+            _finish(remoteFile, QString(), tr("Download of %1 could not be started").arg(remoteFile));
+            continue;
+        }
+
+        _activeReplies.insert(networkReply, remoteFile);
+        connect(networkReply, &QNetworkReply::finished, this, &FirmwareDownloadCache::_downloadFinished);
+        connect(networkReply, &QNetworkReply::downloadProgress, this, [this, remoteFile](qint64 curr, qint64 total) {
+            emit downloadProgress(remoteFile, curr, total);
+        });
+        qCDebug(FirmwareUpgradeLog) << "Firmware download started" << remoteFile << entry.eTag << entry.lastModified;
+    }
+}
+
+void FirmwareDownloadCache::_downloadFinished(void)
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(QObject::sender());
+    if (!_activeReplies.contains(reply)) {
+        return;
+    }
+
+    QString remoteFile = _activeReplies.take(reply);
+    reply->deleteLater();
+
+    if (reply->error() != QNetworkReply::NoError) {
+        QString localFile = cachedFile(remoteFile);
+        if (localFile.isEmpty()) {
+            _finish(remoteFile, QString(), _errorString(reply));
+        } else {
+            qCWarning(FirmwareUpgradeLog) << "Firmware download failed, using cached copy" << remoteFile << reply->errorString();
+            _finish(remoteFile, localFile, QString());
+        }
+    } else if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304) {
+        QString localFile = cachedFile(remoteFile);
+        qCDebug(FirmwareUpgradeLog) << "Firmware file not modified" << remoteFile << localFile;
+        _finish(remoteFile, localFile, localFile.isEmpty() ? tr("Cached copy of %1 is missing").arg(remoteFile) : QString());
+    } else {
+        QString errorMsg;
+        QString localFile = _store(remoteFile, reply, errorMsg);
+        _finish(remoteFile, localFile, errorMsg);
+    }
+
+    _startNext();
+}
+
+void FirmwareDownloadCache::_finish(const QString& remoteFile, const QString& localFile, const QString& errorMsg)
+{
+    emit downloadComplete(remoteFile, localFile, errorMsg);
+
+    if (_prefetchFiles.remove(remoteFile)) {
+        if (!errorMsg.isEmpty()) {
+            _prefetchFailedCount++;
+        }
+        if (_prefetchFiles.isEmpty()) {
+            int fileCount   = _prefetchCount;
+            int failedCount = _prefetchFailedCount;
+
+            _prefetchCount          = 0;
+            _prefetchFailedCount    = 0;
+            emit prefetchComplete(fileCount, failedCount);
+        }
+    }
+}
+
+QString FirmwareDownloadCache::_store(const QString& remoteFile, QNetworkReply* reply, QString& errorMsg)
+{
+    QString entryDir = _entryDir(remoteFile);
+    if (!QDir().mkpath(entryDir)) {
+        errorMsg = tr("Could not create firmware cache directory %1").arg(entryDir);
+        return QString();
+    }
+
+    // The name comes from the original location rather than a redirect, so it stays the same between downloads
+    CacheEntry_t entry;
+    entry.fileName = _remoteFileName(_remoteUrl(remoteFile));
+
+    QString     localFile   = QDir(entryDir).absoluteFilePath(entry.fileName);
+    QByteArray  bytes       = reply->readAll();
+    QSaveFile   file(localFile);
+    if (!file.open(QIODevice::WriteOnly) || file.write(bytes) != bytes.size() || !file.commit()) {
+        errorMsg = tr("Could not save downloaded file to %1. Error: %2").arg(localFile).arg(file.errorString());
+        return QString();
+    }
+
+    entry.eTag          = reply->rawHeader("ETag");
+    entry.lastModified  = reply->rawHeader("Last-Modified");
+    entry.sha256        = QString::fromLatin1(QCryptographicHash::hash(bytes, QCryptographicHash::Sha256).toHex());
+    if (!_writeEntry(remoteFile, entry)) {
+        // The file is still good for this flash, it just won't be reused
+        qCWarning(FirmwareUpgradeLog) << "Unable to write firmware cache entry" << remoteFile;
+    }
+
+    qCDebug(FirmwareUpgradeLog) << "Firmware file stored" << remoteFile << localFile << bytes.size() << entry.sha256;
+    return localFile;
+}
+
+QString FirmwareDownloadCache::_entryDir(const QString& remoteFile) const
+{
+    QString remoteHash = QCryptographicHash::hash(remoteFile.toUtf8(), QCryptographicHash::Sha1).toHex().left(16);
+    return QDir(_cacheDir).absoluteFilePath(remoteHash);
+}
+
+bool FirmwareDownloadCache::_readEntry(const QString& remoteFile, CacheEntry_t& entry) const
+{
+    QFile file(QDir(_entryDir(remoteFile)).absoluteFilePath(_entryFileName));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonParseError jsonParseError;
+    QJsonDocument   doc = QJsonDocument::fromJson(file.readAll(), &jsonParseError);
+    if (jsonParseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        qCWarning(FirmwareUpgradeLog) << "Unable to parse firmware cache entry" << file.fileName() << jsonParseError.errorString();
+        return false;
+    }
+
+    QJsonObject json = doc.object();
+    if (json[_jsonUrlKey].toString() != remoteFile) {
+        // Hash collision of the directory name
+        return false;
+    }
+
+    entry.fileName      = json[_jsonFileNameKey].toString();
+    entry.eTag          = json[_jsonETagKey].toString().toLatin1();
+    entry.lastModified  = json[_jsonLastModifiedKey].toString().toLatin1();
+    entry.sha256        = json[_jsonSha256Key].toString();
+
+    return !entry.fileName.isEmpty();
+}
+
+bool FirmwareDownloadCache::_writeEntry(const QString& remoteFile, const CacheEntry_t& entry)
+{
+    QJsonObject json;
+    json[_jsonUrlKey]           = remoteFile;
+    json[_jsonFileNameKey]      = entry.fileName;
+    json[_jsonETagKey]          = QString::fromLatin1(entry.eTag);
+    json[_jsonLastModifiedKey]  = QString::fromLatin1(entry.lastModified);
+    json[_jsonSha256Key]        = entry.sha256;
+
+    QSaveFile file(QDir(_entryDir(remoteFile)).absoluteFilePath(_entryFileName));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QJsonDocument(json).toJson());
+    return file.commit();
+}
+
+QString FirmwareDownloadCache::_errorString(QNetworkReply* reply) const
+{
+    switch (reply->error()) {
+    case QNetworkReply::OperationCanceledError:
+        return tr("Download cancelled");
+    case QNetworkReply::ContentNotFoundError:
+        return tr("Error: File Not Found");
+    default:
+        return tr("Error during download. Error: %1").arg(reply->error());
+    }
+}
+
+QUrl FirmwareDownloadCache::_remoteUrl(const QString& remoteFile)
+{
+    if (remoteFile.isEmpty()) {
+        return QUrl();
+    }
+    if (remoteFile.startsWith("http:") || remoteFile.startsWith("https:")) {
+        return QUrl(remoteFile);
+    }
+    return QUrl::fromLocalFile(remoteFile);
+}
+
+QString FirmwareDownloadCache::_remoteFileName(const QUrl& remoteUrl)
+{
+    // QUrl::fileName leaves out the query, which downloads from github carry
+    QString fileName = remoteUrl.fileName();
+    if (fileName.isEmpty()) {
+        qWarning() << "Unabled to parse filename from remote url" << remoteUrl.toString();
+        fileName = QStringLiteral("DownloadedFile");
+    }
+    return fileName;
+}
@@ -0,0 +1,94 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QHash>
+#include <QNetworkReply>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+
+/// On disk cache for firmware manifests and images. A cached file is revalidated with its ETag and Last-Modified date,
+/// so a file which hasn't changed on the server isn't downloaded again. The SHA-256 of each file is recorded when it is
+/// stored and checked before a cached copy is handed out. If the server can't be reached a verified cached copy is
+/// used instead.
+///
+/// Up to maxParallelDownloads files download at the same time, the rest are queued. Each file gets its own directory
+/// in the cache so its file name, which FirmwareImage goes by, is kept.
+class FirmwareDownloadCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    FirmwareDownloadCache(const QString& cacheDir, QObject* parent = nullptr);
+
+    /// Downloads the file or revalidates the cached copy. A file which is already queued or downloading isn't
+    /// requested twice, downloadComplete is emitted once for it.
+    ///     @param remoteFile   http(s) address or file system path
+    void download(const QString& remoteFile);
+
+    /// Downloads the files into the cache in the background. prefetchComplete is emitted once all of them are done.
+    void prefetch(const QStringList& remoteFiles);
+
+    /// @return Verified cached copy of the file, empty if there isn't one
+    QString cachedFile(const QString& remoteFile) const;
+
+    int activeDownloads (void) const { return _activeReplies.count(); }
+    int queuedDownloads (void) const { return _queue.count(); }
+
+    /// @return Cache directory shared by the firmware downloads
+    static QString cacheDir(void);
+
+    /// @return Hex SHA-256 of the file contents, empty if it can't be read
+    static QString fileSha256(const QString& fileName);
+
+    static const int maxParallelDownloads = 4;
+
+signals:
+    void downloadProgress   (QString remoteFile, qint64 curr, qint64 total);
+    void downloadComplete   (QString remoteFile, QString localFile, QString errorMsg);
+    void prefetchComplete   (int fileCount, int failedCount);
+
+private slots:
+    void _downloadFinished(void);
+
+private:
+    typedef struct {
+        QString     fileName;
+        QByteArray  eTag;
+        QByteArray  lastModified;
+        QString     sha256;
+    } CacheEntry_t;
+
+    void    _startNext          (void);
+    void    _finish             (const QString& remoteFile, const QString& localFile, const QString& errorMsg);
+    QString _entryDir           (const QString& remoteFile) const;
+    bool    _readEntry          (const QString& remoteFile, CacheEntry_t& entry) const;
+    bool    _writeEntry         (const QString& remoteFile, const CacheEntry_t& entry);
+    QString _store              (const QString& remoteFile, QNetworkReply* reply, QString& errorMsg);
+    QString _errorString        (QNetworkReply* reply) const;
+
+    static QUrl     _remoteUrl      (const QString& remoteFile);
+    static QString  _remoteFileName (const QUrl& remoteUrl);
+
+    QString                         _cacheDir;
+    QStringList                     _queue;
+    QHash<QNetworkReply*, QString>  _activeReplies;     ///< Reply to remote file
+    QSet<QString>                   _prefetchFiles;     ///< Outstanding prefetches
+    int                             _prefetchCount          = 0;
+    int                             _prefetchFailedCount    = 0;
+
+    static const char* _jsonUrlKey;
+    static const char* _jsonFileNameKey;
+    static const char* _jsonETagKey;
+    static const char* _jsonLastModifiedKey;
+    static const char* _jsonSha256Key;
+    static const char* _entryFileName;
+};
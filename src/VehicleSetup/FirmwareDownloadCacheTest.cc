@@ -0,0 +1,151 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "FirmwareDownloadCacheTest.h"
+#include "FirmwareDownloadCache.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+static QString _writeFile(const QTemporaryDir& dir, const QString& name, const QByteArray& bytes)
+{
+    QString fileName = dir.filePath(name);
+    QFile   file(fileName);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(bytes);
+    }
+    return fileName;
+}
+
+static QByteArray _readFile(const QString& fileName)
+{
+    QFile file(fileName);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+void FirmwareDownloadCacheTest::_downloadTest(void)
+{
+    QTemporaryDir           sourceDir;
+    QTemporaryDir           cacheDir;
+    FirmwareDownloadCache   cache(cacheDir.path());
+    QSignalSpy              spyDownloadComplete(&cache, &FirmwareDownloadCache::downloadComplete);
+    QByteArray              bytes(4096, 'x');
+    QString                 remoteFile = _writeFile(sourceDir, QStringLiteral("firmware.px4"), bytes);
+
+    QVERIFY(cache.cachedFile(remoteFile).isEmpty());
+
+    // A second request for a file which is already downloading is dropped
+    cache.download(remoteFile);
+    cache.download(remoteFile);
+    QCOMPARE(spyDownloadComplete.wait(10000), true);
+    QCOMPARE(spyDownloadComplete.count(), 1);
+
+    QList<QVariant> arguments = spyDownloadComplete.takeFirst();
+    QString         localFile = arguments[1].toString();
+    QCOMPARE(arguments[0].toString(), remoteFile);
+    QVERIFY(arguments[2].toString().isEmpty());
+
+    // The copy keeps the file name, which FirmwareImage goes by
+    QVERIFY(localFile.startsWith(cacheDir.path()));
+    QCOMPARE(QFileInfo(localFile).fileName(), QStringLiteral("firmware.px4"));
+    QCOMPARE(_readFile(localFile), bytes);
+    QCOMPARE(cache.cachedFile(remoteFile), localFile);
+    QCOMPARE(FirmwareDownloadCache::fileSha256(localFile), FirmwareDownloadCache::fileSha256(remoteFile));
+}
+
+void FirmwareDownloadCacheTest::_verifyTest(void)
+{
+    QTemporaryDir           sourceDir;
+    QTemporaryDir           cacheDir;
+    FirmwareDownloadCache   cache(cacheDir.path());
+    QSignalSpy              spyDownloadComplete(&cache, &FirmwareDownloadCache::downloadComplete);
+    QString                 remoteFile = _writeFile(sourceDir, QStringLiteral("firmware.apj"), QByteArray(1024, 'a'));
+
+    cache.download(remoteFile);
+    QCOMPARE(spyDownloadComplete.wait(10000), true);
+    QString localFile = cache.cachedFile(remoteFile);
+    QVERIFY(!localFile.isEmpty());
+
+    // Same size, different contents
+    QFile file(localFile);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    file.write("b");
+    file.close();
+    QVERIFY(cache.cachedFile(remoteFile).isEmpty());
+
+    // A different cache looking at the same directory sees the same entries
+    FirmwareDownloadCache otherCache(cacheDir.path());
+    QVERIFY(otherCache.cachedFile(remoteFile).isEmpty());
+}
+
+void FirmwareDownloadCacheTest::_offlineTest(void)
+{
+    QTemporaryDir           sourceDir;
+    QTemporaryDir           cacheDir;
+    FirmwareDownloadCache   cache(cacheDir.path());
+    QSignalSpy              spyDownloadComplete(&cache, &FirmwareDownloadCache::downloadComplete);
+    QByteArray              bytes(2048, 'c');
+    QString                 remoteFile  = _writeFile(sourceDir, QStringLiteral("firmware.px4"), bytes);
+    QString                 missingFile = sourceDir.filePath(QStringLiteral("missing.px4"));
+
+    cache.download(remoteFile);
+    QCOMPARE(spyDownloadComplete.wait(10000), true);
+    spyDownloadComplete.clear();
+
+    // With the source gone the verified cached copy is used
+    QVERIFY(QFile::remove(remoteFile));
+    cache.download(remoteFile);
+    QCOMPARE(spyDownloadComplete.wait(10000), true);
+    QList<QVariant> arguments = spyDownloadComplete.takeFirst();
+    QVERIFY(arguments[2].toString().isEmpty());
+    QCOMPARE(_readFile(arguments[1].toString()), bytes);
+
+    // Without a cached copy the error comes through
+    cache.download(missingFile);
+    QCOMPARE(spyDownloadComplete.wait(10000), true);
+    arguments = spyDownloadComplete.takeFirst();
+    QCOMPARE(arguments[0].toString(), missingFile);
+    QVERIFY(arguments[1].toString().isEmpty());
+    QVERIFY(!arguments[2].toString().isEmpty());
+}
+
+void FirmwareDownloadCacheTest::_prefetchTest(void)
+{
+    QTemporaryDir           sourceDir;
+    QTemporaryDir           cacheDir;
+    FirmwareDownloadCache   cache(cacheDir.path());
+    QSignalSpy              spyDownloadComplete(&cache, &FirmwareDownloadCache::downloadComplete);
+    QSignalSpy              spyPrefetchComplete(&cache, &FirmwareDownloadCache::prefetchComplete);
+    QStringList             remoteFiles;
+
+    const int maxParallel   = FirmwareDownloadCache::maxParallelDownloads;
+    const int fileCount     = maxParallel + 2;
+    for (int i=0; i<fileCount; i++) {
+        remoteFiles.append(_writeFile(sourceDir, QStringLiteral("firmware%1.px4").arg(i), QByteArray(512, static_cast<char>('a' + i))));
+    }
+    remoteFiles.append(sourceDir.filePath(QStringLiteral("missing.px4")));
+
+    cache.prefetch(remoteFiles);
+    QCOMPARE(cache.activeDownloads(), maxParallel);
+    QCOMPARE(cache.queuedDownloads(), remoteFiles.count() - maxParallel);
+
+    QCOMPARE(spyPrefetchComplete.wait(10000), true);
+    QCOMPARE(spyPrefetchComplete.count(), 1);
+    QList<QVariant> arguments = spyPrefetchComplete.takeFirst();
+    QCOMPARE(arguments[0].toInt(), remoteFiles.count());
+    QCOMPARE(arguments[1].toInt(), 1);
+    QCOMPARE(spyDownloadComplete.count(), remoteFiles.count());
+    QCOMPARE(cache.activeDownloads(), 0);
+
+    for (int i=0; i<fileCount; i++) {
+        QVERIFY(!cache.cachedFile(remoteFiles[i]).isEmpty());
+    }
+}
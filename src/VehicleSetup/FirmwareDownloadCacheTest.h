@@ -0,0 +1,24 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for FirmwareDownloadCache
+class FirmwareDownloadCacheTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _downloadTest      (void);
+    void _verifyTest        (void);
+    void _offlineTest       (void);
+    void _prefetchTest      (void);
+};
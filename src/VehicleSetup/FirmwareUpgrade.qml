@@ -514,6 +514,33 @@ SetupPage {
                 onClicked:  globals.activeVehicle.flashBootloader()
             }
 
+            RowLayout {
+                spacing:    ScreenTools.defaultFontPixelWidth
+                visible:    controller.batchFlashAvailable
+
+                QGCButton {
+                    text:       controller.batchFlashing ? qsTr("Stop Batch Upgrade") : qsTr("Upgrade More Boards")
+                    onClicked:  controller.batchFlashing ? controller.stopBatchFlash() : controller.startBatchFlash()
+                }
+
+                QGCLabel {
+                    text:       qsTr("Upgraded: %1 Failed: %2").arg(controller.batchFlashedCount).arg(controller.batchFailedCount)
+                    visible:    controller.batchFlashing
+                }
+            }
+
+            RowLayout {
+                spacing:    ScreenTools.defaultFontPixelWidth
+                visible:    firmwarePage.advanced
+
+                QGCLabel { text: qsTr("Prefetch firmware for board ids") }
+
+                FactTextField {
+                    Layout.preferredWidth:  ScreenTools.defaultFontPixelWidth * 20
+                    fact:                   _firmwareUpgradeSettings.prefetchBoardIds
+                }
+            }
+
             TextArea {
                 id:                 statusTextArea
                 Layout.preferredWidth:              parent.width
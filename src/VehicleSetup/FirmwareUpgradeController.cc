@@ -10,7 +10,6 @@
 #include "FirmwareUpgradeController.h"
 #include "Bootloader.h"
 #include "QGCApplication.h"
-#include "QGCFileDownload.h"
 #include "QGCOptions.h"
 #include "QGCCorePlugin.h"
 #include "FirmwareUpgradeSettings.h"
@@ -25,6 +24,7 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QNetworkProxy>
+#include <QtConcurrent>
 
 #include "zlib.h"
 
@@ -40,6 +40,8 @@ const char* FirmwareUpgradeController::_manifestBootloaderStrJsonKey =
 const char* FirmwareUpgradeController::_manifestLatestKey =                     "latest";
 const char* FirmwareUpgradeController::_manifestPlatformKey =                   "platform";
 const char* FirmwareUpgradeController::_manifestBrandNameKey =                  "brand_name";
+const char* FirmwareUpgradeController::_px4ReleasesUrl =                        "https://api.github.com/repos/PX4/Firmware/releases";
+const char* FirmwareUpgradeController::_ardupilotManifestUrl =                  "http://firmware.ardupilot.org/manifest.json.gz";
 
 struct FirmwareToUrlElement_t {
     FirmwareUpgradeController::AutoPilotStackType_t     stackType;
@@ -94,14 +96,15 @@ FirmwareUpgradeController::FirmwareUpgradeController(void)
     : _singleFirmwareURL                (qgcApp()->toolbox()->corePlugin()->options()->firmwareUpgradeSingleURL())
     , _singleFirmwareMode               (!_singleFirmwareURL.isEmpty())
     , _downloadingFirmwareList          (false)
-    , _downloadManager                  (nullptr)
     , _downloadNetworkReply             (nullptr)
+    , _downloadCache                    (new FirmwareDownloadCache(FirmwareDownloadCache::cacheDir(), this))
     , _statusLog                        (nullptr)
     , _selectedFirmwareBuildType        (StableFirmware)
     , _image                            (nullptr)
     , _apmBoardDescriptionReplaceText   ("<APMBoardDescription>")
     , _apmChibiOSSetting                (qgcApp()->toolbox()->settingsManager()->firmwareUpgradeSettings()->apmChibiOS())
     , _apmVehicleTypeSetting            (qgcApp()->toolbox()->settingsManager()->firmwareUpgradeSettings()->apmVehicleType())
+    , _prefetchBoardIdsSetting          (qgcApp()->toolbox()->settingsManager()->firmwareUpgradeSettings()->prefetchBoardIds())
 {
     _manifestMavFirmwareVersionTypeToFirmwareBuildTypeMap["OFFICIAL"] =  StableFirmware;
     _manifestMavFirmwareVersionTypeToFirmwareBuildTypeMap["BETA"] =      BetaFirmware;
@@ -130,6 +133,12 @@ FirmwareUpgradeController::FirmwareUpgradeController(void)
     
     connect(&_eraseTimer, &QTimer::timeout, this, &FirmwareUpgradeController::_eraseProgressTick);
 
+    connect(_downloadCache,             &FirmwareDownloadCache::downloadComplete,   this, &FirmwareUpgradeController::_cacheDownloadComplete);
+    connect(_downloadCache,             &FirmwareDownloadCache::downloadProgress,   this, &FirmwareUpgradeController::_firmwareDownloadProgress);
+    connect(_downloadCache,             &FirmwareDownloadCache::prefetchComplete,   this, &FirmwareUpgradeController::_prefetchComplete);
+    connect(&_manifestWatcher,          &QFutureWatcherBase::finished,              this, &FirmwareUpgradeController::_ardupilotManifestParseComplete);
+    connect(_prefetchBoardIdsSetting,   &Fact::rawValueChanged,                     this, &FirmwareUpgradeController::_prefetchFirmware);
+
 #if !defined(NO_ARDUPILOT_DIALECT)
     connect(_apmChibiOSSetting,     &Fact::rawValueChanged, this, &FirmwareUpgradeController::_buildAPMFirmwareNames);
     connect(_apmVehicleTypeSetting, &Fact::rawValueChanged, this, &FirmwareUpgradeController::_buildAPMFirmwareNames);
@@ -140,11 +149,15 @@ FirmwareUpgradeController::FirmwareUpgradeController(void)
 
 #if !defined(NO_ARDUPILOT_DIALECT)
     _downloadArduPilotManifest();
+#else
+    _prefetchFirmware();
 #endif
 }
 
 FirmwareUpgradeController::~FirmwareUpgradeController()
 {
+    // Must go before the image it is using
+    delete _batchFlasher;
     qgcApp()->toolbox()->linkManager()->setConnectionsAllowed();
 }
 
@@ -381,17 +394,28 @@ void FirmwareUpgradeController::_downloadFirmware(void)
     _appendStatusLog(tr("Downloading firmware..."));
     _appendStatusLog(tr(" From: %1").arg(_firmwareFilename));
     
-    QGCFileDownload* downloader = new QGCFileDownload(this);
-    connect(downloader, &QGCFileDownload::downloadComplete, this, &FirmwareUpgradeController::_firmwareDownloadComplete);
-    connect(downloader, &QGCFileDownload::downloadProgress, this, &FirmwareUpgradeController::_firmwareDownloadProgress);
-    downloader->download(_firmwareFilename);
+    _downloadingFirmware = true;
+    _downloadCache->download(_firmwareFilename);
+}
+
+/// @brief Routes the completed cache downloads to their handlers. Prefetches complete here as well, they are dropped.
+void FirmwareUpgradeController::_cacheDownloadComplete(QString remoteFile, QString localFile, QString errorMsg)
+{
+    if (remoteFile == QLatin1String(_px4ReleasesUrl)) {
+        _px4ReleasesGithubDownloadComplete(remoteFile, localFile, errorMsg);
+    } else if (remoteFile == QLatin1String(_ardupilotManifestUrl)) {
+        _ardupilotManifestDownloadComplete(remoteFile, localFile, errorMsg);
+    } else if (_downloadingFirmware && remoteFile == _firmwareFilename) {
+        _downloadingFirmware = false;
+        _firmwareDownloadComplete(remoteFile, localFile, errorMsg);
+    }
 }
 
 /// @brief Updates the progress indicator while downloading
-void FirmwareUpgradeController::_firmwareDownloadProgress(qint64 curr, qint64 total)
+void FirmwareUpgradeController::_firmwareDownloadProgress(QString remoteFile, qint64 curr, qint64 total)
 {
     // Take care of cases where 0 / 0 is emitted as error return value
-    if (total > 0) {
+    if (_downloadingFirmware && remoteFile == _firmwareFilename && total > 0) {
         _progressBar->setProperty("value", static_cast<float>(curr) / static_cast<float>(total));
     }
 }
@@ -424,6 +448,8 @@ void FirmwareUpgradeController::_firmwareDownloadComplete(QString /*remoteFile*/
     }
 
     _threadController->flash(image);
+    _batchFirmwareFilename  = localFile;
+    _batchBoardID           = _bootloaderBoardID;
     } else {
         _errorCancel(errorMsg);
     }
@@ -454,9 +480,73 @@ void FirmwareUpgradeController::_flashComplete(void)
     _appendStatusLog(tr("Upgrade complete"), true);
     _appendStatusLog("------------------------------------------", false);
     emit flashComplete();
+    emit batchFlashChanged();
     qgcApp()->toolbox()->linkManager()->setConnectionsAllowed();
 }
 
+void FirmwareUpgradeController::startBatchFlash(void)
+{
+    if (_batchFlasher || _batchFirmwareFilename.isEmpty()) {
+        return;
+    }
+
+    // Same as a single board the image is loaded for the board id, the boards then all have to match it
+    _batchImage = new FirmwareImage(this);
+    connect(_batchImage, &FirmwareImage::statusMessage, this, &FirmwareUpgradeController::_status);
+    connect(_batchImage, &FirmwareImage::errorMessage,  this, &FirmwareUpgradeController::_status);
+    if (!_batchImage->load(_batchFirmwareFilename, _batchBoardID)) {
+        _appendStatusLog(tr("Image load failed"), true);
+        delete _batchImage;
+        _batchImage = nullptr;
+        return;
+    }
+
+    qgcApp()->toolbox()->linkManager()->setConnectionsSuspended(tr("Connect not allowed during Firmware Upgrade."));
+
+    _appendStatusLog(tr("Batch upgrade started, plug in the boards to upgrade"), true);
+    _batchFlasher = new FirmwareBatchFlasher(_batchImage, _batchBoardID, this);
+    connect(_batchFlasher, &FirmwareBatchFlasher::status,           this, &FirmwareUpgradeController::_batchStatus);
+    connect(_batchFlasher, &FirmwareBatchFlasher::boardFinished,    this, &FirmwareUpgradeController::_batchBoardFinished);
+    connect(_batchFlasher, &FirmwareBatchFlasher::countsChanged,    this, &FirmwareUpgradeController::batchFlashChanged);
+    emit batchFlashChanged();
+}
+
+void FirmwareUpgradeController::stopBatchFlash(void)
+{
+    if (!_batchFlasher) {
+        return;
+    }
+
+    if (_batchFlasher->activeCount()) {
+        _appendStatusLog(tr("Waiting for %1 boards to finish").arg(_batchFlasher->activeCount()));
+    }
+    int flashedCount    = _batchFlasher->flashedCount();
+    int failedCount     = _batchFlasher->failedCount();
+    delete _batchFlasher;
+    _batchFlasher = nullptr;
+    delete _batchImage;
+    _batchImage = nullptr;
+
+    _appendStatusLog(tr("Batch upgrade stopped: %1 upgraded, %2 failed").arg(flashedCount).arg(failedCount), true);
+    _appendStatusLog("------------------------------------------", false);
+    emit batchFlashChanged();
+    qgcApp()->toolbox()->linkManager()->setConnectionsAllowed();
+}
+
+void FirmwareUpgradeController::_batchStatus(const QString& portName, const QString& statusText)
+{
+    _appendStatusLog(QStringLiteral("%1: %2").arg(portName, statusText));
+}
+
+void FirmwareUpgradeController::_batchBoardFinished(const QString& portName, bool success, const QString& errorString)
+{
+    if (success) {
+        _appendStatusLog(tr("%1: Upgrade complete").arg(portName), true);
+    } else {
+        _appendStatusLog(tr("%1: Error: %2").arg(portName, errorString), true);
+    }
+}
+
 void FirmwareUpgradeController::_error(const QString& errorString)
 {
     delete _image;
@@ -606,9 +696,7 @@ FirmwareUpgradeController::FirmwareVehicleType_t FirmwareUpgradeController::vehi
 
 void FirmwareUpgradeController::_determinePX4StableVersion(void)
 {
-    QGCFileDownload* downloader = new QGCFileDownload(this);
-    connect(downloader, &QGCFileDownload::downloadComplete, this, &FirmwareUpgradeController::_px4ReleasesGithubDownloadComplete);
-    downloader->download(QStringLiteral("https://api.github.com/repos/PX4/Firmware/releases"));
+    _downloadCache->download(QString::fromLatin1(_px4ReleasesUrl));
 }
 
 void FirmwareUpgradeController::_px4ReleasesGithubDownloadComplete(QString /*remoteFile*/, QString localFile, QString errorMsg)
@@ -671,104 +759,151 @@ void FirmwareUpgradeController::_downloadArduPilotManifest(void)
     _downloadingFirmwareList = true;
     emit downloadingFirmwareListChanged(true);
 
-    QGCFileDownload* downloader = new QGCFileDownload(this);
-    connect(downloader, &QGCFileDownload::downloadComplete, this, &FirmwareUpgradeController::_ardupilotManifestDownloadComplete);
-    downloader->download(QStringLiteral("http://firmware.ardupilot.org/manifest.json.gz"));
+    _downloadCache->download(QString::fromLatin1(_ardupilotManifestUrl));
 }
 
 void FirmwareUpgradeController::_ardupilotManifestDownloadComplete(QString remoteFile, QString localFile, QString errorMsg)
 {
     if (errorMsg.isEmpty()) {
-        // Delete the QGCFileDownload object
-        sender()->deleteLater();
-
         qCDebug(FirmwareUpgradeLog) << "_ardupilotManifestDownloadFinished" << remoteFile << localFile;
 
-        QString jsonFileName(QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).absoluteFilePath("ArduPilot.Manifest.json"));
-        if (!QGCZlib::inflateGzipFile(localFile, jsonFileName)) {
-            qCWarning(FirmwareUpgradeLog) << "Inflate of compressed manifest failed" << localFile;
-            return;
-        }
+        // The manifest lists every build of every board, inflating and parsing it would stall the ui
+        _manifestWatcher.setFuture(QtConcurrent::run(&FirmwareUpgradeController::_parseArduPilotManifest,
+                                                     localFile,
+                                                     _manifestMavFirmwareVersionTypeToFirmwareBuildTypeMap,
+                                                     _manifestMavTypeToFirmwareVehicleTypeMap));
+    } else {
+        qCWarning(FirmwareUpgradeLog) << "ArduPilot Manifest download failed" << errorMsg;
+    }
+}
 
-        QString         errorString;
-        QJsonDocument   doc;
-        if (!JsonHelper::isJsonFile(jsonFileName, doc, errorString)) {
-            qCWarning(FirmwareUpgradeLog) << "Json file read failed" << errorString;
-            return;
-        }
+void FirmwareUpgradeController::_ardupilotManifestParseComplete(void)
+{
+    QList<ManifestFirmwareInfo_t> rgManifestFirmwareInfo = _manifestWatcher.result();
+    if (rgManifestFirmwareInfo.isEmpty()) {
+        return;
+    }
+    _rgManifestFirmwareInfo = rgManifestFirmwareInfo;
 
-        QJsonObject json =          doc.object();
-        QJsonArray  rgFirmware =    json[_manifestFirmwareJsonKey].toArray();
+    if (_bootloaderFound) {
+        _buildAPMFirmwareNames();
+    }
 
-        for (int i=0; i<rgFirmware.count(); i++) {
-            const QJsonObject& firmwareJson = rgFirmware[i].toObject();
+    _downloadingFirmwareList = false;
+    emit downloadingFirmwareListChanged(false);
 
-            FirmwareVehicleType_t   firmwareVehicleType =   _manifestMavTypeToFirmwareVehicleType(firmwareJson[_manifestMavTypeJsonKey].toString());
-            FirmwareBuildType_t     firmwareBuildType =     _manifestMavFirmwareVersionTypeToFirmwareBuildType(firmwareJson[_manifestMavFirmwareVersionTypeJsonKey].toString());
-            QString                 format =                firmwareJson[_manifestFormatJsonKey].toString();
-            QString                 platform =              firmwareJson[_manifestPlatformKey].toString();
+    _prefetchFirmware();
+}
 
-            if (firmwareVehicleType != DefaultVehicleFirmware && firmwareBuildType != CustomFirmware && (format == QStringLiteral("apj") || format == QStringLiteral("px4"))) {
-                if (platform.contains("-heli") && firmwareVehicleType != HeliFirmware) {
-                    continue;
-                }
+QList<FirmwareUpgradeController::ManifestFirmwareInfo_t> FirmwareUpgradeController::_parseArduPilotManifest(const QString& localFile, const BuildTypeMap_t& buildTypeMap, const VehicleTypeMap_t& vehicleTypeMap)
+{
+    QList<ManifestFirmwareInfo_t> rgManifestFirmwareInfo;
 
-                _rgManifestFirmwareInfo.append(ManifestFirmwareInfo_t());
-                ManifestFirmwareInfo_t& firmwareInfo = _rgManifestFirmwareInfo.last();
+    QFile manifestFile(localFile);
+    if (!manifestFile.open(QIODevice::ReadOnly)) {
+        qCWarning(FirmwareUpgradeLog) << "Open of compressed manifest failed" << localFile << manifestFile.errorString();
+        return rgManifestFirmwareInfo;
+    }
+    QByteArray jsonBytes;
+    if (!QGCZlib::inflateGzipData(manifestFile.readAll(), jsonBytes)) {
+        qCWarning(FirmwareUpgradeLog) << "Inflate of compressed manifest failed" << localFile;
+        return rgManifestFirmwareInfo;
+    }
 
-                firmwareInfo.boardId =              static_cast<uint32_t>(firmwareJson[_manifestBoardIdJsonKey].toInt());
-                firmwareInfo.firmwareBuildType =    firmwareBuildType;
-                firmwareInfo.vehicleType =          firmwareVehicleType;
-                firmwareInfo.url =                  firmwareJson[_manifestUrlJsonKey].toString();
-                firmwareInfo.version =              firmwareJson[_manifestMavFirmwareVersionJsonKey].toString();
-                firmwareInfo.chibios =              format == QStringLiteral("apj");                firmwareInfo.fmuv2 =                platform.contains(QStringLiteral("fmuv2"));
+    QString         errorString;
+    QJsonDocument   doc;
+    if (!JsonHelper::isJsonFile(jsonBytes, doc, errorString)) {
+        qCWarning(FirmwareUpgradeLog) << "Json file read failed" << errorString;
+        return rgManifestFirmwareInfo;
+    }
 
-                QJsonArray bootloaderArray = firmwareJson[_manifestBootloaderStrJsonKey].toArray();
-                for (int j=0; j<bootloaderArray.count(); j++) {
-                    firmwareInfo.rgBootloaderPortString.append(bootloaderArray[j].toString());
-                }
+    QJsonObject json =          doc.object();
+    QJsonArray  rgFirmware =    json[_manifestFirmwareJsonKey].toArray();
 
-                QJsonArray usbidArray = firmwareJson[_manifestUSBIDJsonKey].toArray();
-                for (int j=0; j<usbidArray.count(); j++) {
-                    QStringList vidpid = usbidArray[j].toString().split('/');
-                    QString vid = vidpid[0];
-                    QString pid = vidpid[1];
+    for (int i=0; i<rgFirmware.count(); i++) {
+        const QJsonObject& firmwareJson = rgFirmware[i].toObject();
 
-                    bool ok;
-                    firmwareInfo.rgVID.append(vid.right(vid.count() - 2).toInt(&ok, 16));
-                    firmwareInfo.rgPID.append(pid.right(pid.count() - 2).toInt(&ok, 16));
-                }
+        FirmwareVehicleType_t   firmwareVehicleType =   vehicleTypeMap.value(firmwareJson[_manifestMavTypeJsonKey].toString(), DefaultVehicleFirmware);
+        FirmwareBuildType_t     firmwareBuildType =     buildTypeMap.value(firmwareJson[_manifestMavFirmwareVersionTypeJsonKey].toString(), CustomFirmware);
+        QString                 format =                firmwareJson[_manifestFormatJsonKey].toString();
+        QString                 platform =              firmwareJson[_manifestPlatformKey].toString();
 
-                QString brandName = firmwareJson[_manifestBrandNameKey].toString();
-                firmwareInfo.friendlyName = QStringLiteral("%1 - %2").arg(brandName.isEmpty() ? platform : brandName).arg(firmwareInfo.version);
+        if (firmwareVehicleType != DefaultVehicleFirmware && firmwareBuildType != CustomFirmware && (format == QStringLiteral("apj") || format == QStringLiteral("px4"))) {
+            if (platform.contains("-heli") && firmwareVehicleType != HeliFirmware) {
+                continue;
             }
-        }
 
-        if (_bootloaderFound) {
-            _buildAPMFirmwareNames();
-        }
+            rgManifestFirmwareInfo.append(ManifestFirmwareInfo_t());
+            ManifestFirmwareInfo_t& firmwareInfo = rgManifestFirmwareInfo.last();
 
-        _downloadingFirmwareList = false;
-        emit downloadingFirmwareListChanged(false);
-    } else {
-        qCWarning(FirmwareUpgradeLog) << "ArduPilot Manifest download failed" << errorMsg;
+            firmwareInfo.boardId =              static_cast<uint32_t>(firmwareJson[_manifestBoardIdJsonKey].toInt());
+            firmwareInfo.firmwareBuildType =    firmwareBuildType;
+            firmwareInfo.vehicleType =          firmwareVehicleType;
+            firmwareInfo.url =                  firmwareJson[_manifestUrlJsonKey].toString();
+            firmwareInfo.version =              firmwareJson[_manifestMavFirmwareVersionJsonKey].toString();
+            firmwareInfo.chibios =              format == QStringLiteral("apj");
+            firmwareInfo.fmuv2 =                platform.contains(QStringLiteral("fmuv2"));
+
+            QJsonArray bootloaderArray = firmwareJson[_manifestBootloaderStrJsonKey].toArray();
+            for (int j=0; j<bootloaderArray.count(); j++) {
+                firmwareInfo.rgBootloaderPortString.append(bootloaderArray[j].toString());
+            }
+
+            QJsonArray usbidArray = firmwareJson[_manifestUSBIDJsonKey].toArray();
+            for (int j=0; j<usbidArray.count(); j++) {
+                QStringList vidpid = usbidArray[j].toString().split('/');
+                QString vid = vidpid[0];
+                QString pid = vidpid[1];
+
+                bool ok;
+                firmwareInfo.rgVID.append(vid.right(vid.count() - 2).toInt(&ok, 16));
+                firmwareInfo.rgPID.append(pid.right(pid.count() - 2).toInt(&ok, 16));
+            }
+
+            QString brandName = firmwareJson[_manifestBrandNameKey].toString();
+            firmwareInfo.friendlyName = QStringLiteral("%1 - %2").arg(brandName.isEmpty() ? platform : brandName).arg(firmwareInfo.version);
+        }
     }
+
+    return rgManifestFirmwareInfo;
 }
 
-FirmwareUpgradeController::FirmwareBuildType_t FirmwareUpgradeController::_manifestMavFirmwareVersionTypeToFirmwareBuildType(const QString& manifestMavFirmwareVersionType)
+/// @brief Downloads the stable firmware of the boards in the prefetch setting into the cache, so a bench of them can be
+///         flashed without waiting on downloads.
+void FirmwareUpgradeController::_prefetchFirmware(void)
 {
-    if (_manifestMavFirmwareVersionTypeToFirmwareBuildTypeMap.contains(manifestMavFirmwareVersionType)) {
-        return _manifestMavFirmwareVersionTypeToFirmwareBuildTypeMap[manifestMavFirmwareVersionType];
-    } else {
-        return CustomFirmware;
+    QStringList remoteFiles;
+    bool        chibios = _apmChibiOSSetting->rawValue().toInt() == 0;
+
+    for (const QString& boardIdString: _prefetchBoardIdsSetting->rawValue().toString().split(QLatin1Char(','), QString::SkipEmptyParts)) {
+        bool        ok;
+        uint32_t    boardId = boardIdString.trimmed().toUInt(&ok);
+        if (!ok) {
+            qCWarning(FirmwareUpgradeLog) << "Invalid board id in firmware prefetch list" << boardIdString;
+            continue;
+        }
+
+        QString px4File = _firmwareHashForBoardId(static_cast<int>(boardId))->value(FirmwareIdentifier(AutoPilotStackPX4, StableFirmware, DefaultVehicleFirmware));
+        if (!px4File.isEmpty()) {
+            remoteFiles.append(px4File);
+        }
+        for (const ManifestFirmwareInfo_t& firmwareInfo: _rgManifestFirmwareInfo) {
+            if (firmwareInfo.boardId == boardId && firmwareInfo.firmwareBuildType == StableFirmware && firmwareInfo.chibios == chibios) {
+                remoteFiles.append(firmwareInfo.url);
+            }
+        }
+    }
+
+    if (!remoteFiles.isEmpty()) {
+        qCDebug(FirmwareUpgradeLog) << "Prefetching firmware" << remoteFiles;
+        _downloadCache->prefetch(remoteFiles);
     }
 }
 
-FirmwareUpgradeController::FirmwareVehicleType_t FirmwareUpgradeController::_manifestMavTypeToFirmwareVehicleType(const QString& manifestMavType)
+void FirmwareUpgradeController::_prefetchComplete(int fileCount, int failedCount)
 {
-    if (_manifestMavTypeToFirmwareVehicleTypeMap.contains(manifestMavType)) {
-        return _manifestMavTypeToFirmwareVehicleTypeMap[manifestMavType];
-    } else {
-        return DefaultVehicleFirmware;
+    qCDebug(FirmwareUpgradeLog) << "Firmware prefetch complete" << fileCount << failedCount;
+    if (_statusLog) {
+        _appendStatusLog(tr("Prefetched %1 firmware files, %2 failed").arg(fileCount - failedCount).arg(failedCount), failedCount != 0);
     }
 }
@@ -10,10 +10,13 @@
 #pragma once
 
 #include "PX4FirmwareUpgradeThread.h"
+#include "FirmwareBatchFlasher.h"
+#include "FirmwareDownloadCache.h"
 #include "FirmwareImage.h"
 #include "Fact.h"
 
 #include <QObject>
+#include <QFutureWatcher>
 #include <QUrl>
 #include <QTimer>
 #include <QNetworkAccessManager>
@@ -97,6 +100,10 @@ public:
     Q_PROPERTY(QStringList          apmFirmwareUrls             MEMBER _apmFirmwareUrls                                             NOTIFY apmFirmwareNamesChanged)
     Q_PROPERTY(QString              px4StableVersion            READ px4StableVersion                                               NOTIFY px4StableVersionChanged)
     Q_PROPERTY(QString              px4BetaVersion              READ px4BetaVersion                                                 NOTIFY px4BetaVersionChanged)
+    Q_PROPERTY(bool                 batchFlashAvailable         READ batchFlashAvailable                                            NOTIFY batchFlashChanged)
+    Q_PROPERTY(bool                 batchFlashing               READ batchFlashing                                                  NOTIFY batchFlashChanged)
+    Q_PROPERTY(int                  batchFlashedCount           READ batchFlashedCount                                              NOTIFY batchFlashChanged)
+    Q_PROPERTY(int                  batchFailedCount            READ batchFailedCount                                               NOTIFY batchFlashChanged)
 
     /// TextArea for log output
     Q_PROPERTY(QQuickItem* statusLog READ statusLog WRITE setStatusLog)
@@ -121,6 +128,11 @@ public:
     Q_INVOKABLE void flashSingleFirmwareMode(FirmwareBuildType_t firmwareType);
 
     Q_INVOKABLE FirmwareVehicleType_t vehicleTypeFromFirmwareSelectionIndex(int index);
+
+    /// Flashes the firmware of the last successful upgrade to every board of the same type which is plugged in
+    /// from now on, several at a time, until stopBatchFlash is called
+    Q_INVOKABLE void startBatchFlash(void);
+    Q_INVOKABLE void stopBatchFlash(void);
     
     // overload, not exposed to qml side
     void flash(const FirmwareIdentifier& firmwareId);
@@ -143,6 +155,11 @@ public:
     QString     px4StableVersion    (void) { return _px4StableVersion; }
     QString     px4BetaVersion  (void) { return _px4BetaVersion; }
 
+    bool batchFlashAvailable    (void) const { return !_batchFirmwareFilename.isEmpty(); }
+    bool batchFlashing          (void) const { return _batchFlasher != nullptr; }
+    int  batchFlashedCount      (void) const { return _batchFlasher ? _batchFlasher->flashedCount() : 0; }
+    int  batchFailedCount       (void) const { return _batchFlasher ? _batchFlasher->failedCount() : 0; }
+
     bool pixhawkBoard(void) const { return _boardType == QGCSerialPortInfo::BoardTypePixhawk; }
     bool px4FlowBoard(void) const { return _boardType == QGCSerialPortInfo::BoardTypePX4Flow; }
 
@@ -166,9 +183,11 @@ signals:
     void px4StableVersionChanged        (const QString& px4StableVersion);
     void px4BetaVersionChanged          (const QString& px4BetaVersion);
     void downloadingFirmwareListChanged (bool downloadingFirmwareList);
+    void batchFlashChanged              (void);
 
 private slots:
-    void _firmwareDownloadProgress          (qint64 curr, qint64 total);
+    void _firmwareDownloadProgress          (QString remoteFile, qint64 curr, qint64 total);
+    void _cacheDownloadComplete             (QString remoteFile, QString localFile, QString errorMsg);
     void _firmwareDownloadComplete          (QString remoteFile, QString localFile, QString errorMsg);
     void _foundBoard                        (bool firstAttempt, const QSerialPortInfo& portInfo, int boardType, QString boardName);
     void _noBoardFound                      (void);
@@ -184,7 +203,12 @@ private slots:
     void _eraseProgressTick                 (void);
     void _px4ReleasesGithubDownloadComplete (QString remoteFile, QString localFile, QString errorMsg);
     void _ardupilotManifestDownloadComplete (QString remoteFile, QString localFile, QString errorMsg);
+    void _ardupilotManifestParseComplete    (void);
+    void _prefetchFirmware                  (void);
+    void _prefetchComplete                  (int fileCount, int failedCount);
     void _buildAPMFirmwareNames             (void);
+    void _batchStatus                       (const QString& portName, const QString& statusText);
+    void _batchBoardFinished                (const QString& portName, bool success, const QString& errorString);
 
 private:
     QHash<FirmwareIdentifier, QString>* _firmwareHashForBoardId(int boardId);
@@ -225,9 +249,10 @@ private:
     QPixmap _boardIcon;             ///< Icon used to display image of board
     
     QString _firmwareFilename;      ///< Image which we are going to flash to the board
+    bool    _downloadingFirmware = false;   ///< true: waiting on the download of _firmwareFilename
     
-    QNetworkAccessManager*  _downloadManager;       ///< Used for firmware file downloading across the internet
     QNetworkReply*          _downloadNetworkReply;  ///< Used for firmware file downloading across the internet
+    FirmwareDownloadCache*  _downloadCache;         ///< Manifests and images, revalidated instead of downloaded again
     
     /// @brief Thread controller which is used to run bootloader commands on separate thread
     PX4FirmwareUpgradeThreadController* _threadController;
@@ -253,6 +278,11 @@ private:
 
     FirmwareImage*                  _image;
 
+    QString                         _batchFirmwareFilename;     ///< Firmware file of the last successful upgrade
+    uint32_t                        _batchBoardID = 0;          ///< Board id it was flashed to
+    FirmwareImage*                  _batchImage = nullptr;
+    FirmwareBatchFlasher*           _batchFlasher = nullptr;
+
     QString _px4StableVersion;  // Version strange for latest PX4 stable
     QString _px4BetaVersion;    // Version strange for latest PX4 beta
 
@@ -270,6 +300,8 @@ private:
     static const char* _manifestLatestKey;
     static const char* _manifestPlatformKey;
     static const char* _manifestBrandNameKey;
+    static const char* _px4ReleasesUrl;
+    static const char* _ardupilotManifestUrl;
 
     typedef struct {
         uint32_t                boardId;
@@ -285,18 +317,22 @@ private:
         bool                    fmuv2;
     } ManifestFirmwareInfo_t;
 
+    typedef QMap<QString, FirmwareBuildType_t>      BuildTypeMap_t;
+    typedef QMap<QString, FirmwareVehicleType_t>    VehicleTypeMap_t;
+
+    /// Inflates and parses the ArduPilot manifest, runs on a worker thread
+    static QList<ManifestFirmwareInfo_t> _parseArduPilotManifest(const QString& localFile, const BuildTypeMap_t& buildTypeMap, const VehicleTypeMap_t& vehicleTypeMap);
 
     QList<ManifestFirmwareInfo_t>           _rgManifestFirmwareInfo;
-    QMap<QString, FirmwareBuildType_t>      _manifestMavFirmwareVersionTypeToFirmwareBuildTypeMap;
-    QMap<QString, FirmwareVehicleType_t>    _manifestMavTypeToFirmwareVehicleTypeMap;
+    QFutureWatcher<QList<ManifestFirmwareInfo_t>>   _manifestWatcher;
+    BuildTypeMap_t                          _manifestMavFirmwareVersionTypeToFirmwareBuildTypeMap;
+    VehicleTypeMap_t                        _manifestMavTypeToFirmwareVehicleTypeMap;
     QStringList                             _apmFirmwareNames;
     int                                     _apmFirmwareNamesBestIndex = 0;
     QStringList                             _apmFirmwareUrls;
     Fact*                                   _apmChibiOSSetting;
     Fact*                                   _apmVehicleTypeSetting;
-
-    FirmwareBuildType_t     _manifestMavFirmwareVersionTypeToFirmwareBuildType  (const QString& manifestMavFirmwareVersionType);
-    FirmwareVehicleType_t   _manifestMavTypeToFirmwareVehicleType               (const QString& manifestMavType);
+    Fact*                                   _prefetchBoardIdsSetting;
 };
 
 // global hashing function
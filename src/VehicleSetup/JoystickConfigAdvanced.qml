@@ -158,6 +158,30 @@ Item {
             visible:            advancedSettings.checked
         }
         //-----------------------------------------------------------------
+        //-- Event driven input
+        QGCLabel {
+            text:               qsTr("Send on change (event driven)")
+            Layout.alignment:   Qt.AlignVCenter
+            visible:            advancedSettings.checked
+        }
+        QGCCheckBox {
+            enabled:            advancedSettings.checked
+            checked:            _activeJoystick.eventDriven
+            onClicked:          _activeJoystick.eventDriven = checked
+            Layout.alignment:   Qt.AlignVCenter
+            visible:            advancedSettings.checked
+        }
+        QGCLabel {
+            text:               qsTr("Input latency (ms):")
+            Layout.alignment:   Qt.AlignVCenter
+            visible:            advancedSettings.checked && _activeJoystick.eventDriven
+        }
+        QGCLabel {
+            text:               qsTr("%1 mean, %2 max").arg(_activeJoystick.inputLatencyMSecs.toFixed(2)).arg(_activeJoystick.maxInputLatencyMSecs.toFixed(2))
+            Layout.alignment:   Qt.AlignVCenter
+            visible:            advancedSettings.checked && _activeJoystick.eventDriven
+        }
+        //-----------------------------------------------------------------
         //-- Deadband
         QGCLabel {
             text:               qsTr("Deadbands")
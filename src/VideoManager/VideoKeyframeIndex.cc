@@ -0,0 +1,697 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VideoKeyframeIndex.h"
+
+#include <QFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(VideoKeyframeIndexLog, "VideoKeyframeIndexLog")
+
+static constexpr quint32 _fourcc(const char* code)
+{
+    return (static_cast<quint32>(static_cast<uchar>(code[0])) << 24) | (static_cast<quint32>(static_cast<uchar>(code[1])) << 16) |
+           (static_cast<quint32>(static_cast<uchar>(code[2])) << 8)  |  static_cast<quint32>(static_cast<uchar>(code[3]));
+}
+
+// Matroska element ids, with their length marker
+static const quint32 kEbmlHeaderId          = 0x1A45DFA3;
+static const quint32 kSegmentId             = 0x18538067;
+static const quint32 kSeekHeadId            = 0x114D9B74;
+static const quint32 kSeekId                = 0x4DBB;
+static const quint32 kSeekIdId              = 0x53AB;
+static const quint32 kSeekPositionId        = 0x53AC;
+static const quint32 kInfoId                = 0x1549A966;
+static const quint32 kTimestampScaleId      = 0x2AD7B1;
+static const quint32 kDurationId            = 0x4489;
+static const quint32 kDateUtcId             = 0x4461;
+static const quint32 kTracksId              = 0x1654AE6B;
+static const quint32 kTrackEntryId          = 0xAE;
+static const quint32 kTrackNumberId         = 0xD7;
+static const quint32 kTrackTypeId           = 0x83;
+static const quint32 kClusterId             = 0x1F43B675;
+static const quint32 kCuesId                = 0x1C53BB6B;
+static const quint32 kCuePointId            = 0xBB;
+static const quint32 kCueTimeId             = 0xB3;
+static const quint32 kCueTrackPositionsId   = 0xB7;
+static const quint32 kCueTrackId            = 0xF7;
+
+static const quint64 kMatroskaVideoTrack    = 1;
+static const quint32 kMp4NonSyncSample      = 0x00010000;   ///< sample_is_non_sync_sample of the fragment sample flags
+
+static inline const uchar* _bytes(const QByteArray& data, int pos)
+{
+    return reinterpret_cast<const uchar*>(data.constData()) + pos;
+}
+
+VideoKeyframeIndex::VideoKeyframeIndex(void)
+{
+
+}
+
+void VideoKeyframeIndex::_clear(void)
+{
+    _keyframes.clear();
+    _durationUSecs  = 0;
+    _startTimeMSecs = 0;
+}
+
+bool VideoKeyframeIndex::build(const QString& videoFileName, QString& errorString)
+{
+    _clear();
+
+    QFile file(videoFileName);
+    if (!file.open(QFile::ReadOnly)) {
+        errorString = tr("Unable to open video file: %1").arg(file.errorString());
+        return false;
+    }
+
+    const QByteArray header = file.read(8);
+    if (header.size() < 8) {
+        errorString = tr("Video file is empty");
+        return false;
+    }
+
+    bool success = false;
+    if (qFromBigEndian<quint32>(_bytes(header, 0)) == kEbmlHeaderId) {
+        success = _buildMatroska(file, errorString);
+    } else {
+        switch (qFromBigEndian<quint32>(_bytes(header, 4))) {
+        case _fourcc("ftyp"):
+        case _fourcc("styp"):
+        case _fourcc("moov"):
+        case _fourcc("mdat"):
+        case _fourcc("free"):
+        case _fourcc("skip"):
+        case _fourcc("wide"):
+            success = _buildMp4(file, errorString);
+            break;
+        default:
+            errorString = tr("Unsupported video file format, only MP4, MOV and MKV recordings can be replayed");
+            break;
+        }
+    }
+
+    if (success && _keyframes.isEmpty()) {
+        errorString = tr("No key frames found in video file");
+        success = false;
+    }
+    if (!success) {
+        _clear();
+        return false;
+    }
+
+    // Composition offsets can put key frames out of decode order
+    std::sort(_keyframes.begin(), _keyframes.end());
+    _durationUSecs = qMax(_durationUSecs, _keyframes.last());
+
+    qCDebug(VideoKeyframeIndexLog) << "Indexed" << videoFileName << "key frames:" << _keyframes.count() << "duration:" << _durationUSecs << "start:" << _startTimeMSecs;
+    return true;
+}
+
+int VideoKeyframeIndex::keyframeForTime(qint64 timeUSecs) const
+{
+    auto it = std::upper_bound(_keyframes.constBegin(), _keyframes.constEnd(), timeUSecs);
+    return it == _keyframes.constBegin() ? 0 : static_cast<int>(it - _keyframes.constBegin()) - 1;
+}
+
+void VideoKeyframeIndex::_forEachBox(const QByteArray& data, int begin, int end, const Visitor_t& visit)
+{
+    int pos = begin;
+    while (pos + 8 <= end) {
+        quint64         size    = qFromBigEndian<quint32>(_bytes(data, pos));
+        const quint32   type    = qFromBigEndian<quint32>(_bytes(data, pos + 4));
+        int             header  = 8;
+        if (size == 1) {
+            if (pos + 16 > end) {
+                return;
+            }
+            size    = qFromBigEndian<quint64>(_bytes(data, pos + 8));
+            header  = 16;
+        } else if (size == 0) {
+            size = static_cast<quint64>(end - pos);
+        }
+        if (size < static_cast<quint64>(header) || size > static_cast<quint64>(end - pos)) {
+            qCWarning(VideoKeyframeIndexLog) << "Corrupt box at" << pos;
+            return;
+        }
+        visit(type, pos + header, pos + static_cast<int>(size));
+        pos += static_cast<int>(size);
+    }
+}
+
+bool VideoKeyframeIndex::_buildMp4(QFile& file, QString& errorString)
+{
+    Mp4Track_t track;
+    memset(&track, 0, sizeof(track));
+
+    const qint64    fileSize    = file.size();
+    qint64          offset      = 0;
+    bool            haveMoov    = false;
+
+    // Top level boxes, anything but moov and moof is skipped without reading it
+    while (offset + 8 <= fileSize) {
+        uchar header[16];
+        if (!file.seek(offset) || file.read(reinterpret_cast<char*>(header), 8) != 8) {
+            break;
+        }
+        quint64         size        = qFromBigEndian<quint32>(header);
+        const quint32   type        = qFromBigEndian<quint32>(header + 4);
+        qint64          headerSize  = 8;
+        if (size == 1) {
+            if (file.read(reinterpret_cast<char*>(header + 8), 8) != 8) {
+                break;
+            }
+            size        = qFromBigEndian<quint64>(header + 8);
+            headerSize  = 16;
+        } else if (size == 0) {
+            size = static_cast<quint64>(fileSize - offset);
+        }
+        if (size < static_cast<quint64>(headerSize)) {
+            qCWarning(VideoKeyframeIndexLog) << "Corrupt top level box at" << offset;
+            break;
+        }
+
+        const qint64 dataSize = qMin(static_cast<qint64>(size), fileSize - offset) - headerSize;
+        if (type == _fourcc("moov") || (type == _fourcc("moof") && haveMoov)) {
+            if (dataSize > _maxIndexBytes) {
+                errorString = tr("Video file index is too large");
+                return false;
+            }
+            const QByteArray data = file.read(dataSize);
+            if (data.size() != dataSize) {
+                // Recording which was cut short, keep what was found so far
+                break;
+            }
+            if (type == _fourcc("moov")) {
+                _parseMoov(data, track);
+                haveMoov = true;
+            } else {
+                _parseMoof(data, track);
+            }
+        }
+
+        offset += static_cast<qint64>(size);
+    }
+
+    if (!haveMoov) {
+        errorString = tr("Video file has no movie header");
+        return false;
+    }
+    if (track.timescale == 0) {
+        errorString = tr("Video file has no video track");
+        return false;
+    }
+
+    _durationUSecs = qMax(_durationUSecs, track.editEmptyUSecs + ((track.endDts - track.editMediaTime) * 1000000) / track.timescale);
+    return true;
+}
+
+void VideoKeyframeIndex::_parseMoov(const QByteArray& moov, Mp4Track_t& track)
+{
+    quint32 movieTimescale = 0;
+
+    _forEachBox(moov, 0, moov.size(), [&](quint32 type, int begin, int end) {
+        if (type == _fourcc("mvhd") && end - begin >= 32) {
+            const uchar*    p       = _bytes(moov, begin);
+            const bool      v1      = p[0] == 1;
+            const quint64   created = v1 ? qFromBigEndian<quint64>(p + 4) : qFromBigEndian<quint32>(p + 4);
+            const quint32   scale   = qFromBigEndian<quint32>(p + (v1 ? 20 : 12));
+            const quint64   length  = v1 ? qFromBigEndian<quint64>(p + 24) : qFromBigEndian<quint32>(p + 16);
+            if (created > static_cast<quint64>(mp4EpochOffsetSecs)) {
+                _startTimeMSecs = (static_cast<qint64>(created) - mp4EpochOffsetSecs) * 1000;
+            }
+            movieTimescale = scale;
+            if (scale) {
+                _durationUSecs = qMax(_durationUSecs, static_cast<qint64>((length * 1000000) / scale));
+            }
+        } else if (type == _fourcc("trak") && track.timescale == 0) {
+            Mp4Track_t candidate;
+            memset(&candidate, 0, sizeof(candidate));
+            _parseTrak(moov, begin, end, candidate);
+            if (candidate.handler == _fourcc("vide") && candidate.timescale) {
+                track = candidate;
+                track.editEmptyUSecs = movieTimescale ? (track.editEmptyDuration * 1000000) / movieTimescale : 0;
+            }
+        } else if (type == _fourcc("mvex")) {
+            // Fragment defaults, the video track is read first as moov lists its tracks before mvex
+            _forEachBox(moov, begin, end, [&](quint32 type, int begin, int end) {
+                if (type == _fourcc("trex") && end - begin >= 24) {
+                    const uchar* p = _bytes(moov, begin);
+                    if (qFromBigEndian<quint32>(p + 4) == track.trackId) {
+                        track.defaultDuration   = qFromBigEndian<quint32>(p + 12);
+                        track.defaultFlags      = qFromBigEndian<quint32>(p + 20);
+                    }
+                }
+            });
+        }
+    });
+
+    if (track.timescale == 0) {
+        return;
+    }
+
+    // Decode times from stts, composition offsets from ctts, sync samples from stss (all of them without one)
+    const uchar*    stts        = _bytes(moov, track.stts[0]);
+    const int       sttsCount   = track.stts[1] - track.stts[0] >= 8 ? qMin<int>(qFromBigEndian<quint32>(stts + 4), (track.stts[1] - track.stts[0] - 8) / 8) : 0;
+    const uchar*    ctts        = _bytes(moov, track.ctts[0]);
+    const int       cttsCount   = track.ctts[1] - track.ctts[0] >= 8 ? qMin<int>(qFromBigEndian<quint32>(ctts + 4), (track.ctts[1] - track.ctts[0] - 8) / 8) : 0;
+    const uchar*    stss        = _bytes(moov, track.stss[0]);
+    const bool      allSync     = track.stss[1] - track.stss[0] < 8;
+    const int       stssCount   = allSync ? 0 : qMin<int>(qFromBigEndian<quint32>(stss + 4), (track.stss[1] - track.stss[0] - 8) / 4);
+
+    int     cttsEntry   = 0;
+    quint32 cttsLeft    = cttsCount ? qFromBigEndian<quint32>(ctts + 8) : 0;
+    int     stssEntry   = 0;
+    quint32 sample      = 1;
+    qint64  dts         = 0;
+
+    for (int entry = 0; entry < sttsCount; entry++) {
+        const quint32 count = qFromBigEndian<quint32>(stts + 8 + (entry * 8));
+        const quint32 delta = qFromBigEndian<quint32>(stts + 12 + (entry * 8));
+
+        for (quint32 i = 0; i < count; i++, sample++) {
+            qint32 cto = 0;
+            while (cttsEntry < cttsCount && cttsLeft == 0) {
+                if (++cttsEntry < cttsCount) {
+                    cttsLeft = qFromBigEndian<quint32>(ctts + 8 + (cttsEntry * 8));
+                }
+            }
+            if (cttsEntry < cttsCount) {
+                cto = qFromBigEndian<qint32>(ctts + 12 + (cttsEntry * 8));
+                cttsLeft--;
+            }
+
+            bool sync = allSync;
+            while (!sync && stssEntry < stssCount && qFromBigEndian<quint32>(stss + 8 + (stssEntry * 4)) <= sample) {
+                sync = qFromBigEndian<quint32>(stss + 8 + (stssEntry * 4)) == sample;
+                stssEntry++;
+            }
+            if (sync) {
+                _addMp4Keyframe(track, dts + cto);
+            }
+
+            dts += delta;
+        }
+    }
+    track.endDts = dts;
+}
+
+void VideoKeyframeIndex::_parseTrak(const QByteArray& moov, int begin, int end, Mp4Track_t& track)
+{
+    _forEachBox(moov, begin, end, [&](quint32 type, int begin, int end) {
+        const uchar* p = _bytes(moov, begin);
+
+        switch (type) {
+        case _fourcc("tkhd"):
+            if (end - begin >= 24) {
+                track.trackId = qFromBigEndian<quint32>(p + (p[0] == 1 ? 20 : 12));
+            }
+            break;
+        case _fourcc("mdhd"):
+            if (end - begin >= 24) {
+                track.timescale = qFromBigEndian<quint32>(p + (p[0] == 1 ? 20 : 12));
+            }
+            break;
+        case _fourcc("hdlr"):
+            if (end - begin >= 12) {
+                track.handler = qFromBigEndian<quint32>(p + 8);
+            }
+            break;
+        case _fourcc("elst"):
+            if (end - begin >= 8) {
+                // Empty edits delay the track, the first one with media says where it starts
+                const bool      v1          = p[0] == 1;
+                const int       entrySize   = v1 ? 20 : 12;
+                const quint32   count       = qFromBigEndian<quint32>(p + 4);
+                for (quint32 i = 0; i < count && 8 + ((i + 1) * entrySize) <= static_cast<quint32>(end - begin); i++) {
+                    const uchar*    e           = p + 8 + (i * entrySize);
+                    const qint64    duration    = v1 ? qFromBigEndian<qint64>(e) : qFromBigEndian<quint32>(e);
+                    const qint64    mediaTime   = v1 ? qFromBigEndian<qint64>(e + 8) : qFromBigEndian<qint32>(e + 4);
+                    if (mediaTime < 0) {
+                        track.editEmptyDuration += duration;
+                    } else {
+                        track.editMediaTime = mediaTime;
+                        break;
+                    }
+                }
+            }
+            break;
+        case _fourcc("stts"):
+            track.stts[0] = begin;
+            track.stts[1] = end;
+            break;
+        case _fourcc("ctts"):
+            track.ctts[0] = begin;
+            track.ctts[1] = end;
+            break;
+        case _fourcc("stss"):
+            track.stss[0] = begin;
+            track.stss[1] = end;
+            break;
+        case _fourcc("mdia"):
+        case _fourcc("minf"):
+        case _fourcc("stbl"):
+        case _fourcc("edts"):
+            _parseTrak(moov, begin, end, track);
+            break;
+        default:
+            break;
+        }
+    });
+}
+
+void VideoKeyframeIndex::_parseMoof(const QByteArray& moof, Mp4Track_t& track)
+{
+    _forEachBox(moof, 0, moof.size(), [&](quint32 type, int begin, int end) {
+        if (type != _fourcc("traf")) {
+            return;
+        }
+
+        bool    ourTrack        = false;
+        quint32 defaultDuration = track.defaultDuration;
+        quint32 defaultFlags    = track.defaultFlags;
+
+        _forEachBox(moof, begin, end, [&](quint32 type, int begin, int end) {
+            const uchar*    p       = _bytes(moof, begin);
+            const int       length  = end - begin;
+
+            if (type == _fourcc("tfhd") && length >= 8) {
+                const quint32   flags   = qFromBigEndian<quint32>(p) & 0xFFFFFF;
+                int             pos     = 8;
+                ourTrack = qFromBigEndian<quint32>(p + 4) == track.trackId;
+                pos += (flags & 0x01) ? 8 : 0;      // base_data_offset
+                pos += (flags & 0x02) ? 4 : 0;      // sample_description_index
+                if ((flags & 0x08) && pos + 4 <= length) {
+                    defaultDuration = qFromBigEndian<quint32>(p + pos);
+                    pos += 4;
+                }
+                pos += (flags & 0x10) ? 4 : 0;      // default_sample_size
+                if ((flags & 0x20) && pos + 4 <= length) {
+                    defaultFlags = qFromBigEndian<quint32>(p + pos);
+                }
+            } else if (!ourTrack) {
+                return;
+            } else if (type == _fourcc("tfdt") && length >= 8) {
+                track.endDts = p[0] == 1 && length >= 12 ? qFromBigEndian<qint64>(p + 4) : qFromBigEndian<quint32>(p + 4);
+            } else if (type == _fourcc("trun") && length >= 8) {
+                const quint32   flags   = qFromBigEndian<quint32>(p) & 0xFFFFFF;
+                const quint32   count   = qFromBigEndian<quint32>(p + 4);
+                int             pos     = 8;
+                bool            first   = false;
+                quint32         firstFlags = 0;
+
+                pos += (flags & 0x001) ? 4 : 0;     // data_offset
+                if (flags & 0x004) {
+                    if (pos + 4 > length) {
+                        return;
+                    }
+                    first       = true;
+                    firstFlags  = qFromBigEndian<quint32>(p + pos);
+                    pos += 4;
+                }
+
+                const int sampleSize = ((flags & 0x100) ? 4 : 0) + ((flags & 0x200) ? 4 : 0) + ((flags & 0x400) ? 4 : 0) + ((flags & 0x800) ? 4 : 0);
+                for (quint32 i = 0; i < count && pos + sampleSize <= length; i++) {
+                    quint32 duration    = defaultDuration;
+                    quint32 sampleFlags = (i == 0 && first) ? firstFlags : defaultFlags;
+                    qint32  cto         = 0;
+                    if (flags & 0x100) {
+                        duration = qFromBigEndian<quint32>(p + pos);
+                        pos += 4;
+                    }
+                    pos += (flags & 0x200) ? 4 : 0;     // sample_size
+                    if (flags & 0x400) {
+                        const quint32 explicitFlags = qFromBigEndian<quint32>(p + pos);
+                        if (!(i == 0 && first)) {
+                            sampleFlags = explicitFlags;
+                        }
+                        pos += 4;
+                    }
+                    if (flags & 0x800) {
+                        cto = qFromBigEndian<qint32>(p + pos);
+                        pos += 4;
+                    }
+
+                    if (!(sampleFlags & kMp4NonSyncSample)) {
+                        _addMp4Keyframe(track, track.endDts + cto);
+                    }
+                    track.endDts += duration;
+                }
+            }
+        });
+    });
+}
+
+void VideoKeyframeIndex::_addMp4Keyframe(const Mp4Track_t& track, qint64 pts)
+{
+    const qint64 timeUSecs = track.editEmptyUSecs + ((pts - track.editMediaTime) * 1000000) / track.timescale;
+    _keyframes.append(qMax<qint64>(timeUSecs, 0));
+}
+
+bool VideoKeyframeIndex::_readVint(const uchar* bytes, qint64 available, bool keepMarker, quint64& value, int& length, bool* unknown)
+{
+    if (available < 1 || bytes[0] == 0) {
+        return false;
+    }
+
+    uchar mask = 0x80;
+    length = 1;
+    while (!(bytes[0] & mask)) {
+        mask >>= 1;
+        length++;
+    }
+    if (length > available) {
+        return false;
+    }
+
+    value = keepMarker ? bytes[0] : (bytes[0] & (mask - 1));
+    for (int i = 1; i < length; i++) {
+        value = (value << 8) | bytes[i];
+    }
+    if (unknown) {
+        // All value bits set
+        *unknown = !keepMarker && value == ((Q_UINT64_C(1) << (7 * length)) - 1);
+    }
+    return true;
+}
+
+void VideoKeyframeIndex::_forEachElement(const QByteArray& data, int begin, int end, const Visitor_t& visit)
+{
+    int pos = begin;
+    while (pos < end) {
+        quint64 id, size;
+        int     idLength, sizeLength;
+        bool    unknown;
+        if (!_readVint(_bytes(data, pos), end - pos, true, id, idLength) ||
+                !_readVint(_bytes(data, pos + idLength), end - pos - idLength, false, size, sizeLength, &unknown)) {
+            return;
+        }
+        const int dataBegin = pos + idLength + sizeLength;
+        if (unknown || size > static_cast<quint64>(end - dataBegin)) {
+            size = static_cast<quint64>(end - dataBegin);
+        }
+        visit(static_cast<quint32>(id), dataBegin, dataBegin + static_cast<int>(size));
+        pos = dataBegin + static_cast<int>(size);
+    }
+}
+
+/// Reads the header of an element in the file
+///     @param size -1 for an unknown size
+bool VideoKeyframeIndex::_readFileElement(QFile& file, qint64 offset, quint32& id, qint64& dataOffset, qint64& size)
+{
+    if (!file.seek(offset)) {
+        return false;
+    }
+    const QByteArray header = file.read(12);
+
+    quint64 value;
+    int     idLength, sizeLength;
+    bool    unknown;
+    if (!_readVint(_bytes(header, 0), header.size(), true, value, idLength)) {
+        return false;
+    }
+    id = static_cast<quint32>(value);
+    if (!_readVint(_bytes(header, idLength), header.size() - idLength, false, value, sizeLength, &unknown)) {
+        return false;
+    }
+    dataOffset  = offset + idLength + sizeLength;
+    size        = unknown ? -1 : static_cast<qint64>(value);
+    return true;
+}
+
+quint64 VideoKeyframeIndex::_readUInt(const QByteArray& data, int begin, int end)
+{
+    quint64 value = 0;
+    for (int i = begin; i < end && i < begin + 8; i++) {
+        value = (value << 8) | static_cast<uchar>(data[i]);
+    }
+    return value;
+}
+
+double VideoKeyframeIndex::_readFloat(const QByteArray& data, int begin, int end)
+{
+    if (end - begin == 4) {
+        const quint32 bits = qFromBigEndian<quint32>(_bytes(data, begin));
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return static_cast<double>(value);
+    } else if (end - begin == 8) {
+        const quint64 bits = qFromBigEndian<quint64>(_bytes(data, begin));
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    return 0;
+}
+
+bool VideoKeyframeIndex::_buildMatroska(QFile& file, QString& errorString)
+{
+    const qint64    fileSize    = file.size();
+    quint32         id;
+    qint64          dataOffset, size;
+
+    // EBML header, then the segment
+    if (!_readFileElement(file, 0, id, dataOffset, size) || size < 0) {
+        errorString = tr("Corrupt video file header");
+        return false;
+    }
+    if (!_readFileElement(file, dataOffset + size, id, dataOffset, size) || id != kSegmentId) {
+        errorString = tr("Video file has no segment");
+        return false;
+    }
+
+    const qint64    segmentOffset   = dataOffset;
+    const qint64    segmentEnd      = size < 0 ? fileSize : qMin(fileSize, dataOffset + size);
+    qint64          cuesOffset      = -1;           ///< From the seek head, relative to segmentOffset
+    quint64         timestampScale  = 1000000;
+    double          duration        = 0;
+    quint64         videoTrack      = 0;
+    QByteArray      cues;
+
+    // Segment children up to the first cluster of unknown size, clusters are skipped without reading them
+    auto readElement = [&file](qint64 offset, qint64 size, QByteArray& data) {
+        if (size > _maxIndexBytes || !file.seek(offset)) {
+            return false;
+        }
+        data = file.read(size);
+        return data.size() == size;
+    };
+
+    qint64 offset = segmentOffset;
+    while (offset < segmentEnd && _readFileElement(file, offset, id, dataOffset, size)) {
+        if (size < 0) {
+            break;
+        }
+
+        QByteArray data;
+        switch (id) {
+        case kSeekHeadId:
+            if (readElement(dataOffset, size, data)) {
+                _forEachElement(data, 0, data.size(), [&](quint32 id, int begin, int end) {
+                    if (id != kSeekId) {
+                        return;
+                    }
+                    quint64 seekId = 0, seekPosition = 0;
+                    _forEachElement(data, begin, end, [&](quint32 id, int begin, int end) {
+                        if (id == kSeekIdId) {
+                            seekId = _readUInt(data, begin, end);
+                        } else if (id == kSeekPositionId) {
+                            seekPosition = _readUInt(data, begin, end);
+                        }
+                    });
+                    if (seekId == kCuesId) {
+                        cuesOffset = static_cast<qint64>(seekPosition);
+                    }
+                });
+            }
+            break;
+        case kInfoId:
+            if (readElement(dataOffset, size, data)) {
+                _forEachElement(data, 0, data.size(), [&](quint32 id, int begin, int end) {
+                    if (id == kTimestampScaleId) {
+                        timestampScale = _readUInt(data, begin, end);
+                    } else if (id == kDurationId) {
+                        duration = _readFloat(data, begin, end);
+                    } else if (id == kDateUtcId && end - begin == 8) {
+                        const qint64 nsecs = qFromBigEndian<qint64>(_bytes(data, begin));
+                        _startTimeMSecs = (matroskaEpochOffsetSecs * 1000) + (nsecs / 1000000);
+                    }
+                });
+            }
+            break;
+        case kTracksId:
+            if (readElement(dataOffset, size, data)) {
+                _forEachElement(data, 0, data.size(), [&](quint32 id, int begin, int end) {
+                    if (id != kTrackEntryId || videoTrack) {
+                        return;
+                    }
+                    quint64 number = 0, type = 0;
+                    _forEachElement(data, begin, end, [&](quint32 id, int begin, int end) {
+                        if (id == kTrackNumberId) {
+                            number = _readUInt(data, begin, end);
+                        } else if (id == kTrackTypeId) {
+                            type = _readUInt(data, begin, end);
+                        }
+                    });
+                    if (type == kMatroskaVideoTrack) {
+                        videoTrack = number;
+                    }
+                });
+            }
+            break;
+        case kCuesId:
+            readElement(dataOffset, size, cues);
+            break;
+        case kClusterId:
+            // Media
+            break;
+        default:
+            break;
+        }
+
+        offset = dataOffset + size;
+    }
+
+    if (cues.isEmpty() && cuesOffset >= 0 && _readFileElement(file, segmentOffset + cuesOffset, id, dataOffset, size) && id == kCuesId && size >= 0) {
+        readElement(dataOffset, size, cues);
+    }
+    if (cues.isEmpty()) {
+        errorString = tr("Video file has no seek index, it may not have been closed properly");
+        return false;
+    }
+
+    _forEachElement(cues, 0, cues.size(), [&](quint32 id, int begin, int end) {
+        if (id != kCuePointId) {
+            return;
+        }
+        quint64 cueTime     = 0;
+        bool    videoCue    = videoTrack == 0;
+        _forEachElement(cues, begin, end, [&](quint32 id, int begin, int end) {
+            if (id == kCueTimeId) {
+                cueTime = _readUInt(cues, begin, end);
+            } else if (id == kCueTrackPositionsId) {
+                _forEachElement(cues, begin, end, [&](quint32 id, int begin, int end) {
+                    if (id == kCueTrackId && _readUInt(cues, begin, end) == videoTrack) {
+                        videoCue = true;
+                    }
+                });
+            }
+        });
+        if (videoCue) {
+            _keyframes.append(static_cast<qint64>((cueTime * timestampScale) / 1000));
+        }
+    });
+
+    _durationUSecs = static_cast<qint64>((duration * timestampScale) / 1000);
+    return true;
+}
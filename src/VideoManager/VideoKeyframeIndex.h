@@ -0,0 +1,93 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCLoggingCategory.h"
+
+#include <QCoreApplication>
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+Q_DECLARE_LOGGING_CATEGORY(VideoKeyframeIndexLog)
+
+class QFile;
+
+/// Key frame times of a recorded video, which lets a replay find the key frame for a position with a binary search.
+///
+/// The times come from the seek tables the container already has, the file is never decoded:
+///     MP4/MOV     Sample tables of the first video track (stts, ctts, stss, elst), followed by the track runs of any
+///                 movie fragments, which is how fragmented recordings keep theirs
+///     MKV         Cues of the first video track, which matroskamux writes once the recording is finished
+/// Only the index boxes or elements are read, media data is skipped over.
+class VideoKeyframeIndex
+{
+    Q_DECLARE_TR_FUNCTIONS(VideoKeyframeIndex)
+
+public:
+    VideoKeyframeIndex(void);
+
+    /// Reads the key frames of the file
+    /// @return false: failed, unsupported format or no key frames found, errorString set
+    bool build(const QString& videoFileName, QString& errorString);
+
+    bool    isValid         (void) const { return !_keyframes.isEmpty(); }
+    qint64  durationUSecs   (void) const { return _durationUSecs; }
+    qint64  startTimeMSecs  (void) const { return _startTimeMSecs; }    ///< Recording start, msecs since the epoch UTC. 0 if the file doesn't say.
+
+    /// Presentation times in microseconds from the start of the video, ascending
+    const QVector<qint64>& keyframes(void) const { return _keyframes; }
+
+    /// @return Index of the latest key frame at or before timeUSecs, the first one for earlier times. Index must be valid.
+    int keyframeForTime(qint64 timeUSecs) const;
+
+    static const qint64 mp4EpochOffsetSecs      = 2082844800;   ///< 1904-01-01 to 1970-01-01
+    static const qint64 matroskaEpochOffsetSecs = 978307200;    ///< 1970-01-01 to 2001-01-01
+
+private:
+    typedef struct {
+        quint32     trackId;
+        quint32     timescale;
+        quint32     handler;
+        qint64      editMediaTime;          ///< Media time shown first, in timescale units
+        qint64      editEmptyDuration;      ///< Empty edits in front of it, in the movie timescale
+        qint64      editEmptyUSecs;
+        qint64      endDts;                 ///< Decode time following the last sample read so far
+        quint32     defaultDuration;        ///< From trex
+        quint32     defaultFlags;           ///< From trex
+        int         stts[2];                ///< Payload range of the sample table boxes, 0 for none
+        int         ctts[2];
+        int         stss[2];
+    } Mp4Track_t;
+
+    typedef std::function<void(quint32 id, int begin, int end)> Visitor_t;
+
+    void    _clear          (void);
+    bool    _buildMp4       (QFile& file, QString& errorString);
+    bool    _buildMatroska  (QFile& file, QString& errorString);
+    void    _parseMoov      (const QByteArray& moov, Mp4Track_t& track);
+    void    _parseTrak      (const QByteArray& moov, int begin, int end, Mp4Track_t& track);
+    void    _parseMoof      (const QByteArray& moof, Mp4Track_t& track);
+    void    _addMp4Keyframe (const Mp4Track_t& track, qint64 pts);
+
+    static void _forEachBox     (const QByteArray& data, int begin, int end, const Visitor_t& visit);
+    static void _forEachElement (const QByteArray& data, int begin, int end, const Visitor_t& visit);
+    static bool _readVint       (const uchar* bytes, qint64 available, bool keepMarker, quint64& value, int& length, bool* unknown = nullptr);
+    static bool _readFileElement(QFile& file, qint64 offset, quint32& id, qint64& dataOffset, qint64& size);
+    static quint64  _readUInt   (const QByteArray& data, int begin, int end);
+    static double   _readFloat  (const QByteArray& data, int begin, int end);
+
+    QVector<qint64> _keyframes;
+    qint64          _durationUSecs  = 0;
+    qint64          _startTimeMSecs = 0;
+
+    static const int _maxIndexBytes = 64 * 1024 * 1024;     ///< Larger index boxes or elements are taken as corrupt
+};
@@ -13,6 +13,10 @@
 #include <QSettings>
 #include <QUrl>
 #include <QDir>
+#include <QBuffer>
+#include <QSaveFile>
+#include <QtConcurrent>
+#include <QtNumeric>
 
 #ifndef QGC_DISABLE_UVC
 #include <QCameraInfo>
@@ -27,10 +31,12 @@
 #include "Settings/SettingsManager.h"
 #include "Vehicle.h"
 #include "QGCCameraManager.h"
+#include "QGCPowerManager.h"
 
 #if defined(QGC_GST_STREAMING)
 #include "GStreamer.h"
 #include "VideoSettings.h"
+#include "ExifParser.h"
 #else
 #include "GLVideoItemStub.h"
 #endif
@@ -53,6 +59,7 @@ static const char* kFileExtension[VideoReceiver::FILE_FORMAT_MAX - VideoReceiver
 VideoManager::VideoManager(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
 {
+    connect(&_imageBurstTimer, &QTimer::timeout, this, &VideoManager::_imageBurstTimeout);
 #if !defined(QGC_GST_STREAMING)
     static bool once = false;
     if (!once) {
@@ -91,6 +98,7 @@ VideoManager::setToolbox(QGCToolbox *toolbox)
    QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
    qmlRegisterUncreatableType<VideoManager> ("QGroundControl.VideoManager", 1, 0, "VideoManager", "Reference only");
    qmlRegisterUncreatableType<VideoReceiver>("QGroundControl",              1, 0, "VideoReceiver","Reference only");
+   qmlRegisterUncreatableType<VideoReplay>  ("QGroundControl",              1, 0, "VideoReplay",  "Reference only");
 
    // TODO: Those connections should be Per Video, not per VideoManager.
    _videoSettings = toolbox->settingsManager()->videoSettings();
@@ -99,13 +107,28 @@ VideoManager::setToolbox(QGCToolbox *toolbox)
    connect(_videoSettings->udpPort(),       &Fact::rawValueChanged, this, &VideoManager::_udpPortChanged);
    connect(_videoSettings->rtspUrl(),       &Fact::rawValueChanged, this, &VideoManager::_rtspUrlChanged);
    connect(_videoSettings->tcpUrl(),        &Fact::rawValueChanged, this, &VideoManager::_tcpUrlChanged);
+   connect(_videoSettings->srtUrl(),        &Fact::rawValueChanged, this, &VideoManager::_srtUrlChanged);
    connect(_videoSettings->aspectRatio(),   &Fact::rawValueChanged, this, &VideoManager::_aspectRatioChanged);
    connect(_videoSettings->lowLatencyMode(),&Fact::rawValueChanged, this, &VideoManager::_lowLatencyModeChanged);
+   connect(_videoSettings->preRecordDuration(), &Fact::rawValueChanged, this, &VideoManager::_preRecordDurationChanged);
+   connect(_videoSettings->adaptiveLatency(),   &Fact::rawValueChanged, this, &VideoManager::_adaptiveLatencyChanged);
+   connect(_videoSettings->latencyPreference(), &Fact::rawValueChanged, this, &VideoManager::_latencyPreferenceChanged);
+   connect(_videoSettings->restreamEnabled(),       &Fact::rawValueChanged, this, &VideoManager::_restreamChanged);
+   connect(_videoSettings->restreamPort(),          &Fact::rawValueChanged, this, &VideoManager::_restreamChanged);
+   connect(_videoSettings->restreamMaxViewers(),    &Fact::rawValueChanged, this, &VideoManager::_restreamChanged);
+   for (Fact* fact: { _videoSettings->thermalPalette(), _videoSettings->thermalAutoRange(), _videoSettings->thermalRangeLow(),
+                      _videoSettings->thermalRangeHigh(), _videoSettings->thermalIsotherm(), _videoSettings->thermalIsothermLow(),
+                      _videoSettings->thermalIsothermHigh(), _videoSettings->thermalRawScale(), _videoSettings->thermalRawOffset() }) {
+       connect(fact, &Fact::rawValueChanged, this, &VideoManager::_thermalProcessingChanged);
+   }
    MultiVehicleManager *pVehicleMgr = qgcApp()->toolbox()->multiVehicleManager();
    connect(pVehicleMgr, &MultiVehicleManager::activeVehicleChanged, this, &VideoManager::_setActiveVehicle);
+   connect(toolbox->powerManager(), &QGCPowerManager::powerStateChanged, this, &VideoManager::_updateDecoding);
 
 #if defined(QGC_GST_STREAMING)
-    GStreamer::blacklist(static_cast<VideoSettings::VideoDecoderOptions>(_videoSettings->forceVideoDecoder()->rawValue().toInt()));
+    GStreamer::waitForInitialized();
+    GStreamer::blacklist(static_cast<VideoSettings::VideoDecoderOptions>(_videoSettings->forceVideoDecoder()->rawValue().toInt()),
+                         _videoSettings->decoderRankOverrides()->rawValue().toString());
 #ifndef QGC_DISABLE_UVC
    // If we are using a UVC camera setup the device name
    _updateUVC();
@@ -116,16 +139,62 @@ VideoManager::setToolbox(QGCToolbox *toolbox)
 #if defined(QGC_GST_STREAMING)
     _videoReceiver[0] = toolbox->corePlugin()->createVideoReceiver(this);
     _videoReceiver[1] = toolbox->corePlugin()->createVideoReceiver(this);
+    _preRecordDurationChanged();
+    _latencyPreferenceChanged();
+    _thermalProcessingChanged();
+    for (VideoReceiver* receiver: _videoReceiver) {
+        if (receiver != nullptr) {
+            receiver->setAdaptiveLatency(_videoSettings->adaptiveLatency()->rawValue().toBool());
+        }
+    }
+
+    _videoReplay.setReceiver(_videoReceiver[0]);
+    connect(&_videoReplay, &VideoReplay::activeChanged, this, [this](){
+        emit hasVideoChanged();
+        emit isGStreamerChanged();
+        _restartVideo(0);
+    });
 
     connect(_videoReceiver[0], &VideoReceiver::streamingChanged, this, [this](bool active){
         _streaming = active;
         emit streamingChanged();
+        if (!active) {
+            _latencyStats = VideoReceiver::LatencyStats();
+            emit videoLatencyChanged();
+        }
+        // The restream branch goes away with the stream
+        if (active) {
+            _restreamChanged();
+        }
+    });
+
+    connect(_videoReceiver[0], &VideoReceiver::onStartRestreamComplete, this, [this](VideoReceiver::STATUS status){
+        // The stream format is not known until the first data went through, or the last restream is still
+        // shutting down after new settings, try again shortly
+        if (status == VideoReceiver::STATUS_INVALID_STATE) {
+            QTimer::singleShot(1000, this, [this](){
+                if (!_restreaming && _restreamWanted()) {
+                    _videoReceiver[0]->startRestream(_videoSettings->restreamPort()->rawValue().toUInt(),
+                                                     _videoSettings->restreamMaxViewers()->rawValue().toUInt());
+                }
+            });
+        }
+    });
+
+    connect(_videoReceiver[0], &VideoReceiver::restreamingChanged, this, [this](bool active){
+        _restreaming = active;
+        emit restreamingChanged();
+    });
+
+    connect(_videoReceiver[0], &VideoReceiver::restreamViewersChanged, this, [this](int viewers){
+        _restreamViewers = viewers;
+        emit restreamingChanged();
     });
 
     connect(_videoReceiver[0], &VideoReceiver::onStartComplete, this, [this](VideoReceiver::STATUS status) {
         if (status == VideoReceiver::STATUS_OK) {
             _videoStarted[0] = true;
-            if (_videoSink[0] != nullptr) {
+            if (_videoSink[0] != nullptr && !_decodingPaused) {
                 // It is absolytely ok to have video receiver active (streaming) and decoding not active
                 // It should be handy for cases when you have many streams and want to show only some of them
                 // NOTE that even if decoder did not start it is still possible to record video
@@ -159,7 +228,24 @@ VideoManager::setToolbox(QGCToolbox *toolbox)
     });
 
     connect(_videoReceiver[0], &VideoReceiver::recordingStarted, this, [this](){
-        _subtitleWriter.startCapturingTelemetry(_videoFile);
+        if (!_recordingSegmented) {
+            _subtitleWriter.startCapturingTelemetry(_videoFile);
+        }
+    });
+
+    // One subtitle file per segment, starting with it
+    connect(_videoReceiver[0], &VideoReceiver::recordingSegmentStarted, this, [this](QString segmentFile){
+        _subtitleWriter.stopCapturingTelemetry();
+        _subtitleWriter.startCapturingTelemetry(segmentFile);
+    });
+
+    connect(_videoReceiver[0], &VideoReceiver::screenshotTaken, this, &VideoManager::_screenshotTaken);
+
+    connect(_videoReceiver[0], &VideoReceiver::onTakeScreenshotComplete, this, [this](VideoReceiver::STATUS status){
+        // Requests complete in order, no frame will follow for a failed one
+        if (status != VideoReceiver::STATUS_OK && !_pendingImages.isEmpty()) {
+            _pendingImages.dequeue();
+        }
     });
 
     connect(_videoReceiver[0], &VideoReceiver::videoSizeChanged, this, [this](QSize size){
@@ -167,6 +253,18 @@ VideoManager::setToolbox(QGCToolbox *toolbox)
         emit videoSizeChanged();
     });
 
+    connect(_videoReceiver[0], &VideoReceiver::latencyStatsChanged, this, [this](VideoReceiver::LatencyStats stats){
+        _latencyStats = stats;
+        emit videoLatencyChanged();
+    });
+
+    connect(_videoReceiver[0], &VideoReceiver::videoDecoderChanged, this, [this](QString decoder, bool hardware, QString memory){
+        _videoDecoder           = decoder;
+        _videoDecoderHardware   = hardware;
+        _videoMemory            = memory;
+        emit videoDecoderChanged();
+    });
+
     //connect(_videoReceiver, &VideoReceiver::onTakeScreenshotComplete, this, [this](VideoReceiver::STATUS status){
     //    if (status == VideoReceiver::STATUS_OK) {
     //    }
@@ -178,7 +276,7 @@ VideoManager::setToolbox(QGCToolbox *toolbox)
         connect(_videoReceiver[1], &VideoReceiver::onStartComplete, this, [this](VideoReceiver::STATUS status) {
             if (status == VideoReceiver::STATUS_OK) {
                 _videoStarted[1] = true;
-                if (_videoSink[1] != nullptr) {
+                if (_videoSink[1] != nullptr && !_decodingPaused) {
                     _videoReceiver[1]->startDecoding(_videoSink[1]);
                 }
             } else if (status == VideoReceiver::STATUS_INVALID_URL) {
@@ -194,6 +292,18 @@ VideoManager::setToolbox(QGCToolbox *toolbox)
             _videoStarted[1] = false;
             _startReceiver(1);
         });
+
+        connect(_videoReceiver[1], &VideoReceiver::thermalStatsChanged, this, [this](VideoReceiver::ThermalStats stats){
+            _thermalStats = stats;
+            emit thermalStatsChanged();
+        });
+
+        connect(_videoReceiver[1], &VideoReceiver::decodingChanged, this, [this](bool active){
+            if (!active) {
+                _thermalStats = VideoReceiver::ThermalStats();
+                emit thermalStatsChanged();
+            }
+        });
     }
 #endif
     _updateSettings(0);
@@ -313,10 +423,19 @@ VideoManager::startRecording(const QString& videoFile)
     QString videoFile2 = _videoFile + "2." + ext;
     _videoFile += ext;
 
+    const unsigned segmentSecs = _videoSettings->recordingSegmentDuration()->rawValue().toUInt();
+    _recordingSegmented = segmentSecs > 0;
+
+    const bool telemetryTrack = _videoSettings->recordTelemetryTrack()->rawValue().toBool();
+
     if (_videoReceiver[0] && _videoStarted[0]) {
+        _videoReceiver[0]->setRecordingSegmentDuration(segmentSecs);
+        _videoReceiver[0]->setRecordTelemetryTrack(telemetryTrack);
         _videoReceiver[0]->startRecording(_videoFile, fileFormat);
     }
     if (_videoReceiver[1] && _videoStarted[1]) {
+        _videoReceiver[1]->setRecordingSegmentDuration(segmentSecs);
+        _videoReceiver[1]->setRecordTelemetryTrack(telemetryTrack);
         _videoReceiver[1]->startRecording(videoFile2, fileFormat);
     }
 
@@ -361,6 +480,13 @@ VideoManager::grabImage(const QString& imageFile)
 
     emit imageFileChanged();
 
+    QGeoCoordinate coordinate;
+    if (_activeVehicle) {
+        coordinate = _activeVehicle->coordinate();
+        coordinate.setAltitude(_activeVehicle->altitudeAMSL()->rawValue().toDouble());
+    }
+    _pendingImages.enqueue(qMakePair(_imageFile, coordinate));
+
     _videoReceiver[0]->takeScreenshot(_imageFile);
 #else
     Q_UNUSED(imageFile)
@@ -431,6 +557,19 @@ VideoManager::hasThermal()
     return false;
 }
 
+//-----------------------------------------------------------------------------
+QVariantMap
+VideoManager::videoLatencyStages() const
+{
+    QVariantMap stages;
+    stages[QStringLiteral("source")]        = _latencyStats.sourceMsecs;
+    stages[QStringLiteral("jitterBuffer")]  = _latencyStats.jitterBufferMsecs;
+    stages[QStringLiteral("parser")]        = _latencyStats.parserMsecs;
+    stages[QStringLiteral("decoder")]       = _latencyStats.decoderMsecs;
+    stages[QStringLiteral("sink")]          = _latencyStats.sinkMsecs;
+    return stages;
+}
+
 //-----------------------------------------------------------------------------
 QString
 VideoManager::imageFile()
@@ -503,6 +642,13 @@ VideoManager::_tcpUrlChanged()
     _restartVideo(0);
 }
 
+//-----------------------------------------------------------------------------
+void
+VideoManager::_srtUrlChanged()
+{
+    _restartVideo(0);
+}
+
 //-----------------------------------------------------------------------------
 void
 VideoManager::_lowLatencyModeChanged()
@@ -510,11 +656,235 @@ VideoManager::_lowLatencyModeChanged()
     _restartAllVideos();
 }
 
+//-----------------------------------------------------------------------------
+void
+VideoManager::startImageBurst(int count, double framesPerSecond)
+{
+    if (count <= 0 || framesPerSecond <= 0) {
+        return;
+    }
+
+    _imageBurstRemaining = count;
+    _imageBurstTimer.setInterval(qMax(1, static_cast<int>(1000.0 / framesPerSecond)));
+    _imageBurstTimer.start();
+    emit imageBurstActiveChanged();
+
+    _imageBurstTimeout();
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoManager::stopImageBurst()
+{
+    if (_imageBurstTimer.isActive()) {
+        _imageBurstTimer.stop();
+        _imageBurstRemaining = 0;
+        emit imageBurstActiveChanged();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoManager::_imageBurstTimeout()
+{
+    grabImage();
+
+    if (--_imageBurstRemaining <= 0) {
+        stopImageBurst();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Encoding a full resolution frame takes long enough to make the UI hitch, so it is done on the thread pool
+void
+VideoManager::_screenshotTaken(QString imageFile, QImage image)
+{
+    QGeoCoordinate coordinate;
+    while (!_pendingImages.isEmpty()) {
+        const QPair<QString, QGeoCoordinate> pending = _pendingImages.dequeue();
+        if (pending.first == imageFile) {
+            coordinate = pending.second;
+            break;
+        }
+    }
+
+    QtConcurrent::run([imageFile, image, coordinate]() {
+        const QByteArray format = QFileInfo(imageFile).suffix().toUpper().toLatin1();
+
+        QByteArray  bytes;
+        QBuffer     buffer(&bytes);
+
+        buffer.open(QIODevice::WriteOnly);
+        if (!image.save(&buffer, format.isEmpty() ? "JPG" : format.constData())) {
+            qCWarning(VideoManagerLog) << "Unable to encode image" << imageFile;
+            return;
+        }
+        buffer.close();
+
+        if (coordinate.isValid()) {
+            ExifParser().writeGps(bytes, coordinate);
+        }
+
+        QSaveFile file(imageFile);
+        if (!file.open(QIODevice::WriteOnly) || file.write(bytes) != bytes.size() || !file.commit()) {
+            qCWarning(VideoManagerLog) << "Unable to write image" << imageFile << file.errorString();
+            return;
+        }
+        qCDebug(VideoManagerLog) << "Image saved" << imageFile;
+    });
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoManager::_preRecordDurationChanged()
+{
+    const unsigned seconds = _videoSettings->preRecordDuration()->rawValue().toUInt();
+
+    for (VideoReceiver* receiver: _videoReceiver) {
+        if (receiver != nullptr) {
+            receiver->setPreRecordDuration(seconds);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoManager::_adaptiveLatencyChanged()
+{
+    const bool enable = _videoSettings->adaptiveLatency()->rawValue().toBool();
+
+    for (VideoReceiver* receiver: _videoReceiver) {
+        if (receiver != nullptr) {
+            receiver->setAdaptiveLatency(enable);
+        }
+    }
+
+    // The jitter buffer is set up on start
+    _restartAllVideos();
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoManager::_latencyPreferenceChanged()
+{
+    const unsigned percent = _videoSettings->latencyPreference()->rawValue().toUInt();
+
+    for (VideoReceiver* receiver: _videoReceiver) {
+        if (receiver != nullptr) {
+            receiver->setLatencyPreference(percent);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoManager::_thermalProcessingChanged()
+{
+    if (_videoReceiver[1] == nullptr) {
+        return;
+    }
+
+    VideoReceiver::ThermalProcessing thermal;
+    thermal.enabled     = true;
+    thermal.palette     = static_cast<VideoReceiver::THERMAL_PALETTE>(_videoSettings->thermalPalette()->rawValue().toInt());
+    thermal.autoRange   = _videoSettings->thermalAutoRange()->rawValue().toBool();
+    thermal.rangeLow    = _thermalRaw(_videoSettings->thermalRangeLow()->rawValue().toDouble());
+    thermal.rangeHigh   = _thermalRaw(_videoSettings->thermalRangeHigh()->rawValue().toDouble());
+    if (_videoSettings->thermalIsotherm()->rawValue().toBool()) {
+        thermal.isothermLow     = _thermalRaw(_videoSettings->thermalIsothermLow()->rawValue().toDouble());
+        thermal.isothermHigh    = _thermalRaw(_videoSettings->thermalIsothermHigh()->rawValue().toDouble());
+    }
+    thermal.spot        = _thermalSpot;
+    thermal.area        = _thermalArea;
+
+    _videoReceiver[1]->setThermalProcessing(thermal);
+
+    // The temperatures of the last stats follow the scale
+    emit thermalStatsChanged();
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoManager::_restreamChanged()
+{
+    if (_videoReceiver[0] == nullptr) {
+        return;
+    }
+
+    // Restarted for new settings, no-op if not restreaming
+    _videoReceiver[0]->stopRestream();
+
+    if (_restreamWanted()) {
+        _videoReceiver[0]->startRestream(_videoSettings->restreamPort()->rawValue().toUInt(),
+                                         _videoSettings->restreamMaxViewers()->rawValue().toUInt());
+    }
+}
+
+//-----------------------------------------------------------------------------
+bool
+VideoManager::_restreamWanted() const
+{
+    // A replayed recording is not live video for remote viewers
+    return _streaming && !_videoReplay.active() && _videoSettings->restreamEnabled()->rawValue().toBool();
+}
+
+//-----------------------------------------------------------------------------
+/// Degrees Celsius of a raw radiometric value, NaN when not radiometric
+double
+VideoManager::_thermalTemp(bool valid, double raw) const
+{
+    if (!valid || !_thermalStats.radiometric || _videoSettings == nullptr) {
+        return qQNaN();
+    }
+    return raw * _videoSettings->thermalRawScale()->rawValue().toDouble() + _videoSettings->thermalRawOffset()->rawValue().toDouble() - 273.15;
+}
+
+//-----------------------------------------------------------------------------
+/// Raw radiometric value of a temperature in degrees Celsius
+quint16
+VideoManager::_thermalRaw(double celsius) const
+{
+    const double scale  = _videoSettings->thermalRawScale()->rawValue().toDouble();
+    const double offset = _videoSettings->thermalRawOffset()->rawValue().toDouble();
+    return static_cast<quint16>(qRound(qBound(0.0, (celsius + 273.15 - offset) / scale, 65535.0)));
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoManager::setThermalSpot(QPointF spot)
+{
+    if (spot != _thermalSpot) {
+        _thermalSpot = spot;
+        emit thermalMeasurementChanged();
+        _thermalProcessingChanged();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoManager::setThermalArea(QRectF area)
+{
+    area = area.normalized();
+    if (area != _thermalArea) {
+        _thermalArea = area;
+        emit thermalMeasurementChanged();
+        _thermalProcessingChanged();
+    }
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoManager::clearThermalMeasurement()
+{
+    setThermalSpot(QPointF(-1, -1));
+    setThermalArea(QRectF());
+}
+
 //-----------------------------------------------------------------------------
 bool
 VideoManager::hasVideo()
 {
-    if(autoStreamConfigured()) {
+    if(autoStreamConfigured() || _videoReplay.active()) {
         return true;
     }
     QString videoSource = _videoSettings->videoSource()->rawValue().toString();
@@ -532,9 +902,11 @@ VideoManager::isGStreamer()
             videoSource == VideoSettings::videoSourceRTSP ||
             videoSource == VideoSettings::videoSourceTCP ||
             videoSource == VideoSettings::videoSourceMPEGTS ||
+            videoSource == VideoSettings::videoSourceSRT ||
             videoSource == VideoSettings::videoSource3DRSolo ||
             videoSource == VideoSettings::videoSourceParrotDiscovery ||
-            autoStreamConfigured();
+            autoStreamConfigured() ||
+            _videoReplay.active();
 #else
     return false;
 #endif
@@ -563,6 +935,51 @@ VideoManager::setfullScreen(bool f)
     emit fullScreenChanged();
 }
 
+//-----------------------------------------------------------------------------
+void
+VideoManager::setVideoVisible(bool visible)
+{
+    if (visible == _videoVisible) {
+        return;
+    }
+    _videoVisible = visible;
+    emit videoVisibleChanged();
+    _updateDecoding();
+}
+
+//-----------------------------------------------------------------------------
+bool
+VideoManager::_decodingWanted() const
+{
+    QGCPowerManager* powerManager = qgcApp()->toolbox()->powerManager();
+    return _videoVisible && !powerManager->background();
+}
+
+//-----------------------------------------------------------------------------
+void
+VideoManager::_updateDecoding()
+{
+    const bool paused = !_decodingWanted();
+    if (paused == _decodingPaused) {
+        return;
+    }
+    _decodingPaused = paused;
+    qCDebug(VideoManagerLog) << "Decoding paused" << _decodingPaused;
+
+#if defined(QGC_GST_STREAMING)
+    for (unsigned i = 0; i < 2; i++) {
+        if (_videoReceiver[i] == nullptr || _videoSink[i] == nullptr || !_videoStarted[i]) {
+            continue;
+        }
+        if (_decodingPaused) {
+            _videoReceiver[i]->stopDecoding();
+        } else {
+            _videoReceiver[i]->startDecoding(_videoSink[i]);
+        }
+    }
+#endif
+}
+
 //-----------------------------------------------------------------------------
 void
 VideoManager::_initVideo()
@@ -580,7 +997,7 @@ VideoManager::_initVideo()
     if (widget != nullptr && _videoReceiver[0] != nullptr) {
         _videoSink[0] = qgcApp()->toolbox()->corePlugin()->createVideoSink(this, widget);
         if (_videoSink[0] != nullptr) {
-            if (_videoStarted[0]) {
+            if (_videoStarted[0] && !_decodingPaused) {
                 _videoReceiver[0]->startDecoding(_videoSink[0]);
             }
         } else {
@@ -595,7 +1012,7 @@ VideoManager::_initVideo()
     if (widget != nullptr && _videoReceiver[1] != nullptr) {
         _videoSink[1] = qgcApp()->toolbox()->corePlugin()->createVideoSink(this, widget);
         if (_videoSink[1] != nullptr) {
-            if (_videoStarted[1]) {
+            if (_videoStarted[1] && !_decodingPaused) {
                 _videoReceiver[1]->startDecoding(_videoSink[1]);
             }
         } else {
@@ -620,6 +1037,11 @@ VideoManager::_updateSettings(unsigned id)
 
     _lowLatencyStreaming[id] = lowLatencyStreaming;
 
+    //-- Recorded video replayed along with a log, in place of the primary stream
+    if (id == 0 && _videoReplay.active()) {
+        return _updateVideoUri(id, _videoReplay.uri()) || settingsChanged;
+    }
+
     //-- Auto discovery
 
     if(_activeVehicle && _activeVehicle->cameraManager()) {
@@ -688,6 +1110,8 @@ VideoManager::_updateSettings(unsigned id)
         settingsChanged |= _updateVideoUri(0, _videoSettings->rtspUrl()->rawValue().toString());
     else if (source == VideoSettings::videoSourceTCP)
         settingsChanged |= _updateVideoUri(0, QStringLiteral("tcp://%1").arg(_videoSettings->tcpUrl()->rawValue().toString()));
+    else if (source == VideoSettings::videoSourceSRT)
+        settingsChanged |= _updateVideoUri(0, _videoSettings->srtUrl()->rawValue().toString());
     else if (source == VideoSettings::videoSource3DRSolo)
         settingsChanged |= _updateVideoUri(0, QStringLiteral("udp://0.0.0.0:5600"));
     else if (source == VideoSettings::videoSourceParrotDiscovery)
@@ -775,7 +1199,9 @@ VideoManager::_startReceiver(unsigned id)
         qCDebug(VideoManagerLog) << "Unsupported receiver id" << id;
     } else if (_videoReceiver[id] != nullptr/* && _videoSink[id] != nullptr*/) {
         if (!_videoUri[id].isEmpty()) {
-            _videoReceiver[id]->start(_videoUri[id], timeout, _lowLatencyStreaming[id] ? -1 : 0);
+            // A replay is synced to the log clock, so it needs the sink clock like no low latency stream does
+            const bool lowLatency = _lowLatencyStreaming[id] && !(id == 0 && _videoReplay.active());
+            _videoReceiver[id]->start(_videoUri[id], timeout, lowLatency ? -1 : 0);
         }
     }
 #endif
@@ -800,6 +1226,10 @@ VideoManager::_setActiveVehicle(Vehicle* vehicle)
 {
     if(_activeVehicle) {
         disconnect(_activeVehicle->vehicleLinkManager(), &VehicleLinkManager::communicationLostChanged, this, &VideoManager::_communicationLostChanged);
+        disconnect(_activeVehicle, &Vehicle::coordinateChanged, this, &VideoManager::_vehicleTelemetryChanged);
+        for (Fact* fact: { _activeVehicle->roll(), _activeVehicle->pitch(), _activeVehicle->heading(), _activeVehicle->altitudeAMSL() }) {
+            disconnect(fact, &Fact::rawValueChanged, this, &VideoManager::_vehicleTelemetryChanged);
+        }
         if(_activeVehicle->cameraManager()) {
             QGCCameraControl* pCamera = _activeVehicle->cameraManager()->currentCameraInstance();
             if(pCamera) {
@@ -809,8 +1239,14 @@ VideoManager::_setActiveVehicle(Vehicle* vehicle)
         }
     }
     _activeVehicle = vehicle;
+    _vehicleTelemetryChanged();
     if(_activeVehicle) {
         connect(_activeVehicle->vehicleLinkManager(), &VehicleLinkManager::communicationLostChanged, this, &VideoManager::_communicationLostChanged);
+        // Telemetry track of recordings, sampled by the receivers at the video frame rate
+        connect(_activeVehicle, &Vehicle::coordinateChanged, this, &VideoManager::_vehicleTelemetryChanged);
+        for (Fact* fact: { _activeVehicle->roll(), _activeVehicle->pitch(), _activeVehicle->heading(), _activeVehicle->altitudeAMSL() }) {
+            connect(fact, &Fact::rawValueChanged, this, &VideoManager::_vehicleTelemetryChanged);
+        }
         if(_activeVehicle->cameraManager()) {
             connect(_activeVehicle->cameraManager(), &QGCCameraManager::streamChanged, this, &VideoManager::_restartAllVideos);
             QGCCameraControl* pCamera = _activeVehicle->cameraManager()->currentCameraInstance();
@@ -826,6 +1262,32 @@ VideoManager::_setActiveVehicle(Vehicle* vehicle)
     _restartAllVideos();
 }
 
+//----------------------------------------------------------------------------------------
+void
+VideoManager::_vehicleTelemetryChanged()
+{
+    VideoReceiver::Telemetry telemetry;
+
+    if (_activeVehicle) {
+        const QGeoCoordinate coordinate = _activeVehicle->coordinate();
+
+        telemetry.valid         = coordinate.isValid();
+        telemetry.timeMsecs     = QDateTime::currentMSecsSinceEpoch();
+        telemetry.latitude      = coordinate.latitude();
+        telemetry.longitude     = coordinate.longitude();
+        telemetry.altitudeAMSL  = _activeVehicle->altitudeAMSL()->rawValue().toDouble();
+        telemetry.roll          = _activeVehicle->roll()->rawValue().toDouble();
+        telemetry.pitch         = _activeVehicle->pitch()->rawValue().toDouble();
+        telemetry.heading       = _activeVehicle->heading()->rawValue().toDouble();
+    }
+
+    for (VideoReceiver* receiver: _videoReceiver) {
+        if (receiver != nullptr) {
+            receiver->setTelemetry(telemetry);
+        }
+    }
+}
+
 //----------------------------------------------------------------------------------------
 void
 VideoManager::_communicationLostChanged(bool connectionLost)
@@ -15,12 +15,18 @@
 #include <QTimer>
 #include <QTime>
 #include <QUrl>
+#include <QVariantMap>
+#include <QGeoCoordinate>
+#include <QImage>
+#include <QQueue>
 
 #include "QGCMAVLink.h"
 #include "QGCLoggingCategory.h"
 #include "VideoReceiver.h"
 #include "QGCToolbox.h"
 #include "SubtitleWriter.h"
+#include "VideoStreamPool.h"
+#include "VideoReplay.h"
 
 Q_DECLARE_LOGGING_CATEGORY(VideoManagerLog)
 
@@ -42,8 +48,11 @@ public:
     Q_PROPERTY(QString          videoSourceID           READ    videoSourceID                               NOTIFY videoSourceIDChanged)
     Q_PROPERTY(bool             uvcEnabled              READ    uvcEnabled                                  CONSTANT)
     Q_PROPERTY(bool             fullScreen              READ    fullScreen      WRITE   setfullScreen       NOTIFY fullScreenChanged)
+    Q_PROPERTY(bool             videoVisible            READ    videoVisible    WRITE   setVideoVisible     NOTIFY videoVisibleChanged)    ///< Set by the ui, the video isn't decoded while it isn't shown
     Q_PROPERTY(VideoReceiver*   videoReceiver           READ    videoReceiver                               CONSTANT)
     Q_PROPERTY(VideoReceiver*   thermalVideoReceiver    READ    thermalVideoReceiver                        CONSTANT)
+    Q_PROPERTY(VideoStreamPool* streamPool              READ    streamPool                                  CONSTANT)    ///< Additional streams, e.g. one per vehicle
+    Q_PROPERTY(VideoReplay*     videoReplay             READ    videoReplay                                 CONSTANT)    ///< Recorded video played along with a log replay
     Q_PROPERTY(double           aspectRatio             READ    aspectRatio                                 NOTIFY aspectRatioChanged)
     Q_PROPERTY(double           thermalAspectRatio      READ    thermalAspectRatio                          NOTIFY aspectRatioChanged)
     Q_PROPERTY(double           hfov                    READ    hfov                                        NOTIFY aspectRatioChanged)
@@ -51,10 +60,36 @@ public:
     Q_PROPERTY(bool             autoStreamConfigured    READ    autoStreamConfigured                        NOTIFY autoStreamConfiguredChanged)
     Q_PROPERTY(bool             hasThermal              READ    hasThermal                                  NOTIFY decodingChanged)
     Q_PROPERTY(QString          imageFile               READ    imageFile                                   NOTIFY imageFileChanged)
+    Q_PROPERTY(bool             imageBurstActive        READ    imageBurstActive                            NOTIFY imageBurstActiveChanged)
     Q_PROPERTY(bool             streaming               READ    streaming                                   NOTIFY streamingChanged)
     Q_PROPERTY(bool             decoding                READ    decoding                                    NOTIFY decodingChanged)
     Q_PROPERTY(bool             recording               READ    recording                                   NOTIFY recordingChanged)
+    Q_PROPERTY(bool             restreaming             READ    restreaming                                 NOTIFY restreamingChanged)     ///< Primary stream served to remote viewers
+    Q_PROPERTY(int              restreamViewers         READ    restreamViewers                             NOTIFY restreamingChanged)
     Q_PROPERTY(QSize            videoSize               READ    videoSize                                   NOTIFY videoSizeChanged)
+    // Latency of the primary stream, see VideoReceiver::LatencyStats
+    Q_PROPERTY(double           videoLatencyMsecs       READ    videoLatencyMsecs                           NOTIFY videoLatencyChanged)
+    Q_PROPERTY(double           videoFrameAgeMsecs      READ    videoFrameAgeMsecs                          NOTIFY videoLatencyChanged)
+    Q_PROPERTY(double           videoJitterMsecs        READ    videoJitterMsecs                            NOTIFY videoLatencyChanged)
+    Q_PROPERTY(double           videoRoundTripMsecs     READ    videoRoundTripMsecs                         NOTIFY videoLatencyChanged)
+    Q_PROPERTY(double           videoFramesPerSecond    READ    videoFramesPerSecond                        NOTIFY videoLatencyChanged)
+    Q_PROPERTY(int              videoPacketsLost        READ    videoPacketsLost                            NOTIFY videoLatencyChanged)
+    Q_PROPERTY(int              videoPacketsLate        READ    videoPacketsLate                            NOTIFY videoLatencyChanged)
+    Q_PROPERTY(int              videoFramesDropped      READ    videoFramesDropped                          NOTIFY videoLatencyChanged)
+    Q_PROPERTY(QVariantMap      videoLatencyStages      READ    videoLatencyStages                          NOTIFY videoLatencyChanged)
+    Q_PROPERTY(QString          videoDecoder            READ    videoDecoder                                NOTIFY videoDecoderChanged)
+    Q_PROPERTY(bool             videoDecoderHardware    READ    videoDecoderHardware                        NOTIFY videoDecoderChanged)
+    Q_PROPERTY(QString          videoMemory             READ    videoMemory                                 NOTIFY videoDecoderChanged)    ///< Memory frames reach the video sink in
+    // Measurements on the thermal stream in degrees Celsius, NaN while not available, see VideoReceiver::ThermalStats
+    Q_PROPERTY(bool             thermalRadiometric      READ    thermalRadiometric                          NOTIFY thermalStatsChanged)
+    Q_PROPERTY(double           thermalFrameMinTemp     READ    thermalFrameMinTemp                         NOTIFY thermalStatsChanged)
+    Q_PROPERTY(double           thermalFrameMaxTemp     READ    thermalFrameMaxTemp                         NOTIFY thermalStatsChanged)
+    Q_PROPERTY(double           thermalSpotTemp         READ    thermalSpotTemp                             NOTIFY thermalStatsChanged)
+    Q_PROPERTY(double           thermalAreaMinTemp      READ    thermalAreaMinTemp                          NOTIFY thermalStatsChanged)
+    Q_PROPERTY(double           thermalAreaMaxTemp      READ    thermalAreaMaxTemp                          NOTIFY thermalStatsChanged)
+    Q_PROPERTY(double           thermalAreaMeanTemp     READ    thermalAreaMeanTemp                         NOTIFY thermalStatsChanged)
+    Q_PROPERTY(QPointF          thermalSpot             READ    thermalSpot     WRITE   setThermalSpot      NOTIFY thermalMeasurementChanged)   ///< Normalized, (-1,-1) for none
+    Q_PROPERTY(QRectF           thermalArea             READ    thermalArea     WRITE   setThermalArea      NOTIFY thermalMeasurementChanged)   ///< Normalized, empty for none
 
     virtual bool        hasVideo            ();
     virtual bool        isGStreamer         ();
@@ -81,16 +116,47 @@ public:
         return _recording;
     }
 
+    bool    restreaming     (void) const { return _restreaming; }
+    int     restreamViewers (void) const { return _restreamViewers; }
+
     QSize videoSize(void) {
         const quint32 size = _videoSize;
         return QSize((size >> 16) & 0xFFFF, size & 0xFFFF);
     }
 
+    double      videoLatencyMsecs   (void) const { return _latencyStats.totalMsecs; }
+    double      videoFrameAgeMsecs  (void) const { return _latencyStats.frameAgeMsecs; }
+    double      videoJitterMsecs    (void) const { return _latencyStats.jitterMsecs; }
+    double      videoRoundTripMsecs (void) const { return _latencyStats.roundTripMsecs; }
+    double      videoFramesPerSecond(void) const { return _latencyStats.framesPerSecond; }
+    int         videoPacketsLost    (void) const { return static_cast<int>(_latencyStats.packetsLost); }
+    int         videoPacketsLate    (void) const { return static_cast<int>(_latencyStats.packetsLate); }
+    int         videoFramesDropped  (void) const { return static_cast<int>(_latencyStats.framesDropped); }
+    QVariantMap videoLatencyStages  (void) const;
+    QString     videoDecoder        (void) const { return _videoDecoder; }
+    bool        videoDecoderHardware(void) const { return _videoDecoderHardware; }
+    QString     videoMemory         (void) const { return _videoMemory; }
+    bool        thermalRadiometric  (void) const { return _thermalStats.radiometric; }
+    double      thermalFrameMinTemp (void) const { return _thermalTemp(true, _thermalStats.frameMin); }
+    double      thermalFrameMaxTemp (void) const { return _thermalTemp(true, _thermalStats.frameMax); }
+    double      thermalSpotTemp     (void) const { return _thermalTemp(_thermalStats.hasSpot, _thermalStats.spot); }
+    double      thermalAreaMinTemp  (void) const { return _thermalTemp(_thermalStats.hasArea, _thermalStats.areaMin); }
+    double      thermalAreaMaxTemp  (void) const { return _thermalTemp(_thermalStats.hasArea, _thermalStats.areaMax); }
+    double      thermalAreaMeanTemp (void) const { return _thermalTemp(_thermalStats.hasArea, _thermalStats.areaMean); }
+    QPointF     thermalSpot         (void) const { return _thermalSpot; }
+    QRectF      thermalArea         (void) const { return _thermalArea; }
+
+    void        setThermalSpot      (QPointF spot);
+    void        setThermalArea      (QRectF area);
+
 // FIXME: AV: they should be removed after finishing multiple video stream support
 // new arcitecture does not assume direct access to video receiver from QML side, even if it works for now
     virtual VideoReceiver*  videoReceiver           () { return _videoReceiver[0]; }
     virtual VideoReceiver*  thermalVideoReceiver    () { return _videoReceiver[1]; }
 
+    VideoStreamPool*        streamPool              () { return &_streamPool; }
+    VideoReplay*            videoReplay             () { return &_videoReplay; }
+
 #if defined(QGC_DISABLE_UVC)
     virtual bool        uvcEnabled          () { return false; }
 #else
@@ -98,6 +164,11 @@ public:
 #endif
 
     virtual void        setfullScreen       (bool f);
+
+    bool                videoVisible        () const { return _videoVisible; }
+    /// Decoding stops while the video isn't visible or the ui is in the background, see QGCPowerManager. The streams
+    /// keep running, recording and restreaming go on.
+    void                setVideoVisible     (bool visible);
     virtual void        setIsTaisync        (bool t) { _isTaisync = t;  emit isTaisyncChanged(); }
 
     // Override from QGCTool
@@ -111,32 +182,58 @@ public:
 
     Q_INVOKABLE void grabImage(const QString& imageFile = QString());
 
+    /// Grabs count images at framesPerSecond, named like grabImage with an empty file name
+    Q_INVOKABLE void startImageBurst(int count, double framesPerSecond);
+    Q_INVOKABLE void stopImageBurst ();
+
+    bool imageBurstActive(void) const { return _imageBurstTimer.isActive(); }
+
+    /// Removes the thermal spot and area
+    Q_INVOKABLE void clearThermalMeasurement();
+
 signals:
     void hasVideoChanged            ();
     void isGStreamerChanged         ();
     void videoSourceIDChanged       ();
     void fullScreenChanged          ();
+    void videoVisibleChanged        ();
     void isAutoStreamChanged        ();
     void isTaisyncChanged           ();
     void aspectRatioChanged         ();
     void autoStreamConfiguredChanged();
     void imageFileChanged           ();
+    void imageBurstActiveChanged    ();
     void streamingChanged           ();
     void decodingChanged            ();
     void recordingChanged           ();
     void recordingStarted           ();
+    void restreamingChanged         ();
     void videoSizeChanged           ();
+    void videoLatencyChanged        ();
+    void videoDecoderChanged        ();
+    void thermalStatsChanged        ();
+    void thermalMeasurementChanged  ();
 
 protected slots:
     void _videoSourceChanged        ();
     void _udpPortChanged            ();
     void _rtspUrlChanged            ();
     void _tcpUrlChanged             ();
+    void _srtUrlChanged             ();
     void _lowLatencyModeChanged     ();
+    void _preRecordDurationChanged  ();
+    void _adaptiveLatencyChanged    ();
+    void _latencyPreferenceChanged  ();
+    void _thermalProcessingChanged  ();
+    void _restreamChanged           ();
+    void _vehicleTelemetryChanged   ();
     void _updateUVC                 ();
     void _setActiveVehicle          (Vehicle* vehicle);
     void _aspectRatioChanged        ();
     void _communicationLostChanged  (bool communicationLost);
+    void _screenshotTaken           (QString imageFile, QImage image);
+    void _imageBurstTimeout         ();
+    void _updateDecoding            ();
 
 protected:
     friend class FinishVideoInitialization;
@@ -149,11 +246,17 @@ protected:
     void _restartVideo              (unsigned id);
     void _startReceiver             (unsigned id);
     void _stopReceiver              (unsigned id);
+    bool _restreamWanted            () const;
+    bool _decodingWanted            () const;
+    double _thermalTemp             (bool valid, double raw) const;
+    quint16 _thermalRaw             (double celsius) const;
 
 protected:
     QString                 _videoFile;
     QString                 _imageFile;
     SubtitleWriter          _subtitleWriter;
+    VideoStreamPool         _streamPool;
+    VideoReplay             _videoReplay;
     bool                    _isTaisync              = false;
     VideoReceiver*          _videoReceiver[2]       = { nullptr, nullptr };
     void*                   _videoSink[2]           = { nullptr, nullptr };
@@ -168,11 +271,26 @@ protected:
     QAtomicInteger<bool>    _streaming              = false;
     QAtomicInteger<bool>    _decoding               = false;
     QAtomicInteger<bool>    _recording              = false;
+    bool                    _recordingSegmented     = false;
+    bool                    _restreaming            = false;
+    int                     _restreamViewers        = 0;
     QAtomicInteger<quint32> _videoSize              = 0;
+    VideoReceiver::LatencyStats _latencyStats;
+    QString                 _videoDecoder;
+    bool                    _videoDecoderHardware   = false;
+    QString                 _videoMemory;
+    VideoReceiver::ThermalStats _thermalStats;
+    QPointF                 _thermalSpot            = QPointF(-1, -1);
+    QRectF                  _thermalArea;
     VideoSettings*          _videoSettings          = nullptr;
     QString                 _videoSourceID;
     bool                    _fullScreen             = false;
+    bool                    _videoVisible           = true;
+    bool                    _decodingPaused         = false;    ///< Decoding was stopped since nobody sees the video
     Vehicle*                _activeVehicle          = nullptr;
+    QQueue<QPair<QString, QGeoCoordinate>> _pendingImages;          ///< Vehicle position when each pending image was requested, in request order
+    QTimer                  _imageBurstTimer;
+    int                     _imageBurstRemaining    = 0;
 };
 
 #endif
@@ -0,0 +1,195 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VideoReplay.h"
+#include "LogReplayLink.h"
+#include "VideoReceiver.h"
+
+#include <QUrl>
+
+VideoReplay::VideoReplay(QObject* parent)
+    : QObject(parent)
+{
+    _scrubTimer.setSingleShot(true);
+    _scrubTimer.setInterval(scrubSettleMSecs);
+    connect(&_scrubTimer, &QTimer::timeout, this, &VideoReplay::_scrubSettled);
+}
+
+LogReplayLink* VideoReplay::link(void)
+{
+    return _link.data();
+}
+
+bool VideoReplay::open(const QString& videoFile)
+{
+    close();
+
+    QString errorString;
+    if (!_index.build(videoFile, errorString)) {
+        _setErrorString(errorString);
+        return false;
+    }
+    _setErrorString(QString());
+
+    _videoFile = videoFile;
+    _updateFileOffset();
+    emit videoFileChanged();
+    emit activeChanged();
+    return true;
+}
+
+void VideoReplay::close(void)
+{
+    _scrubTimer.stop();
+    _scrubKeyframe  = -1;
+    _offsetFromFile = true;
+
+    if (active()) {
+        _index = VideoKeyframeIndex();
+        _videoFile.clear();
+        emit videoFileChanged();
+        emit activeChanged();
+    }
+}
+
+void VideoReplay::setLink(LogReplayLink* link)
+{
+    if (link == _link) {
+        return;
+    }
+
+    if (_link) {
+        disconnect(_link, nullptr, this, nullptr);
+    }
+
+    _link = link;
+
+    if (_link) {
+        connect(_link, &LogReplayLink::clockChanged,    this, &VideoReplay::_clockChanged);
+        connect(_link, &LogReplayLink::logFileStats,    this, &VideoReplay::_logFileStats);
+        // The video goes with the log
+        connect(_link, &LogReplayLink::disconnected,    this, [this]() { setLink(nullptr); });
+        _clockRunning = _link->clock().isRunning();
+        _updateFileOffset();
+    } else {
+        close();
+    }
+
+    emit linkChanged();
+}
+
+void VideoReplay::setOffsetSecs(double offsetSecs)
+{
+    _offsetFromFile = false;
+    if (!qFuzzyCompare(offsetSecs, _offsetSecs)) {
+        _offsetSecs = offsetSecs;
+        emit offsetSecsChanged();
+        _sync(false);
+    }
+}
+
+void VideoReplay::setReceiver(VideoReceiver* receiver)
+{
+    if (_receiver) {
+        disconnect(_receiver, nullptr, this, nullptr);
+    }
+    _receiver = receiver;
+    if (_receiver) {
+        connect(_receiver, &VideoReceiver::decodingChanged, this, &VideoReplay::_receiverDecoding);
+    }
+}
+
+QString VideoReplay::uri(void) const
+{
+    return active() ? QUrl::fromLocalFile(_videoFile).toString() : QString();
+}
+
+qint64 VideoReplay::videoPositionUSecs(quint64 logTimeUSecs) const
+{
+    const quint64 logStartTimeUSecs = _link ? _link->logStartTimeUSecs() : 0;
+    return static_cast<qint64>(logTimeUSecs - logStartTimeUSecs) - static_cast<qint64>(_offsetSecs * 1000000);
+}
+
+void VideoReplay::_setErrorString(const QString& errorString)
+{
+    if (errorString != _errorString) {
+        _errorString = errorString;
+        emit errorStringChanged();
+    }
+}
+
+/// Lines the video up with the log from the time each of them was recorded, if both files say
+void VideoReplay::_updateFileOffset(void)
+{
+    if (!_offsetFromFile || !_link || !_link->logStartTimeUSecs() || !_index.startTimeMSecs()) {
+        return;
+    }
+
+    const double offsetSecs = ((_index.startTimeMSecs() * 1000) - static_cast<qint64>(_link->logStartTimeUSecs())) / 1000000.0;
+    if (!qFuzzyCompare(offsetSecs, _offsetSecs)) {
+        _offsetSecs = offsetSecs;
+        emit offsetSecsChanged();
+    }
+}
+
+void VideoReplay::_clockChanged(void)
+{
+    const bool wasRunning = _clockRunning;
+    _clockRunning = _link && _link->clock().isRunning();
+
+    // Playhead moves while paused are scrubbing, pausing shows the exact frame right away
+    _sync(!_clockRunning && !wasRunning);
+}
+
+void VideoReplay::_logFileStats(void)
+{
+    _updateFileOffset();
+    _sync(false);
+}
+
+void VideoReplay::_receiverDecoding(bool active)
+{
+    // The receiver starts playing from the beginning of the file
+    if (active) {
+        _scrubKeyframe = -1;
+        _sync(false);
+    }
+}
+
+void VideoReplay::_scrubSettled(void)
+{
+    _scrubKeyframe = -1;
+    _sync(false);
+}
+
+void VideoReplay::_sync(bool scrub)
+{
+    if (!_receiver || !_link || !active()) {
+        return;
+    }
+
+    const ReplayClock::State_t  state       = _link->clock().state();
+    const qint64                position    = qBound<qint64>(0, videoPositionUSecs(state.logTimeUSecs), _index.durationUSecs());
+
+    if (state.running) {
+        _scrubTimer.stop();
+        _scrubKeyframe = -1;
+        _receiver->seek(position, state.rate, false /* keyframe */);
+    } else if (scrub) {
+        const int keyframe = _index.keyframeForTime(position);
+        if (keyframe != _scrubKeyframe) {
+            _scrubKeyframe = keyframe;
+            _receiver->seek(_index.keyframes()[keyframe], 0, true /* keyframe */);
+        }
+        _scrubTimer.start();
+    } else {
+        _scrubTimer.stop();
+        _receiver->seek(position, 0, false /* keyframe */);
+    }
+}
@@ -0,0 +1,98 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "VideoKeyframeIndex.h"
+
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+class LogReplayLink;
+class VideoReceiver;
+
+/// Plays a recorded video in the primary video view along with a telemetry log replay.
+///
+/// The video follows the ReplayClock of the LogReplayLink. Each time the clock changes (play, pause, speed, playhead
+/// move) the receiver is seeked to the matching video position and set to the clock rate, in between both run off
+/// the system clock. Playhead moves while paused are scrubbing: the video goes to the key frame before the position,
+/// found in the VideoKeyframeIndex, and is only seeked again once the playhead reaches another key frame. The exact
+/// frame follows once the playhead rests for scrubSettleMSecs.
+class VideoReplay : public QObject
+{
+    Q_OBJECT
+
+public:
+    VideoReplay(QObject* parent = nullptr);
+
+    Q_PROPERTY(LogReplayLink*   link            READ link           WRITE setLink           NOTIFY linkChanged)
+    Q_PROPERTY(QString          videoFile       READ videoFile                              NOTIFY videoFileChanged)
+    Q_PROPERTY(bool             active          READ active                                 NOTIFY activeChanged)
+    Q_PROPERTY(double           offsetSecs      READ offsetSecs     WRITE setOffsetSecs     NOTIFY offsetSecsChanged)  ///< Video start relative to the log start
+    Q_PROPERTY(double           durationSecs    READ durationSecs                           NOTIFY activeChanged)
+    Q_PROPERTY(QString          errorString     READ errorString                            NOTIFY errorStringChanged)
+
+    /// Indexes the video, VideoManager then switches the primary video over to it
+    /// @return false: The video can't be replayed, see errorString
+    Q_INVOKABLE bool open(const QString& videoFile);
+    Q_INVOKABLE void close(void);
+
+    LogReplayLink*  link            (void);
+    QString         videoFile       (void) const { return _videoFile; }
+    bool            active          (void) const { return _index.isValid(); }
+    double          offsetSecs      (void) const { return _offsetSecs; }
+    double          durationSecs    (void) const { return _index.durationUSecs() / 1000000.0; }
+    QString         errorString     (void) const { return _errorString; }
+
+    const VideoKeyframeIndex& index(void) const { return _index; }
+
+    void setLink        (LogReplayLink* link);
+    void setOffsetSecs  (double offsetSecs);
+
+    /// Receiver which shows the video, set by VideoManager
+    void setReceiver(VideoReceiver* receiver);
+
+    /// @return Uri of the video for the receiver, empty while not active
+    QString uri(void) const;
+
+    /// @return Position in the video for a log time, not limited to the video
+    qint64 videoPositionUSecs(quint64 logTimeUSecs) const;
+
+    static const int scrubSettleMSecs = 300;
+
+signals:
+    void linkChanged        (void);
+    void videoFileChanged   (void);
+    void activeChanged      (void);
+    void offsetSecsChanged  (void);
+    void errorStringChanged (void);
+
+private slots:
+    void _clockChanged      (void);
+    void _logFileStats      (void);
+    void _receiverDecoding  (bool active);
+    void _scrubSettled      (void);
+
+private:
+    void _setErrorString    (const QString& errorString);
+    void _updateFileOffset  (void);
+    void _sync              (bool scrub);
+
+    QPointer<LogReplayLink> _link;
+    QPointer<VideoReceiver> _receiver;
+    QString                 _videoFile;
+    QString                 _errorString;
+    VideoKeyframeIndex      _index;
+    double                  _offsetSecs         = 0;
+    bool                    _offsetFromFile     = true;     ///< offsetSecs follows the recording times until it is set
+    bool                    _clockRunning       = false;    ///< As of the last clock change
+    int                     _scrubKeyframe      = -1;       ///< Key frame shown while scrubbing, -1 for none
+    QTimer                  _scrubTimer;
+};
@@ -0,0 +1,376 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VideoStreamPool.h"
+#include "QGCApplication.h"
+#include "QGCCorePlugin.h"
+#include "SettingsManager.h"
+#include "VideoSettings.h"
+#if defined(QGC_GST_STREAMING)
+#include "GStreamer.h"
+#endif
+
+#include <QTimer>
+#include <algorithm>
+
+QGC_LOGGING_CATEGORY(VideoStreamPoolLog, "VideoStreamPoolLog")
+
+VideoStreamPool::VideoStreamPool(QObject* parent)
+    : QObject(parent)
+{
+
+}
+
+VideoStreamPool::~VideoStreamPool()
+{
+    for (int streamId: _streams.keys()) {
+        removeStream(streamId);
+    }
+}
+
+int VideoStreamPool::addStream(const QString& uri, const QString& lowResUri, int priority)
+{
+    Stream_t* stream = new Stream_t;
+
+    stream->id          = _nextStreamId++;
+    stream->uri         = uri;
+    stream->lowResUri   = lowResUri;
+    stream->priority    = priority;
+    stream->visible     = false;
+    stream->receiver    = nullptr;
+    stream->sink        = nullptr;
+    stream->started     = false;
+    stream->stopping    = false;
+    stream->decoding    = false;
+    stream->decodeMode  = DecodeNone;
+
+    if (!qgcApp()->runningUnitTests()) {
+        stream->receiver = qgcApp()->toolbox()->corePlugin()->createVideoReceiver(this);
+        if (stream->receiver) {
+            _connectReceiver(stream);
+        } else {
+            qCWarning(VideoStreamPoolLog) << "No video receiver available for" << uri;
+        }
+    }
+
+    _streams[stream->id] = stream;
+    qCDebug(VideoStreamPoolLog) << "Added stream" << stream->id << uri << lowResUri;
+
+    _updateDecodeModes();
+    _startStream(stream);
+
+    emit countChanged();
+
+    return stream->id;
+}
+
+void VideoStreamPool::removeStream(int streamId)
+{
+    Stream_t* stream = _streams.take(streamId);
+
+    if (!stream) {
+        qCWarning(VideoStreamPoolLog) << "removeStream: unknown stream" << streamId;
+        return;
+    }
+
+    if (stream->receiver) {
+        // Deleting the receiver waits for the queued stop to complete
+        disconnect(stream->receiver, nullptr, this, nullptr);
+        stream->receiver->stop();
+        delete stream->receiver;
+    }
+    _releaseSink(stream);
+    delete stream;
+
+    if (_focusedStreamId == streamId) {
+        _focusedStreamId = -1;
+        emit focusedStreamChanged();
+    }
+
+    qCDebug(VideoStreamPoolLog) << "Removed stream" << streamId;
+
+    _updateDecodeModes();
+
+    emit countChanged();
+}
+
+void VideoStreamPool::setStreamWidget(int streamId, QQuickItem* widget)
+{
+    Stream_t* stream = _streams.value(streamId, nullptr);
+
+    if (!stream) {
+        qCWarning(VideoStreamPoolLog) << "setStreamWidget: unknown stream" << streamId;
+        return;
+    }
+    if (stream->widget == widget) {
+        return;
+    }
+
+    // A new widget needs a new sink. Decoding stops asynchronously, so restart the whole receiver to get a clean
+    // decoding branch for the new sink.
+    if (stream->decoding && stream->receiver && !stream->stopping) {
+        stream->stopping = true;
+        stream->receiver->stop();
+    }
+    _releaseSink(stream);
+
+    stream->widget = widget;
+    if (widget && stream->receiver) {
+        if ((stream->sink = qgcApp()->toolbox()->corePlugin()->createVideoSink(this, widget)) == nullptr) {
+            qCWarning(VideoStreamPoolLog) << "createVideoSink() failed for stream" << streamId;
+        }
+    }
+
+    _applyDecodeMode(stream);
+}
+
+void VideoStreamPool::setStreamVisible(int streamId, bool visible)
+{
+    Stream_t* stream = _streams.value(streamId, nullptr);
+
+    if (stream && stream->visible != visible) {
+        stream->visible = visible;
+        _updateDecodeModes();
+    }
+}
+
+void VideoStreamPool::setStreamPriority(int streamId, int priority)
+{
+    Stream_t* stream = _streams.value(streamId, nullptr);
+
+    if (stream && stream->priority != priority) {
+        stream->priority = priority;
+        _updateDecodeModes();
+    }
+}
+
+int VideoStreamPool::decodeMode(int streamId) const
+{
+    Stream_t* stream = _streams.value(streamId, nullptr);
+
+    return stream ? stream->decodeMode : DecodeNone;
+}
+
+void VideoStreamPool::setFocusedStream(int streamId)
+{
+    if (streamId != -1 && !_streams.contains(streamId)) {
+        qCWarning(VideoStreamPoolLog) << "setFocusedStream: unknown stream" << streamId;
+        return;
+    }
+    if (streamId != _focusedStreamId) {
+        _focusedStreamId = streamId;
+        emit focusedStreamChanged();
+        _updateDecodeModes();
+    }
+}
+
+void VideoStreamPool::setMaxDecodedStreams(int maxDecodedStreams)
+{
+    maxDecodedStreams = qMax(1, maxDecodedStreams);
+    if (maxDecodedStreams != _maxDecodedStreams) {
+        _maxDecodedStreams = maxDecodedStreams;
+        emit maxDecodedStreamsChanged();
+        _updateDecodeModes();
+    }
+}
+
+QMap<int, VideoStreamPool::DecodeMode_t> VideoStreamPool::decodeModes(const QList<StreamState_t>& streams, int maxDecodedStreams)
+{
+    QMap<int, DecodeMode_t>  modes;
+    QList<StreamState_t>     visibleStreams;
+
+    for (const StreamState_t& stream: streams) {
+        modes[stream.streamId] = DecodeNone;
+        if (stream.visible) {
+            visibleStreams.append(stream);
+        }
+    }
+
+    // Focused first, then by priority, then in the order they were added
+    std::stable_sort(visibleStreams.begin(), visibleStreams.end(), [](const StreamState_t& a, const StreamState_t& b) {
+        if (a.focused != b.focused) {
+            return a.focused;
+        }
+        return a.priority > b.priority;
+    });
+
+    const bool anyFocused = !visibleStreams.isEmpty() && visibleStreams.first().focused;
+
+    for (int i=0; i<qMin(maxDecodedStreams, visibleStreams.count()); i++) {
+        const StreamState_t& stream = visibleStreams[i];
+
+        if (stream.focused || (i == 0 && !anyFocused)) {
+            modes[stream.streamId] = DecodeFull;
+        } else {
+            modes[stream.streamId] = stream.hasLowResolution ? DecodeLowResolution : DecodeKeyframes;
+        }
+    }
+
+    return modes;
+}
+
+void VideoStreamPool::_updateDecodeModes(void)
+{
+    QList<StreamState_t> states;
+
+    for (const Stream_t* stream: _streams) {
+        StreamState_t state;
+
+        state.streamId          = stream->id;
+        state.priority          = stream->priority;
+        state.visible           = stream->visible;
+        state.focused           = stream->id == _focusedStreamId;
+        state.hasLowResolution  = !stream->lowResUri.isEmpty();
+        states.append(state);
+    }
+
+    const QMap<int, DecodeMode_t> modes = decodeModes(states, _maxDecodedStreams);
+
+    for (Stream_t* stream: _streams) {
+        const DecodeMode_t mode = modes[stream->id];
+
+        if (mode != stream->decodeMode) {
+            qCDebug(VideoStreamPoolLog) << "Stream" << stream->id << "decode mode" << stream->decodeMode << "->" << mode;
+            stream->decodeMode = mode;
+            _applyDecodeMode(stream);
+            emit decodeModeChanged(stream->id, mode);
+        }
+    }
+}
+
+QString VideoStreamPool::_wantedUri(const Stream_t* stream) const
+{
+    switch (stream->decodeMode) {
+    case DecodeLowResolution:
+        return stream->lowResUri;
+    case DecodeNone:
+        // Not worth a restart
+        return stream->activeUri.isEmpty() ? stream->uri : stream->activeUri;
+    default:
+        return stream->uri;
+    }
+}
+
+void VideoStreamPool::_applyDecodeMode(Stream_t* stream)
+{
+    if (!stream->receiver) {
+        return;
+    }
+
+    if (stream->started && _wantedUri(stream) != stream->activeUri) {
+        // Restarted from onStopComplete
+        if (!stream->stopping) {
+            stream->stopping = true;
+            stream->receiver->stop();
+        }
+        return;
+    }
+    if (!stream->started) {
+        // Applied from onStartComplete
+        return;
+    }
+
+    const bool decode = stream->decodeMode != DecodeNone && stream->sink != nullptr;
+
+    stream->receiver->setKeyframeOnly(stream->decodeMode == DecodeKeyframes);
+    if (decode && !stream->decoding) {
+        stream->receiver->startDecoding(stream->sink);
+        stream->decoding = true;
+    } else if (!decode && stream->decoding) {
+        stream->receiver->stopDecoding();
+        stream->decoding = false;
+    }
+}
+
+void VideoStreamPool::_startStream(Stream_t* stream)
+{
+    if (!stream->receiver) {
+        return;
+    }
+
+    VideoSettings*  videoSettings   = qgcApp()->toolbox()->settingsManager()->videoSettings();
+    const unsigned  timeout         = videoSettings->rtspTimeout()->rawValue().toUInt();
+    const bool      lowLatency      = videoSettings->lowLatencyMode()->rawValue().toBool();
+
+    stream->activeUri = _wantedUri(stream);
+    if (stream->activeUri.isEmpty()) {
+        return;
+    }
+
+    stream->receiver->setAdaptiveLatency(videoSettings->adaptiveLatency()->rawValue().toBool());
+    stream->receiver->setLatencyPreference(videoSettings->latencyPreference()->rawValue().toUInt());
+
+    qCDebug(VideoStreamPoolLog) << "Starting stream" << stream->id << stream->activeUri;
+    stream->receiver->start(stream->activeUri, timeout, lowLatency ? -1 : 0);
+}
+
+void VideoStreamPool::_connectReceiver(Stream_t* stream)
+{
+    const int streamId = stream->id;
+
+    // Queued signals may still arrive after the stream is gone, so always look the stream up again
+    connect(stream->receiver, &VideoReceiver::onStartComplete, this, [this, streamId](VideoReceiver::STATUS status) {
+        Stream_t* stream = _streams.value(streamId, nullptr);
+        if (!stream) {
+            return;
+        }
+        if (status == VideoReceiver::STATUS_OK) {
+            stream->started = true;
+            stream->decoding = false;
+            _applyDecodeMode(stream);
+        } else if (status == VideoReceiver::STATUS_INVALID_URL || status == VideoReceiver::STATUS_INVALID_STATE) {
+            // Bad url won't get better, already running is fine
+        } else {
+            QTimer::singleShot(_restartDelayMsecs, this, [this, streamId]() {
+                Stream_t* stream = _streams.value(streamId, nullptr);
+                if (stream && !stream->started) {
+                    _startStream(stream);
+                }
+            });
+        }
+    });
+
+    connect(stream->receiver, &VideoReceiver::onStartDecodingComplete, this, [this, streamId](VideoReceiver::STATUS status) {
+        if (status != VideoReceiver::STATUS_INVALID_STATE) {
+            return;
+        }
+        // Previous decoding branch was still shutting down, try again
+        QTimer::singleShot(_restartDelayMsecs, this, [this, streamId]() {
+            Stream_t* stream = _streams.value(streamId, nullptr);
+            if (stream && stream->started) {
+                stream->decoding = false;
+                _applyDecodeMode(stream);
+            }
+        });
+    });
+
+    connect(stream->receiver, &VideoReceiver::onStopComplete, this, [this, streamId](VideoReceiver::STATUS) {
+        Stream_t* stream = _streams.value(streamId, nullptr);
+        if (!stream) {
+            return;
+        }
+        // Uri switch or timeout, either way keep the stream going
+        stream->started = false;
+        stream->stopping = false;
+        stream->decoding = false;
+        _startStream(stream);
+    });
+}
+
+void VideoStreamPool::_releaseSink(Stream_t* stream)
+{
+    if (!stream->sink) {
+        return;
+    }
+#if defined(QGC_GST_STREAMING)
+    // Same as VideoManager, the pool can outlive corePlugin() on app exit
+    GStreamer::releaseVideoSink(stream->sink);
+#endif
+    stream->sink = nullptr;
+}
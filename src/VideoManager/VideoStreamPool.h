@@ -0,0 +1,120 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QMap>
+#include <QPointer>
+#include <QQuickItem>
+
+#include "QGCLoggingCategory.h"
+#include "VideoReceiver.h"
+
+Q_DECLARE_LOGGING_CATEGORY(VideoStreamPoolLog)
+
+/// Additional video streams decoded at the same time as the primary/thermal streams of VideoManager, for example
+/// a grid of tiles with a feed from each vehicle.
+///
+/// Each tile registers its stream and its GstGLVideoItem. Decode cost follows what is on screen:
+///     - Not visible:          Streaming only, nothing is decoded
+///     - Visible, not focused: Low resolution stream if one was given, key frames only otherwise
+///     - Focused:              Full stream, all frames. Without a focused stream this goes to the visible stream with
+///                             the highest priority.
+/// If more streams are visible than maxDecodedStreams, the ones with the lowest priority are not decoded.
+class VideoStreamPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    VideoStreamPool(QObject* parent = nullptr);
+    ~VideoStreamPool();
+
+    typedef enum {
+        DecodeNone = 0,
+        DecodeKeyframes,
+        DecodeLowResolution,
+        DecodeFull,
+    } DecodeMode_t;
+    Q_ENUM(DecodeMode_t)
+
+    /// Input to decodeModes
+    typedef struct {
+        int     streamId;
+        int     priority;
+        bool    visible;
+        bool    focused;
+        bool    hasLowResolution;
+    } StreamState_t;
+
+    Q_PROPERTY(int count                READ count                                          NOTIFY countChanged)
+    Q_PROPERTY(int focusedStream        READ focusedStream      WRITE setFocusedStream      NOTIFY focusedStreamChanged)
+    Q_PROPERTY(int maxDecodedStreams    READ maxDecodedStreams  WRITE setMaxDecodedStreams  NOTIFY maxDecodedStreamsChanged)
+
+    /// Adds a stream to the pool, streaming starts right away
+    ///     @param uri          Same uri formats as VideoReceiver::start
+    ///     @param lowResUri    Lower resolution variant of the same feed for when it is not in focus, empty for none
+    ///     @param priority     Higher priority streams are decoded first when over maxDecodedStreams
+    /// @return Stream id
+    Q_INVOKABLE int     addStream           (const QString& uri, const QString& lowResUri = QString(), int priority = 0);
+    Q_INVOKABLE void    removeStream        (int streamId);
+    Q_INVOKABLE void    setStreamWidget     (int streamId, QQuickItem* widget);
+    Q_INVOKABLE void    setStreamVisible    (int streamId, bool visible);
+    Q_INVOKABLE void    setStreamPriority   (int streamId, int priority);
+    Q_INVOKABLE int     decodeMode          (int streamId) const;
+
+    int     count               (void) const { return _streams.count(); }
+    int     focusedStream       (void) const { return _focusedStreamId; }
+    int     maxDecodedStreams   (void) const { return _maxDecodedStreams; }
+    void    setFocusedStream    (int streamId);
+    void    setMaxDecodedStreams(int maxDecodedStreams);
+
+    /// Decode policy
+    ///     @param maxDecodedStreams Maximum number of streams to decode at all
+    /// @return Key: Stream id, Value: How to decode the stream
+    static QMap<int, DecodeMode_t> decodeModes(const QList<StreamState_t>& streams, int maxDecodedStreams);
+
+signals:
+    void countChanged               (void);
+    void focusedStreamChanged       (void);
+    void maxDecodedStreamsChanged   (void);
+    void decodeModeChanged          (int streamId, int decodeMode);
+
+private:
+    typedef struct {
+        int                     id;
+        QString                 uri;
+        QString                 lowResUri;
+        int                     priority;
+        bool                    visible;
+        QPointer<QQuickItem>    widget;
+        VideoReceiver*          receiver;
+        void*                   sink;
+        bool                    started;        ///< Receiver started ok
+        bool                    stopping;       ///< Stopped to switch uri or sink
+        bool                    decoding;       ///< startDecoding requested
+        QString                 activeUri;      ///< Uri the receiver is streaming from
+        DecodeMode_t            decodeMode;
+    } Stream_t;
+
+    void    _updateDecodeModes  (void);
+    void    _applyDecodeMode    (Stream_t* stream);
+    void    _startStream        (Stream_t* stream);
+    void    _connectReceiver    (Stream_t* stream);
+    void    _releaseSink        (Stream_t* stream);
+    QString _wantedUri          (const Stream_t* stream) const;
+
+    QMap<int, Stream_t*>    _streams;
+    int                     _nextStreamId       = 1;
+    int                     _focusedStreamId    = -1;
+    int                     _maxDecodedStreams  = _defaultMaxDecodedStreams;
+
+    static const int _defaultMaxDecodedStreams  = 6;
+    static const int _restartDelayMsecs         = 1000;
+};
@@ -15,12 +15,19 @@
  */
 
 #include <QDebug>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QtConcurrent>
 
 #include "GStreamer.h"
 #include "GstVideoReceiver.h"
 
 QGC_LOGGING_CATEGORY(GStreamerLog, "GStreamerLog")
 
+static QFuture<void>        _initializeFuture;
+static QList<QByteArray>    _initializeArgs;    ///< Copy of the arguments, the application may change its own argv meanwhile
+static QVector<char*>       _initializeArgv;
+
 static void qt_gst_log(GstDebugCategory * category,
                        GstDebugLevel      level,
                        const gchar      * file,
@@ -74,6 +81,7 @@ G_BEGIN_DECLS
 // The static plugins we use
 #if defined(__android__) || defined(__ios__)
     GST_PLUGIN_STATIC_DECLARE(coreelements);
+    GST_PLUGIN_STATIC_DECLARE(app);
     GST_PLUGIN_STATIC_DECLARE(playback);
     GST_PLUGIN_STATIC_DECLARE(libav);
     GST_PLUGIN_STATIC_DECLARE(rtp);
@@ -84,6 +92,7 @@ G_BEGIN_DECLS
     GST_PLUGIN_STATIC_DECLARE(rtpmanager);
     GST_PLUGIN_STATIC_DECLARE(isomp4);
     GST_PLUGIN_STATIC_DECLARE(matroska);
+    GST_PLUGIN_STATIC_DECLARE(multifile);
     GST_PLUGIN_STATIC_DECLARE(mpegtsdemux);
     GST_PLUGIN_STATIC_DECLARE(opengl);
     GST_PLUGIN_STATIC_DECLARE(tcp);
@@ -105,8 +114,54 @@ static void qgcputenv(const QString& key, const QString& root, const QString& pa
 }
 #endif
 
+// Hardware decoders which do not advertise themselves as such in their klass
+static const char* const kVaapiDecoders[]        = { "vaapih265dec", "vaapih264dec", "vaapivp9dec", "vaapivp8dec", "vaapimpeg2dec", "vaapimpeg4dec", "vaapih263dec", "vaapivc1dec", "vah265dec", "vah264dec", "vavp9dec", "vavp8dec" };
+static const char* const kNvidiaDecoders[]       = { "nvh265dec", "nvh265sldec", "nvh264dec", "nvh264sldec", "nvv4l2decoder" };
+static const char* const kDirectX3DDecoders[]    = { "d3d11vp9dec", "d3d11h265dec", "d3d11h264dec" };
+static const char* const kVideoToolboxDecoders[] = { "vtdec_hw", "vtdec" };
+
+bool
+GStreamer::isHardwareDecoder(GstElementFactory* factory)
+{
+    const gchar* klass = gst_element_factory_get_metadata(factory, GST_ELEMENT_METADATA_KLASS);
+
+    if (klass == nullptr || strstr(klass, "Decoder") == nullptr || strstr(klass, "Video") == nullptr) {
+        return false;
+    }
+
+    if (strstr(klass, "Hardware") != nullptr) {
+        return true;
+    }
+
+    const QString name = QString::fromUtf8(gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(factory)));
+
+    // Android MediaCodec decoders are registered per codec on the device
+    if (name.startsWith(QStringLiteral("amcviddec-"))) {
+        return true;
+    }
+
+    static const QSet<QString> knownHardwareDecoders = []() {
+        QSet<QString> names;
+        for (const char* hwName: kVaapiDecoders) {
+            names.insert(hwName);
+        }
+        for (const char* hwName: kNvidiaDecoders) {
+            names.insert(hwName);
+        }
+        for (const char* hwName: kDirectX3DDecoders) {
+            names.insert(hwName);
+        }
+        for (const char* hwName: kVideoToolboxDecoders) {
+            names.insert(hwName);
+        }
+        return names;
+    }();
+
+    return knownHardwareDecoders.contains(name);
+}
+
 void
-GStreamer::blacklist(VideoSettings::VideoDecoderOptions option)
+GStreamer::blacklist(VideoSettings::VideoDecoderOptions option, const QString& rankOverrides)
 {
     GstRegistry* registry = gst_registry_get();
 
@@ -135,35 +190,84 @@ GStreamer::blacklist(VideoSettings::VideoDecoderOptions option)
         case VideoSettings::ForceVideoDecoderDefault:
             break;
         case VideoSettings::ForceVideoDecoderSoftware:
-            changeRank("avdec_h264", GST_RANK_PRIMARY + 1);
+            for(auto name : {"avdec_h264", "avdec_h265"}) {
+                changeRank(name, GST_RANK_PRIMARY + 1);
+            }
             break;
         case VideoSettings::ForceVideoDecoderVAAPI:
-            for(auto name : {"vaapimpeg2dec", "vaapimpeg4dec", "vaapih263dec", "vaapih264dec", "vaapivc1dec"}) {
+            for(auto name : kVaapiDecoders) {
                 changeRank(name, GST_RANK_PRIMARY + 1);
             }
             break;
         case VideoSettings::ForceVideoDecoderNVIDIA:
-            for(auto name : {"nvh265dec", "nvh265sldec", "nvh264dec", "nvh264sldec"}) {
+            for(auto name : kNvidiaDecoders) {
                 changeRank(name, GST_RANK_PRIMARY + 1);
             }
             break;
         case VideoSettings::ForceVideoDecoderDirectX3D:
-            for(auto name : {"d3d11vp9dec", "d3d11h265dec", "d3d11h264dec"}) {
+            for(auto name : kDirectX3DDecoders) {
                 changeRank(name, GST_RANK_PRIMARY + 1);
             }
             break;
         case VideoSettings::ForceVideoDecoderVideoToolbox:
-            changeRank("vtdec", GST_RANK_PRIMARY + 1);
+            for(auto name : kVideoToolboxDecoders) {
+                changeRank(name, GST_RANK_PRIMARY + 1);
+            }
+            break;
+        case VideoSettings::ForceVideoDecoderHardware:
+            do {
+                // Whatever hardware decoders this platform has, ahead of any software decoder
+                GList* factories = gst_element_factory_list_get_elements(GST_ELEMENT_FACTORY_TYPE_DECODER | GST_ELEMENT_FACTORY_TYPE_MEDIA_VIDEO, GST_RANK_NONE);
+
+                for (GList* item = factories; item != nullptr; item = item->next) {
+                    GstElementFactory* factory = GST_ELEMENT_FACTORY(item->data);
+
+                    if (isHardwareDecoder(factory)) {
+                        changeRank(gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(factory)), GST_RANK_PRIMARY + 1);
+                    }
+                }
+
+                gst_plugin_feature_list_free(factories);
+                factories = nullptr;
+            } while(0);
             break;
         default:
             qCWarning(GStreamerLog) << "Can't handle decode option:" << option;
     }
+
+    for (const QString& rankOverride: rankOverrides.split(QLatin1Char(','), QString::SkipEmptyParts)) {
+        const QStringList   pair = rankOverride.trimmed().split(QLatin1Char(':'));
+        const QString       rankStr = pair.count() == 2 ? pair[1].trimmed().toLower() : QString();
+        bool                ok = true;
+        int                 rank;
+
+        if (rankStr == QStringLiteral("none")) {
+            rank = GST_RANK_NONE;
+        } else if (rankStr == QStringLiteral("marginal")) {
+            rank = GST_RANK_MARGINAL;
+        } else if (rankStr == QStringLiteral("secondary")) {
+            rank = GST_RANK_SECONDARY;
+        } else if (rankStr == QStringLiteral("primary")) {
+            rank = GST_RANK_PRIMARY;
+        } else {
+            rank = rankStr.toInt(&ok);
+        }
+
+        if (!ok || rank < 0 || rank > UINT16_MAX || pair[0].trimmed().isEmpty()) {
+            qCWarning(GStreamerLog) << "Invalid decoder rank override:" << rankOverride;
+            continue;
+        }
+
+        changeRank(pair[0].trimmed().toUtf8().constData(), static_cast<uint16_t>(rank));
+    }
 }
 
 void
 GStreamer::initialize(int argc, char* argv[], int debuglevel)
 {
     qRegisterMetaType<VideoReceiver::STATUS>("STATUS");
+    qRegisterMetaType<VideoReceiver::LatencyStats>("LatencyStats");
+    qRegisterMetaType<VideoReceiver::ThermalStats>("ThermalStats");
 
 #ifdef Q_OS_MAC
     #ifdef QGC_INSTALL_RELEASE
@@ -203,6 +307,7 @@ GStreamer::initialize(int argc, char* argv[], int debuglevel)
     // The static plugins we use
 #if defined(__android__) || defined(__ios__)
     GST_PLUGIN_STATIC_REGISTER(coreelements);
+    GST_PLUGIN_STATIC_REGISTER(app);
     GST_PLUGIN_STATIC_REGISTER(playback);
     GST_PLUGIN_STATIC_REGISTER(libav);
     GST_PLUGIN_STATIC_REGISTER(rtp);
@@ -213,6 +318,7 @@ GStreamer::initialize(int argc, char* argv[], int debuglevel)
     GST_PLUGIN_STATIC_REGISTER(rtpmanager);
     GST_PLUGIN_STATIC_REGISTER(isomp4);
     GST_PLUGIN_STATIC_REGISTER(matroska);
+    GST_PLUGIN_STATIC_REGISTER(multifile);
     GST_PLUGIN_STATIC_REGISTER(mpegtsdemux);
     GST_PLUGIN_STATIC_REGISTER(opengl);
     GST_PLUGIN_STATIC_REGISTER(tcp);
@@ -249,6 +355,36 @@ GStreamer::initialize(int argc, char* argv[], int debuglevel)
     GST_PLUGIN_STATIC_REGISTER(qgc);
 }
 
+void
+GStreamer::initializeAsync(int argc, char* argv[], int debuglevel)
+{
+    for (int i = 0; i < argc; i++) {
+        _initializeArgs.append(QByteArray(argv[i]));
+    }
+    for (QByteArray& arg: _initializeArgs) {
+        _initializeArgv.append(arg.data());
+    }
+    _initializeArgv.append(nullptr);
+
+    _initializeFuture = QtConcurrent::run([debuglevel]() {
+        QElapsedTimer timer;
+        timer.start();
+        initialize(_initializeArgs.count(), _initializeArgv.data(), debuglevel);
+        qCDebug(GStreamerLog) << "Initialized in" << timer.elapsed() << "msecs";
+    });
+}
+
+void
+GStreamer::waitForInitialized(void)
+{
+    if (!_initializeFuture.isFinished()) {
+        QElapsedTimer timer;
+        timer.start();
+        _initializeFuture.waitForFinished();
+        qCDebug(GStreamerLog) << "Waited" << timer.elapsed() << "msecs for initialization";
+    }
+}
+
 void*
 GStreamer::createVideoSink(QObject* parent, QQuickItem* widget)
 {
@@ -6,10 +6,24 @@
 #include "VideoReceiver.h"
 #include "VideoSettings.h"
 
+#include <gst/gst.h>
+
 class GStreamer {
 public:
-    static void blacklist(VideoSettings::VideoDecoderOptions option);
+    /// Sets the decoder ranks used by decodebin3 autoplugging
+    ///     @param rankOverrides Comma separated element:rank list applied after the option, see VideoSettings::decoderRankOverrides
+    static void blacklist(VideoSettings::VideoDecoderOptions option, const QString& rankOverrides = QString());
+
+    /// @return true: Factory is a hardware accelerated video decoder
+    static bool isHardwareDecoder(GstElementFactory* factory);
     static void initialize(int argc, char* argv[], int debuglevel);
+
+    /// Runs initialize on a worker thread, so the plugin registry scan doesn't hold up the rest of the startup.
+    /// Anything which uses GStreamer must call waitForInitialized first.
+    static void initializeAsync(int argc, char* argv[], int debuglevel);
+
+    /// Blocks until initializeAsync is done, returns right away if it wasn't called
+    static void waitForInitialized(void);
     static void* createVideoSink(QObject* parent, QQuickItem* widget);
     static void releaseVideoSink(void* sink);
     static VideoReceiver* createVideoReceiver(QObject* parent);
@@ -15,14 +15,23 @@
  */
 
 #include "GstVideoReceiver.h"
+#include "GStreamer.h"
+#include "VideoStreamFeed.h"
 
 #include <QDebug>
 #include <QUrl>
+#include <QUrlQuery>
 #include <QDateTime>
 #include <QSysInfo>
+#include <QFileInfo>
+
+#include <memory>
 
 QGC_LOGGING_CATEGORY(VideoReceiverLog, "VideoReceiverLog")
 
+QMutex                  GstVideoReceiver::_workerPoolSync;
+QHash<Worker*, int>     GstVideoReceiver::_workerPool;
+
 //-----------------------------------------------------------------------------
 // Our pipeline look like this:
 //
@@ -30,7 +39,12 @@ QGC_LOGGING_CATEGORY(VideoReceiverLog, "VideoReceiverLog")
 //              |
 // _source-->_tee
 //              |
-//              +-->queue-->_recorderValve[-->_fileSink]
+//              +-->_recorderQueue-->_recorderValve[-->_fileSink]
+//
+// While not recording the src pad of _recorderQueue can be blocked so that the queue keeps the last seconds of the
+// (parsed, still compressed) stream, see setPreRecordDuration. Recording then starts with what is in the queue.
+//
+// A file:// source replays a recording, the pipeline is then moved around with seeks pushed up from _tee, see seek.
 //
 
 GstVideoReceiver::GstVideoReceiver(QObject* parent)
@@ -42,28 +56,64 @@ GstVideoReceiver::GstVideoReceiver(QObject* parent)
     , _removingRecorder(false)
     , _source(nullptr)
     , _tee(nullptr)
+    , _decoderQueue(nullptr)
     , _decoderValve(nullptr)
+    , _recorderQueue(nullptr)
     , _recorderValve(nullptr)
     , _decoder(nullptr)
     , _videoSink(nullptr)
     , _fileSink(nullptr)
+    , _restreamQueue(nullptr)
+    , _restreamValve(nullptr)
+    , _restreamSink(nullptr)
+    , _restreamMaxViewers(0)
+    , _restreamViewers(0)
     , _pipeline(nullptr)
     , _lastSourceFrameTime(0)
     , _lastVideoFrameTime(0)
     , _resetVideoSink(true)
     , _videoSinkProbeId(0)
     , _udpReconnect_us(5000000)
+    , _slotHandler(_acquireWorker())
     , _signalDepth(0)
     , _endOfStream(false)
+    , _replay(false)
+    , _stopping(0)
+    , _sourceRestarts(0)
+    , _sourceRecovering(0)
+    , _keyframeOnly(0)
+    , _waitKeyframe(0)
+    , _preRecordSecs(0)
+    , _preRecordProbeId(0)
+    , _recordingSegmentSecs(0)
+    , _recordTelemetryTrack(false)
+    , _telemetrySrc(nullptr)
+    , _decoderHardware(false)
+    , _jitterBuffer(nullptr)
+    , _srtSource(nullptr)
+    , _ntpTimestampCaps(gst_caps_new_empty_simple("timestamp/x-ntp"))
+    , _pipelineLatency(0)
+    , _adaptiveLatency(false)
+    , _latencyPreference(50)
+    , _rtpManager(nullptr)
+    , _latencyMsecs(0)
+    , _adaptLastLost(0)
+    , _adaptLastLate(0)
 {
-    _slotHandler.start();
+    _resetLatencyStats();
     connect(&_watchdogTimer, &QTimer::timeout, this, &GstVideoReceiver::_watchdog);
     _watchdogTimer.start(1000);
 }
 
 GstVideoReceiver::~GstVideoReceiver(void)
 {
-    _slotHandler.shutdown();
+    _releaseWorker(_slotHandler);
+    _slotHandler = nullptr;
+
+    if (_ntpTimestampCaps != nullptr) {
+        gst_caps_unref(_ntpTimestampCaps);
+        _ntpTimestampCaps = nullptr;
+    }
 }
 
 void
@@ -71,7 +121,7 @@ GstVideoReceiver::start(const QString& uri, unsigned timeout, int buffer)
 {
     if (_needDispatch()) {
         QString cachedUri = uri;
-        _slotHandler.dispatch([this, cachedUri, timeout, buffer]() {
+        _slotHandler->dispatch([this, cachedUri, timeout, buffer]() {
             start(cachedUri, timeout, buffer);
         });
         return;
@@ -96,17 +146,20 @@ GstVideoReceiver::start(const QString& uri, unsigned timeout, int buffer)
     _uri = uri;
     _timeout = timeout;
     _buffer = buffer;
+    _replay = uri.startsWith(QStringLiteral("file://"), Qt::CaseInsensitive);
 
     qCDebug(VideoReceiverLog) << "Starting" << _uri << ", buffer" << _buffer;
 
     _endOfStream = false;
+    _stopping = 0;
+    _sourceRestarts = 0;
+    _sourceRecovering = 0;
+
+    _resetLatencyStats();
 
     bool running    = false;
     bool pipelineUp = false;
 
-    GstElement* decoderQueue = nullptr;
-    GstElement* recorderQueue = nullptr;
-
     do {
         if((_tee = gst_element_factory_make("tee", nullptr)) == nullptr)  {
             qCCritical(VideoReceiverLog) << "gst_element_factory_make('tee') failed";
@@ -126,7 +179,7 @@ GstVideoReceiver::start(const QString& uri, unsigned timeout, int buffer)
         gst_object_unref(pad);
         pad = nullptr;
 
-        if((decoderQueue = gst_element_factory_make("queue", nullptr)) == nullptr)  {
+        if((_decoderQueue = gst_element_factory_make("queue", nullptr)) == nullptr)  {
             qCCritical(VideoReceiverLog) << "gst_element_factory_make('queue') failed";
             break;
         }
@@ -138,7 +191,13 @@ GstVideoReceiver::start(const QString& uri, unsigned timeout, int buffer)
 
         g_object_set(_decoderValve, "drop", TRUE, nullptr);
 
-        if((recorderQueue = gst_element_factory_make("queue", nullptr)) == nullptr)  {
+        if ((pad = gst_element_get_static_pad(_decoderValve, "src")) != nullptr) {
+            gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, _keyframeOnlyProbe, this, nullptr);
+            gst_object_unref(pad);
+            pad = nullptr;
+        }
+
+        if((_recorderQueue = gst_element_factory_make("queue", nullptr)) == nullptr)  {
             qCCritical(VideoReceiverLog) << "gst_element_factory_make('queue') failed";
             break;
         }
@@ -150,6 +209,22 @@ GstVideoReceiver::start(const QString& uri, unsigned timeout, int buffer)
 
         g_object_set(_recorderValve, "drop", TRUE, nullptr);
 
+        if((_restreamQueue = gst_element_factory_make("queue", nullptr)) == nullptr)  {
+            qCCritical(VideoReceiverLog) << "gst_element_factory_make('queue') failed";
+            break;
+        }
+
+        // Viewers must never hold back the local video, drop the oldest data instead
+        g_object_set(_restreamQueue, "leaky", 2 /* downstream */, "max-size-buffers", 0, "max-size-bytes", 0,
+                     "max-size-time", static_cast<guint64>(GST_SECOND), nullptr);
+
+        if((_restreamValve = gst_element_factory_make("valve", nullptr)) == nullptr)  {
+            qCCritical(VideoReceiverLog) << "gst_element_factory_make('valve') failed";
+            break;
+        }
+
+        g_object_set(_restreamValve, "drop", TRUE, nullptr);
+
         if ((_pipeline = gst_pipeline_new("receiver")) == nullptr) {
             qCCritical(VideoReceiverLog) << "gst_pipeline_new() failed";
             break;
@@ -162,45 +237,30 @@ GstVideoReceiver::start(const QString& uri, unsigned timeout, int buffer)
             break;
         }
 
-        gst_bin_add_many(GST_BIN(_pipeline), _source, _tee, decoderQueue, _decoderValve, recorderQueue, _recorderValve, nullptr);
+        gst_bin_add_many(GST_BIN(_pipeline), _source, _tee, _decoderQueue, _decoderValve, _recorderQueue, _recorderValve, _restreamQueue, _restreamValve, nullptr);
 
         pipelineUp = true;
 
-        GstPad* srcPad = nullptr;
-
-        GstIterator* it;
-
-        if ((it = gst_element_iterate_src_pads(_source)) != nullptr) {
-            GValue vpad = G_VALUE_INIT;
-
-            if (gst_iterator_next(it, &vpad) == GST_ITERATOR_OK) {
-                srcPad = GST_PAD(g_value_get_object(&vpad));
-                gst_object_ref(srcPad);
-                g_value_reset(&vpad);
-            }
-
-            gst_iterator_free(it);
-            it = nullptr;
-        }
-
-        if (srcPad != nullptr) {
-            _onNewSourcePad(srcPad);
-            gst_object_unref(srcPad);
-            srcPad = nullptr;
-        } else {
-            g_signal_connect(_source, "pad-added", G_CALLBACK(_onNewPad), this);
-        }
+        _linkSource();
 
-        if(!gst_element_link_many(_tee, decoderQueue, _decoderValve, nullptr)) {
+        if(!gst_element_link_many(_tee, _decoderQueue, _decoderValve, nullptr)) {
             qCCritical(VideoReceiverLog) << "Unable to link decoder queue";
             break;
         }
 
-        if(!gst_element_link_many(_tee, recorderQueue, _recorderValve, nullptr)) {
+        if(!gst_element_link_many(_tee, _recorderQueue, _recorderValve, nullptr)) {
             qCCritical(VideoReceiverLog) << "Unable to link recorder queue";
             break;
         }
 
+        if(!gst_element_link_many(_tee, _restreamQueue, _restreamValve, nullptr)) {
+            qCCritical(VideoReceiverLog) << "Unable to link restream queue";
+            break;
+        }
+
+        _preRecordProbeId = 0;
+        _configurePreRecord();
+
         GstBus* bus = nullptr;
 
         if ((bus = gst_pipeline_get_bus(GST_PIPELINE(_pipeline))) != nullptr) {
@@ -226,14 +286,24 @@ GstVideoReceiver::start(const QString& uri, unsigned timeout, int buffer)
 
         // If we failed before adding items to the pipeline, then clean up
         if (!pipelineUp) {
+            if (_restreamValve != nullptr) {
+                gst_object_unref(_restreamValve);
+                _restreamValve = nullptr;
+            }
+
+            if (_restreamQueue != nullptr) {
+                gst_object_unref(_restreamQueue);
+                _restreamQueue = nullptr;
+            }
+
             if (_recorderValve != nullptr) {
                 gst_object_unref(_recorderValve);
                 _recorderValve = nullptr;
             }
 
-            if (recorderQueue != nullptr) {
-                gst_object_unref(recorderQueue);
-                recorderQueue = nullptr;
+            if (_recorderQueue != nullptr) {
+                gst_object_unref(_recorderQueue);
+                _recorderQueue = nullptr;
             }
 
             if (_decoderValve != nullptr) {
@@ -241,9 +311,9 @@ GstVideoReceiver::start(const QString& uri, unsigned timeout, int buffer)
                 _decoderValve = nullptr;
             }
 
-            if (decoderQueue != nullptr) {
-                gst_object_unref(decoderQueue);
-                decoderQueue = nullptr;
+            if (_decoderQueue != nullptr) {
+                gst_object_unref(_decoderQueue);
+                _decoderQueue = nullptr;
             }
 
             if (_tee != nullptr) {
@@ -257,6 +327,12 @@ GstVideoReceiver::start(const QString& uri, unsigned timeout, int buffer)
             }
         }
 
+        _recorderQueue = nullptr;
+        _decoderQueue = nullptr;
+        _restreamQueue = nullptr;
+        _restreamValve = nullptr;
+        _preRecordProbeId = 0;
+
         _dispatchSignal([this](){
             emit onStartComplete(STATUS_FAIL);
         });
@@ -274,7 +350,7 @@ void
 GstVideoReceiver::stop(void)
 {
     if (_needDispatch()) {
-        _slotHandler.dispatch([this]() {
+        _slotHandler->dispatch([this]() {
             stop();
         });
         return;
@@ -290,6 +366,9 @@ GstVideoReceiver::stop(void)
     if (_pipeline != nullptr) {
         GstBus* bus;
 
+        _stopping = 1;
+        _sourceRecovering = 0;
+
         if ((bus = gst_pipeline_get_bus(GST_PIPELINE(_pipeline))) != nullptr) {
             gst_bus_disable_sync_message_emission(bus);
 
@@ -326,6 +405,11 @@ GstVideoReceiver::stop(void)
 
         gst_element_set_state(_pipeline, GST_STATE_NULL);
 
+        // Pipeline is going away, nothing to hold back anymore
+        _recorderQueue = nullptr;
+        _decoderQueue = nullptr;
+        _preRecordProbeId = 0;
+
         // FIXME: check if branch is connected and remove all elements from branch
         if (_fileSink != nullptr) {
            _shutdownRecordingBranch();
@@ -335,15 +419,32 @@ GstVideoReceiver::stop(void)
             _shutdownDecodingBranch();
         }
 
+        if (_restreamSink != nullptr) {
+            _shutdownRestreamBranch();
+        }
+
         GST_DEBUG_BIN_TO_DOT_FILE(GST_BIN(_pipeline), GST_DEBUG_GRAPH_SHOW_ALL, "pipeline-stopped");
 
         gst_object_unref(_pipeline);
         _pipeline = nullptr;
 
+        if (_uri.contains("tsusb://", Qt::CaseInsensitive)) {
+            VideoStreamFeed::feed(VideoStreamFeed::taisyncFeed)->setConsumer(nullptr);
+        }
+
         _recorderValve = nullptr;
         _decoderValve = nullptr;
+        _restreamQueue = nullptr;
+        _restreamValve = nullptr;
         _tee = nullptr;
         _source = nullptr;
+        _jitterBuffer = nullptr;
+        _srtSource = nullptr;
+        _latencyMsecs = 0;
+
+        _latencySync.lock();
+        _rtpManager = nullptr;
+        _latencySync.unlock();
 
         _lastSourceFrameTime = 0;
 
@@ -376,7 +477,7 @@ GstVideoReceiver::startDecoding(void* sink)
     if (_needDispatch()) {
         GstElement* videoSink = GST_ELEMENT(sink);
         gst_object_ref(videoSink);
-        _slotHandler.dispatch([this, videoSink]() mutable {
+        _slotHandler->dispatch([this, videoSink]() mutable {
             startDecoding(videoSink);
             gst_object_unref(videoSink);
         });
@@ -422,6 +523,9 @@ GstVideoReceiver::startDecoding(void* sink)
     _videoSink = videoSink;
     gst_object_ref(_videoSink);
 
+    // Before the sink goes into the pipeline, the filter can only be added to it in the NULL state
+    _configureThermalFilter();
+
     _removingDecoder = false;
 
     if (!_streaming) {
@@ -452,7 +556,7 @@ void
 GstVideoReceiver::stopDecoding(void)
 {
     if (_needDispatch()) {
-        _slotHandler.dispatch([this]() {
+        _slotHandler->dispatch([this]() {
             stopDecoding();
         });
         return;
@@ -487,7 +591,7 @@ GstVideoReceiver::startRecording(const QString& videoFile, FILE_FORMAT format)
 {
     if (_needDispatch()) {
         QString cachedVideoFile = videoFile;
-        _slotHandler.dispatch([this, cachedVideoFile, format]() {
+        _slotHandler->dispatch([this, cachedVideoFile, format]() {
             startRecording(cachedVideoFile, format);
         });
         return;
@@ -513,7 +617,15 @@ GstVideoReceiver::startRecording(const QString& videoFile, FILE_FORMAT format)
 
     qCDebug(VideoReceiverLog) << "New video file:" << videoFile <<  "" << _uri;
 
-    if ((_fileSink = _makeFileSink(videoFile, format)) == nullptr) {
+    _recordingSegmentFile.clear();
+
+    if (_recordingSegmentSecs > 0) {
+        _fileSink = _makeSegmentedFileSink(videoFile, format);
+    } else {
+        _fileSink = _makeFileSink(videoFile, format);
+    }
+
+    if (_fileSink == nullptr) {
         qCCritical(VideoReceiverLog) << "_makeFileSink() failed" << _uri;
         _dispatchSignal([this](){
             emit onStartRecordingComplete(STATUS_FAIL);
@@ -559,6 +671,10 @@ GstVideoReceiver::startRecording(const QString& videoFile, FILE_FORMAT format)
     g_object_set(_recorderValve, "drop", FALSE, nullptr);
 
     _recording = true;
+
+    // Let the pre-recorded part of the stream through, _keyframeWatch drops it up to the first key frame
+    _configurePreRecord();
+
     qCDebug(VideoReceiverLog) << "Recording started" << _uri;
     _dispatchSignal([this](){
         emit onStartRecordingComplete(STATUS_OK);
@@ -571,7 +687,7 @@ void
 GstVideoReceiver::stopRecording(void)
 {
     if (_needDispatch()) {
-        _slotHandler.dispatch([this]() {
+        _slotHandler->dispatch([this]() {
             stopRecording();
         });
         return;
@@ -590,6 +706,15 @@ GstVideoReceiver::stopRecording(void)
 
     g_object_set(_recorderValve, "drop", TRUE, nullptr);
 
+    _telemetrySync.lock();
+    if (_telemetrySrc != nullptr) {
+        // The muxer waits for every track to end
+        GstFlowReturn flowRet;
+        g_signal_emit_by_name(_telemetrySrc, "end-of-stream", &flowRet);
+        _telemetrySrc = nullptr;
+    }
+    _telemetrySync.unlock();
+
     _removingRecorder = true;
 
     bool ret = _unlinkBranch(_recorderValve);
@@ -601,23 +726,336 @@ GstVideoReceiver::stopRecording(void)
     });
 }
 
+void
+GstVideoReceiver::startRestream(unsigned port, unsigned maxViewers)
+{
+    if (_needDispatch()) {
+        _slotHandler->dispatch([this, port, maxViewers]() {
+            startRestream(port, maxViewers);
+        });
+        return;
+    }
+
+    if (_pipeline == nullptr || _restreamSink != nullptr) {
+        qCDebug(VideoReceiverLog) << "Not streaming or already restreaming" << _uri;
+        _dispatchSignal([this](){
+            emit onStartRestreamComplete(STATUS_INVALID_STATE);
+        });
+        return;
+    }
+
+    // Serves what goes through the tee as is, which takes to know what that is. Right after the source pad was
+    // linked its caps may not have reached the tee yet.
+    GstCaps* caps = nullptr;
+    GstPad*  pad  = nullptr;
+
+    if ((pad = gst_element_get_static_pad(_tee, "sink")) != nullptr) {
+        if ((caps = gst_pad_get_current_caps(pad)) == nullptr) {
+            GstPad* peer;
+
+            if ((peer = gst_pad_get_peer(pad)) != nullptr) {
+                caps = gst_pad_get_current_caps(peer);
+                gst_object_unref(peer);
+                peer = nullptr;
+            }
+        }
+
+        gst_object_unref(pad);
+        pad = nullptr;
+    }
+
+    if (caps == nullptr) {
+        qCDebug(VideoReceiverLog) << "Nothing received yet to restream" << _uri;
+        _dispatchSignal([this](){
+            emit onStartRestreamComplete(STATUS_INVALID_STATE);
+        });
+        return;
+    }
+
+    _restreamSink = _makeRestreamSink(caps, port);
+
+    gst_caps_unref(caps);
+    caps = nullptr;
+
+    if (_restreamSink == nullptr) {
+        qCCritical(VideoReceiverLog) << "_makeRestreamSink() failed" << _uri;
+        _dispatchSignal([this](){
+            emit onStartRestreamComplete(STATUS_FAIL);
+        });
+        return;
+    }
+
+    _restreamMaxViewers = maxViewers;
+    _restreamViewers = 0;
+
+    gst_object_ref(_restreamSink);
+
+    gst_bin_add(GST_BIN(_pipeline), _restreamSink);
+
+    if (!gst_element_link(_restreamValve, _restreamSink)) {
+        qCCritical(VideoReceiverLog) << "Failed to link valve and restream sink" << _uri;
+        _shutdownRestreamBranch();
+        _dispatchSignal([this](){
+            emit onStartRestreamComplete(STATUS_FAIL);
+        });
+        return;
+    }
+
+    gst_element_sync_state_with_parent(_restreamSink);
+
+    g_object_set(_restreamValve, "drop", FALSE, nullptr);
+
+    GST_DEBUG_BIN_TO_DOT_FILE(GST_BIN(_pipeline), GST_DEBUG_GRAPH_SHOW_ALL, "pipeline-with-restream");
+
+    qCDebug(VideoReceiverLog) << "Restreaming on port" << port << "for up to" << maxViewers << "viewers" << _uri;
+
+    _dispatchSignal([this](){
+        emit onStartRestreamComplete(STATUS_OK);
+        emit restreamingChanged(true);
+        emit restreamViewersChanged(0);
+    });
+}
+
+void
+GstVideoReceiver::stopRestream(void)
+{
+    if (_needDispatch()) {
+        _slotHandler->dispatch([this]() {
+            stopRestream();
+        });
+        return;
+    }
+
+    if (_pipeline == nullptr || _restreamSink == nullptr) {
+        return;
+    }
+
+    g_object_set(_restreamValve, "drop", TRUE, nullptr);
+
+    GstPad* pad;
+
+    if ((pad = gst_element_get_static_pad(_restreamValve, "src")) == nullptr) {
+        qCCritical(VideoReceiverLog) << "gst_element_get_static_pad() failed" << _uri;
+        return;
+    }
+
+    // Nothing to finish like a file, the branch goes away as soon as no buffer is on the way into it
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_IDLE, _restreamIdleProbe, this, nullptr);
+    gst_object_unref(pad);
+    pad = nullptr;
+}
+
 void
 GstVideoReceiver::takeScreenshot(const QString& imageFile)
 {
     if (_needDispatch()) {
         QString cachedImageFile = imageFile;
-        _slotHandler.dispatch([this, cachedImageFile]() {
+        _slotHandler->dispatch([this, cachedImageFile]() {
             takeScreenshot(cachedImageFile);
         });
         return;
     }
 
-    // FIXME: AV: record screenshot here
-    _dispatchSignal([this](){
-        emit onTakeScreenshotComplete(STATUS_NOT_IMPLEMENTED);
+    if (_pipeline == nullptr || !_decoding || _videoSink == nullptr) {
+        qCDebug(VideoReceiverLog) << "Not decoding!" << _uri;
+        _dispatchSignal([this](){
+            emit onTakeScreenshotComplete(STATUS_INVALID_STATE);
+        });
+        return;
+    }
+
+    // Copy of the frame on screen, only the pixels are copied here, encoding is up to the receiver of screenshotTaken
+    GstSample* sample = nullptr;
+
+    g_object_get(_videoSink, "last-sample", &sample, nullptr);
+
+    QImage image;
+
+    if (sample != nullptr) {
+        image = _sampleToImage(sample);
+        gst_sample_unref(sample);
+        sample = nullptr;
+    }
+
+    if (image.isNull()) {
+        qCWarning(VideoReceiverLog) << "No frame for screenshot" << _uri;
+        _dispatchSignal([this](){
+            emit onTakeScreenshotComplete(STATUS_FAIL);
+        });
+        return;
+    }
+
+    QString cachedImageFile = imageFile;
+    _dispatchSignal([this, cachedImageFile, image](){
+        emit screenshotTaken(cachedImageFile, image);
+        emit onTakeScreenshotComplete(STATUS_OK);
     });
 }
 
+void
+GstVideoReceiver::setKeyframeOnly(bool keyframeOnly)
+{
+    if (keyframeOnly == static_cast<bool>(_keyframeOnly.load())) {
+        return;
+    }
+
+    qCDebug(VideoReceiverLog) << "Key frame only decoding" << keyframeOnly << _uri;
+
+    // Delta frames can only be decoded again from the next key frame on
+    _waitKeyframe.store(keyframeOnly ? 0 : 1);
+    _keyframeOnly.store(keyframeOnly ? 1 : 0);
+}
+
+void
+GstVideoReceiver::setPreRecordDuration(unsigned seconds)
+{
+    if (_needDispatch()) {
+        _slotHandler->dispatch([this, seconds]() {
+            setPreRecordDuration(seconds);
+        });
+        return;
+    }
+
+    if (seconds == _preRecordSecs) {
+        return;
+    }
+
+    qCDebug(VideoReceiverLog) << "Pre-record duration" << seconds << "secs" << _uri;
+
+    _preRecordSecs = seconds;
+
+    _configurePreRecord();
+}
+
+void
+GstVideoReceiver::setRecordingSegmentDuration(unsigned seconds)
+{
+    if (_needDispatch()) {
+        _slotHandler->dispatch([this, seconds]() {
+            setRecordingSegmentDuration(seconds);
+        });
+        return;
+    }
+
+    _recordingSegmentSecs = seconds;
+}
+
+void
+GstVideoReceiver::setRecordTelemetryTrack(bool enable)
+{
+    if (_needDispatch()) {
+        _slotHandler->dispatch([this, enable]() {
+            setRecordTelemetryTrack(enable);
+        });
+        return;
+    }
+
+    _recordTelemetryTrack = enable;
+}
+
+void
+GstVideoReceiver::setAdaptiveLatency(bool enable)
+{
+    if (_needDispatch()) {
+        _slotHandler->dispatch([this, enable]() {
+            setAdaptiveLatency(enable);
+        });
+        return;
+    }
+
+    _adaptiveLatency = enable;
+}
+
+void
+GstVideoReceiver::setLatencyPreference(unsigned percent)
+{
+    if (_needDispatch()) {
+        _slotHandler->dispatch([this, percent]() {
+            setLatencyPreference(percent);
+        });
+        return;
+    }
+
+    // Picked up by the next _adaptLatency
+    _latencyPreference = qMin(percent, 100u);
+}
+
+void
+GstVideoReceiver::seek(qint64 positionUSecs, double rate, bool keyframe)
+{
+    if (_needDispatch()) {
+        _slotHandler->dispatch([this, positionUSecs, rate, keyframe]() {
+            seek(positionUSecs, rate, keyframe);
+        });
+        return;
+    }
+
+    if (_pipeline == nullptr || !_replay) {
+        qCDebug(VideoReceiverLog) << "Not replaying a file" << _uri;
+        return;
+    }
+
+    // Scrubbing and fast playback only decode key frames, the demuxer skips the delta frames in between
+    int flags = GST_SEEK_FLAG_FLUSH;
+
+    if (keyframe || rate >= _kTrickModeRate) {
+        flags |= GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SNAP_BEFORE | GST_SEEK_FLAG_TRICKMODE | GST_SEEK_FLAG_TRICKMODE_KEY_UNITS;
+    } else {
+        flags |= GST_SEEK_FLAG_ACCURATE;
+    }
+
+    // Paused first, the flushing seek then prerolls the frame at the position and the pipeline stays there
+    if (rate <= 0) {
+        gst_element_set_state(_pipeline, GST_STATE_PAUSED);
+    }
+
+    GstEvent* event = gst_event_new_seek(rate > 0 ? rate : 1.0, GST_FORMAT_TIME, static_cast<GstSeekFlags>(flags),
+                                         GST_SEEK_TYPE_SET, static_cast<gint64>(qMax<qint64>(positionUSecs, 0) * GST_USECOND),
+                                         GST_SEEK_TYPE_NONE, static_cast<gint64>(GST_CLOCK_TIME_NONE));
+
+    // Pushed up from the tee, a seek sent to the pipeline would reach the source once for each branch
+    GstPad* pad;
+
+    if ((pad = gst_element_get_static_pad(_tee, "sink")) != nullptr) {
+        if (!gst_pad_push_event(pad, event)) {
+            qCWarning(VideoReceiverLog) << "Seek failed" << positionUSecs << rate << _uri;
+        }
+        gst_object_unref(pad);
+        pad = nullptr;
+    } else {
+        qCCritical(VideoReceiverLog) << "gst_element_get_static_pad() failed";
+        gst_event_unref(event);
+    }
+
+    event = nullptr;
+
+    if (rate > 0) {
+        gst_element_set_state(_pipeline, GST_STATE_PLAYING);
+    }
+}
+
+void
+GstVideoReceiver::setThermalProcessing(const ThermalProcessing& processing)
+{
+    if (_needDispatch()) {
+        _slotHandler->dispatch([this, processing]() {
+            setThermalProcessing(processing);
+        });
+        return;
+    }
+
+    _thermal = processing;
+
+    _configureThermalFilter();
+}
+
+void
+GstVideoReceiver::setTelemetry(const Telemetry& telemetry)
+{
+    QMutexLocker lock(&_telemetrySync);
+    _telemetry = telemetry;
+}
+
 const char* GstVideoReceiver::_kFileMux[FILE_FORMAT_MAX - FILE_FORMAT_MIN] = {
     "matroskamux",
     "qtmux",
@@ -627,13 +1065,18 @@ const char* GstVideoReceiver::_kFileMux[FILE_FORMAT_MAX - FILE_FORMAT_MIN] = {
 void
 GstVideoReceiver::_watchdog(void)
 {
-    _slotHandler.dispatch([this](){
+    _slotHandler->dispatch([this](){
         if(_pipeline == nullptr) {
             return;
         }
 
         const qint64 now = QDateTime::currentSecsSinceEpoch();
 
+        // A paused replay or one at the end of its file has no frames either
+        if (_replay) {
+            _lastSourceFrameTime = _lastVideoFrameTime = now;
+        }
+
         if (_lastSourceFrameTime == 0) {
             _lastSourceFrameTime = now;
         }
@@ -643,7 +1086,9 @@ GstVideoReceiver::_watchdog(void)
             _dispatchSignal([this](){
                 emit timeout();
             });
-            stop();
+            if (!_restartSource()) {
+                stop();
+            }
         }
 
         if (_decoding && !_removingDecoder) {
@@ -659,6 +1104,10 @@ GstVideoReceiver::_watchdog(void)
                 stop();
             }
         }
+
+        if (_pipeline != nullptr) {
+            _reportLatency();
+        }
     });
 }
 
@@ -697,6 +1146,8 @@ GstVideoReceiver::_makeSource(const QString& uri)
     bool isUdp265   = uri.contains("udp265://", Qt::CaseInsensitive);
     bool isTcpMPEGTS= uri.contains("tcp://",    Qt::CaseInsensitive);
     bool isUdpMPEGTS= uri.contains("mpegts://", Qt::CaseInsensitive);
+    bool isSrt      = uri.startsWith("srt://",  Qt::CaseInsensitive);
+    bool isFile     = uri.startsWith("file://", Qt::CaseInsensitive);
 
     GstElement* source  = nullptr;
     GstElement* buffer  = nullptr;
@@ -714,11 +1165,65 @@ GstVideoReceiver::_makeSource(const QString& uri)
             }
         } else if (isRtsp) {
             if ((source = gst_element_factory_make("rtspsrc", "source")) != nullptr) {
-                g_object_set(static_cast<gpointer>(source), "location", qPrintable(uri), "latency", 17, "udp-reconnect", 1, "timeout", _udpReconnect_us, NULL);
-            }
-        } else if(isUdp264 || isUdp265 || isUdpMPEGTS || isTaisync) {
-            if ((source = gst_element_factory_make("udpsrc", "source")) != nullptr) {
-                g_object_set(static_cast<gpointer>(source), "uri", QString("udp://%1:%2").arg(qPrintable(url.host()), QString::number(url.port())).toUtf8().data(), nullptr);
+                // Nothing to tune without sync
+                const bool  adaptive = _adaptiveLatency && _buffer >= 0;
+                const guint latency  = adaptive ? _adaptiveLatencyFloorMsecs(_latencyPreference) : _kRtspLatencyMsecs;
+
+                g_object_set(static_cast<gpointer>(source), "location", qPrintable(uri), "latency", latency, "udp-reconnect", 1, "timeout", _udpReconnect_us, NULL);
+
+                if (adaptive) {
+                    g_object_set(static_cast<gpointer>(source), "drop-on-latency", _latencyPreference < 50, nullptr);
+
+                    // rtspsrc only passes its latency to new sessions, retune its rtpbin instead
+                    g_signal_connect(source, "new-manager", G_CALLBACK(_onNewRtpManager), this);
+                    _latencyMsecs = latency;
+                }
+
+                // Sender NTP time of each frame, if the sender provides RTCP sender reports (GStreamer 1.22+)
+                if (g_object_class_find_property(G_OBJECT_GET_CLASS(source), "add-reference-timestamp-meta") != nullptr) {
+                    g_object_set(static_cast<gpointer>(source), "add-reference-timestamp-meta", TRUE, nullptr);
+                }
+
+                g_signal_connect(source, "pad-added", G_CALLBACK(_onNewRtpSourcePad), this);
+            }
+        } else if (isTaisync) {
+            // Raw h.264 pushed by the Taisync bridge from its I/O thread, no loopback UDP hop in between
+            if ((source = gst_element_factory_make("appsrc", "source")) != nullptr) {
+                g_object_set(static_cast<gpointer>(source), "is-live", TRUE, "format", GST_FORMAT_TIME, "do-timestamp", TRUE, "max-bytes", static_cast<guint64>(_kFeedMaxBytes), nullptr);
+
+                // Drop the oldest data rather than queue without limit while downstream stalls (GStreamer 1.20+)
+                if (g_object_class_find_property(G_OBJECT_GET_CLASS(source), "leaky-type") != nullptr) {
+                    g_object_set(static_cast<gpointer>(source), "leaky-type", 2 /* GST_APP_LEAKY_TYPE_DOWNSTREAM */, nullptr);
+                }
+
+                GstCaps* caps = nullptr;
+
+                if ((caps = gst_caps_from_string("video/x-h264, stream-format=(string)byte-stream")) == nullptr) {
+                    qCCritical(VideoReceiverLog) << "gst_caps_from_string() failed";
+                    break;
+                }
+
+                g_object_set(static_cast<gpointer>(source), "caps", caps, nullptr);
+                gst_caps_unref(caps);
+                caps = nullptr;
+
+                // The feed keeps its own reference, a restarted source replaces it
+                std::shared_ptr<GstElement> appsrc(GST_ELEMENT(gst_object_ref(source)), gst_object_unref);
+
+                VideoStreamFeed::feed(VideoStreamFeed::taisyncFeed)->setConsumer([appsrc](const char* data, int length) {
+                    GstBuffer* buffer = gst_buffer_new_allocate(nullptr, static_cast<gsize>(length), nullptr);
+
+                    if (buffer != nullptr) {
+                        GstFlowReturn ret = GST_FLOW_OK;
+                        gst_buffer_fill(buffer, 0, data, static_cast<gsize>(length));
+                        g_signal_emit_by_name(appsrc.get(), "push-buffer", buffer, &ret);
+                        gst_buffer_unref(buffer);
+                    }
+                });
+            }
+        } else if(isUdp264 || isUdp265 || isUdpMPEGTS) {
+            if ((source = gst_element_factory_make("udpsrc", "source")) != nullptr) {
+                g_object_set(static_cast<gpointer>(source), "uri", QString("udp://%1:%2").arg(qPrintable(url.host()), QString::number(url.port())).toUtf8().data(), nullptr);
 
                 GstCaps* caps = nullptr;
 
@@ -740,6 +1245,28 @@ GstVideoReceiver::_makeSource(const QString& uri)
                     caps = nullptr;
                 }
             }
+        } else if (isSrt) {
+            // MPEG-TS over SRT: lost packets are requested again (ARQ) within the latency, which is agreed on with
+            // the sender on connect. Caller or listener mode, passphrase etc. come from the uri query.
+            if ((source = gst_element_factory_make("srtsrc", "source")) != nullptr) {
+                g_object_set(static_cast<gpointer>(source), "uri", qPrintable(uri), nullptr);
+
+                if (!QUrlQuery(url).hasQueryItem(QStringLiteral("latency"))) {
+                    g_object_set(static_cast<gpointer>(source), "latency", static_cast<gint>(_kSrtLatencyMsecs), nullptr);
+                }
+
+                // Reconnecting is up to the source timeout, don't block the state change on the sender
+                if (g_object_class_find_property(G_OBJECT_GET_CLASS(source), "wait-for-connection") != nullptr) {
+                    g_object_set(static_cast<gpointer>(source), "wait-for-connection", FALSE, nullptr);
+                }
+
+                _srtSource = source;
+            }
+        } else if (isFile) {
+            // A recording being replayed, parsebin picks the demuxer
+            if ((source = gst_element_factory_make("filesrc", "source")) != nullptr) {
+                g_object_set(static_cast<gpointer>(source), "location", qPrintable(url.toLocalFile()), nullptr);
+            }
         } else {
             qCDebug(VideoReceiverLog) << "URI is not recognized";
         }
@@ -763,7 +1290,18 @@ GstVideoReceiver::_makeSource(const QString& uri)
 
         // FIXME: AV: Android does not determine MPEG2-TS via parsebin - have to explicitly state which demux to use
         // FIXME: AV: tsdemux handling is a bit ugly - let's try to find elegant solution for that later
-        if (isTcpMPEGTS || isUdpMPEGTS) {
+        if (isTcpMPEGTS || isUdpMPEGTS || isSrt) {
+            if (isSrt) {
+                GstPad* pad;
+
+                // Arrival time of the TS packets, for the source stage of the latency stats
+                if ((pad = gst_element_get_static_pad(source, "src")) != nullptr) {
+                    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, _sourceLatencyProbe, this, nullptr);
+                    gst_object_unref(pad);
+                    pad = nullptr;
+                }
+            }
+
             if ((tsdemux = gst_element_factory_make("tsdemux", nullptr)) == nullptr) {
                 qCCritical(VideoReceiverLog) << "gst_element_factory_make('tsdemux') failed";
                 break;
@@ -785,18 +1323,47 @@ GstVideoReceiver::_makeSource(const QString& uri)
         gst_element_foreach_src_pad(source, _padProbe, &probeRes);
 
         if (probeRes & 1) {
+            if (probeRes & 2) {
+                GstPad* pad;
+
+                if ((pad = gst_element_get_static_pad(source, "src")) != nullptr) {
+                    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, _sourceLatencyProbe, this, nullptr);
+                    gst_object_unref(pad);
+                    pad = nullptr;
+                }
+            }
+
             if (probeRes & 2 && _buffer >= 0) {
                 if ((buffer = gst_element_factory_make("rtpjitterbuffer", nullptr)) == nullptr) {
                     qCCritical(VideoReceiverLog) << "gst_element_factory_make('rtpjitterbuffer') failed";
                     break;
                 }
 
+                if (g_object_class_find_property(G_OBJECT_GET_CLASS(buffer), "add-reference-timestamp-meta") != nullptr) {
+                    g_object_set(static_cast<gpointer>(buffer), "add-reference-timestamp-meta", TRUE, nullptr);
+                }
+
+                if (_adaptiveLatency) {
+                    _latencyMsecs = _adaptiveLatencyFloorMsecs(_latencyPreference);
+                    g_object_set(static_cast<gpointer>(buffer), "latency", _latencyMsecs, "drop-on-latency", _latencyPreference < 50, nullptr);
+                }
+
+                GstPad* pad;
+
+                if ((pad = gst_element_get_static_pad(buffer, "src")) != nullptr) {
+                    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, _jitterBufferLatencyProbe, this, nullptr);
+                    gst_object_unref(pad);
+                    pad = nullptr;
+                }
+
                 gst_bin_add(GST_BIN(bin), buffer);
 
                 if (!gst_element_link_many(source, buffer, parser, nullptr)) {
                     qCCritical(VideoReceiverLog) << "gst_element_link() failed";
                     break;
                 }
+
+                _jitterBuffer = buffer;
             } else {
                 if (!gst_element_link(source, parser)) {
                     qCCritical(VideoReceiverLog) << "gst_element_link() failed";
@@ -855,6 +1422,9 @@ GstVideoReceiver::_makeDecoder(GstCaps* caps, GstElement* videoSink)
             qCCritical(VideoReceiverLog) << "gst_element_factory_make('decodebin3') failed";
             break;
         }
+
+        // Decoder choice follows the ranks set by GStreamer::blacklist, report which one was picked
+        g_signal_connect(decoder, "deep-element-added", G_CALLBACK(_onDecoderElementAdded), this);
     } while(0);
 
     return decoder;
@@ -923,6 +1493,8 @@ GstVideoReceiver::_makeFileSink(const QString& videoFile, FILE_FORMAT format)
             break;
         }
 
+        _addTelemetryTrack(bin, mux);
+
         fileSink = bin;
         bin = nullptr;
     } while(0);
@@ -947,6 +1519,220 @@ GstVideoReceiver::_makeFileSink(const QString& videoFile, FILE_FORMAT format)
     return fileSink;
 }
 
+// MPEG-TS over TCP for remote viewers, straight from the received and parsed stream without decoding. The parser
+// repeats SPS/PPS at every key frame and tcpserversink starts each new viewer at the latest key frame, each viewer
+// has its own queue and a viewer which falls too far behind skips ahead to the next key frame.
+GstElement*
+GstVideoReceiver::_makeRestreamSink(GstCaps* caps, unsigned port)
+{
+    GstElement* restreamSink    = nullptr;
+    GstElement* parser          = nullptr;
+    GstElement* mux             = nullptr;
+    GstElement* sink            = nullptr;
+    GstElement* bin             = nullptr;
+    bool        releaseElements = true;
+
+    do {
+        const GstStructure* s       = gst_caps_get_structure(caps, 0);
+        const gchar*        parserName = nullptr;
+
+        if (gst_structure_has_name(s, "video/x-h264")) {
+            parserName = "h264parse";
+        } else if (gst_structure_has_name(s, "video/x-h265")) {
+            parserName = "h265parse";
+        } else {
+            qCWarning(VideoReceiverLog) << "Only h.264 and h.265 streams can be restreamed, not" << gst_structure_get_name(s);
+            break;
+        }
+
+        if ((parser = gst_element_factory_make(parserName, nullptr)) == nullptr) {
+            qCCritical(VideoReceiverLog) << "gst_element_factory_make('" << parserName << "') failed";
+            break;
+        }
+
+        g_object_set(static_cast<gpointer>(parser), "config-interval", -1, nullptr);
+
+        if ((mux = gst_element_factory_make("mpegtsmux", nullptr)) == nullptr) {
+            qCCritical(VideoReceiverLog) << "gst_element_factory_make('mpegtsmux') failed";
+            break;
+        }
+
+        if ((sink = gst_element_factory_make("tcpserversink", nullptr)) == nullptr) {
+            qCCritical(VideoReceiverLog) << "gst_element_factory_make('tcpserversink') failed";
+            break;
+        }
+
+        g_object_set(static_cast<gpointer>(sink),
+                     "host",            "0.0.0.0",
+                     "port",            static_cast<gint>(port),
+                     "sync",            FALSE,
+                     "async",           FALSE,
+                     "sync-method",     2 /* latest-keyframe */,
+                     "recover-policy",  3 /* keyframe */,
+                     "units-format",    GST_FORMAT_TIME,
+                     "units-soft-max",  static_cast<gint64>(_kRestreamQueueMsecs * GST_MSECOND),
+                     "units-max",       static_cast<gint64>(2 * _kRestreamQueueMsecs * GST_MSECOND),
+                     "timeout",         static_cast<guint64>(_kRestreamTimeoutSecs * GST_SECOND),
+                     nullptr);
+
+        g_signal_connect(sink, "client-added",   G_CALLBACK(_onRestreamClientAdded),   this);
+        g_signal_connect(sink, "client-removed", G_CALLBACK(_onRestreamClientRemoved), this);
+
+        if ((bin = gst_bin_new("restreambin")) == nullptr) {
+            qCCritical(VideoReceiverLog) << "gst_bin_new('restreambin') failed";
+            break;
+        }
+
+        gst_bin_add_many(GST_BIN(bin), parser, mux, sink, nullptr);
+
+        releaseElements = false;
+
+        if (!gst_element_link_many(parser, mux, sink, nullptr)) {
+            qCCritical(VideoReceiverLog) << "gst_element_link_many() failed";
+            break;
+        }
+
+        GstPad* pad;
+
+        if ((pad = gst_element_get_static_pad(parser, "sink")) == nullptr) {
+            qCCritical(VideoReceiverLog) << "gst_element_get_static_pad() failed";
+            break;
+        }
+
+        gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad));
+        gst_object_unref(pad);
+        pad = nullptr;
+
+        restreamSink = bin;
+        bin = nullptr;
+    } while(0);
+
+    if (releaseElements) {
+        if (sink != nullptr) {
+            gst_object_unref(sink);
+            sink = nullptr;
+        }
+
+        if (mux != nullptr) {
+            gst_object_unref(mux);
+            mux = nullptr;
+        }
+
+        if (parser != nullptr) {
+            gst_object_unref(parser);
+            parser = nullptr;
+        }
+    }
+
+    if (bin != nullptr) {
+        gst_object_unref(bin);
+        bin = nullptr;
+    }
+
+    return restreamSink;
+}
+
+// Same as _makeFileSink but splitmuxsink starts a new file every _recordingSegmentSecs (at the next key frame), so an
+// interrupted recording only loses the last segment and finished segments can be uploaded right away.
+// Segments are named <videoFile base name>_00000.<ext>, _00001.<ext> etc.
+GstElement*
+GstVideoReceiver::_makeSegmentedFileSink(const QString& videoFile, FILE_FORMAT format)
+{
+    GstElement* fileSink = nullptr;
+    GstElement* mux = nullptr;
+    GstElement* splitmux = nullptr;
+    GstElement* bin = nullptr;
+    bool releaseElements = true;
+
+    do{
+        if (format < FILE_FORMAT_MIN || format >= FILE_FORMAT_MAX) {
+            qCCritical(VideoReceiverLog) << "Unsupported file format";
+            break;
+        }
+
+        if ((mux = gst_element_factory_make(_kFileMux[format - FILE_FORMAT_MIN], nullptr)) == nullptr) {
+            qCCritical(VideoReceiverLog) << "gst_element_factory_make('" << _kFileMux[format - FILE_FORMAT_MIN] << "') failed";
+            break;
+        }
+
+        // Fragmented MOV/MP4 so that the segment being written is playable as well
+        if (g_object_class_find_property(G_OBJECT_GET_CLASS(mux), "fragment-duration") != nullptr) {
+            g_object_set(mux, "fragment-duration", _kFragmentMsecs, nullptr);
+        }
+
+        if ((splitmux = gst_element_factory_make("splitmuxsink", nullptr)) == nullptr) {
+            qCCritical(VideoReceiverLog) << "gst_element_factory_make('splitmuxsink') failed";
+            break;
+        }
+
+        const QFileInfo videoFileInfo(videoFile);
+        const QString   location = QStringLiteral("%1/%2_%05d.%3").arg(videoFileInfo.path(), videoFileInfo.completeBaseName(), videoFileInfo.suffix());
+
+        g_object_set(splitmux,
+                     "location",        qPrintable(location),
+                     "max-size-time",   static_cast<guint64>(_recordingSegmentSecs) * GST_SECOND,
+                     "muxer",           mux,
+                     nullptr);
+
+        // Owned by splitmux now
+        mux = nullptr;
+
+        if ((bin = gst_bin_new("sinkbin")) == nullptr) {
+            qCCritical(VideoReceiverLog) << "gst_bin_new('sinkbin') failed";
+            break;
+        }
+
+        GstPadTemplate* padTemplate;
+
+        if ((padTemplate = gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(splitmux), "video")) == nullptr) {
+            qCCritical(VideoReceiverLog) << "gst_element_class_get_pad_template(splitmux) failed";
+            break;
+        }
+
+        GstPad* pad;
+
+        if ((pad = gst_element_request_pad(splitmux, padTemplate, nullptr, nullptr)) == nullptr) {
+            qCCritical(VideoReceiverLog) << "gst_element_request_pad(splitmux) failed";
+            break;
+        }
+
+        gst_bin_add(GST_BIN(bin), splitmux);
+
+        releaseElements = false;
+
+        GstPad* ghostpad = gst_ghost_pad_new("sink", pad);
+
+        gst_element_add_pad(bin, ghostpad);
+
+        gst_object_unref(pad);
+        pad = nullptr;
+
+        _addTelemetryTrack(bin, splitmux);
+
+        fileSink = bin;
+        bin = nullptr;
+    } while(0);
+
+    if (releaseElements) {
+        if (splitmux != nullptr) {
+            gst_object_unref(splitmux);
+            splitmux = nullptr;
+        }
+
+        if (mux != nullptr) {
+            gst_object_unref(mux);
+            mux = nullptr;
+        }
+    }
+
+    if (bin != nullptr) {
+        gst_object_unref(bin);
+        bin = nullptr;
+    }
+
+    return fileSink;
+}
+
 void
 GstVideoReceiver::_onNewSourcePad(GstPad* pad)
 {
@@ -966,7 +1752,8 @@ GstVideoReceiver::_onNewSourcePad(GstPad* pad)
 
     gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, _eosProbe, this, nullptr);
 
-    if (_videoSink == nullptr) {
+    // The decoding branch is kept over a source restart
+    if (_videoSink == nullptr || _decoder != nullptr) {
         return;
     }
 
@@ -1122,12 +1909,20 @@ void
 GstVideoReceiver::_noteTeeFrame(void)
 {
     _lastSourceFrameTime = QDateTime::currentSecsSinceEpoch();
+    _sourceRestarts = 0;
 }
 
 void
 GstVideoReceiver::_noteVideoSinkFrame(void)
 {
     _lastVideoFrameTime = QDateTime::currentSecsSinceEpoch();
+    if (_sourceRecovering.testAndSetOrdered(1, 0)) {
+        const qint64 msecs = _sourceRestartTimer.elapsed();
+        qCDebug(VideoReceiverLog) << "Stream recovered after" << msecs << "msecs" << _uri;
+        _dispatchSignal([this, msecs](){
+            emit streamRecovered(msecs);
+        });
+    }
     if (!_decoding) {
         _decoding = true;
         qCDebug(VideoReceiverLog) << "Decoding started";
@@ -1143,134 +1938,1109 @@ GstVideoReceiver::_noteEndOfStream(void)
     _endOfStream = true;
 }
 
-// -Unlink the branch from the src pad
-// -Send an EOS event at the beginning of that branch
-bool
-GstVideoReceiver::_unlinkBranch(GstElement* from)
+// Buffer timestamps of live sources are the running time of their arrival, so the age of a buffer at any pad
+// downstream is the time it took to get there.
+void
+GstVideoReceiver::_noteStageLatency(LatencyStage_t stage, GstPad* pad, GstBuffer* buffer)
 {
-    GstPad* src;
+    const GstClockTime pts = GST_BUFFER_PTS(buffer);
 
-    if ((src = gst_element_get_static_pad(from, "src")) == nullptr) {
-        qCCritical(VideoReceiverLog) << "gst_element_get_static_pad() failed";
-        return false;
+    if (!GST_CLOCK_TIME_IS_VALID(pts)) {
+        return;
     }
 
-    GstPad* sink;
+    GstEvent* event;
 
-    if ((sink = gst_pad_get_peer(src)) == nullptr) {
-        gst_object_unref(src);
-        src = nullptr;
-        qCCritical(VideoReceiverLog) << "gst_pad_get_peer() failed";
-        return false;
+    if ((event = gst_pad_get_sticky_event(pad, GST_EVENT_SEGMENT, 0)) == nullptr) {
+        return;
     }
 
-    if (!gst_pad_unlink(src, sink)) {
-        gst_object_unref(src);
-        src = nullptr;
-        gst_object_unref(sink);
-        sink = nullptr;
-        qCCritical(VideoReceiverLog) << "gst_pad_unlink() failed";
-        return false;
+    const GstSegment* segment = nullptr;
+    GstClockTime bufferTime = GST_CLOCK_TIME_NONE;
+
+    gst_event_parse_segment(event, &segment);
+
+    if (segment != nullptr && segment->format == GST_FORMAT_TIME) {
+        bufferTime = gst_segment_to_running_time(segment, GST_FORMAT_TIME, pts);
     }
 
-    gst_object_unref(src);
-    src = nullptr;
+    gst_event_unref(event);
+    event = nullptr;
 
-    // Send EOS at the beginning of the branch
-    const gboolean ret = gst_pad_send_event(sink, gst_event_new_eos());
+    const GstClockTime now = _runningTime();
 
-    gst_object_unref(sink);
-    sink = nullptr;
+    if (!GST_CLOCK_TIME_IS_VALID(bufferTime) || !GST_CLOCK_TIME_IS_VALID(now)) {
+        return;
+    }
 
-    if (!ret) {
-        qCCritical(VideoReceiverLog) << "Branch EOS was NOT sent";
-        return false;
+    const qint64 age = static_cast<qint64>(now) - static_cast<qint64>(bufferTime);
+
+    QMutexLocker lock(&_latencySync);
+
+    _stageAgeSum[stage] += age;
+    _stageAgeCount[stage]++;
+
+    if (stage != LatencyStageDecoder) {
+        return;
     }
 
-    qCDebug(VideoReceiverLog) << "Branch EOS was sent";
+    // A synced sink holds the frame until its running time plus the pipeline latency
+    qint64 sinkWait = 0;
 
-    return true;
+    if (_buffer >= 0) {
+        sinkWait = qMax(static_cast<qint64>(0), static_cast<qint64>(bufferTime + _pipelineLatency) - static_cast<qint64>(now));
+    }
+
+    _sinkWaitSum += sinkWait;
+    _sinkWaitCount++;
+
+    GstReferenceTimestampMeta* meta;
+
+    if ((meta = gst_buffer_get_reference_timestamp_meta(buffer, _ntpTimestampCaps)) != nullptr) {
+        // Only meaningful if the sender clock is NTP synced as well
+        const qint64 ntpNow = (QDateTime::currentMSecsSinceEpoch() + _kNtpUnixOffsetMsecs) * GST_MSECOND;
+        _frameAgeSum += ntpNow - static_cast<qint64>(meta->timestamp) + sinkWait;
+        _frameAgeCount++;
+    }
 }
 
+// RTP header timestamp and sequence number of each packet, see RFC 3550 A.8 for the jitter estimate
 void
-GstVideoReceiver::_shutdownDecodingBranch(void)
+GstVideoReceiver::_noteRtpPacket(GstBuffer* buffer)
 {
-    if (_decoder != nullptr) {
-        GstObject* parent;
-
-        if ((parent = gst_element_get_parent(_decoder)) != nullptr) {
-            gst_bin_remove(GST_BIN(_pipeline), _decoder);
-            gst_element_set_state(_decoder, GST_STATE_NULL);
-            gst_object_unref(parent);
-            parent = nullptr;
-        }
+    guint8 header[12];
 
-        gst_object_unref(_decoder);
-        _decoder = nullptr;
+    if (gst_buffer_extract(buffer, 0, header, sizeof(header)) != sizeof(header) || (header[0] >> 6) != 2) {
+        return;
     }
 
-    if (_videoSinkProbeId != 0) {
-        GstPad* sinkpad;
-        if ((sinkpad = gst_element_get_static_pad(_videoSink, "sink")) != nullptr) {
-            gst_pad_remove_probe(sinkpad, _videoSinkProbeId);
-            gst_object_unref(sinkpad);
-            sinkpad = nullptr;
-        }
-        _videoSinkProbeId = 0;
+    const GstClockTime arrival = _runningTime();
+
+    if (!GST_CLOCK_TIME_IS_VALID(arrival)) {
+        return;
     }
 
-    _lastVideoFrameTime = 0;
+    const quint16 seq       = static_cast<quint16>((header[2] << 8) | header[3]);
+    const quint32 timestamp = (static_cast<quint32>(header[4]) << 24) | (static_cast<quint32>(header[5]) << 16) | (static_cast<quint32>(header[6]) << 8) | header[7];
 
-    GstObject* parent;
+    QMutexLocker lock(&_latencySync);
 
-    if ((parent = gst_element_get_parent(_videoSink)) != nullptr) {
+    if (_rtpPacketSeen) {
+        const quint16 seqDelta = static_cast<quint16>(seq - _rtpLastSeq);
+
+        if (seqDelta == 0 || seqDelta >= 0x8000) {
+            // Duplicate or reordered
+            return;
+        }
+
+        _rtpPacketsLost += seqDelta - 1;
+
+        const double transitDelta = (static_cast<double>(arrival) - static_cast<double>(_rtpLastArrival))
+                - static_cast<double>(static_cast<qint32>(timestamp - _rtpLastTimestamp)) * GST_SECOND / _kRtpClockRate;
+
+        _rtpJitterNsecs += (qAbs(transitDelta) - _rtpJitterNsecs) / 16.0;
+    }
+
+    _rtpPacketSeen      = true;
+    _rtpLastSeq         = seq;
+    _rtpLastTimestamp   = timestamp;
+    _rtpLastArrival     = arrival;
+}
+
+void
+GstVideoReceiver::_noteQos(GstMessage* message)
+{
+    GstFormat format;
+    guint64 processed = 0;
+    guint64 dropped = 0;
+
+    gst_message_parse_qos_stats(message, &format, &processed, &dropped);
+
+    if (format != GST_FORMAT_BUFFERS || dropped == static_cast<guint64>(-1)) {
+        return;
+    }
+
+    // Each element reports its running total
+    QMutexLocker lock(&_latencySync);
+    _qosDropped[GST_MESSAGE_SRC(message)] = dropped;
+}
+
+void
+GstVideoReceiver::_noteDecoderElement(GstElement* element)
+{
+    GstElementFactory* factory;
+
+    if ((factory = gst_element_get_factory(element)) == nullptr) {
+        return;
+    }
+
+    const gchar* klass = gst_element_factory_get_metadata(factory, GST_ELEMENT_METADATA_KLASS);
+
+    if (klass == nullptr || strstr(klass, "Decoder") == nullptr || strstr(klass, "Video") == nullptr) {
+        return;
+    }
+
+    const QString name = QString::fromUtf8(gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(factory)));
+    const bool hardware = GStreamer::isHardwareDecoder(factory);
+
+    qCDebug(VideoReceiverLog) << "Video decoder" << name << (hardware ? "(hardware)" : "(software)") << _uri;
+
+    QMutexLocker lock(&_decoderSync);
+    _decoderName = name;
+    _decoderHardware = hardware;
+}
+
+// GL or DMABuf memory at the sink means frames go from the decoder to qmlglsink without being copied by the CPU
+void
+GstVideoReceiver::_noteVideoSinkCaps(GstPad* pad)
+{
+    QString memory = QStringLiteral("SystemMemory");
+    GstCaps* caps;
+
+    if ((caps = gst_pad_get_current_caps(pad)) != nullptr) {
+        GstCapsFeatures* features;
+
+        if (gst_caps_get_size(caps) > 0 && (features = gst_caps_get_features(caps, 0)) != nullptr) {
+            if (gst_caps_features_contains(features, "memory:GLMemory")) {
+                memory = QStringLiteral("GLMemory");
+            } else if (gst_caps_features_contains(features, "memory:DMABuf")) {
+                memory = QStringLiteral("DMABuf");
+            } else if (gst_caps_features_contains(features, "meta:GstVideoGLTextureUploadMeta")) {
+                memory = QStringLiteral("GLTextureUploadMeta");
+            }
+        }
+
+        gst_caps_unref(caps);
+        caps = nullptr;
+    }
+
+    _decoderSync.lock();
+    const QString name = _decoderName;
+    const bool hardware = _decoderHardware;
+    _decoderSync.unlock();
+
+    if (hardware && memory == QStringLiteral("SystemMemory")) {
+        qCWarning(VideoReceiverLog) << "Hardware decoder" << name << "output is copied to system memory before upload" << _uri;
+    } else {
+        qCDebug(VideoReceiverLog) << "Video sink input" << memory << "from" << name << _uri;
+    }
+
+    _dispatchSignal([this, name, hardware, memory](){
+        emit videoDecoderChanged(name, hardware, memory);
+    });
+}
+
+void
+GstVideoReceiver::_reportLatency(void)
+{
+    GstQuery* query;
+
+    if ((query = gst_query_new_latency()) != nullptr) {
+        if (gst_element_query(_pipeline, query)) {
+            gboolean live;
+            GstClockTime minLatency;
+            GstClockTime maxLatency;
+
+            gst_query_parse_latency(query, &live, &minLatency, &maxLatency);
+
+            QMutexLocker lock(&_latencySync);
+            _pipelineLatency = GST_CLOCK_TIME_IS_VALID(minLatency) ? minLatency : 0;
+        }
+
+        gst_query_unref(query);
+        query = nullptr;
+    }
+
+    LatencyStats stats;
+
+    if (_jitterBuffer != nullptr) {
+        GstStructure* s = nullptr;
+
+        g_object_get(_jitterBuffer, "stats", &s, nullptr);
+
+        if (s != nullptr) {
+            guint64 late = 0;
+
+            gst_structure_get_uint64(s, "num-late", &late);
+            stats.packetsLate = late;
+            gst_structure_free(s);
+            s = nullptr;
+        }
+    }
+
+    const qint64 elapsed = _latencyReportTimer.restart();
+
+    {
+        QMutexLocker lock(&_latencySync);
+
+        double* stageMsecs[LatencyStageCount] = { &stats.sourceMsecs, &stats.jitterBufferMsecs, &stats.parserMsecs, &stats.decoderMsecs };
+        double  arrivalMsecs = 0;   // Age at the output of the last stage which saw buffers
+
+        for (int i=0; i<LatencyStageCount; i++) {
+            if (_stageAgeCount[i] > 0) {
+                const double ageMsecs = static_cast<double>(_stageAgeSum[i]) / _stageAgeCount[i] / GST_MSECOND;
+                *stageMsecs[i] = qMax(0.0, ageMsecs - arrivalMsecs);
+                arrivalMsecs = qMax(arrivalMsecs, ageMsecs);
+            }
+        }
+
+        if (_sinkWaitCount > 0) {
+            stats.sinkMsecs = static_cast<double>(_sinkWaitSum) / _sinkWaitCount / GST_MSECOND;
+        }
+        if (_stageAgeCount[LatencyStageDecoder] > 0) {
+            stats.totalMsecs = arrivalMsecs + stats.sinkMsecs;
+            if (elapsed > 0) {
+                stats.framesPerSecond = _stageAgeCount[LatencyStageDecoder] * 1000.0 / elapsed;
+            }
+        }
+        if (_frameAgeCount > 0) {
+            stats.frameAgeMsecs = static_cast<double>(_frameAgeSum) / _frameAgeCount / GST_MSECOND;
+        }
+        if (_rtpPacketSeen) {
+            stats.jitterMsecs = _rtpJitterNsecs / GST_MSECOND;
+        }
+        stats.packetsLost = _rtpPacketsLost;
+        for (quint64 dropped: _qosDropped) {
+            stats.framesDropped += dropped;
+        }
+
+        // Averages are per interval, counters are since start
+        for (int i=0; i<LatencyStageCount; i++) {
+            _stageAgeSum[i] = 0;
+            _stageAgeCount[i] = 0;
+        }
+        _sinkWaitSum = 0;
+        _sinkWaitCount = 0;
+        _frameAgeSum = 0;
+        _frameAgeCount = 0;
+    }
+
+    // Counted by SRT itself, there are no RTP packets to look at
+    if (_srtSource != nullptr) {
+        _getSrtStats(stats);
+    }
+
+    qCDebug(VideoReceiverLog) << "Latency msecs total:" << stats.totalMsecs
+                              << "source:" << stats.sourceMsecs
+                              << "jitterbuffer:" << stats.jitterBufferMsecs
+                              << "parser:" << stats.parserMsecs
+                              << "decoder:" << stats.decoderMsecs
+                              << "sink:" << stats.sinkMsecs
+                              << "frameAge:" << stats.frameAgeMsecs
+                              << "jitter:" << stats.jitterMsecs
+                              << "rtt:" << stats.roundTripMsecs
+                              << "fps:" << stats.framesPerSecond
+                              << "lost:" << stats.packetsLost
+                              << "late:" << stats.packetsLate
+                              << "dropped:" << stats.framesDropped
+                              << _uri;
+
+    _adaptLatency(stats);
+
+    _dispatchSignal([this, stats](){
+        emit latencyStatsChanged(stats);
+    });
+}
+
+// Loss and retransmission counters of srtsrc. A listener keeps them per caller, the first one is the sender.
+void
+GstVideoReceiver::_getSrtStats(LatencyStats& stats)
+{
+    GstStructure* s = nullptr;
+
+    g_object_get(_srtSource, "stats", &s, nullptr);
+
+    if (s == nullptr) {
+        return;
+    }
+
+    const GstStructure* caller = s;
+    const GValue*       callers = gst_structure_get_value(s, "callers");
+
+    if (callers != nullptr && G_VALUE_HOLDS(callers, G_TYPE_VALUE_ARRAY)) {
+        G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+        GValueArray* array = static_cast<GValueArray*>(g_value_get_boxed(callers));
+        caller = nullptr;
+        if (array != nullptr && array->n_values > 0 && GST_VALUE_HOLDS_STRUCTURE(g_value_array_get_nth(array, 0))) {
+            caller = gst_value_get_structure(g_value_array_get_nth(array, 0));
+        }
+        G_GNUC_END_IGNORE_DEPRECATIONS
+    }
+
+    if (caller != nullptr) {
+        gint    lost    = 0;
+        gint    dropped = 0;
+        gdouble rtt     = -1;
+
+        if (gst_structure_get_int(caller, "packets-received-lost", &lost)) {
+            stats.packetsLost = static_cast<quint64>(qMax(lost, 0));
+        }
+        if (gst_structure_get_int(caller, "packets-received-dropped", &dropped)) {
+            stats.packetsLate = static_cast<quint64>(qMax(dropped, 0));
+        }
+        if (gst_structure_get_double(caller, "rtt-ms", &rtt)) {
+            stats.roundTripMsecs = rtt;
+        }
+    }
+
+    gst_structure_free(s);
+    s = nullptr;
+}
+
+// Grows the latency right away when the jitter goes up or packets show up late, shrinks it slowly when the link
+// settles down again so that a single quiet second does not bring back the stutter.
+void
+GstVideoReceiver::_adaptLatency(const LatencyStats& stats)
+{
+    if (!_adaptiveLatency || _latencyMsecs == 0 || stats.jitterMsecs < 0) {
+        return;
+    }
+
+    const bool      late     = stats.packetsLate > _adaptLastLate || stats.packetsLost > _adaptLastLost;
+    const double    s        = _latencyPreference / 100.0;
+    const guint     minMsecs = _adaptiveLatencyFloorMsecs(_latencyPreference);
+    const guint     maxMsecs = _adaptiveLatencyCeilingMsecs(_latencyPreference);
+
+    _adaptLastLate = stats.packetsLate;
+    _adaptLastLost = stats.packetsLost;
+
+    guint target = _adaptiveLatencyMsecs(stats.jitterMsecs, _latencyPreference);
+
+    if (late) {
+        target = qMax(target, static_cast<guint>(_latencyMsecs * (1.2 + 0.3 * s)));
+    }
+
+    guint latency;
+
+    if (target > _latencyMsecs) {
+        latency = target;
+    } else {
+        const guint step = qMax((_latencyMsecs - target) / 8, static_cast<guint>(_kLatencyStepMsecs));
+        latency = _latencyMsecs - target > step ? _latencyMsecs - step : target;
+    }
+    latency = qBound(minMsecs, latency, maxMsecs);
+
+    if (latency + _kLatencyStepMsecs > _latencyMsecs && latency < _latencyMsecs + _kLatencyStepMsecs) {
+        return;
+    }
+
+    qCDebug(VideoReceiverLog) << "Adaptive latency" << _latencyMsecs << "->" << latency << "msecs, jitter:" << stats.jitterMsecs
+                              << "late:" << late << "preference:" << _latencyPreference << _uri;
+
+    _setJitterBufferLatency(latency, _latencyPreference < 50);
+}
+
+guint
+GstVideoReceiver::_adaptiveLatencyMsecs(double jitterMsecs, unsigned preference)
+{
+    const double s = qMin(preference, 100u) / 100.0;
+
+    // Jitter is a mean deviation, the smoother end covers the bursts well past it
+    const double latency = _adaptiveLatencyFloorMsecs(preference) + qMax(0.0, jitterMsecs) * (3 + 9 * s);
+
+    return qMin(static_cast<guint>(latency), _adaptiveLatencyCeilingMsecs(preference));
+}
+
+void
+GstVideoReceiver::_setJitterBufferLatency(guint msecs, bool dropOnLatency)
+{
+    GstElement* element = nullptr;
+
+    if (_jitterBuffer != nullptr) {
+        element = GST_ELEMENT(gst_object_ref(_jitterBuffer));
+    } else {
+        QMutexLocker lock(&_latencySync);
+        if (_rtpManager != nullptr) {
+            element = GST_ELEMENT(gst_object_ref(_rtpManager));
+        }
+    }
+
+    if (element == nullptr) {
+        return;
+    }
+
+    // Both post a latency message, handled in _onBusMessage, rtpbin passes the values on to its jitter buffers
+    g_object_set(static_cast<gpointer>(element), "latency", msecs, "drop-on-latency", dropOnLatency, nullptr);
+    gst_object_unref(element);
+
+    _latencyMsecs = msecs;
+}
+
+void
+GstVideoReceiver::_resetLatencyStats(void)
+{
+    QMutexLocker lock(&_latencySync);
+
+    for (int i=0; i<LatencyStageCount; i++) {
+        _stageAgeSum[i] = 0;
+        _stageAgeCount[i] = 0;
+    }
+    _sinkWaitSum        = 0;
+    _sinkWaitCount      = 0;
+    _frameAgeSum        = 0;
+    _frameAgeCount      = 0;
+    _rtpPacketSeen      = false;
+    _rtpLastSeq         = 0;
+    _rtpLastTimestamp   = 0;
+    _rtpLastArrival     = 0;
+    _rtpJitterNsecs     = 0;
+    _rtpPacketsLost     = 0;
+    _adaptLastLost      = 0;
+    _adaptLastLate      = 0;
+    _pipelineLatency    = 0;
+    _qosDropped.clear();
+    _latencyReportTimer.start();
+}
+
+GstClockTime
+GstVideoReceiver::_runningTime(void)
+{
+    GstClock* clock;
+
+    if (_pipeline == nullptr || (clock = gst_element_get_clock(_pipeline)) == nullptr) {
+        return GST_CLOCK_TIME_NONE;
+    }
+
+    const GstClockTime now = gst_clock_get_time(clock);
+    const GstClockTime baseTime = gst_element_get_base_time(_pipeline);
+
+    gst_object_unref(clock);
+    clock = nullptr;
+
+    return now >= baseTime ? now - baseTime : GST_CLOCK_TIME_NONE;
+}
+
+// -Unlink the branch from the src pad
+// -Send an EOS event at the beginning of that branch
+bool
+GstVideoReceiver::_unlinkBranch(GstElement* from)
+{
+    GstPad* src;
+
+    if ((src = gst_element_get_static_pad(from, "src")) == nullptr) {
+        qCCritical(VideoReceiverLog) << "gst_element_get_static_pad() failed";
+        return false;
+    }
+
+    GstPad* sink;
+
+    if ((sink = gst_pad_get_peer(src)) == nullptr) {
+        gst_object_unref(src);
+        src = nullptr;
+        qCCritical(VideoReceiverLog) << "gst_pad_get_peer() failed";
+        return false;
+    }
+
+    if (!gst_pad_unlink(src, sink)) {
+        gst_object_unref(src);
+        src = nullptr;
+        gst_object_unref(sink);
+        sink = nullptr;
+        qCCritical(VideoReceiverLog) << "gst_pad_unlink() failed";
+        return false;
+    }
+
+    gst_object_unref(src);
+    src = nullptr;
+
+    // Send EOS at the beginning of the branch
+    const gboolean ret = gst_pad_send_event(sink, gst_event_new_eos());
+
+    gst_object_unref(sink);
+    sink = nullptr;
+
+    if (!ret) {
+        qCCritical(VideoReceiverLog) << "Branch EOS was NOT sent";
+        return false;
+    }
+
+    qCDebug(VideoReceiverLog) << "Branch EOS was sent";
+
+    return true;
+}
+
+void
+GstVideoReceiver::_shutdownDecodingBranch(void)
+{
+    if (_decoder != nullptr) {
+        GstObject* parent;
+
+        if ((parent = gst_element_get_parent(_decoder)) != nullptr) {
+            gst_bin_remove(GST_BIN(_pipeline), _decoder);
+            gst_element_set_state(_decoder, GST_STATE_NULL);
+            gst_object_unref(parent);
+            parent = nullptr;
+        }
+
+        gst_object_unref(_decoder);
+        _decoder = nullptr;
+    }
+
+    if (_videoSinkProbeId != 0) {
+        GstPad* sinkpad;
+        if ((sinkpad = gst_element_get_static_pad(_videoSink, "sink")) != nullptr) {
+            gst_pad_remove_probe(sinkpad, _videoSinkProbeId);
+            gst_object_unref(sinkpad);
+            sinkpad = nullptr;
+        }
+        _videoSinkProbeId = 0;
+    }
+
+    _lastVideoFrameTime = 0;
+
+    _latencySync.lock();
+    _qosDropped.clear();
+    _latencySync.unlock();
+
+    _decoderSync.lock();
+    _decoderName.clear();
+    _decoderHardware = false;
+    _decoderSync.unlock();
+
+    GstObject* parent;
+
+    if ((parent = gst_element_get_parent(_videoSink)) != nullptr) {
         gst_bin_remove(GST_BIN(_pipeline), _videoSink);
         gst_element_set_state(_videoSink, GST_STATE_NULL);
         gst_object_unref(parent);
         parent = nullptr;
     }
 
-    gst_object_unref(_videoSink);
-    _videoSink = nullptr;
+    gst_object_unref(_videoSink);
+    _videoSink = nullptr;
+
+    _removingDecoder = false;
+
+    if (_decoding) {
+        _decoding = false;
+        qCDebug(VideoReceiverLog) << "Decoding stopped";
+        _dispatchSignal([this](){
+            emit decodingChanged(_decoding);
+        });
+    }
+
+    GST_DEBUG_BIN_TO_DOT_FILE(GST_BIN(_pipeline), GST_DEBUG_GRAPH_SHOW_ALL, "pipeline-decoding-stopped");
+}
+
+void
+GstVideoReceiver::_shutdownRecordingBranch(void)
+{
+    _telemetrySync.lock();
+    _telemetrySrc = nullptr;
+    _telemetrySync.unlock();
+
+    gst_bin_remove(GST_BIN(_pipeline), _fileSink);
+    gst_element_set_state(_fileSink, GST_STATE_NULL);
+    gst_object_unref(_fileSink);
+    _fileSink = nullptr;
+
+    _removingRecorder = false;
+
+    if (_recording) {
+        _recording = false;
+        qCDebug(VideoReceiverLog) << "Recording stopped";
+        _dispatchSignal([this](){
+            emit recordingChanged(_recording);
+        });
+    }
+
+    // Start buffering for the next recording
+    _configurePreRecord();
+
+    GST_DEBUG_BIN_TO_DOT_FILE(GST_BIN(_pipeline), GST_DEBUG_GRAPH_SHOW_ALL, "pipeline-recording-stopped");
+}
+
+void
+GstVideoReceiver::_shutdownRestreamBranch(void)
+{
+    GstPad* src;
+
+    if ((src = gst_element_get_static_pad(_restreamValve, "src")) != nullptr) {
+        GstPad* sink;
+
+        if ((sink = gst_pad_get_peer(src)) != nullptr) {
+            gst_pad_unlink(src, sink);
+            gst_object_unref(sink);
+            sink = nullptr;
+        }
+
+        gst_object_unref(src);
+        src = nullptr;
+    }
+
+    // Closes the viewer connections
+    gst_bin_remove(GST_BIN(_pipeline), _restreamSink);
+    gst_element_set_state(_restreamSink, GST_STATE_NULL);
+    gst_object_unref(_restreamSink);
+    _restreamSink = nullptr;
+
+    _restreamViewers = 0;
+
+    qCDebug(VideoReceiverLog) << "Restreaming stopped" << _uri;
+
+    _dispatchSignal([this](){
+        emit restreamingChanged(false);
+        emit restreamViewersChanged(0);
+    });
+
+    GST_DEBUG_BIN_TO_DOT_FILE(GST_BIN(_pipeline), GST_DEBUG_GRAPH_SHOW_ALL, "pipeline-restream-stopped");
+}
+
+// Adds an appsrc to the file sink bin which feeds a timed text track of the muxer (or splitmuxsink) with one
+// telemetry sample per video frame, see _pushTelemetry. Recording works as before if the muxer has no text track.
+void
+GstVideoReceiver::_addTelemetryTrack(GstElement* bin, GstElement* mux)
+{
+    if (!_recordTelemetryTrack) {
+        return;
+    }
+
+    GstPadTemplate* padTemplate;
+
+    if ((padTemplate = gst_element_class_get_pad_template(GST_ELEMENT_GET_CLASS(mux), "subtitle_%u")) == nullptr) {
+        qCWarning(VideoReceiverLog) << "Muxer has no text track, recording without telemetry" << _uri;
+        return;
+    }
+
+    GstElement* src;
+
+    if ((src = gst_element_factory_make("appsrc", "telemetrysrc")) == nullptr) {
+        qCCritical(VideoReceiverLog) << "gst_element_factory_make('appsrc') failed";
+        return;
+    }
+
+    GstCaps* caps = gst_caps_new_simple("text/x-raw", "format", G_TYPE_STRING, "utf8", nullptr);
+
+    g_object_set(src,
+                 "caps",        caps,
+                 "format",      GST_FORMAT_TIME,
+                 "is-live",     TRUE,
+                 "block",       FALSE,
+                 nullptr);
+
+    gst_caps_unref(caps);
+    caps = nullptr;
+
+    GstPad* muxPad;
+
+    if ((muxPad = gst_element_request_pad(mux, padTemplate, nullptr, nullptr)) == nullptr) {
+        qCCritical(VideoReceiverLog) << "gst_element_request_pad(mux, subtitle) failed";
+        gst_object_unref(src);
+        return;
+    }
+
+    gst_bin_add(GST_BIN(bin), src);
+
+    GstPad* srcPad = gst_element_get_static_pad(src, "src");
+
+    if (gst_pad_link(srcPad, muxPad) != GST_PAD_LINK_OK) {
+        qCCritical(VideoReceiverLog) << "Unable to link telemetry track";
+        gst_bin_remove(GST_BIN(bin), src);
+        gst_element_release_request_pad(mux, muxPad);
+    } else {
+        GstPad* ghostPad;
+
+        if ((ghostPad = gst_element_get_static_pad(bin, "sink")) != nullptr) {
+            gst_pad_add_probe(ghostPad, GST_PAD_PROBE_TYPE_BUFFER, _telemetryProbe, this, nullptr);
+            gst_object_unref(ghostPad);
+            ghostPad = nullptr;
+        }
+
+        QMutexLocker lock(&_telemetrySync);
+        _telemetrySrc = src;
+    }
+
+    gst_object_unref(srcPad);
+    srcPad = nullptr;
+    gst_object_unref(muxPad);
+    muxPad = nullptr;
+}
+
+// Streaming thread: stamps the latest telemetry with the running time the video frame has in the recording, so each
+// sample lines up with its frame in the file.
+void
+GstVideoReceiver::_pushTelemetry(GstPad* pad, GstBuffer* videoBuffer)
+{
+    if (!GST_BUFFER_PTS_IS_VALID(videoBuffer)) {
+        return;
+    }
+
+    GstEvent* event;
+
+    if ((event = gst_pad_get_sticky_event(pad, GST_EVENT_SEGMENT, 0)) == nullptr) {
+        return;
+    }
+
+    const GstSegment* segment = nullptr;
+
+    gst_event_parse_segment(event, &segment);
+
+    const GstClockTime runningTime = gst_segment_to_running_time(segment, GST_FORMAT_TIME, GST_BUFFER_PTS(videoBuffer));
+
+    gst_event_unref(event);
+    event = nullptr;
+
+    if (!GST_CLOCK_TIME_IS_VALID(runningTime)) {
+        return;
+    }
+
+    QMutexLocker lock(&_telemetrySync);
+
+    if (_telemetrySrc == nullptr) {
+        return;
+    }
+
+    QByteArray sample = "{}";
+
+    if (_telemetry.valid) {
+        sample = QStringLiteral("{\"t\":%1,\"lat\":%2,\"lon\":%3,\"alt\":%4,\"roll\":%5,\"pitch\":%6,\"heading\":%7}")
+                .arg(_telemetry.timeMsecs)
+                .arg(_telemetry.latitude, 0, 'f', 8)
+                .arg(_telemetry.longitude, 0, 'f', 8)
+                .arg(_telemetry.altitudeAMSL, 0, 'f', 2)
+                .arg(_telemetry.roll, 0, 'f', 2)
+                .arg(_telemetry.pitch, 0, 'f', 2)
+                .arg(_telemetry.heading, 0, 'f', 2).toUtf8();
+    }
+
+    GstBuffer* buffer = gst_buffer_new_allocate(nullptr, static_cast<gsize>(sample.size()), nullptr);
+
+    gst_buffer_fill(buffer, 0, sample.constData(), static_cast<gsize>(sample.size()));
+    GST_BUFFER_PTS(buffer)      = runningTime;
+    GST_BUFFER_DURATION(buffer) = GST_BUFFER_DURATION(videoBuffer);
+
+    // Does not take the buffer
+    GstFlowReturn ret;
+    g_signal_emit_by_name(_telemetrySrc, "push-buffer", buffer, &ret);
+
+    gst_buffer_unref(buffer);
+    buffer = nullptr;
+}
+
+// Mapping a GL memory buffer downloads it, which happens here on the worker thread instead of the GUI thread
+QImage
+GstVideoReceiver::_sampleToImage(GstSample* sample)
+{
+    GstCaps*    caps    = gst_sample_get_caps(sample);
+    GstBuffer*  buffer  = gst_sample_get_buffer(sample);
+
+    if (caps == nullptr || buffer == nullptr) {
+        return QImage();
+    }
+
+    const GstStructure* s       = gst_caps_get_structure(caps, 0);
+    const gchar*        format  = gst_structure_get_string(s, "format");
+    gint                width   = 0;
+    gint                height  = 0;
+
+    gst_structure_get_int(s, "width", &width);
+    gst_structure_get_int(s, "height", &height);
+
+    // What glcolorconvert/the sink bin produce, other formats would need videoconvert in the pipeline
+    static const QHash<QString, QImage::Format> imageFormats = {
+        { QStringLiteral("RGBA"), QImage::Format_RGBA8888 },
+        { QStringLiteral("RGBx"), QImage::Format_RGBX8888 },
+        { QStringLiteral("BGRA"), QImage::Format_ARGB32 },
+        { QStringLiteral("BGRx"), QImage::Format_RGB32 },
+    };
+
+    if (format == nullptr || !imageFormats.contains(QString(format)) || width <= 0 || height <= 0) {
+        qCWarning(VideoReceiverLog) << "Unsupported screenshot format" << (format ? format : "") << width << height;
+        return QImage();
+    }
+
+    GstMapInfo map;
+
+    if (!gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+        qCCritical(VideoReceiverLog) << "gst_buffer_map() failed";
+        return QImage();
+    }
+
+    QImage image;
+    const gsize stride = map.size / static_cast<gsize>(height);
+
+    if (stride >= static_cast<gsize>(width) * 4) {
+        image = QImage(map.data, width, height, static_cast<int>(stride), imageFormats[QString(format)]).copy();
+    }
+
+    gst_buffer_unmap(buffer, &map);
+
+    return image;
+}
+
+// Called from the streaming threads for element messages, picks up new files opened by splitmuxsink
+void
+GstVideoReceiver::_noteRecordingSegment(const GstStructure* s)
+{
+    if (s == nullptr || !gst_structure_has_name(s, "splitmuxsink-fragment-opened")) {
+        return;
+    }
+
+    const gchar* location = gst_structure_get_string(s, "location");
+
+    if (location == nullptr) {
+        return;
+    }
+
+    const QString segmentFile = QString::fromUtf8(location);
+
+    _slotHandler->dispatch([this, segmentFile](){
+        // The same message can arrive directly and forwarded by the bin
+        if (!_recording || segmentFile == _recordingSegmentFile) {
+            return;
+        }
+
+        _recordingSegmentFile = segmentFile;
+
+        qCDebug(VideoReceiverLog) << "Recording segment" << segmentFile << _uri;
+
+        _dispatchSignal([this, segmentFile](){
+            emit recordingSegmentStarted(segmentFile);
+        });
+    });
+}
+
+void
+GstVideoReceiver::_noteThermalStats(const GstStructure* s)
+{
+    ThermalStats stats;
+    gboolean radiometric = FALSE;
+    guint value = 0;
+
+    gst_structure_get_boolean(s, "radiometric", &radiometric);
+    stats.radiometric = radiometric;
+
+    if (gst_structure_get_uint(s, "frame-min", &value)) {
+        stats.frameMin = static_cast<quint16>(value);
+    }
+    if (gst_structure_get_uint(s, "frame-max", &value)) {
+        stats.frameMax = static_cast<quint16>(value);
+    }
+    if ((stats.hasSpot = gst_structure_get_uint(s, "spot", &value))) {
+        stats.spot = static_cast<quint16>(value);
+    }
+    if ((stats.hasArea = gst_structure_get_uint(s, "area-min", &value))) {
+        stats.areaMin = static_cast<quint16>(value);
+        if (gst_structure_get_uint(s, "area-max", &value)) {
+            stats.areaMax = static_cast<quint16>(value);
+        }
+        if (gst_structure_get_uint(s, "area-mean", &value)) {
+            stats.areaMean = static_cast<quint16>(value);
+        }
+    }
+
+    // Posted from the GL thread
+    _slotHandler->dispatch([this, stats](){
+        _dispatchSignal([this, stats](){
+            emit thermalStatsChanged(stats);
+        });
+    });
+}
+
+// Processing runs in the qgcthermalfilter of qgcvideosinkbin, other video sinks show thermal frames unprocessed
+void
+GstVideoReceiver::_configureThermalFilter(void)
+{
+    if (_videoSink == nullptr || !_thermal.enabled) {
+        return;
+    }
+
+    if (g_object_class_find_property(G_OBJECT_GET_CLASS(_videoSink), "thermal") == nullptr) {
+        qCDebug(VideoReceiverLog) << "Video sink has no thermal processing" << _uri;
+        return;
+    }
+
+    if (GST_STATE(_videoSink) == GST_STATE_NULL) {
+        g_object_set(_videoSink, "thermal", TRUE, nullptr);
+    }
+
+    GstElement* filter;
+
+    if ((filter = gst_bin_get_by_name(GST_BIN(_videoSink), "thermalfilter")) == nullptr) {
+        qCWarning(VideoReceiverLog) << "No thermal filter in the video sink" << _uri;
+        return;
+    }
+
+    const bool spot = _thermal.spot.x() >= 0 && _thermal.spot.y() >= 0;
+    const bool area = !_thermal.area.isEmpty();
+
+    g_object_set(filter,
+                 "palette",         static_cast<gint>(_thermal.palette),
+                 "auto-range",      static_cast<gboolean>(_thermal.autoRange),
+                 "range-low",       static_cast<guint>(_thermal.rangeLow),
+                 "range-high",      static_cast<guint>(_thermal.rangeHigh),
+                 "isotherm-low",    static_cast<guint>(_thermal.isothermLow),
+                 "isotherm-high",   static_cast<guint>(_thermal.isothermHigh),
+                 "spot-x",          spot ? qBound(0.0, _thermal.spot.x(), 1.0) : -1.0,
+                 "spot-y",          spot ? qBound(0.0, _thermal.spot.y(), 1.0) : -1.0,
+                 "area-x",          area ? qBound(0.0, _thermal.area.x(), 1.0) : 0.0,
+                 "area-y",          area ? qBound(0.0, _thermal.area.y(), 1.0) : 0.0,
+                 "area-width",      area ? qBound(0.0, _thermal.area.width(), 1.0) : 0.0,
+                 "area-height",     area ? qBound(0.0, _thermal.area.height(), 1.0) : 0.0,
+                 nullptr);
+
+    gst_object_unref(filter);
+}
+
+// Sizes the recorder queue for the pre-record duration and holds it back while not recording. The queue leaks its
+// oldest buffers once full, so memory is bounded by both the duration and _kPreRecordMaxBytes.
+void
+GstVideoReceiver::_configurePreRecord(void)
+{
+    if (_recorderQueue == nullptr) {
+        return;
+    }
+
+    if (_preRecordSecs > 0) {
+        g_object_set(_recorderQueue,
+                     "leaky",               2,  // downstream, drop the oldest buffers
+                     "max-size-buffers",    0,
+                     "max-size-bytes",      _kPreRecordMaxBytes,
+                     "max-size-time",       static_cast<guint64>(_preRecordSecs) * GST_SECOND,
+                     nullptr);
+    } else {
+        // queue defaults
+        g_object_set(_recorderQueue,
+                     "leaky",               0,
+                     "max-size-buffers",    200,
+                     "max-size-bytes",      10 * 1024 * 1024,
+                     "max-size-time",       GST_SECOND,
+                     nullptr);
+    }
 
-    _removingDecoder = false;
+    const bool hold = _preRecordSecs > 0 && !_recording;
 
-    if (_decoding) {
-        _decoding = false;
-        qCDebug(VideoReceiverLog) << "Decoding stopped";
-        _dispatchSignal([this](){
-            emit decodingChanged(_decoding);
-        });
+    GstPad* pad;
+
+    if ((pad = gst_element_get_static_pad(_recorderQueue, "src")) == nullptr) {
+        qCCritical(VideoReceiverLog) << "gst_element_get_static_pad() failed" << _uri;
+        return;
     }
 
-    GST_DEBUG_BIN_TO_DOT_FILE(GST_BIN(_pipeline), GST_DEBUG_GRAPH_SHOW_ALL, "pipeline-decoding-stopped");
+    if (hold && _preRecordProbeId == 0) {
+        _preRecordProbeId = gst_pad_add_probe(pad, static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BLOCK | GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST), _preRecordBlockProbe, this, nullptr);
+        qCDebug(VideoReceiverLog) << "Pre-recording" << _preRecordSecs << "secs" << _uri;
+    } else if (!hold && _preRecordProbeId != 0) {
+        gst_pad_remove_probe(pad, _preRecordProbeId);
+        _preRecordProbeId = 0;
+    }
+
+    gst_object_unref(pad);
+    pad = nullptr;
 }
 
+// Links the source bin to the tee, now or once its src pad shows up
 void
-GstVideoReceiver::_shutdownRecordingBranch(void)
+GstVideoReceiver::_linkSource(void)
 {
-    gst_bin_remove(GST_BIN(_pipeline), _fileSink);
-    gst_element_set_state(_fileSink, GST_STATE_NULL);
-    gst_object_unref(_fileSink);
-    _fileSink = nullptr;
+    GstPad* srcPad = nullptr;
 
-    _removingRecorder = false;
+    GstIterator* it;
 
-    if (_recording) {
-        _recording = false;
-        qCDebug(VideoReceiverLog) << "Recording stopped";
-        _dispatchSignal([this](){
-            emit recordingChanged(_recording);
-        });
+    if ((it = gst_element_iterate_src_pads(_source)) != nullptr) {
+        GValue vpad = G_VALUE_INIT;
+
+        if (gst_iterator_next(it, &vpad) == GST_ITERATOR_OK) {
+            srcPad = GST_PAD(g_value_get_object(&vpad));
+            gst_object_ref(srcPad);
+            g_value_reset(&vpad);
+        }
+
+        gst_iterator_free(it);
+        it = nullptr;
     }
 
-    GST_DEBUG_BIN_TO_DOT_FILE(GST_BIN(_pipeline), GST_DEBUG_GRAPH_SHOW_ALL, "pipeline-recording-stopped");
+    if (srcPad != nullptr) {
+        _onNewSourcePad(srcPad);
+        gst_object_unref(srcPad);
+        srcPad = nullptr;
+    } else {
+        g_signal_connect(_source, "pad-added", G_CALLBACK(_onNewPad), this);
+    }
+}
+
+// Warm restart after a dropout: only the source bin (source, jitter buffer, parsebin) is replaced, the tee, the
+// decoding branch and the recording branch keep running. Same uri means the same caps after parsebin, so decodebin3
+// keeps its decoder and the video sink keeps its negotiated format, and a recording goes on in the same file.
+// @return false: Restart the whole pipeline instead
+bool
+GstVideoReceiver::_restartSource(void)
+{
+    if (_pipeline == nullptr || _source == nullptr || _stopping.load()) {
+        return false;
+    }
+
+    if (_sourceRestarts.fetchAndAddOrdered(1) >= _kMaxSourceRestarts) {
+        qCDebug(VideoReceiverLog) << "Source restarts did not bring the stream back" << _uri;
+        return false;
+    }
+
+    qCDebug(VideoReceiverLog) << "Restarting source" << _uri;
+
+    _sourceRestartTimer.start();
+
+    GstElement* source  = _source;
+    GstPad*     pad     = nullptr;
+
+    // Late pads of the old source are ignored by _onNewPad
+    _source = nullptr;
+    g_signal_handlers_disconnect_by_data(source, this);
+
+    // Drop what is left of the old stream in the decoder and let go of a source thread blocked downstream
+    if (_decoderQueue != nullptr && (pad = gst_element_get_static_pad(_decoderQueue, "sink")) != nullptr) {
+        gst_pad_send_event(pad, gst_event_new_flush_start());
+    }
+
+    gst_element_set_state(source, GST_STATE_NULL);
+    gst_bin_remove(GST_BIN(_pipeline), source);
+    source = nullptr;
+
+    if (pad != nullptr) {
+        gst_pad_send_event(pad, gst_event_new_flush_stop(FALSE));
+        gst_object_unref(pad);
+        pad = nullptr;
+    }
+
+    // Decoder lost its reference frames
+    _waitKeyframe = 1;
+
+    _jitterBuffer = nullptr;
+    _srtSource = nullptr;
+    _latencyMsecs = 0;
+
+    _latencySync.lock();
+    _rtpManager = nullptr;
+    _rtpPacketSeen = false;
+    _latencySync.unlock();
+
+    _lastSourceFrameTime = 0;
+    _lastVideoFrameTime = 0;
+
+    if ((_source = _makeSource(_uri)) == nullptr) {
+        qCCritical(VideoReceiverLog) << "_makeSource() failed" << _uri;
+        return false;
+    }
+
+    gst_bin_add(GST_BIN(_pipeline), _source);
+
+    _linkSource();
+
+    if (!gst_element_sync_state_with_parent(_source)) {
+        qCCritical(VideoReceiverLog) << "Unable to start the new source" << _uri;
+        return false;
+    }
+
+    _sourceRecovering = _decoding ? 1 : 0;
+
+    GST_DEBUG_BIN_TO_DOT_FILE(GST_BIN(_pipeline), GST_DEBUG_GRAPH_SHOW_ALL, "pipeline-source-restarted");
+
+    return true;
 }
 
 bool
 GstVideoReceiver::_needDispatch(void)
 {
-    return _slotHandler.needDispatch();
+    return _slotHandler->needDispatch();
 }
 
 void
@@ -1307,23 +3077,49 @@ GstVideoReceiver::_onBusMessage(GstBus* bus, GstMessage* msg, gpointer data)
                 error = nullptr;
             }
 
-            pThis->_slotHandler.dispatch([pThis](){
-                qCDebug(VideoReceiverLog) << "Stopping because of error";
-                pThis->stop();
+            GstObject* src = GST_OBJECT(gst_object_ref(GST_MESSAGE_SRC(msg)));
+
+            pThis->_slotHandler->dispatch([pThis, src](){
+                // Errors of the source, such as a lost connection, only need a new source
+                const bool sourceError = pThis->_source != nullptr && gst_object_has_as_ancestor(src, GST_OBJECT(pThis->_source));
+
+                gst_object_unref(src);
+
+                if (!sourceError || !pThis->_restartSource()) {
+                    qCDebug(VideoReceiverLog) << "Stopping because of error";
+                    pThis->stop();
+                }
             });
         } while(0);
         break;
     case GST_MESSAGE_EOS:
-        pThis->_slotHandler.dispatch([pThis](){
+        pThis->_slotHandler->dispatch([pThis](){
             qCDebug(VideoReceiverLog) << "Received EOS";
             pThis->_handleEOS();
         });
         break;
+    case GST_MESSAGE_QOS:
+        pThis->_noteQos(msg);
+        break;
+    case GST_MESSAGE_LATENCY:
+        // Jitter buffer latency changed at runtime
+        pThis->_slotHandler->dispatch([pThis](){
+            if (pThis->_pipeline != nullptr) {
+                gst_bin_recalculate_latency(GST_BIN(pThis->_pipeline));
+            }
+        });
+        break;
     case GST_MESSAGE_ELEMENT:
         do {
             const GstStructure* s = gst_message_get_structure (msg);
 
+            if (gst_structure_has_name(s, "qgc-thermal-stats")) {
+                pThis->_noteThermalStats(s);
+                break;
+            }
+
             if (!gst_structure_has_name (s, "GstBinForwarded")) {
+                pThis->_noteRecordingSegment(s);
                 break;
             }
 
@@ -1336,10 +3132,12 @@ GstVideoReceiver::_onBusMessage(GstBus* bus, GstMessage* msg, gpointer data)
             }
 
             if (GST_MESSAGE_TYPE(forward_msg) == GST_MESSAGE_EOS) {
-                pThis->_slotHandler.dispatch([pThis](){
+                pThis->_slotHandler->dispatch([pThis](){
                     qCDebug(VideoReceiverLog) << "Received branch EOS";
                     pThis->_handleEOS();
                 });
+            } else if (GST_MESSAGE_TYPE(forward_msg) == GST_MESSAGE_ELEMENT) {
+                pThis->_noteRecordingSegment(gst_message_get_structure(forward_msg));
             }
 
             gst_message_unref(forward_msg);
@@ -1448,12 +3246,15 @@ GstVideoReceiver::_padProbe(GstElement* element, GstPad* pad, gpointer user_data
 GstPadProbeReturn
 GstVideoReceiver::_teeProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
 {
-    Q_UNUSED(pad)
-    Q_UNUSED(info)
-
     if(user_data != nullptr) {
         GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
         pThis->_noteTeeFrame();
+
+        GstBuffer* buf;
+
+        if (info != nullptr && (buf = gst_pad_probe_info_get_buffer(info)) != nullptr) {
+            pThis->_noteStageLatency(LatencyStageParser, pad, buf);
+        }
     }
 
     return GST_PAD_PROBE_OK;
@@ -1462,15 +3263,14 @@ GstVideoReceiver::_teeProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_da
 GstPadProbeReturn
 GstVideoReceiver::_videoSinkProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
 {
-    Q_UNUSED(pad)
-    Q_UNUSED(info)
-
     if(user_data != nullptr) {
         GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
 
         if (pThis->_resetVideoSink) {
             pThis->_resetVideoSink = false;
 
+            pThis->_noteVideoSinkCaps(pad);
+
 // FIXME: AV: this makes MPEG2-TS playing smooth but breaks RTSP
 //            gst_pad_send_event(pad, gst_event_new_flush_start());
 //            gst_pad_send_event(pad, gst_event_new_flush_stop(TRUE));
@@ -1496,6 +3296,12 @@ GstVideoReceiver::_videoSinkProbe(GstPad* pad, GstPadProbeInfo* info, gpointer u
         }
 
         pThis->_noteVideoSinkFrame();
+
+        GstBuffer* buf;
+
+        if (info != nullptr && (buf = gst_pad_probe_info_get_buffer(info)) != nullptr) {
+            pThis->_noteStageLatency(LatencyStageDecoder, pad, buf);
+        }
     }
 
     return GST_PAD_PROBE_OK;
@@ -1504,7 +3310,6 @@ GstVideoReceiver::_videoSinkProbe(GstPad* pad, GstPadProbeInfo* info, gpointer u
 GstPadProbeReturn
 GstVideoReceiver::_eosProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
 {
-    Q_UNUSED(pad);
     Q_ASSERT(user_data != nullptr);
 
     if(info != nullptr) {
@@ -1512,6 +3317,24 @@ GstVideoReceiver::_eosProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_da
 
         if (GST_EVENT_TYPE(event) == GST_EVENT_EOS) {
             GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
+
+            if (!pThis->_stopping.load() && pThis->_replay) {
+                // End of the file, the last frame stays up until the next seek
+                return GST_PAD_PROBE_DROP;
+            }
+
+            if (!pThis->_stopping.load()) {
+                // Sender went away, keep the branches out of EOS and only replace the source
+                const void* source = GST_PAD_PARENT(pad);
+                pThis->_slotHandler->dispatch([pThis, source](){
+                    if (pThis->_source == source && !pThis->_restartSource()) {
+                        pThis->_noteEndOfStream();
+                        pThis->stop();
+                    }
+                });
+                return GST_PAD_PROBE_DROP;
+            }
+
             pThis->_noteEndOfStream();
         }
     }
@@ -1546,3 +3369,233 @@ GstVideoReceiver::_keyframeWatch(GstPad* pad, GstPadProbeInfo* info, gpointer us
 
     return GST_PAD_PROBE_REMOVE;
 }
+
+GstPadProbeReturn
+GstVideoReceiver::_sourceLatencyProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    if (info != nullptr && user_data != nullptr) {
+        GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
+        GstBuffer* buf;
+
+        if ((buf = gst_pad_probe_info_get_buffer(info)) != nullptr) {
+            pThis->_noteRtpPacket(buf);
+            pThis->_noteStageLatency(LatencyStageSource, pad, buf);
+        }
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn
+GstVideoReceiver::_jitterBufferLatencyProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    if (info != nullptr && user_data != nullptr) {
+        GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
+        GstBuffer* buf;
+
+        if ((buf = gst_pad_probe_info_get_buffer(info)) != nullptr) {
+            pThis->_noteStageLatency(LatencyStageJitterBuffer, pad, buf);
+        }
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+void
+GstVideoReceiver::_onNewRtpManager(GstElement* element, GstElement* manager, gpointer data)
+{
+    Q_UNUSED(element)
+
+    GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(data);
+
+    if (g_object_class_find_property(G_OBJECT_GET_CLASS(manager), "latency") == nullptr) {
+        return;
+    }
+
+    QMutexLocker lock(&pThis->_latencySync);
+    pThis->_rtpManager = manager;
+}
+
+void
+GstVideoReceiver::_onNewRtpSourcePad(GstElement* element, GstPad* pad, gpointer data)
+{
+    Q_UNUSED(element)
+
+    if (GST_PAD_IS_SRC(pad)) {
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, _sourceLatencyProbe, data, nullptr);
+    }
+}
+
+GstPadProbeReturn
+GstVideoReceiver::_restreamIdleProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    Q_UNUSED(pad)
+    Q_UNUSED(info)
+
+    GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
+
+    // Right away from stopRestream if the branch was idle already
+    if (!pThis->_needDispatch()) {
+        pThis->_shutdownRestreamBranch();
+        return GST_PAD_PROBE_REMOVE;
+    }
+
+    // Otherwise on a streaming thread, which must not change the state of the branch it is in
+    pThis->_slotHandler->dispatch([pThis]() {
+        if (pThis->_pipeline != nullptr && pThis->_restreamSink != nullptr) {
+            pThis->_shutdownRestreamBranch();
+        }
+    });
+
+    return GST_PAD_PROBE_REMOVE;
+}
+
+void
+GstVideoReceiver::_onRestreamClientAdded(GstElement* sink, GObject* socket, gpointer data)
+{
+    GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(data);
+
+    const int viewers = ++pThis->_restreamViewers;
+
+    if (pThis->_restreamMaxViewers > 0 && viewers > static_cast<int>(pThis->_restreamMaxViewers)) {
+        // Counted down again in client-removed
+        qCDebug(VideoReceiverLog) << "Restream viewer limit reached, dropping viewer" << pThis->_uri;
+        g_signal_emit_by_name(sink, "remove", socket);
+        return;
+    }
+
+    qCDebug(VideoReceiverLog) << "Restream viewer joined," << viewers << "viewers" << pThis->_uri;
+
+    pThis->_dispatchSignal([pThis, viewers](){
+        emit pThis->restreamViewersChanged(viewers);
+    });
+}
+
+void
+GstVideoReceiver::_onRestreamClientRemoved(GstElement* sink, GObject* socket, gint status, gpointer data)
+{
+    Q_UNUSED(sink)
+    Q_UNUSED(socket)
+    Q_UNUSED(status)
+
+    GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(data);
+
+    const int viewers = qMax(--pThis->_restreamViewers, 0);
+
+    pThis->_dispatchSignal([pThis, viewers](){
+        emit pThis->restreamViewersChanged(viewers);
+    });
+}
+
+GstPadProbeReturn
+GstVideoReceiver::_keyframeOnlyProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    Q_UNUSED(pad)
+
+    if (info == nullptr || user_data == nullptr) {
+        return GST_PAD_PROBE_OK;
+    }
+
+    GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
+
+    if (!pThis->_keyframeOnly.load() && !pThis->_waitKeyframe.load()) {
+        return GST_PAD_PROBE_OK;
+    }
+
+    GstBuffer* buf = gst_pad_probe_info_get_buffer(info);
+
+    if (buf == nullptr) {
+        return GST_PAD_PROBE_OK;
+    }
+
+    if (GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_DELTA_UNIT)) {
+        return GST_PAD_PROBE_DROP;
+    }
+
+    pThis->_waitKeyframe.store(0);
+
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn
+GstVideoReceiver::_preRecordBlockProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    Q_UNUSED(pad)
+    Q_UNUSED(info)
+    Q_UNUSED(user_data)
+
+    // Blocking probe, buffers pile up in the recorder queue until the probe is removed by _configurePreRecord
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn
+GstVideoReceiver::_telemetryProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data)
+{
+    if (info != nullptr && user_data != nullptr) {
+        GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(user_data);
+        GstBuffer* buf;
+
+        if ((buf = gst_pad_probe_info_get_buffer(info)) != nullptr) {
+            pThis->_pushTelemetry(pad, buf);
+        }
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+// Receivers share a few worker threads instead of one each, so many streams don't mean as many threads
+Worker*
+GstVideoReceiver::_acquireWorker(void)
+{
+    QMutexLocker lock(&_workerPoolSync);
+
+    const int maxWorkers = qBound(1, QThread::idealThreadCount() / 2, 4);
+
+    Worker* worker = nullptr;
+
+    if (_workerPool.count() < maxWorkers) {
+        worker = new Worker;
+        worker->start();
+        _workerPool[worker] = 0;
+    } else {
+        // Least used worker
+        int useCount = 0;
+
+        for (auto iter = _workerPool.constBegin(); iter != _workerPool.constEnd(); iter++) {
+            if (worker == nullptr || iter.value() < useCount) {
+                worker = iter.key();
+                useCount = iter.value();
+            }
+        }
+    }
+
+    _workerPool[worker]++;
+
+    return worker;
+}
+
+void
+GstVideoReceiver::_releaseWorker(Worker* worker)
+{
+    // Tasks for this receiver may still be queued
+    worker->flush();
+
+    QMutexLocker lock(&_workerPoolSync);
+
+    if (--_workerPool[worker] == 0) {
+        _workerPool.remove(worker);
+        lock.unlock();
+        worker->shutdown();
+        delete worker;
+    }
+}
+
+void
+GstVideoReceiver::_onDecoderElementAdded(GstBin* bin, GstBin* subBin, GstElement* element, gpointer data)
+{
+    Q_UNUSED(bin)
+    Q_UNUSED(subBin)
+
+    GstVideoReceiver* pThis = static_cast<GstVideoReceiver*>(data);
+    pThis->_noteDecoderElement(element);
+}
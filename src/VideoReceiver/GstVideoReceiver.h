@@ -20,10 +20,15 @@
 #include <QThread>
 #include <QWaitCondition>
 #include <QMutex>
+#include <QSemaphore>
+#include <QAtomicInteger>
 #include <QQueue>
 #include <QQuickItem>
+#include <QHash>
+#include <QElapsedTimer>
 
 #include "VideoReceiver.h"
+#include "QGCTrace.h"
 
 #include <gst/gst.h>
 
@@ -44,6 +49,17 @@ public:
         _taskQueueUpdate.wakeOne();
     }
 
+    // Waits for all tasks dispatched so far to complete
+    void flush() {
+        if (needDispatch()) {
+            QSemaphore done;
+            dispatch([&done](){
+                done.release();
+            });
+            done.acquire();
+        }
+    }
+
     void shutdown() {
         if (needDispatch()) {
             dispatch([this](){
@@ -57,6 +73,7 @@ public:
 
 protected:
     void run() {
+        QGCTrace::setThreadName(QStringLiteral("Video Worker"));
         while(!_shutdown) {
             _taskQueueSync.lock();
 
@@ -68,6 +85,7 @@ protected:
 
             _taskQueueSync.unlock();
 
+            QGC_TRACE_SCOPE("Video", "workerTask");
             t();
         }
     }
@@ -88,6 +106,8 @@ public:
     explicit GstVideoReceiver(QObject* parent = nullptr);
     ~GstVideoReceiver(void);
 
+    virtual void setTelemetry(const Telemetry& telemetry);
+
 public slots:
     virtual void start(const QString& uri, unsigned timeout, int buffer = 0);
     virtual void stop(void);
@@ -96,15 +116,41 @@ public slots:
     virtual void startRecording(const QString& videoFile, FILE_FORMAT format);
     virtual void stopRecording(void);
     virtual void takeScreenshot(const QString& imageFile);
+    virtual void startRestream(unsigned port, unsigned maxViewers);
+    virtual void stopRestream(void);
+    virtual void setKeyframeOnly(bool keyframeOnly);
+    virtual void setPreRecordDuration(unsigned seconds);
+    virtual void setRecordingSegmentDuration(unsigned seconds);
+    virtual void setRecordTelemetryTrack(bool enable);
+    virtual void setAdaptiveLatency(bool enable);
+    virtual void setLatencyPreference(unsigned percent);
+    virtual void seek(qint64 positionUSecs, double rate, bool keyframe);
+    virtual void setThermalProcessing(const ThermalProcessing& processing);
 
 protected slots:
     virtual void _watchdog(void);
     virtual void _handleEOS(void);
 
 protected:
+    typedef enum {
+        LatencyStageSource = 0,     ///< Source element src pad
+        LatencyStageJitterBuffer,   ///< rtpjitterbuffer src pad
+        LatencyStageParser,         ///< _tee sink pad
+        LatencyStageDecoder,        ///< _videoSink sink pad
+        LatencyStageCount
+    } LatencyStage_t;
+
     virtual GstElement* _makeSource(const QString& uri);
     virtual GstElement* _makeDecoder(GstCaps* caps = nullptr, GstElement* videoSink = nullptr);
     virtual GstElement* _makeFileSink(const QString& videoFile, FILE_FORMAT format);
+    virtual GstElement* _makeSegmentedFileSink(const QString& videoFile, FILE_FORMAT format);
+    virtual GstElement* _makeRestreamSink(GstCaps* caps, unsigned port);
+    virtual void _noteRecordingSegment(const GstStructure* s);
+    virtual void _noteThermalStats(const GstStructure* s);
+    virtual void _configureThermalFilter(void);
+    virtual void _addTelemetryTrack(GstElement* bin, GstElement* mux);
+    virtual void _pushTelemetry(GstPad* pad, GstBuffer* videoBuffer);
+    virtual QImage _sampleToImage(GstSample* sample);
 
     virtual void _onNewSourcePad(GstPad* pad);
     virtual void _onNewDecoderPad(GstPad* pad);
@@ -113,9 +159,24 @@ protected:
     virtual void _noteTeeFrame(void);
     virtual void _noteVideoSinkFrame(void);
     virtual void _noteEndOfStream(void);
+    virtual void _noteStageLatency(LatencyStage_t stage, GstPad* pad, GstBuffer* buffer);
+    virtual void _noteRtpPacket(GstBuffer* buffer);
+    virtual void _noteQos(GstMessage* message);
+    virtual void _noteDecoderElement(GstElement* element);
+    virtual void _noteVideoSinkCaps(GstPad* pad);
+    virtual void _reportLatency(void);
+    virtual void _adaptLatency(const LatencyStats& stats);
+    virtual void _setJitterBufferLatency(guint msecs, bool dropOnLatency);
+    void _resetLatencyStats(void);
+    void _getSrtStats(LatencyStats& stats);
+    GstClockTime _runningTime(void);
     virtual bool _unlinkBranch(GstElement* from);
     virtual void _shutdownDecodingBranch (void);
     virtual void _shutdownRecordingBranch(void);
+    virtual void _shutdownRestreamBranch(void);
+    virtual void _configurePreRecord(void);
+    virtual bool _restartSource(void);
+    virtual void _linkSource(void);
 
     bool _needDispatch(void);
     void _dispatchSignal(std::function<void()> emitter);
@@ -129,6 +190,22 @@ protected:
     static GstPadProbeReturn _videoSinkProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
     static GstPadProbeReturn _eosProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
     static GstPadProbeReturn _keyframeWatch(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn _keyframeOnlyProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn _restreamIdleProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static void _onRestreamClientAdded(GstElement* sink, GObject* socket, gpointer data);
+    static void _onRestreamClientRemoved(GstElement* sink, GObject* socket, gint status, gpointer data);
+    static GstPadProbeReturn _preRecordBlockProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn _telemetryProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn _sourceLatencyProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static GstPadProbeReturn _jitterBufferLatencyProbe(GstPad* pad, GstPadProbeInfo* info, gpointer user_data);
+    static void _onNewRtpManager(GstElement* element, GstElement* manager, gpointer data);
+
+    /// Jitter buffer latency for the measured RTP jitter, clamped to the range allowed by the preference
+    static guint _adaptiveLatencyMsecs(double jitterMsecs, unsigned preference);
+    static guint _adaptiveLatencyFloorMsecs(unsigned preference)   { return 10 + 90 * qMin(preference, 100u) / 100; }
+    static guint _adaptiveLatencyCeilingMsecs(unsigned preference) { return 150 + 850 * qMin(preference, 100u) / 100; }
+    static void _onNewRtpSourcePad(GstElement* element, GstPad* pad, gpointer data);
+    static void _onDecoderElementAdded(GstBin* bin, GstBin* subBin, GstElement* element, gpointer data);
 
     bool                _streaming;
     bool                _decoding;
@@ -137,11 +214,18 @@ protected:
     bool                _removingRecorder;
     GstElement*         _source;
     GstElement*         _tee;
+    GstElement*         _decoderQueue;
     GstElement*         _decoderValve;
+    GstElement*         _recorderQueue;
     GstElement*         _recorderValve;
     GstElement*         _decoder;
     GstElement*         _videoSink;
     GstElement*         _fileSink;
+    GstElement*         _restreamQueue;
+    GstElement*         _restreamValve;
+    GstElement*         _restreamSink;                          ///< Bin serving remote viewers, see _makeRestreamSink
+    unsigned            _restreamMaxViewers;                    ///< 0 for no limit
+    QAtomicInteger<int> _restreamViewers;                       ///< Counted from the tcpserversink signals
     GstElement*         _pipeline;
 
     qint64              _lastSourceFrameTime;
@@ -158,12 +242,86 @@ protected:
     unsigned            _timeout;
     int                 _buffer;
 
-    Worker              _slotHandler;
+    Worker*             _slotHandler;                           ///< Shared with other receivers, see _acquireWorker
     uint32_t            _signalDepth;
 
     bool                _endOfStream;
+    bool                _replay;                                ///< Source is a file, which is moved through with seek
+
+    // Warm restart, see _restartSource
+    QAtomicInteger<int> _stopping;                              ///< stop() in progress, its EOS must go through
+    QAtomicInteger<int> _sourceRestarts;                        ///< Restarts since the last source frame
+    QAtomicInteger<int> _sourceRecovering;                      ///< Waiting for the first decoded frame after a restart
+    QElapsedTimer       _sourceRestartTimer;
+
+    QAtomicInteger<int> _keyframeOnly;
+    QAtomicInteger<int> _waitKeyframe;                          ///< Drop delta frames until the next key frame
+
+    unsigned            _preRecordSecs;
+    gulong              _preRecordProbeId;                      ///< Holds back the recorder queue while not recording
+
+    unsigned            _recordingSegmentSecs;
+    QString             _recordingSegmentFile;                  ///< File splitmuxsink is currently writing
+
+    ThermalProcessing   _thermal;                               ///< Applied to the qgcthermalfilter of the video sink bin
+
+    bool                _recordTelemetryTrack;
+    QMutex              _telemetrySync;
+    Telemetry           _telemetry;                             ///< Latest setTelemetry
+    GstElement*         _telemetrySrc;                          ///< appsrc feeding the telemetry track of _fileSink
+
+    QMutex              _decoderSync;
+    QString             _decoderName;                           ///< Video decoder picked by decodebin3
+    bool                _decoderHardware;
+
+    // Latency instrumentation, written from the streaming threads and reported from _watchdog
+    QMutex              _latencySync;
+    GstElement*         _jitterBuffer;                          ///< Owned by the source bin
+    GstElement*         _srtSource;                             ///< srtsrc, owned by the source bin
+    GstCaps*            _ntpTimestampCaps;
+    GstClockTime        _pipelineLatency;
+    qint64              _stageAgeSum[LatencyStageCount];        ///< nsecs since arrival at the output of each stage
+    int                 _stageAgeCount[LatencyStageCount];
+    qint64              _sinkWaitSum;
+    int                 _sinkWaitCount;
+    qint64              _frameAgeSum;
+    int                 _frameAgeCount;
+    bool                _rtpPacketSeen;
+    quint16             _rtpLastSeq;
+    quint32             _rtpLastTimestamp;
+    GstClockTime        _rtpLastArrival;
+    double              _rtpJitterNsecs;
+    quint64             _rtpPacketsLost;
+    QHash<const void*, quint64> _qosDropped;                   ///< Key: element posting QoS, Value: dropped count
+    QElapsedTimer       _latencyReportTimer;
+
+    // Adaptive jitter buffer, tuned from _reportLatency
+    bool                _adaptiveLatency;
+    unsigned            _latencyPreference;
+    GstElement*         _rtpManager;                            ///< rtpbin of rtspsrc, owned by rtspsrc, under _latencySync
+    guint               _latencyMsecs;                          ///< Latency last set by _setJitterBufferLatency, 0 for none
+    quint64             _adaptLastLost;
+    quint64             _adaptLastLate;
+
+    static Worker*      _acquireWorker(void);
+    static void         _releaseWorker(Worker* worker);
+
+    static QMutex               _workerPoolSync;
+    static QHash<Worker*, int>  _workerPool;                   ///< Value: Number of receivers using the worker
 
     static const char*  _kFileMux[FILE_FORMAT_MAX - FILE_FORMAT_MIN];
+    static const int    _kRtpClockRate      = 90000;            ///< Video RTP clock rate
+    static const guint  _kPreRecordMaxBytes = 64 * 1024 * 1024; ///< Upper bound of the pre-record buffer whatever the bitrate
+    static const guint  _kFragmentMsecs     = 1000;             ///< MP4/MOV fragment duration within a segment
+    static const qint64 _kNtpUnixOffsetMsecs = 2208988800000LL; ///< 1900-01-01 to 1970-01-01
+    static const guint  _kRtspLatencyMsecs  = 17;               ///< rtspsrc latency without adaptive latency
+    static const guint  _kSrtLatencyMsecs   = 120;              ///< srtsrc latency unless the uri has one, room for about 3 retransmissions at 40 msecs RTT
+    static const guint  _kFeedMaxBytes      = 4 * 1024 * 1024;  ///< Data a stream feed's appsrc holds while downstream is busy
+    static const guint  _kLatencyStepMsecs  = 5;                ///< Smaller changes are not applied, each one resyncs the pipeline latency
+    static const int    _kMaxSourceRestarts = 3;                ///< Without frames in between, then the whole pipeline is restarted
+    static const int    _kTrickModeRate     = 4;                ///< Replay rate from which only key frames are decoded
+    static const guint  _kRestreamQueueMsecs = 2000;            ///< Data a viewer may fall behind before it skips to the next key frame
+    static const guint  _kRestreamTimeoutSecs = 10;             ///< Viewers which take no data for this long are dropped
 };
 
 void* createVideoSink(void* widget);
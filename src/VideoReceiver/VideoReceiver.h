@@ -17,6 +17,9 @@
 
 #include <QObject>
 #include <QSize>
+#include <QImage>
+#include <QPointF>
+#include <QRectF>
 
 class VideoReceiver : public QObject
 {
@@ -47,13 +50,94 @@ public:
 
     Q_ENUM(STATUS)
 
+    /// Latency of the receive pipeline, each value is the average over the last reporting interval (one second).
+    /// Stage latencies are measured from the arrival of a buffer at the source to the output of that stage.
+    struct LatencyStats {
+        double  sourceMsecs         = 0;    ///< Source element, includes the rtspsrc internal jitter buffer
+        double  jitterBufferMsecs   = 0;    ///< rtpjitterbuffer
+        double  parserMsecs         = 0;    ///< Depayload/parse
+        double  decoderMsecs        = 0;    ///< Decode up to the video sink input
+        double  sinkMsecs           = 0;    ///< Wait in the video sink until render time
+        double  totalMsecs          = -1;   ///< Arrival to render, -1 if no frames were rendered
+        double  frameAgeMsecs       = -1;   ///< Sender capture to render from NTP timestamps, -1 if the sender does not provide them
+        double  jitterMsecs         = -1;   ///< RTP interarrival jitter (RFC 3550), -1 if the stream is not RTP
+        double  roundTripMsecs      = -1;   ///< SRT round trip time, -1 if the source is not SRT
+        double  framesPerSecond     = 0;    ///< Frames arriving at the video sink
+        quint64 packetsLost         = 0;    ///< RTP sequence gaps since start, for SRT packets it had to request again
+        quint64 packetsLate         = 0;    ///< RTP packets which arrived after the jitter buffer gave up on them, SRT packets not recovered in time
+        quint64 framesDropped       = 0;    ///< Frames dropped by the decoder/sink (QoS)
+    };
+
+    /// Vehicle state written to the telemetry track of recordings, one sample per video frame
+    struct Telemetry {
+        bool    valid           = false;
+        qint64  timeMsecs       = 0;    ///< Time of the last update, msecs since epoch
+        double  latitude        = 0;
+        double  longitude       = 0;
+        double  altitudeAMSL    = 0;    ///< m
+        double  roll            = 0;    ///< deg
+        double  pitch           = 0;    ///< deg
+        double  heading         = 0;    ///< deg
+    };
+
+    typedef enum {
+        THERMAL_PALETTE_NONE = 0,       ///< Frames as sent, raw radiometric frames white hot
+        THERMAL_PALETTE_WHITE_HOT,
+        THERMAL_PALETTE_BLACK_HOT,
+        THERMAL_PALETTE_IRONBOW,
+        THERMAL_PALETTE_RAINBOW,
+    } THERMAL_PALETTE;
+
+    /// Palette, isotherm and measurements of a thermal stream, done in shaders on the GPU. Values are raw counts
+    /// (0..65535) of radiometric GRAY16_LE frames, for other frames their luminance scaled to the same range.
+    struct ThermalProcessing {
+        bool            enabled         = false;    ///< Applies from the next startDecoding, the filter stays in the sink
+        THERMAL_PALETTE palette         = THERMAL_PALETTE_NONE;
+        bool            autoRange       = true;     ///< Spread the palette over the measured frame minimum..maximum
+        quint16         rangeLow        = 0;        ///< Palette ends without autoRange
+        quint16         rangeHigh       = 65535;
+        quint16         isothermLow     = 0;        ///< Values painted in the isotherm color, none unless isothermHigh > isothermLow
+        quint16         isothermHigh    = 0;
+        QPointF         spot            = QPointF(-1, -1);  ///< Measured point, 0..1 of the frame, negative for none
+        QRectF          area;                       ///< Measured area, 0..1 of the frame, empty for none
+    };
+
+    struct ThermalStats {
+        bool    radiometric     = false;    ///< Values are raw counts of a GRAY16_LE stream
+        quint16 frameMin        = 0;
+        quint16 frameMax        = 0;
+        bool    hasSpot         = false;
+        quint16 spot            = 0;
+        bool    hasArea         = false;
+        quint16 areaMin         = 0;
+        quint16 areaMax         = 0;
+        quint16 areaMean        = 0;
+    };
+
+    // Thread safe and does not block, call on every vehicle update
+    virtual void setTelemetry(const Telemetry& telemetry) { Q_UNUSED(telemetry) }
+
 signals:
     void timeout(void);
     void streamingChanged(bool active);
     void decodingChanged(bool active);
     void recordingChanged(bool active);
     void recordingStarted(void);
+    // Segmented recording started writing a new file
+    void recordingSegmentStarted(QString segmentFile);
+    // Last decoded frame for takeScreenshot, encoding and writing imageFile is left to the slot
+    void screenshotTaken(QString imageFile, QImage image);
     void videoSizeChanged(QSize size);
+    // Source was replaced after a timeout or end of stream while decoding and recording carried on, msecs from the
+    // restart to the first decoded frame
+    void streamRecovered(qint64 msecs);
+    void latencyStatsChanged(VideoReceiver::LatencyStats stats);
+    // memory: Caps memory feature of the frames reaching the video sink (GLMemory, DMABuf, GLTextureUploadMeta, SystemMemory)
+    void videoDecoderChanged(QString decoder, bool hardware, QString memory);
+    // Measurements of the thermal processing, a few times a second
+    void thermalStatsChanged(VideoReceiver::ThermalStats stats);
+    void restreamingChanged(bool active);
+    void restreamViewersChanged(int viewers);
 
     void onStartComplete(STATUS status);
     void onStopComplete(STATUS status);
@@ -62,6 +146,7 @@ signals:
     void onStartRecordingComplete(STATUS status);
     void onStopRecordingComplete(STATUS status);
     void onTakeScreenshotComplete(STATUS status);
+    void onStartRestreamComplete(STATUS status);
 
 public slots:
     // buffer:
@@ -75,4 +160,28 @@ public slots:
     virtual void startRecording(const QString& videoFile, FILE_FORMAT format) = 0;
     virtual void stopRecording(void) = 0;
     virtual void takeScreenshot(const QString& imageFile) = 0;
+    // Only decode key frames, used to lower the decode cost of streams which are not in focus
+    virtual void setKeyframeOnly(bool keyframeOnly) { Q_UNUSED(keyframeOnly) }
+    // Keep the last seconds of the stream so that a recording starts that far back, 0 to disable
+    virtual void setPreRecordDuration(unsigned seconds) { Q_UNUSED(seconds) }
+    // Split recordings into files of this length, applies from the next startRecording, 0 for a single file
+    virtual void setRecordingSegmentDuration(unsigned seconds) { Q_UNUSED(seconds) }
+    // Add a timed metadata track with the setTelemetry samples, applies from the next startRecording
+    virtual void setRecordTelemetryTrack(bool enable) { Q_UNUSED(enable) }
+    // Retune the RTP jitter buffer from the measured jitter and packet loss, applies from the next start
+    virtual void setAdaptiveLatency(bool enable) { Q_UNUSED(enable) }
+    // Adaptive latency trade-off, 0: lowest latency, drop late packets .. 100: smoothest playback
+    virtual void setLatencyPreference(unsigned percent) { Q_UNUSED(percent) }
+    // Replay of a file:// uri, moves to the presentation time and plays on at rate, 0 to stay paused there.
+    // keyframe: Go to the key frame before the position without decoding up to it, for scrubbing
+    virtual void seek(qint64 positionUSecs, double rate, bool keyframe) { Q_UNUSED(positionUSecs) Q_UNUSED(rate) Q_UNUSED(keyframe) }
+    // Palette, isotherm and measurement of thermal frames, takes effect on the next frame once enabled
+    virtual void setThermalProcessing(const ThermalProcessing& processing) { Q_UNUSED(processing) }
+    // Serve the received stream as is (h.264/h.265 in MPEG-TS over TCP) to up to maxViewers remote viewers, 0 for no
+    // limit. Needs the stream to be received already, stops with the stream.
+    virtual void startRestream(unsigned port, unsigned maxViewers) { Q_UNUSED(port) Q_UNUSED(maxViewers) }
+    virtual void stopRestream(void) {}
 };
+
+Q_DECLARE_METATYPE(VideoReceiver::LatencyStats)
+Q_DECLARE_METATYPE(VideoReceiver::ThermalStats)
@@ -78,6 +78,7 @@ LinuxBuild {
         LIBS += -L$$GST_ROOT/lib/gstreamer-1.0 \
             -lgstvideo-1.0 \
             -lgstcoreelements \
+            -lgstapp \
             -lgstplayback \
             -lgstudp \
             -lgstrtp \
@@ -89,6 +90,7 @@ LinuxBuild {
             -lgstrtpmanager \
             -lgstisomp4 \
             -lgstmatroska \
+            -lgstmultifile \
             -lgstmpegtsdemux \
             -lgstandroidmedia \
             -lgstopengl \
@@ -133,13 +135,16 @@ VideoEnabled {
     HEADERS += \
         $$PWD/GStreamer.h \
         $$PWD/GstVideoReceiver.h \
-        $$PWD/VideoReceiver.h
+        $$PWD/VideoReceiver.h \
+        $$PWD/VideoStreamFeed.h
 
     SOURCES += \
+        $$PWD/gstqgcthermalfilter.c \
         $$PWD/gstqgcvideosinkbin.c \
         $$PWD/gstqgc.c \
         $$PWD/GStreamer.cc \
-        $$PWD/GstVideoReceiver.cc
+        $$PWD/GstVideoReceiver.cc \
+        $$PWD/VideoStreamFeed.cc
 
     include($$PWD/../../qmlglsink.pri)
 } else {
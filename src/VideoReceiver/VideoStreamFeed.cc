@@ -0,0 +1,57 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VideoStreamFeed.h"
+
+#include <QHash>
+
+const char* VideoStreamFeed::taisyncFeed = "tsusb";
+
+VideoStreamFeed*
+VideoStreamFeed::feed(const QString& name)
+{
+    static QMutex                           feedsSync;
+    static QHash<QString, VideoStreamFeed*> feeds;
+
+    QMutexLocker lock(&feedsSync);
+    VideoStreamFeed* feed = feeds.value(name, nullptr);
+    if (feed == nullptr) {
+        feed = new VideoStreamFeed;
+        feeds.insert(name, feed);
+    }
+    return feed;
+}
+
+void
+VideoStreamFeed::setConsumer(Consumer_t consumer)
+{
+    // Destroyed after the lock is released, what it holds may take the lock of its own
+    Consumer_t old;
+    {
+        QMutexLocker lock(&_consumerSync);
+        old.swap(_consumer);
+        _consumer = consumer;
+    }
+}
+
+bool
+VideoStreamFeed::hasConsumer(void)
+{
+    QMutexLocker lock(&_consumerSync);
+    return static_cast<bool>(_consumer);
+}
+
+void
+VideoStreamFeed::write(const char* data, int length)
+{
+    QMutexLocker lock(&_consumerSync);
+    if (_consumer) {
+        _consumer(data, length);
+    }
+}
@@ -0,0 +1,40 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QMutex>
+#include <QString>
+
+#include <functional>
+
+/// Video byte stream handed straight from a radio bridge to the video receiver, for streams GStreamer can't open by
+/// itself. The bridge writes from its I/O thread, the consumer runs on that same thread. Without a consumer the data
+/// is dropped.
+class VideoStreamFeed
+{
+public:
+    typedef std::function<void(const char* data, int length)> Consumer_t;
+
+    /// @return Feed of that name, created on first use and kept for the lifetime of the process
+    static VideoStreamFeed* feed(const QString& name);
+
+    /// @param consumer Empty to remove it. Returns once a write still running into the old one is done.
+    void setConsumer    (Consumer_t consumer);
+    bool hasConsumer    (void);
+    void write          (const char* data, int length);
+
+    static const char* taisyncFeed;
+
+private:
+    VideoStreamFeed() = default;
+
+    QMutex      _consumerSync;
+    Consumer_t  _consumer;
+};
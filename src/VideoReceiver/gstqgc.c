@@ -17,6 +17,7 @@
 #include <gst/gst.h>
 
 gboolean gst_qgc_video_sink_bin_plugin_init(GstPlugin *plugin);
+gboolean gst_qgc_thermal_filter_plugin_init(GstPlugin *plugin);
 
 static gboolean
 plugin_init(GstPlugin* plugin)
@@ -25,6 +26,10 @@ plugin_init(GstPlugin* plugin)
         return FALSE;
     }
 
+    if (!gst_qgc_thermal_filter_plugin_init(plugin)) {
+        return FALSE;
+    }
+
     return TRUE;
 }
 
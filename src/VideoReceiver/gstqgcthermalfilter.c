@@ -0,0 +1,899 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+/**
+ * @file
+ *   @brief GStreamer GL filter for thermal streams
+ *
+ * Maps thermal frames through a color palette, paints isotherms and measures spot/area values, all in shaders on
+ * the GL textures qmlglsink renders. Raw radiometric frames (GRAY16_LE, e.g. Y16 from a radiometric camera) are
+ * uploaded by glupload as two 8 bit channels, the shaders put the full 16 bit counts back together. Other frames
+ * arrive as RGBA from glcolorconvert and are measured by their luminance, scaled to 0..65535.
+ *
+ * Measurements are reduced on the GPU in passes of 4x4 blocks down to a single texel, only those two pixels are read
+ * back. They are posted as "qgc-thermal-stats" element messages every stats-interval:
+ *      radiometric     boolean     Values are raw counts of a GRAY16_LE stream
+ *      frame-min       uint        Whole frame, also used for auto-range
+ *      frame-max       uint
+ *      area-min        uint        Only with an area set
+ *      area-max        uint
+ *      area-mean       uint
+ *      spot            uint        Only with a spot set
+ */
+
+#include <gst/gst.h>
+#include <gst/gl/gl.h>
+
+GST_DEBUG_CATEGORY_STATIC(gst_qgc_thermal_filter_debug);
+#define GST_CAT_DEFAULT gst_qgc_thermal_filter_debug
+
+typedef enum {
+    PALETTE_NONE = 0,
+    PALETTE_WHITE_HOT,
+    PALETTE_BLACK_HOT,
+    PALETTE_IRONBOW,
+    PALETTE_RAINBOW,
+} GstQgcThermalPalette;
+
+// How the shaders read a value from the input texture
+typedef enum {
+    INPUT_LUMINANCE_ALPHA = 0,  ///< GRAY16_LE, low byte in luminance, high byte in alpha (GLES2)
+    INPUT_RG,                   ///< GRAY16_LE, low byte in red, high byte in green
+    INPUT_RGBA,                 ///< Luminance of RGBA
+    INPUT_STATS,                ///< Previous reduction pass
+} GstQgcThermalInput;
+
+typedef struct _GstQgcThermalFilter {
+    GstGLFilter filter;
+
+    // GL thread
+    GstGLShader*    shader;
+    GstGLShader*    statsShader;
+    GLuint          paletteTex;
+    GLuint          statsTex[2];        ///< Reduction passes alternate between the two
+    GLuint          statsFbo;
+    gboolean        radiometric;
+    gint64          lastStats;
+    gboolean        haveFrameStats;
+    guint           frameMin;
+    guint           frameMax;
+
+    // Properties, GST_OBJECT_LOCK
+    gint            palette;
+    gboolean        paletteDirty;
+    gboolean        autoRange;
+    guint           rangeLow;
+    guint           rangeHigh;
+    guint           isothermLow;
+    guint           isothermHigh;
+    guint           isothermColor;
+    gdouble         spotX;
+    gdouble         spotY;
+    gdouble         areaX;
+    gdouble         areaY;
+    gdouble         areaWidth;
+    gdouble         areaHeight;
+    guint           statsInterval;
+} GstQgcThermalFilter;
+
+typedef struct _GstQgcThermalFilterClass {
+    GstGLFilterClass parent_class;
+} GstQgcThermalFilterClass;
+
+#define GST_TYPE_QGC_THERMAL_FILTER (gst_qgc_thermal_filter_get_type())
+#define GST_QGC_THERMAL_FILTER(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_QGC_THERMAL_FILTER, GstQgcThermalFilter))
+#define GST_TYPE_QGC_THERMAL_PALETTE (_tf_palette_get_type())
+
+enum {
+    PROP_0,
+    PROP_PALETTE,
+    PROP_AUTO_RANGE,
+    PROP_RANGE_LOW,
+    PROP_RANGE_HIGH,
+    PROP_ISOTHERM_LOW,
+    PROP_ISOTHERM_HIGH,
+    PROP_ISOTHERM_COLOR,
+    PROP_SPOT_X,
+    PROP_SPOT_Y,
+    PROP_AREA_X,
+    PROP_AREA_Y,
+    PROP_AREA_WIDTH,
+    PROP_AREA_HEIGHT,
+    PROP_STATS_INTERVAL,
+};
+
+#define DEFAULT_PALETTE         PALETTE_NONE
+#define DEFAULT_AUTO_RANGE      TRUE
+#define DEFAULT_RANGE_LOW       0
+#define DEFAULT_RANGE_HIGH      65535
+#define DEFAULT_ISOTHERM_COLOR  0xffff0000
+#define DEFAULT_STATS_INTERVAL  250
+
+#define PALETTE_SIZE 256
+
+G_DEFINE_TYPE(GstQgcThermalFilter, gst_qgc_thermal_filter, GST_TYPE_GL_FILTER)
+
+#define _TF_CAPS(formats) \
+    "video/x-raw(" GST_CAPS_FEATURE_MEMORY_GL_MEMORY "), format = (string) " formats ", " \
+    "width = " GST_VIDEO_SIZE_RANGE ", height = " GST_VIDEO_SIZE_RANGE ", framerate = " GST_VIDEO_FPS_RANGE ", " \
+    "texture-target = (string) 2D"
+
+static GstStaticPadTemplate _tf_sink_template = GST_STATIC_PAD_TEMPLATE("sink", GST_PAD_SINK, GST_PAD_ALWAYS,
+    GST_STATIC_CAPS(_TF_CAPS("{ GRAY16_LE, RGBA }")));
+
+static GstStaticPadTemplate _tf_src_template = GST_STATIC_PAD_TEMPLATE("src", GST_PAD_SRC, GST_PAD_ALWAYS,
+    GST_STATIC_CAPS(_TF_CAPS("RGBA")));
+
+// Shared by both shaders: 16 bit values are kept as floats 0..65535, which highp represents exactly
+#define _TF_SHADER_COMMON \
+    "#ifdef GL_ES\n" \
+    "#ifdef GL_FRAGMENT_PRECISION_HIGH\n" \
+    "precision highp float;\n" \
+    "#else\n" \
+    "precision mediump float;\n" \
+    "#endif\n" \
+    "#endif\n" \
+    "varying vec2 v_texcoord;\n" \
+    "uniform sampler2D tex;\n" \
+    "uniform int mode;\n" \
+    "float decode16(vec2 lohi) {\n" \
+    "    return floor(lohi.x * 255.0 + 0.5) + floor(lohi.y * 255.0 + 0.5) * 256.0;\n" \
+    "}\n" \
+    "float value(vec4 c) {\n" \
+    "    if (mode == 0) return decode16(c.ra);\n" \
+    "    if (mode == 1) return decode16(c.rg);\n" \
+    "    return floor(dot(c.rgb, vec3(0.299, 0.587, 0.114)) * 65535.0 + 0.5);\n" \
+    "}\n"
+
+static const gchar* _tf_fragment =
+    _TF_SHADER_COMMON
+    "uniform sampler2D palette;\n"
+    "uniform int showInput;\n"
+    "uniform float low;\n"
+    "uniform float high;\n"
+    "uniform float isothermLow;\n"
+    "uniform float isothermHigh;\n"
+    "uniform vec4 isothermColor;\n"
+    "void main() {\n"
+    "    vec4 c = texture2D(tex, v_texcoord);\n"
+    "    float v = value(c);\n"
+    "    float t = clamp((v - low) / max(high - low, 1.0), 0.0, 1.0);\n"
+    "    vec4 color = showInput == 1 ? c : texture2D(palette, vec2((t * 255.0 + 0.5) / 256.0, 0.5));\n"
+    "    if (v >= isothermLow && v <= isothermHigh) color = isothermColor;\n"
+    "    gl_FragColor = vec4(color.rgb, 1.0);\n"
+    "}\n";
+
+// One reduction pass. Each output texel covers a 4x4 block of the input region, blocks are clamped to the region so
+// edge blocks repeat texels, which doesn't change min/max and only slightly weights the mean. The first 'blocks'
+// columns of the output hold min (rg) and max (ba), the same number of columns after them the mean (rg).
+static const gchar* _tf_stats_fragment =
+    _TF_SHADER_COMMON
+    "uniform vec2 texSize;\n"
+    "uniform vec2 origin;\n"
+    "uniform vec2 size;\n"
+    "uniform float blocks;\n"
+    "uniform float meanOffset;\n"
+    "vec2 encode16(float v) {\n"
+    "    float hi = floor(v / 256.0);\n"
+    "    return vec2(v - hi * 256.0, hi) / 255.0;\n"
+    "}\n"
+    "vec4 texel(vec2 p) {\n"
+    "    return texture2D(tex, (p + 0.5) / texSize);\n"
+    "}\n"
+    "void main() {\n"
+    "    vec2 pos = floor(gl_FragCoord.xy);\n"
+    "    bool meanColumn = pos.x >= blocks;\n"
+    "    vec2 block = vec2(meanColumn ? pos.x - blocks : pos.x, pos.y) * 4.0;\n"
+    "    float lo = 65535.0;\n"
+    "    float hi = 0.0;\n"
+    "    float sum = 0.0;\n"
+    "    for (int j = 0; j < 4; j++) {\n"
+    "        for (int i = 0; i < 4; i++) {\n"
+    "            vec2 p = origin + min(block + vec2(float(i), float(j)), size - 1.0);\n"
+    "            vec4 c = texel(p);\n"
+    "            if (mode == 3) {\n"
+    "                lo = min(lo, decode16(c.rg));\n"
+    "                hi = max(hi, decode16(c.ba));\n"
+    "                sum += decode16(texel(p + vec2(meanOffset, 0.0)).rg);\n"
+    "            } else {\n"
+    "                float v = value(c);\n"
+    "                lo = min(lo, v);\n"
+    "                hi = max(hi, v);\n"
+    "                sum += v;\n"
+    "            }\n"
+    "        }\n"
+    "    }\n"
+    "    gl_FragColor = meanColumn ? vec4(encode16(floor(sum / 16.0 + 0.5)), 0.0, 1.0) : vec4(encode16(lo), encode16(hi));\n"
+    "}\n";
+
+typedef struct {
+    gfloat  pos;
+    guint8  r, g, b;
+} PaletteStop_t;
+
+static const PaletteStop_t _tf_white_hot[] = {
+    { 0.00f,   0,   0,   0 },
+    { 1.00f, 255, 255, 255 },
+};
+
+static const PaletteStop_t _tf_black_hot[] = {
+    { 0.00f, 255, 255, 255 },
+    { 1.00f,   0,   0,   0 },
+};
+
+static const PaletteStop_t _tf_ironbow[] = {
+    { 0.00f,   0,   0,   0 },
+    { 0.15f,  30,   0,  90 },
+    { 0.35f, 150,   0, 150 },
+    { 0.55f, 230,  60,  40 },
+    { 0.75f, 250, 160,   0 },
+    { 0.90f, 255, 230,  60 },
+    { 1.00f, 255, 255, 255 },
+};
+
+static const PaletteStop_t _tf_rainbow[] = {
+    { 0.00f,   0,   0, 255 },
+    { 0.25f,   0, 255, 255 },
+    { 0.50f,   0, 255,   0 },
+    { 0.75f, 255, 255,   0 },
+    { 1.00f, 255,   0,   0 },
+};
+
+static GType
+_tf_palette_get_type(void)
+{
+    static GType _tf_palette_type = 0;
+
+    if (!_tf_palette_type) {
+        static const GEnumValue _tf_palettes[] = {
+            { PALETTE_NONE,         "Frames as they are, raw frames white hot", "none" },
+            { PALETTE_WHITE_HOT,    "White hot",                                "white-hot" },
+            { PALETTE_BLACK_HOT,    "Black hot",                                "black-hot" },
+            { PALETTE_IRONBOW,      "Ironbow",                                  "ironbow" },
+            { PALETTE_RAINBOW,      "Rainbow",                                  "rainbow" },
+            { 0, NULL, NULL },
+        };
+
+        _tf_palette_type = g_enum_register_static("GstQgcThermalPalette", _tf_palettes);
+    }
+
+    return _tf_palette_type;
+}
+
+// The shaders are GLSL ES 1.0 / GLSL 1.10, core profile contexts get them through these defines
+static const gchar* _tf_core_header =
+    "#define varying in\n"
+    "#define texture2D texture\n"
+    "out vec4 fragColor;\n"
+    "#define gl_FragColor fragColor\n";
+
+static GstGLShader*
+_tf_make_shader(GstGLContext* context, const gchar* fragment)
+{
+    const gboolean core = (gst_gl_context_get_gl_api(context) & GST_GL_API_OPENGL3) != 0;
+    const gchar* strings[] = { core ? _tf_core_header : "", fragment };
+    GError* error       = NULL;
+    GstGLShader* shader = gst_gl_shader_new(context);
+    GstGLSLStage* vert  = gst_glsl_stage_new_default_vertex(context);
+    GstGLSLStage* frag  = core ?
+        gst_glsl_stage_new_with_strings(context, GL_FRAGMENT_SHADER, GST_GLSL_VERSION_150, GST_GLSL_PROFILE_CORE, 2, strings) :
+        gst_glsl_stage_new_with_strings(context, GL_FRAGMENT_SHADER, GST_GLSL_VERSION_NONE,
+                                        (GstGLSLProfile)(GST_GLSL_PROFILE_ES | GST_GLSL_PROFILE_COMPATIBILITY), 2, strings);
+
+    // Both shaders draw the same quad, so they need the same attribute locations
+    if (!gst_gl_shader_compile_attach_stage(shader, vert, &error) ||
+            !gst_gl_shader_compile_attach_stage(shader, frag, &error)) {
+        GST_ERROR("Shader compile failed: %s", error != NULL ? error->message : "unknown");
+        g_clear_error(&error);
+        gst_object_unref(shader);
+        return NULL;
+    }
+
+    gst_gl_shader_bind_attribute_location(shader, 0, "a_position");
+    gst_gl_shader_bind_attribute_location(shader, 1, "a_texcoord");
+
+    if (!gst_gl_shader_link(shader, &error)) {
+        GST_ERROR("Shader link failed: %s", error != NULL ? error->message : "unknown");
+        g_clear_error(&error);
+        gst_object_unref(shader);
+        return NULL;
+    }
+
+    return shader;
+}
+
+static void
+_tf_set_nearest(const GstGLFuncs* gl)
+{
+    gl->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    gl->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    gl->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    gl->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+static void
+_tf_upload_palette(GstQgcThermalFilter* tf, gint palette)
+{
+    const GstGLFuncs* gl = GST_GL_BASE_FILTER(tf)->context->gl_vtable;
+    const PaletteStop_t* stops;
+    guint count;
+    guint8 lut[PALETTE_SIZE * 4];
+
+    switch (palette) {
+    case PALETTE_BLACK_HOT:
+        stops = _tf_black_hot;
+        count = G_N_ELEMENTS(_tf_black_hot);
+        break;
+    case PALETTE_IRONBOW:
+        stops = _tf_ironbow;
+        count = G_N_ELEMENTS(_tf_ironbow);
+        break;
+    case PALETTE_RAINBOW:
+        stops = _tf_rainbow;
+        count = G_N_ELEMENTS(_tf_rainbow);
+        break;
+    default:
+        stops = _tf_white_hot;
+        count = G_N_ELEMENTS(_tf_white_hot);
+        break;
+    }
+
+    for (guint i = 0, stop = 0; i < PALETTE_SIZE; i++) {
+        const gfloat t = (gfloat)i / (PALETTE_SIZE - 1);
+
+        while (stop < count - 2 && t > stops[stop + 1].pos) {
+            stop++;
+        }
+
+        const PaletteStop_t* a = &stops[stop];
+        const PaletteStop_t* b = &stops[stop + 1];
+        const gfloat f = CLAMP((t - a->pos) / (b->pos - a->pos), 0.0f, 1.0f);
+
+        lut[i * 4 + 0] = (guint8)(a->r + (b->r - a->r) * f + 0.5f);
+        lut[i * 4 + 1] = (guint8)(a->g + (b->g - a->g) * f + 0.5f);
+        lut[i * 4 + 2] = (guint8)(a->b + (b->b - a->b) * f + 0.5f);
+        lut[i * 4 + 3] = 255;
+    }
+
+    gl->BindTexture(GL_TEXTURE_2D, tf->paletteTex);
+    gl->TexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, PALETTE_SIZE, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, lut);
+}
+
+// Reduces a region of the input texture to its minimum, maximum and mean. Reading back the final two pixels waits
+// for the passes to finish, which is why it only runs every stats-interval.
+static gboolean
+_tf_measure(GstQgcThermalFilter* tf, GstGLMemory* in, GstQgcThermalInput input, gint x, gint y, gint width, gint height,
+            guint* min, guint* max, guint* mean)
+{
+    GstGLFilter* filter     = GST_GL_FILTER(tf);
+    const GstGLFuncs* gl    = GST_GL_BASE_FILTER(tf)->context->gl_vtable;
+    GLuint src              = gst_gl_memory_get_texture_id(in);
+    gint srcWidth           = gst_gl_memory_get_texture_width(in);
+    gint srcHeight          = gst_gl_memory_get_texture_height(in);
+    gint meanOffset         = 0;
+    guint pass              = 0;
+    guint8 pixels[8];
+
+    gst_gl_shader_use(tf->statsShader);
+    gst_gl_shader_set_uniform_1i(tf->statsShader, "tex", 0);
+
+    gl->BindFramebuffer(GL_FRAMEBUFFER, tf->statsFbo);
+    gl->Disable(GL_BLEND);
+
+    do {
+        const gint blocksX  = (width + 3) / 4;
+        const gint blocksY  = (height + 3) / 4;
+        const GLuint dst    = tf->statsTex[pass % 2];
+
+        gl->ActiveTexture(GL_TEXTURE0);
+        gl->BindTexture(GL_TEXTURE_2D, dst);
+        gl->TexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, blocksX * 2, blocksY, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        gl->FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dst, 0);
+
+        if (pass == 0 && gl->CheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            GST_WARNING_OBJECT(tf, "Stats framebuffer incomplete");
+            gl->BindFramebuffer(GL_FRAMEBUFFER, 0);
+            return FALSE;
+        }
+
+        gl->Viewport(0, 0, blocksX * 2, blocksY);
+        gl->BindTexture(GL_TEXTURE_2D, src);
+
+        gst_gl_shader_set_uniform_1i(tf->statsShader, "mode",       pass == 0 ? input : INPUT_STATS);
+        gst_gl_shader_set_uniform_2f(tf->statsShader, "texSize",    (gfloat)srcWidth, (gfloat)srcHeight);
+        gst_gl_shader_set_uniform_2f(tf->statsShader, "origin",     (gfloat)x, (gfloat)y);
+        gst_gl_shader_set_uniform_2f(tf->statsShader, "size",       (gfloat)width, (gfloat)height);
+        gst_gl_shader_set_uniform_1f(tf->statsShader, "blocks",     (gfloat)blocksX);
+        gst_gl_shader_set_uniform_1f(tf->statsShader, "meanOffset", (gfloat)meanOffset);
+
+        filter->draw_attr_position_loc  = 0;
+        filter->draw_attr_texture_loc   = 1;
+        gst_gl_filter_draw_fullscreen_quad(filter);
+
+        src         = dst;
+        srcWidth    = blocksX * 2;
+        srcHeight   = blocksY;
+        x           = 0;
+        y           = 0;
+        width       = blocksX;
+        height      = blocksY;
+        meanOffset  = blocksX;
+        pass++;
+    } while (width > 1 || height > 1);
+
+    gl->ReadPixels(0, 0, 2, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    gl->BindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    *min    = pixels[0] | (pixels[1] << 8);
+    *max    = pixels[2] | (pixels[3] << 8);
+    *mean   = pixels[4] | (pixels[5] << 8);
+
+    return TRUE;
+}
+
+static gboolean
+_tf_gl_start(GstGLBaseFilter* base)
+{
+    GstQgcThermalFilter* tf = GST_QGC_THERMAL_FILTER(base);
+    const GstGLFuncs* gl    = base->context->gl_vtable;
+
+    if (!GST_GL_BASE_FILTER_CLASS(gst_qgc_thermal_filter_parent_class)->gl_start(base)) {
+        return FALSE;
+    }
+
+    if ((tf->shader = _tf_make_shader(base->context, _tf_fragment)) == NULL) {
+        return FALSE;
+    }
+
+    if ((tf->statsShader = _tf_make_shader(base->context, _tf_stats_fragment)) == NULL) {
+        return FALSE;
+    }
+
+    gl->GenTextures(1, &tf->paletteTex);
+    gl->BindTexture(GL_TEXTURE_2D, tf->paletteTex);
+    _tf_set_nearest(gl);
+
+    gl->GenTextures(2, tf->statsTex);
+    for (guint i = 0; i < G_N_ELEMENTS(tf->statsTex); i++) {
+        gl->BindTexture(GL_TEXTURE_2D, tf->statsTex[i]);
+        _tf_set_nearest(gl);
+    }
+    gl->BindTexture(GL_TEXTURE_2D, 0);
+
+    gl->GenFramebuffers(1, &tf->statsFbo);
+
+    GST_OBJECT_LOCK(tf);
+    tf->paletteDirty = TRUE;
+    GST_OBJECT_UNLOCK(tf);
+
+    tf->haveFrameStats  = FALSE;
+    tf->lastStats       = 0;
+
+    return TRUE;
+}
+
+static void
+_tf_gl_stop(GstGLBaseFilter* base)
+{
+    GstQgcThermalFilter* tf = GST_QGC_THERMAL_FILTER(base);
+    const GstGLFuncs* gl    = base->context->gl_vtable;
+
+    if (tf->shader != NULL) {
+        gst_object_unref(tf->shader);
+        tf->shader = NULL;
+    }
+
+    if (tf->statsShader != NULL) {
+        gst_object_unref(tf->statsShader);
+        tf->statsShader = NULL;
+    }
+
+    if (tf->paletteTex != 0) {
+        gl->DeleteTextures(1, &tf->paletteTex);
+        tf->paletteTex = 0;
+    }
+
+    if (tf->statsTex[0] != 0) {
+        gl->DeleteTextures(2, tf->statsTex);
+        tf->statsTex[0] = tf->statsTex[1] = 0;
+    }
+
+    if (tf->statsFbo != 0) {
+        gl->DeleteFramebuffers(1, &tf->statsFbo);
+        tf->statsFbo = 0;
+    }
+
+    GST_GL_BASE_FILTER_CLASS(gst_qgc_thermal_filter_parent_class)->gl_stop(base);
+}
+
+static GstCaps*
+_tf_transform_internal_caps(GstGLFilter* filter, GstPadDirection direction, GstCaps* caps, GstCaps* filter_caps)
+{
+    (void)filter;
+    (void)filter_caps;
+
+    GstCaps* result = gst_caps_copy(caps);
+    GValue formats  = G_VALUE_INIT;
+    GValue format   = G_VALUE_INIT;
+
+    g_value_init(&formats, GST_TYPE_LIST);
+    g_value_init(&format, G_TYPE_STRING);
+
+    if (direction == GST_PAD_SRC) {
+        g_value_set_string(&format, "GRAY16_LE");
+        gst_value_list_append_value(&formats, &format);
+    }
+    g_value_set_string(&format, "RGBA");
+    gst_value_list_append_value(&formats, &format);
+
+    for (guint i = 0; i < gst_caps_get_size(result); i++) {
+        gst_structure_set_value(gst_caps_get_structure(result, i), "format", &formats);
+    }
+
+    g_value_unset(&format);
+    g_value_unset(&formats);
+
+    return result;
+}
+
+static gboolean
+_tf_set_caps(GstGLFilter* filter, GstCaps* incaps, GstCaps* outcaps)
+{
+    (void)incaps;
+    (void)outcaps;
+
+    GstQgcThermalFilter* tf = GST_QGC_THERMAL_FILTER(filter);
+
+    tf->radiometric     = GST_VIDEO_INFO_FORMAT(&filter->in_info) == GST_VIDEO_FORMAT_GRAY16_LE;
+    tf->haveFrameStats  = FALSE;
+
+    GST_DEBUG_OBJECT(tf, "Radiometric input %d", tf->radiometric);
+
+    return TRUE;
+}
+
+// RGBA frames without a palette, isotherm or measurement go through untouched
+static void
+_tf_before_transform(GstBaseTransform* trans, GstBuffer* buffer)
+{
+    (void)buffer;
+
+    GstQgcThermalFilter* tf = GST_QGC_THERMAL_FILTER(trans);
+
+    GST_OBJECT_LOCK(tf);
+    const gboolean passthrough = !tf->radiometric && tf->palette == PALETTE_NONE && tf->isothermHigh <= tf->isothermLow &&
+            tf->spotX < 0 && (tf->areaWidth <= 0 || tf->areaHeight <= 0);
+    GST_OBJECT_UNLOCK(tf);
+
+    gst_base_transform_set_passthrough(trans, passthrough);
+}
+
+static gboolean
+_tf_filter_texture(GstGLFilter* filter, GstGLMemory* in, GstGLMemory* out)
+{
+    GstQgcThermalFilter* tf = GST_QGC_THERMAL_FILTER(filter);
+    const GstGLFuncs* gl    = GST_GL_BASE_FILTER(tf)->context->gl_vtable;
+    const gint width        = gst_gl_memory_get_texture_width(in);
+    const gint height       = gst_gl_memory_get_texture_height(in);
+    GstQgcThermalInput input;
+
+    if (!tf->radiometric) {
+        input = INPUT_RGBA;
+    } else if (gst_gl_memory_get_texture_format(in) == GST_GL_LUMINANCE_ALPHA) {
+        input = INPUT_LUMINANCE_ALPHA;
+    } else {
+        input = INPUT_RG;
+    }
+
+    GST_OBJECT_LOCK(tf);
+    const gint palette          = tf->palette;
+    const gboolean paletteDirty = tf->paletteDirty;
+    const gboolean autoRange    = tf->autoRange;
+    guint low                   = tf->rangeLow;
+    guint high                  = tf->rangeHigh;
+    const guint isothermLow     = tf->isothermLow;
+    const guint isothermHigh    = tf->isothermHigh;
+    const guint isothermColor   = tf->isothermColor;
+    const gboolean spot         = tf->spotX >= 0 && tf->spotY >= 0;
+    const gint spotX            = CLAMP((gint)(tf->spotX * width), 0, width - 1);
+    const gint spotY            = CLAMP((gint)(tf->spotY * height), 0, height - 1);
+    const gboolean area         = tf->areaWidth > 0 && tf->areaHeight > 0;
+    const gint areaX            = CLAMP((gint)(tf->areaX * width), 0, width - 1);
+    const gint areaY            = CLAMP((gint)(tf->areaY * height), 0, height - 1);
+    const gint areaWidth        = CLAMP((gint)(tf->areaWidth * width + 0.5), 1, width - areaX);
+    const gint areaHeight       = CLAMP((gint)(tf->areaHeight * height + 0.5), 1, height - areaY);
+    const guint statsInterval   = tf->statsInterval;
+    tf->paletteDirty = FALSE;
+    GST_OBJECT_UNLOCK(tf);
+
+    if (paletteDirty) {
+        _tf_upload_palette(tf, palette);
+    }
+
+    // Interpolating between texels would mix the two bytes of neighbouring values
+    gl->ActiveTexture(GL_TEXTURE0);
+    gl->BindTexture(GL_TEXTURE_2D, gst_gl_memory_get_texture_id(in));
+    _tf_set_nearest(gl);
+
+    const gint64 now = g_get_monotonic_time();
+
+    if (statsInterval > 0 && now - tf->lastStats >= (gint64)statsInterval * 1000) {
+        guint min, max, mean;
+
+        tf->lastStats = now;
+
+        if (_tf_measure(tf, in, input, 0, 0, width, height, &min, &max, &mean)) {
+            GstStructure* s = gst_structure_new("qgc-thermal-stats",
+                                                "radiometric",  G_TYPE_BOOLEAN, input != INPUT_RGBA,
+                                                "frame-min",    G_TYPE_UINT,    min,
+                                                "frame-max",    G_TYPE_UINT,    max,
+                                                NULL);
+
+            tf->frameMin        = min;
+            tf->frameMax        = max;
+            tf->haveFrameStats  = TRUE;
+
+            if (area && _tf_measure(tf, in, input, areaX, areaY, areaWidth, areaHeight, &min, &max, &mean)) {
+                gst_structure_set(s,
+                                  "area-min",   G_TYPE_UINT, min,
+                                  "area-max",   G_TYPE_UINT, max,
+                                  "area-mean",  G_TYPE_UINT, mean,
+                                  NULL);
+            }
+
+            if (spot && _tf_measure(tf, in, input, spotX, spotY, 1, 1, &min, &max, &mean)) {
+                gst_structure_set(s, "spot", G_TYPE_UINT, min, NULL);
+            }
+
+            gst_element_post_message(GST_ELEMENT(tf), gst_message_new_element(GST_OBJECT(tf), s));
+        }
+    }
+
+    if (autoRange && statsInterval > 0 && tf->haveFrameStats) {
+        low     = tf->frameMin;
+        high    = tf->frameMax;
+    }
+
+    gst_gl_shader_use(tf->shader);
+    gst_gl_shader_set_uniform_1i(tf->shader, "mode",            input);
+    gst_gl_shader_set_uniform_1i(tf->shader, "showInput",       input == INPUT_RGBA && palette == PALETTE_NONE);
+    gst_gl_shader_set_uniform_1f(tf->shader, "low",             (gfloat)low);
+    gst_gl_shader_set_uniform_1f(tf->shader, "high",            (gfloat)high);
+    // An empty isotherm range never matches
+    gst_gl_shader_set_uniform_1f(tf->shader, "isothermLow",     isothermHigh > isothermLow ? (gfloat)isothermLow : 1.0f);
+    gst_gl_shader_set_uniform_1f(tf->shader, "isothermHigh",    isothermHigh > isothermLow ? (gfloat)isothermHigh : 0.0f);
+    gst_gl_shader_set_uniform_4f(tf->shader, "isothermColor",
+                                 ((isothermColor >> 16) & 0xff) / 255.0f,
+                                 ((isothermColor >> 8) & 0xff) / 255.0f,
+                                 (isothermColor & 0xff) / 255.0f,
+                                 1.0f);
+
+    gl->ActiveTexture(GL_TEXTURE1);
+    gl->BindTexture(GL_TEXTURE_2D, tf->paletteTex);
+    gst_gl_shader_set_uniform_1i(tf->shader, "palette", 1);
+    gl->ActiveTexture(GL_TEXTURE0);
+
+    gst_gl_filter_render_to_target_with_shader(filter, in, out, tf->shader);
+
+    return TRUE;
+}
+
+static void
+_tf_set_property(GObject* object, guint prop_id, const GValue* value, GParamSpec* pspec)
+{
+    GstQgcThermalFilter* tf = GST_QGC_THERMAL_FILTER(object);
+
+    GST_OBJECT_LOCK(tf);
+
+    switch (prop_id) {
+    case PROP_PALETTE:
+        tf->palette         = g_value_get_enum(value);
+        tf->paletteDirty    = TRUE;
+        break;
+    case PROP_AUTO_RANGE:
+        tf->autoRange = g_value_get_boolean(value);
+        break;
+    case PROP_RANGE_LOW:
+        tf->rangeLow = g_value_get_uint(value);
+        break;
+    case PROP_RANGE_HIGH:
+        tf->rangeHigh = g_value_get_uint(value);
+        break;
+    case PROP_ISOTHERM_LOW:
+        tf->isothermLow = g_value_get_uint(value);
+        break;
+    case PROP_ISOTHERM_HIGH:
+        tf->isothermHigh = g_value_get_uint(value);
+        break;
+    case PROP_ISOTHERM_COLOR:
+        tf->isothermColor = g_value_get_uint(value);
+        break;
+    case PROP_SPOT_X:
+        tf->spotX = g_value_get_double(value);
+        break;
+    case PROP_SPOT_Y:
+        tf->spotY = g_value_get_double(value);
+        break;
+    case PROP_AREA_X:
+        tf->areaX = g_value_get_double(value);
+        break;
+    case PROP_AREA_Y:
+        tf->areaY = g_value_get_double(value);
+        break;
+    case PROP_AREA_WIDTH:
+        tf->areaWidth = g_value_get_double(value);
+        break;
+    case PROP_AREA_HEIGHT:
+        tf->areaHeight = g_value_get_double(value);
+        break;
+    case PROP_STATS_INTERVAL:
+        tf->statsInterval = g_value_get_uint(value);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
+    }
+
+    GST_OBJECT_UNLOCK(tf);
+}
+
+static void
+_tf_get_property(GObject* object, guint prop_id, GValue* value, GParamSpec* pspec)
+{
+    GstQgcThermalFilter* tf = GST_QGC_THERMAL_FILTER(object);
+
+    GST_OBJECT_LOCK(tf);
+
+    switch (prop_id) {
+    case PROP_PALETTE:
+        g_value_set_enum(value, tf->palette);
+        break;
+    case PROP_AUTO_RANGE:
+        g_value_set_boolean(value, tf->autoRange);
+        break;
+    case PROP_RANGE_LOW:
+        g_value_set_uint(value, tf->rangeLow);
+        break;
+    case PROP_RANGE_HIGH:
+        g_value_set_uint(value, tf->rangeHigh);
+        break;
+    case PROP_ISOTHERM_LOW:
+        g_value_set_uint(value, tf->isothermLow);
+        break;
+    case PROP_ISOTHERM_HIGH:
+        g_value_set_uint(value, tf->isothermHigh);
+        break;
+    case PROP_ISOTHERM_COLOR:
+        g_value_set_uint(value, tf->isothermColor);
+        break;
+    case PROP_SPOT_X:
+        g_value_set_double(value, tf->spotX);
+        break;
+    case PROP_SPOT_Y:
+        g_value_set_double(value, tf->spotY);
+        break;
+    case PROP_AREA_X:
+        g_value_set_double(value, tf->areaX);
+        break;
+    case PROP_AREA_Y:
+        g_value_set_double(value, tf->areaY);
+        break;
+    case PROP_AREA_WIDTH:
+        g_value_set_double(value, tf->areaWidth);
+        break;
+    case PROP_AREA_HEIGHT:
+        g_value_set_double(value, tf->areaHeight);
+        break;
+    case PROP_STATS_INTERVAL:
+        g_value_set_uint(value, tf->statsInterval);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        break;
+    }
+
+    GST_OBJECT_UNLOCK(tf);
+}
+
+static void
+gst_qgc_thermal_filter_init(GstQgcThermalFilter* tf)
+{
+    tf->palette         = DEFAULT_PALETTE;
+    tf->autoRange       = DEFAULT_AUTO_RANGE;
+    tf->rangeLow        = DEFAULT_RANGE_LOW;
+    tf->rangeHigh       = DEFAULT_RANGE_HIGH;
+    tf->isothermLow     = 0;
+    tf->isothermHigh    = 0;
+    tf->isothermColor   = DEFAULT_ISOTHERM_COLOR;
+    tf->spotX           = -1;
+    tf->spotY           = -1;
+    tf->areaX           = 0;
+    tf->areaY           = 0;
+    tf->areaWidth       = 0;
+    tf->areaHeight      = 0;
+    tf->statsInterval   = DEFAULT_STATS_INTERVAL;
+}
+
+static void
+_install_uint_property(GObjectClass* klass, guint prop_id, const gchar* name, const gchar* blurb, guint max, guint def)
+{
+    g_object_class_install_property(klass, prop_id,
+        g_param_spec_uint(name, name, blurb, 0, max, def,
+            (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_CONTROLLABLE)));
+}
+
+static void
+_install_double_property(GObjectClass* klass, guint prop_id, const gchar* name, const gchar* blurb, gdouble min, gdouble def)
+{
+    g_object_class_install_property(klass, prop_id,
+        g_param_spec_double(name, name, blurb, min, 1.0, def,
+            (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_CONTROLLABLE)));
+}
+
+static void
+gst_qgc_thermal_filter_class_init(GstQgcThermalFilterClass* klass)
+{
+    GObjectClass* gobject_klass             = (GObjectClass*)klass;
+    GstElementClass* gstelement_klass       = (GstElementClass*)klass;
+    GstBaseTransformClass* transform_klass  = (GstBaseTransformClass*)klass;
+    GstGLBaseFilterClass* base_klass        = (GstGLBaseFilterClass*)klass;
+    GstGLFilterClass* filter_klass          = (GstGLFilterClass*)klass;
+
+    gobject_klass->set_property = _tf_set_property;
+    gobject_klass->get_property = _tf_get_property;
+
+    transform_klass->before_transform = _tf_before_transform;
+
+    base_klass->gl_start            = _tf_gl_start;
+    base_klass->gl_stop             = _tf_gl_stop;
+    base_klass->supported_gl_api    = (GstGLAPI)(GST_GL_API_OPENGL | GST_GL_API_OPENGL3 | GST_GL_API_GLES2);
+
+    filter_klass->set_caps                  = _tf_set_caps;
+    filter_klass->transform_internal_caps   = _tf_transform_internal_caps;
+    filter_klass->filter_texture            = _tf_filter_texture;
+
+    g_object_class_install_property(gobject_klass, PROP_PALETTE,
+        g_param_spec_enum("palette", "Palette", "Colors the values are mapped to",
+            GST_TYPE_QGC_THERMAL_PALETTE, DEFAULT_PALETTE,
+            (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_CONTROLLABLE)));
+
+    g_object_class_install_property(gobject_klass, PROP_AUTO_RANGE,
+        g_param_spec_boolean("auto-range", "Auto range", "Spread the palette over the measured frame minimum to maximum",
+            DEFAULT_AUTO_RANGE,
+            (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | GST_PARAM_CONTROLLABLE)));
+
+    _install_uint_property(gobject_klass, PROP_RANGE_LOW,       "range-low",        "Value at the low end of the palette without auto-range",      65535, DEFAULT_RANGE_LOW);
+    _install_uint_property(gobject_klass, PROP_RANGE_HIGH,      "range-high",       "Value at the high end of the palette without auto-range",     65535, DEFAULT_RANGE_HIGH);
+    _install_uint_property(gobject_klass, PROP_ISOTHERM_LOW,    "isotherm-low",     "Lowest value painted in the isotherm color",                  65535, 0);
+    _install_uint_property(gobject_klass, PROP_ISOTHERM_HIGH,   "isotherm-high",    "Highest value painted in the isotherm color, none if not above isotherm-low", 65535, 0);
+    _install_uint_property(gobject_klass, PROP_ISOTHERM_COLOR,  "isotherm-color",   "Isotherm color as 0xAARRGGBB",                                G_MAXUINT, DEFAULT_ISOTHERM_COLOR);
+    _install_uint_property(gobject_klass, PROP_STATS_INTERVAL,  "stats-interval",   "Milliseconds between measurements, 0 to not measure",         G_MAXUINT, DEFAULT_STATS_INTERVAL);
+
+    _install_double_property(gobject_klass, PROP_SPOT_X,        "spot-x",       "Measured point, 0..1 across the frame, negative for none",    -1.0, -1.0);
+    _install_double_property(gobject_klass, PROP_SPOT_Y,        "spot-y",       "Measured point, 0..1 down the frame, negative for none",      -1.0, -1.0);
+    _install_double_property(gobject_klass, PROP_AREA_X,        "area-x",       "Measured area left edge, 0..1 across the frame",              0.0, 0.0);
+    _install_double_property(gobject_klass, PROP_AREA_Y,        "area-y",       "Measured area top edge, 0..1 down the frame",                 0.0, 0.0);
+    _install_double_property(gobject_klass, PROP_AREA_WIDTH,    "area-width",   "Measured area width relative to the frame, 0 for none",       0.0, 0.0);
+    _install_double_property(gobject_klass, PROP_AREA_HEIGHT,   "area-height",  "Measured area height relative to the frame, 0 for none",      0.0, 0.0);
+
+    gst_element_class_add_static_pad_template(gstelement_klass, &_tf_sink_template);
+    gst_element_class_add_static_pad_template(gstelement_klass, &_tf_src_template);
+
+    gst_element_class_set_static_metadata(gstelement_klass,
+        "QGC Thermal Filter", "Filter/Effect/Video",
+        "Thermal palette, isotherms and measurements in shaders",
+        "QGroundControl project");
+}
+
+gboolean
+gst_qgc_thermal_filter_plugin_init(GstPlugin* plugin)
+{
+    GST_DEBUG_CATEGORY_INIT(gst_qgc_thermal_filter_debug, "qgcthermalfilter", 0, "QGC Thermal Filter");
+    return gst_element_register(plugin, "qgcthermalfilter", GST_RANK_NONE, GST_TYPE_QGC_THERMAL_FILTER);
+}
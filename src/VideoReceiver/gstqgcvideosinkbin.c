@@ -26,6 +26,8 @@ typedef struct _GstQgcVideoSinkBin {
     GstBin bin;
     GstElement* glupload;
     GstElement* qmlglsink;
+    GstElement* glcolorconvert;     // Owned by the bin
+    GstElement* thermalfilter;      // Owned by the bin, NULL until thermal is set
 } GstQgcVideoSinkBin;
 
 typedef struct _GstQgcVideoSinkBinClass {
@@ -47,6 +49,7 @@ enum {
     PROP_FORCE_ASPECT_RATIO,
     PROP_PIXEL_ASPECT_RATIO,
     PROP_SYNC,
+    PROP_THERMAL,
 };
 
 #define PROP_ENABLE_LAST_SAMPLE_NAME    "enable-last-sample"
@@ -55,6 +58,7 @@ enum {
 #define PROP_FORCE_ASPECT_RATIO_NAME    "force-aspect-ratio"
 #define PROP_PIXEL_ASPECT_RATIO_NAME    "pixel-aspect-ratio"
 #define PROP_SYNC_NAME                  "sync"
+#define PROP_THERMAL_NAME               "thermal"
 
 #define DEFAULT_ENABLE_LAST_SAMPLE TRUE
 #define DEFAULT_FORCE_ASPECT_RATIO TRUE
@@ -145,6 +149,7 @@ _vsb_init(GstQgcVideoSinkBin *vsb)
 
         gboolean ret = gst_element_link_many(vsb->glupload, glcolorconvert, vsb->qmlglsink, NULL);
 
+        vsb->glcolorconvert = glcolorconvert;
         glcolorconvert = NULL;
 
         if (!ret) {
@@ -192,6 +197,48 @@ _vsb_init(GstQgcVideoSinkBin *vsb)
     }
 }
 
+// Inserts qgcthermalfilter (named "thermalfilter") in front of qmlglsink. glcolorconvert passes GRAY16_LE frames
+// on to it as they are, so radiometric values reach the shaders with all 16 bits.
+static gboolean
+_vsb_add_thermal_filter(GstQgcVideoSinkBin *vsb)
+{
+    GstElement* thermalfilter = NULL;
+
+    if (vsb->thermalfilter != NULL) {
+        return TRUE;
+    }
+
+    if (vsb->glcolorconvert == NULL || vsb->qmlglsink == NULL) {
+        GST_ERROR_OBJECT(vsb, "Video sink bin not initialized");
+        return FALSE;
+    }
+
+    if (GST_STATE(vsb) != GST_STATE_NULL) {
+        GST_ERROR_OBJECT(vsb, "Thermal filter can only be added in the NULL state");
+        return FALSE;
+    }
+
+    if ((thermalfilter = gst_element_factory_make("qgcthermalfilter", "thermalfilter")) == NULL) {
+        GST_ERROR_OBJECT(vsb, "gst_element_factory_make('qgcthermalfilter') failed");
+        return FALSE;
+    }
+
+    gst_element_unlink(vsb->glcolorconvert, vsb->qmlglsink);
+
+    gst_bin_add(GST_BIN(vsb), thermalfilter);
+
+    if (!gst_element_link_many(vsb->glcolorconvert, thermalfilter, vsb->qmlglsink, NULL)) {
+        GST_ERROR_OBJECT(vsb, "gst_element_link_many() failed");
+        gst_bin_remove(GST_BIN(vsb), thermalfilter);
+        gst_element_link(vsb->glcolorconvert, vsb->qmlglsink);
+        return FALSE;
+    }
+
+    vsb->thermalfilter = thermalfilter;
+
+    return TRUE;
+}
+
 static void
 _vsb_dispose(GObject *object)
 {
@@ -266,6 +313,9 @@ _vsb_get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *psp
             g_value_set_boolean(value, enable);
         } while(0);
         break;
+    case PROP_THERMAL:
+        g_value_set_boolean(value, vsb->thermalfilter != NULL);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -295,6 +345,13 @@ _vsb_set_property(GObject *object, guint prop_id, const GValue *value, GParamSpe
     case PROP_SYNC:
         g_object_set(G_OBJECT(vsb->qmlglsink), PROP_SYNC_NAME, g_value_get_boolean(value), NULL);
         break;
+    case PROP_THERMAL:
+        if (g_value_get_boolean(value)) {
+            _vsb_add_thermal_filter(vsb);
+        } else if (vsb->thermalfilter != NULL) {
+            GST_WARNING_OBJECT(vsb, "Thermal filter can't be removed");
+        }
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -372,6 +429,11 @@ _vsb_class_init(GstQgcVideoSinkBinClass *klass)
             "Sync on the clock", DEFAULT_SYNC,
             (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
 
+    g_object_class_install_property(gobject_klass, PROP_THERMAL,
+        g_param_spec_boolean(PROP_THERMAL_NAME, "Thermal",
+            "Process frames with qgcthermalfilter, can only be set in the NULL state", FALSE,
+            (GParamFlags)(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
     gst_element_class_set_static_metadata(gstelement_klass,
         "QGC Video Sink Bin", "Sink/Video/Bin",
         "Video rendering for QGC",
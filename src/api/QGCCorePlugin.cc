@@ -24,9 +24,13 @@
 #include "QGCCameraManager.h"
 #include "HorizontalFactValueGrid.h"
 #include "InstrumentValueData.h"
+#include "MAVLinkProtocol.h"
 
 #include <QtQml>
 #include <QQmlEngine>
+#include <QThread>
+
+QGC_LOGGING_CATEGORY(QGCCorePluginLog, "QGCCorePluginLog")
 
 /// @file
 ///     @brief Core Plugin Interface for QGroundControl - Default Implementation
@@ -41,6 +45,7 @@ public:
 
     ~QGCCorePlugin_p()
     {
+        stopMessageThread();
         if(pGeneral)
             delete pGeneral;
         if(pCommLinks)
@@ -63,6 +68,8 @@ public:
             delete pMAVLink;
         if(pConsole)
             delete pConsole;
+        if(pMemory)
+            delete pMemory;
 #if defined(QT_DEBUG)
         if(pMockLink)
             delete pMockLink;
@@ -89,6 +96,7 @@ public:
 #endif
     QmlComponentInfo* pMAVLink                  = nullptr;
     QmlComponentInfo* pConsole                  = nullptr;
+    QmlComponentInfo* pMemory                   = nullptr;
     QmlComponentInfo* pHelp                     = nullptr;
 #if defined(QT_DEBUG)
     QmlComponentInfo* pMockLink                 = nullptr;
@@ -101,6 +109,23 @@ public:
     QVariantList        analyzeList;
 
     QmlObjectListModel _emptyCustomMapItems;
+
+    void stopMessageThread(void)
+    {
+        if (messageThread) {
+            messageThread->quit();
+            messageThread->wait();
+            delete messageWorker;
+            delete messageThread;
+            messageWorker = nullptr;
+            messageThread = nullptr;
+        }
+    }
+
+    QThread*    messageThread           = nullptr;
+    QObject*    messageWorker           = nullptr;  ///< Lives on messageThread, filtered messages are queued to it
+    QAtomicInt  pendingWorkerMessages;
+    bool        droppingWorkerMessages  = false;
 };
 
 QGCCorePlugin::~QGCCorePlugin()
@@ -126,6 +151,67 @@ void QGCCorePlugin::setToolbox(QGCToolbox *toolbox)
     qmlRegisterUncreatableType<QGCCorePlugin>       ("QGroundControl", 1, 0, "QGCCorePlugin",       "Reference only");
     qmlRegisterUncreatableType<QGCOptions>          ("QGroundControl", 1, 0, "QGCOptions",          "Reference only");
     qmlRegisterUncreatableType<QGCFlyViewOptions>   ("QGroundControl", 1, 0, "QGCFlyViewOptions",   "Reference only");
+
+    _subscribeFilteredMessages(toolbox->mavlinkProtocol()->messageDispatcher());
+}
+
+void QGCCorePlugin::_subscribeFilteredMessages(MAVLinkMessageDispatcher* dispatcher)
+{
+    const MavlinkMessageFilter_t filter = mavlinkMessageFilter();
+    if (filter.msgIds.isEmpty()) {
+        return;
+    }
+
+    MAVLinkMessageDispatcher::Handler_t handler;
+    if (filter.workerThread) {
+        if (!_p->messageThread) {
+            _p->messageThread = new QThread();
+            _p->messageThread->setObjectName(QStringLiteral("QGCCorePluginMessages"));
+            _p->messageWorker = new QObject();
+            _p->messageWorker->moveToThread(_p->messageThread);
+            _p->messageThread->start();
+        }
+        QGCCorePlugin_p* p = _p;
+        handler = [this, p](LinkInterface*, const mavlink_message_t& message) {
+            if (!p->messageWorker) {
+                // Worker was stopped
+                return;
+            }
+            if (p->pendingWorkerMessages.fetchAndAddRelaxed(1) >= maxPendingWorkerMessages) {
+                p->pendingWorkerMessages.fetchAndAddRelaxed(-1);
+                if (!p->droppingWorkerMessages) {
+                    qCWarning(QGCCorePluginLog) << "Worker thread is behind, dropping filtered messages";
+                    p->droppingWorkerMessages = true;
+                }
+                return;
+            }
+            p->droppingWorkerMessages = false;
+            // The copy in the functor is the one the worker gets, it isn't shared with anything else
+            QMetaObject::invokeMethod(p->messageWorker, [this, p, message]() {
+                mavlinkMessageFiltered(message);
+                p->pendingWorkerMessages.fetchAndAddRelaxed(-1);
+            }, Qt::QueuedConnection);
+        };
+    } else {
+        handler = [this](LinkInterface*, const mavlink_message_t& message) { mavlinkMessageFiltered(message); };
+    }
+
+    const int   anySystem   = MAVLinkMessageDispatcher::AnySystem;
+    QList<int>  sysIds      = filter.sysIds.values();
+    if (sysIds.isEmpty()) {
+        sysIds.append(anySystem);
+    }
+    for (uint32_t msgId: filter.msgIds) {
+        for (int sysId: sysIds) {
+            dispatcher->subscribe(msgId, sysId, MAVLinkMessageDispatcher::AnyComponent, this, handler);
+        }
+    }
+    qCDebug(QGCCorePluginLog) << "Filtered messages" << filter.msgIds.count() << "systems" << filter.sysIds.count() << "worker" << filter.workerThread;
+}
+
+void QGCCorePlugin::_stopMessageWorker(void)
+{
+    _p->stopMessageThread();
 }
 
 QVariantList &QGCCorePlugin::settingsPages()
@@ -168,6 +254,9 @@ QVariantList &QGCCorePlugin::settingsPages()
         _p->pConsole = new QmlComponentInfo(tr("Console"),
                                             QUrl::fromUserInput("qrc:/qml/QGroundControl/Controls/AppMessages.qml"));
         _p->settingsList.append(QVariant::fromValue(reinterpret_cast<QmlComponentInfo*>(_p->pConsole)));
+        _p->pMemory = new QmlComponentInfo(tr("Memory"),
+                                           QUrl::fromUserInput("qrc:/qml/MemorySettings.qml"));
+        _p->settingsList.append(QVariant::fromValue(reinterpret_cast<QmlComponentInfo*>(_p->pMemory)));
         _p->pHelp = new QmlComponentInfo(tr("Help"),
                                          QUrl::fromUserInput("qrc:/qml/HelpSettings.qml"));
         _p->settingsList.append(QVariant::fromValue(reinterpret_cast<QmlComponentInfo*>(_p->pHelp)));
@@ -191,6 +280,7 @@ QVariantList& QGCCorePlugin::analyzePages()
 {
     if (!_p->analyzeList.count()) {
         _p->analyzeList.append(QVariant::fromValue(new QmlComponentInfo(tr("Log Download"),     QUrl::fromUserInput("qrc:/qml/LogDownloadPage.qml"),        QUrl::fromUserInput("qrc:/qmlimages/LogDownloadIcon"))));
+        _p->analyzeList.append(QVariant::fromValue(new QmlComponentInfo(tr("Log Index"),        QUrl::fromUserInput("qrc:/qml/LogIndexPage.qml"),           QUrl::fromUserInput("qrc:/qmlimages/LogDownloadIcon"))));
 #if !defined(__mobile__)
         _p->analyzeList.append(QVariant::fromValue(new QmlComponentInfo(tr("GeoTag Images"),    QUrl::fromUserInput("qrc:/qml/GeoTagPage.qml"),             QUrl::fromUserInput("qrc:/qmlimages/GeoTagIcon"))));
 #endif
@@ -381,7 +471,7 @@ void QGCCorePlugin::createRootWindow(QQmlApplicationEngine* qmlEngine)
     qmlEngine->load(QUrl(QStringLiteral("qrc:/qml/MainRootWindow.qml")));
 }
 
-bool QGCCorePlugin::mavlinkMessage(Vehicle* vehicle, LinkInterface* link, mavlink_message_t message)
+bool QGCCorePlugin::mavlinkMessage(Vehicle* vehicle, LinkInterface* link, const mavlink_message_t& message)
 {
     Q_UNUSED(vehicle);
     Q_UNUSED(link);
@@ -13,8 +13,10 @@
 #include "QGCPalette.h"
 #include "QGCMAVLink.h"
 #include "QmlObjectListModel.h"
+#include "QGCLoggingCategory.h"
 
 #include <QObject>
+#include <QSet>
 #include <QVariantList>
 
 /// @file
@@ -38,6 +40,9 @@ class QGCCameraManager;
 class QGCCameraControl;
 class QQuickItem;
 class InstrumentValueAreaController;
+class MAVLinkMessageDispatcher;
+
+Q_DECLARE_LOGGING_CATEGORY(QGCCorePluginLog)
 
 class QGCCorePlugin : public QGCTool
 {
@@ -124,7 +129,25 @@ public:
 
     /// Allows the plugin to see all mavlink traffic to a vehicle
     /// @return true: Allow vehicle to continue processing, false: Vehicle should not process message
-    virtual bool mavlinkMessage(Vehicle* vehicle, LinkInterface* link, mavlink_message_t message);
+    virtual bool mavlinkMessage(Vehicle* vehicle, LinkInterface* link, const mavlink_message_t& message);
+
+    typedef struct {
+        QSet<uint32_t>  msgIds;                     ///< Message ids to deliver, empty for none
+        QSet<int>       sysIds;                     ///< Systems to deliver them from, empty for all
+        bool            workerThread    = false;    ///< true: Deliver on a worker thread instead of the GUI thread
+    } MavlinkMessageFilter_t;
+
+    /// Messages to deliver to mavlinkMessageFiltered. Only asked once, when the plugin is set up. The default is none.
+    /// Messages outside the filter never reach the plugin, unlike mavlinkMessage which is called for all of them.
+    virtual MavlinkMessageFilter_t mavlinkMessageFilter(void) const { return MavlinkMessageFilter_t(); }
+
+    /// Called with each message which matches mavlinkMessageFilter, as received and before the vehicle sees it. It
+    /// can't stop the vehicle from processing the message, use mavlinkMessage for that. On the worker thread, which is
+    /// shared by all filtered messages, the message is a copy owned by the call and nothing else may be touched without
+    /// locking. Messages are dropped while maxPendingWorkerMessages are waiting for it.
+    virtual void mavlinkMessageFiltered(const mavlink_message_t& message) { Q_UNUSED(message); }
+
+    static const int maxPendingWorkerMessages = 1000;
 
     /// Allows custom builds to add custom items to the FlightMap. Objects put into QmlObjectListModel should derive from QmlComponentInfo and set the url property.
     virtual QmlObjectListModel* customMapItems();
@@ -205,6 +228,13 @@ signals:
     void toolBarIndicatorsChanged   ();
 
 protected:
+    /// Subscribes mavlinkMessageFiltered to the messages in mavlinkMessageFilter. Called from setToolbox.
+    void _subscribeFilteredMessages(MAVLinkMessageDispatcher* dispatcher);
+
+    /// Waits for the worker thread to finish the messages it has and stops it. Plugins which receive messages on the
+    /// worker thread call this from their destructor, before the state mavlinkMessageFiltered uses goes away.
+    void _stopMessageWorker(void);
+
     bool                _showTouchAreas;
     bool                _showAdvancedUI;
     Vehicle*            _activeVehicle  = nullptr;
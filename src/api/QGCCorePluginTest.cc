@@ -0,0 +1,140 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCCorePluginTest.h"
+#include "QGCCorePlugin.h"
+#include "QGCApplication.h"
+#include "MAVLinkMessageDispatcher.h"
+
+#include <QMutex>
+#include <QThread>
+
+/// Records the messages it is given through the filtered hook
+class FilteredMessagePlugin : public QGCCorePlugin
+{
+public:
+    FilteredMessagePlugin(const MavlinkMessageFilter_t& filter)
+        : QGCCorePlugin (qgcApp(), qgcApp()->toolbox())
+        , _filter       (filter)
+    {
+    }
+
+    ~FilteredMessagePlugin()
+    {
+        _stopMessageWorker();
+    }
+
+    MavlinkMessageFilter_t mavlinkMessageFilter(void) const final { return _filter; }
+
+    void mavlinkMessageFiltered(const mavlink_message_t& message) final
+    {
+        QMutexLocker lock(&_mutex);
+        _messages.append(message);
+        _thread = QThread::currentThread();
+    }
+
+    void subscribe(MAVLinkMessageDispatcher* dispatcher) { _subscribeFilteredMessages(dispatcher); }
+
+    int messageCount(void) const
+    {
+        QMutexLocker lock(&_mutex);
+        return _messages.count();
+    }
+
+    QList<mavlink_message_t> messages(void) const
+    {
+        QMutexLocker lock(&_mutex);
+        return _messages;
+    }
+
+    QThread* thread(void) const
+    {
+        QMutexLocker lock(&_mutex);
+        return _thread;
+    }
+
+private:
+    MavlinkMessageFilter_t      _filter;
+    mutable QMutex              _mutex;
+    QList<mavlink_message_t>    _messages;
+    QThread*                    _thread = nullptr;
+};
+
+static mavlink_message_t _message(uint32_t msgId, uint8_t sysId)
+{
+    mavlink_message_t message;
+
+    memset(&message, 0, sizeof(message));
+    message.msgid   = msgId;
+    message.sysid   = sysId;
+    message.compid  = MAV_COMP_ID_AUTOPILOT1;
+
+    return message;
+}
+
+void QGCCorePluginTest::_noFilterTest(void)
+{
+    MAVLinkMessageDispatcher    dispatcher;
+    FilteredMessagePlugin       plugin((QGCCorePlugin::MavlinkMessageFilter_t()));
+
+    plugin.subscribe(&dispatcher);
+    QCOMPARE(dispatcher.subscriptionCount(), 0);
+}
+
+void QGCCorePluginTest::_filterTest(void)
+{
+    MAVLinkMessageDispatcher                dispatcher;
+    QGCCorePlugin::MavlinkMessageFilter_t   filter;
+
+    filter.msgIds = { MAVLINK_MSG_ID_ATTITUDE, MAVLINK_MSG_ID_GPS_RAW_INT };
+    filter.sysIds = { 1, 3 };
+    FilteredMessagePlugin plugin(filter);
+    plugin.subscribe(&dispatcher);
+    QCOMPARE(dispatcher.subscriptionCount(), 4);
+
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_HEARTBEAT,     1));
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_ATTITUDE,      1));
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_ATTITUDE,      2));
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_GPS_RAW_INT,   3));
+
+    // Delivered right away on the GUI thread
+    QList<mavlink_message_t> messages = plugin.messages();
+    QCOMPARE(messages.count(), 2);
+    QCOMPARE(messages[0].msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_ATTITUDE));
+    QCOMPARE(messages[0].sysid, static_cast<uint8_t>(1));
+    QCOMPARE(messages[1].msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_GPS_RAW_INT));
+    QCOMPARE(plugin.thread(), QThread::currentThread());
+}
+
+void QGCCorePluginTest::_workerThreadTest(void)
+{
+    MAVLinkMessageDispatcher                dispatcher;
+    QGCCorePlugin::MavlinkMessageFilter_t   filter;
+
+    // No system ids is all systems
+    filter.msgIds       = { MAVLINK_MSG_ID_ATTITUDE };
+    filter.workerThread = true;
+    FilteredMessagePlugin plugin(filter);
+    plugin.subscribe(&dispatcher);
+    QCOMPARE(dispatcher.subscriptionCount(), 1);
+
+    for (int i=0; i<20; i++) {
+        dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_ATTITUDE,  static_cast<uint8_t>(i + 1)));
+        dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_HEARTBEAT, static_cast<uint8_t>(i + 1)));
+    }
+
+    QTRY_COMPARE_WITH_TIMEOUT(plugin.messageCount(), 20, 5000);
+    QVERIFY(plugin.thread() != QThread::currentThread());
+
+    // Order is kept through the queue
+    QList<mavlink_message_t> messages = plugin.messages();
+    for (int i=0; i<messages.count(); i++) {
+        QCOMPARE(messages[i].sysid, static_cast<uint8_t>(i + 1));
+    }
+}
@@ -23,55 +23,119 @@
 #include "QGC.h"
 #include "LinkManager.h"
 
+QGC_LOGGING_CATEGORY(BluetoothLinkLog, "BluetoothLinkLog")
+
 BluetoothLink::BluetoothLink(SharedLinkConfigurationPtr& config)
     : LinkInterface     (config)
+    , _bluetoothConfig  (qobject_cast<BluetoothConfiguration*>(config.get()))
 {
+    Q_ASSERT(_bluetoothConfig);
+    moveToThread(this);
 
+    // Reserved capacity is kept when the buffers are resized to empty
+    _writeBuffer.reserve(_coalesceBytes);
+    _readBuffer.resize(_readBufferSize);
 }
 
 BluetoothLink::~BluetoothLink()
 {
     disconnect();
-#ifdef __ios__
-    if(_discoveryAgent) {
-        _shutDown = true;
-        _discoveryAgent->stop();
-        _discoveryAgent->deleteLater();
-        _discoveryAgent = nullptr;
-    }
-#endif
 }
 
 void BluetoothLink::run()
 {
+    // The timer is only used from the link thread, so it lives on its stack for as long as it runs
+    QTimer flushTimer;
 
+    flushTimer.setSingleShot(true);
+    flushTimer.setInterval(_bluetoothConfig->coalesceMSecs());
+    connect(&flushTimer, &QTimer::timeout, this, [this]() {
+        QMutexLocker locker(&_writeBufferMutex);
+        _flushWriteBuffer();
+    });
+
+    _flushTimer = &flushTimer;
+
+    _hardwareConnect();
+    exec();
+
+    _flushTimer = nullptr;
 }
 
 void BluetoothLink::_writeBytes(const QByteArray bytes)
 {
-    if (_targetSocket) {
-        if(_targetSocket->write(bytes) > 0) {
-            emit bytesSent(this, bytes);
-        } else {
-            qWarning() << "Bluetooth write error";
+    if (!_targetSocket) {
+        return;
+    }
+    emit bytesSent(this, bytes);
+
+    QMutexLocker locker(&_writeBufferMutex);
+
+    _writeStatistics.addRead(bytes.length());
+
+    // Writes from other threads aren't held since the flush timer belongs to the link thread
+    if (_bluetoothConfig->coalesceMSecs() <= 0 || !_flushTimer || QThread::currentThread() != this) {
+        _flushWriteBuffer();
+        if (_connectState) {
+            if (_targetSocket->write(bytes) > 0) {
+                _writeStatistics.addDelivery(bytes.length(), 0);
+            } else {
+                qWarning() << "Bluetooth write error";
+            }
         }
+        return;
+    }
+
+    if (_writeBuffer.isEmpty()) {
+        _writePendingTimer.start();
+    }
+    _writeBuffer.append(bytes);
+    if (_writeBuffer.length() >= _coalesceBytes) {
+        _flushWriteBuffer();
+    } else if (!_flushTimer->isActive()) {
+        _flushTimer->start();
+    }
+}
+
+/// Writes out the coalesced bytes. Bytes written while the connection is down are dropped.
+/// Must be called with _writeBufferMutex locked.
+void BluetoothLink::_flushWriteBuffer(void)
+{
+    if (!_writeBuffer.isEmpty()) {
+        if (_targetSocket && _connectState) {
+            if (_targetSocket->write(_writeBuffer) > 0) {
+                _writeStatistics.addDelivery(_writeBuffer.length(), _writePendingTimer.nsecsElapsed() / 1000);
+            } else {
+                qWarning() << "Bluetooth write error";
+            }
+        }
+        _writeBuffer.resize(0);
     }
 }
 
 void BluetoothLink::readBytes()
 {
     if (_targetSocket) {
-        while (_targetSocket->bytesAvailable() > 0) {
-            QByteArray datagram;
-            datagram.resize(_targetSocket->bytesAvailable());
-            _targetSocket->read(datagram.data(), datagram.size());
-            emit bytesReceived(this, datagram);
+        // Reads everything available into the reused buffer, which only grows for a backlog larger than its initial size
+        qint64 byteCount;
+        while ((byteCount = _targetSocket->bytesAvailable()) > 0) {
+            if (_readBuffer.size() < byteCount) {
+                _readBuffer.resize(static_cast<int>(byteCount));
+            }
+            qint64 readCount = _targetSocket->read(_readBuffer.data(), byteCount);
+            if (readCount <= 0) {
+                break;
+            }
+            _readStatistics.addRead(static_cast<int>(readCount));
+            _bytesReceived(_readBuffer.constData(), static_cast<int>(readCount));
         }
     }
 }
 
 void BluetoothLink::disconnect(void)
 {
+    quit();
+    wait();
 #ifdef __ios__
     if(_discoveryAgent) {
         _shutDown = true;
@@ -83,6 +147,12 @@ void BluetoothLink::disconnect(void)
     if(_targetSocket) {
         // This prevents stale signals from calling the link after it has been deleted
         QObject::disconnect(_targetSocket, &QBluetoothSocket::readyRead, this, &BluetoothLink::readBytes);
+        qCDebug(BluetoothLinkLog) << "Read statistics" << _config->name() << _readStatistics.toString();
+        qCDebug(BluetoothLinkLog) << "Write statistics" << _config->name() << _writeStatistics.toString();
+        {
+            QMutexLocker locker(&_writeBufferMutex);
+            _writeBuffer.resize(0);
+        }
         _targetSocket->deleteLater();
         _targetSocket = nullptr;
         emit disconnected();
@@ -92,12 +162,20 @@ void BluetoothLink::disconnect(void)
 
 bool BluetoothLink::_connect(void)
 {
-    _hardwareConnect();
+    if (isRunning()) {
+        quit();
+        wait();
+    }
+    // Service discovery and the socket run on the thread of the link, started from run
+    start(HighPriority);
     return true;
 }
 
 bool BluetoothLink::_hardwareConnect()
 {
+    _readStatistics.reset();
+    _writeStatistics.reset();
+
 #ifdef __ios__
     if(_discoveryAgent) {
         _shutDown = true;
@@ -113,7 +191,7 @@ bool BluetoothLink::_hardwareConnect()
     _discoveryAgent->start();
 #else
     _createSocket();
-    _targetSocket->connectToService(QBluetoothAddress(qobject_cast<BluetoothConfiguration*>(_config.get())->device().address), QBluetoothUuid(QBluetoothUuid::SerialPort));
+    _targetSocket->connectToService(QBluetoothAddress(_bluetoothConfig->device().address), QBluetoothUuid(QBluetoothUuid::SerialPort));
 #endif
     return true;
 }
@@ -140,7 +218,7 @@ void BluetoothLink::serviceDiscovered(const QBluetoothServiceInfo& info)
 {
     if(!info.device().name().isEmpty() && !_targetSocket)
     {
-        if(_config->device().uuid == info.device().deviceUuid() && _config->device().name == info.device().name())
+        if(_bluetoothConfig->device().uuid == info.device().deviceUuid() && _bluetoothConfig->device().name == info.device().name())
         {
             _createSocket();
             _targetSocket->connectToService(info);
@@ -160,7 +238,7 @@ void BluetoothLink::discoveryFinished()
         if(!_targetSocket)
         {
             _connectState = false;
-            emit communicationError("Could not locate Bluetooth device:", _config->device().name);
+            emit communicationError("Could not locate Bluetooth device:", _bluetoothConfig->device().name);
         }
     }
 }
@@ -204,6 +282,7 @@ BluetoothConfiguration::BluetoothConfiguration(BluetoothConfiguration* source)
     : LinkConfiguration(source)
     , _deviceDiscover(nullptr)
     , _device(source->device())
+    , _coalesceMSecs(source->coalesceMSecs())
 {
 }
 
@@ -230,7 +309,16 @@ void BluetoothConfiguration::copyFrom(LinkConfiguration *source)
     LinkConfiguration::copyFrom(source);
     auto* usource = qobject_cast<BluetoothConfiguration*>(source);
     Q_ASSERT(usource != nullptr);
-    _device = usource->device();
+    _device         = usource->device();
+    _coalesceMSecs  = usource->coalesceMSecs();
+}
+
+void BluetoothConfiguration::setCoalesceMSecs(int coalesceMSecs)
+{
+    if (_coalesceMSecs != coalesceMSecs) {
+        _coalesceMSecs = coalesceMSecs;
+        emit coalesceMSecsChanged();
+    }
 }
 
 void BluetoothConfiguration::saveSettings(QSettings& settings, const QString& root)
@@ -242,6 +330,7 @@ void BluetoothConfiguration::saveSettings(QSettings& settings, const QString& ro
 #else
     settings.setValue("address",_device.address);
 #endif
+    settings.setValue("coalesceMSecs", _coalesceMSecs);
     settings.endGroup();
 }
 
@@ -255,6 +344,7 @@ void BluetoothConfiguration::loadSettings(QSettings& settings, const QString& ro
 #else
     _device.address = settings.value("address", _device.address).toString();
 #endif
+    _coalesceMSecs  = settings.value("coalesceMSecs", _coalesceMSecs).toInt();
     settings.endGroup();
 }
 
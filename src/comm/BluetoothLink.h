@@ -15,14 +15,20 @@
 #include <QMutexLocker>
 #include <QQueue>
 #include <QByteArray>
+#include <QElapsedTimer>
+#include <QTimer>
 #include <QBluetoothDeviceInfo>
 #include <QtBluetooth/QBluetoothSocket>
 #include <qbluetoothserviceinfo.h>
 #include <qbluetoothservicediscoveryagent.h>
 
 #include "QGCConfig.h"
+#include "QGCLoggingCategory.h"
 #include "LinkConfiguration.h"
 #include "LinkInterface.h"
+#include "LinkReadStatistics.h"
+
+Q_DECLARE_LOGGING_CATEGORY(BluetoothLinkLog)
 
 class QBluetoothDeviceDiscoveryAgent;
 class QBluetoothServiceDiscoveryAgent;
@@ -78,6 +84,7 @@ public:
     Q_PROPERTY(QString      address     READ address                      NOTIFY addressChanged)
     Q_PROPERTY(QStringList  nameList    READ nameList                     NOTIFY nameListChanged)
     Q_PROPERTY(bool         scanning    READ scanning                     NOTIFY scanningChanged)
+    Q_PROPERTY(int          coalesceMSecs READ coalesceMSecs WRITE setCoalesceMSecs NOTIFY coalesceMSecsChanged)  ///< Longest a write is held for coalescing, 0 to write right away
 
     Q_INVOKABLE void startScan  (void);
     Q_INVOKABLE void stopScan   (void);
@@ -88,6 +95,8 @@ public:
     bool            scanning    (void)                  { return _deviceDiscover != nullptr; }
     BluetoothData   device      (void)                  { return _device; }
     void            setDevName  (const QString& name);
+    int             coalesceMSecs(void) const           { return _coalesceMSecs; }
+    void            setCoalesceMSecs(int coalesceMSecs);
 
     /// LinkConfiguration overrides
     LinkType    type            (void) override                                         { return LinkConfiguration::TypeBluetooth; }
@@ -107,14 +116,19 @@ signals:
     void addressChanged (void);
     void nameListChanged(void);
     void scanningChanged(void);
+    void coalesceMSecsChanged(void);
 
 private:
     QBluetoothDeviceDiscoveryAgent* _deviceDiscover = nullptr;
     BluetoothData                   _device;
+    int                             _coalesceMSecs  = 5;
     QStringList                     _nameList;
     QList<BluetoothData>            _deviceList;
 };
 
+/// RFCOMM link. The socket and the service discovery run on the thread of the link. Each RFCOMM write costs about
+/// the same no matter how small it is, a system call or on Android a JNI call and a frame over the air, so writes are
+/// held for up to coalesceMSecs and written out together once that much time has passed or _coalesceBytes are held.
 class BluetoothLink : public LinkInterface
 {
     Q_OBJECT
@@ -123,13 +137,20 @@ public:
     BluetoothLink(SharedLinkConfigurationPtr& config);
     virtual ~BluetoothLink();
 
-    // Overrides from QThread
-    void run(void) override;
-
     // LinkConfiguration overrides
     bool isConnected(void) const override;
     void disconnect (void) override;
 
+    /// Read sizes since the link was connected
+    const LinkReadStatistics& readStatistics    (void) const { return _readStatistics; }
+    /// Same histograms for the writes: the writes handed to the link count as reads, the socket writes they were
+    /// coalesced into as deliveries
+    const LinkReadStatistics& writeStatistics   (void) const { return _writeStatistics; }
+
+protected:
+    // QThread overrides
+    void run(void) override;
+
 public slots:
     void    readBytes           (void);
     void    deviceConnected     (void);
@@ -151,12 +172,26 @@ private:
 
     bool _hardwareConnect   (void);
     void _createSocket      (void);
+    void _flushWriteBuffer  (void);
 
-    QBluetoothSocket*                   _targetSocket    = nullptr;
+    BluetoothConfiguration*             _bluetoothConfig    = nullptr;
+    QBluetoothSocket*                   _targetSocket       = nullptr;
 #ifdef __ios__
-    QBluetoothServiceDiscoveryAgent*    _discoveryAgent = nullptr;
+    QBluetoothServiceDiscoveryAgent*    _discoveryAgent     = nullptr;
 #endif
-    bool                                _shutDown       = false;
-    bool                                _connectState   = false;
+    bool                                _shutDown           = false;
+    bool                                _connectState       = false;
+    QByteArray                          _readBuffer;                    ///< Reused across reads to prevent an allocation per read
+    QByteArray                          _writeBuffer;                   ///< Writes held for coalescing
+    QMutex                              _writeBufferMutex;
+    QElapsedTimer                       _writePendingTimer;             ///< Started when the first write is held
+    LinkReadStatistics                  _readStatistics;
+    LinkReadStatistics                  _writeStatistics;
+
+    // Only valid while the link thread is running, it lives on its stack
+    QTimer*                             _flushTimer         = nullptr;
+
+    static const int _coalesceBytes     = 1024;         ///< About the largest RFCOMM frame
+    static const int _readBufferSize    = 16 * 1024;
 };
 
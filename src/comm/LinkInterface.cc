@@ -14,7 +14,11 @@ LinkInterface::LinkInterface(SharedLinkConfigurationPtr& config, bool isPX4Flow)
     : QThread   (0)
     , _config   (config)
     , _isPX4Flow(isPX4Flow)
+    , _sendQueue(_sendQueueSlots, MAVLINK_MAX_PACKET_LEN)
 {
+    // Reserved capacity is kept when the batch is resized to empty
+    _sendBatch.reserve(_sendBatchSize);
+
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
 
     qRegisterMetaType<LinkInterface*>("LinkInterface*");
@@ -47,10 +51,104 @@ void LinkInterface::_setMavlinkChannel(uint8_t channel)
 
 void LinkInterface::writeBytesThreadSafe(const char *bytes, int length)
 {
-    QByteArray byteArray(bytes, length);
-    _writeBytesMutex.lock();
-    _writeBytes(byteArray);
-    _writeBytesMutex.unlock();
+    if (_sendQueue.push(bytes, length)) {
+        // Only post a drain if the link thread hasn't been told yet. The drain clears the flag before it starts.
+        if (!_sendQueueNotifyPending.exchange(true)) {
+            QMetaObject::invokeMethod(this, [this]() { _sendQueueReady(); }, Qt::QueuedConnection);
+        }
+        return;
+    }
+
+    QMutexLocker locker(&_writeBytesMutex);
+    _writeSendQueue();
+    _writeBytes(QByteArray(bytes, length));
+}
+
+/// Shares the buffer with the link instead of copying it when it is too large to queue
+void LinkInterface::writeBytesThreadSafe(const QByteArray& bytes)
+{
+    if (bytes.length() <= _sendQueue.slotSize()) {
+        writeBytesThreadSafe(bytes.constData(), bytes.length());
+        return;
+    }
+
+    QMutexLocker locker(&_writeBytesMutex);
+    _writeSendQueue();
+    _writeBytes(bytes);
+}
+
+void LinkInterface::_sendQueueReady(void)
+{
+    _sendQueueNotifyPending.store(false);
+
+    QMutexLocker locker(&_writeBytesMutex);
+    _writeSendQueue();
+}
+
+/// Writes out everything in the send queue. Must be called with _writeBytesMutex locked.
+void LinkInterface::_writeSendQueue(void)
+{
+    const char* packet;
+    int         length;
+
+    if (_sendQueueKeepsPackets()) {
+        while ((length = _sendQueue.front(&packet)) > 0) {
+            _writeBytes(QByteArray::fromRawData(packet, length));
+            _sendQueue.pop();
+        }
+        return;
+    }
+
+    while ((length = _sendQueue.front(&packet)) > 0) {
+        _sendBatch.append(packet, length);
+        _sendQueue.pop();
+        if (_sendBatch.length() >= _sendBatchSize - MAVLINK_MAX_PACKET_LEN) {
+            _writeBytes(_sendBatch);
+            _sendBatch.resize(0);
+        }
+    }
+    if (!_sendBatch.isEmpty()) {
+        _writeBytes(_sendBatch);
+        _sendBatch.resize(0);
+    }
+}
+
+void LinkInterface::_updateTrafficStatistics(qint64 nowMSecs)
+{
+    _trafficStatistics.update(nowMSecs);
+    emit trafficStatisticsChanged();
+}
+
+void LinkInterface::_enableReceiveRing(void)
+{
+    if (!_receiveRing) {
+        _receiveRing.reset(new QGCByteRingBuffer(_receiveRingSize));
+    }
+}
+
+void LinkInterface::_bytesReceived(const char* bytes, int length)
+{
+    _trafficStatistics.addReceived(length);
+
+    if (!_receiveRing) {
+        emit bytesReceived(this, QByteArray(bytes, length));
+        return;
+    }
+
+    if (!_receiveRing->write(bytes, length)) {
+        // Consumer isn't keeping up, there is nothing better to do than drop the bytes like an overrun uart would
+        if ((_receiveRingOverflowCount++ % 100) == 0) {
+            qWarning() << "Receive ring overflow, dropping bytes" << _config->name() << length << _receiveRingOverflowCount;
+        }
+        // Dropped bytes never make it to the backlog
+        _trafficStatistics.addProcessed(length, 0);
+    }
+
+    // Only signal if the consumer hasn't been told yet. The consumer clears the flag before it drains.
+    if (!_receiveRingNotifyPending.exchange(true)) {
+        _receiveRingReadyUSecs = LinkTrafficStatistics::nowUSecs();
+        emit receiveRingReady(this);
+    }
 }
 
 void LinkInterface::addVehicleReference(void)
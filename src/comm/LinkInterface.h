@@ -18,11 +18,15 @@
 #include <QDebug>
 #include <QTimer>
 
+#include <atomic>
 #include <memory>
 
 #include "QGCMAVLink.h"
 #include "LinkConfiguration.h"
 #include "MavlinkMessagesTimer.h"
+#include "QGCByteRingBuffer.h"
+#include "QGCPacketQueue.h"
+#include "LinkTrafficStatistics.h"
 
 class LinkManager;
 
@@ -42,6 +46,15 @@ public:
     Q_PROPERTY(bool isPX4Flow   READ isPX4Flow  CONSTANT)
     Q_PROPERTY(bool isMockLink  READ isMockLink CONSTANT)
 
+    // Traffic statistics, updated once a second
+    Q_PROPERTY(double   bytesInPerSec           READ bytesInPerSec          NOTIFY trafficStatisticsChanged)
+    Q_PROPERTY(double   bytesOutPerSec          READ bytesOutPerSec         NOTIFY trafficStatisticsChanged)
+    Q_PROPERTY(double   messagesInPerSec        READ messagesInPerSec       NOTIFY trafficStatisticsChanged)
+    Q_PROPERTY(double   writesOutPerSec         READ writesOutPerSec        NOTIFY trafficStatisticsChanged)
+    Q_PROPERTY(qint64   receiveBacklogBytes     READ receiveBacklogBytes    NOTIFY trafficStatisticsChanged)
+    Q_PROPERTY(double   receiveLatencyP50MSecs  READ receiveLatencyP50MSecs NOTIFY trafficStatisticsChanged)
+    Q_PROPERTY(double   receiveLatencyP99MSecs  READ receiveLatencyP99MSecs NOTIFY trafficStatisticsChanged)
+
     // Property accessors
     bool isPX4Flow(void) const { return _isPX4Flow; }
 #ifdef UNITTEST_BUILD
@@ -52,6 +65,17 @@ public:
 
     SharedLinkConfigurationPtr linkConfiguration(void) { return _config; }
 
+    double  bytesInPerSec           (void) const { return _trafficStatistics.bytesInPerSec(); }
+    double  bytesOutPerSec          (void) const { return _trafficStatistics.bytesOutPerSec(); }
+    double  messagesInPerSec        (void) const { return _trafficStatistics.messagesInPerSec(); }
+    double  writesOutPerSec         (void) const { return _trafficStatistics.writesOutPerSec(); }
+    qint64  receiveBacklogBytes     (void) const { return _trafficStatistics.backlogBytes(); }
+    double  receiveLatencyP50MSecs  (void) const { return _trafficStatistics.latencyPercentileUSecs(50) / 1000.0; }
+    double  receiveLatencyP99MSecs  (void) const { return _trafficStatistics.latencyPercentileUSecs(99) / 1000.0; }
+
+    /// Counters are thread safe, see LinkTrafficStatistics
+    LinkTrafficStatistics* trafficStatistics(void) { return &_trafficStatistics; }
+
     Q_INVOKABLE virtual void    disconnect  (void) = 0;
 
     virtual bool isConnected    (void) const = 0;
@@ -60,16 +84,35 @@ public:
     uint8_t mavlinkChannel              (void) const;
     bool    decodedFirstMavlinkPacket   (void) const { return _decodedFirstMavlinkPacket; }
     bool    setDecodedFirstMavlinkPacket(bool decodedFirstMavlinkPacket) { return _decodedFirstMavlinkPacket = decodedFirstMavlinkPacket; }
+    /// Queues the bytes for the thread of the link to write out. Packets which fit in a send queue slot are queued
+    /// without taking a lock. Larger writes, or writes while the queue is full, are written directly after whatever
+    /// is already queued.
     void    writeBytesThreadSafe        (const char *bytes, int length);
+    void    writeBytesThreadSafe        (const QByteArray& bytes);
     void    addVehicleReference         (void);
     void    removeVehicleReference      (void);
 
+    /// Ring which received bytes are placed in when receive ring delivery is enabled, nullptr otherwise.
+    /// Only the thread which handles receiveRingReady may read from it.
+    QGCByteRingBuffer*  receiveRing                 (void) { return _receiveRing.get(); }
+    uint64_t            receiveRingOverflowCount    (void) const { return _receiveRingOverflowCount; }
+
+    /// Must be called by the consumer before it starts draining the receive ring
+    void                receiveRingDrainStarted     (void) { _receiveRingNotifyPending.store(false); }
+
+    /// @return LinkTrafficStatistics::nowUSecs of the read which caused the pending receiveRingReady
+    qint64              receiveRingReadyUSecs       (void) const { return _receiveRingReadyUSecs; }
+
 signals:
     void bytesReceived      (LinkInterface* link, QByteArray data);
+    /// Bytes have been placed in the receive ring. Multiple reads are coalesced into a single signal until the consumer calls receiveRingDrainStarted.
+    void receiveRingReady   (LinkInterface* link);
+    /// The bytes may point into the send queue, so they are only valid during the signal. Connect with Qt::DirectConnection.
     void bytesSent          (LinkInterface* link, QByteArray data);
     void connected          (void);
     void disconnected       (void);
     void communicationError (const QString& title, const QString& error);
+    void trafficStatisticsChanged(void);
 
 protected:
     // Links are only created by LinkManager so constructor is not public
@@ -77,6 +120,11 @@ protected:
 
     void _connectionRemoved(void);
 
+    /// Derived links call this from their read path with newly received bytes. The bytes go to the receive ring
+    /// if it is enabled, otherwise they are emitted through bytesReceived. Must always be called from the same thread.
+    void _bytesReceived(const char* bytes, int length);
+    void _bytesReceived(const QByteArray& bytes) { _bytesReceived(bytes.constData(), bytes.length()); }
+
     SharedLinkConfigurationPtr _config;
 
 private:
@@ -85,8 +133,22 @@ private:
 
     virtual void _writeBytes(const QByteArray) = 0; // Not thread safe, only writeBytesThreadSafe is thread safe
 
+    /// @return true: each queued packet is written with its own _writeBytes call, for links where a write is a datagram.
+    /// The bytes then point into the send queue and are only valid during the call. Otherwise queued packets are
+    /// coalesced into a single write.
+    virtual bool _sendQueueKeepsPackets(void) const { return false; }
+
+    void _sendQueueReady(void);
+    void _writeSendQueue(void);
+
     void _setMavlinkChannel(uint8_t channel);
 
+    /// Called by LinkManager once a second
+    void _updateTrafficStatistics(qint64 nowMSecs);
+
+    /// Switches received byte delivery over to the receive ring. Must be called before the link is connected.
+    void _enableReceiveRing(void);
+
     bool    _mavlinkChannelSet          = false;
     uint8_t _mavlinkChannel;
     bool    _decodedFirstMavlinkPacket  = false;
@@ -95,6 +157,21 @@ private:
 
     mutable QMutex _writeBytesMutex;
 
+    std::unique_ptr<QGCByteRingBuffer>  _receiveRing;
+    std::atomic<bool>                   _receiveRingNotifyPending   { false };
+    uint64_t                            _receiveRingOverflowCount   = 0;
+    std::atomic<qint64>                 _receiveRingReadyUSecs      { 0 };
+
+    LinkTrafficStatistics               _trafficStatistics;
+
+    QGCPacketQueue                      _sendQueue;
+    std::atomic<bool>                   _sendQueueNotifyPending     { false };
+    QByteArray                          _sendBatch;
+
+    static const int _receiveRingSize   = 512 * 1024;
+    static const int _sendQueueSlots    = 256;
+    static const int _sendBatchSize     = 16 * 1024;
+
     QMap<int /* vehicle id */, MavlinkMessagesTimer*> _mavlinkMessagesTimers;
 };
 
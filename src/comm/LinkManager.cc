@@ -11,6 +11,8 @@
 #include <QApplication>
 #include <QDebug>
 #include <QSignalSpy>
+#include <QtConcurrent>
+#include <QRegularExpression>
 
 #include <memory>
 
@@ -50,13 +52,15 @@ const int LinkManager::_autoconnectConnectDelayMSecs =  6000;
 #else
 const int LinkManager::_autoconnectConnectDelayMSecs =  1000;
 #endif
+const int LinkManager::_hotplugSettleMSecs =            250;
+const int LinkManager::_trafficStatisticsUpdateMSecs =  1000;
 
 LinkManager::LinkManager(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
     , _configUpdateSuspended(false)
     , _configurationsLoaded(false)
     , _connectionsSuspended(false)
-    , _mavlinkChannelsUsedBitMask(1)    // We never use channel 0 to avoid sequence numbering problems
+    , _mavlinkChannelsUsed(MAVLINK_COMM_NUM_BUFFERS)
     , _autoConnectSettings(nullptr)
     , _mavlinkProtocol(nullptr)
     #ifndef __mobile__
@@ -72,6 +76,9 @@ LinkManager::LinkManager(QGCApplication* app, QGCToolbox* toolbox)
 
 LinkManager::~LinkManager()
 {
+#ifndef NO_SERIAL_LINK
+    _portEnumerationWatcher.waitForFinished();
+#endif
 #ifndef __mobile__
 #ifndef NO_SERIAL_LINK
     delete _nmeaPort;
@@ -88,6 +95,22 @@ void LinkManager::setToolbox(QGCToolbox *toolbox)
 
     connect(&_portListTimer, &QTimer::timeout, this, &LinkManager::_updateAutoConnectLinks);
     _portListTimer.start(_autoconnectUpdateTimerMSecs); // timeout must be long enough to get past bootloader on second pass
+    _autoconnectClock.start();
+
+    connect(&_trafficStatisticsTimer, &QTimer::timeout, this, &LinkManager::_updateTrafficStatistics);
+    _trafficStatisticsTimer.start(_trafficStatisticsUpdateMSecs);
+
+#ifndef NO_SERIAL_LINK
+    connect(&_portEnumerationWatcher, &QFutureWatcherBase::finished, this, &LinkManager::_serialPortsEnumerated);
+#if defined(Q_OS_LINUX) && !defined(__android__)
+    // Device nodes appear as soon as a usb serial adapter is plugged in, so there is no need to wait for the next poll
+    _hotplugTimer.setSingleShot(true);
+    _hotplugTimer.setInterval(_hotplugSettleMSecs);
+    connect(&_hotplugTimer, &QTimer::timeout, this, &LinkManager::_startSerialPortEnumeration);
+    connect(&_devWatcher, &QFileSystemWatcher::directoryChanged, &_hotplugTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+    _devWatcher.addPath(QStringLiteral("/dev"));
+#endif
+#endif
 
 }
 
@@ -150,8 +173,18 @@ bool LinkManager::createConnectedLink(SharedLinkConfigurationPtr& config, bool i
         config->setLink(link);
 
         connect(link.get(), &LinkInterface::communicationError,  _app,                &QGCApplication::criticalMessageBoxOnMainThread);
-        connect(link.get(), &LinkInterface::bytesReceived,       _mavlinkProtocol,    &MAVLinkProtocol::receiveBytes);
-        connect(link.get(), &LinkInterface::bytesSent,           _mavlinkProtocol,    &MAVLinkProtocol::logSentBytes);
+        // Relays serve many links at once, so they always spread the framing over the link threads
+        if (_app->runningRelay() || _toolbox->settingsManager()->appSettings()->mavlinkDecodeOnLinkThread()->rawValue().toBool()) {
+            // Framing, receive status and logging happen on the thread of the link, messages are dispatched to the main thread in batches
+            connect(link.get(), &LinkInterface::bytesReceived,   _mavlinkProtocol,    &MAVLinkProtocol::receiveBytesOnLinkThread, Qt::DirectConnection);
+        } else {
+            // Links which deliver through _bytesReceived use the receive ring, others still emit bytesReceived directly
+            link->_enableReceiveRing();
+            connect(link.get(), &LinkInterface::receiveRingReady,    _mavlinkProtocol,    &MAVLinkProtocol::drainReceiveRing);
+            connect(link.get(), &LinkInterface::bytesReceived,   _mavlinkProtocol,    &MAVLinkProtocol::receiveBytes);
+        }
+        // Direct since the sent bytes may point into the send queue of the link, logSentBytes is thread safe
+        connect(link.get(), &LinkInterface::bytesSent,           _mavlinkProtocol,    &MAVLinkProtocol::logSentBytes, Qt::DirectConnection);
         connect(link.get(), &LinkInterface::disconnected,        this,                &LinkManager::_linkDisconnected);
 
         _mavlinkProtocol->resetMetadataForLink(link.get());
@@ -167,19 +200,6 @@ bool LinkManager::createConnectedLink(SharedLinkConfigurationPtr& config, bool i
     return false;
 }
 
-SharedLinkInterfacePtr LinkManager::mavlinkForwardingLink()
-{
-    for (int i = 0; i < _rgLinks.count(); i++) {
-        SharedLinkConfigurationPtr linkConfig = _rgLinks[i]->linkConfiguration();
-        if (linkConfig->type() == LinkConfiguration::TypeUdp && linkConfig->name() == _mavlinkForwardingLinkName) {
-            SharedLinkInterfacePtr& link = _rgLinks[i];
-            return link;
-        }
-    }
-
-    return nullptr;
-}
-
 void LinkManager::disconnectAll(void)
 {
     QList<SharedLinkInterfacePtr> links = _rgLinks;
@@ -199,6 +219,8 @@ void LinkManager::_linkDisconnected(void)
 
     disconnect(link, &LinkInterface::communicationError,  _app,                &QGCApplication::criticalMessageBoxOnMainThread);
     disconnect(link, &LinkInterface::bytesReceived,       _mavlinkProtocol,    &MAVLinkProtocol::receiveBytes);
+    disconnect(link, &LinkInterface::bytesReceived,       _mavlinkProtocol,    &MAVLinkProtocol::receiveBytesOnLinkThread);
+    disconnect(link, &LinkInterface::receiveRingReady,    _mavlinkProtocol,    &MAVLinkProtocol::drainReceiveRing);
     disconnect(link, &LinkInterface::bytesSent,           _mavlinkProtocol,    &MAVLinkProtocol::logSentBytes);
     disconnect(link, &LinkInterface::disconnected,        this,                &LinkManager::_linkDisconnected);
 
@@ -390,43 +412,86 @@ void LinkManager::_addUDPAutoConnectLink(void)
     }
 }
 
-void LinkManager::_addMAVLinkForwardingLink(void)
+/// Keeps one UDP link per forwarding target connected
+void LinkManager::_updateMAVLinkForwardingLinks(void)
 {
-    if (_toolbox->settingsManager()->appSettings()->forwardMavlink()->rawValue().toBool()) {
-        bool foundMAVLinkForwardingLink = false;
+    AppSettings*        appSettings = _toolbox->settingsManager()->appSettings();
+    MAVLinkForwarder*   forwarder   = _mavlinkProtocol->forwarder();
 
-        for (int i=0; i<_rgLinks.count(); i++) {
-            SharedLinkConfigurationPtr linkConfig = _rgLinks[i]->linkConfiguration();
-            if (linkConfig->type() == LinkConfiguration::TypeUdp && linkConfig->name() == _mavlinkForwardingLinkName) {
-                foundMAVLinkForwardingLink = true;
-                // TODO: should we check if the host/port matches the mavlinkForwardHostName setting and update if it does not match?
+    if (!appSettings->forwardMavlink()->rawValue().toBool()) {
+        return;
+    }
+
+    QString spec = appSettings->forwardMavlinkHostName()->rawValue().toString();
+    if (spec != forwarder->spec() && spec != _mavlinkForwardingBadSpec) {
+        QList<SharedLinkInterfacePtr> oldLinks;
+        for (int i=0; i<forwarder->targetCount(); i++) {
+            SharedLinkInterfacePtr link = forwarder->targetLink(i);
+            if (link) {
+                oldLinks.append(link);
+            }
+        }
+
+        QString errorString;
+        if (forwarder->setTargets(spec, errorString)) {
+            _mavlinkForwardingBadSpec.clear();
+            for (const SharedLinkInterfacePtr& link: oldLinks) {
+                qCDebug(LinkManagerLog) << "MAVLink forwarding link removed" << link->linkConfiguration()->name();
+                link->disconnect();
+            }
+            if (!oldLinks.isEmpty()) {
+                // New links are created on the next update once the old ones are gone, since they reuse the names
+                return;
+            }
+        } else {
+            // Keep forwarding to the previous targets and only complain once about this spec
+            _mavlinkForwardingBadSpec = spec;
+            qgcApp()->showAppMessage(tr("MAVLink forwarding: %1").arg(errorString));
+        }
+    }
+
+    for (int i=0; i<forwarder->targetCount(); i++) {
+        if (forwarder->targetLink(i)) {
+            continue;
+        }
+
+        // The first target keeps the name used before multiple targets were supported
+        QString linkName = i == 0 ? QString(_mavlinkForwardingLinkName) : QStringLiteral("%1 %2").arg(_mavlinkForwardingLinkName).arg(i + 1);
+        SharedLinkInterfacePtr forwardingLink;
+
+        for (int j=0; j<_rgLinks.count(); j++) {
+            SharedLinkConfigurationPtr linkConfig = _rgLinks[j]->linkConfiguration();
+            if (linkConfig->type() == LinkConfiguration::TypeUdp && linkConfig->name() == linkName) {
+                forwardingLink = _rgLinks[j];
                 break;
             }
         }
 
-        if (!foundMAVLinkForwardingLink) {
-            qCDebug(LinkManagerLog) << "New MAVLink forwarding port added";
+        if (!forwardingLink) {
+            qCDebug(LinkManagerLog) << "New MAVLink forwarding port added" << linkName << forwarder->targetHostName(i);
 
-            UDPConfiguration* udpConfig = new UDPConfiguration(_mavlinkForwardingLinkName);
+            UDPConfiguration* udpConfig = new UDPConfiguration(linkName);
             udpConfig->setDynamic(true);
-
-            QString hostName = _toolbox->settingsManager()->appSettings()->forwardMavlinkHostName()->rawValue().toString();
-            udpConfig->addHost(hostName);
+            udpConfig->addHost(forwarder->targetHostName(i));
 
             SharedLinkConfigurationPtr config = addConfiguration(udpConfig);
-            createConnectedLink(config);
+            if (createConnectedLink(config)) {
+                forwardingLink = _rgLinks.last();
+            }
         }
+
+        forwarder->setTargetLink(i, forwardingLink);
     }
 }
 
 void LinkManager::_updateAutoConnectLinks(void)
 {
-    if (_connectionsSuspended || qgcApp()->runningUnitTests()) {
+    if (_connectionsSuspended || qgcApp()->runningUnitTests() || qgcApp()->runningAnalyze()) {
         return;
     }
 
     _addUDPAutoConnectLink();
-    _addMAVLinkForwardingLink();
+    _updateMAVLinkForwardingLinks();
 
 #ifndef __mobile__
 #ifndef NO_SERIAL_LINK
@@ -453,21 +518,72 @@ void LinkManager::_updateAutoConnectLinks(void)
 #endif
 
 #ifndef NO_SERIAL_LINK
-    QStringList                 currentPorts;
-    QList<QGCSerialPortInfo>    portList;
 #ifdef __android__
     // Android builds only support a single serial connection. Repeatedly calling availablePorts after that one serial
     // port is connected leaks file handles due to a bug somewhere in android serial code. In order to work around that
     // bug after we connect the first serial port we stop probing for additional ports.
     if (!_isSerialPortConnected()) {
-        portList = QGCSerialPortInfo::availablePorts();
+        _updateSerialAutoConnect(QGCSerialPortInfo::availablePorts());
     }
     else {
         qDebug() << "Skipping serial port list";
+        _updateSerialAutoConnect(QList<QGCSerialPortInfo>());
     }
 #else
-    portList = QGCSerialPortInfo::availablePorts();
+    _startSerialPortEnumeration();
 #endif
+#endif // NO_SERIAL_LINK
+}
+
+#ifndef NO_SERIAL_LINK
+/// Enumerating ports can take hundreds of msecs on some systems, so it runs in the background and the results are
+/// handled by _serialPortsEnumerated. Nothing new is started while an enumeration is still running.
+void LinkManager::_startSerialPortEnumeration(void)
+{
+    if (!_portEnumerationWatcher.isRunning()) {
+        _portEnumerationWatcher.setFuture(QtConcurrent::run(&QGCSerialPortInfo::availablePorts));
+    }
+}
+
+void LinkManager::_serialPortsEnumerated(void)
+{
+    // Connections may have been suspended while the enumeration was running
+    if (_connectionsSuspended || qgcApp()->runningUnitTests() || qgcApp()->runningAnalyze()) {
+        return;
+    }
+
+    QList<QGCSerialPortInfo>    portList = _portEnumerationWatcher.result();
+    QStringList                 ports;
+    for (const QGCSerialPortInfo& portInfo: portList) {
+        ports.append(portInfo.systemLocation());
+    }
+
+    if (ports != _enumeratedPorts) {
+        for (const QString& port: ports) {
+            if (!_enumeratedPorts.contains(port)) {
+                qCDebug(LinkManagerLog) << "Serial port added" << port;
+            }
+        }
+        for (const QString& port: _enumeratedPorts) {
+            if (!ports.contains(port)) {
+                qCDebug(LinkManagerLog) << "Serial port removed" << port;
+            }
+        }
+        _enumeratedPorts = ports;
+
+        // Port lists shown by the ui are rebuilt the next time they are read
+        _commPortList.clear();
+        _commPortDisplayList.clear();
+        emit commPortsChanged();
+        emit commPortStringsChanged();
+    }
+
+    _updateSerialAutoConnect(portList);
+}
+
+void LinkManager::_updateSerialAutoConnect(const QList<QGCSerialPortInfo>& portList)
+{
+    QStringList currentPorts;
 
     // Iterate Comm Ports
     for (const QGCSerialPortInfo& portInfo: portList) {
@@ -524,8 +640,9 @@ void LinkManager::_updateAutoConnectLinks(void)
                     // are in the bootloader is flaky from a cross-platform standpoint. So by putting it on a wait list
                     // and only connect on the second pass we leave enough time for the board to boot up.
                     qCDebug(LinkManagerLog) << "Waiting for next autoconnect pass" << portInfo.systemLocation();
-                    _autoconnectPortWaitList[portInfo.systemLocation()] = 1;
-                } else if (++_autoconnectPortWaitList[portInfo.systemLocation()] * _autoconnectUpdateTimerMSecs > _autoconnectConnectDelayMSecs) {
+                    _autoconnectPortWaitList[portInfo.systemLocation()] = _autoconnectClock.elapsed();
+                } else if (_autoconnectClock.elapsed() - _autoconnectPortWaitList[portInfo.systemLocation()] >= _autoconnectConnectDelayMSecs - _autoconnectUpdateTimerMSecs / 10) {
+                    // Timed rather than counted since hotplug passes come in between the regular ones. The slack allows for timer jitter.
                     SerialConfiguration* pSerialConfig = nullptr;
                     _autoconnectPortWaitList.remove(portInfo.systemLocation());
                     switch (boardType) {
@@ -585,9 +702,8 @@ void LinkManager::_updateAutoConnectLinks(void)
         _autoConnectRTKPort.clear();
     }
 #endif
-
-#endif // NO_SERIAL_LINK
 }
+#endif // NO_SERIAL_LINK
 
 void LinkManager::shutdown(void)
 {
@@ -843,13 +959,13 @@ void LinkManager::startAutoConnectedLinks(void)
 int LinkManager::_reserveMavlinkChannel(void)
 {
     // Find a mavlink channel to use for this link, Channel 0 is reserved for internal use.
-    for (uint8_t mavlinkChannel = 1; mavlinkChannel < MAVLINK_COMM_NUM_BUFFERS; mavlinkChannel++) {
-        if (!(_mavlinkChannelsUsedBitMask & 1 << mavlinkChannel)) {
-            mavlink_reset_channel_status(mavlinkChannel);
+    for (int mavlinkChannel = 1; mavlinkChannel < MAVLINK_COMM_NUM_BUFFERS; mavlinkChannel++) {
+        if (!_mavlinkChannelsUsed.testBit(mavlinkChannel)) {
+            mavlink_reset_channel_status(static_cast<uint8_t>(mavlinkChannel));
             // Start the channel on Mav 1 protocol
-            mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
+            mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(static_cast<uint8_t>(mavlinkChannel));
             mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
-            _mavlinkChannelsUsedBitMask |= 1 << mavlinkChannel;
+            _mavlinkChannelsUsed.setBit(mavlinkChannel);
             return mavlinkChannel;
         }
     }
@@ -858,7 +974,7 @@ int LinkManager::_reserveMavlinkChannel(void)
 
 void LinkManager::_freeMavlinkChannel(int channel)
 {
-    _mavlinkChannelsUsedBitMask &= ~(1 << channel);
+    _mavlinkChannelsUsed.clearBit(channel);
 }
 
 LogReplayLink* LinkManager::startLogReplay(const QString& logFile)
@@ -885,3 +1001,68 @@ bool LinkManager::_isSerialPortConnected(void)
 
     return false;
 }
+
+void LinkManager::_updateTrafficStatistics(void)
+{
+    qint64 nowMSecs = _autoconnectClock.elapsed();
+
+    for (const SharedLinkInterfacePtr& sharedLink: _rgLinks) {
+        sharedLink->_updateTrafficStatistics(nowMSecs);
+    }
+}
+
+QString LinkManager::trafficStatisticsPrometheus(void)
+{
+    LinkTrafficStatistics::NamedStatistics_t namedStatistics;
+
+    for (const SharedLinkInterfacePtr& sharedLink: _rgLinks) {
+        namedStatistics.append(qMakePair(sharedLink->linkConfiguration()->name(), static_cast<const LinkTrafficStatistics*>(sharedLink->trafficStatistics())));
+    }
+
+    QString                         text        = LinkTrafficStatistics::prometheusText(namedStatistics);
+    const MAVLinkMessageStatistics* statistics  = _mavlinkProtocol->messageStatistics();
+    quint64                         nowMSecs    = QGC::bootTimeMilliseconds();
+
+    text += QStringLiteral("# HELP qgc_link_message_bandwidth_share Fraction of the received bytes of the link taken by the message id\n# TYPE qgc_link_message_bandwidth_share gauge\n");
+    for (const SharedLinkInterfacePtr& sharedLink: _rgLinks) {
+        uint8_t                         channel         = sharedLink->mavlinkChannel();
+        MAVLinkMessageStatistics::Stats_t channelStats  = statistics->channelStats(channel, nowMSecs);
+        QString                         label           = LinkTrafficStatistics::prometheusLabel(sharedLink->linkConfiguration()->name());
+
+        if (channelStats.bytesPerSec <= 0) {
+            continue;
+        }
+        const QHash<uint32_t, MAVLinkMessageStatistics::Stats_t> messageStats = statistics->channelMessageStats(channel, nowMSecs);
+        for (auto it = messageStats.constBegin(); it != messageStats.constEnd(); ++it) {
+            text += QStringLiteral("qgc_link_message_bandwidth_share{%1,msgid=\"%2\"} %3\n").arg(label).arg(it.key()).arg(it.value().bytesPerSec / channelStats.bytesPerSec);
+        }
+    }
+
+    return text;
+}
+
+QString LinkManager::trafficStatisticsStatsD(const QString& prefix)
+{
+    static const QRegularExpression unsafeCharacters(QStringLiteral("[^A-Za-z0-9_]"));
+
+    QString                         text;
+    const MAVLinkMessageStatistics* statistics  = _mavlinkProtocol->messageStatistics();
+    quint64                         nowMSecs    = QGC::bootTimeMilliseconds();
+
+    for (const SharedLinkInterfacePtr& sharedLink: _rgLinks) {
+        QString linkPrefix = QStringLiteral("%1.link.%2").arg(prefix, sharedLink->linkConfiguration()->name().replace(unsafeCharacters, QStringLiteral("_")));
+        sharedLink->trafficStatistics()->appendStatsD(text, linkPrefix);
+
+        uint8_t                             channel         = sharedLink->mavlinkChannel();
+        MAVLinkMessageStatistics::Stats_t   channelStats    = statistics->channelStats(channel, nowMSecs);
+        if (channelStats.bytesPerSec <= 0) {
+            continue;
+        }
+        const QHash<uint32_t, MAVLinkMessageStatistics::Stats_t> messageStats = statistics->channelMessageStats(channel, nowMSecs);
+        for (auto it = messageStats.constBegin(); it != messageStats.constEnd(); ++it) {
+            text += QStringLiteral("%1.message.%2.bandwidth_share:%3|g\n").arg(linkPrefix).arg(it.key()).arg(it.value().bytesPerSec / channelStats.bytesPerSec);
+        }
+    }
+
+    return text;
+}
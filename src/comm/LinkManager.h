@@ -9,6 +9,10 @@
 
 #pragma once
 
+#include <QBitArray>
+#include <QElapsedTimer>
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
 #include <QList>
 #include <QMultiMap>
 #include <QMutex>
@@ -26,6 +30,7 @@
 
 #ifndef NO_SERIAL_LINK
     #include "SerialLink.h"
+    #include "QGCSerialPortInfo.h"
 #endif
 
 Q_DECLARE_LOGGING_CATEGORY(LinkManagerLog)
@@ -70,6 +75,13 @@ public:
 
     Q_INVOKABLE LogReplayLink* startLogReplay(const QString& logFile);
 
+    /// @return Traffic statistics of all links, with the bandwidth share of each message id, in the Prometheus text
+    /// exposition format. For a ground station daemon to serve to a scraper or write out for a textfile collector.
+    Q_INVOKABLE QString trafficStatisticsPrometheus(void);
+
+    /// @return Traffic rates of all links, with the bandwidth share of each message id, as StatsD gauges
+    Q_INVOKABLE QString trafficStatisticsStatsD(const QString& prefix = QStringLiteral("qgc"));
+
     // Property accessors
 
     bool isBluetoothAvailable       (void);
@@ -99,9 +111,6 @@ public:
     // This should only be used by Qml code
     Q_INVOKABLE void createConnectedLink(LinkConfiguration* config);
 
-    /// Returns pointer to the mavlink forwarding link, or nullptr if it does not exist
-    SharedLinkInterfacePtr mavlinkForwardingLink();
-
     void disconnectAll(void);
 
 #ifdef QT_DEBUG
@@ -142,16 +151,20 @@ private:
     QmlObjectListModel* _qmlLinkConfigurations      (void) { return &_qmlConfigurations; }
     bool                _connectionsSuspendedMsg    (void);
     void                _updateAutoConnectLinks     (void);
+    void                _updateTrafficStatistics    (void);
     void                _updateSerialPorts          (void);
     void                _fixUnnamed                 (LinkConfiguration* config);
     void                _removeConfiguration        (LinkConfiguration* config);
     void                _addUDPAutoConnectLink      (void);
-    void                _addMAVLinkForwardingLink   (void);
+    void                _updateMAVLinkForwardingLinks(void);
     void                _freeMavlinkChannel         (int channel);
     bool                _isSerialPortConnected      (void);
 
 #ifndef NO_SERIAL_LINK
     bool                _portAlreadyConnected       (const QString& portName);
+    void                _startSerialPortEnumeration (void);
+    void                _serialPortsEnumerated      (void);
+    void                _updateSerialAutoConnect    (const QList<QGCSerialPortInfo>& portList);
 #endif
 
     bool                                _configUpdateSuspended;                     ///< true: stop updating configuration list
@@ -159,7 +172,8 @@ private:
     bool                                _connectionsSuspended;                      ///< true: all new connections should not be allowed
     QString                             _connectionsSuspendedReason;                ///< User visible reason for suspension
     QTimer                              _portListTimer;
-    uint32_t                            _mavlinkChannelsUsedBitMask;
+    QTimer                              _trafficStatisticsTimer;
+    QBitArray                           _mavlinkChannelsUsed;
 
     AutoConnectSettings*                _autoConnectSettings;
     MAVLinkProtocol*                    _mavlinkProtocol;
@@ -169,12 +183,18 @@ private:
     QString                             _autoConnectRTKPort;
     QmlObjectListModel                  _qmlConfigurations;
 
-    QMap<QString, int>                  _autoconnectPortWaitList;               ///< key: QGCSerialPortInfo::systemLocation, value: wait count
+    QMap<QString, qint64>               _autoconnectPortWaitList;               ///< key: QGCSerialPortInfo::systemLocation, value: _autoconnectClock msecs when first seen
+    QElapsedTimer                       _autoconnectClock;
     QStringList                         _commPortList;
     QStringList                         _commPortDisplayList;
+    QString                             _mavlinkForwardingBadSpec;              ///< Last invalid forwarding target spec, so it is only reported once
 
 #ifndef NO_SERIAL_LINK
     QList<SerialLink*>                  _activeLinkCheckList;                   ///< List of links we are waiting for a vehicle to show up on
+    QFutureWatcher<QList<QGCSerialPortInfo>> _portEnumerationWatcher;           ///< Serial port enumeration running in the background
+    QStringList                         _enumeratedPorts;                       ///< System locations from the last enumeration, for diffing
+    QFileSystemWatcher                  _devWatcher;                            ///< Hotplug notification, watches /dev on Linux
+    QTimer                              _hotplugTimer;                          ///< Lets a burst of device node changes settle before enumerating
 #endif
 
     // NMEA GPS device for GCS position
@@ -191,6 +211,8 @@ private:
     static const char*  _mavlinkForwardingLinkName;
     static const int    _autoconnectUpdateTimerMSecs;
     static const int    _autoconnectConnectDelayMSecs;
+    static const int    _hotplugSettleMSecs;
+    static const int    _trafficStatisticsUpdateMSecs;
 
 };
 
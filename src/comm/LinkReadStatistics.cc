@@ -0,0 +1,62 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinkReadStatistics.h"
+
+#include <QStringList>
+
+LinkReadStatistics::LinkReadStatistics(void)
+{
+    reset();
+}
+
+int LinkReadStatistics::bucket(qint64 value)
+{
+    int index = 0;
+    while (value > 0 && index < bucketCount - 1) {
+        value >>= 1;
+        index++;
+    }
+    return index;
+}
+
+void LinkReadStatistics::addRead(int bytes)
+{
+    _readSizes[bucket(bytes)]++;
+}
+
+void LinkReadStatistics::addDelivery(int bytes, qint64 latencyUSecs)
+{
+    _deliverySizes[bucket(bytes)]++;
+    _deliveryLatencies[bucket(latencyUSecs)]++;
+}
+
+void LinkReadStatistics::reset(void)
+{
+    _readSizes.fill(0, bucketCount);
+    _deliverySizes.fill(0, bucketCount);
+    _deliveryLatencies.fill(0, bucketCount);
+}
+
+QString LinkReadStatistics::toString(void) const
+{
+    return QStringLiteral("read bytes [%1] delivered bytes [%2] latency usecs [%3]").arg(_histogramString(_readSizes), _histogramString(_deliverySizes), _histogramString(_deliveryLatencies));
+}
+
+/// Buckets are labeled with their lower bound
+QString LinkReadStatistics::_histogramString(const QVector<quint64>& histogram)
+{
+    QStringList buckets;
+    for (int i=0; i<histogram.count(); i++) {
+        if (histogram[i]) {
+            buckets.append(QStringLiteral("%1:%2").arg(i == 0 ? 0 : (1LL << (i - 1))).arg(histogram[i]));
+        }
+    }
+    return buckets.join(' ');
+}
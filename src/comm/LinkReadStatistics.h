@@ -0,0 +1,46 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+/// Power of two histograms of the read sizes and delivery latencies of a link, for tuning read coalescing.
+/// Bucket 0 counts zero values, bucket n counts values from 2^(n-1) up to 2^n - 1. The last bucket also counts anything larger.
+class LinkReadStatistics
+{
+public:
+    LinkReadStatistics(void);
+
+    static const int bucketCount = 20;
+
+    /// Counts a single read from the device
+    void addRead        (int bytes);
+    /// Counts a single delivery of coalesced bytes
+    ///     @param latencyUSecs Time from the first byte of the delivery being read until it was delivered
+    void addDelivery    (int bytes, qint64 latencyUSecs);
+    void reset          (void);
+
+    const QVector<quint64>& readSizes           (void) const { return _readSizes; }
+    const QVector<quint64>& deliverySizes       (void) const { return _deliverySizes; }
+    const QVector<quint64>& deliveryLatencies   (void) const { return _deliveryLatencies; }
+
+    /// @return Non-empty buckets of all histograms in a single line for logging
+    QString toString(void) const;
+
+    static int bucket(qint64 value);
+
+private:
+    static QString _histogramString(const QVector<quint64>& histogram);
+
+    QVector<quint64> _readSizes;
+    QVector<quint64> _deliverySizes;
+    QVector<quint64> _deliveryLatencies;
+};
@@ -0,0 +1,43 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinkReadStatisticsTest.h"
+#include "LinkReadStatistics.h"
+
+void LinkReadStatisticsTest::_bucketTest(void)
+{
+    QCOMPARE(LinkReadStatistics::bucket(0), 0);
+    QCOMPARE(LinkReadStatistics::bucket(1), 1);
+    QCOMPARE(LinkReadStatistics::bucket(2), 2);
+    QCOMPARE(LinkReadStatistics::bucket(3), 2);
+    QCOMPARE(LinkReadStatistics::bucket(4), 3);
+    QCOMPARE(LinkReadStatistics::bucket(280), 9);
+
+    // Anything too large ends up in the last bucket
+    QCOMPARE(LinkReadStatistics::bucket(Q_INT64_C(1) << 40), static_cast<int>(LinkReadStatistics::bucketCount) - 1);
+}
+
+void LinkReadStatisticsTest::_histogramTest(void)
+{
+    LinkReadStatistics statistics;
+
+    statistics.addRead(1);
+    statistics.addRead(1);
+    statistics.addRead(300);
+    statistics.addDelivery(302, 1500);
+
+    QCOMPARE(statistics.readSizes()[1], static_cast<quint64>(2));
+    QCOMPARE(statistics.readSizes()[9], static_cast<quint64>(1));
+    QCOMPARE(statistics.deliverySizes()[9], static_cast<quint64>(1));
+    QCOMPARE(statistics.deliveryLatencies()[11], static_cast<quint64>(1));
+    QCOMPARE(statistics.toString(), QStringLiteral("read bytes [1:2 256:1] delivered bytes [256:1] latency usecs [1024:1]"));
+
+    statistics.reset();
+    QCOMPARE(statistics.toString(), QStringLiteral("read bytes [] delivered bytes [] latency usecs []"));
+}
@@ -0,0 +1,191 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinkTrafficStatistics.h"
+
+#include <QElapsedTimer>
+
+LinkTrafficStatistics::LinkTrafficStatistics(void)
+{
+    for (int i=0; i<latencyBucketCount; i++) {
+        _latencyBuckets[i] = 0;
+    }
+}
+
+qint64 LinkTrafficStatistics::nowUSecs(void)
+{
+    // Started on first use, which is thread safe for a function local static
+    static const QElapsedTimer clock = []() { QElapsedTimer timer; timer.start(); return timer; }();
+
+    return clock.nsecsElapsed() / 1000;
+}
+
+int LinkTrafficStatistics::latencyBucket(qint64 latencyUSecs)
+{
+    int bucket = 0;
+
+    while (latencyUSecs > 0 && bucket < latencyBucketCount - 1) {
+        latencyUSecs >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+void LinkTrafficStatistics::addLatency(qint64 latencyUSecs)
+{
+    _latencyBuckets[latencyBucket(latencyUSecs)]++;
+}
+
+void LinkTrafficStatistics::_addBacklog(qint64 bytes)
+{
+    qint64 backlogBytes     = (_backlogBytes += bytes);
+    qint64 maxBacklogBytes  = _maxBacklogBytes;
+
+    // A failed exchange reloads maxBacklogBytes, so this only loops while another thread is raising it at the same time
+    while (backlogBytes > maxBacklogBytes && !_maxBacklogBytes.compare_exchange_weak(maxBacklogBytes, backlogBytes)) {
+        continue;
+    }
+}
+
+void LinkTrafficStatistics::update(qint64 nowMSecs)
+{
+    quint64 bytesIn     = _bytesIn;
+    quint64 bytesOut    = _bytesOut;
+    quint64 messagesIn  = _messagesIn;
+    quint64 writesOut   = _writesOut;
+
+    if (_lastUpdateMSecs != -1 && nowMSecs > _lastUpdateMSecs) {
+        double elapsedSecs = (nowMSecs - _lastUpdateMSecs) / 1000.0;
+
+        _bytesInPerSec      = (bytesIn - _lastBytesIn) / elapsedSecs;
+        _bytesOutPerSec     = (bytesOut - _lastBytesOut) / elapsedSecs;
+        _messagesInPerSec   = (messagesIn - _lastMessagesIn) / elapsedSecs;
+        _writesOutPerSec    = (writesOut - _lastWritesOut) / elapsedSecs;
+    }
+
+    _lastUpdateMSecs    = nowMSecs;
+    _lastBytesIn        = bytesIn;
+    _lastBytesOut       = bytesOut;
+    _lastMessagesIn     = messagesIn;
+    _lastWritesOut      = writesOut;
+}
+
+QVector<quint64> LinkTrafficStatistics::latencyHistogram(void) const
+{
+    QVector<quint64> histogram(latencyBucketCount);
+
+    for (int i=0; i<latencyBucketCount; i++) {
+        histogram[i] = _latencyBuckets[i];
+    }
+
+    return histogram;
+}
+
+qint64 LinkTrafficStatistics::latencyPercentileUSecs(double percentile) const
+{
+    QVector<quint64>    histogram   = latencyHistogram();
+    quint64             total       = 0;
+
+    for (quint64 count: histogram) {
+        total += count;
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    quint64 target  = static_cast<quint64>(total * percentile / 100.0);
+    quint64 seen    = 0;
+    for (int i=0; i<latencyBucketCount; i++) {
+        seen += histogram[i];
+        if (seen > target || i == latencyBucketCount - 1) {
+            return i == 0 ? 0 : (Q_INT64_C(1) << i) - 1;
+        }
+    }
+
+    return 0;
+}
+
+QString LinkTrafficStatistics::prometheusLabel(const QString& linkName)
+{
+    QString escaped = linkName;
+    escaped.replace('\\', QStringLiteral("\\\\")).replace('"', QStringLiteral("\\\"")).replace('\n', QStringLiteral("\\n"));
+    return QStringLiteral("link=\"%1\"").arg(escaped);
+}
+
+QString LinkTrafficStatistics::prometheusText(const NamedStatistics_t& links)
+{
+    typedef struct {
+        const char* name;
+        const char* type;
+        const char* help;
+        quint64 (LinkTrafficStatistics::*value)(void) const;
+    } Counter_t;
+
+    static const Counter_t counters[] = {
+        { "qgc_link_received_bytes_total",      "counter",  "Bytes read from the link",                 &LinkTrafficStatistics::bytesIn },
+        { "qgc_link_sent_bytes_total",          "counter",  "Bytes written to the link",                &LinkTrafficStatistics::bytesOut },
+        { "qgc_link_received_messages_total",   "counter",  "MAVLink messages decoded from the link",   &LinkTrafficStatistics::messagesIn },
+        { "qgc_link_writes_total",              "counter",  "Writes to the link",                       &LinkTrafficStatistics::writesOut },
+    };
+
+    QString text;
+
+    // Each metric family is written in one piece as the format requires
+    for (const Counter_t& counter: counters) {
+        text += QStringLiteral("# HELP %1 %2\n# TYPE %1 %3\n").arg(counter.name, counter.help, counter.type);
+        for (const auto& link: links) {
+            text += QStringLiteral("%1{%2} %3\n").arg(counter.name, prometheusLabel(link.first)).arg((link.second->*counter.value)());
+        }
+    }
+
+    text += QStringLiteral("# HELP qgc_link_receive_backlog_bytes Bytes read but not processed yet\n# TYPE qgc_link_receive_backlog_bytes gauge\n");
+    for (const auto& link: links) {
+        text += QStringLiteral("qgc_link_receive_backlog_bytes{%1} %2\n").arg(prometheusLabel(link.first)).arg(link.second->backlogBytes());
+    }
+    text += QStringLiteral("# HELP qgc_link_receive_backlog_max_bytes Largest receive backlog\n# TYPE qgc_link_receive_backlog_max_bytes gauge\n");
+    for (const auto& link: links) {
+        text += QStringLiteral("qgc_link_receive_backlog_max_bytes{%1} %2\n").arg(prometheusLabel(link.first)).arg(link.second->maxBacklogBytes());
+    }
+
+    // Cumulative buckets in seconds. The sum isn't tracked, so it is estimated from the bucket midpoints.
+    text += QStringLiteral("# HELP qgc_link_receive_latency_seconds Time from a read to the end of the dispatch of its messages\n# TYPE qgc_link_receive_latency_seconds histogram\n");
+    for (const auto& link: links) {
+        QString             label       = prometheusLabel(link.first);
+        QVector<quint64>    histogram   = link.second->latencyHistogram();
+        quint64             count       = 0;
+        double              sumSecs     = 0;
+
+        for (int i=0; i<latencyBucketCount; i++) {
+            count += histogram[i];
+            if (i != 0) {
+                sumSecs += histogram[i] * (1.5 * (Q_INT64_C(1) << (i - 1))) / 1e6;
+            }
+            if (i != latencyBucketCount - 1) {
+                text += QStringLiteral("qgc_link_receive_latency_seconds_bucket{%1,le=\"%2\"} %3\n").arg(label).arg(((Q_INT64_C(1) << i) - 1) / 1e6).arg(count);
+            }
+        }
+        text += QStringLiteral("qgc_link_receive_latency_seconds_bucket{%1,le=\"+Inf\"} %2\n").arg(label).arg(count);
+        text += QStringLiteral("qgc_link_receive_latency_seconds_sum{%1} %2\n").arg(label).arg(sumSecs);
+        text += QStringLiteral("qgc_link_receive_latency_seconds_count{%1} %2\n").arg(label).arg(count);
+    }
+
+    return text;
+}
+
+void LinkTrafficStatistics::appendStatsD(QString& text, const QString& prefix) const
+{
+    text += QStringLiteral("%1.received_bytes_per_sec:%2|g\n").arg(prefix).arg(bytesInPerSec());
+    text += QStringLiteral("%1.sent_bytes_per_sec:%2|g\n").arg(prefix).arg(bytesOutPerSec());
+    text += QStringLiteral("%1.received_messages_per_sec:%2|g\n").arg(prefix).arg(messagesInPerSec());
+    text += QStringLiteral("%1.writes_per_sec:%2|g\n").arg(prefix).arg(writesOutPerSec());
+    text += QStringLiteral("%1.receive_backlog_bytes:%2|g\n").arg(prefix).arg(backlogBytes());
+    text += QStringLiteral("%1.receive_latency_p50_usecs:%2|g\n").arg(prefix).arg(latencyPercentileUSecs(50));
+    text += QStringLiteral("%1.receive_latency_p99_usecs:%2|g\n").arg(prefix).arg(latencyPercentileUSecs(99));
+}
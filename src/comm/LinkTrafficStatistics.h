@@ -0,0 +1,99 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+
+/// Traffic accounting for a single link, cheap enough to always be on. The counters are atomics which are bumped by
+/// whichever thread does the work, the link thread for reads and writes and the main thread for processing. Rates are
+/// worked out by update, which is called on the main thread once a second.
+///
+/// The receive backlog is the bytes which the link has read but the main thread has not processed yet, whether they
+/// are waiting in the receive ring or in queued signals. The receive latency histogram goes from the read to the end of
+/// the dispatch of the resulting messages to the vehicles, bucket n counts latencies from 2^(n-1) up to 2^n - 1 usecs.
+class LinkTrafficStatistics
+{
+public:
+    LinkTrafficStatistics(void);
+
+    static const int latencyBucketCount = 24;   ///< Last bucket starts at ~4 secs
+
+    /// @return Microseconds on a clock shared by all threads, for latency start times
+    static qint64 nowUSecs(void);
+
+    /// Counts bytes read from the device, which are then part of the backlog until processed
+    void addReceived    (int bytes)                 { _bytesIn += static_cast<quint64>(bytes); _addBacklog(bytes); }
+    /// Counts bytes which were processed, along with the messages decoded from them
+    void addProcessed   (int bytes, int messages)   { _addBacklog(-bytes); _messagesIn += static_cast<quint64>(messages); }
+    /// Counts a single write to the device
+    void addSent        (int bytes)                 { _bytesOut += static_cast<quint64>(bytes); _writesOut++; }
+    /// Counts the latency from a read to the end of the dispatch of its messages
+    void addLatency     (qint64 latencyUSecs);
+
+    /// Works out the rates since the previous update. Main thread only.
+    void update(qint64 nowMSecs);
+
+    quint64 bytesIn             (void) const { return _bytesIn; }
+    quint64 bytesOut            (void) const { return _bytesOut; }
+    quint64 messagesIn          (void) const { return _messagesIn; }
+    quint64 writesOut           (void) const { return _writesOut; }
+    qint64  backlogBytes        (void) const { return _backlogBytes; }
+    qint64  maxBacklogBytes     (void) const { return _maxBacklogBytes; }
+
+    double  bytesInPerSec       (void) const { return _bytesInPerSec; }
+    double  bytesOutPerSec      (void) const { return _bytesOutPerSec; }
+    double  messagesInPerSec    (void) const { return _messagesInPerSec; }
+    double  writesOutPerSec     (void) const { return _writesOutPerSec; }
+
+    QVector<quint64> latencyHistogram(void) const;
+
+    /// @return Upper bound of the histogram bucket holding the percentile, 0 if nothing has been counted
+    qint64 latencyPercentileUSecs(double percentile) const;
+
+    static int latencyBucket(qint64 latencyUSecs);
+
+    typedef QList<QPair<QString /* link name */, const LinkTrafficStatistics*>> NamedStatistics_t;
+
+    /// @return Counters, backlog and latency histogram of the links in the Prometheus text exposition format
+    static QString prometheusText(const NamedStatistics_t& links);
+
+    /// @return Escaped link label for a Prometheus sample
+    static QString prometheusLabel(const QString& linkName);
+
+    /// Appends the rates and backlog as StatsD gauges, one per line
+    void appendStatsD(QString& text, const QString& prefix) const;
+
+private:
+    void _addBacklog(qint64 bytes);
+
+    std::atomic<quint64>    _bytesIn            { 0 };
+    std::atomic<quint64>    _bytesOut           { 0 };
+    std::atomic<quint64>    _messagesIn         { 0 };
+    std::atomic<quint64>    _writesOut          { 0 };
+    std::atomic<qint64>     _backlogBytes       { 0 };
+    std::atomic<qint64>     _maxBacklogBytes    { 0 };
+    std::atomic<quint64>    _latencyBuckets[latencyBucketCount];
+
+    // Only used by update on the main thread
+    qint64  _lastUpdateMSecs    = -1;
+    quint64 _lastBytesIn        = 0;
+    quint64 _lastBytesOut       = 0;
+    quint64 _lastMessagesIn     = 0;
+    quint64 _lastWritesOut      = 0;
+    double  _bytesInPerSec      = 0;
+    double  _bytesOutPerSec     = 0;
+    double  _messagesInPerSec   = 0;
+    double  _writesOutPerSec    = 0;
+};
@@ -0,0 +1,99 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LinkTrafficStatisticsTest.h"
+#include "LinkTrafficStatistics.h"
+
+void LinkTrafficStatisticsTest::_backlogTest(void)
+{
+    LinkTrafficStatistics statistics;
+
+    statistics.addReceived(100);
+    statistics.addReceived(50);
+    QCOMPARE(statistics.backlogBytes(), static_cast<qint64>(150));
+
+    statistics.addProcessed(120, 4);
+    QCOMPARE(statistics.backlogBytes(), static_cast<qint64>(30));
+    QCOMPARE(statistics.maxBacklogBytes(), static_cast<qint64>(150));
+    QCOMPARE(statistics.bytesIn(), static_cast<quint64>(150));
+    QCOMPARE(statistics.messagesIn(), static_cast<quint64>(4));
+}
+
+void LinkTrafficStatisticsTest::_rateTest(void)
+{
+    LinkTrafficStatistics statistics;
+
+    // Nothing to compare against on the first update
+    statistics.update(1000);
+    QCOMPARE(statistics.bytesInPerSec(), 0.0);
+
+    statistics.addReceived(1000);
+    statistics.addProcessed(1000, 10);
+    statistics.addSent(300);
+    statistics.addSent(200);
+    statistics.update(3000);
+
+    QCOMPARE(statistics.bytesInPerSec(), 500.0);
+    QCOMPARE(statistics.messagesInPerSec(), 5.0);
+    QCOMPARE(statistics.bytesOutPerSec(), 250.0);
+    QCOMPARE(statistics.writesOutPerSec(), 1.0);
+
+    statistics.update(4000);
+    QCOMPARE(statistics.bytesInPerSec(), 0.0);
+}
+
+void LinkTrafficStatisticsTest::_latencyTest(void)
+{
+    LinkTrafficStatistics statistics;
+
+    QCOMPARE(LinkTrafficStatistics::latencyBucket(0), 0);
+    QCOMPARE(LinkTrafficStatistics::latencyBucket(1), 1);
+    QCOMPARE(LinkTrafficStatistics::latencyBucket(3), 2);
+    QCOMPARE(LinkTrafficStatistics::latencyBucket(4), 3);
+    QCOMPARE(LinkTrafficStatistics::latencyBucket(Q_INT64_C(1) << 40), LinkTrafficStatistics::latencyBucketCount - 1);
+    QCOMPARE(statistics.latencyPercentileUSecs(50), static_cast<qint64>(0));
+
+    // 98 fast deliveries and two slow ones
+    for (int i=0; i<98; i++) {
+        statistics.addLatency(100);
+    }
+    statistics.addLatency(50000);
+    statistics.addLatency(50000);
+
+    QCOMPARE(statistics.latencyPercentileUSecs(50), static_cast<qint64>(127));
+    QCOMPARE(statistics.latencyPercentileUSecs(99), static_cast<qint64>(65535));
+    QCOMPARE(statistics.latencyHistogram()[LinkTrafficStatistics::latencyBucket(100)], static_cast<quint64>(98));
+}
+
+void LinkTrafficStatisticsTest::_prometheusTest(void)
+{
+    LinkTrafficStatistics statistics1;
+    LinkTrafficStatistics statistics2;
+
+    statistics1.addReceived(10);
+    statistics2.addReceived(20);
+    statistics2.addLatency(100);
+
+    LinkTrafficStatistics::NamedStatistics_t links;
+    links.append(qMakePair(QStringLiteral("Serial \"1\""), static_cast<const LinkTrafficStatistics*>(&statistics1)));
+    links.append(qMakePair(QStringLiteral("UDP"), static_cast<const LinkTrafficStatistics*>(&statistics2)));
+
+    QString text = LinkTrafficStatistics::prometheusText(links);
+    QVERIFY(text.contains(QStringLiteral("qgc_link_received_bytes_total{link=\"Serial \\\"1\\\"\"} 10\n")));
+    QVERIFY(text.contains(QStringLiteral("qgc_link_received_bytes_total{link=\"UDP\"} 20\n")));
+    QVERIFY(text.contains(QStringLiteral("qgc_link_receive_latency_seconds_count{link=\"UDP\"} 1\n")));
+    QVERIFY(text.contains(QStringLiteral("qgc_link_receive_latency_seconds_bucket{link=\"UDP\",le=\"+Inf\"} 1\n")));
+
+    // Samples of a metric family for all links follow its TYPE line without anything in between
+    int typeIndex = text.indexOf(QStringLiteral("# TYPE qgc_link_received_bytes_total counter\n"));
+    QVERIFY(typeIndex != -1);
+    QStringList lines = text.mid(typeIndex).split('\n');
+    QVERIFY(lines[1].startsWith(QStringLiteral("qgc_link_received_bytes_total{")));
+    QVERIFY(lines[2].startsWith(QStringLiteral("qgc_link_received_bytes_total{")));
+}
@@ -16,7 +16,8 @@
 #include <QtEndian>
 #include <QSignalSpy>
 
-const char*  LogReplayLinkConfiguration::_logFilenameKey = "logFilename";
+const char*  LogReplayLinkConfiguration::_logFilenameKey          = "logFilename";
+const char*  LogReplayLinkConfiguration::_rateLimitFactGroupsKey  = "rateLimitFactGroups";
 
 LogReplayLinkConfiguration::LogReplayLinkConfiguration(const QString& name)
     : LinkConfiguration(name)
@@ -27,7 +28,9 @@ LogReplayLinkConfiguration::LogReplayLinkConfiguration(const QString& name)
 LogReplayLinkConfiguration::LogReplayLinkConfiguration(LogReplayLinkConfiguration* copy)
     : LinkConfiguration(copy)
 {
-    _logFilename = copy->logFilename();
+    _logFilename            = copy->logFilename();
+    _rateLimitFactGroups    = copy->rateLimitFactGroups();
+    _playOnConnect          = copy->playOnConnect();
 }
 
 void LogReplayLinkConfiguration::copyFrom(LinkConfiguration *source)
@@ -35,7 +38,9 @@ void LogReplayLinkConfiguration::copyFrom(LinkConfiguration *source)
     LinkConfiguration::copyFrom(source);
     auto* ssource = qobject_cast<LogReplayLinkConfiguration*>(source);
     if (ssource) {
-        _logFilename = ssource->logFilename();
+        _logFilename            = ssource->logFilename();
+        _rateLimitFactGroups    = ssource->rateLimitFactGroups();
+        _playOnConnect          = ssource->playOnConnect();
     } else {
         qWarning() << "Internal error";
     }
@@ -45,6 +50,7 @@ void LogReplayLinkConfiguration::saveSettings(QSettings& settings, const QString
 {
     settings.beginGroup(root);
     settings.setValue(_logFilenameKey, _logFilename);
+    settings.setValue(_rateLimitFactGroupsKey, _rateLimitFactGroups);
     settings.endGroup();
 }
 
@@ -52,6 +58,7 @@ void LogReplayLinkConfiguration::loadSettings(QSettings& settings, const QString
 {
     settings.beginGroup(root);
     _logFilename = settings.value(_logFilenameKey, "").toString();
+    _rateLimitFactGroups = settings.value(_rateLimitFactGroupsKey, true).toBool();
     settings.endGroup();
 }
 
@@ -65,6 +72,7 @@ LogReplayLink::LogReplayLink(SharedLinkConfigurationPtr& config)
     : LinkInterface     (config)
     , _logReplayConfig  (qobject_cast<LogReplayLinkConfiguration*>(config.get()))
     , _connected        (false)
+    , _logStartTimeUSecs(0)
     , _playbackSpeed    (1)
 {
     if (!_logReplayConfig) {
@@ -125,7 +133,9 @@ void LogReplayLink::run(void)
     emit connected();
     
     // Start playback
-    _play();
+    if (_logReplayConfig->playOnConnect()) {
+        _play();
+    }
 
     // Run normal event loop until exit
     exec();
@@ -145,106 +155,42 @@ void LogReplayLink::_writeBytes(const QByteArray bytes)
     Q_UNUSED(bytes);
 }
 
-/// Parses a BigEndian quint64 timestamp
-/// @return A Unix timestamp in microseconds UTC for found message or 0 if parsing failed
-quint64 LogReplayLink::_parseTimestamp(const QByteArray& bytes)
-{
-    quint64 timestamp = qFromBigEndian(*((quint64*)(bytes.constData())));
-    quint64 currentTimestamp = ((quint64)QDateTime::currentMSecsSinceEpoch()) * 1000;
-    
-    // Now if the parsed timestamp is in the future, it must be an old file where the timestamp was stored as
-    // little endian, so switch it.
-    if (timestamp > currentTimestamp) {
-        timestamp = qbswap(timestamp);
-    }
-    
-    return timestamp;
-}
-
-/// Reads the next mavlink message from the log
-///     @param bytes[output] Bytes for mavlink message
-/// @return Unix timestamp in microseconds UTC for NEXT mavlink message or 0 if no message found
-quint64 LogReplayLink::_readNextMavlinkMessage(QByteArray& bytes)
-{
-    char                nextByte;
-    mavlink_status_t    status;
-
-    bytes.clear();
-
-    while (_logFile.getChar(&nextByte)) { // Loop over every byte
-        mavlink_message_t message;
-        bool messageFound = mavlink_parse_char(_mavlinkChannel, nextByte, &message, &status);
-
-        if (status.parse_state == MAVLINK_PARSE_STATE_GOT_STX) {
-            // This is the possible beginning of a mavlink message, clear any partial bytes
-            bytes.clear();
-        }
-        bytes.append(nextByte);
-
-        if (messageFound) {
-            // Return the timestamp for the next message
-            QByteArray rawTime = _logFile.read(cbTimestamp);
-            return _parseTimestamp(rawTime);
-        }
-    }
-
-    return 0;
-}
-
-/// Seeks to the beginning of the next successfully parsed mavlink message in the log file.
-///     @param nextMsg[output] Parsed next message that was found
-/// @return A Unix timestamp in microseconds UTC for found message or 0 if parsing failed
-quint64 LogReplayLink::_seekToNextMavlinkMessage(mavlink_message_t* nextMsg)
+/// Reads the record at the current file position into _logCurrentTimeUSecs and _nextMessage. Corrupt data is skipped
+/// up to the next valid record.
+/// @return false: end of the log, _nextMessage is empty
+bool LogReplayLink::_readNextRecord(void)
 {
-    char                nextByte;
-    mavlink_status_t    status;
-    qint64              messageStartPos = -1;
+    _nextMessage.clear();
 
-    mavlink_reset_channel_status(_mavlinkChannel);
-
-    while (_logFile.getChar(&nextByte)) {
-        bool messageFound = mavlink_parse_char(_mavlinkChannel, nextByte, nextMsg, &status);
-
-        if (status.parse_state == MAVLINK_PARSE_STATE_GOT_STX) {
-            // This is the possible beginning of a mavlink message
-            messageStartPos = _logFile.pos() - 1;
+    while (true) {
+        const QByteArray record = _logFile.peek(cbTimestamp + MAVLINK_MAX_PACKET_LEN);
+        if (record.length() <= cbTimestamp) {
+            return false;
         }
-        
-        // If we've found a message, jump back to the start of the message, grab the timestamp,
-        // and go back to the end of this file.
-        if (messageFound && messageStartPos != -1) {
-            _logFile.seek(messageStartPos - cbTimestamp);
-            QByteArray rawTime = _logFile.read(cbTimestamp);
-            return _parseTimestamp(rawTime);
+        const int length = MAVLinkFramer::packetLength(reinterpret_cast<const uint8_t*>(record.constData() + cbTimestamp), record.length() - cbTimestamp);
+        if (length == 0) {
+            // Partial record at the end of the log
+            return false;
+        } else if (length < 0) {
+            _logFile.skip(1);
+            continue;
         }
+        _logCurrentTimeUSecs = TlogIndex::parseTimestamp(record.constData());
+        _nextMessage = record.mid(cbTimestamp, length);
+        _logFile.skip(cbTimestamp + length);
+        return true;
     }
-    
-    return 0;
 }
 
-quint64 LogReplayLink::_findLastTimestamp(void)
+/// Moves to the record at offset, as found in the index
+bool LogReplayLink::_seekToRecord(qint64 offset)
 {
-    char                nextByte;
-    mavlink_status_t    status;
-    quint64             lastTimestamp = 0;
-    mavlink_message_t   msg;
-
-    // We read through the entire file looking for the last good timestamp. This can be somewhat slow, but trying to work from the
-    // end of the file can be way slower due to all the seeking back and forth required. So instead we take the simple reliable approach.
-
-    _logFile.reset();
-    mavlink_reset_channel_status(_mavlinkChannel);
-
-    while (_logFile.bytesAvailable() > cbTimestamp) {
-        lastTimestamp = _parseTimestamp(_logFile.read(cbTimestamp));
-
-        bool endOfMessage = false;
-        while (!endOfMessage && _logFile.getChar(&nextByte)) {
-            endOfMessage = mavlink_parse_char(_mavlinkChannel, nextByte, &msg, &status);
-        }
+    if (!_logFile.seek(offset)) {
+        _replayError(tr("Unable to seek to new position"));
+        return false;
     }
-
-    return lastTimestamp;
+    _readNextRecord();
+    return true;
 }
 
 bool LogReplayLink::_loadLogFile(void)
@@ -253,8 +199,6 @@ bool LogReplayLink::_loadLogFile(void)
     QString logFilename = _logReplayConfig->logFilename();
     QFileInfo logFileInfo;
     int logDurationSecondsTotal;
-    quint64 startTimeUSecs;
-    quint64 endTimeUSecs;
 
     if (_logFile.isOpen()) {
         errorMsg = tr("Attempt to load new log while log being played");
@@ -268,23 +212,23 @@ bool LogReplayLink::_loadLogFile(void)
     }
     logFileInfo.setFile(logFilename);
     _logFileSize = logFileInfo.size();
-    
-    startTimeUSecs = _parseTimestamp(_logFile.read(cbTimestamp));
-    endTimeUSecs = _findLastTimestamp();
 
-    if (endTimeUSecs <= startTimeUSecs) {
+    // Built once on this thread, later replays of the same log load the cached index
+    if (!_index.loadOrBuild(logFilename, errorMsg)) {
+        goto Error;
+    }
+    if (_index.endTimeUSecs() <= _index.startTimeUSecs()) {
         errorMsg = tr("The log file '%1' is corrupt or empty.").arg(logFilename);
         goto Error;
     }
 
     // Remember the start and end time so we can move around this _logFile with the slider.
-    _logEndTimeUSecs = endTimeUSecs;
-    _logStartTimeUSecs = startTimeUSecs;
-    _logDurationUSecs = endTimeUSecs - startTimeUSecs;
-    _logCurrentTimeUSecs = startTimeUSecs;
+    _logEndTimeUSecs = _index.endTimeUSecs();
+    _logStartTimeUSecs = _index.startTimeUSecs();
+    _logDurationUSecs = _logEndTimeUSecs - _logStartTimeUSecs;
 
-    // Reset our log file so when we go to read it for the first time, we start at the beginning.
-    _logFile.reset();
+    // Position on the first record so we start reading at the beginning.
+    _resetPlaybackToBeginning();
 
     logDurationSecondsTotal = (_logDurationUSecs) / 1000000;
     
@@ -300,48 +244,49 @@ Error:
     return false;
 }
 
-/// This function will read the next available log entry. It will then start
-/// the _readTickTimer timer to read the new log entry at the appropriate time.
+/// This function will hand over all log entries which are due. It will then start
+/// the _readTickTimer timer to read the next log entry at the appropriate time.
 /// It might not perfectly match the timing of the log file, but it will never
 /// induce a static drift into the log file replay.
 void LogReplayLink::_readNextLogEntry(void)
 {
-    QByteArray bytes;
+    QByteArray batch;
 
-    // Now parse MAVLink messages, grabbing their timestamps as we go. We stop once we
-    // have at least 3ms until the next one.
+    // Now collect MAVLink messages, grabbing their timestamps as we go. We stop once we
+    // have at least 3ms until the next one. At high playback speeds that is many messages,
+    // which go to the protocol in one go instead of one call per message.
 
     // We track what the next execution time should be in milliseconds, which we use to set
     // the next timer interrupt.
     int timeToNextExecutionMSecs = 0;
 
     while (timeToNextExecutionMSecs < 3) {
-        // Read the next mavlink message from the log
-        qint64 nextTimeUSecs = _readNextMavlinkMessage(bytes);
-        emit bytesReceived(this, bytes);
-        emit playbackPercentCompleteChanged(((float)(_logCurrentTimeUSecs - _logStartTimeUSecs) / (float)_logDurationUSecs) * 100);
-
-        if (_logFile.atEnd()) {
+        batch.append(_nextMessage);
+        if (!_readNextRecord()) {
+            _bytesReceived(batch);
+            emit playbackPercentCompleteChanged(100);
             _finishPlayback();
             return;
         }
-
-        _logCurrentTimeUSecs = nextTimeUSecs;
+        if (batch.length() >= _maxBatchBytes) {
+            break;
+        }
 
         // Calculate how long we should wait in real time until parsing this message.
         // We pace ourselves relative to the start time of playback to fix any drift (initially set in play())
 
-        quint64 currentTimeMSecs =                  (quint64)QDateTime::currentMSecsSinceEpoch();
-        quint64 desiredPlayheadMovementTimeMSecs =  ((_logCurrentTimeUSecs - _playbackStartLogTimeUSecs) / 1000) / _playbackSpeed;
-        quint64 desiredCurrentTimeMSecs =           _playbackStartTimeMSecs + desiredPlayheadMovementTimeMSecs;
+        qint64 currentTimeMSecs =           QDateTime::currentMSecsSinceEpoch();
+        qint64 desiredCurrentTimeMSecs =    _clock.wallMSecs(_logCurrentTimeUSecs);
 
-        timeToNextExecutionMSecs = desiredCurrentTimeMSecs - currentTimeMSecs;
+        timeToNextExecutionMSecs = static_cast<int>(desiredCurrentTimeMSecs - currentTimeMSecs);
     }
 
+    _bytesReceived(batch);
+    emit playbackPercentCompleteChanged(((float)(_logCurrentTimeUSecs - _logStartTimeUSecs) / (float)_logDurationUSecs) * 100);
     _signalCurrentLogTimeSecs();
 
     // And schedule the next execution of this function.
-    _readTickTimer.start(timeToNextExecutionMSecs);
+    _readTickTimer.start(qMax(timeToNextExecutionMSecs, 0));
 }
 
 void LogReplayLink::_play(void)
@@ -352,15 +297,15 @@ void LogReplayLink::_play(void)
 #endif
     
     // Make sure we aren't at the end of the file, if we are, reset to the beginning and play from there.
-    if (_logFile.atEnd()) {
+    if (_nextMessage.isEmpty()) {
         _resetPlaybackToBeginning();
     }
     
-    _playbackStartTimeMSecs = (quint64)QDateTime::currentMSecsSinceEpoch();
-    _playbackStartLogTimeUSecs = _logCurrentTimeUSecs;
+    _clock.start(_logCurrentTimeUSecs, _playbackSpeed);
     _readTickTimer.start(1);
     
     emit playbackStarted();
+    emit clockChanged();
 }
 
 void LogReplayLink::_pause(void)
@@ -371,20 +316,21 @@ void LogReplayLink::_pause(void)
 #endif
     
     _readTickTimer.stop();
+    _clock.stop(_logCurrentTimeUSecs);
     
     emit playbackPaused();
+    emit clockChanged();
 }
 
 void LogReplayLink::_resetPlaybackToBeginning(void)
 {
-    if (_logFile.isOpen()) {
-        _logFile.reset();
+    _logCurrentTimeUSecs = _logStartTimeUSecs;
+    if (_logFile.isOpen() && _index.isValid()) {
+        _seekToRecord(_index.entries().first().offset);
     }
     
-    // And since we haven't starting playback, clear the time of initial playback and the current timestamp.
-    _playbackStartTimeMSecs = 0;
-    _playbackStartLogTimeUSecs = 0;
-    _logCurrentTimeUSecs = _logStartTimeUSecs;
+    // And since we haven't starting playback, the clock stands at the beginning.
+    _clock.stop(_logCurrentTimeUSecs);
 }
 
 void LogReplayLink::movePlayhead(qreal percentComplete)
@@ -405,45 +351,17 @@ void LogReplayLink::movePlayhead(qreal percentComplete)
         percentComplete = 100;
     }
     
-    qreal percentCompleteMult = percentComplete / 100.0;
-    
-    // But if we have a timestamped MAVLink log, then actually aim to hit that percentage in terms of
-    // time through the file.
-    qint64 newFilePos = (qint64)(percentCompleteMult * (qreal)_logFile.size());
-
-    // Now seek to the appropriate position, failing gracefully if we can't.
-    if (!_logFile.seek(newFilePos)) {
-        _replayError(tr("Unable to seek to new position"));
+    // Binary search of the index for the last record at or before the desired time
+    const quint64 desiredTimeUSecs = _logStartTimeUSecs + static_cast<quint64>((percentComplete / 100.0) * _logDurationUSecs);
+    if (!_seekToRecord(_index.entryForTime(desiredTimeUSecs).offset)) {
         return;
     }
-
-    // But we do align to the next MAVLink message for consistency.
-    mavlink_message_t dummy;
-    _logCurrentTimeUSecs = _seekToNextMavlinkMessage(&dummy);
-
-    // Now calculate the current file location based on time.
-    qreal newRelativeTimeUSecs = (qreal)(_logCurrentTimeUSecs - _logStartTimeUSecs);
-
-    // Calculate the effective baud rate of the file in bytes/s.
-    qreal baudRate = _logFile.size() / (qreal)_logDurationUSecs / 1e6;
-
-    // And the desired time is:
-    qreal desiredTimeUSecs = percentCompleteMult * _logDurationUSecs;
-
-    // And now jump the necessary number of bytes in the proper direction
-    qint64 offset = (newRelativeTimeUSecs - desiredTimeUSecs) * baudRate;
-    if (!_logFile.seek(_logFile.pos() + offset)) {
-        _replayError(tr("Unable to seek to new position"));
-        return;
-    }
-
-    // And scan until we reach the start of a MAVLink message. We make sure to record this timestamp for
-    // smooth jumping around the file.
-    _logCurrentTimeUSecs = _seekToNextMavlinkMessage(&dummy);
+    _clock.stop(_logCurrentTimeUSecs);
     _signalCurrentLogTimeSecs();
+    emit clockChanged();
 
     // Now update the UI with our actual final position.
-    newRelativeTimeUSecs = (qreal)(_logCurrentTimeUSecs - _logStartTimeUSecs);
+    qreal newRelativeTimeUSecs = (qreal)(_logCurrentTimeUSecs - _logStartTimeUSecs);
     percentComplete = (newRelativeTimeUSecs / _logDurationUSecs) * 100;
     emit playbackPercentCompleteChanged(percentComplete);
 }
@@ -451,11 +369,17 @@ void LogReplayLink::movePlayhead(qreal percentComplete)
 void LogReplayLink::_setPlaybackSpeed(qreal playbackSpeed)
 {
     _playbackSpeed = playbackSpeed;
+
+    const int factGroupRateLimitMSecs = _logReplayConfig->rateLimitFactGroups() && _playbackSpeed >= _rateLimitSpeed ? _rateLimitUpdateMSecs : 0;
+    if (factGroupRateLimitMSecs != _factGroupRateLimitMSecs) {
+        _factGroupRateLimitMSecs = factGroupRateLimitMSecs;
+        emit factGroupRateLimitChanged(_factGroupRateLimitMSecs);
+    }
     
     // Let _readNextLogEntry update to correct speed
-    _playbackStartTimeMSecs = (quint64)QDateTime::currentMSecsSinceEpoch();
-    _playbackStartLogTimeUSecs = _logCurrentTimeUSecs;
+    _clock.start(_logCurrentTimeUSecs, _playbackSpeed);
     _readTickTimer.start(1);
+    emit clockChanged();
 }
 
 /// @brief Called when playback is complete
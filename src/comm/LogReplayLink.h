@@ -10,6 +10,8 @@
 #pragma once
 
 #include "MAVLinkProtocol.h"
+#include "TlogIndex.h"
+#include "ReplayClock.h"
 
 #include <QTimer>
 #include <QFile>
@@ -21,7 +23,8 @@ class LogReplayLinkConfiguration : public LinkConfiguration
     Q_OBJECT
 
 public:
-    Q_PROPERTY(QString  fileName    READ logFilename    WRITE setLogFilename    NOTIFY fileNameChanged)
+    Q_PROPERTY(QString  fileName            READ logFilename            WRITE setLogFilename            NOTIFY fileNameChanged)
+    Q_PROPERTY(bool     rateLimitFactGroups READ rateLimitFactGroups    WRITE setRateLimitFactGroups    NOTIFY rateLimitFactGroupsChanged)
 
     LogReplayLinkConfiguration(const QString& name);
     LogReplayLinkConfiguration(LogReplayLinkConfiguration* copy);
@@ -31,6 +34,14 @@ public:
 
     QString logFilenameShort(void);
 
+    /// true: Vehicle values are published less often during fast playback, see LogReplayLink::factGroupRateLimitChanged
+    bool rateLimitFactGroups(void) const { return _rateLimitFactGroups; }
+    void setRateLimitFactGroups(bool rateLimitFactGroups) { _rateLimitFactGroups = rateLimitFactGroups; emit rateLimitFactGroupsChanged(); }
+
+    /// false: The link loads the log but doesn't start playing, for TlogAnalyzer which feeds the messages itself. Not saved.
+    bool playOnConnect(void) const { return _playOnConnect; }
+    void setPlayOnConnect(bool playOnConnect) { _playOnConnect = playOnConnect; }
+
     // Virtuals from LinkConfiguration
     LinkType    type                    (void) override                                         { return LinkConfiguration::TypeLogReplay; }
     void        copyFrom                (LinkConfiguration* source) override;
@@ -41,13 +52,19 @@ public:
 
 signals:
     void fileNameChanged();
+    void rateLimitFactGroupsChanged();
 
 private:
     static const char*  _logFilenameKey;
+    static const char*  _rateLimitFactGroupsKey;
     QString             _logFilename;
+    bool                _rateLimitFactGroups = true;
+    bool                _playOnConnect = true;
 };
 
-/// Pseudo link that reads a telemetry log and feeds it into the application.
+/// Pseudo link that reads a telemetry log and feeds it into the application. Seeks go through a TlogIndex, and
+/// all messages which are due are handed over in a single batch per timer tick. Messages are paced by a ReplayClock
+/// which media played along with the log follows, see clock.
 class LogReplayLink : public LinkInterface
 {
     Q_OBJECT
@@ -59,10 +76,20 @@ public:
     /// @return true: log is currently playing, false: log playback is paused
     bool isPlaying(void) { return _readTickTimer.isActive(); }
 
+    /// @return Current fact group rate limit, see factGroupRateLimitChanged
+    int factGroupRateLimitMSecs(void) const { return _factGroupRateLimitMSecs; }
+
     void play           (void) { emit _playOnThread(); }
     void pause          (void) { emit _pauseOnThread(); }
     void movePlayhead   (qreal percentComplete);
 
+    /// Log time of the playhead, read from any thread. Changes other than the clock running on are signalled with
+    /// clockChanged.
+    const ReplayClock& clock(void) const { return _clock; }
+
+    /// @return First timestamp of the log, microseconds since the epoch. 0 until the log is loaded.
+    quint64 logStartTimeUSecs(void) const { return _logStartTimeUSecs; }
+
     // overrides from LinkInterface
     bool isConnected(void) const override { return _connected; }
     bool isLogReplay(void) override { return true; }
@@ -80,6 +107,13 @@ signals:
     void playbackPercentCompleteChanged (qreal percentComplete);
     void currentLogTimeSecs             (int secs);
 
+    /// The clock was started, stopped, changed rate or moved to a new playhead position
+    void clockChanged                   (void);
+
+    /// Fast playback feeds vehicles more messages than anyone can look at. Vehicles of the link should publish the
+    /// values of their fact groups no more often than updateRateMSecs, 0 for their own rate.
+    void factGroupRateLimitChanged      (int updateRateMSecs);
+
     // Internal signals
     void _playOnThread              (void);
     void _pauseOnThread             (void);
@@ -100,10 +134,8 @@ private:
     bool _connect(void) override;
 
     void    _replayError                (const QString& errorMsg);
-    quint64 _parseTimestamp             (const QByteArray& bytes);
-    quint64 _seekToNextMavlinkMessage   (mavlink_message_t* nextMsg);
-    quint64 _findLastTimestamp          (void);
-    quint64 _readNextMavlinkMessage     (QByteArray& bytes);
+    bool    _readNextRecord             (void);
+    bool    _seekToRecord               (qint64 offset);
     bool    _loadLogFile                (void);
     void    _finishPlayback             (void);
     void    _resetPlaybackToBeginning   (void);
@@ -115,25 +147,29 @@ private:
     LogReplayLinkConfiguration* _logReplayConfig;
 
     bool    _connected;
-    uint8_t _mavlinkChannel;
     QTimer  _readTickTimer;      ///< Timer which signals a read of next log record
 
     QString _errorTitle; ///< Title for communicatorError signals
 
     quint64 _logCurrentTimeUSecs;   ///< The timestamp of the next message in the log file.
+    QByteArray _nextMessage;        ///< Packet of the next message in the log file, empty at the end
     quint64 _logStartTimeUSecs;     ///< The first timestamp in the current log file.
     quint64 _logEndTimeUSecs;       ///< The last timestamp in the current log file.
     quint64 _logDurationUSecs;
 
-    qreal   _playbackSpeed;
-    quint64 _playbackStartTimeMSecs;    ///< The time when the logfile was first played back. This is used to pace out replaying the messages to fix long-term drift/skew. 0 indicates that the player hasn't initiated playback of this log file.
-    quint64 _playbackStartLogTimeUSecs;
+    qreal       _playbackSpeed;
+    ReplayClock _clock;                 ///< Started from the playhead on each play or speed change, messages are paced against it to fix long-term drift/skew
 
     MAVLinkProtocol*    _mavlink;
     QFile               _logFile;
     quint64             _logFileSize;
+    TlogIndex           _index;
+    int                 _factGroupRateLimitMSecs = 0;
 
-    static const int cbTimestamp = sizeof(quint64);
+    static const int cbTimestamp            = TlogIndex::cbTimestamp;
+    static const int _maxBatchBytes         = 64 * 1024;    ///< Batches are split up beyond this, so the link thread keeps processing events
+    static const int _rateLimitSpeed        = 10;           ///< Fact groups are rate limited from this playback speed on
+    static const int _rateLimitUpdateMSecs  = 500;
 };
 
 class LogReplayLinkController : public QObject
@@ -0,0 +1,234 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkFieldDecoder.h"
+
+#include <QHash>
+#include <QReadWriteLock>
+
+#include <cstring>
+#include <limits>
+
+/// Built decoders by message id, nullptr for ids which aren't in the dialect so they are only looked up once
+class MAVLinkFieldDecoderRegistry
+{
+public:
+    ~MAVLinkFieldDecoderRegistry()
+    {
+        qDeleteAll(decoders);
+    }
+
+    const MAVLinkFieldDecoder* decoder(uint32_t msgId)
+    {
+        {
+            QReadLocker locker(&lock);
+            auto iter = decoders.constFind(msgId);
+            if (iter != decoders.constEnd()) {
+                return iter.value();
+            }
+        }
+
+        QWriteLocker locker(&lock);
+        auto iter = decoders.constFind(msgId);
+        if (iter != decoders.constEnd()) {
+            return iter.value();
+        }
+        const mavlink_message_info_t* info = mavlink_get_message_info_by_id(msgId);
+        MAVLinkFieldDecoder* decoder = info ? new MAVLinkFieldDecoder(info) : nullptr;
+        decoders.insert(msgId, decoder);
+        return decoder;
+    }
+
+    QReadWriteLock                          lock;
+    QHash<uint32_t, MAVLinkFieldDecoder*>   decoders;
+};
+
+Q_GLOBAL_STATIC(MAVLinkFieldDecoderRegistry, _registry)
+
+template <typename T>
+static T _read(const uint8_t* payload, const MAVLinkFieldDecoder::Field_t& field, int index)
+{
+    // Fields aren't aligned within the payload
+    T value;
+    memcpy(&value, payload + field.wireOffset + (index * static_cast<int>(sizeof(T))), sizeof(T));
+    return value;
+}
+
+template <typename T>
+static void _decode(const uint8_t* payload, const MAVLinkFieldDecoder::Field_t& field, double* values)
+{
+    const int count = qMax(1, field.arrayLength);
+    for (int i=0; i<count; i++) {
+        values[field.slot + i] = static_cast<double>(_read<T>(payload, field, i));
+    }
+}
+
+template <typename T>
+static double _value(const uint8_t* payload, const MAVLinkFieldDecoder::Field_t& field)
+{
+    return static_cast<double>(_read<T>(payload, field, 0));
+}
+
+template <typename T>
+static QString _text(const uint8_t* payload, const MAVLinkFieldDecoder::Field_t& field)
+{
+    const int   count = qMax(1, field.arrayLength);
+    QString     text;
+    for (int i=0; i<count; i++) {
+        if (i) {
+            text += QStringLiteral(", ");
+        }
+        text += QString::number(_read<T>(payload, field, i));
+    }
+    return text;
+}
+
+static QString _charText(const uint8_t* payload, const MAVLinkFieldDecoder::Field_t& field)
+{
+    const char* chars = reinterpret_cast<const char*>(payload + field.wireOffset);
+    if (field.arrayLength == 0) {
+        return QString(QChar(*chars));
+    }
+    // Strings which fill the whole array have no terminator
+    return QString::fromLatin1(chars, static_cast<int>(strnlen(chars, static_cast<size_t>(field.arrayLength))));
+}
+
+MAVLinkFieldDecoder::MAVLinkFieldDecoder(const mavlink_message_info_t* info)
+    : _msgId        (info->msgid)
+    , _name         (info->name)
+    , _slotCount    (0)
+{
+    _fields.reserve(static_cast<int>(info->num_fields));
+    for (unsigned int i = 0; i < info->num_fields; ++i) {
+        const mavlink_field_info_t& fieldInfo = info->fields[i];
+
+        Field_t field;
+        field.name          = fieldInfo.name;
+        field.type          = fieldInfo.type;
+        field.wireOffset    = static_cast<int>(fieldInfo.wire_offset);
+        field.arrayLength   = static_cast<int>(fieldInfo.array_length);
+        field.slot          = -1;
+        field.decode        = nullptr;
+        field.value         = nullptr;
+        field.text          = nullptr;
+
+        switch (fieldInfo.type) {
+        case MAVLINK_TYPE_CHAR:
+            field.typeName  = QStringLiteral("char");
+            field.text      = _charText;
+            break;
+        case MAVLINK_TYPE_UINT8_T:
+            field.typeName  = QStringLiteral("uint8_t");
+            field.decode    = _decode<uint8_t>;
+            field.value     = _value<uint8_t>;
+            field.text      = _text<uint8_t>;
+            break;
+        case MAVLINK_TYPE_INT8_T:
+            field.typeName  = QStringLiteral("int8_t");
+            field.decode    = _decode<int8_t>;
+            field.value     = _value<int8_t>;
+            field.text      = _text<int8_t>;
+            break;
+        case MAVLINK_TYPE_UINT16_T:
+            field.typeName  = QStringLiteral("uint16_t");
+            field.decode    = _decode<uint16_t>;
+            field.value     = _value<uint16_t>;
+            field.text      = _text<uint16_t>;
+            break;
+        case MAVLINK_TYPE_INT16_T:
+            field.typeName  = QStringLiteral("int16_t");
+            field.decode    = _decode<int16_t>;
+            field.value     = _value<int16_t>;
+            field.text      = _text<int16_t>;
+            break;
+        case MAVLINK_TYPE_UINT32_T:
+            field.typeName  = QStringLiteral("uint32_t");
+            field.decode    = _decode<uint32_t>;
+            field.value     = _value<uint32_t>;
+            field.text      = _text<uint32_t>;
+            break;
+        case MAVLINK_TYPE_INT32_T:
+            field.typeName  = QStringLiteral("int32_t");
+            field.decode    = _decode<int32_t>;
+            field.value     = _value<int32_t>;
+            field.text      = _text<int32_t>;
+            break;
+        case MAVLINK_TYPE_FLOAT:
+            field.typeName  = QStringLiteral("float");
+            field.decode    = _decode<float>;
+            field.value     = _value<float>;
+            field.text      = _text<float>;
+            break;
+        case MAVLINK_TYPE_DOUBLE:
+            field.typeName  = QStringLiteral("double");
+            field.decode    = _decode<double>;
+            field.value     = _value<double>;
+            field.text      = _text<double>;
+            break;
+        case MAVLINK_TYPE_UINT64_T:
+            field.typeName  = QStringLiteral("uint64_t");
+            field.decode    = _decode<quint64>;
+            field.value     = _value<quint64>;
+            field.text      = _text<quint64>;
+            break;
+        case MAVLINK_TYPE_INT64_T:
+            field.typeName  = QStringLiteral("int64_t");
+            field.decode    = _decode<qint64>;
+            field.value     = _value<qint64>;
+            field.text      = _text<qint64>;
+            break;
+        default:
+            field.typeName  = QStringLiteral("?");
+            break;
+        }
+
+        if (field.decode) {
+            field.slot  = _slotCount;
+            _slotCount  += qMax(1, field.arrayLength);
+        }
+        _fields.append(field);
+    }
+}
+
+const MAVLinkFieldDecoder* MAVLinkFieldDecoder::decoder(uint32_t msgId)
+{
+    return _registry()->decoder(msgId);
+}
+
+int MAVLinkFieldDecoder::fieldIndex(const QString& name) const
+{
+    for (int i=0; i<_fields.count(); i++) {
+        if (_fields[i].name == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void MAVLinkFieldDecoder::decode(const mavlink_message_t& message, double* values) const
+{
+    const uint8_t* payload = reinterpret_cast<const uint8_t*>(&message.payload64[0]);
+    for (const Field_t& field: _fields) {
+        if (field.decode) {
+            field.decode(payload, field, values);
+        }
+    }
+}
+
+double MAVLinkFieldDecoder::value(const mavlink_message_t& message, int fieldIndex) const
+{
+    const Field_t& field = _fields[fieldIndex];
+    return field.value ? field.value(reinterpret_cast<const uint8_t*>(&message.payload64[0]), field) : std::numeric_limits<double>::quiet_NaN();
+}
+
+QString MAVLinkFieldDecoder::text(const mavlink_message_t& message, int fieldIndex) const
+{
+    const Field_t& field = _fields[fieldIndex];
+    return field.text ? field.text(reinterpret_cast<const uint8_t*>(&message.payload64[0]), field) : QString();
+}
@@ -0,0 +1,71 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+#include "QGCMAVLink.h"
+
+/// Decodes the fields of one message type straight from the payload.
+///
+/// The decoder for a message id is put together once from the dialect's mavlink_message_info_t, with a decode and a
+/// text function picked for each field by its type. Decoding a message is then a walk over that list: no message info
+/// lookup, no switching on field types and no strings. Numeric fields, and each element of numeric arrays, go into a
+/// flat array of doubles at the field's slot, which is what charts, recorders and streaming want. Strings are only
+/// built by text, for display.
+///
+/// Decoders live until exit and are safe to use from any thread.
+class MAVLinkFieldDecoder
+{
+public:
+    typedef struct Field_s {
+        QString     name;
+        QString     typeName;       ///< C type, uint16_t etc
+        int         type;           ///< MAVLINK_TYPE_*
+        int         wireOffset;
+        int         arrayLength;    ///< 0 for a single value
+        int         slot;           ///< First value in the slot array, -1 for char fields which have no numeric value
+        void        (*decode)   (const uint8_t* payload, const struct Field_s& field, double* values);
+        double      (*value)    (const uint8_t* payload, const struct Field_s& field);     ///< First element for arrays
+        QString     (*text)     (const uint8_t* payload, const struct Field_s& field);
+    } Field_t;
+
+    /// @return nullptr: Message id isn't in the dialect
+    static const MAVLinkFieldDecoder* decoder(uint32_t msgId);
+
+    uint32_t                msgId       (void) const { return _msgId; }
+    QString                 name        (void) const { return _name; }
+    const QVector<Field_t>& fields      (void) const { return _fields; }
+    int                     slotCount   (void) const { return _slotCount; }
+
+    /// @return Index into fields, -1 if there is no such field
+    int fieldIndex(const QString& name) const;
+
+    /// Writes all numeric values of the message to values, which must have room for slotCount
+    void decode(const mavlink_message_t& message, double* values) const;
+
+    /// Numeric field value, the first element for arrays
+    /// @return NaN for char fields
+    double value(const mavlink_message_t& message, int fieldIndex) const;
+
+    /// Field value for display, array elements are separated with ", "
+    QString text(const mavlink_message_t& message, int fieldIndex) const;
+
+private:
+    MAVLinkFieldDecoder(const mavlink_message_info_t* info);
+
+    uint32_t            _msgId;
+    QString             _name;
+    QVector<Field_t>    _fields;
+    int                 _slotCount;
+
+    friend class MAVLinkFieldDecoderRegistry;
+};
@@ -0,0 +1,97 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkFieldDecoderTest.h"
+#include "MAVLinkFieldDecoder.h"
+
+void MAVLinkFieldDecoderTest::_layoutTest(void)
+{
+    const MAVLinkFieldDecoder* decoder = MAVLinkFieldDecoder::decoder(MAVLINK_MSG_ID_PARAM_VALUE);
+    QVERIFY(decoder);
+    QCOMPARE(decoder->name(), QStringLiteral("PARAM_VALUE"));
+    QCOMPARE(decoder->msgId(), static_cast<uint32_t>(MAVLINK_MSG_ID_PARAM_VALUE));
+
+    // Same decoder every time
+    QCOMPARE(MAVLinkFieldDecoder::decoder(MAVLINK_MSG_ID_PARAM_VALUE), decoder);
+
+    // The param id string has no slot, the four numbers have one each
+    const int idIndex = decoder->fieldIndex(QStringLiteral("param_id"));
+    QVERIFY(idIndex >= 0);
+    QCOMPARE(decoder->fields()[idIndex].typeName, QStringLiteral("char"));
+    QCOMPARE(decoder->fields()[idIndex].slot, -1);
+    QCOMPARE(decoder->slotCount(), 4);
+    QCOMPARE(decoder->fieldIndex(QStringLiteral("no_such_field")), -1);
+
+    // Each array element has its own slot
+    decoder = MAVLinkFieldDecoder::decoder(MAVLINK_MSG_ID_HIL_ACTUATOR_CONTROLS);
+    QVERIFY(decoder);
+    QCOMPARE(decoder->slotCount(), 16 + 3);
+}
+
+void MAVLinkFieldDecoderTest::_decodeTest(void)
+{
+    mavlink_message_t message;
+    mavlink_msg_attitude_pack(1, MAV_COMP_ID_AUTOPILOT1, &message, 123456, 0.5f, -0.25f, 3.0f, 0.125f, 0, -1.5f);
+
+    const MAVLinkFieldDecoder* decoder = MAVLinkFieldDecoder::decoder(message.msgid);
+    QVERIFY(decoder);
+    QCOMPARE(decoder->slotCount(), 7);
+
+    QVector<double> values(decoder->slotCount());
+    decoder->decode(message, values.data());
+    QCOMPARE(values[decoder->fields()[decoder->fieldIndex(QStringLiteral("time_boot_ms"))].slot], 123456.0);
+    QCOMPARE(values[decoder->fields()[decoder->fieldIndex(QStringLiteral("roll"))].slot], 0.5);
+    QCOMPARE(values[decoder->fields()[decoder->fieldIndex(QStringLiteral("pitch"))].slot], -0.25);
+    QCOMPARE(values[decoder->fields()[decoder->fieldIndex(QStringLiteral("yawspeed"))].slot], -1.5);
+    QCOMPARE(decoder->value(message, decoder->fieldIndex(QStringLiteral("yaw"))), 3.0);
+
+    float controls[16];
+    for (int i=0; i<16; i++) {
+        controls[i] = static_cast<float>(i) / 4;
+    }
+    mavlink_msg_hil_actuator_controls_pack(1, MAV_COMP_ID_AUTOPILOT1, &message, 42, controls, 3, 7);
+    decoder = MAVLinkFieldDecoder::decoder(message.msgid);
+    values.resize(decoder->slotCount());
+    decoder->decode(message, values.data());
+    const int controlsSlot = decoder->fields()[decoder->fieldIndex(QStringLiteral("controls"))].slot;
+    for (int i=0; i<16; i++) {
+        QCOMPARE(values[controlsSlot + i], static_cast<double>(controls[i]));
+    }
+    QCOMPARE(decoder->value(message, decoder->fieldIndex(QStringLiteral("controls"))), 0.0);
+}
+
+void MAVLinkFieldDecoderTest::_textTest(void)
+{
+    mavlink_message_t message;
+
+    // A param id which fills the whole array has no terminator
+    mavlink_msg_param_value_pack(1, MAV_COMP_ID_AUTOPILOT1, &message, "SIXTEEN_CHAR_ID_", 1.5f, MAV_PARAM_TYPE_REAL32, 100, 7);
+    const MAVLinkFieldDecoder* decoder = MAVLinkFieldDecoder::decoder(message.msgid);
+    QCOMPARE(decoder->text(message, decoder->fieldIndex(QStringLiteral("param_id"))), QStringLiteral("SIXTEEN_CHAR_ID_"));
+    QVERIFY(qIsNaN(decoder->value(message, decoder->fieldIndex(QStringLiteral("param_id")))));
+    QCOMPARE(decoder->text(message, decoder->fieldIndex(QStringLiteral("param_value"))), QStringLiteral("1.5"));
+    QCOMPARE(decoder->text(message, decoder->fieldIndex(QStringLiteral("param_index"))), QStringLiteral("7"));
+
+    mavlink_msg_param_value_pack(1, MAV_COMP_ID_AUTOPILOT1, &message, "RATE", 1.5f, MAV_PARAM_TYPE_REAL32, 100, 7);
+    QCOMPARE(decoder->text(message, decoder->fieldIndex(QStringLiteral("param_id"))), QStringLiteral("RATE"));
+
+    // 64 bit values are formatted from the payload, not from the double slot
+    float controls[16] = { 0.5f, 1.0f };
+    const quint64 flags = 0xFFFFFFFFFFFFFFF1ull;
+    mavlink_msg_hil_actuator_controls_pack(1, MAV_COMP_ID_AUTOPILOT1, &message, 42, controls, 3, flags);
+    decoder = MAVLinkFieldDecoder::decoder(message.msgid);
+    QCOMPARE(decoder->text(message, decoder->fieldIndex(QStringLiteral("flags"))), QString::number(flags));
+    QVERIFY(decoder->text(message, decoder->fieldIndex(QStringLiteral("controls"))).startsWith(QStringLiteral("0.5, 1, 0, ")));
+}
+
+void MAVLinkFieldDecoderTest::_unknownTest(void)
+{
+    QVERIFY(!MAVLinkFieldDecoder::decoder(0xFFFFFF));
+    QVERIFY(!MAVLinkFieldDecoder::decoder(0xFFFFFF));
+}
@@ -0,0 +1,23 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class MAVLinkFieldDecoderTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _layoutTest    (void);
+    void _decodeTest    (void);
+    void _textTest      (void);
+    void _unknownTest   (void);
+};
@@ -0,0 +1,154 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkForwarder.h"
+#include "QGCLoggingCategory.h"
+
+#include <QObject>
+
+QGC_LOGGING_CATEGORY(MAVLinkForwarderLog, "MAVLinkForwarderLog")
+
+MAVLinkForwarder::MAVLinkForwarder(void)
+{
+    _rateTimer.start();
+}
+
+bool MAVLinkForwarder::parseTargets(const QString& spec, QList<Target_t>& targets, QString& errorString)
+{
+    QList<Target_t> parsedTargets;
+
+    for (const QString& entry: spec.split(QLatin1Char(';'), QString::SkipEmptyParts)) {
+        QStringList fields = entry.split(QLatin1Char(' '), QString::SkipEmptyParts);
+        if (fields.isEmpty()) {
+            continue;
+        }
+
+        Target_t target;
+        target.hostName = fields.takeFirst();
+
+        for (const QString& field: fields) {
+            int separator = field.indexOf(QLatin1Char('='));
+            if (separator == -1) {
+                errorString = QObject::tr("Unknown forwarding option '%1' for %2").arg(field).arg(target.hostName);
+                return false;
+            }
+            QString name    = field.left(separator);
+            QString value   = field.mid(separator + 1);
+            bool    ok      = false;
+
+            if (name == QStringLiteral("msgs")) {
+                for (const QString& msgId: value.split(QLatin1Char(','), QString::SkipEmptyParts)) {
+                    uint id = msgId.toUInt(&ok);
+                    if (!ok || id > 0xFFFFFF) {
+                        errorString = QObject::tr("Invalid message id '%1' for %2").arg(msgId).arg(target.hostName);
+                        return false;
+                    }
+                    target.msgIds.insert(id);
+                }
+            } else if (name == QStringLiteral("rate")) {
+                target.rateHz = value.toInt(&ok);
+                if (!ok || target.rateHz < 0) {
+                    errorString = QObject::tr("Invalid rate '%1' for %2").arg(value).arg(target.hostName);
+                    return false;
+                }
+            } else {
+                errorString = QObject::tr("Unknown forwarding option '%1' for %2").arg(name).arg(target.hostName);
+                return false;
+            }
+        }
+
+        parsedTargets.append(target);
+    }
+
+    targets = parsedTargets;
+    return true;
+}
+
+bool MAVLinkForwarder::setTargets(const QString& spec, QString& errorString)
+{
+    QList<Target_t> targets;
+
+    if (!parseTargets(spec, targets, errorString)) {
+        return false;
+    }
+
+    _spec       = spec;
+    _targets    = targets;
+    qCDebug(MAVLinkForwarderLog) << "Forwarding targets" << _targets.count() << spec;
+
+    return true;
+}
+
+void MAVLinkForwarder::forward(LinkInterface* sourceLink, const QVector<mavlink_message_t>& messages, const MAVLinkFramer::WireBytes_t& wire)
+{
+    if (messages.isEmpty()) {
+        return;
+    }
+
+    qint64 nowMSecs = _rateTimer.elapsed();
+
+    for (Target_t& target: _targets) {
+        SharedLinkInterfacePtr link = target.link.lock();
+        if (!link || link.get() == sourceLink) {
+            // Never echo traffic back to where it came from
+            continue;
+        }
+
+        if (target.msgIds.isEmpty() && target.rateHz == 0 && wire.bytes.length() <= _maxBatchBytes) {
+            // Everything goes, hand over the received buffer as is
+            link->writeBytesThreadSafe(wire.bytes);
+            target.forwardedCount += static_cast<quint64>(messages.count());
+            continue;
+        }
+
+        QByteArray  batch;
+        int         start = 0;
+
+        for (int i=0; i<messages.count(); i++) {
+            int end = wire.ends[i];
+            if (_accept(target, messages[i], nowMSecs)) {
+                if (batch.length() + (end - start) > _maxBatchBytes && !batch.isEmpty()) {
+                    link->writeBytesThreadSafe(batch);
+                    batch.clear();
+                }
+                batch.append(wire.bytes.constData() + start, end - start);
+                target.forwardedCount++;
+            } else {
+                target.filteredCount++;
+            }
+            start = end;
+        }
+
+        if (!batch.isEmpty()) {
+            link->writeBytesThreadSafe(batch);
+        }
+    }
+}
+
+bool MAVLinkForwarder::_accept(Target_t& target, const mavlink_message_t& message, qint64 nowMSecs)
+{
+    if (!target.msgIds.isEmpty() && !target.msgIds.contains(message.msgid)) {
+        return false;
+    }
+
+    if (target.rateHz > 0) {
+        quint64 streamKey = (static_cast<quint64>(message.msgid) << 16) | (static_cast<quint64>(message.sysid) << 8) | message.compid;
+        auto    iter = target.lastForwardMSecs.find(streamKey);
+
+        if (iter == target.lastForwardMSecs.end()) {
+            target.lastForwardMSecs.insert(streamKey, nowMSecs);
+        } else if (nowMSecs - iter.value() < 1000 / target.rateHz) {
+            return false;
+        } else {
+            iter.value() = nowMSecs;
+        }
+    }
+
+    return true;
+}
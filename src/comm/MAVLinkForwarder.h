@@ -0,0 +1,87 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QList>
+#include <QSet>
+#include <QHash>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+
+#include "LinkInterface.h"
+#include "MAVLinkFramer.h"
+#include "QGCMAVLink.h"
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkForwarderLog)
+
+/// Forwards received MAVLink traffic to any number of targets.
+///
+/// Messages are forwarded using their original wire bytes, so nothing is re-serialized. Each target may restrict
+/// forwarding to a set of message ids and limit the rate for each message stream (msgid, sysid, compid). All
+/// messages which pass a target's checks for a single received batch are written to it with as few writes as
+/// possible. A target which takes everything shares the received buffer with no copy at all.
+///
+/// Targets are described by a semicolon separated list where each entry is a host name followed by optional
+/// space separated options:
+///     localhost:14445; 10.0.0.5:14550 msgs=0,24,33 rate=5
+///         msgs    Comma separated list of message ids to forward, default is all
+///         rate    Maximum rate in Hz to forward each message stream at, default is unlimited
+///
+/// Only used from the main thread.
+class MAVLinkForwarder
+{
+public:
+    MAVLinkForwarder(void);
+
+    typedef struct Target_s {
+        QString                 hostName;
+        QSet<uint32_t>          msgIds;                 ///< Empty for all messages
+        int                     rateHz          = 0;    ///< 0 for no limit
+        WeakLinkInterfacePtr    link;
+        QHash<quint64, qint64>  lastForwardMSecs;       ///< Last time each message stream was forwarded, only used with rate limit
+        quint64                 forwardedCount  = 0;
+        quint64                 filteredCount   = 0;
+    } Target_t;
+
+    /// Parses a target list
+    ///     @param[out] targets Parsed targets
+    ///     @param[out] errorString Reason for failure
+    ///     @return false: spec is invalid, targets is not modified
+    static bool parseTargets(const QString& spec, QList<Target_t>& targets, QString& errorString);
+
+    /// Replaces the current targets with ones described by spec. Nothing changes if spec is invalid.
+    ///     @return false: spec is invalid
+    bool setTargets(const QString& spec, QString& errorString);
+
+    /// Spec which the current targets were created from
+    QString spec(void) const { return _spec; }
+
+    int     targetCount     (void) const { return _targets.count(); }
+    QString targetHostName  (int index) const { return _targets[index].hostName; }
+    SharedLinkInterfacePtr targetLink(int index) const { return _targets[index].link.lock(); }
+    void    setTargetLink   (int index, SharedLinkInterfacePtr link) { _targets[index].link = link; }
+    quint64 forwardedCount  (int index) const { return _targets[index].forwardedCount; }
+    quint64 filteredCount   (int index) const { return _targets[index].filteredCount; }
+
+    /// Forwards a batch of received messages to all targets other than the link they came from
+    ///     @param wire Wire bytes of messages as returned by MAVLinkFramer::parse
+    void forward(LinkInterface* sourceLink, const QVector<mavlink_message_t>& messages, const MAVLinkFramer::WireBytes_t& wire);
+
+private:
+    bool _accept(Target_t& target, const mavlink_message_t& message, qint64 nowMSecs);
+
+    QString         _spec;
+    QList<Target_t> _targets;
+    QElapsedTimer   _rateTimer;
+
+    static const int _maxBatchBytes = 1400; ///< Keeps batched UDP datagrams below a typical ethernet MTU
+};
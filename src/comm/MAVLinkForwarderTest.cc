@@ -0,0 +1,58 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkForwarderTest.h"
+#include "MAVLinkForwarder.h"
+
+void MAVLinkForwarderTest::_parseSingleHostTest(void)
+{
+    // Plain host names from before multiple targets were supported must still work
+    QList<MAVLinkForwarder::Target_t>   targets;
+    QString                             errorString;
+
+    QVERIFY(MAVLinkForwarder::parseTargets(QStringLiteral("localhost:14445"), targets, errorString));
+    QCOMPARE(targets.count(), 1);
+    QCOMPARE(targets[0].hostName, QStringLiteral("localhost:14445"));
+    QVERIFY(targets[0].msgIds.isEmpty());
+    QCOMPARE(targets[0].rateHz, 0);
+
+    QVERIFY(MAVLinkForwarder::parseTargets(QString(), targets, errorString));
+    QCOMPARE(targets.count(), 0);
+}
+
+void MAVLinkForwarderTest::_parseOptionsTest(void)
+{
+    QList<MAVLinkForwarder::Target_t>   targets;
+    QString                             errorString;
+
+    QVERIFY(MAVLinkForwarder::parseTargets(QStringLiteral("localhost:14445; 10.0.0.5:14550 msgs=0,24,33 rate=5 ;;"), targets, errorString));
+    QCOMPARE(targets.count(), 2);
+    QCOMPARE(targets[1].hostName, QStringLiteral("10.0.0.5:14550"));
+    QCOMPARE(targets[1].msgIds.count(), 3);
+    QVERIFY(targets[1].msgIds.contains(MAVLINK_MSG_ID_HEARTBEAT));
+    QVERIFY(targets[1].msgIds.contains(MAVLINK_MSG_ID_GPS_RAW_INT));
+    QVERIFY(targets[1].msgIds.contains(MAVLINK_MSG_ID_GLOBAL_POSITION_INT));
+    QCOMPARE(targets[1].rateHz, 5);
+}
+
+void MAVLinkForwarderTest::_parseErrorTest(void)
+{
+    QList<MAVLinkForwarder::Target_t>   targets;
+    QString                             errorString;
+
+    QVERIFY(MAVLinkForwarder::parseTargets(QStringLiteral("localhost:14445"), targets, errorString));
+
+    // Failures leave the previous result alone
+    QVERIFY(!MAVLinkForwarder::parseTargets(QStringLiteral("localhost:14445 msgs=0,x"), targets, errorString));
+    QVERIFY(!errorString.isEmpty());
+    QVERIFY(!MAVLinkForwarder::parseTargets(QStringLiteral("localhost:14445 rate=-1"), targets, errorString));
+    QVERIFY(!MAVLinkForwarder::parseTargets(QStringLiteral("localhost:14445 speed=1"), targets, errorString));
+    QVERIFY(!MAVLinkForwarder::parseTargets(QStringLiteral("localhost:14445 fast"), targets, errorString));
+    QCOMPARE(targets.count(), 1);
+}
@@ -0,0 +1,265 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkFramer.h"
+#include "QGCLoggingCategory.h"
+
+#include <string.h>
+
+QGC_LOGGING_CATEGORY(MAVLinkFramerLog, "MAVLinkFramerLog")
+
+MAVLinkFramer::MAVLinkFramer(void)
+{
+    reset();
+}
+
+void MAVLinkFramer::reset(void)
+{
+    _pending.clear();
+    _legacyMode = false;
+    memset(&_status,    0, sizeof(_status));
+    memset(&_rxBuffer,  0, sizeof(_rxBuffer));
+}
+
+int MAVLinkFramer::parse(const char* bytes, int length, QVector<mavlink_message_t>& messages, WireBytes_t* wire)
+{
+    const uint8_t*  data;
+    int             size;
+
+    if (_pending.isEmpty()) {
+        data = reinterpret_cast<const uint8_t*>(bytes);
+        size = length;
+    } else {
+        _pending.append(bytes, length);
+        data = reinterpret_cast<const uint8_t*>(_pending.constData());
+        size = _pending.length();
+    }
+
+    int startCount  = messages.count();
+    int position    = 0;
+    int tail        = -1;
+
+    while (position < size) {
+        if (_legacyMode) {
+            _parseLegacy(data, size, position, messages, wire);
+            continue;
+        }
+
+        // Skip to the next start of frame marker
+        while (position < size && data[position] != MAVLINK_STX && data[position] != MAVLINK_STX_MAVLINK1) {
+            position++;
+        }
+        if (position >= size) {
+            break;
+        }
+
+        mavlink_message_t   message;
+        int                 frameLength = 0;
+
+        switch (_frame(data + position, size - position, message, frameLength)) {
+        case FrameOk:
+            _updateStatus(message);
+            messages.append(message);
+            if (wire) {
+                wire->bytes.append(reinterpret_cast<const char*>(data + position), frameLength);
+                wire->ends.append(wire->bytes.length());
+            }
+            _framedCount++;
+            position += frameLength;
+            break;
+        case FrameIncomplete:
+            tail = position;
+            position = size;
+            break;
+        case FrameBad:
+            // Hand the stream over to the byte parser starting at the bad frame so behavior matches mavlink_parse_char exactly
+            _badFrameCount++;
+            _legacyMode = true;
+            qCDebug(MAVLinkFramerLog) << "Bad frame, falling back to byte parser. channel:badFrameCount" << _channel << _badFrameCount;
+            break;
+        }
+    }
+
+    if (tail == -1) {
+        _pending.clear();
+    } else if (_pending.isEmpty()) {
+        _pending = QByteArray(reinterpret_cast<const char*>(data + tail), size - tail);
+    } else {
+        _pending.remove(0, tail);
+    }
+
+    return messages.count() - startCount;
+}
+
+int MAVLinkFramer::packetLength(const uint8_t* data, int length)
+{
+    if (length < 1) {
+        return 0;
+    }
+    if (data[0] != MAVLINK_STX && data[0] != MAVLINK_STX_MAVLINK1) {
+        return -1;
+    }
+
+    bool    mavlink1        = data[0] == MAVLINK_STX_MAVLINK1;
+    int     headerLength    = mavlink1 ? _v1HeaderLength : _v2HeaderLength;
+
+    if (length < headerLength) {
+        return 0;
+    }
+
+    uint8_t     payloadLength   = data[1];
+    int         signatureLength = 0;
+    uint32_t    msgid;
+    if (mavlink1) {
+        msgid = data[5];
+    } else {
+        msgid = static_cast<uint32_t>(data[7]) | (static_cast<uint32_t>(data[8]) << 8) | (static_cast<uint32_t>(data[9]) << 16);
+        if (data[2] & ~MAVLINK_IFLAG_MASK) {
+            // Incompatible feature flag we don't understand
+            return -1;
+        }
+        if (data[2] & MAVLINK_IFLAG_SIGNED) {
+            signatureLength = MAVLINK_SIGNATURE_BLOCK_LEN;
+        }
+    }
+
+    int frameLength = headerLength + payloadLength + MAVLINK_NUM_CHECKSUM_BYTES + signatureLength;
+    if (length < frameLength) {
+        return 0;
+    }
+
+    const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(msgid);
+
+    uint16_t crc;
+    crc_init(&crc);
+    crc_accumulate_buffer(&crc, reinterpret_cast<const char*>(data + 1), static_cast<uint16_t>(headerLength - 1 + payloadLength));
+    crc_accumulate(entry ? entry->crc_extra : 0, &crc);
+
+    const uint8_t* ck = data + headerLength + payloadLength;
+    if (ck[0] != (crc & 0xFF) || ck[1] != (crc >> 8)) {
+        return -1;
+    }
+
+    return frameLength;
+}
+
+/// Validates a single frame which starts with an STX marker at data[0].
+///     @param[out] message Decoded message if FrameOk is returned
+///     @param[out] frameLength Number of wire bytes used by the frame if FrameOk is returned
+int MAVLinkFramer::decodePacket(const uint8_t* data, int length, mavlink_message_t& message)
+{
+    int frameLength;
+    _frame(data, length, message, frameLength);
+    return frameLength;
+}
+
+MAVLinkFramer::FrameResult_t MAVLinkFramer::_frame(const uint8_t* data, int length, mavlink_message_t& message, int& frameLength)
+{
+    frameLength = packetLength(data, length);
+    if (frameLength == 0) {
+        return FrameIncomplete;
+    } else if (frameLength < 0) {
+        return FrameBad;
+    }
+
+    bool    mavlink1        = data[0] == MAVLINK_STX_MAVLINK1;
+    int     headerLength    = mavlink1 ? _v1HeaderLength : _v2HeaderLength;
+    uint8_t payloadLength   = data[1];
+    int     signatureLength = frameLength - (headerLength + payloadLength + MAVLINK_NUM_CHECKSUM_BYTES);
+
+    message.magic   = data[0];
+    message.len     = payloadLength;
+    if (mavlink1) {
+        message.incompat_flags  = 0;
+        message.compat_flags    = 0;
+        message.seq             = data[2];
+        message.sysid           = data[3];
+        message.compid          = data[4];
+        message.msgid           = data[5];
+    } else {
+        message.incompat_flags  = data[2];
+        message.compat_flags    = data[3];
+        message.seq             = data[4];
+        message.sysid           = data[5];
+        message.compid          = data[6];
+        message.msgid           = static_cast<uint32_t>(data[7]) | (static_cast<uint32_t>(data[8]) << 8) | (static_cast<uint32_t>(data[9]) << 16);
+    }
+
+    const mavlink_msg_entry_t*  entry   = mavlink_get_msg_entry(message.msgid);
+    const uint8_t*              ck      = data + headerLength + payloadLength;
+
+    char* payload = _MAV_PAYLOAD_NON_CONST(&message);
+    memcpy(payload, data + headerLength, payloadLength);
+    if (entry && payloadLength < entry->max_msg_len) {
+        // Zero-fill to cope with truncated mavlink 2 payloads, same as mavlink_parse_char
+        memset(payload + payloadLength, 0, entry->max_msg_len - payloadLength);
+    }
+    message.checksum    = static_cast<uint16_t>(ck[0] | (ck[1] << 8));
+    message.ck[0]       = ck[0];
+    message.ck[1]       = ck[1];
+    if (signatureLength) {
+        memcpy(message.signature, ck + MAVLINK_NUM_CHECKSUM_BYTES, signatureLength);
+    }
+
+    return FrameOk;
+}
+
+/// Runs the standard byte parser from position until it produces a message or runs out of data. This is
+/// mavlink_parse_char working on the private status and buffer of the framer instead of those of a channel.
+int MAVLinkFramer::_parseLegacy(const uint8_t* data, int length, int& position, QVector<mavlink_message_t>& messages, WireBytes_t* wire)
+{
+    mavlink_message_t   message;
+    mavlink_status_t    status;
+
+    while (position < length) {
+        uint8_t c       = data[position++];
+        uint8_t result  = mavlink_frame_char_buffer(&_rxBuffer, &_status, c, &message, &status);
+
+        if (result == MAVLINK_FRAMING_BAD_CRC || result == MAVLINK_FRAMING_BAD_SIGNATURE) {
+            // Treated as a parse failure, restarting on the byte if it is a start marker
+            _status.parse_error++;
+            _status.msg_received = MAVLINK_FRAMING_INCOMPLETE;
+            _status.parse_state = MAVLINK_PARSE_STATE_IDLE;
+            if (c == MAVLINK_STX) {
+                _status.parse_state = MAVLINK_PARSE_STATE_GOT_STX;
+                _rxBuffer.len = 0;
+                mavlink_start_checksum(&_rxBuffer);
+            }
+        } else if (result == MAVLINK_FRAMING_OK) {
+            // The byte parser is back in the idle state after a valid message, resume buffer framing
+            messages.append(message);
+            if (wire) {
+                // The frame may have been spread across earlier calls, so rebuild it from the message
+                uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+                int     len = mavlink_msg_to_send_buffer(buf, &message);
+                wire->bytes.append(reinterpret_cast<const char*>(buf), len);
+                wire->ends.append(wire->bytes.length());
+            }
+            _fallbackCount++;
+            _legacyMode = false;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/// Keeps the parser status in sync with what mavlink_parse_char would have done for this message
+void MAVLinkFramer::_updateStatus(const mavlink_message_t& message)
+{
+    mavlink_status_t* status = &_status;
+
+    if (message.magic == MAVLINK_STX_MAVLINK1) {
+        status->flags |= MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+    } else {
+        status->flags &= ~MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+    }
+    status->current_rx_seq = message.seq;
+    status->packet_rx_success_count++;
+}
@@ -0,0 +1,93 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QVector>
+#include <QLoggingCategory>
+
+#include "QGCMAVLink.h"
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkFramerLog)
+
+/// Buffer level MAVLink framer.
+///
+/// Instead of pushing every received byte through mavlink_parse_char this locates STX markers within a
+/// contiguous span of bytes, validates length and CRC over the whole packet in one pass and returns all
+/// complete messages found. A packet which is split across two reads is carried over to the next call.
+///
+/// When a candidate packet fails validation the stream is considered corrupt and the framer falls back to
+/// the standard per-byte parser. It switches back to buffer framing as soon as the byte parser has
+/// resynchronized on a valid message.
+///
+/// The framer owns its parser status and receive buffer instead of using the global ones of a mavlink channel,
+/// so any number of streams can be framed at the same time. The channel is only used for logging.
+class MAVLinkFramer
+{
+public:
+    MAVLinkFramer(void);
+
+    /// Original wire bytes of the messages returned by parse, used to forward messages without re-serializing them
+    typedef struct {
+        QByteArray      bytes;  ///< Frames of all messages back to back
+        QVector<int>    ends;   ///< ends[i] is the offset just past the last byte of messages[i]
+    } WireBytes_t;
+
+    void setChannel (uint8_t channel) { _channel = channel; }
+    uint8_t channel (void) const { return _channel; }
+
+    /// Discards any partial packet, resets the parser status and returns to buffer framing
+    void reset(void);
+
+    /// Parser status of the stream, kept the same as mavlink_parse_char keeps the status of a channel
+    const mavlink_status_t& status(void) const { return _status; }
+
+    /// Frames all complete messages contained in bytes and appends them to messages.
+    ///     @param wire If not nullptr the wire bytes of each appended message are appended here as well. It must
+    ///                 be kept in step with messages across calls.
+    ///     @return Number of messages appended
+    int parse(const char* bytes, int length, QVector<mavlink_message_t>& messages, WireBytes_t* wire = nullptr);
+    int parse(const QByteArray& bytes, QVector<mavlink_message_t>& messages, WireBytes_t* wire = nullptr) { return parse(bytes.constData(), bytes.length(), messages, wire); }
+
+    /// Validates the length, flags and CRC of a single packet which starts with an STX marker at data[0]
+    ///     @return Number of wire bytes of the packet, 0: more bytes needed, -1: not a valid packet
+    static int packetLength(const uint8_t* data, int length);
+
+    /// Decodes a single packet which starts with an STX marker at data[0], without touching any channel status
+    ///     @return Same as packetLength, message is only valid for a positive length
+    static int decodePacket(const uint8_t* data, int length, mavlink_message_t& message);
+
+    uint64_t framedCount    (void) const { return _framedCount; }      ///< Messages decoded through buffer framing
+    uint64_t fallbackCount  (void) const { return _fallbackCount; }    ///< Messages decoded by the per-byte parser
+    uint64_t badFrameCount  (void) const { return _badFrameCount; }    ///< Candidate packets which failed validation
+
+private:
+    typedef enum {
+        FrameOk,
+        FrameIncomplete,
+        FrameBad,
+    } FrameResult_t;
+
+    static FrameResult_t    _frame          (const uint8_t* data, int length, mavlink_message_t& message, int& frameLength);
+    int                     _parseLegacy    (const uint8_t* data, int length, int& position, QVector<mavlink_message_t>& messages, WireBytes_t* wire);
+    void                    _updateStatus   (const mavlink_message_t& message);
+
+    uint8_t             _channel        = 0;
+    bool                _legacyMode     = false;    ///< true: Per-byte parser owns the stream until it resyncs
+    mavlink_status_t    _status;                    ///< Used instead of the channel status by the per-byte parser
+    mavlink_message_t   _rxBuffer;                  ///< Message the per-byte parser is assembling
+    QByteArray          _pending;                   ///< Partial packet carried over from the previous call
+    uint64_t            _framedCount    = 0;
+    uint64_t            _fallbackCount  = 0;
+    uint64_t            _badFrameCount  = 0;
+
+    static constexpr int _v1HeaderLength = MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1;
+    static constexpr int _v2HeaderLength = MAVLINK_CORE_HEADER_LEN + 1;
+};
@@ -0,0 +1,153 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkFramerTest.h"
+#include "MAVLinkFramer.h"
+
+void MAVLinkFramerTest::init(void)
+{
+    UnitTest::init();
+    mavlink_reset_channel_status(_channel);
+}
+
+QByteArray MAVLinkFramerTest::_heartbeatBytes(uint8_t sysid, bool mavlink1)
+{
+    mavlink_status_t* status = mavlink_get_channel_status(_channel);
+    if (mavlink1) {
+        status->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    } else {
+        status->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    }
+
+    mavlink_message_t   message;
+    uint8_t             buffer[MAVLINK_MAX_PACKET_LEN];
+
+    mavlink_msg_heartbeat_pack_chan(sysid, MAV_COMP_ID_AUTOPILOT1, _channel, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+    int length = mavlink_msg_to_send_buffer(buffer, &message);
+
+    status->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+
+    return QByteArray(reinterpret_cast<const char*>(buffer), length);
+}
+
+void MAVLinkFramerTest::_batchTest(void)
+{
+    MAVLinkFramer framer;
+    framer.setChannel(_channel);
+
+    QByteArray bytes = _heartbeatBytes(1) + _heartbeatBytes(2) + _heartbeatBytes(3);
+
+    QVector<mavlink_message_t> messages;
+    QCOMPARE(framer.parse(bytes, messages), 3);
+    for (int i=0; i<messages.count(); i++) {
+        QCOMPARE(messages[i].msgid, static_cast<uint32_t>(MAVLINK_MSG_ID_HEARTBEAT));
+        QCOMPARE(messages[i].sysid, static_cast<uint8_t>(i + 1));
+        mavlink_heartbeat_t heartbeat;
+        mavlink_msg_heartbeat_decode(&messages[i], &heartbeat);
+        QCOMPARE(heartbeat.type, static_cast<uint8_t>(MAV_TYPE_QUADROTOR));
+    }
+    QCOMPARE(framer.framedCount(),      static_cast<uint64_t>(3));
+    QCOMPARE(framer.fallbackCount(),    static_cast<uint64_t>(0));
+}
+
+void MAVLinkFramerTest::_splitReadTest(void)
+{
+    QByteArray bytes;
+    for (uint8_t sysid=1; sysid<=10; sysid++) {
+        bytes += _heartbeatBytes(sysid);
+    }
+
+    // Feed the stream in every chunk size up to more than a full packet so packets straddle reads at all offsets
+    for (int chunkSize=1; chunkSize<=bytes.length() / 4; chunkSize++) {
+        MAVLinkFramer framer;
+        framer.setChannel(_channel);
+
+        QVector<mavlink_message_t>  messages;
+        MAVLinkFramer::WireBytes_t  wire;
+        for (int position=0; position<bytes.length(); position+=chunkSize) {
+            framer.parse(bytes.mid(position, chunkSize), messages, &wire);
+        }
+        QCOMPARE(messages.count(), 10);
+        for (int i=0; i<messages.count(); i++) {
+            QCOMPARE(messages[i].sysid, static_cast<uint8_t>(i + 1));
+        }
+        // Wire bytes are the original frames even when they straddled reads
+        QCOMPARE(wire.bytes, bytes);
+        QCOMPARE(wire.ends.count(), 10);
+        QCOMPARE(wire.ends.last(), bytes.length());
+    }
+}
+
+void MAVLinkFramerTest::_corruptStreamTest(void)
+{
+    MAVLinkFramer framer;
+    framer.setChannel(_channel);
+
+    QByteArray corrupt = _heartbeatBytes(2);
+    corrupt[corrupt.length() - 3] = corrupt[corrupt.length() - 3] ^ 0x55;
+
+    QByteArray bytes = QByteArray("garbage") + _heartbeatBytes(1) + corrupt + _heartbeatBytes(3) + _heartbeatBytes(4);
+
+    QVector<mavlink_message_t> messages;
+    framer.parse(bytes, messages);
+
+    QCOMPARE(messages.count(), 3);
+    QCOMPARE(messages[0].sysid, static_cast<uint8_t>(1));
+    QCOMPARE(messages[1].sysid, static_cast<uint8_t>(3));
+    QCOMPARE(messages[2].sysid, static_cast<uint8_t>(4));
+    QCOMPARE(framer.badFrameCount(), static_cast<uint64_t>(1));
+    QVERIFY(framer.fallbackCount() >= 1);
+    QVERIFY(framer.framedCount() >= 1);
+}
+
+void MAVLinkFramerTest::_mavlink1Test(void)
+{
+    MAVLinkFramer framer;
+    framer.setChannel(_channel);
+
+    QVector<mavlink_message_t> messages;
+    QCOMPARE(framer.parse(_heartbeatBytes(1, true /* mavlink1 */), messages), 1);
+    QCOMPARE(messages[0].magic, static_cast<uint8_t>(MAVLINK_STX_MAVLINK1));
+    QVERIFY(framer.status().flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1);
+
+    QCOMPARE(framer.parse(_heartbeatBytes(2), messages), 1);
+    QVERIFY(!(framer.status().flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1));
+}
+
+void MAVLinkFramerTest::_independentStreamsTest(void)
+{
+    // Framers on the same channel don't share parser state, one stuck in the byte parser doesn't disturb the other
+    MAVLinkFramer framer1;
+    MAVLinkFramer framer2;
+    framer1.setChannel(_channel);
+    framer2.setChannel(_channel);
+
+    QByteArray corrupt = _heartbeatBytes(1);
+    corrupt[corrupt.length() - 3] = corrupt[corrupt.length() - 3] ^ 0x55;
+    QByteArray packet1 = _heartbeatBytes(1);
+    QByteArray packet2 = _heartbeatBytes(2);
+
+    QVector<mavlink_message_t> messages1;
+    QVector<mavlink_message_t> messages2;
+
+    // Leave framer1 in the byte parser half way through a packet
+    QCOMPARE(framer1.parse(corrupt + packet1.left(packet1.length() / 2), messages1), 0);
+    QCOMPARE(framer1.badFrameCount(), static_cast<uint64_t>(1));
+
+    for (int i=0; i<packet2.length(); i++) {
+        framer2.parse(packet2.mid(i, 1), messages2);
+    }
+    QCOMPARE(messages2.count(), 1);
+    QCOMPARE(messages2[0].sysid, static_cast<uint8_t>(2));
+
+    QCOMPARE(framer1.parse(packet1.mid(packet1.length() / 2), messages1), 1);
+    QCOMPARE(messages1[0].sysid, static_cast<uint8_t>(1));
+    QVERIFY(framer1.status().parse_error > 0);
+    QCOMPARE(framer2.status().parse_error, static_cast<uint8_t>(0));
+}
@@ -0,0 +1,34 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class MAVLinkFramer;
+
+class MAVLinkFramerTest : public UnitTest
+{
+    Q_OBJECT
+
+protected slots:
+    void init(void) override;
+
+private slots:
+    void _batchTest                 (void);
+    void _splitReadTest             (void);
+    void _corruptStreamTest         (void);
+    void _mavlink1Test              (void);
+    void _independentStreamsTest    (void);
+
+private:
+    QByteArray _heartbeatBytes(uint8_t sysid, bool mavlink1 = false);
+
+    static const uint8_t _channel = 0;
+};
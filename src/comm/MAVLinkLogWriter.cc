@@ -0,0 +1,193 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkLogWriter.h"
+#include "QGCLoggingCategory.h"
+
+#include <QElapsedTimer>
+#include <QtEndian>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+QGC_LOGGING_CATEGORY(MAVLinkLogWriterLog, "MAVLinkLogWriterLog")
+
+MAVLinkLogWriter::MAVLinkLogWriter(QObject* parent)
+    : QThread(parent)
+{
+
+}
+
+MAVLinkLogWriter::~MAVLinkLogWriter()
+{
+    stopWriting();
+}
+
+void MAVLinkLogWriter::startWriting(QFile* file)
+{
+    stopWriting();
+
+    QMutexLocker locker(&_mutex);
+
+    _file               = file;
+    _stopRequested      = false;
+    _writeFailed        = false;
+    _droppedPacketCount = 0;
+    _bytesWritten       = 0;
+    _fillBuffer.reserve(_batchSize);
+
+    locker.unlock();
+
+    start(LowPriority);
+}
+
+void MAVLinkLogWriter::stopWriting(void)
+{
+    if (!isRunning()) {
+        QMutexLocker locker(&_mutex);
+        _file = nullptr;
+        return;
+    }
+
+    _mutex.lock();
+    _stopRequested = true;
+    _wakeWriter.wakeOne();
+    _mutex.unlock();
+
+    wait();
+
+    _mutex.lock();
+    _file = nullptr;
+    _mutex.unlock();
+
+    if (_droppedPacketCount) {
+        qCWarning(MAVLinkLogWriterLog) << "Telemetry log writer dropped packets:" << _droppedPacketCount;
+    }
+}
+
+bool MAVLinkLogWriter::append(quint64 timestampUSecs, const char* packet, int length)
+{
+    QMutexLocker locker(&_mutex);
+
+    if (!_file || _stopRequested || _writeFailed) {
+        return false;
+    }
+
+    const int recordLength = static_cast<int>(sizeof(quint64)) + length;
+
+    if (_fillBuffer.length() + recordLength > _batchSize) {
+        if (_fullBuffers.count() >= _maxQueuedBatches) {
+            // Writer isn't keeping up with the receive rate, drop rather than stall the caller or grow without bound
+            if (_droppedPacketCount++ == 0) {
+                qCWarning(MAVLinkLogWriterLog) << "Telemetry log writer falling behind, dropping packets";
+            }
+            return false;
+        }
+        _fullBuffers.append(_fillBuffer);
+        if (_freeBuffers.count()) {
+            _fillBuffer = _freeBuffers.takeLast();
+        } else {
+            _fillBuffer = QByteArray();
+            _fillBuffer.reserve(_batchSize);
+        }
+        _wakeWriter.wakeOne();
+    }
+
+    uchar timestamp[sizeof(quint64)];
+    qToBigEndian(timestampUSecs, timestamp);
+    _fillBuffer.append(reinterpret_cast<const char*>(timestamp), sizeof(timestamp));
+    _fillBuffer.append(packet, length);
+
+    return true;
+}
+
+void MAVLinkLogWriter::run(void)
+{
+    QElapsedTimer       syncTimer;
+    QList<QByteArray>   writeBuffers;
+    bool                unsyncedData = false;
+
+    syncTimer.start();
+
+    _mutex.lock();
+    while (true) {
+        if (_fullBuffers.isEmpty() && !_stopRequested) {
+            _wakeWriter.wait(&_mutex, _flushIntervalMSecs);
+        }
+
+        // Take everything that is queued. On stop or flush interval timeout also take the partial batch.
+        writeBuffers.swap(_fullBuffers);
+        if (_fillBuffer.length() && (_stopRequested || writeBuffers.isEmpty())) {
+            writeBuffers.append(_fillBuffer);
+            _fillBuffer = _freeBuffers.count() ? _freeBuffers.takeLast() : QByteArray();
+            _fillBuffer.reserve(_batchSize);
+        }
+        bool stop = _stopRequested;
+
+        _mutex.unlock();
+
+        if (writeBuffers.count()) {
+            unsyncedData = true;
+            if (!_writeBuffers(writeBuffers)) {
+                _mutex.lock();
+                _writeFailed = true;
+                _fullBuffers.clear();
+                _fillBuffer.clear();
+                _mutex.unlock();
+                emit writeError(_file->errorString());
+                return;
+            }
+        }
+        if (unsyncedData && (stop || syncTimer.elapsed() > _syncIntervalMSecs)) {
+            _sync();
+            unsyncedData = false;
+            syncTimer.restart();
+        }
+
+        _mutex.lock();
+        for (QByteArray& buffer: writeBuffers) {
+            buffer.resize(0);
+            if (_freeBuffers.count() < 2) {
+                _freeBuffers.append(buffer);
+            }
+        }
+        writeBuffers.clear();
+
+        if (stop) {
+            break;
+        }
+    }
+    _mutex.unlock();
+}
+
+bool MAVLinkLogWriter::_writeBuffers(QList<QByteArray>& buffers)
+{
+    for (const QByteArray& buffer: buffers) {
+        if (_file->write(buffer) != buffer.length()) {
+            qCWarning(MAVLinkLogWriterLog) << "Telemetry log write failed" << _file->fileName() << _file->errorString();
+            return false;
+        }
+        _bytesWritten += static_cast<quint64>(buffer.length());
+    }
+    return true;
+}
+
+/// Pushes written data all the way to storage so a crash or power loss doesn't lose more than a sync interval
+void MAVLinkLogWriter::_sync(void)
+{
+    _file->flush();
+#if defined(Q_OS_WIN)
+    _commit(_file->handle());
+#else
+    fsync(_file->handle());
+#endif
+}
@@ -0,0 +1,82 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QByteArray>
+#include <QList>
+#include <QFile>
+#include <QLoggingCategory>
+
+#include <atomic>
+
+Q_DECLARE_LOGGING_CATEGORY(MAVLinkLogWriterLog)
+
+/// Background writer for telemetry logs.
+///
+/// Timestamped packets are appended into fixed size batch buffers from any thread. Full batches are
+/// queued to the writer thread which writes them to disk outside of the lock, so a slow file system never
+/// stalls the receive path. Partially filled batches are written out after a short interval and the file
+/// is synced to storage periodically. If the queue backs up past its limit new packets are dropped and counted.
+class MAVLinkLogWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    MAVLinkLogWriter(QObject* parent = nullptr);
+    ~MAVLinkLogWriter();
+
+    /// Starts writing to the specified file. The file must already be open and is only accessed by the
+    /// writer thread until stopWriting returns.
+    void startWriting(QFile* file);
+
+    /// Writes out everything queued so far and stops the writer thread
+    void stopWriting(void);
+
+    bool isWriting(void) const { return _file != nullptr; }
+
+    /// Queues a packet for writing, prefixed by the timestamp in big endian format. Thread safe.
+    ///     @return false: Packet was dropped since the writer is not keeping up or logging is not active
+    bool append(quint64 timestampUSecs, const char* packet, int length);
+
+    quint64 droppedPacketCount  (void) const { return _droppedPacketCount; }
+    quint64 bytesWritten        (void) const { return _bytesWritten; }
+
+signals:
+    /// Emitted from the writer thread when the file could not be written. No more data is written after this.
+    void writeError(QString errorString);
+
+protected:
+    // Overrides from QThread
+    void run(void) override;
+
+private:
+    bool _writeBuffers  (QList<QByteArray>& buffers);
+    void _sync          (void);
+
+    QFile*              _file = nullptr;
+    QMutex              _mutex;
+    QWaitCondition      _wakeWriter;
+    QByteArray          _fillBuffer;            ///< Batch currently being filled by append
+    QList<QByteArray>   _fullBuffers;           ///< Batches waiting for the writer thread
+    QList<QByteArray>   _freeBuffers;           ///< Written batches available for reuse
+    bool                _stopRequested = false;
+    bool                _writeFailed = false;
+
+    std::atomic<quint64> _droppedPacketCount    { 0 };
+    std::atomic<quint64> _bytesWritten          { 0 };
+
+    static const int _batchSize             = 64 * 1024;
+    static const int _maxQueuedBatches      = 64;       ///< 4MB of back log before packets are dropped
+    static const int _flushIntervalMSecs    = 500;      ///< Partially filled batches are written out at least this often
+    static const int _syncIntervalMSecs     = 5000;     ///< How often the file is synced to storage
+};
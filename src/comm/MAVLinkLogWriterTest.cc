@@ -0,0 +1,135 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkLogWriterTest.h"
+#include "MAVLinkLogWriter.h"
+
+#include <QTemporaryDir>
+#include <QSemaphore>
+#include <QFileInfo>
+
+#include <atomic>
+
+namespace {
+
+/// Log file whose writes stall until released, so the writer thread falls behind on demand
+class StallingLogFile : public QFile
+{
+public:
+    StallingLogFile(const QString& name) : QFile(name) { }
+
+    /// Lets the stalled write and all later ones through
+    ///     @param fail true: the writes fail instead of going to the file
+    void release(bool fail)
+    {
+        _fail = fail;
+        _gate.release();
+    }
+
+protected:
+    qint64 writeData(const char* data, qint64 len) override
+    {
+        _gate.acquire();
+        _gate.release();
+        if (_fail) {
+            setErrorString(QStringLiteral("Simulated write failure"));
+            return -1;
+        }
+        return QFile::writeData(data, len);
+    }
+
+private:
+    QSemaphore          _gate;
+    std::atomic<bool>   _fail { false };
+};
+
+}
+
+/// Appends packets until the writer starts dropping them, then _extraPackets more
+///     @return Number of packets accepted
+int MAVLinkLogWriterTest::_fillQueue(MAVLinkLogWriter& writer)
+{
+    const QByteArray    packet(_packetLength, 'x');
+    int                 accepted = 0;
+
+    while (accepted < _maxPackets && writer.append(static_cast<quint64>(accepted), packet.constData(), packet.length())) {
+        accepted++;
+    }
+    for (int i=0; i<_extraPackets; i++) {
+        writer.append(0, packet.constData(), packet.length());
+    }
+
+    return accepted;
+}
+
+void MAVLinkLogWriterTest::_droppedPacketTest(void)
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    StallingLogFile file(tempDir.filePath(QStringLiteral("dropped.tlog")));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+
+    MAVLinkLogWriter    writer;
+    QSignalSpy          spyError(&writer, &MAVLinkLogWriter::writeError);
+
+    writer.startWriting(&file);
+
+    // The writer thread is stuck in its first write, so the queue fills up and the rest are dropped
+    int accepted = _fillQueue(writer);
+    QVERIFY(accepted > 0);
+    QVERIFY(accepted < _maxPackets);
+    QCOMPARE(writer.droppedPacketCount(), static_cast<quint64>(1 + _extraPackets));
+
+    // Once the file keeps up again everything which was accepted is written out
+    file.release(false /* fail */);
+    writer.stopWriting();
+    file.close();
+
+    const quint64 recordLength = sizeof(quint64) + _packetLength;
+    QCOMPARE(writer.bytesWritten(), static_cast<quint64>(accepted) * recordLength);
+    QCOMPARE(static_cast<quint64>(QFileInfo(file.fileName()).size()), writer.bytesWritten());
+    QCOMPARE(writer.droppedPacketCount(), static_cast<quint64>(1 + _extraPackets));
+    QCOMPARE(spyError.count(), 0);
+}
+
+void MAVLinkLogWriterTest::_writeErrorTest(void)
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    StallingLogFile file(tempDir.filePath(QStringLiteral("error.tlog")));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+
+    MAVLinkLogWriter    writer;
+    QSignalSpy          spyError(&writer, &MAVLinkLogWriter::writeError);
+
+    writer.startWriting(&file);
+
+    int accepted = _fillQueue(writer);
+    QVERIFY(accepted > 0);
+    QVERIFY(accepted < _maxPackets);
+    QCOMPARE(writer.droppedPacketCount(), static_cast<quint64>(1 + _extraPackets));
+
+    // The stalled write fails, the writer reports it from its thread and stops taking packets
+    file.release(true /* fail */);
+    QVERIFY(QTest::qWaitFor([&]() { return spyError.count() == 1; }, 5000));
+    QCOMPARE(spyError.takeFirst()[0].toString(), QStringLiteral("Simulated write failure"));
+
+    const QByteArray packet(_packetLength, 'x');
+    QVERIFY(!writer.append(0, packet.constData(), packet.length()));
+
+    writer.stopWriting();
+    file.close();
+
+    // Refused packets after the failure aren't drops, the writer isn't behind it has stopped
+    QCOMPARE(writer.droppedPacketCount(), static_cast<quint64>(1 + _extraPackets));
+    QCOMPARE(writer.bytesWritten(), static_cast<quint64>(0));
+    QCOMPARE(spyError.count(), 0);
+}
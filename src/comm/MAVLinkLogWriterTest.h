@@ -0,0 +1,30 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class MAVLinkLogWriter;
+
+class MAVLinkLogWriterTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _droppedPacketTest (void);
+    void _writeErrorTest    (void);
+
+private:
+    int _fillQueue(MAVLinkLogWriter& writer);
+
+    static const int _packetLength  = 1024;
+    static const int _extraPackets  = 10;       ///< Appended after the first drop, all of these are dropped as well
+    static const int _maxPackets    = 20000;    ///< Well past the writer's back log limit
+};
@@ -0,0 +1,114 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkMessageDispatcher.h"
+
+MAVLinkMessageDispatcher::MAVLinkMessageDispatcher(void)
+{
+
+}
+
+MAVLinkMessageDispatcher::~MAVLinkMessageDispatcher()
+{
+    for (const SubscriptionPtr_t& subscription: _subscriptionsByHandle) {
+        QObject::disconnect(subscription->destroyedConnection);
+    }
+}
+
+/// System ids are 0-255 so AnySystem maps to 256, the message id wildcard is kept as is
+quint64 MAVLinkMessageDispatcher::_key(uint32_t msgId, int sysId)
+{
+    quint64 system = sysId == AnySystem ? 0x100 : static_cast<quint64>(sysId & 0xFF);
+    return (static_cast<quint64>(msgId) << 16) | system;
+}
+
+int MAVLinkMessageDispatcher::subscribe(uint32_t msgId, int sysId, int compId, QObject* context, Handler_t handler)
+{
+    SubscriptionPtr_t subscription = std::make_shared<Subscription_t>();
+
+    subscription->handle    = _nextHandle++;
+    subscription->key       = _key(msgId, sysId);
+    subscription->compId    = compId;
+    subscription->context   = context;
+    subscription->handler   = handler;
+    subscription->active    = true;
+
+    int handle = subscription->handle;
+    if (context) {
+        subscription->destroyedConnection = QObject::connect(context, &QObject::destroyed, [this, handle]() { unsubscribe(handle); });
+    }
+
+    _subscriptions[subscription->key].append(subscription);
+    _subscriptionsByHandle.insert(handle, subscription);
+
+    return handle;
+}
+
+void MAVLinkMessageDispatcher::unsubscribe(int handle)
+{
+    SubscriptionPtr_t subscription = _subscriptionsByHandle.take(handle);
+    if (!subscription) {
+        return;
+    }
+
+    // A dispatch in progress may still hold this subscription in its snapshot, so make sure it is skipped
+    subscription->active = false;
+    QObject::disconnect(subscription->destroyedConnection);
+
+    auto iter = _subscriptions.find(subscription->key);
+    if (iter != _subscriptions.end()) {
+        iter.value().removeOne(subscription);
+        if (iter.value().isEmpty()) {
+            _subscriptions.erase(iter);
+        }
+    }
+}
+
+void MAVLinkMessageDispatcher::unsubscribeAll(QObject* context)
+{
+    QList<int> handles;
+
+    for (const SubscriptionPtr_t& subscription: _subscriptionsByHandle) {
+        if (subscription->context == context) {
+            handles.append(subscription->handle);
+        }
+    }
+    for (int handle: handles) {
+        unsubscribe(handle);
+    }
+}
+
+void MAVLinkMessageDispatcher::dispatch(LinkInterface* link, const mavlink_message_t& message)
+{
+    if (_subscriptions.isEmpty()) {
+        return;
+    }
+
+    _dispatch(_key(message.msgid,   message.sysid), link, message);
+    _dispatch(_key(message.msgid,   AnySystem),     link, message);
+    _dispatch(_key(AnyMessage,      message.sysid), link, message);
+    _dispatch(_key(AnyMessage,      AnySystem),     link, message);
+}
+
+void MAVLinkMessageDispatcher::_dispatch(quint64 key, LinkInterface* link, const mavlink_message_t& message)
+{
+    auto iter = _subscriptions.constFind(key);
+    if (iter == _subscriptions.constEnd()) {
+        return;
+    }
+
+    // Implicitly shared snapshot, handlers are free to change subscriptions while we walk it
+    const QVector<SubscriptionPtr_t> subscriptions = iter.value();
+
+    for (const SubscriptionPtr_t& subscription: subscriptions) {
+        if (subscription->active && (subscription->compId == AnyComponent || subscription->compId == message.compid)) {
+            subscription->handler(link, message);
+        }
+    }
+}
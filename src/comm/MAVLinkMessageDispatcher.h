@@ -0,0 +1,84 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+
+#include <functional>
+#include <memory>
+
+#include "QGCMAVLink.h"
+
+class LinkInterface;
+
+/// Delivers received messages only to the handlers which subscribed to them.
+///
+/// Subscriptions are keyed by message id, system id and component id, each of which can be a wildcard. This
+/// replaces having every consumer connect to MAVLinkProtocol::messageReceived and throw away most of what
+/// it gets, which scales badly with the number of vehicles.
+///
+/// Handlers are called synchronously from dispatch. They may subscribe or unsubscribe (including destroying
+/// their context object) while being called, the change takes effect with the next message. Only used from
+/// the main thread.
+class MAVLinkMessageDispatcher
+{
+public:
+    MAVLinkMessageDispatcher(void);
+    ~MAVLinkMessageDispatcher();
+
+    typedef std::function<void(LinkInterface* link, const mavlink_message_t& message)> Handler_t;
+
+    static const uint32_t   AnyMessage      = 0xFFFFFFFF;
+    static const int        AnySystem       = -1;
+    static const int        AnyComponent    = -1;
+
+    /// Subscribes handler to matching messages
+    ///     @param context Subscription is removed automatically when this object is destroyed
+    ///     @return Handle to pass to unsubscribe
+    int subscribe(uint32_t msgId, int sysId, int compId, QObject* context, Handler_t handler);
+
+    template <typename T>
+    int subscribe(uint32_t msgId, int sysId, int compId, T* context, void (T::*method)(LinkInterface*, const mavlink_message_t&))
+    {
+        return subscribe(msgId, sysId, compId, context, [context, method](LinkInterface* link, const mavlink_message_t& message) {
+            (context->*method)(link, message);
+        });
+    }
+
+    void unsubscribe    (int handle);
+    void unsubscribeAll (QObject* context);
+
+    int subscriptionCount(void) const { return _subscriptionsByHandle.count(); }
+
+    /// Calls all handlers subscribed to this message
+    void dispatch(LinkInterface* link, const mavlink_message_t& message);
+
+private:
+    typedef struct {
+        int                     handle;
+        quint64                 key;
+        int                     compId;
+        QObject*                context;
+        Handler_t               handler;
+        QMetaObject::Connection destroyedConnection;
+        bool                    active;
+    } Subscription_t;
+
+    typedef std::shared_ptr<Subscription_t> SubscriptionPtr_t;
+
+    static quint64 _key(uint32_t msgId, int sysId);
+    void _dispatch(quint64 key, LinkInterface* link, const mavlink_message_t& message);
+
+    int                                             _nextHandle = 1;
+    QHash<quint64, QVector<SubscriptionPtr_t>>      _subscriptions;             ///< Keyed by message id and system id
+    QHash<int, SubscriptionPtr_t>                   _subscriptionsByHandle;
+};
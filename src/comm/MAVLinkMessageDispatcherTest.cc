@@ -0,0 +1,95 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkMessageDispatcherTest.h"
+#include "MAVLinkMessageDispatcher.h"
+
+mavlink_message_t MAVLinkMessageDispatcherTest::_message(uint32_t msgId, uint8_t sysId, uint8_t compId)
+{
+    mavlink_message_t message;
+
+    memset(&message, 0, sizeof(message));
+    message.msgid   = msgId;
+    message.sysid   = sysId;
+    message.compid  = compId;
+
+    return message;
+}
+
+void MAVLinkMessageDispatcherTest::_matchTest(void)
+{
+    MAVLinkMessageDispatcher    dispatcher;
+    QObject                     context;
+    int                         exactCount      = 0;
+    int                         systemCount     = 0;
+    int                         messageCount    = 0;
+    int                         allCount        = 0;
+
+    dispatcher.subscribe(MAVLINK_MSG_ID_ATTITUDE, 1, MAV_COMP_ID_AUTOPILOT1, &context, [&](LinkInterface*, const mavlink_message_t&) { exactCount++; });
+    dispatcher.subscribe(MAVLinkMessageDispatcher::AnyMessage, 1, MAVLinkMessageDispatcher::AnyComponent, &context, [&](LinkInterface*, const mavlink_message_t&) { systemCount++; });
+    dispatcher.subscribe(MAVLINK_MSG_ID_ATTITUDE, MAVLinkMessageDispatcher::AnySystem, MAVLinkMessageDispatcher::AnyComponent, &context, [&](LinkInterface*, const mavlink_message_t&) { messageCount++; });
+    dispatcher.subscribe(MAVLinkMessageDispatcher::AnyMessage, MAVLinkMessageDispatcher::AnySystem, MAVLinkMessageDispatcher::AnyComponent, &context, [&](LinkInterface*, const mavlink_message_t&) { allCount++; });
+
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_ATTITUDE,  1, MAV_COMP_ID_AUTOPILOT1));
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_ATTITUDE,  1, MAV_COMP_ID_CAMERA));
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_ATTITUDE,  2, MAV_COMP_ID_AUTOPILOT1));
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_HEARTBEAT, 1, MAV_COMP_ID_AUTOPILOT1));
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_HEARTBEAT, 2, MAV_COMP_ID_AUTOPILOT1));
+
+    QCOMPARE(exactCount,    1);
+    QCOMPARE(systemCount,   3);
+    QCOMPARE(messageCount,  3);
+    QCOMPARE(allCount,      5);
+}
+
+void MAVLinkMessageDispatcherTest::_unsubscribeTest(void)
+{
+    MAVLinkMessageDispatcher    dispatcher;
+    QObject                     context;
+    int                         firstCount  = 0;
+    int                         secondCount = 0;
+    int                         secondHandle;
+
+    // The first handler removes the second one while the message is being dispatched
+    dispatcher.subscribe(MAVLINK_MSG_ID_HEARTBEAT, 1, MAVLinkMessageDispatcher::AnyComponent, &context, [&](LinkInterface*, const mavlink_message_t&) {
+        firstCount++;
+        dispatcher.unsubscribe(secondHandle);
+    });
+    secondHandle = dispatcher.subscribe(MAVLINK_MSG_ID_HEARTBEAT, 1, MAVLinkMessageDispatcher::AnyComponent, &context, [&](LinkInterface*, const mavlink_message_t&) {
+        secondCount++;
+    });
+    QCOMPARE(dispatcher.subscriptionCount(), 2);
+
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_HEARTBEAT, 1, MAV_COMP_ID_AUTOPILOT1));
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_HEARTBEAT, 1, MAV_COMP_ID_AUTOPILOT1));
+    QCOMPARE(firstCount,    2);
+    QCOMPARE(secondCount,   0);
+    QCOMPARE(dispatcher.subscriptionCount(), 1);
+
+    dispatcher.unsubscribeAll(&context);
+    QCOMPARE(dispatcher.subscriptionCount(), 0);
+}
+
+void MAVLinkMessageDispatcherTest::_contextDestroyedTest(void)
+{
+    MAVLinkMessageDispatcher    dispatcher;
+    QObject*                    context = new QObject();
+    int                         count   = 0;
+
+    dispatcher.subscribe(MAVLinkMessageDispatcher::AnyMessage, 1, MAVLinkMessageDispatcher::AnyComponent, context, [&](LinkInterface*, const mavlink_message_t&) {
+        count++;
+        delete context;
+        context = nullptr;
+    });
+
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_HEARTBEAT, 1, MAV_COMP_ID_AUTOPILOT1));
+    dispatcher.dispatch(nullptr, _message(MAVLINK_MSG_ID_HEARTBEAT, 1, MAV_COMP_ID_AUTOPILOT1));
+    QCOMPARE(count, 1);
+    QCOMPARE(dispatcher.subscriptionCount(), 0);
+}
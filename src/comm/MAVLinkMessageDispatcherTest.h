@@ -0,0 +1,26 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "QGCMAVLink.h"
+
+class MAVLinkMessageDispatcherTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _matchTest             (void);
+    void _unsubscribeTest       (void);
+    void _contextDestroyedTest  (void);
+
+private:
+    mavlink_message_t _message(uint32_t msgId, uint8_t sysId, uint8_t compId);
+};
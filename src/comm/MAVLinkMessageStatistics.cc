@@ -0,0 +1,133 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkMessageStatistics.h"
+
+#include <cstring>
+
+MAVLinkMessageStatistics::MAVLinkMessageStatistics(void)
+{
+    memset(_channels, 0, sizeof(_channels));
+}
+
+quint64 MAVLinkMessageStatistics::_key(uint8_t sysId, uint8_t compId, uint32_t msgId)
+{
+    return (static_cast<quint64>(msgId) << 16) | (static_cast<quint64>(sysId) << 8) | compId;
+}
+
+void MAVLinkMessageStatistics::_add(Entry_t& entry, quint64 bytes, quint64 nowMSecs)
+{
+    if (entry.count == 0) {
+        entry.windowStartMSecs = nowMSecs;
+    } else if (nowMSecs - entry.windowStartMSecs >= static_cast<quint64>(rateWindowMSecs)) {
+        //-- Window complete, same smoothing as the inspector always used
+        const double seconds = (nowMSecs - entry.windowStartMSecs) / 1000.0;
+        entry.messageHz         = (0.2 * entry.messageHz)   + (0.8 * (entry.windowCount / seconds));
+        entry.bytesPerSec       = (0.2 * entry.bytesPerSec) + (0.8 * (entry.windowBytes / seconds));
+        entry.windowStartMSecs  = nowMSecs;
+        entry.windowCount       = 0;
+        entry.windowBytes       = 0;
+    }
+    entry.count++;
+    entry.bytes += bytes;
+    entry.windowCount++;
+    entry.windowBytes += bytes;
+}
+
+void MAVLinkMessageStatistics::add(uint8_t channel, const mavlink_message_t& message, quint64 nowMSecs)
+{
+    if (channel >= MAVLINK_COMM_NUM_BUFFERS) {
+        return;
+    }
+    const quint64 bytes = message.len + MAVLINK_NUM_NON_PAYLOAD_BYTES + (message.incompat_flags & MAVLINK_IFLAG_SIGNED ? MAVLINK_SIGNATURE_BLOCK_LEN : 0);
+
+    auto iter = _messages[channel].find(_key(message.sysid, message.compid, message.msgid));
+    if (iter == _messages[channel].end()) {
+        Entry_t entry;
+        memset(&entry, 0, sizeof(entry));
+        iter = _messages[channel].insert(_key(message.sysid, message.compid, message.msgid), entry);
+    }
+    _add(iter.value(), bytes, nowMSecs);
+    _add(_channels[channel], bytes, nowMSecs);
+}
+
+void MAVLinkMessageStatistics::resetChannel(uint8_t channel)
+{
+    if (channel < MAVLINK_COMM_NUM_BUFFERS) {
+        _messages[channel].clear();
+        memset(&_channels[channel], 0, sizeof(_channels[channel]));
+    }
+}
+
+void MAVLinkMessageStatistics::_addTo(const Entry_t& entry, quint64 nowMSecs, Stats_t& stats)
+{
+    stats.count += entry.count;
+    stats.bytes += entry.bytes;
+    if (entry.count == 0) {
+        return;
+    }
+    const quint64 windowMSecs = nowMSecs - entry.windowStartMSecs;
+    if (windowMSecs >= static_cast<quint64>(2 * rateWindowMSecs)) {
+        //-- Nothing completed the window for a while, so the smoothed rates are stale. This drops towards zero once
+        //-- messages stop coming.
+        stats.messageHz     += entry.windowCount / (windowMSecs / 1000.0);
+        stats.bytesPerSec   += entry.windowBytes / (windowMSecs / 1000.0);
+    } else {
+        stats.messageHz     += entry.messageHz;
+        stats.bytesPerSec   += entry.bytesPerSec;
+    }
+}
+
+MAVLinkMessageStatistics::Stats_t MAVLinkMessageStatistics::messageStats(uint8_t sysId, uint8_t compId, uint32_t msgId, quint64 nowMSecs, int channel) const
+{
+    Stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+
+    const quint64 key = _key(sysId, compId, msgId);
+    for (int i = 0; i < MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if (channel == AnyChannel || channel == i) {
+            auto iter = _messages[i].constFind(key);
+            if (iter != _messages[i].constEnd()) {
+                _addTo(iter.value(), nowMSecs, stats);
+            }
+        }
+    }
+    return stats;
+}
+
+MAVLinkMessageStatistics::Stats_t MAVLinkMessageStatistics::channelStats(uint8_t channel, quint64 nowMSecs) const
+{
+    Stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+
+    if (channel < MAVLINK_COMM_NUM_BUFFERS) {
+        _addTo(_channels[channel], nowMSecs, stats);
+    }
+    return stats;
+}
+
+QHash<uint32_t, MAVLinkMessageStatistics::Stats_t> MAVLinkMessageStatistics::channelMessageStats(uint8_t channel, quint64 nowMSecs) const
+{
+    QHash<uint32_t, Stats_t> messageStats;
+
+    if (channel < MAVLINK_COMM_NUM_BUFFERS) {
+        for (auto iter = _messages[channel].constBegin(); iter != _messages[channel].constEnd(); ++iter) {
+            const uint32_t msgId = static_cast<uint32_t>(iter.key() >> 16);
+            auto statsIter = messageStats.find(msgId);
+            if (statsIter == messageStats.end()) {
+                Stats_t stats;
+                memset(&stats, 0, sizeof(stats));
+                statsIter = messageStats.insert(msgId, stats);
+            }
+            _addTo(iter.value(), nowMSecs, statsIter.value());
+        }
+    }
+    return messageStats;
+}
+
@@ -0,0 +1,65 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QHash>
+
+#include "QGCMAVLink.h"
+
+/// Counts received messages and estimates their rates, for each mavlink channel and each system id, component id and
+/// message id received on it. Fed by MAVLinkProtocol for every message, so adding one is just a hash lookup and a few
+/// additions. Rates are worked out over windows of rateWindowMSecs as messages arrive and are never signalled,
+/// consumers such as the MAVLink Inspector poll them. Only used from the main thread.
+class MAVLinkMessageStatistics
+{
+public:
+    MAVLinkMessageStatistics(void);
+
+    typedef struct {
+        quint64 count;
+        quint64 bytes;          ///< On the wire, including header, checksum and signature
+        double  messageHz;
+        double  bytesPerSec;
+    } Stats_t;
+
+    static const int    AnyChannel      = -1;
+    static const int    rateWindowMSecs = 1000;
+
+    void add            (uint8_t channel, const mavlink_message_t& message, quint64 nowMSecs);
+    void resetChannel   (uint8_t channel);
+
+    /// @param channel Channel the messages were received on, AnyChannel sums all of them
+    /// @return All zero for a message which wasn't received
+    Stats_t messageStats(uint8_t sysId, uint8_t compId, uint32_t msgId, quint64 nowMSecs, int channel = AnyChannel) const;
+
+    /// @return All messages received on the channel
+    Stats_t channelStats(uint8_t channel, quint64 nowMSecs) const;
+
+    /// @return Messages received on the channel summed over all systems and components, keyed by message id
+    QHash<uint32_t, Stats_t> channelMessageStats(uint8_t channel, quint64 nowMSecs) const;
+
+private:
+    typedef struct {
+        quint64 count;
+        quint64 bytes;
+        quint64 windowStartMSecs;
+        quint64 windowCount;
+        quint64 windowBytes;
+        double  messageHz;      ///< Smoothed over the completed windows
+        double  bytesPerSec;
+    } Entry_t;
+
+    static quint64  _key    (uint8_t sysId, uint8_t compId, uint32_t msgId);
+    static void     _add    (Entry_t& entry, quint64 bytes, quint64 nowMSecs);
+    static void     _addTo  (const Entry_t& entry, quint64 nowMSecs, Stats_t& stats);
+
+    QHash<quint64, Entry_t> _messages[MAVLINK_COMM_NUM_BUFFERS];
+    Entry_t                 _channels[MAVLINK_COMM_NUM_BUFFERS];
+};
@@ -0,0 +1,99 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MAVLinkMessageStatisticsTest.h"
+#include "MAVLinkMessageStatistics.h"
+
+mavlink_message_t MAVLinkMessageStatisticsTest::_message(uint32_t msgId, uint8_t sysId, uint8_t compId, uint8_t length)
+{
+    mavlink_message_t message;
+
+    memset(&message, 0, sizeof(message));
+    message.msgid   = msgId;
+    message.sysid   = sysId;
+    message.compid  = compId;
+    message.len     = length;
+
+    return message;
+}
+
+void MAVLinkMessageStatisticsTest::_countTest(void)
+{
+    MAVLinkMessageStatistics statistics;
+
+    statistics.add(0, _message(MAVLINK_MSG_ID_ATTITUDE,  1, MAV_COMP_ID_AUTOPILOT1, 28), 0);
+    statistics.add(0, _message(MAVLINK_MSG_ID_ATTITUDE,  1, MAV_COMP_ID_AUTOPILOT1, 28), 10);
+    statistics.add(1, _message(MAVLINK_MSG_ID_ATTITUDE,  1, MAV_COMP_ID_AUTOPILOT1, 28), 20);
+    statistics.add(0, _message(MAVLINK_MSG_ID_ATTITUDE,  1, MAV_COMP_ID_CAMERA,     28), 30);
+    statistics.add(0, _message(MAVLINK_MSG_ID_HEARTBEAT, 2, MAV_COMP_ID_AUTOPILOT1, 9),  40);
+
+    // Summed across channels unless asked for one
+    MAVLinkMessageStatistics::Stats_t stats = statistics.messageStats(1, MAV_COMP_ID_AUTOPILOT1, MAVLINK_MSG_ID_ATTITUDE, 50);
+    QCOMPARE(stats.count, static_cast<quint64>(3));
+    QCOMPARE(stats.bytes, static_cast<quint64>(3 * (28 + MAVLINK_NUM_NON_PAYLOAD_BYTES)));
+    QCOMPARE(statistics.messageStats(1, MAV_COMP_ID_AUTOPILOT1, MAVLINK_MSG_ID_ATTITUDE, 50, 1).count, static_cast<quint64>(1));
+
+    QCOMPARE(statistics.messageStats(1, MAV_COMP_ID_CAMERA,     MAVLINK_MSG_ID_ATTITUDE,  50).count, static_cast<quint64>(1));
+    QCOMPARE(statistics.messageStats(2, MAV_COMP_ID_AUTOPILOT1, MAVLINK_MSG_ID_HEARTBEAT, 50).count, static_cast<quint64>(1));
+    QCOMPARE(statistics.messageStats(3, MAV_COMP_ID_AUTOPILOT1, MAVLINK_MSG_ID_HEARTBEAT, 50).count, static_cast<quint64>(0));
+
+    QCOMPARE(statistics.channelStats(0, 50).count, static_cast<quint64>(4));
+    QCOMPARE(statistics.channelStats(1, 50).count, static_cast<quint64>(1));
+}
+
+void MAVLinkMessageStatisticsTest::_rateTest(void)
+{
+    MAVLinkMessageStatistics    statistics;
+    const quint64               bytes = 28 + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+
+    // 50Hz for a few windows, the smoothed rate settles on it
+    quint64 now = 0;
+    for (int i=0; i<5 * 50; i++, now += 20) {
+        statistics.add(0, _message(MAVLINK_MSG_ID_ATTITUDE, 1, MAV_COMP_ID_AUTOPILOT1, 28), now);
+    }
+    MAVLinkMessageStatistics::Stats_t stats = statistics.messageStats(1, MAV_COMP_ID_AUTOPILOT1, MAVLINK_MSG_ID_ATTITUDE, now);
+    QVERIFY(qAbs(stats.messageHz - 50) < 1);
+    QVERIFY(qAbs(stats.bytesPerSec - (50 * bytes)) < bytes);
+
+    // Once messages stop the rate drops away
+    stats = statistics.messageStats(1, MAV_COMP_ID_AUTOPILOT1, MAVLINK_MSG_ID_ATTITUDE, now + 10 * MAVLinkMessageStatistics::rateWindowMSecs);
+    QVERIFY(stats.messageHz < 5);
+    QCOMPARE(stats.count, static_cast<quint64>(5 * 50));
+}
+
+void MAVLinkMessageStatisticsTest::_resetTest(void)
+{
+    MAVLinkMessageStatistics statistics;
+
+    statistics.add(0, _message(MAVLINK_MSG_ID_ATTITUDE, 1, MAV_COMP_ID_AUTOPILOT1, 28), 0);
+    statistics.add(1, _message(MAVLINK_MSG_ID_ATTITUDE, 1, MAV_COMP_ID_AUTOPILOT1, 28), 0);
+    statistics.resetChannel(0);
+
+    QCOMPARE(statistics.channelStats(0, 0).count, static_cast<quint64>(0));
+    QCOMPARE(statistics.messageStats(1, MAV_COMP_ID_AUTOPILOT1, MAVLINK_MSG_ID_ATTITUDE, 0).count, static_cast<quint64>(1));
+}
+
+void MAVLinkMessageStatisticsTest::_channelMessageTest(void)
+{
+    MAVLinkMessageStatistics statistics;
+
+    // Systems and components are summed for each message id
+    statistics.add(0, _message(MAVLINK_MSG_ID_ATTITUDE,  1, MAV_COMP_ID_AUTOPILOT1, 28), 0);
+    statistics.add(0, _message(MAVLINK_MSG_ID_ATTITUDE,  2, MAV_COMP_ID_AUTOPILOT1, 28), 0);
+    statistics.add(0, _message(MAVLINK_MSG_ID_ATTITUDE,  1, MAV_COMP_ID_CAMERA,     28), 0);
+    statistics.add(0, _message(MAVLINK_MSG_ID_HEARTBEAT, 1, MAV_COMP_ID_AUTOPILOT1, 9),  0);
+    statistics.add(1, _message(MAVLINK_MSG_ID_VFR_HUD,   1, MAV_COMP_ID_AUTOPILOT1, 20), 0);
+
+    QHash<uint32_t, MAVLinkMessageStatistics::Stats_t> messageStats = statistics.channelMessageStats(0, 0);
+    QCOMPARE(messageStats.count(), 2);
+    QCOMPARE(messageStats[MAVLINK_MSG_ID_ATTITUDE].count, static_cast<quint64>(3));
+    QCOMPARE(messageStats[MAVLINK_MSG_ID_ATTITUDE].bytes, static_cast<quint64>(3 * (28 + MAVLINK_NUM_NON_PAYLOAD_BYTES)));
+    QCOMPARE(messageStats[MAVLINK_MSG_ID_HEARTBEAT].count, static_cast<quint64>(1));
+    QCOMPARE(statistics.channelMessageStats(2, 0).count(), 0);
+}
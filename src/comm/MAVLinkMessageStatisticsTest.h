@@ -0,0 +1,27 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "QGCMAVLink.h"
+
+class MAVLinkMessageStatisticsTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _countTest     (void);
+    void _rateTest      (void);
+    void _resetTest     (void);
+    void _channelMessageTest(void);
+
+private:
+    mavlink_message_t _message(uint32_t msgId, uint8_t sysId, uint8_t compId, uint8_t length);
+};
@@ -31,6 +31,7 @@
 #include "QGCLoggingCategory.h"
 #include "MultiVehicleManager.h"
 #include "SettingsManager.h"
+#include "QGCTrace.h"
 
 Q_DECLARE_METATYPE(mavlink_message_t)
 
@@ -46,8 +47,6 @@ const char* MAVLinkProtocol::_logFileExtension      = "mavlink";            ///<
 MAVLinkProtocol::MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
     , m_enable_version_check(true)
-    , _message({})
-    , _status({})
     , versionMismatchIgnore(false)
     , systemId(255)
     , _current_version(100)
@@ -59,12 +58,7 @@ MAVLinkProtocol::MAVLinkProtocol(QGCApplication* app, QGCToolbox* toolbox)
     , _linkMgr(nullptr)
     , _multiVehicleManager(nullptr)
 {
-    memset(totalReceiveCounter, 0, sizeof(totalReceiveCounter));
-    memset(totalLossCounter,    0, sizeof(totalLossCounter));
-    memset(runningLossPercent,  0, sizeof(runningLossPercent));
     memset(firstMessage,        1, sizeof(firstMessage));
-    memset(&_status,            0, sizeof(_status));
-    memset(&_message,           0, sizeof(_message));
 }
 
 MAVLinkProtocol::~MAVLinkProtocol()
@@ -99,9 +93,17 @@ void MAVLinkProtocol::setToolbox(QGCToolbox *toolbox)
    _multiVehicleManager =   _toolbox->multiVehicleManager();
 
    qRegisterMetaType<mavlink_message_t>("mavlink_message_t");
+   qRegisterMetaType<MAVLinkProtocol::MessageBatch_t>("MAVLinkProtocol::MessageBatch_t");
 
    loadSettings();
 
+   // These settings are needed for every message or heartbeat, so we keep plain copies of them
+   AppSettings* appSettings = _toolbox->settingsManager()->appSettings();
+   _forwardMavlink.bind         (appSettings->forwardMavlink(),         this);
+   _disableAllPersistence.bind  (appSettings->disableAllPersistence(),  this);
+   _telemetrySave.bind          (appSettings->telemetrySave(),          this);
+   _telemetrySaveNotArmed.bind  (appSettings->telemetrySaveNotArmed(),  this);
+
    // All the *Counter variables are not initialized here, as they should be initialized
    // on a per-link basis before those links are used. @see resetMetadataForLink().
 
@@ -109,6 +111,9 @@ void MAVLinkProtocol::setToolbox(QGCToolbox *toolbox)
    connect(this, &MAVLinkProtocol::saveTelemetryLog,        _app, &QGCApplication::saveTelemetryLogOnMainThread);
    connect(this, &MAVLinkProtocol::checkTelemetrySavePath,  _app, &QGCApplication::checkTelemetrySavePathOnMainThread);
 
+   connect(&_logWriter, &MAVLinkLogWriter::writeError,         this, &MAVLinkProtocol::_logWriteError, Qt::QueuedConnection);
+   connect(this, &MAVLinkProtocol::_messageBatchDecoded,     this, &MAVLinkProtocol::_dispatchMessageBatch, Qt::QueuedConnection);
+
    connect(_multiVehicleManager, &MultiVehicleManager::vehicleAdded, this, &MAVLinkProtocol::_vehicleCountChanged);
    connect(_multiVehicleManager, &MultiVehicleManager::vehicleRemoved, this, &MAVLinkProtocol::_vehicleCountChanged);
 
@@ -143,13 +148,22 @@ void MAVLinkProtocol::storeSettings()
 void MAVLinkProtocol::resetMetadataForLink(LinkInterface *link)
 {
     int channel = link->mavlinkChannel();
-    totalReceiveCounter[channel] = 0;
-    totalLossCounter[channel]    = 0;
-    runningLossPercent[channel]  = 0.0f;
     for(int i = 0; i < 256; i++) {
         firstMessage[channel][i] =  1;
     }
+    _receiveStatusMutex.lock();
+    for (auto it = _receiveCounters.begin(); it != _receiveCounters.end(); ) {
+        if (it.key() >> 8 == channel) {
+            it = _receiveCounters.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    _receiveStatusMutex.unlock();
     link->setDecodedFirstMavlinkPacket(false);
+    _messageStatistics.resetChannel(static_cast<uint8_t>(channel));
+    _framers[channel].setChannel(static_cast<uint8_t>(channel));
+    _framers[channel].reset();
 }
 
 /**
@@ -160,33 +174,20 @@ void MAVLinkProtocol::resetMetadataForLink(LinkInterface *link)
 
 void MAVLinkProtocol::logSentBytes(LinkInterface* link, QByteArray b){
 
-    uint8_t bytes_time[sizeof(quint64)];
+    link->trafficStatistics()->addSent(b.length());
 
-    Q_UNUSED(link);
-    if (!_logSuspendError && !_logSuspendReplay && _tempLogFile.isOpen()) {
+    QMutexLocker locker(&_logMutex);
 
+    if (!_logSuspendError && !_logSuspendReplay && _logWriter.isWriting()) {
         quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
-
-        qToBigEndian(time,bytes_time);
-
-        b.insert(0,QByteArray((const char*)bytes_time,sizeof(bytes_time)));
-
-        int len = b.count();
-
-        if(_tempLogFile.write(b) != len)
-        {
-            // If there's an error logging data, raise an alert and stop logging.
-            emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
-            _stopLogging();
-            _logSuspendError = true;
-        }
+        _logWriter.append(time, b.constData(), b.length());
     }
 
 }
 
 /**
- * This method parses all incoming bytes and constructs a MAVLink packet.
- * It can handle multiple links in parallel, as each link has it's own buffer/
+ * This method frames all incoming bytes into MAVLink packets and processes them as a batch.
+ * It can handle multiple links in parallel, as each link has it's own framer/
  * parsing state machine.
  * @param link The interface to read from
  * @see LinkInterface
@@ -194,6 +195,8 @@ void MAVLinkProtocol::logSentBytes(LinkInterface* link, QByteArray b){
 
 void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
 {
+    QGC_TRACE_SCOPE_ARG("MAVLink", "receiveBytes", "bytes", b.size());
+
     // Since receiveBytes signals cross threads we can end up with signals in the queue
     // that come through after the link is disconnected. For these we just drop the data
     // since the link is closed.
@@ -202,176 +205,319 @@ void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
         return;
     }
 
+    QVector<mavlink_message_t>  messages;
+    MAVLinkFramer::WireBytes_t  wire;
+    _framers[link->mavlinkChannel()].parse(b, messages, _forwardMavlink ? &wire : nullptr);
+
+    _processMessages(link, linkPtr, messages, wire);
+
+    // Links which emit bytesReceived themselves don't keep a read time, so there is no latency to count
+    if (!linkPtr.expired()) {
+        link->trafficStatistics()->addProcessed(b.length(), messages.count());
+    }
+}
+
+/**
+ * Drains all bytes which the link has placed in its receive ring and processes the resulting messages.
+ * @param link The interface to read from
+ **/
+void MAVLinkProtocol::drainReceiveRing(LinkInterface* link)
+{
+    // The notification is queued across threads so the link may have been disconnected in the meantime
+    WeakLinkInterfacePtr linkPtr = _linkMgr->sharedLinkInterfacePointerForLink(link, true);
+    if (linkPtr.expired()) {
+        return;
+    }
+    QGCByteRingBuffer* ring = link->receiveRing();
+    if (!ring) {
+        return;
+    }
+
+    // Taken before the drain is started, a read after that stamps the next notification
+    qint64 readUSecs = link->receiveRingReadyUSecs();
+    link->receiveRingDrainStarted();
+
+    MAVLinkFramer&              framer = _framers[link->mavlinkChannel()];
+    QVector<mavlink_message_t>  messages;
+    MAVLinkFramer::WireBytes_t  wire;
+    MAVLinkFramer::WireBytes_t* wirePtr = _forwardMavlink ? &wire : nullptr;
+    const char*                 span;
+    int                         spanLength;
+    int                         drainedBytes = 0;
+
+    // Readable data may wrap around the end of the ring so it can take two spans
+    while ((spanLength = ring->readSpan(&span)) > 0) {
+        framer.parse(span, spanLength, messages, wirePtr);
+        ring->consume(spanLength);
+        drainedBytes += spanLength;
+    }
+
+    _processMessages(link, linkPtr, messages, wire);
+
+    if (!linkPtr.expired()) {
+        LinkTrafficStatistics* trafficStatistics = link->trafficStatistics();
+        trafficStatistics->addProcessed(drainedBytes, messages.count());
+        trafficStatistics->addLatency(LinkTrafficStatistics::nowUSecs() - readUSecs);
+    }
+}
+
+void MAVLinkProtocol::_processMessages(LinkInterface* link, const WeakLinkInterfacePtr& linkPtr, const QVector<mavlink_message_t>& messages, const MAVLinkFramer::WireBytes_t& wire)
+{
     uint8_t mavlinkChannel = link->mavlinkChannel();
 
-    for (int position = 0; position < b.size(); position++) {
-        if (mavlink_parse_char(mavlinkChannel, static_cast<uint8_t>(b[position]), &_message, &_status)) {
-            // Got a valid message
-            if (!link->decodedFirstMavlinkPacket()) {
-                link->setDecodedFirstMavlinkPacket(true);
-                mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
-                if (!(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1) && (mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
-                    qDebug() << "Switching outbound to mavlink 2.0 due to incoming mavlink 2.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
-                    mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
-                    // Set all links to v2
-                    setVersion(200);
-                }
-            }
+    if (_forwardMavlink && wire.ends.count() == messages.count()) {
+        _forwarder.forward(link, messages, wire);
+    }
 
-            //-----------------------------------------------------------------
-            // MAVLink Status
-            uint8_t lastSeq = lastIndex[_message.sysid][_message.compid];
-            uint8_t expectedSeq = lastSeq + 1;
-            // Increase receive counter
-            totalReceiveCounter[mavlinkChannel]++;
-            // Determine what the next expected sequence number is, accounting for
-            // never having seen a message for this system/component pair.
-            if(firstMessage[_message.sysid][_message.compid]) {
-                firstMessage[_message.sysid][_message.compid] = 0;
-                lastSeq     = _message.seq;
-                expectedSeq = _message.seq;
-            }
-            // And if we didn't encounter that sequence number, record the error
-            //int foo = 0;
-            if (_message.seq != expectedSeq)
-            {
-                //foo = 1;
-                int lostMessages = 0;
-                //-- Account for overflow during packet loss
-                if(_message.seq < expectedSeq) {
-                    lostMessages = (_message.seq + 255) - expectedSeq;
-                } else {
-                    lostMessages = _message.seq - expectedSeq;
-                }
-                // Log how many were lost
-                totalLossCounter[mavlinkChannel] += static_cast<uint64_t>(lostMessages);
-            }
+    for (const mavlink_message_t& message: messages) {
+        ReceiveStatus_t status;
+        bool            emitStatus = _updateReceiveStatus(mavlinkChannel, message, status);
 
-            // And update the last sequence number for this system/component pair
-            lastIndex[_message.sysid][_message.compid] = _message.seq;;
-            // Calculate new loss ratio
-            uint64_t totalSent = totalReceiveCounter[mavlinkChannel] + totalLossCounter[mavlinkChannel];
-            float receiveLossPercent = static_cast<float>(static_cast<double>(totalLossCounter[mavlinkChannel]) / static_cast<double>(totalSent));
-            receiveLossPercent *= 100.0f;
-            receiveLossPercent = (receiveLossPercent * 0.5f) + (runningLossPercent[mavlinkChannel] * 0.5f);
-            runningLossPercent[mavlinkChannel] = receiveLossPercent;
-
-            //qDebug() << foo << _message.seq << expectedSeq << lastSeq << totalLossCounter[mavlinkChannel] << totalReceiveCounter[mavlinkChannel] << totalSentCounter[mavlinkChannel] << "(" << _message.sysid << _message.compid << ")";
-
-            //-----------------------------------------------------------------
-            // MAVLink forwarding
-            bool forwardingEnabled = _app->toolbox()->settingsManager()->appSettings()->forwardMavlink()->rawValue().toBool();
-            if (forwardingEnabled) {
-                SharedLinkInterfacePtr forwardingLink = _linkMgr->mavlinkForwardingLink();
-
-                if (forwardingLink) {
-                    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
-                    int len = mavlink_msg_to_send_buffer(buf, &_message);
-                    forwardingLink->writeBytesThreadSafe((const char*)buf, len);
-                }
-            }
+        _logMessage(message);
+        _dispatchMessage(link, linkPtr, message, emitStatus ? &status : nullptr);
 
-            //-----------------------------------------------------------------
-            // Log data
-            if (!_logSuspendError && !_logSuspendReplay && _tempLogFile.isOpen()) {
-                uint8_t buf[MAVLINK_MAX_PACKET_LEN+sizeof(quint64)];
-
-                // Write the uint64 time in microseconds in big endian format before the message.
-                // This timestamp is saved in UTC time. We are only saving in ms precision because
-                // getting more than this isn't possible with Qt without a ton of extra code.
-                quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
-                qToBigEndian(time, buf);
-
-                // Then write the message to the buffer
-                int len = mavlink_msg_to_send_buffer(buf + sizeof(quint64), &_message);
-
-                // Determine how many bytes were written by adding the timestamp size to the message size
-                len += sizeof(quint64);
-
-                // Now write this timestamp/message pair to the log.
-                QByteArray b(reinterpret_cast<const char*>(buf), len);
-                if(_tempLogFile.write(b) != len)
-                {
-                    // If there's an error logging data, raise an alert and stop logging.
-                    emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
-                    _stopLogging();
-                    _logSuspendError = true;
-                }
-
-                // Check for the vehicle arming going by. This is used to trigger log save.
-                if (!_vehicleWasArmed && _message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                    mavlink_heartbeat_t state;
-                    mavlink_msg_heartbeat_decode(&_message, &state);
-                    if (state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY) {
-                        _vehicleWasArmed = true;
-                    }
-                }
-            }
+        // Anyone handling the message could close the connection, which deletes the link,
+        // so we check if it's expired
+        if (linkPtr.expired()) {
+            break;
+        }
+    }
+}
 
-            if (_message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                _startLogging();
-                mavlink_heartbeat_t heartbeat;
-                mavlink_msg_heartbeat_decode(&_message, &heartbeat);
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, heartbeat.autopilot, heartbeat.type);
-            } else if (_message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY) {
-                _startLogging();
-                mavlink_high_latency_t highLatency;
-                mavlink_msg_high_latency_decode(&_message, &highLatency);
-                // HIGH_LATENCY does not provide autopilot or type information, generic is our safest bet
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, MAV_AUTOPILOT_GENERIC, MAV_TYPE_GENERIC);
-            } else if (_message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY2) {
-                _startLogging();
-                mavlink_high_latency2_t highLatency2;
-                mavlink_msg_high_latency2_decode(&_message, &highLatency2);
-                emit vehicleHeartbeatInfo(link, _message.sysid, _message.compid, highLatency2.autopilot, highLatency2.type);
-            }
+/**
+ * Link thread version of receiveBytes. This is called through a direct connection on the thread of the link
+ * which received the bytes. Framing, receive status accounting and logging are done here, the decoded messages
+ * are then handed to the main thread as a single batch.
+ * @param link The interface to read from
+ **/
+void MAVLinkProtocol::receiveBytesOnLinkThread(LinkInterface* link, QByteArray b)
+{
+    QGC_TRACE_SCOPE_ARG("MAVLink", "receiveBytesOnLinkThread", "bytes", b.size());
 
-#if 0
-            // Given the current state of SiK Radio firmwares there is no way to make the code below work.
-            // The ArduPilot implementation of SiK Radio firmware always sends MAVLINK_MSG_ID_RADIO_STATUS as a mavlink 1
-            // packet even if the vehicle is sending Mavlink 2.
-
-            // Detect if we are talking to an old radio not supporting v2
-            mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
-            if (_message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _radio_version_mismatch_count != -1) {
-                if ((mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)
-                && !(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
-                    _radio_version_mismatch_count++;
-                }
-            }
+    // The link is emitting this signal so it can't have been deleted yet. Each channel is only ever
+    // framed by the thread of the link which owns it.
+    uint8_t mavlinkChannel = link->mavlinkChannel();
 
-            if (_radio_version_mismatch_count == 5) {
-                // Warn the user if the radio continues to send v1 while the link uses v2
-                emit protocolStatusMessage(tr("MAVLink Protocol"), tr("Detected radio still using MAVLink v1.0 on a link with MAVLink v2.0 enabled. Please upgrade the radio firmware."));
-                // Set to flag warning already shown
-                _radio_version_mismatch_count = -1;
-                // Flick link back to v1
-                qDebug() << "Switching outbound to mavlink 1.0 due to incoming mavlink 1.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
-                mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
-            }
-#endif
+    MessageBatch_t batch;
+    batch.bytes     = b.length();
+    batch.readUSecs = LinkTrafficStatistics::nowUSecs();
+    if (_framers[mavlinkChannel].parse(b, batch.messages, _forwardMavlink ? &batch.wire : nullptr) == 0) {
+        link->trafficStatistics()->addProcessed(batch.bytes, 0);
+        return;
+    }
 
-            // Update MAVLink status on every 32th packet
-            if ((totalReceiveCounter[mavlinkChannel] & 0x1F) == 0) {
-                emit mavlinkMessageStatus(_message.sysid, totalSent, totalReceiveCounter[mavlinkChannel], totalLossCounter[mavlinkChannel], receiveLossPercent);
-            }
+    for (const mavlink_message_t& message: batch.messages) {
+        ReceiveStatus_t status;
+        if (_updateReceiveStatus(mavlinkChannel, message, status)) {
+            batch.statuses.append(status);
+        }
+        _logMessage(message);
+    }
 
-            // The packet is emitted as a whole, as it is only 255 - 261 bytes short
-            // kind of inefficient, but no issue for a groundstation pc.
-            // It buys as reentrancy for the whole code over all threads
-            emit messageReceived(link, _message);
+    emit _messageBatchDecoded(link, batch);
+}
+
+void MAVLinkProtocol::_dispatchMessageBatch(LinkInterface* link, MessageBatch_t batch)
+{
+    // Batches are queued across threads, so the link may be gone by the time we get here
+    WeakLinkInterfacePtr linkPtr = _linkMgr->sharedLinkInterfacePointerForLink(link, true);
+    if (linkPtr.expired()) {
+        return;
+    }
+
+    if (_forwardMavlink && batch.wire.ends.count() == batch.messages.count()) {
+        _forwarder.forward(link, batch.messages, batch.wire);
+    }
+
+    for (const mavlink_message_t& message: batch.messages) {
+        _dispatchMessage(link, linkPtr, message, nullptr);
+        if (linkPtr.expired()) {
+            return;
+        }
+    }
+
+    LinkTrafficStatistics* trafficStatistics = link->trafficStatistics();
+    trafficStatistics->addProcessed(batch.bytes, batch.messages.count());
+    trafficStatistics->addLatency(LinkTrafficStatistics::nowUSecs() - batch.readUSecs);
+    for (const ReceiveStatus_t& status: batch.statuses) {
+        emit mavlinkMessageStatus(status.sysid, status.totalSent, status.totalReceived, status.totalLoss, status.lossPercent);
+    }
+}
+
+/// Updates the sequence loss accounting for a received message. Thread safe.
+///     @param[out] status Receive status after this message
+///     @return true: mavlinkMessageStatus should be emitted for this message
+bool MAVLinkProtocol::_updateReceiveStatus(uint8_t mavlinkChannel, const mavlink_message_t& message, ReceiveStatus_t& status)
+{
+    QMutexLocker locker(&_receiveStatusMutex);
+
+    // Default constructed counters of a newly heard from system are all zero
+    ReceiveCounters_t&  counters        = _receiveCounters[_receiveCountersKey(mavlinkChannel, message.sysid)];
+    uint64_t&           receiveCounter  = counters.totalReceiveCounter;
+    uint64_t&           lossCounter     = counters.totalLossCounter;
+    float&              runningLoss     = counters.runningLossPercent;
+
+    uint8_t lastSeq = lastIndex[message.sysid][message.compid];
+    uint8_t expectedSeq = lastSeq + 1;
+    // Increase receive counter
+    receiveCounter++;
+    // Determine what the next expected sequence number is, accounting for
+    // never having seen a message for this system/component pair.
+    if(firstMessage[message.sysid][message.compid]) {
+        firstMessage[message.sysid][message.compid] = 0;
+        lastSeq     = message.seq;
+        expectedSeq = message.seq;
+    }
+    // And if we didn't encounter that sequence number, record the error
+    if (message.seq != expectedSeq)
+    {
+        int lostMessages = 0;
+        //-- Account for overflow during packet loss
+        if(message.seq < expectedSeq) {
+            lostMessages = (message.seq + 255) - expectedSeq;
+        } else {
+            lostMessages = message.seq - expectedSeq;
+        }
+        // Log how many were lost
+        lossCounter += static_cast<uint64_t>(lostMessages);
+    }
+
+    // And update the last sequence number for this system/component pair
+    lastIndex[message.sysid][message.compid] = message.seq;
+    // Calculate new loss ratio
+    uint64_t totalSent = receiveCounter + lossCounter;
+    float receiveLossPercent = static_cast<float>(static_cast<double>(lossCounter) / static_cast<double>(totalSent));
+    receiveLossPercent *= 100.0f;
+    receiveLossPercent = (receiveLossPercent * 0.5f) + (runningLoss * 0.5f);
+    runningLoss = receiveLossPercent;
+
+    status.sysid            = message.sysid;
+    status.totalSent        = totalSent;
+    status.totalReceived    = receiveCounter;
+    status.totalLoss        = lossCounter;
+    status.lossPercent      = receiveLossPercent;
+
+    // Update MAVLink status on every 32th packet
+    return (receiveCounter & 0x1F) == 0;
+}
+
+/// Writes a received message to the telemetry log. Thread safe.
+void MAVLinkProtocol::_logMessage(const mavlink_message_t& message)
+{
+    QMutexLocker locker(&_logMutex);
+
+    if (!_logSuspendError && !_logSuspendReplay && _logWriter.isWriting()) {
+        uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+
+        // The uint64 time in microseconds is written in big endian format before the message by the log writer.
+        // This timestamp is saved in UTC time. We are only saving in ms precision because
+        // getting more than this isn't possible with Qt without a ton of extra code.
+        quint64 time = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch() * 1000);
+        int     len = mavlink_msg_to_send_buffer(buf, &message);
 
-            // Anyone handling the message could close the connection, which deletes the link,
-            // so we check if it's expired
-            if (linkPtr.expired()) {
-                break;
+        // The writer queues the pair and writes it out on its own thread. If it falls behind the packet is dropped and counted.
+        _logWriter.append(time, reinterpret_cast<const char*>(buf), len);
+
+        // Check for the vehicle arming going by. This is used to trigger log save.
+        if (!_vehicleWasArmed && message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+            mavlink_heartbeat_t state;
+            mavlink_msg_heartbeat_decode(&message, &state);
+            if (state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY) {
+                _vehicleWasArmed = true;
             }
+        }
+    }
+}
 
-            // Reset message parsing
-            memset(&_status,  0, sizeof(_status));
-            memset(&_message, 0, sizeof(_message));
+/// Called on the main thread when the log writer fails to write to the log file
+void MAVLinkProtocol::_logWriteError(QString errorString)
+{
+    // If there's an error logging data, raise an alert and stop logging.
+    qWarning() << "MAVLink log write failed" << errorString;
+    emit protocolStatusMessage(tr("MAVLink Protocol"), tr("MAVLink Logging failed. Could not write to file %1, logging disabled.").arg(_tempLogFile.fileName()));
+    _logMutex.lock();
+    _logSuspendError = true;
+    _logMutex.unlock();
+    _stopLogging();
+}
+
+/// Main thread handling of a received message: version negotiation, heartbeat detection and
+/// finally handing it out to the rest of the system.
+///     @param status Receive status to emit through mavlinkMessageStatus, nullptr for none
+void MAVLinkProtocol::_dispatchMessage(LinkInterface* link, const WeakLinkInterfacePtr& linkPtr, const mavlink_message_t& message, const ReceiveStatus_t* status)
+{
+    uint8_t mavlinkChannel = link->mavlinkChannel();
+
+    _messageStatistics.add(mavlinkChannel, message, QGC::bootTimeMilliseconds());
+
+    if (!link->decodedFirstMavlinkPacket()) {
+        link->setDecodedFirstMavlinkPacket(true);
+        mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
+        // Messages are framed in batches so the channel status only reflects the last one framed, use the message itself
+        if (message.magic != MAVLINK_STX_MAVLINK1 && (mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
+            qDebug() << "Switching outbound to mavlink 2.0 due to incoming mavlink 2.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
+            mavlinkStatus->flags &= ~MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+            // Set all links to v2
+            setVersion(200);
         }
     }
+
+    if (message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        _startLogging();
+        mavlink_heartbeat_t heartbeat;
+        mavlink_msg_heartbeat_decode(&message, &heartbeat);
+        emit vehicleHeartbeatInfo(link, message.sysid, message.compid, heartbeat.autopilot, heartbeat.type);
+    } else if (message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY) {
+        _startLogging();
+        mavlink_high_latency_t highLatency;
+        mavlink_msg_high_latency_decode(&message, &highLatency);
+        // HIGH_LATENCY does not provide autopilot or type information, generic is our safest bet
+        emit vehicleHeartbeatInfo(link, message.sysid, message.compid, MAV_AUTOPILOT_GENERIC, MAV_TYPE_GENERIC);
+    } else if (message.msgid == MAVLINK_MSG_ID_HIGH_LATENCY2) {
+        _startLogging();
+        mavlink_high_latency2_t highLatency2;
+        mavlink_msg_high_latency2_decode(&message, &highLatency2);
+        emit vehicleHeartbeatInfo(link, message.sysid, message.compid, highLatency2.autopilot, highLatency2.type);
+    }
+
+#if 0
+    // Given the current state of SiK Radio firmwares there is no way to make the code below work.
+    // The ArduPilot implementation of SiK Radio firmware always sends MAVLINK_MSG_ID_RADIO_STATUS as a mavlink 1
+    // packet even if the vehicle is sending Mavlink 2.
+
+    // Detect if we are talking to an old radio not supporting v2
+    mavlink_status_t* mavlinkStatus = mavlink_get_channel_status(mavlinkChannel);
+    if (message.msgid == MAVLINK_MSG_ID_RADIO_STATUS && _radio_version_mismatch_count != -1) {
+        if ((mavlinkStatus->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)
+        && !(mavlinkStatus->flags & MAVLINK_STATUS_FLAG_OUT_MAVLINK1)) {
+            _radio_version_mismatch_count++;
+        }
+    }
+
+    if (_radio_version_mismatch_count == 5) {
+        // Warn the user if the radio continues to send v1 while the link uses v2
+        emit protocolStatusMessage(tr("MAVLink Protocol"), tr("Detected radio still using MAVLink v1.0 on a link with MAVLink v2.0 enabled. Please upgrade the radio firmware."));
+        // Set to flag warning already shown
+        _radio_version_mismatch_count = -1;
+        // Flick link back to v1
+        qDebug() << "Switching outbound to mavlink 1.0 due to incoming mavlink 1.0 packet:" << mavlinkStatus << mavlinkChannel << mavlinkStatus->flags;
+        mavlinkStatus->flags |= MAVLINK_STATUS_FLAG_OUT_MAVLINK1;
+    }
+#endif
+
+    if (status) {
+        emit mavlinkMessageStatus(status->sysid, status->totalSent, status->totalReceived, status->totalLoss, status->lossPercent);
+    }
+
+    // Subscribers only see the messages they asked for
+    _messageDispatcher.dispatch(link, message);
+    if (linkPtr.expired()) {
+        // A subscriber closed the connection
+        return;
+    }
+
+    // Passed by reference, only queued receivers get a copy of their own
+    emit messageReceived(link, message);
 }
 
 /**
@@ -419,6 +565,11 @@ void MAVLinkProtocol::_vehicleCountChanged(void)
 bool MAVLinkProtocol::_closeLogFile(void)
 {
     if (_tempLogFile.isOpen()) {
+        // Everything queued must be on disk before the file is looked at
+        _logWriter.stopWriting();
+        if (_logWriter.droppedPacketCount()) {
+            qWarning() << "Telemetry log" << _tempLogFile.fileName() << "is missing packets dropped by the log writer:" << _logWriter.droppedPacketCount();
+        }
         if (_tempLogFile.size() == 0) {
             // Don't save zero byte files
             _tempLogFile.remove();
@@ -438,18 +589,18 @@ void MAVLinkProtocol::_startLogging(void)
     if (qgcApp()->runningUnitTests()) {
         return;
     }
-    AppSettings* appSettings = _app->toolbox()->settingsManager()->appSettings();
-    if(appSettings->disableAllPersistence()->rawValue().toBool()) {
+    if(_disableAllPersistence) {
         return;
     }
 #ifdef __mobile__
     //-- Mobile build don't write to /tmp unless told to do so
-    if (!appSettings->telemetrySave()->rawValue().toBool()) {
+    if (!_telemetrySave) {
         return;
     }
 #endif
     //-- Log is always written to a temp file. If later the user decides they want
     //   it, it's all there for them.
+    QMutexLocker locker(&_logMutex);
     if (!_tempLogFile.isOpen()) {
         if (!_logSuspendReplay) {
             if (!_tempLogFile.open()) {
@@ -461,6 +612,7 @@ void MAVLinkProtocol::_startLogging(void)
             }
 
             qDebug() << "Temp log" << _tempLogFile.fileName();
+            _logWriter.startWriting(&_tempLogFile);
             emit checkTelemetrySavePath();
 
             _logSuspendError = false;
@@ -470,11 +622,10 @@ void MAVLinkProtocol::_startLogging(void)
 
 void MAVLinkProtocol::_stopLogging(void)
 {
+    QMutexLocker locker(&_logMutex);
     if (_tempLogFile.isOpen()) {
         if (_closeLogFile()) {
-            if ((_vehicleWasArmed || _app->toolbox()->settingsManager()->appSettings()->telemetrySaveNotArmed()->rawValue().toBool()) &&
-                _app->toolbox()->settingsManager()->appSettings()->telemetrySave()->rawValue().toBool() &&
-                !_app->toolbox()->settingsManager()->appSettings()->disableAllPersistence()->rawValue().toBool()) {
+            if ((_vehicleWasArmed || _telemetrySaveNotArmed) && _telemetrySave && !_disableAllPersistence) {
                 emit saveTelemetryLog(_tempLogFile.fileName());
             } else {
                 QFile::remove(_tempLogFile.fileName());
@@ -508,6 +659,7 @@ void MAVLinkProtocol::checkForLostLogFiles(void)
 
 void MAVLinkProtocol::suspendLogForReplay(bool suspend)
 {
+    QMutexLocker locker(&_logMutex);
     _logSuspendReplay = suspend;
 }
 
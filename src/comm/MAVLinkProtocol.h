@@ -15,14 +15,22 @@
 #include <QTimer>
 #include <QFile>
 #include <QMap>
+#include <QHash>
 #include <QByteArray>
+#include <QVector>
 #include <QLoggingCategory>
 
 #include "LinkInterface.h"
 #include "QGCMAVLink.h"
+#include "MAVLinkFramer.h"
+#include "MAVLinkLogWriter.h"
+#include "MAVLinkForwarder.h"
+#include "MAVLinkMessageDispatcher.h"
+#include "MAVLinkMessageStatistics.h"
 #include "QGC.h"
 #include "QGCTemporaryFile.h"
 #include "QGCToolbox.h"
+#include "FactValueCache.h"
 
 class LinkManager;
 class MultiVehicleManager;
@@ -74,13 +82,50 @@ public:
     /// Set protocol version
     void setVersion(unsigned version);
 
+    /// Subscriptions to specific received messages. Handlers are called before messageReceived is emitted.
+    MAVLinkMessageDispatcher* messageDispatcher(void) { return &_messageDispatcher; }
+
+    /// Counts and rates of the received messages, for each link
+    MAVLinkMessageStatistics* messageStatistics(void) { return &_messageStatistics; }
+
+    /// Forwarding targets, which are maintained by LinkManager
+    MAVLinkForwarder* forwarder(void) { return &_forwarder; }
+
+    /// Number of packets the telemetry log writer had to drop for the current log since it could not keep up
+    quint64 logDroppedPacketCount(void) const { return _logWriter.droppedPacketCount(); }
+
     // Override from QGCTool
     virtual void setToolbox(QGCToolbox *toolbox);
 
+    /// Receive status snapshot reported through mavlinkMessageStatus
+    typedef struct {
+        int         sysid;
+        uint64_t    totalSent;
+        uint64_t    totalReceived;
+        uint64_t    totalLoss;
+        float       lossPercent;
+    } ReceiveStatus_t;
+
+    /// Messages decoded on a link thread which are waiting to be dispatched on the main thread
+    typedef struct {
+        QVector<mavlink_message_t>  messages;
+        MAVLinkFramer::WireBytes_t  wire;           ///< Wire bytes of messages, only filled in when forwarding
+        QVector<ReceiveStatus_t>    statuses;       ///< Emitted after the last message, vehicles sharing the link each have their own
+        int                         bytes       = 0;    ///< Bytes the messages were decoded from
+        qint64                      readUSecs   = 0;    ///< LinkTrafficStatistics::nowUSecs when the bytes were read
+    } MessageBatch_t;
+
 public slots:
     /** @brief Receive bytes from a communication interface */
     void receiveBytes(LinkInterface* link, QByteArray b);
 
+    /// Drains the receive ring of a link after it signals receiveRingReady
+    void drainReceiveRing(LinkInterface* link);
+
+    /// Receive bytes from a communication interface on the thread of the link. Must be connected with Qt::DirectConnection.
+    /// Decoded messages are dispatched to the main thread in batches.
+    void receiveBytesOnLinkThread(LinkInterface* link, QByteArray b);
+
     /** @brief Log bytes sent from a communication interface */
     void logSentBytes(LinkInterface* link, QByteArray b);
     
@@ -105,12 +150,17 @@ protected:
     bool        m_enable_version_check;                         ///< Enable checking of version match of MAV and QGC
     uint8_t     lastIndex[256][256];                            ///< Store the last received sequence ID for each system/componenet pair
     uint8_t     firstMessage[256][256];                         ///< First message flag
-    uint64_t    totalReceiveCounter[MAVLINK_COMM_NUM_BUFFERS];  ///< The total number of successfully received messages
-    uint64_t    totalLossCounter[MAVLINK_COMM_NUM_BUFFERS];     ///< Total messages lost during transmission.
-    float       runningLossPercent[MAVLINK_COMM_NUM_BUFFERS];   ///< Loss rate
 
-    mavlink_message_t _message;
-    mavlink_status_t _status;
+    /// Counted for each system on a channel, so vehicles which share a link have their own loss numbers
+    typedef struct {
+        uint64_t    totalReceiveCounter;    ///< The total number of successfully received messages
+        uint64_t    totalLossCounter;       ///< Total messages lost during transmission.
+        float       runningLossPercent;     ///< Loss rate
+    } ReceiveCounters_t;
+
+    static int  _receiveCountersKey(uint8_t mavlinkChannel, uint8_t sysid) { return (mavlinkChannel << 8) | sysid; }
+
+    QHash<int, ReceiveCounters_t> _receiveCounters;             ///< Only systems which were heard from take up space
 
     bool        versionMismatchIgnore;
     int         systemId;
@@ -121,8 +171,9 @@ signals:
     /// Heartbeat received on link
     void vehicleHeartbeatInfo(LinkInterface* link, int vehicleId, int componentId, int vehicleFirmwareType, int vehicleType);
 
-    /** @brief Message received and directly copied via signal */
-    void messageReceived(LinkInterface* link, mavlink_message_t message);
+    /// Every message received on any link. Consumers which only need some messages should use messageDispatcher instead.
+    /// Direct connections see the message by reference, queued connections copy it once per receiver.
+    void messageReceived(LinkInterface* link, const mavlink_message_t& message);
     /** @brief Emitted if version check is enabled / disabled */
     void versionCheckChanged(bool enabled);
     /** @brief Emitted if a message from the protocol should reach the user */
@@ -152,10 +203,19 @@ signals:
     /// Emitted when a telemetry log is started to save.
     void checkTelemetrySavePath(void);
 
+    /// Internal signal used to move a batch of messages decoded on a link thread over to the main thread
+    void _messageBatchDecoded(LinkInterface* link, MAVLinkProtocol::MessageBatch_t batch);
+
 private slots:
-    void _vehicleCountChanged(void);
+    void _vehicleCountChanged   (void);
+    void _dispatchMessageBatch  (LinkInterface* link, MAVLinkProtocol::MessageBatch_t batch);
+    void _logWriteError         (QString errorString);
     
 private:
+    void _processMessages       (LinkInterface* link, const WeakLinkInterfacePtr& linkPtr, const QVector<mavlink_message_t>& messages, const MAVLinkFramer::WireBytes_t& wire);
+    bool _updateReceiveStatus   (uint8_t mavlinkChannel, const mavlink_message_t& message, ReceiveStatus_t& status);
+    void _logMessage            (const mavlink_message_t& message);
+    void _dispatchMessage       (LinkInterface* link, const WeakLinkInterfacePtr& linkPtr, const mavlink_message_t& message, const ReceiveStatus_t* status);
     bool _closeLogFile(void);
     void _startLogging(void);
     void _stopLogging(void);
@@ -164,6 +224,20 @@ private:
     bool _logSuspendReplay;     ///< true: Logging suspended due to replay
     bool _vehicleWasArmed;      ///< true: Vehicle was armed during log sequence
 
+    MAVLinkFramer       _framers[MAVLINK_COMM_NUM_BUFFERS]; ///< Per channel buffer level framing state, only used by the thread doing the decoding
+    QMutex              _receiveStatusMutex;                ///< Protects sequence loss accounting which is shared across link threads
+    QMutex              _logMutex;                          ///< Protects the telemetry log which may be written from link threads
+    MAVLinkLogWriter    _logWriter;                         ///< Writes the telemetry log on a background thread
+    MAVLinkForwarder    _forwarder;
+    MAVLinkMessageDispatcher _messageDispatcher;
+    MAVLinkMessageStatistics _messageStatistics;
+
+    // Cached settings used on the receive path
+    FactValueCache<bool>    _forwardMavlink;
+    FactValueCache<bool>    _disableAllPersistence;
+    FactValueCache<bool>    _telemetrySave;
+    FactValueCache<bool>    _telemetrySaveNotArmed;
+
     QGCTemporaryFile    _tempLogFile;            ///< File to log to
     static const char*  _tempLogFileTemplate;    ///< Template for temporary log file
     static const char*  _logFileExtension;       ///< Extension for log files
@@ -172,3 +246,5 @@ private:
     MultiVehicleManager*    _multiVehicleManager;
 };
 
+Q_DECLARE_METATYPE(MAVLinkProtocol::MessageBatch_t)
+
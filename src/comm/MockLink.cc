@@ -11,6 +11,7 @@
 #include "QGCLoggingCategory.h"
 #include "QGCApplication.h"
 #include "LinkManager.h"
+#include "QGC.h"
 
 #ifdef UNITTEST_BUILD
 #include "UnitTest.h"
@@ -19,6 +20,7 @@
 #include <QTimer>
 #include <QDebug>
 #include <QFile>
+#include <QDataStream>
 
 #include <string.h>
 
@@ -47,6 +49,13 @@ const char* MockConfiguration::_vehicleTypeKey          = "VehicleType";
 const char* MockConfiguration::_sendStatusTextKey       = "SendStatusText";
 const char* MockConfiguration::_incrementVehicleIdKey   = "IncrementVehicleId";
 const char* MockConfiguration::_failureModeKey          = "FailureMode";
+const char* MockConfiguration::_loadVehicleCountKey     = "LoadVehicleCount";
+const char* MockConfiguration::_loadProfileKey          = "LoadProfile";
+const char* MockConfiguration::_loadLossPercentKey      = "LoadLossPercent";
+const char* MockConfiguration::_loadJitterMSecsKey      = "LoadJitterMSecs";
+const char* MockConfiguration::_loadBurstMSecsKey       = "LoadBurstMSecs";
+const char* MockConfiguration::_loadParamCountKey       = "LoadParamCount";
+const char* MockConfiguration::_loadMissionItemCountKey = "LoadMissionItemCount";
 
 constexpr MAV_CMD MockLink::MAV_CMD_MOCKLINK_ALWAYS_RESULT_ACCEPTED;
 constexpr MAV_CMD MockLink::MAV_CMD_MOCKLINK_ALWAYS_RESULT_FAILED;
@@ -91,6 +100,19 @@ MockLink::MockLink(SharedLinkConfigurationPtr& config)
     _vehicleLatitude    = _defaultVehicleLatitude + ((_vehicleSystemId - 128) * 0.0001);
     _vehicleLongitude   = _defaultVehicleLongitude + ((_vehicleSystemId - 128) * 0.0001);
 
+    // The extra vehicles of a swarm take the ids following this one
+    int loadVehicleCount = qMax(mockConfig->loadVehicleCount(), 1);
+    if (mockConfig->incrementVehicleId()) {
+        _nextVehicleSystemId += loadVehicleCount - 1;
+    }
+    MockLinkLoadGenerator::RateProfile_t loadRates;
+    if (!MockLinkLoadGenerator::parseRateProfile(mockConfig->loadProfile(), loadRates)) {
+        qWarning() << "MockLink: invalid load profile" << mockConfig->loadProfile();
+    }
+    _loadGenerator.setVehicles(_vehicleSystemId, loadVehicleCount, _firmwareType, _vehicleType, _vehicleLatitude, _vehicleLongitude, _vehicleAltitude);
+    _loadGenerator.setRates(loadRates);
+    _loadGenerator.setImpairments(mockConfig->loadLossPercent(), mockConfig->loadJitterMSecs(), mockConfig->loadBurstMSecs());
+
     QObject::connect(this, &MockLink::writeBytesQueuedSignal, this, &MockLink::_writeBytesQueued, Qt::QueuedConnection);
 
     union px4_custom_mode   px4_cm;
@@ -103,6 +125,10 @@ MockLink::MockLink(SharedLinkConfigurationPtr& config)
     moveToThread(this);
 
     _loadParams();
+    _padParams(mockConfig->loadParamCount());
+    if (mockConfig->loadMissionItemCount() > 0) {
+        _missionItemHandler.loadMission(mockConfig->loadMissionItemCount(), _vehicleLatitude, _vehicleLongitude, _firmwareType == MAV_AUTOPILOT_ARDUPILOTMEGA);
+    }
 
     _adsbVehicleCoordinate = QGeoCoordinate(_vehicleLatitude, _vehicleLongitude).atDistanceAndAzimuth(1000, _adsbAngle);
     _adsbVehicleCoordinate.setAltitude(100);
@@ -152,6 +178,11 @@ void MockLink::run(void)
     QObject::connect(&timer10HzTasks, &QTimer::timeout, this, &MockLink::_run10HzTasks);
     QObject::connect(&timer500HzTasks, &QTimer::timeout, this, &MockLink::_run500HzTasks);
 
+    if (_loadGenerator.active() || _loadGenerator.impaired()) {
+        // Coarse timers can be off by 5% which would throw out the generated rates
+        timer500HzTasks.setTimerType(Qt::PreciseTimer);
+    }
+
     timer1HzTasks.start(1000);
     timer10HzTasks.start(100);
     timer500HzTasks.start(2);
@@ -224,6 +255,26 @@ void MockLink::_run500HzTasks(void)
     if (_mavlinkStarted && _connected) {
         _paramRequestListWorker();
         _logDownloadWorker();
+        _runLoadGenerator();
+    }
+}
+
+/// Generates the load traffic and delivers whatever the impairments have released, in one read like a real link
+void MockLink::_runLoadGenerator(void)
+{
+    if (!_loadGenerator.active() && !_loadGenerator.impaired()) {
+        return;
+    }
+
+    qint64 nowMSecs = _runningTime.elapsed();
+    if (_loadGenerator.active()) {
+        _loadGenerator.generate(nowMSecs, static_cast<uint8_t>(_mavlinkChannel));
+    }
+
+    QByteArray bytes = _loadGenerator.takeDue(nowMSecs);
+    if (!bytes.isEmpty() && !_commLost) {
+        trafficStatistics()->addReceived(bytes.length());
+        emit bytesReceived(this, bytes);
     }
 }
 
@@ -303,6 +354,21 @@ void MockLink::_loadParams(void)
     }
 }
 
+/// Pads the autopilot parameters so the parameter load is the size of a real vehicle
+void MockLink::_padParams(int paramCount)
+{
+    QMap<QString, QVariant>&        mapParamName2Value          = _mapParamName2Value[MAV_COMP_ID_AUTOPILOT1];
+    QMap<QString, MAV_PARAM_TYPE>&  mapParamName2MavParamType   = _mapParamName2MavParamType[MAV_COMP_ID_AUTOPILOT1];
+
+    for (int i=0; mapParamName2Value.count() < paramCount; i++) {
+        QString paramName = QStringLiteral("LOAD_%1").arg(i, 4, 10, QChar('0'));
+        if (!mapParamName2Value.contains(paramName)) {
+            mapParamName2Value[paramName]           = QVariant(static_cast<float>(i));
+            mapParamName2MavParamType[paramName]    = MAV_PARAM_TYPE_REAL32;
+        }
+    }
+}
+
 void MockLink::_sendHeartBeat(void)
 {
     mavlink_message_t   msg;
@@ -485,11 +551,14 @@ void MockLink::_sendVibration(void)
 
 void MockLink::respondWithMavlinkMessage(const mavlink_message_t& msg)
 {
-    if (!_commLost) {
+    if (_loadGenerator.impaired()) {
+        _loadGenerator.send(msg, _runningTime.elapsed());
+    } else if (!_commLost) {
         uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
 
         int cBuffer = mavlink_msg_to_send_buffer(buffer, &msg);
         QByteArray bytes((char *)buffer, cBuffer);
+        trafficStatistics()->addReceived(bytes.length());
         emit bytesReceived(this, bytes);
     }
 }
@@ -837,6 +906,78 @@ void MockLink::_paramRequestListWorker(void)
     }
 }
 
+QString MockLink::createParamPackFile(void)
+{
+    // The param failure modes are only implemented for PARAM_REQUEST_LIST
+    if (_firmwareType != MAV_AUTOPILOT_ARDUPILOTMEGA || !_mapParamName2Value.contains(MAV_COMP_ID_AUTOPILOT1) ||
+            _failureMode == MockConfiguration::FailMissingParamOnInitialReqest || _failureMode == MockConfiguration::FailMissingParamOnAllRequests) {
+        return QString();
+    }
+
+    const QMap<QString, QVariant>&  mapParamName2Value  = _mapParamName2Value[MAV_COMP_ID_AUTOPILOT1];
+    QByteArray                      bytes;
+    QDataStream                     stream(&bytes, QIODevice::WriteOnly);
+
+    // Names are packed in the same order as the PARAM_REQUEST_LIST indices
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    stream << static_cast<quint16>(0x671b) << static_cast<quint16>(mapParamName2Value.count()) << static_cast<quint16>(mapParamName2Value.count());
+
+    QByteArray previousName;
+    for (const QString& paramName: mapParamName2Value.keys()) {
+        QByteArray  name            = paramName.toLatin1();
+        int         commonLength    = 0;
+        while (commonLength < qMin(15, name.length() - 1) && commonLength < previousName.length() && name[commonLength] == previousName[commonLength]) {
+            commonLength++;
+        }
+        previousName = name;
+
+        const QVariant& value = mapParamName2Value[paramName];
+        quint8          typeCode;
+        switch (_mapParamName2MavParamType[MAV_COMP_ID_AUTOPILOT1][paramName]) {
+        case MAV_PARAM_TYPE_INT8:
+            typeCode = 1;
+            break;
+        case MAV_PARAM_TYPE_INT16:
+            typeCode = 2;
+            break;
+        case MAV_PARAM_TYPE_INT32:
+            typeCode = 3;
+            break;
+        case MAV_PARAM_TYPE_REAL32:
+            typeCode = 4;
+            break;
+        default:
+            qCDebug(MockLinkLog) << "createParamPackFile type not supported by param.pck" << paramName;
+            return QString();
+        }
+
+        QByteArray suffix = name.mid(commonLength);
+        stream << typeCode << static_cast<quint8>(commonLength | ((suffix.length() - 1) << 4));
+        stream.writeRawData(suffix.constData(), suffix.length());
+        switch (typeCode) {
+        case 1:
+            stream << static_cast<qint8>(value.toInt());
+            break;
+        case 2:
+            stream << static_cast<qint16>(value.toInt());
+            break;
+        case 3:
+            stream << static_cast<qint32>(value.toInt());
+            break;
+        default:
+            stream << value.toFloat();
+            break;
+        }
+    }
+
+    QGCTemporaryFile tmpFile("MockLinkParamPack");
+    tmpFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    tmpFile.write(bytes);
+    tmpFile.close();
+    return tmpFile.fileName();
+}
+
 void MockLink::_handleParamSet(const mavlink_message_t& msg)
 {
     mavlink_param_set_t request;
@@ -1301,6 +1442,13 @@ MockConfiguration::MockConfiguration(MockConfiguration* source)
     _sendStatusText     = source->_sendStatusText;
     _incrementVehicleId = source->_incrementVehicleId;
     _failureMode        = source->_failureMode;
+    _loadVehicleCount   = source->_loadVehicleCount;
+    _loadProfile        = source->_loadProfile;
+    _loadLossPercent    = source->_loadLossPercent;
+    _loadJitterMSecs    = source->_loadJitterMSecs;
+    _loadBurstMSecs     = source->_loadBurstMSecs;
+    _loadParamCount     = source->_loadParamCount;
+    _loadMissionItemCount = source->_loadMissionItemCount;
 }
 
 void MockConfiguration::copyFrom(LinkConfiguration *source)
@@ -1318,6 +1466,13 @@ void MockConfiguration::copyFrom(LinkConfiguration *source)
     _sendStatusText     = usource->_sendStatusText;
     _incrementVehicleId = usource->_incrementVehicleId;
     _failureMode        = usource->_failureMode;
+    _loadVehicleCount   = usource->_loadVehicleCount;
+    _loadProfile        = usource->_loadProfile;
+    _loadLossPercent    = usource->_loadLossPercent;
+    _loadJitterMSecs    = usource->_loadJitterMSecs;
+    _loadBurstMSecs     = usource->_loadBurstMSecs;
+    _loadParamCount     = usource->_loadParamCount;
+    _loadMissionItemCount = usource->_loadMissionItemCount;
 }
 
 void MockConfiguration::saveSettings(QSettings& settings, const QString& root)
@@ -1328,6 +1483,13 @@ void MockConfiguration::saveSettings(QSettings& settings, const QString& root)
     settings.setValue(_sendStatusTextKey,       _sendStatusText);
     settings.setValue(_incrementVehicleIdKey,   _incrementVehicleId);
     settings.setValue(_failureModeKey,          (int)_failureMode);
+    settings.setValue(_loadVehicleCountKey,     _loadVehicleCount);
+    settings.setValue(_loadProfileKey,          _loadProfile);
+    settings.setValue(_loadLossPercentKey,      _loadLossPercent);
+    settings.setValue(_loadJitterMSecsKey,      _loadJitterMSecs);
+    settings.setValue(_loadBurstMSecsKey,       _loadBurstMSecs);
+    settings.setValue(_loadParamCountKey,       _loadParamCount);
+    settings.setValue(_loadMissionItemCountKey, _loadMissionItemCount);
     settings.sync();
     settings.endGroup();
 }
@@ -1340,6 +1502,13 @@ void MockConfiguration::loadSettings(QSettings& settings, const QString& root)
     _sendStatusText     = settings.value(_sendStatusTextKey, false).toBool();
     _incrementVehicleId = settings.value(_incrementVehicleIdKey, true).toBool();
     _failureMode        = (FailureMode_t)settings.value(_failureModeKey, (int)FailNone).toInt();
+    _loadVehicleCount   = settings.value(_loadVehicleCountKey, 1).toInt();
+    _loadProfile        = settings.value(_loadProfileKey).toString();
+    _loadLossPercent    = settings.value(_loadLossPercentKey, 0).toDouble();
+    _loadJitterMSecs    = settings.value(_loadJitterMSecsKey, 0).toInt();
+    _loadBurstMSecs     = settings.value(_loadBurstMSecsKey, 0).toInt();
+    _loadParamCount     = settings.value(_loadParamCountKey, 0).toInt();
+    _loadMissionItemCount = settings.value(_loadMissionItemCountKey, 0).toInt();
     settings.endGroup();
 }
 
@@ -1615,6 +1784,17 @@ bool MockLink::_handleRequestMessage(const mavlink_command_long_t& request, bool
     return false;
 }
 
+/// @return CRC of the resource served for a metadata uri, so caches keyed by the uid follow changes to it
+uint32_t MockLink::_metaDataUid(const QString& resource)
+{
+    QFile file(resource);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    QByteArray bytes = file.readAll();
+    return QGC::crc32(reinterpret_cast<const quint8*>(bytes.constData()), static_cast<unsigned>(bytes.size()), 0);
+}
+
 void MockLink::_sendVersionMetaData(void)
 {
     mavlink_message_t   responseMsg;
@@ -1631,7 +1811,7 @@ void MockLink::_sendVersionMetaData(void)
                                                 &responseMsg,
                                                 0,                          // time_boot_ms
                                                 COMP_METADATA_TYPE_VERSION,
-                                                1,                          // comp_metadata_uid
+                                                _metaDataUid(":MockLink/Version.MetaData.json.gz"),   // comp_metadata_uid
                                                 metaDataURI,
                                                 0,                          // comp_translation_uid
                                                 translationURI);
@@ -1654,7 +1834,7 @@ void MockLink::_sendParameterMetaData(void)
                                                 &responseMsg,
                                                 0,                              // time_boot_ms
                                                 COMP_METADATA_TYPE_PARAMETER,
-                                                1,                              // comp_metadata_uid
+                                                _metaDataUid(":MockLink/Parameter.MetaData.json"),  // comp_metadata_uid
                                                 metaDataURI,
                                                 0,                              // comp_translation_uid
                                                 translationURI);
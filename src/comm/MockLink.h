@@ -16,6 +16,7 @@
 
 #include "MockLinkMissionItemHandler.h"
 #include "MockLinkFTP.h"
+#include "MockLinkLoadGenerator.h"
 #include "QGCMAVLink.h"
 
 Q_DECLARE_LOGGING_CATEGORY(MockLinkLog)
@@ -35,6 +36,13 @@ public:
     Q_PROPERTY(int      vehicle             READ vehicle            WRITE setVehicle            NOTIFY vehicleChanged)
     Q_PROPERTY(bool     sendStatus          READ sendStatusText     WRITE setSendStatusText     NOTIFY sendStatusChanged)
     Q_PROPERTY(bool     incrementVehicleId  READ incrementVehicleId WRITE setIncrementVehicleId NOTIFY incrementVehicleIdChanged)
+    Q_PROPERTY(int      loadVehicleCount    READ loadVehicleCount   WRITE setLoadVehicleCount   NOTIFY loadChanged)     ///< Vehicles sent over the link, the extra ones are telemetry only
+    Q_PROPERTY(QString  loadProfile         READ loadProfile        WRITE setLoadProfile        NOTIFY loadChanged)     ///< Rate profile, see MockLinkLoadGenerator::parseRateProfile
+    Q_PROPERTY(double   loadLossPercent     READ loadLossPercent    WRITE setLoadLossPercent    NOTIFY loadChanged)
+    Q_PROPERTY(int      loadJitterMSecs     READ loadJitterMSecs    WRITE setLoadJitterMSecs    NOTIFY loadChanged)
+    Q_PROPERTY(int      loadBurstMSecs      READ loadBurstMSecs     WRITE setLoadBurstMSecs     NOTIFY loadChanged)
+    Q_PROPERTY(int      loadParamCount      READ loadParamCount     WRITE setLoadParamCount     NOTIFY loadChanged)     ///< Autopilot parameters are padded to this many, 0 for no padding
+    Q_PROPERTY(int      loadMissionItemCount READ loadMissionItemCount WRITE setLoadMissionItemCount NOTIFY loadChanged) ///< Mission items on the vehicle at start
 
     int     firmware                (void)                      { return (int)_firmwareType; }
     void    setFirmware             (int type)                  { _firmwareType = (MAV_AUTOPILOT)type; emit firmwareChanged(); }
@@ -52,6 +60,21 @@ public:
     void            setVehicleType      (MAV_TYPE vehicleType)          { _vehicleType = vehicleType; emit vehicleChanged(); }
     void            setSendStatusText   (bool sendStatusText)           { _sendStatusText = sendStatusText; emit sendStatusChanged(); }
 
+    int     loadVehicleCount        (void) const { return _loadVehicleCount; }
+    QString loadProfile             (void) const { return _loadProfile; }
+    double  loadLossPercent         (void) const { return _loadLossPercent; }
+    int     loadJitterMSecs         (void) const { return _loadJitterMSecs; }
+    int     loadBurstMSecs          (void) const { return _loadBurstMSecs; }
+    int     loadParamCount          (void) const { return _loadParamCount; }
+    int     loadMissionItemCount    (void) const { return _loadMissionItemCount; }
+    void    setLoadVehicleCount     (int loadVehicleCount)          { _loadVehicleCount = loadVehicleCount; emit loadChanged(); }
+    void    setLoadProfile          (const QString& loadProfile)    { _loadProfile = loadProfile; emit loadChanged(); }
+    void    setLoadLossPercent      (double loadLossPercent)        { _loadLossPercent = loadLossPercent; emit loadChanged(); }
+    void    setLoadJitterMSecs      (int loadJitterMSecs)           { _loadJitterMSecs = loadJitterMSecs; emit loadChanged(); }
+    void    setLoadBurstMSecs       (int loadBurstMSecs)            { _loadBurstMSecs = loadBurstMSecs; emit loadChanged(); }
+    void    setLoadParamCount       (int loadParamCount)            { _loadParamCount = loadParamCount; emit loadChanged(); }
+    void    setLoadMissionItemCount (int loadMissionItemCount)      { _loadMissionItemCount = loadMissionItemCount; emit loadChanged(); }
+
     typedef enum {
         FailNone,                           // No failures
         FailParamNoReponseToRequestList,    // Do no respond to PARAM_REQUEST_LIST
@@ -74,6 +97,7 @@ signals:
     void vehicleChanged             (void);
     void sendStatusChanged          (void);
     void incrementVehicleIdChanged  (void);
+    void loadChanged                (void);
 
 private:
     MAV_AUTOPILOT   _firmwareType       = MAV_AUTOPILOT_PX4;
@@ -81,12 +105,26 @@ private:
     bool            _sendStatusText     = false;
     FailureMode_t   _failureMode        = FailNone;
     bool            _incrementVehicleId = true;
+    int             _loadVehicleCount   = 1;
+    QString         _loadProfile;
+    double          _loadLossPercent    = 0;
+    int             _loadJitterMSecs    = 0;
+    int             _loadBurstMSecs     = 0;
+    int             _loadParamCount     = 0;
+    int             _loadMissionItemCount = 0;
 
     static const char* _firmwareTypeKey;
     static const char* _vehicleTypeKey;
     static const char* _sendStatusTextKey;
     static const char* _incrementVehicleIdKey;
     static const char* _failureModeKey;
+    static const char* _loadVehicleCountKey;
+    static const char* _loadProfileKey;
+    static const char* _loadLossPercentKey;
+    static const char* _loadJitterMSecsKey;
+    static const char* _loadBurstMSecsKey;
+    static const char* _loadParamCountKey;
+    static const char* _loadMissionItemCountKey;
 };
 
 class MockLink : public LinkInterface
@@ -111,11 +149,17 @@ public:
 
     void emitRemoteControlChannelRawChanged(int channel, uint16_t raw);
 
-    /// Sends the specified mavlink message to QGC
+    /// Sends the specified mavlink message to QGC. With load impairments configured this must be called from the link thread.
     void respondWithMavlinkMessage(const mavlink_message_t& msg);
 
+    const MockLinkLoadGenerator& loadGenerator(void) const { return _loadGenerator; }
+
     MockLinkFTP* mockLinkFTP(void) { return _mockLinkFTP; }
 
+    /// Writes the autopilot parameters to a temporary file in the ArduPilot param.pck format, served as @PARAM/param.pck by MockLinkFTP
+    ///     @return Temporary file name, empty if parameters are not available over FTP
+    QString createParamPackFile(void);
+
     // Overrides from LinkInterface
     bool isConnected(void) const override { return _connected; }
     void disconnect (void) override;
@@ -139,6 +183,15 @@ public:
     /// Reset the state of the MissionItemHandler to no items, no transactions in progress.
     void resetMissionItemHandler(void) { _missionItemHandler.reset(); }
 
+    /// Delays the responses to mission item read requests, 0 to respond immediately
+    void setMissionItemReadResponseDelay(int msecs) { _missionItemHandler.setReadResponseDelay(msecs); }
+
+    /// Replaces the vehicle's mission with itemCount waypoints around the vehicle position
+    void loadMissionItems(int itemCount) { _missionItemHandler.loadMission(itemCount, _vehicleLatitude, _vehicleLongitude, _firmwareType == MAV_AUTOPILOT_ARDUPILOTMEGA); }
+
+    /// Returns the number of plan write sequences the vehicle has seen
+    int missionWriteSequenceCount(void) const { return _missionItemHandler.writeSequenceStartCount(); }
+
     /// Returns the filename for the simulated log file. Only available after a download is requested.
     QString logDownloadFile(void) { return _logDownloadFilename; }
 
@@ -199,6 +252,8 @@ private:
     void _handleIncomingNSHBytes        (const char* bytes, int cBytes);
     void _handleIncomingMavlinkBytes    (const uint8_t* bytes, int cBytes);
     void _loadParams                    (void);
+    void _padParams                     (int paramCount);
+    void _runLoadGenerator              (void);
     void _handleHeartBeat               (const mavlink_message_t& msg);
     void _handleSetMode                 (const mavlink_message_t& msg);
     void _handleParamRequestList        (const mavlink_message_t& msg);
@@ -229,6 +284,7 @@ private:
     void _moveADSBVehicle               (void);
     void _sendVersionMetaData           (void);
     void _sendParameterMetaData         (void);
+    uint32_t _metaDataUid               (const QString& resource);
 
     static MockLink* _startMockLinkWorker(QString configName, MAV_AUTOPILOT firmwareType, MAV_TYPE vehicleType, bool sendStatusText, MockConfiguration::FailureMode_t failureMode);
     static MockLink* _startMockLink(MockConfiguration* mockConfig);
@@ -268,6 +324,8 @@ private:
 
     MockLinkFTP* _mockLinkFTP = nullptr;
 
+    MockLinkLoadGenerator _loadGenerator;
+
     bool _sendStatusText;
     bool _apmSendHomePositionOnEmptyList;
     MockConfiguration::FailureMode_t _failureMode;
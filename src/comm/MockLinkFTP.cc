@@ -10,6 +10,11 @@
 
 #include "MockLinkFTP.h"
 #include "MockLink.h"
+#include "QGC.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
 
 const MockLinkFTP::ErrorMode_t MockLinkFTP::rgFailureModes[] = {
     MockLinkFTP::errModeNoResponse,
@@ -21,6 +26,14 @@ const MockLinkFTP::ErrorMode_t MockLinkFTP::rgFailureModes[] = {
 const size_t MockLinkFTP::cFailureModes = sizeof(MockLinkFTP::rgFailureModes) / sizeof(MockLinkFTP::rgFailureModes[0]);
 
 const char* MockLinkFTP::sizeFilenamePrefix = "mocklink-size-";
+const char* MockLinkFTP::logDirectory       = "/fs/microsd/log";
+
+static const char* _mockLogDate = "2020-10-01";
+
+QString MockLinkFTP::mockLogPath(int index)
+{
+    return QStringLiteral("%1/%2/1%3_00_00.ulg").arg(logDirectory).arg(_mockLogDate).arg(index);
+}
 
 MockLinkFTP::MockLinkFTP(uint8_t systemIdServer, uint8_t componentIdServer, MockLink* mockLink)
     : _systemIdServer   (systemIdServer)
@@ -40,30 +53,60 @@ void MockLinkFTP::ensureNullTemination(MavlinkFTP::Request* request)
     }
 }
 
-/// @brief Handles List command requests. Only supports root folder paths.
-///         File list returned is set using the setFileList method.
+/// @brief Entries of the mock log directory tree
+/// @return false: not part of the log directory tree
+bool MockLinkFTP::_logDirectoryList(const QString& path, QStringList& entries)
+{
+    entries.clear();
+    if (path == logDirectory) {
+        // PX4 sends S for entries it skips
+        entries << QStringLiteral("S") << QStringLiteral("D%1").arg(_mockLogDate);
+        return true;
+    } else if (path == QStringLiteral("%1/%2").arg(logDirectory).arg(_mockLogDate)) {
+        for (int i=0; i<mockLogCount; i++) {
+            entries << QStringLiteral("F%1\t%2").arg(QFileInfo(mockLogPath(i)).fileName()).arg(mockLogSize(i));
+        }
+        return true;
+    }
+    return false;
+}
+
+/// @brief Handles List command requests. Supports the root folder, with the file list set using the setFileList
+///         method, and the log directory tree. Lists which don't fit a single response continue from the offset.
 void MockLinkFTP::_listCommand(uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber)
 {
-    // FIXME: Does not support directories that span multiple packets
-    
     MavlinkFTP::Request  ackResponse;
     QString                     path;
+    QStringList                 entries;
     uint16_t                    outgoingSeqNumber = _nextSeqNumber(seqNumber);
 
+    _listCommandCount++;
     ensureNullTemination(request);
 
-    // We only support root path
     path = (char *)&request->data[0];
-    if (!path.isEmpty() && path != "/") {
+    if (path.isEmpty() || path == "/") {
+        entries = _fileList;
+    } else if (!_logDirectoryList(path, entries)) {
         _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrFail, outgoingSeqNumber, MavlinkFTP::kCmdListDirectory);
         return;
     }
     
     // Offset requested is past the end of the list
-    if (request->hdr.offset > (uint32_t)_fileList.size()) {
+    if (request->hdr.offset >= (uint32_t)entries.size()) {
         _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrEOF, outgoingSeqNumber, MavlinkFTP::kCmdListDirectory);
         return;
     }
+
+    if (request->hdr.offset != 0) {
+        if (_errMode == errModeNakSecondResponse) {
+            // Nak error all subsequent requests
+            _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrFail, outgoingSeqNumber, MavlinkFTP::kCmdListDirectory);
+            return;
+        } else if (_errMode == errModeNoSecondResponse) {
+            // No response for all subsequent requests
+            return;
+        }
+    }
     
     ackResponse.hdr.opcode = MavlinkFTP::kRspAck;
     ackResponse.hdr.req_opcode = MavlinkFTP::kCmdListDirectory;
@@ -71,30 +114,18 @@ void MockLinkFTP::_listCommand(uint8_t senderSystemId, uint8_t senderComponentId
     ackResponse.hdr.offset = request->hdr.offset;
     ackResponse.hdr.size = 0;
 
-    if (request->hdr.offset == 0) {
-        // Requesting first batch of file names
-        Q_ASSERT(_fileList.size());
-        char *bufPtr = (char *)&ackResponse.data[0];
-        for (int i=0; i<_fileList.size(); i++) {
-            strcpy(bufPtr, _fileList[i].toStdString().c_str());
-            uint8_t cchFilename = static_cast<uint8_t>(strlen(bufPtr));
-            Q_ASSERT(cchFilename);
-            ackResponse.hdr.size += cchFilename + 1;
-            bufPtr += cchFilename + 1;
+    char *bufPtr = (char *)&ackResponse.data[0];
+    for (int i=request->hdr.offset; i<entries.size(); i++) {
+        std::string entry = entries[i].toStdString();
+        if (ackResponse.hdr.size + entry.length() + 1 > sizeof(ackResponse.data)) {
+            break;
         }
-
-        _sendResponse(senderSystemId, senderComponentId, &ackResponse, outgoingSeqNumber);
-    } else if (_errMode == errModeNakSecondResponse) {
-        // Nak error all subsequent requests
-        _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrFail, outgoingSeqNumber, MavlinkFTP::kCmdListDirectory);
-        return;
-    } else if (_errMode == errModeNoSecondResponse) {
-        // No response for all subsequent requests
-        return;
-    } else {
-        // FIXME: Does not support directories that span multiple packets
-        _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrEOF, outgoingSeqNumber, MavlinkFTP::kCmdListDirectory);
+        strcpy(bufPtr, entry.c_str());
+        ackResponse.hdr.size += static_cast<uint8_t>(entry.length() + 1);
+        bufPtr += entry.length() + 1;
     }
+
+    _sendResponse(senderSystemId, senderComponentId, &ackResponse, outgoingSeqNumber);
 }
 
 void MockLinkFTP::_openCommand(uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber)
@@ -114,7 +145,9 @@ void MockLinkFTP::_openCommand(uint8_t senderSystemId, uint8_t senderComponentId
     _currentFile.close();
 
     QString sizePrefix = sizeFilenamePrefix;
-    if (path.startsWith(sizePrefix)) {
+    if (_fileData.contains(path)) {
+        tmpFilename = _createDataTempFile(_fileData[path]);
+    } else if (path.startsWith(sizePrefix)) {
         QString sizeString = path.right(path.length() - sizePrefix.length());
         tmpFilename = _createTestTempFile(sizeString.toInt());
     } else if (path == "/version.json") {
@@ -123,6 +156,14 @@ void MockLinkFTP::_openCommand(uint8_t senderSystemId, uint8_t senderComponentId
         tmpFilename = ":MockLink/Version.MetaData.json.gz";
     } else if (path == "/parameter.json") {
         tmpFilename = ":MockLink/Parameter.MetaData.json";
+    } else if (path == "@PARAM/param.pck") {
+        tmpFilename = _mockLink->createParamPackFile();
+    } else {
+        for (int i=0; i<mockLogCount; i++) {
+            if (path == mockLogPath(i)) {
+                tmpFilename = _createTestTempFile(mockLogSize(i));
+            }
+        }
     }
 
     if (!tmpFilename.isEmpty()) {
@@ -237,6 +278,58 @@ void MockLinkFTP::_burstReadCommand(uint8_t senderSystemId, uint8_t senderCompon
     }
 }
 
+void MockLinkFTP::_createCommand(uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber)
+{
+    MavlinkFTP::Request response;
+    uint16_t            outgoingSeqNumber = _nextSeqNumber(seqNumber);
+
+    ensureNullTemination(request);
+    QString path = (char *)request->data;
+
+    _uploadFile.close();
+    _uploadFile.setFileName(_uploadPath(path));
+    if (!_uploadFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        _sendNakErrno(senderSystemId, senderComponentId, _uploadFile.error(), outgoingSeqNumber, MavlinkFTP::kCmdCreateFile);
+        return;
+    }
+
+    response.hdr.opcode     = MavlinkFTP::kRspAck;
+    response.hdr.req_opcode = MavlinkFTP::kCmdCreateFile;
+    response.hdr.session    = _sessionId;
+    response.hdr.size       = 0;
+
+    _sendResponse(senderSystemId, senderComponentId, &response, outgoingSeqNumber);
+}
+
+void MockLinkFTP::_writeCommand(uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber)
+{
+    MavlinkFTP::Request response;
+    uint16_t            outgoingSeqNumber = _nextSeqNumber(seqNumber);
+
+    if (request->hdr.session != _sessionId || !_uploadFile.isOpen()) {
+        _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrInvalidSession, outgoingSeqNumber, MavlinkFTP::kCmdWriteFile);
+        return;
+    }
+
+    _uploadFile.seek(request->hdr.offset);
+    qint64 bytesWritten = _uploadFile.write((const char*)request->data, request->hdr.size);
+    _uploadFile.flush();
+    if (bytesWritten != request->hdr.size) {
+        _sendNakErrno(senderSystemId, senderComponentId, _uploadFile.error(), outgoingSeqNumber, MavlinkFTP::kCmdWriteFile);
+        return;
+    }
+
+    // Ack contains number of bytes written
+    response.hdr.opcode         = MavlinkFTP::kRspAck;
+    response.hdr.req_opcode     = MavlinkFTP::kCmdWriteFile;
+    response.hdr.session        = _sessionId;
+    response.hdr.offset         = request->hdr.offset;
+    response.hdr.size           = sizeof(uint32_t);
+    response.writeFileLength    = static_cast<uint32_t>(bytesWritten);
+
+    _sendResponse(senderSystemId, senderComponentId, &response, outgoingSeqNumber);
+}
+
 void MockLinkFTP::_terminateCommand(uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber)
 {
     uint16_t outgoingSeqNumber = _nextSeqNumber(seqNumber);
@@ -246,6 +339,7 @@ void MockLinkFTP::_terminateCommand(uint8_t senderSystemId, uint8_t senderCompon
         return;
     }
     
+    _uploadFile.close();
     _sendAck(senderSystemId, senderComponentId, outgoingSeqNumber, MavlinkFTP::kCmdTerminateSession);
 
     emit terminateCommandReceived();
@@ -262,6 +356,39 @@ void MockLinkFTP::_resetCommand(uint8_t senderSystemId, uint8_t senderComponentI
     emit resetCommandReceived();
 }
 
+/// Uploads are written to the temp location using the file name from the vehicle path
+QString MockLinkFTP::_uploadPath(const QString& vehiclePath) const
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).absoluteFilePath(QStringLiteral("MockLinkFTPUpload-%1").arg(QFileInfo(vehiclePath).fileName()));
+}
+
+void MockLinkFTP::_calcFileCRC32Command(uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber)
+{
+    MavlinkFTP::Request response;
+    uint16_t            outgoingSeqNumber = _nextSeqNumber(seqNumber);
+
+    ensureNullTemination(request);
+    QString path = (char *)request->data;
+
+    // Files uploaded earlier are what the vehicle has, everything else isn't there
+    QFile file(_uploadPath(path));
+    if (!file.open(QIODevice::ReadOnly)) {
+        _sendNak(senderSystemId, senderComponentId, MavlinkFTP::kErrFailFileNotFound, outgoingSeqNumber, MavlinkFTP::kCmdCalcFileCRC32);
+        return;
+    }
+    QByteArray bytes = file.readAll();
+
+    response.hdr.opcode     = MavlinkFTP::kRspAck;
+    response.hdr.req_opcode = MavlinkFTP::kCmdCalcFileCRC32;
+    response.hdr.session    = 0;
+    response.hdr.offset     = 0;
+    response.hdr.size       = sizeof(uint32_t);
+    uint32_t crc = QGC::crc32(reinterpret_cast<const quint8*>(bytes.constData()), static_cast<unsigned>(bytes.size()), 0);
+    memcpy(response.data, &crc, sizeof(uint32_t));
+
+    _sendResponse(senderSystemId, senderComponentId, &response, outgoingSeqNumber);
+}
+
 void MockLinkFTP::mavlinkMessageReceived(const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL) {
@@ -333,6 +460,14 @@ void MockLinkFTP::mavlinkMessageReceived(const mavlink_message_t& message)
         _burstReadCommand(message.sysid, message.compid, request, incomingSeqNumber);
         break;
 
+    case MavlinkFTP::kCmdCreateFile:
+        _createCommand(message.sysid, message.compid, request, incomingSeqNumber);
+        break;
+
+    case MavlinkFTP::kCmdWriteFile:
+        _writeCommand(message.sysid, message.compid, request, incomingSeqNumber);
+        break;
+
     case MavlinkFTP::kCmdTerminateSession:
         _terminateCommand(message.sysid, message.compid, request, incomingSeqNumber);
         break;
@@ -341,6 +476,10 @@ void MockLinkFTP::mavlinkMessageReceived(const mavlink_message_t& message)
         _resetCommand(message.sysid, message.compid, incomingSeqNumber);
         break;
 
+    case MavlinkFTP::kCmdCalcFileCRC32:
+        _calcFileCRC32Command(message.sysid, message.compid, request, incomingSeqNumber);
+        break;
+
     default:
         // nack for all NYI opcodes
         _sendNak(message.sysid, message.compid, MavlinkFTP::kErrUnknownCommand, outgoingSeqNumber, (MavlinkFTP::OpCode_t)request->hdr.opcode);
@@ -436,3 +575,12 @@ QString MockLinkFTP::_createTestTempFile(int size)
     tmpFile.close();
     return tmpFile.fileName();
 }
+
+QString MockLinkFTP::_createDataTempFile(const QByteArray& data)
+{
+    QGCTemporaryFile tmpFile("MockLinkFTPData");
+    tmpFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    tmpFile.write(data);
+    tmpFile.close();
+    return tmpFile.fileName();
+}
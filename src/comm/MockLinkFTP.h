@@ -12,6 +12,7 @@
 
 #include "QGCMAVLink.h"
 
+#include <QMap>
 #include <QStringList>
 #include <QFile>
 
@@ -55,8 +56,24 @@ public:
 
     void enableRandromDrops(bool enable) { _randomDropsEnabled = enable; }
 
+    /// @return Local file which receives the data of the last CreateFile/WriteFile commands
+    QString uploadFileName(void) const { return _uploadFile.fileName(); }
+
+    /// Serves the data for the path in place of the built in files, for example an ArduPilot @MISSION plan file
+    void setFileData    (const QString& path, const QByteArray& data) { _fileData[path] = data; }
+    void clearFileData  (void) { _fileData.clear(); }
+
+    /// @return ListDirectory commands received so far
+    int listCommandCount(void) const { return _listCommandCount; }
+
     static const char* sizeFilenamePrefix;
 
+    /// Log directory of the mock vehicle, with one dated directory holding mockLogCount logs of mockLogSize(index) bytes
+    static const char*  logDirectory;
+    static const int    mockLogCount = 2;
+    static int          mockLogSize     (int index) { return (index + 1) * 3 * 1024 + 7; }
+    static QString      mockLogPath     (int index);
+
 signals:
     /// You can connect to this signal to be notified when the server receives a Terminate command.
     void terminateCommandReceived(void);
@@ -73,17 +90,26 @@ private:
     void        _openCommand            (uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber);
     void        _readCommand            (uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber);
     void        _burstReadCommand          (uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber);
+    void        _createCommand          (uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber);
+    void        _writeCommand           (uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber);
     void        _terminateCommand       (uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber);
     void        _resetCommand           (uint8_t senderSystemId, uint8_t senderComponentId, uint16_t seqNumber);
+    void        _calcFileCRC32Command   (uint8_t senderSystemId, uint8_t senderComponentId, MavlinkFTP::Request* request, uint16_t seqNumber);
+    QString     _uploadPath             (const QString& vehiclePath) const;
     uint16_t    _nextSeqNumber          (uint16_t seqNumber);
     QString     _createTestTempFile     (int size);
+    QString     _createDataTempFile     (const QByteArray& data);
+    bool        _logDirectoryList       (const QString& path, QStringList& entries);
     
     /// if request is a string, this ensures it's null-terminated
     static void ensureNullTemination(MavlinkFTP::Request* request);
 
     QStringList _fileList;  ///< List of files returned by List command
     
+    QMap<QString, QByteArray> _fileData;    ///< Set by setFileData
+    
     QFile                   _currentFile;
+    QFile                   _uploadFile;
     ErrorMode_t             _errMode            = errModeNone;  ///< Currently set error mode, as specified by setErrorMode
     const uint8_t           _systemIdServer;                    ///< System ID for server
     const uint8_t           _componentIdServer;                 ///< Component ID for server
@@ -92,6 +118,7 @@ private:
     uint16_t                _lastReplySequence  = 0;
     mavlink_message_t       _lastReply;
     bool                    _randomDropsEnabled = false;
+    int                     _listCommandCount   = 0;
 
     static const uint8_t    _sessionId          = 1;    ///< We only support a single fixed session
 };
@@ -0,0 +1,358 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MockLinkLoadGenerator.h"
+
+#include <QStringList>
+#include <QtMath>
+
+bool MockLinkLoadGenerator::canGenerate(uint32_t msgId)
+{
+    switch (msgId) {
+    case MAVLINK_MSG_ID_HEARTBEAT:
+    case MAVLINK_MSG_ID_SYS_STATUS:
+    case MAVLINK_MSG_ID_GPS_RAW_INT:
+    case MAVLINK_MSG_ID_ATTITUDE:
+    case MAVLINK_MSG_ID_ATTITUDE_QUATERNION:
+    case MAVLINK_MSG_ID_LOCAL_POSITION_NED:
+    case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+    case MAVLINK_MSG_ID_SERVO_OUTPUT_RAW:
+    case MAVLINK_MSG_ID_VFR_HUD:
+    case MAVLINK_MSG_ID_HIGHRES_IMU:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool MockLinkLoadGenerator::parseRateProfile(const QString& profile, RateProfile_t& rates)
+{
+    rates.clear();
+
+    // Rates used by a telemetry radio
+    if (profile == QStringLiteral("telemetry")) {
+        rates = {
+            { MAVLINK_MSG_ID_ATTITUDE,              10 },
+            { MAVLINK_MSG_ID_GLOBAL_POSITION_INT,   3 },
+            { MAVLINK_MSG_ID_VFR_HUD,               4 },
+            { MAVLINK_MSG_ID_SYS_STATUS,            2 },
+            { MAVLINK_MSG_ID_GPS_RAW_INT,           2 },
+            { MAVLINK_MSG_ID_SERVO_OUTPUT_RAW,      2 },
+        };
+        return true;
+    }
+
+    // Rates used by a companion computer or USB connection with everything turned up
+    if (profile == QStringLiteral("stress")) {
+        rates = {
+            { MAVLINK_MSG_ID_ATTITUDE,              250 },
+            { MAVLINK_MSG_ID_ATTITUDE_QUATERNION,   250 },
+            { MAVLINK_MSG_ID_HIGHRES_IMU,           250 },
+            { MAVLINK_MSG_ID_LOCAL_POSITION_NED,    100 },
+            { MAVLINK_MSG_ID_GLOBAL_POSITION_INT,   50 },
+            { MAVLINK_MSG_ID_VFR_HUD,               50 },
+            { MAVLINK_MSG_ID_SERVO_OUTPUT_RAW,      50 },
+            { MAVLINK_MSG_ID_GPS_RAW_INT,           10 },
+            { MAVLINK_MSG_ID_SYS_STATUS,            10 },
+        };
+        return true;
+    }
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+    const QStringList pairs = profile.split(',', QString::SkipEmptyParts);
+#else
+    const QStringList pairs = profile.split(',', Qt::SkipEmptyParts);
+#endif
+    for (const QString& pair: pairs) {
+        QStringList parts = pair.split(':');
+        bool        msgIdOk = false;
+        bool        rateOk = false;
+
+        if (parts.count() != 2) {
+            return false;
+        }
+        MessageRate_t rate;
+        rate.msgId  = parts[0].trimmed().toUInt(&msgIdOk);
+        rate.rateHz = parts[1].trimmed().toDouble(&rateOk);
+        if (!msgIdOk || !rateOk || rate.rateHz <= 0 || !canGenerate(rate.msgId)) {
+            return false;
+        }
+        rates.append(rate);
+    }
+
+    return true;
+}
+
+void MockLinkLoadGenerator::setVehicles(uint8_t firstSystemId, int vehicleCount, MAV_AUTOPILOT firmwareType, MAV_TYPE vehicleType, double latitude, double longitude, double altitude)
+{
+    _firstSystemId  = firstSystemId;
+    _vehicleCount   = vehicleCount < 1 ? 1 : vehicleCount;
+    _firmwareType   = firmwareType;
+    _vehicleType    = vehicleType;
+    _latitude       = latitude;
+    _longitude      = longitude;
+    _altitude       = altitude;
+    _resetSchedule();
+}
+
+void MockLinkLoadGenerator::setRates(const RateProfile_t& rates)
+{
+    _rates = rates;
+    _resetSchedule();
+}
+
+void MockLinkLoadGenerator::setImpairments(double lossPercent, int jitterMSecs, int burstMSecs)
+{
+    _lossPercent    = lossPercent;
+    _jitterMSecs    = jitterMSecs;
+    _burstMSecs     = burstMSecs;
+}
+
+void MockLinkLoadGenerator::_resetSchedule(void)
+{
+    _vehicles.clear();
+    _scheduleMSecs = -1;
+
+    for (int i=0; i<_vehicleCount; i++) {
+        Vehicle_t vehicle;
+        vehicle.systemId    = static_cast<uint8_t>(_firstSystemId + i);
+        vehicle.txSeq       = 0;
+
+        // MockLink sends the heartbeat of its own vehicle, the others need one to show up at all
+        bool hasHeartbeat = false;
+        for (const MessageRate_t& rate: _rates) {
+            if (rate.msgId == MAVLINK_MSG_ID_HEARTBEAT) {
+                hasHeartbeat = true;
+                if (i == 0) {
+                    continue;
+                }
+            }
+            vehicle.rates.append(rate);
+        }
+        if (i != 0 && !hasHeartbeat) {
+            MessageRate_t heartbeatRate = { MAVLINK_MSG_ID_HEARTBEAT, 1 };
+            vehicle.rates.append(heartbeatRate);
+        }
+
+        _vehicles.append(vehicle);
+    }
+}
+
+void MockLinkLoadGenerator::generate(qint64 nowMSecs, uint8_t mavlinkChannel)
+{
+    if (_scheduleMSecs == -1) {
+        // Vehicles are spread across the first interval so their messages don't all line up
+        _scheduleMSecs = nowMSecs;
+        for (int i=0; i<_vehicles.count(); i++) {
+            Vehicle_t& vehicle = _vehicles[i];
+            vehicle.nextDueMSecs.clear();
+            for (const MessageRate_t& rate: vehicle.rates) {
+                vehicle.nextDueMSecs.append(nowMSecs + (1000.0 / rate.rateHz) * i / _vehicles.count());
+            }
+        }
+    }
+
+    mavlink_status_t*   status = mavlink_get_channel_status(mavlinkChannel);
+    mavlink_message_t   message;
+
+    for (int i=0; i<_vehicles.count(); i++) {
+        Vehicle_t& vehicle = _vehicles[i];
+
+        // Each simulated vehicle numbers its own messages, the first one shares MockLink's sequence
+        uint8_t linkTxSeq = status->current_tx_seq;
+        if (i != 0) {
+            status->current_tx_seq = vehicle.txSeq;
+        }
+
+        for (int j=0; j<vehicle.rates.count(); j++) {
+            double& nextDueMSecs = vehicle.nextDueMSecs[j];
+            if (nowMSecs - nextDueMSecs > maxCatchUpMSecs) {
+                nextDueMSecs = nowMSecs;
+            }
+            while (nextDueMSecs <= nowMSecs) {
+                _pack(vehicle, vehicle.rates[j].msgId, mavlinkChannel, nowMSecs, message);
+                send(message, nowMSecs);
+                _generatedCount++;
+                nextDueMSecs += 1000.0 / vehicle.rates[j].rateHz;
+            }
+        }
+
+        if (i != 0) {
+            vehicle.txSeq = status->current_tx_seq;
+            status->current_tx_seq = linkTxSeq;
+        }
+    }
+}
+
+void MockLinkLoadGenerator::_pack(const Vehicle_t& vehicle, uint32_t msgId, uint8_t mavlinkChannel, qint64 nowMSecs, mavlink_message_t& message)
+{
+    uint8_t     sysId       = vehicle.systemId;
+    uint8_t     compId      = MAV_COMP_ID_AUTOPILOT1;
+    int         index       = sysId - _firstSystemId;
+    uint32_t    bootMSecs   = static_cast<uint32_t>(nowMSecs);
+    uint64_t    bootUSecs   = static_cast<uint64_t>(nowMSecs) * 1000;
+    // Vehicles circle slowly around their own spot so every message carries changing values
+    double      angle       = qDegreesToRadians(static_cast<double>((nowMSecs / 100 + index * 10) % 360));
+    double      latitude    = _latitude + (index * 0.0001) + (qSin(angle) * 0.0001);
+    double      longitude   = _longitude + (index * 0.0001) + (qCos(angle) * 0.0001);
+    float       yaw         = static_cast<float>(angle - M_PI);
+
+    switch (msgId) {
+    case MAVLINK_MSG_ID_HEARTBEAT:
+    {
+        mavlink_heartbeat_t heartbeat = {};
+        heartbeat.type              = _vehicleType;
+        heartbeat.autopilot         = _firmwareType;
+        heartbeat.base_mode         = MAV_MODE_FLAG_MANUAL_INPUT_ENABLED | MAV_MODE_FLAG_CUSTOM_MODE_ENABLED;
+        heartbeat.system_status     = MAV_STATE_STANDBY;
+        heartbeat.mavlink_version   = 3;
+        mavlink_msg_heartbeat_encode_chan(sysId, compId, mavlinkChannel, &message, &heartbeat);
+        break;
+    }
+    case MAVLINK_MSG_ID_SYS_STATUS:
+    {
+        mavlink_sys_status_t sysStatus = {};
+        sysStatus.load              = 250;
+        sysStatus.voltage_battery   = 4200 * 4;
+        sysStatus.current_battery   = 8000;
+        sysStatus.battery_remaining = 100;
+        mavlink_msg_sys_status_encode_chan(sysId, compId, mavlinkChannel, &message, &sysStatus);
+        break;
+    }
+    case MAVLINK_MSG_ID_GPS_RAW_INT:
+    {
+        mavlink_gps_raw_int_t gpsRawInt = {};
+        gpsRawInt.time_usec             = bootUSecs;
+        gpsRawInt.fix_type              = GPS_FIX_TYPE_3D_FIX;
+        gpsRawInt.lat                   = static_cast<int32_t>(latitude * 1E7);
+        gpsRawInt.lon                   = static_cast<int32_t>(longitude * 1E7);
+        gpsRawInt.alt                   = static_cast<int32_t>(_altitude * 1000);
+        gpsRawInt.eph                   = 100;
+        gpsRawInt.epv                   = 150;
+        gpsRawInt.vel                   = UINT16_MAX;
+        gpsRawInt.cog                   = UINT16_MAX;
+        gpsRawInt.satellites_visible    = 12;
+        mavlink_msg_gps_raw_int_encode_chan(sysId, compId, mavlinkChannel, &message, &gpsRawInt);
+        break;
+    }
+    case MAVLINK_MSG_ID_ATTITUDE:
+    {
+        mavlink_attitude_t attitude = {};
+        attitude.time_boot_ms   = bootMSecs;
+        attitude.roll           = static_cast<float>(qSin(angle) * 0.1);
+        attitude.pitch          = static_cast<float>(qCos(angle) * 0.1);
+        attitude.yaw            = yaw;
+        mavlink_msg_attitude_encode_chan(sysId, compId, mavlinkChannel, &message, &attitude);
+        break;
+    }
+    case MAVLINK_MSG_ID_ATTITUDE_QUATERNION:
+    {
+        mavlink_attitude_quaternion_t attitudeQuaternion = {};
+        attitudeQuaternion.time_boot_ms = bootMSecs;
+        attitudeQuaternion.q1           = static_cast<float>(qCos(yaw / 2));
+        attitudeQuaternion.q4           = static_cast<float>(qSin(yaw / 2));
+        mavlink_msg_attitude_quaternion_encode_chan(sysId, compId, mavlinkChannel, &message, &attitudeQuaternion);
+        break;
+    }
+    case MAVLINK_MSG_ID_LOCAL_POSITION_NED:
+    {
+        mavlink_local_position_ned_t localPosition = {};
+        localPosition.time_boot_ms  = bootMSecs;
+        localPosition.x             = static_cast<float>(qSin(angle) * 10);
+        localPosition.y             = static_cast<float>(qCos(angle) * 10);
+        localPosition.z             = -10;
+        mavlink_msg_local_position_ned_encode_chan(sysId, compId, mavlinkChannel, &message, &localPosition);
+        break;
+    }
+    case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+    {
+        mavlink_global_position_int_t globalPosition = {};
+        globalPosition.time_boot_ms = bootMSecs;
+        globalPosition.lat          = static_cast<int32_t>(latitude * 1E7);
+        globalPosition.lon          = static_cast<int32_t>(longitude * 1E7);
+        globalPosition.alt          = static_cast<int32_t>(_altitude * 1000);
+        globalPosition.relative_alt = 10000;
+        globalPosition.hdg          = static_cast<uint16_t>(qRadiansToDegrees(angle) * 100);
+        mavlink_msg_global_position_int_encode_chan(sysId, compId, mavlinkChannel, &message, &globalPosition);
+        break;
+    }
+    case MAVLINK_MSG_ID_SERVO_OUTPUT_RAW:
+    {
+        mavlink_servo_output_raw_t servoOutput = {};
+        servoOutput.time_usec   = static_cast<uint32_t>(bootUSecs);
+        servoOutput.servo1_raw  = 1500;
+        servoOutput.servo2_raw  = 1500;
+        servoOutput.servo3_raw  = 1500;
+        servoOutput.servo4_raw  = 1500;
+        mavlink_msg_servo_output_raw_encode_chan(sysId, compId, mavlinkChannel, &message, &servoOutput);
+        break;
+    }
+    case MAVLINK_MSG_ID_VFR_HUD:
+    {
+        mavlink_vfr_hud_t vfrHud = {};
+        vfrHud.groundspeed  = 5;
+        vfrHud.alt          = static_cast<float>(_altitude);
+        vfrHud.heading      = static_cast<int16_t>(qRadiansToDegrees(angle));
+        vfrHud.throttle     = 50;
+        mavlink_msg_vfr_hud_encode_chan(sysId, compId, mavlinkChannel, &message, &vfrHud);
+        break;
+    }
+    case MAVLINK_MSG_ID_HIGHRES_IMU:
+    {
+        mavlink_highres_imu_t highresImu = {};
+        highresImu.time_usec    = bootUSecs;
+        highresImu.zacc         = -9.81f;
+        highresImu.abs_pressure = 1013.25f;
+        mavlink_msg_highres_imu_encode_chan(sysId, compId, mavlinkChannel, &message, &highresImu);
+        break;
+    }
+    }
+}
+
+void MockLinkLoadGenerator::send(const mavlink_message_t& message, qint64 nowMSecs)
+{
+    if (_lossPercent > 0 && _random.bounded(100.0) < _lossPercent) {
+        _droppedCount++;
+        return;
+    }
+
+    qint64 dueMSecs = nowMSecs;
+    if (_jitterMSecs > 0) {
+        dueMSecs += _random.bounded(_jitterMSecs + 1);
+    }
+    if (_burstMSecs > 0 && nowMSecs % 1000 < _burstMSecs) {
+        dueMSecs = qMax(dueMSecs, nowMSecs - (nowMSecs % 1000) + _burstMSecs);
+    }
+    // A link delays messages but doesn't reorder them
+    dueMSecs = qMax(dueMSecs, _lastDueMSecs);
+    _lastDueMSecs = dueMSecs;
+
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    int     cBuffer = mavlink_msg_to_send_buffer(buffer, &message);
+
+    if (!_pending.isEmpty() && _pending.last().dueMSecs == dueMSecs) {
+        _pending.last().bytes.append(reinterpret_cast<const char*>(buffer), cBuffer);
+    } else {
+        Pending_t pending;
+        pending.dueMSecs    = dueMSecs;
+        pending.bytes       = QByteArray(reinterpret_cast<const char*>(buffer), cBuffer);
+        _pending.enqueue(pending);
+    }
+}
+
+QByteArray MockLinkLoadGenerator::takeDue(qint64 nowMSecs)
+{
+    QByteArray bytes;
+
+    while (!_pending.isEmpty() && _pending.head().dueMSecs <= nowMSecs) {
+        bytes.append(_pending.dequeue().bytes);
+    }
+
+    return bytes;
+}
@@ -0,0 +1,110 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QQueue>
+#include <QRandomGenerator>
+#include <QVector>
+
+#include "QGCMAVLink.h"
+
+/// Swarm scale telemetry and link impairments for MockLink. Generates the messages of a rate profile for a number of
+/// vehicles on one link and passes all link output through simulated loss, jitter and bursts. Not thread safe, it is
+/// only used from the MockLink thread.
+class MockLinkLoadGenerator
+{
+public:
+    typedef struct {
+        uint32_t    msgId;
+        double      rateHz;
+    } MessageRate_t;
+    typedef QList<MessageRate_t> RateProfile_t;
+
+    /// Parses a rate profile. Either the name of a built in profile or a comma separated list of msgid:hz pairs.
+    ///     @param profile "telemetry", "stress" or for example "30:50,33:10"
+    ///     @param[out] rates Parsed rates, empty for an empty profile
+    /// @return false: profile could not be parsed or uses a message which can't be generated
+    static bool parseRateProfile(const QString& profile, RateProfile_t& rates);
+
+    /// @return true: message can be generated by a rate profile
+    static bool canGenerate(uint32_t msgId);
+
+    /// Sets the vehicles to generate telemetry for. The first vehicle is MockLink's own, which sends its own heartbeat.
+    /// The others only send heartbeats and the rate profile, they don't respond to anything.
+    void setVehicles(uint8_t firstSystemId, int vehicleCount, MAV_AUTOPILOT firmwareType, MAV_TYPE vehicleType, double latitude, double longitude, double altitude);
+
+    void setRates(const RateProfile_t& rates);
+
+    ///     @param lossPercent  Percentage of messages dropped
+    ///     @param jitterMSecs  Messages are delayed by up to this long, order is kept
+    ///     @param burstMSecs   Output is held for this long at the start of every second, then delivered at once
+    void setImpairments(double lossPercent, int jitterMSecs, int burstMSecs);
+
+    void setSeed(quint32 seed) { _random.seed(seed); }
+
+    /// @return true: output goes through send, otherwise it can be delivered directly
+    bool impaired(void) const { return _lossPercent > 0 || _jitterMSecs > 0 || _burstMSecs > 0; }
+
+    /// @return true: there are rates to generate
+    bool active(void) const { return !_rates.isEmpty() || _vehicleCount > 1; }
+
+    /// Generates the messages which have come due by nowMSecs and queues them through send
+    void generate(qint64 nowMSecs, uint8_t mavlinkChannel);
+
+    /// Queues a message for delivery, applying the impairments
+    void send(const mavlink_message_t& message, qint64 nowMSecs);
+
+    /// @return Bytes of the messages which are due for delivery by nowMSecs
+    QByteArray takeDue(qint64 nowMSecs);
+
+    quint64 generatedCount  (void) const { return _generatedCount; }
+    quint64 droppedCount    (void) const { return _droppedCount; }
+
+    static const int maxCatchUpMSecs = 1000;    ///< Generation which falls further behind than this starts over instead of flooding
+
+private:
+    typedef struct {
+        qint64      dueMSecs;
+        QByteArray  bytes;
+    } Pending_t;
+
+    typedef struct {
+        uint8_t         systemId;
+        uint8_t         txSeq;
+        RateProfile_t   rates;
+        QVector<double> nextDueMSecs;   ///< Indexed like rates
+    } Vehicle_t;
+
+    void _pack          (const Vehicle_t& vehicle, uint32_t msgId, uint8_t mavlinkChannel, qint64 nowMSecs, mavlink_message_t& message);
+    void _resetSchedule (void);
+
+    RateProfile_t       _rates;
+    QVector<Vehicle_t>  _vehicles;
+    uint8_t             _firstSystemId      = 1;
+    int                 _vehicleCount       = 1;
+    MAV_AUTOPILOT       _firmwareType       = MAV_AUTOPILOT_PX4;
+    MAV_TYPE            _vehicleType        = MAV_TYPE_QUADROTOR;
+    double              _latitude           = 0;
+    double              _longitude          = 0;
+    double              _altitude           = 0;
+
+    double              _lossPercent        = 0;
+    int                 _jitterMSecs        = 0;
+    int                 _burstMSecs         = 0;
+    QRandomGenerator    _random;
+    QQueue<Pending_t>   _pending;
+    qint64              _lastDueMSecs       = 0;
+    qint64              _scheduleMSecs      = -1;   ///< Time the schedule starts from, -1 to start on the next generate
+
+    quint64             _generatedCount     = 0;
+    quint64             _droppedCount       = 0;
+};
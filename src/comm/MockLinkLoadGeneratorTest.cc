@@ -0,0 +1,148 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "MockLinkLoadGeneratorTest.h"
+#include "MockLinkLoadGenerator.h"
+
+void MockLinkLoadGeneratorTest::init(void)
+{
+    UnitTest::init();
+    mavlink_reset_channel_status(_channel);
+    mavlink_reset_channel_status(_parseChannel);
+}
+
+void MockLinkLoadGeneratorTest::_parse(const QByteArray& bytes, QList<mavlink_message_t>& messages)
+{
+    mavlink_message_t   message;
+    mavlink_status_t    status;
+
+    for (char byte: bytes) {
+        if (mavlink_parse_char(_parseChannel, static_cast<uint8_t>(byte), &message, &status)) {
+            messages.append(message);
+        }
+    }
+}
+
+void MockLinkLoadGeneratorTest::_parseTest(void)
+{
+    MockLinkLoadGenerator::RateProfile_t rates;
+
+    QVERIFY(MockLinkLoadGenerator::parseRateProfile(QString(), rates));
+    QCOMPARE(rates.count(), 0);
+
+    QVERIFY(MockLinkLoadGenerator::parseRateProfile(QStringLiteral("stress"), rates));
+    QVERIFY(rates.count() > 0);
+
+    QVERIFY(MockLinkLoadGenerator::parseRateProfile(QStringLiteral("30:50, 33:2.5"), rates));
+    QCOMPARE(rates.count(), 2);
+    QCOMPARE(rates[0].msgId, static_cast<uint32_t>(MAVLINK_MSG_ID_ATTITUDE));
+    QCOMPARE(rates[1].rateHz, 2.5);
+
+    QVERIFY(!MockLinkLoadGenerator::parseRateProfile(QStringLiteral("30:fast"), rates));
+    QVERIFY(!MockLinkLoadGenerator::parseRateProfile(QStringLiteral("30:0"), rates));
+    // Message which can't be generated
+    QVERIFY(!MockLinkLoadGenerator::parseRateProfile(QStringLiteral("9999:1"), rates));
+}
+
+void MockLinkLoadGeneratorTest::_rateTest(void)
+{
+    MockLinkLoadGenerator                   generator;
+    MockLinkLoadGenerator::RateProfile_t    rates;
+    QList<mavlink_message_t>                messages;
+
+    QVERIFY(MockLinkLoadGenerator::parseRateProfile(QStringLiteral("30:50"), rates));
+    generator.setVehicles(10, 3, MAV_AUTOPILOT_PX4, MAV_TYPE_QUADROTOR, 47.397, 8.5455, 488);
+    generator.setRates(rates);
+    QVERIFY(generator.active());
+    QVERIFY(!generator.impaired());
+
+    // One second on the 500Hz MockLink tick
+    for (qint64 nowMSecs=0; nowMSecs<1000; nowMSecs+=2) {
+        generator.generate(nowMSecs, _channel);
+        _parse(generator.takeDue(nowMSecs), messages);
+    }
+    QCOMPARE(static_cast<quint64>(messages.count()), generator.generatedCount());
+
+    QMap<int, int>  attitudeCounts;
+    QMap<int, int>  heartbeatCounts;
+    QMap<int, int>  nextSeqs;
+    for (const mavlink_message_t& message: messages) {
+        if (message.msgid == MAVLINK_MSG_ID_ATTITUDE) {
+            attitudeCounts[message.sysid]++;
+        } else if (message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+            heartbeatCounts[message.sysid]++;
+        }
+        // Simulated vehicles number their own messages without gaps
+        if (message.sysid != 10) {
+            if (nextSeqs.contains(message.sysid)) {
+                QCOMPARE(static_cast<int>(message.seq), nextSeqs[message.sysid]);
+            }
+            nextSeqs[message.sysid] = (message.seq + 1) & 0xFF;
+        }
+    }
+
+    QCOMPARE(attitudeCounts.keys(), QList<int>({ 10, 11, 12 }));
+    for (int count: attitudeCounts) {
+        QCOMPARE(count, 50);
+    }
+    // MockLink sends the heartbeat of its own vehicle
+    QCOMPARE(heartbeatCounts.keys(), QList<int>({ 11, 12 }));
+    QCOMPARE(heartbeatCounts[11], 1);
+}
+
+void MockLinkLoadGeneratorTest::_lossTest(void)
+{
+    MockLinkLoadGenerator                   generator;
+    MockLinkLoadGenerator::RateProfile_t    rates;
+    QList<mavlink_message_t>                messages;
+
+    QVERIFY(MockLinkLoadGenerator::parseRateProfile(QStringLiteral("30:500"), rates));
+    generator.setVehicles(1, 1, MAV_AUTOPILOT_PX4, MAV_TYPE_QUADROTOR, 47.397, 8.5455, 488);
+    generator.setRates(rates);
+    generator.setImpairments(25, 0, 0);
+    generator.setSeed(1234);
+    QVERIFY(generator.impaired());
+
+    for (qint64 nowMSecs=0; nowMSecs<1000; nowMSecs+=2) {
+        generator.generate(nowMSecs, _channel);
+        _parse(generator.takeDue(nowMSecs), messages);
+    }
+
+    QCOMPARE(generator.generatedCount(), static_cast<quint64>(500));
+    QCOMPARE(static_cast<quint64>(messages.count()), generator.generatedCount() - generator.droppedCount());
+    QVERIFY(generator.droppedCount() > 75 && generator.droppedCount() < 175);
+}
+
+void MockLinkLoadGeneratorTest::_burstTest(void)
+{
+    MockLinkLoadGenerator       generator;
+    QList<mavlink_message_t>    messages;
+    mavlink_message_t           message;
+
+    generator.setImpairments(0, 5, 100);
+
+    // Everything sent while the burst holds output arrives together when it ends, still in order
+    for (qint64 nowMSecs=1000; nowMSecs<1100; nowMSecs+=10) {
+        mavlink_msg_heartbeat_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _channel, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+        generator.send(message, nowMSecs);
+        QVERIFY(generator.takeDue(nowMSecs).isEmpty());
+    }
+    _parse(generator.takeDue(1100), messages);
+    QCOMPARE(messages.count(), 10);
+    for (int i=0; i<messages.count(); i++) {
+        QCOMPARE(static_cast<int>(messages[i].seq), i);
+    }
+
+    // Outside the burst only jitter delays delivery
+    mavlink_msg_heartbeat_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _channel, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+    generator.send(message, 1500);
+    messages.clear();
+    _parse(generator.takeDue(1505), messages);
+    QCOMPARE(messages.count(), 1);
+}
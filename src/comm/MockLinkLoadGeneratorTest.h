@@ -0,0 +1,33 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class MockLinkLoadGeneratorTest : public UnitTest
+{
+    Q_OBJECT
+
+protected slots:
+    void init(void) override;
+
+private slots:
+    void _parseTest     (void);
+    void _rateTest      (void);
+    void _lossTest      (void);
+    void _burstTest     (void);
+
+private:
+    /// Parses bytes, appending the messages to messages
+    void _parse(const QByteArray& bytes, QList<mavlink_message_t>& messages);
+
+    static const uint8_t _channel       = 0;
+    static const uint8_t _parseChannel  = 1;
+};
@@ -33,6 +33,41 @@ MockLinkMissionItemHandler::~MockLinkMissionItemHandler()
 
 }
 
+void MockLinkMissionItemHandler::loadMission(int itemCount, double latitude, double longitude, bool firstItemIsHome)
+{
+    // Rows of 20 waypoints 20 meters apart
+    const int       rowLength   = 20;
+    const double    stepDegrees = 0.00018;
+
+    _missionItems.clear();
+    for (int i=0; i<itemCount; i++) {
+        mavlink_mission_item_int_t missionItemInt;
+        int                        waypointIndex = firstItemIsHome ? i - 1 : i;
+        int                        row = waypointIndex / rowLength;
+        int                        column = waypointIndex % rowLength;
+
+        memset(&missionItemInt, 0, sizeof(missionItemInt));
+        missionItemInt.seq          = static_cast<uint16_t>(i);
+        missionItemInt.command      = MAV_CMD_NAV_WAYPOINT;
+        missionItemInt.autocontinue = true;
+        missionItemInt.mission_type = MAV_MISSION_TYPE_MISSION;
+        if (firstItemIsHome && i == 0) {
+            missionItemInt.frame    = MAV_FRAME_GLOBAL;
+            missionItemInt.x        = static_cast<int32_t>(latitude * 1e7);
+            missionItemInt.y        = static_cast<int32_t>(longitude * 1e7);
+        } else {
+            if (row % 2) {
+                column = rowLength - 1 - column;
+            }
+            missionItemInt.frame    = MAV_FRAME_GLOBAL_RELATIVE_ALT;
+            missionItemInt.x        = static_cast<int32_t>((latitude + row * stepDegrees) * 1e7);
+            missionItemInt.y        = static_cast<int32_t>((longitude + column * stepDegrees) * 1e7);
+            missionItemInt.z        = 50;
+        }
+        _missionItems[static_cast<uint16_t>(i)] = missionItemInt;
+    }
+}
+
 void MockLinkMissionItemHandler::_startMissionItemResponseTimer(void)
 {
     if (!_missionItemResponseTimer) {
@@ -235,8 +270,14 @@ void MockLinkMissionItemHandler::_handleMissionRequest(const mavlink_message_t&
                                                    missionItemInt.autocontinue,
                                                    missionItemInt.param1, missionItemInt.param2, missionItemInt.param3, missionItemInt.param4,
                                                    missionItemInt.x, missionItemInt.y, missionItemInt.z,
-                                                   _requestType);
-            _mockLink->respondWithMavlinkMessage(responseMsg);
+                                                   request.mission_type);   // Plan types may be read concurrently, answer with the requested one
+            if (_readResponseDelayMsecs > 0) {
+                // Responses to requests sent back to back go out back to back, as over a link with latency
+                MockLink* mockLink = _mockLink;
+                QTimer::singleShot(_readResponseDelayMsecs, _mockLink, [mockLink, responseMsg]() { mockLink->respondWithMavlinkMessage(responseMsg); });
+            } else {
+                _mockLink->respondWithMavlinkMessage(responseMsg);
+            }
         }
     }
 }
@@ -250,6 +291,7 @@ void MockLinkMissionItemHandler::_handleMissionCount(const mavlink_message_t& ms
     
     _requestType = (MAV_MISSION_TYPE)missionCount.mission_type;
     _writeSequenceCount = missionCount.count;
+    _writeSequenceStartCount++;
     Q_ASSERT(_writeSequenceCount >= 0);
     
     qCDebug(MockLinkMissionItemHandlerLog) << "_handleMissionCount write sequence _writeSequenceCount:" << _writeSequenceCount;
@@ -76,7 +76,19 @@ public:
     void sendUnexpectedMissionRequest(void);
     
     /// Reset the state of the MissionItemHandler to no items, no transactions in progress.
-    void reset(void) { _missionItems.clear(); }
+    void reset(void) { _missionItems.clear(); _fenceItems.clear(); _rallyItems.clear(); _readResponseDelayMsecs = 0; }
+
+    /// Delays MISSION_ITEM_INT responses to read requests, for unit testing pipelined reads
+    ///     @param msecs Delay for each response, 0 to respond immediately
+    void setReadResponseDelay(int msecs) { _readResponseDelayMsecs = msecs; }
+
+    /// @return Number of write sequences started with MISSION_COUNT
+    int writeSequenceStartCount(void) const { return _writeSequenceStartCount; }
+
+    /// Replaces the mission with a survey pattern of waypoints, for load testing with missions sized like real ones
+    ///     @param itemCount Number of mission items
+    ///     @param firstItemIsHome true: item 0 is the home position as ArduPilot does it
+    void loadMission(int itemCount, double latitude, double longitude, bool firstItemIsHome);
 
     void setSendHomePositionOnEmptyList(bool sendHomePositionOnEmptyList) { _sendHomePositionOnEmptyList = sendHomePositionOnEmptyList; }
 
@@ -98,6 +110,7 @@ private:
     
     int _writeSequenceCount;    ///< Numbers of items about to be written
     int _writeSequenceIndex;    ///< Current index being reqested
+    int _writeSequenceStartCount = 0;
 
     typedef QMap<uint16_t, mavlink_mission_item_int_t> MissionItemList_t;
 
@@ -114,5 +127,6 @@ private:
     bool                _failReadRequestListFirstResponse;
     bool                _failReadRequest1FirstResponse;
     bool                _failWriteMissionCountFirstResponse;
+    int                 _readResponseDelayMsecs = 0;
 };
 
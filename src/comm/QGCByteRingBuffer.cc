@@ -0,0 +1,68 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCByteRingBuffer.h"
+
+#include <string.h>
+
+QGCByteRingBuffer::QGCByteRingBuffer(int capacity)
+    : _head(0)
+    , _tail(0)
+{
+    quint32 size = 1;
+    while (size < static_cast<quint32>(capacity)) {
+        size <<= 1;
+    }
+    _buffer.reset(new char[size]);
+    _mask = size - 1;
+}
+
+int QGCByteRingBuffer::available(void) const
+{
+    return static_cast<int>(_head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire));
+}
+
+bool QGCByteRingBuffer::write(const char* data, int length)
+{
+    quint32 head = _head.load(std::memory_order_relaxed);
+    quint32 tail = _tail.load(std::memory_order_acquire);
+
+    if (length <= 0) {
+        return true;
+    }
+    if (static_cast<quint32>(length) > _mask + 1 - (head - tail)) {
+        return false;
+    }
+
+    quint32 offset  = head & _mask;
+    quint32 first   = qMin(static_cast<quint32>(length), _mask + 1 - offset);
+    memcpy(_buffer.get() + offset, data, first);
+    if (first < static_cast<quint32>(length)) {
+        memcpy(_buffer.get(), data + first, length - first);
+    }
+
+    // Publish the bytes to the consumer
+    _head.store(head + static_cast<quint32>(length), std::memory_order_release);
+    return true;
+}
+
+int QGCByteRingBuffer::readSpan(const char** data) const
+{
+    quint32 tail = _tail.load(std::memory_order_relaxed);
+    quint32 head = _head.load(std::memory_order_acquire);
+
+    quint32 offset = tail & _mask;
+    *data = _buffer.get() + offset;
+    return static_cast<int>(qMin(head - tail, _mask + 1 - offset));
+}
+
+void QGCByteRingBuffer::consume(int length)
+{
+    _tail.store(_tail.load(std::memory_order_relaxed) + static_cast<quint32>(length), std::memory_order_release);
+}
@@ -0,0 +1,49 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <memory>
+
+/// Preallocated lock-free single-producer/single-consumer byte ring.
+///
+/// Exactly one thread may call write and exactly one (possibly different) thread may call readSpan/consume.
+/// Capacity is rounded up to a power of two.
+class QGCByteRingBuffer
+{
+public:
+    QGCByteRingBuffer(int capacity);
+
+    int capacity(void) const { return static_cast<int>(_mask + 1); }
+
+    /// Number of bytes waiting to be read. Exact from the consumer thread, a lower bound from the producer.
+    int available(void) const;
+
+    /// Producer: copies length bytes into the ring. Nothing is written if there isn't room for all of it.
+    ///     @return false: not enough space, bytes were dropped
+    bool write(const char* data, int length);
+
+    /// Consumer: returns the largest contiguous span of unread bytes. Call again after consume to get
+    /// the remainder if the readable data wraps around the end of the ring.
+    ///     @param[out] data Start of span
+    ///     @return Length of span, 0 for empty
+    int readSpan(const char** data) const;
+
+    /// Consumer: releases length bytes returned by readSpan back to the producer
+    void consume(int length);
+
+private:
+    std::unique_ptr<char[]>     _buffer;
+    quint32                     _mask;
+    std::atomic<quint32>        _head;  ///< Total bytes written, owned by producer
+    std::atomic<quint32>        _tail;  ///< Total bytes read, owned by consumer
+};
@@ -0,0 +1,101 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCByteRingBufferTest.h"
+#include "QGCByteRingBuffer.h"
+
+#include <QThread>
+
+void QGCByteRingBufferTest::_wrapTest(void)
+{
+    QGCByteRingBuffer ring(10);
+    QCOMPARE(ring.capacity(), 16);
+
+    const char* span;
+
+    // Move the read/write position close to the end of the ring
+    QVERIFY(ring.write("0123456789AB", 12));
+    QCOMPARE(ring.readSpan(&span), 12);
+    ring.consume(12);
+    QCOMPARE(ring.available(), 0);
+
+    // This write wraps, so it must come back as two spans
+    QVERIFY(ring.write("abcdefgh", 8));
+    QCOMPARE(ring.available(), 8);
+
+    QByteArray result;
+    int spanLength;
+    QCOMPARE(spanLength = ring.readSpan(&span), 4);
+    result.append(span, spanLength);
+    ring.consume(spanLength);
+    QCOMPARE(spanLength = ring.readSpan(&span), 4);
+    result.append(span, spanLength);
+    ring.consume(spanLength);
+
+    QCOMPARE(result, QByteArray("abcdefgh"));
+    QCOMPARE(ring.readSpan(&span), 0);
+}
+
+void QGCByteRingBufferTest::_fullTest(void)
+{
+    QGCByteRingBuffer ring(16);
+
+    QVERIFY(ring.write("0123456789", 10));
+    // Not enough room, nothing should be written
+    QVERIFY(!ring.write("0123456789", 10));
+    QCOMPARE(ring.available(), 10);
+    QVERIFY(ring.write("012345", 6));
+    QCOMPARE(ring.available(), 16);
+}
+
+void QGCByteRingBufferTest::_threadedTest(void)
+{
+    QGCByteRingBuffer   ring(4096);
+    const int           totalBytes = 4 * 1024 * 1024;
+
+    QThread* producer = QThread::create([&ring, totalBytes]() {
+        char    chunk[333];
+        int     value = 0;
+        int     written = 0;
+        while (written < totalBytes) {
+            int length = qMin(static_cast<int>(sizeof(chunk)), totalBytes - written);
+            for (int i=0; i<length; i++) {
+                chunk[i] = static_cast<char>(value + i);
+            }
+            if (ring.write(chunk, length)) {
+                value   += length;
+                written += length;
+            } else {
+                QThread::yieldCurrentThread();
+            }
+        }
+    });
+    producer->start();
+
+    int     read    = 0;
+    bool    inOrder = true;
+    while (read < totalBytes && inOrder) {
+        const char* span;
+        int spanLength = ring.readSpan(&span);
+        for (int i=0; i<spanLength; i++) {
+            if (span[i] != static_cast<char>(read + i)) {
+                inOrder = false;
+                break;
+            }
+        }
+        ring.consume(spanLength);
+        read += spanLength;
+    }
+
+    producer->wait();
+    delete producer;
+
+    QVERIFY(inOrder);
+    QCOMPARE(read, totalBytes);
+}
@@ -15,6 +15,9 @@
 
 #define MAVLINK_USE_MESSAGE_INFO
 #define MAVLINK_EXTERNAL_RX_STATUS  // Single m_mavlink_status instance is in QGCApplication.cc
+// Received bytes are parsed with the private state of each MAVLinkFramer, a channel only carries the sequence number and
+// protocol version of outgoing messages. So every channel the uint8_t channel of the mavlink API can address is available.
+#define MAVLINK_COMM_NUM_BUFFERS    255
 #include <stddef.h>                 // Hack workaround for Mav 2.0 header problem with respect to offsetof usage
 
 // Ignore warnings from mavlink headers for both GCC/Clang and MSVC
@@ -0,0 +1,83 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCPacketQueue.h"
+
+#include <string.h>
+
+QGCPacketQueue::QGCPacketQueue(int slotCount, int slotSize)
+    : _slotSize (slotSize)
+    , _pushCount(0)
+    , _popCount (0)
+{
+    quint32 count = 1;
+    while (count < static_cast<quint32>(slotCount)) {
+        count <<= 1;
+    }
+    _slots.reset(new char[count * static_cast<quint32>(slotSize)]);
+    _lengths.reset(new int[count]);
+    _sequences.reset(new std::atomic<quint32>[count]);
+    for (quint32 i=0; i<count; i++) {
+        _sequences[i].store(i, std::memory_order_relaxed);
+    }
+    _mask = count - 1;
+}
+
+bool QGCPacketQueue::push(const char* data, int length)
+{
+    if (length <= 0 || length > _slotSize) {
+        return false;
+    }
+
+    // Claim a slot. Producers race on the push count, the slot sequence says whether the consumer has released it yet.
+    quint32 pushCount = _pushCount.load(std::memory_order_relaxed);
+    quint32 slot;
+    while (true) {
+        slot = pushCount & _mask;
+        qint32 diff = static_cast<qint32>(_sequences[slot].load(std::memory_order_acquire) - pushCount);
+        if (diff == 0) {
+            if (_pushCount.compare_exchange_weak(pushCount, pushCount + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            // Another producer claimed this slot first
+            pushCount = _pushCount.load(std::memory_order_relaxed);
+        }
+    }
+
+    memcpy(_slots.get() + slot * static_cast<quint32>(_slotSize), data, static_cast<size_t>(length));
+    _lengths[slot] = length;
+
+    // Publish the packet to the consumer
+    _sequences[slot].store(pushCount + 1, std::memory_order_release);
+    return true;
+}
+
+int QGCPacketQueue::front(const char** data) const
+{
+    quint32 slot = _popCount & _mask;
+
+    // A slot which is claimed but not filled yet holds back everything after it, which keeps packets in order
+    if (_sequences[slot].load(std::memory_order_acquire) != _popCount + 1) {
+        return 0;
+    }
+    *data = _slots.get() + slot * static_cast<quint32>(_slotSize);
+    return _lengths[slot];
+}
+
+void QGCPacketQueue::pop(void)
+{
+    quint32 slot = _popCount & _mask;
+
+    // The slot is free again for the push one lap further on
+    _sequences[slot].store(_popCount + _mask + 1, std::memory_order_release);
+    _popCount++;
+}
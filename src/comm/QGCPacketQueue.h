@@ -0,0 +1,49 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <memory>
+
+/// Preallocated lock-free multi-producer/single-consumer queue of packets, each copied into a fixed size slot.
+///
+/// Any number of threads may call push at the same time. Only one thread at a time may call front/pop.
+/// Slot count is rounded up to a power of two.
+class QGCPacketQueue
+{
+public:
+    QGCPacketQueue(int slotCount, int slotSize);
+
+    int slotCount   (void) const { return static_cast<int>(_mask + 1); }
+    int slotSize    (void) const { return _slotSize; }
+
+    /// Producer: copies the packet into the next free slot
+    ///     @return false: queue is full or the packet is larger than a slot, nothing was queued
+    bool push(const char* data, int length);
+
+    /// Consumer: returns the oldest queued packet. The packet stays valid until pop is called.
+    ///     @param[out] data Start of packet
+    ///     @return Length of packet, 0 for empty
+    int front(const char** data) const;
+
+    /// Consumer: releases the packet returned by front back to the producers
+    void pop(void);
+
+private:
+    std::unique_ptr<char[]>                 _slots;
+    std::unique_ptr<int[]>                  _lengths;
+    std::unique_ptr<std::atomic<quint32>[]> _sequences;     ///< Slot is free for push number n when n, filled by push number n when n + 1
+    int                                     _slotSize;
+    quint32                                 _mask;
+    std::atomic<quint32>                    _pushCount;     ///< Total slots claimed by producers
+    quint32                                 _popCount;      ///< Total slots released by the consumer
+};
@@ -0,0 +1,108 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCPacketQueueTest.h"
+#include "QGCPacketQueue.h"
+
+#include <QThread>
+
+#include <string.h>
+
+void QGCPacketQueueTest::_orderTest(void)
+{
+    QGCPacketQueue queue(3, 8);
+    QCOMPARE(queue.slotCount(), 4);
+
+    const char* packet;
+    QCOMPARE(queue.front(&packet), 0);
+
+    // Go around the queue a few times so the slot sequences wrap
+    for (int i=0; i<10; i++) {
+        QVERIFY(queue.push("abc", 3));
+        QVERIFY(queue.push("defghijk", 8));
+
+        QCOMPARE(QByteArray(packet, queue.front(&packet)), QByteArray("abc"));
+        queue.pop();
+        QCOMPARE(QByteArray(packet, queue.front(&packet)), QByteArray("defghijk"));
+        queue.pop();
+        QCOMPARE(queue.front(&packet), 0);
+    }
+}
+
+void QGCPacketQueueTest::_fullTest(void)
+{
+    QGCPacketQueue queue(2, 8);
+
+    // Larger than a slot
+    QVERIFY(!queue.push("012345678", 9));
+
+    QVERIFY(queue.push("0", 1));
+    QVERIFY(queue.push("1", 1));
+    QVERIFY(!queue.push("2", 1));
+
+    const char* packet;
+    QCOMPARE(queue.front(&packet), 1);
+    QCOMPARE(packet[0], '0');
+    queue.pop();
+    QVERIFY(queue.push("2", 1));
+}
+
+void QGCPacketQueueTest::_threadedTest(void)
+{
+    QGCPacketQueue      queue(64, 8);
+    const int           producerCount       = 4;
+    const int           packetsPerProducer  = 100000;
+    QList<QThread*>     producers;
+
+    // Each packet is the producer index followed by a per producer sequence number
+    for (int i=0; i<producerCount; i++) {
+        producers.append(QThread::create([&queue, i, packetsPerProducer]() {
+            for (int sequence=0; sequence<packetsPerProducer; ) {
+                char packet[5];
+                packet[0] = static_cast<char>(i);
+                memcpy(&packet[1], &sequence, sizeof(sequence));
+                if (queue.push(packet, sizeof(packet))) {
+                    sequence++;
+                } else {
+                    QThread::yieldCurrentThread();
+                }
+            }
+        }));
+        producers.last()->start();
+    }
+
+    int     nextSequence[producerCount] = { };
+    int     received    = 0;
+    bool    inOrder     = true;
+    while (received < producerCount * packetsPerProducer && inOrder) {
+        const char* packet;
+        int length = queue.front(&packet);
+        if (length == 0) {
+            continue;
+        }
+        int producer = packet[0];
+        int sequence;
+        memcpy(&sequence, &packet[1], sizeof(sequence));
+        if (length != 5 || producer < 0 || producer >= producerCount || sequence != nextSequence[producer]) {
+            inOrder = false;
+        } else {
+            nextSequence[producer]++;
+        }
+        queue.pop();
+        received++;
+    }
+
+    for (QThread* producer: producers) {
+        producer->wait();
+        delete producer;
+    }
+
+    QVERIFY(inOrder);
+    QCOMPARE(received, producerCount * packetsPerProducer);
+}
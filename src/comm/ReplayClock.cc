@@ -0,0 +1,75 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "ReplayClock.h"
+
+ReplayClock::ReplayClock(void)
+{
+
+}
+
+void ReplayClock::start(quint64 logTimeUSecs, double rate, qint64 wallMSecs)
+{
+    QMutexLocker lock(&_mutex);
+
+    _running            = true;
+    _rate               = rate > 0 ? rate : 1;
+    _startWallMSecs     = wallMSecs;
+    _startLogTimeUSecs  = logTimeUSecs;
+}
+
+void ReplayClock::stop(quint64 logTimeUSecs)
+{
+    QMutexLocker lock(&_mutex);
+
+    _running            = false;
+    _startWallMSecs     = 0;
+    _startLogTimeUSecs  = logTimeUSecs;
+}
+
+bool ReplayClock::isRunning(void) const
+{
+    QMutexLocker lock(&_mutex);
+    return _running;
+}
+
+quint64 ReplayClock::_logTimeUSecs(qint64 wallMSecs) const
+{
+    if (!_running || wallMSecs <= _startWallMSecs) {
+        return _startLogTimeUSecs;
+    }
+    return _startLogTimeUSecs + static_cast<quint64>((wallMSecs - _startWallMSecs) * 1000 * _rate);
+}
+
+ReplayClock::State_t ReplayClock::state(qint64 wallMSecs) const
+{
+    QMutexLocker lock(&_mutex);
+
+    State_t state;
+    state.running       = _running;
+    state.rate          = _rate;
+    state.logTimeUSecs  = _logTimeUSecs(wallMSecs);
+    return state;
+}
+
+quint64 ReplayClock::logTimeUSecs(qint64 wallMSecs) const
+{
+    QMutexLocker lock(&_mutex);
+    return _logTimeUSecs(wallMSecs);
+}
+
+qint64 ReplayClock::wallMSecs(quint64 logTimeUSecs) const
+{
+    QMutexLocker lock(&_mutex);
+
+    if (!_running || logTimeUSecs <= _startLogTimeUSecs) {
+        return _startWallMSecs;
+    }
+    return _startWallMSecs + static_cast<qint64>(((logTimeUSecs - _startLogTimeUSecs) / 1000) / _rate);
+}
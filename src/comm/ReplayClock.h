@@ -0,0 +1,54 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QDateTime>
+#include <QMutex>
+
+/// Maps wall clock time to log time during a replay.
+///
+/// LogReplayLink paces the messages of a log with it, and anything played along with the log, such as a recorded
+/// video, reads the same clock instead of keeping time of its own. Log times are in microseconds like the tlog
+/// timestamps, wall clock times in milliseconds since the epoch. Thread safe.
+class ReplayClock
+{
+public:
+    ReplayClock(void);
+
+    typedef struct {
+        bool    running;
+        double  rate;
+        quint64 logTimeUSecs;       ///< At the time the state was read
+    } State_t;
+
+    /// Log time runs on from logTimeUSecs at rate times the wall clock
+    void start(quint64 logTimeUSecs, double rate, qint64 wallMSecs = QDateTime::currentMSecsSinceEpoch());
+
+    /// Log time stands still at logTimeUSecs
+    void stop(quint64 logTimeUSecs);
+
+    bool    isRunning   (void) const;
+    State_t state       (qint64 wallMSecs = QDateTime::currentMSecsSinceEpoch()) const;
+
+    /// @return Log time at the wall clock time
+    quint64 logTimeUSecs(qint64 wallMSecs = QDateTime::currentMSecsSinceEpoch()) const;
+
+    /// @return Wall clock time at which a log time is due, the start time of a stopped clock
+    qint64 wallMSecs(quint64 logTimeUSecs) const;
+
+private:
+    quint64 _logTimeUSecs   (qint64 wallMSecs) const;
+
+    mutable QMutex  _mutex;
+    bool            _running            = false;
+    double          _rate               = 1;
+    qint64          _startWallMSecs     = 0;
+    quint64         _startLogTimeUSecs  = 0;
+};
@@ -25,6 +25,16 @@
 #include "QGCSerialPortInfo.h"
 #include "LinkManager.h"
 
+#if defined(Q_OS_LINUX) && !defined(__android__)
+#include <errno.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+#endif
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
 QGC_LOGGING_CATEGORY(SerialLinkLog, "SerialLinkLog")
 
 static QStringList kSupportedBaudRates;
@@ -33,6 +43,9 @@ SerialLink::SerialLink(SharedLinkConfigurationPtr& config, bool isPX4Flow)
     : LinkInterface(config, isPX4Flow)
     , _serialConfig(qobject_cast<SerialConfiguration*>(config.get()))
 {
+    _readLatencyTimer.setSingleShot(true);
+    connect(&_readLatencyTimer, &QTimer::timeout, this, &SerialLink::_deliverReadBytes);
+
     qCDebug(SerialLinkLog) << "Create SerialLink portName:baud:flowControl:parity:dataButs:stopBits" << _serialConfig->portName() << _serialConfig->baud() << _serialConfig->flowControl()
                            << _serialConfig->parity() << _serialConfig->dataBits() << _serialConfig->stopBits();
 }
@@ -81,6 +94,9 @@ void SerialLink::disconnect(void)
     if (_port) {
         // This prevents stale signals from calling the link after it has been deleted
         QObject::disconnect(_port, &QIODevice::readyRead, this, &SerialLink::_readBytes);
+        _readLatencyTimer.stop();
+        _readPendingCount = 0;
+        qCDebug(SerialLinkLog) << "Read statistics" << _serialConfig->portName() << _readStatistics.toString();
         _port->close();
         _port->deleteLater();
         _port = nullptr;
@@ -219,6 +235,11 @@ bool SerialLink::_hardwareConnect(QSerialPort::SerialPortError& error, QString&
     _port->setFlowControl  (static_cast<QSerialPort::FlowControl>  (_serialConfig->flowControl()));
     _port->setStopBits     (static_cast<QSerialPort::StopBits>     (_serialConfig->stopBits()));
     _port->setParity       (static_cast<QSerialPort::Parity>       (_serialConfig->parity()));
+    _setupDriver();
+
+    _readPendingCount = 0;
+    _readStatistics.reset();
+    _readLatencyTimer.setInterval(_serialConfig->readMaxLatency());
 
     emit connected();
 
@@ -228,15 +249,55 @@ bool SerialLink::_hardwareConnect(QSerialPort::SerialPortError& error, QString&
     return true; // successful connection
 }
 
+/// Tunes the driver for small latency sensitive reads at high baud rates. Failures are not an error, not all drivers support these.
+void SerialLink::_setupDriver(void)
+{
+#if defined(Q_OS_LINUX) && !defined(__android__)
+    if (_serialConfig->lowLatency()) {
+        // Without this usb serial adapters such as FTDI hold received bytes for up to 16 msecs
+        int                     fd = static_cast<int>(_port->handle());
+        struct serial_struct    serial;
+        if (ioctl(fd, TIOCGSERIAL, &serial) == 0) {
+            serial.flags |= ASYNC_LOW_LATENCY;
+            if (ioctl(fd, TIOCSSERIAL, &serial) != 0) {
+                qCDebug(SerialLinkLog) << "Setting low latency failed" << _serialConfig->portName() << strerror(errno);
+            }
+        } else {
+            qCDebug(SerialLinkLog) << "Low latency not supported" << _serialConfig->portName() << strerror(errno);
+        }
+    }
+#endif
+#ifdef Q_OS_WIN
+    // The default driver queue is small enough to overrun at 3M baud if the event loop stalls
+    if (!SetupComm(_port->handle(), _driverReadBufferSize, _driverReadBufferSize)) {
+        qCDebug(SerialLinkLog) << "Setting driver buffer size failed" << _serialConfig->portName() << GetLastError();
+    }
+#endif
+}
+
 void SerialLink::_readBytes(void)
 {
     if (_port && _port->isOpen()) {
         qint64 byteCount = _port->bytesAvailable();
         if (byteCount) {
-            QByteArray buffer;
-            buffer.resize(byteCount);
-            _port->read(buffer.data(), buffer.size());
-            emit bytesReceived(this, buffer);
+            // The read buffer is reused across reads so there is no allocation once it has grown to the typical batch size
+            if (_readBuffer.size() < _readPendingCount + byteCount) {
+                _readBuffer.resize(_readPendingCount + static_cast<int>(byteCount));
+            }
+            qint64 readCount = _port->read(_readBuffer.data() + _readPendingCount, byteCount);
+            if (readCount > 0) {
+                _readStatistics.addRead(static_cast<int>(readCount));
+                if (_readPendingCount == 0) {
+                    _readPendingTimer.start();
+                }
+                _readPendingCount += static_cast<int>(readCount);
+
+                if (_readPendingCount >= _serialConfig->readBatchSize()) {
+                    _deliverReadBytes();
+                } else if (!_readLatencyTimer.isActive()) {
+                    _readLatencyTimer.start();
+                }
+            }
         }
     } else {
         // Error occurred
@@ -245,6 +306,17 @@ void SerialLink::_readBytes(void)
     }
 }
 
+/// Delivers the bytes held for the current batch
+void SerialLink::_deliverReadBytes(void)
+{
+    _readLatencyTimer.stop();
+    if (_readPendingCount) {
+        _readStatistics.addDelivery(_readPendingCount, _readPendingTimer.nsecsElapsed() / 1000);
+        _bytesReceived(_readBuffer.constData(), _readPendingCount);
+        _readPendingCount = 0;
+    }
+}
+
 void SerialLink::linkError(QSerialPort::SerialPortError error)
 {
     switch (error) {
@@ -305,6 +377,9 @@ SerialConfiguration::SerialConfiguration(SerialConfiguration* copy) : LinkConfig
     _portName           = copy->portName();
     _portDisplayName    = copy->portDisplayName();
     _usbDirect          = copy->_usbDirect;
+    _readBatchSize      = copy->readBatchSize();
+    _readMaxLatency     = copy->readMaxLatency();
+    _lowLatency         = copy->lowLatency();
 }
 
 void SerialConfiguration::copyFrom(LinkConfiguration *source)
@@ -320,6 +395,9 @@ void SerialConfiguration::copyFrom(LinkConfiguration *source)
         _portName           = ssource->portName();
         _portDisplayName    = ssource->portDisplayName();
         _usbDirect          = ssource->_usbDirect;
+        _readBatchSize      = ssource->readBatchSize();
+        _readMaxLatency     = ssource->readMaxLatency();
+        _lowLatency         = ssource->lowLatency();
     } else {
         qWarning() << "Internal error";
     }
@@ -350,6 +428,30 @@ void SerialConfiguration::setParity(int parity)
     _parity = parity;
 }
 
+void SerialConfiguration::setReadBatchSize(int readBatchSize)
+{
+    if (_readBatchSize != readBatchSize) {
+        _readBatchSize = readBatchSize;
+        emit readBatchSizeChanged();
+    }
+}
+
+void SerialConfiguration::setReadMaxLatency(int readMaxLatency)
+{
+    if (_readMaxLatency != readMaxLatency) {
+        _readMaxLatency = readMaxLatency;
+        emit readMaxLatencyChanged();
+    }
+}
+
+void SerialConfiguration::setLowLatency(bool lowLatency)
+{
+    if (_lowLatency != lowLatency) {
+        _lowLatency = lowLatency;
+        emit lowLatencyChanged();
+    }
+}
+
 void SerialConfiguration::setPortName(const QString& portName)
 {
     // No effect on a running connection
@@ -382,6 +484,9 @@ void SerialConfiguration::saveSettings(QSettings& settings, const QString& root)
     settings.setValue("parity",         _parity);
     settings.setValue("portName",       _portName);
     settings.setValue("portDisplayName",_portDisplayName);
+    settings.setValue("readBatchSize",  _readBatchSize);
+    settings.setValue("readMaxLatency", _readMaxLatency);
+    settings.setValue("lowLatency",     _lowLatency);
     settings.endGroup();
 }
 
@@ -395,6 +500,9 @@ void SerialConfiguration::loadSettings(QSettings& settings, const QString& root)
     if(settings.contains("parity"))         _parity         = settings.value("parity").toInt();
     if(settings.contains("portName"))       _portName       = settings.value("portName").toString();
     if(settings.contains("portDisplayName"))_portDisplayName= settings.value("portDisplayName").toString();
+    if(settings.contains("readBatchSize"))  _readBatchSize  = settings.value("readBatchSize").toInt();
+    if(settings.contains("readMaxLatency")) _readMaxLatency = settings.value("readMaxLatency").toInt();
+    if(settings.contains("lowLatency"))     _lowLatency     = settings.value("lowLatency").toBool();
     settings.endGroup();
 }
 
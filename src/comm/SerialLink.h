@@ -13,6 +13,8 @@
 #include <QThread>
 #include <QMutex>
 #include <QString>
+#include <QTimer>
+#include <QElapsedTimer>
 
 #ifdef __android__
 #include "qserialport.h"
@@ -28,6 +30,7 @@ Q_DECLARE_METATYPE(QSerialPort::SerialPortError)
 #include "QGCConfig.h"
 #include "LinkConfiguration.h"
 #include "LinkInterface.h"
+#include "LinkReadStatistics.h"
 
 Q_DECLARE_LOGGING_CATEGORY(SerialLinkLog)
 
@@ -51,6 +54,9 @@ public:
     Q_PROPERTY(QString  portName        READ portName           WRITE setPortName           NOTIFY portNameChanged)
     Q_PROPERTY(QString  portDisplayName READ portDisplayName                                NOTIFY portDisplayNameChanged)
     Q_PROPERTY(bool     usbDirect       READ usbDirect          WRITE setUsbDirect          NOTIFY usbDirectChanged)        ///< true: direct usb connection to board
+    Q_PROPERTY(int      readBatchSize   READ readBatchSize      WRITE setReadBatchSize      NOTIFY readBatchSizeChanged)    ///< Received bytes are held until there are this many, 0 delivers every read
+    Q_PROPERTY(int      readMaxLatency  READ readMaxLatency     WRITE setReadMaxLatency     NOTIFY readMaxLatencyChanged)   ///< Longest time in msecs received bytes are held for a batch
+    Q_PROPERTY(bool     lowLatency      READ lowLatency         WRITE setLowLatency         NOTIFY lowLatencyChanged)       ///< true: ask the driver for low latency, Linux only
 
     int  baud()         { return _baud; }
     int  dataBits()     { return _dataBits; }
@@ -58,6 +64,9 @@ public:
     int  stopBits()     { return _stopBits; }
     int  parity()       { return _parity; }         ///< QSerialPort Enums
     bool usbDirect()    { return _usbDirect; }
+    int  readBatchSize  () const { return _readBatchSize; }
+    int  readMaxLatency () const { return _readMaxLatency; }
+    bool lowLatency     () const { return _lowLatency; }
 
     const QString portName          () { return _portName; }
     const QString portDisplayName   () { return _portDisplayName; }
@@ -69,6 +78,9 @@ public:
     void setParity          (int parity);               ///< QSerialPort Enums
     void setPortName        (const QString& portName);
     void setUsbDirect       (bool usbDirect);
+    void setReadBatchSize   (int readBatchSize);
+    void setReadMaxLatency  (int readMaxLatency);
+    void setLowLatency      (bool lowLatency);
 
     static QStringList supportedBaudRates();
     static QString cleanPortDisplayname(const QString name);
@@ -91,6 +103,9 @@ signals:
     void portNameChanged        ();
     void portDisplayNameChanged ();
     void usbDirectChanged       (bool usbDirect);
+    void readBatchSizeChanged   ();
+    void readMaxLatencyChanged  ();
+    void lowLatencyChanged      ();
 
 private:
     static void _initBaudRates();
@@ -103,6 +118,9 @@ private:
     QString _portName;
     QString _portDisplayName;
     bool _usbDirect;
+    int _readBatchSize  = 0;
+    int _readMaxLatency = 2;
+    bool _lowLatency    = true;
 };
 
 class SerialLink : public LinkInterface
@@ -120,6 +138,9 @@ public:
     /// Don't even think of calling this method!
     QSerialPort* _hackAccessToPort(void) { return _port; }
 
+    /// Read size and latency histograms since the link was connected
+    const LinkReadStatistics& readStatistics(void) const { return _readStatistics; }
+
 private slots:
     void _writeBytes(const QByteArray data) override;
 
@@ -127,7 +148,8 @@ public slots:
     void linkError(QSerialPort::SerialPortError error);
 
 private slots:
-    void _readBytes     (void);
+    void _readBytes         (void);
+    void _deliverReadBytes  (void);
 
 private:
 
@@ -137,6 +159,7 @@ private:
     void _emitLinkError     (const QString& errorMsg);
     bool _hardwareConnect   (QSerialPort::SerialPortError& error, QString& errorString);
     bool _isBootloader      (void);
+    void _setupDriver       (void);
 
     QSerialPort*            _port               = nullptr;
     quint64                 _bytesRead          = 0;
@@ -146,7 +169,14 @@ private:
     volatile bool           _stopp              = false;
     QMutex                  _stoppMutex;                    ///< Mutex for accessing _stopp
     QByteArray              _transmitBuffer;                ///< An internal buffer for receiving data from member functions and actually transmitting them via the serial port.
+    QByteArray              _readBuffer;                    ///< Reused across reads to prevent an allocation per read
+    int                     _readPendingCount   = 0;        ///< Bytes at the start of _readBuffer waiting for the batch to fill up
+    QTimer                  _readLatencyTimer;              ///< Delivers a partial batch once the maximum latency has passed
+    QElapsedTimer           _readPendingTimer;              ///< Started when the first byte of a batch is read
+    LinkReadStatistics      _readStatistics;
     SerialConfiguration*    _serialConfig       = nullptr;
 
+    static const int _driverReadBufferSize = 64 * 1024;
+
 };
 
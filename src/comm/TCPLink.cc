@@ -18,6 +18,14 @@
 #include <QHostInfo>
 #include <QSignalSpy>
 
+#ifdef Q_OS_LINUX
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
+QGC_LOGGING_CATEGORY(TCPLinkLog, "TCPLinkLog")
+
 /// @file
 ///     @brief TCP link type for SITL support
 ///
@@ -31,6 +39,9 @@ TCPLink::TCPLink(SharedLinkConfigurationPtr& config)
 {
     Q_ASSERT(_tcpConfig);
     moveToThread(this);
+
+    // Reserved capacity is kept when the buffer is resized to empty
+    _writeBuffer.reserve(_coalesceBytes);
 }
 
 TCPLink::~TCPLink()
@@ -44,8 +55,30 @@ TCPLink::~TCPLink()
 
 void TCPLink::run()
 {
+    // The timers are only used from the link thread, so they live on its stack for as long as it runs
+    QTimer flushTimer;
+    QTimer reconnectTimer;
+    QTimer statisticsTimer;
+
+    flushTimer.setSingleShot(true);
+    flushTimer.setInterval(_tcpConfig->coalesceMSecs());
+    connect(&flushTimer, &QTimer::timeout, this, [this]() {
+        QMutexLocker locker(&_writeBufferMutex);
+        _flushWriteBuffer();
+    });
+    reconnectTimer.setSingleShot(true);
+    connect(&reconnectTimer, &QTimer::timeout, this, &TCPLink::_reconnect);
+    connect(&statisticsTimer, &QTimer::timeout, this, &TCPLink::_updateStatistics);
+    statisticsTimer.start(_statisticsUpdateMSecs);
+
+    _flushTimer     = &flushTimer;
+    _reconnectTimer = &reconnectTimer;
+
     _hardwareConnect();
     exec();
+
+    _flushTimer     = nullptr;
+    _reconnectTimer = nullptr;
 }
 
 #ifdef TCPLINK_READWRITE_DEBUG
@@ -78,9 +111,39 @@ void TCPLink::_writeBytes(const QByteArray data)
     _writeDebugBytes(data);
 #endif
 
-    if (_socket) {
-        _socket->write(data);
-        emit bytesSent(this, data);
+    if (!_socket) {
+        return;
+    }
+    emit bytesSent(this, data);
+
+    QMutexLocker locker(&_writeBufferMutex);
+
+    // Writes from other threads aren't held since the flush timer belongs to the link thread
+    if (_tcpConfig->lowLatency() || !_flushTimer || QThread::currentThread() != this) {
+        _flushWriteBuffer();
+        if (_socket->state() == QAbstractSocket::ConnectedState) {
+            _socket->write(data);
+        }
+        return;
+    }
+
+    _writeBuffer.append(data);
+    if (_writeBuffer.length() >= _coalesceBytes) {
+        _flushWriteBuffer();
+    } else if (!_flushTimer->isActive()) {
+        _flushTimer->start();
+    }
+}
+
+/// Writes out the coalesced bytes. Bytes written while the connection is down are dropped.
+/// Must be called with _writeBufferMutex locked.
+void TCPLink::_flushWriteBuffer(void)
+{
+    if (!_writeBuffer.isEmpty()) {
+        if (_socket && _socket->state() == QAbstractSocket::ConnectedState) {
+            _socket->write(_writeBuffer);
+        }
+        _writeBuffer.resize(0);
     }
 }
 
@@ -90,13 +153,16 @@ void TCPLink::readBytes()
         qint64 byteCount = _socket->bytesAvailable();
         if (byteCount)
         {
-            QByteArray buffer;
-            buffer.resize(byteCount);
-            _socket->read(buffer.data(), buffer.size());
-            emit bytesReceived(this, buffer);
+            if (_readBuffer.size() < byteCount) {
+                _readBuffer.resize(static_cast<int>(byteCount));
+            }
+            qint64 readCount = _socket->read(_readBuffer.data(), byteCount);
+            if (readCount > 0) {
+                _bytesReceived(_readBuffer.constData(), static_cast<int>(readCount));
 #ifdef TCPLINK_READWRITE_DEBUG
-            writeDebugBytes(buffer.data(), buffer.size());
+                _writeDebugBytes(QByteArray(_readBuffer.constData(), static_cast<int>(readCount)));
 #endif
+            }
         }
     }
 }
@@ -108,7 +174,10 @@ void TCPLink::disconnect(void)
     if (_socket) {
         // This prevents stale signal from calling the link after it has been deleted
         QObject::disconnect(_socket, &QTcpSocket::readyRead, this, &TCPLink::readBytes);
+        QObject::disconnect(_socket, &QAbstractSocket::stateChanged, this, &TCPLink::_socketStateChanged);
         _socketIsConnected = false;
+        SocketStatistics_t statistics = socketStatistics();
+        qCDebug(TCPLinkLog) << "Disconnect" << _config->name() << "rtt usecs" << statistics.rttUSecs << "retransmits" << statistics.retransmits << "reconnects" << statistics.reconnects;
         _socket->disconnectFromHost(); // Disconnect tcp
         _socket->waitForDisconnected();        
         _socket->deleteLater(); // Make sure delete happens on correct thread
@@ -161,14 +230,97 @@ bool TCPLink::_hardwareConnect()
         _socket = nullptr;
         return false;
     }
+    _configureSocket();
+
+    // Only once connected, a failed first connect is reported as an error instead of being retried
+    QObject::connect(_socket, &QAbstractSocket::stateChanged, this, &TCPLink::_socketStateChanged);
+
+    _reconnecting           = false;
+    _reconnectDelayMSecs    = initialReconnectDelayMSecs;
+    {
+        QMutexLocker locker(&_statisticsMutex);
+        _socketStatistics = SocketStatistics_t();
+    }
+
     _socketIsConnected = true;
     emit connected();
     return true;
 }
 
+void TCPLink::_configureSocket(void)
+{
+    if (_tcpConfig->lowLatency()) {
+        // Small send buffer so queued bytes don't add latency on a slow link
+        _socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        _socket->setSocketOption(QAbstractSocket::SendBufferSizeSocketOption, _lowLatencySendBufferSize);
+    } else {
+        _socket->setSocketOption(QAbstractSocket::LowDelayOption, 0);
+    }
+}
+
+/// The link stays connected while the connection underneath it is reestablished, each failed attempt backing off further
+void TCPLink::_socketStateChanged(QAbstractSocket::SocketState socketState)
+{
+    if (socketState == QAbstractSocket::ConnectedState && _reconnecting) {
+        qCDebug(TCPLinkLog) << "Reconnected" << _config->name();
+        _reconnecting           = false;
+        _reconnectDelayMSecs    = initialReconnectDelayMSecs;
+        _configureSocket();
+
+        QMutexLocker locker(&_statisticsMutex);
+        _socketStatistics.reconnects++;
+    } else if (socketState == QAbstractSocket::UnconnectedState && _socketIsConnected && _reconnectTimer && !_reconnectTimer->isActive()) {
+        qCDebug(TCPLinkLog) << "Connection lost, reconnecting in" << _reconnectDelayMSecs << "msecs" << _config->name();
+        _reconnecting = true;
+        _reconnectTimer->start(_reconnectDelayMSecs);
+        _reconnectDelayMSecs = nextReconnectDelay(_reconnectDelayMSecs);
+    }
+}
+
+void TCPLink::_reconnect(void)
+{
+    if (_socket && _socket->state() == QAbstractSocket::UnconnectedState) {
+        _socket->connectToHost(_tcpConfig->address(), _tcpConfig->port());
+    }
+}
+
+int TCPLink::nextReconnectDelay(int delayMSecs)
+{
+    return delayMSecs * 2 > maxReconnectDelayMSecs ? maxReconnectDelayMSecs : delayMSecs * 2;
+}
+
+void TCPLink::_updateStatistics(void)
+{
+#ifdef Q_OS_LINUX
+    if (!_socket || _socket->state() != QAbstractSocket::ConnectedState) {
+        return;
+    }
+
+    struct tcp_info info;
+    socklen_t       length = sizeof(info);
+    if (getsockopt(static_cast<int>(_socket->socketDescriptor()), IPPROTO_TCP, TCP_INFO, &info, &length) == 0) {
+        QMutexLocker locker(&_statisticsMutex);
+        _socketStatistics.valid             = true;
+        _socketStatistics.rttUSecs          = info.tcpi_rtt;
+        _socketStatistics.rttVarianceUSecs  = info.tcpi_rttvar;
+        _socketStatistics.retransmits       = info.tcpi_total_retrans;
+    }
+#endif
+}
+
+TCPLink::SocketStatistics_t TCPLink::socketStatistics(void)
+{
+    QMutexLocker locker(&_statisticsMutex);
+    return _socketStatistics;
+}
+
 void TCPLink::_socketError(QAbstractSocket::SocketError socketError)
 {
-    Q_UNUSED(socketError);
+    if (_reconnecting || socketError == QAbstractSocket::RemoteHostClosedError) {
+        // A dropped connection is reconnected, a popup per failed attempt would just be noise
+        qCDebug(TCPLinkLog) << "Reconnect failed" << _config->name() << _socket->errorString();
+        return;
+    }
     emit communicationError(tr("Link Error"), tr("Error on link %1. Error on socket: %2.").arg(_config->name()).arg(_socket->errorString()));
 }
 
@@ -237,8 +389,10 @@ TCPConfiguration::TCPConfiguration(const QString& name) : LinkConfiguration(name
 
 TCPConfiguration::TCPConfiguration(TCPConfiguration* source) : LinkConfiguration(source)
 {
-    _port    = source->port();
-    _address = source->address();
+    _port           = source->port();
+    _address        = source->address();
+    _lowLatency     = source->lowLatency();
+    _coalesceMSecs  = source->coalesceMSecs();
 }
 
 void TCPConfiguration::copyFrom(LinkConfiguration *source)
@@ -246,8 +400,10 @@ void TCPConfiguration::copyFrom(LinkConfiguration *source)
     LinkConfiguration::copyFrom(source);
     auto* usource = qobject_cast<TCPConfiguration*>(source);
     Q_ASSERT(usource != nullptr);
-    _port    = usource->port();
-    _address = usource->address();
+    _port           = usource->port();
+    _address        = usource->address();
+    _lowLatency     = usource->lowLatency();
+    _coalesceMSecs  = usource->coalesceMSecs();
 }
 
 void TCPConfiguration::setPort(quint16 port)
@@ -260,6 +416,22 @@ void TCPConfiguration::setAddress(const QHostAddress& address)
     _address = address;
 }
 
+void TCPConfiguration::setLowLatency(bool lowLatency)
+{
+    if (_lowLatency != lowLatency) {
+        _lowLatency = lowLatency;
+        emit lowLatencyChanged();
+    }
+}
+
+void TCPConfiguration::setCoalesceMSecs(int coalesceMSecs)
+{
+    if (_coalesceMSecs != coalesceMSecs) {
+        _coalesceMSecs = coalesceMSecs;
+        emit coalesceMSecsChanged();
+    }
+}
+
 void TCPConfiguration::setHost(const QString host)
 {
     QString ipAdd = get_ip_address(host);
@@ -275,6 +447,8 @@ void TCPConfiguration::saveSettings(QSettings& settings, const QString& root)
     settings.beginGroup(root);
     settings.setValue("port", (int)_port);
     settings.setValue("host", address().toString());
+    settings.setValue("lowLatency", _lowLatency);
+    settings.setValue("coalesceMSecs", _coalesceMSecs);
     settings.endGroup();
 }
 
@@ -284,5 +458,7 @@ void TCPConfiguration::loadSettings(QSettings& settings, const QString& root)
     _port = (quint16)settings.value("port", QGC_TCP_PORT).toUInt();
     QString address = settings.value("host", _address.toString()).toString();
     _address = QHostAddress(address);
+    _lowLatency = settings.value("lowLatency", _lowLatency).toBool();
+    _coalesceMSecs = settings.value("coalesceMSecs", _coalesceMSecs).toInt();
     settings.endGroup();
 }
@@ -14,8 +14,10 @@
 #include <QMap>
 #include <QMutex>
 #include <QHostAddress>
+#include <QTimer>
 #include <LinkInterface.h>
 #include "QGCConfig.h"
+#include "QGCLoggingCategory.h"
 
 // Even though QAbstractSocket::SocketError is used in a signal by Qt, Qt doesn't declare it as a meta type.
 // This in turn causes debug output to be kicked out about not being able to queue the signal. We declare it
@@ -30,6 +32,8 @@ class LinkManager;
 
 #define QGC_TCP_PORT 5760
 
+Q_DECLARE_LOGGING_CATEGORY(TCPLinkLog)
+
 class TCPConfiguration : public LinkConfiguration
 {
     Q_OBJECT
@@ -38,6 +42,8 @@ public:
 
     Q_PROPERTY(quint16 port READ port WRITE setPort NOTIFY portChanged)
     Q_PROPERTY(QString host READ host WRITE setHost NOTIFY hostChanged)
+    Q_PROPERTY(bool    lowLatency    READ lowLatency    WRITE setLowLatency    NOTIFY lowLatencyChanged)     ///< true: TCP_NODELAY and a small send buffer, false: writes are coalesced
+    Q_PROPERTY(int     coalesceMSecs READ coalesceMSecs WRITE setCoalesceMSecs NOTIFY coalesceMSecsChanged)  ///< Longest a write is held for coalescing when not low latency
 
     TCPConfiguration(const QString& name);
     TCPConfiguration(TCPConfiguration* source);
@@ -48,6 +54,10 @@ public:
     void                setPort     (quint16 port);
     void                setAddress  (const QHostAddress& address);
     void                setHost     (const QString host);
+    bool                lowLatency  (void) const                    { return _lowLatency; }
+    int                 coalesceMSecs(void) const                   { return _coalesceMSecs; }
+    void                setLowLatency(bool lowLatency);
+    void                setCoalesceMSecs(int coalesceMSecs);
 
     //LinkConfiguration overrides
     LinkType    type                (void) override                                         { return LinkConfiguration::TypeTcp; }
@@ -60,10 +70,14 @@ public:
 signals:
     void portChanged(void);
     void hostChanged(void);
+    void lowLatencyChanged(void);
+    void coalesceMSecsChanged(void);
 
 private:
     QHostAddress    _address;
     quint16         _port;
+    bool            _lowLatency     = true;
+    int             _coalesceMSecs  = 10;
 };
 
 class TCPLink : public LinkInterface
@@ -74,6 +88,23 @@ public:
     TCPLink(SharedLinkConfigurationPtr& config);
     virtual ~TCPLink();
 
+    typedef struct SocketStatistics_t {
+        bool    valid               = false;    ///< false: the platform doesn't report rtt and retransmits
+        quint32 rttUSecs            = 0;        ///< Smoothed round trip time
+        quint32 rttVarianceUSecs    = 0;
+        quint32 retransmits         = 0;        ///< Total retransmitted segments on the current connection
+        quint32 reconnects          = 0;        ///< Connections reestablished since the link was connected
+    } SocketStatistics_t;
+
+    /// Thread safe, updated from the socket every _statisticsUpdateMSecs
+    SocketStatistics_t socketStatistics(void);
+
+    /// @return Delay before the reconnect attempt which follows one made after delayMSecs
+    static int nextReconnectDelay(int delayMSecs);
+
+    static const int initialReconnectDelayMSecs = 500;
+    static const int maxReconnectDelayMSecs     = 30000;
+
     QTcpSocket* getSocket           (void) { return _socket; }
     void        signalBytesWritten  (void);
 
@@ -86,8 +117,9 @@ public slots:
     void waitForReadyRead   (int msecs);
 
 protected slots:
-    void _socketError   (QAbstractSocket::SocketError socketError);
-    void readBytes      (void);
+    void _socketError       (QAbstractSocket::SocketError socketError);
+    void _socketStateChanged(QAbstractSocket::SocketState socketState);
+    void readBytes          (void);
 
 protected:
     // QThread overrides
@@ -103,6 +135,10 @@ private:
     bool _connect(void) override;
 
     bool _hardwareConnect   (void);
+    void _configureSocket   (void);
+    void _reconnect         (void);
+    void _flushWriteBuffer  (void);
+    void _updateStatistics  (void);
 #ifdef TCPLINK_READWRITE_DEBUG
     void _writeDebugBytes   (const QByteArray data);
 #endif
@@ -110,6 +146,20 @@ private:
     TCPConfiguration* _tcpConfig;
     QTcpSocket*       _socket;
     bool              _socketIsConnected;
+    QByteArray        _readBuffer;          ///< Reused across reads to prevent an allocation per read
+    bool              _reconnecting         = false;
+    int               _reconnectDelayMSecs  = initialReconnectDelayMSecs;
+    QByteArray        _writeBuffer;         ///< Writes held for coalescing
+    QMutex            _writeBufferMutex;
+    SocketStatistics_t _socketStatistics;
+
+    // Only valid while the link thread is running, they live on its stack
+    QTimer*           _flushTimer           = nullptr;
+    QTimer*           _reconnectTimer       = nullptr;
+
+    static const int _coalesceBytes             = 8 * 1024;
+    static const int _lowLatencySendBufferSize  = 16 * 1024;
+    static const int _statisticsUpdateMSecs     = 1000;
 
     quint64 _bitsSentTotal;
     quint64 _bitsSentCurrent;
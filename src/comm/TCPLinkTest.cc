@@ -0,0 +1,94 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TCPLinkTest.h"
+#include "TCPLink.h"
+#include "LinkManager.h"
+
+#include <QTcpServer>
+
+void TCPLinkTest::_backoffTest(void)
+{
+    int delay = TCPLink::initialReconnectDelayMSecs;
+
+    delay = TCPLink::nextReconnectDelay(delay);
+    QCOMPARE(delay, TCPLink::initialReconnectDelayMSecs * 2);
+
+    for (int i=0; i<20; i++) {
+        delay = TCPLink::nextReconnectDelay(delay);
+    }
+    QCOMPARE(delay, static_cast<int>(TCPLink::maxReconnectDelayMSecs));
+}
+
+void TCPLinkTest::_coalesceTest(void)
+{
+    QTcpServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost, 0));
+
+    TCPConfiguration* tcpConfig = new TCPConfiguration(QStringLiteral("TCPLinkTest"));
+    tcpConfig->setDynamic(true);
+    tcpConfig->setAddress(QHostAddress::LocalHost);
+    tcpConfig->setPort(server.serverPort());
+    tcpConfig->setLowLatency(false);
+    SharedLinkConfigurationPtr config(tcpConfig);
+
+    QVERIFY(_linkManager->createConnectedLink(config));
+    SharedLinkInterfacePtr link = _linkManager->sharedLinkInterfacePointerForLink(config->link());
+    QVERIFY(link);
+    QTRY_VERIFY(link->isConnected());
+    QTRY_VERIFY(server.hasPendingConnections());
+    QTcpSocket* socket = server.nextPendingConnection();
+
+    // Held writes still go out once the coalescing delay passes
+    QByteArray sentBytes;
+    for (int i=0; i<10; i++) {
+        QByteArray bytes = QByteArray::number(i);
+        link->writeBytesThreadSafe(bytes);
+        sentBytes.append(bytes);
+    }
+    QTRY_COMPARE(socket->bytesAvailable(), static_cast<qint64>(sentBytes.length()));
+    QCOMPARE(socket->readAll(), sentBytes);
+
+    link->disconnect();
+}
+
+void TCPLinkTest::_reconnectTest(void)
+{
+    QTcpServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost, 0));
+
+    TCPConfiguration* tcpConfig = new TCPConfiguration(QStringLiteral("TCPLinkTest"));
+    tcpConfig->setDynamic(true);
+    tcpConfig->setAddress(QHostAddress::LocalHost);
+    tcpConfig->setPort(server.serverPort());
+    SharedLinkConfigurationPtr config(tcpConfig);
+
+    QVERIFY(_linkManager->createConnectedLink(config));
+    SharedLinkInterfacePtr link = _linkManager->sharedLinkInterfacePointerForLink(config->link());
+    QVERIFY(link);
+    QTRY_VERIFY(link->isConnected());
+    QTRY_VERIFY(server.hasPendingConnections());
+
+    // Drop the connection from the far end, the link must come back on its own without being disconnected
+    server.nextPendingConnection()->abort();
+    QTRY_VERIFY_WITH_TIMEOUT(server.hasPendingConnections(), TCPLink::initialReconnectDelayMSecs * 10);
+    QTcpSocket* socket = server.nextPendingConnection();
+    QVERIFY(link->isConnected());
+
+    TCPLink* tcpLink = qobject_cast<TCPLink*>(link.get());
+    QVERIFY(tcpLink);
+    QTRY_COMPARE(tcpLink->socketStatistics().reconnects, static_cast<quint32>(1));
+
+    const QByteArray sentBytes("TCPLinkTest");
+    link->writeBytesThreadSafe(sentBytes);
+    QTRY_COMPARE(socket->bytesAvailable(), static_cast<qint64>(sentBytes.length()));
+    QCOMPARE(socket->readAll(), sentBytes);
+
+    link->disconnect();
+}
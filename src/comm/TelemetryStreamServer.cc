@@ -0,0 +1,445 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryStreamServer.h"
+#include "QGCApplication.h"
+#include "MAVLinkProtocol.h"
+#include "MultiVehicleManager.h"
+#include "SettingsManager.h"
+#include "Vehicle.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QtEndian>
+
+QGC_LOGGING_CATEGORY(TelemetryStreamServerLog, "TelemetryStreamServerLog")
+
+TelemetryStreamServer::TelemetryStreamServer(QGCApplication* app, QGCToolbox* toolbox)
+    : QGCTool(app, toolbox)
+{
+    _tickTimer.setSingleShot(false);
+    _tickTimer.setInterval(tickMSecs);
+    _tickTimer.setWindow(tickMSecs);
+    connect(&_tickTimer,    &QGCWheelTimer::timeout,        this, &TelemetryStreamServer::_tick);
+    connect(&_server,       &QTcpServer::newConnection,     this, &TelemetryStreamServer::_newConnection);
+}
+
+TelemetryStreamServer::~TelemetryStreamServer()
+{
+    // The dispatcher may already be gone, its subscriptions go away with us as their context
+    _server.close();
+    for (Client_t* client: _clients) {
+        delete client->socket;
+        delete client;
+    }
+    _clients.clear();
+    for (const FactSourcePtr& source: _factSources) {
+        disconnect(source->connection);
+    }
+}
+
+void TelemetryStreamServer::setToolbox(QGCToolbox* toolbox)
+{
+    QGCTool::setToolbox(toolbox);
+
+    AppSettings* appSettings = toolbox->settingsManager()->appSettings();
+    connect(appSettings->telemetryStreamEnabled(),  &Fact::rawValueChanged, this, &TelemetryStreamServer::_settingsChanged);
+    connect(appSettings->telemetryStreamPort(),     &Fact::rawValueChanged, this, &TelemetryStreamServer::_settingsChanged);
+}
+
+void TelemetryStreamServer::deferredInit(void)
+{
+    _settingsChanged();
+}
+
+void TelemetryStreamServer::_settingsChanged(void)
+{
+    AppSettings* appSettings = _toolbox->settingsManager()->appSettings();
+
+    close();
+    if (appSettings->telemetryStreamEnabled()->rawValue().toBool()) {
+        QString errorString;
+        if (!listen(static_cast<quint16>(appSettings->telemetryStreamPort()->rawValue().toUInt()), errorString)) {
+            qgcApp()->showAppMessage(tr("Unable to start telemetry streaming: %1").arg(errorString));
+        }
+    }
+}
+
+bool TelemetryStreamServer::listen(quint16 port, QString& errorString)
+{
+    close();
+    if (!_server.listen(QHostAddress::Any, port)) {
+        errorString = _server.errorString();
+        return false;
+    }
+    qCDebug(TelemetryStreamServerLog) << "Listening on port" << _server.serverPort();
+    return true;
+}
+
+void TelemetryStreamServer::close(void)
+{
+    _server.close();
+    while (!_clients.isEmpty()) {
+        _removeClient(_clients.first());
+    }
+}
+
+bool TelemetryStreamServer::parseCommand(const QByteArray& line, Command_t& command, QString& errorString)
+{
+    const QStringList   fields  = QString::fromUtf8(line).simplified().split(QLatin1Char(' '), QString::SkipEmptyParts);
+    const QString       name    = fields.isEmpty() ? QString() : fields[0];
+    bool                ok      = false;
+
+    command.vehicleId   = 0;
+    command.msgId       = 0;
+    command.rateHz      = 0;
+    command.factName.clear();
+
+    if (name == QStringLiteral("remove")) {
+        command.type = Command_t::CommandRemove;
+        if (fields.count() != 2) {
+            errorString = QObject::tr("Usage: remove <id>");
+            return false;
+        }
+    } else if (name == QStringLiteral("fact") || name == QStringLiteral("message")) {
+        command.type = name == QStringLiteral("fact") ? Command_t::CommandFact : Command_t::CommandMessage;
+        if (fields.count() != 5) {
+            errorString = QObject::tr("Usage: %1 <id> <vehicleId> <%2> <rateHz>").arg(name).arg(command.type == Command_t::CommandFact ? QStringLiteral("name") : QStringLiteral("msgId"));
+            return false;
+        }
+        command.vehicleId = fields[2].toInt(&ok);
+        if (!ok || command.vehicleId < 1 || command.vehicleId > 255) {
+            errorString = QObject::tr("Invalid vehicle id '%1'").arg(fields[2]);
+            return false;
+        }
+        if (command.type == Command_t::CommandFact) {
+            command.factName = fields[3];
+        } else {
+            command.msgId = fields[3].toUInt(&ok);
+            if (!ok || command.msgId > 0xFFFFFF) {
+                errorString = QObject::tr("Invalid message id '%1'").arg(fields[3]);
+                return false;
+            }
+        }
+        command.rateHz = fields[4].toInt(&ok);
+        if (!ok || command.rateHz < 0 || command.rateHz > maxRateHz) {
+            errorString = QObject::tr("Invalid rate '%1', must be 0 to %2").arg(fields[4]).arg(maxRateHz);
+            return false;
+        }
+    } else {
+        errorString = QObject::tr("Unknown command '%1'").arg(name);
+        return false;
+    }
+
+    command.id = fields[1].toUShort(&ok);
+    if (!ok) {
+        errorString = QObject::tr("Invalid subscription id '%1'").arg(fields[1]);
+        return false;
+    }
+
+    return true;
+}
+
+void TelemetryStreamServer::_newConnection(void)
+{
+    while (_server.hasPendingConnections()) {
+        Client_t* client = new Client_t;
+        client->socket          = _server.nextPendingConnection();
+        client->errorCount      = 0;
+        client->skippedTicks    = 0;
+        client->socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        _clients.append(client);
+
+        connect(client->socket, &QTcpSocket::readyRead,     this, [this, client]() { _readClient(client); });
+        connect(client->socket, &QTcpSocket::disconnected,  this, [this, client]() { _removeClient(client); });
+
+        qCDebug(TelemetryStreamServerLog) << "Client connected" << client->socket->peerAddress().toString() << client->socket->peerPort();
+    }
+
+    if (!_tickTimer.isActive()) {
+        _tickTimer.start();
+    }
+}
+
+void TelemetryStreamServer::_removeClient(Client_t* client)
+{
+    if (!_clients.removeOne(client)) {
+        return;
+    }
+
+    qCDebug(TelemetryStreamServerLog) << "Client disconnected, skipped ticks" << client->skippedTicks;
+    for (const Subscription_t& subscription: client->subscriptions) {
+        _releaseSource(subscription);
+    }
+    client->socket->disconnect(this);
+    client->socket->abort();
+    client->socket->deleteLater();
+    delete client;
+
+    if (_clients.isEmpty()) {
+        _tickTimer.stop();
+    }
+}
+
+void TelemetryStreamServer::_readClient(Client_t* client)
+{
+    QTcpSocket* socket = client->socket;
+
+    while (socket->canReadLine()) {
+        const QByteArray line = socket->readLine(maxLineBytes + 1);
+        if (line.trimmed().isEmpty()) {
+            continue;
+        }
+        Command_t   command;
+        QString     errorString;
+        if (parseCommand(line, command, errorString)) {
+            _runCommand(client, command);
+        } else {
+            _addError(client, 0, errorString);
+        }
+    }
+
+    if (socket->bytesAvailable() > maxLineBytes) {
+        socket->readAll();
+        _addError(client, 0, tr("Command longer than %1 bytes").arg(maxLineBytes));
+    }
+}
+
+void TelemetryStreamServer::_runCommand(Client_t* client, const Command_t& command)
+{
+    for (int i=0; i<client->subscriptions.count(); i++) {
+        if (client->subscriptions[i].id == command.id) {
+            // A new subscription with the id of an existing one replaces it
+            _removeSubscription(client, i);
+            if (command.type == Command_t::CommandRemove) {
+                return;
+            }
+            break;
+        }
+    }
+
+    if (command.type == Command_t::CommandRemove) {
+        _addError(client, command.id, tr("No subscription %1").arg(command.id));
+        return;
+    }
+    if (command.type == Command_t::CommandFact && command.factName.isEmpty()) {
+        _addError(client, command.id, tr("Fact name is empty"));
+        return;
+    }
+
+    Subscription_t subscription;
+    subscription.id             = command.id;
+    subscription.intervalMSecs  = command.rateHz ? 1000 / command.rateHz : 0;
+    subscription.nextMSecs      = 0;
+    subscription.sentSerial     = 0;
+    if (command.type == Command_t::CommandFact) {
+        subscription.factSource     = _factSource(command.vehicleId, command.factName);
+    } else {
+        subscription.messageSource  = _messageSource(command.vehicleId, command.msgId);
+    }
+    client->subscriptions.append(subscription);
+}
+
+void TelemetryStreamServer::_removeSubscription(Client_t* client, int index)
+{
+    _releaseSource(client->subscriptions[index]);
+    client->subscriptions.removeAt(index);
+}
+
+void TelemetryStreamServer::_addError(Client_t* client, quint16 id, const QString& errorString)
+{
+    qCDebug(TelemetryStreamServerLog) << "Command failed" << id << errorString;
+
+    const QByteArray text = errorString.toUtf8().left(0xFFFF);
+    QDataStream stream(&client->errors, QIODevice::Append);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << id << static_cast<quint8>(RecordError) << static_cast<quint16>(text.length());
+    stream.writeRawData(text.constData(), text.length());
+    client->errorCount++;
+}
+
+TelemetryStreamServer::FactSourcePtr TelemetryStreamServer::_factSource(int vehicleId, const QString& name)
+{
+    const QString key = _factKey(vehicleId, name);
+    FactSourcePtr source = _factSources.value(key);
+    if (source) {
+        source->refCount++;
+        return source;
+    }
+
+    source = FactSourcePtr(new FactSource_t);
+    source->vehicleId   = vehicleId;
+    source->name        = name;
+    source->value       = 0;
+    source->serial      = 0;
+    source->refCount    = 1;
+    // The vehicle may not be there yet, the tick keeps looking for it
+    _resolve(source.data());
+    _factSources.insert(key, source);
+    return source;
+}
+
+TelemetryStreamServer::MessageSourcePtr TelemetryStreamServer::_messageSource(int vehicleId, uint32_t msgId)
+{
+    const quint64 key = _messageKey(vehicleId, msgId);
+    MessageSourcePtr source = _messageSources.value(key);
+    if (source) {
+        source->refCount++;
+        return source;
+    }
+
+    source = MessageSourcePtr(new MessageSource_t);
+    source->vehicleId   = vehicleId;
+    source->msgId       = msgId;
+    source->serial      = 0;
+    source->refCount    = 1;
+
+    MessageSource_t* rawSource = source.data();
+    source->handle = _toolbox->mavlinkProtocol()->messageDispatcher()->subscribe(msgId, vehicleId, MAVLinkMessageDispatcher::AnyComponent, this,
+                                                                                 [this, rawSource](LinkInterface*, const mavlink_message_t& message) {
+        _messageReceived(rawSource, message);
+    });
+    _messageSources.insert(key, source);
+    return source;
+}
+
+void TelemetryStreamServer::_releaseSource(const Subscription_t& subscription)
+{
+    if (subscription.factSource) {
+        FactSource_t* source = subscription.factSource.data();
+        if (--source->refCount == 0) {
+            disconnect(source->connection);
+            _factSources.remove(_factKey(source->vehicleId, source->name));
+        }
+    } else if (subscription.messageSource) {
+        MessageSource_t* source = subscription.messageSource.data();
+        if (--source->refCount == 0) {
+            _toolbox->mavlinkProtocol()->messageDispatcher()->unsubscribe(source->handle);
+            _messageSources.remove(_messageKey(source->vehicleId, source->msgId));
+        }
+    }
+}
+
+bool TelemetryStreamServer::_resolve(FactSource_t* source)
+{
+    FactGroup* factGroup = _toolbox->multiVehicleManager()->getVehicleById(source->vehicleId);
+    if (!factGroup) {
+        return false;
+    }
+
+    const QStringList path = source->name.split(QLatin1Char('.'));
+    for (int i=0; i<path.count() - 1 && factGroup; i++) {
+        factGroup = factGroup->factGroups().value(path[i]);
+    }
+    if (!factGroup || !factGroup->factExists(path.last())) {
+        return false;
+    }
+    Fact* fact = factGroup->getFact(path.last());
+    if (fact->typeIsString()) {
+        qCWarning(TelemetryStreamServerLog) << "Only numeric facts can be streamed" << source->name;
+        return false;
+    }
+
+    // valueChanged is sent once per FactGroup update tick, so this runs at the display rate and not the message rate
+    source->fact        = fact;
+    source->connection  = connect(fact, &Fact::valueChanged, this, [source, fact]() {
+        source->value = fact->rawValue().toDouble();
+        source->serial++;
+    });
+    source->value = fact->rawValue().toDouble();
+    source->serial++;
+    return true;
+}
+
+void TelemetryStreamServer::_messageReceived(MessageSource_t* source, const mavlink_message_t& message)
+{
+    LatestMessage_t& latest = source->latest[message.compid];
+    latest.length  = mavlink_msg_to_send_buffer(latest.wire, &message);
+    latest.serial  = ++source->serial;
+}
+
+void TelemetryStreamServer::_tick(void)
+{
+    const qint64 nowMSecs = QDateTime::currentMSecsSinceEpoch();
+
+    if (nowMSecs - _lastResolveMSecs >= resolveMSecs) {
+        _lastResolveMSecs = nowMSecs;
+        for (const FactSourcePtr& source: _factSources) {
+            // Facts go away with their vehicle
+            if (!source->fact) {
+                _resolve(source.data());
+            }
+        }
+    }
+
+    for (Client_t* client: _clients) {
+        if (client->socket->bytesToWrite() > maxPendingBytes) {
+            // Values keep being updated in place, so the client gets the newest ones once it catches up
+            client->skippedTicks++;
+            continue;
+        }
+        _writeFrame(client, nowMSecs);
+    }
+}
+
+void TelemetryStreamServer::_writeFrame(Client_t* client, qint64 nowMSecs)
+{
+    const int   headerBytes = sizeof(quint32) + sizeof(quint64) + sizeof(quint16);
+    int         recordCount = client->errorCount;
+    QByteArray  frame;
+
+    QDataStream stream(&frame, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << static_cast<quint32>(0) << static_cast<quint64>(nowMSecs) << static_cast<quint16>(0);
+    stream.writeRawData(client->errors.constData(), client->errors.length());
+    client->errors.clear();
+    client->errorCount = 0;
+
+    for (Subscription_t& subscription: client->subscriptions) {
+        if (nowMSecs < subscription.nextMSecs || recordCount >= 0xFFFF) {
+            continue;
+        }
+
+        if (subscription.factSource) {
+            const FactSource_t* source = subscription.factSource.data();
+            if (source->serial == subscription.sentSerial) {
+                continue;
+            }
+            stream << subscription.id << static_cast<quint8>(RecordFact) << source->value;
+            recordCount++;
+            subscription.sentSerial = source->serial;
+        } else {
+            const MessageSource_t* source = subscription.messageSource.data();
+            if (source->serial == subscription.sentSerial) {
+                continue;
+            }
+            for (auto iter = source->latest.constBegin(); iter != source->latest.constEnd() && recordCount < 0xFFFF; ++iter) {
+                quint64& sentSerial = subscription.sentSerials[iter.key()];
+                if (iter.value().serial == sentSerial) {
+                    continue;
+                }
+                stream << subscription.id << static_cast<quint8>(RecordMessage) << static_cast<quint16>(iter.value().length);
+                stream.writeRawData(reinterpret_cast<const char*>(iter.value().wire), iter.value().length);
+                recordCount++;
+                sentSerial = iter.value().serial;
+            }
+            subscription.sentSerial = source->serial;
+        }
+        subscription.nextMSecs = nowMSecs + subscription.intervalMSecs;
+    }
+
+    if (recordCount == 0) {
+        return;
+    }
+
+    uchar* header = reinterpret_cast<uchar*>(frame.data());
+    qToLittleEndian<quint32>(static_cast<quint32>(frame.length() - sizeof(quint32)), header);
+    qToLittleEndian<quint16>(static_cast<quint16>(recordCount), header + headerBytes - sizeof(quint16));
+    client->socket->write(frame);
+}
@@ -0,0 +1,180 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCToolbox.h"
+#include "QGCTimerWheel.h"
+#include "QGCLoggingCategory.h"
+#include "QGCMAVLink.h"
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QHash>
+#include <QList>
+#include <QMap>
+
+Q_DECLARE_LOGGING_CATEGORY(TelemetryStreamServerLog)
+
+class Fact;
+class LinkInterface;
+
+/// Streams live telemetry to external clients over TCP.
+///
+/// Clients send subscription commands as text lines:
+///     fact <id> <vehicleId> <name> <rateHz>       Fact of a vehicle, name is "altitudeRelative" or "gps.hdop"
+///     message <id> <vehicleId> <msgId> <rateHz>   Raw messages of a vehicle, the newest one of each component
+///     remove <id>
+/// The id is chosen by the client and comes back with each record. A rate of 0 sends every change, up to maxRateHz.
+///
+/// The server sends binary frames, all values little endian:
+///     uint32  Length of the rest of the frame
+///     uint64  Milliseconds since the epoch
+///     uint16  Record count, followed by the records:
+///         uint16  Subscription id
+///         uint8   RecordFact: float64 raw value
+///                 RecordMessage: uint16 length and the wire bytes of the message
+///                 RecordError: uint16 length and a UTF-8 message, for a command which failed
+/// Each tick a client gets at most one frame, holding the subscriptions which are due and have changed since they
+/// were last sent.
+///
+/// Facts are read from their valueChanged signal, which FactGroup only sends once per update tick for the Facts
+/// which changed. Messages are copied once as they are dispatched. Either way each value is taken in once no matter
+/// how many clients subscribe to it, clients only read it.
+///
+/// A client which doesn't keep up is skipped while more than maxPendingBytes are waiting to be written to it. It
+/// then gets the newest values once it has caught up, the values in between are dropped.
+class TelemetryStreamServer : public QGCTool
+{
+    Q_OBJECT
+
+public:
+    TelemetryStreamServer(QGCApplication* app, QGCToolbox* toolbox);
+    ~TelemetryStreamServer();
+
+    enum RecordType {
+        RecordFact,
+        RecordMessage,
+        RecordError
+    };
+
+    typedef struct {
+        enum {
+            CommandFact,
+            CommandMessage,
+            CommandRemove
+        }           type;
+        quint16     id;
+        int         vehicleId;
+        QString     factName;
+        uint32_t    msgId;
+        int         rateHz;
+    } Command_t;
+
+    /// @return false: Command is invalid, errorString set
+    static bool parseCommand(const QByteArray& line, Command_t& command, QString& errorString);
+
+    /// Starts listening, the port set in the settings is used when the stream is enabled there
+    /// @param port 0 for any free port
+    /// @return false: errorString set
+    bool    listen      (quint16 port, QString& errorString);
+    void    close       (void);
+    bool    isListening (void) const { return _server.isListening(); }
+    quint16 serverPort  (void) const { return _server.serverPort(); }
+    int     clientCount (void) const { return _clients.count(); }
+
+    /// Number of values taken in by the server, shared between all clients subscribed to them
+    int     sourceCount (void) const { return _factSources.count() + _messageSources.count(); }
+
+    // QGCTool overrides
+    void setToolbox     (QGCToolbox* toolbox) final;
+    void deferredInit   (void) final;
+
+    static const int    tickMSecs           = 20;
+    static const int    maxRateHz           = 1000 / tickMSecs;
+    static const int    maxPendingBytes     = 1024 * 1024;
+    static const int    maxLineBytes        = 1024;
+    static const int    resolveMSecs        = 1000;     ///< How often Facts of vehicles which aren't there yet are looked for
+
+private slots:
+    void _newConnection     (void);
+    void _tick              (void);
+    void _settingsChanged   (void);
+
+private:
+    typedef struct {
+        int                     vehicleId;
+        QString                 name;
+        QPointer<Fact>          fact;
+        QMetaObject::Connection connection;
+        double                  value;
+        quint64                 serial;                 ///< Changes with each new value, 0 until there is a value
+        int                     refCount;
+    } FactSource_t;
+
+    typedef struct {
+        uint8_t     wire[MAVLINK_MAX_PACKET_LEN];
+        quint16     length;
+        quint64     serial;
+    } LatestMessage_t;
+
+    typedef struct {
+        int                             vehicleId;
+        uint32_t                        msgId;
+        int                             handle;
+        QMap<uint8_t, LatestMessage_t>  latest;         ///< By component id
+        quint64                         serial;
+        int                             refCount;
+    } MessageSource_t;
+
+    typedef QSharedPointer<FactSource_t>    FactSourcePtr;
+    typedef QSharedPointer<MessageSource_t> MessageSourcePtr;
+
+    typedef struct {
+        quint16                 id;
+        FactSourcePtr           factSource;
+        MessageSourcePtr        messageSource;
+        int                     intervalMSecs;
+        qint64                  nextMSecs;
+        quint64                 sentSerial;
+        QMap<uint8_t, quint64>  sentSerials;            ///< Messages, by component id
+    } Subscription_t;
+
+    typedef struct {
+        QTcpSocket*             socket;
+        QList<Subscription_t>   subscriptions;
+        QByteArray              errors;                 ///< Error records waiting for the next frame
+        int                     errorCount;
+        quint64                 skippedTicks;
+    } Client_t;
+
+    void                _readClient         (Client_t* client);
+    void                _runCommand         (Client_t* client, const Command_t& command);
+    void                _removeSubscription (Client_t* client, int index);
+    void                _removeClient       (Client_t* client);
+    void                _addError           (Client_t* client, quint16 id, const QString& errorString);
+    void                _writeFrame         (Client_t* client, qint64 nowMSecs);
+    FactSourcePtr       _factSource         (int vehicleId, const QString& name);
+    MessageSourcePtr    _messageSource      (int vehicleId, uint32_t msgId);
+    void                _releaseSource      (const Subscription_t& subscription);
+    bool                _resolve            (FactSource_t* source);
+    void                _messageReceived    (MessageSource_t* source, const mavlink_message_t& message);
+
+    static QString      _factKey            (int vehicleId, const QString& name) { return QStringLiteral("%1:%2").arg(vehicleId).arg(name); }
+    static quint64      _messageKey         (int vehicleId, uint32_t msgId) { return (static_cast<quint64>(vehicleId) << 32) | msgId; }
+
+    QTcpServer                          _server;
+    QList<Client_t*>                    _clients;
+    QHash<QString, FactSourcePtr>       _factSources;
+    QHash<quint64, MessageSourcePtr>    _messageSources;
+    QGCWheelTimer                       _tickTimer          { "TelemetryStream" };
+    qint64                              _lastResolveMSecs   = 0;
+};
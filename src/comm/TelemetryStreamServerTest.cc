@@ -0,0 +1,212 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TelemetryStreamServerTest.h"
+#include "TelemetryStreamServer.h"
+#include "QGCApplication.h"
+#include "MAVLinkProtocol.h"
+#include "MultiVehicleManager.h"
+#include "Vehicle.h"
+
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QtEndian>
+
+TelemetryStreamServer* TelemetryStreamServerTest::_listen(void)
+{
+    TelemetryStreamServer*  server = qgcApp()->toolbox()->telemetryStreamServer();
+    QString                 errorString;
+
+    if (!server->listen(0, errorString)) {
+        qWarning() << errorString;
+        return nullptr;
+    }
+    return server;
+}
+
+void TelemetryStreamServerTest::_connect(TelemetryStreamServer* server, QTcpSocket& socket)
+{
+    const int clientCount = server->clientCount();
+    socket.connectToHost(QHostAddress::LocalHost, server->serverPort());
+    QVERIFY(socket.waitForConnected(5000));
+    QTRY_COMPARE(server->clientCount(), clientCount + 1);
+}
+
+bool TelemetryStreamServerTest::_readFrame(QTcpSocket& socket, QList<Record_t>& records)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    quint32 length = 0;
+    while (timer.elapsed() < 5000) {
+        if (socket.bytesAvailable() >= static_cast<qint64>(sizeof(length))) {
+            socket.peek(reinterpret_cast<char*>(&length), sizeof(length));
+            length = qFromLittleEndian(length);
+            if (socket.bytesAvailable() >= static_cast<qint64>(sizeof(length) + length)) {
+                break;
+            }
+        }
+        QTest::qWait(10);
+    }
+    if (socket.bytesAvailable() < static_cast<qint64>(sizeof(length) + length) || length == 0) {
+        return false;
+    }
+
+    QByteArray  frame = socket.read(sizeof(length) + length);
+    QDataStream stream(frame);
+    quint64     msecs;
+    quint16     count;
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream >> length >> msecs >> count;
+
+    records.clear();
+    for (int i=0; i<count; i++) {
+        Record_t record;
+        record.value = 0;
+        stream >> record.id >> record.type;
+        if (record.type == TelemetryStreamServer::RecordFact) {
+            stream >> record.value;
+        } else {
+            quint16 byteCount;
+            stream >> byteCount;
+            record.bytes.resize(byteCount);
+            stream.readRawData(record.bytes.data(), byteCount);
+        }
+        records.append(record);
+    }
+    return stream.status() == QDataStream::Ok && stream.atEnd();
+}
+
+void TelemetryStreamServerTest::_parseTest(void)
+{
+    TelemetryStreamServer::Command_t    command;
+    QString                             errorString;
+
+    QVERIFY(TelemetryStreamServer::parseCommand("fact 3 1 gps.hdop 10\n", command, errorString));
+    QVERIFY(command.type == TelemetryStreamServer::Command_t::CommandFact);
+    QCOMPARE(command.id, static_cast<quint16>(3));
+    QCOMPARE(command.vehicleId, 1);
+    QCOMPARE(command.factName, QStringLiteral("gps.hdop"));
+    QCOMPARE(command.rateHz, 10);
+
+    QVERIFY(TelemetryStreamServer::parseCommand("  message 4   2 30 0", command, errorString));
+    QVERIFY(command.type == TelemetryStreamServer::Command_t::CommandMessage);
+    QCOMPARE(command.vehicleId, 2);
+    QCOMPARE(command.msgId, static_cast<uint32_t>(MAVLINK_MSG_ID_ATTITUDE));
+    QCOMPARE(command.rateHz, 0);
+
+    QVERIFY(TelemetryStreamServer::parseCommand("remove 4", command, errorString));
+    QVERIFY(command.type == TelemetryStreamServer::Command_t::CommandRemove);
+    QCOMPARE(command.id, static_cast<quint16>(4));
+
+    QVERIFY(!TelemetryStreamServer::parseCommand("bogus 1", command, errorString));
+    QVERIFY(!TelemetryStreamServer::parseCommand("fact 1 1 heading", command, errorString));
+    QVERIFY(!TelemetryStreamServer::parseCommand("fact 1 0 heading 10", command, errorString));
+    QVERIFY(!TelemetryStreamServer::parseCommand("fact 70000 1 heading 10", command, errorString));
+    QVERIFY(!TelemetryStreamServer::parseCommand("message 1 1 x 10", command, errorString));
+    QVERIFY(!TelemetryStreamServer::parseCommand("message 1 1 30 1000", command, errorString));
+    QVERIFY(!TelemetryStreamServer::parseCommand("remove", command, errorString));
+}
+
+void TelemetryStreamServerTest::_messageTest(void)
+{
+    TelemetryStreamServer* server = _listen();
+    QVERIFY(server);
+
+    QTcpSocket first;
+    QTcpSocket second;
+    _connect(server, first);
+    _connect(server, second);
+
+    // Both clients share a single source
+    first.write("message 7 42 30 0\n");
+    second.write("message 9 42 30 0\n");
+    QTRY_COMPARE(server->sourceCount(), 1);
+
+    mavlink_message_t message;
+    mavlink_msg_attitude_pack(42, MAV_COMP_ID_AUTOPILOT1, &message, 1000, 0.5f, 0, 0, 0, 0, 0);
+    qgcApp()->toolbox()->mavlinkProtocol()->messageDispatcher()->dispatch(nullptr, message);
+
+    QByteArray wire(MAVLINK_MAX_PACKET_LEN, 0);
+    wire.resize(mavlink_msg_to_send_buffer(reinterpret_cast<uint8_t*>(wire.data()), &message));
+
+    QList<Record_t> records;
+    QVERIFY(_readFrame(first, records));
+    QCOMPARE(records.count(), 1);
+    QCOMPARE(records[0].id, static_cast<quint16>(7));
+    QCOMPARE(records[0].type, static_cast<quint8>(TelemetryStreamServer::RecordMessage));
+    QCOMPARE(records[0].bytes, wire);
+
+    QVERIFY(_readFrame(second, records));
+    QCOMPARE(records.count(), 1);
+    QCOMPARE(records[0].id, static_cast<quint16>(9));
+
+    // Unchanged values aren't sent again
+    QTest::qWait(TelemetryStreamServer::tickMSecs * 5);
+    QCOMPARE(first.bytesAvailable(), static_cast<qint64>(0));
+
+    first.abort();
+    QTRY_COMPARE(server->clientCount(), 1);
+    QCOMPARE(server->sourceCount(), 1);
+    second.write("remove 9\n");
+    QTRY_COMPARE(server->sourceCount(), 0);
+
+    server->close();
+    QCOMPARE(server->clientCount(), 0);
+}
+
+void TelemetryStreamServerTest::_errorTest(void)
+{
+    TelemetryStreamServer* server = _listen();
+    QVERIFY(server);
+
+    QTcpSocket socket;
+    _connect(server, socket);
+    socket.write("remove 5\n");
+
+    QList<Record_t> records;
+    QVERIFY(_readFrame(socket, records));
+    QCOMPARE(records.count(), 1);
+    QCOMPARE(records[0].id, static_cast<quint16>(5));
+    QCOMPARE(records[0].type, static_cast<quint8>(TelemetryStreamServer::RecordError));
+    QVERIFY(!records[0].bytes.isEmpty());
+
+    server->close();
+}
+
+void TelemetryStreamServerTest::_factTest(void)
+{
+    _connectMockLink();
+    Vehicle* vehicle = qgcApp()->toolbox()->multiVehicleManager()->activeVehicle();
+    QVERIFY(vehicle);
+
+    TelemetryStreamServer* server = _listen();
+    QVERIFY(server);
+
+    QTcpSocket socket;
+    _connect(server, socket);
+    socket.write(QStringLiteral("fact 1 %1 throttlePct 0\n").arg(vehicle->id()).toUtf8());
+    QTRY_COMPARE(server->sourceCount(), 1);
+
+    // The value the fact has when it is found comes first
+    QList<Record_t> records;
+    QVERIFY(_readFrame(socket, records));
+    QCOMPARE(records.count(), 1);
+    QCOMPARE(records[0].type, static_cast<quint8>(TelemetryStreamServer::RecordFact));
+
+    // MockLink doesn't send VFR_HUD, so nothing else changes the value
+    vehicle->getFact(QStringLiteral("throttlePct"))->setRawValue(17);
+    QVERIFY(_readFrame(socket, records));
+    QCOMPARE(records.count(), 1);
+    QCOMPARE(records[0].id, static_cast<quint16>(1));
+    QCOMPARE(records[0].value, 17.0);
+
+    server->close();
+    _disconnectMockLink();
+}
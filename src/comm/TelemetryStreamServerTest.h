@@ -0,0 +1,39 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QTcpSocket>
+
+class TelemetryStreamServer;
+
+class TelemetryStreamServerTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _parseTest     (void);
+    void _messageTest   (void);
+    void _errorTest     (void);
+    void _factTest      (void);
+
+private:
+    typedef struct {
+        quint16     id;
+        quint8      type;
+        double      value;
+        QByteArray  bytes;
+    } Record_t;
+
+    TelemetryStreamServer*  _listen     (void);
+    void                    _connect    (TelemetryStreamServer* server, QTcpSocket& socket);
+    bool                    _readFrame  (QTcpSocket& socket, QList<Record_t>& records);
+};
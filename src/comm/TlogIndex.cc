@@ -0,0 +1,213 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogIndex.h"
+#include "MAVLinkFramer.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+QGC_LOGGING_CATEGORY(TlogIndexLog, "TlogIndexLog")
+
+static const char   kMagic[]        = "QGCTLX";
+static const int    kMagicSize      = sizeof(kMagic) - 1;
+static const int    kReadChunkSize  = 1024 * 1024;
+
+static void _setupStream(QDataStream& stream)
+{
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setVersion(QDataStream::Qt_5_12);
+}
+
+TlogIndex::TlogIndex(void)
+{
+
+}
+
+void TlogIndex::_clear(void)
+{
+    _entries.clear();
+    _startTimeUSecs = 0;
+    _endTimeUSecs   = 0;
+    _recordCount    = 0;
+}
+
+QString TlogIndex::cacheFileName(const QString& logFileName)
+{
+    return logFileName + QStringLiteral(".index");
+}
+
+quint64 TlogIndex::parseTimestamp(const char* bytes)
+{
+    quint64 timestamp = qFromBigEndian<quint64>(reinterpret_cast<const uchar*>(bytes));
+    quint64 currentTimestamp = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch()) * 1000;
+
+    // Now if the parsed timestamp is in the future, it must be an old file where the timestamp was stored as
+    // little endian, so switch it.
+    if (timestamp > currentTimestamp) {
+        timestamp = qbswap(timestamp);
+    }
+
+    return timestamp;
+}
+
+bool TlogIndex::build(const QString& logFileName, QString& errorString)
+{
+    _clear();
+
+    QFile file(logFileName);
+    if (!file.open(QFile::ReadOnly)) {
+        errorString = tr("Unable to open log file: '%1', error: %2").arg(logFileName, file.errorString());
+        return false;
+    }
+
+    QByteArray  buffer;
+    qint64      bufferOffset    = 0;    // File offset of buffer[0]
+    int         position        = 0;
+    quint64     lastEntryUSecs  = 0;
+
+    forever {
+        // Keep at least one whole record ahead, unless the end of the file was reached
+        if (buffer.size() - position < cbTimestamp + MAVLINK_MAX_PACKET_LEN && !file.atEnd()) {
+            buffer.remove(0, position);
+            bufferOffset += position;
+            position = 0;
+            buffer.append(file.read(kReadChunkSize));
+        }
+
+        const int available = buffer.size() - position;
+        if (available <= cbTimestamp) {
+            break;
+        }
+
+        const char* record = buffer.constData() + position;
+        const int   length = MAVLinkFramer::packetLength(reinterpret_cast<const uint8_t*>(record + cbTimestamp), available - cbTimestamp);
+        if (length == 0) {
+            // Partial record at the end of the log
+            break;
+        } else if (length < 0) {
+            // Corrupt data, resync on the next byte
+            position++;
+            continue;
+        }
+
+        const quint64 timeUSecs = parseTimestamp(record);
+        if (_entries.isEmpty()) {
+            _startTimeUSecs = timeUSecs;
+        }
+        if (_entries.isEmpty() || timeUSecs >= lastEntryUSecs + entryIntervalUSecs) {
+            // Entries only move forward in time, otherwise the binary search of entryForTime breaks
+            _entries.append({ bufferOffset + position, timeUSecs });
+            lastEntryUSecs = timeUSecs;
+        }
+        _endTimeUSecs = qMax(_endTimeUSecs, timeUSecs);
+        _recordCount++;
+        position += cbTimestamp + length;
+    }
+
+    if (_entries.isEmpty()) {
+        errorString = tr("The log file '%1' is corrupt or empty.").arg(logFileName);
+        return false;
+    }
+
+    qCDebug(TlogIndexLog) << "Indexed" << logFileName << "records:entries" << _recordCount << _entries.count();
+    return true;
+}
+
+bool TlogIndex::load(const QString& logFileName)
+{
+    _clear();
+
+    QFile file(cacheFileName(logFileName));
+    if (!file.open(QFile::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    _setupStream(stream);
+
+    const QFileInfo logFileInfo(logFileName);
+    char            magic[kMagicSize];
+    quint16         version = 0;
+    qint64          logSize = 0;
+    qint64          logModifiedMSecs = 0;
+    quint32         entryCount = 0;
+
+    if (stream.readRawData(magic, kMagicSize) != kMagicSize || memcmp(magic, kMagic, kMagicSize) != 0) {
+        return false;
+    }
+    stream >> version >> logSize >> logModifiedMSecs;
+    if (stream.status() != QDataStream::Ok || version != cacheVersion ||
+            logSize != logFileInfo.size() || logModifiedMSecs != logFileInfo.lastModified().toMSecsSinceEpoch()) {
+        qCDebug(TlogIndexLog) << "Cached index is out of date" << logFileName;
+        return false;
+    }
+    stream >> _startTimeUSecs >> _endTimeUSecs >> _recordCount >> entryCount;
+    if (stream.status() != QDataStream::Ok || entryCount * sizeof(Entry_t) > static_cast<quint64>(file.size())) {
+        _clear();
+        return false;
+    }
+    _entries.resize(static_cast<int>(entryCount));
+    for (Entry_t& entry: _entries) {
+        stream >> entry.offset >> entry.timeUSecs;
+    }
+    if (stream.status() != QDataStream::Ok || _entries.isEmpty()) {
+        _clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool TlogIndex::save(const QString& logFileName) const
+{
+    QSaveFile file(cacheFileName(logFileName));
+    if (!file.open(QFile::WriteOnly)) {
+        qCDebug(TlogIndexLog) << "Unable to save index" << file.fileName() << file.errorString();
+        return false;
+    }
+    QDataStream stream(&file);
+    _setupStream(stream);
+
+    const QFileInfo logFileInfo(logFileName);
+    stream.writeRawData(kMagic, kMagicSize);
+    stream << static_cast<quint16>(cacheVersion) << logFileInfo.size() << logFileInfo.lastModified().toMSecsSinceEpoch();
+    stream << _startTimeUSecs << _endTimeUSecs << _recordCount << static_cast<quint32>(_entries.count());
+    for (const Entry_t& entry: _entries) {
+        stream << entry.offset << entry.timeUSecs;
+    }
+
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+bool TlogIndex::loadOrBuild(const QString& logFileName, QString& errorString)
+{
+    if (load(logFileName)) {
+        return true;
+    }
+    if (!build(logFileName, errorString)) {
+        return false;
+    }
+    save(logFileName);
+    return true;
+}
+
+const TlogIndex::Entry_t& TlogIndex::entryForTime(quint64 timeUSecs) const
+{
+    auto iter = std::upper_bound(_entries.constBegin(), _entries.constEnd(), timeUSecs, [](quint64 time, const Entry_t& entry) {
+        return time < entry.timeUSecs;
+    });
+    return iter == _entries.constBegin() ? *iter : *(iter - 1);
+}
@@ -0,0 +1,78 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "QGCLoggingCategory.h"
+
+#include <QCoreApplication>
+#include <QString>
+#include <QVector>
+
+Q_DECLARE_LOGGING_CATEGORY(TlogIndexLog)
+
+/// Timestamp index of a telemetry log, which lets LogReplayLink seek with a binary search instead of scanning the file.
+///
+/// A tlog is a sequence of records, each an 8 byte big endian timestamp in microseconds followed by one MAVLink
+/// packet. The index is built in one pass which frames whole packets rather than parsing byte by byte, and keeps the
+/// offset of one record for every entryIntervalUSecs of log time. It is cached beside the log, see cacheFileName.
+class TlogIndex
+{
+    Q_DECLARE_TR_FUNCTIONS(TlogIndex)
+
+public:
+    TlogIndex(void);
+
+    typedef struct {
+        qint64  offset;         ///< File offset of the record
+        quint64 timeUSecs;
+    } Entry_t;
+
+    /// Scans the log
+    /// @return false: failed or no records found, errorString set
+    bool build(const QString& logFileName, QString& errorString);
+
+    /// Loads the index cached for the log. Fails if the log changed since the cache was saved.
+    bool load(const QString& logFileName);
+
+    /// Saves the index beside the log, failure only costs building it again next time
+    bool save(const QString& logFileName) const;
+
+    /// Builds the index unless a cache of it can be loaded, saving a newly built index
+    bool loadOrBuild(const QString& logFileName, QString& errorString);
+
+    bool    isValid         (void) const { return !_entries.isEmpty(); }
+    quint64 startTimeUSecs  (void) const { return _startTimeUSecs; }
+    quint64 endTimeUSecs    (void) const { return _endTimeUSecs; }
+    quint64 recordCount     (void) const { return _recordCount; }
+
+    const QVector<Entry_t>& entries(void) const { return _entries; }
+
+    /// @return Latest entry at or before timeUSecs, the first entry for earlier times. Index must be valid.
+    const Entry_t& entryForTime(quint64 timeUSecs) const;
+
+    /// @return File name of the cache for the log
+    static QString cacheFileName(const QString& logFileName);
+
+    /// Parses a record timestamp
+    /// @return A Unix timestamp in microseconds UTC
+    static quint64 parseTimestamp(const char* bytes);
+
+    static const int        cbTimestamp         = sizeof(quint64);
+    static const quint64    entryIntervalUSecs  = 100000;
+    static const int        cacheVersion        = 1;
+
+private:
+    void _clear(void);
+
+    QVector<Entry_t>    _entries;
+    quint64             _startTimeUSecs = 0;
+    quint64             _endTimeUSecs   = 0;
+    quint64             _recordCount    = 0;
+};
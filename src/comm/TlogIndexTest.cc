@@ -0,0 +1,150 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "TlogIndexTest.h"
+#include "TlogIndex.h"
+
+#include <QtEndian>
+#include <QTemporaryDir>
+
+static const quint64 _startTimeUSecs        = Q_UINT64_C(1600000000000000);
+static const quint64 _recordSpacingUSecs    = 50000;
+
+void TlogIndexTest::init(void)
+{
+    UnitTest::init();
+    mavlink_reset_channel_status(_channel);
+}
+
+QByteArray TlogIndexTest::_record(quint64 timeUSecs)
+{
+    mavlink_message_t   message;
+    uint8_t             buffer[TlogIndex::cbTimestamp + MAVLINK_MAX_PACKET_LEN];
+
+    qToBigEndian<quint64>(timeUSecs, buffer);
+    mavlink_msg_heartbeat_pack_chan(1, MAV_COMP_ID_AUTOPILOT1, _channel, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+    int length = mavlink_msg_to_send_buffer(&buffer[TlogIndex::cbTimestamp], &message);
+
+    return QByteArray(reinterpret_cast<const char*>(buffer), TlogIndex::cbTimestamp + length);
+}
+
+bool TlogIndexTest::_writeLog(const QString& fileName, const QByteArray& bytes, bool append)
+{
+    QFile file(fileName);
+    if (!file.open(append ? QFile::Append : QFile::WriteOnly | QFile::Truncate)) {
+        return false;
+    }
+    return file.write(bytes) == bytes.size();
+}
+
+void TlogIndexTest::_buildTest(void)
+{
+    QTemporaryDir   tempDir;
+    QString         logFileName = tempDir.filePath(QStringLiteral("build.tlog"));
+    QByteArray      bytes;
+
+    // One second of records at 20Hz, followed by half a record which is ignored
+    for (int i=0; i<20; i++) {
+        bytes.append(_record(_startTimeUSecs + (i * _recordSpacingUSecs)));
+    }
+    const int recordSize = bytes.size() / 20;
+    bytes.append(_record(_startTimeUSecs + (20 * _recordSpacingUSecs)).left(recordSize / 2));
+    QVERIFY(_writeLog(logFileName, bytes));
+
+    TlogIndex   index;
+    QString     errorString;
+    QVERIFY(index.build(logFileName, errorString));
+    QCOMPARE(index.recordCount(),       static_cast<quint64>(20));
+    QCOMPARE(index.startTimeUSecs(),    _startTimeUSecs);
+    QCOMPARE(index.endTimeUSecs(),      _startTimeUSecs + (19 * _recordSpacingUSecs));
+
+    // An entry every other record
+    QCOMPARE(index.entries().count(), 10);
+    for (int i=0; i<index.entries().count(); i++) {
+        QCOMPARE(index.entries()[i].offset,     static_cast<qint64>(2 * i * recordSize));
+        QCOMPARE(index.entries()[i].timeUSecs,  _startTimeUSecs + (i * TlogIndex::entryIntervalUSecs));
+    }
+
+    QCOMPARE(index.entryForTime(0).offset,                                  Q_INT64_C(0));
+    QCOMPARE(index.entryForTime(_startTimeUSecs).offset,                    Q_INT64_C(0));
+    QCOMPARE(index.entryForTime(_startTimeUSecs + 250000).timeUSecs,        _startTimeUSecs + 200000);
+    QCOMPARE(index.entryForTime(_startTimeUSecs + 300000).timeUSecs,        _startTimeUSecs + 300000);
+    QCOMPARE(index.entryForTime(_startTimeUSecs + 5000000).timeUSecs,       _startTimeUSecs + 900000);
+    QCOMPARE(TlogIndex::parseTimestamp(bytes.constData()),                  _startTimeUSecs);
+
+    QVERIFY(!index.build(tempDir.filePath(QStringLiteral("missing.tlog")), errorString));
+    QVERIFY(!index.isValid());
+}
+
+void TlogIndexTest::_resyncTest(void)
+{
+    QTemporaryDir   tempDir;
+    QString         logFileName = tempDir.filePath(QStringLiteral("resync.tlog"));
+
+    // Junk, a record with a damaged packet and a truncated record are all skipped
+    QByteArray damaged = _record(_startTimeUSecs + _recordSpacingUSecs);
+    damaged[damaged.size() - 1] = damaged[damaged.size() - 1] ^ 0xFF;
+
+    QByteArray bytes = _record(_startTimeUSecs);
+    bytes.append(QByteArray(13, '\0'));
+    bytes.append(damaged);
+    bytes.append(_record(_startTimeUSecs + (2 * _recordSpacingUSecs)).left(15));
+    const qint64 lastOffset = bytes.size();
+    bytes.append(_record(_startTimeUSecs + (3 * _recordSpacingUSecs)));
+    QVERIFY(_writeLog(logFileName, bytes));
+
+    TlogIndex   index;
+    QString     errorString;
+    QVERIFY(index.build(logFileName, errorString));
+    QCOMPARE(index.recordCount(),   static_cast<quint64>(2));
+    QCOMPARE(index.endTimeUSecs(),  _startTimeUSecs + (3 * _recordSpacingUSecs));
+    QCOMPARE(index.entries().count(), 2);
+    QCOMPARE(index.entries()[1].offset, lastOffset);
+
+    // Nothing but junk
+    QVERIFY(_writeLog(logFileName, QByteArray(1000, '\x55')));
+    QVERIFY(!index.build(logFileName, errorString));
+    QVERIFY(!errorString.isEmpty());
+}
+
+void TlogIndexTest::_cacheTest(void)
+{
+    QTemporaryDir   tempDir;
+    QString         logFileName = tempDir.filePath(QStringLiteral("cache.tlog"));
+    QByteArray      bytes;
+
+    for (int i=0; i<50; i++) {
+        bytes.append(_record(_startTimeUSecs + (i * _recordSpacingUSecs)));
+    }
+    QVERIFY(_writeLog(logFileName, bytes));
+
+    TlogIndex   built;
+    QString     errorString;
+    QVERIFY(!built.load(logFileName));
+    QVERIFY(built.loadOrBuild(logFileName, errorString));
+    QVERIFY(QFile::exists(TlogIndex::cacheFileName(logFileName)));
+
+    TlogIndex loaded;
+    QVERIFY(loaded.load(logFileName));
+    QCOMPARE(loaded.recordCount(),      built.recordCount());
+    QCOMPARE(loaded.startTimeUSecs(),   built.startTimeUSecs());
+    QCOMPARE(loaded.endTimeUSecs(),     built.endTimeUSecs());
+    QCOMPARE(loaded.entries().count(),  built.entries().count());
+    for (int i=0; i<built.entries().count(); i++) {
+        QCOMPARE(loaded.entries()[i].offset,    built.entries()[i].offset);
+        QCOMPARE(loaded.entries()[i].timeUSecs, built.entries()[i].timeUSecs);
+    }
+
+    // A log which changed since the cache was saved is indexed again
+    QVERIFY(_writeLog(logFileName, _record(_startTimeUSecs + (50 * _recordSpacingUSecs)), true /* append */));
+    QVERIFY(!loaded.load(logFileName));
+    QVERIFY(loaded.loadOrBuild(logFileName, errorString));
+    QCOMPARE(loaded.recordCount(), static_cast<quint64>(51));
+    QVERIFY(loaded.load(logFileName));
+}
@@ -0,0 +1,32 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "QGCMAVLink.h"
+
+class TlogIndexTest : public UnitTest
+{
+    Q_OBJECT
+
+protected:
+    void init(void) final;
+
+private slots:
+    void _buildTest     (void);
+    void _resyncTest    (void);
+    void _cacheTest     (void);
+
+private:
+    QByteArray  _record     (quint64 timeUSecs);
+    bool        _writeLog   (const QString& fileName, const QByteArray& bytes, bool append = false);
+
+    static const uint8_t _channel = 0;
+};
@@ -22,6 +22,14 @@
 #include "QGCApplication.h"
 #include "SettingsManager.h"
 #include "AutoConnectSettings.h"
+#include "MAVLinkFramer.h"
+
+#if defined(QGC_UDP_BATCH_IO)
+#include <QSocketNotifier>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <string.h>
+#endif
 
 static const char* kZeroconfRegistration = "_qgroundcontrol._udp";
 
@@ -94,6 +102,9 @@ UDPLink::~UDPLink()
     // Clear client list
     qDeleteAll(_sessionTargets);
     _sessionTargets.clear();
+    _sessionTargetEndpoints.clear();
+    _sysidTargets.clear();
+    _sessions.clear();
     quit();
     // Wait for it to exit
     wait();
@@ -146,20 +157,69 @@ void UDPLink::_writeBytes(const QByteArray data)
 
     QMutexLocker locker(&_sessionTargetsMutex);
 
-    // Send to all manually targeted systems
-    for (int i=0; i<_udpConfig->targetHosts().count(); i++) {
-        UDPCLient* target = _udpConfig->targetHosts()[i];
-        // Skip it if it's part of the session clients below
-        if(!contains_target(_sessionTargets, target->address, target->port)) {
-            _writeDataGram(data, target);
+    QList<const UDPCLient*> targets;
+    const UDPCLient*        routedTarget;
+    if (_routedTarget(data, routedTarget)) {
+        // Only the session the target vehicle talks through gets the message
+        targets.append(routedTarget);
+    } else {
+        // Send to all manually targeted systems
+        for (const UDPCLient* target: _udpConfig->targetHosts()) {
+            // Skip it if it's part of the session clients below
+            if (!_sessionTargetEndpoints.contains(Endpoint_t(target->address, target->port))) {
+                targets.append(target);
+            }
+        }
+        // Send to all connected systems
+        for (const UDPCLient* target: _sessionTargets) {
+            targets.append(target);
         }
     }
-    // Send to all connected systems
-    for(UDPCLient* target: _sessionTargets) {
+
+#if defined(QGC_UDP_BATCH_IO)
+    if (_writeBatch(data, targets)) {
+        return;
+    }
+#endif
+    for (const UDPCLient* target: targets) {
         _writeDataGram(data, target);
     }
 }
 
+/// Finds the session which owns the target system of a message. Must be called with _sessionTargetsMutex locked.
+///     @param data Bytes being written, routing is only done when they are a single message
+///     @param[out] target Session target to send to
+///     @return false: data should go to all targets
+bool UDPLink::_routedTarget(const QByteArray& data, const UDPCLient*& target)
+{
+    // With a single session there is nothing to route
+    if (_sessionTargets.count() < 2) {
+        return false;
+    }
+
+    mavlink_message_t message;
+    if (MAVLinkFramer::decodePacket(reinterpret_cast<const uint8_t*>(data.constData()), data.length(), message) != data.length()) {
+        return false;
+    }
+
+    const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(message.msgid);
+    if (!entry || !(entry->flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_SYSTEM)) {
+        return false;
+    }
+    int targetSystem = static_cast<uint8_t>(_MAV_PAYLOAD(&message)[entry->target_system_ofs]);
+    if (targetSystem == 0) {
+        // Broadcast
+        return false;
+    }
+
+    auto it = _sysidTargets.constFind(targetSystem);
+    if (it == _sysidTargets.constEnd()) {
+        return false;
+    }
+    target = it.value();
+    return true;
+}
+
 void UDPLink::_writeDataGram(const QByteArray data, const UDPCLient* target)
 {
     //qDebug() << "UDP Out" << target->address << target->port;
@@ -168,51 +228,216 @@ void UDPLink::_writeDataGram(const QByteArray data, const UDPCLient* target)
     }
 }
 
+UDPLink::Session_t& UDPLink::_session(const QHostAddress& sender, quint16 senderPort)
+{
+    // Nearly every datagram comes from a sender which is already known, those skip the local address check and the lock
+    Endpoint_t senderEndpoint(sender, senderPort);
+    auto it = _sessions.find(senderEndpoint);
+    if (it != _sessions.end()) {
+        return it.value();
+    }
+
+    // TODO: This doesn't validade the sender. Anything sending UDP packets to this port gets
+    // added to the list and will start receiving datagrams from here. Even a port scanner
+    // would trigger this.
+    // Add host to broadcast list if not yet present, or update its port
+    QHostAddress asender = sender;
+    if(_isIpLocal(sender)) {
+        asender = QHostAddress(QString("127.0.0.1"));
+    }
+    Endpoint_t targetEndpoint(asender, senderPort);
+    QMutexLocker locker(&_sessionTargetsMutex);
+    UDPCLient* target = _sessionTargetEndpoints.value(targetEndpoint, nullptr);
+    if (!target) {
+        qDebug() << "Adding target" << asender << senderPort;
+        target = new UDPCLient(asender, senderPort);
+        _sessionTargets.append(target);
+        _sessionTargetEndpoints[targetEndpoint] = target;
+    }
+
+    Session_t& session = _sessions[senderEndpoint];
+    session.target = target;
+    return session;
+}
+
+/// Hands the complete packets of a datagram over to the link's byte stream. A packet which is cut off at the end of
+/// the datagram is held back until the rest arrives from the same sender, so datagrams from different senders never
+/// interleave within a packet and the parser of the link keeps its framing. Bytes which aren't packets pass through.
+void UDPLink::_datagramReceived(const char* data, int length, const QHostAddress& sender, quint16 senderPort)
+{
+    Session_t& session = _session(sender, senderPort);
+
+    const uint8_t*  bytes;
+    int             size;
+    if (session.pending.isEmpty()) {
+        bytes   = reinterpret_cast<const uint8_t*>(data);
+        size    = length;
+    } else {
+        session.pending.append(data, length);
+        bytes   = reinterpret_cast<const uint8_t*>(session.pending.constData());
+        size    = session.pending.length();
+    }
+
+    int position    = 0;
+    int tail        = size;
+    while (position < size) {
+        if (bytes[position] != MAVLINK_STX && bytes[position] != MAVLINK_STX_MAVLINK1) {
+            position++;
+            continue;
+        }
+        int packetLength = MAVLinkFramer::packetLength(bytes + position, size - position);
+        if (packetLength > 0) {
+            // Remember which session each system talks through, so messages to it can be routed
+            int sysid = bytes[position] == MAVLINK_STX_MAVLINK1 ? bytes[position + 3] : bytes[position + 5];
+            auto it = _sysidTargets.constFind(sysid);
+            if (it == _sysidTargets.constEnd() || it.value() != session.target) {
+                QMutexLocker locker(&_sessionTargetsMutex);
+                _sysidTargets[sysid] = session.target;
+            }
+            position += packetLength;
+        } else if (packetLength == 0) {
+            tail = position;
+            break;
+        } else {
+            position++;
+        }
+    }
+
+    if (tail > 0) {
+        _bytesReceived(reinterpret_cast<const char*>(bytes), tail);
+    }
+    if (tail == size) {
+        session.pending.clear();
+    } else if (session.pending.isEmpty()) {
+        session.pending = QByteArray(data + tail, length - tail);
+    } else {
+        session.pending.remove(0, tail);
+    }
+}
+
 void UDPLink::readBytes()
 {
     if (!_socket) {
         return;
     }
-    QByteArray databuffer;
+#if defined(QGC_UDP_BATCH_IO)
+    if (!_readMessages.empty()) {
+        _readBatches();
+        return;
+    }
+#endif
     while (_socket->hasPendingDatagrams())
     {
-        QByteArray datagram;
-        datagram.resize(_socket->pendingDatagramSize());
+        // The read buffer is reused across datagrams. Received bytes are handed to the receive ring which
+        // coalesces notifications, so there is no need to batch datagrams up here.
+        qint64 datagramSize = _socket->pendingDatagramSize();
+        if (_readBuffer.size() < datagramSize) {
+            _readBuffer.resize(static_cast<int>(datagramSize));
+        }
         QHostAddress sender;
         quint16 senderPort;
         // If the other end is reset then it will still report data available,
         // but will fail on the readDatagram call
-        qint64 slen = _socket->readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
+        qint64 slen = _socket->readDatagram(_readBuffer.data(), _readBuffer.size(), &sender, &senderPort);
         if (slen == -1) {
             break;
         }
-        databuffer.append(datagram);
-        //-- Wait a bit before sending it over
-        if (databuffer.size() > 10 * 1024) {
-            emit bytesReceived(this, databuffer);
-            databuffer.clear();
+        _datagramReceived(_readBuffer.constData(), static_cast<int>(slen), sender, senderPort);
+    }
+}
+
+#if defined(QGC_UDP_BATCH_IO)
+/// Reads all pending datagrams from the socket, up to _batchSize with each system call
+void UDPLink::_readBatches(void)
+{
+    const int fd = static_cast<int>(_socket->socketDescriptor());
+
+    while (true) {
+        for (int i=0; i<_batchSize; i++) {
+            _readMessages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            _readMessages[i].msg_len = 0;
         }
-        // TODO: This doesn't validade the sender. Anything sending UDP packets to this port gets
-        // added to the list and will start receiving datagrams from here. Even a port scanner
-        // would trigger this.
-        // Add host to broadcast list if not yet present, or update its port
-        QHostAddress asender = sender;
-        if(_isIpLocal(sender)) {
-            asender = QHostAddress(QString("127.0.0.1"));
+
+        int count = ::recvmmsg(fd, _readMessages.data(), _batchSize, MSG_DONTWAIT, nullptr);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // EAGAIN is the normal end of the pending datagrams. Anything else, for example ECONNREFUSED after an
+            // ICMP port unreachable, is reported by the next read as well so it is not worth a warning per read.
+            break;
         }
-        QMutexLocker locker(&_sessionTargetsMutex);
-        if (!contains_target(_sessionTargets, asender, senderPort)) {
-            qDebug() << "Adding target" << asender << senderPort;
-            UDPCLient* target = new UDPCLient(asender, senderPort);
-            _sessionTargets.append(target);
+
+        for (int i=0; i<count; i++) {
+            const mmsghdr& message = _readMessages[i];
+            if (message.msg_hdr.msg_flags & MSG_TRUNC) {
+                qWarning() << "UDP datagram truncated to" << message.msg_len << "bytes";
+            }
+            _datagramReceived(_readBuffer.constData() + i * _maxDatagramSize, static_cast<int>(message.msg_len),
+                              QHostAddress(reinterpret_cast<const sockaddr*>(&_readAddresses[i])), ntohs(_readAddresses[i].sin_port));
+        }
+
+        if (count < _batchSize) {
+            break;
         }
-        locker.unlock();
     }
-    //-- Send whatever is left
-    if (databuffer.size()) {
-        emit bytesReceived(this, databuffer);
+}
+
+/// Sends data to all of the targets with as few sendmmsg calls as possible
+///     @return false: targets include addresses which must be written through the socket instead
+bool UDPLink::_writeBatch(const QByteArray& data, const QList<const UDPCLient*>& targets)
+{
+    // The socket is bound to any IPv4 address, anything else goes through QUdpSocket to report the error
+    for (const UDPCLient* target: targets) {
+        if (target->address.protocol() != QAbstractSocket::IPv4Protocol) {
+            return false;
+        }
     }
+
+    const int count = targets.count();
+    if (static_cast<int>(_writeMessages.size()) < count) {
+        _writeMessages.resize(count);
+        _writeAddresses.resize(count);
+    }
+
+    // All of the messages send the same bytes
+    iovec vector;
+    vector.iov_base = const_cast<char*>(data.constData());
+    vector.iov_len  = static_cast<size_t>(data.size());
+
+    for (int i=0; i<count; i++) {
+        sockaddr_in& address = _writeAddresses[i];
+        memset(&address, 0, sizeof(address));
+        address.sin_family      = AF_INET;
+        address.sin_port        = htons(targets[i]->port);
+        address.sin_addr.s_addr = htonl(targets[i]->address.toIPv4Address());
+
+        mmsghdr& message = _writeMessages[i];
+        memset(&message, 0, sizeof(message));
+        message.msg_hdr.msg_name    = &address;
+        message.msg_hdr.msg_namelen = sizeof(address);
+        message.msg_hdr.msg_iov     = &vector;
+        message.msg_hdr.msg_iovlen  = 1;
+    }
+
+    const int fd = static_cast<int>(_socket->socketDescriptor());
+    int sent = 0;
+    while (sent < count) {
+        int result = ::sendmmsg(fd, &_writeMessages[sent], static_cast<unsigned int>(count - sent < _batchSize ? count - sent : _batchSize), 0);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // Same as a failed writeDatagram, the target is skipped and the others still get the data
+            qWarning() << "Error writing to" << targets[sent]->address << targets[sent]->port << strerror(errno);
+            result = 1;
+        }
+        sent += result;
+    }
+
+    return true;
 }
+#endif
 
 void UDPLink::disconnect(void)
 {
@@ -263,7 +488,31 @@ bool UDPLink::_hardwareConnect()
         _socket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 512 * 1024);
 #endif
         _registerZeroconf(_udpConfig->localPort(), kZeroconfRegistration);
+#if defined(QGC_UDP_BATCH_IO)
+        // QUdpSocket stops notifying until readDatagram is called, so batched reads use their own notifier
+        if (_readMessages.empty()) {
+            _readBuffer.resize(_batchSize * _maxDatagramSize);
+            _readMessages.resize(_batchSize);
+            _readVectors.resize(_batchSize);
+            _readAddresses.resize(_batchSize);
+            for (int i=0; i<_batchSize; i++) {
+                _readVectors[i].iov_base    = _readBuffer.data() + i * _maxDatagramSize;
+                _readVectors[i].iov_len     = _maxDatagramSize;
+
+                mmsghdr& message = _readMessages[i];
+                memset(&message, 0, sizeof(message));
+                message.msg_hdr.msg_name    = &_readAddresses[i];
+                message.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+                message.msg_hdr.msg_iov     = &_readVectors[i];
+                message.msg_hdr.msg_iovlen  = 1;
+            }
+        }
+        QSocketNotifier* readNotifier = new QSocketNotifier(_socket->socketDescriptor(), QSocketNotifier::Read, _socket);
+        // activated is overloaded from Qt 5.15 on, activated(int) exists in all versions
+        QObject::connect(readNotifier, SIGNAL(activated(int)), this, SLOT(readBytes()));
+#else
         QObject::connect(_socket, &QUdpSocket::readyRead, this, &UDPLink::readBytes);
+#endif
         emit connected();
     } else {
         emit communicationError(tr("UDP Link Error"), tr("Error binding UDP port: %1").arg(_socket->errorString()));
@@ -17,6 +17,17 @@
 #include <QMutex>
 #include <QQueue>
 #include <QByteArray>
+#include <QHash>
+#include <QPair>
+
+// Datagrams are read and written in batches with recvmmsg/sendmmsg where they are available. macOS has neither
+// in its public API and older Android API levels lack them, those use QUdpSocket one datagram at a time.
+#if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
+#define QGC_UDP_BATCH_IO
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <vector>
+#endif
 
 #if defined(QGC_ZEROCONF_ENABLED)
 #include <dns_sd.h>
@@ -115,23 +126,52 @@ private slots:
     void _writeBytes(const QByteArray data) override;
 
 private:
-
     // LinkInterface overrides
-    bool _connect(void) override;
+    bool _connect               (void) override;
+    bool _sendQueueKeepsPackets (void) const override { return true; }
 
     bool _isIpLocal         (const QHostAddress& add);
     bool _hardwareConnect   (void);
     void _registerZeroconf  (uint16_t port, const std::string& regType);
     void _deregisterZeroconf(void);
     void _writeDataGram     (const QByteArray data, const UDPCLient* target);
+    void _datagramReceived  (const char* data, int length, const QHostAddress& sender, quint16 senderPort);
+    bool _routedTarget      (const QByteArray& data, const UDPCLient*& target);
+#if defined(QGC_UDP_BATCH_IO)
+    void _readBatches       (void);
+    bool _writeBatch        (const QByteArray& data, const QList<const UDPCLient*>& targets);
+#endif
+
+    typedef QPair<QHostAddress, quint16> Endpoint_t;
+
+    /// Remote endpoint which sent datagrams to the link. Only used from the link thread.
+    typedef struct {
+        UDPCLient*  target;     ///< Entry in _sessionTargets replies go to
+        QByteArray  pending;    ///< Start of a packet split across datagrams, completed by the next datagram of this session
+    } Session_t;
+
+    Session_t&  _session(const QHostAddress& sender, quint16 senderPort);
 
     bool                _running;
     QUdpSocket*         _socket;
     UDPConfiguration*   _udpConfig;
     bool                _connectState;
     QList<UDPCLient*>   _sessionTargets;
-    QMutex              _sessionTargetsMutex;
+    QHash<Endpoint_t, UDPCLient*>   _sessionTargetEndpoints;    ///< Same targets as _sessionTargets for hashed lookup
+    QHash<int, UDPCLient*>          _sysidTargets;              ///< Session target each vehicle system id was last received from
+    QMutex                          _sessionTargetsMutex;       ///< Protects the above for writes from other threads
+    QHash<Endpoint_t, Session_t>    _sessions;                  ///< Sender address and port to its session
     QList<QHostAddress> _localAddresses;
+    QByteArray          _readBuffer;                ///< Reused across datagrams to prevent an allocation per read
+#if defined(QGC_UDP_BATCH_IO)
+    static const int    _batchSize          = 16;       ///< Datagrams per recvmmsg/sendmmsg call
+    static const int    _maxDatagramSize    = 65536;    ///< Read slot size, large enough for any UDP payload
+    std::vector<mmsghdr>        _readMessages;
+    std::vector<iovec>          _readVectors;
+    std::vector<sockaddr_in>    _readAddresses;
+    std::vector<mmsghdr>        _writeMessages;         ///< Reused by each write
+    std::vector<sockaddr_in>    _writeAddresses;
+#endif
 #if defined(QGC_ZEROCONF_ENABLED)
     DNSServiceRef       _dnssServiceRef;
 #endif
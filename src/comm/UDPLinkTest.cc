@@ -0,0 +1,173 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "UDPLinkTest.h"
+#include "UDPLink.h"
+#include "LinkManager.h"
+#include "MAVLinkProtocol.h"
+#include "QGCApplication.h"
+
+#include <QUdpSocket>
+
+static quint16 _freePort(void)
+{
+    QUdpSocket portSocket;
+    portSocket.bind(QHostAddress::LocalHost, 0);
+    return portSocket.localPort();
+}
+
+static QByteArray _packet(const mavlink_message_t& message)
+{
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    int     length = mavlink_msg_to_send_buffer(buffer, &message);
+    return QByteArray(reinterpret_cast<const char*>(buffer), length);
+}
+
+static QByteArray _attitudePacket(uint8_t sysid)
+{
+    mavlink_message_t message;
+    mavlink_msg_attitude_pack(sysid, MAV_COMP_ID_AUTOPILOT1, &message, 0, 0, 0, 0, 0, 0, 0);
+    return _packet(message);
+}
+
+static QByteArray _commandPacket(uint8_t targetSystem)
+{
+    mavlink_message_t message;
+    mavlink_msg_command_long_pack(255, MAV_COMP_ID_MISSIONPLANNER, &message, targetSystem, MAV_COMP_ID_AUTOPILOT1, MAV_CMD_REQUEST_MESSAGE, 0, 0, 0, 0, 0, 0, 0, 0);
+    return _packet(message);
+}
+
+void UDPLinkTest::_sessionTargetsTest(void)
+{
+    // More senders than a single batched read or write handles
+    const int           senderCount = 20;
+    const QByteArray    sentBytes("UDPLinkTest");
+    const quint16       linkPort    = _freePort();
+
+    QList<QUdpSocket*> senders;
+    for (int i=0; i<senderCount; i++) {
+        QUdpSocket* sender = new QUdpSocket(this);
+        QVERIFY(sender->bind(QHostAddress::LocalHost, 0));
+        senders.append(sender);
+    }
+
+    UDPConfiguration* udpConfig = new UDPConfiguration(QStringLiteral("UDPLinkTest"));
+    udpConfig->setDynamic(true);
+    udpConfig->setLocalPort(linkPort);
+    // A configured target which also shows up as a sender must only get the bytes once
+    udpConfig->addHost(QStringLiteral("127.0.0.1"), senders[0]->localPort());
+    SharedLinkConfigurationPtr config(udpConfig);
+
+    QVERIFY(_linkManager->createConnectedLink(config));
+    SharedLinkInterfacePtr link = _linkManager->sharedLinkInterfacePointerForLink(config->link());
+    QVERIFY(link);
+    QTRY_VERIFY(link->isConnected());
+
+    for (QUdpSocket* sender: senders) {
+        QVERIFY(sender->writeDatagram(QByteArray(1, '\0'), QHostAddress::LocalHost, linkPort) > 0);
+    }
+    // Senders are added to the session targets on the link thread
+    QTest::qWait(500);
+
+    link->writeBytesThreadSafe(sentBytes);
+
+    for (QUdpSocket* sender: senders) {
+        QTRY_VERIFY(sender->hasPendingDatagrams());
+        QByteArray datagram(static_cast<int>(sender->pendingDatagramSize()), '\0');
+        QCOMPARE(sender->readDatagram(datagram.data(), datagram.size()), static_cast<qint64>(sentBytes.size()));
+        QCOMPARE(datagram, sentBytes);
+    }
+
+    QTest::qWait(200);
+    for (QUdpSocket* sender: senders) {
+        QVERIFY(!sender->hasPendingDatagrams());
+    }
+
+    link->disconnect();
+    qDeleteAll(senders);
+}
+
+void UDPLinkTest::_splitPacketTest(void)
+{
+    // A packet split across two datagrams must survive a datagram from another sender arriving in between
+    const quint16 linkPort = _freePort();
+
+    QUdpSocket sender1;
+    QUdpSocket sender2;
+    QVERIFY(sender1.bind(QHostAddress::LocalHost, 0));
+    QVERIFY(sender2.bind(QHostAddress::LocalHost, 0));
+
+    UDPConfiguration* udpConfig = new UDPConfiguration(QStringLiteral("UDPLinkTest"));
+    udpConfig->setDynamic(true);
+    udpConfig->setLocalPort(linkPort);
+    SharedLinkConfigurationPtr config(udpConfig);
+
+    QVERIFY(_linkManager->createConnectedLink(config));
+    SharedLinkInterfacePtr link = _linkManager->sharedLinkInterfacePointerForLink(config->link());
+    QVERIFY(link);
+    QTRY_VERIFY(link->isConnected());
+
+    QList<int> sysids;
+    QMetaObject::Connection connection = connect(qgcApp()->toolbox()->mavlinkProtocol(), &MAVLinkProtocol::messageReceived, this,
+                                                 [&sysids](LinkInterface*, const mavlink_message_t& message) { sysids.append(message.sysid); });
+
+    QByteArray packet1 = _attitudePacket(1);
+    QByteArray packet2 = _attitudePacket(2);
+    int        split   = packet1.length() / 2;
+
+    QVERIFY(sender1.writeDatagram(packet1.left(split), QHostAddress::LocalHost, linkPort) > 0);
+    QTest::qWait(100);
+    QVERIFY(sender2.writeDatagram(packet2, QHostAddress::LocalHost, linkPort) > 0);
+    QTest::qWait(100);
+    QVERIFY(sender1.writeDatagram(packet1.mid(split), QHostAddress::LocalHost, linkPort) > 0);
+
+    QTRY_COMPARE(sysids.count(), 2);
+    QVERIFY(sysids.contains(1));
+    QVERIFY(sysids.contains(2));
+    disconnect(connection);
+
+    link->disconnect();
+}
+
+void UDPLinkTest::_routingTest(void)
+{
+    // Messages to a system only go to the session it talks through, broadcasts go to all
+    const quint16 linkPort = _freePort();
+
+    QUdpSocket sender1;
+    QUdpSocket sender2;
+    QVERIFY(sender1.bind(QHostAddress::LocalHost, 0));
+    QVERIFY(sender2.bind(QHostAddress::LocalHost, 0));
+
+    UDPConfiguration* udpConfig = new UDPConfiguration(QStringLiteral("UDPLinkTest"));
+    udpConfig->setDynamic(true);
+    udpConfig->setLocalPort(linkPort);
+    SharedLinkConfigurationPtr config(udpConfig);
+
+    QVERIFY(_linkManager->createConnectedLink(config));
+    SharedLinkInterfacePtr link = _linkManager->sharedLinkInterfacePointerForLink(config->link());
+    QVERIFY(link);
+    QTRY_VERIFY(link->isConnected());
+
+    QVERIFY(sender1.writeDatagram(_attitudePacket(1), QHostAddress::LocalHost, linkPort) > 0);
+    QVERIFY(sender2.writeDatagram(_attitudePacket(2), QHostAddress::LocalHost, linkPort) > 0);
+    QTest::qWait(500);
+
+    link->writeBytesThreadSafe(_commandPacket(2));
+    QTRY_VERIFY(sender2.hasPendingDatagrams());
+    QTest::qWait(200);
+    QVERIFY(!sender1.hasPendingDatagrams());
+    sender2.receiveDatagram();
+
+    link->writeBytesThreadSafe(_commandPacket(0));
+    QTRY_VERIFY(sender1.hasPendingDatagrams());
+    QTRY_VERIFY(sender2.hasPendingDatagrams());
+
+    link->disconnect();
+}
@@ -17,6 +17,8 @@
 #include <QUdpSocket>
 #include <QtPlugin>
 #include <QStringListModel>
+#include <QDir>
+#include <QThread>
 
 #include "QGC.h"
 #include "QGCApplication.h"
@@ -26,6 +28,7 @@
 #ifndef __mobile__
     #include "QGCSerialPortInfo.h"
     #include "RunGuard.h"
+    #include "TlogAnalyzeRunner.h"
 #ifndef NO_SERIAL_LINK
     #include <QSerialPort>
 #endif
@@ -35,8 +38,9 @@
     #include "UnitTest.h"
 #endif
 
+#include "CmdLineOptParser.h"
+
 #ifdef QT_DEBUG
-    #include "CmdLineOptParser.h"
     #ifdef Q_OS_WIN
         #include <crtdbg.h>
     #endif
@@ -222,9 +226,44 @@ bool checkAndroidWritePermission() {
 
 int main(int argc, char *argv[])
 {
+    bool    analyzeWorker = false;      // Worker process analyzing a single log, see TlogAnalyzeRunner
+    QString analyzeLog;
+    QString analyzeOutput;
+    bool    relay = false;              // Headless MAVLink relay, see QGCApplication::_initForRelay
+
 #ifndef __mobile__
+    // Headless log analysis shows no UI, so neither the runner nor its workers take part in the single instance check
+    bool    analyze             = false;
+    bool    analyzeOutputSet    = false;
+    bool    analyzeJobsSet      = false;
+    QString analyzeLogs;
+    QString analyzeJobs;
+    CmdLineOpt_t rgAnalyzeOptions[] = {
+        { "--analyze",          &analyze,           &analyzeLogs },
+        { "--analyze-log",      &analyzeWorker,     &analyzeLog },
+        { "--analyze-output",   &analyzeOutputSet,  &analyzeOutput },
+        { "--analyze-jobs",     &analyzeJobsSet,    &analyzeJobs },
+        { "--relay",            &relay,             nullptr },
+    };
+
+    ParseCmdLineOptions(argc, argv, rgAnalyzeOptions, sizeof(rgAnalyzeOptions)/sizeof(rgAnalyzeOptions[0]), false);
+    if (!analyzeOutputSet) {
+        analyzeOutput = QDir::currentPath();
+    }
+    if (analyze) {
+        // The runner only starts worker processes, which don't need a QGCApplication
+        QCoreApplication runnerApp(argc, argv);
+        TlogAnalyzeRunner runner(TlogAnalyzeRunner::logFileNames(analyzeLogs), analyzeOutput, analyzeJobsSet ? analyzeJobs.toInt() : QThread::idealThreadCount());
+        return runner.run();
+    }
+    if ((analyzeWorker || relay) && !qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        // Workers and relays never show a window, so they also run where there is no display or GPU
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    // Relays have their own settings space, so several of them can run on one server
     RunGuard guard("QGroundControlRunGuardKey");
-    if (!guard.tryToRun()) {
+    if (!analyzeWorker && !relay && !guard.tryToRun()) {
         // QApplication is necessary to use QMessageBox
         QApplication errorApp(argc, argv);
         QMessageBox::critical(nullptr, QObject::tr("Error"),
@@ -339,7 +378,7 @@ int main(int argc, char *argv[])
 #endif // QT_DEBUG
 
     QCoreApplication::setAttribute(Qt::AA_UseHighDpiPixmaps);
-    QGCApplication* app = new QGCApplication(argc, argv, runUnitTests);
+    QGCApplication* app = new QGCApplication(argc, argv, runUnitTests, analyzeWorker, relay);
     Q_CHECK_PTR(app);
     if(app->isErrorState()) {
         app->exec();
@@ -357,9 +396,12 @@ int main(int argc, char *argv[])
     // on in the code.
     qRegisterMetaType<QList<QPair<QByteArray,QByteArray> > >();
 
-    app->_initCommon();
-    //-- Initialize Cache System
-    getQGCMapEngine()->init();
+    // A relay has no Qml and no maps
+    if (!relay) {
+        app->_initCommon();
+        //-- Initialize Cache System
+        getQGCMapEngine()->init();
+    }
 
     int exitCode = 0;
 
@@ -382,6 +424,16 @@ int main(int argc, char *argv[])
             }
         }
     } else
+#endif
+#ifndef __mobile__
+    if (analyzeWorker) {
+        exitCode = TlogAnalyzeRunner::runWorker(analyzeLog, analyzeOutput);
+    } else if (relay) {
+        if (!app->_initForRelay()) {
+            return -1;
+        }
+        exitCode = app->exec();
+    } else
 #endif
     {
 
@@ -0,0 +1,60 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "BenchmarkResults.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QtTest>
+
+int BenchmarkResults::envInt(const char* name, int defaultValue)
+{
+    bool    ok      = false;
+    int     value   = qEnvironmentVariableIntValue(name, &ok);
+
+    return ok && value > 0 ? value : defaultValue;
+}
+
+int BenchmarkResults::iterations(void)
+{
+    return envInt("QGC_BENCH_ITERATIONS", defaultIterations);
+}
+
+void BenchmarkResults::record(const QObject* benchmark, const QString& metric, double value, const QString& unit)
+{
+    const QString benchmarkName = QString(benchmark->metaObject()->className());
+
+    qDebug() << benchmarkName << QTest::currentTestFunction() << QTest::currentDataTag() << metric << value << unit;
+
+    QString resultsFilename = qEnvironmentVariable("QGC_BENCH_RESULTS");
+    if (resultsFilename.isEmpty()) {
+        return;
+    }
+
+    QJsonObject result;
+    result[QStringLiteral("benchmark")] = benchmarkName;
+    result[QStringLiteral("test")]      = QString(QTest::currentTestFunction());
+    result[QStringLiteral("tag")]       = QString(QTest::currentDataTag());
+    result[QStringLiteral("metric")]    = metric;
+    result[QStringLiteral("value")]     = value;
+    result[QStringLiteral("unit")]      = unit;
+    result[QStringLiteral("version")]   = QCoreApplication::applicationVersion();
+
+    QFile resultsFile(resultsFilename);
+    if (!resultsFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qWarning() << benchmarkName << "unable to open results file" << resultsFilename << resultsFile.errorString();
+        return;
+    }
+    resultsFile.write(QJsonDocument(result).toJson(QJsonDocument::Compact));
+    resultsFile.write("\n");
+}
@@ -0,0 +1,39 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <QString>
+
+class QObject;
+
+/// Environment settings and result output shared by the standalone benchmarks. A benchmark is registered with
+/// UT_REGISTER_TEST_STANDALONE so it only runs when asked for by name:
+///     QGroundControl --unittest:<BenchmarkName>
+///
+/// Every result is logged and, if QGC_BENCH_RESULTS is set, appended to that file as one json object per line:
+///     {"benchmark":"TelemetryBenchmark","test":"_telemetryPipelineBenchmark","tag":"","metric":"usecsPerMessage","value":3.2,"unit":"us","version":"..."}
+///
+/// Configured through the environment:
+///     QGC_BENCH_ITERATIONS    Number of timed repetitions for each case, default 5
+///     QGC_BENCH_RESULTS       File to append json results to, default none
+class BenchmarkResults
+{
+public:
+    /// @return Value of the environment variable, defaultValue if it isn't set or isn't a positive integer
+    static int envInt(const char* name, int defaultValue);
+
+    /// @return QGC_BENCH_ITERATIONS
+    static int iterations(void);
+
+    /// Records the result of the current test function and data tag, under the class name of the benchmark
+    static void record(const QObject* benchmark, const QString& metric, double value, const QString& unit);
+
+    static const int defaultIterations = 5;
+};
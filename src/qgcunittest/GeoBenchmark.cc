@@ -0,0 +1,419 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "GeoBenchmark.h"
+#include "BenchmarkResults.h"
+#include "QGCGeo.h"
+#include "TerrainTile.h"
+#include "TerrainQuery.h"
+#include "QGCMapPolygon.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QtMath>
+
+const QGeoCoordinate GeoBenchmark::_origin(47.3769, 8.549444);
+
+GeoBenchmark::GeoBenchmark(void)
+{
+
+}
+
+/// Points spread evenly around _origin, the same ones on every run so results can be compared
+void GeoBenchmark::_randomPoints(int count, double radiusDegrees, QVector<double>& latitudes, QVector<double>& longitudes)
+{
+    QRandomGenerator random(1234);
+
+    latitudes.resize(count);
+    longitudes.resize(count);
+    for (int i=0; i<count; i++) {
+        latitudes[i]    = _origin.latitude()  + (random.bounded(2.0) - 1.0) * radiusDegrees;
+        longitudes[i]   = _origin.longitude() + (random.bounded(2.0) - 1.0) * radiusDegrees;
+    }
+}
+
+/// Tile of the full size the terrain servers hand out, with hills so neighbouring values differ
+QByteArray GeoBenchmark::_fullTileBytes(void)
+{
+    const int       gridSize    = qRound(TerrainTile::tileSizeDegrees / TerrainTile::tileValueSpacingDegrees) + 1;
+    const double    swLat       = qFloor(_origin.latitude()  / TerrainTile::tileSizeDegrees) * TerrainTile::tileSizeDegrees;
+    const double    swLon       = qFloor(_origin.longitude() / TerrainTile::tileSizeDegrees) * TerrainTile::tileSizeDegrees;
+
+    QJsonArray carpet;
+    for (int i=0; i<gridSize; i++) {
+        QJsonArray row;
+        for (int j=0; j<gridSize; j++) {
+            row.append(qRound(400 + 50 * qSin(i / 5.0) * qCos(j / 7.0)));
+        }
+        carpet.append(row);
+    }
+
+    QJsonObject bounds;
+    bounds["sw"] = QJsonArray({ swLat, swLon });
+    bounds["ne"] = QJsonArray({ swLat + ((gridSize - 1) * TerrainTile::tileValueSpacingDegrees), swLon + ((gridSize - 1) * TerrainTile::tileValueSpacingDegrees) });
+
+    QJsonObject stats;
+    stats["min"] = 350;
+    stats["max"] = 450;
+    stats["avg"] = 400.0;
+
+    QJsonObject data;
+    data["bounds"] = bounds;
+    data["stats"]  = stats;
+    data["carpet"] = carpet;
+
+    QJsonObject root;
+    root["status"] = "success";
+    root["data"]   = data;
+
+    return TerrainTile::serializeFromAirMapJson(QJsonDocument(root).toJson());
+}
+
+/// @param concave true: alternate vertices are pulled in to form a star
+QList<QGeoCoordinate> GeoBenchmark::_polygonVertices(int vertexCount, bool concave)
+{
+    QList<QGeoCoordinate> vertices;
+    for (int i=0; i<vertexCount; i++) {
+        double vertexRadius = concave && (i % 2) ? 1200 : 2000;
+        vertices.append(_origin.atDistanceAndAzimuth(vertexRadius, 360.0 * i / vertexCount));
+    }
+    return vertices;
+}
+
+void GeoBenchmark::_nedBenchmark_data(void)
+{
+    QTest::addColumn<int>("pointCount");
+
+    QTest::newRow("1000Points")     << 1000;
+    QTest::newRow("100000Points")   << 100000;
+}
+
+void GeoBenchmark::_nedBenchmark(void)
+{
+    QFETCH(int, pointCount);
+
+    QVector<double> latitudes;
+    QVector<double> longitudes;
+    _randomPoints(pointCount, 0.1, latitudes, longitudes);
+
+    QVector<double> north           (pointCount);
+    QVector<double> east            (pointCount);
+    QVector<double> latitudesBack   (pointCount);
+    QVector<double> longitudesBack  (pointCount);
+    int             iterations      = BenchmarkResults::iterations();
+    qint64          scalarToNedNSecs    = 0;
+    qint64          scalarToGeoNSecs    = 0;
+    qint64          batchToNedNSecs     = 0;
+    qint64          batchToGeoNSecs     = 0;
+    QElapsedTimer   timer;
+    for (int i=0; i<iterations; i++) {
+        timer.start();
+        for (int j=0; j<pointCount; j++) {
+            double down;
+            convertGeoToNed(QGeoCoordinate(latitudes[j], longitudes[j]), _origin, &north[j], &east[j], &down);
+        }
+        scalarToNedNSecs += timer.nsecsElapsed();
+
+        timer.start();
+        for (int j=0; j<pointCount; j++) {
+            QGeoCoordinate coord;
+            convertNedToGeo(north[j], east[j], 0, _origin, &coord);
+            latitudesBack[j]    = coord.latitude();
+            longitudesBack[j]   = coord.longitude();
+        }
+        scalarToGeoNSecs += timer.nsecsElapsed();
+
+        timer.start();
+        convertGeoToNed(latitudes.constData(), longitudes.constData(), pointCount, _origin, north.data(), east.data());
+        batchToNedNSecs += timer.nsecsElapsed();
+
+        timer.start();
+        convertNedToGeo(north.constData(), east.constData(), pointCount, _origin, latitudesBack.data(), longitudesBack.data());
+        batchToGeoNSecs += timer.nsecsElapsed();
+    }
+
+    // Round trip lands within a millimeter, which also keeps the work from being optimized away
+    for (int j=0; j<pointCount; j+=pointCount/10) {
+        QVERIFY(QGeoCoordinate(latitudes[j], longitudes[j]).distanceTo(QGeoCoordinate(latitudesBack[j], longitudesBack[j])) < 0.001);
+    }
+
+    double points = static_cast<double>(pointCount) * iterations;
+    BenchmarkResults::record(this, QStringLiteral("nsecsPerPointToNed"),         scalarToNedNSecs / points,  QStringLiteral("ns"));
+    BenchmarkResults::record(this, QStringLiteral("nsecsPerPointToGeo"),         scalarToGeoNSecs / points,  QStringLiteral("ns"));
+    BenchmarkResults::record(this, QStringLiteral("nsecsPerPointToNedBatch"),    batchToNedNSecs / points,   QStringLiteral("ns"));
+    BenchmarkResults::record(this, QStringLiteral("nsecsPerPointToGeoBatch"),    batchToGeoNSecs / points,   QStringLiteral("ns"));
+}
+
+void GeoBenchmark::_utmBenchmark_data(void)
+{
+    QTest::addColumn<int>("pointCount");
+
+    QTest::newRow("1000Points")     << 1000;
+    QTest::newRow("100000Points")   << 100000;
+}
+
+void GeoBenchmark::_utmBenchmark(void)
+{
+    QFETCH(int, pointCount);
+
+    QVector<double> latitudes;
+    QVector<double> longitudes;
+    _randomPoints(pointCount, 0.1, latitudes, longitudes);
+
+    QVector<double> eastings        (pointCount);
+    QVector<double> northings       (pointCount);
+    QVector<double> latitudesBack   (pointCount);
+    QVector<double> longitudesBack  (pointCount);
+    int             zone            = 0;
+    int             iterations      = BenchmarkResults::iterations();
+    qint64          scalarToUTMNSecs    = 0;
+    qint64          scalarToGeoNSecs    = 0;
+    qint64          batchToUTMNSecs     = 0;
+    qint64          batchToGeoNSecs     = 0;
+    QElapsedTimer   timer;
+    for (int i=0; i<iterations; i++) {
+        timer.start();
+        for (int j=0; j<pointCount; j++) {
+            zone = convertGeoToUTM(QGeoCoordinate(latitudes[j], longitudes[j]), eastings[j], northings[j]);
+        }
+        scalarToUTMNSecs += timer.nsecsElapsed();
+
+        timer.start();
+        for (int j=0; j<pointCount; j++) {
+            QGeoCoordinate coord;
+            convertUTMToGeo(eastings[j], northings[j], zone, false /* southhemi */, coord);
+            latitudesBack[j]    = coord.latitude();
+            longitudesBack[j]   = coord.longitude();
+        }
+        scalarToGeoNSecs += timer.nsecsElapsed();
+
+        timer.start();
+        zone = convertGeoToUTM(latitudes.constData(), longitudes.constData(), pointCount, eastings.data(), northings.data());
+        batchToUTMNSecs += timer.nsecsElapsed();
+
+        timer.start();
+        QVERIFY(convertUTMToGeo(eastings.constData(), northings.constData(), pointCount, zone, false /* southhemi */, latitudesBack.data(), longitudesBack.data()));
+        batchToGeoNSecs += timer.nsecsElapsed();
+    }
+
+    QCOMPARE(zone, 32);
+    for (int j=0; j<pointCount; j+=pointCount/10) {
+        QVERIFY(QGeoCoordinate(latitudes[j], longitudes[j]).distanceTo(QGeoCoordinate(latitudesBack[j], longitudesBack[j])) < 0.001);
+    }
+
+    double points = static_cast<double>(pointCount) * iterations;
+    BenchmarkResults::record(this, QStringLiteral("nsecsPerPointToUTM"),         scalarToUTMNSecs / points,  QStringLiteral("ns"));
+    BenchmarkResults::record(this, QStringLiteral("nsecsPerPointToGeo"),         scalarToGeoNSecs / points,  QStringLiteral("ns"));
+    BenchmarkResults::record(this, QStringLiteral("nsecsPerPointToUTMBatch"),    batchToUTMNSecs / points,   QStringLiteral("ns"));
+    BenchmarkResults::record(this, QStringLiteral("nsecsPerPointToGeoBatch"),    batchToGeoNSecs / points,   QStringLiteral("ns"));
+}
+
+void GeoBenchmark::_mgrsBenchmark_data(void)
+{
+    QTest::addColumn<int>("pointCount");
+
+    QTest::newRow("1000Points")     << 1000;
+    QTest::newRow("10000Points")    << 10000;
+}
+
+void GeoBenchmark::_mgrsBenchmark(void)
+{
+    QFETCH(int, pointCount);
+
+    QVector<double> latitudes;
+    QVector<double> longitudes;
+    _randomPoints(pointCount, 0.1, latitudes, longitudes);
+
+    QStringList     mgrs;
+    QGeoCoordinate  coordBack;
+    int             iterations      = BenchmarkResults::iterations();
+    qint64          toMGRSNSecs     = 0;
+    qint64          toGeoNSecs      = 0;
+    QElapsedTimer   timer;
+    for (int i=0; i<iterations; i++) {
+        mgrs.clear();
+        timer.start();
+        for (int j=0; j<pointCount; j++) {
+            mgrs.append(convertGeoToMGRS(QGeoCoordinate(latitudes[j], longitudes[j])));
+        }
+        toMGRSNSecs += timer.nsecsElapsed();
+
+        timer.start();
+        for (int j=0; j<pointCount; j++) {
+            QVERIFY(convertMGRSToGeo(mgrs[j], coordBack));
+        }
+        toGeoNSecs += timer.nsecsElapsed();
+    }
+
+    // MGRS strings have a resolution of a meter
+    QVERIFY(QGeoCoordinate(latitudes.last(), longitudes.last()).distanceTo(coordBack) < 2);
+
+    double points = static_cast<double>(pointCount) * iterations;
+    BenchmarkResults::record(this, QStringLiteral("nsecsPerPointToMGRS"),    toMGRSNSecs / points,   QStringLiteral("ns"));
+    BenchmarkResults::record(this, QStringLiteral("nsecsPerPointToGeo"),     toGeoNSecs / points,    QStringLiteral("ns"));
+}
+
+void GeoBenchmark::_terrainTileBenchmark_data(void)
+{
+    QTest::addColumn<int>("pointCount");
+
+    QTest::newRow("1000Points")     << 1000;
+    QTest::newRow("100000Points")   << 100000;
+}
+
+void GeoBenchmark::_terrainTileBenchmark(void)
+{
+    QFETCH(int, pointCount);
+
+    TerrainTile tile(_fullTileBytes());
+    QVERIFY(tile.isValid());
+
+    // Spread over the tile and a little beyond it, where the values are clamped to the edges
+    QVector<double> latitudes;
+    QVector<double> longitudes;
+    _randomPoints(pointCount, TerrainTile::tileSizeDegrees, latitudes, longitudes);
+
+    QVector<double> heights         (pointCount);
+    QVector<double> batchHeights    (pointCount);
+    int             iterations      = BenchmarkResults::iterations();
+    qint64          scalarNSecs     = 0;
+    qint64          batchNSecs      = 0;
+    QElapsedTimer   timer;
+    for (int i=0; i<iterations; i++) {
+        timer.start();
+        for (int j=0; j<pointCount; j++) {
+            heights[j] = tile.elevation(QGeoCoordinate(latitudes[j], longitudes[j]));
+        }
+        scalarNSecs += timer.nsecsElapsed();
+
+        timer.start();
+        tile.elevations(latitudes.constData(), longitudes.constData(), batchHeights.data(), pointCount);
+        batchNSecs += timer.nsecsElapsed();
+    }
+
+    for (int j=0; j<pointCount; j+=pointCount/10) {
+        QCOMPARE(batchHeights[j], heights[j]);
+    }
+
+    double points = static_cast<double>(pointCount) * iterations;
+    BenchmarkResults::record(this, QStringLiteral("nsecsPerPoint"),      scalarNSecs / points,   QStringLiteral("ns"));
+    BenchmarkResults::record(this, QStringLiteral("nsecsPerPointBatch"), batchNSecs / points,    QStringLiteral("ns"));
+}
+
+void GeoBenchmark::_pathQueryToCoordsBenchmark_data(void)
+{
+    QTest::addColumn<double>("pathMeters");
+
+    QTest::newRow("1km")    << 1000.0;
+    QTest::newRow("10km")   << 10000.0;
+    QTest::newRow("100km")  << 100000.0;
+}
+
+void GeoBenchmark::_pathQueryToCoordsBenchmark(void)
+{
+    QFETCH(double, pathMeters);
+
+    QGeoCoordinate          toCoord     = _origin.atDistanceAndAzimuth(pathMeters, 60);
+    int                     queryCount  = BenchmarkResults::iterations() * 100;
+    QList<QGeoCoordinate>   coords;
+    double                  distanceBetween;
+    double                  finalDistanceBetween;
+    QElapsedTimer           timer;
+    timer.start();
+    for (int i=0; i<queryCount; i++) {
+        coords = TerrainTileManager::pathQueryToCoords(_origin, toCoord, distanceBetween, finalDistanceBetween);
+    }
+    qint64 elapsedNSecs = timer.nsecsElapsed();
+
+    QVERIFY(coords.count() >= 2);
+
+    BenchmarkResults::record(this, QStringLiteral("usecsPerQuery"), elapsedNSecs / 1.0e3 / queryCount, QStringLiteral("us"));
+    BenchmarkResults::record(this, QStringLiteral("coordCount"), coords.count(), QStringLiteral("coords"));
+}
+
+void GeoBenchmark::_polygonContainsBenchmark_data(void)
+{
+    QTest::addColumn<int>("vertexCount");
+    QTest::addColumn<bool>("concave");
+
+    QTest::newRow("convex64")       << 64   << false;
+    QTest::newRow("convex1024")     << 1024 << false;
+    QTest::newRow("concave1024")    << 1024 << true;
+}
+
+void GeoBenchmark::_polygonContainsBenchmark(void)
+{
+    QFETCH(int,     vertexCount);
+    QFETCH(bool,    concave);
+
+    QGCMapPolygon polygon(this);
+    polygon.appendVertices(_polygonVertices(vertexCount, concave));
+
+    // Square around the polygon, so about three quarters of the points are inside
+    const int       pointCount  = 10000;
+    QVector<double> latitudes;
+    QVector<double> longitudes;
+    _randomPoints(pointCount, 0.025, latitudes, longitudes);
+
+    int             iterations      = BenchmarkResults::iterations();
+    int             insideCount     = 0;
+    QElapsedTimer   timer;
+    timer.start();
+    for (int i=0; i<iterations; i++) {
+        insideCount = 0;
+        for (int j=0; j<pointCount; j++) {
+            if (polygon.containsCoordinate(QGeoCoordinate(latitudes[j], longitudes[j]))) {
+                insideCount++;
+            }
+        }
+    }
+    qint64 elapsedNSecs = timer.nsecsElapsed();
+
+    QVERIFY(insideCount > 0);
+    QVERIFY(insideCount < pointCount);
+    QVERIFY(polygon.containsCoordinate(_origin));
+
+    BenchmarkResults::record(this, QStringLiteral("nsecsPerPoint"), elapsedNSecs / (static_cast<double>(pointCount) * iterations), QStringLiteral("ns"));
+    BenchmarkResults::record(this, QStringLiteral("insideCount"), insideCount, QStringLiteral("points"));
+}
+
+void GeoBenchmark::_polygonOffsetBenchmark_data(void)
+{
+    QTest::addColumn<int>("vertexCount");
+    QTest::addColumn<bool>("concave");
+
+    QTest::newRow("convex64")       << 64   << false;
+    QTest::newRow("convex1024")     << 1024 << false;
+    QTest::newRow("concave1024")    << 1024 << true;
+}
+
+void GeoBenchmark::_polygonOffsetBenchmark(void)
+{
+    QFETCH(int,     vertexCount);
+    QFETCH(bool,    concave);
+
+    QGCMapPolygon polygon(this);
+    polygon.appendVertices(_polygonVertices(vertexCount, concave));
+
+    // Grows and shrinks in turn so the polygon stays the same size over the run
+    int             offsetCount = BenchmarkResults::iterations() * 10;
+    QElapsedTimer   timer;
+    timer.start();
+    for (int i=0; i<offsetCount; i++) {
+        polygon.offset(i % 2 ? -10 : 10);
+    }
+    qint64 elapsedNSecs = timer.nsecsElapsed();
+
+    QCOMPARE(polygon.count(), vertexCount);
+
+    BenchmarkResults::record(this, QStringLiteral("usecsPerOffset"), elapsedNSecs / 1.0e3 / offsetCount, QStringLiteral("us"));
+}
@@ -0,0 +1,55 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QGeoCoordinate>
+
+/// Benchmarks for the geo, terrain and polygon kernels, run against generated inputs much larger than GeoTest,
+/// TerrainTileTest and QGCMapPolygonTest use:
+///     - convertGeoToNed/convertNedToGeo, point by point and batched
+///     - convertGeoToUTM/convertUTMToGeo, point by point and batched, and the MGRS conversions
+///     - TerrainTile::elevation and TerrainTile::elevations on a full size tile
+///     - TerrainTileManager::pathQueryToCoords
+///     - QGCMapPolygon::containsCoordinate and QGCMapPolygon::offset, on convex and concave polygons
+/// The survey polygon decomposition is covered by MissionPlanningBenchmark::_surveyRebuildBenchmark.
+///
+/// See BenchmarkResults for how to run it and where results go.
+class GeoBenchmark : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    GeoBenchmark(void);
+
+private slots:
+    void _nedBenchmark_data                 (void);
+    void _nedBenchmark                      (void);
+    void _utmBenchmark_data                 (void);
+    void _utmBenchmark                      (void);
+    void _mgrsBenchmark_data                (void);
+    void _mgrsBenchmark                     (void);
+    void _terrainTileBenchmark_data         (void);
+    void _terrainTileBenchmark              (void);
+    void _pathQueryToCoordsBenchmark_data   (void);
+    void _pathQueryToCoordsBenchmark        (void);
+    void _polygonContainsBenchmark_data     (void);
+    void _polygonContainsBenchmark          (void);
+    void _polygonOffsetBenchmark_data       (void);
+    void _polygonOffsetBenchmark            (void);
+
+private:
+    static void                     _randomPoints   (int count, double radiusDegrees, QVector<double>& latitudes, QVector<double>& longitudes);
+    static QByteArray               _fullTileBytes  (void);
+    static QList<QGeoCoordinate>    _polygonVertices(int vertexCount, bool concave);
+
+    static const QGeoCoordinate _origin;
+};
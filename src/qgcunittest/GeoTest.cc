@@ -16,6 +16,8 @@
 #include "GeoTest.h"
 #include "QGCGeo.h"
 
+#include <QVector>
+
 /*
 GeoTest::GeoTest(void)
 {
@@ -91,3 +93,152 @@ void GeoTest::_convertNedToGeoAtOrigin_test(void)
     QCOMPARE(coord.longitude(), expectedLon);
     QCOMPARE(coord.altitude(), expectedAlt);
 }
+
+void GeoTest::_tangentPlane_test(void)
+{
+    QGCTangentPlane tangentPlane(_origin);
+
+    QList<QGeoCoordinate> coords;
+    coords << _origin << QGeoCoordinate(47.364869, 8.594398, 0.0) << QGeoCoordinate(47.3801, 8.5412, 0.0) << QGeoCoordinate(47.3701, 8.5501, 0.0);
+
+    // The plane must give exactly the same results as the free functions
+    QList<QPointF> points = tangentPlane.geoToEastNorth(coords);
+    QCOMPARE(points.count(), coords.count());
+    for (int i=0; i<coords.count(); i++) {
+        double x, y, z;
+        convertGeoToNed(coords[i], _origin, &x, &y, &z);
+        QCOMPARE(points[i].x(), y);
+        QCOMPARE(points[i].y(), x);
+
+        QGeoCoordinate coord;
+        convertNedToGeo(x, y, 0, _origin, &coord);
+        QGeoCoordinate planeCoord;
+        tangentPlane.nedToGeo(x, y, 0, &planeCoord);
+        QCOMPARE(planeCoord.latitude(), coord.latitude());
+        QCOMPARE(planeCoord.longitude(), coord.longitude());
+    }
+
+    QList<QGeoCoordinate> roundTrip = tangentPlane.eastNorthToGeo(points);
+    QCOMPARE(roundTrip.count(), coords.count());
+    for (int i=0; i<coords.count(); i++) {
+        QCOMPARE(roundTrip[i].latitude(), coords[i].latitude());
+        QCOMPARE(roundTrip[i].longitude(), coords[i].longitude());
+    }
+}
+
+void GeoTest::_batch_test(void)
+{
+    QList<QGeoCoordinate> coords;
+    coords << _origin << QGeoCoordinate(47.364869, 8.594398, 0.0) << QGeoCoordinate(47.3801, 8.5412, 0.0) << QGeoCoordinate(47.3701, 8.5501, 0.0);
+
+    int             count = coords.count();
+    QVector<double> latitudes(count), longitudes(count), north(count), east(count);
+    for (int i=0; i<count; i++) {
+        latitudes[i] = coords[i].latitude();
+        longitudes[i] = coords[i].longitude();
+    }
+
+    // Same results as the single point versions, including the origin without the short circuit
+    convertGeoToNed(latitudes.constData(), longitudes.constData(), count, _origin, north.data(), east.data());
+    for (int i=0; i<count; i++) {
+        double x, y, z;
+        convertGeoToNed(coords[i], _origin, &x, &y, &z);
+        QCOMPARE(north[i], x);
+        QCOMPARE(east[i], y);
+    }
+
+    QVector<double> roundTripLatitudes(count), roundTripLongitudes(count);
+    convertNedToGeo(north.constData(), east.constData(), count, _origin, roundTripLatitudes.data(), roundTripLongitudes.data());
+    for (int i=0; i<count; i++) {
+        QCOMPARE(roundTripLatitudes[i], latitudes[i]);
+        QCOMPARE(roundTripLongitudes[i], longitudes[i]);
+    }
+}
+
+void GeoTest::_batchUTM_test(void)
+{
+    QList<QGeoCoordinate> coords;
+    coords << _origin << QGeoCoordinate(47.364869, 8.594398, 0.0) << QGeoCoordinate(47.3801, 8.5412, 0.0);
+
+    int             count = coords.count();
+    QVector<double> latitudes(count), longitudes(count), eastings(count), northings(count);
+    for (int i=0; i<count; i++) {
+        latitudes[i] = coords[i].latitude();
+        longitudes[i] = coords[i].longitude();
+    }
+
+    int zone = convertGeoToUTM(latitudes.constData(), longitudes.constData(), count, eastings.data(), northings.data());
+    QCOMPARE(zone, 32);
+    for (int i=0; i<count; i++) {
+        double easting, northing;
+        QCOMPARE(convertGeoToUTM(coords[i], easting, northing), zone);
+        QCOMPARE(eastings[i], easting);
+        QCOMPARE(northings[i], northing);
+    }
+
+    QVector<double> roundTripLatitudes(count), roundTripLongitudes(count);
+    QVERIFY(convertUTMToGeo(eastings.constData(), northings.constData(), count, zone, false, roundTripLatitudes.data(), roundTripLongitudes.data()));
+    for (int i=0; i<count; i++) {
+        QVERIFY(qAbs(roundTripLatitudes[i] - latitudes[i]) < 1e-9);
+        QVERIFY(qAbs(roundTripLongitudes[i] - longitudes[i]) < 1e-9);
+    }
+
+    // A point which is out of range for the zone doesn't stop the others
+    eastings[1] = -1e7;
+    QVERIFY(convertUTMToGeo(eastings.constData(), northings.constData(), count, zone, false, roundTripLatitudes.data(), roundTripLongitudes.data()));
+    QVERIFY(qIsNaN(roundTripLatitudes[1]));
+    QVERIFY(!qIsNaN(roundTripLatitudes[2]));
+
+    QVERIFY(!convertUTMToGeo(eastings.constData(), northings.constData(), count, 99, false, roundTripLatitudes.data(), roundTripLongitudes.data()));
+}
+
+void GeoTest::_simplifyPath_test(void)
+{
+    // Straight line with small sideways noise collapses to its end points
+    QList<QGeoCoordinate> path;
+    for (int i=0; i<100; i++) {
+        path.append(_origin.atDistanceAndAzimuth(i * 10.0, 90).atDistanceAndAzimuth(i % 2 ? 0.5 : 0, 0));
+    }
+    QList<QGeoCoordinate> simplifiedPath = simplifyPath(path, 1.0);
+    QCOMPARE(simplifiedPath.count(), 2);
+    QCOMPARE(simplifiedPath.first(), path.first());
+    QCOMPARE(simplifiedPath.last(), path.last());
+
+    // Corners larger than the tolerance are kept
+    path.clear();
+    path << _origin
+         << _origin.atDistanceAndAzimuth(100, 90)
+         << _origin.atDistanceAndAzimuth(100, 90).atDistanceAndAzimuth(50, 0)
+         << _origin.atDistanceAndAzimuth(100, 90).atDistanceAndAzimuth(50, 0).atDistanceAndAzimuth(100, 270);
+    simplifiedPath = simplifyPath(path, 1.0);
+    QCOMPARE(simplifiedPath, path);
+
+    // Nothing to simplify with fewer than three points
+    path.clear();
+    path << _origin << _origin.atDistanceAndAzimuth(100, 90);
+    QCOMPARE(simplifyPath(path, 1000.0), path);
+}
+
+void GeoTest::_simplifyPathToCount_test(void)
+{
+    // Zig zag with shrinking teeth, so the larger teeth are the more significant points
+    QList<QGeoCoordinate> path;
+    for (int i=0; i<50; i++) {
+        path.append(_origin.atDistanceAndAzimuth(i * 10.0, 90).atDistanceAndAzimuth(i % 2 ? 100.0 - i : 0, 0));
+    }
+
+    for (int count: { 2, 3, 10, 25 }) {
+        QList<QGeoCoordinate> simplifiedPath = simplifyPathToCount(path, count);
+        QCOMPARE(simplifiedPath.count(), count);
+        QCOMPARE(simplifiedPath.first(), path.first());
+        QCOMPARE(simplifiedPath.last(), path.last());
+    }
+
+    // Same points as simplifyPath when the tolerance gives the count
+    QList<QGeoCoordinate> simplifiedPath = simplifyPath(path, 60.0);
+    QCOMPARE(simplifyPathToCount(path, simplifiedPath.count()), simplifiedPath);
+
+    // Short enough paths are left alone
+    QCOMPARE(simplifyPathToCount(path, path.count()), path);
+    QCOMPARE(simplifyPathToCount(path, path.count() + 10), path);
+}
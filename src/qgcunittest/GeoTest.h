@@ -33,6 +33,11 @@ private slots:
     void _convertGeoToNedAtOrigin_test(void);
     void _convertNedToGeo_test(void);
     void _convertNedToGeoAtOrigin_test(void);
+    void _tangentPlane_test(void);
+    void _batch_test(void);
+    void _batchUTM_test(void);
+    void _simplifyPath_test(void);
+    void _simplifyPathToCount_test(void);
 private:
     QGeoCoordinate _origin;
 };
@@ -0,0 +1,117 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "LogCompressorTest.h"
+#include "LogCompressor.h"
+
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+/// Writes the log, compresses it and returns the lines of the output
+QStringList LogCompressorTest::_compress(const QString& logFileName, const QByteArray& log, bool holeFilling)
+{
+    QFile logFile(logFileName);
+    if (!logFile.open(QIODevice::WriteOnly) || logFile.write(log) != log.length()) {
+        return QStringList();
+    }
+    logFile.close();
+
+    LogCompressor   compressor(logFileName);
+    QSignalSpy      spy(&compressor, &LogCompressor::finishedFile);
+    compressor.startCompression(holeFilling);
+    if (!compressor.wait(60000) || spy.count() != 1) {
+        return QStringList();
+    }
+
+    QFile outFile(spy[0][0].toString());
+    if (!outFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return QStringList();
+    }
+    QString text = QString::fromLocal8Bit(outFile.readAll());
+    if (text.endsWith('\n')) {
+        text.chop(1);
+    }
+    return text.split('\n');
+}
+
+void LogCompressorTest::_compressTest(void)
+{
+    QTemporaryDir tempDir;
+
+    // Lines out of order within a timestamp, and a short line which is skipped
+    QByteArray log;
+    for (int i=0; i<5; i++) {
+        log += QByteArray::number(100 + i) + "\tuas\tgps.alt\t" + QByteArray::number(i * 10) + "\n";
+        log += QByteArray::number(100 + i) + "\tuas\tatt_roll\t" + QByteArray::number(i) + "\n";
+    }
+    log += "bogus\n";
+
+    QStringList lines = _compress(tempDir.filePath("test.log"), log, false);
+    QCOMPARE(lines.count(), 4);
+    QCOMPARE(lines[0], QStringLiteral("TIMESTAMPms\tattroll\tgpsalt"));
+
+    // The first two rows are dropped as possibly incomplete
+    QCOMPARE(lines[1], QStringLiteral("102\t2\t20"));
+    QCOMPARE(lines[2], QStringLiteral("103\t3\t30"));
+    QCOMPARE(lines[3], QStringLiteral("104\t4\t40"));
+}
+
+void LogCompressorTest::_holeFillingTest(void)
+{
+    QTemporaryDir tempDir;
+
+    QByteArray log;
+    for (int i=0; i<6; i++) {
+        log += QByteArray::number(i) + "\tuas\ta\t" + QByteArray::number(i) + "\n";
+        if (i % 2 == 0) {
+            log += QByteArray::number(i) + "\tuas\tb\t" + QByteArray::number(i) + "\n";
+        }
+    }
+
+    QStringList lines = _compress(tempDir.filePath("holes.log"), log, true);
+    QCOMPARE(lines.count(), 5);
+    QCOMPARE(lines[1], QStringLiteral("2\t2\t2"));
+    QCOMPARE(lines[2], QStringLiteral("3\t3\t2"));
+    QCOMPARE(lines[4], QStringLiteral("5\t5\t4"));
+
+    lines = _compress(tempDir.filePath("noholes.log"), log, false);
+    QCOMPARE(lines.count(), 5);
+    QCOMPARE(lines[2], QStringLiteral("3\t3\t"));
+}
+
+void LogCompressorTest::_streamingTest(void)
+{
+    QTemporaryDir tempDir;
+
+    // Several chunks worth, so timestamps get split across chunk boundaries
+    const int   rowCount = 3 * LogCompressor::chunkBytes / 30;
+    QByteArray  log;
+    log.reserve(4 * LogCompressor::chunkBytes);
+    for (int i=0; i<rowCount; i++) {
+        const QByteArray timestamp = QByteArray::number(1000000 + i);
+        log += timestamp + "\tuas\talpha\t" + QByteArray::number(i) + "\n";
+        if (i % 3 == 0) {
+            log += timestamp + "\tuas\tbeta\t" + QByteArray::number(-i) + "\n";
+        }
+    }
+    QVERIFY(log.length() > 2 * LogCompressor::chunkBytes);
+
+    QStringList lines = _compress(tempDir.filePath("stream.log"), log, true);
+    QCOMPARE(lines.count(), rowCount - 1);
+    QCOMPARE(lines[0], QStringLiteral("TIMESTAMPms\talpha\tbeta"));
+    for (int i=1; i<lines.count(); i++) {
+        const int           row     = i + 1;
+        const QStringList   fields  = lines[i].split('\t');
+        QCOMPARE(fields.count(), 3);
+        QCOMPARE(fields[0].toInt(), 1000000 + row);
+        QCOMPARE(fields[1].toInt(), row);
+        QCOMPARE(fields[2].toInt(), -(row - (row % 3)));
+    }
+}
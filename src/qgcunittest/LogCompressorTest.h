@@ -0,0 +1,25 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class LogCompressorTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _compressTest      (void);
+    void _holeFillingTest   (void);
+    void _streamingTest     (void);
+
+private:
+    QStringList _compress(const QString& logFileName, const QByteArray& log, bool holeFilling);
+};
@@ -0,0 +1,91 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCLoggingCategoryTest.h"
+#include "QGCLoggingCategory.h"
+
+#include <QThread>
+
+QGC_LOGGING_CATEGORY(QGCLoggingCategoryTestLog, "QGCLoggingCategoryTestLog")
+
+static QStringList          _messages;
+static QtMessageHandler     _previousHandler = nullptr;
+static int                  _evaluations = 0;
+
+static void _messageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message)
+{
+    if (context.category && qstrcmp(context.category, "QGCLoggingCategoryTestLog") == 0) {
+        _messages.append(message);
+    } else if (_previousHandler) {
+        _previousHandler(type, context, message);
+    }
+}
+
+/// Counts how often the arguments of a log call are evaluated
+static int _evaluate(void)
+{
+    return ++_evaluations;
+}
+
+/// A single rate limited call site
+static void _logRateLimited(void)
+{
+    QGC_DEBUG_RATE_LIMITED(QGCLoggingCategoryTestLog, 500) << "limited" << _evaluate();
+}
+
+void QGCLoggingCategoryTest::init(void)
+{
+    UnitTest::init();
+
+    _messages.clear();
+    _evaluations = 0;
+    _previousHandler = qInstallMessageHandler(_messageHandler);
+}
+
+void QGCLoggingCategoryTest::cleanup(void)
+{
+    qInstallMessageHandler(_previousHandler);
+    QGCLoggingCategoryTestLog().setEnabled(QtDebugMsg, false);
+
+    UnitTest::cleanup();
+}
+
+void QGCLoggingCategoryTest::_disabledTest(void)
+{
+    QGCLoggingCategoryTestLog().setEnabled(QtDebugMsg, false);
+
+    for (int i=0; i<10; i++) {
+        QGC_DEBUG_RATE_LIMITED(QGCLoggingCategoryTestLog, 0) << _evaluate();
+    }
+    QCOMPARE(_evaluations, 0);
+    QCOMPARE(_messages.count(), 0);
+}
+
+void QGCLoggingCategoryTest::_rateLimitTest(void)
+{
+    QGCLoggingCategoryTestLog().setEnabled(QtDebugMsg, true);
+
+    // Only the first call gets through, the suppressed ones don't evaluate their arguments
+    for (int i=0; i<3; i++) {
+        _logRateLimited();
+    }
+    QCOMPARE(_evaluations, 1);
+    QCOMPARE(_messages, QStringList({ QStringLiteral("limited 1") }));
+
+    // Each call site is limited on its own
+    QGC_DEBUG_RATE_LIMITED(QGCLoggingCategoryTestLog, 500) << "other";
+    QCOMPARE(_messages.count(), 2);
+
+    // After the interval the next call reports what was suppressed
+    QThread::msleep(600);
+    _messages.clear();
+    _logRateLimited();
+    QCOMPARE(_evaluations, 2);
+    QCOMPARE(_messages, QStringList({ QStringLiteral("2 messages suppressed by rate limit"), QStringLiteral("limited 2") }));
+}
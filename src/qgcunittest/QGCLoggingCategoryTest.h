@@ -0,0 +1,24 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class QGCLoggingCategoryTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void init           (void) final;
+    void cleanup        (void) final;
+
+    void _disabledTest  (void);
+    void _rateLimitTest (void);
+};
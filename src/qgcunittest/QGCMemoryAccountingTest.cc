@@ -0,0 +1,69 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCMemoryAccountingTest.h"
+#include "QGCMemoryAccounting.h"
+#include "QGCApplication.h"
+
+#include <QVariantMap>
+
+/// @return Index of the subsystem in the last update, -1 if it isn't there
+static int _subsystemIndex(const QString& name)
+{
+    QVariantList subsystems = qgcApp()->toolbox()->memoryAccounting()->subsystems();
+    for (int i=0; i<subsystems.count(); i++) {
+        if (subsystems[i].toMap()[QStringLiteral("name")].toString() == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void QGCMemoryAccountingTest::_totalsTest(void)
+{
+    QGCMemoryAccounting* accounting = qgcApp()->toolbox()->memoryAccounting();
+    QObject owner;
+
+    // Sources of the same subsystem are summed
+    accounting->addSource(QStringLiteral("Test small"), &owner, []() { return QGCMemoryAccounting::Usage_t{ 10, 100 }; });
+    accounting->addSource(QStringLiteral("Test small"), &owner, []() { return QGCMemoryAccounting::Usage_t{ 5, 50 }; });
+    accounting->addSource(QStringLiteral("Test large"), &owner, []() { return QGCMemoryAccounting::Usage_t{ 1, 1024 * 1024 * 1024 }; });
+    accounting->update();
+
+    int small = _subsystemIndex(QStringLiteral("Test small"));
+    int large = _subsystemIndex(QStringLiteral("Test large"));
+    QVERIFY(small >= 0);
+    QVERIFY(large >= 0);
+
+    QVariantMap subsystem = accounting->subsystems()[small].toMap();
+    QCOMPARE(subsystem[QStringLiteral("count")].toLongLong(),   15LL);
+    QCOMPARE(subsystem[QStringLiteral("bytes")].toLongLong(),   150LL);
+    QCOMPARE(subsystem[QStringLiteral("sources")].toInt(),      2);
+
+    // Largest first
+    QVERIFY(large < small);
+
+    QVERIFY(accounting->summary().contains(QStringLiteral("Test small:15/150B")));
+    QVERIFY(accounting->summary().contains(QStringLiteral("Test large:1/1.00GB")));
+}
+
+void QGCMemoryAccountingTest::_ownerTest(void)
+{
+    QGCMemoryAccounting* accounting = qgcApp()->toolbox()->memoryAccounting();
+
+    QObject* owner = new QObject();
+    accounting->addSource(QStringLiteral("Test owner"), owner, []() { return QGCMemoryAccounting::Usage_t{ 1, 1 }; });
+    accounting->update();
+    QVERIFY(_subsystemIndex(QStringLiteral("Test owner")) >= 0);
+
+    // Sources go away with their owner
+    delete owner;
+    accounting->update();
+    QCOMPARE(_subsystemIndex(QStringLiteral("Test owner")), -1);
+}
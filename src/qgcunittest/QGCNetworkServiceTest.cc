@@ -0,0 +1,234 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCNetworkServiceTest.h"
+#include "QGCApplication.h"
+#include "QGCNetworkService.h"
+
+#include <QNetworkReply>
+#include <QSignalSpy>
+#include <QTcpSocket>
+#include <QThread>
+
+#include <algorithm>
+
+const char* NetworkServiceTestServer::body = "QGroundControl";
+
+NetworkServiceTestServer::NetworkServiceTestServer(QObject* parent)
+    : QTcpServer(parent)
+{
+    connect(this, &QTcpServer::newConnection, this, &NetworkServiceTestServer::_newConnection);
+    listen(QHostAddress::LocalHost);
+}
+
+QUrl NetworkServiceTestServer::url(const QString& path) const
+{
+    return QUrl(QStringLiteral("http://127.0.0.1:%1/%2").arg(serverPort()).arg(path));
+}
+
+void NetworkServiceTestServer::_newConnection(void)
+{
+    while (hasPendingConnections()) {
+        QTcpSocket* socket = nextPendingConnection();
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            // One request per connection is all the tests need
+            if (!socket->peek(socket->bytesAvailable()).contains("\r\n\r\n")) {
+                return;
+            }
+            socket->readAll();
+            _requests++;
+            const QByteArray data(body);
+            socket->write("HTTP/1.1 200 OK\r\n"
+                          "Content-Type: text/plain\r\n"
+                          "Cache-Control: max-age=3600\r\n"
+                          "Connection: close\r\n"
+                          "Content-Length: " + QByteArray::number(data.size()) + "\r\n\r\n" + data);
+            socket->disconnectFromHost();
+        });
+    }
+}
+
+void QGCNetworkServiceTest::_threadTest(void)
+{
+    QGCNetworkService* service = qgcApp()->toolbox()->networkService();
+    QVERIFY(service);
+
+    QNetworkAccessManager* accessManager = service->networkAccessManager();
+    QVERIFY(accessManager);
+    QCOMPARE(service->networkAccessManager(), accessManager);
+
+    // Another thread gets its own
+    QNetworkAccessManager*  threadAccessManager = nullptr;
+    QThread*                thread              = QThread::create([service, &threadAccessManager]() {
+        threadAccessManager = service->networkAccessManager();
+    });
+    thread->start();
+    QVERIFY(thread->wait(5000));
+    QVERIFY(threadAccessManager);
+    QVERIFY(threadAccessManager != accessManager);
+    delete thread;
+}
+
+void QGCNetworkServiceTest::_consumerTest(void)
+{
+    QNetworkRequest request;
+    QCOMPARE(QGCNetworkService::consumer(request), QString(QGCNetworkService::consumerOther));
+
+    QGCNetworkService::setConsumer(request, QGCNetworkService::consumerTerrain);
+    QCOMPARE(QGCNetworkService::consumer(request), QString(QGCNetworkService::consumerTerrain));
+}
+
+void QGCNetworkServiceTest::_limitTest(void)
+{
+    QGCNetworkService*          service = qgcApp()->toolbox()->networkService();
+    NetworkServiceTestServer    server;
+    QVERIFY(server.isListening());
+
+    const int maxActiveRequests = service->maxActiveRequests();
+    service->setMaxActiveRequests(1);
+
+    QNetworkAccessManager*  accessManager = service->networkAccessManager();
+    QNetworkRequest         request(server.url(QStringLiteral("first")));
+    QGCNetworkService::setConsumer(request, QStringLiteral("LimitTest"));
+    QNetworkReply*          first   = accessManager->get(request);
+    request.setUrl(server.url(QStringLiteral("second")));
+    QNetworkReply*          second  = accessManager->get(request);
+
+    // The second one waits for the first
+    QList<QGCNetworkService::Statistics_t> statistics = service->statistics();
+    const auto stats = std::find_if(statistics.begin(), statistics.end(), [](const QGCNetworkService::Statistics_t& entry) { return entry.consumer == QStringLiteral("LimitTest"); });
+    QVERIFY(stats != statistics.end());
+    QCOMPARE(stats->active, 1);
+    QCOMPARE(stats->waiting, 1);
+
+    QTRY_VERIFY_WITH_TIMEOUT(first->isFinished() && second->isFinished(), 5000);
+    QCOMPARE(first->error(), QNetworkReply::NoError);
+    QCOMPARE(second->error(), QNetworkReply::NoError);
+    QCOMPARE(first->readAll(), QByteArray(NetworkServiceTestServer::body));
+    QCOMPARE(second->readAll(), QByteArray(NetworkServiceTestServer::body));
+    QCOMPARE(server.requests(), 2);
+
+    // Aborting a waiting request frees its place
+    request.setUrl(server.url(QStringLiteral("third")));
+    QNetworkReply* third    = accessManager->get(request);
+    request.setUrl(server.url(QStringLiteral("fourth")));
+    QNetworkReply* fourth   = accessManager->get(request);
+    fourth->abort();
+    QCOMPARE(fourth->error(), QNetworkReply::OperationCanceledError);
+    QTRY_VERIFY_WITH_TIMEOUT(third->isFinished(), 5000);
+    QCOMPARE(server.requests(), 3);
+
+    delete first;
+    delete second;
+    delete third;
+    delete fourth;
+    service->setMaxActiveRequests(maxActiveRequests);
+}
+
+void QGCNetworkServiceTest::_cacheTest(void)
+{
+    QGCNetworkService*          service = qgcApp()->toolbox()->networkService();
+    NetworkServiceTestServer    server;
+    QVERIFY(server.isListening());
+
+    const QString consumer = QStringLiteral("CacheTest");
+    service->setCacheBudget(consumer, 1024 * 1024);
+
+    QNetworkAccessManager*  accessManager = service->networkAccessManager();
+    QNetworkRequest         request(server.url(QStringLiteral("cached")));
+    QGCNetworkService::setConsumer(request, consumer);
+
+    QNetworkReply* reply = accessManager->get(request);
+    QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 5000);
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QVERIFY(!reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool());
+    delete reply;
+
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
+    reply = accessManager->get(request);
+    QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 5000);
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QVERIFY(reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool());
+    QCOMPARE(reply->readAll(), QByteArray(NetworkServiceTestServer::body));
+    QCOMPARE(server.requests(), 1);
+    delete reply;
+
+    service->setCacheBudget(consumer, 0);
+}
+
+void QGCNetworkServiceTest::_localUrlTest(void)
+{
+    QVERIFY(QGCNetworkService::isLocalUrl(QUrl(QStringLiteral("http://localhost:8080/camera.xml"))));
+    QVERIFY(QGCNetworkService::isLocalUrl(QUrl(QStringLiteral("http://127.0.0.1/"))));
+    QVERIFY(QGCNetworkService::isLocalUrl(QUrl(QStringLiteral("http://192.168.42.1/DCIM/1.jpg"))));
+    QVERIFY(QGCNetworkService::isLocalUrl(QUrl(QStringLiteral("http://10.41.1.1/pair"))));
+    QVERIFY(QGCNetworkService::isLocalUrl(QUrl(QStringLiteral("http://172.20.0.5/"))));
+    QVERIFY(QGCNetworkService::isLocalUrl(QUrl(QStringLiteral("http://camera.local/"))));
+    QVERIFY(QGCNetworkService::isLocalUrl(QUrl(QStringLiteral("http://[fe80::1]/"))));
+    QVERIFY(!QGCNetworkService::isLocalUrl(QUrl(QStringLiteral("http://172.32.0.1/"))));
+    QVERIFY(!QGCNetworkService::isLocalUrl(QUrl(QStringLiteral("https://8.8.8.8/"))));
+    QVERIFY(!QGCNetworkService::isLocalUrl(QUrl(QStringLiteral("https://api.airmap.com/elevation/v1/ele"))));
+
+    QVERIFY(QGCNetworkService::isConnectivityError(QNetworkReply::HostNotFoundError));
+    QVERIFY(QGCNetworkService::isConnectivityError(QNetworkReply::ProxyTimeoutError));
+    QVERIFY(!QGCNetworkService::isConnectivityError(QNetworkReply::ContentNotFoundError));
+    QVERIFY(!QGCNetworkService::isConnectivityError(QNetworkReply::OperationCanceledError));
+}
+
+void QGCNetworkServiceTest::_internetTest(void)
+{
+    QGCNetworkService*          service = qgcApp()->toolbox()->networkService();
+    NetworkServiceTestServer    server;
+    QVERIFY(server.isListening());
+
+    // Whatever the network of the test machine, the requests decide from here on
+    {
+        QMutexLocker locker(&service->_mutex);
+        service->_interfaceTimer.stop();
+        service->_interfaceUp = true;
+        service->_setInternetUp(true);
+    }
+    service->_announceInternet();
+    QVERIFY(service->internetAvailable());
+
+    QSignalSpy spy(service, &QGCNetworkService::internetAvailableChanged);
+    for (int i = 0; i < QGCNetworkService::connectivityFailures - 1; i++) {
+        service->_reportReachable(false);
+    }
+    QVERIFY(service->internetAvailable());
+    service->_reportReachable(false);
+    QVERIFY(!service->internetAvailable());
+    QTRY_COMPARE_WITH_TIMEOUT(spy.count(), 1, 1000);
+    QCOMPARE(spy.takeFirst().at(0).toBool(), false);
+
+    // Requests to the internet fail right away until the recheck is due, the local network isn't affected
+    const QUrl remoteUrl(QStringLiteral("http://example.com/"));
+    QVERIFY(!service->requestAllowed(remoteUrl));
+    QVERIFY(service->requestAllowed(server.url(QStringLiteral("local"))));
+
+    QNetworkAccessManager* accessManager = service->networkAccessManager();
+    QNetworkReply* remoteReply = accessManager->get(QNetworkRequest(remoteUrl));
+    QNetworkReply* localReply  = accessManager->get(QNetworkRequest(server.url(QStringLiteral("local"))));
+    QTRY_VERIFY_WITH_TIMEOUT(remoteReply->isFinished() && localReply->isFinished(), 5000);
+    QCOMPARE(remoteReply->error(), QNetworkReply::NetworkSessionFailedError);
+    QCOMPARE(localReply->error(), QNetworkReply::NoError);
+    QCOMPARE(server.requests(), 1);
+    delete remoteReply;
+    delete localReply;
+
+    // One answer from the internet brings it back
+    service->_reportReachable(true);
+    QVERIFY(service->internetAvailable());
+    QTRY_COMPARE_WITH_TIMEOUT(spy.count(), 1, 1000);
+    QCOMPARE(spy.takeFirst().at(0).toBool(), true);
+
+    service->_checkInterfaces();
+    service->_interfaceTimer.start(QGCNetworkService::interfaceCheckMSecs);
+}
@@ -0,0 +1,47 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+#include <QTcpServer>
+
+/// Answers each http request on localhost with a small cacheable body
+class NetworkServiceTestServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    NetworkServiceTestServer(QObject* parent = nullptr);
+
+    QUrl    url         (const QString& path) const;
+    int     requests    (void) const { return _requests; }
+
+    static const char* body;
+
+private slots:
+    void _newConnection (void);
+
+private:
+    int _requests = 0;
+};
+
+class QGCNetworkServiceTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _threadTest    (void);
+    void _consumerTest  (void);
+    void _limitTest     (void);
+    void _cacheTest     (void);
+    void _localUrlTest  (void);
+    void _internetTest  (void);
+};
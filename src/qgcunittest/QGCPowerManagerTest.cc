@@ -0,0 +1,85 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCPowerManagerTest.h"
+#include "QGCPowerManager.h"
+#include "QGCApplication.h"
+
+#include <QSignalSpy>
+
+void QGCPowerManagerTest::_stateTest(void)
+{
+    const qint64    idle                = QGCPowerManager::idleMSecs;
+    const int       idleFactor          = QGCPowerManager::idleRateFactor;
+    const int       backgroundFactor    = QGCPowerManager::backgroundRateFactor;
+
+    QCOMPARE(QGCPowerManager::stateFor(false, false, 0),            QGCPowerManager::PowerActive);
+    QCOMPARE(QGCPowerManager::stateFor(false, false, idle - 1),     QGCPowerManager::PowerActive);
+    QCOMPARE(QGCPowerManager::stateFor(false, false, idle),         QGCPowerManager::PowerIdle);
+
+    // A connected vehicle is never idle, the user may just be watching it
+    QCOMPARE(QGCPowerManager::stateFor(false, true, idle * 10),     QGCPowerManager::PowerActive);
+
+    QCOMPARE(QGCPowerManager::stateFor(true, true, 0),              QGCPowerManager::PowerBackground);
+    QCOMPARE(QGCPowerManager::stateFor(true, false, idle),          QGCPowerManager::PowerBackground);
+
+    QCOMPARE(QGCPowerManager::rateFactor(QGCPowerManager::PowerActive),     1);
+    QCOMPARE(QGCPowerManager::rateFactor(QGCPowerManager::PowerIdle),       idleFactor);
+    QCOMPARE(QGCPowerManager::rateFactor(QGCPowerManager::PowerBackground), backgroundFactor);
+}
+
+void QGCPowerManagerTest::_signalTest(void)
+{
+    QGCPowerManager* powerManager = qgcApp()->toolbox()->powerManager();
+    QVERIFY(powerManager);
+    const int backgroundFactor = QGCPowerManager::backgroundRateFactor;
+
+    // Power saving is off in the unit tests
+    QCOMPARE(powerManager->powerState(), QGCPowerManager::PowerActive);
+    QCOMPARE(powerManager->updateRateFactor(), 1);
+
+    QSignalSpy stateSpy (powerManager, &QGCPowerManager::powerStateChanged);
+    QSignalSpy factorSpy(powerManager, &QGCPowerManager::updateRateFactorChanged);
+
+    powerManager->_setPowerState(QGCPowerManager::PowerBackground);
+    QVERIFY(powerManager->background());
+    QCOMPARE(powerManager->updateRateFactor(), backgroundFactor);
+    QCOMPARE(stateSpy.count(), 1);
+    QCOMPARE(factorSpy.count(), 1);
+    QCOMPARE(factorSpy.takeFirst().at(0).toInt(), backgroundFactor);
+
+    // Same state again doesn't signal
+    powerManager->_setPowerState(QGCPowerManager::PowerBackground);
+    QCOMPARE(stateSpy.count(), 1);
+    QCOMPARE(factorSpy.count(), 0);
+
+    // With power saving off a check always ends up active
+    powerManager->_check();
+    QCOMPARE(powerManager->powerState(), QGCPowerManager::PowerActive);
+    QCOMPARE(stateSpy.count(), 2);
+    QCOMPARE(factorSpy.count(), 1);
+    QCOMPARE(factorSpy.takeFirst().at(0).toInt(), 1);
+}
+
+void QGCPowerManagerTest::_activityTest(void)
+{
+    QGCPowerManager* powerManager = qgcApp()->toolbox()->powerManager();
+    QVERIFY(powerManager);
+
+    // User input leaves idle right away instead of on the next check
+    powerManager->_powerSaving = true;
+    powerManager->_setPowerState(QGCPowerManager::PowerIdle);
+    powerManager->userActivity();
+    QVERIFY(powerManager->powerState() != QGCPowerManager::PowerIdle);
+    QVERIFY(powerManager->_inputClock.elapsed() < QGCPowerManager::idleMSecs);
+
+    powerManager->_powerSaving = false;
+    powerManager->_check();
+    QCOMPARE(powerManager->powerState(), QGCPowerManager::PowerActive);
+}
@@ -0,0 +1,119 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTimerWheelTest.h"
+#include "QGCTimerWheel.h"
+#include "QGCApplication.h"
+
+#include <QElapsedTimer>
+#include <QSignalSpy>
+
+#include <algorithm>
+
+void QGCTimerWheelTest::_singleShotTest(void)
+{
+    QVERIFY(qgcApp()->toolbox()->timerWheel());
+
+    QGCWheelTimer   timer("Test");
+    QSignalSpy      spy(&timer, &QGCWheelTimer::timeout);
+    QElapsedTimer   elapsed;
+
+    timer.setSingleShot(true);
+    elapsed.start();
+    timer.start(50);
+    QVERIFY(timer.isActive());
+
+    QVERIFY(spy.wait(1000));
+    QVERIFY(elapsed.elapsed() >= 45);
+    QVERIFY(!timer.isActive());
+
+    QTest::qWait(150);
+    QCOMPARE(spy.count(), 1);
+}
+
+void QGCTimerWheelTest::_periodicTest(void)
+{
+    QGCWheelTimer   timer("Test");
+    QSignalSpy      spy(&timer, &QGCWheelTimer::timeout);
+
+    timer.start(30);
+    QTRY_VERIFY_WITH_TIMEOUT(spy.count() >= 3, 2000);
+    QVERIFY(timer.isActive());
+
+    timer.stop();
+    QVERIFY(!timer.isActive());
+    const int count = spy.count();
+    QTest::qWait(100);
+    QCOMPARE(spy.count(), count);
+}
+
+void QGCTimerWheelTest::_restartTest(void)
+{
+    QGCWheelTimer   timer("Test");
+    QSignalSpy      spy(&timer, &QGCWheelTimer::timeout);
+
+    // A timeout which keeps getting restarted never fires, like a link timeout while messages arrive
+    timer.setSingleShot(true);
+    for (int i=0; i<15; i++) {
+        timer.start(100);
+        QTest::qWait(20);
+    }
+    QCOMPARE(spy.count(), 0);
+
+    QVERIFY(spy.wait(1000));
+    QTest::qWait(150);
+    QCOMPARE(spy.count(), 1);
+}
+
+void QGCTimerWheelTest::_longTimerTest(void)
+{
+    // Past the level 0 span, the timer has to move down a level before it expires
+    QGCWheelTimer   timer("Test");
+    QSignalSpy      spy(&timer, &QGCWheelTimer::timeout);
+    QElapsedTimer   elapsed;
+
+    timer.setSingleShot(true);
+    elapsed.start();
+    timer.start(1000);
+
+    QVERIFY(spy.wait(3000));
+    QVERIFY(elapsed.elapsed() >= 995);
+    QCOMPARE(spy.count(), 1);
+}
+
+void QGCTimerWheelTest::_windowTest(void)
+{
+    static const int cTimers = 20;
+
+    QList<QGCWheelTimer*>   timers;
+    QList<QSignalSpy*>      spies;
+
+    for (int i=0; i<cTimers; i++) {
+        QGCWheelTimer* timer = new QGCWheelTimer("Test", this);
+        timer->setWindow(100);
+        timer->start(100);
+        timers.append(timer);
+        spies.append(new QSignalSpy(timer, &QGCWheelTimer::timeout));
+
+        // Started at different times, but the window lines them all up
+        QTest::qWait(3);
+    }
+
+    const quint64 startWakeups = qgcApp()->toolbox()->timerWheel()->wakeupCount();
+    QTRY_VERIFY_WITH_TIMEOUT(std::all_of(spies.begin(), spies.end(), [](QSignalSpy* spy) { return spy->count() >= 3; }), 3000);
+
+    int timeouts = 0;
+    for (QSignalSpy* spy: spies) {
+        timeouts += spy->count();
+    }
+    QVERIFY(qgcApp()->toolbox()->timerWheel()->wakeupCount() - startWakeups <= static_cast<quint64>(timeouts / 4));
+
+    qDeleteAll(spies);
+    qDeleteAll(timers);
+}
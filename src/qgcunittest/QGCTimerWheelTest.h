@@ -0,0 +1,24 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+class QGCTimerWheelTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _singleShotTest    (void);
+    void _periodicTest      (void);
+    void _restartTest       (void);
+    void _longTimerTest     (void);
+    void _windowTest        (void);
+};
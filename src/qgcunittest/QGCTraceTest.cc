@@ -0,0 +1,153 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCTraceTest.h"
+#include "QGCTrace.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QThread>
+
+static QJsonObject _parseTrace(const QByteArray& json)
+{
+    QJsonParseError error;
+    QJsonDocument   doc = QJsonDocument::fromJson(json, &error);
+    if (error.error != QJsonParseError::NoError) {
+        qWarning() << "Trace JSON" << error.errorString();
+    }
+    return doc.object();
+}
+
+/// @return Complete events with the name
+static QList<QJsonObject> _events(const QJsonObject& trace, const QString& name)
+{
+    QList<QJsonObject> events;
+    for (const QJsonValue& value: trace["traceEvents"].toArray()) {
+        QJsonObject event = value.toObject();
+        if (event["ph"].toString() == QStringLiteral("X") && event["name"].toString() == name) {
+            events.append(event);
+        }
+    }
+    return events;
+}
+
+/// @return Name of the thread given in the thread_name metadata event
+static QString _threadName(const QJsonObject& trace, int tid)
+{
+    for (const QJsonValue& value: trace["traceEvents"].toArray()) {
+        QJsonObject event = value.toObject();
+        if (event["ph"].toString() == QStringLiteral("M") && event["name"].toString() == QStringLiteral("thread_name") && event["tid"].toInt() == tid) {
+            return event["args"].toObject()["name"].toString();
+        }
+    }
+    return QString();
+}
+
+void QGCTraceTest::_scopeTest(void)
+{
+    // Nothing is collected while tracing is off
+    QVERIFY(!QGCTrace::enabled());
+    {
+        QGCTraceScope scope("Test", "beforeStart");
+    }
+
+    QGCTrace::start();
+    QVERIFY(QGCTrace::enabled());
+    {
+        QGCTraceScope outer("Test", "outer", "value", 42);
+        {
+            QGCTraceScope inner("Test", "inner");
+            QThread::msleep(2);
+        }
+    }
+    QJsonObject trace = _parseTrace(QGCTrace::stop());
+    QVERIFY(!QGCTrace::enabled());
+
+    QVERIFY(_events(trace, "beforeStart").isEmpty());
+    QCOMPARE(_events(trace, "outer").count(), 1);
+    QCOMPARE(_events(trace, "inner").count(), 1);
+
+    QJsonObject outer = _events(trace, "outer").first();
+    QJsonObject inner = _events(trace, "inner").first();
+    QCOMPARE(outer["cat"].toString(), QStringLiteral("Test"));
+    QCOMPARE(outer["args"].toObject()["value"].toInt(), 42);
+    QVERIFY(!inner.contains("args"));
+    QCOMPARE(outer["tid"].toInt(), inner["tid"].toInt());
+
+    // Nested events lie within the enclosing one
+    QVERIFY(inner["ts"].toDouble() >= outer["ts"].toDouble());
+    QVERIFY(inner["ts"].toDouble() + inner["dur"].toDouble() <= outer["ts"].toDouble() + outer["dur"].toDouble());
+    QVERIFY(inner["dur"].toDouble() >= 1000);
+
+    // Stopping hands out the events once
+    QGCTrace::start();
+    trace = _parseTrace(QGCTrace::stop());
+    QVERIFY(_events(trace, "outer").isEmpty());
+}
+
+void QGCTraceTest::_threadTest(void)
+{
+    QGCTrace::start();
+
+    QThread* thread = QThread::create([]() {
+        QGCTrace::setThreadName(QStringLiteral("Test \"Worker\""));
+        QGCTraceScope scope("Test", "worker");
+    });
+    thread->start();
+    QVERIFY(thread->wait(5000));
+    delete thread;
+    {
+        QGCTraceScope scope("Test", "main");
+    }
+
+    // The events of a thread which ended are kept
+    QJsonObject trace = _parseTrace(QGCTrace::stop());
+    QCOMPARE(_events(trace, "worker").count(), 1);
+    QCOMPARE(_events(trace, "main").count(), 1);
+
+    int workerTid   = _events(trace, "worker").first()["tid"].toInt();
+    int mainTid     = _events(trace, "main").first()["tid"].toInt();
+    QVERIFY(workerTid != mainTid);
+    QCOMPARE(_threadName(trace, workerTid), QStringLiteral("Test \"Worker\""));
+    QVERIFY(!_threadName(trace, mainTid).isEmpty());
+}
+
+void QGCTraceTest::_droppedTest(void)
+{
+    const int maxThreadEvents = QGCTrace::maxThreadEvents;
+
+    QGCTrace::start();
+    for (int i=0; i<maxThreadEvents + 10; i++) {
+        QGCTrace::addEvent("Test", "event", i, 1);
+    }
+    QJsonObject trace = _parseTrace(QGCTrace::stop());
+    QCOMPARE(_events(trace, "event").count(), maxThreadEvents);
+    QCOMPARE(trace["otherData"].toObject()["droppedEvents"].toInt(), 10);
+}
+
+void QGCTraceTest::_fileTest(void)
+{
+    QTemporaryDir   dir;
+    QString         fileName = dir.filePath("trace.json");
+
+    QGCTrace::start();
+    {
+        QGCTraceScope scope("Test", "file");
+    }
+    QVERIFY(QGCTrace::stop(fileName));
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(_events(_parseTrace(file.readAll()), "file").count(), 1);
+
+    QGCTrace::start();
+    QVERIFY(!QGCTrace::stop(dir.filePath("missing/trace.json")));
+}
@@ -0,0 +1,59 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "QGCZlibTest.h"
+#include "QGCZlib.h"
+
+#include <QBuffer>
+
+QByteArray QGCZlibTest::_readResource(const QString& resource)
+{
+    QFile file(resource);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+void QGCZlibTest::_inflateGzipData(void)
+{
+    QByteArray gzippedData  = _readResource(":MockLink/Version.MetaData.json.gz");
+    QByteArray expectedData = _readResource(":MockLink/Version.MetaData.json");
+    QVERIFY(!gzippedData.isEmpty());
+    QVERIFY(!expectedData.isEmpty());
+
+    QVERIFY(QGCZlib::isGzipData(gzippedData));
+    QVERIFY(!QGCZlib::isGzipData(expectedData));
+
+    QByteArray inflatedData;
+    QVERIFY(QGCZlib::inflateGzipData(gzippedData, inflatedData));
+    QCOMPARE(inflatedData, expectedData);
+}
+
+void QGCZlibTest::_inflateGzipDevice(void)
+{
+    QFile gzippedFile(":MockLink/Version.MetaData.json.gz");
+    QVERIFY(gzippedFile.open(QIODevice::ReadOnly));
+
+    QByteArray  inflatedData;
+    QBuffer     output(&inflatedData);
+    QVERIFY(output.open(QIODevice::WriteOnly));
+
+    QVERIFY(QGCZlib::inflateGzip(gzippedFile, output));
+    QCOMPARE(inflatedData, _readResource(":MockLink/Version.MetaData.json"));
+}
+
+void QGCZlibTest::_inflateTruncated(void)
+{
+    QByteArray gzippedData = _readResource(":MockLink/Version.MetaData.json.gz");
+    gzippedData.chop(gzippedData.size() / 2);
+
+    QByteArray inflatedData;
+    QVERIFY(!QGCZlib::inflateGzipData(gzippedData, inflatedData));
+}
@@ -0,0 +1,26 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for QGCZlib
+class QGCZlibTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _inflateGzipData   (void);
+    void _inflateGzipDevice (void);
+    void _inflateTruncated  (void);
+
+private:
+    QByteArray _readResource(const QString& resource);
+};
@@ -0,0 +1,75 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "StartupBenchmark.h"
+#include "BenchmarkResults.h"
+#include "QGCApplication.h"
+#include "QGCCorePlugin.h"
+
+#include <QElapsedTimer>
+#include <QQmlApplicationEngine>
+#include <QQuickWindow>
+#include <QSignalSpy>
+
+StartupBenchmark::StartupBenchmark(void)
+{
+
+}
+
+void StartupBenchmark::_mainWindowBenchmark(void)
+{
+    QGCCorePlugin*  corePlugin      = qgcApp()->toolbox()->corePlugin();
+    int             iterations      = BenchmarkResults::iterations();
+    qint64          warmLoadMSecs   = 0;
+    qint64          warmFrameMSecs  = 0;
+    qint64          warmPlanMSecs   = 0;
+    QElapsedTimer   timer;
+
+    for (int i=0; i<iterations; i++) {
+        QQmlApplicationEngine* qmlAppEngine = corePlugin->createQmlApplicationEngine(this);
+
+        timer.start();
+        corePlugin->createRootWindow(qmlAppEngine);
+        qint64 loadMSecs = timer.elapsed();
+
+        QVERIFY(!qmlAppEngine->rootObjects().isEmpty());
+        QQuickWindow* rootWindow = qobject_cast<QQuickWindow*>(qmlAppEngine->rootObjects().first());
+        QVERIFY(rootWindow);
+
+        // The signal comes from the render thread with the threaded render loop, the spy queues it to us
+        QSignalSpy frameSwappedSpy(rootWindow, &QQuickWindow::frameSwapped);
+        if (!frameSwappedSpy.wait(_firstFrameTimeoutMSecs)) {
+            delete qmlAppEngine;
+            QSKIP("Main window didn't render a frame, the benchmark needs a display");
+        }
+        qint64 frameMSecs = timer.elapsed();
+
+        timer.start();
+        QMetaObject::invokeMethod(rootWindow, "showPlanView");
+        qint64 planMSecs = timer.elapsed();
+
+        delete qmlAppEngine;
+
+        if (i == 0) {
+            BenchmarkResults::record(this, QStringLiteral("coldMsecsToLoad"),        loadMSecs,  QStringLiteral("ms"));
+            BenchmarkResults::record(this, QStringLiteral("coldMsecsToFirstFrame"),  frameMSecs, QStringLiteral("ms"));
+            BenchmarkResults::record(this, QStringLiteral("coldMsecsToPlanView"),    planMSecs,  QStringLiteral("ms"));
+        } else {
+            warmLoadMSecs   += loadMSecs;
+            warmFrameMSecs  += frameMSecs;
+            warmPlanMSecs   += planMSecs;
+        }
+    }
+
+    if (iterations > 1) {
+        BenchmarkResults::record(this, QStringLiteral("warmMsecsToLoad"),        static_cast<double>(warmLoadMSecs) / (iterations - 1),  QStringLiteral("ms"));
+        BenchmarkResults::record(this, QStringLiteral("warmMsecsToFirstFrame"),  static_cast<double>(warmFrameMSecs) / (iterations - 1), QStringLiteral("ms"));
+        BenchmarkResults::record(this, QStringLiteral("warmMsecsToPlanView"),    static_cast<double>(warmPlanMSecs) / (iterations - 1),  QStringLiteral("ms"));
+    }
+}
@@ -0,0 +1,36 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Benchmark for showing the main window, with the same engine setup as a normal boot:
+///     - Load of MainRootWindow.qml, which creates the fly view and its map
+///     - Time from the start of the load to the first rendered frame
+///     - Plan view creation the first time it is shown
+///
+/// The first pass compiles the QML unless the build ran qmlcachegen (COMPILE_QML/qtquickcompiler), later passes use
+/// the disk cache. They are reported separately as cold and warm.
+///
+/// QGC_BENCH_ITERATIONS is the number of passes, the first is the cold one. It needs a display to render. See
+/// BenchmarkResults for how to run it and where results go.
+class StartupBenchmark : public UnitTest
+{
+    Q_OBJECT
+
+public:
+    StartupBenchmark(void);
+
+private slots:
+    void _mainWindowBenchmark(void);
+
+private:
+    static const int _firstFrameTimeoutMSecs = 30000;
+};
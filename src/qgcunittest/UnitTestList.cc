@@ -11,10 +11,30 @@
 // We keep the list of all unit tests in a global location so it's easier to see which
 // ones are enabled/disabled
 
+#include "FactMetaDataStoreTest.h"
+#include "FactHistoryTest.h"
+#include "SettingsStoreTest.h"
+#include "QmlObjectListModelTest.h"
+#include "ParameterSearchIndexTest.h"
+#include "RCChannelThrottleTest.h"
+#include "TerrainProfileTest.h"
+#include "InstrumentValueDataTest.h"
+#include "VehicleMarkerLayerTest.h"
+#include "QGCImageProviderTest.h"
+#include "QGCTileCacheTest.h"
+#include "FactGroupTest.h"
 #include "FactSystemTestGeneric.h"
 #include "FactSystemTestPX4.h"
 //#include "FileDialogTest.h"
 #include "GeoTest.h"
+#include "QGCZlibTest.h"
+#include "LogCompressorTest.h"
+#include "QGCLoggingCategoryTest.h"
+#include "QGCMemoryAccountingTest.h"
+#include "QGCNetworkServiceTest.h"
+#include "QGCPowerManagerTest.h"
+#include "QGCTimerWheelTest.h"
+#include "QGCTraceTest.h"
 //#include "MessageBoxTest.h"
 #include "MissionItemTest.h"
 #include "SimpleMissionItemTest.h"
@@ -27,16 +47,39 @@
 //#include "FileManagerTest.h"
 #include "ParameterManagerTest.h"
 #include "MissionCommandTreeTest.h"
+#include "ExifParserTest.h"
 //#include "LogDownloadTest.h"
+#include "LogIndexerTest.h"
+#include "MAVLinkChartBufferTest.h"
+#include "MavlinkConsoleBufferTest.h"
+#include "ULogReaderTest.h"
+#include "VibrationAnalyzerTest.h"
+#include "TlogAnalyzerTest.h"
 #include "SendMavCommandWithSignallingTest.h"
 #include "SendMavCommandWithHandlerTest.h"
 #include "VisualMissionItemTest.h"
 #include "CameraSectionTest.h"
 #include "SpeedSectionTest.h"
 #include "PlanMasterControllerTest.h"
+#include "KMLPlanDocumentTest.h"
+#include "FollowMeMotionEstimatorTest.h"
+#include "CompassSphereFitTest.h"
+#include "NmeaParserTest.h"
+#include "FirmwareDownloadCacheTest.h"
+#include "MAVLinkLogUploaderTest.h"
+#include "MAVLinkULogWriterTest.h"
+#include "UASMessageModelTest.h"
+#if defined(QGC_AIRMAP_ENABLED)
+#include "AirspaceGeometryCacheTest.h"
+#include "AirMapTelemetryShaperTest.h"
+#endif
+#if defined(QGC_ENABLE_PAIRING)
+#include "AESTest.h"
+#endif
 #include "MissionSettingsTest.h"
 #include "QGCMapPolygonTest.h"
 #include "AudioOutputTest.h"
+#include "QGCCorePluginTest.h"
 #include "StructureScanComplexItemTest.h"
 #include "QGCMapPolylineTest.h"
 #include "CorridorScanComplexItemTest.h"
@@ -45,20 +88,98 @@
 #include "FWLandingPatternTest.h"
 #include "RequestMessageTest.h"
 #include "FTPManagerTest.h"
+#include "InitialConnectTest.h"
 #include "MissionCommandTreeEditorTest.h"
 #include "VehicleLinkManagerTest.h"
+#include "VehicleStatusModelTest.h"
+#include "StatusTextHandlerTest.h"
+#include "TrajectoryBufferTest.h"
+#include "ObstacleDistanceBufferTest.h"
+#include "LightweightVehicleTest.h"
+#include "MessageDuplicateFilterTest.h"
+#include "MessageRateManagerTest.h"
+#include "TelemetryRecorderTest.h"
+#include "ADSBTargetModelTest.h"
+#include "ADSBParserTest.h"
+#include "NTRIPTest.h"
+#include "QGCCameraDefinitionTest.h"
+#include "QGCCameraMediaTest.h"
+#include "TrafficConflictEngineTest.h"
 #include "LandingComplexItemTest.h"
+#include "MAVLinkFramerTest.h"
+#include "MAVLinkLogWriterTest.h"
+#include "MAVLinkForwarderTest.h"
+#include "MAVLinkMessageDispatcherTest.h"
+#include "MAVLinkFieldDecoderTest.h"
+#include "MAVLinkMessageStatisticsTest.h"
+#include "MockLinkLoadGeneratorTest.h"
+#include "LinkReadStatisticsTest.h"
+#include "LinkTrafficStatisticsTest.h"
+#include "QGCByteRingBufferTest.h"
+#include "QGCPacketQueueTest.h"
+#include "TCPLinkTest.h"
+#include "TelemetryStreamServerTest.h"
+#include "TlogIndexTest.h"
+#include "UDPLinkTest.h"
+#include "TelemetryBenchmark.h"
+#include "MissionLoadBenchmark.h"
+#include "MissionPlanningBenchmark.h"
+#include "StartupBenchmark.h"
+#include "GeoBenchmark.h"
+#include "TerrainLocalDEMTest.h"
+#include "TerrainPathQueryTest.h"
+#include "TerrainTileTest.h"
+#include "TerrainProtocolHandlerTest.h"
+#include "VideoKeyframeIndexTest.h"
+#include "VideoStreamPoolTest.h"
 
+UT_REGISTER_TEST(FactMetaDataStoreTest)
+UT_REGISTER_TEST(FactHistoryTest)
+UT_REGISTER_TEST(SettingsStoreTest)
+UT_REGISTER_TEST(QmlObjectListModelTest)
+UT_REGISTER_TEST(ParameterSearchIndexTest)
+UT_REGISTER_TEST(RCChannelThrottleTest)
+UT_REGISTER_TEST(TerrainProfileTest)
+UT_REGISTER_TEST(InstrumentValueDataTest)
+UT_REGISTER_TEST(VehicleMarkerLayerTest)
+UT_REGISTER_TEST(QGCImageProviderTest)
+UT_REGISTER_TEST(QGCTileCacheTest)
+UT_REGISTER_TEST(FactGroupTest)
 UT_REGISTER_TEST(FactSystemTestGeneric)
 UT_REGISTER_TEST(FactSystemTestPX4)
 //UT_REGISTER_TEST(FileDialogTest)
 UT_REGISTER_TEST(GeoTest)
+UT_REGISTER_TEST(QGCZlibTest)
+UT_REGISTER_TEST(LogCompressorTest)
+UT_REGISTER_TEST(QGCLoggingCategoryTest)
+UT_REGISTER_TEST(QGCMemoryAccountingTest)
+UT_REGISTER_TEST(QGCNetworkServiceTest)
+UT_REGISTER_TEST(QGCPowerManagerTest)
+UT_REGISTER_TEST(QGCTimerWheelTest)
+UT_REGISTER_TEST(QGCTraceTest)
+UT_REGISTER_TEST(VideoKeyframeIndexTest)
+UT_REGISTER_TEST(VideoStreamPoolTest)
 UT_REGISTER_TEST(VehicleLinkManagerTest)
+UT_REGISTER_TEST(VehicleStatusModelTest)
+UT_REGISTER_TEST(StatusTextHandlerTest)
+UT_REGISTER_TEST(TrajectoryBufferTest)
+UT_REGISTER_TEST(ObstacleDistanceBufferTest)
+UT_REGISTER_TEST(LightweightVehicleTest)
+UT_REGISTER_TEST(MessageDuplicateFilterTest)
+UT_REGISTER_TEST(MessageRateManagerTest)
+UT_REGISTER_TEST(TelemetryRecorderTest)
+UT_REGISTER_TEST(ADSBTargetModelTest)
+UT_REGISTER_TEST(ADSBParserTest)
+UT_REGISTER_TEST(NTRIPTest)
+UT_REGISTER_TEST(QGCCameraDefinitionTest)
+UT_REGISTER_TEST(QGCCameraMediaTest)
+UT_REGISTER_TEST(TrafficConflictEngineTest)
 //UT_REGISTER_TEST(MessageBoxTest)
 UT_REGISTER_TEST(SendMavCommandWithSignallingTest)
 UT_REGISTER_TEST(SendMavCommandWithHandlerTest)
 UT_REGISTER_TEST(RequestMessageTest)
 UT_REGISTER_TEST(FTPManagerTest)
+UT_REGISTER_TEST(InitialConnectTest)
 UT_REGISTER_TEST(MissionItemTest)
 UT_REGISTER_TEST(SimpleMissionItemTest)
 UT_REGISTER_TEST(MissionControllerTest)
@@ -67,14 +188,37 @@ UT_REGISTER_TEST(MissionManagerTest)
 //UT_REGISTER_TEST(FileManagerTest)
 UT_REGISTER_TEST(ParameterManagerTest)
 UT_REGISTER_TEST(MissionCommandTreeTest)
+UT_REGISTER_TEST(ExifParserTest)
 //UT_REGISTER_TEST(LogDownloadTest)
+UT_REGISTER_TEST(LogIndexerTest)
+UT_REGISTER_TEST(MAVLinkChartBufferTest)
+UT_REGISTER_TEST(MavlinkConsoleBufferTest)
+UT_REGISTER_TEST(ULogReaderTest)
+UT_REGISTER_TEST(VibrationAnalyzerTest)
+UT_REGISTER_TEST(TlogAnalyzerTest)
 UT_REGISTER_TEST(SurveyComplexItemTest)
 UT_REGISTER_TEST(CameraSectionTest)
 UT_REGISTER_TEST(SpeedSectionTest)
 UT_REGISTER_TEST(PlanMasterControllerTest)
+UT_REGISTER_TEST(KMLPlanDocumentTest)
+UT_REGISTER_TEST(FollowMeMotionEstimatorTest)
+UT_REGISTER_TEST(CompassSphereFitTest)
+UT_REGISTER_TEST(NmeaParserTest)
+UT_REGISTER_TEST(FirmwareDownloadCacheTest)
+UT_REGISTER_TEST(MAVLinkLogUploaderTest)
+UT_REGISTER_TEST(MAVLinkULogWriterTest)
+UT_REGISTER_TEST(UASMessageModelTest)
+#if defined(QGC_AIRMAP_ENABLED)
+UT_REGISTER_TEST(AirspaceGeometryCacheTest)
+UT_REGISTER_TEST(AirMapTelemetryShaperTest)
+#endif
+#if defined(QGC_ENABLE_PAIRING)
+UT_REGISTER_TEST(AESTest)
+#endif
 UT_REGISTER_TEST(MissionSettingsTest)
 UT_REGISTER_TEST(QGCMapPolygonTest)
 UT_REGISTER_TEST(AudioOutputTest)
+UT_REGISTER_TEST(QGCCorePluginTest)
 UT_REGISTER_TEST(StructureScanComplexItemTest)
 UT_REGISTER_TEST(CorridorScanComplexItemTest)
 UT_REGISTER_TEST(TransectStyleComplexItemTest)
@@ -82,8 +226,32 @@ UT_REGISTER_TEST(QGCMapPolylineTest)
 UT_REGISTER_TEST(CameraCalcTest)
 UT_REGISTER_TEST(FWLandingPatternTest)
 UT_REGISTER_TEST(LandingComplexItemTest)
+UT_REGISTER_TEST(MAVLinkFramerTest)
+UT_REGISTER_TEST(MAVLinkLogWriterTest)
+UT_REGISTER_TEST(MAVLinkForwarderTest)
+UT_REGISTER_TEST(MAVLinkMessageDispatcherTest)
+UT_REGISTER_TEST(MAVLinkFieldDecoderTest)
+UT_REGISTER_TEST(MAVLinkMessageStatisticsTest)
+UT_REGISTER_TEST(MockLinkLoadGeneratorTest)
+UT_REGISTER_TEST(LinkReadStatisticsTest)
+UT_REGISTER_TEST(LinkTrafficStatisticsTest)
+UT_REGISTER_TEST(QGCByteRingBufferTest)
+UT_REGISTER_TEST(QGCPacketQueueTest)
+UT_REGISTER_TEST(TCPLinkTest)
+UT_REGISTER_TEST(TelemetryStreamServerTest)
+UT_REGISTER_TEST(TlogIndexTest)
+UT_REGISTER_TEST(UDPLinkTest)
+UT_REGISTER_TEST(TerrainLocalDEMTest)
+UT_REGISTER_TEST(TerrainPathQueryTest)
+UT_REGISTER_TEST(TerrainTileTest)
+UT_REGISTER_TEST(TerrainProtocolHandlerTest)
 
 UT_REGISTER_TEST_STANDALONE(MissionCommandTreeEditorTest)
+UT_REGISTER_TEST_STANDALONE(TelemetryBenchmark)
+UT_REGISTER_TEST_STANDALONE(MissionLoadBenchmark)
+UT_REGISTER_TEST_STANDALONE(MissionPlanningBenchmark)
+UT_REGISTER_TEST_STANDALONE(StartupBenchmark)
+UT_REGISTER_TEST_STANDALONE(GeoBenchmark)
 
 // List of unit test which are currently disabled.
 // If disabling a new test, include reason in comment.
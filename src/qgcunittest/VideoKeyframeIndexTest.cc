@@ -0,0 +1,248 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VideoKeyframeIndexTest.h"
+#include "VideoKeyframeIndex.h"
+#include "ReplayClock.h"
+
+#include <QtEndian>
+#include <QTemporaryDir>
+
+static const qint64     _startTimeSecs      = 1600000000;
+static const quint32    _videoTimescale     = 90000;
+static const quint32    _frameDuration      = _videoTimescale / 30;
+
+QByteArray VideoKeyframeIndexTest::_be32(quint32 value)
+{
+    uchar bytes[4];
+    qToBigEndian(value, bytes);
+    return QByteArray(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+QByteArray VideoKeyframeIndexTest::_be64(quint64 value)
+{
+    uchar bytes[8];
+    qToBigEndian(value, bytes);
+    return QByteArray(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+QByteArray VideoKeyframeIndexTest::_box(const char* type, const QByteArray& payload)
+{
+    return _be32(static_cast<quint32>(8 + payload.size())) + QByteArray(type, 4) + payload;
+}
+
+QByteArray VideoKeyframeIndexTest::_fullBox(const char* type, quint8 version, quint32 flags, const QByteArray& payload)
+{
+    return _box(type, _be32((static_cast<quint32>(version) << 24) | flags) + payload);
+}
+
+/// Movie with an audio track and a video track, the video samples are given by stbl or the fragments
+QByteArray VideoKeyframeIndexTest::_mp4Moov(const QByteArray& stbl, const QByteArray& mvex, const QByteArray& edts)
+{
+    const QByteArray mvhd = _fullBox("mvhd", 0, 0, _be32(static_cast<quint32>(_startTimeSecs + VideoKeyframeIndex::mp4EpochOffsetSecs)) + _be32(0) + _be32(1000) + _be32(0) + QByteArray(80, '\0'));
+    const QByteArray tkhd = _fullBox("tkhd", 0, 0, _be32(0) + _be32(0) + _be32(1) + QByteArray(68, '\0'));
+    const QByteArray mdhd = _fullBox("mdhd", 0, 0, _be32(0) + _be32(0) + _be32(_videoTimescale) + _be32(0) + QByteArray(4, '\0'));
+    const QByteArray hdlr = _fullBox("hdlr", 0, 0, _be32(0) + QByteArray("vide") + QByteArray(13, '\0'));
+    const QByteArray soun = _fullBox("hdlr", 0, 0, _be32(0) + QByteArray("soun") + QByteArray(13, '\0'));
+
+    // An audio track in front is passed over
+    const QByteArray audio = _box("trak", _fullBox("tkhd", 0, 0, _be32(0) + _be32(0) + _be32(2) + QByteArray(68, '\0')) +
+                                          _box("mdia", _fullBox("mdhd", 0, 0, _be32(0) + _be32(0) + _be32(48000) + _be32(0) + QByteArray(4, '\0')) + soun));
+    const QByteArray video = _box("trak", tkhd + edts + _box("mdia", mdhd + hdlr + _box("minf", _box("stbl", stbl))));
+
+    return _box("moov", mvhd + audio + video + mvex);
+}
+
+QByteArray VideoKeyframeIndexTest::_element(quint32 id, const QByteArray& data, bool unknownSize)
+{
+    QByteArray element;
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        if ((id >> shift) || shift == 0) {
+            element.append(static_cast<char>((id >> shift) & 0xFF));
+        }
+    }
+    // Eight byte sizes, which are all allowed to be
+    element.append(_be64(unknownSize ? Q_UINT64_C(0x01FFFFFFFFFFFFFF) : (Q_UINT64_C(0x0100000000000000) | static_cast<quint64>(data.size()))));
+    element.append(data);
+    return element;
+}
+
+QByteArray VideoKeyframeIndexTest::_uintElement(quint32 id, quint64 value)
+{
+    return _element(id, _be64(value));
+}
+
+bool VideoKeyframeIndexTest::_writeFile(const QString& fileName, const QByteArray& bytes)
+{
+    QFile file(fileName);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        return false;
+    }
+    return file.write(bytes) == bytes.size();
+}
+
+void VideoKeyframeIndexTest::_mp4Test(void)
+{
+    QTemporaryDir   tempDir;
+    QString         fileName = tempDir.filePath(QStringLiteral("video.mp4"));
+
+    // Ten seconds with a key frame each second, after a half second empty edit
+    QByteArray stss;
+    for (int i = 0; i < 10; i++) {
+        stss.append(_be32(static_cast<quint32>((i * 30) + 1)));
+    }
+    const QByteArray stbl = _fullBox("stts", 0, 0, _be32(1) + _be32(300) + _be32(_frameDuration)) +
+                            _fullBox("stss", 0, 0, _be32(10) + stss);
+    const QByteArray edts = _box("edts", _fullBox("elst", 0, 0, _be32(1) + _be32(500) + _be32(0xFFFFFFFF) + _be32(0x00010000)));
+
+    QVERIFY(_writeFile(fileName, _box("ftyp", QByteArray("isom") + _be32(0)) + _mp4Moov(stbl, QByteArray(), edts) + _box("mdat", QByteArray(1000, '\x55'))));
+
+    VideoKeyframeIndex  index;
+    QString             errorString;
+    QVERIFY2(index.build(fileName, errorString), qPrintable(errorString));
+    QCOMPARE(index.keyframes().count(), 10);
+    for (int i = 0; i < 10; i++) {
+        QCOMPARE(index.keyframes()[i], (i * Q_INT64_C(1000000)) + 500000);
+    }
+    QCOMPARE(index.durationUSecs(),     Q_INT64_C(10500000));
+    QCOMPARE(index.startTimeMSecs(),    _startTimeSecs * 1000);
+
+    QCOMPARE(index.keyframeForTime(0),          0);
+    QCOMPARE(index.keyframeForTime(2600000),    2);
+    QCOMPARE(index.keyframeForTime(3500000),    3);
+    QCOMPARE(index.keyframeForTime(60000000),   9);
+}
+
+void VideoKeyframeIndexTest::_fragmentedTest(void)
+{
+    QTemporaryDir   tempDir;
+    QString         fileName = tempDir.filePath(QStringLiteral("video.mp4"));
+
+    // Empty sample tables, fragments default to delta frames and flag their first sample as a key frame
+    const QByteArray stbl = _fullBox("stts", 0, 0, _be32(0));
+    const QByteArray mvex = _box("mvex", _fullBox("trex", 0, 0, _be32(1) + _be32(1) + _be32(_frameDuration) + _be32(0) + _be32(0x00010000)));
+
+    QByteArray bytes = _box("ftyp", QByteArray("iso6") + _be32(0)) + _mp4Moov(stbl, mvex);
+    for (quint64 fragment = 0; fragment < 3; fragment++) {
+        const QByteArray tfhd = _fullBox("tfhd", 0, 0x020000, _be32(1));
+        const QByteArray tfdt = _fullBox("tfdt", 1, 0, _be64(fragment * 2 * _videoTimescale));
+        const QByteArray trun = _fullBox("trun", 0, 0x000005, _be32(60) + _be32(0) + _be32(0x02000000));
+        bytes.append(_box("moof", _fullBox("mfhd", 0, 0, _be32(static_cast<quint32>(fragment + 1))) + _box("traf", tfhd + tfdt + trun)));
+        bytes.append(_box("mdat", QByteArray(500, '\x55')));
+    }
+    QVERIFY(_writeFile(fileName, bytes));
+
+    VideoKeyframeIndex  index;
+    QString             errorString;
+    QVERIFY2(index.build(fileName, errorString), qPrintable(errorString));
+    QCOMPARE(index.keyframes().count(), 3);
+    QCOMPARE(index.keyframes()[0], Q_INT64_C(0));
+    QCOMPARE(index.keyframes()[1], Q_INT64_C(2000000));
+    QCOMPARE(index.keyframes()[2], Q_INT64_C(4000000));
+    QCOMPARE(index.durationUSecs(), Q_INT64_C(6000000));
+    QCOMPARE(index.keyframeForTime(3999999), 1);
+
+    // A recording cut short in its last fragment keeps the fragments before it
+    QVERIFY(_writeFile(fileName, bytes.left(bytes.size() - 600)));
+    QVERIFY(index.build(fileName, errorString));
+    QCOMPARE(index.keyframes().count(), 2);
+}
+
+void VideoKeyframeIndexTest::_matroskaTest(void)
+{
+    QTemporaryDir   tempDir;
+    QString         fileName = tempDir.filePath(QStringLiteral("video.mkv"));
+
+    const QByteArray ebml   = _element(0x1A45DFA3, _element(0x4282, QByteArray("matroska")));
+    const QByteArray info   = _element(0x1549A966, _uintElement(0x2AD7B1, 1000000) +
+                                                   _element(0x4489, _be64(0x40B3880000000000)) +        // 5000.0
+                                                   _uintElement(0x4461, static_cast<quint64>(_startTimeSecs - VideoKeyframeIndex::matroskaEpochOffsetSecs) * 1000000000));
+    // Audio track 1, video track 2
+    const QByteArray tracks = _element(0x1654AE6B, _element(0xAE, _uintElement(0xD7, 1) + _uintElement(0x83, 2)) +
+                                                   _element(0xAE, _uintElement(0xD7, 2) + _uintElement(0x83, 1)));
+
+    QByteArray cuePoints;
+    for (quint64 time = 0; time < 5000; time += 1000) {
+        cuePoints.append(_element(0xBB, _uintElement(0xB3, time) + _element(0xB7, _uintElement(0xF7, 2) + _uintElement(0xF1, 0))));
+    }
+    // Audio only cue
+    cuePoints.append(_element(0xBB, _uintElement(0xB3, 4500) + _element(0xB7, _uintElement(0xF7, 1) + _uintElement(0xF1, 0))));
+    const QByteArray cues       = _element(0x1C53BB6B, cuePoints);
+    const QByteArray cluster    = _element(0x1F43B675, QByteArray(2000, '\x55'));
+
+    QVERIFY(_writeFile(fileName, ebml + _element(0x18538067, info + tracks + cluster + cues)));
+
+    VideoKeyframeIndex  index;
+    QString             errorString;
+    QVERIFY2(index.build(fileName, errorString), qPrintable(errorString));
+    QCOMPARE(index.keyframes().count(), 5);
+    QCOMPARE(index.keyframes()[3],      Q_INT64_C(3000000));
+    QCOMPARE(index.durationUSecs(),     Q_INT64_C(5000000));
+    QCOMPARE(index.startTimeMSecs(),    _startTimeSecs * 1000);
+    QCOMPARE(index.keyframeForTime(4999999), 4);
+
+    // Cluster of unknown size in front of the cues, which are then found through the seek head
+    const QByteArray    unknownCluster  = _element(0x1F43B675, QByteArray(2000, '\x55'), true /* unknownSize */);
+    QByteArray          seekHead        = _element(0x114D9B74, _element(0x4DBB, _element(0x53AB, _be32(0x1C53BB6B)) + _uintElement(0x53AC, 0)));
+    const quint64       cuesPosition    = static_cast<quint64>(seekHead.size() + info.size() + tracks.size() + unknownCluster.size());
+    seekHead = _element(0x114D9B74, _element(0x4DBB, _element(0x53AB, _be32(0x1C53BB6B)) + _uintElement(0x53AC, cuesPosition)));
+
+    QVERIFY(_writeFile(fileName, ebml + _element(0x18538067, seekHead + info + tracks + unknownCluster + cues, true /* unknownSize */)));
+    QVERIFY2(index.build(fileName, errorString), qPrintable(errorString));
+    QCOMPARE(index.keyframes().count(), 5);
+
+    // Without cues there is no index
+    QVERIFY(_writeFile(fileName, ebml + _element(0x18538067, info + tracks + cluster)));
+    QVERIFY(!index.build(fileName, errorString));
+    QVERIFY(!errorString.isEmpty());
+    QVERIFY(!index.isValid());
+}
+
+void VideoKeyframeIndexTest::_unsupportedTest(void)
+{
+    QTemporaryDir       tempDir;
+    QString             fileName = tempDir.filePath(QStringLiteral("video.ts"));
+    VideoKeyframeIndex  index;
+    QString             errorString;
+
+    QVERIFY(_writeFile(fileName, QByteArray(188 * 10, '\x47')));
+    QVERIFY(!index.build(fileName, errorString));
+    QVERIFY(!errorString.isEmpty());
+
+    QVERIFY(!index.build(tempDir.filePath(QStringLiteral("missing.mp4")), errorString));
+
+    // Movie without a video track
+    QVERIFY(_writeFile(fileName, _box("ftyp", QByteArray("isom") + _be32(0)) + _box("moov", _fullBox("mvhd", 0, 0, QByteArray(96, '\0')))));
+    QVERIFY(!index.build(fileName, errorString));
+}
+
+void VideoKeyframeIndexTest::_clockTest(void)
+{
+    ReplayClock     clock;
+    const qint64    wallMSecs       = Q_INT64_C(1600000000000);
+    const quint64   logTimeUSecs    = Q_UINT64_C(1600000000000000);
+
+    clock.stop(logTimeUSecs);
+    QVERIFY(!clock.isRunning());
+    QCOMPARE(clock.logTimeUSecs(wallMSecs + 5000), logTimeUSecs);
+
+    clock.start(logTimeUSecs, 2.0, wallMSecs);
+    QVERIFY(clock.isRunning());
+    QCOMPARE(clock.logTimeUSecs(wallMSecs),         logTimeUSecs);
+    QCOMPARE(clock.logTimeUSecs(wallMSecs + 1000),  logTimeUSecs + 2000000);
+    QCOMPARE(clock.wallMSecs(logTimeUSecs + 3000000), wallMSecs + 1500);
+
+    ReplayClock::State_t state = clock.state(wallMSecs + 250);
+    QVERIFY(state.running);
+    QCOMPARE(state.rate,            2.0);
+    QCOMPARE(state.logTimeUSecs,    logTimeUSecs + 500000);
+
+    clock.stop(logTimeUSecs + 500000);
+    QCOMPARE(clock.state(wallMSecs + 10000).logTimeUSecs, logTimeUSecs + 500000);
+}
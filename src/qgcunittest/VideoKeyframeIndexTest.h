@@ -0,0 +1,36 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+
+/// Unit test for VideoKeyframeIndex and the ReplayClock it is played against
+class VideoKeyframeIndexTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _mp4Test           (void);
+    void _fragmentedTest    (void);
+    void _matroskaTest      (void);
+    void _unsupportedTest   (void);
+    void _clockTest         (void);
+
+private:
+    QByteArray  _box        (const char* type, const QByteArray& payload);
+    QByteArray  _fullBox    (const char* type, quint8 version, quint32 flags, const QByteArray& payload);
+    QByteArray  _mp4Moov    (const QByteArray& stbl, const QByteArray& mvex, const QByteArray& edts = QByteArray());
+    QByteArray  _element    (quint32 id, const QByteArray& data, bool unknownSize = false);
+    QByteArray  _uintElement(quint32 id, quint64 value);
+    bool        _writeFile  (const QString& fileName, const QByteArray& bytes);
+
+    static QByteArray _be32(quint32 value);
+    static QByteArray _be64(quint64 value);
+};
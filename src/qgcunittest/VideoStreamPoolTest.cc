@@ -0,0 +1,109 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "VideoStreamPoolTest.h"
+
+#include <QSignalSpy>
+
+VideoStreamPool::StreamState_t VideoStreamPoolTest::_state(int streamId, int priority, bool visible, bool focused, bool hasLowResolution)
+{
+    VideoStreamPool::StreamState_t state;
+
+    state.streamId          = streamId;
+    state.priority          = priority;
+    state.visible           = visible;
+    state.focused           = focused;
+    state.hasLowResolution  = hasLowResolution;
+
+    return state;
+}
+
+void VideoStreamPoolTest::_focused(void)
+{
+    QList<VideoStreamPool::StreamState_t> streams;
+
+    streams.append(_state(1, 0, true,  false, true));
+    streams.append(_state(2, 0, true,  true,  true));
+    streams.append(_state(3, 5, true,  false, false));
+    streams.append(_state(4, 9, false, false, true));
+
+    QMap<int, VideoStreamPool::DecodeMode_t> modes = VideoStreamPool::decodeModes(streams, 6);
+
+    QCOMPARE(modes.count(), 4);
+    QCOMPARE(modes[1], VideoStreamPool::DecodeLowResolution);
+    QCOMPARE(modes[2], VideoStreamPool::DecodeFull);
+    QCOMPARE(modes[3], VideoStreamPool::DecodeKeyframes);
+    QCOMPARE(modes[4], VideoStreamPool::DecodeNone);
+}
+
+void VideoStreamPoolTest::_noFocus(void)
+{
+    QList<VideoStreamPool::StreamState_t> streams;
+
+    streams.append(_state(1, 0, true, false, true));
+    streams.append(_state(2, 3, true, false, true));
+    streams.append(_state(3, 3, true, false, false));
+
+    // Highest priority gets full decode, first added wins a tie
+    QMap<int, VideoStreamPool::DecodeMode_t> modes = VideoStreamPool::decodeModes(streams, 6);
+
+    QCOMPARE(modes[1], VideoStreamPool::DecodeLowResolution);
+    QCOMPARE(modes[2], VideoStreamPool::DecodeFull);
+    QCOMPARE(modes[3], VideoStreamPool::DecodeKeyframes);
+
+    QVERIFY(VideoStreamPool::decodeModes(QList<VideoStreamPool::StreamState_t>(), 6).isEmpty());
+}
+
+void VideoStreamPoolTest::_maxDecodedStreams(void)
+{
+    QList<VideoStreamPool::StreamState_t> streams;
+
+    streams.append(_state(1, 1, true, false, false));
+    streams.append(_state(2, 2, true, false, false));
+    streams.append(_state(3, 3, true, false, false));
+    streams.append(_state(4, 0, true, true,  false));
+
+    // Focused stream is always decoded, lowest priority streams drop out
+    QMap<int, VideoStreamPool::DecodeMode_t> modes = VideoStreamPool::decodeModes(streams, 2);
+
+    QCOMPARE(modes[4], VideoStreamPool::DecodeFull);
+    QCOMPARE(modes[3], VideoStreamPool::DecodeKeyframes);
+    QCOMPARE(modes[2], VideoStreamPool::DecodeNone);
+    QCOMPARE(modes[1], VideoStreamPool::DecodeNone);
+}
+
+void VideoStreamPoolTest::_poolSignals(void)
+{
+    // No receivers are created while running unit tests, so this only exercises the bookkeeping
+    VideoStreamPool pool;
+    QSignalSpy      countSpy(&pool, &VideoStreamPool::countChanged);
+    QSignalSpy      modeSpy(&pool, &VideoStreamPool::decodeModeChanged);
+
+    const int stream1 = pool.addStream(QStringLiteral("udp://0.0.0.0:5600"), QStringLiteral("udp://0.0.0.0:5601"));
+    const int stream2 = pool.addStream(QStringLiteral("udp://0.0.0.0:5602"));
+    QCOMPARE(pool.count(), 2);
+    QCOMPARE(countSpy.count(), 2);
+    QCOMPARE(pool.decodeMode(stream1), static_cast<int>(VideoStreamPool::DecodeNone));
+
+    pool.setStreamVisible(stream1, true);
+    pool.setStreamVisible(stream2, true);
+    QCOMPARE(pool.decodeMode(stream1), static_cast<int>(VideoStreamPool::DecodeFull));
+    QCOMPARE(pool.decodeMode(stream2), static_cast<int>(VideoStreamPool::DecodeKeyframes));
+
+    modeSpy.clear();
+    pool.setFocusedStream(stream2);
+    QCOMPARE(pool.decodeMode(stream1), static_cast<int>(VideoStreamPool::DecodeLowResolution));
+    QCOMPARE(pool.decodeMode(stream2), static_cast<int>(VideoStreamPool::DecodeFull));
+    QCOMPARE(modeSpy.count(), 2);
+
+    pool.removeStream(stream2);
+    QCOMPARE(pool.focusedStream(), -1);
+    QCOMPARE(pool.count(), 1);
+    QCOMPARE(pool.decodeMode(stream1), static_cast<int>(VideoStreamPool::DecodeFull));
+}
@@ -0,0 +1,28 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include "UnitTest.h"
+#include "VideoStreamPool.h"
+
+/// Unit test for the VideoStreamPool decode policy
+class VideoStreamPoolTest : public UnitTest
+{
+    Q_OBJECT
+
+private slots:
+    void _focused           (void);
+    void _noFocus           (void);
+    void _maxDecodedStreams (void);
+    void _poolSignals       (void);
+
+private:
+    VideoStreamPool::StreamState_t _state(int streamId, int priority, bool visible, bool focused, bool hasLowResolution);
+};
@@ -18,15 +18,25 @@
 #include "UASMessageHandler.h"
 #include "MultiVehicleManager.h"
 #include "Vehicle.h"
+#include "QGCMemoryAccounting.h"
 
-UASMessage::UASMessage(int componentid, int severity, QString text)
+UASMessage::UASMessage(int componentid, int severity, QString text, bool showComponent)
+    : _compId       (componentid)
+    , _severity     (severity)
+    , _text         (text)
+    , _time         (QTime::currentTime())
+    , _showComponent(showComponent)
 {
-    _compId   = componentid;
-    _severity = severity;
-    _text     = text;
 }
 
-bool UASMessage::severityIsError()
+void UASMessage::setRepeatCount(int repeatCount)
+{
+    _repeatCount    = repeatCount;
+    _time           = QTime::currentTime();
+    _formatedText.clear();
+}
+
+bool UASMessage::severityIsError() const
 {
     switch (_severity) {
         case MAV_SEVERITY_EMERGENCY:
@@ -39,6 +49,202 @@ bool UASMessage::severityIsError()
     }
 }
 
+QString UASMessage::severityText(int severity)
+{
+    switch (severity)
+    {
+    case MAV_SEVERITY_EMERGENCY:
+        return UASMessageHandler::tr(" EMERGENCY:");
+    case MAV_SEVERITY_ALERT:
+        return UASMessageHandler::tr(" ALERT:");
+    case MAV_SEVERITY_CRITICAL:
+        return UASMessageHandler::tr(" Critical:");
+    case MAV_SEVERITY_ERROR:
+        return UASMessageHandler::tr(" Error:");
+    case MAV_SEVERITY_WARNING:
+        return UASMessageHandler::tr(" Warning:");
+    case MAV_SEVERITY_NOTICE:
+        return UASMessageHandler::tr(" Notice:");
+    case MAV_SEVERITY_INFO:
+        return UASMessageHandler::tr(" Info:");
+    case MAV_SEVERITY_DEBUG:
+        return UASMessageHandler::tr(" Debug:");
+    default:
+        return QString();
+    }
+}
+
+QString UASMessage::getFormatedText() const
+{
+    if (!_formatedText.isEmpty()) {
+        return _formatedText;
+    }
+
+    // Color the output depending on the message severity. We have 3 distinct cases:
+    // 1: If we have an ERROR or worse, make it bigger, bolder, and highlight it red.
+    // 2: If we have a warning or notice, just make it bold and color it orange.
+    // 3: Otherwise color it the standard color, white.
+    QString style;
+    switch (_severity)
+    {
+    case MAV_SEVERITY_EMERGENCY:
+    case MAV_SEVERITY_ALERT:
+    case MAV_SEVERITY_CRITICAL:
+    case MAV_SEVERITY_ERROR:
+        style = QStringLiteral("<#E>");
+        break;
+    case MAV_SEVERITY_NOTICE:
+    case MAV_SEVERITY_WARNING:
+        style = QStringLiteral("<#I>");
+        break;
+    default:
+        style = QStringLiteral("<#N>");
+        break;
+    }
+
+    // Finally preppend the properly-styled text with a timestamp.
+    QString compString;
+    if (_showComponent) {
+        compString = QString(" COMP:%1").arg(_compId);
+    }
+    QString repeatString;
+    if (_repeatCount > 1) {
+        repeatString = QString(" (x%1)").arg(_repeatCount);
+    }
+    _formatedText = QString("<font style=\"%1\">[%2%3]%4 %5%6</font><br/>").arg(style).arg(_time.toString("hh:mm:ss.zzz")).arg(compString).arg(severityText(_severity)).arg(_text).arg(repeatString);
+    return _formatedText;
+}
+
+UASMessageModel::UASMessageModel(int capacity, QObject* parent)
+    : QAbstractListModel(parent)
+    , _capacity         (capacity > 0 ? capacity : 1)
+{
+    _ring.reserve(_capacity);
+    for (int i=0; i<severityLevels; i++) {
+        _severityCounts[i] = 0;
+    }
+
+    QGCMemoryAccounting::_instance->addSource(QStringLiteral("Vehicle messages"), this, [this]() {
+        QGCMemoryAccounting::Usage_t usage{ _count, _ring.capacity() * static_cast<qint64>(sizeof(UASMessage)) };
+        for (const UASMessage& message: _ring) {
+            usage.bytes += message.textBytes();
+        }
+        return usage;
+    });
+}
+
+UASMessage* UASMessageModel::append(const UASMessage& message)
+{
+    if (_count == _capacity) {
+        // Make room by dropping the oldest message
+        beginRemoveRows(QModelIndex(), 0, 0);
+        int severity = _ring[_first].getSeverity();
+        if (severity >= 0 && severity < severityLevels) {
+            _severityCounts[severity]--;
+        }
+        _first = (_first + 1) % _capacity;
+        _count--;
+        _droppedCount++;
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), _count, _count);
+    int ringIndex = _ringIndex(_count);
+    if (ringIndex < _ring.count()) {
+        _ring[ringIndex] = message;
+    } else {
+        _ring.append(message);
+    }
+    _count++;
+    int severity = message.getSeverity();
+    if (severity >= 0 && severity < severityLevels) {
+        _severityCounts[severity]++;
+    }
+    endInsertRows();
+    emit countChanged(_count);
+
+    return &_ring[ringIndex];
+}
+
+UASMessage* UASMessageModel::repeat(int componentId, int severity, const QString& text, int repeatCount)
+{
+    const int oldestRow = qMax(0, _count - repeatSearchRows);
+    for (int row=_count-1; row>=oldestRow; row--) {
+        UASMessage& message = _ring[_ringIndex(row)];
+        if (message.getComponentID() == componentId && message.getSeverity() == severity && message.getText() == text) {
+            message.setRepeatCount(repeatCount);
+            emit dataChanged(index(row), index(row));
+            return &message;
+        }
+    }
+    return nullptr;
+}
+
+void UASMessageModel::clear(void)
+{
+    beginResetModel();
+    _ring.clear();
+    _first          = 0;
+    _count          = 0;
+    _droppedCount   = 0;
+    for (int i=0; i<severityLevels; i++) {
+        _severityCounts[i] = 0;
+    }
+    endResetModel();
+    emit countChanged(_count);
+}
+
+int UASMessageModel::severityCount(int severity) const
+{
+    return severity >= 0 && severity < severityLevels ? _severityCounts[severity] : 0;
+}
+
+int UASMessageModel::rowCount(const QModelIndex& parent) const
+{
+    Q_UNUSED(parent);
+    return _count;
+}
+
+QVariant UASMessageModel::data(const QModelIndex& index, int role) const
+{
+    if (index.row() < 0 || index.row() >= _count) {
+        return QVariant();
+    }
+
+    const UASMessage& message = at(index.row());
+
+    switch (role) {
+    case SeverityRole:
+        return message.getSeverity();
+    case ComponentIdRole:
+        return message.getComponentID();
+    case TextRole:
+        return message.getText();
+    case FormattedTextRole:
+        return message.getFormatedText();
+    case IsErrorRole:
+        return message.severityIsError();
+    case RepeatCountRole:
+        return message.getRepeatCount();
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> UASMessageModel::roleNames(void) const
+{
+    QHash<int, QByteArray> roles;
+
+    roles[SeverityRole]         = "severity";
+    roles[ComponentIdRole]      = "componentId";
+    roles[TextRole]             = "text";
+    roles[FormattedTextRole]    = "formattedText";
+    roles[IsErrorRole]          = "isError";
+    roles[RepeatCountRole]      = "repeatCount";
+
+    return roles;
+}
+
 UASMessageHandler::UASMessageHandler(QGCApplication* app, QGCToolbox* toolbox)
     : QGCTool(app, toolbox)
     , _activeVehicle(nullptr)
@@ -72,15 +278,10 @@ void UASMessageHandler::setToolbox(QGCToolbox *toolbox)
 
 void UASMessageHandler::clearMessages()
 {
-    _mutex.lock();
-    while(_messages.count()) {
-        delete _messages.last();
-        _messages.pop_back();
-    }
+    _messages.clear();
     _errorCount   = 0;
     _warningCount = 0;
     _normalCount  = 0;
-    _mutex.unlock();
     emit textMessageCountChanged(0);
 }
 
@@ -88,7 +289,7 @@ void UASMessageHandler::_activeVehicleChanged(Vehicle* vehicle)
 {
     // If we were already attached to an autopilot, disconnect it.
     if (_activeVehicle) {
-        disconnect(_activeVehicle, &Vehicle::textMessageReceived, this, &UASMessageHandler::handleTextMessage);
+        disconnect(_activeVehicle, &Vehicle::statusTextReceived, this, &UASMessageHandler::handleStatusText);
         _activeVehicle = nullptr;
         clearMessages();
         emit textMessageReceived(nullptr);
@@ -99,23 +300,29 @@ void UASMessageHandler::_activeVehicleChanged(Vehicle* vehicle)
         // Connect to the new UAS.
         clearMessages();
         _activeVehicle = vehicle;
-        connect(_activeVehicle, &Vehicle::textMessageReceived, this, &UASMessageHandler::handleTextMessage);
+        connect(_activeVehicle, &Vehicle::statusTextReceived, this, &UASMessageHandler::handleStatusText);
     }
 }
 
 void UASMessageHandler::handleTextMessage(int, int compId, int severity, QString text)
 {
-    // Hack to prevent calibration messages from cluttering things up
-    if (_activeVehicle->px4Firmware() && text.startsWith(QStringLiteral("[cal] "))) {
+    _addMessage(compId, severity, text, 1);
+}
+
+void UASMessageHandler::handleStatusText(const StatusTextHandler::StatusText_t& statusText)
+{
+    if (statusText.repeatCount > 1 && _messages.repeat(statusText.compId, statusText.severity, statusText.text, statusText.repeatCount)) {
         return;
     }
+    _addMessage(statusText.compId, statusText.severity, statusText.text, statusText.repeatCount);
+}
 
-    // Color the output depending on the message severity. We have 3 distinct cases:
-    // 1: If we have an ERROR or worse, make it bigger, bolder, and highlight it red.
-    // 2: If we have a warning or notice, just make it bold and color it orange.
-    // 3: Otherwise color it the standard color, white.
-
-    _mutex.lock();
+void UASMessageHandler::_addMessage(int compId, int severity, const QString& text, int repeatCount)
+{
+    // Hack to prevent calibration messages from cluttering things up
+    if (_activeVehicle && _activeVehicle->px4Firmware() && text.startsWith(QStringLiteral("[cal] "))) {
+        return;
+    }
 
     if (_activeComponent < 0) {
         _activeComponent = compId;
@@ -125,81 +332,36 @@ void UASMessageHandler::handleTextMessage(int, int compId, int severity, QString
         _multiComp = true;
     }
 
-    // So first determine the styling based on the severity.
-    QString style;
     switch (severity)
     {
     case MAV_SEVERITY_EMERGENCY:
     case MAV_SEVERITY_ALERT:
     case MAV_SEVERITY_CRITICAL:
     case MAV_SEVERITY_ERROR:
-        style = QString("<#E>");
         _errorCount++;
         _errorCountTotal++;
         break;
     case MAV_SEVERITY_NOTICE:
     case MAV_SEVERITY_WARNING:
-        style = QString("<#I>");
         _warningCount++;
         break;
     default:
-        style = QString("<#N>");
         _normalCount++;
         break;
     }
 
-    // And determine the text for the severitie
-    QString severityText;
-    switch (severity)
-    {
-    case MAV_SEVERITY_EMERGENCY:
-        severityText = tr(" EMERGENCY:");
-        break;
-    case MAV_SEVERITY_ALERT:
-        severityText = tr(" ALERT:");
-        break;
-    case MAV_SEVERITY_CRITICAL:
-        severityText = tr(" Critical:");
-        break;
-    case MAV_SEVERITY_ERROR:
-        severityText = tr(" Error:");
-        break;
-    case MAV_SEVERITY_WARNING:
-        severityText = tr(" Warning:");
-        break;
-    case MAV_SEVERITY_NOTICE:
-        severityText = tr(" Notice:");
-        break;
-    case MAV_SEVERITY_INFO:
-        severityText = tr(" Info:");
-        break;
-    case MAV_SEVERITY_DEBUG:
-        severityText = tr(" Debug:");
-        break;
-    default:
-        break;
-    }
-
-    // Finally preppend the properly-styled text with a timestamp.
-    QString dateString = QDateTime::currentDateTime().toString("hh:mm:ss.zzz");
-    UASMessage* message = new UASMessage(compId, severity, text);
-    QString compString;
-    if (_multiComp) {
-        compString = QString(" COMP:%1").arg(compId);
+    // Formatting waits until someone asks for the text
+    UASMessage* message = _messages.append(UASMessage(compId, severity, text, _multiComp));
+    if (repeatCount > 1) {
+        message->setRepeatCount(repeatCount);
     }
-    message->_setFormatedText(QString("<font style=\"%1\">[%2%3]%4 %5</font><br/>").arg(style).arg(dateString).arg(compString).arg(severityText).arg(text));
 
     if (message->severityIsError()) {
-        _latestError = severityText + " " + text;
+        _latestError = UASMessage::severityText(severity) + " " + text;
     }
 
-    _mutex.unlock();
-
     emit textMessageReceived(message);
-
-    _messages.append(message);
-    int count = _messages.count();
-    emit textMessageCountChanged(count);
+    emit textMessageCountChanged(_messages.count());
 
     if (_showErrorsInToolbar && message->severityIsError()) {
         _app->showCriticalVehicleMessage(message->getText());
@@ -207,32 +369,23 @@ void UASMessageHandler::handleTextMessage(int, int compId, int severity, QString
 }
 
 int UASMessageHandler::getErrorCountTotal() {
-    _mutex.lock();
-    int c = _errorCountTotal;
-    _mutex.unlock();
-    return c;
+    return _errorCountTotal;
 }
 
 int UASMessageHandler::getErrorCount() {
-    _mutex.lock();
     int c = _errorCount;
     _errorCount = 0;
-    _mutex.unlock();
     return c;
 }
 
 int UASMessageHandler::getWarningCount() {
-    _mutex.lock();
     int c = _warningCount;
     _warningCount = 0;
-    _mutex.unlock();
     return c;
 }
 
 int UASMessageHandler::getNormalCount() {
-    _mutex.lock();
     int c = _normalCount;
     _normalCount = 0;
-    _mutex.unlock();
     return c;
 }
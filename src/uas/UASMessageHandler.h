@@ -9,11 +9,13 @@
 
 #pragma once
 
+#include <QAbstractListModel>
 #include <QObject>
+#include <QTime>
 #include <QVector>
-#include <QMutex>
 
 #include "QGCToolbox.h"
+#include "StatusTextHandler.h"
 
 class Vehicle;
 class UASInterface;
@@ -26,36 +28,122 @@ class QGCApplication;
  */
 class UASMessage
 {
-    friend class UASMessageHandler;
 public:
+    /**
+     * @param showComponent Include the component id in the formatted text
+     */
+    UASMessage(int componentid, int severity, QString text, bool showComponent = false);
     /**
      * @brief Get message source component ID
      */
-    int getComponentID()        { return _compId; }
+    int getComponentID() const  { return _compId; }
     /**
      * @brief Get message severity (from MAV_SEVERITY_XXX enum)
      */
-    int getSeverity()           { return _severity; }
+    int getSeverity() const     { return _severity; }
     /**
      * @brief Get message text (e.g. "[pm] sending list")
      */
-    QString getText()           { return _text; }
+    QString getText() const     { return _text; }
+    /**
+     * @brief Number of times the vehicle sent the text in a row, 1 if it wasn't repeated
+     */
+    int getRepeatCount() const  { return _repeatCount; }
+    /**
+     * @brief Updates the repeat count and takes the time of the latest repeat
+     */
+    void setRepeatCount(int repeatCount);
     /**
      * @brief Get (html) formatted text (in the form: "[11:44:21.137 - COMP:50] Info: [pm] sending list")
+     * Built the first time it is asked for.
      */
-    QString getFormatedText()   { return _formatedText; }
+    QString getFormatedText() const;
     /**
      * @return true: This message is a of a severity which is considered an error
      */
-    bool severityIsError();
+    bool severityIsError() const;
+    /**
+     * @return Translated severity text, e.g. " Info:"
+     */
+    static QString severityText(int severity);
+    /**
+     * @return Heap bytes of the text, and of the formatted text once it was built
+     */
+    qint64 textBytes() const { return (_text.capacity() + _formatedText.capacity()) * static_cast<qint64>(sizeof(QChar)); }
 
 private:
-    UASMessage(int componentid, int severity, QString text);
-    void _setFormatedText(const QString formatedText) { _formatedText = formatedText; }
-    int _compId;
-    int _severity;
-    QString _text;
-    QString _formatedText;
+    int             _compId;
+    int             _severity;
+    QString         _text;
+    QTime           _time;
+    bool            _showComponent;
+    int             _repeatCount    = 1;
+    mutable QString _formatedText;
+};
+
+/// Fixed capacity ring of the latest messages. Once it is full the oldest message makes room for the next one, so
+/// memory use doesn't grow with the length of the flight. As a list model only the rows QML shows are formatted.
+class UASMessageModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    UASMessageModel(int capacity = defaultCapacity, QObject* parent = nullptr);
+
+    enum Roles {
+        SeverityRole = Qt::UserRole + 1,
+        ComponentIdRole,
+        TextRole,
+        FormattedTextRole,
+        IsErrorRole,
+        RepeatCountRole,
+    };
+
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+    int count   (void) const { return _count; }
+    int capacity(void) const { return _capacity; }
+
+    /// @param index 0 is the oldest message
+    const UASMessage& at(int index) const { return _ring[_ringIndex(index)]; }
+
+    /// Adds the message, dropping the oldest one if the ring is full
+    /// @return Stored message, valid until it is dropped
+    UASMessage* append(const UASMessage& message);
+
+    /// Updates the repeat count of the newest of the last repeatSearchRows messages which matches
+    /// @return Updated message, nullptr if it is older or was dropped
+    UASMessage* repeat(int componentId, int severity, const QString& text, int repeatCount);
+
+    void clear(void);
+
+    /// @return Number of messages of the MAV_SEVERITY in the ring
+    int severityCount(int severity) const;
+
+    /// @return Number of messages which were dropped to make room since the last clear
+    int droppedCount(void) const { return _droppedCount; }
+
+    // QAbstractListModel overrides
+    int                     rowCount    (const QModelIndex& parent = QModelIndex()) const override;
+    QVariant                data        (const QModelIndex& index, int role) const override;
+    QHash<int, QByteArray>  roleNames   (void) const override;
+
+    static const int defaultCapacity    = 1000;
+    static const int severityLevels     = 8;    ///< MAV_SEVERITY_EMERGENCY ... MAV_SEVERITY_DEBUG
+    static const int repeatSearchRows   = 32;
+
+signals:
+    void countChanged(int count);
+
+private:
+    int _ringIndex(int index) const { return (_first + index) % _capacity; }
+
+    int                 _capacity;
+    QVector<UASMessage> _ring;
+    int                 _first          = 0;    ///< Ring index of the oldest message
+    int                 _count          = 0;
+    int                 _droppedCount   = 0;
+    int                 _severityCounts[severityLevels];
 };
 
 class UASMessageHandler : public QGCTool
@@ -67,17 +155,9 @@ public:
     ~UASMessageHandler();
 
     /**
-     * @brief Locks access to the message list
-     */
-    void lockAccess()   {_mutex.lock(); }
-    /**
-     * @brief Unlocks access to the message list
-     */
-    void unlockAccess() {_mutex.unlock(); }
-    /**
-     * @brief Access to the message list
+     * @brief Access to the latest messages, oldest first
      */
-    const QVector<UASMessage*>& messages() { return _messages; }
+    UASMessageModel* messages() { return &_messages; }
     /**
      * @brief Clear messages
      */
@@ -118,6 +198,11 @@ public slots:
      * @param text Message Text
      */
     void handleTextMessage(int uasid, int componentid, int severity, QString text);
+    /**
+     * @brief Handle status text from current active vehicle. A repeat updates the message it repeats, which isn't
+     * counted or shown in the toolbar again.
+     */
+    void handleStatusText(const StatusTextHandler::StatusText_t& statusText);
 
 signals:
     /**
@@ -135,11 +220,12 @@ private slots:
     void _activeVehicleChanged(Vehicle* vehicle);
 
 private:
+    void _addMessage(int componentid, int severity, const QString& text, int repeatCount);
+
     Vehicle*                _activeVehicle;
     int                     _activeComponent;
     bool                    _multiComp;
-    QVector<UASMessage*>    _messages;
-    QMutex                  _mutex;
+    UASMessageModel         _messages;
     int                     _errorCount;
     int                     _errorCountTotal;
     int                     _warningCount;
@@ -148,4 +234,3 @@ private:
     bool                    _showErrorsInToolbar;
     MultiVehicleManager*    _multiVehicleManager;
 };
-
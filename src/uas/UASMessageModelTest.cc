@@ -0,0 +1,148 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+#include "UASMessageModelTest.h"
+#include "UASMessageHandler.h"
+#include "QGCMAVLink.h"
+
+#include <QSignalSpy>
+
+void UASMessageModelTest::_appendTest(void)
+{
+    UASMessageModel model;
+
+    QCOMPARE(model.count(), 0);
+
+    UASMessage* message = model.append(UASMessage(1, MAV_SEVERITY_ERROR, "error"));
+    QCOMPARE(message->getText(), QString("error"));
+    QVERIFY(message->severityIsError());
+    model.append(UASMessage(1, MAV_SEVERITY_WARNING, "warning"));
+    model.append(UASMessage(1, MAV_SEVERITY_INFO, "info 1"));
+    model.append(UASMessage(1, MAV_SEVERITY_INFO, "info 2"));
+
+    QCOMPARE(model.count(), 4);
+    QCOMPARE(model.rowCount(), 4);
+    QCOMPARE(model.at(0).getText(), QString("error"));
+    QCOMPARE(model.at(3).getText(), QString("info 2"));
+    QCOMPARE(model.severityCount(MAV_SEVERITY_ERROR), 1);
+    QCOMPARE(model.severityCount(MAV_SEVERITY_INFO), 2);
+    QCOMPARE(model.severityCount(MAV_SEVERITY_DEBUG), 0);
+    QCOMPARE(model.severityCount(-1), 0);
+
+    QCOMPARE(model.data(model.index(1), UASMessageModel::TextRole).toString(), QString("warning"));
+    QCOMPARE(model.data(model.index(1), UASMessageModel::SeverityRole).toInt(), static_cast<int>(MAV_SEVERITY_WARNING));
+    QCOMPARE(model.data(model.index(0), UASMessageModel::IsErrorRole).toBool(), true);
+    QVERIFY(!model.data(model.index(4), UASMessageModel::TextRole).isValid());
+
+    model.clear();
+    QCOMPARE(model.count(), 0);
+    QCOMPARE(model.severityCount(MAV_SEVERITY_INFO), 0);
+}
+
+void UASMessageModelTest::_capacityTest(void)
+{
+    const int       capacity = 10;
+    UASMessageModel model(capacity);
+
+    // Wraps around the ring a few times
+    for (int i=0; i<35; i++) {
+        model.append(UASMessage(1, i % 2 ? MAV_SEVERITY_INFO : MAV_SEVERITY_ERROR, QString::number(i)));
+        QVERIFY(model.count() <= capacity);
+    }
+
+    // Newest messages are kept, oldest first
+    QCOMPARE(model.count(), capacity);
+    QCOMPARE(model.droppedCount(), 25);
+    for (int i=0; i<capacity; i++) {
+        QCOMPARE(model.at(i).getText(), QString::number(25 + i));
+    }
+    QCOMPARE(model.severityCount(MAV_SEVERITY_INFO), 5);
+    QCOMPARE(model.severityCount(MAV_SEVERITY_ERROR), 5);
+
+    // Starts over after a clear
+    model.clear();
+    QCOMPARE(model.droppedCount(), 0);
+    model.append(UASMessage(1, MAV_SEVERITY_INFO, "again"));
+    QCOMPARE(model.count(), 1);
+    QCOMPARE(model.at(0).getText(), QString("again"));
+}
+
+void UASMessageModelTest::_formattedTextTest(void)
+{
+    UASMessage error(50, MAV_SEVERITY_ERROR, "[pm] failed", true);
+    QString text = error.getFormatedText();
+    QVERIFY(text.contains("<#E>"));
+    QVERIFY(text.contains(" COMP:50]"));
+    QVERIFY(text.contains(UASMessage::severityText(MAV_SEVERITY_ERROR) + " [pm] failed"));
+    QVERIFY(text.endsWith("</font><br/>"));
+    // Built once
+    QCOMPARE(error.getFormatedText(), text);
+
+    UASMessage notice(1, MAV_SEVERITY_NOTICE, "notice");
+    QVERIFY(notice.getFormatedText().contains("<#I>"));
+    QVERIFY(!notice.getFormatedText().contains("COMP:"));
+
+    UASMessage info(1, MAV_SEVERITY_INFO, "info");
+    QVERIFY(info.getFormatedText().contains("<#N>"));
+}
+
+void UASMessageModelTest::_modelSignalsTest(void)
+{
+    UASMessageModel model(2);
+    QSignalSpy      spyInserted(&model, &QAbstractItemModel::rowsInserted);
+    QSignalSpy      spyRemoved(&model, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy      spyCount(&model, &UASMessageModel::countChanged);
+
+    model.append(UASMessage(1, MAV_SEVERITY_INFO, "1"));
+    model.append(UASMessage(1, MAV_SEVERITY_INFO, "2"));
+    QCOMPARE(spyInserted.count(), 2);
+    QCOMPARE(spyRemoved.count(), 0);
+
+    // A full ring drops the first row
+    model.append(UASMessage(1, MAV_SEVERITY_INFO, "3"));
+    QCOMPARE(spyInserted.count(), 3);
+    QCOMPARE(spyRemoved.count(), 1);
+    QCOMPARE(spyRemoved[0][1].toInt(), 0);
+    QCOMPARE(spyInserted[2][1].toInt(), 1);
+    QCOMPARE(spyCount.count(), 3);
+    QCOMPARE(model.data(model.index(1), UASMessageModel::TextRole).toString(), QString("3"));
+}
+
+void UASMessageModelTest::_repeatTest(void)
+{
+    UASMessageModel model;
+    QSignalSpy      spyDataChanged(&model, &QAbstractItemModel::dataChanged);
+
+    model.append(UASMessage(1, MAV_SEVERITY_CRITICAL, "PreArm: Compass not calibrated"));
+    model.append(UASMessage(1, MAV_SEVERITY_INFO, "info"));
+    QString text = model.at(0).getFormatedText();
+    QVERIFY(!text.contains("(x"));
+
+    // Updates the row in place
+    UASMessage* message = model.repeat(1, MAV_SEVERITY_CRITICAL, "PreArm: Compass not calibrated", 3);
+    QVERIFY(message);
+    QCOMPARE(model.count(), 2);
+    QCOMPARE(model.severityCount(MAV_SEVERITY_CRITICAL), 1);
+    QCOMPARE(spyDataChanged.count(), 1);
+    QCOMPARE(spyDataChanged[0][0].toModelIndex().row(), 0);
+    QCOMPARE(model.data(model.index(0), UASMessageModel::RepeatCountRole).toInt(), 3);
+    QVERIFY(model.at(0).getFormatedText().contains("Compass not calibrated (x3)"));
+
+    // Other component, severity or text isn't a match
+    QVERIFY(!model.repeat(2, MAV_SEVERITY_CRITICAL, "PreArm: Compass not calibrated", 2));
+    QVERIFY(!model.repeat(1, MAV_SEVERITY_ERROR, "PreArm: Compass not calibrated", 2));
+    QVERIFY(!model.repeat(1, MAV_SEVERITY_INFO, "other", 2));
+
+    // Only the latest rows are searched
+    for (int i=0; i<UASMessageModel::repeatSearchRows; i++) {
+        model.append(UASMessage(1, MAV_SEVERITY_INFO, QString::number(i)));
+    }
+    QVERIFY(!model.repeat(1, MAV_SEVERITY_CRITICAL, "PreArm: Compass not calibrated", 4));
+    QVERIFY(model.repeat(1, MAV_SEVERITY_INFO, "0", 2));
+}
@@ -127,7 +127,7 @@ ApplicationWindow {
         toolDrawer.visible      = false
         toolDrawer.toolSource   = ""
         flightView.visible      = false
-        planView.visible        = false
+        planViewLoader.visible  = false
         toolbar.currentToolbar  = currentToolbar
     }
 
@@ -141,7 +141,10 @@ ApplicationWindow {
 
     function showPlanView() {
         viewSwitch(toolbar.planViewToolbar)
-        planView.visible = true
+        // Plan view is only created the first time it is shown. It becomes visible after it is loaded so it still sees the
+        // visible change which sets up its map.
+        planViewLoader.active   = true
+        planViewLoader.visible  = true
     }
 
     function showTool(toolTitle, toolSource, toolIcon) {
@@ -471,10 +474,12 @@ ApplicationWindow {
         anchors.fill:   parent
     }
 
-    PlanView {
-        id:             planView
+    Loader {
+        id:             planViewLoader
         anchors.fill:   parent
         visible:        false
+        active:         false
+        source:         "PlanView.qml"
     }
 
     Drawer {
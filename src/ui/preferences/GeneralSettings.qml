@@ -43,6 +43,10 @@ Rectangle {
     property string _mapProvider:               QGroundControl.settingsManager.flightMapSettings.mapProvider.value
     property string _mapType:                   QGroundControl.settingsManager.flightMapSettings.mapType.value
     property Fact   _followTarget:              QGroundControl.settingsManager.appSettings.followTarget
+    property Fact   _followTargetRate:          QGroundControl.settingsManager.appSettings.followTargetRate
+    property Fact   _audioMuted:                QGroundControl.settingsManager.appSettings.audioMuted
+    property Fact   _audioMessageMaxAge:        QGroundControl.settingsManager.appSettings.audioMessageMaxAge
+    property Fact   _audioVehicleInterval:      QGroundControl.settingsManager.appSettings.audioVehicleInterval
     property real   _panelWidth:                _root.width * _internalWidthRatio
     property real   _margins:                   ScreenTools.defaultFontPixelWidth
     property var    _planViewSettings:          QGroundControl.settingsManager.planViewSettings
@@ -55,6 +59,7 @@ Rectangle {
     property bool   _isRTSP:                    _isGst && _videoSource === _videoSettings.rtspVideoSource
     property bool   _isTCP:                     _isGst && _videoSource === _videoSettings.tcpVideoSource
     property bool   _isMPEGTS:                  _isGst && _videoSource === _videoSettings.mpegtsVideoSource
+    property bool   _isSRT:                     _isGst && _videoSource === _videoSettings.srtVideoSource
     property bool   _videoAutoStreamConfig:     QGroundControl.videoManager.autoStreamConfigured
     property bool   _showSaveVideoSettings:     _isGst || _videoAutoStreamConfig
     property bool   _disableAllDataPersistence: QGroundControl.settingsManager.appSettings.disableAllPersistence.rawValue
@@ -281,6 +286,17 @@ Rectangle {
                                     visible:                tcpUrlLabel.visible
                                 }
 
+                                QGCLabel {
+                                    id:         srtUrlLabel
+                                    text:       qsTr("SRT URL")
+                                    visible:    !_videoAutoStreamConfig && _isSRT && _videoSettings.srtUrl.visible
+                                }
+                                FactTextField {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _videoSettings.srtUrl
+                                    visible:                srtUrlLabel.visible
+                                }
+
                                 QGCLabel {
                                     text:                   qsTr("Aspect Ratio")
                                     visible:                !_videoAutoStreamConfig && _isGst && _videoSettings.aspectRatio.visible
@@ -302,6 +318,28 @@ Rectangle {
                                     visible:                videoFileFormatLabel.visible
                                 }
 
+                                QGCLabel {
+                                    id:         preRecordDurationLabel
+                                    text:       qsTr("Pre-record")
+                                    visible:    _showSaveVideoSettings && _videoSettings.preRecordDuration.visible
+                                }
+                                FactTextField {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _videoSettings.preRecordDuration
+                                    visible:                preRecordDurationLabel.visible
+                                }
+
+                                QGCLabel {
+                                    id:         recordingSegmentDurationLabel
+                                    text:       qsTr("Segment Length")
+                                    visible:    _showSaveVideoSettings && _videoSettings.recordingSegmentDuration.visible
+                                }
+                                FactTextField {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _videoSettings.recordingSegmentDuration
+                                    visible:                recordingSegmentDurationLabel.visible
+                                }
+
                                 QGCLabel {
                                     id:         maxSavedVideoStorageLabel
                                     text:       qsTr("Max Storage Usage")
@@ -326,6 +364,16 @@ Rectangle {
                                     indexModel:             false
                                 }
 
+                                QGCLabel {
+                                    text:       qsTr("Decoder rank overrides")
+                                    visible:    forceVideoDecoderComboBox.visible && QGroundControl.corePlugin.showAdvancedUI
+                                }
+                                FactTextField {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _videoSettings.decoderRankOverrides
+                                    visible:                forceVideoDecoderComboBox.visible && QGroundControl.corePlugin.showAdvancedUI
+                                }
+
                                 Item { width: 1; height: 1}
                                 FactCheckBox {
                                     text:       qsTr("Disable When Disarmed")
@@ -340,6 +388,129 @@ Rectangle {
                                     visible:    !_videoAutoStreamConfig && _isGst && fact.visible
                                 }
 
+                                Item { width: 1; height: 1}
+                                FactCheckBox {
+                                    id:         adaptiveLatencyCheckBox
+                                    text:       qsTr("Adaptive Jitter Buffer")
+                                    fact:       _videoSettings.adaptiveLatency
+                                    visible:    !_videoAutoStreamConfig && _isGst && fact.visible
+                                    enabled:    !_videoSettings.lowLatencyMode.rawValue
+                                }
+
+                                QGCLabel {
+                                    text:       qsTr("Latency / Smoothness")
+                                    visible:    adaptiveLatencyCheckBox.visible && _videoSettings.latencyPreference.visible
+                                }
+                                QGCSlider {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    minimumValue:           0
+                                    maximumValue:           100
+                                    stepSize:               5
+                                    value:                  _videoSettings.latencyPreference.rawValue
+                                    visible:                adaptiveLatencyCheckBox.visible && _videoSettings.latencyPreference.visible
+                                    enabled:                adaptiveLatencyCheckBox.enabled && _videoSettings.adaptiveLatency.rawValue
+                                    onPressedChanged: {
+                                        // Only on release, every change retunes the receivers
+                                        if (!pressed) {
+                                            _videoSettings.latencyPreference.rawValue = value
+                                        }
+                                    }
+                                }
+
+                                QGCLabel {
+                                    text:       qsTr("Thermal Palette")
+                                    visible:    thermalPaletteComboBox.visible
+                                }
+                                FactComboBox {
+                                    id:                     thermalPaletteComboBox
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _videoSettings.thermalPalette
+                                    visible:                _isGst && fact.visible
+                                    indexModel:             false
+                                }
+
+                                Item { width: 1; height: 1}
+                                FactCheckBox {
+                                    id:         thermalAutoRangeCheckBox
+                                    text:       qsTr("Thermal Auto Range")
+                                    fact:       _videoSettings.thermalAutoRange
+                                    visible:    thermalPaletteComboBox.visible
+                                }
+
+                                QGCLabel {
+                                    text:       qsTr("Thermal Range")
+                                    visible:    thermalPaletteComboBox.visible && !_videoSettings.thermalAutoRange.rawValue
+                                }
+                                RowLayout {
+                                    visible:    thermalPaletteComboBox.visible && !_videoSettings.thermalAutoRange.rawValue
+                                    FactTextField { fact: _videoSettings.thermalRangeLow;  Layout.preferredWidth: _comboFieldWidth / 2 }
+                                    FactTextField { fact: _videoSettings.thermalRangeHigh; Layout.preferredWidth: _comboFieldWidth / 2 }
+                                }
+
+                                Item { width: 1; height: 1}
+                                FactCheckBox {
+                                    text:       qsTr("Thermal Isotherm")
+                                    fact:       _videoSettings.thermalIsotherm
+                                    visible:    thermalPaletteComboBox.visible
+                                }
+
+                                QGCLabel {
+                                    text:       qsTr("Isotherm Range")
+                                    visible:    thermalPaletteComboBox.visible && _videoSettings.thermalIsotherm.rawValue
+                                }
+                                RowLayout {
+                                    visible:    thermalPaletteComboBox.visible && _videoSettings.thermalIsotherm.rawValue
+                                    FactTextField { fact: _videoSettings.thermalIsothermLow;  Layout.preferredWidth: _comboFieldWidth / 2 }
+                                    FactTextField { fact: _videoSettings.thermalIsothermHigh; Layout.preferredWidth: _comboFieldWidth / 2 }
+                                }
+
+                                QGCLabel {
+                                    text:       qsTr("Radiometric Scale / Offset")
+                                    visible:    thermalPaletteComboBox.visible && QGroundControl.corePlugin.showAdvancedUI
+                                }
+                                RowLayout {
+                                    visible:    thermalPaletteComboBox.visible && QGroundControl.corePlugin.showAdvancedUI
+                                    FactTextField { fact: _videoSettings.thermalRawScale;  Layout.preferredWidth: _comboFieldWidth / 2 }
+                                    FactTextField { fact: _videoSettings.thermalRawOffset; Layout.preferredWidth: _comboFieldWidth / 2 }
+                                }
+
+                                Item { width: 1; height: 1}
+                                FactCheckBox {
+                                    id:         restreamCheckBox
+                                    text:       QGroundControl.videoManager.restreaming ?
+                                                    qsTr("Restream Video (%1 viewers)").arg(QGroundControl.videoManager.restreamViewers) :
+                                                    qsTr("Restream Video")
+                                    fact:       _videoSettings.restreamEnabled
+                                    visible:    _isGst && fact.visible
+                                }
+
+                                QGCLabel {
+                                    text:       qsTr("Restream Port")
+                                    visible:    restreamCheckBox.visible && _videoSettings.restreamEnabled.rawValue
+                                }
+                                FactTextField {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _videoSettings.restreamPort
+                                    visible:                restreamCheckBox.visible && _videoSettings.restreamEnabled.rawValue
+                                }
+
+                                QGCLabel {
+                                    text:       qsTr("Restream Viewer Limit")
+                                    visible:    restreamCheckBox.visible && _videoSettings.restreamEnabled.rawValue
+                                }
+                                FactTextField {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _videoSettings.restreamMaxViewers
+                                    visible:                restreamCheckBox.visible && _videoSettings.restreamEnabled.rawValue
+                                }
+
+                                Item { width: 1; height: 1}
+                                FactCheckBox {
+                                    text:       qsTr("Record Telemetry Track")
+                                    fact:       _videoSettings.recordTelemetryTrack
+                                    visible:    _showSaveVideoSettings && fact.visible
+                                }
+
                                 Item { width: 1; height: 1}
                                 FactCheckBox {
                                     text:       qsTr("Auto-Delete Saved Recordings")
@@ -535,6 +706,33 @@ Rectangle {
                                     indexModel:             false
                                     visible:                _followTarget.visible
                                 }
+                                QGCLabel {
+                                    text:                   qsTr("GCS Position Rate")
+                                    visible:                _followTargetRate.visible && _followTarget.rawValue !== 0
+                                }
+                                FactTextField {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _followTargetRate
+                                    visible:                _followTargetRate.visible && _followTarget.rawValue !== 0
+                                }
+                                QGCLabel {
+                                    text:                   qsTr("Drop Announcements After")
+                                    visible:                _audioMessageMaxAge.visible && !_audioMuted.rawValue
+                                }
+                                FactTextField {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _audioMessageMaxAge
+                                    visible:                _audioMessageMaxAge.visible && !_audioMuted.rawValue
+                                }
+                                QGCLabel {
+                                    text:                   qsTr("Vehicle Announcement Interval")
+                                    visible:                _audioVehicleInterval.visible && !_audioMuted.rawValue
+                                }
+                                FactTextField {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   _audioVehicleInterval
+                                    visible:                _audioVehicleInterval.visible && !_audioMuted.rawValue
+                                }
                                 QGCLabel {
                                     text:                           qsTr("UI Scaling")
                                     visible:                        _appFontPointSize.visible
@@ -621,6 +819,13 @@ Rectangle {
                                     property Fact _checkInternet: QGroundControl.settingsManager.appSettings.checkInternet
                                 }
 
+                                FactCheckBox {
+                                    text:       qsTr("Save power when not in use")
+                                    fact:       _powerSaving
+                                    visible:    _powerSaving && _powerSaving.visible
+                                    property Fact _powerSaving: QGroundControl.settingsManager.appSettings.powerSaving
+                                }
+
                                 QGCCheckBox {
                                     id:         clearCheck
                                     text:       qsTr("Clear all settings on next start")
@@ -724,12 +929,33 @@ Rectangle {
                             }
                             FactCheckBox {
                                 id:         promptSaveCsv
-                                text:       qsTr("Save CSV log of telemetry data")
+                                text:       qsTr("Record telemetry data")
                                 fact:       _saveCsvTelemetry
                                 visible:    _saveCsvTelemetry.visible
                                 enabled:    !_disableAllDataPersistence
                                 property Fact _saveCsvTelemetry: QGroundControl.settingsManager.appSettings.saveCsvTelemetry
                             }
+                            FactCheckBox {
+                                text:       qsTr("Also write telemetry as CSV")
+                                fact:       _telemetryRecordCsv
+                                visible:    _telemetryRecordCsv.visible
+                                enabled:    promptSaveCsv.checked && !_disableAllDataPersistence
+                                property Fact _telemetryRecordCsv: QGroundControl.settingsManager.appSettings.telemetryRecordCsv
+                            }
+                            RowLayout {
+                                spacing:    ScreenTools.defaultFontPixelWidth
+                                visible:    _telemetryRecordRate.visible
+                                property Fact _telemetryRecordRate: QGroundControl.settingsManager.appSettings.telemetryRecordRate
+                                QGCLabel {
+                                    text:   qsTr("Telemetry record rate")
+                                }
+                                FactComboBox {
+                                    Layout.preferredWidth:  _comboFieldWidth
+                                    fact:                   parent._telemetryRecordRate
+                                    indexModel:             false
+                                    enabled:                promptSaveCsv.checked && !_disableAllDataPersistence
+                                }
+                            }
                         }
                     }
 
@@ -979,6 +1205,91 @@ Rectangle {
                                     rtkGrid.rtkSettings.fixedBasePositionAccuracy.rawValue =    QGroundControl.gpsRtk.currentAccuracy.rawValue
                                 }
                             }
+
+                            Item { width: rtkGrid.firstColWidth; height: 1 }
+                            QGCLabel {
+                                text:               rtkGrid.rtkSettings.rtcmBandwidthLimit.shortDescription
+                                visible:            rtkGrid.rtkSettings.rtcmBandwidthLimit.visible
+                            }
+                            FactTextField {
+                                fact:               rtkGrid.rtkSettings.rtcmBandwidthLimit
+                                visible:            rtkGrid.rtkSettings.rtcmBandwidthLimit.visible
+                                Layout.preferredWidth:  _valueFieldWidth
+                            }
+
+                            FactCheckBox {
+                                text:               rtkGrid.rtkSettings.ntripServerConnectEnabled.shortDescription
+                                fact:               rtkGrid.rtkSettings.ntripServerConnectEnabled
+                                visible:            rtkGrid.rtkSettings.ntripServerConnectEnabled.visible
+                                Layout.columnSpan:  3
+                            }
+
+                            Item { width: rtkGrid.firstColWidth; height: 1 }
+                            QGCLabel {
+                                text:               rtkGrid.rtkSettings.ntripServerHostAddress.shortDescription
+                                visible:            rtkGrid.rtkSettings.ntripServerHostAddress.visible
+                            }
+                            FactTextField {
+                                fact:               rtkGrid.rtkSettings.ntripServerHostAddress
+                                visible:            rtkGrid.rtkSettings.ntripServerHostAddress.visible
+                                Layout.preferredWidth:  _valueFieldWidth
+                            }
+
+                            Item { width: rtkGrid.firstColWidth; height: 1 }
+                            QGCLabel {
+                                text:               rtkGrid.rtkSettings.ntripServerPort.shortDescription
+                                visible:            rtkGrid.rtkSettings.ntripServerPort.visible
+                            }
+                            FactTextField {
+                                fact:               rtkGrid.rtkSettings.ntripServerPort
+                                visible:            rtkGrid.rtkSettings.ntripServerPort.visible
+                                Layout.preferredWidth:  _valueFieldWidth
+                            }
+
+                            Item { width: rtkGrid.firstColWidth; height: 1 }
+                            QGCLabel {
+                                text:               rtkGrid.rtkSettings.ntripMountpoint.shortDescription
+                                visible:            rtkGrid.rtkSettings.ntripMountpoint.visible
+                            }
+                            FactTextField {
+                                fact:               rtkGrid.rtkSettings.ntripMountpoint
+                                visible:            rtkGrid.rtkSettings.ntripMountpoint.visible
+                                Layout.preferredWidth:  _valueFieldWidth
+                            }
+
+                            Item { width: rtkGrid.firstColWidth; height: 1 }
+                            QGCLabel {
+                                text:               rtkGrid.rtkSettings.ntripUsername.shortDescription
+                                visible:            rtkGrid.rtkSettings.ntripUsername.visible
+                            }
+                            FactTextField {
+                                fact:               rtkGrid.rtkSettings.ntripUsername
+                                visible:            rtkGrid.rtkSettings.ntripUsername.visible
+                                Layout.preferredWidth:  _valueFieldWidth
+                            }
+
+                            Item { width: rtkGrid.firstColWidth; height: 1 }
+                            QGCLabel {
+                                text:               rtkGrid.rtkSettings.ntripPassword.shortDescription
+                                visible:            rtkGrid.rtkSettings.ntripPassword.visible
+                            }
+                            FactTextField {
+                                fact:               rtkGrid.rtkSettings.ntripPassword
+                                visible:            rtkGrid.rtkSettings.ntripPassword.visible
+                                echoMode:           TextInput.Password
+                                Layout.preferredWidth:  _valueFieldWidth
+                            }
+
+                            Item { width: rtkGrid.firstColWidth; height: 1 }
+                            QGCLabel {
+                                text:               rtkGrid.rtkSettings.ntripGgaInterval.shortDescription
+                                visible:            rtkGrid.rtkSettings.ntripGgaInterval.visible
+                            }
+                            FactTextField {
+                                fact:               rtkGrid.rtkSettings.ntripGgaInterval
+                                visible:            rtkGrid.rtkSettings.ntripGgaInterval.visible
+                                Layout.preferredWidth:  _valueFieldWidth
+                            }
                         }
                     }
 
@@ -1042,6 +1353,23 @@ Rectangle {
                                 visible:                adsbGrid.adsbSettings.adsbServerPort.visible
                                 Layout.preferredWidth:  _valueFieldWidth
                             }
+
+                            QGCLabel {
+                                text:               adsbGrid.adsbSettings.adsbMaxDistance.shortDescription
+                                visible:            adsbGrid.adsbSettings.adsbMaxDistance.visible
+                            }
+                            FactTextField {
+                                fact:                   adsbGrid.adsbSettings.adsbMaxDistance
+                                visible:                adsbGrid.adsbSettings.adsbMaxDistance.visible
+                                Layout.preferredWidth:  _valueFieldWidth
+                            }
+
+                            FactCheckBox {
+                                text:                   adsbGrid.adsbSettings.adsbConflictAlerts.shortDescription
+                                fact:                   adsbGrid.adsbSettings.adsbConflictAlerts
+                                visible:                adsbGrid.adsbSettings.adsbConflictAlerts.visible
+                                Layout.columnSpan:      2
+                            }
                         }
                     }
 
@@ -45,6 +45,15 @@ Column {
             }
         }
     }
+    QGCCheckBox {
+        text:       qsTr("Reduce display updates during fast playback")
+        checked:    subEditConfig && subEditConfig.linkType === LinkConfiguration.TypeLogReplay ? subEditConfig.rateLimitFactGroups : true
+        onClicked: {
+            if(subEditConfig) {
+                subEditConfig.rateLimitFactGroups = checked
+            }
+        }
+    }
     FileDialog {
         id:             fileDialog
         title:          qsTr("Please choose a file")
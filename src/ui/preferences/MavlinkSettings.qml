@@ -167,7 +167,7 @@ Rectangle {
                             width:              _labelWidth
                             anchors.baseline:   mavlinkForwardingHostNameField.baseline
                             visible:            QGroundControl.settingsManager.appSettings.forwardMavlinkHostName.visible
-                            text:               qsTr("Host name:")
+                            text:               qsTr("Targets:")
                         }
                         FactTextField {
                             id:                     mavlinkForwardingHostNameField
@@ -180,9 +180,15 @@ Rectangle {
 
                     }
                    QGCLabel {
-                        text:       qsTr("<i> Changing the host name requires restart of application. </i>")
+                        text:       qsTr("<i> Separate multiple targets with ';'. Options per target: msgs=0,24,33 rate=5 </i>")
                         visible:    QGroundControl.settingsManager.appSettings.forwardMavlinkHostName.visible
                     }
+
+                    FactCheckBox {
+                        text:       qsTr("Decode MAVLink on link threads (takes effect on reconnect)")
+                        fact:       QGroundControl.settingsManager.appSettings.mavlinkDecodeOnLinkThread
+                        visible:    QGroundControl.settingsManager.appSettings.mavlinkDecodeOnLinkThread.visible
+                    }
                 }
             }
             //-----------------------------------------------------------------
@@ -414,6 +420,27 @@ Rectangle {
                         }
                     }
                     //-----------------------------------------------------------------
+                    //-- Stream statistics
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        anchors.horizontalCenter: parent.horizontalCenter
+                        visible:    QGroundControl.mavlinkLogManager.logPacketsReceived > 0
+                        QGCLabel {
+                            width:              _labelWidth
+                            text:               qsTr("Stream loss:")
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                        QGCLabel {
+                            width:              _valueWidth
+                            text:               qsTr("%1% (%2 dropped, %3 reordered of %4 packets)")
+                                                    .arg(QGroundControl.mavlinkLogManager.logDropRate.toFixed(1))
+                                                    .arg(QGroundControl.mavlinkLogManager.logPacketsDropped)
+                                                    .arg(QGroundControl.mavlinkLogManager.logPacketsReordered)
+                                                    .arg(QGroundControl.mavlinkLogManager.logPacketsReceived)
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                    }
+                    //-----------------------------------------------------------------
                     //-- Enable auto log on arming
                     QGCCheckBox {
                         text:       qsTr("Enable automatic logging")
@@ -531,6 +558,50 @@ Rectangle {
                         }
                     }
                     //-----------------------------------------------------------------
+                    //-- Concurrent Uploads
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        QGCLabel {
+                            width:              _labelWidth
+                            anchors.baseline:   concurrentUploadsField.baseline
+                            text:               qsTr("Concurrent uploads:")
+                        }
+                        QGCTextField {
+                            id:         concurrentUploadsField
+                            text:       QGroundControl.mavlinkLogManager.maxConcurrentUploads
+                            width:      _valueWidth
+                            enabled:    !_disableDataPersistence
+                            validator:  IntValidator {bottom: 1; top: 8;}
+                            inputMethodHints:       Qt.ImhDigitsOnly
+                            anchors.verticalCenter: parent.verticalCenter
+                            onEditingFinished: {
+                                QGroundControl.mavlinkLogManager.maxConcurrentUploads = parseInt(text)
+                            }
+                        }
+                    }
+                    //-----------------------------------------------------------------
+                    //-- Upload Rate Limit
+                    Row {
+                        spacing:    ScreenTools.defaultFontPixelWidth
+                        QGCLabel {
+                            width:              _labelWidth
+                            anchors.baseline:   uploadRateLimitField.baseline
+                            text:               qsTr("Upload rate limit (KB/s, 0 no limit):")
+                        }
+                        QGCTextField {
+                            id:         uploadRateLimitField
+                            text:       QGroundControl.mavlinkLogManager.uploadRateLimit
+                            width:      _valueWidth
+                            enabled:    !_disableDataPersistence
+                            validator:  IntValidator {bottom: 0; top: 100000;}
+                            inputMethodHints:       Qt.ImhDigitsOnly
+                            anchors.verticalCenter: parent.verticalCenter
+                            onEditingFinished: {
+                                QGroundControl.mavlinkLogManager.uploadRateLimit = parseInt(text)
+                            }
+                        }
+                    }
+                    //-----------------------------------------------------------------
                     //-- Wind Speed
                     Row {
                         spacing:                ScreenTools.defaultFontPixelWidth
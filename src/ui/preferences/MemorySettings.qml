@@ -0,0 +1,95 @@
+/****************************************************************************
+ *
+ * (c) 2009-2020 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+ *
+ * QGroundControl is licensed according to the terms in the file
+ * COPYING.md in the root of the source code directory.
+ *
+ ****************************************************************************/
+
+import QtQuick          2.3
+import QtQuick.Layouts  1.11
+
+import QGroundControl               1.0
+import QGroundControl.Controls      1.0
+import QGroundControl.Palette       1.0
+import QGroundControl.ScreenTools   1.0
+
+Rectangle {
+    color:          qgcPal.window
+    anchors.fill:   parent
+
+    readonly property real  _margins:           ScreenTools.defaultFontPixelHeight
+    readonly property var   _memoryAccounting:  QGroundControl.memoryAccounting
+
+    QGCPalette { id: qgcPal; colorGroupEnabled: true }
+
+    Timer {
+        interval:           2000
+        running:            visible
+        repeat:             true
+        triggeredOnStart:   true
+        onTriggered:        _memoryAccounting.update()
+    }
+
+    QGCFlickable {
+        anchors.margins:    _margins
+        anchors.fill:       parent
+        contentWidth:       column.width
+        contentHeight:      column.height
+        clip:               true
+
+        ColumnLayout {
+            id:         column
+            spacing:    _margins
+
+            GridLayout {
+                columns:        2
+                columnSpacing:  _margins
+
+                QGCLabel { text: qsTr("Resident") }
+                QGCLabel { text: _memoryAccounting.residentBytes < 0 ? qsTr("Unknown") : _memoryAccounting.bytesToString(_memoryAccounting.residentBytes) }
+
+                QGCLabel {
+                    text:       qsTr("Allocated (%1)").arg(_memoryAccounting.allocator)
+                    visible:    _memoryAccounting.heapBytes >= 0
+                }
+                QGCLabel {
+                    text:       _memoryAccounting.bytesToString(_memoryAccounting.heapBytes)
+                    visible:    _memoryAccounting.heapBytes >= 0
+                }
+            }
+
+            GridLayout {
+                columns:        4
+                columnSpacing:  _margins
+
+                QGCLabel { text: qsTr("Subsystem"); font.bold: true }
+                QGCLabel { text: qsTr("Items");     font.bold: true; Layout.alignment: Qt.AlignRight }
+                QGCLabel { text: qsTr("Size");      font.bold: true; Layout.alignment: Qt.AlignRight }
+                QGCLabel { text: qsTr("Sources");   font.bold: true; Layout.alignment: Qt.AlignRight }
+
+                // Four cells for each subsystem
+                Repeater {
+                    model: _memoryAccounting.subsystems.length * 4
+
+                    QGCLabel {
+                        text:               index % 4 === 0 ? subsystem.name :
+                                                (index % 4 === 1 ? subsystem.count :
+                                                    (index % 4 === 2 ? _memoryAccounting.bytesToString(subsystem.bytes) : subsystem.sources))
+                        Layout.alignment:   index % 4 === 0 ? Qt.AlignLeft : Qt.AlignRight
+
+                        property var subsystem: _memoryAccounting.subsystems[Math.floor(index / 4)]
+                    }
+                }
+            }
+
+            QGCLabel {
+                Layout.maximumWidth:    ScreenTools.defaultFontPixelWidth * 80
+                wrapMode:               Text.WordWrap
+                font.pointSize:         ScreenTools.smallFontPointSize
+                text:                   qsTr("Sizes are estimates of the container storage of each subsystem. Turn on MemoryAccountingLog in the Console to log them every minute.")
+            }
+        }
+    }
+}
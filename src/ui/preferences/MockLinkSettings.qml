@@ -36,6 +36,13 @@ Column {
             subEditConfig.firmware = 0
         subEditConfig.sendStatus = sendStatus.checked
         subEditConfig.incrementVehicleId = incrementVehicleId.checked
+        subEditConfig.loadVehicleCount = parseInt(loadVehicleCount.text)
+        subEditConfig.loadProfile = loadProfile.text
+        subEditConfig.loadLossPercent = parseFloat(loadLossPercent.text)
+        subEditConfig.loadJitterMSecs = parseInt(loadJitterMSecs.text)
+        subEditConfig.loadBurstMSecs = parseInt(loadBurstMSecs.text)
+        subEditConfig.loadParamCount = parseInt(loadParamCount.text)
+        subEditConfig.loadMissionItemCount = parseInt(loadMissionItemCount.text)
     }
 
     Component.onCompleted: {
@@ -51,6 +58,13 @@ Column {
             copterVehicle.checked = true
         sendStatus.checked = subEditConfig.sendStatus
         incrementVehicleId.checked = subEditConfig.incrementVehicleId
+        loadVehicleCount.text = subEditConfig.loadVehicleCount
+        loadProfile.text = subEditConfig.loadProfile
+        loadLossPercent.text = subEditConfig.loadLossPercent
+        loadJitterMSecs.text = subEditConfig.loadJitterMSecs
+        loadBurstMSecs.text = subEditConfig.loadBurstMSecs
+        loadParamCount.text = subEditConfig.loadParamCount
+        loadMissionItemCount.text = subEditConfig.loadMissionItemCount
     }
 
     QGCCheckBox {
@@ -105,4 +119,51 @@ Column {
             checked:    false
         }
     }
+    Item {
+        height: ScreenTools.defaultFontPixelHeight / 2
+        width:  parent.width
+    }
+    QGCLabel {
+        text:           qsTr("Load Testing")
+    }
+    GridLayout {
+        columns:        2
+        columnSpacing:  ScreenTools.defaultFontPixelWidth
+
+        QGCLabel { text: qsTr("Vehicles") }
+        QGCTextField {
+            id:                 loadVehicleCount
+            inputMethodHints:   Qt.ImhDigitsOnly
+        }
+        QGCLabel { text: qsTr("Rate Profile") }
+        QGCTextField {
+            id:                 loadProfile
+            placeholderText:    qsTr("telemetry, stress or msgid:hz,...")
+        }
+        QGCLabel { text: qsTr("Loss (%)") }
+        QGCTextField {
+            id:                 loadLossPercent
+            inputMethodHints:   Qt.ImhFormattedNumbersOnly
+        }
+        QGCLabel { text: qsTr("Jitter (ms)") }
+        QGCTextField {
+            id:                 loadJitterMSecs
+            inputMethodHints:   Qt.ImhDigitsOnly
+        }
+        QGCLabel { text: qsTr("Burst (ms each second)") }
+        QGCTextField {
+            id:                 loadBurstMSecs
+            inputMethodHints:   Qt.ImhDigitsOnly
+        }
+        QGCLabel { text: qsTr("Parameters") }
+        QGCTextField {
+            id:                 loadParamCount
+            inputMethodHints:   Qt.ImhDigitsOnly
+        }
+        QGCLabel { text: qsTr("Mission Items") }
+        QGCTextField {
+            id:                 loadMissionItemCount
+            inputMethodHints:   Qt.ImhDigitsOnly
+        }
+    }
 }
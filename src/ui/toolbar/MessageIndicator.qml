@@ -83,34 +83,27 @@ Item {
             color:          qgcPal.window
             border.color:   qgcPal.text
 
+            property string _errorStyle:    "color: " + qgcPal.warningText + "; font: " + (ScreenTools.defaultFontPointSize.toFixed(0) - 1) + "pt monospace;"
+            property string _normalStyle:   "color: " + qgcPal.text + "; font: " + (ScreenTools.defaultFontPointSize.toFixed(0) - 1) + "pt monospace;"
+
             function formatMessage(message) {
-                message = message.replace(new RegExp("<#E>", "g"), "color: " + qgcPal.warningText + "; font: " + (ScreenTools.defaultFontPointSize.toFixed(0) - 1) + "pt monospace;");
-                message = message.replace(new RegExp("<#I>", "g"), "color: " + qgcPal.warningText + "; font: " + (ScreenTools.defaultFontPointSize.toFixed(0) - 1) + "pt monospace;");
-                message = message.replace(new RegExp("<#N>", "g"), "color: " + qgcPal.text + "; font: " + (ScreenTools.defaultFontPointSize.toFixed(0) - 1) + "pt monospace;");
+                message = message.replace("<#E>", _errorStyle);
+                message = message.replace("<#I>", _errorStyle);
+                message = message.replace("<#N>", _normalStyle);
+                // Each message has its own row
+                message = message.replace("<br/>", "");
                 return message;
             }
 
             Component.onCompleted: {
-                messageText.text = formatMessage(_activeVehicle.formattedMessages)
-                //-- Hack to scroll to last message
-                for (var i = 0; i < _activeVehicle.messageCount; i++)
-                    messageFlick.flick(0,-5000)
+                messageList.positionViewAtEnd()
                 _activeVehicle.resetMessages()
             }
 
-            Connections {
-                target: _activeVehicle
-                onNewFormattedMessage :{
-                    messageText.append(formatMessage(formattedMessage))
-                    //-- Hack to scroll down
-                    messageFlick.flick(0,-500)
-                }
-            }
-
             QGCLabel {
                 anchors.centerIn:   parent
                 text:               qsTr("No Messages")
-                visible:            messageText.length === 0
+                visible:            messageList.count === 0
             }
 
             //-- Clear Messages
@@ -126,7 +119,7 @@ Item {
                 mipmap:             true
                 smooth:             true
                 color:              qgcPal.text
-                visible:            messageText.length !== 0
+                visible:            messageList.count !== 0
                 MouseArea {
                     anchors.fill:   parent
                     onClicked: {
@@ -138,19 +131,33 @@ Item {
                 }
             }
 
-            QGCFlickable {
-                id:                 messageFlick
+            //-- Only the messages on screen get delegates (and formatted text)
+            QGCListView {
+                id:                 messageList
                 anchors.margins:    ScreenTools.defaultFontPixelHeight
                 anchors.fill:       parent
-                contentHeight:      messageText.height
-                contentWidth:       messageText.width
+                clip:               true
                 pixelAligned:       true
+                model:              _activeVehicle ? _activeVehicle.messageModel : null
+
+                // Follow new messages unless the user scrolled back
+                property bool _atEnd: true
+
+                onMovementEnded:    _atEnd = atYEnd
+                onCountChanged: {
+                    if (_atEnd) {
+                        positionViewAtEnd()
+                    }
+                }
 
-                TextEdit {
-                    id:             messageText
+                delegate: TextEdit {
+                    width:          messageList.width
                     readOnly:       true
+                    selectByMouse:  true
                     textFormat:     TextEdit.RichText
+                    wrapMode:       TextEdit.Wrap
                     color:          qgcPal.text
+                    text:           formatMessage(formattedText)
                 }
             }
         }